@@ -0,0 +1,532 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * On-Target Benchmark
+ *
+ * Main of the jerry_bench image, the application with this file in place
+ * of main.c and without its tasks. It times the kernels the firmware's
+ * budgets rest on with the DWT cycle counter, on the Cortex-M33 at the real
+ * clock, flash wait states and buses: first with the instruction cache off,
+ * as the application runs, then on. The results go to the console for
+ * tools/bench_compare.py.
+ *
+ * Each case is run once to warm up, then BENCH_RUNS times; a run calls the
+ * kernel BENCH_REPEATS times between two counter reads. Interrupts stay
+ * enabled, since the register callbacks may wait on peripherals, so the
+ * fastest run is taken as the cost and the median shows the spread. The
+ * cost of the timing loop itself, an empty kernel timed the same way, is
+ * subtracted.
+ *
+ * Output, one record per line after a "BENCH" tag so that other console
+ * output may be interleaved, fields as key=value:
+ *
+ *   BENCH begin version=1 core_hz=<Hz> overhead=<cycles>
+ *   BENCH case=<name> icache=<0|1> ops=<n> min=<cycles> median=<cycles>
+ *         per_op=<cycles>  (one line)
+ *   BENCH skip icache=<0|1> error=<bsp_error_t>
+ *   BENCH end cases=<n>
+ *
+ * min and median are cycles of one kernel call, ops the units of work of a
+ * call (samples, bytes or registers), and per_op is min / ops to two
+ * decimals. A pass is skipped if the secure image cannot set the cache.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter.h"
+#include "arm_math.h"
+#include "bsp.h"
+#include "log.h"
+#include "modbus_callbacks.h"
+#include "modbus_internal.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack of the benchmark task in words */
+#define BENCH_TASK_STACK_SIZE 1024
+
+/** Output format version, the "version" of the begin record */
+#define BENCH_FORMAT_VERSION 1U
+
+/** Timed runs of each case; odd, so that the median is one run */
+#define BENCH_RUNS 15U
+
+/** Kernel calls of one timed run */
+#define BENCH_REPEATS 8U
+
+/** Bytes of a CRC and LRC frame, the largest RTU frame's payload */
+#define BENCH_FRAME_BYTES 256U
+
+/** Bytes of a copy */
+#define BENCH_COPY_BYTES 1024U
+
+/** Samples of a q15 copy, as the spectrum collector makes them */
+#define BENCH_COPY_SAMPLES 512U
+
+/** Holding registers read and written, the PWM block (HR 0-11) */
+#define BENCH_HOLDING_REGISTERS 12U
+
+/** Input registers read, the ADC values (IR 0-3) */
+#define BENCH_INPUT_REGISTERS 4U
+
+/** Coils read, the digital outputs (coils 0-15) */
+#define BENCH_COILS 16U
+
+/** Channels and block of the filter context benchmarked */
+#define BENCH_FILTER_CHANNELS 6U
+#define BENCH_FILTER_BLOCK    64U
+
+/** Decimated samples of one filter block */
+#define BENCH_DECIMATED_SAMPLES \
+    (BENCH_FILTER_BLOCK / ADC_FILTER_DECIMATION_FACTOR)
+
+/**
+ * @brief One benchmark case
+ */
+typedef struct
+{
+    const char* name;  /**< Case name, kept stable for comparisons */
+    void (*run)(void); /**< One kernel call */
+    uint32_t    ops;   /**< Units of work of one call */
+} bench_case_t;
+
+/* ==========================================================================
+ * Forward Declarations (MISRA 8.4)
+ * ========================================================================== */
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer,
+                                   StackType_t**  ppxIdleTaskStackBuffer,
+                                   uint32_t*      pulIdleTaskStackSize);
+void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer,
+                                    StackType_t**  ppxTimerTaskStackBuffer,
+                                    uint32_t*      pulTimerTaskStackSize);
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char* pcTaskName);
+void vApplicationMallocFailedHook(void);
+void vApplicationIdleHook(void);
+void vApplicationTickHook(void);
+
+/* ==========================================================================
+ * Data
+ * ========================================================================== */
+
+static StaticTask_t xBenchTaskTCB;
+static StackType_t  xBenchTaskStack[BENCH_TASK_STACK_SIZE];
+
+ADC_FILTER_CONTEXT_DEFINE(s_filter, ADC_FILTER_COEFFS_DEFAULT,
+                          BENCH_FILTER_CHANNELS, BENCH_FILTER_BLOCK);
+static adc_filter_sample_t s_filter_in[BENCH_FILTER_BLOCK];
+static adc_filter_sample_t s_filter_out[BENCH_FILTER_BLOCK];
+static float32_t           s_frame_in[BENCH_FILTER_CHANNELS];
+static float32_t           s_frame_out[BENCH_FILTER_CHANNELS];
+static float32_t           s_decimate_in[BENCH_FILTER_BLOCK];
+static float32_t           s_decimate_out[BENCH_DECIMATED_SAMPLES];
+
+static uint8_t      s_bytes[BENCH_FRAME_BYTES];
+static modbus_pdu_t s_pdu;
+static uint8_t      s_pdu_buffer[MODBUS_MAX_PDU_SIZE];
+static uint8_t      s_request[MODBUS_MAX_PDU_SIZE];
+static uint16_t     s_request_length;
+static uint16_t     s_registers[BENCH_HOLDING_REGISTERS];
+static uint8_t      s_coils[(BENCH_COILS + 7U) / 8U];
+
+/* Word aligned; the unaligned copy starts one byte in */
+static uint32_t s_copy_src[(BENCH_COPY_BYTES / 4U) + 1U];
+static uint32_t s_copy_dst[(BENCH_COPY_BYTES / 4U) + 1U];
+static q15_t    s_q15_src[BENCH_COPY_SAMPLES];
+static q15_t    s_q15_dst[BENCH_COPY_SAMPLES];
+
+/** Results the compiler must not drop */
+static volatile uint32_t s_sink;
+
+/* ==========================================================================
+ * Cases
+ * ========================================================================== */
+
+static void bench_empty(void) {}
+
+static void bench_filter_block(void)
+{
+    adc_filter_process_block(&s_filter, 0U, s_filter_in, s_filter_out,
+                             BENCH_FILTER_BLOCK);
+}
+
+static void bench_filter_frame(void)
+{
+    adc_filter_process_frame(&s_filter, s_frame_in, s_frame_out);
+}
+
+static void bench_filter_decimate(void)
+{
+    s_sink = adc_filter_decimate_block(&s_filter, 0U, s_decimate_in,
+                                       s_decimate_out, BENCH_FILTER_BLOCK);
+}
+
+static void bench_crc16(void)
+{
+    s_sink = modbus_crc16(s_bytes, BENCH_FRAME_BYTES);
+}
+
+static void bench_crc16_table(void)
+{
+    s_sink = modbus_crc16_table(s_bytes, BENCH_FRAME_BYTES);
+}
+
+static void bench_crc16_bitwise(void)
+{
+    s_sink = modbus_crc16_bitwise(s_bytes, BENCH_FRAME_BYTES);
+}
+
+#if MODBUS_CRC_BACKEND == MODBUS_CRC_BACKEND_HW
+static void bench_crc16_hw(void)
+{
+    uint16_t crc = 0U;
+
+    (void)modbus_crc16_hw(s_bytes, BENCH_FRAME_BYTES, &crc);
+    s_sink = crc;
+}
+#endif
+
+static void bench_lrc(void) { s_sink = modbus_lrc(s_bytes, BENCH_FRAME_BYTES); }
+
+static void bench_pdu_encode(void)
+{
+    uint16_t length = 0U;
+
+    (void)modbus_pdu_encode_read_holding_registers(&s_pdu, 0U,
+                                                   BENCH_HOLDING_REGISTERS);
+    (void)modbus_pdu_serialize(&s_pdu, s_pdu_buffer, sizeof(s_pdu_buffer),
+                               &length);
+    s_sink = length;
+}
+
+static void bench_pdu_decode(void)
+{
+    uint16_t address  = 0U;
+    uint16_t quantity = 0U;
+
+    (void)modbus_pdu_deserialize(&s_pdu, s_request, s_request_length);
+    (void)modbus_pdu_decode_read_registers_request(&s_pdu, &address,
+                                                   &quantity);
+    s_sink = quantity;
+}
+
+static void bench_pdu_encode_write(void)
+{
+    uint16_t length = 0U;
+
+    (void)modbus_pdu_encode_write_multiple_registers(
+        &s_pdu, 0U, BENCH_HOLDING_REGISTERS, s_registers);
+    (void)modbus_pdu_serialize(&s_pdu, s_pdu_buffer, sizeof(s_pdu_buffer),
+                               &length);
+    s_sink = length;
+}
+
+static void bench_read_holding(void)
+{
+    s_sink = (uint32_t)modbus_cb_read_holding_registers(
+        0U, BENCH_HOLDING_REGISTERS, s_registers);
+}
+
+static void bench_read_input(void)
+{
+    s_sink = (uint32_t)modbus_cb_read_input_registers(
+        0U, BENCH_INPUT_REGISTERS, s_registers);
+}
+
+static void bench_read_coils(void)
+{
+    s_sink = (uint32_t)modbus_cb_read_coils(0U, BENCH_COILS, s_coils);
+}
+
+static void bench_memcpy(void)
+{
+    (void)memcpy(s_copy_dst, s_copy_src, BENCH_COPY_BYTES);
+}
+
+static void bench_memcpy_unaligned(void)
+{
+    (void)memcpy(s_copy_dst, (const uint8_t*)s_copy_src + 1U,
+                 BENCH_COPY_BYTES);
+}
+
+static void bench_memset(void)
+{
+    (void)memset(s_copy_dst, 0, BENCH_COPY_BYTES);
+}
+
+static void bench_copy_q15(void)
+{
+    arm_copy_q15(s_q15_src, s_q15_dst, BENCH_COPY_SAMPLES);
+}
+
+static const bench_case_t s_cases[] = {
+    {"adc_filter_block", bench_filter_block, BENCH_FILTER_BLOCK},
+    {"adc_filter_frame", bench_filter_frame, BENCH_FILTER_CHANNELS},
+    {"adc_filter_decimate", bench_filter_decimate, BENCH_FILTER_BLOCK},
+    {"crc16", bench_crc16, BENCH_FRAME_BYTES},
+    {"crc16_table", bench_crc16_table, BENCH_FRAME_BYTES},
+    {"crc16_bitwise", bench_crc16_bitwise, BENCH_FRAME_BYTES},
+#if MODBUS_CRC_BACKEND == MODBUS_CRC_BACKEND_HW
+    {"crc16_hw", bench_crc16_hw, BENCH_FRAME_BYTES},
+#endif
+    {"lrc", bench_lrc, BENCH_FRAME_BYTES},
+    {"pdu_encode_fc03", bench_pdu_encode, 1U},
+    {"pdu_decode_fc03", bench_pdu_decode, 1U},
+    {"pdu_encode_fc16", bench_pdu_encode_write, BENCH_HOLDING_REGISTERS},
+    {"cb_read_holding", bench_read_holding, BENCH_HOLDING_REGISTERS},
+    {"cb_read_input", bench_read_input, BENCH_INPUT_REGISTERS},
+    {"cb_read_coils", bench_read_coils, BENCH_COILS},
+    {"memcpy", bench_memcpy, BENCH_COPY_BYTES},
+    {"memcpy_unaligned", bench_memcpy_unaligned, BENCH_COPY_BYTES},
+    {"memset", bench_memset, BENCH_COPY_BYTES},
+    {"arm_copy_q15", bench_copy_q15, BENCH_COPY_SAMPLES},
+};
+
+/* ==========================================================================
+ * Timing
+ * ========================================================================== */
+
+/**
+ * @brief Fill the inputs with data that exercises every branch
+ */
+static void bench_prepare(void)
+{
+    uint32_t seed = 0x12345678U;
+
+    (void)adc_filter_init(&s_filter);
+
+    for (uint32_t i = 0U; i < BENCH_FILTER_BLOCK; i++)
+    {
+        /* Linear congruential noise around mid-scale */
+        seed           = (seed * 1664525U) + 1013904223U;
+        s_filter_in[i] = ADC_FILTER_FROM_ADC12(1024U + ((seed >> 20) & 2047U));
+        s_decimate_in[i] = ADC_FILTER_TO_FLOAT(s_filter_in[i]);
+    }
+    for (uint32_t i = 0U; i < BENCH_FILTER_CHANNELS; i++)
+    {
+        s_frame_in[i] = ADC_FILTER_TO_FLOAT(s_filter_in[i]);
+    }
+    for (uint32_t i = 0U; i < BENCH_FRAME_BYTES; i++)
+    {
+        seed       = (seed * 1664525U) + 1013904223U;
+        s_bytes[i] = (uint8_t)(seed >> 24);
+    }
+    for (uint32_t i = 0U; i < BENCH_COPY_SAMPLES; i++)
+    {
+        s_q15_src[i] = (q15_t)(int32_t)(i * 64U);
+    }
+    (void)memset(s_copy_src, 0xA5, sizeof(s_copy_src));
+
+    (void)modbus_pdu_encode_read_holding_registers(&s_pdu, 0U,
+                                                   BENCH_HOLDING_REGISTERS);
+    (void)modbus_pdu_serialize(&s_pdu, s_request, sizeof(s_request),
+                               &s_request_length);
+}
+
+/**
+ * @brief Time BENCH_REPEATS calls of a kernel
+ * @return Cycles of all calls
+ */
+static uint32_t bench_time(void (*run)(void))
+{
+    uint32_t start = BSP_CycleCounter_Read();
+
+    for (uint32_t i = 0U; i < BENCH_REPEATS; i++)
+    {
+        run();
+    }
+
+    return BSP_CycleCounter_Read() - start;
+}
+
+/**
+ * @brief Time one kernel
+ * @param[in]  run    Kernel
+ * @param[out] median Median cycles of one call
+ * @return Fewest cycles of one call
+ */
+static uint32_t bench_measure(void (*run)(void), uint32_t* median)
+{
+    uint32_t runs[BENCH_RUNS];
+
+    /* Warm-up: the cache, the flash prefetch, lazily set up state */
+    (void)bench_time(run);
+
+    for (uint32_t r = 0U; r < BENCH_RUNS; r++)
+    {
+        uint32_t cycles = bench_time(run);
+        uint32_t i      = r;
+
+        /* Insertion sort, the runs are few */
+        while ((i > 0U) && (runs[i - 1U] > cycles))
+        {
+            runs[i] = runs[i - 1U];
+            i--;
+        }
+        runs[i] = cycles;
+    }
+
+    *median = runs[BENCH_RUNS / 2U] / BENCH_REPEATS;
+    return runs[0] / BENCH_REPEATS;
+}
+
+/**
+ * @brief Time one case and print its record
+ */
+static void bench_run_case(const bench_case_t* bench, bool icache,
+                           uint32_t overhead)
+{
+    uint32_t median  = 0U;
+    uint32_t fastest = bench_measure(bench->run, &median);
+    uint32_t per_op;
+
+    fastest = (fastest > overhead) ? (fastest - overhead) : 0U;
+    median  = (median > overhead) ? (median - overhead) : 0U;
+    per_op  = (uint32_t)(((uint64_t)fastest * 100U) / bench->ops);
+
+    (void)printf(
+        "BENCH case=%s icache=%u ops=%lu min=%lu median=%lu per_op=%lu.%02lu\n",
+        bench->name, icache ? 1U : 0U, (unsigned long)bench->ops,
+        (unsigned long)fastest, (unsigned long)median,
+        (unsigned long)(per_op / 100U), (unsigned long)(per_op % 100U));
+}
+
+/* ==========================================================================
+ * Benchmark Task
+ * ========================================================================== */
+
+static void vBenchTask(void* pvParameters)
+{
+    const uint32_t count = sizeof(s_cases) / sizeof(s_cases[0]);
+    uint32_t       overhead;
+    uint32_t       median = 0U;
+    uint32_t       done   = 0U;
+
+    (void)pvParameters;
+
+    bench_prepare();
+    overhead = bench_measure(bench_empty, &median);
+
+    (void)printf("BENCH begin version=%u core_hz=%lu overhead=%lu\n",
+                 BENCH_FORMAT_VERSION, (unsigned long)BSP_CycleCounter_Hz(),
+                 (unsigned long)overhead);
+
+    for (uint32_t pass = 0U; pass < 2U; pass++)
+    {
+        bool        icache = (pass != 0U);
+        bsp_error_t ret    = BSP_ICache_Set(icache);
+
+        if (ret != BSP_OK)
+        {
+            (void)printf("BENCH skip icache=%u error=%d\n", icache ? 1U : 0U,
+                         (int)ret);
+            continue;
+        }
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            bench_run_case(&s_cases[i], icache, overhead);
+            done++;
+        }
+    }
+
+    /* Back to the application's configuration */
+    (void)BSP_ICache_Set(false);
+
+    (void)printf("BENCH end cases=%lu\n", (unsigned long)done);
+
+    for (;;)
+    {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
+/* ==========================================================================
+ * FreeRTOS Hooks
+ * ========================================================================== */
+
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer,
+                                   StackType_t**  ppxIdleTaskStackBuffer,
+                                   uint32_t*      pulIdleTaskStackSize)
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t  xIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+    *ppxIdleTaskTCBBuffer   = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = xIdleTaskStack;
+    *pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer,
+                                    StackType_t**  ppxTimerTaskStackBuffer,
+                                    uint32_t*      pulTimerTaskStackSize)
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t  xTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+    *ppxTimerTaskTCBBuffer   = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = xTimerTaskStack;
+    *pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char* pcTaskName)
+{
+    (void)xTask;
+
+    (void)printf("BENCH error stack_overflow task=%s\n", pcTaskName);
+    taskDISABLE_INTERRUPTS();
+    for (;;)
+    {
+        /* Halt */
+    }
+}
+
+void vApplicationMallocFailedHook(void)
+{
+    (void)printf("BENCH error malloc_failed\n");
+    taskDISABLE_INTERRUPTS();
+    for (;;)
+    {
+        /* Halt */
+    }
+}
+
+void vApplicationIdleHook(void) {}
+
+void vApplicationTickHook(void)
+{
+    /* Keep the run-time counter's wrap count current */
+    (void)BSP_CycleCounter_Read64();
+}
+
+/* ==========================================================================
+ * Main
+ * ========================================================================== */
+
+int main(void)
+{
+    /* Register callbacks may log */
+    log_init();
+
+    BSP_Init();
+
+    if (NULL != xTaskCreateStatic(vBenchTask, "Bench", BENCH_TASK_STACK_SIZE,
+                                  NULL, TASK_PRIO_BACKGROUND, xBenchTaskStack,
+                                  &xBenchTaskTCB))
+    {
+        vTaskStartScheduler();
+    }
+
+    while (1)
+    {
+        /* Should never reach here */
+    }
+    return 0;
+}
@@ -2,10 +2,28 @@
 #define BSP_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "arm_math_types.h"
+
+/**
+ * @brief Host simulation build (VENDOR=posix)
+ *
+ * The BSP is the shim of bsp/posix: the same interface on the FreeRTOS
+ * POSIX port, with recorded or synthetic ADC data, a TAP interface for the
+ * Ethernet and host stand-ins for the Cortex-M intrinsics used by the
+ * application.
+ */
+#ifndef BSP_POSIX
+#define BSP_POSIX 0
+#endif
+
+#if BSP_POSIX
+#include "bsp_posix.h"
+#else
 #include "stm32h5xx_nucleo.h"
+#endif
 
 /**
  * @brief BSP Error Codes
@@ -39,8 +57,9 @@ typedef int bsp_error_t;
  * @defgroup BSP_I2C_Digital_Output_Channels I2C Digital Output Channel Indices
  * @brief Channel indices for I2C digital outputs (PCF8574/PCF8574A).
  *
- * These macros define the channel indices for the 16 digital outputs
- * controlled via I2C expanders.
+ * These macros define the channel indices of the first 16 digital outputs,
+ * those of the first two I2C expanders; an output image holds up to
+ * ::BSP_I2CDO_MAX_OUTPUTS.
  *
  * @{
  */
@@ -118,26 +137,304 @@ typedef int bsp_error_t;
 /** @} */
 
 /**
- * @defgroup BSP_I2C_Digital_Output_Addresses I2C Digital Output Addresses
- * @brief I2C addresses and timeout for PCF8574 and PCF8574A expanders.
+ * @defgroup BSP_I2C_Digital_Output_Bus I2C Digital Output Bus
+ * @brief Expanders on I2C3 and timeout.
+ *
+ * The outputs are PCF8574 class 8-bit expanders, one byte each: output n is
+ * bit n % 8 of expander n / 8, in the order given to BSP_I2CDO_init(). The
+ * application takes that order from the code generator
+ * (jerry_device_i2c_expanders), so the outputs follow the coils of the
+ * register map.
  * @{
  */
-#define BSP_I2CDO_PCF8574_ADDR                                              \
-    (0x20 << 1) /**< 7-bit I2C address of PCF8574 (0x20), shifted left by 1 \
-                   for HAL functions. */
-#define BSP_I2CDO_PCF8574A_ADDR                                              \
-    (0x21 << 1) /**< 7-bit I2C address of PCF8574A (0x21), shifted left by 1 \
-                   for HAL functions. */
+#define BSP_I2CDO_MAX_EXPANDERS 4U /**< Expanders the output image holds */
+#define BSP_I2CDO_MAX_OUTPUTS                                               \
+    (8U * BSP_I2CDO_MAX_EXPANDERS) /**< Bits of the output image */
 #define BSP_I2CDO_TIMEOUT                               \
     100 /**< I2C communication timeout in milliseconds. \
          */
 /** @} */
 
+/**
+ * @brief Task notification index used to signal I2C digital output transfer
+ * completion (index 0 is left to the application tasks).
+ */
+#define BSP_I2CDO_NOTIFY_INDEX 1U
+
+/**
+ * @brief Completion handle for an asynchronous I2C digital output transfer.
+ *
+ * The handle must stay valid until the transfer has completed, i.e. until
+ * BSP_I2CDO_IsDone() returns true. It is owned by the caller; the BSP only
+ * references it while the transfer is in flight.
+ */
+typedef struct
+{
+    volatile bsp_error_t status; /**< BSP_BUSY while in flight, then result */
+    void    *waiter;             /**< Task notified on completion */
+    uint32_t value;              /**< Output image being written */
+    uint8_t  bytes[BSP_I2CDO_MAX_EXPANDERS]; /**< Expander transmit bytes */
+    uint8_t  pending;            /**< Expanders still to write, bit n = n */
+    volatile uint8_t stage;      /**< Expander currently being written */
+} bsp_i2cdo_xfer_t;
+
+/**
+ * @brief Task notification index used to signal RS-485 frame reception and
+ * transmit completion to the task that called BSP_RS485_Init().
+ */
+#define BSP_RS485_NOTIFY_INDEX 2U
+
+/**
+ * @brief Task notification index used to signal console transmit completion
+ * to the task in BSP_Console_Transmit(). Shared with
+ * ::BSP_I2CDO_NOTIFY_INDEX, so that task must not also drive the I2C
+ * outputs.
+ */
+#define BSP_CONSOLE_NOTIFY_INDEX 1U
+
+/**
+ * @brief Task notification index used to signal the end of a flash write to
+ * the task that started it with BSP_Flash_WriteAsync().
+ */
+#define BSP_FLASH_NOTIFY_INDEX 3U
+
+/**
+ * @defgroup BSP_RS485_Parity RS-485 Parity Settings
+ * @brief Character formats of the RS-485 port (always 11 bits per character).
+ * @{
+ */
+#define BSP_RS485_PARITY_NONE 0U /**< 8 data bits, no parity, 2 stop bits */
+#define BSP_RS485_PARITY_EVEN 1U /**< 8 data bits, even parity, 1 stop bit */
+#define BSP_RS485_PARITY_ODD  2U /**< 8 data bits, odd parity, 1 stop bit */
+/** @} */
+
+/** @brief Size of the circular RS-485 receive DMA buffer in bytes */
+#define BSP_RS485_RX_RING_SIZE 1024U
+
+/**
+ * @brief RS-485 port configuration.
+ */
+typedef struct
+{
+    uint32_t baudrate;         /**< Bit rate in bits per second */
+    uint32_t parity;           /**< ::BSP_RS485_Parity */
+    uint32_t frame_timeout_us; /**< Line silence that ends a frame */
+} bsp_rs485_config_t;
+
+/**
+ * @brief RS-485 port statistics (cumulative since BSP_RS485_Init()).
+ */
+typedef struct
+{
+    uint32_t frames;      /**< Frames delimited by the receiver timeout */
+    uint32_t rx_errors;   /**< Frames with parity, framing or noise errors */
+    uint32_t rx_overruns; /**< Frames dropped because none could be queued */
+    uint32_t tx_frames;   /**< Frames transmitted */
+} bsp_rs485_stats_t;
+
 /**
  * @brief Number of ADC1 channels configured
  */
 #define BSP_ADC1_NUM_CHANNELS 6U
 
+/**
+ * @brief Convert the channels on ADC1 and ADC2 in dual simultaneous mode
+ *
+ * 0 converts all channels one after the other on ADC1. 1 splits them: ADC1
+ * converts channels 0 to 2 and ADC2 channels 3 to 5 at the same time, in
+ * regular simultaneous mode on the same trigger, and one DMA channel moves
+ * both results of a pair at once. The sequence takes half as long, and
+ * channels n and n + 3 are sampled at the same instant. Set by the CMake
+ * option JERRY_ADC_DUAL_MODE.
+ */
+#ifndef BSP_ADC1_DUAL_MODE
+#define BSP_ADC1_DUAL_MODE 0
+#endif
+
+/**
+ * @brief ADC1 channels sampled at ADC_FILTER_SLOW_SAMPLE_RATE, bit n for
+ * channel n
+ *
+ * 0 converts every channel on every trigger. A set bit takes a channel
+ * that changes far slower than the sample rate, a temperature for one, out
+ * of the regular sequence: ADC2 converts the slow channels in its injected
+ * group once per slow sample period, on the TIM1 update that the
+ * repetition counter lets through every rate / ADC_FILTER_SLOW_SAMPLE_RATE
+ * triggers, and the filter task runs them through a filter set of their own,
+ * ADC_FILTER_COEFFS_SLOW. The sequence, the DMA transfers and the block
+ * pipeline then carry the other channels only; a slow channel's last raw
+ * and filtered values are repeated in every sample of the rings until its
+ * next conversion; BSP_ADC1_SetFilterBank() leaves them on their set. At
+ * most 4 channels, the injected ranks; not channel 0, the mains channel on
+ * an input ADC2 cannot reach; not with BSP_ADC1_DUAL_MODE. The simulation
+ * converts them at the same rate. Set by the CMake option
+ * JERRY_ADC_SLOW_CHANNELS.
+ */
+#ifndef BSP_ADC1_SLOW_CHANNELS
+#define BSP_ADC1_SLOW_CHANNELS 0U
+#endif
+
+/** @brief Number of bits set in the low 8 bits of @p mask */
+#define BSP_ADC1_COUNT_BITS(mask)                    \
+    ((((mask) >> 0U) & 1U) + (((mask) >> 1U) & 1U) + \
+     (((mask) >> 2U) & 1U) + (((mask) >> 3U) & 1U) + \
+     (((mask) >> 4U) & 1U) + (((mask) >> 5U) & 1U) + \
+     (((mask) >> 6U) & 1U) + (((mask) >> 7U) & 1U))
+
+/** @brief Number of channels in BSP_ADC1_SLOW_CHANNELS */
+#define BSP_ADC1_NUM_SLOW_CHANNELS BSP_ADC1_COUNT_BITS(BSP_ADC1_SLOW_CHANNELS)
+
+/** @brief Number of channels converted on every trigger */
+#define BSP_ADC1_NUM_FAST_CHANNELS \
+    (BSP_ADC1_NUM_CHANNELS - BSP_ADC1_NUM_SLOW_CHANNELS)
+
+/**
+ * @brief ADC1 channels filtered on every sample, bit n for channel n
+ *
+ * 0 filters every channel a block at a time in the filter task: the least
+ * CPU per sample, but a value is up to a block period (3.2 ms) old before
+ * anything sees it. A set bit makes a channel low-latency: the ADC1
+ * end-of-sequence interrupt runs it through the filter as soon as each
+ * frame is converted, with the frame kernel (adc_filter_process_frame(),
+ * one pass over the stages for all of these channels), and hands the
+ * calibrated value to the sample hook, BSP_ADC1_SetSampleHook(). The block
+ * pipeline then takes those filtered samples in place of the channel's
+ * block cascade, so the rings, the filtered values and the block hook
+ * carry it as before. The other channels stay on the block path.
+ *
+ * The interrupt costs about 1 us per frame for two channels, 1 % of the
+ * CPU at 10 kHz and 5 % at 50 kHz; keep the mask to the channels that
+ * need it. The low-latency channels filter with the bank of the first of
+ * them; a reset of one warm starts them all. Not a slow channel. The
+ * simulation filters them frame by frame before each block. Set by the
+ * CMake option JERRY_ADC_LOW_LATENCY_CHANNELS.
+ */
+#ifndef BSP_ADC1_LOW_LATENCY_CHANNELS
+#define BSP_ADC1_LOW_LATENCY_CHANNELS 0U
+#endif
+
+/** @brief Number of channels in BSP_ADC1_LOW_LATENCY_CHANNELS */
+#define BSP_ADC1_NUM_LOW_LATENCY_CHANNELS \
+    BSP_ADC1_COUNT_BITS(BSP_ADC1_LOW_LATENCY_CHANNELS)
+
+/**
+ * @brief Drive probe pins along the ADC1 sample path
+ *
+ * 1 drives the three user LED pins of the Nucleo board, also on the morpho
+ * connectors, for a logic analyser: PB0 (LD1) high while the DMA block
+ * callback runs, PF4 (LD2) while the filter task filters a block, PG4
+ * (LD3) while the block hook runs. The stage times of
+ * BSP_ADC1_GetLatency() are kept either way. Set by the CMake option
+ * JERRY_ADC_PROBE_PINS.
+ */
+#ifndef BSP_ADC1_PROBE_PINS
+#define BSP_ADC1_PROBE_PINS 0
+#endif
+
+/**
+ * @brief Phase-lock the ADC1 trigger to the PTP time
+ *
+ * 0 leaves TIM1 running from its start in BSP_Init(). 1 adds
+ * BSP_ADC1_SetTriggerSync(): while enabled, every DMA block moves the TIM1
+ * counter so that the triggers fall on whole trigger periods of the PTP
+ * timescale, and nodes following the same master sample at the same
+ * instants. Set by the CMake option JERRY_ADC_SYNC.
+ */
+#ifndef BSP_ADC1_SYNC
+#define BSP_ADC1_SYNC 0
+#endif
+
+/**
+ * @brief Number of samples per channel in one ADC1 DMA block
+ *
+ * The circular DMA buffer holds two blocks; the filter runs once per block
+ * on each half/full-transfer event. This is the block at the default
+ * sample rate, ADC_FILTER_SAMPLE_RATE; BSP_ADC1_SetSampleRate() resizes the
+ * block with the rate, see BSP_ADC1_BLOCK_SAMPLES_AT().
+ */
+#define BSP_ADC1_BLOCK_SAMPLES 32U
+
+/** @brief Period of an ADC1 DMA block kept at every sample rate (us) */
+#define BSP_ADC1_BLOCK_US 3200U
+
+/**
+ * @brief Samples a block is a multiple of: whole decimation periods, and
+ * whole cache lines of every DMA half
+ */
+#define BSP_ADC1_BLOCK_QUANTUM 16U
+
+/**
+ * @brief Samples per channel in one ADC1 DMA block at @p hz
+ *
+ * BSP_ADC1_BLOCK_US of samples, rounded up to BSP_ADC1_BLOCK_QUANTUM: the
+ * block period is 3.2 ms at every rate of at least 5 kHz, 16 ms at 1 kHz.
+ */
+#define BSP_ADC1_BLOCK_SAMPLES_AT(hz)                                     \
+    (((((hz) * BSP_ADC1_BLOCK_US) / 1000000UL) + BSP_ADC1_BLOCK_QUANTUM - \
+      1U) /                                                               \
+     BSP_ADC1_BLOCK_QUANTUM * BSP_ADC1_BLOCK_QUANTUM)
+
+/**
+ * @brief Largest ADC1 DMA block, the one of ADC_FILTER_MAX_SAMPLE_RATE
+ *
+ * The DMA buffer, the filter context and the pipeline buffers are sized
+ * with it.
+ */
+#define BSP_ADC1_MAX_BLOCK_SAMPLES 160U
+
+/**
+ * @brief ADC1 regular group hardware oversampling ratio, as a power of two
+ *
+ * 0 disables oversampling; n makes the ADC accumulate 2^n conversions of
+ * each channel per trigger, at no CPU cost. The whole sequence must still
+ * fit in one TIM1 trigger period (100 us at 10 kHz): a pass of the 6
+ * channels takes 6 x (24.5 + 12.5) cycles of the 16 MHz ADC clock =
+ * 13.9 us, so at most 2 (x4). In dual mode (BSP_ADC1_DUAL_MODE) a pass is
+ * 3 conversions, 6.9 us, which allows 3 (x8). The faster sample rates of
+ * BSP_ADC1_SetSampleRate() need a lower ratio, see
+ * BSP_ADC1_SEQUENCE_NS.
+ */
+#define BSP_ADC1_OVERSAMPLING_LOG2 2U
+
+/**
+ * @brief Right shift applied to the accumulated result
+ *
+ * 0 to BSP_ADC1_OVERSAMPLING_LOG2; every bit not shifted out widens the
+ * result by one bit.
+ */
+#define BSP_ADC1_OVERSAMPLING_SHIFT 0U
+
+/** @brief Result bits gained over a single 12-bit conversion */
+#define BSP_ADC1_RESULT_EXTRA_BITS \
+    (BSP_ADC1_OVERSAMPLING_LOG2 - BSP_ADC1_OVERSAMPLING_SHIFT)
+
+/** @brief Width of an ADC1 result, in bits */
+#define BSP_ADC1_RESULT_BITS (12U + BSP_ADC1_RESULT_EXTRA_BITS)
+
+/** @brief ADC1 result for a full-scale input */
+#define BSP_ADC1_FULL_SCALE (4095UL << BSP_ADC1_RESULT_EXTRA_BITS)
+
+/** @brief Conversions per pass of the regular sequence on each ADC */
+#if BSP_ADC1_DUAL_MODE
+#define BSP_ADC1_SEQUENCE_CONVERSIONS (BSP_ADC1_NUM_CHANNELS / 2U)
+#else
+#define BSP_ADC1_SEQUENCE_CONVERSIONS BSP_ADC1_NUM_FAST_CHANNELS
+#endif
+
+/**
+ * @brief Time the ADC takes for the oversampled regular sequence (ns)
+ *
+ * 37 cycles of the 16 MHz ADC clock per conversion, every pass of the
+ * oversampling ratio: 55.5 us at x4 (27.75 us in dual mode). A sample rate
+ * whose trigger period is shorter overruns the ADC and is refused by
+ * BSP_ADC1_SetSampleRate(). With x4 only 10 kHz and below fit; 25 kHz
+ * needs dual mode or x2, and 50 kHz x2 in dual mode or no oversampling.
+ */
+#define BSP_ADC1_SEQUENCE_NS                          \
+    (((BSP_ADC1_SEQUENCE_CONVERSIONS * 37UL * 1000UL) \
+      << BSP_ADC1_OVERSAMPLING_LOG2) /                \
+     16UL)
+
 /**
  * @brief Global configuration structure for BSP COM port initialization.
  *
@@ -145,7 +442,9 @@ typedef int bsp_error_t;
  * Stop Bits, Parity, etc.) used to initialize the COM port (UART) functionality
  * provided by the Board Support Package.
  */
+#if !BSP_POSIX
 extern COM_InitTypeDef BspCOMInit;
+#endif
 
 /**
  * @brief Initializes the Board Support Package (BSP).
@@ -169,7 +468,11 @@ bsp_error_t BSP_Init(void);
  *
  * This function starts the ADC1 in continuous conversion mode with DMA
  * transfer. The ADC will continuously convert all configured channels
- * and store results in an internal buffer via DMA.
+ * into a circular buffer of two BSP_ADC1_BLOCK_SAMPLES blocks; each
+ * half/full-transfer event hands one block to the filter task. With a
+ * single ADC the DMA (GPDMA1 channel 6, 2D addressing) writes the results
+ * of each channel into a plane of its own, which the q15 filters read in
+ * place.
  *
  * @note Call this function once after BSP_Init() to start ADC conversions.
  * @note The ADC runs in circular DMA mode, so conversions continue
@@ -202,18 +505,22 @@ bool BSP_ADC1_IsConversionComplete(void);
 /**
  * @brief Gets the ADC1 conversion results.
  *
- * This function returns a pointer to the internal buffer containing
- * the latest ADC conversion results for all channels.
+ * This function returns a pointer to the most recently completed frame of
+ * the DMA buffer, i.e. the last conversion of all channels in the latest
+ * block.
  *
  * @param[out] results Pointer to store the address of the results buffer.
  *                     The buffer contains BSP_ADC1_NUM_CHANNELS values.
- *                     Each value is a 12-bit right-aligned ADC reading.
+ *                     Each value is a right-aligned reading of
+ *                     BSP_ADC1_RESULT_BITS bits.
  *
  * @return bsp_error_t BSP_OK if results are valid, BSP_INVALID_ARG if
- *         results pointer is NULL, BSP_ERROR if ADC is not running.
+ *         results pointer is NULL, BSP_ERROR if ADC is not running or no
+ *         block has completed yet.
  *
- * @note The returned pointer points to the DMA buffer which is continuously
- *       updated. For consistent readings, either:
+ * @note The returned pointer points into the DMA buffer (in dual mode, to
+ *       a copy unpacked by the DMA interrupt), which is
+ *       overwritten one block period later. For consistent readings, either:
  *       - Use BSP_ADC1_GetResultsCopy() for a snapshot, or
  *       - Disable interrupts briefly while reading all values.
  */
@@ -233,6 +540,35 @@ bsp_error_t BSP_ADC1_GetResults(const uint32_t **results);
  */
 bsp_error_t BSP_ADC1_GetResultsCopy(uint32_t *buffer);
 
+/**
+ * @brief Task notification index used to end BSP_ADC1_SampleNow().
+ * Shared with ::BSP_FLASH_NOTIFY_INDEX, so the sampling task must not also
+ * write the flash or the SPI NOR.
+ */
+#define BSP_ADC1_NOTIFY_INDEX 3U
+
+/**
+ * @brief Converts one channel now, outside the regular sequence.
+ *
+ * The channel is converted once by the injected group of ADC1, started by
+ * software, and the calling task sleeps on ::BSP_ADC1_NOTIFY_INDEX until
+ * the end-of-conversion interrupt, a few microseconds. The result is raw,
+ * unfiltered, in the format of the regular results, oversampling
+ * included. The regular sequence and its DMA stream go on: a conversion
+ * of it under way when the injected one starts is converted again after
+ * it, so its frame ends up to one conversion time late. In dual mode
+ * ADC1 converts any of the channels, those of ADC2 included. One task at
+ * a time.
+ *
+ * @param channel Channel index (0 to BSP_ADC1_NUM_CHANNELS - 1).
+ * @param[out] value Receives the result.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for an unknown channel or a
+ *         NULL @p value, BSP_ERROR if ADC1 is not running, BSP_BUSY if
+ *         another task is sampling, BSP_TIMEOUT if the conversion did not
+ *         end.
+ */
+bsp_error_t BSP_ADC1_SampleNow(uint8_t channel, uint16_t *value);
+
 /**
  * @brief Check if an ADC error has occurred.
  *
@@ -251,7 +587,10 @@ uint32_t BSP_ADC1_GetLastError(void);
  * @brief Restart ADC1 after an error or stop.
  *
  * This function stops the ADC if running, clears error flags,
- * and restarts the ADC with DMA.
+ * and restarts the ADC with DMA. The DMA queue is rebuilt and the ADC
+ * calibrated again. Errors do not need it: the block filter task resumes
+ * the acquisition after an overrun or DMA error by itself, within
+ * microseconds, and uses this only if that fails.
  *
  * @return bsp_error_t BSP_OK if restart successful, BSP_ERROR otherwise.
  */
@@ -275,31 +614,38 @@ bool BSP_ADC1_CheckAndRestart(void);
  *
  * These functions provide filtered ADC readings using a 12-stage biquad
  * cascade filter (4th order Butterworth LPF + 10 notch filters for 50Hz
- * mains rejection). The filter runs continuously at 10kHz, processing
- * every ADC sample in the DMA ISR.
+ * mains rejection). The filter runs continuously at the ADC1 sample rate
+ * (10kHz by default, see BSP_ADC1_SetSampleRate()) in a high-priority
+ * task, processing one block per channel on each DMA half/full-transfer
+ * event.
  *
  * **Key characteristics:**
  * - **Instant response**: GetFilteredValue() returns immediately
  * - **Continuous operation**: Filter always running, values always current
  * - **~2-5ms signal delay**: Actual group delay through filter chain
- * - **~102ms initial settling**: One-time after power-on/reset
+ * - **No initial settling**: The filter starts in steady state on the first
+ *   sample, so values are valid after one block (3.2 ms)
  *
  * @{
  */
 
-/** Number of samples required for filter settling (95% settling) */
-#define BSP_ADC1_FILTER_SETTLING_SAMPLES 1024U
+/** Number of samples before the filtered values are valid: one block, the
+ * filter is warm started (adc_filter_warm_start()) */
+#define BSP_ADC1_FILTER_SETTLING_SAMPLES BSP_ADC1_BLOCK_SAMPLES
+
+/** Channel whose mains pickup is measured for notch tracking */
+#define BSP_ADC1_MAINS_CHANNEL BSP_ADC1_CHANNEL_A0
 
 /**
  * @brief Initialize the ADC filter subsystem.
  *
- * This function initializes the digital filter for all ADC channels.
- * After initialization, the filter runs continuously, processing every
- * ADC sample in the DMA ISR.
+ * This function initializes the digital filter for all ADC channels
+ * and starts the block filter task. After initialization, the filter runs
+ * continuously, processing every DMA block as it completes.
  *
  * @note This is automatically called by BSP_Init().
- * @note After calling this, wait ~102ms for filter to settle before
- *       reading values (use BSP_ADC1_IsFilterSettled() to check).
+ * @note The values are valid once the first block has been filtered
+ *       (use BSP_ADC1_IsFilterSettled() to check).
  */
 void BSP_ADC1_FilterInit(void);
 
@@ -311,14 +657,15 @@ void BSP_ADC1_FilterInit(void);
  * returns immediately with the latest filtered value.
  *
  * @param[in]  channel Channel index (0 to BSP_ADC1_NUM_CHANNELS-1).
- * @param[out] value   Pointer to store the filtered value (0.0 to 1.0
- * normalized).
+ * @param[out] value   Pointer to store the filtered value, calibrated (V by
+ *                     default, see BSP_ADC1_SetCalibration()).
  *
  * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG if parameters
  *         are invalid, BSP_ERROR if filter is not initialized.
  *
  * @note This function returns instantly (no blocking).
- * @note The returned value is normalized to 0.0-1.0 range (0 = 0V, 1.0 = VREF).
+ * @note With the default calibration the value is in volts (0 = 0 V,
+ *       BSP_ADC1_VREF_V = full scale).
  * @note Check BSP_ADC1_IsFilterSettled() to ensure filter has settled
  *       after power-on before trusting the values.
  */
@@ -341,12 +688,54 @@ bsp_error_t BSP_ADC1_GetFilteredValue(uint8_t channel, float32_t *value);
  */
 bsp_error_t BSP_ADC1_GetFilteredValuesAll(float32_t *values);
 
+/** @brief Block quality: a result within a quarter of a 12-bit count of a
+ * rail */
+#define BSP_ADC1_QUALITY_CLIPPED 0x01U
+
+/** @brief Block quality: every result of the block the same */
+#define BSP_ADC1_QUALITY_STUCK 0x02U
+
+/** @brief Block quality: noise above BSP_ADC1_QUALITY_NOISE_COUNTS */
+#define BSP_ADC1_QUALITY_NOISY 0x04U
+
+/**
+ * @brief Noise of a block above which it is BSP_ADC1_QUALITY_NOISY, in
+ * 12-bit counts RMS
+ *
+ * The noise is estimated from the differences between neighbouring
+ * results, so the slope of a fast signal counts too: a 50 Hz sine of
+ * 1600 counts adds about 25 counts at 10 kHz.
+ */
+#ifndef BSP_ADC1_QUALITY_NOISE_COUNTS
+#define BSP_ADC1_QUALITY_NOISE_COUNTS 64U
+#endif
+
+/**
+ * @brief Get the quality bits of the last block of every channel.
+ *
+ * The filter task checks each channel's block once, before filtering it,
+ * with CMSIS-DSP vector kernels: its lowest and highest result against the
+ * rails (BSP_ADC1_QUALITY_CLIPPED), its variance against zero
+ * (BSP_ADC1_QUALITY_STUCK) and its noise against
+ * BSP_ADC1_QUALITY_NOISE_COUNTS (BSP_ADC1_QUALITY_NOISY). The same bits
+ * go with every sample of the block in the rings (bsp_adc1_sample_t). A
+ * slow channel (BSP_ADC1_SLOW_CHANNELS) is only checked for clipping, on
+ * its conversions since the previous block.
+ *
+ * @param[out] quality Array of BSP_ADC1_NUM_CHANNELS entries receiving the
+ *                     BSP_ADC1_QUALITY_* bits, 0 for a good block.
+ *
+ * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG if @p quality
+ *         is NULL, BSP_ERROR if the filter is not initialized.
+ */
+bsp_error_t BSP_ADC1_GetQualityAll(uint8_t *quality);
+
 /**
  * @brief Check if filter has settled after initialization.
  *
- * After power-on or filter reset, the filter needs ~1024 samples (~102ms)
- * to settle. This function returns true once enough samples have been
- * processed for the filter output to be valid.
+ * Every channel's filter starts in steady state on its first sample, so
+ * the output is valid as soon as BSP_ADC1_FILTER_SETTLING_SAMPLES (one
+ * block) have been processed. This function returns true from then on.
  *
  * @return true if filter has settled and values are valid, false otherwise.
  */
@@ -362,80 +751,3093 @@ bool BSP_ADC1_IsFilterSettled(void);
  */
 uint32_t BSP_ADC1_GetFilterSampleCount(void);
 
-/** @} */ /* End of BSP_ADC1_Filtered group */
+/**
+ * @brief Get the number of ADC blocks lost to filter task overruns.
+ *
+ * A block is lost if the DMA starts refilling it before the filter task has
+ * processed it.
+ *
+ * @return Number of overrun blocks since initialization.
+ */
+uint32_t BSP_ADC1_GetFilterBlockOverruns(void);
 
 /**
- * @brief Initializes the I2C Digital Output (PCF8574/PCF8574A) subsystem.
+ * @brief Get the number of times ADC1 was resumed after an error.
  *
- * This function initializes the I2C expanders to a known state, typically all
- * outputs set to low.
+ * On an overrun or DMA error the block filter task stops the ADC and the
+ * DMA and starts both again on the queue still linked, keeping the
+ * calibration. The samples not converted meanwhile are a gap in the sample
+ * streams; see bsp_adc1_sample_t.
  *
- * @return bsp_error_t BSP_OK if initialization is successful, otherwise an
- * error code.
+ * @return Number of recoveries since initialization.
  */
-bsp_error_t BSP_I2CDO_init();
+uint32_t BSP_ADC1_GetRecoveryCount(void);
 
 /**
- * @brief Writes a 16-bit value to the I2C Digital Output expanders.
+ * @brief Get the number of samples lost to acquisition gaps.
  *
- * The lower 8 bits of the value are sent to PCF8574, and the upper 8 bits
- * are sent to PCF8574A. This function includes checks for device readiness.
+ * The sum of the gaps of all frames published, at the ADC sample rate.
  *
- * @param value A 16-bit mask of ::BSP_I2C_Digital_Output_Masks indicating the
- * desired state of the digital outputs.
- * @return bsp_error_t BSP_OK if the write is successful, otherwise an error
- * code.
+ * @return Samples never converted since initialization.
  */
-bsp_error_t BSP_I2CDO_Write(uint16_t value);
+uint32_t BSP_ADC1_GetMissedSamples(void);
 
 /**
- * @brief Reads the current 16-bit state of the I2C Digital Output expanders.
+ * @brief Get the capture time of the current filtered values.
  *
- * This function reads the state from both PCF8574 and PCF8574A and combines
- * them into a single 16-bit value. It includes checks for device readiness.
+ * The time of the newest sample behind BSP_ADC1_GetFilteredValue(); see
+ * BSP_ADC1_GetSampleTime(). Values and time are read separately, so they
+ * can be one block apart if a block is published in between.
  *
- * @param value Pointer to a uint16_t where the read value will be stored.
- * @return bsp_error_t BSP_OK if the read is successful, otherwise an error
- * code.
+ * @param[out] time Pointer to store the capture time, in
+ *                  BSP_ADC1_TIMESTAMP_HZ ticks.
+ *
+ * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG if @p time is
+ *         NULL, BSP_ERROR if the filter is not initialized or no block has
+ *         been filtered yet.
  */
-bsp_error_t BSP_I2CDO_Read(uint16_t *value);
+bsp_error_t BSP_ADC1_GetFilteredTimestamp(uint64_t *time);
 
 /**
- * @brief Read the state of a GPIO digital input channel
+ * @brief Restart the filter of one channel.
  *
- * Reads the current logic level of the specified GPIO digital input pin
- * and stores the result in the provided output parameter.
+ * Clears the channel's filter history, e.g. after a discontinuity in its
+ * input. The filter task restarts the cascade and the decimator at the
+ * channel's next block in steady state on the first sample of the block,
+ * so the values stay valid and show no settling transient.
  *
- * @param[in]  channel The digital input channel index to read.
- *                     @see BSP_GPIODI_INDEX for valid channel values
- *                     (BSP_GPIODI_INDEX_0 through BSP_GPIODI_INDEX_7)
- * @param[out] pVal    Pointer to store the pin state (GPIO_PIN_SET or
- * GPIO_PIN_RESET)
+ * @param[in] channel Channel index (0 to BSP_ADC1_NUM_CHANNELS-1).
  *
- * @return bsp_error_t
- * @retval BSP_OK    Read operation successful
- * @retval BSP_ERROR Invalid channel or NULL pointer
+ * @return bsp_error_t BSP_OK if the restart was requested, BSP_INVALID_ARG
+ *         if @p channel is out of range, BSP_ERROR if the filter is not
+ *         initialized.
  */
-bsp_error_t BSP_GPIODI_Read(uint32_t channel, uint32_t *pVal);
+bsp_error_t BSP_ADC1_ResetFilter(uint8_t channel);
 
 /**
- * @brief Read the device address from DEVADDR0-3 GPIO pins
+ * @brief Select the filter coefficient bank of one channel.
  *
- * Reads the 4-bit device address from the DEVADDR GPIO pins.
- * The pins are active-low with internal pull-ups, so a grounded pin
- * reads as 1 in the returned value.
+ * Banks are precomputed in flash by config/adc_filter_design.py (50/60 Hz
+ * mains notch sets, several LPF cutoffs; see ADC_FILTER_NUM_BANKS). The
+ * switch is applied by the filter task at its next block boundary, so no
+ * block is filtered with mixed coefficients and acquisition is not
+ * interrupted.
  *
- * The address is composed as:
- * - Bit 0: DEVADDR0 (PG14)
- * - Bit 1: DEVADDR1 (PE11)
- * - Bit 2: DEVADDR2 (PE13)
- * - Bit 3: DEVADDR3 (PE14)
+ * @param[in] channel Channel index (0 to BSP_ADC1_NUM_CHANNELS-1).
+ * @param[in] bank    Bank index (0 to ADC_FILTER_NUM_BANKS-1).
  *
- * @return uint8_t Device address value (0-15)
+ * @return bsp_error_t BSP_OK if the switch was requested, BSP_INVALID_ARG
+ *         if @p channel or @p bank is out of range, BSP_ERROR if the filter
+ *         is not initialized.
+ */
+bsp_error_t BSP_ADC1_SetFilterBank(uint8_t channel, uint8_t bank);
+
+/**
+ * @brief Get the filter coefficient bank selected for one channel.
  *
- * @note The pins have internal pull-ups, so open pins read as 0 (high = 0).
- *       Grounding a pin sets the corresponding bit to 1.
+ * @param[in]  channel Channel index (0 to BSP_ADC1_NUM_CHANNELS-1).
+ * @param[out] bank    Pointer to store the bank index.
+ *
+ * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG if parameters
+ *         are invalid, BSP_ERROR if filter is not initialized.
  */
-uint8_t BSP_GetDeviceAddress(void);
+bsp_error_t BSP_ADC1_GetFilterBank(uint8_t channel, uint8_t *bank);
+
+/**
+ * @brief Change the ADC1 sample rate.
+ *
+ * @p hz must be one of the rates the coefficient sets were generated for
+ * (ADC_FILTER_FOR_EACH_RATE, config/adc_filter_design.py), each with its
+ * own copy of every bank, so the LPF cutoffs and mains notches stay where
+ * they are in Hz. The filter task applies the change between two blocks:
+ * it stops the DMA, moves TIM1 to the new trigger period, resizes the DMA
+ * block to BSP_ADC1_BLOCK_SAMPLES_AT(@p hz), switches the filter context
+ * to the set of the rate, keeping each channel's bank, and restarts the
+ * acquisition with the filters warm started on the first samples.
+ *
+ * The capture timer keeps running, so sample times stay on one timescale.
+ * The samples not taken during the switch are a gap in the sample streams,
+ * whose sequence numbers count samples at the rate in force. Mains tracking
+ * restarts at the nominal frequency of its base bank.
+ *
+ * @param[in] hz Sample rate (Hz).
+ *
+ * @return bsp_error_t BSP_OK if the change was requested, BSP_INVALID_ARG
+ *         if there is no coefficient set for @p hz or its trigger period
+ *         is shorter than BSP_ADC1_SEQUENCE_NS, BSP_ERROR if the filter is
+ *         not initialized or the SPI ADC shares TIM1's trigger grid
+ *         (BSP_SPIADC_ENABLE).
+ */
+bsp_error_t BSP_ADC1_SetSampleRate(uint32_t hz);
+
+/**
+ * @brief Get the ADC1 sample rate in force.
+ *
+ * The rate of the samples published last; a change requested with
+ * BSP_ADC1_SetSampleRate() shows once it has been applied.
+ *
+ * @return Sample rate (Hz).
+ */
+uint32_t BSP_ADC1_GetSampleRate(void);
+
+/**
+ * @brief Get the samples per channel of an ADC1 DMA block at the rate in
+ * force, BSP_ADC1_BLOCK_SAMPLES_AT(BSP_ADC1_GetSampleRate()).
+ *
+ * @return Samples per block, at most BSP_ADC1_MAX_BLOCK_SAMPLES.
+ */
+uint32_t BSP_ADC1_GetBlockSamples(void);
+
+/** Reference voltage, V: the default gain, so filtered values are in volts */
+#define BSP_ADC1_VREF_V 3.3f
+
+/** Most points of a linearization table */
+#define BSP_ADC1_LINEARIZATION_MAX_POINTS 17U
+
+/**
+ * @brief Set the gain and offset calibration of one channel.
+ *
+ * The filter task takes the filtered block of each channel from the
+ * normalized 0.0-1.0 full-scale range to engineering units once per block,
+ * with arm_scale_f32() and arm_offset_f32(): value = normalized * gain +
+ * offset. Everything downstream (filtered values, both sample rings, the
+ * block hook) sees calibrated values. The default is gain BSP_ADC1_VREF_V,
+ * offset 0, i.e. volts. Applied at the filter task's next block boundary.
+ *
+ * @param[in] channel Channel index (0 to BSP_ADC1_NUM_CHANNELS-1).
+ * @param[in] gain    Units per full scale, finite and non-zero.
+ * @param[in] offset  Units at a reading of 0, finite.
+ *
+ * @return bsp_error_t BSP_OK if the change was requested, BSP_INVALID_ARG
+ *         if a parameter is out of range.
+ */
+bsp_error_t BSP_ADC1_SetCalibration(uint8_t channel, float32_t gain,
+                                    float32_t offset);
+
+/**
+ * @brief Get the gain and offset calibration of one channel.
+ *
+ * @param[in]  channel Channel index (0 to BSP_ADC1_NUM_CHANNELS-1).
+ * @param[out] gain    Pointer to store the gain.
+ * @param[out] offset  Pointer to store the offset.
+ *
+ * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG if parameters
+ *         are invalid.
+ */
+bsp_error_t BSP_ADC1_GetCalibration(uint8_t channel, float32_t *gain,
+                                    float32_t *offset);
+
+/**
+ * @brief Set the linearization table of one channel.
+ *
+ * For a sensor that is not linear, the normalized reading is first mapped
+ * through the table with arm_linear_interp_f32(): @p count points spread
+ * evenly over 0.0-1.0, each the corrected normalized reading at that
+ * point, with straight lines in between. Gain and offset are applied
+ * after. Applied at the filter task's next block boundary.
+ *
+ * @param[in] channel Channel index (0 to BSP_ADC1_NUM_CHANNELS-1).
+ * @param[in] table   Corrected readings (copied), or NULL to remove the
+ *                    table.
+ * @param[in] count   Points in @p table, 2 to
+ *                    BSP_ADC1_LINEARIZATION_MAX_POINTS (ignored for NULL).
+ *
+ * @return bsp_error_t BSP_OK if the change was requested, BSP_INVALID_ARG
+ *         if a parameter is out of range.
+ */
+bsp_error_t BSP_ADC1_SetLinearization(uint8_t channel, const float32_t *table,
+                                      uint32_t count);
+
+/**
+ * @brief ADC1 channels with a conversion table, bit n for channel n.
+ *
+ * For each of them the filter task keeps a table of BSP_ADC1_LUT_SIZE
+ * entries, one per 12-bit code, each the code taken through the channel's
+ * calibration (linearization, gain, offset) exactly as the filtered values
+ * are. Code that works on raw results, the rings' raw samples or
+ * BSP_ADC1_SampleNow(), then gets engineering units with one load instead
+ * of the interpolation and float arithmetic. 16 KB each, in the CPU bank
+ * (bsp_sections.h). Set by the CMake option JERRY_ADC_LUT_CHANNELS.
+ */
+#ifndef BSP_ADC1_LUT_CHANNELS
+#define BSP_ADC1_LUT_CHANNELS 0U
+#endif
+
+/** Entries of a conversion table, one per 12-bit code */
+#define BSP_ADC1_LUT_SIZE 4096U
+
+/** @brief Entry of a conversion table for the raw result @p raw */
+#define BSP_ADC1_LUT_INDEX(raw) \
+    ((uint32_t)(raw) >> BSP_ADC1_RESULT_EXTRA_BITS)
+
+/**
+ * @brief Get the conversion table of one channel.
+ *
+ * The table follows the channel's calibration: a change is built into it
+ * by the filter task when it applies the change, at the channel's next
+ * block. Meanwhile each entry reads either the old or the new value.
+ *
+ * @param[in] channel Channel index (0 to BSP_ADC1_NUM_CHANNELS-1).
+ *
+ * @return BSP_ADC1_LUT_SIZE values in the calibration's units, indexed by
+ *         BSP_ADC1_LUT_INDEX(), or NULL if the channel is not in
+ *         BSP_ADC1_LUT_CHANNELS or the filter is not initialized.
+ */
+const float32_t *BSP_ADC1_GetConversionTable(uint8_t channel);
+
+/**
+ * @brief Enable or disable mains frequency tracking.
+ *
+ * While enabled, the filter task measures the mains frequency on
+ * BSP_ADC1_MAINS_CHANNEL (one estimate per 200 ms) and moves the notch
+ * stages of every channel onto it, keeping the LPF stages of @p base_bank.
+ * This keeps the notches centred when the grid drifts off its nominal
+ * 50/60 Hz. When disabled, every channel returns to @p base_bank.
+ *
+ * The nominal frequency comes from @p base_bank. Calls made while tracking
+ * is enabled only change the base bank.
+ *
+ * @param[in] enable    true to track, false to use the fixed bank.
+ * @param[in] base_bank Bank index (0 to ADC_FILTER_NUM_BANKS-1).
+ *
+ * @return bsp_error_t BSP_OK if the change was requested, BSP_INVALID_ARG
+ *         if @p base_bank is out of range, BSP_ERROR if the filter is not
+ *         initialized.
+ */
+bsp_error_t BSP_ADC1_SetMainsTracking(bool enable, uint8_t base_bank);
+
+/**
+ * @brief Get the mains frequency the notch stages are tuned to.
+ *
+ * @param[out] frequency Pointer to store the frequency in Hz, or 0.0 if
+ *                       tracking is disabled.
+ *
+ * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG if @p frequency
+ *         is NULL, BSP_ERROR if the filter is not initialized.
+ */
+bsp_error_t BSP_ADC1_GetMainsFrequency(float32_t *frequency);
+
+/**
+ * @brief Function run by the filter task after each filtered block.
+ *
+ * @param[in] values Last filtered value of every channel in the block, in
+ *                   the units of BSP_ADC1_GetFilteredValuesAll().
+ */
+typedef void (*bsp_adc1_block_hook_t)(const float32_t *values);
+
+/**
+ * @brief Install the function the filter task runs after each block.
+ *
+ * The hook is called once per block (BSP_ADC1_GetBlockSamples() samples,
+ * 3.2 ms at any rate of at least 5 kHz), after the block is published to
+ * the filtered values and the sample rings, at the filter task's priority.
+ * It must not block and must return well within a block period.
+ *
+ * @param[in] hook Function to run, or NULL for none.
+ */
+void BSP_ADC1_SetBlockHook(bsp_adc1_block_hook_t hook);
+
+/**
+ * @brief Function run by the ADC1 interrupt on every frame.
+ *
+ * @param[in] values Filtered value of every channel, in the units of
+ *                   BSP_ADC1_GetFilteredValuesAll(); only those of
+ *                   BSP_ADC1_LOW_LATENCY_CHANNELS are set, the others are
+ *                   0.
+ * @return true to wake the filter task to run the alarm hook.
+ */
+typedef bool (*bsp_adc1_sample_hook_t)(const float32_t *values);
+
+/**
+ * @brief Function run by the filter task after a sample hook returned true.
+ */
+typedef void (*bsp_adc1_sample_alarm_hook_t)(void);
+
+/**
+ * @brief Install the functions run on every frame of the low-latency
+ * channels.
+ *
+ * @p hook runs in the ADC1 interrupt, within a trigger period of the
+ * conversion, once the low-latency channels of the frame are filtered
+ * (BSP_ADC1_LOW_LATENCY_CHANNELS): it must only compare and count, a few
+ * hundred cycles at most, and may only call the FromISR kernel functions.
+ * Returning true wakes the filter task at once, without waiting for the
+ * end of the block, to run @p alarm with the constraints of the block
+ * hook. Neither runs without low-latency channels.
+ *
+ * @param[in] hook  Function run on every frame, or NULL for none.
+ * @param[in] alarm Function run when @p hook asks for it, or NULL.
+ */
+void BSP_ADC1_SetSampleHook(bsp_adc1_sample_hook_t       hook,
+                            bsp_adc1_sample_alarm_hook_t alarm);
+
+/** @brief Analog watchdogs of the acquisition (AWD1 to AWD3) */
+#define BSP_ADC1_AWD_COUNT 3U
+
+/**
+ * @brief Window of an analog watchdog.
+ *
+ * The bounds are raw results, as in bsp_adc1_sample_t::raw, and are inside
+ * the window. The hardware compares fewer bits: AWD1 the 12 most
+ * significant of the 16-bit oversampled result, AWD2 and AWD3 only 8, so
+ * the bounds are rounded outward, to 16 results for AWD1 and 256 for the
+ * others (exact and 16 without oversampling). A window of the whole
+ * range, 0 to BSP_ADC1_FULL_SCALE, never alarms.
+ */
+typedef struct
+{
+    uint8_t  channel; /**< Channel watched (0 to BSP_ADC1_NUM_CHANNELS-1) */
+    uint16_t low;     /**< Lowest result inside the window */
+    uint16_t high;    /**< Highest result inside the window */
+} bsp_adc1_awd_config_t;
+
+/**
+ * @brief Alarms of the analog watchdogs.
+ */
+typedef struct
+{
+    uint32_t active; /**< Alarms active, bit n for AWD n+1 */
+    uint32_t raised; /**< Alarms raised since BSP_ADC1_FilterInit() */
+} bsp_adc1_awd_status_t;
+
+/**
+ * @brief Function run by the filter task when the watchdog alarms change.
+ *
+ * @param[in] raised Alarms just raised, bit n for AWD n+1; 0 when alarms
+ *                   only cleared.
+ * @param[in] active Alarms now active, @p raised included.
+ */
+typedef void (*bsp_adc1_awd_hook_t)(uint32_t raised, uint32_t active);
+
+/**
+ * @brief Sets the window of an analog watchdog.
+ *
+ * The ADC compares every conversion of the channel with the window, with
+ * no CPU time per sample. The first conversion outside raises the
+ * watchdog's alarm, in its interrupt, which wakes the filter task at once
+ * to run the watchdog hook; the interrupt is then off until the end of the
+ * next block, when it is armed again, so it fires at most once a block.
+ * The alarm clears after a block with no conversion outside.
+ *
+ * New bounds apply from the next conversion. The channels can only be
+ * chosen while ADC1 is stopped: changing one while it runs makes the
+ * filter task stop the conversions, set the channel and start them again,
+ * a gap of a few samples as after an overrun. In dual mode a channel of
+ * ADC2 is watched by its watchdog of the same number.
+ *
+ * @param[in] awd    Watchdog (0 to BSP_ADC1_AWD_COUNT-1, for AWD1 to AWD3).
+ * @param[in] config Channel and window.
+ *
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if @p awd or the channel
+ *         is out of range, @p config is NULL or its bounds are reversed.
+ */
+bsp_error_t BSP_ADC1_SetWatchdog(uint8_t                      awd,
+                                 const bsp_adc1_awd_config_t *config);
+
+/**
+ * @brief Gets the alarms of the analog watchdogs.
+ *
+ * @param[out] status Alarms active and raised.
+ *
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if @p status is NULL.
+ */
+bsp_error_t BSP_ADC1_GetWatchdogStatus(bsp_adc1_awd_status_t *status);
+
+/**
+ * @brief Install the function the filter task runs on watchdog alarms.
+ *
+ * Called at the filter task's priority as soon as an alarm is raised,
+ * without waiting for the end of the block, and at the end of the block
+ * an alarm clears in, with the same constraints as the block hook.
+ *
+ * @param[in] hook Function to run, or NULL for none.
+ */
+void BSP_ADC1_SetWatchdogHook(bsp_adc1_awd_hook_t hook);
+
+/**
+ * @brief Stages of the ADC1 sample path, timed on every block.
+ *
+ * A block is timed from the trigger of its last frame, the newest sample
+ * of the block, to the end of the block hook. The trigger instant is taken
+ * from the capture timer, to one tick (100 ns); the other stages are
+ * measured on the DWT cycle counter.
+ */
+typedef enum
+{
+    BSP_ADC1_LATENCY_CONVERSION = 0, /**< Trigger to DMA interrupt entry:
+                                          conversion, DMA and interrupt
+                                          latency */
+    BSP_ADC1_LATENCY_CALLBACK,       /**< Interrupt entry to the HAL block
+                                          callback */
+    BSP_ADC1_LATENCY_WAKE,           /**< Callback to the filter task
+                                          starting the block */
+    BSP_ADC1_LATENCY_FILTER,         /**< Filtering, until the block is in
+                                          the filtered values and rings */
+    BSP_ADC1_LATENCY_HOOK,           /**< Block hook */
+    BSP_ADC1_LATENCY_TOTAL,          /**< Trigger to the end of the hook */
+    BSP_ADC1_LATENCY_COUNT           /**< Number of stages */
+} bsp_adc1_latency_stage_t;
+
+/** Number of histogram buckets of a stage */
+#define BSP_ADC1_LATENCY_BUCKETS 16U
+
+/**
+ * Bucket 0 counts stage times under 2^shift cycles (about 1 us at
+ * 250 MHz), bucket n those from 2^(shift + n - 1) up to 2^(shift + n), and
+ * the last bucket every longer time.
+ */
+#define BSP_ADC1_LATENCY_MIN_SHIFT 8U
+
+/**
+ * @brief Time statistics of one stage since BSP_ADC1_FilterInit().
+ */
+typedef struct
+{
+    uint32_t count;      /**< Blocks timed */
+    uint32_t min_cycles; /**< Shortest time, 0 before the first block */
+    uint32_t max_cycles; /**< Longest time */
+    uint64_t sum_cycles; /**< Sum of the times, for the mean */
+    uint32_t buckets[BSP_ADC1_LATENCY_BUCKETS]; /**< Blocks per time */
+} bsp_adc1_latency_t;
+
+/**
+ * @brief Read the time statistics of a stage of the sample path.
+ *
+ * The statistics are written by the filter task and copied consistently.
+ *
+ * @param[in]  stage   Stage.
+ * @param[out] latency Receives the statistics.
+ *
+ * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG for an unknown
+ *         stage or a NULL @p latency.
+ */
+bsp_error_t BSP_ADC1_GetLatency(bsp_adc1_latency_stage_t stage,
+                                bsp_adc1_latency_t      *latency);
+
+/**
+ * @brief Processing stages of an ADC1 block, in the order they run.
+ *
+ * The filter task takes each channel of a DMA block through all stages
+ * (dsp_pipeline.h) before the next channel; together they make up
+ * BSP_ADC1_LATENCY_FILTER.
+ */
+typedef enum
+{
+    BSP_ADC1_STAGE_CONVERT = 0,       /**< Results to filter samples */
+    BSP_ADC1_STAGE_QUALITY,           /**< Clipping, stuck and noise checks */
+    BSP_ADC1_STAGE_MAINS,             /**< Mains frequency tracking */
+    BSP_ADC1_STAGE_FILTER,            /**< Biquad cascade */
+    BSP_ADC1_STAGE_CALIBRATE,         /**< To float, calibration */
+    BSP_ADC1_STAGE_PUBLISH,           /**< Full-rate ring */
+    BSP_ADC1_STAGE_DECIMATE,          /**< FIR decimator */
+    BSP_ADC1_STAGE_PUBLISH_DECIMATED, /**< Decimated ring */
+    BSP_ADC1_STAGE_COUNT              /**< Number of stages */
+} bsp_adc1_stage_t;
+
+/**
+ * @brief Time statistics of one processing stage since
+ *        BSP_ADC1_FilterInit(), per block of all channels.
+ */
+typedef struct
+{
+    uint32_t count;       /**< Blocks timed */
+    uint32_t last_cycles; /**< Time of the last block */
+    uint32_t min_cycles;  /**< Shortest time, 0 before the first block */
+    uint32_t max_cycles;  /**< Longest time */
+    uint64_t sum_cycles;  /**< Sum of the times, for the mean */
+} bsp_adc1_stage_cycles_t;
+
+/**
+ * @brief Read the time statistics of a processing stage.
+ *
+ * @param[in]  stage  Stage.
+ * @param[out] cycles Receives the statistics, copied consistently.
+ *
+ * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG for an unknown
+ *         stage or a NULL @p cycles.
+ */
+bsp_error_t BSP_ADC1_GetStageCycles(bsp_adc1_stage_t         stage,
+                                    bsp_adc1_stage_cycles_t *cycles);
+
+/** @} */ /* End of BSP_ADC1_Filtered group */
+
+/**
+ * @defgroup BSP_ADC1_Ring ADC1 Sample History
+ * @brief Lock-free history of raw and filtered ADC1 samples
+ *
+ * The filter task publishes every filtered frame into a statically sized
+ * ring, one block at a time. Any number of tasks can drain it, each through
+ * its own bsp_adc1_reader_t cursor, without a mutex and without affecting
+ * other readers. A reader that falls more than BSP_ADC1_RING_SIZE samples
+ * behind loses the oldest samples; these are counted in its overrun
+ * counter.
+ *
+ * A second, decimated stream keeps one frame per
+ * ADC_FILTER_DECIMATION_FACTOR samples, taken from the FIR decimator that
+ * follows the biquad cascade. Consumers that only need the filtered signal
+ * bandwidth should read this stream to handle fewer samples.
+ *
+ * Each DMA block is stamped once with the capture time of its first
+ * sample, from a 32-bit timer that TIM1 starts together with itself; the
+ * time of any sample follows from its sequence number with
+ * BSP_ADC1_GetSampleTime(). Samples on the same node are exact to the
+ * timer tick, and readings from several nodes correlate to the accuracy
+ * of their common start.
+ *
+ * @{
+ */
+
+/** Tick rate of sample timestamps (Hz): TIM1's 250 MHz / 25 counter clock */
+#define BSP_ADC1_TIMESTAMP_HZ 10000000UL
+
+/** Number of frames kept in the sample ring (power of two): 51 ms at
+ * 10 kHz */
+#define BSP_ADC1_RING_SIZE 512U
+
+/** Number of frames kept in the decimated ring (power of two) */
+#define BSP_ADC1_DECIMATED_RING_SIZE 64U
+
+/**
+ * @brief Sample stream a reader is attached to.
+ */
+typedef enum
+{
+    BSP_ADC1_STREAM_FULL = 0,  /**< Every sample, at the ADC sample rate */
+    BSP_ADC1_STREAM_DECIMATED, /**< Decimated by ADC_FILTER_DECIMATION_FACTOR */
+    BSP_ADC1_STREAM_COUNT      /**< Number of streams */
+} bsp_adc1_stream_t;
+
+/**
+ * @brief One frame of ADC1 samples.
+ *
+ * The capture time of a frame follows from its sequence number; see
+ * BSP_ADC1_GetSampleTime(). When the ADC is resumed after an error, the
+ * samples it did not convert are skipped in the sequence, and the first
+ * frame after them in each stream has @c gap set to their number, so the
+ * missing samples are exactly sequence - gap to sequence - 1 (counted at
+ * the full rate on both streams). Every frame of a block carries the
+ * block's quality bits (BSP_ADC1_GetQualityAll()).
+ *
+ * The digital inputs selected for edge capture (BSP_GPIODI_CaptureSelect())
+ * share the timeline: their edges are timed on the capture timer, the
+ * clock of the samples, and each lands in the first frame captured at or
+ * after it. @c di holds the levels of those inputs as of the frame and
+ * @c di_edges the inputs with an edge since the previous frame of the
+ * stream; a decimated frame gathers the edges of its whole period.
+ * Inputs not captured read 0 in both.
+ */
+typedef struct
+{
+    uint32_t  sequence; /**< Sample index since start (sample-period clock) */
+    uint32_t  gap;      /**< Samples never converted before this one */
+    uint16_t  raw[BSP_ADC1_NUM_CHANNELS];      /**< Right-aligned ADC results */
+    uint8_t   quality[BSP_ADC1_NUM_CHANNELS];  /**< BSP_ADC1_QUALITY_* bits */
+    uint8_t   di;       /**< Captured input levels, bit n = DIn */
+    uint8_t   di_edges; /**< Captured inputs with an edge, bit n = DIn */
+    float32_t filtered[BSP_ADC1_NUM_CHANNELS]; /**< Calibrated filter outputs */
+} bsp_adc1_sample_t;
+
+/**
+ * @brief Per-reader cursor into the sample ring.
+ */
+typedef struct
+{
+    uint32_t          cursor;   /**< Stream index of the next sample */
+    uint32_t          overruns; /**< Samples lost to falling behind */
+    bsp_adc1_stream_t stream;   /**< Stream this reader drains */
+} bsp_adc1_reader_t;
+
+/**
+ * @brief Attach a reader to one of the sample streams.
+ *
+ * The reader starts at the newest sample, so only samples published after
+ * this call are returned.
+ *
+ * @param[out] reader Reader cursor to initialize.
+ * @param[in]  stream Stream to read (full rate or decimated).
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if @p reader is NULL or
+ *         @p stream is out of range.
+ */
+bsp_error_t BSP_ADC1_RingReaderInit(bsp_adc1_reader_t *reader,
+                                    bsp_adc1_stream_t  stream);
+
+/**
+ * @brief Get the number of samples a reader can drain.
+ *
+ * @param[in] reader Reader cursor.
+ * @return Number of unread samples, capped at the stream's ring size.
+ */
+uint32_t BSP_ADC1_RingAvailable(const bsp_adc1_reader_t *reader);
+
+/**
+ * @brief Bulk-read samples from the ring and advance the reader cursor.
+ *
+ * Samples are returned oldest first with strictly increasing sequence
+ * numbers. On the full-rate stream, gaps in the sequence are samples lost
+ * to overruns; on the decimated stream consecutive entries are
+ * ADC_FILTER_DECIMATION_FACTOR apart and larger gaps are overruns. Either
+ * stream also skips the samples of an acquisition gap, which the sample
+ * after it reports in its @c gap field; the reader's overrun count does
+ * not include them.
+ *
+ * @param[in,out] reader    Reader cursor.
+ * @param[out]    samples   Destination for at most @p max_count samples.
+ * @param[in]     max_count Capacity of @p samples.
+ * @param[out]    count     Number of samples stored in @p samples.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if a pointer is NULL.
+ */
+bsp_error_t BSP_ADC1_RingRead(bsp_adc1_reader_t *reader,
+                              bsp_adc1_sample_t *samples, uint32_t max_count,
+                              uint32_t *count);
+
+/**
+ * @brief Get the capture time of a sample.
+ *
+ * The time is the ADC trigger of the sample: the block timestamp plus the
+ * sample's offset in the block times the trigger period. It counts
+ * BSP_ADC1_TIMESTAMP_HZ ticks since TIM1 was started in BSP_Init(), and
+ * does not wrap in practice.
+ *
+ * @param[in]  sequence Sample sequence number, from either stream.
+ * @param[out] time     Pointer to store the capture time.
+ *
+ * @return bsp_error_t BSP_OK if successful, BSP_INVALID_ARG if @p time is
+ *         NULL, BSP_ERROR if the sample's block is not (or no longer) in
+ *         the timestamp history, or the sequence falls in a gap. The
+ *         history covers both rings.
+ */
+bsp_error_t BSP_ADC1_GetSampleTime(uint32_t sequence, uint64_t *time);
+
+/**
+ * @brief Get the capture time of a sample on the PTP timescale.
+ *
+ * Each block is also stamped with BSP_Time_NowNs(), read in the DMA
+ * interrupt and moved back to the block's first trigger; the sample
+ * follows at the trigger period. Nodes following the same PTP master
+ * agree on this time to the accuracy of their servos, with no trigger
+ * wiring between them.
+ *
+ * @param[in]  sequence Sample sequence number, from either stream.
+ * @param[out] time_ns  Pointer to store the capture time, in ns.
+ *
+ * @return bsp_error_t As BSP_ADC1_GetSampleTime(). The time is on the PTP
+ *         timescale only while ptp_is_locked() (ptp.h) holds.
+ */
+bsp_error_t BSP_ADC1_GetSampleTimeNs(uint32_t sequence, uint64_t *time_ns);
+
+#if BSP_ADC1_SYNC
+/** Largest correction of the trigger phase per DMA block, in
+ *  BSP_ADC1_TIMESTAMP_HZ ticks */
+#define BSP_ADC1_SYNC_MAX_STEP 50U
+
+/** Phase error within which the triggers count as on the PTP grid, in
+ *  BSP_ADC1_TIMESTAMP_HZ ticks */
+#define BSP_ADC1_SYNC_ALIGNED_TICKS 2U
+
+/**
+ * @brief Lock the ADC1 trigger to the PTP time, or let it run free.
+ *
+ * While enabled, the DMA interrupt of every block compares the PTP time of
+ * the block's last trigger (as for BSP_ADC1_GetSampleTimeNs()) with the
+ * nearest whole trigger period of the PTP timescale, and moves the TIM1
+ * counter by the difference, at most ::BSP_ADC1_SYNC_MAX_STEP ticks, so
+ * the next block's triggers fall on the grid. TIM1 runs from the local
+ * oscillator, so corrections of a tick or two go on at the rate error of
+ * the servo; a first alignment or a PTP step takes up to ten blocks. The
+ * capture timer is not touched: the sample times of each block stay
+ * exact, on the moved grid.
+ *
+ * Disabled, the trigger keeps the phase it has. To be enabled once the
+ * PTP servo follows a master (ptp.h).
+ *
+ * @param[in] enable true to follow the PTP time.
+ */
+void BSP_ADC1_SetTriggerSync(bool enable);
+
+/**
+ * @brief Whether the ADC1 triggers fall on the PTP grid.
+ *
+ * @return true while BSP_ADC1_SetTriggerSync() is enabled and the last
+ *         phase error was within ::BSP_ADC1_SYNC_ALIGNED_TICKS. Samples of
+ *         all aligned nodes of one master are then captured at the same
+ *         PTP times, whole multiples of the trigger period.
+ */
+bool BSP_ADC1_IsTriggerSynced(void);
+#endif /* BSP_ADC1_SYNC */
+
+/** @} */ /* End of BSP_ADC1_Ring group */
+
+/**
+ * @brief Drive an external simultaneous-sampling ADC on SPI1
+ *
+ * 0 leaves SPI1, TIM8 and their pins and DMA channels alone. 1 adds the
+ * BSP_SPIADC group below, started by BSP_Init(). Set by the CMake option
+ * JERRY_SPI_ADC.
+ */
+#ifndef BSP_SPIADC_ENABLE
+#define BSP_SPIADC_ENABLE 0
+#endif
+
+#if BSP_SPIADC_ENABLE && BSP_ADC1_SYNC
+#error "TIM8 keeps the SPI ADC frames on the start grid; build BSP_ADC1_SYNC without it"
+#endif
+
+#if BSP_SPIADC_ENABLE
+/**
+ * @defgroup BSP_SPIADC External SPI ADC
+ * @brief Simultaneous-sampling ADC on SPI1, read by timer-triggered DMA
+ *
+ * For a converter that samples all its channels on a CONVST edge and is
+ * read back as one SPI word per channel under its chip select, such as
+ * the AD7606 (8 channels, 16 bits, serial read on DOUTA).
+ *
+ * TIM8 counts on the ADC1 timestamp grid, started by TIM1 in the same
+ * cycle as the capture timer. Each period, channel 2 pulses CONVST on PC7
+ * and channel 3, BSP_SPIADC_CONVERT_NS later, requests GPDMA1 channel 5,
+ * which restarts SPI1 for one frame of BSP_SPIADC_NUM_CHANNELS words.
+ * SPI1 is a receive-only master with its own chip select (SCK PA5, MISO
+ * PG9, NSS PG10), and GPDMA1 channel 4 moves the words into a circular
+ * buffer of two blocks. No code runs per frame; the half-transfer and
+ * transfer-complete interrupts hand a block to a task that publishes it.
+ *
+ * The published frames behave as those of BSP_ADC1_Ring: a lock-free ring
+ * with per-reader cursors and overrun counts, sequence numbers with gaps
+ * where frames were not read, and a capture time per frame on the
+ * BSP_ADC1_TIMESTAMP_HZ tick and on the PTP timescale, so readings of both
+ * converters correlate exactly. The frames carry raw results only; the
+ * ADC1 filter chain is built for its 6 channels at 10 kHz.
+ * @{
+ */
+
+/** Number of channels in a frame */
+#define BSP_SPIADC_NUM_CHANNELS 8U
+
+/** Width of a result and of the SPI word, 9 to 32 bits, two's complement */
+#define BSP_SPIADC_RESULT_BITS 16U
+
+/**
+ * @brief Frames per second
+ *
+ * The frame period, in BSP_ADC1_TIMESTAMP_HZ ticks, must divide the ADC1
+ * trigger period of 1000 ticks, so that the capture timer's wrap-around
+ * keeps both grids, and must leave room for a frame: with the defaults
+ * 4.3 us to convert and 8.2 us to read. 50 kS/s (200 ticks) is the
+ * fastest rate that does.
+ */
+#define BSP_SPIADC_SAMPLE_RATE 50000U
+
+/** Longest conversion time after the CONVST edge (AD7606 without
+ * oversampling) */
+#define BSP_SPIADC_CONVERT_NS 4150U
+
+/** SPI clock as the 250 MHz kernel clock / 2^n, 1 to 8: 4 is 15.6 MHz */
+#define BSP_SPIADC_SCK_DIV_LOG2 4U
+
+/** Frames per DMA block, the half of the circular DMA buffer */
+#define BSP_SPIADC_BLOCK_SAMPLES 64U
+
+/** Number of frames kept in the sample ring (power of two) */
+#define BSP_SPIADC_RING_SIZE 512U
+
+/**
+ * @brief One frame of external ADC results.
+ *
+ * As bsp_adc1_sample_t: the first frame after frames that were never read
+ * has @c gap set to their number.
+ */
+typedef struct
+{
+    uint32_t sequence; /**< Frame index since start (sample-period clock) */
+    uint32_t gap;      /**< Frames never read before this one */
+    int32_t  raw[BSP_SPIADC_NUM_CHANNELS]; /**< Sign-extended results */
+} bsp_spiadc_sample_t;
+
+/**
+ * @brief Per-reader cursor into the sample ring.
+ */
+typedef struct
+{
+    uint32_t cursor;   /**< Index of the next frame */
+    uint32_t overruns; /**< Frames lost to falling behind */
+} bsp_spiadc_reader_t;
+
+/**
+ * @brief Function run once per published block, by the publishing task
+ *
+ * @param raw Results of the last frame of the block.
+ */
+typedef void (*bsp_spiadc_block_hook_t)(const int32_t *raw);
+
+/**
+ * @brief Counters of the external ADC
+ */
+typedef struct
+{
+    uint32_t frames;         /**< Frames published */
+    uint32_t missed;         /**< Frames never read, the sum of all gaps */
+    uint32_t block_overruns; /**< Blocks overwritten before publishing */
+    uint32_t errors;         /**< DMA errors and stalls, each a restart */
+} bsp_spiadc_stats_t;
+
+/**
+ * @brief Start reading frames.
+ *
+ * Conversions run whenever TIM1 does; this starts the DMA channels and
+ * SPI1. Frames converted while stopped are a gap before the first frame
+ * read.
+ *
+ * @return bsp_error_t BSP_OK, BSP_BUSY if already running, otherwise
+ *         BSP_ERROR.
+ */
+bsp_error_t BSP_SPIADC_Start(void);
+
+/**
+ * @brief Stop reading frames.
+ *
+ * @return bsp_error_t BSP_OK, or BSP_ERROR if a DMA channel did not stop.
+ */
+bsp_error_t BSP_SPIADC_Stop(void);
+
+/**
+ * @brief Check whether frames are being read.
+ *
+ * @return true between BSP_SPIADC_Start() and BSP_SPIADC_Stop().
+ */
+bool BSP_SPIADC_IsRunning(void);
+
+/**
+ * @brief Set the function run once per published block, or NULL.
+ *
+ * @param hook Block hook; it runs at the publishing task's priority and
+ *             must not block.
+ */
+void BSP_SPIADC_SetBlockHook(bsp_spiadc_block_hook_t hook);
+
+/**
+ * @brief Attach a reader to the sample ring.
+ *
+ * The reader starts at the newest frame, as BSP_ADC1_RingReaderInit().
+ *
+ * @param[out] reader Reader cursor to initialize.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if @p reader is NULL.
+ */
+bsp_error_t BSP_SPIADC_RingReaderInit(bsp_spiadc_reader_t *reader);
+
+/**
+ * @brief Get the number of frames a reader can drain.
+ *
+ * @param[in] reader Reader cursor.
+ * @return Number of unread frames, capped at BSP_SPIADC_RING_SIZE.
+ */
+uint32_t BSP_SPIADC_RingAvailable(const bsp_spiadc_reader_t *reader);
+
+/**
+ * @brief Bulk-read frames from the ring and advance the reader cursor.
+ *
+ * As BSP_ADC1_RingRead() on the full-rate stream.
+ *
+ * @param[in,out] reader    Reader cursor.
+ * @param[out]    samples   Destination for at most @p max_count frames.
+ * @param[in]     max_count Capacity of @p samples.
+ * @param[out]    count     Number of frames stored in @p samples.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if a pointer is NULL.
+ */
+bsp_error_t BSP_SPIADC_RingRead(bsp_spiadc_reader_t *reader,
+                                bsp_spiadc_sample_t *samples,
+                                uint32_t max_count, uint32_t *count);
+
+/**
+ * @brief Get the capture time of a frame.
+ *
+ * The time is the frame's CONVST edge, in BSP_ADC1_TIMESTAMP_HZ ticks on
+ * the timescale of BSP_ADC1_GetSampleTime().
+ *
+ * @param[in]  sequence Frame sequence number.
+ * @param[out] time     Pointer to store the capture time.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG if @p time is NULL, BSP_ERROR
+ *         if the frame's block is not (or no longer) in the timestamp
+ *         history, or the sequence falls in a gap.
+ */
+bsp_error_t BSP_SPIADC_GetSampleTime(uint32_t sequence, uint64_t *time);
+
+/**
+ * @brief Get the capture time of a frame on the PTP timescale.
+ *
+ * @param[in]  sequence Frame sequence number.
+ * @param[out] time_ns  Pointer to store the capture time, in ns.
+ * @return bsp_error_t As BSP_SPIADC_GetSampleTime().
+ */
+bsp_error_t BSP_SPIADC_GetSampleTimeNs(uint32_t sequence, uint64_t *time_ns);
+
+/**
+ * @brief Get the counters of the external ADC.
+ *
+ * @param[out] stats Destination.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if @p stats is NULL.
+ */
+bsp_error_t BSP_SPIADC_GetStats(bsp_spiadc_stats_t *stats);
+
+/** @} */ /* End of BSP_SPIADC group */
+#endif /* BSP_SPIADC_ENABLE */
+
+/** @brief External ADC receive DMA interrupt entry, called from
+ * GPDMA1_Channel4_IRQHandler(); defined either way, the interrupt is only
+ * enabled with BSP_SPIADC_ENABLE */
+void BSP_SPIADC_DMA_IRQHandler(void);
+
+/**
+ * @brief Initializes the I2C Digital Output subsystem.
+ *
+ * Takes the expanders of the output image, then writes every one of them
+ * to all outputs low, so the committed image matches the pins.
+ *
+ * @param addresses 7-bit I2C addresses of the expanders, output n on
+ * expander n / 8.
+ * @param count     Number of expanders, 1 to ::BSP_I2CDO_MAX_EXPANDERS.
+ * @return bsp_error_t BSP_OK if initialization is successful,
+ * BSP_INVALID_ARG for a bad expander list, otherwise an error code.
+ */
+bsp_error_t BSP_I2CDO_init(const uint8_t *addresses, uint8_t count);
+
+/**
+ * @brief Returns the number of outputs of the expanders in use.
+ *
+ * @return uint32_t 8 per expander given to BSP_I2CDO_init(), 0 before.
+ */
+uint32_t BSP_I2CDO_GetCount(void);
+
+/**
+ * @brief Writes an output image to the I2C Digital Output expanders.
+ *
+ * Each expander whose byte of the image differs from the last successfully
+ * written image is sent its byte; all of them before the first success.
+ * Bits above BSP_I2CDO_GetCount() are ignored.
+ *
+ * @param value Output image (::BSP_I2C_Digital_Output_Masks) indicating the
+ * desired state of the digital outputs.
+ * @return bsp_error_t BSP_OK if the write is successful, otherwise an error
+ * code.
+ */
+bsp_error_t BSP_I2CDO_Write(uint32_t value);
+
+/**
+ * @brief Reads the current state of the I2C Digital Output expanders.
+ *
+ * This function reads every expander and combines their bytes into one
+ * output image.
+ *
+ * @param value Pointer to a uint32_t where the read value will be stored.
+ * @return bsp_error_t BSP_OK if the read is successful, otherwise an error
+ * code.
+ */
+bsp_error_t BSP_I2CDO_Read(uint32_t *value);
+
+/**
+ * @brief Starts an interrupt-driven write of the I2C digital outputs.
+ *
+ * Queues the bytes of the expanders that change, as BSP_I2CDO_Write()
+ * selects them, back-to-back on I2C3 and returns immediately; the
+ * transfer takes one expander byte time per changed expander. On
+ * completion the calling task is notified on ::BSP_I2CDO_NOTIFY_INDEX; use
+ * BSP_I2CDO_Wait() to block on it or BSP_I2CDO_IsDone() to poll from a
+ * periodic job. Must be called from a task once the scheduler is running.
+ *
+ * @param value Output states (::BSP_I2C_Digital_Output_Masks).
+ * @param xfer  Completion handle, valid until the transfer is done.
+ * @return bsp_error_t BSP_OK if the transfer was started, BSP_BUSY if
+ * another transfer is in flight, otherwise an error code.
+ */
+bsp_error_t BSP_I2CDO_WriteAsync(uint32_t value, bsp_i2cdo_xfer_t *xfer);
+
+/**
+ * @brief Starts an interrupt-driven commit of the shadow output image.
+ *
+ * Asynchronous counterpart of BSP_I2CDO_Commit(). If nothing is staged the
+ * handle completes immediately with BSP_OK and no transfer is started.
+ *
+ * @param xfer Completion handle, valid until the transfer is done.
+ * @return bsp_error_t as for BSP_I2CDO_WriteAsync().
+ */
+bsp_error_t BSP_I2CDO_CommitAsync(bsp_i2cdo_xfer_t *xfer);
+
+/**
+ * @brief Blocks the calling task until an asynchronous transfer completes.
+ *
+ * Only the task that started the transfer is notified, so this must be
+ * called from that task. On timeout the transfer stays in flight and
+ * @p xfer must remain valid.
+ *
+ * @param xfer       Completion handle of the transfer.
+ * @param timeout_ms Maximum time to wait in milliseconds.
+ * @return bsp_error_t Transfer result, or BSP_TIMEOUT if still in flight.
+ */
+bsp_error_t BSP_I2CDO_Wait(bsp_i2cdo_xfer_t *xfer, uint32_t timeout_ms);
+
+/**
+ * @brief Checks whether an asynchronous transfer has completed.
+ *
+ * @param xfer Completion handle of the transfer.
+ * @return true once the transfer has finished (successfully or not).
+ */
+bool BSP_I2CDO_IsDone(const bsp_i2cdo_xfer_t *xfer);
+
+/**
+ * @brief Stages a change of the I2C digital outputs in the shadow image.
+ *
+ * Only the cached output image is updated; no I2C transfer takes place
+ * until BSP_I2CDO_Commit() is called. Several stages can therefore be
+ * combined into a single expander update.
+ *
+ * Outputs held by BSP_I2CDO_Force() keep their forced states. Safe to call
+ * from any task.
+ *
+ * @param mask  Outputs to change (::BSP_I2C_Digital_Output_Masks).
+ * @param value New states for the outputs selected by @p mask.
+ * @return bsp_error_t BSP_OK.
+ */
+bsp_error_t BSP_I2CDO_Stage(uint32_t mask, uint32_t value);
+
+/**
+ * @brief Pushes the shadow image to the I2C expanders.
+ *
+ * Writes the bytes of the expanders whose outputs differ from the last
+ * successfully written state, if any. On failure the staged changes are
+ * kept, so they can be retried or dropped with BSP_I2CDO_Discard().
+ *
+ * @return bsp_error_t BSP_OK if the expanders hold the shadow image,
+ * otherwise an error code.
+ */
+bsp_error_t BSP_I2CDO_Commit(void);
+
+/**
+ * @brief Drops staged changes, restoring the last committed output image.
+ *
+ * Outputs held by BSP_I2CDO_Force() keep their forced states.
+ */
+void BSP_I2CDO_Discard(void);
+
+/**
+ * @brief Holds outputs in fixed states, whatever is staged or written.
+ *
+ * The forced states are staged in the shadow image at once, and every later
+ * stage, discard and write keeps them, so no other writer can change a
+ * held output. Each call replaces the held set; an output released keeps
+ * its state until it is written again. The caller commits the change.
+ * Safe to call from any task.
+ *
+ * @param mask  Outputs to hold (::BSP_I2C_Digital_Output_Masks).
+ * @param value States of the outputs selected by @p mask.
+ */
+void BSP_I2CDO_Force(uint32_t mask, uint32_t value);
+
+/**
+ * @brief Returns the shadow output image, including staged changes.
+ *
+ * @return uint32_t Output states (::BSP_I2C_Digital_Output_Masks).
+ */
+uint32_t BSP_I2CDO_GetShadow(void);
+
+/**
+ * @brief Returns the output image last written to the expanders.
+ *
+ * @return uint32_t Output states (::BSP_I2C_Digital_Output_Masks).
+ */
+uint32_t BSP_I2CDO_GetCommitted(void);
+
+/**
+ * @brief Verifies the expander outputs against the last committed image.
+ *
+ * Reads every expander back; intended for diagnostics only, as the shadow
+ * image is the reference for all output updates.
+ *
+ * @return bsp_error_t BSP_OK if the outputs match, BSP_ERROR on mismatch,
+ * otherwise the read error code.
+ */
+bsp_error_t BSP_I2CDO_Verify(void);
+
+/**
+ * @brief Read the state of a GPIO digital input channel
+ *
+ * Reads the current logic level of the specified GPIO digital input pin
+ * and stores the result in the provided output parameter.
+ *
+ * @param[in]  channel The digital input channel index to read.
+ *                     @see BSP_GPIODI_INDEX for valid channel values
+ *                     (BSP_GPIODI_INDEX_0 through BSP_GPIODI_INDEX_7)
+ * @param[out] pVal    Pointer to store the pin state (GPIO_PIN_SET or
+ * GPIO_PIN_RESET)
+ *
+ * @return bsp_error_t
+ * @retval BSP_OK    Read operation successful
+ * @retval BSP_ERROR Invalid channel or NULL pointer
+ */
+bsp_error_t BSP_GPIODI_Read(uint32_t channel, uint32_t *pVal);
+
+/** @brief Ticks an input must hold a new level before it is reported */
+#define BSP_GPIODI_DEBOUNCE_TICKS 4U
+
+/**
+ * @brief Read the debounced state of all GPIO digital inputs at once
+ *
+ * Returns the state kept by BSP_GPIODI_DebounceTick(), so all inputs come
+ * from the same sample and a level shows once it has been stable for
+ * ::BSP_GPIODI_DEBOUNCE_TICKS ticks. After the tick was suppressed by
+ * tickless idle the filter restarts from the pins. Callable from any task.
+ *
+ * @param[out] pBits Input states, bit n = BSP_GPIODI_INDEX_n
+ *
+ * @return bsp_error_t
+ * @retval BSP_OK    Read operation successful
+ * @retval BSP_ERROR NULL pointer
+ */
+bsp_error_t BSP_GPIODI_ReadAll(uint8_t *pBits);
+
+/**
+ * @brief Sample the GPIO digital inputs into the debounce filter
+ *
+ * Reads the input register of each port once. Called from the FreeRTOS
+ * tick hook.
+ */
+void BSP_GPIODI_DebounceTick(void);
+
+/**
+ * @brief Read the device address from DEVADDR0-3 GPIO pins
+ *
+ * Reads the 4-bit device address from the DEVADDR GPIO pins.
+ * The pins are active-low with internal pull-ups, so a grounded pin
+ * reads as 1 in the returned value.
+ *
+ * The address is composed as:
+ * - Bit 0: DEVADDR0 (PG14)
+ * - Bit 1: DEVADDR1 (PE11)
+ * - Bit 2: DEVADDR2 (PE13)
+ * - Bit 3: DEVADDR3 (PE14)
+ *
+ * @return uint8_t Device address value (0-15)
+ *
+ * @note The pins have internal pull-ups, so open pins read as 0 (high = 0).
+ *       Grounding a pin sets the corresponding bit to 1.
+ */
+uint8_t BSP_GetDeviceAddress(void);
+
+/**
+ * @defgroup BSP_RS485 RS-485 Serial Port
+ * @brief Half-duplex RS-485 port on USART2 (TX PD5, RX PD6, DE PD4).
+ *
+ * Reception runs continuously into a circular DMA buffer. The USART
+ * receiver timeout fires once the line has been silent for the configured
+ * frame timeout, and that single interrupt queues the bytes received since
+ * the previous one as a frame; no per-byte interrupt or software timing is
+ * involved. Transmission uses DMA, with the driver enable pin driven by the
+ * USART itself: DE rises one transceiver enable time before the start bit
+ * and falls as soon as the last stop bit is on the line, both counted in
+ * sample times by the USART so the turnaround has no software jitter.
+ * The receiver timeout is the frame timeout, so a response transmitted as
+ * soon as it is built already leaves that silence on the line.
+ * @{
+ */
+
+/**
+ * @brief Initializes USART2 and its DMA channels and starts reception.
+ *
+ * The calling task becomes the owner of the port and is the one notified
+ * on ::BSP_RS485_NOTIFY_INDEX. Must be called from a task once the
+ * scheduler is running.
+ *
+ * @param config Port configuration.
+ * @return bsp_error_t BSP_OK if the port is running, BSP_INVALID_ARG for an
+ * unsupported configuration, otherwise BSP_ERROR.
+ */
+bsp_error_t BSP_RS485_Init(const bsp_rs485_config_t *config);
+
+/**
+ * @brief Waits for the next received frame and copies it out.
+ *
+ * Frames are delivered in order of arrival. A frame that does not fit
+ * @p size, or that was received with a character error, is consumed and
+ * reported as BSP_ERROR.
+ *
+ * @param frame      Destination buffer.
+ * @param size       Size of @p frame in bytes.
+ * @param length     Number of bytes copied to @p frame.
+ * @param timeout_ms Maximum time to wait in milliseconds.
+ * @return bsp_error_t BSP_OK if a frame was copied, BSP_TIMEOUT if none
+ * arrived, BSP_ERROR if the frame was discarded.
+ */
+bsp_error_t BSP_RS485_ReadFrame(uint8_t *frame, uint16_t size,
+                                uint16_t *length, uint32_t timeout_ms);
+
+/**
+ * @brief Transmits a frame and waits until its last stop bit has been sent.
+ *
+ * @p data must stay valid until the function returns.
+ *
+ * @param data       Bytes to transmit.
+ * @param length     Number of bytes.
+ * @param timeout_ms Maximum time to wait in milliseconds.
+ * @return bsp_error_t BSP_OK on completion, BSP_TIMEOUT if the transfer is
+ * still in flight (it is aborted), otherwise an error code.
+ */
+bsp_error_t BSP_RS485_Transmit(const uint8_t *data, uint16_t length,
+                               uint32_t timeout_ms);
+
+/**
+ * @brief Returns the RS-485 port statistics.
+ *
+ * @param stats Destination.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if @p stats is NULL.
+ */
+bsp_error_t BSP_RS485_GetStats(bsp_rs485_stats_t *stats);
+
+/** @brief USART2 interrupt entry, called from USART2_IRQHandler(). */
+void BSP_RS485_IRQHandler(void);
+
+/** @brief RX DMA interrupt entry, called from GPDMA1_Channel1_IRQHandler(). */
+void BSP_RS485_RxDMA_IRQHandler(void);
+
+/** @brief TX DMA interrupt entry, called from GPDMA1_Channel2_IRQHandler(). */
+void BSP_RS485_TxDMA_IRQHandler(void);
+
+/** @brief ADC1 DMA interrupt entry, called from GPDMA1_Channel6_IRQHandler */
+void BSP_ADC1_DMA_IRQHandler(void);
+
+/** @brief ADC1 interrupt entry, called from ADC1_IRQHandler */
+void BSP_ADC1_IRQHandler(void);
+
+/** @brief ADC2 interrupt entry, called from ADC2_IRQHandler */
+void BSP_ADC2_IRQHandler(void);
+
+/** @} */ /* End of BSP_RS485 group */
+
+/**
+ * @defgroup BSP_PWM PWM Outputs
+ * @brief Four PWM outputs, each on channel 1 of its own timer.
+ *
+ * Output 0 is TIM3 on PC6, 1 TIM4 on PD12, 2 TIM5 on PA0 and 3 TIM15 on
+ * PE5. Prescaler, period and compare value are all preloaded, so a new
+ * setting takes over at a period boundary and no period mixes old and new
+ * values. A stopped output is driven low.
+ * @{
+ */
+
+/** @brief Number of PWM outputs */
+#define BSP_PWM_COUNT 4U
+
+/** @brief Duty cycle of an output that stays high, in 0.01 % */
+#define BSP_PWM_DUTY_MAX 10000U
+
+/** @brief Lowest output frequency in Hz */
+#define BSP_PWM_MIN_FREQUENCY 1U
+
+/** @brief Highest output frequency in Hz */
+#define BSP_PWM_MAX_FREQUENCY 100000U
+
+/**
+ * @brief Sets the frequency and duty cycle of a PWM output and runs it.
+ *
+ * A running output switches at the end of its current period, a stopped
+ * one starts with the new setting at once. Callable from any task.
+ *
+ * @param channel      Output, below ::BSP_PWM_COUNT.
+ * @param frequency_hz ::BSP_PWM_MIN_FREQUENCY to ::BSP_PWM_MAX_FREQUENCY.
+ * @param duty         High time in 0.01 % of the period, at most
+ *                     ::BSP_PWM_DUTY_MAX.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if an argument is out of
+ * range.
+ */
+bsp_error_t BSP_PWM_Start(uint8_t channel, uint32_t frequency_hz,
+                          uint16_t duty);
+
+/**
+ * @brief Changes the duty cycle of a PWM output, keeping its frequency.
+ *
+ * Takes effect at the end of the current period of a running output; a
+ * stopped output stays stopped. Callable from any task.
+ *
+ * @param channel Output, below ::BSP_PWM_COUNT.
+ * @param duty    High time in 0.01 % of the period, at most
+ *                ::BSP_PWM_DUTY_MAX.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if an argument is out of
+ * range.
+ */
+bsp_error_t BSP_PWM_SetDuty(uint8_t channel, uint16_t duty);
+
+/**
+ * @brief Stops a PWM output and drives it low at once.
+ *
+ * @param channel Output, below ::BSP_PWM_COUNT.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG for an unknown output.
+ */
+bsp_error_t BSP_PWM_Stop(uint8_t channel);
+
+/** @} */ /* End of BSP_PWM group */
+
+/**
+ * @defgroup BSP_GPIODI_CAPTURE Digital Input Edge Capture
+ * @brief Edge counting and timing of the GPIO digital inputs.
+ *
+ * Every edge of a captured input raises an EXTI interrupt that counts it,
+ * times it on the cycle counter and queues it in an edge FIFO; nothing is
+ * polled. The digital input pins have no timer channel free for input
+ * capture, so the time of an edge is the time its interrupt runs, and the
+ * interrupt latency is the timing jitter.
+ *
+ * An EXTI line serves one pin number of one port, so inputs on the same
+ * pin number exclude each other: DI4, DI5 and DI7 (line 0), DI3 and DI6
+ * (line 1), DI0 and DI2 (line 2). DI1 (line 9) has a line of its own. At
+ * most four inputs are captured at once.
+ * @{
+ */
+
+/** @brief Number of GPIO digital inputs */
+#define BSP_GPIODI_COUNT 8U
+
+/** @brief Edges the edge FIFO holds, a power of two */
+#define BSP_GPIODI_EDGE_FIFO_SIZE 64U
+
+/**
+ * @brief Counters of one captured input.
+ *
+ * Times are cycle counter values (::BSP_CycleCounter_Read64()); a period
+ * or high time beyond 2^32 cycles reads as UINT32_MAX.
+ */
+typedef struct
+{
+    uint32_t rising;    /**< Rising edges since the capture was enabled */
+    uint32_t period;    /**< Cycles between the last two rising edges, 0
+                             until two were seen */
+    uint32_t high_time; /**< Cycles from the last rising edge to the
+                             falling edge after it, 0 until one was seen */
+    uint64_t last_rise; /**< Time of the last rising edge */
+} bsp_gpiodi_capture_t;
+
+/**
+ * @brief One edge of the edge FIFO.
+ */
+typedef struct
+{
+    uint64_t time;    /**< Cycle counter when the edge was handled */
+    uint8_t  channel; /**< Digital input, ::BSP_GPIODI_INDEX */
+    bool     rising;  /**< Rising edge, else falling */
+} bsp_gpiodi_edge_t;
+
+/**
+ * @brief Selects the captured inputs.
+ *
+ * Newly selected inputs start from zeroed counters; the counters of inputs
+ * that stay selected run on. Deselected inputs go back to plain inputs.
+ * Callable from any task.
+ *
+ * @param mask Inputs to capture, bit n = DIn.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if the mask names two
+ * inputs of one EXTI line; the selection is then unchanged.
+ */
+bsp_error_t BSP_GPIODI_CaptureSelect(uint8_t mask);
+
+/**
+ * @brief Returns the inputs selected by BSP_GPIODI_CaptureSelect().
+ *
+ * @return uint8_t Captured inputs, bit n = DIn.
+ */
+uint8_t BSP_GPIODI_CaptureSelected(void);
+
+/**
+ * @brief Reads the counters of a captured input as one snapshot.
+ *
+ * @param channel Digital input, ::BSP_GPIODI_INDEX.
+ * @param capture Counters; zero for an input that is not captured.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG for an unknown input or
+ * NULL @p capture.
+ */
+bsp_error_t BSP_GPIODI_CaptureRead(uint32_t              channel,
+                                   bsp_gpiodi_capture_t *capture);
+
+/**
+ * @brief Reads the rising edge count of a captured input alone.
+ *
+ * One word, read without a critical section, so that it may be called
+ * above the kernel's interrupt mask, e.g. from a ::bsp_pvd_hook_t.
+ *
+ * @param channel Digital input, ::BSP_GPIODI_INDEX.
+ * @return uint32_t Rising edges, 0 for an input that is not captured or an
+ * unknown one.
+ */
+uint32_t BSP_GPIODI_CaptureRising(uint32_t channel);
+
+/**
+ * @brief Takes edges from the edge FIFO, oldest first.
+ *
+ * Edges that find the FIFO full are dropped and counted as overruns.
+ * Meant for a single reader.
+ *
+ * @param edges     Destination for at most @p max_count edges.
+ * @param max_count Capacity of @p edges.
+ * @param count     Number of edges stored in @p edges.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if a pointer is NULL.
+ */
+bsp_error_t BSP_GPIODI_EdgeRead(bsp_gpiodi_edge_t *edges, uint32_t max_count,
+                                uint32_t *count);
+
+/**
+ * @brief Returns the number of edges dropped because the FIFO was full.
+ *
+ * @return uint32_t Dropped edges since BSP_Init().
+ */
+uint32_t BSP_GPIODI_EdgeOverruns(void);
+
+/**
+ * @brief EXTI interrupt handler of a captured input.
+ *
+ * Called from the EXTI0, EXTI1, EXTI2 and EXTI9 interrupt handlers.
+ *
+ * @param line EXTI line of the interrupt.
+ */
+void BSP_GPIODI_IRQHandler(uint32_t line);
+
+/** @} */ /* End of BSP_GPIODI_CAPTURE group */
+
+/**
+ * @defgroup BSP_CAN CAN FD Port
+ * @brief CAN FD port on FDCAN1 (TX PB9, RX PB8), kernel clock PLL2Q.
+ *
+ * The acceptance filters run in the controller: a frame that matches no
+ * filter is dropped without an interrupt or a message RAM write, so other
+ * traffic on the bus costs no CPU time. Accepted frames wait in the three
+ * entry RX FIFO 0. Transmission goes through a software queue in front of
+ * the controller's three TX buffers, run as a FIFO so frames leave in the
+ * order they were queued; the transmission complete interrupt moves the
+ * next queued frames into the buffers that came free. A bus-off controller
+ * is restarted at once and goes through the bus recovery sequence.
+ *
+ * The board has no CAN transceiver: PB8 and PB9 (Arduino D15/D14) connect
+ * to an external one.
+ * @{
+ */
+
+/** @brief Largest payload of a CAN FD frame in bytes */
+#define BSP_CAN_MAX_DATA 64U
+
+/** @brief Number of acceptance filters */
+#define BSP_CAN_MAX_FILTERS 28U
+
+/** @brief Frames the software TX queue holds, a power of two */
+#define BSP_CAN_TX_QUEUE_SIZE 16U
+
+/** @brief Highest standard (11-bit) identifier */
+#define BSP_CAN_MAX_ID 0x7FFU
+
+/** @brief Lowest nominal bit rate in bit/s */
+#define BSP_CAN_MIN_BITRATE 10000U
+
+/** @brief Highest nominal bit rate in bit/s */
+#define BSP_CAN_MAX_BITRATE 1000000U
+
+/** @brief Highest data phase bit rate in bit/s */
+#define BSP_CAN_MAX_DATA_BITRATE 8000000U
+
+/** @brief Frame flag: CAN FD format, up to ::BSP_CAN_MAX_DATA bytes */
+#define BSP_CAN_FLAG_FD 0x01U
+
+/** @brief Frame flag: data phase at the data bit rate (FD frames only) */
+#define BSP_CAN_FLAG_BRS 0x02U
+
+/**
+ * @brief Acceptance filter on standard identifiers.
+ *
+ * A frame is accepted when its identifier equals @c id in every bit set
+ * in @c mask.
+ */
+typedef struct
+{
+    uint16_t id;   /**< Identifier to match */
+    uint16_t mask; /**< Identifier bits compared */
+} bsp_can_filter_t;
+
+/**
+ * @brief CAN port configuration.
+ *
+ * The bit timing is derived from the 80 MHz kernel clock with the sample
+ * point at 80 % of the nominal bit and 75 % of the data bit.
+ */
+typedef struct
+{
+    uint32_t                nominal_bitrate; /**< Arbitration phase, bit/s */
+    uint32_t                data_bitrate;    /**< Data phase, bit/s */
+    const bsp_can_filter_t *filters;         /**< Acceptance filters */
+    uint8_t                 filter_count;    /**< Filters, none accepts no
+                                                  frame */
+} bsp_can_config_t;
+
+/**
+ * @brief One frame with a standard identifier.
+ *
+ * A classic frame carries up to 8 bytes. An FD frame carries 0 to 8, 12,
+ * 16, 20, 24, 32, 48 or 64 bytes.
+ */
+typedef struct
+{
+    uint16_t id;                     /**< Standard identifier */
+    uint8_t  length;                 /**< Payload length in bytes */
+    uint8_t  flags;                  /**< BSP_CAN_FLAG_* */
+    uint8_t  data[BSP_CAN_MAX_DATA]; /**< Payload */
+} bsp_can_frame_t;
+
+/**
+ * @brief CAN port statistics, cumulative since BSP_Init().
+ */
+typedef struct
+{
+    uint32_t tx_frames;  /**< Frames handed to the controller */
+    uint32_t tx_dropped; /**< Frames refused on a full TX queue */
+    uint32_t rx_lost;    /**< Accepted frames lost on a full RX FIFO */
+    uint32_t bus_off;    /**< Times the controller went bus-off */
+    uint8_t  tec;        /**< Transmit error counter, now */
+    uint8_t  rec;        /**< Receive error counter, now */
+} bsp_can_stats_t;
+
+/**
+ * @brief Configures FDCAN1 and joins the bus.
+ *
+ * A running port is restarted with the new configuration; frames still
+ * queued are dropped. Callable from any task.
+ *
+ * @param config Port configuration.
+ * @return bsp_error_t BSP_OK once the controller takes part in bus
+ * traffic, BSP_INVALID_ARG for a bit rate out of range or one the kernel
+ * clock cannot divide to, too many filters or a filter on an identifier
+ * above ::BSP_CAN_MAX_ID, BSP_ERROR if the kernel clock cannot be set up,
+ * BSP_TIMEOUT if the controller does not respond.
+ */
+bsp_error_t BSP_CAN_Start(const bsp_can_config_t *config);
+
+/**
+ * @brief Leaves the bus and stops the FDCAN1 clock.
+ *
+ * Frames still queued are dropped. Callable from any task.
+ *
+ * @return bsp_error_t BSP_OK, or BSP_TIMEOUT if the controller does not
+ * respond.
+ */
+bsp_error_t BSP_CAN_Stop(void);
+
+/**
+ * @brief Returns whether the port was started.
+ *
+ * @return true between BSP_CAN_Start() and BSP_CAN_Stop().
+ */
+bool BSP_CAN_IsRunning(void);
+
+/**
+ * @brief Queues a frame for transmission.
+ *
+ * The frame is copied; it goes straight to the controller when a TX buffer
+ * is free and nothing is queued before it. Callable from any task.
+ *
+ * @param frame Frame to send.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for an identifier above
+ * ::BSP_CAN_MAX_ID or a length the frame format cannot carry, BSP_BUSY if
+ * the TX queue is full (counted in @c tx_dropped), BSP_ERROR if the port is
+ * not running.
+ */
+bsp_error_t BSP_CAN_Transmit(const bsp_can_frame_t *frame);
+
+/**
+ * @brief Takes accepted frames from RX FIFO 0, oldest first.
+ *
+ * Meant for a single reader.
+ *
+ * @param frames    Destination for at most @p max_count frames.
+ * @param max_count Capacity of @p frames.
+ * @param count     Number of frames stored in @p frames.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG if a pointer is NULL,
+ * BSP_ERROR if the port is not running.
+ */
+bsp_error_t BSP_CAN_Receive(bsp_can_frame_t *frames, uint32_t max_count,
+                            uint32_t *count);
+
+/**
+ * @brief Returns the CAN port statistics.
+ *
+ * @param stats Destination.
+ * @return bsp_error_t BSP_OK, or BSP_INVALID_ARG if @p stats is NULL.
+ */
+bsp_error_t BSP_CAN_GetStats(bsp_can_stats_t *stats);
+
+/** @brief FDCAN1 interrupt entry, called from FDCAN1_IT0_IRQHandler(). */
+void BSP_CAN_IRQHandler(void);
+
+/** @} */ /* End of BSP_CAN group */
+
+/**
+ * @defgroup BSP_USBH USB Host Port
+ * @brief Full-speed USB host on USB_DRD_FS (PA11/PA12), clocked by HSI48.
+ *
+ * A thin layer over the HAL HCD driver for a single device without a hub:
+ * one control pipe plus one bulk IN and one bulk OUT pipe. Transfers block
+ * the calling task, which sleeps on ::BSP_USBH_NOTIFY_INDEX until the
+ * interrupt reports the end of the transfer; a NAK resubmits the rest of
+ * the transfer until the timeout. Data toggles are kept by the HAL per
+ * pipe and reset with the pipe. Class drivers live above the BSP.
+ *
+ * The board does not source VBUS on the USB connector: a device needs an
+ * externally powered OTG adapter or hub.
+ * @{
+ */
+
+/** @brief Error code: the endpoint answered STALL */
+#define BSP_USBH_STALL ((bsp_error_t)5)
+
+/**
+ * @brief Task notification index used to signal the end of a USB transfer
+ * to the task that started it. Shared with ::BSP_RS485_NOTIFY_INDEX, so
+ * that task must not also drive the USB host port.
+ */
+#define BSP_USBH_NOTIFY_INDEX 2U
+
+/** @brief Endpoint address bit of the IN direction */
+#define BSP_USBH_EP_IN 0x80U
+
+/**
+ * @brief Setup packet of a control transfer (USB 2.0, 9.3).
+ */
+typedef struct
+{
+    uint8_t  request_type; /**< bmRequestType, direction in bit 7 */
+    uint8_t  request;      /**< bRequest */
+    uint16_t value;        /**< wValue */
+    uint16_t index;        /**< wIndex */
+    uint16_t length;       /**< wLength, data stage size */
+} bsp_usbh_setup_t;
+
+/**
+ * @brief Starts the host port and enables its interrupt.
+ *
+ * The first call initializes the HCD, which BSP_Init() leaves out to keep
+ * it off the boot path, and turns the host on so that device attachment is
+ * detected. Calling it again has no effect.
+ *
+ * @return bsp_error_t BSP_OK, or BSP_ERROR if the HCD does not start or
+ * the port is built as a device (BSP_USBD_ENABLE).
+ */
+bsp_error_t BSP_USBH_Start(void);
+
+/**
+ * @brief Returns whether a device is attached.
+ *
+ * @return true from the connect to the disconnect interrupt.
+ */
+bool BSP_USBH_IsConnected(void);
+
+/**
+ * @brief Resets the bus and opens the control pipe to address 0.
+ *
+ * Closes all pipes. Task context only.
+ *
+ * @return bsp_error_t BSP_OK once the port is enabled, BSP_ERROR if no
+ * device is attached, BSP_TIMEOUT if the port is not enabled in time.
+ */
+bsp_error_t BSP_USBH_ResetPort(void);
+
+/**
+ * @brief Reopens the control pipe for a device address or packet size.
+ *
+ * @param address    Device address, 0 to 127.
+ * @param max_packet Endpoint 0 packet size from the device descriptor.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for an address above 127 or
+ * a packet size of 0 or above 64, BSP_ERROR if the HCD refuses the pipe.
+ */
+bsp_error_t BSP_USBH_OpenControl(uint8_t address, uint8_t max_packet);
+
+/**
+ * @brief Opens the bulk pipe of an endpoint on the current address.
+ *
+ * One IN and one OUT pipe are open at a time; opening an endpoint of the
+ * same direction replaces the pipe.
+ *
+ * @param endpoint   Endpoint address, ::BSP_USBH_EP_IN set for IN.
+ * @param max_packet Endpoint packet size from the endpoint descriptor.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for endpoint 0 or a packet
+ * size of 0 or above 64, BSP_ERROR if the HCD refuses the pipe.
+ */
+bsp_error_t BSP_USBH_OpenBulk(uint8_t endpoint, uint16_t max_packet);
+
+/**
+ * @brief Runs a control transfer on the control pipe. Task context only.
+ *
+ * @param setup      Setup packet; @c length bytes are transferred in the
+ *                   direction of @c request_type.
+ * @param data       Data stage buffer, NULL only if @c length is 0.
+ * @param actual     Bytes transferred in the data stage, may be NULL.
+ * @param timeout_ms Longest time for the whole transfer.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for a missing buffer,
+ * BSP_USBH_STALL if the device refuses the request, BSP_TIMEOUT, or
+ * BSP_ERROR on a bus error or a disconnect.
+ */
+bsp_error_t BSP_USBH_Control(const bsp_usbh_setup_t *setup, uint8_t *data,
+                             uint16_t *actual, uint32_t timeout_ms);
+
+/**
+ * @brief Runs a bulk transfer on an open pipe. Task context only.
+ *
+ * An IN transfer ends early on a short packet.
+ *
+ * @param endpoint   Endpoint address given to BSP_USBH_OpenBulk().
+ * @param data       Buffer of @p length bytes.
+ * @param length     Bytes to transfer, at most 65535.
+ * @param actual     Bytes transferred, may be NULL.
+ * @param timeout_ms Longest time for the whole transfer.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for a missing buffer, a pipe
+ * that is not open or a length above 65535, BSP_USBH_STALL if the endpoint
+ * halted, BSP_TIMEOUT, or BSP_ERROR on a bus error or a disconnect.
+ */
+bsp_error_t BSP_USBH_Bulk(uint8_t endpoint, uint8_t *data, uint32_t length,
+                          uint32_t *actual, uint32_t timeout_ms);
+
+/**
+ * @brief Clears the halt of a bulk endpoint and resets its data toggle.
+ *
+ * Sends CLEAR_FEATURE(ENDPOINT_HALT). Task context only.
+ *
+ * @param endpoint   Endpoint address given to BSP_USBH_OpenBulk().
+ * @param timeout_ms Longest time for the request.
+ * @return bsp_error_t as BSP_USBH_Control().
+ */
+bsp_error_t BSP_USBH_ClearHalt(uint8_t endpoint, uint32_t timeout_ms);
+
+/** @brief USB interrupt entry, called from USB_DRD_FS_IRQHandler(); serves
+ * the device port instead when built with BSP_USBD_ENABLE. */
+void BSP_USBH_IRQHandler(void);
+
+/** @} */ /* End of BSP_USBH group */
+
+/**
+ * @brief Run USB_DRD_FS as a device instead of the host port
+ *
+ * 0 keeps the BSP_USBH host port. 1 adds the BSP_USBD group below and
+ * BSP_USBH_Start() refuses to start, as both drive the same connector.
+ * Set by the CMake option JERRY_USB_STREAM.
+ */
+#ifndef BSP_USBD_ENABLE
+#define BSP_USBD_ENABLE 0
+#endif
+
+#if BSP_USBD_ENABLE
+/**
+ * @defgroup BSP_USBD USB Device Port
+ * @brief Full-speed USB device on USB_DRD_FS, clocked by HSI48 trimmed to
+ * the host's SOF by the CRS.
+ *
+ * A register-level driver, as the HAL PCD driver is not part of the tree,
+ * for one configuration: the control endpoint and the bulk IN endpoint
+ * ::BSP_USBD_EP_BULK_IN, each single-buffered in the packet memory.
+ * Standard requests are answered from the descriptors given to
+ * BSP_USBD_Start(); vendor and class requests go to a callback. Requests
+ * with an OUT data stage are refused with a STALL.
+ *
+ * A bulk transfer sends a buffer of the caller's in place: the interrupt
+ * copies it into the packet memory one packet at a time as the host takes
+ * them, and ends it with a short or zero-length packet, so one transfer
+ * is one host read. Up to ::BSP_USBD_QUEUE_DEPTH transfers are queued so
+ * that the next one starts from the interrupt when one ends. A bus reset
+ * drops the queue; every transfer queued is reported to the completion
+ * callback exactly once, sent or not.
+ * @{
+ */
+
+/** @brief Address of the bulk IN endpoint */
+#define BSP_USBD_EP_BULK_IN 0x81U
+
+/** @brief Packet size of the control and bulk endpoints */
+#define BSP_USBD_MAX_PACKET 64U
+
+/** @brief Bulk transfers queued at a time */
+#define BSP_USBD_QUEUE_DEPTH 4U
+
+/**
+ * @brief Descriptors and callbacks of the device.
+ *
+ * The descriptors are wire format and must outlive the port. The
+ * callbacks run in the USB interrupt.
+ */
+typedef struct
+{
+    const uint8_t *device;        /**< Device descriptor, 18 bytes */
+    const uint8_t *configuration; /**< Configuration descriptor with its
+                                       interface and endpoint descriptors,
+                                       wTotalLength bytes */
+    const uint8_t *bos;           /**< BOS descriptor set, or NULL */
+    const uint8_t *const *strings; /**< String descriptors by index, the
+                                        language IDs at 0 */
+    uint8_t string_count;          /**< Entries of @c strings */
+
+    /**
+     * Vendor or class request without an OUT data stage. Points @p data
+     * at the IN data, which stays valid until the next request, and
+     * returns its length (cut to wLength), 0 for none, or -1 to STALL.
+     */
+    int32_t (*request)(const bsp_usbh_setup_t *setup, const uint8_t **data);
+
+    /** The host set configuration 1, or left it by a reset or
+     *  SET_CONFIGURATION(0); may be NULL */
+    void (*configured)(bool configured);
+
+    /** A bulk transfer ended, sent (@p sent true) or dropped */
+    void (*transmitted)(const uint8_t *data, bool sent);
+} bsp_usbd_config_t;
+
+/**
+ * @brief Starts the device and connects it to the bus.
+ *
+ * Clocks the port, enables its interrupt and pulls D+ up, after which the
+ * host enumerates the device. Call once.
+ *
+ * @param config Descriptors and callbacks, kept by reference.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for a missing descriptor or
+ * callback, BSP_BUSY if the port is already started.
+ */
+bsp_error_t BSP_USBD_Start(const bsp_usbd_config_t *config);
+
+/**
+ * @brief Returns whether the host has set the configuration.
+ *
+ * @return true from SET_CONFIGURATION(1) to a reset or
+ * SET_CONFIGURATION(0).
+ */
+bool BSP_USBD_IsConfigured(void);
+
+/**
+ * @brief Queues a bulk IN transfer.
+ *
+ * The buffer is read from the interrupt until the completion callback
+ * reports it, so it must not change before then. Any context.
+ *
+ * @param data   Transfer data.
+ * @param length Bytes to send, at least 1.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for a missing or empty
+ * buffer, BSP_ERROR if the device is not configured, BSP_BUSY if the queue
+ * is full.
+ */
+bsp_error_t BSP_USBD_Transmit(const uint8_t *data, uint32_t length);
+
+/** @} */ /* End of BSP_USBD group */
+#endif /* BSP_USBD_ENABLE */
+
+/**
+ * @defgroup BSP_CONSOLE Console Port
+ * @brief Console on the ST-LINK virtual COM port (USART3, COM1).
+ *
+ * printf() writes to the port byte by byte through the Nucleo BSP. The
+ * functions here let one task own the port instead and hand it whole
+ * buffers by DMA.
+ * @{
+ */
+
+/**
+ * @brief Transmits a buffer by DMA and waits until it has been sent.
+ *
+ * @p data must stay valid until the function returns. Task context only;
+ * one task at a time.
+ *
+ * @param data       Bytes to transmit.
+ * @param length     Number of bytes.
+ * @param timeout_ms Maximum time to wait in milliseconds.
+ * @return bsp_error_t BSP_OK on completion, BSP_TIMEOUT if the transfer is
+ * still in flight (it is aborted), otherwise an error code.
+ */
+bsp_error_t BSP_Console_Transmit(const uint8_t *data, uint16_t length,
+                                 uint32_t timeout_ms);
+
+/**
+ * @brief Writes a buffer by polling the transmitter.
+ *
+ * Waits for a DMA transfer in flight to end first. Usable without the
+ * scheduler and with interrupts disabled, such as before the scheduler
+ * starts or in a fault handler.
+ *
+ * @param data   Bytes to write.
+ * @param length Number of bytes.
+ */
+void BSP_Console_Write(const uint8_t *data, uint16_t length);
+
+/** @brief Function run once by the first fault handler, before it prints. */
+typedef void (*bsp_console_fault_hook_t)(void);
+
+/**
+ * @brief Sets the function run by BSP_Console_Fault().
+ *
+ * The logging writes out the output it still holds with it, so the last
+ * messages before a fault reach the console ahead of the fault report.
+ *
+ * @param hook Function to call, NULL for none.
+ */
+void BSP_Console_SetFaultHook(bsp_console_fault_hook_t hook);
+
+/**
+ * @brief Runs the fault hook, once.
+ *
+ * Called by the fault handlers and the fatal kernel hooks before they
+ * print, with interrupts masked or at fault priority. Later calls, such as
+ * from a fault within the hook, return at once.
+ */
+void BSP_Console_Fault(void);
+
+/** @brief USART3 interrupt entry, called from USART3_IRQHandler(). */
+void BSP_Console_IRQHandler(void);
+
+/** @brief TX DMA interrupt entry, called from GPDMA1_Channel3_IRQHandler(). */
+void BSP_Console_TxDMA_IRQHandler(void);
+
+/** @} */ /* End of BSP_CONSOLE group */
+
+/**
+ * @defgroup BSP_CRC CRC Calculation Unit
+ * @brief CRC-16/MODBUS on the CRC peripheral.
+ * @{
+ */
+
+/**
+ * @brief Computes the Modbus RTU CRC-16 of a buffer on the CRC unit.
+ *
+ * The unit has one owner at a time. A caller that finds it in use gets
+ * BSP_BUSY at once rather than waiting, and is expected to compute the CRC
+ * in software instead. Task context only.
+ *
+ * @param data   Data buffer.
+ * @param length Number of bytes.
+ * @param crc    CRC-16, low byte first on the wire as for modbus_crc16().
+ * @return bsp_error_t BSP_OK if @p crc was computed, BSP_BUSY if the unit is
+ * in use, BSP_INVALID_ARG for a NULL pointer.
+ */
+bsp_error_t BSP_CRC16_Modbus(const uint8_t *data, uint16_t length,
+                             uint16_t *crc);
+
+/** @} */ /* End of BSP_CRC group */
+
+/**
+ * @defgroup BSP_FLASH Firmware Update Flash
+ * @brief Programming of the update slot in the inactive flash bank.
+ *
+ * Each 1 MB bank holds the secure area (sectors 0-15, the secure image and
+ * its veneers) followed by the non-secure application. The bank booted is
+ * mapped at 0x08000000, the other one right above it, so the application
+ * always runs at ::BSP_FLASH_APP_BASE and the update slot is always at
+ * ::BSP_FLASH_UPDATE_BASE. BSP_Flash_SwapBanks() exchanges the two.
+ *
+ * The last sector of each bank is kept out of the application and the
+ * update slot for the configuration store. Configuration sector n is the
+ * one of physical bank n + 1, so a sector keeps its number across a swap;
+ * BSP_Flash_ConfigSector() gives its address in the current mapping. The
+ * sector below it is kept for the power-fail snapshot, numbered the same
+ * way (BSP_Flash_SnapshotSector()).
+ *
+ * Writes are interrupt driven: erase and programming run in the background.
+ * The update slot is in the other bank, so the CPU keeps executing; a
+ * configuration sector may be in the bank booted, whose fetches stall for
+ * each step (about 60 us per quad-word, a few ms per erase). One write is
+ * in flight at a time, whichever task started it.
+ * @{
+ */
+
+/** @brief Flash bank size */
+#define BSP_FLASH_BANK_SIZE 0x00100000U
+
+/** @brief Erase unit */
+#define BSP_FLASH_SECTOR_SIZE 0x2000U
+
+/** @brief Programming unit, one quad-word */
+#define BSP_FLASH_WORD_SIZE 16U
+
+/** @brief Offset of the application in a bank, after the secure area */
+#define BSP_FLASH_APP_OFFSET 0x00020000U
+
+/** @brief Offset of the configuration sector in a bank, the last sector */
+#define BSP_FLASH_CONFIG_OFFSET (BSP_FLASH_BANK_SIZE - BSP_FLASH_SECTOR_SIZE)
+
+/** @brief Configuration sectors, one per bank */
+#define BSP_FLASH_CONFIG_SECTORS 2U
+
+/** @brief Offset of the snapshot sector in a bank, below the configuration
+ * sector */
+#define BSP_FLASH_SNAPSHOT_OFFSET \
+    (BSP_FLASH_CONFIG_OFFSET - BSP_FLASH_SECTOR_SIZE)
+
+/** @brief Snapshot sectors, one per bank */
+#define BSP_FLASH_SNAPSHOT_SECTORS 2U
+
+/** @brief Largest application image, up to the snapshot sector */
+#define BSP_FLASH_APP_SIZE (BSP_FLASH_SNAPSHOT_OFFSET - BSP_FLASH_APP_OFFSET)
+
+/** @brief Address of the running application */
+#define BSP_FLASH_APP_BASE (0x08000000U + BSP_FLASH_APP_OFFSET)
+
+/** @brief Address of the update slot in the inactive bank */
+#define BSP_FLASH_UPDATE_BASE (BSP_FLASH_APP_BASE + BSP_FLASH_BANK_SIZE)
+
+/**
+ * @brief Starts an interrupt-driven write into the update slot.
+ *
+ * Programs @p length bytes at @p offset of the slot and returns at once.
+ * A sector is erased when a write reaches its first byte, so the slot must
+ * be written in order from offset 0; bytes past the last write are left as
+ * they were. On completion the calling task is notified on
+ * ::BSP_FLASH_NOTIFY_INDEX; see BSP_Flash_Wait(). Task context only.
+ *
+ * @param offset Offset in the slot, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @param data   Source, 32-bit aligned and valid until the write is done.
+ * @param length Bytes, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @return bsp_error_t BSP_OK if the write was started, BSP_BUSY if one is in
+ * flight, BSP_INVALID_ARG for a misaligned or out of range write, otherwise
+ * BSP_ERROR.
+ */
+bsp_error_t BSP_Flash_WriteAsync(uint32_t offset, const void *data,
+                                 uint32_t length);
+
+/**
+ * @brief Starts an interrupt-driven erase of a configuration sector.
+ *
+ * Returns at once; completion is signalled as for BSP_Flash_WriteAsync().
+ * Task context only.
+ *
+ * @param sector Configuration sector, below ::BSP_FLASH_CONFIG_SECTORS.
+ * @return bsp_error_t BSP_OK if the erase was started, BSP_BUSY if a write
+ * is in flight, BSP_INVALID_ARG for an unknown sector, otherwise BSP_ERROR.
+ */
+bsp_error_t BSP_Flash_ConfigEraseAsync(uint32_t sector);
+
+/**
+ * @brief Starts an interrupt-driven write into a configuration sector.
+ *
+ * Programs @p length bytes at @p offset of the sector and returns at once;
+ * nothing is erased, so the quad-words written must be erased ones.
+ * Completion is signalled as for BSP_Flash_WriteAsync(). Task context only.
+ *
+ * @param sector Configuration sector, below ::BSP_FLASH_CONFIG_SECTORS.
+ * @param offset Offset in the sector, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @param data   Source, 32-bit aligned and valid until the write is done.
+ * @param length Bytes, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @return bsp_error_t BSP_OK if the write was started, BSP_BUSY if one is in
+ * flight, BSP_INVALID_ARG for a misaligned or out of range write, otherwise
+ * BSP_ERROR.
+ */
+bsp_error_t BSP_Flash_ConfigWriteAsync(uint32_t sector, uint32_t offset,
+                                       const void *data, uint32_t length);
+
+/**
+ * @brief Address of a configuration sector in the current mapping.
+ *
+ * @param sector Configuration sector, below ::BSP_FLASH_CONFIG_SECTORS.
+ * @return const uint8_t* First byte of the sector, NULL for an unknown one.
+ */
+const uint8_t *BSP_Flash_ConfigSector(uint32_t sector);
+
+/**
+ * @brief Starts an interrupt-driven erase of a snapshot sector.
+ *
+ * As BSP_Flash_ConfigEraseAsync(), for the snapshot sectors. Task context
+ * only.
+ *
+ * @param sector Snapshot sector, below ::BSP_FLASH_SNAPSHOT_SECTORS.
+ * @return bsp_error_t BSP_OK if the erase was started, BSP_BUSY if a write
+ * is in flight, BSP_INVALID_ARG for an unknown sector, otherwise BSP_ERROR.
+ */
+bsp_error_t BSP_Flash_SnapshotEraseAsync(uint32_t sector);
+
+/**
+ * @brief Starts an interrupt-driven write into a snapshot sector.
+ *
+ * As BSP_Flash_ConfigWriteAsync(), for the snapshot sectors. Task context
+ * only.
+ *
+ * @param sector Snapshot sector, below ::BSP_FLASH_SNAPSHOT_SECTORS.
+ * @param offset Offset in the sector, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @param data   Source, 32-bit aligned and valid until the write is done.
+ * @param length Bytes, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @return bsp_error_t BSP_OK if the write was started, BSP_BUSY if one is in
+ * flight, BSP_INVALID_ARG for a misaligned or out of range write, otherwise
+ * BSP_ERROR.
+ */
+bsp_error_t BSP_Flash_SnapshotWriteAsync(uint32_t sector, uint32_t offset,
+                                         const void *data, uint32_t length);
+
+/**
+ * @brief Programs quad-words into a snapshot sector and waits, polling.
+ *
+ * For the power-fail interrupt: runs in any context, above the kernel's
+ * interrupt mask too, and uses no FreeRTOS call. The step in flight of an
+ * interrupt-driven write, a quad-word or an erase of up to a few ms, is
+ * waited for, then the write is abandoned: its task gets BSP_ERROR from
+ * BSP_Flash_Wait(). Nothing is erased, so the quad-words written must be
+ * erased ones.
+ *
+ * @param sector Snapshot sector, below ::BSP_FLASH_SNAPSHOT_SECTORS.
+ * @param offset Offset in the sector, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @param data   Source, 32-bit aligned.
+ * @param length Bytes, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @return bsp_error_t BSP_OK once programmed, BSP_INVALID_ARG for a
+ * misaligned or out of range write, otherwise BSP_ERROR.
+ */
+bsp_error_t BSP_Flash_SnapshotProgram(uint32_t sector, uint32_t offset,
+                                      const void *data, uint32_t length);
+
+/**
+ * @brief Address of a snapshot sector in the current mapping.
+ *
+ * @param sector Snapshot sector, below ::BSP_FLASH_SNAPSHOT_SECTORS.
+ * @return const uint8_t* First byte of the sector, NULL for an unknown one.
+ */
+const uint8_t *BSP_Flash_SnapshotSector(uint32_t sector);
+
+/**
+ * @brief Reads quad-words of a configuration or snapshot sector.
+ *
+ * A quad-word whose programming was cut short by a reset or a collapsing
+ * supply fails its ECC check, and a plain load of it raises the ECC
+ * double-error NMI. For these sectors BSP_Flash_NMIHandler() takes that
+ * NMI and the read reports the quad-word instead, so a torn write can be
+ * found without faulting. Any context.
+ *
+ * @param address First quad-word, in a configuration or snapshot sector.
+ * @param data    Destination, 32-bit aligned.
+ * @param length  Bytes, a multiple of ::BSP_FLASH_WORD_SIZE.
+ * @return bsp_error_t BSP_OK once read, BSP_ERROR at the first unreadable
+ * quad-word (those before it are copied), BSP_INVALID_ARG for a misaligned
+ * read.
+ */
+bsp_error_t BSP_Flash_Read(const void *address, void *data, uint32_t length);
+
+/**
+ * @brief Blocks the calling task until the flash write has ended.
+ *
+ * Waits for a write of another task too, in which case the result is that
+ * of the caller's own last write. On timeout the write stays in flight and
+ * its source must remain valid.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds.
+ * @return bsp_error_t BSP_OK if no write is in flight and the caller's last
+ * one succeeded, BSP_ERROR if it failed, BSP_TIMEOUT if still in flight.
+ */
+bsp_error_t BSP_Flash_Wait(uint32_t timeout_ms);
+
+/**
+ * @brief Checks whether a flash write is in flight.
+ *
+ * @return true from the start of a write or erase until it has ended.
+ */
+bool BSP_Flash_IsBusy(void);
+
+/**
+ * @brief Boots the update slot.
+ *
+ * Asks the secure world to swap the banks, which resets the device. Must
+ * only be called once the slot holds a complete image; the secure world
+ * refuses unless BSP_Verify_Finish() accepted it.
+ *
+ * @return bsp_error_t BSP_BUSY if a write is in flight, otherwise BSP_ERROR;
+ * does not return if the swap is made.
+ */
+bsp_error_t BSP_Flash_SwapBanks(void);
+
+/**
+ * @brief Checks which bank is booted.
+ *
+ * @return true if the banks are swapped, i.e. bank 2 is mapped first.
+ */
+bool BSP_Flash_IsSwapped(void);
+
+/** @brief FLASH interrupt entry, called from FLASH_IRQHandler(). */
+void BSP_Flash_IRQHandler(void);
+
+/**
+ * @brief Flash ECC double-error entry, called by the secure NMI_Handler().
+ *
+ * The NMI is taken by the secure world, which hands an ECC double error
+ * over here (SECURE_RegisterCallback(), FLASH_ECC_CB_ID). One of a
+ * configuration or snapshot sector is noted for BSP_Flash_Read().
+ *
+ * @param detection FLASH_ECCDETR, read before the flag is cleared.
+ * @return true if the error was in those sectors, so the secure world
+ * clears it and resumes; false for any other, which stays fatal.
+ */
+bool BSP_Flash_NMIHandler(uint32_t detection);
+
+/** @} */ /* End of BSP_FLASH group */
+
+/**
+ * @brief Drive an external SPI NOR flash on SPI3
+ *
+ * 0 leaves SPI3, its pins and GPDMA1 channel 7 alone. 1 adds the
+ * BSP_SPINOR group below, set up by BSP_Init(). Set by the CMake option
+ * JERRY_SPI_NOR.
+ */
+#ifndef BSP_SPINOR_ENABLE
+#define BSP_SPINOR_ENABLE 0
+#endif
+
+#if BSP_SPINOR_ENABLE
+/**
+ * @defgroup BSP_SPINOR External SPI NOR Flash
+ * @brief Serial NOR flash on SPI3, data phases moved by DMA
+ *
+ * For a 25-series flash with the common command set, 3-byte addresses and
+ * 64 KB block erase, such as the W25Q128 or MX25L12845 (up to 16 MB).
+ * SPI3 is a master in mode 0 (SCK PC10, MISO PC11, MOSI PC12) with the
+ * chip select on PA15 driven by software, so that one command spans
+ * several SPI transfers. The command and address bytes are written by the
+ * CPU; the data of a read or a page program is moved by GPDMA1 channel 7
+ * while the calling task sleeps on ::BSP_SPINOR_NOTIFY_INDEX.
+ *
+ * An erase runs in the background: BSP_SPINOR_EraseSector() returns once
+ * the chip has taken the command, and BSP_SPINOR_IsErasing() reports its
+ * end. A read or a program meanwhile suspends the erase, runs, and
+ * resumes it, so it waits a suspend latency (tens of us) rather than the
+ * erase (up to 2 s). A program waits for the chip to finish it.
+ *
+ * One call at a time: callers in several tasks must serialize themselves.
+ * Task context only.
+ * @{
+ */
+
+/**
+ * @brief Task notification index used to signal the end of a DMA transfer
+ * to the task in a BSP_SPINOR call. Shared with ::BSP_FLASH_NOTIFY_INDEX,
+ * so that task must not also write the internal flash.
+ */
+#define BSP_SPINOR_NOTIFY_INDEX 3U
+
+/** @brief Programming unit */
+#define BSP_SPINOR_PAGE_SIZE 256U
+
+/** @brief Erase unit, the 64 KB block */
+#define BSP_SPINOR_SECTOR_SIZE 0x10000U
+
+/** @brief Largest size used, the reach of 3-byte addresses */
+#define BSP_SPINOR_MAX_SIZE 0x01000000U
+
+/**
+ * @brief Resets the flash and reads its size.
+ *
+ * A software reset ends any erase or program left over from before the
+ * restart, then the JEDEC ID gives the capacity.
+ *
+ * @param[out] size Bytes usable, at most ::BSP_SPINOR_MAX_SIZE.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG if @p size is NULL,
+ * BSP_ERROR if no flash answers or its capacity is below two sectors.
+ */
+bsp_error_t BSP_SPINOR_Probe(uint32_t *size);
+
+/**
+ * @brief Reads from the flash.
+ *
+ * @param address First byte read.
+ * @param data    Destination.
+ * @param length  Bytes to read.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for a NULL pointer or a range
+ * past the flash, BSP_TIMEOUT if a transfer or a suspend did not end,
+ * otherwise BSP_ERROR.
+ */
+bsp_error_t BSP_SPINOR_Read(uint32_t address, void *data, uint32_t length);
+
+/**
+ * @brief Programs one page and waits for the flash to finish it.
+ *
+ * The page must be erased; its bytes can only go from 1 to 0.
+ *
+ * @param address First byte of the page, a multiple of
+ *                ::BSP_SPINOR_PAGE_SIZE.
+ * @param data    ::BSP_SPINOR_PAGE_SIZE bytes.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for a NULL pointer or a
+ * misaligned or out of range page, BSP_TIMEOUT if the flash stayed busy,
+ * otherwise BSP_ERROR.
+ */
+bsp_error_t BSP_SPINOR_ProgramPage(uint32_t address, const void *data);
+
+/**
+ * @brief Starts the erase of a sector.
+ *
+ * Returns once the flash has taken the command; see BSP_SPINOR_IsErasing().
+ *
+ * @param address First byte of the sector, a multiple of
+ *                ::BSP_SPINOR_SECTOR_SIZE.
+ * @return bsp_error_t BSP_OK if the erase was started, BSP_BUSY if one is
+ * in flight, BSP_INVALID_ARG for a misaligned or out of range sector,
+ * otherwise BSP_ERROR.
+ */
+bsp_error_t BSP_SPINOR_EraseSector(uint32_t address);
+
+/**
+ * @brief Checks whether an erase is in flight.
+ *
+ * Reads the status of the flash while one was started.
+ *
+ * @return true from BSP_SPINOR_EraseSector() until the flash has ended it.
+ */
+bool BSP_SPINOR_IsErasing(void);
+
+/** @} */ /* End of BSP_SPINOR group */
+#endif /* BSP_SPINOR_ENABLE */
+
+/** @brief SPI NOR flash DMA interrupt entry, called from
+ * GPDMA1_Channel7_IRQHandler(); defined either way, the interrupt is only
+ * enabled with BSP_SPINOR_ENABLE */
+void BSP_SPINOR_DMA_IRQHandler(void);
+
+/**
+ * @defgroup BSP_SECURE Secure Services
+ * @brief Batched calls into the secure world.
+ *
+ * Every call through the secure gateway pays for a state transition and
+ * the checks of its arguments, so services are requested as a batch of
+ * descriptors that one BSP_Secure_Batch() call runs in order. Buffers stay
+ * in non-secure memory and are checked by the secure world before use.
+ * @{
+ */
+
+/** @brief Most requests in one batch */
+#define BSP_SECURE_BATCH_MAX 16U
+
+/** @brief P-256 scalar and coordinate size in bytes */
+#define BSP_ECDSA_CURVE_SIZE 32U
+
+/**
+ * @brief Buffer of a ::BSP_SECURE_OP_ECDSA_VERIFY request: public key X and
+ * Y, digest, then r and s, each ::BSP_ECDSA_CURVE_SIZE bytes big-endian
+ */
+#define BSP_ECDSA_REQUEST_SIZE (5U * BSP_ECDSA_CURVE_SIZE)
+
+/**
+ * @brief Secure service operations.
+ */
+typedef enum
+{
+    BSP_SECURE_OP_NOP            = 0, /**< Nothing, for measuring a batch */
+    BSP_SECURE_OP_RANDOM         = 1, /**< BSP_Random_Read() */
+    BSP_SECURE_OP_VERIFY_START   = 2, /**< BSP_Verify_Start() */
+    BSP_SECURE_OP_VERIFY_UPDATE  = 3, /**< BSP_Verify_Update() */
+    BSP_SECURE_OP_VERIFY_FINISH  = 4, /**< BSP_Verify_Finish() */
+    BSP_SECURE_OP_ECDSA_VERIFY   = 5, /**< BSP_Ecdsa_Verify() */
+    BSP_SECURE_OP_ICACHE_ON      = 6, /**< BSP_ICache_Set(), on */
+    BSP_SECURE_OP_ICACHE_OFF     = 7, /**< BSP_ICache_Set(), off */
+    BSP_SECURE_OP_ICACHE_MONITOR = 8  /**< BSP_ICache_ReadMonitor() */
+} bsp_secure_op_t;
+
+/**
+ * @brief Secure service request status.
+ */
+typedef enum
+{
+    BSP_SECURE_OK            = 0, /**< Done */
+    BSP_SECURE_ERROR         = 1, /**< Bad call order or hardware failure */
+    BSP_SECURE_BAD_SIGNATURE = 2, /**< Image not signed with the key */
+    BSP_SECURE_INVALID       = 3, /**< Bad operation, length or buffer */
+    BSP_SECURE_SKIPPED       = 4  /**< An earlier request of the batch failed */
+} bsp_secure_status_t;
+
+/**
+ * @brief One request of a batch.
+ */
+typedef struct
+{
+    uint32_t op;     /**< bsp_secure_op_t */
+    uint32_t status; /**< bsp_secure_status_t, set by the batch */
+    void    *buffer; /**< Buffer of the operation, NULL if none */
+    uint32_t length; /**< Buffer size in bytes; bytes read by a random read */
+} bsp_secure_request_t;
+
+/**
+ * @brief Cost of the secure gateway.
+ */
+typedef struct
+{
+    uint32_t call_cycles;    /**< Fixed cost of one batch */
+    uint32_t request_cycles; /**< Added cost of each request in it */
+} bsp_secure_bench_t;
+
+/**
+ * @brief Runs a batch of secure service requests.
+ *
+ * Requests run in order in one transition to the secure world; once one
+ * fails the rest are not run and get ::BSP_SECURE_SKIPPED. The status of
+ * each request is written back into it.
+ *
+ * @param requests Array of requests in non-secure RAM.
+ * @param count    Number of requests, 1 to ::BSP_SECURE_BATCH_MAX.
+ * @return bsp_error_t BSP_OK if every request succeeded, BSP_BUSY if
+ * another task is in the secure world, BSP_INVALID_ARG for a bad count,
+ * otherwise BSP_ERROR and the statuses tell which request failed; all are
+ * ::BSP_SECURE_INVALID if the array is not in non-secure RAM.
+ */
+bsp_error_t BSP_Secure_Batch(bsp_secure_request_t *requests, uint32_t count);
+
+/**
+ * @brief Reads random words from the secure entropy pool.
+ *
+ * The TRNG refills the pool from its interrupt in the background, so the
+ * read never waits for conversions: it returns what the pool holds, up to
+ * @p length bytes, and may return fewer or none right after a large read.
+ *
+ * @param buffer      Buffer, 32-bit aligned.
+ * @param length      Bytes wanted, a multiple of 4.
+ * @param read_length Bytes read.
+ * @return bsp_error_t as BSP_Secure_Batch().
+ */
+bsp_error_t BSP_Random_Read(void *buffer, uint32_t length,
+                            uint32_t *read_length);
+
+/**
+ * @brief Checks an ECDSA P-256 signature on the PKA.
+ *
+ * Unlike BSP_Verify_Finish() any public key may be given; the result does
+ * not allow a bank swap.
+ *
+ * @param key       Public key, X then Y (2 x ::BSP_ECDSA_CURVE_SIZE bytes).
+ * @param hash      Digest, ::BSP_ECDSA_CURVE_SIZE bytes.
+ * @param signature r then s (2 x ::BSP_ECDSA_CURVE_SIZE bytes).
+ * @return bsp_error_t BSP_OK if the signature is valid, BSP_INVALID_ARG if
+ * it is not, BSP_BUSY if the gateway is in use, otherwise BSP_ERROR.
+ */
+bsp_error_t BSP_Ecdsa_Verify(const uint8_t *key, const uint8_t *hash,
+                             const uint8_t *signature);
+
+/**
+ * @brief Measures the cost of the secure gateway.
+ *
+ * Times batches of one and of ::BSP_SECURE_BATCH_MAX empty requests with
+ * the cycle counter and keeps the fastest of several runs, splitting the
+ * cost into a part paid per batch and a part paid per request.
+ *
+ * @param result Measured costs in core clock cycles.
+ * @return bsp_error_t BSP_OK, BSP_BUSY if the gateway is in use.
+ */
+bsp_error_t BSP_Secure_Benchmark(bsp_secure_bench_t *result);
+
+/**
+ * @brief Instruction cache hit and miss counts, with the hot code cluster
+ * they are meant to judge.
+ */
+typedef struct
+{
+    uint32_t hits;      /**< Fetches served by the cache */
+    uint32_t misses;    /**< Fetches that went to the flash, at most
+                             ::BSP_ICACHE_MISS_MAX */
+    uint32_t hot_start; /**< Address of the hot code at the start of .text */
+    uint32_t hot_size;  /**< Its size in bytes, 0 without JERRY_TEXT_HOT */
+} bsp_icache_monitor_t;
+
+/** @brief The miss counter stops at this value */
+#define BSP_ICACHE_MISS_MAX 0xFFFFU
+
+/**
+ * @brief Turns the instruction cache on or off.
+ *
+ * The cache is owned by the secure world and off after reset; the
+ * application runs without it unless built with ICACHE_ENABLE. The
+ * benchmark image (jerry_bench) turns it on and off to time its kernels
+ * both ways. Turning it on starts the hit and miss monitors from zero.
+ *
+ * @param enable true to turn the cache on, 2-way set associative.
+ * @return bsp_error_t as BSP_Secure_Batch().
+ */
+bsp_error_t BSP_ICache_Set(bool enable);
+
+/**
+ * @brief Reads and restarts the hit and miss monitors of the cache.
+ *
+ * The counts are those of every code fetch from the flash since the last
+ * read, secure and non-secure alike; both stay 0 while the cache is off.
+ * Neither counter wraps: the hit counter stops at 2^32 - 1, 17 s of
+ * fetches at 250 MHz, and the miss counter at ::BSP_ICACHE_MISS_MAX, so
+ * exact rates need reads at least that often. The host simulation has no cache and reads 0.
+ *
+ * The hot code is the cluster of the functions the linker script gathers
+ * in .text.hot (JERRY_TEXT_HOT), laid out in a row from a cache line on.
+ *
+ * @param counts Counts since the last read, and the hot code.
+ * @return bsp_error_t as BSP_Secure_Batch().
+ */
+bsp_error_t BSP_ICache_ReadMonitor(bsp_icache_monitor_t *counts);
+
+/** @} */ /* End of BSP_SECURE group */
+
+/**
+ * @defgroup BSP_VERIFY Image Verification
+ * @brief Signature check of update images in the secure world.
+ *
+ * The image is hashed (SHA-256, HASH peripheral fed by a secure DMA
+ * channel) while it is received, and its ECDSA P-256 signature is checked
+ * with PKA against the signing key held in secure flash. BSP_Flash_SwapBanks()
+ * only swaps to an image accepted by BSP_Verify_Finish(). Each call is a
+ * batch of one request; BSP_Secure_Batch() can combine them.
+ * @{
+ */
+
+/** @brief Signature size: r then s, big-endian */
+#define BSP_VERIFY_SIGNATURE_SIZE 64U
+
+/**
+ * @brief Starts checking an update image.
+ *
+ * Any image being checked is abandoned. Called from one task only, which
+ * then makes all BSP_Verify_*() and BSP_Flash_SwapBanks() calls.
+ *
+ * @return bsp_error_t BSP_OK, BSP_BUSY if the gateway is in use, BSP_ERROR
+ * if the hash unit cannot be used.
+ */
+bsp_error_t BSP_Verify_Start(void);
+
+/**
+ * @brief Adds the next bytes of the image to its digest.
+ *
+ * Returns once the block is queued; it is hashed in the background and
+ * must stay unchanged until the next BSP_Verify_Update() or
+ * BSP_Verify_Finish() call, which wait for it.
+ *
+ * @param data   Block, 32-bit aligned.
+ * @param length Bytes, at most 65532; only the last block may have a
+ * length that is not a multiple of 4.
+ * @return bsp_error_t BSP_OK, otherwise BSP_ERROR and the image must be
+ * started again.
+ */
+bsp_error_t BSP_Verify_Update(const void *data, uint32_t length);
+
+/**
+ * @brief Ends the digest and checks the image signature.
+ *
+ * @param signature ::BSP_VERIFY_SIGNATURE_SIZE bytes.
+ * @return bsp_error_t BSP_OK if the image is signed with the signing key,
+ * BSP_INVALID_ARG if it is not, BSP_ERROR if no image was being checked or
+ * the hardware failed.
+ */
+bsp_error_t BSP_Verify_Finish(const uint8_t *signature);
+
+/** @} */ /* End of BSP_VERIFY group */
+
+/**
+ * @defgroup BSP_CYCLES Cycle Counter
+ * @brief Free-running core clock cycle counter (DWT CYCCNT).
+ * @{
+ */
+
+/**
+ * @brief Reads the cycle counter started by BSP_Init().
+ *
+ * Counts core clock cycles and wraps every 2^32 cycles; differences of two
+ * readings are valid across one wrap. Callable from any context.
+ *
+ * @return uint32_t Current cycle count.
+ */
+uint32_t BSP_CycleCounter_Read(void);
+
+/**
+ * @brief Returns the rate at which the cycle counter runs.
+ *
+ * @return uint32_t Core clock frequency in Hz.
+ */
+uint32_t BSP_CycleCounter_Hz(void);
+
+/**
+ * @brief Reads the cycle counter extended to 64 bits.
+ *
+ * Counts CYCCNT wraps, so it must be read at least once per wrap (17 s at
+ * 250 MHz); the FreeRTOS tick hook does. Backs the FreeRTOS run-time
+ * statistics. Callable from any context.
+ *
+ * @return uint64_t Cycles since BSP_Init().
+ */
+uint64_t BSP_CycleCounter_Read64(void);
+
+/**
+ * @brief Interrupts whose execution time is accounted.
+ */
+typedef enum
+{
+    BSP_ISR_ADC1_DMA = 0, /**< ADC1 DMA, runs the block callbacks */
+    BSP_ISR_ETH,          /**< Ethernet MAC */
+    BSP_ISR_COUNT         /**< Number of accounted interrupts */
+} bsp_isr_t;
+
+/**
+ * @brief Function run on entry to and exit from an accounted handler.
+ *
+ * @param isr   Interrupt.
+ * @param enter true on entry, false on exit.
+ */
+typedef void (*bsp_isr_trace_hook_t)(bsp_isr_t isr, bool enter);
+
+/**
+ * @brief Marks the entry of an accounted interrupt handler.
+ *
+ * Called first by the handler itself; reports the entry to the trace hook.
+ *
+ * @param isr Interrupt.
+ * @return uint32_t Cycle counter at entry, for BSP_ISR_AddCycles().
+ */
+uint32_t BSP_ISR_Enter(bsp_isr_t isr);
+
+/**
+ * @brief Adds the cycles of one run of an interrupt handler.
+ *
+ * Called last by the handler itself; reports the exit to the trace hook.
+ * Time spent in a higher priority interrupt that preempted it is included.
+ *
+ * @param isr    Interrupt.
+ * @param cycles Cycles the handler ran.
+ */
+void BSP_ISR_AddCycles(bsp_isr_t isr, uint32_t cycles);
+
+/**
+ * @brief Install the trace hook of the accounted interrupts.
+ *
+ * The hook runs in the handler, so it must be short and must not block.
+ *
+ * @param hook Function to run, or NULL for none.
+ */
+void BSP_ISR_SetTraceHook(bsp_isr_trace_hook_t hook);
+
+/**
+ * @brief Returns the cycles an interrupt handler has run since BSP_Init().
+ *
+ * @param isr Interrupt.
+ * @return uint64_t Total cycles, 0 for an unknown interrupt.
+ */
+uint64_t BSP_ISR_GetCycles(bsp_isr_t isr);
+
+/** @} */ /* End of BSP_CYCLES group */
+
+/**
+ * @defgroup BSP_PROFILE PC Sampling
+ * @brief Periodic interrupt reading the code it interrupted, on TIM7.
+ *
+ * TIM7 interrupts at a fixed rate, above configMAX_SYSCALL_INTERRUPT_PRIORITY
+ * so that kernel critical sections and the other interrupt handlers are
+ * sampled too. Its handler reads the program counter and link register
+ * from the exception frame the core stacked on entry, and the exception
+ * number from the stacked xPSR, and passes them to a hook; about a hundred
+ * cycles a sample with a short hook. Code of the secure world stacks its
+ * frame on the secure stack: its samples carry no addresses.
+ *
+ * TIM7 counts on the timer clock of the full profile, so sampling holds off
+ * the idle clock profile (BSP_Clock_SetProfile()) until it is stopped. The
+ * host simulation cannot sample.
+ * @{
+ */
+
+/** @brief Lowest sample rate in Hz */
+#define BSP_PROFILE_MIN_HZ 100U
+
+/** @brief Highest sample rate in Hz */
+#define BSP_PROFILE_MAX_HZ 20000U
+
+/**
+ * @brief One sample of the interrupted code.
+ */
+typedef struct
+{
+    uint32_t pc;        /**< Interrupted instruction, 0 if secure */
+    uint32_t lr;        /**< Link register at that instruction, 0 if secure */
+    uint16_t exception; /**< Exception it ran in, 0 for thread mode */
+    bool     secure;    /**< Interrupted in the secure world */
+} bsp_profile_sample_t;
+
+/**
+ * @brief Function run by the sampling interrupt with each sample.
+ *
+ * Runs above the kernel's interrupt mask: it must not call the FreeRTOS
+ * API other than plain reads of the kernel state.
+ *
+ * @param sample Sample just taken.
+ */
+typedef void (*bsp_profile_hook_t)(const bsp_profile_sample_t *sample);
+
+/**
+ * @brief Starts sampling.
+ *
+ * @param hz   Sample rate, ::BSP_PROFILE_MIN_HZ to ::BSP_PROFILE_MAX_HZ.
+ * @param hook Function to pass the samples to.
+ * @return bsp_error_t BSP_OK if started, BSP_INVALID_ARG for a rate out of
+ *         range or no hook, BSP_BUSY if already sampling, BSP_ERROR if the
+ *         platform cannot sample.
+ */
+bsp_error_t BSP_Profile_Start(uint32_t hz, bsp_profile_hook_t hook);
+
+/**
+ * @brief Stops sampling; the hook is not run after this returns.
+ */
+void BSP_Profile_Stop(void);
+
+/**
+ * @brief TIM7 interrupt entry, reached from TIM7_IRQHandler() with the
+ *        registers that locate the exception frame.
+ *
+ * @param exc_return EXC_RETURN value of the exception (LR at entry).
+ * @param msp        Main stack pointer at entry.
+ * @param psp        Process stack pointer at entry.
+ */
+void BSP_Profile_IRQHandler(uint32_t exc_return, const uint32_t *msp,
+                            const uint32_t *psp);
+
+/** @} */ /* End of BSP_PROFILE group */
+
+/**
+ * @defgroup BSP_PVD Supply Voltage Detector
+ * @brief Early warning of a falling supply, from the programmable voltage
+ * detector (PVD).
+ *
+ * The detector compares VDD with a threshold and interrupts on both
+ * crossings, above configMAX_SYSCALL_INTERRUPT_PRIORITY and every other
+ * interrupt, so that the time left before the brown-out reset is spent in
+ * its hook. How long that is depends on the hold-up of the supply: the
+ * threshold is chosen high enough for the hook to finish above the
+ * brown-out level. The host simulation has no detector.
+ * @{
+ */
+
+/** @brief Highest threshold: 0 is about 1.95 V, each step 0.15 V more, up
+ * to about 2.85 V */
+#define BSP_PVD_LEVEL_MAX 6U
+
+/**
+ * @brief Function run by the detector interrupt on each crossing.
+ *
+ * Runs above the kernel's interrupt mask: it must not call the FreeRTOS
+ * API other than plain reads of the kernel state.
+ *
+ * @param low VDD fell below the threshold, else rose back above it.
+ */
+typedef void (*bsp_pvd_hook_t)(bool low);
+
+/**
+ * @brief Starts the detector.
+ *
+ * A supply already below the threshold is not reported until it has
+ * risen above it.
+ *
+ * @param level Threshold, 0 to ::BSP_PVD_LEVEL_MAX.
+ * @param hook  Function to run on each crossing.
+ * @return bsp_error_t BSP_OK if started, BSP_INVALID_ARG for an unknown
+ *         level or no hook, BSP_BUSY if already started, BSP_ERROR if the
+ *         platform has no detector.
+ */
+bsp_error_t BSP_PVD_Start(uint32_t level, bsp_pvd_hook_t hook);
+
+/** @brief PVD interrupt entry, called from PVD_AVD_IRQHandler(). */
+void BSP_PVD_IRQHandler(void);
+
+/** @} */ /* End of BSP_PVD group */
+
+/**
+ * @defgroup BSP_PTP PTP System Time
+ * @brief IEEE 1588 system time of the Ethernet MAC.
+ *
+ * The MAC keeps a seconds and nanoseconds counter, started in BSP_Init(),
+ * that timestamps PTP event messages on the wire (ethernetif.h) and that a
+ * PTP servo disciplines to a master clock (ptp.h): large offsets are
+ * stepped with BSP_PTP_StepNs(), the rate is trimmed with
+ * BSP_PTP_AdjustFrequency(). Until a master is followed the counter runs
+ * from the local oscillator, starting at 0.
+ *
+ * The counter is advanced by the fine update method: an accumulator adds a
+ * 32-bit addend every HCLK cycle and each overflow adds a fixed 20 ns, so
+ * the rate is trimmed in steps of about 0.25 ppb without changing the
+ * resolution.
+ * @{
+ */
+
+/** @brief Nanoseconds per second, the rollover of the nanoseconds counter */
+#define BSP_PTP_NS_PER_S 1000000000LL
+
+/** @brief Largest frequency correction BSP_PTP_AdjustFrequency() applies */
+#define BSP_PTP_MAX_ADJ_PPB 500000L
+
+/**
+ * @brief Reads the PTP system time.
+ *
+ * Two register reads in the common case; the seconds are read again when
+ * the nanoseconds rolled over in between. Callable from any context.
+ *
+ * @return uint64_t Nanoseconds of the PTP timescale, or since BSP_Init()
+ *         while no master has been followed.
+ */
+uint64_t BSP_Time_NowNs(void);
+
+/**
+ * @brief Steps the PTP system time.
+ *
+ * The offset is added in one update, which also moves the timestamps of
+ * messages still in flight; the servo discards the exchange it was used
+ * in.
+ *
+ * @param offset_ns Signed correction in nanoseconds.
+ * @return bsp_error_t BSP_OK, BSP_BUSY if the previous update has not
+ *         completed, BSP_ERROR if the time base is not running.
+ */
+bsp_error_t BSP_PTP_StepNs(int64_t offset_ns);
+
+/**
+ * @brief Trims the rate of the PTP system time.
+ *
+ * @param ppb Rate relative to the oscillator in parts per billion,
+ *            positive to run faster; clamped to ±BSP_PTP_MAX_ADJ_PPB.
+ * @return bsp_error_t BSP_OK, BSP_BUSY if the previous addend has not been
+ *         loaded, BSP_ERROR if the time base is not running.
+ */
+bsp_error_t BSP_PTP_AdjustFrequency(int32_t ppb);
+
+/** @brief Longest wait BSP_Time_SleepUntilNs() takes, in nanoseconds */
+#define BSP_TIME_MAX_SLEEP_NS 10000000LL
+
+/**
+ * @brief Task notification index used to end BSP_Time_SleepUntilNs().
+ * Shared with ::BSP_RS485_NOTIFY_INDEX, so the sleeping task must not also
+ * own the RS-485 or USB host port.
+ */
+#define BSP_TIME_NOTIFY_INDEX 2U
+
+/**
+ * @brief Blocks the calling task until the PTP system time reaches a
+ *        deadline.
+ *
+ * The wake-up is a compare interrupt of the ADC1 capture timer, so it
+ * comes within one timer tick (1 / ::BSP_ADC1_TIMESTAMP_HZ) and the
+ * interrupt latency of the deadline. The timer runs from the local
+ * oscillator: the wait is converted at the time of the call and ends late
+ * or early by the servo's frequency correction over its length, hence the
+ * short ::BSP_TIME_MAX_SLEEP_NS; sleep the bulk of a longer wait in ticks.
+ * One task at a time; Stop mode is refused meanwhile.
+ *
+ * @param deadline_ns PTP system time to wake at (BSP_Time_NowNs()).
+ * @return bsp_error_t BSP_OK once the deadline has passed (at once if it
+ *         already had), BSP_BUSY if another task is sleeping, BSP_ERROR if
+ *         the deadline lies more than ::BSP_TIME_MAX_SLEEP_NS ahead or the
+ *         time base is not running, BSP_TIMEOUT if the interrupt did not
+ *         come.
+ */
+bsp_error_t BSP_Time_SleepUntilNs(uint64_t deadline_ns);
+
+/** @brief TIM2 interrupt entry, called from TIM2_IRQHandler(). */
+void BSP_Time_IRQHandler(void);
+
+/** @} */ /* End of BSP_PTP group */
+
+/**
+ * @defgroup BSP_CACHE Data Cache and DMA Coherency
+ * @brief Hand-over of buffers between the core and the DMA masters.
+ *
+ * The Cortex-M33 has no data cache, and DCACHE1 of the STM32H563 serves
+ * only the external memory interfaces (FMC, OCTOSPI); the internal SRAM is
+ * never cached, so DMA buffers stay coherent by themselves. What remains is
+ * ordering: the core's writes to a buffer must be complete before a DMA
+ * reads it, and its reads of a buffer must not be issued before the DMA
+ * completion was seen.
+ *
+ * Drivers call these helpers at each hand-over anyway, so that a buffer in
+ * cacheable memory would still be handled. DMA buffers are placed with
+ * BSP_SECTION_DMA (bsp_sections.h), which aligns them to a cache line; their
+ * sizes are whole lines, so that maintenance of one buffer never touches its
+ * neighbours. The DMA buffers are also a non-cacheable MPU region.
+ * @{
+ */
+
+/** @brief Data cache line size in bytes, the alignment of DMA buffers */
+#define BSP_CACHE_LINE_SIZE 32U
+
+/**
+ * @brief Makes the core's writes to a buffer visible to a DMA.
+ *
+ * Called after filling a buffer and before starting the DMA that reads it.
+ * Callable from any context.
+ *
+ * @param addr Start of the buffer.
+ * @param size Size in bytes.
+ */
+void BSP_Cache_CleanRange(const void *addr, size_t size);
+
+/**
+ * @brief Makes a DMA's writes to a buffer visible to the core.
+ *
+ * Called after the DMA completed (or reached the part to be read) and
+ * before reading the buffer. Callable from any context.
+ *
+ * @param addr Start of the buffer.
+ * @param size Size in bytes.
+ */
+void BSP_Cache_InvalidateRange(void *addr, size_t size);
+
+/** @} */ /* End of BSP_CACHE group */
+
+/**
+ * @defgroup BSP_LOWPOWER Low-Power Modes
+ * @brief Timed sleep of the core on LPTIM1, the tickless idle back end.
+ *
+ * LPTIM1 runs from the LSI oscillator (32 kHz) in every state, so the time
+ * slept is known even when the core clock stops.
+ * @{
+ */
+
+/**
+ * @brief Sleep states, from shallow to deep.
+ */
+typedef enum
+{
+    BSP_SLEEP_NONE = 0,   /**< Core runs (idle loop) */
+    BSP_SLEEP_SLEEP,      /**< Core clock stopped, peripherals run */
+    BSP_SLEEP_STOP,       /**< All clocks but LSI/LSE stopped */
+    BSP_SLEEP_STATE_COUNT /**< Number of sleep states */
+} bsp_sleep_state_t;
+
+/** @brief Longest sleep BSP_LowPower_Sleep() can time, in microseconds */
+#define BSP_LOWPOWER_MAX_SLEEP_US 2000000U
+
+/** @brief Wake-up latency of Sleep: interrupt entry only */
+#define BSP_LOWPOWER_SLEEP_EXIT_US 1U
+
+/**
+ * @brief Wake-up latency of Stop, in microseconds.
+ *
+ * Regulator and HSI start plus HSE and PLL1 relock in SystemClock_Config(),
+ * estimated with margin from the datasheet figures.
+ */
+#define BSP_LOWPOWER_STOP_EXIT_US 200U
+
+/**
+ * @brief Whether the BSP can tolerate Stop mode now.
+ *
+ * Stop halts the clocks of the ADC1 acquisition (TIM1, ADC1, GPDMA1), the
+ * serial ports, the I2C bus, the PWM timers, the CAN and USB ports and the
+ * cycle counter that times input edges, so it is refused while the
+ * acquisition runs, the RS-485, CAN or USB host port is open, a PWM output
+ * runs, an input is captured, a transfer or flash write is in flight or a
+ * task waits in BSP_Time_SleepUntilNs().
+ *
+ * @return true if nothing of the BSP needs the peripheral clocks.
+ */
+bool BSP_LowPower_StopAllowed(void);
+
+/**
+ * @brief Sleeps until an interrupt or the end of a time limit.
+ *
+ * The caller masks interrupts with PRIMASK; a pending interrupt still ends
+ * the sleep and is taken once the caller unmasks. The HAL time base is
+ * suspended meanwhile. Stop restores the system clock before returning.
+ *
+ * @param state       BSP_SLEEP_SLEEP or BSP_SLEEP_STOP.
+ * @param duration_us Time limit, at most ::BSP_LOWPOWER_MAX_SLEEP_US.
+ * @return uint32_t Time slept in microseconds, 0 if no sleep was entered.
+ */
+uint32_t BSP_LowPower_Sleep(bsp_sleep_state_t state, uint32_t duration_us);
+
+/** @brief LPTIM1 interrupt entry, called from LPTIM1_IRQHandler(). */
+void BSP_LowPower_IRQHandler(void);
+
+/** @} */ /* End of BSP_LOWPOWER group */
+
+/**
+ * @defgroup BSP_CLOCK Clock Profiles
+ * @brief System clock scaled to the workload, with PLL1 kept locked.
+ *
+ * Both profiles run from PLL1 at 250 MHz; the idle one divides it by four
+ * in the AHB prescaler, which takes effect within a few bus cycles without
+ * a relock, so the switch is free of glitches. The core, the buses and the
+ * timers follow HCLK, and the switch adjusts what depends on it: the flash
+ * wait states, the kernel tick (SysTick), the HAL time base (TIM6) and the
+ * PTP addend, so the MAC system time keeps its rate and servo correction.
+ * No peripheral with a kernel clock mux runs from a PCLK: the ADCs, the
+ * serial ports (USART2, USART3, LPUART1) and I2C3 run from HSI, the SPI
+ * ports from PLL1Q, FDCAN from PLL2Q and USB from HSI48, none of which
+ * changes. The generated MSP code selects PCLK3 for I2C3 and LPUART1; the
+ * BSP moves them to HSI after their MX_*_Init(). A peripheral added later
+ * must be given a fixed kernel clock the same way, or be re-timed in the
+ * switch.
+ *
+ * The timers keep their prescalers and would count at a quarter rate, so
+ * the idle profile is refused while one of them has work: the ADC1 and SPI
+ * ADC acquisitions, a PWM output, input capture (stamped on the cycle
+ * counter), a timed sleep or PC sampling. Starting any of these brings the
+ * full profile back first.
+ * @{
+ */
+
+/**
+ * @brief Clock profiles.
+ */
+typedef enum
+{
+    BSP_CLOCK_FULL = 0,     /**< HCLK 250 MHz, acquisition and bursts */
+    BSP_CLOCK_IDLE,         /**< HCLK 62.5 MHz, polls and housekeeping */
+    BSP_CLOCK_PROFILE_COUNT /**< Number of profiles */
+} bsp_clock_profile_t;
+
+/** @brief HCLK of the full profile, in hertz */
+#define BSP_CLOCK_FULL_HZ 250000000U
+
+/** @brief HCLK of the idle profile, in hertz */
+#define BSP_CLOCK_IDLE_HZ 62500000U
+
+/**
+ * @brief Whether the idle profile can be entered now.
+ *
+ * @return false while a timer of the BSP has work, see above.
+ */
+bool BSP_Clock_IdleAllowed(void);
+
+/**
+ * @brief Switches the system clock to a profile.
+ *
+ * Runs with interrupts masked for the few microseconds of the switch.
+ * Task context only.
+ *
+ * @param profile Profile to run in.
+ * @return bsp_error_t BSP_OK once running in @p profile, BSP_BUSY if the
+ * idle profile is refused, BSP_INVALID_ARG for an unknown profile.
+ */
+bsp_error_t BSP_Clock_SetProfile(bsp_clock_profile_t profile);
+
+/**
+ * @brief Returns the profile the system clock runs in.
+ *
+ * @return bsp_clock_profile_t Current profile.
+ */
+bsp_clock_profile_t BSP_Clock_GetProfile(void);
+
+/** @} */ /* End of BSP_CLOCK group */
+
+/**
+ * @defgroup BSP_WATCHDOG Independent Watchdog
+ * @brief IWDG reset of a firmware that stops refreshing it.
+ *
+ * The IWDG runs from the LSI oscillator, in Sleep and Stop too, and once
+ * started cannot be stopped until the next reset. It is frozen while the
+ * core is halted by a debugger.
+ * @{
+ */
+
+/** @brief Longest timeout BSP_Watchdog_Start() accepts, in milliseconds */
+#define BSP_WATCHDOG_MAX_TIMEOUT_MS 8000U
+
+/**
+ * @brief Starts the independent watchdog.
+ *
+ * Also takes the reset cause for BSP_Watchdog_CausedReset() and clears the
+ * reset flags.
+ *
+ * @param timeout_ms Time without BSP_Watchdog_Kick() until the reset, 2 ms
+ *                   resolution, at most ::BSP_WATCHDOG_MAX_TIMEOUT_MS.
+ * @return bsp_error_t BSP_OK if started, BSP_INVALID_ARG for a timeout out
+ *         of range, BSP_ERROR if the new timeout did not take effect.
+ */
+bsp_error_t BSP_Watchdog_Start(uint32_t timeout_ms);
+
+/**
+ * @brief Refreshes the independent watchdog, restarting its timeout.
+ */
+void BSP_Watchdog_Kick(void);
+
+/**
+ * @brief Whether the last reset was caused by the independent watchdog.
+ *
+ * @return true if so; false before BSP_Watchdog_Start().
+ */
+bool BSP_Watchdog_CausedReset(void);
+
+/** @} */ /* End of BSP_WATCHDOG group */
 
 #endif  // BSP_H
\ No newline at end of file
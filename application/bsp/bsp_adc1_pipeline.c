@@ -0,0 +1,2010 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC1 Block Pipeline
+ *
+ * The board-independent half of the ADC1 acquisition, built into both
+ * BSPs; see bsp_adc1_pipeline.h. Everything here runs in the filter task of
+ * the BSP, or reads what it published, except the frame filter of the
+ * low-latency channels, which runs in the ADC1 interrupt.
+ */
+
+#include "bsp_adc1_pipeline.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_mains.h"
+#include "bsp_sections.h"
+#include "dsp_pipeline.h"
+#include "task.h"
+
+/*============================================================================*/
+/*                     ADC1 Pipeline Configuration                            */
+/*============================================================================*/
+
+/** @brief Normalized results a quarter of a 12-bit count inside a rail and
+ * beyond are clipped */
+#define ADC1_QUALITY_RAIL_LOW (0.25f / 4096.0f)
+#define ADC1_QUALITY_RAIL_HIGH \
+    (ADC_FILTER_TO_FLOAT(ADC_FILTER_FROM_ADC12(4095U)) - (0.25f / 4096.0f))
+
+/** @brief BSP_ADC1_QUALITY_NOISE_COUNTS squared, normalized */
+#define ADC1_QUALITY_NOISE_POWER                             \
+    (((float32_t)BSP_ADC1_QUALITY_NOISE_COUNTS / 4096.0f) * \
+     ((float32_t)BSP_ADC1_QUALITY_NOISE_COUNTS / 4096.0f))
+
+/** @brief Fewest results a block is checked for stuck and noise on, the
+ * smallest block: 16 samples at 1 kHz */
+#define ADC1_QUALITY_MIN_SAMPLES 16U
+
+/**
+ * @brief Filter the results in place
+ *
+ * With the fast q15 backend and a 14-bit result the raw result is the
+ * filter's input sample as it is (ADC_FILTER_FROM_ADC() shifts by 0), so
+ * each planar block, the DMA half itself on the board, is passed to the
+ * filter without a conversion pass.
+ */
+#if !BSP_ADC1_DUAL_MODE &&                                       \
+    (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15) &&   \
+    ((3U - ADC_FILTER_INPUT_HEADROOM_BITS) == BSP_ADC1_RESULT_EXTRA_BITS)
+#define ADC1_FILTER_IN_PLACE 1
+#else
+#define ADC1_FILTER_IN_PLACE 0
+#endif
+
+_Static_assert((BSP_ADC1_BLOCK_QUANTUM % ADC_FILTER_DECIMATION_FACTOR) == 0U,
+               "ADC1 block must be a multiple of the decimation factor");
+_Static_assert(BSP_ADC1_BLOCK_SAMPLES ==
+                   BSP_ADC1_BLOCK_SAMPLES_AT(ADC_FILTER_SAMPLE_RATE),
+               "ADC1 default block differs from the one of its rate");
+_Static_assert(BSP_ADC1_MAX_BLOCK_SAMPLES ==
+                   BSP_ADC1_BLOCK_SAMPLES_AT(ADC_FILTER_MAX_SAMPLE_RATE),
+               "ADC1 largest block differs from the one of the fastest rate");
+_Static_assert(BSP_ADC1_RESULT_BITS <= 15U,
+               "ADC1 results are converted to filter samples as q15");
+
+#if BSP_ADC1_SLOW_CHANNELS
+_Static_assert((BSP_ADC1_SLOW_CHANNELS >> BSP_ADC1_NUM_CHANNELS) == 0U,
+               "ADC1 slow channel mask names a channel that does not exist");
+_Static_assert(!ADC1_IS_SLOW(BSP_ADC1_MAINS_CHANNEL),
+               "ADC1 mains channel cannot be a slow channel");
+#endif
+
+_Static_assert((BSP_ADC1_LUT_CHANNELS >> BSP_ADC1_NUM_CHANNELS) == 0U,
+               "ADC1 table channel mask names a channel that does not exist");
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+_Static_assert((BSP_ADC1_LOW_LATENCY_CHANNELS >> BSP_ADC1_NUM_CHANNELS) == 0U,
+               "ADC1 low-latency channel mask names a channel that does not "
+               "exist");
+_Static_assert((BSP_ADC1_LOW_LATENCY_CHANNELS & BSP_ADC1_SLOW_CHANNELS) == 0U,
+               "ADC1 low-latency channels cannot be slow channels");
+
+/** @brief Slot of low-latency channel @p ch in the frame context, its rank
+ * among the low-latency channels */
+#define ADC1_LOW_LATENCY_RANK(ch) \
+    BSP_ADC1_COUNT_BITS(BSP_ADC1_LOW_LATENCY_CHANNELS & ((1UL << (ch)) - 1U))
+#endif
+
+/*============================================================================*/
+/*                     Filtered ADC Private Variables                         */
+/*============================================================================*/
+
+/** @brief Filter context for all ADC channels, sized to the largest
+ * block; the slots of the slow channels only keep their banks */
+ADC_FILTER_CONTEXT_DEFINE(g_adc_filter_ctx, ADC_FILTER_COEFFS_DEFAULT,
+                          BSP_ADC1_NUM_CHANNELS, BSP_ADC1_MAX_BLOCK_SAMPLES);
+
+#if BSP_ADC1_SLOW_CHANNELS
+/** @brief Filter context of the slow channels, one slot per slow channel in
+ * channel order, taking the conversions since the previous block in one
+ * go */
+ADC_FILTER_CONTEXT_DEFINE(g_slow_filter_ctx, ADC_FILTER_COEFFS_SLOW,
+                          BSP_ADC1_NUM_SLOW_CHANNELS, ADC1_SLOW_RING_SIZE);
+
+/** @brief Last raw result of each slow channel, repeated in the rings
+ * (filter task only) */
+static uint16_t g_slow_held_raw[BSP_ADC1_NUM_CHANNELS];
+#endif
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+/** @brief Frame filter context of the low-latency channels, one slot per
+ * channel in channel order (ADC1 interrupt only, but for the coefficient
+ * set and the banks) */
+ADC_FILTER_CONTEXT_DEFINE(g_ll_filter_ctx, ADC_FILTER_COEFFS_DEFAULT,
+                          BSP_ADC1_NUM_LOW_LATENCY_CHANNELS,
+                          BSP_ADC1_BLOCK_QUANTUM);
+
+/** @brief Calibrated samples of the low-latency channels per frame of the
+ * DMA buffer, written by the interrupt and taken by the block filter */
+static float32_t g_ll_frames[ADC1_LOW_LATENCY_SLOTS]
+                            [BSP_ADC1_NUM_LOW_LATENCY_CHANNELS];
+
+/** @brief Low-latency channels to warm start at their next frame (bit n =
+ * channel n); set in critical sections, cleared by the interrupt */
+static volatile uint32_t g_ll_warm_pending = 0U;
+
+/** @brief Sample hook, run by the interrupt on every frame */
+static volatile bsp_adc1_sample_hook_t g_sample_hook = NULL;
+
+/** @brief Sample alarm hook, run by the filter task on request */
+static volatile bsp_adc1_sample_alarm_hook_t g_sample_alarm_hook = NULL;
+#endif
+
+/** @brief Filtered output values for all channels (continuously updated) */
+static volatile float32_t g_filtered_values[BSP_ADC1_NUM_CHANNELS];
+
+/** @brief BSP_ADC1_QUALITY_* bits of each channel's last block */
+static volatile uint8_t g_adc1_quality[BSP_ADC1_NUM_CHANNELS];
+
+/** @brief Sample counter since filter initialization (for settling detection)
+ */
+static volatile uint32_t g_filter_sample_count = 0;
+
+volatile bool     g_filter_initialized    = false;
+volatile uint32_t g_filter_block_overruns = 0U;
+volatile uint32_t g_filter_warm_pending   = 0U;
+volatile uint32_t g_adc1_recoveries       = 0U;
+
+/** @brief Samples never converted, the sum of the gaps between blocks */
+static volatile uint32_t g_adc1_missed_samples = 0U;
+
+/** @brief Sequence numbers skipped so far, the sum of all gaps (filter task
+ * only) */
+static uint32_t g_sequence_skip = 0U;
+
+/** @brief Capture time due for the block after the previous one filtered,
+ * one block on at its rate (filter task only) */
+static uint64_t g_next_capture = 0U;
+
+/** @brief g_next_capture is set (filter task only) */
+static bool g_next_capture_valid = false;
+
+/** @brief Levels of the captured inputs as of the last frame published,
+ * bit n = DIn (filter task only) */
+static uint8_t g_di_level = 0U;
+
+/** @brief Inputs captured for the last block, bit n = DIn (filter task
+ * only) */
+static uint8_t g_di_selected = 0U;
+
+/** @brief Blocks published so far, the index of the next block's
+ * timestamp slot */
+static volatile uint32_t g_block_count = 0U;
+
+#if BSP_ADC1_DUAL_MODE
+/** @brief Results of one channel unpacked from the ADC1/ADC2 pairs */
+static q15_t g_filter_block_raw[BSP_ADC1_MAX_BLOCK_SAMPLES];
+#endif
+
+/** @brief Input block of the mains channel, normalized to float */
+static float32_t g_mains_block_float[BSP_ADC1_MAX_BLOCK_SAMPLES];
+
+/** @brief Flag requesting mains frequency tracking */
+static volatile bool g_mains_tracking = false;
+
+/** @brief Bank providing the LPF stages and nominal mains frequency */
+static volatile uint8_t g_mains_base_bank = ADC_FILTER_DEFAULT_BANK;
+
+/** @brief Base bank the estimator runs for, ADC_FILTER_NUM_BANKS if idle
+ * (filter task only) */
+static uint8_t g_mains_tracked_bank = ADC_FILTER_NUM_BANKS;
+
+/** @brief Overrun count seen by the estimator (filter task only) */
+static uint32_t g_mains_overruns = 0U;
+
+/** @brief Mains frequency estimator (filter task only) */
+static adc_filter_mains_t g_mains;
+
+/** @brief Function run after each filtered block, NULL for none */
+static volatile bsp_adc1_block_hook_t g_block_hook = NULL;
+
+/** @brief Time statistics of the sample path (written by the filter task) */
+static bsp_adc1_latency_t g_latency[BSP_ADC1_LATENCY_COUNT];
+
+/** @brief Calibration of one channel */
+typedef struct
+{
+    float32_t gain;   /**< Units per full scale */
+    float32_t offset; /**< Units at a reading of 0 */
+    uint32_t  points; /**< Linearization points, 0 for none */
+    float32_t table[BSP_ADC1_LINEARIZATION_MAX_POINTS]; /**< Corrected values */
+} adc1_calibration_t;
+
+/** @brief Calibration requested per channel */
+static adc1_calibration_t g_cal_pending[BSP_ADC1_NUM_CHANNELS];
+
+/** @brief Incremented on every change of a channel's requested calibration */
+static volatile uint32_t g_cal_generation[BSP_ADC1_NUM_CHANNELS];
+
+/** @brief Calibration in use per channel (filter task only) */
+static adc1_calibration_t g_cal[BSP_ADC1_NUM_CHANNELS];
+
+/** @brief Generation of g_cal per channel (filter task only) */
+static uint32_t g_cal_applied[BSP_ADC1_NUM_CHANNELS];
+
+/** @brief Interpolation over g_cal[].table (filter task only) */
+static arm_linear_interp_instance_f32 g_cal_interp[BSP_ADC1_NUM_CHANNELS];
+
+#if BSP_ADC1_LUT_CHANNELS
+/** @brief Number of channels in BSP_ADC1_LUT_CHANNELS */
+#define ADC1_NUM_LUTS BSP_ADC1_COUNT_BITS(BSP_ADC1_LUT_CHANNELS)
+
+/** @brief Channel @p ch has a conversion table */
+#define ADC1_HAS_LUT(ch) (((BSP_ADC1_LUT_CHANNELS >> (ch)) & 1U) != 0U)
+
+/** @brief Table of channel @p ch: the channels of the mask below it come
+ * first */
+#define ADC1_LUT_SLOT(ch) \
+    BSP_ADC1_COUNT_BITS(BSP_ADC1_LUT_CHANNELS & ((1UL << (ch)) - 1U))
+
+/** @brief Entries built at a time, on the filter task's stack */
+#define ADC1_LUT_CHUNK 64U
+
+/** @brief Conversion tables, raw code to calibrated value (written by the
+ * filter task) */
+static float32_t g_cal_lut[ADC1_NUM_LUTS][BSP_ADC1_LUT_SIZE]
+    BSP_SECTION_FASTBSS;
+#endif
+
+/*============================================================================*/
+/*                     ADC1 Sample Ring Private Variables                     */
+/*============================================================================*/
+
+/** @brief Index mask for the sample ring (size is a power of two) */
+#define ADC1_RING_MASK (BSP_ADC1_RING_SIZE - 1U)
+
+/** @brief Index mask for the decimated ring (size is a power of two) */
+#define ADC1_DECIMATED_RING_MASK (BSP_ADC1_DECIMATED_RING_SIZE - 1U)
+
+_Static_assert((BSP_ADC1_RING_SIZE & ADC1_RING_MASK) == 0U,
+               "ADC1 ring size must be a power of two");
+_Static_assert(BSP_ADC1_RING_SIZE >= (2U * BSP_ADC1_MAX_BLOCK_SAMPLES),
+               "ADC1 ring must hold at least two blocks");
+_Static_assert((BSP_ADC1_DECIMATED_RING_SIZE & ADC1_DECIMATED_RING_MASK) ==
+                   0U,
+               "ADC1 decimated ring size must be a power of two");
+_Static_assert(BSP_ADC1_DECIMATED_RING_SIZE >=
+                   (2U * ADC1_MAX_DECIMATED_BLOCK_SAMPLES),
+               "ADC1 decimated ring must hold at least two blocks");
+
+/** @brief Blocks kept in the timestamp history (power of two): enough
+ * to cover the rings with the smallest blocks */
+#define ADC1_TIME_RING_SIZE 64U
+
+/** @brief Index mask for the timestamp history */
+#define ADC1_TIME_RING_MASK (ADC1_TIME_RING_SIZE - 1U)
+
+_Static_assert((ADC1_TIME_RING_SIZE & ADC1_TIME_RING_MASK) == 0U,
+               "ADC1 timestamp history size must be a power of two");
+_Static_assert((ADC1_TIME_RING_SIZE * BSP_ADC1_BLOCK_QUANTUM) >=
+                   (BSP_ADC1_RING_SIZE + BSP_ADC1_MAX_BLOCK_SAMPLES),
+               "ADC1 timestamp history must cover the sample ring");
+_Static_assert((ADC1_TIME_RING_SIZE * BSP_ADC1_BLOCK_QUANTUM) >=
+                   ((BSP_ADC1_DECIMATED_RING_SIZE *
+                     ADC_FILTER_DECIMATION_FACTOR) +
+                    BSP_ADC1_MAX_BLOCK_SAMPLES),
+               "ADC1 timestamp history must cover the decimated ring");
+
+/**
+ * @brief Geometry of one sample stream's ring
+ */
+typedef struct
+{
+    bsp_adc1_sample_t *entries; /**< Ring storage */
+    volatile uint32_t *head;    /**< Index of the next entry to publish */
+    uint32_t           size;    /**< Number of entries (power of two) */
+    uint32_t           block;   /**< Most entries published per block */
+} adc1_ring_t;
+
+/**
+ * @brief Timestamped sample history written by the filter task
+ *
+ * Single producer, any number of readers. Entries are published a whole
+ * block at a time by advancing g_ring_head; readers never write here.
+ */
+static bsp_adc1_sample_t g_ring[BSP_ADC1_RING_SIZE];
+
+/** @brief Sequence number of the next sample to publish */
+static volatile uint32_t g_ring_head = 0U;
+
+/** @brief Decimated sample history, one entry per decimation period */
+static bsp_adc1_sample_t g_decimated_ring[BSP_ADC1_DECIMATED_RING_SIZE];
+
+/** @brief Index of the next decimated entry to publish */
+static volatile uint32_t g_decimated_ring_head = 0U;
+
+/**
+ * @brief Capture time of the recently published blocks
+ *
+ * Written by the filter task next to the ring entries, read lock-free:
+ * the block index is set to ADC1_TIME_SLOT_BUSY while the slot is
+ * rewritten. Slots are indexed by block, not by sequence, as a gap moves
+ * the sequence of every later block and a change of sample rate the size
+ * of the blocks.
+ */
+static adc1_block_time_t g_block_times[ADC1_TIME_RING_SIZE];
+
+/** @brief Ring of each bsp_adc1_stream_t stream */
+static const adc1_ring_t g_rings[BSP_ADC1_STREAM_COUNT] = {
+    [BSP_ADC1_STREAM_FULL]      = {g_ring, &g_ring_head, BSP_ADC1_RING_SIZE,
+                                   BSP_ADC1_MAX_BLOCK_SAMPLES},
+    [BSP_ADC1_STREAM_DECIMATED] = {g_decimated_ring, &g_decimated_ring_head,
+                                   BSP_ADC1_DECIMATED_RING_SIZE,
+                                   ADC1_MAX_DECIMATED_BLOCK_SAMPLES},
+};
+
+/*============================================================================*/
+/*                     Filtered ADC1 Functions (Continuous Mode)              */
+/*============================================================================*/
+
+/**
+ * @brief Look up the capture time of a sample in the timestamp history
+ * @param sequence Sample sequence number
+ * @param time     Capture time, interpolated at the trigger period of the
+ *                 block
+ * @param time_ns  Capture time on the PTP timescale, or NULL
+ * @return true if the sample's block is in the history, false otherwise
+ *
+ * Blocks are searched newest first; a sample is usually one of the last
+ * few blocks. A sequence in a gap between two blocks has no time.
+ */
+static bool adc1_lookup_time(uint32_t sequence, uint64_t *time,
+                             uint64_t *time_ns)
+{
+    uint32_t blocks = g_block_count;
+
+    for (uint32_t n = 0U; (n < ADC1_TIME_RING_SIZE) && (n < blocks); n++)
+    {
+        uint32_t                 block = blocks - 1U - n;
+        const adc1_block_time_t *slot =
+            &g_block_times[block & ADC1_TIME_RING_MASK];
+        uint32_t before;
+        uint32_t after;
+        uint32_t first;
+        uint32_t samples;
+        uint32_t period;
+        uint32_t offset;
+        uint64_t capture;
+        uint64_t capture_ns;
+
+        before = slot->block;
+        __DMB();
+        first      = slot->sequence;
+        samples    = slot->samples;
+        period     = slot->period;
+        capture    = slot->time;
+        capture_ns = slot->time_ns;
+        __DMB();
+        after = slot->block;
+
+        if ((before != block) || (after != block))
+        {
+            /* Rewritten for a newer block meanwhile */
+            return false;
+        }
+
+        offset = sequence - first;
+        if ((int32_t)offset < 0)
+        {
+            continue;
+        }
+        if (offset >= samples)
+        {
+            return false;
+        }
+
+        *time = capture + ((uint64_t)offset * period);
+        if (time_ns != NULL)
+        {
+            *time_ns = capture_ns +
+                       ((uint64_t)offset * period * ADC1_TIMESTAMP_NS);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Select a bank for every channel (filter task only)
+ * @param bank Bank index, or ADC_FILTER_TRACKING_BANK
+ */
+static void adc1_select_bank_all(uint8_t bank)
+{
+    for (uint8_t ch = 0; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        (void)adc_filter_select_bank(&g_adc_filter_ctx, ch, bank);
+    }
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    for (uint8_t k = 0; k < BSP_ADC1_NUM_LOW_LATENCY_CHANNELS; k++)
+    {
+        (void)adc_filter_select_bank(&g_ll_filter_ctx, k, bank);
+    }
+#endif
+}
+
+/**
+ * @brief Retune the tracking bank of every filter context (filter task
+ * only)
+ * @param base     Bank providing the LPF stages
+ * @param mains_hz Mains frequency, Hz
+ *
+ * The interrupt filters the low-latency channels with the tracking buffer
+ * published, never the one being filled.
+ */
+static void adc1_retune_mains(uint8_t base, float32_t mains_hz)
+{
+    (void)adc_filter_retune_mains(&g_adc_filter_ctx, base, mains_hz);
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    (void)adc_filter_retune_mains(&g_ll_filter_ctx, base, mains_hz);
+#endif
+}
+
+/**
+ * @brief Get the filter input block of one channel of a block
+ * @param in        The block
+ * @param ch        Channel index
+ * @param converted Room for one block of converted samples
+ * @return The block's samples in the backend's format
+ *
+ * With a single ADC the channel's results are contiguous: they are either
+ * the input as they are (ADC1_FILTER_IN_PLACE) or converted into
+ * @p converted by adc_filter_from_adc_block(). In dual mode they are
+ * unpacked from the ADC1/ADC2 pairs first.
+ */
+static const adc_filter_sample_t *adc1_filter_input(
+    const adc1_pipeline_block_t *in, uint8_t ch,
+    adc_filter_sample_t *converted)
+{
+#if ADC1_FILTER_IN_PLACE
+    (void)converted;
+    return (const adc_filter_sample_t *)in->raw[ch];
+#else
+    uint32_t samples = in->samples;
+#if BSP_ADC1_DUAL_MODE
+    const q15_t *raw = g_filter_block_raw;
+
+    for (uint32_t i = 0U; i < samples; i++)
+    {
+        g_filter_block_raw[i] = (q15_t)in->raw[ch][i * ADC1_PIPELINE_STRIDE];
+    }
+#else
+    const q15_t *raw = (const q15_t *)in->raw[ch];
+#endif
+
+    adc_filter_from_adc_block(raw, converted, BSP_ADC1_RESULT_EXTRA_BITS,
+                              samples);
+
+    return converted;
+#endif
+}
+
+/**
+ * @brief Run mains tracking on the mains channel block
+ * @param input Filter input block of BSP_ADC1_MAINS_CHANNEL
+ * @param count Samples in the block
+ *
+ * Starts and stops tracking as requested, feeds the block to the
+ * estimator and retunes the tracking bank on every new estimate. Called
+ * before the mains channel is filtered, so a retune applies to the block
+ * that produced it.
+ */
+static void adc1_mains_track(const adc_filter_sample_t *input, uint32_t count)
+{
+    uint8_t base = g_mains_base_bank;
+
+    if (!g_mains_tracking)
+    {
+        if (g_mains_tracked_bank != ADC_FILTER_NUM_BANKS)
+        {
+            adc1_select_bank_all(base);
+            g_mains_tracked_bank = ADC_FILTER_NUM_BANKS;
+        }
+        return;
+    }
+
+    if (base != g_mains_tracked_bank)
+    {
+        /* (Re)start at the nominal frequency of the base bank */
+        adc_filter_mains_init(&g_mains,
+                              (float32_t)adc_filter_bank_mains_freq[base],
+                              BSP_ADC1_GetSampleRate());
+        adc1_retune_mains(base, adc_filter_mains_get_frequency(&g_mains));
+        adc1_select_bank_all(ADC_FILTER_TRACKING_BANK);
+        g_mains_tracked_bank = base;
+        g_mains_overruns     = g_filter_block_overruns;
+    }
+
+    if (g_filter_block_overruns != g_mains_overruns)
+    {
+        /* Lost blocks break the phase reference between windows */
+        adc_filter_mains_restart(&g_mains);
+        g_mains_overruns = g_filter_block_overruns;
+    }
+
+    adc_filter_to_float_block(input, g_mains_block_float, count);
+
+    if (adc_filter_mains_process(&g_mains, g_mains_block_float, count))
+    {
+        adc1_retune_mains(base, adc_filter_mains_get_frequency(&g_mains));
+    }
+}
+
+/**
+ * @brief Take normalized values of one channel to engineering units in
+ * place, with the calibration in use
+ * @param ch     Channel index
+ * @param values Normalized values
+ * @param count  Values in @p values
+ */
+static void adc1_calibrate_values(uint8_t ch, float32_t *values,
+                                  uint32_t count)
+{
+    const adc1_calibration_t *cal = &g_cal[ch];
+
+    if (cal->points >= 2U)
+    {
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            values[i] = arm_linear_interp_f32(&g_cal_interp[ch], values[i]);
+        }
+    }
+
+    arm_scale_f32(values, cal->gain, values, count);
+    arm_offset_f32(values, cal->offset, values, count);
+}
+
+/**
+ * @brief Point the interpolation of one channel at its calibration table
+ * @param ch Channel index
+ *
+ * Together with the copy into g_cal, so the interrupt never calibrates with
+ * half of a change.
+ */
+static void adc1_calibration_interp(uint8_t ch)
+{
+    const adc1_calibration_t *cal = &g_cal[ch];
+
+    if (cal->points >= 2U)
+    {
+        g_cal_interp[ch].nValues  = cal->points;
+        g_cal_interp[ch].x1       = 0.0f;
+        g_cal_interp[ch].xSpacing = 1.0f / (float32_t)(cal->points - 1U);
+        g_cal_interp[ch].pYData   = cal->table;
+    }
+}
+
+/**
+ * @brief Set up the calibration just put in use for one channel
+ * @param ch Channel index
+ *
+ * Rebuilds the channel's conversion table, in chunks so that a reader
+ * meanwhile never sees a normalized value.
+ */
+static void adc1_calibration_changed(uint8_t ch)
+{
+#if BSP_ADC1_LUT_CHANNELS
+    if (ADC1_HAS_LUT(ch))
+    {
+        float32_t *lut = g_cal_lut[ADC1_LUT_SLOT(ch)];
+        float32_t  chunk[ADC1_LUT_CHUNK];
+
+        for (uint32_t code = 0U; code < BSP_ADC1_LUT_SIZE;
+             code += ADC1_LUT_CHUNK)
+        {
+            for (uint32_t i = 0U; i < ADC1_LUT_CHUNK; i++)
+            {
+                chunk[i] = (float32_t)(code + i) / 4095.0f;
+            }
+            adc1_calibrate_values(ch, chunk, ADC1_LUT_CHUNK);
+            for (uint32_t i = 0U; i < ADC1_LUT_CHUNK; i++)
+            {
+                lut[code + i] = chunk[i]; /* One 32-bit store each */
+            }
+        }
+    }
+#else
+    (void)ch;
+#endif
+}
+
+/**
+ * @brief Put a new calibration of one channel in use, if there is one
+ * @param ch Channel index
+ */
+static void adc1_calibration_update(uint8_t ch)
+{
+    if (g_cal_generation[ch] != g_cal_applied[ch])
+    {
+        taskENTER_CRITICAL();
+        g_cal[ch]         = g_cal_pending[ch];
+        g_cal_applied[ch] = g_cal_generation[ch];
+        adc1_calibration_interp(ch);
+        taskEXIT_CRITICAL();
+
+        adc1_calibration_changed(ch);
+    }
+}
+
+/**
+ * @brief Calibrate one channel's filtered block in place
+ * @param ch    Channel index
+ * @param block Normalized values
+ * @param count Values in @p block
+ *
+ * Picks up a new calibration of the channel first, so a block is never
+ * calibrated half with the old one.
+ */
+static void adc1_calibrate_block(uint8_t ch, float32_t *block, uint32_t count)
+{
+    adc1_calibration_update(ch);
+
+    adc1_calibrate_values(ch, block, count);
+}
+
+/**
+ * @brief Add one stage time of a block (filter task, interrupts masked)
+ */
+static void adc1_latency_add(bsp_adc1_latency_stage_t stage, uint32_t cycles)
+{
+    bsp_adc1_latency_t *latency = &g_latency[stage];
+    uint32_t            bucket  = 0U;
+
+    if ((cycles >> BSP_ADC1_LATENCY_MIN_SHIFT) != 0U)
+    {
+        bucket = 32U - __CLZ(cycles >> BSP_ADC1_LATENCY_MIN_SHIFT);
+        if (bucket >= BSP_ADC1_LATENCY_BUCKETS)
+        {
+            bucket = BSP_ADC1_LATENCY_BUCKETS - 1U;
+        }
+    }
+
+    if ((latency->count == 0U) || (cycles < latency->min_cycles))
+    {
+        latency->min_cycles = cycles;
+    }
+    if (cycles > latency->max_cycles)
+    {
+        latency->max_cycles = cycles;
+    }
+    latency->count++;
+    latency->sum_cycles += cycles;
+    latency->buckets[bucket]++;
+}
+
+/**
+ * @brief Time the stages of a filtered block (filter task only)
+ * @param in        The block, with the instants the hardware layer took
+ * @param start     Cycle counter when the filter task started the block
+ * @param published Cycle counter once the block was published
+ * @param done      Cycle counter once the block hook returned
+ */
+static void adc1_latency_record(const adc1_pipeline_block_t *in,
+                                uint32_t start, uint32_t published,
+                                uint32_t done)
+{
+    taskENTER_CRITICAL();
+    adc1_latency_add(BSP_ADC1_LATENCY_CONVERSION, in->conversion);
+    adc1_latency_add(BSP_ADC1_LATENCY_CALLBACK, in->callback - in->ready);
+    adc1_latency_add(BSP_ADC1_LATENCY_WAKE, start - in->callback);
+    adc1_latency_add(BSP_ADC1_LATENCY_FILTER, published - start);
+    adc1_latency_add(BSP_ADC1_LATENCY_HOOK, done - published);
+    adc1_latency_add(BSP_ADC1_LATENCY_TOTAL,
+                     in->conversion + (done - in->ready));
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief A block on its way through the block pipeline
+ */
+typedef struct
+{
+    /** The block's results and timing */
+    const adc1_pipeline_block_t *in;
+
+    /** Full-rate ring slot of its first sample */
+    uint32_t head;
+
+    /** Decimated ring slot of its first output */
+    uint32_t decimated_head;
+
+    uint32_t  warm; /**< Channels to warm start, one bit each */
+    uint8_t   quality[BSP_ADC1_NUM_CHANNELS]; /**< BSP_ADC1_QUALITY_* bits */
+    float32_t latest[BSP_ADC1_NUM_CHANNELS];  /**< Last calibrated values */
+} adc1_block_t;
+
+/**
+ * @brief Check a block of normalized results
+ * @param x     Results, 0.0 to 1.0; centred on their mean on return
+ * @param count Results in the block
+ * @return BSP_ADC1_QUALITY_* bits of the block
+ *
+ * The noise is estimated from the differences of neighbouring results,
+ * white noise of variance s^2 giving differences of variance 2 s^2. Their
+ * sum of squares follows from the power and the lag-one product of the
+ * centred block, so no kernel needs a second buffer.
+ */
+static uint8_t adc1_block_quality(float32_t *x, uint32_t count)
+{
+    uint8_t   quality = 0U;
+    float32_t min;
+    float32_t max;
+    float32_t var;
+    float32_t mean;
+    float32_t lag;
+    float32_t diff;
+    uint32_t  index;
+
+    arm_min_f32(x, count, &min, &index);
+    arm_max_f32(x, count, &max, &index);
+    if ((min < ADC1_QUALITY_RAIL_LOW) || (max > ADC1_QUALITY_RAIL_HIGH))
+    {
+        quality |= BSP_ADC1_QUALITY_CLIPPED;
+    }
+
+    if (count < ADC1_QUALITY_MIN_SAMPLES)
+    {
+        return quality;
+    }
+
+    arm_var_f32(x, count, &var);
+    if (var <= 0.0f)
+    {
+        return quality | BSP_ADC1_QUALITY_STUCK;
+    }
+
+    arm_mean_f32(x, count, &mean);
+    arm_offset_f32(x, -mean, x, count);
+    arm_dot_prod_f32(x, &x[1], count - 1U, &lag);
+
+    /* Twice the power of the centred block less its end results, less
+     * twice the lag-one product */
+    diff = (2.0f * var * (float32_t)(count - 1U)) - (x[0] * x[0]) -
+           (x[count - 1U] * x[count - 1U]) - (2.0f * lag);
+    if (diff > (2.0f * ADC1_QUALITY_NOISE_POWER * (float32_t)(count - 1U)))
+    {
+        quality |= BSP_ADC1_QUALITY_NOISY;
+    }
+
+    return quality;
+}
+
+#if BSP_ADC1_SLOW_CHANNELS
+/**
+ * @brief Repeat a slow channel's last values in the ring slots of a block
+ * @param ring  Full-rate or decimated ring
+ * @param mask  Index mask of the ring
+ * @param head  Slot of the block's first sample
+ * @param count Samples of the block in the ring
+ * @param ch    Slow channel
+ */
+static void adc1_publish_held(bsp_adc1_sample_t *ring, uint32_t mask,
+                              uint32_t head, uint32_t count, uint8_t ch)
+{
+    uint16_t  raw      = g_slow_held_raw[ch];
+    uint8_t   quality  = g_adc1_quality[ch];
+    float32_t filtered = g_filtered_values[ch];
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        bsp_adc1_sample_t *entry = &ring[(head + i) & mask];
+
+        entry->raw[ch]      = raw;
+        entry->quality[ch]  = quality;
+        entry->filtered[ch] = filtered;
+    }
+}
+#endif
+
+/**
+ * @brief Pipeline stage: the channel's results as filter samples
+ *
+ * Converted into the free buffer, or the results themselves with
+ * ADC1_FILTER_IN_PLACE.
+ */
+static void adc1_stage_convert(void *context, uint32_t channel,
+                               dsp_pipeline_block_t *block, void *free_buffer)
+{
+    const adc1_block_t *b = (const adc1_block_t *)context;
+
+    /* A slow channel has no block; the later stages pass it over */
+    if (ADC1_IS_SLOW(channel))
+    {
+        block->length = 0U;
+        return;
+    }
+
+    block->data   = (void *)adc1_filter_input(
+        b->in, (uint8_t)channel, (adc_filter_sample_t *)free_buffer);
+    block->length = b->in->samples;
+}
+
+/**
+ * @brief Pipeline stage: the quality checks, with the free buffer as
+ * scratch
+ *
+ * Reads the block and leaves it.
+ */
+static void adc1_stage_quality(void *context, uint32_t channel,
+                               dsp_pipeline_block_t *block, void *free_buffer)
+{
+    adc1_block_t *b       = (adc1_block_t *)context;
+    float32_t    *scratch = (float32_t *)free_buffer;
+
+    if (block->length == 0U)
+    {
+        b->quality[channel] = g_adc1_quality[channel];
+        return;
+    }
+
+    adc_filter_to_float_block((const adc_filter_sample_t *)block->data,
+                              scratch, block->length);
+    b->quality[channel]     = adc1_block_quality(scratch, block->length);
+    g_adc1_quality[channel] = b->quality[channel];
+}
+
+/**
+ * @brief Pipeline stage: mains tracking on the raw mains channel
+ *
+ * Runs before the channel is filtered, so a retune applies to the block
+ * that produced it.
+ */
+static void adc1_stage_mains(void *context, uint32_t channel,
+                             dsp_pipeline_block_t *block, void *free_buffer)
+{
+    (void)context;
+    (void)free_buffer;
+
+    if (channel == BSP_ADC1_MAINS_CHANNEL)
+    {
+        adc1_mains_track((const adc_filter_sample_t *)block->data,
+                         block->length);
+    }
+}
+
+/**
+ * @brief Pipeline stage: the biquad cascade, into the free buffer
+ *
+ * A low-latency channel takes the calibrated samples the interrupt filtered
+ * instead, as floats.
+ */
+static void adc1_stage_filter(void *context, uint32_t channel,
+                              dsp_pipeline_block_t *block, void *free_buffer)
+{
+    const adc1_block_t        *b     = (const adc1_block_t *)context;
+    const adc_filter_sample_t *input = (const adc_filter_sample_t *)block->data;
+
+    if (block->length == 0U)
+    {
+        return;
+    }
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    if (ADC1_IS_LOW_LATENCY(channel))
+    {
+        float32_t *output = (float32_t *)free_buffer;
+        uint32_t   rank   = ADC1_LOW_LATENCY_RANK(channel);
+
+        for (uint32_t i = 0U; i < block->length; i++)
+        {
+            output[i] = g_ll_frames[b->in->slot + i][rank];
+        }
+        block->data = free_buffer;
+        return;
+    }
+#endif
+
+    /* Restart as if the first sample had always been the input */
+    if ((b->warm & (1UL << channel)) != 0U)
+    {
+        adc_filter_warm_start(&g_adc_filter_ctx, (uint8_t)channel, input[0]);
+    }
+
+    adc_filter_process_block(&g_adc_filter_ctx, (uint8_t)channel, input,
+                             (adc_filter_sample_t *)free_buffer,
+                             block->length);
+    block->data = free_buffer;
+}
+
+/**
+ * @brief Pipeline stage: normalize to float and calibrate
+ *
+ * The last value of the block becomes the channel's filtered value.
+ */
+static void adc1_stage_calibrate(void *context, uint32_t channel,
+                                 dsp_pipeline_block_t *block, void *free_buffer)
+{
+    adc1_block_t *b      = (adc1_block_t *)context;
+    float32_t    *output = (float32_t *)free_buffer;
+
+    if (block->length == 0U)
+    {
+        b->latest[channel] = g_filtered_values[channel];
+        return;
+    }
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    if (ADC1_IS_LOW_LATENCY(channel))
+    {
+        /* Calibrated by the interrupt; a new calibration applies to the
+         * frames from here on */
+        adc1_calibration_update((uint8_t)channel);
+        output = (float32_t *)block->data;
+    }
+    else
+#endif
+    {
+        adc_filter_to_float_block((const adc_filter_sample_t *)block->data,
+                                  output, block->length);
+        adc1_calibrate_block((uint8_t)channel, output, block->length);
+    }
+
+    b->latest[channel]         = output[block->length - 1U];
+    g_filtered_values[channel] = b->latest[channel];
+    block->data                = output;
+}
+
+/**
+ * @brief Pipeline stage: fill the channel's unpublished full-rate slots
+ */
+static void adc1_stage_publish(void *context, uint32_t channel,
+                               dsp_pipeline_block_t *block, void *free_buffer)
+{
+    const adc1_block_t *b        = (const adc1_block_t *)context;
+    const float32_t    *filtered = (const float32_t *)block->data;
+    const uint16_t     *raw      = b->in->raw[channel];
+
+    (void)free_buffer;
+
+#if BSP_ADC1_SLOW_CHANNELS
+    if (ADC1_IS_SLOW(channel))
+    {
+        adc1_publish_held(g_ring, ADC1_RING_MASK, b->head, b->in->samples,
+                          (uint8_t)channel);
+        return;
+    }
+#endif
+
+    for (uint32_t i = 0U; i < block->length; i++)
+    {
+        bsp_adc1_sample_t *entry = &g_ring[(b->head + i) & ADC1_RING_MASK];
+
+        entry->raw[channel]      = raw[i * ADC1_PIPELINE_STRIDE];
+        entry->quality[channel]  = b->quality[channel];
+        entry->filtered[channel] = filtered[i];
+    }
+}
+
+/**
+ * @brief Pipeline stage: the FIR decimator, into the free buffer
+ */
+static void adc1_stage_decimate(void *context, uint32_t channel,
+                                dsp_pipeline_block_t *block, void *free_buffer)
+{
+    const adc1_block_t *b     = (const adc1_block_t *)context;
+    const float32_t    *input = (const float32_t *)block->data;
+
+    if (block->length == 0U)
+    {
+        return;
+    }
+
+    if ((b->warm & (1UL << channel)) != 0U)
+    {
+        adc_filter_warm_start_decimator(&g_adc_filter_ctx, (uint8_t)channel,
+                                        input[0]);
+    }
+
+    block->length = adc_filter_decimate_block(
+        &g_adc_filter_ctx, (uint8_t)channel, input, (float32_t *)free_buffer,
+        block->length);
+    block->data = free_buffer;
+}
+
+/**
+ * @brief Pipeline stage: fill the channel's unpublished decimated slots
+ *
+ * Each decimated output lines up with the last input of its period.
+ */
+static void adc1_stage_publish_decimated(void *context, uint32_t channel,
+                                         dsp_pipeline_block_t *block,
+                                         void                 *free_buffer)
+{
+    const adc1_block_t *b         = (const adc1_block_t *)context;
+    const float32_t    *decimated = (const float32_t *)block->data;
+    const uint16_t     *raw       = b->in->raw[channel];
+
+    (void)free_buffer;
+
+#if BSP_ADC1_SLOW_CHANNELS
+    if (ADC1_IS_SLOW(channel))
+    {
+        adc1_publish_held(g_decimated_ring, ADC1_DECIMATED_RING_MASK,
+                          b->decimated_head,
+                          b->in->samples / ADC_FILTER_DECIMATION_FACTOR,
+                          (uint8_t)channel);
+        return;
+    }
+#endif
+
+    for (uint32_t k = 0U; k < block->length; k++)
+    {
+        uint32_t last = ((k + 1U) * ADC_FILTER_DECIMATION_FACTOR) - 1U;
+        bsp_adc1_sample_t *entry =
+            &g_decimated_ring[(b->decimated_head + k) &
+                              ADC1_DECIMATED_RING_MASK];
+
+        entry->raw[channel]      = raw[last * ADC1_PIPELINE_STRIDE];
+        entry->quality[channel]  = b->quality[channel];
+        entry->filtered[channel] = decimated[k];
+    }
+}
+
+_Static_assert(sizeof(adc_filter_sample_t) <= sizeof(float32_t),
+               "ADC1 pipeline buffers hold float blocks");
+
+/**
+ * @brief Block pipeline of ADC1, one entry per bsp_adc1_stage_t
+ *
+ * A stage is added here and to bsp_adc1_stage_t; the hardware layers of
+ * the BSPs stay as they are.
+ */
+DSP_PIPELINE_DEFINE(g_adc1_pipeline,
+                    BSP_ADC1_MAX_BLOCK_SAMPLES * sizeof(float32_t),
+                    BSP_CycleCounter_Read,
+                    {"convert", adc1_stage_convert},
+                    {"quality", adc1_stage_quality},
+                    {"mains", adc1_stage_mains},
+                    {"filter", adc1_stage_filter},
+                    {"calibrate", adc1_stage_calibrate},
+                    {"publish", adc1_stage_publish},
+                    {"decimate", adc1_stage_decimate},
+                    {"publish_decimated", adc1_stage_publish_decimated});
+
+_Static_assert(DSP_PIPELINE_STAGES_OF(g_adc1_pipeline) ==
+                   (uint32_t)BSP_ADC1_STAGE_COUNT,
+               "ADC1 pipeline and bsp_adc1_stage_t differ");
+
+#if BSP_ADC1_SLOW_CHANNELS
+void adc1_pipeline_filter_slow(
+    const uint16_t (*results)[BSP_ADC1_NUM_SLOW_CHANNELS], uint32_t first,
+    uint32_t count)
+{
+    uint32_t            warm = 0U;
+    uint8_t             rank = 0U;
+    q15_t               raw[ADC1_SLOW_RING_SIZE];
+    adc_filter_sample_t input[ADC1_SLOW_RING_SIZE];
+    adc_filter_sample_t output[ADC1_SLOW_RING_SIZE];
+    float32_t           values[ADC1_SLOW_RING_SIZE];
+
+    if (count == 0U)
+    {
+        return;
+    }
+
+    if ((g_filter_warm_pending & BSP_ADC1_SLOW_CHANNELS) != 0U)
+    {
+        taskENTER_CRITICAL();
+        warm                   = g_filter_warm_pending & BSP_ADC1_SLOW_CHANNELS;
+        g_filter_warm_pending &= ~(uint32_t)BSP_ADC1_SLOW_CHANNELS;
+        taskEXIT_CRITICAL();
+    }
+
+    /* Each slow channel runs its results through g_slow_filter_ctx and
+     * calibration; the last ones become the values its ring entries hold
+     * until the next conversion. A warm start asked for a slow channel
+     * waits for its next conversion. */
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if (!ADC1_IS_SLOW(ch))
+        {
+            continue;
+        }
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            raw[i] = (q15_t)results[(first + i) & ADC1_SLOW_RING_MASK][rank];
+        }
+        adc_filter_from_adc_block(raw, input, BSP_ADC1_RESULT_EXTRA_BITS,
+                                  count);
+        adc_filter_to_float_block(input, values, count);
+        g_adc1_quality[ch] = adc1_block_quality(values, count);
+
+        if ((warm & (1UL << ch)) != 0U)
+        {
+            adc_filter_warm_start(&g_slow_filter_ctx, rank, input[0]);
+        }
+
+        adc_filter_process_block(&g_slow_filter_ctx, rank, input, output,
+                                 count);
+        adc_filter_to_float_block(output, values, count);
+        adc1_calibrate_block(ch, values, count);
+
+        g_slow_held_raw[ch]   = (uint16_t)raw[count - 1U];
+        g_filtered_values[ch] = values[count - 1U];
+        rank++;
+    }
+}
+#endif
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+/*
+ * One pass of adc_filter_process_frame() over the low-latency channels,
+ * in their order in g_ll_filter_ctx, then the calibration and the sample
+ * hook. A channel to warm start is restarted on the frame's result first.
+ */
+bool adc1_pipeline_filter_frame(const uint16_t *raw, uint32_t slot)
+{
+    static float32_t       values[BSP_ADC1_NUM_CHANNELS];
+    float32_t             *frame = g_ll_frames[slot];
+    uint32_t               warm  = g_ll_warm_pending;
+    bsp_adc1_sample_hook_t hook;
+    uint8_t                k     = 0U;
+
+    if (warm != 0U)
+    {
+        g_ll_warm_pending = 0U;
+    }
+
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if (ADC1_IS_LOW_LATENCY(ch))
+        {
+            adc_filter_sample_t sample =
+                ADC_FILTER_FROM_ADC(raw[ch], BSP_ADC1_RESULT_EXTRA_BITS);
+
+            if ((warm & (1UL << ch)) != 0U)
+            {
+                adc_filter_warm_start(&g_ll_filter_ctx, k, sample);
+            }
+            frame[k] = ADC_FILTER_TO_FLOAT(sample);
+            k++;
+        }
+    }
+
+    adc_filter_process_frame(&g_ll_filter_ctx, frame, frame);
+
+    k = 0U;
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if (ADC1_IS_LOW_LATENCY(ch))
+        {
+            adc1_calibrate_values(ch, &frame[k], 1U);
+            values[ch] = frame[k];
+            k++;
+        }
+    }
+
+    hook = g_sample_hook;
+    return (hook != NULL) && hook(values);
+}
+
+void adc1_pipeline_sample_alarm(void)
+{
+    bsp_adc1_sample_alarm_hook_t alarm = g_sample_alarm_hook;
+
+    if (alarm != NULL)
+    {
+        alarm();
+    }
+}
+#endif
+
+/**
+ * @brief Merge the input edges of a block into its ring entries (filter
+ * task only)
+ * @param in             The block, with its edges
+ * @param head           Full-rate ring index of the block's first frame
+ * @param decimated_head Decimated ring index of its first frame
+ *
+ * Frame i is captured at capture + i * period; an edge up to that instant
+ * and after the previous frame lands in frame i, edges before the block's
+ * first frame in that frame.
+ */
+static void adc1_merge_di(const adc1_pipeline_block_t *in, uint32_t head,
+                          uint32_t decimated_head)
+{
+    const uint8_t selected = in->di_selected;
+    const uint8_t added    = selected & (uint8_t)~g_di_selected;
+    uint8_t       level    = (g_di_level & selected & (uint8_t)~added) |
+                             (in->di_level & added);
+    uint8_t       decimated_edges = 0U;
+    uint32_t      e               = 0U;
+    uint64_t      due             = in->capture;
+
+    for (uint32_t i = 0U; i < in->samples; i++)
+    {
+        bsp_adc1_sample_t *entry = &g_ring[(head + i) & ADC1_RING_MASK];
+        uint8_t            edges = 0U;
+
+        while ((e < in->edge_count) && (in->edges[e].time <= due))
+        {
+            const adc1_di_edge_t *edge = &in->edges[e];
+            const uint8_t         bit  = (uint8_t)(1U << edge->channel);
+
+            if ((selected & bit) != 0U)
+            {
+                edges |= bit;
+                level = edge->rising ? (level | bit) : (level & (uint8_t)~bit);
+            }
+            e++;
+        }
+
+        entry->di       = level;
+        entry->di_edges = edges;
+
+        decimated_edges |= edges;
+        if (((i + 1U) % ADC_FILTER_DECIMATION_FACTOR) == 0U)
+        {
+            entry = &g_decimated_ring[(decimated_head +
+                                       (i / ADC_FILTER_DECIMATION_FACTOR)) &
+                                      ADC1_DECIMATED_RING_MASK];
+            entry->di       = level;
+            entry->di_edges = decimated_edges;
+            decimated_edges = 0U;
+        }
+
+        due += in->period;
+    }
+
+    g_di_level    = level;
+    g_di_selected = selected;
+}
+
+/*
+ * Each channel is taken through g_adc1_pipeline: converted, filtered with
+ * a single adc_filter_process_block() call, calibrated to engineering
+ * units, written into the full-rate ring, decimated and written into the
+ * lower-rate ring; the raw block of BSP_ADC1_MAINS_CHANNEL also drives
+ * mains tracking. The last output of the block becomes the channel's
+ * current filtered value. Slow channels pass the stages over: their
+ * conversions are filtered on their own first, and their entries in the
+ * rings repeat the last results. The block hook runs last, on the values
+ * just published, and the block's path is timed. The edges of the captured
+ * digital inputs are merged into the entries of both rings on the way.
+ *
+ * Blocks follow each other on the trigger grid, so a block captured later
+ * than one block after the previous one follows a gap: the samples in
+ * between were never converted. The gap is exact to the sample, and the
+ * sequence numbers skip it, so they stay on the sample-period clock; the
+ * gap of a change of rate is counted at the new rate.
+ */
+void adc1_pipeline_filter_block(const adc1_pipeline_block_t *in)
+{
+    uint32_t              start   = BSP_CycleCounter_Read();
+    uint32_t              gap     = 0U;
+    uint32_t              samples = in->samples;
+    uint64_t              capture = in->capture;
+    adc1_block_t          job;
+    uint32_t              head;
+    uint32_t              decimated_head;
+    uint32_t              sequence;
+    uint32_t              published;
+    bsp_adc1_block_hook_t hook;
+
+#if BSP_ADC1_PROBE_PINS
+    adc1_probe_set(ADC1_PROBE_PIN_FILTER, true);
+#endif
+
+    if (g_next_capture_valid && (capture > g_next_capture))
+    {
+        gap = (uint32_t)((capture - g_next_capture) / in->period);
+    }
+    g_next_capture       = capture + ((uint64_t)samples * in->period);
+    g_next_capture_valid = true;
+
+    head               = g_ring_head;
+    decimated_head     = g_decimated_ring_head;
+    job.in             = in;
+    job.head           = head;
+    job.decimated_head = decimated_head;
+    job.warm           = 0U;
+
+    if (gap != 0U)
+    {
+        g_sequence_skip       += gap;
+        g_adc1_missed_samples += gap;
+    }
+    sequence = head + g_sequence_skip;
+
+    if ((g_filter_warm_pending & ADC1_FAST_CHANNELS) != 0U)
+    {
+        taskENTER_CRITICAL();
+        job.warm               = g_filter_warm_pending & ADC1_FAST_CHANNELS;
+        g_filter_warm_pending &= ~(uint32_t)ADC1_FAST_CHANNELS;
+        taskEXIT_CRITICAL();
+    }
+
+    dsp_pipeline_run(&g_adc1_pipeline, BSP_ADC1_NUM_CHANNELS, &job);
+
+    /* The first entry of each stream carries the gap before the block */
+    for (uint32_t i = 0U; i < samples; i++)
+    {
+        bsp_adc1_sample_t *entry = &g_ring[(head + i) & ADC1_RING_MASK];
+
+        entry->sequence = sequence + i;
+        entry->gap      = (i == 0U) ? gap : 0U;
+    }
+
+    for (uint32_t k = 0U; k < (samples / ADC_FILTER_DECIMATION_FACTOR); k++)
+    {
+        bsp_adc1_sample_t *entry =
+            &g_decimated_ring[(decimated_head + k) & ADC1_DECIMATED_RING_MASK];
+
+        entry->sequence =
+            sequence + ((k + 1U) * ADC_FILTER_DECIMATION_FACTOR) - 1U;
+        entry->gap = (k == 0U) ? gap : 0U;
+    }
+
+    adc1_merge_di(in, head, decimated_head);
+
+    /* Block timestamp, rewritten under the busy marker */
+    {
+        uint32_t           block = g_block_count;
+        adc1_block_time_t *slot  = &g_block_times[block & ADC1_TIME_RING_MASK];
+
+        slot->block = ADC1_TIME_SLOT_BUSY;
+        __DMB();
+        slot->sequence = sequence;
+        slot->samples  = samples;
+        slot->period   = in->period;
+        slot->time     = capture;
+        slot->time_ns  = in->capture_ns;
+        __DMB();
+        slot->block = block;
+    }
+
+    /* Publish the blocks only once every entry is complete */
+    __DMB();
+    g_ring_head           = head + samples;
+    g_decimated_ring_head =
+        decimated_head + (samples / ADC_FILTER_DECIMATION_FACTOR);
+    g_block_count++;
+
+    /* Advance sample counter (for settling detection) */
+    g_filter_sample_count += samples;
+
+    published = BSP_CycleCounter_Read();
+#if BSP_ADC1_PROBE_PINS
+    adc1_probe_set(ADC1_PROBE_PIN_FILTER, false);
+#endif
+
+    hook = g_block_hook;
+    if (hook != NULL)
+    {
+#if BSP_ADC1_PROBE_PINS
+        adc1_probe_set(ADC1_PROBE_PIN_HOOK, true);
+#endif
+        hook(job.latest);
+#if BSP_ADC1_PROBE_PINS
+        adc1_probe_set(ADC1_PROBE_PIN_HOOK, false);
+#endif
+    }
+
+    adc1_latency_record(in, start, published, BSP_CycleCounter_Read());
+}
+
+void adc1_pipeline_init(void)
+{
+    /* Initialize the filter context for all channels */
+    (void)adc_filter_init(&g_adc_filter_ctx);
+#if BSP_ADC1_SLOW_CHANNELS
+    (void)adc_filter_init(&g_slow_filter_ctx);
+#endif
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    (void)adc_filter_init(&g_ll_filter_ctx);
+    g_ll_warm_pending = BSP_ADC1_LOW_LATENCY_CHANNELS;
+#endif
+    dsp_pipeline_init(&g_adc1_pipeline);
+
+    /* Clear filtered values, calibrate to volts */
+    for (uint8_t ch = 0; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        g_filtered_values[ch]    = 0.0f;
+        g_adc1_quality[ch]       = 0U;
+        g_cal_pending[ch].gain   = BSP_ADC1_VREF_V;
+        g_cal_pending[ch].offset = 0.0f;
+        g_cal_pending[ch].points = 0U;
+        g_cal[ch]                = g_cal_pending[ch];
+        adc1_calibration_interp(ch);
+        adc1_calibration_changed(ch);
+    }
+
+    /* Reset sample counter */
+    g_filter_sample_count = 0;
+
+    g_filter_block_overruns = 0U;
+    g_filter_warm_pending   = ADC1_ALL_CHANNELS;
+    g_adc1_recoveries       = 0U;
+    g_adc1_missed_samples   = 0U;
+}
+
+void adc1_pipeline_set_rate(uint32_t hz)
+{
+    (void)adc_filter_set_coeffs(&g_adc_filter_ctx,
+                                adc_filter_coeffs_for_rate(hz));
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    /* The hardware layer has stopped the conversions, and with them the
+     * frame filter */
+    (void)adc_filter_set_coeffs(&g_ll_filter_ctx,
+                                adc_filter_coeffs_for_rate(hz));
+#endif
+
+    if (g_mains_tracked_bank != ADC_FILTER_NUM_BANKS)
+    {
+        /* Restart tracking at the nominal frequency, at the new rate */
+        adc_filter_mains_init(
+            &g_mains,
+            (float32_t)adc_filter_bank_mains_freq[g_mains_tracked_bank], hz);
+        adc1_retune_mains(g_mains_tracked_bank,
+                          adc_filter_mains_get_frequency(&g_mains));
+    }
+
+    adc1_pipeline_warm_all();
+}
+
+void adc1_pipeline_warm_all(void)
+{
+    taskENTER_CRITICAL();
+    g_filter_warm_pending = ADC1_ALL_CHANNELS;
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    g_ll_warm_pending = BSP_ADC1_LOW_LATENCY_CHANNELS;
+#endif
+    taskEXIT_CRITICAL();
+}
+
+bsp_error_t BSP_ADC1_GetFilteredValue(uint8_t channel, float32_t *value)
+{
+    bsp_error_t ret = BSP_OK;
+
+    /* Validate parameters */
+    if (channel >= BSP_ADC1_NUM_CHANNELS || value == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    /* Check if filter is initialized */
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* Instant response: just return the current filtered value */
+        *value = g_filtered_values[channel];
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_GetFilteredValuesAll(float32_t *values)
+{
+    bsp_error_t ret = BSP_OK;
+
+    /* Validate parameters */
+    if (values == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    /* Check if filter is initialized */
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* Instant response: copy all current filtered values */
+        /* Disable interrupts briefly to get consistent snapshot */
+        __disable_irq();
+        for (uint8_t ch = 0; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+        {
+            values[ch] = g_filtered_values[ch];
+        }
+        __enable_irq();
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_GetQualityAll(uint8_t *quality)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (quality == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        __disable_irq();
+        for (uint8_t ch = 0; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+        {
+            quality[ch] = g_adc1_quality[ch];
+        }
+        __enable_irq();
+    }
+
+    return ret;
+}
+
+void BSP_ADC1_SetBlockHook(bsp_adc1_block_hook_t hook)
+{
+    g_block_hook = hook;
+}
+
+void BSP_ADC1_SetSampleHook(bsp_adc1_sample_hook_t       hook,
+                            bsp_adc1_sample_alarm_hook_t alarm)
+{
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    taskENTER_CRITICAL();
+    g_sample_hook       = hook;
+    g_sample_alarm_hook = alarm;
+    taskEXIT_CRITICAL();
+#else
+    (void)hook;
+    (void)alarm;
+#endif
+}
+
+
+bsp_error_t BSP_ADC1_GetLatency(bsp_adc1_latency_stage_t stage,
+                                bsp_adc1_latency_t      *latency)
+{
+    if (((uint32_t)stage >= (uint32_t)BSP_ADC1_LATENCY_COUNT) ||
+        (latency == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    *latency = g_latency[stage];
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_ADC1_GetStageCycles(bsp_adc1_stage_t         stage,
+                                    bsp_adc1_stage_cycles_t *cycles)
+{
+    dsp_pipeline_stats_t stats;
+
+    if ((cycles == NULL) ||
+        !dsp_pipeline_get_stats(&g_adc1_pipeline, (uint32_t)stage, &stats))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    cycles->count       = stats.count;
+    cycles->last_cycles = stats.last_cycles;
+    cycles->min_cycles  = stats.min_cycles;
+    cycles->max_cycles  = stats.max_cycles;
+    cycles->sum_cycles  = stats.sum_cycles;
+
+    return BSP_OK;
+}
+
+bool BSP_ADC1_IsFilterSettled(void)
+{
+    return g_filter_initialized &&
+           (g_filter_sample_count >= BSP_ADC1_FILTER_SETTLING_SAMPLES);
+}
+
+uint32_t BSP_ADC1_GetFilterSampleCount(void) { return g_filter_sample_count; }
+
+uint32_t BSP_ADC1_GetFilterBlockOverruns(void)
+{
+    return g_filter_block_overruns;
+}
+
+uint32_t BSP_ADC1_GetRecoveryCount(void) { return g_adc1_recoveries; }
+
+uint32_t BSP_ADC1_GetMissedSamples(void) { return g_adc1_missed_samples; }
+
+bsp_error_t BSP_ADC1_GetFilteredTimestamp(uint64_t *time)
+{
+    bsp_error_t ret  = BSP_OK;
+    uint32_t    head = g_ring_head;
+
+    if (time == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized || (head == 0U) ||
+             !adc1_lookup_time(g_ring[(head - 1U) & ADC1_RING_MASK].sequence,
+                               time, NULL))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_ResetFilter(uint8_t channel)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (channel >= BSP_ADC1_NUM_CHANNELS)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* Applied by the filter task at the channel's next block, and by
+         * the interrupt at a low-latency channel's next frame */
+        taskENTER_CRITICAL();
+        g_filter_warm_pending |= (1UL << channel);
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+        g_ll_warm_pending |= (BSP_ADC1_LOW_LATENCY_CHANNELS & (1UL << channel));
+#endif
+        taskEXIT_CRITICAL();
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_SetFilterBank(uint8_t channel, uint8_t bank)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    /* Takes effect at the filter task's next block boundary */
+    else if (!adc_filter_select_bank(&g_adc_filter_ctx, channel, bank))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    else if (ADC1_IS_LOW_LATENCY(channel))
+    {
+        /* The frame filter runs one bank for all of them, at its next
+         * frame */
+        for (uint8_t k = 0U; k < BSP_ADC1_NUM_LOW_LATENCY_CHANNELS; k++)
+        {
+            (void)adc_filter_select_bank(&g_ll_filter_ctx, k, bank);
+        }
+    }
+#endif
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_GetFilterBank(uint8_t channel, uint8_t *bank)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if ((channel >= BSP_ADC1_NUM_CHANNELS) || (bank == NULL))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        *bank = adc_filter_get_bank(&g_adc_filter_ctx, channel);
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_SetCalibration(uint8_t channel, float32_t gain,
+                                    float32_t offset)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if ((channel >= BSP_ADC1_NUM_CHANNELS) || !isfinite(gain) ||
+        (gain == 0.0f) || !isfinite(offset))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* Applied by the filter task at the channel's next block */
+        taskENTER_CRITICAL();
+        g_cal_pending[channel].gain   = gain;
+        g_cal_pending[channel].offset = offset;
+        g_cal_generation[channel]++;
+        taskEXIT_CRITICAL();
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_GetCalibration(uint8_t channel, float32_t *gain,
+                                    float32_t *offset)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if ((channel >= BSP_ADC1_NUM_CHANNELS) || (gain == NULL) ||
+        (offset == NULL))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        *gain   = g_cal_pending[channel].gain;
+        *offset = g_cal_pending[channel].offset;
+        taskEXIT_CRITICAL();
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_SetLinearization(uint8_t channel, const float32_t *table,
+                                      uint32_t count)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if ((channel >= BSP_ADC1_NUM_CHANNELS) ||
+        ((table != NULL) &&
+         ((count < 2U) || (count > BSP_ADC1_LINEARIZATION_MAX_POINTS))))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* Applied by the filter task at the channel's next block */
+        taskENTER_CRITICAL();
+        if (table != NULL)
+        {
+            (void)memcpy(g_cal_pending[channel].table, table,
+                         count * sizeof(float32_t));
+            g_cal_pending[channel].points = count;
+        }
+        else
+        {
+            g_cal_pending[channel].points = 0U;
+        }
+        g_cal_generation[channel]++;
+        taskEXIT_CRITICAL();
+    }
+
+    return ret;
+}
+
+const float32_t *BSP_ADC1_GetConversionTable(uint8_t channel)
+{
+    const float32_t *lut = NULL;
+
+#if BSP_ADC1_LUT_CHANNELS
+    if ((channel < BSP_ADC1_NUM_CHANNELS) && ADC1_HAS_LUT(channel) &&
+        g_filter_initialized)
+    {
+        lut = g_cal_lut[ADC1_LUT_SLOT(channel)];
+    }
+#else
+    (void)channel;
+#endif
+
+    return lut;
+}
+
+bsp_error_t BSP_ADC1_SetMainsTracking(bool enable, uint8_t base_bank)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (base_bank >= ADC_FILTER_NUM_BANKS)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* Applied by the filter task on the next mains channel block */
+        g_mains_base_bank = base_bank;
+        g_mains_tracking  = enable;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_GetMainsFrequency(float32_t *frequency)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (frequency == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else if (!g_mains_tracking)
+    {
+        *frequency = 0.0f;
+    }
+    else
+    {
+        *frequency = adc_filter_get_tracking_frequency(&g_adc_filter_ctx);
+    }
+
+    return ret;
+}
+
+/*============================================================================*/
+/*                     ADC1 Sample Ring Functions                             */
+/*============================================================================*/
+
+bsp_error_t BSP_ADC1_GetSampleTime(uint32_t sequence, uint64_t *time)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (time == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!adc1_lookup_time(sequence, time, NULL))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_GetSampleTimeNs(uint32_t sequence, uint64_t *time_ns)
+{
+    bsp_error_t ret = BSP_OK;
+    uint64_t    time;
+
+    if (time_ns == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!adc1_lookup_time(sequence, &time, time_ns))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_RingReaderInit(bsp_adc1_reader_t *reader,
+                                    bsp_adc1_stream_t  stream)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if ((reader == NULL) || ((uint32_t)stream >= BSP_ADC1_STREAM_COUNT))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else
+    {
+        reader->cursor   = *g_rings[stream].head;
+        reader->overruns = 0U;
+        reader->stream   = stream;
+    }
+
+    return ret;
+}
+
+uint32_t BSP_ADC1_RingAvailable(const bsp_adc1_reader_t *reader)
+{
+    uint32_t available = 0U;
+
+    if ((reader != NULL) && ((uint32_t)reader->stream < BSP_ADC1_STREAM_COUNT))
+    {
+        const adc1_ring_t *ring = &g_rings[reader->stream];
+
+        available = *ring->head - reader->cursor;
+        if (available > ring->size)
+        {
+            available = ring->size;
+        }
+    }
+
+    return available;
+}
+
+bsp_error_t BSP_ADC1_RingRead(bsp_adc1_reader_t *reader,
+                              bsp_adc1_sample_t *samples, uint32_t max_count,
+                              uint32_t *count)
+{
+    bsp_error_t ret  = BSP_OK;
+    uint32_t    done = 0U;
+
+    if ((reader == NULL) || (samples == NULL) || (count == NULL) ||
+        ((uint32_t)reader->stream >= BSP_ADC1_STREAM_COUNT))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else
+    {
+        const adc1_ring_t *ring   = &g_rings[reader->stream];
+        uint32_t           mask   = ring->size - 1U;
+        uint32_t           head   = *ring->head;
+        uint32_t           cursor = reader->cursor;
+
+        /* Skip samples that have already been overwritten */
+        if ((head - cursor) > ring->size)
+        {
+            reader->overruns += (head - cursor) - ring->size;
+            cursor            = head - ring->size;
+        }
+
+        __DMB();
+
+        while ((done < max_count) && (cursor != head))
+        {
+            uint32_t n     = head - cursor;
+            uint32_t first = cursor & mask;
+            uint32_t lost;
+
+            if (n > (max_count - done))
+            {
+                n = max_count - done;
+            }
+            if (n > (ring->size - first))
+            {
+                n = ring->size - first;
+            }
+
+            (void)memcpy(&samples[done], &ring->entries[first],
+                         n * sizeof(bsp_adc1_sample_t));
+
+            /*
+             * The producer may have refilled the oldest slots while they were
+             * copied: the block being written extends one block past the
+             * published head. Drop any entry it could have reached.
+             */
+            __DMB();
+            head = *ring->head;
+            lost = 0U;
+            if ((head + ring->block - cursor) > ring->size)
+            {
+                lost = (head + ring->block - cursor) - ring->size;
+                if (lost > n)
+                {
+                    lost = n;
+                }
+                reader->overruns += lost;
+            }
+
+            if (lost > 0U)
+            {
+                (void)memmove(&samples[done], &samples[done + lost],
+                              (n - lost) * sizeof(bsp_adc1_sample_t));
+            }
+
+            done   += n - lost;
+            cursor += n;
+        }
+
+        reader->cursor = cursor;
+        *count         = done;
+    }
+
+    return ret;
+}
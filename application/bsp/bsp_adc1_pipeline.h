@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC1 Block Pipeline
+ *
+ * The board-independent half of the ADC1 acquisition, shared by the BSPs
+ * (bsp/stm, bsp/posix): the block pipeline and its stages, the warm
+ * starts, the calibration and mains tracking, the quality checks, the
+ * full-rate and decimated rings with their timestamp history, and the
+ * filtered-value API of bsp.h that reads them.
+ *
+ * The hardware layer of a BSP converts the frames, a DMA half on the
+ * board, a simulated block on the host, and hands each completed block to
+ * adc1_pipeline_filter_block() from its filter task, with the capture time
+ * of the first frame and the instants the block's path is timed from. It
+ * keeps the sample rate, the trigger timing, the watchdogs and the filter
+ * task itself, and moves the pipeline to a new rate with
+ * adc1_pipeline_set_rate().
+ *
+ * Private to the BSPs; the application uses bsp.h.
+ */
+
+#ifndef BSP_ADC1_PIPELINE_H
+#define BSP_ADC1_PIPELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "adc_filter.h"
+#include "bsp.h"
+
+/** @brief Channels converted on every trigger, bit n for channel n */
+#define ADC1_FAST_CHANNELS                   \
+    (((1UL << BSP_ADC1_NUM_CHANNELS) - 1U) & \
+     ~(uint32_t)BSP_ADC1_SLOW_CHANNELS)
+
+/** @brief Every channel, bit n for channel n */
+#define ADC1_ALL_CHANNELS ((1UL << BSP_ADC1_NUM_CHANNELS) - 1U)
+
+/** @brief Channel @p ch is converted at the slow rate */
+#define ADC1_IS_SLOW(ch) \
+    (((BSP_ADC1_SLOW_CHANNELS >> (ch)) & 1U) != 0U)
+
+/** @brief Channel @p ch is filtered in the ADC1 interrupt, frame by frame */
+#define ADC1_IS_LOW_LATENCY(ch) \
+    (((BSP_ADC1_LOW_LATENCY_CHANNELS >> (ch)) & 1U) != 0U)
+
+/** @brief Frames of low-latency samples held for the block filter, both
+ * halves of the largest block */
+#define ADC1_LOW_LATENCY_SLOTS (2U * BSP_ADC1_MAX_BLOCK_SAMPLES)
+
+/** @brief Triggers per slow channel conversion at the sample rate @p hz */
+#define ADC1_SLOW_TRIGGERS(hz) ((hz) / ADC_FILTER_SLOW_SAMPLE_RATE)
+
+/** @brief Slow conversions held for the next block filtered, a power of 2 */
+#define ADC1_SLOW_RING_SIZE 8U
+#define ADC1_SLOW_RING_MASK (ADC1_SLOW_RING_SIZE - 1U)
+
+/** @brief Decimated frames produced per block of the largest size */
+#define ADC1_MAX_DECIMATED_BLOCK_SAMPLES \
+    (BSP_ADC1_MAX_BLOCK_SAMPLES / ADC_FILTER_DECIMATION_FACTOR)
+
+/** @brief Nanoseconds per capture timer tick */
+#define ADC1_TIMESTAMP_NS (1000000000UL / BSP_ADC1_TIMESTAMP_HZ)
+
+/**
+ * @brief Results of a block from one frame to the next
+ *
+ * A channel's results are contiguous, one plane per channel, except in
+ * dual mode, where each frame packs the ADC1/ADC2 pairs in words and a
+ * channel's result is one half-word of a frame of BSP_ADC1_NUM_CHANNELS
+ * half-words.
+ */
+#if BSP_ADC1_DUAL_MODE
+#define ADC1_PIPELINE_STRIDE BSP_ADC1_NUM_CHANNELS
+#else
+#define ADC1_PIPELINE_STRIDE 1U
+#endif
+
+/** @brief Timestamp slot marker while the slot is rewritten (above any
+ * block index) */
+#define ADC1_TIME_SLOT_BUSY 0xFFFFFFFFUL
+
+/**
+ * @brief Capture time of one published block
+ */
+typedef struct
+{
+    volatile uint32_t block;    /**< Index of the block, counted from 0 */
+    uint32_t          sequence; /**< Sequence of the block's first sample */
+    uint32_t          samples;  /**< Samples in the block */
+    uint32_t          period;   /**< Capture ticks from a sample to the next */
+    uint64_t          time;     /**< Capture time of that sample (ticks) */
+    uint64_t          time_ns;  /**< The same on the PTP timescale */
+} adc1_block_time_t;
+
+/**
+ * @brief One edge of a captured digital input on the capture timeline
+ */
+typedef struct
+{
+    uint64_t time;    /**< Capture time of the edge (ticks) */
+    uint8_t  channel; /**< Digital input, ::BSP_GPIODI_INDEX */
+    bool     rising;  /**< Rising edge, else falling */
+} adc1_di_edge_t;
+
+/**
+ * @brief A completed block, as the hardware layer hands it over
+ *
+ * The cycle counts time the block's path: @c ready is when the block was
+ * complete, the DMA interrupt entry on the board, and @c callback when
+ * the filter task was woken for it; the pipeline adds the rest.
+ *
+ * The edges are those of the captured inputs up to the capture of the
+ * block's last frame, oldest first; later ones are kept for the next
+ * block. An input newly captured starts from its level in @c di_level.
+ */
+typedef struct
+{
+    /** First result of each fast channel, ADC1_PIPELINE_STRIDE apart */
+    const uint16_t *raw[BSP_ADC1_NUM_CHANNELS];
+
+    uint32_t samples;    /**< Frames in the block */
+    uint32_t slot;       /**< Low-latency slot of the first frame */
+    uint32_t period;     /**< Capture ticks from a frame to the next */
+    uint64_t capture;    /**< Capture time of the first frame (ticks) */
+    uint64_t capture_ns; /**< The same on the PTP timescale */
+    uint32_t conversion; /**< Cycles from the last trigger to @c ready */
+    uint32_t ready;      /**< Cycle counter when the block was complete */
+    uint32_t callback;   /**< Cycle counter when the task was woken */
+
+    const adc1_di_edge_t *edges; /**< Input edges since the previous block */
+    uint32_t edge_count;         /**< Edges in @c edges */
+    uint8_t  di_selected;        /**< Captured inputs, bit n = DIn */
+    uint8_t  di_level;           /**< Input levels read for the block */
+} adc1_pipeline_block_t;
+
+/** @brief The filter task runs and the filtered values are kept */
+extern volatile bool g_filter_initialized;
+
+/** @brief Channels to restart in steady state at their next block (bit n =
+ * channel n) */
+extern volatile uint32_t g_filter_warm_pending;
+
+/** @brief Blocks lost because the filter task fell behind */
+extern volatile uint32_t g_filter_block_overruns;
+
+/** @brief Times ADC1 was resumed after an overrun or DMA error */
+extern volatile uint32_t g_adc1_recoveries;
+
+/**
+ * @brief Reset the filters, the calibration and the counters
+ *
+ * The first part of BSP_ADC1_FilterInit(), before the hardware layer
+ * starts its filter task. Every channel warm starts on its first block.
+ */
+void adc1_pipeline_init(void);
+
+/**
+ * @brief Filter one completed block and publish it (filter task only)
+ * @param block The block's results and timing
+ *
+ * The results must stay in place until the call returns.
+ */
+void adc1_pipeline_filter_block(const adc1_pipeline_block_t *block);
+
+#if BSP_ADC1_SLOW_CHANNELS
+/**
+ * @brief Filter the slow channel conversions since the last block
+ * (filter task only)
+ * @param results Conversions, one result per slow channel in channel order
+ * @param first   Index of the first conversion in @p results
+ * @param count   Conversions from @p first on, at most ADC1_SLOW_RING_SIZE
+ *
+ * @p results is indexed modulo ADC1_SLOW_RING_SIZE. Called before the
+ * block they make up for is filtered.
+ */
+void adc1_pipeline_filter_slow(
+    const uint16_t (*results)[BSP_ADC1_NUM_SLOW_CHANNELS], uint32_t first,
+    uint32_t count);
+#endif
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+/**
+ * @brief Filter the low-latency channels of one frame (ADC1 interrupt)
+ * @param raw  Result of every channel of the frame, channel order; only
+ *             those of BSP_ADC1_LOW_LATENCY_CHANNELS are read
+ * @param slot Slot for the filtered samples, below ADC1_LOW_LATENCY_SLOTS:
+ *             the frame's index in the DMA buffer, where the block filter
+ *             picks them up through adc1_pipeline_block_t::slot
+ * @return true if the sample hook asked for its alarm
+ *
+ * Runs the sample hook on the calibrated values.
+ */
+bool adc1_pipeline_filter_frame(const uint16_t *raw, uint32_t slot);
+
+/**
+ * @brief Run the sample alarm hook (filter task only)
+ */
+void adc1_pipeline_sample_alarm(void);
+#endif
+
+/**
+ * @brief Move the filters to a new sample rate (filter task only)
+ * @param hz Rate, one with a coefficient set
+ *
+ * Switches the coefficient set, restarts mains tracking at the rate and
+ * warm starts every channel on the first block at the rate; the hardware
+ * layer has already moved its trigger.
+ */
+void adc1_pipeline_set_rate(uint32_t hz);
+
+/**
+ * @brief Warm start every channel on its next block, after a gap
+ */
+void adc1_pipeline_warm_all(void);
+
+#if BSP_ADC1_PROBE_PINS
+/**
+ * @brief Probe pins of the sample path driven by the pipeline
+ */
+typedef enum
+{
+    ADC1_PROBE_PIN_FILTER = 0, /**< High while a block is filtered */
+    ADC1_PROBE_PIN_HOOK   = 1, /**< High while the block hook runs */
+} adc1_probe_pin_t;
+
+/**
+ * @brief Drive a probe pin, provided by the hardware layer
+ */
+void adc1_probe_set(adc1_probe_pin_t pin, bool high);
+#endif
+
+#endif /* BSP_ADC1_PIPELINE_H */
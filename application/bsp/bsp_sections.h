@@ -0,0 +1,61 @@
+/**
+ * @file bsp_sections.h
+ * @brief Placement of DMA buffers, task stacks, network pools and hot code
+ *        in the SRAM banks.
+ *
+ * Each SRAM bank is a separate bus matrix slave, so bus masters working on
+ * different banks do not wait for each other. The non-secure image owns two
+ * banks on the STM32H563 (SRAM1 belongs to the secure image):
+ * - SRAM3 (320 KB, "RAM"): the DMA bank. Ethernet descriptors and buffers,
+ *   the lwIP pools and heap (the Ethernet DMA reads TX payloads from them),
+ *   the ADC DMA buffers, and all other data.
+ * - SRAM2 (64 KB, "RAM2"): the CPU bank. Task stacks, the code and
+ *   constants of the interrupt paths, and tables read on every sample, so
+ *   that none waits behind DMA bursts.
+ *
+ * The sections are laid out in STM32H563xx_FLASH_ns.ld. The NOLOAD ones
+ * (stacks, DMA buffers, pools, run-time tables) are not zeroed by the
+ * startup code; their users initialize them before the first read.
+ *
+ * The host simulation build (BSP_POSIX) has a single memory and no linker
+ * script: the macros keep only the alignment.
+ */
+
+#ifndef BSP_SECTIONS_H
+#define BSP_SECTIONS_H
+
+#if defined(BSP_POSIX) && BSP_POSIX
+
+#define BSP_SECTION_DMA      __attribute__((aligned(32)))
+#define BSP_SECTION_NET_POOL __attribute__((aligned(32)))
+#define BSP_SECTION_STACK    __attribute__((aligned(8)))
+#define BSP_SECTION_RAMFUNC
+#define BSP_SECTION_FASTDATA __attribute__((aligned(8)))
+#define BSP_SECTION_FASTBSS  __attribute__((aligned(8)))
+
+#else
+
+/** DMA buffer in the DMA bank, aligned to BSP_CACHE_LINE_SIZE */
+#define BSP_SECTION_DMA __attribute__((section(".dma_buffer"), aligned(32)))
+
+/** lwIP pool or heap in the DMA bank */
+#define BSP_SECTION_NET_POOL \
+    __attribute__((section(".net_pool"), aligned(32)))
+
+/** Task stack in the CPU bank, aligned as the AAPCS requires */
+#define BSP_SECTION_STACK __attribute__((section(".task_stack"), aligned(8)))
+
+/** Function run from the CPU bank, copied there by the startup code */
+#define BSP_SECTION_RAMFUNC __attribute__((section(".RamFunc")))
+
+/** Constant read by interrupt code from the CPU bank, dual-word aligned */
+#define BSP_SECTION_FASTDATA \
+    __attribute__((section(".fastdata"), aligned(8)))
+
+/** Table built at run time in the CPU bank, not loaded nor zeroed */
+#define BSP_SECTION_FASTBSS \
+    __attribute__((section(".fast_bss"), aligned(8)))
+
+#endif /* BSP_POSIX */
+
+#endif /* BSP_SECTIONS_H */
@@ -0,0 +1,3542 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Host Simulation Board Support
+ *
+ * The bsp.h contract on a Linux host, under the FreeRTOS POSIX port, so
+ * that the application, the lwIP stack and the Modbus stacks run unchanged
+ * as a process. Several processes, one per node, make a simulated network
+ * (see the lwIP port's TAP interface).
+ *
+ * - ADC1 is a task at the filter task's priority that produces a block of
+ *   frames every block period of host time (BSP_ADC1_SetSampleRate()),
+ *   3.2 ms at the default rate, either a fixed
+ *   test signal or the frames of a CSV file (JERRY_SIM_ADC), and runs it
+ *   through the board's filter, calibration, ring and timestamp code,
+ *   bsp_adc1_pipeline.c.
+ * - The external SPI ADC (BSP_SPIADC_ENABLE) is a task that publishes a
+ *   block of BSP_SPIADC_BLOCK_SAMPLES frames of a test signal per block
+ *   period into the same ring and timestamp history as the board.
+ * - The flash is a 2 MB mapping at the address of the device's flash, as
+ *   readers of the update slot and the configuration sectors use the
+ *   addresses directly; it is kept in a file (JERRY_SIM_FLASH) or lost at
+ *   exit. Erases and programs end before the call returns.
+ * - The SPI NOR flash (BSP_SPINOR_ENABLE) is 16 MB of memory, kept in a
+ *   file (JERRY_SIM_NOR) or lost at exit; its erases end at once too.
+ * - The cycle counter and the PTP time follow CLOCK_MONOTONIC; the cycle
+ *   counter is scaled to the core clock of the STM32H563.
+ * - The watchdog ends the process with SIM_EXIT_WATCHDOG; a bank swap ends
+ *   it with SIM_EXIT_RESET, for a wrapper to start it again.
+ * - The device address is JERRY_SIM_NODE (0-15), the I2C outputs hold
+ *   their image, the digital inputs read low and never change, RS-485,
+ *   CAN and USB have no peer, and the secure services are left to the
+ *   host: random numbers come from getrandom(), image verification fails.
+ *
+ * The interrupt entries of bsp.h have no callers here and are left out.
+ */
+
+#define _GNU_SOURCE
+
+#include "bsp.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter.h"
+#include "bsp_adc1_pipeline.h"
+#include "bsp_sections.h"
+#include "task.h"
+
+/** @brief Core clock reported to the kernel and the application */
+uint32_t SystemCoreClock = BSP_POSIX_CYCLE_HZ;
+
+/*============================================================================*/
+/*                          Simulation Settings                               */
+/*============================================================================*/
+
+/** @brief Environment variable holding the device address, 0 to 15 */
+#define SIM_NODE_ENV "JERRY_SIM_NODE"
+
+/** @brief Environment variable naming a CSV file of ADC1 frames */
+#define SIM_ADC_ENV "JERRY_SIM_ADC"
+
+/** @brief Environment variable naming the file that keeps the flash */
+#define SIM_FLASH_ENV "JERRY_SIM_FLASH"
+
+/** @brief Environment variable naming the file that keeps the SPI NOR flash */
+#define SIM_NOR_ENV "JERRY_SIM_NOR"
+
+/** @brief Exit status of a watchdog expiry */
+#define SIM_EXIT_WATCHDOG 3
+
+/** @brief Exit status of a reset asked for by the application */
+#define SIM_EXIT_RESET 4
+
+/** @brief Largest device address, four DEVADDR pins */
+#define SIM_NODE_MAX 15U
+
+/** @brief Device address, from SIM_NODE_ENV at BSP_Init() */
+static uint8_t sim_node = 0U;
+
+/** @brief Nanoseconds in a second, unsigned */
+#define SIM_NS_PER_S 1000000000ULL
+
+/** @brief CLOCK_MONOTONIC at BSP_Init(), all host times count from it */
+static uint64_t sim_epoch_ns = 0U;
+
+/**
+ * @brief Host time since BSP_Init()
+ */
+static uint64_t sim_now_ns(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (((uint64_t)now.tv_sec * SIM_NS_PER_S) + (uint64_t)now.tv_nsec) -
+           sim_epoch_ns;
+}
+
+/*============================================================================*/
+/*                          Interrupt Mask                                    */
+/*============================================================================*/
+
+/* The POSIX port masks the tick and yield signals of the calling thread;
+ * a thread with SIGALRM blocked is the one in a critical section. */
+
+uint32_t bsp_posix_get_primask(void)
+{
+    sigset_t current;
+
+    (void)pthread_sigmask(SIG_BLOCK, NULL, &current);
+
+    return (sigismember(&current, SIGALRM) == 1) ? 1U : 0U;
+}
+
+void bsp_posix_set_primask(uint32_t primask)
+{
+    if (primask != 0U)
+    {
+        vPortDisableInterrupts();
+    }
+    else
+    {
+        vPortEnableInterrupts();
+    }
+}
+
+long xPortIsInsideInterrupt(void) { return 0; }
+
+/*============================================================================*/
+/*                          ADC1 Private Variables                            */
+/*============================================================================*/
+
+/** @brief Result of channel @p ch in frame @p i of the simulated block */
+#define ADC1_RESULT(i, ch) ((uint32_t)adc1_block[ch][i])
+
+/** @brief ADC1 block filter task stack size (words) */
+#define ADC1_FILTER_TASK_STACK_SIZE 256U
+
+/** @brief ADC1 block filter task priority (task_priorities.h) */
+#define ADC1_FILTER_TASK_PRIORITY TASK_PRIO_ADC_FILTER
+
+/** @brief Blocks the task may fall behind before the oldest are dropped, as
+ * the DMA would overwrite them */
+#define ADC1_MAX_BEHIND 2U
+
+/** @brief Frequency and amplitude of the test signal on the mains channel */
+#define ADC1_SIM_MAINS_HZ        50.0
+#define ADC1_SIM_MAINS_AMPLITUDE 0.4
+
+/** @brief Peak noise of the test signal, in results */
+#define ADC1_SIM_NOISE 8U
+
+/** @brief Results of the block being filtered, one plane per channel */
+static uint16_t adc1_block[BSP_ADC1_NUM_CHANNELS][BSP_ADC1_MAX_BLOCK_SAMPLES];
+
+/** @brief Latest frame, one result per channel */
+static uint32_t adc1_latest_results[BSP_ADC1_NUM_CHANNELS];
+
+#if BSP_ADC1_SLOW_CHANNELS
+/** @brief Slow conversions since the last block filtered, one result per
+ * slow channel in channel order, and their count */
+static uint16_t adc1_slow_block[ADC1_SLOW_RING_SIZE]
+                               [BSP_ADC1_NUM_SLOW_CHANNELS];
+static uint32_t adc1_slow_count = 0U;
+
+/** @brief Triggers before the next slow conversion */
+static uint32_t adc1_slow_countdown = 0U;
+
+/** @brief Slow conversions dropped with the queue full */
+static volatile uint32_t adc1_slow_overruns = 0U;
+#endif
+
+/** @brief Most recently completed frame */
+static const uint32_t *volatile adc1_latest_frame = NULL;
+
+/** @brief Windows of the analog watchdogs, as last set */
+static bsp_adc1_awd_config_t adc1_awd_config[BSP_ADC1_AWD_COUNT] = {
+    {0U, 0U, (uint16_t)BSP_ADC1_FULL_SCALE},
+    {1U, 0U, (uint16_t)BSP_ADC1_FULL_SCALE},
+    {2U, 0U, (uint16_t)BSP_ADC1_FULL_SCALE}};
+
+/** @brief Alarms active, bit n for AWD n+1 */
+static volatile uint32_t adc1_awd_active = 0U;
+
+/** @brief Alarms raised since BSP_ADC1_FilterInit() */
+static volatile uint32_t adc1_awd_raised = 0U;
+
+/** @brief Function run when the alarms change, NULL for none */
+static volatile bsp_adc1_awd_hook_t adc1_awd_hook = NULL;
+
+/** @brief Flag indicating ADC1 is running */
+static volatile bool adc1_running = false;
+
+/** @brief ADC1 sample rate in force (Hz) */
+static volatile uint32_t adc1_sample_rate = ADC_FILTER_SAMPLE_RATE;
+
+/** @brief Frames per block at adc1_sample_rate */
+static volatile uint32_t adc1_block_samples = BSP_ADC1_BLOCK_SAMPLES;
+
+/** @brief Sample rate requested from the filter task (Hz), 0 for none */
+static volatile uint32_t adc1_rate_request = 0U;
+
+/** @brief Flag indicating a complete conversion sequence is available */
+static volatile bool adc1_conversion_complete = false;
+
+/** @brief Sample clock time of the first frame of the next block, in
+ * capture ticks since BSP_Init(): the block is due one block period later,
+ * moved by adc1_sync_shift (filter task only) */
+static uint64_t adc1_next_start = 0U;
+
+/** @brief Capture ticks the sample clock has been moved by to follow the PTP
+ * time, 0 without BSP_ADC1_SYNC (filter task only) */
+static int64_t adc1_sync_shift = 0;
+
+#if BSP_ADC1_SYNC
+/** @brief The trigger follows the PTP time (BSP_ADC1_SetTriggerSync()) */
+static volatile bool adc1_sync_enabled = false;
+
+/** @brief The last phase error was within BSP_ADC1_SYNC_ALIGNED_TICKS */
+static volatile bool adc1_sync_aligned = false;
+#endif
+
+/** @brief CSV file replayed, NULL for the test signal */
+static FILE *adc1_replay = NULL;
+
+/** @brief State of the test signal noise generator */
+static uint32_t adc1_noise = 1U;
+
+/*============================================================================*/
+/*                     Filtered ADC Private Variables                         */
+/*============================================================================*/
+
+/** @brief Block filter task control block and stack */
+static StaticTask_t g_filter_task_tcb;
+static StackType_t  g_filter_task_stack[ADC1_FILTER_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** @brief Block filter task handle, NULL until BSP_ADC1_FilterInit() */
+static TaskHandle_t g_filter_task = NULL;
+
+/*============================================================================*/
+/*                     ADC1 Timebase Private Variables                        */
+/*============================================================================*/
+
+/** @brief Capture ticks per ADC trigger, the TIM1 period of the board */
+static uint32_t g_trigger_period =
+    BSP_ADC1_TIMESTAMP_HZ / ADC_FILTER_SAMPLE_RATE;
+
+#if BSP_SPIADC_ENABLE
+/*============================================================================*/
+/*                          SPI ADC Private Variables                         */
+/*============================================================================*/
+
+/** @brief Capture ticks per frame, the TIM8 period of the board */
+#define SPIADC_PERIOD (BSP_ADC1_TIMESTAMP_HZ / BSP_SPIADC_SAMPLE_RATE)
+
+/** @brief Host time of one block */
+#define SPIADC_BLOCK_NS                                        \
+    ((uint64_t)BSP_SPIADC_BLOCK_SAMPLES * SPIADC_PERIOD *      \
+     ADC1_TIMESTAMP_NS)
+
+/** @brief Blocks the task may fall behind before the oldest are dropped, as
+ * the DMA would overwrite them */
+#define SPIADC_MAX_BEHIND 2U
+
+/** @brief Publishing task stack size (words) */
+#define SPIADC_TASK_STACK_SIZE 256U
+
+/** @brief Publishing task priority (task_priorities.h) */
+#define SPIADC_TASK_PRIORITY TASK_PRIO_SPI_ADC
+
+/** @brief Largest result of the converter */
+#define SPIADC_FULL_SCALE \
+    ((int32_t)((1UL << (BSP_SPIADC_RESULT_BITS - 1U)) - 1U))
+
+/** @brief Frequency and amplitude of the test signal on channel 0 */
+#define SPIADC_SIM_SINE_HZ        1000.0
+#define SPIADC_SIM_SINE_AMPLITUDE 0.8
+
+/** @brief Peak noise of the test signal, in results */
+#define SPIADC_SIM_NOISE 16U
+
+/** @brief DMA blocks kept in the timestamp history (power of two) */
+#define SPIADC_TIME_RING_SIZE 16U
+
+/** @brief Index mask for the timestamp history */
+#define SPIADC_TIME_RING_MASK (SPIADC_TIME_RING_SIZE - 1U)
+
+/** @brief Index mask for the sample ring */
+#define SPIADC_RING_MASK (BSP_SPIADC_RING_SIZE - 1U)
+
+_Static_assert((BSP_ADC1_TIMESTAMP_HZ % BSP_SPIADC_SAMPLE_RATE) == 0U,
+               "SPI ADC frame period must be a whole number of ticks");
+_Static_assert((BSP_SPIADC_RESULT_BITS >= 9U) &&
+                   (BSP_SPIADC_RESULT_BITS <= 32U),
+               "SPI ADC results must be 9 to 32 bits");
+_Static_assert(BSP_SPIADC_NUM_CHANNELS <= 8U,
+               "SPI ADC frames hold at most 8 channels");
+_Static_assert((BSP_SPIADC_RING_SIZE & SPIADC_RING_MASK) == 0U,
+               "SPI ADC ring size must be a power of two");
+_Static_assert(BSP_SPIADC_RING_SIZE >= (2U * BSP_SPIADC_BLOCK_SAMPLES),
+               "SPI ADC ring must hold at least two blocks");
+_Static_assert((SPIADC_TIME_RING_SIZE * BSP_SPIADC_BLOCK_SAMPLES) >=
+                   (BSP_SPIADC_RING_SIZE + BSP_SPIADC_BLOCK_SAMPLES),
+               "SPI ADC timestamp history must cover the sample ring");
+
+/** @brief Set between BSP_SPIADC_Start() and BSP_SPIADC_Stop() */
+static volatile bool spiadc_running = false;
+
+/** @brief Index of the next block on the sample clock, block n is due
+ * (n + 1) * SPIADC_BLOCK_NS after BSP_Init() (task only) */
+static uint64_t spiadc_next_block = 0U;
+
+/** @brief Block published last, and whether there was one (task only) */
+static uint64_t spiadc_last_block       = 0U;
+static bool     spiadc_last_block_valid = false;
+
+/** @brief Sequence numbers skipped so far (task only) */
+static uint32_t spiadc_sequence_skip = 0U;
+
+/** @brief State of the test signal noise generator */
+static uint32_t spiadc_noise = 1U;
+
+/** @brief Counters, written by the task */
+static bsp_spiadc_stats_t spiadc_stats;
+
+/** @brief Function run per published block */
+static volatile bsp_spiadc_block_hook_t spiadc_block_hook = NULL;
+
+/** @brief Published frames, single producer, any number of readers */
+static bsp_spiadc_sample_t spiadc_ring[BSP_SPIADC_RING_SIZE];
+
+/** @brief Index of the next frame to publish */
+static volatile uint32_t spiadc_ring_head = 0U;
+
+/** @brief Capture time of the recently published blocks, as on the board */
+static adc1_block_time_t spiadc_block_times[SPIADC_TIME_RING_SIZE];
+
+/** @brief Publishing task control block, stack and handle */
+static StaticTask_t spiadc_task_tcb;
+static StackType_t  spiadc_task_stack[SPIADC_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
+static TaskHandle_t spiadc_task = NULL;
+#endif
+
+/*============================================================================*/
+/*                          Peripheral Private Variables                      */
+/*============================================================================*/
+
+/** @brief Outputs of the expanders given to BSP_I2CDO_init() */
+static uint32_t i2cdo_count   = 0U;
+static uint32_t i2cdo_outputs = 0U;
+
+/** @brief Output image staged by BSP_I2CDO_Stage(), pushed by Commit */
+static uint32_t i2cdo_shadow = 0U;
+
+/** @brief Output image last written to the expanders */
+static volatile uint32_t i2cdo_committed = 0U;
+
+/** @brief Asynchronous transfer in flight, NULL when idle */
+static bsp_i2cdo_xfer_t *volatile i2cdo_active = NULL;
+
+/** @brief Outputs held by BSP_I2CDO_Force() and their states, changed
+ * together in a critical section */
+static uint32_t i2cdo_force_mask  = 0U;
+static uint32_t i2cdo_force_value = 0U;
+
+/** @brief Pins of the simulated expanders */
+static volatile uint32_t i2cdo_pins = 0U;
+
+/** @brief RS-485 port statistics */
+static bsp_rs485_stats_t rs485_stats;
+
+/** @brief Task that called BSP_RS485_Init(), NULL before */
+static TaskHandle_t rs485_owner = NULL;
+
+/** @brief Output state of each PWM channel */
+typedef struct
+{
+    uint32_t frequency_hz; /**< Frequency, 0 while stopped */
+    uint16_t duty;         /**< Duty cycle, 0 to BSP_PWM_DUTY_MAX */
+} pwm_state_t;
+
+static pwm_state_t pwm_state[BSP_PWM_COUNT];
+
+/** @brief Captured digital inputs, bit n = DIn */
+static volatile uint8_t gpiodi_selected = 0U;
+
+/** @brief Capture counters, all zero as the inputs never change */
+static bsp_gpiodi_capture_t gpiodi_capture[BSP_GPIODI_COUNT];
+
+/** @brief CAN FD data length of each DLC code */
+static const uint8_t can_dlc_length[16] = {0U,  1U,  2U,  3U,  4U,  5U,
+                                           6U,  7U,  8U,  12U, 16U, 20U,
+                                           24U, 32U, 48U, 64U};
+
+/** @brief Set between BSP_CAN_Start() and BSP_CAN_Stop() */
+static volatile bool can_running = false;
+
+/** @brief CAN port statistics */
+static bsp_can_stats_t can_stats;
+
+/** @brief Function run by the first BSP_Console_Fault() */
+static volatile bsp_console_fault_hook_t console_fault_hook = NULL;
+
+/** @brief Set by the first BSP_Console_Fault() */
+static volatile bool console_fault_entered = false;
+
+/*============================================================================*/
+/*                          Cycle Counter Private Variables                   */
+/*============================================================================*/
+
+/** @brief Cycles run by each accounted interrupt handler */
+static uint64_t isr_cycles[BSP_ISR_COUNT];
+
+/** @brief Cycle counter at the last entry of each accounted handler */
+static volatile uint32_t isr_enter_cycles[BSP_ISR_COUNT];
+
+/** @brief Trace hook of the accounted interrupts */
+static volatile bsp_isr_trace_hook_t isr_trace_hook = NULL;
+
+/*============================================================================*/
+/*                          PTP Time Private Variables                        */
+/*============================================================================*/
+
+/** @brief Host time of the last step or frequency change */
+static uint64_t ptp_base_host_ns = 0U;
+
+/** @brief PTP time at ptp_base_host_ns */
+static uint64_t ptp_base_ns = 0U;
+
+/** @brief Frequency correction since ptp_base_host_ns */
+static int32_t ptp_ppb = 0;
+
+/** @brief Task in BSP_Time_SleepUntilNs(), NULL if none */
+static TaskHandle_t ptp_sleeper = NULL;
+
+/*============================================================================*/
+/*                          CRC Private Variables                             */
+/*============================================================================*/
+
+/** @brief CRC-16/MODBUS polynomial, reflected (x^16 + x^15 + x^2 + 1) */
+#define CRC16_MODBUS_POLY_REFLECTED 0xA001U
+
+/** @brief CRC-16/MODBUS initial value */
+#define CRC16_MODBUS_INIT 0xFFFFU
+
+/** @brief Set while a caller owns the "unit", as on the board */
+static volatile bool crc_busy = false;
+
+/*============================================================================*/
+/*                          Secure Services Private Variables                 */
+/*============================================================================*/
+
+/** @brief Set while a task runs a batch */
+static volatile bool secure_busy = false;
+
+/** @brief Runs of each batch size timed by BSP_Secure_Benchmark() */
+#define SECURE_BENCH_RUNS 8U
+
+/*============================================================================*/
+/*                          Flash Private Variables                           */
+/*============================================================================*/
+
+/** @brief Address and size of the device's flash */
+#define FLASH_BASE_ADDRESS 0x08000000UL
+#define FLASH_TOTAL_SIZE   (2U * BSP_FLASH_BANK_SIZE)
+
+/** @brief The mapping, at FLASH_BASE_ADDRESS once mapped */
+static uint8_t *flash_memory = NULL;
+
+/** @brief Address of the update slot sector erased last, 0 before the first */
+static uint32_t flash_erased;
+
+/** @brief Task whose last write failed, NULL if none */
+static TaskHandle_t volatile flash_failed = NULL;
+
+/** @brief Sector buffer of BSP_Flash_SwapBanks() */
+static uint8_t flash_swap_buffer[BSP_FLASH_SECTOR_SIZE];
+
+#if BSP_SPINOR_ENABLE
+/*============================================================================*/
+/*                          SPI NOR Private Variables                         */
+/*============================================================================*/
+
+/** @brief The flash contents, BSP_SPINOR_MAX_SIZE bytes once mapped */
+static uint8_t *spinor_memory = NULL;
+#endif /* BSP_SPINOR_ENABLE */
+
+/*============================================================================*/
+/*                          Watchdog Private Variables                        */
+/*============================================================================*/
+
+/** @brief Timeout set by BSP_Watchdog_Start(), 0 while stopped */
+static volatile uint32_t watchdog_timeout_ms = 0U;
+
+/** @brief Host time of the last kick */
+static volatile uint64_t watchdog_kick_ns = 0U;
+
+/*============================================================================*/
+/*                          Simulated ADC1                                    */
+/*============================================================================*/
+
+/**
+ * @brief Next value of the test signal noise, -ADC1_SIM_NOISE to
+ * ADC1_SIM_NOISE
+ */
+static int32_t adc1_sim_noise(void)
+{
+    adc1_noise = (adc1_noise * 1664525U) + 1013904223U;
+
+    return (int32_t)((adc1_noise >> 16U) % ((2U * ADC1_SIM_NOISE) + 1U)) -
+           (int32_t)ADC1_SIM_NOISE;
+}
+
+/**
+ * @brief Fill one frame of the block from the next line of the CSV file
+ * @param i Frame index in the block
+ * @return false if the file holds no frame
+ *
+ * A line holds the results of channels 0 to 5, comma separated; missing
+ * channels read 0. The file is replayed from the start at its end.
+ */
+static bool adc1_sim_replay(uint32_t i)
+{
+    char  line[128];
+    char *cursor = line;
+
+    if (fgets(line, sizeof(line), adc1_replay) == NULL)
+    {
+        rewind(adc1_replay);
+        if (fgets(line, sizeof(line), adc1_replay) == NULL)
+        {
+            return false;
+        }
+    }
+
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        char         *end;
+        unsigned long value = strtoul(cursor, &end, 10);
+
+        if (end == cursor)
+        {
+            value = 0U;
+        }
+        adc1_block[ch][i] = (uint16_t)((value > BSP_ADC1_FULL_SCALE)
+                                           ? BSP_ADC1_FULL_SCALE
+                                           : value);
+        cursor = (*end == ',') ? (end + 1) : end;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Fill one frame of the block with the test signal
+ * @param i    Frame index in the block
+ * @param time Trigger time of the frame on the capture clock
+ *
+ * A mains-frequency sine on the mains channel and a different steady
+ * level on each other channel, all with a little noise.
+ */
+static void adc1_sim_signal(uint32_t i, uint64_t time)
+{
+    double t = (double)time / (double)BSP_ADC1_TIMESTAMP_HZ;
+
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        double  level;
+        int32_t value;
+
+        if (ch == BSP_ADC1_MAINS_CHANNEL)
+        {
+            level = 0.5 + (ADC1_SIM_MAINS_AMPLITUDE *
+                           sin(2.0 * M_PI * ADC1_SIM_MAINS_HZ * t));
+        }
+        else
+        {
+            level = (double)(ch + 1U) / (double)(BSP_ADC1_NUM_CHANNELS + 1U);
+        }
+
+        value = (int32_t)(level * (double)BSP_ADC1_FULL_SCALE) +
+                adc1_sim_noise();
+        if (value < 0)
+        {
+            value = 0;
+        }
+        else if (value > (int32_t)BSP_ADC1_FULL_SCALE)
+        {
+            value = (int32_t)BSP_ADC1_FULL_SCALE;
+        }
+        adc1_block[ch][i] = (uint16_t)value;
+    }
+}
+
+#if BSP_ADC1_SLOW_CHANNELS
+/**
+ * @brief Take the slow channels of frame @p i once per slow sample period
+ *
+ * As ADC2 on the board, where the other results of the frame are not
+ * converted; the slow results also stand in the latest frame.
+ */
+static void adc1_sim_slow(uint32_t i)
+{
+    uint32_t rank = 0U;
+
+    if (adc1_slow_countdown != 0U)
+    {
+        adc1_slow_countdown--;
+        return;
+    }
+    adc1_slow_countdown = ADC1_SLOW_TRIGGERS(adc1_sample_rate) - 1U;
+
+    if (adc1_slow_count == ADC1_SLOW_RING_SIZE)
+    {
+        adc1_slow_overruns++;
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if (ADC1_IS_SLOW(ch))
+        {
+            adc1_slow_block[adc1_slow_count][rank] = adc1_block[ch][i];
+            adc1_latest_results[ch]                = ADC1_RESULT(i, ch);
+            rank++;
+        }
+    }
+    taskEXIT_CRITICAL();
+    adc1_slow_count++;
+}
+#endif
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+/** @brief The sample hook asked for its alarm (filter task only) */
+static bool adc1_sample_alarm = false;
+
+/**
+ * @brief Filter the low-latency channels of one frame as it is converted
+ * (filter task only)
+ * @param i Index of the frame in the block
+ *
+ * Stands in for the end of sequence interrupt; the block has one slot per
+ * frame.
+ */
+static void adc1_sim_frame(uint32_t i)
+{
+    uint16_t raw[BSP_ADC1_NUM_CHANNELS];
+
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        raw[ch] = (uint16_t)ADC1_RESULT(i, ch);
+    }
+    if (adc1_pipeline_filter_frame(raw, i))
+    {
+        adc1_sample_alarm = true;
+    }
+}
+#endif
+
+/**
+ * @brief Convert the frames of one block (filter task only)
+ * @param start Trigger time of the first frame on the capture clock
+ */
+static void adc1_sim_convert(uint64_t start)
+{
+    for (uint32_t i = 0U; i < adc1_block_samples; i++)
+    {
+        if ((adc1_replay == NULL) || !adc1_sim_replay(i))
+        {
+            adc1_sim_signal(i, start + ((uint64_t)i * g_trigger_period));
+        }
+#if BSP_ADC1_SLOW_CHANNELS
+        adc1_sim_slow(i);
+#endif
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+        adc1_sim_frame(i);
+#endif
+    }
+
+    /* The last frame, for BSP_ADC1_GetResults() */
+    taskENTER_CRITICAL();
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if (!ADC1_IS_SLOW(ch))
+        {
+            adc1_latest_results[ch] =
+                ADC1_RESULT(adc1_block_samples - 1U, ch);
+        }
+    }
+    adc1_latest_frame        = adc1_latest_results;
+    adc1_conversion_complete = true;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Compare a converted block with the watchdog windows (filter task
+ * only)
+ *
+ * Stands in for the watchdog interrupts: an alarm is raised by a block
+ * with a result of its channel outside the window, before the block is
+ * filtered, and clears with the first block with none. The bounds are
+ * compared exactly, without the rounding of the hardware.
+ */
+static void adc1_sim_watchdogs(void)
+{
+    bsp_adc1_awd_config_t config[BSP_ADC1_AWD_COUNT];
+    bsp_adc1_awd_hook_t   hook   = adc1_awd_hook;
+    uint32_t              before = adc1_awd_active;
+    uint32_t              active = 0U;
+    uint32_t              raised;
+
+    taskENTER_CRITICAL();
+    memcpy(config, adc1_awd_config, sizeof(config));
+    taskEXIT_CRITICAL();
+
+    for (uint8_t awd = 0U; awd < BSP_ADC1_AWD_COUNT; awd++)
+    {
+        const uint16_t *results = adc1_block[config[awd].channel];
+
+        for (uint32_t i = 0U; i < adc1_block_samples; i++)
+        {
+            if ((results[i] < config[awd].low) ||
+                (results[i] > config[awd].high))
+            {
+                active |= 1UL << awd;
+                break;
+            }
+        }
+    }
+
+    if (active == before)
+    {
+        return;
+    }
+
+    raised = active & ~before;
+
+    taskENTER_CRITICAL();
+    for (uint32_t bits = raised; bits != 0U; bits &= bits - 1U)
+    {
+        adc1_awd_raised++;
+    }
+    adc1_awd_active = active;
+    taskEXIT_CRITICAL();
+
+    if (hook != NULL)
+    {
+        hook(raised, active);
+    }
+}
+
+/**
+ * @brief End the process once the watchdog has not been kicked in time
+ */
+static void watchdog_check(uint64_t now)
+{
+    uint32_t timeout_ms = watchdog_timeout_ms;
+
+    if ((timeout_ms != 0U) &&
+        ((now - watchdog_kick_ns) > ((uint64_t)timeout_ms * 1000000U)))
+    {
+        (void)printf("[BSP] Watchdog expired after %lu ms\n",
+                     (unsigned long)timeout_ms);
+        (void)fflush(stdout);
+        exit(SIM_EXIT_WATCHDOG);
+    }
+}
+
+/*============================================================================*/
+/*                          Flash Initialization                              */
+/*============================================================================*/
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+/**
+ * @brief Map the flash at its device address
+ *
+ * Backed by the JERRY_SIM_FLASH file if set, created erased, so the
+ * settings and an update survive a restart; otherwise by anonymous
+ * memory, erased at every start.
+ */
+static void flash_init(void)
+{
+    const char *path  = getenv(SIM_FLASH_ENV);
+    int         flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    int         fd    = -1;
+    bool        fresh = true;
+    void       *map;
+
+    if (path != NULL)
+    {
+        struct stat st;
+
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if ((fd < 0) || (fstat(fd, &st) != 0))
+        {
+            (void)printf("[BSP] Cannot open %s: %s\n", path, strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        fresh = (st.st_size == 0);
+        if (fresh && (ftruncate(fd, FLASH_TOTAL_SIZE) != 0))
+        {
+            (void)printf("[BSP] Cannot size %s: %s\n", path, strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        if (!fresh && (st.st_size != (off_t)FLASH_TOTAL_SIZE))
+        {
+            (void)printf("[BSP] %s is not a %u byte flash image\n", path,
+                         (unsigned)FLASH_TOTAL_SIZE);
+            exit(EXIT_FAILURE);
+        }
+        flags = MAP_SHARED;
+    }
+
+    /* The application reads the flash at the device's addresses */
+    map = mmap((void *)FLASH_BASE_ADDRESS, FLASH_TOTAL_SIZE,
+               PROT_READ | PROT_WRITE, flags | MAP_FIXED_NOREPLACE, fd, 0);
+    if ((map == MAP_FAILED) || (map != (void *)FLASH_BASE_ADDRESS))
+    {
+        (void)printf("[BSP] Cannot map the flash at 0x%08lx\n",
+                     (unsigned long)FLASH_BASE_ADDRESS);
+        exit(EXIT_FAILURE);
+    }
+    if (fd >= 0)
+    {
+        (void)close(fd);
+    }
+
+    flash_memory = (uint8_t *)map;
+    if (fresh)
+    {
+        (void)memset(flash_memory, 0xFF, FLASH_TOTAL_SIZE);
+    }
+}
+
+#if BSP_SPINOR_ENABLE
+/*============================================================================*/
+/*                          SPI NOR Initialization                            */
+/*============================================================================*/
+
+/**
+ * @brief Map the SPI NOR flash
+ *
+ * Backed by the JERRY_SIM_NOR file if set, created erased, so the log
+ * survives a restart; otherwise by anonymous memory, erased at every start.
+ * A flash that cannot be mapped is left absent.
+ */
+static void spinor_sim_init(void)
+{
+    const char *path  = getenv(SIM_NOR_ENV);
+    int         flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    int         fd    = -1;
+    bool        fresh = true;
+    void       *map;
+
+    if (path != NULL)
+    {
+        struct stat st;
+
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if ((fd < 0) || (fstat(fd, &st) != 0))
+        {
+            (void)printf("[BSP] Cannot open %s: %s\n", path, strerror(errno));
+            return;
+        }
+
+        fresh = (st.st_size == 0);
+        if ((fresh && (ftruncate(fd, BSP_SPINOR_MAX_SIZE) != 0)) ||
+            (!fresh && (st.st_size != (off_t)BSP_SPINOR_MAX_SIZE)))
+        {
+            (void)printf("[BSP] %s is not a %u byte NOR flash image\n", path,
+                         (unsigned)BSP_SPINOR_MAX_SIZE);
+            (void)close(fd);
+            return;
+        }
+        flags = MAP_SHARED;
+    }
+
+    map = mmap(NULL, BSP_SPINOR_MAX_SIZE, PROT_READ | PROT_WRITE, flags, fd,
+               0);
+    if (fd >= 0)
+    {
+        (void)close(fd);
+    }
+    if (map == MAP_FAILED)
+    {
+        (void)printf("[BSP] Cannot map the NOR flash\n");
+        return;
+    }
+
+    spinor_memory = (uint8_t *)map;
+    if (fresh)
+    {
+        (void)memset(spinor_memory, 0xFF, BSP_SPINOR_MAX_SIZE);
+    }
+}
+#endif /* BSP_SPINOR_ENABLE */
+
+#if BSP_SPIADC_ENABLE
+/*============================================================================*/
+/*                          Simulated SPI ADC                                 */
+/*============================================================================*/
+
+/**
+ * @brief Next value of the test signal noise, -SPIADC_SIM_NOISE to
+ * SPIADC_SIM_NOISE
+ */
+static int32_t spiadc_sim_noise(void)
+{
+    spiadc_noise = (spiadc_noise * 1664525U) + 1013904223U;
+
+    return (int32_t)((spiadc_noise >> 16U) % ((2U * SPIADC_SIM_NOISE) + 1U)) -
+           (int32_t)SPIADC_SIM_NOISE;
+}
+
+/**
+ * @brief Fill one entry with the test signal
+ * @param entry Ring entry
+ * @param frame Frame number since BSP_Init(), the signal time
+ *
+ * A sine on channel 0 and a different steady level, of alternating sign,
+ * on each other channel, all with a little noise.
+ */
+static void spiadc_sim_signal(bsp_spiadc_sample_t *entry, uint64_t frame)
+{
+    double t = (double)frame / (double)BSP_SPIADC_SAMPLE_RATE;
+
+    for (uint32_t ch = 0U; ch < BSP_SPIADC_NUM_CHANNELS; ch++)
+    {
+        double level;
+
+        if (ch == 0U)
+        {
+            level = SPIADC_SIM_SINE_AMPLITUDE *
+                    sin(2.0 * M_PI * SPIADC_SIM_SINE_HZ * t);
+        }
+        else
+        {
+            level = (double)ch / (double)(BSP_SPIADC_NUM_CHANNELS + 1U);
+            if ((ch & 1U) == 0U)
+            {
+                level = -level;
+            }
+        }
+
+        entry->raw[ch] = (int32_t)(level * (double)SPIADC_FULL_SCALE) +
+                         spiadc_sim_noise();
+    }
+}
+
+/**
+ * @brief Publish one block into the sample ring (task only)
+ * @param block      Index of the block on the sample clock
+ * @param capture_ns Capture time of its first frame on the PTP timescale
+ *
+ * Blocks missed since the last one, stopped or dropped, are its gap.
+ */
+static void spiadc_publish_block(uint64_t block, uint64_t capture_ns)
+{
+    uint32_t                head  = spiadc_ring_head;
+    uint64_t                frame = block * BSP_SPIADC_BLOCK_SAMPLES;
+    uint32_t                gap   = 0U;
+    uint32_t                sequence;
+    bsp_spiadc_block_hook_t hook;
+
+    if (spiadc_last_block_valid && (block > (spiadc_last_block + 1U)))
+    {
+        gap = (uint32_t)((block - spiadc_last_block - 1U) *
+                         BSP_SPIADC_BLOCK_SAMPLES);
+    }
+    spiadc_last_block       = block;
+    spiadc_last_block_valid = true;
+
+    spiadc_sequence_skip += gap;
+    spiadc_stats.missed  += gap;
+    sequence              = head + spiadc_sequence_skip;
+
+    for (uint32_t i = 0U; i < BSP_SPIADC_BLOCK_SAMPLES; i++)
+    {
+        bsp_spiadc_sample_t *entry =
+            &spiadc_ring[(head + i) & SPIADC_RING_MASK];
+
+        entry->sequence = sequence + i;
+        entry->gap      = (i == 0U) ? gap : 0U;
+        spiadc_sim_signal(entry, frame + i);
+    }
+
+    /* Block timestamp, rewritten under the busy marker */
+    {
+        uint32_t           index = head / BSP_SPIADC_BLOCK_SAMPLES;
+        adc1_block_time_t *slot =
+            &spiadc_block_times[index & SPIADC_TIME_RING_MASK];
+
+        slot->block = ADC1_TIME_SLOT_BUSY;
+        __DMB();
+        slot->sequence = sequence;
+        slot->time     = frame * SPIADC_PERIOD;
+        slot->time_ns  = capture_ns;
+        __DMB();
+        slot->block = index;
+    }
+
+    __DMB();
+    spiadc_ring_head    = head + BSP_SPIADC_BLOCK_SAMPLES;
+    spiadc_stats.frames += BSP_SPIADC_BLOCK_SAMPLES;
+
+    hook = spiadc_block_hook;
+    if (hook != NULL)
+    {
+        hook(spiadc_ring[(head + BSP_SPIADC_BLOCK_SAMPLES - 1U) &
+                         SPIADC_RING_MASK]
+                 .raw);
+    }
+}
+
+/**
+ * @brief Simulated external ADC
+ * @param pvParameters Unused
+ *
+ * Publishes the blocks due on the sample clock, as the ADC1 filter task
+ * does.
+ */
+static void spiadc_task_entry(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;)
+    {
+        uint64_t due = sim_now_ns() / SPIADC_BLOCK_NS;
+
+        if ((due - spiadc_next_block) > SPIADC_MAX_BEHIND)
+        {
+            if (spiadc_running)
+            {
+                spiadc_stats.block_overruns +=
+                    (uint32_t)(due - spiadc_next_block - SPIADC_MAX_BEHIND);
+            }
+            spiadc_next_block = due - SPIADC_MAX_BEHIND;
+        }
+
+        while (spiadc_next_block < due)
+        {
+            uint64_t block    = spiadc_next_block;
+            uint64_t first_ns = block * SPIADC_BLOCK_NS;
+
+            spiadc_next_block++;
+            if (spiadc_running)
+            {
+                spiadc_publish_block(block, BSP_Time_NowNs() -
+                                                (sim_now_ns() - first_ns));
+            }
+        }
+
+        vTaskDelay(1U);
+    }
+}
+
+/**
+ * @brief Start the simulated external ADC's task
+ * @return BSP_OK, or BSP_ERROR if the task cannot be created
+ */
+static bsp_error_t spiadc_init(void)
+{
+    /* Nodes started together see different noise */
+    spiadc_noise = 1U + sim_node;
+
+    spiadc_task = xTaskCreateStatic(
+        spiadc_task_entry, "SpiAdc", SPIADC_TASK_STACK_SIZE, NULL,
+        SPIADC_TASK_PRIORITY, spiadc_task_stack, &spiadc_task_tcb);
+
+    return (spiadc_task != NULL) ? BSP_OK : BSP_ERROR;
+}
+
+/**
+ * @brief Look up the capture time of a frame in the timestamp history
+ *
+ * As adc1_lookup_time(), on the external ADC's history.
+ */
+static bool spiadc_lookup_time(uint32_t sequence, uint64_t *time,
+                               uint64_t *time_ns)
+{
+    uint32_t blocks = spiadc_ring_head / BSP_SPIADC_BLOCK_SAMPLES;
+
+    for (uint32_t n = 0U; (n < SPIADC_TIME_RING_SIZE) && (n < blocks); n++)
+    {
+        uint32_t                 block = blocks - 1U - n;
+        const adc1_block_time_t *slot =
+            &spiadc_block_times[block & SPIADC_TIME_RING_MASK];
+        uint32_t before;
+        uint32_t after;
+        uint32_t first;
+        uint32_t offset;
+        uint64_t capture;
+        uint64_t capture_ns;
+
+        before = slot->block;
+        __DMB();
+        first      = slot->sequence;
+        capture    = slot->time;
+        capture_ns = slot->time_ns;
+        __DMB();
+        after = slot->block;
+
+        if ((before != block) || (after != block))
+        {
+            /* Rewritten for a newer block meanwhile */
+            return false;
+        }
+
+        offset = sequence - first;
+        if ((int32_t)offset < 0)
+        {
+            continue;
+        }
+        if (offset >= BSP_SPIADC_BLOCK_SAMPLES)
+        {
+            return false;
+        }
+
+        *time = capture + ((uint64_t)offset * SPIADC_PERIOD);
+        if (time_ns != NULL)
+        {
+            *time_ns = capture_ns +
+                       ((uint64_t)offset * SPIADC_PERIOD * ADC1_TIMESTAMP_NS);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+#endif
+
+/*============================================================================*/
+/*                          BSP Initialization                                */
+/*============================================================================*/
+
+bsp_error_t BSP_Init(void)
+{
+    const char *node = getenv(SIM_NODE_ENV);
+    const char *adc  = getenv(SIM_ADC_ENV);
+
+    /* Read with the epoch still 0: the host clock starts now */
+    sim_epoch_ns = sim_now_ns();
+
+    if (node != NULL)
+    {
+        unsigned long address = strtoul(node, NULL, 0);
+
+        if (address > SIM_NODE_MAX)
+        {
+            (void)printf("[BSP] %s=%s out of range, using 0\n", SIM_NODE_ENV,
+                         node);
+            address = 0U;
+        }
+        sim_node = (uint8_t)address;
+    }
+
+    /* Nodes started together see different noise */
+    adc1_noise = 1U + sim_node;
+    if (adc != NULL)
+    {
+        adc1_replay = fopen(adc, "r");
+        if (adc1_replay == NULL)
+        {
+            (void)printf("[BSP] Cannot open %s: %s, using the test signal\n",
+                         adc, strerror(errno));
+        }
+    }
+
+    flash_init();
+#if BSP_SPINOR_ENABLE
+    spinor_sim_init();
+#endif
+
+    /* Initialize ADC filter subsystem */
+    BSP_ADC1_FilterInit();
+#if BSP_SPIADC_ENABLE
+    if (spiadc_init() != BSP_OK)
+    {
+        (void)printf("[BSP] Cannot start the SPI ADC task\n");
+    }
+#endif
+
+    BSP_ADC1_Start();
+#if BSP_SPIADC_ENABLE
+    (void)BSP_SPIADC_Start();
+#endif
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          ADC1 Functions                                    */
+/*============================================================================*/
+
+bsp_error_t BSP_ADC1_Start(void)
+{
+    bsp_error_t ret = BSP_OK;
+
+    taskENTER_CRITICAL();
+    if (adc1_running)
+    {
+        ret = BSP_BUSY;
+    }
+    else
+    {
+        /* Blocks due while stopped are never converted: a gap */
+        adc1_conversion_complete = false;
+        adc1_latest_frame        = NULL;
+        adc1_running             = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_Stop(void)
+{
+    adc1_running             = false;
+    adc1_conversion_complete = false;
+
+    return BSP_OK;
+}
+
+bool BSP_ADC1_IsConversionComplete(void)
+{
+    bool result = false;
+
+    if (adc1_running && adc1_conversion_complete)
+    {
+        /* Clear the flag so caller can detect next conversion */
+        adc1_conversion_complete = false;
+        result                   = true;
+    }
+
+    return result;
+}
+
+bsp_error_t BSP_ADC1_GetResults(const uint32_t **results)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (results == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!adc1_running || (adc1_latest_frame == NULL))
+    {
+        *results = NULL;
+        ret      = BSP_ERROR;
+    }
+    else
+    {
+        *results = adc1_latest_frame;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_GetResultsCopy(uint32_t *buffer)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (buffer == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!adc1_running || (adc1_latest_frame == NULL))
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        memcpy(buffer, (const void *)adc1_latest_frame,
+               BSP_ADC1_NUM_CHANNELS * sizeof(uint32_t));
+        taskEXIT_CRITICAL();
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_SampleNow(uint8_t channel, uint16_t *value)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if ((channel >= BSP_ADC1_NUM_CHANNELS) || (value == NULL))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!adc1_running || (adc1_latest_frame == NULL))
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* No injected group: the channel's result in the latest frame */
+        taskENTER_CRITICAL();
+        *value = (uint16_t)adc1_latest_frame[channel];
+        taskEXIT_CRITICAL();
+    }
+
+    return ret;
+}
+
+/* The simulated converter has no overrun or DMA error */
+
+bool BSP_ADC1_HasError(void) { return false; }
+
+uint32_t BSP_ADC1_GetLastError(void) { return 0U; }
+
+bsp_error_t BSP_ADC1_Restart(void)
+{
+    (void)BSP_ADC1_Stop();
+
+    return BSP_ADC1_Start();
+}
+
+bool BSP_ADC1_CheckAndRestart(void)
+{
+    bool restarted = false;
+
+    if (!adc1_running)
+    {
+        if (BSP_ADC1_Restart() == BSP_OK)
+        {
+            restarted = true;
+        }
+    }
+
+    return restarted;
+}
+
+/*============================================================================*/
+/*                     Filtered ADC1 Functions (Continuous Mode)              */
+/*============================================================================*/
+
+#if BSP_ADC1_PROBE_PINS
+/* The host has no pins to probe; the stage times are kept all the same */
+void adc1_probe_set(adc1_probe_pin_t pin, bool high)
+{
+    (void)pin;
+    (void)high;
+}
+#endif
+
+/**
+ * @brief Filter the simulated block through the block pipeline
+ * @param capture    Capture time of the block's first sample
+ * @param capture_ns Capture time on the PTP timescale
+ * @param wake       Cycles from the block's due time to the filter task
+ *
+ * The slow conversions since the previous block go first. There is no
+ * conversion or interrupt to time on the host: the block counts as
+ * complete, and the task as woken, @p wake cycles before it is filtered.
+ */
+static void adc1_filter_block(uint64_t capture, uint64_t capture_ns,
+                              uint32_t wake)
+{
+    adc1_pipeline_block_t block;
+
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        block.raw[ch] = adc1_block[ch];
+    }
+    block.samples    = adc1_block_samples;
+    block.slot       = 0U;
+    block.period     = g_trigger_period;
+    block.capture    = capture;
+    block.capture_ns = capture_ns;
+    block.conversion = 0U;
+    block.ready      = BSP_CycleCounter_Read() - wake;
+    block.callback   = block.ready;
+    /* The inputs are open: the captured ones stay low, without edges */
+    block.edges       = NULL;
+    block.edge_count  = 0U;
+    block.di_selected = gpiodi_selected;
+    block.di_level    = 0U;
+
+#if BSP_ADC1_SLOW_CHANNELS
+    adc1_pipeline_filter_slow(
+        (const uint16_t(*)[BSP_ADC1_NUM_SLOW_CHANNELS])adc1_slow_block, 0U,
+        adc1_slow_count);
+    adc1_slow_count = 0U;
+#endif
+
+    adc1_pipeline_filter_block(&block);
+}
+
+#if BSP_ADC1_SYNC
+/**
+ * @brief Move the sample clock so that its triggers fall on the PTP grid
+ * @param trigger_ns PTP time of the last trigger of the block just filtered
+ *
+ * The corrections of the board (BSP_ADC1_SetTriggerSync()), without its
+ * limits on where TIM1 can be moved: the blocks that follow are due that
+ * much earlier or later.
+ */
+static void adc1_sync_trigger(uint64_t trigger_ns)
+{
+    uint32_t period_ns = g_trigger_period * ADC1_TIMESTAMP_NS;
+    int32_t  error     = (int32_t)(trigger_ns % period_ns);
+    int32_t  ticks;
+
+    if (!adc1_sync_enabled)
+    {
+        adc1_sync_aligned = false;
+        return;
+    }
+
+    if (error > (int32_t)(period_ns / 2U))
+    {
+        error -= (int32_t)period_ns;
+    }
+    ticks = (error >= 0)
+                ? ((error + (int32_t)(ADC1_TIMESTAMP_NS / 2U)) /
+                   (int32_t)ADC1_TIMESTAMP_NS)
+                : -((-error + (int32_t)(ADC1_TIMESTAMP_NS / 2U)) /
+                    (int32_t)ADC1_TIMESTAMP_NS);
+
+    adc1_sync_aligned = (ticks <= (int32_t)BSP_ADC1_SYNC_ALIGNED_TICKS) &&
+                        (ticks >= -(int32_t)BSP_ADC1_SYNC_ALIGNED_TICKS);
+    if (ticks > (int32_t)BSP_ADC1_SYNC_MAX_STEP)
+    {
+        ticks = (int32_t)BSP_ADC1_SYNC_MAX_STEP;
+    }
+    else if (ticks < -(int32_t)BSP_ADC1_SYNC_MAX_STEP)
+    {
+        ticks = -(int32_t)BSP_ADC1_SYNC_MAX_STEP;
+    }
+    else
+    {
+        /* Within one step */
+    }
+
+    /* Late triggers come earlier */
+    adc1_sync_shift -= ticks;
+}
+#endif /* BSP_ADC1_SYNC */
+
+/**
+ * @brief Switch to the requested sample rate (filter task only)
+ * @param clock Sample clock time now, in capture ticks
+ *
+ * The board's switch without the timers: the block in progress is
+ * dropped and the first block at the new rate starts on its trigger grid
+ * after @p clock, so the next block filtered sees the gap.
+ */
+static void adc1_apply_sample_rate(uint64_t clock)
+{
+    uint32_t                   hz  = adc1_rate_request;
+    const adc_filter_coeffs_t *set = adc_filter_coeffs_for_rate(hz);
+    uint32_t                   period;
+
+    adc1_rate_request = 0U;
+    if ((set == NULL) || (hz == adc1_sample_rate))
+    {
+        return;
+    }
+    period = BSP_ADC1_TIMESTAMP_HZ / hz;
+
+    g_trigger_period   = period;
+    adc1_sample_rate   = hz;
+    adc1_block_samples = BSP_ADC1_BLOCK_SAMPLES_AT(hz);
+    adc1_next_start    = ((clock / period) + 1U) * period;
+#if BSP_ADC1_SLOW_CHANNELS
+    adc1_slow_countdown = 0U;
+#endif
+
+    adc1_pipeline_set_rate(hz);
+}
+
+/**
+ * @brief ADC1 block filter task
+ * @param pvParameters Unused
+ *
+ * Wakes every tick and converts and filters the blocks that have come due
+ * on the host clock. A task more than ADC1_MAX_BEHIND blocks behind drops
+ * the oldest as overruns, as the DMA would overwrite them; blocks due
+ * while ADC1 is stopped are dropped without a count. Either way the next
+ * block filtered sees the gap. The watchdog is checked here too, at the
+ * highest priority, and a change of sample rate is made between blocks.
+ */
+static void adc1_filter_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;)
+    {
+        uint64_t now = sim_now_ns();
+        uint64_t clock =
+            (uint64_t)((int64_t)(now / ADC1_TIMESTAMP_NS) - adc1_sync_shift);
+        uint64_t block_ticks;
+
+        watchdog_check(now);
+
+        if (adc1_rate_request != 0U)
+        {
+            adc1_apply_sample_rate(clock);
+        }
+        block_ticks = (uint64_t)adc1_block_samples * g_trigger_period;
+
+        if (clock >=
+            (adc1_next_start + ((ADC1_MAX_BEHIND + 1U) * block_ticks)))
+        {
+            uint64_t behind = ((clock - adc1_next_start) / block_ticks) -
+                              ADC1_MAX_BEHIND;
+
+            if (adc1_running)
+            {
+                g_filter_block_overruns += (uint32_t)behind;
+            }
+            adc1_next_start += behind * block_ticks;
+        }
+
+        while ((adc1_next_start + block_ticks) <= clock)
+        {
+            uint64_t start    = adc1_next_start;
+            uint64_t capture  = (uint64_t)((int64_t)start + adc1_sync_shift);
+            uint64_t first_ns = capture * ADC1_TIMESTAMP_NS;
+            uint64_t late_ns =
+                sim_now_ns() - (first_ns + (block_ticks * ADC1_TIMESTAMP_NS));
+            uint64_t capture_ns;
+
+            adc1_next_start += block_ticks;
+            if (!adc1_running)
+            {
+                continue;
+            }
+
+            capture_ns = BSP_Time_NowNs() - (sim_now_ns() - first_ns);
+            adc1_sim_convert(capture);
+            adc1_sim_watchdogs();
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+            if (adc1_sample_alarm)
+            {
+                adc1_sample_alarm = false;
+                adc1_pipeline_sample_alarm();
+            }
+#endif
+            adc1_filter_block(capture, capture_ns,
+                              (uint32_t)(late_ns / (SIM_NS_PER_S /
+                                                    BSP_POSIX_CYCLE_HZ)));
+#if BSP_ADC1_SYNC
+            adc1_sync_trigger(capture_ns +
+                              ((uint64_t)(adc1_block_samples - 1U) *
+                               g_trigger_period * ADC1_TIMESTAMP_NS));
+#endif
+        }
+
+        vTaskDelay(1U);
+    }
+}
+
+void BSP_ADC1_FilterInit(void)
+{
+    if (!g_filter_initialized)
+    {
+        /* Filters, calibration and counters */
+        adc1_pipeline_init();
+#if BSP_ADC1_SLOW_CHANNELS
+        adc1_slow_count    = 0U;
+        adc1_slow_overruns = 0U;
+#endif
+
+        adc1_awd_active = 0U;
+        adc1_awd_raised = 0U;
+
+        /* Start the block filter task - it is the simulated ADC1 too */
+        g_filter_task = xTaskCreateStatic(
+            adc1_filter_task, "AdcFilter", ADC1_FILTER_TASK_STACK_SIZE, NULL,
+            ADC1_FILTER_TASK_PRIORITY, g_filter_task_stack, &g_filter_task_tcb);
+
+        /* Mark as initialized - filtered values are now maintained */
+        g_filter_initialized = (g_filter_task != NULL);
+    }
+}
+
+/* The simulated converter takes a new channel at once, with no restart */
+
+bsp_error_t BSP_ADC1_SetWatchdog(uint8_t                      awd,
+                                 const bsp_adc1_awd_config_t *config)
+{
+    if ((awd >= BSP_ADC1_AWD_COUNT) || (config == NULL) ||
+        (config->channel >= BSP_ADC1_NUM_CHANNELS) ||
+        (config->low > config->high))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    adc1_awd_config[awd] = *config;
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_ADC1_GetWatchdogStatus(bsp_adc1_awd_status_t *status)
+{
+    if (status == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    status->active = adc1_awd_active;
+    status->raised = adc1_awd_raised;
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+void BSP_ADC1_SetWatchdogHook(bsp_adc1_awd_hook_t hook)
+{
+    adc1_awd_hook = hook;
+}
+
+bsp_error_t BSP_ADC1_SetSampleRate(uint32_t hz)
+{
+    bsp_error_t ret = BSP_OK;
+
+#if BSP_SPIADC_ENABLE
+    /* The SPI ADC is framed on TIM1's trigger grid on the board */
+    (void)hz;
+    ret = BSP_ERROR;
+#else
+    /* The sequence must end before the next trigger */
+    if ((adc_filter_coeffs_for_rate(hz) == NULL) ||
+        ((BSP_ADC1_TIMESTAMP_HZ % hz) != 0U) ||
+        (BSP_ADC1_SEQUENCE_NS >= (1000000000UL / hz)))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        adc1_rate_request = hz;
+    }
+#endif
+
+    return ret;
+}
+
+uint32_t BSP_ADC1_GetSampleRate(void) { return adc1_sample_rate; }
+
+uint32_t BSP_ADC1_GetBlockSamples(void) { return adc1_block_samples; }
+
+#if BSP_ADC1_SYNC
+void BSP_ADC1_SetTriggerSync(bool enable)
+{
+    adc1_sync_enabled = enable;
+}
+
+bool BSP_ADC1_IsTriggerSynced(void)
+{
+    return adc1_sync_enabled && adc1_sync_aligned;
+}
+#endif /* BSP_ADC1_SYNC */
+
+#if BSP_SPIADC_ENABLE
+/*============================================================================*/
+/*                          SPI ADC Functions                                 */
+/*============================================================================*/
+
+bsp_error_t BSP_SPIADC_Start(void)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (spiadc_task == NULL)
+    {
+        ret = BSP_ERROR;
+    }
+    else if (spiadc_running)
+    {
+        ret = BSP_BUSY;
+    }
+    else
+    {
+        spiadc_running = true;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_SPIADC_Stop(void)
+{
+    spiadc_running = false;
+
+    return BSP_OK;
+}
+
+bool BSP_SPIADC_IsRunning(void) { return spiadc_running; }
+
+void BSP_SPIADC_SetBlockHook(bsp_spiadc_block_hook_t hook)
+{
+    spiadc_block_hook = hook;
+}
+
+bsp_error_t BSP_SPIADC_RingReaderInit(bsp_spiadc_reader_t *reader)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (reader == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else
+    {
+        reader->cursor   = spiadc_ring_head;
+        reader->overruns = 0U;
+    }
+
+    return ret;
+}
+
+uint32_t BSP_SPIADC_RingAvailable(const bsp_spiadc_reader_t *reader)
+{
+    uint32_t available = 0U;
+
+    if (reader != NULL)
+    {
+        available = spiadc_ring_head - reader->cursor;
+        if (available > BSP_SPIADC_RING_SIZE)
+        {
+            available = BSP_SPIADC_RING_SIZE;
+        }
+    }
+
+    return available;
+}
+
+bsp_error_t BSP_SPIADC_RingRead(bsp_spiadc_reader_t *reader,
+                                bsp_spiadc_sample_t *samples,
+                                uint32_t max_count, uint32_t *count)
+{
+    bsp_error_t ret  = BSP_OK;
+    uint32_t    done = 0U;
+
+    if ((reader == NULL) || (samples == NULL) || (count == NULL))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else
+    {
+        uint32_t head   = spiadc_ring_head;
+        uint32_t cursor = reader->cursor;
+
+        /* Skip frames that have already been overwritten */
+        if ((head - cursor) > BSP_SPIADC_RING_SIZE)
+        {
+            reader->overruns += (head - cursor) - BSP_SPIADC_RING_SIZE;
+            cursor            = head - BSP_SPIADC_RING_SIZE;
+        }
+
+        __DMB();
+
+        while ((done < max_count) && (cursor != head))
+        {
+            uint32_t n     = head - cursor;
+            uint32_t first = cursor & SPIADC_RING_MASK;
+            uint32_t lost;
+
+            if (n > (max_count - done))
+            {
+                n = max_count - done;
+            }
+            if (n > (BSP_SPIADC_RING_SIZE - first))
+            {
+                n = BSP_SPIADC_RING_SIZE - first;
+            }
+
+            (void)memcpy(&samples[done], &spiadc_ring[first],
+                         n * sizeof(bsp_spiadc_sample_t));
+
+            /* Drop any entry the block being written could have reached,
+             * as BSP_ADC1_RingRead() */
+            __DMB();
+            head = spiadc_ring_head;
+            lost = 0U;
+            if ((head + BSP_SPIADC_BLOCK_SAMPLES - cursor) >
+                BSP_SPIADC_RING_SIZE)
+            {
+                lost = (head + BSP_SPIADC_BLOCK_SAMPLES - cursor) -
+                       BSP_SPIADC_RING_SIZE;
+                if (lost > n)
+                {
+                    lost = n;
+                }
+                reader->overruns += lost;
+            }
+
+            if (lost > 0U)
+            {
+                (void)memmove(&samples[done], &samples[done + lost],
+                              (n - lost) * sizeof(bsp_spiadc_sample_t));
+            }
+
+            done   += n - lost;
+            cursor += n;
+        }
+
+        reader->cursor = cursor;
+        *count         = done;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_SPIADC_GetSampleTime(uint32_t sequence, uint64_t *time)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (time == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!spiadc_lookup_time(sequence, time, NULL))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_SPIADC_GetSampleTimeNs(uint32_t sequence, uint64_t *time_ns)
+{
+    bsp_error_t ret = BSP_OK;
+    uint64_t    time;
+
+    if (time_ns == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!spiadc_lookup_time(sequence, &time, time_ns))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_SPIADC_GetStats(bsp_spiadc_stats_t *stats)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (stats == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else
+    {
+        *stats = spiadc_stats;
+    }
+
+    return ret;
+}
+#endif
+
+/*============================================================================*/
+/*                     I2C based Digital output                               */
+/*============================================================================*/
+
+/* The expanders are a pin image of 8 bits each: a write lands at once, so
+ * an asynchronous write has completed when BSP_I2CDO_WriteAsync() returns. */
+
+bsp_error_t BSP_I2CDO_init(const uint8_t *addresses, uint8_t count)
+{
+    if ((addresses == NULL) || (count == 0U) ||
+        (count > BSP_I2CDO_MAX_EXPANDERS))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    i2cdo_count   = count;
+    i2cdo_outputs = (count == BSP_I2CDO_MAX_EXPANDERS)
+                        ? 0xFFFFFFFFU
+                        : ((1UL << (8U * count)) - 1U);
+
+    // Set initial state to all low and write to expanders
+    return BSP_I2CDO_Write(0x0000U);
+}
+
+uint32_t BSP_I2CDO_GetCount(void) { return 8U * i2cdo_count; }
+
+/**
+ * @brief Apply the outputs held by BSP_I2CDO_Force() to an output image
+ *
+ * @param value Output image.
+ * @return uint32_t @p value with the held outputs in their forced states,
+ *         cut to the outputs of the expanders.
+ */
+static uint32_t i2cdo_apply_force(uint32_t value)
+{
+    uint32_t mask;
+    uint32_t force;
+
+    taskENTER_CRITICAL();
+    mask  = i2cdo_force_mask;
+    force = i2cdo_force_value;
+    taskEXIT_CRITICAL();
+
+    return ((value & ~mask) | force) & i2cdo_outputs;
+}
+
+bsp_error_t BSP_I2CDO_Write(uint32_t value)
+{
+    bsp_error_t ret = BSP_OK;
+
+    taskENTER_CRITICAL();
+    if (i2cdo_active != NULL)
+    {
+        ret = BSP_BUSY;
+    }
+    else
+    {
+        value           = i2cdo_apply_force(value);
+        i2cdo_pins      = value;
+        i2cdo_shadow    = value;
+        i2cdo_committed = value;
+    }
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+bsp_error_t BSP_I2CDO_Read(uint32_t *value)
+{
+    if (value == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    *value = i2cdo_pins;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_I2CDO_WriteAsync(uint32_t value, bsp_i2cdo_xfer_t *xfer)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (xfer == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    if (i2cdo_active != NULL)
+    {
+        ret = BSP_BUSY;
+    }
+    else
+    {
+        value           = i2cdo_apply_force(value);
+        xfer->value     = value;
+        xfer->pending   = 0U;
+        xfer->waiter    = NULL;
+        xfer->status    = BSP_OK;
+        i2cdo_pins      = value;
+        i2cdo_shadow    = value;
+        i2cdo_committed = value;
+    }
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+bsp_error_t BSP_I2CDO_CommitAsync(bsp_i2cdo_xfer_t *xfer)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (xfer == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    if (i2cdo_shadow != i2cdo_committed)
+    {
+        ret = BSP_I2CDO_WriteAsync(i2cdo_shadow, xfer);
+    }
+    else
+    {
+        xfer->status = BSP_OK;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_I2CDO_Wait(bsp_i2cdo_xfer_t *xfer, uint32_t timeout_ms)
+{
+    bsp_error_t ret;
+
+    if (xfer == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    if (xfer->status == BSP_BUSY)
+    {
+        (void)ulTaskNotifyTakeIndexed(BSP_I2CDO_NOTIFY_INDEX, pdTRUE,
+                                      pdMS_TO_TICKS(timeout_ms));
+    }
+
+    ret = xfer->status;
+    if (ret == BSP_BUSY)
+    {
+        ret = BSP_TIMEOUT;
+    }
+
+    return ret;
+}
+
+bool BSP_I2CDO_IsDone(const bsp_i2cdo_xfer_t *xfer)
+{
+    return (xfer == NULL) || (xfer->status != BSP_BUSY);
+}
+
+bsp_error_t BSP_I2CDO_Stage(uint32_t mask, uint32_t value)
+{
+    taskENTER_CRITICAL();
+    i2cdo_shadow =
+        i2cdo_apply_force((i2cdo_shadow & ~mask) | (value & mask));
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+void BSP_I2CDO_Force(uint32_t mask, uint32_t value)
+{
+    taskENTER_CRITICAL();
+    i2cdo_force_mask  = mask;
+    i2cdo_force_value = value & mask;
+    i2cdo_shadow      = i2cdo_apply_force(i2cdo_shadow);
+    taskEXIT_CRITICAL();
+}
+
+bsp_error_t BSP_I2CDO_Commit(void)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (i2cdo_shadow != i2cdo_committed)
+    {
+        ret = BSP_I2CDO_Write(i2cdo_shadow);
+    }
+
+    return ret;
+}
+
+void BSP_I2CDO_Discard(void)
+{
+    taskENTER_CRITICAL();
+    i2cdo_shadow = i2cdo_apply_force(i2cdo_committed);
+    taskEXIT_CRITICAL();
+}
+
+uint32_t BSP_I2CDO_GetShadow(void) { return i2cdo_shadow; }
+
+uint32_t BSP_I2CDO_GetCommitted(void) { return i2cdo_committed; }
+
+bsp_error_t BSP_I2CDO_Verify(void)
+{
+    uint32_t    readback = 0U;
+    bsp_error_t ret      = BSP_I2CDO_Read(&readback);
+
+    if ((ret == BSP_OK) && (readback != i2cdo_committed))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+/* The digital inputs of the host are open: every input reads 0 */
+
+bsp_error_t BSP_GPIODI_Read(uint32_t channel, uint32_t *pVal)
+{
+    if ((channel >= BSP_GPIODI_COUNT) || (NULL == pVal))
+    {
+        return BSP_ERROR;
+    }
+
+    *pVal = 0U;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_GPIODI_ReadAll(uint8_t *pBits)
+{
+    if (NULL == pBits)
+    {
+        return BSP_ERROR;
+    }
+
+    *pBits = 0U;
+
+    return BSP_OK;
+}
+
+void BSP_GPIODI_DebounceTick(void) {}
+
+uint8_t BSP_GetDeviceAddress(void) { return sim_node; }
+
+/*============================================================================*/
+/*                          RS-485 Functions                                  */
+/*============================================================================*/
+
+/* The host has no RS-485 port: frames are sent to nowhere and none is ever
+ * received, so a Modbus RTU client sees its requests time out. */
+
+/** @brief Largest receiver timeout of the board's USART, in bit times */
+#define RS485_RTO_MAX 0x00FFFFFFU
+
+bsp_error_t BSP_RS485_Init(const bsp_rs485_config_t *config)
+{
+    uint64_t rto_bits;
+
+    if ((config == NULL) || (config->baudrate == 0U) ||
+        (config->parity > BSP_RS485_PARITY_ODD))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* Rejected as on the board */
+    rto_bits = (((uint64_t)config->frame_timeout_us * config->baudrate) +
+                999999U) /
+               1000000U;
+    if ((rto_bits == 0U) || (rto_bits > RS485_RTO_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    if (rs485_owner != NULL)
+    {
+        return BSP_BUSY;
+    }
+
+    (void)memset(&rs485_stats, 0, sizeof(rs485_stats));
+    rs485_owner = xTaskGetCurrentTaskHandle();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_RS485_ReadFrame(uint8_t *frame, uint16_t size,
+                                uint16_t *length, uint32_t timeout_ms)
+{
+    (void)size;
+
+    if ((frame == NULL) || (length == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    *length = 0U;
+    vTaskDelay(pdMS_TO_TICKS(timeout_ms));
+
+    return BSP_TIMEOUT;
+}
+
+bsp_error_t BSP_RS485_Transmit(const uint8_t *data, uint16_t length,
+                               uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+
+    if ((data == NULL) || (length == 0U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    rs485_stats.tx_frames++;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_RS485_GetStats(bsp_rs485_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    *stats = rs485_stats;
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          PWM Functions                                     */
+/*============================================================================*/
+
+bsp_error_t BSP_PWM_Start(uint8_t channel, uint32_t frequency_hz,
+                          uint16_t duty)
+{
+    if ((channel >= BSP_PWM_COUNT) || (frequency_hz < BSP_PWM_MIN_FREQUENCY) ||
+        (frequency_hz > BSP_PWM_MAX_FREQUENCY) || (duty > BSP_PWM_DUTY_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    pwm_state[channel].frequency_hz = frequency_hz;
+    pwm_state[channel].duty         = duty;
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_PWM_SetDuty(uint8_t channel, uint16_t duty)
+{
+    if ((channel >= BSP_PWM_COUNT) || (duty > BSP_PWM_DUTY_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    pwm_state[channel].duty = duty;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_PWM_Stop(uint8_t channel)
+{
+    if (channel >= BSP_PWM_COUNT)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    pwm_state[channel].frequency_hz = 0U;
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          Digital Input Capture Functions                   */
+/*============================================================================*/
+
+/* The inputs never change, so a selected input counts no edge; the host
+ * has no shared EXTI lines to refuse a mask on. */
+
+bsp_error_t BSP_GPIODI_CaptureSelect(uint8_t mask)
+{
+    uint8_t added;
+
+    if ((mask >> BSP_GPIODI_COUNT) != 0U)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    added = mask & (uint8_t)~gpiodi_selected;
+    for (uint8_t ch = 0U; ch < BSP_GPIODI_COUNT; ch++)
+    {
+        if ((added & (1U << ch)) != 0U)
+        {
+            (void)memset(&gpiodi_capture[ch], 0, sizeof(gpiodi_capture[ch]));
+        }
+    }
+    gpiodi_selected = mask;
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+uint8_t BSP_GPIODI_CaptureSelected(void) { return gpiodi_selected; }
+
+bsp_error_t BSP_GPIODI_CaptureRead(uint32_t              channel,
+                                   bsp_gpiodi_capture_t *capture)
+{
+    if ((channel >= BSP_GPIODI_COUNT) || (capture == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    if ((gpiodi_selected & (1U << channel)) != 0U)
+    {
+        *capture = gpiodi_capture[channel];
+    }
+    else
+    {
+        (void)memset(capture, 0, sizeof(*capture));
+    }
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+uint32_t BSP_GPIODI_CaptureRising(uint32_t channel)
+{
+    if ((channel >= BSP_GPIODI_COUNT) ||
+        ((gpiodi_selected & (1U << channel)) == 0U))
+    {
+        return 0U;
+    }
+
+    return gpiodi_capture[channel].rising;
+}
+
+bsp_error_t BSP_GPIODI_EdgeRead(bsp_gpiodi_edge_t *edges, uint32_t max_count,
+                                uint32_t *count)
+{
+    (void)max_count;
+
+    if ((edges == NULL) || (count == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    *count = 0U;
+
+    return BSP_OK;
+}
+
+uint32_t BSP_GPIODI_EdgeOverruns(void) { return 0U; }
+
+/*============================================================================*/
+/*                          CAN Functions                                     */
+/*============================================================================*/
+
+/* The host bus has no other node: frames are counted as sent and none is
+ * received. */
+
+/**
+ * @brief Get the DLC code of a frame's length
+ * @param frame Frame to send
+ * @return uint32_t DLC code, 16 if the length has no code
+ */
+static uint32_t can_length_code(const bsp_can_frame_t *frame)
+{
+    if ((frame->flags & BSP_CAN_FLAG_FD) == 0U)
+    {
+        return ((frame->length <= 8U) &&
+                ((frame->flags & BSP_CAN_FLAG_BRS) == 0U))
+                   ? frame->length
+                   : 16U;
+    }
+
+    for (uint32_t code = 0U; code < 16U; code++)
+    {
+        if (can_dlc_length[code] == frame->length)
+        {
+            return code;
+        }
+    }
+
+    return 16U;
+}
+
+bsp_error_t BSP_CAN_Start(const bsp_can_config_t *config)
+{
+    if ((config == NULL) || (config->nominal_bitrate < BSP_CAN_MIN_BITRATE) ||
+        (config->nominal_bitrate > BSP_CAN_MAX_BITRATE) ||
+        (config->data_bitrate < config->nominal_bitrate) ||
+        (config->data_bitrate > BSP_CAN_MAX_DATA_BITRATE) ||
+        (config->filter_count > BSP_CAN_MAX_FILTERS) ||
+        ((config->filter_count > 0U) && (config->filters == NULL)))
+    {
+        return BSP_INVALID_ARG;
+    }
+    for (uint8_t i = 0U; i < config->filter_count; i++)
+    {
+        if ((config->filters[i].id > BSP_CAN_MAX_ID) ||
+            (config->filters[i].mask > BSP_CAN_MAX_ID))
+        {
+            return BSP_INVALID_ARG;
+        }
+    }
+
+    if (can_running)
+    {
+        return BSP_BUSY;
+    }
+
+    (void)memset(&can_stats, 0, sizeof(can_stats));
+    can_running = true;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_CAN_Stop(void)
+{
+    can_running = false;
+
+    return BSP_OK;
+}
+
+bool BSP_CAN_IsRunning(void) { return can_running; }
+
+bsp_error_t BSP_CAN_Transmit(const bsp_can_frame_t *frame)
+{
+    bsp_error_t status = BSP_OK;
+
+    if ((frame == NULL) || (frame->id > BSP_CAN_MAX_ID) ||
+        (can_length_code(frame) >= 16U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    if (!can_running)
+    {
+        status = BSP_ERROR;
+    }
+    else
+    {
+        can_stats.tx_frames++;
+    }
+    taskEXIT_CRITICAL();
+
+    return status;
+}
+
+bsp_error_t BSP_CAN_Receive(bsp_can_frame_t *frames, uint32_t max_count,
+                            uint32_t *count)
+{
+    (void)max_count;
+
+    if ((frames == NULL) || (count == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    *count = 0U;
+
+    return can_running ? BSP_OK : BSP_ERROR;
+}
+
+bsp_error_t BSP_CAN_GetStats(bsp_can_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    *stats = can_stats;
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          USB Host Functions                                */
+/*============================================================================*/
+
+/* The port starts and no device is ever attached */
+
+bsp_error_t BSP_USBH_Start(void) { return BSP_OK; }
+
+bool BSP_USBH_IsConnected(void) { return false; }
+
+bsp_error_t BSP_USBH_ResetPort(void) { return BSP_ERROR; }
+
+bsp_error_t BSP_USBH_OpenControl(uint8_t address, uint8_t max_packet)
+{
+    (void)address;
+    (void)max_packet;
+
+    return BSP_ERROR;
+}
+
+bsp_error_t BSP_USBH_OpenBulk(uint8_t endpoint, uint16_t max_packet)
+{
+    (void)endpoint;
+    (void)max_packet;
+
+    return BSP_ERROR;
+}
+
+bsp_error_t BSP_USBH_Control(const bsp_usbh_setup_t *setup, uint8_t *data,
+                             uint16_t *actual, uint32_t timeout_ms)
+{
+    (void)setup;
+    (void)data;
+    (void)timeout_ms;
+
+    if (actual != NULL)
+    {
+        *actual = 0U;
+    }
+
+    return BSP_ERROR;
+}
+
+bsp_error_t BSP_USBH_Bulk(uint8_t endpoint, uint8_t *data, uint32_t length,
+                          uint32_t *actual, uint32_t timeout_ms)
+{
+    (void)endpoint;
+    (void)data;
+    (void)length;
+    (void)timeout_ms;
+
+    if (actual != NULL)
+    {
+        *actual = 0U;
+    }
+
+    return BSP_ERROR;
+}
+
+bsp_error_t BSP_USBH_ClearHalt(uint8_t endpoint, uint32_t timeout_ms)
+{
+    (void)endpoint;
+    (void)timeout_ms;
+
+    return BSP_ERROR;
+}
+
+/*============================================================================*/
+/*                          Console Functions                                 */
+/*============================================================================*/
+
+/* The console is the process's standard output */
+
+bsp_error_t BSP_Console_Transmit(const uint8_t *data, uint16_t length,
+                                 uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+
+    if ((data == NULL) || (length == 0U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    if ((fwrite(data, 1U, length, stdout) != length) || (fflush(stdout) != 0))
+    {
+        return BSP_ERROR;
+    }
+
+    return BSP_OK;
+}
+
+void BSP_Console_Write(const uint8_t *data, uint16_t length)
+{
+    if (data == NULL)
+    {
+        return;
+    }
+
+    (void)fwrite(data, 1U, length, stdout);
+    (void)fflush(stdout);
+}
+
+void BSP_Console_SetFaultHook(bsp_console_fault_hook_t hook)
+{
+    console_fault_hook = hook;
+}
+
+void BSP_Console_Fault(void)
+{
+    bsp_console_fault_hook_t hook = console_fault_hook;
+
+    if (console_fault_entered)
+    {
+        return;
+    }
+    console_fault_entered = true;
+
+    if (hook != NULL)
+    {
+        hook();
+    }
+}
+
+/*============================================================================*/
+/*                          CRC Functions                                     */
+/*============================================================================*/
+
+bsp_error_t BSP_CRC16_Modbus(const uint8_t *data, uint16_t length,
+                             uint16_t *crc)
+{
+    uint16_t value = CRC16_MODBUS_INIT;
+
+    if ((data == NULL) || (crc == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    if (crc_busy)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_BUSY;
+    }
+    crc_busy = true;
+    taskEXIT_CRITICAL();
+
+    /* Bitwise, reflected: what the CRC unit computes on the board */
+    for (uint16_t i = 0U; i < length; i++)
+    {
+        value ^= data[i];
+        for (uint8_t bit = 0U; bit < 8U; bit++)
+        {
+            value = ((value & 1U) != 0U)
+                        ? (uint16_t)((value >> 1U) ^
+                                     CRC16_MODBUS_POLY_REFLECTED)
+                        : (uint16_t)(value >> 1U);
+        }
+    }
+
+    *crc = value;
+
+    crc_busy = false;
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          Flash Functions                                   */
+/*============================================================================*/
+
+/* Writes and erases are done in the call, in a critical section, so the
+ * flash is never busy and BSP_Flash_Wait() only reports the result. */
+
+/**
+ * @brief Program quad-words the way the flash controller does
+ * @param address First address programmed
+ * @param data    Source of the quad-words
+ * @param length  Bytes programmed
+ * @param erase_ahead Erase each update slot sector as the write reaches it
+ * @return true if every quad-word was erased before
+ */
+static bool flash_program(uint32_t address, const uint8_t *data,
+                          uint32_t length, bool erase_ahead)
+{
+    for (uint32_t done = 0U; done < length; done += BSP_FLASH_WORD_SIZE)
+    {
+        uint8_t *word = (uint8_t *)(uintptr_t)(address + done);
+
+        if (erase_ahead &&
+            (((address + done - BSP_FLASH_UPDATE_BASE) %
+              BSP_FLASH_SECTOR_SIZE) == 0U) &&
+            (flash_erased != (address + done)))
+        {
+            (void)memset(word, 0xFF, BSP_FLASH_SECTOR_SIZE);
+            flash_erased = address + done;
+        }
+
+        /* A quad-word is programmed once between erases */
+        for (uint32_t i = 0U; i < BSP_FLASH_WORD_SIZE; i++)
+        {
+            if (word[i] != 0xFFU)
+            {
+                return false;
+            }
+        }
+        (void)memcpy(word, &data[done], BSP_FLASH_WORD_SIZE);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Do a write or erase as the calling task's
+ *
+ * @param address     First address programmed, or the sector erased
+ * @param data        Source of the quad-words
+ * @param length      Bytes programmed, 0 for an erase alone
+ * @param erase_ahead Erase each update slot sector as the write reaches it
+ * @param erase       Erase the configuration sector at @p address
+ * @return bsp_error_t BSP_OK, the result is left for BSP_Flash_Wait()
+ */
+static bsp_error_t flash_start(uint32_t address, const void *data,
+                               uint32_t length, bool erase_ahead, bool erase)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    bool         ok   = true;
+
+    taskENTER_CRITICAL();
+    /* A write from the start erases the slot again */
+    if (erase_ahead && (address == BSP_FLASH_UPDATE_BASE))
+    {
+        flash_erased = 0U;
+    }
+    if (flash_failed == self)
+    {
+        flash_failed = NULL;
+    }
+
+    if (erase)
+    {
+        (void)memset((void *)(uintptr_t)address, 0xFF, BSP_FLASH_SECTOR_SIZE);
+    }
+    else
+    {
+        ok = flash_program(address, (const uint8_t *)data, length,
+                           erase_ahead);
+    }
+
+    if (!ok)
+    {
+        flash_failed = self;
+    }
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_Flash_WriteAsync(uint32_t offset, const void *data,
+                                 uint32_t length)
+{
+    if ((data == NULL) || (length == 0U) ||
+        ((offset % BSP_FLASH_WORD_SIZE) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) || (offset > BSP_FLASH_APP_SIZE) ||
+        (length > (BSP_FLASH_APP_SIZE - offset)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start(BSP_FLASH_UPDATE_BASE + offset, data, length, true,
+                       false);
+}
+
+bsp_error_t BSP_Flash_ConfigEraseAsync(uint32_t sector)
+{
+    if (sector >= BSP_FLASH_CONFIG_SECTORS)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start((uint32_t)(uintptr_t)BSP_Flash_ConfigSector(sector),
+                       NULL, 0U, false, true);
+}
+
+bsp_error_t BSP_Flash_ConfigWriteAsync(uint32_t sector, uint32_t offset,
+                                       const void *data, uint32_t length)
+{
+    if ((sector >= BSP_FLASH_CONFIG_SECTORS) || (data == NULL) ||
+        (length == 0U) || ((offset % BSP_FLASH_WORD_SIZE) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) || (offset > BSP_FLASH_SECTOR_SIZE) ||
+        (length > (BSP_FLASH_SECTOR_SIZE - offset)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start(
+        (uint32_t)(uintptr_t)BSP_Flash_ConfigSector(sector) + offset, data,
+        length, false, false);
+}
+
+const uint8_t *BSP_Flash_ConfigSector(uint32_t sector)
+{
+    if (sector >= BSP_FLASH_CONFIG_SECTORS)
+    {
+        return NULL;
+    }
+
+    /* The swap is undone by BSP_Flash_SwapBanks() before the restart */
+    return (const uint8_t *)(uintptr_t)(FLASH_BASE_ADDRESS +
+                                        (sector * BSP_FLASH_BANK_SIZE) +
+                                        BSP_FLASH_CONFIG_OFFSET);
+}
+
+bsp_error_t BSP_Flash_SnapshotEraseAsync(uint32_t sector)
+{
+    if (sector >= BSP_FLASH_SNAPSHOT_SECTORS)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start((uint32_t)(uintptr_t)BSP_Flash_SnapshotSector(sector),
+                       NULL, 0U, false, true);
+}
+
+bsp_error_t BSP_Flash_SnapshotWriteAsync(uint32_t sector, uint32_t offset,
+                                         const void *data, uint32_t length)
+{
+    if ((sector >= BSP_FLASH_SNAPSHOT_SECTORS) || (data == NULL) ||
+        (length == 0U) || ((offset % BSP_FLASH_WORD_SIZE) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) || (offset > BSP_FLASH_SECTOR_SIZE) ||
+        (length > (BSP_FLASH_SECTOR_SIZE - offset)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start(
+        (uint32_t)(uintptr_t)BSP_Flash_SnapshotSector(sector) + offset, data,
+        length, false, false);
+}
+
+bsp_error_t BSP_Flash_SnapshotProgram(uint32_t sector, uint32_t offset,
+                                      const void *data, uint32_t length)
+{
+    if ((sector >= BSP_FLASH_SNAPSHOT_SECTORS) || (data == NULL) ||
+        (length == 0U) || ((offset % BSP_FLASH_WORD_SIZE) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) || (offset > BSP_FLASH_SECTOR_SIZE) ||
+        (length > (BSP_FLASH_SECTOR_SIZE - offset)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* Writes never stay in flight here, so there is none to abandon */
+    if (!flash_program(
+            (uint32_t)(uintptr_t)BSP_Flash_SnapshotSector(sector) + offset,
+            (const uint8_t *)data, length, false))
+    {
+        return BSP_ERROR;
+    }
+
+    return BSP_OK;
+}
+
+const uint8_t *BSP_Flash_SnapshotSector(uint32_t sector)
+{
+    if (sector >= BSP_FLASH_SNAPSHOT_SECTORS)
+    {
+        return NULL;
+    }
+
+    return (const uint8_t *)(uintptr_t)(FLASH_BASE_ADDRESS +
+                                        (sector * BSP_FLASH_BANK_SIZE) +
+                                        BSP_FLASH_SNAPSHOT_OFFSET);
+}
+
+bsp_error_t BSP_Flash_Read(const void *address, void *data, uint32_t length)
+{
+    if ((address == NULL) || (data == NULL) ||
+        (((uintptr_t)address % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* The host mapping keeps no ECC, so every quad-word reads back */
+    (void)memcpy(data, address, length);
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_Flash_Wait(uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+
+    return (flash_failed == xTaskGetCurrentTaskHandle()) ? BSP_ERROR : BSP_OK;
+}
+
+bool BSP_Flash_IsBusy(void) { return false; }
+
+/**
+ * @brief Swap the banks and restart
+ *
+ * The banks are exchanged in the mapping itself, so the restarted process
+ * finds the new image in bank 1, never swapped; bank 2 holds the old one.
+ * The process ends with SIM_EXIT_RESET for a supervisor to start it again.
+ */
+bsp_error_t BSP_Flash_SwapBanks(void)
+{
+    uint8_t *bank1 = flash_memory;
+    uint8_t *bank2 = &flash_memory[BSP_FLASH_BANK_SIZE];
+
+    taskENTER_CRITICAL();
+    for (uint32_t at = 0U; at < BSP_FLASH_BANK_SIZE;
+         at += BSP_FLASH_SECTOR_SIZE)
+    {
+        (void)memcpy(flash_swap_buffer, &bank1[at], BSP_FLASH_SECTOR_SIZE);
+        (void)memcpy(&bank1[at], &bank2[at], BSP_FLASH_SECTOR_SIZE);
+        (void)memcpy(&bank2[at], flash_swap_buffer, BSP_FLASH_SECTOR_SIZE);
+    }
+    (void)msync(flash_memory, FLASH_TOTAL_SIZE, MS_SYNC);
+
+    (void)printf("[BSP] Flash banks swapped, resetting\n");
+    (void)fflush(stdout);
+    exit(SIM_EXIT_RESET);
+}
+
+bool BSP_Flash_IsSwapped(void) { return false; }
+
+#if BSP_SPINOR_ENABLE
+/*============================================================================*/
+/*                          SPI NOR Flash Functions                           */
+/*============================================================================*/
+
+/* Reads, programs and erases are done in the call, so an erase has ended
+ * by the time BSP_SPINOR_IsErasing() is asked. */
+
+bsp_error_t BSP_SPINOR_Probe(uint32_t *size)
+{
+    if (size == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+    if (spinor_memory == NULL)
+    {
+        return BSP_ERROR;
+    }
+
+    *size = BSP_SPINOR_MAX_SIZE;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_SPINOR_Read(uint32_t address, void *data, uint32_t length)
+{
+    if ((data == NULL) || (spinor_memory == NULL) ||
+        (address > BSP_SPINOR_MAX_SIZE) ||
+        (length > (BSP_SPINOR_MAX_SIZE - address)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    (void)memcpy(data, &spinor_memory[address], length);
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_SPINOR_ProgramPage(uint32_t address, const void *data)
+{
+    const uint8_t *src = (const uint8_t *)data;
+
+    if ((data == NULL) || (spinor_memory == NULL) ||
+        ((address % BSP_SPINOR_PAGE_SIZE) != 0U) ||
+        (address >= BSP_SPINOR_MAX_SIZE))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* Programming only clears bits */
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0U; i < BSP_SPINOR_PAGE_SIZE; i++)
+    {
+        spinor_memory[address + i] &= src[i];
+    }
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_SPINOR_EraseSector(uint32_t address)
+{
+    if ((spinor_memory == NULL) ||
+        ((address % BSP_SPINOR_SECTOR_SIZE) != 0U) ||
+        (address >= BSP_SPINOR_MAX_SIZE))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    (void)memset(&spinor_memory[address], 0xFF, BSP_SPINOR_SECTOR_SIZE);
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bool BSP_SPINOR_IsErasing(void) { return false; }
+#endif /* BSP_SPINOR_ENABLE */
+
+/*============================================================================*/
+/*                          Secure Services Functions                         */
+/*============================================================================*/
+
+/* Only the random source and the cache switch and monitor exist on the
+ * host: image verification and ECDSA fail as a secure world without keys
+ * would. */
+
+/**
+ * @brief Run one request of a batch
+ * @param request Request, status set on return
+ * @return true if the request succeeded
+ */
+static bool secure_request(bsp_secure_request_t *request)
+{
+    request->status = BSP_SECURE_OK;
+
+    switch (request->op)
+    {
+        case BSP_SECURE_OP_NOP:
+        case BSP_SECURE_OP_ICACHE_ON:
+        case BSP_SECURE_OP_ICACHE_OFF:
+            break;
+
+        case BSP_SECURE_OP_ICACHE_MONITOR:
+            /* No cache, so neither hits nor misses */
+            if ((request->buffer == NULL) || (request->length != 8U))
+            {
+                request->status = BSP_SECURE_INVALID;
+                break;
+            }
+            (void)memset(request->buffer, 0, request->length);
+            break;
+
+        case BSP_SECURE_OP_RANDOM:
+        {
+            ssize_t got;
+
+            if ((request->buffer == NULL) && (request->length != 0U))
+            {
+                request->status = BSP_SECURE_INVALID;
+                break;
+            }
+            got = getrandom(request->buffer, request->length, 0U);
+            if (got < 0)
+            {
+                request->status = BSP_SECURE_ERROR;
+                break;
+            }
+            request->length = (uint32_t)got;
+            break;
+        }
+
+        case BSP_SECURE_OP_VERIFY_START:
+        case BSP_SECURE_OP_VERIFY_UPDATE:
+        case BSP_SECURE_OP_VERIFY_FINISH:
+            request->status = BSP_SECURE_ERROR;
+            break;
+
+        default:
+            request->status = BSP_SECURE_INVALID;
+            break;
+    }
+
+    return request->status == BSP_SECURE_OK;
+}
+
+bsp_error_t BSP_Secure_Batch(bsp_secure_request_t *requests, uint32_t count)
+{
+    uint32_t done = 0U;
+
+    if ((requests == NULL) || (count == 0U) || (count > BSP_SECURE_BATCH_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* Secure calls from two tasks must not nest */
+    taskENTER_CRITICAL();
+    if (secure_busy)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_BUSY;
+    }
+    secure_busy = true;
+    taskEXIT_CRITICAL();
+
+    while ((done < count) && secure_request(&requests[done]))
+    {
+        done++;
+    }
+    for (uint32_t i = done + 1U; i < count; i++)
+    {
+        requests[i].status = BSP_SECURE_SKIPPED;
+    }
+
+    secure_busy = false;
+
+    return (done == count) ? BSP_OK : BSP_ERROR;
+}
+
+bsp_error_t BSP_Random_Read(void *buffer, uint32_t length,
+                            uint32_t *read_length)
+{
+    bsp_secure_request_t request = {
+        .op = BSP_SECURE_OP_RANDOM, .buffer = buffer, .length = length};
+    bsp_error_t ret;
+
+    if (read_length == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    ret          = BSP_Secure_Batch(&request, 1U);
+    *read_length = (ret == BSP_OK) ? request.length : 0U;
+
+    return ret;
+}
+
+bsp_error_t BSP_Ecdsa_Verify(const uint8_t *key, const uint8_t *hash,
+                             const uint8_t *signature)
+{
+    uint8_t              buffer[BSP_ECDSA_REQUEST_SIZE];
+    bsp_secure_request_t request = {.op     = BSP_SECURE_OP_ECDSA_VERIFY,
+                                    .buffer = buffer,
+                                    .length = sizeof(buffer)};
+    bsp_error_t          ret;
+
+    if ((key == NULL) || (hash == NULL) || (signature == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    (void)memcpy(&buffer[0], key, 2U * BSP_ECDSA_CURVE_SIZE);
+    (void)memcpy(&buffer[2U * BSP_ECDSA_CURVE_SIZE], hash,
+                 BSP_ECDSA_CURVE_SIZE);
+    (void)memcpy(&buffer[3U * BSP_ECDSA_CURVE_SIZE], signature,
+                 2U * BSP_ECDSA_CURVE_SIZE);
+
+    ret = BSP_Secure_Batch(&request, 1U);
+    if ((ret == BSP_ERROR) && (request.status == BSP_SECURE_BAD_SIGNATURE))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_Secure_Benchmark(bsp_secure_bench_t *result)
+{
+    bsp_secure_request_t requests[BSP_SECURE_BATCH_MAX] = {0};
+    uint32_t             fastest[2] = {UINT32_MAX, UINT32_MAX};
+    const uint32_t       sizes[2]   = {1U, BSP_SECURE_BATCH_MAX};
+
+    if (result == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* The fastest run is the one not stretched by interrupts */
+    for (uint32_t run = 0U; run < SECURE_BENCH_RUNS; run++)
+    {
+        for (uint32_t i = 0U; i < 2U; i++)
+        {
+            uint32_t    start  = BSP_CycleCounter_Read();
+            bsp_error_t ret    = BSP_Secure_Batch(requests, sizes[i]);
+            uint32_t    cycles = BSP_CycleCounter_Read() - start;
+
+            if (ret != BSP_OK)
+            {
+                return ret;
+            }
+            if (cycles < fastest[i])
+            {
+                fastest[i] = cycles;
+            }
+        }
+    }
+
+    result->request_cycles =
+        (fastest[1] > fastest[0])
+            ? (fastest[1] - fastest[0]) / (BSP_SECURE_BATCH_MAX - 1U)
+            : 0U;
+    result->call_cycles = (fastest[0] > result->request_cycles)
+                              ? fastest[0] - result->request_cycles
+                              : 0U;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_ICache_Set(bool enable)
+{
+    bsp_secure_request_t request = {
+        .op = enable ? BSP_SECURE_OP_ICACHE_ON : BSP_SECURE_OP_ICACHE_OFF};
+
+    return BSP_Secure_Batch(&request, 1U);
+}
+
+bsp_error_t BSP_ICache_ReadMonitor(bsp_icache_monitor_t *counts)
+{
+    uint32_t             words[2] = {0U, 0U};
+    bsp_secure_request_t request  = {.op     = BSP_SECURE_OP_ICACHE_MONITOR,
+                                     .buffer = words,
+                                     .length = sizeof(words)};
+    bsp_error_t          result;
+
+    if (counts == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    result            = BSP_Secure_Batch(&request, 1U);
+    counts->hits      = words[0];
+    counts->misses    = words[1];
+    counts->hot_start = 0U;
+    counts->hot_size  = 0U;
+
+    return result;
+}
+
+/*============================================================================*/
+/*                          Image Verification Functions                      */
+/*============================================================================*/
+
+bsp_error_t BSP_Verify_Start(void)
+{
+    bsp_secure_request_t request = {.op = BSP_SECURE_OP_VERIFY_START};
+    bsp_error_t          ret     = BSP_Secure_Batch(&request, 1U);
+
+    return ((ret == BSP_OK) || (ret == BSP_BUSY)) ? ret : BSP_ERROR;
+}
+
+bsp_error_t BSP_Verify_Update(const void *data, uint32_t length)
+{
+    bsp_secure_request_t request = {.op     = BSP_SECURE_OP_VERIFY_UPDATE,
+                                    .buffer = (void *)data,
+                                    .length = length};
+
+    return (BSP_Secure_Batch(&request, 1U) == BSP_OK) ? BSP_OK : BSP_ERROR;
+}
+
+bsp_error_t BSP_Verify_Finish(const uint8_t *signature)
+{
+    bsp_secure_request_t request = {.op     = BSP_SECURE_OP_VERIFY_FINISH,
+                                    .buffer = (void *)signature,
+                                    .length = BSP_VERIFY_SIGNATURE_SIZE};
+
+    if (BSP_Secure_Batch(&request, 1U) == BSP_OK)
+    {
+        return BSP_OK;
+    }
+    return (request.status == BSP_SECURE_BAD_SIGNATURE) ? BSP_INVALID_ARG
+                                                        : BSP_ERROR;
+}
+
+/*============================================================================*/
+/*============================================================================*/
+/*                          Cycle Counter Functions                           */
+/*============================================================================*/
+
+/* A cycle of the board's core clock on the host clock, never wrapping in
+ * 64 bits */
+
+uint64_t BSP_CycleCounter_Read64(void)
+{
+    return sim_now_ns() / (SIM_NS_PER_S / BSP_POSIX_CYCLE_HZ);
+}
+
+uint32_t BSP_CycleCounter_Read(void)
+{
+    return (uint32_t)BSP_CycleCounter_Read64();
+}
+
+uint32_t BSP_CycleCounter_Hz(void) { return SystemCoreClock; }
+
+uint32_t BSP_ISR_Enter(bsp_isr_t isr)
+{
+    bsp_isr_trace_hook_t hook  = isr_trace_hook;
+    uint32_t             start = BSP_CycleCounter_Read();
+
+    if ((uint32_t)isr < (uint32_t)BSP_ISR_COUNT)
+    {
+        isr_enter_cycles[isr] = start;
+    }
+
+    if (hook != NULL)
+    {
+        hook(isr, true);
+    }
+
+    return start;
+}
+
+void BSP_ISR_AddCycles(bsp_isr_t isr, uint32_t cycles)
+{
+    bsp_isr_trace_hook_t hook = isr_trace_hook;
+
+    /* Only the handler itself writes its entry, and it does not nest */
+    if ((uint32_t)isr < (uint32_t)BSP_ISR_COUNT)
+    {
+        isr_cycles[isr] += cycles;
+    }
+
+    if (hook != NULL)
+    {
+        hook(isr, false);
+    }
+}
+
+void BSP_ISR_SetTraceHook(bsp_isr_trace_hook_t hook) { isr_trace_hook = hook; }
+
+uint64_t BSP_ISR_GetCycles(bsp_isr_t isr)
+{
+    uint64_t cycles = 0U;
+
+    if ((uint32_t)isr < (uint32_t)BSP_ISR_COUNT)
+    {
+        uint32_t primask = __get_PRIMASK();
+
+        __disable_irq();
+        cycles = isr_cycles[isr];
+        __set_PRIMASK(primask);
+    }
+
+    return cycles;
+}
+
+/*============================================================================*/
+/*                          PC Sampling Functions                             */
+/*============================================================================*/
+
+/* Tasks are threads of the host process: there is no exception frame to
+ * sample, profile the simulation with the host's own tools */
+
+bsp_error_t BSP_Profile_Start(uint32_t hz, bsp_profile_hook_t hook)
+{
+    if ((hook == NULL) || (hz < BSP_PROFILE_MIN_HZ) ||
+        (hz > BSP_PROFILE_MAX_HZ))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return BSP_ERROR;
+}
+
+void BSP_Profile_Stop(void) {}
+
+void BSP_Profile_IRQHandler(uint32_t exc_return, const uint32_t *msp,
+                            const uint32_t *psp)
+{
+    (void)exc_return;
+    (void)msp;
+    (void)psp;
+}
+
+/*============================================================================*/
+/*                          Supply Voltage Detector Functions                 */
+/*============================================================================*/
+
+bsp_error_t BSP_PVD_Start(uint32_t level, bsp_pvd_hook_t hook)
+{
+    if ((hook == NULL) || (level > BSP_PVD_LEVEL_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return BSP_ERROR;
+}
+
+void BSP_PVD_IRQHandler(void) {}
+
+/*============================================================================*/
+/*                          PTP Time Functions                                */
+/*============================================================================*/
+
+/* The PTP clock runs on the host clock from 0 at BSP_Init(), stepped and
+ * trimmed like the MAC's system time. */
+
+/**
+ * @brief Get the PTP time at a host time (interrupts masked)
+ * @param host_ns Host time, not before ptp_base_host_ns
+ */
+static uint64_t ptp_time_at(uint64_t host_ns)
+{
+    int64_t elapsed = (int64_t)(host_ns - ptp_base_host_ns);
+
+    return ptp_base_ns +
+           (uint64_t)(elapsed + ((elapsed * ptp_ppb) / BSP_PTP_NS_PER_S));
+}
+
+uint64_t BSP_Time_NowNs(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint64_t now;
+
+    __disable_irq();
+    now = ptp_time_at(sim_now_ns());
+    __set_PRIMASK(primask);
+
+    return now;
+}
+
+bsp_error_t BSP_PTP_StepNs(int64_t offset_ns)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint64_t host_ns;
+
+    __disable_irq();
+    host_ns          = sim_now_ns();
+    ptp_base_ns      = ptp_time_at(host_ns) + (uint64_t)offset_ns;
+    ptp_base_host_ns = host_ns;
+    __set_PRIMASK(primask);
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_PTP_AdjustFrequency(int32_t ppb)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint64_t host_ns;
+
+    if (ppb > BSP_PTP_MAX_ADJ_PPB)
+    {
+        ppb = BSP_PTP_MAX_ADJ_PPB;
+    }
+    else if (ppb < -BSP_PTP_MAX_ADJ_PPB)
+    {
+        ppb = -BSP_PTP_MAX_ADJ_PPB;
+    }
+
+    /* The new rate applies from now on */
+    __disable_irq();
+    host_ns          = sim_now_ns();
+    ptp_base_ns      = ptp_time_at(host_ns);
+    ptp_base_host_ns = host_ns;
+    ptp_ppb          = ppb;
+    __set_PRIMASK(primask);
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_Time_SleepUntilNs(uint64_t deadline_ns)
+{
+    uint64_t now_ns;
+
+    taskENTER_CRITICAL();
+    if (ptp_sleeper != NULL)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_BUSY;
+    }
+
+    now_ns = BSP_Time_NowNs();
+    if (deadline_ns <= now_ns)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_OK;
+    }
+    if ((deadline_ns - now_ns) > (uint64_t)BSP_TIME_MAX_SLEEP_NS)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_ERROR;
+    }
+    ptp_sleeper = xTaskGetCurrentTaskHandle();
+    taskEXIT_CRITICAL();
+
+    /* No compare timer on the host: the sleep ends on the tick after */
+    while (BSP_Time_NowNs() < deadline_ns)
+    {
+        vTaskDelay(1U);
+    }
+
+    ptp_sleeper = NULL;
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          Cache Functions                                   */
+/*============================================================================*/
+
+void BSP_Cache_CleanRange(const void *addr, size_t size)
+{
+    (void)addr;
+    (void)size;
+
+    /* Complete the buffer writes before the DMA is started */
+    __DSB();
+}
+
+void BSP_Cache_InvalidateRange(void *addr, size_t size)
+{
+    (void)addr;
+    (void)size;
+
+    /* Issue the buffer reads only after the completion was seen */
+    __DMB();
+}
+
+/*============================================================================*/
+/*                          Low Power Functions                               */
+/*============================================================================*/
+
+/* The POSIX port idles in its tick signal: no state is ever entered */
+
+bool BSP_LowPower_StopAllowed(void) { return false; }
+
+uint32_t BSP_LowPower_Sleep(bsp_sleep_state_t state, uint32_t duration_us)
+{
+    (void)state;
+    (void)duration_us;
+
+    return 0U;
+}
+
+/*============================================================================*/
+/*                          Clock Profile Functions                           */
+/*============================================================================*/
+
+/* The host clock cannot be scaled; only the profile is kept */
+
+/** @brief Profile last set */
+static bsp_clock_profile_t clock_profile = BSP_CLOCK_FULL;
+
+bool BSP_Clock_IdleAllowed(void) { return true; }
+
+bsp_error_t BSP_Clock_SetProfile(bsp_clock_profile_t profile)
+{
+    if ((uint32_t)profile >= (uint32_t)BSP_CLOCK_PROFILE_COUNT)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    clock_profile = profile;
+
+    return BSP_OK;
+}
+
+bsp_clock_profile_t BSP_Clock_GetProfile(void) { return clock_profile; }
+
+/*============================================================================*/
+/*                          Independent Watchdog                              */
+/*============================================================================*/
+
+/* Checked by the ADC1 task, see watchdog_check() */
+
+/** @brief Shortest timeout, the IWDG's resolution on the board */
+#define WATCHDOG_MS_PER_COUNT 2U
+
+bsp_error_t BSP_Watchdog_Start(uint32_t timeout_ms)
+{
+    if ((timeout_ms < WATCHDOG_MS_PER_COUNT) ||
+        (timeout_ms > BSP_WATCHDOG_MAX_TIMEOUT_MS))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    watchdog_kick_ns    = sim_now_ns();
+    watchdog_timeout_ms = timeout_ms;
+
+    return BSP_OK;
+}
+
+void BSP_Watchdog_Kick(void) { watchdog_kick_ns = sim_now_ns(); }
+
+/* A process started again after SIM_EXIT_WATCHDOG looks like a power-on */
+bool BSP_Watchdog_CausedReset(void) { return false; }
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Host Stand-ins for the Cortex-M Intrinsics
+ *
+ * Included by bsp.h in place of the Nucleo BSP in the host simulation
+ * build. The few CMSIS intrinsics the application and the lwIP port use
+ * are mapped onto the FreeRTOS POSIX port: PRIMASK is the port's interrupt
+ * mask, which blocks the tick and yield signals of the calling thread, no
+ * code ever runs in handler mode and BASEPRI is always 0. The barriers are
+ * full compiler and processor fences.
+ */
+
+#ifndef BSP_POSIX_H
+#define BSP_POSIX_H
+
+#include <stdint.h>
+
+/** Core clock the cycle counter is scaled to, that of the STM32H563 */
+#define BSP_POSIX_CYCLE_HZ 250000000UL
+
+/**
+ * @brief Interrupt mask of the calling task, 1 while masked
+ */
+uint32_t bsp_posix_get_primask(void);
+
+/**
+ * @brief Mask (1) or unmask (0) the kernel signals
+ */
+void bsp_posix_set_primask(uint32_t primask);
+
+/**
+ * @brief Handler mode test of the port layer, always false on the host
+ *
+ * BaseType_t of the POSIX port is a long.
+ */
+long xPortIsInsideInterrupt(void);
+
+static inline uint32_t __get_PRIMASK(void) { return bsp_posix_get_primask(); }
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+    bsp_posix_set_primask(primask);
+}
+
+static inline void __disable_irq(void) { bsp_posix_set_primask(1U); }
+
+static inline void __enable_irq(void) { bsp_posix_set_primask(0U); }
+
+static inline uint32_t __get_IPSR(void) { return 0U; }
+
+static inline uint32_t __get_BASEPRI(void) { return 0U; }
+
+static inline void __set_BASEPRI(uint32_t basepri) { (void)basepri; }
+
+static inline void __set_BASEPRI_MAX(uint32_t basepri) { (void)basepri; }
+
+static inline void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+static inline void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+static inline void __ISB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+static inline uint8_t __CLZ(uint32_t value)
+{
+    return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+#endif /* BSP_POSIX_H */
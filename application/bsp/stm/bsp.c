@@ -1,754 +1,9835 @@
 #include "bsp.h"
 
+#include <math.h>
 #include <string.h>
 
+#include "FreeRTOS.h"
 #include "adc_filter.h"
+#include "bsp_adc1_pipeline.h"
+#include "bsp_sections.h"
 #include "main.h"
+#include "secure_nsc.h"
 #include "stm32h5xx_hal.h"
+#include "task.h"
 
 /* External declarations */
 void                     SystemClock_Config(void);
 extern uint32_t          __eth_dma_start;
+extern uint32_t          __dma_buffer_start;
+extern uint32_t          __dma_buffer_end;
+extern uint32_t          __text_hot_start;
+extern uint32_t          __text_hot_end;
 extern TIM_HandleTypeDef htim1;
 extern I2C_HandleTypeDef hi2c3;
+extern UART_HandleTypeDef hlpuart1;
+extern HCD_HandleTypeDef hhcd_USB_DRD_FS;
+extern ETH_HandleTypeDef heth;
 
-/* Note: hadc1, Node_GPDMA1_Channel0, List_GPDMA1_Channel0, and
- * handle_GPDMA1_Channel0 are declared extern in main.h */
+/* Note: hadc1 is declared extern in main.h. The ADC1 DMA channel set up by
+ * MX_ADC1_Init() (handle_GPDMA1_Channel0) is replaced by adc1_dma on
+ * GPDMA1 channel 6, one of the two channels with 2D addressing. */
 
 /*============================================================================*/
 /*                          ADC1 Private Variables                            */
 /*============================================================================*/
 
-/** @brief DMA buffer for ADC1 conversion results */
-static uint32_t adc1_dma_buffer[BSP_ADC1_NUM_CHANNELS];
+/** @brief Number of halves in the circular ADC1 DMA buffer */
+#define ADC1_DMA_HALVES 2U
+
+/** @brief GPDMA1 channel moving the ADC1 results, one of the two with 2D
+ * addressing */
+#define ADC1_DMA_CHANNEL GPDMA1_Channel6
+
+/** @brief Interrupt of ADC1_DMA_CHANNEL */
+#define ADC1_DMA_IRQn GPDMA1_Channel6_IRQn
+
+/** @brief Priority of the ADC1 DMA interrupt */
+#define ADC1_DMA_IRQ_PRIORITY 5U
+
+/** @brief Priority of the ADC1 interrupt: injected ends, overruns and
+ * watchdogs */
+#define ADC1_IRQ_PRIORITY 5U
+
+/** @brief Priority of the ADC2 interrupt: watchdogs in dual mode, slow
+ * conversions and their watchdogs otherwise */
+#define ADC2_IRQ_PRIORITY 5U
+
+#if (BSP_ADC1_OVERSAMPLING_LOG2 > 0U)
+/** @brief Result bits below those a watchdog compares: AWD1 takes bits 15:4
+ * of the oversampled result, AWD2 and AWD3 bits 15:8 */
+#define ADC1_AWD1_SHIFT  4U
+#define ADC1_AWD23_SHIFT 8U
+#else
+/** @brief Result bits below those a watchdog compares: AWD1 takes the whole
+ * 12-bit result, AWD2 and AWD3 bits 11:4 */
+#define ADC1_AWD1_SHIFT  0U
+#define ADC1_AWD23_SHIFT 4U
+#endif
+
+/** @brief Largest threshold of AWD1 and of AWD2/AWD3 */
+#define ADC1_AWD1_MAX  0xFFFUL
+#define ADC1_AWD23_MAX 0xFFUL
+
+/** @brief Longest wait for an injected conversion, in milliseconds */
+#define ADC1_SAMPLE_NOW_TIMEOUT_MS 2U
+
+/** @brief ADC2 serves the acquisition: as the dual mode slave, or for the
+ * slow channels */
+#define ADC1_USES_ADC2 \
+    (BSP_ADC1_DUAL_MODE || (BSP_ADC1_SLOW_CHANNELS != 0U))
+
+#if BSP_ADC1_DUAL_MODE
+/** @brief DMA words per frame: ADC1 and ADC2 results packed in one word */
+#define ADC1_FRAME_WORDS (BSP_ADC1_NUM_CHANNELS / 2U)
+
+/** @brief DMA word of a frame holding the result of a channel */
+#define ADC1_RESULT_WORD(ch) ((ch) % ADC1_FRAME_WORDS)
+
+/** @brief Position of a channel's result in its DMA word: ADC2 results
+ * are in the upper half-word */
+#define ADC1_RESULT_SHIFT(ch) (((ch) / ADC1_FRAME_WORDS) * 16U)
+
+/** @brief Frame @p i of a DMA half, the halves being blocks at the rate in
+ * force */
+#define ADC1_FRAME(half, i) \
+    adc1_dma_buffer[((half) * adc1_block_samples) + (i)]
+
+/** @brief Result of channel @p ch in frame @p i of a DMA half */
+#define ADC1_RESULT(half, i, ch)                                         \
+    ((ADC1_FRAME(half, i)[ADC1_RESULT_WORD(ch)] >>                       \
+      ADC1_RESULT_SHIFT(ch)) &                                           \
+     0xFFFFUL)
+
+/** @brief Number of words the DMA fills in the ADC1 DMA buffer */
+#define ADC1_DMA_LENGTH \
+    (ADC1_DMA_HALVES * adc1_block_samples * ADC1_FRAME_WORDS)
+#else
+/** @brief Plane of channel @p ch in the DMA buffer, its rank in the regular
+ * sequence: the fast channels below it */
+#define ADC1_PLANE(ch) \
+    BSP_ADC1_COUNT_BITS(ADC1_FAST_CHANNELS & ((1UL << (ch)) - 1U))
+
+/** @brief Results in plane @p plane of a DMA half, the halves being blocks
+ * at the rate in force */
+#define ADC1_PLANE_HALF(plane, half) \
+    (&adc1_dma_buffer[plane][(half) * adc1_block_samples])
+
+/** @brief Results of fast channel @p ch in a DMA half */
+#define ADC1_HALF(ch, half) ADC1_PLANE_HALF(ADC1_PLANE(ch), half)
+
+/** @brief Result of channel @p ch in frame @p i of a DMA half */
+#define ADC1_RESULT(half, i, ch) ((uint32_t)ADC1_HALF(ch, half)[i])
+
+/** @brief Bytes from one channel's plane to the next */
+#define ADC1_PLANE_SIZE                                       \
+    ((int32_t)(ADC1_DMA_HALVES * BSP_ADC1_MAX_BLOCK_SAMPLES * \
+               sizeof(uint16_t)))
+#endif
+
+/** @brief Pending-block bit for the first half of the DMA buffer */
+#define ADC1_BLOCK_FIRST_HALF (1UL << 0U)
+
+/** @brief Pending-block bit for the second half of the DMA buffer */
+#define ADC1_BLOCK_SECOND_HALF (1UL << 1U)
+
+/** @brief Retry interval while ADC1 cannot be resumed after an error (ms) */
+#define ADC1_RECOVER_RETRY_MS 10U
+
+/** @brief ADC1 block filter task stack size (words) */
+#define ADC1_FILTER_TASK_STACK_SIZE 256U
+
+/** @brief ADC1 block filter task priority (task_priorities.h) */
+#define ADC1_FILTER_TASK_PRIORITY TASK_PRIO_ADC_FILTER
+
+_Static_assert(BSP_ADC1_OVERSAMPLING_LOG2 <= 8U,
+               "ADC1 oversampling ratio above 256");
+_Static_assert(BSP_ADC1_OVERSAMPLING_SHIFT <= BSP_ADC1_OVERSAMPLING_LOG2,
+               "ADC1 oversampling shift drops conversion bits");
+_Static_assert(BSP_ADC1_SEQUENCE_NS < (1000000000UL / ADC_FILTER_SAMPLE_RATE),
+               "ADC1 sequence longer than the default trigger period");
+
+#if BSP_ADC1_SLOW_CHANNELS
+/** @brief Remainder of a rate of the generated sets by the slow rate */
+#define ADC1_SLOW_RATE_REMAINDER(set, hz) \
+    (((hz) % ADC_FILTER_SLOW_SAMPLE_RATE) != 0U) +
+
+_Static_assert(!BSP_ADC1_DUAL_MODE,
+               "ADC1 slow channels need ADC2 outside dual mode");
+_Static_assert(BSP_ADC1_NUM_SLOW_CHANNELS <= 4U,
+               "ADC1 slow channels beyond the 4 injected ranks of ADC2");
+_Static_assert(!ADC1_IS_SLOW(0U) && !ADC1_IS_SLOW(BSP_ADC1_MAINS_CHANNEL),
+               "ADC1 channel 0 is the mains channel and not on ADC2");
+_Static_assert((ADC_FILTER_FOR_EACH_RATE(ADC1_SLOW_RATE_REMAINDER) 0U) == 0U,
+               "ADC1 sample rates must be multiples of the slow rate");
+_Static_assert(ADC1_SLOW_TRIGGERS(ADC_FILTER_MAX_SAMPLE_RATE) <= 65536UL,
+               "ADC1 slow rate beyond the TIM1 repetition counter");
+#endif
+
+#if BSP_ADC1_DUAL_MODE
+_Static_assert((ADC1_FRAME_WORDS * 2U) == BSP_ADC1_NUM_CHANNELS,
+               "ADC1 dual mode needs an even number of channels");
+
+/**
+ * @brief Circular DMA buffer for ADC1 conversion results
+ *
+ * Two halves of one block of frames each, at the rate in force, one after
+ * the other from the start; a frame holds one conversion of every channel.
+ * Each word is one ADC1/ADC2 pair (ADC12 CDR), channel n and n +
+ * ADC1_FRAME_WORDS; read results with ADC1_RESULT().
+ */
+static uint32_t adc1_dma_buffer[ADC1_DMA_HALVES * BSP_ADC1_MAX_BLOCK_SAMPLES]
+                               [ADC1_FRAME_WORDS] BSP_SECTION_DMA;
+
+_Static_assert(((BSP_ADC1_BLOCK_QUANTUM * sizeof(adc1_dma_buffer[0])) %
+                BSP_CACHE_LINE_SIZE) == 0U,
+               "ADC1 DMA halves must be whole cache lines");
+#else
+/**
+ * @brief Planar DMA buffer for ADC1 conversion results
+ *
+ * One plane per channel of the regular sequence, the slow channels left
+ * out, each holding both halves of one block of results at the rate in
+ * force, one after the other from the start of the plane, so a channel's
+ * block is contiguous. The DMA writes one frame per block of its
+ * repeated-block transfer, jumping to the next plane after every result;
+ * see BSP_ADC1_Start().
+ */
+static uint16_t adc1_dma_buffer[BSP_ADC1_NUM_FAST_CHANNELS]
+                               [ADC1_DMA_HALVES * BSP_ADC1_MAX_BLOCK_SAMPLES]
+    BSP_SECTION_DMA;
+
+_Static_assert(((BSP_ADC1_BLOCK_QUANTUM * sizeof(uint16_t)) %
+                BSP_CACHE_LINE_SIZE) == 0U,
+               "ADC1 DMA half planes must be whole cache lines");
+_Static_assert((sizeof(adc1_dma_buffer[0]) % BSP_CACHE_LINE_SIZE) == 0U,
+               "ADC1 DMA planes must be whole cache lines");
+#endif
+
+#if ADC1_USES_ADC2
+/** @brief ADC2: the slave converting channels ADC1_FRAME_WORDS and up in
+ * dual mode, otherwise the converter of the slow channels */
+static ADC_HandleTypeDef hadc2;
+#endif
+
+/** @brief ADC1 DMA channel, its node and queue: a repeated-block 2D node
+ * (linear in dual mode) run as a circular list */
+static DMA_HandleTypeDef adc1_dma;
+static DMA_NodeTypeDef   adc1_dma_node;
+static DMA_QListTypeDef  adc1_dma_list;
+
+/** @brief Most recently completed frame (last frame of the last half) */
+static const uint32_t *volatile adc1_latest_frame = NULL;
+
+/** @brief Latest frame, one result per channel (DMA ISR) */
+static uint32_t adc1_latest_results[BSP_ADC1_NUM_CHANNELS];
 
 /** @brief Flag indicating ADC1 is running */
 static volatile bool adc1_running = false;
 
+/** @brief ADC1 sample rate in force (Hz) */
+static volatile uint32_t adc1_sample_rate = ADC_FILTER_SAMPLE_RATE;
+
+/** @brief Frames per DMA half at adc1_sample_rate */
+static volatile uint32_t adc1_block_samples = BSP_ADC1_BLOCK_SAMPLES;
+
+/** @brief Sample rate requested from the filter task (Hz), 0 for none */
+static volatile uint32_t adc1_rate_request = 0U;
+
 /** @brief Flag indicating a complete conversion sequence is available */
 static volatile bool adc1_conversion_complete = false;
 
-/** @brief Flag indicating ADC1 error occurred (for restart) */
-static volatile bool adc1_error_occurred = false;
+/** @brief Flag indicating ADC1 error occurred (for restart) */
+static volatile bool adc1_error_occurred = false;
+
+/** @brief ADC1 error code for debugging */
+static volatile uint32_t adc1_last_error = 0;
+
+/** @brief Input of each channel, in the order of the regular sequence */
+static const uint32_t adc1_channels[BSP_ADC1_NUM_CHANNELS] = {
+    ADC_CHANNEL_2,  ADC_CHANNEL_3,  ADC_CHANNEL_5,
+    ADC_CHANNEL_10, ADC_CHANNEL_12, ADC_CHANNEL_13};
+
+#if BSP_ADC1_SLOW_CHANNELS
+/** @brief Injected ranks of ADC2, in order */
+static const uint32_t adc1_slow_ranks[] = {
+    ADC_INJECTED_RANK_1, ADC_INJECTED_RANK_2, ADC_INJECTED_RANK_3,
+    ADC_INJECTED_RANK_4};
+
+/** @brief Channel converted in each injected rank of ADC2 */
+static uint8_t adc1_slow_channels[BSP_ADC1_NUM_SLOW_CHANNELS];
+
+/** @brief Slow conversions for the filter task, one result per rank */
+static uint16_t adc1_slow_ring[ADC1_SLOW_RING_SIZE]
+                              [BSP_ADC1_NUM_SLOW_CHANNELS];
+
+/** @brief Slow conversions queued (ADC2 ISR) and filtered (filter task) so
+ * far */
+static volatile uint32_t adc1_slow_head = 0U;
+static uint32_t          adc1_slow_tail = 0U;
+
+/** @brief Slow conversions dropped with the queue full */
+static volatile uint32_t adc1_slow_overruns = 0U;
+#endif
+
+/** @brief Task in BSP_ADC1_SampleNow(), NULL if none */
+static TaskHandle_t volatile adc1_sampler = NULL;
+
+/** @brief Result of the last injected conversion (ADC1 ISR) */
+static volatile uint16_t adc1_sample_value = 0U;
+
+/** @brief Windows of the analog watchdogs, as last set */
+static bsp_adc1_awd_config_t adc1_awd_config[BSP_ADC1_AWD_COUNT] = {
+    {0U, 0U, (uint16_t)BSP_ADC1_FULL_SCALE},
+    {1U, 0U, (uint16_t)BSP_ADC1_FULL_SCALE},
+    {2U, 0U, (uint16_t)BSP_ADC1_FULL_SCALE}};
+
+/** @brief Channel each watchdog is set to watch in the ADC */
+static uint8_t adc1_awd_channels[BSP_ADC1_AWD_COUNT] = {0U, 1U, 2U};
+
+/** @brief A channel of adc1_awd_config is not yet the one watched */
+static volatile bool adc1_awd_reassign = false;
+
+/** @brief Watchdogs whose interrupt fired, bit n for AWD n+1 (ADC ISR) */
+static volatile uint32_t adc1_awd_fired = 0U;
+
+/** @brief Watchdogs fired since the end of the last block (filter task
+ * only) */
+static uint32_t adc1_awd_seen = 0U;
+
+/** @brief Alarms active, bit n for AWD n+1 */
+static volatile uint32_t adc1_awd_active = 0U;
+
+/** @brief Alarms raised since BSP_ADC1_FilterInit() */
+static volatile uint32_t adc1_awd_raised = 0U;
+
+/** @brief Function run when the alarms change, NULL for none */
+static volatile bsp_adc1_awd_hook_t adc1_awd_hook = NULL;
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+/** @brief DMA buffer frame the next end of sequence completes, counted
+ * over both halves (ADC1 and DMA ISRs) */
+static volatile uint32_t adc1_frame_slot = 0U;
+
+/** @brief The sample hook asked for its alarm (ADC1 ISR) */
+static volatile bool adc1_sample_alarm = false;
+#endif
+
+/*============================================================================*/
+/*                     Filtered ADC Private Variables                         */
+/*============================================================================*/
+
+/** @brief DMA halves completed but not yet filtered (ADC1_BLOCK_* bits) */
+static volatile uint32_t g_filter_pending = 0U;
+
+/** @brief Half completed most recently by the DMA (0 or 1) */
+static volatile uint32_t g_filter_last_half = 0U;
+
+/** @brief Block filter task control block and stack */
+static StaticTask_t g_filter_task_tcb;
+static StackType_t  g_filter_task_stack[ADC1_FILTER_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** @brief Block filter task handle, NULL until BSP_ADC1_FilterInit() */
+static TaskHandle_t g_filter_task = NULL;
+
+/** @brief Cycle counter at the trigger of the last frame of each half */
+static volatile uint32_t g_block_trigger_cycles[ADC1_DMA_HALVES];
+
+/** @brief Cycle counter at the DMA interrupt entry of each half */
+static volatile uint32_t g_block_isr_cycles[ADC1_DMA_HALVES];
+
+/** @brief Cycle counter at the block callback of each half */
+static volatile uint32_t g_block_callback_cycles[ADC1_DMA_HALVES];
+
+#if BSP_ADC1_PROBE_PINS
+/** @brief Probe pins of the sample path, see BSP_ADC1_PROBE_PINS */
+#define ADC1_PROBE_CALLBACK_PORT GPIOB
+#define ADC1_PROBE_CALLBACK_PIN  GPIO_PIN_0
+#define ADC1_PROBE_FILTER_PORT   GPIOF
+#define ADC1_PROBE_FILTER_PIN    GPIO_PIN_4
+#define ADC1_PROBE_HOOK_PORT     GPIOG
+#define ADC1_PROBE_HOOK_PIN      GPIO_PIN_4
+
+/** @brief Drive a probe pin high or low with one store */
+#define ADC1_PROBE_HIGH(probe) \
+    (ADC1_PROBE_##probe##_PORT->BSRR = ADC1_PROBE_##probe##_PIN)
+#define ADC1_PROBE_LOW(probe)                 \
+    (ADC1_PROBE_##probe##_PORT->BSRR =        \
+         ((uint32_t)ADC1_PROBE_##probe##_PIN << 16U))
+#else
+#define ADC1_PROBE_HIGH(probe) ((void)0)
+#define ADC1_PROBE_LOW(probe)  ((void)0)
+#endif
+
+/*============================================================================*/
+/*                     ADC1 Timebase Private Variables                        */
+/*============================================================================*/
+
+/** @brief Free-running capture timer, started by TIM1 in the same cycle */
+static TIM_HandleTypeDef g_timebase_tim;
+
+/** @brief TIM1 period, i.e. capture ticks per ADC trigger */
+static uint32_t g_trigger_period = 1U;
+
+/** @brief Capture timer count, modulo the trigger period, at which the ADC
+ * trigger fires: TIM1's compare, until BSP_ADC1_SYNC moves TIM1 */
+static uint32_t g_trigger_phase = 0U;
+
+/** @brief Capture timer modulus, a whole number of seconds */
+static uint32_t g_timebase_span = 0U;
+
+/** @brief Capture timer wrap-arounds seen so far (DMA ISR only) */
+static uint32_t g_timebase_wraps = 0U;
+
+/** @brief Capture timer count at the previous DMA event (DMA ISR only) */
+static uint32_t g_timebase_last = 0U;
+
+/** @brief Capture time of the first frame of each DMA half */
+static uint64_t g_block_capture[ADC1_DMA_HALVES];
+
+/** @brief The same on the PTP timescale (ns) */
+static uint64_t g_block_capture_ns[ADC1_DMA_HALVES];
+
+#if BSP_ADC1_SYNC
+/** @brief The trigger follows the PTP time (BSP_ADC1_SetTriggerSync()) */
+static volatile bool g_sync_enabled = false;
+
+/** @brief The last phase error was within BSP_ADC1_SYNC_ALIGNED_TICKS */
+static volatile bool g_sync_aligned = false;
+#endif
+
+#if BSP_SPIADC_ENABLE
+/*============================================================================*/
+/*                          SPI ADC Private Variables                         */
+/*============================================================================*/
+
+/** @brief Capture timer ticks per frame, the TIM8 period */
+#define SPIADC_PERIOD (BSP_ADC1_TIMESTAMP_HZ / BSP_SPIADC_SAMPLE_RATE)
+
+/** @brief TIM8 count up to which CONVST is high, from the period start */
+#define SPIADC_CONVST_TICKS 1U
+
+/** @brief TIM8 count of the request that reads a frame: the conversion
+ * time after the CONVST edge, rounded up, and one tick more */
+#define SPIADC_READ_TICKS \
+    (((BSP_SPIADC_CONVERT_NS + ADC1_TIMESTAMP_NS - 1U) / ADC1_TIMESTAMP_NS) + 1U)
+
+/** @brief SPI1 kernel clock, PLL1Q */
+#define SPIADC_KERNEL_HZ 250000000UL
+
+/** @brief SPI clock */
+#define SPIADC_SCK_HZ (SPIADC_KERNEL_HZ >> BSP_SPIADC_SCK_DIV_LOG2)
+
+/** @brief Capture timer ticks to clock in one frame, rounded up, and one
+ * tick for the restart DMA and the chip select delay */
+#define SPIADC_TRANSFER_TICKS                                         \
+    (((((uint64_t)BSP_SPIADC_NUM_CHANNELS * BSP_SPIADC_RESULT_BITS * \
+        BSP_ADC1_TIMESTAMP_HZ) +                                      \
+       SPIADC_SCK_HZ - 1U) /                                          \
+      SPIADC_SCK_HZ) +                                                \
+     1U)
+
+/** @brief Ticks from the CONVST edge to the last word of the frame */
+#define SPIADC_FRAME_TICKS (SPIADC_READ_TICKS + SPIADC_TRANSFER_TICKS)
+
+/** @brief GPDMA1 channel moving the received words */
+#define SPIADC_DMA_RX_CHANNEL GPDMA1_Channel4
+
+/** @brief Interrupt of SPIADC_DMA_RX_CHANNEL */
+#define SPIADC_DMA_RX_IRQn GPDMA1_Channel4_IRQn
+
+/** @brief GPDMA1 channel restarting SPI1 once per frame */
+#define SPIADC_DMA_RESTART_CHANNEL GPDMA1_Channel5
+
+/** @brief Interrupt priority of the receive DMA, that of the ADC1 DMA, as
+ * both extend the capture timer (timebase_extend_from_isr()) */
+#define SPIADC_DMA_IRQ_PRIORITY ADC1_DMA_IRQ_PRIORITY
+
+/** @brief Publishing task stack size (words) */
+#define SPIADC_TASK_STACK_SIZE 256U
+
+/** @brief Publishing task priority (task_priorities.h) */
+#define SPIADC_TASK_PRIORITY TASK_PRIO_SPI_ADC
+
+/** @brief Time without a block after which the DMA is restarted (ms) */
+#define SPIADC_STALL_MS 20U
+
+/** @brief DMA blocks kept in the timestamp history (power of two) */
+#define SPIADC_TIME_RING_SIZE 16U
+
+/** @brief Index mask for the timestamp history */
+#define SPIADC_TIME_RING_MASK (SPIADC_TIME_RING_SIZE - 1U)
+
+/** @brief Index mask for the sample ring */
+#define SPIADC_RING_MASK (BSP_SPIADC_RING_SIZE - 1U)
+
+_Static_assert((BSP_ADC1_TIMESTAMP_HZ % BSP_SPIADC_SAMPLE_RATE) == 0U,
+               "SPI ADC frame period must be a whole number of ticks");
+_Static_assert(SPIADC_FRAME_TICKS < SPIADC_PERIOD,
+               "SPI ADC frame does not fit its period");
+_Static_assert((BSP_SPIADC_RESULT_BITS >= 9U) &&
+                   (BSP_SPIADC_RESULT_BITS <= 32U),
+               "SPI ADC results must be 9 to 32 bits");
+_Static_assert((BSP_SPIADC_SCK_DIV_LOG2 >= 1U) &&
+                   (BSP_SPIADC_SCK_DIV_LOG2 <= 8U),
+               "SPI ADC clock divider out of range");
+_Static_assert(BSP_SPIADC_NUM_CHANNELS <= 8U,
+               "SPI ADC frames hold at most 8 channels");
+_Static_assert((BSP_SPIADC_RING_SIZE & SPIADC_RING_MASK) == 0U,
+               "SPI ADC ring size must be a power of two");
+_Static_assert(BSP_SPIADC_RING_SIZE >= (2U * BSP_SPIADC_BLOCK_SAMPLES),
+               "SPI ADC ring must hold at least two blocks");
+_Static_assert((SPIADC_TIME_RING_SIZE * BSP_SPIADC_BLOCK_SAMPLES) >=
+                   (BSP_SPIADC_RING_SIZE + BSP_SPIADC_BLOCK_SAMPLES),
+               "SPI ADC timestamp history must cover the sample ring");
+
+/** @brief Received word: half-words up to 16 bits, as RXDR is read */
+#if BSP_SPIADC_RESULT_BITS <= 16U
+typedef uint16_t spiadc_word_t;
+#define SPIADC_SRC_DATAWIDTH  DMA_SRC_DATAWIDTH_HALFWORD
+#define SPIADC_DEST_DATAWIDTH DMA_DEST_DATAWIDTH_HALFWORD
+#else
+typedef uint32_t spiadc_word_t;
+#define SPIADC_SRC_DATAWIDTH  DMA_SRC_DATAWIDTH_WORD
+#define SPIADC_DEST_DATAWIDTH DMA_DEST_DATAWIDTH_WORD
+#endif
+
+/**
+ * @brief Circular DMA buffer of received frames
+ *
+ * Two halves of BSP_SPIADC_BLOCK_SAMPLES frames; a frame is one word per
+ * channel, in the order the converter shifts them out.
+ */
+static spiadc_word_t spiadc_dma_buffer[ADC1_DMA_HALVES]
+                                      [BSP_SPIADC_BLOCK_SAMPLES]
+                                      [BSP_SPIADC_NUM_CHANNELS]
+    BSP_SECTION_DMA;
+
+_Static_assert((sizeof(spiadc_dma_buffer[0]) % BSP_CACHE_LINE_SIZE) == 0U,
+               "SPI ADC DMA halves must be whole cache lines");
+
+/**
+ * @brief Register values the restart DMA writes once per frame
+ *
+ * SPI1 off, which ends the previous transfer; its flags cleared; SPI1 on;
+ * the transfer of BSP_SPIADC_NUM_CHANNELS words started.
+ */
+static uint32_t spiadc_restart_words[4] BSP_SECTION_DMA;
+
+/** @brief Receive DMA, a circular node over both halves */
+static DMA_HandleTypeDef spiadc_dma_rx;
+static DMA_NodeTypeDef   spiadc_rx_node;
+static DMA_QListTypeDef  spiadc_rx_list;
+
+/** @brief Restart DMA, a circular list of three nodes: CR1 on the TIM8
+ * request, then IFCR and CR1 twice without one */
+static DMA_HandleTypeDef spiadc_dma_restart;
+static DMA_NodeTypeDef   spiadc_restart_nodes[3];
+static DMA_QListTypeDef  spiadc_restart_list;
+
+/** @brief TIM8, CONVST on channel 2 and the frame request on channel 3 */
+static TIM_HandleTypeDef spiadc_tim;
+
+/** @brief Set between BSP_SPIADC_Start() and BSP_SPIADC_Stop() */
+static volatile bool spiadc_running = false;
+
+/** @brief Set by a DMA error until the task restarts the transfer */
+static volatile bool spiadc_error = false;
+
+/** @brief Halves waiting for the task, ADC1_BLOCK_*_HALF bits */
+static volatile uint32_t spiadc_pending = 0U;
+
+/** @brief Half filled last, to publish two pending halves in order */
+static volatile uint32_t spiadc_last_half = 0U;
+
+/** @brief Capture time of the first frame of each DMA half */
+static uint64_t spiadc_block_capture[ADC1_DMA_HALVES];
+
+/** @brief The same on the PTP timescale (ns) */
+static uint64_t spiadc_block_capture_ns[ADC1_DMA_HALVES];
+
+/** @brief Capture time of the previous block published (task only) */
+static uint64_t spiadc_last_capture = 0U;
+
+/** @brief spiadc_last_capture is set (task only) */
+static bool spiadc_last_capture_valid = false;
+
+/** @brief Sequence numbers skipped so far (task only) */
+static uint32_t spiadc_sequence_skip = 0U;
+
+/** @brief Counters, written by the task (overruns by the DMA ISR) */
+static bsp_spiadc_stats_t spiadc_stats;
+
+/** @brief Function run per published block */
+static volatile bsp_spiadc_block_hook_t spiadc_block_hook = NULL;
+
+/** @brief Published frames, single producer, any number of readers */
+static bsp_spiadc_sample_t spiadc_ring[BSP_SPIADC_RING_SIZE];
+
+/** @brief Index of the next frame to publish */
+static volatile uint32_t spiadc_ring_head = 0U;
+
+/** @brief Capture time of the recently published blocks, as
+ * g_block_times */
+static adc1_block_time_t spiadc_block_times[SPIADC_TIME_RING_SIZE];
+
+/** @brief Publishing task control block, stack and handle */
+static StaticTask_t spiadc_task_tcb;
+static StackType_t  spiadc_task_stack[SPIADC_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
+static TaskHandle_t spiadc_task = NULL;
+#endif
+
+/*============================================================================*/
+/*                     I2C based Digital output                               */
+/*============================================================================*/
+
+/** @brief I2C3 timing of 100 kHz standard mode from the 64 MHz HSI kernel
+ * clock: PRESC 15 (250 ns), SCLDEL 4, SDADEL 2, SCLH 15, SCLL 19 */
+#define I2CDO_TIMING_HSI_100KHZ 0xF0420F13U
+
+/** @brief HAL (8-bit) addresses of the expanders, output n on n / 8 */
+static uint16_t i2cdo_addresses[BSP_I2CDO_MAX_EXPANDERS];
+
+/** @brief Expanders given to BSP_I2CDO_init(), 0 before */
+static uint8_t i2cdo_count = 0U;
+
+/** @brief Outputs of those expanders, the bits an image keeps */
+static uint32_t i2cdo_outputs = 0U;
+
+/** @brief Output image staged by BSP_I2CDO_Stage(), pushed by Commit */
+static uint32_t i2cdo_shadow = 0U;
+
+/** @brief Output image last written to the expanders (updated from ISR) */
+static volatile uint32_t i2cdo_committed = 0U;
+
+/** @brief Whether the expanders hold i2cdo_committed, false until the
+ * first write succeeds */
+static volatile bool i2cdo_known = false;
+
+/** @brief Asynchronous transfer currently owning I2C3, NULL when idle */
+static bsp_i2cdo_xfer_t *volatile i2cdo_active = NULL;
+
+/** @brief Outputs held by BSP_I2CDO_Force() and their states, changed
+ * together in a critical section */
+static uint32_t i2cdo_force_mask  = 0U;
+static uint32_t i2cdo_force_value = 0U;
+
+/*============================================================================*/
+/*                          RS-485 Private Variables                          */
+/*============================================================================*/
+
+/** @brief Received frames that can wait for the owner task */
+#define RS485_FRAME_QUEUE_SIZE 8U
+
+/** @brief Driver enable time of the transceiver, DE high to line driven */
+#define RS485_DE_ASSERT_NS 1000U
+
+/** @brief DE kept high after the last stop bit, for the transceiver delay */
+#define RS485_DE_DEASSERT_NS 500U
+
+/** @brief Largest DE assertion or deassertion time, in sample times */
+#define RS485_DE_TIME_MAX (USART_CR1_DEAT_Msk >> USART_CR1_DEAT_Pos)
+
+/** @brief Sample times per bit at 16x oversampling */
+#define RS485_SAMPLES_PER_BIT 16U
+
+/** @brief Interrupt priority of USART2 and its DMA channels */
+#define RS485_IRQ_PRIORITY 5U
+
+/** @brief Largest receiver timeout the USART can count, in bit times */
+#define RS485_RTO_MAX (USART_RTOR_RTO_Msk >> USART_RTOR_RTO_Pos)
+
+/** @brief Character errors latched until the end of the frame */
+#define RS485_RX_ERROR_FLAGS \
+    (USART_ISR_PE | USART_ISR_FE | USART_ISR_NE | USART_ISR_ORE)
+
+_Static_assert((BSP_RS485_RX_RING_SIZE & (BSP_RS485_RX_RING_SIZE - 1U)) == 0U,
+               "RS-485 receive ring size must be a power of two");
+_Static_assert((RS485_FRAME_QUEUE_SIZE & (RS485_FRAME_QUEUE_SIZE - 1U)) == 0U,
+               "RS-485 frame queue size must be a power of two");
+
+/**
+ * @brief Location of a received frame in the receive ring
+ */
+typedef struct
+{
+    uint16_t start;  /**< Ring index of the first byte */
+    uint16_t length; /**< Frame length in bytes */
+    bool     error;  /**< A character error was seen during the frame */
+} rs485_frame_t;
+
+/** @brief USART2 handle */
+static UART_HandleTypeDef rs485_uart;
+
+/** @brief Circular receive DMA (GPDMA1 channel 1) and its linked list */
+static DMA_HandleTypeDef rs485_dma_rx;
+static DMA_NodeTypeDef   rs485_rx_node;
+static DMA_QListTypeDef  rs485_rx_list;
+
+/** @brief Transmit DMA (GPDMA1 channel 2) */
+static DMA_HandleTypeDef rs485_dma_tx;
+
+/** @brief Circular receive buffer, written by the DMA only */
+static uint8_t rs485_rx_ring[BSP_RS485_RX_RING_SIZE] BSP_SECTION_DMA;
+
+_Static_assert((BSP_RS485_RX_RING_SIZE % BSP_CACHE_LINE_SIZE) == 0U,
+               "RS-485 receive ring must be whole cache lines");
+
+/** @brief Received frames, head advanced by the ISR, tail by the owner */
+static rs485_frame_t     rs485_frames[RS485_FRAME_QUEUE_SIZE];
+static volatile uint32_t rs485_frame_head = 0U;
+static volatile uint32_t rs485_frame_tail = 0U;
+
+/** @brief Ring index of the frame being received (ISR only) */
+static uint32_t rs485_rx_start = 0U;
+
+/** @brief Character error seen in the frame being received (ISR only) */
+static bool rs485_rx_error = false;
+
+/** @brief Set by the ISR once the transmission has ended */
+static volatile bool rs485_tx_done = false;
+
+/** @brief Transmission ended with a DMA or USART error */
+static volatile bool rs485_tx_error = false;
+
+/** @brief Task notified of frames and transmit completion */
+static TaskHandle_t rs485_owner = NULL;
+
+/** @brief Port statistics */
+static bsp_rs485_stats_t rs485_stats;
+
+/*============================================================================*/
+/*                          PWM Private Variables                             */
+/*============================================================================*/
+
+/** @brief Largest timer count, the counters of TIM3, TIM4 and TIM15 are
+ * 16-bit */
+#define PWM_COUNTER_RANGE 65536U
+
+/** @brief Timer and pin of a PWM output */
+typedef struct
+{
+    TIM_TypeDef  *instance;  /**< Timer, channel 1 drives the pin */
+    GPIO_TypeDef *port;      /**< Port of the pin */
+    uint16_t      pin;       /**< Pin mask */
+    uint8_t       alternate; /**< Alternate function of TIMx_CH1 */
+} pwm_output_t;
+
+/** @brief PWM outputs, indexed by channel */
+static const pwm_output_t pwm_outputs[BSP_PWM_COUNT] = {
+    {TIM3, GPIOC, GPIO_PIN_6, GPIO_AF2_TIM3},
+    {TIM4, GPIOD, GPIO_PIN_12, GPIO_AF2_TIM4},
+    {TIM5, GPIOA, GPIO_PIN_0, GPIO_AF2_TIM5},
+    {TIM15, GPIOE, GPIO_PIN_5, GPIO_AF4_TIM15},
+};
+
+/** @brief Timer handles of the PWM outputs */
+static TIM_HandleTypeDef pwm_tim[BSP_PWM_COUNT];
+
+/** @brief Outputs whose counter runs, bit n = channel n */
+static volatile uint8_t pwm_running = 0U;
+
+/*============================================================================*/
+/*                          Digital Input Private Variables                   */
+/*============================================================================*/
+
+/** @brief Priority of the edge interrupts, masked by critical sections */
+#define GPIODI_IRQ_PRIORITY 5U
+
+/** @brief Marks an EXTI line without a captured input */
+#define GPIODI_LINE_FREE 0xFFU
+
+/** @brief Number of EXTI lines served by GPIO pins */
+#define GPIODI_EXTI_LINES 16U
+
+/** @brief Number of ports the digital inputs are spread over */
+#define GPIODI_PORT_COUNT 5U
+
+/** @brief Ports of the digital inputs, each read once per sample */
+static GPIO_TypeDef *const gpiodi_ports[GPIODI_PORT_COUNT] = {
+    DI0_GPIO_Port, DI1_GPIO_Port, DI2_GPIO_Port, DI5_GPIO_Port, DI7_GPIO_Port,
+};
+
+/** @brief Pin of a digital input */
+typedef struct
+{
+    GPIO_TypeDef *port; /**< Port of the pin */
+    uint16_t      pin;  /**< Pin mask */
+    uint8_t       line; /**< EXTI line, the pin number */
+    IRQn_Type     irq;  /**< Interrupt of the EXTI line */
+    uint8_t       slot; /**< Index of the port in gpiodi_ports */
+} gpiodi_input_t;
+
+/** @brief Digital inputs, indexed by channel */
+static const gpiodi_input_t gpiodi_inputs[BSP_GPIODI_COUNT] = {
+    {DI0_GPIO_Port, DI0_Pin, 2U, EXTI2_IRQn, 0U},
+    {DI1_GPIO_Port, DI1_Pin, 9U, EXTI9_IRQn, 1U},
+    {DI2_GPIO_Port, DI2_Pin, 2U, EXTI2_IRQn, 2U},
+    {DI3_GPIO_Port, DI3_Pin, 1U, EXTI1_IRQn, 2U},
+    {DI4_GPIO_Port, DI4_Pin, 0U, EXTI0_IRQn, 2U},
+    {DI5_GPIO_Port, DI5_Pin, 0U, EXTI0_IRQn, 3U},
+    {DI6_GPIO_Port, DI6_Pin, 1U, EXTI1_IRQn, 3U},
+    {DI7_GPIO_Port, DI7_Pin, 0U, EXTI0_IRQn, 4U},
+};
+
+/** @brief Debounced input states, bit n = DIn */
+static volatile uint8_t gpiodi_debounced = 0U;
+
+/** @brief Vertical counter of the debounce filter, low and high bit planes:
+ * per input, samples that differed from the debounced state in a row */
+static uint8_t gpiodi_count0 = 0U;
+static uint8_t gpiodi_count1 = 0U;
+
+/** @brief Tick of the last debounce sample */
+static volatile TickType_t gpiodi_sample_tick = 0U;
+
+/** @brief Captured input of each EXTI line, GPIODI_LINE_FREE if none */
+static volatile uint8_t gpiodi_line_owner[GPIODI_EXTI_LINES];
+
+/** @brief Captured inputs, bit n = DIn */
+static volatile uint8_t gpiodi_selected = 0U;
+
+/** @brief Counters of the inputs, written by the edge interrupts */
+static bsp_gpiodi_capture_t gpiodi_capture[BSP_GPIODI_COUNT];
+
+/** @brief Edge FIFO, written by the edge interrupts */
+static bsp_gpiodi_edge_t gpiodi_edges[BSP_GPIODI_EDGE_FIFO_SIZE];
+
+/** @brief Edges ever queued (FIFO write index) */
+static volatile uint32_t gpiodi_edge_head = 0U;
+
+/** @brief Edges ever taken (FIFO read index) */
+static volatile uint32_t gpiodi_edge_tail = 0U;
+
+/** @brief Edges dropped on a full FIFO */
+static volatile uint32_t gpiodi_edge_overruns = 0U;
+
+/**
+ * @brief One edge on the capture timer, for the ADC1 timeline
+ */
+typedef struct
+{
+    uint32_t count;   /**< Capture timer count at the interrupt */
+    uint8_t  channel; /**< Digital input */
+    bool     rising;  /**< Rising edge, else falling */
+} gpiodi_stamp_t;
+
+/** @brief Timeline FIFO, written by the edge interrupts and read by the
+ * ADC1 filter task; apart from the edge FIFO, which Modbus reads */
+static gpiodi_stamp_t gpiodi_stamps[BSP_GPIODI_EDGE_FIFO_SIZE];
+
+/** @brief Edges ever queued on the timeline (FIFO write index) */
+static volatile uint32_t gpiodi_stamp_head = 0U;
+
+/** @brief Edges ever merged into the timeline (FIFO read index) */
+static volatile uint32_t gpiodi_stamp_tail = 0U;
+
+/** @brief Edges the filter task takes for one block (filter task only) */
+static adc1_di_edge_t gpiodi_block_edges[BSP_GPIODI_EDGE_FIFO_SIZE];
+
+/*============================================================================*/
+/*                          CAN Private Variables                             */
+/*============================================================================*/
+
+/** @brief Priority of the FDCAN1 interrupt, masked by critical sections */
+#define CAN_IRQ_PRIORITY 5U
+
+/** @brief Kernel clock of FDCAN1: HSE 8 MHz / 4 * 160 / 4 on PLL2Q */
+#define CAN_KERNEL_HZ 80000000UL
+
+/** @brief Longest wait for the controller to enter or leave init mode */
+#define CAN_INIT_TIMEOUT_MS 10U
+
+/** @brief Sample points of the nominal and the data bit, in percent */
+#define CAN_NOMINAL_SAMPLE_POINT 80U
+#define CAN_DATA_SAMPLE_POINT    75U
+
+/** @brief Fewest time quanta per bit */
+#define CAN_MIN_QUANTA 5U
+
+/** @brief Message RAM of FDCAN1, fixed layout (RM0481 FDCAN message RAM) */
+#define CAN_RAM_FILTERS   (SRAMCAN_BASE + 0x000U) /* 28 standard filters */
+#define CAN_RAM_RX_FIFO0  (SRAMCAN_BASE + 0x0B0U) /* 3 RX FIFO 0 elements */
+#define CAN_RAM_TX_BUFFER (SRAMCAN_BASE + 0x278U) /* 3 TX buffers */
+#define CAN_RAM_SIZE      0x350U
+
+/** @brief Size of an RX FIFO or TX buffer element in bytes */
+#define CAN_RAM_ELEMENT_SIZE 72U
+
+/** @brief Number of TX buffers */
+#define CAN_TX_BUFFERS 3U
+
+/** @brief Element header bits shared by RX and TX elements */
+#define CAN_ELEMENT_ID_Pos  18U /* Standard identifier, word 0 */
+#define CAN_ELEMENT_XTD     (1UL << 30U)
+#define CAN_ELEMENT_DLC_Pos 16U /* Data length code, word 1 */
+#define CAN_ELEMENT_BRS     (1UL << 20U)
+#define CAN_ELEMENT_FDF     (1UL << 21U)
+
+/** @brief Standard filter element: classic filter storing in RX FIFO 0 */
+#define CAN_FILTER_CLASSIC_FIFO0 ((2UL << 30U) | (1UL << 27U))
+
+/** @brief Reject frames matching no filter (RXGFC ANFS/ANFE) */
+#define CAN_NON_MATCHING_REJECT 2UL
+
+/** @brief Bit timing of one phase, in time quanta */
+typedef struct
+{
+    uint32_t prescaler; /**< Kernel clocks per time quantum */
+    uint32_t seg1;      /**< Propagation and phase 1 segment */
+    uint32_t seg2;      /**< Phase 2 segment, also the jump width */
+} can_timing_t;
+
+/** @brief Payload length of each data length code */
+static const uint8_t can_dlc_length[16] = {0U,  1U,  2U,  3U,  4U,  5U,
+                                           6U,  7U,  8U,  12U, 16U, 20U,
+                                           24U, 32U, 48U, 64U};
+
+/** @brief Frames waiting for a TX buffer */
+static bsp_can_frame_t can_tx_queue[BSP_CAN_TX_QUEUE_SIZE];
+
+/** @brief Frames ever queued (queue write index) */
+static volatile uint32_t can_tx_head = 0U;
+
+/** @brief Frames ever moved to the controller (queue read index) */
+static volatile uint32_t can_tx_tail = 0U;
+
+/** @brief Set between BSP_CAN_Start() and BSP_CAN_Stop() */
+static volatile bool can_running = false;
+
+/** @brief Port statistics, updated from the interrupt */
+static bsp_can_stats_t can_stats;
+
+/*============================================================================*/
+/*                          USB Host Private Variables                        */
+/*============================================================================*/
+
+/** @brief Priority of the USB interrupt, masked by critical sections */
+#define USBH_IRQ_PRIORITY 5U
+
+/** @brief HCD channels of the pipes */
+#define USBH_CH_CTRL_OUT 0U
+#define USBH_CH_CTRL_IN  1U
+#define USBH_CH_BULK_OUT 2U
+#define USBH_CH_BULK_IN  3U
+
+/** @brief Longest wait for the first SOF after the bus reset */
+#define USBH_ENABLE_TIMEOUT_MS 100U
+
+/** @brief Largest packet of a full-speed control or bulk endpoint */
+#define USBH_MAX_PACKET 64U
+
+/** @brief Largest length of one HCD transfer */
+#define USBH_MAX_TRANSFER 0xFFFFU
+
+/** @brief Set once BSP_USBH_Start() has initialized the HCD */
+static bool usbh_initialized = false;
+
+/** @brief Set once BSP_USBH_Start() has started the HCD */
+static bool usbh_started = false;
+
+/** @brief Device attached, from the connect and disconnect interrupts */
+static volatile bool usbh_connected = false;
+
+/** @brief Task in a transfer, woken on every URB state change */
+static TaskHandle_t usbh_waiter = NULL;
+
+/** @brief Device address and speed the pipes are opened for */
+static uint8_t usbh_address = 0U;
+static uint8_t usbh_speed   = HCD_DEVICE_SPEED_FULL;
+
+/** @brief Endpoint 0 packet size */
+
+/** @brief Endpoint addresses of the open bulk pipes, 0 when closed */
+static uint8_t usbh_bulk_out = 0U;
+static uint8_t usbh_bulk_in  = 0U;
+
+#if BSP_USBD_ENABLE
+/*============================================================================*/
+/*                          USB Device Private Variables                      */
+/*============================================================================*/
+
+/** @brief Priority of the USB interrupt, as for the host port */
+#define USBD_IRQ_PRIORITY USBH_IRQ_PRIORITY
+
+/** @brief Endpoint registers of the control and the bulk IN endpoint */
+#define USBD_EP_CTRL    0U
+#define USBD_EP_BULK_IN (BSP_USBD_EP_BULK_IN & 0x0FU)
+
+/** @brief Packet buffers, after the buffer descriptor table of the eight
+ * endpoint registers */
+#define USBD_PMA_CTRL_TX 0x40U
+#define USBD_PMA_CTRL_RX 0x80U
+#define USBD_PMA_BULK_TX 0xC0U
+
+/** @brief Fields of bmRequestType */
+#define USBD_REQ_TYPE_MASK      0x60U
+#define USBD_REQ_TYPE_STANDARD  0x00U
+#define USBD_REQ_RECIPIENT_MASK 0x1FU
+#define USBD_REQ_TO_DEVICE      0x00U
+#define USBD_REQ_TO_ENDPOINT    0x02U
+
+/** @brief Standard requests (USB 2.0, 9.4) */
+#define USBD_REQ_GET_STATUS        0x00U
+#define USBD_REQ_CLEAR_FEATURE     0x01U
+#define USBD_REQ_SET_FEATURE       0x03U
+#define USBD_REQ_SET_ADDRESS       0x05U
+#define USBD_REQ_GET_DESCRIPTOR    0x06U
+#define USBD_REQ_GET_CONFIGURATION 0x08U
+#define USBD_REQ_SET_CONFIGURATION 0x09U
+#define USBD_REQ_GET_INTERFACE     0x0AU
+#define USBD_REQ_SET_INTERFACE     0x0BU
+
+/** @brief Descriptor types of GET_DESCRIPTOR */
+#define USBD_DESC_DEVICE        0x01U
+#define USBD_DESC_CONFIGURATION 0x02U
+#define USBD_DESC_STRING        0x03U
+#define USBD_DESC_BOS           0x0FU
+
+/** @brief Feature selector of ENDPOINT_HALT */
+#define USBD_FEATURE_ENDPOINT_HALT 0x00U
+
+/** @brief Status bit of a self-powered device */
+#define USBD_STATUS_SELF_POWERED 0x01U
+
+/**
+ * @brief Queued bulk IN transfer
+ */
+typedef struct
+{
+    const uint8_t *data;   /**< Caller's buffer */
+    uint32_t       length; /**< Bytes to send */
+} usbd_transfer_t;
+
+/** @brief Descriptors and callbacks, NULL until BSP_USBD_Start() */
+static const bsp_usbd_config_t *usbd_config = NULL;
+
+/** @brief Configuration set by the host, 0 while not configured */
+static volatile uint8_t usbd_configuration = 0U;
+
+/** @brief Address of SET_ADDRESS, taken once its status stage is sent */
+static bool    usbd_address_pending = false;
+static uint8_t usbd_address         = 0U;
+
+/** @brief Rest of the IN data stage of the control transfer */
+static const uint8_t *usbd_ctrl_data = NULL;
+static uint32_t       usbd_ctrl_left = 0U;
+
+/** @brief The IN data stage ends with a zero-length packet */
+static bool usbd_ctrl_zlp = false;
+
+/** @brief Data of the replies to GET_STATUS, GET_CONFIGURATION and
+ * GET_INTERFACE */
+static uint8_t usbd_ctrl_reply[2];
+
+/** @brief Bulk IN queue; the transfer at the head is on the endpoint */
+static usbd_transfer_t  usbd_queue[BSP_USBD_QUEUE_DEPTH];
+static uint8_t          usbd_queue_head  = 0U;
+static volatile uint8_t usbd_queue_count = 0U;
+
+/** @brief Rest of the transfer at the head of the queue */
+static const uint8_t *usbd_bulk_data = NULL;
+static uint32_t       usbd_bulk_left = 0U;
+
+/** @brief The last packet was a full one that ends the transfer */
+static bool usbd_bulk_zlp = false;
+
+/** @brief The host halted the bulk endpoint (SET_FEATURE) */
+static bool usbd_bulk_halted = false;
+#endif /* BSP_USBD_ENABLE */
+
+/*============================================================================*/
+/*                          Console Private Variables                         */
+/*============================================================================*/
+
+/** @brief Priority of the console interrupts, below the RS-485 port */
+#define CONSOLE_IRQ_PRIORITY 6U
+
+/** @brief Polling limit of BSP_Console_Write() for a DMA transfer to end */
+#define CONSOLE_DMA_DRAIN_SPINS 10000000U
+
+/** @brief Transmit DMA (GPDMA1 channel 3) of the COM1 USART */
+static DMA_HandleTypeDef console_dma_tx;
+
+/** @brief Set by the ISR once the transmission has ended */
+static volatile bool console_tx_done = true;
+
+/** @brief Transmission ended with a DMA or USART error */
+static volatile bool console_tx_error = false;
+
+/** @brief Task waiting in BSP_Console_Transmit() */
+static TaskHandle_t console_tx_waiter = NULL;
+
+/** @brief Run by the first BSP_Console_Fault() */
+static volatile bsp_console_fault_hook_t console_fault_hook = NULL;
+
+/** @brief Set once BSP_Console_Fault() has run */
+static volatile bool console_fault_entered = false;
+
+/*============================================================================*/
+/*                          Low Power Private Variables                       */
+/*============================================================================*/
+
+/** @brief LPTIM1 counter clock, LSI undivided */
+#define LOWPOWER_TIMER_HZ LSI_VALUE
+
+/** @brief Wake-up interrupt line of LPTIM1 (EXTI line 47) */
+#define LOWPOWER_LPTIM1_EXTI_LINE EXTI_IMR2_IM47
+
+/** @brief Priority of the LPTIM1 interrupt, it only ends a sleep */
+#define LOWPOWER_IRQ_PRIORITY 14U
+
+/*============================================================================*/
+/*                          Clock Profile Private Variables                   */
+/*============================================================================*/
+
+/**
+ * @brief How the system clock is set up for a profile
+ */
+typedef struct
+{
+    uint32_t hpre;    /**< AHB prescaler, RCC_SYSCLK_DIVx */
+    uint32_t latency; /**< Flash wait states for HCLK at VOS0 */
+    uint32_t delay;   /**< Flash programming delay for HCLK at VOS0 */
+} clock_setting_t;
+
+/** @brief Settings of each profile; PLL1P is 250 MHz in both */
+static const clock_setting_t clock_settings[BSP_CLOCK_PROFILE_COUNT] = {
+    [BSP_CLOCK_FULL] = {RCC_SYSCLK_DIV1, FLASH_LATENCY_5,
+                        FLASH_PROGRAMMING_DELAY_2},
+    [BSP_CLOCK_IDLE] = {RCC_SYSCLK_DIV4, FLASH_LATENCY_1,
+                        FLASH_PROGRAMMING_DELAY_0},
+};
+
+/** @brief Profile the system clock runs in */
+static volatile bsp_clock_profile_t clock_profile = BSP_CLOCK_FULL;
+
+/** @brief Starts in progress that need the full profile, see clock_hold() */
+static uint32_t clock_holds = 0U;
+
+/*============================================================================*/
+/*                          Cycle Counter Private Variables                   */
+/*============================================================================*/
+
+/** @brief CYCCNT wraps seen by BSP_CycleCounter_Read64() */
+static uint32_t cycle_counter_wraps;
+
+/** @brief CYCCNT at the last BSP_CycleCounter_Read64() */
+static uint32_t cycle_counter_last;
+
+/** @brief Cycles run by each accounted interrupt handler */
+static uint64_t isr_cycles[BSP_ISR_COUNT];
+
+/** @brief Cycle counter at the last entry of each accounted handler */
+static volatile uint32_t isr_enter_cycles[BSP_ISR_COUNT];
+
+/** @brief Trace hook of the accounted interrupts */
+static volatile bsp_isr_trace_hook_t isr_trace_hook = NULL;
+
+/*============================================================================*/
+/*                          PC Sampling Private Variables                     */
+/*============================================================================*/
+
+/** @brief Priority of the sampling interrupt, above the kernel's mask so
+ * that critical sections are sampled too */
+#define PROFILE_IRQ_PRIORITY 4U
+
+/** @brief TIM7 counter clock after the prescaler */
+#define PROFILE_COUNTER_HZ 1000000U
+
+/** @brief EXC_RETURN bits: frame on the process stack, on the secure stack */
+#define PROFILE_EXC_RETURN_SPSEL (1UL << 2U)
+#define PROFILE_EXC_RETURN_S     (1UL << 6U)
+
+/** @brief Words of the exception frame: LR, PC and xPSR */
+#define PROFILE_FRAME_LR   5U
+#define PROFILE_FRAME_PC   6U
+#define PROFILE_FRAME_XPSR 7U
+
+/** @brief Exception number field of the xPSR */
+#define PROFILE_XPSR_EXCEPTION_MASK 0x1FFU
+
+/** @brief Hook given to BSP_Profile_Start(), NULL while stopped */
+static volatile bsp_profile_hook_t profile_hook = NULL;
+
+/*============================================================================*/
+/*                          Supply Voltage Detector Private Variables         */
+/*============================================================================*/
+
+/** @brief Priority of the detector interrupt, above every other one */
+#define PVD_IRQ_PRIORITY 2U
+
+/** @brief Thresholds of BSP_PVD_Start(), 0 to BSP_PVD_LEVEL_MAX */
+static const uint32_t pvd_levels[BSP_PVD_LEVEL_MAX + 1U] = {
+    PWR_PVDLEVEL_0, PWR_PVDLEVEL_1, PWR_PVDLEVEL_2, PWR_PVDLEVEL_3,
+    PWR_PVDLEVEL_4, PWR_PVDLEVEL_5, PWR_PVDLEVEL_6,
+};
+
+/** @brief Hook given to BSP_PVD_Start(), NULL until started */
+static volatile bsp_pvd_hook_t pvd_hook = NULL;
+
+/*============================================================================*/
+/*                          PTP Time Private Variables                        */
+/*============================================================================*/
+
+/** @brief Nanoseconds added on each accumulator overflow (50 MHz updates) */
+#define PTP_SUBSECOND_INC_NS 20U
+
+/** @brief Accumulator addend of the nominal rate at the current HCLK */
+static uint32_t ptp_addend_nominal;
+
+/** @brief Correction last set by BSP_PTP_AdjustFrequency(), kept over a
+ * clock profile switch */
+static int32_t ptp_adjust_ppb = 0;
+
+/** @brief Set once the MAC system time runs */
+static bool ptp_running = false;
+
+/** @brief Priority of the capture timer compare that ends a timed sleep */
+#define PTP_SLEEP_IRQ_PRIORITY 5U
+
+/** @brief Task in BSP_Time_SleepUntilNs(), NULL if none */
+static TaskHandle_t ptp_sleeper = NULL;
+
+/*============================================================================*/
+/*                          CRC Private Variables                             */
+/*============================================================================*/
+
+/** @brief CRC-16/MODBUS generator polynomial (x^16 + x^15 + x^2 + 1) */
+#define CRC16_MODBUS_POLY 0x8005U
+
+/** @brief CRC-16/MODBUS initial value */
+#define CRC16_MODBUS_INIT 0xFFFFU
+
+/** @brief Set while a caller owns the CRC unit */
+static volatile bool crc_busy = false;
+
+/*============================================================================*/
+/*                          Secure Services Private Variables                 */
+/*============================================================================*/
+
+/** @brief Set while a task is in the secure world */
+static volatile bool secure_busy = false;
+
+/** @brief Runs of each batch size timed by BSP_Secure_Benchmark() */
+#define SECURE_BENCH_RUNS 8U
+
+/*============================================================================*/
+/*                          Flash Private Variables                           */
+/*============================================================================*/
+
+/** @brief Priority of the FLASH interrupt, it only chains the next step */
+#define FLASH_IRQ_PRIORITY 12U
+
+/** @brief Next address to erase or program */
+static uint32_t flash_address;
+
+/** @brief End of the write in flight */
+static uint32_t flash_end;
+
+/** @brief Source of the next quad-word */
+static const uint8_t *flash_source;
+
+/** @brief Address of the sector erased last, 0 before the first */
+static uint32_t flash_erased;
+
+/** @brief The write in flight erases each slot sector as it reaches it */
+static bool flash_erase_ahead;
+
+/** @brief Bank of a configuration or snapshot sector to erase first, 0 if
+ * none; the sector is the one of flash_address */
+static uint32_t flash_erase_bank;
+
+/** @brief Set from the start of a write or erase until it has ended */
+static volatile bool flash_busy = false;
+
+/** @brief Task whose last write failed, NULL if none */
+static TaskHandle_t volatile flash_failed = NULL;
+
+/** @brief Task notified at the end of the write */
+static TaskHandle_t flash_owner = NULL;
+
+/** @brief Quad-word of the last ECC double error in a configuration or
+ * snapshot sector, 0 if none since BSP_Flash_Read() cleared it */
+static volatile uint32_t flash_ecc_address = 0U;
+
+#if BSP_SPINOR_ENABLE
+/*============================================================================*/
+/*                          SPI NOR Private Variables                         */
+/*============================================================================*/
+
+/** @brief SPI clock as the 250 MHz kernel clock / 2^n: 3 is 31.25 MHz */
+#define SPINOR_SCK_DIV_LOG2 3U
+
+/** @brief Priority of the DMA interrupt, it only wakes the task */
+#define SPINOR_DMA_IRQ_PRIORITY 12U
+
+/** @brief Chip select, driven by software */
+#define SPINOR_CS_PORT GPIOA
+#define SPINOR_CS_PIN  GPIO_PIN_15
+
+/** @brief Commands of the 25-series command set */
+#define SPINOR_CMD_WRITE_ENABLE 0x06U
+#define SPINOR_CMD_READ_STATUS  0x05U
+#define SPINOR_CMD_FAST_READ    0x0BU
+#define SPINOR_CMD_PAGE_PROGRAM 0x02U
+#define SPINOR_CMD_BLOCK_ERASE  0xD8U
+#define SPINOR_CMD_SUSPEND      0x75U
+#define SPINOR_CMD_RESUME       0x7AU
+#define SPINOR_CMD_RESET_ENABLE 0x66U
+#define SPINOR_CMD_RESET        0x99U
+#define SPINOR_CMD_READ_ID      0x9FU
+
+/** @brief Write in progress bit of the status register */
+#define SPINOR_STATUS_WIP 0x01U
+
+/** @brief Bytes of one DMA data phase, within the TSIZE field */
+#define SPINOR_MAX_TRANSFER 0x8000U
+
+/** @brief Longest DMA data phase, 32 KB take about 8.4 ms */
+#define SPINOR_DMA_TIMEOUT_MS 50U
+
+/** @brief Longest wait for the last frames after the DMA */
+#define SPINOR_EOT_TIMEOUT_US 20U
+
+/** @brief Longest page program (3 ms for the parts above) */
+#define SPINOR_PROGRAM_TIMEOUT_MS 10U
+
+/** @brief Longest suspend latency (20 to 30 us for the parts above) */
+#define SPINOR_SUSPEND_TIMEOUT_US 100U
+
+/**
+ * @brief Time an erase runs after a resume before it is suspended again,
+ * so that it makes progress under back-to-back commands
+ */
+#define SPINOR_RESUME_HOLD_MS 1U
+
+/** @brief Wait after the software reset (30 us for the parts above) */
+#define SPINOR_RESET_MS 1U
+
+/** @brief Data phase channel, reconfigured for each direction */
+static DMA_HandleTypeDef spinor_dma;
+
+/** @brief Task in the data phase, notified by the DMA interrupt */
+static TaskHandle_t spinor_waiter = NULL;
+
+/** @brief Set by the DMA interrupt on a transfer error */
+static volatile bool spinor_dma_failed = false;
+
+/** @brief Bytes usable, 0 until BSP_SPINOR_Probe() found the flash */
+static uint32_t spinor_size = 0U;
+
+/** @brief Set from the start of an erase until the flash has ended it */
+static bool spinor_erasing = false;
+
+/** @brief Tick of the last erase start or resume */
+static TickType_t spinor_resumed;
+#endif /* BSP_SPINOR_ENABLE */
+
+/*============================================================================*/
+/*                     I2C Digital Output Callbacks                           */
+/*============================================================================*/
+
+/**
+ * @brief Finish the active asynchronous transfer (ISR context)
+ * @param xfer   Transfer being completed
+ * @param status Final transfer status
+ *
+ * Releases the bus and wakes the task that started the transfer.
+ */
+static void i2cdo_complete_from_isr(bsp_i2cdo_xfer_t *xfer, bsp_error_t status)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (status == BSP_OK)
+    {
+        i2cdo_committed = xfer->value;
+        i2cdo_known     = true;
+    }
+
+    i2cdo_active = NULL;
+    xfer->status = status;
+
+    if (xfer->waiter != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR((TaskHandle_t)xfer->waiter,
+                                      BSP_I2CDO_NOTIFY_INDEX, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Start sending the byte of the next expander of a transfer
+ * @param xfer Transfer with at least one expander pending
+ * @return HAL_StatusTypeDef Result of starting the transmission
+ */
+static HAL_StatusTypeDef i2cdo_transmit_next(bsp_i2cdo_xfer_t *xfer)
+{
+    uint8_t n = 0U;
+
+    while ((xfer->pending & (1U << n)) == 0U)
+    {
+        n++;
+    }
+
+    xfer->pending &= (uint8_t)~(1U << n);
+    xfer->stage = n;
+
+    return HAL_I2C_Master_Transmit_IT(&hi2c3, i2cdo_addresses[n],
+                                      &xfer->bytes[n], 1U);
+}
+
+/**
+ * @brief I2C master transmit complete callback (called by HAL from I2C IRQ)
+ * @param hi2c I2C handle
+ *
+ * Chains the byte of the next changed expander directly after the last,
+ * then completes the transfer once all of them have been written.
+ */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    bsp_i2cdo_xfer_t *xfer = i2cdo_active;
+
+    if ((hi2c->Instance == I2C3) && (xfer != NULL))
+    {
+        if (xfer->pending == 0U)
+        {
+            i2cdo_complete_from_isr(xfer, BSP_OK);
+        }
+        else if (i2cdo_transmit_next(xfer) != HAL_OK)
+        {
+            i2cdo_complete_from_isr(xfer, BSP_ERROR);
+        }
+        else
+        {
+            /* Completed by the next callback */
+        }
+    }
+}
+
+/**
+ * @brief I2C error callback (called by HAL on NACK, bus or arbitration error)
+ * @param hi2c I2C handle
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    bsp_i2cdo_xfer_t *xfer = i2cdo_active;
+
+    if ((hi2c->Instance == I2C3) && (xfer != NULL))
+    {
+        i2cdo_complete_from_isr(xfer, BSP_ERROR);
+    }
+}
+
+/*============================================================================*/
+/*                          RS-485 Callbacks                                  */
+/*============================================================================*/
+
+/**
+ * @brief Wake the port owner (ISR context)
+ */
+static void rs485_notify_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (rs485_owner != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(rs485_owner, BSP_RS485_NOTIFY_INDEX,
+                                      &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Wake the task waiting for the console transmission
+ */
+static void console_notify_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (console_tx_waiter != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(console_tx_waiter,
+                                      BSP_CONSOLE_NOTIFY_INDEX, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Queue the bytes received since the last timeout as a frame (ISR)
+ *
+ * The DMA write position is the end of the frame; the frame length is its
+ * distance from the previous end, so the cost does not depend on it.
+ */
+static void rs485_queue_frame_from_isr(void)
+{
+    uint32_t end =
+        BSP_RS485_RX_RING_SIZE - __HAL_DMA_GET_COUNTER(&rs485_dma_rx);
+    uint32_t length;
+
+    end &= (BSP_RS485_RX_RING_SIZE - 1U);
+    length = (end - rs485_rx_start) & (BSP_RS485_RX_RING_SIZE - 1U);
+
+    if (length > 0U)
+    {
+        rs485_stats.frames++;
+        if (rs485_rx_error)
+        {
+            rs485_stats.rx_errors++;
+        }
+
+        if ((rs485_frame_head - rs485_frame_tail) >= RS485_FRAME_QUEUE_SIZE)
+        {
+            rs485_stats.rx_overruns++;
+        }
+        else
+        {
+            rs485_frame_t *frame =
+                &rs485_frames[rs485_frame_head & (RS485_FRAME_QUEUE_SIZE - 1U)];
+
+            frame->start  = (uint16_t)rs485_rx_start;
+            frame->length = (uint16_t)length;
+            frame->error  = rs485_rx_error;
+            rs485_frame_head++;
+            rs485_notify_from_isr();
+        }
+    }
+
+    rs485_rx_start = end;
+    rs485_rx_error = false;
+}
+
+/**
+ * @brief (Re)start circular reception into the receive ring
+ * @return HAL status of the DMA start
+ *
+ * Only the receiver timeout delimits frames, so the DMA half and full
+ * transfer interrupts are switched off again right after the start.
+ */
+static HAL_StatusTypeDef rs485_start_rx(void)
+{
+    HAL_StatusTypeDef status;
+
+    rs485_rx_start = 0U;
+    rs485_rx_error = false;
+
+    status = HAL_UART_Receive_DMA(&rs485_uart, rs485_rx_ring,
+                                  BSP_RS485_RX_RING_SIZE);
+    if (status == HAL_OK)
+    {
+        __HAL_DMA_DISABLE_IT(&rs485_dma_rx, DMA_IT_HT | DMA_IT_TC);
+        __HAL_UART_CLEAR_FLAG(&rs485_uart, UART_CLEAR_RTOF);
+        __HAL_UART_ENABLE_IT(&rs485_uart, UART_IT_RTO);
+    }
+
+    return status;
+}
+
+/**
+ * @brief UART transmit complete callback (called by HAL on the TC event)
+ * @param huart UART handle
+ *
+ * The last stop bit has left the shift register; the USART releases DE
+ * after the deassertion time on its own.
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART2)
+    {
+        rs485_tx_done = true;
+        rs485_notify_from_isr();
+    }
+    else if (huart->Instance == COM1_UART)
+    {
+        console_tx_done = true;
+        console_notify_from_isr();
+    }
+    else
+    {
+        /* Not a BSP port */
+    }
+}
+
+/**
+ * @brief UART error callback (called by HAL on DMA or blocking errors)
+ * @param huart UART handle
+ *
+ * Character errors never get here, BSP_RS485_IRQHandler() takes them
+ * first. A reception stopped by the HAL is restarted from an empty ring.
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART2)
+    {
+        if ((!rs485_tx_done) &&
+            (rs485_dma_tx.ErrorCode != HAL_DMA_ERROR_NONE))
+        {
+            rs485_tx_error = true;
+            rs485_tx_done  = true;
+            rs485_notify_from_isr();
+        }
+
+        if (huart->RxState == HAL_UART_STATE_READY)
+        {
+            rs485_stats.rx_errors++;
+            (void)rs485_start_rx();
+        }
+    }
+    else if (huart->Instance == COM1_UART)
+    {
+        if (!console_tx_done)
+        {
+            console_tx_error = true;
+            console_tx_done  = true;
+            console_notify_from_isr();
+        }
+    }
+    else
+    {
+        /* Not a BSP port */
+    }
+}
+
+/*============================================================================*/
+/*                          ADC1 DMA Callbacks                                */
+/*============================================================================*/
+
+/**
+ * @brief Invalidate the cached copy of one DMA half before reading it
+ * @param half Index of the half (0 or 1)
+ */
+static void adc1_invalidate_half(uint32_t half)
+{
+#if BSP_ADC1_DUAL_MODE
+    BSP_Cache_InvalidateRange(ADC1_FRAME(half, 0U),
+                              adc1_block_samples * sizeof(adc1_dma_buffer[0]));
+#else
+    for (uint32_t plane = 0U; plane < BSP_ADC1_NUM_FAST_CHANNELS; plane++)
+    {
+        BSP_Cache_InvalidateRange(ADC1_PLANE_HALF(plane, half),
+                                  adc1_block_samples * sizeof(uint16_t));
+    }
+#endif
+}
+
+/**
+ * @brief Invalidate the cached copy of one frame of a DMA half
+ * @param half  Index of the half (0 or 1)
+ * @param frame Index of the frame in the half
+ */
+static void adc1_invalidate_frame(uint32_t half, uint32_t frame)
+{
+#if BSP_ADC1_DUAL_MODE
+    BSP_Cache_InvalidateRange(ADC1_FRAME(half, frame),
+                              sizeof(adc1_dma_buffer[0]));
+#else
+    for (uint32_t plane = 0U; plane < BSP_ADC1_NUM_FAST_CHANNELS; plane++)
+    {
+        BSP_Cache_InvalidateRange(&ADC1_PLANE_HALF(plane, half)[frame],
+                                  sizeof(uint16_t));
+    }
+#endif
+}
+
+/**
+ * @brief Extend a capture timer count to the full capture time (ISR)
+ * @param now Capture timer count, read just before
+ * @return Ticks since TIM1 was started
+ *
+ * Counts the wrap-arounds of the timer. Called from the DMA interrupts
+ * that stamp blocks, all at one priority, at least once per wrap.
+ */
+static uint64_t timebase_extend_from_isr(uint32_t now)
+{
+    if (now < g_timebase_last)
+    {
+        g_timebase_wraps++;
+    }
+    g_timebase_last = now;
+
+    return ((uint64_t)g_timebase_wraps * g_timebase_span) + now;
+}
+
+#if BSP_ADC1_SYNC
+/**
+ * @brief Move TIM1 so that its triggers fall on the PTP grid (ISR)
+ * @param trigger_ns PTP time of the most recent trigger
+ *
+ * The counter is moved forward to trigger earlier and back to trigger
+ * later, but never across the compare that fires the trigger, which would
+ * add or drop one, nor past the auto-reload: a correction that does not
+ * fit before the next trigger is cut short and completed on the next
+ * block. The phase of the triggers in capture time is then read back from
+ * both counters at once rather than added up, so a tick that passes
+ * during the move does not stay in the sample times.
+ */
+static void adc1_sync_trigger_from_isr(uint64_t trigger_ns)
+{
+    uint32_t period_ns = g_trigger_period * ADC1_TIMESTAMP_NS;
+    uint32_t compare   = __HAL_TIM_GET_COMPARE(&htim1, TIM_CHANNEL_1);
+    int32_t  error     = (int32_t)(trigger_ns % period_ns);
+    int32_t  ticks;
+    uint32_t primask;
+    uint32_t count;
+    uint32_t room;
+    uint32_t before;
+    uint32_t after;
+
+    if (!g_sync_enabled)
+    {
+        g_sync_aligned = false;
+        return;
+    }
+
+    /* Late (positive) or early (negative) of the nearest grid point */
+    if (error > (int32_t)(period_ns / 2U))
+    {
+        error -= (int32_t)period_ns;
+    }
+    ticks = (error >= 0)
+                ? ((error + (int32_t)(ADC1_TIMESTAMP_NS / 2U)) /
+                   (int32_t)ADC1_TIMESTAMP_NS)
+                : -((-error + (int32_t)(ADC1_TIMESTAMP_NS / 2U)) /
+                    (int32_t)ADC1_TIMESTAMP_NS);
+
+    g_sync_aligned = (ticks <= (int32_t)BSP_ADC1_SYNC_ALIGNED_TICKS) &&
+                     (ticks >= -(int32_t)BSP_ADC1_SYNC_ALIGNED_TICKS);
+    if (ticks == 0)
+    {
+        return;
+    }
+    if (ticks > (int32_t)BSP_ADC1_SYNC_MAX_STEP)
+    {
+        ticks = (int32_t)BSP_ADC1_SYNC_MAX_STEP;
+    }
+    else if (ticks < -(int32_t)BSP_ADC1_SYNC_MAX_STEP)
+    {
+        ticks = -(int32_t)BSP_ADC1_SYNC_MAX_STEP;
+    }
+    else
+    {
+        /* Within one step */
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    count = __HAL_TIM_GET_COUNTER(&htim1);
+    if (ticks > 0)
+    {
+        /* Late: count ahead, short of the compare or the reload */
+        room = (count > compare)   ? (g_trigger_period - 1U - count)
+               : (count < compare) ? (compare - count - 1U)
+                                   : 0U;
+        if ((uint32_t)ticks > room)
+        {
+            ticks = (int32_t)room;
+        }
+        __HAL_TIM_SET_COUNTER(&htim1, count + (uint32_t)ticks);
+    }
+    else
+    {
+        /* Early: count back, short of the compare or zero */
+        room = (count > compare) ? (count - compare - 1U)
+               : (count < compare) ? count
+                                   : 0U;
+        if ((uint32_t)(-ticks) > room)
+        {
+            ticks = -(int32_t)room;
+        }
+        __HAL_TIM_SET_COUNTER(&htim1, count - (uint32_t)(-ticks));
+    }
+
+    /* Both counters run from one clock; retry if the capture timer ticked
+     * between the reads */
+    do
+    {
+        before = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+        count  = __HAL_TIM_GET_COUNTER(&htim1);
+        after  = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+    } while (before != after);
+
+    g_trigger_phase = ((before % g_trigger_period) + g_trigger_period -
+                       count + compare) %
+                      g_trigger_period;
+
+    __set_PRIMASK(primask);
+}
+#endif /* BSP_ADC1_SYNC */
+
+/**
+ * @brief Record the capture time of a completed DMA half (ISR)
+ * @param half Index of the half that has just been filled (0 or 1)
+ *
+ * The capture timer counts in step with TIM1, so the trigger of the last
+ * frame is the latest point of the trigger grid before now; neither the
+ * conversion time nor the interrupt latency enters the timestamp, as long
+ * as the interrupt runs within one trigger period.
+ *
+ * The PTP time is read next to the timer and moved back by the same number
+ * of ticks; over one block the two clocks differ by no more than the
+ * servo's frequency correction. So is the cycle counter, for the latency
+ * of the sample path.
+ */
+static void adc1_stamp_block_from_isr(uint32_t half)
+{
+    uint32_t now    = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+    uint32_t cycles = DWT->CYCCNT;
+    uint64_t now_ns = BSP_Time_NowNs();
+    uint32_t phase  = now % g_trigger_period;
+    uint32_t span   = adc1_block_samples - 1U;
+    uint64_t trigger;
+
+    /* Ticks since the most recent trigger */
+    phase = (phase >= g_trigger_phase)
+                ? (phase - g_trigger_phase)
+                : (phase + g_trigger_period - g_trigger_phase);
+
+    trigger = timebase_extend_from_isr(now) - phase;
+
+    g_block_trigger_cycles[half] =
+        cycles - (phase * (SystemCoreClock / BSP_ADC1_TIMESTAMP_HZ));
+
+    g_block_capture[half] = trigger - ((uint64_t)span * g_trigger_period);
+    g_block_capture_ns[half] =
+        now_ns -
+        ((phase + ((uint64_t)span * g_trigger_period)) * ADC1_TIMESTAMP_NS);
+
+#if BSP_ADC1_SYNC
+    adc1_sync_trigger_from_isr(now_ns - ((uint64_t)phase * ADC1_TIMESTAMP_NS));
+#endif
+}
+
+/**
+ * @brief Hand a completed DMA half over to the block filter task (ISR)
+ * @param half Index of the half that has just been filled (0 or 1)
+ *
+ * Only flags the block and wakes the filter task; no filtering runs in
+ * interrupt context. A block still pending from the previous pass is
+ * counted as an overrun, as the DMA has started overwriting it.
+ */
+static void adc1_block_ready_from_isr(uint32_t half)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t   bit   = (half == 0U) ? ADC1_BLOCK_FIRST_HALF
+                                    : ADC1_BLOCK_SECOND_HALF;
+
+    ADC1_PROBE_HIGH(CALLBACK);
+    g_block_callback_cycles[half] = DWT->CYCCNT;
+    g_block_isr_cycles[half]      = isr_enter_cycles[BSP_ISR_ADC1_DMA];
+
+    adc1_stamp_block_from_isr(half);
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    /* Keep the frame slots on the block grid. At the same priority the DMA
+     * interrupt is served before the ADC one, so the end of sequence of the
+     * half's last frame can still be pending */
+    adc1_frame_slot =
+        ((half * adc1_block_samples) +
+         (__HAL_ADC_GET_FLAG(&hadc1, ADC_FLAG_EOS) ? (adc1_block_samples - 1U)
+                                                   : adc1_block_samples)) %
+        (ADC1_DMA_HALVES * adc1_block_samples);
+#endif
+
+    /* Unpack the last frame for BSP_ADC1_GetResults(); the slow results
+     * come from the ADC2 ISR */
+    adc1_invalidate_frame(half, adc1_block_samples - 1U);
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if (!ADC1_IS_SLOW(ch))
+        {
+            adc1_latest_results[ch] =
+                ADC1_RESULT(half, adc1_block_samples - 1U, ch);
+        }
+    }
+    adc1_latest_frame = adc1_latest_results;
+    adc1_conversion_complete = true;
+
+    if (g_filter_task != NULL)
+    {
+        if ((g_filter_pending & bit) != 0U)
+        {
+            g_filter_block_overruns++;
+        }
+        g_filter_pending  |= bit;
+        g_filter_last_half = half;
+
+        vTaskNotifyGiveFromISR(g_filter_task, &woken);
+    }
+
+    ADC1_PROBE_LOW(CALLBACK);
+    portYIELD_FROM_ISR(woken);
+}
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+/**
+ * @brief Filter the low-latency channels of the frame just converted (ISR)
+ *
+ * Runs at the end of each regular sequence, once the DMA has stored the
+ * frame, and wakes the filter task when the sample hook asks for its
+ * alarm.
+ */
+static void adc1_frame_done_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t   slot  = adc1_frame_slot;
+    uint32_t   half  = slot / adc1_block_samples;
+    uint32_t   frame = slot % adc1_block_samples;
+    uint16_t   raw[BSP_ADC1_NUM_CHANNELS];
+
+    adc1_invalidate_frame(half, frame);
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        raw[ch] = ADC1_IS_LOW_LATENCY(ch)
+                      ? (uint16_t)ADC1_RESULT(half, frame, ch)
+                      : 0U;
+    }
+    adc1_frame_slot = (slot + 1U) % (ADC1_DMA_HALVES * adc1_block_samples);
+
+    if (adc1_pipeline_filter_frame(raw, slot) && (g_filter_task != NULL))
+    {
+        adc1_sample_alarm = true;
+        vTaskNotifyGiveFromISR(g_filter_task, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
+/**
+ * @brief ADC DMA half-transfer callback (called by HAL from DMA IRQ)
+ * @param hadc ADC handle
+ *
+ * The first half of the circular buffer holds a full block of frames.
+ */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        adc1_block_ready_from_isr(0U);
+    }
+}
+
+/**
+ * @brief ADC DMA transfer complete callback (called by HAL from DMA IRQ)
+ * @param hadc ADC handle
+ *
+ * The second half of the circular buffer holds a full block of frames.
+ */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        adc1_block_ready_from_isr(1U);
+    }
+}
+
+/**
+ * @brief ADC error callback (called by HAL when ADC error occurs)
+ * @param hadc ADC handle
+ *
+ * This callback is invoked when an ADC error occurs (overrun, DMA error, etc.)
+ * It flags the error and wakes the block filter task, which resumes the
+ * acquisition once it has filtered the blocks already completed.
+ */
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (hadc->Instance == ADC1)
+    {
+        adc1_error_occurred = true;
+        adc1_last_error     = hadc->ErrorCode;
+        adc1_running        = false;
+
+        if (g_filter_task != NULL)
+        {
+            vTaskNotifyGiveFromISR(g_filter_task, &woken);
+        }
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/*============================================================================*/
+/*                          ADC1 Oversampling                                 */
+/*============================================================================*/
+
+/**
+ * @brief Apply the regular group oversampling settings to ADC1
+ *
+ * MX_ADC1_Init() configures plain 12-bit conversions; this re-runs
+ * HAL_ADC_Init() with BSP_ADC1_OVERSAMPLING_LOG2 and
+ * BSP_ADC1_OVERSAMPLING_SHIFT before the ADC is first enabled. Channel
+ * configuration is kept. All 2^n conversions of a channel run on one
+ * trigger, so the sample rate and DMA layout do not change.
+ */
+static void adc1_config_oversampling(void)
+{
+#if (BSP_ADC1_OVERSAMPLING_LOG2 > 0U)
+    hadc1.Init.OversamplingMode = ENABLE;
+    hadc1.Init.Oversampling.Ratio =
+        (BSP_ADC1_OVERSAMPLING_LOG2 - 1U) << ADC_CFGR2_OVSR_Pos;
+    hadc1.Init.Oversampling.RightBitShift = BSP_ADC1_OVERSAMPLING_SHIFT
+                                            << ADC_CFGR2_OVSS_Pos;
+    hadc1.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+    hadc1.Init.Oversampling.OversamplingStopReset =
+        ADC_REGOVERSAMPLING_CONTINUED_MODE;
+
+    if (HAL_ADC_Init(&hadc1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+#endif
+}
+
+/*============================================================================*/
+/*                          ADC1/ADC2 Dual Mode                               */
+/*============================================================================*/
+
+#if BSP_ADC1_DUAL_MODE
+/**
+ * @brief Split the channels over ADC1 and ADC2 in regular simultaneous mode
+ *
+ * MX_ADC1_Init() puts all channels in the ADC1 sequence. ADC1 keeps the
+ * first ADC1_FRAME_WORDS ranks and ADC2 converts the rest, rank for rank
+ * on the same TIM1 trigger, so the sequence takes half as long and each
+ * pair is sampled at the same instant. The common data register holds both
+ * results of a pair, and one GPDMA channel moves it (MDMA 12/10-bit mode:
+ * ADC1 in bits 15:0, ADC2 in bits 31:16). Runs after
+ * adc1_config_oversampling(), whose settings ADC2 copies.
+ */
+static void adc1_config_dual_mode(void)
+{
+    static const uint32_t slave_channels[ADC1_FRAME_WORDS] = {
+        ADC_CHANNEL_10, ADC_CHANNEL_12, ADC_CHANNEL_13};
+    static const uint32_t ranks[ADC1_FRAME_WORDS] = {
+        ADC_REGULAR_RANK_1, ADC_REGULAR_RANK_2, ADC_REGULAR_RANK_3};
+    ADC_ChannelConfTypeDef channel = {0};
+    ADC_MultiModeTypeDef   multi   = {0};
+
+    hadc1.Init.NbrOfConversion = ADC1_FRAME_WORDS;
+    if (HAL_ADC_Init(&hadc1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    /* Same conversion settings; the slave follows the master's trigger */
+    hadc2.Instance                   = ADC2;
+    hadc2.Init                       = hadc1.Init;
+    hadc2.Init.ExternalTrigConv      = ADC_SOFTWARE_START;
+    hadc2.Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_NONE;
+    hadc2.Init.DMAContinuousRequests = DISABLE;
+    if (HAL_ADC_Init(&hadc2) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    channel.SamplingTime = ADC_SAMPLETIME_24CYCLES_5;
+    channel.SingleDiff   = ADC_SINGLE_ENDED;
+    channel.OffsetNumber = ADC_OFFSET_NONE;
+    channel.Offset       = 0;
+    for (uint32_t rank = 0U; rank < ADC1_FRAME_WORDS; rank++)
+    {
+        channel.Channel = slave_channels[rank];
+        channel.Rank    = ranks[rank];
+        if (HAL_ADC_ConfigChannel(&hadc2, &channel) != HAL_OK)
+        {
+            Error_Handler();
+        }
+    }
+
+    multi.Mode             = ADC_DUALMODE_REGSIMULT;
+    multi.DMAAccessMode    = ADC_DMAACCESSMODE_12_10_BITS;
+    multi.TwoSamplingDelay = ADC_TWOSAMPLINGDELAY_1CYCLE;
+    if (HAL_ADCEx_MultiModeConfigChannel(&hadc1, &multi) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+#endif
+
+/*============================================================================*/
+/*                          ADC1 Slow Channels                                */
+/*============================================================================*/
+
+#if BSP_ADC1_SLOW_CHANNELS
+/**
+ * @brief Move the slow channels from the ADC1 sequence to ADC2
+ *
+ * MX_ADC1_Init() puts all channels in the ADC1 sequence. ADC1 keeps the
+ * fast channels, in channel order, so plane n of the DMA buffer holds the
+ * nth fast channel (ADC1_PLANE()). ADC2 converts the slow channels in its
+ * injected ranks on TIM1 TRGO2, the update that the repetition counter
+ * lets through once per slow sample period (adc1_set_slow_triggers()),
+ * and its JEOS interrupt, enabled by adc1_config_watchdogs(), queues each
+ * set of results for the filter task.
+ * The injected group has the regular group's oversampling, so the results
+ * have the same format; the regular group of ADC2 stays unused. Runs
+ * after adc1_config_oversampling(), before the ADCs are first enabled.
+ */
+static void adc1_config_slow_channels(void)
+{
+    static const uint32_t regular_ranks[BSP_ADC1_NUM_CHANNELS] = {
+        ADC_REGULAR_RANK_1, ADC_REGULAR_RANK_2, ADC_REGULAR_RANK_3,
+        ADC_REGULAR_RANK_4, ADC_REGULAR_RANK_5, ADC_REGULAR_RANK_6};
+    ADC_ChannelConfTypeDef   channel  = {0};
+    ADC_InjectionConfTypeDef injected = {0};
+    uint32_t                 fast     = 0U;
+    uint32_t                 slow     = 0U;
+
+    hadc1.Init.NbrOfConversion = BSP_ADC1_NUM_FAST_CHANNELS;
+    if (HAL_ADC_Init(&hadc1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    hadc2.Instance                   = ADC2;
+    hadc2.Init                       = hadc1.Init;
+    hadc2.Init.NbrOfConversion       = 1U;
+    hadc2.Init.ExternalTrigConv      = ADC_SOFTWARE_START;
+    hadc2.Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_NONE;
+    hadc2.Init.DMAContinuousRequests = DISABLE;
+    if (HAL_ADC_Init(&hadc2) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    channel.SamplingTime = ADC_SAMPLETIME_24CYCLES_5;
+    channel.SingleDiff   = ADC_SINGLE_ENDED;
+    channel.OffsetNumber = ADC_OFFSET_NONE;
+    channel.Offset       = 0;
+
+    injected.InjectedSamplingTime          = ADC_SAMPLETIME_24CYCLES_5;
+    injected.InjectedSingleDiff            = ADC_SINGLE_ENDED;
+    injected.InjectedOffsetNumber          = ADC_OFFSET_NONE;
+    injected.InjectedOffset                = 0;
+    injected.InjectedNbrOfConversion       = BSP_ADC1_NUM_SLOW_CHANNELS;
+    injected.InjectedDiscontinuousConvMode = DISABLE;
+    injected.AutoInjectedConv              = DISABLE;
+    injected.QueueInjectedContext          = DISABLE;
+    injected.ExternalTrigInjecConv         = ADC_EXTERNALTRIGINJEC_T1_TRGO2;
+
+    injected.ExternalTrigInjecConvEdge = ADC_EXTERNALTRIGINJECCONV_EDGE_RISING;
+    injected.InjecOversamplingMode     = hadc1.Init.OversamplingMode;
+    injected.InjecOversampling.Ratio   = hadc1.Init.Oversampling.Ratio;
+    injected.InjecOversampling.RightBitShift =
+        hadc1.Init.Oversampling.RightBitShift;
+
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if (ADC1_IS_SLOW(ch))
+        {
+            injected.InjectedChannel = adc1_channels[ch];
+            injected.InjectedRank    = adc1_slow_ranks[slow];
+            if (HAL_ADCEx_InjectedConfigChannel(&hadc2, &injected) != HAL_OK)
+            {
+                Error_Handler();
+            }
+            adc1_slow_channels[slow] = ch;
+            slow++;
+        }
+        else
+        {
+            channel.Channel = adc1_channels[ch];
+            channel.Rank    = regular_ranks[fast];
+            if (HAL_ADC_ConfigChannel(&hadc1, &channel) != HAL_OK)
+            {
+                Error_Handler();
+            }
+            fast++;
+        }
+    }
+
+    /* Without the queue JSQR stays set from one trigger to the next */
+    if (HAL_ADCEx_DisableInjectedQueue(&hadc2) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+
+/**
+ * @brief Let one TIM1 update through every slow sample period
+ * @param hz Sample rate in force
+ *
+ * The repetition counter holds back the updates, and with them TRGO2, for
+ * ADC1_SLOW_TRIGGERS() trigger periods. The update generated here loads
+ * the count at once and clears the counter, so it runs before TIM1 starts
+ * or with the counter just cleared and ADC2 stopped.
+ */
+static void adc1_set_slow_triggers(uint32_t hz)
+{
+    htim1.Instance->RCR = ADC1_SLOW_TRIGGERS(hz) - 1U;
+    htim1.Instance->EGR = TIM_EGR_UG;
+}
+
+/**
+ * @brief Queue the results of a slow conversion for the filter task (ADC2
+ * ISR)
+ *
+ * The results also stand in the latest frame of BSP_ADC1_GetResults().
+ * With the queue full, which takes the filter task ADC1_SLOW_RING_SIZE
+ * slow periods behind, the conversion is counted and dropped.
+ */
+static void adc1_slow_done_from_isr(void)
+{
+    uint32_t  head  = adc1_slow_head;
+    uint16_t *slot  = adc1_slow_ring[head & ADC1_SLOW_RING_MASK];
+    bool      space = (head - adc1_slow_tail) < ADC1_SLOW_RING_SIZE;
+
+    for (uint32_t rank = 0U; rank < BSP_ADC1_NUM_SLOW_CHANNELS; rank++)
+    {
+        uint16_t value = (uint16_t)HAL_ADCEx_InjectedGetValue(
+            &hadc2, adc1_slow_ranks[rank]);
+
+        adc1_latest_results[adc1_slow_channels[rank]] = value;
+        if (space)
+        {
+            slot[rank] = value;
+        }
+    }
+
+    if (space)
+    {
+        adc1_slow_head = head + 1U;
+    }
+    else
+    {
+        adc1_slow_overruns++;
+    }
+}
+#endif
+
+/*============================================================================*/
+/*                          ADC1 Injected Group                               */
+/*============================================================================*/
+
+/**
+ * @brief Set up the injected group of ADC1 for BSP_ADC1_SampleNow()
+ *
+ * One rank, started by software, with the regular group's oversampling so
+ * its results have the same format; BSP_ADC1_SampleNow() sets the channel
+ * of the rank for each conversion. The sampling times are those set for
+ * the regular sequence, for all six inputs. Runs before the ADC is first
+ * enabled, after adc1_config_oversampling().
+ */
+static void adc1_config_injected(void)
+{
+    ADC_InjectionConfTypeDef injected = {0};
+
+    injected.InjectedChannel               = adc1_channels[0];
+    injected.InjectedRank                  = ADC_INJECTED_RANK_1;
+    injected.InjectedSamplingTime          = ADC_SAMPLETIME_24CYCLES_5;
+    injected.InjectedSingleDiff            = ADC_SINGLE_ENDED;
+    injected.InjectedOffsetNumber          = ADC_OFFSET_NONE;
+    injected.InjectedOffset                = 0;
+    injected.InjectedNbrOfConversion       = 1U;
+    injected.InjectedDiscontinuousConvMode = DISABLE;
+    injected.AutoInjectedConv              = DISABLE;
+    injected.QueueInjectedContext          = DISABLE;
+    injected.ExternalTrigInjecConv         = ADC_INJECTED_SOFTWARE_START;
+
+    injected.ExternalTrigInjecConvEdge = ADC_EXTERNALTRIGINJECCONV_EDGE_NONE;
+    injected.InjecOversamplingMode     = hadc1.Init.OversamplingMode;
+    injected.InjecOversampling.Ratio   = hadc1.Init.Oversampling.Ratio;
+    injected.InjecOversampling.RightBitShift =
+        hadc1.Init.Oversampling.RightBitShift;
+
+    /* Without the queue the software start is seen and JSQR stays set */
+    if ((HAL_ADCEx_InjectedConfigChannel(&hadc1, &injected) != HAL_OK) ||
+        (HAL_ADCEx_DisableInjectedQueue(&hadc1) != HAL_OK))
+    {
+        Error_Handler();
+    }
+
+    HAL_NVIC_SetPriority(ADC1_IRQn, ADC1_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(ADC1_IRQn);
+}
+
+/**
+ * @brief ADC injected conversion complete callback (called by HAL from the
+ * ADC IRQ)
+ * @param hadc ADC handle
+ */
+void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (hadc->Instance == ADC1)
+    {
+        adc1_sample_value =
+            (uint16_t)HAL_ADCEx_InjectedGetValue(hadc, ADC_INJECTED_RANK_1);
+        if (adc1_sampler != NULL)
+        {
+            vTaskNotifyGiveIndexedFromISR(adc1_sampler, BSP_ADC1_NOTIFY_INDEX,
+                                          &woken);
+        }
+    }
+#if BSP_ADC1_SLOW_CHANNELS
+    else if (hadc->Instance == ADC2)
+    {
+        adc1_slow_done_from_isr();
+    }
+#endif
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Calibrate the ADC(s) of the acquisition
+ */
+static HAL_StatusTypeDef adc1_calibrate(void)
+{
+    HAL_StatusTypeDef status =
+        HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED);
+
+#if ADC1_USES_ADC2
+    if (status == HAL_OK)
+    {
+        status = HAL_ADCEx_Calibration_Start(&hadc2, ADC_SINGLE_ENDED);
+    }
+#endif
+
+    return status;
+}
+
+#if !BSP_ADC1_DUAL_MODE
+/**
+ * @brief Planar DMA half-transfer callback: the first half is complete
+ */
+static void adc1_dma_half_cplt(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    adc1_block_ready_from_isr(0U);
+}
+
+/**
+ * @brief Planar DMA transfer-complete callback: the second half is complete
+ */
+static void adc1_dma_cplt(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    adc1_block_ready_from_isr(1U);
+}
+
+/**
+ * @brief Planar DMA error callback, reported as an ADC1 DMA error
+ */
+static void adc1_dma_error(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    hadc1.ErrorCode |= HAL_ADC_ERROR_DMA;
+    HAL_ADC_ErrorCallback(&hadc1);
+}
+#endif
+
+/**
+ * @brief Start the conversions and the DMA on the linked queue
+ *
+ * HAL_ADC_Start_DMA() would rewrite the node's CBR1 with a plain length
+ * and drop the repeat count of the planar node, so with a single ADC the
+ * ADC, the DMA channel and the conversions are started here, with the DMA
+ * callbacks of this file instead of the HAL ADC ones.
+ */
+static HAL_StatusTypeDef adc1_start_dma(void)
+{
+    HAL_StatusTypeDef status;
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    adc1_frame_slot = 0U;
+#endif
+
+#if BSP_ADC1_DUAL_MODE
+    status = HAL_ADCEx_MultiModeStart_DMA(&hadc1, &adc1_dma_buffer[0][0],
+                                          ADC1_DMA_LENGTH);
+#else
+    status = ADC_Enable(&hadc1);
+
+    if (status == HAL_OK)
+    {
+        ADC_STATE_CLR_SET(hadc1.State,
+                          HAL_ADC_STATE_READY | HAL_ADC_STATE_REG_EOC |
+                              HAL_ADC_STATE_REG_OVR | HAL_ADC_STATE_REG_EOSMP,
+                          HAL_ADC_STATE_REG_BUSY);
+        hadc1.ErrorCode = HAL_ADC_ERROR_NONE;
+
+        adc1_dma.XferHalfCpltCallback = adc1_dma_half_cplt;
+        adc1_dma.XferCpltCallback     = adc1_dma_cplt;
+        adc1_dma.XferErrorCallback    = adc1_dma_error;
+
+        __HAL_ADC_CLEAR_FLAG(&hadc1,
+                             ADC_FLAG_EOC | ADC_FLAG_EOS | ADC_FLAG_OVR);
+        __HAL_ADC_ENABLE_IT(&hadc1, ADC_IT_OVR);
+        status = HAL_DMAEx_List_Start_IT(&adc1_dma);
+    }
+
+    if (status == HAL_OK)
+    {
+        LL_ADC_REG_StartConversion(hadc1.Instance);
+    }
+#if BSP_ADC1_SLOW_CHANNELS
+    if (status == HAL_OK)
+    {
+        status = HAL_ADCEx_InjectedStart_IT(&hadc2);
+    }
+#endif
+#endif
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+    /* Frame by frame filter; an end of sequence already flagged interrupts
+     * at once */
+    if (status == HAL_OK)
+    {
+        __HAL_ADC_ENABLE_IT(&hadc1, ADC_IT_EOS);
+    }
+#endif
+
+    return status;
+}
+
+/**
+ * @brief Stop the conversions and the DMA; the queue stays linked
+ */
+static HAL_StatusTypeDef adc1_stop_dma(void)
+{
+#if BSP_ADC1_DUAL_MODE
+    return HAL_ADCEx_MultiModeStop_DMA(&hadc1);
+#else
+    HAL_StatusTypeDef status = HAL_ADC_Stop_DMA(&hadc1);
+
+#if BSP_ADC1_SLOW_CHANNELS
+    if (HAL_ADCEx_InjectedStop_IT(&hadc2) != HAL_OK)
+    {
+        status = HAL_ERROR;
+    }
+#endif
+
+    return status;
+#endif
+}
+
+/*============================================================================*/
+/*                          ADC1 Analog Watchdogs                             */
+/*============================================================================*/
+
+/** @brief Number, interrupt source and flag of each watchdog */
+static const uint32_t adc1_awd_numbers[BSP_ADC1_AWD_COUNT] = {
+    ADC_ANALOGWATCHDOG_1, ADC_ANALOGWATCHDOG_2, ADC_ANALOGWATCHDOG_3};
+static const uint32_t adc1_awd_its[BSP_ADC1_AWD_COUNT] = {
+    ADC_IT_AWD1, ADC_IT_AWD2, ADC_IT_AWD3};
+static const uint32_t adc1_awd_flags[BSP_ADC1_AWD_COUNT] = {
+    ADC_FLAG_AWD1, ADC_FLAG_AWD2, ADC_FLAG_AWD3};
+
+/**
+ * @brief ADC converting a channel of the acquisition
+ */
+static ADC_HandleTypeDef *adc1_awd_adc(uint8_t channel)
+{
+#if BSP_ADC1_DUAL_MODE
+    return (channel < ADC1_FRAME_WORDS) ? &hadc1 : &hadc2;
+#elif BSP_ADC1_SLOW_CHANNELS
+    return ADC1_IS_SLOW(channel) ? &hadc2 : &hadc1;
+#else
+    (void)channel;
+    return &hadc1;
+#endif
+}
+
+/**
+ * @brief Write the window of a watchdog in the bits it compares
+ *
+ * The thresholds may change while the ADC converts. Written straight,
+ * without the resolution shift of HAL_ADC_AnalogWDGConfig(), as the
+ * results are oversampled.
+ */
+static void adc1_awd_write_window(uint8_t awd)
+{
+    uint32_t shift = (awd == 0U) ? ADC1_AWD1_SHIFT : ADC1_AWD23_SHIFT;
+    uint32_t max   = (awd == 0U) ? ADC1_AWD1_MAX : ADC1_AWD23_MAX;
+    uint32_t low   = (uint32_t)adc1_awd_config[awd].low >> shift;
+    uint32_t high  = (uint32_t)adc1_awd_config[awd].high >> shift;
+
+    LL_ADC_ConfigAnalogWDThresholds(
+        adc1_awd_adc(adc1_awd_channels[awd])->Instance, adc1_awd_numbers[awd],
+        (high < max) ? high : max, (low < max) ? low : max);
+}
+
+/**
+ * @brief Point a watchdog at its channel and arm its interrupt
+ *
+ * The channel of a watchdog can only be written with no conversion under
+ * way. When ADC2 converts channels too the watchdog of the other ADC is
+ * turned off; ADC2 watches a slow channel in its injected group.
+ */
+static void adc1_awd_watch(uint8_t awd)
+{
+    uint8_t            channel = adc1_awd_channels[awd];
+    ADC_HandleTypeDef *adc     = adc1_awd_adc(channel);
+    uint32_t           group   = ADC1_IS_SLOW(channel) ? LL_ADC_GROUP_INJECTED
+                                                       : LL_ADC_GROUP_REGULAR;
+
+#if ADC1_USES_ADC2
+    ADC_HandleTypeDef *other = (adc == &hadc1) ? &hadc2 : &hadc1;
+
+    __HAL_ADC_DISABLE_IT(other, adc1_awd_its[awd]);
+    LL_ADC_SetAnalogWDMonitChannels(other->Instance, adc1_awd_numbers[awd],
+                                    LL_ADC_AWD_DISABLE);
+#endif
+
+    LL_ADC_SetAnalogWDMonitChannels(
+        adc->Instance, adc1_awd_numbers[awd],
+        __LL_ADC_ANALOGWD_CHANNEL_GROUP(adc1_channels[channel], group));
+    __HAL_ADC_CLEAR_FLAG(adc, adc1_awd_flags[awd]);
+    __HAL_ADC_ENABLE_IT(adc, adc1_awd_its[awd]);
+}
+
+/**
+ * @brief Set up the watchdogs with their default windows
+ *
+ * Runs before the ADC is first enabled, after adc1_config_injected(),
+ * which enables the ADC1 interrupt.
+ */
+static void adc1_config_watchdogs(void)
+{
+    for (uint8_t awd = 0U; awd < BSP_ADC1_AWD_COUNT; awd++)
+    {
+        adc1_awd_watch(awd);
+        adc1_awd_write_window(awd);
+    }
+
+#if ADC1_USES_ADC2
+    HAL_NVIC_SetPriority(ADC2_IRQn, ADC2_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(ADC2_IRQn);
+#endif
+}
+
+/**
+ * @brief Raise the alarm of a watchdog from its interrupt
+ *
+ * The interrupt stays off until the filter task arms it again at the end
+ * of the block, so a channel out of its window costs one interrupt a
+ * block, not one a conversion.
+ */
+static void adc1_awd_fired_from_isr(ADC_HandleTypeDef *hadc, uint8_t awd)
+{
+    BaseType_t woken = pdFALSE;
+
+    __HAL_ADC_DISABLE_IT(hadc, adc1_awd_its[awd]);
+    adc1_awd_fired |= 1UL << awd;
+    if (g_filter_task != NULL)
+    {
+        vTaskNotifyGiveFromISR(g_filter_task, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief ADC analog watchdog 1 callback (called by HAL from the ADC IRQ)
+ * @param hadc ADC handle
+ */
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc)
+{
+    adc1_awd_fired_from_isr(hadc, 0U);
+}
+
+/**
+ * @brief ADC analog watchdog 2 callback (called by HAL from the ADC IRQ)
+ * @param hadc ADC handle
+ */
+void HAL_ADCEx_LevelOutOfWindow2Callback(ADC_HandleTypeDef *hadc)
+{
+    adc1_awd_fired_from_isr(hadc, 1U);
+}
+
+/**
+ * @brief ADC analog watchdog 3 callback (called by HAL from the ADC IRQ)
+ * @param hadc ADC handle
+ */
+void HAL_ADCEx_LevelOutOfWindow3Callback(ADC_HandleTypeDef *hadc)
+{
+    adc1_awd_fired_from_isr(hadc, 2U);
+}
+
+/*============================================================================*/
+/*                          ADC1 Timebase                                     */
+/*============================================================================*/
+
+/**
+ * @brief Start the sample capture timer together with TIM1
+ *
+ * TIM2 (32-bit, ITR0 = TIM1 TRGO) runs from the same timer clock and
+ * prescaler as TIM1 and is started by TIM1's counter enable, so its count
+ * is TIM1's elapsed ticks and every ADC trigger lands on a known grid.
+ * The auto-reload is a whole number of seconds, so of the trigger periods
+ * of all sample rates, and the grid survives a wrap-around at any rate.
+ */
+static void adc1_timebase_init(void)
+{
+    TIM_MasterConfigTypeDef master = {0};
+    TIM_SlaveConfigTypeDef  slave  = {0};
+
+    g_trigger_period = htim1.Init.Period + 1U;
+    g_trigger_phase  = __HAL_TIM_GET_COMPARE(&htim1, TIM_CHANNEL_1);
+    g_timebase_span  = (UINT32_MAX / BSP_ADC1_TIMESTAMP_HZ) *
+                       BSP_ADC1_TIMESTAMP_HZ;
+
+    __HAL_RCC_TIM2_CLK_ENABLE();
+
+    g_timebase_tim.Instance               = TIM2;
+    g_timebase_tim.Init.Prescaler         = htim1.Init.Prescaler;
+    g_timebase_tim.Init.CounterMode       = TIM_COUNTERMODE_UP;
+    g_timebase_tim.Init.Period            = g_timebase_span - 1U;
+    g_timebase_tim.Init.ClockDivision     = TIM_CLOCKDIVISION_DIV1;
+    g_timebase_tim.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    if (HAL_TIM_Base_Init(&g_timebase_tim) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    slave.SlaveMode    = TIM_SLAVEMODE_TRIGGER;
+    slave.InputTrigger = TIM_TS_ITR0;
+    if (HAL_TIM_SlaveConfigSynchro(&g_timebase_tim, &slave) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    master.MasterOutputTrigger = TIM_TRGO_ENABLE;
+#if BSP_ADC1_SLOW_CHANNELS
+    /* TRGO2 starts the slow conversions of ADC2 */
+    master.MasterOutputTrigger2 = TIM_TRGO2_UPDATE;
+#else
+    master.MasterOutputTrigger2 = TIM_TRGO2_RESET;
+#endif
+    master.MasterSlaveMode = TIM_MASTERSLAVEMODE_ENABLE;
+    if (HAL_TIMEx_MasterConfigSynchronization(&htim1, &master) != HAL_OK)
+    {
+        Error_Handler();
+    }
+#if BSP_ADC1_SLOW_CHANNELS
+    adc1_set_slow_triggers(adc1_sample_rate);
+#endif
+}
+
+/*============================================================================*/
+/*                          MPU Configuration                                 */
+/*============================================================================*/
+
+static void MPU_Config(void)
+{
+    MPU_Region_InitTypeDef     MPU_InitStruct     = {0};
+    MPU_Attributes_InitTypeDef MPU_AttributesInit = {0};
+
+    /* Disables the MPU */
+    HAL_MPU_Disable();
+
+    /* Configure the MPU attributes for Ethernet Buffers */
+    /* Attribute 0: Normal, Non-Cacheable */
+    MPU_AttributesInit.Number     = MPU_ATTRIBUTES_NUMBER0;
+    MPU_AttributesInit.Attributes = MPU_NOT_CACHEABLE;
+    HAL_MPU_ConfigMemoryAttributes(&MPU_AttributesInit);
+
+    /* Configure the MPU region */
+    MPU_InitStruct.Enable      = MPU_REGION_ENABLE;
+    MPU_InitStruct.Number      = MPU_REGION_NUMBER0;
+    MPU_InitStruct.BaseAddress = (uint32_t)&__eth_dma_start;
+    MPU_InitStruct.LimitAddress =
+        (uint32_t)&__eth_dma_start + 32 * 1024 - 1; /* 32KB region */
+    MPU_InitStruct.AttributesIndex  = MPU_ATTRIBUTES_NUMBER0;
+    MPU_InitStruct.AccessPermission = MPU_REGION_ALL_RW;
+    MPU_InitStruct.DisableExec      = MPU_INSTRUCTION_ACCESS_ENABLE;
+    MPU_InitStruct.IsShareable      = MPU_ACCESS_OUTER_SHAREABLE;
+
+    HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+    /* The other DMA buffers (BSP_SECTION_DMA), cache line aligned by the
+     * linker script, with the same attributes */
+    if (&__dma_buffer_end != &__dma_buffer_start)
+    {
+        MPU_InitStruct.Number       = MPU_REGION_NUMBER1;
+        MPU_InitStruct.BaseAddress  = (uint32_t)&__dma_buffer_start;
+        MPU_InitStruct.LimitAddress = (uint32_t)&__dma_buffer_end - 1U;
+        MPU_InitStruct.DisableExec  = MPU_INSTRUCTION_ACCESS_DISABLE;
+        HAL_MPU_ConfigRegion(&MPU_InitStruct);
+    }
+
+    /* Enables the MPU */
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+}
+
+/*============================================================================*/
+/*                          Console Initialization                            */
+/*============================================================================*/
+
+/**
+ * @brief Clock the console USART from HSI, ahead of BSP_COM_Init()
+ * @return BSP_OK, or BSP_ERROR if the kernel clock cannot be selected
+ *
+ * The baud rate then stays put over clock profile switches.
+ */
+static bsp_error_t console_clock_init(void)
+{
+    RCC_PeriphCLKInitTypeDef clk = {0};
+
+    clk.PeriphClockSelection = RCC_PERIPHCLK_USART3;
+    clk.Usart3ClockSelection = RCC_USART3CLKSOURCE_HSI;
+
+    return (HAL_RCCEx_PeriphCLKConfig(&clk) == HAL_OK) ? BSP_OK : BSP_ERROR;
+}
+
+/**
+ * @brief Clock LPUART1 from HSI, after MX_LPUART1_UART_Init()
+ * @return BSP_OK, or BSP_ERROR if the kernel clock cannot be selected
+ *
+ * The generated MSP code selects PCLK3, which the idle clock profile
+ * divides; the port is set up again for the baud rate from HSI.
+ */
+static bsp_error_t lpuart1_clock_init(void)
+{
+    RCC_PeriphCLKInitTypeDef clk = {0};
+
+    clk.PeriphClockSelection  = RCC_PERIPHCLK_LPUART1;
+    clk.Lpuart1ClockSelection = RCC_LPUART1CLKSOURCE_HSI;
+
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    return (HAL_UART_Init(&hlpuart1) == HAL_OK) ? BSP_OK : BSP_ERROR;
+}
+
+/**
+ * @brief Set up the transmit DMA channel of the console USART
+ * @return BSP_OK, or BSP_ERROR if a DMA call fails
+ *
+ * Called once BSP_COM_Init() has configured the USART.
+ */
+static bsp_error_t console_dma_init(void)
+{
+    console_dma_tx.Instance                   = GPDMA1_Channel3;
+    console_dma_tx.Init.Request               = GPDMA1_REQUEST_USART3_TX;
+    console_dma_tx.Init.BlkHWRequest          = DMA_BREQ_SINGLE_BURST;
+    console_dma_tx.Init.Direction             = DMA_MEMORY_TO_PERIPH;
+    console_dma_tx.Init.SrcInc                = DMA_SINC_INCREMENTED;
+    console_dma_tx.Init.DestInc               = DMA_DINC_FIXED;
+    console_dma_tx.Init.SrcDataWidth          = DMA_SRC_DATAWIDTH_BYTE;
+    console_dma_tx.Init.DestDataWidth         = DMA_DEST_DATAWIDTH_BYTE;
+    console_dma_tx.Init.Priority              = DMA_LOW_PRIORITY_LOW_WEIGHT;
+    console_dma_tx.Init.SrcBurstLength        = 1;
+    console_dma_tx.Init.DestBurstLength       = 1;
+    console_dma_tx.Init.TransferAllocatedPort =
+        DMA_SRC_ALLOCATED_PORT1 | DMA_DEST_ALLOCATED_PORT0;
+    console_dma_tx.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+    console_dma_tx.Init.Mode              = DMA_NORMAL;
+
+    if ((HAL_DMA_Init(&console_dma_tx) != HAL_OK) ||
+        (HAL_DMA_ConfigChannelAttributes(&console_dma_tx, DMA_CHANNEL_PRIV) !=
+         HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+    __HAL_LINKDMA(&hcom_uart[COM1], hdmatx, console_dma_tx);
+
+    HAL_NVIC_SetPriority(USART3_IRQn, CONSOLE_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(USART3_IRQn);
+    HAL_NVIC_SetPriority(GPDMA1_Channel3_IRQn, CONSOLE_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel3_IRQn);
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          Low Power Initialization                          */
+/*============================================================================*/
+
+/**
+ * @brief Start the LSI and clock LPTIM1 from it
+ * @return BSP_OK, or BSP_ERROR if the oscillator or clock setup fails
+ */
+static bsp_error_t lowpower_timer_init(void)
+{
+    RCC_OscInitTypeDef       osc    = {0};
+    RCC_PeriphCLKInitTypeDef periph = {0};
+
+    osc.OscillatorType = RCC_OSCILLATORTYPE_LSI;
+    osc.LSIState       = RCC_LSI_ON;
+    osc.PLL.PLLState   = RCC_PLL_NONE;
+    if (HAL_RCC_OscConfig(&osc) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    periph.PeriphClockSelection = RCC_PERIPHCLK_LPTIM1;
+    periph.Lptim1ClockSelection = RCC_LPTIM1CLKSOURCE_LSI;
+    if (HAL_RCCEx_PeriphCLKConfig(&periph) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    __HAL_RCC_LPTIM1_CLK_ENABLE();
+
+    /* Counter clocked by the kernel clock, prescaler 1 */
+    LPTIM1->CR   = 0U;
+    LPTIM1->CFGR = 0U;
+
+    EXTI->IMR2 |= LOWPOWER_LPTIM1_EXTI_LINE;
+    HAL_NVIC_SetPriority(LPTIM1_IRQn, LOWPOWER_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          PWM Initialization                                */
+/*============================================================================*/
+
+/**
+ * @brief Set up the PWM timers with their outputs driven low
+ *
+ * Channel 1 of each timer runs in PWM mode 1 with the auto-reload and
+ * compare registers preloaded; the output is enabled but forced inactive
+ * until BSP_PWM_Start().
+ *
+ * @return BSP_OK, or BSP_ERROR if a timer cannot be initialized
+ */
+static bsp_error_t pwm_init(void)
+{
+    TIM_OC_InitTypeDef oc   = {0};
+    GPIO_InitTypeDef   gpio = {0};
+
+    __HAL_RCC_TIM3_CLK_ENABLE();
+    __HAL_RCC_TIM4_CLK_ENABLE();
+    __HAL_RCC_TIM5_CLK_ENABLE();
+    __HAL_RCC_TIM15_CLK_ENABLE();
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    __HAL_RCC_GPIOD_CLK_ENABLE();
+    __HAL_RCC_GPIOE_CLK_ENABLE();
+
+    oc.OCMode     = TIM_OCMODE_PWM1;
+    oc.Pulse      = 0U;
+    oc.OCPolarity = TIM_OCPOLARITY_HIGH;
+    oc.OCFastMode = TIM_OCFAST_DISABLE;
+
+    for (uint8_t ch = 0U; ch < BSP_PWM_COUNT; ch++)
+    {
+        const pwm_output_t *output = &pwm_outputs[ch];
+        TIM_HandleTypeDef  *htim   = &pwm_tim[ch];
+
+        htim->Instance               = output->instance;
+        htim->Init.Prescaler         = 0U;
+        htim->Init.CounterMode       = TIM_COUNTERMODE_UP;
+        htim->Init.Period            = PWM_COUNTER_RANGE - 1U;
+        htim->Init.ClockDivision     = TIM_CLOCKDIVISION_DIV1;
+        htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+        if ((HAL_TIM_PWM_Init(htim) != HAL_OK) ||
+            (HAL_TIM_PWM_ConfigChannel(htim, &oc, TIM_CHANNEL_1) != HAL_OK))
+        {
+            return BSP_ERROR;
+        }
+
+        /* ConfigChannel() sets OC1PE; hold the output low, enable it */
+        MODIFY_REG(output->instance->CCMR1, TIM_CCMR1_OC1M,
+                   TIM_OCMODE_FORCED_INACTIVE);
+        output->instance->CCER |= TIM_CCER_CC1E;
+        if (IS_TIM_BREAK_INSTANCE(output->instance))
+        {
+            output->instance->BDTR |= TIM_BDTR_MOE;
+        }
+
+        gpio.Pin       = output->pin;
+        gpio.Mode      = GPIO_MODE_AF_PP;
+        gpio.Pull      = GPIO_NOPULL;
+        gpio.Speed     = GPIO_SPEED_FREQ_LOW;
+        gpio.Alternate = output->alternate;
+        HAL_GPIO_Init(output->port, &gpio);
+    }
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          Digital Input Initialization                      */
+/*============================================================================*/
+
+/**
+ * @brief Sample all digital inputs, one IDR read per port
+ * @return Raw input states, bit n = DIn
+ */
+static uint8_t gpiodi_sample(void)
+{
+    uint32_t idr[GPIODI_PORT_COUNT];
+    uint8_t  bits = 0U;
+
+    for (uint8_t p = 0U; p < GPIODI_PORT_COUNT; p++)
+    {
+        idr[p] = gpiodi_ports[p]->IDR;
+    }
+
+    for (uint8_t ch = 0U; ch < BSP_GPIODI_COUNT; ch++)
+    {
+        const gpiodi_input_t *input = &gpiodi_inputs[ch];
+
+        bits |= (uint8_t)(((idr[input->slot] >> input->line) & 1U) << ch);
+    }
+
+    return bits;
+}
+
+/**
+ * @brief Seed the debounce filter and enable the EXTI interrupts
+ *
+ * The filter starts from the pins as they are. No input is captured yet;
+ * BSP_GPIODI_CaptureSelect() routes the EXTI lines to the inputs and
+ * unmasks them.
+ */
+static void gpiodi_init(void)
+{
+    gpiodi_debounced = gpiodi_sample();
+
+    (void)memset((void *)gpiodi_line_owner, GPIODI_LINE_FREE,
+                 sizeof(gpiodi_line_owner));
+
+    for (uint8_t ch = 0U; ch < BSP_GPIODI_COUNT; ch++)
+    {
+        /* Inputs sharing a line set the same interrupt up twice */
+        HAL_NVIC_SetPriority(gpiodi_inputs[ch].irq, GPIODI_IRQ_PRIORITY, 0);
+        HAL_NVIC_EnableIRQ(gpiodi_inputs[ch].irq);
+    }
+}
+
+/*============================================================================*/
+/*                          PTP Time Initialization                           */
+/*============================================================================*/
+
+/**
+ * @brief Start the MAC system time and PTP timestamping
+ *
+ * Runs after MX_ETH_Init(), whose MAC reset clears the timestamp unit. The
+ * accumulator overflows at 50 MHz with the nominal addend, each time adding
+ * PTP_SUBSECOND_INC_NS to the nanoseconds counter (digital rollover at
+ * 10^9). As a slave, the MAC takes RX snapshots of Sync messages over
+ * UDP/IPv4; TX snapshots are requested per frame (ethernetif.c).
+ */
+/**
+ * @brief Accumulator addend of the nominal rate at an HCLK frequency
+ */
+static uint32_t ptp_addend_at(uint32_t hclk_hz)
+{
+    uint64_t update_hz = (uint64_t)BSP_PTP_NS_PER_S / PTP_SUBSECOND_INC_NS;
+
+    return (uint32_t)((update_hz << 32) / hclk_hz);
+}
+
+/**
+ * @brief Load the addend of a rate correction into the MAC
+ * @param ppb Correction in parts per billion, within the servo's range
+ */
+static void ptp_load_addend(int32_t ppb)
+{
+    /* The rate is proportional to the addend */
+    int64_t delta = ((int64_t)ptp_addend_nominal * ppb) / BSP_PTP_NS_PER_S;
+
+    WRITE_REG(heth.Instance->MACTSAR,
+              (uint32_t)((int64_t)ptp_addend_nominal + delta));
+    SET_BIT(heth.Instance->MACTSCR, ETH_MACTSCR_TSADDREG);
+}
+
+static void ptp_time_init(void)
+{
+    ETH_PTP_ConfigTypeDef config = {0};
+
+    ptp_addend_nominal = ptp_addend_at(HAL_RCC_GetHCLKFreq());
+
+    config.Timestamp             = ENABLE;
+    config.TimestampUpdateMode   = ENABLE; /* Fine update */
+    config.TimestampAddendUpdate = ENABLE;
+    config.TimestampRolloverMode = ENABLE; /* Digital rollover */
+    config.TimestampV2           = ENABLE;
+    config.TimestampIPv4         = ENABLE;
+    config.TimestampEvent        = ENABLE; /* Event messages only */
+    config.TimestampMaster       = DISABLE;
+    config.TimestampAddend       = ptp_addend_nominal;
+    config.TimestampSubsecondInc = PTP_SUBSECOND_INC_NS
+                                   << ETH_MACMACSSIR_SSINC_Pos;
+
+    if (HAL_ETH_PTP_SetConfig(&heth, &config) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    ptp_running = true;
+
+    /* Compare channel 1 of the capture timer (frozen output mode, no
+     * preload) ends BSP_Time_SleepUntilNs() */
+    HAL_NVIC_SetPriority(TIM2_IRQn, PTP_SLEEP_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TIM2_IRQn);
+}
+
+/*============================================================================*/
+/*                          Clock Profile Control                             */
+/*============================================================================*/
+
+/**
+ * @brief Set the flash wait states and programming delay of a profile
+ */
+static void clock_set_flash(const clock_setting_t *setting)
+{
+    __HAL_FLASH_SET_LATENCY(setting->latency);
+    while (__HAL_FLASH_GET_LATENCY() != setting->latency)
+    {
+    }
+    __HAL_FLASH_SET_PROGRAM_DELAY(setting->delay);
+}
+
+/**
+ * @brief Switch the system clock to a profile (interrupts masked)
+ *
+ * Wait states go up before HCLK does and down after it has. The kernel
+ * tick in progress restarts on the new reload value, so the tick count
+ * falls behind by less than one tick per switch.
+ */
+static void clock_apply(bsp_clock_profile_t profile)
+{
+    const clock_setting_t *setting = &clock_settings[profile];
+    bool faster = (setting->latency > __HAL_FLASH_GET_LATENCY());
+
+    if (faster)
+    {
+        clock_set_flash(setting);
+    }
+    MODIFY_REG(RCC->CFGR2, RCC_CFGR2_HPRE, setting->hpre);
+    if (!faster)
+    {
+        clock_set_flash(setting);
+    }
+
+    SystemCoreClockUpdate();
+    SysTick->LOAD = (SystemCoreClock / configTICK_RATE_HZ) - 1U;
+    SysTick->VAL  = 0U;
+    (void)HAL_InitTick(uwTickPrio);
+
+    if (ptp_running)
+    {
+        /* An update still pending is one cycle of the PTP clock away */
+        while ((heth.Instance->MACTSCR & ETH_MACTSCR_TSADDREG) != 0U)
+        {
+        }
+        ptp_addend_nominal = ptp_addend_at(SystemCoreClock);
+        ptp_load_addend(ptp_adjust_ppb);
+    }
+
+    clock_profile = profile;
+}
+
+/**
+ * @brief Whether no timer of the BSP has work (interrupts masked)
+ */
+static bool clock_idle_allowed(void)
+{
+    return (clock_holds == 0U) && !adc1_running &&
+#if BSP_SPIADC_ENABLE
+           !spiadc_running &&
+#endif
+           (pwm_running == 0U) && (gpiodi_selected == 0U) &&
+           (ptp_sleeper == NULL) && (profile_hook == NULL) && !flash_busy;
+}
+
+/**
+ * @brief Bring the full profile back before a timer is set up
+ *
+ * For a start that sets its running flag in the same critical section;
+ * callable with interrupts masked.
+ */
+static void clock_require_full(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (clock_profile != BSP_CLOCK_FULL)
+    {
+        clock_apply(BSP_CLOCK_FULL);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Keep the full profile from the start of a timer set up until
+ * clock_release(), by which time its running flag is set
+ */
+static void clock_hold(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    clock_holds++;
+    clock_require_full();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief End a clock_hold()
+ */
+static void clock_release(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    clock_holds--;
+    __set_PRIMASK(primask);
+}
+
+/*============================================================================*/
+/*                          SPI ADC Functions                                 */
+/*============================================================================*/
+
+#if BSP_SPIADC_ENABLE
+/**
+ * @brief Record the capture time of a received DMA half and hand it over to
+ * the publishing task (ISR)
+ * @param half Index of the half that has just been filled (0 or 1)
+ *
+ * TIM8 counts in step with the capture timer, so the last frame of the
+ * half is the one of the latest CONVST edge at least SPIADC_FRAME_TICKS
+ * before now; a later frame is still being converted or read. This holds
+ * while the interrupt runs within a frame period of the half's end.
+ */
+static void spiadc_block_ready_from_isr(uint32_t half)
+{
+    BaseType_t woken  = pdFALSE;
+    uint32_t   bit    = (half == 0U) ? ADC1_BLOCK_FIRST_HALF
+                                     : ADC1_BLOCK_SECOND_HALF;
+    uint32_t   count  = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+    uint64_t   now_ns = BSP_Time_NowNs();
+    uint32_t   phase  = count % SPIADC_PERIOD;
+    uint64_t   now    = timebase_extend_from_isr(count);
+    uint64_t   first  = now - phase;
+
+    if (phase < SPIADC_FRAME_TICKS)
+    {
+        first -= SPIADC_PERIOD;
+    }
+    first -= (uint64_t)(BSP_SPIADC_BLOCK_SAMPLES - 1U) * SPIADC_PERIOD;
+
+    spiadc_block_capture[half]    = first;
+    spiadc_block_capture_ns[half] = now_ns - ((now - first) *
+                                              ADC1_TIMESTAMP_NS);
+
+    if ((spiadc_pending & bit) != 0U)
+    {
+        spiadc_stats.block_overruns++;
+    }
+    spiadc_pending  |= bit;
+    spiadc_last_half = half;
+
+    vTaskNotifyGiveFromISR(spiadc_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Receive DMA half-transfer callback: the first half is complete
+ */
+static void spiadc_dma_half_cplt(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    spiadc_block_ready_from_isr(0U);
+}
+
+/**
+ * @brief Receive DMA transfer-complete callback: the second half is
+ * complete
+ */
+static void spiadc_dma_cplt(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    spiadc_block_ready_from_isr(1U);
+}
+
+/**
+ * @brief Receive DMA error callback; the task restarts the transfer
+ */
+static void spiadc_dma_error(DMA_HandleTypeDef *hdma)
+{
+    BaseType_t woken = pdFALSE;
+
+    (void)hdma;
+    spiadc_error = true;
+
+    vTaskNotifyGiveFromISR(spiadc_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Enable the SPI1 kernel clock, the bus clocks and the pins
+ * @return BSP_OK, or BSP_ERROR if the kernel clock cannot be selected
+ */
+static bsp_error_t spiadc_msp_init(void)
+{
+    GPIO_InitTypeDef         gpio = {0};
+    RCC_PeriphCLKInitTypeDef clk  = {0};
+
+    clk.PeriphClockSelection = RCC_PERIPHCLK_SPI1;
+    clk.Spi1ClockSelection   = RCC_SPI1CLKSOURCE_PLL1Q;
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    __HAL_RCC_SPI1_CLK_ENABLE();
+    __HAL_RCC_TIM8_CLK_ENABLE();
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    __HAL_RCC_GPIOG_CLK_ENABLE();
+
+    gpio.Mode  = GPIO_MODE_AF_PP;
+    gpio.Pull  = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+
+    /* PA5 SPI1_SCK, PG9 SPI1_MISO, PG10 SPI1_NSS */
+    gpio.Alternate = GPIO_AF5_SPI1;
+    gpio.Pin       = GPIO_PIN_5;
+    HAL_GPIO_Init(GPIOA, &gpio);
+    gpio.Pin = GPIO_PIN_9 | GPIO_PIN_10;
+    HAL_GPIO_Init(GPIOG, &gpio);
+
+    /* PC7 TIM8_CH2, CONVST */
+    gpio.Alternate = GPIO_AF3_TIM8;
+    gpio.Pin       = GPIO_PIN_7;
+    HAL_GPIO_Init(GPIOC, &gpio);
+
+    HAL_NVIC_SetPriority(SPIADC_DMA_RX_IRQn, SPIADC_DMA_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(SPIADC_DMA_RX_IRQn);
+
+    return BSP_OK;
+}
+
+/**
+ * @brief Configure SPI1 as a receive-only master of one frame per transfer
+ *
+ * Left disabled. The HAL SPI driver is not built, and the restart DMA
+ * writes the registers anyway. The pins stay driven while SPI1 is
+ * disabled between frames (AFCNTR): SCK idles high, NSS high. Data is
+ * sampled on the rising SCK edge (CPOL 1, CPHA 1), most significant bit
+ * first, and NSS falls one SCK period before the first edge.
+ */
+static void spiadc_spi_init(void)
+{
+    SPI1->CR1  = 0U;
+    SPI1->CFG1 = ((BSP_SPIADC_SCK_DIV_LOG2 - 1U) << SPI_CFG1_MBR_Pos) |
+                 SPI_CFG1_RXDMAEN |
+                 ((BSP_SPIADC_RESULT_BITS - 1U) << SPI_CFG1_DSIZE_Pos);
+    SPI1->CFG2 = SPI_CFG2_AFCNTR | SPI_CFG2_SSOE | SPI_CFG2_CPOL |
+                 SPI_CFG2_CPHA | SPI_CFG2_MASTER | SPI_CFG2_COMM_1 |
+                 (1UL << SPI_CFG2_MSSI_Pos);
+    SPI1->CR2  = BSP_SPIADC_NUM_CHANNELS << SPI_CR2_TSIZE_Pos;
+
+    spiadc_restart_words[0] = 0U;
+    spiadc_restart_words[1] = SPI_IFCR_EOTC | SPI_IFCR_TXTFC | SPI_IFCR_OVRC |
+                              SPI_IFCR_MODFC | SPI_IFCR_SUSPC;
+    spiadc_restart_words[2] = SPI_CR1_SPE;
+    spiadc_restart_words[3] = SPI_CR1_SPE | SPI_CR1_CSTART;
+    BSP_Cache_CleanRange(spiadc_restart_words, sizeof(spiadc_restart_words));
+}
+
+/**
+ * @brief Set up TIM8 to start with TIM1, on the capture timer's grid
+ * @return BSP_OK, or BSP_ERROR if a HAL call fails
+ *
+ * TIM8 (ITR0 = TIM1 TRGO) runs from the same timer clock and prescaler as
+ * TIM1 and TIM2 and is started by TIM1's counter enable, so its periods
+ * begin on multiples of SPIADC_PERIOD in capture time. Must run before
+ * TIM1 is started, and the ADC1 trigger period must be a whole number of
+ * frame periods for the grid to survive the capture timer's wrap-around.
+ */
+static bsp_error_t spiadc_timer_init(void)
+{
+    TIM_OC_InitTypeDef     oc    = {0};
+    TIM_SlaveConfigTypeDef slave = {0};
+
+    if ((g_trigger_period % SPIADC_PERIOD) != 0U)
+    {
+        return BSP_ERROR;
+    }
+
+    spiadc_tim.Instance               = TIM8;
+    spiadc_tim.Init.Prescaler         = htim1.Init.Prescaler;
+    spiadc_tim.Init.CounterMode       = TIM_COUNTERMODE_UP;
+    spiadc_tim.Init.Period            = SPIADC_PERIOD - 1U;
+    spiadc_tim.Init.ClockDivision     = TIM_CLOCKDIVISION_DIV1;
+    spiadc_tim.Init.RepetitionCounter = 0U;
+    spiadc_tim.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    if (HAL_TIM_PWM_Init(&spiadc_tim) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    slave.SlaveMode    = TIM_SLAVEMODE_TRIGGER;
+    slave.InputTrigger = TIM_TS_ITR0;
+    if (HAL_TIM_SlaveConfigSynchro(&spiadc_tim, &slave) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    /* CONVST rises at the start of every period */
+    oc.OCMode       = TIM_OCMODE_PWM1;
+    oc.Pulse        = SPIADC_CONVST_TICKS;
+    oc.OCPolarity   = TIM_OCPOLARITY_HIGH;
+    oc.OCNPolarity  = TIM_OCNPOLARITY_HIGH;
+    oc.OCFastMode   = TIM_OCFAST_DISABLE;
+    oc.OCIdleState  = TIM_OCIDLESTATE_RESET;
+    oc.OCNIdleState = TIM_OCNIDLESTATE_RESET;
+    if (HAL_TIM_PWM_ConfigChannel(&spiadc_tim, &oc, TIM_CHANNEL_2) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    /* The frame is read once converted: a compare without an output */
+    oc.OCMode = TIM_OCMODE_TIMING;
+    oc.Pulse  = SPIADC_READ_TICKS;
+    if (HAL_TIM_OC_ConfigChannel(&spiadc_tim, &oc, TIM_CHANNEL_3) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+    __HAL_TIM_ENABLE_DMA(&spiadc_tim, TIM_DMA_CC3);
+
+    /* Armed: the counter waits for TIM1 */
+    if (HAL_TIM_PWM_Start(&spiadc_tim, TIM_CHANNEL_2) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    return BSP_OK;
+}
+
+/**
+ * @brief Build the linked lists of both DMA channels
+ * @return BSP_OK, or BSP_ERROR if a DMA call fails
+ */
+static bsp_error_t spiadc_dma_init(void)
+{
+    DMA_NodeConfTypeDef node_config = {0};
+
+    /* Receive: one circular node over both halves, HT and TC per half */
+    node_config.NodeType             = DMA_GPDMA_LINEAR_NODE;
+    node_config.Init.Request         = GPDMA1_REQUEST_SPI1_RX;
+    node_config.Init.BlkHWRequest    = DMA_BREQ_SINGLE_BURST;
+    node_config.Init.Direction       = DMA_PERIPH_TO_MEMORY;
+    node_config.Init.SrcInc          = DMA_SINC_FIXED;
+    node_config.Init.DestInc         = DMA_DINC_INCREMENTED;
+    node_config.Init.SrcDataWidth    = SPIADC_SRC_DATAWIDTH;
+    node_config.Init.DestDataWidth   = SPIADC_DEST_DATAWIDTH;
+    node_config.Init.SrcBurstLength  = 1;
+    node_config.Init.DestBurstLength = 1;
+    node_config.Init.TransferAllocatedPort =
+        DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1;
+    node_config.Init.TransferEventMode          = DMA_TCEM_BLOCK_TRANSFER;
+    node_config.Init.Mode                       = DMA_NORMAL;
+    node_config.DataHandlingConfig.DataExchange = DMA_EXCHANGE_NONE;
+    node_config.DataHandlingConfig.DataAlignment =
+        DMA_DATA_RIGHTALIGN_ZEROPADDED;
+    node_config.TriggerConfig.TriggerPolarity = DMA_TRIG_POLARITY_MASKED;
+    node_config.SrcAddress = (uint32_t)&SPI1->RXDR;
+    node_config.DstAddress = (uint32_t)spiadc_dma_buffer;
+    node_config.DataSize   = sizeof(spiadc_dma_buffer);
+
+    if ((HAL_DMAEx_List_BuildNode(&node_config, &spiadc_rx_node) != HAL_OK) ||
+        (HAL_DMAEx_List_ResetQ(&spiadc_rx_list) != HAL_OK) ||
+        (HAL_DMAEx_List_InsertNode_Tail(&spiadc_rx_list, &spiadc_rx_node) !=
+         HAL_OK) ||
+        (HAL_DMAEx_List_SetCircularMode(&spiadc_rx_list) != HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+
+    spiadc_dma_rx.Instance                         = SPIADC_DMA_RX_CHANNEL;
+    spiadc_dma_rx.InitLinkedList.Priority          = DMA_HIGH_PRIORITY;
+    spiadc_dma_rx.InitLinkedList.LinkStepMode      = DMA_LSM_FULL_EXECUTION;
+    spiadc_dma_rx.InitLinkedList.LinkAllocatedPort = DMA_LINK_ALLOCATED_PORT0;
+    spiadc_dma_rx.InitLinkedList.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+    spiadc_dma_rx.InitLinkedList.LinkedListMode    = DMA_LINKEDLIST_CIRCULAR;
+
+    if ((HAL_DMAEx_List_Init(&spiadc_dma_rx) != HAL_OK) ||
+        (HAL_DMAEx_List_LinkQ(&spiadc_dma_rx, &spiadc_rx_list) != HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+    spiadc_dma_rx.XferHalfCpltCallback = spiadc_dma_half_cplt;
+    spiadc_dma_rx.XferCpltCallback     = spiadc_dma_cplt;
+    spiadc_dma_rx.XferErrorCallback    = spiadc_dma_error;
+
+    /*
+     * Restart: the first node waits for the TIM8 channel 3 request and
+     * disables SPI1, the other two follow at once on software requests.
+     */
+    node_config.Init.SrcInc       = DMA_SINC_INCREMENTED;
+    node_config.Init.DestInc      = DMA_DINC_FIXED;
+    node_config.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_WORD;
+    node_config.Init.DestDataWidth = DMA_DEST_DATAWIDTH_WORD;
+    node_config.Init.TransferAllocatedPort =
+        DMA_SRC_ALLOCATED_PORT1 | DMA_DEST_ALLOCATED_PORT0;
+    if (HAL_DMAEx_List_ResetQ(&spiadc_restart_list) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+    for (uint32_t n = 0U; n < 3U; n++)
+    {
+        static const uint8_t first_word[3] = {0U, 1U, 2U};
+        static const uint8_t words[3]      = {1U, 1U, 2U};
+
+        node_config.Init.Request   = (n == 0U) ? GPDMA1_REQUEST_TIM8_CH3
+                                               : DMA_REQUEST_SW;
+        node_config.Init.Direction = (n == 0U) ? DMA_MEMORY_TO_PERIPH
+                                               : DMA_MEMORY_TO_MEMORY;
+        node_config.SrcAddress =
+            (uint32_t)&spiadc_restart_words[first_word[n]];
+        node_config.DstAddress = (n == 1U) ? (uint32_t)&SPI1->IFCR
+                                           : (uint32_t)&SPI1->CR1;
+        node_config.DataSize   = words[n] * sizeof(uint32_t);
+
+        if ((HAL_DMAEx_List_BuildNode(&node_config,
+                                      &spiadc_restart_nodes[n]) != HAL_OK) ||
+            (HAL_DMAEx_List_InsertNode_Tail(&spiadc_restart_list,
+                                            &spiadc_restart_nodes[n]) !=
+             HAL_OK))
+        {
+            return BSP_ERROR;
+        }
+    }
+    if (HAL_DMAEx_List_SetCircularMode(&spiadc_restart_list) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    spiadc_dma_restart.Instance = SPIADC_DMA_RESTART_CHANNEL;
+    spiadc_dma_restart.InitLinkedList.Priority     = DMA_HIGH_PRIORITY;
+    spiadc_dma_restart.InitLinkedList.LinkStepMode = DMA_LSM_FULL_EXECUTION;
+    spiadc_dma_restart.InitLinkedList.LinkAllocatedPort =
+        DMA_LINK_ALLOCATED_PORT0;
+    spiadc_dma_restart.InitLinkedList.TransferEventMode =
+        DMA_TCEM_BLOCK_TRANSFER;
+    spiadc_dma_restart.InitLinkedList.LinkedListMode =
+        DMA_LINKEDLIST_CIRCULAR;
+
+    if ((HAL_DMAEx_List_Init(&spiadc_dma_restart) != HAL_OK) ||
+        (HAL_DMAEx_List_LinkQ(&spiadc_dma_restart, &spiadc_restart_list) !=
+         HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+
+    return BSP_OK;
+}
+
+/**
+ * @brief Start both DMA channels on their linked lists
+ *
+ * The receive buffer starts over at its first frame, and the restart
+ * channel at the node that waits for TIM8.
+ */
+static HAL_StatusTypeDef spiadc_start_dma(void)
+{
+    HAL_StatusTypeDef status;
+
+    SPI1->CR1  = 0U;
+    SPI1->IFCR = spiadc_restart_words[1];
+
+    status = HAL_DMAEx_List_Start_IT(&spiadc_dma_rx);
+    if (status == HAL_OK)
+    {
+        status = HAL_DMAEx_List_Start(&spiadc_dma_restart);
+        if (status != HAL_OK)
+        {
+            (void)HAL_DMA_Abort(&spiadc_dma_rx);
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Stop both DMA channels and SPI1; the lists stay linked
+ */
+static HAL_StatusTypeDef spiadc_stop_dma(void)
+{
+    HAL_StatusTypeDef restart = HAL_DMA_Abort(&spiadc_dma_restart);
+    HAL_StatusTypeDef rx;
+
+    SPI1->CR1 = 0U;
+    rx        = HAL_DMA_Abort(&spiadc_dma_rx);
+
+    return (restart != HAL_OK) ? restart : rx;
+}
+
+/**
+ * @brief Sign-extend a received word
+ */
+static int32_t spiadc_sign_extend(uint32_t word)
+{
+    const uint32_t mask = UINT32_MAX >> (32U - BSP_SPIADC_RESULT_BITS);
+    const uint32_t sign = 1UL << (BSP_SPIADC_RESULT_BITS - 1U);
+
+    return (int32_t)(((word & mask) ^ sign) - sign);
+}
+
+/**
+ * @brief Publish one received DMA half into the sample ring (task only)
+ * @param half Index of the half (0 or 1)
+ *
+ * As the ADC1 filter task does: a block that starts later than the
+ * previous one ended is preceded by a gap, and the block's time is
+ * written under the busy marker before the block is published.
+ */
+static void spiadc_publish_half(uint32_t half)
+{
+    uint32_t                head    = spiadc_ring_head;
+    uint64_t                capture = spiadc_block_capture[half];
+    uint32_t                gap     = 0U;
+    uint32_t                sequence;
+    bsp_spiadc_block_hook_t hook;
+
+    BSP_Cache_InvalidateRange(spiadc_dma_buffer[half],
+                              sizeof(spiadc_dma_buffer[half]));
+
+    if (spiadc_last_capture_valid)
+    {
+        uint64_t expected =
+            spiadc_last_capture +
+            ((uint64_t)BSP_SPIADC_BLOCK_SAMPLES * SPIADC_PERIOD);
+
+        if (capture > expected)
+        {
+            gap = (uint32_t)((capture - expected) / SPIADC_PERIOD);
+        }
+    }
+    spiadc_last_capture       = capture;
+    spiadc_last_capture_valid = true;
+
+    spiadc_sequence_skip += gap;
+    spiadc_stats.missed  += gap;
+    sequence              = head + spiadc_sequence_skip;
+
+    for (uint32_t i = 0U; i < BSP_SPIADC_BLOCK_SAMPLES; i++)
+    {
+        bsp_spiadc_sample_t *entry =
+            &spiadc_ring[(head + i) & SPIADC_RING_MASK];
+
+        entry->sequence = sequence + i;
+        entry->gap      = (i == 0U) ? gap : 0U;
+        for (uint32_t ch = 0U; ch < BSP_SPIADC_NUM_CHANNELS; ch++)
+        {
+            entry->raw[ch] = spiadc_sign_extend(spiadc_dma_buffer[half][i][ch]);
+        }
+    }
+
+    /* Block timestamp, rewritten under the busy marker */
+    {
+        uint32_t           block = head / BSP_SPIADC_BLOCK_SAMPLES;
+        adc1_block_time_t *slot =
+            &spiadc_block_times[block & SPIADC_TIME_RING_MASK];
+
+        slot->block = ADC1_TIME_SLOT_BUSY;
+        __DMB();
+        slot->sequence = sequence;
+        slot->samples  = BSP_SPIADC_BLOCK_SAMPLES;
+        slot->period   = SPIADC_PERIOD;
+        slot->time     = capture;
+        slot->time_ns  = spiadc_block_capture_ns[half];
+        __DMB();
+        slot->block = block;
+    }
+
+    /* Publish the block only once every entry is complete */
+    __DMB();
+    spiadc_ring_head    = head + BSP_SPIADC_BLOCK_SAMPLES;
+    spiadc_stats.frames += BSP_SPIADC_BLOCK_SAMPLES;
+
+    hook = spiadc_block_hook;
+    if (hook != NULL)
+    {
+        hook(spiadc_ring[(head + BSP_SPIADC_BLOCK_SAMPLES - 1U) &
+                         SPIADC_RING_MASK]
+                 .raw);
+    }
+}
+
+/**
+ * @brief Restart the DMA after an error or a stall (task only)
+ *
+ * The partly received half is dropped; its frames are part of the gap
+ * seen by the next block. If the DMA does not start again the error stays
+ * set and the task retries after SPIADC_STALL_MS.
+ */
+static void spiadc_recover(void)
+{
+    (void)spiadc_stop_dma();
+
+    taskENTER_CRITICAL();
+    spiadc_error   = false;
+    spiadc_pending = 0U;
+    taskEXIT_CRITICAL();
+
+    spiadc_stats.errors++;
+    if (spiadc_start_dma() != HAL_OK)
+    {
+        spiadc_error = true;
+    }
+}
+
+/**
+ * @brief External ADC publishing task
+ * @param pvParameters Unused
+ *
+ * Sleeps until the DMA ISR hands over a received half, then publishes it;
+ * two pending halves are published oldest first. While running, a DMA
+ * error or SPIADC_STALL_MS without a block (the restart channel has no
+ * interrupt) restarts both channels.
+ */
+static void spiadc_publish_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;)
+    {
+        uint32_t notified;
+        uint32_t pending;
+        uint32_t last_half;
+
+        notified = ulTaskNotifyTake(pdTRUE,
+                                    spiadc_running
+                                        ? pdMS_TO_TICKS(SPIADC_STALL_MS)
+                                        : portMAX_DELAY);
+
+        taskENTER_CRITICAL();
+        pending        = spiadc_pending;
+        last_half      = spiadc_last_half;
+        spiadc_pending = 0U;
+        taskEXIT_CRITICAL();
+
+        if (pending == (ADC1_BLOCK_FIRST_HALF | ADC1_BLOCK_SECOND_HALF))
+        {
+            spiadc_publish_half(1U - last_half);
+            spiadc_publish_half(last_half);
+        }
+        else if (pending == ADC1_BLOCK_FIRST_HALF)
+        {
+            spiadc_publish_half(0U);
+        }
+        else if (pending == ADC1_BLOCK_SECOND_HALF)
+        {
+            spiadc_publish_half(1U);
+        }
+        else
+        {
+            /* Error, start or stall: nothing to publish */
+        }
+
+        if (spiadc_running && (spiadc_error || (notified == 0U)))
+        {
+            spiadc_recover();
+        }
+    }
+}
+
+/**
+ * @brief Set up the external ADC, its timer and its task
+ * @return BSP_OK, or BSP_ERROR if a peripheral cannot be set up
+ *
+ * Runs after adc1_timebase_init() and before TIM1 is started.
+ */
+static bsp_error_t spiadc_init(void)
+{
+    if ((spiadc_msp_init() != BSP_OK) || (spiadc_timer_init() != BSP_OK))
+    {
+        return BSP_ERROR;
+    }
+    spiadc_spi_init();
+    if (spiadc_dma_init() != BSP_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    spiadc_task = xTaskCreateStatic(
+        spiadc_publish_task, "SpiAdc", SPIADC_TASK_STACK_SIZE, NULL,
+        SPIADC_TASK_PRIORITY, spiadc_task_stack, &spiadc_task_tcb);
+
+    return (spiadc_task != NULL) ? BSP_OK : BSP_ERROR;
+}
+
+/**
+ * @brief Look up the capture time of a frame in the timestamp history
+ * @param sequence Frame sequence number
+ * @param time     Capture time, interpolated at the frame period
+ * @param time_ns  Capture time on the PTP timescale, or NULL
+ * @return true if the frame's block is in the history, false otherwise
+ *
+ * As adc1_lookup_time(), on the external ADC's history.
+ */
+static bool spiadc_lookup_time(uint32_t sequence, uint64_t *time,
+                               uint64_t *time_ns)
+{
+    uint32_t blocks = spiadc_ring_head / BSP_SPIADC_BLOCK_SAMPLES;
+
+    for (uint32_t n = 0U; (n < SPIADC_TIME_RING_SIZE) && (n < blocks); n++)
+    {
+        uint32_t                 block = blocks - 1U - n;
+        const adc1_block_time_t *slot =
+            &spiadc_block_times[block & SPIADC_TIME_RING_MASK];
+        uint32_t before;
+        uint32_t after;
+        uint32_t first;
+        uint32_t offset;
+        uint64_t capture;
+        uint64_t capture_ns;
+
+        before = slot->block;
+        __DMB();
+        first      = slot->sequence;
+        capture    = slot->time;
+        capture_ns = slot->time_ns;
+        __DMB();
+        after = slot->block;
+
+        if ((before != block) || (after != block))
+        {
+            /* Rewritten for a newer block meanwhile */
+            return false;
+        }
+
+        offset = sequence - first;
+        if ((int32_t)offset < 0)
+        {
+            continue;
+        }
+        if (offset >= BSP_SPIADC_BLOCK_SAMPLES)
+        {
+            return false;
+        }
+
+        *time = capture + ((uint64_t)offset * SPIADC_PERIOD);
+        if (time_ns != NULL)
+        {
+            *time_ns = capture_ns +
+                       ((uint64_t)offset * SPIADC_PERIOD * ADC1_TIMESTAMP_NS);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bsp_error_t BSP_SPIADC_Start(void)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (spiadc_task == NULL)
+    {
+        ret = BSP_ERROR;
+    }
+    else if (spiadc_running)
+    {
+        ret = BSP_BUSY;
+    }
+    else
+    {
+        /* TIM8 counts on the grid of the full profile */
+        clock_hold();
+
+        taskENTER_CRITICAL();
+        spiadc_error   = false;
+        spiadc_pending = 0U;
+        taskEXIT_CRITICAL();
+
+        if (spiadc_start_dma() != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+        else
+        {
+            /* The task now watches for a stall */
+            spiadc_running = true;
+            (void)xTaskNotifyGive(spiadc_task);
+        }
+
+        clock_release();
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_SPIADC_Stop(void)
+{
+    bsp_error_t ret = BSP_OK;
+
+    spiadc_running = false;
+    if (spiadc_stop_dma() != HAL_OK)
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bool BSP_SPIADC_IsRunning(void) { return spiadc_running; }
+
+void BSP_SPIADC_SetBlockHook(bsp_spiadc_block_hook_t hook)
+{
+    spiadc_block_hook = hook;
+}
+
+bsp_error_t BSP_SPIADC_RingReaderInit(bsp_spiadc_reader_t *reader)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (reader == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else
+    {
+        reader->cursor   = spiadc_ring_head;
+        reader->overruns = 0U;
+    }
+
+    return ret;
+}
+
+uint32_t BSP_SPIADC_RingAvailable(const bsp_spiadc_reader_t *reader)
+{
+    uint32_t available = 0U;
+
+    if (reader != NULL)
+    {
+        available = spiadc_ring_head - reader->cursor;
+        if (available > BSP_SPIADC_RING_SIZE)
+        {
+            available = BSP_SPIADC_RING_SIZE;
+        }
+    }
+
+    return available;
+}
+
+bsp_error_t BSP_SPIADC_RingRead(bsp_spiadc_reader_t *reader,
+                                bsp_spiadc_sample_t *samples,
+                                uint32_t max_count, uint32_t *count)
+{
+    bsp_error_t ret  = BSP_OK;
+    uint32_t    done = 0U;
+
+    if ((reader == NULL) || (samples == NULL) || (count == NULL))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else
+    {
+        uint32_t head   = spiadc_ring_head;
+        uint32_t cursor = reader->cursor;
+
+        /* Skip frames that have already been overwritten */
+        if ((head - cursor) > BSP_SPIADC_RING_SIZE)
+        {
+            reader->overruns += (head - cursor) - BSP_SPIADC_RING_SIZE;
+            cursor            = head - BSP_SPIADC_RING_SIZE;
+        }
+
+        __DMB();
+
+        while ((done < max_count) && (cursor != head))
+        {
+            uint32_t n     = head - cursor;
+            uint32_t first = cursor & SPIADC_RING_MASK;
+            uint32_t lost;
+
+            if (n > (max_count - done))
+            {
+                n = max_count - done;
+            }
+            if (n > (BSP_SPIADC_RING_SIZE - first))
+            {
+                n = BSP_SPIADC_RING_SIZE - first;
+            }
+
+            (void)memcpy(&samples[done], &spiadc_ring[first],
+                         n * sizeof(bsp_spiadc_sample_t));
+
+            /* Drop any entry the block being written could have reached,
+             * as BSP_ADC1_RingRead() */
+            __DMB();
+            head = spiadc_ring_head;
+            lost = 0U;
+            if ((head + BSP_SPIADC_BLOCK_SAMPLES - cursor) >
+                BSP_SPIADC_RING_SIZE)
+            {
+                lost = (head + BSP_SPIADC_BLOCK_SAMPLES - cursor) -
+                       BSP_SPIADC_RING_SIZE;
+                if (lost > n)
+                {
+                    lost = n;
+                }
+                reader->overruns += lost;
+            }
+
+            if (lost > 0U)
+            {
+                (void)memmove(&samples[done], &samples[done + lost],
+                              (n - lost) * sizeof(bsp_spiadc_sample_t));
+            }
+
+            done   += n - lost;
+            cursor += n;
+        }
+
+        reader->cursor = cursor;
+        *count         = done;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_SPIADC_GetSampleTime(uint32_t sequence, uint64_t *time)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (time == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!spiadc_lookup_time(sequence, time, NULL))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_SPIADC_GetSampleTimeNs(uint32_t sequence, uint64_t *time_ns)
+{
+    bsp_error_t ret = BSP_OK;
+    uint64_t    time;
+
+    if (time_ns == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!spiadc_lookup_time(sequence, &time, time_ns))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_SPIADC_GetStats(bsp_spiadc_stats_t *stats)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (stats == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else
+    {
+        *stats = spiadc_stats;
+    }
+
+    return ret;
+}
+
+void BSP_SPIADC_DMA_IRQHandler(void) { HAL_DMA_IRQHandler(&spiadc_dma_rx); }
+#else
+void BSP_SPIADC_DMA_IRQHandler(void) {}
+#endif
+
+/*============================================================================*/
+/*                          SPI NOR Flash Functions                           */
+/*============================================================================*/
+
+#if BSP_SPINOR_ENABLE
+/**
+ * @brief Wake the task in the data phase
+ */
+static void spinor_dma_cplt(DMA_HandleTypeDef *hdma)
+{
+    BaseType_t woken = pdFALSE;
+
+    (void)hdma;
+
+    if (spinor_waiter != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(spinor_waiter, BSP_SPINOR_NOTIFY_INDEX,
+                                      &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Fail the data phase and wake its task
+ */
+static void spinor_dma_error(DMA_HandleTypeDef *hdma)
+{
+    spinor_dma_failed = true;
+    spinor_dma_cplt(hdma);
+}
+
+/**
+ * @brief Enable SPI3 and its pins, and set up SPI3 and the DMA channel
+ * @return BSP_OK, or BSP_ERROR if the kernel clock or the channel cannot be
+ * set up
+ *
+ * SPI3 is a master in mode 0 with 8-bit frames, most significant bit
+ * first, left disabled between transfers; the pins stay driven meanwhile
+ * (AFCNTR), SCK low. The chip select is a plain output, high until a
+ * command.
+ */
+static bsp_error_t spinor_init(void)
+{
+    GPIO_InitTypeDef         gpio = {0};
+    RCC_PeriphCLKInitTypeDef clk  = {0};
+
+    clk.PeriphClockSelection = RCC_PERIPHCLK_SPI3;
+    clk.Spi3ClockSelection   = RCC_SPI3CLKSOURCE_PLL1Q;
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    __HAL_RCC_SPI3_CLK_ENABLE();
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+
+    /* PA15 chip select, deselected from the start */
+    HAL_GPIO_WritePin(SPINOR_CS_PORT, SPINOR_CS_PIN, GPIO_PIN_SET);
+    gpio.Pin   = SPINOR_CS_PIN;
+    gpio.Mode  = GPIO_MODE_OUTPUT_PP;
+    gpio.Pull  = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(SPINOR_CS_PORT, &gpio);
+
+    /* PC10 SPI3_SCK, PC11 SPI3_MISO, PC12 SPI3_MOSI */
+    gpio.Pin       = GPIO_PIN_10 | GPIO_PIN_11 | GPIO_PIN_12;
+    gpio.Mode      = GPIO_MODE_AF_PP;
+    gpio.Speed     = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio.Alternate = GPIO_AF6_SPI3;
+    HAL_GPIO_Init(GPIOC, &gpio);
+
+    SPI3->CR1  = SPI_CR1_SSI;
+    SPI3->CFG1 = ((SPINOR_SCK_DIV_LOG2 - 1U) << SPI_CFG1_MBR_Pos) |
+                 (7UL << SPI_CFG1_DSIZE_Pos);
+    SPI3->CFG2 = SPI_CFG2_AFCNTR | SPI_CFG2_SSM | SPI_CFG2_MASTER;
+
+    /* Set up for a program; a read changes the direction fields */
+    spinor_dma.Instance                   = GPDMA1_Channel7;
+    spinor_dma.Init.Request               = GPDMA1_REQUEST_SPI3_TX;
+    spinor_dma.Init.BlkHWRequest          = DMA_BREQ_SINGLE_BURST;
+    spinor_dma.Init.Direction             = DMA_MEMORY_TO_PERIPH;
+    spinor_dma.Init.SrcInc                = DMA_SINC_INCREMENTED;
+    spinor_dma.Init.DestInc               = DMA_DINC_FIXED;
+    spinor_dma.Init.SrcDataWidth          = DMA_SRC_DATAWIDTH_BYTE;
+    spinor_dma.Init.DestDataWidth         = DMA_DEST_DATAWIDTH_BYTE;
+    spinor_dma.Init.Priority              = DMA_LOW_PRIORITY_HIGH_WEIGHT;
+    spinor_dma.Init.SrcBurstLength        = 1;
+    spinor_dma.Init.DestBurstLength       = 1;
+    spinor_dma.Init.TransferAllocatedPort =
+        DMA_SRC_ALLOCATED_PORT1 | DMA_DEST_ALLOCATED_PORT0;
+    spinor_dma.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+    spinor_dma.Init.Mode              = DMA_NORMAL;
+
+    if ((HAL_DMA_Init(&spinor_dma) != HAL_OK) ||
+        (HAL_DMA_ConfigChannelAttributes(&spinor_dma, DMA_CHANNEL_PRIV) !=
+         HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+    spinor_dma.XferCpltCallback  = spinor_dma_cplt;
+    spinor_dma.XferErrorCallback = spinor_dma_error;
+
+    HAL_NVIC_SetPriority(GPDMA1_Channel7_IRQn, SPINOR_DMA_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel7_IRQn);
+
+    return BSP_OK;
+}
+
+static void spinor_select(void)
+{
+    HAL_GPIO_WritePin(SPINOR_CS_PORT, SPINOR_CS_PIN, GPIO_PIN_RESET);
+}
+
+static void spinor_deselect(void)
+{
+    HAL_GPIO_WritePin(SPINOR_CS_PORT, SPINOR_CS_PIN, GPIO_PIN_SET);
+}
+
+/**
+ * @brief Configure SPI3 for a transfer, still disabled
+ * @param comm   SPI_CFG2_COMM value: full duplex, transmit or receive only
+ * @param dma    SPI_CFG1_TXDMAEN, SPI_CFG1_RXDMAEN or 0
+ * @param length Frames of the transfer
+ */
+static void spinor_spi_setup(uint32_t comm, uint32_t dma, uint32_t length)
+{
+    SPI3->CR1  = SPI_CR1_SSI;
+    SPI3->IFCR = SPI_IFCR_EOTC | SPI_IFCR_TXTFC | SPI_IFCR_OVRC |
+                 SPI_IFCR_UDRC | SPI_IFCR_MODFC | SPI_IFCR_SUSPC;
+    SPI3->CFG1 = (SPI3->CFG1 & ~(SPI_CFG1_TXDMAEN | SPI_CFG1_RXDMAEN)) | dma;
+    SPI3->CFG2 = (SPI3->CFG2 & ~SPI_CFG2_COMM) | comm;
+    SPI3->CR2  = length << SPI_CR2_TSIZE_Pos;
+}
+
+/**
+ * @brief Wait for the end of the transfer, the last frame shifted
+ * @return false on a timeout
+ */
+static bool spinor_wait_eot(void)
+{
+    uint32_t start = BSP_CycleCounter_Read();
+    uint32_t limit = (BSP_CycleCounter_Hz() / 1000000U) * SPINOR_EOT_TIMEOUT_US;
+
+    while ((SPI3->SR & SPI_SR_EOT) == 0U)
+    {
+        if ((BSP_CycleCounter_Read() - start) > limit)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Disable SPI3 after a transfer; this flushes its FIFOs
+ */
+static void spinor_spi_stop(void)
+{
+    SPI3->IFCR = SPI_IFCR_EOTC | SPI_IFCR_TXTFC;
+    SPI3->CR1  = SPI_CR1_SSI;
+}
+
+/**
+ * @brief Exchange a few bytes through the FIFOs, full duplex
+ * @param tx     Bytes sent, NULL for 0xFF
+ * @param rx     Bytes received, NULL to drop them
+ * @param length Bytes, at most 8
+ * @return false if the transfer did not end
+ */
+static bool spinor_exchange(const uint8_t *tx, uint8_t *rx, uint32_t length)
+{
+    bool ok;
+
+    spinor_spi_setup(0U, 0U, length);
+    SPI3->CR1 = SPI_CR1_SSI | SPI_CR1_SPE;
+    for (uint32_t i = 0U; i < length; i++)
+    {
+        *(volatile uint8_t *)&SPI3->TXDR = (tx != NULL) ? tx[i] : 0xFFU;
+    }
+    SPI3->CR1 = SPI_CR1_SSI | SPI_CR1_SPE | SPI_CR1_CSTART;
+
+    ok = spinor_wait_eot();
+    for (uint32_t i = 0U; ok && (i < length); i++)
+    {
+        uint8_t byte = *(const volatile uint8_t *)&SPI3->RXDR;
+
+        if (rx != NULL)
+        {
+            rx[i] = byte;
+        }
+    }
+    spinor_spi_stop();
+
+    return ok;
+}
+
+/**
+ * @brief Send a command without arguments under its own chip select
+ */
+static bool spinor_command(uint8_t command)
+{
+    bool ok;
+
+    spinor_select();
+    ok = spinor_exchange(&command, NULL, 1U);
+    spinor_deselect();
+
+    return ok;
+}
+
+/**
+ * @brief Read the status register
+ */
+static bool spinor_read_status(uint8_t *status)
+{
+    const uint8_t tx[2] = {SPINOR_CMD_READ_STATUS, 0xFFU};
+    uint8_t       rx[2] = {0U, 0U};
+    bool          ok;
+
+    spinor_select();
+    ok = spinor_exchange(tx, rx, sizeof(tx));
+    spinor_deselect();
+    *status = rx[1];
+
+    return ok;
+}
+
+/**
+ * @brief Send a command with a 3-byte address, the chip already selected
+ * @param dummy Dummy bytes after the address, 0 or 1
+ */
+static bool spinor_address(uint8_t command, uint32_t address, uint32_t dummy)
+{
+    const uint8_t tx[5] = {command, (uint8_t)(address >> 16),
+                           (uint8_t)(address >> 8), (uint8_t)address, 0xFFU};
+
+    return spinor_exchange(tx, NULL, 4U + dummy);
+}
+
+/**
+ * @brief Move the data phase of a command by DMA, the chip selected
+ * @param tx     Bytes to send, or NULL to receive
+ * @param rx     Destination of a receive
+ * @param length Bytes, at most SPINOR_MAX_TRANSFER
+ * @return BSP_OK, BSP_TIMEOUT if the transfer did not end, otherwise
+ * BSP_ERROR
+ *
+ * SPI3 runs simplex in the direction of the phase, so only one DMA
+ * request is active; the calling task sleeps until the channel completes.
+ */
+static bsp_error_t spinor_transfer(const uint8_t *tx, uint8_t *rx,
+                                   uint32_t length)
+{
+    bool        transmit = (tx != NULL);
+    bsp_error_t status   = BSP_OK;
+
+    spinor_dma.Init.Request   = transmit ? GPDMA1_REQUEST_SPI3_TX
+                                         : GPDMA1_REQUEST_SPI3_RX;
+    spinor_dma.Init.Direction = transmit ? DMA_MEMORY_TO_PERIPH
+                                         : DMA_PERIPH_TO_MEMORY;
+    spinor_dma.Init.SrcInc    = transmit ? DMA_SINC_INCREMENTED
+                                         : DMA_SINC_FIXED;
+    spinor_dma.Init.DestInc   = transmit ? DMA_DINC_FIXED
+                                         : DMA_DINC_INCREMENTED;
+    spinor_dma.Init.TransferAllocatedPort =
+        transmit ? (DMA_SRC_ALLOCATED_PORT1 | DMA_DEST_ALLOCATED_PORT0)
+                 : (DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1);
+    if (HAL_DMA_Init(&spinor_dma) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    spinor_spi_setup(transmit ? SPI_CFG2_COMM_0 : SPI_CFG2_COMM_1,
+                     transmit ? SPI_CFG1_TXDMAEN : SPI_CFG1_RXDMAEN, length);
+
+    spinor_dma_failed = false;
+    spinor_waiter     = xTaskGetCurrentTaskHandle();
+    (void)xTaskNotifyStateClearIndexed(NULL, BSP_SPINOR_NOTIFY_INDEX);
+
+    if (transmit)
+    {
+        BSP_Cache_CleanRange(tx, length);
+        status = (HAL_DMA_Start_IT(&spinor_dma, (uint32_t)tx,
+                                   (uint32_t)&SPI3->TXDR, length) == HAL_OK)
+                     ? BSP_OK
+                     : BSP_ERROR;
+    }
+    else
+    {
+        status = (HAL_DMA_Start_IT(&spinor_dma, (uint32_t)&SPI3->RXDR,
+                                   (uint32_t)rx, length) == HAL_OK)
+                     ? BSP_OK
+                     : BSP_ERROR;
+    }
+
+    if (status == BSP_OK)
+    {
+        SPI3->CR1 = SPI_CR1_SSI | SPI_CR1_SPE;
+        SPI3->CR1 = SPI_CR1_SSI | SPI_CR1_SPE | SPI_CR1_CSTART;
+
+        if (ulTaskNotifyTakeIndexed(BSP_SPINOR_NOTIFY_INDEX, pdTRUE,
+                                    pdMS_TO_TICKS(SPINOR_DMA_TIMEOUT_MS)) ==
+            0U)
+        {
+            (void)HAL_DMA_Abort(&spinor_dma);
+            status = BSP_TIMEOUT;
+        }
+        else if (spinor_dma_failed)
+        {
+            status = BSP_ERROR;
+        }
+        else if (!spinor_wait_eot())
+        {
+            status = BSP_TIMEOUT;
+        }
+        else
+        {
+            /* All frames shifted */
+        }
+    }
+    spinor_spi_stop();
+    spinor_waiter = NULL;
+
+    if (!transmit)
+    {
+        BSP_Cache_InvalidateRange(rx, length);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Poll the status until no operation is in progress
+ * @param timeout_us Longest wait, busy-polled
+ */
+static bsp_error_t spinor_wait_ready_us(uint32_t timeout_us)
+{
+    uint32_t start = BSP_CycleCounter_Read();
+    uint32_t limit = (BSP_CycleCounter_Hz() / 1000000U) * timeout_us;
+    uint8_t  status;
+
+    for (;;)
+    {
+        if (!spinor_read_status(&status))
+        {
+            return BSP_ERROR;
+        }
+        if ((status & SPINOR_STATUS_WIP) == 0U)
+        {
+            return BSP_OK;
+        }
+        if ((BSP_CycleCounter_Read() - start) > limit)
+        {
+            return BSP_TIMEOUT;
+        }
+    }
+}
+
+/**
+ * @brief Poll the status until no operation is in progress, a tick apart
+ * @param timeout_ms Longest wait
+ */
+static bsp_error_t spinor_wait_ready_ms(uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    uint8_t    status;
+
+    for (;;)
+    {
+        if (!spinor_read_status(&status))
+        {
+            return BSP_ERROR;
+        }
+        if ((status & SPINOR_STATUS_WIP) == 0U)
+        {
+            return BSP_OK;
+        }
+        if ((xTaskGetTickCount() - start) > pdMS_TO_TICKS(timeout_ms))
+        {
+            return BSP_TIMEOUT;
+        }
+        vTaskDelay(1U);
+    }
+}
+
+/**
+ * @brief Suspend the erase in flight, if any, for a read or a program
+ * @param[out] suspended Set if a suspend was sent, to resume afterwards
+ * @return BSP_OK once the flash takes commands
+ *
+ * An erase that ended meanwhile ignores the suspend and the resume.
+ */
+static bsp_error_t spinor_suspend(bool *suspended)
+{
+    TickType_t hold = pdMS_TO_TICKS(SPINOR_RESUME_HOLD_MS);
+    TickType_t ran;
+
+    *suspended = false;
+    if (!spinor_erasing)
+    {
+        return BSP_OK;
+    }
+
+    ran = xTaskGetTickCount() - spinor_resumed;
+    if (ran < hold)
+    {
+        vTaskDelay(hold - ran);
+    }
+
+    if (!spinor_command(SPINOR_CMD_SUSPEND))
+    {
+        return BSP_ERROR;
+    }
+    *suspended = true;
+
+    return spinor_wait_ready_us(SPINOR_SUSPEND_TIMEOUT_US);
+}
+
+/**
+ * @brief Resume the erase suspended by spinor_suspend()
+ */
+static bsp_error_t spinor_resume(bool suspended)
+{
+    if (!suspended)
+    {
+        return BSP_OK;
+    }
+
+    spinor_resumed = xTaskGetTickCount();
+
+    return spinor_command(SPINOR_CMD_RESUME) ? BSP_OK : BSP_ERROR;
+}
+
+bsp_error_t BSP_SPINOR_Probe(uint32_t *size)
+{
+    const uint8_t tx[4] = {SPINOR_CMD_READ_ID, 0xFFU, 0xFFU, 0xFFU};
+    uint8_t       id[4] = {0U, 0U, 0U, 0U};
+    bool          ok;
+
+    if (size == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* Ends an erase or program left from before a restart, and a suspend */
+    spinor_size    = 0U;
+    spinor_erasing = false;
+    if (!spinor_command(SPINOR_CMD_RESET_ENABLE) ||
+        !spinor_command(SPINOR_CMD_RESET))
+    {
+        return BSP_ERROR;
+    }
+    vTaskDelay(pdMS_TO_TICKS(SPINOR_RESET_MS) + 1U);
+
+    spinor_select();
+    ok = spinor_exchange(tx, id, sizeof(tx));
+    spinor_deselect();
+
+    /* Manufacturer, memory type, capacity as log2 of the size in bytes; an
+     * absent chip reads all ones or zeros */
+    if (!ok || (id[1] == 0x00U) || (id[1] == 0xFFU) || (id[3] < 17U) ||
+        (id[3] > 31U))
+    {
+        return BSP_ERROR;
+    }
+
+    spinor_size = (id[3] >= 24U) ? BSP_SPINOR_MAX_SIZE : (1UL << id[3]);
+    *size       = spinor_size;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_SPINOR_Read(uint32_t address, void *data, uint32_t length)
+{
+    uint8_t    *dst = (uint8_t *)data;
+    bsp_error_t status;
+    bsp_error_t resumed;
+    bool        suspended;
+
+    if ((data == NULL) || (address > spinor_size) ||
+        (length > (spinor_size - address)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    status = spinor_suspend(&suspended);
+    while ((status == BSP_OK) && (length > 0U))
+    {
+        uint32_t chunk = (length < SPINOR_MAX_TRANSFER) ? length
+                                                        : SPINOR_MAX_TRANSFER;
+
+        spinor_select();
+        status = spinor_address(SPINOR_CMD_FAST_READ, address, 1U)
+                     ? spinor_transfer(NULL, dst, chunk)
+                     : BSP_ERROR;
+        spinor_deselect();
+
+        address += chunk;
+        dst += chunk;
+        length -= chunk;
+    }
+
+    resumed = spinor_resume(suspended);
+
+    return (status != BSP_OK) ? status : resumed;
+}
+
+bsp_error_t BSP_SPINOR_ProgramPage(uint32_t address, const void *data)
+{
+    bsp_error_t status;
+    bsp_error_t resumed;
+    bool        suspended;
+
+    if ((data == NULL) || ((address % BSP_SPINOR_PAGE_SIZE) != 0U) ||
+        (address >= spinor_size))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    status = spinor_suspend(&suspended);
+    if ((status == BSP_OK) && !spinor_command(SPINOR_CMD_WRITE_ENABLE))
+    {
+        status = BSP_ERROR;
+    }
+    if (status == BSP_OK)
+    {
+        /* The program starts as the chip select rises */
+        spinor_select();
+        status = spinor_address(SPINOR_CMD_PAGE_PROGRAM, address, 0U)
+                     ? spinor_transfer((const uint8_t *)data, NULL,
+                                       BSP_SPINOR_PAGE_SIZE)
+                     : BSP_ERROR;
+        spinor_deselect();
+    }
+    if (status == BSP_OK)
+    {
+        status = spinor_wait_ready_ms(SPINOR_PROGRAM_TIMEOUT_MS);
+    }
+
+    resumed = spinor_resume(suspended);
+
+    return (status != BSP_OK) ? status : resumed;
+}
+
+bsp_error_t BSP_SPINOR_EraseSector(uint32_t address)
+{
+    bool ok;
+
+    if (((address % BSP_SPINOR_SECTOR_SIZE) != 0U) ||
+        (address >= spinor_size))
+    {
+        return BSP_INVALID_ARG;
+    }
+    if (BSP_SPINOR_IsErasing())
+    {
+        return BSP_BUSY;
+    }
+
+    if (!spinor_command(SPINOR_CMD_WRITE_ENABLE))
+    {
+        return BSP_ERROR;
+    }
+    spinor_select();
+    ok = spinor_address(SPINOR_CMD_BLOCK_ERASE, address, 0U);
+    spinor_deselect();
+    if (!ok)
+    {
+        return BSP_ERROR;
+    }
+
+    spinor_erasing = true;
+    spinor_resumed = xTaskGetTickCount();
+
+    return BSP_OK;
+}
+
+bool BSP_SPINOR_IsErasing(void)
+{
+    uint8_t status;
+
+    /* Right after a start or resume the status may not show it yet */
+    if (spinor_erasing &&
+        ((xTaskGetTickCount() - spinor_resumed) >=
+         pdMS_TO_TICKS(SPINOR_RESUME_HOLD_MS)) &&
+        spinor_read_status(&status) && ((status & SPINOR_STATUS_WIP) == 0U))
+    {
+        spinor_erasing = false;
+    }
+
+    return spinor_erasing;
+}
+
+void BSP_SPINOR_DMA_IRQHandler(void) { HAL_DMA_IRQHandler(&spinor_dma); }
+#else
+void BSP_SPINOR_DMA_IRQHandler(void) {}
+#endif
+
+/*============================================================================*/
+/*                          BSP Initialization                                */
+/*============================================================================*/
+
+bsp_error_t BSP_Init(void)
+{
+    /* Reset of all peripherals, Initializes the Flash interface and the
+     * Systick. */
+    HAL_Init();
+
+    /* Configure MPU for the Ethernet and other DMA buffers */
+    MPU_Config();
+
+    SystemClock_Config();
+    MX_GTZC_NS_Init();
+
+    /* Start the DWT cycle counter behind BSP_CycleCounter_Read() */
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0U;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* Initialize all configured peripherals */
+    MX_GPDMA1_Init();
+    MX_GPIO_Init();
+    MX_LPUART1_UART_Init();
+    if (lpuart1_clock_init() != BSP_OK)
+    {
+        Error_Handler();
+    }
+    MX_TIM1_Init();
+    adc1_timebase_init();
+    MX_ADC1_Init();
+    adc1_config_oversampling();
+#if BSP_ADC1_DUAL_MODE
+    adc1_config_dual_mode();
+#elif BSP_ADC1_SLOW_CHANNELS
+    adc1_config_slow_channels();
+#endif
+    adc1_config_injected();
+    adc1_config_watchdogs();
+
+    BSP_LED_Init(LED_GREEN);
+    BSP_LED_Init(LED_YELLOW);
+    BSP_LED_Init(LED_RED);
+
+    /* Initialize USER push-button, will be used to trigger an interrupt each
+     * time it's pressed.*/
+    BSP_PB_Init(BUTTON_USER, BUTTON_MODE_EXTI);
+
+    BspCOMInit.BaudRate   = 115200;
+    BspCOMInit.WordLength = COM_WORDLENGTH_8B;
+    BspCOMInit.StopBits   = COM_STOPBITS_1;
+    BspCOMInit.Parity     = COM_PARITY_NONE;
+    BspCOMInit.HwFlowCtl  = COM_HWCONTROL_NONE;
+    if ((console_clock_init() != BSP_OK) ||
+        (BSP_COM_Init(COM1, &BspCOMInit) != BSP_ERROR_NONE))
+    {
+        Error_Handler();
+    }
+    if (console_dma_init() != BSP_OK)
+    {
+        Error_Handler();
+    }
+    if (lowpower_timer_init() != BSP_OK)
+    {
+        Error_Handler();
+    }
+    if (pwm_init() != BSP_OK)
+    {
+        Error_Handler();
+    }
+    gpiodi_init();
+
+    /* Flash writes chain their erase and program steps on this interrupt */
+    HAL_NVIC_SetPriority(FLASH_IRQn, FLASH_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(FLASH_IRQn);
+    /* The NMI is secure; it hands a flash ECC double error over here */
+    SECURE_RegisterCallback(FLASH_ECC_CB_ID, (void *)BSP_Flash_NMIHandler);
+#if BSP_SPINOR_ENABLE
+    if (spinor_init() != BSP_OK)
+    {
+        Error_Handler();
+    }
+#endif
+
+    /* The USB host port is initialized by BSP_USBH_Start(), off the boot
+     * path */
+    MX_ETH_Init();
+    ptp_time_init();
+
+    /* Initialize ADC filter subsystem */
+    BSP_ADC1_FilterInit();
+#if BSP_SPIADC_ENABLE
+    /* TIM8 must be armed before TIM1 starts it */
+    if (spiadc_init() != BSP_OK)
+    {
+        Error_Handler();
+    }
+#endif
+
+    HAL_TIM_OC_Start(&htim1, TIM_CHANNEL_1);
+    BSP_ADC1_Start();
+#if BSP_SPIADC_ENABLE
+    (void)BSP_SPIADC_Start();
+#endif
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          ADC1 Functions                                    */
+/*============================================================================*/
+
+bsp_error_t BSP_ADC1_Start(void)
+{
+    bsp_error_t         ret         = BSP_OK;
+    DMA_NodeConfTypeDef node_config = {0};
+
+    /* TIM1 triggers on the grid of the full profile */
+    clock_hold();
+
+    /* Check if already running */
+    if (adc1_running)
+    {
+        ret = BSP_BUSY;
+    }
+    else
+    {
+        /* Clear the conversion complete flag and any stale blocks */
+        adc1_conversion_complete = false;
+        adc1_latest_frame        = NULL;
+        g_filter_pending         = 0U;
+
+        /* Configure DMA node for ADC1 */
+        node_config.Init.Request         = GPDMA1_REQUEST_ADC1;
+        node_config.Init.BlkHWRequest    = DMA_BREQ_SINGLE_BURST;
+        node_config.Init.Direction       = DMA_PERIPH_TO_MEMORY;
+        node_config.Init.SrcInc          = DMA_SINC_FIXED;
+        node_config.Init.DestInc         = DMA_DINC_INCREMENTED;
+        node_config.Init.SrcBurstLength  = 1;
+        node_config.Init.DestBurstLength = 1;
+        node_config.Init.TransferAllocatedPort =
+            DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1;
+        node_config.Init.Mode                       = DMA_NORMAL;
+        node_config.DataHandlingConfig.DataExchange = DMA_EXCHANGE_NONE;
+        node_config.DataHandlingConfig.DataAlignment =
+            DMA_DATA_RIGHTALIGN_ZEROPADDED;
+        node_config.TriggerConfig.TriggerMode      = DMA_TRIGM_BLOCK_TRANSFER;
+        node_config.TriggerConfig.TriggerPolarity  = DMA_TRIG_POLARITY_MASKED;
+        node_config.TriggerConfig.TriggerSelection = 0;
+#if BSP_ADC1_DUAL_MODE
+        /* One packed pair per word, frames one after the other */
+        node_config.NodeType                      = DMA_GPDMA_LINEAR_NODE;
+        node_config.Init.SrcDataWidth             = DMA_SRC_DATAWIDTH_WORD;
+        node_config.Init.DestDataWidth            = DMA_DEST_DATAWIDTH_WORD;
+        node_config.Init.TransferEventMode        = DMA_TCEM_BLOCK_TRANSFER;
+        node_config.RepeatBlockConfig.RepeatCount = 1;
+        node_config.RepeatBlockConfig.DestAddrOffset    = 0;
+        node_config.RepeatBlockConfig.BlkDestAddrOffset = 0;
+        node_config.SrcAddress = (uint32_t)&ADC12_COMMON->CDR;
+        node_config.DataSize   = ADC1_DMA_LENGTH * sizeof(uint32_t);
+#else
+        /*
+         * One block per frame, repeated for every frame of both halves,
+         * each one ADC1 block long at the rate in force.
+         * After each result the destination moves on to the next plane;
+         * after the frame it goes back to the first plane, one sample on.
+         * HT and TC mark the halves of the repeated block.
+         */
+        node_config.NodeType           = DMA_GPDMA_2D_NODE;
+        node_config.Init.SrcDataWidth  = DMA_SRC_DATAWIDTH_HALFWORD;
+        node_config.Init.DestDataWidth = DMA_DEST_DATAWIDTH_HALFWORD;
+        node_config.Init.TransferEventMode =
+            DMA_TCEM_REPEATED_BLOCK_TRANSFER;
+        node_config.RepeatBlockConfig.RepeatCount =
+            ADC1_DMA_HALVES * adc1_block_samples;
+        node_config.RepeatBlockConfig.DestAddrOffset =
+            ADC1_PLANE_SIZE - (int32_t)sizeof(uint16_t);
+        node_config.RepeatBlockConfig.BlkDestAddrOffset =
+            -((int32_t)(BSP_ADC1_NUM_FAST_CHANNELS - 1U) * ADC1_PLANE_SIZE);
+        node_config.SrcAddress = (uint32_t)&ADC1->DR;
+        node_config.DataSize =
+            BSP_ADC1_NUM_FAST_CHANNELS * sizeof(uint16_t);
+#endif
+        node_config.RepeatBlockConfig.SrcAddrOffset    = 0;
+        node_config.RepeatBlockConfig.BlkSrcAddrOffset = 0;
+        node_config.DstAddress = (uint32_t)adc1_dma_buffer;
+
+        /* Build the DMA node from configuration */
+        if (HAL_DMAEx_List_BuildNode(&node_config, &adc1_dma_node) != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+    }
+
+    /* Reset the queue before use */
+    if (ret == BSP_OK)
+    {
+        if (HAL_DMAEx_List_ResetQ(&adc1_dma_list) != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+    }
+
+    /* Insert node into the queue */
+    if (ret == BSP_OK)
+    {
+        if (HAL_DMAEx_List_InsertNode_Tail(&adc1_dma_list,
+                                           &adc1_dma_node) != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+    }
+
+    /* Make the list circular for continuous conversion */
+    if (ret == BSP_OK)
+    {
+        if (HAL_DMAEx_List_SetCircularMode(&adc1_dma_list) != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+    }
+
+    /* Initialize the DMA handle for linked list mode */
+    if (ret == BSP_OK)
+    {
+        adc1_dma.Instance = ADC1_DMA_CHANNEL;
+        adc1_dma.InitLinkedList.Priority =
+            DMA_LOW_PRIORITY_LOW_WEIGHT;
+        adc1_dma.InitLinkedList.LinkStepMode =
+            DMA_LSM_FULL_EXECUTION;
+        adc1_dma.InitLinkedList.LinkAllocatedPort =
+            DMA_LINK_ALLOCATED_PORT0;
+        adc1_dma.InitLinkedList.TransferEventMode =
+            node_config.Init.TransferEventMode;
+        adc1_dma.InitLinkedList.LinkedListMode =
+            DMA_LINKEDLIST_CIRCULAR;
+
+        if (HAL_DMAEx_List_Init(&adc1_dma) != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+    }
+
+    /* Link the queue to the DMA handle */
+    if (ret == BSP_OK)
+    {
+        if (HAL_DMAEx_List_LinkQ(&adc1_dma,
+                                 &adc1_dma_list) != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+    }
+
+    /* Link DMA handle to ADC handle */
+    if (ret == BSP_OK)
+    {
+        __HAL_LINKDMA(&hadc1, DMA_Handle, adc1_dma);
+        HAL_NVIC_SetPriority(ADC1_DMA_IRQn, ADC1_DMA_IRQ_PRIORITY, 0);
+        HAL_NVIC_EnableIRQ(ADC1_DMA_IRQn);
+
+        /* Run ADC calibration */
+        if (adc1_calibrate() != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+    }
+
+    /* Start ADC with DMA */
+    if (ret == BSP_OK)
+    {
+        if (adc1_start_dma() != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+        else
+        {
+            adc1_running = true;
+        }
+    }
+
+    clock_release();
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_Stop(void)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (adc1_running)
+    {
+        /* Stop ADC DMA */
+        if (adc1_stop_dma() != HAL_OK)
+        {
+            ret = BSP_ERROR;
+        }
+        else
+        {
+            adc1_running             = false;
+            adc1_conversion_complete = false;
+        }
+    }
+    /* If not running, return BSP_OK (already stopped) */
+
+    return ret;
+}
+
+bool BSP_ADC1_IsConversionComplete(void)
+{
+    bool result = false;
+
+    if (adc1_running && adc1_conversion_complete)
+    {
+        /* Clear the flag so caller can detect next conversion */
+        adc1_conversion_complete = false;
+        result                   = true;
+    }
+
+    return result;
+}
+
+bsp_error_t BSP_ADC1_GetResults(const uint32_t **results)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (results == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!adc1_running || (adc1_latest_frame == NULL))
+    {
+        *results = NULL;
+        ret      = BSP_ERROR;
+    }
+    else
+    {
+        *results = adc1_latest_frame;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_GetResultsCopy(uint32_t *buffer)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (buffer == NULL)
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!adc1_running || (adc1_latest_frame == NULL))
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* Disable interrupts briefly to get consistent snapshot */
+        __disable_irq();
+        memcpy(buffer, (const void *)adc1_latest_frame,
+               BSP_ADC1_NUM_CHANNELS * sizeof(uint32_t));
+        __enable_irq();
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_ADC1_SampleNow(uint8_t channel, uint16_t *value)
+{
+    bsp_error_t       ret = BSP_OK;
+    HAL_StatusTypeDef status;
+
+    if ((channel >= BSP_ADC1_NUM_CHANNELS) || (value == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+    if (!adc1_running)
+    {
+        return BSP_ERROR;
+    }
+
+    /* Left over from a conversion that ended as the wait timed out */
+    (void)ulTaskNotifyTakeIndexed(BSP_ADC1_NOTIFY_INDEX, pdTRUE, 0U);
+
+    taskENTER_CRITICAL();
+    if (adc1_sampler != NULL)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_BUSY;
+    }
+    adc1_sampler = xTaskGetCurrentTaskHandle();
+    taskEXIT_CRITICAL();
+
+    /* The rank may change while no injected conversion is under way */
+    LL_ADC_INJ_SetSequencerRanks(hadc1.Instance, LL_ADC_INJ_RANK_1,
+                                 adc1_channels[channel]);
+    status = HAL_ADCEx_InjectedStart_IT(&hadc1);
+    if (status != HAL_OK)
+    {
+        ret = (status == HAL_BUSY) ? BSP_BUSY : BSP_ERROR;
+    }
+    else if (ulTaskNotifyTakeIndexed(
+                 BSP_ADC1_NOTIFY_INDEX, pdTRUE,
+                 pdMS_TO_TICKS(ADC1_SAMPLE_NOW_TIMEOUT_MS)) == 0U)
+    {
+        (void)HAL_ADCEx_InjectedStop_IT(&hadc1);
+        ret = BSP_TIMEOUT;
+    }
+    else
+    {
+        *value = adc1_sample_value;
+    }
+
+    taskENTER_CRITICAL();
+    adc1_sampler = NULL;
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+bool BSP_ADC1_HasError(void) { return adc1_error_occurred; }
+
+uint32_t BSP_ADC1_GetLastError(void) { return adc1_last_error; }
+
+bsp_error_t BSP_ADC1_Restart(void)
+{
+    bsp_error_t ret = BSP_OK;
+
+    /* Stop ADC if running */
+    if (adc1_running)
+    {
+        (void)adc1_stop_dma();
+        adc1_running = false;
+    }
+
+    /* Clear error flags */
+    adc1_error_occurred = false;
+    adc1_last_error     = 0;
+
+    /* De-initialize and re-initialize the DMA handle */
+    (void)HAL_DMAEx_List_DeInit(&adc1_dma);
+
+    /* Restart ADC */
+    ret = BSP_ADC1_Start();
+
+    return ret;
+}
+
+bool BSP_ADC1_CheckAndRestart(void)
+{
+    bool restarted = false;
+
+    if (adc1_error_occurred || !adc1_running)
+    {
+        if (BSP_ADC1_Restart() == BSP_OK)
+        {
+            restarted = true;
+        }
+    }
+
+    return restarted;
+}
+
+/*============================================================================*/
+/*                     Filtered ADC1 Functions (Continuous Mode)              */
+/*============================================================================*/
+
+/**
+ * @brief Take the input edges of a block off the timeline FIFO (filter
+ * task only)
+ * @param capture Capture time of the block's first frame
+ * @param last    Capture time of its last frame
+ * @return Edges in gpiodi_block_edges
+ *
+ * The timer count of an edge is extended to the capture time nearest the
+ * block, within half the timer's span. Edges after the last frame stay
+ * queued for the next block.
+ */
+static uint32_t gpiodi_take_block_edges(uint64_t capture, uint64_t last)
+{
+    const uint32_t base = (uint32_t)(capture % g_timebase_span);
+    uint32_t       head = gpiodi_stamp_head;
+    uint32_t       tail;
+    uint32_t       n = 0U;
+
+    __DMB();
+    tail = gpiodi_stamp_tail;
+
+    while ((tail != head) && (n < BSP_GPIODI_EDGE_FIFO_SIZE))
+    {
+        const gpiodi_stamp_t *stamp =
+            &gpiodi_stamps[tail & (BSP_GPIODI_EDGE_FIFO_SIZE - 1U)];
+        uint32_t ahead = (stamp->count >= base)
+                             ? (stamp->count - base)
+                             : (stamp->count + g_timebase_span - base);
+        uint64_t time;
+
+        if (ahead < (g_timebase_span / 2U))
+        {
+            time = capture + ahead;
+        }
+        else
+        {
+            /* Before the block, from the previous one or a gap */
+            ahead = g_timebase_span - ahead;
+            time  = (capture > ahead) ? (capture - ahead) : 0U;
+        }
+
+        if (time > last)
+        {
+            break;
+        }
+
+        gpiodi_block_edges[n].time    = time;
+        gpiodi_block_edges[n].channel = stamp->channel;
+        gpiodi_block_edges[n].rising  = stamp->rising;
+        n++;
+        tail++;
+    }
+
+    /* The slots are copied out before the interrupt may reuse them */
+    __DMB();
+    gpiodi_stamp_tail = tail;
+
+    return n;
+}
+
+/**
+ * @brief Filter one DMA half through the block pipeline
+ * @param half Index of the half to process (0 or 1)
+ *
+ * The half is handed to adc1_pipeline_filter_block() where the DMA wrote
+ * it, after the slow conversions queued since the previous block, with the
+ * input edges up to its last frame. The trigger instant comes from the
+ * capture timer, read in the callback next to the cycle counter, and can
+ * fall a tick after the interrupt entry; the conversion time is then taken
+ * as 0.
+ */
+static void adc1_filter_half(uint32_t half)
+{
+    adc1_pipeline_block_t block;
+#if BSP_ADC1_SLOW_CHANNELS
+    uint32_t slow_head = adc1_slow_head;
+#endif
+
+    adc1_invalidate_half(half);
+
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+#if BSP_ADC1_DUAL_MODE
+        /* The channel's half-word of the first frame, little-endian */
+        block.raw[ch] = (const uint16_t *)ADC1_FRAME(half, 0U) +
+                        (ADC1_RESULT_WORD(ch) * 2U) +
+                        (ADC1_RESULT_SHIFT(ch) / 16U);
+#else
+        block.raw[ch] = ADC1_IS_SLOW(ch) ? NULL : ADC1_HALF(ch, half);
+#endif
+    }
+    block.samples    = adc1_block_samples;
+    block.slot       = half * adc1_block_samples;
+    block.period     = g_trigger_period;
+    block.capture    = g_block_capture[half];
+    block.capture_ns = g_block_capture_ns[half];
+    block.ready      = g_block_isr_cycles[half];
+    block.callback   = g_block_callback_cycles[half];
+    block.conversion = block.ready - g_block_trigger_cycles[half];
+    if ((int32_t)block.conversion < 0)
+    {
+        block.conversion = 0U;
+    }
+    block.edges      = gpiodi_block_edges;
+    block.edge_count = gpiodi_take_block_edges(
+        block.capture,
+        block.capture + ((uint64_t)(block.samples - 1U) * block.period));
+    block.di_selected = gpiodi_selected;
+    block.di_level    = gpiodi_sample() & block.di_selected;
+
+#if BSP_ADC1_SLOW_CHANNELS
+    adc1_pipeline_filter_slow(
+        (const uint16_t(*)[BSP_ADC1_NUM_SLOW_CHANNELS])adc1_slow_ring,
+        adc1_slow_tail, slow_head - adc1_slow_tail);
+    adc1_slow_tail = slow_head;
+#endif
+
+    adc1_pipeline_filter_block(&block);
+}
+
+/**
+ * @brief Resume ADC1 after an overrun or DMA error (filter task only)
+ *
+ * Stops the conversions and the DMA channel and starts them again on the
+ * queue still linked to the channel, keeping the calibration: no node is
+ * rebuilt and nothing is re-initialized, so sampling resumes within
+ * microseconds. The partly filled half is dropped; its samples are part of
+ * the gap seen by the next block. Falls back to the full BSP_ADC1_Restart()
+ * if the DMA does not start again; if that fails too, the error stays set
+ * and the filter task retries.
+ */
+static void adc1_recover(void)
+{
+    bool resumed;
+
+    (void)adc1_stop_dma();
+    __HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_OVR);
+
+    taskENTER_CRITICAL();
+    adc1_error_occurred      = false;
+    adc1_conversion_complete = false;
+    adc1_latest_frame        = NULL;
+    g_filter_pending         = 0U;
+    taskEXIT_CRITICAL();
+
+    resumed = (adc1_start_dma() == HAL_OK);
+    if (resumed)
+    {
+        adc1_running = true;
+    }
+    else
+    {
+        resumed = (BSP_ADC1_Restart() == BSP_OK);
+    }
+
+    if (resumed)
+    {
+        g_adc1_recoveries++;
+
+        /* Restart the filters on the first samples after the gap */
+        adc1_pipeline_warm_all();
+    }
+    else
+    {
+        adc1_error_occurred = true;
+    }
+}
+
+/**
+ * @brief Move the acquisition to the requested sample rate (filter task
+ * only)
+ *
+ * Stops the conversions and the DMA, and moves TIM1 to the trigger period
+ * of the rate while it runs: with the counter at 0 the new auto-reload
+ * takes effect at once, and the capture timer it started keeps counting.
+ * The phase of the triggers in capture time is read back from both
+ * counters, as after a sync step. BSP_ADC1_Restart() then rebuilds the DMA
+ * node for the block of the rate, and adc1_pipeline_set_rate() moves the
+ * filters to it; they warm start on the first block after the gap. A
+ * stopped ADC1 stays stopped and starts at the rate. If the ADC does not
+ * start again the error stays set and adc1_recover() retries.
+ */
+static void adc1_apply_sample_rate(void)
+{
+    uint32_t                   hz  = adc1_rate_request;
+    const adc_filter_coeffs_t *set = adc_filter_coeffs_for_rate(hz);
+    uint32_t                   compare;
+    uint32_t                   period;
+    uint32_t                   primask;
+    uint32_t                   count;
+    uint32_t                   before;
+    uint32_t                   after;
+    bool                       running = adc1_running;
+
+    adc1_rate_request = 0U;
+    if ((set == NULL) || (hz == adc1_sample_rate))
+    {
+        return;
+    }
+    period  = BSP_ADC1_TIMESTAMP_HZ / hz;
+    compare = __HAL_TIM_GET_COMPARE(&htim1, TIM_CHANNEL_1);
+
+    if (running)
+    {
+        (void)adc1_stop_dma();
+        adc1_running = false;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    __HAL_TIM_SET_COUNTER(&htim1, 0U);
+    __HAL_TIM_SET_AUTORELOAD(&htim1, period - 1U);
+#if BSP_ADC1_SLOW_CHANNELS
+    adc1_set_slow_triggers(hz);
+#endif
+
+    /* Both counters run from one clock; retry if the capture timer ticked
+     * between the reads */
+    do
+    {
+        before = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+        count  = __HAL_TIM_GET_COUNTER(&htim1);
+        after  = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+    } while (before != after);
+
+    g_trigger_period = period;
+    g_trigger_phase  = ((before % period) + period - count + compare) % period;
+
+    __set_PRIMASK(primask);
+
+    adc1_sample_rate   = hz;
+    adc1_block_samples = BSP_ADC1_BLOCK_SAMPLES_AT(hz);
+    adc1_pipeline_set_rate(hz);
+
+    if (running && (BSP_ADC1_Restart() != BSP_OK))
+    {
+        adc1_error_occurred = true;
+    }
+}
+
+/**
+ * @brief Take the watchdog interrupts into the alarms and run the hook
+ * @param block_done A block was filtered since the last call: the alarms
+ * not raised again since the end of the previous block clear, and the
+ * watchdogs that fired are armed again
+ */
+static void adc1_awd_service(bool block_done)
+{
+    bsp_adc1_awd_hook_t hook   = adc1_awd_hook;
+    uint32_t            before = adc1_awd_active;
+    uint32_t            fired;
+    uint32_t            raised;
+    uint32_t            active;
+
+    taskENTER_CRITICAL();
+    fired          = adc1_awd_fired;
+    adc1_awd_fired = 0U;
+    taskEXIT_CRITICAL();
+
+    adc1_awd_seen |= fired;
+    raised = fired & ~before;
+    active = before | fired;
+
+    if (block_done)
+    {
+        active &= adc1_awd_seen;
+
+        taskENTER_CRITICAL();
+        for (uint8_t awd = 0U; awd < BSP_ADC1_AWD_COUNT; awd++)
+        {
+            if ((adc1_awd_seen & (1UL << awd)) != 0U)
+            {
+                ADC_HandleTypeDef *adc = adc1_awd_adc(adc1_awd_channels[awd]);
+
+                __HAL_ADC_CLEAR_FLAG(adc, adc1_awd_flags[awd]);
+                __HAL_ADC_ENABLE_IT(adc, adc1_awd_its[awd]);
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        adc1_awd_seen = 0U;
+    }
+
+    if (active == before)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint32_t bits = raised; bits != 0U; bits &= bits - 1U)
+    {
+        adc1_awd_raised++;
+    }
+    adc1_awd_active = active;
+    taskEXIT_CRITICAL();
+
+    if (hook != NULL)
+    {
+        hook(raised, active);
+    }
+}
+
+/**
+ * @brief Point the watchdogs at the channels last set for them
+ *
+ * The ADC only takes a new channel with no conversion under way, so a
+ * running acquisition is stopped around it as in adc1_recover(), and the
+ * filters restart on the first samples after the gap. A failed start is
+ * left to adc1_recover().
+ */
+static void adc1_awd_reassign_channels(void)
+{
+    bool running = adc1_running;
+
+    if (running)
+    {
+        (void)adc1_stop_dma();
+    }
+
+    taskENTER_CRITICAL();
+    adc1_awd_reassign = false;
+    for (uint8_t awd = 0U; awd < BSP_ADC1_AWD_COUNT; awd++)
+    {
+        adc1_awd_channels[awd] = adc1_awd_config[awd].channel;
+    }
+    if (running)
+    {
+        adc1_conversion_complete = false;
+        adc1_latest_frame        = NULL;
+        g_filter_pending         = 0U;
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t awd = 0U; awd < BSP_ADC1_AWD_COUNT; awd++)
+    {
+        adc1_awd_watch(awd);
+    }
+    adc1_awd_seen = 0U;
+
+    /* After a BSP_ADC1_SetWatchdog() that ran in between, too */
+    taskENTER_CRITICAL();
+    for (uint8_t awd = 0U; awd < BSP_ADC1_AWD_COUNT; awd++)
+    {
+        adc1_awd_write_window(awd);
+    }
+    taskEXIT_CRITICAL();
+
+    if (!running)
+    {
+        return;
+    }
+
+    if (adc1_start_dma() == HAL_OK)
+    {
+        adc1_pipeline_warm_all();
+    }
+    else
+    {
+        adc1_error_occurred = true;
+    }
+}
+
+#if BSP_ADC1_PROBE_PINS
+void adc1_probe_set(adc1_probe_pin_t pin, bool high)
+{
+    if (pin == ADC1_PROBE_PIN_FILTER)
+    {
+        if (high)
+        {
+            ADC1_PROBE_HIGH(FILTER);
+        }
+        else
+        {
+            ADC1_PROBE_LOW(FILTER);
+        }
+    }
+    else if (high)
+    {
+        ADC1_PROBE_HIGH(HOOK);
+    }
+    else
+    {
+        ADC1_PROBE_LOW(HOOK);
+    }
+}
+
+/**
+ * @brief Configure the probe pins of the sample path as outputs, low
+ */
+static void adc1_probe_init(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    __HAL_RCC_GPIOF_CLK_ENABLE();
+    __HAL_RCC_GPIOG_CLK_ENABLE();
+
+    gpio.Mode  = GPIO_MODE_OUTPUT_PP;
+    gpio.Pull  = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+
+    ADC1_PROBE_LOW(CALLBACK);
+    ADC1_PROBE_LOW(FILTER);
+    ADC1_PROBE_LOW(HOOK);
+
+    gpio.Pin = ADC1_PROBE_CALLBACK_PIN;
+    HAL_GPIO_Init(ADC1_PROBE_CALLBACK_PORT, &gpio);
+    gpio.Pin = ADC1_PROBE_FILTER_PIN;
+    HAL_GPIO_Init(ADC1_PROBE_FILTER_PORT, &gpio);
+    gpio.Pin = ADC1_PROBE_HOOK_PIN;
+    HAL_GPIO_Init(ADC1_PROBE_HOOK_PORT, &gpio);
+}
+#endif
+
+/**
+ * @brief ADC1 block filter task
+ * @param pvParameters Unused
+ *
+ * Sleeps until the DMA ISR hands over a completed half, then filters it.
+ * If both halves are pending the older one is processed first. An analog
+ * watchdog interrupt wakes it too, to run the watchdog hook at once. After
+ * an ADC1 error the task resumes the acquisition with adc1_recover().
+ */
+static void adc1_filter_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;)
+    {
+        uint32_t pending;
+        uint32_t last_half;
+
+        (void)ulTaskNotifyTake(pdTRUE,
+                               adc1_error_occurred
+                                   ? pdMS_TO_TICKS(ADC1_RECOVER_RETRY_MS)
+                                   : portMAX_DELAY);
+
+        taskENTER_CRITICAL();
+        pending          = g_filter_pending;
+        last_half        = g_filter_last_half;
+        g_filter_pending = 0U;
+        taskEXIT_CRITICAL();
+
+        if (pending == (ADC1_BLOCK_FIRST_HALF | ADC1_BLOCK_SECOND_HALF))
+        {
+            adc1_filter_half(1U - last_half);
+            adc1_filter_half(last_half);
+        }
+        else if (pending == ADC1_BLOCK_FIRST_HALF)
+        {
+            adc1_filter_half(0U);
+        }
+        else if (pending == ADC1_BLOCK_SECOND_HALF)
+        {
+            adc1_filter_half(1U);
+        }
+        else
+        {
+            /* Watchdog or spurious wake-up, nothing to filter */
+        }
+
+        adc1_awd_service(pending != 0U);
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+        if (adc1_sample_alarm)
+        {
+            adc1_sample_alarm = false;
+            adc1_pipeline_sample_alarm();
+        }
+#endif
+        if (adc1_awd_reassign)
+        {
+            adc1_awd_reassign_channels();
+        }
+
+        if (adc1_rate_request != 0U)
+        {
+            adc1_apply_sample_rate();
+        }
+
+        if (adc1_error_occurred)
+        {
+            adc1_recover();
+        }
+    }
+}
+
+void BSP_ADC1_FilterInit(void)
+{
+    if (!g_filter_initialized)
+    {
+        /* Filters, calibration and counters */
+        adc1_pipeline_init();
+#if BSP_ADC1_SLOW_CHANNELS
+        adc1_slow_tail     = adc1_slow_head;
+        adc1_slow_overruns = 0U;
+#endif
+
+        g_filter_pending = 0U;
+        adc1_awd_active  = 0U;
+        adc1_awd_raised  = 0U;
+
+#if BSP_ADC1_PROBE_PINS
+        adc1_probe_init();
+#endif
+
+        /* Start the block filter task - the DMA ISR only wakes it */
+        g_filter_task = xTaskCreateStatic(
+            adc1_filter_task, "AdcFilter", ADC1_FILTER_TASK_STACK_SIZE, NULL,
+            ADC1_FILTER_TASK_PRIORITY, g_filter_task_stack, &g_filter_task_tcb);
+
+        /* Mark as initialized - filtered values are now maintained */
+        g_filter_initialized = (g_filter_task != NULL);
+    }
+}
+
+bsp_error_t BSP_ADC1_SetWatchdog(uint8_t                      awd,
+                                 const bsp_adc1_awd_config_t *config)
+{
+    bool reassign;
+
+    if ((awd >= BSP_ADC1_AWD_COUNT) || (config == NULL) ||
+        (config->channel >= BSP_ADC1_NUM_CHANNELS) ||
+        (config->low > config->high))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    reassign = adc1_awd_reassign ||
+               (config->channel != adc1_awd_channels[awd]);
+    adc1_awd_config[awd] = *config;
+    adc1_awd_reassign    = reassign;
+    if (!reassign)
+    {
+        adc1_awd_write_window(awd);
+    }
+    taskEXIT_CRITICAL();
+
+    /* Otherwise the task reassigns at its first wake-up */
+    if (reassign && (g_filter_task != NULL))
+    {
+        xTaskNotifyGive(g_filter_task);
+    }
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_ADC1_GetWatchdogStatus(bsp_adc1_awd_status_t *status)
+{
+    if (status == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    status->active = adc1_awd_active;
+    status->raised = adc1_awd_raised;
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+void BSP_ADC1_SetWatchdogHook(bsp_adc1_awd_hook_t hook)
+{
+    adc1_awd_hook = hook;
+}
+
+bsp_error_t BSP_ADC1_SetSampleRate(uint32_t hz)
+{
+    bsp_error_t ret = BSP_OK;
+
+#if BSP_SPIADC_ENABLE
+    /* TIM8 frames the SPI ADC on TIM1's trigger grid */
+    (void)hz;
+    ret = BSP_ERROR;
+#else
+    /* The sequence must end before the next trigger */
+    if ((adc_filter_coeffs_for_rate(hz) == NULL) ||
+        ((BSP_ADC1_TIMESTAMP_HZ % hz) != 0U) ||
+        (BSP_ADC1_SEQUENCE_NS >= (1000000000UL / hz)))
+    {
+        ret = BSP_INVALID_ARG;
+    }
+    else if (!g_filter_initialized)
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        adc1_rate_request = hz;
+        xTaskNotifyGive(g_filter_task);
+    }
+#endif
+
+    return ret;
+}
+
+uint32_t BSP_ADC1_GetSampleRate(void) { return adc1_sample_rate; }
+
+uint32_t BSP_ADC1_GetBlockSamples(void) { return adc1_block_samples; }
+
+#if BSP_ADC1_SYNC
+void BSP_ADC1_SetTriggerSync(bool enable)
+{
+    g_sync_enabled = enable;
+}
+
+bool BSP_ADC1_IsTriggerSynced(void)
+{
+    return g_sync_enabled && g_sync_aligned;
+}
+#endif /* BSP_ADC1_SYNC */
+
+/**
+ * @brief Clock I2C3 from HSI, after MX_I2C3_Init()
+ * @return BSP_OK, or BSP_ERROR if the kernel clock cannot be selected
+ *
+ * The generated MSP code selects PCLK3, which the idle clock profile
+ * divides; from HSI the SCL rate stays at 100 kHz in both profiles.
+ */
+static bsp_error_t i2cdo_clock_init(void)
+{
+    RCC_PeriphCLKInitTypeDef clk = {0};
+
+    clk.PeriphClockSelection = RCC_PERIPHCLK_I2C3;
+    clk.I2c3ClockSelection   = RCC_I2C3CLKSOURCE_HSI;
+
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    /* Initialized already, so the MSP code does not run again */
+    hi2c3.Init.Timing = I2CDO_TIMING_HSI_100KHZ;
+
+    return (HAL_I2C_Init(&hi2c3) == HAL_OK) ? BSP_OK : BSP_ERROR;
+}
+
+bsp_error_t BSP_I2CDO_init(const uint8_t *addresses, uint8_t count)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if ((addresses == NULL) || (count == 0U) ||
+        (count > BSP_I2CDO_MAX_EXPANDERS))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    for (uint8_t n = 0U; n < count; n++)
+    {
+        /* 7-bit addresses outside the reserved ones */
+        if ((addresses[n] < 0x08U) || (addresses[n] > 0x77U))
+        {
+            return BSP_INVALID_ARG;
+        }
+        i2cdo_addresses[n] = (uint16_t)((uint16_t)addresses[n] << 1U);
+    }
+
+    i2cdo_count   = count;
+    i2cdo_outputs = (count == BSP_I2CDO_MAX_EXPANDERS)
+                        ? 0xFFFFFFFFU
+                        : ((1UL << (8U * count)) - 1U);
+    i2cdo_known   = false;
+
+    MX_I2C3_Init();
+    ret = i2cdo_clock_init();
+    if (ret != BSP_OK)
+    {
+        return ret;
+    }
+
+    // Set initial state to all low and write to expanders
+    ret = BSP_I2CDO_Write(0x0000U);
+
+    return ret;
+}
+
+uint32_t BSP_I2CDO_GetCount(void) { return 8U * (uint32_t)i2cdo_count; }
+
+/**
+ * @brief Apply the outputs held by BSP_I2CDO_Force() to an output image
+ *
+ * @param value Output image.
+ * @return uint32_t @p value with the held outputs in their forced states,
+ *         cut to the outputs of the expanders.
+ */
+static uint32_t i2cdo_apply_force(uint32_t value)
+{
+    uint32_t mask;
+    uint32_t force;
+
+    taskENTER_CRITICAL();
+    mask  = i2cdo_force_mask;
+    force = i2cdo_force_value;
+    taskEXIT_CRITICAL();
+
+    return ((value & ~mask) | force) & i2cdo_outputs;
+}
+
+/**
+ * @brief Select the expanders an output image changes
+ *
+ * @param value Output image to write.
+ * @return uint8_t Bit n set if expander n has to be written: its byte
+ *         differs from the committed image, or that image is not known.
+ */
+static uint8_t i2cdo_changed(uint32_t value)
+{
+    const uint32_t diff    = value ^ i2cdo_committed;
+    uint8_t        changed = 0U;
+
+    for (uint8_t n = 0U; n < i2cdo_count; n++)
+    {
+        if (!i2cdo_known || (((diff >> (8U * n)) & 0xFFU) != 0U))
+        {
+            changed |= (uint8_t)(1U << n);
+        }
+    }
+
+    return changed;
+}
+
+/**
+ * @brief Convert a blocking HAL I2C result
+ */
+static bsp_error_t i2cdo_status(HAL_StatusTypeDef status)
+{
+    if (status == HAL_OK)
+    {
+        return BSP_OK;
+    }
+
+    return (status == HAL_TIMEOUT) ? BSP_TIMEOUT : BSP_ERROR;
+}
+
+bsp_error_t BSP_I2CDO_Write(uint32_t value)
+{
+    uint8_t     output_byte;
+    uint8_t     changed;
+    bsp_error_t ret = BSP_OK;
+
+    if (i2cdo_count == 0U)
+    {
+        return BSP_ERROR;
+    }
+    if (i2cdo_active != NULL)
+    {
+        return BSP_BUSY;
+    }
+
+    value   = i2cdo_apply_force(value);
+    changed = i2cdo_changed(value);
+
+    for (uint8_t n = 0U; (n < i2cdo_count) && (ret == BSP_OK); n++)
+    {
+        if ((changed & (1U << n)) != 0U)
+        {
+            output_byte = (uint8_t)((value >> (8U * n)) & 0xFFU);
+            ret         = i2cdo_status(
+                HAL_I2C_Master_Transmit(&hi2c3, i2cdo_addresses[n],
+                                        &output_byte, 1, BSP_I2CDO_TIMEOUT));
+        }
+    }
+
+    if (ret == BSP_OK)
+    {
+        i2cdo_shadow    = value;
+        i2cdo_committed = value;
+        i2cdo_known     = true;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_I2CDO_Read(uint32_t *value)
+{
+    uint8_t     read_byte;
+    uint32_t    image = 0U;
+    bsp_error_t ret   = BSP_OK;
+
+    if (value == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+    if (i2cdo_count == 0U)
+    {
+        return BSP_ERROR;
+    }
+
+    for (uint8_t n = 0U; (n < i2cdo_count) && (ret == BSP_OK); n++)
+    {
+        ret = i2cdo_status(HAL_I2C_Master_Receive(&hi2c3, i2cdo_addresses[n],
+                                                  &read_byte, 1,
+                                                  BSP_I2CDO_TIMEOUT));
+        image |= (uint32_t)read_byte << (8U * n);
+    }
+
+    if (ret == BSP_OK)
+    {
+        *value = image;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_I2CDO_WriteAsync(uint32_t value, bsp_i2cdo_xfer_t *xfer)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (xfer == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+    if (i2cdo_count == 0U)
+    {
+        return BSP_ERROR;
+    }
+
+    taskENTER_CRITICAL();
+    if (i2cdo_active != NULL)
+    {
+        ret = BSP_BUSY;
+    }
+    else
+    {
+        i2cdo_active = xfer;
+    }
+    taskEXIT_CRITICAL();
+
+    if (ret == BSP_OK)
+    {
+        value         = i2cdo_apply_force(value);
+        xfer->value   = value;
+        xfer->pending = i2cdo_changed(value);
+        xfer->status  = BSP_BUSY;
+        xfer->waiter  = xTaskGetCurrentTaskHandle();
+        i2cdo_shadow  = value;
+        for (uint8_t n = 0U; n < i2cdo_count; n++)
+        {
+            xfer->bytes[n] = (uint8_t)((value >> (8U * n)) & 0xFFU);
+        }
+
+        if (xfer->pending == 0U)
+        {
+            /* The expanders already hold every byte */
+            i2cdo_committed = value;
+            i2cdo_active    = NULL;
+            xfer->status    = BSP_OK;
+            return BSP_OK;
+        }
+
+        (void)xTaskNotifyStateClearIndexed(NULL, BSP_I2CDO_NOTIFY_INDEX);
+
+        if (i2cdo_transmit_next(xfer) != HAL_OK)
+        {
+            xfer->status = BSP_ERROR;
+            i2cdo_active = NULL;
+            ret          = BSP_ERROR;
+        }
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_I2CDO_CommitAsync(bsp_i2cdo_xfer_t *xfer)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (xfer == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    if (i2cdo_shadow != i2cdo_committed)
+    {
+        ret = BSP_I2CDO_WriteAsync(i2cdo_shadow, xfer);
+    }
+    else
+    {
+        xfer->status = BSP_OK;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_I2CDO_Wait(bsp_i2cdo_xfer_t *xfer, uint32_t timeout_ms)
+{
+    bsp_error_t ret;
+
+    if (xfer == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    if (xfer->status == BSP_BUSY)
+    {
+        (void)ulTaskNotifyTakeIndexed(BSP_I2CDO_NOTIFY_INDEX, pdTRUE,
+                                      pdMS_TO_TICKS(timeout_ms));
+    }
+
+    ret = xfer->status;
+    if (ret == BSP_BUSY)
+    {
+        ret = BSP_TIMEOUT;
+    }
+
+    return ret;
+}
+
+bool BSP_I2CDO_IsDone(const bsp_i2cdo_xfer_t *xfer)
+{
+    return (xfer == NULL) || (xfer->status != BSP_BUSY);
+}
+
+bsp_error_t BSP_I2CDO_Stage(uint32_t mask, uint32_t value)
+{
+    taskENTER_CRITICAL();
+    i2cdo_shadow =
+        i2cdo_apply_force((i2cdo_shadow & ~mask) | (value & mask));
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+void BSP_I2CDO_Force(uint32_t mask, uint32_t value)
+{
+    taskENTER_CRITICAL();
+    i2cdo_force_mask  = mask;
+    i2cdo_force_value = value & mask;
+    i2cdo_shadow      = i2cdo_apply_force(i2cdo_shadow);
+    taskEXIT_CRITICAL();
+}
+
+bsp_error_t BSP_I2CDO_Commit(void)
+{
+    bsp_error_t ret = BSP_OK;
+
+    if (i2cdo_shadow != i2cdo_committed)
+    {
+        ret = BSP_I2CDO_Write(i2cdo_shadow);
+    }
+
+    return ret;
+}
+
+void BSP_I2CDO_Discard(void)
+{
+    taskENTER_CRITICAL();
+    i2cdo_shadow = i2cdo_apply_force(i2cdo_committed);
+    taskEXIT_CRITICAL();
+}
+
+uint32_t BSP_I2CDO_GetShadow(void) { return i2cdo_shadow; }
+
+uint32_t BSP_I2CDO_GetCommitted(void) { return i2cdo_committed; }
+
+bsp_error_t BSP_I2CDO_Verify(void)
+{
+    uint32_t    readback = 0U;
+    bsp_error_t ret      = BSP_I2CDO_Read(&readback);
+
+    if ((ret == BSP_OK) && (readback != i2cdo_committed))
+    {
+        ret = BSP_ERROR;
+    }
+
+    return ret;
+}
+
+bsp_error_t BSP_GPIODI_Read(uint32_t channel, uint32_t *pVal)
+{
+    if ((channel >= BSP_GPIODI_COUNT) || (NULL == pVal))
+    {
+        return BSP_ERROR;
+    }
+
+    *pVal = (uint32_t)HAL_GPIO_ReadPin(gpiodi_inputs[channel].port,
+                                       gpiodi_inputs[channel].pin);
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_GPIODI_ReadAll(uint8_t *pBits)
+{
+    if (NULL == pBits)
+    {
+        return BSP_ERROR;
+    }
+
+    /* No samples while the tick was suppressed: the filter restarts from
+     * the pins */
+    taskENTER_CRITICAL();
+    if ((xTaskGetTickCount() - gpiodi_sample_tick) >
+        BSP_GPIODI_DEBOUNCE_TICKS)
+    {
+        gpiodi_debounced   = gpiodi_sample();
+        gpiodi_count0      = 0U;
+        gpiodi_count1      = 0U;
+        gpiodi_sample_tick = xTaskGetTickCount();
+    }
+    *pBits = gpiodi_debounced;
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+void BSP_GPIODI_DebounceTick(void)
+{
+    uint8_t delta = gpiodi_sample() ^ gpiodi_debounced;
+
+    /* Count differing inputs 1, 2, 3, 0; a difference that goes away
+     * clears its count */
+    gpiodi_count1 = (gpiodi_count1 ^ gpiodi_count0) & delta;
+    gpiodi_count0 = (uint8_t)~gpiodi_count0 & delta;
+
+    /* Inputs whose count wrapped to 0 have differed for four samples */
+    gpiodi_debounced ^= delta & (uint8_t)~(gpiodi_count0 | gpiodi_count1);
+    gpiodi_sample_tick = xTaskGetTickCountFromISR();
+}
+
+uint8_t BSP_GetDeviceAddress(void)
+{
+    uint8_t address = 0U;
+
+    /*
+     * Read DEVADDR pins - they have internal pull-ups, so:
+     * - Open/floating pin reads HIGH (GPIO_PIN_SET) -> bit = 0
+     * - Grounded pin reads LOW (GPIO_PIN_RESET) -> bit = 1
+     *
+     * This allows setting address by grounding pins (active-low logic).
+     */
+
+    /* DEVADDR0 - Bit 0 */
+    if (HAL_GPIO_ReadPin(DEVADDR0_GPIO_Port, DEVADDR0_Pin) == GPIO_PIN_RESET)
+    {
+        address |= (1U << 0U);
+    }
+
+    /* DEVADDR1 - Bit 1 */
+    if (HAL_GPIO_ReadPin(DEVADDR1_GPIO_Port, DEVADDR1_Pin) == GPIO_PIN_RESET)
+    {
+        address |= (1U << 1U);
+    }
+
+    /* DEVADDR2 - Bit 2 */
+    if (HAL_GPIO_ReadPin(DEVADDR2_GPIO_Port, DEVADDR2_Pin) == GPIO_PIN_RESET)
+    {
+        address |= (1U << 2U);
+    }
+
+    /* DEVADDR3 - Bit 3 */
+    if (HAL_GPIO_ReadPin(DEVADDR3_GPIO_Port, DEVADDR3_Pin) == GPIO_PIN_RESET)
+    {
+        address |= (1U << 3U);
+    }
+
+    return address;
+}
+
+/*============================================================================*/
+/*                          RS-485 Functions                                  */
+/*============================================================================*/
+
+/**
+ * @brief Enable the USART2 clocks and pins and its interrupts
+ * @return BSP_OK, or BSP_ERROR if the kernel clock cannot be selected
+ */
+static bsp_error_t rs485_msp_init(void)
+{
+    GPIO_InitTypeDef         gpio = {0};
+    RCC_PeriphCLKInitTypeDef clk  = {0};
+
+    clk.PeriphClockSelection = RCC_PERIPHCLK_USART2;
+    clk.Usart2ClockSelection = RCC_USART2CLKSOURCE_HSI;
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    __HAL_RCC_USART2_CLK_ENABLE();
+    __HAL_RCC_GPIOD_CLK_ENABLE();
+
+    /* PD4 USART2_DE, PD5 USART2_TX, PD6 USART2_RX */
+    gpio.Pin       = GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_6;
+    gpio.Mode      = GPIO_MODE_AF_PP;
+    gpio.Pull      = GPIO_NOPULL;
+    gpio.Speed     = GPIO_SPEED_FREQ_LOW;
+    gpio.Alternate = GPIO_AF7_USART2;
+    HAL_GPIO_Init(GPIOD, &gpio);
+
+    HAL_NVIC_SetPriority(USART2_IRQn, RS485_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
+    HAL_NVIC_SetPriority(GPDMA1_Channel1_IRQn, RS485_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel1_IRQn);
+    HAL_NVIC_SetPriority(GPDMA1_Channel2_IRQn, RS485_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel2_IRQn);
+
+    return BSP_OK;
+}
+
+/**
+ * @brief Set up the circular receive and the normal transmit DMA channels
+ * @return BSP_OK, or BSP_ERROR if a DMA call fails
+ */
+static bsp_error_t rs485_dma_init(void)
+{
+    DMA_NodeConfTypeDef node_config = {0};
+
+    /* Receive: one circular node over the whole ring */
+    node_config.NodeType             = DMA_GPDMA_LINEAR_NODE;
+    node_config.Init.Request         = GPDMA1_REQUEST_USART2_RX;
+    node_config.Init.BlkHWRequest    = DMA_BREQ_SINGLE_BURST;
+    node_config.Init.Direction       = DMA_PERIPH_TO_MEMORY;
+    node_config.Init.SrcInc          = DMA_SINC_FIXED;
+    node_config.Init.DestInc         = DMA_DINC_INCREMENTED;
+    node_config.Init.SrcDataWidth    = DMA_SRC_DATAWIDTH_BYTE;
+    node_config.Init.DestDataWidth   = DMA_DEST_DATAWIDTH_BYTE;
+    node_config.Init.SrcBurstLength  = 1;
+    node_config.Init.DestBurstLength = 1;
+    node_config.Init.TransferAllocatedPort =
+        DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1;
+    node_config.Init.TransferEventMode          = DMA_TCEM_BLOCK_TRANSFER;
+    node_config.Init.Mode                       = DMA_NORMAL;
+    node_config.DataHandlingConfig.DataExchange = DMA_EXCHANGE_NONE;
+    node_config.DataHandlingConfig.DataAlignment =
+        DMA_DATA_RIGHTALIGN_ZEROPADDED;
+    node_config.TriggerConfig.TriggerPolarity = DMA_TRIG_POLARITY_MASKED;
+    node_config.SrcAddress = (uint32_t)&USART2->RDR;
+    node_config.DstAddress = (uint32_t)rs485_rx_ring;
+    node_config.DataSize   = BSP_RS485_RX_RING_SIZE;
+
+    if ((HAL_DMAEx_List_BuildNode(&node_config, &rs485_rx_node) != HAL_OK) ||
+        (HAL_DMAEx_List_ResetQ(&rs485_rx_list) != HAL_OK) ||
+        (HAL_DMAEx_List_InsertNode_Tail(&rs485_rx_list, &rs485_rx_node) !=
+         HAL_OK) ||
+        (HAL_DMAEx_List_SetCircularMode(&rs485_rx_list) != HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+
+    rs485_dma_rx.Instance                         = GPDMA1_Channel1;
+    rs485_dma_rx.InitLinkedList.Priority          = DMA_HIGH_PRIORITY;
+    rs485_dma_rx.InitLinkedList.LinkStepMode      = DMA_LSM_FULL_EXECUTION;
+    rs485_dma_rx.InitLinkedList.LinkAllocatedPort = DMA_LINK_ALLOCATED_PORT0;
+    rs485_dma_rx.InitLinkedList.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+    rs485_dma_rx.InitLinkedList.LinkedListMode    = DMA_LINKEDLIST_CIRCULAR;
+
+    if ((HAL_DMAEx_List_Init(&rs485_dma_rx) != HAL_OK) ||
+        (HAL_DMAEx_List_LinkQ(&rs485_dma_rx, &rs485_rx_list) != HAL_OK) ||
+        (HAL_DMA_ConfigChannelAttributes(&rs485_dma_rx, DMA_CHANNEL_PRIV) !=
+         HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+    __HAL_LINKDMA(&rs485_uart, hdmarx, rs485_dma_rx);
+
+    /* Transmit: one block per frame */
+    rs485_dma_tx.Instance                   = GPDMA1_Channel2;
+    rs485_dma_tx.Init.Request               = GPDMA1_REQUEST_USART2_TX;
+    rs485_dma_tx.Init.BlkHWRequest          = DMA_BREQ_SINGLE_BURST;
+    rs485_dma_tx.Init.Direction             = DMA_MEMORY_TO_PERIPH;
+    rs485_dma_tx.Init.SrcInc                = DMA_SINC_INCREMENTED;
+    rs485_dma_tx.Init.DestInc               = DMA_DINC_FIXED;
+    rs485_dma_tx.Init.SrcDataWidth          = DMA_SRC_DATAWIDTH_BYTE;
+    rs485_dma_tx.Init.DestDataWidth         = DMA_DEST_DATAWIDTH_BYTE;
+    rs485_dma_tx.Init.Priority              = DMA_LOW_PRIORITY_HIGH_WEIGHT;
+    rs485_dma_tx.Init.SrcBurstLength        = 1;
+    rs485_dma_tx.Init.DestBurstLength       = 1;
+    rs485_dma_tx.Init.TransferAllocatedPort =
+        DMA_SRC_ALLOCATED_PORT1 | DMA_DEST_ALLOCATED_PORT0;
+    rs485_dma_tx.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+    rs485_dma_tx.Init.Mode              = DMA_NORMAL;
+
+    if ((HAL_DMA_Init(&rs485_dma_tx) != HAL_OK) ||
+        (HAL_DMA_ConfigChannelAttributes(&rs485_dma_tx, DMA_CHANNEL_PRIV) !=
+         HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+    __HAL_LINKDMA(&rs485_uart, hdmatx, rs485_dma_tx);
+
+    return BSP_OK;
+}
+
+/**
+ * @brief Block the owner until the next port event or the deadline
+ * @param timeout   Wait start, from vTaskSetTimeOutState()
+ * @param remaining Ticks left, updated
+ * @return false once the deadline has passed
+ *
+ * Events only wake the owner; the caller rechecks its own condition.
+ */
+static bool rs485_wait(TimeOut_t *timeout, TickType_t *remaining)
+{
+    if (xTaskCheckForTimeOut(timeout, remaining) != pdFALSE)
+    {
+        return false;
+    }
+
+    (void)ulTaskNotifyTakeIndexed(BSP_RS485_NOTIFY_INDEX, pdTRUE, *remaining);
+
+    return true;
+}
+
+/**
+ * @brief DE time covering a transceiver delay, in sample times
+ * @param baudrate Bit rate in bits per second
+ * @param delay_ns Transceiver delay in nanoseconds
+ * @return Sample times, rounded up and limited to what the USART counts
+ *
+ * The assertion time delays the start bit and the deassertion time holds
+ * the bus after the stop bit, so both are turnaround: a fixed bit time
+ * would cost 104 us at 9600 baud for a delay of about a microsecond.
+ */
+static uint32_t rs485_de_samples(uint32_t baudrate, uint32_t delay_ns)
+{
+    uint64_t samples =
+        (((uint64_t)delay_ns * baudrate * RS485_SAMPLES_PER_BIT) +
+         999999999U) /
+        1000000000U;
+
+    return (samples > RS485_DE_TIME_MAX) ? RS485_DE_TIME_MAX
+                                         : (uint32_t)samples;
+}
+
+bsp_error_t BSP_RS485_Init(const bsp_rs485_config_t *config)
+{
+    uint64_t rto_bits;
+
+    if ((config == NULL) || (config->baudrate == 0U) ||
+        (config->parity > BSP_RS485_PARITY_ODD))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* The receiver timeout counts bit times after the last stop bit */
+    rto_bits = (((uint64_t)config->frame_timeout_us * config->baudrate) +
+                999999U) /
+               1000000U;
+    if ((rto_bits == 0U) || (rto_bits > RS485_RTO_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    if (rs485_owner != NULL)
+    {
+        return BSP_BUSY;
+    }
+
+    (void)memset(&rs485_stats, 0, sizeof(rs485_stats));
+    rs485_frame_head = 0U;
+    rs485_frame_tail = 0U;
+    rs485_tx_done    = true;
+    rs485_owner      = xTaskGetCurrentTaskHandle();
+
+    if (rs485_msp_init() != BSP_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    /* Modbus RTU characters are 11 bits: parity or a second stop bit */
+    rs485_uart.Instance          = USART2;
+    rs485_uart.Init.BaudRate     = config->baudrate;
+    rs485_uart.Init.WordLength   = UART_WORDLENGTH_9B;
+    rs485_uart.Init.StopBits     = UART_STOPBITS_1;
+    rs485_uart.Init.Mode         = UART_MODE_TX_RX;
+    rs485_uart.Init.HwFlowCtl    = UART_HWCONTROL_NONE;
+    rs485_uart.Init.OverSampling = UART_OVERSAMPLING_16;
+    rs485_uart.Init.OneBitSampling = UART_ONE_BIT_SAMPLE_DISABLE;
+    rs485_uart.Init.ClockPrescaler = UART_PRESCALER_DIV1;
+    rs485_uart.AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
+    rs485_uart.FifoMode                    = UART_FIFOMODE_DISABLE;
+
+    switch (config->parity)
+    {
+        case BSP_RS485_PARITY_EVEN:
+            rs485_uart.Init.Parity = UART_PARITY_EVEN;
+            break;
+        case BSP_RS485_PARITY_ODD:
+            rs485_uart.Init.Parity = UART_PARITY_ODD;
+            break;
+        default:
+            rs485_uart.Init.WordLength = UART_WORDLENGTH_8B;
+            rs485_uart.Init.StopBits   = UART_STOPBITS_2;
+            rs485_uart.Init.Parity     = UART_PARITY_NONE;
+            break;
+    }
+
+    if (HAL_RS485Ex_Init(
+            &rs485_uart, UART_DE_POLARITY_HIGH,
+            rs485_de_samples(config->baudrate, RS485_DE_ASSERT_NS),
+            rs485_de_samples(config->baudrate, RS485_DE_DEASSERT_NS)) !=
+        HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    HAL_UART_ReceiverTimeout_Config(&rs485_uart, (uint32_t)rto_bits);
+    if ((HAL_UART_EnableReceiverTimeout(&rs485_uart) != HAL_OK) ||
+        (rs485_dma_init() != BSP_OK) || (rs485_start_rx() != HAL_OK))
+    {
+        return BSP_ERROR;
+    }
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_RS485_ReadFrame(uint8_t *frame, uint16_t size,
+                                uint16_t *length, uint32_t timeout_ms)
+{
+    TimeOut_t            timeout;
+    TickType_t           remaining = pdMS_TO_TICKS(timeout_ms);
+    const rs485_frame_t *queued;
+    uint32_t             first;
+    bsp_error_t          ret = BSP_OK;
+
+    if ((frame == NULL) || (length == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    *length = 0U;
+    vTaskSetTimeOutState(&timeout);
+    while (rs485_frame_tail == rs485_frame_head)
+    {
+        if (!rs485_wait(&timeout, &remaining))
+        {
+            return BSP_TIMEOUT;
+        }
+    }
+
+    queued = &rs485_frames[rs485_frame_tail & (RS485_FRAME_QUEUE_SIZE - 1U)];
+    if (queued->error || (queued->length > size))
+    {
+        ret = BSP_ERROR;
+    }
+    else
+    {
+        /* At most two copies, the second one if the frame wraps the ring */
+        first = BSP_RS485_RX_RING_SIZE - queued->start;
+        if (first > queued->length)
+        {
+            first = queued->length;
+        }
+        BSP_Cache_InvalidateRange(&rs485_rx_ring[queued->start], first);
+        BSP_Cache_InvalidateRange(rs485_rx_ring, queued->length - first);
+        (void)memcpy(frame, &rs485_rx_ring[queued->start], first);
+        (void)memcpy(&frame[first], rs485_rx_ring, queued->length - first);
+        *length = queued->length;
+    }
+
+    rs485_frame_tail++;
+
+    return ret;
+}
+
+bsp_error_t BSP_RS485_Transmit(const uint8_t *data, uint16_t length,
+                               uint32_t timeout_ms)
+{
+    TimeOut_t         timeout;
+    TickType_t        remaining = pdMS_TO_TICKS(timeout_ms);
+    HAL_StatusTypeDef status;
+
+    if ((data == NULL) || (length == 0U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    rs485_tx_done  = false;
+    rs485_tx_error = false;
+
+    BSP_Cache_CleanRange(data, length);
+    status = HAL_UART_Transmit_DMA(&rs485_uart, data, length);
+    if (status != HAL_OK)
+    {
+        rs485_tx_done = true;
+        return (status == HAL_BUSY) ? BSP_BUSY : BSP_ERROR;
+    }
+
+    vTaskSetTimeOutState(&timeout);
+    while (!rs485_tx_done)
+    {
+        if (!rs485_wait(&timeout, &remaining))
+        {
+            (void)HAL_UART_AbortTransmit(&rs485_uart);
+            rs485_tx_done = true;
+            return BSP_TIMEOUT;
+        }
+    }
+
+    if (rs485_tx_error)
+    {
+        return BSP_ERROR;
+    }
+
+    rs485_stats.tx_frames++;
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_RS485_GetStats(bsp_rs485_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    *stats = rs485_stats;
+
+    return BSP_OK;
+}
+
+void BSP_RS485_IRQHandler(void)
+{
+    uint32_t isr = rs485_uart.Instance->ISR;
+
+    /* Character errors only mark the frame; the HAL would stop the DMA */
+    if ((isr & RS485_RX_ERROR_FLAGS) != 0U)
+    {
+        rs485_rx_error = true;
+        __HAL_UART_CLEAR_FLAG(&rs485_uart, UART_CLEAR_PEF | UART_CLEAR_FEF |
+                                               UART_CLEAR_NEF |
+                                               UART_CLEAR_OREF);
+    }
+
+    /* t3.5 of silence: everything since the last timeout is one frame */
+    if ((isr & USART_ISR_RTOF) != 0U)
+    {
+        __HAL_UART_CLEAR_FLAG(&rs485_uart, UART_CLEAR_RTOF);
+        rs485_queue_frame_from_isr();
+    }
+
+    HAL_UART_IRQHandler(&rs485_uart);
+}
+
+void BSP_RS485_RxDMA_IRQHandler(void) { HAL_DMA_IRQHandler(&rs485_dma_rx); }
+
+void BSP_RS485_TxDMA_IRQHandler(void) { HAL_DMA_IRQHandler(&rs485_dma_tx); }
+
+void BSP_ADC1_DMA_IRQHandler(void) { HAL_DMA_IRQHandler(&adc1_dma); }
+
+#if BSP_ADC1_LOW_LATENCY_CHANNELS
+void BSP_ADC1_IRQHandler(void)
+{
+    /* Cleared first, or the HAL would take it for a DMA transfer complete */
+    if (__HAL_ADC_GET_FLAG(&hadc1, ADC_FLAG_EOS))
+    {
+        __HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_EOS);
+        adc1_frame_done_from_isr();
+    }
+    HAL_ADC_IRQHandler(&hadc1);
+}
+#else
+void BSP_ADC1_IRQHandler(void) { HAL_ADC_IRQHandler(&hadc1); }
+#endif
+
+#if ADC1_USES_ADC2
+void BSP_ADC2_IRQHandler(void) { HAL_ADC_IRQHandler(&hadc2); }
+#else
+void BSP_ADC2_IRQHandler(void) {}
+#endif
+
+/*============================================================================*/
+/*                          PWM Functions                                     */
+/*============================================================================*/
+
+/**
+ * @brief Kernel clock of a PWM timer
+ *
+ * With TIMPRE clear a timer runs at its APB clock, or at twice the APB
+ * clock when the APB prescaler divides.
+ */
+static uint32_t pwm_timer_clock(const TIM_TypeDef *tim)
+{
+    uint32_t pclk;
+    uint32_t ppre;
+
+    if (tim == TIM15)
+    {
+        pclk = HAL_RCC_GetPCLK2Freq();
+        ppre = (RCC->CFGR2 & RCC_CFGR2_PPRE2) >> RCC_CFGR2_PPRE2_Pos;
+    }
+    else
+    {
+        pclk = HAL_RCC_GetPCLK1Freq();
+        ppre = (RCC->CFGR2 & RCC_CFGR2_PPRE1) >> RCC_CFGR2_PPRE1_Pos;
+    }
+
+    /* PPREx values below 4 do not divide */
+    return (ppre < 4U) ? pclk : (2U * pclk);
+}
+
+/**
+ * @brief Compare value of a duty cycle
+ * @param period Counter ticks per period, ARR + 1
+ * @param duty   High time in 0.01 % of the period
+ */
+static uint32_t pwm_compare(uint32_t period, uint16_t duty)
+{
+    return ((period * duty) + (BSP_PWM_DUTY_MAX / 2U)) / BSP_PWM_DUTY_MAX;
+}
+
+/**
+ * @brief Write the preload registers of a PWM output
+ *
+ * The prescaler is the smallest that fits the period in the 16-bit
+ * counter, which keeps the duty resolution highest. UDIS holds off the
+ * update event while the three registers are written, so they reach the
+ * counter together at a period boundary. A duty of ::BSP_PWM_DUTY_MAX
+ * puts the compare value past the auto-reload, keeping the output high.
+ */
+static void pwm_load(TIM_TypeDef *tim, uint32_t frequency_hz, uint16_t duty)
+{
+    uint32_t cycles    = pwm_timer_clock(tim) / frequency_hz;
+    uint32_t prescaler = cycles / PWM_COUNTER_RANGE;
+    uint32_t period    = cycles / (prescaler + 1U);
+
+    tim->CR1 |= TIM_CR1_UDIS;
+    tim->PSC  = prescaler;
+    tim->ARR  = period - 1U;
+    tim->CCR1 = pwm_compare(period, duty);
+    tim->CR1 &= ~TIM_CR1_UDIS;
+}
+
+bsp_error_t BSP_PWM_Start(uint8_t channel, uint32_t frequency_hz,
+                          uint16_t duty)
+{
+    TIM_TypeDef *tim;
+
+    if ((channel >= BSP_PWM_COUNT) || (frequency_hz < BSP_PWM_MIN_FREQUENCY) ||
+        (frequency_hz > BSP_PWM_MAX_FREQUENCY) || (duty > BSP_PWM_DUTY_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+    tim = pwm_outputs[channel].instance;
+
+    taskENTER_CRITICAL();
+    clock_require_full();
+    pwm_load(tim, frequency_hz, duty);
+    if ((pwm_running & (1U << channel)) == 0U)
+    {
+        /* Stopped: load the shadow registers now and start a period */
+        tim->EGR = TIM_EGR_UG;
+        MODIFY_REG(tim->CCMR1, TIM_CCMR1_OC1M, TIM_OCMODE_PWM1);
+        tim->CR1 |= TIM_CR1_CEN;
+        pwm_running |= (uint8_t)(1U << channel);
+    }
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_PWM_SetDuty(uint8_t channel, uint16_t duty)
+{
+    TIM_TypeDef *tim;
+
+    if ((channel >= BSP_PWM_COUNT) || (duty > BSP_PWM_DUTY_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+    tim = pwm_outputs[channel].instance;
+
+    /* ARR reads back its preload, the period the compare value lands in */
+    taskENTER_CRITICAL();
+    tim->CCR1 = pwm_compare(tim->ARR + 1U, duty);
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_PWM_Stop(uint8_t channel)
+{
+    TIM_TypeDef *tim;
+
+    if (channel >= BSP_PWM_COUNT)
+    {
+        return BSP_INVALID_ARG;
+    }
+    tim = pwm_outputs[channel].instance;
+
+    taskENTER_CRITICAL();
+    MODIFY_REG(tim->CCMR1, TIM_CCMR1_OC1M, TIM_OCMODE_FORCED_INACTIVE);
+    tim->CR1 &= ~TIM_CR1_CEN;
+    pwm_running &= (uint8_t)~(1U << channel);
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          Digital Input Capture Functions                   */
+/*============================================================================*/
+
+/**
+ * @brief Narrow a cycle count to 32 bits, saturating
+ */
+static uint32_t gpiodi_cycles(uint64_t cycles)
+{
+    return (cycles > UINT32_MAX) ? UINT32_MAX : (uint32_t)cycles;
+}
+
+/**
+ * @brief Count, time and queue one edge of a captured input (ISR)
+ * @param ch     Digital input
+ * @param rising Rising edge, else falling
+ * @param now    Cycle counter at the interrupt
+ * @param count  Capture timer count at the interrupt
+ *
+ * All edge interrupts share one priority and never nest, so this is the
+ * only writer of the counters and of the FIFO heads.
+ */
+static void gpiodi_edge_from_isr(uint8_t ch, bool rising, uint64_t now,
+                                 uint32_t count)
+{
+    bsp_gpiodi_capture_t *capture = &gpiodi_capture[ch];
+    uint32_t              head    = gpiodi_edge_head;
+    uint32_t              stamp   = gpiodi_stamp_head;
+    bsp_gpiodi_edge_t    *edge;
+
+    if (rising)
+    {
+        if (capture->rising != 0U)
+        {
+            capture->period = gpiodi_cycles(now - capture->last_rise);
+        }
+        capture->last_rise = now;
+        capture->rising++;
+    }
+    else if (capture->rising != 0U)
+    {
+        capture->high_time = gpiodi_cycles(now - capture->last_rise);
+    }
+    else
+    {
+        /* A falling edge before the first rising one has no high time */
+    }
+
+    /* A full timeline drops the edge; the input's next edge sets its level
+     * again */
+    if ((stamp - gpiodi_stamp_tail) < BSP_GPIODI_EDGE_FIFO_SIZE)
+    {
+        gpiodi_stamp_t *slot =
+            &gpiodi_stamps[stamp & (BSP_GPIODI_EDGE_FIFO_SIZE - 1U)];
+
+        slot->count   = count;
+        slot->channel = ch;
+        slot->rising  = rising;
+        __DMB();
+        gpiodi_stamp_head = stamp + 1U;
+    }
+
+    if ((head - gpiodi_edge_tail) >= BSP_GPIODI_EDGE_FIFO_SIZE)
+    {
+        gpiodi_edge_overruns++;
+        return;
+    }
+
+    edge          = &gpiodi_edges[head & (BSP_GPIODI_EDGE_FIFO_SIZE - 1U)];
+    edge->time    = now;
+    edge->channel = ch;
+    edge->rising  = rising;
+    __DMB();
+    gpiodi_edge_head = head + 1U;
+}
+
+bsp_error_t BSP_GPIODI_CaptureSelect(uint8_t mask)
+{
+    uint16_t lines = 0U;
+    uint8_t  dropped;
+    uint8_t  added;
+
+    for (uint8_t ch = 0U; ch < BSP_GPIODI_COUNT; ch++)
+    {
+        uint16_t line = (uint16_t)(1U << gpiodi_inputs[ch].line);
+
+        if ((mask & (1U << ch)) != 0U)
+        {
+            if ((lines & line) != 0U)
+            {
+                return BSP_INVALID_ARG;
+            }
+            lines |= line;
+        }
+    }
+
+    dropped = gpiodi_selected & (uint8_t)~mask;
+    added   = mask & (uint8_t)~gpiodi_selected;
+
+    /* Free the lines first, an added input may take over one of them */
+    for (uint8_t ch = 0U; ch < BSP_GPIODI_COUNT; ch++)
+    {
+        uint32_t line = 1UL << gpiodi_inputs[ch].line;
+
+        if ((dropped & (1U << ch)) == 0U)
+        {
+            continue;
+        }
+
+        /* The pin stays an input, only its EXTI line is released */
+        taskENTER_CRITICAL();
+        EXTI->IMR1 &= ~line;
+        EXTI->RTSR1 &= ~line;
+        EXTI->FTSR1 &= ~line;
+        EXTI->RPR1 = line;
+        EXTI->FPR1 = line;
+        gpiodi_line_owner[gpiodi_inputs[ch].line] = GPIODI_LINE_FREE;
+        gpiodi_selected &= (uint8_t)~(1U << ch);
+        taskEXIT_CRITICAL();
+    }
+
+    for (uint8_t ch = 0U; ch < BSP_GPIODI_COUNT; ch++)
+    {
+        const gpiodi_input_t *input = &gpiodi_inputs[ch];
+        GPIO_InitTypeDef      gpio  = {0};
+
+        if ((added & (1U << ch)) == 0U)
+        {
+            continue;
+        }
+
+        gpio.Pin   = input->pin;
+        gpio.Mode  = GPIO_MODE_IT_RISING_FALLING;
+        gpio.Pull  = GPIO_NOPULL;
+        gpio.Speed = GPIO_SPEED_FREQ_LOW;
+
+        taskENTER_CRITICAL();
+        clock_require_full();
+        (void)memset(&gpiodi_capture[ch], 0, sizeof(gpiodi_capture[ch]));
+        gpiodi_line_owner[input->line] = ch;
+        gpiodi_selected |= (uint8_t)(1U << ch);
+        /* Routes the line to the port and unmasks it */
+        HAL_GPIO_Init(input->port, &gpio);
+        taskEXIT_CRITICAL();
+    }
+
+    return BSP_OK;
+}
+
+uint8_t BSP_GPIODI_CaptureSelected(void) { return gpiodi_selected; }
+
+bsp_error_t BSP_GPIODI_CaptureRead(uint32_t              channel,
+                                   bsp_gpiodi_capture_t *capture)
+{
+    if ((channel >= BSP_GPIODI_COUNT) || (capture == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    if ((gpiodi_selected & (1U << channel)) != 0U)
+    {
+        *capture = gpiodi_capture[channel];
+    }
+    else
+    {
+        (void)memset(capture, 0, sizeof(*capture));
+    }
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+uint32_t BSP_GPIODI_CaptureRising(uint32_t channel)
+{
+    if ((channel >= BSP_GPIODI_COUNT) ||
+        ((gpiodi_selected & (1U << channel)) == 0U))
+    {
+        return 0U;
+    }
+
+    return gpiodi_capture[channel].rising;
+}
+
+bsp_error_t BSP_GPIODI_EdgeRead(bsp_gpiodi_edge_t *edges, uint32_t max_count,
+                                uint32_t *count)
+{
+    uint32_t head;
+    uint32_t tail;
+    uint32_t n = 0U;
+
+    if ((edges == NULL) || (count == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    head = gpiodi_edge_head;
+    __DMB();
+    tail = gpiodi_edge_tail;
+
+    while ((tail != head) && (n < max_count))
+    {
+        edges[n] = gpiodi_edges[tail & (BSP_GPIODI_EDGE_FIFO_SIZE - 1U)];
+        n++;
+        tail++;
+    }
+
+    /* The slots are copied out before the interrupt may reuse them */
+    __DMB();
+    gpiodi_edge_tail = tail;
+    *count           = n;
+
+    return BSP_OK;
+}
+
+uint32_t BSP_GPIODI_EdgeOverruns(void) { return gpiodi_edge_overruns; }
+
+void BSP_GPIODI_IRQHandler(uint32_t line)
+{
+    uint32_t mask;
+    uint32_t rising;
+    uint32_t falling;
+    uint64_t now   = BSP_CycleCounter_Read64();
+    uint32_t count = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+    uint8_t  ch;
+
+    if (line >= GPIODI_EXTI_LINES)
+    {
+        return;
+    }
+
+    mask    = 1UL << line;
+    rising  = EXTI->RPR1 & mask;
+    falling = EXTI->FPR1 & mask;
+    EXTI->RPR1 = rising;
+    EXTI->FPR1 = falling;
+
+    ch = gpiodi_line_owner[line];
+    if (ch == GPIODI_LINE_FREE)
+    {
+        return;
+    }
+
+    if ((rising != 0U) && (falling != 0U))
+    {
+        /* Both edges came before the interrupt ran; the level now tells
+         * which was last */
+        bool high = (gpiodi_inputs[ch].port->IDR & gpiodi_inputs[ch].pin) != 0U;
+
+        gpiodi_edge_from_isr(ch, !high, now, count);
+        gpiodi_edge_from_isr(ch, high, now, count);
+    }
+    else if (rising != 0U)
+    {
+        gpiodi_edge_from_isr(ch, true, now, count);
+    }
+    else if (falling != 0U)
+    {
+        gpiodi_edge_from_isr(ch, false, now, count);
+    }
+    else
+    {
+        /* Spurious, the line was released meanwhile */
+    }
+}
+
+/*============================================================================*/
+/*                          CAN Functions                                     */
+/*============================================================================*/
+
+/**
+ * @brief Find the bit timing of one phase
+ *
+ * Takes the smallest prescaler that divides the kernel clock to a whole
+ * number of quanta within the segment limits, which places the sample
+ * point most finely.
+ *
+ * @param bitrate       Bit rate in bit/s
+ * @param sample_point  Sample point in percent of the bit
+ * @param max_prescaler Largest prescaler of the phase
+ * @param max_seg1      Longest segment 1 of the phase
+ * @param max_seg2      Longest segment 2 of the phase
+ * @param timing        Timing found
+ * @return true if the kernel clock can time the bit rate
+ */
+static bool can_find_timing(uint32_t bitrate, uint32_t sample_point,
+                            uint32_t max_prescaler, uint32_t max_seg1,
+                            uint32_t max_seg2, can_timing_t *timing)
+{
+    for (uint32_t prescaler = 1U; prescaler <= max_prescaler; prescaler++)
+    {
+        uint32_t quanta;
+
+        if ((CAN_KERNEL_HZ % (prescaler * bitrate)) != 0U)
+        {
+            continue;
+        }
+        quanta = CAN_KERNEL_HZ / (prescaler * bitrate);
+        if (quanta < CAN_MIN_QUANTA)
+        {
+            return false;
+        }
+
+        /* The sample point ends the sync quantum and segment 1 */
+        timing->prescaler = prescaler;
+        timing->seg1      = ((quanta * sample_point) / 100U) - 1U;
+        timing->seg2      = quanta - 1U - timing->seg1;
+        if ((timing->seg1 <= max_seg1) && (timing->seg2 <= max_seg2))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Wait for the controller to enter or leave init mode
+ * @return false if it did not within CAN_INIT_TIMEOUT_MS
+ */
+static bool can_wait_init(bool init)
+{
+    uint32_t start = HAL_GetTick();
+
+    while (((FDCAN1->CCCR & FDCAN_CCCR_INIT) != 0U) != init)
+    {
+        if ((HAL_GetTick() - start) > CAN_INIT_TIMEOUT_MS)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Put the controller into init mode and drop the queued frames
+ *
+ * Init mode aborts the pending transmissions and leaves the bus.
+ */
+static bool can_halt(void)
+{
+    HAL_NVIC_DisableIRQ(FDCAN1_IT0_IRQn);
+    FDCAN1->CCCR |= FDCAN_CCCR_INIT;
+
+    taskENTER_CRITICAL();
+    can_running = false;
+    can_tx_tail = can_tx_head;
+    taskEXIT_CRITICAL();
+
+    return can_wait_init(true);
+}
+
+/**
+ * @brief Enable the FDCAN1 kernel clock, bus clock and pins
+ * @return BSP_OK, or BSP_ERROR if PLL2 cannot be set up
+ */
+static bsp_error_t can_msp_init(void)
+{
+    GPIO_InitTypeDef         gpio = {0};
+    RCC_PeriphCLKInitTypeDef clk  = {0};
+
+    /* PLL2 runs for FDCAN1 alone: 8 MHz / 4 * 160 = 320 MHz VCO, Q / 4 */
+    clk.PeriphClockSelection = RCC_PERIPHCLK_FDCAN;
+    clk.FdcanClockSelection  = RCC_FDCANCLKSOURCE_PLL2Q;
+    clk.PLL2.PLL2Source      = RCC_PLL2_SOURCE_HSE;
+    clk.PLL2.PLL2M           = 4U;
+    clk.PLL2.PLL2N           = 160U;
+    clk.PLL2.PLL2P           = 2U;
+    clk.PLL2.PLL2Q           = 4U;
+    clk.PLL2.PLL2R           = 2U;
+    clk.PLL2.PLL2RGE         = RCC_PLL2_VCIRANGE_1;
+    clk.PLL2.PLL2VCOSEL      = RCC_PLL2_VCORANGE_WIDE;
+    clk.PLL2.PLL2FRACN       = 0U;
+    clk.PLL2.PLL2ClockOut    = RCC_PLL2_DIVQ;
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    __HAL_RCC_FDCAN_CLK_ENABLE();
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+
+    /* PB8 FDCAN1_RX, PB9 FDCAN1_TX */
+    gpio.Pin       = GPIO_PIN_8 | GPIO_PIN_9;
+    gpio.Mode      = GPIO_MODE_AF_PP;
+    gpio.Pull      = GPIO_NOPULL;
+    gpio.Speed     = GPIO_SPEED_FREQ_HIGH;
+    gpio.Alternate = GPIO_AF9_FDCAN1;
+    HAL_GPIO_Init(GPIOB, &gpio);
+
+    HAL_NVIC_SetPriority(FDCAN1_IT0_IRQn, CAN_IRQ_PRIORITY, 0);
+
+    return BSP_OK;
+}
+
+/**
+ * @brief Data length code of a frame
+ * @return The code, or 16 if the frame format cannot carry the length
+ */
+static uint32_t can_length_code(const bsp_can_frame_t *frame)
+{
+    if ((frame->flags & BSP_CAN_FLAG_FD) == 0U)
+    {
+        return ((frame->length <= 8U) &&
+                ((frame->flags & BSP_CAN_FLAG_BRS) == 0U))
+                   ? frame->length
+                   : 16U;
+    }
+
+    for (uint32_t code = 0U; code < 16U; code++)
+    {
+        if (can_dlc_length[code] == frame->length)
+        {
+            return code;
+        }
+    }
+
+    return 16U;
+}
+
+/**
+ * @brief Copy a frame into the TX buffer at the put index and request it
+ *
+ * The caller has checked that a TX buffer is free. Message RAM takes
+ * 32-bit accesses only, so the payload is written a word at a time.
+ */
+static void can_write_tx(const bsp_can_frame_t *frame)
+{
+    uint32_t index =
+        (FDCAN1->TXFQS & FDCAN_TXFQS_TFQPI) >> FDCAN_TXFQS_TFQPI_Pos;
+    volatile uint32_t *element =
+        (volatile uint32_t *)(CAN_RAM_TX_BUFFER +
+                              (index * CAN_RAM_ELEMENT_SIZE));
+    uint32_t header = can_length_code(frame) << CAN_ELEMENT_DLC_Pos;
+
+    if ((frame->flags & BSP_CAN_FLAG_FD) != 0U)
+    {
+        header |= CAN_ELEMENT_FDF;
+    }
+    if ((frame->flags & BSP_CAN_FLAG_BRS) != 0U)
+    {
+        header |= CAN_ELEMENT_BRS;
+    }
+
+    element[0] = (uint32_t)frame->id << CAN_ELEMENT_ID_Pos;
+    element[1] = header;
+    for (uint32_t i = 0U; i < frame->length; i += 4U)
+    {
+        uint32_t word = 0U;
+
+        for (uint32_t b = 0U; (b < 4U) && ((i + b) < frame->length); b++)
+        {
+            word |= (uint32_t)frame->data[i + b] << (8U * b);
+        }
+        element[2U + (i / 4U)] = word;
+    }
+
+    FDCAN1->TXBAR = 1UL << index;
+    can_stats.tx_frames++;
+}
+
+/**
+ * @brief Move queued frames into the free TX buffers
+ *
+ * Runs in the interrupt or with it masked.
+ */
+static void can_refill_tx(void)
+{
+    while ((can_tx_tail != can_tx_head) &&
+           ((FDCAN1->TXFQS & FDCAN_TXFQS_TFQF) == 0U))
+    {
+        can_write_tx(&can_tx_queue[can_tx_tail & (BSP_CAN_TX_QUEUE_SIZE - 1U)]);
+        can_tx_tail++;
+    }
+}
+
+bsp_error_t BSP_CAN_Start(const bsp_can_config_t *config)
+{
+    can_timing_t       nominal;
+    can_timing_t       data;
+    volatile uint32_t *ram    = (volatile uint32_t *)SRAMCAN_BASE;
+    volatile uint32_t *filter = (volatile uint32_t *)CAN_RAM_FILTERS;
+
+    if ((config == NULL) || (config->nominal_bitrate < BSP_CAN_MIN_BITRATE) ||
+        (config->nominal_bitrate > BSP_CAN_MAX_BITRATE) ||
+        (config->data_bitrate < config->nominal_bitrate) ||
+        (config->data_bitrate > BSP_CAN_MAX_DATA_BITRATE) ||
+        (config->filter_count > BSP_CAN_MAX_FILTERS) ||
+        ((config->filter_count > 0U) && (config->filters == NULL)))
+    {
+        return BSP_INVALID_ARG;
+    }
+    for (uint8_t i = 0U; i < config->filter_count; i++)
+    {
+        if ((config->filters[i].id > BSP_CAN_MAX_ID) ||
+            (config->filters[i].mask > BSP_CAN_MAX_ID))
+        {
+            return BSP_INVALID_ARG;
+        }
+    }
+
+    /* NBTP and DBTP limits, each field holds its value less one */
+    if (!can_find_timing(config->nominal_bitrate, CAN_NOMINAL_SAMPLE_POINT,
+                         512U, 256U, 128U, &nominal) ||
+        !can_find_timing(config->data_bitrate, CAN_DATA_SAMPLE_POINT, 32U,
+                         32U, 16U, &data))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    if (can_running && !can_halt())
+    {
+        return BSP_TIMEOUT;
+    }
+    if (can_msp_init() != BSP_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    /* Leave sleep mode, then configure in init mode */
+    FDCAN1->CCCR &= ~FDCAN_CCCR_CSR;
+    FDCAN1->CCCR |= FDCAN_CCCR_INIT;
+    if (!can_wait_init(true))
+    {
+        return BSP_TIMEOUT;
+    }
+    FDCAN1->CCCR |= FDCAN_CCCR_CCE;
+
+    for (uint32_t i = 0U; i < (CAN_RAM_SIZE / 4U); i++)
+    {
+        ram[i] = 0U;
+    }
+
+    /* Undivided kernel clock; FD frames with bit rate switching, automatic
+     * retransmission, no protocol exception handling */
+    FDCAN_CONFIG->CKDIV = 0U;
+    FDCAN1->CCCR &= ~(FDCAN_CCCR_DAR | FDCAN_CCCR_TEST | FDCAN_CCCR_MON |
+                      FDCAN_CCCR_ASM);
+    FDCAN1->CCCR |= FDCAN_CCCR_FDOE | FDCAN_CCCR_BRSE | FDCAN_CCCR_PXHD;
+    FDCAN1->NBTP = ((nominal.seg2 - 1U) << FDCAN_NBTP_NSJW_Pos) |
+                   ((nominal.prescaler - 1U) << FDCAN_NBTP_NBRP_Pos) |
+                   ((nominal.seg1 - 1U) << FDCAN_NBTP_NTSEG1_Pos) |
+                   ((nominal.seg2 - 1U) << FDCAN_NBTP_NTSEG2_Pos);
+    FDCAN1->DBTP = ((data.prescaler - 1U) << FDCAN_DBTP_DBRP_Pos) |
+                   ((data.seg1 - 1U) << FDCAN_DBTP_DTSEG1_Pos) |
+                   ((data.seg2 - 1U) << FDCAN_DBTP_DTSEG2_Pos) |
+                   ((data.seg2 - 1U) << FDCAN_DBTP_DSJW_Pos);
+
+    /* The transceiver loop delay exceeds a fast data bit: sample the own
+     * bits at the sample point after their delayed return */
+    if (data.prescaler <= 2U)
+    {
+        FDCAN1->TDCR = (data.prescaler * data.seg1) << FDCAN_TDCR_TDCO_Pos;
+        FDCAN1->DBTP |= FDCAN_DBTP_TDC;
+    }
+
+    for (uint8_t i = 0U; i < config->filter_count; i++)
+    {
+        filter[i] = CAN_FILTER_CLASSIC_FIFO0 |
+                    ((uint32_t)config->filters[i].id << 16U) |
+                    config->filters[i].mask;
+    }
+    FDCAN1->RXGFC =
+        ((uint32_t)config->filter_count << FDCAN_RXGFC_LSS_Pos) |
+        (CAN_NON_MATCHING_REJECT << FDCAN_RXGFC_ANFS_Pos) |
+        (CAN_NON_MATCHING_REJECT << FDCAN_RXGFC_ANFE_Pos) |
+        FDCAN_RXGFC_RRFS | FDCAN_RXGFC_RRFE;
+
+    /* TX buffers as a FIFO; all interrupts on line 0 */
+    FDCAN1->TXBC   = 0U;
+    FDCAN1->TXBTIE = (1UL << CAN_TX_BUFFERS) - 1U;
+    FDCAN1->ILS    = 0U;
+    FDCAN1->IE     = FDCAN_IE_TCE | FDCAN_IE_RF0LE | FDCAN_IE_BOE;
+    FDCAN1->ILE    = FDCAN_ILE_EINT0;
+    FDCAN1->IR     = FDCAN1->IR;
+
+    taskENTER_CRITICAL();
+    can_tx_tail = can_tx_head;
+    can_running = true;
+    taskEXIT_CRITICAL();
+
+    HAL_NVIC_EnableIRQ(FDCAN1_IT0_IRQn);
+    FDCAN1->CCCR &= ~FDCAN_CCCR_INIT;
+    if (!can_wait_init(false))
+    {
+        (void)can_halt();
+        return BSP_TIMEOUT;
+    }
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_CAN_Stop(void)
+{
+    bool halted;
+
+    if (!can_running)
+    {
+        return BSP_OK;
+    }
+
+    halted = can_halt();
+    __HAL_RCC_FDCAN_CLK_DISABLE();
+
+    return halted ? BSP_OK : BSP_TIMEOUT;
+}
+
+bool BSP_CAN_IsRunning(void) { return can_running; }
+
+bsp_error_t BSP_CAN_Transmit(const bsp_can_frame_t *frame)
+{
+    bsp_error_t status = BSP_OK;
+
+    if ((frame == NULL) || (frame->id > BSP_CAN_MAX_ID) ||
+        (can_length_code(frame) >= 16U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    if (!can_running)
+    {
+        status = BSP_ERROR;
+    }
+    else if ((can_tx_head - can_tx_tail) >= BSP_CAN_TX_QUEUE_SIZE)
+    {
+        can_stats.tx_dropped++;
+        status = BSP_BUSY;
+    }
+    else
+    {
+        /* Through the queue, so a frame never overtakes an earlier one */
+        can_tx_queue[can_tx_head & (BSP_CAN_TX_QUEUE_SIZE - 1U)] = *frame;
+        can_tx_head++;
+        can_refill_tx();
+    }
+    taskEXIT_CRITICAL();
+
+    return status;
+}
+
+bsp_error_t BSP_CAN_Receive(bsp_can_frame_t *frames, uint32_t max_count,
+                            uint32_t *count)
+{
+    if ((frames == NULL) || (count == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    *count = 0U;
+    if (!can_running)
+    {
+        return BSP_ERROR;
+    }
+
+    while ((*count < max_count) && ((FDCAN1->RXF0S & FDCAN_RXF0S_F0FL) != 0U))
+    {
+        uint32_t index =
+            (FDCAN1->RXF0S & FDCAN_RXF0S_F0GI) >> FDCAN_RXF0S_F0GI_Pos;
+        const volatile uint32_t *element =
+            (const volatile uint32_t *)(CAN_RAM_RX_FIFO0 +
+                                        (index * CAN_RAM_ELEMENT_SIZE));
+        bsp_can_frame_t *frame  = &frames[*count];
+        uint32_t         header = element[1];
+
+        /* Extended frames are rejected by the global filter */
+        frame->id     = (uint16_t)((element[0] >> CAN_ELEMENT_ID_Pos) &
+                                   BSP_CAN_MAX_ID);
+        frame->length = can_dlc_length[(header >> CAN_ELEMENT_DLC_Pos) & 0xFU];
+        frame->flags  = 0U;
+        if ((header & CAN_ELEMENT_FDF) != 0U)
+        {
+            frame->flags |= BSP_CAN_FLAG_FD;
+        }
+        else if (frame->length > 8U)
+        {
+            /* Classic codes above 8 still carry 8 bytes */
+            frame->length = 8U;
+        }
+        if ((header & CAN_ELEMENT_BRS) != 0U)
+        {
+            frame->flags |= BSP_CAN_FLAG_BRS;
+        }
+
+        for (uint32_t i = 0U; i < frame->length; i += 4U)
+        {
+            uint32_t word = element[2U + (i / 4U)];
+
+            for (uint32_t b = 0U; (b < 4U) && ((i + b) < frame->length); b++)
+            {
+                frame->data[i + b] = (uint8_t)(word >> (8U * b));
+            }
+        }
+
+        FDCAN1->RXF0A = index;
+        (*count)++;
+    }
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_CAN_GetStats(bsp_can_stats_t *stats)
+{
+    uint32_t ecr;
+
+    if (stats == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    *stats = can_stats;
+    if (can_running)
+    {
+        ecr        = FDCAN1->ECR;
+        stats->tec = (uint8_t)((ecr & FDCAN_ECR_TEC) >> FDCAN_ECR_TEC_Pos);
+        stats->rec = (uint8_t)((ecr & FDCAN_ECR_REC) >> FDCAN_ECR_REC_Pos);
+    }
+    taskEXIT_CRITICAL();
+
+    return BSP_OK;
+}
+
+void BSP_CAN_IRQHandler(void)
+{
+    uint32_t flags = FDCAN1->IR & FDCAN1->IE;
+
+    FDCAN1->IR = flags;
+
+    if ((flags & FDCAN_IR_TC) != 0U)
+    {
+        can_refill_tx();
+    }
+
+    if ((flags & FDCAN_IR_RF0L) != 0U)
+    {
+        can_stats.rx_lost++;
+    }
+
+    if (((flags & FDCAN_IR_BO) != 0U) && ((FDCAN1->PSR & FDCAN_PSR_BO) != 0U))
+    {
+        /* Bus-off set INIT; clearing it starts the recovery sequence of
+         * 128 times 11 recessive bits */
+        can_stats.bus_off++;
+        FDCAN1->CCCR &= ~FDCAN_CCCR_INIT;
+    }
+}
+
+#if BSP_USBD_ENABLE
+/*============================================================================*/
+/*                          USB Device Functions                              */
+/*============================================================================*/
+
+/**
+ * @brief Load the next packet of the control IN data stage (ISR)
+ */
+static void usbd_ctrl_next(void)
+{
+    const uint32_t length = (usbd_ctrl_left < BSP_USBD_MAX_PACKET)
+                                ? usbd_ctrl_left
+                                : BSP_USBD_MAX_PACKET;
+
+    if (length > 0U)
+    {
+        USB_WritePMA(USB_DRD_FS, (uint8_t *)usbd_ctrl_data, USBD_PMA_CTRL_TX,
+                     (uint16_t)length);
+    }
+    USB_DRD_SET_CHEP_TX_CNT(USB_DRD_FS, USBD_EP_CTRL, length);
+    usbd_ctrl_data += length;
+    usbd_ctrl_left -= length;
+    USB_DRD_SET_CHEP_TX_STATUS(USB_DRD_FS, USBD_EP_CTRL, USB_EP_TX_VALID);
+}
+
+/**
+ * @brief Start the IN stage of a control transfer (ISR)
+ *
+ * For a request without data the stage is the zero-length status packet.
+ * A reply shorter than wLength that ends on a full packet is closed by a
+ * zero-length one, so the host does not wait for more.
+ */
+static void usbd_ctrl_start(const bsp_usbh_setup_t *setup,
+                            const uint8_t *data, uint32_t length)
+{
+    if (length > setup->length)
+    {
+        length = setup->length;
+    }
+
+    usbd_ctrl_data = data;
+    usbd_ctrl_left = length;
+    usbd_ctrl_zlp  = (length > 0U) && (length < setup->length) &&
+                    ((length % BSP_USBD_MAX_PACKET) == 0U);
+
+    /* The OUT status stage, or an early one ending the data stage */
+    USB_DRD_SET_CHEP_RX_STATUS(USB_DRD_FS, USBD_EP_CTRL, USB_EP_RX_VALID);
+    usbd_ctrl_next();
+}
+
+/**
+ * @brief Refuse the control transfer in progress (ISR)
+ *
+ * The next SETUP packet is taken whatever the endpoint state.
+ */
+static void usbd_ctrl_stall(void)
+{
+    usbd_ctrl_left = 0U;
+    usbd_ctrl_zlp  = false;
+    USB_DRD_SET_CHEP_TX_STATUS(USB_DRD_FS, USBD_EP_CTRL, USB_EP_TX_STALL);
+    USB_DRD_SET_CHEP_RX_STATUS(USB_DRD_FS, USBD_EP_CTRL, USB_EP_RX_STALL);
+}
+
+/**
+ * @brief Load the next packet of the bulk transfer at the head (ISR)
+ */
+static void usbd_bulk_next(void)
+{
+    const uint32_t length = (usbd_bulk_left < BSP_USBD_MAX_PACKET)
+                                ? usbd_bulk_left
+                                : BSP_USBD_MAX_PACKET;
+
+    if (length > 0U)
+    {
+        USB_WritePMA(USB_DRD_FS, (uint8_t *)usbd_bulk_data, USBD_PMA_BULK_TX,
+                     (uint16_t)length);
+    }
+    USB_DRD_SET_CHEP_TX_CNT(USB_DRD_FS, USBD_EP_BULK_IN, length);
+    usbd_bulk_data += length;
+    usbd_bulk_left -= length;
+
+    /* A transfer of whole packets is closed by a zero-length one */
+    usbd_bulk_zlp = (usbd_bulk_left == 0U) && (length == BSP_USBD_MAX_PACKET);
+
+    if (!usbd_bulk_halted)
+    {
+        USB_DRD_SET_CHEP_TX_STATUS(USB_DRD_FS, USBD_EP_BULK_IN,
+                                   USB_EP_TX_VALID);
+    }
+}
+
+/**
+ * @brief Start the transfer at the head of the queue, if any (ISR)
+ */
+static void usbd_bulk_start(void)
+{
+    if (usbd_queue_count == 0U)
+    {
+        return;
+    }
+
+    usbd_bulk_data = usbd_queue[usbd_queue_head].data;
+    usbd_bulk_left = usbd_queue[usbd_queue_head].length;
+    usbd_bulk_next();
+}
+
+/**
+ * @brief Remove the transfer at the head and report it (ISR)
+ */
+static void usbd_bulk_finish(bool sent)
+{
+    const uint8_t *data = usbd_queue[usbd_queue_head].data;
+
+    usbd_queue_head = (uint8_t)((usbd_queue_head + 1U) % BSP_USBD_QUEUE_DEPTH);
+    usbd_queue_count--;
+    usbd_config->transmitted(data, sent);
+}
+
+/**
+ * @brief Drop every queued transfer (ISR)
+ *
+ * The endpoint is left to the caller, which disables or reopens it.
+ */
+static void usbd_bulk_flush(void)
+{
+    while (usbd_queue_count > 0U)
+    {
+        usbd_bulk_finish(false);
+    }
+    usbd_bulk_left = 0U;
+    usbd_bulk_zlp  = false;
+}
+
+/**
+ * @brief Halt the bulk endpoint or clear its halt (ISR)
+ *
+ * Clearing the halt also restarts the data toggle at DATA0, and sends the
+ * packet the halt held back.
+ */
+static void usbd_bulk_halt(bool halt)
+{
+    usbd_bulk_halted = halt;
+    if (halt)
+    {
+        USB_DRD_SET_CHEP_TX_STATUS(USB_DRD_FS, USBD_EP_BULK_IN,
+                                   USB_EP_TX_STALL);
+        return;
+    }
+
+    USB_DRD_CLEAR_TX_DTOG(USB_DRD_FS, USBD_EP_BULK_IN);
+    USB_DRD_SET_CHEP_TX_STATUS(USB_DRD_FS, USBD_EP_BULK_IN,
+                               (usbd_queue_count > 0U) ? USB_EP_TX_VALID
+                                                       : USB_EP_TX_NAK);
+}
+
+/**
+ * @brief Apply SET_CONFIGURATION (ISR)
+ *
+ * Configuration 1 opens the bulk endpoint at DATA0; either value drops
+ * the transfers queued.
+ */
+static void usbd_configure(uint8_t configuration)
+{
+    const bool was_configured = (usbd_configuration != 0U);
+
+    usbd_configuration = 0U;
+    usbd_bulk_flush();
+    usbd_bulk_halted = false;
+
+    if (configuration != 0U)
+    {
+        USB_DRD_SET_CHEP(USB_DRD_FS, USBD_EP_BULK_IN,
+                         USB_EP_BULK | USBD_EP_BULK_IN);
+        USB_DRD_SET_CHEP_TX_ADDRESS(USB_DRD_FS, USBD_EP_BULK_IN,
+                                    USBD_PMA_BULK_TX);
+        USB_DRD_CLEAR_TX_DTOG(USB_DRD_FS, USBD_EP_BULK_IN);
+        USB_DRD_SET_CHEP_TX_STATUS(USB_DRD_FS, USBD_EP_BULK_IN,
+                                   USB_EP_TX_NAK);
+    }
+    else if (was_configured)
+    {
+        USB_DRD_SET_CHEP_TX_STATUS(USB_DRD_FS, USBD_EP_BULK_IN,
+                                   USB_EP_TX_DIS);
+    }
+
+    usbd_configuration = configuration;
+    if ((usbd_config->configured != NULL) &&
+        (was_configured != (configuration != 0U)))
+    {
+        usbd_config->configured(configuration != 0U);
+    }
+}
+
+/**
+ * @brief Find the descriptor of GET_DESCRIPTOR (ISR)
+ *
+ * @return Descriptor length, -1 if there is none of that type and index.
+ */
+static int32_t usbd_descriptor(const bsp_usbh_setup_t *setup,
+                               const uint8_t **data)
+{
+    const uint8_t type  = (uint8_t)(setup->value >> 8U);
+    const uint8_t index = (uint8_t)(setup->value & 0xFFU);
+    const uint8_t *desc = NULL;
+
+    switch (type)
+    {
+    case USBD_DESC_DEVICE:
+        *data = usbd_config->device;
+        return (int32_t)usbd_config->device[0];
+
+    case USBD_DESC_CONFIGURATION:
+        desc = (index == 0U) ? usbd_config->configuration : NULL;
+        break;
+
+    case USBD_DESC_STRING:
+        if (index < usbd_config->string_count)
+        {
+            *data = usbd_config->strings[index];
+            return (*data != NULL) ? (int32_t)(*data)[0] : -1;
+        }
+        return -1;
+
+    case USBD_DESC_BOS:
+        desc = usbd_config->bos;
+        break;
+
+    default:
+        break;
+    }
+
+    if (desc == NULL)
+    {
+        return -1;
+    }
+
+    /* wTotalLength of the descriptor set */
+    *data = desc;
+    return (int32_t)((uint32_t)desc[2] | ((uint32_t)desc[3] << 8U));
+}
+
+/**
+ * @brief Answer a standard request (ISR)
+ *
+ * @return Length of the IN data at @p data, 0 for none, -1 to STALL.
+ */
+static int32_t usbd_standard(const bsp_usbh_setup_t *setup,
+                             const uint8_t **data)
+{
+    const uint8_t recipient = setup->request_type & USBD_REQ_RECIPIENT_MASK;
+    const bool    bulk_in   = (recipient == USBD_REQ_TO_ENDPOINT) &&
+                         ((setup->index & 0xFFU) == BSP_USBD_EP_BULK_IN);
+
+    switch (setup->request)
+    {
+    case USBD_REQ_GET_STATUS:
+        usbd_ctrl_reply[0] = 0U;
+        usbd_ctrl_reply[1] = 0U;
+        if (recipient == USBD_REQ_TO_DEVICE)
+        {
+            usbd_ctrl_reply[0] = USBD_STATUS_SELF_POWERED;
+        }
+        else if (bulk_in && usbd_bulk_halted)
+        {
+            usbd_ctrl_reply[0] = 1U;
+        }
+        *data = usbd_ctrl_reply;
+        return 2;
+
+    case USBD_REQ_CLEAR_FEATURE:
+    case USBD_REQ_SET_FEATURE:
+        if (!bulk_in || (usbd_configuration == 0U) ||
+            (setup->value != USBD_FEATURE_ENDPOINT_HALT))
+        {
+            return -1;
+        }
+        usbd_bulk_halt(setup->request == USBD_REQ_SET_FEATURE);
+        return 0;
+
+    case USBD_REQ_SET_ADDRESS:
+        usbd_address         = (uint8_t)(setup->value & 0x7FU);
+        usbd_address_pending = true;
+        return 0;
+
+    case USBD_REQ_GET_DESCRIPTOR:
+        return usbd_descriptor(setup, data);
+
+    case USBD_REQ_GET_CONFIGURATION:
+        usbd_ctrl_reply[0] = usbd_configuration;
+        *data              = usbd_ctrl_reply;
+        return 1;
+
+    case USBD_REQ_SET_CONFIGURATION:
+        if (setup->value > 1U)
+        {
+            return -1;
+        }
+        usbd_configure((uint8_t)setup->value);
+        return 0;
+
+    case USBD_REQ_GET_INTERFACE:
+        usbd_ctrl_reply[0] = 0U;
+        *data              = usbd_ctrl_reply;
+        return (usbd_configuration != 0U) ? 1 : -1;
+
+    case USBD_REQ_SET_INTERFACE:
+        return ((usbd_configuration != 0U) && (setup->value == 0U)) ? 0 : -1;
+
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief Handle a SETUP packet received on the control endpoint (ISR)
+ */
+static void usbd_setup(void)
+{
+    uint8_t          packet[8];
+    bsp_usbh_setup_t setup;
+    const uint8_t   *data   = NULL;
+    int32_t          length = -1;
+
+    USB_ReadPMA(USB_DRD_FS, packet, USBD_PMA_CTRL_RX, sizeof(packet));
+    USB_DRD_CLEAR_RX_CHEP_CTR(USB_DRD_FS, USBD_EP_CTRL);
+
+    setup.request_type = packet[0];
+    setup.request      = packet[1];
+    setup.value        = (uint16_t)(packet[2] | ((uint16_t)packet[3] << 8U));
+    setup.index        = (uint16_t)(packet[4] | ((uint16_t)packet[5] << 8U));
+    setup.length       = (uint16_t)(packet[6] | ((uint16_t)packet[7] << 8U));
+
+    /* No request takes an OUT data stage */
+    if (((setup.request_type & BSP_USBH_EP_IN) != 0U) || (setup.length == 0U))
+    {
+        if ((setup.request_type & USBD_REQ_TYPE_MASK) ==
+            USBD_REQ_TYPE_STANDARD)
+        {
+            length = usbd_standard(&setup, &data);
+        }
+        else
+        {
+            length = usbd_config->request(&setup, &data);
+        }
+    }
+
+    if (length < 0)
+    {
+        usbd_ctrl_stall();
+        return;
+    }
+
+    usbd_ctrl_start(&setup, data, (uint32_t)length);
+}
+
+/**
+ * @brief A packet of the control IN stage was taken by the host (ISR)
+ */
+static void usbd_ctrl_in(void)
+{
+    if (usbd_address_pending)
+    {
+        /* The status stage of SET_ADDRESS went out at address 0 */
+        usbd_address_pending = false;
+        USB_DRD_FS->DADDR    = USB_DADDR_EF | usbd_address;
+        return;
+    }
+
+    if ((usbd_ctrl_left > 0U) || usbd_ctrl_zlp)
+    {
+        if (usbd_ctrl_left == 0U)
+        {
+            usbd_ctrl_zlp = false;
+        }
+        usbd_ctrl_next();
+    }
+}
+
+/**
+ * @brief A packet of the bulk transfer at the head was taken (ISR)
+ */
+static void usbd_bulk_in(void)
+{
+    if (usbd_queue_count == 0U)
+    {
+        return;
+    }
+
+    if ((usbd_bulk_left > 0U) || usbd_bulk_zlp)
+    {
+        usbd_bulk_next();
+        return;
+    }
+
+    usbd_bulk_finish(true);
+    usbd_bulk_start();
+}
+
+/**
+ * @brief Bus reset: back to the default state at address 0 (ISR)
+ */
+static void usbd_reset(void)
+{
+    usbd_configure(0U);
+    usbd_address_pending = false;
+    usbd_ctrl_left       = 0U;
+    usbd_ctrl_zlp        = false;
+
+    /* The reset disabled every endpoint */
+    USB_DRD_SET_CHEP(USB_DRD_FS, USBD_EP_CTRL, USB_EP_CONTROL | USBD_EP_CTRL);
+    USB_DRD_SET_CHEP_TX_ADDRESS(USB_DRD_FS, USBD_EP_CTRL, USBD_PMA_CTRL_TX);
+    USB_DRD_SET_CHEP_RX_ADDRESS(USB_DRD_FS, USBD_EP_CTRL, USBD_PMA_CTRL_RX);
+    USB_DRD_SET_CHEP_RX_CNT(USB_DRD_FS, USBD_EP_CTRL, BSP_USBD_MAX_PACKET);
+    USB_DRD_SET_CHEP_RX_STATUS(USB_DRD_FS, USBD_EP_CTRL, USB_EP_RX_VALID);
+    USB_DRD_SET_CHEP_TX_STATUS(USB_DRD_FS, USBD_EP_CTRL, USB_EP_TX_NAK);
+
+    USB_DRD_FS->DADDR = USB_DADDR_EF;
+}
+
+bsp_error_t BSP_USBD_Start(const bsp_usbd_config_t *config)
+{
+    RCC_PeriphCLKInitTypeDef clock = {0};
+    RCC_CRSInitTypeDef       crs   = {0};
+    USB_DRD_CfgTypeDef       usb   = {0};
+
+    if ((config == NULL) || (config->device == NULL) ||
+        (config->configuration == NULL) || (config->request == NULL) ||
+        (config->transmitted == NULL) ||
+        ((config->string_count > 0U) && (config->strings == NULL)))
+    {
+        return BSP_INVALID_ARG;
+    }
+    if (usbd_config != NULL)
+    {
+        return BSP_BUSY;
+    }
+
+    clock.PeriphClockSelection = RCC_PERIPHCLK_USB;
+    clock.UsbClockSelection    = RCC_USBCLKSOURCE_HSI48;
+    if (HAL_RCCEx_PeriphCLKConfig(&clock) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+    HAL_PWREx_EnableVddUSB();
+    __HAL_RCC_USB_CLK_ENABLE();
+
+    /* HSI48 alone is further off than the 0.25 % a full-speed device is
+     * allowed; the CRS trims it to the 1 ms SOF of the host */
+    __HAL_RCC_CRS_CLK_ENABLE();
+    crs.Prescaler             = RCC_CRS_SYNC_DIV1;
+    crs.Source                = RCC_CRS_SYNC_SOURCE_USB;
+    crs.Polarity              = RCC_CRS_SYNC_POLARITY_RISING;
+    crs.ReloadValue           = RCC_CRS_RELOADVALUE_DEFAULT;
+    crs.ErrorLimitValue       = RCC_CRS_ERRORLIMIT_DEFAULT;
+    crs.HSI48CalibrationValue = RCC_CRS_HSI48CALIBRATION_DEFAULT;
+    HAL_RCCEx_CRSConfig(&crs);
+
+    usbd_config = config;
+
+    (void)USB_CoreInit(USB_DRD_FS, usb);
+    (void)USB_DevInit(USB_DRD_FS, usb);
+    USB_DRD_FS->ISTR = 0U;
+    USB_DRD_FS->CNTR = USB_CNTR_CTRM | USB_CNTR_RESETM;
+
+    HAL_NVIC_SetPriority(USB_DRD_FS_IRQn, USBD_IRQ_PRIORITY, 0U);
+    HAL_NVIC_EnableIRQ(USB_DRD_FS_IRQn);
+
+    /* The host sees the device attach and resets it */
+    (void)USB_DevConnect(USB_DRD_FS);
+    return BSP_OK;
+}
+
+bool BSP_USBD_IsConfigured(void)
+{
+    return usbd_configuration != 0U;
+}
+
+bsp_error_t BSP_USBD_Transmit(const uint8_t *data, uint32_t length)
+{
+    bsp_error_t status = BSP_OK;
+    uint32_t    primask;
+
+    if ((data == NULL) || (length == 0U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (usbd_configuration == 0U)
+    {
+        status = BSP_ERROR;
+    }
+    else if (usbd_queue_count >= BSP_USBD_QUEUE_DEPTH)
+    {
+        status = BSP_BUSY;
+    }
+    else
+    {
+        usbd_transfer_t *transfer =
+            &usbd_queue[(usbd_queue_head + usbd_queue_count) %
+                        BSP_USBD_QUEUE_DEPTH];
+
+        transfer->data   = data;
+        transfer->length = length;
+        usbd_queue_count++;
+        if (usbd_queue_count == 1U)
+        {
+            usbd_bulk_start();
+        }
+    }
+    __set_PRIMASK(primask);
+
+    return status;
+}
+
+/**
+ * @brief Serve the USB interrupt in device mode (ISR)
+ */
+static void usbd_irq_handler(void)
+{
+    uint32_t istr = USB_DRD_FS->ISTR;
+
+    if ((istr & USB_ISTR_RESET) != 0U)
+    {
+        /* Flags are cleared by writing 0, the others are left */
+        USB_DRD_FS->ISTR = ~USB_ISTR_RESET;
+        usbd_reset();
+    }
+
+    for (istr = USB_DRD_FS->ISTR; (istr & USB_ISTR_CTR) != 0U;
+         istr = USB_DRD_FS->ISTR)
+    {
+        const uint32_t ep  = istr & USB_ISTR_IDN;
+        const uint32_t reg = USB_DRD_GET_CHEP(USB_DRD_FS, ep);
+
+        if (ep == USBD_EP_CTRL)
+        {
+            if ((reg & USB_CHEP_VTTX) != 0U)
+            {
+                USB_DRD_CLEAR_TX_CHEP_CTR(USB_DRD_FS, USBD_EP_CTRL);
+                usbd_ctrl_in();
+            }
+            if ((reg & USB_CHEP_VTRX) != 0U)
+            {
+                if ((reg & USB_CHEP_SETUP) != 0U)
+                {
+                    usbd_setup();
+                }
+                else
+                {
+                    /* The OUT status stage */
+                    USB_DRD_CLEAR_RX_CHEP_CTR(USB_DRD_FS, USBD_EP_CTRL);
+                    USB_DRD_SET_CHEP_RX_STATUS(USB_DRD_FS, USBD_EP_CTRL,
+                                               USB_EP_RX_VALID);
+                }
+            }
+        }
+        else if ((ep == USBD_EP_BULK_IN) && ((reg & USB_CHEP_VTTX) != 0U))
+        {
+            USB_DRD_CLEAR_TX_CHEP_CTR(USB_DRD_FS, USBD_EP_BULK_IN);
+            usbd_bulk_in();
+        }
+        else
+        {
+            /* Nothing else is open; clear whatever flagged the endpoint */
+            USB_DRD_SET_CHEP(USB_DRD_FS, ep,
+                             reg & USB_CHEP_REG_MASK &
+                                 ~(USB_CHEP_VTRX | USB_CHEP_VTTX));
+        }
+    }
+}
+#endif /* BSP_USBD_ENABLE */
+
+/*============================================================================*/
+/*                          USB Host Functions                                */
+/*============================================================================*/
+
+/**
+ * @brief Wake the task waiting for a USB transfer
+ */
+static void usbh_notify_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (usbh_waiter != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(usbh_waiter, BSP_USBH_NOTIFY_INDEX,
+                                      &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+void HAL_HCD_Connect_Callback(HCD_HandleTypeDef *hhcd)
+{
+    (void)hhcd;
+
+    usbh_connected = true;
+}
+
+void HAL_HCD_Disconnect_Callback(HCD_HandleTypeDef *hhcd)
+{
+    (void)hhcd;
+
+    /* The HAL has released all channels */
+    usbh_connected = false;
+    usbh_bulk_out  = 0U;
+    usbh_bulk_in   = 0U;
+    usbh_notify_from_isr();
+}
+
+void HAL_HCD_HC_NotifyURBChange_Callback(HCD_HandleTypeDef  *hhcd,
+                                         uint8_t             chnum,
+                                         HCD_URBStateTypeDef urb_state)
+{
+    (void)hhcd;
+    (void)chnum;
+
+    if (urb_state != URB_IDLE)
+    {
+        usbh_notify_from_isr();
+    }
+}
+
+/**
+ * @brief Wait for the URB of a channel to leave the idle state
+ *
+ * @return State the URB ended in, URB_IDLE on a timeout or a disconnect
+ */
+static HCD_URBStateTypeDef usbh_wait(uint8_t channel, TimeOut_t *timeout,
+                                     TickType_t *remaining)
+{
+    HCD_URBStateTypeDef state;
+
+    state = HAL_HCD_HC_GetURBState(&hhcd_USB_DRD_FS, channel);
+    while (state == URB_IDLE)
+    {
+        if (!usbh_connected ||
+            (xTaskCheckForTimeOut(timeout, remaining) != pdFALSE))
+        {
+            return URB_IDLE;
+        }
+        (void)ulTaskNotifyTakeIndexed(BSP_USBH_NOTIFY_INDEX, pdTRUE,
+                                      *remaining);
+        state = HAL_HCD_HC_GetURBState(&hhcd_USB_DRD_FS, channel);
+    }
+
+    return state;
+}
+
+/**
+ * @brief Run one stage of a transfer on a channel
+ *
+ * A NAK or a transaction error below the HAL retry limit leaves the URB
+ * not ready; the rest of the stage is then submitted again, one tick later
+ * if nothing was transferred so that a busy device is not polled flat out.
+ *
+ * @param channel   HCD channel
+ * @param direction 1 for IN, 0 for OUT
+ * @param ep_type   EP_TYPE_CTRL or EP_TYPE_BULK
+ * @param token     0 for a SETUP packet, 1 for data
+ * @param data      Stage buffer
+ * @param length    Stage length
+ * @param actual    Bytes transferred
+ * @param timeout   Transfer timeout state
+ * @param remaining Ticks left of the timeout
+ */
+static bsp_error_t usbh_stage(uint8_t channel, uint8_t direction,
+                              uint8_t ep_type, uint8_t token, uint8_t *data,
+                              uint16_t length, uint16_t *actual,
+                              TimeOut_t *timeout, TickType_t *remaining)
+{
+    bsp_error_t status = BSP_TIMEOUT;
+    uint16_t    done   = 0U;
+
+    usbh_waiter = xTaskGetCurrentTaskHandle();
+
+    for (;;)
+    {
+        HCD_URBStateTypeDef state;
+        uint16_t            moved;
+
+        (void)xTaskNotifyStateClearIndexed(NULL, BSP_USBH_NOTIFY_INDEX);
+        if (HAL_HCD_HC_SubmitRequest(&hhcd_USB_DRD_FS, channel, direction,
+                                     ep_type, token, &data[done],
+                                     (uint16_t)(length - done),
+                                     0U) != HAL_OK)
+        {
+            status = BSP_ERROR;
+            break;
+        }
+
+        state = usbh_wait(channel, timeout, remaining);
+        moved = (uint16_t)HAL_HCD_HC_GetXferCount(&hhcd_USB_DRD_FS, channel);
+        done  = (uint16_t)(done + moved);
+
+        if (state == URB_DONE)
+        {
+            status = BSP_OK;
+            break;
+        }
+        if (state == URB_STALL)
+        {
+            status = BSP_USBH_STALL;
+            break;
+        }
+        if ((state == URB_IDLE) || (state == URB_ERROR))
+        {
+            (void)HAL_HCD_HC_Halt(&hhcd_USB_DRD_FS, channel);
+            status = (usbh_connected && (state == URB_IDLE)) ? BSP_TIMEOUT
+                                                             : BSP_ERROR;
+            break;
+        }
+        if ((length != 0U) && (done >= length))
+        {
+            status = BSP_OK;
+            break;
+        }
+        if (moved == 0U)
+        {
+            vTaskDelay(1U);
+        }
+    }
+
+    usbh_waiter = NULL;
+    *actual     = done;
+    return status;
+}
+
+/**
+ * @brief Open one channel of a pipe on the current address and speed
+ */
+static bsp_error_t usbh_open(uint8_t channel, uint8_t endpoint,
+                             uint8_t ep_type, uint16_t max_packet)
+{
+    if (HAL_HCD_HC_Init(&hhcd_USB_DRD_FS, channel, endpoint, usbh_address,
+                        usbh_speed, ep_type, max_packet) != HAL_OK)
+    {
+        return BSP_ERROR;
+    }
+
+    hhcd_USB_DRD_FS.hc[channel].toggle_in  = 0U;
+    hhcd_USB_DRD_FS.hc[channel].toggle_out = 0U;
+    return BSP_OK;
+}
+
+bsp_error_t BSP_USBH_Start(void)
+{
+    if (BSP_USBD_ENABLE != 0)
+    {
+        /* The port is the device of BSP_USBD */
+        return BSP_ERROR;
+    }
+
+    if (usbh_started)
+    {
+        return BSP_OK;
+    }
+
+    if (!usbh_initialized)
+    {
+        MX_USB_HCD_Init();
+        usbh_initialized = true;
+    }
+
+    HAL_NVIC_SetPriority(USB_DRD_FS_IRQn, USBH_IRQ_PRIORITY, 0U);
+    HAL_NVIC_EnableIRQ(USB_DRD_FS_IRQn);
+
+    if (HAL_HCD_Start(&hhcd_USB_DRD_FS) != HAL_OK)
+    {
+        HAL_NVIC_DisableIRQ(USB_DRD_FS_IRQn);
+        return BSP_ERROR;
+    }
+
+    usbh_started = true;
+    return BSP_OK;
+}
+
+bool BSP_USBH_IsConnected(void)
+{
+    return usbh_connected;
+}
+
+bsp_error_t BSP_USBH_ResetPort(void)
+{
+    TickType_t start;
+
+    if (!usbh_connected)
+    {
+        return BSP_ERROR;
+    }
+
+    usbh_bulk_out = 0U;
+    usbh_bulk_in  = 0U;
+
+    /* Holds SE0 for 100 ms, then 30 ms of reset recovery */
+    (void)HAL_HCD_ResetPort(&hhcd_USB_DRD_FS);
+
+    /* The port is enabled with the first SOF after the reset */
+    start = xTaskGetTickCount();
+    while (hhcd_USB_DRD_FS.HostState != HCD_HCD_STATE_RUN)
+    {
+        if (!usbh_connected)
+        {
+            return BSP_ERROR;
+        }
+        if ((xTaskGetTickCount() - start) >
+            pdMS_TO_TICKS(USBH_ENABLE_TIMEOUT_MS))
+        {
+            return BSP_TIMEOUT;
+        }
+        vTaskDelay(1U);
+    }
+
+    usbh_speed = (HAL_HCD_GetCurrentSpeed(&hhcd_USB_DRD_FS) ==
+                  USB_DRD_SPEED_LS)
+                     ? HCD_DEVICE_SPEED_LOW
+                     : HCD_DEVICE_SPEED_FULL;
+
+    return BSP_USBH_OpenControl(0U, 8U);
+}
+
+bsp_error_t BSP_USBH_OpenControl(uint8_t address, uint8_t max_packet)
+{
+    bsp_error_t status;
+
+    if ((address > 127U) || (max_packet == 0U) ||
+        (max_packet > USBH_MAX_PACKET))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    usbh_address = address;
+    status = usbh_open(USBH_CH_CTRL_OUT, 0x00U, EP_TYPE_CTRL, max_packet);
+    if (status == BSP_OK)
+    {
+        status = usbh_open(USBH_CH_CTRL_IN, BSP_USBH_EP_IN, EP_TYPE_CTRL,
+                           max_packet);
+    }
+
+    return status;
+}
+
+bsp_error_t BSP_USBH_OpenBulk(uint8_t endpoint, uint16_t max_packet)
+{
+    bool        in = (endpoint & BSP_USBH_EP_IN) != 0U;
+    bsp_error_t status;
+
+    if (((endpoint & 0x0FU) == 0U) || ((endpoint & 0x70U) != 0U) ||
+        (max_packet == 0U) || (max_packet > USBH_MAX_PACKET))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    status = usbh_open(in ? USBH_CH_BULK_IN : USBH_CH_BULK_OUT, endpoint,
+                       EP_TYPE_BULK, max_packet);
+    if (status != BSP_OK)
+    {
+        return status;
+    }
+
+    if (in)
+    {
+        usbh_bulk_in = endpoint;
+    }
+    else
+    {
+        usbh_bulk_out = endpoint;
+    }
+    return BSP_OK;
+}
+
+bsp_error_t BSP_USBH_Control(const bsp_usbh_setup_t *setup, uint8_t *data,
+                             uint16_t *actual, uint32_t timeout_ms)
+{
+    TimeOut_t   timeout;
+    TickType_t  remaining = pdMS_TO_TICKS(timeout_ms);
+    uint8_t     packet[8];
+    uint16_t    done = 0U;
+    uint16_t    ignored;
+    bool        in;
+    bsp_error_t status;
+
+    if ((setup == NULL) || ((setup->length != 0U) && (data == NULL)))
+    {
+        return BSP_INVALID_ARG;
+    }
+    if (!usbh_connected)
+    {
+        return BSP_ERROR;
+    }
+
+    in        = (setup->request_type & BSP_USBH_EP_IN) != 0U;
+    packet[0] = setup->request_type;
+    packet[1] = setup->request;
+    packet[2] = (uint8_t)(setup->value & 0xFFU);
+    packet[3] = (uint8_t)(setup->value >> 8U);
+    packet[4] = (uint8_t)(setup->index & 0xFFU);
+    packet[5] = (uint8_t)(setup->index >> 8U);
+    packet[6] = (uint8_t)(setup->length & 0xFFU);
+    packet[7] = (uint8_t)(setup->length >> 8U);
+
+    vTaskSetTimeOutState(&timeout);
+    status = usbh_stage(USBH_CH_CTRL_OUT, 0U, EP_TYPE_CTRL, 0U, packet,
+                        sizeof(packet), &ignored, &timeout, &remaining);
+
+    if ((status == BSP_OK) && (setup->length != 0U))
+    {
+        if (in)
+        {
+            status = usbh_stage(USBH_CH_CTRL_IN, 1U, EP_TYPE_CTRL, 1U, data,
+                                setup->length, &done, &timeout, &remaining);
+        }
+        else
+        {
+            /* The data stage starts with DATA1 */
+            hhcd_USB_DRD_FS.hc[USBH_CH_CTRL_OUT].toggle_out = 1U;
+            status = usbh_stage(USBH_CH_CTRL_OUT, 0U, EP_TYPE_CTRL, 1U, data,
+                                setup->length, &done, &timeout, &remaining);
+        }
+    }
+
+    /* Zero-length status stage in the other direction */
+    if (status == BSP_OK)
+    {
+        if (in && (setup->length != 0U))
+        {
+            status = usbh_stage(USBH_CH_CTRL_OUT, 0U, EP_TYPE_CTRL, 1U,
+                                packet, 0U, &ignored, &timeout, &remaining);
+        }
+        else
+        {
+            status = usbh_stage(USBH_CH_CTRL_IN, 1U, EP_TYPE_CTRL, 1U, packet,
+                                0U, &ignored, &timeout, &remaining);
+        }
+    }
+
+    if (actual != NULL)
+    {
+        *actual = done;
+    }
+    return status;
+}
+
+bsp_error_t BSP_USBH_Bulk(uint8_t endpoint, uint8_t *data, uint32_t length,
+                          uint32_t *actual, uint32_t timeout_ms)
+{
+    TimeOut_t   timeout;
+    TickType_t  remaining = pdMS_TO_TICKS(timeout_ms);
+    bool        in        = (endpoint & BSP_USBH_EP_IN) != 0U;
+    uint16_t    done      = 0U;
+    bsp_error_t status;
+
+    if ((data == NULL) || (length > USBH_MAX_TRANSFER) || (endpoint == 0U) ||
+        (endpoint != (in ? usbh_bulk_in : usbh_bulk_out)))
+    {
+        return BSP_INVALID_ARG;
+    }
+    if (!usbh_connected)
+    {
+        return BSP_ERROR;
+    }
+
+    vTaskSetTimeOutState(&timeout);
+    status = usbh_stage(in ? USBH_CH_BULK_IN : USBH_CH_BULK_OUT,
+                        in ? 1U : 0U, EP_TYPE_BULK, 1U, data,
+                        (uint16_t)length, &done, &timeout, &remaining);
+
+    if (actual != NULL)
+    {
+        *actual = done;
+    }
+    return status;
+}
+
+bsp_error_t BSP_USBH_ClearHalt(uint8_t endpoint, uint32_t timeout_ms)
+{
+    /* CLEAR_FEATURE(ENDPOINT_HALT) to the endpoint */
+    const bsp_usbh_setup_t setup = {
+        .request_type = 0x02U,
+        .request      = 0x01U,
+        .value        = 0U,
+        .index        = endpoint,
+        .length       = 0U,
+    };
+    uint8_t     channel;
+    bsp_error_t status;
+
+    if ((endpoint != 0U) && (endpoint == usbh_bulk_in))
+    {
+        channel = USBH_CH_BULK_IN;
+    }
+    else if ((endpoint != 0U) && (endpoint == usbh_bulk_out))
+    {
+        channel = USBH_CH_BULK_OUT;
+    }
+    else
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    status = BSP_USBH_Control(&setup, NULL, NULL, timeout_ms);
+    if (status == BSP_OK)
+    {
+        /* The endpoint restarts with DATA0 */
+        hhcd_USB_DRD_FS.hc[channel].toggle_in  = 0U;
+        hhcd_USB_DRD_FS.hc[channel].toggle_out = 0U;
+    }
+
+    return status;
+}
+
+void BSP_USBH_IRQHandler(void)
+{
+#if BSP_USBD_ENABLE
+    usbd_irq_handler();
+#else
+    HAL_HCD_IRQHandler(&hhcd_USB_DRD_FS);
+#endif
+}
+
+/*============================================================================*/
+/*                          Console Functions                                 */
+/*============================================================================*/
+
+bsp_error_t BSP_Console_Transmit(const uint8_t *data, uint16_t length,
+                                 uint32_t timeout_ms)
+{
+    TimeOut_t         timeout;
+    TickType_t        remaining = pdMS_TO_TICKS(timeout_ms);
+    HAL_StatusTypeDef status;
+
+    if ((data == NULL) || (length == 0U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    console_tx_waiter = xTaskGetCurrentTaskHandle();
+    console_tx_done   = false;
+    console_tx_error  = false;
+    (void)xTaskNotifyStateClearIndexed(NULL, BSP_CONSOLE_NOTIFY_INDEX);
+
+    BSP_Cache_CleanRange(data, length);
+    status = HAL_UART_Transmit_DMA(&hcom_uart[COM1], data, length);
+    if (status != HAL_OK)
+    {
+        console_tx_done = true;
+        return (status == HAL_BUSY) ? BSP_BUSY : BSP_ERROR;
+    }
+
+    vTaskSetTimeOutState(&timeout);
+    while (!console_tx_done)
+    {
+        if (xTaskCheckForTimeOut(&timeout, &remaining) != pdFALSE)
+        {
+            (void)HAL_UART_AbortTransmit(&hcom_uart[COM1]);
+            console_tx_done = true;
+            return BSP_TIMEOUT;
+        }
+        (void)ulTaskNotifyTakeIndexed(BSP_CONSOLE_NOTIFY_INDEX, pdTRUE,
+                                      remaining);
+    }
+
+    return console_tx_error ? BSP_ERROR : BSP_OK;
+}
+
+void BSP_Console_Write(const uint8_t *data, uint16_t length)
+{
+    USART_TypeDef *uart  = COM1_UART;
+    uint32_t       spins = 0U;
+
+    if (data == NULL)
+    {
+        return;
+    }
+
+    /* The channel disables itself at the end of the block */
+    while (((console_dma_tx.Instance->CCR & DMA_CCR_EN) != 0U) &&
+           (spins < CONSOLE_DMA_DRAIN_SPINS))
+    {
+        spins++;
+    }
+
+    for (uint16_t i = 0U; i < length; i++)
+    {
+        while ((uart->ISR & USART_ISR_TXE_TXFNF) == 0U)
+        {
+        }
+        uart->TDR = data[i];
+    }
+    while ((uart->ISR & USART_ISR_TC) == 0U)
+    {
+    }
+}
+
+void BSP_Console_SetFaultHook(bsp_console_fault_hook_t hook)
+{
+    console_fault_hook = hook;
+}
+
+void BSP_Console_Fault(void)
+{
+    bsp_console_fault_hook_t hook = console_fault_hook;
+
+    if (console_fault_entered)
+    {
+        return;
+    }
+    console_fault_entered = true;
+
+    if (hook != NULL)
+    {
+        hook();
+    }
+}
+
+void BSP_Console_IRQHandler(void) { HAL_UART_IRQHandler(&hcom_uart[COM1]); }
+
+void BSP_Console_TxDMA_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&console_dma_tx);
+}
+
+/*============================================================================*/
+/*                          CRC Functions                                     */
+/*============================================================================*/
+
+bsp_error_t BSP_CRC16_Modbus(const uint8_t *data, uint16_t length,
+                             uint16_t *crc)
+{
+    uint32_t word;
+    uint16_t i = 0U;
+
+    if ((data == NULL) || (crc == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL();
+    if (crc_busy)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_BUSY;
+    }
+    crc_busy = true;
+    taskEXIT_CRITICAL();
+
+    __HAL_RCC_CRC_CLK_ENABLE();
+
+    /* 16-bit polynomial, input reflected per byte, output reflected */
+    CRC->POL  = CRC16_MODBUS_POLY;
+    CRC->INIT = CRC16_MODBUS_INIT;
+    CRC->CR   = CRC_CR_POLYSIZE_0 | CRC_CR_REV_IN_0 | CRC_CR_REV_OUT |
+              CRC_CR_RESET;
+
+    /* The unit takes a word MSB first, so swap to keep the byte order */
+    for (; (uint32_t)i + 4U <= length; i += 4U)
+    {
+        (void)memcpy(&word, &data[i], sizeof(word));
+        CRC->DR = __REV(word);
+    }
+    for (; i < length; i++)
+    {
+        *(__IO uint8_t *)&CRC->DR = data[i];
+    }
+
+    *crc = (uint16_t)CRC->DR;
+
+    crc_busy = false;
+
+    return BSP_OK;
+}
+
+/*============================================================================*/
+/*                          Flash Functions                                   */
+/*============================================================================*/
+
+/**
+ * @brief Physical bank behind the update slot
+ *
+ * Erase selects a bank physically, so the choice inverts once the banks are
+ * swapped.
+ */
+static uint32_t flash_update_bank(void)
+{
+    return BSP_Flash_IsSwapped() ? FLASH_BANK_1 : FLASH_BANK_2;
+}
+
+/**
+ * @brief Physical bank of a configuration or snapshot sector
+ */
+static uint32_t flash_config_bank(uint32_t sector)
+{
+    return (sector == 0U) ? FLASH_BANK_1 : FLASH_BANK_2;
+}
+
+/**
+ * @brief Address of a sector at an offset of physical bank sector + 1
+ */
+static uint32_t flash_reserved_sector(uint32_t sector, uint32_t offset)
+{
+    /* Physical bank 1 is mapped second once the banks are swapped */
+    uint32_t mapped = sector ^ (BSP_Flash_IsSwapped() ? 1U : 0U);
+
+    return 0x08000000U + (mapped * BSP_FLASH_BANK_SIZE) + offset;
+}
+
+/**
+ * @brief End the write in flight (ISR context)
+ * @param error The write failed
+ */
+static void flash_finish_from_isr(bool error)
+{
+    BaseType_t woken = pdFALSE;
+
+    (void)HAL_FLASH_Lock();
+    if (error)
+    {
+        flash_failed = flash_owner;
+    }
+    flash_busy = false;
+    if (flash_owner != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(flash_owner, BSP_FLASH_NOTIFY_INDEX,
+                                      &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Start the next step of the write in flight
+ *
+ * A configuration or snapshot erase is a single step. In the update slot
+ * a sector is erased when the write reaches its first byte; every other
+ * step programs one quad-word. The state is advanced before the step is
+ * started, as its interrupt may run before the HAL call returns.
+ *
+ * @return true if the step was started
+ */
+static bool flash_step(void)
+{
+    uint32_t               address = flash_address;
+    FLASH_EraseInitTypeDef erase   = {0};
+    HAL_StatusTypeDef      status;
+
+    if (flash_erase_bank != 0U)
+    {
+        erase.Banks  = flash_erase_bank;
+        erase.Sector = ((address - 0x08000000U) % BSP_FLASH_BANK_SIZE) /
+                       BSP_FLASH_SECTOR_SIZE;
+        flash_erase_bank = 0U;
+    }
+    else if (flash_erase_ahead &&
+             (((address - BSP_FLASH_UPDATE_BASE) % BSP_FLASH_SECTOR_SIZE) ==
+              0U) &&
+             (flash_erased != address))
+    {
+        erase.Banks  = flash_update_bank();
+        erase.Sector = (address - BSP_FLASH_UPDATE_BASE +
+                        BSP_FLASH_APP_OFFSET) /
+                       BSP_FLASH_SECTOR_SIZE;
+        flash_erased = address;
+    }
+
+    if (erase.Banks != 0U)
+    {
+        erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+        erase.NbSectors = 1U;
+        status          = HAL_FLASHEx_Erase_IT(&erase);
+    }
+    else
+    {
+        const uint8_t *source = flash_source;
+
+        flash_address += BSP_FLASH_WORD_SIZE;
+        flash_source += BSP_FLASH_WORD_SIZE;
+        status = HAL_FLASH_Program_IT(FLASH_TYPEPROGRAM_QUADWORD, address,
+                                      (uint32_t)source);
+    }
+
+    return status == HAL_OK;
+}
+
+/**
+ * @brief Start a write or erase as the calling task's
+ *
+ * Claiming the flash and starting the first step are one critical section,
+ * so two tasks starting at once see one of them get BSP_BUSY.
+ *
+ * @param address     First address programmed
+ * @param data        Source of the quad-words
+ * @param length      Bytes programmed, 0 for an erase alone
+ * @param erase_ahead Erase each update slot sector as the write reaches it
+ * @param erase_bank  Bank of the sector at @p address to erase, 0 if none
+ * @return bsp_error_t BSP_OK if the first step was started
+ */
+static bsp_error_t flash_start(uint32_t address, const void *data,
+                               uint32_t length, bool erase_ahead,
+                               uint32_t erase_bank)
+{
+    TaskHandle_t self   = xTaskGetCurrentTaskHandle();
+    bsp_error_t  result = BSP_OK;
+
+    (void)xTaskNotifyStateClearIndexed(NULL, BSP_FLASH_NOTIFY_INDEX);
+
+    /* The interrupt chains the following steps */
+    taskENTER_CRITICAL();
+    if (flash_busy)
+    {
+        result = BSP_BUSY;
+    }
+    else if (HAL_FLASH_Unlock() != HAL_OK)
+    {
+        result = BSP_ERROR;
+    }
+    else
+    {
+        /* A write from the start erases the slot again */
+        if (erase_ahead && (address == BSP_FLASH_UPDATE_BASE))
+        {
+            flash_erased = 0U;
+        }
+        flash_address     = address;
+        flash_end         = address + length;
+        flash_source      = (const uint8_t *)data;
+        flash_erase_ahead = erase_ahead;
+        flash_erase_bank  = erase_bank;
+        flash_owner       = self;
+        if (flash_failed == self)
+        {
+            flash_failed = NULL;
+        }
+
+        flash_busy = true;
+        if (!flash_step())
+        {
+            flash_busy       = false;
+            flash_erase_bank = 0U;
+            (void)HAL_FLASH_Lock();
+            result = BSP_ERROR;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+}
+
+void HAL_FLASH_EndOfOperationCallback(uint32_t ReturnValue)
+{
+    (void)ReturnValue;
+
+    if (!flash_busy)
+    {
+        return;
+    }
+    if (flash_address == flash_end)
+    {
+        flash_finish_from_isr(false);
+    }
+    else if (!flash_step())
+    {
+        flash_finish_from_isr(true);
+    }
+}
+
+void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue)
+{
+    (void)ReturnValue;
+
+    if (flash_busy)
+    {
+        flash_finish_from_isr(true);
+    }
+}
+
+bsp_error_t BSP_Flash_WriteAsync(uint32_t offset, const void *data,
+                                 uint32_t length)
+{
+    if ((data == NULL) || (length == 0U) ||
+        ((offset % BSP_FLASH_WORD_SIZE) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) || (offset > BSP_FLASH_APP_SIZE) ||
+        (length > (BSP_FLASH_APP_SIZE - offset)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start(BSP_FLASH_UPDATE_BASE + offset, data, length, true,
+                       0U);
+}
+
+bsp_error_t BSP_Flash_ConfigEraseAsync(uint32_t sector)
+{
+    if (sector >= BSP_FLASH_CONFIG_SECTORS)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* Nothing to program, the erase ends the operation */
+    return flash_start((uint32_t)BSP_Flash_ConfigSector(sector), NULL, 0U,
+                       false, flash_config_bank(sector));
+}
+
+bsp_error_t BSP_Flash_ConfigWriteAsync(uint32_t sector, uint32_t offset,
+                                       const void *data, uint32_t length)
+{
+    if ((sector >= BSP_FLASH_CONFIG_SECTORS) || (data == NULL) ||
+        (length == 0U) || ((offset % BSP_FLASH_WORD_SIZE) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) || (offset > BSP_FLASH_SECTOR_SIZE) ||
+        (length > (BSP_FLASH_SECTOR_SIZE - offset)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start((uint32_t)BSP_Flash_ConfigSector(sector) + offset,
+                       data, length, false, 0U);
+}
+
+const uint8_t *BSP_Flash_ConfigSector(uint32_t sector)
+{
+    if (sector >= BSP_FLASH_CONFIG_SECTORS)
+    {
+        return NULL;
+    }
+
+    return (const uint8_t *)flash_reserved_sector(sector,
+                                                  BSP_FLASH_CONFIG_OFFSET);
+}
+
+bsp_error_t BSP_Flash_SnapshotEraseAsync(uint32_t sector)
+{
+    if (sector >= BSP_FLASH_SNAPSHOT_SECTORS)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start((uint32_t)BSP_Flash_SnapshotSector(sector), NULL, 0U,
+                       false, flash_config_bank(sector));
+}
+
+bsp_error_t BSP_Flash_SnapshotWriteAsync(uint32_t sector, uint32_t offset,
+                                         const void *data, uint32_t length)
+{
+    if ((sector >= BSP_FLASH_SNAPSHOT_SECTORS) || (data == NULL) ||
+        (length == 0U) || ((offset % BSP_FLASH_WORD_SIZE) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) || (offset > BSP_FLASH_SECTOR_SIZE) ||
+        (length > (BSP_FLASH_SECTOR_SIZE - offset)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    return flash_start((uint32_t)BSP_Flash_SnapshotSector(sector) + offset,
+                       data, length, false, 0U);
+}
+
+bsp_error_t BSP_Flash_SnapshotProgram(uint32_t sector, uint32_t offset,
+                                      const void *data, uint32_t length)
+{
+    const uint32_t *source = (const uint32_t *)data;
+    uint32_t        primask;
+    uint32_t        errors = 0U;
+
+    if ((sector >= BSP_FLASH_SNAPSHOT_SECTORS) || (data == NULL) ||
+        (length == 0U) || ((offset % BSP_FLASH_WORD_SIZE) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) || (offset > BSP_FLASH_SECTOR_SIZE) ||
+        (length > (BSP_FLASH_SECTOR_SIZE - offset)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* The HAL writes a quad-word with the interrupts masked, so none is
+     * half written here; the step in flight ends and its write is
+     * abandoned */
+    while ((FLASH_NS->NSSR & FLASH_SR_BSY) != 0U)
+    {
+    }
+    if (flash_busy)
+    {
+        flash_failed     = flash_owner;
+        flash_busy       = false;
+        flash_erase_bank = 0U;
+    }
+    pFlash.ProcedureOnGoing = 0U;
+    HAL_NVIC_ClearPendingIRQ(FLASH_IRQn);
+
+    if ((FLASH_NS->NSCR & FLASH_CR_LOCK) != 0U)
+    {
+        FLASH_NS->NSKEYR = FLASH_KEY1;
+        FLASH_NS->NSKEYR = FLASH_KEY2;
+    }
+    FLASH_NS->NSCCR = FLASH_FLAG_SR_ERRORS | FLASH_FLAG_EOP;
+    FLASH_NS->NSCR  = FLASH_CR_PG;
+
+    for (uint32_t at = 0U; (at < length) && (errors == 0U);
+         at += BSP_FLASH_WORD_SIZE)
+    {
+        volatile uint32_t *target =
+            (volatile uint32_t *)((uint32_t)BSP_Flash_SnapshotSector(sector) +
+                                  offset + at);
+
+        for (uint32_t i = 0U; i < (BSP_FLASH_WORD_SIZE / 4U); i++)
+        {
+            target[i] = *source++;
+        }
+        __DSB();
+        while ((FLASH_NS->NSSR & (FLASH_SR_BSY | FLASH_SR_WBNE |
+                                  FLASH_SR_DBNE)) != 0U)
+        {
+        }
+        errors = FLASH_NS->NSSR & FLASH_FLAG_SR_ERRORS;
+    }
+
+    FLASH_NS->NSCCR = FLASH_FLAG_SR_ERRORS | FLASH_FLAG_EOP;
+    FLASH_NS->NSCR  = FLASH_CR_LOCK;
+    __set_PRIMASK(primask);
+
+    return (errors == 0U) ? BSP_OK : BSP_ERROR;
+}
+
+const uint8_t *BSP_Flash_SnapshotSector(uint32_t sector)
+{
+    if (sector >= BSP_FLASH_SNAPSHOT_SECTORS)
+    {
+        return NULL;
+    }
+
+    return (const uint8_t *)flash_reserved_sector(sector,
+                                                  BSP_FLASH_SNAPSHOT_OFFSET);
+}
+
+bsp_error_t BSP_Flash_Read(const void *address, void *data, uint32_t length)
+{
+    const volatile uint32_t *source = (const volatile uint32_t *)address;
+    uint32_t                *target = (uint32_t *)data;
+
+    if ((address == NULL) || (data == NULL) ||
+        (((uintptr_t)address % BSP_FLASH_WORD_SIZE) != 0U) ||
+        (((uintptr_t)data & 3U) != 0U) ||
+        ((length % BSP_FLASH_WORD_SIZE) != 0U))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    for (uint32_t at = 0U; at < (length / 4U); at += 4U)
+    {
+        uint32_t word[BSP_FLASH_WORD_SIZE / 4U];
+
+        flash_ecc_address = 0U;
+        for (uint32_t i = 0U; i < (BSP_FLASH_WORD_SIZE / 4U); i++)
+        {
+            word[i] = source[at + i];
+        }
+        /* The NMI of a failed check is taken once the loads complete */
+        __DSB();
+        __ISB();
+        if (flash_ecc_address == (uint32_t)&source[at])
+        {
+            return BSP_ERROR;
+        }
+        (void)memcpy(&target[at], word, sizeof(word));
+    }
+
+    return BSP_OK;
+}
+
+bsp_error_t BSP_Flash_Wait(uint32_t timeout_ms)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TimeOut_t    timeout;
+    TickType_t   remaining = pdMS_TO_TICKS(timeout_ms);
+
+    vTaskSetTimeOutState(&timeout);
+    while (flash_busy)
+    {
+        if (xTaskCheckForTimeOut(&timeout, &remaining) != pdFALSE)
+        {
+            return BSP_TIMEOUT;
+        }
+        if (flash_owner == self)
+        {
+            (void)ulTaskNotifyTakeIndexed(BSP_FLASH_NOTIFY_INDEX, pdTRUE,
+                                          remaining);
+        }
+        else
+        {
+            /* Another task's write, its end is notified to that task */
+            vTaskDelay(1U);
+        }
+    }
+
+    return (flash_failed == self) ? BSP_ERROR : BSP_OK;
+}
+
+bool BSP_Flash_IsBusy(void) { return flash_busy; }
+
+bsp_error_t BSP_Flash_SwapBanks(void)
+{
+    if (flash_busy)
+    {
+        return BSP_BUSY;
+    }
+
+    /* Resets the device once the swap is programmed */
+    SECURE_SwapBank();
+
+    return BSP_ERROR;
+}
+
+bool BSP_Flash_IsSwapped(void)
+{
+    return (FLASH->OPTSR_CUR & FLASH_OPTSR_SWAP_BANK) != 0U;
+}
+
+void BSP_Flash_IRQHandler(void) { HAL_FLASH_IRQHandler(); }
+
+bool BSP_Flash_NMIHandler(uint32_t detection)
+{
+    uint32_t offset    = (detection & FLASH_ECCR_ADDR_ECC) * BSP_FLASH_WORD_SIZE;
+
+    /* Only a user bank quad-word of the reserved sectors; anything else,
+     * code or constants among them, stays fatal */
+    if (((detection & FLASH_ECCR_ECCD) == 0U) ||
+        ((detection & (FLASH_ECCR_OBK_ECC | FLASH_ECCR_DATA_ECC |
+                       FLASH_ECCR_SYSF_ECC | FLASH_ECCR_OTP_ECC)) != 0U) ||
+        (offset < BSP_FLASH_SNAPSHOT_OFFSET))
+    {
+        return false;
+    }
+
+    /* The bank reported is physical, like a reserved sector's number */
+    flash_ecc_address = flash_reserved_sector(
+        ((detection & FLASH_ECCR_BK_ECC) != 0U) ? 1U : 0U, offset);
+
+    return true;
+}
+
+/*============================================================================*/
+/*                          Secure Services Functions                         */
+/*============================================================================*/
+
+_Static_assert(sizeof(bsp_secure_request_t) == sizeof(SECURE_RequestTypeDef),
+               "request layout differs from the secure world");
+_Static_assert(BSP_SECURE_BATCH_MAX == SECURE_BATCH_MAX,
+               "batch size differs from the secure world");
+_Static_assert(BSP_ECDSA_REQUEST_SIZE == SECURE_ECDSA_REQUEST_SIZE,
+               "ECDSA request differs from the secure world");
+_Static_assert(((uint32_t)BSP_SECURE_OP_ICACHE_MONITOR ==
+                (uint32_t)SECURE_OP_ICACHE_MONITOR) &&
+                   ((uint32_t)BSP_SECURE_SKIPPED ==
+                    (uint32_t)SECURE_STATUS_SKIPPED),
+               "codes differ from the secure world");
+
+bsp_error_t BSP_Secure_Batch(bsp_secure_request_t *requests, uint32_t count)
+{
+    uint32_t done;
+
+    if ((requests == NULL) || (count == 0U) || (count > BSP_SECURE_BATCH_MAX))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* Secure calls from two tasks must not nest */
+    taskENTER_CRITICAL();
+    if (secure_busy)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_BUSY;
+    }
+    secure_busy = true;
+    taskEXIT_CRITICAL();
+
+    /* Left as it is if the secure world rejects the whole array */
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        requests[i].status = BSP_SECURE_INVALID;
+    }
+
+    done = SECURE_Batch((SECURE_RequestTypeDef *)requests, count);
+
+    secure_busy = false;
+
+    return (done == count) ? BSP_OK : BSP_ERROR;
+}
+
+bsp_error_t BSP_Random_Read(void *buffer, uint32_t length,
+                            uint32_t *read_length)
+{
+    bsp_secure_request_t request = {
+        .op = BSP_SECURE_OP_RANDOM, .buffer = buffer, .length = length};
+    bsp_error_t ret;
 
-/** @brief ADC1 error code for debugging */
-static volatile uint32_t adc1_last_error = 0;
+    if (read_length == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
 
-/*============================================================================*/
-/*                     Filtered ADC Private Variables                         */
-/*============================================================================*/
+    ret          = BSP_Secure_Batch(&request, 1U);
+    *read_length = (ret == BSP_OK) ? request.length : 0U;
 
-/** @brief Filter context for all ADC channels */
-static adc_filter_context_t g_adc_filter_ctx;
+    return ret;
+}
 
-/** @brief Filtered output values for all channels (continuously updated) */
-static volatile float32_t g_filtered_values[BSP_ADC1_NUM_CHANNELS];
+bsp_error_t BSP_Ecdsa_Verify(const uint8_t *key, const uint8_t *hash,
+                             const uint8_t *signature)
+{
+    uint8_t              buffer[BSP_ECDSA_REQUEST_SIZE];
+    bsp_secure_request_t request = {.op     = BSP_SECURE_OP_ECDSA_VERIFY,
+                                    .buffer = buffer,
+                                    .length = sizeof(buffer)};
+    bsp_error_t          ret;
 
-/** @brief Sample counter since filter initialization (for settling detection)
- */
-static volatile uint32_t g_filter_sample_count = 0;
+    if ((key == NULL) || (hash == NULL) || (signature == NULL))
+    {
+        return BSP_INVALID_ARG;
+    }
 
-/** @brief Flag indicating filter subsystem is initialized and running */
-static volatile bool g_filter_initialized = false;
+    (void)memcpy(&buffer[0], key, 2U * BSP_ECDSA_CURVE_SIZE);
+    (void)memcpy(&buffer[2U * BSP_ECDSA_CURVE_SIZE], hash,
+                 BSP_ECDSA_CURVE_SIZE);
+    (void)memcpy(&buffer[3U * BSP_ECDSA_CURVE_SIZE], signature,
+                 2U * BSP_ECDSA_CURVE_SIZE);
 
-/*============================================================================*/
-/*                     I2C based Digital output                               */
-/*============================================================================*/
+    ret = BSP_Secure_Batch(&request, 1U);
+    if ((ret == BSP_ERROR) && (request.status == BSP_SECURE_BAD_SIGNATURE))
+    {
+        ret = BSP_INVALID_ARG;
+    }
 
-/*============================================================================*/
-/*                          ADC1 DMA Callbacks                                */
-/*============================================================================*/
+    return ret;
+}
 
-/**
- * @brief ADC conversion complete callback (called by HAL from DMA IRQ)
- * @param hadc ADC handle
- *
- * This callback is invoked by the HAL when a DMA transfer completes.
- * In continuous filtering mode, it always processes each sample through
- * the 12-stage biquad filter chain in the ISR context (~12µs per call).
- *
- * The filtered values are continuously updated and can be read at any time
- * via BSP_ADC1_GetFilteredValue() with instant response.
- */
-void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+bsp_error_t BSP_Secure_Benchmark(bsp_secure_bench_t *result)
 {
-    if (hadc->Instance == ADC1)
+    bsp_secure_request_t requests[BSP_SECURE_BATCH_MAX] = {0};
+    uint32_t             fastest[2] = {UINT32_MAX, UINT32_MAX};
+    const uint32_t       sizes[2]   = {1U, BSP_SECURE_BATCH_MAX};
+
+    if (result == NULL)
     {
-        adc1_conversion_complete = true;
+        return BSP_INVALID_ARG;
+    }
 
-        /* Continuous filtering: always process samples when filter is
-         * initialized */
-        if (g_filter_initialized)
+    /* The fastest run is the one not stretched by interrupts */
+    for (uint32_t run = 0U; run < SECURE_BENCH_RUNS; run++)
+    {
+        for (uint32_t i = 0U; i < 2U; i++)
         {
-            /* Convert and filter each channel */
-            for (uint8_t ch = 0; ch < BSP_ADC1_NUM_CHANNELS; ch++)
-            {
-                /* Convert 12-bit ADC value to normalized float (0.0 to 1.0) */
-                float32_t input = (float32_t)adc1_dma_buffer[ch] / 4095.0f;
+            uint32_t    start  = BSP_CycleCounter_Read();
+            bsp_error_t ret    = BSP_Secure_Batch(requests, sizes[i]);
+            uint32_t    cycles = BSP_CycleCounter_Read() - start;
 
-                /* Apply 12-stage biquad filter */
-                g_filtered_values[ch] =
-                    adc_filter_process_sample(&g_adc_filter_ctx, ch, input);
+            if (ret != BSP_OK)
+            {
+                return ret;
+            }
+            if (cycles < fastest[i])
+            {
+                fastest[i] = cycles;
             }
-
-            /* Increment sample counter (for settling detection) */
-            g_filter_sample_count++;
         }
     }
-}
 
-/**
- * @brief ADC error callback (called by HAL when ADC error occurs)
- * @param hadc ADC handle
- *
- * This callback is invoked when an ADC error occurs (overrun, DMA error, etc.)
- * It sets a flag that can be checked to restart the ADC.
- */
-void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc)
-{
-    if (hadc->Instance == ADC1)
-    {
-        adc1_error_occurred = true;
-        adc1_last_error     = hadc->ErrorCode;
-        adc1_running        = false;
-    }
-}
+    result->request_cycles =
+        (fastest[1] > fastest[0])
+            ? (fastest[1] - fastest[0]) / (BSP_SECURE_BATCH_MAX - 1U)
+            : 0U;
+    result->call_cycles = (fastest[0] > result->request_cycles)
+                              ? fastest[0] - result->request_cycles
+                              : 0U;
 
-/*============================================================================*/
-/*                          MPU Configuration                                 */
-/*============================================================================*/
+    return BSP_OK;
+}
 
-static void MPU_Config(void)
+bsp_error_t BSP_ICache_Set(bool enable)
 {
-    MPU_Region_InitTypeDef     MPU_InitStruct     = {0};
-    MPU_Attributes_InitTypeDef MPU_AttributesInit = {0};
+    bsp_secure_request_t request = {
+        .op = enable ? BSP_SECURE_OP_ICACHE_ON : BSP_SECURE_OP_ICACHE_OFF};
 
-    /* Disables the MPU */
-    HAL_MPU_Disable();
+    return BSP_Secure_Batch(&request, 1U);
+}
 
-    /* Configure the MPU attributes for Ethernet Buffers */
-    /* Attribute 0: Normal, Non-Cacheable */
-    MPU_AttributesInit.Number     = MPU_ATTRIBUTES_NUMBER0;
-    MPU_AttributesInit.Attributes = MPU_NOT_CACHEABLE;
-    HAL_MPU_ConfigMemoryAttributes(&MPU_AttributesInit);
+bsp_error_t BSP_ICache_ReadMonitor(bsp_icache_monitor_t *counts)
+{
+    uint32_t             words[SECURE_ICACHE_MONITOR_SIZE / 4U];
+    bsp_secure_request_t request = {.op     = BSP_SECURE_OP_ICACHE_MONITOR,
+                                    .buffer = words,
+                                    .length = sizeof(words)};
+    bsp_error_t          result;
 
-    /* Configure the MPU region */
-    MPU_InitStruct.Enable      = MPU_REGION_ENABLE;
-    MPU_InitStruct.Number      = MPU_REGION_NUMBER0;
-    MPU_InitStruct.BaseAddress = (uint32_t)&__eth_dma_start;
-    MPU_InitStruct.LimitAddress =
-        (uint32_t)&__eth_dma_start + 32 * 1024 - 1; /* 32KB region */
-    MPU_InitStruct.AttributesIndex  = MPU_ATTRIBUTES_NUMBER0;
-    MPU_InitStruct.AccessPermission = MPU_REGION_ALL_RW;
-    MPU_InitStruct.DisableExec      = MPU_INSTRUCTION_ACCESS_ENABLE;
-    MPU_InitStruct.IsShareable      = MPU_ACCESS_OUTER_SHAREABLE;
+    if (counts == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
 
-    HAL_MPU_ConfigRegion(&MPU_InitStruct);
+    result = BSP_Secure_Batch(&request, 1U);
+    if (result == BSP_OK)
+    {
+        counts->hits   = words[0];
+        counts->misses = words[1];
+    }
+    counts->hot_start = (uint32_t)&__text_hot_start;
+    counts->hot_size =
+        (uint32_t)&__text_hot_end - (uint32_t)&__text_hot_start;
 
-    /* Enables the MPU */
-    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+    return result;
 }
 
 /*============================================================================*/
-/*                          BSP Initialization                                */
+/*                          Image Verification Functions                      */
 /*============================================================================*/
 
-bsp_error_t BSP_Init(void)
-{
-    /* Reset of all peripherals, Initializes the Flash interface and the
-     * Systick. */
-    HAL_Init();
+_Static_assert(BSP_VERIFY_SIGNATURE_SIZE == SECURE_VERIFY_SIGNATURE_SIZE,
+               "signature size differs from the secure world");
 
-    /* Configure MPU for Ethernet DMA */
-    MPU_Config();
+bsp_error_t BSP_Verify_Start(void)
+{
+    bsp_secure_request_t request = {.op = BSP_SECURE_OP_VERIFY_START};
+    bsp_error_t          ret     = BSP_Secure_Batch(&request, 1U);
 
-    SystemClock_Config();
-    MX_GTZC_NS_Init();
+    return ((ret == BSP_OK) || (ret == BSP_BUSY)) ? ret : BSP_ERROR;
+}
 
-    /* Initialize all configured peripherals */
-    MX_GPDMA1_Init();
-    MX_GPIO_Init();
-    MX_LPUART1_UART_Init();
-    MX_TIM1_Init();
-    MX_ADC1_Init();
+bsp_error_t BSP_Verify_Update(const void *data, uint32_t length)
+{
+    bsp_secure_request_t request = {.op     = BSP_SECURE_OP_VERIFY_UPDATE,
+                                    .buffer = (void *)data,
+                                    .length = length};
 
-    BSP_LED_Init(LED_GREEN);
-    BSP_LED_Init(LED_YELLOW);
-    BSP_LED_Init(LED_RED);
+    return (BSP_Secure_Batch(&request, 1U) == BSP_OK) ? BSP_OK : BSP_ERROR;
+}
 
-    /* Initialize USER push-button, will be used to trigger an interrupt each
-     * time it's pressed.*/
-    BSP_PB_Init(BUTTON_USER, BUTTON_MODE_EXTI);
+bsp_error_t BSP_Verify_Finish(const uint8_t *signature)
+{
+    bsp_secure_request_t request = {.op     = BSP_SECURE_OP_VERIFY_FINISH,
+                                    .buffer = (void *)signature,
+                                    .length = BSP_VERIFY_SIGNATURE_SIZE};
 
-    BspCOMInit.BaudRate   = 115200;
-    BspCOMInit.WordLength = COM_WORDLENGTH_8B;
-    BspCOMInit.StopBits   = COM_STOPBITS_1;
-    BspCOMInit.Parity     = COM_PARITY_NONE;
-    BspCOMInit.HwFlowCtl  = COM_HWCONTROL_NONE;
-    if (BSP_COM_Init(COM1, &BspCOMInit) != BSP_ERROR_NONE)
+    if (BSP_Secure_Batch(&request, 1U) == BSP_OK)
     {
-        Error_Handler();
+        return BSP_OK;
     }
-
-    MX_ETH_Init();
-    MX_USB_HCD_Init();
-
-    /* Initialize ADC filter subsystem */
-    BSP_ADC1_FilterInit();
-
-    HAL_TIM_OC_Start(&htim1, TIM_CHANNEL_1);
-    BSP_ADC1_Start();
-
-    return BSP_OK;
+    return (request.status == BSP_SECURE_BAD_SIGNATURE) ? BSP_INVALID_ARG
+                                                        : BSP_ERROR;
 }
 
 /*============================================================================*/
-/*                          ADC1 Functions                                    */
+/*                          Cycle Counter Functions                           */
 /*============================================================================*/
 
-bsp_error_t BSP_ADC1_Start(void)
+uint32_t BSP_CycleCounter_Read(void) { return DWT->CYCCNT; }
+
+uint32_t BSP_CycleCounter_Hz(void) { return SystemCoreClock; }
+
+uint64_t BSP_CycleCounter_Read64(void)
 {
-    bsp_error_t         ret         = BSP_OK;
-    DMA_NodeConfTypeDef node_config = {0};
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now;
+    uint64_t value;
 
-    /* Check if already running */
-    if (adc1_running)
+    __disable_irq();
+    now = DWT->CYCCNT;
+    if (now < cycle_counter_last)
     {
-        ret = BSP_BUSY;
+        cycle_counter_wraps++;
     }
-    else
-    {
-        /* Clear the conversion complete flag */
-        adc1_conversion_complete = false;
+    cycle_counter_last = now;
+    value              = ((uint64_t)cycle_counter_wraps << 32) | now;
+    __set_PRIMASK(primask);
 
-        /* Configure DMA node for ADC1 */
-        node_config.NodeType             = DMA_GPDMA_LINEAR_NODE;
-        node_config.Init.Request         = GPDMA1_REQUEST_ADC1;
-        node_config.Init.BlkHWRequest    = DMA_BREQ_SINGLE_BURST;
-        node_config.Init.Direction       = DMA_PERIPH_TO_MEMORY;
-        node_config.Init.SrcInc          = DMA_SINC_FIXED;
-        node_config.Init.DestInc         = DMA_DINC_INCREMENTED;
-        node_config.Init.SrcDataWidth    = DMA_SRC_DATAWIDTH_WORD;
-        node_config.Init.DestDataWidth   = DMA_DEST_DATAWIDTH_WORD;
-        node_config.Init.SrcBurstLength  = 1;
-        node_config.Init.DestBurstLength = 1;
-        node_config.Init.TransferAllocatedPort =
-            DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1;
-        node_config.Init.TransferEventMode          = DMA_TCEM_BLOCK_TRANSFER;
-        node_config.Init.Mode                       = DMA_NORMAL;
-        node_config.DataHandlingConfig.DataExchange = DMA_EXCHANGE_NONE;
-        node_config.DataHandlingConfig.DataAlignment =
-            DMA_DATA_RIGHTALIGN_ZEROPADDED;
-        node_config.TriggerConfig.TriggerMode        = DMA_TRIGM_BLOCK_TRANSFER;
-        node_config.TriggerConfig.TriggerPolarity    = DMA_TRIG_POLARITY_MASKED;
-        node_config.TriggerConfig.TriggerSelection   = 0;
-        node_config.RepeatBlockConfig.RepeatCount    = 1;
-        node_config.RepeatBlockConfig.SrcAddrOffset  = 0;
-        node_config.RepeatBlockConfig.DestAddrOffset = 0;
-        node_config.RepeatBlockConfig.BlkSrcAddrOffset  = 0;
-        node_config.RepeatBlockConfig.BlkDestAddrOffset = 0;
-        node_config.SrcAddress                          = (uint32_t)&ADC1->DR;
-        node_config.DstAddress = (uint32_t)adc1_dma_buffer;
-        node_config.DataSize   = BSP_ADC1_NUM_CHANNELS * sizeof(uint32_t);
+    return value;
+}
 
-        /* Build the DMA node from configuration */
-        if (HAL_DMAEx_List_BuildNode(&node_config, &Node_GPDMA1_Channel0) !=
-            HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
-    }
+uint32_t BSP_ISR_Enter(bsp_isr_t isr)
+{
+    bsp_isr_trace_hook_t hook  = isr_trace_hook;
+    uint32_t             start = DWT->CYCCNT;
 
-    /* Reset the queue before use */
-    if (ret == BSP_OK)
+    if ((uint32_t)isr < (uint32_t)BSP_ISR_COUNT)
     {
-        if (HAL_DMAEx_List_ResetQ(&List_GPDMA1_Channel0) != HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
+        isr_enter_cycles[isr] = start;
     }
 
-    /* Insert node into the queue */
-    if (ret == BSP_OK)
+    if (hook != NULL)
     {
-        if (HAL_DMAEx_List_InsertNode_Tail(&List_GPDMA1_Channel0,
-                                           &Node_GPDMA1_Channel0) != HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
+        hook(isr, true);
     }
 
-    /* Make the list circular for continuous conversion */
-    if (ret == BSP_OK)
-    {
-        if (HAL_DMAEx_List_SetCircularMode(&List_GPDMA1_Channel0) != HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
-    }
+    return start;
+}
 
-    /* Initialize the DMA handle for linked list mode */
-    if (ret == BSP_OK)
-    {
-        handle_GPDMA1_Channel0.Instance = GPDMA1_Channel0;
-        handle_GPDMA1_Channel0.InitLinkedList.Priority =
-            DMA_LOW_PRIORITY_LOW_WEIGHT;
-        handle_GPDMA1_Channel0.InitLinkedList.LinkStepMode =
-            DMA_LSM_FULL_EXECUTION;
-        handle_GPDMA1_Channel0.InitLinkedList.LinkAllocatedPort =
-            DMA_LINK_ALLOCATED_PORT0;
-        handle_GPDMA1_Channel0.InitLinkedList.TransferEventMode =
-            DMA_TCEM_BLOCK_TRANSFER;
-        handle_GPDMA1_Channel0.InitLinkedList.LinkedListMode =
-            DMA_LINKEDLIST_CIRCULAR;
+void BSP_ISR_AddCycles(bsp_isr_t isr, uint32_t cycles)
+{
+    bsp_isr_trace_hook_t hook = isr_trace_hook;
 
-        if (HAL_DMAEx_List_Init(&handle_GPDMA1_Channel0) != HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
+    /* Only the handler itself writes its entry, and it does not nest */
+    if ((uint32_t)isr < (uint32_t)BSP_ISR_COUNT)
+    {
+        isr_cycles[isr] += cycles;
     }
 
-    /* Link the queue to the DMA handle */
-    if (ret == BSP_OK)
+    if (hook != NULL)
     {
-        if (HAL_DMAEx_List_LinkQ(&handle_GPDMA1_Channel0,
-                                 &List_GPDMA1_Channel0) != HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
+        hook(isr, false);
     }
+}
 
-    /* Link DMA handle to ADC handle */
-    if (ret == BSP_OK)
-    {
-        __HAL_LINKDMA(&hadc1, DMA_Handle, handle_GPDMA1_Channel0);
+void BSP_ISR_SetTraceHook(bsp_isr_trace_hook_t hook) { isr_trace_hook = hook; }
 
-        /* Run ADC calibration */
-        if (HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED) != HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
-    }
+uint64_t BSP_ISR_GetCycles(bsp_isr_t isr)
+{
+    uint64_t cycles = 0U;
 
-    /* Start ADC with DMA */
-    if (ret == BSP_OK)
+    if ((uint32_t)isr < (uint32_t)BSP_ISR_COUNT)
     {
-        if (HAL_ADC_Start_DMA(&hadc1, adc1_dma_buffer, BSP_ADC1_NUM_CHANNELS) !=
-            HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
-        else
-        {
-            adc1_running = true;
-        }
+        uint32_t primask = __get_PRIMASK();
+
+        __disable_irq();
+        cycles = isr_cycles[isr];
+        __set_PRIMASK(primask);
     }
 
-    return ret;
+    return cycles;
 }
 
-bsp_error_t BSP_ADC1_Stop(void)
+/*============================================================================*/
+/*                          PC Sampling Functions                             */
+/*============================================================================*/
+
+bsp_error_t BSP_Profile_Start(uint32_t hz, bsp_profile_hook_t hook)
 {
-    bsp_error_t ret = BSP_OK;
+    uint32_t pclk;
+    uint32_t ppre;
+    uint32_t clock;
 
-    if (adc1_running)
+    if ((hook == NULL) || (hz < BSP_PROFILE_MIN_HZ) ||
+        (hz > BSP_PROFILE_MAX_HZ))
     {
-        /* Stop ADC DMA */
-        if (HAL_ADC_Stop_DMA(&hadc1) != HAL_OK)
-        {
-            ret = BSP_ERROR;
-        }
-        else
-        {
-            adc1_running             = false;
-            adc1_conversion_complete = false;
-        }
+        return BSP_INVALID_ARG;
+    }
+    if (profile_hook != NULL)
+    {
+        return BSP_BUSY;
     }
-    /* If not running, return BSP_OK (already stopped) */
 
-    return ret;
+    /* TIM7 counts on the clock of the full profile, see pwm_timer_clock() */
+    clock_hold();
+    pclk  = HAL_RCC_GetPCLK1Freq();
+    ppre  = (RCC->CFGR2 & RCC_CFGR2_PPRE1) >> RCC_CFGR2_PPRE1_Pos;
+    clock = (ppre < 4U) ? pclk : (2U * pclk);
+
+    __HAL_RCC_TIM7_CLK_ENABLE();
+
+    TIM7->CR1  = 0U;
+    TIM7->PSC  = (clock / PROFILE_COUNTER_HZ) - 1U;
+    TIM7->ARR  = (PROFILE_COUNTER_HZ / hz) - 1U;
+    TIM7->EGR  = TIM_EGR_UG;
+    TIM7->SR   = 0U;
+    TIM7->DIER = TIM_DIER_UIE;
+
+    profile_hook = hook;
+
+    HAL_NVIC_SetPriority(TIM7_IRQn, PROFILE_IRQ_PRIORITY, 0);
+    HAL_NVIC_ClearPendingIRQ(TIM7_IRQn);
+    HAL_NVIC_EnableIRQ(TIM7_IRQn);
+    TIM7->CR1 = TIM_CR1_CEN;
+    clock_release();
+
+    return BSP_OK;
 }
 
-bool BSP_ADC1_IsConversionComplete(void)
+void BSP_Profile_Stop(void)
 {
-    bool result = false;
+    HAL_NVIC_DisableIRQ(TIM7_IRQn);
+    TIM7->CR1  = 0U;
+    TIM7->DIER = 0U;
+    TIM7->SR   = 0U;
+    HAL_NVIC_ClearPendingIRQ(TIM7_IRQn);
 
-    if (adc1_running && adc1_conversion_complete)
-    {
-        /* Clear the flag so caller can detect next conversion */
-        adc1_conversion_complete = false;
-        result                   = true;
-    }
+    /* A handler that was running has finished once the line is disabled */
+    __DSB();
+    __ISB();
+    profile_hook = NULL;
 
-    return result;
+    __HAL_RCC_TIM7_CLK_DISABLE();
 }
 
-bsp_error_t BSP_ADC1_GetResults(const uint32_t **results)
+void BSP_Profile_IRQHandler(uint32_t exc_return, const uint32_t *msp,
+                            const uint32_t *psp)
 {
-    bsp_error_t ret = BSP_OK;
+    bsp_profile_hook_t   hook   = profile_hook;
+    bsp_profile_sample_t sample = {0};
 
-    if (results == NULL)
+    TIM7->SR = ~TIM_SR_UIF;
+
+    if (hook == NULL)
     {
-        ret = BSP_INVALID_ARG;
+        return;
     }
-    else if (!adc1_running)
+
+    /* The non-secure world cannot read the secure stack */
+    if ((exc_return & PROFILE_EXC_RETURN_S) != 0U)
     {
-        *results = NULL;
-        ret      = BSP_ERROR;
+        sample.secure = true;
     }
     else
     {
-        *results = adc1_dma_buffer;
+        const uint32_t *frame =
+            ((exc_return & PROFILE_EXC_RETURN_SPSEL) != 0U) ? psp : msp;
+
+        sample.pc        = frame[PROFILE_FRAME_PC];
+        sample.lr        = frame[PROFILE_FRAME_LR];
+        sample.exception = (uint16_t)(frame[PROFILE_FRAME_XPSR] &
+                                      PROFILE_XPSR_EXCEPTION_MASK);
     }
 
-    return ret;
+    hook(&sample);
 }
 
-bsp_error_t BSP_ADC1_GetResultsCopy(uint32_t *buffer)
+/*============================================================================*/
+/*                          Supply Voltage Detector Functions                 */
+/*============================================================================*/
+
+bsp_error_t BSP_PVD_Start(uint32_t level, bsp_pvd_hook_t hook)
 {
-    bsp_error_t ret = BSP_OK;
+    PWR_PVDTypeDef config = {0};
 
-    if (buffer == NULL)
+    if ((hook == NULL) || (level > BSP_PVD_LEVEL_MAX))
     {
-        ret = BSP_INVALID_ARG;
+        return BSP_INVALID_ARG;
     }
-    else if (!adc1_running)
+    if (pvd_hook != NULL)
     {
-        ret = BSP_ERROR;
+        return BSP_BUSY;
     }
-    else
+
+    /* The output rises as VDD falls below the threshold */
+    config.PVDLevel = pvd_levels[level];
+    config.Mode     = PWR_PVD_MODE_IT_RISING_FALLING;
+    if (HAL_PWR_ConfigPVD(&config) != HAL_OK)
     {
-        /* Disable interrupts briefly to get consistent snapshot */
-        __disable_irq();
-        memcpy(buffer, adc1_dma_buffer, sizeof(adc1_dma_buffer));
-        __enable_irq();
+        return BSP_ERROR;
     }
 
-    return ret;
-}
+    pvd_hook = hook;
 
-bool BSP_ADC1_HasError(void) { return adc1_error_occurred; }
+    HAL_NVIC_SetPriority(PVD_AVD_IRQn, PVD_IRQ_PRIORITY, 0);
+    HAL_NVIC_ClearPendingIRQ(PVD_AVD_IRQn);
+    HAL_NVIC_EnableIRQ(PVD_AVD_IRQn);
+    HAL_PWR_EnablePVD();
 
-uint32_t BSP_ADC1_GetLastError(void) { return adc1_last_error; }
+    return BSP_OK;
+}
 
-bsp_error_t BSP_ADC1_Restart(void)
+void HAL_PWR_PVDCallback(void)
 {
-    bsp_error_t ret = BSP_OK;
+    bsp_pvd_hook_t hook = pvd_hook;
 
-    /* Stop ADC if running */
-    if (adc1_running)
+    if (hook != NULL)
     {
-        (void)HAL_ADC_Stop_DMA(&hadc1);
-        adc1_running = false;
+        hook(__HAL_PWR_GET_FLAG(PWR_FLAG_PVDO));
     }
+}
 
-    /* Clear error flags */
-    adc1_error_occurred = false;
-    adc1_last_error     = 0;
+void BSP_PVD_IRQHandler(void) { HAL_PWR_PVD_IRQHandler(); }
 
-    /* De-initialize and re-initialize the DMA handle */
-    (void)HAL_DMAEx_List_DeInit(&handle_GPDMA1_Channel0);
+/*============================================================================*/
+/*                          PTP Time Functions                                */
+/*============================================================================*/
 
-    /* Restart ADC */
-    ret = BSP_ADC1_Start();
+uint64_t BSP_Time_NowNs(void)
+{
+    uint32_t seconds;
+    uint32_t nanos;
+    uint32_t again;
 
-    return ret;
+    if (!ptp_running)
+    {
+        return 0U;
+    }
+
+    seconds = heth.Instance->MACSTSR;
+    nanos   = heth.Instance->MACSTNR;
+    again   = heth.Instance->MACSTSR;
+    if (again != seconds)
+    {
+        /* Rolled over between the reads: the new second starts near 0 */
+        seconds = again;
+        nanos   = heth.Instance->MACSTNR;
+    }
+
+    return ((uint64_t)seconds * (uint64_t)BSP_PTP_NS_PER_S) +
+           (nanos & ETH_MACSTNR_TSSS_Msk);
 }
 
-bool BSP_ADC1_CheckAndRestart(void)
+bsp_error_t BSP_PTP_StepNs(int64_t offset_ns)
 {
-    bool restarted = false;
+    ETH_TimeTypeDef      step;
+    ETH_PtpUpdateTypeDef sign = HAL_ETH_PTP_POSITIVE_UPDATE;
+    uint64_t             magnitude;
 
-    if (adc1_error_occurred || !adc1_running)
+    if (!ptp_running)
     {
-        if (BSP_ADC1_Restart() == BSP_OK)
-        {
-            restarted = true;
-        }
+        return BSP_ERROR;
+    }
+    if ((heth.Instance->MACTSCR & ETH_MACTSCR_TSUPDT) != 0U)
+    {
+        return BSP_BUSY;
     }
 
-    return restarted;
-}
+    if (offset_ns < 0)
+    {
+        sign      = HAL_ETH_PTP_NEGATIVE_UPDATE;
+        magnitude = (uint64_t)(-offset_ns);
+    }
+    else
+    {
+        magnitude = (uint64_t)offset_ns;
+    }
 
-/*============================================================================*/
-/*                     Filtered ADC1 Functions (Continuous Mode)              */
-/*============================================================================*/
+    step.Seconds     = (uint32_t)(magnitude / (uint64_t)BSP_PTP_NS_PER_S);
+    step.NanoSeconds = (uint32_t)(magnitude % (uint64_t)BSP_PTP_NS_PER_S);
 
-void BSP_ADC1_FilterInit(void)
+    return (HAL_ETH_PTP_AddTimeOffset(&heth, sign, &step) == HAL_OK)
+               ? BSP_OK
+               : BSP_ERROR;
+}
+
+bsp_error_t BSP_PTP_AdjustFrequency(int32_t ppb)
 {
-    if (!g_filter_initialized)
+    if (!ptp_running)
+    {
+        return BSP_ERROR;
+    }
+    if ((heth.Instance->MACTSCR & ETH_MACTSCR_TSADDREG) != 0U)
     {
-        /* Initialize the filter context for all channels */
-        adc_filter_init(&g_adc_filter_ctx);
+        return BSP_BUSY;
+    }
 
-        /* Clear filtered values */
-        for (uint8_t ch = 0; ch < BSP_ADC1_NUM_CHANNELS; ch++)
-        {
-            g_filtered_values[ch] = 0.0f;
-        }
+    if (ppb > BSP_PTP_MAX_ADJ_PPB)
+    {
+        ppb = BSP_PTP_MAX_ADJ_PPB;
+    }
+    else if (ppb < -BSP_PTP_MAX_ADJ_PPB)
+    {
+        ppb = -BSP_PTP_MAX_ADJ_PPB;
+    }
 
-        /* Reset sample counter */
-        g_filter_sample_count = 0;
+    ptp_adjust_ppb = ppb;
+    ptp_load_addend(ppb);
 
-        /* Mark as initialized - ISR will start processing samples */
-        g_filter_initialized = true;
-    }
+    return BSP_OK;
 }
 
-bsp_error_t BSP_ADC1_GetFilteredValue(uint8_t channel, float32_t *value)
+bsp_error_t BSP_Time_SleepUntilNs(uint64_t deadline_ns)
 {
     bsp_error_t ret = BSP_OK;
+    uint64_t    now_ns;
+    uint64_t    wait_ns;
+    uint32_t    start;
+    uint32_t    ticks;
+    uint32_t    target;
+    uint32_t    elapsed;
 
-    /* Validate parameters */
-    if (channel >= BSP_ADC1_NUM_CHANNELS || value == NULL)
+    if (!ptp_running)
     {
-        ret = BSP_INVALID_ARG;
+        return BSP_ERROR;
     }
-    /* Check if filter is initialized */
-    else if (!g_filter_initialized)
+
+    /* Left over from a sleep that timed out as the interrupt came */
+    (void)ulTaskNotifyTakeIndexed(BSP_TIME_NOTIFY_INDEX, pdTRUE, 0U);
+
+    taskENTER_CRITICAL();
+    if (ptp_sleeper != NULL)
     {
-        ret = BSP_ERROR;
+        taskEXIT_CRITICAL();
+        return BSP_BUSY;
     }
-    else
+
+    /* The capture timer ticks at its nominal rate in the full profile */
+    clock_require_full();
+
+    /* The timer is read next to the PTP time, as for the block stamps */
+    start  = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+    now_ns = BSP_Time_NowNs();
+    if (deadline_ns <= now_ns)
     {
-        /* Instant response: just return the current filtered value */
-        *value = g_filtered_values[channel];
+        taskEXIT_CRITICAL();
+        return BSP_OK;
+    }
+    wait_ns = deadline_ns - now_ns;
+    if (wait_ns > (uint64_t)BSP_TIME_MAX_SLEEP_NS)
+    {
+        taskEXIT_CRITICAL();
+        return BSP_ERROR;
     }
 
-    return ret;
-}
+    /* Rounded up, so the sleep never ends before the deadline */
+    ticks = (uint32_t)(((wait_ns * BSP_ADC1_TIMESTAMP_HZ) +
+                        (uint64_t)(BSP_PTP_NS_PER_S - 1)) /
+                       (uint64_t)BSP_PTP_NS_PER_S);
+    target = ((g_timebase_span - start) > ticks)
+                 ? (start + ticks)
+                 : (ticks - (g_timebase_span - start));
 
-bsp_error_t BSP_ADC1_GetFilteredValuesAll(float32_t *values)
-{
-    bsp_error_t ret = BSP_OK;
+    ptp_sleeper = xTaskGetCurrentTaskHandle();
+    __HAL_TIM_SET_COMPARE(&g_timebase_tim, TIM_CHANNEL_1, target);
+    __HAL_TIM_CLEAR_FLAG(&g_timebase_tim, TIM_FLAG_CC1);
+    __HAL_TIM_ENABLE_IT(&g_timebase_tim, TIM_IT_CC1);
 
-    /* Validate parameters */
-    if (values == NULL)
+    /* A count passed while arming never matches: raise the event instead */
+    elapsed = __HAL_TIM_GET_COUNTER(&g_timebase_tim);
+    elapsed = (elapsed >= start) ? (elapsed - start)
+                                 : (elapsed + g_timebase_span - start);
+    if (elapsed >= ticks)
     {
-        ret = BSP_INVALID_ARG;
+        g_timebase_tim.Instance->EGR = TIM_EGR_CC1G;
     }
-    /* Check if filter is initialized */
-    else if (!g_filter_initialized)
+    taskEXIT_CRITICAL();
+
+    if (ulTaskNotifyTakeIndexed(
+            BSP_TIME_NOTIFY_INDEX, pdTRUE,
+            pdMS_TO_TICKS((uint32_t)(wait_ns / 1000000U) + 2U)) == 0U)
     {
-        ret = BSP_ERROR;
+        ret = BSP_TIMEOUT;
     }
-    else
+
+    taskENTER_CRITICAL();
+    __HAL_TIM_DISABLE_IT(&g_timebase_tim, TIM_IT_CC1);
+    ptp_sleeper = NULL;
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+void BSP_Time_IRQHandler(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (__HAL_TIM_GET_FLAG(&g_timebase_tim, TIM_FLAG_CC1) != 0U)
     {
-        /* Instant response: copy all current filtered values */
-        /* Disable interrupts briefly to get consistent snapshot */
-        __disable_irq();
-        for (uint8_t ch = 0; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+        __HAL_TIM_CLEAR_FLAG(&g_timebase_tim, TIM_FLAG_CC1);
+        __HAL_TIM_DISABLE_IT(&g_timebase_tim, TIM_IT_CC1);
+        if (ptp_sleeper != NULL)
         {
-            values[ch] = g_filtered_values[ch];
+            vTaskNotifyGiveIndexedFromISR(ptp_sleeper, BSP_TIME_NOTIFY_INDEX,
+                                          &woken);
         }
-        __enable_irq();
     }
 
-    return ret;
+    portYIELD_FROM_ISR(woken);
 }
 
-bool BSP_ADC1_IsFilterSettled(void)
-{
-    return g_filter_initialized &&
-           (g_filter_sample_count >= BSP_ADC1_FILTER_SETTLING_SAMPLES);
-}
+/*============================================================================*/
+/*                          Cache Functions                                   */
+/*============================================================================*/
 
-uint32_t BSP_ADC1_GetFilterSampleCount(void) { return g_filter_sample_count; }
+/* The internal SRAM is not cached (see the BSP_CACHE group), so only the
+ * ordering of the hand-over is left to do. Both barriers are cheap next to
+ * the transfers they order. */
 
-bsp_error_t BSP_I2CDO_init()
+void BSP_Cache_CleanRange(const void *addr, size_t size)
 {
-    bsp_error_t ret = BSP_OK;
+    (void)addr;
+    (void)size;
 
-    MX_I2C3_Init();
+    /* Complete the buffer writes before the DMA is started */
+    __DSB();
+}
 
-    // Set initial state to all low and write to expanders
-    ret = BSP_I2CDO_Write(0x0000U);
+void BSP_Cache_InvalidateRange(void *addr, size_t size)
+{
+    (void)addr;
+    (void)size;
 
-    return ret;
+    /* Issue the buffer reads only after the completion was seen */
+    __DMB();
 }
 
-bsp_error_t BSP_I2CDO_Write(uint16_t value)
+/*============================================================================*/
+/*                          Low Power Functions                               */
+/*============================================================================*/
+
+/**
+ * @brief Read the LPTIM1 counter
+ *
+ * The counter runs asynchronously to the bus clock; two equal consecutive
+ * reads are needed.
+ */
+static uint32_t lowpower_timer_count(void)
 {
-    HAL_StatusTypeDef status;
-    uint8_t           output_byte;
-    bsp_error_t       ret = BSP_OK;
+    uint32_t first;
+    uint32_t second = LPTIM1->CNT;
 
-    // Write lower 8 bits to PCF8574
-    output_byte = (uint8_t)(value & 0xFFU);
-    status      = HAL_I2C_Master_Transmit(&hi2c3, BSP_I2CDO_PCF8574_ADDR,
-                                          &output_byte, 1, BSP_I2CDO_TIMEOUT);
-    if (status != HAL_OK)
+    do
     {
-        if (status == HAL_TIMEOUT)
-        {
-            ret = BSP_TIMEOUT;
-        }
-        else
-        {
-            ret = BSP_ERROR;
-        }
-    }
+        first  = second;
+        second = LPTIM1->CNT;
+    } while (first != second);
 
-    // Write upper 8 bits to PCF8574A
-    if (ret == BSP_OK)
-    {
-        output_byte = (uint8_t)((value >> 8U) & 0xFFU);
-        status      = HAL_I2C_Master_Transmit(&hi2c3, BSP_I2CDO_PCF8574A_ADDR,
-                                              &output_byte, 1, BSP_I2CDO_TIMEOUT);
-        if (status != HAL_OK)
-        {
-            if (status == HAL_TIMEOUT)
-            {
-                ret = BSP_TIMEOUT;
-            }
-            else
-            {
-                ret = BSP_ERROR;
-            }
-        }
-    }
+    return second;
+}
 
-    return ret;
+bool BSP_LowPower_StopAllowed(void)
+{
+    return !adc1_running && console_tx_done && (rs485_uart.Instance == NULL) &&
+           (i2cdo_active == NULL) && !crc_busy && !flash_busy &&
+           (pwm_running == 0U) && (gpiodi_selected == 0U) && !can_running &&
+           !usbh_started && (ptp_sleeper == NULL);
 }
 
-bsp_error_t BSP_I2CDO_Read(uint16_t *value)
+uint32_t BSP_LowPower_Sleep(bsp_sleep_state_t state, uint32_t duration_us)
 {
-    HAL_StatusTypeDef status;
-    uint8_t           read_byte_pcf8574;
-    uint8_t           read_byte_pcf8574a;
-    bsp_error_t       ret = BSP_OK;
+    uint32_t ticks;
+    uint32_t elapsed;
 
-    if (value == NULL)
+    if ((state != BSP_SLEEP_SLEEP) && (state != BSP_SLEEP_STOP))
     {
-        return BSP_INVALID_ARG;
+        return 0U;
     }
-
-    // Read from PCF8574
-    status = HAL_I2C_Master_Receive(&hi2c3, BSP_I2CDO_PCF8574_ADDR,
-                                    &read_byte_pcf8574, 1, BSP_I2CDO_TIMEOUT);
-    if (status != HAL_OK)
+    if (duration_us > BSP_LOWPOWER_MAX_SLEEP_US)
     {
-        if (status == HAL_TIMEOUT)
-        {
-            ret = BSP_TIMEOUT;
-        }
-        else
-        {
-            ret = BSP_ERROR;
-        }
+        duration_us = BSP_LOWPOWER_MAX_SLEEP_US;
     }
 
-    // Read from PCF8574A
-    if (ret == BSP_OK)
+    ticks = (uint32_t)(((uint64_t)duration_us * LOWPOWER_TIMER_HZ) / 1000000U);
+    if (ticks < 2U)
     {
-        status =
-            HAL_I2C_Master_Receive(&hi2c3, BSP_I2CDO_PCF8574A_ADDR,
-                                   &read_byte_pcf8574a, 1, BSP_I2CDO_TIMEOUT);
-        if (status != HAL_OK)
-        {
-            if (status == HAL_TIMEOUT)
-            {
-                ret = BSP_TIMEOUT;
-            }
-            else
-            {
-                ret = BSP_ERROR;
-            }
-        }
+        return 0U;
     }
 
-    if (ret == BSP_OK)
+    HAL_SuspendTick();
+
+    /* DIER and ARR only take writes while the timer is enabled */
+    LPTIM1->CR   = LPTIM_CR_ENABLE;
+    LPTIM1->DIER = LPTIM_DIER_ARRMIE;
+    while ((LPTIM1->ISR & LPTIM_ISR_DIEROK) == 0U)
     {
-        *value =
-            (uint16_t)read_byte_pcf8574 | ((uint16_t)read_byte_pcf8574a << 8U);
     }
-
-    return ret;
-}
-
-bsp_error_t BSP_GPIODI_Read(uint32_t channel, uint32_t *pVal)
-{
-    bsp_error_t retval;
-
-    if ((channel <= BSP_GPIODI_INDEX_7) && (NULL != pVal))
+    LPTIM1->ICR = LPTIM_ICR_DIEROKCF;
+    LPTIM1->ARR = ticks;
+    while ((LPTIM1->ISR & LPTIM_ISR_ARROK) == 0U)
     {
-        GPIO_PinState pinValue;
+    }
+    LPTIM1->ICR = LPTIM_ICR_ARROKCF | LPTIM_ICR_ARRMCF;
+    LPTIM1->CR  = LPTIM_CR_ENABLE | LPTIM_CR_SNGSTRT;
 
-        retval = BSP_OK;
-        switch (channel)
+    if (state == BSP_SLEEP_STOP)
+    {
+        HAL_PWR_EnterSTOPMode(PWR_MAINREGULATOR_ON, PWR_STOPENTRY_WFI);
+        /* The core wakes on HSI; bring back HSE and PLL1, then the profile */
+        SystemClock_Config();
+        if (clock_profile != BSP_CLOCK_FULL)
         {
-            case BSP_GPIODI_INDEX_0:
-                pinValue = HAL_GPIO_ReadPin(DI0_GPIO_Port, DI0_Pin);
-                break;
-            case BSP_GPIODI_INDEX_1:
-                pinValue = HAL_GPIO_ReadPin(DI1_GPIO_Port, DI1_Pin);
-                break;
-            case BSP_GPIODI_INDEX_2:
-                pinValue = HAL_GPIO_ReadPin(DI2_GPIO_Port, DI2_Pin);
-                break;
-            case BSP_GPIODI_INDEX_3:
-                pinValue = HAL_GPIO_ReadPin(DI3_GPIO_Port, DI3_Pin);
-                break;
-            case BSP_GPIODI_INDEX_4:
-                pinValue = HAL_GPIO_ReadPin(DI4_GPIO_Port, DI4_Pin);
-                break;
-            case BSP_GPIODI_INDEX_5:
-                pinValue = HAL_GPIO_ReadPin(DI5_GPIO_Port, DI5_Pin);
-                break;
-            case BSP_GPIODI_INDEX_6:
-                pinValue = HAL_GPIO_ReadPin(DI6_GPIO_Port, DI6_Pin);
-                break;
-            case BSP_GPIODI_INDEX_7:
-                pinValue = HAL_GPIO_ReadPin(DI7_GPIO_Port, DI7_Pin);
-                break;
-            default:
-                pinValue = GPIO_PIN_RESET;
+            clock_apply(clock_profile);
         }
-        *pVal = pinValue;
     }
     else
     {
-        retval = BSP_ERROR;
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
     }
 
-    return retval;
+    elapsed = ((LPTIM1->ISR & LPTIM_ISR_ARRM) != 0U) ? ticks
+                                                     : lowpower_timer_count();
+
+    /* Disabling resets the counter */
+    LPTIM1->ICR = LPTIM_ICR_ARRMCF;
+    LPTIM1->CR  = 0U;
+
+    HAL_ResumeTick();
+
+    return (uint32_t)(((uint64_t)elapsed * 1000000U) / LOWPOWER_TIMER_HZ);
 }
 
-uint8_t BSP_GetDeviceAddress(void)
+void BSP_LowPower_IRQHandler(void)
 {
-    uint8_t address = 0U;
+    /* The wake-up itself is all that is needed */
+    LPTIM1->ICR = LPTIM_ICR_ARRMCF;
+}
 
-    /*
-     * Read DEVADDR pins - they have internal pull-ups, so:
-     * - Open/floating pin reads HIGH (GPIO_PIN_SET) -> bit = 0
-     * - Grounded pin reads LOW (GPIO_PIN_RESET) -> bit = 1
-     *
-     * This allows setting address by grounding pins (active-low logic).
-     */
+/*============================================================================*/
+/*                          Clock Profile Functions                           */
+/*============================================================================*/
 
-    /* DEVADDR0 - Bit 0 */
-    if (HAL_GPIO_ReadPin(DEVADDR0_GPIO_Port, DEVADDR0_Pin) == GPIO_PIN_RESET)
+bool BSP_Clock_IdleAllowed(void) { return clock_idle_allowed(); }
+
+bsp_error_t BSP_Clock_SetProfile(bsp_clock_profile_t profile)
+{
+    bsp_error_t ret = BSP_OK;
+    uint32_t    primask;
+
+    if ((uint32_t)profile >= (uint32_t)BSP_CLOCK_PROFILE_COUNT)
     {
-        address |= (1U << 0U);
+        return BSP_INVALID_ARG;
     }
 
-    /* DEVADDR1 - Bit 1 */
-    if (HAL_GPIO_ReadPin(DEVADDR1_GPIO_Port, DEVADDR1_Pin) == GPIO_PIN_RESET)
+    /* Checked and switched at once, so no timer starts in between */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if ((profile == BSP_CLOCK_IDLE) && !clock_idle_allowed())
     {
-        address |= (1U << 1U);
+        ret = BSP_BUSY;
     }
+    else if (profile != clock_profile)
+    {
+        clock_apply(profile);
+    }
+    __set_PRIMASK(primask);
 
-    /* DEVADDR2 - Bit 2 */
-    if (HAL_GPIO_ReadPin(DEVADDR2_GPIO_Port, DEVADDR2_Pin) == GPIO_PIN_RESET)
+    return ret;
+}
+
+bsp_clock_profile_t BSP_Clock_GetProfile(void) { return clock_profile; }
+
+/*============================================================================*/
+/*                          Independent Watchdog                              */
+/*============================================================================*/
+
+/** @brief IWDG key register values */
+#define WATCHDOG_KEY_START  0xCCCCU
+#define WATCHDOG_KEY_UNLOCK 0x5555U
+#define WATCHDOG_KEY_KICK   0xAAAAU
+
+/** @brief Prescaler 64 (PR = 4): 2 ms per count of the 32 kHz LSI */
+#define WATCHDOG_PRESCALER 4U
+#define WATCHDOG_MS_PER_COUNT 2U
+
+/** @brief Status bits that stay set until a register update is done */
+#define WATCHDOG_SR_BUSY (IWDG_SR_PVU | IWDG_SR_RVU | IWDG_SR_WVU)
+
+/** @brief Register update attempts before BSP_Watchdog_Start() gives up */
+#define WATCHDOG_UPDATE_SPINS 100000U
+
+_Static_assert(((BSP_WATCHDOG_MAX_TIMEOUT_MS / WATCHDOG_MS_PER_COUNT) - 1U) <=
+                   IWDG_RLR_RL_Msk,
+               "the longest timeout must fit the reload register");
+
+/** @brief Reset cause taken by BSP_Watchdog_Start() */
+static bool watchdog_caused_reset = false;
+
+bsp_error_t BSP_Watchdog_Start(uint32_t timeout_ms)
+{
+    uint32_t spins = 0U;
+
+    if ((timeout_ms < WATCHDOG_MS_PER_COUNT) ||
+        (timeout_ms > BSP_WATCHDOG_MAX_TIMEOUT_MS))
     {
-        address |= (1U << 2U);
+        return BSP_INVALID_ARG;
     }
 
-    /* DEVADDR3 - Bit 3 */
-    if (HAL_GPIO_ReadPin(DEVADDR3_GPIO_Port, DEVADDR3_Pin) == GPIO_PIN_RESET)
+    watchdog_caused_reset = ((RCC->RSR & RCC_RSR_IWDGRSTF) != 0U);
+    RCC->RSR |= RCC_RSR_RMVF;
+
+    /* A debugger halting the core must not reset it */
+    DBGMCU->APB1FZR1 |= DBGMCU_APB1FZR1_DBG_IWDG_STOP;
+
+    /* Starting the IWDG also starts the LSI */
+    IWDG->KR  = WATCHDOG_KEY_START;
+    IWDG->KR  = WATCHDOG_KEY_UNLOCK;
+    IWDG->PR  = WATCHDOG_PRESCALER;
+    IWDG->RLR = (timeout_ms / WATCHDOG_MS_PER_COUNT) - 1U;
+
+    while (((IWDG->SR & WATCHDOG_SR_BUSY) != 0U) &&
+           (spins < WATCHDOG_UPDATE_SPINS))
     {
-        address |= (1U << 3U);
+        spins++;
     }
 
-    return address;
-}
\ No newline at end of file
+    IWDG->KR = WATCHDOG_KEY_KICK;
+
+    return ((IWDG->SR & WATCHDOG_SR_BUSY) == 0U) ? BSP_OK : BSP_ERROR;
+}
+
+void BSP_Watchdog_Kick(void) { IWDG->KR = WATCHDOG_KEY_KICK; }
+
+bool BSP_Watchdog_CausedReset(void) { return watchdog_caused_reset; }
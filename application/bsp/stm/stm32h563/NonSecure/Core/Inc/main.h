@@ -134,6 +134,10 @@ void ethernetif_get_mac_addr(uint8_t *mac_addr);
 #define ARD_D0_RX_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
+/* LAN8742 nINT, open drain, low while an unmasked PHY interrupt is flagged */
+#define ETH_PHY_INT_Pin GPIO_PIN_3
+#define ETH_PHY_INT_GPIO_Port GPIOE
+#define ETH_PHY_INT_EXTI_IRQn EXTI3_IRQn
 
 /* USER CODE END Private defines */
 
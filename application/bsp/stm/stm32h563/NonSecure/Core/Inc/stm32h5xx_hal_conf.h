@@ -256,6 +256,19 @@
  */
 #define USE_SPI_CRC                   0U
 
+/* ############################################ ETH peripheral configuration ######################################## */
+
+/* PTP FEATURE: Use to activate the PTP timestamp APIs of the HAL ETH Driver
+ * (hardware TX/RX timestamps and the MAC system time, see the BSP_PTP group)
+ */
+#define HAL_ETH_USE_PTP
+
+/* TX DMA descriptors: a VLAN tagged frame takes a context descriptor ahead
+ * of its data descriptors (see ethernetif_set_vlan()), so the HAL default of
+ * 4 is doubled to keep as many frames queued
+ */
+#define ETH_TX_DESC_CNT 8U
+
 /* Includes ----------------------------------------------------------------------------------------------------------*/
 
 /**
@@ -46,7 +46,9 @@ extern "C" {
 /* USER CODE END EM */
 
 /* Exported functions prototypes ---------------------------------------------*/
+void HardFault_Handler(void);
 void MemManage_Handler(void);
+void BusFault_Handler(void);
 void UsageFault_Handler(void);
 void EXTI13_IRQHandler(void);
 void GPDMA1_Channel0_IRQHandler(void);
@@ -356,6 +356,18 @@ void MX_ETH_Init(void)
   TxConfig.ChecksumCtrl = ETH_CHECKSUM_IPHDR_PAYLOAD_INSERT_PHDR_CALC;
   TxConfig.CRCPadCtrl = ETH_CRC_PAD_INSERT;
   /* USER CODE BEGIN ETH_Init 2 */
+  /* Verify IPv4 header and TCP/UDP/ICMP checksums in the MAC and drop frames
+   * that fail, so lwIP can skip its software checks (ETHIF_CHECKSUM_OFFLOAD
+   * in lwipopts.h). */
+  {
+    ETH_MACConfigTypeDef MACConf = {0};
+
+    HAL_ETH_GetMACConfig(&heth, &MACConf);
+    MACConf.ChecksumOffload = ENABLE;
+    MACConf.DropTCPIPChecksumErrorPacket = ENABLE;
+    MACConf.ForwardRxErrorPacket = DISABLE;
+    HAL_ETH_SetMACConfig(&heth, &MACConf);
+  }
 
   /* USER CODE END ETH_Init 2 */
 
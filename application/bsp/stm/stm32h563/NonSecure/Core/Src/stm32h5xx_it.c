@@ -24,6 +24,8 @@
 /* USER CODE BEGIN Includes */
 #include <stdint.h>
 #include <stdio.h>
+
+#include "bsp.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -48,6 +50,29 @@
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN PFP */
+/* RS-485 port interrupt entries, implemented in bsp.c */
+void BSP_RS485_IRQHandler(void);
+void BSP_RS485_RxDMA_IRQHandler(void);
+void BSP_RS485_TxDMA_IRQHandler(void);
+
+/* ADC1 DMA interrupt entry, implemented in bsp.c */
+void BSP_ADC1_DMA_IRQHandler(void);
+
+/* ADC1 interrupt entry (injected conversions, watchdogs), implemented in
+ * bsp.c */
+void BSP_ADC1_IRQHandler(void);
+
+/* ADC2 interrupt entry (watchdogs in dual mode), implemented in bsp.c */
+void BSP_ADC2_IRQHandler(void);
+
+/* External SPI ADC DMA interrupt entry, implemented in bsp.c */
+void BSP_SPIADC_DMA_IRQHandler(void);
+
+/* SPI NOR flash DMA interrupt entry, implemented in bsp.c */
+void BSP_SPINOR_DMA_IRQHandler(void);
+
+/* PHY interrupt entry, implemented in ethernetif.c */
+void ethernetif_phy_irq_handler(void);
 
 /* USER CODE END PFP */
 
@@ -64,18 +89,37 @@ extern ETH_HandleTypeDef heth;
 extern TIM_HandleTypeDef htim6;
 
 /* USER CODE BEGIN EV */
+extern I2C_HandleTypeDef hi2c3;
 
 /* USER CODE END EV */
 
 /******************************************************************************/
 /*           Cortex Processor Interruption and Exception Handlers          */
 /******************************************************************************/
+/**
+  * @brief This function handles Hard fault interrupt.
+  */
+void HardFault_Handler(void)
+{
+  /* USER CODE BEGIN HardFault_IRQn 0 */
+  BSP_Console_Fault();
+  printf("\r\n!!! HardFault_Handler !!!\r\n");
+  printf("HFSR=0x%08lX, CFSR=0x%08lX\r\n", SCB->HFSR, SCB->CFSR);
+  /* USER CODE END HardFault_IRQn 0 */
+  while (1)
+  {
+    /* USER CODE BEGIN W1_HardFault_IRQn 0 */
+    /* USER CODE END W1_HardFault_IRQn 0 */
+  }
+}
+
 /**
   * @brief This function handles Memory management fault.
   */
 void MemManage_Handler(void)
 {
   /* USER CODE BEGIN MemoryManagement_IRQn 0 */
+  BSP_Console_Fault();
   printf("\r\n!!! MemManage_Handler !!!\r\n");
   printf("CFSR=0x%08lX, MMFAR=0x%08lX\r\n",
          SCB->CFSR, SCB->MMFAR);
@@ -87,12 +131,30 @@ void MemManage_Handler(void)
   }
 }
 
+/**
+  * @brief This function handles Pre-fetch fault, memory access fault.
+  */
+void BusFault_Handler(void)
+{
+  /* USER CODE BEGIN BusFault_IRQn 0 */
+  BSP_Console_Fault();
+  printf("\r\n!!! BusFault_Handler !!!\r\n");
+  printf("CFSR=0x%08lX, BFAR=0x%08lX\r\n", SCB->CFSR, SCB->BFAR);
+  /* USER CODE END BusFault_IRQn 0 */
+  while (1)
+  {
+    /* USER CODE BEGIN W1_BusFault_IRQn 0 */
+    /* USER CODE END W1_BusFault_IRQn 0 */
+  }
+}
+
 /**
   * @brief This function handles Undefined instruction or illegal state.
   */
 void UsageFault_Handler(void)
 {
   /* USER CODE BEGIN UsageFault_IRQn 0 */
+  BSP_Console_Fault();
   printf("\r\n!!! UsageFault_Handler !!!\r\n");
   printf("CFSR=0x%08lX\r\n", SCB->CFSR);
   /* USER CODE END UsageFault_IRQn 0 */
@@ -130,11 +192,11 @@ void EXTI13_IRQHandler(void)
 void GPDMA1_Channel0_IRQHandler(void)
 {
   /* USER CODE BEGIN GPDMA1_Channel0_IRQn 0 */
-
+  uint32_t isr_start = BSP_ISR_Enter(BSP_ISR_ADC1_DMA);
   /* USER CODE END GPDMA1_Channel0_IRQn 0 */
   HAL_DMA_IRQHandler(&handle_GPDMA1_Channel0);
   /* USER CODE BEGIN GPDMA1_Channel0_IRQn 1 */
-
+  BSP_ISR_AddCycles(BSP_ISR_ADC1_DMA, BSP_CycleCounter_Read() - isr_start);
   /* USER CODE END GPDMA1_Channel0_IRQn 1 */
 }
 
@@ -158,14 +220,213 @@ void TIM6_IRQHandler(void)
 void ETH_IRQHandler(void)
 {
   /* USER CODE BEGIN ETH_IRQn 0 */
-
+  uint32_t isr_start = BSP_ISR_Enter(BSP_ISR_ETH);
   /* USER CODE END ETH_IRQn 0 */
   HAL_ETH_IRQHandler(&heth);
   /* USER CODE BEGIN ETH_IRQn 1 */
-
+  BSP_ISR_AddCycles(BSP_ISR_ETH, BSP_CycleCounter_Read() - isr_start);
   /* USER CODE END ETH_IRQn 1 */
 }
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles I2C3 event interrupt.
+  */
+void I2C3_EV_IRQHandler(void)
+{
+  HAL_I2C_EV_IRQHandler(&hi2c3);
+}
+
+/**
+  * @brief This function handles I2C3 error interrupt.
+  */
+void I2C3_ER_IRQHandler(void)
+{
+  HAL_I2C_ER_IRQHandler(&hi2c3);
+}
+
+/**
+  * @brief This function handles USART2 (RS-485) global interrupt.
+  */
+void USART2_IRQHandler(void)
+{
+  BSP_RS485_IRQHandler();
+}
+
+/**
+  * @brief This function handles GPDMA1 Channel 1 (USART2 RX) interrupt.
+  */
+void GPDMA1_Channel1_IRQHandler(void)
+{
+  BSP_RS485_RxDMA_IRQHandler();
+}
+
+/**
+  * @brief This function handles GPDMA1 Channel 2 (USART2 TX) interrupt.
+  */
+void GPDMA1_Channel2_IRQHandler(void)
+{
+  BSP_RS485_TxDMA_IRQHandler();
+}
+
+/**
+  * @brief This function handles GPDMA1 Channel 6 (ADC1) interrupt.
+  */
+void GPDMA1_Channel6_IRQHandler(void)
+{
+  BSP_ADC1_DMA_IRQHandler();
+}
+
+/**
+  * @brief This function handles ADC1 global interrupt.
+  */
+void ADC1_IRQHandler(void)
+{
+  BSP_ADC1_IRQHandler();
+}
+
+/**
+  * @brief This function handles ADC2 global interrupt.
+  */
+void ADC2_IRQHandler(void)
+{
+  BSP_ADC2_IRQHandler();
+}
+
+/**
+  * @brief This function handles GPDMA1 Channel 4 (SPI1 RX, external ADC) interrupt.
+  */
+void GPDMA1_Channel4_IRQHandler(void)
+{
+  BSP_SPIADC_DMA_IRQHandler();
+}
+
+/**
+  * @brief This function handles GPDMA1 Channel 7 (SPI3, NOR flash) interrupt.
+  */
+void GPDMA1_Channel7_IRQHandler(void)
+{
+  BSP_SPINOR_DMA_IRQHandler();
+}
+
+/**
+  * @brief This function handles USART3 (console) global interrupt.
+  */
+void USART3_IRQHandler(void)
+{
+  BSP_Console_IRQHandler();
+}
+
+/**
+  * @brief This function handles GPDMA1 Channel 3 (USART3 TX) interrupt.
+  */
+void GPDMA1_Channel3_IRQHandler(void)
+{
+  BSP_Console_TxDMA_IRQHandler();
+}
+
+/**
+  * @brief This function handles LPTIM1 (low-power wake-up timer) interrupt.
+  */
+void LPTIM1_IRQHandler(void)
+{
+  BSP_LowPower_IRQHandler();
+}
+
+/**
+  * @brief This function handles TIM2 (capture timer compare) interrupt.
+  */
+void TIM2_IRQHandler(void)
+{
+  BSP_Time_IRQHandler();
+}
+
+/**
+  * @brief This function handles TIM7 (PC sampling) interrupt.
+  *
+  * Naked, so that LR still holds EXC_RETURN and neither stack pointer has
+  * moved since the core stacked the frame of the interrupted code; the
+  * tail branch returns from the exception through BSP_Profile_IRQHandler().
+  */
+__attribute__((naked)) void TIM7_IRQHandler(void)
+{
+  __asm volatile("mov r0, lr                 \n"
+                 "mrs r1, msp                \n"
+                 "mrs r2, psp                \n"
+                 "b   BSP_Profile_IRQHandler \n");
+}
+
+/**
+  * @brief This function handles FLASH non-secure global interrupt.
+  */
+void FLASH_IRQHandler(void)
+{
+  BSP_Flash_IRQHandler();
+}
+
+/**
+  * @brief This function handles the PVD (supply voltage detector) interrupt.
+  */
+void PVD_AVD_IRQHandler(void)
+{
+  BSP_PVD_IRQHandler();
+}
+
+/**
+  * @brief This function handles EXTI Line0 (digital input edge) interrupt.
+  */
+void EXTI0_IRQHandler(void)
+{
+  BSP_GPIODI_IRQHandler(0U);
+}
+
+/**
+  * @brief This function handles EXTI Line1 (digital input edge) interrupt.
+  */
+void EXTI1_IRQHandler(void)
+{
+  BSP_GPIODI_IRQHandler(1U);
+}
+
+/**
+  * @brief This function handles EXTI Line2 (digital input edge) interrupt.
+  */
+void EXTI2_IRQHandler(void)
+{
+  BSP_GPIODI_IRQHandler(2U);
+}
+
+/**
+  * @brief This function handles EXTI Line3 (PHY nINT) interrupt.
+  */
+void EXTI3_IRQHandler(void)
+{
+  ethernetif_phy_irq_handler();
+}
+
+/**
+  * @brief This function handles EXTI Line9 (digital input edge) interrupt.
+  */
+void EXTI9_IRQHandler(void)
+{
+  BSP_GPIODI_IRQHandler(9U);
+}
+
+/**
+  * @brief This function handles FDCAN1 interrupt 0.
+  */
+void FDCAN1_IT0_IRQHandler(void)
+{
+  BSP_CAN_IRQHandler();
+}
+
+/**
+  * @brief This function handles USB FS global interrupt.
+  */
+void USB_DRD_FS_IRQHandler(void)
+{
+  BSP_USBH_IRQHandler();
+}
+
 /* USER CODE END 1 */
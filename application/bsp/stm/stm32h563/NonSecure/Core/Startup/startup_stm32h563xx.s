@@ -42,6 +42,13 @@ defined in linker script */
 .word _sbss
 /* end address for the .bss section. defined in linker script */
 .word _ebss
+/* start address for the initialization values of the .sram2 section.
+defined in linker script */
+.word _sisram2
+/* start address for the .sram2 section. defined in linker script */
+.word _ssram2
+/* end address for the .sram2 section. defined in linker script */
+.word _esram2
 
 /**
   * @brief  This is the code that gets called when the processor first
@@ -78,6 +85,23 @@ LoopCopyDataInit:
   cmp r4, r1
   bcc CopyDataInit
 
+/* Copy the SRAM2 code and constants from flash to SRAM2 */
+  ldr r0, =_ssram2
+  ldr r1, =_esram2
+  ldr r2, =_sisram2
+  movs r3, #0
+  b LoopCopySram2Init
+
+CopySram2Init:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopySram2Init:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopySram2Init
+
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
   ldr r4, =_ebss
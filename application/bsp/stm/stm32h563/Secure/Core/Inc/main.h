@@ -74,6 +74,8 @@ void MX_GTZC_S_Init(void);
 void MX_ICACHE_Init(void);
 
 /* USER CODE BEGIN EFP */
+void Secure_RandomInit(void);
+void Secure_RandomIRQHandler(void);
 
 /* USER CODE END EFP */
 
@@ -83,12 +83,12 @@
 /*
 //     <o>Start Address <0-0xFFFFFFE0>
 */
-#define SAU_INIT_START0     0x0C0FE000      /* start address of SAU region 0 */
+#define SAU_INIT_START0     0x0C01E000      /* start address of SAU region 0 */
 
 /*
 //     <o>End Address <0x1F-0xFFFFFFFF>
 */
-#define SAU_INIT_END0       0x0C0FFFFF      /* end address of SAU region 0 */
+#define SAU_INIT_END0       0x0C01FFFF      /* end address of SAU region 0 */
 
 /*
 //     <o>Region is
@@ -109,7 +109,7 @@
 /*
 //     <o>Start Address <0-0xFFFFFFE0>
 */
-#define SAU_INIT_START1     0x08100000      /* start address of SAU region 1 */
+#define SAU_INIT_START1     0x08020000      /* start address of SAU region 1 */
 
 /*
 //     <o>End Address <0x1F-0xFFFFFFFF>
@@ -135,7 +135,7 @@
 /*
 //     <o>Start Address <0-0xFFFFFFE0>
 */
-#define SAU_INIT_START2     0x20050000      /* start address of SAU region 2 */
+#define SAU_INIT_START2     0x20040000      /* start address of SAU region 2 */
 
 /*
 //     <o>End Address <0x1F-0xFFFFFFFF>
@@ -380,26 +380,26 @@
 /*
 // Interrupts 0..31
 //   <o.0>  WWDG_IRQn             <0=> Secure state
-//   <o.1>  PVD_AVD_IRQn          <0=> Secure state
+//   <o.1>  PVD_AVD_IRQn          <1=> Non-Secure state
 //   <o.2>  RTC_IRQn              <0=> Secure state
 //   <o.3>  RTC_S_IRQn            <0=> Secure state
 //   <o.4>  TAMP_IRQn             <0=> Secure state
 //   <o.5>  RAMCFG_IRQn           <0=> Secure state
-//   <o.6>  FLASH_IRQn            <0=> Secure state
+//   <o.6>  FLASH_IRQn            <1=> Non-Secure state
 //   <o.7>  FLASH_S_IRQn          <0=> Secure state
 //   <o.8>  GTZC_IRQn             <0=> Secure state
 //   <o.9>  RCC_IRQn              <0=> Secure state
 //   <o.10> RCC_S_IRQn            <0=> Secure state
-//   <o.11> EXTI0_IRQn            <0=> Secure state
-//   <o.12> EXTI1_IRQn            <0=> Secure state
-//   <o.13> EXTI2_IRQn            <0=> Secure state
-//   <o.14> EXTI3_IRQn            <0=> Secure state
+//   <o.11> EXTI0_IRQn            <1=> Non-Secure state
+//   <o.12> EXTI1_IRQn            <1=> Non-Secure state
+//   <o.13> EXTI2_IRQn            <1=> Non-Secure state
+//   <o.14> EXTI3_IRQn            <1=> Non-Secure state
 //   <o.15> EXTI4_IRQn            <0=> Secure state
 //   <o.16> EXTI5_IRQn            <0=> Secure state
 //   <o.17> EXTI6_IRQn            <0=> Secure state
 //   <o.18> EXTI7_IRQn            <0=> Secure state
 //   <o.19> EXTI8_IRQn            <0=> Secure state
-//   <o.20> EXTI9_IRQn            <0=> Secure state
+//   <o.20> EXTI9_IRQn            <1=> Non-Secure state
 //   <o.21> EXTI10_IRQn           <0=> Secure state
 //   <o.22> EXTI11_IRQn           <0=> Secure state
 //   <o.23> EXTI12_IRQn           <0=> Secure state
@@ -407,12 +407,12 @@
 //   <o.25> EXTI14_IRQn           <0=> Secure state
 //   <o.26> EXTI15_IRQn           <0=> Secure state
 //   <o.27> GPDMA1_Channel0_IRQn  <1=> Non-Secure state
-//   <o.28> GPDMA1_Channel1_IRQn  <0=> Secure state
-//   <o.29> GPDMA1_Channel2_IRQn  <0=> Secure state
-//   <o.30> GPDMA1_Channel3_IRQn  <0=> Secure state
-//   <o.31> GPDMA1_Channel4_IRQn  <0=> Secure state
+//   <o.28> GPDMA1_Channel1_IRQn  <1=> Non-Secure state
+//   <o.29> GPDMA1_Channel2_IRQn  <1=> Non-Secure state
+//   <o.30> GPDMA1_Channel3_IRQn  <1=> Non-Secure state
+//   <o.31> GPDMA1_Channel4_IRQn  <1=> Non-Secure state
 */
-#define NVIC_INIT_ITNS0_VAL      0x09000000
+#define NVIC_INIT_ITNS0_VAL      0xF9107842
 
 /*
 //   </e>
@@ -426,18 +426,18 @@
 /*
 // Interrupts 32..63
 //   <o.0>  GPDMA1_Channel5_IRQn  <0=> Secure state
-//   <o.1>  GPDMA1_Channel6_IRQn  <0=> Secure state
-//   <o.2>  GPDMA1_Channel7_IRQn  <0=> Secure state
+//   <o.1>  GPDMA1_Channel6_IRQn  <1=> Non-Secure state
+//   <o.2>  GPDMA1_Channel7_IRQn  <1=> Non-Secure state
 //   <o.3>  IWDG_IRQn             <0=> Secure state
-//   <o.5>  ADC1_IRQn             <0=> Secure state
+//   <o.5>  ADC1_IRQn             <1=> Non-Secure state
 //   <o.6>  DAC1_IRQn             <0=> Secure state
-//   <o.7>  FDCAN1_IT0_IRQn       <0=> Secure state
+//   <o.7>  FDCAN1_IT0_IRQn       <1=> Non-Secure state
 //   <o.8>  FDCAN1_IT1_IRQn       <0=> Secure state
 //   <o.9>  TIM1_BRK_IRQn         <0=> Secure state
 //   <o.10> TIM1_UP_IRQn          <0=> Secure state
 //   <o.11> TIM1_TRG_COM_IRQn     <0=> Secure state
 //   <o.12> TIM1_CC_IRQn          <0=> Secure state
-//   <o.13> TIM2_IRQn             <0=> Secure state
+//   <o.13> TIM2_IRQn             <1=> Non-Secure state
 //   <o.14> TIM3_IRQn             <0=> Secure state
 //   <o.15> TIM4_IRQn             <0=> Secure state
 //   <o.16> TIM5_IRQn             <0=> Secure state
@@ -451,13 +451,13 @@
 //   <o.24> SPI2_IRQn             <0=> Secure state
 //   <o.25> SPI3_IRQn             <0=> Secure state
 //   <o.26> USART1_IRQn           <0=> Secure state
-//   <o.27> USART2_IRQn           <0=> Secure state
-//   <o.28> USART3_IRQn           <0=> Secure state
+//   <o.27> USART2_IRQn           <1=> Non-Secure state
+//   <o.28> USART3_IRQn           <1=> Non-Secure state
 //   <o.29> UART4_IRQn            <0=> Secure state
 //   <o.30> UART5_IRQn            <0=> Secure state
 //   <o.31> LPUART1_IRQn          <0=> Secure state
 */
-#define NVIC_INIT_ITNS1_VAL      0x00020000
+#define NVIC_INIT_ITNS1_VAL      0x180220A6
 
 /*
 //   </e>
@@ -470,24 +470,24 @@
 
 /*
 // Interrupts 64..95
-//   <o.0>  LPTIM1_IRQn           <0=> Secure state
+//   <o.0>  LPTIM1_IRQn           <1=> Non-Secure state
 //   <o.1>  TIM8_BRK_IRQn         <0=> Secure state
 //   <o.2>  TIM8_UP_IRQn          <0=> Secure state
 //   <o.3>  TIM8_TRG_COM_IRQn     <0=> Secure state
 //   <o.4>  TIM8_CC_IRQn          <0=> Secure state
-//   <o.5>  ADC2_IRQn             <0=> Secure state
+//   <o.5>  ADC2_IRQn             <1=> Non-Secure state
 //   <o.6>  LPTIM2_IRQn           <0=> Secure state
 //   <o.7>  TIM15_IRQn            <0=> Secure state
 //   <o.8>  TIM16_IRQn            <0=> Secure state
 //   <o.9>  TIM17_IRQn            <0=> Secure state
-//   <o.10> USB_DRD_FS_IRQn       <0=> Secure state
+//   <o.10> USB_DRD_FS_IRQn       <1=> Non-Secure state
 //   <o.11> CRS_IRQn              <0=> Secure state
 //   <o.12> UCPD1_IRQn            <0=> Secure state
 //   <o.13> FMC_IRQn              <0=> Secure state
 //   <o.14> OCTOSPI1_IRQn         <0=> Secure state
 //   <o.15> SDMMC1_IRQn           <0=> Secure state
-//   <o.16> I2C3_EV_IRQn          <0=> Secure state
-//   <o.17> I2C3_ER_IRQn          <0=> Secure state
+//   <o.16> I2C3_EV_IRQn          <1=> Non-Secure state
+//   <o.17> I2C3_ER_IRQn          <1=> Non-Secure state
 //   <o.18> SPI4_IRQn             <0=> Secure state
 //   <o.19> SPI5_IRQn             <0=> Secure state
 //   <o.20> SPI6_IRQn             <0=> Secure state
@@ -503,7 +503,7 @@
 //   <o.30> GPDMA2_Channel4_IRQn  <0=> Secure state
 //   <o.31> GPDMA2_Channel5_IRQn  <0=> Secure state
 */
-#define NVIC_INIT_ITNS2_VAL      0x00000000
+#define NVIC_INIT_ITNS2_VAL      0x00030421
 
 /*
 //   </e>
@@ -54,6 +54,7 @@ void UsageFault_Handler(void);
 void SecureFault_Handler(void);
 void DebugMon_Handler(void);
 /* USER CODE BEGIN EFP */
+void RNG_IRQHandler(void);
 
 /* USER CODE END EFP */
 
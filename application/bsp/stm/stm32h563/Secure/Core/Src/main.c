@@ -36,10 +36,12 @@
 
 /* USER CODE BEGIN VTOR_TABLE */
 
-/* Non-secure Vector table to jump to (internal Flash Bank2 here)             */
+/* Non-secure Vector table to jump to (internal Flash of the bank mapped at   */
+/* 0x08000000, above the 128K secure area; the other bank holds the FOTA      */
+/* update slot at the same offset)                                            */
 /* Caution: address must correspond to non-secure internal Flash where is     */
 /*          mapped in the non-secure vector table                             */
-#define VTOR_TABLE_NS_START_ADDR  0x08100000UL
+#define VTOR_TABLE_NS_START_ADDR  0x08020000UL
 
 /* USER CODE END VTOR_TABLE*/
 
@@ -74,6 +76,8 @@ int main(void)
   MX_GTZC_S_Init();
   MX_GPIO_Init();
   MX_ICACHE_Init();
+  /* Entropy is collected from the first non-secure instruction on */
+  Secure_RandomInit();
    /* Disable Secure SysTick before jumping to Non-Secure */
   SysTick->CTRL = 0;
   NonSecure_Init();
@@ -133,6 +137,20 @@ void MX_GTZC_S_Init(void)
   {
     Error_Handler();
   }
+  /* HASH, PKA and the RNG that PKA needs are used only by the secure image
+   * verification (secure_nsc.c), so non-secure code cannot alter a check */
+  if (HAL_GTZC_TZSC_ConfigPeriphAttributes(GTZC_PERIPH_HASH, GTZC_TZSC_PERIPH_SEC) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_GTZC_TZSC_ConfigPeriphAttributes(GTZC_PERIPH_PKA, GTZC_TZSC_PERIPH_SEC) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_GTZC_TZSC_ConfigPeriphAttributes(GTZC_PERIPH_RNG, GTZC_TZSC_PERIPH_SEC) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE END GTZC_S_Init 1 */
   MPCBB_Area_Desc.SecureRWIllegalMode = GTZC_MPCBB_SRWILADIS_ENABLE;
   MPCBB_Area_Desc.InvertSecureState = GTZC_MPCBB_INVSECSTATE_NOT_INVERTED;
@@ -199,6 +217,16 @@ void MX_GTZC_S_Init(void)
   {
     Error_Handler();
   }
+
+  /* SRAM2 is the non-secure CPU bank (task stacks and interrupt code, see
+  * bsp_sections.h), so that CPU accesses do not contend with the DMA
+  * masters in SRAM3. The descriptor is already non-secure and
+  * non-privileged; only its first 64 KB worth of blocks apply.
+  */
+  if (HAL_GTZC_MPCBB_ConfigMem(SRAM2_BASE, &MPCBB_Area_Desc) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE END GTZC_S_Init 2 */
 
 }
@@ -278,6 +306,31 @@ void MX_GPIO_Init(void)
   HAL_GPIO_ConfigPinAttributes(GPIOF, GPIO_PIN_4, GPIO_PIN_NSEC);
 
   /* USER CODE BEGIN MX_GPIO_Init_2 */
+  /* RS-485 port (USART2 DE/TX/RX), driven by the non-secure BSP */
+  HAL_GPIO_ConfigPinAttributes(GPIOD, GPIO_PIN_4|GPIO_PIN_5|GPIO_PIN_6, GPIO_PIN_NSEC);
+
+  /* PWM outputs (TIM3/4/5/15 channel 1), driven by the non-secure BSP */
+  HAL_GPIO_ConfigPinAttributes(GPIOC, GPIO_PIN_6, GPIO_PIN_NSEC);
+  HAL_GPIO_ConfigPinAttributes(GPIOD, GPIO_PIN_12, GPIO_PIN_NSEC);
+  HAL_GPIO_ConfigPinAttributes(GPIOA, GPIO_PIN_0, GPIO_PIN_NSEC);
+  HAL_GPIO_ConfigPinAttributes(GPIOE, GPIO_PIN_5, GPIO_PIN_NSEC);
+
+  /* CAN FD port (FDCAN1 RX/TX), driven by the non-secure BSP */
+  HAL_GPIO_ConfigPinAttributes(GPIOB, GPIO_PIN_8|GPIO_PIN_9, GPIO_PIN_NSEC);
+
+  /* External SPI ADC (SPI1 SCK/MISO/NSS, TIM8 CONVST), driven by the
+     non-secure BSP when built in */
+  HAL_GPIO_ConfigPinAttributes(GPIOA, GPIO_PIN_5, GPIO_PIN_NSEC);
+  HAL_GPIO_ConfigPinAttributes(GPIOG, GPIO_PIN_9|GPIO_PIN_10, GPIO_PIN_NSEC);
+  HAL_GPIO_ConfigPinAttributes(GPIOC, GPIO_PIN_7, GPIO_PIN_NSEC);
+
+  /* External SPI NOR flash (SPI3 SCK/MISO/MOSI, chip select), driven by the
+     non-secure BSP when built in */
+  HAL_GPIO_ConfigPinAttributes(GPIOC, GPIO_PIN_10|GPIO_PIN_11|GPIO_PIN_12, GPIO_PIN_NSEC);
+  HAL_GPIO_ConfigPinAttributes(GPIOA, GPIO_PIN_15, GPIO_PIN_NSEC);
+
+  /* PHY interrupt (LAN8742 nINT), served by the non-secure ethernetif */
+  HAL_GPIO_ConfigPinAttributes(GPIOE, GPIO_PIN_3, GPIO_PIN_NSEC);
 
   /* USER CODE END MX_GPIO_Init_2 */
 }
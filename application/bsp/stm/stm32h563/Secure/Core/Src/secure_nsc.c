@@ -20,8 +20,12 @@
 
 /* USER CODE BEGIN Non_Secure_CallLib */
 /* Includes ------------------------------------------------------------------*/
+#include <arm_cmse.h>
+#include <string.h>
+
 #include "main.h"
 #include "secure_nsc.h"
+#include "fota_public_key.h"
 /** @addtogroup STM32H5xx_HAL_Examples
 
   * @{
@@ -34,14 +38,687 @@
 /* Global variables ----------------------------------------------------------*/
 void *pSecureFaultCallback = NULL;   /* Pointer to secure fault callback in Non-secure */
 void *pSecureErrorCallback = NULL;   /* Pointer to secure error callback in Non-secure */
+void *pFlashEccCallback = NULL;      /* Pointer to flash ECC error callback in Non-secure */
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+/* Secure area at the start of each bank: secure image and NSC veneers,
+   sectors 0-15 under SECWM1 and SECWM2 */
+#define SECURE_AREA_SIZE        0x00020000UL
+#define SECURE_AREA_SECTORS     (SECURE_AREA_SIZE / FLASH_SECTOR_SIZE)
+
+/* Secure alias of the bank mapped one bank above 0x0C000000, the inactive one */
+#define SECURE_INACTIVE_BASE    (FLASH_BASE_S + FLASH_BANK_SIZE)
+
+/* Image verification: SHA-256 on HASH, fed by GPDMA2 channel 0, then
+   ECDSA P-256 on PKA */
+#define VERIFY_HASH_SHA256      (0x3UL << HASH_CR_ALGO_Pos)
+#define VERIFY_HASH_BYTES       (0x2UL << HASH_CR_DATATYPE_Pos)
+#define VERIFY_DIGEST_WORDS     8U
+#define VERIFY_CURVE_SIZE       32U
+#define VERIFY_CURVE_BITS       256U
+#define VERIFY_DMA_MAX_LENGTH   0xFFFCUL
+#define VERIFY_DMA_TIMEOUT      100U
+
+/* PKA ECDSA verification operation and its operands in PKA RAM (RM0481) */
+#define VERIFY_PKA_MODE_ECDSA   0x26UL
+#define VERIFY_PKA_VALID        0xD60DUL
+#define VERIFY_PKA_RAM(addr)    (((addr) - 0x0400UL) >> 2U)
+#define VERIFY_PKA_ORDER_BITS   VERIFY_PKA_RAM(0x0408UL)
+#define VERIFY_PKA_MOD_BITS     VERIFY_PKA_RAM(0x04B8UL)
+#define VERIFY_PKA_A_SIGN       VERIFY_PKA_RAM(0x0468UL)
+#define VERIFY_PKA_A            VERIFY_PKA_RAM(0x046CUL)
+#define VERIFY_PKA_MOD          VERIFY_PKA_RAM(0x04C0UL)
+#define VERIFY_PKA_GX           VERIFY_PKA_RAM(0x05E8UL)
+#define VERIFY_PKA_GY           VERIFY_PKA_RAM(0x063CUL)
+#define VERIFY_PKA_RESULT       VERIFY_PKA_RAM(0x05B0UL)
+#define VERIFY_PKA_ORDER        VERIFY_PKA_RAM(0x0D5CUL)
+#define VERIFY_PKA_QX           VERIFY_PKA_RAM(0x0F40UL)
+#define VERIFY_PKA_QY           VERIFY_PKA_RAM(0x0F94UL)
+#define VERIFY_PKA_E            VERIFY_PKA_RAM(0x0FE8UL)
+#define VERIFY_PKA_R            VERIFY_PKA_RAM(0x1098UL)
+#define VERIFY_PKA_S            VERIFY_PKA_RAM(0x0A44UL)
+#define VERIFY_PKA_ERRORS       (PKA_SR_RAMERRF | PKA_SR_ADDRERRF | PKA_SR_OPERRF)
+#define VERIFY_PKA_CLEAR        (PKA_CLRFR_PROCENDFC | PKA_CLRFR_RAMERRFC | \
+                                 PKA_CLRFR_ADDRERRFC | PKA_CLRFR_OPERRFC)
+
+/* Entropy pool: words of the TRNG's conditioned output, filled from its
+   interrupt and drained by SECURE_OP_RANDOM. A power of two. */
+#define RANDOM_POOL_WORDS       64U
+#define RANDOM_IRQ_PRIORITY     15U
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
+/* NIST P-256 domain parameters, big-endian */
+static const uint8_t Verify_CurveP[VERIFY_CURVE_SIZE] =
+{
+  0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+static const uint8_t Verify_CurveN[VERIFY_CURVE_SIZE] =
+{
+  0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xBC, 0xE6, 0xFA, 0xAD, 0xA7, 0x17, 0x9E, 0x84,
+  0xF3, 0xB9, 0xCA, 0xC2, 0xFC, 0x63, 0x25, 0x51
+};
+static const uint8_t Verify_CurveGx[VERIFY_CURVE_SIZE] =
+{
+  0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47, 0xF8, 0xBC, 0xE6, 0xE5,
+  0x63, 0xA4, 0x40, 0xF2, 0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0,
+  0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96
+};
+static const uint8_t Verify_CurveGy[VERIFY_CURVE_SIZE] =
+{
+  0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B, 0x8E, 0xE7, 0xEB, 0x4A,
+  0x7C, 0x0F, 0x9E, 0x16, 0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE,
+  0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5
+};
+/* |a| = 3, a is negative */
+static const uint8_t Verify_CurveA[1] = { 0x03 };
+
+/* Image signing public key, X then Y, big-endian, from the key the build
+   is configured with (JERRY_FOTA_KEY, fota_key.cmake) */
+static const uint8_t Verify_PublicKey[2U * VERIFY_CURVE_SIZE] =
+{
+  FOTA_PUBLIC_KEY_BYTES
+};
+
+static DMA_HandleTypeDef hdma_verify;
+static uint8_t Verify_Active = 0U;     /* Between the start and finish requests */
+static uint8_t Verify_DmaBusy = 0U;    /* A block is being fed to HASH */
+static uint8_t Verify_Passed = 0U;     /* The last image checked is signed */
+static uint32_t Verify_Tail = 0U;      /* Last partial word of the image */
+static uint32_t Verify_TailBits = 0U;  /* Its valid bits, 0 if none yet */
+
+/* Written by the RNG interrupt only (head) or by SECURE_OP_RANDOM only (tail) */
+static uint32_t Random_Pool[RANDOM_POOL_WORDS];
+static volatile uint32_t Random_Head = 0U;
+static volatile uint32_t Random_Tail = 0U;
+static volatile uint32_t Random_Errors = 0U; /* Seed and clock errors recovered */
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 
+/**
+  * @brief  Physical bank mapped at the inactive (upper) address range.
+  * @note   Erase selects banks physically, so the choice inverts once the
+  *         banks are swapped.
+  * @retval FLASH_BANK_1 or FLASH_BANK_2
+  */
+static uint32_t Secure_InactiveBank(void)
+{
+  return ((FLASH->OPTSR_CUR & FLASH_OPTSR_SWAP_BANK) != 0U) ? FLASH_BANK_1 : FLASH_BANK_2;
+}
+
+/**
+  * @brief  Copy the running secure area to the inactive bank if it differs.
+  * @note   The non-secure update only writes the application area of the
+  *         inactive bank, so the secure firmware is carried over here before
+  *         the banks are swapped.
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef Secure_CopySecureArea(void)
+{
+  FLASH_EraseInitTypeDef erase = {0};
+  uint32_t sector_error = 0U;
+  uint32_t offset;
+  HAL_StatusTypeDef status;
+
+  if (memcmp((const void *)FLASH_BASE_S, (const void *)SECURE_INACTIVE_BASE,
+             SECURE_AREA_SIZE) == 0)
+  {
+    return HAL_OK;
+  }
+
+  erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+  erase.Banks = Secure_InactiveBank();
+  erase.Sector = 0U;
+  erase.NbSectors = SECURE_AREA_SECTORS;
+  status = HAL_FLASHEx_Erase(&erase, &sector_error);
+
+  for (offset = 0U; (status == HAL_OK) && (offset < SECURE_AREA_SIZE); offset += 16U)
+  {
+    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_QUADWORD, SECURE_INACTIVE_BASE + offset,
+                               FLASH_BASE_S + offset);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  Wait for the block being fed to HASH.
+  * @note   The secure SysTick is stopped, so the poll does not time out; a
+  *         block of a few KB takes some microseconds.
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef Verify_WaitDma(void)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+
+  if (Verify_DmaBusy != 0U)
+  {
+    status = HAL_DMA_PollForTransfer(&hdma_verify, HAL_DMA_FULL_TRANSFER, VERIFY_DMA_TIMEOUT);
+    Verify_DmaBusy = 0U;
+  }
+
+  return status;
+}
+
+/**
+  * @brief  Abandon the image being checked.
+  * @retval SECURE_STATUS_ERROR
+  */
+static SECURE_StatusTypeDef Verify_Abort(void)
+{
+  if (Verify_DmaBusy != 0U)
+  {
+    (void)HAL_DMA_Abort(&hdma_verify);
+    Verify_DmaBusy = 0U;
+  }
+  CLEAR_BIT(HASH->CR, HASH_CR_DMAE);
+  Verify_Active = 0U;
+
+  return SECURE_STATUS_ERROR;
+}
+
+/**
+  * @brief  Set up GPDMA2 channel 0 to feed HASH from non-secure memory.
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef Verify_InitDma(void)
+{
+  if (hdma_verify.Instance != NULL)
+  {
+    return HAL_OK;
+  }
+
+  __HAL_RCC_GPDMA2_CLK_ENABLE();
+
+  hdma_verify.Instance = GPDMA2_Channel0;
+  hdma_verify.Init.Request = GPDMA2_REQUEST_HASH_IN;
+  hdma_verify.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
+  hdma_verify.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_verify.Init.SrcInc = DMA_SINC_INCREMENTED;
+  hdma_verify.Init.DestInc = DMA_DINC_FIXED;
+  hdma_verify.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_WORD;
+  hdma_verify.Init.DestDataWidth = DMA_DEST_DATAWIDTH_WORD;
+  hdma_verify.Init.Priority = DMA_LOW_PRIORITY_LOW_WEIGHT;
+  hdma_verify.Init.SrcBurstLength = 1;
+  hdma_verify.Init.DestBurstLength = 1;
+  hdma_verify.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1;
+  hdma_verify.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+  hdma_verify.Init.Mode = DMA_NORMAL;
+  if (HAL_DMA_Init(&hdma_verify) != HAL_OK)
+  {
+    hdma_verify.Instance = NULL;
+    return HAL_ERROR;
+  }
+
+  /* Secure channel reading the non-secure chunk buffers */
+  return HAL_DMA_ConfigChannelAttributes(&hdma_verify,
+                                         DMA_CHANNEL_SEC | DMA_CHANNEL_SRC_NSEC | DMA_CHANNEL_DEST_SEC);
+}
+
+/**
+  * @brief  Load a big-endian number into PKA RAM.
+  * @param  index Word offset of the operand
+  * @param  src   Number, most significant byte first
+  * @param  size  Size in bytes
+  * @retval None
+  */
+static void Verify_PkaLoad(uint32_t index, const uint8_t *src, uint32_t size)
+{
+  uint32_t i;
+  uint32_t word;
+
+  for (i = 0U; (4U * i) < size; i++)
+  {
+    word = 0U;
+    for (uint32_t b = 0U; (b < 4U) && ((4U * i) + b < size); b++)
+    {
+      word |= (uint32_t)src[size - 1U - (4U * i) - b] << (8U * b);
+    }
+    PKA->RAM[index + i] = word;
+  }
+
+  /* Operands end with a zero 64-bit word */
+  PKA->RAM[index + i] = 0U;
+  PKA->RAM[index + i + 1U] = 0U;
+}
+
+/**
+  * @brief  Verify an ECDSA P-256 signature.
+  * @param  key       Public key, X then Y, big-endian
+  * @param  hash      Digest, big-endian, VERIFY_CURVE_SIZE bytes
+  * @param  signature r then s, big-endian
+  * @retval SECURE_STATUS_OK if the signature is valid
+  */
+static SECURE_StatusTypeDef Verify_Ecdsa(const uint8_t *key, const uint8_t *hash,
+                                         const uint8_t *signature)
+{
+  SECURE_StatusTypeDef result = SECURE_STATUS_BAD_SIGNATURE;
+  uint32_t sr;
+
+  /* PKA erases its RAM on enable, which needs the RNG clock */
+  __HAL_RCC_RNG_CLK_ENABLE();
+  __HAL_RCC_PKA_CLK_ENABLE();
+  PKA->CR = PKA_CR_EN;
+  while ((PKA->SR & PKA_SR_INITOK) == 0U)
+  {
+  }
+  PKA->CLRFR = VERIFY_PKA_CLEAR;
+
+  PKA->RAM[VERIFY_PKA_ORDER_BITS] = VERIFY_CURVE_BITS;
+  PKA->RAM[VERIFY_PKA_ORDER_BITS + 1U] = 0U;
+  PKA->RAM[VERIFY_PKA_MOD_BITS] = VERIFY_CURVE_BITS;
+  PKA->RAM[VERIFY_PKA_MOD_BITS + 1U] = 0U;
+  PKA->RAM[VERIFY_PKA_A_SIGN] = 1U;
+  PKA->RAM[VERIFY_PKA_A_SIGN + 1U] = 0U;
+  Verify_PkaLoad(VERIFY_PKA_A, Verify_CurveA, sizeof(Verify_CurveA));
+  Verify_PkaLoad(VERIFY_PKA_MOD, Verify_CurveP, VERIFY_CURVE_SIZE);
+  Verify_PkaLoad(VERIFY_PKA_GX, Verify_CurveGx, VERIFY_CURVE_SIZE);
+  Verify_PkaLoad(VERIFY_PKA_GY, Verify_CurveGy, VERIFY_CURVE_SIZE);
+  Verify_PkaLoad(VERIFY_PKA_ORDER, Verify_CurveN, VERIFY_CURVE_SIZE);
+  Verify_PkaLoad(VERIFY_PKA_QX, &key[0], VERIFY_CURVE_SIZE);
+  Verify_PkaLoad(VERIFY_PKA_QY, &key[VERIFY_CURVE_SIZE], VERIFY_CURVE_SIZE);
+  Verify_PkaLoad(VERIFY_PKA_E, hash, VERIFY_CURVE_SIZE);
+  Verify_PkaLoad(VERIFY_PKA_R, &signature[0], VERIFY_CURVE_SIZE);
+  Verify_PkaLoad(VERIFY_PKA_S, &signature[VERIFY_CURVE_SIZE], VERIFY_CURVE_SIZE);
+
+  PKA->CR = PKA_CR_EN | (VERIFY_PKA_MODE_ECDSA << PKA_CR_MODE_Pos);
+  PKA->CR |= PKA_CR_START;
+  do
+  {
+    sr = PKA->SR;
+  } while ((sr & (PKA_SR_PROCENDF | VERIFY_PKA_ERRORS)) == 0U);
+
+  if (((sr & VERIFY_PKA_ERRORS) == 0U) && (PKA->RAM[VERIFY_PKA_RESULT] == VERIFY_PKA_VALID))
+  {
+    result = SECURE_STATUS_OK;
+  }
+
+  /* Disabling PKA erases the operands */
+  PKA->CLRFR = VERIFY_PKA_CLEAR;
+  PKA->CR = 0U;
+  __HAL_RCC_PKA_CLK_DISABLE();
+
+  return result;
+}
+
+/**
+  * @brief  Start checking an update image.
+  * @note   Any image being checked is abandoned.
+  * @retval SECURE_STATUS_OK, or SECURE_STATUS_ERROR if HASH cannot be fed
+  */
+static SECURE_StatusTypeDef Verify_Start(void)
+{
+  (void)Verify_Abort();
+  Verify_Passed = 0U;
+  Verify_Tail = 0U;
+  Verify_TailBits = 0U;
+
+  __HAL_RCC_HASH_CLK_ENABLE();
+  if (Verify_InitDma() != HAL_OK)
+  {
+    return SECURE_STATUS_ERROR;
+  }
+
+  /* SHA-256 over bytes; DMA blocks do not end the message */
+  HASH->CR = VERIFY_HASH_SHA256 | VERIFY_HASH_BYTES | HASH_CR_MDMAT;
+  HASH->CR |= HASH_CR_INIT;
+  Verify_Active = 1U;
+
+  return SECURE_STATUS_OK;
+}
+
+/**
+  * @brief  Add image bytes to the digest.
+  * @note   Returns once the block is handed to GPDMA2, which feeds HASH in
+  *         the background; the caller keeps @p data unchanged until its next
+  *         update or finish request. Only the last block may have a length
+  *         that is not a multiple of 4.
+  * @param  data   Non-secure block, 32-bit aligned
+  * @param  length Bytes, at most 65532
+  * @retval SECURE_STATUS_OK, or SECURE_STATUS_ERROR after which the image
+  *         must be started again
+  */
+static SECURE_StatusTypeDef Verify_Update(const void *data, uint32_t length)
+{
+  uint32_t aligned = length & ~3UL;
+
+  if ((Verify_Active == 0U) || (Verify_TailBits != 0U) || (((uint32_t)data & 3U) != 0U) ||
+      (length > VERIFY_DMA_MAX_LENGTH))
+  {
+    return Verify_Abort();
+  }
+  if (Verify_WaitDma() != HAL_OK)
+  {
+    return Verify_Abort();
+  }
+
+  if ((length & 3U) != 0U)
+  {
+    (void)memcpy(&Verify_Tail, (const uint8_t *)data + aligned, length & 3U);
+    Verify_TailBits = (length & 3U) * 8U;
+  }
+  if (aligned != 0U)
+  {
+    SET_BIT(HASH->CR, HASH_CR_DMAE);
+    if (HAL_DMA_Start(&hdma_verify, (uint32_t)data, (uint32_t)&HASH->DIN, aligned) != HAL_OK)
+    {
+      return Verify_Abort();
+    }
+    Verify_DmaBusy = 1U;
+  }
+
+  return SECURE_STATUS_OK;
+}
+
+/**
+  * @brief  End the digest and check the image signature.
+  * @param  signature ECDSA P-256 signature of the SHA-256 of the image,
+  *         r then s, big-endian (SECURE_VERIFY_SIGNATURE_SIZE bytes)
+  * @retval SECURE_STATUS_OK if the image is signed with the signing key,
+  *         SECURE_STATUS_BAD_SIGNATURE if not, SECURE_STATUS_ERROR if no
+  *         image was being checked or the hardware failed
+  */
+static SECURE_StatusTypeDef Verify_Finish(const uint8_t *signature)
+{
+  uint8_t sig[SECURE_VERIFY_SIGNATURE_SIZE];
+  uint8_t digest[4U * VERIFY_DIGEST_WORDS];
+  SECURE_StatusTypeDef result;
+  uint32_t word;
+
+  if (Verify_Active == 0U)
+  {
+    return Verify_Abort();
+  }
+  if (Verify_WaitDma() != HAL_OK)
+  {
+    return Verify_Abort();
+  }
+
+  /* Copied first, non-secure memory may change under the check */
+  (void)memcpy(sig, signature, sizeof(sig));
+
+  CLEAR_BIT(HASH->CR, HASH_CR_DMAE);
+  if (Verify_TailBits != 0U)
+  {
+    HASH->DIN = Verify_Tail;
+  }
+  MODIFY_REG(HASH->STR, HASH_STR_NBLW, Verify_TailBits);
+  SET_BIT(HASH->STR, HASH_STR_DCAL);
+  while ((HASH->SR & HASH_SR_DCIS) == 0U)
+  {
+  }
+
+  for (uint32_t i = 0U; i < VERIFY_DIGEST_WORDS; i++)
+  {
+    word = HASH_DIGEST->HR[i];
+    digest[4U * i] = (uint8_t)(word >> 24);
+    digest[(4U * i) + 1U] = (uint8_t)(word >> 16);
+    digest[(4U * i) + 2U] = (uint8_t)(word >> 8);
+    digest[(4U * i) + 3U] = (uint8_t)word;
+  }
+
+  result = Verify_Ecdsa(Verify_PublicKey, digest, sig);
+  Verify_Active = 0U;
+  Verify_Passed = (result == SECURE_STATUS_OK) ? 1U : 0U;
+
+  return result;
+}
+
+/**
+  * @brief  Read words from the entropy pool without waiting.
+  * @note   The pool is refilled in the background, so a read that finds it
+  *         short returns what there is rather than waiting on the TRNG.
+  * @param  buffer Non-secure buffer, 32-bit aligned
+  * @param  length Bytes wanted, a multiple of 4; set to the bytes read
+  * @retval SECURE_STATUS_OK, SECURE_STATUS_INVALID for a misaligned buffer
+  */
+static SECURE_StatusTypeDef Random_Read(void *buffer, uint32_t *length)
+{
+  uint32_t *out = (uint32_t *)buffer;
+  uint32_t tail = Random_Tail;
+  uint32_t count = Random_Head - tail;
+  uint32_t i;
+
+  if (((*length & 3U) != 0U) || (((uint32_t)buffer & 3U) != 0U))
+  {
+    return SECURE_STATUS_INVALID;
+  }
+
+  if (count > (*length / 4U))
+  {
+    count = *length / 4U;
+  }
+  for (i = 0U; i < count; i++)
+  {
+    out[i] = Random_Pool[(tail + i) & (RANDOM_POOL_WORDS - 1U)];
+    /* Each word is given out once */
+    Random_Pool[(tail + i) & (RANDOM_POOL_WORDS - 1U)] = 0U;
+  }
+  Random_Tail = tail + count;
+  *length = count * 4U;
+
+  /* The interrupt stops once the pool is full; it cannot run while IE is
+     clear, so setting it here does not race with the handler */
+  if ((RNG->CR & RNG_CR_IE) == 0U)
+  {
+    SET_BIT(RNG->CR, RNG_CR_IE);
+  }
+
+  return SECURE_STATUS_OK;
+}
+
+/**
+  * @brief  Verify an ECDSA P-256 signature with a caller's key.
+  * @note   Only checks the signature; it does not count as an image check
+  *         for SECURE_SwapBank().
+  * @param  request Non-secure SECURE_ECDSA_REQUEST_SIZE bytes: public key X
+  *         and Y, digest, then r and s, all big-endian
+  * @retval SECURE_STATUS_OK if the signature is valid,
+  *         SECURE_STATUS_BAD_SIGNATURE if not
+  */
+static SECURE_StatusTypeDef Ecdsa_Verify(const uint8_t *request)
+{
+  uint8_t copy[SECURE_ECDSA_REQUEST_SIZE];
+
+  /* Copied first, non-secure memory may change under the check */
+  (void)memcpy(copy, request, sizeof(copy));
+
+  return Verify_Ecdsa(&copy[0], &copy[2U * VERIFY_CURVE_SIZE],
+                      &copy[3U * VERIFY_CURVE_SIZE]);
+}
+
+/**
+  * @brief  Turn the instruction cache on or off.
+  * @note   The cache belongs to the secure world. The on-target benchmark
+  *         (jerry_bench) times its kernels both ways; turning the cache off
+  *         waits for the invalidation that comes with it.
+  * @param  enable Non-zero to turn it on, in 2-way set associative mode,
+  *         with the hit and miss monitors counting from 0
+  * @retval SECURE_STATUS_OK, SECURE_STATUS_ERROR on a HAL failure
+  */
+static SECURE_StatusTypeDef ICache_Set(uint32_t enable)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+
+  if (enable == 0U)
+  {
+    status = HAL_ICACHE_Disable();
+  }
+  else if (HAL_ICACHE_IsEnabled() == 0U)
+  {
+    status = HAL_ICACHE_ConfigAssociativityMode(ICACHE_2WAYS);
+    if (status == HAL_OK)
+    {
+      status = HAL_ICACHE_Enable();
+    }
+    if (status == HAL_OK)
+    {
+      status = HAL_ICACHE_Monitor_Reset(ICACHE_MONITOR_HIT_MISS);
+    }
+    if (status == HAL_OK)
+    {
+      status = HAL_ICACHE_Monitor_Start(ICACHE_MONITOR_HIT_MISS);
+    }
+  }
+
+  return (status == HAL_OK) ? SECURE_STATUS_OK : SECURE_STATUS_ERROR;
+}
+
+/**
+  * @brief  Read the hit and miss monitors of the instruction cache and
+  *         restart them from 0.
+  * @note   Fetches between the two reads and the reset are not counted.
+  *         Neither monitor wraps; the miss monitor stops at 0xFFFF.
+  * @param  counts Non-secure buffer, 32-bit aligned: hits, then misses
+  * @retval SECURE_STATUS_OK, SECURE_STATUS_INVALID for a misaligned buffer,
+  *         SECURE_STATUS_ERROR on a HAL failure
+  */
+static SECURE_StatusTypeDef ICache_Monitor(uint32_t *counts)
+{
+  uint32_t hits;
+  uint32_t misses;
+
+  if (((uint32_t)counts & 3U) != 0U)
+  {
+    return SECURE_STATUS_INVALID;
+  }
+
+  hits = HAL_ICACHE_Monitor_GetHitValue();
+  misses = HAL_ICACHE_Monitor_GetMissValue();
+  if (HAL_ICACHE_Monitor_Reset(ICACHE_MONITOR_HIT_MISS) != HAL_OK)
+  {
+    return SECURE_STATUS_ERROR;
+  }
+  counts[0] = hits;
+  counts[1] = misses;
+
+  return SECURE_STATUS_OK;
+}
+
+/**
+  * @brief  Run one request of a batch.
+  * @param  request Secure copy of the request, its Length updated by
+  *         SECURE_OP_RANDOM
+  * @retval Request status
+  */
+static SECURE_StatusTypeDef Batch_Run(SECURE_RequestTypeDef *request)
+{
+  int flags = CMSE_NONSECURE | CMSE_MPU_READ;
+
+  if ((request->Operation == (uint32_t)SECURE_OP_RANDOM) ||
+      (request->Operation == (uint32_t)SECURE_OP_ICACHE_MONITOR))
+  {
+    flags = CMSE_NONSECURE | CMSE_MPU_READWRITE;
+  }
+  if ((request->Length != 0U) &&
+      (cmse_check_address_range(request->Buffer, request->Length, flags) == NULL))
+  {
+    return SECURE_STATUS_INVALID;
+  }
+
+  switch (request->Operation)
+  {
+    case SECURE_OP_NOP:
+      return SECURE_STATUS_OK;
+    case SECURE_OP_RANDOM:
+      return Random_Read(request->Buffer, &request->Length);
+    case SECURE_OP_VERIFY_START:
+      return Verify_Start();
+    case SECURE_OP_VERIFY_UPDATE:
+      return Verify_Update(request->Buffer, request->Length);
+    case SECURE_OP_VERIFY_FINISH:
+      if (request->Length != SECURE_VERIFY_SIGNATURE_SIZE)
+      {
+        return SECURE_STATUS_INVALID;
+      }
+      return Verify_Finish((const uint8_t *)request->Buffer);
+    case SECURE_OP_ECDSA_VERIFY:
+      if (request->Length != SECURE_ECDSA_REQUEST_SIZE)
+      {
+        return SECURE_STATUS_INVALID;
+      }
+      return Ecdsa_Verify((const uint8_t *)request->Buffer);
+    case SECURE_OP_ICACHE_ON:
+      return ICache_Set(1U);
+    case SECURE_OP_ICACHE_OFF:
+      return ICache_Set(0U);
+    case SECURE_OP_ICACHE_MONITOR:
+      if (request->Length != SECURE_ICACHE_MONITOR_SIZE)
+      {
+        return SECURE_STATUS_INVALID;
+      }
+      return ICache_Monitor((uint32_t *)request->Buffer);
+    default:
+      return SECURE_STATUS_INVALID;
+  }
+}
+
+/**
+  * @brief  Start filling the entropy pool.
+  * @note   Called by the secure main before the non-secure image starts.
+  *         The RNG runs from HSI48 (RNGSEL reset value), which the
+  *         non-secure clock setup would only enable later. Its output is
+  *         the conditioned one of the reset configuration, which meets
+  *         NIST SP 800-90B.
+  * @retval None
+  */
+void Secure_RandomInit(void)
+{
+  __HAL_RCC_HSI48_ENABLE();
+  while (__HAL_RCC_GET_FLAG(RCC_FLAG_HSI48RDY) == 0U)
+  {
+  }
+  __HAL_RCC_RNG_CLK_ENABLE();
+
+  HAL_NVIC_SetPriority(RNG_IRQn, RANDOM_IRQ_PRIORITY, 0U);
+  HAL_NVIC_EnableIRQ(RNG_IRQn);
+  SET_BIT(RNG->CR, RNG_CR_RNGEN | RNG_CR_IE);
+}
+
+/**
+  * @brief  Move TRNG output into the entropy pool.
+  * @note   Called from RNG_IRQHandler() on data ready or an error. On a
+  *         seed error the conditioning logic is reset as RM0481 describes
+  *         and the FIFO is not read. The interrupt is turned off once the
+  *         pool is full and back on by the next read.
+  * @retval None
+  */
+void Secure_RandomIRQHandler(void)
+{
+  uint32_t head = Random_Head;
+  uint32_t sr = RNG->SR;
+
+  if ((sr & (RNG_SR_SEIS | RNG_SR_CEIS)) != 0U)
+  {
+    Random_Errors++;
+    CLEAR_BIT(RNG->SR, RNG_SR_SEIS | RNG_SR_CEIS);
+    if ((sr & RNG_SR_SEIS) != 0U)
+    {
+      SET_BIT(RNG->CR, RNG_CR_CONDRST);
+      CLEAR_BIT(RNG->CR, RNG_CR_CONDRST);
+      return;
+    }
+  }
+
+  while (((RNG->SR & (RNG_SR_DRDY | RNG_SR_SECS)) == RNG_SR_DRDY) &&
+         ((head - Random_Tail) < RANDOM_POOL_WORDS))
+  {
+    Random_Pool[head & (RANDOM_POOL_WORDS - 1U)] = RNG->DR;
+    head++;
+  }
+  Random_Head = head;
+
+  if ((head - Random_Tail) >= RANDOM_POOL_WORDS)
+  {
+    CLEAR_BIT(RNG->CR, RNG_CR_IE);
+  }
+}
+
 /**
   * @brief  Secure registration of non-secure callback.
   * @param  CallbackId  callback identifier
@@ -60,6 +737,9 @@ CMSE_NS_ENTRY void SECURE_RegisterCallback(SECURE_CallbackIDTypeDef CallbackId,
       case GTZC_ERROR_CB_ID:             /* GTZC Interrupt occurred */
         pSecureErrorCallback = func;
         break;
+      case FLASH_ECC_CB_ID:              /* Flash ECC double error (NMI) */
+        pFlashEccCallback = func;
+        break;
       default:
         /* unknown */
         break;
@@ -67,6 +747,105 @@ CMSE_NS_ENTRY void SECURE_RegisterCallback(SECURE_CallbackIDTypeDef CallbackId,
   }
 }
 
+/**
+  * @brief  Boot the other flash bank.
+  * @note   Called by the non-secure FOTA once the update slot holds a
+  *         complete image. The secure area is copied to the inactive bank
+  *         if needed, then SWAP_BANK is toggled with a single option byte
+  *         program and the device resets. Until that program completes the
+  *         device keeps booting the current bank, so the swap is atomic.
+  *         Refused unless SECURE_OP_VERIFY_FINISH accepted the last image.
+  * @retval None, returns only if the swap could not be made
+  */
+CMSE_NS_ENTRY void SECURE_SwapBank(void)
+{
+  FLASH_OBProgramInitTypeDef ob = {0};
+  HAL_StatusTypeDef status;
+
+  if (Verify_Passed == 0U)
+  {
+    return;
+  }
+
+  status = HAL_FLASH_Unlock();
+  if (status == HAL_OK)
+  {
+    status = Secure_CopySecureArea();
+  }
+  if (status == HAL_OK)
+  {
+    status = HAL_FLASH_OB_Unlock();
+  }
+  if (status == HAL_OK)
+  {
+    ob.OptionType = OPTIONBYTE_USER;
+    ob.USERType = OB_USER_SWAP_BANK;
+    ob.USERConfig = ((FLASH->OPTSR_CUR & FLASH_OPTSR_SWAP_BANK) != 0U) ?
+                    OB_SWAP_BANK_DISABLE : OB_SWAP_BANK_ENABLE;
+    status = HAL_FLASHEx_OBProgram(&ob);
+  }
+  if (status == HAL_OK)
+  {
+    status = HAL_FLASH_OB_Launch();
+  }
+  if (status == HAL_OK)
+  {
+    NVIC_SystemReset();
+  }
+
+  (void)HAL_FLASH_OB_Lock();
+  (void)HAL_FLASH_Lock();
+}
+
+/**
+  * @brief  Run a batch of secure service requests.
+  * @note   One secure state transition serves the whole batch: the request
+  *         array is checked once, then each request has its buffer checked
+  *         and is run, so the entry cost is paid per batch rather than per
+  *         operation. Requests run in order; once one fails the rest are
+  *         marked SECURE_STATUS_SKIPPED. Status is written back into each
+  *         request of the array, and the bytes read into the Length of a
+  *         SECURE_OP_RANDOM request.
+  * @param  Requests Non-secure array of Count requests
+  * @param  Count    Number of requests, 1 to SECURE_BATCH_MAX
+  * @retval Number of requests that completed with SECURE_STATUS_OK, 0 if
+  *         the array itself is invalid
+  */
+CMSE_NS_ENTRY uint32_t SECURE_Batch(SECURE_RequestTypeDef *Requests, uint32_t Count)
+{
+  SECURE_RequestTypeDef request;
+  SECURE_StatusTypeDef status = SECURE_STATUS_OK;
+  uint32_t done = 0U;
+
+  if ((Count == 0U) || (Count > SECURE_BATCH_MAX) ||
+      (cmse_check_address_range(Requests, Count * sizeof(*Requests),
+                                CMSE_NONSECURE | CMSE_MPU_READWRITE) == NULL))
+  {
+    return 0U;
+  }
+
+  for (uint32_t i = 0U; i < Count; i++)
+  {
+    if (status != SECURE_STATUS_OK)
+    {
+      Requests[i].Status = SECURE_STATUS_SKIPPED;
+      continue;
+    }
+
+    /* Copied first, non-secure memory may change under the request */
+    request = Requests[i];
+    status = Batch_Run(&request);
+    Requests[i].Status = status;
+    Requests[i].Length = request.Length;
+    if (status == SECURE_STATUS_OK)
+    {
+      done++;
+    }
+  }
+
+  return done;
+}
+
 /**
   * @}
   */
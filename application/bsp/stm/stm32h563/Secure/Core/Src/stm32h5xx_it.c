@@ -22,11 +22,20 @@
 #include "stm32h5xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include <arm_cmse.h>
+#include <stdbool.h>
+
+#include "secure_nsc.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN TD */
-
+/* Non-secure flash ECC error callback, see FLASH_ECC_CB_ID */
+#if defined ( __ICCARM__ )
+typedef bool (CMSE_NS_CALL *funcptr_flash_ecc_NS)(uint32_t detection);
+#else
+typedef bool CMSE_NS_CALL (*funcptr_flash_ecc_NS)(uint32_t detection);
+#endif
 /* USER CODE END TD */
 
 /* Private define ------------------------------------------------------------*/
@@ -57,7 +66,7 @@
 /* External variables --------------------------------------------------------*/
 
 /* USER CODE BEGIN EV */
-
+extern void *pFlashEccCallback;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -69,7 +78,22 @@
 void NMI_Handler(void)
 {
   /* USER CODE BEGIN NonMaskableInt_IRQn 0 */
+  uint32_t detection = FLASH->ECCDETR;
 
+  /* A double ECC error is the non-secure application's to judge: a torn
+     write of its configuration or snapshot sectors, read back at boot, is
+     expected after a power loss and resumed from */
+  if (((detection & FLASH_ECCR_ECCD) != 0U) && (pFlashEccCallback != NULL))
+  {
+    funcptr_flash_ecc_NS callback_NS =
+      (funcptr_flash_ecc_NS)cmse_nsfptr_create(pFlashEccCallback);
+
+    if (callback_NS(detection))
+    {
+      FLASH->ECCDETR = FLASH_ECCR_ECCD;
+      return;
+    }
+  }
   /* USER CODE END NonMaskableInt_IRQn 0 */
   /* USER CODE BEGIN NonMaskableInt_IRQn 1 */
    while (1)
@@ -258,4 +282,12 @@ void DebugMon_Handler(void)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles RNG global interrupt (entropy pool).
+  */
+void RNG_IRQHandler(void)
+{
+  Secure_RandomIRQHandler();
+}
+
 /* USER CODE END 1 */
@@ -33,13 +33,80 @@
 typedef enum
 {
   SECURE_FAULT_CB_ID     = 0x00U, /*!< System secure fault callback ID */
-  GTZC_ERROR_CB_ID       = 0x01U  /*!< GTZC secure error callback ID */
+  GTZC_ERROR_CB_ID       = 0x01U, /*!< GTZC secure error callback ID */
+  FLASH_ECC_CB_ID        = 0x02U  /*!< Flash ECC double error (NMI) callback ID,
+                                       bool func(uint32_t ECCDETR): true if the
+                                       error is the non-secure application's, then
+                                       cleared and resumed */
 } SECURE_CallbackIDTypeDef;
 
+/**
+  * @brief  Secure service operations of SECURE_Batch()
+  */
+typedef enum
+{
+  SECURE_OP_NOP           = 0x00U, /*!< Nothing, measures the batch cost */
+  SECURE_OP_RANDOM        = 0x01U, /*!< Read up to Length bytes (a multiple of 4) from the
+                                        entropy pool without waiting; Length is written
+                                        back as the bytes read, 0 if the pool is empty */
+  SECURE_OP_VERIFY_START  = 0x02U, /*!< Start checking an update image, no buffer */
+  SECURE_OP_VERIFY_UPDATE = 0x03U, /*!< Hash Buffer in the background; it stays unchanged
+                                        until the next verify request. Only the last one
+                                        may have a Length that is not a multiple of 4 */
+  SECURE_OP_VERIFY_FINISH = 0x04U, /*!< Check the signature in Buffer
+                                        (SECURE_VERIFY_SIGNATURE_SIZE bytes) */
+  SECURE_OP_ECDSA_VERIFY  = 0x05U, /*!< Check a P-256 signature made with any key, Buffer
+                                        (SECURE_ECDSA_REQUEST_SIZE bytes) holds the key X
+                                        and Y, the digest, then r and s, big-endian */
+  SECURE_OP_ICACHE_ON     = 0x06U, /*!< Turn the instruction cache on and restart its
+                                        monitors, no buffer */
+  SECURE_OP_ICACHE_OFF    = 0x07U, /*!< Turn the instruction cache off, no buffer */
+  SECURE_OP_ICACHE_MONITOR = 0x08U /*!< Read the hit then the miss monitor into Buffer
+                                        (SECURE_ICACHE_MONITOR_SIZE bytes) and restart
+                                        them */
+} SECURE_OpTypeDef;
+
+/**
+  * @brief  Secure service request status
+  */
+typedef enum
+{
+  SECURE_STATUS_OK            = 0x00U, /*!< Done */
+  SECURE_STATUS_ERROR         = 0x01U, /*!< Bad call order or hardware failure */
+  SECURE_STATUS_BAD_SIGNATURE = 0x02U, /*!< Signature does not match the image */
+  SECURE_STATUS_INVALID       = 0x03U, /*!< Unknown operation, bad length or buffer not non-secure */
+  SECURE_STATUS_SKIPPED       = 0x04U  /*!< Not run, an earlier request of the batch failed */
+} SECURE_StatusTypeDef;
+
+/**
+  * @brief  Secure service request, one entry of a SECURE_Batch() array
+  */
+typedef struct
+{
+  uint32_t Operation;   /*!< SECURE_OpTypeDef */
+  uint32_t Status;      /*!< SECURE_StatusTypeDef, written back */
+  void *Buffer;         /*!< Non-secure buffer of the operation */
+  uint32_t Length;      /*!< Buffer size in bytes, written back by SECURE_OP_RANDOM */
+} SECURE_RequestTypeDef;
+
 /* Exported constants --------------------------------------------------------*/
+/* ECDSA P-256 signature size, r then s */
+#define SECURE_VERIFY_SIGNATURE_SIZE 64U
+
+/* SECURE_OP_ECDSA_VERIFY request: key, digest, signature */
+#define SECURE_ECDSA_REQUEST_SIZE 160U
+
+/* SECURE_OP_ICACHE_MONITOR buffer: hit and miss counts, 32 bits each */
+#define SECURE_ICACHE_MONITOR_SIZE 8U
+
+/* Most requests in one SECURE_Batch() call */
+#define SECURE_BATCH_MAX 16U
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 void SECURE_RegisterCallback(SECURE_CallbackIDTypeDef CallbackId, void *func);
+void SECURE_SwapBank(void);
+uint32_t SECURE_Batch(SECURE_RequestTypeDef *Requests, uint32_t Count);
 
 #endif /* SECURE_NSC_H */
 /* USER CODE END Non_Secure_CallLib_h */
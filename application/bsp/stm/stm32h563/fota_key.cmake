@@ -0,0 +1,69 @@
+# FOTA verification key of the Secure application
+#
+# The Secure app only swaps to an image signed with the key whose public
+# half it is built with. That half comes from JERRY_FOTA_KEY, a P-256 key
+# in PEM (private or public), through tools/fota_key.py, into a generated
+# fota_public_key.h. The default is the development key of tools/keys,
+# which fota_key.py generates on the first configure of a checkout and
+# git ignores: anyone holding the file can sign images for a device built
+# with it.
+
+set(JERRY_FOTA_KEY_DEFAULT
+    "${CMAKE_CURRENT_LIST_DIR}/../../../../tools/keys/fota_dev_p256.pem")
+get_filename_component(JERRY_FOTA_KEY_DEFAULT "${JERRY_FOTA_KEY_DEFAULT}" ABSOLUTE)
+
+set(JERRY_FOTA_KEY "${JERRY_FOTA_KEY_DEFAULT}" CACHE FILEPATH
+    "P-256 key (PEM) whose public half verifies FOTA images")
+option(JERRY_FOTA_DEV_KEY_RELEASE
+    "Allow the development FOTA key in release builds" OFF)
+
+set(FOTA_KEY_SCRIPT "${CMAKE_CURRENT_LIST_DIR}/../../../../tools/fota_key.py")
+
+# Generate fota_public_key.h for a target, at configure time so the key
+# is checked before anything is built
+function(jerry_fota_public_key TARGET)
+    if(NOT Python3_EXECUTABLE)
+        find_package(Python3 COMPONENTS Interpreter REQUIRED)
+    endif()
+
+    # A relative path is from the top of the source tree
+    get_filename_component(key_file "${JERRY_FOTA_KEY}" ABSOLUTE
+        BASE_DIR "${CMAKE_SOURCE_DIR}")
+    set(key_dir "${CMAKE_CURRENT_BINARY_DIR}/fota_key")
+    set(key_header "${key_dir}/fota_public_key.h")
+    execute_process(
+        COMMAND ${Python3_EXECUTABLE} "${FOTA_KEY_SCRIPT}" "${key_file}"
+                --output "${key_header}"
+        RESULT_VARIABLE key_result
+        OUTPUT_VARIABLE key_output
+        ERROR_VARIABLE key_error
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+    )
+    if(NOT key_result EQUAL 0)
+        message(FATAL_ERROR "[FOTA] JERRY_FOTA_KEY: ${key_error}")
+    endif()
+    message(STATUS "[FOTA] ${key_output}")
+
+    # Configure again when the key or the script changes
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS
+        "${key_file}" "${FOTA_KEY_SCRIPT}")
+
+    file(STRINGS "${key_header}" key_development
+        REGEX "^#define FOTA_PUBLIC_KEY_DEVELOPMENT 1$")
+    if(key_development)
+        if((CMAKE_BUILD_TYPE MATCHES "^(Release|MinSizeRel|RelWithDebInfo)$")
+           AND NOT JERRY_FOTA_DEV_KEY_RELEASE)
+            message(FATAL_ERROR
+                "[FOTA] ${CMAKE_BUILD_TYPE} build with the development key: "
+                "anyone with the checkout could sign firmware for it. Set JERRY_FOTA_KEY "
+                "to the product's signing key, or JERRY_FOTA_DEV_KEY_RELEASE=ON "
+                "to build it anyway.")
+        endif()
+        message(WARNING
+            "[FOTA] The Secure app accepts images signed with the "
+            "development key (${key_file}): anyone with it can update a device "
+            "running it. Set JERRY_FOTA_KEY to the product's signing key.")
+    endif()
+
+    target_include_directories(${TARGET} PRIVATE "${key_dir}")
+endfunction()
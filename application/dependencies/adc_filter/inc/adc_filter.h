@@ -6,18 +6,52 @@
  * - 4th order Butterworth low-pass filter (500Hz cutoff)
  * - 10 IIR notch filters for 50Hz mains rejection and harmonics
  *
- * The filter uses CMSIS-DSP arm_biquad_cascade_df1_f32 for efficient
- * implementation on Cortex-M processors.
+ * The filter uses CMSIS-DSP biquad cascades for efficient implementation on
+ * Cortex-M processors. The backend is selected at compile time for all
+ * contexts with ADC_FILTER_BACKEND:
+ * - ADC_FILTER_BACKEND_DF1_F32:      arm_biquad_cascade_df1_f32 (default)
+ * - ADC_FILTER_BACKEND_DF2T_F32:     arm_biquad_cascade_df2T_f32, half the
+ *                                    state memory of DF1
+ * - ADC_FILTER_BACKEND_DF1_Q31:      arm_biquad_cascade_df1_q31, filters
+ *                                    12-bit samples with no float conversion
+ * - ADC_FILTER_BACKEND_DF1_FAST_Q15: arm_biquad_cascade_df1_fast_q15; only
+ *                                    13 coefficient bits survive postShift,
+ *                                    so the Q=10 notch set loses DC and
+ *                                    notch accuracy (low-Q designs only)
+ *
+ * Each channel filters with one of the precomputed
+ * coefficient banks (mains frequency / LPF cutoff), selected at run time
+ * with adc_filter_select_bank(). The extra ADC_FILTER_TRACKING_BANK holds
+ * notch stages retuned to the measured mains frequency with
+ * adc_filter_retune_mains() (see adc_filter_mains.h).
+ *
+ * When the decimation factor of the set is above 1,
+ * adc_filter_decimate_block() runs the cascade output through an
+ * arm_fir_decimate_f32 anti-alias stage and produces one sample per factor
+ * inputs.
+ *
+ * Each acquisition source has a context of its own, defined with
+ * ADC_FILTER_CONTEXT_DEFINE() for a coefficient set, a channel count and
+ * the largest block it filters; its state is sized for exactly those when
+ * it is defined. adc_filter_coefficients.h holds a generated set for each
+ * of the ADC_FILTER_NUM_RATES sample rates, adc_filter_coeffs_rates[], all
+ * with the same sizes and banks; ADC_FILTER_COEFFS_DEFAULT is the one of
+ * ADC_FILTER_SAMPLE_RATE, and a context defined with it can switch to any of
+ * the others with adc_filter_set_coeffs() when its source changes rate. A
+ * source with tables of its own describes them with an adc_filter_coeffs_t
+ * and the same kind of macro.
  *
  * @note All memory is statically allocated - no dynamic allocation.
  *
  * Usage:
  * @code
- *   adc_filter_context_t filter_ctx;
- *   adc_filter_init(&filter_ctx);
+ *   ADC_FILTER_CONTEXT_DEFINE(s_filter_ctx, ADC_FILTER_COEFFS_DEFAULT, 6U,
+ *                             32U);
+ *   adc_filter_init(&s_filter_ctx);
  *
  *   // Process samples
- *   float32_t filtered = adc_filter_process_sample(&filter_ctx, 0, raw_sample);
+ *   float32_t filtered =
+ *       adc_filter_process_sample(&s_filter_ctx, 0, raw_sample);
  * @endcode
  */
 
@@ -39,46 +73,349 @@ extern "C"
  * Definitions
  ******************************************************************************/
 
-/** Number of ADC channels supported */
-#define ADC_FILTER_NUM_CHANNELS 6U
+/**
+ * Placement of the filter kernels called from the ADC interrupt: with
+ * ADC_FILTER_IN_RAM in .RamFunc, which the startup code copies to SRAM with
+ * .data, so that they run without flash wait states; otherwise in flash.
+ * The CMSIS-DSP kernels follow through adc_filter_ram.ld.
+ */
+#if ADC_FILTER_IN_RAM
+#define ADC_FILTER_RAMFUNC __attribute__((section(".RamFunc")))
+#else
+#define ADC_FILTER_RAMFUNC
+#endif
 
-/** Maximum block size for block processing */
-#define ADC_FILTER_MAX_BLOCK_SIZE 64U
+/** @brief Backend: floating-point Direct Form I */
+#define ADC_FILTER_BACKEND_DF1_F32 0
+
+/** @brief Backend: floating-point Direct Form II transposed */
+#define ADC_FILTER_BACKEND_DF2T_F32 1
+
+/** @brief Backend: q31 Direct Form I */
+#define ADC_FILTER_BACKEND_DF1_Q31 2
+
+/** @brief Backend: fast q15 Direct Form I */
+#define ADC_FILTER_BACKEND_DF1_FAST_Q15 3
+
+/** Filter backend used for all contexts */
+#ifndef ADC_FILTER_BACKEND
+#define ADC_FILTER_BACKEND ADC_FILTER_BACKEND_DF1_F32
+#endif
+
+/**
+ * Headroom kept above fixed-point input samples, in bits, so that filter
+ * overshoot on full-scale steps cannot wrap the q31/q15 outputs.
+ */
+#define ADC_FILTER_INPUT_HEADROOM_BITS 1U
+
+#if (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_F32)
+    /** Sample type processed by the filter */
+    typedef float32_t adc_filter_sample_t;
+
+    /** Coefficient type of the selected backend */
+    typedef float32_t adc_filter_coeff_t;
+
+    /** CMSIS-DSP instance type for one channel */
+    typedef arm_biquad_casd_df1_inst_f32 adc_filter_instance_t;
+
+/** State words per stage for the selected backend */
+#define ADC_FILTER_BACKEND_STATE_PER_STAGE 4U
+
+/** Coefficients per stage for the selected backend */
+#define ADC_FILTER_BACKEND_COEFFS_PER_STAGE ADC_FILTER_COEFFS_PER_STAGE
+
+/**
+ * Convert an ADC reading to a filter sample (0.0 to 1.0). @p extra_bits is
+ * the growth above 12 bits from hardware oversampling, so full scale is
+ * 4095 << extra_bits.
+ */
+#define ADC_FILTER_FROM_ADC(raw, extra_bits) \
+    ((float32_t)(raw) / (4095.0f * (float32_t)(1UL << (extra_bits))))
+
+/** Convert a filter sample to a normalized float (0.0 to 1.0) */
+#define ADC_FILTER_TO_FLOAT(sample) (sample)
+
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF2T_F32)
+    typedef float32_t adc_filter_sample_t;
+    typedef float32_t adc_filter_coeff_t;
+    typedef arm_biquad_cascade_df2T_instance_f32 adc_filter_instance_t;
+
+#define ADC_FILTER_BACKEND_STATE_PER_STAGE 2U
+#define ADC_FILTER_BACKEND_COEFFS_PER_STAGE ADC_FILTER_COEFFS_PER_STAGE
+#define ADC_FILTER_FROM_ADC(raw, extra_bits) \
+    ((float32_t)(raw) / (4095.0f * (float32_t)(1UL << (extra_bits))))
+#define ADC_FILTER_TO_FLOAT(sample) (sample)
+
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31)
+    typedef q31_t adc_filter_sample_t;
+    typedef q31_t adc_filter_coeff_t;
+    typedef arm_biquad_casd_df1_inst_q31 adc_filter_instance_t;
+
+#define ADC_FILTER_BACKEND_STATE_PER_STAGE 4U
+#define ADC_FILTER_BACKEND_COEFFS_PER_STAGE ADC_FILTER_COEFFS_PER_STAGE
+#define ADC_FILTER_FROM_ADC(raw, extra_bits)                            \
+    ((q31_t)((uint32_t)(raw)                                            \
+             << (19U - ADC_FILTER_INPUT_HEADROOM_BITS - (extra_bits))))
+#define ADC_FILTER_TO_FLOAT(sample) \
+    ((float32_t)(sample) *          \
+     ((float32_t)(1UL << ADC_FILTER_INPUT_HEADROOM_BITS) / 2147483648.0f))
+
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15)
+    typedef q15_t adc_filter_sample_t;
+    typedef q15_t adc_filter_coeff_t;
+    typedef arm_biquad_casd_df1_inst_q15 adc_filter_instance_t;
+
+#define ADC_FILTER_BACKEND_STATE_PER_STAGE 4U
+#define ADC_FILTER_BACKEND_COEFFS_PER_STAGE ADC_FILTER_Q15_COEFFS_PER_STAGE
+#define ADC_FILTER_FROM_ADC(raw, extra_bits)                           \
+    ((q15_t)(((uint32_t)(raw) << (3U - ADC_FILTER_INPUT_HEADROOM_BITS)) \
+             >> (extra_bits)))
+#define ADC_FILTER_TO_FLOAT(sample) \
+    ((float32_t)(sample) *          \
+     ((float32_t)(1UL << ADC_FILTER_INPUT_HEADROOM_BITS) / 32768.0f))
+
+#else
+#error "Unsupported ADC_FILTER_BACKEND"
+#endif
+
+/** Convert a 12-bit ADC reading to a filter sample (0.0 to 1.0) */
+#define ADC_FILTER_FROM_ADC12(raw) ADC_FILTER_FROM_ADC(raw, 0U)
+
+/**
+ * Bank index of the RAM bank retuned by adc_filter_retune_mains(), for
+ * contexts on ADC_FILTER_COEFFS_DEFAULT. In general it is the num_banks of
+ * the context's set, one past its designed banks.
+ */
+#define ADC_FILTER_TRACKING_BANK ADC_FILTER_NUM_BANKS
+
+#if ((ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31) || \
+     (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15))
+/** Tracking bank quantized for the fixed-point backend, in the storage of
+ *  ADC_FILTER_CONTEXT_DEFINE() */
+#define ADC_FILTER_BACKEND_TRACKING_STORAGE(stages) \
+    adc_filter_coeff_t tracking_fixed[2][(stages) *  \
+                                         ADC_FILTER_BACKEND_COEFFS_PER_STAGE];
+#define ADC_FILTER_BACKEND_TRACKING_INIT(ctx_name) \
+    .tracking_fixed = &ctx_name##_storage.tracking_fixed[0][0],
+#else
+#define ADC_FILTER_BACKEND_TRACKING_STORAGE(stages)
+#define ADC_FILTER_BACKEND_TRACKING_INIT(ctx_name)
+#endif
 
     /*******************************************************************************
      * Types
      ******************************************************************************/
 
+    /**
+     * @brief Coefficient set: the banks of one filter design.
+     *
+     * Every bank has num_stages stages, the low-pass stages first and the
+     * notch stages after them; each stage is {b0, b1, b2, -a1, -a2}, or the
+     * backend's own layout in backend_coeffs. Banks follow each other.
+     */
+    typedef struct
+    {
+        /** Float banks, num_banks x num_stages x ADC_FILTER_COEFFS_PER_STAGE */
+        const float32_t *coeffs;
+
+        /** The same banks in the format of the backend */
+        const adc_filter_coeff_t *backend_coeffs;
+
+        /** DC gain of each stage of each bank, num_banks x num_stages */
+        const float32_t *dc_gain;
+
+        /** Decimator FIR (CMSIS-DSP order), NULL without a decimator */
+        const float32_t *decimation_coeffs;
+
+        /** Sample rate the banks were designed for (Hz) */
+        uint32_t sample_rate;
+
+        /** Quality factor of the notch stages */
+        float32_t notch_q;
+
+        /** Taps of the decimator FIR */
+        uint16_t decimation_taps;
+
+        /** Decimation factor after the cascade, 1 without a decimator */
+        uint8_t decimation_factor;
+
+        /** Biquad stages of every bank */
+        uint8_t num_stages;
+
+        /** Low-pass stages at the start of every bank */
+        uint8_t lpf_stages;
+
+        /** Selectable banks */
+        uint8_t num_banks;
+
+        /** Bank selected by adc_filter_init() */
+        uint8_t default_bank;
+    } adc_filter_coeffs_t;
+
     /**
      * @brief Filter instance for a single ADC channel.
      *
-     * Contains the CMSIS-DSP biquad instance and state buffer.
+     * Contains the CMSIS-DSP biquad instance and its state buffer.
      * Each channel has independent state for proper filtering.
      */
     typedef struct
     {
         /** CMSIS-DSP biquad cascade filter instance */
-        arm_biquad_casd_df1_inst_f32 instance;
+        adc_filter_instance_t instance;
 
-        /** State buffer for the filter (4 values per stage) */
-        float32_t state[ADC_FILTER_STATE_SIZE];
+        /** State buffer for the filter, in the storage of the context */
+        adc_filter_sample_t *state;
 
         /** Flag indicating if the channel is initialized */
         bool initialized;
+
+        /** Coefficient bank requested with adc_filter_select_bank() */
+        volatile uint8_t bank;
     } adc_filter_channel_t;
 
     /**
-     * @brief Filter context containing all ADC channels.
+     * @brief Filter context of one acquisition source.
      *
-     * This structure holds the filter instances for all channels.
-     * Coefficients are shared across all channels.
+     * Defined with ADC_FILTER_CONTEXT_DEFINE(), which sets the sizes and the
+     * storage; the members are private to adc_filter.c. Coefficients are
+     * shared across all channels.
      */
     typedef struct
     {
+        /** Coefficient set */
+        const adc_filter_coeffs_t *coeffs;
+
+        /** Channels, stages, block size and decimator taps the storage
+         *  holds */
+        uint8_t  num_channels;
+        uint8_t  max_stages;
+        uint16_t max_block_size;
+        uint16_t max_decimation_taps;
+
         /** Filter instances for each channel */
-        adc_filter_channel_t channels[ADC_FILTER_NUM_CHANNELS];
+        adc_filter_channel_t *channels;
+
+        /** Cascade state of each channel, max_stages *
+         *  ADC_FILTER_BACKEND_STATE_PER_STAGE words apart */
+        adc_filter_sample_t *state;
+
+        /**
+         * Channel-interleaved state for adc_filter_process_frame(), laid out
+         * stage-major, state-variable next, channel-minor:
+         * frame_state[stage][{x[n-1], x[n-2], y[n-1], y[n-2]}][channel].
+         * Independent of the per-channel states above.
+         */
+        float32_t *frame_state;
+
+        /**
+         * Double-buffered tracking bank, max_stages *
+         * ADC_FILTER_COEFFS_PER_STAGE coefficients apart:
+         * adc_filter_retune_mains() fills the buffer not selected by
+         * tracking_index and then flips the index.
+         */
+        float32_t *tracking_f32;
+
+#if ((ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31) || \
+     (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15))
+        /** Tracking bank quantized for the fixed-point backend, max_stages *
+         *  ADC_FILTER_BACKEND_COEFFS_PER_STAGE coefficients apart */
+        adc_filter_coeff_t *tracking_fixed;
+#endif
+
+        /** Tracking buffer currently published (0 or 1) */
+        volatile uint8_t tracking_index;
+
+        /** Mains frequency the tracking bank is tuned to (Hz) */
+        float32_t tracking_hz;
+
+        /** Bank the LPF stages of each tracking buffer come from */
+        uint8_t tracking_base[2];
+
+        /** CMSIS-DSP FIR decimator instance for each channel */
+        arm_fir_decimate_instance_f32 *decimators;
+
+        /** FIR decimator state of each channel, max_decimation_taps +
+         *  max_block_size - 1 words apart */
+        float32_t *decimator_state;
     } adc_filter_context_t;
 
+    /**
+     * @brief The generated coefficient sets (adc_filter_coefficients.h), one
+     *        per sample rate, in the order of adc_filter_sample_rates.
+     */
+    extern const adc_filter_coeffs_t
+        adc_filter_coeffs_rates[ADC_FILTER_NUM_RATES];
+
+    /**
+     * @brief The generated set of the slow channels, sampled at
+     *        ADC_FILTER_SLOW_SAMPLE_RATE: ADC_FILTER_SLOW_STAGES low-pass
+     *        stages in one bank, without a decimator.
+     */
+    extern const adc_filter_coeffs_t adc_filter_coeffs_slow;
+
+/**
+ * The generated set of ADC_FILTER_SAMPLE_RATE, as
+ * ADC_FILTER_CONTEXT_DEFINE() takes one: its descriptor, then the stages,
+ * decimator taps and decimation factor the storage is sized with, which
+ * the sets of the other rates share. A set of other tables is named alike.
+ */
+#define ADC_FILTER_COEFFS_DEFAULT                                    \
+    &adc_filter_coeffs_rates[ADC_FILTER_DEFAULT_RATE],               \
+        ADC_FILTER_NUM_STAGES, ADC_FILTER_DECIMATION_TAPS,           \
+        ADC_FILTER_DECIMATION_FACTOR
+
+/** The generated set of the slow channels, as ADC_FILTER_CONTEXT_DEFINE()
+ *  takes one */
+#define ADC_FILTER_COEFFS_SLOW \
+    &adc_filter_coeffs_slow, ADC_FILTER_SLOW_STAGES, 0U, 1U
+
+/**
+ * @brief Define a static filter context and its storage
+ *
+ * Defines the context @p ctx_name for @p num_ch channels filtered in blocks
+ * of at most @p block_size samples with the coefficient set @p coeff_set
+ * (ADC_FILTER_COEFFS_DEFAULT or a macro like it). adc_filter_init() sets it
+ * up before first use.
+ */
+#define ADC_FILTER_CONTEXT_DEFINE(ctx_name, coeff_set, num_ch, block_size) \
+    ADC_FILTER_CONTEXT_DEFINE_SET(ctx_name, num_ch, block_size, coeff_set)
+
+/* Takes the set apart once its macro expanded */
+#define ADC_FILTER_CONTEXT_DEFINE_SET(ctx_name, num_ch, block_size, set,     \
+                                      stages, taps, factor)                 \
+    _Static_assert(((num_ch) > 0U) && ((num_ch) <= 255U),                   \
+                   "context " #ctx_name " has too many channels");          \
+    _Static_assert(((block_size) > 0U) && ((block_size) <= 65535U) &&        \
+                       (((block_size) % (factor)) == 0U),                   \
+                   "block size of " #ctx_name                               \
+                   " must be a multiple of the decimation factor");         \
+    static struct                                                           \
+    {                                                                       \
+        adc_filter_channel_t channels[(num_ch)];                            \
+        adc_filter_sample_t                                                 \
+            state[(num_ch)][(stages) * ADC_FILTER_BACKEND_STATE_PER_STAGE];  \
+        float32_t frame_state[(stages)][ADC_FILTER_STATE_PER_STAGE]         \
+                             [(num_ch)];                                    \
+        float32_t tracking_f32[2][(stages) * ADC_FILTER_COEFFS_PER_STAGE];  \
+        ADC_FILTER_BACKEND_TRACKING_STORAGE(stages)                         \
+        arm_fir_decimate_instance_f32 decimators[(num_ch)];                 \
+        float32_t decimator_state[(num_ch)][(taps) + (block_size) - 1U];    \
+    } ctx_name##_storage;                                                   \
+    static adc_filter_context_t ctx_name = {                                \
+        .coeffs              = (set),                                       \
+        .num_channels        = (uint8_t)(num_ch),                           \
+        .max_stages          = (uint8_t)(stages),                           \
+        .max_block_size      = (uint16_t)(block_size),                      \
+        .max_decimation_taps = (uint16_t)(taps),                            \
+        .channels            = ctx_name##_storage.channels,                 \
+        .state               = &ctx_name##_storage.state[0][0],             \
+        .frame_state         = &ctx_name##_storage.frame_state[0][0][0],    \
+        .tracking_f32        = &ctx_name##_storage.tracking_f32[0][0],      \
+        ADC_FILTER_BACKEND_TRACKING_INIT(ctx_name)                          \
+        .decimators          = ctx_name##_storage.decimators,               \
+        .decimator_state     = &ctx_name##_storage.decimator_state[0][0],   \
+    }
+
     /*******************************************************************************
      * API Functions
      ******************************************************************************/
@@ -90,13 +427,51 @@ extern "C"
      * ADC channel. All channels share the same coefficients but have
      * independent state buffers.
      *
-     * @param[in,out] ctx Pointer to the filter context to initialize.
-     *                    Must not be NULL.
+     * @param[in,out] ctx Pointer to the filter context to initialize, from
+     *                    ADC_FILTER_CONTEXT_DEFINE().
+     *
+     * @return true if initialized, false if @p ctx is NULL or its set does
+     *         not fit the storage it was defined with; its channels then
+     *         stay uninitialized and pass samples through.
      *
      * @note This function must be called before any filtering operations.
      * @note All state buffers are cleared to zero.
      */
-    void adc_filter_init(adc_filter_context_t *ctx);
+    bool adc_filter_init(adc_filter_context_t *ctx);
+
+    /**
+     * @brief Get the generated coefficient set of a sample rate.
+     *
+     * @param[in] sample_rate Sample rate (Hz).
+     *
+     * @return The set of adc_filter_coeffs_rates designed for
+     *         @p sample_rate, NULL if there is none.
+     */
+    const adc_filter_coeffs_t *
+    adc_filter_coeffs_for_rate(uint32_t sample_rate);
+
+    /**
+     * @brief Switch a context to another coefficient set.
+     *
+     * For a source that changes sample rate: the context restarts from
+     * cleared state with @p set, as adc_filter_init() does, but each channel
+     * keeps the bank it had requested, so the banks of the two sets must
+     * correspond by index. The tracking bank restarts as a copy of the
+     * default bank until the next adc_filter_retune_mains(). Follow with
+     * adc_filter_warm_start() to restart without settling.
+     *
+     * @param[in,out] ctx Pointer to the filter context.
+     * @param[in]     set Coefficient set, with as many banks as the current
+     *                    one and fitting the storage of the context.
+     *
+     * @return true if switched; false on invalid arguments, the context
+     *         then filtering with its current set as before.
+     *
+     * @note Must not preempt filtering on the same context: call it from
+     *       the filtering task itself, between blocks.
+     */
+    bool adc_filter_set_coeffs(adc_filter_context_t      *ctx,
+                               const adc_filter_coeffs_t *set);
 
     /**
      * @brief Process a single sample for one channel.
@@ -105,7 +480,7 @@ extern "C"
      * input sample and returns the filtered output.
      *
      * @param[in,out] ctx     Pointer to the filter context.
-     * @param[in]     channel Channel index (0 to ADC_FILTER_NUM_CHANNELS-1).
+     * @param[in]     channel Channel index (0 to num_ch-1).
      * @param[in]     input   Input sample value.
      *
      * @return Filtered output sample.
@@ -114,8 +489,9 @@ extern "C"
      * @note For better efficiency, consider using adc_filter_process_block()
      *       when processing multiple samples.
      */
-    float32_t adc_filter_process_sample(adc_filter_context_t *ctx,
-                                        uint8_t channel, float32_t input);
+    adc_filter_sample_t adc_filter_process_sample(adc_filter_context_t *ctx,
+                                                  uint8_t              channel,
+                                                  adc_filter_sample_t  input);
 
     /**
      * @brief Process a block of samples for one channel.
@@ -124,30 +500,228 @@ extern "C"
      * This is more efficient than processing samples individually.
      *
      * @param[in,out] ctx        Pointer to the filter context.
-     * @param[in]     channel    Channel index (0 to ADC_FILTER_NUM_CHANNELS-1).
+     * @param[in]     channel    Channel index (0 to num_ch-1).
      * @param[in]     input      Pointer to input sample buffer.
      * @param[out]    output     Pointer to output sample buffer.
      * @param[in]     block_size Number of samples to process.
      *
      * @note Input and output buffers must not overlap.
-     * @note block_size should not exceed ADC_FILTER_MAX_BLOCK_SIZE.
+     * @note block_size should not exceed the block size of the context.
+     */
+    void adc_filter_process_block(adc_filter_context_t      *ctx,
+                                  uint8_t                    channel,
+                                  const adc_filter_sample_t *input,
+                                  adc_filter_sample_t       *output,
+                                  uint32_t                   block_size);
+
+    /**
+     * @brief Convert a block of ADC readings to filter samples.
+     *
+     * Block form of ADC_FILTER_FROM_ADC() built from CMSIS-DSP vector
+     * functions: a shift for the fixed-point backends, arm_q15_to_float()
+     * and one arm_scale_f32() for the float backends, with no division per
+     * sample.
+     *
+     * @param[in]  raw        ADC readings, at most 15 bits, read as q15.
+     * @param[out] output     Pointer to output sample buffer.
+     * @param[in]  extra_bits Growth above 12 bits, as for
+     *                        ADC_FILTER_FROM_ADC().
+     * @param[in]  block_size Number of samples to convert.
+     *
+     * @note @p raw and @p output must not overlap.
+     */
+    void adc_filter_from_adc_block(const q15_t         *raw,
+                                   adc_filter_sample_t *output,
+                                   uint32_t             extra_bits,
+                                   uint32_t             block_size);
+
+    /**
+     * @brief Convert a block of filter samples to normalized floats.
+     *
+     * Block form of ADC_FILTER_TO_FLOAT(): arm_q15_to_float() or
+     * arm_q31_to_float() and one arm_scale_f32() for the fixed-point
+     * backends, a copy for the float backends.
+     *
+     * @param[in]  input      Pointer to input sample buffer.
+     * @param[out] output     Pointer to output buffer (0.0 to 1.0).
+     * @param[in]  block_size Number of samples to convert.
+     */
+    void adc_filter_to_float_block(const adc_filter_sample_t *input,
+                                   float32_t                 *output,
+                                   uint32_t                   block_size);
+
+    /**
+     * @brief Select the coefficient bank of one channel.
+     *
+     * Only records the request; the filter switches to the new bank at the
+     * start of its next adc_filter_process_sample()/adc_filter_process_block()
+     * call by swapping the instance's coefficient pointer, so a block is
+     * never filtered with mixed coefficients and no filter call is stalled.
+     * Safe to call from another task than the one filtering. State is kept
+     * across the switch: with the Direct Form I backends it is plain signal
+     * history, so the output moves smoothly to the new response (the DF2T
+     * backend may show a short transient).
+     *
+     * The interleaved frame filter uses the bank of channel 0 for all
+     * channels.
+     *
+     * @param[in,out] ctx     Pointer to the filter context.
+     * @param[in]     channel Channel index (0 to num_ch-1).
+     * @param[in]     bank    Bank index (0 to num_banks-1 of the set), or
+     *                        the tracking bank (ADC_FILTER_TRACKING_BANK).
+     *
+     * @return true if the request was accepted, false on invalid arguments.
+     */
+    bool adc_filter_select_bank(adc_filter_context_t *ctx, uint8_t channel,
+                                uint8_t bank);
+
+    /**
+     * @brief Get the coefficient bank selected for one channel.
+     *
+     * @param[in] ctx     Pointer to the filter context.
+     * @param[in] channel Channel index (0 to num_ch-1).
+     *
+     * @return Last requested bank, or the default bank of the set on invalid
+     *         arguments.
+     */
+    uint8_t adc_filter_get_bank(const adc_filter_context_t *ctx,
+                                uint8_t                     channel);
+
+    /**
+     * @brief Retune the tracking bank's notch stages to a mains frequency.
+     *
+     * Builds the tracking bank from the low-pass stages of @p base_bank and
+     * notch stages at harmonics of @p mains_hz (same count and Q as the
+     * designed banks), then publishes it. Channels on
+     * ADC_FILTER_TRACKING_BANK move to the new coefficients at their next
+     * filter call, with the same pointer swap as adc_filter_select_bank().
+     *
+     * Cost is one sinf() and a handful of multiplies per notch stage, so it
+     * is meant to be called at a low rate (once per estimator window) from
+     * task context, never from an ISR.
+     *
+     * @param[in,out] ctx       Pointer to the filter context.
+     * @param[in]     base_bank Bank providing the LPF stages
+     *                          (0 to num_banks-1 of the set).
+     * @param[in]     mains_hz  Mains fundamental frequency (Hz).
+     *
+     * @return true if the bank was retuned, false on invalid arguments.
+     *
+     * @note Must not preempt filtering on the same context: call it from
+     *       the filtering task itself, or from a lower-priority task.
+     */
+    bool adc_filter_retune_mains(adc_filter_context_t *ctx, uint8_t base_bank,
+                                 float32_t mains_hz);
+
+    /**
+     * @brief Get the mains frequency the tracking bank is tuned to.
+     *
+     * @param[in] ctx Pointer to the filter context.
+     *
+     * @return Tuned frequency in Hz, 0 if never retuned or on error.
      */
-    void adc_filter_process_block(adc_filter_context_t *ctx, uint8_t channel,
-                                  const float32_t *input, float32_t *output,
-                                  uint32_t block_size);
+    float32_t adc_filter_get_tracking_frequency(
+        const adc_filter_context_t *ctx);
+
+    /**
+     * @brief Process one frame holding a sample of every channel.
+     *
+     * Runs the filter chain over all channels of the context in a
+     * single pass: each stage's five coefficients are loaded once and
+     * applied to every channel before moving to the next stage. Uses the
+     * channel-interleaved frame state, so it must not be mixed with
+     * adc_filter_process_sample()/adc_filter_process_block() on the same
+     * stream.
+     *
+     * @param[in,out] ctx    Pointer to the filter context.
+     * @param[in]     input  One input sample per channel.
+     * @param[out]    output One filtered sample per channel.
+     *
+     * @note @p input and @p output may be the same buffer.
+     */
+    void adc_filter_process_frame(adc_filter_context_t *ctx,
+                                  const float32_t     *input,
+                                  float32_t           *output);
+
+    /**
+     * @brief Decimate a block of filtered samples for one channel.
+     *
+     * Runs the FIR anti-alias decimator over a block of cascade output that
+     * has already been converted with ADC_FILTER_TO_FLOAT(), keeping one
+     * sample out of every decimation factor of the set. Rate conversion is
+     * continuous across calls.
+     *
+     * @param[in,out] ctx        Pointer to the filter context.
+     * @param[in]     channel    Channel index (0 to num_ch-1).
+     * @param[in]     input      Pointer to input sample buffer.
+     * @param[out]    output     Pointer to output buffer with room for
+     *                           block_size / decimation factor samples.
+     * @param[in]     block_size Number of input samples, a multiple of
+     *                           the decimation factor not exceeding the
+     *                           block size of the context.
+     *
+     * @return Number of samples written to @p output; 0 on invalid arguments.
+     *         Without a decimation stage (factor 1) the input is copied.
+     */
+    uint32_t adc_filter_decimate_block(adc_filter_context_t *ctx,
+                                       uint8_t               channel,
+                                       const float32_t      *input,
+                                       float32_t            *output,
+                                       uint32_t              block_size);
 
     /**
      * @brief Reset filter state for a single channel.
      *
-     * Clears the state buffer for the specified channel, effectively
-     * resetting the filter to its initial state. This is useful when
-     * there's a discontinuity in the input signal.
+     * Clears the state buffer for the specified channel, including its
+     * slots in the frame state and its decimator, effectively resetting the
+     * filter to its initial state. This is useful when there's a
+     * discontinuity in the input signal. The output then settles like a
+     * step from zero; adc_filter_warm_start() restarts without settling.
      *
      * @param[in,out] ctx     Pointer to the filter context.
-     * @param[in]     channel Channel index (0 to ADC_FILTER_NUM_CHANNELS-1).
+     * @param[in]     channel Channel index (0 to num_ch-1).
      */
     void adc_filter_reset(adc_filter_context_t *ctx, uint8_t channel);
 
+    /**
+     * @brief Restart the filter of one channel in steady state.
+     *
+     * Fills the cascade state of the channel, and its slots in the frame
+     * state, as if @p input had been applied forever: the input history of
+     * every stage holds its input level and the output history that level
+     * times the stage's DC gain (adc_filter_stage_dc_gain, computed by
+     * config/adc_filter_design.py). Filtering a signal that starts at
+     * @p input then shows no start-up transient, so its output is valid at
+     * once instead of after the cascade has settled. The bank requested for
+     * the channel is applied first.
+     *
+     * The decimator is restarted separately with
+     * adc_filter_warm_start_decimator(), since its input is the cascade
+     * output after ADC_FILTER_TO_FLOAT() and any scaling by the caller.
+     *
+     * @param[in,out] ctx     Pointer to the filter context.
+     * @param[in]     channel Channel index (0 to num_ch-1).
+     * @param[in]     input   Input level to start from, typically the first
+     *                        sample of the next block.
+     *
+     * @note Must not preempt filtering of the same channel.
+     */
+    void adc_filter_warm_start(adc_filter_context_t *ctx, uint8_t channel,
+                               adc_filter_sample_t input);
+
+    /**
+     * @brief Restart the decimator of one channel in steady state.
+     *
+     * Fills the FIR history with @p level, as if it had been the input
+     * forever. Does nothing without a decimation stage.
+     *
+     * @param[in,out] ctx     Pointer to the filter context.
+     * @param[in]     channel Channel index (0 to num_ch-1).
+     * @param[in]     level   Decimator input level to start from.
+     */
+    void adc_filter_warm_start_decimator(adc_filter_context_t *ctx,
+                                         uint8_t channel, float32_t level);
+
     /**
      * @brief Reset filter state for all channels.
      *
@@ -161,7 +735,7 @@ extern "C"
      * @brief Check if a channel is initialized.
      *
      * @param[in] ctx     Pointer to the filter context.
-     * @param[in] channel Channel index (0 to ADC_FILTER_NUM_CHANNELS-1).
+     * @param[in] channel Channel index (0 to num_ch-1).
      *
      * @return true if the channel is initialized, false otherwise.
      */
@@ -171,16 +745,21 @@ extern "C"
     /**
      * @brief Get the number of filter stages.
      *
-     * @return Number of biquad stages in the filter cascade.
+     * @param[in] ctx Pointer to the filter context.
+     *
+     * @return Number of biquad stages in the filter cascade, 0 on error.
      */
-    uint32_t adc_filter_get_num_stages(void);
+    uint32_t adc_filter_get_num_stages(const adc_filter_context_t *ctx);
 
     /**
      * @brief Get the filter sample rate.
      *
-     * @return Sample rate in Hz that the filter was designed for.
+     * @param[in] ctx Pointer to the filter context.
+     *
+     * @return Sample rate in Hz that the filter was designed for, 0 on
+     *         error.
      */
-    uint32_t adc_filter_get_sample_rate(void);
+    uint32_t adc_filter_get_sample_rate(const adc_filter_context_t *ctx);
 
 #ifdef __cplusplus
 }
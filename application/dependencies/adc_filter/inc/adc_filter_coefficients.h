@@ -12,6 +12,22 @@
  *   - Notch Frequencies: 50, 100, 150, 200, 250, 300, 350, 400, 450, 500 Hz
  *   - Notch Q Factor: 10
  *   - Total Biquad Stages: 12
+ *   - Cost: 66 MACs/sample
+ *
+ * Coefficient Banks:
+ *   - Bank 0: 50 Hz mains notches, 500 Hz LPF
+ *   - Bank 1: 60 Hz mains notches, 500 Hz LPF
+ *   - Bank 2: 50 Hz mains notches, 250 Hz LPF
+ *   - Bank 3: 60 Hz mains notches, 250 Hz LPF
+ *
+ * Sample Rates (each with all of the banks):
+ *   - Set 0: 1000 Hz
+ *   - Set 1: 5000 Hz
+ *   - Set 2: 10000 Hz
+ *   - Set 3: 25000 Hz
+ *   - Set 4: 50000 Hz
+ *
+ * Slow Channels: 10 Hz, 4th order Butterworth LPF at 1 Hz
  */
 
 #ifndef ADC_FILTER_COEFFICIENTS_H
@@ -24,9 +40,31 @@ extern "C"
 {
 #endif
 
+/** Nonzero to keep the coefficient tables in SRAM (set by CMake) */
+#ifndef ADC_FILTER_IN_RAM
+#define ADC_FILTER_IN_RAM 0
+#endif
+
+/**
+ * Placement of the coefficient tables read by the filter kernels: with
+ * ADC_FILTER_IN_RAM in .fastdata, which the startup code copies to SRAM
+ * with .data, aligned for dual-word loads; otherwise in flash.
+ */
+#if ADC_FILTER_IN_RAM
+#define ADC_FILTER_FASTDATA __attribute__((section(".fastdata"), aligned(8)))
+#else
+#define ADC_FILTER_FASTDATA
+#endif
+
 /** Number of biquad stages in the filter cascade */
 #define ADC_FILTER_NUM_STAGES 12U
 
+/** Number of low-pass stages at the start of the cascade */
+#define ADC_FILTER_LPF_STAGES 2U
+
+/** Quality factor of the notch stages */
+#define ADC_FILTER_NOTCH_Q 10U
+
 /** Number of coefficients per stage (b0, b1, b2, -a1, -a2) */
 #define ADC_FILTER_COEFFS_PER_STAGE 5U
 
@@ -34,26 +72,186 @@ extern "C"
 #define ADC_FILTER_TOTAL_COEFFS \
     (ADC_FILTER_NUM_STAGES * ADC_FILTER_COEFFS_PER_STAGE)
 
-/** Number of state variables per stage */
+/** Number of coefficients per stage in the q15 set (b0, 0, b1, b2, -a1, -a2)
+ */
+#define ADC_FILTER_Q15_COEFFS_PER_STAGE 6U
+
+/** Total number of coefficients in the q15 set */
+#define ADC_FILTER_Q15_TOTAL_COEFFS \
+    (ADC_FILTER_NUM_STAGES * ADC_FILTER_Q15_COEFFS_PER_STAGE)
+
+/** Coefficient scale-down (and output scale-up) for the q31 set, in bits */
+#define ADC_FILTER_Q31_POST_SHIFT 2
+
+/** Coefficient scale-down (and output scale-up) for the q15 set, in bits */
+#define ADC_FILTER_Q15_POST_SHIFT 2
+
+/** Decimation factor after the cascade (1 disables the decimator) */
+#define ADC_FILTER_DECIMATION_FACTOR 8U
+
+/** Number of taps of the decimator FIR */
+#define ADC_FILTER_DECIMATION_TAPS 48U
+
+/** Decimator FIR cutoff frequency at the default rate (Hz) */
+#define ADC_FILTER_DECIMATION_CUTOFF 500U
+
+/** Number of selectable coefficient banks */
+#define ADC_FILTER_NUM_BANKS 4U
+
+/** Bank selected by adc_filter_init() */
+#define ADC_FILTER_DEFAULT_BANK 0U
+
+/** Bank 0: 50 Hz mains notches, 500 Hz LPF */
+#define ADC_FILTER_BANK_50HZ_500HZ 0U
+
+/** Bank 1: 60 Hz mains notches, 500 Hz LPF */
+#define ADC_FILTER_BANK_60HZ_500HZ 1U
+
+/** Bank 2: 50 Hz mains notches, 250 Hz LPF */
+#define ADC_FILTER_BANK_50HZ_250HZ 2U
+
+/** Bank 3: 60 Hz mains notches, 250 Hz LPF */
+#define ADC_FILTER_BANK_60HZ_250HZ 3U
+
+/** Number of state variables per stage (Direct Form I) */
 #define ADC_FILTER_STATE_PER_STAGE 4U
 
 /** Total state variables needed per channel */
 #define ADC_FILTER_STATE_SIZE \
     (ADC_FILTER_NUM_STAGES * ADC_FILTER_STATE_PER_STAGE)
 
-/** Sample rate used for filter design (Hz) */
+/** Default sample rate (Hz) */
 #define ADC_FILTER_SAMPLE_RATE 10000U
 
-/** LPF cutoff frequency (Hz) */
+/** Number of sample rates with a set of banks */
+#define ADC_FILTER_NUM_RATES 5U
+
+/** Set of ADC_FILTER_SAMPLE_RATE */
+#define ADC_FILTER_DEFAULT_RATE 2U
+
+/** Highest sample rate with a set of banks (Hz) */
+#define ADC_FILTER_MAX_SAMPLE_RATE 50000U
+
+/** Set 0: 1000 Hz */
+#define ADC_FILTER_RATE_1000HZ 0U
+
+/** Set 1: 5000 Hz */
+#define ADC_FILTER_RATE_5000HZ 1U
+
+/** Set 2: 10000 Hz */
+#define ADC_FILTER_RATE_10000HZ 2U
+
+/** Set 3: 25000 Hz */
+#define ADC_FILTER_RATE_25000HZ 3U
+
+/** Set 4: 50000 Hz */
+#define ADC_FILTER_RATE_50000HZ 4U
+
+/** Expands X(set, sample rate in Hz) for each set */
+#define ADC_FILTER_FOR_EACH_RATE(X) \
+    X(0U, 1000U)                    \
+    X(1U, 5000U)                    \
+    X(2U, 10000U)                   \
+    X(3U, 25000U)                   \
+    X(4U, 50000U)
+
+/** Sample rate of the slow channel set (Hz) */
+#define ADC_FILTER_SLOW_SAMPLE_RATE 10U
+
+/** Number of biquad stages of the slow channel set, all low-pass */
+#define ADC_FILTER_SLOW_STAGES 2U
+
+/** LPF cutoff frequency of the slow channel set (Hz) */
+#define ADC_FILTER_SLOW_LPF_CUTOFF 1U
+
+/** Total number of coefficients of the slow channel set */
+#define ADC_FILTER_SLOW_TOTAL_COEFFS \
+    (ADC_FILTER_SLOW_STAGES * ADC_FILTER_COEFFS_PER_STAGE)
+
+/** Total number of coefficients of the slow channel set in q15 */
+#define ADC_FILTER_SLOW_Q15_TOTAL_COEFFS \
+    (ADC_FILTER_SLOW_STAGES * ADC_FILTER_Q15_COEFFS_PER_STAGE)
+
+/** LPF cutoff frequency of the default bank (Hz) */
 #define ADC_FILTER_LPF_CUTOFF 500U
 
     /**
-     * @brief Filter coefficients array.
+     * @brief Sample rate of each set (Hz).
+     */
+    extern const uint32_t adc_filter_sample_rates[ADC_FILTER_NUM_RATES];
+
+    /**
+     * @brief Filter coefficient banks of each sample rate.
      *
      * Coefficients are in CMSIS-DSP format: {b0, b1, b2, -a1, -a2} for each
      * stage. The filter chain is: LPF stages followed by notch filter stages.
      */
-    extern const float32_t adc_filter_coefficients[ADC_FILTER_TOTAL_COEFFS];
+    extern const float32_t adc_filter_coefficients[ADC_FILTER_NUM_RATES]
+                                                  [ADC_FILTER_NUM_BANKS]
+                                                  [ADC_FILTER_TOTAL_COEFFS];
+
+    /**
+     * @brief Filter coefficient banks in q31, scaled by
+     * 2^-ADC_FILTER_Q31_POST_SHIFT.
+     */
+    extern const q31_t adc_filter_coefficients_q31[ADC_FILTER_NUM_RATES]
+                                                  [ADC_FILTER_NUM_BANKS]
+                                                  [ADC_FILTER_TOTAL_COEFFS];
+
+    /**
+     * @brief Filter coefficient banks in q15, scaled by
+     * 2^-ADC_FILTER_Q15_POST_SHIFT.
+     *
+     * Each stage is laid out as {b0, 0, b1, b2, -a1, -a2}, as required by
+     * arm_biquad_cascade_df1_init_q15().
+     */
+    extern const q15_t adc_filter_coefficients_q15[ADC_FILTER_NUM_RATES]
+                                                  [ADC_FILTER_NUM_BANKS]
+                                                  [ADC_FILTER_Q15_TOTAL_COEFFS];
+
+    /**
+     * @brief DC gain of each stage of each bank, for adc_filter_warm_start().
+     */
+    extern const float32_t adc_filter_stage_dc_gain[ADC_FILTER_NUM_RATES]
+                                                   [ADC_FILTER_NUM_BANKS]
+                                                   [ADC_FILTER_NUM_STAGES];
+
+    /**
+     * @brief Filter coefficients of the slow channel set, in CMSIS-DSP format.
+     */
+    extern const float32_t
+        adc_filter_slow_coefficients[ADC_FILTER_SLOW_TOTAL_COEFFS];
+
+    /**
+     * @brief Slow channel set in q31, scaled by 2^-ADC_FILTER_Q31_POST_SHIFT.
+     */
+    extern const q31_t
+        adc_filter_slow_coefficients_q31[ADC_FILTER_SLOW_TOTAL_COEFFS];
+
+    /**
+     * @brief Slow channel set in q15, scaled by 2^-ADC_FILTER_Q15_POST_SHIFT.
+     */
+    extern const q15_t
+        adc_filter_slow_coefficients_q15[ADC_FILTER_SLOW_Q15_TOTAL_COEFFS];
+
+    /**
+     * @brief DC gain of each stage of the slow channel set.
+     */
+    extern const float32_t
+        adc_filter_slow_stage_dc_gain[ADC_FILTER_SLOW_STAGES];
+
+    /**
+     * @brief Mains fundamental frequency (Hz) notched out by each bank.
+     */
+    extern const uint16_t adc_filter_bank_mains_freq[ADC_FILTER_NUM_BANKS];
+
+    /**
+     * @brief Decimator FIR coefficients of each sample rate (CMSIS-DSP order,
+     *        time reversed).
+     */
+    extern const float32_t
+        adc_filter_decimation_coefficients[ADC_FILTER_NUM_RATES]
+                                          [ADC_FILTER_DECIMATION_TAPS];
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,178 @@
+/**
+ * @file adc_filter_mains.h
+ * @brief Mains frequency estimator for the adaptive notch filter.
+ *
+ * Estimates the actual mains frequency from the raw samples of one ADC
+ * channel, so the notch stages can be retuned with
+ * adc_filter_retune_mains() instead of assuming exactly 50.00 Hz or
+ * 60.00 Hz.
+ *
+ * The estimator runs a single-bin Goertzel filter at the nominal frequency
+ * over windows of ADC_FILTER_MAINS_WINDOW(fs) samples at the sample rate fs
+ * of the channel. Each window holds a whole number of nominal cycles, so the
+ * DC level and harmonics do not leak into the bin. A frequency offset makes
+ * the bin's phase advance from one window to the next; the offset follows as
+ *
+ *   df = dphi * fs / (2 * pi * ADC_FILTER_MAINS_WINDOW(fs))
+ *
+ * which is unambiguous up to +/- fs / (2 * ADC_FILTER_MAINS_WINDOW(fs)),
+ * 2.5 Hz at any rate.
+ *
+ * Cost per sample is one multiply-accumulate; the estimate itself (one
+ * atan2f) is computed once per window.
+ *
+ * @note All memory is statically allocated - no dynamic allocation.
+ *
+ * Usage:
+ * @code
+ *   adc_filter_mains_t mains;
+ *   adc_filter_mains_init(&mains, 50.0f, ADC_FILTER_SAMPLE_RATE);
+ *
+ *   if (adc_filter_mains_process(&mains, samples, block_size))
+ *   {
+ *       (void)adc_filter_retune_mains(&filter_ctx, bank,
+ *                                     adc_filter_mains_get_frequency(&mains));
+ *   }
+ * @endcode
+ */
+
+#ifndef ADC_FILTER_MAINS_H
+#define ADC_FILTER_MAINS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "adc_filter_coefficients.h"
+#include "arm_math.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/**
+ * Samples per estimation window (200 ms) at sample rate @p fs (Hz): a whole
+ * number of cycles for any nominal frequency that is a multiple of 5 Hz,
+ * measuring up to +/- 2.5 Hz.
+ */
+#define ADC_FILTER_MAINS_WINDOW(fs) ((fs) / 5U)
+
+/** Largest accepted deviation from the nominal frequency (Hz) */
+#define ADC_FILTER_MAINS_MAX_DEVIATION 2.0f
+
+/**
+ * Smallest mains amplitude that is tracked, in normalized units (1 LSB of
+ * the 12-bit ADC). Weaker windows keep the previous estimate.
+ */
+#define ADC_FILTER_MAINS_MIN_AMPLITUDE (1.0f / 4095.0f)
+
+/** Weight of a new window in the smoothed estimate (0 to 1) */
+#define ADC_FILTER_MAINS_SMOOTHING 0.25f
+
+    /*******************************************************************************
+     * Types
+     ******************************************************************************/
+
+    /**
+     * @brief Mains frequency estimator state.
+     */
+    typedef struct
+    {
+        /** Nominal mains frequency (Hz) */
+        float32_t nominal_hz;
+
+        /** Sample rate of the tracked channel (Hz) */
+        uint32_t sample_rate;
+
+        /** Samples per window, ADC_FILTER_MAINS_WINDOW(sample_rate) */
+        uint32_t window;
+
+        /** Goertzel feedback coefficient, 2 * cos(w) */
+        float32_t coeff;
+
+        /** cos(w) and sin(w) of the nominal bin */
+        float32_t cos_w;
+        float32_t sin_w;
+
+        /** Goertzel state s[n-1] and s[n-2] */
+        float32_t s1;
+        float32_t s2;
+
+        /** Samples accumulated in the current window */
+        uint32_t count;
+
+        /** Bin value of the previous window (real, imaginary) */
+        float32_t prev_re;
+        float32_t prev_im;
+
+        /** Flag indicating the previous window is usable for a phase step */
+        bool have_prev;
+
+        /** Smoothed frequency estimate (Hz) */
+        float32_t frequency_hz;
+    } adc_filter_mains_t;
+
+    /*******************************************************************************
+     * API Functions
+     ******************************************************************************/
+
+    /**
+     * @brief Initialize the estimator for a nominal mains frequency.
+     *
+     * @param[out] mains       Pointer to the estimator to initialize.
+     * @param[in]  nominal_hz  Nominal mains frequency (50 or 60 Hz).
+     * @param[in]  sample_rate Sample rate of the tracked channel (Hz), a
+     *                         multiple of 5 Hz.
+     *
+     * @note The estimate starts at @p nominal_hz. Initialize again when the
+     *       sample rate changes.
+     */
+    void adc_filter_mains_init(adc_filter_mains_t *mains, float32_t nominal_hz,
+                               uint32_t sample_rate);
+
+    /**
+     * @brief Feed a block of samples to the estimator.
+     *
+     * @param[in,out] mains      Pointer to the estimator.
+     * @param[in]     input      Samples of the tracked channel, normalized
+     *                           like ADC_FILTER_TO_FLOAT() (0.0 to 1.0).
+     * @param[in]     block_size Number of samples; any size, windows may end
+     *                           inside a block.
+     *
+     * @return true if a window completed in this block and updated the
+     *         estimate, false otherwise.
+     *
+     * @note A gap in the input (dropped samples) breaks the phase reference;
+     *       call adc_filter_mains_restart() after one.
+     */
+    bool adc_filter_mains_process(adc_filter_mains_t *mains,
+                                  const float32_t    *input,
+                                  uint32_t            block_size);
+
+    /**
+     * @brief Discard the current window and phase reference.
+     *
+     * Keeps the current estimate.
+     *
+     * @param[in,out] mains Pointer to the estimator.
+     */
+    void adc_filter_mains_restart(adc_filter_mains_t *mains);
+
+    /**
+     * @brief Get the smoothed mains frequency estimate.
+     *
+     * @param[in] mains Pointer to the estimator.
+     *
+     * @return Estimated mains frequency in Hz.
+     */
+    float32_t adc_filter_mains_get_frequency(const adc_filter_mains_t *mains);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_FILTER_MAINS_H */
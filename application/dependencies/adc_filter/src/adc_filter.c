@@ -8,55 +8,584 @@
 
 #include "adc_filter.h"
 
+#include <math.h>
+#include <stdatomic.h>
 #include <string.h>
 
 #include "adc_filter_coefficients.h"
 
+/*******************************************************************************
+ * Backend Selection
+ ******************************************************************************/
+
+#if (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_F32)
+#define ADC_FILTER_BACKEND_INIT(inst, stages, coeffs, state) \
+    arm_biquad_cascade_df1_init_f32((inst), (stages), (coeffs), (state))
+#define ADC_FILTER_BACKEND_TABLES(rate) \
+    (&adc_filter_coefficients[(rate)][0][0])
+#define ADC_FILTER_BACKEND_SLOW_TABLES (adc_filter_slow_coefficients)
+#define ADC_FILTER_BACKEND_RUN(inst, in, out, n) \
+    arm_biquad_cascade_df1_f32((inst), (in), (out), (n))
+
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF2T_F32)
+#define ADC_FILTER_BACKEND_INIT(inst, stages, coeffs, state) \
+    arm_biquad_cascade_df2T_init_f32((inst), (stages), (coeffs), (state))
+#define ADC_FILTER_BACKEND_TABLES(rate) \
+    (&adc_filter_coefficients[(rate)][0][0])
+#define ADC_FILTER_BACKEND_SLOW_TABLES (adc_filter_slow_coefficients)
+#define ADC_FILTER_BACKEND_RUN(inst, in, out, n) \
+    arm_biquad_cascade_df2T_f32((inst), (in), (out), (n))
+
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31)
+#define ADC_FILTER_BACKEND_INIT(inst, stages, coeffs, state)          \
+    arm_biquad_cascade_df1_init_q31((inst), (stages), (coeffs), (state), \
+                                    ADC_FILTER_Q31_POST_SHIFT)
+#define ADC_FILTER_BACKEND_TABLES(rate) \
+    (&adc_filter_coefficients_q31[(rate)][0][0])
+#define ADC_FILTER_BACKEND_SLOW_TABLES (adc_filter_slow_coefficients_q31)
+#define ADC_FILTER_BACKEND_RUN(inst, in, out, n) \
+    arm_biquad_cascade_df1_q31((inst), (in), (out), (n))
+
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15)
+#define ADC_FILTER_BACKEND_INIT(inst, stages, coeffs, state)          \
+    arm_biquad_cascade_df1_init_q15((inst), (stages), (coeffs), (state), \
+                                    ADC_FILTER_Q15_POST_SHIFT)
+#define ADC_FILTER_BACKEND_TABLES(rate) \
+    (&adc_filter_coefficients_q15[(rate)][0][0])
+#define ADC_FILTER_BACKEND_SLOW_TABLES (adc_filter_slow_coefficients_q15)
+#define ADC_FILTER_BACKEND_RUN(inst, in, out, n) \
+    arm_biquad_cascade_df1_fast_q15((inst), (in), (out), (n))
+#endif
+
+#if ((ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31) || \
+     (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15))
+#define ADC_FILTER_BACKEND_TRACKING(ctx, index)          \
+    (&(ctx)->tracking_fixed[(uint32_t)(index) * (ctx)->max_stages * \
+                            ADC_FILTER_BACKEND_COEFFS_PER_STAGE])
+#else
+#define ADC_FILTER_BACKEND_TRACKING(ctx, index) \
+    (adc_filter_tracking_f32((ctx), (index)))
+#endif
+
+/*******************************************************************************
+ * Public Data
+ ******************************************************************************/
+
+/* Descriptor of the generated set of one sample rate */
+#define ADC_FILTER_COEFFS_RATE(rate, hz)                                 \
+    {                                                                    \
+        .coeffs            = &adc_filter_coefficients[(rate)][0][0],     \
+        .backend_coeffs    = ADC_FILTER_BACKEND_TABLES(rate),            \
+        .dc_gain           = &adc_filter_stage_dc_gain[(rate)][0][0],    \
+        .decimation_coeffs = adc_filter_decimation_coefficients[(rate)], \
+        .sample_rate       = (hz),                                       \
+        .notch_q           = (float32_t)ADC_FILTER_NOTCH_Q,              \
+        .decimation_taps   = (uint16_t)ADC_FILTER_DECIMATION_TAPS,       \
+        .decimation_factor = (uint8_t)ADC_FILTER_DECIMATION_FACTOR,      \
+        .num_stages        = (uint8_t)ADC_FILTER_NUM_STAGES,             \
+        .lpf_stages        = (uint8_t)ADC_FILTER_LPF_STAGES,             \
+        .num_banks         = (uint8_t)ADC_FILTER_NUM_BANKS,              \
+        .default_bank      = (uint8_t)ADC_FILTER_DEFAULT_BANK,           \
+    },
+
+const adc_filter_coeffs_t adc_filter_coeffs_rates[ADC_FILTER_NUM_RATES] = {
+    ADC_FILTER_FOR_EACH_RATE(ADC_FILTER_COEFFS_RATE)
+};
+
+/* Generated set of the slow channels: the LPF alone, in one bank */
+const adc_filter_coeffs_t adc_filter_coeffs_slow = {
+    .coeffs            = adc_filter_slow_coefficients,
+    .backend_coeffs    = ADC_FILTER_BACKEND_SLOW_TABLES,
+    .dc_gain           = adc_filter_slow_stage_dc_gain,
+    .decimation_coeffs = NULL,
+    .sample_rate       = ADC_FILTER_SLOW_SAMPLE_RATE,
+    .notch_q           = (float32_t)ADC_FILTER_NOTCH_Q,
+    .decimation_taps   = 0U,
+    .decimation_factor = 1U,
+    .num_stages        = (uint8_t)ADC_FILTER_SLOW_STAGES,
+    .lpf_stages        = (uint8_t)ADC_FILTER_SLOW_STAGES,
+    .num_banks         = 1U,
+    .default_bank      = 0U,
+};
+
 /*******************************************************************************
  * Private Functions
  ******************************************************************************/
 
+/**
+ * @brief Get one buffer of the float tracking bank.
+ *
+ * @param[in] ctx   Pointer to the filter context.
+ * @param[in] index Tracking buffer (0 or 1).
+ *
+ * @return Pointer to the buffer's coefficients.
+ */
+static inline ADC_FILTER_RAMFUNC float32_t *
+adc_filter_tracking_f32(const adc_filter_context_t *ctx, uint8_t index)
+{
+    return &ctx->tracking_f32[(uint32_t)index * ctx->max_stages *
+                              ADC_FILTER_COEFFS_PER_STAGE];
+}
+
+/**
+ * @brief Get the float coefficients of a designed bank.
+ *
+ * @param[in] ctx  Pointer to the filter context.
+ * @param[in] bank Bank index (0 to num_banks-1 of the set).
+ *
+ * @return Pointer to the bank's coefficients.
+ */
+static inline ADC_FILTER_RAMFUNC const float32_t *
+adc_filter_design_coeffs(const adc_filter_context_t *ctx, uint8_t bank)
+{
+    return &ctx->coeffs->coeffs[(uint32_t)bank * ctx->coeffs->num_stages *
+                                ADC_FILTER_COEFFS_PER_STAGE];
+}
+
+/**
+ * @brief Get the backend coefficients of a bank.
+ *
+ * @param[in] ctx  Pointer to the filter context.
+ * @param[in] bank Bank index, or the tracking bank.
+ *
+ * @return Pointer to the bank's coefficients in the backend format.
+ */
+static inline ADC_FILTER_RAMFUNC const adc_filter_coeff_t *
+adc_filter_bank_coeffs(const adc_filter_context_t *ctx, uint8_t bank)
+{
+    if (bank == ctx->coeffs->num_banks)
+    {
+        return ADC_FILTER_BACKEND_TRACKING(ctx, ctx->tracking_index);
+    }
+
+    return &ctx->coeffs->backend_coeffs[(uint32_t)bank *
+                                        ctx->coeffs->num_stages *
+                                        ADC_FILTER_BACKEND_COEFFS_PER_STAGE];
+}
+
+/**
+ * @brief Get the cascade state of a channel.
+ *
+ * @param[in] ctx     Pointer to the filter context.
+ * @param[in] channel Channel index.
+ *
+ * @return Pointer to the channel's state words.
+ */
+static adc_filter_sample_t *adc_filter_channel_state(adc_filter_context_t *ctx,
+                                                     uint8_t channel)
+{
+    return &ctx->state[(uint32_t)channel * ctx->max_stages *
+                       ADC_FILTER_BACKEND_STATE_PER_STAGE];
+}
+
+/**
+ * @brief Get one frame state variable of every channel.
+ *
+ * @param[in] ctx   Pointer to the filter context.
+ * @param[in] stage Stage index.
+ * @param[in] k     State variable: x[n-1], x[n-2], y[n-1], y[n-2].
+ *
+ * @return Pointer to the variable of channel 0, the others following.
+ */
+static inline ADC_FILTER_RAMFUNC float32_t *
+adc_filter_frame_state(const adc_filter_context_t *ctx, uint32_t stage,
+                       uint32_t k)
+{
+    return &ctx->frame_state[((stage * ADC_FILTER_STATE_PER_STAGE) + k) *
+                             ctx->num_channels];
+}
+
 /**
  * @brief Initialize a single filter channel.
  *
- * @param[in,out] channel Pointer to the channel structure.
+ * @param[in,out] ctx     Pointer to the filter context.
+ * @param[in]     channel Channel index.
+ * @param[in]     bank    Bank to filter with, or the tracking bank.
  */
-static void adc_filter_init_channel(adc_filter_channel_t *channel)
+static void adc_filter_init_channel(adc_filter_context_t *ctx, uint8_t channel,
+                                    uint8_t bank)
 {
+    adc_filter_channel_t *chan = &ctx->channels[channel];
+
     /* Clear state buffer */
-    (void)memset(channel->state, 0, sizeof(channel->state));
+    chan->state = adc_filter_channel_state(ctx, channel);
+    (void)memset(chan->state, 0,
+                 (size_t)ctx->max_stages * ADC_FILTER_BACKEND_STATE_PER_STAGE *
+                     sizeof(adc_filter_sample_t));
 
     /* Initialize CMSIS-DSP biquad cascade filter */
-    arm_biquad_cascade_df1_init_f32(&channel->instance, ADC_FILTER_NUM_STAGES,
-                                    adc_filter_coefficients, channel->state);
+    chan->bank = bank;
+    ADC_FILTER_BACKEND_INIT(&chan->instance, ctx->coeffs->num_stages,
+                            adc_filter_bank_coeffs(ctx, chan->bank),
+                            chan->state);
+
+    chan->initialized = true;
+}
+
+/**
+ * @brief Switch a channel to its requested coefficient bank, if it changed.
+ *
+ * Called between filter calls only, so the swap lands on a frame boundary.
+ * The fixed-point banks share one postShift, so only the coefficient
+ * pointer changes. This also picks up a newly published tracking bank.
+ *
+ * @param[in]     ctx     Pointer to the filter context.
+ * @param[in,out] channel Pointer to the channel structure.
+ */
+static inline ADC_FILTER_RAMFUNC void
+adc_filter_apply_bank(const adc_filter_context_t *ctx,
+                      adc_filter_channel_t       *channel)
+{
+    const adc_filter_coeff_t *coeffs =
+        adc_filter_bank_coeffs(ctx, channel->bank);
+
+    if (channel->instance.pCoeffs != coeffs)
+    {
+        channel->instance.pCoeffs = coeffs;
+    }
+}
+
+/**
+ * @brief Design one notch stage, as config/adc_filter_design.py does.
+ *
+ * @param[out] coeffs Five coefficients {b0, b1, b2, -a1, -a2}.
+ * @param[in]  set    Coefficient set the stage is designed for.
+ * @param[in]  freq   Notch frequency (Hz), below the Nyquist rate.
+ */
+static void adc_filter_design_notch(float32_t                 *coeffs,
+                                    const adc_filter_coeffs_t *set,
+                                    float32_t                  freq)
+{
+    const float32_t fs = (float32_t)set->sample_rate;
+    const float32_t bw = freq / set->notch_q;
+    float32_t       r  = 1.0f - (PI * bw / fs);
+
+    /*
+     * 1 - cos(w0) written as 2 * sin^2(w0 / 2): cos(w0) is close to 1 for
+     * low notches, and the direct difference would lose most of its bits.
+     */
+    const float32_t half = sinf(PI * freq / fs);
+    const float32_t one_minus_cos = 2.0f * half * half;
+    const float32_t cos_w0        = 1.0f - one_minus_cos;
+    float32_t       gain;
+
+    /* Clamp r to prevent instability (must be < 1) */
+    if (r > 0.999f)
+    {
+        r = 0.999f;
+    }
+
+    /* Unity DC gain: (b0 + b1 + b2) / (1 + a1 + a2) */
+    gain = (2.0f * one_minus_cos) /
+           (((1.0f - r) * (1.0f - r)) + (2.0f * r * one_minus_cos));
+
+    coeffs[0] = 1.0f / gain;
+    coeffs[1] = (-2.0f * cos_w0) / gain;
+    coeffs[2] = 1.0f / gain;
+    coeffs[3] = 2.0f * r * cos_w0;
+    coeffs[4] = -(r * r);
+}
+
+#if (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31)
+/**
+ * @brief Quantize a float bank to the q31 layout.
+ *
+ * @param[in]  src    Float coefficients.
+ * @param[out] dst    q31 coefficients scaled by 2^-ADC_FILTER_Q31_POST_SHIFT.
+ * @param[in]  stages Stages of the bank.
+ */
+static void adc_filter_quantize_bank(const float32_t *src, q31_t *dst,
+                                     uint32_t stages)
+{
+    const float32_t scale =
+        2147483648.0f / (float32_t)(1UL << ADC_FILTER_Q31_POST_SHIFT);
+
+    for (uint32_t i = 0U; i < (stages * ADC_FILTER_COEFFS_PER_STAGE); i++)
+    {
+        const float32_t v = roundf(src[i] * scale);
+
+        dst[i] = (v >= 2147483647.0f)    ? (q31_t)0x7FFFFFFF
+                 : (v <= -2147483647.0f) ? (q31_t)-0x7FFFFFFF
+                                         : (q31_t)v;
+    }
+}
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15)
+/**
+ * @brief Quantize a float bank to the q15 layout {b0, 0, b1, b2, a1, a2}.
+ *
+ * @param[in]  src    Float coefficients.
+ * @param[out] dst    q15 coefficients scaled by 2^-ADC_FILTER_Q15_POST_SHIFT.
+ * @param[in]  stages Stages of the bank.
+ */
+static void adc_filter_quantize_bank(const float32_t *src, q15_t *dst,
+                                     uint32_t stages)
+{
+    const float32_t scale =
+        32768.0f / (float32_t)(1UL << ADC_FILTER_Q15_POST_SHIFT);
+
+    for (uint32_t stage = 0U; stage < stages; stage++)
+    {
+        const float32_t *in  = &src[stage * ADC_FILTER_COEFFS_PER_STAGE];
+        q15_t           *out = &dst[stage * ADC_FILTER_Q15_COEFFS_PER_STAGE];
+        uint32_t         k   = 0U;
+
+        for (uint32_t i = 0U; i < ADC_FILTER_Q15_COEFFS_PER_STAGE; i++)
+        {
+            float32_t v = 0.0f;
+
+            /* Slot 1 is the padding zero */
+            if (i != 1U)
+            {
+                v = roundf(in[k] * scale);
+                k++;
+            }
+
+            out[i] = (v >= 32767.0f)    ? (q15_t)32767
+                     : (v <= -32767.0f) ? (q15_t)-32767
+                                        : (q15_t)v;
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Get the DC gain of one stage of a bank.
+ *
+ * The notch stages of the tracking bank are designed for unity DC gain
+ * (adc_filter_design_notch()), its LPF stages come from a designed bank.
+ *
+ * @param[in] ctx   Pointer to the filter context.
+ * @param[in] bank  Bank index, or the tracking bank.
+ * @param[in] stage Stage index.
+ *
+ * @return DC gain of the stage.
+ */
+static float32_t adc_filter_dc_gain(const adc_filter_context_t *ctx,
+                                    uint8_t bank, uint32_t stage)
+{
+    const adc_filter_coeffs_t *set = ctx->coeffs;
+
+    if (bank != set->num_banks)
+    {
+        return set->dc_gain[((uint32_t)bank * set->num_stages) + stage];
+    }
+
+    if (stage < set->lpf_stages)
+    {
+        bank = ctx->tracking_base[ctx->tracking_index];
+        return set->dc_gain[((uint32_t)bank * set->num_stages) + stage];
+    }
+
+    return 1.0f;
+}
+
+/**
+ * @brief Convert a level to the backend's sample format, saturating.
+ *
+ * @param[in] level Level in sample units.
+ *
+ * @return Nearest sample.
+ */
+static adc_filter_sample_t adc_filter_to_sample(float32_t level)
+{
+#if (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31)
+    const float32_t v = roundf(level);
+
+    return (v >= 2147483647.0f)    ? (q31_t)0x7FFFFFFF
+           : (v <= -2147483647.0f) ? (q31_t)-0x7FFFFFFF
+                                   : (q31_t)v;
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15)
+    const float32_t v = roundf(level);
+
+    return (v >= 32767.0f)    ? (q15_t)32767
+           : (v <= -32767.0f) ? (q15_t)-32767
+                              : (q15_t)v;
+#else
+    return level;
+#endif
+}
+
+/**
+ * @brief Get the FIR decimator state of a channel.
+ *
+ * @param[in] ctx     Pointer to the filter context.
+ * @param[in] channel Channel index.
+ *
+ * @return Pointer to the channel's decimator state words.
+ */
+static float32_t *adc_filter_decimator_state(const adc_filter_context_t *ctx,
+                                             uint8_t channel)
+{
+    return &ctx->decimator_state[(uint32_t)channel *
+                                 ((uint32_t)ctx->max_decimation_taps +
+                                  ctx->max_block_size - 1U)];
+}
+
+/**
+ * @brief Initialize the FIR decimator of a single channel.
+ *
+ * Does nothing if the set has no decimator.
+ *
+ * @param[in,out] ctx     Pointer to the filter context.
+ * @param[in]     channel Channel index.
+ */
+static void adc_filter_init_decimator(adc_filter_context_t *ctx,
+                                      uint8_t               channel)
+{
+    const adc_filter_coeffs_t *set   = ctx->coeffs;
+    float32_t                 *state = adc_filter_decimator_state(ctx, channel);
+
+    if (set->decimation_factor <= 1U)
+    {
+        return;
+    }
+
+    /* Clear state buffer */
+    (void)memset(state, 0,
+                 ((size_t)ctx->max_decimation_taps + ctx->max_block_size -
+                  1U) * sizeof(float32_t));
+
+    /* blockSize only sizes the state; any multiple of M works at run time */
+    (void)arm_fir_decimate_init_f32(
+        &ctx->decimators[channel], set->decimation_taps,
+        set->decimation_factor, set->decimation_coeffs, state,
+        ctx->max_block_size);
+}
+
+/**
+ * @brief Check that a coefficient set fits the storage of a context.
+ *
+ * @param[in] ctx Pointer to the filter context.
+ * @param[in] set Coefficient set.
+ *
+ * @return true if the context can filter with @p set.
+ */
+static bool adc_filter_set_fits(const adc_filter_context_t *ctx,
+                                const adc_filter_coeffs_t  *set)
+{
+    return (set->num_stages != 0U) && (set->num_stages <= ctx->max_stages) &&
+           (set->lpf_stages <= set->num_stages) &&
+           (set->default_bank < set->num_banks) &&
+           ((set->decimation_factor <= 1U) ||
+            ((set->decimation_taps <= ctx->max_decimation_taps) &&
+             ((ctx->max_block_size % set->decimation_factor) == 0U)));
+}
+
+/**
+ * @brief Start filtering with the set of a context, from cleared state.
+ *
+ * @param[in,out] ctx        Pointer to the filter context, its set checked
+ *                           with adc_filter_set_fits().
+ * @param[in]     keep_banks Keep the bank requested for each channel
+ *                           instead of the default bank of the set.
+ */
+static void adc_filter_start(adc_filter_context_t *ctx, bool keep_banks)
+{
+    const adc_filter_coeffs_t *set = ctx->coeffs;
+
+    /* The tracking bank starts as a copy of the default bank */
+    for (uint8_t i = 0U; i < 2U; i++)
+    {
+        (void)memcpy(adc_filter_tracking_f32(ctx, i),
+                     adc_filter_design_coeffs(ctx, set->default_bank),
+                     (size_t)set->num_stages * ADC_FILTER_COEFFS_PER_STAGE *
+                         sizeof(float32_t));
+#if ((ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31) || \
+     (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15))
+        (void)memcpy(ADC_FILTER_BACKEND_TRACKING(ctx, i),
+                     adc_filter_bank_coeffs(ctx, set->default_bank),
+                     (size_t)set->num_stages *
+                         ADC_FILTER_BACKEND_COEFFS_PER_STAGE *
+                         sizeof(adc_filter_coeff_t));
+#endif
+    }
+    ctx->tracking_index   = 0U;
+    ctx->tracking_hz      = 0.0f;
+    ctx->tracking_base[0] = set->default_bank;
+    ctx->tracking_base[1] = set->default_bank;
+
+    /* Initialize each channel */
+    for (uint8_t ch = 0U; ch < ctx->num_channels; ch++)
+    {
+        uint8_t bank = keep_banks ? ctx->channels[ch].bank : set->default_bank;
+
+        adc_filter_init_channel(ctx, ch, bank);
+    }
 
-    channel->initialized = true;
+    /* Clear the interleaved multi-channel state */
+    (void)memset(ctx->frame_state, 0,
+                 (size_t)ctx->max_stages * ADC_FILTER_STATE_PER_STAGE *
+                     ctx->num_channels * sizeof(float32_t));
+
+    for (uint8_t ch = 0U; ch < ctx->num_channels; ch++)
+    {
+        adc_filter_init_decimator(ctx, ch);
+    }
 }
 
 /*******************************************************************************
  * Public Functions
  ******************************************************************************/
 
-void adc_filter_init(adc_filter_context_t *ctx)
+bool adc_filter_init(adc_filter_context_t *ctx)
 {
-    if (ctx == NULL)
+    const adc_filter_coeffs_t *set;
+
+    if ((ctx == NULL) || (ctx->coeffs == NULL))
     {
-        return;
+        return false;
     }
 
-    /* Initialize each channel */
-    for (uint8_t ch = 0U; ch < ADC_FILTER_NUM_CHANNELS; ch++)
+    set = ctx->coeffs;
+    if (!adc_filter_set_fits(ctx, set))
+    {
+        for (uint8_t ch = 0U; ch < ctx->num_channels; ch++)
+        {
+            ctx->channels[ch].initialized = false;
+        }
+        return false;
+    }
+
+    adc_filter_start(ctx, false);
+
+    return true;
+}
+
+const adc_filter_coeffs_t *adc_filter_coeffs_for_rate(uint32_t sample_rate)
+{
+    for (uint32_t i = 0U; i < ADC_FILTER_NUM_RATES; i++)
+    {
+        if (adc_filter_coeffs_rates[i].sample_rate == sample_rate)
+        {
+            return &adc_filter_coeffs_rates[i];
+        }
+    }
+
+    return NULL;
+}
+
+bool adc_filter_set_coeffs(adc_filter_context_t      *ctx,
+                           const adc_filter_coeffs_t *set)
+{
+    if ((ctx == NULL) || (set == NULL) || !adc_filter_set_fits(ctx, set) ||
+        (set->num_banks != ctx->coeffs->num_banks))
     {
-        adc_filter_init_channel(&ctx->channels[ch]);
+        return false;
     }
+
+    ctx->coeffs = set;
+    adc_filter_start(ctx, true);
+
+    return true;
 }
 
-float32_t adc_filter_process_sample(adc_filter_context_t *ctx, uint8_t channel,
-                                    float32_t input)
+ADC_FILTER_RAMFUNC adc_filter_sample_t
+adc_filter_process_sample(adc_filter_context_t *ctx, uint8_t channel,
+                          adc_filter_sample_t input)
 {
-    float32_t output = 0.0f;
+    adc_filter_sample_t output = 0;
 
-    if ((ctx == NULL) || (channel >= ADC_FILTER_NUM_CHANNELS))
+    if ((ctx == NULL) || (channel >= ctx->num_channels))
     {
         return input; /* Return unfiltered on error */
     }
@@ -66,25 +595,28 @@ float32_t adc_filter_process_sample(adc_filter_context_t *ctx, uint8_t channel,
         return input; /* Return unfiltered if not initialized */
     }
 
+    adc_filter_apply_bank(ctx, &ctx->channels[channel]);
+
     /* Process single sample using CMSIS-DSP
-     * Note: arm_biquad_cascade_df1_f32 processes blocks, so we use block size 1
+     * Note: the biquad cascades process blocks, so we use block size 1
      */
-    arm_biquad_cascade_df1_f32(&ctx->channels[channel].instance, &input,
-                               &output, 1U);
+    ADC_FILTER_BACKEND_RUN(&ctx->channels[channel].instance, &input, &output,
+                           1U);
 
     return output;
 }
 
-void adc_filter_process_block(adc_filter_context_t *ctx, uint8_t channel,
-                              const float32_t *input, float32_t *output,
-                              uint32_t block_size)
+ADC_FILTER_RAMFUNC void
+adc_filter_process_block(adc_filter_context_t *ctx, uint8_t channel,
+                         const adc_filter_sample_t *input,
+                         adc_filter_sample_t *output, uint32_t block_size)
 {
     if ((ctx == NULL) || (input == NULL) || (output == NULL))
     {
         return;
     }
 
-    if (channel >= ADC_FILTER_NUM_CHANNELS)
+    if (channel >= ctx->num_channels)
     {
         return;
     }
@@ -92,7 +624,7 @@ void adc_filter_process_block(adc_filter_context_t *ctx, uint8_t channel,
     if (!ctx->channels[channel].initialized)
     {
         /* Copy input to output unfiltered if not initialized */
-        (void)memcpy(output, input, block_size * sizeof(float32_t));
+        (void)memcpy(output, input, block_size * sizeof(adc_filter_sample_t));
         return;
     }
 
@@ -101,28 +633,270 @@ void adc_filter_process_block(adc_filter_context_t *ctx, uint8_t channel,
         return;
     }
 
+    adc_filter_apply_bank(ctx, &ctx->channels[channel]);
+
     /* Process block using CMSIS-DSP */
-    arm_biquad_cascade_df1_f32(&ctx->channels[channel].instance, input, output,
-                               block_size);
+    ADC_FILTER_BACKEND_RUN(&ctx->channels[channel].instance, input, output,
+                           block_size);
+}
+
+ADC_FILTER_RAMFUNC void
+adc_filter_from_adc_block(const q15_t *raw, adc_filter_sample_t *output,
+                          uint32_t extra_bits, uint32_t block_size)
+{
+    if ((raw == NULL) || (output == NULL))
+    {
+        return;
+    }
+
+#if (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15)
+    arm_shift_q15(raw,
+                  (int8_t)(3 - (int32_t)ADC_FILTER_INPUT_HEADROOM_BITS -
+                           (int32_t)extra_bits),
+                  output, block_size);
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31)
+    /* arm_q15_to_q31() shifts by 16, the rest of the 19 bits follow */
+    arm_q15_to_q31(raw, output, block_size);
+    arm_shift_q31(output,
+                  (int8_t)(3 - (int32_t)ADC_FILTER_INPUT_HEADROOM_BITS -
+                           (int32_t)extra_bits),
+                  output, block_size);
+#else
+    /* arm_q15_to_float() divides by 32768, rescale to full scale */
+    arm_q15_to_float(raw, output, block_size);
+    arm_scale_f32(output,
+                  32768.0f / (4095.0f * (float32_t)(1UL << extra_bits)),
+                  output, block_size);
+#endif
+}
+
+ADC_FILTER_RAMFUNC void
+adc_filter_to_float_block(const adc_filter_sample_t *input, float32_t *output,
+                          uint32_t block_size)
+{
+    if ((input == NULL) || (output == NULL))
+    {
+        return;
+    }
+
+#if (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15)
+    arm_q15_to_float(input, output, block_size);
+    arm_scale_f32(output, (float32_t)(1UL << ADC_FILTER_INPUT_HEADROOM_BITS),
+                  output, block_size);
+#elif (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31)
+    arm_q31_to_float(input, output, block_size);
+    arm_scale_f32(output, (float32_t)(1UL << ADC_FILTER_INPUT_HEADROOM_BITS),
+                  output, block_size);
+#else
+    if (output != input)
+    {
+        (void)memcpy(output, input, block_size * sizeof(float32_t));
+    }
+#endif
+}
+
+ADC_FILTER_RAMFUNC void
+adc_filter_process_frame(adc_filter_context_t *ctx, const float32_t *input,
+                         float32_t *output)
+{
+    const float32_t *coeffs;
+    uint32_t         channels;
+    uint8_t          bank;
+
+    if ((ctx == NULL) || (input == NULL) || (output == NULL))
+    {
+        return;
+    }
+
+    /* All channels share channel 0's bank, read once per frame */
+    bank   = ctx->channels[0].bank;
+    coeffs = (bank == ctx->coeffs->num_banks)
+                 ? adc_filter_tracking_f32(ctx, ctx->tracking_index)
+                 : adc_filter_design_coeffs(ctx, bank);
+
+    /* The cascade runs in place in the output frame */
+    channels = ctx->num_channels;
+    if (output != input)
+    {
+        (void)memcpy(output, input, channels * sizeof(float32_t));
+    }
+
+    for (uint32_t stage = 0U; stage < ctx->coeffs->num_stages; stage++)
+    {
+        /* Load this stage's coefficients once for all channels */
+        const float32_t b0 = coeffs[0];
+        const float32_t b1 = coeffs[1];
+        const float32_t b2 = coeffs[2];
+        const float32_t a1 = coeffs[3];
+        const float32_t a2 = coeffs[4];
+
+        float32_t *x1 = adc_filter_frame_state(ctx, stage, 0U);
+        float32_t *x2 = adc_filter_frame_state(ctx, stage, 1U);
+        float32_t *y1 = adc_filter_frame_state(ctx, stage, 2U);
+        float32_t *y2 = adc_filter_frame_state(ctx, stage, 3U);
+
+        for (uint32_t ch = 0U; ch < channels; ch++)
+        {
+            const float32_t x0 = output[ch];
+            const float32_t y0 = (b0 * x0) + (b1 * x1[ch]) + (b2 * x2[ch]) +
+                                 (a1 * y1[ch]) + (a2 * y2[ch]);
+
+            x2[ch]     = x1[ch];
+            x1[ch]     = x0;
+            y2[ch]     = y1[ch];
+            y1[ch]     = y0;
+            output[ch] = y0;
+        }
+
+        coeffs += ADC_FILTER_COEFFS_PER_STAGE;
+    }
+}
+
+ADC_FILTER_RAMFUNC uint32_t
+adc_filter_decimate_block(adc_filter_context_t *ctx, uint8_t channel,
+                          const float32_t *input, float32_t *output,
+                          uint32_t block_size)
+{
+    uint32_t factor;
+
+    if ((ctx == NULL) || (input == NULL) || (output == NULL))
+    {
+        return 0U;
+    }
+
+    factor = ctx->coeffs->decimation_factor;
+    if ((channel >= ctx->num_channels) || (block_size > ctx->max_block_size) ||
+        ((block_size % factor) != 0U))
+    {
+        return 0U;
+    }
+
+    if (factor > 1U)
+    {
+        arm_fir_decimate_f32(&ctx->decimators[channel], input, output,
+                             block_size);
+    }
+    else
+    {
+        (void)memcpy(output, input, block_size * sizeof(float32_t));
+    }
+
+    return block_size / factor;
 }
 
 void adc_filter_reset(adc_filter_context_t *ctx, uint8_t channel)
 {
-    if ((ctx == NULL) || (channel >= ADC_FILTER_NUM_CHANNELS))
+    if ((ctx == NULL) || (channel >= ctx->num_channels))
     {
         return;
     }
 
     /* Clear state buffer */
     (void)memset(ctx->channels[channel].state, 0,
-                 sizeof(ctx->channels[channel].state));
+                 (size_t)ctx->max_stages * ADC_FILTER_BACKEND_STATE_PER_STAGE *
+                     sizeof(adc_filter_sample_t));
+
+    /* Clear this channel's slots in the interleaved frame state */
+    for (uint32_t stage = 0U; stage < ctx->coeffs->num_stages; stage++)
+    {
+        for (uint32_t k = 0U; k < ADC_FILTER_STATE_PER_STAGE; k++)
+        {
+            adc_filter_frame_state(ctx, stage, k)[channel] = 0.0f;
+        }
+    }
 
     /* Re-initialize the filter instance with cleared state */
     if (ctx->channels[channel].initialized)
     {
-        arm_biquad_cascade_df1_init_f32(
-            &ctx->channels[channel].instance, ADC_FILTER_NUM_STAGES,
-            adc_filter_coefficients, ctx->channels[channel].state);
+        ADC_FILTER_BACKEND_INIT(
+            &ctx->channels[channel].instance, ctx->coeffs->num_stages,
+            adc_filter_bank_coeffs(ctx, ctx->channels[channel].bank),
+            ctx->channels[channel].state);
+    }
+
+    adc_filter_init_decimator(ctx, channel);
+}
+
+void adc_filter_warm_start(adc_filter_context_t *ctx, uint8_t channel,
+                           adc_filter_sample_t input)
+{
+    adc_filter_channel_t *chan;
+    float32_t             level;
+    float32_t             frame_level;
+    uint8_t               frame_bank;
+
+    if ((ctx == NULL) || (channel >= ctx->num_channels))
+    {
+        return;
+    }
+
+    chan = &ctx->channels[channel];
+    if (!chan->initialized)
+    {
+        return;
+    }
+
+    adc_filter_apply_bank(ctx, chan);
+
+    /* Each stage passes its input level on, times its DC gain */
+    level = (float32_t)input;
+    for (uint32_t stage = 0U; stage < ctx->coeffs->num_stages; stage++)
+    {
+        const float32_t out =
+            level * adc_filter_dc_gain(ctx, chan->bank, stage);
+        adc_filter_sample_t *state =
+            &chan->state[stage * ADC_FILTER_BACKEND_STATE_PER_STAGE];
+
+#if (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF2T_F32)
+        /* d1 = y - b0 x, d2 = b2 x + a2 y */
+        const float32_t *coeffs =
+            &chan->instance.pCoeffs[stage * ADC_FILTER_COEFFS_PER_STAGE];
+
+        state[0] = out - (coeffs[0] * level);
+        state[1] = (coeffs[2] * level) + (coeffs[4] * out);
+#else
+        /* {x[n-1], x[n-2], y[n-1], y[n-2]} */
+        state[0] = adc_filter_to_sample(level);
+        state[1] = state[0];
+        state[2] = adc_filter_to_sample(out);
+        state[3] = state[2];
+#endif
+        level = out;
+    }
+
+    /* The frame filter runs the float bank of channel 0 */
+    frame_level = ADC_FILTER_TO_FLOAT(input);
+    frame_bank  = ctx->channels[0].bank;
+    for (uint32_t stage = 0U; stage < ctx->coeffs->num_stages; stage++)
+    {
+        const float32_t out =
+            frame_level * adc_filter_dc_gain(ctx, frame_bank, stage);
+
+        adc_filter_frame_state(ctx, stage, 0U)[channel] = frame_level;
+        adc_filter_frame_state(ctx, stage, 1U)[channel] = frame_level;
+        adc_filter_frame_state(ctx, stage, 2U)[channel] = out;
+        adc_filter_frame_state(ctx, stage, 3U)[channel] = out;
+        frame_level                                     = out;
+    }
+}
+
+void adc_filter_warm_start_decimator(adc_filter_context_t *ctx,
+                                     uint8_t channel, float32_t level)
+{
+    if ((ctx == NULL) || (channel >= ctx->num_channels))
+    {
+        return;
+    }
+
+    if (ctx->coeffs->decimation_factor > 1U)
+    {
+        float32_t *state = adc_filter_decimator_state(ctx, channel);
+
+        /* The kernel keeps the numTaps - 1 newest inputs at the state start */
+        for (uint32_t i = 0U; i < (ctx->coeffs->decimation_taps - 1U); i++)
+        {
+            state[i] = level;
+        }
     }
 }
 
@@ -133,15 +907,112 @@ void adc_filter_reset_all(adc_filter_context_t *ctx)
         return;
     }
 
-    for (uint8_t ch = 0U; ch < ADC_FILTER_NUM_CHANNELS; ch++)
+    for (uint8_t ch = 0U; ch < ctx->num_channels; ch++)
     {
         adc_filter_reset(ctx, ch);
     }
 }
 
+bool adc_filter_select_bank(adc_filter_context_t *ctx, uint8_t channel,
+                            uint8_t bank)
+{
+    if ((ctx == NULL) || (channel >= ctx->num_channels) ||
+        (bank > ctx->coeffs->num_banks))
+    {
+        return false;
+    }
+
+    /* Picked up by adc_filter_apply_bank() before the next filter call */
+    ctx->channels[channel].bank = bank;
+
+    return true;
+}
+
+uint8_t adc_filter_get_bank(const adc_filter_context_t *ctx, uint8_t channel)
+{
+    if ((ctx == NULL) || (channel >= ctx->num_channels))
+    {
+        return (ctx != NULL) ? ctx->coeffs->default_bank : 0U;
+    }
+
+    return ctx->channels[channel].bank;
+}
+
+bool adc_filter_retune_mains(adc_filter_context_t *ctx, uint8_t base_bank,
+                             float32_t mains_hz)
+{
+    const adc_filter_coeffs_t *set;
+    float32_t                  nyquist;
+    float32_t                 *coeffs;
+    uint8_t                    next;
+
+    if ((ctx == NULL) || (base_bank >= ctx->coeffs->num_banks) ||
+        !(mains_hz > 0.0f))
+    {
+        return false;
+    }
+
+    set     = ctx->coeffs;
+    nyquist = (float32_t)set->sample_rate / 2.0f;
+
+    /* Fill the buffer no channel is filtering with */
+    next   = (uint8_t)(1U - ctx->tracking_index);
+    coeffs = adc_filter_tracking_f32(ctx, next);
+
+    /* LPF stages come unchanged from the base bank */
+    (void)memcpy(coeffs, adc_filter_design_coeffs(ctx, base_bank),
+                 (size_t)set->lpf_stages * ADC_FILTER_COEFFS_PER_STAGE *
+                     sizeof(float32_t));
+
+    for (uint32_t stage = set->lpf_stages; stage < set->num_stages; stage++)
+    {
+        float32_t *notch = &coeffs[stage * ADC_FILTER_COEFFS_PER_STAGE];
+        float32_t  freq =
+            mains_hz * (float32_t)(stage - set->lpf_stages + 1U);
+
+        if (freq < nyquist)
+        {
+            adc_filter_design_notch(notch, set, freq);
+        }
+        else
+        {
+            /* Harmonic above Nyquist: pass-through stage */
+            notch[0] = 1.0f;
+            notch[1] = 0.0f;
+            notch[2] = 0.0f;
+            notch[3] = 0.0f;
+            notch[4] = 0.0f;
+        }
+    }
+
+#if ((ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_Q31) || \
+     (ADC_FILTER_BACKEND == ADC_FILTER_BACKEND_DF1_FAST_Q15))
+    adc_filter_quantize_bank(coeffs, ADC_FILTER_BACKEND_TRACKING(ctx, next),
+                             set->num_stages);
+#endif
+    ctx->tracking_base[next] = base_bank;
+
+    /* Publish only once the whole buffer is written */
+    atomic_thread_fence(memory_order_release);
+    ctx->tracking_index = next;
+    ctx->tracking_hz    = mains_hz;
+
+    return true;
+}
+
+float32_t adc_filter_get_tracking_frequency(const adc_filter_context_t *ctx)
+{
+    if (ctx == NULL)
+    {
+        return 0.0f;
+    }
+
+    return ctx->tracking_hz;
+}
+
 bool adc_filter_is_initialized(const adc_filter_context_t *ctx, uint8_t channel)
 {
-    if ((ctx == NULL) || (channel >= ADC_FILTER_NUM_CHANNELS))
+    if ((ctx == NULL) || (channel >= ctx->num_channels))
     {
         return false;
     }
@@ -149,6 +1020,22 @@ bool adc_filter_is_initialized(const adc_filter_context_t *ctx, uint8_t channel)
     return ctx->channels[channel].initialized;
 }
 
-uint32_t adc_filter_get_num_stages(void) { return ADC_FILTER_NUM_STAGES; }
+uint32_t adc_filter_get_num_stages(const adc_filter_context_t *ctx)
+{
+    if (ctx == NULL)
+    {
+        return 0U;
+    }
+
+    return ctx->coeffs->num_stages;
+}
+
+uint32_t adc_filter_get_sample_rate(const adc_filter_context_t *ctx)
+{
+    if (ctx == NULL)
+    {
+        return 0U;
+    }
 
-uint32_t adc_filter_get_sample_rate(void) { return ADC_FILTER_SAMPLE_RATE; }
+    return ctx->coeffs->sample_rate;
+}
@@ -12,85 +12,5509 @@
  *   - Notch Frequencies: 50, 100, 150, 200, 250, 300, 350, 400, 450, 500 Hz
  *   - Notch Q Factor: 10
  *   - Total Biquad Stages: 12
+ *   - Cost: 66 MACs/sample
+ *
+ * Coefficient Banks:
+ *   - Bank 0: 50 Hz mains notches, 500 Hz LPF
+ *   - Bank 1: 60 Hz mains notches, 500 Hz LPF
+ *   - Bank 2: 50 Hz mains notches, 250 Hz LPF
+ *   - Bank 3: 60 Hz mains notches, 250 Hz LPF
+ *
+ * Sample Rates (each with all of the banks):
+ *   - Set 0: 1000 Hz
+ *   - Set 1: 5000 Hz
+ *   - Set 2: 10000 Hz
+ *   - Set 3: 25000 Hz
+ *   - Set 4: 50000 Hz
+ *
+ * Slow Channels: 10 Hz, 4th order Butterworth LPF at 1 Hz
  */
 
 #include "adc_filter_coefficients.h"
 
 /**
- * Filter coefficients in CMSIS-DSP format.
+ * Sample rate of each set (Hz).
+ */
+const uint32_t adc_filter_sample_rates[ADC_FILTER_NUM_RATES] = {
+    1000U,
+    5000U,
+    10000U,
+    25000U,
+    50000U,
+};
+
+/**
+ * Filter coefficient banks of each sample rate in CMSIS-DSP format.
+ * Each stage has 5 coefficients: {b0, b1, b2, -a1, -a2}
+ */
+const float32_t adc_filter_coefficients[ADC_FILTER_NUM_RATES]
+                                       [ADC_FILTER_NUM_BANKS]
+                                       [ADC_FILTER_TOTAL_COEFFS] ADC_FILTER_FASTDATA = {
+    /* Set 0: 1000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2.598915324741450e-01f,
+            5.197830649482900e-01f,
+            2.598915324741450e-01f,
+            1.387778780781446e-16f,
+            -3.956612989658004e-02f,
+            /* LPF Stage 2 */
+            3.616156730429223e-01f,
+            7.232313460858446e-01f,
+            3.616156730429223e-01f,
+            1.110223024625157e-16f,
+            -4.464626921716894e-01f,
+            /* Notch 50Hz */
+            9.868127002744672e-01f,
+            -1.877029297917697e+00f,
+            9.868127002744672e-01f,
+            1.872234710942891e+00f,
+            -9.688308135741293e-01f,
+            /* Notch 100Hz */
+            9.711679694418589e-01f,
+            -1.571382783342147e+00f,
+            9.711679694418589e-01f,
+            1.567201951826742e+00f,
+            -9.381551073683130e-01f,
+            /* Notch 150Hz */
+            9.555696831488374e-01f,
+            -1.123339534585356e+00f,
+            9.555696831488374e-01f,
+            1.120173049670233e+00f,
+            -9.079728813825514e-01f,
+            /* Notch 200Hz */
+            9.400248320624967e-01f,
+            -5.809672964835348e-01f,
+            9.400248320624967e-01f,
+            5.792017679753856e-01f,
+            -8.782841356168440e-01f,
+            /* Notch 250Hz */
+            9.245444350355956e-01f,
+            -1.132240383035840e-16f,
+            9.245444350355956e-01f,
+            1.128463264461264e-16f,
+            -8.490888700711912e-01f,
+            /* Notch 300Hz */
+            9.091450884754365e-01f,
+            5.618825653828500e-01f,
+            9.091450884754365e-01f,
+            -5.597856575881307e-01f,
+            -8.203870847455927e-01f,
+            /* Notch 350Hz */
+            8.938515306123426e-01f,
+            1.050785494865978e+00f,
+            8.938515306123426e-01f,
+            -1.046309776450614e+00f,
+            -7.921787796400489e-01f,
+            /* Notch 400Hz */
+            8.787009203609810e-01f,
+            1.421767955089882e+00f,
+            8.787009203609810e-01f,
+            -1.414705841057284e+00f,
+            -7.644639547545596e-01f,
+            /* Notch 450Hz */
+            8.637501578510947e-01f,
+            1.642950432150502e+00f,
+            8.637501578510947e-01f,
+            -1.633208137763567e+00f,
+            -7.372426100891246e-01f,
+            /* Pass-through (500Hz at or above Nyquist) */
+            1.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+        },
+        /* Bank 1: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2.598915324741450e-01f,
+            5.197830649482900e-01f,
+            2.598915324741450e-01f,
+            1.387778780781446e-16f,
+            -3.956612989658004e-02f,
+            /* LPF Stage 2 */
+            3.616156730429223e-01f,
+            7.232313460858446e-01f,
+            3.616156730429223e-01f,
+            1.110223024625157e-16f,
+            -4.464626921716894e-01f,
+            /* Notch 60Hz */
+            9.836802644878608e-01f,
+            -1.829205559106298e+00f,
+            9.836802644878608e-01f,
+            1.824501224045938e+00f,
+            -9.626561939153616e-01f,
+            /* Notch 120Hz */
+            9.649227673516360e-01f,
+            -1.406796850567984e+00f,
+            9.649227673516360e-01f,
+            1.402974315212314e+00f,
+            -9.260229993476019e-01f,
+            /* Notch 180Hz */
+            9.462357597028890e-01f,
+            -8.057751828396688e-01f,
+            9.462357597028890e-01f,
+            8.034040797306113e-01f,
+            -8.901004162967203e-01f,
+            /* Notch 240Hz */
+            9.276346586381745e-01f,
+            -1.164933242985768e-01f,
+            9.276346586381745e-01f,
+            1.161124517849449e-01f,
+            -8.548884447627174e-01f,
+            /* Notch 300Hz */
+            9.091450884754365e-01f,
+            5.618825653828500e-01f,
+            9.091450884754365e-01f,
+            -5.597856575881307e-01f,
+            -8.203870847455927e-01f,
+            /* Notch 360Hz */
+            8.908084968586801e-01f,
+            1.135645412339386e+00f,
+            8.908084968586801e-01f,
+            -1.130666069811400e+00f,
+            -7.865963362453468e-01f,
+            /* Notch 420Hz */
+            8.726925372600818e-01f,
+            1.529492600050876e+00f,
+            8.726925372600818e-01f,
+            -1.521361475309060e+00f,
+            -7.535161992619790e-01f,
+            /* Notch 480Hz */
+            8.549109470174571e-01f,
+            1.696339437701404e+00f,
+            8.549109470174571e-01f,
+            -1.685014657940828e+00f,
+            -7.211466737954898e-01f,
+            /* Pass-through (540Hz at or above Nyquist) */
+            1.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            /* Pass-through (600Hz at or above Nyquist) */
+            1.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2.598915324741450e-01f,
+            5.197830649482900e-01f,
+            2.598915324741450e-01f,
+            1.387778780781446e-16f,
+            -3.956612989658004e-02f,
+            /* LPF Stage 2 */
+            3.616156730429223e-01f,
+            7.232313460858446e-01f,
+            3.616156730429223e-01f,
+            1.110223024625157e-16f,
+            -4.464626921716894e-01f,
+            /* Notch 50Hz */
+            9.868127002744672e-01f,
+            -1.877029297917697e+00f,
+            9.868127002744672e-01f,
+            1.872234710942891e+00f,
+            -9.688308135741293e-01f,
+            /* Notch 100Hz */
+            9.711679694418589e-01f,
+            -1.571382783342147e+00f,
+            9.711679694418589e-01f,
+            1.567201951826742e+00f,
+            -9.381551073683130e-01f,
+            /* Notch 150Hz */
+            9.555696831488374e-01f,
+            -1.123339534585356e+00f,
+            9.555696831488374e-01f,
+            1.120173049670233e+00f,
+            -9.079728813825514e-01f,
+            /* Notch 200Hz */
+            9.400248320624967e-01f,
+            -5.809672964835348e-01f,
+            9.400248320624967e-01f,
+            5.792017679753856e-01f,
+            -8.782841356168440e-01f,
+            /* Notch 250Hz */
+            9.245444350355956e-01f,
+            -1.132240383035840e-16f,
+            9.245444350355956e-01f,
+            1.128463264461264e-16f,
+            -8.490888700711912e-01f,
+            /* Notch 300Hz */
+            9.091450884754365e-01f,
+            5.618825653828500e-01f,
+            9.091450884754365e-01f,
+            -5.597856575881307e-01f,
+            -8.203870847455927e-01f,
+            /* Notch 350Hz */
+            8.938515306123426e-01f,
+            1.050785494865978e+00f,
+            8.938515306123426e-01f,
+            -1.046309776450614e+00f,
+            -7.921787796400489e-01f,
+            /* Notch 400Hz */
+            8.787009203609810e-01f,
+            1.421767955089882e+00f,
+            8.787009203609810e-01f,
+            -1.414705841057284e+00f,
+            -7.644639547545596e-01f,
+            /* Notch 450Hz */
+            8.637501578510947e-01f,
+            1.642950432150502e+00f,
+            8.637501578510947e-01f,
+            -1.633208137763567e+00f,
+            -7.372426100891246e-01f,
+            /* Pass-through (500Hz at or above Nyquist) */
+            1.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2.598915324741450e-01f,
+            5.197830649482900e-01f,
+            2.598915324741450e-01f,
+            1.387778780781446e-16f,
+            -3.956612989658004e-02f,
+            /* LPF Stage 2 */
+            3.616156730429223e-01f,
+            7.232313460858446e-01f,
+            3.616156730429223e-01f,
+            1.110223024625157e-16f,
+            -4.464626921716894e-01f,
+            /* Notch 60Hz */
+            9.836802644878608e-01f,
+            -1.829205559106298e+00f,
+            9.836802644878608e-01f,
+            1.824501224045938e+00f,
+            -9.626561939153616e-01f,
+            /* Notch 120Hz */
+            9.649227673516360e-01f,
+            -1.406796850567984e+00f,
+            9.649227673516360e-01f,
+            1.402974315212314e+00f,
+            -9.260229993476019e-01f,
+            /* Notch 180Hz */
+            9.462357597028890e-01f,
+            -8.057751828396688e-01f,
+            9.462357597028890e-01f,
+            8.034040797306113e-01f,
+            -8.901004162967203e-01f,
+            /* Notch 240Hz */
+            9.276346586381745e-01f,
+            -1.164933242985768e-01f,
+            9.276346586381745e-01f,
+            1.161124517849449e-01f,
+            -8.548884447627174e-01f,
+            /* Notch 300Hz */
+            9.091450884754365e-01f,
+            5.618825653828500e-01f,
+            9.091450884754365e-01f,
+            -5.597856575881307e-01f,
+            -8.203870847455927e-01f,
+            /* Notch 360Hz */
+            8.908084968586801e-01f,
+            1.135645412339386e+00f,
+            8.908084968586801e-01f,
+            -1.130666069811400e+00f,
+            -7.865963362453468e-01f,
+            /* Notch 420Hz */
+            8.726925372600818e-01f,
+            1.529492600050876e+00f,
+            8.726925372600818e-01f,
+            -1.521361475309060e+00f,
+            -7.535161992619790e-01f,
+            /* Notch 480Hz */
+            8.549109470174571e-01f,
+            1.696339437701404e+00f,
+            8.549109470174571e-01f,
+            -1.685014657940828e+00f,
+            -7.211466737954898e-01f,
+            /* Pass-through (540Hz at or above Nyquist) */
+            1.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            /* Pass-through (600Hz at or above Nyquist) */
+            1.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+            0.000000000000000e+00f,
+        },
+    },
+    /* Set 1: 5000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            6.188519529976447e-02f,
+            1.237703905995289e-01f,
+            6.188519529976447e-02f,
+            1.048599576362612e+00f,
+            -2.961403575616696e-01f,
+            /* LPF Stage 2 */
+            7.795634051646255e-02f,
+            1.559126810329251e-01f,
+            7.795634051646255e-02f,
+            1.320913430819426e+00f,
+            -6.327387928852763e-01f,
+            /* Notch 50Hz */
+            9.993592299758098e-01f,
+            -1.994774445634708e+00f,
+            9.993592299758098e-01f,
+            1.989782669980310e+00f,
+            -9.937266842972214e-01f,
+            /* Notch 100Hz */
+            9.962201071601580e-01f,
+            -1.976729228117355e+00f,
+            9.962201071601580e-01f,
+            1.971762121600284e+00f,
+            -9.874731078032450e-01f,
+            /* Notch 150Hz */
+            9.930826374113232e-01f,
+            -1.950984827298328e+00f,
+            9.930826374113232e-01f,
+            1.946058822993753e+00f,
+            -9.812392705180711e-01f,
+            /* Notch 200Hz */
+            9.899468305237930e-01f,
+            -1.917691660916009e+00f,
+            9.899468305237930e-01f,
+            1.912823172310122e+00f,
+            -9.750251724416991e-01f,
+            /* Notch 250Hz */
+            9.868127002744672e-01f,
+            -1.877029297917697e+00f,
+            9.868127002744672e-01f,
+            1.872234710942891e+00f,
+            -9.688308135741293e-01f,
+            /* Notch 300Hz */
+            9.836802644878608e-01f,
+            -1.829205559106298e+00f,
+            9.836802644878608e-01f,
+            1.824501224045938e+00f,
+            -9.626561939153616e-01f,
+            /* Notch 350Hz */
+            9.805495451208435e-01f,
+            -1.774455509417178e+00f,
+            9.805495451208435e-01f,
+            1.769857732640888e+00f,
+            -9.565013134653964e-01f,
+            /* Notch 400Hz */
+            9.774205683675221e-01f,
+            -1.713040346545459e+00f,
+            9.774205683675221e-01f,
+            1.708565382034648e+00f,
+            -9.503661722242330e-01f,
+            /* Notch 450Hz */
+            9.742933647851195e-01f,
+            -1.645246191038796e+00f,
+            9.742933647851195e-01f,
+            1.640910231660429e+00f,
+            -9.442507701918720e-01f,
+            /* Notch 500Hz */
+            9.711679694418589e-01f,
+            -1.571382783342147e+00f,
+            9.711679694418589e-01f,
+            1.567201951826742e+00f,
+            -9.381551073683130e-01f,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            6.188519529976447e-02f,
+            1.237703905995289e-01f,
+            6.188519529976447e-02f,
+            1.048599576362612e+00f,
+            -2.961403575616696e-01f,
+            /* LPF Stage 2 */
+            7.795634051646255e-02f,
+            1.559126810329251e-01f,
+            7.795634051646255e-02f,
+            1.320913430819426e+00f,
+            -6.327387928852763e-01f,
+            /* Notch 60Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+            /* Notch 120Hz */
+            9.949649204326959e-01f,
+            -1.967347609077609e+00f,
+            9.949649204326959e-01f,
+            1.962394972396337e+00f,
+            -9.849772041841193e-01f,
+            /* Notch 180Hz */
+            9.912009529436046e-01f,
+            -1.931903929950412e+00f,
+            9.912009529436046e-01f,
+            1.927010467030395e+00f,
+            -9.775084429671915e-01f,
+            /* Notch 240Hz */
+            9.874393913966097e-01f,
+            -1.885741729861652e+00f,
+            9.874393913966097e-01f,
+            1.880931053279371e+00f,
+            -9.700681062109391e-01f,
+            /* Notch 300Hz */
+            9.836802644878608e-01f,
+            -1.829205559106298e+00f,
+            9.836802644878608e-01f,
+            1.824501224045938e+00f,
+            -9.626561939153616e-01f,
+            /* Notch 360Hz */
+            9.799236094469524e-01f,
+            -1.762696880940925e+00f,
+            9.799236094469524e-01f,
+            1.758122368127480e+00f,
+            -9.552727060804594e-01f,
+            /* Notch 420Hz */
+            9.761694722930052e-01f,
+            -1.686671332525399e+00f,
+            9.761694722930052e-01f,
+            1.682250030645621e+00f,
+            -9.479176427062322e-01f,
+            /* Notch 480Hz */
+            9.724179081534861e-01f,
+            -1.601635691764084e+00f,
+            9.724179081534861e-01f,
+            1.597390879249792e+00f,
+            -9.405910037926803e-01f,
+            /* Notch 540Hz */
+            9.686689816494465e-01f,
+            -1.508144569822826e+00f,
+            9.686689816494465e-01f,
+            1.504099395863736e+00f,
+            -9.332927893398034e-01f,
+            /* Notch 600Hz */
+            9.649227673516360e-01f,
+            -1.406796850567984e+00f,
+            9.649227673516360e-01f,
+            1.402974315212314e+00f,
+            -9.260229993476019e-01f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            1.903683158782385e-02f,
+            3.807366317564770e-02f,
+            1.903683158782385e-02f,
+            1.479674216931193e+00f,
+            -5.558215432824888e-01f,
+            /* LPF Stage 2 */
+            2.188385196794301e-02f,
+            4.376770393588603e-02f,
+            2.188385196794301e-02f,
+            1.700964331943526e+00f,
+            -7.884997398152980e-01f,
+            /* Notch 50Hz */
+            9.993592299758098e-01f,
+            -1.994774445634708e+00f,
+            9.993592299758098e-01f,
+            1.989782669980310e+00f,
+            -9.937266842972214e-01f,
+            /* Notch 100Hz */
+            9.962201071601580e-01f,
+            -1.976729228117355e+00f,
+            9.962201071601580e-01f,
+            1.971762121600284e+00f,
+            -9.874731078032450e-01f,
+            /* Notch 150Hz */
+            9.930826374113232e-01f,
+            -1.950984827298328e+00f,
+            9.930826374113232e-01f,
+            1.946058822993753e+00f,
+            -9.812392705180711e-01f,
+            /* Notch 200Hz */
+            9.899468305237930e-01f,
+            -1.917691660916009e+00f,
+            9.899468305237930e-01f,
+            1.912823172310122e+00f,
+            -9.750251724416991e-01f,
+            /* Notch 250Hz */
+            9.868127002744672e-01f,
+            -1.877029297917697e+00f,
+            9.868127002744672e-01f,
+            1.872234710942891e+00f,
+            -9.688308135741293e-01f,
+            /* Notch 300Hz */
+            9.836802644878608e-01f,
+            -1.829205559106298e+00f,
+            9.836802644878608e-01f,
+            1.824501224045938e+00f,
+            -9.626561939153616e-01f,
+            /* Notch 350Hz */
+            9.805495451208435e-01f,
+            -1.774455509417178e+00f,
+            9.805495451208435e-01f,
+            1.769857732640888e+00f,
+            -9.565013134653964e-01f,
+            /* Notch 400Hz */
+            9.774205683675221e-01f,
+            -1.713040346545459e+00f,
+            9.774205683675221e-01f,
+            1.708565382034648e+00f,
+            -9.503661722242330e-01f,
+            /* Notch 450Hz */
+            9.742933647851195e-01f,
+            -1.645246191038796e+00f,
+            9.742933647851195e-01f,
+            1.640910231660429e+00f,
+            -9.442507701918720e-01f,
+            /* Notch 500Hz */
+            9.711679694418589e-01f,
+            -1.571382783342147e+00f,
+            9.711679694418589e-01f,
+            1.567201951826742e+00f,
+            -9.381551073683130e-01f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            1.903683158782385e-02f,
+            3.807366317564770e-02f,
+            1.903683158782385e-02f,
+            1.479674216931193e+00f,
+            -5.558215432824888e-01f,
+            /* LPF Stage 2 */
+            2.188385196794301e-02f,
+            4.376770393588603e-02f,
+            2.188385196794301e-02f,
+            1.700964331943526e+00f,
+            -7.884997398152980e-01f,
+            /* Notch 60Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+            /* Notch 120Hz */
+            9.949649204326959e-01f,
+            -1.967347609077609e+00f,
+            9.949649204326959e-01f,
+            1.962394972396337e+00f,
+            -9.849772041841193e-01f,
+            /* Notch 180Hz */
+            9.912009529436046e-01f,
+            -1.931903929950412e+00f,
+            9.912009529436046e-01f,
+            1.927010467030395e+00f,
+            -9.775084429671915e-01f,
+            /* Notch 240Hz */
+            9.874393913966097e-01f,
+            -1.885741729861652e+00f,
+            9.874393913966097e-01f,
+            1.880931053279371e+00f,
+            -9.700681062109391e-01f,
+            /* Notch 300Hz */
+            9.836802644878608e-01f,
+            -1.829205559106298e+00f,
+            9.836802644878608e-01f,
+            1.824501224045938e+00f,
+            -9.626561939153616e-01f,
+            /* Notch 360Hz */
+            9.799236094469524e-01f,
+            -1.762696880940925e+00f,
+            9.799236094469524e-01f,
+            1.758122368127480e+00f,
+            -9.552727060804594e-01f,
+            /* Notch 420Hz */
+            9.761694722930052e-01f,
+            -1.686671332525399e+00f,
+            9.761694722930052e-01f,
+            1.682250030645621e+00f,
+            -9.479176427062322e-01f,
+            /* Notch 480Hz */
+            9.724179081534861e-01f,
+            -1.601635691764084e+00f,
+            9.724179081534861e-01f,
+            1.597390879249792e+00f,
+            -9.405910037926803e-01f,
+            /* Notch 540Hz */
+            9.686689816494465e-01f,
+            -1.508144569822826e+00f,
+            9.686689816494465e-01f,
+            1.504099395863736e+00f,
+            -9.332927893398034e-01f,
+            /* Notch 600Hz */
+            9.649227673516360e-01f,
+            -1.406796850567984e+00f,
+            9.649227673516360e-01f,
+            1.402974315212314e+00f,
+            -9.260229993476019e-01f,
+        },
+    },
+    /* Set 2: 10000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            1.903683158782385e-02f,
+            3.807366317564770e-02f,
+            1.903683158782385e-02f,
+            1.479674216931193e+00f,
+            -5.558215432824888e-01f,
+            /* LPF Stage 2 */
+            2.188385196794301e-02f,
+            4.376770393588603e-02f,
+            2.188385196794301e-02f,
+            1.700964331943526e+00f,
+            -7.884997398152980e-01f,
+            /* Notch 50Hz */
+            1.000929409300205e+00f,
+            -2.000871022117102e+00f,
+            1.000929409300205e+00f,
+            1.995873078264203e+00f,
+            -9.968608747475105e-01f,
+            /* Notch 100Hz */
+            9.993592299758098e-01f,
+            -1.994774445634708e+00f,
+            9.993592299758098e-01f,
+            1.989782669980310e+00f,
+            -9.937266842972214e-01f,
+            /* Notch 150Hz */
+            9.977894623926329e-01f,
+            -1.986722474879721e+00f,
+            9.977894623926329e-01f,
+            1.981740978743588e+00f,
+            -9.905974286491330e-01f,
+            /* Notch 200Hz */
+            9.962201071601580e-01f,
+            -1.976729228117355e+00f,
+            9.962201071601580e-01f,
+            1.971762121600284e+00f,
+            -9.874731078032450e-01f,
+            /* Notch 250Hz */
+            9.946511651329361e-01f,
+            -1.964810717522340e+00f,
+            9.946511651329361e-01f,
+            1.959862109016026e+00f,
+            -9.843537217595579e-01f,
+            /* Notch 300Hz */
+            9.930826374113232e-01f,
+            -1.950984827298328e+00f,
+            9.930826374113232e-01f,
+            1.946058822993753e+00f,
+            -9.812392705180711e-01f,
+            /* Notch 350Hz */
+            9.915145253428467e-01f,
+            -1.935271289975650e+00f,
+            9.915145253428467e-01f,
+            1.930371993368742e+00f,
+            -9.781297540787848e-01f,
+            /* Notch 400Hz */
+            9.899468305237930e-01f,
+            -1.917691660916009e+00f,
+            9.899468305237930e-01f,
+            1.912823172310122e+00f,
+            -9.750251724416991e-01f,
+            /* Notch 450Hz */
+            9.883795548010862e-01f,
+            -1.898269291055342e+00f,
+            9.883795548010862e-01f,
+            1.893435707059984e+00f,
+            -9.719255256068139e-01f,
+            /* Notch 500Hz */
+            9.868127002744672e-01f,
+            -1.877029297917697e+00f,
+            9.868127002744672e-01f,
+            1.872234710942891e+00f,
+            -9.688308135741293e-01f,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            1.903683158782385e-02f,
+            3.807366317564770e-02f,
+            1.903683158782385e-02f,
+            1.479674216931193e+00f,
+            -5.558215432824888e-01f,
+            /* LPF Stage 2 */
+            2.188385196794301e-02f,
+            4.376770393588603e-02f,
+            2.188385196794301e-02f,
+            1.700964331943526e+00f,
+            -7.884997398152980e-01f,
+            /* Notch 60Hz */
+            1.000615340516927e+00f,
+            -1.999808751882487e+00f,
+            1.000615340516927e+00f,
+            1.994811712721910e+00f,
+            -9.962336418732767e-01f,
+            /* Notch 120Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+            /* Notch 180Hz */
+            9.968477997218724e-01f,
+            -1.980958497341273e+00f,
+            9.968477997218724e-01f,
+            1.975985141862864e+00f,
+            -9.887222439653363e-01f,
+            /* Notch 240Hz */
+            9.949649204326959e-01f,
+            -1.967347609077609e+00f,
+            9.949649204326959e-01f,
+            1.962394972396337e+00f,
+            -9.849772041841193e-01f,
+            /* Notch 300Hz */
+            9.930826374113232e-01f,
+            -1.950984827298328e+00f,
+            9.930826374113232e-01f,
+            1.946058822993753e+00f,
+            -9.812392705180711e-01f,
+            /* Notch 360Hz */
+            9.912009529436046e-01f,
+            -1.931903929950412e+00f,
+            9.912009529436046e-01f,
+            1.927010467030395e+00f,
+            -9.775084429671915e-01f,
+            /* Notch 420Hz */
+            9.893198698312532e-01f,
+            -1.910142474536033e+00f,
+            9.893198698312532e-01f,
+            1.905287456405007e+00f,
+            -9.737847215314809e-01f,
+            /* Notch 480Hz */
+            9.874393913966097e-01f,
+            -1.885741729861652e+00f,
+            9.874393913966097e-01f,
+            1.880931053279371e+00f,
+            -9.700681062109391e-01f,
+            /* Notch 540Hz */
+            9.855595214883082e-01f,
+            -1.858746602645150e+00f,
+            9.855595214883082e-01f,
+            1.853986156674099e+00f,
+            -9.663585970055660e-01f,
+            /* Notch 600Hz */
+            9.836802644878608e-01f,
+            -1.829205559106298e+00f,
+            9.836802644878608e-01f,
+            1.824501224045938e+00f,
+            -9.626561939153616e-01f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            5.378494217712609e-03f,
+            1.075698843542522e-02f,
+            5.378494217712609e-03f,
+            1.725933395036941e+00f,
+            -7.474473719077911e-01f,
+            /* LPF Stage 2 */
+            5.808126894364884e-03f,
+            1.161625378872977e-02f,
+            5.808126894364884e-03f,
+            1.863800492075235e+00f,
+            -8.870329996526944e-01f,
+            /* Notch 50Hz */
+            1.000929409300205e+00f,
+            -2.000871022117102e+00f,
+            1.000929409300205e+00f,
+            1.995873078264203e+00f,
+            -9.968608747475105e-01f,
+            /* Notch 100Hz */
+            9.993592299758098e-01f,
+            -1.994774445634708e+00f,
+            9.993592299758098e-01f,
+            1.989782669980310e+00f,
+            -9.937266842972214e-01f,
+            /* Notch 150Hz */
+            9.977894623926329e-01f,
+            -1.986722474879721e+00f,
+            9.977894623926329e-01f,
+            1.981740978743588e+00f,
+            -9.905974286491330e-01f,
+            /* Notch 200Hz */
+            9.962201071601580e-01f,
+            -1.976729228117355e+00f,
+            9.962201071601580e-01f,
+            1.971762121600284e+00f,
+            -9.874731078032450e-01f,
+            /* Notch 250Hz */
+            9.946511651329361e-01f,
+            -1.964810717522340e+00f,
+            9.946511651329361e-01f,
+            1.959862109016026e+00f,
+            -9.843537217595579e-01f,
+            /* Notch 300Hz */
+            9.930826374113232e-01f,
+            -1.950984827298328e+00f,
+            9.930826374113232e-01f,
+            1.946058822993753e+00f,
+            -9.812392705180711e-01f,
+            /* Notch 350Hz */
+            9.915145253428467e-01f,
+            -1.935271289975650e+00f,
+            9.915145253428467e-01f,
+            1.930371993368742e+00f,
+            -9.781297540787848e-01f,
+            /* Notch 400Hz */
+            9.899468305237930e-01f,
+            -1.917691660916009e+00f,
+            9.899468305237930e-01f,
+            1.912823172310122e+00f,
+            -9.750251724416991e-01f,
+            /* Notch 450Hz */
+            9.883795548010862e-01f,
+            -1.898269291055342e+00f,
+            9.883795548010862e-01f,
+            1.893435707059984e+00f,
+            -9.719255256068139e-01f,
+            /* Notch 500Hz */
+            9.868127002744672e-01f,
+            -1.877029297917697e+00f,
+            9.868127002744672e-01f,
+            1.872234710942891e+00f,
+            -9.688308135741293e-01f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            5.378494217712609e-03f,
+            1.075698843542522e-02f,
+            5.378494217712609e-03f,
+            1.725933395036941e+00f,
+            -7.474473719077911e-01f,
+            /* LPF Stage 2 */
+            5.808126894364884e-03f,
+            1.161625378872977e-02f,
+            5.808126894364884e-03f,
+            1.863800492075235e+00f,
+            -8.870329996526944e-01f,
+            /* Notch 60Hz */
+            1.000615340516927e+00f,
+            -1.999808751882487e+00f,
+            1.000615340516927e+00f,
+            1.994811712721910e+00f,
+            -9.962336418732767e-01f,
+            /* Notch 120Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+            /* Notch 180Hz */
+            9.968477997218724e-01f,
+            -1.980958497341273e+00f,
+            9.968477997218724e-01f,
+            1.975985141862864e+00f,
+            -9.887222439653363e-01f,
+            /* Notch 240Hz */
+            9.949649204326959e-01f,
+            -1.967347609077609e+00f,
+            9.949649204326959e-01f,
+            1.962394972396337e+00f,
+            -9.849772041841193e-01f,
+            /* Notch 300Hz */
+            9.930826374113232e-01f,
+            -1.950984827298328e+00f,
+            9.930826374113232e-01f,
+            1.946058822993753e+00f,
+            -9.812392705180711e-01f,
+            /* Notch 360Hz */
+            9.912009529436046e-01f,
+            -1.931903929950412e+00f,
+            9.912009529436046e-01f,
+            1.927010467030395e+00f,
+            -9.775084429671915e-01f,
+            /* Notch 420Hz */
+            9.893198698312532e-01f,
+            -1.910142474536033e+00f,
+            9.893198698312532e-01f,
+            1.905287456405007e+00f,
+            -9.737847215314809e-01f,
+            /* Notch 480Hz */
+            9.874393913966097e-01f,
+            -1.885741729861652e+00f,
+            9.874393913966097e-01f,
+            1.880931053279371e+00f,
+            -9.700681062109391e-01f,
+            /* Notch 540Hz */
+            9.855595214883082e-01f,
+            -1.858746602645150e+00f,
+            9.855595214883082e-01f,
+            1.853986156674099e+00f,
+            -9.663585970055660e-01f,
+            /* Notch 600Hz */
+            9.836802644878608e-01f,
+            -1.829205559106298e+00f,
+            9.836802644878608e-01f,
+            1.824501224045938e+00f,
+            -9.626561939153616e-01f,
+        },
+    },
+    /* Set 3: 25000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            3.533495923377983e-03f,
+            7.066991846755966e-03f,
+            3.533495923377983e-03f,
+            1.778313488139435e+00f,
+            -7.924474718329471e-01f,
+            /* LPF Stage 2 */
+            3.762202981698714e-03f,
+            7.524405963397428e-03f,
+            3.762202981698714e-03f,
+            1.893415601022501e+00f,
+            -9.084644129492954e-01f,
+            /* Notch 50Hz */
+            1.005332657311179e+00f,
+            -2.010506560941583e+00f,
+            1.005332657311179e+00f,
+            1.997842246319225e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 100Hz */
+            1.001243494537562e+00f,
+            -2.001854582223922e+00f,
+            1.001243494537562e+00f,
+            1.996855898162630e+00f,
+            -9.974883050138322e-01f,
+            /* Notch 150Hz */
+            1.000615340516927e+00f,
+            -1.999808751882487e+00f,
+            1.000615340516927e+00f,
+            1.994811712721910e+00f,
+            -9.962336418732767e-01f,
+            /* Notch 200Hz */
+            9.999872523224964e-01f,
+            -1.997448450058767e+00f,
+            9.999872523224964e-01f,
+            1.992453713714848e+00f,
+            -9.949797683010730e-01f,
+            /* Notch 250Hz */
+            9.993592299758098e-01f,
+            -1.994774445634708e+00f,
+            9.993592299758098e-01f,
+            1.989782669980310e+00f,
+            -9.937266842972214e-01f,
+            /* Notch 300Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+            /* Notch 350Hz */
+            9.981033829442423e-01f,
+            -1.988488650300516e+00f,
+            9.981033829442423e-01f,
+            1.983504769406606e+00f,
+            -9.912228849945748e-01f,
+            /* Notch 400Hz */
+            9.974755583342499e-01f,
+            -1.984878642357304e+00f,
+            9.974755583342499e-01f,
+            1.979899695384584e+00f,
+            -9.899721696957795e-01f,
+            /* Notch 450Hz */
+            9.968477997218724e-01f,
+            -1.980958497341273e+00f,
+            9.968477997218724e-01f,
+            1.975985141862864e+00f,
+            -9.887222439653363e-01f,
+            /* Notch 500Hz */
+            9.962201071601580e-01f,
+            -1.976729228117355e+00f,
+            9.962201071601580e-01f,
+            1.971762121600284e+00f,
+            -9.874731078032450e-01f,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            3.533495923377983e-03f,
+            7.066991846755966e-03f,
+            3.533495923377983e-03f,
+            1.778313488139435e+00f,
+            -7.924474718329471e-01f,
+            /* LPF Stage 2 */
+            3.762202981698714e-03f,
+            7.524405963397428e-03f,
+            3.762202981698714e-03f,
+            1.893415601022501e+00f,
+            -9.084644129492954e-01f,
+            /* Notch 60Hz */
+            1.003397704152095e+00f,
+            -2.006567244319199e+00f,
+            1.003397704152095e+00f,
+            1.997772836015009e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 120Hz */
+            1.000992225031392e+00f,
+            -2.001074033821795e+00f,
+            1.000992225031392e+00f,
+            1.996075928768419e+00f,
+            -9.969863450094077e-01f,
+            /* Notch 180Hz */
+            1.000238479699944e+00f,
+            -1.998430259261792e+00f,
+            1.000238479699944e+00f,
+            1.993434522843656e+00f,
+            -9.954812229817522e-01f,
+            /* Notch 240Hz */
+            9.994848291761036e-01f,
+            -1.995334304166767e+00f,
+            9.994848291761036e-01f,
+            1.990341883747084e+00f,
+            -9.939772379325237e-01f,
+            /* Notch 300Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+            /* Notch 360Hz */
+            9.979778127447796e-01f,
+            -1.987791506671339e+00f,
+            9.979778127447796e-01f,
+            1.982808559951127e+00f,
+            -9.909726787693475e-01f,
+            /* Notch 420Hz */
+            9.972244469667507e-01f,
+            -1.983347745160597e+00f,
+            9.972244469667507e-01f,
+            1.978370955882496e+00f,
+            -9.894721046553999e-01f,
+            /* Notch 480Hz */
+            9.964711762550971e-01f,
+            -1.978457963882386e+00f,
+            9.964711762550971e-01f,
+            1.973488278892071e+00f,
+            -9.879726675198794e-01f,
+            /* Notch 540Hz */
+            9.957180007069876e-01f,
+            -1.973123954705209e+00f,
+            9.957180007069876e-01f,
+            1.968162320654020e+00f,
+            -9.864743673627857e-01f,
+            /* Notch 600Hz */
+            9.949649204326959e-01f,
+            -1.967347609077609e+00f,
+            9.949649204326959e-01f,
+            1.962394972396337e+00f,
+            -9.849772041841193e-01f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            9.325384156294857e-04f,
+            1.865076831258971e-03f,
+            9.325384156294857e-04f,
+            1.886609582621506e+00f,
+            -8.903397362840243e-01f,
+            /* LPF Stage 2 */
+            9.634843255122704e-04f,
+            1.926968651024541e-03f,
+            9.634843255122704e-04f,
+            1.949215958025842e+00f,
+            -9.530698953278908e-01f,
+            /* Notch 50Hz */
+            1.005332657311179e+00f,
+            -2.010506560941583e+00f,
+            1.005332657311179e+00f,
+            1.997842246319225e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 100Hz */
+            1.001243494537562e+00f,
+            -2.001854582223922e+00f,
+            1.001243494537562e+00f,
+            1.996855898162630e+00f,
+            -9.974883050138322e-01f,
+            /* Notch 150Hz */
+            1.000615340516927e+00f,
+            -1.999808751882487e+00f,
+            1.000615340516927e+00f,
+            1.994811712721910e+00f,
+            -9.962336418732767e-01f,
+            /* Notch 200Hz */
+            9.999872523224964e-01f,
+            -1.997448450058767e+00f,
+            9.999872523224964e-01f,
+            1.992453713714848e+00f,
+            -9.949797683010730e-01f,
+            /* Notch 250Hz */
+            9.993592299758098e-01f,
+            -1.994774445634708e+00f,
+            9.993592299758098e-01f,
+            1.989782669980310e+00f,
+            -9.937266842972214e-01f,
+            /* Notch 300Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+            /* Notch 350Hz */
+            9.981033829442423e-01f,
+            -1.988488650300516e+00f,
+            9.981033829442423e-01f,
+            1.983504769406606e+00f,
+            -9.912228849945748e-01f,
+            /* Notch 400Hz */
+            9.974755583342499e-01f,
+            -1.984878642357304e+00f,
+            9.974755583342499e-01f,
+            1.979899695384584e+00f,
+            -9.899721696957795e-01f,
+            /* Notch 450Hz */
+            9.968477997218724e-01f,
+            -1.980958497341273e+00f,
+            9.968477997218724e-01f,
+            1.975985141862864e+00f,
+            -9.887222439653363e-01f,
+            /* Notch 500Hz */
+            9.962201071601580e-01f,
+            -1.976729228117355e+00f,
+            9.962201071601580e-01f,
+            1.971762121600284e+00f,
+            -9.874731078032450e-01f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            9.325384156294857e-04f,
+            1.865076831258971e-03f,
+            9.325384156294857e-04f,
+            1.886609582621506e+00f,
+            -8.903397362840243e-01f,
+            /* LPF Stage 2 */
+            9.634843255122704e-04f,
+            1.926968651024541e-03f,
+            9.634843255122704e-04f,
+            1.949215958025842e+00f,
+            -9.530698953278908e-01f,
+            /* Notch 60Hz */
+            1.003397704152095e+00f,
+            -2.006567244319199e+00f,
+            1.003397704152095e+00f,
+            1.997772836015009e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 120Hz */
+            1.000992225031392e+00f,
+            -2.001074033821795e+00f,
+            1.000992225031392e+00f,
+            1.996075928768419e+00f,
+            -9.969863450094077e-01f,
+            /* Notch 180Hz */
+            1.000238479699944e+00f,
+            -1.998430259261792e+00f,
+            1.000238479699944e+00f,
+            1.993434522843656e+00f,
+            -9.954812229817522e-01f,
+            /* Notch 240Hz */
+            9.994848291761036e-01f,
+            -1.995334304166767e+00f,
+            9.994848291761036e-01f,
+            1.990341883747084e+00f,
+            -9.939772379325237e-01f,
+            /* Notch 300Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+            /* Notch 360Hz */
+            9.979778127447796e-01f,
+            -1.987791506671339e+00f,
+            9.979778127447796e-01f,
+            1.982808559951127e+00f,
+            -9.909726787693475e-01f,
+            /* Notch 420Hz */
+            9.972244469667507e-01f,
+            -1.983347745160597e+00f,
+            9.972244469667507e-01f,
+            1.978370955882496e+00f,
+            -9.894721046553999e-01f,
+            /* Notch 480Hz */
+            9.964711762550971e-01f,
+            -1.978457963882386e+00f,
+            9.964711762550971e-01f,
+            1.973488278892071e+00f,
+            -9.879726675198794e-01f,
+            /* Notch 540Hz */
+            9.957180007069876e-01f,
+            -1.973123954705209e+00f,
+            9.957180007069876e-01f,
+            1.968162320654020e+00f,
+            -9.864743673627857e-01f,
+            /* Notch 600Hz */
+            9.949649204326959e-01f,
+            -1.967347609077609e+00f,
+            9.949649204326959e-01f,
+            1.962394972396337e+00f,
+            -9.849772041841193e-01f,
+        },
+    },
+    /* Set 4: 50000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            9.325384156294857e-04f,
+            1.865076831258971e-03f,
+            9.325384156294857e-04f,
+            1.886609582621506e+00f,
+            -8.903397362840243e-01f,
+            /* LPF Stage 2 */
+            9.634843255122704e-04f,
+            1.926968651024541e-03f,
+            9.634843255122704e-04f,
+            1.949215958025842e+00f,
+            -9.530698953278908e-01f,
+            /* Notch 50Hz */
+            1.024330379244179e+00f,
+            -2.048620319678920e+00f,
+            1.024330379244179e+00f,
+            1.997960561190562e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 100Hz */
+            1.005332657311179e+00f,
+            -2.010506560941583e+00f,
+            1.005332657311179e+00f,
+            1.997842246319225e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 150Hz */
+            1.001814560658407e+00f,
+            -2.003273181373671e+00f,
+            1.001814560658407e+00f,
+            1.997645060056856e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 200Hz */
+            1.001243494537562e+00f,
+            -2.001854582223922e+00f,
+            1.001243494537562e+00f,
+            1.996855898162630e+00f,
+            -9.974883050138322e-01f,
+            /* Notch 250Hz */
+            1.000929409300205e+00f,
+            -2.000871022117102e+00f,
+            1.000929409300205e+00f,
+            1.995873078264203e+00f,
+            -9.968608747475105e-01f,
+            /* Notch 300Hz */
+            1.000615340516927e+00f,
+            -1.999808751882487e+00f,
+            1.000615340516927e+00f,
+            1.994811712721910e+00f,
+            -9.962336418732767e-01f,
+            /* Notch 350Hz */
+            1.000301288190355e+00f,
+            -1.998667863006238e+00f,
+            1.000301288190355e+00f,
+            1.993671893016659e+00f,
+            -9.956066063911307e-01f,
+            /* Notch 400Hz */
+            9.999872523224964e-01f,
+            -1.997448450058767e+00f,
+            9.999872523224964e-01f,
+            1.992453713714848e+00f,
+            -9.949797683010730e-01f,
+            /* Notch 450Hz */
+            9.996732329165805e-01f,
+            -1.996150610692729e+00f,
+            9.996732329165805e-01f,
+            1.991157272462671e+00f,
+            -9.943531276031033e-01f,
+            /* Notch 500Hz */
+            9.993592299758098e-01f,
+            -1.994774445634708e+00f,
+            9.993592299758098e-01f,
+            1.989782669980310e+00f,
+            -9.937266842972214e-01f,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            9.325384156294857e-04f,
+            1.865076831258971e-03f,
+            9.325384156294857e-04f,
+            1.886609582621506e+00f,
+            -8.903397362840243e-01f,
+            /* LPF Stage 2 */
+            9.634843255122704e-04f,
+            1.926968651024541e-03f,
+            9.634843255122704e-04f,
+            1.949215958025842e+00f,
+            -9.530698953278908e-01f,
+            /* Notch 60Hz */
+            1.016590566605801e+00f,
+            -2.033123341408221e+00f,
+            1.016590566605801e+00f,
+            1.997943208196618e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 120Hz */
+            1.003397704152095e+00f,
+            -2.006567244319199e+00f,
+            1.003397704152095e+00f,
+            1.997772836015009e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 180Hz */
+            1.001369133238892e+00f,
+            -2.002225947526045e+00f,
+            1.001369133238892e+00f,
+            1.997227013438406e+00f,
+            -9.977393323901457e-01f,
+            /* Notch 240Hz */
+            1.000992225031392e+00f,
+            -2.001074033821795e+00f,
+            1.000992225031392e+00f,
+            1.996075928768419e+00f,
+            -9.969863450094077e-01f,
+            /* Notch 300Hz */
+            1.000615340516927e+00f,
+            -1.999808751882487e+00f,
+            1.000615340516927e+00f,
+            1.994811712721910e+00f,
+            -9.962336418732767e-01f,
+            /* Notch 360Hz */
+            1.000238479699944e+00f,
+            -1.998430259261792e+00f,
+            1.000238479699944e+00f,
+            1.993434522843656e+00f,
+            -9.954812229817522e-01f,
+            /* Notch 420Hz */
+            9.998616425845220e-01f,
+            -1.996938719910694e+00f,
+            9.998616425845220e-01f,
+            1.991944523076485e+00f,
+            -9.947290883348344e-01f,
+            /* Notch 480Hz */
+            9.994848291761036e-01f,
+            -1.995334304166767e+00f,
+            9.994848291761036e-01f,
+            1.990341883747084e+00f,
+            -9.939772379325237e-01f,
+            /* Notch 540Hz */
+            9.991080394805976e-01f,
+            -1.993617188737826e+00f,
+            9.991080394805976e-01f,
+            1.988626781551450e+00f,
+            -9.932256717748195e-01f,
+            /* Notch 600Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2.397619825633967e-04f,
+            4.795239651267935e-04f,
+            2.397619825633967e-04f,
+            1.942638230540114e+00f,
+            -9.435972784703673e-01f,
+            /* LPF Stage 2 */
+            2.437893768917065e-04f,
+            4.875787537834130e-04f,
+            2.437893768917065e-04f,
+            1.975269634851873e+00f,
+            -9.762447923594398e-01f,
+            /* Notch 50Hz */
+            1.024330379244179e+00f,
+            -2.048620319678920e+00f,
+            1.024330379244179e+00f,
+            1.997960561190562e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 100Hz */
+            1.005332657311179e+00f,
+            -2.010506560941583e+00f,
+            1.005332657311179e+00f,
+            1.997842246319225e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 150Hz */
+            1.001814560658407e+00f,
+            -2.003273181373671e+00f,
+            1.001814560658407e+00f,
+            1.997645060056856e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 200Hz */
+            1.001243494537562e+00f,
+            -2.001854582223922e+00f,
+            1.001243494537562e+00f,
+            1.996855898162630e+00f,
+            -9.974883050138322e-01f,
+            /* Notch 250Hz */
+            1.000929409300205e+00f,
+            -2.000871022117102e+00f,
+            1.000929409300205e+00f,
+            1.995873078264203e+00f,
+            -9.968608747475105e-01f,
+            /* Notch 300Hz */
+            1.000615340516927e+00f,
+            -1.999808751882487e+00f,
+            1.000615340516927e+00f,
+            1.994811712721910e+00f,
+            -9.962336418732767e-01f,
+            /* Notch 350Hz */
+            1.000301288190355e+00f,
+            -1.998667863006238e+00f,
+            1.000301288190355e+00f,
+            1.993671893016659e+00f,
+            -9.956066063911307e-01f,
+            /* Notch 400Hz */
+            9.999872523224964e-01f,
+            -1.997448450058767e+00f,
+            9.999872523224964e-01f,
+            1.992453713714848e+00f,
+            -9.949797683010730e-01f,
+            /* Notch 450Hz */
+            9.996732329165805e-01f,
+            -1.996150610692729e+00f,
+            9.996732329165805e-01f,
+            1.991157272462671e+00f,
+            -9.943531276031033e-01f,
+            /* Notch 500Hz */
+            9.993592299758098e-01f,
+            -1.994774445634708e+00f,
+            9.993592299758098e-01f,
+            1.989782669980310e+00f,
+            -9.937266842972214e-01f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2.397619825633967e-04f,
+            4.795239651267935e-04f,
+            2.397619825633967e-04f,
+            1.942638230540114e+00f,
+            -9.435972784703673e-01f,
+            /* LPF Stage 2 */
+            2.437893768917065e-04f,
+            4.875787537834130e-04f,
+            2.437893768917065e-04f,
+            1.975269634851873e+00f,
+            -9.762447923594398e-01f,
+            /* Notch 60Hz */
+            1.016590566605801e+00f,
+            -2.033123341408221e+00f,
+            1.016590566605801e+00f,
+            1.997943208196618e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 120Hz */
+            1.003397704152095e+00f,
+            -2.006567244319199e+00f,
+            1.003397704152095e+00f,
+            1.997772836015009e+00f,
+            -9.980010000000000e-01f,
+            /* Notch 180Hz */
+            1.001369133238892e+00f,
+            -2.002225947526045e+00f,
+            1.001369133238892e+00f,
+            1.997227013438406e+00f,
+            -9.977393323901457e-01f,
+            /* Notch 240Hz */
+            1.000992225031392e+00f,
+            -2.001074033821795e+00f,
+            1.000992225031392e+00f,
+            1.996075928768419e+00f,
+            -9.969863450094077e-01f,
+            /* Notch 300Hz */
+            1.000615340516927e+00f,
+            -1.999808751882487e+00f,
+            1.000615340516927e+00f,
+            1.994811712721910e+00f,
+            -9.962336418732767e-01f,
+            /* Notch 360Hz */
+            1.000238479699944e+00f,
+            -1.998430259261792e+00f,
+            1.000238479699944e+00f,
+            1.993434522843656e+00f,
+            -9.954812229817522e-01f,
+            /* Notch 420Hz */
+            9.998616425845220e-01f,
+            -1.996938719910694e+00f,
+            9.998616425845220e-01f,
+            1.991944523076485e+00f,
+            -9.947290883348344e-01f,
+            /* Notch 480Hz */
+            9.994848291761036e-01f,
+            -1.995334304166767e+00f,
+            9.994848291761036e-01f,
+            1.990341883747084e+00f,
+            -9.939772379325237e-01f,
+            /* Notch 540Hz */
+            9.991080394805976e-01f,
+            -1.993617188737826e+00f,
+            9.991080394805976e-01f,
+            1.988626781551450e+00f,
+            -9.932256717748195e-01f,
+            /* Notch 600Hz */
+            9.987312735049659e-01f,
+            -1.991787556688188e+00f,
+            9.987312735049659e-01f,
+            1.986799399539979e+00f,
+            -9.924743898617220e-01f,
+        },
+    },
+};
+
+/**
+ * Filter coefficient banks in q31 format, scaled by 2^-2.
  * Each stage has 5 coefficients: {b0, b1, b2, -a1, -a2}
  */
-const float32_t adc_filter_coefficients[ADC_FILTER_TOTAL_COEFFS] = {
+const q31_t adc_filter_coefficients_q31[ADC_FILTER_NUM_RATES]
+                                       [ADC_FILTER_NUM_BANKS]
+                                       [ADC_FILTER_TOTAL_COEFFS] ADC_FILTER_FASTDATA = {
+    /* Set 0: 1000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            139528204,
+            279056408,
+            139528204,
+            0,
+            -21241904,
+            /* LPF Stage 2 */
+            194140936,
+            388281872,
+            194140936,
+            0,
+            -239692833,
+            /* Notch 50Hz */
+            529791034,
+            -1007722431,
+            529791034,
+            1005148357,
+            -520137082,
+            /* Notch 100Hz */
+            521391833,
+            -843629708,
+            521391833,
+            841385141,
+            -503668188,
+            /* Notch 150Hz */
+            513017567,
+            -603088320,
+            513017567,
+            601388327,
+            -487464229,
+            /* Notch 200Hz */
+            504671989,
+            -311904442,
+            504671989,
+            310956581,
+            -471525205,
+            /* Notch 250Hz */
+            496361014,
+            0,
+            496361014,
+            0,
+            -455851116,
+            /* Notch 300Hz */
+            488093553,
+            301658405,
+            488093553,
+            -300532637,
+            -440441962,
+            /* Notch 350Hz */
+            479882886,
+            564136167,
+            479882886,
+            -561733284,
+            -425297744,
+            /* Notch 400Hz */
+            471748964,
+            763305859,
+            471748964,
+            -759514415,
+            -410418461,
+            /* Notch 450Hz */
+            463722335,
+            882052297,
+            463722335,
+            -876821942,
+            -395804112,
+            /* Pass-through (500Hz at or above Nyquist) */
+            536870912,
+            0,
+            0,
+            0,
+            0,
+        },
+        /* Bank 1: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            139528204,
+            279056408,
+            139528204,
+            0,
+            -21241904,
+            /* LPF Stage 2 */
+            194140936,
+            388281872,
+            194140936,
+            0,
+            -239692833,
+            /* Notch 60Hz */
+            528109321,
+            -982047257,
+            528109321,
+            979521636,
+            -516822109,
+            /* Notch 120Hz */
+            518038966,
+            -755268308,
+            518038966,
+            753216100,
+            -497154812,
+            /* Notch 180Hz */
+            508006455,
+            -432597257,
+            508006455,
+            431324281,
+            -477869022,
+            /* Notch 240Hz */
+            498020065,
+            -62541877,
+            498020065,
+            62337398,
+            -458964739,
+            /* Notch 300Hz */
+            488093553,
+            301658405,
+            488093553,
+            -300532637,
+            -440441962,
+            /* Notch 360Hz */
+            478249170,
+            609694988,
+            478249170,
+            -607021724,
+            -422300692,
+            /* Notch 420Hz */
+            468523238,
+            821140087,
+            468523238,
+            -816774723,
+            -404540929,
+            /* Notch 480Hz */
+            458976820,
+            910715301,
+            458976820,
+            -904635356,
+            -387162672,
+            /* Pass-through (540Hz at or above Nyquist) */
+            536870912,
+            0,
+            0,
+            0,
+            0,
+            /* Pass-through (600Hz at or above Nyquist) */
+            536870912,
+            0,
+            0,
+            0,
+            0,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            139528204,
+            279056408,
+            139528204,
+            0,
+            -21241904,
+            /* LPF Stage 2 */
+            194140936,
+            388281872,
+            194140936,
+            0,
+            -239692833,
+            /* Notch 50Hz */
+            529791034,
+            -1007722431,
+            529791034,
+            1005148357,
+            -520137082,
+            /* Notch 100Hz */
+            521391833,
+            -843629708,
+            521391833,
+            841385141,
+            -503668188,
+            /* Notch 150Hz */
+            513017567,
+            -603088320,
+            513017567,
+            601388327,
+            -487464229,
+            /* Notch 200Hz */
+            504671989,
+            -311904442,
+            504671989,
+            310956581,
+            -471525205,
+            /* Notch 250Hz */
+            496361014,
+            0,
+            496361014,
+            0,
+            -455851116,
+            /* Notch 300Hz */
+            488093553,
+            301658405,
+            488093553,
+            -300532637,
+            -440441962,
+            /* Notch 350Hz */
+            479882886,
+            564136167,
+            479882886,
+            -561733284,
+            -425297744,
+            /* Notch 400Hz */
+            471748964,
+            763305859,
+            471748964,
+            -759514415,
+            -410418461,
+            /* Notch 450Hz */
+            463722335,
+            882052297,
+            463722335,
+            -876821942,
+            -395804112,
+            /* Pass-through (500Hz at or above Nyquist) */
+            536870912,
+            0,
+            0,
+            0,
+            0,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            139528204,
+            279056408,
+            139528204,
+            0,
+            -21241904,
+            /* LPF Stage 2 */
+            194140936,
+            388281872,
+            194140936,
+            0,
+            -239692833,
+            /* Notch 60Hz */
+            528109321,
+            -982047257,
+            528109321,
+            979521636,
+            -516822109,
+            /* Notch 120Hz */
+            518038966,
+            -755268308,
+            518038966,
+            753216100,
+            -497154812,
+            /* Notch 180Hz */
+            508006455,
+            -432597257,
+            508006455,
+            431324281,
+            -477869022,
+            /* Notch 240Hz */
+            498020065,
+            -62541877,
+            498020065,
+            62337398,
+            -458964739,
+            /* Notch 300Hz */
+            488093553,
+            301658405,
+            488093553,
+            -300532637,
+            -440441962,
+            /* Notch 360Hz */
+            478249170,
+            609694988,
+            478249170,
+            -607021724,
+            -422300692,
+            /* Notch 420Hz */
+            468523238,
+            821140087,
+            468523238,
+            -816774723,
+            -404540929,
+            /* Notch 480Hz */
+            458976820,
+            910715301,
+            458976820,
+            -904635356,
+            -387162672,
+            /* Pass-through (540Hz at or above Nyquist) */
+            536870912,
+            0,
+            0,
+            0,
+            0,
+            /* Pass-through (600Hz at or above Nyquist) */
+            536870912,
+            0,
+            0,
+            0,
+            0,
+        },
+    },
+    /* Set 1: 5000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            33224361,
+            66448722,
+            33224361,
+            562962611,
+            -158989144,
+            /* LPF Stage 2 */
+            41852492,
+            83704983,
+            41852492,
+            709159998,
+            -339699053,
+            /* Notch 50Hz */
+            536526901,
+            -1070936376,
+            536526901,
+            1068256437,
+            -533502951,
+            /* Notch 100Hz */
+            534841597,
+            -1061248423,
+            534841597,
+            1058581728,
+            -530145588,
+            /* Notch 150Hz */
+            533157181,
+            -1047427004,
+            533157181,
+            1044782375,
+            -526798822,
+            /* Notch 200Hz */
+            531473658,
+            -1029552871,
+            531473658,
+            1026939121,
+            -523462654,
+            /* Notch 250Hz */
+            529791034,
+            -1007722431,
+            529791034,
+            1005148357,
+            -520137082,
+            /* Notch 300Hz */
+            528109321,
+            -982047257,
+            528109321,
+            979521636,
+            -516822109,
+            /* Notch 350Hz */
+            526428529,
+            -952653548,
+            526428529,
+            950185135,
+            -513517732,
+            /* Notch 400Hz */
+            524748672,
+            -919681533,
+            524748672,
+            917279055,
+            -510223954,
+            /* Notch 450Hz */
+            523069767,
+            -883284823,
+            523069767,
+            880956973,
+            -506940772,
+            /* Notch 500Hz */
+            521391833,
+            -843629708,
+            521391833,
+            841385141,
+            -503668188,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            33224361,
+            66448722,
+            33224361,
+            562962611,
+            -158989144,
+            /* LPF Stage 2 */
+            41852492,
+            83704983,
+            41852492,
+            709159998,
+            -339699053,
+            /* Notch 60Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+            /* Notch 120Hz */
+            534167724,
+            -1056211705,
+            534167724,
+            1053552779,
+            -528805610,
+            /* Notch 180Hz */
+            532146960,
+            -1037183025,
+            532146960,
+            1034555867,
+            -524795849,
+            /* Notch 240Hz */
+            530127487,
+            -1012399882,
+            530127487,
+            1009817170,
+            -520801349,
+            /* Notch 300Hz */
+            528109321,
+            -982047257,
+            528109321,
+            979521636,
+            -516822109,
+            /* Notch 360Hz */
+            526092482,
+            -946340682,
+            526092482,
+            943884759,
+            -512858129,
+            /* Notch 420Hz */
+            524076995,
+            -905524777,
+            524076995,
+            903151108,
+            -508909409,
+            /* Notch 480Hz */
+            522062889,
+            -859871615,
+            522062889,
+            857592698,
+            -504975950,
+            /* Notch 540Hz */
+            520050200,
+            -809678951,
+            520050200,
+            807507214,
+            -501057751,
+            /* Notch 600Hz */
+            518038966,
+            -755268308,
+            518038966,
+            753216100,
+            -497154812,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            10220321,
+            20440642,
+            10220321,
+            794394046,
+            -298404419,
+            /* LPF Stage 2 */
+            11748804,
+            23497607,
+            11748804,
+            913198272,
+            -423322574,
+            /* Notch 50Hz */
+            536526901,
+            -1070936376,
+            536526901,
+            1068256437,
+            -533502951,
+            /* Notch 100Hz */
+            534841597,
+            -1061248423,
+            534841597,
+            1058581728,
+            -530145588,
+            /* Notch 150Hz */
+            533157181,
+            -1047427004,
+            533157181,
+            1044782375,
+            -526798822,
+            /* Notch 200Hz */
+            531473658,
+            -1029552871,
+            531473658,
+            1026939121,
+            -523462654,
+            /* Notch 250Hz */
+            529791034,
+            -1007722431,
+            529791034,
+            1005148357,
+            -520137082,
+            /* Notch 300Hz */
+            528109321,
+            -982047257,
+            528109321,
+            979521636,
+            -516822109,
+            /* Notch 350Hz */
+            526428529,
+            -952653548,
+            526428529,
+            950185135,
+            -513517732,
+            /* Notch 400Hz */
+            524748672,
+            -919681533,
+            524748672,
+            917279055,
+            -510223954,
+            /* Notch 450Hz */
+            523069767,
+            -883284823,
+            523069767,
+            880956973,
+            -506940772,
+            /* Notch 500Hz */
+            521391833,
+            -843629708,
+            521391833,
+            841385141,
+            -503668188,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            10220321,
+            20440642,
+            10220321,
+            794394046,
+            -298404419,
+            /* LPF Stage 2 */
+            11748804,
+            23497607,
+            11748804,
+            913198272,
+            -423322574,
+            /* Notch 60Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+            /* Notch 120Hz */
+            534167724,
+            -1056211705,
+            534167724,
+            1053552779,
+            -528805610,
+            /* Notch 180Hz */
+            532146960,
+            -1037183025,
+            532146960,
+            1034555867,
+            -524795849,
+            /* Notch 240Hz */
+            530127487,
+            -1012399882,
+            530127487,
+            1009817170,
+            -520801349,
+            /* Notch 300Hz */
+            528109321,
+            -982047257,
+            528109321,
+            979521636,
+            -516822109,
+            /* Notch 360Hz */
+            526092482,
+            -946340682,
+            526092482,
+            943884759,
+            -512858129,
+            /* Notch 420Hz */
+            524076995,
+            -905524777,
+            524076995,
+            903151108,
+            -508909409,
+            /* Notch 480Hz */
+            522062889,
+            -859871615,
+            522062889,
+            857592698,
+            -504975950,
+            /* Notch 540Hz */
+            520050200,
+            -809678951,
+            520050200,
+            807507214,
+            -501057751,
+            /* Notch 600Hz */
+            518038966,
+            -755268308,
+            518038966,
+            753216100,
+            -497154812,
+        },
+    },
+    /* Set 2: 10000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            10220321,
+            20440642,
+            10220321,
+            794394046,
+            -298404419,
+            /* LPF Stage 2 */
+            11748804,
+            23497607,
+            11748804,
+            913198272,
+            -423322574,
+            /* Notch 50Hz */
+            537369885,
+            -1074209450,
+            537369885,
+            1071526200,
+            -535185607,
+            /* Notch 100Hz */
+            536526901,
+            -1070936376,
+            536526901,
+            1068256437,
+            -533502951,
+            /* Notch 150Hz */
+            535684139,
+            -1066613507,
+            535684139,
+            1063939087,
+            -531822945,
+            /* Notch 200Hz */
+            534841597,
+            -1061248423,
+            534841597,
+            1058581728,
+            -530145588,
+            /* Notch 250Hz */
+            533999278,
+            -1054849722,
+            533999278,
+            1052192958,
+            -528470880,
+            /* Notch 300Hz */
+            533157181,
+            -1047427004,
+            533157181,
+            1044782375,
+            -526798822,
+            /* Notch 350Hz */
+            532315307,
+            -1038990862,
+            532315307,
+            1036360573,
+            -525129413,
+            /* Notch 400Hz */
+            531473658,
+            -1029552871,
+            531473658,
+            1026939121,
+            -523462654,
+            /* Notch 450Hz */
+            530632233,
+            -1019125566,
+            530632233,
+            1016530555,
+            -521798543,
+            /* Notch 500Hz */
+            529791034,
+            -1007722431,
+            529791034,
+            1005148357,
+            -520137082,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            10220321,
+            20440642,
+            10220321,
+            794394046,
+            -298404419,
+            /* LPF Stage 2 */
+            11748804,
+            23497607,
+            11748804,
+            913198272,
+            -423322574,
+            /* Notch 60Hz */
+            537201270,
+            -1073639148,
+            537201270,
+            1070956383,
+            -534848864,
+            /* Notch 120Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+            /* Notch 180Hz */
+            535178587,
+            -1063518995,
+            535178587,
+            1060848945,
+            -530816213,
+            /* Notch 240Hz */
+            534167724,
+            -1056211705,
+            534167724,
+            1053552779,
+            -528805610,
+            /* Notch 300Hz */
+            533157181,
+            -1047427004,
+            533157181,
+            1044782375,
+            -526798822,
+            /* Notch 360Hz */
+            532146960,
+            -1037183025,
+            532146960,
+            1034555867,
+            -524795849,
+            /* Notch 420Hz */
+            531137061,
+            -1025499932,
+            531137061,
+            1022893414,
+            -522796692,
+            /* Notch 480Hz */
+            530127487,
+            -1012399882,
+            530127487,
+            1009817170,
+            -520801349,
+            /* Notch 540Hz */
+            529118239,
+            -997906984,
+            529118239,
+            995351239,
+            -518809821,
+            /* Notch 600Hz */
+            528109321,
+            -982047257,
+            528109321,
+            979521636,
+            -516822109,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2887557,
+            5775114,
+            2887557,
+            926603436,
+            -401282752,
+            /* LPF Stage 2 */
+            3118214,
+            6236429,
+            3118214,
+            1000620270,
+            -476222215,
+            /* Notch 50Hz */
+            537369885,
+            -1074209450,
+            537369885,
+            1071526200,
+            -535185607,
+            /* Notch 100Hz */
+            536526901,
+            -1070936376,
+            536526901,
+            1068256437,
+            -533502951,
+            /* Notch 150Hz */
+            535684139,
+            -1066613507,
+            535684139,
+            1063939087,
+            -531822945,
+            /* Notch 200Hz */
+            534841597,
+            -1061248423,
+            534841597,
+            1058581728,
+            -530145588,
+            /* Notch 250Hz */
+            533999278,
+            -1054849722,
+            533999278,
+            1052192958,
+            -528470880,
+            /* Notch 300Hz */
+            533157181,
+            -1047427004,
+            533157181,
+            1044782375,
+            -526798822,
+            /* Notch 350Hz */
+            532315307,
+            -1038990862,
+            532315307,
+            1036360573,
+            -525129413,
+            /* Notch 400Hz */
+            531473658,
+            -1029552871,
+            531473658,
+            1026939121,
+            -523462654,
+            /* Notch 450Hz */
+            530632233,
+            -1019125566,
+            530632233,
+            1016530555,
+            -521798543,
+            /* Notch 500Hz */
+            529791034,
+            -1007722431,
+            529791034,
+            1005148357,
+            -520137082,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2887557,
+            5775114,
+            2887557,
+            926603436,
+            -401282752,
+            /* LPF Stage 2 */
+            3118214,
+            6236429,
+            3118214,
+            1000620270,
+            -476222215,
+            /* Notch 60Hz */
+            537201270,
+            -1073639148,
+            537201270,
+            1070956383,
+            -534848864,
+            /* Notch 120Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+            /* Notch 180Hz */
+            535178587,
+            -1063518995,
+            535178587,
+            1060848945,
+            -530816213,
+            /* Notch 240Hz */
+            534167724,
+            -1056211705,
+            534167724,
+            1053552779,
+            -528805610,
+            /* Notch 300Hz */
+            533157181,
+            -1047427004,
+            533157181,
+            1044782375,
+            -526798822,
+            /* Notch 360Hz */
+            532146960,
+            -1037183025,
+            532146960,
+            1034555867,
+            -524795849,
+            /* Notch 420Hz */
+            531137061,
+            -1025499932,
+            531137061,
+            1022893414,
+            -522796692,
+            /* Notch 480Hz */
+            530127487,
+            -1012399882,
+            530127487,
+            1009817170,
+            -520801349,
+            /* Notch 540Hz */
+            529118239,
+            -997906984,
+            529118239,
+            995351239,
+            -518809821,
+            /* Notch 600Hz */
+            528109321,
+            -982047257,
+            528109321,
+            979521636,
+            -516822109,
+        },
+    },
+    /* Set 3: 25000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            1897031,
+            3794062,
+            1897031,
+            954724784,
+            -425441997,
+            /* LPF Stage 2 */
+            2019817,
+            4039635,
+            2019817,
+            1016519761,
+            -487728118,
+            /* Notch 50Hz */
+            539733861,
+            -1079382491,
+            539733861,
+            1072583389,
+            -535797707,
+            /* Notch 100Hz */
+            537538508,
+            -1074737495,
+            537538508,
+            1072053847,
+            -535522456,
+            /* Notch 150Hz */
+            537201270,
+            -1073639148,
+            537201270,
+            1070956383,
+            -534848864,
+            /* Notch 200Hz */
+            536864068,
+            -1072371971,
+            536864068,
+            1069690442,
+            -534175696,
+            /* Notch 250Hz */
+            536526901,
+            -1070936376,
+            536526901,
+            1068256437,
+            -533502951,
+            /* Notch 300Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+            /* Notch 350Hz */
+            535852673,
+            -1067561715,
+            535852673,
+            1064886015,
+            -532158734,
+            /* Notch 400Hz */
+            535515613,
+            -1065623607,
+            535515613,
+            1062950555,
+            -531487262,
+            /* Notch 450Hz */
+            535178587,
+            -1063518995,
+            535178587,
+            1060848945,
+            -530816213,
+            /* Notch 500Hz */
+            534841597,
+            -1061248423,
+            534841597,
+            1058581728,
+            -530145588,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            1897031,
+            3794062,
+            1897031,
+            954724784,
+            -425441997,
+            /* LPF Stage 2 */
+            2019817,
+            4039635,
+            2019817,
+            1016519761,
+            -487728118,
+            /* Notch 60Hz */
+            538695041,
+            -1077267586,
+            538695041,
+            1072546124,
+            -535797707,
+            /* Notch 120Hz */
+            537403609,
+            -1074318442,
+            537403609,
+            1071635104,
+            -535252968,
+            /* Notch 180Hz */
+            536998945,
+            -1072899076,
+            536998945,
+            1070217010,
+            -534444912,
+            /* Notch 240Hz */
+            536594332,
+            -1071236948,
+            536594332,
+            1068556662,
+            -533637466,
+            /* Notch 300Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+            /* Notch 360Hz */
+            535785258,
+            -1067187439,
+            535785258,
+            1064512240,
+            -532024406,
+            /* Notch 420Hz */
+            535380798,
+            -1064801713,
+            535380798,
+            1062129819,
+            -531218791,
+            /* Notch 480Hz */
+            534976389,
+            -1062176531,
+            534976389,
+            1059508452,
+            -530413787,
+            /* Notch 540Hz */
+            534572031,
+            -1059312857,
+            534572031,
+            1056649100,
+            -529609393,
+            /* Notch 600Hz */
+            534167724,
+            -1056211705,
+            534167724,
+            1053552779,
+            -528805610,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            500653,
+            1001305,
+            500653,
+            1012865807,
+            -477997506,
+            /* LPF Stage 2 */
+            517267,
+            1034533,
+            517267,
+            1046477349,
+            -511675504,
+            /* Notch 50Hz */
+            539733861,
+            -1079382491,
+            539733861,
+            1072583389,
+            -535797707,
+            /* Notch 100Hz */
+            537538508,
+            -1074737495,
+            537538508,
+            1072053847,
+            -535522456,
+            /* Notch 150Hz */
+            537201270,
+            -1073639148,
+            537201270,
+            1070956383,
+            -534848864,
+            /* Notch 200Hz */
+            536864068,
+            -1072371971,
+            536864068,
+            1069690442,
+            -534175696,
+            /* Notch 250Hz */
+            536526901,
+            -1070936376,
+            536526901,
+            1068256437,
+            -533502951,
+            /* Notch 300Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+            /* Notch 350Hz */
+            535852673,
+            -1067561715,
+            535852673,
+            1064886015,
+            -532158734,
+            /* Notch 400Hz */
+            535515613,
+            -1065623607,
+            535515613,
+            1062950555,
+            -531487262,
+            /* Notch 450Hz */
+            535178587,
+            -1063518995,
+            535178587,
+            1060848945,
+            -530816213,
+            /* Notch 500Hz */
+            534841597,
+            -1061248423,
+            534841597,
+            1058581728,
+            -530145588,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            500653,
+            1001305,
+            500653,
+            1012865807,
+            -477997506,
+            /* LPF Stage 2 */
+            517267,
+            1034533,
+            517267,
+            1046477349,
+            -511675504,
+            /* Notch 60Hz */
+            538695041,
+            -1077267586,
+            538695041,
+            1072546124,
+            -535797707,
+            /* Notch 120Hz */
+            537403609,
+            -1074318442,
+            537403609,
+            1071635104,
+            -535252968,
+            /* Notch 180Hz */
+            536998945,
+            -1072899076,
+            536998945,
+            1070217010,
+            -534444912,
+            /* Notch 240Hz */
+            536594332,
+            -1071236948,
+            536594332,
+            1068556662,
+            -533637466,
+            /* Notch 300Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+            /* Notch 360Hz */
+            535785258,
+            -1067187439,
+            535785258,
+            1064512240,
+            -532024406,
+            /* Notch 420Hz */
+            535380798,
+            -1064801713,
+            535380798,
+            1062129819,
+            -531218791,
+            /* Notch 480Hz */
+            534976389,
+            -1062176531,
+            534976389,
+            1059508452,
+            -530413787,
+            /* Notch 540Hz */
+            534572031,
+            -1059312857,
+            534572031,
+            1056649100,
+            -529609393,
+            /* Notch 600Hz */
+            534167724,
+            -1056211705,
+            534167724,
+            1053552779,
+            -528805610,
+        },
+    },
+    /* Set 4: 50000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            500653,
+            1001305,
+            500653,
+            1012865807,
+            -477997506,
+            /* LPF Stage 2 */
+            517267,
+            1034533,
+            517267,
+            1046477349,
+            -511675504,
+            /* Notch 50Hz */
+            549933185,
+            -1099844659,
+            549933185,
+            1072646909,
+            -535797707,
+            /* Notch 100Hz */
+            539733861,
+            -1079382491,
+            539733861,
+            1072583389,
+            -535797707,
+            /* Notch 150Hz */
+            537845097,
+            -1075499100,
+            537845097,
+            1072477525,
+            -535797707,
+            /* Notch 200Hz */
+            537538508,
+            -1074737495,
+            537538508,
+            1072053847,
+            -535522456,
+            /* Notch 250Hz */
+            537369885,
+            -1074209450,
+            537369885,
+            1071526200,
+            -535185607,
+            /* Notch 300Hz */
+            537201270,
+            -1073639148,
+            537201270,
+            1070956383,
+            -534848864,
+            /* Notch 350Hz */
+            537032665,
+            -1073026638,
+            537032665,
+            1070344447,
+            -534512227,
+            /* Notch 400Hz */
+            536864068,
+            -1072371971,
+            536864068,
+            1069690442,
+            -534175696,
+            /* Notch 450Hz */
+            536695480,
+            -1071675199,
+            536695480,
+            1068994421,
+            -533839270,
+            /* Notch 500Hz */
+            536526901,
+            -1070936376,
+            536526901,
+            1068256437,
+            -533502951,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            500653,
+            1001305,
+            500653,
+            1012865807,
+            -477997506,
+            /* LPF Stage 2 */
+            517267,
+            1034533,
+            517267,
+            1046477349,
+            -511675504,
+            /* Notch 60Hz */
+            545777905,
+            -1091524783,
+            545777905,
+            1072637592,
+            -535797707,
+            /* Notch 120Hz */
+            538695041,
+            -1077267586,
+            538695041,
+            1072546124,
+            -535797707,
+            /* Notch 180Hz */
+            537605960,
+            -1074936870,
+            537605960,
+            1072253088,
+            -535657225,
+            /* Notch 240Hz */
+            537403609,
+            -1074318442,
+            537403609,
+            1071635104,
+            -535252968,
+            /* Notch 300Hz */
+            537201270,
+            -1073639148,
+            537201270,
+            1070956383,
+            -534848864,
+            /* Notch 360Hz */
+            536998945,
+            -1072899076,
+            536998945,
+            1070217010,
+            -534444912,
+            /* Notch 420Hz */
+            536796632,
+            -1072098312,
+            536796632,
+            1069417073,
+            -534041113,
+            /* Notch 480Hz */
+            536594332,
+            -1071236948,
+            536594332,
+            1068556662,
+            -533637466,
+            /* Notch 540Hz */
+            536392044,
+            -1070315078,
+            536392044,
+            1067635874,
+            -533233972,
+            /* Notch 600Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            128721,
+            257442,
+            128721,
+            1042945959,
+            -506589931,
+            /* LPF Stage 2 */
+            130883,
+            261767,
+            130883,
+            1060464810,
+            -524117432,
+            /* Notch 50Hz */
+            549933185,
+            -1099844659,
+            549933185,
+            1072646909,
+            -535797707,
+            /* Notch 100Hz */
+            539733861,
+            -1079382491,
+            539733861,
+            1072583389,
+            -535797707,
+            /* Notch 150Hz */
+            537845097,
+            -1075499100,
+            537845097,
+            1072477525,
+            -535797707,
+            /* Notch 200Hz */
+            537538508,
+            -1074737495,
+            537538508,
+            1072053847,
+            -535522456,
+            /* Notch 250Hz */
+            537369885,
+            -1074209450,
+            537369885,
+            1071526200,
+            -535185607,
+            /* Notch 300Hz */
+            537201270,
+            -1073639148,
+            537201270,
+            1070956383,
+            -534848864,
+            /* Notch 350Hz */
+            537032665,
+            -1073026638,
+            537032665,
+            1070344447,
+            -534512227,
+            /* Notch 400Hz */
+            536864068,
+            -1072371971,
+            536864068,
+            1069690442,
+            -534175696,
+            /* Notch 450Hz */
+            536695480,
+            -1071675199,
+            536695480,
+            1068994421,
+            -533839270,
+            /* Notch 500Hz */
+            536526901,
+            -1070936376,
+            536526901,
+            1068256437,
+            -533502951,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            128721,
+            257442,
+            128721,
+            1042945959,
+            -506589931,
+            /* LPF Stage 2 */
+            130883,
+            261767,
+            130883,
+            1060464810,
+            -524117432,
+            /* Notch 60Hz */
+            545777905,
+            -1091524783,
+            545777905,
+            1072637592,
+            -535797707,
+            /* Notch 120Hz */
+            538695041,
+            -1077267586,
+            538695041,
+            1072546124,
+            -535797707,
+            /* Notch 180Hz */
+            537605960,
+            -1074936870,
+            537605960,
+            1072253088,
+            -535657225,
+            /* Notch 240Hz */
+            537403609,
+            -1074318442,
+            537403609,
+            1071635104,
+            -535252968,
+            /* Notch 300Hz */
+            537201270,
+            -1073639148,
+            537201270,
+            1070956383,
+            -534848864,
+            /* Notch 360Hz */
+            536998945,
+            -1072899076,
+            536998945,
+            1070217010,
+            -534444912,
+            /* Notch 420Hz */
+            536796632,
+            -1072098312,
+            536796632,
+            1069417073,
+            -534041113,
+            /* Notch 480Hz */
+            536594332,
+            -1071236948,
+            536594332,
+            1068556662,
+            -533637466,
+            /* Notch 540Hz */
+            536392044,
+            -1070315078,
+            536392044,
+            1067635874,
+            -533233972,
+            /* Notch 600Hz */
+            536189770,
+            -1069332802,
+            536189770,
+            1066654806,
+            -532830631,
+        },
+    },
+};
+
+/**
+ * Filter coefficient banks in q15 format, scaled by 2^-2.
+ * Each stage has 6 coefficients: {b0, 0, b1, b2, -a1, -a2}
+ */
+const q15_t adc_filter_coefficients_q15[ADC_FILTER_NUM_RATES]
+                                       [ADC_FILTER_NUM_BANKS]
+                                       [ADC_FILTER_Q15_TOTAL_COEFFS] ADC_FILTER_FASTDATA = {
+    /* Set 0: 1000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2129,
+            0,
+            4258,
+            2129,
+            0,
+            -324,
+            /* LPF Stage 2 */
+            2962,
+            0,
+            5925,
+            2962,
+            0,
+            -3657,
+            /* Notch 50Hz */
+            8084,
+            0,
+            -15377,
+            8084,
+            15337,
+            -7937,
+            /* Notch 100Hz */
+            7956,
+            0,
+            -12873,
+            7956,
+            12839,
+            -7685,
+            /* Notch 150Hz */
+            7828,
+            0,
+            -9202,
+            7828,
+            9176,
+            -7438,
+            /* Notch 200Hz */
+            7701,
+            0,
+            -4759,
+            7701,
+            4745,
+            -7195,
+            /* Notch 250Hz */
+            7574,
+            0,
+            0,
+            7574,
+            0,
+            -6956,
+            /* Notch 300Hz */
+            7448,
+            0,
+            4603,
+            7448,
+            -4586,
+            -6721,
+            /* Notch 350Hz */
+            7322,
+            0,
+            8608,
+            7322,
+            -8571,
+            -6490,
+            /* Notch 400Hz */
+            7198,
+            0,
+            11647,
+            7198,
+            -11589,
+            -6262,
+            /* Notch 450Hz */
+            7076,
+            0,
+            13459,
+            7076,
+            -13379,
+            -6039,
+            /* Pass-through (500Hz at or above Nyquist) */
+            8192,
+            0,
+            0,
+            0,
+            0,
+            0,
+        },
+        /* Bank 1: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2129,
+            0,
+            4258,
+            2129,
+            0,
+            -324,
+            /* LPF Stage 2 */
+            2962,
+            0,
+            5925,
+            2962,
+            0,
+            -3657,
+            /* Notch 60Hz */
+            8058,
+            0,
+            -14985,
+            8058,
+            14946,
+            -7886,
+            /* Notch 120Hz */
+            7905,
+            0,
+            -11524,
+            7905,
+            11493,
+            -7586,
+            /* Notch 180Hz */
+            7752,
+            0,
+            -6601,
+            7752,
+            6581,
+            -7292,
+            /* Notch 240Hz */
+            7599,
+            0,
+            -954,
+            7599,
+            951,
+            -7003,
+            /* Notch 300Hz */
+            7448,
+            0,
+            4603,
+            7448,
+            -4586,
+            -6721,
+            /* Notch 360Hz */
+            7298,
+            0,
+            9303,
+            7298,
+            -9262,
+            -6444,
+            /* Notch 420Hz */
+            7149,
+            0,
+            12530,
+            7149,
+            -12463,
+            -6173,
+            /* Notch 480Hz */
+            7003,
+            0,
+            13896,
+            7003,
+            -13804,
+            -5908,
+            /* Pass-through (540Hz at or above Nyquist) */
+            8192,
+            0,
+            0,
+            0,
+            0,
+            0,
+            /* Pass-through (600Hz at or above Nyquist) */
+            8192,
+            0,
+            0,
+            0,
+            0,
+            0,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2129,
+            0,
+            4258,
+            2129,
+            0,
+            -324,
+            /* LPF Stage 2 */
+            2962,
+            0,
+            5925,
+            2962,
+            0,
+            -3657,
+            /* Notch 50Hz */
+            8084,
+            0,
+            -15377,
+            8084,
+            15337,
+            -7937,
+            /* Notch 100Hz */
+            7956,
+            0,
+            -12873,
+            7956,
+            12839,
+            -7685,
+            /* Notch 150Hz */
+            7828,
+            0,
+            -9202,
+            7828,
+            9176,
+            -7438,
+            /* Notch 200Hz */
+            7701,
+            0,
+            -4759,
+            7701,
+            4745,
+            -7195,
+            /* Notch 250Hz */
+            7574,
+            0,
+            0,
+            7574,
+            0,
+            -6956,
+            /* Notch 300Hz */
+            7448,
+            0,
+            4603,
+            7448,
+            -4586,
+            -6721,
+            /* Notch 350Hz */
+            7322,
+            0,
+            8608,
+            7322,
+            -8571,
+            -6490,
+            /* Notch 400Hz */
+            7198,
+            0,
+            11647,
+            7198,
+            -11589,
+            -6262,
+            /* Notch 450Hz */
+            7076,
+            0,
+            13459,
+            7076,
+            -13379,
+            -6039,
+            /* Pass-through (500Hz at or above Nyquist) */
+            8192,
+            0,
+            0,
+            0,
+            0,
+            0,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2129,
+            0,
+            4258,
+            2129,
+            0,
+            -324,
+            /* LPF Stage 2 */
+            2962,
+            0,
+            5925,
+            2962,
+            0,
+            -3657,
+            /* Notch 60Hz */
+            8058,
+            0,
+            -14985,
+            8058,
+            14946,
+            -7886,
+            /* Notch 120Hz */
+            7905,
+            0,
+            -11524,
+            7905,
+            11493,
+            -7586,
+            /* Notch 180Hz */
+            7752,
+            0,
+            -6601,
+            7752,
+            6581,
+            -7292,
+            /* Notch 240Hz */
+            7599,
+            0,
+            -954,
+            7599,
+            951,
+            -7003,
+            /* Notch 300Hz */
+            7448,
+            0,
+            4603,
+            7448,
+            -4586,
+            -6721,
+            /* Notch 360Hz */
+            7298,
+            0,
+            9303,
+            7298,
+            -9262,
+            -6444,
+            /* Notch 420Hz */
+            7149,
+            0,
+            12530,
+            7149,
+            -12463,
+            -6173,
+            /* Notch 480Hz */
+            7003,
+            0,
+            13896,
+            7003,
+            -13804,
+            -5908,
+            /* Pass-through (540Hz at or above Nyquist) */
+            8192,
+            0,
+            0,
+            0,
+            0,
+            0,
+            /* Pass-through (600Hz at or above Nyquist) */
+            8192,
+            0,
+            0,
+            0,
+            0,
+            0,
+        },
+    },
+    /* Set 1: 5000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            507,
+            0,
+            1014,
+            507,
+            8590,
+            -2426,
+            /* LPF Stage 2 */
+            639,
+            0,
+            1277,
+            639,
+            10821,
+            -5183,
+            /* Notch 50Hz */
+            8187,
+            0,
+            -16341,
+            8187,
+            16300,
+            -8141,
+            /* Notch 100Hz */
+            8161,
+            0,
+            -16193,
+            8161,
+            16153,
+            -8089,
+            /* Notch 150Hz */
+            8135,
+            0,
+            -15982,
+            8135,
+            15942,
+            -8038,
+            /* Notch 200Hz */
+            8110,
+            0,
+            -15710,
+            8110,
+            15670,
+            -7987,
+            /* Notch 250Hz */
+            8084,
+            0,
+            -15377,
+            8084,
+            15337,
+            -7937,
+            /* Notch 300Hz */
+            8058,
+            0,
+            -14985,
+            8058,
+            14946,
+            -7886,
+            /* Notch 350Hz */
+            8033,
+            0,
+            -14536,
+            8033,
+            14499,
+            -7836,
+            /* Notch 400Hz */
+            8007,
+            0,
+            -14033,
+            8007,
+            13997,
+            -7785,
+            /* Notch 450Hz */
+            7981,
+            0,
+            -13478,
+            7981,
+            13442,
+            -7735,
+            /* Notch 500Hz */
+            7956,
+            0,
+            -12873,
+            7956,
+            12839,
+            -7685,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            507,
+            0,
+            1014,
+            507,
+            8590,
+            -2426,
+            /* LPF Stage 2 */
+            639,
+            0,
+            1277,
+            639,
+            10821,
+            -5183,
+            /* Notch 60Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+            /* Notch 120Hz */
+            8151,
+            0,
+            -16117,
+            8151,
+            16076,
+            -8069,
+            /* Notch 180Hz */
+            8120,
+            0,
+            -15826,
+            8120,
+            15786,
+            -8008,
+            /* Notch 240Hz */
+            8089,
+            0,
+            -15448,
+            8089,
+            15409,
+            -7947,
+            /* Notch 300Hz */
+            8058,
+            0,
+            -14985,
+            8058,
+            14946,
+            -7886,
+            /* Notch 360Hz */
+            8028,
+            0,
+            -14440,
+            8028,
+            14403,
+            -7826,
+            /* Notch 420Hz */
+            7997,
+            0,
+            -13817,
+            7997,
+            13781,
+            -7765,
+            /* Notch 480Hz */
+            7966,
+            0,
+            -13121,
+            7966,
+            13086,
+            -7705,
+            /* Notch 540Hz */
+            7935,
+            0,
+            -12355,
+            7935,
+            12322,
+            -7646,
+            /* Notch 600Hz */
+            7905,
+            0,
+            -11524,
+            7905,
+            11493,
+            -7586,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            156,
+            0,
+            312,
+            156,
+            12121,
+            -4553,
+            /* LPF Stage 2 */
+            179,
+            0,
+            359,
+            179,
+            13934,
+            -6459,
+            /* Notch 50Hz */
+            8187,
+            0,
+            -16341,
+            8187,
+            16300,
+            -8141,
+            /* Notch 100Hz */
+            8161,
+            0,
+            -16193,
+            8161,
+            16153,
+            -8089,
+            /* Notch 150Hz */
+            8135,
+            0,
+            -15982,
+            8135,
+            15942,
+            -8038,
+            /* Notch 200Hz */
+            8110,
+            0,
+            -15710,
+            8110,
+            15670,
+            -7987,
+            /* Notch 250Hz */
+            8084,
+            0,
+            -15377,
+            8084,
+            15337,
+            -7937,
+            /* Notch 300Hz */
+            8058,
+            0,
+            -14985,
+            8058,
+            14946,
+            -7886,
+            /* Notch 350Hz */
+            8033,
+            0,
+            -14536,
+            8033,
+            14499,
+            -7836,
+            /* Notch 400Hz */
+            8007,
+            0,
+            -14033,
+            8007,
+            13997,
+            -7785,
+            /* Notch 450Hz */
+            7981,
+            0,
+            -13478,
+            7981,
+            13442,
+            -7735,
+            /* Notch 500Hz */
+            7956,
+            0,
+            -12873,
+            7956,
+            12839,
+            -7685,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            156,
+            0,
+            312,
+            156,
+            12121,
+            -4553,
+            /* LPF Stage 2 */
+            179,
+            0,
+            359,
+            179,
+            13934,
+            -6459,
+            /* Notch 60Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+            /* Notch 120Hz */
+            8151,
+            0,
+            -16117,
+            8151,
+            16076,
+            -8069,
+            /* Notch 180Hz */
+            8120,
+            0,
+            -15826,
+            8120,
+            15786,
+            -8008,
+            /* Notch 240Hz */
+            8089,
+            0,
+            -15448,
+            8089,
+            15409,
+            -7947,
+            /* Notch 300Hz */
+            8058,
+            0,
+            -14985,
+            8058,
+            14946,
+            -7886,
+            /* Notch 360Hz */
+            8028,
+            0,
+            -14440,
+            8028,
+            14403,
+            -7826,
+            /* Notch 420Hz */
+            7997,
+            0,
+            -13817,
+            7997,
+            13781,
+            -7765,
+            /* Notch 480Hz */
+            7966,
+            0,
+            -13121,
+            7966,
+            13086,
+            -7705,
+            /* Notch 540Hz */
+            7935,
+            0,
+            -12355,
+            7935,
+            12322,
+            -7646,
+            /* Notch 600Hz */
+            7905,
+            0,
+            -11524,
+            7905,
+            11493,
+            -7586,
+        },
+    },
+    /* Set 2: 10000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            156,
+            0,
+            312,
+            156,
+            12121,
+            -4553,
+            /* LPF Stage 2 */
+            179,
+            0,
+            359,
+            179,
+            13934,
+            -6459,
+            /* Notch 50Hz */
+            8200,
+            0,
+            -16391,
+            8200,
+            16350,
+            -8166,
+            /* Notch 100Hz */
+            8187,
+            0,
+            -16341,
+            8187,
+            16300,
+            -8141,
+            /* Notch 150Hz */
+            8174,
+            0,
+            -16275,
+            8174,
+            16234,
+            -8115,
+            /* Notch 200Hz */
+            8161,
+            0,
+            -16193,
+            8161,
+            16153,
+            -8089,
+            /* Notch 250Hz */
+            8148,
+            0,
+            -16096,
+            8148,
+            16055,
+            -8064,
+            /* Notch 300Hz */
+            8135,
+            0,
+            -15982,
+            8135,
+            15942,
+            -8038,
+            /* Notch 350Hz */
+            8122,
+            0,
+            -15854,
+            8122,
+            15814,
+            -8013,
+            /* Notch 400Hz */
+            8110,
+            0,
+            -15710,
+            8110,
+            15670,
+            -7987,
+            /* Notch 450Hz */
+            8097,
+            0,
+            -15551,
+            8097,
+            15511,
+            -7962,
+            /* Notch 500Hz */
+            8084,
+            0,
+            -15377,
+            8084,
+            15337,
+            -7937,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            156,
+            0,
+            312,
+            156,
+            12121,
+            -4553,
+            /* LPF Stage 2 */
+            179,
+            0,
+            359,
+            179,
+            13934,
+            -6459,
+            /* Notch 60Hz */
+            8197,
+            0,
+            -16382,
+            8197,
+            16341,
+            -8161,
+            /* Notch 120Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+            /* Notch 180Hz */
+            8166,
+            0,
+            -16228,
+            8166,
+            16187,
+            -8100,
+            /* Notch 240Hz */
+            8151,
+            0,
+            -16117,
+            8151,
+            16076,
+            -8069,
+            /* Notch 300Hz */
+            8135,
+            0,
+            -15982,
+            8135,
+            15942,
+            -8038,
+            /* Notch 360Hz */
+            8120,
+            0,
+            -15826,
+            8120,
+            15786,
+            -8008,
+            /* Notch 420Hz */
+            8105,
+            0,
+            -15648,
+            8105,
+            15608,
+            -7977,
+            /* Notch 480Hz */
+            8089,
+            0,
+            -15448,
+            8089,
+            15409,
+            -7947,
+            /* Notch 540Hz */
+            8074,
+            0,
+            -15227,
+            8074,
+            15188,
+            -7916,
+            /* Notch 600Hz */
+            8058,
+            0,
+            -14985,
+            8058,
+            14946,
+            -7886,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            44,
+            0,
+            88,
+            44,
+            14139,
+            -6123,
+            /* LPF Stage 2 */
+            48,
+            0,
+            95,
+            48,
+            15268,
+            -7267,
+            /* Notch 50Hz */
+            8200,
+            0,
+            -16391,
+            8200,
+            16350,
+            -8166,
+            /* Notch 100Hz */
+            8187,
+            0,
+            -16341,
+            8187,
+            16300,
+            -8141,
+            /* Notch 150Hz */
+            8174,
+            0,
+            -16275,
+            8174,
+            16234,
+            -8115,
+            /* Notch 200Hz */
+            8161,
+            0,
+            -16193,
+            8161,
+            16153,
+            -8089,
+            /* Notch 250Hz */
+            8148,
+            0,
+            -16096,
+            8148,
+            16055,
+            -8064,
+            /* Notch 300Hz */
+            8135,
+            0,
+            -15982,
+            8135,
+            15942,
+            -8038,
+            /* Notch 350Hz */
+            8122,
+            0,
+            -15854,
+            8122,
+            15814,
+            -8013,
+            /* Notch 400Hz */
+            8110,
+            0,
+            -15710,
+            8110,
+            15670,
+            -7987,
+            /* Notch 450Hz */
+            8097,
+            0,
+            -15551,
+            8097,
+            15511,
+            -7962,
+            /* Notch 500Hz */
+            8084,
+            0,
+            -15377,
+            8084,
+            15337,
+            -7937,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            44,
+            0,
+            88,
+            44,
+            14139,
+            -6123,
+            /* LPF Stage 2 */
+            48,
+            0,
+            95,
+            48,
+            15268,
+            -7267,
+            /* Notch 60Hz */
+            8197,
+            0,
+            -16382,
+            8197,
+            16341,
+            -8161,
+            /* Notch 120Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+            /* Notch 180Hz */
+            8166,
+            0,
+            -16228,
+            8166,
+            16187,
+            -8100,
+            /* Notch 240Hz */
+            8151,
+            0,
+            -16117,
+            8151,
+            16076,
+            -8069,
+            /* Notch 300Hz */
+            8135,
+            0,
+            -15982,
+            8135,
+            15942,
+            -8038,
+            /* Notch 360Hz */
+            8120,
+            0,
+            -15826,
+            8120,
+            15786,
+            -8008,
+            /* Notch 420Hz */
+            8105,
+            0,
+            -15648,
+            8105,
+            15608,
+            -7977,
+            /* Notch 480Hz */
+            8089,
+            0,
+            -15448,
+            8089,
+            15409,
+            -7947,
+            /* Notch 540Hz */
+            8074,
+            0,
+            -15227,
+            8074,
+            15188,
+            -7916,
+            /* Notch 600Hz */
+            8058,
+            0,
+            -14985,
+            8058,
+            14946,
+            -7886,
+        },
+    },
+    /* Set 3: 25000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            29,
+            0,
+            58,
+            29,
+            14568,
+            -6492,
+            /* LPF Stage 2 */
+            31,
+            0,
+            62,
+            31,
+            15511,
+            -7442,
+            /* Notch 50Hz */
+            8236,
+            0,
+            -16470,
+            8236,
+            16366,
+            -8176,
+            /* Notch 100Hz */
+            8202,
+            0,
+            -16399,
+            8202,
+            16358,
+            -8171,
+            /* Notch 150Hz */
+            8197,
+            0,
+            -16382,
+            8197,
+            16341,
+            -8161,
+            /* Notch 200Hz */
+            8192,
+            0,
+            -16363,
+            8192,
+            16322,
+            -8151,
+            /* Notch 250Hz */
+            8187,
+            0,
+            -16341,
+            8187,
+            16300,
+            -8141,
+            /* Notch 300Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+            /* Notch 350Hz */
+            8176,
+            0,
+            -16290,
+            8176,
+            16249,
+            -8120,
+            /* Notch 400Hz */
+            8171,
+            0,
+            -16260,
+            8171,
+            16219,
+            -8110,
+            /* Notch 450Hz */
+            8166,
+            0,
+            -16228,
+            8166,
+            16187,
+            -8100,
+            /* Notch 500Hz */
+            8161,
+            0,
+            -16193,
+            8161,
+            16153,
+            -8089,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            29,
+            0,
+            58,
+            29,
+            14568,
+            -6492,
+            /* LPF Stage 2 */
+            31,
+            0,
+            62,
+            31,
+            15511,
+            -7442,
+            /* Notch 60Hz */
+            8220,
+            0,
+            -16438,
+            8220,
+            16366,
+            -8176,
+            /* Notch 120Hz */
+            8200,
+            0,
+            -16393,
+            8200,
+            16352,
+            -8167,
+            /* Notch 180Hz */
+            8194,
+            0,
+            -16371,
+            8194,
+            16330,
+            -8155,
+            /* Notch 240Hz */
+            8188,
+            0,
+            -16346,
+            8188,
+            16305,
+            -8143,
+            /* Notch 300Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+            /* Notch 360Hz */
+            8175,
+            0,
+            -16284,
+            8175,
+            16243,
+            -8118,
+            /* Notch 420Hz */
+            8169,
+            0,
+            -16248,
+            8169,
+            16207,
+            -8106,
+            /* Notch 480Hz */
+            8163,
+            0,
+            -16208,
+            8163,
+            16167,
+            -8093,
+            /* Notch 540Hz */
+            8157,
+            0,
+            -16164,
+            8157,
+            16123,
+            -8081,
+            /* Notch 600Hz */
+            8151,
+            0,
+            -16117,
+            8151,
+            16076,
+            -8069,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            8,
+            0,
+            15,
+            8,
+            15455,
+            -7294,
+            /* LPF Stage 2 */
+            8,
+            0,
+            16,
+            8,
+            15968,
+            -7808,
+            /* Notch 50Hz */
+            8236,
+            0,
+            -16470,
+            8236,
+            16366,
+            -8176,
+            /* Notch 100Hz */
+            8202,
+            0,
+            -16399,
+            8202,
+            16358,
+            -8171,
+            /* Notch 150Hz */
+            8197,
+            0,
+            -16382,
+            8197,
+            16341,
+            -8161,
+            /* Notch 200Hz */
+            8192,
+            0,
+            -16363,
+            8192,
+            16322,
+            -8151,
+            /* Notch 250Hz */
+            8187,
+            0,
+            -16341,
+            8187,
+            16300,
+            -8141,
+            /* Notch 300Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+            /* Notch 350Hz */
+            8176,
+            0,
+            -16290,
+            8176,
+            16249,
+            -8120,
+            /* Notch 400Hz */
+            8171,
+            0,
+            -16260,
+            8171,
+            16219,
+            -8110,
+            /* Notch 450Hz */
+            8166,
+            0,
+            -16228,
+            8166,
+            16187,
+            -8100,
+            /* Notch 500Hz */
+            8161,
+            0,
+            -16193,
+            8161,
+            16153,
+            -8089,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            8,
+            0,
+            15,
+            8,
+            15455,
+            -7294,
+            /* LPF Stage 2 */
+            8,
+            0,
+            16,
+            8,
+            15968,
+            -7808,
+            /* Notch 60Hz */
+            8220,
+            0,
+            -16438,
+            8220,
+            16366,
+            -8176,
+            /* Notch 120Hz */
+            8200,
+            0,
+            -16393,
+            8200,
+            16352,
+            -8167,
+            /* Notch 180Hz */
+            8194,
+            0,
+            -16371,
+            8194,
+            16330,
+            -8155,
+            /* Notch 240Hz */
+            8188,
+            0,
+            -16346,
+            8188,
+            16305,
+            -8143,
+            /* Notch 300Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+            /* Notch 360Hz */
+            8175,
+            0,
+            -16284,
+            8175,
+            16243,
+            -8118,
+            /* Notch 420Hz */
+            8169,
+            0,
+            -16248,
+            8169,
+            16207,
+            -8106,
+            /* Notch 480Hz */
+            8163,
+            0,
+            -16208,
+            8163,
+            16167,
+            -8093,
+            /* Notch 540Hz */
+            8157,
+            0,
+            -16164,
+            8157,
+            16123,
+            -8081,
+            /* Notch 600Hz */
+            8151,
+            0,
+            -16117,
+            8151,
+            16076,
+            -8069,
+        },
+    },
+    /* Set 4: 50000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            8,
+            0,
+            15,
+            8,
+            15455,
+            -7294,
+            /* LPF Stage 2 */
+            8,
+            0,
+            16,
+            8,
+            15968,
+            -7808,
+            /* Notch 50Hz */
+            8391,
+            0,
+            -16782,
+            8391,
+            16367,
+            -8176,
+            /* Notch 100Hz */
+            8236,
+            0,
+            -16470,
+            8236,
+            16366,
+            -8176,
+            /* Notch 150Hz */
+            8207,
+            0,
+            -16411,
+            8207,
+            16365,
+            -8176,
+            /* Notch 200Hz */
+            8202,
+            0,
+            -16399,
+            8202,
+            16358,
+            -8171,
+            /* Notch 250Hz */
+            8200,
+            0,
+            -16391,
+            8200,
+            16350,
+            -8166,
+            /* Notch 300Hz */
+            8197,
+            0,
+            -16382,
+            8197,
+            16341,
+            -8161,
+            /* Notch 350Hz */
+            8194,
+            0,
+            -16373,
+            8194,
+            16332,
+            -8156,
+            /* Notch 400Hz */
+            8192,
+            0,
+            -16363,
+            8192,
+            16322,
+            -8151,
+            /* Notch 450Hz */
+            8189,
+            0,
+            -16352,
+            8189,
+            16312,
+            -8146,
+            /* Notch 500Hz */
+            8187,
+            0,
+            -16341,
+            8187,
+            16300,
+            -8141,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            8,
+            0,
+            15,
+            8,
+            15455,
+            -7294,
+            /* LPF Stage 2 */
+            8,
+            0,
+            16,
+            8,
+            15968,
+            -7808,
+            /* Notch 60Hz */
+            8328,
+            0,
+            -16655,
+            8328,
+            16367,
+            -8176,
+            /* Notch 120Hz */
+            8220,
+            0,
+            -16438,
+            8220,
+            16366,
+            -8176,
+            /* Notch 180Hz */
+            8203,
+            0,
+            -16402,
+            8203,
+            16361,
+            -8173,
+            /* Notch 240Hz */
+            8200,
+            0,
+            -16393,
+            8200,
+            16352,
+            -8167,
+            /* Notch 300Hz */
+            8197,
+            0,
+            -16382,
+            8197,
+            16341,
+            -8161,
+            /* Notch 360Hz */
+            8194,
+            0,
+            -16371,
+            8194,
+            16330,
+            -8155,
+            /* Notch 420Hz */
+            8191,
+            0,
+            -16359,
+            8191,
+            16318,
+            -8149,
+            /* Notch 480Hz */
+            8188,
+            0,
+            -16346,
+            8188,
+            16305,
+            -8143,
+            /* Notch 540Hz */
+            8185,
+            0,
+            -16332,
+            8185,
+            16291,
+            -8137,
+            /* Notch 600Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2,
+            0,
+            4,
+            2,
+            15914,
+            -7730,
+            /* LPF Stage 2 */
+            2,
+            0,
+            4,
+            2,
+            16181,
+            -7997,
+            /* Notch 50Hz */
+            8391,
+            0,
+            -16782,
+            8391,
+            16367,
+            -8176,
+            /* Notch 100Hz */
+            8236,
+            0,
+            -16470,
+            8236,
+            16366,
+            -8176,
+            /* Notch 150Hz */
+            8207,
+            0,
+            -16411,
+            8207,
+            16365,
+            -8176,
+            /* Notch 200Hz */
+            8202,
+            0,
+            -16399,
+            8202,
+            16358,
+            -8171,
+            /* Notch 250Hz */
+            8200,
+            0,
+            -16391,
+            8200,
+            16350,
+            -8166,
+            /* Notch 300Hz */
+            8197,
+            0,
+            -16382,
+            8197,
+            16341,
+            -8161,
+            /* Notch 350Hz */
+            8194,
+            0,
+            -16373,
+            8194,
+            16332,
+            -8156,
+            /* Notch 400Hz */
+            8192,
+            0,
+            -16363,
+            8192,
+            16322,
+            -8151,
+            /* Notch 450Hz */
+            8189,
+            0,
+            -16352,
+            8189,
+            16312,
+            -8146,
+            /* Notch 500Hz */
+            8187,
+            0,
+            -16341,
+            8187,
+            16300,
+            -8141,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            /* LPF Stage 1 */
+            2,
+            0,
+            4,
+            2,
+            15914,
+            -7730,
+            /* LPF Stage 2 */
+            2,
+            0,
+            4,
+            2,
+            16181,
+            -7997,
+            /* Notch 60Hz */
+            8328,
+            0,
+            -16655,
+            8328,
+            16367,
+            -8176,
+            /* Notch 120Hz */
+            8220,
+            0,
+            -16438,
+            8220,
+            16366,
+            -8176,
+            /* Notch 180Hz */
+            8203,
+            0,
+            -16402,
+            8203,
+            16361,
+            -8173,
+            /* Notch 240Hz */
+            8200,
+            0,
+            -16393,
+            8200,
+            16352,
+            -8167,
+            /* Notch 300Hz */
+            8197,
+            0,
+            -16382,
+            8197,
+            16341,
+            -8161,
+            /* Notch 360Hz */
+            8194,
+            0,
+            -16371,
+            8194,
+            16330,
+            -8155,
+            /* Notch 420Hz */
+            8191,
+            0,
+            -16359,
+            8191,
+            16318,
+            -8149,
+            /* Notch 480Hz */
+            8188,
+            0,
+            -16346,
+            8188,
+            16305,
+            -8143,
+            /* Notch 540Hz */
+            8185,
+            0,
+            -16332,
+            8185,
+            16291,
+            -8137,
+            /* Notch 600Hz */
+            8182,
+            0,
+            -16317,
+            8182,
+            16276,
+            -8130,
+        },
+    },
+};
+
+/**
+ * DC gain of each stage of each bank: (b0 + b1 + b2) / (1 + a1 + a2).
+ */
+const float32_t adc_filter_stage_dc_gain[ADC_FILTER_NUM_RATES]
+                                        [ADC_FILTER_NUM_BANKS]
+                                        [ADC_FILTER_NUM_STAGES] = {
+    /* Set 0: 1000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 250 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            9.999999999999998e-01f,
+            1.000000000000000e+00f,
+            9.999999999999999e-01f,
+            9.999999999999998e-01f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 1: 60 Hz mains, 250 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            9.999999999999992e-01f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            9.999999999999998e-01f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            9.999999999999998e-01f,
+            1.000000000000000e+00f,
+            9.999999999999999e-01f,
+            9.999999999999998e-01f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            9.999999999999992e-01f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            9.999999999999998e-01f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+        },
+    },
+    /* Set 1: 5000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            9.999999999999999e-01f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000003e+00f,
+            1.000000000000002e+00f,
+            1.000000000000000e+00f,
+            9.999999999999992e-01f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            9.999999999999999e-01f,
+            1.000000000000000e+00f,
+            1.000000000000020e+00f,
+            1.000000000000005e+00f,
+            9.999999999999978e-01f,
+            1.000000000000000e+00f,
+            9.999999999999992e-01f,
+            1.000000000000001e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000003e+00f,
+            1.000000000000002e+00f,
+            1.000000000000000e+00f,
+            9.999999999999992e-01f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000020e+00f,
+            1.000000000000005e+00f,
+            9.999999999999978e-01f,
+            1.000000000000000e+00f,
+            9.999999999999992e-01f,
+            1.000000000000001e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+        },
+    },
+    /* Set 2: 10000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000003e+00f,
+            1.000000000000000e+00f,
+            1.000000000000002e+00f,
+            1.000000000000001e+00f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000020e+00f,
+            1.000000000000000e+00f,
+            1.000000000000005e+00f,
+            1.000000000000003e+00f,
+            9.999999999999978e-01f,
+            1.000000000000002e+00f,
+            1.000000000000000e+00f,
+            9.999999999999990e-01f,
+            9.999999999999992e-01f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000003e+00f,
+            1.000000000000000e+00f,
+            1.000000000000002e+00f,
+            1.000000000000001e+00f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000020e+00f,
+            1.000000000000000e+00f,
+            1.000000000000005e+00f,
+            1.000000000000003e+00f,
+            9.999999999999978e-01f,
+            1.000000000000002e+00f,
+            1.000000000000000e+00f,
+            9.999999999999990e-01f,
+            9.999999999999992e-01f,
+        },
+    },
+    /* Set 3: 25000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            9.999999999999999e-01f,
+            1.000000000000699e+00f,
+            1.000000000000176e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000020e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            1.000000000000000e+00f,
+            9.999999999999999e-01f,
+            9.999999999995134e-01f,
+            1.000000000000122e+00f,
+            9.999999999998915e-01f,
+            9.999999999999695e-01f,
+            1.000000000000020e+00f,
+            1.000000000000014e+00f,
+            1.000000000000010e+00f,
+            1.000000000000000e+00f,
+            1.000000000000006e+00f,
+            1.000000000000005e+00f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            9.999999999999999e-01f,
+            9.999999999999999e-01f,
+            1.000000000000699e+00f,
+            1.000000000000176e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000020e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            9.999999999999999e-01f,
+            9.999999999999999e-01f,
+            9.999999999995134e-01f,
+            1.000000000000122e+00f,
+            9.999999999998915e-01f,
+            9.999999999999695e-01f,
+            1.000000000000020e+00f,
+            1.000000000000014e+00f,
+            1.000000000000010e+00f,
+            1.000000000000000e+00f,
+            1.000000000000006e+00f,
+            1.000000000000005e+00f,
+        },
+    },
+    /* Set 4: 50000 Hz */
+    {
+        /* Bank 0: 50 Hz mains, 500 Hz LPF */
+        {
+            9.999999999999999e-01f,
+            9.999999999999999e-01f,
+            9.999999999972545e-01f,
+            1.000000000000699e+00f,
+            9.999999999996881e-01f,
+            1.000000000000176e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            9.999999999999426e-01f,
+            1.000000000000000e+00f,
+            9.999999999999653e-01f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 1: 60 Hz mains, 500 Hz LPF */
+        {
+            9.999999999999999e-01f,
+            9.999999999999999e-01f,
+            9.999999999980790e-01f,
+            9.999999999995134e-01f,
+            9.999999999993499e-01f,
+            1.000000000000122e+00f,
+            1.000000000000000e+00f,
+            9.999999999998915e-01f,
+            1.000000000000040e+00f,
+            9.999999999999695e-01f,
+            9.999999999999759e-01f,
+            1.000000000000020e+00f,
+        },
+        /* Bank 2: 50 Hz mains, 250 Hz LPF */
+        {
+            9.999999999999999e-01f,
+            9.999999999999999e-01f,
+            9.999999999972545e-01f,
+            1.000000000000699e+00f,
+            9.999999999996881e-01f,
+            1.000000000000176e+00f,
+            1.000000000000000e+00f,
+            1.000000000000000e+00f,
+            9.999999999999426e-01f,
+            1.000000000000000e+00f,
+            9.999999999999653e-01f,
+            1.000000000000000e+00f,
+        },
+        /* Bank 3: 60 Hz mains, 250 Hz LPF */
+        {
+            9.999999999999999e-01f,
+            9.999999999999999e-01f,
+            9.999999999980790e-01f,
+            9.999999999995134e-01f,
+            9.999999999993499e-01f,
+            1.000000000000122e+00f,
+            1.000000000000000e+00f,
+            9.999999999998915e-01f,
+            1.000000000000040e+00f,
+            9.999999999999695e-01f,
+            9.999999999999759e-01f,
+            1.000000000000020e+00f,
+        },
+    },
+};
+
+/**
+ * Filter coefficients of the slow channel set in CMSIS-DSP format,
+ * 10 Hz, 1 Hz LPF.
+ */
+const float32_t adc_filter_slow_coefficients[ADC_FILTER_SLOW_TOTAL_COEFFS]
+    ADC_FILTER_FASTDATA = {
     /* LPF Stage 1 */
-    1.903683158782388e-02f,
-    3.807366317564775e-02f,
-    1.903683158782388e-02f,
-    1.479674216931193e+00f,
-    -5.558215432824889e-01f,
+    6.188519529976447e-02f,
+    1.237703905995289e-01f,
+    6.188519529976447e-02f,
+    1.048599576362612e+00f,
+    -2.961403575616696e-01f,
     /* LPF Stage 2 */
-    2.188385196794304e-02f,
-    4.376770393588608e-02f,
-    2.188385196794304e-02f,
-    1.700964331943526e+00f,
-    -7.884997398152979e-01f,
-    /* Notch 50Hz */
-    1.000929409300205e+00f,
-    -2.000871022117102e+00f,
-    1.000929409300205e+00f,
-    1.995873078264203e+00f,
-    -9.968608747475105e-01f,
-    /* Notch 100Hz */
-    9.993592299758098e-01f,
-    -1.994774445634708e+00f,
-    9.993592299758098e-01f,
-    1.989782669980310e+00f,
-    -9.937266842972214e-01f,
-    /* Notch 150Hz */
-    9.977894623926329e-01f,
-    -1.986722474879721e+00f,
-    9.977894623926329e-01f,
-    1.981740978743588e+00f,
-    -9.905974286491330e-01f,
-    /* Notch 200Hz */
-    9.962201071601580e-01f,
-    -1.976729228117355e+00f,
-    9.962201071601580e-01f,
-    1.971762121600284e+00f,
-    -9.874731078032450e-01f,
-    /* Notch 250Hz */
-    9.946511651329361e-01f,
-    -1.964810717522340e+00f,
-    9.946511651329361e-01f,
-    1.959862109016026e+00f,
-    -9.843537217595579e-01f,
-    /* Notch 300Hz */
-    9.930826374113232e-01f,
-    -1.950984827298328e+00f,
-    9.930826374113232e-01f,
-    1.946058822993753e+00f,
-    -9.812392705180711e-01f,
-    /* Notch 350Hz */
-    9.915145253428467e-01f,
-    -1.935271289975650e+00f,
-    9.915145253428467e-01f,
-    1.930371993368742e+00f,
-    -9.781297540787848e-01f,
-    /* Notch 400Hz */
-    9.899468305237930e-01f,
-    -1.917691660916009e+00f,
-    9.899468305237930e-01f,
-    1.912823172310122e+00f,
-    -9.750251724416991e-01f,
-    /* Notch 450Hz */
-    9.883795548010862e-01f,
-    -1.898269291055342e+00f,
-    9.883795548010862e-01f,
-    1.893435707059984e+00f,
-    -9.719255256068139e-01f,
-    /* Notch 500Hz */
-    9.868127002744672e-01f,
-    -1.877029297917697e+00f,
-    9.868127002744672e-01f,
-    1.872234710942891e+00f,
-    -9.688308135741293e-01f,
+    7.795634051646255e-02f,
+    1.559126810329251e-01f,
+    7.795634051646255e-02f,
+    1.320913430819426e+00f,
+    -6.327387928852763e-01f,
+};
+
+/**
+ * Slow channel set in q31 format, scaled by 2^-2.
+ */
+const q31_t adc_filter_slow_coefficients_q31[ADC_FILTER_SLOW_TOTAL_COEFFS]
+    ADC_FILTER_FASTDATA = {
+    /* LPF Stage 1 */
+    33224361,
+    66448722,
+    33224361,
+    562962611,
+    -158989144,
+    /* LPF Stage 2 */
+    41852492,
+    83704983,
+    41852492,
+    709159998,
+    -339699053,
+};
+
+/**
+ * Slow channel set in q15 format, scaled by 2^-2.
+ */
+const q15_t
+    adc_filter_slow_coefficients_q15[ADC_FILTER_SLOW_Q15_TOTAL_COEFFS] ADC_FILTER_FASTDATA = {
+    /* LPF Stage 1 */
+    507,
+    0,
+    1014,
+    507,
+    8590,
+    -2426,
+    /* LPF Stage 2 */
+    639,
+    0,
+    1277,
+    639,
+    10821,
+    -5183,
+};
+
+/**
+ * DC gain of each stage of the slow channel set.
+ */
+const float32_t adc_filter_slow_stage_dc_gain[ADC_FILTER_SLOW_STAGES] = {
+    9.999999999999999e-01f,
+    1.000000000000000e+00f,
+};
+
+/**
+ * Mains fundamental frequency (Hz) of each bank.
+ */
+const uint16_t adc_filter_bank_mains_freq[ADC_FILTER_NUM_BANKS] = {
+    50U,
+    60U,
+    50U,
+    60U,
+};
+
+/**
+ * Decimator FIR coefficients of each sample rate (48 taps, /8).
+ */
+const float32_t
+    adc_filter_decimation_coefficients[ADC_FILTER_NUM_RATES]
+                                      [ADC_FILTER_DECIMATION_TAPS] ADC_FILTER_FASTDATA = {
+    /* Set 0: 1000 Hz, 50 Hz cutoff */
+    {
+        9.625721857335176e-04f,
+        8.387861878077213e-04f,
+        6.456008399821799e-04f,
+        2.821231519741301e-04f,
+        -3.671464958210942e-04f,
+        -1.393925755953351e-03f,
+        -2.823691296023650e-03f,
+        -4.577852546076312e-03f,
+        -6.449368012863519e-03f,
+        -8.099047665416968e-03f,
+        -9.076720750257403e-03f,
+        -8.867343610852653e-03f,
+        -6.957646118636693e-03f,
+        -2.914839364551589e-03f,
+        3.534028318821457e-03f,
+        1.243469724007322e-02f,
+        2.356212537139352e-02f,
+        3.640973177563659e-02f,
+        5.021602083195462e-02f,
+        6.402772925027497e-02f,
+        7.679307602413625e-02f,
+        8.747388802753486e-02f,
+        9.516211410219511e-02f,
+        9.918508830893527e-02f,
+        9.918508830893527e-02f,
+        9.516211410219511e-02f,
+        8.747388802753488e-02f,
+        7.679307602413624e-02f,
+        6.402772925027495e-02f,
+        5.021602083195462e-02f,
+        3.640973177563659e-02f,
+        2.356212537139352e-02f,
+        1.243469724007322e-02f,
+        3.534028318821456e-03f,
+        -2.914839364551589e-03f,
+        -6.957646118636693e-03f,
+        -8.867343610852651e-03f,
+        -9.076720750257403e-03f,
+        -8.099047665416963e-03f,
+        -6.449368012863512e-03f,
+        -4.577852546076309e-03f,
+        -2.823691296023647e-03f,
+        -1.393925755953352e-03f,
+        -3.671464958210940e-04f,
+        2.821231519741299e-04f,
+        6.456008399821795e-04f,
+        8.387861878077208e-04f,
+        9.625721857335176e-04f,
+    },
+    /* Set 1: 5000 Hz, 250 Hz cutoff */
+    {
+        9.625721857335176e-04f,
+        8.387861878077213e-04f,
+        6.456008399821799e-04f,
+        2.821231519741301e-04f,
+        -3.671464958210942e-04f,
+        -1.393925755953351e-03f,
+        -2.823691296023650e-03f,
+        -4.577852546076312e-03f,
+        -6.449368012863519e-03f,
+        -8.099047665416968e-03f,
+        -9.076720750257403e-03f,
+        -8.867343610852653e-03f,
+        -6.957646118636693e-03f,
+        -2.914839364551589e-03f,
+        3.534028318821457e-03f,
+        1.243469724007322e-02f,
+        2.356212537139352e-02f,
+        3.640973177563659e-02f,
+        5.021602083195462e-02f,
+        6.402772925027497e-02f,
+        7.679307602413625e-02f,
+        8.747388802753486e-02f,
+        9.516211410219511e-02f,
+        9.918508830893527e-02f,
+        9.918508830893527e-02f,
+        9.516211410219511e-02f,
+        8.747388802753488e-02f,
+        7.679307602413624e-02f,
+        6.402772925027495e-02f,
+        5.021602083195462e-02f,
+        3.640973177563659e-02f,
+        2.356212537139352e-02f,
+        1.243469724007322e-02f,
+        3.534028318821456e-03f,
+        -2.914839364551589e-03f,
+        -6.957646118636693e-03f,
+        -8.867343610852651e-03f,
+        -9.076720750257403e-03f,
+        -8.099047665416963e-03f,
+        -6.449368012863512e-03f,
+        -4.577852546076309e-03f,
+        -2.823691296023647e-03f,
+        -1.393925755953352e-03f,
+        -3.671464958210940e-04f,
+        2.821231519741299e-04f,
+        6.456008399821795e-04f,
+        8.387861878077208e-04f,
+        9.625721857335176e-04f,
+    },
+    /* Set 2: 10000 Hz, 500 Hz cutoff */
+    {
+        9.625721857335176e-04f,
+        8.387861878077213e-04f,
+        6.456008399821799e-04f,
+        2.821231519741301e-04f,
+        -3.671464958210942e-04f,
+        -1.393925755953351e-03f,
+        -2.823691296023650e-03f,
+        -4.577852546076312e-03f,
+        -6.449368012863519e-03f,
+        -8.099047665416968e-03f,
+        -9.076720750257403e-03f,
+        -8.867343610852653e-03f,
+        -6.957646118636693e-03f,
+        -2.914839364551589e-03f,
+        3.534028318821457e-03f,
+        1.243469724007322e-02f,
+        2.356212537139352e-02f,
+        3.640973177563659e-02f,
+        5.021602083195462e-02f,
+        6.402772925027497e-02f,
+        7.679307602413625e-02f,
+        8.747388802753486e-02f,
+        9.516211410219511e-02f,
+        9.918508830893527e-02f,
+        9.918508830893527e-02f,
+        9.516211410219511e-02f,
+        8.747388802753488e-02f,
+        7.679307602413624e-02f,
+        6.402772925027495e-02f,
+        5.021602083195462e-02f,
+        3.640973177563659e-02f,
+        2.356212537139352e-02f,
+        1.243469724007322e-02f,
+        3.534028318821456e-03f,
+        -2.914839364551589e-03f,
+        -6.957646118636693e-03f,
+        -8.867343610852651e-03f,
+        -9.076720750257403e-03f,
+        -8.099047665416963e-03f,
+        -6.449368012863512e-03f,
+        -4.577852546076309e-03f,
+        -2.823691296023647e-03f,
+        -1.393925755953352e-03f,
+        -3.671464958210940e-04f,
+        2.821231519741299e-04f,
+        6.456008399821795e-04f,
+        8.387861878077208e-04f,
+        9.625721857335176e-04f,
+    },
+    /* Set 3: 25000 Hz, 500 Hz cutoff */
+    {
+        2.490364543091743e-04f,
+        4.509546308594363e-04f,
+        7.448795919201918e-04f,
+        1.188816795627221e-03f,
+        1.840431124466137e-03f,
+        2.753505413590671e-03f,
+        3.974422898233057e-03f,
+        5.538871079773627e-03f,
+        7.468957868461238e-03f,
+        9.770913333484571e-03f,
+        1.243352277456541e-02f,
+        1.542740050986101e-02f,
+        1.870517065623406e-02f,
+        2.220257357681854e-02f,
+        2.584046718885621e-02f,
+        2.952764370167197e-02f,
+        3.316433731228960e-02f,
+        3.664625947257386e-02f,
+        3.986896778379388e-02f,
+        4.273235414816758e-02f,
+        4.514502873293114e-02f,
+        4.702837917299989e-02f,
+        4.832009917985788e-02f,
+        4.897700659865373e-02f,
+        4.897700659865373e-02f,
+        4.832009917985788e-02f,
+        4.702837917299990e-02f,
+        4.514502873293113e-02f,
+        4.273235414816757e-02f,
+        3.986896778379389e-02f,
+        3.664625947257386e-02f,
+        3.316433731228959e-02f,
+        2.952764370167197e-02f,
+        2.584046718885621e-02f,
+        2.220257357681854e-02f,
+        1.870517065623406e-02f,
+        1.542740050986100e-02f,
+        1.243352277456541e-02f,
+        9.770913333484564e-03f,
+        7.468957868461231e-03f,
+        5.538871079773623e-03f,
+        3.974422898233053e-03f,
+        2.753505413590672e-03f,
+        1.840431124466135e-03f,
+        1.188816795627220e-03f,
+        7.448795919201913e-04f,
+        4.509546308594360e-04f,
+        2.490364543091743e-04f,
+    },
+    /* Set 4: 50000 Hz, 500 Hz cutoff */
+    {
+        2.246130746222548e-03f,
+        2.446811470528304e-03f,
+        2.898307173577453e-03f,
+        3.616801479188893e-03f,
+        4.611644811136279e-03f,
+        5.884827980816848e-03f,
+        7.430660333855109e-03f,
+        9.235666386398597e-03f,
+        1.127870831735276e-02f,
+        1.353133480149221e-02f,
+        1.595834968813748e-02f,
+        1.851858717386081e-02f,
+        2.116587360623553e-02f,
+        2.385015010022910e-02f,
+        2.651872494420977e-02f,
+        2.911762049043502e-02f,
+        3.159297600828354e-02f,
+        3.389246593672984e-02f,
+        3.596669217762867e-02f,
+        3.777050955537217e-02f,
+        3.926424532240823e-02f,
+        4.041477656401397e-02f,
+        4.119643346020391e-02f,
+        4.159170147168303e-02f,
+        4.159170147168303e-02f,
+        4.119643346020391e-02f,
+        4.041477656401397e-02f,
+        3.926424532240822e-02f,
+        3.777050955537216e-02f,
+        3.596669217762867e-02f,
+        3.389246593672984e-02f,
+        3.159297600828354e-02f,
+        2.911762049043501e-02f,
+        2.651872494420976e-02f,
+        2.385015010022910e-02f,
+        2.116587360623553e-02f,
+        1.851858717386081e-02f,
+        1.595834968813748e-02f,
+        1.353133480149220e-02f,
+        1.127870831735275e-02f,
+        9.235666386398588e-03f,
+        7.430660333855102e-03f,
+        5.884827980816852e-03f,
+        4.611644811136276e-03f,
+        3.616801479188891e-03f,
+        2.898307173577451e-03f,
+        2.446811470528302e-03f,
+        2.246130746222548e-03f,
+    },
 };
\ No newline at end of file
@@ -0,0 +1,160 @@
+/**
+ * @file adc_filter_mains.c
+ * @brief Mains frequency estimator implementation.
+ *
+ * Single-bin Goertzel filter with window-to-window phase tracking; see
+ * adc_filter_mains.h for the method.
+ */
+
+#include "adc_filter_mains.h"
+
+#include <math.h>
+
+/*******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/**
+ * @brief Close the current window and update the estimate.
+ *
+ * @param[in,out] mains Pointer to the estimator.
+ *
+ * @return true if the estimate was updated, false otherwise.
+ */
+static bool adc_filter_mains_end_window(adc_filter_mains_t *mains)
+{
+    /* Bin value, up to a phase factor that is the same for every window */
+    const float32_t re = mains->s1 - (mains->cos_w * mains->s2);
+    const float32_t im = mains->sin_w * mains->s2;
+
+    /* A tone of amplitude A gives |X| = A * N / 2 */
+    const float32_t min_magnitude = ADC_FILTER_MAINS_MIN_AMPLITUDE *
+                                    ((float32_t)mains->window / 2.0f);
+    bool updated = false;
+
+    mains->s1    = 0.0f;
+    mains->s2    = 0.0f;
+    mains->count = 0U;
+
+    if (((re * re) + (im * im)) < (min_magnitude * min_magnitude))
+    {
+        /* No usable mains pickup in this window */
+        mains->have_prev = false;
+        return false;
+    }
+
+    if (mains->have_prev)
+    {
+        /* Phase step: arg(X[k] * conj(X[k-1])) */
+        const float32_t dphi =
+            atan2f((im * mains->prev_re) - (re * mains->prev_im),
+                   (re * mains->prev_re) + (im * mains->prev_im));
+        const float32_t offset =
+            dphi * (float32_t)mains->sample_rate /
+            (2.0f * PI * (float32_t)mains->window);
+
+        if (fabsf(offset) <= ADC_FILTER_MAINS_MAX_DEVIATION)
+        {
+            mains->frequency_hz +=
+                ADC_FILTER_MAINS_SMOOTHING *
+                ((mains->nominal_hz + offset) - mains->frequency_hz);
+            updated = true;
+        }
+    }
+
+    mains->prev_re   = re;
+    mains->prev_im   = im;
+    mains->have_prev = true;
+
+    return updated;
+}
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void adc_filter_mains_init(adc_filter_mains_t *mains, float32_t nominal_hz,
+                           uint32_t sample_rate)
+{
+    float32_t w;
+
+    if ((mains == NULL) || (sample_rate < 5U))
+    {
+        return;
+    }
+
+    w = 2.0f * PI * nominal_hz / (float32_t)sample_rate;
+
+    mains->nominal_hz   = nominal_hz;
+    mains->sample_rate  = sample_rate;
+    mains->window       = ADC_FILTER_MAINS_WINDOW(sample_rate);
+    mains->cos_w        = cosf(w);
+    mains->sin_w        = sinf(w);
+    mains->coeff        = 2.0f * mains->cos_w;
+    mains->frequency_hz = nominal_hz;
+
+    adc_filter_mains_restart(mains);
+}
+
+bool adc_filter_mains_process(adc_filter_mains_t *mains,
+                              const float32_t *input, uint32_t block_size)
+{
+    bool      updated = false;
+    float32_t s1;
+    float32_t s2;
+
+    if ((mains == NULL) || (input == NULL))
+    {
+        return false;
+    }
+
+    s1 = mains->s1;
+    s2 = mains->s2;
+
+    for (uint32_t i = 0U; i < block_size; i++)
+    {
+        const float32_t s0 = input[i] + (mains->coeff * s1) - s2;
+
+        s2 = s1;
+        s1 = s0;
+
+        if (++mains->count >= mains->window)
+        {
+            mains->s1 = s1;
+            mains->s2 = s2;
+            updated   = adc_filter_mains_end_window(mains) || updated;
+            s1        = 0.0f;
+            s2        = 0.0f;
+        }
+    }
+
+    mains->s1 = s1;
+    mains->s2 = s2;
+
+    return updated;
+}
+
+void adc_filter_mains_restart(adc_filter_mains_t *mains)
+{
+    if (mains == NULL)
+    {
+        return;
+    }
+
+    mains->s1        = 0.0f;
+    mains->s2        = 0.0f;
+    mains->count     = 0U;
+    mains->prev_re   = 0.0f;
+    mains->prev_im   = 0.0f;
+    mains->have_prev = false;
+}
+
+float32_t adc_filter_mains_get_frequency(const adc_filter_mains_t *mains)
+{
+    if (mains == NULL)
+    {
+        return 0.0f;
+    }
+
+    return mains->frequency_hz;
+}
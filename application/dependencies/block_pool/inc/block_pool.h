@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Fixed-Block Pool
+ *
+ * Nothing is allocated from a heap, so every subsystem that hands out
+ * objects at run time keeps them in a static array. A pool turns such an
+ * array into an allocator: each block has a free list link, the free list
+ * head names the first free block, and allocation and release pop and
+ * push it in O(1) however many blocks there are.
+ *
+ * The head is swapped with a compare-and-swap (LDREX/STREX on the
+ * Cortex-M33), not under a lock, so tasks and interrupt handlers of any
+ * priority can allocate and free from the same pool. Its upper half is a
+ * tag counted up on every change: a pop preempted between reading the head
+ * and swapping it fails and retries even if the same block is back at the
+ * head by then.
+ *
+ * Every pool counts the blocks in use, their high-water mark and the
+ * allocations it refused because it was empty.
+ *
+ * A pool is defined over its blocks with BLOCK_POOL_DEFINE(), or over an
+ * existing array with BLOCK_POOL_INIT() where the blocks need a section of
+ * their own or a companion array indexed alike (block_pool_index()). Either
+ * way block_pool_init() links the free list before first use.
+ *
+ * Usage:
+ *
+ *   BLOCK_POOL_DEFINE(s_sample_pool, sample_block_t, 8U);
+ *
+ *   block_pool_init(&s_sample_pool);
+ *   sample_block_t *block = block_pool_alloc(&s_sample_pool);
+ *   ...
+ *   (void)block_pool_free(&s_sample_pool, block);
+ */
+
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Most blocks a pool can hold; the last index marks the end of the list */
+#define BLOCK_POOL_MAX_BLOCKS 0xFFFEU
+
+/**
+ * @brief Pool of fixed-size blocks
+ *
+ * Set up with BLOCK_POOL_INIT() or BLOCK_POOL_DEFINE(); the members are
+ * private to block_pool.c.
+ */
+typedef struct
+{
+    const char *name;       /**< Pool name, for the statistics */
+    uint8_t    *blocks;     /**< First block */
+    uint16_t   *links;      /**< Free list link per block */
+    size_t      block_size; /**< Distance between blocks, in bytes */
+    uint16_t    count;      /**< Blocks in the pool */
+    atomic_uint head;       /**< Tag << 16 | first free block */
+    atomic_uint used;       /**< Blocks allocated */
+    atomic_uint max_used;   /**< High-water mark of used */
+    atomic_uint failures;   /**< Allocations refused because it was empty */
+} block_pool_t;
+
+/**
+ * @brief Statistics of one pool
+ */
+typedef struct
+{
+    const char *name;     /**< Pool name */
+    uint16_t    count;    /**< Blocks in the pool */
+    uint16_t    used;     /**< Blocks allocated */
+    uint16_t    max_used; /**< High-water mark of used */
+    uint32_t    failures; /**< Allocations refused because it was empty */
+} block_pool_stats_t;
+
+/**
+ * @brief Initializer of a pool over existing arrays
+ *
+ * @param name_str    Pool name, a string literal
+ * @param block_array Array of the blocks
+ * @param link_array  uint16_t array with one entry per block
+ */
+#define BLOCK_POOL_INIT(name_str, block_array, link_array)                  \
+    {                                                                       \
+        .name       = (name_str),                                           \
+        .blocks     = (uint8_t *)(block_array),                             \
+        .links      = (link_array),                                         \
+        .block_size = sizeof((block_array)[0]),                             \
+        .count      = (uint16_t)(sizeof(link_array) /                       \
+                                 sizeof((link_array)[0])),                  \
+    }
+
+/**
+ * @brief Define a static pool of @p block_count blocks of @p block_type
+ *
+ * Defines the blocks, their links and the pool @p pool_name, named after
+ * itself.
+ */
+#define BLOCK_POOL_DEFINE(pool_name, block_type, block_count)           \
+    _Static_assert(((block_count) > 0U) &&                              \
+                       ((block_count) <= BLOCK_POOL_MAX_BLOCKS),        \
+                   "pool " #pool_name " has too many blocks");          \
+    static block_type   pool_name##_blocks[(block_count)];              \
+    static uint16_t     pool_name##_links[(block_count)];               \
+    static block_pool_t pool_name =                                     \
+        BLOCK_POOL_INIT(#pool_name, pool_name##_blocks, pool_name##_links)
+
+/**
+ * @brief Link all blocks of a pool into its free list
+ *
+ * Called once before the pool is used; every block becomes free and the
+ * statistics are cleared.
+ *
+ * @param[in,out] pool Pool
+ */
+void block_pool_init(block_pool_t *pool);
+
+/**
+ * @brief Take a block from a pool
+ *
+ * Lock-free; callable from tasks and interrupt handlers.
+ *
+ * @param[in,out] pool Pool
+ * @return The block, or NULL if the pool is empty
+ */
+void *block_pool_alloc(block_pool_t *pool);
+
+/**
+ * @brief Give a block back to its pool
+ *
+ * Lock-free; callable from tasks and interrupt handlers. A block must not
+ * be freed twice.
+ *
+ * @param[in,out] pool  Pool
+ * @param[in]     block Block taken from @p pool
+ * @return false if @p block is not a block of @p pool
+ */
+bool block_pool_free(block_pool_t *pool, void *block);
+
+/**
+ * @brief Position of a block in its pool
+ *
+ * @param[in] pool  Pool
+ * @param[in] block Block
+ * @return Index of @p block from 0, -1 if it is not a block of @p pool
+ */
+int32_t block_pool_index(const block_pool_t *pool, const void *block);
+
+/**
+ * @brief Check whether a pool has a free block
+ *
+ * A snapshot: another context may take the block before the caller does.
+ *
+ * @param[in] pool Pool
+ * @return true if block_pool_alloc() would find a block now
+ */
+bool block_pool_available(const block_pool_t *pool);
+
+/**
+ * @brief Read the statistics of a pool
+ *
+ * @param[in]  pool  Pool
+ * @param[out] stats Receives the statistics
+ */
+void block_pool_get_stats(const block_pool_t *pool, block_pool_stats_t *stats);
+
+#endif /* BLOCK_POOL_H */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Fixed-Block Pool
+ *
+ * The free list is a Treiber stack. A pop reads the head, the link of the
+ * block it names, and swaps the head for that link, tag counted up; if the
+ * head changed in between, an interrupt or a preempting task having popped
+ * or pushed, the swap fails and the pop starts over. The link it read may
+ * belong to a block taken meanwhile and be stale, but a stale link never
+ * reaches the head, as the tag of the head it was read under has moved on.
+ * A push links the block to the head it read and swaps likewise. The
+ * counters are updated apart from the head, after a pop and before a push,
+ * so a statistics snapshot may lag the free list but never counts more
+ * blocks in use than are off it. See block_pool.h.
+ */
+
+#include "block_pool.h"
+
+/* ==========================================================================
+ * Private Definitions
+ * ========================================================================== */
+
+/** Index marking the end of the free list */
+#define BLOCK_POOL_END 0xFFFFU
+
+/** Block index in a head */
+#define HEAD_INDEX(head) ((uint16_t)((head) & 0xFFFFU))
+
+/** Head naming block @p index, tagged one on from @p old */
+#define HEAD_NEXT(old, index) \
+    ((((old) + 0x10000U) & 0xFFFF0000U) | (unsigned int)(index))
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void block_pool_init(block_pool_t *pool)
+{
+    uint16_t i;
+
+    for (i = 0U; i < pool->count; i++)
+    {
+        pool->links[i] = (uint16_t)(i + 1U);
+    }
+    pool->links[pool->count - 1U] = BLOCK_POOL_END;
+
+    atomic_init(&pool->head, 0U);
+    atomic_init(&pool->used, 0U);
+    atomic_init(&pool->max_used, 0U);
+    atomic_init(&pool->failures, 0U);
+}
+
+void *block_pool_alloc(block_pool_t *pool)
+{
+    unsigned int head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    unsigned int used;
+    unsigned int peak;
+    uint16_t     index;
+
+    do
+    {
+        index = HEAD_INDEX(head);
+        if (index == BLOCK_POOL_END)
+        {
+            (void)atomic_fetch_add_explicit(&pool->failures, 1U,
+                                            memory_order_relaxed);
+            return NULL;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(
+        &pool->head, &head, HEAD_NEXT(head, pool->links[index]),
+        memory_order_acquire, memory_order_acquire));
+
+    used = atomic_fetch_add_explicit(&pool->used, 1U, memory_order_relaxed) +
+           1U;
+    peak = atomic_load_explicit(&pool->max_used, memory_order_relaxed);
+    while ((used > peak) &&
+           !atomic_compare_exchange_weak_explicit(&pool->max_used, &peak, used,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+    {
+        /* peak now holds the mark another context raised it to */
+    }
+
+    return &pool->blocks[(size_t)index * pool->block_size];
+}
+
+bool block_pool_free(block_pool_t *pool, void *block)
+{
+    int32_t      index = block_pool_index(pool, block);
+    unsigned int head;
+
+    if (index < 0)
+    {
+        return false;
+    }
+
+    /* Uncounted first, so used never exceeds the blocks off the list */
+    (void)atomic_fetch_sub_explicit(&pool->used, 1U, memory_order_relaxed);
+
+    head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    do
+    {
+        pool->links[index] = HEAD_INDEX(head);
+    } while (!atomic_compare_exchange_weak_explicit(
+        &pool->head, &head, HEAD_NEXT(head, (uint16_t)index),
+        memory_order_release, memory_order_relaxed));
+
+    return true;
+}
+
+int32_t block_pool_index(const block_pool_t *pool, const void *block)
+{
+    uintptr_t base   = (uintptr_t)pool->blocks;
+    uintptr_t offset = (uintptr_t)block - base;
+
+    if (((uintptr_t)block < base) || ((offset % pool->block_size) != 0U) ||
+        ((offset / pool->block_size) >= pool->count))
+    {
+        return -1;
+    }
+
+    return (int32_t)(offset / pool->block_size);
+}
+
+bool block_pool_available(const block_pool_t *pool)
+{
+    unsigned int head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+
+    return HEAD_INDEX(head) != BLOCK_POOL_END;
+}
+
+void block_pool_get_stats(const block_pool_t *pool, block_pool_stats_t *stats)
+{
+    stats->name  = pool->name;
+    stats->count = pool->count;
+    stats->used =
+        (uint16_t)atomic_load_explicit(&pool->used, memory_order_relaxed);
+    stats->max_used =
+        (uint16_t)atomic_load_explicit(&pool->max_used, memory_order_relaxed);
+    stats->failures =
+        (uint32_t)atomic_load_explicit(&pool->failures, memory_order_relaxed);
+}
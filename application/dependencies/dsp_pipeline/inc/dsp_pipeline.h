@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Block Processing Pipeline
+ *
+ * An acquisition path is a chain of stages: conversion, filtering,
+ * calibration, decimation, publishing and whatever follows. A pipeline
+ * declares that chain at compile time as a constant array of stages, with
+ * two ping-pong buffers between them, and dsp_pipeline_run() takes each
+ * channel of a block through every stage in turn, so the channel's samples
+ * stay in the cache from the first stage to the last.
+ *
+ * A stage sees the channel's current block and the ping-pong buffer the
+ * block is not in. It either
+ *
+ *   - reads the block and leaves it, a sink or a side path,
+ *   - changes the samples in place,
+ *   - writes its output into the free buffer and points the block at it,
+ *     the buffers then swapping roles for the next stage, or
+ *   - points the block at samples of its own, such as a DMA buffer, with
+ *     no copy.
+ *
+ * The block starts empty for the first stage of each channel, which
+ * produces it. The sample type is a contract between neighbouring stages;
+ * the buffers hold DSP_PIPELINE_DEFINE()'s block_bytes each, word aligned.
+ *
+ * Every stage is timed with the cycle counter of the pipeline: the cycles
+ * of all channels of a block add up to one time per block, kept as the
+ * last, shortest, longest and total time. The statistics are written by
+ * the task that runs the pipeline and read by any other with
+ * dsp_pipeline_get_stats(), consistently, under a sequence count.
+ *
+ * Usage:
+ *
+ *   DSP_PIPELINE_DEFINE(s_pipeline, 32U * sizeof(float32_t),
+ *                       BSP_CycleCounter_Read,
+ *                       {"convert", convert_block},
+ *                       {"filter", filter_block},
+ *                       {"publish", publish_block});
+ *
+ *   dsp_pipeline_init(&s_pipeline);
+ *   ...
+ *   dsp_pipeline_run(&s_pipeline, channels, &block_context);
+ */
+
+#ifndef DSP_PIPELINE_H
+#define DSP_PIPELINE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Most stages of a pipeline */
+#define DSP_PIPELINE_MAX_STAGES 16U
+
+/**
+ * @brief The block of one channel, as it goes from stage to stage
+ */
+typedef struct
+{
+    void    *data;   /**< Samples, NULL before the first stage */
+    uint32_t length; /**< Samples in data */
+} dsp_pipeline_block_t;
+
+/**
+ * @brief Process one channel's block
+ *
+ * @param[in]     context     Context given to dsp_pipeline_run(), the
+ *                            block being processed
+ * @param[in]     channel     Channel index
+ * @param[in,out] block       Current block; repointed by a stage that
+ *                            writes elsewhere
+ * @param[out]    free_buffer Ping-pong buffer @p block is not in
+ */
+typedef void (*dsp_pipeline_stage_fn_t)(void *context, uint32_t channel,
+                                        dsp_pipeline_block_t *block,
+                                        void                 *free_buffer);
+
+/**
+ * @brief One stage of a pipeline
+ */
+typedef struct
+{
+    const char             *name; /**< Stage name, for the statistics */
+    dsp_pipeline_stage_fn_t run;  /**< Called once per channel and block */
+} dsp_pipeline_stage_t;
+
+/**
+ * @brief Time statistics of one stage, over all channels of a block
+ */
+typedef struct
+{
+    uint32_t count;       /**< Blocks timed */
+    uint32_t last_cycles; /**< Time of the last block */
+    uint32_t min_cycles;  /**< Shortest time, 0 before the first block */
+    uint32_t max_cycles;  /**< Longest time */
+    uint64_t sum_cycles;  /**< Sum of the times, for the mean */
+} dsp_pipeline_stats_t;
+
+/**
+ * @brief Pipeline
+ *
+ * Set up with DSP_PIPELINE_DEFINE(); the members are private to
+ * dsp_pipeline.c.
+ */
+typedef struct
+{
+    const dsp_pipeline_stage_t *stages;       /**< Stages, in order */
+    dsp_pipeline_stats_t       *stats;        /**< Statistics per stage */
+    uint32_t                   *block_cycles; /**< Times of the block run */
+    uint32_t                   *buffers[2];   /**< Ping-pong buffers */
+    uint32_t (*cycles)(void);                 /**< Cycle counter */
+    uint32_t    stage_count;                  /**< Stages */
+    atomic_uint sequence;                     /**< Odd while stats change */
+} dsp_pipeline_t;
+
+/**
+ * @brief Define a static pipeline of the stages given
+ *
+ * Defines the pipeline @p name over the stages that follow, as
+ * dsp_pipeline_stage_t initializers, with ping-pong buffers of
+ * @p block_bytes each, timed with @p cycles_fn.
+ */
+#define DSP_PIPELINE_DEFINE(name, block_bytes, cycles_fn, ...)             \
+    static const dsp_pipeline_stage_t name##_stages[] = {__VA_ARGS__};     \
+    _Static_assert(DSP_PIPELINE_STAGES_OF(name) <= DSP_PIPELINE_MAX_STAGES, \
+                   "pipeline " #name " has too many stages");              \
+    static dsp_pipeline_stats_t name##_stats[DSP_PIPELINE_STAGES_OF(name)]; \
+    static uint32_t name##_block_cycles[DSP_PIPELINE_STAGES_OF(name)];     \
+    static uint32_t name##_buffers[2][((block_bytes) + 3U) / 4U];          \
+    static dsp_pipeline_t name = {                                         \
+        .stages       = name##_stages,                                     \
+        .stats        = name##_stats,                                      \
+        .block_cycles = name##_block_cycles,                               \
+        .buffers      = {name##_buffers[0], name##_buffers[1]},            \
+        .cycles       = (cycles_fn),                                       \
+        .stage_count  = (uint32_t)DSP_PIPELINE_STAGES_OF(name),            \
+    }
+
+/* Stages of the pipeline DSP_PIPELINE_DEFINE() is defining */
+#define DSP_PIPELINE_STAGES_OF(name) \
+    (sizeof(name##_stages) / sizeof(name##_stages[0]))
+
+/**
+ * @brief Clear the statistics of a pipeline
+ *
+ * Called once before the pipeline first runs.
+ *
+ * @param[in,out] pipeline Pipeline
+ */
+void dsp_pipeline_init(dsp_pipeline_t *pipeline);
+
+/**
+ * @brief Run one block through the pipeline
+ *
+ * Takes channel 0 through every stage, then channel 1, and so on, and
+ * adds the stage times of the block to the statistics. Called by one task
+ * only.
+ *
+ * @param[in,out] pipeline Pipeline
+ * @param[in]     channels Channels of the block
+ * @param[in]     context  Handed to every stage
+ */
+void dsp_pipeline_run(dsp_pipeline_t *pipeline, uint32_t channels,
+                      void *context);
+
+/**
+ * @brief Number of stages of a pipeline
+ *
+ * @param[in] pipeline Pipeline
+ * @return Stages
+ */
+uint32_t dsp_pipeline_stage_count(const dsp_pipeline_t *pipeline);
+
+/**
+ * @brief Name of a stage
+ *
+ * @param[in] pipeline Pipeline
+ * @param[in] stage    Stage index
+ * @return Name, NULL for an unknown stage
+ */
+const char *dsp_pipeline_stage_name(const dsp_pipeline_t *pipeline,
+                                    uint32_t              stage);
+
+/**
+ * @brief Read the time statistics of a stage
+ *
+ * Callable from any task; the copy is of one moment, between two blocks.
+ *
+ * @param[in]  pipeline Pipeline
+ * @param[in]  stage    Stage index
+ * @param[out] stats    Receives the statistics
+ * @return false for an unknown stage or a NULL @p stats
+ */
+bool dsp_pipeline_get_stats(dsp_pipeline_t *pipeline, uint32_t stage,
+                            dsp_pipeline_stats_t *stats);
+
+#endif /* DSP_PIPELINE_H */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Block Processing Pipeline
+ *
+ * The free buffer of a stage is the ping-pong buffer its block is not in,
+ * the first one when the block is in neither, so a stage writing into it
+ * never overwrites its own input. The stage times of a block are added up
+ * over its channels first and folded into the statistics once the block
+ * is through, between two steps of the sequence count: a reader that sees
+ * the count odd, or changed after its copy, copies again. See
+ * dsp_pipeline.h.
+ */
+
+#include "dsp_pipeline.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Ping-pong buffer a stage may write into
+ */
+static void *dsp_pipeline_free_buffer(const dsp_pipeline_t       *pipeline,
+                                      const dsp_pipeline_block_t *block)
+{
+    return (block->data == pipeline->buffers[0]) ? pipeline->buffers[1]
+                                                 : pipeline->buffers[0];
+}
+
+/**
+ * @brief Add the stage times of a block to the statistics
+ */
+static void dsp_pipeline_account(dsp_pipeline_t *pipeline)
+{
+    unsigned int sequence =
+        atomic_load_explicit(&pipeline->sequence, memory_order_relaxed);
+
+    atomic_store_explicit(&pipeline->sequence, sequence + 1U,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (uint32_t i = 0U; i < pipeline->stage_count; i++)
+    {
+        dsp_pipeline_stats_t *stats  = &pipeline->stats[i];
+        uint32_t              cycles = pipeline->block_cycles[i];
+
+        if ((stats->count == 0U) || (cycles < stats->min_cycles))
+        {
+            stats->min_cycles = cycles;
+        }
+        if (cycles > stats->max_cycles)
+        {
+            stats->max_cycles = cycles;
+        }
+        stats->count++;
+        stats->last_cycles = cycles;
+        stats->sum_cycles += cycles;
+    }
+
+    atomic_store_explicit(&pipeline->sequence, sequence + 2U,
+                          memory_order_release);
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void dsp_pipeline_init(dsp_pipeline_t *pipeline)
+{
+    (void)memset(pipeline->stats, 0,
+                 pipeline->stage_count * sizeof(dsp_pipeline_stats_t));
+    atomic_init(&pipeline->sequence, 0U);
+}
+
+void dsp_pipeline_run(dsp_pipeline_t *pipeline, uint32_t channels,
+                      void *context)
+{
+    (void)memset(pipeline->block_cycles, 0,
+                 pipeline->stage_count * sizeof(uint32_t));
+
+    for (uint32_t ch = 0U; ch < channels; ch++)
+    {
+        dsp_pipeline_block_t block = {NULL, 0U};
+        uint32_t             start = pipeline->cycles();
+
+        for (uint32_t i = 0U; i < pipeline->stage_count; i++)
+        {
+            uint32_t end;
+
+            pipeline->stages[i].run(context, ch, &block,
+                                    dsp_pipeline_free_buffer(pipeline, &block));
+
+            end = pipeline->cycles();
+            pipeline->block_cycles[i] += end - start;
+            start = end;
+        }
+    }
+
+    dsp_pipeline_account(pipeline);
+}
+
+uint32_t dsp_pipeline_stage_count(const dsp_pipeline_t *pipeline)
+{
+    return pipeline->stage_count;
+}
+
+const char *dsp_pipeline_stage_name(const dsp_pipeline_t *pipeline,
+                                    uint32_t              stage)
+{
+    if (stage >= pipeline->stage_count)
+    {
+        return NULL;
+    }
+
+    return pipeline->stages[stage].name;
+}
+
+bool dsp_pipeline_get_stats(dsp_pipeline_t *pipeline, uint32_t stage,
+                            dsp_pipeline_stats_t *stats)
+{
+    unsigned int before;
+    unsigned int after;
+
+    if ((stage >= pipeline->stage_count) || (stats == NULL))
+    {
+        return false;
+    }
+
+    do
+    {
+        before =
+            atomic_load_explicit(&pipeline->sequence, memory_order_acquire);
+        *stats = pipeline->stats[stage];
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&pipeline->sequence, memory_order_relaxed);
+    } while (((before & 1U) != 0U) || (before != after));
+
+    return true;
+}
@@ -20,41 +20,177 @@
 #define LWIP_SO_RCVTIMEO                1  /* Enable receive timeout for sockets */
 /* Use LWIP_COMPAT_SOCKETS=2 to provide actual functions instead of macros.
    This avoids conflicts with code that uses 'send', 'recv', 'select', etc.
-   as variable or function pointer names. */
+   as variable or function pointer names. The host simulation sets 0, so the
+   C library keeps read() and write(). */
+#ifndef LWIP_COMPAT_SOCKETS
 #define LWIP_COMPAT_SOCKETS             2
+#endif
 /* Stop LwIP from defining struct timeval, as <sys/time.h> already does it */
 #define LWIP_TIMEVAL_PRIVATE            0
 #define LWIP_ERRNO_STDINCLUDE           1
 
+/* netconn and socket calls run in the calling task under the core mutex
+   (a FreeRTOS mutex, so its holder inherits the priority of a waiting
+   TCP/IP thread) instead of being posted to the TCP/IP thread. Received
+   frames still go through the mailbox, in batches (ethernetif.c). Raw API
+   entry points check that their caller holds the mutex; set
+   SYS_ARCH_CHECK_CORE_LOCKING to 0 to leave the check out */
+#define LWIP_TCPIP_CORE_LOCKING         1
+#define LWIP_TCPIP_CORE_LOCKING_INPUT   0
+#define SYS_ARCH_CHECK_CORE_LOCKING     1
+#if SYS_ARCH_CHECK_CORE_LOCKING
+#define LWIP_MARK_TCPIP_THREAD()        sys_mark_tcpip_thread()
+#define LWIP_ASSERT_CORE_LOCKED()       sys_check_core_locking()
+#endif
+
 /* ------------------------------------------------
    3. Memory Options (Tailor to STM32H5 RAM)
    ------------------------------------------------ */
 #define MEM_ALIGNMENT                   4
-#define MEM_SIZE                        (4 * 1024) /* 4KB Heap - actual usage ~120 bytes max */
 #define MEMP_NUM_PBUF                   16
-#define MEMP_NUM_UDP_PCB                4
-#define MEMP_NUM_TCP_PCB                10
-#define MEMP_NUM_TCP_PCB_LISTEN         2   /* Only need 1-2 listening sockets */
-#define MEMP_NUM_NETCONN                10  /* Number of netconn structures */
-#define MEMP_NUM_SYS_TIMEOUT            10
-#define MEMP_NUM_TCP_SEG                32  /* TCP segments for queuing */
+#define LWIP_SUPPORT_CUSTOM_PBUF        1  /* Zero-copy RX pool in ethernetif.c */
+#define MEMP_NUM_UDP_PCB                10 /* DHCP, streams, two PTP ports, Modbus, RBE, snapshot, TWAMP */
+/* Modbus TCP connections: the four netconn workers, or those of the raw
+   API server (MODBUS_TCP_RAW_MAX_CONNECTIONS), set by CMake from
+   JERRY_MODBUS_TCP_RAW_CONNECTIONS */
+#ifndef MODBUS_TCP_PCBS
+#define MODBUS_TCP_PCBS                 4
+#endif
+/* Besides Modbus: two HTTP or WebSocket clients, one MQTT, two OPC UA, one
+   Modbus/TCP Security and one FOTA connection, one each for the trace,
+   NOR log, profile and Modbus capture streams, and four for connections
+   still closing */
+#define MEMP_NUM_TCP_PCB                (15 + MODBUS_TCP_PCBS)
+#define MEMP_NUM_TCP_PCB_LISTEN         5   /* Modbus, FOTA, HTTP, OPC UA and one spare */
+#define MEMP_NUM_NETCONN                17  /* Number of netconn structures, three OPC UA sockets */
+#define MEMP_NUM_SYS_TIMEOUT            12  /* Two for the network bring-up cache */
 
 /* ------------------------------------------------
    3b. TCP Tuning for Embedded Systems
    ------------------------------------------------ */
 #define TCP_MSS                         1460 /* Maximum segment size */
-#define TCP_WND                         (2 * TCP_MSS) /* Receive window size - reduced to limit memory */
-#define TCP_SND_BUF                     (2 * TCP_MSS) /* Send buffer size - reduced to prevent heap exhaustion */
-#define TCP_SND_QUEUELEN                8   /* Number of segments in send queue (must be > TCP_SNDQUEUELOWAT) */
-#define TCP_QUEUE_OOSEQ                 0   /* Disable out-of-order segment queuing to save memory */
 #define LWIP_TCP_SACK_OUT               0   /* Disable SACK to save memory */
 
 /* Reduce TIME_WAIT duration for faster connection recycling */
 #define TCP_MSL                         1000 /* 1 second MSL (default is 60000ms) */
 
+/* Per-listener backlog of not yet accepted connections and keepalive
+   probes (the Modbus server uses both) */
+#define TCP_LISTEN_BACKLOG              1
+#define LWIP_TCP_KEEPALIVE              1
+
 /* Enable send timeout to prevent blocking forever */
 #define LWIP_SO_SNDTIMEO                1
 
+/* Initial local ports and sequence numbers are drawn from LWIP_RAND(),
+   the secure entropy pool, so connections cannot be predicted */
+#define LWIP_RANDOMIZE_INITIAL_LOCAL_PORTS 1
+#define LWIP_HOOK_TCP_ISN(local_ip, local_port, remote_ip, remote_port) \
+    LWIP_RAND()
+
+/* ------------------------------------------------
+   3c. Network Tuning Profiles
+   ------------------------------------------------ */
+/* NET_PROFILE selects the buffer, window and timer set (CMake option
+   JERRY_NET_PROFILE):
+     NET_PROFILE_LOW_LATENCY - Modbus control loops: small windows, Nagle off
+                               on the Modbus connections, 100 ms TCP timer so
+                               delayed ACKs go out sooner.
+     NET_PROFILE_BALANCED    - Default: Modbus with Nagle off plus moderate
+                               bulk transfers (ADC streaming, firmware upload).
+     NET_PROFILE_BULK        - Large transfers: wide windows, out-of-order
+                               queueing, Nagle left on to coalesce writes.
+   NET_PROFILE_RAM_BUDGET bounds the RAM the profile reserves for the lwIP
+   heap, the PBUF_POOL, the TCP segment pool and the zero-copy RX pool
+   (ethernetif.c); NET_PROFILE_RAM_ESTIMATE below is checked against it.
+   The profiles are sized for four Modbus TCP connections; every one beyond
+   that (MODBUS_TCP_PCBS) adds MODBUS_TCP_CONN_MEM bytes of heap for the
+   responses tcp_write() copies, MODBUS_TCP_CONN_SEGS TCP segments to carry
+   them until they are acknowledged, and half a PBUF_POOL buffer for the
+   requests lwIP queues, to the pools and to the budget alike. */
+#define NET_PROFILE_LOW_LATENCY         1
+#define NET_PROFILE_BALANCED            2
+#define NET_PROFILE_BULK                3
+
+/* Two bursts of MODBUS_TCP_RAW_PIPELINE_DEPTH maximum-size responses
+   (260 bytes) in flight, with their pbuf headers */
+#define MODBUS_TCP_CONN_MEM             (2 * 1100)
+#define MODBUS_TCP_CONN_SEGS            2
+#define MODBUS_TCP_EXTRA_CONNS          ((MODBUS_TCP_PCBS > 4) ? (MODBUS_TCP_PCBS - 4) : 0)
+#define MODBUS_TCP_EXTRA_MEM            (MODBUS_TCP_EXTRA_CONNS * MODBUS_TCP_CONN_MEM)
+#define MODBUS_TCP_EXTRA_SEGS           (MODBUS_TCP_EXTRA_CONNS * MODBUS_TCP_CONN_SEGS)
+#define MODBUS_TCP_EXTRA_PBUFS          ((MODBUS_TCP_EXTRA_CONNS + 1) / 2)
+#define MODBUS_TCP_EXTRA_RAM            (MODBUS_TCP_EXTRA_MEM + \
+                                         (MODBUS_TCP_EXTRA_PBUFS * 1536) + \
+                                         (MODBUS_TCP_EXTRA_SEGS * 32))
+
+#ifndef NET_PROFILE
+#define NET_PROFILE                     NET_PROFILE_BALANCED
+#endif
+
+#if NET_PROFILE == NET_PROFILE_LOW_LATENCY
+#define NET_PROFILE_NAME                "low-latency"
+#define NET_PROFILE_RAM_BUDGET          ((40 * 1024) + MODBUS_TCP_EXTRA_RAM)
+#define NET_PROFILE_TCP_NODELAY         1
+#define MEM_SIZE                        ((6 * 1024) + MODBUS_TCP_EXTRA_MEM)
+#define PBUF_POOL_SIZE                  (12 + MODBUS_TCP_EXTRA_PBUFS)
+#define MEMP_NUM_TCP_SEG                (24 + MODBUS_TCP_EXTRA_SEGS)
+#define TCP_WND                         (2 * TCP_MSS)
+#define TCP_SND_BUF                     (2 * TCP_MSS)
+#define TCP_SND_QUEUELEN                8
+#define TCP_QUEUE_OOSEQ                 0
+#define TCP_TMR_INTERVAL                100 /* Delayed ACK flushed within 100 ms */
+#define ETH_RX_BUFFER_CNT               (8U)
+#elif NET_PROFILE == NET_PROFILE_BALANCED
+#define NET_PROFILE_NAME                "balanced"
+#define NET_PROFILE_RAM_BUDGET          ((64 * 1024) + MODBUS_TCP_EXTRA_RAM)
+#define NET_PROFILE_TCP_NODELAY         1
+#define MEM_SIZE                        ((10 * 1024) + MODBUS_TCP_EXTRA_MEM)
+#define PBUF_POOL_SIZE                  (16 + MODBUS_TCP_EXTRA_PBUFS)
+#define MEMP_NUM_TCP_SEG                (32 + MODBUS_TCP_EXTRA_SEGS)
+#define TCP_WND                         (4 * TCP_MSS)
+#define TCP_SND_BUF                     (4 * TCP_MSS)
+#define TCP_SND_QUEUELEN                16
+#define TCP_QUEUE_OOSEQ                 1
+#define TCP_OOSEQ_MAX_PBUFS             4
+#define TCP_TMR_INTERVAL                250
+#define ETH_RX_BUFFER_CNT               (12U)
+#elif NET_PROFILE == NET_PROFILE_BULK
+#define NET_PROFILE_NAME                "bulk"
+#define NET_PROFILE_RAM_BUDGET          ((96 * 1024) + MODBUS_TCP_EXTRA_RAM)
+#define NET_PROFILE_TCP_NODELAY         0
+#define MEM_SIZE                        ((16 * 1024) + MODBUS_TCP_EXTRA_MEM)
+#define PBUF_POOL_SIZE                  (24 + MODBUS_TCP_EXTRA_PBUFS)
+#define MEMP_NUM_TCP_SEG                (64 + MODBUS_TCP_EXTRA_SEGS)
+#define TCP_WND                         (6 * TCP_MSS)
+#define TCP_SND_BUF                     (8 * TCP_MSS)
+#define TCP_SND_QUEUELEN                32
+#define TCP_QUEUE_OOSEQ                 1
+#define TCP_OOSEQ_MAX_PBUFS             8
+#define TCP_TMR_INTERVAL                250
+#define ETH_RX_BUFFER_CNT               (16U)
+#else
+#error "NET_PROFILE must be NET_PROFILE_LOW_LATENCY, _BALANCED or _BULK"
+#endif
+
+/* Static RAM reserved by the profile. Pool elements are rounded up to cover
+   the memp/pbuf headers: 1536 bytes per PBUF_POOL buffer, 32 bytes per TCP
+   segment, 1568 bytes per RX pool entry (buffer plus pbuf_custom). */
+#define NET_PROFILE_RAM_ESTIMATE        (MEM_SIZE + \
+                                         (PBUF_POOL_SIZE * 1536) + \
+                                         (MEMP_NUM_TCP_SEG * 32) + \
+                                         (ETH_RX_BUFFER_CNT * 1568))
+
+#if NET_PROFILE_RAM_ESTIMATE > NET_PROFILE_RAM_BUDGET
+#error "Network profile exceeds NET_PROFILE_RAM_BUDGET"
+#endif
+
+/* The receive window must fit in the RX pool with every DMA descriptor
+   still armed, or the peer can stall the link by filling the window. */
+#if (TCP_WND / TCP_MSS) + 4 > ETH_RX_BUFFER_CNT
+#error "TCP_WND exceeds what the zero-copy RX pool can hold"
+#endif
+
 /* ------------------------------------------------
    4. IP Version Support
    ------------------------------------------------ */
@@ -69,26 +205,48 @@
 #define LWIP_ICMP                       1
 #define LWIP_RAW                        1
 #define LWIP_DHCP                       1
+#define DHCP_DOES_ARP_CHECK             0  /* No probe of a lease, net_cache.h */
+#define ETHARP_SUPPORT_STATIC_ENTRIES   1  /* SCADA master entry, net_cache.h */
 #define LWIP_DNS                        1
+#define LWIP_IGMP                       1  /* Drives the MAC multicast filter */
 
 /* ------------------------------------------------
    6. Checksum Offload (STM32H5 Hardware)
    ------------------------------------------------ */
-/* If your ethernetif.c driver handles checksums, set these to 0.
-   If you aren't sure, set to 1 (Software Checksum) to be safe. */
+/* ETHIF_CHECKSUM_OFFLOAD = 1: the ETH MAC inserts the IPv4 header and
+   TCP/UDP/ICMP checksums on transmit (TxConfig in ethernetif.c) and verifies
+   them on receive, dropping bad frames (MX_ETH_Init), so lwIP skips them.
+   Set to 0 to compute and check every checksum in software. */
+#ifndef ETHIF_CHECKSUM_OFFLOAD
+#define ETHIF_CHECKSUM_OFFLOAD          1
+#endif
+
+#if ETHIF_CHECKSUM_OFFLOAD
+#define CHECKSUM_GEN_IP                 0
+#define CHECKSUM_GEN_UDP                0
+#define CHECKSUM_GEN_TCP                0
+#define CHECKSUM_GEN_ICMP               0
+#define CHECKSUM_CHECK_IP               0
+#define CHECKSUM_CHECK_UDP              0
+#define CHECKSUM_CHECK_TCP              0
+#define CHECKSUM_CHECK_ICMP             0
+#else
 #define CHECKSUM_GEN_IP                 1
 #define CHECKSUM_GEN_UDP                1
 #define CHECKSUM_GEN_TCP                1
+#define CHECKSUM_GEN_ICMP               1
 #define CHECKSUM_CHECK_IP               1
 #define CHECKSUM_CHECK_UDP              1
 #define CHECKSUM_CHECK_TCP              1
+#define CHECKSUM_CHECK_ICMP             1
+#endif
 
 /* ------------------------------------------------
    7. FreeRTOS Specifics
    ------------------------------------------------ */
 #define TCPIP_THREAD_NAME               "tcpip_thread"
 #define TCPIP_THREAD_STACKSIZE          1024
-#define TCPIP_THREAD_PRIO               3
+#define TCPIP_THREAD_PRIO               TASK_PRIO_TCPIP
 #define TCPIP_MBOX_SIZE                 8
 
 #define DEFAULT_THREAD_STACKSIZE        1024
@@ -99,6 +257,7 @@
 #define DEFAULT_ACCEPTMBOX_SIZE         8
 
 #define LWIP_NETIF_LINK_CALLBACK        1
+#define LWIP_NETIF_STATUS_CALLBACK      1
 
 /* ------------------------------------------------
    8. Statistics (for debugging memory issues)
@@ -112,4 +271,13 @@
 #define TCP_STATS                       1  /* TCP statistics */
 #define IP_STATS                        1  /* IP statistics */
 
+/* LWIP_PROFILE = 1 (CMake option JERRY_LWIP_PROFILE): sys_arch.c also keeps
+   the deepest level and the refused posts of each mailbox class, and every
+   telemetry frame carries the size of each pool element and the sys_arch
+   pools, so tools/lwip_pool_profile.py can turn a recorded workload into
+   the values of this file */
+#ifndef LWIP_PROFILE
+#define LWIP_PROFILE                    0
+#endif
+
 #endif /* LWIP_LWIPOPTS_H */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * LwIP Architecture - Compiler/CPU definitions for the host simulation
+ */
+
+#ifndef LWIP_ARCH_CC_H
+#define LWIP_ARCH_CC_H
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+/* Define basic types for LwIP */
+typedef uint8_t   u8_t;
+typedef int8_t    s8_t;
+typedef uint16_t  u16_t;
+typedef int16_t   s16_t;
+typedef uint32_t  u32_t;
+typedef int32_t   s32_t;
+typedef uintptr_t mem_ptr_t;
+
+/* Define byte order - x86-64 and AArch64 hosts are little endian */
+#ifndef BYTE_ORDER
+#define BYTE_ORDER LITTLE_ENDIAN
+#endif
+
+/* Define (sn)printf formatters for these LwIP types: uint32_t is an
+ * 'unsigned int' on 64-bit hosts */
+#define U16_F "hu"
+#define S16_F "hd"
+#define X16_F "hx"
+#define U32_F PRIu32
+#define S32_F PRId32
+#define X32_F PRIx32
+#define SZT_F "zu"
+
+/* Compiler hints for packing structures */
+#define PACK_STRUCT_FIELD(x) x
+#define PACK_STRUCT_STRUCT   __attribute__((packed))
+#define PACK_STRUCT_BEGIN
+#define PACK_STRUCT_END
+
+/* Platform specific diagnostic output */
+#define LWIP_PLATFORM_DIAG(x) \
+    do                        \
+    {                         \
+        printf x;             \
+    } while (0)
+#define LWIP_PLATFORM_ASSERT(x)                                           \
+    do                                                                    \
+    {                                                                     \
+        printf("Assertion \"%s\" failed at line %d in %s\n", x, __LINE__, \
+               __FILE__);                                                 \
+        abort();                                                          \
+    } while (0)
+
+/* Memory pools and heap, plain arrays: the host has no SRAM banks */
+#define LWIP_DECLARE_MEMORY_ALIGNED(variable_name, size) \
+    u8_t variable_name[LWIP_MEM_ALIGN_BUFFER(size)]
+
+/* Error codes - use errno values */
+#define LWIP_ERRNO_INCLUDE    <errno.h>
+#define LWIP_ERRNO_STDINCLUDE 1
+
+/* Random number generation, from the host entropy (sys_arch.c) */
+u32_t sys_arch_random(void);
+#define LWIP_RAND() sys_arch_random()
+
+/* Compiler hints */
+#ifndef LWIP_NO_STDINT_H
+#define LWIP_NO_STDINT_H 0
+#endif
+
+#ifndef LWIP_NO_INTTYPES_H
+#define LWIP_NO_INTTYPES_H 0
+#endif
+
+#ifndef LWIP_NO_LIMITS_H
+#define LWIP_NO_LIMITS_H 0
+#endif
+
+#endif /* LWIP_ARCH_CC_H */
@@ -0,0 +1,289 @@
+/**
+ ******************************************************************************
+ * @file    ethernetif.c
+ * @brief   Host simulation LwIP Ethernet Interface on a Linux TAP device
+ * @note    Every simulated node opens its own TAP interface; bridging the
+ *          interfaces on the host puts the nodes on one segment. The link
+ *          is always up and frames carry no PTP hardware timestamps.
+ ******************************************************************************
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/if.h>
+#include <linux/if_tun.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "ethernetif.h"
+#include "lwip/etharp.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+#include "metrics.h"
+#include "netif/ethernet.h"
+#include "task.h"
+#include "task_priorities.h"
+
+#define INTERFACE_THREAD_STACK_SIZE (1024)
+#define IFNAME0                     's'
+#define IFNAME1                     't'
+
+/* Ethernet payload of a frame, as on the MAC */
+#define ETHIF_MAX_PAYLOAD (1500U)
+
+/* Largest frame read from the TAP device: payload, header and VLAN tag */
+#define ETHIF_FRAME_MAX (ETHIF_MAX_PAYLOAD + 18U)
+
+/* Frames read from the TAP device per input task wakeup */
+#define ETHIF_RX_BURST (8U)
+
+/* Interval of the link check; the TAP link never changes */
+#define ETHIF_LINK_POLL_MS (1000U)
+
+/* Environment variable naming the TAP interface, "tap<address>" otherwise */
+#define ETHIF_TAP_ENV "JERRY_SIM_TAP"
+
+static int               TapFd = -1;
+static StaticTask_t      InputTaskTCB;
+static StackType_t       InputTaskStack[INTERFACE_THREAD_STACK_SIZE];
+static volatile uint32_t RxFrameCount;
+static uint8_t          RxFrame[ETHIF_FRAME_MAX];
+static uint8_t          TxFrame[ETHIF_FRAME_MAX];
+
+static void ethernetif_input_task(void *argument);
+
+/* Open the TAP interface, non-blocking, without the packet info header */
+static int ethernetif_tap_open(void)
+{
+    struct ifreq ifr;
+    const char  *name = getenv(ETHIF_TAP_ENV);
+    int          fd;
+
+    fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+    if (fd < 0)
+    {
+        (void)printf("[ETH] /dev/net/tun: %s\n", strerror(errno));
+        return -1;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    if (name != NULL)
+    {
+        (void)snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", name);
+    }
+    else
+    {
+        (void)snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "tap%u",
+                       (unsigned int)BSP_GetDeviceAddress());
+    }
+
+    if (ioctl(fd, TUNSETIFF, &ifr) < 0)
+    {
+        (void)printf("[ETH] TAP %s: %s\n", ifr.ifr_name, strerror(errno));
+        (void)close(fd);
+        return -1;
+    }
+
+    (void)printf("[ETH] TAP %s\n", ifr.ifr_name);
+    return fd;
+}
+
+void ethernetif_get_mac_addr(uint8_t *mac_addr)
+{
+    /* Locally administered, unique per node address */
+    mac_addr[0] = 0x02U;
+    mac_addr[1] = (uint8_t)'J';
+    mac_addr[2] = (uint8_t)'R';
+    mac_addr[3] = 0x00U;
+    mac_addr[4] = 0x00U;
+    mac_addr[5] = BSP_GetDeviceAddress();
+}
+
+static void low_level_init(struct netif *netif)
+{
+    ethernetif_get_mac_addr(netif->hwaddr);
+    netif->hwaddr_len = ETH_HWADDR_LEN;
+    netif->mtu        = ETHIF_MAX_PAYLOAD;
+    netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+#if LWIP_IGMP
+    /* The TAP device passes every multicast frame, no filter to program */
+    netif->flags |= NETIF_FLAG_IGMP;
+#endif
+
+    TapFd = ethernetif_tap_open();
+
+    (void)xTaskCreateStatic(ethernetif_input_task, "EthIf",
+                            INTERFACE_THREAD_STACK_SIZE, netif,
+                            TASK_PRIO_ETHIF, InputTaskStack, &InputTaskTCB);
+}
+
+static err_t low_level_output(struct netif *netif, struct pbuf *p)
+{
+    u16_t   len;
+    ssize_t written;
+
+    (void)netif;
+
+    if ((TapFd < 0) || (p->tot_len > sizeof(TxFrame)))
+    {
+        metrics_add(METRIC_ETH_TX_ERR, 1U);
+        return ERR_IF;
+    }
+
+    len     = pbuf_copy_partial(p, TxFrame, p->tot_len, 0U);
+    written = write(TapFd, TxFrame, len);
+    if (written != (ssize_t)len)
+    {
+        metrics_add(METRIC_ETH_TX_ERR, 1U);
+        return ((written < 0) && (errno == EAGAIN)) ? ERR_MEM : ERR_IF;
+    }
+
+    return ERR_OK;
+}
+
+static struct pbuf *low_level_input(struct netif *netif)
+{
+    struct pbuf *p;
+    ssize_t      len;
+
+    (void)netif;
+
+    len = read(TapFd, RxFrame, sizeof(RxFrame));
+    if (len <= 0)
+    {
+        return NULL;
+    }
+
+    RxFrameCount++;
+    p = pbuf_alloc(PBUF_RAW, (u16_t)len, PBUF_POOL);
+    if (p == NULL)
+    {
+        metrics_add(METRIC_ETH_RX_NO_BUFFER, 1U);
+        return NULL;
+    }
+
+    (void)pbuf_take(p, RxFrame, (u16_t)len);
+    return p;
+}
+
+void ethernetif_input(struct netif *netif)
+{
+    struct pbuf *p;
+    uint32_t     n;
+
+    for (n = 0U; n < ETHIF_RX_BURST; n++)
+    {
+        p = low_level_input(netif);
+        if (p == NULL)
+        {
+            break;
+        }
+
+        if (netif->input(p, netif) != ERR_OK)
+        {
+            metrics_add(METRIC_ETH_RX_DROPPED, 1U);
+            pbuf_free(p);
+        }
+    }
+}
+
+static void ethernetif_input_task(void *argument)
+{
+    struct netif *netif = (struct netif *)argument;
+
+    if (TapFd < 0)
+    {
+        /* No device: the interface stays up and silent */
+        vTaskSuspend(NULL);
+    }
+
+    for (;;)
+    {
+        uint32_t before = RxFrameCount;
+
+        ethernetif_input(netif);
+
+        /* The TAP device is polled: a tick between empty reads */
+        if (RxFrameCount == before)
+        {
+            vTaskDelay(1U);
+        }
+    }
+}
+
+err_t ethernetif_init(struct netif *netif)
+{
+    LWIP_ASSERT("netif != NULL", (netif != NULL));
+#if LWIP_NETIF_HOSTNAME
+    netif->hostname = "lwip";
+#endif
+    netif->name[0]    = IFNAME0;
+    netif->name[1]    = IFNAME1;
+    netif->output     = etharp_output;
+    netif->linkoutput = low_level_output;
+    low_level_init(netif);
+    return ERR_OK;
+}
+
+uint32_t ethernetif_get_rx_int_count(void) { return RxFrameCount; }
+
+uint32_t ethernetif_get_rx_stall_max_us(void) { return 0U; }
+
+bool ethernetif_ptp_rx_stamp(uint16_t sequence_id, uint64_t *time_ns)
+{
+    (void)sequence_id;
+    (void)time_ns;
+    return false;
+}
+
+bool ethernetif_ptp_tx_stamp(uint16_t sequence_id, uint64_t *time_ns)
+{
+    (void)sequence_id;
+    (void)time_ns;
+    return false;
+}
+
+/* A TAP device has no tagging MAC; frames leave untagged */
+void ethernetif_set_vlan(const ethernetif_vlan_config_t *config)
+{
+    (void)config;
+}
+
+void ethernetif_check_link(struct netif *netif)
+{
+    if (!netif_is_link_up(netif))
+    {
+        LOCK_TCPIP_CORE();
+        netif_set_up(netif);
+        netif_set_link_up(netif);
+        UNLOCK_TCPIP_CORE();
+    }
+}
+
+bool ethernetif_wait_link_event(void)
+{
+    vTaskDelay(pdMS_TO_TICKS(ETHIF_LINK_POLL_MS));
+    return false;
+}
+
+void ethernetif_phy_irq_handler(void) {}
+
+void ethernetif_poll(struct netif *netif) { ethernetif_input(netif); }
+
+void ethernet_link_thread(void *argument)
+{
+    struct netif *netif = (struct netif *)argument;
+
+    for (;;)
+    {
+        ethernetif_check_link(netif);
+        (void)ethernetif_wait_link_event();
+    }
+}
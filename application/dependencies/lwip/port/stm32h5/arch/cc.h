@@ -12,6 +12,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "bsp_sections.h"
+
 /* Define timeval structure for embedded (no sys/time.h) */
 #ifndef _TIMEVAL_DEFINED
 #define _TIMEVAL_DEFINED
@@ -66,12 +68,17 @@ typedef uintptr_t mem_ptr_t;
         while (1);                                                        \
     } while (0)
 
+/* Memory pools and heap, in the DMA bank with the Ethernet buffers */
+#define LWIP_DECLARE_MEMORY_ALIGNED(variable_name, size) \
+    u8_t variable_name[LWIP_MEM_ALIGN_BUFFER(size)] BSP_SECTION_NET_POOL
+
 /* Error codes - use errno values */
 #define LWIP_ERRNO_INCLUDE    <errno.h>
 #define LWIP_ERRNO_STDINCLUDE 1
 
-/* Random number generation */
-#define LWIP_RAND() ((u32_t)rand())
+/* Random number generation, from the secure entropy pool (sys_arch.c) */
+u32_t sys_arch_random(void);
+#define LWIP_RAND() sys_arch_random()
 
 /* Compiler hints */
 #ifndef LWIP_NO_STDINT_H
@@ -60,6 +60,46 @@ extern "C"
 
 #define sys_msleep(ms) vTaskDelay(pdMS_TO_TICKS(ms))
 
+    /**
+     * @brief Usage of one static kernel object pool
+     */
+    typedef struct
+    {
+        const char *name;     /**< Pool name ("mutex", "mbox_conn", ...) */
+        uint16_t    count;    /**< Objects in the pool */
+        uint16_t    depth;    /**< Mailbox depth, 0 for other objects */
+        uint16_t    used;     /**< Objects currently allocated */
+        uint16_t    max_used; /**< High-water mark of used */
+        uint16_t    err;      /**< Allocations refused because it was full */
+        uint16_t    size;     /**< Static RAM per object, in bytes */
+        uint16_t    max_fill; /**< Most messages a mailbox held (LWIP_PROFILE) */
+        uint16_t    full;     /**< Posts refused by a full mailbox
+                                   (LWIP_PROFILE) */
+    } sys_arch_pool_stats_t;
+
+    /**
+     * @brief Read the statistics of one sys_arch object pool
+     * @param index pool number, counting from 0
+     * @param stats receives the statistics
+     * @return 0 on success, -1 if index is past the last pool
+     */
+    int sys_arch_pool_stats(unsigned int index, sys_arch_pool_stats_t *stats);
+
+    /**
+     * @brief Record the calling task as the TCP/IP thread
+     * @note Called by lwIP at the start of the TCP/IP thread
+     *       (LWIP_MARK_TCPIP_THREAD)
+     */
+    void sys_mark_tcpip_thread(void);
+
+    /**
+     * @brief Assert that the caller may use the raw API
+     * @note Called by lwIP on entry to the raw API (LWIP_ASSERT_CORE_LOCKED).
+     *       Fails in an interrupt, and once the TCP/IP thread runs, in a task
+     *       not holding the core mutex
+     */
+    void sys_check_core_locking(void);
+
 #ifdef __cplusplus
 }
 #endif
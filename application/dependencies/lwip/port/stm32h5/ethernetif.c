@@ -18,9 +18,12 @@
 #define ETH_DEBUG(fmt, ...) ((void)0)
 #endif
 
+#include <stddef.h>
 #include <string.h>
 
 #include "FreeRTOS.h"
+#include "bsp.h"
+#include "bsp_sections.h"
 #include "ethernetif.h"
 #include "lan8742.h"
 #include "lwip/etharp.h"
@@ -28,19 +31,105 @@
 #include "lwip/opt.h"
 #include "lwip/pbuf.h"
 #include "lwip/stats.h"
+#include "lwip/sys.h"
 #include "lwip/tcpip.h"
 #include "lwip/timeouts.h"
 #include "main.h"
+#include "metrics.h"
 #include "netif/ethernet.h"
 #include "semphr.h"
 #include "stm32h5xx_hal.h"
 #include "task.h"
 
-#define ETHIF_TX_TIMEOUT            (2000U)
 #define INTERFACE_THREAD_STACK_SIZE (1024)
 #define IFNAME0                     's'
 #define IFNAME1                     't'
-#define ETH_RX_BUFFER_SIZE          (1536U)
+
+/* Zero-copy RX buffer pool, placed in the non-cacheable .eth_dma_mem region
+ * (ETH_DMA_MEM_SIZE bytes, see MPU_Config()). Frames larger than one buffer
+ * span several descriptors and arrive as a pbuf chain. Both can be
+ * overridden from the build. */
+#ifndef ETH_RX_BUFFER_CNT
+#define ETH_RX_BUFFER_CNT (12U)
+#endif
+#ifndef ETH_RX_BUFFER_SIZE
+#define ETH_RX_BUFFER_SIZE (1536U)
+#endif
+#define ETH_DMA_MEM_SIZE (32U * 1024U)
+
+/* Each TX descriptor carries up to two buffers (BUF1 and BUF2), so a frame
+ * can span at most twice as many pbufs as there are descriptors. */
+#define ETH_TX_BUFFER_MAX (ETH_TX_DESC_CNT * 2U)
+
+/* RX interrupt moderation: descriptors are refilled without IOC, so the DMA
+ * raises the receive interrupt from its watchdog this long after the first
+ * unreported frame (0 = interrupt on every frame). */
+#define ETHIF_RX_COALESCE_US (100U)
+
+/* Notification index the input task and the link waiter are woken on;
+ * neither task is notified by anything outside the driver */
+#define ETHIF_NOTIFY_INDEX (0U)
+
+/* Frames read from the DMA ring per input task wakeup */
+#define ETHIF_RX_BURST (8U)
+
+/* Busy RX: a wakeup that fills its whole burst masks the RX interrupt, and
+ * the input task polls the ring one burst at a time, paced by the tcpip
+ * thread draining each batch, until a burst leaves the ring empty
+ * (0 = always interrupt driven) */
+#define ETHIF_RX_POLL (1U)
+
+/* Frames handed to the tcpip thread but not yet processed (power of two) */
+#define ETHIF_RX_QUEUE_LEN (16U)
+
+/* DMACRIWTR watchdog unit: RWTU = 3 counts in steps of 2048 HCLK cycles */
+#define ETHIF_RX_RWTU        (3U)
+#define ETHIF_RX_RWTU_Pos    (16U)
+#define ETHIF_RX_RWTU_CYCLES (2048U)
+
+/* PTP event message timestamps kept per direction (power of two) */
+#define ETHIF_PTP_STAMPS (4U)
+
+/* Not a PTP event message */
+#define ETHIF_PTP_NONE (0xFFU)
+
+/* Offsets in a frame: IPv4 header in the Ethernet frame, PTP header fields
+ * after the UDP header */
+#define ETHIF_IP4_OFFSET     (14U)
+#define ETHIF_PTP_TYPE_OFF   (8U)
+#define ETHIF_PTP_SEQ_OFF    (8U + 30U)
+#define ETHIF_PTP_PEEK_LEN   (8U + 34U)
+#define ETHIF_NS_PER_S       (1000000000ULL)
+
+/* 802.1Q tag control: PCP above the 12-bit VLAN ID */
+#define ETHIF_VLAN_PCP_Pos (13U)
+#define ETHIF_VLAN_VID_Msk (0x0FFFU)
+
+/* Link check interval. The PHY interrupt (nINT on ETH_PHY_INT_Pin, see
+ * main.h) reports link down and auto-negotiation complete, so polling only
+ * backs up a missed edge; without it the link is polled as before. */
+#ifdef ETH_PHY_INT_Pin
+#define ETHIF_LINK_POLL_MS (1000U)
+#else
+#define ETHIF_LINK_POLL_MS (10U)
+#endif
+
+/* PHY interrupt priority, that of the ETH interrupt (masked by critical
+ * sections) */
+#define ETHIF_PHY_IRQ_PRIORITY (5U)
+
+/* Multicast hash filter bins (MACHT0R/MACHT1R), indexed by the upper 6 bits
+ * of the bit-reversed CRC-32 of the destination address */
+#define ETHIF_HASH_BINS (64U)
+
+/* Broadcast storm limit: beyond ETHIF_BCAST_LIMIT broadcast frames within
+ * ETHIF_BCAST_WINDOW_MS the MAC drops broadcasts for ETHIF_BCAST_HOLD_MS
+ * (0 = broadcasts are never blocked) */
+#ifndef ETHIF_BCAST_LIMIT
+#define ETHIF_BCAST_LIMIT (200U)
+#endif
+#define ETHIF_BCAST_WINDOW_MS (100U)
+#define ETHIF_BCAST_HOLD_MS   (1000U)
 
 /* MAC address is defined in ethernetif.h - single source of truth */
 
@@ -54,39 +143,132 @@ extern ETH_HandleTypeDef heth;
 /* TxConfig from main.c */
 extern ETH_TxPacketConfigTypeDef TxConfig;
 
-/* RX buffers in SRAM3 for cache coherency
- * IMPORTANT: We need MORE buffers than descriptors to handle the case where
- * some buffers are being processed by the application while DMA needs new ones.
- * Using 2x the descriptor count gives us headroom.
- */
-#define RX_BUFFER_COUNT (ETH_RX_DESC_CNT * 2)
-static uint8_t RxBuff[RX_BUFFER_COUNT][ETH_RX_BUFFER_SIZE]
-    __attribute__((section(".driver.eth_mac0_rx_buf"), aligned(32)));
+/* RX pool entry: the DMA buffer followed by the custom pbuf that lends it to
+ * lwIP. Buffers go straight from the DMA to the stack and return to the pool
+ * from rx_pbuf_free() when lwIP frees the pbuf.
+ * IMPORTANT: We need MORE buffers than descriptors, because buffers held by
+ * lwIP (queued frames, netconn receive mailboxes) cannot be refilled. */
+typedef struct
+{
+    uint8_t            buff[ETH_RX_BUFFER_SIZE];
+    struct pbuf_custom pbuf_custom;
+} __attribute__((aligned(32))) RxBuff_t;
+
+static RxBuff_t RxPool[ETH_RX_BUFFER_CNT]
+    __attribute__((section(".driver.eth_mac0_rx_buf")));
 
 /* Buffer tracking:
- * - RxBuffAssigned: Bitmask tracking which buffers are currently assigned to
- * DMA descriptors
- * - A buffer is "assigned" from when RxAllocateCallback returns it until
- * RxLinkCallback processes it
- * - After RxLinkCallback, the HAL clears BackupAddr0, and the next
- * RxAllocateCallback can reuse it
+ * - RxBuffInUse: bit N is set while RxPool[N] is attached to a DMA descriptor
+ *   or lent to lwIP, from RxAllocateCallback until rx_pbuf_free()
+ * - Updated under SYS_ARCH_PROTECT, which is interrupt safe: pbufs may be
+ *   freed from the TX complete interrupt (e.g. an ICMP echo reply sent from
+ *   the request buffer)
  */
-static volatile uint32_t RxBuffAssigned =
-    0; /* Bitmask: bit N = buffer N assigned to DMA */
-static volatile uint32_t CurrentRxBuffIdx = 0;
-
-static SemaphoreHandle_t RxPktSemaphore = NULL;
-static SemaphoreHandle_t TxPktSemaphore = NULL;
-static TaskHandle_t      EthIfThread    = NULL;
+#define RX_POOL_MASK (0xFFFFFFFFU >> (32U - ETH_RX_BUFFER_CNT))
+static volatile uint32_t RxBuffInUse = 0;
+
+/* RX stall (RBU) recovery:
+ * - RxStalled is set by HAL_ETH_ErrorCallback() on RBU, with the cycle
+ *   counter in RxStallStart, and wakes the input task
+ * - The input task refills the descriptors through HAL_ETH_ReadData() and
+ *   issues the receive poll demand; while the pool is empty, rx_pbuf_free()
+ *   wakes it again as soon as lwIP returns a buffer
+ * - No MAC or DMA restart is involved; RxStallMaxUs is the longest stall */
+static volatile uint32_t RxStalled    = 0;
+static volatile uint32_t RxStallStart = 0;
+static uint32_t          RxStallMaxUs = 0;
+
+_Static_assert((ETH_RX_BUFFER_CNT > ETH_RX_DESC_CNT) &&
+                   (ETH_RX_BUFFER_CNT <= 32U),
+               "ETH_RX_BUFFER_CNT must exceed ETH_RX_DESC_CNT and fit the "
+               "RxBuffInUse bitmask");
+_Static_assert((ETH_RX_BUFFER_SIZE % 32U) == 0U,
+               "ETH_RX_BUFFER_SIZE must keep RX buffers 32-byte aligned");
+_Static_assert((ETH_RX_BUFFER_SIZE >= 256U) &&
+                   (ETH_RX_BUFFER_SIZE <= (ETH_DMACRCR_RBSZ_Msk >>
+                                           ETH_DMACRCR_RBSZ_Pos)),
+               "ETH_RX_BUFFER_SIZE out of DMA buffer size range");
+_Static_assert(sizeof(RxPool) <= ETH_DMA_MEM_SIZE,
+               "RX pool does not fit the .eth_dma_mem region");
+
+/* TX buffer list handed to HAL_ETH_Transmit_IT().
+ * The HAL copies the list into the DMA descriptors before it returns and the
+ * DMA then reads the pbuf payloads directly, so one persistent list is enough.
+ * low_level_output() only runs with the lwIP core locked, and it only
+ * rewrites the entries a frame actually uses. Transmitted pbufs are released
+ * by the input task when HAL_ETH_TxCpltCallback() wakes it. */
+static ETH_BufferTypeDef TxBufferList[ETH_TX_BUFFER_MAX];
+
+/* PTP event message timestamps (see ethernetif.h), slot by sequence ID.
+ * Both are recorded by the input task, TX stamps as it releases sent
+ * frames; all accesses are under SYS_ARCH_PROTECT. */
+typedef struct
+{
+    uint64_t time_ns;
+    uint16_t sequence_id;
+    bool     valid;
+} PtpStamp_t;
+
+static PtpStamp_t PtpRxStamps[ETHIF_PTP_STAMPS];
+static PtpStamp_t PtpTxStamps[ETHIF_PTP_STAMPS];
+
+/* 802.1Q tags of the TX classes (see ethernetif.h), set by
+ * ethernetif_set_vlan() from any task and read by low_level_output(), both
+ * under SYS_ARCH_PROTECT */
+static bool     VlanTxEnabled = false;
+static uint16_t VlanTxTags[ETHERNETIF_TX_CLASS_COUNT];
+
+#if LWIP_IGMP
+/* Groups joined per hash bin; a bin stays set while any group uses it.
+ * Written by the IGMP MAC filter hook, tcpip thread only. */
+static uint8_t HashBinRefs[ETHIF_HASH_BINS];
+#endif
 
-/* Static semaphore buffers for FreeRTOS */
-static StaticSemaphore_t RxSemaphoreBuffer;
-static StaticSemaphore_t TxSemaphoreBuffer;
+/* Broadcast storm limit (ETHIF_BCAST_LIMIT), input task only */
+static TickType_t BcastWindowStart = 0;
+static uint32_t   BcastCount       = 0;
+static TickType_t BcastBlockedAt   = 0;
+static bool       BcastBlocked     = false;
+
+/* Received frames on their way to lwIP.
+ * The input task fills RxQueue one burst at a time and posts RxBatchMsg, a
+ * preallocated tcpip callback, once per batch instead of one mailbox message
+ * per frame. Only the input task advances RxQueueHead and only the tcpip
+ * thread advances RxQueueTail. RxBatchPending is set while RxBatchMsg is in
+ * the tcpip mailbox. RxBacklog asks the tcpip thread to wake the input task
+ * after draining, because the input task stopped with frames still waiting in
+ * the DMA ring. */
+static struct pbuf               *RxQueue[ETHIF_RX_QUEUE_LEN];
+static volatile uint32_t          RxQueueHead    = 0;
+static volatile uint32_t          RxQueueTail    = 0;
+static volatile uint32_t          RxBatchPending = 0;
+static volatile uint32_t          RxBacklog      = 0;
+static struct tcpip_callback_msg *RxBatchMsg     = NULL;
+
+/* RX interrupt masked while the input task polls (input task only) */
+static bool RxPolling = false;
+
+_Static_assert((ETHIF_RX_QUEUE_LEN & (ETHIF_RX_QUEUE_LEN - 1U)) == 0U,
+               "ETHIF_RX_QUEUE_LEN must be a power of two");
+_Static_assert(ETHIF_RX_BURST <= ETHIF_RX_QUEUE_LEN,
+               "ETHIF_RX_BURST must fit in the RX queue");
+
+/* Input task, notified on ETHIF_NOTIFY_INDEX for received frames, a
+ * stalled RX DMA, a freed RX buffer and completed transmissions. The
+ * notification counts, so events arriving while the task runs wake it
+ * again instead of being lost. TxReleasePending asks it to reclaim the
+ * completed TX descriptors. */
+static TaskHandle_t      EthIfThread      = NULL;
+static volatile uint32_t TxReleasePending = 0;
+
+/* Task in ethernetif_wait_link_event(), notified by the PHY interrupt */
+static TaskHandle_t volatile LinkWaiter = NULL;
 
 static lan8742_Object_t LAN8742;
 
 /* Forward declarations */
 static void    ethernetif_input_task(void *argument);
+static void    ethernetif_rx_deliver(void *ctx);
 static int32_t ETH_PHY_IO_Init(void);
 static int32_t ETH_PHY_IO_DeInit(void);
 static int32_t ETH_PHY_IO_ReadReg(uint32_t DevAddr, uint32_t RegAddr,
@@ -122,53 +304,276 @@ static int32_t ETH_PHY_IO_WriteReg(uint32_t DevAddr, uint32_t RegAddr,
 static int32_t ETH_PHY_IO_GetTick(void) { return (int32_t)HAL_GetTick(); }
 
 /**
- * @brief  Find buffer index from buffer address
- * @param  buff: Buffer address to find
- * @retval Buffer index or -1 if not found
+ * @brief  Wake the input task from an interrupt handler
  */
-static int32_t find_rx_buffer_index(uint8_t *buff)
+static void ethernetif_wake_from_isr(void)
 {
-    for (uint32_t i = 0; i < RX_BUFFER_COUNT; i++)
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if (EthIfThread != NULL)
     {
-        if (buff == &RxBuff[i][0])
+        vTaskNotifyGiveIndexedFromISR(EthIfThread, ETHIF_NOTIFY_INDEX,
+                                      &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+/**
+ * @brief  Find the RX pool entry owning a DMA buffer address
+ * @param  buff: Buffer address handed out by HAL_ETH_RxAllocateCallback()
+ * @retval Pool entry, or NULL if the address is not an RX pool buffer
+ */
+static RxBuff_t *rx_buff_from_addr(uint8_t *buff)
+{
+    uintptr_t base = (uintptr_t)&RxPool[0];
+    uintptr_t addr = (uintptr_t)buff;
+    uintptr_t offset = addr - base;
+
+    if ((addr < base) || ((offset % sizeof(RxBuff_t)) != 0U) ||
+        ((offset / sizeof(RxBuff_t)) >= ETH_RX_BUFFER_CNT))
+    {
+        return NULL;
+    }
+    return &RxPool[offset / sizeof(RxBuff_t)];
+}
+
+/**
+ * @brief  Custom pbuf free function - returns the buffer to the RX pool
+ * @param  p: The pbuf_custom embedded in an RX pool entry
+ */
+static void rx_pbuf_free(struct pbuf *p)
+{
+    RxBuff_t *rx =
+        (RxBuff_t *)((uint8_t *)p - offsetof(RxBuff_t, pbuf_custom));
+    uint32_t idx = (uint32_t)(rx - RxPool);
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    RxBuffInUse &= ~(1U << idx);
+    SYS_ARCH_UNPROTECT(lev);
+
+    /* A stalled RX DMA waits for exactly this buffer */
+    if ((RxStalled != 0U) && (EthIfThread != NULL))
+    {
+        if (xPortIsInsideInterrupt() != pdFALSE)
+        {
+            ethernetif_wake_from_isr();
+        }
+        else
         {
-            return (int32_t)i;
+            (void)xTaskNotifyGiveIndexed(EthIfThread, ETHIF_NOTIFY_INDEX);
         }
     }
-    return -1;
 }
 
 /**
  * @brief  HAL ETH RX Allocate Callback - Allocates buffer for DMA descriptor
  * @param  buff: Pointer to receive buffer pointer
  * @note   This is the KEY function for preventing RBU errors!
- *         We track which buffers are assigned to DMA and only return free ones.
- *         A buffer is marked as "assigned" here and freed in RxLinkCallback.
+ *         Only buffers neither attached to a descriptor nor held by lwIP are
+ *         returned; the lowest free one is found in constant time.
  */
 void HAL_ETH_RxAllocateCallback(uint8_t **buff)
 {
-    uint32_t startIdx = CurrentRxBuffIdx;
+    uint32_t free_mask;
+    uint32_t idx;
+    SYS_ARCH_DECL_PROTECT(lev);
 
-    /* Find a free buffer using round-robin search */
-    for (uint32_t i = 0; i < RX_BUFFER_COUNT; i++)
+    SYS_ARCH_PROTECT(lev);
+    free_mask = ~RxBuffInUse & RX_POOL_MASK;
+    if (free_mask != 0U)
     {
-        uint32_t idx  = (startIdx + i) % RX_BUFFER_COUNT;
-        uint32_t mask = (1U << idx);
+        idx = __CLZ(__RBIT(free_mask));
+        RxBuffInUse |= (1U << idx);
+        *buff = RxPool[idx].buff;
+    }
+    else
+    {
+        *buff = NULL;
+    }
+    SYS_ARCH_UNPROTECT(lev);
 
-        /* Check if buffer is free (not assigned to any descriptor) */
-        if ((RxBuffAssigned & mask) == 0)
-        {
-            /* Mark buffer as assigned to DMA */
-            RxBuffAssigned |= mask;
-            CurrentRxBuffIdx = (idx + 1) % RX_BUFFER_COUNT;
-            *buff            = &RxBuff[idx][0];
-            return;
-        }
+    if (*buff == NULL)
+    {
+        /* No buffer available - this will cause RBU error! */
+        ETH_DEBUG("RxAlloc FAILED! No free buffers");
+        metrics_add(METRIC_ETH_RX_NO_BUFFER, 1U);
+    }
+}
+
+/**
+ * @brief  Identify a PTP event message over UDP/IPv4
+ * @param  p: Frame, starting with the Ethernet header
+ * @param  sequence_id: Filled with the sequenceId of the message
+ * @retval PTP messageType, or ETHIF_PTP_NONE for any other frame
+ * @note   Reads through pbuf_copy_partial(), so headers split across
+ *         buffers are handled; safe in interrupt context.
+ */
+static uint8_t ethernetif_ptp_classify(const struct pbuf *p,
+                                       uint16_t          *sequence_id)
+{
+    uint8_t  hdr[ETHIF_IP4_OFFSET + 20U];
+    uint8_t *ip = &hdr[ETHIF_IP4_OFFSET];
+    uint8_t  udp[ETHIF_PTP_PEEK_LEN];
+    uint16_t udp_offset;
+
+    if (pbuf_copy_partial(p, hdr, sizeof(hdr), 0U) != sizeof(hdr))
+    {
+        return ETHIF_PTP_NONE;
+    }
+
+    /* EtherType IPv4, version 4, UDP, not a fragment */
+    if ((hdr[12] != 0x08U) || (hdr[13] != 0x00U) || ((ip[0] >> 4) != 4U) ||
+        (ip[9] != 17U) || (((ip[6] & 0x3FU) | ip[7]) != 0U))
+    {
+        return ETHIF_PTP_NONE;
     }
 
-    /* No buffer available - this will cause RBU error! */
-    ETH_DEBUG("RxAlloc FAILED! No free buffers");
-    *buff = NULL;
+    udp_offset = ETHIF_IP4_OFFSET + ((ip[0] & 0x0FU) * 4U);
+    if ((pbuf_copy_partial(p, udp, sizeof(udp), udp_offset) != sizeof(udp)) ||
+        ((((uint16_t)udp[2] << 8) | udp[3]) != ETHERNETIF_PTP_EVENT_PORT))
+    {
+        return ETHIF_PTP_NONE;
+    }
+
+    *sequence_id = (uint16_t)(((uint16_t)udp[ETHIF_PTP_SEQ_OFF] << 8) |
+                              udp[ETHIF_PTP_SEQ_OFF + 1U]);
+    return udp[ETHIF_PTP_TYPE_OFF] & 0x0FU;
+}
+
+/**
+ * @brief  Sort a frame into its TX class
+ * @param  p: Frame, starting with the Ethernet header
+ * @retval Class from the DSCP of an IPv4 frame; ARP is control traffic
+ */
+static ethernetif_tx_class_t ethernetif_tx_class(const struct pbuf *p)
+{
+    uint8_t hdr[ETHIF_IP4_OFFSET + 2U];
+
+    if (pbuf_copy_partial(p, hdr, sizeof(hdr), 0U) != sizeof(hdr))
+    {
+        return ETHERNETIF_TX_CLASS_DEFAULT;
+    }
+
+    if ((hdr[12] == 0x08U) && (hdr[13] == 0x06U))
+    {
+        return ETHERNETIF_TX_CLASS_CONTROL;
+    }
+    if ((hdr[12] != 0x08U) || (hdr[13] != 0x00U))
+    {
+        return ETHERNETIF_TX_CLASS_DEFAULT;
+    }
+
+    /* DSCP only, ECN left out */
+    switch (hdr[ETHIF_IP4_OFFSET + 1U] & 0xFCU)
+    {
+        case ETHERNETIF_TOS_CONTROL:
+            return ETHERNETIF_TX_CLASS_CONTROL;
+        case ETHERNETIF_TOS_BULK:
+            return ETHERNETIF_TX_CLASS_BULK;
+        default:
+            return ETHERNETIF_TX_CLASS_DEFAULT;
+    }
+}
+
+/**
+ * @brief  Keep the timestamp of a PTP event message
+ * @param  table: PtpRxStamps or PtpTxStamps
+ * @param  p: Frame carrying the message
+ * @param  stamp: MAC timestamp of the frame
+ */
+static void ethernetif_ptp_record(PtpStamp_t *table, const struct pbuf *p,
+                                  const ETH_TimeStampTypeDef *stamp)
+{
+    uint16_t    sequence_id;
+    PtpStamp_t *slot;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    if (ethernetif_ptp_classify(p, &sequence_id) == ETHIF_PTP_NONE)
+    {
+        return;
+    }
+
+    slot = &table[sequence_id & (ETHIF_PTP_STAMPS - 1U)];
+    SYS_ARCH_PROTECT(lev);
+    slot->time_ns = ((uint64_t)stamp->TimeStampHigh * ETHIF_NS_PER_S) +
+                    stamp->TimeStampLow;
+    slot->sequence_id = sequence_id;
+    slot->valid       = true;
+    SYS_ARCH_UNPROTECT(lev);
+}
+
+/**
+ * @brief  Collect a kept timestamp, freeing its slot
+ */
+static bool ethernetif_ptp_take(PtpStamp_t *table, uint16_t sequence_id,
+                                uint64_t *time_ns)
+{
+    PtpStamp_t *slot  = &table[sequence_id & (ETHIF_PTP_STAMPS - 1U)];
+    bool        found = false;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    if (slot->valid && (slot->sequence_id == sequence_id))
+    {
+        *time_ns    = slot->time_ns;
+        slot->valid = false;
+        found       = true;
+    }
+    SYS_ARCH_UNPROTECT(lev);
+
+    return found;
+}
+
+bool ethernetif_ptp_rx_stamp(uint16_t sequence_id, uint64_t *time_ns)
+{
+    return ethernetif_ptp_take(PtpRxStamps, sequence_id, time_ns);
+}
+
+bool ethernetif_ptp_tx_stamp(uint16_t sequence_id, uint64_t *time_ns)
+{
+    return ethernetif_ptp_take(PtpTxStamps, sequence_id, time_ns);
+}
+
+void ethernetif_set_vlan(const ethernetif_vlan_config_t *config)
+{
+    uint16_t vid;
+    uint16_t tags[ETHERNETIF_TX_CLASS_COUNT];
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    if (config == NULL)
+    {
+        return;
+    }
+
+    vid = config->vlan_id & ETHIF_VLAN_VID_Msk;
+    for (uint32_t i = 0U; i < ETHERNETIF_TX_CLASS_COUNT; i++)
+    {
+        tags[i] = (uint16_t)((uint16_t)(config->pcp[i] & ETHERNETIF_PCP_MAX)
+                             << ETHIF_VLAN_PCP_Pos) |
+                  vid;
+    }
+
+    SYS_ARCH_PROTECT(lev);
+    VlanTxEnabled = config->enabled;
+    (void)memcpy(VlanTxTags, tags, sizeof(VlanTxTags));
+
+    /* Receive: only this VLAN (any with ID 0) or untagged frames pass, and
+     * the tag is stripped before the frame reaches the DMA */
+    if (config->enabled)
+    {
+        HAL_ETH_SetRxVLANIdentifier(&heth, ETH_VLANTAGCOMPARISON_12BIT, vid);
+        MODIFY_REG(heth.Instance->MACVTR, ETH_MACVTR_EVLS,
+                   ETH_MACVTR_EVLS_ALWAYSSTRIP);
+        SET_BIT(heth.Instance->MACPFR, ETH_MACPFR_VTFE);
+    }
+    else
+    {
+        CLEAR_BIT(heth.Instance->MACPFR, ETH_MACPFR_VTFE);
+        CLEAR_BIT(heth.Instance->MACVTR, ETH_MACVTR_EVLS);
+        HAL_ETH_SetRxVLANIdentifier(&heth, ETH_VLANTAGCOMPARISON_12BIT, 0U);
+    }
+    SYS_ARCH_UNPROTECT(lev);
 }
 
 /**
@@ -177,8 +582,11 @@ void HAL_ETH_RxAllocateCallback(uint8_t **buff)
  * @param  pEnd: Pointer to end of pbuf chain
  * @param  buff: Pointer to received data buffer
  * @param  Length: Length of received data
- * @note   We copy data from DMA buffer to a new pbuf, then FREE the buffer
- *         so it can be reused by RxAllocateCallback.
+ * @note   The DMA buffer itself becomes the pbuf payload (no copy); the
+ *         buffer stays in use until lwIP frees the pbuf.
+ *         The HAL reads the timestamp of a frame from its context
+ *         descriptor before linking the frame's last buffer, so the stamp
+ *         is taken once the chain is complete and then marked consumed.
  */
 void HAL_ETH_RxLinkCallback(void **pStart, void **pEnd, uint8_t *buff,
                             uint16_t Length)
@@ -186,40 +594,245 @@ void HAL_ETH_RxLinkCallback(void **pStart, void **pEnd, uint8_t *buff,
     struct pbuf **ppStart = (struct pbuf **)pStart;
     struct pbuf **ppEnd   = (struct pbuf **)pEnd;
     struct pbuf  *p;
-    int32_t       bufIdx;
+    RxBuff_t     *rx;
 
-    /* Find buffer index and mark it as free */
-    bufIdx = find_rx_buffer_index(buff);
-    if (bufIdx >= 0)
+    rx = rx_buff_from_addr(buff);
+    if (rx == NULL)
     {
-        /* Clear the assigned bit - buffer is now free for reuse */
-        RxBuffAssigned &= ~(1U << bufIdx);
+        ETH_DEBUG("RxLink: unknown buffer %p", (void *)buff);
+        return;
     }
 
-    /* Allocate a pbuf for the received frame segment */
-    p = pbuf_alloc(PBUF_RAW, Length, PBUF_POOL);
+    /* Data Synchronization Barrier before handing the DMA buffer over */
+    __DSB();
+    rx->pbuf_custom.custom_free_function = rx_pbuf_free;
+    p = pbuf_alloced_custom(PBUF_RAW, Length, PBUF_REF, &rx->pbuf_custom,
+                            rx->buff, ETH_RX_BUFFER_SIZE);
 
-    if (p != NULL)
+    /* Chain the pbuf */
+    if (*ppStart == NULL)
     {
-        /* Data Synchronization Barrier before reading DMA buffer */
-        __DSB();
-        pbuf_take(p, buff, Length);
+        *ppStart = p;
+    }
+    else if (*ppEnd != NULL)
+    {
+        pbuf_cat(*ppEnd, p);
+    }
+    *ppEnd = p;
+
+    if (heth.RxDescList.TimeStamp.TimeStampHigh != UINT32_MAX)
+    {
+        ethernetif_ptp_record(PtpRxStamps, *ppStart,
+                              &heth.RxDescList.TimeStamp);
+        heth.RxDescList.TimeStamp.TimeStampHigh = UINT32_MAX;
+    }
+}
 
-        /* Chain the pbuf */
-        if (*ppStart == NULL)
+/**
+ * @brief  Switch RX interrupts to watchdog moderation after HAL_ETH_Start_IT
+ * @note   HAL_ETH_Start_IT() arms every RX descriptor with IOC. Clearing the
+ *         HAL's ItMode makes later refills omit it, so a burst of frames
+ *         raises one interrupt when the RX watchdog expires.
+ */
+static void ethernetif_rx_coalesce_start(void)
+{
+#if ETHIF_RX_COALESCE_US > 0U
+    uint32_t rwt = ((HAL_RCC_GetHCLKFreq() / 1000000U) * ETHIF_RX_COALESCE_US +
+                    (ETHIF_RX_RWTU_CYCLES - 1U)) /
+                   ETHIF_RX_RWTU_CYCLES;
+
+    if (rwt == 0U)
+    {
+        rwt = 1U;
+    }
+    else if (rwt > ETH_DMACRIWTR_RWT_Msk)
+    {
+        rwt = ETH_DMACRIWTR_RWT_Msk;
+    }
+
+    WRITE_REG(heth.Instance->DMACRIWTR,
+              (ETHIF_RX_RWTU << ETHIF_RX_RWTU_Pos) | rwt);
+    heth.RxDescList.ItMode = 0U;
+#endif
+}
+
+/**
+ * @brief  Set up the MAC receive filter
+ * @note   Passes frames to our own address (perfect filter, MACA0 from
+ *         HAL_ETH_Init()), broadcasts, and multicast groups joined through
+ *         IGMP (hash filter, empty until lwIP joins one). Everything else is
+ *         dropped by the MAC before it takes a descriptor.
+ */
+static void ethernetif_filter_init(void)
+{
+    ETH_MACFilterConfigTypeDef FilterConf;
+
+    HAL_ETH_GetMACFilterConfig(&heth, &FilterConf);
+    FilterConf.PromiscuousMode     = DISABLE;
+    FilterConf.ReceiveAllMode      = DISABLE;
+    FilterConf.HachOrPerfectFilter = DISABLE;
+    FilterConf.HashUnicast         = DISABLE;
+    FilterConf.HashMulticast       = (LWIP_IGMP != 0) ? ENABLE : DISABLE;
+    FilterConf.PassAllMulticast    = DISABLE;
+    FilterConf.BroadcastFilter     = DISABLE;
+    HAL_ETH_SetMACFilterConfig(&heth, &FilterConf);
+
+    heth.Instance->MACHT0R = 0U;
+    heth.Instance->MACHT1R = 0U;
+}
+
+#if LWIP_IGMP
+/**
+ * @brief  Hash filter bin of a MAC address
+ * @param  mac: Destination address, ETH_HWADDR_LEN bytes
+ * @retval Bin, 0 to ETHIF_HASH_BINS - 1
+ */
+static uint32_t ethernetif_hash_bin(const uint8_t *mac)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (uint32_t i = 0U; i < ETH_HWADDR_LEN; i++)
+    {
+        crc ^= mac[i];
+        for (uint32_t bit = 0U; bit < 8U; bit++)
         {
-            *ppStart = p;
+            crc = (crc >> 1) ^ ((crc & 1U) ? 0xEDB88320U : 0U);
         }
-        else if (*ppEnd != NULL)
+    }
+    return __RBIT(~crc) >> 26;
+}
+
+/**
+ * @brief  IGMP MAC filter hook: pass or drop the frames of a group
+ * @param  netif: The interface
+ * @param  group: IPv4 multicast group
+ * @param  action: NETIF_ADD_MAC_FILTER or NETIF_DEL_MAC_FILTER
+ * @retval ERR_OK, or ERR_ARG for a group that was not added
+ * @note   Groups are mapped to 01:00:5E plus the low 23 bits of the group
+ *         address. Groups sharing a bin let each other's frames through;
+ *         lwIP drops those.
+ */
+static err_t ethernetif_igmp_mac_filter(struct netif *netif,
+                                        const ip4_addr_t *group,
+                                        enum netif_mac_filter_action action)
+{
+    const uint8_t mac[ETH_HWADDR_LEN] = {
+        0x01U, 0x00U, 0x5EU, (uint8_t)(ip4_addr2(group) & 0x7FU),
+        ip4_addr3(group), ip4_addr4(group)};
+    uint32_t bin  = ethernetif_hash_bin(mac);
+    uint32_t mask = 1UL << (bin & 31U);
+    volatile uint32_t *table =
+        (bin < 32U) ? &heth.Instance->MACHT0R : &heth.Instance->MACHT1R;
+
+    (void)netif;
+
+    if (action == NETIF_ADD_MAC_FILTER)
+    {
+        if (HashBinRefs[bin] == UINT8_MAX)
         {
-            pbuf_cat(*ppEnd, p);
+            return ERR_MEM;
         }
-        *ppEnd = p;
+        HashBinRefs[bin]++;
+        *table |= mask;
     }
     else
     {
-        ETH_DEBUG("pbuf_alloc FAILED!");
+        if (HashBinRefs[bin] == 0U)
+        {
+            return ERR_ARG;
+        }
+        HashBinRefs[bin]--;
+        if (HashBinRefs[bin] == 0U)
+        {
+            *table &= ~mask;
+        }
+    }
+    return ERR_OK;
+}
+#endif /* LWIP_IGMP */
+
+/**
+ * @brief  Count a received broadcast, blocking broadcasts in a storm
+ */
+static void ethernetif_bcast_count(void)
+{
+#if ETHIF_BCAST_LIMIT > 0U
+    TickType_t now = xTaskGetTickCount();
+
+    if ((now - BcastWindowStart) >= pdMS_TO_TICKS(ETHIF_BCAST_WINDOW_MS))
+    {
+        BcastWindowStart = now;
+        BcastCount       = 0U;
     }
+
+    BcastCount++;
+    if ((BcastCount > ETHIF_BCAST_LIMIT) && !BcastBlocked)
+    {
+        SET_BIT(heth.Instance->MACPFR, ETH_MACPFR_DBF);
+        BcastBlocked   = true;
+        BcastBlockedAt = now;
+        metrics_add(METRIC_ETH_BCAST_STORM, 1U);
+        ETH_DEBUG("Broadcast storm, blocking broadcasts");
+    }
+#endif
+}
+
+/**
+ * @brief  Accept broadcasts again once the storm hold time is over
+ * @param  wait: Ticks the input task is about to wait
+ * @retval wait, shortened to the end of the hold time
+ */
+static TickType_t ethernetif_bcast_release(TickType_t wait)
+{
+    TickType_t elapsed;
+    TickType_t hold = pdMS_TO_TICKS(ETHIF_BCAST_HOLD_MS);
+
+    if (!BcastBlocked)
+    {
+        return wait;
+    }
+
+    elapsed = xTaskGetTickCount() - BcastBlockedAt;
+    if (elapsed >= hold)
+    {
+        CLEAR_BIT(heth.Instance->MACPFR, ETH_MACPFR_DBF);
+        BcastBlocked     = false;
+        BcastWindowStart = xTaskGetTickCount();
+        BcastCount       = 0U;
+        return wait;
+    }
+    return ((hold - elapsed) < wait) ? (hold - elapsed) : wait;
+}
+
+/**
+ * @brief  Route the PHY link interrupts to nINT and its EXTI line
+ * @note   nINT stays low while a flag in ISFR is unmasked, until ISFR is
+ *         read. Flags are cleared before the falling edge is armed, so the
+ *         first change of link produces an edge.
+ */
+static void ethernetif_phy_int_init(void)
+{
+#ifdef ETH_PHY_INT_Pin
+    GPIO_InitTypeDef gpio = {0};
+
+    if ((LAN8742_EnableIT(&LAN8742, LAN8742_LINK_DOWN_IT |
+                                        LAN8742_AUTONEGO_COMPLETE_IT) !=
+         LAN8742_STATUS_OK) ||
+        (LAN8742_ClearIT(&LAN8742, 0U) != LAN8742_STATUS_OK))
+    {
+        ETH_DEBUG("PHY interrupt setup FAILED, polling the link");
+        return;
+    }
+
+    gpio.Pin  = ETH_PHY_INT_Pin;
+    gpio.Mode = GPIO_MODE_IT_FALLING;
+    gpio.Pull = GPIO_PULLUP;
+    HAL_GPIO_Init(ETH_PHY_INT_GPIO_Port, &gpio);
+    __HAL_GPIO_EXTI_CLEAR_FALLING_IT(ETH_PHY_INT_Pin);
+
+    HAL_NVIC_SetPriority(ETH_PHY_INT_EXTI_IRQn, ETHIF_PHY_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(ETH_PHY_INT_EXTI_IRQn);
+#endif
 }
 
 static void low_level_init(struct netif *netif)
@@ -232,36 +845,64 @@ static void low_level_init(struct netif *netif)
     ETH_DEBUG("low_level_init: Starting");
 
     /* Initialize buffer tracking - all buffers free */
-    RxBuffAssigned   = 0;
-    CurrentRxBuffIdx = 0;
+    RxBuffInUse = 0;
+
+    /* No RX timestamp pending (HAL_ETH_RxLinkCallback() checks it) */
+    heth.RxDescList.TimeStamp.TimeStampHigh = UINT32_MAX;
+
+    ethernetif_filter_init();
+
+    /* Size the DMA receive buffers to the RX pool (the DMA is not running
+     * yet; MX_ETH_Init() programmed the CubeMX default) */
+    heth.Init.RxBuffLen = ETH_RX_BUFFER_SIZE;
+    MODIFY_REG(heth.Instance->DMACRCR, ETH_DMACRCR_RBSZ,
+               ETH_RX_BUFFER_SIZE << ETH_DMACRCR_RBSZ_Pos);
 
     /* Get MAC address from Unique Device ID */
     ethernetif_get_mac_addr(netif->hwaddr);
     netif->hwaddr_len = ETH_HWADDR_LEN;
     netif->mtu        = ETH_MAX_PAYLOAD;
     netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+#if LWIP_IGMP
+    netif->flags |= NETIF_FLAG_IGMP;
+    netif_set_igmp_mac_filter(netif, ethernetif_igmp_mac_filter);
+#endif
 
     ETH_DEBUG("MAC: %02X:%02X:%02X:%02X:%02X:%02X", netif->hwaddr[0],
               netif->hwaddr[1], netif->hwaddr[2], netif->hwaddr[3],
               netif->hwaddr[4], netif->hwaddr[5]);
 
     memset(&TxConfig, 0, sizeof(ETH_TxPacketConfigTypeDef));
-    /* Disable hardware checksum offload - LwIP calculates checksums in software
-     * (CHECKSUM_GEN_* = 1 in lwipopts.h). Only enable CRC/PAD insertion. */
+#if ETHIF_CHECKSUM_OFFLOAD
+    /* Hardware checksum offload (lwipopts.h): the MAC inserts the IPv4 header
+     * checksum and computes the TCP/UDP/ICMP checksum including the pseudo
+     * header, so lwIP leaves those fields zero (CHECKSUM_GEN_* = 0). */
+    TxConfig.Attributes =
+        ETH_TX_PACKETS_FEATURES_CSUM | ETH_TX_PACKETS_FEATURES_CRCPAD;
+    TxConfig.ChecksumCtrl = ETH_CHECKSUM_IPHDR_PAYLOAD_INSERT_PHDR_CALC;
+#else
+    /* LwIP calculates checksums in software (CHECKSUM_GEN_* = 1 in
+     * lwipopts.h). Only enable CRC/PAD insertion. */
     TxConfig.Attributes   = ETH_TX_PACKETS_FEATURES_CRCPAD;
     TxConfig.ChecksumCtrl = ETH_CHECKSUM_DISABLE;
-    TxConfig.CRCPadCtrl   = ETH_CRC_PAD_INSERT;
+#endif
+    TxConfig.CRCPadCtrl = ETH_CRC_PAD_INSERT;
 
     /* Create semaphores */
-    RxPktSemaphore = xSemaphoreCreateBinaryStatic(&RxSemaphoreBuffer);
-    TxPktSemaphore = xSemaphoreCreateBinaryStatic(&TxSemaphoreBuffer);
+    /* RX batch delivery message; without it frames go to netif->input() one
+     * by one */
+    RxQueueHead    = 0;
+    RxQueueTail    = 0;
+    RxBatchPending = 0;
+    RxBacklog      = 0;
+    RxBatchMsg     = tcpip_callbackmsg_new(ethernetif_rx_deliver, netif);
 
     /* Create RX task */
     static StaticTask_t xTaskBuffer;
-    static StackType_t  xStack[INTERFACE_THREAD_STACK_SIZE];
+    static StackType_t  xStack[INTERFACE_THREAD_STACK_SIZE] BSP_SECTION_STACK;
     EthIfThread = xTaskCreateStatic(
         ethernetif_input_task, "EthIf", INTERFACE_THREAD_STACK_SIZE, netif,
-        configMAX_PRIORITIES - 1, xStack, &xTaskBuffer);
+        TASK_PRIO_ETHIF, xStack, &xTaskBuffer);
 
     /* Initialize PHY */
     LAN8742_RegisterBusIO(&LAN8742, &LAN8742_IOCtx);
@@ -272,6 +913,7 @@ static void low_level_init(struct netif *netif)
         netif_set_down(netif);
         return;
     }
+    ethernetif_phy_int_init();
 
     PHYLinkState = LAN8742_GetLinkState(&LAN8742);
 
@@ -322,6 +964,7 @@ static void low_level_init(struct netif *netif)
 
     if (hal_status == HAL_OK)
     {
+        ethernetif_rx_coalesce_start();
         netif_set_up(netif);
         netif_set_link_up(netif);
         ETH_DEBUG("ETH started, Link UP");
@@ -334,13 +977,24 @@ static void low_level_init(struct netif *netif)
     }
 }
 
+/**
+ * @brief  Queue one frame on the TX DMA ring without copying it
+ * @note   The pbuf chain is mapped onto TxBufferList and referenced until the
+ *         DMA has sent it. When the ring has no room the frame is dropped
+ *         with ERR_MEM instead of waiting for descriptors to drain, so the
+ *         tcpip thread never blocks here; TCP retransmits, and UDP senders
+ *         see the error.
+ */
 static err_t low_level_output(struct netif *netif, struct pbuf *p)
 {
     (void)netif;
     uint32_t          i = 0U;
     struct pbuf      *q;
-    ETH_BufferTypeDef Txbuffer[ETH_TX_DESC_CNT];
     HAL_StatusTypeDef tx_status;
+    uint16_t          sequence_id;
+    bool              vlan_enabled;
+    uint16_t          vlan_tag;
+    SYS_ARCH_DECL_PROTECT(lev);
 
     /* Update link statistics */
     LINK_STATS_INC(link.xmit);
@@ -352,41 +1006,70 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p)
               (unsigned)p->tot_len, data[0], data[1], data[2], data[3], data[4],
               data[5], data[12], data[13]);
 
-    memset(Txbuffer, 0, ETH_TX_DESC_CNT * sizeof(ETH_BufferTypeDef));
     for (q = p; q != NULL; q = q->next)
     {
-        if (i >= ETH_TX_DESC_CNT) return ERR_IF;
-        Txbuffer[i].buffer = q->payload;
-        Txbuffer[i].len    = q->len;
-        if (i > 0) Txbuffer[i - 1].next = &Txbuffer[i];
-        if (q->next == NULL) Txbuffer[i].next = NULL;
+        if (i >= ETH_TX_BUFFER_MAX)
+        {
+            LINK_STATS_INC(link.err);
+            metrics_add(METRIC_ETH_TX_ERR, 1U);
+            return ERR_IF;
+        }
+        TxBufferList[i].buffer = q->payload;
+        TxBufferList[i].len    = q->len;
+        TxBufferList[i].next   = (q->next != NULL) ? &TxBufferList[i + 1U] : NULL;
         i++;
     }
 
     TxConfig.Length   = p->tot_len;
-    TxConfig.TxBuffer = Txbuffer;
+    TxConfig.TxBuffer = TxBufferList;
     TxConfig.pData    = p;
     pbuf_ref(p);
 
+    /* 802.1Q tag of the frame's class, inserted by the MAC from a context
+     * descriptor */
+    SYS_ARCH_PROTECT(lev);
+    vlan_enabled = VlanTxEnabled;
+    vlan_tag     = VlanTxTags[ethernetif_tx_class(p)];
+    SYS_ARCH_UNPROTECT(lev);
+    if (vlan_enabled)
+    {
+        TxConfig.Attributes |= ETH_TX_PACKETS_FEATURES_VLANTAG;
+        TxConfig.VlanTag  = vlan_tag;
+        TxConfig.VlanCtrl = ETH_VLAN_INSERT;
+    }
+    else
+    {
+        TxConfig.Attributes &= ~ETH_TX_PACKETS_FEATURES_VLANTAG;
+    }
+
+    /* PTP event messages are stamped as they leave, see
+     * HAL_ETH_TxPtpCallback() */
+    if (ethernetif_ptp_classify(p, &sequence_id) != ETHIF_PTP_NONE)
+    {
+        (void)HAL_ETH_PTP_InsertTxTimestamp(&heth);
+    }
+
     /* Memory barrier before TX */
     __DSB();
 
     tx_status = HAL_ETH_Transmit_IT(&heth, &TxConfig);
-    while (tx_status != HAL_OK)
+    if (tx_status != HAL_OK)
     {
-        if (HAL_ETH_GetError(&heth) & HAL_ETH_ERROR_BUSY)
-        {
-            (void)xSemaphoreTake(TxPktSemaphore,
-                                 pdMS_TO_TICKS(ETHIF_TX_TIMEOUT));
-            HAL_ETH_ReleaseTxPacket(&heth);
-            tx_status = HAL_ETH_Transmit_IT(&heth, &TxConfig);
-        }
-        else
+        /* The HAL did not take the frame: drop the reference taken above */
+        pbuf_free(p);
+
+        if (heth.gState == HAL_ETH_STATE_STARTED)
         {
-            ETH_DEBUG("TX FAILED!");
-            pbuf_free(p);
-            return ERR_IF;
+            /* Not enough free descriptors; completed frames are reclaimed by
+             * HAL_ETH_TxCpltCallback() as the DMA drains the ring. */
+            LINK_STATS_INC(link.memerr);
+            return ERR_MEM;
         }
+
+        ETH_DEBUG("TX FAILED!");
+        LINK_STATS_INC(link.err);
+        metrics_add(METRIC_ETH_TX_ERR, 1U);
+        return ERR_IF;
     }
     return ERR_OK;
 }
@@ -402,6 +1085,12 @@ static struct pbuf *low_level_input(struct netif *netif)
         /* Update link statistics */
         LINK_STATS_INC(link.recv);
 
+        if ((p->len >= ETH_HWADDR_LEN) &&
+            (memcmp(p->payload, &ethbroadcast, ETH_HWADDR_LEN) == 0))
+        {
+            ethernetif_bcast_count();
+        }
+
         /* Log packet details including first bytes for protocol identification
          */
         uint8_t *data = (uint8_t *)p->payload;
@@ -424,6 +1113,7 @@ void ethernetif_input(struct netif *netif)
         if (err != ERR_OK)
         {
             ETH_DEBUG("netif->input FAILED: err=%d", (int)err);
+            metrics_add(METRIC_ETH_RX_DROPPED, 1U);
             pbuf_free(p);
         }
     }
@@ -436,31 +1126,228 @@ static volatile uint32_t RxIntCount = 0;
 static volatile uint32_t SemTakeCount      = 0;
 static volatile uint32_t PktProcessedCount = 0;
 
-static void ethernetif_input_task(void *argument)
+/**
+ * @brief  Deliver queued RX frames to lwIP (tcpip thread, via RxBatchMsg)
+ */
+static void ethernetif_rx_deliver(void *ctx)
 {
+    struct netif *netif = (struct netif *)ctx;
     struct pbuf  *p;
-    struct netif *netif = (struct netif *)argument;
 
-    for (;;)
+    /* Clear before draining so frames queued meanwhile post a new batch */
+    RxBatchPending = 0U;
+    __DMB();
+
+    while (RxQueueTail != RxQueueHead)
+    {
+        p = RxQueue[RxQueueTail & (ETHIF_RX_QUEUE_LEN - 1U)];
+        __DMB();
+        RxQueueTail++;
+
+        if (ethernet_input(p, netif) != ERR_OK)
+        {
+            ETH_DEBUG("ethernet_input FAILED!");
+            metrics_add(METRIC_ETH_RX_DROPPED, 1U);
+            pbuf_free(p);
+        }
+    }
+
+    if (RxBacklog != 0U)
     {
-        if (xSemaphoreTake(RxPktSemaphore, pdMS_TO_TICKS(5000)) == pdTRUE)
+        RxBacklog = 0U;
+        (void)xTaskNotifyGiveIndexed(EthIfThread, ETHIF_NOTIFY_INDEX);
+    }
+}
+
+/**
+ * @brief  Read one burst of frames from the DMA ring and hand it to lwIP
+ * @param  drained: Set if the burst left the DMA ring empty
+ * @retval pdTRUE if the batch could not be posted and must be retried soon
+ */
+static BaseType_t ethernetif_rx_burst(struct netif *netif, bool *drained)
+{
+    struct pbuf *p     = NULL;
+    uint32_t     count = 0U;
+
+    *drained = false;
+
+    if (RxBatchMsg == NULL)
+    {
+        do
         {
-            SemTakeCount++;
-            do
+            p = low_level_input(netif);
+            if (p != NULL)
             {
-                p = low_level_input(netif);
-                if (p != NULL)
+                PktProcessedCount++;
+                if (netif->input(p, netif) != ERR_OK)
                 {
-                    PktProcessedCount++;
-                    if (netif->input(p, netif) != ERR_OK)
-                    {
-                        ETH_DEBUG("netif->input FAILED!");
-                        pbuf_free(p);
-                    }
+                    ETH_DEBUG("netif->input FAILED!");
+                    metrics_add(METRIC_ETH_RX_DROPPED, 1U);
+                    pbuf_free(p);
                 }
-            } while (p != NULL);
+            }
+        } while (p != NULL);
+        *drained = true;
+        return pdFALSE;
+    }
+
+    while ((count < ETHIF_RX_BURST) &&
+           ((RxQueueHead - RxQueueTail) < ETHIF_RX_QUEUE_LEN))
+    {
+        p = low_level_input(netif);
+        if (p == NULL)
+        {
+            *drained = true;
+            break;
+        }
+        PktProcessedCount++;
+        RxQueue[RxQueueHead & (ETHIF_RX_QUEUE_LEN - 1U)] = p;
+        __DMB();
+        RxQueueHead++;
+        count++;
+    }
+
+    /* Frames may still be waiting in the DMA ring: resume once the tcpip
+     * thread has drained this batch rather than starving it */
+    if (!*drained)
+    {
+        RxBacklog = 1U;
+    }
+
+    if ((RxQueueHead != RxQueueTail) && (RxBatchPending == 0U))
+    {
+        RxBatchPending = 1U;
+        if (tcpip_callbackmsg_trycallback(RxBatchMsg) != ERR_OK)
+        {
+            /* tcpip mailbox full: keep the frames queued and retry */
+            RxBatchPending = 0U;
+            return pdTRUE;
         }
     }
+    return pdFALSE;
+}
+
+/**
+ * @brief  Resume a stalled RX DMA once descriptors have been refilled
+ * @retval pdTRUE while the DMA still has no descriptor to receive into
+ * @note   HAL_ETH_ReadData() has just run, refilling every descriptor the
+ *         pool has a buffer for. The tail pointer write is the receive
+ *         poll demand that takes the DMA out of its suspended state.
+ */
+static BaseType_t ethernetif_rx_stall_recover(void)
+{
+    uint32_t tail;
+    uint32_t cycles;
+    uint32_t us;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    if (RxStalled == 0U)
+    {
+        return pdFALSE;
+    }
+    if (heth.RxDescList.RxBuildDescCnt >= ETH_RX_DESC_CNT)
+    {
+        return pdTRUE;
+    }
+
+    tail = (heth.RxDescList.RxBuildDescIdx + ETH_RX_DESC_CNT - 1U) %
+           ETH_RX_DESC_CNT;
+    __DMB();
+    WRITE_REG(heth.Instance->DMACRDTPR, (uint32_t)(heth.Init.RxDesc + tail));
+
+    SYS_ARCH_PROTECT(lev);
+    cycles    = BSP_CycleCounter_Read() - RxStallStart;
+    RxStalled = 0U;
+    SYS_ARCH_UNPROTECT(lev);
+
+    us = cycles / (BSP_CycleCounter_Hz() / 1000000U);
+
+    if (us > RxStallMaxUs)
+    {
+        RxStallMaxUs = us;
+    }
+    metrics_add(METRIC_ETH_RX_RECOVERED, 1U);
+    metrics_add(METRIC_ETH_RX_STALL_US, us);
+    ETH_DEBUG("RX DMA resumed after %lu us", (unsigned long)us);
+    return pdFALSE;
+}
+
+/**
+ * @brief  Switch between interrupt driven and polled reception
+ * @param  drained: The last burst left the DMA ring empty
+ * @note   While the RX interrupt is masked its status bit still latches
+ *         (without setting the summary bit); the input task clears it before
+ *         each polled burst, so a frame completing after the burst that
+ *         emptied the ring raises the interrupt as soon as it is unmasked.
+ */
+static void ethernetif_rx_poll_update(bool drained)
+{
+#if ETHIF_RX_POLL
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    if (!RxPolling && !drained)
+    {
+        SYS_ARCH_PROTECT(lev);
+        __HAL_ETH_DMA_DISABLE_IT(&heth, ETH_DMACIER_RIE);
+        SYS_ARCH_UNPROTECT(lev);
+        RxPolling = true;
+        metrics_add(METRIC_ETH_RX_POLL, 1U);
+    }
+    else if (RxPolling && drained)
+    {
+        SYS_ARCH_PROTECT(lev);
+        __HAL_ETH_DMA_ENABLE_IT(&heth, ETH_DMACIER_RIE);
+        SYS_ARCH_UNPROTECT(lev);
+        RxPolling = false;
+    }
+    else
+    {
+        /* Mode unchanged */
+    }
+#else
+    (void)drained;
+#endif
+}
+
+static void ethernetif_input_task(void *argument)
+{
+    struct netif *netif = (struct netif *)argument;
+    TickType_t    wait  = pdMS_TO_TICKS(5000);
+    bool          drained;
+
+    for (;;)
+    {
+        /* Every event since the last pass is served by this one */
+        SemTakeCount +=
+            ulTaskNotifyTakeIndexed(ETHIF_NOTIFY_INDEX, pdTRUE, wait);
+
+        /* Completed TX descriptors are reclaimed here rather than in the
+         * interrupt. This task preempts every task that transmits, as the
+         * interrupt did, so the HAL TX bookkeeping still never runs twice
+         * at once, and the pbufs are freed outside interrupt context. */
+        if (TxReleasePending != 0U)
+        {
+            TxReleasePending = 0U;
+            (void)HAL_ETH_ReleaseTxPacket(&heth);
+        }
+
+        if (RxPolling)
+        {
+            __HAL_ETH_DMA_CLEAR_IT(&heth, ETH_DMACSR_RI);
+        }
+        wait = (ethernetif_rx_burst(netif, &drained) == pdTRUE)
+                   ? 1U
+                   : pdMS_TO_TICKS(5000);
+        ethernetif_rx_poll_update(drained);
+
+        /* Still stalled: rx_pbuf_free() wakes the task, the short timeout
+         * only covers a buffer freed before the stall was flagged */
+        if (ethernetif_rx_stall_recover() == pdTRUE)
+        {
+            wait = 1U;
+        }
+        wait = ethernetif_bcast_release(wait);
+    }
 }
 
 err_t ethernetif_init(struct netif *netif)
@@ -480,16 +1367,11 @@ err_t ethernetif_init(struct netif *netif)
 void HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *heth_param)
 {
     (void)heth_param;
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     RxIntCount++;
-    if (RxPktSemaphore)
-    {
-        xSemaphoreGiveFromISR(RxPktSemaphore, &xHigherPriorityTaskWoken);
-        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-    }
+    ethernetif_wake_from_isr();
 }
 
-/* Debug function to get semaphore take count */
+/* Debug function to get the count of input task wakeup events */
 uint32_t ethernetif_get_sem_take_count(void) { return SemTakeCount; }
 
 /* Debug function to get processed packet count */
@@ -497,20 +1379,20 @@ uint32_t ethernetif_get_pkt_processed_count(void) { return PktProcessedCount; }
 
 uint32_t ethernetif_get_rx_int_count(void) { return RxIntCount; }
 
+uint32_t ethernetif_get_rx_stall_max_us(void) { return RxStallMaxUs; }
+
 void HAL_ETH_TxCpltCallback(ETH_HandleTypeDef *heth_param)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-
-    /* Release transmitted packets - this calls HAL_ETH_TxFreeCallback for each
-     * completed packet, which frees the associated pbuf.
-     * CRITICAL: This must be called to prevent memory leaks! */
-    HAL_ETH_ReleaseTxPacket(heth_param);
-
-    if (TxPktSemaphore)
-    {
-        xSemaphoreGiveFromISR(TxPktSemaphore, &xHigherPriorityTaskWoken);
-        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-    }
+    /* Transmitted packets are released by the input task, which calls
+     * HAL_ETH_ReleaseTxPacket() and so HAL_ETH_TxFreeCallback for each
+     * completed packet, freeing its pbuf and returning its descriptors to
+     * the ring.
+     * CRITICAL: The release must happen to prevent memory leaks!
+     * The input task is the only place TX descriptors are reclaimed; the
+     * HAL release bookkeeping is not safe to run from two contexts at once. */
+    (void)heth_param;
+    TxReleasePending = 1U;
+    ethernetif_wake_from_isr();
 }
 
 /**
@@ -538,17 +1420,43 @@ void HAL_ETH_TxFreeCallback(uint32_t *buff)
     }
 }
 
+/**
+ * @brief  HAL ETH TX PTP Callback - Keeps the timestamp of a sent frame
+ * @param  buff: The pbuf of the frame, as in HAL_ETH_TxFreeCallback()
+ * @param  timestamp: MAC time the frame left at
+ * @note   Called from HAL_ETH_ReleaseTxPacket() before the pbuf is freed,
+ *         for frames queued with HAL_ETH_PTP_InsertTxTimestamp().
+ */
+void HAL_ETH_TxPtpCallback(uint32_t *buff, ETH_TimeStampTypeDef *timestamp)
+{
+    struct pbuf *p = (struct pbuf *)buff;
+
+    if (p != NULL)
+    {
+        ethernetif_ptp_record(PtpTxStamps, p, timestamp);
+    }
+}
+
 void HAL_ETH_ErrorCallback(ETH_HandleTypeDef *heth_param)
 {
     uint32_t error = HAL_ETH_GetDMAError(heth_param);
 
+    /* The HAL only sets the DMA error code when the DMA reports one; clear
+     * it so a later MAC error is not taken for a second RBU */
+    heth_param->DMAErrorCode = 0U;
+
     if (error & ETH_DMACSR_RBU)
     {
-        ETH_DEBUG("RBU Error - restarting RX DMA");
-        /* Restart RX DMA by writing tail pointer */
-        __DMB();
-        WRITE_REG(heth_param->Instance->DMACRDTPR,
-                  (uint32_t)(heth_param->Init.RxDesc + (ETH_RX_DESC_CNT - 1U)));
+        /* RX DMA suspended, out of descriptors: have the input task refill
+         * them and resume it, see ethernetif_rx_stall_recover() */
+        ETH_DEBUG("RBU Error - RX DMA suspended");
+        metrics_add(METRIC_ETH_RX_STALL, 1U);
+        if (RxStalled == 0U)
+        {
+            RxStallStart = BSP_CycleCounter_Read();
+            RxStalled    = 1U;
+        }
+        ethernetif_wake_from_isr();
     }
 
     if (error & ETH_DMACSR_TBU)
@@ -578,8 +1486,10 @@ void ethernetif_check_link(struct netif *netif)
     {
         ETH_DEBUG("Link DOWN");
         HAL_ETH_Stop_IT(&heth);
+        LOCK_TCPIP_CORE();
         netif_set_down(netif);
         netif_set_link_down(netif);
+        UNLOCK_TCPIP_CORE();
     }
     /* Link was down, now it's up */
     else if (!netif_is_link_up(netif) && is_phy_link_up(PHYLinkState))
@@ -615,9 +1525,9 @@ void ethernetif_check_link(struct netif *netif)
         MACConf.Speed      = speed;
         HAL_ETH_SetMACConfig(&heth, &MACConf);
 
-        /* Reset buffer tracking before starting ETH */
-        RxBuffAssigned   = 0;
-        CurrentRxBuffIdx = 0;
+        /* Buffer tracking is kept across the restart: descriptors keep the
+         * buffers attached before HAL_ETH_Stop_IT() and lwIP may still hold
+         * received frames. */
 
         /* Memory barriers before starting DMA */
         __DSB();
@@ -626,8 +1536,11 @@ void ethernetif_check_link(struct netif *netif)
         /* Start ETH - let HAL handle descriptor initialization */
         if (HAL_ETH_Start_IT(&heth) == HAL_OK)
         {
+            ethernetif_rx_coalesce_start();
+            LOCK_TCPIP_CORE();
             netif_set_up(netif);
             netif_set_link_up(netif);
+            UNLOCK_TCPIP_CORE();
             ETH_DEBUG("ETH started");
         }
         else
@@ -637,6 +1550,38 @@ void ethernetif_check_link(struct netif *netif)
     }
 }
 
+bool ethernetif_wait_link_event(void)
+{
+    /* An edge before the first wait is caught by the next link check */
+    LinkWaiter = xTaskGetCurrentTaskHandle();
+
+    if (ulTaskNotifyTakeIndexed(ETHIF_NOTIFY_INDEX, pdTRUE,
+                                pdMS_TO_TICKS(ETHIF_LINK_POLL_MS)) == 0U)
+    {
+        return false;
+    }
+
+    /* Reading ISFR releases nINT for the next event */
+    (void)LAN8742_ClearIT(&LAN8742, 0U);
+    return true;
+}
+
+void ethernetif_phy_irq_handler(void)
+{
+#ifdef ETH_PHY_INT_Pin
+    BaseType_t   xHigherPriorityTaskWoken = pdFALSE;
+    TaskHandle_t waiter                   = LinkWaiter;
+
+    __HAL_GPIO_EXTI_CLEAR_FALLING_IT(ETH_PHY_INT_Pin);
+    if (waiter != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(waiter, ETHIF_NOTIFY_INDEX,
+                                      &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+#endif
+}
+
 void ethernetif_poll(struct netif *netif) { ethernetif_input(netif); }
 
 void ethernet_link_thread(void *argument)
@@ -646,6 +1591,6 @@ void ethernet_link_thread(void *argument)
     for (;;)
     {
         ethernetif_check_link(netif);
-        vTaskDelay(pdMS_TO_TICKS(100));
+        (void)ethernetif_wait_link_event();
     }
 }
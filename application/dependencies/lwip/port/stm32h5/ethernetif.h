@@ -8,6 +8,9 @@
 #ifndef ETHERNETIF_H
 #define ETHERNETIF_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "lwip/err.h"
 #include "lwip/netif.h"
 
@@ -43,6 +46,18 @@ extern "C"
      */
     void ethernetif_check_link(struct netif *netif);
 
+    /**
+     * @brief Wait for a PHY link interrupt or the fallback poll interval
+     * @return true if the PHY reported a link event, false on timeout
+     * @note Call ethernetif_check_link() after each return. Task context.
+     */
+    bool ethernetif_wait_link_event(void);
+
+    /**
+     * @brief PHY nINT EXTI interrupt handler, wakes ethernetif_wait_link_event()
+     */
+    void ethernetif_phy_irq_handler(void);
+
     /**
      * @brief Poll for received Ethernet frames
      * @param netif the lwip network interface structure
@@ -67,6 +82,95 @@ extern "C"
      */
     uint32_t ethernetif_get_rx_int_count(void);
 
+    /**
+     * @brief Get the longest RX DMA stall (RBU until the DMA resumed)
+     * @return Stall time in microseconds
+     */
+    uint32_t ethernetif_get_rx_stall_max_us(void);
+
+    /*******************************************************************************
+     * PTP Hardware Timestamps
+     *
+     * PTP event messages over UDP/IPv4 (destination port
+     * ETHERNETIF_PTP_EVENT_PORT) are timestamped by the MAC with its system
+     * time (BSP_Time_NowNs()): received Sync messages on the wire, sent
+     * Delay_Req messages when they left. The last few stamps of each
+     * direction are kept by PTP sequence ID until collected.
+     ******************************************************************************/
+
+/** UDP port of PTP event messages */
+#define ETHERNETIF_PTP_EVENT_PORT 319U
+
+    /**
+     * @brief Collect the receive timestamp of a PTP event message
+     * @param sequence_id sequenceId of the message
+     * @param time_ns Filled with the MAC time the message arrived at
+     * @return true if the message was stamped, false if no (or an
+     *         overwritten) stamp is kept for it
+     */
+    bool ethernetif_ptp_rx_stamp(uint16_t sequence_id, uint64_t *time_ns);
+
+    /**
+     * @brief Collect the transmit timestamp of a PTP event message
+     * @param sequence_id sequenceId of the message
+     * @param time_ns Filled with the MAC time the message left at
+     * @return true once the message has been sent and stamped
+     */
+    bool ethernetif_ptp_tx_stamp(uint16_t sequence_id, uint64_t *time_ns);
+
+    /*******************************************************************************
+     * 802.1Q Priority Tagging
+     *
+     * Sent frames are sorted into traffic classes by the DSCP of their IPv4
+     * header, which the PCBs of the services set through their TOS
+     * (ETHERNETIF_TOS_CONTROL, ETHERNETIF_TOS_BULK); ARP goes with the
+     * control class, as a reply may wait on it, and everything else is
+     * default. With tagging on, the MAC inserts a VLAN tag with the PCP of
+     * the class of each frame (TxConfig), so switches queue control traffic
+     * ahead of bulk transfers. Received tagged frames of other VLANs are
+     * dropped by the MAC VLAN filter and the tag of the rest is stripped,
+     * so lwIP only sees untagged frames; untagged frames still pass. With
+     * VLAN ID 0 frames are priority tagged only, and the MAC does not
+     * compare the VLAN ID of received frames.
+     ******************************************************************************/
+
+/** TOS of the PCBs of each class: DSCP EF (46) and CS1 (8) */
+#define ETHERNETIF_TOS_CONTROL 0xB8U
+#define ETHERNETIF_TOS_BULK    0x20U
+
+/** Highest 802.1Q VLAN ID and priority code point */
+#define ETHERNETIF_VLAN_ID_MAX 4094U
+#define ETHERNETIF_PCP_MAX     7U
+
+    /**
+     * @brief Traffic classes of sent frames
+     */
+    typedef enum
+    {
+        ETHERNETIF_TX_CLASS_DEFAULT = 0, /**< Anything not marked */
+        ETHERNETIF_TX_CLASS_CONTROL,     /**< Modbus responses, reports, ARP */
+        ETHERNETIF_TX_CLASS_BULK,        /**< Waveform streams, FOTA */
+        ETHERNETIF_TX_CLASS_COUNT        /**< Number of classes */
+    } ethernetif_tx_class_t;
+
+    /**
+     * @brief VLAN tagging configuration
+     */
+    typedef struct
+    {
+        bool     enabled; /**< Tag sent frames, filter received ones */
+        uint16_t vlan_id; /**< VLAN ID, 0 = priority tag only */
+        uint8_t  pcp[ETHERNETIF_TX_CLASS_COUNT]; /**< PCP of each class */
+    } ethernetif_vlan_config_t;
+
+    /**
+     * @brief Apply a VLAN tagging configuration
+     * @param config New configuration (copied); NULL is ignored. Values out
+     *        of range are masked to their field.
+     * @note Safe to call from any task, before or after ethernetif_init().
+     */
+    void ethernetif_set_vlan(const ethernetif_vlan_config_t *config);
+
 #ifdef __cplusplus
 }
 #endif
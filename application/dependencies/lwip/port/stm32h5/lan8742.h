@@ -74,6 +74,16 @@ extern "C"
 #define LAN8742_PHYSCSR_100BTX_HD     0x0008U
 #define LAN8742_PHYSCSR_100BTX_FD     0x0018U
 
+/* Interrupt Sources (ISFR flags, IMR mask bits) */
+#define LAN8742_WOL_IT                        0x0100U
+#define LAN8742_ENERGYON_IT                   0x0080U
+#define LAN8742_AUTONEGO_COMPLETE_IT          0x0040U
+#define LAN8742_REMOTE_FAULT_IT               0x0020U
+#define LAN8742_LINK_DOWN_IT                  0x0010U
+#define LAN8742_AUTONEGO_LP_ACK_IT            0x0008U
+#define LAN8742_PARALLEL_DETECTION_FAULT_IT   0x0004U
+#define LAN8742_AUTONEGO_PAGE_RECEIVED_IT     0x0002U
+
 /* Link State */
 #define LAN8742_STATUS_READ_ERROR          -5
 #define LAN8742_STATUS_WRITE_ERROR         -4
@@ -5,18 +5,38 @@
  * LwIP System Architecture for FreeRTOS (Static Allocation)
  */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "FreeRTOS.h"
+#include "bsp.h"
+#include "block_pool.h"
+#include "bsp_sections.h"
+#include "lwip/def.h"
 #include "lwip/opt.h"
 #include "lwip/stats.h"
 #include "lwip/sys.h"
+#include "lwip/tcpip.h"
 #include "queue.h"
 #include "semphr.h"
+#if !BSP_POSIX
+#include "stm32h5xx.h"
+#endif
 #include "task.h"
 
 #if !NO_SYS
 
+/*-----------------------------------------------------------------------------------*/
+/* Static Object Pools */
+/*-----------------------------------------------------------------------------------*/
+
+/*
+ * Kernel objects come from fixed static arrays, each handed out by a block
+ * pool (block_pool.h) in O(1) however many objects exist. Handles map back
+ * to blocks by address, since a statically created FreeRTOS object's handle
+ * is its buffer.
+ */
+
 /*-----------------------------------------------------------------------------------*/
 /* Mutex Functions - Using Static Allocation */
 /*-----------------------------------------------------------------------------------*/
@@ -24,29 +44,28 @@
 /* Static mutex storage pool */
 #define MAX_MUTEXES 8
 static StaticSemaphore_t mutexBuffers[MAX_MUTEXES];
-static uint8_t           mutexUsed[MAX_MUTEXES] = {0};
+static uint16_t          mutexLinks[MAX_MUTEXES];
+static block_pool_t      mutexPool =
+    BLOCK_POOL_INIT("mutex", mutexBuffers, mutexLinks);
 
 err_t sys_mutex_new(sys_mutex_t *mutex)
 {
-    int i;
-    for (i = 0; i < MAX_MUTEXES; i++)
+    StaticSemaphore_t *buffer = block_pool_alloc(&mutexPool);
+
+    if (buffer == NULL)
     {
-        if (mutexUsed[i] == 0)
-        {
-            mutexUsed[i] = 1;
-            *mutex       = xSemaphoreCreateMutexStatic(&mutexBuffers[i]);
-            if (*mutex == NULL)
-            {
-                mutexUsed[i] = 0;
-                SYS_STATS_INC(mutex.err);
-                return ERR_MEM;
-            }
-            SYS_STATS_INC_USED(mutex);
-            return ERR_OK;
-        }
+        SYS_STATS_INC(mutex.err);
+        return ERR_MEM;
+    }
+    *mutex = xSemaphoreCreateMutexStatic(buffer);
+    if (*mutex == NULL)
+    {
+        (void)block_pool_free(&mutexPool, buffer);
+        SYS_STATS_INC(mutex.err);
+        return ERR_MEM;
     }
-    SYS_STATS_INC(mutex.err);
-    return ERR_MEM;
+    SYS_STATS_INC_USED(mutex);
+    return ERR_OK;
 }
 
 void sys_mutex_lock(sys_mutex_t *mutex)
@@ -58,18 +77,9 @@ void sys_mutex_unlock(sys_mutex_t *mutex) { xSemaphoreGive(*mutex); }
 
 void sys_mutex_free(sys_mutex_t *mutex)
 {
-    int i;
     SYS_STATS_DEC(mutex.used);
     vSemaphoreDelete(*mutex);
-    /* Find and free the static buffer */
-    for (i = 0; i < MAX_MUTEXES; i++)
-    {
-        if (*mutex == (SemaphoreHandle_t)&mutexBuffers[i])
-        {
-            mutexUsed[i] = 0;
-            break;
-        }
-    }
+    (void)block_pool_free(&mutexPool, *mutex);
     *mutex = NULL;
 }
 
@@ -79,29 +89,28 @@ void sys_mutex_free(sys_mutex_t *mutex)
 
 #define MAX_SEMAPHORES 16
 static StaticSemaphore_t semBuffers[MAX_SEMAPHORES];
-static uint8_t           semUsed[MAX_SEMAPHORES] = {0};
+static uint16_t          semLinks[MAX_SEMAPHORES];
+static block_pool_t      semPool =
+    BLOCK_POOL_INIT("sem", semBuffers, semLinks);
 
 err_t sys_sem_new(sys_sem_t *sem, u8_t count)
 {
-    int i;
-    for (i = 0; i < MAX_SEMAPHORES; i++)
+    StaticSemaphore_t *buffer = block_pool_alloc(&semPool);
+
+    if (buffer == NULL)
     {
-        if (semUsed[i] == 0)
-        {
-            semUsed[i] = 1;
-            *sem = xSemaphoreCreateCountingStatic(0xFF, count, &semBuffers[i]);
-            if (*sem == NULL)
-            {
-                semUsed[i] = 0;
-                SYS_STATS_INC(sem.err);
-                return ERR_MEM;
-            }
-            SYS_STATS_INC_USED(sem);
-            return ERR_OK;
-        }
+        SYS_STATS_INC(sem.err);
+        return ERR_MEM;
     }
-    SYS_STATS_INC(sem.err);
-    return ERR_MEM;
+    *sem = xSemaphoreCreateCountingStatic(0xFF, count, buffer);
+    if (*sem == NULL)
+    {
+        (void)block_pool_free(&semPool, buffer);
+        SYS_STATS_INC(sem.err);
+        return ERR_MEM;
+    }
+    SYS_STATS_INC_USED(sem);
+    return ERR_OK;
 }
 
 void sys_sem_signal(sys_sem_t *sem) { xSemaphoreGive(*sem); }
@@ -138,17 +147,9 @@ u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout)
 
 void sys_sem_free(sys_sem_t *sem)
 {
-    int i;
     SYS_STATS_DEC(sem.used);
     vSemaphoreDelete(*sem);
-    for (i = 0; i < MAX_SEMAPHORES; i++)
-    {
-        if (*sem == (SemaphoreHandle_t)&semBuffers[i])
-        {
-            semUsed[i] = 0;
-            break;
-        }
-    }
+    (void)block_pool_free(&semPool, *sem);
     *sem = NULL;
 }
 
@@ -156,36 +157,160 @@ void sys_sem_free(sys_sem_t *sem)
 /* Mailbox Functions - Using Static Allocation */
 /*-----------------------------------------------------------------------------------*/
 
-#define MAX_MBOXES 8
-#define MBOX_SIZE  16
-static StaticQueue_t mboxStaticBuffers[MAX_MBOXES];
-static uint8_t       mboxStorage[MAX_MBOXES][MBOX_SIZE * sizeof(void *)];
-static uint8_t       mboxUsed[MAX_MBOXES] = {0};
+/*
+ * Mailboxes come in size classes taken from lwipopts.h: one for the tcpip
+ * thread and one for netconn receive/accept mailboxes (every netconn has a
+ * receive mailbox, listeners an accept mailbox as well). sys_mbox_new() uses
+ * the shallowest class that holds the requested depth and has a free slot.
+ */
+#define MBOX_TCPIP_DEPTH TCPIP_MBOX_SIZE
+#define MBOX_TCPIP_COUNT 1
+#define MBOX_CONN_DEPTH                                            \
+    LWIP_MAX(LWIP_MAX(DEFAULT_TCP_RECVMBOX_SIZE,                   \
+                      DEFAULT_UDP_RECVMBOX_SIZE),                  \
+             LWIP_MAX(DEFAULT_RAW_RECVMBOX_SIZE, DEFAULT_ACCEPTMBOX_SIZE))
+#define MBOX_CONN_COUNT (MEMP_NUM_NETCONN + MEMP_NUM_TCP_PCB_LISTEN)
+
+typedef struct
+{
+    block_pool_t pool;    /* Over the queues, one per slot */
+    void       **storage; /* depth entries per slot */
+    uint16_t     depth;
+#if LWIP_PROFILE
+    uint16_t     maxFill; /* Most messages one of its mailboxes held */
+    uint32_t     full;    /* Posts refused by a full mailbox */
+#endif
+} mboxClass_t;
+
+static StaticQueue_t mboxTcpipQueues[MBOX_TCPIP_COUNT];
+static void         *mboxTcpipStorage[MBOX_TCPIP_COUNT][MBOX_TCPIP_DEPTH];
+static uint16_t      mboxTcpipLinks[MBOX_TCPIP_COUNT];
+
+static StaticQueue_t mboxConnQueues[MBOX_CONN_COUNT];
+static void         *mboxConnStorage[MBOX_CONN_COUNT][MBOX_CONN_DEPTH];
+static uint16_t      mboxConnLinks[MBOX_CONN_COUNT];
+
+static mboxClass_t mboxClasses[] = {
+    {.pool    = BLOCK_POOL_INIT("mbox_tcpip", mboxTcpipQueues, mboxTcpipLinks),
+     .storage = &mboxTcpipStorage[0][0],
+     .depth   = MBOX_TCPIP_DEPTH},
+    {.pool    = BLOCK_POOL_INIT("mbox_conn", mboxConnQueues, mboxConnLinks),
+     .storage = &mboxConnStorage[0][0],
+     .depth   = MBOX_CONN_DEPTH},
+};
+
+#define MBOX_CLASS_COUNT (sizeof(mboxClasses) / sizeof(mboxClasses[0]))
+
+_Static_assert(MBOX_CONN_COUNT <= BLOCK_POOL_MAX_BLOCKS,
+               "too many netconn mailboxes for a block pool");
+
+#if LWIP_PROFILE
+/*
+ * Mailbox profile, for sizing the depths in lwipopts.h: the level of a
+ * mailbox is taken right after each post, so a receiver that runs first
+ * can hide the last message, and refused posts count against the class.
+ */
+static void mbox_profile_post(sys_mbox_t mbox, int posted, int fromIsr)
+{
+    mboxClass_t *cls = NULL;
+    UBaseType_t  fill;
+    uint32_t     i;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    for (i = 0; i < MBOX_CLASS_COUNT; i++)
+    {
+        if (block_pool_index(&mboxClasses[i].pool, mbox) >= 0)
+        {
+            cls = &mboxClasses[i];
+            break;
+        }
+    }
+    if (cls == NULL)
+    {
+        return;
+    }
+
+    fill = fromIsr ? uxQueueMessagesWaitingFromISR(mbox)
+                   : uxQueueMessagesWaiting(mbox);
+
+    SYS_ARCH_PROTECT(lev);
+    if (!posted)
+    {
+        cls->full++;
+    }
+    if (fill > cls->maxFill)
+    {
+        cls->maxFill = (uint16_t)fill;
+    }
+    SYS_ARCH_UNPROTECT(lev);
+}
+#define MBOX_PROFILE_POST(mbox, posted, fromIsr) \
+    mbox_profile_post((mbox), (posted), (fromIsr))
+#else
+#define MBOX_PROFILE_POST(mbox, posted, fromIsr) ((void)0)
+#endif
 
 err_t sys_mbox_new(sys_mbox_t *mbox, int size)
 {
-    int i;
-    (void)size; /* Use fixed size */
+    mboxClass_t   *best = NULL;
+    mboxClass_t   *fit  = NULL;
+    mboxClass_t   *cls;
+    StaticQueue_t *queue = NULL;
+    uint32_t       i;
+    uint32_t       slot;
+
+    if (size <= 0)
+    {
+        size = 1;
+    }
 
-    for (i = 0; i < MAX_MBOXES; i++)
+    /* Shallowest class that fits (fit) and that also has room (best);
+     * there are only a few classes */
+    for (i = 0; i < MBOX_CLASS_COUNT; i++)
     {
-        if (mboxUsed[i] == 0)
+        cls = &mboxClasses[i];
+        if (cls->depth < (uint32_t)size)
         {
-            mboxUsed[i] = 1;
-            *mbox       = xQueueCreateStatic(MBOX_SIZE, sizeof(void *),
-                                             mboxStorage[i], &mboxStaticBuffers[i]);
-            if (*mbox == NULL)
-            {
-                mboxUsed[i] = 0;
-                SYS_STATS_INC(mbox.err);
-                return ERR_MEM;
-            }
-            SYS_STATS_INC_USED(mbox);
-            return ERR_OK;
+            continue;
+        }
+        if ((fit == NULL) || (cls->depth < fit->depth))
+        {
+            fit = cls;
+        }
+        if (block_pool_available(&cls->pool) &&
+            ((best == NULL) || (cls->depth < best->depth)))
+        {
+            best = cls;
         }
     }
-    SYS_STATS_INC(mbox.err);
-    return ERR_MEM;
+
+    /* With every fitting class full, the refusal counts against fit */
+    if (best == NULL)
+    {
+        best = fit;
+    }
+    if (best != NULL)
+    {
+        queue = block_pool_alloc(&best->pool);
+    }
+    if (queue == NULL)
+    {
+        SYS_STATS_INC(mbox.err);
+        return ERR_MEM;
+    }
+
+    slot  = (uint32_t)block_pool_index(&best->pool, queue);
+    *mbox = xQueueCreateStatic(best->depth, sizeof(void *),
+                               (uint8_t *)&best->storage[slot * best->depth],
+                               queue);
+    if (*mbox == NULL)
+    {
+        (void)block_pool_free(&best->pool, queue);
+        SYS_STATS_INC(mbox.err);
+        return ERR_MEM;
+    }
+    SYS_STATS_INC_USED(mbox);
+    return ERR_OK;
 }
 
 void sys_mbox_post(sys_mbox_t *mbox, void *msg)
@@ -194,16 +319,19 @@ void sys_mbox_post(sys_mbox_t *mbox, void *msg)
     {
         /* Keep trying */
     }
+    MBOX_PROFILE_POST(*mbox, 1, 0);
 }
 
 err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
 {
     if (xQueueSendToBack(*mbox, &msg, 0) == pdTRUE)
     {
+        MBOX_PROFILE_POST(*mbox, 1, 0);
         return ERR_OK;
     }
     else
     {
+        MBOX_PROFILE_POST(*mbox, 0, 0);
         SYS_STATS_INC(mbox.err);
         return ERR_MEM;
     }
@@ -215,11 +343,13 @@ err_t sys_mbox_trypost_fromisr(sys_mbox_t *mbox, void *msg)
     if (xQueueSendToBackFromISR(*mbox, &msg, &xHigherPriorityTaskWoken) ==
         pdTRUE)
     {
+        MBOX_PROFILE_POST(*mbox, 1, 1);
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         return ERR_OK;
     }
     else
     {
+        MBOX_PROFILE_POST(*mbox, 0, 1);
         return ERR_MEM;
     }
 }
@@ -282,16 +412,16 @@ u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
 
 void sys_mbox_free(sys_mbox_t *mbox)
 {
-    int i;
+    uint32_t i;
+
     if (*mbox != NULL)
     {
         SYS_STATS_DEC(mbox.used);
         vQueueDelete(*mbox);
-        for (i = 0; i < MAX_MBOXES; i++)
+        for (i = 0; i < MBOX_CLASS_COUNT; i++)
         {
-            if (*mbox == (QueueHandle_t)&mboxStaticBuffers[i])
+            if (block_pool_free(&mboxClasses[i].pool, *mbox))
             {
-                mboxUsed[i] = 0;
                 break;
             }
         }
@@ -306,49 +436,175 @@ void sys_mbox_free(sys_mbox_t *mbox)
 #define MAX_THREADS       4
 #define THREAD_STACK_SIZE 512
 static StaticTask_t threadTCBs[MAX_THREADS];
-static StackType_t  threadStacks[MAX_THREADS][THREAD_STACK_SIZE];
-static uint8_t      threadUsed[MAX_THREADS] = {0};
+static StackType_t  threadStacks[MAX_THREADS][THREAD_STACK_SIZE]
+    BSP_SECTION_STACK;
+static uint16_t     threadLinks[MAX_THREADS];
+static block_pool_t threadPool =
+    BLOCK_POOL_INIT("thread", threadTCBs, threadLinks);
 
 sys_thread_t sys_thread_new(const char *name, lwip_thread_fn thread, void *arg,
                             int stacksize, int prio)
 {
-    int i;
+    StaticTask_t *tcb = block_pool_alloc(&threadPool);
     (void)stacksize; /* Use fixed stack size */
 
-    for (i = 0; i < MAX_THREADS; i++)
+    if (tcb == NULL)
     {
-        if (threadUsed[i] == 0)
-        {
-            threadUsed[i]           = 1;
-            TaskHandle_t taskHandle = xTaskCreateStatic(
-                thread, name, THREAD_STACK_SIZE, arg, (UBaseType_t)prio,
-                threadStacks[i], &threadTCBs[i]);
-            return taskHandle;
-        }
+        return NULL;
+    }
+    /* lwIP never ends a thread, so the block is never freed */
+    return xTaskCreateStatic(
+        thread, name, THREAD_STACK_SIZE, arg, (UBaseType_t)prio,
+        threadStacks[block_pool_index(&threadPool, tcb)], tcb);
+}
+
+/*-----------------------------------------------------------------------------------*/
+/* Pool Statistics */
+/*-----------------------------------------------------------------------------------*/
+
+int sys_arch_pool_stats(unsigned int index, sys_arch_pool_stats_t *stats)
+{
+    const block_pool_t *pool;
+    block_pool_stats_t  usage;
+    uint16_t            depth   = 0;
+    size_t              storage = 0;
+
+    if (stats == NULL)
+    {
+        return -1;
+    }
+    if (index == 0U)
+    {
+        pool = &mutexPool;
+    }
+    else if (index == 1U)
+    {
+        pool = &semPool;
+    }
+    else if ((index - 2U) < MBOX_CLASS_COUNT)
+    {
+        pool    = &mboxClasses[index - 2U].pool;
+        depth   = mboxClasses[index - 2U].depth;
+        storage = depth * sizeof(void *);
+    }
+    else if (index == (2U + MBOX_CLASS_COUNT))
+    {
+        pool    = &threadPool;
+        storage = sizeof(threadStacks[0]);
+    }
+    else
+    {
+        return -1;
+    }
+
+    block_pool_get_stats(pool, &usage);
+    stats->name     = usage.name;
+    stats->count    = usage.count;
+    stats->depth    = depth;
+    stats->used     = usage.used;
+    stats->max_used = usage.max_used;
+    stats->err      = (usage.failures > UINT16_MAX) ? UINT16_MAX
+                                                    : (uint16_t)usage.failures;
+
+    /* The object, its storage and its free list link */
+    stats->size =
+        (uint16_t)LWIP_MIN(pool->block_size + storage + sizeof(uint16_t),
+                           UINT16_MAX);
+    stats->max_fill = 0;
+    stats->full     = 0;
+#if LWIP_PROFILE
+    if (depth != 0U)
+    {
+        const mboxClass_t *cls = &mboxClasses[index - 2U];
+
+        stats->max_fill = cls->maxFill;
+        stats->full     = (cls->full > UINT16_MAX) ? UINT16_MAX
+                                                   : (uint16_t)cls->full;
     }
-    return NULL;
+#endif
+    return 0;
 }
 
 /*-----------------------------------------------------------------------------------*/
 /* Critical Section / Protection Functions */
 /*-----------------------------------------------------------------------------------*/
 #if SYS_LIGHTWEIGHT_PROT
-static sys_prot_t critNestingCount;
-
+/*
+ * Lightweight protection guards every pbuf/memp allocation and free, so it
+ * only raises BASEPRI to configMAX_SYSCALL_INTERRUPT_PRIORITY instead of
+ * entering a scheduler critical section. The previous BASEPRI is returned
+ * and restored, which makes nested calls correct and keeps no nesting state,
+ * so the same pair is safe from tasks and from interrupts at or below the
+ * syscall priority. Interrupts above that priority (which must not call
+ * lwIP) are never held off.
+ */
+#if BSP_POSIX
+/* The host has no BASEPRI: the kernel critical section nests by itself */
 sys_prot_t sys_arch_protect(void)
 {
     taskENTER_CRITICAL();
-    return critNestingCount++;
+    return 0U;
 }
 
 void sys_arch_unprotect(sys_prot_t pval)
 {
     (void)pval;
-    critNestingCount--;
     taskEXIT_CRITICAL();
 }
+#else
+sys_prot_t sys_arch_protect(void)
+{
+    sys_prot_t pval = __get_BASEPRI();
+
+    /* Only ever raises the mask: a caller already running with a stricter
+     * BASEPRI keeps it */
+    __set_BASEPRI_MAX(configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    __DSB();
+    __ISB();
+    return pval;
+}
+
+void sys_arch_unprotect(sys_prot_t pval)
+{
+    __set_BASEPRI(pval);
+}
+#endif /* BSP_POSIX */
 #endif /* SYS_LIGHTWEIGHT_PROT */
 
+/*-----------------------------------------------------------------------------------*/
+/* Core Locking Checks */
+/*-----------------------------------------------------------------------------------*/
+
+/*
+ * lwip_init() and the netif setup before the TCP/IP thread starts run in
+ * one task with nothing to race, so the check only applies once the thread
+ * has marked itself. The thread holds the core mutex whenever it is not
+ * waiting for a message, so its callbacks and timers pass the same check.
+ */
+static TaskHandle_t tcpipThread;
+
+void sys_mark_tcpip_thread(void)
+{
+    tcpipThread = xTaskGetCurrentTaskHandle();
+}
+
+void sys_check_core_locking(void)
+{
+    LWIP_ASSERT("lwIP raw API called from an interrupt", __get_IPSR() == 0U);
+
+    if (tcpipThread != NULL)
+    {
+#if LWIP_TCPIP_CORE_LOCKING
+        LWIP_ASSERT("lwIP core not locked by the caller",
+                    xSemaphoreGetMutexHolder(lock_tcpip_core) ==
+                        xTaskGetCurrentTaskHandle());
+#else
+        LWIP_ASSERT("lwIP raw API called outside the TCP/IP thread",
+                    xTaskGetCurrentTaskHandle() == tcpipThread);
+#endif
+    }
+}
+
 /*-----------------------------------------------------------------------------------*/
 /* System Time Functions */
 /*-----------------------------------------------------------------------------------*/
@@ -357,6 +613,74 @@ u32_t sys_now(void)
     return (u32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
 }
 
-void sys_init(void) { /* Nothing to do for FreeRTOS */ }
+/*-----------------------------------------------------------------------------------*/
+/* Random Numbers */
+/*-----------------------------------------------------------------------------------*/
+
+/*
+ * LWIP_RAND() (DHCP xid, initial ports, TCP ISN) takes words from the
+ * secure entropy pool, fetched a few at a time so most calls make no
+ * secure call. It never waits: when the pool is empty or the gateway busy
+ * it falls back to rand() mixed with the cycle counter, as these values
+ * need to be hard to guess from the wire, not of cryptographic strength.
+ */
+#define RANDOM_CACHE_WORDS 8U
+
+static uint32_t randomCache[RANDOM_CACHE_WORDS];
+static uint32_t randomCount;
+
+u32_t sys_arch_random(void)
+{
+    uint32_t words[RANDOM_CACHE_WORDS];
+    uint32_t got = 0U;
+    uint32_t i;
+    u32_t    value;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    if (randomCount > 0U)
+    {
+        randomCount--;
+        value                    = randomCache[randomCount];
+        randomCache[randomCount] = 0U;
+        SYS_ARCH_UNPROTECT(lev);
+        return value;
+    }
+    SYS_ARCH_UNPROTECT(lev);
+
+    /* Refilled outside the protection, the secure call takes microseconds */
+    if ((BSP_Random_Read(words, sizeof(words), &got) != BSP_OK) ||
+        (got < sizeof(uint32_t)))
+    {
+        return (u32_t)rand() ^ BSP_CycleCounter_Read();
+    }
+
+    value = words[0];
+    SYS_ARCH_PROTECT(lev);
+    for (i = 1U; (i < (got / sizeof(uint32_t))) &&
+                 (randomCount < RANDOM_CACHE_WORDS);
+         i++)
+    {
+        randomCache[randomCount] = words[i];
+        randomCount++;
+    }
+    SYS_ARCH_UNPROTECT(lev);
+
+    return value;
+}
+
+void sys_init(void)
+{
+    uint32_t i;
+
+    /* Called by lwip_init() before any object is created */
+    block_pool_init(&mutexPool);
+    block_pool_init(&semPool);
+    for (i = 0; i < MBOX_CLASS_COUNT; i++)
+    {
+        block_pool_init(&mboxClasses[i].pool);
+    }
+    block_pool_init(&threadPool);
+}
 
 #endif /* !NO_SYS */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Mbed TLS Configuration
+ *
+ * Just enough of Mbed TLS for the Modbus/TCP Security server: TLS 1.2 with
+ * mutual certificate authentication and the one cipher suite
+ * ECDHE-ECDSA-AES128-GCM-SHA256 on P-256, plus session tickets and a small
+ * session cache so reconnecting masters resume instead of repeating the
+ * handshake. The STM32H563 has no AES engine, so AES-GCM runs in software
+ * from flash tables; ECDSA verification runs on the PKA in the secure
+ * world and the entropy comes from its TRNG (mbedtls_port.c).
+ */
+
+#ifndef MBEDTLS_JERRY_CONFIG_H
+#define MBEDTLS_JERRY_CONFIG_H
+
+/* ------------------------------------------------
+   1. Platform
+   ------------------------------------------------ */
+#define MBEDTLS_HAVE_ASM
+#define MBEDTLS_HAVE_TIME
+#define MBEDTLS_PLATFORM_C
+#define MBEDTLS_PLATFORM_TIME_ALT    /* Seconds since boot, no RTC time */
+#define MBEDTLS_PLATFORM_MS_TIME_ALT /* FreeRTOS tick count */
+#define MBEDTLS_DEPRECATED_REMOVED
+
+/* All allocations come from a static buffer (mbedtls_port_init()) */
+#define MBEDTLS_PLATFORM_MEMORY
+#define MBEDTLS_MEMORY_BUFFER_ALLOC_C
+
+/* The only entropy source is the TRNG */
+#define MBEDTLS_NO_PLATFORM_ENTROPY
+#define MBEDTLS_ENTROPY_HARDWARE_ALT
+#define MBEDTLS_ENTROPY_C
+#define MBEDTLS_ENTROPY_MAX_SOURCES 2
+#define MBEDTLS_CTR_DRBG_C
+
+/* ------------------------------------------------
+   2. Symmetric Cryptography
+   ------------------------------------------------ */
+#define MBEDTLS_AES_C
+#define MBEDTLS_AES_ROM_TABLES          /* Tables in flash, not 8 KB of RAM */
+#define MBEDTLS_BLOCK_CIPHER_NO_DECRYPT /* GCM and CTR only encrypt */
+#define MBEDTLS_CIPHER_C
+#define MBEDTLS_GCM_C
+#define MBEDTLS_MD_C
+#define MBEDTLS_SHA256_C
+
+/* ------------------------------------------------
+   3. Public Key Cryptography
+   ------------------------------------------------ */
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+#define MBEDTLS_ECDH_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECDSA_VERIFY_ALT /* On the PKA */
+
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
+#define MBEDTLS_OID_C
+#define MBEDTLS_PK_C
+#define MBEDTLS_PK_PARSE_C
+#define MBEDTLS_PEM_PARSE_C
+#define MBEDTLS_BASE64_C
+#define MBEDTLS_X509_USE_C
+#define MBEDTLS_X509_CRT_PARSE_C
+#define MBEDTLS_X509_MAX_INTERMEDIATE_CA 2
+
+/* ------------------------------------------------
+   4. TLS
+   ------------------------------------------------ */
+#define MBEDTLS_SSL_TLS_C
+#define MBEDTLS_SSL_SRV_C
+#define MBEDTLS_SSL_PROTO_TLS1_2
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+#define MBEDTLS_SSL_CIPHERSUITES MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256
+#define MBEDTLS_SSL_EXTENDED_MASTER_SECRET
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+#define MBEDTLS_SSL_ALL_ALERT_MESSAGES
+
+/* Resumption: tickets, and the cache for masters without ticket support */
+#define MBEDTLS_SSL_SESSION_TICKETS
+#define MBEDTLS_SSL_TICKET_C
+#define MBEDTLS_SSL_CACHE_C
+#define MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES 4
+#define MBEDTLS_SSL_CACHE_DEFAULT_TIMEOUT     86400
+
+/* Fixed record buffers: a pipelined batch of Modbus ADUs and the largest
+ * handshake message expected, a client certificate chain, both fit */
+#define MBEDTLS_SSL_IN_CONTENT_LEN  2048
+#define MBEDTLS_SSL_OUT_CONTENT_LEN 2048
+
+#endif /* MBEDTLS_JERRY_CONFIG_H */
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Mbed TLS Platform Port
+ *
+ * The TRNG and the PKA belong to the secure world and are shared with the
+ * firmware update; a request that finds the gateway busy is retried.
+ */
+
+#include "mbedtls_port.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "mbedtls/bignum.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/memory_buffer_alloc.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/platform_time.h"
+#include "mbedtls/platform_util.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Words read from the entropy pool per secure request */
+#define MBEDTLS_PORT_RANDOM_WORDS 16U
+
+/** Tries of a secure request while the gateway is busy or the entropy pool
+ * empty, 1 ms apart */
+#define MBEDTLS_PORT_BUSY_RETRIES 100U
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Heap of Mbed TLS, word aligned */
+static uint32_t s_heap[MBEDTLS_PORT_HEAP_SIZE / sizeof(uint32_t)];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+static mbedtls_time_t mbedtls_port_time(mbedtls_time_t *timer)
+{
+    mbedtls_time_t now =
+        (mbedtls_time_t)(xTaskGetTickCount() / configTICK_RATE_HZ);
+
+    if (timer != NULL)
+    {
+        *timer = now;
+    }
+
+    return now;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void mbedtls_port_init(void)
+{
+    mbedtls_memory_buffer_alloc_init((unsigned char *)s_heap, sizeof(s_heap));
+    (void)mbedtls_platform_set_time(mbedtls_port_time);
+}
+
+/**
+ * @brief Time since boot in milliseconds (MBEDTLS_PLATFORM_MS_TIME_ALT)
+ */
+mbedtls_ms_time_t mbedtls_ms_time(void)
+{
+    return (mbedtls_ms_time_t)pdTICKS_TO_MS(xTaskGetTickCount());
+}
+
+/**
+ * @brief Entropy from the TRNG (MBEDTLS_ENTROPY_HARDWARE_ALT)
+ *
+ * Reads the secure entropy pool, waiting a tick for it to refill when it
+ * runs short. Mbed TLS accepts fewer bytes than asked for and polls again.
+ */
+int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len,
+                          size_t *olen)
+{
+    uint32_t words[MBEDTLS_PORT_RANDOM_WORDS];
+    size_t   done  = 0U;
+    uint32_t tries = 0U;
+
+    (void)data;
+
+    while ((done < len) && (tries < MBEDTLS_PORT_BUSY_RETRIES))
+    {
+        uint32_t    got  = 0U;
+        size_t      want = (len - done + 3U) & ~(size_t)3U;
+        bsp_error_t ret;
+
+        if (want > sizeof(words))
+        {
+            want = sizeof(words);
+        }
+        ret = BSP_Random_Read(words, (uint32_t)want, &got);
+        if ((ret != BSP_OK) && (ret != BSP_BUSY))
+        {
+            break;
+        }
+        if (got == 0U)
+        {
+            tries++;
+            vTaskDelay(pdMS_TO_TICKS(1U));
+            continue;
+        }
+        if (got > (len - done))
+        {
+            got = (uint32_t)(len - done);
+        }
+        (void)memcpy(&output[done], words, got);
+        done += got;
+    }
+
+    mbedtls_platform_zeroize(words, sizeof(words));
+    *olen = done;
+
+    return (done > 0U) ? 0 : MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+}
+
+/**
+ * @brief ECDSA verification on the PKA (MBEDTLS_ECDSA_VERIFY_ALT)
+ *
+ * Only P-256 is configured. The digest is reduced to its leftmost 256 bits
+ * as SEC1 4.1.4 requires; the range of r and s and the public key are
+ * checked here, the rest of the verification by the PKA.
+ */
+int mbedtls_ecdsa_verify(mbedtls_ecp_group *grp, const unsigned char *buf,
+                         size_t blen, const mbedtls_ecp_point *Q,
+                         const mbedtls_mpi *r, const mbedtls_mpi *s)
+{
+    uint8_t     point[1U + (2U * BSP_ECDSA_CURVE_SIZE)];
+    uint8_t     hash[BSP_ECDSA_CURVE_SIZE] = {0};
+    uint8_t     signature[2U * BSP_ECDSA_CURVE_SIZE];
+    size_t      point_len;
+    uint32_t    tries = 0U;
+    bsp_error_t ret;
+
+    if (grp->id != MBEDTLS_ECP_DP_SECP256R1)
+    {
+        return MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+    }
+    if ((mbedtls_mpi_cmp_int(r, 1) < 0) ||
+        (mbedtls_mpi_cmp_mpi(r, &grp->N) >= 0) ||
+        (mbedtls_mpi_cmp_int(s, 1) < 0) ||
+        (mbedtls_mpi_cmp_mpi(s, &grp->N) >= 0))
+    {
+        return MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+    if ((mbedtls_ecp_check_pubkey(grp, Q) != 0) ||
+        (mbedtls_ecp_point_write_binary(grp, Q, MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                        &point_len, point,
+                                        sizeof(point)) != 0) ||
+        (point_len != sizeof(point)) ||
+        (mbedtls_mpi_write_binary(r, &signature[0], BSP_ECDSA_CURVE_SIZE) !=
+         0) ||
+        (mbedtls_mpi_write_binary(s, &signature[BSP_ECDSA_CURVE_SIZE],
+                                  BSP_ECDSA_CURVE_SIZE) != 0))
+    {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    /* Shorter digests are right-aligned, longer ones truncated */
+    if (blen >= sizeof(hash))
+    {
+        (void)memcpy(hash, buf, sizeof(hash));
+    }
+    else
+    {
+        (void)memcpy(&hash[sizeof(hash) - blen], buf, blen);
+    }
+
+    /* The point is 0x04, then X and Y */
+    while (((ret = BSP_Ecdsa_Verify(&point[1], hash, signature)) ==
+            BSP_BUSY) &&
+           (++tries < MBEDTLS_PORT_BUSY_RETRIES))
+    {
+        vTaskDelay(pdMS_TO_TICKS(1U));
+    }
+
+    switch (ret)
+    {
+        case BSP_OK:
+            return 0;
+        case BSP_INVALID_ARG:
+            return MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        default:
+            return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+    }
+}
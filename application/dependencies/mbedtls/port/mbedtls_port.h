@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Mbed TLS Platform Port
+ *
+ * Hooks Mbed TLS to the board: its heap is a static buffer, time is the
+ * FreeRTOS tick count, entropy comes from the TRNG and ECDSA signatures are
+ * checked on the PKA, the last two through the secure services gateway
+ * (BSP_Random_Read(), BSP_Ecdsa_Verify()).
+ */
+
+#ifndef MBEDTLS_PORT_H
+#define MBEDTLS_PORT_H
+
+/** Size of the Mbed TLS heap */
+#ifndef MBEDTLS_PORT_HEAP_SIZE
+#define MBEDTLS_PORT_HEAP_SIZE (24U * 1024U)
+#endif
+
+/**
+ * @brief Prepare Mbed TLS for use
+ *
+ * Sets up the heap and the time source. Called once, before any other
+ * Mbed TLS function, by the task that owns Mbed TLS.
+ */
+void mbedtls_port_init(void);
+
+#endif /* MBEDTLS_PORT_H */
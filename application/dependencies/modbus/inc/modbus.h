@@ -21,6 +21,7 @@
 
 #include "modbus_callbacks.h"
 #include "modbus_config.h"
+#include "modbus_master.h"
 #include "modbus_types.h"
 
 #ifdef __cplusplus
@@ -49,8 +50,8 @@ extern "C"
      * @return Size in bytes required for a modbus_context_t
      *
      * @code
-     * static uint8_t modbus_ctx_storage[modbus_context_size()];
-     * modbus_context_t* ctx = (modbus_context_t*)modbus_ctx_storage;
+     * static modbus_context_storage_t modbus_ctx_storage;
+     * modbus_context_t* ctx = (modbus_context_t*)&modbus_ctx_storage;
      * @endcode
      */
     size_t modbus_context_size(void);
@@ -165,6 +166,93 @@ extern "C"
      */
     modbus_error_t modbus_slave_poll(modbus_context_t *ctx);
 
+    /**
+     * @brief Register a handler for an additional function code
+     *
+     * Custom entries are looked up before the built-in table, so they can
+     * also replace the handling of a standard function code.
+     *
+     * @param[in] ctx   Pointer to initialized context
+     * @param[in] entry Dispatch entry; must stay valid (typically const)
+     * @return MODBUS_OK on success, MODBUS_ERROR_BUFFER_OVERFLOW if all
+     *         MODBUS_MAX_CUSTOM_HANDLERS slots are in use
+     */
+    modbus_error_t modbus_slave_register_handler(modbus_context_t *ctx,
+                                                 const modbus_fc_entry_t *entry);
+
+    /**
+     * @brief Set the device identification served by FC43/14
+     *
+     * Read Device Identification is answered with ILLEGAL_FUNCTION until a
+     * table is set.
+     *
+     * @param[in] ctx       Pointer to initialized context
+     * @param[in] device_id Object table sorted by object ID; must stay valid
+     *                      (typically const), NULL to stop serving FC43/14
+     * @return MODBUS_OK on success
+     */
+    modbus_error_t modbus_slave_set_device_id(
+        modbus_context_t *ctx, const modbus_device_id_t *device_id);
+
+    /**
+     * @brief Set the reader of the files served by FC20
+     *
+     * Read File Record is answered with ILLEGAL_FUNCTION until a reader is
+     * set. The reader is called once per sub-request, from the dispatch of
+     * the request.
+     *
+     * @param[in] ctx    Pointer to initialized context
+     * @param[in] reader File reader, NULL to stop serving FC20
+     * @return MODBUS_OK on success
+     */
+    modbus_error_t modbus_slave_set_file_reader(modbus_context_t  *ctx,
+                                                modbus_file_read_t reader);
+
+    /**
+     * @brief Set the mapper of the files served by FC20
+     *
+     * Optional, next to the reader: a sub-request the mapper finds in
+     * memory is encoded straight from there, any other goes to the reader.
+     *
+     * @param[in] ctx    Pointer to initialized context
+     * @param[in] mapper File mapper, NULL to read every sub-request
+     * @return MODBUS_OK on success
+     */
+    modbus_error_t modbus_slave_set_file_mapper(modbus_context_t *ctx,
+                                                modbus_file_map_t mapper);
+
+    /**
+     * @brief Set the writer of the files served by FC21
+     *
+     * Write File Record is answered with ILLEGAL_FUNCTION until a writer is
+     * set. The writer is called once per sub-request, in request order,
+     * from the dispatch of the request; sub-requests before one it rejects
+     * stay written.
+     *
+     * @param[in] ctx    Pointer to initialized context
+     * @param[in] writer File writer, NULL to stop serving FC21
+     * @return MODBUS_OK on success
+     */
+    modbus_error_t modbus_slave_set_file_writer(modbus_context_t   *ctx,
+                                                modbus_file_write_t writer);
+
+    /**
+     * @brief Set the data callbacks of a context
+     *
+     * A context calls the global modbus_cb_* functions until it is given a
+     * table of its own, so several contexts can serve different register
+     * maps, for example one per unit ID.
+     *
+     * @param[in] ctx       Pointer to initialized context
+     * @param[in] callbacks Callback table with every entry set; must stay
+     *                      valid (typically const), NULL to go back to the
+     *                      modbus_cb_* functions
+     * @return MODBUS_OK on success, MODBUS_ERROR_INVALID_PARAM if an entry
+     *         of the table is NULL
+     */
+    modbus_error_t modbus_slave_set_callbacks(
+        modbus_context_t *ctx, const modbus_slave_callbacks_t *callbacks);
+
 #endif /* MODBUS_ENABLE_SLAVE */
 
     /* ==========================================================================
@@ -358,12 +446,39 @@ extern "C"
     /**
      * @brief Reset statistics
      *
-     * Resets all statistics counters to zero.
+     * Resets all statistics counters to zero, including the latency
+     * histograms attached with modbus_slave_set_latency_stats().
      *
      * @param[in] ctx Pointer to initialized context
      */
     void modbus_reset_statistics(modbus_context_t *ctx);
 
+#if MODBUS_ENABLE_LATENCY_STATS
+    /**
+     * @brief Attach latency histograms to a slave context
+     *
+     * Every request dispatched on the context is then timed by stage and
+     * counted in the histogram of its function code.
+     *
+     * @param[in] ctx   Pointer to initialized context
+     * @param[in] stats Histograms, cleared here; must stay valid, NULL to
+     *                  stop timing
+     * @return MODBUS_OK on success
+     */
+    modbus_error_t modbus_slave_set_latency_stats(
+        modbus_context_t *ctx, modbus_latency_stats_t *stats);
+
+    /**
+     * @brief Mark the start of parsing a received frame
+     *
+     * Call before the frame is parsed; the time up to dispatch is counted
+     * as the parse stage of the next request. Without it that stage is 0.
+     *
+     * @param[in] ctx Pointer to initialized context
+     */
+    void modbus_slave_mark_frame_start(modbus_context_t *ctx);
+#endif
+
     /* ==========================================================================
      * CRC/LRC Utility Functions
      * ==========================================================================
@@ -36,6 +36,94 @@
 #define MODBUS_ENABLE_MASTER 0
 #endif
 
+/* ==========================================================================
+ * Function Code Enable/Disable
+ * A slave answers a disabled function code with ILLEGAL_FUNCTION, and its
+ * handler, request decoder and response encoder are left out of the build.
+ * The request encoders used by a master are always built.
+ * ========================================================================== */
+/* Read Coils (FC01) */
+#ifndef MODBUS_ENABLE_FC_READ_COILS
+#define MODBUS_ENABLE_FC_READ_COILS 1
+#endif
+
+/* Read Discrete Inputs (FC02) */
+#ifndef MODBUS_ENABLE_FC_READ_DISCRETE_INPUTS
+#define MODBUS_ENABLE_FC_READ_DISCRETE_INPUTS 1
+#endif
+
+/* Read Holding Registers (FC03) */
+#ifndef MODBUS_ENABLE_FC_READ_HOLDING_REGISTERS
+#define MODBUS_ENABLE_FC_READ_HOLDING_REGISTERS 1
+#endif
+
+/* Read Input Registers (FC04) */
+#ifndef MODBUS_ENABLE_FC_READ_INPUT_REGISTERS
+#define MODBUS_ENABLE_FC_READ_INPUT_REGISTERS 1
+#endif
+
+/* Write Single Coil (FC05) */
+#ifndef MODBUS_ENABLE_FC_WRITE_SINGLE_COIL
+#define MODBUS_ENABLE_FC_WRITE_SINGLE_COIL 1
+#endif
+
+/* Write Single Register (FC06) */
+#ifndef MODBUS_ENABLE_FC_WRITE_SINGLE_REGISTER
+#define MODBUS_ENABLE_FC_WRITE_SINGLE_REGISTER 1
+#endif
+
+/* Write Multiple Coils (FC15) */
+#ifndef MODBUS_ENABLE_FC_WRITE_MULTIPLE_COILS
+#define MODBUS_ENABLE_FC_WRITE_MULTIPLE_COILS 1
+#endif
+
+/* Write Multiple Registers (FC16) */
+#ifndef MODBUS_ENABLE_FC_WRITE_MULTIPLE_REGISTERS
+#define MODBUS_ENABLE_FC_WRITE_MULTIPLE_REGISTERS 1
+#endif
+
+/* Read File Record (FC20) */
+#ifndef MODBUS_ENABLE_FC_READ_FILE_RECORD
+#define MODBUS_ENABLE_FC_READ_FILE_RECORD 1
+#endif
+
+/* Write File Record (FC21) */
+#ifndef MODBUS_ENABLE_FC_WRITE_FILE_RECORD
+#define MODBUS_ENABLE_FC_WRITE_FILE_RECORD 1
+#endif
+
+/* Read/Write Multiple Registers (FC23) */
+#ifndef MODBUS_ENABLE_FC_READ_WRITE_MULTIPLE_REGS
+#define MODBUS_ENABLE_FC_READ_WRITE_MULTIPLE_REGS 1
+#endif
+
+/* Read Device Identification (FC43/14) */
+#ifndef MODBUS_ENABLE_FC_ENCAPSULATED_INTERFACE
+#define MODBUS_ENABLE_FC_ENCAPSULATED_INTERFACE 1
+#endif
+
+/* Read Scattered Registers (FC100, vendor-specific) */
+#ifndef MODBUS_ENABLE_FC_READ_SCATTERED_REGISTERS
+#define MODBUS_ENABLE_FC_READ_SCATTERED_REGISTERS 1
+#endif
+
+/* PDU codecs shared by several function codes */
+#define MODBUS_PDU_HAS_READ_BITS \
+    (MODBUS_ENABLE_FC_READ_COILS || MODBUS_ENABLE_FC_READ_DISCRETE_INPUTS)
+#define MODBUS_PDU_HAS_READ_REGISTERS           \
+    (MODBUS_ENABLE_FC_READ_HOLDING_REGISTERS || \
+     MODBUS_ENABLE_FC_READ_INPUT_REGISTERS)
+#define MODBUS_PDU_HAS_REGISTERS_RESPONSE         \
+    (MODBUS_PDU_HAS_READ_REGISTERS ||             \
+     MODBUS_ENABLE_FC_READ_WRITE_MULTIPLE_REGS || \
+     MODBUS_ENABLE_FC_READ_SCATTERED_REGISTERS)
+#define MODBUS_PDU_HAS_WRITE_SINGLE        \
+    (MODBUS_ENABLE_FC_WRITE_SINGLE_COIL || \
+     MODBUS_ENABLE_FC_WRITE_SINGLE_REGISTER)
+#define MODBUS_PDU_HAS_WRITE_MULTIPLE         \
+    (MODBUS_ENABLE_FC_WRITE_MULTIPLE_COILS || \
+     MODBUS_ENABLE_FC_WRITE_MULTIPLE_REGISTERS)
+
 /* ==========================================================================
  * Buffer Sizes
  * ========================================================================== */
@@ -47,8 +135,20 @@
 #define MODBUS_ASCII_MAX_ADU_SIZE 513U /* : + 2*256 + CR + LF */
 #define MODBUS_TCP_MAX_ADU_SIZE   260U /* 7 (MBAP) + 253 (PDU) */
 
-/* Maximum frame buffer size (use largest) */
+/* Position of the PDU in an RTU and a TCP frame, for building a response
+ * in place in a transmit buffer */
+#define MODBUS_RTU_PDU_OFFSET 1U /* Address */
+#define MODBUS_TCP_PDU_OFFSET 7U /* MBAP header */
+
+/* Maximum frame buffer size: the largest ADU of the protocols enabled, so
+ * that an RTU and TCP build does not carry ASCII sized buffers */
+#if MODBUS_ENABLE_ASCII
 #define MODBUS_MAX_FRAME_SIZE MODBUS_ASCII_MAX_ADU_SIZE
+#elif MODBUS_ENABLE_TCP
+#define MODBUS_MAX_FRAME_SIZE MODBUS_TCP_MAX_ADU_SIZE
+#else
+#define MODBUS_MAX_FRAME_SIZE MODBUS_RTU_MAX_ADU_SIZE
+#endif
 
 /* Receive and transmit buffer sizes */
 #define MODBUS_RX_BUFFER_SIZE MODBUS_MAX_FRAME_SIZE
@@ -72,6 +172,91 @@
 /* Maximum number of registers that can be written in one request */
 #define MODBUS_MAX_WRITE_REGISTERS 123U
 
+/* ==========================================================================
+ * Function Code Dispatch
+ * ========================================================================== */
+/* Number of custom function code handlers per context */
+#ifndef MODBUS_MAX_CUSTOM_HANDLERS
+#define MODBUS_MAX_CUSTOM_HANDLERS 4U
+#endif
+
+/* Storage reserved for a statically allocated modbus_context_t (bytes) */
+#ifndef MODBUS_CONTEXT_STORAGE_SIZE
+#define MODBUS_CONTEXT_STORAGE_SIZE 664U
+#endif
+
+/* ==========================================================================
+ * Master Polling Engine
+ * ========================================================================== */
+/* Entries a poll table may hold */
+#ifndef MODBUS_MASTER_MAX_POLL_ITEMS
+#define MODBUS_MASTER_MAX_POLL_ITEMS 32U
+#endif
+
+/* Read requests the poll table may be merged into */
+#ifndef MODBUS_MASTER_MAX_BATCHES
+#define MODBUS_MASTER_MAX_BATCHES 16U
+#endif
+
+/* Transactions outstanding at once on Modbus TCP (RTU always uses 1) */
+#ifndef MODBUS_MASTER_MAX_PIPELINE
+#define MODBUS_MASTER_MAX_PIPELINE 4U
+#endif
+
+/* Unpolled addresses a merged read may span between two poll items; only
+ * raise this if the slave answers reads of the gap addresses */
+#ifndef MODBUS_MASTER_MERGE_GAP
+#define MODBUS_MASTER_MERGE_GAP 0U
+#endif
+
+/* ==========================================================================
+ * Latency Statistics
+ * ========================================================================== */
+/* Time slave requests by stage into per function code histograms, using
+ * the port hook modbus_port_cycle_count() */
+#ifndef MODBUS_ENABLE_LATENCY_STATS
+#define MODBUS_ENABLE_LATENCY_STATS 0
+#endif
+
+/* Buckets of a latency histogram */
+#ifndef MODBUS_LATENCY_BUCKETS
+#define MODBUS_LATENCY_BUCKETS 16U
+#endif
+
+/* Bucket 0 counts requests under 2^shift cycles, bucket n those from
+ * 2^(shift + n - 1) cycles on; the last bucket also takes everything longer */
+#ifndef MODBUS_LATENCY_MIN_SHIFT
+#define MODBUS_LATENCY_MIN_SHIFT 9U
+#endif
+
+/* ==========================================================================
+ * CRC-16 Backend
+ * ========================================================================== */
+#define MODBUS_CRC_BACKEND_TABLE 0 /* 256-entry lookup table, portable */
+#define MODBUS_CRC_BACKEND_HW    1 /* Port hook modbus_crc16_hw() */
+
+/* CRC-16 backend used by modbus_crc16() */
+#ifndef MODBUS_CRC_BACKEND
+#define MODBUS_CRC_BACKEND MODBUS_CRC_BACKEND_TABLE
+#endif
+
+/* Shortest buffer handed to the hardware backend; below this the table is
+ * faster than claiming and programming the CRC unit (bytes) */
+#ifndef MODBUS_CRC_HW_MIN_LENGTH
+#define MODBUS_CRC_HW_MIN_LENGTH 32U
+#endif
+
+/* Bytes folded in per step by the table backend: 1 (512 B of tables),
+ * 4 (2 KB) or 8 (4 KB) */
+#ifndef MODBUS_CRC_TABLE_SLICES
+#define MODBUS_CRC_TABLE_SLICES 1U
+#endif
+
+#if (MODBUS_CRC_TABLE_SLICES != 1U) && (MODBUS_CRC_TABLE_SLICES != 4U) && \
+    (MODBUS_CRC_TABLE_SLICES != 8U)
+#error "MODBUS_CRC_TABLE_SLICES must be 1, 4 or 8"
+#endif
+
 /* ==========================================================================
  * Timing Configuration
  * ========================================================================== */
@@ -30,14 +30,60 @@ extern "C"
      * ==========================================================================
      */
 
+/** Initial CRC-16 value of a Modbus RTU frame */
+#define MODBUS_CRC16_INIT 0xFFFFU
+
     /**
-     * @brief Calculate CRC-16 using lookup table
+     * @brief Calculate CRC-16 with the configured backend
+     *
+     * Uses modbus_crc16_hw() when MODBUS_CRC_BACKEND is
+     * MODBUS_CRC_BACKEND_HW and the buffer is at least
+     * MODBUS_CRC_HW_MIN_LENGTH bytes, the lookup table otherwise.
+     *
      * @param[in] data Data buffer
      * @param[in] length Length of data
      * @return CRC-16 value (low byte first, as per Modbus spec)
      */
     uint16_t modbus_crc16(const uint8_t *data, uint16_t length);
 
+    /**
+     * @brief Calculate CRC-16 using lookup table
+     * @param[in] data Data buffer
+     * @param[in] length Length of data
+     * @return CRC-16 value (low byte first, as per Modbus spec)
+     */
+    uint16_t modbus_crc16_table(const uint8_t *data, uint16_t length);
+
+    /**
+     * @brief Continue a CRC-16 over more data
+     *
+     * Start from MODBUS_CRC16_INIT; feeding a buffer in pieces gives the
+     * same value as modbus_crc16() over the whole buffer.
+     *
+     * @param[in] crc CRC-16 of the data so far
+     * @param[in] data Data buffer
+     * @param[in] length Length of data
+     * @return CRC-16 value including @p data
+     */
+    uint16_t modbus_crc16_update(uint16_t crc, const uint8_t *data,
+                                 uint16_t length);
+
+#if MODBUS_CRC_BACKEND == MODBUS_CRC_BACKEND_HW
+    /**
+     * @brief Calculate CRC-16 on a hardware CRC unit (port hook)
+     *
+     * Provided by the port when MODBUS_CRC_BACKEND is MODBUS_CRC_BACKEND_HW.
+     * Returns false without touching @p crc when the unit is owned by
+     * another caller, and modbus_crc16() then falls back to the table.
+     *
+     * @param[in] data Data buffer (not NULL)
+     * @param[in] length Length of data
+     * @param[out] crc CRC-16 value, as modbus_crc16_table() would return
+     * @return true if @p crc was computed by the hardware
+     */
+    bool modbus_crc16_hw(const uint8_t *data, uint16_t length, uint16_t *crc);
+#endif
+
     /**
      * @brief Calculate CRC-16 bit-by-bit (for verification)
      * @param[in] data Data buffer
@@ -112,6 +158,19 @@ extern "C"
     uint16_t modbus_binary_to_ascii(const uint8_t *binary, uint16_t binary_len,
                                     char *ascii, uint16_t ascii_size);
 
+    /**
+     * @brief Convert binary buffer to ASCII hex string, summing in the pass
+     * @param[in] binary Pointer to binary data
+     * @param[in] binary_len Length of binary data
+     * @param[out] ascii Pointer to ASCII output buffer
+     * @param[in] ascii_size Size of ASCII buffer
+     * @param[out] lrc LRC of the binary data (may be NULL)
+     * @return Number of ASCII characters written, or 0 on error
+     */
+    uint16_t modbus_binary_to_ascii_lrc(const uint8_t *binary,
+                                        uint16_t binary_len, char *ascii,
+                                        uint16_t ascii_size, uint8_t *lrc);
+
     /**
      * @brief Convert ASCII hex string to binary buffer
      * @param[in] ascii Pointer to ASCII hex string
@@ -123,6 +182,20 @@ extern "C"
     uint16_t modbus_ascii_to_binary(const char *ascii, uint16_t ascii_len,
                                     uint8_t *binary, uint16_t binary_size);
 
+    /**
+     * @brief Convert ASCII hex string to binary buffer, summing in the pass
+     * @param[in] ascii Pointer to ASCII hex string
+     * @param[in] ascii_len Length of ASCII string (must be even)
+     * @param[out] binary Pointer to binary output buffer
+     * @param[in] binary_size Size of binary buffer
+     * @param[out] lrc LRC of the decoded bytes, 0 over a frame including its
+     *                 LRC byte (may be NULL)
+     * @return Number of binary bytes written, or 0 on error
+     */
+    uint16_t modbus_ascii_to_binary_lrc(const char *ascii, uint16_t ascii_len,
+                                        uint8_t *binary, uint16_t binary_size,
+                                        uint8_t *lrc);
+
     /* ==========================================================================
      * PDU Functions (modbus_pdu.c)
      * ==========================================================================
@@ -179,6 +252,45 @@ extern "C"
         modbus_pdu_t *pdu, uint8_t function_code,
         modbus_exception_t exception_code);
 
+    /* Response Encoding into a PDU buffer (in place, no copy) */
+    void modbus_pdu_buffer_from_pdu(modbus_pdu_t        *pdu,
+                                    modbus_pdu_buffer_t *buffer);
+
+    modbus_error_t modbus_pdu_buffer_from_frame(uint8_t *frame, uint16_t size,
+                                                modbus_pdu_buffer_t *buffer);
+
+    modbus_error_t modbus_pdu_buffer_encode_read_bits_response(
+        modbus_pdu_buffer_t *buffer, uint8_t function_code,
+        const uint8_t *coil_values, uint16_t quantity);
+
+    modbus_error_t modbus_pdu_buffer_encode_read_registers_response(
+        modbus_pdu_buffer_t *buffer, uint8_t function_code,
+        const uint16_t *register_values, uint16_t quantity);
+
+    modbus_error_t modbus_pdu_buffer_encode_write_single_response(
+        modbus_pdu_buffer_t *buffer, uint8_t function_code, uint16_t address,
+        uint16_t value);
+
+    modbus_error_t modbus_pdu_buffer_encode_write_multiple_response(
+        modbus_pdu_buffer_t *buffer, uint8_t function_code,
+        uint16_t start_address, uint16_t quantity);
+
+    modbus_error_t modbus_pdu_buffer_encode_device_id_response(
+        modbus_pdu_buffer_t *buffer, uint8_t read_code,
+        uint8_t conformity_level, const modbus_device_id_object_t *objects,
+        uint8_t object_count);
+
+    modbus_error_t modbus_pdu_buffer_encode_file_record_response(
+        modbus_pdu_buffer_t *buffer, const uint16_t *record_lengths,
+        uint8_t count, const uint16_t *const *records);
+
+    modbus_error_t modbus_pdu_buffer_encode_file_write_response(
+        modbus_pdu_buffer_t *buffer, const modbus_pdu_view_t *request);
+
+    modbus_error_t modbus_pdu_buffer_encode_exception(
+        modbus_pdu_buffer_t *buffer, uint8_t function_code,
+        modbus_exception_t exception_code);
+
     /* Request Decoding */
     modbus_error_t modbus_pdu_decode_read_bits_request(const modbus_pdu_t *pdu,
                                                        uint16_t *start_address,
@@ -201,6 +313,64 @@ extern "C"
         const modbus_pdu_t *pdu, uint16_t *start_address, uint16_t *quantity,
         uint16_t *values, uint16_t max_values);
 
+    /* View Decoding (in-place, no copy) */
+    void modbus_pdu_view_from_pdu(const modbus_pdu_t *pdu,
+                                  modbus_pdu_view_t  *view);
+
+    modbus_error_t modbus_pdu_view_decode_read_bits_request(
+        const modbus_pdu_view_t *pdu, uint16_t *start_address,
+        uint16_t *quantity);
+
+    modbus_error_t modbus_pdu_view_decode_read_registers_request(
+        const modbus_pdu_view_t *pdu, uint16_t *start_address,
+        uint16_t *quantity);
+
+    modbus_error_t modbus_pdu_view_decode_write_single_coil_request(
+        const modbus_pdu_view_t *pdu, uint16_t *address, bool *value);
+
+    modbus_error_t modbus_pdu_view_decode_write_single_register_request(
+        const modbus_pdu_view_t *pdu, uint16_t *address, uint16_t *value);
+
+    modbus_error_t modbus_pdu_view_decode_write_multiple_coils_request(
+        const modbus_pdu_view_t *pdu, uint16_t *start_address,
+        uint16_t *quantity, const uint8_t **values);
+
+    modbus_error_t modbus_pdu_view_decode_write_multiple_registers_request(
+        const modbus_pdu_view_t *pdu, uint16_t *start_address,
+        uint16_t *quantity, uint16_t *values, uint16_t max_values);
+
+    modbus_error_t modbus_pdu_view_decode_read_write_registers_request(
+        const modbus_pdu_view_t *pdu, uint16_t *read_address,
+        uint16_t *read_quantity, uint16_t *write_address,
+        uint16_t *write_quantity, uint16_t *values, uint16_t max_values);
+
+    modbus_error_t modbus_pdu_view_decode_device_id_request(
+        const modbus_pdu_view_t *pdu, uint8_t *mei_type, uint8_t *read_code,
+        uint8_t *object_id);
+
+    modbus_error_t modbus_pdu_view_decode_file_record_count(
+        const modbus_pdu_view_t *pdu, uint8_t *count);
+
+    modbus_error_t modbus_pdu_view_decode_file_record_sub_request(
+        const modbus_pdu_view_t *pdu, uint8_t index, uint8_t *reference_type,
+        uint16_t *file_number, uint16_t *record_number,
+        uint16_t *record_length);
+
+    modbus_error_t modbus_pdu_view_decode_file_write_count(
+        const modbus_pdu_view_t *pdu, uint8_t *count);
+
+    modbus_error_t modbus_pdu_view_decode_file_write_sub_request(
+        const modbus_pdu_view_t *pdu, uint16_t *pos, uint8_t *reference_type,
+        uint16_t *file_number, uint16_t *record_number,
+        uint16_t *record_length, uint16_t *values, uint16_t max_values);
+
+    modbus_error_t modbus_pdu_view_decode_scatter_count(
+        const modbus_pdu_view_t *pdu, uint8_t *count);
+
+    modbus_error_t modbus_pdu_view_decode_scatter_descriptor(
+        const modbus_pdu_view_t *pdu, uint8_t index, uint8_t *table,
+        uint16_t *start_address, uint16_t *quantity);
+
     /* PDU Utilities */
     bool modbus_pdu_is_exception(const modbus_pdu_t *pdu);
 
@@ -228,6 +398,17 @@ extern "C"
                                           uint16_t       frame_length,
                                           modbus_adu_t  *adu);
 
+    modbus_error_t modbus_rtu_build_frame_in_place(uint8_t   unit_id,
+                                                   uint8_t  *frame,
+                                                   uint16_t  pdu_length,
+                                                   uint16_t  frame_size,
+                                                   uint16_t *frame_length);
+
+    modbus_error_t modbus_rtu_parse_frame_view(const uint8_t     *frame,
+                                               uint16_t           frame_length,
+                                               uint8_t           *unit_id,
+                                               modbus_pdu_view_t *pdu);
+
     uint32_t modbus_rtu_get_interframe_delay_us(uint32_t baudrate);
 
     uint32_t modbus_rtu_get_interchar_timeout_us(uint32_t baudrate);
@@ -267,6 +448,28 @@ extern "C"
                                           uint16_t       frame_length,
                                           modbus_adu_t  *adu);
 
+    modbus_error_t modbus_tcp_parse_frame_view(const uint8_t     *frame,
+                                               uint16_t           frame_length,
+                                               uint16_t          *transaction_id,
+                                               uint8_t           *unit_id,
+                                               modbus_pdu_view_t *pdu);
+
+    modbus_error_t modbus_tcp_build_frame_pdu(uint16_t            transaction_id,
+                                              uint8_t             unit_id,
+                                              const modbus_pdu_t *pdu,
+                                              uint8_t            *frame,
+                                              uint16_t            frame_size,
+                                              uint16_t           *frame_length);
+
+    modbus_error_t modbus_tcp_build_frame_in_place(uint16_t  transaction_id,
+                                                   uint8_t   unit_id,
+                                                   uint8_t  *frame,
+                                                   uint16_t  pdu_length,
+                                                   uint16_t  frame_size,
+                                                   uint16_t *frame_length);
+
+    uint16_t modbus_tcp_get_frame_length(const uint8_t *data, uint16_t length);
+
     uint16_t modbus_tcp_get_next_transaction_id(void);
 
     void modbus_tcp_reset_transaction_id(void);
@@ -279,6 +482,26 @@ extern "C"
 
     uint8_t modbus_tcp_get_unit_id(const uint8_t *frame);
 
+    modbus_error_t modbus_tcp_rx_init(modbus_tcp_rx_context_t *ctx,
+                                      uint32_t                 timeout_ms);
+
+    void modbus_tcp_rx_reset(modbus_tcp_rx_context_t *ctx);
+
+    modbus_error_t modbus_tcp_rx_process_data(modbus_tcp_rx_context_t *ctx,
+                                              const uint8_t           *data,
+                                              uint16_t                 length,
+                                              uint32_t  current_time_ms,
+                                              uint16_t *consumed);
+
+    bool modbus_tcp_rx_is_complete(const modbus_tcp_rx_context_t *ctx);
+
+    bool modbus_tcp_rx_is_timeout(const modbus_tcp_rx_context_t *ctx,
+                                  uint32_t current_time_ms);
+
+    modbus_error_t modbus_tcp_rx_get_frame(const modbus_tcp_rx_context_t *ctx,
+                                           const uint8_t **frame,
+                                           uint16_t       *length);
+
     /* ==========================================================================
      * Core Functions (modbus_core.c)
      * ==========================================================================
@@ -290,6 +513,17 @@ extern "C"
                                             const modbus_pdu_t *request,
                                             modbus_pdu_t       *response);
 
+    modbus_error_t modbus_slave_process_pdu_buffer(
+        modbus_context_t *ctx, const modbus_pdu_view_t *request,
+        modbus_pdu_buffer_t *response);
+
+    modbus_error_t modbus_slave_process_pdu_view(
+        modbus_context_t *ctx, const modbus_pdu_view_t *request,
+        modbus_pdu_t *response);
+
+    uint16_t modbus_slave_get_response_bound(const modbus_context_t *ctx,
+                                             uint8_t function_code);
+
     modbus_error_t modbus_slave_process_adu(modbus_context_t   *ctx,
                                             const modbus_adu_t *request,
                                             modbus_adu_t       *response,
@@ -301,6 +535,19 @@ extern "C"
 
     uint32_t modbus_get_exceptions_sent(const modbus_context_t *ctx);
 
+#if MODBUS_ENABLE_LATENCY_STATS
+    /**
+     * @brief Read a free-running cycle counter (port hook)
+     *
+     * Provided by the port when MODBUS_ENABLE_LATENCY_STATS is 1, typically
+     * from the DWT cycle counter. Only differences of two readings are used,
+     * so the counter may wrap.
+     *
+     * @return Current cycle count
+     */
+    uint32_t modbus_port_cycle_count(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus Master Polling Engine
+ *
+ * Reads downstream slaves cyclically from a poll table fixed at build time.
+ * Each table entry names a block of coils, discrete inputs or registers, how
+ * often it is wanted and where the values go. At initialization the entries
+ * of one slave, function code and period that touch are merged into as few
+ * read requests as the per-request limits (MODBUS_MAX_READ_REGISTERS etc.)
+ * allow. The requests are then issued earliest deadline first, so a fast
+ * group is not held up behind a slow one sharing the bus.
+ *
+ * The engine only builds request frames and consumes response frames; the
+ * caller moves them over its transport. On RTU one transaction is
+ * outstanding at a time. On TCP up to MODBUS_MASTER_MAX_PIPELINE are, and
+ * responses are matched to their request by transaction ID in whatever
+ * order they arrive.
+ *
+ * All state lives in the caller's modbus_poller_t; nothing is allocated.
+ */
+
+#ifndef MODBUS_MASTER_H
+#define MODBUS_MASTER_H
+
+#include "modbus_config.h"
+#include "modbus_types.h"
+
+#if MODBUS_ENABLE_MASTER
+
+#if MODBUS_MASTER_MAX_BATCHES > 255U
+#error "MODBUS_MASTER_MAX_BATCHES must fit the uint8_t item to batch map"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* ==========================================================================
+     * Poll Table Types
+     * ==========================================================================
+     */
+
+    /**
+     * @brief One poll table entry
+     *
+     * @p values receives @p quantity registers (uint16_t[], FC03/FC04) or
+     * @p quantity bit-packed coils or inputs (uint8_t[], FC01/FC02, LSB
+     * first) each time the entry is read.
+     */
+    typedef struct
+    {
+        uint8_t  unit_id;       /**< Slave address (1-247 on RTU) */
+        uint8_t  function_code; /**< MODBUS_FC_READ_COILS..INPUT_REGISTERS */
+        uint16_t start_address; /**< First address read */
+        uint16_t quantity;      /**< Number of coils, inputs or registers */
+        uint32_t period_ms;     /**< Poll period, entries with equal period
+                                     form one poll group */
+        void    *values;        /**< Destination of the values read */
+    } modbus_poll_item_t;
+
+    /**
+     * @brief Result of the reads of one merged request
+     */
+    typedef struct
+    {
+        uint32_t           updated_ms;     /**< Time of the last good read */
+        uint32_t           responses;      /**< Reads that returned data */
+        uint32_t           failures;       /**< Exceptions, timeouts and
+                                                malformed responses */
+        modbus_error_t     last_error;     /**< Result of the last read */
+        modbus_exception_t last_exception; /**< Code of the last exception */
+    } modbus_poll_status_t;
+
+    /**
+     * @brief Read request built from one or more poll items (engine state)
+     */
+    typedef struct
+    {
+        uint8_t              unit_id;       /**< Slave address */
+        uint8_t              function_code; /**< Read function code */
+        uint16_t             start_address; /**< First address read */
+        uint16_t             quantity;      /**< Number of values read */
+        uint32_t             period_ms;     /**< Poll period */
+        uint32_t             due_ms;        /**< Time of the next read */
+        bool                 in_flight;     /**< Request outstanding */
+        modbus_poll_status_t status;        /**< Read results */
+    } modbus_poll_batch_t;
+
+    /**
+     * @brief Outstanding transaction (engine state)
+     */
+    typedef struct
+    {
+        bool     active;         /**< Slot in use */
+        uint8_t  batch;          /**< Index of the batch requested */
+        uint16_t transaction_id; /**< MBAP transaction ID (TCP only) */
+        uint32_t sent_ms;        /**< Time the request was built */
+    } modbus_poll_pending_t;
+
+    /**
+     * @brief Poller state, statically allocated by the caller
+     */
+    typedef struct
+    {
+        const modbus_poll_item_t *items;      /**< Poll table */
+        uint16_t                  item_count; /**< Poll table entries */
+        uint16_t                  batch_count; /**< Merged requests */
+        modbus_poll_batch_t   batches[MODBUS_MASTER_MAX_BATCHES];
+        uint8_t               item_batch[MODBUS_MASTER_MAX_POLL_ITEMS];
+        modbus_poll_pending_t pending[MODBUS_MASTER_MAX_PIPELINE];
+        uint8_t               pipeline_depth; /**< Usable pending slots */
+        modbus_protocol_t     protocol;       /**< RTU or TCP framing */
+        uint16_t              next_transaction_id; /**< Next MBAP ID */
+        uint32_t              response_timeout_ms; /**< Response timeout */
+    } modbus_poller_t;
+
+    /* ==========================================================================
+     * Poll Engine API
+     * ==========================================================================
+     */
+
+    /**
+     * @brief Initialize a poller and merge its poll table
+     *
+     * Every merged request is due at @p now_ms.
+     *
+     * @param[out] poller              Poller to initialize
+     * @param[in]  items               Poll table, must outlive the poller
+     * @param[in]  item_count          Number of entries
+     *                                 (1-MODBUS_MASTER_MAX_POLL_ITEMS)
+     * @param[in]  protocol            MODBUS_PROTOCOL_RTU or
+     *                                 MODBUS_PROTOCOL_TCP
+     * @param[in]  response_timeout_ms Time a request may stay unanswered
+     * @param[in]  now_ms              Current time in milliseconds
+     * @return MODBUS_OK on success, MODBUS_ERROR_INVALID_PARAM for a bad
+     *         entry, MODBUS_ERROR_BUFFER_OVERFLOW if the table does not
+     *         merge into MODBUS_MASTER_MAX_BATCHES requests
+     */
+    modbus_error_t modbus_poll_init(modbus_poller_t          *poller,
+                                    const modbus_poll_item_t *items,
+                                    uint16_t item_count,
+                                    modbus_protocol_t protocol,
+                                    uint32_t response_timeout_ms,
+                                    uint32_t now_ms);
+
+    /**
+     * @brief Build the frame of the next request due
+     *
+     * Retires timed out transactions first. Of the requests due, the one
+     * with the earliest deadline (due time plus period) is sent.
+     *
+     * @param[in,out] poller       Initialized poller
+     * @param[in]     now_ms       Current time in milliseconds
+     * @param[out]    frame        Frame buffer
+     * @param[in]     frame_size   Frame buffer size
+     * @param[out]    frame_length Length of the frame built
+     * @return MODBUS_OK if a frame was built, MODBUS_ERROR_BUSY if nothing is
+     *         due or every transaction slot is taken
+     */
+    modbus_error_t modbus_poll_next_request(modbus_poller_t *poller,
+                                            uint32_t         now_ms,
+                                            uint8_t         *frame,
+                                            uint16_t         frame_size,
+                                            uint16_t        *frame_length);
+
+    /**
+     * @brief Consume a response frame
+     *
+     * Stores the values of a matching response in the poll items and
+     * completes the transaction. A frame that matches no outstanding
+     * transaction, such as a response arriving after its timeout, is
+     * ignored.
+     *
+     * @param[in,out] poller       Initialized poller
+     * @param[in]     frame        Complete RTU or MBAP frame
+     * @param[in]     frame_length Frame length in bytes
+     * @param[in]     now_ms       Current time in milliseconds
+     * @return MODBUS_OK if values were stored, MODBUS_ERROR_EXCEPTION if the
+     *         slave answered with an exception, MODBUS_ERROR_INVALID_STATE
+     *         if nothing was waiting for the frame, or the framing error
+     */
+    modbus_error_t modbus_poll_handle_response(modbus_poller_t *poller,
+                                               const uint8_t   *frame,
+                                               uint16_t         frame_length,
+                                               uint32_t         now_ms);
+
+    /**
+     * @brief Time until the poller next needs modbus_poll_next_request()
+     *
+     * The earlier of the next request due with a free transaction slot and
+     * the next transaction timeout; a transport can wait this long for a
+     * response.
+     *
+     * @param[in] poller Initialized poller
+     * @param[in] now_ms Current time in milliseconds
+     * @return Milliseconds, 0 if a request is due now
+     */
+    uint32_t modbus_poll_time_to_next(const modbus_poller_t *poller,
+                                      uint32_t               now_ms);
+
+    /**
+     * @brief Return the read results of a poll item
+     *
+     * Items merged into one request share its results.
+     *
+     * @param[in]  poller     Initialized poller
+     * @param[in]  item_index Index of the entry in the poll table
+     * @param[out] status     Destination
+     * @return MODBUS_OK, or MODBUS_ERROR_INVALID_PARAM for a bad index
+     */
+    modbus_error_t modbus_poll_get_status(const modbus_poller_t *poller,
+                                          uint16_t               item_index,
+                                          modbus_poll_status_t  *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODBUS_ENABLE_MASTER */
+
+#endif /* MODBUS_MASTER_H */
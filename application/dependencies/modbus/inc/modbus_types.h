@@ -103,9 +103,23 @@ typedef enum
     /* Register Mask Write */
     MODBUS_FC_MASK_WRITE_REGISTER = 0x16, /**< Mask Write Register (FC22) */
     MODBUS_FC_READ_WRITE_MULTIPLE_REGS =
-        0x17 /**< Read/Write Multiple Regs (FC23) */
+        0x17, /**< Read/Write Multiple Regs (FC23) */
+
+    /* Encapsulated Interface Transport */
+    MODBUS_FC_ENCAPSULATED_INTERFACE =
+        0x2B, /**< Encapsulated Interface Transport (FC43) */
+
+    /* User-defined range (100-110) */
+    MODBUS_FC_READ_SCATTERED_REGISTERS =
+        0x64 /**< Read Scattered Registers (FC100, vendor-specific) */
 } modbus_function_code_t;
 
+/** Most descriptors of a Read Scattered Registers (FC100) request */
+#define MODBUS_SCATTER_MAX_DESCRIPTORS 50U
+
+/** MEI type of Read Device Identification (FC43/14) */
+#define MODBUS_MEI_READ_DEVICE_ID 0x0EU
+
 /* ==========================================================================
  * Protocol and Mode Types
  * ========================================================================== */
@@ -146,6 +160,35 @@ typedef struct
     uint16_t data_length;                    /**< Length of data in bytes */
 } modbus_pdu_t;
 
+/**
+ * @brief Non-owning view of a received PDU
+ *
+ * Points into the buffer the frame was received in, so a request can be
+ * decoded without copying its data into a modbus_pdu_t. The underlying
+ * buffer must stay valid for as long as the view is used.
+ */
+typedef struct
+{
+    uint8_t        function_code; /**< Function code */
+    const uint8_t *data;          /**< PDU data following the function code */
+    uint16_t       data_length;   /**< Length of data in bytes */
+} modbus_pdu_view_t;
+
+/**
+ * @brief Writable PDU destination
+ *
+ * Lets a response be encoded either into a modbus_pdu_t or straight into a
+ * transmit frame, where the function code is followed by the data. The
+ * encoder sets @p data_length.
+ */
+typedef struct
+{
+    uint8_t *function_code; /**< Where the function code is written */
+    uint8_t *data;          /**< Where the PDU data is written */
+    uint16_t data_size;     /**< Space at data in bytes */
+    uint16_t data_length;   /**< Length of the data written */
+} modbus_pdu_buffer_t;
+
 /**
  * @brief Modbus Application Data Unit (ADU)
  *
@@ -219,6 +262,209 @@ typedef struct
     const uint16_t *values;        /**< Register values */
 } modbus_write_multiple_registers_request_t;
 
+/* ==========================================================================
+ * Device Identification Types
+ * ========================================================================== */
+
+/**
+ * @brief Read Device ID codes of an FC43/14 request
+ */
+typedef enum
+{
+    MODBUS_DEVICE_ID_BASIC    = 0x01, /**< Stream objects 0x00-0x02 */
+    MODBUS_DEVICE_ID_REGULAR  = 0x02, /**< Stream objects 0x00-0x7F */
+    MODBUS_DEVICE_ID_EXTENDED = 0x03, /**< Stream objects 0x00-0xFF */
+    MODBUS_DEVICE_ID_SPECIFIC = 0x04  /**< One object */
+} modbus_device_id_code_t;
+
+/**
+ * @brief Standard device identification object IDs
+ */
+typedef enum
+{
+    MODBUS_DEVICE_ID_VENDOR_NAME           = 0x00, /**< Basic, mandatory */
+    MODBUS_DEVICE_ID_PRODUCT_CODE          = 0x01, /**< Basic, mandatory */
+    MODBUS_DEVICE_ID_MAJOR_MINOR_REVISION  = 0x02, /**< Basic, mandatory */
+    MODBUS_DEVICE_ID_VENDOR_URL            = 0x03, /**< Regular */
+    MODBUS_DEVICE_ID_PRODUCT_NAME          = 0x04, /**< Regular */
+    MODBUS_DEVICE_ID_MODEL_NAME            = 0x05, /**< Regular */
+    MODBUS_DEVICE_ID_USER_APPLICATION_NAME = 0x06  /**< Regular */
+} modbus_device_id_object_id_t;
+
+/**
+ * @brief One device identification object
+ */
+typedef struct
+{
+    uint8_t     id;     /**< Object ID */
+    uint8_t     length; /**< Length of the value in bytes */
+    const char *value;  /**< ASCII value, need not be NUL terminated */
+} modbus_device_id_object_t;
+
+/**
+ * @brief Device identification served by FC43/14
+ *
+ * Typically a constant table in flash. Objects are sorted by ascending ID
+ * and include the three mandatory basic objects.
+ */
+typedef struct
+{
+    const modbus_device_id_object_t *objects;      /**< Object table */
+    uint8_t                          object_count; /**< Number of objects */
+} modbus_device_id_t;
+
+/* ==========================================================================
+ * File Record Types
+ * ========================================================================== */
+
+/** Reference type of every file record sub-request */
+#define MODBUS_FILE_REFERENCE_TYPE 0x06U
+
+/** Highest record number of a file */
+#define MODBUS_FILE_MAX_RECORD 0x270FU
+
+/**
+ * @brief Read records of a file, serving one FC20 sub-request
+ *
+ * @param[in]  file_number   File number (1-0xFFFF)
+ * @param[in]  record_number First record (0-0x270F)
+ * @param[in]  record_length Number of records, 1 or more
+ * @param[out] values        Record values in native byte order
+ * @return MODBUS_EXCEPTION_NONE on success, or the exception to answer
+ */
+typedef modbus_exception_t (*modbus_file_read_t)(uint16_t  file_number,
+                                                 uint16_t  record_number,
+                                                 uint16_t  record_length,
+                                                 uint16_t *values);
+
+/**
+ * @brief Find records of a file in memory, for one FC20 sub-request
+ *
+ * Lets a file held as native-order words be encoded into the response
+ * straight from where it lives, without a copy into the context. The
+ * records must stay unchanged until the response has been encoded.
+ *
+ * @param[in] file_number   File number (1-0xFFFF)
+ * @param[in] record_number First record (0-0x270F)
+ * @param[in] record_length Number of records, 1 or more
+ * @return The records, or NULL to have the file reader serve the
+ *         sub-request
+ */
+typedef const uint16_t *(*modbus_file_map_t)(uint16_t file_number,
+                                             uint16_t record_number,
+                                             uint16_t record_length);
+
+/**
+ * @brief Write records of a file, serving one FC21 sub-request
+ *
+ * @param[in] file_number   File number (1-0xFFFF)
+ * @param[in] record_number First record (0-0x270F)
+ * @param[in] record_length Number of records, 1 or more
+ * @param[in] values        Record values in native byte order
+ * @return MODBUS_EXCEPTION_NONE on success, or the exception to answer
+ */
+typedef modbus_exception_t (*modbus_file_write_t)(uint16_t        file_number,
+                                                  uint16_t        record_number,
+                                                  uint16_t        record_length,
+                                                  const uint16_t *values);
+
+/* ==========================================================================
+ * Slave Callback Table
+ * ========================================================================== */
+
+/**
+ * @brief Data callbacks of one slave context
+ *
+ * The entries have the signatures and contracts of the modbus_cb_*
+ * functions of modbus_callbacks.h, which a context uses until it is given
+ * a table of its own. Every entry must be set. Typically a constant table
+ * in flash, one per register map served.
+ */
+typedef struct
+{
+    modbus_exception_t (*read_coils)(uint16_t start_address, uint16_t quantity,
+                                     uint8_t *coil_values);
+    modbus_exception_t (*write_single_coil)(uint16_t address, bool value);
+    modbus_exception_t (*write_multiple_coils)(uint16_t       start_address,
+                                               uint16_t       quantity,
+                                               const uint8_t *coil_values);
+    modbus_exception_t (*read_discrete_inputs)(uint16_t start_address,
+                                               uint16_t quantity,
+                                               uint8_t *input_values);
+    modbus_exception_t (*read_holding_registers)(uint16_t  start_address,
+                                                 uint16_t  quantity,
+                                                 uint16_t *register_values);
+    modbus_exception_t (*write_single_register)(uint16_t address,
+                                                uint16_t value);
+    modbus_exception_t (*write_multiple_registers)(
+        uint16_t start_address, uint16_t quantity,
+        const uint16_t *register_values);
+    modbus_exception_t (*read_input_registers)(uint16_t  start_address,
+                                               uint16_t  quantity,
+                                               uint16_t *register_values);
+} modbus_slave_callbacks_t;
+
+/* ==========================================================================
+ * Latency Statistics Types
+ * ========================================================================== */
+
+/**
+ * @brief Function code groups with a latency histogram of their own
+ */
+typedef enum
+{
+    MODBUS_LATENCY_FC01 = 0, /**< Read Coils */
+    MODBUS_LATENCY_FC02,     /**< Read Discrete Inputs */
+    MODBUS_LATENCY_FC03,     /**< Read Holding Registers */
+    MODBUS_LATENCY_FC04,     /**< Read Input Registers */
+    MODBUS_LATENCY_FC05,     /**< Write Single Coil */
+    MODBUS_LATENCY_FC06,     /**< Write Single Register */
+    MODBUS_LATENCY_FC15,     /**< Write Multiple Coils */
+    MODBUS_LATENCY_FC16,     /**< Write Multiple Registers */
+    MODBUS_LATENCY_FC23,     /**< Read/Write Multiple Registers */
+    MODBUS_LATENCY_FC43,     /**< Encapsulated Interface Transport */
+    MODBUS_LATENCY_OTHER,    /**< Any other function code */
+    MODBUS_LATENCY_FC_COUNT  /**< Number of groups */
+} modbus_latency_fc_t;
+
+/**
+ * @brief Stages of a slave request
+ */
+typedef enum
+{
+    MODBUS_LATENCY_PARSE = 0, /**< Frame parsing, from the frame start mark */
+    MODBUS_LATENCY_DISPATCH,  /**< Handler lookup and request decoding */
+    MODBUS_LATENCY_CALLBACK,  /**< Application data callbacks */
+    MODBUS_LATENCY_ENCODE,    /**< Response encoding */
+    MODBUS_LATENCY_STAGE_COUNT /**< Number of stages */
+} modbus_latency_stage_t;
+
+/**
+ * @brief Latency histogram of one function code group
+ *
+ * Durations are in cycles of modbus_port_cycle_count(); see
+ * MODBUS_LATENCY_MIN_SHIFT for the bucket bounds.
+ */
+typedef struct
+{
+    uint32_t count; /**< Requests timed */
+    uint16_t buckets[MODBUS_LATENCY_BUCKETS]; /**< Requests per total
+                                                   latency, saturating */
+    uint64_t stage_cycles[MODBUS_LATENCY_STAGE_COUNT]; /**< Cycles spent
+                                                            per stage */
+} modbus_latency_histogram_t;
+
+/**
+ * @brief Latency statistics of one slave context, owned by the caller
+ *
+ * A context serves one transport, so attaching one of these to each
+ * context gives histograms per function code and transport.
+ */
+typedef struct
+{
+    modbus_latency_histogram_t fc[MODBUS_LATENCY_FC_COUNT]; /**< Per group */
+} modbus_latency_stats_t;
+
 /* ==========================================================================
  * State Machine Types
  * ========================================================================== */
@@ -274,6 +520,33 @@ typedef struct
     uint32_t timeout_ms; /**< Connection timeout in milliseconds */
 } modbus_tcp_config_t;
 
+/**
+ * @brief TCP receiver states
+ */
+typedef enum
+{
+    TCP_RX_STATE_HEADER = 0, /**< Receiving MBAP header */
+    TCP_RX_STATE_PDU,        /**< Receiving PDU data */
+    TCP_RX_STATE_COMPLETE,   /**< Frame reception complete */
+    TCP_RX_STATE_ERROR       /**< Reception error */
+} modbus_tcp_rx_state_t;
+
+/**
+ * @brief TCP receiver context
+ *
+ * Reassembles MBAP frames from a TCP byte stream. Owned by the caller so
+ * that each connection can keep its own partially received frame.
+ */
+typedef struct
+{
+    modbus_tcp_rx_state_t state;               /**< Current receiver state */
+    uint8_t  buffer[MODBUS_TCP_MAX_ADU_SIZE]; /**< Receive buffer */
+    uint16_t index;                            /**< Current buffer index */
+    uint16_t expected_length; /**< Expected total frame length */
+    uint32_t start_time;      /**< Timestamp of frame start */
+    uint32_t timeout_ms;      /**< Frame timeout in milliseconds */
+} modbus_tcp_rx_context_t;
+
 /* ==========================================================================
  * Context Configuration
  * ========================================================================== */
@@ -304,6 +577,56 @@ typedef struct
 /* Forward declare context structure (defined in modbus_core.c) */
 typedef struct modbus_context modbus_context_t;
 
+/**
+ * @brief Suitably aligned storage for a statically allocated context
+ *
+ * modbus_core.c checks at compile time that the context fits.
+ */
+typedef union
+{
+    uint8_t  bytes[MODBUS_CONTEXT_STORAGE_SIZE]; /**< Raw storage */
+    uint32_t align_word;                         /**< Forces alignment */
+    void    *align_ptr;                          /**< Forces alignment */
+} modbus_context_storage_t;
+
+/* ==========================================================================
+ * Function Code Dispatch
+ * ========================================================================== */
+
+/**
+ * @brief Function code handler
+ *
+ * Called by the slave core once the request data length has been checked
+ * against the entry's bounds. The handler writes the response PDU, encoding
+ * an exception response itself if the request cannot be served. The
+ * response buffer may be the transport's transmit frame; it holds at least
+ * the entry's max_response_length bytes.
+ *
+ * @param[in] ctx Modbus context (scratch buffers, statistics)
+ * @param[in] request Request PDU view
+ * @param[out] response Response PDU buffer to fill
+ * @return MODBUS_OK if a response (normal or exception) was encoded
+ */
+typedef modbus_error_t (*modbus_fc_handler_t)(modbus_context_t        *ctx,
+                                              const modbus_pdu_view_t *request,
+                                              modbus_pdu_buffer_t *response);
+
+/**
+ * @brief Function code dispatch table entry
+ *
+ * Entries for the standard function codes live in a constant table in
+ * modbus_core.c. Applications can add entries for other function codes with
+ * modbus_slave_register_handler().
+ */
+typedef struct
+{
+    uint8_t             function_code;   /**< Function code served */
+    modbus_fc_handler_t handler;         /**< Handler, NULL if unsupported */
+    uint16_t            min_data_length; /**< Minimum request data bytes */
+    uint16_t            max_data_length; /**< Maximum request data bytes */
+    uint16_t max_response_length; /**< Upper bound of the response PDU size */
+} modbus_fc_entry_t;
+
 /* Forward declare protocol operations (defined in protocol headers) */
 typedef struct modbus_protocol_ops modbus_protocol_ops_t;
 
@@ -34,6 +34,22 @@
 /** Maximum number of registers that can be written */
 #define MAX_WRITE_REGISTERS 123U
 
+/** Maximum number of registers that FC23 can write */
+#define MAX_READ_WRITE_REGISTERS 121U
+
+/** Conformity level flag: objects can also be read individually */
+#define DEVICE_ID_INDIVIDUAL_ACCESS 0x80U
+
+/** Most sub-requests an FC20 request can hold (byte count 0xF5) */
+#define MAX_FILE_SUB_REQUESTS 35U
+
+/** FC20 response data after the length byte: 2 bytes per sub-response
+ *  header and 2 per record */
+#define MAX_FILE_RESPONSE_DATA (MODBUS_MAX_PDU_SIZE - 2U)
+
+/** Most records one FC21 sub-request can hold (byte count 0xFB) */
+#define MAX_FILE_WRITE_RECORDS 122U
+
 /* ==========================================================================
  * Context Structure Definition
  * ========================================================================== */
@@ -53,12 +69,224 @@ struct modbus_context
     uint8_t  coil_buffer[256];     /**< Buffer for coil data */
     uint16_t register_buffer[125]; /**< Buffer for register data */
 
+    /* Custom function code handlers */
+    const modbus_fc_entry_t *custom_handlers[MODBUS_MAX_CUSTOM_HANDLERS];
+    uint8_t                  custom_handler_count;
+
+    /* Device identification served by FC43/14, NULL if not provided */
+    const modbus_device_id_t *device_id;
+
+    /* Reader of the files served by FC20, NULL if not provided */
+    modbus_file_read_t file_reader;
+
+    /* Finds FC20 records in memory, NULL to read them all */
+    modbus_file_map_t file_mapper;
+
+    /* Writer of the files served by FC21, NULL if not provided */
+    modbus_file_write_t file_writer;
+
+    /* Data callbacks, s_global_callbacks unless the slave set a table */
+    const modbus_slave_callbacks_t *callbacks;
+
+#if MODBUS_ENABLE_LATENCY_STATS
+    /* Latency statistics, NULL if not attached */
+    modbus_latency_stats_t *latency;
+    uint32_t latency_frame_start;    /**< Cycle count of the frame mark */
+    uint32_t latency_dispatch_start; /**< Cycle count at dispatch */
+    uint32_t latency_callback_start; /**< Cycle count before the callback */
+    uint32_t latency_callback_end;   /**< Cycle count after the callback */
+    bool     latency_frame_marked;   /**< Frame start mark is pending */
+    bool     latency_callback_timed; /**< Callback stamps are valid */
+#endif
+
     /* Statistics */
     uint32_t requests_processed; /**< Number of requests processed */
     uint32_t errors_count;       /**< Number of errors */
     uint32_t exceptions_sent;    /**< Number of exceptions sent */
 };
 
+_Static_assert(sizeof(struct modbus_context) <= MODBUS_CONTEXT_STORAGE_SIZE,
+               "MODBUS_CONTEXT_STORAGE_SIZE too small for modbus_context_t");
+
+/** The modbus_cb_* functions of the application, used by default */
+static const modbus_slave_callbacks_t s_global_callbacks = {
+    modbus_cb_read_coils,
+    modbus_cb_write_single_coil,
+    modbus_cb_write_multiple_coils,
+    modbus_cb_read_discrete_inputs,
+    modbus_cb_read_holding_registers,
+    modbus_cb_write_single_register,
+    modbus_cb_write_multiple_registers,
+    modbus_cb_read_input_registers,
+};
+
+/* ==========================================================================
+ * Latency Statistics Helpers
+ *
+ * Compile to nothing unless MODBUS_ENABLE_LATENCY_STATS is set. A request
+ * costs five cycle counter reads and one histogram update.
+ * ========================================================================== */
+
+/**
+ * @brief Stamp the start of a dispatch
+ */
+static void latency_dispatch_begin(modbus_context_t *ctx)
+{
+#if MODBUS_ENABLE_LATENCY_STATS
+    if (ctx->latency != NULL)
+    {
+        ctx->latency_dispatch_start = modbus_port_cycle_count();
+        ctx->latency_callback_timed = false;
+    }
+#else
+    (void)ctx;
+#endif
+}
+
+/**
+ * @brief Stamp the start of a handler's application callback
+ */
+static void latency_callback_begin(modbus_context_t *ctx)
+{
+#if MODBUS_ENABLE_LATENCY_STATS
+    if (ctx->latency != NULL)
+    {
+        ctx->latency_callback_start = modbus_port_cycle_count();
+    }
+#else
+    (void)ctx;
+#endif
+}
+
+/**
+ * @brief Stamp the end of a handler's application callback
+ */
+static void latency_callback_end(modbus_context_t *ctx)
+{
+#if MODBUS_ENABLE_LATENCY_STATS
+    if (ctx->latency != NULL)
+    {
+        ctx->latency_callback_end   = modbus_port_cycle_count();
+        ctx->latency_callback_timed = true;
+    }
+#else
+    (void)ctx;
+#endif
+}
+
+#if MODBUS_ENABLE_LATENCY_STATS
+/**
+ * @brief Histogram group of a function code
+ */
+static modbus_latency_fc_t latency_fc_group(uint8_t function_code)
+{
+    modbus_latency_fc_t group;
+
+    switch (function_code)
+    {
+        case MODBUS_FC_READ_COILS:
+            group = MODBUS_LATENCY_FC01;
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            group = MODBUS_LATENCY_FC02;
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            group = MODBUS_LATENCY_FC03;
+            break;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            group = MODBUS_LATENCY_FC04;
+            break;
+        case MODBUS_FC_WRITE_SINGLE_COIL:
+            group = MODBUS_LATENCY_FC05;
+            break;
+        case MODBUS_FC_WRITE_SINGLE_REGISTER:
+            group = MODBUS_LATENCY_FC06;
+            break;
+        case MODBUS_FC_WRITE_MULTIPLE_COILS:
+            group = MODBUS_LATENCY_FC15;
+            break;
+        case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+            group = MODBUS_LATENCY_FC16;
+            break;
+        case MODBUS_FC_READ_WRITE_MULTIPLE_REGS:
+            group = MODBUS_LATENCY_FC23;
+            break;
+        case MODBUS_FC_ENCAPSULATED_INTERFACE:
+            group = MODBUS_LATENCY_FC43;
+            break;
+        default:
+            group = MODBUS_LATENCY_OTHER;
+            break;
+    }
+
+    return group;
+}
+#endif
+
+/**
+ * @brief Count a finished dispatch in the histogram of its function code
+ */
+static void latency_record(modbus_context_t *ctx, uint8_t function_code)
+{
+#if MODBUS_ENABLE_LATENCY_STATS
+    if (ctx->latency != NULL)
+    {
+        modbus_latency_histogram_t *histogram =
+            &ctx->latency->fc[latency_fc_group(function_code)];
+        uint32_t end = modbus_port_cycle_count();
+        uint32_t stage[MODBUS_LATENCY_STAGE_COUNT] = {0U};
+        uint32_t total;
+        uint32_t scaled;
+        uint32_t bucket = 0U;
+
+        if (ctx->latency_frame_marked)
+        {
+            stage[MODBUS_LATENCY_PARSE] =
+                ctx->latency_dispatch_start - ctx->latency_frame_start;
+            ctx->latency_frame_marked = false;
+        }
+
+        if (ctx->latency_callback_timed)
+        {
+            stage[MODBUS_LATENCY_DISPATCH] =
+                ctx->latency_callback_start - ctx->latency_dispatch_start;
+            stage[MODBUS_LATENCY_CALLBACK] =
+                ctx->latency_callback_end - ctx->latency_callback_start;
+            stage[MODBUS_LATENCY_ENCODE] = end - ctx->latency_callback_end;
+        }
+        else
+        {
+            /* Rejected before any callback: all of it is dispatch */
+            stage[MODBUS_LATENCY_DISPATCH] = end - ctx->latency_dispatch_start;
+        }
+
+        total = stage[MODBUS_LATENCY_PARSE] +
+                (end - ctx->latency_dispatch_start);
+
+        /* log2 bucket, see MODBUS_LATENCY_MIN_SHIFT */
+        scaled = total >> MODBUS_LATENCY_MIN_SHIFT;
+        while ((scaled != 0U) && (bucket < (MODBUS_LATENCY_BUCKETS - 1U)))
+        {
+            scaled >>= 1U;
+            bucket++;
+        }
+
+        if (histogram->buckets[bucket] < UINT16_MAX)
+        {
+            histogram->buckets[bucket]++;
+        }
+        histogram->count++;
+        for (uint32_t i = 0U; i < MODBUS_LATENCY_STAGE_COUNT; i++)
+        {
+            histogram->stage_cycles[i] += stage[i];
+        }
+    }
+#else
+    (void)ctx;
+    (void)function_code;
+#endif
+}
+
 /* ==========================================================================
  * Context Management Functions
  * ========================================================================== */
@@ -80,6 +308,7 @@ modbus_error_t modbus_init(modbus_context_t *ctx, const modbus_config_t *config)
         /* Initialize context */
         (void)memset(ctx, 0, sizeof(modbus_context_t));
         (void)memcpy(&ctx->config, config, sizeof(modbus_config_t));
+        ctx->callbacks   = &s_global_callbacks;
         ctx->state       = MODBUS_STATE_IDLE;
         ctx->initialized = true;
         result           = MODBUS_OK;
@@ -145,12 +374,14 @@ modbus_state_t modbus_get_state(const modbus_context_t *ctx)
  * Slave Request Processing Functions
  * ========================================================================== */
 
+#if MODBUS_ENABLE_FC_READ_COILS
+
 /**
  * @brief Process Read Coils (FC01) request
  */
-static modbus_error_t process_read_coils(modbus_context_t   *ctx,
-                                         const modbus_pdu_t *request,
-                                         modbus_pdu_t       *response)
+static modbus_error_t process_read_coils(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
     uint16_t           start_address;
     uint16_t           quantity;
@@ -158,48 +389,53 @@ static modbus_error_t process_read_coils(modbus_context_t   *ctx,
     modbus_error_t     err;
     modbus_error_t     result;
 
-    err =
-        modbus_pdu_decode_read_bits_request(request, &start_address, &quantity);
+    err = modbus_pdu_view_decode_read_bits_request(request, &start_address,
+                                                   &quantity);
     if (err != MODBUS_OK)
     {
-        result =
-            modbus_pdu_encode_exception(response, MODBUS_FC_READ_COILS,
-                                        MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_READ_COILS,
+            MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else if ((quantity == 0U) || (quantity > MAX_READ_COILS))
     {
         /* Validate quantity */
-        result =
-            modbus_pdu_encode_exception(response, MODBUS_FC_READ_COILS,
-                                        MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_READ_COILS,
+            MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else
     {
         /* Call user callback */
-        exception =
-            modbus_cb_read_coils(start_address, quantity, ctx->coil_buffer);
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->read_coils(start_address, quantity,
+                                               ctx->coil_buffer);
+        latency_callback_end(ctx);
         if (exception != MODBUS_EXCEPTION_NONE)
         {
             ctx->exceptions_sent++;
-            result = modbus_pdu_encode_exception(response, MODBUS_FC_READ_COILS,
-                                                 exception);
+            result = modbus_pdu_buffer_encode_exception(
+                response, MODBUS_FC_READ_COILS, exception);
         }
         else
         {
-            result = modbus_pdu_encode_read_bits_response(
+            result = modbus_pdu_buffer_encode_read_bits_response(
                 response, MODBUS_FC_READ_COILS, ctx->coil_buffer, quantity);
         }
     }
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_READ_DISCRETE_INPUTS
 
 /**
  * @brief Process Read Discrete Inputs (FC02) request
  */
-static modbus_error_t process_read_discrete_inputs(modbus_context_t   *ctx,
-                                                   const modbus_pdu_t *request,
-                                                   modbus_pdu_t       *response)
+static modbus_error_t process_read_discrete_inputs(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
     uint16_t           start_address;
     uint16_t           quantity;
@@ -207,35 +443,37 @@ static modbus_error_t process_read_discrete_inputs(modbus_context_t   *ctx,
     modbus_error_t     err;
     modbus_error_t     result;
 
-    err =
-        modbus_pdu_decode_read_bits_request(request, &start_address, &quantity);
+    err = modbus_pdu_view_decode_read_bits_request(request, &start_address,
+                                                   &quantity);
     if (err != MODBUS_OK)
     {
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_READ_DISCRETE_INPUTS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else if ((quantity == 0U) || (quantity > MAX_READ_COILS))
     {
         /* Validate quantity */
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_READ_DISCRETE_INPUTS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else
     {
         /* Call user callback */
-        exception = modbus_cb_read_discrete_inputs(start_address, quantity,
-                                                   ctx->coil_buffer);
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->read_discrete_inputs(
+            start_address, quantity, ctx->coil_buffer);
+        latency_callback_end(ctx);
         if (exception != MODBUS_EXCEPTION_NONE)
         {
             ctx->exceptions_sent++;
-            result = modbus_pdu_encode_exception(
+            result = modbus_pdu_buffer_encode_exception(
                 response, MODBUS_FC_READ_DISCRETE_INPUTS, exception);
         }
         else
         {
-            result = modbus_pdu_encode_read_bits_response(
+            result = modbus_pdu_buffer_encode_read_bits_response(
                 response, MODBUS_FC_READ_DISCRETE_INPUTS, ctx->coil_buffer,
                 quantity);
         }
@@ -243,12 +481,16 @@ static modbus_error_t process_read_discrete_inputs(modbus_context_t   *ctx,
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_READ_HOLDING_REGISTERS
 
 /**
  * @brief Process Read Holding Registers (FC03) request
  */
 static modbus_error_t process_read_holding_registers(
-    modbus_context_t *ctx, const modbus_pdu_t *request, modbus_pdu_t *response)
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
     uint16_t           start_address;
     uint16_t           quantity;
@@ -256,35 +498,37 @@ static modbus_error_t process_read_holding_registers(
     modbus_error_t     err;
     modbus_error_t     result;
 
-    err = modbus_pdu_decode_read_registers_request(request, &start_address,
-                                                   &quantity);
+    err = modbus_pdu_view_decode_read_registers_request(
+        request, &start_address, &quantity);
     if (err != MODBUS_OK)
     {
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_READ_HOLDING_REGISTERS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else if ((quantity == 0U) || (quantity > MAX_READ_REGISTERS))
     {
         /* Validate quantity */
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_READ_HOLDING_REGISTERS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else
     {
         /* Call user callback */
-        exception = modbus_cb_read_holding_registers(start_address, quantity,
-                                                     ctx->register_buffer);
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->read_holding_registers(
+            start_address, quantity, ctx->register_buffer);
+        latency_callback_end(ctx);
         if (exception != MODBUS_EXCEPTION_NONE)
         {
             ctx->exceptions_sent++;
-            result = modbus_pdu_encode_exception(
+            result = modbus_pdu_buffer_encode_exception(
                 response, MODBUS_FC_READ_HOLDING_REGISTERS, exception);
         }
         else
         {
-            result = modbus_pdu_encode_read_registers_response(
+            result = modbus_pdu_buffer_encode_read_registers_response(
                 response, MODBUS_FC_READ_HOLDING_REGISTERS,
                 ctx->register_buffer, quantity);
         }
@@ -292,13 +536,16 @@ static modbus_error_t process_read_holding_registers(
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_READ_INPUT_REGISTERS
 
 /**
  * @brief Process Read Input Registers (FC04) request
  */
-static modbus_error_t process_read_input_registers(modbus_context_t   *ctx,
-                                                   const modbus_pdu_t *request,
-                                                   modbus_pdu_t       *response)
+static modbus_error_t process_read_input_registers(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
     uint16_t           start_address;
     uint16_t           quantity;
@@ -306,35 +553,37 @@ static modbus_error_t process_read_input_registers(modbus_context_t   *ctx,
     modbus_error_t     err;
     modbus_error_t     result;
 
-    err = modbus_pdu_decode_read_registers_request(request, &start_address,
-                                                   &quantity);
+    err = modbus_pdu_view_decode_read_registers_request(
+        request, &start_address, &quantity);
     if (err != MODBUS_OK)
     {
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_READ_INPUT_REGISTERS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else if ((quantity == 0U) || (quantity > MAX_READ_REGISTERS))
     {
         /* Validate quantity */
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_READ_INPUT_REGISTERS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else
     {
         /* Call user callback */
-        exception = modbus_cb_read_input_registers(start_address, quantity,
-                                                   ctx->register_buffer);
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->read_input_registers(
+            start_address, quantity, ctx->register_buffer);
+        latency_callback_end(ctx);
         if (exception != MODBUS_EXCEPTION_NONE)
         {
             ctx->exceptions_sent++;
-            result = modbus_pdu_encode_exception(
+            result = modbus_pdu_buffer_encode_exception(
                 response, MODBUS_FC_READ_INPUT_REGISTERS, exception);
         }
         else
         {
-            result = modbus_pdu_encode_read_registers_response(
+            result = modbus_pdu_buffer_encode_read_registers_response(
                 response, MODBUS_FC_READ_INPUT_REGISTERS, ctx->register_buffer,
                 quantity);
         }
@@ -342,13 +591,16 @@ static modbus_error_t process_read_input_registers(modbus_context_t   *ctx,
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_SINGLE_COIL
 
 /**
  * @brief Process Write Single Coil (FC05) request
  */
-static modbus_error_t process_write_single_coil(modbus_context_t   *ctx,
-                                                const modbus_pdu_t *request,
-                                                modbus_pdu_t       *response)
+static modbus_error_t process_write_single_coil(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
     uint16_t           address;
     bool               value;
@@ -358,27 +610,29 @@ static modbus_error_t process_write_single_coil(modbus_context_t   *ctx,
 
     (void)ctx; /* Unused in this function */
 
-    err =
-        modbus_pdu_decode_write_single_coil_request(request, &address, &value);
+    err = modbus_pdu_view_decode_write_single_coil_request(request, &address,
+                                                           &value);
     if (err != MODBUS_OK)
     {
-        result =
-            modbus_pdu_encode_exception(response, MODBUS_FC_WRITE_SINGLE_COIL,
-                                        MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_WRITE_SINGLE_COIL,
+            MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else
     {
         /* Call user callback */
-        exception = modbus_cb_write_single_coil(address, value);
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->write_single_coil(address, value);
+        latency_callback_end(ctx);
         if (exception != MODBUS_EXCEPTION_NONE)
         {
-            result = modbus_pdu_encode_exception(
+            result = modbus_pdu_buffer_encode_exception(
                 response, MODBUS_FC_WRITE_SINGLE_COIL, exception);
         }
         else
         {
             /* Echo request as response */
-            result = modbus_pdu_encode_write_single_response(
+            result = modbus_pdu_buffer_encode_write_single_response(
                 response, MODBUS_FC_WRITE_SINGLE_COIL, address,
                 value ? 0xFF00U : 0x0000U);
         }
@@ -386,13 +640,16 @@ static modbus_error_t process_write_single_coil(modbus_context_t   *ctx,
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_SINGLE_REGISTER
 
 /**
  * @brief Process Write Single Register (FC06) request
  */
-static modbus_error_t process_write_single_register(modbus_context_t   *ctx,
-                                                    const modbus_pdu_t *request,
-                                                    modbus_pdu_t *response)
+static modbus_error_t process_write_single_register(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
     uint16_t           address;
     uint16_t           value;
@@ -402,40 +659,45 @@ static modbus_error_t process_write_single_register(modbus_context_t   *ctx,
 
     (void)ctx; /* Unused in this function */
 
-    err = modbus_pdu_decode_write_single_register_request(request, &address,
-                                                          &value);
+    err = modbus_pdu_view_decode_write_single_register_request(
+        request, &address, &value);
     if (err != MODBUS_OK)
     {
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_WRITE_SINGLE_REGISTER,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else
     {
         /* Call user callback */
-        exception = modbus_cb_write_single_register(address, value);
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->write_single_register(address, value);
+        latency_callback_end(ctx);
         if (exception != MODBUS_EXCEPTION_NONE)
         {
-            result = modbus_pdu_encode_exception(
+            result = modbus_pdu_buffer_encode_exception(
                 response, MODBUS_FC_WRITE_SINGLE_REGISTER, exception);
         }
         else
         {
             /* Echo request as response */
-            result = modbus_pdu_encode_write_single_response(
+            result = modbus_pdu_buffer_encode_write_single_response(
                 response, MODBUS_FC_WRITE_SINGLE_REGISTER, address, value);
         }
     }
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_MULTIPLE_COILS
 
 /**
  * @brief Process Write Multiple Coils (FC15) request
  */
-static modbus_error_t process_write_multiple_coils(modbus_context_t   *ctx,
-                                                   const modbus_pdu_t *request,
-                                                   modbus_pdu_t       *response)
+static modbus_error_t process_write_multiple_coils(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
     uint16_t           start_address;
     uint16_t           quantity;
@@ -446,34 +708,36 @@ static modbus_error_t process_write_multiple_coils(modbus_context_t   *ctx,
 
     (void)ctx; /* Unused in this function */
 
-    err = modbus_pdu_decode_write_multiple_coils_request(
+    err = modbus_pdu_view_decode_write_multiple_coils_request(
         request, &start_address, &quantity, &values);
     if (err != MODBUS_OK)
     {
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_WRITE_MULTIPLE_COILS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else if ((quantity == 0U) || (quantity > MAX_WRITE_COILS))
     {
         /* Validate quantity */
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_WRITE_MULTIPLE_COILS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else
     {
         /* Call user callback */
-        exception =
-            modbus_cb_write_multiple_coils(start_address, quantity, values);
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->write_multiple_coils(start_address,
+                                                         quantity, values);
+        latency_callback_end(ctx);
         if (exception != MODBUS_EXCEPTION_NONE)
         {
-            result = modbus_pdu_encode_exception(
+            result = modbus_pdu_buffer_encode_exception(
                 response, MODBUS_FC_WRITE_MULTIPLE_COILS, exception);
         }
         else
         {
-            result = modbus_pdu_encode_write_multiple_response(
+            result = modbus_pdu_buffer_encode_write_multiple_response(
                 response, MODBUS_FC_WRITE_MULTIPLE_COILS, start_address,
                 quantity);
         }
@@ -481,12 +745,16 @@ static modbus_error_t process_write_multiple_coils(modbus_context_t   *ctx,
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_MULTIPLE_REGISTERS
 
 /**
  * @brief Process Write Multiple Registers (FC16) request
  */
 static modbus_error_t process_write_multiple_registers(
-    modbus_context_t *ctx, const modbus_pdu_t *request, modbus_pdu_t *response)
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
     uint16_t           start_address;
     uint16_t           quantity;
@@ -494,35 +762,37 @@ static modbus_error_t process_write_multiple_registers(
     modbus_error_t     err;
     modbus_error_t     result;
 
-    err = modbus_pdu_decode_write_multiple_registers_request(
+    err = modbus_pdu_view_decode_write_multiple_registers_request(
         request, &start_address, &quantity, ctx->register_buffer,
         MAX_WRITE_REGISTERS);
     if (err != MODBUS_OK)
     {
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_WRITE_MULTIPLE_REGISTERS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else if ((quantity == 0U) || (quantity > MAX_WRITE_REGISTERS))
     {
         /* Validate quantity */
-        result = modbus_pdu_encode_exception(
+        result = modbus_pdu_buffer_encode_exception(
             response, MODBUS_FC_WRITE_MULTIPLE_REGISTERS,
             MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
     }
     else
     {
         /* Call user callback */
-        exception = modbus_cb_write_multiple_registers(start_address, quantity,
-                                                       ctx->register_buffer);
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->write_multiple_registers(
+            start_address, quantity, ctx->register_buffer);
+        latency_callback_end(ctx);
         if (exception != MODBUS_EXCEPTION_NONE)
         {
-            result = modbus_pdu_encode_exception(
+            result = modbus_pdu_buffer_encode_exception(
                 response, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, exception);
         }
         else
         {
-            result = modbus_pdu_encode_write_multiple_response(
+            result = modbus_pdu_buffer_encode_write_multiple_response(
                 response, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, start_address,
                 quantity);
         }
@@ -530,218 +800,1137 @@ static modbus_error_t process_write_multiple_registers(
 
     return result;
 }
+#endif
 
-/* ==========================================================================
- * Main Request Processing
- * ========================================================================== */
+#if MODBUS_ENABLE_FC_READ_WRITE_MULTIPLE_REGS
 
 /**
- * @brief Process a Modbus request PDU and generate response PDU
+ * @brief Process Read/Write Multiple Registers (FC23) request
  *
- * @param[in] ctx Pointer to context
- * @param[in] request Pointer to request PDU
- * @param[out] response Pointer to response PDU to fill
- * @return modbus_error_t MODBUS_OK on success
+ * The write is done before the read, so the response reflects it. Both run
+ * within one dispatch, so no other request is handled in between.
  */
-modbus_error_t modbus_slave_process_pdu(modbus_context_t   *ctx,
-                                        const modbus_pdu_t *request,
-                                        modbus_pdu_t       *response)
+static modbus_error_t process_read_write_multiple_registers(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
-    modbus_error_t err;
-    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+    uint16_t           read_address;
+    uint16_t           read_quantity;
+    uint16_t           write_address;
+    uint16_t           write_quantity;
+    modbus_exception_t exception;
+    modbus_error_t     err;
+    modbus_error_t     result;
 
-    if ((ctx != NULL) && (request != NULL) && (response != NULL))
+    err = modbus_pdu_view_decode_read_write_registers_request(
+        request, &read_address, &read_quantity, &write_address,
+        &write_quantity, ctx->register_buffer, MAX_READ_WRITE_REGISTERS);
+    if (err != MODBUS_OK)
     {
-        if (!ctx->initialized)
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_READ_WRITE_MULTIPLE_REGS,
+            MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+    }
+    else if ((read_quantity == 0U) || (read_quantity > MAX_READ_REGISTERS) ||
+             (write_quantity == 0U))
+    {
+        /* Validate quantities */
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_READ_WRITE_MULTIPLE_REGS,
+            MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+    }
+    else
+    {
+        /* Call user callbacks, write first */
+        latency_callback_begin(ctx);
+        exception = ctx->callbacks->write_multiple_registers(
+            write_address, write_quantity, ctx->register_buffer);
+        if (exception == MODBUS_EXCEPTION_NONE)
         {
-            result = MODBUS_ERROR_NOT_INITIALIZED;
+            exception = ctx->callbacks->read_holding_registers(
+                read_address, read_quantity, ctx->register_buffer);
+        }
+        latency_callback_end(ctx);
+
+        if (exception != MODBUS_EXCEPTION_NONE)
+        {
+            ctx->exceptions_sent++;
+            result = modbus_pdu_buffer_encode_exception(
+                response, MODBUS_FC_READ_WRITE_MULTIPLE_REGS, exception);
         }
         else
         {
-            ctx->requests_processed++;
-
-            /* Process based on function code */
-            switch (request->function_code)
-            {
-                case MODBUS_FC_READ_COILS:
-                    err = process_read_coils(ctx, request, response);
-                    break;
-
-                case MODBUS_FC_READ_DISCRETE_INPUTS:
-                    err = process_read_discrete_inputs(ctx, request, response);
-                    break;
-
-                case MODBUS_FC_READ_HOLDING_REGISTERS:
-                    err =
-                        process_read_holding_registers(ctx, request, response);
-                    break;
-
-                case MODBUS_FC_READ_INPUT_REGISTERS:
-                    err = process_read_input_registers(ctx, request, response);
-                    break;
-
-                case MODBUS_FC_WRITE_SINGLE_COIL:
-                    err = process_write_single_coil(ctx, request, response);
-                    break;
-
-                case MODBUS_FC_WRITE_SINGLE_REGISTER:
-                    err = process_write_single_register(ctx, request, response);
-                    break;
-
-                case MODBUS_FC_WRITE_MULTIPLE_COILS:
-                    err = process_write_multiple_coils(ctx, request, response);
-                    break;
-
-                case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
-                    err = process_write_multiple_registers(ctx, request,
-                                                           response);
-                    break;
-
-                default:
-                    /* Unsupported function code */
-                    ctx->exceptions_sent++;
-                    err = modbus_pdu_encode_exception(
-                        response, request->function_code,
-                        MODBUS_EXCEPTION_ILLEGAL_FUNCTION);
-                    break;
-            }
-
-            if (err != MODBUS_OK)
-            {
-                ctx->errors_count++;
-            }
-
-            result = err;
+            result = modbus_pdu_buffer_encode_read_registers_response(
+                response, MODBUS_FC_READ_WRITE_MULTIPLE_REGS,
+                ctx->register_buffer, read_quantity);
         }
     }
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_READ_SCATTERED_REGISTERS
 
 /**
- * @brief Process a complete Modbus ADU and generate response ADU
+ * @brief Process Read Scattered Registers (FC100) request
  *
- * @param[in] ctx Pointer to context
- * @param[in] request Pointer to request ADU
- * @param[out] response Pointer to response ADU to fill
- * @param[out] send_response Pointer to flag indicating if response should be
- * sent
- * @return modbus_error_t MODBUS_OK on success
+ * Each descriptor names a holding or input register block, by the function
+ * code that reads it; the blocks are read in turn through the callbacks
+ * into the register buffer and returned back to back, as one FC03
+ * response would return them. Together they must fit one response.
  */
-modbus_error_t modbus_slave_process_adu(modbus_context_t   *ctx,
-                                        const modbus_adu_t *request,
-                                        modbus_adu_t       *response,
-                                        bool               *send_response)
+static modbus_error_t process_read_scattered_registers(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
-    modbus_error_t err;
-    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+    modbus_exception_t exception = MODBUS_EXCEPTION_NONE;
+    uint16_t           words     = 0U;
+    uint8_t            count     = 0U;
+    modbus_error_t     result;
 
-    if ((ctx != NULL) && (request != NULL) && (response != NULL) &&
-        (send_response != NULL))
+    if (modbus_pdu_view_decode_scatter_count(request, &count) != MODBUS_OK)
     {
-        /* Check if request is for this slave */
-        if ((request->unit_id != ctx->config.unit_id) &&
-            (request->unit_id != 0U))
-        {
-            /* Not for us - don't respond */
-            *send_response = false;
-            result         = MODBUS_OK;
-        }
-        else
+        exception = MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    else
+    {
+        latency_callback_begin(ctx);
+        for (uint8_t i = 0U;
+             (i < count) && (exception == MODBUS_EXCEPTION_NONE); i++)
         {
-            /* Process PDU */
-            err = modbus_slave_process_pdu(ctx, &request->pdu, &response->pdu);
-            if (err != MODBUS_OK)
+            uint8_t  table         = 0U;
+            uint16_t start_address = 0U;
+            uint16_t quantity      = 0U;
+
+            (void)modbus_pdu_view_decode_scatter_descriptor(
+                request, i, &table, &start_address, &quantity);
+
+            if ((quantity == 0U) ||
+                (((uint32_t)words + quantity) > MAX_READ_REGISTERS))
             {
-                *send_response = false;
-                result         = err;
+                exception = MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            else if (table == MODBUS_FC_READ_HOLDING_REGISTERS)
+            {
+                exception = ctx->callbacks->read_holding_registers(
+                    start_address, quantity, &ctx->register_buffer[words]);
+            }
+            else if (table == MODBUS_FC_READ_INPUT_REGISTERS)
+            {
+                exception = ctx->callbacks->read_input_registers(
+                    start_address, quantity, &ctx->register_buffer[words]);
             }
             else
             {
-                /* Copy addressing info to response */
-                response->unit_id        = ctx->config.unit_id;
-                response->transaction_id = request->transaction_id;
-                response->protocol_id    = request->protocol_id;
-
-                /* Don't respond to broadcast requests */
-                *send_response = (request->unit_id != 0U);
-                result         = MODBUS_OK;
+                exception = MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
             }
+            words = (uint16_t)(words + quantity);
         }
+        latency_callback_end(ctx);
+    }
+
+    if (exception != MODBUS_EXCEPTION_NONE)
+    {
+        ctx->exceptions_sent++;
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_READ_SCATTERED_REGISTERS, exception);
+    }
+    else
+    {
+        result = modbus_pdu_buffer_encode_read_registers_response(
+            response, MODBUS_FC_READ_SCATTERED_REGISTERS, ctx->register_buffer,
+            words);
     }
 
     return result;
 }
+#endif
 
-/* ==========================================================================
- * Statistics Functions
- * ========================================================================== */
+#if MODBUS_ENABLE_FC_ENCAPSULATED_INTERFACE
 
 /**
- * @brief Get number of requests processed
+ * @brief Conformity level of a device identification table
  *
- * @param[in] ctx Pointer to context
- * @return uint32_t Number of requests processed
+ * The highest category with an object, with individual access supported.
  */
-uint32_t modbus_get_requests_processed(const modbus_context_t *ctx)
+static uint8_t device_id_conformity_level(const modbus_device_id_t *id)
 {
-    uint32_t result = 0U;
+    uint8_t last_id = id->objects[id->object_count - 1U].id;
+    uint8_t level   = MODBUS_DEVICE_ID_BASIC;
 
-    if ((ctx != NULL) && (ctx->initialized))
+    if (last_id >= 0x80U)
     {
-        result = ctx->requests_processed;
+        level = MODBUS_DEVICE_ID_EXTENDED;
+    }
+    else if (last_id > MODBUS_DEVICE_ID_MAJOR_MINOR_REVISION)
+    {
+        level = MODBUS_DEVICE_ID_REGULAR;
     }
 
-    return result;
+    return (uint8_t)(level | DEVICE_ID_INDIVIDUAL_ACCESS);
 }
 
 /**
- * @brief Get number of errors
+ * @brief Process Read Device Identification (FC43/14) request
  *
- * @param[in] ctx Pointer to context
- * @return uint32_t Number of errors
+ * Stream access (codes 01-03) sends the objects of the category from the
+ * requested object on; an object ID the device does not have restarts the
+ * stream at the first object. Individual access (code 04) sends one object.
  */
-uint32_t modbus_get_errors_count(const modbus_context_t *ctx)
+static modbus_error_t process_read_device_identification(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
-    uint32_t result = 0U;
-
-    if ((ctx != NULL) && (ctx->initialized))
+    const modbus_device_id_t *id = ctx->device_id;
+    modbus_exception_t        exception = MODBUS_EXCEPTION_NONE;
+    uint8_t                   mei_type;
+    uint8_t                   read_code;
+    uint8_t                   object_id;
+    uint8_t                   last_id   = 0x00U;
+    uint8_t                   first     = 0U;
+    uint8_t                   count     = 0U;
+    modbus_error_t            result;
+
+    if (modbus_pdu_view_decode_device_id_request(request, &mei_type,
+                                                 &read_code, &object_id) !=
+        MODBUS_OK)
     {
-        result = ctx->errors_count;
+        exception = MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
     }
+    else if ((mei_type != MODBUS_MEI_READ_DEVICE_ID) || (id == NULL) ||
+             (id->object_count == 0U))
+    {
+        exception = MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+    }
+    else if (read_code == (uint8_t)MODBUS_DEVICE_ID_SPECIFIC)
+    {
+        while ((first < id->object_count) &&
+               (id->objects[first].id != object_id))
+        {
+            first++;
+        }
+        count = (first < id->object_count) ? 1U : 0U;
+        if (count == 0U)
+        {
+            exception = MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+        }
+    }
+    else if ((read_code >= (uint8_t)MODBUS_DEVICE_ID_BASIC) &&
+             (read_code <= (uint8_t)MODBUS_DEVICE_ID_EXTENDED))
+    {
+        if (read_code == (uint8_t)MODBUS_DEVICE_ID_BASIC)
+        {
+            last_id = MODBUS_DEVICE_ID_MAJOR_MINOR_REVISION;
+        }
+        else
+        {
+            last_id = (read_code == (uint8_t)MODBUS_DEVICE_ID_REGULAR) ? 0x7FU
+                                                                       : 0xFFU;
+        }
 
-    return result;
-}
-
-/**
- * @brief Get number of exceptions sent
- *
- * @param[in] ctx Pointer to context
- * @return uint32_t Number of exceptions sent
- */
-uint32_t modbus_get_exceptions_sent(const modbus_context_t *ctx)
-{
-    uint32_t result = 0U;
+        while ((first < id->object_count) &&
+               (id->objects[first].id != object_id))
+        {
+            first++;
+        }
+        if ((first == id->object_count) || (object_id > last_id))
+        {
+            first = 0U;
+        }
+        while (((first + count) < id->object_count) &&
+               (id->objects[first + count].id <= last_id))
+        {
+            count++;
+        }
+    }
+    else
+    {
+        exception = MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
 
-    if ((ctx != NULL) && (ctx->initialized))
+    if (exception != MODBUS_EXCEPTION_NONE)
     {
-        result = ctx->exceptions_sent;
+        ctx->exceptions_sent++;
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_ENCAPSULATED_INTERFACE, exception);
+    }
+    else
+    {
+        result = modbus_pdu_buffer_encode_device_id_response(
+            response, read_code, device_id_conformity_level(id),
+            &id->objects[first], count);
     }
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_READ_FILE_RECORD
 
 /**
- * @brief Reset statistics counters
+ * @brief Process Read File Record (FC20) request
  *
- * @param[in] ctx Pointer to context
+ * Sub-requests the file mapper finds in memory are encoded straight from
+ * there; the others are read in turn into the register buffer. The records
+ * of all of them must fit one response together.
  */
-void modbus_reset_statistics(modbus_context_t *ctx)
+static modbus_error_t process_read_file_record(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
 {
-    if ((ctx != NULL) && (ctx->initialized))
+    uint16_t           lengths[MAX_FILE_SUB_REQUESTS];
+    const uint16_t    *records[MAX_FILE_SUB_REQUESTS];
+    modbus_exception_t exception = MODBUS_EXCEPTION_NONE;
+    uint32_t           bytes     = 0U;
+    uint16_t           words     = 0U;
+    uint8_t            count     = 0U;
+    modbus_error_t     result;
+
+    if (ctx->file_reader == NULL)
     {
-        ctx->requests_processed = 0U;
-        ctx->errors_count       = 0U;
-        ctx->exceptions_sent    = 0U;
+        exception = MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+    }
+    else if (modbus_pdu_view_decode_file_record_count(request, &count) !=
+             MODBUS_OK)
+    {
+        exception = MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    else
+    {
+        latency_callback_begin(ctx);
+        for (uint8_t i = 0U;
+             (i < count) && (exception == MODBUS_EXCEPTION_NONE); i++)
+        {
+            uint8_t  reference_type = 0U;
+            uint16_t file_number    = 0U;
+            uint16_t record_number  = 0U;
+            uint16_t record_length  = 0U;
+
+            (void)modbus_pdu_view_decode_file_record_sub_request(
+                request, i, &reference_type, &file_number, &record_number,
+                &record_length);
+
+            if ((reference_type != MODBUS_FILE_REFERENCE_TYPE) ||
+                (file_number == 0U) ||
+                (record_number > MODBUS_FILE_MAX_RECORD) ||
+                (record_length == 0U))
+            {
+                exception = MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+            }
+            else if ((bytes + 2U + (2U * (uint32_t)record_length)) >
+                     MAX_FILE_RESPONSE_DATA)
+            {
+                exception = MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            else
+            {
+                records[i] = (ctx->file_mapper != NULL)
+                                 ? ctx->file_mapper(file_number, record_number,
+                                                    record_length)
+                                 : NULL;
+                if (records[i] == NULL)
+                {
+                    exception  = ctx->file_reader(file_number, record_number,
+                                                  record_length,
+                                                  &ctx->register_buffer[words]);
+                    records[i] = &ctx->register_buffer[words];
+                    words      = (uint16_t)(words + record_length);
+                }
+                lengths[i] = record_length;
+                bytes += 2U + (2U * (uint32_t)record_length);
+            }
+        }
+        latency_callback_end(ctx);
+    }
+
+    if (exception != MODBUS_EXCEPTION_NONE)
+    {
+        ctx->exceptions_sent++;
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_READ_FILE_RECORD, exception);
+    }
+    else
+    {
+        result = modbus_pdu_buffer_encode_file_record_response(
+            response, lengths, count, records);
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_FILE_RECORD
+
+/**
+ * @brief Process Write File Record (FC21) request
+ *
+ * The sub-requests are decoded into the register buffer and written in
+ * turn; the first exception ends the request.
+ */
+static modbus_error_t process_write_file_record(
+    modbus_context_t *ctx, const modbus_pdu_view_t *request,
+    modbus_pdu_buffer_t *response)
+{
+    modbus_exception_t exception = MODBUS_EXCEPTION_NONE;
+    uint16_t           pos       = 1U;
+    uint8_t            count     = 0U;
+    modbus_error_t     result;
+
+    if (ctx->file_writer == NULL)
+    {
+        exception = MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+    }
+    else if (modbus_pdu_view_decode_file_write_count(request, &count) !=
+             MODBUS_OK)
+    {
+        exception = MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    else
+    {
+        latency_callback_begin(ctx);
+        for (uint8_t i = 0U;
+             (i < count) && (exception == MODBUS_EXCEPTION_NONE); i++)
+        {
+            uint8_t  reference_type = 0U;
+            uint16_t file_number    = 0U;
+            uint16_t record_number  = 0U;
+            uint16_t record_length  = 0U;
+
+            (void)modbus_pdu_view_decode_file_write_sub_request(
+                request, &pos, &reference_type, &file_number, &record_number,
+                &record_length, ctx->register_buffer, MAX_FILE_WRITE_RECORDS);
+
+            if ((reference_type != MODBUS_FILE_REFERENCE_TYPE) ||
+                (file_number == 0U) ||
+                (((uint32_t)record_number + record_length) >
+                 (MODBUS_FILE_MAX_RECORD + 1U)))
+            {
+                exception = MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+            }
+            else
+            {
+                exception = ctx->file_writer(file_number, record_number,
+                                             record_length,
+                                             ctx->register_buffer);
+            }
+        }
+        latency_callback_end(ctx);
+    }
+
+    if (exception != MODBUS_EXCEPTION_NONE)
+    {
+        ctx->exceptions_sent++;
+        result = modbus_pdu_buffer_encode_exception(
+            response, MODBUS_FC_WRITE_FILE_RECORD, exception);
+    }
+    else
+    {
+        result = modbus_pdu_buffer_encode_file_write_response(response,
+                                                              request);
+    }
+
+    return result;
+}
+#endif
+
+/* ==========================================================================
+ * Function Code Dispatch Table
+ * ========================================================================== */
+
+/** Number of entries in the built-in table (function codes 0-127) */
+#define FC_TABLE_SIZE 128U
+
+/** Request data length of the fixed-size FC01-FC06 requests */
+#define FC_FIXED_REQUEST_LENGTH 4U
+
+/** Minimum FC15 request data: address, quantity, byte count, 1 data byte */
+#define FC15_MIN_REQUEST_LENGTH 6U
+
+/** Minimum FC16 request data: address, quantity, byte count, 1 register */
+#define FC16_MIN_REQUEST_LENGTH 7U
+
+/** Minimum FC23 request data: read and write fields, byte count, 1 register */
+#define FC23_MIN_REQUEST_LENGTH 11U
+
+/** FC20 request data: byte count, one to 35 sub-requests of 7 bytes */
+#define FC20_MIN_REQUEST_LENGTH 8U
+#define FC20_MAX_REQUEST_LENGTH (1U + (7U * MAX_FILE_SUB_REQUESTS))
+
+/** FC21 request data: byte count, one sub-request with one record */
+#define FC21_MIN_REQUEST_LENGTH 10U
+
+/** FC100 request data: byte count, 1 to 50 descriptors of 5 bytes */
+#define FC100_MIN_REQUEST_LENGTH 6U
+#define FC100_MAX_REQUEST_LENGTH (1U + (5U * MODBUS_SCATTER_MAX_DESCRIPTORS))
+
+/** FC43/14 request data: MEI type, Read Device ID code, object ID */
+#define FC43_REQUEST_LENGTH 3U
+
+/** Response PDU of a read: function code, byte count, up to 250 bytes */
+#define FC_READ_MAX_RESPONSE_LENGTH 252U
+
+/** Response PDU of a write: function code, address, value/quantity */
+#define FC_WRITE_RESPONSE_LENGTH 5U
+
+/** Largest request data length */
+#define FC_MAX_REQUEST_LENGTH (MODBUS_MAX_PDU_SIZE - 1U)
+
+/**
+ * @brief Built-in dispatch table, indexed by function code
+ *
+ * Unlisted function codes, and those disabled in modbus_config.h, have a
+ * NULL handler and are answered with ILLEGAL_FUNCTION.
+ */
+static const modbus_fc_entry_t s_fc_table[FC_TABLE_SIZE] = {
+#if MODBUS_ENABLE_FC_READ_COILS
+    [MODBUS_FC_READ_COILS] = {MODBUS_FC_READ_COILS, process_read_coils,
+                              FC_FIXED_REQUEST_LENGTH, FC_FIXED_REQUEST_LENGTH,
+                              FC_READ_MAX_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_READ_DISCRETE_INPUTS
+    [MODBUS_FC_READ_DISCRETE_INPUTS] = {MODBUS_FC_READ_DISCRETE_INPUTS,
+                                        process_read_discrete_inputs,
+                                        FC_FIXED_REQUEST_LENGTH,
+                                        FC_FIXED_REQUEST_LENGTH,
+                                        FC_READ_MAX_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_READ_HOLDING_REGISTERS
+    [MODBUS_FC_READ_HOLDING_REGISTERS] = {MODBUS_FC_READ_HOLDING_REGISTERS,
+                                          process_read_holding_registers,
+                                          FC_FIXED_REQUEST_LENGTH,
+                                          FC_FIXED_REQUEST_LENGTH,
+                                          FC_READ_MAX_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_READ_INPUT_REGISTERS
+    [MODBUS_FC_READ_INPUT_REGISTERS] = {MODBUS_FC_READ_INPUT_REGISTERS,
+                                        process_read_input_registers,
+                                        FC_FIXED_REQUEST_LENGTH,
+                                        FC_FIXED_REQUEST_LENGTH,
+                                        FC_READ_MAX_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_WRITE_SINGLE_COIL
+    [MODBUS_FC_WRITE_SINGLE_COIL] = {MODBUS_FC_WRITE_SINGLE_COIL,
+                                     process_write_single_coil,
+                                     FC_FIXED_REQUEST_LENGTH,
+                                     FC_FIXED_REQUEST_LENGTH,
+                                     FC_WRITE_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_WRITE_SINGLE_REGISTER
+    [MODBUS_FC_WRITE_SINGLE_REGISTER] = {MODBUS_FC_WRITE_SINGLE_REGISTER,
+                                         process_write_single_register,
+                                         FC_FIXED_REQUEST_LENGTH,
+                                         FC_FIXED_REQUEST_LENGTH,
+                                         FC_WRITE_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_WRITE_MULTIPLE_COILS
+    [MODBUS_FC_WRITE_MULTIPLE_COILS] = {MODBUS_FC_WRITE_MULTIPLE_COILS,
+                                        process_write_multiple_coils,
+                                        FC15_MIN_REQUEST_LENGTH,
+                                        FC_MAX_REQUEST_LENGTH,
+                                        FC_WRITE_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_WRITE_MULTIPLE_REGISTERS
+    [MODBUS_FC_WRITE_MULTIPLE_REGISTERS] = {MODBUS_FC_WRITE_MULTIPLE_REGISTERS,
+                                            process_write_multiple_registers,
+                                            FC16_MIN_REQUEST_LENGTH,
+                                            FC_MAX_REQUEST_LENGTH,
+                                            FC_WRITE_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_READ_FILE_RECORD
+    [MODBUS_FC_READ_FILE_RECORD] = {MODBUS_FC_READ_FILE_RECORD,
+                                    process_read_file_record,
+                                    FC20_MIN_REQUEST_LENGTH,
+                                    FC20_MAX_REQUEST_LENGTH,
+                                    MODBUS_MAX_PDU_SIZE},
+#endif
+#if MODBUS_ENABLE_FC_WRITE_FILE_RECORD
+    [MODBUS_FC_WRITE_FILE_RECORD] = {MODBUS_FC_WRITE_FILE_RECORD,
+                                     process_write_file_record,
+                                     FC21_MIN_REQUEST_LENGTH,
+                                     FC_MAX_REQUEST_LENGTH,
+                                     MODBUS_MAX_PDU_SIZE},
+#endif
+#if MODBUS_ENABLE_FC_READ_WRITE_MULTIPLE_REGS
+    [MODBUS_FC_READ_WRITE_MULTIPLE_REGS] =
+        {MODBUS_FC_READ_WRITE_MULTIPLE_REGS,
+         process_read_write_multiple_registers, FC23_MIN_REQUEST_LENGTH,
+         FC_MAX_REQUEST_LENGTH, FC_READ_MAX_RESPONSE_LENGTH},
+#endif
+#if MODBUS_ENABLE_FC_ENCAPSULATED_INTERFACE
+    [MODBUS_FC_ENCAPSULATED_INTERFACE] = {MODBUS_FC_ENCAPSULATED_INTERFACE,
+                                          process_read_device_identification,
+                                          FC43_REQUEST_LENGTH,
+                                          FC43_REQUEST_LENGTH,
+                                          MODBUS_MAX_PDU_SIZE},
+#endif
+#if MODBUS_ENABLE_FC_READ_SCATTERED_REGISTERS
+    [MODBUS_FC_READ_SCATTERED_REGISTERS] =
+        {MODBUS_FC_READ_SCATTERED_REGISTERS, process_read_scattered_registers,
+         FC100_MIN_REQUEST_LENGTH, FC100_MAX_REQUEST_LENGTH,
+         FC_READ_MAX_RESPONSE_LENGTH},
+#endif
+};
+
+/**
+ * @brief Look up the dispatch entry for a function code
+ *
+ * Custom entries registered on the context take precedence over the
+ * built-in table.
+ *
+ * @param[in] ctx Pointer to context
+ * @param[in] function_code Function code to look up
+ * @return Pointer to the entry, or NULL if the function code is unsupported
+ */
+static const modbus_fc_entry_t *find_fc_entry(const modbus_context_t *ctx,
+                                              uint8_t function_code)
+{
+    const modbus_fc_entry_t *result = NULL;
+
+    for (uint8_t i = 0U; (i < ctx->custom_handler_count) && (result == NULL);
+         i++)
+    {
+        if (ctx->custom_handlers[i]->function_code == function_code)
+        {
+            result = ctx->custom_handlers[i];
+        }
+    }
+
+    if ((result == NULL) && (function_code < FC_TABLE_SIZE) &&
+        (s_fc_table[function_code].handler != NULL))
+    {
+        result = &s_fc_table[function_code];
+    }
+
+    return result;
+}
+
+/**
+ * @brief Register a handler for an additional function code
+ *
+ * @param[in] ctx Pointer to initialized context
+ * @param[in] entry Dispatch entry; must stay valid
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_register_handler(modbus_context_t        *ctx,
+                                             const modbus_fc_entry_t *entry)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((ctx != NULL) && (entry != NULL) && (entry->handler != NULL))
+    {
+        if (!ctx->initialized)
+        {
+            result = MODBUS_ERROR_NOT_INITIALIZED;
+        }
+        else if (ctx->custom_handler_count >= MODBUS_MAX_CUSTOM_HANDLERS)
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+        else
+        {
+            ctx->custom_handlers[ctx->custom_handler_count] = entry;
+            ctx->custom_handler_count++;
+            result = MODBUS_OK;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Set the device identification served by FC43/14
+ *
+ * @param[in] ctx Pointer to initialized context
+ * @param[in] device_id Object table; must stay valid, NULL to stop serving
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_set_device_id(modbus_context_t         *ctx,
+                                          const modbus_device_id_t *device_id)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (ctx != NULL)
+    {
+        if (!ctx->initialized)
+        {
+            result = MODBUS_ERROR_NOT_INITIALIZED;
+        }
+        else
+        {
+            ctx->device_id = device_id;
+            result         = MODBUS_OK;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Set the reader of the files served by FC20
+ *
+ * @param[in] ctx Pointer to initialized context
+ * @param[in] reader File reader, NULL to stop serving FC20
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_set_file_reader(modbus_context_t  *ctx,
+                                            modbus_file_read_t reader)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (ctx != NULL)
+    {
+        if (!ctx->initialized)
+        {
+            result = MODBUS_ERROR_NOT_INITIALIZED;
+        }
+        else
+        {
+            ctx->file_reader = reader;
+            result           = MODBUS_OK;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Set the mapper of the files served by FC20
+ *
+ * @param[in] ctx Pointer to initialized context
+ * @param[in] mapper File mapper, NULL to read every sub-request
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_set_file_mapper(modbus_context_t *ctx,
+                                            modbus_file_map_t mapper)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (ctx != NULL)
+    {
+        if (!ctx->initialized)
+        {
+            result = MODBUS_ERROR_NOT_INITIALIZED;
+        }
+        else
+        {
+            ctx->file_mapper = mapper;
+            result           = MODBUS_OK;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Set the writer of the files served by FC21
+ *
+ * @param[in] ctx Pointer to initialized context
+ * @param[in] writer File writer, NULL to stop serving FC21
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_set_file_writer(modbus_context_t   *ctx,
+                                            modbus_file_write_t writer)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (ctx != NULL)
+    {
+        if (!ctx->initialized)
+        {
+            result = MODBUS_ERROR_NOT_INITIALIZED;
+        }
+        else
+        {
+            ctx->file_writer = writer;
+            result           = MODBUS_OK;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Set the data callbacks of a context
+ *
+ * @param[in] ctx Pointer to initialized context
+ * @param[in] callbacks Callback table; must stay valid, NULL for the
+ * modbus_cb_* functions
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_set_callbacks(
+    modbus_context_t *ctx, const modbus_slave_callbacks_t *callbacks)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (ctx != NULL)
+    {
+        if (!ctx->initialized)
+        {
+            result = MODBUS_ERROR_NOT_INITIALIZED;
+        }
+        else if (callbacks == NULL)
+        {
+            ctx->callbacks = &s_global_callbacks;
+            result         = MODBUS_OK;
+        }
+        else if ((callbacks->read_coils != NULL) &&
+                 (callbacks->write_single_coil != NULL) &&
+                 (callbacks->write_multiple_coils != NULL) &&
+                 (callbacks->read_discrete_inputs != NULL) &&
+                 (callbacks->read_holding_registers != NULL) &&
+                 (callbacks->write_single_register != NULL) &&
+                 (callbacks->write_multiple_registers != NULL) &&
+                 (callbacks->read_input_registers != NULL))
+        {
+            ctx->callbacks = callbacks;
+            result         = MODBUS_OK;
+        }
+        else
+        {
+            /* A missing entry would be called through NULL */
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get the upper bound of the response PDU size for a function code
+ *
+ * Lets a transport reserve only as much TX space as a response can take.
+ *
+ * @param[in] ctx Pointer to context
+ * @param[in] function_code Request function code
+ * @return uint16_t Maximum response PDU length in bytes
+ */
+uint16_t modbus_slave_get_response_bound(const modbus_context_t *ctx,
+                                         uint8_t                 function_code)
+{
+    uint16_t result = MODBUS_MAX_PDU_SIZE;
+
+    if ((ctx != NULL) && (ctx->initialized))
+    {
+        const modbus_fc_entry_t *entry = find_fc_entry(ctx, function_code);
+
+        if (entry != NULL)
+        {
+            result = entry->max_response_length;
+        }
+        else
+        {
+            /* Exception response: function code + exception code */
+            result = 2U;
+        }
+    }
+
+    return result;
+}
+
+/* ==========================================================================
+ * Main Request Processing
+ * ========================================================================== */
+
+/**
+ * @brief Process a Modbus request PDU view into a response PDU buffer
+ *
+ * The response is written where the buffer points, which can be the PDU
+ * position of the transport's transmit frame; no response PDU is staged.
+ *
+ * @param[in] ctx Pointer to context
+ * @param[in] request Pointer to request PDU view
+ * @param[out] response Pointer to response PDU buffer to fill
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_process_pdu_buffer(modbus_context_t        *ctx,
+                                               const modbus_pdu_view_t *request,
+                                               modbus_pdu_buffer_t *response)
+{
+    modbus_error_t err;
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((ctx != NULL) && (request != NULL) && (response != NULL))
+    {
+        if (!ctx->initialized)
+        {
+            result = MODBUS_ERROR_NOT_INITIALIZED;
+        }
+        else
+        {
+            const modbus_fc_entry_t *entry;
+
+            latency_dispatch_begin(ctx);
+            entry = find_fc_entry(ctx, request->function_code);
+
+            ctx->requests_processed++;
+
+            if (entry == NULL)
+            {
+                /* Unsupported function code */
+                ctx->exceptions_sent++;
+                err = modbus_pdu_buffer_encode_exception(
+                    response, request->function_code,
+                    MODBUS_EXCEPTION_ILLEGAL_FUNCTION);
+            }
+            else if ((request->data_length < entry->min_data_length) ||
+                     (request->data_length > entry->max_data_length))
+            {
+                /* Malformed request - rejected before the handler runs */
+                ctx->exceptions_sent++;
+                err = modbus_pdu_buffer_encode_exception(
+                    response, request->function_code,
+                    MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+            }
+            else
+            {
+                err = entry->handler(ctx, request, response);
+            }
+
+            if (err != MODBUS_OK)
+            {
+                ctx->errors_count++;
+            }
+
+            latency_record(ctx, request->function_code);
+            result = err;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Process a Modbus request PDU view and generate response PDU
+ *
+ * @param[in] ctx Pointer to context
+ * @param[in] request Pointer to request PDU view
+ * @param[out] response Pointer to response PDU to fill
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_process_pdu_view(modbus_context_t        *ctx,
+                                             const modbus_pdu_view_t *request,
+                                             modbus_pdu_t            *response)
+{
+    modbus_pdu_buffer_t buffer;
+    modbus_error_t      result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (response != NULL)
+    {
+        modbus_pdu_buffer_from_pdu(response, &buffer);
+        result = modbus_slave_process_pdu_buffer(ctx, request, &buffer);
+        if (result == MODBUS_OK)
+        {
+            response->data_length = buffer.data_length;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Process a Modbus request PDU and generate response PDU
+ *
+ * @param[in] ctx Pointer to context
+ * @param[in] request Pointer to request PDU
+ * @param[out] response Pointer to response PDU to fill
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_process_pdu(modbus_context_t   *ctx,
+                                        const modbus_pdu_t *request,
+                                        modbus_pdu_t       *response)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (request != NULL)
+    {
+        modbus_pdu_view_t view;
+
+        modbus_pdu_view_from_pdu(request, &view);
+        result = modbus_slave_process_pdu_view(ctx, &view, response);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Process a complete Modbus ADU and generate response ADU
+ *
+ * @param[in] ctx Pointer to context
+ * @param[in] request Pointer to request ADU
+ * @param[out] response Pointer to response ADU to fill
+ * @param[out] send_response Pointer to flag indicating if response should be
+ * sent
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_process_adu(modbus_context_t   *ctx,
+                                        const modbus_adu_t *request,
+                                        modbus_adu_t       *response,
+                                        bool               *send_response)
+{
+    modbus_error_t err;
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((ctx != NULL) && (request != NULL) && (response != NULL) &&
+        (send_response != NULL))
+    {
+        /* Check if request is for this slave */
+        if ((request->unit_id != ctx->config.unit_id) &&
+            (request->unit_id != 0U))
+        {
+            /* Not for us - don't respond */
+            *send_response = false;
+            result         = MODBUS_OK;
+        }
+        else
+        {
+            /* Process PDU */
+            err = modbus_slave_process_pdu(ctx, &request->pdu, &response->pdu);
+            if (err != MODBUS_OK)
+            {
+                *send_response = false;
+                result         = err;
+            }
+            else
+            {
+                /* Copy addressing info to response */
+                response->unit_id        = ctx->config.unit_id;
+                response->transaction_id = request->transaction_id;
+                response->protocol_id    = request->protocol_id;
+
+                /* Don't respond to broadcast requests */
+                *send_response = (request->unit_id != 0U);
+                result         = MODBUS_OK;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* ==========================================================================
+ * Statistics Functions
+ * ========================================================================== */
+
+/**
+ * @brief Get number of requests processed
+ *
+ * @param[in] ctx Pointer to context
+ * @return uint32_t Number of requests processed
+ */
+uint32_t modbus_get_requests_processed(const modbus_context_t *ctx)
+{
+    uint32_t result = 0U;
+
+    if ((ctx != NULL) && (ctx->initialized))
+    {
+        result = ctx->requests_processed;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get number of errors
+ *
+ * @param[in] ctx Pointer to context
+ * @return uint32_t Number of errors
+ */
+uint32_t modbus_get_errors_count(const modbus_context_t *ctx)
+{
+    uint32_t result = 0U;
+
+    if ((ctx != NULL) && (ctx->initialized))
+    {
+        result = ctx->errors_count;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get number of exceptions sent
+ *
+ * @param[in] ctx Pointer to context
+ * @return uint32_t Number of exceptions sent
+ */
+uint32_t modbus_get_exceptions_sent(const modbus_context_t *ctx)
+{
+    uint32_t result = 0U;
+
+    if ((ctx != NULL) && (ctx->initialized))
+    {
+        result = ctx->exceptions_sent;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Reset statistics counters
+ *
+ * @param[in] ctx Pointer to context
+ */
+void modbus_reset_statistics(modbus_context_t *ctx)
+{
+    if ((ctx != NULL) && (ctx->initialized))
+    {
+        ctx->requests_processed = 0U;
+        ctx->errors_count       = 0U;
+        ctx->exceptions_sent    = 0U;
+#if MODBUS_ENABLE_LATENCY_STATS
+        if (ctx->latency != NULL)
+        {
+            (void)memset(ctx->latency, 0, sizeof(*ctx->latency));
+        }
+#endif
+    }
+}
+
+#if MODBUS_ENABLE_LATENCY_STATS
+/**
+ * @brief Attach latency histograms to a slave context
+ *
+ * @param[in] ctx Pointer to initialized context
+ * @param[in] stats Histograms to clear and fill, NULL to stop timing
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_slave_set_latency_stats(modbus_context_t       *ctx,
+                                              modbus_latency_stats_t *stats)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (ctx != NULL)
+    {
+        if (!ctx->initialized)
+        {
+            result = MODBUS_ERROR_NOT_INITIALIZED;
+        }
+        else
+        {
+            if (stats != NULL)
+            {
+                (void)memset(stats, 0, sizeof(*stats));
+            }
+            ctx->latency              = stats;
+            ctx->latency_frame_marked = false;
+            result                    = MODBUS_OK;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Mark the start of parsing a received frame
+ *
+ * @param[in] ctx Pointer to initialized context
+ */
+void modbus_slave_mark_frame_start(modbus_context_t *ctx)
+{
+    if ((ctx != NULL) && (ctx->latency != NULL))
+    {
+        ctx->latency_frame_start  = modbus_port_cycle_count();
+        ctx->latency_frame_marked = true;
     }
 }
+#endif /* MODBUS_ENABLE_LATENCY_STATS */
@@ -0,0 +1,732 @@
+/**
+ * @file modbus_master.c
+ * @brief Modbus master polling engine
+ *
+ * Merges a poll table into read requests, schedules them earliest deadline
+ * first and matches the responses back to the poll items. Framing uses the
+ * RTU and TCP encoders of the library; moving the frames is left to the
+ * caller.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include <string.h>
+
+#include "modbus_config.h"
+#include "modbus_internal.h"
+#include "modbus_master.h"
+#include "modbus_types.h"
+
+#if MODBUS_ENABLE_MASTER
+
+/* ==========================================================================
+ * Private Constants
+ * ========================================================================== */
+
+/** Exception flag in the function code of a response */
+#define POLL_EXCEPTION_FLAG 0x80U
+
+/** Smallest RTU response: address, function code and CRC */
+#define POLL_RTU_MIN_FRAME_SIZE 4U
+
+/** Highest slave address a request can go to */
+#define POLL_RTU_MAX_UNIT_ID 247U
+
+/* ==========================================================================
+ * Private Helper Functions
+ * ========================================================================== */
+
+/**
+ * @brief Check whether time @p a has reached time @p b (wrap safe)
+ */
+static bool poll_time_reached(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) >= 0;
+}
+
+/**
+ * @brief Largest quantity one request of a read function code may carry
+ *
+ * @return The limit, 0 for a function code the engine cannot poll
+ */
+static uint16_t poll_max_quantity(uint8_t function_code)
+{
+    uint16_t limit = 0U;
+
+    switch (function_code)
+    {
+        case MODBUS_FC_READ_COILS:
+            limit = MODBUS_MAX_READ_COILS;
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            limit = MODBUS_MAX_READ_DISCRETE;
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            limit = MODBUS_MAX_READ_REGISTERS;
+            break;
+        default:
+            break;
+    }
+
+    return limit;
+}
+
+/**
+ * @brief Check whether a function code reads single bits
+ */
+static bool poll_is_bit_read(uint8_t function_code)
+{
+    return (function_code == (uint8_t)MODBUS_FC_READ_COILS) ||
+           (function_code == (uint8_t)MODBUS_FC_READ_DISCRETE_INPUTS);
+}
+
+/**
+ * @brief Validate one poll table entry
+ */
+static bool poll_item_valid(const modbus_poll_item_t *item,
+                            modbus_protocol_t         protocol)
+{
+    uint16_t limit = poll_max_quantity(item->function_code);
+
+    return (limit != 0U) && (item->quantity > 0U) &&
+           (item->quantity <= limit) &&
+           (((uint32_t)item->start_address + item->quantity) <= 0x10000UL) &&
+           (item->period_ms > 0U) && (item->values != NULL) &&
+           ((protocol == MODBUS_PROTOCOL_TCP) ||
+            ((item->unit_id != 0U) &&
+             (item->unit_id <= POLL_RTU_MAX_UNIT_ID)));
+}
+
+/**
+ * @brief Try to widen a batch so that it also covers an address span
+ *
+ * The span and the batch must belong to the same request group, touch or
+ * lie at most MODBUS_MASTER_MERGE_GAP addresses apart, and fit one request
+ * together.
+ *
+ * @param[in,out] batch   Batch to widen
+ * @param[in]     unit_id Slave address of the span
+ * @param[in]     fc      Function code of the span
+ * @param[in]     period  Poll period of the span
+ * @param[in]     start   First address of the span
+ * @param[in]     end     One past the last address of the span
+ * @return true if the batch now covers the span
+ */
+static bool poll_batch_merge(modbus_poll_batch_t *batch, uint8_t unit_id,
+                             uint8_t fc, uint32_t period, uint32_t start,
+                             uint32_t end)
+{
+    uint32_t batch_start = batch->start_address;
+    uint32_t batch_end   = batch_start + batch->quantity;
+    uint32_t lo;
+    uint32_t hi;
+    bool     merged = false;
+
+    if ((batch->unit_id == unit_id) && (batch->function_code == fc) &&
+        (batch->period_ms == period) &&
+        (start <= (batch_end + MODBUS_MASTER_MERGE_GAP)) &&
+        ((end + MODBUS_MASTER_MERGE_GAP) >= batch_start))
+    {
+        lo = (start < batch_start) ? start : batch_start;
+        hi = (end > batch_end) ? end : batch_end;
+
+        if ((hi - lo) <= poll_max_quantity(fc))
+        {
+            batch->start_address = (uint16_t)lo;
+            batch->quantity      = (uint16_t)(hi - lo);
+            merged               = true;
+        }
+    }
+
+    return merged;
+}
+
+/**
+ * @brief Merge batches that came to touch after the entries were placed
+ *
+ * Entries are placed in table order, so two batches can end up adjacent
+ * once a later entry has widened one of them. Repeats until no pair of
+ * batches can be merged.
+ */
+static void poll_coalesce_batches(modbus_poller_t *poller)
+{
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+
+        for (uint16_t i = 0U; (i < poller->batch_count) && !changed; i++)
+        {
+            for (uint16_t j = (uint16_t)(i + 1U);
+                 (j < poller->batch_count) && !changed; j++)
+            {
+                const modbus_poll_batch_t *other = &poller->batches[j];
+
+                if (poll_batch_merge(&poller->batches[i], other->unit_id,
+                                     other->function_code, other->period_ms,
+                                     other->start_address,
+                                     (uint32_t)other->start_address +
+                                         other->quantity))
+                {
+                    uint16_t last = (uint16_t)(poller->batch_count - 1U);
+
+                    /* Move the items of j to i, then the last batch into j */
+                    for (uint16_t k = 0U; k < poller->item_count; k++)
+                    {
+                        if (poller->item_batch[k] == (uint8_t)j)
+                        {
+                            poller->item_batch[k] = (uint8_t)i;
+                        }
+                        else if (poller->item_batch[k] == (uint8_t)last)
+                        {
+                            poller->item_batch[k] = (uint8_t)j;
+                        }
+                        else
+                        {
+                            /* Unaffected */
+                        }
+                    }
+
+                    poller->batches[j] = poller->batches[last];
+                    poller->batch_count--;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Release a transaction slot and schedule the batch's next read
+ *
+ * The next read keeps its phase; a batch that fell a whole period behind is
+ * read once at the earliest chance instead of catching up on every read it
+ * missed.
+ */
+static void poll_complete(modbus_poller_t *poller,
+                          modbus_poll_pending_t *pending, uint32_t now_ms)
+{
+    modbus_poll_batch_t *batch = &poller->batches[pending->batch];
+
+    batch->in_flight = false;
+    batch->due_ms += batch->period_ms;
+    if (!poll_time_reached(batch->due_ms, now_ms))
+    {
+        batch->due_ms = now_ms;
+    }
+
+    pending->active = false;
+}
+
+/**
+ * @brief Record a failed read and complete its transaction
+ */
+static void poll_fail(modbus_poller_t *poller, modbus_poll_pending_t *pending,
+                      modbus_error_t error, uint32_t now_ms)
+{
+    modbus_poll_status_t *status = &poller->batches[pending->batch].status;
+
+    status->failures++;
+    status->last_error = error;
+    poll_complete(poller, pending, now_ms);
+}
+
+/**
+ * @brief Retire the transactions that have waited past the timeout
+ */
+static void poll_expire(modbus_poller_t *poller, uint32_t now_ms)
+{
+    for (uint8_t i = 0U; i < poller->pipeline_depth; i++)
+    {
+        modbus_poll_pending_t *pending = &poller->pending[i];
+
+        if (pending->active &&
+            poll_time_reached(now_ms,
+                              pending->sent_ms + poller->response_timeout_ms))
+        {
+            poll_fail(poller, pending, MODBUS_ERROR_TIMEOUT, now_ms);
+        }
+    }
+}
+
+/**
+ * @brief Find the due batch with the earliest deadline
+ *
+ * @return Batch index, or batch_count if none is due
+ */
+static uint16_t poll_select_batch(const modbus_poller_t *poller,
+                                  uint32_t               now_ms)
+{
+    uint16_t selected = poller->batch_count;
+    uint32_t deadline = 0U;
+
+    for (uint16_t i = 0U; i < poller->batch_count; i++)
+    {
+        const modbus_poll_batch_t *batch = &poller->batches[i];
+        uint32_t candidate = batch->due_ms + batch->period_ms;
+
+        if (!batch->in_flight && poll_time_reached(now_ms, batch->due_ms) &&
+            ((selected == poller->batch_count) ||
+             !poll_time_reached(candidate, deadline)))
+        {
+            selected = i;
+            deadline = candidate;
+        }
+    }
+
+    return selected;
+}
+
+/**
+ * @brief Encode the request PDU of a batch
+ */
+static modbus_error_t poll_encode_request(const modbus_poll_batch_t *batch,
+                                          modbus_pdu_t              *pdu)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    switch (batch->function_code)
+    {
+        case MODBUS_FC_READ_COILS:
+            result = modbus_pdu_encode_read_coils(pdu, batch->start_address,
+                                                  batch->quantity);
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            result = modbus_pdu_encode_read_discrete_inputs(
+                pdu, batch->start_address, batch->quantity);
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            result = modbus_pdu_encode_read_holding_registers(
+                pdu, batch->start_address, batch->quantity);
+            break;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            result = modbus_pdu_encode_read_input_registers(
+                pdu, batch->start_address, batch->quantity);
+            break;
+        default:
+            break;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Copy the values of a batch response into one poll item
+ *
+ * @param[in] item   Poll item inside the batch
+ * @param[in] batch  Batch the response belongs to
+ * @param[in] values Response data after the byte count
+ */
+static void poll_store_item(const modbus_poll_item_t  *item,
+                            const modbus_poll_batch_t *batch,
+                            const uint8_t             *values)
+{
+    uint16_t offset = (uint16_t)(item->start_address - batch->start_address);
+
+    if (poll_is_bit_read(item->function_code))
+    {
+        uint8_t *bits = (uint8_t *)item->values;
+
+        (void)memset(bits, 0, ((uint32_t)item->quantity + 7U) / 8U);
+        for (uint16_t i = 0U; i < item->quantity; i++)
+        {
+            uint16_t bit = (uint16_t)(offset + i);
+
+            if ((values[bit / 8U] & (1U << (bit % 8U))) != 0U)
+            {
+                bits[i / 8U] |= (uint8_t)(1U << (i % 8U));
+            }
+        }
+    }
+    else
+    {
+        uint16_t      *registers = (uint16_t *)item->values;
+        const uint8_t *src       = &values[offset * 2U];
+
+        for (uint16_t i = 0U; i < item->quantity; i++)
+        {
+            registers[i] = (uint16_t)(((uint16_t)src[i * 2U] << 8U) |
+                                      (uint16_t)src[(i * 2U) + 1U]);
+        }
+    }
+}
+
+/**
+ * @brief Apply a response PDU to the transaction it answers
+ */
+static modbus_error_t poll_apply_response(modbus_poller_t         *poller,
+                                          modbus_poll_pending_t   *pending,
+                                          const modbus_pdu_view_t *pdu,
+                                          uint32_t                 now_ms)
+{
+    modbus_poll_batch_t *batch = &poller->batches[pending->batch];
+    uint16_t             byte_count;
+    modbus_error_t       result;
+
+    if (poll_is_bit_read(batch->function_code))
+    {
+        byte_count = (uint16_t)((batch->quantity + 7U) / 8U);
+    }
+    else
+    {
+        byte_count = (uint16_t)(batch->quantity * 2U);
+    }
+
+    if ((pdu->function_code ==
+         (uint8_t)(batch->function_code | POLL_EXCEPTION_FLAG)) &&
+        (pdu->data_length == 1U))
+    {
+        batch->status.last_exception = (modbus_exception_t)pdu->data[0];
+        result                       = MODBUS_ERROR_EXCEPTION;
+        poll_fail(poller, pending, result, now_ms);
+    }
+    else if ((pdu->function_code != batch->function_code) ||
+             (pdu->data_length != (1U + byte_count)) ||
+             (pdu->data[0] != byte_count))
+    {
+        result = MODBUS_ERROR_FRAME;
+        poll_fail(poller, pending, result, now_ms);
+    }
+    else
+    {
+        for (uint16_t i = 0U; i < poller->item_count; i++)
+        {
+            if (poller->item_batch[i] == pending->batch)
+            {
+                poll_store_item(&poller->items[i], batch, &pdu->data[1]);
+            }
+        }
+
+        batch->status.responses++;
+        batch->status.updated_ms = now_ms;
+        batch->status.last_error = MODBUS_OK;
+        result                   = MODBUS_OK;
+        poll_complete(poller, pending, now_ms);
+    }
+
+    return result;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+/**
+ * @brief Initialize a poller and merge its poll table
+ *
+ * @param[out] poller Poller to initialize
+ * @param[in] items Poll table
+ * @param[in] item_count Number of entries
+ * @param[in] protocol MODBUS_PROTOCOL_RTU or MODBUS_PROTOCOL_TCP
+ * @param[in] response_timeout_ms Response timeout
+ * @param[in] now_ms Current time in milliseconds
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_poll_init(modbus_poller_t          *poller,
+                                const modbus_poll_item_t *items,
+                                uint16_t item_count, modbus_protocol_t protocol,
+                                uint32_t response_timeout_ms, uint32_t now_ms)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((poller != NULL) && (items != NULL) && (item_count > 0U) &&
+        (item_count <= MODBUS_MASTER_MAX_POLL_ITEMS) &&
+        ((protocol == MODBUS_PROTOCOL_RTU) ||
+         (protocol == MODBUS_PROTOCOL_TCP)))
+    {
+        (void)memset(poller, 0, sizeof(*poller));
+        poller->items               = items;
+        poller->item_count          = item_count;
+        poller->protocol            = protocol;
+        poller->response_timeout_ms = response_timeout_ms;
+        poller->pipeline_depth      = (protocol == MODBUS_PROTOCOL_TCP)
+                                          ? (uint8_t)MODBUS_MASTER_MAX_PIPELINE
+                                          : 1U;
+        result                      = MODBUS_OK;
+
+        for (uint16_t i = 0U; (i < item_count) && (result == MODBUS_OK); i++)
+        {
+            const modbus_poll_item_t *item  = &items[i];
+            bool                      valid = poll_item_valid(item, protocol);
+            uint16_t                  b     = 0U;
+
+            while (valid && (b < poller->batch_count) &&
+                   !poll_batch_merge(&poller->batches[b], item->unit_id,
+                                     item->function_code, item->period_ms,
+                                     item->start_address,
+                                     (uint32_t)item->start_address +
+                                         item->quantity))
+            {
+                b++;
+            }
+
+            if (!valid)
+            {
+                result = MODBUS_ERROR_INVALID_PARAM;
+            }
+            else if (b < poller->batch_count)
+            {
+                poller->item_batch[i] = (uint8_t)b;
+            }
+            else if (b == MODBUS_MASTER_MAX_BATCHES)
+            {
+                result = MODBUS_ERROR_BUFFER_OVERFLOW;
+            }
+            else
+            {
+                modbus_poll_batch_t *batch = &poller->batches[b];
+
+                batch->unit_id        = item->unit_id;
+                batch->function_code  = item->function_code;
+                batch->start_address  = item->start_address;
+                batch->quantity       = item->quantity;
+                batch->period_ms      = item->period_ms;
+                batch->due_ms         = now_ms;
+                poller->item_batch[i] = (uint8_t)b;
+                poller->batch_count++;
+            }
+        }
+
+        if (result == MODBUS_OK)
+        {
+            poll_coalesce_batches(poller);
+        }
+        else
+        {
+            poller->batch_count = 0U;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Build the frame of the next request due
+ *
+ * @param[in,out] poller Initialized poller
+ * @param[in] now_ms Current time in milliseconds
+ * @param[out] frame Frame buffer
+ * @param[in] frame_size Frame buffer size
+ * @param[out] frame_length Length of the frame built
+ * @return modbus_error_t MODBUS_OK if a frame was built
+ */
+modbus_error_t modbus_poll_next_request(modbus_poller_t *poller,
+                                        uint32_t now_ms, uint8_t *frame,
+                                        uint16_t  frame_size,
+                                        uint16_t *frame_length)
+{
+    modbus_poll_pending_t *pending = NULL;
+    modbus_adu_t           adu;
+    uint16_t               index;
+    modbus_error_t         result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((poller != NULL) && (frame != NULL) && (frame_length != NULL))
+    {
+        poll_expire(poller, now_ms);
+
+        for (uint8_t i = 0U;
+             (i < poller->pipeline_depth) && (pending == NULL); i++)
+        {
+            if (!poller->pending[i].active)
+            {
+                pending = &poller->pending[i];
+            }
+        }
+
+        index  = poll_select_batch(poller, now_ms);
+        result = MODBUS_ERROR_BUSY;
+
+        if ((pending != NULL) && (index < poller->batch_count))
+        {
+            modbus_poll_batch_t *batch = &poller->batches[index];
+
+            (void)memset(&adu, 0, sizeof(adu));
+            adu.unit_id        = batch->unit_id;
+            adu.transaction_id = poller->next_transaction_id;
+
+            result = poll_encode_request(batch, &adu.pdu);
+            if (result != MODBUS_OK)
+            {
+                /* Entries were validated at init */
+            }
+            else if (poller->protocol == MODBUS_PROTOCOL_TCP)
+            {
+                result = modbus_tcp_build_frame_pdu(
+                    adu.transaction_id, adu.unit_id, &adu.pdu, frame,
+                    frame_size, frame_length);
+            }
+            else
+            {
+                result = modbus_rtu_build_frame(&adu, frame, frame_size,
+                                                frame_length);
+            }
+
+            if (result == MODBUS_OK)
+            {
+                pending->active         = true;
+                pending->batch          = (uint8_t)index;
+                pending->transaction_id = adu.transaction_id;
+                pending->sent_ms        = now_ms;
+                batch->in_flight        = true;
+                poller->next_transaction_id++;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Consume a response frame
+ *
+ * @param[in,out] poller Initialized poller
+ * @param[in] frame Complete RTU or MBAP frame
+ * @param[in] frame_length Frame length in bytes
+ * @param[in] now_ms Current time in milliseconds
+ * @return modbus_error_t MODBUS_OK if values were stored
+ */
+modbus_error_t modbus_poll_handle_response(modbus_poller_t *poller,
+                                           const uint8_t   *frame,
+                                           uint16_t         frame_length,
+                                           uint32_t         now_ms)
+{
+    modbus_poll_pending_t *pending = NULL;
+    modbus_pdu_view_t      pdu;
+    uint16_t               transaction_id = 0U;
+    uint8_t                unit_id        = 0U;
+    modbus_error_t         result         = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((poller != NULL) && (frame != NULL))
+    {
+        if (poller->protocol == MODBUS_PROTOCOL_TCP)
+        {
+            result = modbus_tcp_parse_frame_view(
+                frame, frame_length, &transaction_id, &unit_id, &pdu);
+        }
+        else if (frame_length < POLL_RTU_MIN_FRAME_SIZE)
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+        else if (modbus_crc16(frame, frame_length) != 0U)
+        {
+            /* The CRC over a frame including its own CRC leaves no residue */
+            result = MODBUS_ERROR_CRC;
+        }
+        else
+        {
+            unit_id           = frame[0];
+            pdu.function_code = frame[1];
+            pdu.data          = &frame[2];
+            pdu.data_length =
+                (uint16_t)(frame_length - POLL_RTU_MIN_FRAME_SIZE);
+            result = MODBUS_OK;
+        }
+
+        for (uint8_t i = 0U; (result == MODBUS_OK) &&
+                             (i < poller->pipeline_depth) && (pending == NULL);
+             i++)
+        {
+            modbus_poll_pending_t *candidate = &poller->pending[i];
+
+            if (candidate->active &&
+                ((poller->protocol != MODBUS_PROTOCOL_TCP) ||
+                 (candidate->transaction_id == transaction_id)) &&
+                (poller->batches[candidate->batch].unit_id == unit_id))
+            {
+                pending = candidate;
+            }
+        }
+
+        if (result != MODBUS_OK)
+        {
+            /* Framing error, no transaction identified */
+        }
+        else if (pending == NULL)
+        {
+            result = MODBUS_ERROR_INVALID_STATE;
+        }
+        else
+        {
+            result = poll_apply_response(poller, pending, &pdu, now_ms);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Time until the poller next needs modbus_poll_next_request()
+ *
+ * @param[in] poller Initialized poller
+ * @param[in] now_ms Current time in milliseconds
+ * @return uint32_t Milliseconds, 0 if a request is due now
+ */
+uint32_t modbus_poll_time_to_next(const modbus_poller_t *poller,
+                                  uint32_t               now_ms)
+{
+    uint32_t wait      = UINT32_MAX;
+    bool     slot_free = false;
+
+    for (uint8_t i = 0U; (poller != NULL) && (i < poller->pipeline_depth);
+         i++)
+    {
+        const modbus_poll_pending_t *pending = &poller->pending[i];
+
+        if (pending->active)
+        {
+            uint32_t expiry = pending->sent_ms + poller->response_timeout_ms;
+            uint32_t left =
+                poll_time_reached(now_ms, expiry) ? 0U : (expiry - now_ms);
+
+            wait = (left < wait) ? left : wait;
+        }
+        else
+        {
+            slot_free = true;
+        }
+    }
+
+    for (uint16_t i = 0U; slot_free && (i < poller->batch_count); i++)
+    {
+        const modbus_poll_batch_t *batch = &poller->batches[i];
+
+        if (!batch->in_flight)
+        {
+            uint32_t left = poll_time_reached(now_ms, batch->due_ms)
+                                ? 0U
+                                : (batch->due_ms - now_ms);
+
+            wait = (left < wait) ? left : wait;
+        }
+    }
+
+    return wait;
+}
+
+/**
+ * @brief Return the read results of a poll item
+ *
+ * @param[in] poller Initialized poller
+ * @param[in] item_index Index of the entry in the poll table
+ * @param[out] status Destination
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_poll_get_status(const modbus_poller_t *poller,
+                                      uint16_t               item_index,
+                                      modbus_poll_status_t  *status)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((poller != NULL) && (status != NULL) &&
+        (item_index < poller->item_count) && (poller->batch_count > 0U))
+    {
+        *status = poller->batches[poller->item_batch[item_index]].status;
+        result  = MODBUS_OK;
+    }
+
+    return result;
+}
+
+#endif /* MODBUS_ENABLE_MASTER */
@@ -46,7 +46,7 @@ static void pdu_write_uint16_be(uint8_t *buffer, uint16_t value)
  * @param[in] buffer Pointer to buffer
  * @return uint16_t Value read from buffer
  */
-static uint16_t pdu_read_uint16_be(const uint8_t *buffer)
+static inline uint16_t pdu_read_uint16_be(const uint8_t *buffer)
 {
     return (uint16_t)(((uint16_t)buffer[0] << 8U) | (uint16_t)buffer[1]);
 }
@@ -314,82 +314,1099 @@ modbus_error_t modbus_pdu_encode_write_multiple_registers(
     return result;
 }
 
+/* ==========================================================================
+ * PDU Buffer Encoding Functions - Response Building
+ *
+ * These encoders write through a modbus_pdu_buffer_t, so that a response can
+ * be built straight into the transmit frame of a transport.
+ * ========================================================================== */
+
+/**
+ * @brief Point a PDU buffer at a PDU structure
+ *
+ * @param[in] pdu Pointer to PDU structure
+ * @param[out] buffer Buffer to fill
+ */
+void modbus_pdu_buffer_from_pdu(modbus_pdu_t *pdu, modbus_pdu_buffer_t *buffer)
+{
+    if ((pdu != NULL) && (buffer != NULL))
+    {
+        buffer->function_code = &pdu->function_code;
+        buffer->data          = pdu->data;
+        buffer->data_size     = (uint16_t)sizeof(pdu->data);
+        buffer->data_length   = 0U;
+    }
+}
+
+/**
+ * @brief Point a PDU buffer at the PDU position of a frame
+ *
+ * @param[in] frame Pointer to the function code byte in the frame
+ * @param[in] size Space from the function code byte on, in bytes
+ * @param[out] buffer Buffer to fill
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_buffer_from_frame(uint8_t *frame, uint16_t size,
+                                            modbus_pdu_buffer_t *buffer)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((frame != NULL) && (buffer != NULL) && (size > 0U))
+    {
+        buffer->function_code = &frame[0];
+        buffer->data          = &frame[1];
+        buffer->data_size     = (uint16_t)(size - 1U);
+        buffer->data_length   = 0U;
+        result                = MODBUS_OK;
+    }
+
+    return result;
+}
+
+#if MODBUS_PDU_HAS_READ_BITS
+
+/**
+ * @brief Encode a Read Coils/Discrete Inputs response into a PDU buffer
+ *
+ * @param[out] buffer PDU buffer to fill
+ * @param[in] function_code Function code (FC01 or FC02)
+ * @param[in] coil_values Pointer to coil values (bit-packed)
+ * @param[in] quantity Number of coils/inputs
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_buffer_encode_read_bits_response(
+    modbus_pdu_buffer_t *buffer, uint8_t function_code,
+    const uint8_t *coil_values, uint16_t quantity)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((buffer != NULL) && (coil_values != NULL))
+    {
+        uint8_t byte_count = (uint8_t)((quantity + 7U) / 8U);
+
+        if ((1U + byte_count) <= buffer->data_size)
+        {
+            *buffer->function_code = function_code;
+            buffer->data[0]        = byte_count;
+            (void)memcpy(&buffer->data[1], coil_values, byte_count);
+            buffer->data_length = 1U + (uint16_t)byte_count;
+            result              = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_PDU_HAS_REGISTERS_RESPONSE
+
+/**
+ * @brief Encode a Read Registers response into a PDU buffer
+ *
+ * @param[out] buffer PDU buffer to fill
+ * @param[in] function_code Function code (FC03 or FC04)
+ * @param[in] register_values Pointer to register values
+ * @param[in] quantity Number of registers
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_buffer_encode_read_registers_response(
+    modbus_pdu_buffer_t *buffer, uint8_t function_code,
+    const uint16_t *register_values, uint16_t quantity)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((buffer != NULL) && (register_values != NULL))
+    {
+        uint8_t byte_count = (uint8_t)(quantity * 2U);
+
+        if ((1U + byte_count) <= buffer->data_size)
+        {
+            *buffer->function_code = function_code;
+            buffer->data[0]        = byte_count;
+
+            for (uint16_t i = 0U; i < quantity; i++)
+            {
+                pdu_write_uint16_be(&buffer->data[1U + (i * 2U)],
+                                    register_values[i]);
+            }
+            buffer->data_length = 1U + (uint16_t)byte_count;
+            result              = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_PDU_HAS_WRITE_SINGLE || MODBUS_PDU_HAS_WRITE_MULTIPLE
+
+/**
+ * @brief Encode a 4-byte address/value response into a PDU buffer
+ *
+ * Shared by the write responses, which all echo two 16-bit fields.
+ */
+static modbus_error_t pdu_buffer_encode_echo(modbus_pdu_buffer_t *buffer,
+                                             uint8_t  function_code,
+                                             uint16_t first, uint16_t second)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (buffer != NULL)
+    {
+        if (buffer->data_size >= 4U)
+        {
+            *buffer->function_code = function_code;
+            pdu_write_uint16_be(&buffer->data[0], first);
+            pdu_write_uint16_be(&buffer->data[2], second);
+            buffer->data_length = 4U;
+            result              = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_PDU_HAS_WRITE_SINGLE
+
+/**
+ * @brief Encode a Write Single Coil/Register response into a PDU buffer
+ *
+ * @param[out] buffer PDU buffer to fill
+ * @param[in] function_code Function code (FC05 or FC06)
+ * @param[in] address Address written
+ * @param[in] value Value written
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_buffer_encode_write_single_response(
+    modbus_pdu_buffer_t *buffer, uint8_t function_code, uint16_t address,
+    uint16_t value)
+{
+    return pdu_buffer_encode_echo(buffer, function_code, address, value);
+}
+#endif
+
+#if MODBUS_PDU_HAS_WRITE_MULTIPLE
+
+/**
+ * @brief Encode a Write Multiple Coils/Registers response into a PDU buffer
+ *
+ * @param[out] buffer PDU buffer to fill
+ * @param[in] function_code Function code (FC15 or FC16)
+ * @param[in] start_address Starting address
+ * @param[in] quantity Number of items written
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_buffer_encode_write_multiple_response(
+    modbus_pdu_buffer_t *buffer, uint8_t function_code, uint16_t start_address,
+    uint16_t quantity)
+{
+    return pdu_buffer_encode_echo(buffer, function_code, start_address,
+                                  quantity);
+}
+#endif
+
+#if MODBUS_ENABLE_FC_ENCAPSULATED_INTERFACE
+
+/**
+ * @brief Encode a Read Device Identification (FC43/14) response
+ *
+ * Objects are packed in order for as long as they fit the buffer. If some
+ * are left over, the response says more follow and names the first object
+ * left out, where the client continues the stream.
+ *
+ * @param[out] buffer PDU buffer to fill
+ * @param[in] read_code Read Device ID code of the request
+ * @param[in] conformity_level Conformity level of the device
+ * @param[in] objects First object to send
+ * @param[in] object_count Number of objects from @p objects on (1 or more)
+ * @return modbus_error_t MODBUS_OK on success, MODBUS_ERROR_BUFFER_OVERFLOW
+ *         if not even the first object fits
+ */
+modbus_error_t modbus_pdu_buffer_encode_device_id_response(
+    modbus_pdu_buffer_t *buffer, uint8_t read_code, uint8_t conformity_level,
+    const modbus_device_id_object_t *objects, uint8_t object_count)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((buffer != NULL) && (objects != NULL) && (object_count > 0U))
+    {
+        /* MEI type, code, conformity, more follows, next ID, count */
+        uint16_t length = 6U;
+        uint8_t  sent   = 0U;
+
+        while ((sent < object_count) &&
+               ((length + 2U + objects[sent].length) <= buffer->data_size))
+        {
+            buffer->data[length]      = objects[sent].id;
+            buffer->data[length + 1U] = objects[sent].length;
+            (void)memcpy(&buffer->data[length + 2U], objects[sent].value,
+                         objects[sent].length);
+            length = (uint16_t)(length + 2U + objects[sent].length);
+            sent++;
+        }
+
+        if (sent > 0U)
+        {
+            *buffer->function_code = MODBUS_FC_ENCAPSULATED_INTERFACE;
+            buffer->data[0]        = MODBUS_MEI_READ_DEVICE_ID;
+            buffer->data[1]        = read_code;
+            buffer->data[2]        = conformity_level;
+            buffer->data[3]        = (sent < object_count) ? 0xFFU : 0x00U;
+            buffer->data[4] =
+                (sent < object_count) ? objects[sent].id : 0x00U;
+            buffer->data[5]     = sent;
+            buffer->data_length = length;
+            result              = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_READ_FILE_RECORD
+
+/**
+ * @brief Encode a Read File Record (FC20) response
+ *
+ * One sub-response per sub-request, each encoded straight from the records
+ * of that sub-request, wherever they are.
+ *
+ * @param[out] buffer PDU buffer to fill
+ * @param[in] record_lengths Records of each sub-request
+ * @param[in] count Number of sub-requests (1 or more)
+ * @param[in] records Records of each sub-request
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_buffer_encode_file_record_response(
+    modbus_pdu_buffer_t *buffer, const uint16_t *record_lengths,
+    uint8_t count, const uint16_t *const *records)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((buffer != NULL) && (record_lengths != NULL) && (records != NULL) &&
+        (count > 0U))
+    {
+        uint32_t length = 1U;
+
+        for (uint8_t i = 0U; i < count; i++)
+        {
+            length += 2U + (2U * (uint32_t)record_lengths[i]);
+        }
+
+        if ((length <= buffer->data_size) && (length <= 256U))
+        {
+            uint16_t pos = 1U;
+
+            *buffer->function_code = MODBUS_FC_READ_FILE_RECORD;
+            buffer->data[0]        = (uint8_t)(length - 1U);
+            for (uint8_t i = 0U; i < count; i++)
+            {
+                const uint16_t *values = records[i];
+
+                buffer->data[pos] =
+                    (uint8_t)(1U + (2U * (uint32_t)record_lengths[i]));
+                buffer->data[pos + 1U] = MODBUS_FILE_REFERENCE_TYPE;
+                pos                    = (uint16_t)(pos + 2U);
+                for (uint16_t r = 0U; r < record_lengths[i]; r++)
+                {
+                    pdu_write_uint16_be(&buffer->data[pos], values[r]);
+                    pos = (uint16_t)(pos + 2U);
+                }
+            }
+            buffer->data_length = pos;
+            result              = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_FILE_RECORD
+
+/**
+ * @brief Encode a Write File Record (FC21) response
+ *
+ * The response is an echo of the request.
+ *
+ * @param[out] buffer PDU buffer to fill, may share memory with the request
+ * @param[in] request Request PDU, checked with
+ *                    modbus_pdu_view_decode_file_write_count()
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_buffer_encode_file_write_response(
+    modbus_pdu_buffer_t *buffer, const modbus_pdu_view_t *request)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((buffer != NULL) && (request != NULL) && (request->data != NULL))
+    {
+        if (request->data_length <= buffer->data_size)
+        {
+            *buffer->function_code = MODBUS_FC_WRITE_FILE_RECORD;
+            (void)memmove(buffer->data, request->data, request->data_length);
+            buffer->data_length = request->data_length;
+            result              = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+#endif
+
+/**
+ * @brief Encode an exception response into a PDU buffer
+ *
+ * @param[out] buffer PDU buffer to fill
+ * @param[in] function_code Original function code
+ * @param[in] exception_code Exception code
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_buffer_encode_exception(
+    modbus_pdu_buffer_t *buffer, uint8_t function_code,
+    modbus_exception_t exception_code)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (buffer != NULL)
+    {
+        if (buffer->data_size >= 1U)
+        {
+            /* Exception response has function code with MSB set */
+            *buffer->function_code = function_code | 0x80U;
+            buffer->data[0]        = (uint8_t)exception_code;
+            buffer->data_length    = 1U;
+            result                 = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+
 /* ==========================================================================
  * PDU Encoding Functions - Response Building
  * ========================================================================== */
 
+#if MODBUS_PDU_HAS_READ_BITS
+
 /**
  * @brief Encode a Read Coils/Discrete Inputs response PDU
  *
- * @param[out] pdu Pointer to PDU structure to fill
- * @param[in] function_code Function code (FC01 or FC02)
- * @param[in] coil_values Pointer to coil values (bit-packed)
- * @param[in] quantity Number of coils/inputs
+ * @param[out] pdu Pointer to PDU structure to fill
+ * @param[in] function_code Function code (FC01 or FC02)
+ * @param[in] coil_values Pointer to coil values (bit-packed)
+ * @param[in] quantity Number of coils/inputs
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_encode_read_bits_response(modbus_pdu_t *pdu,
+                                                    uint8_t       function_code,
+                                                    const uint8_t *coil_values,
+                                                    uint16_t       quantity)
+{
+    modbus_pdu_buffer_t buffer;
+    modbus_error_t      result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (pdu != NULL)
+    {
+        modbus_pdu_buffer_from_pdu(pdu, &buffer);
+        result = modbus_pdu_buffer_encode_read_bits_response(
+            &buffer, function_code, coil_values, quantity);
+        if (result == MODBUS_OK)
+        {
+            pdu->data_length = buffer.data_length;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_PDU_HAS_REGISTERS_RESPONSE
+
+/**
+ * @brief Encode a Read Registers response PDU
+ *
+ * @param[out] pdu Pointer to PDU structure to fill
+ * @param[in] function_code Function code (FC03 or FC04)
+ * @param[in] register_values Pointer to register values
+ * @param[in] quantity Number of registers
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_encode_read_registers_response(
+    modbus_pdu_t *pdu, uint8_t function_code, const uint16_t *register_values,
+    uint16_t quantity)
+{
+    modbus_pdu_buffer_t buffer;
+    modbus_error_t      result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (pdu != NULL)
+    {
+        modbus_pdu_buffer_from_pdu(pdu, &buffer);
+        result = modbus_pdu_buffer_encode_read_registers_response(
+            &buffer, function_code, register_values, quantity);
+        if (result == MODBUS_OK)
+        {
+            pdu->data_length = buffer.data_length;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_PDU_HAS_WRITE_SINGLE
+
+/**
+ * @brief Encode a Write Single Coil/Register response PDU (echo of request)
+ *
+ * @param[out] pdu Pointer to PDU structure to fill
+ * @param[in] function_code Function code (FC05 or FC06)
+ * @param[in] address Address written
+ * @param[in] value Value written
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_encode_write_single_response(modbus_pdu_t *pdu,
+                                                       uint8_t  function_code,
+                                                       uint16_t address,
+                                                       uint16_t value)
+{
+    modbus_pdu_buffer_t buffer;
+    modbus_error_t      result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (pdu != NULL)
+    {
+        modbus_pdu_buffer_from_pdu(pdu, &buffer);
+        result = modbus_pdu_buffer_encode_write_single_response(
+            &buffer, function_code, address, value);
+        if (result == MODBUS_OK)
+        {
+            pdu->data_length = buffer.data_length;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_PDU_HAS_WRITE_MULTIPLE
+
+/**
+ * @brief Encode a Write Multiple Coils/Registers response PDU
+ *
+ * @param[out] pdu Pointer to PDU structure to fill
+ * @param[in] function_code Function code (FC15 or FC16)
+ * @param[in] start_address Starting address
+ * @param[in] quantity Number of items written
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_encode_write_multiple_response(modbus_pdu_t *pdu,
+                                                         uint8_t  function_code,
+                                                         uint16_t start_address,
+                                                         uint16_t quantity)
+{
+    modbus_pdu_buffer_t buffer;
+    modbus_error_t      result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (pdu != NULL)
+    {
+        modbus_pdu_buffer_from_pdu(pdu, &buffer);
+        result = modbus_pdu_buffer_encode_write_multiple_response(
+            &buffer, function_code, start_address, quantity);
+        if (result == MODBUS_OK)
+        {
+            pdu->data_length = buffer.data_length;
+        }
+    }
+
+    return result;
+}
+#endif
+
+/**
+ * @brief Encode an exception response PDU
+ *
+ * @param[out] pdu Pointer to PDU structure to fill
+ * @param[in] function_code Original function code
+ * @param[in] exception_code Exception code
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_encode_exception(modbus_pdu_t      *pdu,
+                                           uint8_t            function_code,
+                                           modbus_exception_t exception_code)
+{
+    modbus_pdu_buffer_t buffer;
+    modbus_error_t      result = MODBUS_ERROR_INVALID_PARAM;
+
+    if (pdu != NULL)
+    {
+        modbus_pdu_buffer_from_pdu(pdu, &buffer);
+        result = modbus_pdu_buffer_encode_exception(&buffer, function_code,
+                                                    exception_code);
+        if (result == MODBUS_OK)
+        {
+            pdu->data_length = buffer.data_length;
+        }
+    }
+
+    return result;
+}
+
+/* ==========================================================================
+ * PDU View Decoding Functions
+ *
+ * These decoders read straight from a non-owning view so that requests can be
+ * decoded in place from a receive buffer without copying into a modbus_pdu_t.
+ * ========================================================================== */
+
+/**
+ * @brief Build a view over a PDU structure
+ *
+ * @param[in] pdu Pointer to PDU structure (may be NULL)
+ * @param[out] view View to fill; left empty if pdu is NULL
+ */
+void modbus_pdu_view_from_pdu(const modbus_pdu_t *pdu, modbus_pdu_view_t *view)
+{
+    if (view != NULL)
+    {
+        if (pdu != NULL)
+        {
+            view->function_code = pdu->function_code;
+            view->data          = pdu->data;
+            view->data_length   = pdu->data_length;
+        }
+        else
+        {
+            view->function_code = 0U;
+            view->data          = NULL;
+            view->data_length   = 0U;
+        }
+    }
+}
+
+#if MODBUS_PDU_HAS_READ_BITS
+
+/**
+ * @brief Decode a Read Coils/Discrete Inputs request
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] start_address Pointer to store starting address
+ * @param[out] quantity Pointer to store quantity
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_read_bits_request(
+    const modbus_pdu_view_t *pdu, uint16_t *start_address, uint16_t *quantity)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (start_address != NULL) &&
+        (quantity != NULL))
+    {
+        if (pdu->data_length >= 4U)
+        {
+            *start_address = pdu_read_uint16_be(&pdu->data[0]);
+            *quantity      = pdu_read_uint16_be(&pdu->data[2]);
+            result         = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_PDU_HAS_READ_REGISTERS
+
+/**
+ * @brief Decode a Read Registers request
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] start_address Pointer to store starting address
+ * @param[out] quantity Pointer to store quantity
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_read_registers_request(
+    const modbus_pdu_view_t *pdu, uint16_t *start_address, uint16_t *quantity)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (start_address != NULL) &&
+        (quantity != NULL))
+    {
+        if (pdu->data_length >= 4U)
+        {
+            *start_address = pdu_read_uint16_be(&pdu->data[0]);
+            *quantity      = pdu_read_uint16_be(&pdu->data[2]);
+            result         = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_SINGLE_COIL
+
+/**
+ * @brief Decode a Write Single Coil request
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] address Pointer to store address
+ * @param[out] value Pointer to store value (true = ON, false = OFF)
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_write_single_coil_request(
+    const modbus_pdu_view_t *pdu, uint16_t *address, bool *value)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (address != NULL) &&
+        (value != NULL))
+    {
+        if (pdu->data_length >= 4U)
+        {
+            *address            = pdu_read_uint16_be(&pdu->data[0]);
+            uint16_t coil_value = pdu_read_uint16_be(&pdu->data[2]);
+
+            /* Validate coil value - must be 0xFF00 or 0x0000 */
+            if ((coil_value == MODBUS_COIL_ON) ||
+                (coil_value == MODBUS_COIL_OFF))
+            {
+                *value = (coil_value == MODBUS_COIL_ON);
+                result = MODBUS_OK;
+            }
+            else
+            {
+                result = MODBUS_ERROR_FRAME;
+            }
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_SINGLE_REGISTER
+
+/**
+ * @brief Decode a Write Single Register request
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] address Pointer to store address
+ * @param[out] value Pointer to store value
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_write_single_register_request(
+    const modbus_pdu_view_t *pdu, uint16_t *address, uint16_t *value)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (address != NULL) &&
+        (value != NULL))
+    {
+        if (pdu->data_length >= 4U)
+        {
+            *address = pdu_read_uint16_be(&pdu->data[0]);
+            *value   = pdu_read_uint16_be(&pdu->data[2]);
+            result   = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_MULTIPLE_COILS
+
+/**
+ * @brief Decode a Write Multiple Coils request
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] start_address Pointer to store starting address
+ * @param[out] quantity Pointer to store quantity
+ * @param[out] values Pointer to pointer to store coil values location
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_write_multiple_coils_request(
+    const modbus_pdu_view_t *pdu, uint16_t *start_address, uint16_t *quantity,
+    const uint8_t **values)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (start_address != NULL) &&
+        (quantity != NULL) && (values != NULL))
+    {
+        if (pdu->data_length >= 5U)
+        {
+            *start_address     = pdu_read_uint16_be(&pdu->data[0]);
+            *quantity          = pdu_read_uint16_be(&pdu->data[2]);
+            uint8_t byte_count = pdu->data[4];
+
+            /* Validate byte count */
+            uint8_t expected_bytes = (uint8_t)((*quantity + 7U) / 8U);
+            if (byte_count == expected_bytes)
+            {
+                if (pdu->data_length >= (5U + byte_count))
+                {
+                    *values = &pdu->data[5];
+                    result  = MODBUS_OK;
+                }
+                else
+                {
+                    result = MODBUS_ERROR_FRAME;
+                }
+            }
+            else
+            {
+                result = MODBUS_ERROR_FRAME;
+            }
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_MULTIPLE_REGISTERS
+
+/**
+ * @brief Decode a Write Multiple Registers request
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] start_address Pointer to store starting address
+ * @param[out] quantity Pointer to store quantity
+ * @param[out] values Pointer to buffer to store register values
+ * @param[in] max_values Maximum number of values buffer can hold
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_write_multiple_registers_request(
+    const modbus_pdu_view_t *pdu, uint16_t *start_address, uint16_t *quantity,
+    uint16_t *values, uint16_t max_values)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (start_address != NULL) &&
+        (quantity != NULL) && (values != NULL))
+    {
+        if (pdu->data_length >= 5U)
+        {
+            *start_address     = pdu_read_uint16_be(&pdu->data[0]);
+            *quantity          = pdu_read_uint16_be(&pdu->data[2]);
+            uint8_t byte_count = pdu->data[4];
+
+            /* Validate byte count */
+            if (byte_count == (*quantity * 2U))
+            {
+                if (*quantity <= max_values)
+                {
+                    if (pdu->data_length >= (5U + byte_count))
+                    {
+                        /* Extract register values */
+                        for (uint16_t i = 0U; i < *quantity; i++)
+                        {
+                            values[i] =
+                                pdu_read_uint16_be(&pdu->data[5U + (i * 2U)]);
+                        }
+                        result = MODBUS_OK;
+                    }
+                    else
+                    {
+                        result = MODBUS_ERROR_FRAME;
+                    }
+                }
+                else
+                {
+                    result = MODBUS_ERROR_BUFFER_OVERFLOW;
+                }
+            }
+            else
+            {
+                result = MODBUS_ERROR_FRAME;
+            }
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_READ_WRITE_MULTIPLE_REGS
+
+/**
+ * @brief Decode a Read/Write Multiple Registers (FC23) request
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] read_address Pointer to store the first register read
+ * @param[out] read_quantity Pointer to store the number of registers read
+ * @param[out] write_address Pointer to store the first register written
+ * @param[out] write_quantity Pointer to store the number of registers
+ * written
+ * @param[out] values Pointer to buffer to store the values written
+ * @param[in] max_values Maximum number of values buffer can hold
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_read_write_registers_request(
+    const modbus_pdu_view_t *pdu, uint16_t *read_address,
+    uint16_t *read_quantity, uint16_t *write_address, uint16_t *write_quantity,
+    uint16_t *values, uint16_t max_values)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (read_address != NULL) &&
+        (read_quantity != NULL) && (write_address != NULL) &&
+        (write_quantity != NULL) && (values != NULL))
+    {
+        if (pdu->data_length >= 9U)
+        {
+            *read_address      = pdu_read_uint16_be(&pdu->data[0]);
+            *read_quantity     = pdu_read_uint16_be(&pdu->data[2]);
+            *write_address     = pdu_read_uint16_be(&pdu->data[4]);
+            *write_quantity    = pdu_read_uint16_be(&pdu->data[6]);
+            uint8_t byte_count = pdu->data[8];
+
+            if ((byte_count != (*write_quantity * 2U)) ||
+                (pdu->data_length < (9U + byte_count)))
+            {
+                result = MODBUS_ERROR_FRAME;
+            }
+            else if (*write_quantity > max_values)
+            {
+                result = MODBUS_ERROR_BUFFER_OVERFLOW;
+            }
+            else
+            {
+                for (uint16_t i = 0U; i < *write_quantity; i++)
+                {
+                    values[i] = pdu_read_uint16_be(&pdu->data[9U + (i * 2U)]);
+                }
+                result = MODBUS_OK;
+            }
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_ENCAPSULATED_INTERFACE
+
+/**
+ * @brief Decode a Read Device Identification (FC43/14) request
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] mei_type Pointer to store the MEI type
+ * @param[out] read_code Pointer to store the Read Device ID code
+ * @param[out] object_id Pointer to store the object ID
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_device_id_request(
+    const modbus_pdu_view_t *pdu, uint8_t *mei_type, uint8_t *read_code,
+    uint8_t *object_id)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (mei_type != NULL) &&
+        (read_code != NULL) && (object_id != NULL))
+    {
+        if (pdu->data_length == 3U)
+        {
+            *mei_type  = pdu->data[0];
+            *read_code = pdu->data[1];
+            *object_id = pdu->data[2];
+            result     = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#if MODBUS_ENABLE_FC_READ_FILE_RECORD
+
+/**
+ * @brief Decode the number of sub-requests of a Read File Record (FC20)
+ *        request
+ *
+ * The byte count must cover the rest of the request and be a whole number
+ * of 7-byte sub-requests, 0x07 to 0xF5 bytes.
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] count Pointer to store the number of sub-requests
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_pdu_view_decode_file_record_count(
+    const modbus_pdu_view_t *pdu, uint8_t *count)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (pdu->data != NULL) && (count != NULL))
+    {
+        uint8_t byte_count = (pdu->data_length > 0U) ? pdu->data[0] : 0U;
+
+        if ((pdu->data_length == (1U + (uint16_t)byte_count)) &&
+            (byte_count >= 0x07U) && (byte_count <= 0xF5U) &&
+            ((byte_count % 7U) == 0U))
+        {
+            *count = (uint8_t)(byte_count / 7U);
+            result = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Decode one sub-request of a Read File Record (FC20) request
+ *
+ * @param[in] pdu Pointer to PDU view, checked with
+ *                modbus_pdu_view_decode_file_record_count()
+ * @param[in] index Sub-request, from 0
+ * @param[out] reference_type Pointer to store the reference type
+ * @param[out] file_number Pointer to store the file number
+ * @param[out] record_number Pointer to store the first record
+ * @param[out] record_length Pointer to store the number of records
  * @return modbus_error_t MODBUS_OK on success
  */
-modbus_error_t modbus_pdu_encode_read_bits_response(modbus_pdu_t *pdu,
-                                                    uint8_t       function_code,
-                                                    const uint8_t *coil_values,
-                                                    uint16_t       quantity)
+modbus_error_t modbus_pdu_view_decode_file_record_sub_request(
+    const modbus_pdu_view_t *pdu, uint8_t index, uint8_t *reference_type,
+    uint16_t *file_number, uint16_t *record_number, uint16_t *record_length)
 {
     modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
 
-    if ((pdu != NULL) && (coil_values != NULL))
+    if ((pdu != NULL) && (pdu->data != NULL) && (reference_type != NULL) &&
+        (file_number != NULL) && (record_number != NULL) &&
+        (record_length != NULL))
     {
-        uint8_t byte_count = (uint8_t)((quantity + 7U) / 8U);
+        uint16_t pos = (uint16_t)(1U + (7U * (uint16_t)index));
 
-        if ((1U + byte_count) <= (MODBUS_MAX_PDU_SIZE - 1U))
+        if ((pos + 7U) <= pdu->data_length)
         {
-            pdu->function_code = function_code;
-            pdu->data[0]       = byte_count;
-            (void)memcpy(&pdu->data[1], coil_values, byte_count);
-            pdu->data_length = 1U + (uint16_t)byte_count;
-            result           = MODBUS_OK;
+            *reference_type = pdu->data[pos];
+            *file_number    = pdu_read_uint16_be(&pdu->data[pos + 1U]);
+            *record_number  = pdu_read_uint16_be(&pdu->data[pos + 3U]);
+            *record_length  = pdu_read_uint16_be(&pdu->data[pos + 5U]);
+            result          = MODBUS_OK;
         }
         else
         {
-            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+            result = MODBUS_ERROR_FRAME;
         }
     }
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_FILE_RECORD
 
 /**
- * @brief Encode a Read Registers response PDU
+ * @brief Decode the number of sub-requests of a Write File Record (FC21)
+ *        request
  *
- * @param[out] pdu Pointer to PDU structure to fill
- * @param[in] function_code Function code (FC03 or FC04)
- * @param[in] register_values Pointer to register values
- * @param[in] quantity Number of registers
+ * The byte count must cover the rest of the request, 0x09 to 0xFB bytes,
+ * and be filled exactly by sub-requests of a 7-byte header and at least
+ * one record each.
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] count Pointer to store the number of sub-requests
  * @return modbus_error_t MODBUS_OK on success
  */
-modbus_error_t modbus_pdu_encode_read_registers_response(
-    modbus_pdu_t *pdu, uint8_t function_code, const uint16_t *register_values,
-    uint16_t quantity)
+modbus_error_t modbus_pdu_view_decode_file_write_count(
+    const modbus_pdu_view_t *pdu, uint8_t *count)
 {
     modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
 
-    if ((pdu != NULL) && (register_values != NULL))
+    if ((pdu != NULL) && (pdu->data != NULL) && (count != NULL))
     {
-        uint8_t byte_count = (uint8_t)(quantity * 2U);
+        uint8_t  byte_count = (pdu->data_length > 0U) ? pdu->data[0] : 0U;
+        uint32_t pos        = 1U;
+        uint8_t  found      = 0U;
 
-        if ((1U + byte_count) <= (MODBUS_MAX_PDU_SIZE - 1U))
+        result = MODBUS_ERROR_FRAME;
+        if ((pdu->data_length == (1U + (uint16_t)byte_count)) &&
+            (byte_count >= 0x09U) && (byte_count <= 0xFBU))
         {
-            pdu->function_code = function_code;
-            pdu->data[0]       = byte_count;
+            while ((pos + 7U) <= pdu->data_length)
+            {
+                uint16_t length = pdu_read_uint16_be(&pdu->data[pos + 5U]);
 
-            for (uint16_t i = 0U; i < quantity; i++)
+                if (length == 0U)
+                {
+                    break;
+                }
+                pos += 7U + (2U * (uint32_t)length);
+                found++;
+            }
+
+            if ((pos == pdu->data_length) && (found > 0U))
             {
-                pdu_write_uint16_be(&pdu->data[1U + (i * 2U)],
-                                    register_values[i]);
+                *count = found;
+                result = MODBUS_OK;
             }
-            pdu->data_length = 1U + (uint16_t)byte_count;
-            result           = MODBUS_OK;
-        }
-        else
-        {
-            result = MODBUS_ERROR_BUFFER_OVERFLOW;
         }
     }
 
@@ -397,91 +1414,156 @@ modbus_error_t modbus_pdu_encode_read_registers_response(
 }
 
 /**
- * @brief Encode a Write Single Coil/Register response PDU (echo of request)
+ * @brief Decode the next sub-request of a Write File Record (FC21) request
  *
- * @param[out] pdu Pointer to PDU structure to fill
- * @param[in] function_code Function code (FC05 or FC06)
- * @param[in] address Address written
- * @param[in] value Value written
+ * @param[in] pdu Pointer to PDU view, checked with
+ *                modbus_pdu_view_decode_file_write_count()
+ * @param[in,out] pos Offset of the sub-request in the request data, 1 for
+ *                    the first; moved past it
+ * @param[out] reference_type Pointer to store the reference type
+ * @param[out] file_number Pointer to store the file number
+ * @param[out] record_number Pointer to store the first record
+ * @param[out] record_length Pointer to store the number of records
+ * @param[out] values Array to store the records in native byte order
+ * @param[in] max_values Size of the values array
  * @return modbus_error_t MODBUS_OK on success
  */
-modbus_error_t modbus_pdu_encode_write_single_response(modbus_pdu_t *pdu,
-                                                       uint8_t  function_code,
-                                                       uint16_t address,
-                                                       uint16_t value)
+modbus_error_t modbus_pdu_view_decode_file_write_sub_request(
+    const modbus_pdu_view_t *pdu, uint16_t *pos, uint8_t *reference_type,
+    uint16_t *file_number, uint16_t *record_number, uint16_t *record_length,
+    uint16_t *values, uint16_t max_values)
 {
     modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
 
-    if (pdu != NULL)
+    if ((pdu != NULL) && (pdu->data != NULL) && (pos != NULL) &&
+        (reference_type != NULL) && (file_number != NULL) &&
+        (record_number != NULL) && (record_length != NULL) &&
+        (values != NULL))
     {
-        pdu->function_code = function_code;
-        pdu_write_uint16_be(&pdu->data[0], address);
-        pdu_write_uint16_be(&pdu->data[2], value);
-        pdu->data_length = 4U;
-        result           = MODBUS_OK;
+        uint32_t at     = *pos;
+        uint16_t length = 0U;
+
+        if ((at + 7U) <= pdu->data_length)
+        {
+            length = pdu_read_uint16_be(&pdu->data[at + 5U]);
+        }
+
+        if (((at + 7U) > pdu->data_length) ||
+            ((at + 7U + (2U * (uint32_t)length)) > pdu->data_length))
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+        else if (length > max_values)
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+        else
+        {
+            *reference_type = pdu->data[at];
+            *file_number    = pdu_read_uint16_be(&pdu->data[at + 1U]);
+            *record_number  = pdu_read_uint16_be(&pdu->data[at + 3U]);
+            *record_length  = length;
+            at += 7U;
+            for (uint16_t r = 0U; r < length; r++)
+            {
+                values[r] = pdu_read_uint16_be(&pdu->data[at]);
+                at += 2U;
+            }
+            *pos   = (uint16_t)at;
+            result = MODBUS_OK;
+        }
     }
 
     return result;
 }
+#endif
+
+#if MODBUS_ENABLE_FC_READ_SCATTERED_REGISTERS
 
 /**
- * @brief Encode a Write Multiple Coils/Registers response PDU
+ * @brief Decode the number of descriptors of a Read Scattered Registers
+ *        (FC100) request
  *
- * @param[out] pdu Pointer to PDU structure to fill
- * @param[in] function_code Function code (FC15 or FC16)
- * @param[in] start_address Starting address
- * @param[in] quantity Number of items written
+ * The byte count must cover the rest of the request and be a whole number
+ * of 5-byte descriptors, 1 to MODBUS_SCATTER_MAX_DESCRIPTORS of them.
+ *
+ * @param[in] pdu Pointer to PDU view
+ * @param[out] count Pointer to store the number of descriptors
  * @return modbus_error_t MODBUS_OK on success
  */
-modbus_error_t modbus_pdu_encode_write_multiple_response(modbus_pdu_t *pdu,
-                                                         uint8_t  function_code,
-                                                         uint16_t start_address,
-                                                         uint16_t quantity)
+modbus_error_t modbus_pdu_view_decode_scatter_count(
+    const modbus_pdu_view_t *pdu, uint8_t *count)
 {
     modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
 
-    if (pdu != NULL)
+    if ((pdu != NULL) && (pdu->data != NULL) && (count != NULL))
     {
-        pdu->function_code = function_code;
-        pdu_write_uint16_be(&pdu->data[0], start_address);
-        pdu_write_uint16_be(&pdu->data[2], quantity);
-        pdu->data_length = 4U;
-        result           = MODBUS_OK;
+        uint8_t byte_count = (pdu->data_length > 0U) ? pdu->data[0] : 0U;
+
+        if ((pdu->data_length == (1U + (uint16_t)byte_count)) &&
+            (byte_count >= 5U) &&
+            (byte_count <= (5U * MODBUS_SCATTER_MAX_DESCRIPTORS)) &&
+            ((byte_count % 5U) == 0U))
+        {
+            *count = (uint8_t)(byte_count / 5U);
+            result = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
     }
 
     return result;
 }
 
 /**
- * @brief Encode an exception response PDU
+ * @brief Decode one descriptor of a Read Scattered Registers (FC100)
+ *        request
  *
- * @param[out] pdu Pointer to PDU structure to fill
- * @param[in] function_code Original function code
- * @param[in] exception_code Exception code
+ * @param[in] pdu Pointer to PDU view, checked with
+ *                modbus_pdu_view_decode_scatter_count()
+ * @param[in] index Descriptor, from 0
+ * @param[out] table Pointer to store the register space, as the function
+ *                   code that reads it (FC03 or FC04)
+ * @param[out] start_address Pointer to store the first register
+ * @param[out] quantity Pointer to store the number of registers
  * @return modbus_error_t MODBUS_OK on success
  */
-modbus_error_t modbus_pdu_encode_exception(modbus_pdu_t      *pdu,
-                                           uint8_t            function_code,
-                                           modbus_exception_t exception_code)
+modbus_error_t modbus_pdu_view_decode_scatter_descriptor(
+    const modbus_pdu_view_t *pdu, uint8_t index, uint8_t *table,
+    uint16_t *start_address, uint16_t *quantity)
 {
     modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
 
-    if (pdu != NULL)
+    if ((pdu != NULL) && (pdu->data != NULL) && (table != NULL) &&
+        (start_address != NULL) && (quantity != NULL))
     {
-        /* Exception response has function code with MSB set */
-        pdu->function_code = function_code | 0x80U;
-        pdu->data[0]       = (uint8_t)exception_code;
-        pdu->data_length   = 1U;
-        result             = MODBUS_OK;
+        uint16_t pos = (uint16_t)(1U + (5U * (uint16_t)index));
+
+        if ((pos + 5U) <= pdu->data_length)
+        {
+            *table         = pdu->data[pos];
+            *start_address = pdu_read_uint16_be(&pdu->data[pos + 1U]);
+            *quantity      = pdu_read_uint16_be(&pdu->data[pos + 3U]);
+            result         = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
     }
 
     return result;
 }
+#endif
 
 /* ==========================================================================
  * PDU Decoding Functions
  * ========================================================================== */
 
+#if MODBUS_PDU_HAS_READ_BITS
+
 /**
  * @brief Decode a Read Coils/Discrete Inputs request
  *
@@ -494,24 +1576,16 @@ modbus_error_t modbus_pdu_decode_read_bits_request(const modbus_pdu_t *pdu,
                                                    uint16_t *start_address,
                                                    uint16_t *quantity)
 {
-    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+    modbus_pdu_view_t view;
 
-    if ((pdu != NULL) && (start_address != NULL) && (quantity != NULL))
-    {
-        if (pdu->data_length >= 4U)
-        {
-            *start_address = pdu_read_uint16_be(&pdu->data[0]);
-            *quantity      = pdu_read_uint16_be(&pdu->data[2]);
-            result         = MODBUS_OK;
-        }
-        else
-        {
-            result = MODBUS_ERROR_FRAME;
-        }
-    }
+    modbus_pdu_view_from_pdu(pdu, &view);
 
-    return result;
+    return modbus_pdu_view_decode_read_bits_request(&view, start_address,
+                                                    quantity);
 }
+#endif
+
+#if MODBUS_PDU_HAS_READ_REGISTERS
 
 /**
  * @brief Decode a Read Registers request
@@ -525,24 +1599,16 @@ modbus_error_t modbus_pdu_decode_read_registers_request(const modbus_pdu_t *pdu,
                                                         uint16_t *start_address,
                                                         uint16_t *quantity)
 {
-    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+    modbus_pdu_view_t view;
 
-    if ((pdu != NULL) && (start_address != NULL) && (quantity != NULL))
-    {
-        if (pdu->data_length >= 4U)
-        {
-            *start_address = pdu_read_uint16_be(&pdu->data[0]);
-            *quantity      = pdu_read_uint16_be(&pdu->data[2]);
-            result         = MODBUS_OK;
-        }
-        else
-        {
-            result = MODBUS_ERROR_FRAME;
-        }
-    }
+    modbus_pdu_view_from_pdu(pdu, &view);
 
-    return result;
+    return modbus_pdu_view_decode_read_registers_request(&view, start_address,
+                                                         quantity);
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_SINGLE_COIL
 
 /**
  * @brief Decode a Write Single Coil request
@@ -555,35 +1621,16 @@ modbus_error_t modbus_pdu_decode_read_registers_request(const modbus_pdu_t *pdu,
 modbus_error_t modbus_pdu_decode_write_single_coil_request(
     const modbus_pdu_t *pdu, uint16_t *address, bool *value)
 {
-    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+    modbus_pdu_view_t view;
 
-    if ((pdu != NULL) && (address != NULL) && (value != NULL))
-    {
-        if (pdu->data_length >= 4U)
-        {
-            *address            = pdu_read_uint16_be(&pdu->data[0]);
-            uint16_t coil_value = pdu_read_uint16_be(&pdu->data[2]);
-
-            /* Validate coil value - must be 0xFF00 or 0x0000 */
-            if ((coil_value == MODBUS_COIL_ON) ||
-                (coil_value == MODBUS_COIL_OFF))
-            {
-                *value = (coil_value == MODBUS_COIL_ON);
-                result = MODBUS_OK;
-            }
-            else
-            {
-                result = MODBUS_ERROR_FRAME;
-            }
-        }
-        else
-        {
-            result = MODBUS_ERROR_FRAME;
-        }
-    }
+    modbus_pdu_view_from_pdu(pdu, &view);
 
-    return result;
+    return modbus_pdu_view_decode_write_single_coil_request(&view, address,
+                                                            value);
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_SINGLE_REGISTER
 
 /**
  * @brief Decode a Write Single Register request
@@ -596,24 +1643,16 @@ modbus_error_t modbus_pdu_decode_write_single_coil_request(
 modbus_error_t modbus_pdu_decode_write_single_register_request(
     const modbus_pdu_t *pdu, uint16_t *address, uint16_t *value)
 {
-    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+    modbus_pdu_view_t view;
 
-    if ((pdu != NULL) && (address != NULL) && (value != NULL))
-    {
-        if (pdu->data_length >= 4U)
-        {
-            *address = pdu_read_uint16_be(&pdu->data[0]);
-            *value   = pdu_read_uint16_be(&pdu->data[2]);
-            result   = MODBUS_OK;
-        }
-        else
-        {
-            result = MODBUS_ERROR_FRAME;
-        }
-    }
+    modbus_pdu_view_from_pdu(pdu, &view);
 
-    return result;
+    return modbus_pdu_view_decode_write_single_register_request(&view, address,
+                                                                value);
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_MULTIPLE_COILS
 
 /**
  * @brief Decode a Write Multiple Coils request
@@ -628,44 +1667,16 @@ modbus_error_t modbus_pdu_decode_write_multiple_coils_request(
     const modbus_pdu_t *pdu, uint16_t *start_address, uint16_t *quantity,
     const uint8_t **values)
 {
-    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
-
-    if ((pdu != NULL) && (start_address != NULL) && (quantity != NULL) &&
-        (values != NULL))
-    {
-        if (pdu->data_length >= 5U)
-        {
-            *start_address     = pdu_read_uint16_be(&pdu->data[0]);
-            *quantity          = pdu_read_uint16_be(&pdu->data[2]);
-            uint8_t byte_count = pdu->data[4];
+    modbus_pdu_view_t view;
 
-            /* Validate byte count */
-            uint8_t expected_bytes = (uint8_t)((*quantity + 7U) / 8U);
-            if (byte_count == expected_bytes)
-            {
-                if (pdu->data_length >= (5U + byte_count))
-                {
-                    *values = &pdu->data[5];
-                    result  = MODBUS_OK;
-                }
-                else
-                {
-                    result = MODBUS_ERROR_FRAME;
-                }
-            }
-            else
-            {
-                result = MODBUS_ERROR_FRAME;
-            }
-        }
-        else
-        {
-            result = MODBUS_ERROR_FRAME;
-        }
-    }
+    modbus_pdu_view_from_pdu(pdu, &view);
 
-    return result;
+    return modbus_pdu_view_decode_write_multiple_coils_request(
+        &view, start_address, quantity, values);
 }
+#endif
+
+#if MODBUS_ENABLE_FC_WRITE_MULTIPLE_REGISTERS
 
 /**
  * @brief Decode a Write Multiple Registers request
@@ -681,55 +1692,14 @@ modbus_error_t modbus_pdu_decode_write_multiple_registers_request(
     const modbus_pdu_t *pdu, uint16_t *start_address, uint16_t *quantity,
     uint16_t *values, uint16_t max_values)
 {
-    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
-
-    if ((pdu != NULL) && (start_address != NULL) && (quantity != NULL) &&
-        (values != NULL))
-    {
-        if (pdu->data_length >= 5U)
-        {
-            *start_address     = pdu_read_uint16_be(&pdu->data[0]);
-            *quantity          = pdu_read_uint16_be(&pdu->data[2]);
-            uint8_t byte_count = pdu->data[4];
+    modbus_pdu_view_t view;
 
-            /* Validate byte count */
-            if (byte_count == (*quantity * 2U))
-            {
-                if (*quantity <= max_values)
-                {
-                    if (pdu->data_length >= (5U + byte_count))
-                    {
-                        /* Extract register values */
-                        for (uint16_t i = 0U; i < *quantity; i++)
-                        {
-                            values[i] =
-                                pdu_read_uint16_be(&pdu->data[5U + (i * 2U)]);
-                        }
-                        result = MODBUS_OK;
-                    }
-                    else
-                    {
-                        result = MODBUS_ERROR_FRAME;
-                    }
-                }
-                else
-                {
-                    result = MODBUS_ERROR_BUFFER_OVERFLOW;
-                }
-            }
-            else
-            {
-                result = MODBUS_ERROR_FRAME;
-            }
-        }
-        else
-        {
-            result = MODBUS_ERROR_FRAME;
-        }
-    }
+    modbus_pdu_view_from_pdu(pdu, &view);
 
-    return result;
+    return modbus_pdu_view_decode_write_multiple_registers_request(
+        &view, start_address, quantity, values, max_values);
 }
+#endif
 
 /**
  * @brief Check if PDU is an exception response
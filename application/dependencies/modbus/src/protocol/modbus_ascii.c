@@ -81,25 +81,25 @@ modbus_error_t modbus_ascii_build_frame(const modbus_adu_t *adu, char *frame,
         {
             uint16_t binary_len = 1U + pdu_len; /* address + PDU */
 
-            /* Calculate LRC on binary data */
-            uint8_t lrc = modbus_lrc(binary_buffer, binary_len);
-
-            /* Append LRC to binary data */
-            binary_buffer[binary_len] = lrc;
-            binary_len++;
-
-            /* Calculate required frame size: : + hex_data + CR + LF */
-            if (frame_size >= (1U + (binary_len * 2U) + 2U))
+            /* Calculate required frame size: : + hex_data + LRC + CR + LF */
+            if (frame_size >= (1U + ((binary_len + 1U) * 2U) + 2U))
             {
+                uint8_t lrc;
+
                 /* Build frame: Start character */
                 frame[0] = MODBUS_ASCII_START_CHAR;
 
-                /* Build frame: Hex-encoded data (address + PDU + LRC) */
-                uint16_t ascii_len =
-                    modbus_binary_to_ascii(binary_buffer, binary_len, &frame[1],
-                                           (uint16_t)(frame_size - 3U));
+                /* Build frame: Hex-encoded address + PDU, summed for the LRC
+                 * in the same pass, then the LRC itself */
+                uint16_t ascii_len = modbus_binary_to_ascii_lrc(
+                    binary_buffer, binary_len, &frame[1],
+                    (uint16_t)(frame_size - 5U), &lrc);
                 if (ascii_len > 0U)
                 {
+                    modbus_byte_to_ascii(lrc, &frame[1U + ascii_len],
+                                         &frame[2U + ascii_len]);
+                    ascii_len += 2U;
+
                     /* Build frame: End characters */
                     frame[1U + ascii_len]      = MODBUS_ASCII_END_CR;
                     frame[1U + ascii_len + 1U] = MODBUS_ASCII_END_LF;
@@ -175,14 +175,17 @@ modbus_error_t modbus_ascii_parse_frame(const char   *frame,
                 uint8_t binary_buffer[MODBUS_ASCII_MAX_BINARY_LEN +
                                       1U]; /* +1 for LRC */
 
-                /* Convert hex to binary */
-                uint16_t binary_len = modbus_ascii_to_binary(
-                    &frame[1], hex_len, binary_buffer, sizeof(binary_buffer));
+                uint8_t lrc = 0U;
+
+                /* Convert hex to binary, summing for the LRC on the way */
+                uint16_t binary_len =
+                    modbus_ascii_to_binary_lrc(&frame[1], hex_len, binary_buffer,
+                                               sizeof(binary_buffer), &lrc);
                 if (binary_len == 0U)
                 {
                     result = MODBUS_ERROR_FRAME;
                 }
-                else if (!modbus_lrc_verify(binary_buffer, binary_len))
+                else if (lrc != 0U)
                 {
                     /* Verify LRC (binary data includes LRC byte) */
                     result =
@@ -399,6 +402,75 @@ modbus_error_t modbus_ascii_rx_process_char(modbus_ascii_rx_context_t *ctx,
     return result;
 }
 
+/**
+ * @brief Process a span of received characters in ASCII receiver
+ *
+ * For receivers fed from a DMA buffer. Runs of hex characters inside a
+ * frame are copied in one go; delimiters go through
+ * modbus_ascii_rx_process_char(). Stops once a frame is complete or in
+ * error, so the characters after it can be fed again after the reset.
+ *
+ * @param[in,out] ctx Pointer to receiver context
+ * @param[in] chars Received characters
+ * @param[in] count Number of characters
+ * @param[in] current_time_ms Current timestamp in milliseconds
+ * @param[out] consumed Number of characters taken from @p chars
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_ascii_rx_process_chars(modbus_ascii_rx_context_t *ctx,
+                                             const char *chars, uint16_t count,
+                                             uint32_t  current_time_ms,
+                                             uint16_t *consumed)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((ctx != NULL) && (chars != NULL) && (consumed != NULL))
+    {
+        uint16_t i = 0U;
+
+        result = MODBUS_OK;
+
+        while ((i < count) && (result == MODBUS_OK) &&
+               (ctx->state != ASCII_RX_STATE_COMPLETE) &&
+               (ctx->state != ASCII_RX_STATE_ERROR))
+        {
+            uint16_t run = 0U;
+
+            if (ctx->state == ASCII_RX_STATE_RECEIVING)
+            {
+                while (((i + run) < count) &&
+                       (chars[i + run] != MODBUS_ASCII_START_CHAR) &&
+                       (chars[i + run] != MODBUS_ASCII_END_CR))
+                {
+                    run++;
+                }
+            }
+
+            if (run == 0U)
+            {
+                result =
+                    modbus_ascii_rx_process_char(ctx, chars[i], current_time_ms);
+                i++;
+            }
+            else if (run <= (MODBUS_ASCII_MAX_FRAME_LEN - ctx->index))
+            {
+                (void)memcpy(&ctx->buffer[ctx->index], &chars[i], run);
+                ctx->index = (uint16_t)(ctx->index + run);
+                i          = (uint16_t)(i + run);
+            }
+            else
+            {
+                ctx->state = ASCII_RX_STATE_ERROR;
+                result     = MODBUS_ERROR_BUFFER_OVERFLOW;
+            }
+        }
+
+        *consumed = i;
+    }
+
+    return result;
+}
+
 /**
  * @brief Check if frame reception is complete
  *
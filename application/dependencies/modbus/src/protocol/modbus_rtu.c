@@ -163,6 +163,98 @@ modbus_error_t modbus_rtu_parse_frame(const uint8_t *frame,
     return result;
 }
 
+/**
+ * @brief Complete an RTU frame whose PDU was written in place
+ *
+ * The PDU must already sit at MODBUS_RTU_PDU_OFFSET in @p frame, e.g. from
+ * modbus_slave_process_pdu_buffer(); only the address and the CRC are
+ * added, so the response is never copied.
+ *
+ * @param[in] unit_id Slave address
+ * @param[in,out] frame Frame buffer holding the PDU
+ * @param[in] pdu_length Length of the PDU (function code and data)
+ * @param[in] frame_size Size of the frame buffer
+ * @param[out] frame_length Pointer to store actual frame length
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_rtu_build_frame_in_place(uint8_t unit_id, uint8_t *frame,
+                                               uint16_t  pdu_length,
+                                               uint16_t  frame_size,
+                                               uint16_t *frame_length)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((frame != NULL) && (frame_length != NULL) && (pdu_length > 0U))
+    {
+        uint16_t length = (uint16_t)(MODBUS_RTU_ADDRESS_SIZE + pdu_length);
+
+        if ((length + MODBUS_RTU_CRC_SIZE) <= frame_size)
+        {
+            uint16_t crc;
+
+            frame[0] = unit_id;
+            crc      = modbus_crc16(frame, length);
+
+            /* CRC is transmitted little-endian */
+            frame[length]      = (uint8_t)(crc & 0xFFU);
+            frame[length + 1U] = (uint8_t)(crc >> 8U);
+            *frame_length      = (uint16_t)(length + MODBUS_RTU_CRC_SIZE);
+            result             = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Parse an RTU frame in place
+ *
+ * Verifies the CRC and returns a view of the PDU that points into the frame
+ * buffer, so the request can be decoded without copying it into an ADU.
+ *
+ * @param[in] frame Input frame buffer
+ * @param[in] frame_length Length of frame data
+ * @param[out] unit_id Pointer to store the slave address
+ * @param[out] pdu Pointer to view to fill (references frame)
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_rtu_parse_frame_view(const uint8_t *frame,
+                                           uint16_t       frame_length,
+                                           uint8_t       *unit_id,
+                                           modbus_pdu_view_t *pdu)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((frame != NULL) && (unit_id != NULL) && (pdu != NULL))
+    {
+        if ((frame_length < MODBUS_RTU_MIN_FRAME_SIZE) ||
+            (frame_length > MODBUS_RTU_MAX_FRAME_SIZE))
+        {
+            result = MODBUS_ERROR_FRAME;
+        }
+        else if (!modbus_crc16_verify(frame, frame_length))
+        {
+            result = MODBUS_ERROR_CRC;
+        }
+        else
+        {
+            *unit_id           = frame[0];
+            pdu->function_code = frame[MODBUS_RTU_PDU_OFFSET];
+            pdu->data          = &frame[MODBUS_RTU_PDU_OFFSET + 1U];
+            pdu->data_length =
+                (uint16_t)(frame_length - MODBUS_RTU_ADDRESS_SIZE - 1U -
+                           MODBUS_RTU_CRC_SIZE);
+            result = MODBUS_OK;
+        }
+    }
+
+    return result;
+}
+
 /* ==========================================================================
  * RTU Timing Functions
  * ========================================================================== */
@@ -262,6 +354,7 @@ typedef struct
     modbus_rtu_rx_state_t state;                /**< Current receiver state */
     uint8_t  buffer[MODBUS_RTU_MAX_FRAME_SIZE]; /**< Receive buffer */
     uint16_t index;                             /**< Current buffer index */
+    uint16_t crc;                  /**< CRC-16 of the bytes received */
     uint32_t last_byte_time;       /**< Timestamp of last byte received */
     uint32_t interchar_timeout_us; /**< Inter-character timeout */
     uint32_t interframe_delay_us;  /**< Inter-frame delay */
@@ -283,6 +376,7 @@ modbus_error_t modbus_rtu_rx_init(modbus_rtu_rx_context_t *ctx,
     {
         ctx->state          = RTU_RX_STATE_IDLE;
         ctx->index          = 0U;
+        ctx->crc            = MODBUS_CRC16_INIT;
         ctx->last_byte_time = 0U;
         ctx->interchar_timeout_us =
             modbus_rtu_get_interchar_timeout_us(baudrate);
@@ -304,6 +398,7 @@ void modbus_rtu_rx_reset(modbus_rtu_rx_context_t *ctx)
     {
         ctx->state = RTU_RX_STATE_IDLE;
         ctx->index = 0U;
+        ctx->crc   = MODBUS_CRC16_INIT;
     }
 }
 
@@ -331,6 +426,7 @@ modbus_error_t modbus_rtu_rx_process_byte(modbus_rtu_rx_context_t *ctx,
                 /* Start of new frame */
                 ctx->buffer[0]      = byte;
                 ctx->index          = 1U;
+                ctx->crc = modbus_crc16_update(MODBUS_CRC16_INIT, &byte, 1U);
                 ctx->last_byte_time = current_time_us;
                 ctx->state          = RTU_RX_STATE_RECEIVING;
                 break;
@@ -344,6 +440,8 @@ modbus_error_t modbus_rtu_rx_process_byte(modbus_rtu_rx_context_t *ctx,
                     /* Timeout - start new frame */
                     ctx->buffer[0] = byte;
                     ctx->index     = 1U;
+                    ctx->crc =
+                        modbus_crc16_update(MODBUS_CRC16_INIT, &byte, 1U);
                 }
                 else
                 {
@@ -352,6 +450,7 @@ modbus_error_t modbus_rtu_rx_process_byte(modbus_rtu_rx_context_t *ctx,
                     {
                         ctx->buffer[ctx->index] = byte;
                         ctx->index++;
+                        ctx->crc = modbus_crc16_update(ctx->crc, &byte, 1U);
                     }
                     else
                     {
@@ -403,15 +502,17 @@ bool modbus_rtu_rx_is_complete(modbus_rtu_rx_context_t *ctx,
             uint32_t elapsed = current_time_us - ctx->last_byte_time;
             if (elapsed >= ctx->interframe_delay_us)
             {
-                /* Frame complete - check minimum length */
-                if (ctx->index >= MODBUS_RTU_MIN_FRAME_SIZE)
+                /* Frame complete - check minimum length and CRC; the CRC
+                 * runs over the CRC bytes too, leaving 0 for a good frame */
+                if ((ctx->index >= MODBUS_RTU_MIN_FRAME_SIZE) &&
+                    (ctx->crc == 0U))
                 {
                     ctx->state = RTU_RX_STATE_COMPLETE;
                     result     = true;
                 }
                 else
                 {
-                    /* Frame too short */
+                    /* Frame too short or corrupted */
                     ctx->state = RTU_RX_STATE_ERROR;
                 }
             }
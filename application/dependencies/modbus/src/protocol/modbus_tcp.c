@@ -91,11 +91,91 @@ modbus_error_t modbus_tcp_build_frame(const modbus_adu_t *adu, uint8_t *frame,
 {
     modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
 
-    if ((adu != NULL) && (frame != NULL) && (frame_length != NULL))
+    if (adu != NULL)
+    {
+        result = modbus_tcp_build_frame_pdu(adu->transaction_id, adu->unit_id,
+                                            &adu->pdu, frame, frame_size,
+                                            frame_length);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Complete a TCP frame whose PDU was written in place
+ *
+ * The PDU must already sit at MODBUS_TCP_PDU_OFFSET in @p frame, e.g. from
+ * modbus_slave_process_pdu_buffer(); only the MBAP header is written in
+ * front of it.
+ *
+ * @param[in] transaction_id Transaction identifier to echo
+ * @param[in] unit_id Unit identifier
+ * @param[in,out] frame Frame buffer holding the PDU
+ * @param[in] pdu_length Length of the PDU (function code and data)
+ * @param[in] frame_size Size of the frame buffer
+ * @param[out] frame_length Pointer to store actual frame length
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_tcp_build_frame_in_place(uint16_t  transaction_id,
+                                               uint8_t   unit_id,
+                                               uint8_t  *frame,
+                                               uint16_t  pdu_length,
+                                               uint16_t  frame_size,
+                                               uint16_t *frame_length)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((frame != NULL) && (frame_length != NULL) && (pdu_length > 0U))
+    {
+        if ((MODBUS_TCP_MBAP_SIZE + (uint32_t)pdu_length) <= frame_size)
+        {
+            tcp_write_uint16_be(&frame[MBAP_OFFSET_TRANSACTION_ID],
+                                transaction_id);
+            tcp_write_uint16_be(&frame[MBAP_OFFSET_PROTOCOL_ID],
+                                MODBUS_TCP_PROTOCOL_ID);
+            /* Length covers the unit ID and the PDU */
+            tcp_write_uint16_be(&frame[MBAP_OFFSET_LENGTH],
+                                (uint16_t)(1U + pdu_length));
+            frame[MBAP_OFFSET_UNIT_ID] = unit_id;
+
+            *frame_length = (uint16_t)(MODBUS_TCP_MBAP_SIZE + pdu_length);
+            result        = MODBUS_OK;
+        }
+        else
+        {
+            result = MODBUS_ERROR_BUFFER_OVERFLOW;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Build a TCP frame directly from header fields and a PDU
+ *
+ * Same as modbus_tcp_build_frame() but without requiring the caller to
+ * assemble a modbus_adu_t (and copy the PDU into it) first.
+ *
+ * @param[in] transaction_id Transaction identifier to echo
+ * @param[in] unit_id Unit identifier
+ * @param[in] pdu Pointer to PDU structure
+ * @param[out] frame Output buffer for the frame
+ * @param[in] frame_size Size of output buffer
+ * @param[out] frame_length Pointer to store actual frame length
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_tcp_build_frame_pdu(uint16_t            transaction_id,
+                                          uint8_t             unit_id,
+                                          const modbus_pdu_t *pdu,
+                                          uint8_t *frame, uint16_t frame_size,
+                                          uint16_t *frame_length)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((pdu != NULL) && (frame != NULL) && (frame_length != NULL))
     {
         /* Calculate PDU length */
-        uint16_t pdu_length =
-            1U + adu->pdu.data_length; /* function code + data */
+        uint16_t pdu_length = 1U + pdu->data_length; /* function code + data */
 
         /* Calculate total frame length: MBAP header + PDU */
         uint16_t total_length = MODBUS_TCP_MBAP_SIZE + pdu_length;
@@ -104,16 +184,16 @@ modbus_error_t modbus_tcp_build_frame(const modbus_adu_t *adu, uint8_t *frame,
         {
             /* Build MBAP header */
             tcp_write_uint16_be(&frame[MBAP_OFFSET_TRANSACTION_ID],
-                                adu->transaction_id);
+                                transaction_id);
             tcp_write_uint16_be(&frame[MBAP_OFFSET_PROTOCOL_ID],
                                 MODBUS_TCP_PROTOCOL_ID);
             tcp_write_uint16_be(&frame[MBAP_OFFSET_LENGTH],
                                 1U + pdu_length); /* Unit ID + PDU */
-            frame[MBAP_OFFSET_UNIT_ID] = adu->unit_id;
+            frame[MBAP_OFFSET_UNIT_ID] = unit_id;
 
             /* Serialize PDU */
             modbus_error_t err = modbus_pdu_serialize(
-                &adu->pdu, &frame[MBAP_OFFSET_PDU],
+                pdu, &frame[MBAP_OFFSET_PDU],
                 (uint16_t)(frame_size - MODBUS_TCP_MBAP_SIZE), &pdu_length);
             if (err == MODBUS_OK)
             {
@@ -150,6 +230,50 @@ modbus_error_t modbus_tcp_parse_frame(const uint8_t *frame,
     modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
 
     if ((frame != NULL) && (adu != NULL))
+    {
+        modbus_pdu_view_t view;
+
+        result = modbus_tcp_parse_frame_view(
+            frame, frame_length, &adu->transaction_id, &adu->unit_id, &view);
+        if (result == MODBUS_OK)
+        {
+            adu->protocol_id       = MODBUS_TCP_PROTOCOL_ID;
+            adu->pdu.function_code = view.function_code;
+            adu->pdu.data_length   = view.data_length;
+
+            if (view.data_length > 0U)
+            {
+                (void)memcpy(adu->pdu.data, view.data, view.data_length);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Parse a TCP frame in place
+ *
+ * Validates the MBAP header and returns a view of the PDU that points into
+ * the frame buffer, so the request can be decoded without copying it.
+ *
+ * @param[in] frame Input frame buffer
+ * @param[in] frame_length Length of frame data
+ * @param[out] transaction_id Pointer to store the transaction identifier
+ * @param[out] unit_id Pointer to store the unit identifier
+ * @param[out] pdu Pointer to view to fill (references frame)
+ * @return modbus_error_t MODBUS_OK on success
+ */
+modbus_error_t modbus_tcp_parse_frame_view(const uint8_t *frame,
+                                           uint16_t       frame_length,
+                                           uint16_t      *transaction_id,
+                                           uint8_t       *unit_id,
+                                           modbus_pdu_view_t *pdu)
+{
+    modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+
+    if ((frame != NULL) && (transaction_id != NULL) && (unit_id != NULL) &&
+        (pdu != NULL))
     {
         /* Validate minimum frame length */
         if (frame_length < MODBUS_TCP_MIN_FRAME_SIZE)
@@ -161,49 +285,63 @@ modbus_error_t modbus_tcp_parse_frame(const uint8_t *frame,
             /* Validate maximum frame length */
             result = MODBUS_ERROR_FRAME;
         }
+        else if (tcp_read_uint16_be(&frame[MBAP_OFFSET_PROTOCOL_ID]) !=
+                 MODBUS_TCP_PROTOCOL_ID)
+        {
+            /* Protocol ID must be 0 for Modbus */
+            result = MODBUS_ERROR_FRAME;
+        }
+        else if ((MODBUS_TCP_MBAP_SIZE - 1U +
+                  tcp_read_uint16_be(&frame[MBAP_OFFSET_LENGTH])) !=
+                 frame_length)
+        {
+            /* Length field doesn't match actual frame length */
+            result = MODBUS_ERROR_FRAME;
+        }
         else
         {
-            /* Validate protocol ID (must be 0 for Modbus) */
-            uint16_t protocol_id =
-                tcp_read_uint16_be(&frame[MBAP_OFFSET_PROTOCOL_ID]);
-            if (protocol_id != MODBUS_TCP_PROTOCOL_ID)
-            {
-                result = MODBUS_ERROR_FRAME;
-            }
-            else
-            {
-                /* Validate length field */
-                uint16_t length_field =
-                    tcp_read_uint16_be(&frame[MBAP_OFFSET_LENGTH]);
-                if ((MODBUS_TCP_MBAP_SIZE - 1U + length_field) != frame_length)
-                {
-                    /* Length field doesn't match actual frame length */
-                    result = MODBUS_ERROR_FRAME;
-                }
-                else
-                {
-                    /* Extract MBAP header fields */
-                    adu->transaction_id =
-                        tcp_read_uint16_be(&frame[MBAP_OFFSET_TRANSACTION_ID]);
-                    adu->protocol_id = protocol_id;
-                    adu->unit_id     = frame[MBAP_OFFSET_UNIT_ID];
-
-                    /* Extract PDU */
-                    uint16_t pdu_length =
-                        (uint16_t)(length_field -
-                                   1U); /* Subtract Unit ID byte */
-                    modbus_error_t err = modbus_pdu_deserialize(
-                        &adu->pdu, &frame[MBAP_OFFSET_PDU], pdu_length);
-                    if (err == MODBUS_OK)
-                    {
-                        result = MODBUS_OK;
-                    }
-                    else
-                    {
-                        result = err;
-                    }
-                }
-            }
+            /* Extract MBAP header fields */
+            *transaction_id =
+                tcp_read_uint16_be(&frame[MBAP_OFFSET_TRANSACTION_ID]);
+            *unit_id = frame[MBAP_OFFSET_UNIT_ID];
+
+            /* PDU starts after the unit ID */
+            pdu->function_code = frame[MBAP_OFFSET_PDU];
+            pdu->data          = &frame[MBAP_OFFSET_PDU + 1U];
+            pdu->data_length =
+                (uint16_t)(frame_length - MODBUS_TCP_MIN_FRAME_SIZE);
+            result = MODBUS_OK;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get the length of a complete frame at the start of a buffer
+ *
+ * Used to decode frames in place when a whole ADU arrives in one segment.
+ *
+ * @param[in] data Received bytes
+ * @param[in] length Number of received bytes
+ * @return uint16_t Total frame length, or 0 if no complete, plausible frame
+ *         starts at data
+ */
+uint16_t modbus_tcp_get_frame_length(const uint8_t *data, uint16_t length)
+{
+    uint16_t result = 0U;
+
+    if ((data != NULL) && (length >= MODBUS_TCP_MIN_FRAME_SIZE))
+    {
+        uint16_t frame_length =
+            (uint16_t)(MODBUS_TCP_MBAP_SIZE - 1U +
+                       tcp_read_uint16_be(&data[MBAP_OFFSET_LENGTH]));
+
+        if ((frame_length >= MODBUS_TCP_MIN_FRAME_SIZE) &&
+            (frame_length <= MODBUS_TCP_MAX_FRAME_SIZE) &&
+            (frame_length <= length))
+        {
+            result = frame_length;
         }
     }
 
@@ -245,30 +383,6 @@ void modbus_tcp_set_transaction_id(uint16_t id) { s_transaction_id = id; }
  * TCP Frame Receiver State Machine
  * ========================================================================== */
 
-/**
- * @brief TCP receiver states
- */
-typedef enum
-{
-    TCP_RX_STATE_HEADER = 0, /**< Receiving MBAP header */
-    TCP_RX_STATE_PDU,        /**< Receiving PDU data */
-    TCP_RX_STATE_COMPLETE,   /**< Frame reception complete */
-    TCP_RX_STATE_ERROR       /**< Reception error */
-} modbus_tcp_rx_state_t;
-
-/**
- * @brief TCP receiver context
- */
-typedef struct
-{
-    modbus_tcp_rx_state_t state;                /**< Current receiver state */
-    uint8_t  buffer[MODBUS_TCP_MAX_FRAME_SIZE]; /**< Receive buffer */
-    uint16_t index;                             /**< Current buffer index */
-    uint16_t expected_length; /**< Expected total frame length */
-    uint32_t start_time;      /**< Timestamp of frame start */
-    uint32_t timeout_ms;      /**< Frame timeout in milliseconds */
-} modbus_tcp_rx_context_t;
-
 /**
  * @brief Initialize TCP receiver context
  *
@@ -312,17 +426,24 @@ void modbus_tcp_rx_reset(modbus_tcp_rx_context_t *ctx)
 /**
  * @brief Process received data in TCP receiver
  *
+ * Consumes bytes until one frame is complete or the input is exhausted.
+ * Bytes following a completed frame are left unconsumed so the caller can
+ * handle the frame, reset the receiver and feed the remainder.
+ *
  * @param[in,out] ctx Pointer to receiver context
  * @param[in] data Pointer to received data
  * @param[in] length Length of received data
  * @param[in] current_time_ms Current timestamp in milliseconds
+ * @param[out] consumed Number of bytes taken from data (may be NULL)
  * @return modbus_error_t MODBUS_OK on success
  */
 modbus_error_t modbus_tcp_rx_process_data(modbus_tcp_rx_context_t *ctx,
                                           const uint8_t *data, uint16_t length,
-                                          uint32_t current_time_ms)
+                                          uint32_t  current_time_ms,
+                                          uint16_t *consumed)
 {
     modbus_error_t result = MODBUS_ERROR_INVALID_PARAM;
+    uint16_t       offset = 0U;
 
     if ((ctx != NULL) && (data != NULL))
     {
@@ -342,7 +463,6 @@ modbus_error_t modbus_tcp_rx_process_data(modbus_tcp_rx_context_t *ctx,
                 ctx->start_time = current_time_ms;
             }
 
-            uint16_t offset = 0U;
             while ((offset < length) && processing && (result == MODBUS_OK))
             {
                 uint16_t remaining =
@@ -353,7 +473,7 @@ modbus_error_t modbus_tcp_rx_process_data(modbus_tcp_rx_context_t *ctx,
                         : remaining;
 
                 /* Check buffer overflow */
-                if ((ctx->index + bytes_to_copy) > MODBUS_TCP_MAX_FRAME_SIZE)
+                if ((ctx->index + bytes_to_copy) > MODBUS_TCP_MAX_ADU_SIZE)
                 {
                     ctx->state = TCP_RX_STATE_ERROR;
                     result     = MODBUS_ERROR_BUFFER_OVERFLOW;
@@ -397,7 +517,7 @@ modbus_error_t modbus_tcp_rx_process_data(modbus_tcp_rx_context_t *ctx,
                                     MODBUS_TCP_MBAP_SIZE - 1U + length_field;
 
                                 if (ctx->expected_length >
-                                    MODBUS_TCP_MAX_FRAME_SIZE)
+                                    MODBUS_TCP_MAX_ADU_SIZE)
                                 {
                                     ctx->state = TCP_RX_STATE_ERROR;
                                     result     = MODBUS_ERROR_FRAME;
@@ -429,6 +549,11 @@ modbus_error_t modbus_tcp_rx_process_data(modbus_tcp_rx_context_t *ctx,
         }
     }
 
+    if (consumed != NULL)
+    {
+        *consumed = offset;
+    }
+
     return result;
 }
 
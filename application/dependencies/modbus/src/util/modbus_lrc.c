@@ -80,47 +80,80 @@ bool modbus_lrc_verify(const uint8_t *data, uint16_t length)
     return result;
 }
 
+/* ==========================================================================
+ * Hex Conversion Tables
+ * ========================================================================== */
+
+/** Marks a character that is not a hex digit in s_hex_decode_table */
+#define HEX_INVALID 0xFFU
+
 /**
- * @brief Convert a nibble (4 bits) to ASCII hex character
- *
- * @param[in] nibble Value 0-15 to convert
- * @return char ASCII character '0'-'9' or 'A'-'F'
+ * Byte to its two upper-case hex characters, the first in the low byte, so
+ * a frame is encoded with one lookup per byte
  */
-static char nibble_to_ascii(uint8_t nibble)
-{
-    static const char hex_chars[] = "0123456789ABCDEF";
-    return hex_chars[nibble & 0x0FU];
-}
+static const uint16_t s_hex_encode_table[256] = {
+    0x3030, 0x3130, 0x3230, 0x3330, 0x3430, 0x3530, 0x3630, 0x3730, 0x3830,
+    0x3930, 0x4130, 0x4230, 0x4330, 0x4430, 0x4530, 0x4630, 0x3031, 0x3131,
+    0x3231, 0x3331, 0x3431, 0x3531, 0x3631, 0x3731, 0x3831, 0x3931, 0x4131,
+    0x4231, 0x4331, 0x4431, 0x4531, 0x4631, 0x3032, 0x3132, 0x3232, 0x3332,
+    0x3432, 0x3532, 0x3632, 0x3732, 0x3832, 0x3932, 0x4132, 0x4232, 0x4332,
+    0x4432, 0x4532, 0x4632, 0x3033, 0x3133, 0x3233, 0x3333, 0x3433, 0x3533,
+    0x3633, 0x3733, 0x3833, 0x3933, 0x4133, 0x4233, 0x4333, 0x4433, 0x4533,
+    0x4633, 0x3034, 0x3134, 0x3234, 0x3334, 0x3434, 0x3534, 0x3634, 0x3734,
+    0x3834, 0x3934, 0x4134, 0x4234, 0x4334, 0x4434, 0x4534, 0x4634, 0x3035,
+    0x3135, 0x3235, 0x3335, 0x3435, 0x3535, 0x3635, 0x3735, 0x3835, 0x3935,
+    0x4135, 0x4235, 0x4335, 0x4435, 0x4535, 0x4635, 0x3036, 0x3136, 0x3236,
+    0x3336, 0x3436, 0x3536, 0x3636, 0x3736, 0x3836, 0x3936, 0x4136, 0x4236,
+    0x4336, 0x4436, 0x4536, 0x4636, 0x3037, 0x3137, 0x3237, 0x3337, 0x3437,
+    0x3537, 0x3637, 0x3737, 0x3837, 0x3937, 0x4137, 0x4237, 0x4337, 0x4437,
+    0x4537, 0x4637, 0x3038, 0x3138, 0x3238, 0x3338, 0x3438, 0x3538, 0x3638,
+    0x3738, 0x3838, 0x3938, 0x4138, 0x4238, 0x4338, 0x4438, 0x4538, 0x4638,
+    0x3039, 0x3139, 0x3239, 0x3339, 0x3439, 0x3539, 0x3639, 0x3739, 0x3839,
+    0x3939, 0x4139, 0x4239, 0x4339, 0x4439, 0x4539, 0x4639, 0x3041, 0x3141,
+    0x3241, 0x3341, 0x3441, 0x3541, 0x3641, 0x3741, 0x3841, 0x3941, 0x4141,
+    0x4241, 0x4341, 0x4441, 0x4541, 0x4641, 0x3042, 0x3142, 0x3242, 0x3342,
+    0x3442, 0x3542, 0x3642, 0x3742, 0x3842, 0x3942, 0x4142, 0x4242, 0x4342,
+    0x4442, 0x4542, 0x4642, 0x3043, 0x3143, 0x3243, 0x3343, 0x3443, 0x3543,
+    0x3643, 0x3743, 0x3843, 0x3943, 0x4143, 0x4243, 0x4343, 0x4443, 0x4543,
+    0x4643, 0x3044, 0x3144, 0x3244, 0x3344, 0x3444, 0x3544, 0x3644, 0x3744,
+    0x3844, 0x3944, 0x4144, 0x4244, 0x4344, 0x4444, 0x4544, 0x4644, 0x3045,
+    0x3145, 0x3245, 0x3345, 0x3445, 0x3545, 0x3645, 0x3745, 0x3845, 0x3945,
+    0x4145, 0x4245, 0x4345, 0x4445, 0x4545, 0x4645, 0x3046, 0x3146, 0x3246,
+    0x3346, 0x3446, 0x3546, 0x3646, 0x3746, 0x3846, 0x3946, 0x4146, 0x4246,
+    0x4346, 0x4446, 0x4546, 0x4646};
 
 /**
- * @brief Convert ASCII hex character to nibble value
- *
- * @param[in] c ASCII character '0'-'9', 'A'-'F', or 'a'-'f'
- * @return int8_t Value 0-15, or -1 if invalid character
+ * Character to its nibble value, HEX_INVALID for anything but '0'-'9',
+ * 'A'-'F' and 'a'-'f'. OR-ing the entries of a whole buffer validates it
+ * once at the end instead of branching on every character.
  */
-static int8_t ascii_to_nibble(char c)
-{
-    int8_t result = -1;
+static const uint8_t s_hex_decode_table[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF};
 
-    if ((c >= '0') && (c <= '9'))
-    {
-        result = (int8_t)(c - '0');
-    }
-    else if ((c >= 'A') && (c <= 'F'))
-    {
-        result = (int8_t)(c - 'A' + 10);
-    }
-    else if ((c >= 'a') && (c <= 'f'))
-    {
-        result = (int8_t)(c - 'a' + 10);
-    }
-    else
-    {
-        /* result already -1 */
-    }
-
-    return result;
-}
+/* ==========================================================================
+ * Hex Conversion Functions
+ * ========================================================================== */
 
 /**
  * @brief Convert binary byte to two ASCII hex characters
@@ -133,8 +166,9 @@ void modbus_byte_to_ascii(uint8_t byte, char *high_char, char *low_char)
 {
     if ((high_char != NULL) && (low_char != NULL))
     {
-        *high_char = nibble_to_ascii((byte >> 4U) & 0x0FU);
-        *low_char  = nibble_to_ascii(byte & 0x0FU);
+        uint16_t pair = s_hex_encode_table[byte];
+        *high_char    = (char)(pair & 0xFFU);
+        *low_char     = (char)(pair >> 8U);
     }
 }
 
@@ -154,13 +188,12 @@ modbus_error_t modbus_ascii_to_byte(char high_char, char low_char,
 
     if (byte != NULL)
     {
-        int8_t high_nibble = ascii_to_nibble(high_char);
-        int8_t low_nibble  = ascii_to_nibble(low_char);
+        uint8_t high_nibble = s_hex_decode_table[(uint8_t)high_char];
+        uint8_t low_nibble  = s_hex_decode_table[(uint8_t)low_char];
 
-        if ((high_nibble >= 0) && (low_nibble >= 0))
+        if ((high_nibble != HEX_INVALID) && (low_nibble != HEX_INVALID))
         {
-            *byte =
-                (uint8_t)(((uint8_t)high_nibble << 4U) | (uint8_t)low_nibble);
+            *byte  = (uint8_t)((uint8_t)(high_nibble << 4U) | low_nibble);
             result = MODBUS_OK;
         }
         else
@@ -173,30 +206,45 @@ modbus_error_t modbus_ascii_to_byte(char high_char, char low_char,
 }
 
 /**
- * @brief Convert binary buffer to ASCII hex string
+ * @brief Convert binary buffer to ASCII hex string and compute its LRC
+ *
+ * Encodes and sums in one pass over the data.
  *
  * @param[in] binary Pointer to binary data
  * @param[in] binary_len Length of binary data
  * @param[out] ascii Pointer to ASCII output buffer (must be at least
  * 2*binary_len bytes)
  * @param[in] ascii_size Size of ASCII buffer
+ * @param[out] lrc LRC of the binary data, as modbus_lrc() (may be NULL)
  * @return uint16_t Number of ASCII characters written, or 0 on error
  */
-uint16_t modbus_binary_to_ascii(const uint8_t *binary, uint16_t binary_len,
-                                char *ascii, uint16_t ascii_size)
+uint16_t modbus_binary_to_ascii_lrc(const uint8_t *binary, uint16_t binary_len,
+                                    char *ascii, uint16_t ascii_size,
+                                    uint8_t *lrc)
 {
     uint16_t result = 0U;
 
     if ((binary != NULL) && (ascii != NULL) && (binary_len > 0U))
     {
         /* Check if output buffer is large enough */
-        uint16_t ascii_len = binary_len * 2U;
+        uint16_t ascii_len = (uint16_t)(binary_len * 2U);
         if (ascii_size >= ascii_len)
         {
+            uint8_t sum = 0U;
+            char   *out = ascii;
+
             for (uint16_t i = 0U; i < binary_len; i++)
             {
-                modbus_byte_to_ascii(binary[i], &ascii[i * 2U],
-                                     &ascii[(i * 2U) + 1U]);
+                uint16_t pair = s_hex_encode_table[binary[i]];
+                out[0]        = (char)(pair & 0xFFU);
+                out[1]        = (char)(pair >> 8U);
+                out           = &out[2];
+                sum           = (uint8_t)(sum + binary[i]);
+            }
+
+            if (lrc != NULL)
+            {
+                *lrc = (uint8_t)(-(int8_t)sum);
             }
             result = ascii_len;
         }
@@ -206,19 +254,40 @@ uint16_t modbus_binary_to_ascii(const uint8_t *binary, uint16_t binary_len,
 }
 
 /**
- * @brief Convert ASCII hex string to binary buffer
+ * @brief Convert binary buffer to ASCII hex string
+ *
+ * @param[in] binary Pointer to binary data
+ * @param[in] binary_len Length of binary data
+ * @param[out] ascii Pointer to ASCII output buffer (must be at least
+ * 2*binary_len bytes)
+ * @param[in] ascii_size Size of ASCII buffer
+ * @return uint16_t Number of ASCII characters written, or 0 on error
+ */
+uint16_t modbus_binary_to_ascii(const uint8_t *binary, uint16_t binary_len,
+                                char *ascii, uint16_t ascii_size)
+{
+    return modbus_binary_to_ascii_lrc(binary, binary_len, ascii, ascii_size,
+                                      NULL);
+}
+
+/**
+ * @brief Convert ASCII hex string to binary buffer and compute its LRC
+ *
+ * Decodes, validates and sums in one pass. When the string ends with the
+ * LRC of a frame, @p lrc is 0 for an intact frame.
  *
  * @param[in] ascii Pointer to ASCII hex string
  * @param[in] ascii_len Length of ASCII string (must be even)
  * @param[out] binary Pointer to binary output buffer
  * @param[in] binary_size Size of binary buffer
+ * @param[out] lrc LRC of the decoded bytes, as modbus_lrc() (may be NULL)
  * @return uint16_t Number of binary bytes written, or 0 on error
  */
-uint16_t modbus_ascii_to_binary(const char *ascii, uint16_t ascii_len,
-                                uint8_t *binary, uint16_t binary_size)
+uint16_t modbus_ascii_to_binary_lrc(const char *ascii, uint16_t ascii_len,
+                                    uint8_t *binary, uint16_t binary_size,
+                                    uint8_t *lrc)
 {
-    uint16_t result        = 0U;
-    bool     conversion_ok = true;
+    uint16_t result = 0U;
 
     if ((ascii != NULL) && (binary != NULL) && (ascii_len > 0U) &&
         ((ascii_len % 2U) == 0U))
@@ -226,17 +295,29 @@ uint16_t modbus_ascii_to_binary(const char *ascii, uint16_t ascii_len,
         uint16_t binary_len = ascii_len / 2U;
         if (binary_size >= binary_len)
         {
-            for (uint16_t i = 0U; (i < binary_len) && conversion_ok; i++)
+            const uint8_t *in      = (const uint8_t *)ascii;
+            uint8_t        invalid = 0U;
+            uint8_t        sum     = 0U;
+
+            for (uint16_t i = 0U; i < binary_len; i++)
             {
-                modbus_error_t err = modbus_ascii_to_byte(
-                    ascii[i * 2U], ascii[(i * 2U) + 1U], &binary[i]);
-                if (err != MODBUS_OK)
-                {
-                    conversion_ok = false;
-                }
+                uint8_t high = s_hex_decode_table[in[0]];
+                uint8_t low  = s_hex_decode_table[in[1]];
+                uint8_t byte = (uint8_t)((uint8_t)(high << 4U) | low);
+
+                invalid   = (uint8_t)(invalid | high | low);
+                binary[i] = byte;
+                sum       = (uint8_t)(sum + byte);
+                in        = &in[2];
             }
-            if (conversion_ok)
+
+            /* Only HEX_INVALID has bit 4 set; valid nibbles are below 16 */
+            if ((invalid & 0x10U) == 0U)
             {
+                if (lrc != NULL)
+                {
+                    *lrc = (uint8_t)(-(int8_t)sum);
+                }
                 result = binary_len;
             }
         }
@@ -244,3 +325,19 @@ uint16_t modbus_ascii_to_binary(const char *ascii, uint16_t ascii_len,
 
     return result;
 }
+
+/**
+ * @brief Convert ASCII hex string to binary buffer
+ *
+ * @param[in] ascii Pointer to ASCII hex string
+ * @param[in] ascii_len Length of ASCII string (must be even)
+ * @param[out] binary Pointer to binary output buffer
+ * @param[in] binary_size Size of binary buffer
+ * @return uint16_t Number of binary bytes written, or 0 on error
+ */
+uint16_t modbus_ascii_to_binary(const char *ascii, uint16_t ascii_len,
+                                uint8_t *binary, uint16_t binary_size)
+{
+    return modbus_ascii_to_binary_lrc(ascii, ascii_len, binary, binary_size,
+                                      NULL);
+}
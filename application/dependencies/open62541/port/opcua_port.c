@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * open62541 Memory Port
+ *
+ * A block does not record its size: free() and realloc() find its class
+ * from the address, as each class is an array of its own.
+ */
+
+#include "opcua_port.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "open62541/types.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/**
+ * Blocks per size class. Node and string allocations are small and many,
+ * the large classes serve the message chunks of the connections.
+ */
+#define OPCUA_PORT_BLOCKS_32   768U
+#define OPCUA_PORT_BLOCKS_64   384U
+#define OPCUA_PORT_BLOCKS_128  192U
+#define OPCUA_PORT_BLOCKS_256  96U
+#define OPCUA_PORT_BLOCKS_512  32U
+#define OPCUA_PORT_BLOCKS_1024 8U
+#define OPCUA_PORT_BLOCKS_2048 4U
+#define OPCUA_PORT_BLOCKS_8192 5U
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/* Blocks of each class, 8-byte aligned as malloc() must be */
+typedef struct { uint64_t words[32U / 8U]; } opcua_block_32_t;
+typedef struct { uint64_t words[64U / 8U]; } opcua_block_64_t;
+typedef struct { uint64_t words[128U / 8U]; } opcua_block_128_t;
+typedef struct { uint64_t words[256U / 8U]; } opcua_block_256_t;
+typedef struct { uint64_t words[512U / 8U]; } opcua_block_512_t;
+typedef struct { uint64_t words[1024U / 8U]; } opcua_block_1024_t;
+typedef struct { uint64_t words[2048U / 8U]; } opcua_block_2048_t;
+typedef struct { uint64_t words[8192U / 8U]; } opcua_block_8192_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+BLOCK_POOL_DEFINE(s_pool_32, opcua_block_32_t, OPCUA_PORT_BLOCKS_32);
+BLOCK_POOL_DEFINE(s_pool_64, opcua_block_64_t, OPCUA_PORT_BLOCKS_64);
+BLOCK_POOL_DEFINE(s_pool_128, opcua_block_128_t, OPCUA_PORT_BLOCKS_128);
+BLOCK_POOL_DEFINE(s_pool_256, opcua_block_256_t, OPCUA_PORT_BLOCKS_256);
+BLOCK_POOL_DEFINE(s_pool_512, opcua_block_512_t, OPCUA_PORT_BLOCKS_512);
+BLOCK_POOL_DEFINE(s_pool_1024, opcua_block_1024_t, OPCUA_PORT_BLOCKS_1024);
+BLOCK_POOL_DEFINE(s_pool_2048, opcua_block_2048_t, OPCUA_PORT_BLOCKS_2048);
+BLOCK_POOL_DEFINE(s_pool_8192, opcua_block_8192_t, OPCUA_PORT_BLOCKS_8192);
+
+/** Size classes, smallest first */
+static block_pool_t *const s_pools[OPCUA_PORT_POOL_COUNT] = {
+    &s_pool_32,  &s_pool_64,   &s_pool_128,  &s_pool_256,
+    &s_pool_512, &s_pool_1024, &s_pool_2048, &s_pool_8192,
+};
+
+/** Block size of each class */
+static const size_t s_block_sizes[OPCUA_PORT_POOL_COUNT] = {
+    32U, 64U, 128U, 256U, 512U, 1024U, 2048U, 8192U,
+};
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Size class holding a block, -1 if none
+ */
+static int32_t opcua_port_class(const void *ptr)
+{
+    for (uint32_t i = 0U; i < OPCUA_PORT_POOL_COUNT; i++)
+    {
+        if (block_pool_index(s_pools[i], ptr) >= 0)
+        {
+            return (int32_t)i;
+        }
+    }
+
+    return -1;
+}
+
+static void *opcua_port_malloc(size_t size)
+{
+    for (uint32_t i = 0U; i < OPCUA_PORT_POOL_COUNT; i++)
+    {
+        void *block;
+
+        if (size > s_block_sizes[i])
+        {
+            continue;
+        }
+        block = block_pool_alloc(s_pools[i]);
+        if (block != NULL)
+        {
+            return block;
+        }
+    }
+
+    return NULL;
+}
+
+static void opcua_port_free(void *ptr)
+{
+    int32_t cls;
+
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    cls = opcua_port_class(ptr);
+    if (cls >= 0)
+    {
+        (void)block_pool_free(s_pools[cls], ptr);
+    }
+}
+
+static void *opcua_port_calloc(size_t nelem, size_t elsize)
+{
+    void *ptr;
+
+    if ((elsize != 0U) && (nelem > (SIZE_MAX / elsize)))
+    {
+        return NULL;
+    }
+
+    ptr = opcua_port_malloc(nelem * elsize);
+    if (ptr != NULL)
+    {
+        (void)memset(ptr, 0, nelem * elsize);
+    }
+
+    return ptr;
+}
+
+static void *opcua_port_realloc(void *ptr, size_t size)
+{
+    int32_t cls;
+    size_t  old_size;
+    void   *moved;
+
+    if (ptr == NULL)
+    {
+        return opcua_port_malloc(size);
+    }
+    if (size == 0U)
+    {
+        opcua_port_free(ptr);
+        return NULL;
+    }
+
+    cls = opcua_port_class(ptr);
+    if (cls < 0)
+    {
+        return NULL;
+    }
+
+    /* A block that still fits stays where it is */
+    old_size = s_block_sizes[cls];
+    if (size <= old_size)
+    {
+        return ptr;
+    }
+
+    moved = opcua_port_malloc(size);
+    if (moved != NULL)
+    {
+        (void)memcpy(moved, ptr, old_size);
+        (void)block_pool_free(s_pools[cls], ptr);
+    }
+
+    return moved;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void opcua_port_init(void)
+{
+    for (uint32_t i = 0U; i < OPCUA_PORT_POOL_COUNT; i++)
+    {
+        block_pool_init(s_pools[i]);
+    }
+
+    UA_mallocSingleton  = opcua_port_malloc;
+    UA_freeSingleton    = opcua_port_free;
+    UA_callocSingleton  = opcua_port_calloc;
+    UA_reallocSingleton = opcua_port_realloc;
+}
+
+void opcua_port_get_stats(block_pool_stats_t stats[OPCUA_PORT_POOL_COUNT])
+{
+    for (uint32_t i = 0U; i < OPCUA_PORT_POOL_COUNT; i++)
+    {
+        block_pool_get_stats(s_pools[i], &stats[i]);
+    }
+}
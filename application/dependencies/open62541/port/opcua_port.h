@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * open62541 Memory Port
+ *
+ * The FreeRTOS port of open62541 allocates from the FreeRTOS heap, which
+ * this firmware does not have (configSUPPORT_DYNAMIC_ALLOCATION 0). Its
+ * allocator singletons are pointed instead at fixed-block pools
+ * (block_pool.h) of OPCUA_PORT_POOL_COUNT size classes: an allocation
+ * takes a block of the smallest class it fits into, or of the next one
+ * while that class is empty, and fails beyond the largest. The classes
+ * are sized for the address space of jerry_registers.json and
+ * OPCUA_SERVER_MAX_SESSIONS sessions; opcua_port_get_stats() shows how
+ * full they ran.
+ */
+
+#ifndef OPCUA_PORT_H
+#define OPCUA_PORT_H
+
+#include <stdint.h>
+
+#include "block_pool.h"
+
+/** Size classes of the allocator */
+#define OPCUA_PORT_POOL_COUNT 8U
+
+/**
+ * @brief Point the open62541 allocator at the pools
+ *
+ * Called once, before any other open62541 function, by the task that owns
+ * the stack.
+ */
+void opcua_port_init(void);
+
+/**
+ * @brief Read the statistics of the size classes
+ *
+ * @param[out] stats OPCUA_PORT_POOL_COUNT entries, smallest class first
+ */
+void opcua_port_get_stats(block_pool_stats_t stats[OPCUA_PORT_POOL_COUNT]);
+
+#endif /* OPCUA_PORT_H */
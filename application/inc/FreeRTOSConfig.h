@@ -10,22 +10,40 @@
 #include <stdint.h>
 #include <stdio.h> /* For printf */
 
+#include "task_priorities.h"
+
 /* Map configPRINTF to standard printf */
 #define configPRINTF(X) printf X
 
 extern uint32_t SystemCoreClock;
 
+#ifndef BSP_POSIX
+#define BSP_POSIX 0
+#endif
+
+#if !BSP_POSIX
+/* Tickless idle on the BSP low-power timer instead of the port's SysTick
+ * version */
+extern void low_power_suppress_ticks_and_sleep(uint32_t expected_idle);
+#define portSUPPRESS_TICKS_AND_SLEEP(x) low_power_suppress_ticks_and_sleep(x)
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
 #define configUSE_PREEMPTION                    1U
-#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0U
-#define configUSE_TICKLESS_IDLE                 0U
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1U /* CLZ, at most 32 levels */
+#if BSP_POSIX
+#define configUSE_TICKLESS_IDLE 0U /* The host idles in the tick signal */
+#else
+#define configUSE_TICKLESS_IDLE 2U /* low_power.h */
+#endif
 #define configCPU_CLOCK_HZ                      (SystemCoreClock)
 #define configTICK_RATE_HZ                      ((TickType_t)1000U)
-#define configMAX_PRIORITIES                    (5U)
+#define configMAX_PRIORITIES                    (TASK_PRIORITY_LEVELS)
 #define configMINIMAL_STACK_SIZE                ((uint16_t)128U)
 #define configMAX_TASK_NAME_LEN                 (16U)
 #define configIDLE_SHOULD_YIELD                 1U
 #define configUSE_TASK_NOTIFICATIONS            1U
-#define configTASK_NOTIFICATION_ARRAY_ENTRIES   3U
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   4U
 #define configUSE_MUTEXES                       1U
 #define configUSE_RECURSIVE_MUTEXES             1U
 #define configUSE_COUNTING_SEMAPHORES           1U
@@ -35,7 +53,7 @@ extern uint32_t SystemCoreClock;
 #define configUSE_NEWLIB_REENTRANT              0U
 #define configENABLE_BACKWARD_COMPATIBILITY     0U
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5U
-#define configUSE_16_BIT_TICKS                  1U
+#define configTICK_TYPE_WIDTH_IN_BITS           TICK_TYPE_WIDTH_32_BITS
 #define configUSE_QUEUES                        1U
 
 /* Memory allocation related definitions. */
@@ -56,17 +74,66 @@ extern uint32_t SystemCoreClock;
 #define configUSE_DAEMON_TASK_STARTUP_HOOK 0U
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS        0U
+#define configGENERATE_RUN_TIME_STATS        1U /* Per-task CPU load (cpu_load.h) */
 #define configUSE_TRACE_FACILITY             1U /* Requirement: Track stack usage */
 #define configUSE_STATS_FORMATTING_FUNCTIONS 0U
 
+/* Run time is counted in core clock cycles on the DWT counter started by
+ * BSP_Init(), extended to 64 bits so it does not wrap */
+extern uint64_t BSP_CycleCounter_Read64(void);
+#define configRUN_TIME_COUNTER_TYPE uint64_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() BSP_CycleCounter_Read64()
+
+/* Event trace recorder (trace.h). The hooks expand inside tasks.c and
+ * queue.c, where the TCB and queue members they read are visible */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 0
+#endif
+#if TRACE_ENABLE
+#include "trace.h"
+#define TRACE_QUEUE_EVENT(event, context, queue)                    \
+    trace_record((uint8_t)(event), (uint8_t)(context),              \
+                 (uint16_t)(queue)->uxQueueNumber)
+#define traceTASK_SWITCHED_IN()                                     \
+    trace_record((uint8_t)TRACE_EVENT_TASK_SWITCH, 0U,              \
+                 (uint16_t)pxCurrentTCB->uxTCBNumber)
+#define traceISR_ENTER()                                            \
+    trace_record((uint8_t)TRACE_EVENT_ISR_ENTER, TRACE_ISR_TICK, 0U)
+#define traceISR_EXIT()                                             \
+    trace_record((uint8_t)TRACE_EVENT_ISR_EXIT, TRACE_ISR_TICK, 0U)
+#define traceISR_EXIT_TO_SCHEDULER() traceISR_EXIT()
+#define traceQUEUE_CREATE(pxNewQueue)                               \
+    ((pxNewQueue)->uxQueueNumber = (UBaseType_t)trace_queue_number())
+#define traceQUEUE_SEND(pxQueue)                                    \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_SEND, 0U, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)                           \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_SEND, 1U, pxQueue)
+#define traceQUEUE_SEND_FAILED(pxQueue)                             \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_SEND_FAILED, 0U, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue)                    \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_SEND_FAILED, 1U, pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)                                 \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_RECEIVE, 0U, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)                        \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_RECEIVE, 1U, pxQueue)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)                          \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_RECEIVE_FAILED, 0U, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue)                 \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_RECEIVE_FAILED, 1U, pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)                        \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_BLOCK, 1U, pxQueue)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)                     \
+    TRACE_QUEUE_EVENT(TRACE_EVENT_QUEUE_BLOCK, 0U, pxQueue)
+#endif
+
 /* Co-routine related definitions. */
 #define configUSE_CO_ROUTINES           0U
 #define configMAX_CO_ROUTINE_PRIORITIES (2U)
 
 /* Software timer related definitions. */
 #define configUSE_TIMERS             1U
-#define configTIMER_TASK_PRIORITY    (configMAX_PRIORITIES - 1U)
+#define configTIMER_TASK_PRIORITY    (TASK_PRIO_TIMER)
 #define configTIMER_QUEUE_LENGTH     10U
 #define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 2U)
 
@@ -93,6 +160,7 @@ extern uint32_t SystemCoreClock;
 #define INCLUDE_vTaskDelay                  1U
 #define INCLUDE_xTaskGetSchedulerState      1U
 #define INCLUDE_xTaskGetCurrentTaskHandle   1U
+#define INCLUDE_xSemaphoreGetMutexHolder    1U
 #define INCLUDE_uxTaskGetStackHighWaterMark 1U
 #define INCLUDE_xTaskGetIdleTaskHandle      1U
 #define INCLUDE_eTaskGetState               1U
@@ -101,9 +169,11 @@ extern uint32_t SystemCoreClock;
 #define INCLUDE_xTaskGetHandle              1U
 #define INCLUDE_xTaskResumeFromISR          1U
 
+#if !BSP_POSIX
 /* Cortex-M33 specific definitions */
 #define configENABLE_FPU       1U
 #define configENABLE_MPU       0U
 #define configENABLE_TRUSTZONE 0U
+#endif
 
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Round-Robin Archives
+ *
+ * Keeps the history a historian would otherwise poll for: the minimum,
+ * maximum and mean of every ADC1 channel per second over the last day, and
+ * per minute over the last 30 days, in two fixed-size circular archives on
+ * the SPI NOR flash (BSP_SPINOR) above the sample log (nor_log.h).
+ *
+ * The window statistics (adc_stats.h) hand over each 1 s bucket they close,
+ * in the units of their input registers, from the filter task; the second
+ * archive takes it as a record, and the minute archive folds it into the
+ * record of its PTP minute. Records collect in a RAM page per archive, and
+ * a full page is queued for the writer task (ArchWrite) without waiting,
+ * so the flash sees one page program every 6 s and every 6 min. A page
+ * that finds the queue full is dropped and counted in METRIC_ARCHIVE_LOST.
+ * Records still in RAM are not yet in the answer to a query.
+ *
+ * Each archive is a ring of sectors whose pages are numbered by a page
+ * sequence that counts up over the life of the archive; page n is held by
+ * page n modulo the ring, so a query finds any page without an index. The
+ * writer keeps the sector after the one being written erased, and erases
+ * the next, the oldest, in the background when the write position enters
+ * it; besides those two sectors the rings hold ADC_ARCHIVE_SECOND_RECORDS
+ * and ADC_ARCHIVE_MINUTE_RECORDS records. At start the writer finds the
+ * newest page from the first page of every sector.
+ *
+ * Page, little-endian:
+ *
+ *   Offset  Size  Field
+ *   0       4     Page sequence; 0xFFFFFFFF for an erased page
+ *   4       2     Magic, ADC_ARCHIVE_MAGIC ("JR")
+ *   6       1     Archive, adc_archive_id_t
+ *   7       1     Records in the page n, at most ADC_ARCHIVE_PAGE_RECORDS
+ *   8             Records, n of them
+ *   254     2     CRC-16/MODBUS of bytes 0-253
+ *
+ * A record is ADC_ARCHIVE_RECORD_SIZE bytes:
+ *
+ *   Offset  Size  Field
+ *   0       4     Start of the second or minute, s on the PTP timescale
+ *   4       12    Lowest filtered value of A0-A5, 0.1 mV
+ *   16      12    Highest filtered value of A0-A5, 0.1 mV
+ *   28      12    Mean of A0-A5, 0.1 mV
+ *
+ * Values saturate at 0 and 65535 as in the statistics registers. A second
+ * without samples has no record; a minute record exists for every minute
+ * with at least one second. Records follow the PTP time, so a step of the
+ * clock backwards makes them out of order until it is caught up, and a
+ * range query ends at the step.
+ *
+ * Queries run from any task but the TCP/IP thread with a wait, and from it
+ * without: the flash is shared with the sample log through its mutex, held
+ * for one page read at a time. A range is also readable as Modbus file
+ * ADC_ARCHIVE_FILE_NUMBER: an FC21 write of the query records runs it and
+ * an FC20 read returns its first ADC_ARCHIVE_FILE_MAX_RECORDS records, in
+ * records of one 16-bit word, high word first:
+ *
+ *   Query, written at record 0:
+ *
+ *   Record  Size  Field
+ *   0       1     Archive, adc_archive_id_t
+ *   1       2     First time, s
+ *   3       2     Last time, s
+ *   5       1     Reserved, 0
+ *
+ *   Result:
+ *
+ *   Record  Size  Field
+ *   0       1     Magic, ADC_ARCHIVE_FILE_MAGIC ("JR")
+ *   1       1     Format version, ADC_ARCHIVE_VERSION
+ *   2       1     Header size in records, ADC_ARCHIVE_HEADER_RECORDS
+ *   3       1     Record size in records, ADC_ARCHIVE_FILE_RECORD_SIZE
+ *   4       1     Records in the file, oldest first
+ *   5       1     Archive of the query
+ *   6       1     1 if more records of the range follow, else 0
+ *   7       1     Reserved, 0
+ *   8       20R   Records:
+ *                   +0   2  Start of the second or minute, s
+ *                   +2   6  Lowest values of A0-A5, 0.1 mV
+ *                   +8   6  Highest values of A0-A5, 0.1 mV
+ *                   +14  6  Means of A0-A5, 0.1 mV
+ *
+ * A client reads the rest of a range by writing the query again from the
+ * time after the last record. The query is shared by all Modbus clients.
+ * The HTTP server (http_server.h) streams a whole range as
+ * /api/archive.json.
+ *
+ * Built when ADC_ARCHIVE is 1 (CMake option JERRY_ADC_ARCHIVE), which needs
+ * BSP_SPINOR_ENABLE.
+ */
+
+#ifndef ADC_ARCHIVE_H
+#define ADC_ARCHIVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "modbus_types.h"
+
+#ifndef ADC_ARCHIVE
+#define ADC_ARCHIVE 0
+#endif
+
+#if ADC_ARCHIVE && !BSP_SPINOR_ENABLE
+#error "ADC_ARCHIVE needs BSP_SPINOR_ENABLE (JERRY_SPI_NOR)"
+#endif
+
+/** Channels of a record */
+#define ADC_ARCHIVE_CHANNELS BSP_ADC1_NUM_CHANNELS
+
+/** Records the second archive keeps, one day */
+#ifndef ADC_ARCHIVE_SECOND_RECORDS
+#define ADC_ARCHIVE_SECOND_RECORDS 86400U
+#endif
+
+/** Records the minute archive keeps, 30 days */
+#ifndef ADC_ARCHIVE_MINUTE_RECORDS
+#define ADC_ARCHIVE_MINUTE_RECORDS 43200U
+#endif
+
+/** Page magic: the bytes 'J', 'R' */
+#define ADC_ARCHIVE_MAGIC 0x524AU
+
+/** Page header size in bytes */
+#define ADC_ARCHIVE_PAGE_HEADER_SIZE 8U
+
+/** Offset of the CRC in a page */
+#define ADC_ARCHIVE_PAGE_CRC_OFFSET 254U
+
+/** Record size in bytes: the time and three values per channel */
+#define ADC_ARCHIVE_RECORD_SIZE (4U + (ADC_ARCHIVE_CHANNELS * 6U))
+
+/** Records per page */
+#define ADC_ARCHIVE_PAGE_RECORDS                                 \
+    ((ADC_ARCHIVE_PAGE_CRC_OFFSET - ADC_ARCHIVE_PAGE_HEADER_SIZE) / \
+     ADC_ARCHIVE_RECORD_SIZE)
+
+/** Pages per sector */
+#define ADC_ARCHIVE_SECTOR_PAGES (BSP_SPINOR_SECTOR_SIZE / BSP_SPINOR_PAGE_SIZE)
+
+/** Sectors of an archive of n records: those the records fill, the one
+ *  being written and the one kept erased */
+#define ADC_ARCHIVE_RING_SECTORS(n)                                  \
+    (((((n) + ADC_ARCHIVE_PAGE_RECORDS - 1U) /                       \
+       ADC_ARCHIVE_PAGE_RECORDS) + ADC_ARCHIVE_SECTOR_PAGES - 1U) / \
+         ADC_ARCHIVE_SECTOR_PAGES +                                  \
+     2U)
+
+/** Sectors at the top of the flash taken by the archives */
+#if ADC_ARCHIVE
+#define ADC_ARCHIVE_SECTORS                                  \
+    (ADC_ARCHIVE_RING_SECTORS(ADC_ARCHIVE_SECOND_RECORDS) + \
+     ADC_ARCHIVE_RING_SECTORS(ADC_ARCHIVE_MINUTE_RECORDS))
+#else
+#define ADC_ARCHIVE_SECTORS 0U
+#endif
+
+/** FC20/FC21 file number of the range query */
+#define ADC_ARCHIVE_FILE_NUMBER 7U
+
+/** File magic, "JR" */
+#define ADC_ARCHIVE_FILE_MAGIC 0x4A52U
+
+/** File format version */
+#define ADC_ARCHIVE_VERSION 1U
+
+/** File header size in records */
+#define ADC_ARCHIVE_HEADER_RECORDS 8U
+
+/** Query size in records */
+#define ADC_ARCHIVE_QUERY_RECORDS 6U
+
+/** Record size in file records */
+#define ADC_ARCHIVE_FILE_RECORD_SIZE (2U + (ADC_ARCHIVE_CHANNELS * 3U))
+
+/** Most records a query returns in the file, four pages */
+#define ADC_ARCHIVE_FILE_MAX_RECORDS (4U * ADC_ARCHIVE_PAGE_RECORDS)
+
+/** Returned by adc_archive_query_next() while the flash is busy */
+#define ADC_ARCHIVE_BUSY (-1)
+
+/**
+ * @brief Archives
+ */
+typedef enum
+{
+    ADC_ARCHIVE_SECONDS = 0, /**< One record per second */
+    ADC_ARCHIVE_MINUTES = 1, /**< One record per minute */
+    ADC_ARCHIVE_COUNT        /**< Number of archives */
+} adc_archive_id_t;
+
+/**
+ * @brief One record, as kept on the flash
+ */
+typedef struct
+{
+    uint32_t time_s;                     /**< Start, s on the PTP timescale */
+    uint16_t min[ADC_ARCHIVE_CHANNELS];  /**< Lowest values, 0.1 mV */
+    uint16_t max[ADC_ARCHIVE_CHANNELS];  /**< Highest values, 0.1 mV */
+    uint16_t mean[ADC_ARCHIVE_CHANNELS]; /**< Means, 0.1 mV */
+} adc_archive_record_t;
+
+/**
+ * @brief Position of a range query, kept by its caller
+ */
+typedef struct
+{
+    uint32_t from_s;  /**< First time not yet returned */
+    uint32_t to_s;    /**< Last time of the range */
+    uint32_t page;    /**< Page sequence read next, once located */
+    uint8_t  archive; /**< adc_archive_id_t */
+    bool     located; /**< @c page found */
+    bool     done;    /**< Range ended */
+} adc_archive_query_t;
+
+#if ADC_ARCHIVE
+
+/**
+ * @brief Take in a closed 1 s bucket of the window statistics
+ *
+ * Filter task only (adc_stats.h); never blocks. Does nothing until the
+ * archives are mounted.
+ *
+ * @param[in] record The second, stamped with its start
+ */
+void adc_archive_add_second(const adc_archive_record_t *record);
+
+/**
+ * @brief Start a range query
+ *
+ * @param[out] query   Query
+ * @param[in]  archive Archive
+ * @param[in]  from_s  First time, s
+ * @param[in]  to_s    Last time, s
+ */
+void adc_archive_query_init(adc_archive_query_t *query,
+                            adc_archive_id_t archive, uint32_t from_s,
+                            uint32_t to_s);
+
+/**
+ * @brief Read the next records of a range query, oldest first
+ *
+ * Reads pages until one holds records of the range, taking the flash
+ * mutex for each; a query whose pages were overwritten meanwhile goes on
+ * from the oldest page kept. Task context.
+ *
+ * @param[in,out] query   Query
+ * @param[out]    records At least ADC_ARCHIVE_PAGE_RECORDS records
+ * @param[in]     wait    Longest wait for the flash mutex, 0 to only try it
+ * @return Records read, 0 at the end of the range, or ADC_ARCHIVE_BUSY if
+ *         the mutex was not taken; the query then goes on where it was
+ */
+int32_t adc_archive_query_next(adc_archive_query_t  *query,
+                               adc_archive_record_t *records,
+                               TickType_t            wait);
+
+/**
+ * @brief Read records of the query result, its FC20 file reader
+ *
+ * @param[in]  file_number   ADC_ARCHIVE_FILE_NUMBER
+ * @param[in]  record_number First record
+ * @param[in]  record_length Number of records
+ * @param[out] values        Record values
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS unless all records lie in
+ *         the result
+ */
+modbus_exception_t adc_archive_read_file_record(uint16_t  file_number,
+                                                uint16_t  record_number,
+                                                uint16_t  record_length,
+                                                uint16_t *values);
+
+/**
+ * @brief Run a range query written to the file, its FC21 file writer
+ *
+ * Modbus tasks; waits for the flash.
+ *
+ * @param[in] file_number   ADC_ARCHIVE_FILE_NUMBER
+ * @param[in] record_number 0
+ * @param[in] record_length ADC_ARCHIVE_QUERY_RECORDS
+ * @param[in] values        Query
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS for other records,
+ *         MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE for an unknown archive or a
+ *         range ending before it starts, MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE
+ *         if the archives are not mounted
+ */
+modbus_exception_t adc_archive_write_file_record(uint16_t        file_number,
+                                                 uint16_t        record_number,
+                                                 uint16_t        record_length,
+                                                 const uint16_t *values);
+
+/**
+ * @brief Start the writer task
+ *
+ * Called once by the main task, after nor_log_start().
+ */
+void adc_archive_start(void);
+
+#endif /* ADC_ARCHIVE */
+
+#endif /* ADC_ARCHIVE_H */
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Triggered ADC Waveform Capture
+ *
+ * The capture job keeps the raw samples of all ADC1 channels of the last
+ * ADC_CAPTURE_MAX_SAMPLES sample periods in a history of its own. Once
+ * armed, it waits for the trigger and records the post-trigger samples;
+ * the pre-trigger samples before the trigger and the post-trigger samples
+ * from it on are then copied to the snapshot area and the capture stops.
+ * The snapshot stays frozen, and readable, until the capture is armed and
+ * triggered again.
+ *
+ * Trigger conditions are evaluated once per ring read of up to one ADC
+ * block: the block's minimum and maximum of the trigger channel, taken
+ * with CMSIS-DSP, tell whether the level was crossed in it, and only such
+ * a block is searched for the crossing sample. A digital input trigger
+ * falls on the sample its rising edge landed in on the sample timeline
+ * (bsp_adc1_sample_t::di_edges), the first captured at or after the edge,
+ * for an input selected for edge capture. Samples lost to ring overruns
+ * restart the history, and a capture that loses samples after its trigger
+ * is armed again.
+ *
+ * The snapshot is read with Modbus FC20 (Read File Record), over TCP or
+ * RTU, in records of one 16-bit word. A Modbus file holds 10000 records,
+ * so the snapshot spans ADC_CAPTURE_FILE_COUNT files from
+ * ADC_CAPTURE_FILE_NUMBER on: snapshot record r is record r % 10000 of
+ * file ADC_CAPTURE_FILE_NUMBER + r / 10000. 32- and 64-bit fields are
+ * stored high word first, as the 32-bit registers are:
+ *
+ *   Record  Size  Field
+ *   0       1     Magic, ADC_CAPTURE_MAGIC ("JC")
+ *   1       1     Format version, ADC_CAPTURE_VERSION
+ *   2       1     Header size in records, ADC_CAPTURE_HEADER_RECORDS
+ *   3       1     Channels per sample
+ *   4       2     Snapshot number, 1 for the first since boot
+ *   6       2     Sequence number of the first sample
+ *   8       2     Sequence number of the trigger sample
+ *   10      4     Timestamp of the trigger sample, 0 if unknown
+ *   14      1     Samples in the snapshot n
+ *   15      1     Pre-trigger samples, before the trigger sample
+ *   16      1     Trigger, adc_capture_trigger_t
+ *   17      1     Trigger input, ADC channel or digital input
+ *   18      1     Trigger level in mV
+ *   19      1     Sample rate in Hz
+ *   20      6n    Samples: right-aligned results of A0..A5, one record each
+ *
+ * Timestamps count BSP_ADC1_TIMESTAMP_HZ ticks since boot. Until the first
+ * snapshot the file has no records. A snapshot is only replaced by the
+ * trigger of a new capture, so a master that reads it between two arm
+ * commands reads one snapshot; the snapshot number tells it apart from the
+ * next.
+ */
+
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#include <stdint.h>
+
+#include "bsp.h"
+#include "modbus_types.h"
+
+/** Samples a snapshot holds at most, pre- and post-trigger together */
+#define ADC_CAPTURE_MAX_SAMPLES 2048U
+
+/** First file number of the snapshot for FC20 */
+#define ADC_CAPTURE_FILE_NUMBER 2U
+
+/** Records of one FC20 file */
+#define ADC_CAPTURE_FILE_RECORDS (MODBUS_FILE_MAX_RECORD + 1U)
+
+/** Snapshot magic: the bytes 'J', 'C' */
+#define ADC_CAPTURE_MAGIC 0x4A43U
+
+/** Snapshot format version */
+#define ADC_CAPTURE_VERSION 1U
+
+/** Snapshot header size in records */
+#define ADC_CAPTURE_HEADER_RECORDS 20U
+
+/** Records of one sample, one per ADC1 channel */
+#define ADC_CAPTURE_SAMPLE_RECORDS BSP_ADC1_NUM_CHANNELS
+
+/** Records of the largest snapshot */
+#define ADC_CAPTURE_MAX_RECORDS                              \
+    (ADC_CAPTURE_HEADER_RECORDS +                            \
+     (ADC_CAPTURE_MAX_SAMPLES * ADC_CAPTURE_SAMPLE_RECORDS))
+
+/** Files the largest snapshot spans */
+#define ADC_CAPTURE_FILE_COUNT                                   \
+    ((ADC_CAPTURE_MAX_RECORDS + ADC_CAPTURE_FILE_RECORDS - 1U) / \
+     ADC_CAPTURE_FILE_RECORDS)
+
+/** Highest trigger level in mV, the ADC reference */
+#define ADC_CAPTURE_MAX_LEVEL_MV 3300U
+
+/**
+ * @brief Trigger conditions
+ */
+typedef enum
+{
+    ADC_CAPTURE_TRIGGER_MANUAL    = 0, /**< Only ADC_CAPTURE_COMMAND_FORCE */
+    ADC_CAPTURE_TRIGGER_RISING    = 1, /**< ADC channel rises to the level */
+    ADC_CAPTURE_TRIGGER_FALLING   = 2, /**< ADC channel falls below it */
+    ADC_CAPTURE_TRIGGER_DI_RISING = 3, /**< Rising edge of a captured DI */
+    ADC_CAPTURE_TRIGGER_COUNT     = 4  /**< Number of trigger conditions */
+} adc_capture_trigger_t;
+
+/**
+ * @brief Capture commands
+ */
+typedef enum
+{
+    ADC_CAPTURE_COMMAND_STOP  = 0, /**< Stop waiting for a trigger */
+    ADC_CAPTURE_COMMAND_ARM   = 1, /**< Wait for the next trigger */
+    ADC_CAPTURE_COMMAND_FORCE = 2, /**< Arm if needed, trigger regardless */
+    ADC_CAPTURE_COMMAND_COUNT = 3  /**< Number of commands */
+} adc_capture_command_t;
+
+/**
+ * @brief Capture states
+ */
+typedef enum
+{
+    ADC_CAPTURE_STATE_IDLE      = 0, /**< Not armed, no snapshot yet */
+    ADC_CAPTURE_STATE_ARMED     = 1, /**< Waiting for the trigger */
+    ADC_CAPTURE_STATE_TRIGGERED = 2, /**< Recording post-trigger samples */
+    ADC_CAPTURE_STATE_READY     = 3  /**< Snapshot frozen, not armed */
+} adc_capture_state_t;
+
+/**
+ * @brief Capture configuration
+ *
+ * @c pre_samples plus @c post_samples is at most ADC_CAPTURE_MAX_SAMPLES;
+ * arming shortens the post-trigger part of a longer capture.
+ */
+typedef struct
+{
+    uint16_t trigger;      /**< Trigger condition, adc_capture_trigger_t */
+    uint16_t input;        /**< ADC channel (0-5) or digital input (0-7) */
+    uint16_t level_mv;     /**< Trigger level of the ADC channel, mV */
+    uint16_t pre_samples;  /**< Samples kept before the trigger */
+    uint16_t post_samples; /**< Samples recorded from the trigger on */
+} adc_capture_config_t;
+
+/**
+ * @brief Apply a new capture configuration
+ *
+ * Safe to call from any task. The capture job picks the configuration up
+ * within one frame of the cyclic executive; an armed capture waits for the
+ * new trigger, one recording its post-trigger samples is armed again. The snapshot is kept.
+ *
+ * @param[in] config New configuration (copied); NULL is ignored.
+ */
+void adc_capture_set_config(const adc_capture_config_t *config);
+
+/**
+ * @brief Run a capture command
+ *
+ * Safe to call from any task; the capture job runs the command within one
+ * frame. Arming keeps the snapshot until the next trigger.
+ *
+ * @param[in] command adc_capture_command_t; unknown commands are ignored.
+ */
+void adc_capture_command(uint16_t command);
+
+/**
+ * @brief Run the capture for one frame
+ *
+ * Cyclic executive only: applies what was set and, while armed, drains the
+ * ring.
+ */
+void adc_capture_job(void);
+
+/**
+ * @brief Get the capture state
+ *
+ * @return adc_capture_state_t
+ */
+adc_capture_state_t adc_capture_get_state(void);
+
+/**
+ * @brief Get the number of the frozen snapshot
+ *
+ * @return Snapshot number, 0 if there is none yet
+ */
+uint32_t adc_capture_get_snapshot(void);
+
+/**
+ * @brief Read records of the snapshot, the FC20 reader of its files
+ *
+ * @param[in]  file_number   ADC_CAPTURE_FILE_NUMBER and the files after it
+ * @param[in]  record_number First record in the file
+ * @param[in]  record_length Number of records
+ * @param[out] values        Record values
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS unless all records lie in
+ *         the snapshot
+ */
+modbus_exception_t adc_capture_read_file_record(uint16_t  file_number,
+                                                uint16_t  record_number,
+                                                uint16_t  record_length,
+                                                uint16_t *values);
+
+/**
+ * @brief Locate records of the snapshot, the FC20 mapper of its files
+ *
+ * The snapshot stays in place until the next trigger, which comes no
+ * sooner than the post-trigger samples after an arm command; the header
+ * snapshot number tells a client whether the records of two requests
+ * belong together.
+ *
+ * @param[in] file_number   ADC_CAPTURE_FILE_NUMBER and the files after it
+ * @param[in] record_number First record in the file
+ * @param[in] record_length Number of records
+ * @return The records, NULL unless all of them lie in the snapshot
+ */
+const uint16_t *adc_capture_map_file_record(uint16_t file_number,
+                                            uint16_t record_number,
+                                            uint16_t record_length);
+
+#endif /* ADC_CAPTURE_H */
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Change Detection
+ *
+ * After each filtered ADC1 block the filter task compares the value of
+ * every channel with the value last published for it, all channels in one
+ * CMSIS-DSP pass (arm_sub_f32(), arm_abs_f32()). A channel whose value
+ * moved by more than its deadband is published: its new value is kept and
+ * its change count goes up. A deadband of 0 publishes every block that
+ * changes the value at all.
+ *
+ * Consumers never hear about a change directly. Each keeps a cursor, the
+ * change counts it has seen, and adc_change_poll() returns the channels
+ * that changed since as a bitmap together with the published values; a
+ * consumer with nothing to do skips its work. Any number of consumers can
+ * poll, none of them resets what another one sees.
+ */
+
+#ifndef ADC_CHANGE_H
+#define ADC_CHANGE_H
+
+#include <stdint.h>
+
+#include "arm_math_types.h"
+#include "bsp.h"
+
+/** Channels watched, every ADC1 channel */
+#define ADC_CHANGE_CHANNELS BSP_ADC1_NUM_CHANNELS
+
+/** Bitmap of all channels */
+#define ADC_CHANGE_ALL_CHANNELS ((uint32_t)((1UL << ADC_CHANGE_CHANNELS) - 1U))
+
+/**
+ * @brief Change counts one consumer has seen
+ *
+ * Zero-initialize before the first poll.
+ */
+typedef struct
+{
+    uint32_t changes[ADC_CHANGE_CHANNELS]; /**< Change count per channel */
+} adc_change_cursor_t;
+
+/**
+ * @brief Set the deadband of a channel
+ *
+ * Safe to call from any task; the filter task compares against it from
+ * its next block on.
+ *
+ * @param[in] channel  Channel index, below ADC_CHANGE_CHANNELS.
+ * @param[in] deadband Change that is published, V; 0 = any change.
+ */
+void adc_change_set_deadband(uint8_t channel, float32_t deadband);
+
+/**
+ * @brief Compare a filtered block with the published values
+ *
+ * Filter task only (ADC1 block hook). Does nothing until the filters have
+ * settled.
+ *
+ * @param[in] values Last filtered value of every ADC1 channel, V
+ */
+void adc_change_process(const float32_t *values);
+
+/**
+ * @brief Get the channels that changed since the cursor was last polled
+ *
+ * Safe to call from any task.
+ *
+ * @param[in,out] cursor Change counts seen, updated to the current ones
+ * @param[out]    values Published value of every channel, V (NULL if not
+ *                       needed); ADC_CHANGE_CHANNELS entries
+ * @return Bitmap of the channels that changed, bit n = channel n
+ */
+uint32_t adc_change_poll(adc_change_cursor_t *cursor, float32_t *values);
+
+/**
+ * @brief Get the total change count of a set of channels
+ *
+ * The total goes up whenever one of the channels is published, so a
+ * consumer can tell whether it is still up to date by comparing two
+ * totals. Safe to call from any task.
+ *
+ * @param[in] mask Bitmap of the channels
+ * @return Sum of their change counts
+ */
+uint32_t adc_change_count(uint32_t mask);
+
+#endif /* ADC_CHANGE_H */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Window Statistics
+ *
+ * Keeps the minimum, maximum, mean and RMS of every ADC1 channel over the
+ * last second, the last 10 seconds and the last minute, from the decimated
+ * stream of filtered values (BSP_ADC1_STREAM_DECIMATED). The filter task
+ * drains the stream after each block (ADC1 block hook), so no task of its
+ * own is needed.
+ *
+ * No window is ever rescanned. Samples are summed into 100 ms buckets
+ * (count, sum, sum of squares, min, max); ten of them make up a 1 s bucket.
+ * A window is a run of buckets with running sums, from which the bucket
+ * that drops out is subtracted, and two monotonic deques of bucket slots
+ * whose fronts are the minimum and the maximum of the window:
+ *
+ *   Window  Buckets          Slides by
+ *   1 s     10 x 100 ms      100 ms
+ *   10 s    10 x 1 s         1 s
+ *   1 min   60 x 1 s         1 s
+ *
+ * A sample costs the same constant work whatever the window lengths; a
+ * closed bucket costs amortized constant work per window. The bucket
+ * boundaries follow the sample sequence numbers, so an acquisition gap
+ * leaves empty buckets and the windows keep their length in time. A gap
+ * longer than the minute window restarts all of them, and so does a change
+ * of the sample rate (BSP_ADC1_SetSampleRate), after which the buckets hold
+ * as many samples as 100 ms takes at the new rate.
+ *
+ * The RMS includes the mean. Figures are published every 100 ms, all
+ * channels and windows together; a window holding no sample reads 0.
+ * With the archives built (adc_archive.h), each 1 s bucket closed is also
+ * handed to them.
+ */
+
+#ifndef ADC_STATS_H
+#define ADC_STATS_H
+
+#include <stdint.h>
+
+#include "adc_filter_coefficients.h"
+#include "bsp.h"
+
+/** Channels kept, every ADC1 channel */
+#define ADC_STATS_CHANNELS BSP_ADC1_NUM_CHANNELS
+
+/** 100 ms buckets per second */
+#define ADC_STATS_TICKS_PER_SECOND 10U
+
+/** 1 s buckets kept, the length of the longest window */
+#define ADC_STATS_SECONDS 60U
+
+/**
+ * @brief Windows the statistics are kept over
+ */
+typedef enum
+{
+    ADC_STATS_WINDOW_1S = 0, /**< Last second */
+    ADC_STATS_WINDOW_10S,    /**< Last 10 seconds */
+    ADC_STATS_WINDOW_1MIN,   /**< Last minute */
+    ADC_STATS_WINDOW_COUNT   /**< Number of windows */
+} adc_stats_window_t;
+
+/**
+ * @brief Figures of one channel over one window, scaled for the input
+ * registers
+ *
+ * Values saturate at 0 and 65535.
+ */
+typedef struct
+{
+    uint16_t min;  /**< Lowest filtered value, 0.1 mV */
+    uint16_t max;  /**< Highest filtered value, 0.1 mV */
+    uint16_t mean; /**< Mean, 0.1 mV */
+    uint16_t rms;  /**< RMS, mean included, 0.1 mV */
+} adc_stats_result_t;
+
+/**
+ * @brief Take the new decimated samples into the statistics
+ *
+ * Filter task only (ADC1 block hook). Attaches its stream reader on the
+ * first call.
+ */
+void adc_stats_process(void);
+
+/**
+ * @brief Get the figures last published
+ *
+ * Safe to call from any task. All figures come from the same update.
+ *
+ * @param[out] results ADC_STATS_CHANNELS x ADC_STATS_WINDOW_COUNT entries,
+ *                     A0 first, windows of a channel in adc_stats_window_t
+ *                     order
+ * @return Number of updates since boot, 0 if none yet
+ */
+uint32_t adc_stats_get_results(
+    adc_stats_result_t results[ADC_STATS_CHANNELS][ADC_STATS_WINDOW_COUNT]);
+
+#endif /* ADC_STATS_H */
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Waveform Streaming over UDP
+ *
+ * The stream task drains the ADC1 sample ring and sends the samples as
+ * fixed-format UDP datagrams to one destination. Each datagram holds a
+ * 32-byte header followed by consecutive frames; all fields are
+ * little-endian.
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, ADC_STREAM_MAGIC ("JS")
+ *   2       1     Format version, ADC_STREAM_VERSION
+ *   3       1     Flags, ADC_STREAM_FLAG_*
+ *   4       1     Channel mask (bit 0 = A0)
+ *   5       1     Number of channels in the mask
+ *   6       2     Number of frames in the datagram
+ *   8       4     Datagram sequence number (1 per datagram sent)
+ *   12      4     Sample sequence number of the first frame
+ *   16      2     Sample sequence step between frames
+ *   18      2     Frame size in bytes
+ *   20      4     Samples lost on the device before the first frame
+ *                 (cumulative ring overruns and pbuf shortages)
+ *   24      8     Capture time of the first frame, BSP_ADC1_TIMESTAMP_HZ
+ *                 ticks (valid if ADC_STREAM_FLAG_TIME_VALID is set), or
+ *                 ns on the PTP timescale if ADC_STREAM_FLAG_TIME_PTP is
+ *                 also set
+ *
+ * A frame holds the raw 16-bit results of the masked channels in
+ * ascending channel order if ADC_STREAM_FLAG_RAW is set, followed by their
+ * 32-bit float filter outputs if ADC_STREAM_FLAG_FILTERED is set, then, if
+ * ADC_STREAM_FLAG_DI is set, a 16-bit word of the digital inputs captured
+ * for edge timing on the same timeline: their levels in the low byte and
+ * the inputs with an edge since the previous frame in the high byte, bit n
+ * for DIn (bsp_adc1_sample_t::di, ::di_edges). Frames in one datagram are
+ * consecutive samples; a gap in the sample sequence always starts a new
+ * datagram.
+ *
+ * If ADC_STREAM_FLAG_COMPRESSED is set the frames hold raw results only
+ * and are coded losslessly (sample_codec.h): the payload is a sequence of
+ * encoded blocks of ADC_STREAM_CODEC_BLOCK frames, the last one possibly
+ * shorter, of a codec state initialized for every datagram with the
+ * channels in the mask. The frame size field still gives the size of an
+ * uncoded frame. Only raw streams are compressed; a stream with filter
+ * outputs or inputs is sent uncoded whatever the configuration.
+ *
+ * tools/adc_stream_receiver.py is the matching receiver.
+ */
+
+#ifndef ADC_STREAM_TASK_H
+#define ADC_STREAM_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Datagram magic: the bytes 'J', 'S' */
+#define ADC_STREAM_MAGIC 0x534AU
+
+/** Datagram format version */
+#define ADC_STREAM_VERSION 1U
+
+/** Datagram header size in bytes */
+#define ADC_STREAM_HEADER_SIZE 32U
+
+/** Frames carry raw ADC results */
+#define ADC_STREAM_FLAG_RAW 0x01U
+
+/** Frames carry filter outputs */
+#define ADC_STREAM_FLAG_FILTERED 0x02U
+
+/** Frames come from the decimated stream */
+#define ADC_STREAM_FLAG_DECIMATED 0x04U
+
+/** The timestamp field is valid */
+#define ADC_STREAM_FLAG_TIME_VALID 0x08U
+
+/** The timestamp is PTP time in ns, common to all nodes of the master */
+#define ADC_STREAM_FLAG_TIME_PTP 0x10U
+
+/** Frames are coded with sample_codec.h */
+#define ADC_STREAM_FLAG_COMPRESSED 0x20U
+
+/** Samples are captured on whole trigger periods of PTP time, at the same
+ *  instants on every aligned node of the master (BSP_ADC1_SYNC) */
+#define ADC_STREAM_FLAG_TIME_ALIGNED 0x40U
+
+/** Frames end with the word of the captured digital inputs */
+#define ADC_STREAM_FLAG_DI 0x80U
+
+/** Frames per encoded block of a compressed datagram */
+#define ADC_STREAM_CODEC_BLOCK 32U
+
+/** Default destination UDP port */
+#define ADC_STREAM_DEFAULT_PORT 5005U
+
+/**
+ * @brief Stream configuration
+ *
+ * Streaming is active when @c enable is set and @c dest_addr, @c content and
+ * @c channel_mask are all non-zero.
+ */
+typedef struct
+{
+    bool     enable;       /**< Stream samples */
+    uint8_t  content;      /**< ADC_STREAM_FLAG_RAW, _FILTERED and/or _DI */
+    uint8_t  channel_mask; /**< Streamed channels (bit 0 = A0) */
+    bool     decimated;    /**< Stream the decimated instead of the full ring */
+    bool     compress;     /**< Code the frames of a raw-only stream */
+    uint32_t dest_addr;    /**< Destination IPv4 address, a.b.c.d as 0xaabbccdd */
+    uint16_t dest_port;    /**< Destination UDP port */
+} adc_stream_config_t;
+
+/**
+ * @brief Apply a new stream configuration
+ *
+ * Safe to call from any task. The stream task picks the configuration up
+ * within one poll period; a datagram still being filled is discarded.
+ *
+ * @param[in] config New configuration (copied); NULL is ignored.
+ */
+void adc_stream_set_config(const adc_stream_config_t *config);
+
+#endif /* ADC_STREAM_TASK_H */
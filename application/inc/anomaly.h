@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Spectral Anomaly Detection
+ *
+ * Scores every spectrum frame (spectrum.h) of every analysed channel with
+ * a small int8 model run on the CMSIS-NN kernels, so that a change in the
+ * shape or level of a signal raises an alarm on the device and only the
+ * alarm has to leave it.
+ *
+ * The features of a channel are the levels of ANOMALY_BANDS bands of its
+ * amplitude spectrum, half an octave wide except at the ends
+ * (anomaly_band_edges), and its AC RMS, in dB re 1 mV. They are quantized
+ * to int8 in steps of ANOMALY_FEATURE_STEP_DB around
+ * ANOMALY_FEATURE_ZERO_POINT, so the range runs from
+ * ANOMALY_FEATURE_FLOOR_DB up; lower levels read as the floor.
+ *
+ * The model of a channel is an autoencoder of two fully connected layers,
+ * ANOMALY_FEATURES to ANOMALY_HIDDEN to ANOMALY_FEATURES, trained on
+ * frames of normal operation: it reconstructs normal feature vectors well
+ * and others badly. The score of a frame is the RMS difference between
+ * the features and their reconstruction, in 0.01 dB. The models are
+ * generated into anomaly_model.c by tools/anomaly_train.py; the untrained
+ * default reconstructs every frame as the floor, so its score is just the
+ * distance of the features from it.
+ *
+ * A channel raises its alarm once its score has been above the threshold
+ * for a number of consecutive frames, and clears it once it has been at or
+ * below it for as many. A threshold of 0 turns the alarms off and clears
+ * them. Every raised and cleared alarm is logged, and the alarm register
+ * is what a Modbus Report by Exception subscription (modbus_rbe.h) sends
+ * upstream: one update per change instead of a stream of figures.
+ *
+ * The model runs in the spectrum analysis task, from its frame hook, on
+ * statically allocated tensors. It is built when ANOMALY_DETECT is 1 (CMake
+ * option JERRY_ANOMALY), together with the CMSIS-NN kernels it needs;
+ * without it the configuration is kept and the status reads all zero.
+ */
+
+#ifndef ANOMALY_H
+#define ANOMALY_H
+
+#include <stdint.h>
+
+#include "bsp.h"
+#include "spectrum.h"
+
+#ifndef ANOMALY_DETECT
+#define ANOMALY_DETECT 0
+#endif
+
+/** Spectrum bands in the features */
+#define ANOMALY_BANDS 16U
+
+/** Features per channel: the bands, then the AC RMS */
+#define ANOMALY_FEATURES (ANOMALY_BANDS + 1U)
+
+/** Units of the hidden layer of a model */
+#define ANOMALY_HIDDEN 8U
+
+/** Feature quantization step (dB) */
+#define ANOMALY_FEATURE_STEP_DB 0.5f
+
+/** Quantized value of a level of 0 dB re 1 mV */
+#define ANOMALY_FEATURE_ZERO_POINT (-88)
+
+/** Lowest feature level, quantized to -128 (dB re 1 mV) */
+#define ANOMALY_FEATURE_FLOOR_DB \
+    ((float)(-128 - ANOMALY_FEATURE_ZERO_POINT) * ANOMALY_FEATURE_STEP_DB)
+
+/** Frames over or under the threshold before an alarm changes, default */
+#define ANOMALY_DEFAULT_HOLD_FRAMES 3U
+
+/** Highest hold */
+#define ANOMALY_MAX_HOLD_FRAMES 100U
+
+/**
+ * @brief One fully connected int8 layer, as arm_fully_connected_s8() takes
+ * it
+ *
+ * The output is requantized with @c multiplier and @c shift (TensorFlow
+ * Lite per-tensor scheme) and offset by the output zero point.
+ */
+typedef struct
+{
+    const int8_t  *weights;       /**< Output-major, outputs x inputs */
+    const int32_t *bias;          /**< One per output */
+    int32_t        input_offset;  /**< Minus the input zero point */
+    int32_t        output_offset; /**< Output zero point */
+    int32_t        multiplier;    /**< Requantization multiplier, Q31 */
+    int32_t        shift;         /**< Requantization shift, left if > 0 */
+} anomaly_layer_t;
+
+/**
+ * @brief Autoencoder of one channel
+ *
+ * The input and the output are features quantized as above.
+ */
+typedef struct
+{
+    anomaly_layer_t encoder; /**< ANOMALY_FEATURES to ANOMALY_HIDDEN */
+    anomaly_layer_t decoder; /**< ANOMALY_HIDDEN to ANOMALY_FEATURES */
+} anomaly_model_t;
+
+/**
+ * @brief Alarm configuration
+ */
+typedef struct
+{
+    uint16_t threshold;   /**< Score that alarms, 0.01 dB; 0 = alarms off */
+    uint16_t hold_frames; /**< Frames before an alarm changes, at least 1 */
+} anomaly_config_t;
+
+/**
+ * @brief Scores and alarms of the last frame
+ */
+typedef struct
+{
+    uint32_t frame;  /**< Spectrum frame scored, 0 if none yet */
+    uint32_t events; /**< Alarms raised since boot */
+    uint16_t alarms; /**< Alarms active, bit n for A<n> */
+    uint16_t score[BSP_ADC1_NUM_CHANNELS]; /**< Score, 0.01 dB; 0 if the
+                                                channel is not analysed */
+} anomaly_status_t;
+
+/** First FFT bin of each band, and the end of the last one */
+extern const uint16_t anomaly_band_edges[ANOMALY_BANDS + 1U];
+
+/** Models of A0 first, in anomaly_model.c */
+extern const anomaly_model_t anomaly_models[BSP_ADC1_NUM_CHANNELS];
+
+/**
+ * @brief Apply a new alarm configuration
+ *
+ * Safe to call from any task; takes effect with the next frame.
+ *
+ * @param[in] config New configuration (copied); NULL is ignored and a hold
+ *                   of 0 is taken as 1
+ */
+void anomaly_set_config(const anomaly_config_t *config);
+
+/**
+ * @brief Get the scores and alarms of the last frame
+ *
+ * Safe to call from any task. All fields come from the same frame.
+ *
+ * @param[out] status Scores and alarms
+ */
+void anomaly_get_status(anomaly_status_t *status);
+
+/**
+ * @brief Score a spectrum frame, the spectrum frame hook
+ *
+ * Spectrum analysis task only; see spectrum_frame_hook_t. Built with
+ * ANOMALY_DETECT only.
+ *
+ * @param[in] channels Channels analysed, bit n for A<n>
+ * @param[in] bins     Amplitude spectrum in 0.1 mV, SPECTRUM_BINS per
+ *                     channel, A0 first
+ * @param[in] results  Figures of the frame, BSP_ADC1_NUM_CHANNELS entries
+ */
+void anomaly_process(uint16_t channels, const uint16_t *bins,
+                     const spectrum_result_t *results);
+
+#endif /* ANOMALY_H */
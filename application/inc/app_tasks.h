@@ -11,6 +11,13 @@ void vLoggingTask(void* pvParameters);
 void vModbusTask(void* pvParameters);
 void vFotaTask(void* pvParameters);
 void vMonitorTask(void* pvParameters);
-void vTcpEchoTask(void* pvParameters);
+void vNetworkTask(void* pvParameters);
+void vAdcStreamTask(void* pvParameters);
+void vCyclicTask(void* pvParameters);
+void vUsbLogTask(void* pvParameters);
+void vUsbWriteTask(void* pvParameters);
+void vSpectrumTask(void* pvParameters);
+void vPtpTask(void* pvParameters);
+void vDoScheduleTask(void* pvParameters);
 
 #endif /* APP_TASKS_H */
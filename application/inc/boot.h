@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Boot Sequencing and Profile
+ *
+ * Tasks that depend on another part of the bring-up wait for its event
+ * instead of sleeping a fixed time: the network tasks for the interface,
+ * non-critical peripherals (USB) for the Modbus service. Each event is
+ * timestamped the first time it is set, and together with the stages
+ * marked by boot_mark() forms the boot profile, printed once the service
+ * is up.
+ *
+ * Times are cycle counter readings (BSP_CycleCounter_Read()), which starts
+ * in BSP_Init() once the system clock is configured; the few milliseconds
+ * before are not counted.
+ */
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** TCP/IP thread running, netconns can be created */
+#define BOOT_EVENT_NET_STACK (1UL << 0)
+/** Network interface added and up, netconns can be bound */
+#define BOOT_EVENT_NETIF_UP (1UL << 1)
+/** Ethernet link up, cleared while the link is down */
+#define BOOT_EVENT_LINK_UP (1UL << 2)
+/** Modbus TCP server listening, the control path is up */
+#define BOOT_EVENT_SERVICE_UP (1UL << 3)
+/** Saved registers restored, the configuration they hold is in effect */
+#define BOOT_EVENT_CONFIG (1UL << 4)
+
+/** Timeout of boot_wait() that never expires */
+#define BOOT_WAIT_FOREVER UINT32_MAX
+
+/** Time to service the boot profile is checked against, in ms */
+#define BOOT_SERVICE_TARGET_MS 500U
+
+/** Stages the profile holds; later marks are dropped */
+#define BOOT_MAX_STAGES 16U
+
+/**
+ * @brief Create the event group
+ *
+ * Called from main() before any task is created.
+ */
+void boot_init(void);
+
+/**
+ * @brief Timestamp a boot stage
+ *
+ * @param stage Name of the stage, a string literal (the pointer is kept).
+ *
+ * Callable from any context, also before the scheduler starts.
+ */
+void boot_mark(const char *stage);
+
+/**
+ * @brief Set boot events, timestamping the first setting of each
+ *
+ * @param events BOOT_EVENT_* bits.
+ *
+ * Task context only.
+ */
+void boot_event_set(uint32_t events);
+
+/**
+ * @brief Clear boot events
+ *
+ * @param events BOOT_EVENT_* bits.
+ *
+ * Task context only.
+ */
+void boot_event_clear(uint32_t events);
+
+/**
+ * @brief Wait until all of the given events are set
+ *
+ * @param events     BOOT_EVENT_* bits.
+ * @param timeout_ms Longest wait, or BOOT_WAIT_FOREVER.
+ * @return true if all events are set, false on timeout.
+ *
+ * Task context only.
+ */
+bool boot_wait(uint32_t events, uint32_t timeout_ms);
+
+/**
+ * @brief Print the stages timestamped so far
+ *
+ * Task context only.
+ */
+void boot_profile_print(void);
+
+#endif /* BOOT_H */
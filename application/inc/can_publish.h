@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Sample Publishing over CAN FD
+ *
+ * The CAN publish job drains the ADC1 sample ring and sends the filtered
+ * values of A0..A3 in 64-byte CAN FD frames with bit rate switching, all
+ * with identifier CAN_PUBLISH_ID. A frame starts at every sample whose
+ * sequence number is a multiple of the frame period, the ADC1 sample rate
+ * / rate samples (rounded down, at the rate in force when the port is
+ * configured), and takes up to CAN_PUBLISH_MAX_SAMPLES samples of it,
+ * evenly spaced. All fields are little-endian.
+ *
+ *   Offset  Size  Field
+ *   0       4     Sample sequence number of the first sample
+ *   4       2     Sample sequence step between samples
+ *   6       1     Number of samples n
+ *   7       1     Debounced digital inputs when the frame was started
+ *                 (bit n = DIn)
+ *   8       8n    Samples: A0, A1, A2 and A3 filter outputs in mV (int16
+ *                 each, saturated)
+ *   8+8n    ...   Zero
+ *
+ * Samples lost to ring overruns drop the frame they fall in. The layout is
+ * also the "can" section of config/jerry_registers.json, from which the
+ * code generator writes a DBC file of the message.
+ */
+
+#ifndef CAN_PUBLISH_H
+#define CAN_PUBLISH_H
+
+#include <stdint.h>
+
+/** Identifier of the sample frames */
+#define CAN_PUBLISH_ID 0x100U
+
+/** Channels in a sample, A0..A3 */
+#define CAN_PUBLISH_CHANNELS 4U
+
+/** Frame header size in bytes */
+#define CAN_PUBLISH_HEADER_SIZE 8U
+
+/** Samples that fit one frame */
+#define CAN_PUBLISH_MAX_SAMPLES 7U
+
+/** Highest frame rate in Hz */
+#define CAN_PUBLISH_MAX_RATE_HZ 1000U
+
+/**
+ * @brief Publish configuration
+ *
+ * The port runs while @c rate_hz is non-zero.
+ */
+typedef struct
+{
+    uint16_t rate_hz;      /**< Frames per second, 0 = off */
+    uint16_t nominal_kbps; /**< Arbitration bit rate, kbit/s */
+    uint16_t data_kbps;    /**< Data phase bit rate, kbit/s */
+} can_publish_config_t;
+
+/**
+ * @brief Apply a new publish configuration
+ *
+ * Safe to call from any task. The publish job picks the configuration up
+ * within one frame of the cyclic executive; a new bit rate restarts the
+ * port and drops the frames still queued.
+ *
+ * @param[in] config New configuration (copied); NULL is ignored.
+ */
+void can_publish_set_config(const can_publish_config_t *config);
+
+/**
+ * @brief Run the publishing for one frame
+ *
+ * Cyclic executive only: applies what was set and, while publishing,
+ * drains the ring.
+ */
+void can_publish_job(void);
+
+#endif /* CAN_PUBLISH_H */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Clock Scaling
+ *
+ * Runs the system clock in the BSP profile the workload needs
+ * (BSP_CLOCK): full while a timer-driven job runs or the network is busy,
+ * idle otherwise, so a node that only answers a slow poll spends most of
+ * its time at a quarter of the clock.
+ *
+ * A timer of the timer service task, above everything that can load the
+ * core, looks at the load every CLOCK_SCALING_PERIOD_MS:
+ *
+ *   - the acquisitions, PWM outputs, input capture and timed sleeps of the
+ *     BSP (BSP_Clock_IdleAllowed()), which start in the full profile
+ *     whatever the period, and
+ *   - the Ethernet frames received and sent over the period (lwIP link
+ *     statistics), against CLOCK_SCALING_BUSY_FRAMES.
+ *
+ * Demand raises the clock at once; the idle profile is only entered after
+ * CLOCK_SCALING_IDLE_HOLD_MS without any, so a burst of requests does not
+ * switch back and forth. The time spent in each profile is counted for
+ * the monitor task.
+ */
+
+#ifndef CLOCK_SCALING_H
+#define CLOCK_SCALING_H
+
+#include <stdint.h>
+
+#include "bsp.h"
+
+/** Scale the system clock to the workload (CMake JERRY_CLOCK_SCALING) */
+#ifndef CLOCK_SCALING
+#define CLOCK_SCALING 0
+#endif
+
+/** Evaluation period */
+#ifndef CLOCK_SCALING_PERIOD_MS
+#define CLOCK_SCALING_PERIOD_MS 250U
+#endif
+
+/** Ethernet frames per period, received and sent, that need the full
+ *  profile; a 1 Hz Modbus poll is about 3 per second */
+#ifndef CLOCK_SCALING_BUSY_FRAMES
+#define CLOCK_SCALING_BUSY_FRAMES 10U
+#endif
+
+/** Time without demand before the idle profile is entered */
+#ifndef CLOCK_SCALING_IDLE_HOLD_MS
+#define CLOCK_SCALING_IDLE_HOLD_MS 5000U
+#endif
+
+/**
+ * @brief Time spent in the clock profiles
+ */
+typedef struct
+{
+    uint32_t switches[BSP_CLOCK_PROFILE_COUNT]; /**< Switches into each */
+    uint64_t time_ms[BSP_CLOCK_PROFILE_COUNT];  /**< Time run in each */
+    uint32_t vetoes; /**< Idle profile refused by the BSP */
+} clock_scaling_stats_t;
+
+/**
+ * @brief Start evaluating the workload
+ *
+ * Called once from a task; the clock stays in the full profile until the
+ * first idle hold time has passed.
+ */
+void clock_scaling_start(void);
+
+/**
+ * @brief Copy the profile statistics
+ *
+ * @param[out] stats Destination
+ */
+void clock_scaling_get_stats(clock_scaling_stats_t *stats);
+
+/**
+ * @brief Print the profile statistics
+ */
+void clock_scaling_print(void);
+
+#endif /* CLOCK_SCALING_H */
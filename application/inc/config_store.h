@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Configuration Store
+ *
+ * Keeps the holding registers marked "persistent" in jerry_registers.json
+ * (PWM, ADC calibration, filter bank) across resets, in the two
+ * configuration sectors of the flash (BSP_FLASH_CONFIG_SECTORS, the last
+ * sector of each bank). The store is a log: a changed register is appended
+ * as a new record after the last one and the newest record of a register
+ * wins, so a write costs one quad-word program and no erase. Only when the
+ * active sector is full are the current values copied to the other sector,
+ * which is erased first, and only then does that sector become active; the
+ * two sectors wear evenly, one erase each per roughly 490 writes.
+ *
+ * A record is one quad-word, the unit the flash programs and covers with
+ * its ECC, little-endian:
+ *
+ *   Offset  Size  Field
+ *   0       2     Key: address of the register
+ *   2       2     Registers in the value (1 to 4)
+ *   4       8     Value, the register words in address order, unused ones
+ *                 0xFFFF
+ *   12      4     Check over bytes 0-11
+ *
+ * The first quad-word of a sector is its header: CONFIG_STORE_MAGIC, the
+ * generation, CONFIG_STORE_VERSION and the check over the three. A
+ * compaction writes the header after every record, so a sector without a
+ * valid header is never read, and the sector with the higher generation is
+ * the active one. A record cut short by a reset fails its check and is
+ * skipped. Such a quad-word, or a header cut short, usually fails its ECC
+ * check too, so the sectors are only read through BSP_Flash_Read(), which
+ * reports it instead of faulting; a record of a register no longer persistent, or of another
+ * size, is skipped too and dropped by the next compaction.
+ *
+ * Writes never wait for the flash. The Modbus write callbacks hand every
+ * block stored to config_store_note(), which compares the persistent
+ * registers in it with the values last saved and flags the ones changed.
+ * The store task (Config) then waits CONFIG_STORE_COMMIT_DELAY_MS, so that
+ * a burst of writes, such as a calibration run, takes one commit, and
+ * appends one record per flagged register.
+ *
+ * At boot config_store_start() reads the active sector (512 quad-words of
+ * memory-mapped flash, well under a millisecond) and writes the values back
+ * through the Modbus write callback, so they are range checked and applied
+ * to the outputs exactly as a client write would be.
+ *
+ * The persistent registers are also file CONFIG_STORE_FILE_NUMBER, so that
+ * a tool saves or loads the whole configuration with one FC20 or FC21
+ * request instead of one register block each. In records of one 16-bit
+ * word:
+ *
+ *   Record  Size  Field
+ *   0       1     CONFIG_STORE_FILE_VERSION
+ *   1       1     Header records (CONFIG_STORE_FILE_HEADER_RECORDS)
+ *   2       1     Entries, JERRY_DEVICE_PERSISTENT_COUNT
+ *   3       1     Records per entry (CONFIG_STORE_FILE_ENTRY_RECORDS)
+ *   4 + 6n  6     Entry n: register address, registers (1 to 4) and the
+ *                 value, the register words in address order, unused ones
+ *                 0xFFFF
+ *
+ * A write covers whole entries and gives each the address and count it
+ * reads with; the values go through the Modbus write callback like any
+ * other write, and are saved by the next commit. The header is read-only.
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "modbus_types.h"
+
+/** Sector header magic: the bytes 'J', 'C', 'F', 'G' */
+#define CONFIG_STORE_MAGIC 0x4746434AU
+
+/** Record and header format version */
+#define CONFIG_STORE_VERSION 1U
+
+/** Delay from the first change to its commit */
+#define CONFIG_STORE_COMMIT_DELAY_MS 1000U
+
+/** Delay before a failed commit is tried again */
+#define CONFIG_STORE_RETRY_MS 10000U
+
+/** FC20/FC21 file number of the persistent registers */
+#define CONFIG_STORE_FILE_NUMBER 6U
+
+/** Format version of the file */
+#define CONFIG_STORE_FILE_VERSION 1U
+
+/** Records of the file header */
+#define CONFIG_STORE_FILE_HEADER_RECORDS 4U
+
+/** Records of one entry of the file */
+#define CONFIG_STORE_FILE_ENTRY_RECORDS 6U
+
+/**
+ * @brief Figures of the store
+ */
+typedef struct
+{
+    uint32_t sector;      /**< Active sector, BSP_FLASH_CONFIG_SECTORS: none */
+    uint32_t generation;  /**< Generation of the active sector */
+    uint32_t used;        /**< Bytes of the active sector written */
+    uint32_t restored;    /**< Registers restored at boot */
+    uint32_t restore_us;  /**< Time taken by the restore */
+    uint32_t commits;     /**< Commits made */
+    uint32_t records;     /**< Records appended */
+    uint32_t compactions; /**< Sectors rewritten */
+    uint32_t failures;    /**< Commits failed */
+} config_store_stats_t;
+
+/**
+ * @brief Restore the saved registers and start the store task
+ *
+ * Called once by the Modbus task, after jerry_device_registers_init() and
+ * before any other task writes registers.
+ */
+void config_store_start(void);
+
+/**
+ * @brief Flag the persistent registers of a stored block that changed
+ *
+ * Called by the holding register write callbacks once the block is
+ * published, with the register writers serialized. Never waits for the
+ * flash.
+ *
+ * @param[in] start_address First register address of the block
+ * @param[in] quantity      Number of registers in the block
+ */
+void config_store_note(uint16_t start_address, uint16_t quantity);
+
+/**
+ * @brief Copy the records of the values not in the flash yet
+ *
+ * For the power-fail snapshot (power_fail.h): the records of the commit in
+ * flight, then those of the flagged registers, in the format of the flash
+ * log. Callable above the kernel's interrupt mask: an entry or a batch
+ * caught in the middle of an update, its sequence count odd or changed
+ * across the copy, is left out, and a register being written meanwhile may
+ * be taken with its old value.
+ *
+ * @param[out] records     Receives the records
+ * @param[in]  max_records Records @p records holds
+ * @return Records copied
+ */
+uint32_t config_store_pending(uint32_t (*records)[4], uint32_t max_records);
+
+/**
+ * @brief Write back records taken by config_store_pending() before a reset
+ *
+ * Modbus task, after config_store_start() and before any other task writes
+ * registers. Records failing their check are skipped; the others go
+ * through the Modbus write callback and are saved by the next commit.
+ *
+ * @param[in] records Records
+ * @param[in] count   Number of records
+ * @return Records applied
+ */
+uint32_t config_store_apply(const uint32_t (*records)[4], uint32_t count);
+
+/**
+ * @brief Read records of the configuration file, its FC20 file reader
+ *
+ * @param[in]  file_number   CONFIG_STORE_FILE_NUMBER
+ * @param[in]  record_number First record
+ * @param[in]  record_length Number of records
+ * @param[out] values        Record values
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS unless all records lie in
+ *         the file
+ */
+modbus_exception_t config_store_read_file_record(uint16_t  file_number,
+                                                 uint16_t  record_number,
+                                                 uint16_t  record_length,
+                                                 uint16_t *values);
+
+/**
+ * @brief Write entries of the configuration file, its FC21 file writer
+ *
+ * Modbus task, with the register writers serialized. The entries are
+ * checked before any is written; entries written before one the callback
+ * rejects stay applied.
+ *
+ * @param[in] file_number   CONFIG_STORE_FILE_NUMBER
+ * @param[in] record_number First record, the start of an entry
+ * @param[in] record_length Number of records, whole entries
+ * @param[in] values        Record values
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS unless the records are
+ *         whole entries of the file, MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE
+ *         for an entry of another address or count, or the exception of
+ *         the write callback
+ */
+modbus_exception_t config_store_write_file_record(uint16_t        file_number,
+                                                  uint16_t        record_number,
+                                                  uint16_t        record_length,
+                                                  const uint16_t *values);
+
+/**
+ * @brief Read the figures of the store
+ *
+ * @param[out] stats Receives the figures
+ */
+void config_store_get_stats(config_store_stats_t *stats);
+
+/**
+ * @brief Print the figures of the store
+ *
+ * Monitor task, part of its snapshot.
+ */
+void config_store_print(void);
+
+#endif /* CONFIG_STORE_H */
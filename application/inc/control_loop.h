@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Closed-Loop Control
+ *
+ * PID loops that regulate the duty cycle of a PWM output on a filtered
+ * ADC channel. The loops run in the ADC1 filter task right after each
+ * block is filtered (BSP_ADC1_SetBlockHook()), so a loop closes at the
+ * block rate, CONTROL_LOOP_RATE_HZ, with no task switch or network in the
+ * path. BSP_PWM_SetDuty() preloads the result, which reaches the pin at
+ * the next PWM period boundary.
+ *
+ * The PID is the incremental CMSIS-DSP arm_pid_f32(). Its output is
+ * clamped to the loop's duty range and fed back as the previous output,
+ * so the integral cannot wind up past the limits, and a gain change does
+ * not step the output. A loop only sets the duty cycle: the enable coil
+ * and the frequency of the PWM output still come from Modbus.
+ */
+
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "adc_filter_coefficients.h"
+#include "arm_math_types.h"
+#include "bsp.h"
+
+/** Number of control loops */
+#define CONTROL_LOOP_COUNT 4U
+
+/** Rate at which every loop runs, one step per filtered ADC1 block */
+#define CONTROL_LOOP_RATE_HZ \
+    ((float32_t)ADC_FILTER_SAMPLE_RATE / (float32_t)BSP_ADC1_BLOCK_SAMPLES)
+
+/**
+ * @brief Configuration of one loop
+ *
+ * The output is in duty cycle units of 0.01 % (BSP_PWM_DUTY_MAX = 100 %),
+ * the error in volts. Negative gains make a reverse-acting loop.
+ */
+typedef struct
+{
+    bool      enable;     /**< Run the loop */
+    uint8_t   input;      /**< ADC1 channel of the process variable */
+    uint8_t   output;     /**< PWM channel driven */
+    float32_t setpoint;   /**< Setpoint, V */
+    float32_t kp;         /**< Proportional gain, 0.01 % per V */
+    float32_t ki;         /**< Integral gain, 0.01 % per V and second */
+    float32_t kd;         /**< Derivative gain, 0.01 % per V/s */
+    uint16_t  output_min; /**< Lowest duty cycle */
+    uint16_t  output_max; /**< Highest duty cycle */
+    uint16_t  start_duty; /**< Duty cycle the loop starts from */
+} control_loop_config_t;
+
+/**
+ * @brief Run one step of every enabled loop
+ *
+ * Filter task only, from the ADC1 block hook; every loop starts disabled.
+ *
+ * @param[in] values Last filtered value of every ADC1 channel, V
+ */
+void control_loop_step(const float32_t *values);
+
+/**
+ * @brief Apply a new configuration to a loop
+ *
+ * Safe to call from any task. The filter task picks the configuration up
+ * before its next loop step. A loop that is enabled, or moved to another
+ * input or output, restarts from @c start_duty; other changes keep its
+ * output.
+ *
+ * @param[in] loop   Loop index, below CONTROL_LOOP_COUNT.
+ * @param[in] config New configuration (copied); NULL or an out-of-range
+ *                   input, output or duty range is ignored.
+ */
+void control_loop_set_config(uint8_t loop, const control_loop_config_t *config);
+
+#endif /* CONTROL_LOOP_H */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * CPU Load Accounting
+ *
+ * Turns the FreeRTOS run-time statistics, counted in core clock cycles on
+ * the DWT counter, into the CPU load of each task over the last
+ * measurement window. The load of the accounted interrupt handlers
+ * (bsp_isr_t) is reported beside it; FreeRTOS charges that time to
+ * whichever task the interrupt preempted, so it is also part of the task
+ * figures. Loads are in hundredths of a percent.
+ *
+ * The monitor task closes a window with every metrics snapshot (by default
+ * every MONITOR_SNAPSHOT_PERIOD_MS). The last window is printed with the
+ * snapshot and served as Modbus diagnostic registers (modbus_diag.h).
+ */
+
+#ifndef CPU_LOAD_H
+#define CPU_LOAD_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+
+/** Tasks that can be accounted; further tasks are left out */
+#define CPU_LOAD_MAX_TASKS 16U
+
+/**
+ * @brief Load and stack headroom of one task
+ */
+typedef struct
+{
+    char     name[configMAX_TASK_NAME_LEN]; /**< Task name, NUL padded */
+    uint16_t load;                          /**< 0.01 % of the window */
+    uint16_t stack_free;                    /**< Stack left, words */
+} cpu_load_task_t;
+
+/**
+ * @brief Loads of one measurement window
+ */
+typedef struct
+{
+    uint16_t        total;              /**< Load of all but the idle task */
+    uint16_t        isr[BSP_ISR_COUNT]; /**< Load of each interrupt handler */
+    uint16_t        task_count;         /**< Entries of tasks[] in use */
+    cpu_load_task_t tasks[CPU_LOAD_MAX_TASKS];
+} cpu_load_snapshot_t;
+
+/**
+ * @brief Close the measurement window and start the next one
+ *
+ * The first call only starts a window. Task context only.
+ */
+void cpu_load_update(void);
+
+/**
+ * @brief Copy the loads of the last window
+ *
+ * @param[out] snapshot Destination, zeroed before the first full window
+ */
+void cpu_load_get(cpu_load_snapshot_t *snapshot);
+
+/**
+ * @brief Print the loads of the last window
+ */
+void cpu_load_print(void);
+
+#endif /* CPU_LOAD_H */
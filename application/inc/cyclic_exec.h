@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Cyclic Executive
+ *
+ * The periodic jobs that drain the ADC1 sample ring without blocking run
+ * one after the other in a single task (Cyclic) instead of a task each,
+ * from a static table. Time is counted in frames of one ADC1 block
+ * (BSP_ADC1_BLOCK_SAMPLES samples, 3.2 ms at 10 kHz): the block hook
+ * releases a frame with cyclic_exec_release() once the block is in the
+ * rings, so the frames follow the TIM1 trigger of the acquisition rather
+ * than the kernel tick. While the acquisition is stopped a frame is
+ * released every CYCLIC_IDLE_FRAME_MS instead, so the jobs still see their
+ * configuration changes.
+ *
+ * Each job runs every period frames at a fixed phase, in table order:
+ *
+ *   Job           Period  Phase  Work
+ *   AdcCapture    1       0      history and trigger of the capture
+ *   CanPub        1       0      CAN FD sample frames
+ *   SpecCollect   2       1      raw samples of the spectrum frame
+ *   NorLog        4       3      sample frames of the NOR flash log
+ *                                (BSP_SPINOR_ENABLE only)
+ *   LiveData      4       2      live data frames of the WebSocket
+ *                                (HTTP_SERVER only)
+ *
+ * A job must return well within a frame and never block; a job with
+ * nothing to do returns at once, so an idle job costs a few loads per
+ * frame. The ring holds BSP_ADC1_RING_SIZE samples, eight frames, which
+ * bounds the period of a job; the decimated ring of
+ * BSP_ADC1_DECIMATED_RING_SIZE entries holds sixteen.
+ *
+ * Per job, the executive measures the release latency (from the block hook
+ * to the start of the job, so the jitter of its start), the run time, and
+ * counts overruns: releases that passed while the executive was still busy
+ * with an earlier frame, and runs longer than the job's period.
+ */
+
+#ifndef CYCLIC_EXEC_H
+#define CYCLIC_EXEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Frame length while no ADC1 block releases frames */
+#define CYCLIC_IDLE_FRAME_MS 100U
+
+/**
+ * @brief Timing of one job
+ */
+typedef struct
+{
+    const char *name;           /**< Job name */
+    uint8_t     period;         /**< Frames between releases */
+    uint8_t     phase;          /**< Frame of the first release */
+    uint32_t    runs;           /**< Times run */
+    uint32_t    overruns;       /**< Releases missed or overrun */
+    uint32_t    max_latency_us; /**< Longest release to start */
+    uint32_t    max_run_us;     /**< Longest run */
+} cyclic_job_stats_t;
+
+/**
+ * @brief Release the next frame
+ *
+ * Called by the ADC1 block hook in the filter task after each block.
+ */
+void cyclic_exec_release(void);
+
+/**
+ * @brief Read the timing of a job
+ *
+ * @param[in]  index Job number, in table order from 0
+ * @param[out] stats Receives the timing
+ * @return false if @p index is past the last job
+ */
+bool cyclic_exec_get_stats(uint32_t index, cyclic_job_stats_t *stats);
+
+/**
+ * @brief Print the timing of every job
+ *
+ * Monitor task, part of its snapshot.
+ */
+void cyclic_exec_print(void);
+
+#endif /* CYCLIC_EXEC_H */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Scheduled Digital Outputs
+ *
+ * A queue of "set these outputs at time T" commands, so that a master can
+ * switch outputs at a known instant whatever the latency of the Modbus
+ * request that carried the command. T is PTP system time (BSP_Time_NowNs()),
+ * the timescale of the master once the PTP servo follows it (ptp.h).
+ *
+ * Commands are queued from the do_schedule holding registers: the time in
+ * seconds and nanoseconds, the outputs and their states, then
+ * DO_SCHEDULE_COMMAND_ADD in the command register, best in one FC16
+ * request. DO_SCHEDULE_COMMAND_CANCEL drops every pending command. Up to
+ * DO_SCHEDULE_QUEUE_LENGTH commands wait in time order; commands due at the
+ * same time are applied in the order they were queued, in one expander
+ * write.
+ *
+ * The executor task sleeps in ticks until DO_SCHEDULE_LEAD_NS before the
+ * next command is due, then on a compare of the capture timer until the
+ * time itself (BSP_Time_SleepUntilNs()), and starts the interrupt-driven
+ * expander write at once. It runs at the top task priority, so an output
+ * changes within the interrupt latency plus the expander write of its
+ * time; a write of the Modbus path or the interlocks still on the bus
+ * adds one more. The delay from T to the start of the write is kept per
+ * command, the latency input register shows the last one.
+ *
+ * do_schedule_write() queues a change for the present instead, for callers
+ * that must not wait for the expander, such as Modbus coil writes served
+ * in the TCP/IP thread (modbus_units.h). Such a change counts as a command
+ * in the status and is dropped by DO_SCHEDULE_COMMAND_CANCEL like one.
+ *
+ * Outputs held by an interlock (interlock.h) keep their forced states.
+ * Commands use the same shadow image as Modbus coil writes, and the coils
+ * read back the outputs as driven. A command whose write fails is dropped
+ * and counted, not retried: its time has passed.
+ */
+
+#ifndef DO_SCHEDULE_H
+#define DO_SCHEDULE_H
+
+#include <stdint.h>
+
+/** Commands that can wait in the queue */
+#define DO_SCHEDULE_QUEUE_LENGTH 16U
+
+/** Time before a command is due at which the executor leaves its tick
+ * sleep, two ticks so one tick of jitter never makes it late (ns) */
+#define DO_SCHEDULE_LEAD_NS 2000000ULL
+
+/** Longest tick sleep of the executor, so a PTP step moves the next wake-up
+ * within this (ms) */
+#define DO_SCHEDULE_MAX_SLEEP_MS 100U
+
+/**
+ * @brief Values of the command register
+ */
+typedef enum
+{
+    DO_SCHEDULE_COMMAND_NONE   = 0, /**< Nothing */
+    DO_SCHEDULE_COMMAND_ADD    = 1, /**< Queue the command in the registers */
+    DO_SCHEDULE_COMMAND_CANCEL = 2, /**< Drop every pending command */
+    DO_SCHEDULE_COMMAND_COUNT       /**< Number of commands */
+} do_schedule_command_t;
+
+/**
+ * @brief Result of queueing a command
+ */
+typedef enum
+{
+    DO_SCHEDULE_OK = 0, /**< Queued */
+    DO_SCHEDULE_PAST,   /**< The time has already passed */
+    DO_SCHEDULE_FULL,   /**< DO_SCHEDULE_QUEUE_LENGTH commands are pending */
+} do_schedule_result_t;
+
+/**
+ * @brief State of the queue
+ */
+typedef struct
+{
+    uint16_t pending;    /**< Commands waiting */
+    uint32_t executed;   /**< Commands applied since boot */
+    uint32_t failed;     /**< Commands whose write failed since boot */
+    uint32_t latency_ns; /**< Time from T to the start of the write of the
+                              last command applied, ns */
+} do_schedule_status_t;
+
+/**
+ * @brief Queue a command
+ *
+ * Safe to call from any task.
+ *
+ * @param[in] time_ns PTP system time to apply it at, ns
+ * @param[in] mask    Outputs to change (bit n = BSP_I2CDO_INDEX_Dn)
+ * @param[in] value   New states of the outputs in @p mask
+ * @return DO_SCHEDULE_OK if the command was queued
+ */
+do_schedule_result_t do_schedule_add(uint64_t time_ns, uint16_t mask,
+                                     uint16_t value);
+
+/**
+ * @brief Queue a change of outputs for as soon as possible
+ *
+ * Safe to call from any task. The executor applies it after the commands
+ * already due, in its next expander write; the caller does not wait for
+ * the write.
+ *
+ * @param[in] mask  Outputs to change (bit n = BSP_I2CDO_INDEX_Dn)
+ * @param[in] value New states of the outputs in @p mask
+ * @return DO_SCHEDULE_OK if the change was queued, DO_SCHEDULE_FULL if
+ *         DO_SCHEDULE_QUEUE_LENGTH commands are pending
+ */
+do_schedule_result_t do_schedule_write(uint16_t mask, uint16_t value);
+
+/**
+ * @brief Drop every pending command
+ *
+ * Safe to call from any task. A command whose write has started is still
+ * applied.
+ */
+void do_schedule_cancel(void);
+
+/**
+ * @brief Get the state of the queue
+ *
+ * Safe to call from any task. All fields are read together.
+ *
+ * @param[out] status Queue state
+ */
+void do_schedule_get_status(do_schedule_status_t *status);
+
+#endif /* DO_SCHEDULE_H */
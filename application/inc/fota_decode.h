@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * FOTA Payload Decoder
+ *
+ * Turns the payload of an update, as it arrives in segments of any size,
+ * into the image: a full image is taken as it is, a patch is applied on
+ * top of a base image and a compressed image is decompressed. The image
+ * bytes are gathered in two chunk buffers, and each full one is handed to
+ * an output function, which writes it to the update slot. The payload
+ * formats are described in fota_task.h.
+ *
+ * The decoder needs no flash and no kernel: the base image is any memory
+ * and the output any function, so it is built into the unit tests as it
+ * is.
+ */
+
+#ifndef FOTA_DECODE_H
+#define FOTA_DECODE_H
+
+#include <stdint.h>
+
+#include "fota_task.h"
+
+/** Size of each chunk buffer */
+#define FOTA_CHUNK_SIZE 2048U
+
+/**
+ * @brief Take a full chunk buffer, or the last part of one
+ *
+ * The buffer may be used until the next call returns: it is only filled
+ * again after the other one has been handed over. Its bytes from @p length
+ * up to FOTA_CHUNK_SIZE may be overwritten, to pad the last chunk.
+ *
+ * @param[in] context As given to fota_decode_init()
+ * @param[in] chunk   Chunk buffer, word aligned
+ * @param     length  Image bytes in the buffer, FOTA_CHUNK_SIZE but for
+ *                    the last one
+ * @return FOTA_STATUS_OK to go on, any other status ends the transfer
+ */
+typedef fota_status_t (*fota_decode_output_t)(void *context, uint8_t *chunk,
+                                              uint32_t length);
+
+/**
+ * @brief State of the decoder of one payload
+ */
+typedef struct
+{
+    /** Chunk buffers, word aligned for the flash source */
+    uint32_t             chunk[2][FOTA_CHUNK_SIZE / sizeof(uint32_t)];
+    fota_decode_output_t output;     /**< Output function */
+    void                *context;    /**< Context of the output function */
+    const uint8_t       *base;       /**< Base image of a patch */
+    uint32_t             base_size;  /**< Base image size */
+    uint32_t             image_size; /**< Image size */
+    uint32_t             received;   /**< Image bytes produced */
+    uint32_t             fill;       /**< Bytes in the active buffer */
+    uint8_t              active;     /**< Buffer being filled */
+    uint8_t              type;       /**< Payload, fota_payload_t */
+
+    /* Patch decoder and decompressor */
+    uint8_t  state;    /**< What the next payload byte belongs to */
+    uint8_t  shift;    /**< Bits of the varint read so far */
+    uint32_t varint;   /**< Varint being read */
+    uint32_t pending;  /**< Length of the current command or literals */
+    uint32_t copy_end; /**< Base offset after the previous COPY */
+    uint32_t match;    /**< Length of the current match */
+    uint32_t distance; /**< Distance of the current match */
+} fota_decode_t;
+
+/**
+ * @brief CRC-32 (IEEE 802.3, reflected), as zlib.crc32()
+ */
+uint32_t fota_crc32(const uint8_t *data, uint32_t length);
+
+/**
+ * @brief Start decoding a payload
+ *
+ * @param[out] decode     Decoder state
+ * @param      type       Payload
+ * @param      image_size Image size in bytes
+ * @param      output     Takes the chunk buffers
+ * @param      context    Handed to @p output
+ */
+void fota_decode_init(fota_decode_t *decode, fota_payload_t type,
+                      uint32_t image_size, fota_decode_output_t output,
+                      void *context);
+
+/**
+ * @brief Give a patch its base image, checking it is the one it was made
+ * from
+ *
+ * @param[in,out] decode    Decoder state
+ * @param[in]     base      Base image, left mapped while the patch is taken
+ * @param         base_size Base image size from the header
+ * @param         base_crc  CRC-32 of the base image from the header
+ * @return FOTA_STATUS_BAD_HEADER for a base of no bytes,
+ *         FOTA_STATUS_BAD_BASE if the CRC-32 does not match
+ */
+fota_status_t fota_decode_base(fota_decode_t *decode, const uint8_t *base,
+                               uint32_t base_size, uint32_t base_crc);
+
+/**
+ * @brief Go on with a full image whose first bytes are already written
+ *
+ * @param[in,out] decode   Decoder state, of a full image not yet taken
+ * @param         received Image bytes written, a whole number of chunks
+ */
+void fota_decode_resume(fota_decode_t *decode, uint32_t received);
+
+/**
+ * @brief Take one received segment of the payload
+ *
+ * Bytes past the image are ignored. A malformed patch or compressed image
+ * is refused before any bytes of the command that is wrong reach the
+ * output.
+ *
+ * @param[in,out] decode Decoder state
+ * @param[in]     data   Payload bytes
+ * @param         length Payload bytes in @p data
+ * @return FOTA_STATUS_BAD_PATCH for a malformed payload, the status of the
+ *         output if not FOTA_STATUS_OK, otherwise FOTA_STATUS_OK
+ */
+fota_status_t fota_decode_take(fota_decode_t *decode, const uint8_t *data,
+                               uint32_t length);
+
+/**
+ * @brief Hand the last, partly filled chunk buffer to the output
+ *
+ * @param[in,out] decode Decoder state
+ * @return The status of the output, FOTA_STATUS_OK if there was nothing
+ *         left
+ */
+fota_status_t fota_decode_finish(fota_decode_t *decode);
+
+#endif /* FOTA_DECODE_H */
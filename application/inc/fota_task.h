@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Firmware Update over TCP
+ *
+ * The FOTA task accepts one connection at a time on FOTA_DEFAULT_PORT. The
+ * client sends an 80-byte header followed by the payload: the raw
+ * application image, the objcopy binary of the NonSecure ELF linked at
+ * BSP_FLASH_APP_BASE, the image compressed, or a patch that rebuilds it
+ * from the running image. Fields are little-endian unless noted.
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, FOTA_MAGIC ("JF")
+ *   2       1     Format version, FOTA_VERSION
+ *   3       1     Payload type, fota_payload_t
+ *   4       4     Image size in bytes
+ *   8       4     Base image size in bytes, 0 for a full image
+ *   12      4     CRC-32 of the base image, for a full image of the image
+ *                 itself or 0
+ *   16      64    ECDSA P-256 signature of the SHA-256 of the image, r then
+ *                 s, big-endian
+ *
+ * A patch (FOTA_PAYLOAD_DELTA) is only applied on top of the image it was
+ * made from: the base size and CRC-32 (IEEE 802.3, as zlib.crc32()) are
+ * checked against the running image before anything is written. The patch
+ * is a sequence of commands, each a varint (LEB128) holding the length in
+ * bytes shifted left by one and the command in bit 0:
+ *
+ *   0  ADD   the length in bytes of the new image follows literally
+ *   1  COPY  a zigzag varint follows, the distance from the end of the
+ *            previous COPY to where the bytes are copied from in the base
+ *
+ * The commands rebuild the image front to back and the patch ends once the
+ * image size has been produced. A rebuild with small changes is mostly
+ * long COPYs, which makes the patch several times smaller than the image.
+ * tools/fota_delta.py makes patches.
+ *
+ * A compressed image (FOTA_PAYLOAD_LZ) is an LZ4 block whose matches reach
+ * back at most FOTA_LZ_WINDOW bytes, and it may end on a match. Each
+ * sequence is a token with the literal length in its high nibble and the
+ * match length minus 4 in its low one, the literals, then the match
+ * distance in two bytes. A nibble of 15 is continued by bytes added to
+ * it, up to the first below 255, after the token for the literals and
+ * after the distance for the match. The window is the data still in the
+ * chunk buffers, so the decompressor needs no RAM of its own; firmware
+ * typically compresses by a third. tools/fota_compress.py makes
+ * compressed images.
+ *
+ * The image is written straight into the update slot of the inactive flash
+ * bank as it is received or rebuilt; no copy of it is held in RAM. The
+ * signature is over the image, not the patch, so it is checked the same
+ * way for every payload. Each chunk is hashed in the secure world while it
+ * is programmed, so once the last byte is written only the signature check
+ * is left (BSP_Verify_Finish()). The vector table is also checked to belong
+ * to an image linked for the slot. The task then replies with 8 bytes and
+ * closes the connection:
+ *
+ *   Offset  Size  Field
+ *   0       1     Status, fota_status_t
+ *   1       3     Reserved, 0
+ *   4       4     Image bytes written
+ *
+ * On FOTA_STATUS_OK the banks are swapped and the device resets into the
+ * new image; on any other status the running image is left as it is.
+ *
+ * A transfer cut by a link drop or a reset resumes where it stopped. With
+ * a version 3 header the task answers a header it accepts with the same
+ * 8 bytes at once, status FOTA_STATUS_OK and the image offset the client
+ * goes on from, and the client waits for them before sending the payload.
+ * Version 2 clients get no such reply and always start from 0. Every
+ * FOTA_RESUME_STEP bytes programmed, the progress is saved in persistent
+ * holding registers (group fota_resume, config_store.h) with a tag of the
+ * header up to the signature and of the bank, so a resume needs the same
+ * image, named by its CRC-32, on the same bank; any other transfer, or a
+ * failed check, clears the progress. The signature is left out of the tag
+ * as ECDSA signs the same image differently each time. On a
+ * resume the slot up to the offset is hashed from the flash first, so the
+ * signature still covers the whole image. Only full images resume: the
+ * state of the patch decoder and of the decompressor is not saved.
+ *
+ * tools/fota_upload.py is the matching client.
+ */
+
+#ifndef FOTA_TASK_H
+#define FOTA_TASK_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/** Header magic: the bytes 'J', 'F' */
+#define FOTA_MAGIC 0x464AU
+
+/** Header format version, and the oldest one still accepted */
+#define FOTA_VERSION     3U
+#define FOTA_VERSION_MIN 2U
+
+/** Header size in bytes */
+#define FOTA_HEADER_SIZE 80U
+
+/** Offset of the signature in the header */
+#define FOTA_SIGNATURE_OFFSET 16U
+
+/** Offsets of the base image size and CRC-32 in the header */
+#define FOTA_BASE_SIZE_OFFSET 8U
+#define FOTA_BASE_CRC_OFFSET  12U
+
+/** Farthest match distance of a compressed image, a chunk buffer */
+#define FOTA_LZ_WINDOW 2048U
+
+/** Reply size in bytes */
+#define FOTA_REPLY_SIZE 8U
+
+/** TCP port of the update server */
+#define FOTA_DEFAULT_PORT 5008U
+
+/** Image bytes between progress saves, whole flash sectors */
+#define FOTA_RESUME_STEP (64U * 1024U)
+
+/**
+ * @brief Payload following the header
+ */
+typedef enum
+{
+    FOTA_PAYLOAD_IMAGE = 0, /**< The image itself */
+    FOTA_PAYLOAD_DELTA = 1, /**< A patch against the running image */
+    FOTA_PAYLOAD_LZ    = 2  /**< The image compressed */
+} fota_payload_t;
+
+/**
+ * @brief Update result
+ */
+typedef enum
+{
+    FOTA_STATUS_OK            = 0, /**< Image written, banks are swapped */
+    FOTA_STATUS_BAD_HEADER    = 1, /**< Wrong magic, version, type or size */
+    FOTA_STATUS_TIMEOUT       = 2, /**< Connection idle or closed too soon */
+    FOTA_STATUS_FLASH         = 3, /**< Erase or program failed */
+    FOTA_STATUS_BAD_SIGNATURE = 4, /**< Not signed with the signing key */
+    FOTA_STATUS_BAD_IMAGE     = 5, /**< Vector table not for the update slot */
+    FOTA_STATUS_VERIFY        = 6, /**< Secure verification service failed */
+    FOTA_STATUS_BAD_BASE      = 7, /**< Patch not made from the running image */
+    FOTA_STATUS_BAD_PATCH     = 8  /**< Malformed patch or compressed data */
+} fota_status_t;
+
+/**
+ * @brief Hand the progress registers to the task
+ *
+ * Called by the holding register write callback, also when the saved
+ * registers are restored at boot.
+ *
+ * @param[in] tag Tag of the transfer the progress belongs to
+ * @param[in] kib Image KiB programmed, 0 for none
+ */
+void fota_resume_set(uint32_t tag, uint16_t kib);
+
+/**
+ * @brief Give the task the register mutex, so it can save its progress
+ *
+ * Called once by the Modbus task after the register mutex is created.
+ *
+ * @param[in] register_mutex Mutex of the register writers
+ */
+void fota_resume_start(SemaphoreHandle_t register_mutex);
+
+#endif /* FOTA_TASK_H */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Tone Monitor
+ *
+ * Measures the amplitude and phase of a few chosen frequencies, such as
+ * mains harmonics or a known machine tone, on every ADC1 channel
+ * continuously. Where the spectrum (spectrum.h) transforms whole frames of
+ * a few channels at background priority, a tone costs one Goertzel filter:
+ * a multiply and two adds per sample of its channel and three words of
+ * state, so the tones run in the filter task on every sample.
+ *
+ * Up to GOERTZEL_TONES tones are configured, each an ADC1 channel and a
+ * frequency; a channel may have several. The filter task (ADC1 block hook)
+ * drains the full-rate stream after each block and runs every tone over
+ * the new raw samples of its channel, before the filter cascade, which
+ * notches the mains harmonics. A window of window_ms of consecutive
+ * samples gives one result per tone:
+ *
+ *   - magnitude: amplitude of the tone, in 0.1 mV;
+ *   - phase: phase of the tone as a cosine at the first sample of the
+ *     window, in 0.01 degree from -180 to 180 degrees; 0 while the
+ *     magnitude reads 0.
+ *
+ * All tones share the window, so the phases of two channels at the same
+ * frequency give the angle between them, such as that of the current to
+ * the voltage. The mean of each channel over the previous window is
+ * removed first. A window holding a whole number of periods of a tone
+ * measures it exactly; otherwise a tone leaks into its neighbours, by
+ * less the more periods the window holds: the default 200 ms holds 10
+ * periods of 50 Hz and 12 of 60 Hz.
+ *
+ * A new configuration, and a change of the sample rate, take effect with
+ * the next window; a gap in the sample sequence drops the window. A tone
+ * of frequency 0, or at or above half the sample rate, is off and reads 0.
+ * Results are published together at the end of each window.
+ */
+
+#ifndef GOERTZEL_H
+#define GOERTZEL_H
+
+#include <stdint.h>
+
+#include "bsp.h"
+
+/** Tones monitored at most */
+#define GOERTZEL_TONES 8U
+
+/** Window length bounds and default, ms */
+#define GOERTZEL_MIN_WINDOW_MS     10U
+#define GOERTZEL_MAX_WINDOW_MS     1000U
+#define GOERTZEL_DEFAULT_WINDOW_MS 200U
+
+/**
+ * @brief One tone to monitor
+ */
+typedef struct
+{
+    uint16_t channel;   /**< ADC1 channel, below BSP_ADC1_NUM_CHANNELS */
+    uint16_t frequency; /**< Frequency, 0.1 Hz; 0 = off */
+} goertzel_tone_t;
+
+/**
+ * @brief Tone monitor configuration
+ */
+typedef struct
+{
+    uint16_t        window_ms;             /**< Window length, ms */
+    goertzel_tone_t tones[GOERTZEL_TONES]; /**< Tones */
+} goertzel_config_t;
+
+/**
+ * @brief Result of one tone over one window, scaled for the input
+ * registers
+ */
+typedef struct
+{
+    uint16_t magnitude; /**< Amplitude, 0.1 mV, saturating at 65535 */
+    int16_t  phase;     /**< Phase, 0.01 degree */
+} goertzel_result_t;
+
+/**
+ * @brief Apply a new configuration
+ *
+ * Safe to call from any task; takes effect with the next window.
+ *
+ * @param[in] config New configuration (copied); NULL is ignored and a
+ *                   window length is clamped to GOERTZEL_MIN_WINDOW_MS to
+ *                   GOERTZEL_MAX_WINDOW_MS
+ */
+void goertzel_set_config(const goertzel_config_t *config);
+
+/**
+ * @brief Run the tones over the new full-rate samples
+ *
+ * Filter task only (ADC1 block hook). Attaches its stream reader on the
+ * first call.
+ */
+void goertzel_process(void);
+
+/**
+ * @brief Get the results last published
+ *
+ * Safe to call from any task. All results come from the same window.
+ *
+ * @param[out] results GOERTZEL_TONES entries, tone 0 first
+ * @return Number of windows since boot, 0 if none yet
+ */
+uint32_t goertzel_get_results(goertzel_result_t results[GOERTZEL_TONES]);
+
+#endif /* GOERTZEL_H */
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * HTTP Status Server on the lwIP Raw API
+ *
+ * A status page for a browser on HTTP_SERVER_PORT, with JSON resources
+ * behind it:
+ *
+ *   /                    The page, application/web/index.html
+ *   /api/status.json     Uptime, ADC counters, CPU load and stack headroom
+ *                        per task, and the metrics counters
+ *   /api/registers.json  The register groups marked "snapshot", one array
+ *                        of values per block (snapshot_publish.h)
+ *   /api/archive.json    A range of an ADC archive (adc_archive.h), with
+ *                        ?archive=seconds|minutes&from=s&to=s, each record
+ *                        an array [time, min, max, mean of A0, ...]
+ *   /ws                  WebSocket pushing the live data frames and events
+ *                        (http_ws.h)
+ *
+ * Nothing is allocated and no document is built in RAM. The files of
+ * application/web are compressed at build time by tools/http_assets.py
+ * into a table of complete responses, header and gzip body, in flash,
+ * which is queued with tcp_write() without a copy: the send buffer only
+ * refers to it. The JSON is produced one item at a time, a task entry, a
+ * counter or a few register values, into a buffer of HTTP_SERVER_ITEM_SIZE
+ * bytes per connection, and each item is copied in only while the send
+ * buffer has room for it; the rest follows from the tcp_sent() callback as
+ * the client acknowledges. A response ends when the connection closes
+ * (HTTP/1.0), so its length need not be known in advance. Assets are
+ * always sent gzip-encoded, which every browser accepts.
+ *
+ * All callbacks run in the TCP/IP thread, as for the raw Modbus server
+ * (modbus_tcp_raw.h), and never wait there: the register mutex is only
+ * tried, once per block of values; while a Modbus request holds it the
+ * response pauses and resumes on the next poll. Connections get the lowest
+ * PCB priority, so lwIP reclaims them first when PCBs run out. Each block
+ * of at most HTTP_SERVER_VALUES_MAX values is read at once, so its values
+ * are consistent with each other, but not with the other blocks.
+ * An archive range is read a page at a time, the flash mutex only tried
+ * in the same way; each page read costs the TCP/IP thread one short SPI
+ * transfer.
+ *
+ * Built when HTTP_SERVER is 1 (CMake option JERRY_HTTP_SERVER).
+ */
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef HTTP_SERVER
+#define HTTP_SERVER 0
+#endif
+
+/** TCP port of the server */
+#define HTTP_SERVER_PORT 80U
+
+/** Maximum number of simultaneous connections; further ones are refused */
+#define HTTP_SERVER_MAX_CONNECTIONS 2U
+
+/** Longest request line kept, a longer one is answered with 400; longer
+ *  header lines are cut */
+#define HTTP_SERVER_REQUEST_MAX 96U
+
+/** Size of the buffer of one JSON item */
+#define HTTP_SERVER_ITEM_SIZE 128U
+
+/** Register values read from a block at once (bits are read 16 a word) */
+#define HTTP_SERVER_VALUES_MAX 64U
+
+/**
+ * @brief Precompressed asset, generated by tools/http_assets.py
+ */
+typedef struct
+{
+    const char    *path;          /**< URL path, e.g. "/index.html" */
+    const char    *header;        /**< Complete response header */
+    uint16_t       header_length; /**< Bytes of @c header */
+    const uint8_t *body;          /**< gzip data */
+    uint32_t       body_length;   /**< Bytes of @c body */
+} http_asset_t;
+
+/** Assets, in flash */
+extern const http_asset_t http_assets[];
+
+/** Entries of http_assets[] */
+extern const uint32_t http_asset_count;
+
+/**
+ * @brief Listen on the HTTP port
+ *
+ * Called by the Modbus TCP task once the network interface is up.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ */
+void http_server_start(SemaphoreHandle_t register_mutex);
+
+#endif /* HTTP_SERVER_H */
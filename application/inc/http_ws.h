@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * WebSocket Live Data Push of the HTTP Server
+ *
+ * A dashboard opens a WebSocket (RFC 6455) on HTTP_WS_PATH of the HTTP
+ * server and is then sent, without asking, one binary message per live
+ * data frame, 25 a second, and one per event (live_data.h). Up to
+ * HTTP_WS_MAX_CLIENTS dashboards are served at once; a further upgrade
+ * request is answered with 503.
+ *
+ * The push task (WsPush) subscribes to both live data topics, encodes
+ * each message once and copies it into a queue of HTTP_WS_QUEUE_MESSAGES
+ * per client, then sends from each queue while that client has fewer than
+ * HTTP_WS_SEND_BUDGET bytes unacknowledged; the rest follows its ACKs. A
+ * client that falls behind loses its oldest messages, and the next message
+ * it gets tells how many. So a slow dashboard holds at most its budget of
+ * send buffer and delays no other client, and the bus messages are back in
+ * their topic as soon as they are encoded.
+ *
+ * The clients' own frames are read only for the protocol: a ping is
+ * answered with a pong, a close with a close, and anything else is
+ * skipped. Client frames must be masked and control frames must fit
+ * HTTP_WS_CONTROL_MAX bytes, else the connection is reset.
+ *
+ * Message, little-endian:
+ *
+ *   Offset  Size  Field
+ *   0       1     Type, HTTP_WS_TYPE_FRAME or HTTP_WS_TYPE_EVENT
+ *   1       1     Frames: channels n; events: source, live_data_source_t
+ *   2       1     Frames: digital inputs, bit n = DI n; events: kind
+ *   3       1     Reserved, 0
+ *   4       2     Messages this client lost just before this one
+ *                 (saturated)
+ *   6       2     Events: interlock rule or anomaly channel; frames: 0
+ *   8       8     Time, ns on the PTP timescale: of the first sample of a
+ *                 frame, 0 if unknown, or of the event
+ *   16      4     Frames: sample sequence of the first sample;
+ *                 events: value, interlock input in mV or anomaly score
+ *   20      4n    Frames only: channel means, float32 volts
+ *
+ * Built with the HTTP server (HTTP_SERVER).
+ */
+
+#ifndef HTTP_WS_H
+#define HTTP_WS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bsp.h"
+#include "http_server.h"
+
+/** Path of the WebSocket */
+#define HTTP_WS_PATH "/ws"
+
+/** Dashboards served at once */
+#define HTTP_WS_MAX_CLIENTS 4U
+
+/** Messages queued per client (power of two), 320 ms of frames */
+#define HTTP_WS_QUEUE_MESSAGES 8U
+
+/** Bytes a client may have sent but unacknowledged */
+#define HTTP_WS_SEND_BUDGET 1024U
+
+/** Longest control frame payload of a client, as RFC 6455 allows */
+#define HTTP_WS_CONTROL_MAX 125U
+
+/** Characters of a Sec-WebSocket-Key, base64 of 16 bytes */
+#define HTTP_WS_KEY_LENGTH 24U
+
+/** Message types */
+#define HTTP_WS_TYPE_FRAME 1U
+#define HTTP_WS_TYPE_EVENT 2U
+
+/** Message header size in bytes */
+#define HTTP_WS_HEADER_SIZE 20U
+
+/** Frame message size in bytes */
+#define HTTP_WS_FRAME_SIZE (HTTP_WS_HEADER_SIZE + (BSP_ADC1_NUM_CHANNELS * 4U))
+
+/** Event message size in bytes */
+#define HTTP_WS_EVENT_SIZE HTTP_WS_HEADER_SIZE
+
+#if HTTP_SERVER
+
+struct tcp_pcb;
+
+/**
+ * @brief Take over a connection that asked for the WebSocket
+ *
+ * Called by the HTTP server, in the TCP/IP thread, once the request
+ * headers are in. Sends the 101 response and sets its own callbacks on
+ * @p pcb; the caller must no longer use it as its connection.
+ *
+ * @param[in] pcb PCB of the connection
+ * @param[in] key Value of its Sec-WebSocket-Key header
+ * @return false if every client slot is taken or the response could not
+ *         be queued; @p pcb is then untouched
+ */
+bool http_ws_accept(struct tcp_pcb *pcb, const char *key);
+
+/**
+ * @brief Subscribe to the live data and start the push task
+ *
+ * Called once by the main task, after live_data_init().
+ */
+void http_ws_start(void);
+
+#endif /* HTTP_SERVER */
+
+#endif /* HTTP_WS_H */
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Local Interlocks
+ *
+ * Threshold rules on the filtered ADC1 inputs that drive the digital
+ * outputs directly, without a round trip through Modbus and the PLC. The
+ * rules are the "interlocks" section of jerry_registers.json, generated
+ * into the jerry_device_interlocks table. They are evaluated in the filter
+ * task after each block (ADC1 block hook), so an interlock reacts within
+ * one block period, INTERLOCK_BLOCK_US, plus its delay and the expander
+ * write.
+ *
+ * A rule trips once its input has been above (or below) its threshold for
+ * its delay, rounded up to whole blocks, and releases as soon as the input
+ * is back past the threshold by its hysteresis. While a rule is tripped
+ * its output is held in the rule's state (BSP_I2CDO_Force()): Modbus coil
+ * writes to it are not applied and the coil reads back the held state. A
+ * released output keeps that state until it is written again, so nothing
+ * restarts on its own. Rules sharing an output force the same state; the
+ * output is released when the last of them is.
+ *
+ * A rule on a low-latency channel (BSP_ADC1_LOW_LATENCY_CHANNELS) trips
+ * on samples instead: the sample hook, interlock_sample(), counts the
+ * filtered samples beyond the threshold in the ADC1 interrupt and the
+ * rule trips once they cover its delay, rounded up to whole samples at
+ * the rate in force; the filter task, woken at once, holds the output
+ * and writes it. Such a rule reacts within a sample period plus its delay
+ * and the expander write, and releases on blocks as above.
+ *
+ * A rule can also be tripped by an ADC analog watchdog, set with
+ * interlock_set_watchdog_rules(): the watchdog hook trips it as soon as
+ * the watchdog alarms, with no delay and without waiting for the block.
+ * It does not release while the alarm is active, then releases as above.
+ *
+ * The held outputs are committed with an interrupt-driven expander write
+ * started by the filter task, which never waits for it. A write that finds
+ * the bus busy with a Modbus write, or fails, is retried on the next block
+ * until the expanders hold the forced states.
+ *
+ * Every trip and release is recorded with the capture time of its block in
+ * a ring of INTERLOCK_EVENT_COUNT events, readable with Modbus FC20 as file
+ * INTERLOCK_FILE_NUMBER, in records of one 16-bit word:
+ *
+ *   Record  Size  Field
+ *   0       1     Magic, INTERLOCK_MAGIC ("JI")
+ *   1       1     Format version, INTERLOCK_VERSION
+ *   2       1     Header size in records, INTERLOCK_HEADER_RECORDS
+ *   3       1     Event size in records, INTERLOCK_EVENT_RECORDS
+ *   4       1     Events in the file, oldest first, at most
+ *                 INTERLOCK_EVENT_COUNT
+ *   5       1     Reserved, 0
+ *   6       2     Sequence number of the newest event, high word first
+ *   8       8E    Events:
+ *                   +0  2  Sequence number, 1 for the first since boot
+ *                   +2  4  Capture time, microseconds since boot
+ *                   +6  1  Rule in the low byte, interlock_event_kind_t in
+ *                          the high byte
+ *                   +7  1  Input value, mV (int16, saturated)
+ *
+ * All words of a value are high word first. A read over several FC20
+ * requests can see the ring move on in between; the sequence numbers tell.
+ * Rules disabled in the table, or at run time with a bit of the disable
+ * register, are not evaluated; disabling a tripped rule releases it.
+ */
+
+#ifndef INTERLOCK_H
+#define INTERLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "adc_filter_coefficients.h"
+#include "arm_math_types.h"
+#include "bsp.h"
+#include "modbus_types.h"
+
+/** Period at which every rule is evaluated, one filtered ADC1 block (us) */
+#define INTERLOCK_BLOCK_US \
+    ((BSP_ADC1_BLOCK_SAMPLES * 1000000UL) / ADC_FILTER_SAMPLE_RATE)
+
+/** Events kept in the ring */
+#define INTERLOCK_EVENT_COUNT 32U
+
+/** FC20 file number of the event ring */
+#define INTERLOCK_FILE_NUMBER 5U
+
+/** File magic, "JI" */
+#define INTERLOCK_MAGIC 0x4A49U
+
+/** File format version */
+#define INTERLOCK_VERSION 1U
+
+/** File header size in records */
+#define INTERLOCK_HEADER_RECORDS 8U
+
+/** Event size in records */
+#define INTERLOCK_EVENT_RECORDS 8U
+
+/** File size in records with a full ring */
+#define INTERLOCK_FILE_RECORDS   \
+    (INTERLOCK_HEADER_RECORDS + \
+     (INTERLOCK_EVENT_COUNT * INTERLOCK_EVENT_RECORDS))
+
+/**
+ * @brief What an event records
+ */
+typedef enum
+{
+    INTERLOCK_EVENT_TRIPPED  = 1, /**< The rule tripped, its output is held */
+    INTERLOCK_EVENT_RELEASED = 2, /**< The input came back, output released */
+    INTERLOCK_EVENT_DISABLED = 3, /**< The tripped rule was disabled */
+    INTERLOCK_EVENT_WATCHDOG = 4, /**< An analog watchdog tripped the rule */
+} interlock_event_kind_t;
+
+/**
+ * @brief State of the interlocks
+ */
+typedef struct
+{
+    uint16_t tripped;      /**< Rules tripped, bit n for rule n */
+    uint32_t events;       /**< Events recorded since boot */
+    uint32_t write_errors; /**< Output writes retried since boot */
+} interlock_status_t;
+
+/**
+ * @brief Evaluate every rule on a filtered block
+ *
+ * Filter task only (ADC1 block hook), ahead of anything else on the block.
+ * Does nothing until the filters have settled.
+ *
+ * @param[in] values Last filtered value of every ADC1 channel, V
+ */
+void interlock_process(const float32_t *values);
+
+/**
+ * @brief Disable rules at run time
+ *
+ * Safe to call from any task; the filter task applies it on its next
+ * block.
+ *
+ * @param[in] mask Rules disabled, bit n for rule n; 0 runs every rule
+ *                 enabled in the table
+ */
+void interlock_set_disabled(uint16_t mask);
+
+/**
+ * @brief Choose the rules an analog watchdog trips
+ *
+ * Safe to call from any task; applies from the watchdog's next alarm.
+ *
+ * @param[in] awd   Watchdog, 0 to BSP_ADC1_AWD_COUNT-1
+ * @param[in] rules Rules tripped, bit n for rule n; 0 for none
+ */
+void interlock_set_watchdog_rules(uint8_t awd, uint16_t rules);
+
+/**
+ * @brief Trip the rules of the analog watchdogs that alarmed
+ *
+ * Filter task only (ADC1 watchdog hook). Holds the outputs of the rules
+ * tripped and starts their write at once.
+ *
+ * @param[in] raised Alarms just raised, bit n for AWD n+1
+ * @param[in] active Alarms active
+ */
+void interlock_watchdog(uint32_t raised, uint32_t active);
+
+/**
+ * @brief Count the samples of the low-latency rules beyond their threshold
+ *
+ * ADC1 interrupt only (ADC1 sample hook). Does nothing until
+ * interlock_process() has started on settled filters.
+ *
+ * @param[in] values Filtered value of every ADC1 channel, V; only those of
+ *                   BSP_ADC1_LOW_LATENCY_CHANNELS are read
+ * @return true if a rule is due to trip, for interlock_sample_alarm()
+ */
+bool interlock_sample(const float32_t *values);
+
+/**
+ * @brief Trip the low-latency rules due to trip
+ *
+ * Filter task only (ADC1 sample alarm hook). Holds their outputs and
+ * starts the write at once.
+ */
+void interlock_sample_alarm(void);
+
+/**
+ * @brief Get the state of the interlocks
+ *
+ * Safe to call from any task. All fields come from the same block.
+ *
+ * @param[out] status Interlock state
+ */
+void interlock_get_status(interlock_status_t *status);
+
+/**
+ * @brief Read records of the event file, its FC20 file reader
+ *
+ * @param[in]  file_number   INTERLOCK_FILE_NUMBER
+ * @param[in]  record_number First record
+ * @param[in]  record_length Number of records
+ * @param[out] values        Record values
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS unless all records lie in
+ *         the file, whose size follows the events recorded
+ */
+modbus_exception_t interlock_read_file_record(uint16_t  file_number,
+                                              uint16_t  record_number,
+                                              uint16_t  record_length,
+                                              uint16_t *values);
+
+#endif /* INTERLOCK_H */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Allocation-Free Formatter
+ *
+ * A small snprintf() for the paths that format often, the logging task
+ * first: integers, characters, strings and pointers, no floating point
+ * and no locale. It never allocates, never recurses and keeps one digit
+ * buffer on the stack, so its stack use is fixed (about 100 bytes at -Os)
+ * and its cost is linear in the length of the output, where newlib's
+ * formatter draws on the reentrancy structure and, for some conversions,
+ * the heap.
+ *
+ * The conversions follow C99 for the subset supported:
+ *
+ *   Flags       - 0 + space #
+ *   Width       digits or *
+ *   Precision   .digits or .* (minimum digits, or the string length)
+ *   Length      hh h l ll z t j
+ *   Conversion  d i u o x X c s p %
+ *
+ * Anything else, such as %f, is copied to the output as written, so a
+ * mistake shows in the text rather than consuming the wrong argument.
+ */
+
+#ifndef JERRY_PRINTF_H
+#define JERRY_PRINTF_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/**
+ * @brief Format into a buffer
+ *
+ * The output is cut to @p size - 1 characters and always terminated
+ * while @p size is non-zero.
+ *
+ * @param[out] buffer Destination, may be NULL if @p size is 0
+ * @param[in]  size   Size of @p buffer in bytes
+ * @param[in]  format printf() format, of the subset above
+ * @return Length the full output would have, without the terminator
+ */
+int jerry_snprintf(char *buffer, size_t size, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Format into a buffer from a va_list
+ *
+ * @see jerry_snprintf()
+ */
+int jerry_vsnprintf(char *buffer, size_t size, const char *format,
+                    va_list ap) __attribute__((format(printf, 3, 0)));
+
+#endif /* JERRY_PRINTF_H */
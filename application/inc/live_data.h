@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Live Data Topics
+ *
+ * Puts the live state of the node on the message bus (msg_bus.h) at a
+ * rate a display can follow, for any task that wants it. Two topics:
+ *
+ *   live_data_frames()  Every LIVE_DATA_FRAME_MS, the mean of each
+ *                       channel's filtered output over the frame, and
+ *                       the digital input states at its end
+ *   live_data_events()  The interlock trips and resets and the anomaly
+ *                       alarms, as they happen
+ *
+ * The frame job (LiveData, cyclic_exec.h) averages the decimated stream
+ * as the NOR flash log does; the events are published by the interlock
+ * and anomaly tasks. Publishing never waits: a frame or an event that
+ * finds every message of its topic held by slow subscribers is dropped,
+ * counted in the topic's pool statistics.
+ *
+ * Built with the HTTP server (HTTP_SERVER), whose WebSocket clients are
+ * the subscribers (http_ws.h).
+ */
+
+#ifndef LIVE_DATA_H
+#define LIVE_DATA_H
+
+#include <stdint.h>
+
+#include "adc_filter_coefficients.h"
+#include "bsp.h"
+#include "http_server.h"
+#include "msg_bus.h"
+
+/** Period of a frame (25 Hz) */
+#define LIVE_DATA_FRAME_MS 40U
+
+/** Messages of the frame topic */
+#define LIVE_DATA_FRAME_MESSAGES 4U
+
+/** Messages of the event topic */
+#define LIVE_DATA_EVENT_MESSAGES 8U
+
+/**
+ * @brief Origin of an event
+ */
+typedef enum
+{
+    LIVE_DATA_SOURCE_INTERLOCK = 1, /**< Interlock rule (interlock.h) */
+    LIVE_DATA_SOURCE_ANOMALY   = 2, /**< Anomaly alarm (anomaly.h) */
+} live_data_source_t;
+
+/**
+ * @brief Payload of the frame topic
+ */
+typedef struct
+{
+    uint64_t  time_ns;  /**< Time of the frame start, ns, 0 if unknown */
+    uint32_t  sequence; /**< Sample sequence of the frame start */
+    float32_t mean[BSP_ADC1_NUM_CHANNELS]; /**< Channel means, volts */
+    uint8_t   di;       /**< Debounced digital inputs, bit n = DI n */
+} live_data_frame_t;
+
+/**
+ * @brief Payload of the event topic
+ */
+typedef struct
+{
+    uint64_t time_ns; /**< BSP_Time_NowNs() when it happened */
+    int32_t  value;   /**< Interlock input in mV, or anomaly score */
+    uint16_t index;   /**< Interlock rule or anomaly channel */
+    uint8_t  source;  /**< live_data_source_t */
+    uint8_t  kind;    /**< interlock_event_kind_t, or 1 raised / 0 cleared */
+} live_data_event_t;
+
+#if HTTP_SERVER
+
+/**
+ * @brief Initialize the topics
+ *
+ * Called once by the main task, before any subscriber subscribes.
+ */
+void live_data_init(void);
+
+/**
+ * @brief Topic of the frames, of live_data_frame_t
+ */
+msg_bus_topic_t *live_data_frames(void);
+
+/**
+ * @brief Topic of the events, of live_data_event_t
+ */
+msg_bus_topic_t *live_data_events(void);
+
+/**
+ * @brief Publish an event
+ *
+ * Stamped with BSP_Time_NowNs(). Task context; never blocks.
+ *
+ * @param[in] source Origin of the event
+ * @param[in] kind   Kind, as defined by the source
+ * @param[in] index  Rule or channel
+ * @param[in] value  Value, as defined by the source
+ */
+void live_data_event(live_data_source_t source, uint8_t kind, uint16_t index,
+                     int32_t value);
+
+/**
+ * @brief Frame job: average the decimated stream into frames
+ *
+ * Run by the cyclic executive; never blocks.
+ */
+void live_data_job(void);
+
+#endif /* HTTP_SERVER */
+
+#endif /* LIVE_DATA_H */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Asynchronous Logging
+ *
+ * LOG() stores a compact record (format string pointer, timestamp and up to
+ * LOG_MAX_ARGS arguments) in a lock-free multi-producer ring and returns;
+ * the string is only formatted later by the logging task, which drains the
+ * ring to the console by DMA. Any task or interrupt handler may log. A full
+ * ring drops the record and counts it, it never blocks the caller.
+ *
+ * printf() output goes through the same ring as raw text chunks, so both
+ * kinds of output stay in order. Before the scheduler starts, and with
+ * interrupts masked or in a fault handler, printf() writes to the console
+ * directly by polling instead. Text that finds the ring full is dropped
+ * and counted like a record; with LOG_BLOCK_ON_FULL set (CMake option
+ * JERRY_LOG_BLOCK) printf() from a task waits up to LOG_BLOCK_MAX_MS for
+ * the logging task to make room instead, so long reports such as the
+ * monitor snapshot come out whole at the cost of the printing task's
+ * latency. LOG() and interrupt handlers never wait.
+ *
+ * The fault handlers and the fatal kernel hooks call log_panic() through
+ * BSP_Console_Fault() before they print, which writes out what the ring
+ * still holds by polling, so the messages leading up to a fault are not
+ * lost with it.
+ *
+ * Arguments are stored as 32-bit words: they must be integers of at most 32
+ * bits, characters or pointers. %s may only point to strings that outlive
+ * the record, in practice string literals and other constant data; a string
+ * in a buffer that is reused, such as a request, goes through LOG_NOW(),
+ * which formats the message at once and stores the text. Floating point
+ * conversions are not supported.
+ *
+ * With LOG_BINARY set (CMake option JERRY_LOG_BINARY) the logging task
+ * sends the records unformatted and tools/log_decoder.py formats them on
+ * the host from the ELF file; the frame format is given in logging_task.c.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Arguments stored per record */
+#define LOG_MAX_ARGS 4U
+
+/** Records the ring holds, a power of two */
+#define LOG_RING_SIZE 128U
+
+/** Bytes of printf() text carried by one record */
+#define LOG_TEXT_BYTES (LOG_MAX_ARGS * sizeof(uint32_t))
+
+/** Longest message of LOG_NOW(), longer ones are cut */
+#define LOG_NOW_MAX_BYTES 96U
+
+#ifndef LOG_BINARY
+#define LOG_BINARY 0
+#endif
+
+#ifndef LOG_BLOCK_ON_FULL
+#define LOG_BLOCK_ON_FULL 0
+#endif
+
+/** Longest wait of printf() text for room with LOG_BLOCK_ON_FULL */
+#define LOG_BLOCK_MAX_MS 100U
+
+/**
+ * @brief One log record
+ */
+typedef struct
+{
+    const char *format;       /**< printf() format, NULL for a text chunk */
+    uint32_t    timestamp_ms; /**< Tick count when logged */
+    uint8_t     length;       /**< Arguments, or text bytes of a chunk */
+    uint32_t    args[LOG_MAX_ARGS]; /**< Arguments, or the text bytes */
+} log_record_t;
+
+/** @cond INTERNAL */
+#define LOG_COUNT_(f, a1, a2, a3, a4, a5, n, ...) n
+#define LOG_COUNT(...) \
+    LOG_COUNT_(__VA_ARGS__, LOG_too_many_arguments, 4, 3, 2, 1, 0, 0)
+/** @endcond */
+
+/**
+ * @brief Log a printf() style message
+ *
+ * Usage: LOG("Client %u connected\n", (unsigned int)slot). At most
+ * LOG_MAX_ARGS arguments; more fail to compile.
+ */
+#define LOG(...) log_write(LOG_COUNT(__VA_ARGS__), __VA_ARGS__)
+
+/**
+ * @brief Log a printf() style message formatted by the caller
+ *
+ * For %s arguments that do not outlive the record. The message is
+ * formatted on the caller's stack (jerry_printf.h subset, at most
+ * LOG_NOW_MAX_BYTES) and stored as text chunks; like LOG() it never waits
+ * for room. Usage: LOG_NOW("HTTP: GET %s\n", path).
+ */
+#define LOG_NOW(...) log_now(__VA_ARGS__)
+
+/**
+ * @brief Initialize the ring
+ *
+ * Call once at startup, before anything logs.
+ */
+void log_init(void);
+
+/**
+ * @brief Store a record, use LOG() instead
+ *
+ * @param arg_count Number of arguments following @p format
+ * @param format    printf() format string, must outlive the record
+ */
+void log_write(uint32_t arg_count, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Format a message now and store it as text, use LOG_NOW() instead
+ *
+ * @param format printf() format string
+ */
+void log_now(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Store text as raw text chunks
+ *
+ * Waits for room on a full ring as LOG_BLOCK_ON_FULL allows, else drops
+ * the rest of the text.
+ *
+ * @param text   Text, copied
+ * @param length Number of bytes
+ */
+void log_text(const char *text, size_t length);
+
+/**
+ * @brief Take the oldest record from the ring (logging task only)
+ *
+ * @param[out] record Destination
+ * @return true if a record was taken, false if the ring is empty
+ */
+bool log_read(log_record_t *record);
+
+/**
+ * @brief Return and clear the number of records dropped on a full ring
+ */
+uint32_t log_take_dropped(void);
+
+/**
+ * @brief Write out everything in the ring by polling the console
+ *
+ * For the fault handlers and fatal hooks, through BSP_Console_Fault(); the
+ * system must not resume afterwards, as the logging task may have been
+ * stopped in the middle of a record. Implemented by the logging task.
+ */
+void log_panic(void);
+
+#endif /* LOG_H */
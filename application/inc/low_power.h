@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Tickless Idle
+ *
+ * Replaces the FreeRTOS port's tickless idle (configUSE_TICKLESS_IDLE 2):
+ * when every task is blocked for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+ * ticks, the kernel tick is stopped and the core sleeps on the BSP
+ * low-power timer (BSP_LOWPOWER) until the next task is due or an
+ * interrupt arrives. The ticks slept are then credited to the kernel.
+ *
+ * The sleep state is the deepest one allowed by LOW_POWER_MAX_DEPTH whose
+ * wake-up latency is within LOW_POWER_MAX_WAKE_LATENCY_US. Sleep keeps
+ * every peripheral clocked, so the TIM1 triggered ADC1 acquisition and the
+ * Ethernet MAC go on and their interrupts wake the core. Stop is further
+ * limited to idle periods of at least LOW_POWER_STOP_MIN_IDLE_MS with the
+ * BSP idle (BSP_LowPower_StopAllowed(), which rules it out while the
+ * acquisition runs) and the Ethernet link down: the MAC is not clocked in
+ * Stop, so frames would be lost. A link coming up is seen at the next
+ * wake-up, at the latest after the idle period.
+ *
+ * The time slept in each state is counted for the monitor task.
+ */
+
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bsp.h"
+
+/** Deepest sleep state used: 0 none, 1 Sleep, 2 Stop (CMake
+ *  JERRY_LOW_POWER_DEPTH) */
+#ifndef LOW_POWER_MAX_DEPTH
+#define LOW_POWER_MAX_DEPTH 1
+#endif
+
+/** Longest acceptable delay from a wake-up event to running code */
+#ifndef LOW_POWER_MAX_WAKE_LATENCY_US
+#define LOW_POWER_MAX_WAKE_LATENCY_US 250U
+#endif
+
+/** Shortest idle period worth entering Stop for */
+#ifndef LOW_POWER_STOP_MIN_IDLE_MS
+#define LOW_POWER_STOP_MIN_IDLE_MS 10U
+#endif
+
+/**
+ * @brief Time spent in the sleep states
+ */
+typedef struct
+{
+    uint32_t entries[BSP_SLEEP_STATE_COUNT]; /**< Idle periods per state,
+                                                  BSP_SLEEP_NONE: not slept */
+    uint64_t time_us[BSP_SLEEP_STATE_COUNT]; /**< Time slept per state */
+    uint32_t stop_vetoes; /**< Stop ruled out by a busy peripheral or the
+                               Ethernet link */
+} low_power_stats_t;
+
+/**
+ * @brief Sleep through an idle period, portSUPPRESS_TICKS_AND_SLEEP()
+ *
+ * Called by the idle task with the scheduler suspended.
+ *
+ * @param expected_idle Ticks until the next task is due
+ */
+void low_power_suppress_ticks_and_sleep(uint32_t expected_idle);
+
+/**
+ * @brief Report the Ethernet link state, Stop is only used while it is down
+ *
+ * The link is taken as up until first reported.
+ */
+void low_power_set_ethernet_active(bool active);
+
+/**
+ * @brief Copy the sleep statistics
+ *
+ * @param[out] stats Destination
+ */
+void low_power_get_stats(low_power_stats_t *stats);
+
+/**
+ * @brief Print the sleep statistics
+ */
+void low_power_print(void);
+
+#endif /* LOW_POWER_H */
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Metrics
+ *
+ * Event counters pushed by their producers: the Ethernet driver, the lwIP
+ * pools, the ADC stream and the Modbus transports. metrics_add() is a
+ * single atomic add, callable from any task or interrupt handler. Each
+ * counter has a threshold; whenever its total crosses a multiple of it the
+ * monitor task is woken to report what changed. Otherwise the monitor
+ * sleeps until a full snapshot is requested with
+ * metrics_request_snapshot().
+ *
+ * lwIP keeps its own error counters (lwip_stats) and has no hook on them,
+ * so metrics_lwip_sample() is run by an lwIP timer in the tcpip thread and
+ * pushes their increase like any other producer.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/** Period of the lwIP error counter sample in the tcpip thread */
+#ifndef METRICS_LWIP_SAMPLE_MS
+#define METRICS_LWIP_SAMPLE_MS 1000U
+#endif
+
+/** Events returned by metrics_wait() */
+#define METRICS_EVENT_THRESHOLD (1UL << 0) /**< A counter crossed it */
+#define METRICS_EVENT_SNAPSHOT  (1UL << 1) /**< A snapshot was requested */
+#define METRICS_EVENT_TELEMETRY (1UL << 2) /**< A telemetry frame is due */
+
+/**
+ * @brief Counters
+ */
+typedef enum
+{
+    METRIC_LWIP_HEAP_ERR = 0, /**< lwIP heap allocation failed */
+    METRIC_LWIP_PBUF_ERR,     /**< PBUF_POOL empty */
+    METRIC_LWIP_TCP_SEG_ERR,  /**< TCP_SEG pool empty */
+    METRIC_LWIP_TCP_PCB_ERR,  /**< TCP_PCB pool empty */
+    METRIC_LWIP_NETCONN_ERR,  /**< NETCONN pool empty */
+    METRIC_ETH_RX_NO_BUFFER,  /**< No RX buffer for a DMA descriptor */
+    METRIC_ETH_RX_STALL,      /**< RX DMA stopped for lack of descriptors */
+    METRIC_ETH_RX_DROPPED,    /**< Received frame refused by lwIP */
+    METRIC_ETH_TX_ERR,        /**< Frame not taken by the MAC */
+    METRIC_ADC_OVERRUN,       /**< Samples overwritten before streaming */
+    METRIC_ADC_DROPPED,       /**< Samples dropped for lack of pbufs */
+    METRIC_MODBUS_TCP_ERR,    /**< Modbus TCP request or framing error */
+    METRIC_MODBUS_RTU_ERR,    /**< Modbus RTU frame or response error */
+    METRIC_USB_LOG_LOST,      /**< Samples dropped waiting for the stick */
+    METRIC_ETH_RX_RECOVERED,  /**< RX DMA stall recovered by a refill */
+    METRIC_ETH_RX_STALL_US,   /**< Microseconds the RX DMA spent stalled */
+    METRIC_ETH_BCAST_STORM,   /**< Broadcasts blocked in the MAC for a storm */
+    METRIC_MODBUS_UDP_RETRY,  /**< Modbus/UDP write retry answered again */
+    METRIC_MODBUS_UNIT_DROP,  /**< Modbus TCP frame for a foreign unit */
+    METRIC_MODBUS_SHED_CONN,  /**< Request over its connection's rate */
+    METRIC_MODBUS_SHED_UNIT,  /**< Request over its unit's rate */
+    METRIC_ETH_RX_POLL,       /**< RX switched to polling for a burst */
+    METRIC_MSG_BUS_DROP,      /**< Message missed by a full subscriber */
+    METRIC_TRACE_DROP,        /**< Trace record lost to a full ring */
+    METRIC_DEADLINE_MISS,     /**< Supervised task missed its deadline */
+    METRIC_LOG_DROP,          /**< Log record or printf() text lost */
+    METRIC_CONFIG_FAIL,       /**< Configuration store commit failed */
+    METRIC_NOR_LOG_LOST,      /**< NOR log record lost to a full queue */
+    METRIC_WS_DROP,           /**< WebSocket message lost, slow client */
+    METRIC_MQTT_RECONNECT,    /**< MQTT broker connection lost */
+    METRIC_ARCHIVE_LOST,      /**< Archive record lost to a full queue */
+    METRIC_USB_STREAM_LOST,   /**< Sample not streamed to the USB host */
+    METRIC_PROFILE_DROP,      /**< PC sample lost to a full ring */
+    METRIC_CAPTURE_DROP,      /**< Modbus request record lost, full ring */
+    METRIC_COUNT
+} metric_id_t;
+
+/**
+ * @brief Add to a counter
+ *
+ * Any context, never blocks. Wakes the monitor task when the total crosses
+ * a multiple of the counter's threshold.
+ *
+ * @param id    Counter
+ * @param count Events to add
+ */
+void metrics_add(metric_id_t id, uint32_t count);
+
+/**
+ * @brief Have the monitor task print a full snapshot
+ *
+ * Any context.
+ */
+void metrics_request_snapshot(void);
+
+/**
+ * @brief Have the monitor task build a telemetry frame now (telemetry.h)
+ *
+ * Any context.
+ */
+void metrics_request_telemetry(void);
+
+/**
+ * @brief Wait for a threshold crossing or a snapshot request
+ *
+ * Monitor task only; the first call makes the calling task the one woken.
+ *
+ * @param timeout Ticks to wait, portMAX_DELAY for ever
+ * @return METRICS_EVENT_* bits, 0 on timeout
+ */
+uint32_t metrics_wait(TickType_t timeout);
+
+/**
+ * @brief Copy the counter totals
+ *
+ * @param[out] totals Destination, METRIC_COUNT entries
+ */
+void metrics_get(uint32_t totals[METRIC_COUNT]);
+
+/**
+ * @brief Get the printed name of a counter
+ *
+ * @param id Counter
+ * @return Name, a constant string
+ */
+const char *metrics_name(metric_id_t id);
+
+/**
+ * @brief Print the counters that changed since the last call
+ *
+ * Monitor task only.
+ */
+void metrics_print_changes(void);
+
+/**
+ * @brief Print all counters with their thresholds
+ */
+void metrics_print(void);
+
+/**
+ * @brief Push the increase of the lwIP error counters and re-arm
+ *
+ * lwIP timer callback, tcpip thread only. Start it once with
+ * sys_timeout(METRICS_LWIP_SAMPLE_MS, metrics_lwip_sample, NULL).
+ */
+void metrics_lwip_sample(void *arg);
+
+#endif /* METRICS_H */
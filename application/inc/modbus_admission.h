@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Admission Control
+ *
+ * Token bucket rate limits on the requests of the Modbus TCP server, so a
+ * master polling in a tight loop cannot take the register callbacks, the
+ * TCP/IP thread and the link tasks away from the others. Every request
+ * takes a token from the bucket of its connection and one from the bucket
+ * of its unit (modbus_units.h), which all connections share; buckets refill
+ * continuously at their rate up to their burst. A request that finds
+ * either bucket empty is not queued but shed at once: it is answered with
+ * exception 06 (SLAVE DEVICE BUSY) without touching the registers, and
+ * counted as METRIC_MODBUS_SHED_CONN or METRIC_MODBUS_SHED_UNIT.
+ *
+ * Control writes (FC05, FC06, FC15, FC16 and FC23) may overdraw a bucket
+ * by MODBUS_ADMISSION_WRITE_RESERVE tokens, so a flood of reads sheds reads
+ * first and the writes behind them still get through. They are also served
+ * ahead of reads by the TCP server: reads queue for the register mutex one
+ * at a time behind a gate of their own, so a write waits for at most the
+ * access in progress and one read, however many masters poll.
+ *
+ * Requests the gateway forwards (modbus_gateway.h) only draw on the bucket
+ * of their connection; the port queue bounds them downstream.
+ */
+
+#ifndef MODBUS_ADMISSION_H
+#define MODBUS_ADMISSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "modbus_units.h"
+
+/** Requests per second each connection may sustain */
+#define MODBUS_ADMISSION_CONN_RATE 200U
+
+/** Requests a connection may send at once after a pause */
+#define MODBUS_ADMISSION_CONN_BURST 32U
+
+/** Requests per second each unit may sustain, over all connections */
+#define MODBUS_ADMISSION_UNIT_RATE 500U
+
+/** Requests a unit may take at once after a pause */
+#define MODBUS_ADMISSION_UNIT_BURST 64U
+
+/** Tokens a control write may take beyond an empty bucket */
+#define MODBUS_ADMISSION_WRITE_RESERVE 8U
+
+/**
+ * @brief Token bucket
+ *
+ * Tokens are counted in thousandths of a request, so refills at any rate
+ * are exact to the millisecond.
+ */
+typedef struct
+{
+    int32_t    tokens; /**< Thousandths of a request, below 0 if overdrawn */
+    TickType_t last;   /**< Tick of the last refill */
+} modbus_bucket_t;
+
+/**
+ * @brief Result of the admission of a request
+ */
+typedef enum
+{
+    MODBUS_ADMIT_OK = 0,    /**< Serve it */
+    MODBUS_ADMIT_SHED_CONN, /**< Its connection is over its rate */
+    MODBUS_ADMIT_SHED_UNIT, /**< Its unit is over its rate */
+} modbus_admission_t;
+
+/**
+ * @brief Fill a connection bucket for a new connection
+ *
+ * @param[out] bucket Bucket of the connection
+ */
+void modbus_admission_init_conn(modbus_bucket_t *bucket);
+
+/**
+ * @brief Check whether a function code is a control write
+ *
+ * @param[in] function_code Function code of a request
+ * @return true for the function codes that may overdraw and jump the reads
+ */
+bool modbus_admission_is_write(uint8_t function_code);
+
+/**
+ * @brief Admit a request and take its tokens
+ *
+ * Called by the worker of the connection, which owns @p conn; the unit
+ * buckets are guarded by a critical section. Tokens are only taken when
+ * the request is admitted.
+ *
+ * @param[in,out] conn          Bucket of the connection
+ * @param[in]     unit          Unit the request is for, NULL if forwarded
+ * @param[in]     function_code Function code of the request
+ * @return MODBUS_ADMIT_OK to serve it, otherwise the bucket that refused
+ */
+modbus_admission_t modbus_admission_check(modbus_bucket_t     *conn,
+                                          const modbus_unit_t *unit,
+                                          uint8_t              function_code);
+
+#endif /* MODBUS_ADMISSION_H */
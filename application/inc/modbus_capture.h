@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Request Capture
+ *
+ * Records the shape of the requests the masters send to port 502, so that
+ * a benchmark can replay real traffic: odd ranges, bursts, several
+ * masters and unit IDs. Each request frame the connection workers of
+ * modbus_task.c receive, including those for a unit not served here,
+ * becomes one MODBUS_CAPTURE_RECORD_SIZE record in a RAM ring: when it
+ * arrived, on which connection, its unit ID, function code, transaction
+ * ID, length and the register or coil range it addresses. Register values
+ * and other payload are never recorded.
+ *
+ * Nothing is recorded while no client is connected; a frame then costs
+ * one load. The workers write the ring in a critical section, the capture
+ * task is its only reader. A full ring drops the new records, counted as
+ * METRIC_CAPTURE_DROP; the stream then carries one record with
+ * MODBUS_CAPTURE_FLAG_LOST and the number lost in its time field.
+ *
+ * The capture task (MbCapture) serves one client at a time on TCP port
+ * MODBUS_CAPTURE_PORT. The client sends a request, the task answers with
+ * a header, starts recording and streams the records every
+ * MODBUS_CAPTURE_DRAIN_MS until the client closes. All fields are
+ * little-endian.
+ *
+ * Request:
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, MODBUS_CAPTURE_MAGIC ("JC")
+ *   2       1     Format version, MODBUS_CAPTURE_VERSION
+ *   3       1     Reserved, 0
+ *
+ * Header:
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, MODBUS_CAPTURE_MAGIC
+ *   2       1     Format version, MODBUS_CAPTURE_VERSION
+ *   3       1     Record size, MODBUS_CAPTURE_RECORD_SIZE
+ *   4       4     Time of the start of the capture, seconds of the PTP
+ *                 timescale (BSP_Time_NowNs())
+ *
+ * Record:
+ *
+ *   Offset  Size  Field
+ *   0       4     Arrival time, microseconds since the start of the capture
+ *   4       2     Transaction ID of the MBAP header
+ *   6       2     ADU length in bytes, MBAP header included
+ *   8       2     Start address; the read range of FC23
+ *   10      2     Quantity; 1 for FC05, FC06 and FC22
+ *   12      2     Write start address of FC23, 0 otherwise
+ *   14      2     Write quantity of FC23, 0 otherwise
+ *   16      1     Unit ID
+ *   17      1     Function code, 0 if the frame ended before it
+ *   18      1     Connection, the worker slot that received the frame
+ *   19      1     Flags, MODBUS_CAPTURE_FLAG_*
+ *
+ * The range fields are 0 for the function codes without one (FC07, FC08,
+ * FC11, FC20, FC21, FC43 and the like). A step of the PTP time during a
+ * capture moves the times of the later records with it. tools/modbus_replay.py records a
+ * capture and replays it to a device or to the host simulation, at its
+ * own timing or scaled.
+ *
+ * Built when MODBUS_CAPTURE is 1 (CMake option JERRY_MODBUS_CAPTURE); not
+ * with the raw API server of MODBUS_TCP_RAW, which bypasses the workers.
+ */
+
+#ifndef MODBUS_CAPTURE_H
+#define MODBUS_CAPTURE_H
+
+#include <stdint.h>
+
+#ifndef MODBUS_CAPTURE
+#define MODBUS_CAPTURE 0
+#endif
+
+/** Request and header magic: the bytes 'J', 'C' */
+#define MODBUS_CAPTURE_MAGIC 0x434AU
+
+/** Stream format version */
+#define MODBUS_CAPTURE_VERSION 1U
+
+/** Request size in bytes */
+#define MODBUS_CAPTURE_REQUEST_SIZE 4U
+
+/** Header size in bytes */
+#define MODBUS_CAPTURE_HEADER_SIZE 8U
+
+/** Size of one record in bytes */
+#define MODBUS_CAPTURE_RECORD_SIZE 20U
+
+/** Records the ring holds, a power of two */
+#define MODBUS_CAPTURE_RING_RECORDS 512U
+
+/** Period at which the capture task drains the ring */
+#define MODBUS_CAPTURE_DRAIN_MS 20U
+
+/** TCP port of the capture stream */
+#define MODBUS_CAPTURE_PORT 5013U
+
+/** Record flag: frame for a unit ID not served here, skipped */
+#define MODBUS_CAPTURE_FLAG_FOREIGN 0x01U
+
+/** Record flag: records lost before this one, their number in the time
+ * field; the other fields are 0 */
+#define MODBUS_CAPTURE_FLAG_LOST 0x02U
+
+/**
+ * @brief Record one request frame
+ *
+ * Called by the connection workers for every frame received; returns at
+ * once while no client is connected.
+ *
+ * @param[in] connection Worker slot that received the frame
+ * @param[in] frame      Frame, from its MBAP header; may end early for a
+ *                       foreign frame
+ * @param[in] available  Bytes of @p frame at hand
+ * @param[in] flags      MODBUS_CAPTURE_FLAG_FOREIGN or 0
+ */
+void modbus_capture_frame(uint8_t connection, const uint8_t *frame,
+                          uint16_t available, uint8_t flags);
+
+/**
+ * @brief Start the capture task
+ *
+ * Called once by the Modbus task, with the network interface up.
+ */
+void modbus_capture_start(void);
+
+#endif /* MODBUS_CAPTURE_H */
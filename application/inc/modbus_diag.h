@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus Diagnostic Registers
+ *
+ * Serves diagnostics as reserved blocks of input registers. The registers
+ * are read live and never cached.
+ *
+ * The latency block (MODBUS_DIAG_IR_BASE) holds the request latency
+ * histograms the Modbus stack collects when it is built with
+ * MODBUS_ENABLE_LATENCY_STATS. It has one section per transport (TCP, then
+ * RTU), and each section one slot per histogram group of
+ * modbus_latency_fc_t:
+ *
+ *   +0       Request count, high word
+ *   +1       Request count, low word
+ *   +2..+17  Histogram buckets (see MODBUS_LATENCY_MIN_SHIFT)
+ *   +18..+21 Mean parse, dispatch, callback and encode time in us
+ *
+ * modbus_reset_statistics() on a transport's context clears its section.
+ *
+ * The CPU load block (MODBUS_DIAG_CPU_IR_BASE) holds the last window of
+ * cpu_load.h, loads in hundredths of a percent:
+ *
+ *   +0       Load of all tasks but idle
+ *   +1       Load of the ADC1 DMA interrupt
+ *   +2       Load of the Ethernet interrupt
+ *   +3       Number of task slots in use
+ *   +4...    One slot per task: 8 registers of name, two characters
+ *            each with the first in the high byte, then its load
+ *
+ * The ADC latency block (MODBUS_DIAG_ADC_IR_BASE) holds the stage times of
+ * the ADC1 sample path since boot (BSP_ADC1_GetLatency()), one slot per
+ * bsp_adc1_latency_stage_t, from the trigger to the end of the block hook:
+ *
+ *   +0       Blocks timed, high word
+ *   +1       Blocks timed, low word
+ *   +2..+4   Minimum, mean and maximum time in 0.1 us, saturating
+ *   +5..+36  Histogram buckets (see BSP_ADC1_LATENCY_MIN_SHIFT), high
+ *            word first
+ *
+ * Times are cumulative: the interval between two reads follows from the
+ * difference of their counts and buckets.
+ */
+
+#ifndef MODBUS_DIAG_H
+#define MODBUS_DIAG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bsp.h"
+#include "cpu_load.h"
+#include "modbus.h"
+
+/** First input register of the latency block */
+#define MODBUS_DIAG_IR_BASE 0xF000U
+
+/** Registers of one histogram slot */
+#define MODBUS_DIAG_SLOT_REGS (2U + MODBUS_LATENCY_BUCKETS + 4U)
+
+/** Registers of one transport section */
+#define MODBUS_DIAG_TRANSPORT_REGS \
+    (MODBUS_DIAG_SLOT_REGS * (uint16_t)MODBUS_LATENCY_FC_COUNT)
+
+/**
+ * @brief Transports with their own latency statistics
+ */
+typedef enum
+{
+    MODBUS_DIAG_TRANSPORT_TCP = 0,
+    MODBUS_DIAG_TRANSPORT_RTU,
+    MODBUS_DIAG_TRANSPORT_COUNT
+} modbus_diag_transport_t;
+
+/** Registers of the latency block */
+#define MODBUS_DIAG_IR_COUNT \
+    (MODBUS_DIAG_TRANSPORT_REGS * (uint16_t)MODBUS_DIAG_TRANSPORT_COUNT)
+
+/** First input register of the CPU load block */
+#define MODBUS_DIAG_CPU_IR_BASE 0xF200U
+
+/** Registers of one task slot of the CPU load block */
+#define MODBUS_DIAG_CPU_TASK_REGS 9U
+
+/** Registers of the CPU load block */
+#define MODBUS_DIAG_CPU_IR_COUNT \
+    (4U + (MODBUS_DIAG_CPU_TASK_REGS * CPU_LOAD_MAX_TASKS))
+
+/** First input register of the ADC latency block */
+#define MODBUS_DIAG_ADC_IR_BASE 0xF300U
+
+/** Registers of one stage slot of the ADC latency block */
+#define MODBUS_DIAG_ADC_STAGE_REGS (5U + (2U * BSP_ADC1_LATENCY_BUCKETS))
+
+/** Registers of the ADC latency block */
+#define MODBUS_DIAG_ADC_IR_COUNT \
+    (MODBUS_DIAG_ADC_STAGE_REGS * (uint16_t)BSP_ADC1_LATENCY_COUNT)
+
+/**
+ * @brief Check whether a register block touches a diagnostic block
+ *
+ * @param[in] start_address First register
+ * @param[in] quantity      Number of registers
+ *
+ * @return true if any register of the block is diagnostic
+ */
+bool modbus_diag_overlaps(uint16_t start_address, uint16_t quantity);
+
+/**
+ * @brief Read diagnostic input registers
+ *
+ * Called with the register mutex held, like every register callback.
+ *
+ * @param[in]  start_address First register
+ * @param[in]  quantity      Number of registers
+ * @param[out] values        Register values
+ *
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS unless the whole block lies
+ *         in one diagnostic block
+ */
+modbus_exception_t modbus_diag_read_input_registers(uint16_t  start_address,
+                                                    uint16_t  quantity,
+                                                    uint16_t *values);
+
+#if MODBUS_ENABLE_LATENCY_STATS
+
+/**
+ * @brief Return the latency statistics of a transport
+ *
+ * Attached by the transport task with modbus_slave_set_latency_stats().
+ *
+ * @param[in] transport Transport
+ *
+ * @return Statistics, NULL for an unknown transport
+ */
+modbus_latency_stats_t *modbus_diag_latency_stats(
+    modbus_diag_transport_t transport);
+
+#endif /* MODBUS_ENABLE_LATENCY_STATS */
+
+#endif /* MODBUS_DIAG_H */
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus File Records
+ *
+ * The FC20 (Read File Record) reader and mapper and the FC21 (Write File
+ * Record) writer of the slave contexts. Each sub-request goes to the
+ * module that owns its file number:
+ *
+ *   File  Contents                                      Access
+ *   1     Last telemetry frame (telemetry.h)            Read
+ *   2-3   ADC capture snapshot (adc_capture.h)          Read, in place
+ *   4     Amplitude spectrum of the ADC inputs          Read
+ *         (spectrum.h)
+ *   5     Interlock events (interlock.h)                Read
+ *   6     Persistent registers (config_store.h)         Read, write
+ *   7     Range query of the archives (adc_archive.h)   Write the query,
+ *                                                       read the result
+ *
+ * The snapshot records are encoded straight out of the capture buffer, so
+ * a request of 124-record sub-requests (the most a response holds) costs
+ * no copy. Other file numbers answer with an illegal data address.
+ */
+
+#ifndef MODBUS_FILES_H
+#define MODBUS_FILES_H
+
+#include <stdint.h>
+
+#include "modbus_types.h"
+
+/**
+ * @brief Read records of a file, the FC20 file reader
+ *
+ * Set on the slave contexts with modbus_slave_set_file_reader().
+ *
+ * @param[in]  file_number   File
+ * @param[in]  record_number First record
+ * @param[in]  record_length Number of records
+ * @param[out] values        Record values
+ * @return The exception of the file's reader, or
+ *         MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS for an unknown file
+ */
+modbus_exception_t modbus_files_read_record(uint16_t  file_number,
+                                            uint16_t  record_number,
+                                            uint16_t  record_length,
+                                            uint16_t *values);
+
+/**
+ * @brief Locate records of a file held in memory, the FC20 file mapper
+ *
+ * Set on the slave contexts with modbus_slave_set_file_mapper().
+ *
+ * @param[in] file_number   File
+ * @param[in] record_number First record
+ * @param[in] record_length Number of records
+ * @return The records, or NULL to have modbus_files_read_record() read
+ *         them
+ */
+const uint16_t *modbus_files_map_record(uint16_t file_number,
+                                        uint16_t record_number,
+                                        uint16_t record_length);
+
+/**
+ * @brief Write records of a file, the FC21 file writer
+ *
+ * Set with modbus_slave_set_file_writer() on the contexts that take
+ * writes.
+ *
+ * @param[in] file_number   File
+ * @param[in] record_number First record
+ * @param[in] record_length Number of records
+ * @param[in] values        Record values
+ * @return The exception of the file's writer, or
+ *         MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS for a file not written
+ */
+modbus_exception_t modbus_files_write_record(uint16_t        file_number,
+                                             uint16_t        record_number,
+                                             uint16_t        record_length,
+                                             const uint16_t *values);
+
+#endif /* MODBUS_FILES_H */
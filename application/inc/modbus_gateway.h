@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP to RTU Gateway
+ *
+ * Requests that arrive on the Modbus TCP server for a unit ID other than
+ * those Jerry serves itself (modbus_units.h) are forwarded as RTU frames to the devices on a serial port
+ * and their responses are returned to the TCP master. Each port has its
+ * own task and request queue, so transactions on different ports run
+ * concurrently; on a port they run one at a time, as RTU requires.
+ *
+ * Forwarding does not re-encode the PDU. The request's unit ID and PDU are
+ * placed in the worker's TX buffer right behind the space of the response
+ * MBAP header, the CRC is appended and the frame is sent from there. The
+ * downstream response is read back into the same place, so only the MBAP
+ * header in front is written and the CRC behind is dropped.
+ *
+ * The gateway is opt-in: it is only used when the build sets
+ * MODBUS_GATEWAY to 1 (CMake option JERRY_MODBUS_GATEWAY). It then owns the
+ * RS-485 port, and the local RTU slave (modbus_rtu_task.h) is not started.
+ */
+
+#ifndef MODBUS_GATEWAY_H
+#define MODBUS_GATEWAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "modbus.h"
+
+#ifndef MODBUS_GATEWAY
+#define MODBUS_GATEWAY 0
+#endif
+
+/** Task notification index on which a TCP worker waits for its forward */
+#define MODBUS_GATEWAY_NOTIFY_INDEX 3U
+
+/** Requests that can wait for each port */
+#define MODBUS_GATEWAY_QUEUE_DEPTH 4U
+
+/** Downstream response timeout, from the end of the request frame */
+#define MODBUS_GATEWAY_RESPONSE_TIMEOUT_MS MODBUS_DEFAULT_RESPONSE_TIMEOUT_MS
+
+/**
+ * Space modbus_gateway_forward() needs in the response buffer: the MBAP
+ * header up to the unit ID plus a maximum-size RTU frame
+ */
+#define MODBUS_GATEWAY_BUFFER_SIZE (6U + MODBUS_RTU_MAX_ADU_SIZE)
+
+/**
+ * @brief Per-port statistics
+ */
+typedef struct
+{
+    uint32_t forwarded; /**< Requests transmitted downstream */
+    uint32_t responses; /**< Valid responses returned to the master */
+    uint32_t timeouts;  /**< Requests without a valid response in time */
+    uint32_t rejected;  /**< Requests refused because the queue was full */
+} modbus_gateway_stats_t;
+
+/**
+ * @brief Start the gateway port tasks
+ *
+ * Called by the Modbus TCP task instead of modbus_rtu_task_start(), once
+ * its units are in the unit table; their unit IDs are never forwarded.
+ */
+void modbus_gateway_start(void);
+
+/**
+ * @brief Check whether a TCP request is for a downstream device
+ *
+ * @param[in] unit_id Unit ID of the request
+ * @return true if modbus_gateway_forward() handles it
+ */
+bool modbus_gateway_is_remote(uint8_t unit_id);
+
+/**
+ * @brief Forward one MBAP request and build the MBAP response
+ *
+ * Blocks the calling TCP worker until the port has finished the
+ * transaction. A missing or corrupt downstream response, or a full port
+ * queue, is answered with the gateway exception the specification
+ * defines (0x0B target failed to respond, 0x0A path unavailable).
+ *
+ * @param[in]  request       Complete MBAP request frame
+ * @param[in]  request_len   Request length in bytes
+ * @param[out] response      Response frame buffer, at least
+ *                           MODBUS_GATEWAY_BUFFER_SIZE bytes
+ * @param[out] response_len  Response length in bytes
+ *
+ * @return MODBUS_OK if a response (possibly an exception) was built
+ */
+modbus_error_t modbus_gateway_forward(const uint8_t *request,
+                                      uint16_t request_len, uint8_t *response,
+                                      uint16_t *response_len);
+
+/**
+ * @brief Return the statistics of a port
+ *
+ * @param[in]  port  Port index
+ * @param[out] stats Destination
+ *
+ * @return true if @p port exists
+ */
+bool modbus_gateway_get_stats(uint8_t port, modbus_gateway_stats_t *stats);
+
+#endif /* MODBUS_GATEWAY_H */
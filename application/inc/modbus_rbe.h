@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus Report by Exception
+ *
+ * Instead of polling slow-changing values, a client subscribes to a block
+ * of one register table over UDP on MODBUS_RBE_PORT, and the device sends
+ * it the values whenever they change. The block is scanned every
+ * MODBUS_RBE_SCAN_MS through the same register callbacks a Modbus read
+ * uses. A register changes when it moved by more than the deadband since
+ * it was last reported (0 = any change, as for coils and discrete inputs);
+ * an update carries the span from the first to the last changed value. The
+ * whole block is also sent every refresh period, so a lost update is
+ * repaired without the client asking.
+ *
+ * A subscription lasts MODBUS_RBE_LEASE_PERIODS refresh periods; the
+ * client keeps it by sending the same subscribe again, which renews it
+ * without a refresh. A subscribe with other parameters replaces the
+ * subscription and is answered by a refresh. All fields are little-endian,
+ * register values included.
+ *
+ * Subscribe / unsubscribe, client to device (MODBUS_RBE_REQUEST_SIZE):
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, MODBUS_RBE_MAGIC ("JR")
+ *   2       1     Format version, MODBUS_RBE_VERSION
+ *   3       1     Message type, MODBUS_RBE_MSG_SUBSCRIBE or _UNSUBSCRIBE
+ *   4       1     Subscription ID, chosen by the client
+ *   5       1     Table: the Modbus read function code (1 coils, 2 discrete
+ *                 inputs, 3 holding registers, 4 input registers)
+ *   6       2     First address
+ *   8       2     Quantity
+ *   10      2     Deadband in register units (ignored for bits)
+ *   12      2     Refresh period in s, 0 = MODBUS_RBE_DEFAULT_REFRESH_S
+ *   14      2     Shortest interval between two updates in ms, 0 = none
+ *
+ * Update, device to client (MODBUS_RBE_HEADER_SIZE + values):
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic
+ *   2       1     Format version
+ *   3       1     Message type, MODBUS_RBE_MSG_CHANGE, _REFRESH or _REJECT
+ *   4       1     Subscription ID
+ *   5       1     Table
+ *   6       2     Address of the first value
+ *   8       2     Number of values
+ *   10      2     Sequence number (1 per message of the subscription)
+ *   12      4     Device uptime in ms
+ *   16      ...   Values: registers as 16-bit words, bits packed LSB first
+ *
+ * A rejected subscribe (bad block, or no free subscription) is answered
+ * with a header at its first address and without values. The deadband
+ * compares each 16-bit register on its own; blocks with 32-bit values
+ * should use 0.
+ *
+ * tools/rbe_monitor.py is the matching client.
+ */
+
+#ifndef MODBUS_RBE_H
+#define MODBUS_RBE_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef MODBUS_RBE
+#define MODBUS_RBE 1
+#endif
+
+/** UDP port subscriptions are sent to, and updates sent from */
+#define MODBUS_RBE_PORT 5021U
+
+/** Message magic: the bytes 'J', 'R' */
+#define MODBUS_RBE_MAGIC 0x524AU
+
+/** Message format version */
+#define MODBUS_RBE_VERSION 1U
+
+/** Message types */
+#define MODBUS_RBE_MSG_SUBSCRIBE   1U
+#define MODBUS_RBE_MSG_UNSUBSCRIBE 2U
+#define MODBUS_RBE_MSG_CHANGE      3U
+#define MODBUS_RBE_MSG_REFRESH     4U
+#define MODBUS_RBE_MSG_REJECT      5U
+
+/** Subscribe message size in bytes */
+#define MODBUS_RBE_REQUEST_SIZE 16U
+
+/** Update header size in bytes */
+#define MODBUS_RBE_HEADER_SIZE 16U
+
+/** Subscriptions served at the same time, over all clients */
+#define MODBUS_RBE_MAX_SUBSCRIPTIONS 16U
+
+/** Largest block of registers; bit blocks may hold 16 times as many */
+#define MODBUS_RBE_MAX_REGISTERS 64U
+
+/** Scan period of the subscribed blocks */
+#define MODBUS_RBE_SCAN_MS 10U
+
+/** Refresh period of subscriptions that leave it to the device */
+#define MODBUS_RBE_DEFAULT_REFRESH_S 10U
+
+/** Refresh periods a subscription lasts without being renewed */
+#define MODBUS_RBE_LEASE_PERIODS 3U
+
+/**
+ * @brief Start the report by exception task
+ *
+ * Called by the Modbus TCP task once the registers are initialized and the
+ * network interface is up.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ */
+void modbus_rbe_start(SemaphoreHandle_t register_mutex);
+
+#endif /* MODBUS_RBE_H */
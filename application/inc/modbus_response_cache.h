@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Response Cache
+ *
+ * Masters that poll the same read request over and over get the stored
+ * response back, with only the transaction ID patched, instead of having
+ * the register callbacks run again. Entries are keyed on (unit ID,
+ * function code, start address, quantity) of FC01-FC04 requests and stay
+ * valid for the freshness window the device grants the requested block
+ * (modbus_response_cache_ttl_ms()), and only while the version of its data
+ * (modbus_response_cache_version()) stays the one it was built from. The
+ * device's write callbacks drop all entries whenever they store anything,
+ * so a write over any transport, or from any other task, is seen by the
+ * next read.
+ *
+ * The cache is opt-in: it is only used when the build sets
+ * MODBUS_RESPONSE_CACHE to 1 (CMake option JERRY_MODBUS_RESPONSE_CACHE).
+ *
+ * None of the functions are reentrant; callers serialize them together
+ * with register access.
+ */
+
+#ifndef MODBUS_RESPONSE_CACHE_H
+#define MODBUS_RESPONSE_CACHE_H
+
+#include <stdint.h>
+
+#ifndef MODBUS_RESPONSE_CACHE
+#define MODBUS_RESPONSE_CACHE 0
+#endif
+
+/** Number of cached responses */
+#define MODBUS_RESPONSE_CACHE_ENTRIES 8U
+
+/**
+ * @brief Cache statistics
+ */
+typedef struct
+{
+    uint32_t hits;          /**< Requests answered from the cache */
+    uint32_t misses;        /**< Cacheable requests that were processed */
+    uint32_t invalidations; /**< Times all entries were dropped */
+} modbus_response_cache_stats_t;
+
+/**
+ * @brief Drop all entries and reset the statistics
+ */
+void modbus_response_cache_init(void);
+
+/**
+ * @brief Answer a request from the cache
+ *
+ * @param[in]  request       Complete MBAP request frame
+ * @param[in]  request_len   Request length in bytes
+ * @param[out] response      Response frame buffer
+ * @param[in]  response_size Size of @p response in bytes
+ *
+ * @return Length of the response copied to @p response, 0 on a miss
+ */
+uint16_t modbus_response_cache_lookup(const uint8_t *request,
+                                      uint16_t       request_len,
+                                      uint8_t       *response,
+                                      uint16_t       response_size);
+
+/**
+ * @brief Record a processed request and its response
+ *
+ * Normal read responses are stored if their block has a freshness window;
+ * any other request is ignored.
+ *
+ * @param[in] request      Complete MBAP request frame
+ * @param[in] request_len  Request length in bytes
+ * @param[in] response     Response frame built for it
+ * @param[in] response_len Response length in bytes
+ */
+void modbus_response_cache_update(const uint8_t *request,
+                                  uint16_t       request_len,
+                                  const uint8_t *response,
+                                  uint16_t       response_len);
+
+/**
+ * @brief Drop all entries
+ */
+void modbus_response_cache_invalidate(void);
+
+/**
+ * @brief Get the cache statistics
+ * @param[out] stats Destination (NULL is ignored)
+ */
+void modbus_response_cache_get_stats(modbus_response_cache_stats_t *stats);
+
+/**
+ * @brief Freshness window of a read block, provided by the device
+ *
+ * Implemented next to the register callbacks, which know how often each
+ * block changes on its own.
+ *
+ * @param[in] function_code Read function code (FC01-FC04)
+ * @param[in] start_address First address of the block
+ * @param[in] quantity      Number of coils/inputs/registers
+ *
+ * @return How long a response for this block stays valid in milliseconds,
+ *         0 if it must not be cached
+ */
+uint32_t modbus_response_cache_ttl_ms(uint8_t  function_code,
+                                      uint16_t start_address,
+                                      uint16_t quantity);
+
+/**
+ * @brief Version of the data behind a read block, provided by the device
+ *
+ * Lets a block that changes only now and then be cached for a long window:
+ * the device moves the version on whenever the data changes, and entries
+ * built from an older version miss. Blocks without one return 0.
+ *
+ * @param[in] function_code Read function code (FC01-FC04)
+ * @param[in] start_address First address of the block
+ * @param[in] quantity      Number of coils/inputs/registers
+ *
+ * @return Current version of the block's data
+ */
+uint32_t modbus_response_cache_version(uint8_t  function_code,
+                                       uint16_t start_address,
+                                       uint16_t quantity);
+
+#endif /* MODBUS_RESPONSE_CACHE_H */
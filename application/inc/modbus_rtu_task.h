@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus RTU Serial Transport
+ *
+ * Serves the Modbus register map on the RS-485 port (BSP_RS485_*), next to
+ * the Modbus TCP server and with the same unit ID. The port delimits frames
+ * in hardware, so the task only sees whole frames: it checks them with
+ * modbus_rtu_parse_frame(), dispatches the PDU and transmits the response.
+ * Broadcast requests are executed but not answered.
+ */
+
+#ifndef MODBUS_RTU_TASK_H
+#define MODBUS_RTU_TASK_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "semphr.h"
+
+/** RS-485 bit rate */
+#ifndef MODBUS_RTU_BAUDRATE
+#define MODBUS_RTU_BAUDRATE 115200U
+#endif
+
+/** RS-485 character format (::BSP_RS485_Parity), even parity per the spec */
+#ifndef MODBUS_RTU_PARITY
+#define MODBUS_RTU_PARITY BSP_RS485_PARITY_EVEN
+#endif
+
+/**
+ * @brief Start the Modbus RTU task
+ *
+ * Called by the Modbus TCP task once the registers are initialized.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ * @param[in] unit_id        Modbus slave address to answer to
+ */
+void modbus_rtu_task_start(SemaphoreHandle_t register_mutex, uint8_t unit_id);
+
+#endif /* MODBUS_RTU_TASK_H */
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus/TCP Security Transport
+ *
+ * Serves the Modbus register map over TLS on MODBUS_SECURITY_PORT, as the
+ * Modbus/TCP Security specification defines: TLS 1.2, with the master
+ * authenticated by an X.509 certificate issued by the device's CA. The
+ * MBAP frames inside the TLS stream are the same as on port 502.
+ *
+ * One master is served at a time. Full handshakes cost several ECC
+ * operations, so the server issues session tickets and also keeps a small
+ * session cache: a master that reconnects resumes its session with
+ * symmetric cryptography only. Once connected, a request costs the
+ * AES-GCM of its record and of the response on top of the plaintext
+ * server. All Mbed TLS memory, including the record buffers, is static.
+ *
+ * The transport is opt-in: it is only built when MODBUS_SECURITY is 1
+ * (CMake option JERRY_MODBUS_SECURITY, which also fetches Mbed TLS). The
+ * credentials built in are development ones, from tools/keys.
+ */
+
+#ifndef MODBUS_SECURITY_H
+#define MODBUS_SECURITY_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef MODBUS_SECURITY
+#define MODBUS_SECURITY 0
+#endif
+
+/** TCP port of Modbus/TCP Security */
+#define MODBUS_SECURITY_PORT 802U
+
+/** Lifetime of a session ticket, and of a cached session */
+#define MODBUS_SECURITY_TICKET_LIFETIME_S 86400U
+
+/**
+ * @brief Start the Modbus/TCP Security task
+ *
+ * Called by the Modbus TCP task once the registers are initialized.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ * @param[in] unit_id        Modbus unit ID to answer to
+ */
+void modbus_security_start(SemaphoreHandle_t register_mutex, uint8_t unit_id);
+
+#endif /* MODBUS_SECURITY_H */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Server on the lwIP Raw API
+ *
+ * An alternative to the netconn server of the Modbus TCP task for port 502.
+ * The netconn server hands every received segment from the TCP/IP thread
+ * to a connection worker and every response back, two context switches
+ * and two mailbox posts per request. This server registers tcp_recv()
+ * callbacks instead: the request is processed in the TCP/IP thread,
+ * straight from the received pbuf, and the response is queued with
+ * tcp_write() and sent in the same callback, with no task switch at all.
+ * This suits masters polling at a high rate on few connections.
+ *
+ * Requests are routed, admitted and shed exactly as by the netconn server
+ * (modbus_units.h, modbus_admission.h) and reach the same unit contexts
+ * under the same register mutex. The wait for the mutex is bounded, as for
+ * Modbus/UDP (modbus_udp.h), so a stuck holder costs requests, answered
+ * with exception 06 (SLAVE DEVICE BUSY), not the network stack. Requests
+ * are served in the order they arrive; with every request in one thread
+ * the read gate of the netconn server has nothing to order.
+ *
+ * A connection is a record of about 300 bytes, mostly its receive buffer,
+ * and an lwIP PCB, where a netconn worker needs a 2 KiB stack and a task
+ * control block, so the server takes many more masters than the four
+ * workers: MODBUS_TCP_RAW_MAX_CONNECTIONS, 16 by default (CMake
+ * JERRY_MODBUS_TCP_RAW_CONNECTIONS), for which lwipopts.h sizes
+ * MEMP_NUM_TCP_PCB through MODBUS_TCP_PCBS. Connections beyond it evict
+ * the least recently used idle one, and idle connections are closed, on
+ * the same timeouts as the netconn server.
+ *
+ * The gateway (modbus_gateway.h) blocks for a serial transaction, which the
+ * TCP/IP thread must not, so it needs the netconn server. For the same
+ * reason the device unit queues digital output writes here instead of
+ * waiting for the I2C expanders (modbus_units_tcpip_callbacks,
+ * modbus_units.h). This server is built instead of it when MODBUS_TCP_RAW
+ * is 1 (CMake option JERRY_MODBUS_TCP_RAW).
+ */
+
+#ifndef MODBUS_TCP_RAW_H
+#define MODBUS_TCP_RAW_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef MODBUS_TCP_RAW
+#define MODBUS_TCP_RAW 0
+#endif
+
+/** Maximum number of simultaneous connections; at most MODBUS_TCP_PCBS */
+#ifndef MODBUS_TCP_RAW_MAX_CONNECTIONS
+#define MODBUS_TCP_RAW_MAX_CONNECTIONS 16U
+#endif
+
+/**
+ * @brief Listen on the Modbus TCP port
+ *
+ * Called by the Modbus TCP task once the unit table is filled and the
+ * network interface is up, in place of its netconn server. Sets
+ * BOOT_EVENT_SERVICE_UP once listening.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ */
+void modbus_tcp_raw_start(SemaphoreHandle_t register_mutex);
+
+#endif /* MODBUS_TCP_RAW_H */
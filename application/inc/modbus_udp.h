@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus/UDP Transport
+ *
+ * Serves the Modbus register map as MBAP frames in UDP datagrams on
+ * MODBUS_UDP_PORT, one request per datagram. Without connections there is
+ * no accept, no ACK and no worker hand-off: the request is processed in
+ * lwIP's receive callback, straight from the received pbuf, and the
+ * response goes back in the same pass. This suits masters polling a few
+ * registers at a high rate.
+ *
+ * A datagram may be lost, so masters retry with the same transaction ID.
+ * The last write of each master (MODBUS_UDP_MAX_MASTERS, by address and
+ * port) is remembered with its response; a retry of it gets that response
+ * again instead of being executed twice. Reads are idempotent and always
+ * run.
+ *
+ * Digital output coil writes are queued for the output executor and
+ * answered before the I2C expanders change, as the TCP/IP thread must not
+ * wait for them (modbus_units.h).
+ *
+ * The transport is built when MODBUS_UDP is 1 (CMake option
+ * JERRY_MODBUS_UDP).
+ */
+
+#ifndef MODBUS_UDP_H
+#define MODBUS_UDP_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef MODBUS_UDP
+#define MODBUS_UDP 1
+#endif
+
+/** UDP port of Modbus/UDP */
+#define MODBUS_UDP_PORT 502U
+
+/** Masters whose last write is remembered for retries */
+#define MODBUS_UDP_MAX_MASTERS 4U
+
+/**
+ * @brief Bind the Modbus/UDP port
+ *
+ * Called by the Modbus TCP task once the registers are initialized and the
+ * network interface is up.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ * @param[in] unit_id        Modbus unit ID to answer to
+ */
+void modbus_udp_start(SemaphoreHandle_t register_mutex, uint8_t unit_id);
+
+#endif /* MODBUS_UDP_H */
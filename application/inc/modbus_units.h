@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Units
+ *
+ * The Modbus TCP server answers for several unit IDs, so one device can
+ * appear to a master as a set of logically separate slaves. Each unit has
+ * its own slave context, bound to its own callback table
+ * (modbus_slave_set_callbacks()), device identification and file reader.
+ * The unit ID of a request selects the context through a 256-entry lookup
+ * array, one load per request whatever the number of units.
+ *
+ * Routing needs nothing but the unit ID byte of the 7-byte MBAP header.
+ * The server looks at it before a frame is reassembled, cached or parsed:
+ * a frame for a unit not in the table, and not forwarded by the gateway
+ * (modbus_gateway.h), is skipped in the receive stream without being copied
+ * and counted as METRIC_MODBUS_UNIT_DROP.
+ *
+ * The table is filled once by the Modbus TCP task before the first
+ * connection is served and read without a lock after that. Broadcast
+ * requests (unit ID 0) go to the first unit added.
+ *
+ * Two units are served:
+ *
+ *   Unit                 ID                                   Callbacks
+ *   Device               MODBUS_UNIT_ID_BASE + DEVADDR        modbus_cb_*
+ *   Monitor (optional)   device + MODBUS_UNITS_MONITOR_OFFSET read-only
+ *
+ * The monitor unit serves the same register map read-only: every write is
+ * answered with ILLEGAL_FUNCTION, so a supervisory master can be given
+ * access that cannot change outputs or settings. It is only served when
+ * the build sets MODBUS_MONITOR_UNIT to 1 (CMake option
+ * JERRY_MODBUS_MONITOR_UNIT).
+ *
+ * Transports that serve requests in the TCP/IP thread, Modbus/UDP
+ * (modbus_udp.h) and the raw API server (modbus_tcp_raw.h), use
+ * modbus_units_tcpip_callbacks for the device instead of modbus_cb_*. A
+ * digital output write of modbus_cb_* waits for the I2C expander commit,
+ * up to BSP_I2CDO_TIMEOUT, which would stall all of lwIP there, so FC05
+ * and FC15 writes hand the digital outputs to the output executor
+ * (do_schedule_write(), do_schedule.h) and are answered once they are
+ * queued, before the expanders change. A full queue is answered with
+ * SLAVE_DEVICE_BUSY. Every other access is that of modbus_cb_*.
+ */
+
+#ifndef MODBUS_UNITS_H
+#define MODBUS_UNITS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "modbus.h"
+
+#ifndef MODBUS_MONITOR_UNIT
+#define MODBUS_MONITOR_UNIT 0
+#endif
+
+/** Units the table can hold */
+#define MODBUS_UNITS_MAX 4U
+
+/** Distance of the unit ID of the monitor unit from the device's */
+#define MODBUS_UNITS_MONITOR_OFFSET 128U
+
+/**
+ * @brief One unit of the table
+ */
+typedef struct
+{
+    uint8_t           unit_id; /**< Unit ID, used in its responses */
+    uint8_t           index;   /**< Position in the table, from 0 */
+    modbus_context_t *ctx;     /**< Slave context serving it */
+} modbus_unit_t;
+
+/** Data callbacks of the monitor unit: the reads of modbus_cb_*, writes
+ *  refused */
+extern const modbus_slave_callbacks_t modbus_units_monitor_callbacks;
+
+/** Data callbacks of the device for a transport in the TCP/IP thread: those
+ *  of modbus_cb_*, digital output writes queued */
+extern const modbus_slave_callbacks_t modbus_units_tcpip_callbacks;
+
+/**
+ * @brief Add a unit to the table
+ *
+ * Modbus TCP task only, before the first connection is served.
+ *
+ * @param[in] unit_id Unit ID, 1-255
+ * @param[in] ctx     Initialized slave context serving it; must stay valid
+ * @return false if @p unit_id is 0 or already in the table, or the table
+ *         is full
+ */
+bool modbus_units_add(uint8_t unit_id, modbus_context_t *ctx);
+
+/**
+ * @brief Look up the unit a request is for
+ *
+ * @param[in] unit_id Unit ID of the request, 0 for a broadcast
+ * @return The unit, NULL if none here serves @p unit_id
+ */
+const modbus_unit_t *modbus_units_lookup(uint8_t unit_id);
+
+#endif /* MODBUS_UNITS_H */
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * MQTT Publisher
+ *
+ * Publishes the node's data to an MQTT 3.1.1 broker, for cloud and plant
+ * systems that subscribe rather than poll. Every period_ms, each topic is
+ * sent as one PUBLISH holding all of its values, a JSON object:
+ *
+ *   jerry/<id>/telemetry  {"uptime_ms":u,"ch":[v,...],"di":b}
+ *                         filtered value of every channel, V, and the
+ *                         debounced digital inputs, bit n = DI n
+ *   jerry/<id>/stats      {"updates":u,"ch":[[[min,max,mean,rms],...],...]}
+ *                         figures of every channel over the windows of
+ *                         adc_stats.h, 1 s, 10 s and 1 min, V
+ *   jerry/<id>/events     {"uptime_ms":u,"changes":[{"ch":n,"v":v},...],
+ *                         "di":b}
+ *                         the channels that changed by more than their
+ *                         deadband (adc_change.h) since the last one, and
+ *                         the digital inputs; sent only when a channel or
+ *                         an input changed
+ *
+ * <id> is the last three bytes of the MAC address in hex, and the client
+ * identifier is "jerry-<id>". Values are written with 0.1 mV resolution.
+ *
+ * Bit n of qos_mask sends topic n (mqtt_client_topic_t) at QoS 1: the
+ * data of a topic published is kept until the broker acknowledges it and
+ * is sent again, as a duplicate, after a reconnect; no new data is taken
+ * for that topic meanwhile, so the events of that time are merged into the
+ * next message. QoS 0 topics are sent once, and a period that finds no
+ * room in the send buffer is skipped.
+ *
+ * A lost connection is opened again after a backoff that starts at
+ * MQTT_CLIENT_BACKOFF_MIN_MS, doubles per failure up to
+ * MQTT_CLIENT_BACKOFF_MAX_MS and is spread by a random part, so a plant of
+ * nodes does not reconnect to a restarted broker in step. The session is
+ * clean and the client does not subscribe; no username or TLS.
+ *
+ * The publisher is built when MQTT_CLIENT is 1 (CMake option
+ * JERRY_MQTT_CLIENT).
+ */
+
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <stdint.h>
+
+#ifndef MQTT_CLIENT
+#define MQTT_CLIENT 0
+#endif
+
+/** Default broker TCP port */
+#define MQTT_CLIENT_DEFAULT_PORT 1883U
+
+/** Shortest and longest publish period */
+#define MQTT_CLIENT_MIN_PERIOD_MS 100U
+#define MQTT_CLIENT_MAX_PERIOD_MS 60000U
+
+/** Default and longest keepalive in seconds */
+#define MQTT_CLIENT_DEFAULT_KEEPALIVE_S 60U
+#define MQTT_CLIENT_MAX_KEEPALIVE_S     3600U
+
+/** Backoff before a reconnect: first and longest */
+#define MQTT_CLIENT_BACKOFF_MIN_MS 1000U
+#define MQTT_CLIENT_BACKOFF_MAX_MS 60000U
+
+/**
+ * @brief Topics, and their bits in qos_mask
+ */
+typedef enum
+{
+    MQTT_CLIENT_TOPIC_TELEMETRY = 0, /**< Channel values and inputs */
+    MQTT_CLIENT_TOPIC_STATS,         /**< Windowed statistics */
+    MQTT_CLIENT_TOPIC_EVENTS,        /**< Changes of value */
+    MQTT_CLIENT_TOPIC_COUNT          /**< Number of topics */
+} mqtt_client_topic_t;
+
+/**
+ * @brief Publisher configuration
+ *
+ * The client connects while @c period_ms, @c broker_addr and
+ * @c broker_port are non-zero.
+ */
+typedef struct
+{
+    uint16_t period_ms;   /**< Publish period, 0 = off */
+    uint32_t broker_addr; /**< Broker IPv4 address, a.b.c.d as 0xaabbccdd */
+    uint16_t broker_port; /**< Broker TCP port */
+    uint8_t  qos_mask;    /**< Bit n set: topic n at QoS 1, else QoS 0 */
+    uint16_t keepalive_s; /**< Keepalive of the connection, 0 = none */
+} mqtt_client_config_t;
+
+/**
+ * @brief Apply a new publisher configuration
+ *
+ * Safe to call from any task. A change of broker or keepalive closes the
+ * connection and opens a new one at once.
+ *
+ * @param[in] config New configuration (copied); NULL is ignored.
+ */
+void mqtt_client_set_config(const mqtt_client_config_t *config);
+
+#if MQTT_CLIENT
+
+/**
+ * @brief Start the MQTT publish task
+ *
+ * Called by the Modbus TCP task once the registers are initialized and the
+ * network interface is up.
+ */
+void mqtt_client_start(void);
+
+#endif /* MQTT_CLIENT */
+
+#endif /* MQTT_CLIENT_H */
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Message Bus
+ *
+ * Publish/subscribe between tasks without copying the payload. A topic is
+ * declared statically with MSG_BUS_TOPIC_DEFINE() and owns a block pool
+ * (block_pool.h) of messages of one payload type. A producer loans a
+ * message from the topic, fills its payload in place and publishes it: the
+ * message is handed by reference to every subscriber of the topic, one
+ * pointer per subscriber queue, and goes back to the pool once the last of
+ * them has released it. A block of samples fanned out to N consumers costs
+ * one write and N queue posts.
+ *
+ * A subscriber is a FreeRTOS queue of message pointers, declared with
+ * MSG_BUS_SUBSCRIBER_DEFINE(), owned by the one task that receives from it.
+ * It may subscribe to several topics and tell their messages apart with
+ * msg_bus_topic(). Publishing never blocks: a subscriber whose queue is
+ * full misses the message, counted per topic and as METRIC_MSG_BUS_DROP.
+ * A topic with no free message refuses the loan, counted in its pool
+ * statistics, so a subscriber that holds on to messages starves only its
+ * own topics.
+ *
+ * Loans, publishing and releases are callable from tasks and from
+ * interrupt handlers (msg_bus_publish_from_isr()). Subscriptions are set
+ * up once, before the first message of the topic is published.
+ *
+ * Usage:
+ *
+ *   MSG_BUS_TOPIC_DEFINE(s_block_topic, sample_block_t, 4U);
+ *   MSG_BUS_SUBSCRIBER_DEFINE(s_stats_sub, 4U);
+ *
+ *   msg_bus_topic_init(&s_block_topic);
+ *   msg_bus_subscriber_init(&s_stats_sub);
+ *   (void)msg_bus_subscribe(&s_block_topic, &s_stats_sub);
+ *
+ *   msg_bus_msg_t *msg = msg_bus_loan(&s_block_topic);  (producer)
+ *   sample_block_t *block = msg_bus_payload(msg);
+ *   ...
+ *   msg_bus_publish(msg);
+ *
+ *   msg_bus_msg_t *msg = msg_bus_receive(&s_stats_sub, portMAX_DELAY);
+ *   ...                                                 (subscriber)
+ *   msg_bus_release(msg);
+ */
+
+#ifndef MSG_BUS_H
+#define MSG_BUS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "block_pool.h"
+#include "queue.h"
+
+/** Subscribers a topic can have */
+#define MSG_BUS_MAX_SUBSCRIBERS 4U
+
+typedef struct msg_bus_topic msg_bus_topic_t;
+
+/**
+ * @brief Header of a message, followed by its payload
+ */
+typedef struct
+{
+    msg_bus_topic_t *topic; /**< Topic the message belongs to */
+    atomic_uint      refs;  /**< Holders: subscribers and the publisher */
+} msg_bus_msg_t;
+
+/**
+ * @brief Subscriber queue
+ *
+ * Declared with MSG_BUS_SUBSCRIBER_DEFINE().
+ */
+typedef struct
+{
+    QueueHandle_t   queue;        /**< Pending messages */
+    StaticQueue_t   queue_buffer; /**< Queue control block */
+    msg_bus_msg_t **storage;      /**< depth message pointers */
+    uint16_t        depth;        /**< Messages the queue holds */
+} msg_bus_subscriber_t;
+
+/**
+ * @brief Topic
+ *
+ * Declared with MSG_BUS_TOPIC_DEFINE().
+ */
+struct msg_bus_topic
+{
+    block_pool_t          pool;             /**< Messages, named after it */
+    size_t                payload_offset;   /**< Payload from message start */
+    msg_bus_subscriber_t *subscribers[MSG_BUS_MAX_SUBSCRIBERS];
+    uint8_t               subscriber_count; /**< Entries in subscribers */
+    atomic_uint           published;        /**< Messages published */
+    atomic_uint           dropped;          /**< Deliveries missed */
+};
+
+/**
+ * @brief Statistics of one topic
+ */
+typedef struct
+{
+    block_pool_stats_t messages;  /**< Message pool; failures are refused
+                                       loans */
+    uint32_t           published; /**< Messages published */
+    uint32_t           dropped;   /**< Deliveries missed on a full queue */
+} msg_bus_topic_stats_t;
+
+/**
+ * @brief Define a static topic of @p count messages of @p payload_type
+ */
+#define MSG_BUS_TOPIC_DEFINE(topic_name, payload_type, count)            \
+    typedef struct                                                       \
+    {                                                                    \
+        msg_bus_msg_t msg;                                               \
+        payload_type  payload;                                           \
+    } topic_name##_block_t;                                              \
+    _Static_assert(((count) > 0U) && ((count) <= BLOCK_POOL_MAX_BLOCKS), \
+                   "topic " #topic_name " has too many messages");       \
+    static topic_name##_block_t topic_name##_blocks[(count)];            \
+    static uint16_t             topic_name##_links[(count)];             \
+    static msg_bus_topic_t      topic_name = {                           \
+        .pool = BLOCK_POOL_INIT(#topic_name, topic_name##_blocks,        \
+                                topic_name##_links),                     \
+        .payload_offset = offsetof(topic_name##_block_t, payload),       \
+    }
+
+/**
+ * @brief Define a static subscriber queue of @p queue_depth messages
+ */
+#define MSG_BUS_SUBSCRIBER_DEFINE(sub_name, queue_depth)           \
+    static msg_bus_msg_t       *sub_name##_storage[(queue_depth)]; \
+    static msg_bus_subscriber_t sub_name = {                       \
+        .storage = sub_name##_storage,                             \
+        .depth   = (uint16_t)(queue_depth),                        \
+    }
+
+/**
+ * @brief Make every message of a topic free
+ *
+ * Once, before the topic is used.
+ *
+ * @param[in,out] topic Topic
+ */
+void msg_bus_topic_init(msg_bus_topic_t *topic);
+
+/**
+ * @brief Create the queue of a subscriber
+ *
+ * Once, before the subscriber subscribes.
+ *
+ * @param[in,out] sub Subscriber
+ */
+void msg_bus_subscriber_init(msg_bus_subscriber_t *sub);
+
+/**
+ * @brief Deliver the messages of a topic to a subscriber
+ *
+ * Before the first message of @p topic is published.
+ *
+ * @param[in,out] topic Topic
+ * @param[in]     sub   Initialized subscriber
+ * @return false if the topic has MSG_BUS_MAX_SUBSCRIBERS already
+ */
+bool msg_bus_subscribe(msg_bus_topic_t *topic, msg_bus_subscriber_t *sub);
+
+/**
+ * @brief Loan a message of a topic to fill
+ *
+ * Any context, never blocks. The message must then be published.
+ *
+ * @param[in,out] topic Topic
+ * @return The message, or NULL if all messages of @p topic are out
+ */
+msg_bus_msg_t *msg_bus_loan(msg_bus_topic_t *topic);
+
+/**
+ * @brief Payload of a message
+ *
+ * @param[in] msg Message
+ * @return Its payload, of the type of its topic
+ */
+void *msg_bus_payload(msg_bus_msg_t *msg);
+
+/**
+ * @brief Topic of a message
+ *
+ * @param[in] msg Message
+ * @return The topic it was loaned from
+ */
+const msg_bus_topic_t *msg_bus_topic(const msg_bus_msg_t *msg);
+
+/**
+ * @brief Publish a loaned message to the subscribers of its topic
+ *
+ * Task context, never blocks. The publisher must not touch @p msg
+ * afterwards.
+ *
+ * @param[in] msg Loaned, filled message
+ */
+void msg_bus_publish(msg_bus_msg_t *msg);
+
+/**
+ * @brief Publish a loaned message from an interrupt handler
+ *
+ * As msg_bus_publish().
+ *
+ * @param[in]  msg                         Loaned, filled message
+ * @param[out] higher_priority_task_woken  Set to pdTRUE if a subscriber of
+ *                                         higher priority was woken
+ */
+void msg_bus_publish_from_isr(msg_bus_msg_t *msg,
+                              BaseType_t    *higher_priority_task_woken);
+
+/**
+ * @brief Wait for the next message of a subscriber
+ *
+ * Task of the subscriber only.
+ *
+ * @param[in] sub     Subscriber
+ * @param[in] timeout Ticks to wait at most
+ * @return The message, to be released with msg_bus_release(), or NULL on
+ *         timeout
+ */
+msg_bus_msg_t *msg_bus_receive(msg_bus_subscriber_t *sub, TickType_t timeout);
+
+/**
+ * @brief Release a received message
+ *
+ * Any context. The message goes back to its topic once every subscriber
+ * it was delivered to has released it.
+ *
+ * @param[in] msg Received message
+ */
+void msg_bus_release(msg_bus_msg_t *msg);
+
+/**
+ * @brief Read the statistics of a topic
+ *
+ * @param[in]  topic Topic
+ * @param[out] stats Receives the statistics
+ */
+void msg_bus_get_stats(const msg_bus_topic_t *topic,
+                       msg_bus_topic_stats_t *stats);
+
+#endif /* MSG_BUS_H */
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Network Bring-up Cache
+ *
+ * Cuts the time from link-up to serving after a power blip, when the DHCP
+ * server, the switch and the SCADA master still know this node, by keeping
+ * what the last boot learned in persistent holding registers (group
+ * net_cache of jerry_registers.json, saved by config_store.h):
+ *
+ *   Lease   net_lease_ip_high/_low, the address of the last DHCP lease.
+ *           With DHCP (USE_DHCP), the next boot asks for it straight away
+ *           with the DHCPREQUEST of INIT-REBOOT (RFC 2131 4.3.2), one
+ *           round trip instead of DISCOVER, OFFER, REQUEST and ACK. A
+ *           server that NAKs it, or no answer in lwIP's reboot tries,
+ *           falls back to a DISCOVER. The ARP probe of a new address is
+ *           left out (DHCP_DOES_ARP_CHECK 0, lwipopts.h), it costs a
+ *           second.
+ *   Master  net_master_ip_high/_low, the SCADA master, set by the user,
+ *           and net_master_mac_high/_mid/_low, its MAC. From the moment
+ *           the link is up with an address the master has a static ARP
+ *           entry for NET_CACHE_MASTER_HOLD_MS, so the first replies to
+ *           it go out without an ARP exchange; the entry is then dropped
+ *           and the master resolved as any peer. Every
+ *           NET_CACHE_LEARN_MS, a resolved MAC other than the one cached
+ *           is saved.
+ *
+ * From the same moment NET_CACHE_ANNOUNCE_COUNT gratuitous ARPs go out,
+ * NET_CACHE_ANNOUNCE_MS apart, after the one lwIP sends, which a switch
+ * port still coming up may drop; peers that cached this node update their
+ * entry instead of timing out on it.
+ *
+ * A new lease or MAC is written into the registers by the Ethernet task
+ * (net_cache_poll()) through the Modbus write callback under the register
+ * mutex, so it is stored as a client write would be; both change rarely,
+ * the flash sees about one record per change of server or NIC.
+ */
+
+#ifndef NET_CACHE_H
+#define NET_CACHE_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "lwip/err.h"
+#include "lwip/netif.h"
+#include "semphr.h"
+
+/** Gratuitous ARPs after lwIP's own, and their spacing */
+#define NET_CACHE_ANNOUNCE_COUNT 3U
+#define NET_CACHE_ANNOUNCE_MS    250U
+
+/** Lifetime of the static ARP entry of the master */
+#define NET_CACHE_MASTER_HOLD_MS 5000U
+
+/** Period of the check of the master's MAC */
+#define NET_CACHE_LEARN_MS 10000U
+
+/** Longest wait of net_cache_poll() for the register mutex */
+#define NET_CACHE_LOCK_WAIT_MS 10U
+
+/**
+ * @brief Cached network state, as held by the registers
+ *
+ * Addresses are IPv4, a.b.c.d as 0xaabbccdd, 0 for none.
+ */
+typedef struct
+{
+    uint32_t lease_addr;    /**< Address of the last DHCP lease */
+    uint32_t master_addr;   /**< SCADA master */
+    uint8_t  master_mac[6]; /**< MAC of the master, all 0 if unknown */
+} net_cache_config_t;
+
+/**
+ * @brief Apply the cached state of the registers
+ *
+ * Called by the holding register write callback, which the config store
+ * restores the saved values through at boot. Safe to call from any task.
+ *
+ * @param[in] config New state (copied); NULL is ignored.
+ */
+void net_cache_set_config(const net_cache_config_t *config);
+
+/**
+ * @brief Give the cache the register mutex
+ *
+ * Called by the Modbus TCP task once the mutex exists; nothing is saved
+ * before.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ */
+void net_cache_start(SemaphoreHandle_t register_mutex);
+
+/**
+ * @brief Start DHCP, from INIT-REBOOT if a lease is cached
+ *
+ * Called in place of dhcp_start() with the TCP/IP core lock held, once the
+ * saved registers are restored (BOOT_EVENT_CONFIG).
+ *
+ * @param[in] netif Interface to configure
+ * @return Result of dhcp_start()
+ */
+err_t net_cache_dhcp_start(struct netif *netif);
+
+/**
+ * @brief Follow the link and address of the interface
+ *
+ * The status callback of the interface, also called by its link callback;
+ * TCP/IP thread or core lock.
+ *
+ * @param[in] netif Interface changed
+ */
+void net_cache_netif_changed(struct netif *netif);
+
+/**
+ * @brief Write a new lease or master MAC into the registers
+ *
+ * Called by the Ethernet task on each pass of its loop; does nothing while
+ * the registers hold what was learned.
+ */
+void net_cache_poll(void);
+
+#endif /* NET_CACHE_H */
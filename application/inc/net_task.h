@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ */
+
+#ifndef NET_TASK_H
+#define NET_TASK_H
+
+/**
+ * @brief Bring the lwIP stack and the network interface up
+ *
+ * Starts the TCP/IP thread and the Ethernet task, configures the address
+ * (static from DEVADDR, or DHCP), starts the TWAMP Light reflector
+ * (twamp_reflector.h) and deletes itself.
+ */
+void vNetworkTask(void *pvParameters);
+
+#endif /* NET_TASK_H */
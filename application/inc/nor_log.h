@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * SPI NOR Flash Circular Sample and Event Logger
+ *
+ * Keeps the recent history of the node on the external SPI NOR flash
+ * (BSP_SPINOR), so that a historian which lost the network can fetch what
+ * it missed once it is back. Two kinds of record are kept: sample frames,
+ * the mean of each channel's filtered output over NOR_LOG_FRAME_MS, and
+ * events, the interlock trips and resets and the anomaly alarms. At 10
+ * frames a second a 16 MB flash holds about 16 hours of samples.
+ *
+ * The capture job (NorLog, cyclic_exec.h) averages the decimated stream
+ * into frames and packs them into pages; a full page is queued for the
+ * writer task (NorWrite) without waiting, and a page that finds the queue
+ * full is dropped and counted in METRIC_NOR_LOG_LOST. The writer programs
+ * the pages by DMA, one flash page each, and adds a page of events when
+ * enough are pending or the oldest has waited NOR_LOG_EVENT_FLUSH_MS.
+ *
+ * The flash is a ring of sectors, written page by page from page 0 of a
+ * sector to its end. The writer keeps the next NOR_LOG_ERASE_AHEAD sectors
+ * erased, starting each erase as soon as the previous one ends while it
+ * goes on writing, so a page never waits for an erase; this keeps at
+ * least that many sectors of old data out of reach. At start the writer
+ * reads the header of every sector into a RAM index, the sector sequence
+ * and the time of its first page, and continues after the last page
+ * written. All fields are little-endian; tools/nor_log_reader.py decodes
+ * a back-fill or a flash image. With the archives built (adc_archive.h)
+ * the log leaves them the top ADC_ARCHIVE_SECTORS sectors of the flash,
+ * and they make their flash calls under its mutex too.
+ *
+ * Sector header, page 0 of a sector:
+ *
+ *   Offset  Size  Field
+ *   0       4     Magic, NOR_LOG_MAGIC ("JNOR")
+ *   4       2     Format version, NOR_LOG_VERSION
+ *   6       2     Header size in bytes, NOR_LOG_HEADER_SIZE
+ *   8       4     Sector sequence, counting up over the life of the flash
+ *   12      4     Sector size in bytes
+ *   16      2     Page size in bytes
+ *   18      2     Data page header size in bytes
+ *   20      1     Channels per sample frame
+ *   21      1     Reserved, 0
+ *   22      2     Frame period in ms
+ *   24      4     Sectors in the log
+ *   28      2     Reserved, 0
+ *   30      2     CRC-16/MODBUS of bytes 0-29
+ *
+ * Data pages, pages 1 to the end of the sector:
+ *
+ *   Offset  Size  Field
+ *   0       4     Sector sequence; 0xFFFFFFFF for an erased page
+ *   4       1     Page type, NOR_LOG_PAGE_SAMPLES or NOR_LOG_PAGE_EVENTS
+ *   5       1     Records in the page n
+ *   6       2     Records lost just before this page (saturated)
+ *   8       8     Time of the first record, ns on the PTP timescale
+ *   16      4     Sample pages: sample sequence of the first frame;
+ *                 event pages: number of the first event since boot
+ *   20      4     Sample pages: sample sequence spacing of the frames,
+ *                 the samples of NOR_LOG_FRAME_MS at the rate in force;
+ *                 event pages: reserved, 0
+ *   24            Records, n of them
+ *   254     2     CRC-16/MODBUS of bytes 0-253
+ *
+ * A sample record is the six channel means, float32 volts each; frame k
+ * of a page starts k times the spacing of bytes 20-23 samples, and k times
+ * the frame period, after the first. A gap in the acquisition or a change
+ * of the sample rate starts a new page. An event record is 16 bytes:
+ *
+ *   Offset  Size  Field
+ *   0       8     Time, ns on the PTP timescale
+ *   8       1     Source, nor_log_source_t
+ *   9       1     Kind: interlock_event_kind_t, or 1 raised / 0 cleared
+ *   10      2     Interlock rule or anomaly channel
+ *   12      4     Value: interlock input in mV, or anomaly score
+ *
+ * A page whose CRC fails, from a program cut short by a reset, is
+ * skipped by readers, as is a page of a sector sequence other than its
+ * sector's.
+ *
+ * Back-fill: a client connects to NOR_LOG_PORT and sends one request:
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, NOR_LOG_FILL_MAGIC ("JB")
+ *   2       1     Version, NOR_LOG_VERSION
+ *   3       1     Reserved, 0
+ *   4       8     Start time in ns, 0 for the oldest page kept
+ *   12      8     End time in ns, 0 for the newest page
+ *   20      4     Reserved, 0
+ *
+ * The reply is a NOR_LOG_FILL_HEADER_SIZE header, then, if the status is
+ * NOR_LOG_FILL_OK, the data pages as they are on the flash, oldest first,
+ * from the last page starting at or before the start time up to the last
+ * one starting at or before the end time; the node then closes the
+ * connection.
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, NOR_LOG_FILL_MAGIC
+ *   2       1     Version, NOR_LOG_VERSION
+ *   3       1     Status, nor_log_fill_status_t
+ *   4       2     Page size in bytes
+ *   6       2     Pages per sector
+ *   8       4     Sectors in the log
+ *   12      2     Frame period in ms
+ *   14      2     Reserved, 0
+ *   16      8     Time of the oldest page kept, ns, 0 if none
+ *   24      8     Time of the newest page, ns, 0 if none
+ *
+ * The server reads the flash in NOR_LOG_FILL_PAGES chunks between the
+ * writer's calls and runs at the lowest application priority, so a
+ * back-fill slows neither the acquisition nor the logging.
+ */
+
+#ifndef NOR_LOG_H
+#define NOR_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_coefficients.h"
+#include "bsp.h"
+
+/** Sector header magic: the bytes 'J', 'N', 'O', 'R' */
+#define NOR_LOG_MAGIC 0x524F4E4AUL
+
+/** Format version */
+#define NOR_LOG_VERSION 1U
+
+/** Sector header size in bytes */
+#define NOR_LOG_HEADER_SIZE 32U
+
+/** Data page header size in bytes */
+#define NOR_LOG_PAGE_HEADER_SIZE 24U
+
+/** Offset of the CRC in a data page */
+#define NOR_LOG_PAGE_CRC_OFFSET 254U
+
+/** Data page types */
+#define NOR_LOG_PAGE_SAMPLES 1U
+#define NOR_LOG_PAGE_EVENTS  2U
+
+/** Period of a sample frame */
+#define NOR_LOG_FRAME_MS 100U
+
+/** Sample record size: one float32 per channel */
+#define NOR_LOG_FRAME_SIZE (BSP_ADC1_NUM_CHANNELS * 4U)
+
+/** Sample frames per page */
+#define NOR_LOG_FRAMES_PER_PAGE \
+    ((NOR_LOG_PAGE_CRC_OFFSET - NOR_LOG_PAGE_HEADER_SIZE) / NOR_LOG_FRAME_SIZE)
+
+/** Event record size */
+#define NOR_LOG_EVENT_SIZE 16U
+
+/** Event records per page */
+#define NOR_LOG_EVENTS_PER_PAGE \
+    ((NOR_LOG_PAGE_CRC_OFFSET - NOR_LOG_PAGE_HEADER_SIZE) / NOR_LOG_EVENT_SIZE)
+
+/** Longest time an event waits for a page of its own */
+#define NOR_LOG_EVENT_FLUSH_MS 1000U
+
+/** Sectors kept erased ahead of the one being written */
+#define NOR_LOG_ERASE_AHEAD 2U
+
+/** TCP port of the back-fill server */
+#define NOR_LOG_PORT 5011U
+
+/** Back-fill request and reply magic: the bytes 'J', 'B' */
+#define NOR_LOG_FILL_MAGIC 0x424AU
+
+/** Back-fill request size in bytes */
+#define NOR_LOG_FILL_REQUEST_SIZE 24U
+
+/** Back-fill reply header size in bytes */
+#define NOR_LOG_FILL_HEADER_SIZE 32U
+
+/** Pages read from the flash per chunk of a back-fill (4 KB) */
+#define NOR_LOG_FILL_PAGES 16U
+
+/**
+ * @brief Status of a back-fill reply
+ */
+typedef enum
+{
+    NOR_LOG_FILL_OK          = 0, /**< Pages follow */
+    NOR_LOG_FILL_BAD_REQUEST = 1, /**< Request malformed, nothing follows */
+    NOR_LOG_FILL_NO_LOG      = 2, /**< No flash mounted, nothing follows */
+} nor_log_fill_status_t;
+
+/**
+ * @brief Origin of an event record
+ */
+typedef enum
+{
+    NOR_LOG_SOURCE_INTERLOCK = 1, /**< Interlock rule (interlock.h) */
+    NOR_LOG_SOURCE_ANOMALY   = 2, /**< Anomaly alarm (anomaly.h) */
+} nor_log_source_t;
+
+#if BSP_SPINOR_ENABLE
+
+/**
+ * @brief Record an event
+ *
+ * Stamped with BSP_Time_NowNs(). Task context; never blocks. Does nothing
+ * until the flash is mounted, and counts the event in METRIC_NOR_LOG_LOST
+ * if too many wait for the writer.
+ *
+ * @param[in] source Origin of the event
+ * @param[in] kind   Kind, as defined by the source
+ * @param[in] index  Rule or channel
+ * @param[in] value  Value, as defined by the source
+ */
+void nor_log_event(nor_log_source_t source, uint8_t kind, uint16_t index,
+                   int32_t value);
+
+/**
+ * @brief Capture job: average the decimated stream into sample frames
+ *
+ * Run by the cyclic executive; never blocks.
+ */
+void nor_log_job(void);
+
+/**
+ * @brief Get the size of the flash the writer found at start
+ *
+ * Any task.
+ *
+ * @param[out] size Bytes, 0 if no flash answered
+ * @return false until the writer has probed the flash
+ */
+bool nor_log_flash_size(uint32_t *size);
+
+/**
+ * @brief Take the mutex serializing the flash calls
+ *
+ * For the other users of the flash, which must hold it for every
+ * BSP_SPINOR call and only for a page program, a short read or an erase
+ * step at a time.
+ *
+ * @param[in] wait Longest wait, 0 to only try it
+ * @return true if taken
+ */
+bool nor_log_lock(TickType_t wait);
+
+/**
+ * @brief Give the mutex taken with nor_log_lock()
+ */
+void nor_log_unlock(void);
+
+/**
+ * @brief Start the writer and the back-fill tasks
+ *
+ * Called once by the main task.
+ */
+void nor_log_start(void);
+
+#endif /* BSP_SPINOR_ENABLE */
+
+#endif /* NOR_LOG_H */
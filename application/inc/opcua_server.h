@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * OPC UA Server (Nano Embedded Device Profile)
+ *
+ * An OPC UA server on OPCUA_SERVER_PORT, open62541 built with the minimal
+ * namespace zero, subscriptions and no security (policy None), for SCADA
+ * and MES clients that browse and subscribe rather than poll registers.
+ * The address space of namespace 1, under the Objects folder:
+ *
+ *   <group>/<register>   One folder per register group marked "opcua" in
+ *                        config/jerry_registers.json, and one variable per
+ *                        register of the group, generated as
+ *                        jerry_device_opcua_folders and _nodes; i=1 + the
+ *                        group's index for a folder, i=table << 16 |
+ *                        address for a variable, table being the Modbus
+ *                        read function code. Coils and read-write holding
+ *                        registers are writable.
+ *   Channels/A<n>        Mean of channel n, Float volts, at
+ *                        OPCUA_SERVER_SAMPLE_RATE_HZ;
+ *                        i=OPCUA_SERVER_NODE_CHANNELS + 1 + n
+ *   Statistics/A<n>_<w>  Float[4] {min, max, mean, rms} of channel n over
+ *                        window w (1s, 10s, 1min, adc_stats.h), volts;
+ *                        i=OPCUA_SERVER_NODE_STATISTICS + 1 +
+ *                        n * ADC_STATS_WINDOW_COUNT + w
+ *
+ * A register variable holds the raw value in the type of the register, or
+ * the engineering value, raw times scale_factor, as Float if the register
+ * has a scale factor; its unit ends the description. It is read and
+ * written through the Modbus register callbacks under the register mutex,
+ * so writes run the write hooks as over Modbus; a read or write that does
+ * not get the mutex in OPCUA_SERVER_LOCK_WAIT_MS fails with
+ * BadResourceUnavailable. The statistics are read when asked for.
+ *
+ * The channel variables are sampling-driven: the server task averages the
+ * decimated stream of the ADC ring buffer (BSP_ADC1_RingRead()) over
+ * 1 / OPCUA_SERVER_SAMPLE_RATE_HZ, at whatever sample rate is in force, and
+ * writes each mean with the PTP time of its start as source timestamp. A
+ * monitored item with a sampling interval of 0 is sampled on each of those
+ * writes, so a subscription sees every mean, with its own time, however long
+ * its publishing interval; the queue size the client asks for per item, up to
+ * OPCUA_SERVER_MAX_QUEUE_SIZE (one second of means), holds them between
+ * publishes. A gap of the stream drops the mean in progress.
+ *
+ * Nothing comes from a heap: the stack allocates from fixed-block pools
+ * (opcua_port.h). The server runs in its own task, which alone calls into
+ * the stack.
+ *
+ * The server is built when OPCUA_SERVER is 1 (CMake option
+ * JERRY_OPCUA_SERVER).
+ */
+
+#ifndef OPCUA_SERVER_H
+#define OPCUA_SERVER_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef OPCUA_SERVER
+#define OPCUA_SERVER 0
+#endif
+
+/** TCP port of the server, opc.tcp:// default */
+#define OPCUA_SERVER_PORT 4840U
+
+/** Sessions, and secure channels, served at once */
+#define OPCUA_SERVER_MAX_SESSIONS 2U
+
+/** Send and receive buffer of a connection, the smallest OPC UA allows */
+#define OPCUA_SERVER_BUFFER_SIZE 8192U
+
+/** Rate of the channel means */
+#define OPCUA_SERVER_SAMPLE_RATE_HZ 50U
+
+/** Largest queue of a monitored item: one second of channel means */
+#define OPCUA_SERVER_MAX_QUEUE_SIZE OPCUA_SERVER_SAMPLE_RATE_HZ
+
+/** Subscriptions per session and monitored items per subscription */
+#define OPCUA_SERVER_MAX_SUBSCRIPTIONS    2U
+#define OPCUA_SERVER_MAX_MONITORED_ITEMS  32U
+
+/** Shortest publishing interval of a subscription */
+#define OPCUA_SERVER_MIN_PUBLISHING_MS 50U
+
+/** Shortest sampling interval of the register and statistics variables,
+ *  which are sampled by polling */
+#define OPCUA_SERVER_REGISTER_SAMPLING_MS 100U
+
+/** Longest wait for the register mutex */
+#define OPCUA_SERVER_LOCK_WAIT_MS 10U
+
+/** Period of the server task: network, timers and the ADC ring */
+#define OPCUA_SERVER_POLL_MS 10U
+
+/** Numeric node IDs of the Channels and Statistics folders */
+#define OPCUA_SERVER_NODE_CHANNELS   0x1000U
+#define OPCUA_SERVER_NODE_STATISTICS 0x2000U
+
+#if OPCUA_SERVER
+
+/**
+ * @brief Start the OPC UA server task
+ *
+ * Called by the Modbus TCP task once the registers are initialized and the
+ * network interface is up.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ */
+void opcua_server_start(SemaphoreHandle_t register_mutex);
+
+#endif /* OPCUA_SERVER */
+
+#endif /* OPCUA_SERVER_H */
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Power-Fail Snapshot
+ *
+ * Keeps the state that lives only in RAM across a loss of the supply,
+ * without writing the flash while the device runs: the rising edge counts
+ * of the digital inputs, the energy totals of the power meter
+ * (power_meter.h) and the persistent registers written since the last
+ * commit of config_store.h. The supply voltage detector
+ * (BSP_PVD_Start()) interrupts as VDD falls below POWER_FAIL_PVD_LEVEL,
+ * above every other interrupt, so no task or other handler runs until it
+ * returns. Its hook builds one record and programs it into an erased part
+ * of a snapshot sector (BSP_FLASH_SNAPSHOT_SECTORS, the sector below the
+ * configuration sector of each bank) with BSP_Flash_SnapshotProgram(): at
+ * most POWER_FAIL_MAX_WORDS quad-words, under a millisecond, which the
+ * hold-up of the supply has to cover between the threshold and the
+ * brown-out reset. A flash write in flight is waited for and abandoned;
+ * an erase of the configuration store makes the hook a few ms late.
+ *
+ * The sectors are a log like that of config_store.h: records follow one
+ * another, each starting on a quad-word, and the newest, by sequence
+ * number, wins. All fields are little-endian. Header, the first quad-word:
+ *
+ *   Offset  Size  Field
+ *   0       4     POWER_FAIL_MAGIC
+ *   4       4     Sequence number, one more than the record before
+ *   8       1     Kind, POWER_FAIL_KIND_*
+ *   9       1     POWER_FAIL_VERSION
+ *   10      2     Quad-words of the record, the header included
+ *   12      4     Check over every other word of the record
+ *
+ * A POWER_FAIL_KIND_SNAPSHOT record goes on with:
+ *
+ *   Offset  Size  Field
+ *   16      32    Rising edge count of DI0 to DI7, 4 bytes each
+ *   48      72    Energy totals of power meter pairs 0 to 2
+ *                 (power_meter_saved_energy()), each the imported and
+ *                 exported Wh and the apparent VAh, IEEE 754 doubles
+ *   120     8     0
+ *   128     16n   Persistent register records (config_store_pending()), up
+ *                 to POWER_FAIL_CONFIG_RECORDS, in the format of the
+ *                 configuration store
+ *
+ * A POWER_FAIL_KIND_CLEARED record is the header alone: the snapshot
+ * before it has been used up, by a restore or because the supply came back
+ * before the reset.
+ *
+ * At boot power_fail_start() restores a snapshot that is the newest
+ * record: the counts become the base the input registers add to the
+ * counts of the BSP, the energy totals are added back to those of the
+ * power meter (power_meter_restore_energy()), and the register records go
+ * through
+ * config_store_apply(), so they win over the older values of the store and
+ * are committed by it. A CLEARED record then follows, so that a later reset
+ * without a snapshot does not restore the same one again. The hook is
+ * armed while the active sector has room for a snapshot and its CLEARED
+ * record; a fuller one is left for the other, erased at boot as it is
+ * switched to.
+ *
+ * A snapshot is often cut short by the supply itself, and the quad-word
+ * being programmed then fails its ECC check. The sectors are read with
+ * BSP_Flash_Read(), which reports such a quad-word instead of faulting,
+ * and the walk of the records ends there, as for a damaged header.
+ *
+ * Built when POWER_FAIL is 1 (CMake option JERRY_POWER_FAIL). The host
+ * simulation has no voltage detector: it restores a snapshot but never
+ * takes one.
+ */
+
+#ifndef POWER_FAIL_H
+#define POWER_FAIL_H
+
+#include <stdint.h>
+
+#ifndef POWER_FAIL
+#define POWER_FAIL 0
+#endif
+
+/** Detector threshold, see BSP_PVD_Start(): 6 is about 2.85 V */
+#ifndef POWER_FAIL_PVD_LEVEL
+#define POWER_FAIL_PVD_LEVEL 6U
+#endif
+
+/** Record header magic: the bytes 'J', 'P', 'F', 'S' */
+#define POWER_FAIL_MAGIC 0x5346504AU
+
+/** Record format version; a record of another version is never restored */
+#define POWER_FAIL_VERSION 2U
+
+/** Record kind: state taken as the supply fell */
+#define POWER_FAIL_KIND_SNAPSHOT 1U
+
+/** Record kind: the snapshot before it is used up */
+#define POWER_FAIL_KIND_CLEARED 2U
+
+/** Digital inputs whose rising edge counts are kept */
+#define POWER_FAIL_DI_COUNT 8U
+
+/** Persistent register records a snapshot holds at most */
+#define POWER_FAIL_CONFIG_RECORDS 8U
+
+/** Quad-words of the rising edge counts */
+#define POWER_FAIL_DI_WORDS 2U
+
+/** Quad-words of the energy totals */
+#define POWER_FAIL_ENERGY_WORDS 5U
+
+/** Quad-words of a snapshot before its register records */
+#define POWER_FAIL_FIXED_WORDS                                                \
+    (1U + POWER_FAIL_DI_WORDS + POWER_FAIL_ENERGY_WORDS)
+
+/** Quad-words of the largest snapshot */
+#define POWER_FAIL_MAX_WORDS                                                  \
+    (POWER_FAIL_FIXED_WORDS + POWER_FAIL_CONFIG_RECORDS)
+
+/**
+ * @brief Restore the snapshot of the last power loss and arm the detector
+ *
+ * Called once by the Modbus task, right after config_store_start().
+ */
+void power_fail_start(void);
+
+/**
+ * @brief Rising edges of a digital input counted before the last power
+ *        loss
+ *
+ * @param[in] channel Digital input, below POWER_FAIL_DI_COUNT
+ * @return Count to add to that of the BSP, 0 without a snapshot
+ */
+uint32_t power_fail_di_base(uint8_t channel);
+
+#endif /* POWER_FAIL_H */
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Power Meter
+ *
+ * Computes real and apparent power and energy from pairs of ADC1
+ * channels, a voltage and a current, at the full sample rate, so that a
+ * load that changes between two polls of the PLC still counts in the
+ * energy. Up to POWER_METER_PAIRS pairs are configured.
+ *
+ * The filter task (ADC1 block hook) drains the full-rate stream after
+ * each block and converts the raw samples of each pair with the channel's
+ * calibration: the conversion table where there is one
+ * (BSP_ADC1_LUT_CHANNELS), else gain and offset, without the
+ * linearization. The calibration has to put the voltage channel in V and
+ * the current channel in A; the filtered values are not used, as the mains
+ * notches take the signal out. Over each run of consecutive samples:
+ *
+ *   - arm_dot_prod_f32() of the voltage and current, the sum of the
+ *     instantaneous power;
+ *   - arm_power_f32() of each channel, the sums of squares;
+ *
+ * which go into double-precision sums over a window of window_ms. At the
+ * end of the window:
+ *
+ *   - real power P, the mean of the instantaneous power, in W;
+ *   - apparent power S, Vrms x Irms, in VA;
+ *   - P x the window's duration goes to the imported energy when P is
+ *     positive, else to the exported energy, and S x the duration to the
+ *     apparent energy, in double-precision totals in Wh and VAh.
+ *
+ * The window holds whole mains periods at the default 200 ms, so P does
+ * not ripple at twice the mains frequency. A gap in the sample sequence
+ * and a change of the sample rate close the window early, and the samples
+ * never converted are not counted; a new configuration takes effect with
+ * the next window. With BSP_ADC1_DUAL_MODE channels n and n + 3 are
+ * sampled at the same instant, the best pairs; otherwise the current lags
+ * the voltage by the conversions between them, a small phase error at
+ * mains frequencies.
+ *
+ * The totals count from 0 at first boot and survive a loss of the supply
+ * through the power-fail snapshot (power_fail.h), which takes them with
+ * power_meter_saved_energy() and hands them back with
+ * power_meter_restore_energy(). power_meter_clear_energy() sets the totals
+ * of chosen pairs to 0.
+ */
+
+#ifndef POWER_METER_H
+#define POWER_METER_H
+
+#include <stdint.h>
+
+#include "bsp.h"
+
+/** Voltage and current channel pairs metered at most */
+#define POWER_METER_PAIRS 3U
+
+/** Window length bounds and default, ms */
+#define POWER_METER_MIN_WINDOW_MS     20U
+#define POWER_METER_MAX_WINDOW_MS     1000U
+#define POWER_METER_DEFAULT_WINDOW_MS 200U
+
+/**
+ * @brief One pair of channels to meter
+ *
+ * A pair whose two channels are the same is off.
+ */
+typedef struct
+{
+    uint16_t voltage; /**< ADC1 channel of the voltage, V */
+    uint16_t current; /**< ADC1 channel of the current, A */
+} power_meter_pair_t;
+
+/**
+ * @brief Power meter configuration
+ */
+typedef struct
+{
+    uint16_t           window_ms;                /**< Window length, ms */
+    power_meter_pair_t pairs[POWER_METER_PAIRS]; /**< Pairs */
+} power_meter_config_t;
+
+/**
+ * @brief Energy totals of one pair
+ */
+typedef struct
+{
+    float64_t imported; /**< Real energy taken, Wh */
+    float64_t exported; /**< Real energy given back, Wh */
+    float64_t apparent; /**< Apparent energy, VAh */
+} power_meter_energy_t;
+
+/**
+ * @brief Result of one pair over one window
+ */
+typedef struct
+{
+    float32_t            real;     /**< Real power, W */
+    float32_t            apparent; /**< Apparent power, VA */
+    power_meter_energy_t energy;   /**< Totals at the end of the window */
+} power_meter_result_t;
+
+/**
+ * @brief Apply a new configuration
+ *
+ * Safe to call from any task; takes effect with the next window.
+ *
+ * @param[in] config New configuration (copied); NULL is ignored and a
+ *                   window length is clamped to POWER_METER_MIN_WINDOW_MS
+ *                   to POWER_METER_MAX_WINDOW_MS
+ */
+void power_meter_set_config(const power_meter_config_t *config);
+
+/**
+ * @brief Meter the new full-rate samples
+ *
+ * Filter task only (ADC1 block hook). Attaches its stream reader on the
+ * first call.
+ */
+void power_meter_process(void);
+
+/**
+ * @brief Get the results last published
+ *
+ * Safe to call from any task. All results come from the same window.
+ *
+ * @param[out] results POWER_METER_PAIRS entries, pair 0 first
+ * @return Number of windows since boot, 0 if none yet
+ */
+uint32_t
+power_meter_get_results(power_meter_result_t results[POWER_METER_PAIRS]);
+
+/**
+ * @brief Set the energy totals of some pairs to 0
+ *
+ * Safe to call from any task; takes effect with the next window.
+ *
+ * @param[in] mask Pairs to clear, bit n = pair n
+ */
+void power_meter_clear_energy(uint8_t mask);
+
+/**
+ * @brief Add the totals of a power-fail snapshot to the energy totals
+ *
+ * Called once at boot, by power_fail_start(); takes effect with the next
+ * window.
+ *
+ * @param[in] energy POWER_METER_PAIRS totals (copied)
+ */
+void power_meter_restore_energy(
+    const power_meter_energy_t energy[POWER_METER_PAIRS]);
+
+/**
+ * @brief Get the energy totals for a power-fail snapshot
+ *
+ * For the voltage detector hook, which runs above every task and
+ * interrupt: reads the copy of the totals the filter task completed last,
+ * at the end of the last window, and adds a restore still waiting.
+ *
+ * @param[out] energy POWER_METER_PAIRS totals
+ */
+void power_meter_saved_energy(power_meter_energy_t energy[POWER_METER_PAIRS]);
+
+#endif /* POWER_METER_H */
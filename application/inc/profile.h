@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Statistical PC Sampling Profiler
+ *
+ * Shows where the CPU time goes, inside the Modbus callbacks, lwIP and the
+ * interrupt handlers alike, without instrumenting any of them. A timer
+ * interrupt (BSP_Profile_Start()) samples the interrupted program counter
+ * from the exception frame, with the link register, the exception the
+ * code ran in and the running task. Samples taken at a fixed rate are
+ * spread over the code in proportion to the time spent in it, so a few
+ * seconds of them give a flat profile of the functions.
+ *
+ * A sample is one PROFILE_SAMPLE_SIZE record in a RAM ring of
+ * PROFILE_RING_SAMPLES. The interrupt runs above the kernel's mask, so it
+ * is the only writer of the ring and never waits for a critical section;
+ * the profile task is the only reader. Nothing runs while no client is
+ * connected: the timer is stopped. A full ring drops the new samples,
+ * counted as METRIC_PROFILE_DROP; the stream then carries one sample with
+ * PROFILE_FLAG_LOST and the number lost.
+ *
+ * The profile task (Profile) serves one client at a time on TCP port
+ * PROFILE_PORT. The client asks for a rate with a request, the task
+ * answers with a header and the task table and streams the samples every
+ * PROFILE_DRAIN_MS until the client closes; closing stops the sampling.
+ * All fields are little-endian.
+ *
+ * Request:
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, PROFILE_MAGIC ("JP")
+ *   2       1     Format version, PROFILE_VERSION
+ *   3       1     Reserved, 0
+ *   4       4     Sample rate in Hz, 0 for PROFILE_DEFAULT_HZ
+ *
+ * Header:
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, PROFILE_MAGIC
+ *   2       1     Format version, PROFILE_VERSION
+ *   3       1     Sample size, PROFILE_SAMPLE_SIZE
+ *   4       4     Sample rate in Hz
+ *   8       2     Number of tasks n
+ *   10      2     Reserved, 0
+ *   12      20n   Tasks: number (u16), priority (u8), reserved (u8), name
+ *                 (PROFILE_NAME_SIZE bytes, NUL padded)
+ *
+ * A sample is the program counter (u32) and link register (u32) of the
+ * interrupted code, the number of the task that was running (u16), the
+ * exception the code ran in (u8, 0 in thread mode, the IRQ number plus 16
+ * in an interrupt handler) and flags (u8, PROFILE_FLAG_*). The link
+ * register is the caller only while the code is in a leaf function or its
+ * prologue; the flame graph of tools/profile_report.py uses it as a hint.
+ *
+ * The profiler is built when PROFILE_ENABLE is 1 (CMake option
+ * JERRY_PROFILE). tools/profile_report.py records the stream and
+ * symbolizes it against jerry_app.elf into a flat profile and the folded
+ * stacks of a flame graph.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE 0
+#endif
+
+/** Request and header magic: the bytes 'J', 'P' */
+#define PROFILE_MAGIC 0x504AU
+
+/** Stream format version */
+#define PROFILE_VERSION 1U
+
+/** Request size in bytes */
+#define PROFILE_REQUEST_SIZE 8U
+
+/** Header size in bytes, without the task table */
+#define PROFILE_HEADER_SIZE 12U
+
+/** Size of one sample in bytes */
+#define PROFILE_SAMPLE_SIZE 12U
+
+/** Size of the name field of a task entry */
+#define PROFILE_NAME_SIZE 16U
+
+/** Size of a task entry in bytes */
+#define PROFILE_TASK_ENTRY_SIZE (4U + PROFILE_NAME_SIZE)
+
+/** Samples the ring holds, a power of two */
+#define PROFILE_RING_SAMPLES 512U
+
+/** Period at which the profile task drains the ring */
+#define PROFILE_DRAIN_MS 10U
+
+/**
+ * Sample rate when the request leaves it open: near 5 kHz, and prime so
+ * that the samples do not lock onto the 1 kHz tick or the ADC1 trigger
+ */
+#define PROFILE_DEFAULT_HZ 4999U
+
+/** TCP port of the profile stream */
+#define PROFILE_PORT 5012U
+
+/** Sample flag: interrupted in the secure world, no addresses */
+#define PROFILE_FLAG_SECURE 0x01U
+
+/** Sample flag: samples lost before this one, their number in the PC
+ * field; the other fields are 0 */
+#define PROFILE_FLAG_LOST 0x02U
+
+/**
+ * @brief Start the profile task
+ *
+ * Called once by the main task.
+ */
+void profile_start(void);
+
+#endif /* PROFILE_H */
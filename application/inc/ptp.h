@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * IEEE 1588 PTP Slave
+ *
+ * Disciplines the MAC system time (BSP_PTP group in bsp.h) to a PTPv2
+ * master over UDP/IPv4, two-step, with the end-to-end delay mechanism. All
+ * four times of an exchange are hardware timestamps taken by the MAC
+ * (ethernetif.h) or by the master:
+ *
+ *   master                      slave
+ *     t1  Sync -------------->  t2
+ *         Follow_Up (t1) ---->
+ *     t4  <------------ Delay_Req  t3
+ *         Delay_Resp (t4) --->
+ *
+ *   mean path delay = ((t2 - t1) + (t4 - t3)) / 2
+ *   offset          = (t2 - t1) - mean path delay
+ *
+ * Offsets beyond PTP_STEP_THRESHOLD_NS step the time; smaller ones feed a
+ * PI servo that trims its rate. There is no best master selection: the
+ * slave follows the first master it hears in PTP_DOMAIN and moves on to
+ * another one only after PTP_MASTER_TIMEOUT_MS of silence. One-step
+ * masters (no Follow_Up) are followed as well.
+ *
+ * ADC samples are stamped on this timescale (BSP_ADC1_GetSampleTimeNs()),
+ * so nodes following the same master correlate their acquisitions without
+ * trigger wiring. With BSP_ADC1_SYNC the ADC trigger follows it too, from
+ * the first lock until the master is dropped (BSP_ADC1_SetTriggerSync()),
+ * and these nodes sample at the same instants.
+ */
+
+#ifndef PTP_H
+#define PTP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** PTP domain followed */
+#define PTP_DOMAIN 0U
+
+/** UDP port of PTP general messages (Follow_Up, Delay_Resp) */
+#define PTP_GENERAL_PORT 320U
+
+/** Offset beyond which the time is stepped instead of slewed, in ns */
+#define PTP_STEP_THRESHOLD_NS 100000LL
+
+/** Offset within which the servo counts as locked, in ns */
+#define PTP_LOCK_THRESHOLD_NS 1000LL
+
+/** Consecutive offsets within PTP_LOCK_THRESHOLD_NS before locking */
+#define PTP_LOCK_COUNT 4U
+
+/** Silence after which the master is dropped, in ms */
+#define PTP_MASTER_TIMEOUT_MS 5000U
+
+/** Shortest interval between two Delay_Req messages, in ms */
+#define PTP_DELAY_REQ_INTERVAL_MS 1000U
+
+/**
+ * @brief State of the slave
+ */
+typedef struct
+{
+    bool     has_master;         /**< A master is followed */
+    bool     locked;             /**< The servo has converged */
+    uint8_t  master_identity[8]; /**< clockIdentity of the master */
+    int64_t  offset_ns;          /**< Last offset from the master */
+    int64_t  path_delay_ns;      /**< Mean path delay to the master */
+    int32_t  freq_ppb;           /**< Rate correction applied */
+    uint32_t syncs;              /**< Sync exchanges completed */
+    uint32_t steps;              /**< Times the clock was stepped */
+} ptp_status_t;
+
+/**
+ * @brief Whether the system time follows a master within the lock threshold
+ *
+ * Callable from any task.
+ */
+bool ptp_is_locked(void);
+
+/**
+ * @brief Copy the state of the slave
+ *
+ * @param status Filled with the state.
+ */
+void ptp_get_status(ptp_status_t *status);
+
+#endif /* PTP_H */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Lossless ADC Sample Compression
+ *
+ * Compresses blocks of raw ADC results for the UDP stream and the USB
+ * stick logger. Each channel of a block is predicted from its previous
+ * samples, by the first difference or the second-order extrapolation
+ * 2 x[n-1] - x[n-2], whichever leaves the smaller residuals, and the
+ * residuals are Rice coded with a parameter fitted to the block. A block
+ * that would not shrink is stored verbatim, so an encoded block is never
+ * more than one byte per channel larger than the raw samples
+ * (SAMPLE_CODEC_MAX_SIZE). Slowly moving signals take 3 to 6 bits per
+ * 12-bit reading.
+ *
+ * Blocks continue the prediction of the previous block of the same codec
+ * state; a decoder must see every block since sample_codec_init(). The
+ * first sample of every channel after an init is stored verbatim.
+ *
+ * An encoded block is a bit string, most significant bit first, padded
+ * with zero bits to a whole byte. For each channel in frame order:
+ *
+ *   Bits  Field
+ *   8     Mode: 0x00-0x0F first difference, 0x10-0x1F second-order, with
+ *         the Rice parameter k in the low four bits; 0xFF verbatim
+ *   16    First sample after an init, if the mode is not verbatim
+ *   ...   Per sample, verbatim: 16 bits; otherwise the residual r, mapped
+ *         to u = 2r for r >= 0 and -2r - 1 for r < 0, as u >> k zero bits,
+ *         a one bit and the k low bits of u
+ *
+ * tools/sample_codec.py is the matching decoder.
+ */
+
+#ifndef SAMPLE_CODEC_H
+#define SAMPLE_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Most channels of one codec state */
+#define SAMPLE_CODEC_MAX_CHANNELS 8U
+
+/** Most frames of one block */
+#define SAMPLE_CODEC_MAX_FRAMES 4096U
+
+/** Mode of a channel stored verbatim */
+#define SAMPLE_CODEC_MODE_VERBATIM 0xFFU
+
+/** Mode bit of the second-order predictor */
+#define SAMPLE_CODEC_MODE_ORDER2 0x10U
+
+/** Largest encoded size of a block of frames of channels, in bytes */
+#define SAMPLE_CODEC_MAX_SIZE(channels, frames) \
+    ((channels) * (1U + (2U * (frames))))
+
+/**
+ * @brief Predictor history of one channel
+ */
+typedef struct
+{
+    int32_t last[2]; /**< Last two samples, newest first */
+    uint8_t primed;  /**< Samples in last[] */
+} sample_codec_channel_t;
+
+/**
+ * @brief Codec state of one stream of blocks
+ */
+typedef struct
+{
+    sample_codec_channel_t channel[SAMPLE_CODEC_MAX_CHANNELS];
+    uint8_t                channels; /**< Channels per frame */
+} sample_codec_t;
+
+/**
+ * @brief Start a new stream of blocks
+ *
+ * @param[out] codec    Codec state
+ * @param      channels Channels per frame, 1 to SAMPLE_CODEC_MAX_CHANNELS
+ */
+void sample_codec_init(sample_codec_t *codec, uint8_t channels);
+
+/**
+ * @brief Encode a block of frames
+ *
+ * @param[in,out] codec  Codec state
+ * @param[in]     frames count frames of codec->channels samples each
+ * @param         count  Frames, 1 to SAMPLE_CODEC_MAX_FRAMES
+ * @param[out]    dst    Room for SAMPLE_CODEC_MAX_SIZE(channels, count)
+ *                       bytes
+ * @return Bytes written
+ */
+size_t sample_codec_encode(sample_codec_t *codec, const uint16_t *frames,
+                           uint32_t count, uint8_t *dst);
+
+#endif /* SAMPLE_CODEC_H */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Register Snapshot Multicast
+ *
+ * Several clients reading the same registers each poll the device for
+ * them. Instead, the device can send the registers of the groups marked
+ * "snapshot" in config/jerry_registers.json as one UDP datagram, rate_hz
+ * times per second, to a multicast group any number of clients join. The
+ * datagram is built once per period, with the register mutex held, so all
+ * blocks of it come from the same published register image. All fields
+ * are little-endian, register values included.
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, SNAPSHOT_PUBLISH_MAGIC ("JS")
+ *   2       1     Format version, SNAPSHOT_PUBLISH_VERSION
+ *   3       1     Number of blocks
+ *   4       4     Layout ID, JERRY_DEVICE_SNAPSHOT_LAYOUT_ID
+ *   8       4     Sequence number (1 per datagram)
+ *   12      4     Device uptime in ms
+ *   16      ...   Blocks
+ *
+ * A block is a 6-byte header (table u8: the Modbus read function code,
+ * reserved u8, first address u16, count u16) followed by its values:
+ * registers as 16-bit words, bits packed LSB first and padded to a whole
+ * word. The blocks and their order are those of jerry_device_snapshot_blocks
+ * and the register map documentation. The layout ID is a CRC-32 the code
+ * generator computes over the blocks and the names of their registers, so
+ * a client built for another register map can tell without decoding.
+ *
+ * The publisher is built when SNAPSHOT_PUBLISH is 1 (CMake option
+ * JERRY_SNAPSHOT_PUBLISH). tools/snapshot_listener.py is the matching
+ * client.
+ */
+
+#ifndef SNAPSHOT_PUBLISH_H
+#define SNAPSHOT_PUBLISH_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef SNAPSHOT_PUBLISH
+#define SNAPSHOT_PUBLISH 1
+#endif
+
+/** Datagram magic: the bytes 'J', 'S' */
+#define SNAPSHOT_PUBLISH_MAGIC 0x534AU
+
+/** Datagram format version */
+#define SNAPSHOT_PUBLISH_VERSION 1U
+
+/** Datagram header size in bytes */
+#define SNAPSHOT_PUBLISH_HEADER_SIZE 16U
+
+/** Block header size in bytes */
+#define SNAPSHOT_PUBLISH_BLOCK_HEADER_SIZE 6U
+
+/** Highest snapshot rate in Hz */
+#define SNAPSHOT_PUBLISH_MAX_RATE_HZ 100U
+
+/** Default multicast group, 239.255.74.1 */
+#define SNAPSHOT_PUBLISH_DEFAULT_GROUP 0xEFFF4A01U
+
+/** Default destination UDP port */
+#define SNAPSHOT_PUBLISH_DEFAULT_PORT 5023U
+
+/**
+ * @brief Publish configuration
+ *
+ * Snapshots are sent while @c rate_hz, @c dest_addr and @c dest_port are
+ * non-zero. The destination may also be a unicast address.
+ */
+typedef struct
+{
+    uint16_t rate_hz;   /**< Snapshots per second, 0 = off */
+    uint32_t dest_addr; /**< Destination IPv4 address, a.b.c.d as 0xaabbccdd */
+    uint16_t dest_port; /**< Destination UDP port */
+} snapshot_publish_config_t;
+
+/**
+ * @brief Apply a new publish configuration
+ *
+ * Safe to call from any task. The publish task picks the configuration up
+ * at once and starts a new period with it.
+ *
+ * @param[in] config New configuration (copied); NULL is ignored.
+ */
+void snapshot_publish_set_config(const snapshot_publish_config_t *config);
+
+/**
+ * @brief Start the snapshot publish task
+ *
+ * Called by the Modbus TCP task once the registers are initialized and the
+ * network interface is up.
+ *
+ * @param[in] register_mutex Mutex serializing register callback access
+ */
+void snapshot_publish_start(SemaphoreHandle_t register_mutex);
+
+#endif /* SNAPSHOT_PUBLISH_H */
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Spectral Analysis
+ *
+ * Computes the spectrum, RMS, peak and total harmonic distortion of the
+ * selected ADC1 channels on the device, so that mains quality and
+ * vibration figures need no raw sample stream.
+ *
+ * Two parts share the work. The collector job (SpecCollect) runs in the
+ * cyclic executive (cyclic_exec.h) and only copies the raw samples of
+ * SPECTRUM_FFT_SIZE consecutive sample periods into a frame buffer.
+ * The analysis task (Spectrum) runs at background priority: for every
+ * selected channel it removes the mean, applies a Hann window, transforms
+ * the frame with arm_rfft_fast_f32() and derives the figures below. The
+ * collector waits while a frame is analysed and then starts a fresh one,
+ * so the analysis can take as long as the scheduler lets it without ever
+ * delaying the acquisition; frames are just taken less often.
+ *
+ * Per channel, from one frame of SPECTRUM_FFT_SIZE samples (102.4 ms at
+ * 10 kHz, 9.77 Hz per bin), computed on the raw samples because the
+ * filter cascade notches the mains harmonics:
+ *
+ *   - mean, AC RMS and peak (largest deviation from the mean), in mV;
+ *   - fundamental: the strongest bin from SPECTRUM_MIN_BIN on, its
+ *     frequency refined to the power centroid of its main lobe, and its
+ *     amplitude;
+ *   - THD: the power of harmonics 2 to SPECTRUM_HARMONICS below the
+ *     Nyquist frequency relative to that of the fundamental, each summed
+ *     over the +-SPECTRUM_LOBE_BINS bins of a Hann main lobe. A channel
+ *     whose fundamental is below SPECTRUM_MIN_AMPLITUDE_MV reports no
+ *     fundamental and no THD.
+ *
+ * The amplitude spectrum of the last frame is also readable with Modbus
+ * FC20 as file SPECTRUM_FILE_NUMBER, in records of one 16-bit word:
+ *
+ *   Record  Size  Field
+ *   0       1     Magic, SPECTRUM_MAGIC ("JS")
+ *   1       1     Format version, SPECTRUM_VERSION
+ *   2       1     Header size in records, SPECTRUM_HEADER_RECORDS
+ *   3       1     Channels analysed, bit n for A<n>
+ *   4       1     FFT size; bin k is k * sample rate / FFT size
+ *   5       1     Sample rate in Hz
+ *   6       2     Frame number, high word first
+ *   8       6B    Amplitude of bins 0..B-1 of A0..A5 in 0.1 mV, B bins per
+ *                 channel (SPECTRUM_BINS), zero for channels not analysed
+ *
+ * A spectrum read over several FC20 requests can mix two frames if a new
+ * one is published in between; reading the frame number again after the
+ * bins tells.
+ *
+ * Stages that work on the spectrum, such as the anomaly scores (anomaly.h),
+ * run after each frame in the analysis task through a frame hook.
+ */
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdint.h>
+
+#include "bsp.h"
+#include "modbus_types.h"
+
+/** Samples per frame and FFT length (a size arm_rfft_fast_f32 supports) */
+#define SPECTRUM_FFT_SIZE 1024U
+
+/** Bins of the amplitude spectrum, DC to just below the Nyquist frequency */
+#define SPECTRUM_BINS (SPECTRUM_FFT_SIZE / 2U)
+
+/** Lowest bin taken as a fundamental, above the leakage of the mean */
+#define SPECTRUM_MIN_BIN 3U
+
+/** Bins on either side of a peak that belong to its Hann main lobe */
+#define SPECTRUM_LOBE_BINS 2U
+
+/** Highest harmonic in the THD */
+#define SPECTRUM_HARMONICS 40U
+
+/** Fundamental amplitude below which a channel has no fundamental */
+#define SPECTRUM_MIN_AMPLITUDE_MV 5.0f
+
+/** Channel mask selecting every ADC1 channel */
+#define SPECTRUM_ALL_CHANNELS ((1U << BSP_ADC1_NUM_CHANNELS) - 1U)
+
+/** File number of the amplitude spectrum for FC20 */
+#define SPECTRUM_FILE_NUMBER 4U
+
+/** Spectrum file magic: the bytes 'J', 'S' */
+#define SPECTRUM_MAGIC 0x4A53U
+
+/** Spectrum file format version */
+#define SPECTRUM_VERSION 1U
+
+/** Spectrum file header size in records */
+#define SPECTRUM_HEADER_RECORDS 8U
+
+/** Records of the spectrum file */
+#define SPECTRUM_FILE_RECORDS \
+    (SPECTRUM_HEADER_RECORDS + (BSP_ADC1_NUM_CHANNELS * SPECTRUM_BINS))
+
+/**
+ * @brief Figures of one channel, scaled for the input registers
+ *
+ * Values saturate at 65535.
+ */
+typedef struct
+{
+    uint16_t mean;      /**< Mean, 0.1 mV */
+    uint16_t rms;       /**< RMS with the mean removed, 0.1 mV */
+    uint16_t peak;      /**< Largest deviation from the mean, 0.1 mV */
+    uint16_t frequency; /**< Fundamental frequency, 0.1 Hz; 0 if none */
+    uint16_t amplitude; /**< Fundamental amplitude, 0.1 mV; 0 if none */
+    uint16_t thd;       /**< Total harmonic distortion, 0.01 %; 0 if none */
+} spectrum_result_t;
+
+/**
+ * @brief Function run by the analysis task after each frame
+ *
+ * @param[in] channels Channels analysed, bit n for A<n>
+ * @param[in] bins     Amplitude spectrum of the frame in 0.1 mV,
+ *                     SPECTRUM_BINS per channel, A0 first; zero for
+ *                     channels not analysed
+ * @param[in] results  Figures of the frame, BSP_ADC1_NUM_CHANNELS entries
+ */
+typedef void (*spectrum_frame_hook_t)(uint16_t                 channels,
+                                      const uint16_t          *bins,
+                                      const spectrum_result_t *results);
+
+/**
+ * @brief Install the function the analysis task runs after each frame
+ *
+ * The hook is called once the figures and the spectrum file of a frame
+ * are published, at the analysis task's background priority, before the
+ * next frame is collected. It may take its time but only delays the next
+ * frame; the arguments are valid until it returns.
+ *
+ * @param[in] hook Function to run, or NULL for none
+ */
+void spectrum_set_frame_hook(spectrum_frame_hook_t hook);
+
+/**
+ * @brief Select the channels to analyse
+ *
+ * Safe to call from any task; takes effect with the next frame. Channels
+ * that are not selected read all zero from then on. With no channel
+ * selected no frames are taken and the figures keep their last values.
+ *
+ * @param[in] mask Bit n selects A<n>; bits above SPECTRUM_ALL_CHANNELS are
+ *                 ignored.
+ */
+void spectrum_set_channels(uint16_t mask);
+
+/**
+ * @brief Get the figures of the last frame
+ *
+ * The figures of all channels come from the same frame.
+ *
+ * @param[out] results BSP_ADC1_NUM_CHANNELS entries, A0 first
+ * @return Frame number, 1 for the first since boot, 0 if none yet
+ */
+uint32_t spectrum_get_results(spectrum_result_t *results);
+
+/**
+ * @brief Read records of the spectrum file, its FC20 file reader
+ *
+ * @param[in]  file_number   SPECTRUM_FILE_NUMBER
+ * @param[in]  record_number First record
+ * @param[in]  record_length Number of records
+ * @param[out] values        Record values
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS unless all records lie in
+ *         the file; the file has no records until the first frame
+ */
+modbus_exception_t spectrum_read_file_record(uint16_t  file_number,
+                                             uint16_t  record_number,
+                                             uint16_t  record_length,
+                                             uint16_t *values);
+
+/**
+ * @brief Collect raw samples of the frame
+ *
+ * Cyclic executive only. Does nothing while the frame is analysed or no
+ * channel is selected.
+ */
+void spectrum_collect_job(void);
+
+#endif /* SPECTRUM_H */
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Task Deadline Supervisor
+ *
+ * The tasks whose stall would go unnoticed otherwise register with the
+ * supervisor, giving the period at which they work and the deadline
+ * within which they must report, and then check in once per unit of work:
+ * the AdcFilter task after every ADC1 block, the cyclic executive after
+ * every frame, the logging task after every drain and each Modbus TCP
+ * connection worker after every receive poll. A check-in later than the
+ * deadline after the one before is a miss; so is a task that has not
+ * checked in for longer than its deadline, counted once when the
+ * supervisor notices and again only after the task has reported.
+ *
+ * A task that is about to wait for work with no bound, as a connection
+ * worker waiting for a connection, declares itself idle and is not
+ * supervised until its next check-in.
+ *
+ * Every miss is logged and counted, per task and as
+ * METRIC_DEADLINE_MISS, so a task drifting past its budget shows up in
+ * the telemetry before it fails. The supervisor task (Supervisor) checks
+ * the tasks every SUPERVISOR_CHECK_MS and reloads the independent
+ * watchdog only while none of them is late: a stalled task stops the
+ * reloads, and the watchdog resets the MCU SUPERVISOR_WATCHDOG_MS later
+ * unless the task recovers. A deadlocked or starved supervisor stops them
+ * too.
+ *
+ *   Task          Period      Deadline
+ *   AdcFilter     3.2 ms      50 ms
+ *   Cyclic        3.2 ms      250 ms (2.5 idle frames)
+ *   Log           10 ms       1000 ms
+ *   ModbusW0-3    250 ms      2000 ms (while serving)
+ */
+
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Tasks that can register */
+#define SUPERVISOR_MAX_TASKS 12U
+
+/** Period of the supervisor task */
+#define SUPERVISOR_CHECK_MS 100U
+
+/** Watchdog timeout, from the last reload */
+#define SUPERVISOR_WATCHDOG_MS 2000U
+
+/** Returned by supervisor_register() when the table is full */
+#define SUPERVISOR_INVALID_ID 0xFFU
+
+/** Registration number of a task */
+typedef uint8_t supervisor_id_t;
+
+/**
+ * @brief Supervision figures of one task
+ */
+typedef struct
+{
+    const char *name;         /**< Task name */
+    uint32_t    period_ms;    /**< Period of the check-ins */
+    uint32_t    deadline_ms;  /**< Longest gap before a miss */
+    uint32_t    checkins;     /**< Check-ins since registration */
+    uint32_t    misses;       /**< Deadlines missed */
+    uint32_t    max_gap_ms;   /**< Longest gap between two check-ins */
+    uint32_t    last_miss_ms; /**< Uptime of the last miss, 0 if none */
+    bool        late;         /**< Past its deadline now */
+    bool        idle;         /**< Not supervised until the next check-in */
+} supervisor_stats_t;
+
+/**
+ * @brief Register the calling task
+ *
+ * The deadline runs from the registration. Called once per task, from
+ * the task itself or before it starts.
+ *
+ * @param[in] name        Task name, kept by reference
+ * @param[in] period_ms   Period of the check-ins
+ * @param[in] deadline_ms Longest gap before a miss, at least the period
+ * @return Registration number, SUPERVISOR_INVALID_ID if the table is full
+ */
+supervisor_id_t supervisor_register(const char *name, uint32_t period_ms,
+                                    uint32_t deadline_ms);
+
+/**
+ * @brief Report a unit of work done
+ *
+ * Task context. Does nothing for SUPERVISOR_INVALID_ID.
+ *
+ * @param[in] id Registration number
+ */
+void supervisor_checkin(supervisor_id_t id);
+
+/**
+ * @brief Stop supervising a task until its next check-in
+ *
+ * Task context, before a wait with no bound.
+ *
+ * @param[in] id Registration number
+ */
+void supervisor_idle(supervisor_id_t id);
+
+/**
+ * @brief Read the figures of a registered task
+ *
+ * @param[in]  index Registration number, from 0
+ * @param[out] stats Receives the figures
+ * @return false if @p index is past the last task registered
+ */
+bool supervisor_get_stats(uint32_t index, supervisor_stats_t *stats);
+
+/**
+ * @brief Print the figures of every registered task
+ *
+ * Monitor task, part of its snapshot.
+ */
+void supervisor_print(void);
+
+/**
+ * @brief Start the watchdog and the supervisor task
+ *
+ * Called once by the main task.
+ */
+void supervisor_start(void);
+
+#endif /* SUPERVISOR_H */
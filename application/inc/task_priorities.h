@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Task Priority Map
+ *
+ * Every task of the firmware takes its priority from here. The layout is
+ * rate monotonic: the shorter the period or deadline a task has to meet,
+ * the higher it runs.
+ *
+ *   Prio  Task                 Period / deadline
+ *   9     AdcFilter, SpiAdc,   filtering of one ADC1 block, 3.2 ms, and
+ *         EthIf, Tmr Svc,        publishing of one SPI ADC block, ahead of
+ *         DoSched, Supervisor    every task that reads them; Ethernet RX
+ *                                hand-off per interrupt; timers; a
+ *                                scheduled output, within microseconds;
+ *                                the deadline check, 100 ms, so no task
+ *                                below it can hide a miss
+ *   8     AdcStream, Cyclic,   one ADC1 block, 3.2 ms (32 samples, 10 kHz)
+ *         UsbLog, UsbStream
+ *   7     ModbusRTU, GwRS485   RS-485 turnaround, about 1 ms at 115200 baud
+ *   6     tcpip_thread         lwIP core, serves every netconn user below
+ *   5     Ethernet             link poll, 10 ms
+ *   4     Modbus, ModbusW0-3,  Modbus TCP requests, tens of ms
+ *         ModbusTLS
+ *   3     Network, UsbWrite,   interface bring-up, once; one USB log
+ *         Ptp, ModbusRBE,      buffer, 256 ms; one Sync interval, the
+ *         SnapPub, NorWrite,     timestamps are taken by the MAC; one
+ *         WsPush, Mqtt,          subscription scan, 10 ms, best effort;
+ *         OpcUa                  one snapshot, 10 ms at 100 Hz, best
+ *                                effort; one NOR log page, 0.9 s; one
+ *                                live data frame, 40 ms, best effort;
+ *                                one MQTT period, 100 ms at the least;
+ *                                one OPC UA channel mean, 20 ms, best
+ *                                effort
+ *   2     Log, Trace, Config,  console drain, 10 ms, tolerant of delay;
+ *         Profile, MbCapture     trace drain, 10 ms, best effort; one
+ *                                configuration commit, 1 s after a write;
+ *                                profile drain, 10 ms, best effort;
+ *                                capture drain, 20 ms, best effort
+ *   1     Main, Fota, Monitor, seconds
+ *         NorFill, ArchWrite
+ *         Spectrum             one frame, 102.4 ms, best effort
+ *   0     IDLE                 tickless idle (low_power.h)
+ *
+ * The values are plain numbers rather than offsets of tskIDLE_PRIORITY
+ * (always 0) so FreeRTOSConfig.h and lwipopts.h can use them.
+ * task_priorities_check() verifies at startup that every running task
+ * matches the map.
+ */
+
+#ifndef TASK_PRIORITIES_H
+#define TASK_PRIORITIES_H
+
+/** Number of priority levels, configMAX_PRIORITIES */
+#define TASK_PRIORITY_LEVELS 10U
+
+#define TASK_PRIO_ADC_FILTER  9U
+#define TASK_PRIO_SPI_ADC     9U
+#define TASK_PRIO_ETHIF       9U
+#define TASK_PRIO_TIMER       9U
+#define TASK_PRIO_DO_SCHEDULE 9U
+#define TASK_PRIO_SUPERVISOR  9U
+#define TASK_PRIO_ADC_STREAM  8U
+#define TASK_PRIO_CYCLIC      8U
+#define TASK_PRIO_USB_LOG     8U
+#define TASK_PRIO_USB_STREAM  8U
+#define TASK_PRIO_RS485       7U
+#define TASK_PRIO_TCPIP       6U
+#define TASK_PRIO_ETHERNET    5U
+#define TASK_PRIO_MODBUS_TCP  4U
+#define TASK_PRIO_NETWORK     3U
+#define TASK_PRIO_USB_WRITE   3U
+#define TASK_PRIO_PTP         3U
+#define TASK_PRIO_MODBUS_RBE  3U
+#define TASK_PRIO_SNAPSHOT    3U
+#define TASK_PRIO_NOR_WRITE   3U
+#define TASK_PRIO_WS_PUSH     3U
+#define TASK_PRIO_MQTT        3U
+#define TASK_PRIO_OPCUA       3U
+#define TASK_PRIO_LOG         2U
+#define TASK_PRIO_TRACE       2U
+#define TASK_PRIO_CONFIG      2U
+#define TASK_PRIO_PROFILE     2U
+#define TASK_PRIO_MB_CAPTURE  2U
+#define TASK_PRIO_BACKGROUND  1U
+#define TASK_PRIO_SPECTRUM    1U
+
+#if TASK_PRIO_ETHIF >= TASK_PRIORITY_LEVELS
+#error "Task priorities must stay below TASK_PRIORITY_LEVELS"
+#endif
+
+#if !((TASK_PRIO_ADC_FILTER > TASK_PRIO_ADC_STREAM) && \
+      (TASK_PRIO_ADC_STREAM > TASK_PRIO_RS485) &&  \
+      (TASK_PRIO_RS485 > TASK_PRIO_TCPIP) &&       \
+      (TASK_PRIO_TCPIP > TASK_PRIO_ETHERNET) &&    \
+      (TASK_PRIO_ETHERNET > TASK_PRIO_MODBUS_TCP) && \
+      (TASK_PRIO_MODBUS_TCP > TASK_PRIO_LOG))
+#error "Task priorities must follow the rate monotonic order above"
+#endif
+
+/**
+ * @brief Check the base priority of every task against the map
+ *
+ * A task that is missing from the map or runs at another priority is
+ * printed and trips configASSERT(). Call once all tasks have started.
+ */
+void task_priorities_check(void);
+
+#endif /* TASK_PRIORITIES_H */
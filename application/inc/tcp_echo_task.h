@@ -1,11 +0,0 @@
-/*
- * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
- * All rights reserved.
- */
-
-#ifndef TCP_ECHO_TASK_H
-#define TCP_ECHO_TASK_H
-
-void vTcpEchoTask(void *pvParameters);
-
-#endif /* TCP_ECHO_TASK_H */
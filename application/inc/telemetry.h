@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Binary Telemetry
+ *
+ * Every telemetry period the monitor task builds one binary health frame.
+ * The frame is sent as a UDP datagram to the configured destination, and
+ * the last one built can be read at any time as file TELEMETRY_FILE_NUMBER
+ * with Modbus FC20 (Read File Record): record n holds bytes 2n and 2n + 1,
+ * the first in the high byte, and an odd frame is padded with a zero byte.
+ * All fields are little-endian.
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, TELEMETRY_MAGIC ("JT")
+ *   2       1     Format version, TELEMETRY_VERSION
+ *   3       1     Number of sections
+ *   4       2     Frame length in bytes, CRC included
+ *   6       2     Telemetry period in seconds
+ *   8       4     Frame sequence number (1 per frame built)
+ *   12      4     Uptime in milliseconds
+ *   16      ...   Sections
+ *   end-2   2     CRC-16/MODBUS of all bytes before it
+ *
+ * A section is a 4-byte header (ID, number of entries, body length in
+ * bytes as u16) followed by its entries. A receiver skips sections it does
+ * not know; the version changes only when the layout of a known section
+ * does. A section that does not fit the frame is left out.
+ *
+ *   ID  Section     One entry
+ *   1   LWIP_MEM    heap avail, used, max, err (u32 each)
+ *   2   LWIP_MEMP   pool name (TELEMETRY_NAME_SIZE bytes, NUL padded),
+ *                   avail, used, max, err (u16 each)
+ *   3   LINK        lwIP link recv, xmit, drop, Ethernet RX interrupts
+ *                   (u32 each)
+ *   4   CPU         load of all tasks but idle, of the ADC1 DMA and of
+ *                   the Ethernet interrupt (u16 each, 0.01 %), reserved u16
+ *   5   TASKS       task name (TELEMETRY_NAME_SIZE bytes), load (u16,
+ *                   0.01 %), stack high water mark (u16, words)
+ *   6   ADC         filtered samples, filter block overruns (u32 each)
+ *   7   METRICS     total of each metrics.h counter in metric_id_t order
+ *                   (u32 each)
+ *   8   LATENCY     transport (u8, modbus_diag_transport_t), function code
+ *                   group (u8, modbus_latency_fc_t), MODBUS_LATENCY_MIN_SHIFT
+ *                   (u8), bucket count B (u8), requests (u32), cycle
+ *                   counter rate in Hz (u32), B buckets (u16 each), mean
+ *                   parse, dispatch, callback and encode time in us (u16
+ *                   each); groups without requests are left out
+ *   9   LWIP_SIZES  RAM per element of each LWIP_MEMP pool, in the same
+ *                   order, pool overhead included (u16, bytes)
+ *   10  SYS_POOLS   pool name (TELEMETRY_NAME_SIZE bytes), RAM per object
+ *                   in bytes, objects, mailbox depth (0 for others), used,
+ *                   max used, refused allocations, most messages a mailbox
+ *                   held, posts refused by a full mailbox (u16 each)
+ *   11  ICACHE      milliseconds since the last frame, instruction cache
+ *                   hits, misses (at most BSP_ICACHE_MISS_MAX), address
+ *                   and size of the hot code (u32 each)
+ *
+ * Sections 9 and 10 are built with LWIP_PROFILE only (lwipopts.h), for
+ * tools/lwip_pool_profile.py, which records the frames of a workload and
+ * recommends pool sizes from them.
+ *
+ * The cache counts of section 11 are those of the interval since the last
+ * frame (BSP_ICache_ReadMonitor()), all 0 while the cache is off; with
+ * ICACHE_ENABLE the monitor task turns it on as it starts. The miss count
+ * stops at its maximum, so the period is kept short enough for it while
+ * judging a code layout: a few seconds for the hot code of
+ * JERRY_TEXT_HOT.
+ *
+ * CPU loads and stack high water marks are those of the last CPU load
+ * window (cpu_load.h). A frame read over several FC20 requests can mix two
+ * frames if a new one is built in between; the CRC then fails and the
+ * client reads it again.
+ *
+ * tools/telemetry_decoder.py is the matching decoder.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "modbus_types.h"
+
+/** The monitor task turns the instruction cache on as it starts */
+#ifndef ICACHE_ENABLE
+#define ICACHE_ENABLE 0
+#endif
+
+/** Frame magic: the bytes 'J', 'T' */
+#define TELEMETRY_MAGIC 0x544AU
+
+/** Frame format version */
+#define TELEMETRY_VERSION 1U
+
+/** Frame header size in bytes */
+#define TELEMETRY_HEADER_SIZE 16U
+
+/** Largest frame, one UDP datagram on an Ethernet MTU */
+#define TELEMETRY_MAX_FRAME_SIZE 1472U
+
+/** Size of the name field of pool and task entries */
+#define TELEMETRY_NAME_SIZE 16U
+
+/** File number of the last frame for FC20 */
+#define TELEMETRY_FILE_NUMBER 1U
+
+/** Default frame period in seconds */
+#define TELEMETRY_DEFAULT_PERIOD_S 10U
+
+/** Default destination UDP port */
+#define TELEMETRY_DEFAULT_PORT 5006U
+
+/**
+ * @brief Section IDs
+ */
+typedef enum
+{
+    TELEMETRY_SECTION_LWIP_MEM   = 1,
+    TELEMETRY_SECTION_LWIP_MEMP  = 2,
+    TELEMETRY_SECTION_LINK       = 3,
+    TELEMETRY_SECTION_CPU        = 4,
+    TELEMETRY_SECTION_TASKS      = 5,
+    TELEMETRY_SECTION_ADC        = 6,
+    TELEMETRY_SECTION_METRICS    = 7,
+    TELEMETRY_SECTION_LATENCY    = 8,
+    TELEMETRY_SECTION_LWIP_SIZES = 9,
+    TELEMETRY_SECTION_SYS_POOLS  = 10,
+    TELEMETRY_SECTION_ICACHE     = 11
+} telemetry_section_t;
+
+/**
+ * @brief Telemetry configuration
+ *
+ * Frames are built every @c period_s seconds, none if it is 0, and sent
+ * when @c dest_addr and @c dest_port are non-zero.
+ */
+typedef struct
+{
+    uint16_t period_s;  /**< Frame period in seconds, 0 = off */
+    uint32_t dest_addr; /**< Destination IPv4 address, a.b.c.d as 0xaabbccdd */
+    uint16_t dest_port; /**< Destination UDP port */
+} telemetry_config_t;
+
+/**
+ * @brief Apply a new telemetry configuration
+ *
+ * Safe to call from any task. The monitor task picks the configuration up
+ * at once and builds a frame with it.
+ *
+ * @param config New configuration
+ */
+void telemetry_set_config(const telemetry_config_t *config);
+
+/**
+ * @brief Build and send a frame when one is due
+ *
+ * Monitor task only.
+ *
+ * @param now Build a frame even if the period has not elapsed
+ * @return Ticks until the next frame is due, portMAX_DELAY if off
+ */
+TickType_t telemetry_poll(bool now);
+
+/**
+ * @brief Read records of the last frame, the FC20 file reader
+ *
+ * Set on the slave contexts with modbus_slave_set_file_reader().
+ *
+ * @param[in]  file_number   TELEMETRY_FILE_NUMBER
+ * @param[in]  record_number First record
+ * @param[in]  record_length Number of records
+ * @param[out] values        Record values
+ * @return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS unless all records lie in
+ *         the last frame
+ */
+modbus_exception_t telemetry_read_file_record(uint16_t  file_number,
+                                              uint16_t  record_number,
+                                              uint16_t  record_length,
+                                              uint16_t *values);
+
+#endif /* TELEMETRY_H */
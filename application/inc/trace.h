@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Kernel and Interrupt Event Trace
+ *
+ * Records what the scheduler and the interrupts did, so that a latency
+ * outlier can be traced to its cause. The FreeRTOS trace macros
+ * (FreeRTOSConfig.h) record every task switch, queue, semaphore and mutex
+ * operation and the tick interrupt; the accounted interrupt handlers
+ * (BSP_ISR_SetTraceHook()) record their entry and exit; and TRACE_USER()
+ * marks points of the application, such as the start and end of a Modbus
+ * request or of an ADC1 block.
+ *
+ * An event is one 8-byte record in a RAM ring of TRACE_RING_RECORDS,
+ * written with the kernel interrupts masked: a record costs a call, a
+ * cycle counter read and four stores, a few dozen cycles. Nothing is
+ * recorded while no client is connected. A full ring drops the new
+ * records, counted as METRIC_TRACE_DROP; the stream then carries one
+ * TRACE_EVENT_OVERFLOW record with the number lost.
+ *
+ * The trace task (Trace) serves one client at a time on TCP port
+ * TRACE_PORT. On connection it sends a header and the task table, then
+ * streams the records every TRACE_DRAIN_MS until the client closes. All
+ * fields are little-endian.
+ *
+ *   Offset  Size  Field
+ *   0       2     Magic, TRACE_MAGIC ("JR")
+ *   2       1     Format version, TRACE_VERSION
+ *   3       1     Record size, TRACE_RECORD_SIZE
+ *   4       4     Cycle counter rate in Hz
+ *   8       2     Number of tasks n
+ *   10      2     Reserved, 0
+ *   12      20n   Tasks: number (u16), priority (u8), reserved (u8), name
+ *                 (TRACE_NAME_SIZE bytes, NUL padded)
+ *
+ * A record is the low 32 bits of the cycle counter (u32; it wraps every
+ * 17 s at 250 MHz, and the trace task's own switches keep the gaps far
+ * shorter), the event (u8, trace_event_t), a context byte and an argument
+ * (u16):
+ *
+ *   Event                 Context                Argument
+ *   TASK_SWITCH           0                      task number
+ *   ISR_ENTER, ISR_EXIT   bsp_isr_t, or          0
+ *                         TRACE_ISR_TICK
+ *   QUEUE_SEND, _RECEIVE  1 from an interrupt    queue number
+ *   QUEUE_SEND_FAILED,    1 from an interrupt    queue number
+ *   QUEUE_RECEIVE_FAILED
+ *   QUEUE_BLOCK           1 on send, 0 receive   queue number
+ *   USER                  trace_user_t           value of the point
+ *   OVERFLOW              0                      records lost (saturated)
+ *
+ * Queue numbers count the queues, semaphores and mutexes from 1 in the
+ * order they were created. Task numbers are those of the task table.
+ *
+ * The recorder is built when TRACE_ENABLE is 1 (CMake option JERRY_TRACE).
+ * tools/trace_convert.py records the stream and converts it to the Chrome
+ * trace event format, opened by Perfetto and chrome://tracing.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 0
+#endif
+
+/** Header magic: the bytes 'J', 'R' */
+#define TRACE_MAGIC 0x524AU
+
+/** Stream format version */
+#define TRACE_VERSION 1U
+
+/** Header size in bytes, without the task table */
+#define TRACE_HEADER_SIZE 12U
+
+/** Size of one record in bytes */
+#define TRACE_RECORD_SIZE 8U
+
+/** Size of the name field of a task entry */
+#define TRACE_NAME_SIZE 16U
+
+/** Size of a task entry in bytes */
+#define TRACE_TASK_ENTRY_SIZE (4U + TRACE_NAME_SIZE)
+
+/** Records the ring holds, a power of two */
+#define TRACE_RING_RECORDS 1024U
+
+/** Period at which the trace task drains the ring */
+#define TRACE_DRAIN_MS 10U
+
+/** TCP port of the trace stream */
+#define TRACE_PORT 5010U
+
+/** ISR_ENTER and ISR_EXIT context of the kernel tick */
+#define TRACE_ISR_TICK 0xFFU
+
+/**
+ * @brief Record event
+ */
+typedef enum
+{
+    TRACE_EVENT_TASK_SWITCH          = 1,  /**< Task switched in */
+    TRACE_EVENT_ISR_ENTER            = 2,  /**< Interrupt handler entered */
+    TRACE_EVENT_ISR_EXIT             = 3,  /**< Interrupt handler left */
+    TRACE_EVENT_QUEUE_SEND           = 4,  /**< Queue send, semaphore give */
+    TRACE_EVENT_QUEUE_RECEIVE        = 5,  /**< Queue receive, take */
+    TRACE_EVENT_QUEUE_SEND_FAILED    = 6,  /**< Send gave up, queue full */
+    TRACE_EVENT_QUEUE_RECEIVE_FAILED = 7,  /**< Receive gave up, empty */
+    TRACE_EVENT_QUEUE_BLOCK          = 8,  /**< Task blocks on a queue */
+    TRACE_EVENT_USER                 = 9,  /**< TRACE_USER() point */
+    TRACE_EVENT_OVERFLOW             = 10, /**< Records lost before this */
+} trace_event_t;
+
+/**
+ * @brief Application trace points, the context of TRACE_EVENT_USER
+ */
+typedef enum
+{
+    TRACE_USER_MODBUS_REQUEST  = 0, /**< Modbus TCP request, function code */
+    TRACE_USER_MODBUS_RESPONSE = 1, /**< Response built, modbus_error_t */
+    TRACE_USER_ADC_BLOCK       = 2, /**< Block hook entered, block count */
+    TRACE_USER_ADC_BLOCK_DONE  = 3, /**< Block hook left */
+} trace_user_t;
+
+#if TRACE_ENABLE
+
+/** Mark an application trace point */
+#define TRACE_USER(point, value)                              \
+    trace_record((uint8_t)TRACE_EVENT_USER, (uint8_t)(point), \
+                 (uint16_t)(value))
+
+#else
+
+#define TRACE_USER(point, value) ((void)0)
+
+#endif /* TRACE_ENABLE */
+
+/**
+ * @brief Record one event
+ *
+ * Any context at or below configMAX_SYSCALL_INTERRUPT_PRIORITY; does
+ * nothing while no client is connected.
+ *
+ * @param[in] event   trace_event_t
+ * @param[in] context Context byte of the event
+ * @param[in] arg     Argument of the event
+ */
+void trace_record(uint8_t event, uint8_t context, uint16_t arg);
+
+/**
+ * @brief Next queue number, for traceQUEUE_CREATE()
+ *
+ * @return Numbers from 1, in order of the calls
+ */
+uint32_t trace_queue_number(void);
+
+/**
+ * @brief Start the trace task
+ *
+ * Called once by the main task.
+ */
+void trace_start(void);
+
+#endif /* TRACE_H */
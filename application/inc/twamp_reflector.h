@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * TWAMP Light Reflector
+ *
+ * Answers the test packets of a TWAMP Light sender (RFC 5357, appendix I,
+ * unauthenticated mode) on UDP port TWAMP_PORT, so that the network
+ * latency to the device can be measured apart from the time it spends on
+ * Modbus requests. There is no control session: any packet to the port is
+ * a test packet and is answered at once from lwIP's receive callback in
+ * the TCP/IP thread, without a task or a copy of the request.
+ *
+ * Each reply carries the time the request was taken in (T2) and the time
+ * the reply was handed to the network interface (T3), both read from the
+ * PTP system time (BSP_Time_NowNs()). With the sender's own send time (T1)
+ * and receive time (T4):
+ *
+ *   round trip       = (T4 - T1) - (T3 - T2)
+ *   forward one-way  = T2 - T1
+ *   backward one-way = T4 - T3
+ *
+ * The one-way delays only mean something when the sender follows the same
+ * PTP master as the device. T3 - T2 is the time spent in the reflector;
+ * the wait of a request between the MAC and the TCP/IP thread counts as
+ * network time.
+ *
+ * All fields are big-endian. Timestamps are in the truncated PTP format of
+ * RFC 8186, seconds (u32) then nanoseconds (u32), and the Z bit of each
+ * error estimate says so; the S bit is set while the PTP slave is locked
+ * (ptp_is_locked()). A sender's packet is at least TWAMP_SENDER_SIZE bytes:
+ *
+ *   Offset  Size  Field
+ *   0       4     Sequence number
+ *   4       8     Timestamp, T1
+ *   12      2     Error estimate
+ *   14      ...   Padding
+ *
+ * The reply is as long as the request, TWAMP_REFLECTOR_SIZE bytes at the
+ * least (RFC 6038 symmetrical size); its padding is zero:
+ *
+ *   Offset  Size  Field
+ *   0       4     Sequence number, one more per reply sent
+ *   4       8     Timestamp, T3
+ *   12      2     Error estimate
+ *   14      2     0
+ *   16      8     Receive timestamp, T2
+ *   24      4     Sender sequence number
+ *   28      8     Sender timestamp, T1
+ *   36      2     Sender error estimate
+ *   38      2     0
+ *   40      1     Sender TTL, the IP TTL of the request as received
+ *   41      ...   Padding
+ *
+ * The reply goes out with the DSCP of the request, so probes test each
+ * traffic class of the network (ethernetif.h). tools/twamp_probe.py is a
+ * matching sender.
+ *
+ * Built when TWAMP_REFLECTOR is 1 (CMake option JERRY_TWAMP).
+ */
+
+#ifndef TWAMP_REFLECTOR_H
+#define TWAMP_REFLECTOR_H
+
+#ifndef TWAMP_REFLECTOR
+#define TWAMP_REFLECTOR 1
+#endif
+
+/** UDP port of the test packets (RFC 8545) */
+#define TWAMP_PORT 862U
+
+/** Shortest sender packet */
+#define TWAMP_SENDER_SIZE 14U
+
+/** Shortest reply */
+#define TWAMP_REFLECTOR_SIZE 41U
+
+/** Longest reply, one Ethernet frame; longer requests are dropped */
+#define TWAMP_MAX_SIZE 1472U
+
+/**
+ * @brief Bind the test port
+ *
+ * Called once by the network task, with the network interface up.
+ */
+void twamp_reflector_start(void);
+
+#endif /* TWAMP_REFLECTOR_H */
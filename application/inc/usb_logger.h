@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * USB Flash Stick Sample Logger
+ *
+ * Records the raw ADC1 samples of all channels at the full sample rate to
+ * a USB flash stick, with no network involved. Logging starts when a
+ * stick is attached and stops when it is removed.
+ *
+ * Two tasks share the work. The capture task (UsbLog) drains the sample
+ * ring as the ADC stream does and packs samples into data blocks in one
+ * of USB_LOG_BUFFERS buffers; it never waits for the stick. A full buffer
+ * is handed to the writer task (UsbWrite), which writes it with a single
+ * SCSI command while the capture task fills the other one. When both are
+ * full the new samples are dropped and counted in METRIC_USB_LOG_LOST, so
+ * a slow stick costs samples, never acquisition time.
+ *
+ * No file system is used: the stick is written as a raw block device and
+ * any partition table or file system on it is overwritten. The medium is
+ * divided into slots of USB_LOG_FILE_BLOCKS blocks; each slot holds one
+ * log file and the files rotate through the slots, the oldest being
+ * overwritten once the stick is full. After an attach the writer reads the
+ * header of every slot and continues after the newest file. All fields are
+ * little-endian; tools/usb_log_reader.py lists and extracts the files.
+ *
+ * File header, block 0 of a slot:
+ *
+ *   Offset  Size  Field
+ *   0       4     Magic, USB_LOG_MAGIC ("JLOG")
+ *   4       2     Format version, USB_LOG_VERSION
+ *   6       2     Header size in bytes, USB_LOG_HEADER_SIZE
+ *   8       4     File number, counting up over the life of the stick
+ *   12      4     Slot number; the slot starts at slot * file size
+ *   16      4     File size in blocks, header included
+ *   20      2     Block size in bytes
+ *   22      2     Block offset of the first data block in the file
+ *   24      4     Sample rate in Hz
+ *   28      4     Timestamp rate in Hz
+ *   32      1     Channels per sample
+ *   33      1     ADC resolution in bits
+ *   34      2     Sample size in bytes
+ *   36      2     Data block header size in bytes
+ *   38      2     Samples per data block, at most
+ *   40      4     Sequence number of the first sample
+ *   44      8     Timestamp of the first sample
+ *   52      2     Sample coding, USB_LOG_CODING_RAW or _CODEC
+ *   54      2     Samples per encoded block, 0 if raw
+ *
+ * Data blocks follow from the data offset to the end of the slot:
+ *
+ *   Offset  Size  Field
+ *   0       4     File number; any other value ends the file
+ *   4       4     Sequence number of the first sample
+ *   8       8     Timestamp of the first sample, 0 if unknown
+ *   16      2     Samples in the block n, 0 for none
+ *   18      2     Samples lost just before this block (saturated)
+ *   20      4     Reserved, 0
+ *   24      12n   Samples: right-aligned results of A0..A5, uint16 each
+ *
+ * A coded file (USB_LOG_COMPRESS) holds the samples of a data block as
+ * encoded blocks of USB_LOG_CODEC_BLOCK samples (sample_codec.h), the last
+ * one possibly shorter, of a codec state initialized for every data block;
+ * typical signals fit about three times the samples in a block. Version 1 files
+ * have the 52-byte header without the coding fields and are raw.
+ *
+ * The samples of a block are consecutive; a gap in the sequence starts a
+ * new block. Timestamps count BSP_ADC1_TIMESTAMP_HZ ticks since boot and
+ * advance by BSP_ADC1_TIMESTAMP_HZ / the sample rate per sample; the header
+ * holds the rate when the file was started, and a change of rate
+ * (BSP_ADC1_SetSampleRate()) leaves a gap, so the next block starts anew.
+ */
+
+#ifndef USB_LOGGER_H
+#define USB_LOGGER_H
+
+#include <stdint.h>
+
+#include "bsp.h"
+#include "usb_msc.h"
+
+#ifndef USB_LOG_COMPRESS
+#define USB_LOG_COMPRESS 1
+#endif
+
+/** File header magic: the bytes 'J', 'L', 'O', 'G' */
+#define USB_LOG_MAGIC 0x474F4C4AUL
+
+/** Format version */
+#define USB_LOG_VERSION 2U
+
+/** File header size in bytes */
+#define USB_LOG_HEADER_SIZE 56U
+
+/** Sample codings of a file */
+#define USB_LOG_CODING_RAW   0U
+#define USB_LOG_CODING_CODEC 1U
+
+/** Samples per encoded block of a coded file */
+#define USB_LOG_CODEC_BLOCK 32U
+
+/** Data block header size in bytes */
+#define USB_LOG_BLOCK_HEADER_SIZE 24U
+
+/** Sample size in bytes: one uint16 per channel */
+#define USB_LOG_SAMPLE_SIZE (BSP_ADC1_NUM_CHANNELS * 2U)
+
+/** Sample bytes of one data block */
+#define USB_LOG_SAMPLE_AREA (USB_MSC_BLOCK_SIZE - USB_LOG_BLOCK_HEADER_SIZE)
+
+/** Samples that fit one data block */
+#define USB_LOG_SAMPLES_PER_BLOCK (USB_LOG_SAMPLE_AREA / USB_LOG_SAMPLE_SIZE)
+
+/** Samples of a coded data block, at most: one bit per channel each */
+#define USB_LOG_CODED_SAMPLES_PER_BLOCK \
+    ((USB_LOG_SAMPLE_AREA * 8U) / BSP_ADC1_NUM_CHANNELS)
+
+/** Blocks of a buffer, written by one command (32 KB, 256 ms of samples) */
+#define USB_LOG_BUFFER_BLOCKS USB_MSC_MAX_BLOCKS_PER_COMMAND
+
+/** Buffers between the capture and the writer task */
+#define USB_LOG_BUFFERS 2U
+
+/**
+ * Blocks of a file slot, 128 MB or about 17 minutes. The first buffer's
+ * worth holds the header so that data writes stay buffer aligned.
+ */
+#define USB_LOG_FILE_BLOCKS 262144U
+
+#endif /* USB_LOGGER_H */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * USB Mass Storage Host Class
+ *
+ * Bulk-Only Transport (BOT) with the SCSI transparent command set, on the
+ * BSP USB host port: enough to use a USB flash stick as a raw block device.
+ * One device is handled, attached directly to the port, using LUN 0 only;
+ * only 512-byte blocks are supported. All calls block the calling task and
+ * the port's transfers notify it on ::BSP_USBH_NOTIFY_INDEX.
+ *
+ * A command that the device fails with a check condition is followed by a
+ * REQUEST SENSE; a transport error goes through the BOT reset recovery, so
+ * the next command starts from a clean state.
+ */
+
+#ifndef USB_MSC_H
+#define USB_MSC_H
+
+#include <stdint.h>
+
+#include "bsp.h"
+
+/** Block size the class works with, in bytes */
+#define USB_MSC_BLOCK_SIZE 512U
+
+/** Largest number of blocks moved by one SCSI command */
+#define USB_MSC_MAX_BLOCKS_PER_COMMAND 64U
+
+/**
+ * @brief Attached mass storage device
+ *
+ * Filled by usb_msc_attach(); owned by the task that attached it.
+ */
+typedef struct
+{
+    uint32_t block_count; /**< Blocks on the medium */
+    uint32_t tag;         /**< Tag of the last command block wrapper */
+    uint32_t residue;     /**< Data stage bytes the last command left */
+    uint8_t  interface;   /**< Interface number of the BOT interface */
+    uint8_t  bulk_in;     /**< Bulk IN endpoint address */
+    uint8_t  bulk_out;    /**< Bulk OUT endpoint address */
+    uint8_t  sense_key;   /**< Sense key of the last failed command */
+    uint8_t  asc;         /**< Additional sense code of the same */
+} usb_msc_device_t;
+
+/**
+ * @brief Enumerate the attached device and bring its medium up
+ *
+ * Resets the port, assigns address 1, selects the first configuration
+ * with a BOT SCSI interface, and waits for the medium to become ready
+ * before reading its capacity.
+ *
+ * @param[out] device Device state.
+ * @return bsp_error_t BSP_OK with the device ready, BSP_INVALID_ARG if the
+ * device has no BOT SCSI interface or another block size, BSP_TIMEOUT if
+ * the medium does not become ready, or the BSP error of a failed transfer.
+ */
+bsp_error_t usb_msc_attach(usb_msc_device_t *device);
+
+/**
+ * @brief Read blocks from the medium
+ *
+ * @param device Attached device.
+ * @param lba    First block.
+ * @param count  Number of blocks.
+ * @param[out] data Destination of count * USB_MSC_BLOCK_SIZE bytes.
+ * @return bsp_error_t BSP_OK, BSP_INVALID_ARG for blocks past the end of
+ * the medium, BSP_ERROR if the device fails the command, or the BSP error
+ * of a failed transfer.
+ */
+bsp_error_t usb_msc_read(usb_msc_device_t *device, uint32_t lba,
+                         uint32_t count, uint8_t *data);
+
+/**
+ * @brief Write blocks to the medium
+ *
+ * @param device Attached device.
+ * @param lba    First block.
+ * @param count  Number of blocks.
+ * @param data   count * USB_MSC_BLOCK_SIZE bytes, not modified.
+ * @return bsp_error_t as usb_msc_read().
+ */
+bsp_error_t usb_msc_write(usb_msc_device_t *device, uint32_t lba,
+                          uint32_t count, uint8_t *data);
+
+#endif /* USB_MSC_H */
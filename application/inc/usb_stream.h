@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Waveform Streaming over USB
+ *
+ * Built with JERRY_USB_STREAM, the USB connector is a full-speed device
+ * (BSP_USBD) instead of the stick logger's host port, and streams the
+ * ADC1 sample ring to the host it is plugged into, with no network
+ * involved. Every bulk IN transfer on BSP_USBD_EP_BULK_IN is one block in
+ * the format of a UDP stream datagram (adc_stream_task.h): the 32-byte
+ * header, then the frames. The block sequence numbers count blocks as the
+ * datagram sequence numbers count datagrams, so a receiver of the UDP
+ * stream decodes and reassembles the blocks unchanged. Blocks are never
+ * compressed; full speed carries every channel raw and filtered at the
+ * full rate.
+ *
+ * The capture task (UsbStream) drains the ring as the UDP stream task
+ * does and packs the frames straight into one of USB_STREAM_BUFFERS block
+ * buffers, which is handed to the port as it is: the USB interrupt copies
+ * it into the packet memory packet by packet as the host reads it, and the
+ * buffer is filled again once sent. While every buffer waits for the host
+ * the samples wait in the ring, and those the ring overwrites count as
+ * lost in the header and in METRIC_USB_STREAM_LOST, as do the blocks of a
+ * bus reset.
+ *
+ * The device is vendor-specific (class 0xFF) with one interface and the
+ * bulk endpoint; libusb drives it on Linux and macOS, and on Windows the
+ * MS OS 2.0 descriptors bind WinUSB without an INF file. The host starts
+ * and stops the stream with vendor requests to the device:
+ *
+ *   bRequest                 Dir  wValue                 wIndex
+ *   USB_STREAM_REQ_START     OUT  mask | content << 8    bit 0: decimated
+ *   USB_STREAM_REQ_STOP      OUT  0                      0
+ *   USB_STREAM_REQ_INFO      IN   0                      0
+ *
+ * The mask selects the channels (bit 0 = A0) and the content is
+ * ADC_STREAM_FLAG_RAW, ADC_STREAM_FLAG_FILTERED and/or ADC_STREAM_FLAG_DI,
+ * the word of the captured digital inputs; a start reads the
+ * ring from its newest sample. Blocks already queued when the stream
+ * stops are still sent. The info reply, little-endian:
+ *
+ *   Offset  Size  Field
+ *   0       1     Channels of ADC1
+ *   1       1     1 while streaming
+ *   2       2     Largest block in bytes, USB_STREAM_BLOCK_SIZE
+ *   4       4     Sample rate of the full stream in Hz
+ *   8       2     Decimation factor of the decimated stream
+ *   10      2     Reserved, 0
+ *   12      4     Blocks sent
+ *   16      4     Samples lost
+ *
+ * tools/usb_stream_receiver.py is the matching receiver.
+ */
+
+#ifndef USB_STREAM_H
+#define USB_STREAM_H
+
+#include "bsp.h"
+
+/** USB vendor and product ID, the pid.codes test pair: a product ships
+ *  with its own */
+#ifndef USB_STREAM_VENDOR_ID
+#define USB_STREAM_VENDOR_ID 0x1209U
+#endif
+#ifndef USB_STREAM_PRODUCT_ID
+#define USB_STREAM_PRODUCT_ID 0x0001U
+#endif
+
+/** Vendor requests */
+#define USB_STREAM_REQ_START 0x01U /**< Start streaming */
+#define USB_STREAM_REQ_STOP  0x02U /**< Stop streaming */
+#define USB_STREAM_REQ_INFO  0x03U /**< Read the stream information */
+#define USB_STREAM_REQ_MS_OS 0x4DU /**< MS OS 2.0 descriptor set */
+
+/** wIndex bit of USB_STREAM_REQ_START selecting the decimated stream */
+#define USB_STREAM_START_DECIMATED 0x0001U
+
+/** Largest block, the size of the largest stream datagram */
+#define USB_STREAM_BLOCK_SIZE 1472U
+
+/** Size of the USB_STREAM_REQ_INFO reply */
+#define USB_STREAM_INFO_SIZE 20U
+
+#if BSP_USBD_ENABLE
+/**
+ * @brief Start the USB device and the capture task
+ *
+ * Call once from the main task, in place of the stick logger's tasks.
+ * The host enumerates the device once it is plugged in; streaming waits
+ * for USB_STREAM_REQ_START.
+ */
+void usb_stream_start(void);
+#endif
+
+#endif /* USB_STREAM_H */
@@ -0,0 +1,852 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Round-Robin Archives
+ *
+ * The filter task owns the RAM pages and the minute being folded, and
+ * hands each full page over as a copy through the page queue, so it never
+ * waits for the writer. The writer alone changes the write positions of
+ * the rings; it and the queries read them, and make every flash call,
+ * with the mutex of the sample log held (nor_log_lock()), one page or one
+ * erase step at a time. The Modbus query result has a mutex of its own,
+ * held while a query runs into it. See adc_archive.h.
+ */
+
+#include "adc_archive.h"
+
+#if ADC_ARCHIVE
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "bsp_sections.h"
+#include "log.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "nor_log.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the writer task (words) */
+#define ADC_ARCHIVE_STACK_SIZE 256U
+
+/** Pages queued for the writer */
+#define ADC_ARCHIVE_QUEUE_PAGES 4U
+
+/** Writer wait for a page, and its erase poll period */
+#define ADC_ARCHIVE_POLL_MS 100U
+
+/** Seconds folded into a minute record */
+#define ADC_ARCHIVE_MINUTE_S 60U
+
+/** Sequence field of an erased page */
+#define ADC_ARCHIVE_ERASED 0xFFFFFFFFU
+
+_Static_assert(BSP_SPINOR_PAGE_SIZE == (ADC_ARCHIVE_PAGE_CRC_OFFSET + 2U),
+               "the CRC must end a page");
+_Static_assert(ADC_ARCHIVE_PAGE_RECORDS > 0U, "a page must hold a record");
+_Static_assert((ADC_ARCHIVE_FILE_MAX_RECORDS % ADC_ARCHIVE_PAGE_RECORDS) ==
+                   0U,
+               "the file result must hold whole pages");
+_Static_assert((ADC_ARCHIVE_HEADER_RECORDS +
+                (ADC_ARCHIVE_FILE_MAX_RECORDS *
+                 ADC_ARCHIVE_FILE_RECORD_SIZE)) <= 0xFFFFU,
+               "the file result must be addressable by FC20");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Ring of an archive, changed by the writer under the flash mutex
+ */
+typedef struct
+{
+    uint32_t first;   /**< First sector of the ring on the flash */
+    uint32_t sectors; /**< Sectors in the ring */
+    uint32_t next;    /**< Sequence of the page written next */
+    uint32_t clean;   /**< Pages from @c next up to this sequence, a sector
+                           start, are erased */
+    bool erasing;     /**< The sector of @c clean is being erased */
+} adc_archive_ring_t;
+
+/**
+ * @brief Page being filled (filter task)
+ */
+typedef struct
+{
+    uint32_t count;                      /**< Records in the page */
+    uint8_t  page[BSP_SPINOR_PAGE_SIZE]; /**< The page, but for its sequence
+                                              and CRC */
+} adc_archive_fill_t;
+
+/**
+ * @brief Minute being folded (filter task)
+ */
+typedef struct
+{
+    uint32_t start_s;                   /**< Start of the minute, s */
+    uint32_t seconds;                   /**< Seconds folded in, 0 if none */
+    uint16_t min[ADC_ARCHIVE_CHANNELS]; /**< Lowest values */
+    uint16_t max[ADC_ARCHIVE_CHANNELS]; /**< Highest values */
+    uint32_t sum[ADC_ARCHIVE_CHANNELS]; /**< Sums of the means */
+} adc_archive_minute_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+static StaticTask_t s_task_tcb;
+static StackType_t  s_task_stack[ADC_ARCHIVE_STACK_SIZE] BSP_SECTION_STACK;
+
+/** Full pages waiting for the writer */
+static StaticQueue_t s_queue_buffer;
+static uint8_t       s_queue_storage[ADC_ARCHIVE_QUEUE_PAGES *
+                                     BSP_SPINOR_PAGE_SIZE];
+static QueueHandle_t s_queue = NULL;
+
+/** Records kept, in adc_archive_id_t order */
+static const uint32_t s_ring_records[ADC_ARCHIVE_COUNT] = {
+    ADC_ARCHIVE_SECOND_RECORDS, ADC_ARCHIVE_MINUTE_RECORDS};
+
+/** Rings (flash mutex) */
+static adc_archive_ring_t s_rings[ADC_ARCHIVE_COUNT];
+
+/** Set by the writer once the rings are mounted */
+static atomic_bool s_mounted;
+
+/* Filter task only */
+static adc_archive_fill_t   s_fills[ADC_ARCHIVE_COUNT];
+static adc_archive_minute_t s_minute;
+
+/** Page being written (writer task) */
+static uint8_t s_page[BSP_SPINOR_PAGE_SIZE];
+
+/** Page read by a query (flash mutex) */
+static uint8_t s_read[BSP_SPINOR_PAGE_SIZE];
+
+/** Modbus query result (file mutex) */
+static StaticSemaphore_t    s_file_lock_buffer;
+static SemaphoreHandle_t    s_file_lock = NULL;
+static adc_archive_record_t s_file_records[ADC_ARCHIVE_FILE_MAX_RECORDS];
+static uint32_t             s_file_count;
+static uint8_t              s_file_archive;
+static bool                 s_file_more;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+static uint8_t *put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFU);
+    dst[1] = (uint8_t)(value >> 8U);
+    return &dst[2];
+}
+
+static uint8_t *put_u32(uint8_t *dst, uint32_t value)
+{
+    dst = put_u16(dst, (uint16_t)(value & 0xFFFFU));
+    return put_u16(dst, (uint16_t)(value >> 16U));
+}
+
+static uint16_t get_u16(const uint8_t *src)
+{
+    return (uint16_t)((uint16_t)src[0] | ((uint16_t)src[1] << 8U));
+}
+
+static uint32_t get_u32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8U) |
+           ((uint32_t)src[2] << 16U) | ((uint32_t)src[3] << 24U);
+}
+
+/**
+ * @brief Flash address of a page of a ring
+ */
+static uint32_t adc_archive_address(const adc_archive_ring_t *ring,
+                                    uint32_t                  sequence)
+{
+    uint32_t page = sequence % (ring->sectors * ADC_ARCHIVE_SECTOR_PAGES);
+
+    return (ring->first * BSP_SPINOR_SECTOR_SIZE) +
+           (page * BSP_SPINOR_PAGE_SIZE);
+}
+
+/**
+ * @brief Check the header fields of a page read back
+ *
+ * @param[in] page     The page, its header at least
+ * @param[in] archive  Archive of the ring it was read from
+ * @param[in] sequence Sequence it was read for
+ */
+static bool adc_archive_header_valid(const uint8_t *page, uint32_t archive,
+                                     uint32_t sequence)
+{
+    return (get_u32(page) == sequence) &&
+           (get_u16(&page[4]) == ADC_ARCHIVE_MAGIC) &&
+           (page[6] == (uint8_t)archive) && (page[7] != 0U) &&
+           (page[7] <= ADC_ARCHIVE_PAGE_RECORDS);
+}
+
+/**
+ * @brief Check a whole page read back
+ */
+static bool adc_archive_page_valid(const uint8_t *page, uint32_t archive,
+                                   uint32_t sequence)
+{
+    return adc_archive_header_valid(page, archive, sequence) &&
+           (modbus_crc16(page, ADC_ARCHIVE_PAGE_CRC_OFFSET) ==
+            get_u16(&page[ADC_ARCHIVE_PAGE_CRC_OFFSET]));
+}
+
+static void adc_archive_put_record(uint8_t                    *dst,
+                                   const adc_archive_record_t *record)
+{
+    dst = put_u32(dst, record->time_s);
+    for (uint32_t ch = 0U; ch < ADC_ARCHIVE_CHANNELS; ch++)
+    {
+        dst = put_u16(dst, record->min[ch]);
+    }
+    for (uint32_t ch = 0U; ch < ADC_ARCHIVE_CHANNELS; ch++)
+    {
+        dst = put_u16(dst, record->max[ch]);
+    }
+    for (uint32_t ch = 0U; ch < ADC_ARCHIVE_CHANNELS; ch++)
+    {
+        dst = put_u16(dst, record->mean[ch]);
+    }
+}
+
+static void adc_archive_get_record(const uint8_t        *src,
+                                   adc_archive_record_t *record)
+{
+    record->time_s = get_u32(src);
+    src            = &src[4];
+    for (uint32_t ch = 0U; ch < ADC_ARCHIVE_CHANNELS; ch++)
+    {
+        record->min[ch]  = get_u16(&src[ch * 2U]);
+        record->max[ch]  = get_u16(&src[(ADC_ARCHIVE_CHANNELS + ch) * 2U]);
+        record->mean[ch] =
+            get_u16(&src[((2U * ADC_ARCHIVE_CHANNELS) + ch) * 2U]);
+    }
+}
+
+/**
+ * @brief Sequence of the oldest page a ring still holds
+ *
+ * Flash mutex held.
+ */
+static uint32_t adc_archive_oldest(const adc_archive_ring_t *ring)
+{
+    uint32_t span = ring->sectors * ADC_ARCHIVE_SECTOR_PAGES;
+    uint32_t end  = ring->clean + (ring->erasing ? ADC_ARCHIVE_SECTOR_PAGES
+                                                 : 0U);
+
+    return (end > span) ? (end - span) : 0U;
+}
+
+/**
+ * @brief Add a record to the RAM page of an archive
+ *
+ * Queues the page once full. Filter task.
+ */
+static void adc_archive_add(uint32_t                    archive,
+                            const adc_archive_record_t *record)
+{
+    adc_archive_fill_t *fill = &s_fills[archive];
+
+    if (fill->count == 0U)
+    {
+        (void)memset(fill->page, 0xFF, sizeof(fill->page));
+        (void)put_u16(&fill->page[4], ADC_ARCHIVE_MAGIC);
+        fill->page[6] = (uint8_t)archive;
+    }
+
+    adc_archive_put_record(&fill->page[ADC_ARCHIVE_PAGE_HEADER_SIZE +
+                                       (fill->count *
+                                        ADC_ARCHIVE_RECORD_SIZE)],
+                           record);
+    fill->count++;
+    if (fill->count < ADC_ARCHIVE_PAGE_RECORDS)
+    {
+        return;
+    }
+
+    fill->page[7] = (uint8_t)fill->count;
+    if (xQueueSend(s_queue, fill->page, 0U) != pdPASS)
+    {
+        metrics_add(METRIC_ARCHIVE_LOST, fill->count);
+    }
+    fill->count = 0U;
+}
+
+/**
+ * @brief Add the minute folded so far to the minute archive
+ */
+static void adc_archive_close_minute(void)
+{
+    adc_archive_record_t record;
+
+    record.time_s = s_minute.start_s;
+    for (uint32_t ch = 0U; ch < ADC_ARCHIVE_CHANNELS; ch++)
+    {
+        record.min[ch]  = s_minute.min[ch];
+        record.max[ch]  = s_minute.max[ch];
+        record.mean[ch] = (uint16_t)((s_minute.sum[ch] +
+                                      (s_minute.seconds / 2U)) /
+                                     s_minute.seconds);
+    }
+    adc_archive_add(ADC_ARCHIVE_MINUTES, &record);
+    s_minute.seconds = 0U;
+}
+
+/**
+ * @brief Find the first page of a ring left to write after a restart
+ *
+ * The pages of a sector are written in order, so the first erased one
+ * ends them. Writer task, flash mutex held.
+ *
+ * @param[in] sequence Sequence of the first page of the sector
+ * @return Pages written in the sector, 1 to ADC_ARCHIVE_SECTOR_PAGES
+ */
+static uint32_t adc_archive_find_end(const adc_archive_ring_t *ring,
+                                     uint32_t                  sequence)
+{
+    uint32_t lo = 1U;
+    uint32_t hi = ADC_ARCHIVE_SECTOR_PAGES;
+    uint8_t  word[4];
+
+    while (lo < hi)
+    {
+        uint32_t mid = lo + ((hi - lo) / 2U);
+
+        if ((BSP_SPINOR_Read(adc_archive_address(ring, sequence + mid), word,
+                             sizeof(word)) == BSP_OK) &&
+            (get_u32(word) == ADC_ARCHIVE_ERASED))
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1U;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * @brief Find the write position of a ring from its newest sector
+ *
+ * Writer task, flash mutex held.
+ */
+static void adc_archive_mount(adc_archive_ring_t *ring, uint32_t archive)
+{
+    uint32_t span   = ring->sectors * ADC_ARCHIVE_SECTOR_PAGES;
+    uint32_t newest = 0U;
+    bool     found  = false;
+    uint32_t end;
+
+    for (uint32_t s = 0U; s < ring->sectors; s++)
+    {
+        uint32_t address = (ring->first + s) * BSP_SPINOR_SECTOR_SIZE;
+        uint32_t sequence;
+
+        if (BSP_SPINOR_Read(address, s_page, BSP_SPINOR_PAGE_SIZE) != BSP_OK)
+        {
+            continue;
+        }
+
+        /* A page of another archive, or of the log before it, is no start */
+        sequence = get_u32(s_page);
+        if (((sequence % span) != (s * ADC_ARCHIVE_SECTOR_PAGES)) ||
+            !adc_archive_page_valid(s_page, archive, sequence))
+        {
+            continue;
+        }
+        if (!found || ((int32_t)(sequence - newest) > 0))
+        {
+            newest = sequence;
+            found  = true;
+        }
+    }
+
+    ring->erasing = false;
+    if (!found)
+    {
+        /* Blank or foreign: start at the first sector once it is erased */
+        ring->next  = 0U;
+        ring->clean = 0U;
+        return;
+    }
+
+    /* No sector counts as erased beyond the pages left in the newest, so
+     * the erase ahead also redoes one that the reset cut short */
+    end         = adc_archive_find_end(ring, newest);
+    ring->next  = newest + end;
+    ring->clean = newest + ADC_ARCHIVE_SECTOR_PAGES;
+}
+
+/**
+ * @brief Keep the rest of the write sector and the next sector erased
+ *
+ * Ends the erase in flight once the flash has finished it and starts the
+ * next one needed; never waits. An erase the log started first is retried
+ * on the next call. Writer task, flash mutex held.
+ */
+static void adc_archive_erase_ahead(adc_archive_ring_t *ring)
+{
+    uint32_t wanted =
+        ((ring->next / ADC_ARCHIVE_SECTOR_PAGES) + 2U) *
+        ADC_ARCHIVE_SECTOR_PAGES;
+
+    if (ring->erasing)
+    {
+        if (BSP_SPINOR_IsErasing())
+        {
+            return;
+        }
+        ring->erasing = false;
+        ring->clean += ADC_ARCHIVE_SECTOR_PAGES;
+    }
+
+    if (((int32_t)(wanted - ring->clean) > 0) &&
+        (BSP_SPINOR_EraseSector(adc_archive_address(ring, ring->clean)) ==
+         BSP_OK))
+    {
+        ring->erasing = true;
+    }
+}
+
+/**
+ * @brief Write a page at the write position of its ring
+ *
+ * The position must be erased. A page that fails to program is given up
+ * and its position skipped; readers drop it by its CRC. Writer task, flash
+ * mutex held.
+ *
+ * @param[in,out] page Page, but for its sequence and CRC
+ */
+static void adc_archive_write_page(adc_archive_ring_t *ring, uint8_t *page)
+{
+    (void)put_u32(page, ring->next);
+    (void)put_u16(&page[ADC_ARCHIVE_PAGE_CRC_OFFSET],
+                  modbus_crc16(page, ADC_ARCHIVE_PAGE_CRC_OFFSET));
+
+    if (BSP_SPINOR_ProgramPage(adc_archive_address(ring, ring->next), page) !=
+        BSP_OK)
+    {
+        metrics_add(METRIC_ARCHIVE_LOST, page[7]);
+    }
+    ring->next++;
+}
+
+/**
+ * @brief Writer task: mount the rings, erase ahead and write the pages
+ */
+static void adc_archive_task(void *pvParameters)
+{
+    uint32_t size;
+    uint32_t sector;
+    bool     pending = false;
+
+    (void)pvParameters;
+
+    /* The log probes the flash, which resets it */
+    while (!nor_log_flash_size(&size))
+    {
+        vTaskDelay(pdMS_TO_TICKS(ADC_ARCHIVE_POLL_MS));
+    }
+    sector = size / BSP_SPINOR_SECTOR_SIZE;
+    if (sector < ADC_ARCHIVE_SECTORS)
+    {
+        LOG("Archive: No flash of %u sectors found\n",
+            (unsigned int)ADC_ARCHIVE_SECTORS);
+        vTaskDelete(NULL);
+    }
+
+    sector -= ADC_ARCHIVE_SECTORS;
+    (void)nor_log_lock(portMAX_DELAY);
+    for (uint32_t a = 0U; a < (uint32_t)ADC_ARCHIVE_COUNT; a++)
+    {
+        adc_archive_ring_t *ring = &s_rings[a];
+
+        ring->first   = sector;
+        ring->sectors = ADC_ARCHIVE_RING_SECTORS(s_ring_records[a]);
+        sector += ring->sectors;
+        adc_archive_mount(ring, a);
+    }
+    nor_log_unlock();
+
+    LOG("Archive: Writing second page %lu, minute page %lu\n",
+        (unsigned long)s_rings[ADC_ARCHIVE_SECONDS].next,
+        (unsigned long)s_rings[ADC_ARCHIVE_MINUTES].next);
+    atomic_store(&s_mounted, true);
+
+    for (;;)
+    {
+        adc_archive_ring_t *ring;
+        bool                ready;
+
+        (void)nor_log_lock(portMAX_DELAY);
+        for (uint32_t a = 0U; a < (uint32_t)ADC_ARCHIVE_COUNT; a++)
+        {
+            adc_archive_erase_ahead(&s_rings[a]);
+        }
+        nor_log_unlock();
+
+        if (!pending)
+        {
+            if (xQueueReceive(s_queue, s_page,
+                              pdMS_TO_TICKS(ADC_ARCHIVE_POLL_MS)) != pdPASS)
+            {
+                continue;
+            }
+            pending = true;
+        }
+
+        /* The page waits for the erase ahead to catch up */
+        ring = &s_rings[s_page[6]];
+        (void)nor_log_lock(portMAX_DELAY);
+        ready = (int32_t)(ring->clean - ring->next) > 0;
+        if (ready)
+        {
+            adc_archive_write_page(ring, s_page);
+        }
+        nor_log_unlock();
+
+        if (ready)
+        {
+            pending = false;
+        }
+        else
+        {
+            vTaskDelay(pdMS_TO_TICKS(ADC_ARCHIVE_POLL_MS));
+        }
+    }
+}
+
+/**
+ * @brief Find the page a range query starts in
+ *
+ * The last page whose first record is not after the start of the range,
+ * by bisection over the pages kept; a page that does not read back counts
+ * as before the start. Flash mutex held.
+ */
+static void adc_archive_locate(adc_archive_query_t      *query,
+                               const adc_archive_ring_t *ring)
+{
+    uint32_t oldest = adc_archive_oldest(ring);
+    uint32_t lo     = oldest;
+    uint32_t hi     = ring->next;
+    uint8_t  head[ADC_ARCHIVE_PAGE_HEADER_SIZE + 4U];
+
+    while (lo != hi)
+    {
+        uint32_t mid = lo + ((hi - lo) / 2U);
+
+        if ((BSP_SPINOR_Read(adc_archive_address(ring, mid), head,
+                             sizeof(head)) == BSP_OK) &&
+            adc_archive_header_valid(head, query->archive, mid) &&
+            (get_u32(&head[ADC_ARCHIVE_PAGE_HEADER_SIZE]) > query->from_s))
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1U;
+        }
+    }
+
+    query->page    = (lo != oldest) ? (lo - 1U) : oldest;
+    query->located = true;
+}
+
+/**
+ * @brief Take the records of the range out of a page read into s_read
+ *
+ * Flash mutex held.
+ *
+ * @return Records taken
+ */
+static int32_t adc_archive_take(adc_archive_query_t  *query,
+                                adc_archive_record_t *records)
+{
+    int32_t count = 0;
+
+    for (uint32_t i = 0U; (i < s_read[7]) && !query->done; i++)
+    {
+        adc_archive_record_t *record = &records[count];
+
+        adc_archive_get_record(&s_read[ADC_ARCHIVE_PAGE_HEADER_SIZE +
+                                       (i * ADC_ARCHIVE_RECORD_SIZE)],
+                               record);
+        if (record->time_s > query->to_s)
+        {
+            query->done = true;
+        }
+        else if (record->time_s >= query->from_s)
+        {
+            count++;
+            query->done   = (record->time_s == query->to_s);
+            query->from_s = record->time_s + 1U;
+        }
+        else
+        {
+            /* Before the range, in the page it starts in */
+        }
+    }
+
+    return count;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void adc_archive_add_second(const adc_archive_record_t *record)
+{
+    uint32_t start_s = record->time_s - (record->time_s % ADC_ARCHIVE_MINUTE_S);
+
+    if (!atomic_load(&s_mounted))
+    {
+        return;
+    }
+
+    adc_archive_add(ADC_ARCHIVE_SECONDS, record);
+
+    if ((s_minute.seconds != 0U) && (start_s != s_minute.start_s))
+    {
+        adc_archive_close_minute();
+    }
+    if (s_minute.seconds == 0U)
+    {
+        s_minute.start_s = start_s;
+        (void)memcpy(s_minute.min, record->min, sizeof(s_minute.min));
+        (void)memcpy(s_minute.max, record->max, sizeof(s_minute.max));
+        (void)memset(s_minute.sum, 0, sizeof(s_minute.sum));
+    }
+
+    for (uint32_t ch = 0U; ch < ADC_ARCHIVE_CHANNELS; ch++)
+    {
+        if (record->min[ch] < s_minute.min[ch])
+        {
+            s_minute.min[ch] = record->min[ch];
+        }
+        if (record->max[ch] > s_minute.max[ch])
+        {
+            s_minute.max[ch] = record->max[ch];
+        }
+        s_minute.sum[ch] += record->mean[ch];
+    }
+    s_minute.seconds++;
+}
+
+void adc_archive_query_init(adc_archive_query_t *query,
+                            adc_archive_id_t archive, uint32_t from_s,
+                            uint32_t to_s)
+{
+    query->from_s  = from_s;
+    query->to_s    = to_s;
+    query->page    = 0U;
+    query->archive = (uint8_t)archive;
+    query->located = false;
+    query->done    = (to_s < from_s);
+}
+
+int32_t adc_archive_query_next(adc_archive_query_t  *query,
+                               adc_archive_record_t *records,
+                               TickType_t            wait)
+{
+    const adc_archive_ring_t *ring  = &s_rings[query->archive];
+    int32_t                   count = 0;
+
+    if (!atomic_load(&s_mounted))
+    {
+        query->done = true;
+    }
+
+    while (!query->done && (count == 0))
+    {
+        uint32_t oldest;
+
+        if (!nor_log_lock(wait))
+        {
+            return ADC_ARCHIVE_BUSY;
+        }
+
+        if (!query->located)
+        {
+            adc_archive_locate(query, ring);
+        }
+
+        /* Overwritten since: go on from what is left */
+        oldest = adc_archive_oldest(ring);
+        if ((int32_t)(query->page - oldest) < 0)
+        {
+            query->page = oldest;
+        }
+
+        if (query->page == ring->next)
+        {
+            query->done = true;
+        }
+        else
+        {
+            if ((BSP_SPINOR_Read(adc_archive_address(ring, query->page),
+                                 s_read, BSP_SPINOR_PAGE_SIZE) == BSP_OK) &&
+                adc_archive_page_valid(s_read, query->archive, query->page))
+            {
+                count = adc_archive_take(query, records);
+            }
+            query->page++;
+        }
+        nor_log_unlock();
+    }
+
+    return count;
+}
+
+modbus_exception_t adc_archive_read_file_record(uint16_t  file_number,
+                                                uint16_t  record_number,
+                                                uint16_t  record_length,
+                                                uint16_t *values)
+{
+    modbus_exception_t ex = MODBUS_EXCEPTION_NONE;
+
+    (void)xSemaphoreTake(s_file_lock, portMAX_DELAY);
+
+    if ((file_number != ADC_ARCHIVE_FILE_NUMBER) ||
+        (((uint32_t)record_number + record_length) >
+         (ADC_ARCHIVE_HEADER_RECORDS +
+          (s_file_count * ADC_ARCHIVE_FILE_RECORD_SIZE))))
+    {
+        ex = MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    for (uint32_t i = 0U; (ex == MODBUS_EXCEPTION_NONE) && (i < record_length);
+         i++)
+    {
+        static const uint16_t header[ADC_ARCHIVE_HEADER_RECORDS] = {
+            ADC_ARCHIVE_FILE_MAGIC, ADC_ARCHIVE_VERSION,
+            ADC_ARCHIVE_HEADER_RECORDS, ADC_ARCHIVE_FILE_RECORD_SIZE};
+        uint32_t                    record = (uint32_t)record_number + i;
+        const adc_archive_record_t *entry;
+        uint32_t                    field;
+
+        if (record < ADC_ARCHIVE_HEADER_RECORDS)
+        {
+            switch (record)
+            {
+                case 4U:
+                    values[i] = (uint16_t)s_file_count;
+                    break;
+                case 5U:
+                    values[i] = s_file_archive;
+                    break;
+                case 6U:
+                    values[i] = s_file_more ? 1U : 0U;
+                    break;
+                default:
+                    values[i] = header[record];
+                    break;
+            }
+            continue;
+        }
+
+        record -= ADC_ARCHIVE_HEADER_RECORDS;
+        entry = &s_file_records[record / ADC_ARCHIVE_FILE_RECORD_SIZE];
+        field = record % ADC_ARCHIVE_FILE_RECORD_SIZE;
+        if (field < 2U)
+        {
+            values[i] = (uint16_t)(entry->time_s >> (16U * (1U - field)));
+        }
+        else if (field < (2U + ADC_ARCHIVE_CHANNELS))
+        {
+            values[i] = entry->min[field - 2U];
+        }
+        else if (field < (2U + (2U * ADC_ARCHIVE_CHANNELS)))
+        {
+            values[i] = entry->max[field - (2U + ADC_ARCHIVE_CHANNELS)];
+        }
+        else
+        {
+            values[i] = entry->mean[field - (2U + (2U * ADC_ARCHIVE_CHANNELS))];
+        }
+    }
+
+    (void)xSemaphoreGive(s_file_lock);
+
+    return ex;
+}
+
+modbus_exception_t adc_archive_write_file_record(uint16_t        file_number,
+                                                 uint16_t        record_number,
+                                                 uint16_t        record_length,
+                                                 const uint16_t *values)
+{
+    adc_archive_query_t query;
+    uint32_t            from_s;
+    uint32_t            to_s;
+
+    if ((file_number != ADC_ARCHIVE_FILE_NUMBER) || (record_number != 0U) ||
+        (record_length != ADC_ARCHIVE_QUERY_RECORDS))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    from_s = ((uint32_t)values[1] << 16U) | values[2];
+    to_s   = ((uint32_t)values[3] << 16U) | values[4];
+    if ((values[0] >= (uint16_t)ADC_ARCHIVE_COUNT) || (to_s < from_s))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    if (!atomic_load(&s_mounted))
+    {
+        return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
+    }
+
+    adc_archive_query_init(&query, (adc_archive_id_t)values[0], from_s, to_s);
+
+    (void)xSemaphoreTake(s_file_lock, portMAX_DELAY);
+    s_file_count = 0U;
+    while ((s_file_count + ADC_ARCHIVE_PAGE_RECORDS) <=
+           ADC_ARCHIVE_FILE_MAX_RECORDS)
+    {
+        int32_t count = adc_archive_query_next(
+            &query, &s_file_records[s_file_count], portMAX_DELAY);
+
+        if (count <= 0)
+        {
+            break;
+        }
+        s_file_count += (uint32_t)count;
+    }
+    s_file_archive = (uint8_t)values[0];
+    s_file_more    = !query.done;
+    (void)xSemaphoreGive(s_file_lock);
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+void adc_archive_start(void)
+{
+    s_queue     = xQueueCreateStatic(ADC_ARCHIVE_QUEUE_PAGES,
+                                     BSP_SPINOR_PAGE_SIZE, s_queue_storage,
+                                     &s_queue_buffer);
+    s_file_lock = xSemaphoreCreateMutexStatic(&s_file_lock_buffer);
+
+    (void)xTaskCreateStatic(adc_archive_task, "ArchWrite",
+                            ADC_ARCHIVE_STACK_SIZE, NULL, TASK_PRIO_BACKGROUND,
+                            s_task_stack, &s_task_tcb);
+}
+
+#endif /* ADC_ARCHIVE */
@@ -0,0 +1,621 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Capture
+ *
+ * While armed, the capture job (cyclic_exec.h) drains the ADC1 sample
+ * ring through its own reader into a circular history of raw samples and
+ * evaluates the trigger once per read. The trigger is only looked for once the history holds the
+ * pre-trigger samples, and a level trigger only fires after the channel
+ * was seen on the other side of the level. When the post-trigger samples
+ * are in, the capture is copied out of the history into the snapshot and
+ * the job goes idle until the next command. The snapshot format is
+ * described in adc_capture.h.
+ */
+
+#include "adc_capture.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_coefficients.h"
+#include "app_tasks.h"
+#include "arm_math.h"
+#include "bsp.h"
+#include "metrics.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Samples copied out of the ring per read, one ADC block */
+#define ADC_CAPTURE_READ_CHUNK BSP_ADC1_BLOCK_SAMPLES
+
+/** History depth: a full capture plus the read that completes it */
+#define ADC_CAPTURE_HISTORY (ADC_CAPTURE_MAX_SAMPLES + ADC_CAPTURE_READ_CHUNK)
+
+/** No trigger in the samples of a read */
+#define ADC_CAPTURE_NO_TRIGGER UINT32_MAX
+
+/* Header record offsets (adc_capture.h) */
+#define HDR_MAGIC          0U
+#define HDR_VERSION        1U
+#define HDR_SIZE           2U
+#define HDR_CHANNELS       3U
+#define HDR_SNAPSHOT       4U
+#define HDR_FIRST_SEQUENCE 6U
+#define HDR_TRIGGER_SEQ    8U
+#define HDR_TRIGGER_TIME   10U
+#define HDR_SAMPLES        14U
+#define HDR_PRE_SAMPLES    15U
+#define HDR_TRIGGER        16U
+#define HDR_INPUT          17U
+#define HDR_LEVEL          18U
+#define HDR_SAMPLE_RATE    19U
+
+_Static_assert(ADC_CAPTURE_HEADER_RECORDS == (HDR_SAMPLE_RATE + 1U),
+               "header records out of step with the layout");
+_Static_assert(ADC_FILTER_MAX_SAMPLE_RATE <= 0xFFFFU,
+               "sample rate must fit one record");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Capture job state
+ *
+ * Owned by the capture job; only the pending configuration and command
+ * are shared.
+ */
+typedef struct
+{
+    adc_capture_config_t config;     /**< Active configuration */
+    bsp_adc1_reader_t    reader;     /**< Ring cursor */
+    uint32_t             generation; /**< Configuration generation applied */
+    uint32_t             commands;   /**< Command generation applied */
+    adc_capture_state_t  state;      /**< Capture state */
+    float32_t            level;      /**< Trigger level, filter output units */
+    uint16_t             post;       /**< Post-trigger samples, clamped */
+    bool                 primed;     /**< Trigger condition can fire */
+    bool                 force;      /**< Trigger at the next read */
+    uint8_t              di_level;   /**< DI levels after the last read */
+
+    /* History of contiguous samples */
+    uint32_t head;          /**< History index of the next sample */
+    uint32_t fill;          /**< Contiguous samples in the history */
+    uint32_t next_sequence; /**< Sequence that continues the history */
+
+    /* Capture after its trigger */
+    uint32_t trigger_sequence; /**< Sequence of the trigger sample */
+    uint64_t trigger_time;     /**< Capture time of the trigger sample */
+    uint32_t end_sequence;     /**< Sequence after the last sample */
+} adc_capture_engine_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+/** Configuration waiting to be applied by the capture job */
+static adc_capture_config_t s_pending_config = {
+    .trigger      = (uint16_t)ADC_CAPTURE_TRIGGER_RISING,
+    .input        = 0U,
+    .level_mv     = 1650U,
+    .pre_samples  = 1024U,
+    .post_samples = 1024U,
+};
+
+/**
+ * Incremented on every adc_capture_set_config() call; starts ahead of the
+ * job so that it applies the defaults
+ */
+static volatile uint32_t s_config_generation = 1U;
+
+/** Command waiting to be run by the capture job */
+static uint16_t s_pending_command = (uint16_t)ADC_CAPTURE_COMMAND_STOP;
+
+/** Incremented on every adc_capture_command() call */
+static volatile uint32_t s_command_generation = 0U;
+
+/** Capture state, published for the Modbus task */
+static volatile adc_capture_state_t s_state = ADC_CAPTURE_STATE_IDLE;
+
+/** Number of the frozen snapshot, 0 if none */
+static volatile uint32_t s_snapshot_number = 0U;
+
+/** Records of the frozen snapshot, 0 if none */
+static volatile uint32_t s_snapshot_records = 0U;
+
+/** Samples copied out of the ring, kept off the executive stack */
+static bsp_adc1_sample_t s_chunk[ADC_CAPTURE_READ_CHUNK];
+
+/** Trigger channel of the samples of a read */
+static float32_t s_level[ADC_CAPTURE_READ_CHUNK];
+
+/** Raw samples of the last ADC_CAPTURE_HISTORY sample periods */
+static uint16_t s_history[ADC_CAPTURE_HISTORY][BSP_ADC1_NUM_CHANNELS];
+
+/** Frozen snapshot, header and samples, in FC20 records */
+static uint16_t s_snapshot[ADC_CAPTURE_MAX_RECORDS];
+
+/** Capture job state */
+static adc_capture_engine_t s_engine;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Store a 32-bit value in two records, high word first
+ */
+static void put_records32(uint16_t *dst, uint32_t value)
+{
+    dst[0] = (uint16_t)(value >> 16U);
+    dst[1] = (uint16_t)(value & 0xFFFFU);
+}
+
+/**
+ * @brief Publish a new capture state
+ */
+static void adc_capture_set_state(adc_capture_engine_t *engine,
+                                  adc_capture_state_t   state)
+{
+    engine->state = state;
+    s_state       = state;
+}
+
+/**
+ * @brief Start waiting for the trigger with an empty history
+ */
+static void adc_capture_arm(adc_capture_engine_t *engine)
+{
+    engine->fill   = 0U;
+    engine->primed = false;
+    engine->force  = false;
+    engine->post   = engine->config.post_samples;
+    engine->level  = (float32_t)engine->config.level_mv / 1000.0f;
+    if (((uint32_t)engine->config.pre_samples + engine->post) >
+        ADC_CAPTURE_MAX_SAMPLES)
+    {
+        engine->post =
+            (uint16_t)(ADC_CAPTURE_MAX_SAMPLES - engine->config.pre_samples);
+    }
+    (void)BSP_ADC1_RingReaderInit(&engine->reader, BSP_ADC1_STREAM_FULL);
+    adc_capture_set_state(engine, ADC_CAPTURE_STATE_ARMED);
+}
+
+/**
+ * @brief Pick up a configuration and a command from the other tasks
+ */
+static void adc_capture_apply(adc_capture_engine_t *engine)
+{
+    uint32_t generation = s_config_generation;
+    uint32_t commands   = s_command_generation;
+    uint16_t command;
+
+    if (generation != engine->generation)
+    {
+        taskENTER_CRITICAL();
+        generation     = s_config_generation;
+        engine->config = s_pending_config;
+        taskEXIT_CRITICAL();
+
+        engine->generation = generation;
+        if (engine->config.pre_samples > ADC_CAPTURE_MAX_SAMPLES)
+        {
+            engine->config.pre_samples = (uint16_t)ADC_CAPTURE_MAX_SAMPLES;
+        }
+        if (((engine->config.trigger == (uint16_t)ADC_CAPTURE_TRIGGER_RISING) ||
+             (engine->config.trigger ==
+              (uint16_t)ADC_CAPTURE_TRIGGER_FALLING)) &&
+            (engine->config.input >= BSP_ADC1_NUM_CHANNELS))
+        {
+            engine->config.trigger = (uint16_t)ADC_CAPTURE_TRIGGER_MANUAL;
+        }
+        if ((engine->config.trigger ==
+             (uint16_t)ADC_CAPTURE_TRIGGER_DI_RISING) &&
+            (engine->config.input >= BSP_GPIODI_COUNT))
+        {
+            engine->config.trigger = (uint16_t)ADC_CAPTURE_TRIGGER_MANUAL;
+        }
+        if (engine->config.trigger >= (uint16_t)ADC_CAPTURE_TRIGGER_COUNT)
+        {
+            engine->config.trigger = (uint16_t)ADC_CAPTURE_TRIGGER_MANUAL;
+        }
+
+        if ((engine->state == ADC_CAPTURE_STATE_ARMED) ||
+            (engine->state == ADC_CAPTURE_STATE_TRIGGERED))
+        {
+            adc_capture_arm(engine);
+        }
+    }
+
+    if (commands == engine->commands)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    commands = s_command_generation;
+    command  = s_pending_command;
+    taskEXIT_CRITICAL();
+
+    engine->commands = commands;
+    switch (command)
+    {
+        case (uint16_t)ADC_CAPTURE_COMMAND_STOP:
+            adc_capture_set_state(engine, (s_snapshot_records != 0U)
+                                              ? ADC_CAPTURE_STATE_READY
+                                              : ADC_CAPTURE_STATE_IDLE);
+            break;
+        case (uint16_t)ADC_CAPTURE_COMMAND_ARM:
+            adc_capture_arm(engine);
+            break;
+        case (uint16_t)ADC_CAPTURE_COMMAND_FORCE:
+            if (engine->state != ADC_CAPTURE_STATE_ARMED)
+            {
+                adc_capture_arm(engine);
+            }
+            engine->force = true;
+            break;
+        default:
+            /* Unknown commands are ignored */
+            break;
+    }
+}
+
+/**
+ * @brief Find the trigger sample of a level trigger in one read
+ *
+ * The minimum and maximum of the read decide whether the channel stayed
+ * on one side of the level; only a read that crosses it is searched.
+ *
+ * @return Index of the trigger sample, ADC_CAPTURE_NO_TRIGGER if none
+ */
+static uint32_t adc_capture_find_level(adc_capture_engine_t *engine,
+                                       uint32_t              count)
+{
+    bool rising =
+        (engine->config.trigger == (uint16_t)ADC_CAPTURE_TRIGGER_RISING);
+    float32_t min;
+    float32_t max;
+    uint32_t  index;
+    bool      all_before;
+    bool      all_after;
+
+    arm_min_f32(s_level, count, &min, &index);
+    arm_max_f32(s_level, count, &max, &index);
+
+    /* "Before" is the side of the level the trigger starts from */
+    all_before = rising ? (max < engine->level) : (min >= engine->level);
+    all_after  = rising ? (min >= engine->level) : (max < engine->level);
+
+    if (all_before)
+    {
+        engine->primed = true;
+        return ADC_CAPTURE_NO_TRIGGER;
+    }
+    if (all_after)
+    {
+        return engine->primed ? 0U : ADC_CAPTURE_NO_TRIGGER;
+    }
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        bool before = rising ? (s_level[i] < engine->level)
+                             : (s_level[i] >= engine->level);
+
+        if (before)
+        {
+            engine->primed = true;
+        }
+        else if (engine->primed)
+        {
+            return i;
+        }
+        else
+        {
+            /* Still on the trigger side since arming */
+        }
+    }
+
+    return ADC_CAPTURE_NO_TRIGGER;
+}
+
+/**
+ * @brief Find the first rising edge of the trigger input in one read
+ *
+ * An edge lands in the first sample captured at or after it. A sample
+ * with an edge of the input has a rising one unless the input went from
+ * high to low over it.
+ *
+ * @return Index of the trigger sample, ADC_CAPTURE_NO_TRIGGER if none
+ */
+static uint32_t adc_capture_find_di(const adc_capture_engine_t *engine,
+                                    uint32_t                    count)
+{
+    const uint8_t bit    = (uint8_t)(1U << engine->config.input);
+    uint8_t       before = engine->di_level;
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const bsp_adc1_sample_t *sample = &s_chunk[i];
+
+        if (((sample->di_edges & bit) != 0U) &&
+            (((before & bit) == 0U) || ((sample->di & bit) != 0U)))
+        {
+            return i;
+        }
+        before = sample->di;
+    }
+
+    return ADC_CAPTURE_NO_TRIGGER;
+}
+
+/**
+ * @brief Find the trigger sample of the configured condition in one read
+ *
+ * @return Index of the trigger sample, ADC_CAPTURE_NO_TRIGGER if none
+ */
+static uint32_t adc_capture_find(adc_capture_engine_t *engine, uint32_t count)
+{
+    if (engine->force)
+    {
+        return 0U;
+    }
+
+    switch (engine->config.trigger)
+    {
+        case (uint16_t)ADC_CAPTURE_TRIGGER_RISING:
+        case (uint16_t)ADC_CAPTURE_TRIGGER_FALLING:
+            return adc_capture_find_level(engine, count);
+        case (uint16_t)ADC_CAPTURE_TRIGGER_DI_RISING:
+            if (!engine->primed)
+            {
+                /* Edges from before arming are not taken */
+                engine->primed = true;
+                return ADC_CAPTURE_NO_TRIGGER;
+            }
+            return adc_capture_find_di(engine, count);
+        default:
+            return ADC_CAPTURE_NO_TRIGGER;
+    }
+}
+
+/**
+ * @brief Copy the capture out of the history into the snapshot
+ */
+static void adc_capture_freeze(adc_capture_engine_t *engine)
+{
+    uint32_t  samples = (uint32_t)engine->config.pre_samples + engine->post;
+    uint32_t  first   = engine->trigger_sequence - engine->config.pre_samples;
+    uint32_t  back    = engine->next_sequence - first;
+    uint32_t  index   = (engine->head + ADC_CAPTURE_HISTORY - back) %
+                     ADC_CAPTURE_HISTORY;
+    uint16_t *dst     = &s_snapshot[ADC_CAPTURE_HEADER_RECORDS];
+    uint32_t  number  = s_snapshot_number + 1U;
+
+    s_snapshot_records = 0U;
+
+    for (uint32_t i = 0U; i < samples; i++)
+    {
+        (void)memcpy(dst, s_history[index], sizeof(s_history[index]));
+        dst   = &dst[ADC_CAPTURE_SAMPLE_RECORDS];
+        index = (index + 1U) % ADC_CAPTURE_HISTORY;
+    }
+
+    s_snapshot[HDR_MAGIC]    = (uint16_t)ADC_CAPTURE_MAGIC;
+    s_snapshot[HDR_VERSION]  = (uint16_t)ADC_CAPTURE_VERSION;
+    s_snapshot[HDR_SIZE]     = (uint16_t)ADC_CAPTURE_HEADER_RECORDS;
+    s_snapshot[HDR_CHANNELS] = (uint16_t)BSP_ADC1_NUM_CHANNELS;
+    put_records32(&s_snapshot[HDR_SNAPSHOT], number);
+    put_records32(&s_snapshot[HDR_FIRST_SEQUENCE], first);
+    put_records32(&s_snapshot[HDR_TRIGGER_SEQ], engine->trigger_sequence);
+    put_records32(&s_snapshot[HDR_TRIGGER_TIME],
+                  (uint32_t)(engine->trigger_time >> 32U));
+    put_records32(&s_snapshot[HDR_TRIGGER_TIME + 2U],
+                  (uint32_t)(engine->trigger_time & 0xFFFFFFFFU));
+    s_snapshot[HDR_SAMPLES]     = (uint16_t)samples;
+    s_snapshot[HDR_PRE_SAMPLES] = engine->config.pre_samples;
+    s_snapshot[HDR_TRIGGER]     = engine->config.trigger;
+    s_snapshot[HDR_INPUT]       = engine->config.input;
+    s_snapshot[HDR_LEVEL]       = engine->config.level_mv;
+    s_snapshot[HDR_SAMPLE_RATE] = (uint16_t)BSP_ADC1_GetSampleRate();
+
+    s_snapshot_number  = number;
+    s_snapshot_records = ADC_CAPTURE_HEADER_RECORDS +
+                         (samples * ADC_CAPTURE_SAMPLE_RECORDS);
+    adc_capture_set_state(engine, ADC_CAPTURE_STATE_READY);
+
+    printf("ADC capture: snapshot %lu, %lu samples, trigger at sample %lu\n",
+           (unsigned long)number, (unsigned long)samples,
+           (unsigned long)engine->trigger_sequence);
+}
+
+/**
+ * @brief Add one read to the history and run the trigger on it
+ */
+static void adc_capture_process(adc_capture_engine_t *engine, uint32_t count)
+{
+    uint8_t  input = (uint8_t)engine->config.input;
+    bool     gap   = false;
+    uint32_t trigger;
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const bsp_adc1_sample_t *sample = &s_chunk[i];
+
+        if (sample->sequence != engine->next_sequence)
+        {
+            engine->fill = 0U;
+            gap          = true;
+        }
+        (void)memcpy(s_history[engine->head], sample->raw,
+                     sizeof(s_history[engine->head]));
+        engine->head = (engine->head + 1U) % ADC_CAPTURE_HISTORY;
+        if (engine->fill < ADC_CAPTURE_HISTORY)
+        {
+            engine->fill++;
+        }
+        engine->next_sequence = sample->sequence + 1U;
+
+        if (input < BSP_ADC1_NUM_CHANNELS)
+        {
+            s_level[i] = sample->filtered[input];
+        }
+    }
+
+    if (gap && (engine->state == ADC_CAPTURE_STATE_TRIGGERED))
+    {
+        /* The capture lost samples; wait for the next trigger */
+        engine->primed = false;
+        adc_capture_set_state(engine, ADC_CAPTURE_STATE_ARMED);
+    }
+
+    if ((engine->state == ADC_CAPTURE_STATE_ARMED) &&
+        (engine->fill >= ((uint32_t)engine->config.pre_samples + count)))
+    {
+        trigger = adc_capture_find(engine, count);
+        if (trigger != ADC_CAPTURE_NO_TRIGGER)
+        {
+            engine->trigger_sequence = s_chunk[trigger].sequence;
+            engine->end_sequence     = engine->trigger_sequence + engine->post;
+            if (BSP_ADC1_GetSampleTime(engine->trigger_sequence,
+                                       &engine->trigger_time) != BSP_OK)
+            {
+                engine->trigger_time = 0U;
+            }
+            engine->force = false;
+            adc_capture_set_state(engine, ADC_CAPTURE_STATE_TRIGGERED);
+        }
+    }
+
+    if (count > 0U)
+    {
+        engine->di_level = s_chunk[count - 1U].di;
+    }
+
+    if ((engine->state == ADC_CAPTURE_STATE_TRIGGERED) &&
+        ((int32_t)(engine->next_sequence - engine->end_sequence) >= 0))
+    {
+        adc_capture_freeze(engine);
+    }
+}
+
+/**
+ * @brief Move all available ring samples through the capture
+ */
+static void adc_capture_drain(adc_capture_engine_t *engine)
+{
+    uint32_t count = 0U;
+
+    do
+    {
+        uint32_t overruns = engine->reader.overruns;
+
+        if (BSP_ADC1_RingRead(&engine->reader, s_chunk, ADC_CAPTURE_READ_CHUNK,
+                              &count) != BSP_OK)
+        {
+            return;
+        }
+        metrics_add(METRIC_ADC_OVERRUN, engine->reader.overruns - overruns);
+
+        if (count > 0U)
+        {
+            adc_capture_process(engine, count);
+        }
+    } while ((count == ADC_CAPTURE_READ_CHUNK) &&
+             (engine->state != ADC_CAPTURE_STATE_READY));
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void adc_capture_set_config(const adc_capture_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_pending_config = *config;
+    s_config_generation++;
+    taskEXIT_CRITICAL();
+}
+
+void adc_capture_command(uint16_t command)
+{
+    taskENTER_CRITICAL();
+    s_pending_command = command;
+    s_command_generation++;
+    taskEXIT_CRITICAL();
+}
+
+adc_capture_state_t adc_capture_get_state(void) { return s_state; }
+
+uint32_t adc_capture_get_snapshot(void) { return s_snapshot_number; }
+
+const uint16_t *adc_capture_map_file_record(uint16_t file_number,
+                                            uint16_t record_number,
+                                            uint16_t record_length)
+{
+    uint32_t records = s_snapshot_records;
+    uint32_t first;
+
+    if ((file_number < ADC_CAPTURE_FILE_NUMBER) ||
+        (file_number >= (ADC_CAPTURE_FILE_NUMBER + ADC_CAPTURE_FILE_COUNT)) ||
+        (((uint32_t)record_number + record_length) >
+         ADC_CAPTURE_FILE_RECORDS))
+    {
+        return NULL;
+    }
+
+    first = ((uint32_t)(file_number - ADC_CAPTURE_FILE_NUMBER) *
+             ADC_CAPTURE_FILE_RECORDS) +
+            record_number;
+    if ((first + record_length) > records)
+    {
+        return NULL;
+    }
+
+    return &s_snapshot[first];
+}
+
+modbus_exception_t adc_capture_read_file_record(uint16_t  file_number,
+                                                uint16_t  record_number,
+                                                uint16_t  record_length,
+                                                uint16_t *values)
+{
+    const uint16_t *records =
+        adc_capture_map_file_record(file_number, record_number, record_length);
+
+    if (records == NULL)
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    (void)memcpy(values, records, (size_t)record_length * sizeof(values[0]));
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief ADC capture job, run by the cyclic executive every frame
+ */
+void adc_capture_job(void)
+{
+    adc_capture_engine_t *engine = &s_engine;
+
+    adc_capture_apply(engine);
+
+    if ((engine->state == ADC_CAPTURE_STATE_ARMED) ||
+        (engine->state == ADC_CAPTURE_STATE_TRIGGERED))
+    {
+        adc_capture_drain(engine);
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Change Detection
+ *
+ * The published values and change counts are written by the filter task
+ * only, in one short critical section per block that changes anything, so
+ * a poll always copies a set published together. Deadbands are single
+ * words and are read without a lock.
+ */
+
+#include "adc_change.h"
+
+#include "FreeRTOS.h"
+#include "arm_math.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Deadband of each channel, V */
+static volatile float32_t s_deadband[ADC_CHANGE_CHANNELS];
+
+/** Value last published of each channel, V */
+static float32_t s_published[ADC_CHANGE_CHANNELS];
+
+/** Times each channel was published */
+static uint32_t s_changes[ADC_CHANGE_CHANNELS];
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void adc_change_set_deadband(uint8_t channel, float32_t deadband)
+{
+    if ((channel < ADC_CHANGE_CHANNELS) && (deadband >= 0.0f))
+    {
+        s_deadband[channel] = deadband;
+    }
+}
+
+void adc_change_process(const float32_t *values)
+{
+    float32_t diff[ADC_CHANGE_CHANNELS];
+    uint32_t  changed = 0U;
+
+    if (!BSP_ADC1_IsFilterSettled())
+    {
+        return;
+    }
+
+    /* s_published is only written below, by this task */
+    arm_sub_f32(values, s_published, diff, ADC_CHANGE_CHANNELS);
+    arm_abs_f32(diff, diff, ADC_CHANGE_CHANNELS);
+
+    for (uint32_t ch = 0U; ch < ADC_CHANGE_CHANNELS; ch++)
+    {
+        if (diff[ch] > s_deadband[ch])
+        {
+            changed |= (1UL << ch);
+        }
+    }
+
+    if (changed == 0U)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint32_t ch = 0U; ch < ADC_CHANGE_CHANNELS; ch++)
+    {
+        if ((changed & (1UL << ch)) != 0U)
+        {
+            s_published[ch] = values[ch];
+            s_changes[ch]++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+uint32_t adc_change_poll(adc_change_cursor_t *cursor, float32_t *values)
+{
+    uint32_t changed = 0U;
+
+    if (cursor == NULL)
+    {
+        return 0U;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint32_t ch = 0U; ch < ADC_CHANGE_CHANNELS; ch++)
+    {
+        if (cursor->changes[ch] != s_changes[ch])
+        {
+            cursor->changes[ch] = s_changes[ch];
+            changed |= (1UL << ch);
+        }
+        if (values != NULL)
+        {
+            values[ch] = s_published[ch];
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return changed;
+}
+
+uint32_t adc_change_count(uint32_t mask)
+{
+    uint32_t total = 0U;
+
+    for (uint32_t ch = 0U; ch < ADC_CHANGE_CHANNELS; ch++)
+    {
+        if ((mask & (1UL << ch)) != 0U)
+        {
+            total += s_changes[ch];
+        }
+    }
+
+    return total;
+}
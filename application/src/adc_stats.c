@@ -0,0 +1,545 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Window Statistics
+ *
+ * The buckets, windows and the stream reader belong to the filter task.
+ * Only the published figures are shared, copied in one short critical
+ * section per update. A deque holds bucket slots in the order the buckets
+ * were closed; a window's buckets are its last slots of the ring, so a
+ * slot also tells the bucket's age. Window sums are kept in double
+ * precision, updated only ten times a second, so adding and subtracting
+ * buckets for hours leaves no drift worth a register unit. See
+ * adc_stats.h.
+ */
+
+#include "adc_stats.h"
+
+#include <float.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_archive.h"
+#include "arm_math.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Missed buckets after which every window would be empty */
+#define ADC_STATS_MAX_GAP_TICKS \
+    (ADC_STATS_SECONDS * ADC_STATS_TICKS_PER_SECOND)
+
+/** Samples read from the stream at a time, one ADC block's worth */
+#define ADC_STATS_READ_BATCH \
+    (BSP_ADC1_BLOCK_SAMPLES / ADC_FILTER_DECIMATION_FACTOR)
+
+/** Register units per V */
+#define ADC_STATS_UNITS_PER_V 10000.0f
+
+/** Largest register value */
+#define ADC_STATS_REGISTER_MAX 65535.0f
+
+/** Remainder of a sample rate over the bucket rate, for the check below */
+#define ADC_STATS_RATE_REMAINDER(index, hz) \
+    (((hz) % ADC_STATS_TICKS_PER_SECOND) != 0U) +
+
+_Static_assert((ADC_FILTER_FOR_EACH_RATE(ADC_STATS_RATE_REMAINDER) 0U) == 0U,
+               "a bucket must be a whole number of samples at every rate");
+_Static_assert(ADC_STATS_SECONDS <= 255U, "deque slots are one byte");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/** Samples of one channel over one bucket period */
+typedef struct
+{
+    float32_t min;    /**< Lowest sample, FLT_MAX if none */
+    float32_t max;    /**< Highest sample, -FLT_MAX if none */
+    float32_t sum;    /**< Sum of the samples */
+    float32_t sum_sq; /**< Sum of their squares */
+    uint32_t  count;  /**< Number of samples */
+} adc_stats_bucket_t;
+
+/** Bucket slots of rising minimums or falling maximums, oldest first */
+typedef struct
+{
+    uint8_t slot[ADC_STATS_SECONDS]; /**< Circular, from head */
+    uint8_t head;                    /**< Index of the oldest entry */
+    uint8_t size;                    /**< Number of entries */
+} adc_stats_deque_t;
+
+/** Running state of one window */
+typedef struct
+{
+    float64_t         sum;     /**< Sum of the samples in the window */
+    float64_t         sum_sq;  /**< Sum of their squares */
+    uint32_t          count;   /**< Samples in the window */
+    uint32_t          buckets; /**< Buckets in the window, up to its length */
+    adc_stats_deque_t min;     /**< Front: slot of the window minimum */
+    adc_stats_deque_t max;     /**< Front: slot of the window maximum */
+} adc_stats_window_state_t;
+
+/** Buckets and windows of one channel */
+typedef struct
+{
+    adc_stats_bucket_t tick;   /**< 100 ms bucket being filled */
+    adc_stats_bucket_t second; /**< 1 s bucket being filled */
+    adc_stats_bucket_t ticks[ADC_STATS_TICKS_PER_SECOND]; /**< Last 100 ms */
+    adc_stats_bucket_t seconds[ADC_STATS_SECONDS];        /**< Last 1 s */
+    adc_stats_window_state_t windows[ADC_STATS_WINDOW_COUNT];
+} adc_stats_channel_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Buckets per window, in adc_stats_window_t order */
+static const uint32_t s_window_buckets[ADC_STATS_WINDOW_COUNT] = {
+    ADC_STATS_TICKS_PER_SECOND, 10U, ADC_STATS_SECONDS};
+
+/* Filter task only */
+static adc_stats_channel_t s_channels[ADC_STATS_CHANNELS];
+static bsp_adc1_reader_t   s_reader;      /**< Decimated stream reader */
+static bool                s_attached;    /**< s_reader initialized */
+static bool                s_started;     /**< s_tick_end is set */
+static uint32_t            s_tick_end;    /**< Sequence ending the bucket */
+static uint32_t            s_tick_slot;   /**< Slot of the 100 ms bucket */
+static uint32_t            s_second_slot; /**< Slot of the 1 s bucket */
+static uint32_t            s_ticks;       /**< 100 ms buckets closed */
+static uint32_t            s_rate;        /**< Sample rate of the buckets */
+static uint32_t            s_tick_samples; /**< Full-rate samples per 100 ms
+                                                bucket at s_rate; sequence
+                                                numbers count full rate */
+
+/** Samples being taken in */
+static bsp_adc1_sample_t s_samples[ADC_STATS_READ_BATCH];
+
+/** Figures being computed (filter task only) and last published */
+static adc_stats_result_t s_next[ADC_STATS_CHANNELS][ADC_STATS_WINDOW_COUNT];
+static adc_stats_result_t s_results[ADC_STATS_CHANNELS][ADC_STATS_WINDOW_COUNT];
+
+/** Updates published, 0 until the first */
+static uint32_t s_updates;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Empty a bucket
+ */
+static void bucket_clear(adc_stats_bucket_t *bucket)
+{
+    bucket->min    = FLT_MAX;
+    bucket->max    = -FLT_MAX;
+    bucket->sum    = 0.0f;
+    bucket->sum_sq = 0.0f;
+    bucket->count  = 0U;
+}
+
+/**
+ * @brief Add the samples of one bucket to another
+ */
+static void bucket_merge(adc_stats_bucket_t       *dst,
+                         const adc_stats_bucket_t *src)
+{
+    if (src->min < dst->min)
+    {
+        dst->min = src->min;
+    }
+    if (src->max > dst->max)
+    {
+        dst->max = src->max;
+    }
+    dst->sum += src->sum;
+    dst->sum_sq += src->sum_sq;
+    dst->count += src->count;
+}
+
+/** @brief Oldest entry of a deque, which must not be empty */
+static uint8_t deque_front(const adc_stats_deque_t *dq)
+{
+    return dq->slot[dq->head];
+}
+
+/** @brief Newest entry of a deque, which must not be empty */
+static uint8_t deque_back(const adc_stats_deque_t *dq)
+{
+    return dq->slot[(dq->head + dq->size - 1U) % ADC_STATS_SECONDS];
+}
+
+/** @brief Drop the oldest entry of a deque */
+static void deque_pop_front(adc_stats_deque_t *dq)
+{
+    dq->head = (uint8_t)((dq->head + 1U) % ADC_STATS_SECONDS);
+    dq->size--;
+}
+
+/** @brief Append an entry to a deque */
+static void deque_push_back(adc_stats_deque_t *dq, uint8_t slot)
+{
+    dq->slot[(dq->head + dq->size) % ADC_STATS_SECONDS] = slot;
+    dq->size++;
+}
+
+/**
+ * @brief Slide a window by one bucket
+ *
+ * Called before the bucket is stored in its slot, so that the slot of the
+ * bucket dropping out still holds it when the window is as long as the
+ * ring. Deque entries are only popped from the back while their bucket is
+ * no lower (minimum) or no higher (maximum) than the new one, so each
+ * bucket enters and leaves a deque once.
+ *
+ * @param[in,out] win    Window state
+ * @param[in]     ring   Bucket ring the window runs over
+ * @param[in]     size   Slots of the ring
+ * @param[in]     length Buckets of the window, at most @p size
+ * @param[in]     slot   Slot the new bucket goes to
+ * @param[in]     bucket New bucket
+ */
+static void window_push(adc_stats_window_state_t *win,
+                        const adc_stats_bucket_t *ring, uint32_t size,
+                        uint32_t length, uint32_t slot,
+                        const adc_stats_bucket_t *bucket)
+{
+    if (win->buckets == length)
+    {
+        uint8_t old = (uint8_t)((slot + size - length) % size);
+        const adc_stats_bucket_t *out = &ring[old];
+
+        win->sum -= (float64_t)out->sum;
+        win->sum_sq -= (float64_t)out->sum_sq;
+        win->count -= out->count;
+        if ((win->min.size != 0U) && (deque_front(&win->min) == old))
+        {
+            deque_pop_front(&win->min);
+        }
+        if ((win->max.size != 0U) && (deque_front(&win->max) == old))
+        {
+            deque_pop_front(&win->max);
+        }
+    }
+    else
+    {
+        win->buckets++;
+    }
+
+    win->sum += (float64_t)bucket->sum;
+    win->sum_sq += (float64_t)bucket->sum_sq;
+    win->count += bucket->count;
+    if (win->count == 0U)
+    {
+        /* Nothing left to carry rounding errors along */
+        win->sum    = 0.0;
+        win->sum_sq = 0.0;
+    }
+
+    if (bucket->count == 0U)
+    {
+        return;
+    }
+
+    while ((win->min.size != 0U) &&
+           (ring[deque_back(&win->min)].min >= bucket->min))
+    {
+        win->min.size--;
+    }
+    deque_push_back(&win->min, (uint8_t)slot);
+
+    while ((win->max.size != 0U) &&
+           (ring[deque_back(&win->max)].max <= bucket->max))
+    {
+        win->max.size--;
+    }
+    deque_push_back(&win->max, (uint8_t)slot);
+}
+
+/**
+ * @brief Scale a value in V to a register value, rounded and saturated
+ */
+static uint16_t adc_stats_register(float32_t volts)
+{
+    float32_t value = volts * ADC_STATS_UNITS_PER_V;
+
+    if (!(value > 0.0f))
+    {
+        return 0U;
+    }
+    if (value >= ADC_STATS_REGISTER_MAX)
+    {
+        return (uint16_t)ADC_STATS_REGISTER_MAX;
+    }
+    return (uint16_t)(value + 0.5f);
+}
+
+/**
+ * @brief Compute the figures of one window
+ */
+static adc_stats_result_t window_result(const adc_stats_window_state_t *win,
+                                        const adc_stats_bucket_t       *ring)
+{
+    adc_stats_result_t result = {0U, 0U, 0U, 0U};
+    float32_t          mean_sq;
+    float32_t          rms;
+
+    if ((win->count == 0U) || (win->min.size == 0U) || (win->max.size == 0U))
+    {
+        return result;
+    }
+
+    mean_sq = (float32_t)(win->sum_sq / (float64_t)win->count);
+    (void)arm_sqrt_f32((mean_sq > 0.0f) ? mean_sq : 0.0f, &rms);
+
+    result.min  = adc_stats_register(ring[deque_front(&win->min)].min);
+    result.max  = adc_stats_register(ring[deque_front(&win->max)].max);
+    result.mean = adc_stats_register(
+        (float32_t)(win->sum / (float64_t)win->count));
+    result.rms = adc_stats_register(rms);
+
+    return result;
+}
+
+/**
+ * @brief Start all windows empty
+ */
+static void adc_stats_reset(void)
+{
+    (void)memset(s_channels, 0, sizeof(s_channels));
+    for (uint32_t ch = 0U; ch < ADC_STATS_CHANNELS; ch++)
+    {
+        adc_stats_channel_t *c = &s_channels[ch];
+
+        bucket_clear(&c->tick);
+        bucket_clear(&c->second);
+    }
+
+    s_started     = false;
+    s_tick_slot   = 0U;
+    s_second_slot = 0U;
+}
+
+#if ADC_ARCHIVE
+/**
+ * @brief Hand the 1 s bucket just closed to the archives
+ *
+ * Stamped with the PTP second nearest the capture time of its first
+ * sample, or one second before now once that left the timestamp history.
+ * A second without samples is left out.
+ */
+static void adc_stats_archive(void)
+{
+    adc_archive_record_t record;
+    uint64_t             time_ns;
+
+    if (s_channels[0].seconds[s_second_slot].count == 0U)
+    {
+        return;
+    }
+
+    if (BSP_ADC1_GetSampleTimeNs(
+            s_tick_end - (s_tick_samples * ADC_STATS_TICKS_PER_SECOND),
+            &time_ns) == BSP_OK)
+    {
+        record.time_s = (uint32_t)((time_ns + 500000000ULL) / 1000000000ULL);
+    }
+    else
+    {
+        record.time_s = (uint32_t)(BSP_Time_NowNs() / 1000000000ULL) - 1U;
+    }
+
+    for (uint32_t ch = 0U; ch < ADC_STATS_CHANNELS; ch++)
+    {
+        const adc_stats_bucket_t *second =
+            &s_channels[ch].seconds[s_second_slot];
+
+        record.min[ch]  = adc_stats_register(second->min);
+        record.max[ch]  = adc_stats_register(second->max);
+        record.mean[ch] =
+            adc_stats_register(second->sum / (float32_t)second->count);
+    }
+
+    adc_archive_add_second(&record);
+}
+#endif
+
+/**
+ * @brief Close the 100 ms bucket, and the 1 s bucket with its tenth
+ */
+static void adc_stats_close_tick(void)
+{
+    bool second_done = (s_tick_slot == (ADC_STATS_TICKS_PER_SECOND - 1U));
+
+    for (uint32_t ch = 0U; ch < ADC_STATS_CHANNELS; ch++)
+    {
+        adc_stats_channel_t *c = &s_channels[ch];
+
+        window_push(&c->windows[ADC_STATS_WINDOW_1S], c->ticks,
+                    ADC_STATS_TICKS_PER_SECOND,
+                    s_window_buckets[ADC_STATS_WINDOW_1S], s_tick_slot,
+                    &c->tick);
+        c->ticks[s_tick_slot] = c->tick;
+        bucket_merge(&c->second, &c->tick);
+        bucket_clear(&c->tick);
+
+        if (second_done)
+        {
+            for (uint32_t w = ADC_STATS_WINDOW_10S; w < ADC_STATS_WINDOW_COUNT;
+                 w++)
+            {
+                window_push(&c->windows[w], c->seconds, ADC_STATS_SECONDS,
+                            s_window_buckets[w], s_second_slot, &c->second);
+            }
+            c->seconds[s_second_slot] = c->second;
+            bucket_clear(&c->second);
+        }
+    }
+
+    s_tick_slot = (s_tick_slot + 1U) % ADC_STATS_TICKS_PER_SECOND;
+    if (second_done)
+    {
+#if ADC_ARCHIVE
+        adc_stats_archive();
+#endif
+        s_second_slot = (s_second_slot + 1U) % ADC_STATS_SECONDS;
+    }
+    s_ticks++;
+}
+
+/**
+ * @brief Take one decimated sample in
+ *
+ * Closes every bucket whose period ended before the sample, empty ones
+ * included.
+ */
+static void adc_stats_add(const bsp_adc1_sample_t *sample)
+{
+    if (s_started && ((int32_t)(sample->sequence - s_tick_end) >= 0))
+    {
+        if (((sample->sequence - s_tick_end) / s_tick_samples) >=
+            ADC_STATS_MAX_GAP_TICKS)
+        {
+            adc_stats_reset();
+        }
+        else
+        {
+            do
+            {
+                adc_stats_close_tick();
+                s_tick_end += s_tick_samples;
+            } while ((int32_t)(sample->sequence - s_tick_end) >= 0);
+        }
+    }
+
+    if (!s_started)
+    {
+        s_tick_end = sample->sequence + s_tick_samples;
+        s_started  = true;
+    }
+
+    for (uint32_t ch = 0U; ch < ADC_STATS_CHANNELS; ch++)
+    {
+        adc_stats_bucket_t *bucket = &s_channels[ch].tick;
+        float32_t           value  = sample->filtered[ch];
+
+        if (value < bucket->min)
+        {
+            bucket->min = value;
+        }
+        if (value > bucket->max)
+        {
+            bucket->max = value;
+        }
+        bucket->sum += value;
+        bucket->sum_sq += value * value;
+        bucket->count++;
+    }
+}
+
+/**
+ * @brief Publish the figures of all windows
+ */
+static void adc_stats_publish(void)
+{
+    for (uint32_t ch = 0U; ch < ADC_STATS_CHANNELS; ch++)
+    {
+        const adc_stats_channel_t *c = &s_channels[ch];
+
+        s_next[ch][ADC_STATS_WINDOW_1S] =
+            window_result(&c->windows[ADC_STATS_WINDOW_1S], c->ticks);
+        for (uint32_t w = ADC_STATS_WINDOW_10S; w < ADC_STATS_WINDOW_COUNT;
+             w++)
+        {
+            s_next[ch][w] = window_result(&c->windows[w], c->seconds);
+        }
+    }
+
+    taskENTER_CRITICAL();
+    (void)memcpy(s_results, s_next, sizeof(s_results));
+    s_updates = s_ticks;
+    taskEXIT_CRITICAL();
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void adc_stats_process(void)
+{
+    uint32_t ticks = s_ticks;
+    uint32_t rate  = BSP_ADC1_GetSampleRate();
+    uint32_t count;
+
+    if (!s_attached)
+    {
+        (void)BSP_ADC1_RingReaderInit(&s_reader, BSP_ADC1_STREAM_DECIMATED);
+        s_attached = true;
+        s_rate     = 0U;
+    }
+
+    /* The buckets keep their length in time: a new rate starts every
+     * window anew with buckets of as many samples as it takes */
+    if (rate != s_rate)
+    {
+        adc_stats_reset();
+        s_rate         = rate;
+        s_tick_samples = rate / ADC_STATS_TICKS_PER_SECOND;
+    }
+
+    do
+    {
+        if (BSP_ADC1_RingRead(&s_reader, s_samples, ADC_STATS_READ_BATCH,
+                              &count) != BSP_OK)
+        {
+            break;
+        }
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            adc_stats_add(&s_samples[i]);
+        }
+    } while (count == ADC_STATS_READ_BATCH);
+
+    /* Once per block at most, however many buckets closed */
+    if (s_ticks != ticks)
+    {
+        adc_stats_publish();
+    }
+}
+
+uint32_t adc_stats_get_results(
+    adc_stats_result_t results[ADC_STATS_CHANNELS][ADC_STATS_WINDOW_COUNT])
+{
+    uint32_t updates;
+
+    taskENTER_CRITICAL();
+    (void)memcpy(results, s_results, sizeof(s_results));
+    updates = s_updates;
+    taskEXIT_CRITICAL();
+
+    return updates;
+}
@@ -0,0 +1,885 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Waveform Streaming Task
+ *
+ * This task drains the ADC1 sample ring through its own reader and packs
+ * the samples straight into PBUF_POOL pbufs allocated at the transport
+ * layer, so lwIP prepends the UDP, IP and Ethernet headers in place and the
+ * Ethernet driver transmits the payload without another copy. A datagram is
+ * sent once it is full, once the sample sequence has a gap, or once it has
+ * been open for ADC_STREAM_FLUSH_MS. The wire format is described in
+ * adc_stream_task.h.
+ *
+ * The pool is shared with Ethernet reception, so the task holds at most one
+ * pbuf while filling it; sent pbufs return to the pool on TX completion.
+ *
+ * A compressed stream stages ADC_STREAM_CODEC_BLOCK frames at a time and
+ * codes the block into the datagram before the next sample goes in. A
+ * block whose worst case does not fit is coded aside and copied if it
+ * fits after all; otherwise the datagram is sent and the block starts the
+ * next one with a fresh codec state, so every datagram decodes on its own.
+ *
+ * With ADC_STREAM_FAST_PATH, datagrams skip lwIP's UDP, IP and ARP layers:
+ * the task keeps the Ethernet, IPv4 and UDP headers for the destination
+ * ready-made, copies them into the headroom of the pbuf, patches the
+ * lengths and the IPv4 identification and hands the frame to the driver's
+ * linkoutput under the core lock, which serializes it with lwIP's own
+ * frames on the TX descriptor ring. The checksums are left to the MAC
+ * (ETHIF_CHECKSUM_OFFLOAD); without it only the IPv4 header is summed and
+ * the UDP checksum is sent as zero, none. Every ADC_STREAM_RESOLVE_MS one
+ * datagram goes through lwIP instead, which keeps the ARP entry of the
+ * next hop alive, and the headers are rebuilt after it; while the next
+ * hop is not resolved every datagram goes through lwIP.
+ */
+
+#include "adc_stream_task.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_coefficients.h"
+#include "app_tasks.h"
+#include "boot.h"
+#include "bsp.h"
+#include "ethernetif.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "lwip/etharp.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/ip4.h"
+#include "lwip/netbuf.h"
+#include "lwip/netif.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/prot/ethernet.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/udp.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include "metrics.h"
+#include "ptp.h"
+#include "sample_codec.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Largest datagram payload: Ethernet MTU less the IPv4 and UDP headers */
+#define ADC_STREAM_MAX_PAYLOAD 1472U
+
+/** Ring poll period while streaming, well below the ring's 25.6 ms depth */
+#define ADC_STREAM_POLL_MS 2U
+
+/** Configuration poll period while not streaming */
+#define ADC_STREAM_IDLE_MS 100U
+
+/** Longest time a partly filled datagram is held back */
+#define ADC_STREAM_FLUSH_MS 20U
+
+/** Samples copied out of the ring per read */
+#define ADC_STREAM_READ_CHUNK 32U
+
+/** Bytes per channel in a frame: raw result plus filter output */
+#define ADC_STREAM_RAW_SIZE      2U
+#define ADC_STREAM_FILTERED_SIZE 4U
+
+/** Bytes per frame of the digital input word */
+#define ADC_STREAM_DI_SIZE 2U
+
+/** Channels that exist on ADC1 */
+#define ADC_STREAM_CHANNEL_MASK ((1U << BSP_ADC1_NUM_CHANNELS) - 1U)
+
+/** Send datagrams to the Ethernet driver with ready-made headers */
+#ifndef ADC_STREAM_FAST_PATH
+#define ADC_STREAM_FAST_PATH 1
+#endif
+
+/** Period of the fast path datagrams sent through lwIP */
+#define ADC_STREAM_RESOLVE_MS 1000U
+
+/** Ethernet, IPv4 and UDP headers in front of a fast path datagram */
+#define ADC_STREAM_LINK_HLEN (SIZEOF_ETH_HDR + IP_HLEN + UDP_HLEN)
+
+/* One datagram must fit a single pool pbuf to be filled in place */
+_Static_assert((PBUF_POOL_BUFSIZE - PBUF_LINK_ENCAPSULATION_HLEN -
+                PBUF_LINK_HLEN - PBUF_IP_HLEN - PBUF_TRANSPORT_HLEN) >=
+                   ADC_STREAM_MAX_PAYLOAD,
+               "PBUF_POOL_BUFSIZE too small for one stream datagram");
+_Static_assert(BSP_ADC1_NUM_CHANNELS <= 8U,
+               "channel mask field is 8 bits wide");
+_Static_assert(BSP_ADC1_NUM_CHANNELS <= SAMPLE_CODEC_MAX_CHANNELS,
+               "sample codec cannot hold every channel");
+_Static_assert(SAMPLE_CODEC_MAX_SIZE(BSP_ADC1_NUM_CHANNELS,
+                                     ADC_STREAM_CODEC_BLOCK) <=
+                   (ADC_STREAM_MAX_PAYLOAD - ADC_STREAM_HEADER_SIZE),
+               "a coded block must fit an empty datagram");
+#if ADC_STREAM_FAST_PATH
+_Static_assert((ETH_PAD_SIZE == 0) && (PBUF_LINK_ENCAPSULATION_HLEN == 0),
+               "fast path headers must start a PBUF_TRANSPORT pbuf");
+#endif
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Stream task state
+ *
+ * Owned by the stream task; only the pending configuration is shared.
+ */
+typedef struct
+{
+    struct netconn     *conn;       /**< UDP connection */
+    struct netbuf      *buf;        /**< Carrier for the datagram pbuf */
+    adc_stream_config_t config;     /**< Active configuration */
+    bsp_adc1_reader_t   reader;     /**< Ring cursor */
+    ip_addr_t           dest;       /**< Destination address */
+    uint32_t            generation; /**< Configuration generation applied */
+    uint32_t            datagram_sequence; /**< Sequence of next datagram */
+    uint32_t            dropped;           /**< Samples dropped on pbuf OOM */
+    uint16_t            frame_size;        /**< Bytes per frame */
+    uint16_t            max_frames;        /**< Frames per full datagram */
+    uint16_t            sequence_step;     /**< Sequence step between frames */
+    uint8_t             flags;             /**< ADC_STREAM_FLAG_* for header */
+    uint8_t             channel_count;     /**< Channels in the mask */
+    bool                compress;          /**< Frames are coded */
+
+    /* Datagram being filled, pbuf is NULL if none */
+    struct pbuf *pbuf;           /**< Pool pbuf holding the datagram */
+    uint8_t     *write;          /**< Next frame position in the payload */
+    uint16_t     frame_count;    /**< Frames stored so far */
+    uint32_t     first_sequence; /**< Sample sequence of the first frame */
+    uint32_t     next_sequence;  /**< Sequence expected for the next frame */
+    uint32_t     lost;           /**< Samples lost before the first frame */
+    TickType_t   opened;         /**< Tick count when the first frame went in */
+    sample_codec_t codec;        /**< Codec state of a compressed datagram */
+
+    /* Frames of a compressed stream waiting to be coded */
+    uint16_t   staged;          /**< Frames in s_staged */
+    uint32_t   staged_sequence; /**< Sample sequence of the first one */
+    uint32_t   staged_lost;     /**< Samples lost before the first one */
+    TickType_t staged_opened;   /**< Tick count when the first one went in */
+
+#if ADC_STREAM_FAST_PATH
+    /* Fast path, link_hdr is valid while fast is set */
+    bool          fast;     /**< Datagrams skip lwIP */
+    struct netif *netif;    /**< Interface of the headers */
+    TickType_t    resolved; /**< Tick count when the headers were built */
+    uint16_t      ip_id;    /**< IPv4 identification of the next one */
+    uint8_t       link_hdr[ADC_STREAM_LINK_HLEN]; /**< Ready-made headers */
+#endif
+} adc_stream_state_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+/** Configuration waiting to be applied by the stream task */
+static adc_stream_config_t s_pending_config = {
+    .enable       = false,
+    .content      = ADC_STREAM_FLAG_RAW | ADC_STREAM_FLAG_FILTERED,
+    .channel_mask = (uint8_t)ADC_STREAM_CHANNEL_MASK,
+    .decimated    = false,
+    .compress     = false,
+    .dest_addr    = 0U,
+    .dest_port    = ADC_STREAM_DEFAULT_PORT,
+};
+
+/** Incremented on every adc_stream_set_config() call */
+static volatile uint32_t s_config_generation = 0U;
+
+/** Samples copied out of the ring, kept off the task stack */
+static bsp_adc1_sample_t s_chunk[ADC_STREAM_READ_CHUNK];
+
+/** Raw results of the staged frames of a compressed stream */
+static uint16_t s_staged[ADC_STREAM_CODEC_BLOCK * BSP_ADC1_NUM_CHANNELS];
+
+/** A coded block that may not fit the datagram */
+static uint8_t s_coded[SAMPLE_CODEC_MAX_SIZE(BSP_ADC1_NUM_CHANNELS,
+                                             ADC_STREAM_CODEC_BLOCK)];
+
+/** Stream task state */
+static adc_stream_state_t s_stream;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Store a 16-bit value little-endian
+ */
+static uint8_t *put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFU);
+    dst[1] = (uint8_t)((value >> 8U) & 0xFFU);
+    return &dst[2];
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static uint8_t *put_u32(uint8_t *dst, uint32_t value)
+{
+    dst = put_u16(dst, (uint16_t)(value & 0xFFFFU));
+    return put_u16(dst, (uint16_t)(value >> 16U));
+}
+
+/**
+ * @brief Store a 64-bit value little-endian
+ */
+static uint8_t *put_u64(uint8_t *dst, uint64_t value)
+{
+    dst = put_u32(dst, (uint32_t)(value & 0xFFFFFFFFU));
+    return put_u32(dst, (uint32_t)(value >> 32U));
+}
+
+/**
+ * @brief Check whether a configuration produces any datagrams
+ */
+static bool adc_stream_is_active(const adc_stream_config_t *config)
+{
+    return config->enable && (config->dest_addr != 0U) &&
+           (config->content != 0U) && (config->channel_mask != 0U);
+}
+
+/**
+ * @brief Free the datagram being filled, if any
+ */
+static void adc_stream_discard(adc_stream_state_t *state)
+{
+    if (state->pbuf != NULL)
+    {
+        (void)pbuf_free(state->pbuf);
+        state->pbuf = NULL;
+    }
+    state->frame_count = 0U;
+    state->staged      = 0U;
+}
+
+/**
+ * @brief Pick up a configuration published by adc_stream_set_config()
+ *
+ * Derives the frame layout and restarts the ring reader, so streaming
+ * starts at the newest sample.
+ */
+static void adc_stream_apply_config(adc_stream_state_t *state)
+{
+    uint32_t generation = s_config_generation;
+    uint8_t  mask;
+    uint16_t channel_size = 0U;
+
+    if (generation == state->generation)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    generation    = s_config_generation;
+    state->config = s_pending_config;
+    taskEXIT_CRITICAL();
+
+    state->generation = generation;
+    adc_stream_discard(state);
+#if ADC_STREAM_FAST_PATH
+    state->fast = false;
+#endif
+
+    mask = state->config.channel_mask & (uint8_t)ADC_STREAM_CHANNEL_MASK;
+    state->config.channel_mask = mask;
+    state->config.content &= (uint8_t)(ADC_STREAM_FLAG_RAW |
+                                       ADC_STREAM_FLAG_FILTERED |
+                                       ADC_STREAM_FLAG_DI);
+
+    state->channel_count = 0U;
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if ((mask & (1U << ch)) != 0U)
+        {
+            state->channel_count++;
+        }
+    }
+
+    if ((state->config.content & ADC_STREAM_FLAG_RAW) != 0U)
+    {
+        channel_size += ADC_STREAM_RAW_SIZE;
+    }
+    if ((state->config.content & ADC_STREAM_FLAG_FILTERED) != 0U)
+    {
+        channel_size += ADC_STREAM_FILTERED_SIZE;
+    }
+
+    state->frame_size = (uint16_t)(state->channel_count * channel_size);
+    if ((state->config.content & ADC_STREAM_FLAG_DI) != 0U)
+    {
+        state->frame_size += ADC_STREAM_DI_SIZE;
+    }
+    state->max_frames =
+        (state->frame_size == 0U)
+            ? 0U
+            : (uint16_t)((ADC_STREAM_MAX_PAYLOAD - ADC_STREAM_HEADER_SIZE) /
+                         state->frame_size);
+    state->flags = state->config.content;
+
+    /* Only raw results are coded */
+    state->compress = state->config.compress &&
+                      (state->config.content == ADC_STREAM_FLAG_RAW);
+    if (state->compress)
+    {
+        state->flags |= ADC_STREAM_FLAG_COMPRESSED;
+    }
+
+    if (state->config.decimated)
+    {
+        state->flags |= ADC_STREAM_FLAG_DECIMATED;
+        state->sequence_step = (uint16_t)ADC_FILTER_DECIMATION_FACTOR;
+        (void)BSP_ADC1_RingReaderInit(&state->reader,
+                                      BSP_ADC1_STREAM_DECIMATED);
+    }
+    else
+    {
+        state->sequence_step = 1U;
+        (void)BSP_ADC1_RingReaderInit(&state->reader, BSP_ADC1_STREAM_FULL);
+    }
+
+    IP_ADDR4(&state->dest, (uint8_t)(state->config.dest_addr >> 24U),
+             (uint8_t)(state->config.dest_addr >> 16U),
+             (uint8_t)(state->config.dest_addr >> 8U),
+             (uint8_t)state->config.dest_addr);
+
+    if (adc_stream_is_active(&state->config))
+    {
+        printf("ADC stream: %u channel(s), %u frames of %u bytes%s to "
+               "%s:%u\n",
+               (unsigned int)state->channel_count,
+               (unsigned int)state->max_frames,
+               (unsigned int)state->frame_size,
+               state->compress ? " (compressed)" : "",
+               ipaddr_ntoa(&state->dest),
+               (unsigned int)state->config.dest_port);
+    }
+}
+
+#if ADC_STREAM_FAST_PATH
+/**
+ * @brief Build the headers of the fast path
+ *
+ * Called with the core locked after a datagram went through lwIP, so the
+ * connection has its local port and the next hop is in the ARP table if
+ * it answered. Broadcast and multicast destinations stay on lwIP.
+ */
+static void adc_stream_resolve(adc_stream_state_t *state)
+{
+    const struct udp_pcb *pcb      = state->conn->pcb.udp;
+    const ip4_addr_t     *dest     = ip_2_ip4(&state->dest);
+    const ip4_addr_t     *next_hop = dest;
+    const ip4_addr_t     *found;
+    struct netif         *netif;
+    struct eth_addr      *mac;
+    struct eth_hdr       *eth;
+    struct ip_hdr        *ip;
+    struct udp_hdr       *udp;
+
+    state->fast     = false;
+    state->resolved = xTaskGetTickCount();
+
+    netif = ip4_route(dest);
+    if ((netif == NULL) || !netif_is_up(netif) || !netif_is_link_up(netif) ||
+        ((netif->flags & NETIF_FLAG_ETHARP) == 0U) ||
+        ip4_addr_isbroadcast(dest, netif) || ip4_addr_ismulticast(dest) ||
+        (pcb->local_port == 0U))
+    {
+        return;
+    }
+
+    if (!ip4_addr_netcmp(dest, netif_ip4_addr(netif),
+                         netif_ip4_netmask(netif)))
+    {
+        next_hop = netif_ip4_gw(netif);
+    }
+    if (etharp_find_addr(netif, next_hop, &mac, &found) < 0)
+    {
+        return;
+    }
+
+    (void)memset(state->link_hdr, 0, sizeof(state->link_hdr));
+
+    eth = (struct eth_hdr *)state->link_hdr;
+    SMEMCPY(&eth->dest, mac, ETH_HWADDR_LEN);
+    SMEMCPY(&eth->src, netif->hwaddr, ETH_HWADDR_LEN);
+    eth->type = PP_HTONS(ETHTYPE_IP);
+
+    /* Lengths, identification and checksum are filled in per datagram;
+     * the datagrams never exceed the MTU, so they are not fragmented */
+    ip = (struct ip_hdr *)&state->link_hdr[SIZEOF_ETH_HDR];
+    IPH_VHL_SET(ip, 4, IP_HLEN / 4U);
+    IPH_TOS_SET(ip, pcb->tos);
+    IPH_OFFSET_SET(ip, PP_HTONS(IP_DF));
+    IPH_TTL_SET(ip, pcb->ttl);
+    IPH_PROTO_SET(ip, IP_PROTO_UDP);
+    IPADDR2_COPY(&ip->src, netif_ip4_addr(netif));
+    IPADDR2_COPY(&ip->dest, dest);
+
+    udp       = (struct udp_hdr *)&state->link_hdr[SIZEOF_ETH_HDR + IP_HLEN];
+    udp->src  = lwip_htons(pcb->local_port);
+    udp->dest = lwip_htons(state->config.dest_port);
+
+    state->netif = netif;
+    state->fast  = true;
+}
+
+/**
+ * @brief Put the headers in front of a datagram and queue it for the MAC
+ *
+ * Takes over the caller's reference to @p p. A frame the TX ring has no
+ * room for is lost, as a failed send through lwIP would be.
+ */
+static void adc_stream_send_fast(adc_stream_state_t *state, struct pbuf *p)
+{
+    const u16_t     udp_len = (u16_t)(p->tot_len + UDP_HLEN);
+    struct ip_hdr  *ip;
+    struct udp_hdr *udp;
+
+    /* PBUF_TRANSPORT left exactly this headroom */
+    if (pbuf_add_header(p, ADC_STREAM_LINK_HLEN) != 0U)
+    {
+        (void)pbuf_free(p);
+        return;
+    }
+
+    (void)memcpy(p->payload, state->link_hdr, ADC_STREAM_LINK_HLEN);
+    ip  = (struct ip_hdr *)((uint8_t *)p->payload + SIZEOF_ETH_HDR);
+    udp = (struct udp_hdr *)((uint8_t *)ip + IP_HLEN);
+
+    IPH_LEN_SET(ip, lwip_htons((u16_t)(udp_len + IP_HLEN)));
+    IPH_ID_SET(ip, lwip_htons(state->ip_id));
+    state->ip_id++;
+#if !ETHIF_CHECKSUM_OFFLOAD
+    IPH_CHKSUM_SET(ip, inet_chksum(ip, IP_HLEN));
+#endif
+    udp->len = lwip_htons(udp_len);
+
+    LOCK_TCPIP_CORE();
+    if (netif_is_up(state->netif) && netif_is_link_up(state->netif))
+    {
+        (void)state->netif->linkoutput(state->netif, p);
+    }
+    else
+    {
+        state->fast = false;
+    }
+    UNLOCK_TCPIP_CORE();
+
+    /* The driver holds its own reference until the DMA has sent it */
+    (void)pbuf_free(p);
+}
+#endif
+
+/**
+ * @brief Fill in the header and send the datagram being filled
+ *
+ * The pbuf is released once lwIP and the driver are done with it; a failed
+ * send still consumes a datagram sequence number, so the receiver sees it
+ * as lost.
+ */
+static void adc_stream_send(adc_stream_state_t *state)
+{
+    uint8_t *hdr   = (uint8_t *)state->pbuf->payload;
+    uint64_t time  = 0U;
+    uint8_t  flags = state->flags;
+
+    if (ptp_is_locked() &&
+        (BSP_ADC1_GetSampleTimeNs(state->first_sequence, &time) == BSP_OK))
+    {
+        flags |= ADC_STREAM_FLAG_TIME_VALID | ADC_STREAM_FLAG_TIME_PTP;
+#if BSP_ADC1_SYNC
+        if (BSP_ADC1_IsTriggerSynced())
+        {
+            flags |= ADC_STREAM_FLAG_TIME_ALIGNED;
+        }
+#endif
+    }
+    else if (BSP_ADC1_GetSampleTime(state->first_sequence, &time) == BSP_OK)
+    {
+        flags |= ADC_STREAM_FLAG_TIME_VALID;
+    }
+
+    hdr    = put_u16(hdr, ADC_STREAM_MAGIC);
+    hdr[0] = (uint8_t)ADC_STREAM_VERSION;
+    hdr[1] = flags;
+    hdr[2] = state->config.channel_mask;
+    hdr[3] = state->channel_count;
+    hdr    = put_u16(&hdr[4], state->frame_count);
+    hdr    = put_u32(hdr, state->datagram_sequence);
+    hdr    = put_u32(hdr, state->first_sequence);
+    hdr    = put_u16(hdr, state->sequence_step);
+    hdr    = put_u16(hdr, state->frame_size);
+    hdr    = put_u32(hdr, state->lost);
+    (void)put_u64(hdr, time);
+
+    /* Trim the pool pbuf to the bytes actually written */
+    pbuf_realloc(state->pbuf,
+                 (u16_t)(state->write - (uint8_t *)state->pbuf->payload));
+
+#if ADC_STREAM_FAST_PATH
+    if (state->fast && ((xTaskGetTickCount() - state->resolved) <
+                        pdMS_TO_TICKS(ADC_STREAM_RESOLVE_MS)))
+    {
+        adc_stream_send_fast(state, state->pbuf);
+        state->pbuf = NULL;
+    }
+    else
+#endif
+    {
+        /* The netbuf only carries the pbuf; netbuf_free() drops our
+         * reference */
+        state->buf->p   = state->pbuf;
+        state->buf->ptr = state->pbuf;
+        state->pbuf     = NULL;
+
+        (void)netconn_sendto(state->conn, state->buf, &state->dest,
+                             state->config.dest_port);
+        netbuf_free(state->buf);
+
+#if ADC_STREAM_FAST_PATH
+        LOCK_TCPIP_CORE();
+        adc_stream_resolve(state);
+        UNLOCK_TCPIP_CORE();
+#endif
+    }
+
+    state->datagram_sequence++;
+    state->frame_count = 0U;
+}
+
+/**
+ * @brief Allocate the pbuf of a new datagram
+ *
+ * @return false if the pool is exhausted.
+ */
+static bool adc_stream_open(adc_stream_state_t *state)
+{
+    state->pbuf = pbuf_alloc(PBUF_TRANSPORT, (u16_t)ADC_STREAM_MAX_PAYLOAD,
+                             PBUF_POOL);
+    if (state->pbuf == NULL)
+    {
+        return false;
+    }
+    state->write = (uint8_t *)state->pbuf->payload + ADC_STREAM_HEADER_SIZE;
+
+    return true;
+}
+
+/**
+ * @brief Code the staged frames into the datagram, sending it when full
+ *
+ * @return false if no pbuf was available and the staged frames were
+ *         dropped.
+ */
+static bool adc_stream_code(adc_stream_state_t *state)
+{
+    const uint32_t count = state->staged;
+    size_t         size  = 0U;
+    bool           coded = false;
+
+    if (state->pbuf != NULL)
+    {
+        const size_t room =
+            (size_t)(((uint8_t *)state->pbuf->payload +
+                      ADC_STREAM_MAX_PAYLOAD) -
+                     state->write);
+
+        if (room >= SAMPLE_CODEC_MAX_SIZE(state->channel_count, count))
+        {
+            size  = sample_codec_encode(&state->codec, s_staged, count,
+                                        state->write);
+            coded = true;
+        }
+        else
+        {
+            size = sample_codec_encode(&state->codec, s_staged, count,
+                                       s_coded);
+            if (size <= room)
+            {
+                (void)memcpy(state->write, s_coded, size);
+                coded = true;
+            }
+            else
+            {
+                adc_stream_send(state);
+            }
+        }
+    }
+
+    if (!coded)
+    {
+        /* The block starts a new datagram */
+        if (!adc_stream_open(state))
+        {
+            state->dropped += count;
+            metrics_add(METRIC_ADC_DROPPED, count);
+            state->staged = 0U;
+            return false;
+        }
+        sample_codec_init(&state->codec, state->channel_count);
+        state->first_sequence = state->staged_sequence;
+        state->lost           = state->staged_lost;
+        state->opened         = state->staged_opened;
+        size = sample_codec_encode(&state->codec, s_staged, count,
+                                   state->write);
+    }
+
+    state->write += size;
+    state->frame_count = (uint16_t)(state->frame_count + count);
+    state->staged      = 0U;
+
+    return true;
+}
+
+/**
+ * @brief Send everything held back, coding the staged frames first
+ *
+ * @return false if no pbuf was available and the staged frames were
+ *         dropped.
+ */
+static bool adc_stream_flush(adc_stream_state_t *state)
+{
+    if ((state->staged > 0U) && !adc_stream_code(state))
+    {
+        return false;
+    }
+    if (state->frame_count > 0U)
+    {
+        adc_stream_send(state);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Stage one sample of a compressed stream
+ *
+ * @return false if no pbuf was available; the staged frames were dropped
+ *         and counted, the sample itself was not.
+ */
+static bool adc_stream_stage(adc_stream_state_t *state,
+                             const bsp_adc1_sample_t *sample)
+{
+    const uint8_t mask = state->config.channel_mask;
+    uint16_t     *dst;
+
+    /* Frames in a datagram are consecutive samples */
+    if (((state->frame_count > 0U) || (state->staged > 0U)) &&
+        (sample->sequence != state->next_sequence) &&
+        !adc_stream_flush(state))
+    {
+        return false;
+    }
+
+    if ((state->staged >= ADC_STREAM_CODEC_BLOCK) && !adc_stream_code(state))
+    {
+        return false;
+    }
+
+    if (state->staged == 0U)
+    {
+        state->staged_sequence = sample->sequence;
+        state->staged_lost     = state->reader.overruns + state->dropped;
+        state->staged_opened   = xTaskGetTickCount();
+    }
+
+    dst = &s_staged[(uint32_t)state->staged * state->channel_count];
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if ((mask & (1U << ch)) != 0U)
+        {
+            *dst++ = sample->raw[ch];
+        }
+    }
+
+    state->staged++;
+    state->next_sequence = sample->sequence + state->sequence_step;
+
+    return true;
+}
+
+/**
+ * @brief Append one sample to the datagram, sending it when needed
+ *
+ * @return false if no pbuf was available and the sample was dropped.
+ */
+static bool adc_stream_append(adc_stream_state_t *state,
+                              const bsp_adc1_sample_t *sample)
+{
+    const uint8_t mask = state->config.channel_mask;
+
+    /* Frames in a datagram are consecutive samples */
+    if ((state->frame_count > 0U) && (sample->sequence != state->next_sequence))
+    {
+        adc_stream_send(state);
+    }
+
+    if ((state->pbuf == NULL) && !adc_stream_open(state))
+    {
+        return false;
+    }
+
+    if (state->frame_count == 0U)
+    {
+        state->first_sequence = sample->sequence;
+        state->lost           = state->reader.overruns + state->dropped;
+        state->opened         = xTaskGetTickCount();
+    }
+
+    if ((state->flags & ADC_STREAM_FLAG_RAW) != 0U)
+    {
+        for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+        {
+            if ((mask & (1U << ch)) != 0U)
+            {
+                state->write = put_u16(state->write, sample->raw[ch]);
+            }
+        }
+    }
+
+    if ((state->flags & ADC_STREAM_FLAG_FILTERED) != 0U)
+    {
+        for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+        {
+            if ((mask & (1U << ch)) != 0U)
+            {
+                uint32_t bits;
+
+                (void)memcpy(&bits, &sample->filtered[ch], sizeof(bits));
+                state->write = put_u32(state->write, bits);
+            }
+        }
+    }
+
+    if ((state->flags & ADC_STREAM_FLAG_DI) != 0U)
+    {
+        state->write = put_u16(
+            state->write,
+            (uint16_t)(sample->di | ((uint16_t)sample->di_edges << 8U)));
+    }
+
+    state->frame_count++;
+    state->next_sequence = sample->sequence + state->sequence_step;
+
+    if (state->frame_count >= state->max_frames)
+    {
+        adc_stream_send(state);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Move all available ring samples into datagrams
+ */
+static void adc_stream_drain(adc_stream_state_t *state)
+{
+    uint32_t count = 0U;
+
+    do
+    {
+        uint32_t overruns = state->reader.overruns;
+
+        if (BSP_ADC1_RingRead(&state->reader, s_chunk, ADC_STREAM_READ_CHUNK,
+                              &count) != BSP_OK)
+        {
+            return;
+        }
+        metrics_add(METRIC_ADC_OVERRUN, state->reader.overruns - overruns);
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            const bool stored = state->compress
+                                    ? adc_stream_stage(state, &s_chunk[i])
+                                    : adc_stream_append(state, &s_chunk[i]);
+
+            if (!stored)
+            {
+                /* Pool exhausted: the rest of this chunk is lost */
+                state->dropped += count - i;
+                metrics_add(METRIC_ADC_DROPPED, count - i);
+                return;
+            }
+        }
+    } while (count == ADC_STREAM_READ_CHUNK);
+
+    /* Bound the latency of slow streams */
+    if (((state->frame_count > 0U) || (state->staged > 0U)) &&
+        ((xTaskGetTickCount() -
+          ((state->frame_count > 0U) ? state->opened : state->staged_opened)) >=
+         pdMS_TO_TICKS(ADC_STREAM_FLUSH_MS)))
+    {
+        (void)adc_stream_flush(state);
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void adc_stream_set_config(const adc_stream_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_pending_config = *config;
+    s_config_generation++;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief ADC stream task
+ */
+void vAdcStreamTask(void *pvParameters)
+{
+    adc_stream_state_t *state = &s_stream;
+
+    (void)pvParameters;
+
+    /* Wait for the network interface, as the Modbus task does */
+    (void)boot_wait(BOOT_EVENT_NETIF_UP, BOOT_WAIT_FOREVER);
+
+    while ((state->conn = netconn_new(NETCONN_UDP)) == NULL)
+    {
+        printf("ADC stream: Failed to create UDP connection\n");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    while ((state->buf = netbuf_new()) == NULL)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    /* Streams are bulk traffic, queued behind Modbus by tagging switches */
+    LOCK_TCPIP_CORE();
+    state->conn->pcb.udp->tos = ETHERNETIF_TOS_BULK;
+    UNLOCK_TCPIP_CORE();
+
+    printf("ADC stream task started\n");
+
+    for (;;)
+    {
+        adc_stream_apply_config(state);
+
+        if (adc_stream_is_active(&state->config) && (state->max_frames > 0U))
+        {
+            adc_stream_drain(state);
+            vTaskDelay(pdMS_TO_TICKS(ADC_STREAM_POLL_MS));
+        }
+        else
+        {
+            vTaskDelay(pdMS_TO_TICKS(ADC_STREAM_IDLE_MS));
+        }
+    }
+}
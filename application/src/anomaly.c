@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Spectral Anomaly Detection
+ *
+ * Runs in the spectrum analysis task once per frame (spectrum frame hook).
+ * The feature vector, the hidden layer and the reconstruction of the
+ * channel being scored live in one static tensor arena; the two layers
+ * are arm_fully_connected_s8() calls, which need no scratch buffer. The
+ * status is published in one short critical section per frame, so a read
+ * always copies a set scored together. See anomaly.h.
+ */
+
+#include "anomaly.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if ANOMALY_DETECT
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+#include "live_data.h"
+#include "log.h"
+#include "nor_log.h"
+#endif
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+#if ANOMALY_DETECT
+
+/** Score units per quantization step, 0.01 dB */
+#define ANOMALY_UNITS_PER_STEP (ANOMALY_FEATURE_STEP_DB * 100.0f)
+
+/** Largest register value */
+#define ANOMALY_REGISTER_MAX 65535.0f
+
+/** Steps per natural log unit of a power: 10 / ln(10) dB */
+#define ANOMALY_STEPS_PER_LN (4.3429448f / ANOMALY_FEATURE_STEP_DB)
+
+/** Quantized feature of a power of 1 (0.1 mV squared), -20 dB re 1 mV */
+#define ANOMALY_STEPS_AT_UNIT_POWER \
+    ((float32_t)ANOMALY_FEATURE_ZERO_POINT - (20.0f / ANOMALY_FEATURE_STEP_DB))
+
+#endif /* ANOMALY_DETECT */
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+#if ANOMALY_DETECT
+
+/**
+ * @brief Tensors of one inference
+ */
+typedef struct
+{
+    int8_t features[ANOMALY_FEATURES];       /**< Model input */
+    int8_t hidden[ANOMALY_HIDDEN];           /**< Encoder output */
+    int8_t reconstruction[ANOMALY_FEATURES]; /**< Model output */
+} anomaly_arena_t;
+
+#endif /* ANOMALY_DETECT */
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** 16 bands from bin 1 (9.77 Hz) to the Nyquist frequency: single bins at
+ * the bottom, half octaves from bin 4, the top octave whole */
+const uint16_t anomaly_band_edges[ANOMALY_BANDS + 1U] = {
+    1U,  2U,  3U,  4U,   6U,   8U,   11U,  16U,  23U,
+    32U, 45U, 64U, 91U, 128U, 181U, 256U, SPECTRUM_BINS};
+
+/** Alarm configuration, guarded by a critical section */
+static anomaly_config_t s_config = {0U, ANOMALY_DEFAULT_HOLD_FRAMES};
+
+/** Status of the last frame, guarded by a critical section */
+static anomaly_status_t s_status;
+
+#if ANOMALY_DETECT
+
+/** Tensors of the channel being scored */
+static anomaly_arena_t s_arena;
+
+/** Levels of the channel being scored, then their logs */
+static float32_t s_levels[ANOMALY_FEATURES];
+
+/** Consecutive frames each channel spent on the other side of the
+ * threshold from its alarm */
+static uint16_t s_pending[BSP_ADC1_NUM_CHANNELS];
+
+#endif /* ANOMALY_DETECT */
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+#if ANOMALY_DETECT
+
+/**
+ * @brief Quantize the features of one channel into the arena
+ *
+ * @param[in] bins SPECTRUM_BINS amplitude records of the channel, 0.1 mV
+ * @param[in] rms  AC RMS of the channel, 0.1 mV
+ */
+static void anomaly_features(const uint16_t *bins, uint16_t rms)
+{
+    for (uint32_t b = 0U; b < ANOMALY_BANDS; b++)
+    {
+        float32_t power = 0.0f;
+
+        for (uint32_t k = anomaly_band_edges[b];
+             k < anomaly_band_edges[b + 1U]; k++)
+        {
+            float32_t amplitude = (float32_t)bins[k];
+
+            power += amplitude * amplitude;
+        }
+        s_levels[b] = power;
+    }
+    s_levels[ANOMALY_BANDS] = (float32_t)rms * (float32_t)rms;
+
+    /* Powers in 0.1 mV squared, at least 1; lower ones read as the floor */
+    for (uint32_t f = 0U; f < ANOMALY_FEATURES; f++)
+    {
+        if (s_levels[f] < 1.0f)
+        {
+            s_levels[f] = 1.0f;
+        }
+    }
+    arm_vlog_f32(s_levels, s_levels, ANOMALY_FEATURES);
+    arm_scale_f32(s_levels, ANOMALY_STEPS_PER_LN, s_levels, ANOMALY_FEATURES);
+    arm_offset_f32(s_levels, ANOMALY_STEPS_AT_UNIT_POWER + 0.5f, s_levels,
+                   ANOMALY_FEATURES);
+
+    for (uint32_t f = 0U; f < ANOMALY_FEATURES; f++)
+    {
+        float32_t q = s_levels[f];
+
+        if (q >= 127.0f)
+        {
+            s_arena.features[f] = 127;
+        }
+        else if (q <= -128.0f)
+        {
+            s_arena.features[f] = -128;
+        }
+        else
+        {
+            /* Rounded down: the offset carries the half step */
+            s_arena.features[f] = (int8_t)(int32_t)floorf(q);
+        }
+    }
+}
+
+/**
+ * @brief Run one fully connected layer
+ *
+ * @param[in]  layer   Weights and quantization
+ * @param[in]  input   @p inputs values
+ * @param[in]  inputs  Input size
+ * @param[out] output  @p outputs values
+ * @param[in]  outputs Output size
+ */
+static void anomaly_layer(const anomaly_layer_t *layer, const int8_t *input,
+                          int32_t inputs, int8_t *output, int32_t outputs)
+{
+    const cmsis_nn_context   ctx    = {NULL, 0};
+    const cmsis_nn_fc_params params = {layer->input_offset, 0,
+                                       layer->output_offset, {-128, 127}};
+    const cmsis_nn_per_tensor_quant_params quant = {layer->multiplier,
+                                                    layer->shift};
+    const cmsis_nn_dims input_dims  = {1, 1, 1, inputs};
+    const cmsis_nn_dims filter_dims = {inputs, 1, 1, outputs};
+    const cmsis_nn_dims bias_dims   = {1, 1, 1, outputs};
+    const cmsis_nn_dims output_dims = {1, 1, 1, outputs};
+
+    (void)arm_fully_connected_s8(&ctx, &params, &quant, &input_dims, input,
+                                 &filter_dims, layer->weights, &bias_dims,
+                                 layer->bias, &output_dims, output);
+}
+
+/**
+ * @brief Score one channel from the features in the arena
+ *
+ * @param[in] model Model of the channel
+ * @return Score, 0.01 dB
+ */
+static uint16_t anomaly_score(const anomaly_model_t *model)
+{
+    int32_t   sum = 0;
+    float32_t rms;
+
+    anomaly_layer(&model->encoder, s_arena.features, (int32_t)ANOMALY_FEATURES,
+                  s_arena.hidden, (int32_t)ANOMALY_HIDDEN);
+    anomaly_layer(&model->decoder, s_arena.hidden, (int32_t)ANOMALY_HIDDEN,
+                  s_arena.reconstruction, (int32_t)ANOMALY_FEATURES);
+
+    for (uint32_t f = 0U; f < ANOMALY_FEATURES; f++)
+    {
+        int32_t error = (int32_t)s_arena.reconstruction[f] -
+                        (int32_t)s_arena.features[f];
+
+        sum += error * error;
+    }
+
+    (void)arm_sqrt_f32((float32_t)sum / (float32_t)ANOMALY_FEATURES, &rms);
+    rms *= ANOMALY_UNITS_PER_STEP;
+
+    return (rms >= ANOMALY_REGISTER_MAX) ? (uint16_t)ANOMALY_REGISTER_MAX
+                                         : (uint16_t)(rms + 0.5f);
+}
+
+#endif /* ANOMALY_DETECT */
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void anomaly_set_config(const anomaly_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_config = *config;
+    if (s_config.hold_frames == 0U)
+    {
+        s_config.hold_frames = 1U;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void anomaly_get_status(anomaly_status_t *status)
+{
+    if (status == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *status = s_status;
+    taskEXIT_CRITICAL();
+}
+
+#if ANOMALY_DETECT
+
+void anomaly_process(uint16_t channels, const uint16_t *bins,
+                     const spectrum_result_t *results)
+{
+    anomaly_config_t config;
+    anomaly_status_t status;
+
+    taskENTER_CRITICAL();
+    config = s_config;
+    status = s_status;
+    taskEXIT_CRITICAL();
+
+    /* Only this task writes the status, so the copy is current */
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        uint16_t bit    = (uint16_t)(1U << ch);
+        bool     active = ((status.alarms & bit) != 0U);
+        bool     over   = false;
+
+        status.score[ch] = 0U;
+        if ((channels & bit) != 0U)
+        {
+            anomaly_features(&bins[(uint32_t)ch * SPECTRUM_BINS],
+                             results[ch].rms);
+            status.score[ch] = anomaly_score(&anomaly_models[ch]);
+            over = (config.threshold != 0U) &&
+                   (status.score[ch] > config.threshold);
+        }
+
+        if (over == active)
+        {
+            s_pending[ch] = 0U;
+            continue;
+        }
+
+        /* Alarms off, or the channel not analysed: clear at once */
+        s_pending[ch]++;
+        if (((config.threshold != 0U) && ((channels & bit) != 0U)) &&
+            (s_pending[ch] < config.hold_frames))
+        {
+            continue;
+        }
+
+        s_pending[ch] = 0U;
+        status.alarms ^= bit;
+        if (over)
+        {
+            status.events++;
+            LOG("Anomaly: A%u alarm raised, score %u\n", (unsigned int)ch,
+                (unsigned int)status.score[ch]);
+        }
+        else
+        {
+            LOG("Anomaly: A%u alarm cleared, score %u\n", (unsigned int)ch,
+                (unsigned int)status.score[ch]);
+        }
+#if BSP_SPINOR_ENABLE
+        nor_log_event(NOR_LOG_SOURCE_ANOMALY, over ? 1U : 0U, (uint16_t)ch,
+                      (int32_t)status.score[ch]);
+#endif
+#if HTTP_SERVER
+        live_data_event(LIVE_DATA_SOURCE_ANOMALY, over ? 1U : 0U,
+                        (uint16_t)ch, (int32_t)status.score[ch]);
+#endif
+    }
+    status.frame = spectrum_get_results(NULL);
+
+    taskENTER_CRITICAL();
+    s_status = status;
+    taskEXIT_CRITICAL();
+}
+
+#endif /* ANOMALY_DETECT */
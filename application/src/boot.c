@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Boot Sequencing and Profile
+ *
+ * Stages are appended under PRIMASK, which also works before the
+ * scheduler starts, and keep the order in which they were reached.
+ */
+
+#include "boot.h"
+
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "event_groups.h"
+
+/** Bit number of BOOT_EVENT_SERVICE_UP, the end of the boot */
+#define BOOT_SERVICE_EVENT_BIT 3U
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One timestamped stage
+ */
+typedef struct
+{
+    const char *name;   /**< Stage name */
+    uint32_t    cycles; /**< Cycle counter when the stage was reached */
+} boot_stage_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Boot events, created by boot_init() */
+static StaticEventGroup_t s_events_buffer;
+static EventGroupHandle_t s_events;
+
+/** Events set at least once, each timestamped on its first setting */
+static uint32_t s_events_seen;
+
+/** Stage names of the events, by bit */
+static const char *const s_event_names[] = {"net_stack", "netif_up",
+                                            "link_up", "service_up",
+                                            "config"};
+
+_Static_assert((1UL << BOOT_SERVICE_EVENT_BIT) == BOOT_EVENT_SERVICE_UP,
+               "service event bit");
+
+/** Timestamped stages, in the order reached */
+static boot_stage_t s_stages[BOOT_MAX_STAGES];
+static uint32_t     s_stage_count;
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void boot_init(void)
+{
+    s_events = xEventGroupCreateStatic(&s_events_buffer);
+}
+
+void boot_mark(const char *stage)
+{
+    uint32_t cycles  = BSP_CycleCounter_Read();
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (s_stage_count < BOOT_MAX_STAGES)
+    {
+        s_stages[s_stage_count].name   = stage;
+        s_stages[s_stage_count].cycles = cycles;
+        s_stage_count++;
+    }
+    __set_PRIMASK(primask);
+}
+
+void boot_event_set(uint32_t events)
+{
+    uint32_t first;
+
+    taskENTER_CRITICAL();
+    first = events & ~s_events_seen;
+    s_events_seen |= events;
+    taskEXIT_CRITICAL();
+
+    for (uint32_t i = 0U;
+         i < (sizeof(s_event_names) / sizeof(s_event_names[0])); i++)
+    {
+        if ((first & (1UL << i)) != 0U)
+        {
+            boot_mark(s_event_names[i]);
+        }
+    }
+
+    (void)xEventGroupSetBits(s_events, (EventBits_t)events);
+}
+
+void boot_event_clear(uint32_t events)
+{
+    (void)xEventGroupClearBits(s_events, (EventBits_t)events);
+}
+
+bool boot_wait(uint32_t events, uint32_t timeout_ms)
+{
+    TickType_t  ticks = (timeout_ms == BOOT_WAIT_FOREVER)
+                            ? portMAX_DELAY
+                            : pdMS_TO_TICKS(timeout_ms);
+    EventBits_t bits  = xEventGroupWaitBits(s_events, (EventBits_t)events,
+                                            pdFALSE, pdTRUE, ticks);
+
+    return ((uint32_t)bits & events) == events;
+}
+
+void boot_profile_print(void)
+{
+    uint32_t per_us = BSP_CycleCounter_Hz() / 1000000U;
+    uint32_t count  = s_stage_count;
+    uint32_t prev   = 0U;
+
+    printf("\n=== Boot Profile ===\n");
+    printf("Stage           Time (us)   Delta (us)\n");
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        uint32_t at = s_stages[i].cycles / per_us;
+
+        printf("%-15s %9lu   %10lu\n", s_stages[i].name, (unsigned long)at,
+               (unsigned long)(at - prev));
+        prev = at;
+    }
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        if (s_stages[i].name == s_event_names[BOOT_SERVICE_EVENT_BIT])
+        {
+            uint32_t ms = s_stages[i].cycles / per_us / 1000U;
+
+            printf("Time to service: %lu ms (target %u ms)%s\n",
+                   (unsigned long)ms, BOOT_SERVICE_TARGET_MS,
+                   (ms > BOOT_SERVICE_TARGET_MS) ? " !!! OVER TARGET !!!"
+                                                 : "");
+            break;
+        }
+    }
+    printf("====================\n\n");
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * CAN Publish
+ *
+ * The publish job (cyclic_exec.h) drains the ADC1 sample ring through its
+ * own reader, picks the samples that belong to a frame and packs them into
+ * a CAN FD frame as they arrive; a complete frame goes to the BSP TX queue
+ * at once. The port accepts no frames: with no acceptance filter the
+ * controller drops all bus traffic in hardware. The frame format is
+ * described in can_publish.h.
+ */
+
+#include "can_publish.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_coefficients.h"
+#include "app_tasks.h"
+#include "arm_math.h"
+#include "bsp.h"
+#include "metrics.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Samples copied out of the ring per read */
+#define CAN_PUBLISH_READ_CHUNK 32U
+
+/** Bytes per sample: one int16 per channel */
+#define CAN_PUBLISH_SAMPLE_SIZE (CAN_PUBLISH_CHANNELS * 2U)
+
+_Static_assert((CAN_PUBLISH_HEADER_SIZE +
+                (CAN_PUBLISH_MAX_SAMPLES * CAN_PUBLISH_SAMPLE_SIZE)) <=
+                   BSP_CAN_MAX_DATA,
+               "samples do not fit one CAN FD frame");
+_Static_assert(CAN_PUBLISH_CHANNELS <= BSP_ADC1_NUM_CHANNELS,
+               "published channels must exist on ADC1");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Publish job state
+ *
+ * Owned by the publish job; only the pending configuration is shared.
+ */
+typedef struct
+{
+    can_publish_config_t config;     /**< Active configuration */
+    bsp_adc1_reader_t    reader;     /**< Ring cursor */
+    uint32_t             generation; /**< Configuration generation applied */
+    uint32_t             period;     /**< Samples from one frame to the next */
+    uint16_t             stride;     /**< Sequence step between samples */
+    uint8_t              samples;    /**< Samples per frame */
+
+    /* Frame being filled, count is 0 if none */
+    bsp_can_frame_t frame;         /**< Frame being filled */
+    uint8_t         count;         /**< Samples stored so far */
+    uint32_t        next_sequence; /**< Sequence expected for the next one */
+} can_publish_state_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+/** Configuration waiting to be applied by the publish job */
+static can_publish_config_t s_pending_config = {
+    .rate_hz      = 0U,
+    .nominal_kbps = 500U,
+    .data_kbps    = 2000U,
+};
+
+/** Incremented on every can_publish_set_config() call */
+static volatile uint32_t s_config_generation = 0U;
+
+/** Samples copied out of the ring, kept off the executive stack */
+static bsp_adc1_sample_t s_chunk[CAN_PUBLISH_READ_CHUNK];
+
+/** Publish job state; the frame header fields never change */
+static can_publish_state_t s_publish = {
+    .frame =
+        {
+            .id     = (uint16_t)CAN_PUBLISH_ID,
+            .length = (uint8_t)BSP_CAN_MAX_DATA,
+            .flags  = (uint8_t)(BSP_CAN_FLAG_FD | BSP_CAN_FLAG_BRS),
+        },
+};
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Store a 16-bit value little-endian
+ */
+static uint8_t *put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFU);
+    dst[1] = (uint8_t)((value >> 8U) & 0xFFU);
+    return &dst[2];
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static uint8_t *put_u32(uint8_t *dst, uint32_t value)
+{
+    dst = put_u16(dst, (uint16_t)(value & 0xFFFFU));
+    return put_u16(dst, (uint16_t)(value >> 16U));
+}
+
+/**
+ * @brief Pick up a configuration published by can_publish_set_config()
+ *
+ * Derives the frame layout and restarts the ring reader. The port is
+ * started, restarted for a new bit rate, or stopped for a zero rate.
+ */
+static void can_publish_apply_config(can_publish_state_t *state)
+{
+    can_publish_config_t previous   = state->config;
+    bsp_can_config_t     port       = {0};
+    uint32_t             generation = s_config_generation;
+    bsp_error_t          status;
+
+    if (generation == state->generation)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    generation    = s_config_generation;
+    state->config = s_pending_config;
+    taskEXIT_CRITICAL();
+
+    state->generation = generation;
+    state->count      = 0U;
+
+    if (state->config.rate_hz > CAN_PUBLISH_MAX_RATE_HZ)
+    {
+        state->config.rate_hz = CAN_PUBLISH_MAX_RATE_HZ;
+    }
+    if (state->config.rate_hz == 0U)
+    {
+        (void)BSP_CAN_Stop();
+        return;
+    }
+
+    state->period  = BSP_ADC1_GetSampleRate() / state->config.rate_hz;
+    state->samples = (state->period < CAN_PUBLISH_MAX_SAMPLES)
+                         ? (uint8_t)state->period
+                         : (uint8_t)CAN_PUBLISH_MAX_SAMPLES;
+    state->stride  = (uint16_t)(state->period / state->samples);
+    (void)BSP_ADC1_RingReaderInit(&state->reader, BSP_ADC1_STREAM_FULL);
+
+    if (BSP_CAN_IsRunning() &&
+        (state->config.nominal_kbps == previous.nominal_kbps) &&
+        (state->config.data_kbps == previous.data_kbps))
+    {
+        return;
+    }
+
+    port.nominal_bitrate = (uint32_t)state->config.nominal_kbps * 1000U;
+    port.data_bitrate    = (uint32_t)state->config.data_kbps * 1000U;
+    status               = BSP_CAN_Start(&port);
+    if (status != BSP_OK)
+    {
+        printf("CAN publish: cannot start at %u/%u kbit/s (%d)\n",
+               (unsigned int)state->config.nominal_kbps,
+               (unsigned int)state->config.data_kbps, (int)status);
+        return;
+    }
+
+    printf("CAN publish: %u frames/s of %u samples at %u/%u kbit/s\n",
+           (unsigned int)(BSP_ADC1_GetSampleRate() / state->period),
+           (unsigned int)state->samples,
+           (unsigned int)state->config.nominal_kbps,
+           (unsigned int)state->config.data_kbps);
+}
+
+/**
+ * @brief Start a frame with its first sample's header
+ */
+static void can_publish_open(can_publish_state_t *state, uint32_t sequence)
+{
+    uint8_t *hdr = state->frame.data;
+    uint8_t  inputs;
+
+    if (BSP_GPIODI_ReadAll(&inputs) != BSP_OK)
+    {
+        inputs = 0U;
+    }
+
+    (void)memset(state->frame.data, 0, sizeof(state->frame.data));
+    hdr    = put_u32(hdr, sequence);
+    hdr    = put_u16(hdr, state->stride);
+    hdr[0] = state->samples;
+    hdr[1] = inputs;
+
+    state->count = 0U;
+}
+
+/**
+ * @brief Add a ring sample to the frame if it belongs to one
+ *
+ * The filter outputs are scaled by 1000 / 32768 so that arm_float_to_q15()
+ * truncates and saturates them to millivolts, as the ADC registers are.
+ */
+static void can_publish_sample(can_publish_state_t     *state,
+                               const bsp_adc1_sample_t *sample)
+{
+    uint32_t  offset = sample->sequence % state->period;
+    uint32_t  index  = offset / state->stride;
+    float32_t scaled[CAN_PUBLISH_CHANNELS];
+    q15_t     millivolts[CAN_PUBLISH_CHANNELS];
+    uint8_t  *dst;
+
+    if (((offset % state->stride) != 0U) || (index >= state->samples))
+    {
+        return;
+    }
+
+    if (index == 0U)
+    {
+        can_publish_open(state, sample->sequence);
+    }
+    else if ((state->count != index) ||
+             (sample->sequence != state->next_sequence))
+    {
+        /* The frame lost a sample; wait for the next one */
+        state->count = 0U;
+        return;
+    }
+    else
+    {
+        /* Next sample of the open frame */
+    }
+
+    arm_scale_f32(sample->filtered, 1000.0f / 32768.0f, scaled,
+                  CAN_PUBLISH_CHANNELS);
+    arm_float_to_q15(scaled, millivolts, CAN_PUBLISH_CHANNELS);
+
+    dst = &state->frame.data[CAN_PUBLISH_HEADER_SIZE +
+                             (index * CAN_PUBLISH_SAMPLE_SIZE)];
+    for (uint8_t ch = 0U; ch < CAN_PUBLISH_CHANNELS; ch++)
+    {
+        dst = put_u16(dst, (uint16_t)millivolts[ch]);
+    }
+
+    state->count++;
+    state->next_sequence = sample->sequence + state->stride;
+
+    if (state->count >= state->samples)
+    {
+        /* A full TX queue is counted in the port statistics */
+        (void)BSP_CAN_Transmit(&state->frame);
+        state->count = 0U;
+    }
+}
+
+/**
+ * @brief Move all available ring samples into frames
+ */
+static void can_publish_drain(can_publish_state_t *state)
+{
+    uint32_t count = 0U;
+
+    do
+    {
+        uint32_t overruns = state->reader.overruns;
+
+        if (BSP_ADC1_RingRead(&state->reader, s_chunk, CAN_PUBLISH_READ_CHUNK,
+                              &count) != BSP_OK)
+        {
+            return;
+        }
+        metrics_add(METRIC_ADC_OVERRUN, state->reader.overruns - overruns);
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            can_publish_sample(state, &s_chunk[i]);
+        }
+    } while (count == CAN_PUBLISH_READ_CHUNK);
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void can_publish_set_config(const can_publish_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_pending_config = *config;
+    s_config_generation++;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief CAN publish job, run by the cyclic executive every frame
+ */
+void can_publish_job(void)
+{
+    can_publish_state_t *state = &s_publish;
+
+    can_publish_apply_config(state);
+
+    if ((state->config.rate_hz != 0U) && BSP_CAN_IsRunning())
+    {
+        can_publish_drain(state);
+    }
+}
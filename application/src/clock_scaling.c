@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Clock Scaling
+ *
+ * The link counters are read without the lwIP core lock: they are only
+ * incremented, and a count torn by a concurrent increment is off by one
+ * frame for one period. The profile time is charged at every evaluation
+ * to the profile of the period just ended. See clock_scaling.h.
+ */
+
+#include "clock_scaling.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "lwip/stats.h"
+#include "task.h"
+#include "timers.h"
+
+#if CLOCK_SCALING
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Evaluations without demand before the idle profile */
+#define CLOCK_SCALING_IDLE_HOLD_PERIODS \
+    (CLOCK_SCALING_IDLE_HOLD_MS / CLOCK_SCALING_PERIOD_MS)
+
+/** Evaluation timer */
+static StaticTimer_t s_timer_buffer;
+static TimerHandle_t s_timer;
+
+/** Statistics, written by the timer service task */
+static clock_scaling_stats_t s_stats;
+
+/** Link frames counted at the previous evaluation */
+static STAT_COUNTER s_last_frames;
+
+/** Evaluations in a row without demand */
+static uint32_t s_quiet_periods;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Ethernet frames received and sent since boot, wrapping
+ */
+static STAT_COUNTER clock_scaling_frames(void)
+{
+#if LINK_STATS
+    return (STAT_COUNTER)(lwip_stats.link.recv + lwip_stats.link.xmit);
+#else
+    return 0U;
+#endif
+}
+
+/**
+ * @brief Switch to a profile and count the switch
+ */
+static void clock_scaling_switch(bsp_clock_profile_t profile)
+{
+    bsp_error_t err = BSP_Clock_SetProfile(profile);
+
+    taskENTER_CRITICAL();
+    if (err == BSP_OK)
+    {
+        s_stats.switches[profile]++;
+    }
+    else
+    {
+        s_stats.vetoes++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Evaluate the period just ended (timer service task)
+ */
+static void clock_scaling_evaluate(TimerHandle_t timer)
+{
+    bsp_clock_profile_t profile = BSP_Clock_GetProfile();
+    STAT_COUNTER        frames  = clock_scaling_frames();
+    bool                busy;
+
+    (void)timer;
+
+    busy = ((STAT_COUNTER)(frames - s_last_frames) >=
+            CLOCK_SCALING_BUSY_FRAMES) ||
+           !BSP_Clock_IdleAllowed();
+    s_last_frames = frames;
+
+    taskENTER_CRITICAL();
+    s_stats.time_ms[profile] += CLOCK_SCALING_PERIOD_MS;
+    taskEXIT_CRITICAL();
+
+    if (busy)
+    {
+        s_quiet_periods = 0U;
+        if (profile != BSP_CLOCK_FULL)
+        {
+            clock_scaling_switch(BSP_CLOCK_FULL);
+        }
+    }
+    else if (s_quiet_periods < CLOCK_SCALING_IDLE_HOLD_PERIODS)
+    {
+        s_quiet_periods++;
+    }
+    else if (profile != BSP_CLOCK_IDLE)
+    {
+        /* Refused if a timer started since BSP_Clock_IdleAllowed() */
+        clock_scaling_switch(BSP_CLOCK_IDLE);
+    }
+    else
+    {
+        /* Idle and staying so */
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void clock_scaling_start(void)
+{
+    s_last_frames = clock_scaling_frames();
+
+    s_timer = xTimerCreateStatic("ClkScale",
+                                 pdMS_TO_TICKS(CLOCK_SCALING_PERIOD_MS),
+                                 pdTRUE, NULL, clock_scaling_evaluate,
+                                 &s_timer_buffer);
+    if ((s_timer == NULL) || (xTimerStart(s_timer, 0U) != pdPASS))
+    {
+        (void)printf("Clock scaling: timer not started\n");
+    }
+}
+
+void clock_scaling_get_stats(clock_scaling_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    (void)memcpy(stats, &s_stats, sizeof(*stats));
+    taskEXIT_CRITICAL();
+}
+
+void clock_scaling_print(void)
+{
+    static const char *const names[BSP_CLOCK_PROFILE_COUNT] = {"Full",
+                                                               "Idle"};
+    clock_scaling_stats_t stats;
+
+    clock_scaling_get_stats(&stats);
+
+    (void)printf("\n=== Clock Profiles (now %s) ===\n",
+                 names[BSP_Clock_GetProfile()]);
+    (void)printf("Profile     Switches    Time (s)\n");
+    (void)printf("------------------------------------------------\n");
+    for (uint32_t i = 0U; i < (uint32_t)BSP_CLOCK_PROFILE_COUNT; i++)
+    {
+        (void)printf("%-11s %-11lu %lu\n", names[i],
+                     (unsigned long)stats.switches[i],
+                     (unsigned long)(stats.time_ms[i] / 1000U));
+    }
+    (void)printf("Idle vetoes: %lu\n", (unsigned long)stats.vetoes);
+    (void)printf("================================================\n\n");
+}
+
+#endif /* CLOCK_SCALING */
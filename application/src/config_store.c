@@ -0,0 +1,867 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Configuration Store
+ *
+ * The values last saved live in a RAM image, one entry per persistent
+ * register, with a flag for the entries the flash does not hold yet. The
+ * Modbus writers update the image and the store task copies the flagged
+ * entries out of it, each with the kernel interrupts masked for a few
+ * loads and stores; the flash is only ever touched by the store task,
+ * outside of any lock. A commit that fails flags its entries again and is
+ * retried CONFIG_STORE_RETRY_MS later. See config_store.h.
+ *
+ * The voltage detector's hook reads the image and the batch in flight with
+ * config_store_pending(), above the kernel mask, so it may land in the
+ * middle of one of those updates. Each entry and the batch carry a
+ * sequence count, odd while they are written: the hook skips what it
+ * catches odd or changed.
+ */
+
+#include "config_store.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "bsp_sections.h"
+#include "jerry_device_registers.h"
+#include "log.h"
+#include "metrics.h"
+#include "modbus_callbacks.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the task (words) */
+#define CONFIG_STORE_STACK_SIZE 256U
+
+/** Longest wait for one erase or program, including another task's */
+#define CONFIG_STORE_FLASH_TIMEOUT_MS 1000U
+
+/** Bytes of a record and of the sector header */
+#define CONFIG_STORE_RECORD_SIZE BSP_FLASH_WORD_SIZE
+
+/** Registers a record holds */
+#define CONFIG_STORE_MAX_WORDS 4U
+
+/** Quad-words of a sector, the header first */
+#define CONFIG_STORE_SLOTS (BSP_FLASH_SECTOR_SIZE / CONFIG_STORE_RECORD_SIZE)
+
+/** Seed of the check, so that neither an erased nor a zero word passes */
+#define CONFIG_STORE_CHECK_SEED 0x5A17C3E9U
+
+/** No active sector */
+#define CONFIG_STORE_NO_SECTOR BSP_FLASH_CONFIG_SECTORS
+
+/** Records of the configuration file */
+#define CONFIG_STORE_FILE_RECORDS               \
+    (CONFIG_STORE_FILE_HEADER_RECORDS +         \
+     (JERRY_DEVICE_PERSISTENT_COUNT * CONFIG_STORE_FILE_ENTRY_RECORDS))
+
+_Static_assert(sizeof(uint32_t[4]) == CONFIG_STORE_RECORD_SIZE,
+               "a record is one quad-word");
+_Static_assert(JERRY_DEVICE_PERSISTENT_COUNT < CONFIG_STORE_SLOTS,
+               "a compacted sector must hold every persistent register");
+_Static_assert(CONFIG_STORE_FILE_ENTRY_RECORDS == (2U + CONFIG_STORE_MAX_WORDS),
+               "a file entry is the key, the count and the value");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Entry of the RAM image
+ */
+typedef struct
+{
+    uint16_t          value[CONFIG_STORE_MAX_WORDS]; /**< Register words */
+    bool              dirty;    /**< Not in the flash yet */
+    volatile uint32_t sequence; /**< Odd while value is written */
+} config_store_entry_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task control block and stack */
+static StaticTask_t s_config_task_tcb;
+static StackType_t  s_config_task_stack[CONFIG_STORE_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** Store task, NULL until started */
+static TaskHandle_t s_config_task;
+
+/** Values last saved, as jerry_device_persistent_registers */
+static config_store_entry_t s_entries[JERRY_DEVICE_PERSISTENT_COUNT];
+
+/** Records of the commit being written, valid until it has ended */
+static uint32_t s_batch[JERRY_DEVICE_PERSISTENT_COUNT][4];
+
+/** Records of s_batch whose commit has not ended, for
+ * config_store_pending() */
+static volatile uint32_t s_batch_count;
+
+/** Odd while s_batch and s_batch_count are written */
+static volatile uint32_t s_batch_sequence;
+
+/** Active sector, CONFIG_STORE_NO_SECTOR before the first commit */
+static uint32_t s_sector = CONFIG_STORE_NO_SECTOR;
+
+/** Generation of the active sector */
+static uint32_t s_generation;
+
+/** Offset of the first erased quad-word of the active sector */
+static uint32_t s_next;
+
+/** Figures, written by the store task only */
+static config_store_stats_t s_stats;
+
+/** Header of the configuration file */
+static const uint16_t s_file_header[CONFIG_STORE_FILE_HEADER_RECORDS] = {
+    (uint16_t)CONFIG_STORE_FILE_VERSION,
+    (uint16_t)CONFIG_STORE_FILE_HEADER_RECORDS,
+    (uint16_t)JERRY_DEVICE_PERSISTENT_COUNT,
+    (uint16_t)CONFIG_STORE_FILE_ENTRY_RECORDS,
+};
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Check of the first three words of a record or header
+ */
+static uint32_t config_store_check(const uint32_t *words)
+{
+    uint32_t w1 = words[1];
+    uint32_t w2 = words[2];
+
+    return CONFIG_STORE_CHECK_SEED ^ words[0] ^ ((w1 << 11) | (w1 >> 21)) ^
+           ((w2 << 22) | (w2 >> 10));
+}
+
+/**
+ * @brief Check whether a quad-word of the flash is erased
+ */
+static bool config_store_erased(const uint32_t *words)
+{
+    return (words[0] & words[1] & words[2] & words[3]) == 0xFFFFFFFFU;
+}
+
+/**
+ * @brief Read the generation of a sector
+ *
+ * A header cut short by a reset fails its ECC check, so it is read with
+ * BSP_Flash_Read() and such a sector is not valid.
+ *
+ * @param[in]  sector     Configuration sector
+ * @param[out] generation Receives the generation of a valid sector
+ * @return true if the sector holds a valid header
+ */
+static bool config_store_header(uint32_t sector, uint32_t *generation)
+{
+    uint32_t header[4];
+
+    if ((BSP_Flash_Read(BSP_Flash_ConfigSector(sector), header,
+                        CONFIG_STORE_RECORD_SIZE) != BSP_OK) ||
+        (header[0] != CONFIG_STORE_MAGIC) ||
+        (header[2] != CONFIG_STORE_VERSION) ||
+        (header[3] != config_store_check(header)))
+    {
+        return false;
+    }
+
+    *generation = header[1];
+    return true;
+}
+
+/**
+ * @brief Entry of a register, JERRY_DEVICE_PERSISTENT_COUNT if none
+ */
+static uint32_t config_store_find(uint16_t address)
+{
+    uint32_t i;
+
+    for (i = 0U; i < JERRY_DEVICE_PERSISTENT_COUNT; i++)
+    {
+        if (jerry_device_persistent_registers[i].address == address)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/**
+ * @brief Build the record of an entry, with interrupts masked
+ */
+static void config_store_record(uint32_t index, uint32_t *record)
+{
+    const jerry_device_persistent_t *reg =
+        &jerry_device_persistent_registers[index];
+    const uint16_t *value = s_entries[index].value;
+
+    record[0] = (uint32_t)reg->address | ((uint32_t)reg->count << 16);
+    record[1] = (uint32_t)value[0] | ((uint32_t)value[1] << 16);
+    record[2] = (uint32_t)value[2] | ((uint32_t)value[3] << 16);
+    record[3] = config_store_check(record);
+}
+
+/**
+ * @brief Load the newest valid record of every register from a sector
+ *
+ * A record whose append was cut short by a reset fails its ECC check; it
+ * is read with BSP_Flash_Read() and skipped like one failing its own
+ * check, so the erased quad-word after it ends the walk.
+ *
+ * @param[in]  sector Configuration sector, holding a valid header
+ * @param[out] loaded Set for each entry a record was found for
+ * @return Offset of the first erased quad-word
+ */
+static uint32_t config_store_load(uint32_t sector, bool *loaded)
+{
+    const uint8_t *slots = BSP_Flash_ConfigSector(sector);
+    uint32_t       slot;
+
+    for (slot = 1U; slot < CONFIG_STORE_SLOTS; slot++)
+    {
+        uint32_t record[4];
+        uint32_t index;
+
+        if (BSP_Flash_Read(&slots[slot * CONFIG_STORE_RECORD_SIZE], record,
+                           CONFIG_STORE_RECORD_SIZE) != BSP_OK)
+        {
+            continue;
+        }
+        if (config_store_erased(record))
+        {
+            break;
+        }
+        if (record[3] != config_store_check(record))
+        {
+            continue;
+        }
+
+        index = config_store_find((uint16_t)record[0]);
+        if ((index < JERRY_DEVICE_PERSISTENT_COUNT) &&
+            (jerry_device_persistent_registers[index].count ==
+             (uint16_t)(record[0] >> 16)))
+        {
+            uint16_t *value = s_entries[index].value;
+
+            value[0]      = (uint16_t)record[1];
+            value[1]      = (uint16_t)(record[1] >> 16);
+            value[2]      = (uint16_t)record[2];
+            value[3]      = (uint16_t)(record[2] >> 16);
+            loaded[index] = true;
+        }
+    }
+
+    return slot * CONFIG_STORE_RECORD_SIZE;
+}
+
+/**
+ * @brief Read a persistent register from the published image
+ *
+ * @param[in]  index Entry
+ * @param[out] value Receives the words, unused ones 0xFFFF
+ * @return true if the register could be read
+ */
+static bool config_store_read(uint32_t index,
+                              uint16_t value[CONFIG_STORE_MAX_WORDS])
+{
+    const jerry_device_persistent_t *reg =
+        &jerry_device_persistent_registers[index];
+
+    (void)memset(value, 0xFF, CONFIG_STORE_MAX_WORDS * sizeof(uint16_t));
+
+    return jerry_device_read_holding_registers(reg->address, reg->count,
+                                               value);
+}
+
+/**
+ * @brief Restore the saved registers
+ *
+ * The image starts out as the defaults. Each value found is written back
+ * through the FC16 callback; one it rejects keeps its default, which is
+ * then flagged so the next commit replaces the value saved.
+ */
+static void config_store_restore(void)
+{
+    bool     loaded[JERRY_DEVICE_PERSISTENT_COUNT] = {false};
+    uint32_t start                                 = BSP_CycleCounter_Read();
+    uint32_t generation[BSP_FLASH_CONFIG_SECTORS];
+    bool     valid[BSP_FLASH_CONFIG_SECTORS];
+
+    for (uint32_t i = 0U; i < JERRY_DEVICE_PERSISTENT_COUNT; i++)
+    {
+        (void)config_store_read(i, s_entries[i].value);
+    }
+
+    for (uint32_t sector = 0U; sector < BSP_FLASH_CONFIG_SECTORS; sector++)
+    {
+        valid[sector] = config_store_header(sector, &generation[sector]);
+    }
+
+    /* The newer one, should a compaction have ended without the erase */
+    if (valid[0] && (!valid[1] || ((int32_t)(generation[0] - generation[1]) >
+                                   0)))
+    {
+        s_sector = 0U;
+    }
+    else if (valid[1])
+    {
+        s_sector = 1U;
+    }
+
+    if (s_sector != CONFIG_STORE_NO_SECTOR)
+    {
+        s_generation = generation[s_sector];
+        s_next       = config_store_load(s_sector, loaded);
+    }
+
+    for (uint32_t i = 0U; i < JERRY_DEVICE_PERSISTENT_COUNT; i++)
+    {
+        const jerry_device_persistent_t *reg =
+            &jerry_device_persistent_registers[i];
+
+        if (!loaded[i])
+        {
+            continue;
+        }
+
+        if (modbus_cb_write_multiple_registers(reg->address, reg->count,
+                                               s_entries[i].value) ==
+            MODBUS_EXCEPTION_NONE)
+        {
+            s_stats.restored++;
+        }
+        else
+        {
+            (void)config_store_read(i, s_entries[i].value);
+            s_entries[i].dirty = true;
+        }
+    }
+
+    s_stats.restore_us = (uint32_t)(((uint64_t)(BSP_CycleCounter_Read() -
+                                                start) *
+                                     1000000U) /
+                                    BSP_CycleCounter_Hz());
+}
+
+/**
+ * @brief Copy the flagged entries, or all of them, into the batch
+ *
+ * @param[in] all Take every entry, for a compaction
+ * @return Records in the batch
+ */
+static uint32_t config_store_collect(bool all)
+{
+    uint32_t count = 0U;
+
+    taskENTER_CRITICAL();
+    s_batch_sequence++;
+    __DMB();
+    for (uint32_t i = 0U; i < JERRY_DEVICE_PERSISTENT_COUNT; i++)
+    {
+        if (all || s_entries[i].dirty)
+        {
+            config_store_record(i, s_batch[count]);
+            count++;
+        }
+    }
+    s_batch_count = count;
+    __DMB();
+    s_batch_sequence++;
+    __DMB();
+
+    /* Only once the batch is whole, so that the hook finds each entry in
+     * one or the other */
+    for (uint32_t i = 0U; i < JERRY_DEVICE_PERSISTENT_COUNT; i++)
+    {
+        s_entries[i].dirty = false;
+    }
+    taskEXIT_CRITICAL();
+
+    return count;
+}
+
+/**
+ * @brief Flag the entries of the batch again, after a failed commit
+ */
+static void config_store_requeue(uint32_t count)
+{
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        uint32_t index = config_store_find((uint16_t)s_batch[i][0]);
+
+        if (index < JERRY_DEVICE_PERSISTENT_COUNT)
+        {
+            s_entries[index].dirty = true;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Erase a sector, or program quad-words into it, and wait
+ *
+ * A write of another task, e.g. a firmware update, is waited for first.
+ *
+ * @param[in] sector Configuration sector
+ * @param[in] offset Offset in the sector
+ * @param[in] data   Quad-words to program, NULL to erase the sector
+ * @param[in] length Bytes to program
+ * @return true if the flash took the erase or the write
+ */
+static bool config_store_flash(uint32_t sector, uint32_t offset,
+                               const void *data, uint32_t length)
+{
+    bsp_error_t result;
+
+    do
+    {
+        /* Only the end of a write matters here, not how it went */
+        result = BSP_Flash_Wait(CONFIG_STORE_FLASH_TIMEOUT_MS);
+        if (result != BSP_TIMEOUT)
+        {
+            result = (data == NULL)
+                         ? BSP_Flash_ConfigEraseAsync(sector)
+                         : BSP_Flash_ConfigWriteAsync(sector, offset, data,
+                                                      length);
+        }
+    } while (result == BSP_BUSY);
+
+    if (result == BSP_OK)
+    {
+        result = BSP_Flash_Wait(CONFIG_STORE_FLASH_TIMEOUT_MS);
+    }
+
+    return result == BSP_OK;
+}
+
+/**
+ * @brief Copy every current value into the other sector and switch to it
+ *
+ * The header is written last: until then the old sector stays the active
+ * one.
+ *
+ * @return true if the other sector is active
+ */
+static bool config_store_compact(void)
+{
+    uint32_t sector =
+        (s_sector == CONFIG_STORE_NO_SECTOR) ? 0U : (s_sector ^ 1U);
+    uint32_t generation = s_generation + 1U;
+    uint32_t header[4];
+    uint32_t count;
+
+    if (!config_store_flash(sector, 0U, NULL, 0U))
+    {
+        return false;
+    }
+
+    count = config_store_collect(true);
+    if (!config_store_flash(sector, CONFIG_STORE_RECORD_SIZE, s_batch,
+                            count * CONFIG_STORE_RECORD_SIZE))
+    {
+        config_store_requeue(count);
+        return false;
+    }
+
+    header[0] = CONFIG_STORE_MAGIC;
+    header[1] = generation;
+    header[2] = CONFIG_STORE_VERSION;
+    header[3] = config_store_check(header);
+    if (!config_store_flash(sector, 0U, header, sizeof(header)))
+    {
+        config_store_requeue(count);
+        return false;
+    }
+
+    s_sector     = sector;
+    s_generation = generation;
+    s_next       = (count + 1U) * CONFIG_STORE_RECORD_SIZE;
+    s_stats.records += count;
+    s_stats.compactions++;
+    LOG("Config: sector %lu active, generation %lu\n", (unsigned long)sector,
+        (unsigned long)generation);
+
+    return true;
+}
+
+/**
+ * @brief Append the flagged entries, compacting first if they do not fit
+ *
+ * @return true if every flagged entry is in the flash
+ */
+static bool config_store_commit(void)
+{
+    uint32_t pending = 0U;
+    uint32_t count;
+
+    for (uint32_t i = 0U; i < JERRY_DEVICE_PERSISTENT_COUNT; i++)
+    {
+        pending += s_entries[i].dirty ? 1U : 0U;
+    }
+    if (pending == 0U)
+    {
+        return true;
+    }
+
+    /* The compaction takes every entry, the flagged ones included */
+    if ((s_sector == CONFIG_STORE_NO_SECTOR) ||
+        ((pending * CONFIG_STORE_RECORD_SIZE) >
+         (BSP_FLASH_SECTOR_SIZE - s_next)))
+    {
+        if (!config_store_compact())
+        {
+            return false;
+        }
+        s_stats.commits++;
+        return true;
+    }
+
+    /* Entries flagged since the count only make the append longer */
+    count = config_store_collect(false);
+    if ((count * CONFIG_STORE_RECORD_SIZE) > (BSP_FLASH_SECTOR_SIZE - s_next))
+    {
+        config_store_requeue(count);
+        s_next = BSP_FLASH_SECTOR_SIZE;
+        return false;
+    }
+    if (!config_store_flash(s_sector, s_next, s_batch,
+                            count * CONFIG_STORE_RECORD_SIZE))
+    {
+        /* The quad-words may be part written, start a fresh sector */
+        config_store_requeue(count);
+        s_next = BSP_FLASH_SECTOR_SIZE;
+        return false;
+    }
+
+    s_next += count * CONFIG_STORE_RECORD_SIZE;
+    s_stats.records += count;
+    s_stats.commits++;
+    return true;
+}
+
+/**
+ * @brief Store task
+ */
+static void config_store_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        /* Let the rest of a burst of writes come in */
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_STORE_COMMIT_DELAY_MS));
+
+        while (!config_store_commit())
+        {
+            s_batch_count = 0U;
+            s_stats.failures++;
+            metrics_add(METRIC_CONFIG_FAIL, 1U);
+            LOG("Config: commit failed, retry in %lu ms\n",
+                (unsigned long)CONFIG_STORE_RETRY_MS);
+            vTaskDelay(pdMS_TO_TICKS(CONFIG_STORE_RETRY_MS));
+        }
+        s_batch_count = 0U;
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void config_store_start(void)
+{
+    bool pending = false;
+
+    config_store_restore();
+
+    if (s_sector == CONFIG_STORE_NO_SECTOR)
+    {
+        printf("Config: no saved configuration, defaults in use\n");
+    }
+    else
+    {
+        printf("Config: %lu registers restored from sector %lu in %lu us\n",
+               (unsigned long)s_stats.restored, (unsigned long)s_sector,
+               (unsigned long)s_stats.restore_us);
+    }
+
+    s_config_task = xTaskCreateStatic(config_store_task, "Config",
+                                      CONFIG_STORE_STACK_SIZE, NULL,
+                                      TASK_PRIO_CONFIG, s_config_task_stack,
+                                      &s_config_task_tcb);
+
+    /* Values the restore rejected are saved as they now are */
+    for (uint32_t i = 0U; i < JERRY_DEVICE_PERSISTENT_COUNT; i++)
+    {
+        pending = pending || s_entries[i].dirty;
+    }
+    if (pending)
+    {
+        (void)xTaskNotifyGive(s_config_task);
+    }
+}
+
+void config_store_note(uint16_t start_address, uint16_t quantity)
+{
+    uint32_t end     = (uint32_t)start_address + quantity;
+    bool     pending = false;
+
+    for (uint32_t i = 0U; i < JERRY_DEVICE_PERSISTENT_COUNT; i++)
+    {
+        const jerry_device_persistent_t *reg =
+            &jerry_device_persistent_registers[i];
+        uint16_t value[CONFIG_STORE_MAX_WORDS];
+
+        if ((reg->address >= end) ||
+            (((uint32_t)reg->address + reg->count) <= start_address) ||
+            !config_store_read(i, value))
+        {
+            continue;
+        }
+
+        taskENTER_CRITICAL();
+        if (memcmp(value, s_entries[i].value, sizeof(value)) != 0)
+        {
+            s_entries[i].sequence++;
+            __DMB();
+            (void)memcpy(s_entries[i].value, value, sizeof(value));
+            __DMB();
+            s_entries[i].sequence++;
+            s_entries[i].dirty = true;
+            pending            = true;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    if (pending && (s_config_task != NULL))
+    {
+        (void)xTaskNotifyGive(s_config_task);
+    }
+}
+
+uint32_t config_store_pending(uint32_t (*records)[4], uint32_t max_records)
+{
+    uint32_t sequence = s_batch_sequence;
+    uint32_t batch;
+    uint32_t count = 0U;
+
+    /* The commit in flight first, so that a newer flagged value wins; a
+     * batch being filled still has its entries flagged */
+    __DMB();
+    batch = ((sequence & 1U) == 0U) ? s_batch_count : 0U;
+    for (uint32_t i = 0U; (i < batch) && (count < max_records); i++)
+    {
+        (void)memcpy(records[count], s_batch[i], sizeof(records[count]));
+        count++;
+    }
+    __DMB();
+    if (s_batch_sequence != sequence)
+    {
+        count = 0U;
+    }
+
+    for (uint32_t i = 0U;
+         (i < JERRY_DEVICE_PERSISTENT_COUNT) && (count < max_records); i++)
+    {
+        if (!s_entries[i].dirty)
+        {
+            continue;
+        }
+
+        sequence = s_entries[i].sequence;
+        __DMB();
+        config_store_record(i, records[count]);
+        __DMB();
+        if (((sequence & 1U) == 0U) && (s_entries[i].sequence == sequence))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+uint32_t config_store_apply(const uint32_t (*records)[4], uint32_t count)
+{
+    uint32_t applied = 0U;
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const uint32_t *record = records[i];
+        uint32_t        index  = config_store_find((uint16_t)record[0]);
+        uint16_t        value[CONFIG_STORE_MAX_WORDS];
+
+        if ((record[3] != config_store_check(record)) ||
+            (index >= JERRY_DEVICE_PERSISTENT_COUNT) ||
+            ((record[0] >> 16) !=
+             jerry_device_persistent_registers[index].count))
+        {
+            continue;
+        }
+
+        value[0] = (uint16_t)record[1];
+        value[1] = (uint16_t)(record[1] >> 16);
+        value[2] = (uint16_t)record[2];
+        value[3] = (uint16_t)(record[2] >> 16);
+
+        /* The callback hands the block to config_store_note() */
+        if (modbus_cb_write_multiple_registers(
+                jerry_device_persistent_registers[index].address,
+                jerry_device_persistent_registers[index].count, value) ==
+            MODBUS_EXCEPTION_NONE)
+        {
+            applied++;
+        }
+    }
+
+    return applied;
+}
+
+modbus_exception_t config_store_read_file_record(uint16_t  file_number,
+                                                 uint16_t  record_number,
+                                                 uint16_t  record_length,
+                                                 uint16_t *values)
+{
+    if ((file_number != CONFIG_STORE_FILE_NUMBER) ||
+        (((uint32_t)record_number + record_length) > CONFIG_STORE_FILE_RECORDS))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    for (uint32_t i = 0U; i < record_length; i++)
+    {
+        uint32_t record = (uint32_t)record_number + i;
+        uint32_t index;
+        uint32_t field;
+
+        if (record < CONFIG_STORE_FILE_HEADER_RECORDS)
+        {
+            values[i] = s_file_header[record];
+            continue;
+        }
+
+        record -= CONFIG_STORE_FILE_HEADER_RECORDS;
+        index = record / CONFIG_STORE_FILE_ENTRY_RECORDS;
+        field = record % CONFIG_STORE_FILE_ENTRY_RECORDS;
+        if (field == 0U)
+        {
+            values[i] = jerry_device_persistent_registers[index].address;
+        }
+        else if (field == 1U)
+        {
+            values[i] = jerry_device_persistent_registers[index].count;
+        }
+        else
+        {
+            taskENTER_CRITICAL();
+            values[i] = s_entries[index].value[field - 2U];
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+modbus_exception_t config_store_write_file_record(uint16_t        file_number,
+                                                  uint16_t        record_number,
+                                                  uint16_t        record_length,
+                                                  const uint16_t *values)
+{
+    uint32_t first = (uint32_t)record_number -
+                     CONFIG_STORE_FILE_HEADER_RECORDS;
+    uint32_t count = (uint32_t)record_length / CONFIG_STORE_FILE_ENTRY_RECORDS;
+
+    if ((file_number != CONFIG_STORE_FILE_NUMBER) ||
+        (record_number < CONFIG_STORE_FILE_HEADER_RECORDS) ||
+        (((uint32_t)record_number + record_length) >
+         CONFIG_STORE_FILE_RECORDS) ||
+        ((first % CONFIG_STORE_FILE_ENTRY_RECORDS) != 0U) ||
+        ((record_length % CONFIG_STORE_FILE_ENTRY_RECORDS) != 0U))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+    first /= CONFIG_STORE_FILE_ENTRY_RECORDS;
+
+    /* Every key first, so that a stale file writes nothing */
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const jerry_device_persistent_t *reg =
+            &jerry_device_persistent_registers[first + i];
+        const uint16_t *entry = &values[i * CONFIG_STORE_FILE_ENTRY_RECORDS];
+
+        if ((entry[0] != reg->address) || (entry[1] != reg->count))
+        {
+            return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+        }
+    }
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const jerry_device_persistent_t *reg =
+            &jerry_device_persistent_registers[first + i];
+        modbus_exception_t result = modbus_cb_write_multiple_registers(
+            reg->address, reg->count,
+            &values[(i * CONFIG_STORE_FILE_ENTRY_RECORDS) + 2U]);
+
+        if (result != MODBUS_EXCEPTION_NONE)
+        {
+            return result;
+        }
+    }
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+void config_store_get_stats(config_store_stats_t *stats)
+{
+    *stats            = s_stats;
+    stats->sector     = s_sector;
+    stats->generation = s_generation;
+    stats->used = (s_sector == CONFIG_STORE_NO_SECTOR) ? 0U : s_next;
+}
+
+void config_store_print(void)
+{
+    config_store_stats_t stats;
+
+    config_store_get_stats(&stats);
+
+    (void)printf("\n=== Configuration Store ===\n");
+    if (stats.sector == CONFIG_STORE_NO_SECTOR)
+    {
+        (void)printf("Sector: none, nothing saved yet\n");
+    }
+    else
+    {
+        (void)printf("Sector: %lu, generation %lu, %lu of %lu bytes used\n",
+                     (unsigned long)stats.sector,
+                     (unsigned long)stats.generation,
+                     (unsigned long)stats.used,
+                     (unsigned long)BSP_FLASH_SECTOR_SIZE);
+    }
+    (void)printf("Restored: %lu registers in %lu us\n",
+                 (unsigned long)stats.restored,
+                 (unsigned long)stats.restore_us);
+    (void)printf("Commits: %lu, records: %lu, compactions: %lu, "
+                 "failures: %lu\n",
+                 (unsigned long)stats.commits, (unsigned long)stats.records,
+                 (unsigned long)stats.compactions,
+                 (unsigned long)stats.failures);
+    (void)printf("===========================\n\n");
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Closed-Loop Control
+ *
+ * Configurations are handed over like the stream and telemetry ones: the
+ * writer stores them and bumps a generation, and the filter task copies
+ * them at the start of its next step. The loop state is only touched by
+ * the filter task.
+ */
+
+#include "control_loop.h"
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "arm_math.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Time between two steps of a loop */
+#define CONTROL_LOOP_PERIOD_S (1.0f / CONTROL_LOOP_RATE_HZ)
+
+/** State of one loop */
+typedef struct
+{
+    control_loop_config_t config; /**< Active configuration */
+    arm_pid_instance_f32  pid;    /**< Discrete PID, gains per step */
+} control_loop_t;
+
+/** Configurations written by control_loop_set_config() */
+static control_loop_config_t s_pending[CONTROL_LOOP_COUNT];
+
+/** Incremented on every control_loop_set_config() call */
+static volatile uint32_t s_config_generation = 0U;
+
+/* Filter task only */
+static control_loop_t s_loops[CONTROL_LOOP_COUNT]; /**< Loop states */
+static uint32_t       s_generation;                /**< Generation applied */
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Limit a duty cycle to the range of a loop
+ */
+static float32_t control_loop_clamp(const control_loop_config_t *config,
+                                    float32_t                    duty)
+{
+    if (duty < (float32_t)config->output_min)
+    {
+        return (float32_t)config->output_min;
+    }
+    if (duty > (float32_t)config->output_max)
+    {
+        return (float32_t)config->output_max;
+    }
+    return duty;
+}
+
+/**
+ * @brief Pick up configurations published by control_loop_set_config()
+ *
+ * The gains become per-step coefficients. A loop that starts, or changes
+ * its input or output, clears its error history and starts from its
+ * start duty; otherwise the previous output is kept.
+ */
+static void control_loop_apply_config(void)
+{
+    control_loop_config_t pending[CONTROL_LOOP_COUNT];
+    uint32_t              generation = s_config_generation;
+
+    if (generation == s_generation)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    generation = s_config_generation;
+    (void)memcpy(pending, s_pending, sizeof(pending));
+    taskEXIT_CRITICAL();
+
+    s_generation = generation;
+
+    for (uint8_t i = 0U; i < CONTROL_LOOP_COUNT; i++)
+    {
+        control_loop_t              *loop = &s_loops[i];
+        const control_loop_config_t *next = &pending[i];
+        bool restart = next->enable && (!loop->config.enable ||
+                                        (next->input != loop->config.input) ||
+                                        (next->output != loop->config.output));
+
+        loop->pid.Kp = next->kp;
+        loop->pid.Ki = next->ki * CONTROL_LOOP_PERIOD_S;
+        loop->pid.Kd = next->kd / CONTROL_LOOP_PERIOD_S;
+        arm_pid_init_f32(&loop->pid, restart ? 1 : 0);
+
+        loop->config = *next;
+        if (restart)
+        {
+            /* state[2] is the previous output of the incremental form */
+            loop->pid.state[2] =
+                control_loop_clamp(next, (float32_t)next->start_duty);
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void control_loop_step(const float32_t *values)
+{
+    control_loop_apply_config();
+
+    /* Hold the outputs until the filters have settled */
+    if (!BSP_ADC1_IsFilterSettled())
+    {
+        return;
+    }
+
+    for (uint8_t i = 0U; i < CONTROL_LOOP_COUNT; i++)
+    {
+        control_loop_t *loop = &s_loops[i];
+        float32_t       duty;
+
+        if (!loop->config.enable)
+        {
+            continue;
+        }
+
+        duty = arm_pid_f32(&loop->pid,
+                           loop->config.setpoint - values[loop->config.input]);
+        duty = control_loop_clamp(&loop->config, duty);
+
+        /* Integrate from the limit, not past it */
+        loop->pid.state[2] = duty;
+
+        (void)BSP_PWM_SetDuty(loop->config.output, (uint16_t)(duty + 0.5f));
+    }
+}
+
+void control_loop_set_config(uint8_t loop, const control_loop_config_t *config)
+{
+    if ((loop >= CONTROL_LOOP_COUNT) || (config == NULL) ||
+        (config->input >= BSP_ADC1_NUM_CHANNELS) ||
+        (config->output >= BSP_PWM_COUNT) ||
+        (config->output_min > config->output_max) ||
+        (config->output_max > BSP_PWM_DUTY_MAX))
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_pending[loop] = *config;
+    s_config_generation++;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * CPU Load Accounting
+ *
+ * Each window takes one uxTaskGetSystemState() snapshot and subtracts the
+ * run-time counters of the previous one, matched by task handle. A task
+ * created during the window is charged from zero, so its first figure
+ * covers its whole life.
+ */
+
+#include "cpu_load.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "task.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task states of the current snapshot (monitor task only) */
+static TaskStatus_t s_task_status[CPU_LOAD_MAX_TASKS];
+
+/** Run-time counters of the previous snapshot, by task handle */
+static TaskHandle_t s_prev_handle[CPU_LOAD_MAX_TASKS];
+static uint64_t     s_prev_run_time[CPU_LOAD_MAX_TASKS];
+static UBaseType_t  s_prev_count;
+
+/** Total run time and interrupt cycles of the previous snapshot */
+static uint64_t s_prev_total;
+static uint64_t s_prev_isr[BSP_ISR_COUNT];
+static bool     s_started;
+
+/** Loads of the last full window */
+static cpu_load_snapshot_t s_snapshot;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Share of a window in hundredths of a percent
+ */
+static uint16_t load_of(uint64_t cycles, uint64_t window)
+{
+    uint64_t load = (window == 0U) ? 0U : ((cycles * 10000U) / window);
+
+    return (load > 10000U) ? 10000U : (uint16_t)load;
+}
+
+/**
+ * @brief Run time of a task at the previous snapshot
+ */
+static uint64_t prev_run_time(TaskHandle_t handle)
+{
+    for (UBaseType_t i = 0U; i < s_prev_count; i++)
+    {
+        if (s_prev_handle[i] == handle)
+        {
+            return s_prev_run_time[i];
+        }
+    }
+
+    return 0U;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void cpu_load_update(void)
+{
+    cpu_load_snapshot_t snapshot;
+    TaskHandle_t        idle = xTaskGetIdleTaskHandle();
+    uint64_t            total;
+    uint64_t            window;
+    UBaseType_t         count;
+
+    count = uxTaskGetSystemState(s_task_status, CPU_LOAD_MAX_TASKS, &total);
+    window = total - s_prev_total;
+
+    (void)memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.total = 10000U;
+    for (UBaseType_t i = 0U; i < count; i++)
+    {
+        const TaskStatus_t *task = &s_task_status[i];
+        uint16_t            load = load_of(
+            task->ulRunTimeCounter - prev_run_time(task->xHandle), window);
+
+        (void)strncpy(snapshot.tasks[i].name, task->pcTaskName,
+                      sizeof(snapshot.tasks[i].name) - 1U);
+        snapshot.tasks[i].load       = load;
+        snapshot.tasks[i].stack_free = (uint16_t)task->usStackHighWaterMark;
+        if (task->xHandle == idle)
+        {
+            snapshot.total = (uint16_t)(10000U - load);
+        }
+    }
+    snapshot.task_count = (uint16_t)count;
+
+    for (uint32_t i = 0U; i < (uint32_t)BSP_ISR_COUNT; i++)
+    {
+        uint64_t cycles = BSP_ISR_GetCycles((bsp_isr_t)i);
+
+        snapshot.isr[i] = load_of(cycles - s_prev_isr[i], window);
+        s_prev_isr[i]   = cycles;
+    }
+
+    for (UBaseType_t i = 0U; i < count; i++)
+    {
+        s_prev_handle[i]   = s_task_status[i].xHandle;
+        s_prev_run_time[i] = s_task_status[i].ulRunTimeCounter;
+    }
+    s_prev_count = count;
+    s_prev_total = total;
+
+    if (s_started)
+    {
+        taskENTER_CRITICAL();
+        s_snapshot = snapshot;
+        taskEXIT_CRITICAL();
+    }
+    s_started = true;
+}
+
+void cpu_load_get(cpu_load_snapshot_t *snapshot)
+{
+    taskENTER_CRITICAL();
+    *snapshot = s_snapshot;
+    taskEXIT_CRITICAL();
+}
+
+void cpu_load_print(void)
+{
+    cpu_load_snapshot_t snapshot;
+
+    cpu_load_get(&snapshot);
+
+    (void)printf("\n=== CPU Load ===\n");
+    (void)printf("Task Name       Load (%%)\n");
+    (void)printf("------------------------------------------------\n");
+    for (uint16_t i = 0U; i < snapshot.task_count; i++)
+    {
+        (void)printf("%-15s %3u.%02u\n", snapshot.tasks[i].name,
+                     (unsigned int)(snapshot.tasks[i].load / 100U),
+                     (unsigned int)(snapshot.tasks[i].load % 100U));
+    }
+    (void)printf("------------------------------------------------\n");
+    (void)printf("%-15s %3u.%02u\n", "Total",
+                 (unsigned int)(snapshot.total / 100U),
+                 (unsigned int)(snapshot.total % 100U));
+    (void)printf("%-15s %3u.%02u\n", "ISR ADC1 DMA",
+                 (unsigned int)(snapshot.isr[BSP_ISR_ADC1_DMA] / 100U),
+                 (unsigned int)(snapshot.isr[BSP_ISR_ADC1_DMA] % 100U));
+    (void)printf("%-15s %3u.%02u\n", "ISR ETH",
+                 (unsigned int)(snapshot.isr[BSP_ISR_ETH] / 100U),
+                 (unsigned int)(snapshot.isr[BSP_ISR_ETH] % 100U));
+    (void)printf("================================================\n\n");
+}
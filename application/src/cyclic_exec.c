@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Cyclic Executive
+ *
+ * The block hook stamps the release and gives the executive a
+ * notification, so a count above one on waking means frames passed
+ * unserved. Each job keeps a countdown to its next release; a wake that
+ * spans several frames runs the job once and counts the releases it
+ * covered beyond the first as overruns. The timing is written by the
+ * executive only and read by the monitor a word at a time, so a snapshot
+ * may mix two frames but never tears a figure. See cyclic_exec.h.
+ */
+
+#include "cyclic_exec.h"
+
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "adc_capture.h"
+#include "adc_filter_coefficients.h"
+#include "app_tasks.h"
+#include "bsp.h"
+#include "can_publish.h"
+#include "live_data.h"
+#include "nor_log.h"
+#include "spectrum.h"
+#include "supervisor.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Entry of the job table
+ */
+typedef struct
+{
+    const char *name;   /**< Job name */
+    void (*run)(void);  /**< Runs the job for one release */
+    uint8_t     period; /**< Frames between releases */
+    uint8_t     phase;  /**< Frame of the first release */
+} cyclic_job_t;
+
+/**
+ * @brief Run-time state of a job (executive only)
+ */
+typedef struct
+{
+    uint32_t countdown;          /**< Frames to the next release, 1 = next */
+    uint32_t runs;               /**< Times run */
+    uint32_t overruns;           /**< Releases missed or overrun */
+    uint32_t max_latency_cycles; /**< Longest release to start */
+    uint32_t max_run_cycles;     /**< Longest run */
+} cyclic_timing_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** The jobs, run in this order within a frame */
+static const cyclic_job_t s_jobs[] = {
+    {"AdcCapture", adc_capture_job, 1U, 0U},
+    {"CanPub", can_publish_job, 1U, 0U},
+    {"SpecCollect", spectrum_collect_job, 2U, 1U},
+#if BSP_SPINOR_ENABLE
+    {"NorLog", nor_log_job, 4U, 3U},
+#endif
+#if HTTP_SERVER
+    {"LiveData", live_data_job, 4U, 2U},
+#endif
+};
+
+#define CYCLIC_JOB_COUNT (sizeof(s_jobs) / sizeof(s_jobs[0]))
+
+/** Timing of the jobs, by table index */
+static cyclic_timing_t s_timing[CYCLIC_JOB_COUNT];
+
+/** Executive task, notified for every frame */
+static TaskHandle_t volatile s_executive = NULL;
+
+/** Cycle counter at the last release */
+static volatile uint32_t s_release_cycles;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Cycles of one frame
+ */
+static uint32_t frame_cycles(void)
+{
+    return (uint32_t)(((uint64_t)BSP_ADC1_BLOCK_SAMPLES *
+                       BSP_CycleCounter_Hz()) /
+                      ADC_FILTER_SAMPLE_RATE);
+}
+
+/**
+ * @brief Microseconds of a cycle count
+ */
+static uint32_t cycles_to_us(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000000U) / BSP_CycleCounter_Hz());
+}
+
+/**
+ * @brief Run the jobs released within the frames past
+ *
+ * @param[in] frames  Frames since the last call, at least 1
+ * @param[in] release Cycle counter at the release of the last of them
+ */
+static void cyclic_run_frame(uint32_t frames, uint32_t release)
+{
+    uint32_t frame = frame_cycles();
+
+    for (uint32_t i = 0U; i < CYCLIC_JOB_COUNT; i++)
+    {
+        const cyclic_job_t *job    = &s_jobs[i];
+        cyclic_timing_t    *timing = &s_timing[i];
+        uint32_t            released;
+        uint32_t            start;
+        uint32_t            run;
+
+        if (frames < timing->countdown)
+        {
+            timing->countdown -= frames;
+            continue;
+        }
+
+        /* The first release in the span and every period after it */
+        released          = 1U + ((frames - timing->countdown) / job->period);
+        timing->countdown = job->period -
+                            ((frames - timing->countdown) % job->period);
+
+        start = BSP_CycleCounter_Read();
+        job->run();
+        run = BSP_CycleCounter_Read() - start;
+
+        timing->runs++;
+        timing->overruns += released - 1U;
+        if (run > (frame * job->period))
+        {
+            timing->overruns++;
+        }
+        if ((start - release) > timing->max_latency_cycles)
+        {
+            timing->max_latency_cycles = start - release;
+        }
+        if (run > timing->max_run_cycles)
+        {
+            timing->max_run_cycles = run;
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void cyclic_exec_release(void)
+{
+    TaskHandle_t executive = s_executive;
+
+    s_release_cycles = BSP_CycleCounter_Read();
+
+    if (executive != NULL)
+    {
+        xTaskNotifyGive(executive);
+    }
+}
+
+bool cyclic_exec_get_stats(uint32_t index, cyclic_job_stats_t *stats)
+{
+    if (index >= CYCLIC_JOB_COUNT)
+    {
+        return false;
+    }
+
+    stats->name           = s_jobs[index].name;
+    stats->period         = s_jobs[index].period;
+    stats->phase          = s_jobs[index].phase;
+    stats->runs           = s_timing[index].runs;
+    stats->overruns       = s_timing[index].overruns;
+    stats->max_latency_us = cycles_to_us(s_timing[index].max_latency_cycles);
+    stats->max_run_us     = cycles_to_us(s_timing[index].max_run_cycles);
+
+    return true;
+}
+
+void cyclic_exec_print(void)
+{
+    cyclic_job_stats_t stats;
+
+    (void)printf("\n=== Cyclic Executive ===\n");
+    (void)printf("Job          Period Phase       Runs  Overruns  "
+                 "Latency(us)  Run(us)\n");
+    (void)printf("------------------------------------------------"
+                 "----------------------\n");
+    for (uint32_t i = 0U; cyclic_exec_get_stats(i, &stats); i++)
+    {
+        (void)printf("%-12s %6u %5u %10lu %9lu %12lu %8lu\n", stats.name,
+                     (unsigned int)stats.period, (unsigned int)stats.phase,
+                     (unsigned long)stats.runs, (unsigned long)stats.overruns,
+                     (unsigned long)stats.max_latency_us,
+                     (unsigned long)stats.max_run_us);
+    }
+    (void)printf("================================================"
+                 "======================\n\n");
+}
+
+/**
+ * @brief Cyclic executive task
+ */
+void vCyclicTask(void *pvParameters)
+{
+    /* Up to an idle frame apart, so the deadline allows a late one */
+    supervisor_id_t heartbeat = supervisor_register(
+        "Cyclic", 3U, (5U * CYCLIC_IDLE_FRAME_MS) / 2U);
+
+    (void)pvParameters;
+
+    for (uint32_t i = 0U; i < CYCLIC_JOB_COUNT; i++)
+    {
+        configASSERT(s_jobs[i].phase < s_jobs[i].period);
+        s_timing[i].countdown = (uint32_t)s_jobs[i].phase + 1U;
+    }
+
+    s_executive = xTaskGetCurrentTaskHandle();
+
+    printf("Cyclic executive task started\n");
+
+    for (;;)
+    {
+        uint32_t frames =
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CYCLIC_IDLE_FRAME_MS));
+        uint32_t release = s_release_cycles;
+
+        /* No block came: the acquisition is stopped, this is an idle frame */
+        if (frames == 0U)
+        {
+            frames  = 1U;
+            release = BSP_CycleCounter_Read();
+        }
+
+        cyclic_run_frame(frames, release);
+        supervisor_checkin(heartbeat);
+    }
+}
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Scheduled Digital Outputs
+ *
+ * The queue is an array kept in time order, shared between the tasks that
+ * queue commands and the executor and guarded by a critical section; an
+ * insertion moves at most DO_SCHEDULE_QUEUE_LENGTH entries. The executor
+ * is woken on notification index 0 whenever the queue changes, so a
+ * command due sooner than the one it sleeps for is not missed. The expander
+ * transfer and the counters belong to the executor; the status is
+ * published in one critical section per write. See do_schedule.h.
+ */
+
+#include "do_schedule.h"
+
+#include "FreeRTOS.h"
+#include "app_tasks.h"
+#include "bsp.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Nanoseconds per tick */
+#define DO_SCHEDULE_NS_PER_TICK (1000000000ULL / configTICK_RATE_HZ)
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One queued command
+ */
+typedef struct
+{
+    uint64_t time_ns; /**< PTP system time to apply it at */
+    uint16_t mask;    /**< Outputs to change */
+    uint16_t value;   /**< New states of the outputs in mask */
+} do_schedule_entry_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Pending commands, soonest first, guarded by a critical section */
+static do_schedule_entry_t s_queue[DO_SCHEDULE_QUEUE_LENGTH];
+
+/** Entries of s_queue in use, guarded by a critical section */
+static uint32_t s_pending;
+
+/** Executor, set once it runs */
+static TaskHandle_t s_task;
+
+/** Counters, guarded by a critical section; written by the executor only */
+static do_schedule_status_t s_status;
+
+/** Expander transfer of the executor */
+static bsp_i2cdo_xfer_t s_xfer;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Wake the executor to look at the queue again
+ */
+static void do_schedule_notify(void)
+{
+    TaskHandle_t task = s_task;
+
+    if (task != NULL)
+    {
+        (void)xTaskNotifyGive(task);
+    }
+}
+
+/**
+ * @brief Take every command due by a time off the queue
+ *
+ * @param[in]  now_ns  PTP system time
+ * @param[out] time_ns Time the first of them was due
+ * @param[out] mask    Outputs the commands change
+ * @param[out] value   Their states, the command queued last winning
+ * @return Number of commands taken
+ */
+static uint32_t do_schedule_take_due(uint64_t now_ns, uint64_t *time_ns,
+                                     uint16_t *mask, uint16_t *value)
+{
+    uint32_t due = 0U;
+
+    *mask  = 0U;
+    *value = 0U;
+
+    taskENTER_CRITICAL();
+    *time_ns = s_queue[0].time_ns;
+    while ((due < s_pending) && (s_queue[due].time_ns <= now_ns))
+    {
+        *value = (uint16_t)((*value & (uint16_t)~s_queue[due].mask) |
+                            (s_queue[due].value & s_queue[due].mask));
+        *mask |= s_queue[due].mask;
+        due++;
+    }
+    for (uint32_t i = due; i < s_pending; i++)
+    {
+        s_queue[i - due] = s_queue[i];
+    }
+    s_pending -= due;
+    taskEXIT_CRITICAL();
+
+    return due;
+}
+
+/**
+ * @brief Write the outputs of the commands due
+ *
+ * The change is staged again before each attempt: a failed Modbus write
+ * in flight discards whatever was staged with it.
+ *
+ * @param[in] time_ns Time the commands were due
+ * @param[in] mask    Outputs to change
+ * @param[in] value   New states of the outputs in @p mask
+ * @param[in] count   Commands applied with the write
+ */
+static void do_schedule_apply(uint64_t time_ns, uint16_t mask, uint16_t value,
+                              uint32_t count)
+{
+    TickType_t  start = xTaskGetTickCount();
+    uint64_t    started_ns;
+    uint64_t    latency_ns;
+    bsp_error_t err;
+
+    do
+    {
+        (void)BSP_I2CDO_Stage(mask, value);
+        err = BSP_I2CDO_CommitAsync(&s_xfer);
+        /* The bus is busy for one write, about 0.2 ms at 100 kHz */
+    } while ((err == BSP_BUSY) && ((xTaskGetTickCount() - start) <
+                                   pdMS_TO_TICKS(BSP_I2CDO_TIMEOUT)));
+    started_ns = BSP_Time_NowNs();
+
+    if (err == BSP_OK)
+    {
+        err = BSP_I2CDO_Wait(&s_xfer, BSP_I2CDO_TIMEOUT);
+    }
+    if (err != BSP_OK)
+    {
+        BSP_I2CDO_Discard();
+    }
+
+    latency_ns = (started_ns > time_ns) ? (started_ns - time_ns) : 0U;
+
+    taskENTER_CRITICAL();
+    if (err == BSP_OK)
+    {
+        s_status.executed += count;
+        s_status.latency_ns = (latency_ns > UINT32_MAX) ? UINT32_MAX
+                                                        : (uint32_t)latency_ns;
+    }
+    else
+    {
+        s_status.failed += count;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Put a command into the queue, in time order
+ *
+ * @param[in] time_ns PTP system time to apply it at, ns
+ * @param[in] mask    Outputs to change
+ * @param[in] value   New states of the outputs in @p mask
+ * @return DO_SCHEDULE_OK if the command was queued
+ */
+static do_schedule_result_t do_schedule_insert(uint64_t time_ns,
+                                               uint16_t mask, uint16_t value)
+{
+    uint32_t at;
+
+    taskENTER_CRITICAL();
+    if (s_pending >= DO_SCHEDULE_QUEUE_LENGTH)
+    {
+        taskEXIT_CRITICAL();
+        return DO_SCHEDULE_FULL;
+    }
+
+    /* After the commands due at the same time */
+    at = s_pending;
+    while ((at > 0U) && (s_queue[at - 1U].time_ns > time_ns))
+    {
+        s_queue[at] = s_queue[at - 1U];
+        at--;
+    }
+    s_queue[at] = (do_schedule_entry_t){time_ns, mask, value};
+    s_pending++;
+    taskEXIT_CRITICAL();
+
+    do_schedule_notify();
+
+    return DO_SCHEDULE_OK;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+do_schedule_result_t do_schedule_add(uint64_t time_ns, uint16_t mask,
+                                     uint16_t value)
+{
+    if (time_ns <= BSP_Time_NowNs())
+    {
+        return DO_SCHEDULE_PAST;
+    }
+
+    return do_schedule_insert(time_ns, mask, value);
+}
+
+do_schedule_result_t do_schedule_write(uint16_t mask, uint16_t value)
+{
+    return do_schedule_insert(BSP_Time_NowNs(), mask, value);
+}
+
+void do_schedule_cancel(void)
+{
+    taskENTER_CRITICAL();
+    s_pending = 0U;
+    taskEXIT_CRITICAL();
+
+    do_schedule_notify();
+}
+
+void do_schedule_get_status(do_schedule_status_t *status)
+{
+    if (status == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *status         = s_status;
+    status->pending = (uint16_t)s_pending;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Executor task
+ *
+ * Sleeps on notification index 0 until the next command is near, then on
+ * the capture timer until it is due.
+ */
+void vDoScheduleTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    s_task = xTaskGetCurrentTaskHandle();
+
+    for (;;)
+    {
+        uint64_t   next_ns;
+        uint64_t   now_ns;
+        TickType_t sleep = portMAX_DELAY;
+        uint16_t   mask;
+        uint16_t   value;
+        uint32_t   due;
+
+        taskENTER_CRITICAL();
+        next_ns = (s_pending > 0U) ? s_queue[0].time_ns : UINT64_MAX;
+        taskEXIT_CRITICAL();
+
+        now_ns = BSP_Time_NowNs();
+        if (next_ns != UINT64_MAX)
+        {
+            sleep = 0U;
+            if ((next_ns > now_ns) &&
+                ((next_ns - now_ns) > DO_SCHEDULE_LEAD_NS))
+            {
+                uint64_t ticks =
+                    (next_ns - now_ns - DO_SCHEDULE_LEAD_NS) /
+                    DO_SCHEDULE_NS_PER_TICK;
+
+                sleep = (ticks > pdMS_TO_TICKS(DO_SCHEDULE_MAX_SLEEP_MS))
+                            ? pdMS_TO_TICKS(DO_SCHEDULE_MAX_SLEEP_MS)
+                            : (TickType_t)ticks;
+            }
+        }
+
+        if (sleep != 0U)
+        {
+            /* Woken early when the queue changes */
+            (void)ulTaskNotifyTake(pdTRUE, sleep);
+            continue;
+        }
+
+        /* Within the lead: wait for the time itself */
+        if (BSP_Time_SleepUntilNs(next_ns) != BSP_OK)
+        {
+            /* No time base: never spin above every other task */
+            vTaskDelay(1U);
+        }
+
+        due = do_schedule_take_due(BSP_Time_NowNs(), &next_ns, &mask, &value);
+        if (due > 0U)
+        {
+            do_schedule_apply(next_ns, mask, value, due);
+        }
+    }
+}
@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * FOTA Payload Decoder
+ *
+ * A patch is decoded as it arrives by a small state machine, since its
+ * commands straddle segments: ADD bytes are copied from the segment and
+ * COPY bytes from the base image. A compressed image is decoded the same
+ * way; its matches are copied from the buffer being filled or the one
+ * before it, which the output only gives back once the next one is full,
+ * which is why the window is a chunk. Either way the image bytes take the
+ * same path through the chunk buffers as a full image. The formats are
+ * described in fota_task.h.
+ */
+
+#include "fota_decode.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+_Static_assert(FOTA_LZ_WINDOW <= FOTA_CHUNK_SIZE,
+               "matches must stay within the chunk buffers");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Patch decoder state, what the next patch byte belongs to
+ */
+typedef enum
+{
+    FOTA_DELTA_COMMAND = 0, /**< Command varint */
+    FOTA_DELTA_OFFSET,      /**< COPY distance varint */
+    FOTA_DELTA_ADD          /**< ADD literal bytes */
+} fota_delta_state_t;
+
+/**
+ * @brief Decompressor state, what the next stream byte belongs to
+ */
+typedef enum
+{
+    FOTA_LZ_TOKEN = 0,      /**< Sequence token */
+    FOTA_LZ_LITERAL_LENGTH, /**< Literal length continuation */
+    FOTA_LZ_LITERALS,       /**< Literal bytes */
+    FOTA_LZ_DISTANCE_LOW,   /**< Match distance, low byte */
+    FOTA_LZ_DISTANCE_HIGH,  /**< Match distance, high byte */
+    FOTA_LZ_MATCH_LENGTH    /**< Match length continuation */
+} fota_lz_state_t;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Hand the active buffer to the output and switch to the other one
+ */
+static fota_status_t fota_output(fota_decode_t *decode)
+{
+    fota_status_t status =
+        decode->output(decode->context,
+                       (uint8_t *)decode->chunk[decode->active], decode->fill);
+
+    decode->fill   = 0U;
+    decode->active = (uint8_t)(decode->active ^ 1U);
+
+    return status;
+}
+
+/**
+ * @brief Append image bytes to the chunk buffers, writing full ones
+ */
+static fota_status_t fota_emit(fota_decode_t *decode, const uint8_t *data,
+                               uint32_t length)
+{
+    fota_status_t status = FOTA_STATUS_OK;
+
+    while ((status == FOTA_STATUS_OK) && (length > 0U))
+    {
+        uint32_t n = FOTA_CHUNK_SIZE - decode->fill;
+
+        if (n > length)
+        {
+            n = length;
+        }
+        (void)memcpy((uint8_t *)decode->chunk[decode->active] + decode->fill,
+                     data, n);
+        decode->fill += n;
+        decode->received += n;
+        data += n;
+        length -= n;
+
+        if (decode->fill == FOTA_CHUNK_SIZE)
+        {
+            status = fota_output(decode);
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Read one byte of a varint
+ * @return true once the varint is complete in decode->varint
+ */
+static bool fota_varint(fota_decode_t *decode, uint8_t byte)
+{
+    if (decode->shift == 0U)
+    {
+        decode->varint = 0U;
+    }
+    decode->varint |= (uint32_t)(byte & 0x7FU) << decode->shift;
+
+    if ((byte & 0x80U) != 0U)
+    {
+        decode->shift = (uint8_t)(decode->shift + 7U);
+        return false;
+    }
+
+    decode->shift = 0U;
+    return true;
+}
+
+/**
+ * @brief Run the patch commands of one received segment
+ *
+ * Commands that reach past the new or the base image are refused before
+ * any of their bytes are written.
+ */
+static fota_status_t fota_delta_take(fota_decode_t *decode,
+                                     const uint8_t *data, uint32_t length)
+{
+    fota_status_t status = FOTA_STATUS_OK;
+
+    /* Bytes past the image are ignored */
+    while ((status == FOTA_STATUS_OK) && (length > 0U) &&
+           (decode->received < decode->image_size))
+    {
+        uint8_t byte = *data;
+
+        if (decode->state == (uint8_t)FOTA_DELTA_ADD)
+        {
+            uint32_t n = decode->pending;
+
+            if (n > length)
+            {
+                n = length;
+            }
+            status = fota_emit(decode, data, n);
+            decode->pending -= n;
+            data += n;
+            length -= n;
+            if (decode->pending == 0U)
+            {
+                decode->state = (uint8_t)FOTA_DELTA_COMMAND;
+            }
+            continue;
+        }
+
+        data++;
+        length--;
+
+        /* 32 bits fit five varint bytes, the fifth holding four */
+        if ((decode->shift == 28U) && (byte > 0x0FU))
+        {
+            status = FOTA_STATUS_BAD_PATCH;
+        }
+        else if (!fota_varint(decode, byte))
+        {
+            /* More varint bytes to come */
+        }
+        else if (decode->state == (uint8_t)FOTA_DELTA_COMMAND)
+        {
+            decode->pending = decode->varint >> 1;
+            if ((decode->pending == 0U) ||
+                (decode->pending >
+                 (decode->image_size - decode->received)))
+            {
+                status = FOTA_STATUS_BAD_PATCH;
+            }
+            else
+            {
+                decode->state = ((decode->varint & 1U) != 0U)
+                                      ? (uint8_t)FOTA_DELTA_OFFSET
+                                      : (uint8_t)FOTA_DELTA_ADD;
+            }
+        }
+        else
+        {
+            /* Zigzag: bit 0 is the sign */
+            int64_t source =
+                (int64_t)decode->copy_end +
+                (int64_t)((int32_t)(decode->varint >> 1) ^
+                          -(int32_t)(decode->varint & 1U));
+
+            if ((source < 0) ||
+                ((source + (int64_t)decode->pending) >
+                 (int64_t)decode->base_size))
+            {
+                status = FOTA_STATUS_BAD_PATCH;
+            }
+            else
+            {
+                status = fota_emit(decode, decode->base + (uint32_t)source,
+                                   decode->pending);
+                decode->copy_end = (uint32_t)source + decode->pending;
+                decode->state    = (uint8_t)FOTA_DELTA_COMMAND;
+            }
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Copy a match from the data still in the chunk buffers
+ *
+ * The bytes before the active buffer are the end of the other one, which
+ * the output may still be using but which is only refilled after the next
+ * output. Each copy stops at the end of its source and of the active
+ * buffer, which also keeps an overlapping match from reading bytes it has
+ * not written yet.
+ */
+static fota_status_t fota_lz_match(fota_decode_t *decode)
+{
+    fota_status_t status = FOTA_STATUS_OK;
+
+    while ((status == FOTA_STATUS_OK) && (decode->match > 0U))
+    {
+        const uint8_t *source;
+        uint32_t       n;
+
+        if (decode->distance <= decode->fill)
+        {
+            source = (const uint8_t *)decode->chunk[decode->active] +
+                     (decode->fill - decode->distance);
+            n      = decode->distance;
+        }
+        else
+        {
+            n      = decode->distance - decode->fill;
+            source = (const uint8_t *)decode->chunk[decode->active ^ 1U] +
+                     (FOTA_CHUNK_SIZE - n);
+        }
+        if (n > decode->match)
+        {
+            n = decode->match;
+        }
+        if (n > (FOTA_CHUNK_SIZE - decode->fill))
+        {
+            n = FOTA_CHUNK_SIZE - decode->fill;
+        }
+
+        status = fota_emit(decode, source, n);
+        decode->match -= n;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Read one length continuation byte
+ * @return true once the length is complete
+ */
+static bool fota_lz_length(uint32_t *length, uint8_t byte)
+{
+    *length += byte;
+    return byte != 0xFFU;
+}
+
+/**
+ * @brief Decompress one received segment
+ *
+ * Lengths that reach past the image and distances before its start or
+ * beyond the window are refused before any of their bytes are written.
+ */
+static fota_status_t fota_lz_take(fota_decode_t *decode,
+                                  const uint8_t *data, uint32_t length)
+{
+    fota_status_t status = FOTA_STATUS_OK;
+
+    /* Bytes past the image are ignored */
+    while ((status == FOTA_STATUS_OK) && (length > 0U) &&
+           (decode->received < decode->image_size))
+    {
+        uint32_t left = decode->image_size - decode->received;
+        uint8_t  byte = *data;
+        bool     done = false;
+
+        if (decode->state == (uint8_t)FOTA_LZ_LITERALS)
+        {
+            uint32_t n = decode->pending;
+
+            if (n > length)
+            {
+                n = length;
+            }
+            status = fota_emit(decode, data, n);
+            decode->pending -= n;
+            data += n;
+            length -= n;
+            if ((decode->pending == 0U) &&
+                (decode->received < decode->image_size))
+            {
+                decode->state = (uint8_t)FOTA_LZ_DISTANCE_LOW;
+            }
+            continue;
+        }
+
+        data++;
+        length--;
+
+        switch ((fota_lz_state_t)decode->state)
+        {
+            case FOTA_LZ_TOKEN:
+                decode->pending = (uint32_t)byte >> 4;
+                decode->match   = (uint32_t)(byte & 0x0FU);
+                done              = (decode->pending != 15U);
+                decode->state   = (uint8_t)FOTA_LZ_LITERAL_LENGTH;
+                break;
+            case FOTA_LZ_LITERAL_LENGTH:
+                done = fota_lz_length(&decode->pending, byte);
+                break;
+            case FOTA_LZ_DISTANCE_LOW:
+                decode->distance = byte;
+                decode->state    = (uint8_t)FOTA_LZ_DISTANCE_HIGH;
+                break;
+            case FOTA_LZ_DISTANCE_HIGH:
+                decode->distance |= (uint32_t)byte << 8;
+                if ((decode->distance == 0U) ||
+                    (decode->distance > FOTA_LZ_WINDOW) ||
+                    (decode->distance > decode->received))
+                {
+                    status = FOTA_STATUS_BAD_PATCH;
+                }
+                done            = (decode->match != 15U);
+                decode->state = (uint8_t)FOTA_LZ_MATCH_LENGTH;
+                break;
+            case FOTA_LZ_MATCH_LENGTH:
+                done = fota_lz_length(&decode->match, byte);
+                break;
+            default:
+                status = FOTA_STATUS_BAD_PATCH;
+                break;
+        }
+
+        /* A length grows past the image well before it can wrap */
+        if (((decode->state == (uint8_t)FOTA_LZ_LITERAL_LENGTH) &&
+             (decode->pending > left)) ||
+            ((decode->state == (uint8_t)FOTA_LZ_MATCH_LENGTH) &&
+             ((decode->match + 4U) > left)))
+        {
+            status = FOTA_STATUS_BAD_PATCH;
+        }
+        if ((status != FOTA_STATUS_OK) || !done)
+        {
+            continue;
+        }
+
+        if (decode->state == (uint8_t)FOTA_LZ_LITERAL_LENGTH)
+        {
+            /* A sequence may have no literals */
+            decode->state = (decode->pending > 0U)
+                                  ? (uint8_t)FOTA_LZ_LITERALS
+                                  : (uint8_t)FOTA_LZ_DISTANCE_LOW;
+        }
+        else
+        {
+            decode->match += 4U;
+            decode->state = (uint8_t)FOTA_LZ_TOKEN;
+            status          = fota_lz_match(decode);
+        }
+    }
+
+    return status;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+/* Four bits at a time from a 16-entry table: the base image is only
+ * checked once per update, so a few milliseconds per megabyte are not
+ * worth a 1 KiB table */
+uint32_t fota_crc32(const uint8_t *data, uint32_t length)
+{
+    static const uint32_t table[16] = {
+        0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+        0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+        0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+        0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU};
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (uint32_t i = 0U; i < length; i++)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0FU];
+        crc = (crc >> 4) ^ table[crc & 0x0FU];
+    }
+
+    return crc ^ 0xFFFFFFFFU;
+}
+
+void fota_decode_init(fota_decode_t *decode, fota_payload_t type,
+                      uint32_t image_size, fota_decode_output_t output,
+                      void *context)
+{
+    (void)memset(decode, 0, sizeof(*decode));
+    decode->type       = (uint8_t)type;
+    decode->image_size = image_size;
+    decode->output     = output;
+    decode->context    = context;
+}
+
+fota_status_t fota_decode_base(fota_decode_t *decode, const uint8_t *base,
+                               uint32_t base_size, uint32_t base_crc)
+{
+    if (base_size == 0U)
+    {
+        return FOTA_STATUS_BAD_HEADER;
+    }
+    if (fota_crc32(base, base_size) != base_crc)
+    {
+        return FOTA_STATUS_BAD_BASE;
+    }
+
+    decode->base      = base;
+    decode->base_size = base_size;
+
+    return FOTA_STATUS_OK;
+}
+
+void fota_decode_resume(fota_decode_t *decode, uint32_t received)
+{
+    decode->received = received;
+}
+
+fota_status_t fota_decode_take(fota_decode_t *decode, const uint8_t *data,
+                               uint32_t length)
+{
+    if (decode->type == (uint8_t)FOTA_PAYLOAD_DELTA)
+    {
+        return fota_delta_take(decode, data, length);
+    }
+    if (decode->type == (uint8_t)FOTA_PAYLOAD_LZ)
+    {
+        return fota_lz_take(decode, data, length);
+    }
+
+    /* Bytes past the image are ignored */
+    if (length > (decode->image_size - decode->received))
+    {
+        length = decode->image_size - decode->received;
+    }
+
+    return fota_emit(decode, data, length);
+}
+
+fota_status_t fota_decode_finish(fota_decode_t *decode)
+{
+    if (decode->fill == 0U)
+    {
+        return FOTA_STATUS_OK;
+    }
+
+    return fota_output(decode);
+}
@@ -1,26 +1,576 @@
 /*
  * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
  * All rights reserved.
+ *
+ * FOTA Task
+ *
+ * The update image is streamed from the TCP connection into the inactive
+ * flash bank. Received segments are copied into one of two chunk buffers;
+ * once a buffer is full it is handed to BSP_Flash_WriteAsync() and to
+ * BSP_Verify_Update(), and the next segments fill the other buffer while
+ * the flash interrupt programs the first and the secure world hashes it. A
+ * buffer is only filled again after both have finished with it, so at most
+ * one chunk is in flight and RAM use does not depend on the image size.
+ *
+ * The chunk buffers are those of the payload decoder (fota_decode.h),
+ * which applies a patch on top of the running image, mapped at
+ * BSP_FLASH_APP_BASE while the other bank is programmed, and decompresses
+ * a compressed image from the buffer being filled and the one before it,
+ * still held while the flash programs it. The decoding of one chunk thus
+ * overlaps the programming of the last.
+ *
+ * The progress of a full image is saved from fota_flush(), right after
+ * the wait that ends the write before, so everything below the offset
+ * saved is programmed. The offsets are whole sectors: the write that
+ * resumes at one erases the sector, whatever a cut transfer left in it.
+ * The wire format is described in fota_task.h.
  */
 
+#include "fota_task.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
 #include "FreeRTOS.h"
 #include "app_tasks.h"
+#include "boot.h"
+#include "bsp.h"
+#include "ethernetif.h"
+#include "fota_decode.h"
+#include "jerry_device_registers.h"
+#include "log.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "lwip/netbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "modbus_callbacks.h"
+#include "semphr.h"
 #include "task.h"
 
-#define CONST 10000
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Longest pause in the transfer before it is given up */
+#define FOTA_RECV_TIMEOUT_MS 5000
+
+/** Longest time one chunk may take to erase and program */
+#define FOTA_WRITE_TIMEOUT_MS 1000U
+
+/** Time left for the reply to leave before the banks are swapped */
+#define FOTA_SWAP_DELAY_MS 100U
+
+/** Longest wait for the register mutex to save the progress */
+#define FOTA_RESUME_LOCK_WAIT_MS 100U
+
+/** Slot bytes hashed per request when a transfer resumes */
+#define FOTA_RESUME_HASH_BLOCK (32U * 1024U)
+
+/** NonSecure RAM, where an image's initial stack pointer must lie */
+#define FOTA_RAM_START 0x20050000U
+#define FOTA_RAM_END   0x200A0000U
+
+_Static_assert((FOTA_CHUNK_SIZE % BSP_FLASH_WORD_SIZE) == 0U,
+               "chunks must be whole flash words");
+_Static_assert(((FOTA_RESUME_STEP % BSP_FLASH_SECTOR_SIZE) == 0U) &&
+                   ((FOTA_RESUME_STEP % FOTA_CHUNK_SIZE) == 0U),
+               "a resume must start a sector and a chunk");
+_Static_assert((BSP_FLASH_APP_SIZE / 1024U) <= UINT16_MAX,
+               "the progress must fit its register");
+_Static_assert((FOTA_SIGNATURE_OFFSET + BSP_VERIFY_SIGNATURE_SIZE) ==
+                   FOTA_HEADER_SIZE,
+               "signature must end the header");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief State of one transfer
+ */
+typedef struct
+{
+    uint8_t  header[FOTA_HEADER_SIZE]; /**< Header as received */
+    uint32_t header_length;            /**< Header bytes received */
+    uint32_t image_size;               /**< Image size from the header */
+    uint32_t written;                  /**< Image bytes handed to flash */
+    uint32_t payload;                  /**< Payload bytes received */
+    uint8_t  type;                     /**< Payload, fota_payload_t */
+    uint32_t tag;                      /**< Tag of the header and bank */
+    uint32_t saved;                    /**< Image bytes of the progress saved */
+    bool     resumable;                /**< Progress is saved */
+    bool     reply_start;              /**< Start reply not sent yet */
+
+    /** Payload decoder, with the chunk buffers */
+    fota_decode_t decode;
+} fota_transfer_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+static fota_transfer_t s_transfer;
+
+/** Register mutex, for saving the progress */
+static SemaphoreHandle_t volatile s_register_mutex;
+
+/** Progress held by the registers, written by their callback */
+static uint32_t s_resume_tag;
+static uint16_t s_resume_kib;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+static uint32_t fota_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static void fota_put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Save the progress of a transfer in its registers
+ *
+ * Written through the Modbus write callback under the register mutex, as
+ * a client write would be; the configuration store commits it shortly
+ * after. A progress not saved for want of the mutex is saved at the next
+ * step.
+ */
+static void fota_resume_save(uint32_t tag, uint32_t offset)
+{
+    SemaphoreHandle_t mutex = s_register_mutex;
+    uint16_t          words[3];
+
+    if ((mutex == NULL) ||
+        (xSemaphoreTake(mutex, pdMS_TO_TICKS(FOTA_RESUME_LOCK_WAIT_MS)) !=
+         pdTRUE))
+    {
+        return;
+    }
+
+    /* The write callback hands the values back to fota_resume_set() */
+    words[0] = (uint16_t)(tag >> 16);
+    words[1] = (uint16_t)tag;
+    words[2] = (uint16_t)(offset / 1024U);
+    (void)modbus_cb_write_multiple_registers(
+        JERRY_DEVICE_HR_FOTA_RESUME_TAG_HIGH, 3U, words);
 
-/* FOTA Task */
-void vFotaTask(void* pvParameters)
+    (void)xSemaphoreGive(mutex);
+}
+
+/**
+ * @brief Pick up a cut transfer of the same image where it stopped
+ *
+ * The slot up to the saved offset is hashed from the flash, then the
+ * transfer goes on as if those bytes had just been received. Without a
+ * matching progress, one left by another transfer is cleared, since this
+ * one overwrites the slot.
+ */
+static fota_status_t fota_resume(fota_transfer_t *transfer)
 {
+    uint32_t tag;
+    uint32_t offset;
+
+    taskENTER_CRITICAL();
+    tag    = s_resume_tag;
+    offset = (uint32_t)s_resume_kib * 1024U;
+    taskEXIT_CRITICAL();
+
+    if (!transfer->resumable || (tag != transfer->tag) || (offset == 0U) ||
+        ((offset % FOTA_RESUME_STEP) != 0U) ||
+        (offset >= transfer->image_size))
+    {
+        if (offset != 0U)
+        {
+            fota_resume_save(transfer->tag, 0U);
+        }
+        return FOTA_STATUS_OK;
+    }
+
+    for (uint32_t pos = 0U; pos < offset; pos += FOTA_RESUME_HASH_BLOCK)
+    {
+        uint32_t n = offset - pos;
+
+        if (n > FOTA_RESUME_HASH_BLOCK)
+        {
+            n = FOTA_RESUME_HASH_BLOCK;
+        }
+        if (BSP_Verify_Update((const void *)(BSP_FLASH_UPDATE_BASE + pos), n) !=
+            BSP_OK)
+        {
+            return FOTA_STATUS_VERIFY;
+        }
+    }
+
+    fota_decode_resume(&transfer->decode, offset);
+    transfer->written  = offset;
+    transfer->saved    = offset;
+    LOG("FOTA: Resuming at %u bytes\n", (unsigned int)offset);
+
+    return FOTA_STATUS_OK;
+}
+
+/**
+ * @brief Write and hash a chunk buffer, the output of the decoder
+ *
+ * The write and hash before them are waited for first, which also frees
+ * the buffer the decoder fills next. Only image bytes are hashed, not the
+ * padding.
+ */
+static fota_status_t fota_flush(void *context, uint8_t *chunk,
+                                uint32_t length)
+{
+    fota_transfer_t *transfer = (fota_transfer_t *)context;
+    uint32_t         padded   = length;
+    bsp_error_t      result;
+
+    /* Pad the last chunk to a whole flash word */
+    while ((padded % BSP_FLASH_WORD_SIZE) != 0U)
+    {
+        chunk[padded] = 0xFFU;
+        padded++;
+    }
+
+    /* A configuration store commit may take the flash in between */
+    do
+    {
+        result = BSP_Flash_Wait(FOTA_WRITE_TIMEOUT_MS);
+        if (result == BSP_OK)
+        {
+            result = BSP_Flash_WriteAsync(transfer->written, chunk, padded);
+        }
+    } while (result == BSP_BUSY);
+    if (result != BSP_OK)
+    {
+        return FOTA_STATUS_FLASH;
+    }
+    if (BSP_Verify_Update(chunk, length) != BSP_OK)
+    {
+        return FOTA_STATUS_VERIFY;
+    }
+
+    /* The wait above ended every write below this one */
+    if (transfer->resumable &&
+        ((transfer->written - transfer->saved) >= FOTA_RESUME_STEP))
+    {
+        transfer->saved = transfer->written -
+                          (transfer->written % FOTA_RESUME_STEP);
+        fota_resume_save(transfer->tag, transfer->saved);
+    }
+
+    transfer->written += padded;
+
+    return FOTA_STATUS_OK;
+}
+
+/**
+ * @brief Check the received header
+ * @return FOTA_STATUS_OK if an image of the given size can be taken
+ */
+static fota_status_t fota_check_header(fota_transfer_t *transfer)
+{
+    const uint8_t *h     = transfer->header;
+    uint16_t       magic = (uint16_t)(h[0] | ((uint16_t)h[1] << 8));
+
+    transfer->image_size = fota_get_u32(&h[4]);
+    transfer->type       = h[3];
+
+    /* The vector table alone is two words */
+    if ((magic != FOTA_MAGIC) || (h[2] < FOTA_VERSION_MIN) ||
+        (h[2] > FOTA_VERSION) ||
+        (transfer->image_size < 8U) ||
+        (transfer->image_size > BSP_FLASH_APP_SIZE) ||
+        (transfer->type > (uint8_t)FOTA_PAYLOAD_LZ))
+    {
+        return FOTA_STATUS_BAD_HEADER;
+    }
+
+    fota_decode_init(&transfer->decode, (fota_payload_t)transfer->type,
+                     transfer->image_size, fota_flush, transfer);
+
+    /* A patch only rebuilds the image from the one it was made from */
+    if (transfer->type == (uint8_t)FOTA_PAYLOAD_DELTA)
+    {
+        uint32_t      base_size = fota_get_u32(&h[FOTA_BASE_SIZE_OFFSET]);
+        fota_status_t status;
+
+        if (base_size > BSP_FLASH_APP_SIZE)
+        {
+            return FOTA_STATUS_BAD_HEADER;
+        }
+        status = fota_decode_base(&transfer->decode,
+                                  (const uint8_t *)BSP_FLASH_APP_BASE,
+                                  base_size,
+                                  fota_get_u32(&h[FOTA_BASE_CRC_OFFSET]));
+        if (status != FOTA_STATUS_OK)
+        {
+            return status;
+        }
+    }
+
+    if (BSP_Verify_Start() != BSP_OK)
+    {
+        return FOTA_STATUS_VERIFY;
+    }
+
+    /* The tag tells apart the same image sent to the other bank */
+    transfer->tag = (fota_crc32(h, FOTA_SIGNATURE_OFFSET) & ~1U) |
+                    (BSP_Flash_IsSwapped() ? 1U : 0U);
+    transfer->reply_start = (h[2] >= 3U);
+    transfer->resumable =
+        transfer->reply_start && (transfer->type == (uint8_t)FOTA_PAYLOAD_IMAGE);
+
+    return fota_resume(transfer);
+}
+
+/**
+ * @brief Take one received segment
+ */
+static fota_status_t fota_take(fota_transfer_t *transfer, const uint8_t *data,
+                               uint32_t length)
+{
+    fota_status_t status = FOTA_STATUS_OK;
+
+    /* The header may arrive split over segments */
+    if (transfer->header_length < FOTA_HEADER_SIZE)
+    {
+        uint32_t n = FOTA_HEADER_SIZE - transfer->header_length;
+
+        if (n > length)
+        {
+            n = length;
+        }
+        (void)memcpy(&transfer->header[transfer->header_length], data, n);
+        transfer->header_length += n;
+        data += n;
+        length -= n;
+
+        if (transfer->header_length < FOTA_HEADER_SIZE)
+        {
+            return FOTA_STATUS_OK;
+        }
+        status = fota_check_header(transfer);
+    }
+    if (status != FOTA_STATUS_OK)
+    {
+        return status;
+    }
+
+    transfer->payload += length;
+
+    return fota_decode_take(&transfer->decode, data, length);
+}
+
+/**
+ * @brief Check the written slot
+ *
+ * The digest is complete once the last chunk is hashed, so only the
+ * signature is left to check. After the swap the slot is mapped at
+ * BSP_FLASH_APP_BASE, where the image's vectors must point.
+ */
+static fota_status_t fota_verify(const fota_transfer_t *transfer)
+{
+    const uint32_t *vectors = (const uint32_t *)BSP_FLASH_UPDATE_BASE;
+    uint32_t        sp      = vectors[0];
+    uint32_t        reset   = vectors[1];
+
+    switch (BSP_Verify_Finish(&transfer->header[FOTA_SIGNATURE_OFFSET]))
+    {
+        case BSP_OK:
+            break;
+        case BSP_INVALID_ARG:
+            return FOTA_STATUS_BAD_SIGNATURE;
+        default:
+            return FOTA_STATUS_VERIFY;
+    }
+    if ((sp <= FOTA_RAM_START) || (sp > FOTA_RAM_END) || ((reset & 1U) == 0U) ||
+        (reset < BSP_FLASH_APP_BASE) ||
+        (reset >= (BSP_FLASH_APP_BASE + transfer->image_size)))
+    {
+        return FOTA_STATUS_BAD_IMAGE;
+    }
+
+    return FOTA_STATUS_OK;
+}
+
+static void fota_reply(struct netconn *conn, fota_status_t status,
+                       uint32_t written)
+{
+    uint8_t reply[FOTA_REPLY_SIZE] = {0};
+
+    reply[0] = (uint8_t)status;
+    fota_put_u32(&reply[4], written);
+    (void)netconn_write(conn, reply, sizeof(reply), NETCONN_COPY);
+}
+
+/**
+ * @brief Receive one image from a connection
+ */
+static fota_status_t fota_receive(struct netconn *conn,
+                                  fota_transfer_t *transfer)
+{
+    fota_status_t  status = FOTA_STATUS_OK;
+    struct netbuf *buf;
+
+    (void)memset(transfer, 0, sizeof(*transfer));
+
+    while ((status == FOTA_STATUS_OK) &&
+           ((transfer->header_length < FOTA_HEADER_SIZE) ||
+            (transfer->decode.received < transfer->image_size)))
+    {
+        void *data;
+        u16_t len;
+
+        if (netconn_recv(conn, &buf) != ERR_OK)
+        {
+            status = FOTA_STATUS_TIMEOUT;
+            break;
+        }
+        do
+        {
+            netbuf_data(buf, &data, &len);
+            status = fota_take(transfer, (const uint8_t *)data, len);
+        } while ((status == FOTA_STATUS_OK) && (netbuf_next(buf) >= 0));
+        netbuf_delete(buf);
+
+        /* The client sends the payload from the offset it is told */
+        if ((status == FOTA_STATUS_OK) && transfer->reply_start)
+        {
+            fota_reply(conn, FOTA_STATUS_OK, transfer->written);
+            transfer->reply_start = false;
+        }
+    }
+
+    if (status == FOTA_STATUS_OK)
+    {
+        status = fota_decode_finish(&transfer->decode);
+    }
+
+    /* Nothing may still be writing once the transfer has ended */
+    if ((BSP_Flash_Wait(FOTA_WRITE_TIMEOUT_MS) != BSP_OK) &&
+        (status == FOTA_STATUS_OK))
+    {
+        status = FOTA_STATUS_FLASH;
+    }
+
+    if (status == FOTA_STATUS_OK)
+    {
+        status = fota_verify(transfer);
+    }
+
+    /* A cut transfer resumes, a slot that fails its checks is sent again */
+    if ((status != FOTA_STATUS_OK) && (status != FOTA_STATUS_TIMEOUT) &&
+        (transfer->saved != 0U))
+    {
+        fota_resume_save(transfer->tag, 0U);
+    }
+
+    return status;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void fota_resume_set(uint32_t tag, uint16_t kib)
+{
+    taskENTER_CRITICAL();
+    s_resume_tag = tag;
+    s_resume_kib = kib;
+    taskEXIT_CRITICAL();
+}
+
+void fota_resume_start(SemaphoreHandle_t register_mutex)
+{
+    s_register_mutex = register_mutex;
+}
+
+/**
+ * @brief FOTA task
+ */
+void vFotaTask(void *pvParameters)
+{
+    struct netconn    *listen_conn;
+    struct netconn    *conn;
+    bsp_secure_bench_t bench;
+
     (void)pvParameters;
 
-    /* Initialize FOTA (Flash, Security, etc.) */
+    /* Wait for the network interface, as the Modbus task does, and for the
+     * saved progress */
+    (void)boot_wait(BOOT_EVENT_NETIF_UP | BOOT_EVENT_CONFIG, BOOT_WAIT_FOREVER);
+
+    while ((listen_conn = netconn_new(NETCONN_TCP)) == NULL)
+    {
+        printf("FOTA: Failed to create connection\n");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    if ((netconn_bind(listen_conn, IP_ADDR_ANY, FOTA_DEFAULT_PORT) != ERR_OK) ||
+        (netconn_listen_with_backlog(listen_conn, 1U) != ERR_OK))
+    {
+        printf("FOTA: Failed to listen on port %u\n", FOTA_DEFAULT_PORT);
+        netconn_delete(listen_conn);
+        vTaskDelete(NULL);
+    }
+
+    printf("FOTA server listening on port %u (bank %s)\n", FOTA_DEFAULT_PORT,
+           BSP_Flash_IsSwapped() ? "2" : "1");
+
+    if (BSP_Secure_Benchmark(&bench) == BSP_OK)
+    {
+        printf("Secure gateway: %u cycles per call, %u per request\n",
+               (unsigned int)bench.call_cycles,
+               (unsigned int)bench.request_cycles);
+    }
 
     for (;;)
     {
-        /* Check for updates */
-        /* Verify signature */
-        /* Write to dual bank */
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        fota_status_t status;
+
+        if (netconn_accept(listen_conn, &conn) != ERR_OK)
+        {
+            continue;
+        }
+
+        LOG("FOTA: Update started\n");
+
+        /* The image is bulk traffic, its ACKs must not delay Modbus */
+        LOCK_TCPIP_CORE();
+        if (conn->pcb.tcp != NULL)
+        {
+            conn->pcb.tcp->tos = ETHERNETIF_TOS_BULK;
+        }
+        UNLOCK_TCPIP_CORE();
+        netconn_set_recvtimeout(conn, FOTA_RECV_TIMEOUT_MS);
+        status = fota_receive(conn, &s_transfer);
+        fota_reply(conn, status, s_transfer.written);
+        netconn_close(conn);
+        netconn_delete(conn);
+
+        if (status != FOTA_STATUS_OK)
+        {
+            LOG("FOTA: Update failed, status %u after %u bytes\n",
+                (unsigned int)status,
+                (unsigned int)s_transfer.decode.received);
+            continue;
+        }
+
+        LOG("FOTA: %u bytes verified from %u received, swapping banks\n",
+            (unsigned int)s_transfer.image_size,
+            (unsigned int)s_transfer.payload);
+        vTaskDelay(pdMS_TO_TICKS(FOTA_SWAP_DELAY_MS));
+        (void)BSP_Flash_SwapBanks();
+        LOG("FOTA: Bank swap failed\n");
     }
 }
@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Tone Monitor
+ *
+ * The tone states, the window and the stream reader belong to the filter
+ * task. Only the configuration and the published results are shared, each
+ * copied in one short critical section.
+ *
+ * A Goertzel filter run over a whole window in single precision loses
+ * accuracy as the window grows, the more so the lower the tone is against
+ * the sample rate: 50 Hz over 1 s at 50 kHz reads half a percent low. So
+ * each ring read is a segment of its own: the filter starts from zero, and
+ * at the end of the segment its output is turned back to the window's
+ * first sample and added to the tone's sum. The turn is taken from the
+ * exact integer phase of the segment's last sample, so the segments join
+ * without drift, at one sine and cosine per tone per read. See goertzel.h.
+ */
+
+#include "goertzel.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_coefficients.h"
+#include "arm_math.h"
+#include "metrics.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Samples read from the stream at a time, one ADC block's worth */
+#define GOERTZEL_READ_BATCH BSP_ADC1_BLOCK_SAMPLES
+
+/** ADC reference in mV */
+#define GOERTZEL_VREF_MV 3300.0f
+
+/** Frequency register units per Hz */
+#define GOERTZEL_UNITS_PER_HZ 10U
+
+/** Register units per mV and per radian */
+#define GOERTZEL_UNITS_PER_MV  10.0f
+#define GOERTZEL_UNITS_PER_RAD (18000.0f / PI)
+
+/** Largest magnitude register value */
+#define GOERTZEL_REGISTER_MAX 65535.0f
+
+/** 2 pi, for the coefficients, worked out in double precision */
+#define GOERTZEL_TWO_PI 6.283185307179586
+
+/** Samples of the longest window */
+#define GOERTZEL_MAX_WINDOW_SAMPLES \
+    ((GOERTZEL_MAX_WINDOW_MS * ADC_FILTER_MAX_SAMPLE_RATE) / 1000U)
+
+_Static_assert(GOERTZEL_MAX_WINDOW_SAMPLES <=
+                   (UINT32_MAX / BSP_ADC1_FULL_SCALE),
+               "channel sums must fit 32 bits");
+_Static_assert(GOERTZEL_MAX_WINDOW_SAMPLES <= (UINT32_MAX / 0xFFFFU),
+               "segment phases must fit 32 bits");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/** Running state of one tone over the window */
+typedef struct
+{
+    float32_t coeff;     /**< 2 cos(w) */
+    float32_t cos_w;     /**< cos(w), for the segment output */
+    float32_t sin_w;     /**< sin(w), for the segment output */
+    float32_t re;        /**< Real part of the window sum */
+    float32_t im;        /**< Imaginary part of the window sum */
+    uint16_t  frequency; /**< Frequency, 0.1 Hz */
+    uint16_t  channel;   /**< ADC1 channel */
+    bool      active;    /**< Measured in this window */
+} goertzel_state_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Configuration, guarded by a critical section */
+static goertzel_config_t s_config = {GOERTZEL_DEFAULT_WINDOW_MS, {{0U, 0U}}};
+
+/* Filter task only */
+static goertzel_state_t  s_tones[GOERTZEL_TONES];
+static bsp_adc1_reader_t s_reader;        /**< Full-rate stream reader */
+static bool              s_attached;      /**< s_reader initialized */
+static bool              s_open;          /**< A window is being filled */
+static uint32_t          s_rate;          /**< Sample rate of the window */
+static uint32_t          s_period;        /**< Frequency units per cycle of
+                                               the sample clock */
+static uint32_t          s_window_samples; /**< Samples of the window */
+static uint32_t          s_fill;           /**< Samples taken in */
+static uint32_t          s_next_sequence;  /**< Sequence that continues it */
+static uint32_t          s_sum[BSP_ADC1_NUM_CHANNELS]; /**< Raw sums */
+static float32_t         s_offset[BSP_ADC1_NUM_CHANNELS]; /**< Means removed */
+static bool              s_offset_valid;   /**< s_offset is set */
+
+/** Samples being taken in */
+static bsp_adc1_sample_t s_samples[GOERTZEL_READ_BATCH];
+
+/** Results being computed (filter task only) and last published */
+static goertzel_result_t s_next[GOERTZEL_TONES];
+static goertzel_result_t s_results[GOERTZEL_TONES];
+
+/** Windows published, 0 until the first */
+static uint32_t s_windows;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Start a window with the current configuration
+ *
+ * @param[in] first First sample of the window
+ */
+static void goertzel_open(const bsp_adc1_sample_t *first)
+{
+    goertzel_config_t config;
+
+    taskENTER_CRITICAL();
+    config = s_config;
+    taskEXIT_CRITICAL();
+
+    s_period         = GOERTZEL_UNITS_PER_HZ * s_rate;
+    s_window_samples = ((uint32_t)config.window_ms * s_rate) / 1000U;
+    if (s_window_samples == 0U)
+    {
+        s_window_samples = 1U;
+    }
+
+    for (uint32_t t = 0U; t < GOERTZEL_TONES; t++)
+    {
+        goertzel_state_t      *tone = &s_tones[t];
+        const goertzel_tone_t *cfg  = &config.tones[t];
+        float64_t              w;
+
+        (void)memset(tone, 0, sizeof(*tone));
+        tone->frequency = cfg->frequency;
+        tone->channel   = cfg->channel;
+        tone->active    = (cfg->frequency != 0U) &&
+                       (cfg->channel < BSP_ADC1_NUM_CHANNELS) &&
+                       ((2U * (uint32_t)cfg->frequency) < s_period);
+        if (!tone->active)
+        {
+            continue;
+        }
+
+        w = (GOERTZEL_TWO_PI * (float64_t)cfg->frequency) /
+            (float64_t)s_period;
+        tone->coeff = (float32_t)(2.0 * cos(w));
+        tone->cos_w = 0.5f * tone->coeff;
+        tone->sin_w = (float32_t)sin(w);
+    }
+
+    /* The first window after boot removes its first sample instead of
+     * the mean of a window before it */
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if (!s_offset_valid)
+        {
+            s_offset[ch] = (float32_t)first->raw[ch];
+        }
+        s_sum[ch] = 0U;
+    }
+    s_offset_valid = true;
+
+    s_fill = 0U;
+    s_open = true;
+}
+
+/**
+ * @brief Run every tone over one segment of consecutive samples
+ *
+ * @param[in] samples Samples of the segment
+ * @param[in] count   Number of samples, at least 1, that the window still
+ *                    has room for
+ */
+static void goertzel_segment(const bsp_adc1_sample_t *samples, uint32_t count)
+{
+    uint32_t last = s_fill + count - 1U;
+
+    for (uint32_t t = 0U; t < GOERTZEL_TONES; t++)
+    {
+        goertzel_state_t *tone = &s_tones[t];
+        float32_t         offset;
+        float32_t         s1 = 0.0f;
+        float32_t         s2 = 0.0f;
+        float32_t         yr;
+        float32_t         yi;
+        float32_t         turn;
+        float32_t         c;
+        float32_t         s;
+
+        if (!tone->active)
+        {
+            continue;
+        }
+
+        offset = s_offset[tone->channel];
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            float32_t s0 = ((float32_t)samples[i].raw[tone->channel] - offset) +
+                           (tone->coeff * s1) - s2;
+
+            s2 = s1;
+            s1 = s0;
+        }
+
+        /* Output at the last sample, turned back by its phase to the
+         * first sample of the window */
+        yr   = s1 - (tone->cos_w * s2);
+        yi   = tone->sin_w * s2;
+        turn = ((2.0f * PI) *
+                (float32_t)(((uint32_t)tone->frequency * last) % s_period)) /
+               (float32_t)s_period;
+        c    = cosf(turn);
+        s    = sinf(turn);
+        tone->re += (yr * c) + (yi * s);
+        tone->im += (yi * c) - (yr * s);
+    }
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+        {
+            s_sum[ch] += samples[i].raw[ch];
+        }
+    }
+
+    s_fill += count;
+}
+
+/**
+ * @brief Publish the results of the full window
+ */
+static void goertzel_close(void)
+{
+    float32_t scale = (2.0f * GOERTZEL_VREF_MV * GOERTZEL_UNITS_PER_MV) /
+                      ((float32_t)BSP_ADC1_FULL_SCALE *
+                       (float32_t)s_window_samples);
+
+    for (uint32_t t = 0U; t < GOERTZEL_TONES; t++)
+    {
+        const goertzel_state_t *tone = &s_tones[t];
+        float32_t               magnitude;
+        float32_t               phase;
+
+        if (!tone->active)
+        {
+            s_next[t] = (goertzel_result_t){0U, 0};
+            continue;
+        }
+
+        (void)arm_sqrt_f32((tone->re * tone->re) + (tone->im * tone->im),
+                           &magnitude);
+        magnitude *= scale;
+        phase = atan2f(tone->im, tone->re) * GOERTZEL_UNITS_PER_RAD;
+
+        s_next[t].magnitude = (magnitude >= GOERTZEL_REGISTER_MAX)
+                                  ? (uint16_t)GOERTZEL_REGISTER_MAX
+                                  : (uint16_t)(magnitude + 0.5f);
+
+        /* The phase of noise means nothing */
+        s_next[t].phase =
+            (s_next[t].magnitude != 0U) ? (int16_t)lrintf(phase) : 0;
+    }
+
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        s_offset[ch] = (float32_t)s_sum[ch] / (float32_t)s_window_samples;
+    }
+
+    taskENTER_CRITICAL();
+    (void)memcpy(s_results, s_next, sizeof(s_results));
+    s_windows++;
+    taskEXIT_CRITICAL();
+
+    s_open = false;
+}
+
+/**
+ * @brief Take a batch of samples into the window
+ *
+ * A sample that does not follow the one before drops the window and
+ * starts the next with it.
+ */
+static void goertzel_take(const bsp_adc1_sample_t *samples, uint32_t count)
+{
+    uint32_t i = 0U;
+
+    while (i < count)
+    {
+        uint32_t room;
+        uint32_t run = 1U;
+
+        if (s_open && (samples[i].sequence != s_next_sequence))
+        {
+            s_open = false;
+        }
+        if (!s_open)
+        {
+            goertzel_open(&samples[i]);
+        }
+
+        room = s_window_samples - s_fill;
+        while (((i + run) < count) && (run < room) &&
+               (samples[i + run].sequence == (samples[i].sequence + run)))
+        {
+            run++;
+        }
+
+        goertzel_segment(&samples[i], run);
+        s_next_sequence = samples[i + run - 1U].sequence + 1U;
+        i += run;
+
+        if (s_fill == s_window_samples)
+        {
+            goertzel_close();
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void goertzel_set_config(const goertzel_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_config = *config;
+    if (s_config.window_ms < GOERTZEL_MIN_WINDOW_MS)
+    {
+        s_config.window_ms = GOERTZEL_MIN_WINDOW_MS;
+    }
+    if (s_config.window_ms > GOERTZEL_MAX_WINDOW_MS)
+    {
+        s_config.window_ms = GOERTZEL_MAX_WINDOW_MS;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void goertzel_process(void)
+{
+    uint32_t rate = BSP_ADC1_GetSampleRate();
+    uint32_t count;
+
+    if (!s_attached)
+    {
+        (void)BSP_ADC1_RingReaderInit(&s_reader, BSP_ADC1_STREAM_FULL);
+        s_attached = true;
+    }
+
+    /* A window is taken at one rate throughout */
+    if (rate != s_rate)
+    {
+        s_open = false;
+        s_rate = rate;
+    }
+
+    do
+    {
+        uint32_t overruns = s_reader.overruns;
+
+        if (BSP_ADC1_RingRead(&s_reader, s_samples, GOERTZEL_READ_BATCH,
+                              &count) != BSP_OK)
+        {
+            break;
+        }
+        metrics_add(METRIC_ADC_OVERRUN, s_reader.overruns - overruns);
+        goertzel_take(s_samples, count);
+    } while (count == GOERTZEL_READ_BATCH);
+}
+
+uint32_t goertzel_get_results(goertzel_result_t results[GOERTZEL_TONES])
+{
+    uint32_t windows;
+
+    taskENTER_CRITICAL();
+    (void)memcpy(results, s_results, sizeof(s_results));
+    windows = s_windows;
+    taskEXIT_CRITICAL();
+
+    return windows;
+}
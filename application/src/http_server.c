@@ -0,0 +1,1251 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * HTTP Status Server on the lwIP Raw API
+ *
+ * Every callback of this file runs in the TCP/IP thread, one at a time, so
+ * the connection table needs no lock. A response is a constant part, an
+ * asset or a canned header, queued by reference, optionally followed by a
+ * JSON stream. The stream is a generator per resource that formats its
+ * next item into the connection's item buffer from a cursor (step, index,
+ * offset); http_server_send() copies items into the send buffer until it
+ * is full and is called again from the sent and poll callbacks. The cursor
+ * is all the state a response keeps. See http_server.h.
+ */
+
+#include "http_server.h"
+
+#if HTTP_SERVER
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "adc_archive.h"
+#include "bsp.h"
+#include "cpu_load.h"
+#include "http_ws.h"
+#include "jerry_device_registers.h"
+#include "jerry_printf.h"
+#include "log.h"
+#include "lwip/err.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "modbus_callbacks.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** tcp_poll() period, in TCP coarse timer ticks of 500 ms */
+#define HTTP_SERVER_POLL_INTERVAL 1U
+
+/** Connections without a request, or without progress, for this long are
+ *  closed */
+#define HTTP_SERVER_IDLE_TIMEOUT_MS 10000U
+
+/** Longest JSON value of a register table: "65535" and a comma */
+#define HTTP_SERVER_VALUE_MAX_LENGTH 6U
+
+/** Path of the page served for "/" */
+#define HTTP_SERVER_INDEX_PATH "/index.html"
+
+/** Request header naming the key of a WebSocket upgrade */
+#define HTTP_SERVER_WS_KEY_HEADER "Sec-WebSocket-Key:"
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Result of a JSON generator step
+ */
+typedef enum
+{
+    HTTP_ITEM_READY, /**< An item is in the item buffer */
+    HTTP_ITEM_WAIT,  /**< Nothing yet, retry on the next poll */
+    HTTP_ITEM_END,   /**< The document is complete */
+} http_item_t;
+
+/**
+ * @brief Steps of the status document
+ */
+enum
+{
+    HTTP_STATUS_HEAD = 0U,
+    HTTP_STATUS_CPU,
+    HTTP_STATUS_TASKS,
+    HTTP_STATUS_METRICS,
+    HTTP_STATUS_END,
+};
+
+/**
+ * @brief Steps of the register document
+ */
+enum
+{
+    HTTP_REGISTERS_HEAD = 0U,
+    HTTP_REGISTERS_BLOCK,
+    HTTP_REGISTERS_VALUES,
+    HTTP_REGISTERS_END,
+};
+
+/**
+ * @brief Steps of the archive document
+ */
+enum
+{
+    HTTP_ARCHIVE_HEAD = 0U,
+    HTTP_ARCHIVE_RECORDS,
+    HTTP_ARCHIVE_END,
+};
+
+struct http_conn;
+
+/** Generator of the next item of a JSON document */
+typedef http_item_t (*http_json_fn_t)(struct http_conn *conn);
+
+/**
+ * @brief One connection
+ *
+ * @c pcb is NULL while the entry is free. The response is @c part, sent
+ * from @c part_offset without a copy, then, if @c json is set, its items.
+ * A WebSocket request reads its headers up to the blank line and then
+ * hands the PCB over to http_ws_accept().
+ */
+typedef struct http_conn
+{
+    struct tcp_pcb *pcb;           /**< PCB, NULL if free */
+    TickType_t      last_activity; /**< Tick of the last request or ACK */
+    bool            responding;    /**< Response started */
+    bool            upgrade;       /**< WebSocket request, reading headers */
+    uint16_t        rx_length;     /**< Bytes of the line in rx */
+    char            rx[HTTP_SERVER_REQUEST_MAX]; /**< Line being read */
+    char            key[HTTP_WS_KEY_LENGTH + 1U]; /**< Sec-WebSocket-Key */
+
+    const uint8_t *part;        /**< Constant part, in flash */
+    uint32_t       part_length; /**< Bytes of @c part */
+    uint32_t       part_offset; /**< Bytes of @c part queued */
+    const uint8_t *body;        /**< Constant part behind it, or NULL */
+    uint32_t       body_length; /**< Bytes of @c body */
+
+    http_json_fn_t json;        /**< Generator, NULL when done */
+    uint16_t       step;        /**< Step of the generator */
+    uint16_t       index;       /**< Entry within the step */
+    uint16_t       offset;      /**< Values of the block read so far */
+    uint16_t       item_length; /**< Bytes in item, 0 if it was sent */
+    char           item[HTTP_SERVER_ITEM_SIZE]; /**< Item being sent */
+
+    /** Data of the document, taken as the request arrived or per block */
+    union
+    {
+        struct
+        {
+            cpu_load_snapshot_t load;
+            uint32_t            totals[METRIC_COUNT];
+        } status;
+        struct
+        {
+            uint16_t values[HTTP_SERVER_VALUES_MAX]; /**< Read, bits packed */
+            uint16_t length;  /**< Values read into values[] */
+            uint16_t next;    /**< Next of them to send */
+            uint16_t emitted; /**< Values of the block sent */
+        } registers;
+#if ADC_ARCHIVE
+        struct
+        {
+            adc_archive_query_t  query; /**< Range still to send */
+            adc_archive_record_t records[ADC_ARCHIVE_PAGE_RECORDS];
+            uint16_t length; /**< Records read into records[] */
+            uint16_t next;   /**< Next of them to send */
+        } archive;
+#endif
+    } data;
+} http_conn_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Register mutex owned by the Modbus TCP task */
+static SemaphoreHandle_t s_register_mutex;
+
+/** Connections (TCP/IP thread only) */
+static http_conn_t s_conns[HTTP_SERVER_MAX_CONNECTIONS];
+
+/** Header of the JSON resources, which end with the connection */
+static const char s_json_header[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Content-Type: application/json\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+/** Canned error responses */
+static const char s_bad_request[] =
+    "HTTP/1.0 400 Bad Request\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 12\r\n"
+    "Connection: close\r\n"
+    "\r\n"
+    "Bad request\n";
+
+static const char s_not_found[] =
+    "HTTP/1.0 404 Not Found\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 10\r\n"
+    "Connection: close\r\n"
+    "\r\n"
+    "Not found\n";
+
+static const char s_not_allowed[] =
+    "HTTP/1.0 405 Method Not Allowed\r\n"
+    "Allow: GET\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 19\r\n"
+    "Connection: close\r\n"
+    "\r\n"
+    "Method not allowed\n";
+
+static const char s_unavailable[] =
+    "HTTP/1.0 503 Service Unavailable\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 12\r\n"
+    "Connection: close\r\n"
+    "\r\n"
+    "Unavailable\n";
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Format an item into the connection's item buffer
+ *
+ * The items are far shorter than the buffer; one that is not is cut.
+ *
+ * @return HTTP_ITEM_READY
+ */
+static http_item_t http_item(http_conn_t *conn, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static http_item_t http_item(http_conn_t *conn, const char *format, ...)
+{
+    va_list ap;
+    int     length;
+
+    va_start(ap, format);
+    length = jerry_vsnprintf(conn->item, sizeof(conn->item), format, ap);
+    va_end(ap);
+
+    conn->item_length = (length < (int)sizeof(conn->item))
+                            ? (uint16_t)length
+                            : (uint16_t)(sizeof(conn->item) - 1U);
+
+    return HTTP_ITEM_READY;
+}
+
+/**
+ * @brief Generator of /api/status.json
+ *
+ * The CPU load and the counters were copied as the request arrived, so
+ * the document is one consistent view.
+ */
+static http_item_t http_status_next(http_conn_t *conn)
+{
+    const cpu_load_snapshot_t *load   = &conn->data.status.load;
+    const uint32_t            *totals = conn->data.status.totals;
+    http_item_t                item   = HTTP_ITEM_READY;
+
+    switch (conn->step)
+    {
+        case HTTP_STATUS_HEAD:
+            (void)http_item(
+                conn,
+                "{\"uptime_ms\":%lu,\"adc\":{\"samples\":%lu,"
+                "\"block_overruns\":%lu},",
+                (unsigned long)pdTICKS_TO_MS(xTaskGetTickCount()),
+                (unsigned long)BSP_ADC1_GetFilterSampleCount(),
+                (unsigned long)BSP_ADC1_GetFilterBlockOverruns());
+            conn->step = HTTP_STATUS_CPU;
+            break;
+
+        case HTTP_STATUS_CPU:
+            (void)http_item(
+                conn,
+                "\"cpu\":{\"total\":%u.%02u,\"isr\":{\"adc1_dma\":%u.%02u,"
+                "\"eth\":%u.%02u},\"tasks\":[",
+                (unsigned int)(load->total / 100U),
+                (unsigned int)(load->total % 100U),
+                (unsigned int)(load->isr[BSP_ISR_ADC1_DMA] / 100U),
+                (unsigned int)(load->isr[BSP_ISR_ADC1_DMA] % 100U),
+                (unsigned int)(load->isr[BSP_ISR_ETH] / 100U),
+                (unsigned int)(load->isr[BSP_ISR_ETH] % 100U));
+            conn->step  = HTTP_STATUS_TASKS;
+            conn->index = 0U;
+            break;
+
+        case HTTP_STATUS_TASKS:
+            if (conn->index < load->task_count)
+            {
+                const cpu_load_task_t *task = &load->tasks[conn->index];
+
+                (void)http_item(
+                    conn,
+                    "%s{\"name\":\"%.*s\",\"load\":%u.%02u,"
+                    "\"stack_free\":%u}",
+                    (conn->index > 0U) ? "," : "", (int)sizeof(task->name),
+                    task->name, (unsigned int)(task->load / 100U),
+                    (unsigned int)(task->load % 100U),
+                    (unsigned int)task->stack_free);
+                conn->index++;
+            }
+            else
+            {
+                (void)http_item(conn, "]},\"metrics\":[");
+                conn->step  = HTTP_STATUS_METRICS;
+                conn->index = 0U;
+            }
+            break;
+
+        case HTTP_STATUS_METRICS:
+            if (conn->index < (uint16_t)METRIC_COUNT)
+            {
+                (void)http_item(conn, "%s{\"name\":\"%s\",\"total\":%lu}",
+                                (conn->index > 0U) ? "," : "",
+                                metrics_name((metric_id_t)conn->index),
+                                (unsigned long)totals[conn->index]);
+                conn->index++;
+            }
+            else
+            {
+                (void)http_item(conn, "]}\n");
+                conn->step = HTTP_STATUS_END;
+            }
+            break;
+
+        default:
+            item = HTTP_ITEM_END;
+            break;
+    }
+
+    return item;
+}
+
+#ifdef JERRY_DEVICE_SNAPSHOT_BLOCK_COUNT
+
+/**
+ * @brief Read the next values of a block through the Modbus read callbacks
+ *
+ * Tries the register mutex without waiting.
+ *
+ * @param[in,out] conn  Connection, values land in its register data
+ * @param[in]     block Block being sent
+ * @param[out]    ex    Exception of the callback
+ * @return false if the mutex is taken, so nothing was read
+ */
+static bool http_registers_read(http_conn_t                         *conn,
+                                const jerry_device_snapshot_block_t *block,
+                                modbus_exception_t                  *ex)
+{
+    bool     bits  = (block->table == MODBUS_FC_READ_COILS) ||
+                     (block->table == MODBUS_FC_READ_DISCRETE_INPUTS);
+    uint16_t limit = bits ? (uint16_t)(HTTP_SERVER_VALUES_MAX * 16U)
+                          : (uint16_t)HTTP_SERVER_VALUES_MAX;
+    uint16_t count = (uint16_t)(block->count - conn->offset);
+    uint16_t address;
+
+    if (count > limit)
+    {
+        count = limit;
+    }
+    address = (uint16_t)(block->address + conn->offset);
+
+    if (xSemaphoreTake(s_register_mutex, 0U) != pdTRUE)
+    {
+        return false;
+    }
+    switch (block->table)
+    {
+        case MODBUS_FC_READ_COILS:
+            *ex = modbus_cb_read_coils(
+                address, count, (uint8_t *)conn->data.registers.values);
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            *ex = modbus_cb_read_discrete_inputs(
+                address, count, (uint8_t *)conn->data.registers.values);
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            *ex = modbus_cb_read_holding_registers(
+                address, count, conn->data.registers.values);
+            break;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            *ex = modbus_cb_read_input_registers(
+                address, count, conn->data.registers.values);
+            break;
+        default:
+            *ex = MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+            break;
+    }
+    (void)xSemaphoreGive(s_register_mutex);
+
+    conn->offset                = (uint16_t)(conn->offset + count);
+    conn->data.registers.length = count;
+    conn->data.registers.next   = 0U;
+
+    return true;
+}
+
+/**
+ * @brief Format the values read so far into an item, as many as fit
+ */
+static void http_registers_values(http_conn_t                         *conn,
+                                  const jerry_device_snapshot_block_t *block)
+{
+    const uint8_t *bytes = (const uint8_t *)conn->data.registers.values;
+    bool           bits  = (block->table == MODBUS_FC_READ_COILS) ||
+                           (block->table == MODBUS_FC_READ_DISCRETE_INPUTS);
+    uint16_t       length = 0U;
+
+    while ((conn->data.registers.next < conn->data.registers.length) &&
+           ((length + HTTP_SERVER_VALUE_MAX_LENGTH) < sizeof(conn->item)))
+    {
+        uint16_t i     = conn->data.registers.next;
+        uint16_t value = bits ? (uint16_t)((bytes[i / 8U] >> (i % 8U)) & 1U)
+                              : conn->data.registers.values[i];
+        int      added = jerry_snprintf(
+            &conn->item[length], sizeof(conn->item) - length, "%s%u",
+            (conn->data.registers.emitted > 0U) ? "," : "",
+            (unsigned int)value);
+
+        length = (uint16_t)(length + (uint16_t)added);
+        conn->data.registers.next++;
+        conn->data.registers.emitted++;
+    }
+
+    conn->item_length = length;
+}
+
+/**
+ * @brief Generator of /api/registers.json
+ */
+static http_item_t http_registers_next(http_conn_t *conn)
+{
+    const jerry_device_snapshot_block_t *block =
+        &jerry_device_snapshot_blocks[conn->index];
+    modbus_exception_t ex   = MODBUS_EXCEPTION_NONE;
+    http_item_t        item = HTTP_ITEM_READY;
+
+    switch (conn->step)
+    {
+        case HTTP_REGISTERS_HEAD:
+            (void)http_item(
+                conn, "{\"layout_id\":%lu,\"uptime_ms\":%lu,\"blocks\":[",
+                (unsigned long)JERRY_DEVICE_SNAPSHOT_LAYOUT_ID,
+                (unsigned long)pdTICKS_TO_MS(xTaskGetTickCount()));
+            conn->step  = HTTP_REGISTERS_BLOCK;
+            conn->index = 0U;
+            break;
+
+        case HTTP_REGISTERS_BLOCK:
+            if (conn->index < JERRY_DEVICE_SNAPSHOT_BLOCK_COUNT)
+            {
+                (void)http_item(
+                    conn,
+                    "%s{\"table\":%u,\"address\":%u,\"count\":%u,\"values\":[",
+                    (conn->index > 0U) ? "," : "", (unsigned int)block->table,
+                    (unsigned int)block->address, (unsigned int)block->count);
+                conn->offset                 = 0U;
+                conn->data.registers.length  = 0U;
+                conn->data.registers.next    = 0U;
+                conn->data.registers.emitted = 0U;
+                conn->step                   = HTTP_REGISTERS_VALUES;
+            }
+            else
+            {
+                (void)http_item(conn, "]}\n");
+                conn->step = HTTP_REGISTERS_END;
+            }
+            break;
+
+        case HTTP_REGISTERS_VALUES:
+            if (conn->data.registers.next < conn->data.registers.length)
+            {
+                http_registers_values(conn, block);
+            }
+            else if (conn->offset >= block->count)
+            {
+                (void)http_item(conn, "]}");
+                conn->index++;
+                conn->step = HTTP_REGISTERS_BLOCK;
+            }
+            else if (!http_registers_read(conn, block, &ex))
+            {
+                /* A Modbus request holds the registers */
+                item = HTTP_ITEM_WAIT;
+            }
+            else if (ex != MODBUS_EXCEPTION_NONE)
+            {
+                (void)http_item(conn, "],\"exception\":%u}", (unsigned int)ex);
+                conn->index++;
+                conn->step = HTTP_REGISTERS_BLOCK;
+            }
+            else
+            {
+                http_registers_values(conn, block);
+            }
+            break;
+
+        default:
+            item = HTTP_ITEM_END;
+            break;
+    }
+
+    return item;
+}
+
+#endif /* JERRY_DEVICE_SNAPSHOT_BLOCK_COUNT */
+
+#if ADC_ARCHIVE
+
+/**
+ * @brief Generator of /api/archive.json
+ *
+ * Reads one page of records at a time, only trying the flash mutex.
+ */
+static http_item_t http_archive_next(http_conn_t *conn)
+{
+    http_item_t item = HTTP_ITEM_READY;
+
+    switch (conn->step)
+    {
+        case HTTP_ARCHIVE_HEAD:
+            (void)http_item(
+                conn,
+                "{\"archive\":\"%s\",\"from\":%lu,\"to\":%lu,"
+                "\"records\":[",
+                (conn->data.archive.query.archive ==
+                 (uint8_t)ADC_ARCHIVE_MINUTES)
+                    ? "minutes"
+                    : "seconds",
+                (unsigned long)conn->data.archive.query.from_s,
+                (unsigned long)conn->data.archive.query.to_s);
+            conn->data.archive.length = 0U;
+            conn->data.archive.next   = 0U;
+            conn->step                = HTTP_ARCHIVE_RECORDS;
+            conn->index               = 0U;
+            break;
+
+        case HTTP_ARCHIVE_RECORDS:
+            if (conn->data.archive.next == conn->data.archive.length)
+            {
+                int32_t count = adc_archive_query_next(
+                    &conn->data.archive.query, conn->data.archive.records,
+                    0U);
+
+                if (count == ADC_ARCHIVE_BUSY)
+                {
+                    /* The log or a query holds the flash */
+                    item = HTTP_ITEM_WAIT;
+                    break;
+                }
+                if (count == 0)
+                {
+                    (void)http_item(conn, "]}\n");
+                    conn->step = HTTP_ARCHIVE_END;
+                    break;
+                }
+                conn->data.archive.length = (uint16_t)count;
+                conn->data.archive.next   = 0U;
+            }
+            {
+                const adc_archive_record_t *record =
+                    &conn->data.archive.records[conn->data.archive.next];
+                uint16_t length = (uint16_t)jerry_snprintf(
+                    conn->item, sizeof(conn->item), "%s[%lu",
+                    (conn->index > 0U) ? "," : "",
+                    (unsigned long)record->time_s);
+
+                for (uint32_t ch = 0U; ch < ADC_ARCHIVE_CHANNELS; ch++)
+                {
+                    length = (uint16_t)(
+                        length +
+                        (uint16_t)jerry_snprintf(
+                            &conn->item[length], sizeof(conn->item) - length,
+                            ",%u,%u,%u", (unsigned int)record->min[ch],
+                            (unsigned int)record->max[ch],
+                            (unsigned int)record->mean[ch]));
+                }
+                conn->item[length++] = ']';
+                conn->item_length    = length;
+                conn->data.archive.next++;
+                conn->index = 1U;
+            }
+            break;
+
+        default:
+            item = HTTP_ITEM_END;
+            break;
+    }
+
+    return item;
+}
+
+#endif /* ADC_ARCHIVE */
+
+/**
+ * @brief Detach a connection from its PCB and close it
+ *
+ * @param[in,out] conn  Connection, free on return
+ * @param[in]     abort Reset the connection instead of closing it
+ * @return ERR_ABRT if the PCB was aborted, which a callback of that PCB
+ *         must return, else ERR_OK
+ */
+static err_t http_server_close(http_conn_t *conn, bool abort)
+{
+    struct tcp_pcb *pcb = conn->pcb;
+    err_t           err = ERR_OK;
+
+    conn->pcb = NULL;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0U);
+
+    if (abort || (tcp_close(pcb) != ERR_OK))
+    {
+        tcp_abort(pcb);
+        err = ERR_ABRT;
+    }
+
+    return err;
+}
+
+/**
+ * @brief Queue as much of the response as the send buffer takes
+ *
+ * The constant parts are queued by reference, the JSON items copied. When
+ * all is queued the connection is closed, after the data.
+ *
+ * @return ERR_ABRT if the PCB was aborted, else ERR_OK
+ */
+static err_t http_server_send(http_conn_t *conn)
+{
+    struct tcp_pcb *pcb     = conn->pcb;
+    bool            blocked = false;
+    err_t           err     = ERR_OK;
+
+    while (!blocked && (err == ERR_OK) && (conn->part != NULL))
+    {
+        uint32_t remaining = conn->part_length - conn->part_offset;
+        uint32_t chunk     = tcp_sndbuf(pcb);
+
+        if (remaining == 0U)
+        {
+            /* On to the body, if any */
+            conn->part        = conn->body;
+            conn->part_length = conn->body_length;
+            conn->part_offset = 0U;
+            conn->body        = NULL;
+            continue;
+        }
+
+        if (chunk > remaining)
+        {
+            chunk = remaining;
+        }
+        if (chunk > TCP_MSS)
+        {
+            chunk = TCP_MSS;
+        }
+        if (chunk == 0U)
+        {
+            blocked = true;
+            continue;
+        }
+
+        err = tcp_write(pcb, &conn->part[conn->part_offset], (u16_t)chunk,
+                        ((chunk < remaining) || (conn->body != NULL) ||
+                         (conn->json != NULL))
+                            ? TCP_WRITE_FLAG_MORE
+                            : 0U);
+        if (err == ERR_OK)
+        {
+            conn->part_offset += chunk;
+        }
+    }
+
+    while (!blocked && (err == ERR_OK) && (conn->part == NULL) &&
+           (conn->json != NULL))
+    {
+        if (conn->item_length == 0U)
+        {
+            http_item_t item = conn->json(conn);
+
+            if (item == HTTP_ITEM_WAIT)
+            {
+                blocked = true;
+                continue;
+            }
+            if (item == HTTP_ITEM_END)
+            {
+                conn->json = NULL;
+                continue;
+            }
+        }
+
+        if (tcp_sndbuf(pcb) < conn->item_length)
+        {
+            blocked = true;
+            continue;
+        }
+
+        err = tcp_write(pcb, conn->item, conn->item_length,
+                        TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+        if (err == ERR_OK)
+        {
+            conn->item_length = 0U;
+        }
+    }
+
+    /* ERR_MEM: the segment queue is full, go on when it drains */
+    if (err == ERR_MEM)
+    {
+        err = ERR_OK;
+    }
+    if (err != ERR_OK)
+    {
+        LOG("HTTP: Write error: %d\n", err);
+        return http_server_close(conn, true);
+    }
+
+    (void)tcp_output(pcb);
+
+    if ((conn->part == NULL) && (conn->json == NULL))
+    {
+        err = http_server_close(conn, false);
+    }
+
+    return err;
+}
+
+/**
+ * @brief Start a response of constant parts
+ */
+static void http_server_respond(http_conn_t *conn, const char *header,
+                                uint32_t header_length, const uint8_t *body,
+                                uint32_t body_length)
+{
+    conn->part        = (const uint8_t *)header;
+    conn->part_length = header_length;
+    conn->part_offset = 0U;
+    conn->body        = body;
+    conn->body_length = body_length;
+}
+
+/**
+ * @brief Start a JSON response
+ */
+static void http_server_respond_json(http_conn_t *conn, http_json_fn_t json)
+{
+    http_server_respond(conn, s_json_header, sizeof(s_json_header) - 1U, NULL,
+                        0U);
+    conn->json        = json;
+    conn->step        = 0U;
+    conn->index       = 0U;
+    conn->item_length = 0U;
+}
+
+#if ADC_ARCHIVE
+
+/**
+ * @brief Find a parameter of the query string
+ *
+ * @return Its value, up to the next '&' or the end, or NULL if absent
+ */
+static const char *http_server_param(const char *query, const char *name)
+{
+    size_t length = strlen(name);
+
+    while ((query != NULL) && (*query != '\0'))
+    {
+        if ((strncmp(query, name, length) == 0) && (query[length] == '='))
+        {
+            return &query[length + 1U];
+        }
+        query = strchr(query, '&');
+        if (query != NULL)
+        {
+            query++;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Read a decimal parameter of the query string
+ *
+ * @param[in,out] value Left as it is if the parameter is absent
+ * @return false if the parameter is not a number of 32 bits
+ */
+static bool http_server_param_u32(const char *query, const char *name,
+                                  uint32_t *value)
+{
+    const char *digits = http_server_param(query, name);
+    uint64_t    number = 0U;
+
+    if (digits == NULL)
+    {
+        return true;
+    }
+    if (!isdigit((unsigned char)*digits))
+    {
+        return false;
+    }
+    while (isdigit((unsigned char)*digits))
+    {
+        number = (number * 10U) + (uint64_t)(*digits - '0');
+        if (number > 0xFFFFFFFFULL)
+        {
+            return false;
+        }
+        digits++;
+    }
+    *value = (uint32_t)number;
+
+    return (*digits == '\0') || (*digits == '&');
+}
+
+/**
+ * @brief Start /api/archive.json for the range of the query string
+ *
+ * Parameters: archive, "seconds" (the default) or "minutes"; from and to,
+ * the first and last times in s, by default the whole archive.
+ */
+static void http_archive_route(http_conn_t *conn, const char *query)
+{
+    const char      *name    = http_server_param(query, "archive");
+    adc_archive_id_t archive = ADC_ARCHIVE_SECONDS;
+    uint32_t         from_s  = 0U;
+    uint32_t         to_s    = 0xFFFFFFFFU;
+    bool             valid   = true;
+
+    if (name != NULL)
+    {
+        if ((strncmp(name, "minutes", 7U) == 0) &&
+            ((name[7] == '\0') || (name[7] == '&')))
+        {
+            archive = ADC_ARCHIVE_MINUTES;
+        }
+        else if ((strncmp(name, "seconds", 7U) != 0) ||
+                 ((name[7] != '\0') && (name[7] != '&')))
+        {
+            valid = false;
+        }
+        else
+        {
+            /* The default */
+        }
+    }
+    valid = valid && http_server_param_u32(query, "from", &from_s) &&
+            http_server_param_u32(query, "to", &to_s) && (from_s <= to_s);
+
+    if (!valid)
+    {
+        http_server_respond(conn, s_bad_request, sizeof(s_bad_request) - 1U,
+                            NULL, 0U);
+        return;
+    }
+
+    adc_archive_query_init(&conn->data.archive.query, archive, from_s, to_s);
+    http_server_respond_json(conn, http_archive_next);
+}
+
+#endif /* ADC_ARCHIVE */
+
+/**
+ * @brief Route the request line held in rx to its response
+ *
+ * Sets @c upgrade instead for the WebSocket path.
+ */
+static void http_server_route(http_conn_t *conn)
+{
+    const char *path  = &conn->rx[4];
+    char       *query = NULL;
+    char       *end;
+
+    if (strncmp(conn->rx, "GET ", 4U) != 0)
+    {
+        http_server_respond(conn, s_not_allowed, sizeof(s_not_allowed) - 1U,
+                            NULL, 0U);
+        return;
+    }
+
+    end = strpbrk(&conn->rx[4], " ?\r");
+    if ((end == NULL) || (conn->rx[4] != '/'))
+    {
+        http_server_respond(conn, s_bad_request, sizeof(s_bad_request) - 1U,
+                            NULL, 0U);
+        return;
+    }
+    if (*end == '?')
+    {
+        query = &end[1];
+        query[strcspn(query, " ")] = '\0';
+    }
+    *end = '\0';
+
+    /* path points into conn->rx, which the next request overwrites */
+    LOG_NOW("HTTP: GET %s\n", path);
+
+    if (strcmp(path, "/") == 0)
+    {
+        path = HTTP_SERVER_INDEX_PATH;
+    }
+
+    if (strcmp(path, HTTP_WS_PATH) == 0)
+    {
+        /* The response waits for the Sec-WebSocket-Key header */
+        conn->upgrade = true;
+        conn->key[0]  = '\0';
+        return;
+    }
+
+    if (strcmp(path, "/api/status.json") == 0)
+    {
+        cpu_load_get(&conn->data.status.load);
+        metrics_get(conn->data.status.totals);
+        http_server_respond_json(conn, http_status_next);
+        return;
+    }
+#ifdef JERRY_DEVICE_SNAPSHOT_BLOCK_COUNT
+    if (strcmp(path, "/api/registers.json") == 0)
+    {
+        http_server_respond_json(conn, http_registers_next);
+        return;
+    }
+#endif
+#if ADC_ARCHIVE
+    if (strcmp(path, "/api/archive.json") == 0)
+    {
+        http_archive_route(conn, query);
+        return;
+    }
+#else
+    (void)query;
+#endif
+
+    for (uint32_t i = 0U; i < http_asset_count; i++)
+    {
+        const http_asset_t *asset = &http_assets[i];
+
+        if (strcmp(path, asset->path) == 0)
+        {
+            http_server_respond(conn, asset->header, asset->header_length,
+                                asset->body, asset->body_length);
+            return;
+        }
+    }
+
+    http_server_respond(conn, s_not_found, sizeof(s_not_found) - 1U, NULL,
+                        0U);
+}
+
+/**
+ * @brief Match a request header line, ignoring the case of its name
+ *
+ * @return The value, leading blanks skipped, or NULL for another header
+ */
+static const char *http_server_header(const char *line, const char *name)
+{
+    size_t length = strlen(name);
+
+    for (size_t i = 0U; i < length; i++)
+    {
+        if (tolower((unsigned char)line[i]) !=
+            tolower((unsigned char)name[i]))
+        {
+            return NULL;
+        }
+    }
+
+    line = &line[length];
+    while ((*line == ' ') || (*line == '\t'))
+    {
+        line++;
+    }
+
+    return line;
+}
+
+/**
+ * @brief Handle the line held in rx, without its line ending
+ *
+ * @return true once the response is set up
+ */
+static bool http_server_line(http_conn_t *conn)
+{
+    const char *value;
+
+    if (!conn->upgrade)
+    {
+        /* The request line; the headers of other requests are not used */
+        http_server_route(conn);
+        return !conn->upgrade;
+    }
+
+    if (conn->rx_length > 0U)
+    {
+        value = http_server_header(conn->rx, HTTP_SERVER_WS_KEY_HEADER);
+        if (value != NULL)
+        {
+            (void)jerry_snprintf(conn->key, sizeof(conn->key), "%s", value);
+        }
+        return false;
+    }
+
+    /* End of the headers */
+    if (strlen(conn->key) != HTTP_WS_KEY_LENGTH)
+    {
+        http_server_respond(conn, s_bad_request, sizeof(s_bad_request) - 1U,
+                            NULL, 0U);
+    }
+    else if (!http_ws_accept(conn->pcb, conn->key))
+    {
+        http_server_respond(conn, s_unavailable, sizeof(s_unavailable) - 1U,
+                            NULL, 0U);
+    }
+    else
+    {
+        /* The WebSocket owns the PCB and its callbacks now */
+        conn->pcb = NULL;
+    }
+
+    return true;
+}
+
+/**
+ * @brief tcp_recv() callback: collect the request, discard the rest
+ *
+ * The request is read a line at a time. A request line longer than rx is
+ * answered with 400; a longer header line is cut, which only a WebSocket
+ * request reads, for its key.
+ */
+static err_t http_server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p,
+                              err_t err)
+{
+    http_conn_t *conn  = (http_conn_t *)arg;
+    bool         start = false;
+
+    if (p == NULL)
+    {
+        /* The client may close its side once the request is sent */
+        return conn->responding ? ERR_OK : http_server_close(conn, false);
+    }
+    if (err != ERR_OK)
+    {
+        pbuf_free(p);
+        return err;
+    }
+
+    for (uint16_t i = 0U; (i < p->tot_len) && !conn->responding && !start;
+         i++)
+    {
+        char c = (char)pbuf_get_at(p, i);
+
+        if (c == '\n')
+        {
+            conn->rx[conn->rx_length] = '\0';
+            start                     = http_server_line(conn);
+            conn->rx_length           = 0U;
+        }
+        else if (c == '\r')
+        {
+            /* Line endings are CRLF, or LF alone */
+        }
+        else if (conn->rx_length < (sizeof(conn->rx) - 1U))
+        {
+            conn->rx[conn->rx_length++] = c;
+        }
+        else if (!conn->upgrade)
+        {
+            http_server_respond(conn, s_bad_request,
+                                sizeof(s_bad_request) - 1U, NULL, 0U);
+            start = true;
+        }
+        else
+        {
+            /* The rest of a long header line is not needed */
+        }
+    }
+
+    /* The rest of the request and anything after it are not needed */
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    if (!start)
+    {
+        return ERR_OK;
+    }
+    if (conn->pcb == NULL)
+    {
+        /* Handed over to the WebSocket, which is free again */
+        return ERR_OK;
+    }
+
+    conn->responding    = true;
+    conn->last_activity = xTaskGetTickCount();
+    return http_server_send(conn);
+}
+
+/**
+ * @brief tcp_sent() callback: queue more of the response
+ */
+static err_t http_server_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+
+    (void)pcb;
+    (void)len;
+
+    conn->last_activity = xTaskGetTickCount();
+    return http_server_send(conn);
+}
+
+/**
+ * @brief tcp_err() callback: the PCB is already freed by lwIP
+ */
+static void http_server_error(void *arg, err_t err)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+
+    LOG("HTTP: Connection error: %d\n", err);
+    if (conn != NULL)
+    {
+        conn->pcb = NULL;
+    }
+}
+
+/**
+ * @brief tcp_poll() callback: idle timeout, and resume a paused response
+ */
+static err_t http_server_poll(void *arg, struct tcp_pcb *pcb)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+    TickType_t   idle = xTaskGetTickCount() - conn->last_activity;
+
+    (void)pcb;
+
+    if (idle >= pdMS_TO_TICKS(HTTP_SERVER_IDLE_TIMEOUT_MS))
+    {
+        LOG("HTTP: Idle timeout\n");
+        return http_server_close(conn, true);
+    }
+
+    return conn->responding ? http_server_send(conn) : ERR_OK;
+}
+
+/**
+ * @brief tcp_accept() callback: take a connection if a slot is free
+ */
+static err_t http_server_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    http_conn_t *conn = NULL;
+
+    (void)arg;
+
+    if ((err != ERR_OK) || (pcb == NULL))
+    {
+        return ERR_VAL;
+    }
+
+    for (uint32_t i = 0U; (i < HTTP_SERVER_MAX_CONNECTIONS) && (conn == NULL);
+         i++)
+    {
+        if (s_conns[i].pcb == NULL)
+        {
+            conn = &s_conns[i];
+        }
+    }
+    if (conn == NULL)
+    {
+        LOG("HTTP: No free connection slot, rejecting\n");
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    conn->pcb           = pcb;
+    conn->last_activity = xTaskGetTickCount();
+    conn->responding    = false;
+    conn->upgrade       = false;
+    conn->rx_length     = 0U;
+    conn->part          = NULL;
+    conn->body          = NULL;
+    conn->json          = NULL;
+
+    /* The response is flushed per callback, so Nagle only delays its last
+     * segment; Modbus keeps its PCBs when lwIP runs out of them */
+    tcp_nagle_disable(pcb);
+    tcp_setprio(pcb, TCP_PRIO_MIN);
+
+    tcp_arg(pcb, conn);
+    tcp_recv(pcb, http_server_recv);
+    tcp_sent(pcb, http_server_sent);
+    tcp_err(pcb, http_server_error);
+    tcp_poll(pcb, http_server_poll, HTTP_SERVER_POLL_INTERVAL);
+
+    return ERR_OK;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void http_server_start(SemaphoreHandle_t register_mutex)
+{
+    struct tcp_pcb *pcb;
+    struct tcp_pcb *listen_pcb = NULL;
+
+    s_register_mutex = register_mutex;
+
+    LOCK_TCPIP_CORE();
+    pcb = tcp_new();
+    if (pcb != NULL)
+    {
+        if (tcp_bind(pcb, IP_ADDR_ANY, HTTP_SERVER_PORT) == ERR_OK)
+        {
+            listen_pcb = tcp_listen_with_backlog(
+                pcb, (u8_t)HTTP_SERVER_MAX_CONNECTIONS);
+        }
+        if (listen_pcb != NULL)
+        {
+            tcp_accept(listen_pcb, http_server_accept);
+        }
+        else
+        {
+            (void)tcp_close(pcb);
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+
+    if (listen_pcb == NULL)
+    {
+        printf("HTTP: Failed to listen on port %u\n", HTTP_SERVER_PORT);
+        return;
+    }
+
+    printf("HTTP server listening on port %u (%lu assets)\n",
+           HTTP_SERVER_PORT, (unsigned long)http_asset_count);
+}
+
+#endif /* HTTP_SERVER */
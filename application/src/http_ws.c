@@ -0,0 +1,838 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * WebSocket Live Data Push of the HTTP Server
+ *
+ * The client table belongs to the TCP/IP thread: its callbacks use it
+ * directly and the push task takes the core lock to queue and send. The
+ * queue of a client is a ring of complete WebSocket frames, two bytes of
+ * framing and the message; one that finds it full pushes out the oldest.
+ * The lost count is patched into a message just before it is written, so
+ * it counts every message lost since the last one the client got. Sent
+ * and unacknowledged bytes are TCP_SND_BUF less tcp_sndbuf(), so the send
+ * budget needs no bookkeeping of its own. SHA-1 serves the handshake only,
+ * as RFC 6455 requires. See http_ws.h.
+ */
+
+#include "http_ws.h"
+
+#if HTTP_SERVER
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "bsp_sections.h"
+#include "jerry_printf.h"
+#include "live_data.h"
+#include "log.h"
+#include "lwip/err.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "metrics.h"
+#include "msg_bus.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the push task (words) */
+#define HTTP_WS_TASK_STACK_SIZE 256U
+
+/** Bus messages waiting for the push task */
+#define HTTP_WS_SUBSCRIBER_DEPTH 8U
+
+/** tcp_poll() period, in TCP coarse timer ticks of 500 ms */
+#define HTTP_WS_POLL_INTERVAL 2U
+
+/** A client that acknowledges nothing for this long is reset */
+#define HTTP_WS_STALL_TIMEOUT_MS 10000U
+
+/** Keepalive of an idle client: first probe, and between probes */
+#define HTTP_WS_KEEPALIVE_IDLE_MS     10000U
+#define HTTP_WS_KEEPALIVE_INTERVAL_MS 2000U
+
+/** WebSocket framing of a server message: FIN and opcode, length */
+#define HTTP_WS_FRAMING 2U
+
+/** Longest queued frame */
+#define HTTP_WS_MESSAGE_MAX (HTTP_WS_FRAMING + HTTP_WS_FRAME_SIZE)
+
+/** Longest client frame header: 2 bytes, 8 of length, 4 of mask */
+#define HTTP_WS_RX_HEADER_MAX 14U
+
+/** Opcodes */
+#define HTTP_WS_OP_BINARY 0x2U
+#define HTTP_WS_OP_CLOSE  0x8U
+#define HTTP_WS_OP_PING   0x9U
+#define HTTP_WS_OP_PONG   0xAU
+
+/** First byte of a frame: FIN set */
+#define HTTP_WS_FIN 0x80U
+
+/** Close status: normal closure */
+#define HTTP_WS_CLOSE_NORMAL 1000U
+
+/** Appended to the key for the Sec-WebSocket-Accept value */
+#define HTTP_WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+/** SHA-1 digest size in bytes */
+#define HTTP_WS_SHA1_SIZE 20U
+
+/** Characters of the Sec-WebSocket-Accept value, base64 of the digest */
+#define HTTP_WS_ACCEPT_LENGTH 28U
+
+_Static_assert(HTTP_WS_FRAME_SIZE <= 125U,
+               "a message must fit the short WebSocket length");
+_Static_assert((HTTP_WS_QUEUE_MESSAGES & (HTTP_WS_QUEUE_MESSAGES - 1U)) ==
+                   0U,
+               "the client queue must be a power of two");
+_Static_assert(HTTP_WS_SEND_BUDGET <= TCP_SND_BUF,
+               "the send budget must fit the send buffer");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Outcome of a byte of a client frame
+ */
+typedef enum
+{
+    HTTP_WS_RX_MORE,  /**< Go on */
+    HTTP_WS_RX_CLOSE, /**< The client closes; answer and close */
+    HTTP_WS_RX_ERROR, /**< Protocol violation; reset */
+} http_ws_rx_t;
+
+/**
+ * @brief One client
+ *
+ * @c pcb is NULL while the entry is free. Messages @c tail to @c head - 1
+ * are queued.
+ */
+typedef struct
+{
+    struct tcp_pcb *pcb;      /**< PCB, NULL if free */
+    TickType_t      last_ack; /**< Tick of the last ACK, or of the accept */
+    uint32_t        head;     /**< Messages queued */
+    uint32_t        tail;     /**< Messages written or pushed out */
+    uint32_t        lost;     /**< Messages pushed out since the last
+                                   written */
+    uint8_t length[HTTP_WS_QUEUE_MESSAGES]; /**< Bytes of each frame */
+    uint8_t queue[HTTP_WS_QUEUE_MESSAGES][HTTP_WS_MESSAGE_MAX];
+
+    uint8_t  rx_header[HTTP_WS_RX_HEADER_MAX]; /**< Frame header so far */
+    uint8_t  rx_header_length; /**< Bytes of it received */
+    bool     rx_payload;       /**< Receiving the payload */
+    uint32_t rx_length;        /**< Payload bytes of the frame */
+    uint32_t rx_offset;        /**< Payload bytes received */
+    uint8_t  control[HTTP_WS_CONTROL_MAX]; /**< Unmasked control payload */
+} http_ws_client_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Clients (TCP/IP thread, or the core lock) */
+static http_ws_client_t s_clients[HTTP_WS_MAX_CLIENTS];
+
+MSG_BUS_SUBSCRIBER_DEFINE(s_sub, HTTP_WS_SUBSCRIBER_DEPTH);
+
+/** Task control block and stack */
+static StaticTask_t s_task_tcb;
+static StackType_t  s_task_stack[HTTP_WS_TASK_STACK_SIZE] BSP_SECTION_STACK;
+
+/** Base64 alphabet */
+static const char s_base64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+static uint8_t *put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFU);
+    dst[1] = (uint8_t)(value >> 8);
+    return &dst[2];
+}
+
+static uint8_t *put_u32(uint8_t *dst, uint32_t value)
+{
+    dst = put_u16(dst, (uint16_t)(value & 0xFFFFU));
+    return put_u16(dst, (uint16_t)(value >> 16));
+}
+
+static uint8_t *put_u64(uint8_t *dst, uint64_t value)
+{
+    dst = put_u32(dst, (uint32_t)(value & 0xFFFFFFFFU));
+    return put_u32(dst, (uint32_t)(value >> 32));
+}
+
+static uint32_t rol32(uint32_t value, uint32_t bits)
+{
+    return (value << bits) | (value >> (32U - bits));
+}
+
+/**
+ * @brief Run one 64-byte block through SHA-1
+ *
+ * The message schedule is kept as a ring of 16 words.
+ */
+static void http_ws_sha1_block(uint32_t *h, const uint8_t *block)
+{
+    uint32_t w[16];
+    uint32_t a = h[0];
+    uint32_t b = h[1];
+    uint32_t c = h[2];
+    uint32_t d = h[3];
+    uint32_t e = h[4];
+
+    for (uint32_t i = 0U; i < 16U; i++)
+    {
+        w[i] = ((uint32_t)block[4U * i] << 24) |
+               ((uint32_t)block[(4U * i) + 1U] << 16) |
+               ((uint32_t)block[(4U * i) + 2U] << 8) |
+               (uint32_t)block[(4U * i) + 3U];
+    }
+
+    for (uint32_t i = 0U; i < 80U; i++)
+    {
+        uint32_t f;
+        uint32_t k;
+        uint32_t t;
+
+        if (i >= 16U)
+        {
+            w[i & 15U] = rol32(w[(i + 13U) & 15U] ^ w[(i + 8U) & 15U] ^
+                                   w[(i + 2U) & 15U] ^ w[i & 15U],
+                               1U);
+        }
+        if (i < 20U)
+        {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999U;
+        }
+        else if (i < 40U)
+        {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1U;
+        }
+        else if (i < 60U)
+        {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDCU;
+        }
+        else
+        {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6U;
+        }
+
+        t = rol32(a, 5U) + f + e + k + w[i & 15U];
+        e = d;
+        d = c;
+        c = rol32(b, 30U);
+        b = a;
+        a = t;
+    }
+
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+}
+
+/**
+ * @brief SHA-1 of a short message
+ */
+static void http_ws_sha1(const uint8_t *data, uint32_t length, uint8_t *digest)
+{
+    uint32_t h[5]   = {0x67452301U, 0xEFCDAB89U, 0x98BADCFEU, 0x10325476U,
+                       0xC3D2E1F0U};
+    uint64_t bits   = (uint64_t)length * 8U;
+    uint32_t offset = 0U;
+    uint32_t rest;
+    uint8_t  block[64];
+
+    for (; (length - offset) >= sizeof(block); offset += sizeof(block))
+    {
+        http_ws_sha1_block(h, &data[offset]);
+    }
+
+    /* Padding: a 1 bit, zeros, and the length in bits, big-endian */
+    rest = length - offset;
+    (void)memset(block, 0, sizeof(block));
+    (void)memcpy(block, &data[offset], rest);
+    block[rest] = 0x80U;
+    if (rest >= (sizeof(block) - 8U))
+    {
+        http_ws_sha1_block(h, block);
+        (void)memset(block, 0, sizeof(block));
+    }
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        block[sizeof(block) - 1U - i] = (uint8_t)(bits >> (8U * i));
+    }
+    http_ws_sha1_block(h, block);
+
+    for (uint32_t i = 0U; i < HTTP_WS_SHA1_SIZE; i++)
+    {
+        digest[i] = (uint8_t)(h[i / 4U] >> (24U - (8U * (i % 4U))));
+    }
+}
+
+/**
+ * @brief Sec-WebSocket-Accept value of a key
+ *
+ * @param[in]  key    Sec-WebSocket-Key, HTTP_WS_KEY_LENGTH characters
+ * @param[out] accept HTTP_WS_ACCEPT_LENGTH characters and a terminator
+ */
+static void http_ws_accept_value(const char *key, char *accept)
+{
+    uint8_t  text[HTTP_WS_KEY_LENGTH + sizeof(HTTP_WS_GUID) - 1U];
+    uint8_t  digest[HTTP_WS_SHA1_SIZE];
+    uint32_t out = 0U;
+
+    (void)memcpy(text, key, HTTP_WS_KEY_LENGTH);
+    (void)memcpy(&text[HTTP_WS_KEY_LENGTH], HTTP_WS_GUID,
+                 sizeof(HTTP_WS_GUID) - 1U);
+    http_ws_sha1(text, sizeof(text), digest);
+
+    /* Base64; 20 bytes leave 2 over, so one pad character */
+    for (uint32_t i = 0U; i < HTTP_WS_SHA1_SIZE; i += 3U)
+    {
+        uint32_t group = (uint32_t)digest[i] << 16;
+
+        if ((i + 1U) < HTTP_WS_SHA1_SIZE)
+        {
+            group |= (uint32_t)digest[i + 1U] << 8;
+        }
+        if ((i + 2U) < HTTP_WS_SHA1_SIZE)
+        {
+            group |= (uint32_t)digest[i + 2U];
+        }
+        accept[out++] = s_base64[(group >> 18) & 0x3FU];
+        accept[out++] = s_base64[(group >> 12) & 0x3FU];
+        accept[out++] = ((i + 1U) < HTTP_WS_SHA1_SIZE)
+                            ? s_base64[(group >> 6) & 0x3FU]
+                            : '=';
+        accept[out++] =
+            ((i + 2U) < HTTP_WS_SHA1_SIZE) ? s_base64[group & 0x3FU] : '=';
+    }
+    accept[out] = '\0';
+}
+
+/**
+ * @brief Encode a live data frame as a WebSocket frame
+ *
+ * @return Bytes written to @p dst
+ */
+static uint8_t http_ws_encode_frame(uint8_t                 *dst,
+                                    const live_data_frame_t *frame)
+{
+    uint8_t *p = &dst[HTTP_WS_FRAMING];
+
+    (void)memset(dst, 0, HTTP_WS_FRAMING + HTTP_WS_HEADER_SIZE);
+    dst[0] = (uint8_t)(HTTP_WS_FIN | HTTP_WS_OP_BINARY);
+    dst[1] = (uint8_t)HTTP_WS_FRAME_SIZE;
+    p[0]   = (uint8_t)HTTP_WS_TYPE_FRAME;
+    p[1]   = (uint8_t)BSP_ADC1_NUM_CHANNELS;
+    p[2]   = frame->di;
+    (void)put_u64(&p[8], frame->time_ns);
+    p = put_u32(&p[16], frame->sequence);
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        uint32_t bits;
+
+        (void)memcpy(&bits, &frame->mean[ch], sizeof(bits));
+        p = put_u32(p, bits);
+    }
+
+    return (uint8_t)(HTTP_WS_FRAMING + HTTP_WS_FRAME_SIZE);
+}
+
+/**
+ * @brief Encode a live data event as a WebSocket frame
+ *
+ * @return Bytes written to @p dst
+ */
+static uint8_t http_ws_encode_event(uint8_t                 *dst,
+                                    const live_data_event_t *event)
+{
+    uint8_t *p = &dst[HTTP_WS_FRAMING];
+
+    (void)memset(dst, 0, HTTP_WS_FRAMING + HTTP_WS_HEADER_SIZE);
+    dst[0] = (uint8_t)(HTTP_WS_FIN | HTTP_WS_OP_BINARY);
+    dst[1] = (uint8_t)HTTP_WS_EVENT_SIZE;
+    p[0]   = (uint8_t)HTTP_WS_TYPE_EVENT;
+    p[1]   = event->source;
+    p[2]   = event->kind;
+    (void)put_u16(&p[6], event->index);
+    (void)put_u64(&p[8], event->time_ns);
+    (void)put_u32(&p[16], (uint32_t)event->value);
+
+    return (uint8_t)(HTTP_WS_FRAMING + HTTP_WS_EVENT_SIZE);
+}
+
+/**
+ * @brief Detach a client from its PCB and close it
+ *
+ * @param[in,out] client Client, free on return
+ * @param[in]     abort  Reset the connection instead of closing it
+ * @return ERR_ABRT if the PCB was aborted, else ERR_OK
+ */
+static err_t http_ws_close(http_ws_client_t *client, bool abort)
+{
+    struct tcp_pcb *pcb = client->pcb;
+    err_t           err = ERR_OK;
+
+    client->pcb = NULL;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0U);
+
+    if (abort || (tcp_close(pcb) != ERR_OK))
+    {
+        tcp_abort(pcb);
+        err = ERR_ABRT;
+    }
+
+    return err;
+}
+
+/**
+ * @brief Queue a frame for a client, pushing out the oldest if full
+ */
+static void http_ws_queue(http_ws_client_t *client, const uint8_t *frame,
+                          uint8_t length)
+{
+    uint32_t slot;
+
+    if ((client->head - client->tail) == HTTP_WS_QUEUE_MESSAGES)
+    {
+        client->tail++;
+        client->lost++;
+        metrics_add(METRIC_WS_DROP, 1U);
+    }
+
+    slot = client->head & (HTTP_WS_QUEUE_MESSAGES - 1U);
+    (void)memcpy(client->queue[slot], frame, length);
+    client->length[slot] = length;
+    client->head++;
+}
+
+/**
+ * @brief Write queued frames while the client is within its budget
+ *
+ * @return ERR_ABRT if the PCB was aborted, else ERR_OK
+ */
+static err_t http_ws_flush(http_ws_client_t *client)
+{
+    struct tcp_pcb *pcb = client->pcb;
+    err_t           err = ERR_OK;
+
+    while ((err == ERR_OK) && (client->tail != client->head))
+    {
+        uint32_t slot    = client->tail & (HTTP_WS_QUEUE_MESSAGES - 1U);
+        uint8_t *frame   = client->queue[slot];
+        uint32_t length  = client->length[slot];
+        uint32_t room    = tcp_sndbuf(pcb);
+        uint32_t unacked = (uint32_t)TCP_SND_BUF - room;
+        uint16_t lost    = (client->lost > 0xFFFFU) ? 0xFFFFU
+                                                    : (uint16_t)client->lost;
+
+        if (((unacked + length) > HTTP_WS_SEND_BUDGET) || (room < length))
+        {
+            break;
+        }
+
+        (void)put_u16(&frame[HTTP_WS_FRAMING + 4U], lost);
+        err = tcp_write(pcb, frame, (u16_t)length, TCP_WRITE_FLAG_COPY);
+        if (err == ERR_OK)
+        {
+            client->tail++;
+            client->lost = 0U;
+        }
+    }
+
+    /* ERR_MEM: the segment queue is full, go on when it drains */
+    if (err == ERR_MEM)
+    {
+        err = ERR_OK;
+    }
+    if (err != ERR_OK)
+    {
+        LOG("WS: Write error: %d\n", err);
+        return http_ws_close(client, true);
+    }
+
+    (void)tcp_output(pcb);
+    return ERR_OK;
+}
+
+/**
+ * @brief Write a control frame at once, ahead of the queue
+ *
+ * A control frame that does not fit the send buffer is not sent; the
+ * client then misses one pong.
+ */
+static void http_ws_control(http_ws_client_t *client, uint8_t opcode,
+                            const uint8_t *payload, uint32_t length)
+{
+    uint8_t header[HTTP_WS_FRAMING];
+
+    if (tcp_sndbuf(client->pcb) < (HTTP_WS_FRAMING + length))
+    {
+        return;
+    }
+
+    header[0] = (uint8_t)(HTTP_WS_FIN | opcode);
+    header[1] = (uint8_t)length;
+    if ((tcp_write(client->pcb, header, sizeof(header),
+                   TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE) == ERR_OK) &&
+        (length > 0U))
+    {
+        (void)tcp_write(client->pcb, payload, (u16_t)length,
+                        TCP_WRITE_FLAG_COPY);
+    }
+}
+
+/**
+ * @brief Handle a complete client frame
+ *
+ * @return HTTP_WS_RX_CLOSE for a close frame, else HTTP_WS_RX_MORE
+ */
+static http_ws_rx_t http_ws_frame_end(http_ws_client_t *client)
+{
+    uint8_t      opcode = (uint8_t)(client->rx_header[0] & 0x0FU);
+    http_ws_rx_t rx     = HTTP_WS_RX_MORE;
+
+    /* The next byte starts a new frame; rx_length stays for the caller */
+    client->rx_payload       = false;
+    client->rx_header_length = 0U;
+
+    switch (opcode)
+    {
+        case HTTP_WS_OP_PING:
+            http_ws_control(client, HTTP_WS_OP_PONG, client->control,
+                            client->rx_length);
+            break;
+        case HTTP_WS_OP_CLOSE:
+            rx = HTTP_WS_RX_CLOSE;
+            break;
+        default:
+            /* Data and pongs are not used */
+            break;
+    }
+
+    return rx;
+}
+
+/**
+ * @brief Take one byte of a client frame
+ */
+static http_ws_rx_t http_ws_parse(http_ws_client_t *client, uint8_t byte)
+{
+    uint8_t *header = client->rx_header;
+    uint32_t length;
+    uint32_t needed;
+
+    if (client->rx_payload)
+    {
+        if (client->rx_offset < sizeof(client->control))
+        {
+            client->control[client->rx_offset] =
+                byte ^ header[client->rx_header_length - 4U +
+                              (client->rx_offset & 3U)];
+        }
+        client->rx_offset++;
+        return (client->rx_offset == client->rx_length)
+                   ? http_ws_frame_end(client)
+                   : HTTP_WS_RX_MORE;
+    }
+
+    header[client->rx_header_length++] = byte;
+    if (client->rx_header_length < 2U)
+    {
+        return HTTP_WS_RX_MORE;
+    }
+    if ((header[1] & 0x80U) == 0U)
+    {
+        /* Frames from a client must be masked */
+        return HTTP_WS_RX_ERROR;
+    }
+
+    length = header[1] & 0x7FU;
+    needed = (length == 126U) ? 8U : ((length == 127U) ? 14U : 6U);
+    if (client->rx_header_length < needed)
+    {
+        return HTTP_WS_RX_MORE;
+    }
+
+    if (length == 126U)
+    {
+        length = ((uint32_t)header[2] << 8) | header[3];
+    }
+    else if (length == 127U)
+    {
+        if ((header[2] | header[3] | header[4] | header[5]) != 0U)
+        {
+            return HTTP_WS_RX_ERROR;
+        }
+        length = ((uint32_t)header[6] << 24) | ((uint32_t)header[7] << 16) |
+                 ((uint32_t)header[8] << 8) | header[9];
+    }
+    else
+    {
+        /* Length in the second byte */
+    }
+
+    /* Control frames are short and never fragmented */
+    if (((header[0] & 0x08U) != 0U) &&
+        ((length > HTTP_WS_CONTROL_MAX) || ((header[0] & HTTP_WS_FIN) == 0U)))
+    {
+        return HTTP_WS_RX_ERROR;
+    }
+
+    client->rx_length  = length;
+    client->rx_offset  = 0U;
+    client->rx_payload = true;
+    if (length == 0U)
+    {
+        return http_ws_frame_end(client);
+    }
+
+    return HTTP_WS_RX_MORE;
+}
+
+/**
+ * @brief tcp_recv() callback: read the client's frames
+ */
+static err_t http_ws_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p,
+                          err_t err)
+{
+    http_ws_client_t *client = (http_ws_client_t *)arg;
+    http_ws_rx_t      rx     = HTTP_WS_RX_MORE;
+    uint8_t           code[2];
+
+    if (p == NULL)
+    {
+        return http_ws_close(client, false);
+    }
+    if (err != ERR_OK)
+    {
+        pbuf_free(p);
+        return err;
+    }
+
+    for (uint16_t i = 0U; (i < p->tot_len) && (rx == HTTP_WS_RX_MORE); i++)
+    {
+        rx = http_ws_parse(client, pbuf_get_at(p, i));
+    }
+
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    if (rx == HTTP_WS_RX_ERROR)
+    {
+        LOG("WS: Protocol error, resetting\n");
+        return http_ws_close(client, true);
+    }
+    if (rx == HTTP_WS_RX_CLOSE)
+    {
+        /* Echo the client's status, or a normal closure */
+        if (client->rx_length >= 2U)
+        {
+            code[0] = client->control[0];
+            code[1] = client->control[1];
+        }
+        else
+        {
+            code[0] = (uint8_t)(HTTP_WS_CLOSE_NORMAL >> 8);
+            code[1] = (uint8_t)(HTTP_WS_CLOSE_NORMAL & 0xFFU);
+        }
+        http_ws_control(client, HTTP_WS_OP_CLOSE, code, sizeof(code));
+        return http_ws_close(client, false);
+    }
+
+    (void)tcp_output(pcb);
+    return ERR_OK;
+}
+
+/**
+ * @brief tcp_sent() callback: send more of the queue
+ */
+static err_t http_ws_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+    http_ws_client_t *client = (http_ws_client_t *)arg;
+
+    (void)pcb;
+    (void)len;
+
+    client->last_ack = xTaskGetTickCount();
+    return http_ws_flush(client);
+}
+
+/**
+ * @brief tcp_err() callback: the PCB is already freed by lwIP
+ */
+static void http_ws_error(void *arg, err_t err)
+{
+    http_ws_client_t *client = (http_ws_client_t *)arg;
+
+    LOG("WS: Connection error: %d\n", err);
+    if (client != NULL)
+    {
+        client->pcb = NULL;
+    }
+}
+
+/**
+ * @brief tcp_poll() callback: reset a client that stopped reading
+ */
+static err_t http_ws_poll(void *arg, struct tcp_pcb *pcb)
+{
+    http_ws_client_t *client = (http_ws_client_t *)arg;
+    TickType_t        idle   = xTaskGetTickCount() - client->last_ack;
+
+    if ((tcp_sndbuf(pcb) < TCP_SND_BUF) &&
+        (idle >= pdMS_TO_TICKS(HTTP_WS_STALL_TIMEOUT_MS)))
+    {
+        LOG("WS: Client stalled, resetting\n");
+        return http_ws_close(client, true);
+    }
+
+    return http_ws_flush(client);
+}
+
+/**
+ * @brief Push task: fan each live data message out to the clients
+ */
+static void http_ws_task(void *pvParameters)
+{
+    uint8_t frame[HTTP_WS_MESSAGE_MAX];
+
+    (void)pvParameters;
+
+    for (;;)
+    {
+        msg_bus_msg_t *msg = msg_bus_receive(&s_sub, portMAX_DELAY);
+        uint8_t        length;
+
+        if (msg == NULL)
+        {
+            continue;
+        }
+
+        if (msg_bus_topic(msg) == live_data_frames())
+        {
+            length = http_ws_encode_frame(
+                frame, (const live_data_frame_t *)msg_bus_payload(msg));
+        }
+        else
+        {
+            length = http_ws_encode_event(
+                frame, (const live_data_event_t *)msg_bus_payload(msg));
+        }
+        msg_bus_release(msg);
+
+        LOCK_TCPIP_CORE();
+        for (uint32_t i = 0U; i < HTTP_WS_MAX_CLIENTS; i++)
+        {
+            if (s_clients[i].pcb != NULL)
+            {
+                http_ws_queue(&s_clients[i], frame, length);
+                (void)http_ws_flush(&s_clients[i]);
+            }
+        }
+        UNLOCK_TCPIP_CORE();
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+bool http_ws_accept(struct tcp_pcb *pcb, const char *key)
+{
+    http_ws_client_t *client = NULL;
+    char              accept[HTTP_WS_ACCEPT_LENGTH + 1U];
+    char              response[160];
+    int               length;
+
+    for (uint32_t i = 0U; (i < HTTP_WS_MAX_CLIENTS) && (client == NULL); i++)
+    {
+        if (s_clients[i].pcb == NULL)
+        {
+            client = &s_clients[i];
+        }
+    }
+    if (client == NULL)
+    {
+        LOG("WS: No free client slot\n");
+        return false;
+    }
+
+    http_ws_accept_value(key, accept);
+    length = jerry_snprintf(response, sizeof(response),
+                            "HTTP/1.1 101 Switching Protocols\r\n"
+                            "Upgrade: websocket\r\n"
+                            "Connection: Upgrade\r\n"
+                            "Sec-WebSocket-Accept: %s\r\n"
+                            "\r\n",
+                            accept);
+    if (tcp_write(pcb, response, (u16_t)length, TCP_WRITE_FLAG_COPY) !=
+        ERR_OK)
+    {
+        return false;
+    }
+
+    client->pcb              = pcb;
+    client->last_ack         = xTaskGetTickCount();
+    client->head             = 0U;
+    client->tail             = 0U;
+    client->lost             = 0U;
+    client->rx_header_length = 0U;
+    client->rx_payload       = false;
+    client->rx_length        = 0U;
+    client->rx_offset        = 0U;
+
+    /* An idle dashboard that vanished is found by keepalive; one that
+     * stops acknowledging, by the stall timeout */
+    ip_set_option(pcb, SOF_KEEPALIVE);
+    pcb->keep_idle  = HTTP_WS_KEEPALIVE_IDLE_MS;
+    pcb->keep_intvl = HTTP_WS_KEEPALIVE_INTERVAL_MS;
+
+    tcp_arg(pcb, client);
+    tcp_recv(pcb, http_ws_recv);
+    tcp_sent(pcb, http_ws_sent);
+    tcp_err(pcb, http_ws_error);
+    tcp_poll(pcb, http_ws_poll, HTTP_WS_POLL_INTERVAL);
+
+    (void)tcp_output(pcb);
+    LOG("WS: Client %u connected\n", (unsigned int)(client - s_clients));
+
+    return true;
+}
+
+void http_ws_start(void)
+{
+    msg_bus_subscriber_init(&s_sub);
+    (void)msg_bus_subscribe(live_data_frames(), &s_sub);
+    (void)msg_bus_subscribe(live_data_events(), &s_sub);
+
+    (void)xTaskCreateStatic(http_ws_task, "WsPush", HTTP_WS_TASK_STACK_SIZE,
+                            NULL, TASK_PRIO_WS_PUSH, s_task_stack,
+                            &s_task_tcb);
+}
+
+#endif /* HTTP_SERVER */
@@ -0,0 +1,668 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Local Interlocks
+ *
+ * The rule states, the held outputs and the expander transfer belong to
+ * the filter task. The event ring and the status are shared with the
+ * readers: an event goes into the ring in one short critical section
+ * together with the count of events recorded, and the status is published
+ * in another once per block, and after a watchdog trip, so a reader
+ * always copies a consistent set. The sample counts of the low-latency
+ * rules belong to the ADC1 interrupt, which hands the rules due to trip
+ * over in a third. See interlock.h.
+ */
+
+#include "interlock.h"
+
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "jerry_device_registers.h"
+#include "live_data.h"
+#include "nor_log.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Number of rules, from the generated table */
+#define INTERLOCK_RULES JERRY_DEVICE_INTERLOCK_COUNT
+
+/** Timestamp ticks per microsecond */
+#define INTERLOCK_TICKS_PER_US (BSP_ADC1_TIMESTAMP_HZ / 1000000UL)
+
+/** The input of a rule is filtered sample by sample */
+#define INTERLOCK_LOW_LATENCY(input) \
+    (((BSP_ADC1_LOW_LATENCY_CHANNELS >> (input)) & 1U) != 0U)
+
+_Static_assert(INTERLOCK_RULES <= 16U,
+               "interlock rules must fit the 16-bit registers");
+_Static_assert(JERRY_DEVICE_INTERLOCK_MAX_INPUT < BSP_ADC1_NUM_CHANNELS,
+               "an interlock rule watches a channel that is not converted");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One recorded event
+ */
+typedef struct
+{
+    uint32_t sequence; /**< 1 for the first since boot */
+    uint64_t time_us;  /**< Capture time of the block, us since boot */
+    uint8_t  rule;     /**< Rule index */
+    uint8_t  kind;     /**< interlock_event_kind_t */
+    int16_t  value_mv; /**< Input value, mV */
+} interlock_event_t;
+
+/**
+ * @brief Evaluation state of one rule
+ */
+typedef struct
+{
+    uint32_t beyond;  /**< Consecutive blocks beyond the threshold */
+    bool     tripped; /**< Output held */
+} interlock_rule_state_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Rules disabled at run time, bit n for rule n */
+static volatile uint16_t s_disabled;
+
+/** Rules each analog watchdog trips, bit n for rule n */
+static volatile uint16_t s_watchdog_rules[BSP_ADC1_AWD_COUNT];
+
+/** Rules held by an active watchdog alarm */
+static uint16_t s_watchdog_held;
+
+/** Blocks beyond the threshold that trip each rule, set on the first call */
+static uint32_t s_trip_blocks[INTERLOCK_RULES];
+
+/** Whether s_trip_blocks is set */
+static bool s_started;
+
+/** Evaluation state of each rule */
+static interlock_rule_state_t s_rules[INTERLOCK_RULES];
+
+/** Samples beyond the threshold that trip each low-latency rule, at
+ * s_sample_rate */
+static volatile uint32_t s_trip_samples[INTERLOCK_RULES];
+
+/** Sample rate s_trip_samples was computed for, Hz */
+static uint32_t s_sample_rate;
+
+/** Consecutive samples beyond the threshold (ADC1 interrupt only) */
+static uint32_t s_sample_beyond[INTERLOCK_RULES];
+
+/** Low-latency rules due to trip and their inputs, guarded by a critical
+ * section */
+static uint16_t  s_sample_trips;
+static float32_t s_sample_values[INTERLOCK_RULES];
+
+/** Outputs held and their states, as last handed to BSP_I2CDO_Force() */
+static uint32_t s_force_mask;
+static uint32_t s_force_value;
+
+/** Outputs forced but not yet written to the expanders */
+static uint32_t s_unwritten;
+
+/** Expander transfer of the held outputs */
+static bsp_i2cdo_xfer_t s_xfer;
+
+/** Whether s_xfer was started and its result not yet taken */
+static bool s_writing;
+
+/** Event ring, guarded by a critical section */
+static interlock_event_t s_events[INTERLOCK_EVENT_COUNT];
+
+/** Events recorded since boot, guarded with the ring */
+static uint32_t s_recorded;
+
+/** Status of the last block, guarded by a critical section */
+static interlock_status_t s_status;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Check whether an input is beyond the threshold of a rule
+ *
+ * @param[in] rule  Rule
+ * @param[in] value Input value, V
+ * @return true if the rule would trip on @p value
+ */
+static bool interlock_beyond(const jerry_device_interlock_t *rule,
+                             float32_t                       value)
+{
+    return rule->above ? (value > rule->threshold)
+                       : (value < rule->threshold);
+}
+
+/**
+ * @brief Check whether an input is back past the hysteresis of a rule
+ *
+ * @param[in] rule  Rule
+ * @param[in] value Input value, V
+ * @return true if a tripped rule releases on @p value
+ */
+static bool interlock_back(const jerry_device_interlock_t *rule,
+                           float32_t                       value)
+{
+    return rule->above ? (value <= (rule->threshold - rule->hysteresis))
+                       : (value >= (rule->threshold + rule->hysteresis));
+}
+
+/**
+ * @brief Record an event of the current block
+ *
+ * @param[in]     rule    Rule index
+ * @param[in]     kind    What happened
+ * @param[in]     value   Input value, V
+ * @param[in,out] time_us Capture time of the block, read on the first
+ *                        event of the block (0 until then)
+ */
+static void interlock_record(uint8_t rule, interlock_event_kind_t kind,
+                             float32_t value, uint64_t *time_us)
+{
+    interlock_event_t event;
+    float32_t         mv = value * 1000.0f;
+
+    if (*time_us == 0U)
+    {
+        uint64_t ticks = 0U;
+
+        (void)BSP_ADC1_GetFilteredTimestamp(&ticks);
+        *time_us = ticks / INTERLOCK_TICKS_PER_US;
+    }
+
+    /* Only this task writes the ring, so the count is current */
+    event.sequence = s_recorded + 1U;
+    event.time_us  = *time_us;
+    event.rule     = rule;
+    event.kind     = (uint8_t)kind;
+    if (mv >= 32767.0f)
+    {
+        event.value_mv = 32767;
+    }
+    else if (mv <= -32768.0f)
+    {
+        event.value_mv = -32768;
+    }
+    else
+    {
+        event.value_mv = (int16_t)mv;
+    }
+
+    taskENTER_CRITICAL();
+    s_events[s_recorded % INTERLOCK_EVENT_COUNT] = event;
+    s_recorded++;
+    taskEXIT_CRITICAL();
+
+#if BSP_SPINOR_ENABLE
+    nor_log_event(NOR_LOG_SOURCE_INTERLOCK, (uint8_t)kind, rule,
+                  (int32_t)event.value_mv);
+#endif
+#if HTTP_SERVER
+    live_data_event(LIVE_DATA_SOURCE_INTERLOCK, (uint8_t)kind, rule,
+                    (int32_t)event.value_mv);
+#endif
+}
+
+/**
+ * @brief Write the held outputs until the expanders hold them
+ *
+ * @param[in,out] status Write error count to update
+ */
+static void interlock_commit(interlock_status_t *status)
+{
+    bsp_error_t err;
+
+    if (!BSP_I2CDO_IsDone(&s_xfer))
+    {
+        return;
+    }
+
+    if (s_writing)
+    {
+        s_writing = false;
+        if (s_xfer.status != BSP_OK)
+        {
+            status->write_errors++;
+        }
+    }
+
+    /* An output released before it was written is still written once */
+    s_unwritten = (s_unwritten | s_force_mask) &
+                  (BSP_I2CDO_GetCommitted() ^ BSP_I2CDO_GetShadow());
+    if (s_unwritten == 0U)
+    {
+        return;
+    }
+
+    /* A Modbus write in flight also writes the forced states */
+    err = BSP_I2CDO_CommitAsync(&s_xfer);
+    if (err == BSP_OK)
+    {
+        s_writing = true;
+    }
+    else if (err != BSP_BUSY)
+    {
+        status->write_errors++;
+    }
+    else
+    {
+        /* Retried on the next block */
+    }
+}
+
+/**
+ * @brief Hold the outputs of the tripped rules and publish the status
+ *
+ * @param[in,out] status Status to publish; its tripped rules are set here
+ */
+static void interlock_apply(interlock_status_t *status)
+{
+    uint32_t mask  = 0U;
+    uint32_t state = 0U;
+
+    status->tripped = 0U;
+    for (uint8_t r = 0U; r < INTERLOCK_RULES; r++)
+    {
+        const jerry_device_interlock_t *rule = &jerry_device_interlocks[r];
+
+        if (s_rules[r].tripped)
+        {
+            status->tripped |= (uint16_t)(1U << r);
+            mask |= 1UL << rule->output;
+            if (rule->state)
+            {
+                state |= 1UL << rule->output;
+            }
+        }
+    }
+
+    if ((mask != s_force_mask) || (state != s_force_value))
+    {
+        BSP_I2CDO_Force(mask, state);
+        s_force_mask  = mask;
+        s_force_value = state;
+    }
+    interlock_commit(status);
+
+    taskENTER_CRITICAL();
+    status->events = s_recorded;
+    s_status       = *status;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Value of a header record of the event file
+ *
+ * @param[in] record   Record, below INTERLOCK_HEADER_RECORDS
+ * @param[in] recorded Events recorded since boot
+ * @param[in] count    Events in the file
+ * @return Record value
+ */
+static uint16_t interlock_header_record(uint32_t record, uint32_t recorded,
+                                        uint32_t count)
+{
+    uint16_t value;
+
+    switch (record)
+    {
+        case 0U:
+            value = INTERLOCK_MAGIC;
+            break;
+        case 1U:
+            value = INTERLOCK_VERSION;
+            break;
+        case 2U:
+            value = INTERLOCK_HEADER_RECORDS;
+            break;
+        case 3U:
+            value = INTERLOCK_EVENT_RECORDS;
+            break;
+        case 4U:
+            value = (uint16_t)count;
+            break;
+        case 6U:
+            value = (uint16_t)(recorded >> 16U);
+            break;
+        case 7U:
+            value = (uint16_t)recorded;
+            break;
+        default:
+            value = 0U;
+            break;
+    }
+
+    return value;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void interlock_process(const float32_t *values)
+{
+    interlock_status_t status;
+    uint64_t           time_us = 0U;
+    uint16_t           disabled;
+
+    if (!BSP_ADC1_IsFilterSettled())
+    {
+        return;
+    }
+
+    if (!s_started)
+    {
+        for (uint32_t r = 0U; r < INTERLOCK_RULES; r++)
+        {
+            uint64_t delay_us =
+                (uint64_t)jerry_device_interlocks[r].delay_ms * 1000U;
+
+            s_trip_blocks[r] =
+                (uint32_t)((delay_us + INTERLOCK_BLOCK_US - 1U) /
+                           INTERLOCK_BLOCK_US);
+        }
+        s_started = true;
+    }
+
+    if (BSP_ADC1_GetSampleRate() != s_sample_rate)
+    {
+        s_sample_rate = BSP_ADC1_GetSampleRate();
+        for (uint32_t r = 0U; r < INTERLOCK_RULES; r++)
+        {
+            uint64_t delay =
+                (uint64_t)jerry_device_interlocks[r].delay_ms * s_sample_rate;
+
+            s_trip_samples[r] = (uint32_t)((delay + 999U) / 1000U);
+        }
+    }
+
+    taskENTER_CRITICAL();
+    status = s_status;
+    taskEXIT_CRITICAL();
+
+    disabled = s_disabled;
+    for (uint8_t r = 0U; r < INTERLOCK_RULES; r++)
+    {
+        const jerry_device_interlock_t *rule  = &jerry_device_interlocks[r];
+        interlock_rule_state_t         *rs    = &s_rules[r];
+        float32_t                       value = values[rule->input];
+
+        if (!rule->enabled || ((disabled & (1U << r)) != 0U))
+        {
+            if (rs->tripped)
+            {
+                interlock_record(r, INTERLOCK_EVENT_DISABLED, value, &time_us);
+            }
+            rs->tripped = false;
+            rs->beyond  = 0U;
+            continue;
+        }
+
+        if (!rs->tripped && INTERLOCK_LOW_LATENCY(rule->input))
+        {
+            /* Tripped on samples by interlock_sample_alarm() */
+        }
+        else if (!rs->tripped)
+        {
+            rs->beyond = interlock_beyond(rule, value) ? (rs->beyond + 1U)
+                                                       : 0U;
+            /* The first block beyond starts the delay */
+            if (rs->beyond > s_trip_blocks[r])
+            {
+                rs->tripped = true;
+                interlock_record(r, INTERLOCK_EVENT_TRIPPED, value, &time_us);
+            }
+        }
+        else if (((s_watchdog_held & (1U << r)) == 0U) &&
+                 interlock_back(rule, value))
+        {
+            rs->tripped = false;
+            rs->beyond  = 0U;
+            interlock_record(r, INTERLOCK_EVENT_RELEASED, value, &time_us);
+        }
+        else
+        {
+            /* Still tripped */
+        }
+    }
+
+    interlock_apply(&status);
+}
+
+void interlock_set_disabled(uint16_t mask) { s_disabled = mask; }
+
+void interlock_set_watchdog_rules(uint8_t awd, uint16_t rules)
+{
+    if (awd < BSP_ADC1_AWD_COUNT)
+    {
+        s_watchdog_rules[awd] = rules;
+    }
+}
+
+void interlock_watchdog(uint32_t raised, uint32_t active)
+{
+    interlock_status_t status;
+    uint64_t           time_us  = 0U;
+    uint16_t           disabled = s_disabled;
+    uint16_t           trip     = 0U;
+    bool               tripped  = false;
+
+    s_watchdog_held = 0U;
+    for (uint8_t awd = 0U; awd < BSP_ADC1_AWD_COUNT; awd++)
+    {
+        if ((active & (1UL << awd)) != 0U)
+        {
+            s_watchdog_held |= s_watchdog_rules[awd];
+        }
+        if ((raised & (1UL << awd)) != 0U)
+        {
+            trip |= s_watchdog_rules[awd];
+        }
+    }
+
+    for (uint8_t r = 0U; r < INTERLOCK_RULES; r++)
+    {
+        const jerry_device_interlock_t *rule  = &jerry_device_interlocks[r];
+        interlock_rule_state_t         *rs    = &s_rules[r];
+        float32_t                       value = 0.0f;
+
+        if (((trip & (1U << r)) == 0U) || rs->tripped || !rule->enabled ||
+            ((disabled & (1U << r)) != 0U))
+        {
+            continue;
+        }
+
+        (void)BSP_ADC1_GetFilteredValue(rule->input, &value);
+        rs->tripped = true;
+        interlock_record(r, INTERLOCK_EVENT_WATCHDOG, value, &time_us);
+        tripped = true;
+    }
+
+    /* Alarms that only cleared leave the outputs to the next block */
+    if (tripped)
+    {
+        taskENTER_CRITICAL();
+        status = s_status;
+        taskEXIT_CRITICAL();
+
+        interlock_apply(&status);
+    }
+}
+
+bool interlock_sample(const float32_t *values)
+{
+    uint16_t disabled = s_disabled;
+    bool     due      = false;
+
+    if (!s_started)
+    {
+        return false;
+    }
+
+    for (uint8_t r = 0U; r < INTERLOCK_RULES; r++)
+    {
+        const jerry_device_interlock_t *rule = &jerry_device_interlocks[r];
+        float32_t                       value;
+
+        if (!INTERLOCK_LOW_LATENCY(rule->input))
+        {
+            continue;
+        }
+
+        value = values[rule->input];
+        if (s_rules[r].tripped || !rule->enabled ||
+            ((disabled & (1U << r)) != 0U) || !interlock_beyond(rule, value))
+        {
+            s_sample_beyond[r] = 0U;
+            continue;
+        }
+
+        /* The first sample beyond starts the delay */
+        s_sample_beyond[r]++;
+        if ((s_sample_beyond[r] > s_trip_samples[r]) &&
+            ((s_sample_trips & (1U << r)) == 0U))
+        {
+            s_sample_trips     |= (uint16_t)(1U << r);
+            s_sample_values[r]  = value;
+            due                 = true;
+        }
+    }
+
+    return due;
+}
+
+void interlock_sample_alarm(void)
+{
+    interlock_status_t status;
+    float32_t          values[INTERLOCK_RULES];
+    uint64_t           time_us  = 0U;
+    uint16_t           disabled = s_disabled;
+    uint16_t           trip;
+    bool               tripped  = false;
+
+    taskENTER_CRITICAL();
+    trip           = s_sample_trips;
+    s_sample_trips = 0U;
+    for (uint8_t r = 0U; r < INTERLOCK_RULES; r++)
+    {
+        values[r] = s_sample_values[r];
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t r = 0U; r < INTERLOCK_RULES; r++)
+    {
+        const jerry_device_interlock_t *rule = &jerry_device_interlocks[r];
+        interlock_rule_state_t         *rs   = &s_rules[r];
+
+        if (((trip & (1U << r)) == 0U) || rs->tripped || !rule->enabled ||
+            ((disabled & (1U << r)) != 0U))
+        {
+            continue;
+        }
+
+        rs->tripped = true;
+        rs->beyond  = 0U;
+        interlock_record(r, INTERLOCK_EVENT_TRIPPED, values[r], &time_us);
+        tripped = true;
+    }
+
+    if (tripped)
+    {
+        taskENTER_CRITICAL();
+        status = s_status;
+        taskEXIT_CRITICAL();
+
+        interlock_apply(&status);
+    }
+}
+
+void interlock_get_status(interlock_status_t *status)
+{
+    if (status == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *status = s_status;
+    taskEXIT_CRITICAL();
+}
+
+modbus_exception_t interlock_read_file_record(uint16_t  file_number,
+                                              uint16_t  record_number,
+                                              uint16_t  record_length,
+                                              uint16_t *values)
+{
+    uint32_t recorded;
+    uint32_t count;
+
+    taskENTER_CRITICAL();
+    recorded = s_recorded;
+    taskEXIT_CRITICAL();
+
+    count = (recorded < INTERLOCK_EVENT_COUNT) ? recorded
+                                               : INTERLOCK_EVENT_COUNT;
+    if ((file_number != INTERLOCK_FILE_NUMBER) ||
+        (((uint32_t)record_number + record_length) >
+         (INTERLOCK_HEADER_RECORDS + (count * INTERLOCK_EVENT_RECORDS))))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    for (uint32_t i = 0U; i < record_length; i++)
+    {
+        uint32_t          record = (uint32_t)record_number + i;
+        uint32_t          slot;
+        uint32_t          field;
+        interlock_event_t event;
+
+        if (record < INTERLOCK_HEADER_RECORDS)
+        {
+            values[i] = interlock_header_record(record, recorded, count);
+            continue;
+        }
+
+        /* Event n of the file is the n-th oldest of those counted above */
+        record -= INTERLOCK_HEADER_RECORDS;
+        slot  = (recorded - count) + (record / INTERLOCK_EVENT_RECORDS);
+        field = record % INTERLOCK_EVENT_RECORDS;
+        taskENTER_CRITICAL();
+        event = s_events[slot % INTERLOCK_EVENT_COUNT];
+        taskEXIT_CRITICAL();
+
+        switch (field)
+        {
+            case 0U:
+                values[i] = (uint16_t)(event.sequence >> 16U);
+                break;
+            case 1U:
+                values[i] = (uint16_t)event.sequence;
+                break;
+            case 6U:
+                values[i] = (uint16_t)(((uint16_t)event.kind << 8U) |
+                                       (uint16_t)event.rule);
+                break;
+            case 7U:
+                values[i] = (uint16_t)event.value_mv;
+                break;
+            default:
+                /* Capture time, fields 2 to 5 */
+                values[i] =
+                    (uint16_t)(event.time_us >> (16U * (5U - field)));
+                break;
+        }
+    }
+
+    return MODBUS_EXCEPTION_NONE;
+}
@@ -0,0 +1,563 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Allocation-Free Formatter
+ *
+ * One pass over the format: literal text is copied, each conversion is
+ * parsed into a spec and written through one output cursor that counts
+ * every character but stores only those that fit. Integers are converted
+ * into a digit buffer from the least significant digit, in 32-bit
+ * arithmetic while the value fits, so the common case avoids the 64-bit
+ * division helper. Reentrant: all state is on the caller's stack. See
+ * jerry_printf.h.
+ */
+
+#include "jerry_printf.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/** Digits of the longest conversion, a 64-bit value in octal */
+#define JERRY_PRINTF_DIGITS 22U
+
+/** Flags of a conversion */
+#define FLAG_LEFT  0x01U /**< '-' */
+#define FLAG_ZERO  0x02U /**< '0' */
+#define FLAG_PLUS  0x04U /**< '+' */
+#define FLAG_SPACE 0x08U /**< ' ' */
+#define FLAG_ALT   0x10U /**< '#' */
+
+/**
+ * @brief Length modifier of a conversion
+ */
+typedef enum
+{
+    LENGTH_INT,       /**< None */
+    LENGTH_CHAR,      /**< hh */
+    LENGTH_SHORT,     /**< h */
+    LENGTH_LONG,      /**< l */
+    LENGTH_LONG_LONG, /**< ll */
+    LENGTH_SIZE,      /**< z */
+    LENGTH_PTRDIFF,   /**< t */
+    LENGTH_INTMAX,    /**< j */
+} length_t;
+
+/**
+ * @brief One parsed conversion
+ */
+typedef struct
+{
+    uint8_t  flags;     /**< FLAG_* */
+    length_t length;    /**< Length modifier */
+    size_t   width;     /**< Minimum field width */
+    int      precision; /**< Precision, -1 if none */
+} spec_t;
+
+/**
+ * @brief Output cursor
+ */
+typedef struct
+{
+    char  *buffer; /**< Destination */
+    size_t size;   /**< Size of the destination */
+    size_t length; /**< Characters produced, stored or not */
+} output_t;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Produce one character, stored while it fits
+ */
+static void put_char(output_t *out, char c)
+{
+    if ((out->length + 1U) < out->size)
+    {
+        out->buffer[out->length] = c;
+    }
+    out->length++;
+}
+
+/**
+ * @brief Produce a character several times
+ */
+static void put_repeat(output_t *out, char c, size_t count)
+{
+    for (size_t i = 0U; i < count; i++)
+    {
+        put_char(out, c);
+    }
+}
+
+/**
+ * @brief Padding a field of @p used characters needs to reach the width
+ */
+static size_t padding(const spec_t *spec, size_t used)
+{
+    return (spec->width > used) ? (spec->width - used) : 0U;
+}
+
+/**
+ * @brief Convert a value into digits, least significant first
+ *
+ * @return Number of digits
+ */
+static size_t to_digits(uint64_t value, uint32_t base, bool upper,
+                        char digits[JERRY_PRINTF_DIGITS])
+{
+    const char *set   = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    size_t      count = 0U;
+
+    while (value > UINT32_MAX)
+    {
+        digits[count] = set[value % base];
+        value /= base;
+        count++;
+    }
+
+    for (uint32_t word = (uint32_t)value; word != 0U; word /= base)
+    {
+        digits[count] = set[word % base];
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Write an integer conversion
+ *
+ * @param[in] value    Magnitude
+ * @param[in] negative Value is negative
+ * @param[in] base     8, 10 or 16
+ * @param[in] upper    Upper case hexadecimal digits
+ */
+static void put_integer(output_t *out, const spec_t *spec, uint64_t value,
+                        bool negative, uint32_t base, bool upper)
+{
+    char   digits[JERRY_PRINTF_DIGITS];
+    size_t count = to_digits(value, base, upper, digits);
+    size_t zeros = 0U;
+    size_t used;
+    size_t pad;
+    char   sign   = '\0';
+    bool   prefix = ((spec->flags & FLAG_ALT) != 0U) && (base == 16U) &&
+                  (value != 0U);
+
+    /* Zero printed with no digits only at an explicit zero precision */
+    if ((count == 0U) && (spec->precision != 0))
+    {
+        digits[0] = '0';
+        count     = 1U;
+    }
+
+    if ((spec->precision > 0) && ((size_t)spec->precision > count))
+    {
+        zeros = (size_t)spec->precision - count;
+    }
+    if (((spec->flags & FLAG_ALT) != 0U) && (base == 8U) && (zeros == 0U) &&
+        ((count == 0U) || (digits[count - 1U] != '0')))
+    {
+        zeros = 1U;
+    }
+
+    if (negative)
+    {
+        sign = '-';
+    }
+    else if ((spec->flags & FLAG_PLUS) != 0U)
+    {
+        sign = '+';
+    }
+    else if ((spec->flags & FLAG_SPACE) != 0U)
+    {
+        sign = ' ';
+    }
+    else
+    {
+        /* Unsigned or positive without a sign flag */
+    }
+
+    used = count + zeros + ((sign != '\0') ? 1U : 0U) + (prefix ? 2U : 0U);
+    pad  = padding(spec, used);
+
+    /* The 0 flag pads with zeros after the sign, unless a precision or
+     * the - flag is given */
+    if (((spec->flags & FLAG_ZERO) != 0U) &&
+        ((spec->flags & FLAG_LEFT) == 0U) && (spec->precision < 0))
+    {
+        zeros += pad;
+        pad = 0U;
+    }
+
+    if ((spec->flags & FLAG_LEFT) == 0U)
+    {
+        put_repeat(out, ' ', pad);
+    }
+    if (sign != '\0')
+    {
+        put_char(out, sign);
+    }
+    if (prefix)
+    {
+        put_char(out, '0');
+        put_char(out, upper ? 'X' : 'x');
+    }
+    put_repeat(out, '0', zeros);
+    while (count > 0U)
+    {
+        count--;
+        put_char(out, digits[count]);
+    }
+    if ((spec->flags & FLAG_LEFT) != 0U)
+    {
+        put_repeat(out, ' ', pad);
+    }
+}
+
+/**
+ * @brief Write a string conversion
+ */
+static void put_string(output_t *out, const spec_t *spec, const char *text)
+{
+    size_t length = 0U;
+    size_t pad;
+
+    if (text == NULL)
+    {
+        text = "(null)";
+    }
+
+    /* Never read past the precision, the string need not be terminated */
+    while ((text[length] != '\0') &&
+           ((spec->precision < 0) || (length < (size_t)spec->precision)))
+    {
+        length++;
+    }
+
+    pad = padding(spec, length);
+    if ((spec->flags & FLAG_LEFT) == 0U)
+    {
+        put_repeat(out, ' ', pad);
+    }
+    for (size_t i = 0U; i < length; i++)
+    {
+        put_char(out, text[i]);
+    }
+    if ((spec->flags & FLAG_LEFT) != 0U)
+    {
+        put_repeat(out, ' ', pad);
+    }
+}
+
+/**
+ * @brief Fetch a signed argument of the spec's length
+ */
+static int64_t fetch_signed(const spec_t *spec, va_list *ap)
+{
+    switch (spec->length)
+    {
+        case LENGTH_CHAR:
+            return (signed char)va_arg(*ap, int);
+        case LENGTH_SHORT:
+            return (short)va_arg(*ap, int);
+        case LENGTH_LONG:
+            return va_arg(*ap, long);
+        case LENGTH_LONG_LONG:
+            return va_arg(*ap, long long);
+        case LENGTH_SIZE:
+        case LENGTH_PTRDIFF:
+            return va_arg(*ap, ptrdiff_t);
+        case LENGTH_INTMAX:
+            return va_arg(*ap, intmax_t);
+        case LENGTH_INT:
+        default:
+            return va_arg(*ap, int);
+    }
+}
+
+/**
+ * @brief Fetch an unsigned argument of the spec's length
+ */
+static uint64_t fetch_unsigned(const spec_t *spec, va_list *ap)
+{
+    switch (spec->length)
+    {
+        case LENGTH_CHAR:
+            return (unsigned char)va_arg(*ap, unsigned int);
+        case LENGTH_SHORT:
+            return (unsigned short)va_arg(*ap, unsigned int);
+        case LENGTH_LONG:
+            return va_arg(*ap, unsigned long);
+        case LENGTH_LONG_LONG:
+            return va_arg(*ap, unsigned long long);
+        case LENGTH_SIZE:
+        case LENGTH_PTRDIFF:
+            return va_arg(*ap, size_t);
+        case LENGTH_INTMAX:
+            return va_arg(*ap, uintmax_t);
+        case LENGTH_INT:
+        default:
+            return va_arg(*ap, unsigned int);
+    }
+}
+
+/**
+ * @brief Parse flags, width, precision and length of a conversion
+ *
+ * @param[in]     format Character after the '%'
+ * @param[out]    spec   Receives the conversion
+ * @param[in,out] ap     Arguments, for a * width or precision
+ * @return Position of the conversion character
+ */
+static const char *parse_spec(const char *format, spec_t *spec, va_list *ap)
+{
+    spec->flags     = 0U;
+    spec->length    = LENGTH_INT;
+    spec->width     = 0U;
+    spec->precision = -1;
+
+    for (;; format++)
+    {
+        uint8_t flag;
+
+        switch (*format)
+        {
+            case '-':
+                flag = FLAG_LEFT;
+                break;
+            case '0':
+                flag = FLAG_ZERO;
+                break;
+            case '+':
+                flag = FLAG_PLUS;
+                break;
+            case ' ':
+                flag = FLAG_SPACE;
+                break;
+            case '#':
+                flag = FLAG_ALT;
+                break;
+            default:
+                flag = 0U;
+                break;
+        }
+        if (flag == 0U)
+        {
+            break;
+        }
+        spec->flags |= flag;
+    }
+
+    if (*format == '*')
+    {
+        int width = va_arg(*ap, int);
+
+        /* A negative width is the - flag */
+        if (width < 0)
+        {
+            spec->flags |= FLAG_LEFT;
+            width = -width;
+        }
+        spec->width = (size_t)width;
+        format++;
+    }
+    while ((*format >= '0') && (*format <= '9'))
+    {
+        spec->width = (spec->width * 10U) + (size_t)(*format - '0');
+        format++;
+    }
+
+    if (*format == '.')
+    {
+        format++;
+        spec->precision = 0;
+        if (*format == '*')
+        {
+            /* A negative precision is taken as none */
+            spec->precision = va_arg(*ap, int);
+            if (spec->precision < 0)
+            {
+                spec->precision = -1;
+            }
+            format++;
+        }
+        while ((*format >= '0') && (*format <= '9'))
+        {
+            spec->precision = (spec->precision * 10) + (*format - '0');
+            format++;
+        }
+    }
+
+    switch (*format)
+    {
+        case 'h':
+            format++;
+            spec->length = LENGTH_SHORT;
+            if (*format == 'h')
+            {
+                format++;
+                spec->length = LENGTH_CHAR;
+            }
+            break;
+        case 'l':
+            format++;
+            spec->length = LENGTH_LONG;
+            if (*format == 'l')
+            {
+                format++;
+                spec->length = LENGTH_LONG_LONG;
+            }
+            break;
+        case 'z':
+            format++;
+            spec->length = LENGTH_SIZE;
+            break;
+        case 't':
+            format++;
+            spec->length = LENGTH_PTRDIFF;
+            break;
+        case 'j':
+            format++;
+            spec->length = LENGTH_INTMAX;
+            break;
+        default:
+            break;
+    }
+
+    return format;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+int jerry_vsnprintf(char *buffer, size_t size, const char *format,
+                    va_list ap)
+{
+    output_t out = {buffer, size, 0U};
+    va_list  args;
+
+    va_copy(args, ap);
+
+    while (*format != '\0')
+    {
+        const char *start = format;
+        spec_t      spec;
+
+        if (*format != '%')
+        {
+            put_char(&out, *format);
+            format++;
+            continue;
+        }
+
+        format = parse_spec(format + 1, &spec, &args);
+
+        /* The sign flags only apply to signed conversions */
+        if ((*format != 'd') && (*format != 'i'))
+        {
+            spec.flags &= (uint8_t)~(FLAG_PLUS | FLAG_SPACE);
+        }
+
+        switch (*format)
+        {
+            case 'd':
+            case 'i':
+            {
+                int64_t value = fetch_signed(&spec, &args);
+                bool    neg   = value < 0;
+
+                /* The magnitude of INT64_MIN only fits unsigned */
+                put_integer(&out, &spec,
+                            neg ? (0U - (uint64_t)value) : (uint64_t)value,
+                            neg, 10U, false);
+                break;
+            }
+            case 'u':
+                put_integer(&out, &spec, fetch_unsigned(&spec, &args), false,
+                            10U, false);
+                break;
+            case 'o':
+                put_integer(&out, &spec, fetch_unsigned(&spec, &args), false,
+                            8U, false);
+                break;
+            case 'x':
+            case 'X':
+                put_integer(&out, &spec, fetch_unsigned(&spec, &args), false,
+                            16U, *format == 'X');
+                break;
+            case 'p':
+                spec.flags |= FLAG_ALT;
+                put_integer(&out, &spec,
+                            (uintptr_t)va_arg(args, const void *), false,
+                            16U, false);
+                break;
+            case 'c':
+            {
+                size_t pad = padding(&spec, 1U);
+
+                if ((spec.flags & FLAG_LEFT) == 0U)
+                {
+                    put_repeat(&out, ' ', pad);
+                }
+                put_char(&out, (char)va_arg(args, int));
+                if ((spec.flags & FLAG_LEFT) != 0U)
+                {
+                    put_repeat(&out, ' ', pad);
+                }
+                break;
+            }
+            case 's':
+                put_string(&out, &spec, va_arg(args, const char *));
+                break;
+            case '%':
+                put_char(&out, '%');
+                break;
+            default:
+                /* Not supported: copied as written, its argument left */
+                for (; start < format; start++)
+                {
+                    put_char(&out, *start);
+                }
+                if (*format != '\0')
+                {
+                    put_char(&out, *format);
+                }
+                break;
+        }
+
+        if (*format != '\0')
+        {
+            format++;
+        }
+    }
+
+    va_end(args);
+
+    if (size > 0U)
+    {
+        buffer[(out.length < size) ? out.length : (size - 1U)] = '\0';
+    }
+
+    return (out.length > (size_t)INT_MAX) ? INT_MAX : (int)out.length;
+}
+
+int jerry_snprintf(char *buffer, size_t size, const char *format, ...)
+{
+    va_list ap;
+    int     length;
+
+    va_start(ap, format);
+    length = jerry_vsnprintf(buffer, size, format, ap);
+    va_end(ap);
+
+    return length;
+}
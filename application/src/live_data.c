@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Live Data Topics
+ *
+ * The frame job keeps the sums of the frame in progress and loans a
+ * message only once the frame is complete, so a frame holds no message
+ * while it builds up and a dropped frame costs nothing but its sums. A gap
+ * or an overrun of the decimated stream ends the frame in progress without
+ * publishing it. See live_data.h.
+ */
+
+#include "live_data.h"
+
+#if HTTP_SERVER
+
+#include <stdbool.h>
+#include <string.h>
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Decimated samples copied out of the ring per read, one job period */
+#define LIVE_DATA_READ_CHUNK 16U
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Frame job state
+ */
+typedef struct
+{
+    bsp_adc1_reader_t reader; /**< Decimated ring cursor */
+    bool              active; /**< Reader attached */
+    bool              open;   /**< A frame is being summed */
+    float32_t sum[BSP_ADC1_NUM_CHANNELS]; /**< Sums of the frame */
+    uint32_t  count;          /**< Decimated samples in the frame */
+    uint32_t  frame_sequence; /**< Sequence the frame starts at */
+    uint32_t  frame_end;      /**< Sequence the next frame starts at */
+    uint64_t  frame_ns;       /**< Time of its start, 0 if unknown */
+    uint32_t  next_sequence;  /**< Sequence that continues the frame */
+} live_data_capture_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+MSG_BUS_TOPIC_DEFINE(s_frame_topic, live_data_frame_t,
+                     LIVE_DATA_FRAME_MESSAGES);
+MSG_BUS_TOPIC_DEFINE(s_event_topic, live_data_event_t,
+                     LIVE_DATA_EVENT_MESSAGES);
+
+static live_data_capture_t s_capture;
+
+/** Copy of the decimated ring, job only */
+static bsp_adc1_sample_t s_chunk[LIVE_DATA_READ_CHUNK];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Publish the completed frame, if a message is free
+ */
+static void live_data_publish_frame(const live_data_capture_t *capture)
+{
+    msg_bus_msg_t     *msg = msg_bus_loan(&s_frame_topic);
+    live_data_frame_t *frame;
+
+    if (msg == NULL)
+    {
+        /* Every message is still held by a subscriber */
+        return;
+    }
+
+    frame           = (live_data_frame_t *)msg_bus_payload(msg);
+    frame->time_ns  = capture->frame_ns;
+    frame->sequence = capture->frame_sequence;
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        frame->mean[ch] =
+            capture->sum[ch] / (float32_t)capture->count;
+    }
+    if (BSP_GPIODI_ReadAll(&frame->di) != BSP_OK)
+    {
+        frame->di = 0U;
+    }
+
+    msg_bus_publish(msg);
+}
+
+/**
+ * @brief Start a frame at a sample sequence
+ *
+ * A frame spans the samples of LIVE_DATA_FRAME_MS at the rate in force, as
+ * the NOR flash log's frames do (nor_log.c).
+ */
+static void live_data_open_frame(live_data_capture_t *capture,
+                                 uint32_t             sequence)
+{
+    capture->open           = true;
+    capture->count          = 0U;
+    capture->frame_sequence = sequence;
+    capture->frame_end      =
+        sequence + ((BSP_ADC1_GetSampleRate() * LIVE_DATA_FRAME_MS) / 1000U);
+    if (BSP_ADC1_GetSampleTimeNs(sequence, &capture->frame_ns) != BSP_OK)
+    {
+        capture->frame_ns = 0U;
+    }
+    (void)memset(capture->sum, 0, sizeof(capture->sum));
+}
+
+/**
+ * @brief Add one decimated sample to the frame
+ */
+static void live_data_sample(live_data_capture_t     *capture,
+                             const bsp_adc1_sample_t *sample)
+{
+    if (capture->open && (sample->sequence != capture->next_sequence))
+    {
+        capture->open = false;
+    }
+
+    if (!capture->open)
+    {
+        live_data_open_frame(capture, sample->sequence);
+    }
+
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        capture->sum[ch] += sample->filtered[ch];
+    }
+    capture->count++;
+    capture->next_sequence = sample->sequence + ADC_FILTER_DECIMATION_FACTOR;
+
+    if ((int32_t)(capture->next_sequence - capture->frame_end) >= 0)
+    {
+        live_data_publish_frame(capture);
+        live_data_open_frame(capture, capture->frame_end);
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void live_data_init(void)
+{
+    msg_bus_topic_init(&s_frame_topic);
+    msg_bus_topic_init(&s_event_topic);
+}
+
+msg_bus_topic_t *live_data_frames(void) { return &s_frame_topic; }
+
+msg_bus_topic_t *live_data_events(void) { return &s_event_topic; }
+
+void live_data_event(live_data_source_t source, uint8_t kind, uint16_t index,
+                     int32_t value)
+{
+    msg_bus_msg_t     *msg = msg_bus_loan(&s_event_topic);
+    live_data_event_t *event;
+
+    if (msg == NULL)
+    {
+        return;
+    }
+
+    event          = (live_data_event_t *)msg_bus_payload(msg);
+    event->time_ns = BSP_Time_NowNs();
+    event->value   = value;
+    event->index   = index;
+    event->source  = (uint8_t)source;
+    event->kind    = kind;
+
+    msg_bus_publish(msg);
+}
+
+void live_data_job(void)
+{
+    live_data_capture_t *capture = &s_capture;
+    uint32_t             count;
+
+    if (!capture->active)
+    {
+        (void)BSP_ADC1_RingReaderInit(&capture->reader,
+                                      BSP_ADC1_STREAM_DECIMATED);
+        capture->active = true;
+    }
+
+    do
+    {
+        if (BSP_ADC1_RingRead(&capture->reader, s_chunk, LIVE_DATA_READ_CHUNK,
+                              &count) != BSP_OK)
+        {
+            break;
+        }
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            live_data_sample(capture, &s_chunk[i]);
+        }
+    } while (count == LIVE_DATA_READ_CHUNK);
+}
+
+#endif /* HTTP_SERVER */
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Asynchronous Logging
+ *
+ * The ring is a bounded MPSC queue after D. Vyukov. Every slot carries a
+ * sequence number telling whose turn it is: a producer claims the slot at
+ * the enqueue position with a compare-and-swap once its sequence equals the
+ * position, fills it and publishes it by advancing the sequence. The single
+ * consumer takes a slot once it is published and hands it back one lap
+ * ahead. Producers never wait for each other, so an interrupt handler can
+ * log while it preempts a task in the middle of a record; the consumer
+ * simply stops at that record until the task has finished it.
+ */
+
+#include "log.h"
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "jerry_printf.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+#if (LOG_RING_SIZE & (LOG_RING_SIZE - 1U)) != 0U
+#error "LOG_RING_SIZE must be a power of two"
+#endif
+
+/** Mask of the slot index in a ring position */
+#define LOG_RING_MASK (LOG_RING_SIZE - 1U)
+
+/** Exception numbers of the fault handlers (NMI to SecureFault) */
+#define LOG_IPSR_FAULT_FIRST 2U
+#define LOG_IPSR_FAULT_LAST  7U
+
+/**
+ * @brief Ring slot
+ */
+typedef struct
+{
+    atomic_uint  sequence; /**< Position the slot is next due for */
+    log_record_t record;
+} log_slot_t;
+
+static log_slot_t s_ring[LOG_RING_SIZE];
+
+/** Next position to claim (producers) */
+static atomic_uint s_enqueue_pos;
+
+/** Next position to take (logging task only) */
+static unsigned int s_dequeue_pos;
+
+/** Records dropped on a full ring since the last log_take_dropped() */
+static atomic_uint s_dropped;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Claim the slot at the enqueue position
+ * @param[out] pos Position claimed
+ * @return The slot, or NULL if the ring is full; the caller counts the drop
+ */
+static log_slot_t *ring_claim(unsigned int *pos)
+{
+    unsigned int claim =
+        atomic_load_explicit(&s_enqueue_pos, memory_order_relaxed);
+
+    for (;;)
+    {
+        log_slot_t  *slot = &s_ring[claim & LOG_RING_MASK];
+        unsigned int seq =
+            atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int diff = (int)(seq - claim);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(
+                    &s_enqueue_pos, &claim, claim + 1U, memory_order_relaxed,
+                    memory_order_relaxed))
+            {
+                *pos = claim;
+                return slot;
+            }
+            /* Another producer won, claim now holds the new position */
+        }
+        else if (diff < 0)
+        {
+            /* Slot still holds the record of the previous lap */
+            return NULL;
+        }
+        else
+        {
+            claim = atomic_load_explicit(&s_enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Hand a filled slot to the consumer
+ */
+static void ring_publish(log_slot_t *slot, unsigned int pos)
+{
+    atomic_store_explicit(&slot->sequence, pos + 1U, memory_order_release);
+}
+
+/**
+ * @brief Count a record or text chunk lost on a full ring
+ */
+static void ring_count_drop(void)
+{
+    (void)atomic_fetch_add_explicit(&s_dropped, 1U, memory_order_relaxed);
+}
+
+/**
+ * @brief Wait a tick for the logging task to make room, if allowed
+ *
+ * @param[in,out] waited_ms Time waited so far for this text
+ * @return true after a wait, false if the text is to be dropped
+ */
+static bool log_wait_for_room(uint32_t *waited_ms)
+{
+#if LOG_BLOCK_ON_FULL
+    /* log_text() is only reached from a task or an unmasked interrupt */
+    if ((xPortIsInsideInterrupt() == pdFALSE) &&
+        (*waited_ms < LOG_BLOCK_MAX_MS))
+    {
+        vTaskDelay(1U);
+        *waited_ms += portTICK_PERIOD_MS;
+        return true;
+    }
+#else
+    (void)waited_ms;
+#endif
+
+    return false;
+}
+
+/**
+ * @brief Tick count in milliseconds, from task or interrupt context
+ */
+static uint32_t log_timestamp_ms(void)
+{
+    TickType_t ticks = (xPortIsInsideInterrupt() != pdFALSE)
+                           ? xTaskGetTickCountFromISR()
+                           : xTaskGetTickCount();
+
+    return (uint32_t)ticks * portTICK_PERIOD_MS;
+}
+
+/**
+ * @brief Whether text can be left to the logging task
+ *
+ * Not before the scheduler runs, and not in a fault handler or with
+ * interrupts masked, where the system is usually about to halt.
+ */
+static bool log_deferred(void)
+{
+    uint32_t ipsr = __get_IPSR();
+
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+    {
+        return false;
+    }
+    if ((ipsr >= LOG_IPSR_FAULT_FIRST) && (ipsr <= LOG_IPSR_FAULT_LAST))
+    {
+        return false;
+    }
+
+    return (__get_PRIMASK() == 0U) && (__get_BASEPRI() == 0U);
+}
+
+/**
+ * @brief Store text as raw text chunks
+ *
+ * @param text     Text, copied
+ * @param length   Number of bytes
+ * @param may_wait Whether a full ring may be waited on (LOG_BLOCK_ON_FULL)
+ */
+static void log_store_text(const char *text, size_t length, bool may_wait)
+{
+    uint32_t waited_ms = 0U;
+
+    while (length > 0U)
+    {
+        size_t       chunk = (length > LOG_TEXT_BYTES) ? LOG_TEXT_BYTES : length;
+        unsigned int pos;
+        log_slot_t  *slot = ring_claim(&pos);
+
+        if (slot == NULL)
+        {
+            if (may_wait && log_wait_for_room(&waited_ms))
+            {
+                continue;
+            }
+            ring_count_drop();
+            return;
+        }
+
+        slot->record.format       = NULL;
+        slot->record.timestamp_ms = log_timestamp_ms();
+        slot->record.length       = (uint8_t)chunk;
+        (void)memcpy(slot->record.args, text, chunk);
+        ring_publish(slot, pos);
+
+        text += chunk;
+        length -= chunk;
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void log_init(void)
+{
+    for (unsigned int i = 0U; i < LOG_RING_SIZE; i++)
+    {
+        atomic_init(&s_ring[i].sequence, i);
+    }
+    atomic_init(&s_enqueue_pos, 0U);
+    atomic_init(&s_dropped, 0U);
+    s_dequeue_pos = 0U;
+}
+
+void log_write(uint32_t arg_count, const char *format, ...)
+{
+    unsigned int pos;
+    log_slot_t  *slot = ring_claim(&pos);
+    va_list      ap;
+
+    if (slot == NULL)
+    {
+        ring_count_drop();
+        return;
+    }
+
+    if (arg_count > LOG_MAX_ARGS)
+    {
+        arg_count = LOG_MAX_ARGS;
+    }
+
+    slot->record.format       = format;
+    slot->record.timestamp_ms = log_timestamp_ms();
+    slot->record.length       = (uint8_t)arg_count;
+
+    va_start(ap, format);
+    for (uint32_t i = 0U; i < arg_count; i++)
+    {
+        slot->record.args[i] = va_arg(ap, uint32_t);
+    }
+    va_end(ap);
+
+    ring_publish(slot, pos);
+}
+
+void log_now(const char *format, ...)
+{
+    char    text[LOG_NOW_MAX_BYTES];
+    va_list ap;
+    int     length;
+
+    va_start(ap, format);
+    length = jerry_vsnprintf(text, sizeof(text), format, ap);
+    va_end(ap);
+
+    if (length < 0)
+    {
+        return;
+    }
+    if ((size_t)length >= sizeof(text))
+    {
+        length = (int)sizeof(text) - 1;
+    }
+
+    log_store_text(text, (size_t)length, false);
+}
+
+void log_text(const char *text, size_t length)
+{
+    log_store_text(text, length, true);
+}
+
+bool log_read(log_record_t *record)
+{
+    log_slot_t  *slot = &s_ring[s_dequeue_pos & LOG_RING_MASK];
+    unsigned int seq =
+        atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+    if (seq != (s_dequeue_pos + 1U))
+    {
+        return false;
+    }
+
+    *record = slot->record;
+    atomic_store_explicit(&slot->sequence, s_dequeue_pos + LOG_RING_SIZE,
+                          memory_order_release);
+    s_dequeue_pos++;
+
+    return true;
+}
+
+uint32_t log_take_dropped(void)
+{
+    return (uint32_t)atomic_exchange_explicit(&s_dropped, 0U,
+                                              memory_order_relaxed);
+}
+
+/**
+ * @brief newlib output hook, replaces the weak one of syscalls.c
+ *
+ * Sends printf() output through the ring, or straight to the console
+ * where the logging task cannot be relied on.
+ */
+int _write(int file, char *ptr, int len)
+{
+    (void)file;
+
+    if (len <= 0)
+    {
+        return 0;
+    }
+
+    if (log_deferred())
+    {
+        log_text(ptr, (size_t)len);
+    }
+    else
+    {
+        BSP_Console_Write((const uint8_t *)ptr, (uint16_t)len);
+    }
+
+    return len;
+}
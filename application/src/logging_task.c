@@ -1,23 +1,318 @@
 /*
  * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
  * All rights reserved.
+ *
+ * Logging Task
+ *
+ * Drains the log ring (log.h) to the console. Records are packed into a
+ * transmit buffer, which is sent by DMA once it is full or the ring is
+ * empty; the task then sleeps LOG_DRAIN_PERIOD_MS.
+ *
+ * By default the records are formatted here, with jerry_snprintf(), so the
+ * task needs no newlib formatter and its stack use is fixed; the formats
+ * of LOG() are within its subset. With LOG_BINARY they are sent
+ * as frames for tools/log_decoder.py instead, all integers little-endian:
+ *
+ *   0xA5 | kind | payload length | payload | checksum
+ *
+ *   kind 0  format record: timestamp_ms (u32), format address (u32),
+ *           arguments (u32 each)
+ *   kind 1  printf() text: the bytes
+ *   kind 2  records dropped: count (u32)
+ *
+ * The checksum makes the sum of kind, length, payload and checksum zero
+ * (mod 256).
+ *
+ * log_panic() takes the place of the task once a fault has stopped it: it
+ * sends the transmit buffer and the rest of the ring with the polled
+ * console writes. A buffer the task had handed to the DMA is left to it:
+ * the DMA is waited for before the buffer is filled again, so it is
+ * neither overwritten while sent nor sent again.
  */
 
+#include <string.h>
+
 #include "FreeRTOS.h"
 #include "app_tasks.h"
+#include "bsp.h"
+#include "jerry_printf.h"
+#include "log.h"
+#include "metrics.h"
+#include "supervisor.h"
 #include "task.h"
 
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Sleep between drains of an empty ring */
+#define LOG_DRAIN_PERIOD_MS 10U
+
+/** Supervisor deadline, several transmit buffers past their timeout */
+#define LOG_DEADLINE_MS 1000U
+
+/** Transmit buffer size */
+#define LOG_TX_BUFFER_SIZE 256U
+
+/** Time allowed for one transmit buffer (22 ms at 115200 baud) */
+#define LOG_TX_TIMEOUT_MS 100U
+
+#if LOG_BINARY
+#define LOG_FRAME_SYNC         0xA5U
+#define LOG_FRAME_KIND_FORMAT  0U
+#define LOG_FRAME_KIND_TEXT    1U
+#define LOG_FRAME_KIND_DROPPED 2U
+
+/** Largest payload: timestamp, format address and arguments */
+#define LOG_PAYLOAD_MAX ((2U + LOG_MAX_ARGS) * 4U)
+#endif
+
+static uint8_t  s_tx_buffer[LOG_TX_BUFFER_SIZE];
+static uint16_t s_tx_length;
+
+/** Set while the transmit buffer is handed to the DMA */
+static volatile bool s_tx_sending;
+
+/** Set once log_panic() has taken over the console */
+static volatile bool s_panic;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Send the transmit buffer
+ */
+static void log_flush(void)
+{
+    if (s_tx_length == 0U)
+    {
+        return;
+    }
+
+    if (s_panic)
+    {
+        BSP_Console_Write(s_tx_buffer, s_tx_length);
+    }
+    else
+    {
+        s_tx_sending = true;
+        (void)BSP_Console_Transmit(s_tx_buffer, s_tx_length,
+                                   LOG_TX_TIMEOUT_MS);
+        s_tx_sending = false;
+    }
+    s_tx_length = 0U;
+}
+
+#if LOG_BINARY
+
+/**
+ * @brief Append a u32 to a frame
+ */
+static uint8_t *put_u32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+/**
+ * @brief Append a frame to the transmit buffer
+ */
+static void log_emit_frame(uint8_t kind, const uint8_t *payload,
+                           uint8_t length)
+{
+    uint8_t *out;
+    uint8_t  sum = (uint8_t)(kind + length);
+
+    if ((s_tx_length + 4U + length) > LOG_TX_BUFFER_SIZE)
+    {
+        log_flush();
+    }
+
+    out    = &s_tx_buffer[s_tx_length];
+    out[0] = LOG_FRAME_SYNC;
+    out[1] = kind;
+    out[2] = length;
+    for (uint8_t i = 0U; i < length; i++)
+    {
+        out[3U + i] = payload[i];
+        sum         = (uint8_t)(sum + payload[i]);
+    }
+    out[3U + length] = (uint8_t)(0U - sum);
+    s_tx_length      = (uint16_t)(s_tx_length + 4U + length);
+}
+
+/**
+ * @brief Append a record as a frame
+ */
+static void log_emit(const log_record_t *record)
+{
+    uint8_t  payload[LOG_PAYLOAD_MAX];
+    uint8_t *out = payload;
+
+    if (record->format == NULL)
+    {
+        log_emit_frame(LOG_FRAME_KIND_TEXT, (const uint8_t *)record->args,
+                       record->length);
+        return;
+    }
+
+    out = put_u32(out, record->timestamp_ms);
+    out = put_u32(out, (uint32_t)(uintptr_t)record->format);
+    for (uint8_t i = 0U; i < record->length; i++)
+    {
+        out = put_u32(out, record->args[i]);
+    }
+    log_emit_frame(LOG_FRAME_KIND_FORMAT, payload,
+                   (uint8_t)(out - payload));
+}
+
+/**
+ * @brief Report records lost on a full ring
+ */
+static void log_emit_dropped(uint32_t dropped)
+{
+    uint8_t payload[4];
+
+    (void)put_u32(payload, dropped);
+    log_emit_frame(LOG_FRAME_KIND_DROPPED, payload, sizeof(payload));
+}
+
+#else /* !LOG_BINARY */
+
+/**
+ * @brief Append formatted text to the transmit buffer
+ *
+ * Text longer than the whole buffer is cut off.
+ */
+static void log_emit_text(const char *format, const uint32_t *args)
+{
+    int written;
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        size_t space = LOG_TX_BUFFER_SIZE - s_tx_length;
+
+        /* Extra arguments are ignored; %s takes the 32-bit pointer */
+        written = jerry_snprintf((char *)&s_tx_buffer[s_tx_length], space,
+                                 format, args[0], args[1], args[2], args[3]);
+        if (written < 0)
+        {
+            return;
+        }
+        if (((size_t)written < space) || (s_tx_length == 0U))
+        {
+            break;
+        }
+        log_flush();
+    }
+
+    if ((size_t)written >= (LOG_TX_BUFFER_SIZE - s_tx_length))
+    {
+        /* Drop the terminator jerry_snprintf() stored in the last byte */
+        written = (int)(LOG_TX_BUFFER_SIZE - s_tx_length - 1U);
+    }
+    s_tx_length = (uint16_t)(s_tx_length + (uint16_t)written);
+}
+
+/**
+ * @brief Append a record as text
+ */
+static void log_emit(const log_record_t *record)
+{
+    uint32_t args[LOG_MAX_ARGS] = {0};
+
+    if (record->format == NULL)
+    {
+        if ((s_tx_length + record->length) > LOG_TX_BUFFER_SIZE)
+        {
+            log_flush();
+        }
+        (void)memcpy(&s_tx_buffer[s_tx_length], record->args, record->length);
+        s_tx_length = (uint16_t)(s_tx_length + record->length);
+        return;
+    }
+
+    (void)memcpy(args, record->args, record->length * sizeof(uint32_t));
+    log_emit_text(record->format, args);
+}
+
+/**
+ * @brief Report records lost on a full ring
+ */
+static void log_emit_dropped(uint32_t dropped)
+{
+    const uint32_t args[LOG_MAX_ARGS] = {dropped, 0U, 0U, 0U};
+
+    log_emit_text("[log] %lu records dropped\n", args);
+}
+
+#endif /* LOG_BINARY */
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
 /* Logging Task */
 void vLoggingTask(void* pvParameters)
 {
+    log_record_t    record;
+    supervisor_id_t heartbeat;
+
     (void)pvParameters;
 
-    /* Initialize UART for Logging (115200 bps) */
-    /* UART_Init(LOG_UART, 115200); */
+    /* A full ring takes long to drain, so every record is a check-in */
+    heartbeat = supervisor_register("Log", LOG_DRAIN_PERIOD_MS,
+                                    LOG_DEADLINE_MS);
 
     for (;;)
     {
-        /* Process log queue and send over UART */
-        vTaskDelay(pdMS_TO_TICKS(100));
+        uint32_t dropped = log_take_dropped();
+
+        if (dropped > 0U)
+        {
+            metrics_add(METRIC_LOG_DROP, dropped);
+            log_emit_dropped(dropped);
+        }
+
+        while (log_read(&record))
+        {
+            log_emit(&record);
+            supervisor_checkin(heartbeat);
+        }
+        log_flush();
+        supervisor_checkin(heartbeat);
+
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+    }
+}
+
+void log_panic(void)
+{
+    log_record_t record;
+    uint32_t     dropped;
+
+    s_panic = true;
+
+    /* The DMA finishes the buffer it was given before it is reused; a
+     * polled write of nothing only waits for the channel */
+    if (s_tx_sending)
+    {
+        BSP_Console_Write(s_tx_buffer, 0U);
+        s_tx_length = 0U;
+    }
+
+    dropped = log_take_dropped();
+    if (dropped > 0U)
+    {
+        log_emit_dropped(dropped);
+    }
+    while (log_read(&record))
+    {
+        log_emit(&record);
     }
+    log_flush();
 }
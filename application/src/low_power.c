@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Tickless Idle
+ *
+ * The SysTick is stopped for the sleep and restarted on a fresh period
+ * afterwards. The part of a tick already elapsed when it stopped, and the
+ * part of a tick slept beyond the last whole one, are carried over to the
+ * next sleep, so the tick count does not drift behind over many short
+ * sleeps.
+ */
+
+#include "low_power.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+#if (LOW_POWER_MAX_DEPTH < 0) || (LOW_POWER_MAX_DEPTH > 2)
+#error "LOW_POWER_MAX_DEPTH must be 0 (none), 1 (Sleep) or 2 (Stop)"
+#endif
+
+/** Length of a kernel tick */
+#define LOW_POWER_TICK_US (1000000U / configTICK_RATE_HZ)
+
+/** Idle period limit, one tick above the longest timed sleep */
+#define LOW_POWER_MAX_IDLE_TICKS \
+    ((BSP_LOWPOWER_MAX_SLEEP_US / LOW_POWER_TICK_US) + 1U)
+
+/** Sleep states within the depth and wake-up latency limits */
+#define LOW_POWER_USE_SLEEP                                                 \
+    ((LOW_POWER_MAX_DEPTH >= 1) &&                                          \
+     (BSP_LOWPOWER_SLEEP_EXIT_US <= LOW_POWER_MAX_WAKE_LATENCY_US))
+#define LOW_POWER_USE_STOP                                                  \
+    ((LOW_POWER_MAX_DEPTH >= 2) &&                                          \
+     (BSP_LOWPOWER_STOP_EXIT_US <= LOW_POWER_MAX_WAKE_LATENCY_US))
+
+/** Statistics, written by the idle task with interrupts masked */
+static low_power_stats_t s_stats;
+
+/** Time not yet credited to the kernel tick */
+static uint32_t s_residual_us;
+
+/** Ethernet link up, vetoes Stop */
+static volatile bool s_ethernet_active = true;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+#if !BSP_POSIX
+/* The host simulation idles in the tick signal of the POSIX port */
+
+/**
+ * @brief Deepest sleep state usable for an idle period
+ */
+static bsp_sleep_state_t low_power_select(uint32_t expected_idle)
+{
+    bsp_sleep_state_t state = BSP_SLEEP_NONE;
+
+#if LOW_POWER_USE_SLEEP
+    state = BSP_SLEEP_SLEEP;
+#endif
+#if LOW_POWER_USE_STOP
+    if (expected_idle >= pdMS_TO_TICKS(LOW_POWER_STOP_MIN_IDLE_MS))
+    {
+        if (!s_ethernet_active && BSP_LowPower_StopAllowed())
+        {
+            state = BSP_SLEEP_STOP;
+        }
+        else
+        {
+            s_stats.stop_vetoes++;
+        }
+    }
+#else
+    (void)expected_idle;
+#endif
+
+    return state;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void low_power_suppress_ticks_and_sleep(uint32_t expected_idle)
+{
+    bsp_sleep_state_t state;
+    uint32_t          elapsed_us;
+    uint32_t          slept_us;
+    uint32_t          ticks;
+
+    __disable_irq();
+    __DSB();
+    __ISB();
+
+    /* A task may have been readied since the kernel decided to idle */
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+    {
+        __enable_irq();
+        return;
+    }
+
+    /* Longest period the wake timer can time */
+    if (expected_idle > LOW_POWER_MAX_IDLE_TICKS)
+    {
+        expected_idle = LOW_POWER_MAX_IDLE_TICKS;
+    }
+
+    state = low_power_select(expected_idle);
+    if ((state == BSP_SLEEP_NONE) || (expected_idle < 2U))
+    {
+        s_stats.entries[BSP_SLEEP_NONE]++;
+        __enable_irq();
+        return;
+    }
+
+    /* Stop the tick, keeping the part of the current period gone by */
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    elapsed_us = (uint32_t)(((uint64_t)(SysTick->LOAD - SysTick->VAL) *
+                             LOW_POWER_TICK_US) /
+                            (SysTick->LOAD + 1U));
+
+    /* Wake in time for the tick that readies the next task */
+    slept_us = BSP_LowPower_Sleep(state, (expected_idle - 1U) *
+                                             LOW_POWER_TICK_US);
+
+    s_stats.entries[state]++;
+    s_stats.time_us[state] += slept_us;
+
+    elapsed_us += slept_us + s_residual_us;
+    ticks         = elapsed_us / LOW_POWER_TICK_US;
+    s_residual_us = elapsed_us % LOW_POWER_TICK_US;
+    if (ticks > (expected_idle - 1U))
+    {
+        ticks         = expected_idle - 1U;
+        s_residual_us = 0U;
+    }
+    vTaskStepTick((TickType_t)ticks);
+
+    SysTick->VAL = 0U;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __enable_irq();
+}
+#endif /* !BSP_POSIX */
+
+void low_power_set_ethernet_active(bool active) { s_ethernet_active = active; }
+
+void low_power_get_stats(low_power_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    (void)memcpy(stats, &s_stats, sizeof(*stats));
+    taskEXIT_CRITICAL();
+}
+
+void low_power_print(void)
+{
+    static const char *const names[BSP_SLEEP_STATE_COUNT] = {"Awake", "Sleep",
+                                                             "Stop"};
+    low_power_stats_t stats;
+
+    low_power_get_stats(&stats);
+
+    (void)printf("\n=== Low Power (depth %u) ===\n",
+                 (unsigned int)LOW_POWER_MAX_DEPTH);
+    (void)printf("State       Entries     Time (ms)\n");
+    (void)printf("------------------------------------------------\n");
+    for (uint32_t i = 0U; i < (uint32_t)BSP_SLEEP_STATE_COUNT; i++)
+    {
+        (void)printf("%-11s %-11lu %lu\n", names[i],
+                     (unsigned long)stats.entries[i],
+                     (unsigned long)(stats.time_us[i] / 1000U));
+    }
+    (void)printf("Stop vetoes: %lu\n", (unsigned long)stats.stop_vetoes);
+    (void)printf("================================================\n\n");
+}
@@ -9,10 +9,32 @@
 #include <string.h>
 
 #include "FreeRTOS.h"
+#include "adc_change.h"
+#include "adc_archive.h"
+#include "adc_stats.h"
+#include "anomaly.h"
 #include "app_tasks.h"
+#include "boot.h"
 #include "bsp.h"
+#include "bsp_sections.h"
+#include "clock_scaling.h"
+#include "control_loop.h"
+#include "cyclic_exec.h"
+#include "goertzel.h"
+#include "http_ws.h"
+#include "interlock.h"
+#include "jerry_device_registers.h"
+#include "live_data.h"
+#include "log.h"
+#include "nor_log.h"
+#include "power_meter.h"
+#include "profile.h"
+#include "supervisor.h"
 #include "task.h"
+#include "task_priorities.h"
 #include "timers.h"
+#include "trace.h"
+#include "usb_stream.h"
 
 /* LwIP includes for memory stats */
 #include "lwip/mem.h"
@@ -20,12 +42,25 @@
 #include "lwip/stats.h"
 
 /* Stack size for the tasks */
-#define MAIN_TASK_STACK_SIZE     256
-#define LOG_TASK_STACK_SIZE      256
-#define MODBUS_TASK_STACK_SIZE   512
-#define FOTA_TASK_STACK_SIZE     512
-#define MONITOR_TASK_STACK_SIZE  256 /* Increased from 128 for printf calls */
-#define TCP_ECHO_TASK_STACK_SIZE 1024
+#define MAIN_TASK_STACK_SIZE         256
+#define LOG_TASK_STACK_SIZE          256 /* jerry_snprintf() of the records */
+#define MODBUS_TASK_STACK_SIZE       512
+#define FOTA_TASK_STACK_SIZE         512
+#define MONITOR_TASK_STACK_SIZE      256 /* Increased from 128 for printf calls */
+#define NETWORK_TASK_STACK_SIZE      512 /* Bring-up only, then deleted */
+#define ADC_STREAM_TASK_STACK_SIZE   512
+#define CYCLIC_TASK_STACK_SIZE       384
+#define USB_LOG_TASK_STACK_SIZE      384
+#define USB_WRITE_TASK_STACK_SIZE    512
+#define SPECTRUM_TASK_STACK_SIZE     512
+#define PTP_TASK_STACK_SIZE          512
+#define DO_SCHEDULE_TASK_STACK_SIZE  256
+
+/* Deadline of the ADC1 filter task, about 15 blocks */
+#define MAIN_ADC_FILTER_DEADLINE_MS 50U
+
+/* Longest wait for the Modbus service before the boot report is printed */
+#define MAIN_BOOT_REPORT_TIMEOUT_MS 10000U
 
 /* ==========================================================================
  * Forward Declarations (MISRA 8.4)
@@ -41,6 +76,7 @@ void vApplicationMallocFailedHook(void);
 void vApplicationIdleHook(void);
 void vApplicationTickHook(void);
 void vMainTask(void* pvParameters);
+static void vAdcBlockHook(const float32_t* values);
 
 #if LWIP_STATS
 void print_lwip_memory_stats(void);
@@ -50,33 +86,66 @@ void print_task_stack_usage(void);
 
 /* Static Task Structures */
 static StaticTask_t xMainTaskTCB;
-static StackType_t  xMainTaskStack[MAIN_TASK_STACK_SIZE];
+static StackType_t  xMainTaskStack[MAIN_TASK_STACK_SIZE] BSP_SECTION_STACK;
 
 static StaticTask_t xLogTaskTCB;
-static StackType_t  xLogTaskStack[LOG_TASK_STACK_SIZE];
+static StackType_t  xLogTaskStack[LOG_TASK_STACK_SIZE] BSP_SECTION_STACK;
 
 static StaticTask_t xModbusTaskTCB;
-static StackType_t  xModbusTaskStack[MODBUS_TASK_STACK_SIZE];
+static StackType_t  xModbusTaskStack[MODBUS_TASK_STACK_SIZE] BSP_SECTION_STACK;
 
 static StaticTask_t xFotaTaskTCB;
-static StackType_t  xFotaTaskStack[FOTA_TASK_STACK_SIZE];
+static StackType_t  xFotaTaskStack[FOTA_TASK_STACK_SIZE] BSP_SECTION_STACK;
 
 static StaticTask_t xMonitorTaskTCB;
-static StackType_t  xMonitorTaskStack[MONITOR_TASK_STACK_SIZE];
+static StackType_t  xMonitorTaskStack[MONITOR_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
 
-static StaticTask_t xTcpEchoTaskTCB;
-static StackType_t  xTcpEchoTaskStack[TCP_ECHO_TASK_STACK_SIZE];
+static StaticTask_t xNetworkTaskTCB;
+static StackType_t  xNetworkTaskStack[NETWORK_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+static StaticTask_t xAdcStreamTaskTCB;
+static StackType_t  xAdcStreamTaskStack[ADC_STREAM_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+static StaticTask_t xCyclicTaskTCB;
+static StackType_t  xCyclicTaskStack[CYCLIC_TASK_STACK_SIZE] BSP_SECTION_STACK;
+
+#if !BSP_USBD_ENABLE
+static StaticTask_t xUsbLogTaskTCB;
+static StackType_t  xUsbLogTaskStack[USB_LOG_TASK_STACK_SIZE] BSP_SECTION_STACK;
+
+static StaticTask_t xUsbWriteTaskTCB;
+static StackType_t  xUsbWriteTaskStack[USB_WRITE_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
+#endif
+
+static StaticTask_t xSpectrumTaskTCB;
+static StackType_t  xSpectrumTaskStack[SPECTRUM_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+static StaticTask_t xPtpTaskTCB;
+static StackType_t  xPtpTaskStack[PTP_TASK_STACK_SIZE] BSP_SECTION_STACK;
+
+static StaticTask_t xDoScheduleTaskTCB;
+static StackType_t  xDoScheduleTaskStack[DO_SCHEDULE_TASK_STACK_SIZE]
+    BSP_SECTION_STACK;
 
 /* Task Handles */
 static TaskHandle_t xMainTaskHandle = NULL;
 
+/* Supervisor registration of the ADC1 filter task */
+static supervisor_id_t xAdcFilterHeartbeat = SUPERVISOR_INVALID_ID;
+
 /* FreeRTOS Static Allocation Hooks */
 void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer,
                                    StackType_t**  ppxIdleTaskStackBuffer,
                                    uint32_t*      pulIdleTaskStackSize)
 {
     static StaticTask_t xIdleTaskTCB;
-    static StackType_t  xIdleTaskStack[configMINIMAL_STACK_SIZE];
+    static StackType_t  xIdleTaskStack[configMINIMAL_STACK_SIZE]
+        BSP_SECTION_STACK;
 
     *ppxIdleTaskTCBBuffer   = &xIdleTaskTCB;
     *ppxIdleTaskStackBuffer = xIdleTaskStack;
@@ -88,7 +157,8 @@ void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer,
                                     uint32_t*      pulTimerTaskStackSize)
 {
     static StaticTask_t xTimerTaskTCB;
-    static StackType_t  xTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+    static StackType_t  xTimerTaskStack[configTIMER_TASK_STACK_DEPTH]
+        BSP_SECTION_STACK;
 
     *ppxTimerTaskTCBBuffer   = &xTimerTaskTCB;
     *ppxTimerTaskStackBuffer = xTimerTaskStack;
@@ -111,6 +181,7 @@ void vApplicationStackOverflowHook(TaskHandle_t xTask, char* pcTaskName)
     (void)xTask;
 
     /* CRITICAL: Stack overflow detected! */
+    BSP_Console_Fault();
     (void)printf("\n\n");
     (void)printf(
         "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
@@ -138,6 +209,9 @@ void vApplicationStackOverflowHook(TaskHandle_t xTask, char* pcTaskName)
  */
 void vApplicationMallocFailedHook(void)
 {
+    /* Halt first, so the report is written by polling */
+    taskDISABLE_INTERRUPTS();
+    BSP_Console_Fault();
     (void)printf("\n\n");
     (void)printf(
         "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
@@ -150,7 +224,6 @@ void vApplicationMallocFailedHook(void)
         "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
     (void)printf("\n");
 
-    taskDISABLE_INTERRUPTS();
     for (;;)
     {
         /* Infinite loop to halt execution */
@@ -161,7 +234,36 @@ void vApplicationMallocFailedHook(void)
 void vApplicationIdleHook(void) { /* Called when the idle task runs */ }
 
 /* Tick Hook */
-void vApplicationTickHook(void) { /* Called every tick interrupt */ }
+void vApplicationTickHook(void)
+{
+    /* Keep the run-time counter's wrap count current while no task switch
+     * reads it */
+    (void)BSP_CycleCounter_Read64();
+
+    BSP_GPIODI_DebounceTick();
+}
+
+/* ADC1 Block Hook, in the filter task after each block */
+static void vAdcBlockHook(const float32_t* values)
+{
+    TRACE_USER(TRACE_USER_ADC_BLOCK,
+               BSP_ADC1_GetFilterSampleCount() / BSP_ADC1_GetBlockSamples());
+
+    /* The interlocks first, then the loops, they have a deadline */
+    interlock_process(values);
+    control_loop_step(values);
+    adc_change_process(values);
+    adc_stats_process();
+    goertzel_process();
+    power_meter_process();
+
+    /* The block is in the rings, so the ring jobs have work */
+    cyclic_exec_release();
+
+    supervisor_checkin(xAdcFilterHeartbeat);
+
+    TRACE_USER(TRACE_USER_ADC_BLOCK_DONE, 0U);
+}
 
 /* ==========================================================================
  * LwIP Memory Monitoring
@@ -380,13 +482,20 @@ void print_task_stack_usage(void)
 /* Main Entry Point */
 int main(void)
 {
+    /* Logging ring, before any interrupt handler can log; a fault writes
+     * out what it still holds before the fault report */
+    log_init();
+    BSP_Console_SetFaultHook(log_panic);
+    boot_init();
+
     /* Initialize Hardware (BSP) */
     BSP_Init();
+    boot_mark("bsp");
 
     /* Create Main Task */
     xMainTaskHandle = xTaskCreateStatic(
         vMainTask, "Main", MAIN_TASK_STACK_SIZE, NULL,
-        (UBaseType_t)(tskIDLE_PRIORITY + 1U), xMainTaskStack, &xMainTaskTCB);
+        TASK_PRIO_BACKGROUND, xMainTaskStack, &xMainTaskTCB);
 
     if (NULL != xMainTaskHandle)
     {
@@ -407,25 +516,136 @@ void vMainTask(void* pvParameters)
 {
     (void)pvParameters;
 
+    boot_mark("scheduler");
+
+    /* The watchdog is reloaded only while the supervised tasks keep their
+     * deadlines; the filter task reports from its block hook */
+    xAdcFilterHeartbeat =
+        supervisor_register("AdcFilter", 3U, MAIN_ADC_FILTER_DEADLINE_MS);
+    supervisor_start();
+
+#if HTTP_SERVER
+    /* Live frames and events for the WebSocket clients of the HTTP
+     * server, subscribed before the first of them is published */
+    live_data_init();
+    http_ws_start();
+#endif
+
+    /* The output expanders of the digital output coils, all outputs low,
+     * before the interlocks or a Modbus write can stage an output */
+    if (BSP_I2CDO_init(jerry_device_i2c_expanders,
+                       JERRY_DEVICE_I2C_EXPANDER_COUNT) != BSP_OK)
+    {
+        printf("Digital outputs: expanders not answering\n");
+    }
+
+    /* Interlocks, PID loops and change detection run in the ADC1 filter
+     * task, the watchdog trips of the interlocks too; the interlocks on
+     * low-latency channels count samples in the ADC1 interrupt */
+    BSP_ADC1_SetBlockHook(vAdcBlockHook);
+    BSP_ADC1_SetWatchdogHook(interlock_watchdog);
+    BSP_ADC1_SetSampleHook(interlock_sample, interlock_sample_alarm);
+
+#if ANOMALY_DETECT
+    /* The anomaly models score each spectrum frame in the analysis task */
+    spectrum_set_frame_hook(anomaly_process);
+#endif
+
+#if TRACE_ENABLE
+    /* Streams the kernel events to a client on TCP, while one is connected */
+    trace_start();
+#endif
+
+#if PROFILE_ENABLE
+    /* Samples the interrupted code while a client is connected */
+    profile_start();
+#endif
+
+#if BSP_SPINOR_ENABLE
+    /* Keeps samples and events on the SPI NOR flash for back-fill */
+    nor_log_start();
+#endif
+
+#if ADC_ARCHIVE
+    /* Keeps the per second and per minute statistics on the flash too */
+    adc_archive_start();
+#endif
+
     /* Initialize sub-systems */
     (void)xTaskCreateStatic(vLoggingTask, "Log", LOG_TASK_STACK_SIZE, NULL,
-                            tskIDLE_PRIORITY + 1, xLogTaskStack, &xLogTaskTCB);
+                            TASK_PRIO_LOG, xLogTaskStack, &xLogTaskTCB);
 
     (void)xTaskCreateStatic(vModbusTask, "Modbus", MODBUS_TASK_STACK_SIZE, NULL,
-                            tskIDLE_PRIORITY + 2, xModbusTaskStack,
+                            TASK_PRIO_MODBUS_TCP, xModbusTaskStack,
                             &xModbusTaskTCB);
 
     (void)xTaskCreateStatic(vFotaTask, "Fota", FOTA_TASK_STACK_SIZE, NULL,
-                            tskIDLE_PRIORITY + 1, xFotaTaskStack,
+                            TASK_PRIO_BACKGROUND, xFotaTaskStack,
                             &xFotaTaskTCB);
 
     (void)xTaskCreateStatic(vMonitorTask, "Monitor", MONITOR_TASK_STACK_SIZE,
-                            NULL, tskIDLE_PRIORITY + 1, xMonitorTaskStack,
+                            NULL, TASK_PRIO_BACKGROUND, xMonitorTaskStack,
                             &xMonitorTaskTCB);
 
-    (void)xTaskCreateStatic(vTcpEchoTask, "TcpEcho", TCP_ECHO_TASK_STACK_SIZE,
-                            NULL, tskIDLE_PRIORITY + 1, xTcpEchoTaskStack,
-                            &xTcpEchoTaskTCB);
+    (void)xTaskCreateStatic(vNetworkTask, "Network", NETWORK_TASK_STACK_SIZE,
+                            NULL, TASK_PRIO_NETWORK, xNetworkTaskStack,
+                            &xNetworkTaskTCB);
+
+    /* Above the network, one block period is the deadline of the ring */
+    (void)xTaskCreateStatic(vAdcStreamTask, "AdcStream",
+                            ADC_STREAM_TASK_STACK_SIZE, NULL,
+                            TASK_PRIO_ADC_STREAM, xAdcStreamTaskStack,
+                            &xAdcStreamTaskTCB);
+
+    /* The CAN publishing, trigger capture and spectrum collection drain
+     * the same ring, at the same deadline, as jobs of one task */
+    (void)xTaskCreateStatic(vCyclicTask, "Cyclic", CYCLIC_TASK_STACK_SIZE,
+                            NULL, TASK_PRIO_CYCLIC, xCyclicTaskStack,
+                            &xCyclicTaskTCB);
+
+#if BSP_USBD_ENABLE
+    /* The connector is a device streaming the ring to its host, at the
+     * ring deadline like the UDP stream */
+    usb_stream_start();
+#else
+    /* The USB log capture shares the ring deadline; its writer only has
+     * to finish one buffer before the other fills */
+    (void)xTaskCreateStatic(vUsbLogTask, "UsbLog", USB_LOG_TASK_STACK_SIZE,
+                            NULL, TASK_PRIO_USB_LOG, xUsbLogTaskStack,
+                            &xUsbLogTaskTCB);
+    (void)xTaskCreateStatic(vUsbWriteTask, "UsbWrite",
+                            USB_WRITE_TASK_STACK_SIZE, NULL,
+                            TASK_PRIO_USB_WRITE, xUsbWriteTaskStack,
+                            &xUsbWriteTaskTCB);
+#endif
+
+    /* The spectrum analysis takes whatever time is left */
+    (void)xTaskCreateStatic(vSpectrumTask, "Spectrum",
+                            SPECTRUM_TASK_STACK_SIZE, NULL,
+                            TASK_PRIO_SPECTRUM, xSpectrumTaskStack,
+                            &xSpectrumTaskTCB);
+
+    /* Timestamps are taken by the MAC, so the servo tolerates delay */
+    (void)xTaskCreateStatic(vPtpTask, "Ptp", PTP_TASK_STACK_SIZE, NULL,
+                            TASK_PRIO_PTP, xPtpTaskStack, &xPtpTaskTCB);
+
+    /* Above everything: it only runs at the instant an output is due */
+    (void)xTaskCreateStatic(vDoScheduleTask, "DoSched",
+                            DO_SCHEDULE_TASK_STACK_SIZE, NULL,
+                            TASK_PRIO_DO_SCHEDULE, xDoScheduleTaskStack,
+                            &xDoScheduleTaskTCB);
+
+    /* Every task has started once the Modbus service is up; check the map
+     * and report how long the bring-up took */
+    (void)boot_wait(BOOT_EVENT_SERVICE_UP, MAIN_BOOT_REPORT_TIMEOUT_MS);
+    task_priorities_check();
+    boot_profile_print();
+
+#if CLOCK_SCALING
+    /* The bring-up ran in the full profile; from here on the workload
+     * picks the clock */
+    clock_scaling_start();
+#endif
 
     for (;;)
     {
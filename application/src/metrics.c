@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Metrics
+ *
+ * A producer learns from the total before its add whether it crossed a
+ * multiple of the threshold, so exactly one of several concurrent
+ * producers wakes the monitor for each crossing. The wake-up is a
+ * notification bit, so crossings that come faster than the monitor runs
+ * fold into one report.
+ */
+
+#include "metrics.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "bsp.h"
+#include "log.h"
+#include "lwip/stats.h"
+#include "lwip/timeouts.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Notification index the monitor task waits on */
+#define METRICS_NOTIFY_INDEX 0U
+
+/** Lost ADC samples per wake-up, one acquisition block */
+#define METRICS_ADC_THRESHOLD BSP_ADC1_BLOCK_SAMPLES
+
+/** RX stall time per wake-up, in us */
+#define METRICS_ETH_STALL_THRESHOLD_US 10000U
+
+/** Frames for other units per wake-up; a master polling a unit ID that is
+ *  not served is not an error */
+#define METRICS_UNIT_DROP_THRESHOLD 100U
+
+/** Requests shed per wake-up; a flood sheds hundreds a second */
+#define METRICS_SHED_THRESHOLD 100U
+
+/** Switches of the RX path to polling per wake-up; bursts are not errors */
+#define METRICS_ETH_POLL_THRESHOLD 100U
+
+/** Log records lost per wake-up, two rings; the printout of the counters
+ *  takes records itself */
+#define METRICS_LOG_THRESHOLD (2U * LOG_RING_SIZE)
+
+/** WebSocket messages dropped per wake-up; a dashboard on a slow link
+ *  drops some every second */
+#define METRICS_WS_DROP_THRESHOLD 100U
+
+/**
+ * @brief Static description of a counter
+ */
+typedef struct
+{
+    const char *name;      /**< Printed name */
+    uint32_t    threshold; /**< Events per wake-up of the monitor */
+} metric_info_t;
+
+/** Errors wake the monitor at once */
+static const metric_info_t s_info[METRIC_COUNT] = {
+    [METRIC_LWIP_HEAP_ERR]    = {"lwIP heap errors", 1U},
+    [METRIC_LWIP_PBUF_ERR]    = {"PBUF pool errors", 1U},
+    [METRIC_LWIP_TCP_SEG_ERR] = {"TCP_SEG pool errors", 1U},
+    [METRIC_LWIP_TCP_PCB_ERR] = {"TCP_PCB pool errors", 1U},
+    [METRIC_LWIP_NETCONN_ERR] = {"NETCONN pool errors", 1U},
+    [METRIC_ETH_RX_NO_BUFFER] = {"ETH RX no buffer", 1U},
+    [METRIC_ETH_RX_STALL]     = {"ETH RX DMA stalls", 1U},
+    [METRIC_ETH_RX_DROPPED]   = {"ETH RX dropped", 1U},
+    [METRIC_ETH_TX_ERR]       = {"ETH TX errors", 1U},
+    [METRIC_ADC_OVERRUN]      = {"ADC samples overrun", METRICS_ADC_THRESHOLD},
+    [METRIC_ADC_DROPPED]      = {"ADC samples dropped", METRICS_ADC_THRESHOLD},
+    [METRIC_MODBUS_TCP_ERR]   = {"Modbus TCP errors", 1U},
+    [METRIC_MODBUS_RTU_ERR]   = {"Modbus RTU errors", 1U},
+    [METRIC_USB_LOG_LOST]     = {"USB log samples lost", METRICS_ADC_THRESHOLD},
+    [METRIC_ETH_RX_RECOVERED] = {"ETH RX stalls recovered", 1U},
+    [METRIC_ETH_RX_STALL_US]  = {"ETH RX stall time (us)",
+                                 METRICS_ETH_STALL_THRESHOLD_US},
+    [METRIC_ETH_BCAST_STORM]  = {"ETH broadcast storms", 1U},
+    [METRIC_MODBUS_UDP_RETRY] = {"Modbus UDP retries", 1U},
+    [METRIC_MODBUS_UNIT_DROP] = {"Modbus TCP foreign unit frames",
+                                 METRICS_UNIT_DROP_THRESHOLD},
+    [METRIC_MODBUS_SHED_CONN] = {"Modbus requests shed, connection rate",
+                                 METRICS_SHED_THRESHOLD},
+    [METRIC_MODBUS_SHED_UNIT] = {"Modbus requests shed, unit rate",
+                                 METRICS_SHED_THRESHOLD},
+    [METRIC_ETH_RX_POLL]      = {"ETH RX polled bursts",
+                                 METRICS_ETH_POLL_THRESHOLD},
+    [METRIC_MSG_BUS_DROP]     = {"Message bus deliveries missed", 1U},
+    [METRIC_TRACE_DROP]       = {"Trace records dropped", 1U},
+    [METRIC_DEADLINE_MISS]    = {"Task deadlines missed", 1U},
+    [METRIC_LOG_DROP]         = {"Log records dropped", METRICS_LOG_THRESHOLD},
+    [METRIC_CONFIG_FAIL]      = {"Config commits failed", 1U},
+    [METRIC_NOR_LOG_LOST]     = {"NOR log records lost", 1U},
+    [METRIC_WS_DROP]          = {"WebSocket messages dropped",
+                                 METRICS_WS_DROP_THRESHOLD},
+    [METRIC_MQTT_RECONNECT]   = {"MQTT connections lost", 1U},
+    [METRIC_ARCHIVE_LOST]     = {"Archive records lost", 1U},
+    [METRIC_USB_STREAM_LOST]  = {"USB stream samples lost",
+                                 METRICS_ADC_THRESHOLD},
+    [METRIC_PROFILE_DROP]     = {"Profile samples dropped", 1U},
+    [METRIC_CAPTURE_DROP]     = {"Modbus capture records dropped", 1U},
+};
+
+static atomic_uint s_totals[METRIC_COUNT];
+
+/** Totals at the last metrics_print_changes() (monitor task only) */
+static uint32_t s_reported[METRIC_COUNT];
+
+/** Task woken by the events, set by its first metrics_wait() */
+static TaskHandle_t volatile s_monitor;
+
+#if LWIP_STATS
+/** lwIP error counts at the last sample (tcpip thread only) */
+static STAT_COUNTER s_lwip_seen[METRIC_LWIP_NETCONN_ERR + 1U];
+#endif
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Set event bits of the monitor task, from a task or an interrupt
+ */
+static void metrics_notify(uint32_t events)
+{
+    TaskHandle_t monitor = s_monitor;
+
+    if (monitor == NULL)
+    {
+        return;
+    }
+
+    if (xPortIsInsideInterrupt() != pdFALSE)
+    {
+        BaseType_t woken = pdFALSE;
+
+        (void)xTaskNotifyIndexedFromISR(monitor, METRICS_NOTIFY_INDEX, events,
+                                        eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        (void)xTaskNotifyIndexed(monitor, METRICS_NOTIFY_INDEX, events,
+                                 eSetBits);
+    }
+}
+
+#if LWIP_STATS
+/**
+ * @brief Push the increase of one lwIP error counter
+ */
+static void metrics_lwip_push(metric_id_t id, STAT_COUNTER count)
+{
+    STAT_COUNTER delta = (STAT_COUNTER)(count - s_lwip_seen[id]);
+
+    if (delta != 0U)
+    {
+        s_lwip_seen[id] = count;
+        metrics_add(id, (uint32_t)delta);
+    }
+}
+
+#if MEMP_STATS
+/**
+ * @brief Error count of a memory pool, 0 if it has no statistics
+ */
+static STAT_COUNTER metrics_memp_err(memp_t pool)
+{
+    return (lwip_stats.memp[pool] != NULL) ? lwip_stats.memp[pool]->err : 0U;
+}
+#endif
+#endif /* LWIP_STATS */
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void metrics_add(metric_id_t id, uint32_t count)
+{
+    uint32_t threshold = s_info[id].threshold;
+    uint32_t before;
+
+    if (count == 0U)
+    {
+        return;
+    }
+
+    before = (uint32_t)atomic_fetch_add_explicit(&s_totals[id], count,
+                                                 memory_order_relaxed);
+    if (((before + count) / threshold) != (before / threshold))
+    {
+        metrics_notify(METRICS_EVENT_THRESHOLD);
+    }
+}
+
+void metrics_request_snapshot(void)
+{
+    metrics_notify(METRICS_EVENT_SNAPSHOT);
+}
+
+void metrics_request_telemetry(void)
+{
+    metrics_notify(METRICS_EVENT_TELEMETRY);
+}
+
+uint32_t metrics_wait(TickType_t timeout)
+{
+    uint32_t events = 0U;
+
+    if (s_monitor == NULL)
+    {
+        s_monitor = xTaskGetCurrentTaskHandle();
+    }
+
+    if (xTaskNotifyWaitIndexed(METRICS_NOTIFY_INDEX, 0U, UINT32_MAX, &events,
+                               timeout) != pdTRUE)
+    {
+        events = 0U;
+    }
+
+    return events;
+}
+
+void metrics_get(uint32_t totals[METRIC_COUNT])
+{
+    for (uint32_t i = 0U; i < (uint32_t)METRIC_COUNT; i++)
+    {
+        totals[i] =
+            (uint32_t)atomic_load_explicit(&s_totals[i], memory_order_relaxed);
+    }
+}
+
+const char *metrics_name(metric_id_t id)
+{
+    return s_info[id].name;
+}
+
+void metrics_print_changes(void)
+{
+    uint32_t totals[METRIC_COUNT];
+
+    metrics_get(totals);
+    for (uint32_t i = 0U; i < (uint32_t)METRIC_COUNT; i++)
+    {
+        if (totals[i] != s_reported[i])
+        {
+            (void)printf("!!! %s: +%lu (total %lu) !!!\n", s_info[i].name,
+                         (unsigned long)(totals[i] - s_reported[i]),
+                         (unsigned long)totals[i]);
+            s_reported[i] = totals[i];
+        }
+    }
+}
+
+void metrics_print(void)
+{
+    uint32_t totals[METRIC_COUNT];
+
+    metrics_get(totals);
+    (void)printf("\n=== Metrics ===\n");
+    (void)printf("Counter                 Total       Threshold\n");
+    (void)printf("------------------------------------------------\n");
+    for (uint32_t i = 0U; i < (uint32_t)METRIC_COUNT; i++)
+    {
+        (void)printf("%-23s %-11lu %lu\n", s_info[i].name,
+                     (unsigned long)totals[i],
+                     (unsigned long)s_info[i].threshold);
+    }
+    (void)printf("================================================\n\n");
+}
+
+void metrics_lwip_sample(void *arg)
+{
+    (void)arg;
+
+#if LWIP_STATS && MEM_STATS
+    metrics_lwip_push(METRIC_LWIP_HEAP_ERR, lwip_stats.mem.err);
+#endif
+#if LWIP_STATS && MEMP_STATS
+    metrics_lwip_push(METRIC_LWIP_PBUF_ERR, metrics_memp_err(MEMP_PBUF));
+    metrics_lwip_push(METRIC_LWIP_TCP_SEG_ERR, metrics_memp_err(MEMP_TCP_SEG));
+    metrics_lwip_push(METRIC_LWIP_TCP_PCB_ERR, metrics_memp_err(MEMP_TCP_PCB));
+    metrics_lwip_push(METRIC_LWIP_NETCONN_ERR, metrics_memp_err(MEMP_NETCONN));
+#endif
+
+    sys_timeout(METRICS_LWIP_SAMPLE_MS, metrics_lwip_sample, NULL);
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Admission Control
+ *
+ * A connection bucket belongs to the worker of its connection and is used
+ * without a lock. The unit buckets are shared by all workers and are
+ * refilled, checked and taken in one critical section of a few dozen
+ * instructions. They start empty, and their first refill, whole seconds
+ * after boot, fills them. See modbus_admission.h.
+ */
+
+#include "modbus_admission.h"
+
+#include "modbus_types.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Tokens of one request */
+#define MODBUS_ADMISSION_TOKEN 1000
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Buckets of the units, by unit table index (critical section) */
+static modbus_bucket_t s_unit_buckets[MODBUS_UNITS_MAX];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Refill a bucket for the time since its last refill
+ *
+ * @param[in,out] bucket Bucket
+ * @param[in]     rate   Requests per second
+ * @param[in]     burst  Requests it holds at most
+ * @param[in]     now    Current tick
+ */
+static void bucket_refill(modbus_bucket_t *bucket, uint32_t rate,
+                          uint32_t burst, TickType_t now)
+{
+    int32_t  full    = (int32_t)(burst * (uint32_t)MODBUS_ADMISSION_TOKEN);
+    uint32_t elapsed = (uint32_t)pdTICKS_TO_MS(now - bucket->last);
+
+    bucket->last = now;
+
+    /* Full after the time to fill a drained bucket; below it the product
+     * cannot overflow */
+    if (elapsed >= ((burst + MODBUS_ADMISSION_WRITE_RESERVE) *
+                    (uint32_t)MODBUS_ADMISSION_TOKEN) / rate)
+    {
+        bucket->tokens = full;
+    }
+    else
+    {
+        bucket->tokens += (int32_t)(elapsed * rate);
+        if (bucket->tokens > full)
+        {
+            bucket->tokens = full;
+        }
+    }
+}
+
+/**
+ * @brief Check whether a bucket holds the tokens of a request
+ *
+ * @param[in] bucket Refilled bucket
+ * @param[in] write  The request is a control write
+ * @return true if the request may take its tokens
+ */
+static bool bucket_admits(const modbus_bucket_t *bucket, bool write)
+{
+    int32_t floor = write ? -(int32_t)(MODBUS_ADMISSION_WRITE_RESERVE *
+                                       (uint32_t)MODBUS_ADMISSION_TOKEN)
+                          : 0;
+
+    return (bucket->tokens - MODBUS_ADMISSION_TOKEN) >= floor;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_admission_init_conn(modbus_bucket_t *bucket)
+{
+    bucket->tokens = (int32_t)(MODBUS_ADMISSION_CONN_BURST *
+                               (uint32_t)MODBUS_ADMISSION_TOKEN);
+    bucket->last   = xTaskGetTickCount();
+}
+
+bool modbus_admission_is_write(uint8_t function_code)
+{
+    bool write;
+
+    switch (function_code)
+    {
+        case MODBUS_FC_WRITE_SINGLE_COIL:
+        case MODBUS_FC_WRITE_SINGLE_REGISTER:
+        case MODBUS_FC_WRITE_MULTIPLE_COILS:
+        case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+        case MODBUS_FC_READ_WRITE_MULTIPLE_REGS:
+        case MODBUS_FC_WRITE_FILE_RECORD:
+            write = true;
+            break;
+        default:
+            write = false;
+            break;
+    }
+
+    return write;
+}
+
+modbus_admission_t modbus_admission_check(modbus_bucket_t     *conn,
+                                          const modbus_unit_t *unit,
+                                          uint8_t              function_code)
+{
+    bool write = modbus_admission_is_write(function_code);
+
+    bucket_refill(conn, MODBUS_ADMISSION_CONN_RATE,
+                  MODBUS_ADMISSION_CONN_BURST, xTaskGetTickCount());
+    if (!bucket_admits(conn, write))
+    {
+        return MODBUS_ADMIT_SHED_CONN;
+    }
+
+    if (unit != NULL)
+    {
+        modbus_bucket_t *shared = &s_unit_buckets[unit->index];
+        bool             admitted;
+
+        /* The tick is read inside, so it never goes back for a bucket */
+        taskENTER_CRITICAL();
+        bucket_refill(shared, MODBUS_ADMISSION_UNIT_RATE,
+                      MODBUS_ADMISSION_UNIT_BURST, xTaskGetTickCount());
+        admitted = bucket_admits(shared, write);
+        if (admitted)
+        {
+            shared->tokens -= MODBUS_ADMISSION_TOKEN;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!admitted)
+        {
+            return MODBUS_ADMIT_SHED_UNIT;
+        }
+    }
+
+    conn->tokens -= MODBUS_ADMISSION_TOKEN;
+
+    return MODBUS_ADMIT_OK;
+}
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Request Capture Task
+ *
+ * The connection workers run at the same priority and may preempt each
+ * other, so a record is stamped, filled and published in one critical
+ * section: the records of the ring are in the order of their times. The
+ * capture task is the only reader: as in the profiler (profile.c) it sends
+ * the records between the tail and the head straight from the ring and
+ * frees them once sent. The stream format is described in
+ * modbus_capture.h.
+ */
+
+#include "modbus_capture.h"
+
+#if MODBUS_CAPTURE
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "bsp_sections.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "metrics.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the task (words) */
+#define MODBUS_CAPTURE_STACK_SIZE 384U
+
+/** Time a client has to send its request */
+#define MODBUS_CAPTURE_REQUEST_TIMEOUT_MS 2000U
+
+/** MBAP header size; the function code follows it */
+#define MODBUS_CAPTURE_MBAP_SIZE 7U
+
+_Static_assert((MODBUS_CAPTURE_RING_RECORDS &
+                (MODBUS_CAPTURE_RING_RECORDS - 1U)) == 0U,
+               "the ring size must be a power of two");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One record, in its wire layout
+ */
+typedef struct
+{
+    uint32_t time_us;        /**< Microseconds since the capture start */
+    uint16_t transaction;    /**< MBAP transaction ID */
+    uint16_t length;         /**< ADU length */
+    uint16_t address;        /**< Start address */
+    uint16_t quantity;       /**< Quantity */
+    uint16_t write_address;  /**< FC23 write start address */
+    uint16_t write_quantity; /**< FC23 write quantity */
+    uint8_t  unit_id;        /**< Unit ID */
+    uint8_t  function;       /**< Function code */
+    uint8_t  connection;     /**< Worker slot */
+    uint8_t  flags;          /**< MODBUS_CAPTURE_FLAG_* */
+} modbus_capture_record_t;
+
+_Static_assert(sizeof(modbus_capture_record_t) == MODBUS_CAPTURE_RECORD_SIZE,
+               "records are sent as they are stored");
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task control block and stack */
+static StaticTask_t s_capture_task_tcb;
+static StackType_t s_capture_task_stack[MODBUS_CAPTURE_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** Record ring */
+static modbus_capture_record_t s_ring[MODBUS_CAPTURE_RING_RECORDS];
+
+/** Records written, and records sent, since boot */
+static atomic_uint s_head;
+static atomic_uint s_tail;
+
+/** Records dropped, written in the critical section only */
+static atomic_uint s_dropped;
+
+/** Records dropped that were reported (capture task only) */
+static uint32_t s_dropped_sent;
+
+/** A client is connected: the workers record */
+static atomic_bool s_recording;
+
+/** Start of the capture, BSP_Time_NowNs() */
+static uint64_t s_start_ns;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Load a 16-bit big-endian value of a frame
+ */
+static uint16_t get_be16(const uint8_t *src)
+{
+    return (uint16_t)(((uint16_t)src[0] << 8U) | src[1]);
+}
+
+/**
+ * @brief Store a 16-bit value little-endian
+ */
+static void put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static void put_u32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+    dst[2] = (uint8_t)(value >> 16U);
+    dst[3] = (uint8_t)(value >> 24U);
+}
+
+/**
+ * @brief Fill the range fields of a record from the request PDU
+ *
+ * @param[out] record Record
+ * @param[in]  pdu    Request PDU, from its function code
+ * @param[in]  length Bytes of @p pdu at hand
+ */
+static void modbus_capture_range(modbus_capture_record_t *record,
+                                 const uint8_t *pdu, uint16_t length)
+{
+    switch (pdu[0])
+    {
+        case 0x01U: /* Read Coils */
+        case 0x02U: /* Read Discrete Inputs */
+        case 0x03U: /* Read Holding Registers */
+        case 0x04U: /* Read Input Registers */
+        case 0x0FU: /* Write Multiple Coils */
+        case 0x10U: /* Write Multiple Registers */
+            if (length >= 5U)
+            {
+                record->address  = get_be16(&pdu[1]);
+                record->quantity = get_be16(&pdu[3]);
+            }
+            break;
+
+        case 0x05U: /* Write Single Coil */
+        case 0x06U: /* Write Single Register */
+        case 0x16U: /* Mask Write Register */
+            if (length >= 3U)
+            {
+                record->address  = get_be16(&pdu[1]);
+                record->quantity = 1U;
+            }
+            break;
+
+        case 0x17U: /* Read/Write Multiple Registers */
+            if (length >= 9U)
+            {
+                record->address        = get_be16(&pdu[1]);
+                record->quantity       = get_be16(&pdu[3]);
+                record->write_address  = get_be16(&pdu[5]);
+                record->write_quantity = get_be16(&pdu[7]);
+            }
+            break;
+
+        default:
+            /* No range */
+            break;
+    }
+}
+
+/**
+ * @brief Receive the request of a client
+ *
+ * @return true for a valid request
+ */
+static bool modbus_capture_request(struct netconn *conn)
+{
+    uint8_t        request[MODBUS_CAPTURE_REQUEST_SIZE];
+    uint32_t       received = 0U;
+    struct netbuf *buf;
+
+    netconn_set_recvtimeout(conn, MODBUS_CAPTURE_REQUEST_TIMEOUT_MS);
+
+    while (received < sizeof(request))
+    {
+        if (netconn_recv(conn, &buf) != ERR_OK)
+        {
+            return false;
+        }
+        received += netbuf_copy_partial(buf, &request[received],
+                                        (u16_t)(sizeof(request) - received),
+                                        0U);
+        netbuf_delete(buf);
+    }
+
+    return ((uint16_t)(request[0] | ((uint16_t)request[1] << 8U)) ==
+            MODBUS_CAPTURE_MAGIC) &&
+           (request[2] == MODBUS_CAPTURE_VERSION);
+}
+
+/**
+ * @brief Send the records written since the last drain and free them
+ */
+static err_t modbus_capture_drain(struct netconn *conn)
+{
+    uint32_t tail    = atomic_load_explicit(&s_tail, memory_order_relaxed);
+    uint32_t head    = atomic_load_explicit(&s_head, memory_order_acquire);
+    uint32_t dropped = atomic_load(&s_dropped) - s_dropped_sent;
+    err_t    err     = ERR_OK;
+
+    while ((err == ERR_OK) && (tail != head))
+    {
+        uint32_t index = tail & (MODBUS_CAPTURE_RING_RECORDS - 1U);
+        uint32_t count = head - tail;
+
+        /* Up to the end of the ring, the rest on the next pass */
+        if (count > (MODBUS_CAPTURE_RING_RECORDS - index))
+        {
+            count = MODBUS_CAPTURE_RING_RECORDS - index;
+        }
+
+        err = netconn_write(conn, &s_ring[index],
+                            (size_t)count * sizeof(s_ring[0]), NETCONN_COPY);
+        tail += count;
+    }
+
+    /* Free the ring before the lost record, so recording resumes */
+    atomic_store_explicit(&s_tail, tail, memory_order_release);
+
+    if ((err == ERR_OK) && (dropped != 0U))
+    {
+        modbus_capture_record_t lost = {
+            .time_us = dropped,
+            .flags   = MODBUS_CAPTURE_FLAG_LOST,
+        };
+
+        s_dropped_sent += dropped;
+        metrics_add(METRIC_CAPTURE_DROP, dropped);
+        err = netconn_write(conn, &lost, sizeof(lost), NETCONN_COPY);
+    }
+
+    return err;
+}
+
+/**
+ * @brief Record and stream to one client until it goes away
+ */
+static void modbus_capture_stream(struct netconn *conn)
+{
+    uint8_t header[MODBUS_CAPTURE_HEADER_SIZE];
+    err_t   err;
+
+    if (!modbus_capture_request(conn))
+    {
+        printf("Capture: bad request\n");
+        return;
+    }
+
+    /* Nothing records, so the ring is idle */
+    atomic_store(&s_tail, atomic_load(&s_head));
+    s_dropped_sent = atomic_load(&s_dropped);
+    s_start_ns     = BSP_Time_NowNs();
+
+    put_u16(&header[0], (uint16_t)MODBUS_CAPTURE_MAGIC);
+    header[2] = (uint8_t)MODBUS_CAPTURE_VERSION;
+    header[3] = (uint8_t)MODBUS_CAPTURE_RECORD_SIZE;
+    put_u32(&header[4], (uint32_t)(s_start_ns / (uint64_t)BSP_PTP_NS_PER_S));
+
+    err = netconn_write(conn, header, sizeof(header), NETCONN_COPY);
+    if (err != ERR_OK)
+    {
+        return;
+    }
+
+    atomic_store(&s_recording, true);
+    printf("Capture: client connected\n");
+
+    while (err == ERR_OK)
+    {
+        vTaskDelay(pdMS_TO_TICKS(MODBUS_CAPTURE_DRAIN_MS));
+        err = modbus_capture_drain(conn);
+    }
+
+    atomic_store(&s_recording, false);
+    printf("Capture: client gone (%d)\n", (int)err);
+}
+
+/**
+ * @brief Capture task
+ */
+static void modbus_capture_task(void *pvParameters)
+{
+    struct netconn *listen_conn;
+    struct netconn *conn;
+
+    (void)pvParameters;
+
+    while ((listen_conn = netconn_new(NETCONN_TCP)) == NULL)
+    {
+        printf("Capture: Failed to create connection\n");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    if ((netconn_bind(listen_conn, IP_ADDR_ANY, MODBUS_CAPTURE_PORT) !=
+         ERR_OK) ||
+        (netconn_listen_with_backlog(listen_conn, 1U) != ERR_OK))
+    {
+        printf("Capture: Failed to listen on port %u\n", MODBUS_CAPTURE_PORT);
+        netconn_delete(listen_conn);
+        vTaskDelete(NULL);
+    }
+
+    printf("Modbus capture listening on port %u\n", MODBUS_CAPTURE_PORT);
+
+    for (;;)
+    {
+        if (netconn_accept(listen_conn, &conn) != ERR_OK)
+        {
+            continue;
+        }
+
+        modbus_capture_stream(conn);
+        netconn_close(conn);
+        netconn_delete(conn);
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_capture_frame(uint8_t connection, const uint8_t *frame,
+                          uint16_t available, uint8_t flags)
+{
+    modbus_capture_record_t record = {0};
+    uint32_t                head;
+
+    if (!atomic_load_explicit(&s_recording, memory_order_acquire))
+    {
+        return;
+    }
+
+    /* The header of a foreign frame may have arrived in part */
+    record.length     = available;
+    record.connection = connection;
+    record.flags      = flags;
+    if (available >= 6U)
+    {
+        record.transaction = get_be16(&frame[0]);
+        record.length      = (uint16_t)(6U + get_be16(&frame[4]));
+    }
+    if (available >= MODBUS_CAPTURE_MBAP_SIZE)
+    {
+        record.unit_id = frame[MODBUS_CAPTURE_MBAP_SIZE - 1U];
+    }
+    if (available > MODBUS_CAPTURE_MBAP_SIZE)
+    {
+        record.function = frame[MODBUS_CAPTURE_MBAP_SIZE];
+        modbus_capture_range(
+            &record, &frame[MODBUS_CAPTURE_MBAP_SIZE],
+            (uint16_t)(available - MODBUS_CAPTURE_MBAP_SIZE));
+    }
+
+    /* Stamped and published together, so the ring stays in time order */
+    taskENTER_CRITICAL();
+    head = atomic_load_explicit(&s_head, memory_order_relaxed);
+    if ((head - atomic_load_explicit(&s_tail, memory_order_acquire)) <
+        MODBUS_CAPTURE_RING_RECORDS)
+    {
+        record.time_us = (uint32_t)((BSP_Time_NowNs() - s_start_ns) / 1000U);
+        s_ring[head & (MODBUS_CAPTURE_RING_RECORDS - 1U)] = record;
+        atomic_store_explicit(&s_head, head + 1U, memory_order_release);
+    }
+    else
+    {
+        atomic_fetch_add_explicit(&s_dropped, 1U, memory_order_relaxed);
+    }
+    taskEXIT_CRITICAL();
+}
+
+void modbus_capture_start(void)
+{
+    (void)xTaskCreateStatic(modbus_capture_task, "MbCapture",
+                            MODBUS_CAPTURE_STACK_SIZE, NULL,
+                            TASK_PRIO_MB_CAPTURE, s_capture_task_stack,
+                            &s_capture_task_tcb);
+}
+
+#endif /* MODBUS_CAPTURE */
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus CRC-16 Hardware Backend
+ *
+ * Port hook of the Modbus library for MODBUS_CRC_BACKEND_HW: hands long
+ * buffers to the CRC unit through BSP_CRC16_Modbus(). When another task
+ * owns the unit the library falls back to its lookup table, so callers
+ * never block on the peripheral.
+ */
+
+#include "bsp.h"
+#include "modbus_internal.h"
+
+#if MODBUS_CRC_BACKEND == MODBUS_CRC_BACKEND_HW
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+bool modbus_crc16_hw(const uint8_t *data, uint16_t length, uint16_t *crc)
+{
+    return BSP_CRC16_Modbus(data, length, crc) == BSP_OK;
+}
+
+#endif /* MODBUS_CRC_BACKEND == MODBUS_CRC_BACKEND_HW */
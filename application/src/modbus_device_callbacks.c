@@ -12,14 +12,40 @@
  * @copyright Copyright (c) 2026
  */
 
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "FreeRTOS.h"
+#include "adc_capture.h"
+#include "adc_change.h"
+#include "adc_stats.h"
+#include "adc_filter_coefficients.h"
+#include "anomaly.h"
+#include "adc_stream_task.h"
+#include "arm_math.h"
 #include "bsp.h"
+#include "can_publish.h"
+#include "config_store.h"
+#include "control_loop.h"
+#include "do_schedule.h"
+#include "ethernetif.h"
+#include "fota_task.h"
+#include "goertzel.h"
+#include "interlock.h"
 #include "jerry_device_registers.h"
 #include "modbus_callbacks.h"
+#include "modbus_diag.h"
+#include "modbus_response_cache.h"
+#include "mqtt_client.h"
+#include "net_cache.h"
+#include "power_fail.h"
+#include "power_meter.h"
+#include "snapshot_publish.h"
+#include "spectrum.h"
 #include "task.h"
+#include "telemetry.h"
 
 /* ==========================================================================
  * Helper Macros
@@ -34,43 +60,300 @@
 #define ADDR_IN_RANGE_NONZERO(addr, min, max) \
     (((addr) >= (min)) && ((addr) <= (max)))
 
+/** Number of GPIO digital inputs (BSP_GPIODI_INDEX_0..7) */
+#define GPIODI_CHANNEL_COUNT 8U
+
+/** Number of ADC channels mirrored into holding registers (A0..A3) */
+#define ADC_REGISTER_COUNT 4U
+
+/** Filtered ADC values change once per DMA block (response cache window) */
+#define ADC_UPDATE_PERIOD_MS \
+    ((BSP_ADC1_BLOCK_SAMPLES * 1000U) / ADC_FILTER_SAMPLE_RATE)
+
+/** Channels behind the ADC value registers, A0..A3 */
+#define ADC_REGISTER_CHANNELS ((uint32_t)((1UL << ADC_REGISTER_COUNT) - 1U))
+
+/** Response cache window of data that only Modbus writes change */
+#define STATIC_DATA_CACHE_TTL_MS 1000U
+
+/** Bit of a PWM channel in a channel mask */
+#define PWM_CHANNEL_BIT(ch) ((uint8_t)(1U << (ch)))
+
+/** Registers between the first registers of two PWM channels */
+#define PWM_REGISTER_STRIDE \
+    (JERRY_DEVICE_HR_PWM_1_DUTY_CYCLE - JERRY_DEVICE_HR_PWM_0_DUTY_CYCLE)
+
+/** Registers between the first registers of two control loops */
+#define CONTROL_REGISTER_STRIDE \
+    (JERRY_DEVICE_HR_CONTROL_1_ENABLE - JERRY_DEVICE_HR_CONTROL_0_ENABLE)
+
+/** Registers between the first registers of two analog watchdogs */
+#define ADC_WATCHDOG_STRIDE \
+    (JERRY_DEVICE_HR_ADC_AWD_1_CHANNEL - JERRY_DEVICE_HR_ADC_AWD_0_CHANNEL)
+
+/** Offset of a register within the registers of its analog watchdog */
+#define ADC_WATCHDOG_FIELD(field) \
+    (JERRY_DEVICE_HR_ADC_AWD_0_##field - JERRY_DEVICE_HR_ADC_AWD_0_CHANNEL)
+
+/** Registers between the first registers of two monitored tones */
+#define GOERTZEL_STRIDE \
+    (JERRY_DEVICE_HR_GOERTZEL_1_CHANNEL - JERRY_DEVICE_HR_GOERTZEL_0_CHANNEL)
+
+/** Offset of a register within the registers of its tone */
+#define GOERTZEL_FIELD(field) \
+    (JERRY_DEVICE_HR_GOERTZEL_0_##field - JERRY_DEVICE_HR_GOERTZEL_0_CHANNEL)
+
+/** Registers between the first registers of two metered pairs */
+#define POWER_PAIR_STRIDE                      \
+    (JERRY_DEVICE_HR_POWER_1_VOLTAGE_CHANNEL - \
+     JERRY_DEVICE_HR_POWER_0_VOLTAGE_CHANNEL)
+
+/** Offset of a register within the registers of its pair */
+#define POWER_PAIR_FIELD(field)                  \
+    (JERRY_DEVICE_HR_POWER_0_##field##_CHANNEL - \
+     JERRY_DEVICE_HR_POWER_0_VOLTAGE_CHANNEL)
+
+/** Pairs power_energy_clear can name, bit n = pair n */
+#define POWER_PAIR_MASK ((1U << POWER_METER_PAIRS) - 1U)
+
+/** Dirty mask bit of the scheduled output command register */
+#define DO_SCHEDULE_COMMAND_BIT \
+    (JERRY_DEVICE_HR_DO_SCHEDULE_COMMAND - JERRY_DEVICE_HR_DO_SCHEDULE_SECONDS)
+
+/** Working registers of one control loop */
+typedef struct
+{
+    uint16_t *enable;     /**< Loop enable */
+    uint16_t *input;      /**< ADC channel */
+    uint16_t *output;     /**< PWM channel */
+    uint16_t *setpoint;   /**< Setpoint, mV */
+    int16_t  *kp;         /**< Proportional gain, 0.01 %/V */
+    int16_t  *ki;         /**< Integral gain, 0.01 %/(V s) */
+    int16_t  *kd;         /**< Derivative gain, 0.0001 % s/V */
+    uint16_t *output_min; /**< Lowest duty cycle, 0.01 % */
+    uint16_t *output_max; /**< Highest duty cycle, 0.01 % */
+} control_registers_t;
+
+/** Working registers of one analog watchdog */
+typedef struct
+{
+    uint16_t *channel;    /**< ADC channel watched */
+    uint16_t *low;        /**< Lowest raw result inside the window */
+    uint16_t *high;       /**< Highest raw result inside the window */
+    uint16_t *interlocks; /**< Interlock rules tripped, bit n = rule n */
+} adc_watchdog_registers_t;
+
+/** Holding registers of one monitored tone */
+typedef struct
+{
+    uint16_t *channel;   /**< ADC channel */
+    uint16_t *frequency; /**< Frequency, 0.1 Hz */
+} goertzel_tone_registers_t;
+
+/** Holding registers of tone @p n */
+#define GOERTZEL_TONE_REGISTERS(regs, n)                          \
+    ((goertzel_tone_registers_t){&(regs)->goertzel_##n##_channel, \
+                                 &(regs)->goertzel_##n##_frequency})
+
+/** Holding registers of one metered pair */
+typedef struct
+{
+    uint16_t *voltage; /**< ADC channel of the voltage */
+    uint16_t *current; /**< ADC channel of the current */
+} power_pair_registers_t;
+
+/** Holding registers of pair @p n */
+#define POWER_PAIR_REGISTERS(regs, n)                               \
+    ((power_pair_registers_t){&(regs)->power_##n##_voltage_channel, \
+                              &(regs)->power_##n##_current_channel})
+
+/** Edges kept in the edge log input registers */
+#define DI_EDGE_LOG_COUNT 8U
+
+/** Event register bit of a rising edge */
+#define DI_EDGE_EVENT_RISING 0x8000U
+
+/** A captured input whose rising edge is this many periods late reads as
+ * stopped */
+#define DI_STOPPED_PERIODS 2U
+
+/** Input registers of one captured digital input */
+typedef struct
+{
+    uint32_t *rising_count; /**< Rising edges */
+    uint32_t *frequency;    /**< Frequency, mHz */
+    uint32_t *high_time;    /**< Last high pulse, us */
+} di_capture_registers_t;
+
+/** Input registers of one edge log entry */
+typedef struct
+{
+    uint32_t *time;  /**< Edge time, us */
+    uint16_t *event; /**< Input and edge direction */
+} di_edge_registers_t;
+
+/** Newest edges taken from the BSP edge FIFO, slot = sequence modulo
+ * DI_EDGE_LOG_COUNT; input register reads are serialized by the Modbus
+ * register mutex */
+static bsp_gpiodi_edge_t s_edge_log[DI_EDGE_LOG_COUNT];
+
+/** Edges taken from the BSP edge FIFO so far */
+static uint32_t s_edge_sequence;
+
+/** Input registers of the figures of one analysed ADC channel */
+typedef struct
+{
+    uint16_t *mean;      /**< Mean, 0.1 mV */
+    uint16_t *rms;       /**< AC RMS, 0.1 mV */
+    uint16_t *peak;      /**< Largest deviation from the mean, 0.1 mV */
+    uint16_t *frequency; /**< Fundamental frequency, 0.1 Hz */
+    uint16_t *amplitude; /**< Fundamental amplitude, 0.1 mV */
+    uint16_t *thd;       /**< Total harmonic distortion, 0.01 % */
+} spectrum_registers_t;
+
+/** Input registers of the figures of one ADC channel over one window */
+typedef struct
+{
+    uint16_t *min;  /**< Lowest filtered value, 0.1 mV */
+    uint16_t *max;  /**< Highest filtered value, 0.1 mV */
+    uint16_t *mean; /**< Mean, 0.1 mV */
+    uint16_t *rms;  /**< RMS, 0.1 mV */
+} adc_stats_registers_t;
+
+/** Input registers of channel @p ch over window @p win (1s, 10s, 1min) */
+#define ADC_STATS_REGISTERS(regs, ch, win)                           \
+    ((adc_stats_registers_t){&(regs)->adc_stats_##ch##_##win##_min,  \
+                             &(regs)->adc_stats_##ch##_##win##_max,  \
+                             &(regs)->adc_stats_##ch##_##win##_mean, \
+                             &(regs)->adc_stats_##ch##_##win##_rms})
+
+/** Input registers of the result of one monitored tone */
+typedef struct
+{
+    uint16_t *magnitude; /**< Amplitude, 0.1 mV */
+    int16_t  *phase;     /**< Phase, 0.01 degree */
+} goertzel_result_registers_t;
+
+/** Input registers of tone @p n */
+#define GOERTZEL_RESULT_REGISTERS(regs, n)                              \
+    ((goertzel_result_registers_t){&(regs)->goertzel_##n##_magnitude, \
+                                   &(regs)->goertzel_##n##_phase})
+
+/** Input registers of the result of one metered pair */
+typedef struct
+{
+    float    *real;            /**< Real power, W */
+    float    *apparent;        /**< Apparent power, VA */
+    uint32_t *imported_wh;     /**< Real energy taken, Wh, wrapping */
+    uint32_t *exported_wh;     /**< Real energy given back, Wh, wrapping */
+    uint64_t *imported;        /**< Real energy taken, mWh */
+    uint64_t *exported;        /**< Real energy given back, mWh */
+    uint64_t *apparent_energy; /**< Apparent energy, mVAh */
+} power_result_registers_t;
+
+/** Input registers of pair @p n */
+#define POWER_RESULT_REGISTERS(regs, n)                              \
+    ((power_result_registers_t){&(regs)->power_##n##_real,           \
+                                &(regs)->power_##n##_apparent,       \
+                                &(regs)->power_##n##_imported_wh,    \
+                                &(regs)->power_##n##_exported_wh,    \
+                                &(regs)->power_##n##_imported,       \
+                                &(regs)->power_##n##_exported,       \
+                                &(regs)->power_##n##_apparent_energy})
+
+/** Change detector cursors of the millivolt and the float32 ADC registers;
+ * holding register reads are serialized by the Modbus register mutex */
+static adc_change_cursor_t s_adc_value_cursor;
+static adc_change_cursor_t s_adc_voltage_cursor;
+
+/** Working registers of one PWM channel */
+typedef struct
+{
+    uint16_t *duty;      /**< Duty cycle, 0.01 % */
+    uint32_t *frequency; /**< Frequency, Hz */
+} pwm_registers_t;
+
+/** Registers between the calibration registers of two ADC channels */
+#define ADC_CALIBRATION_STRIDE \
+    (JERRY_DEVICE_HR_ADC_1_CAL_GAIN - JERRY_DEVICE_HR_ADC_0_CAL_GAIN)
+
+/** Calibration registers of one ADC channel */
+typedef struct
+{
+    float *gain;   /**< Value at full scale */
+    float *offset; /**< Value at a reading of 0 */
+} adc_calibration_registers_t;
+
 /**
- * @brief Update a Modbus register with a filtered ADC value in millivolts
+ * @brief Update the ADC holding registers with filtered values in millivolts
  *
- * Reads the filtered ADC value from the specified channel, converts it from
- * volts to millivolts, and stores the result in both the register structure
- * field and the output array. The update only occurs if the ADC filter has
- * settled (reached steady state).
+ * Takes the values the change detector last published (adc_change.h) and
+ * converts them in a single CMSIS-DSP pass: scaled by 1000 / 32768, a
+ * value in volts becomes the millivolt count as a q15 integer, and
+ * arm_float_to_q15() truncates and saturates it. Only the channels that
+ * moved beyond their deadband since the last update are rewritten; nothing
+ * is published before the ADC filter has settled.
  *
- * @param[in]  channel      ADC1 channel index (e.g., BSP_ADC1_CHANNEL_A0)
- * @param[out] pStructField Pointer to the holding register structure field to
- * update
- * @param[out] pArr         Pointer to the Modbus response array element to
- * update
+ * @param regs Pointer to holding registers structure
  *
- * @note If the filter has not settled or the ADC read fails, no update is
- * performed
- * @note The ADC value is converted from volts (float) to millivolts (uint16_t)
+ * @note Negative filter outputs (undershoot) read as 0 mV
  *
- * @see BSP_ADC1_IsFilterSettled()
- * @see BSP_ADC1_GetFilteredValue()
+ * @see adc_change_poll()
  */
-static void update_reg_with_adcval(uint16_t channel, uint16_t *pStructField,
-                                   uint16_t *pArr)
+static void update_adc_registers(jerry_device_holding_registers_t *regs)
 {
-    // by default we get values in volts and hence float
-    float32_t adcValv = 0;
-    // then we convert it to mv and save it in an integer
-    uint16_t adcValmv = 0;
-    if (BSP_ADC1_IsFilterSettled())
+    uint16_t *const fields[ADC_REGISTER_COUNT] = {
+        &regs->adc_0_value, &regs->adc_1_value, &regs->adc_2_value,
+        &regs->adc_3_value};
+    float32_t volts[ADC_CHANGE_CHANNELS];
+    q15_t     millivolts[ADC_CHANGE_CHANNELS];
+    uint32_t  changed =
+        adc_change_poll(&s_adc_value_cursor, volts) & ADC_REGISTER_CHANNELS;
+
+    if (changed == 0U)
+    {
+        return;
+    }
+
+    arm_scale_f32(volts, 1000.0f / 32768.0f, volts, ADC_CHANGE_CHANNELS);
+    arm_float_to_q15(volts, millivolts, ADC_CHANGE_CHANNELS);
+
+    /* Registers A0..A3 map to channels BSP_ADC1_CHANNEL_A0..A3 */
+    for (uint16_t ch = 0U; ch < ADC_REGISTER_COUNT; ch++)
     {
-        if (BSP_OK != BSP_ADC1_GetFilteredValue(channel, &adcValv))
+        if ((changed & (1UL << ch)) != 0U)
         {
-            adcValv = 0.0f;
+            *fields[ch] = (millivolts[ch] > 0) ? (uint16_t)millivolts[ch]
+                                               : (uint16_t)0U;
         }
+    }
+}
+
+/**
+ * @brief Update the float32 ADC holding registers with filtered values
+ *
+ * Full resolution counterpart of update_adc_registers(): the published
+ * value in volts is stored as is, and the generated address map sends each
+ * value as two registers in the device word order. It polls the change
+ * detector with a cursor of its own, so either block can be read first.
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_adc_voltage_registers(jerry_device_holding_registers_t *regs)
+{
+    float *const fields[ADC_REGISTER_COUNT] = {
+        &regs->adc_0_voltage, &regs->adc_1_voltage, &regs->adc_2_voltage,
+        &regs->adc_3_voltage};
+    float32_t volts[ADC_CHANGE_CHANNELS];
+    uint32_t  changed =
+        adc_change_poll(&s_adc_voltage_cursor, volts) & ADC_REGISTER_CHANNELS;
 
-        adcValmv = (uint16_t)(adcValv * 1000.0);
-        *pArr = *pStructField = adcValmv;
+    for (uint16_t ch = 0U; ch < ADC_REGISTER_COUNT; ch++)
+    {
+        if ((changed & (1UL << ch)) != 0U)
+        {
+            *fields[ch] = volts[ch];
+        }
     }
 }
 
@@ -91,291 +374,1833 @@ static void update_system_tick_registers(jerry_device_holding_registers_t *regs)
 }
 
 /**
- * @brief Update a digital output via I2C and sync the coil register
+ * @brief Update the ADC timestamp register from the filter
+ *
+ * @param regs Pointer to holding registers structure
  *
- * Reads the current I2C expander state, modifies the specified channel bit,
- * writes the new state back, and updates the coil register field on success.
+ * @note The capture time is stored in microseconds (low 32 bits); if no
+ *       block has been filtered yet the register keeps its last value
+ */
+static void update_adc_timestamp_register(
+    jerry_device_holding_registers_t *regs)
+{
+    uint64_t ticks = 0U;
+
+    if (BSP_OK == BSP_ADC1_GetFilteredTimestamp(&ticks))
+    {
+        regs->adc_timestamp =
+            (uint32_t)(ticks / (BSP_ADC1_TIMESTAMP_HZ / 1000000UL));
+    }
+}
+
+/**
+ * @brief Update the mains frequency register from the filter
  *
- * @param[in]  channel Channel index (BSP_I2CDO_INDEX_D0 to BSP_I2CDO_INDEX_D15)
- * @param[in]  val     New output value (true = ON, false = OFF)
- * @param[out] pCoil   Pointer to coil register field to update (can be NULL)
+ * @param regs Pointer to holding registers structure
  *
- * @note The coil register is only updated if the I2C write succeeds
+ * @note The frequency is stored in 0.01 Hz units, 0 when not tracking
  */
-static void update_digital_output(uint16_t channel, bool val, bool *pCoil)
+static void update_mains_frequency_register(
+    jerry_device_holding_registers_t *regs)
 {
-    if (channel < 16U)
+    float32_t frequency = 0.0f;
+
+    if (BSP_OK != BSP_ADC1_GetMainsFrequency(&frequency))
     {
-        uint16_t    initVal = 0U;
-        bsp_error_t err     = BSP_I2CDO_Read(&initVal);
+        frequency = 0.0f;
+    }
 
-        if (BSP_OK == err)
-        {
-            uint16_t mask     = BSP_I2CDO_CONSTRUCT_MASK(channel);
-            uint16_t finalVal = 0;
+    regs->adc_mains_frequency = (uint16_t)((frequency * 100.0f) + 0.5f);
+}
 
-            if (val == true)
-            {
-                finalVal = initVal | mask;
-            }
-            else
-            {
-                finalVal = initVal & (~mask);
-            }
+/**
+ * @brief Hand the stream registers to the ADC stream task
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_stream_config(const jerry_device_holding_registers_t *regs)
+{
+    adc_stream_config_t config;
 
-            err = BSP_I2CDO_Write(finalVal);
+    config.enable       = (regs->adc_stream_enable != 0U);
+    config.content      = (uint8_t)regs->adc_stream_content;
+    config.channel_mask = (uint8_t)regs->adc_stream_channels;
+    config.decimated    = (regs->adc_stream_decimated != 0U);
+    config.compress     = (regs->adc_stream_compress != 0U);
+    config.dest_addr    = ((uint32_t)regs->adc_stream_ip_high << 16U) |
+                       (uint32_t)regs->adc_stream_ip_low;
+    config.dest_port = regs->adc_stream_port;
 
-            if ((BSP_OK == err) && (NULL != pCoil))
-            {
-                *pCoil = val;
-            }
-        }
+    adc_stream_set_config(&config);
+}
+
+/**
+ * @brief Hand the telemetry registers to the telemetry module
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void
+update_telemetry_config(const jerry_device_holding_registers_t *regs)
+{
+    telemetry_config_t config;
+
+    config.period_s  = regs->telemetry_period_s;
+    config.dest_addr = ((uint32_t)regs->telemetry_ip_high << 16U) |
+                       (uint32_t)regs->telemetry_ip_low;
+    config.dest_port = regs->telemetry_port;
+
+    telemetry_set_config(&config);
+}
+
+/**
+ * @brief Hand the CAN publish registers to the CAN publish job
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_can_config(const jerry_device_holding_registers_t *regs)
+{
+    can_publish_config_t config;
+
+    config.rate_hz      = regs->can_publish_rate;
+    config.nominal_kbps = regs->can_nominal_bitrate;
+    config.data_kbps    = regs->can_data_bitrate;
+
+    can_publish_set_config(&config);
+}
+
+/**
+ * @brief Hand the capture registers to the ADC capture job
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_capture_config(const jerry_device_holding_registers_t *regs)
+{
+    adc_capture_config_t config;
+
+    config.trigger      = regs->adc_capture_trigger;
+    config.input        = regs->adc_capture_input;
+    config.level_mv     = regs->adc_capture_level;
+    config.pre_samples  = regs->adc_capture_pre_samples;
+    config.post_samples = regs->adc_capture_post_samples;
+
+    adc_capture_set_config(&config);
+}
+
+/**
+ * @brief Hand the snapshot registers to the snapshot publish task
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_snapshot_config(const jerry_device_holding_registers_t *regs)
+{
+    snapshot_publish_config_t config;
+
+    config.rate_hz   = regs->snapshot_rate_hz;
+    config.dest_addr = ((uint32_t)regs->snapshot_ip_high << 16U) |
+                       (uint32_t)regs->snapshot_ip_low;
+    config.dest_port = regs->snapshot_port;
+
+    snapshot_publish_set_config(&config);
+}
+
+/**
+ * @brief Hand the MQTT registers to the MQTT publisher
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_mqtt_config(const jerry_device_holding_registers_t *regs)
+{
+    mqtt_client_config_t config;
+
+    config.period_ms   = regs->mqtt_period_ms;
+    config.broker_addr = ((uint32_t)regs->mqtt_ip_high << 16U) |
+                         (uint32_t)regs->mqtt_ip_low;
+    config.broker_port = regs->mqtt_port;
+    config.qos_mask    = (uint8_t)regs->mqtt_qos;
+    config.keepalive_s = regs->mqtt_keepalive_s;
+
+    mqtt_client_set_config(&config);
+}
+
+/**
+ * @brief Hand the network cache registers to the network bring-up cache
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void
+update_net_cache_config(const jerry_device_holding_registers_t *regs)
+{
+    net_cache_config_t config;
+
+    config.lease_addr  = ((uint32_t)regs->net_lease_ip_high << 16U) |
+                         (uint32_t)regs->net_lease_ip_low;
+    config.master_addr = ((uint32_t)regs->net_master_ip_high << 16U) |
+                         (uint32_t)regs->net_master_ip_low;
+
+    config.master_mac[0] = (uint8_t)(regs->net_master_mac_high >> 8U);
+    config.master_mac[1] = (uint8_t)regs->net_master_mac_high;
+    config.master_mac[2] = (uint8_t)(regs->net_master_mac_mid >> 8U);
+    config.master_mac[3] = (uint8_t)regs->net_master_mac_mid;
+    config.master_mac[4] = (uint8_t)(regs->net_master_mac_low >> 8U);
+    config.master_mac[5] = (uint8_t)regs->net_master_mac_low;
+
+    net_cache_set_config(&config);
+}
+
+/**
+ * @brief Hand the VLAN registers to the Ethernet driver
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_vlan_config(const jerry_device_holding_registers_t *regs)
+{
+    ethernetif_vlan_config_t config;
+
+    config.enabled = (regs->net_vlan_enable != 0U);
+    config.vlan_id = regs->net_vlan_id;
+    config.pcp[ETHERNETIF_TX_CLASS_CONTROL] =
+        (uint8_t)regs->net_vlan_pcp_control;
+    config.pcp[ETHERNETIF_TX_CLASS_DEFAULT] =
+        (uint8_t)regs->net_vlan_pcp_default;
+    config.pcp[ETHERNETIF_TX_CLASS_BULK] = (uint8_t)regs->net_vlan_pcp_bulk;
+
+    ethernetif_set_vlan(&config);
+}
+
+/**
+ * @brief Hand the firmware update progress registers to the FOTA task
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_fota_resume(const jerry_device_holding_registers_t *regs)
+{
+    fota_resume_set(((uint32_t)regs->fota_resume_tag_high << 16U) |
+                        (uint32_t)regs->fota_resume_tag_low,
+                    regs->fota_resume_kib);
+}
+
+/**
+ * @brief Hand the anomaly alarm registers to the anomaly detector
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_anomaly_config(const jerry_device_holding_registers_t *regs)
+{
+    anomaly_config_t config;
+
+    config.threshold   = regs->anomaly_threshold;
+    config.hold_frames = regs->anomaly_hold_frames;
+
+    anomaly_set_config(&config);
+}
+
+/**
+ * @brief Locate the registers of an analog watchdog
+ *
+ * @param[in] regs Holding registers structure
+ * @param[in] awd  Watchdog, below BSP_ADC1_AWD_COUNT
+ *
+ * @return adc_watchdog_registers_t Registers of the watchdog
+ */
+static adc_watchdog_registers_t
+adc_watchdog_registers(jerry_device_holding_registers_t *regs, uint8_t awd)
+{
+    adc_watchdog_registers_t wd;
+
+    switch (awd)
+    {
+        case 0U:
+            wd = (adc_watchdog_registers_t){
+                &regs->adc_awd_0_channel, &regs->adc_awd_0_low,
+                &regs->adc_awd_0_high, &regs->adc_awd_0_interlocks};
+            break;
+        case 1U:
+            wd = (adc_watchdog_registers_t){
+                &regs->adc_awd_1_channel, &regs->adc_awd_1_low,
+                &regs->adc_awd_1_high, &regs->adc_awd_1_interlocks};
+            break;
+        default:
+            wd = (adc_watchdog_registers_t){
+                &regs->adc_awd_2_channel, &regs->adc_awd_2_low,
+                &regs->adc_awd_2_high, &regs->adc_awd_2_interlocks};
+            break;
     }
+
+    return wd;
 }
 
 /**
- * @brief Read a GPIO digital input and update coil/discrete input registers
+ * @brief Hand the registers of an analog watchdog to the BSP and the
+ * interlocks
  *
- * Reads the current state of the specified GPIO digital input channel using
- * the BSP layer and optionally updates the coil and/or discrete input register
- * fields with the result.
+ * A window written one bound at a time can pass through a lowest result
+ * above the highest; it is not applied until the other bound is written.
  *
- * @param[in]  channel GPIO digital input channel index
- *                     (BSP_GPIODI_INDEX_0 through BSP_GPIODI_INDEX_7)
- * @param[out] pCoil   Pointer to coil register field to update (can be NULL)
- * @param[out] pDi     Pointer to discrete input register field to update (can
- *                     be NULL)
+ * @param regs Pointer to holding registers structure
+ * @param awd  Watchdog, below BSP_ADC1_AWD_COUNT
+ */
+static void update_adc_watchdog_config(jerry_device_holding_registers_t *regs,
+                                       uint8_t                           awd)
+{
+    adc_watchdog_registers_t wd = adc_watchdog_registers(regs, awd);
+    bsp_adc1_awd_config_t    config;
+
+    interlock_set_watchdog_rules(awd, *wd.interlocks);
+
+    config.channel = (uint8_t)*wd.channel;
+    config.low     = (*wd.low < BSP_ADC1_FULL_SCALE)
+                         ? *wd.low
+                         : (uint16_t)BSP_ADC1_FULL_SCALE;
+    config.high    = (*wd.high < BSP_ADC1_FULL_SCALE)
+                         ? *wd.high
+                         : (uint16_t)BSP_ADC1_FULL_SCALE;
+    (void)BSP_ADC1_SetWatchdog(awd, &config);
+}
+
+/**
+ * @brief Locate the holding registers of a monitored tone
  *
- * @return bsp_error_t
- * @retval BSP_OK    Read operation successful, output pointers updated
- * @retval BSP_ERROR Invalid channel or BSP read failure
+ * @param[in] regs Holding registers structure
+ * @param[in] tone Tone, below GOERTZEL_TONES
+ *
+ * @return goertzel_tone_registers_t Registers of the tone
  */
-static bsp_error_t update_digital_input(unsigned int channel, bool *pCoil,
-                                        bool *pDi)
+static goertzel_tone_registers_t
+goertzel_tone_registers(jerry_device_holding_registers_t *regs, uint8_t tone)
 {
-    bsp_error_t apiStatus;
-    uint32_t    inVal = 0;
+    switch (tone)
+    {
+        case 0U:
+            return GOERTZEL_TONE_REGISTERS(regs, 0);
+        case 1U:
+            return GOERTZEL_TONE_REGISTERS(regs, 1);
+        case 2U:
+            return GOERTZEL_TONE_REGISTERS(regs, 2);
+        case 3U:
+            return GOERTZEL_TONE_REGISTERS(regs, 3);
+        case 4U:
+            return GOERTZEL_TONE_REGISTERS(regs, 4);
+        case 5U:
+            return GOERTZEL_TONE_REGISTERS(regs, 5);
+        case 6U:
+            return GOERTZEL_TONE_REGISTERS(regs, 6);
+        default:
+            return GOERTZEL_TONE_REGISTERS(regs, 7);
+    }
+}
 
-    apiStatus = BSP_GPIODI_Read(channel, &inVal);
-    if (BSP_OK == apiStatus)
+/**
+ * @brief Hand the tone monitor registers to the tone monitor
+ *
+ * @param regs Pointer to holding registers structure
+ */
+static void update_goertzel_config(jerry_device_holding_registers_t *regs)
+{
+    goertzel_config_t config;
+
+    config.window_ms = regs->goertzel_window_ms;
+    for (uint8_t t = 0U; t < GOERTZEL_TONES; t++)
     {
-        if (NULL != pCoil)
-        {
-            *pCoil = inVal != 0;
-        }
-        if (NULL != pDi)
-        {
-            *pDi = inVal != 0;
-        }
+        goertzel_tone_registers_t tone = goertzel_tone_registers(regs, t);
+
+        config.tones[t].channel   = *tone.channel;
+        config.tones[t].frequency = *tone.frequency;
     }
 
-    return apiStatus;
+    goertzel_set_config(&config);
 }
 
-/* ==========================================================================
- * Coil Callbacks (FC01, FC05, FC15)
- * ========================================================================== */
+/**
+ * @brief Locate the holding registers of a metered pair
+ *
+ * @param[in] regs Holding registers structure
+ * @param[in] pair Pair, below POWER_METER_PAIRS
+ *
+ * @return power_pair_registers_t Registers of the pair
+ */
+static power_pair_registers_t
+power_pair_registers(jerry_device_holding_registers_t *regs, uint8_t pair)
+{
+    switch (pair)
+    {
+        case 0U:
+            return POWER_PAIR_REGISTERS(regs, 0);
+        case 1U:
+            return POWER_PAIR_REGISTERS(regs, 1);
+        default:
+            return POWER_PAIR_REGISTERS(regs, 2);
+    }
+}
 
 /**
- * @brief Read coils callback (FC01)
+ * @brief Hand the power meter registers to the power meter
+ *
+ * @param regs Pointer to holding registers structure
  */
-modbus_exception_t modbus_cb_read_coils(uint16_t start_address,
-                                        uint16_t quantity, uint8_t *coil_values)
+static void update_power_meter_config(jerry_device_holding_registers_t *regs)
 {
-    jerry_device_coils_t *coils       = jerry_device_get_coils();
-    uint16_t              end_address = start_address + quantity - 1U;
-    uint16_t              byte_index;
-    uint16_t              bit_index;
-    bool                  value;
+    power_meter_config_t config;
 
-    /* Validate address range */
-    if (!ADDR_IN_RANGE_FROM_ZERO(start_address, JERRY_DEVICE_COIL_MAX_ADDR) ||
-        !ADDR_IN_RANGE_FROM_ZERO(end_address, JERRY_DEVICE_COIL_MAX_ADDR))
+    config.window_ms = regs->power_window_ms;
+    for (uint8_t p = 0U; p < POWER_METER_PAIRS; p++)
     {
-        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+        power_pair_registers_t pair = power_pair_registers(regs, p);
+
+        config.pairs[p].voltage = *pair.voltage;
+        config.pairs[p].current = *pair.current;
     }
 
-    /* Clear output buffer */
-    for (uint16_t i = 0U; i < ((quantity + 7U) / 8U); i++)
+    power_meter_set_config(&config);
+}
+
+/**
+ * @brief Update a group of digital outputs with a single expander commit
+ *
+ * Stages the bits selected by @p mask in the BSP shadow image and commits
+ * it once, so a multi-coil write costs one transfer per expander and no
+ * read-back. The commit runs interrupt-driven on I2C3 and the calling
+ * worker sleeps on its completion notification instead of polling the bus.
+ * If the commit fails the staged change is dropped, keeping the shadow
+ * image in step with the coil registers. Outputs held by the interlocks
+ * (interlock.h) keep their forced states, and a commit that finds their
+ * write in flight is retried until it is done.
+ *
+ * @param[in] mask  Output channels to change (bit n = BSP_I2CDO_INDEX_Dn)
+ * @param[in] value New output states for the channels in @p mask
+ *
+ * @return bsp_error_t BSP_OK if the expanders were updated
+ */
+static bsp_error_t update_digital_outputs(uint32_t mask, uint32_t value)
+{
+    /* Callbacks are serialized by the Modbus register mutex */
+    static bsp_i2cdo_xfer_t s_xfer;
+
+    bsp_error_t err   = BSP_I2CDO_Stage(mask, value);
+    TickType_t  start = xTaskGetTickCount();
+
+    while (BSP_OK == err)
     {
-        coil_values[i] = 0U;
+        err = BSP_I2CDO_CommitAsync(&s_xfer);
+        if ((BSP_BUSY != err) || ((xTaskGetTickCount() - start) >=
+                                  pdMS_TO_TICKS(BSP_I2CDO_TIMEOUT)))
+        {
+            break;
+        }
+        /* An interlock write, two bytes on the bus */
+        vTaskDelay(1U);
+        err = BSP_OK;
     }
 
-    /* Read each coil */
-    for (uint16_t i = 0U; i < quantity; i++)
+    if (BSP_OK == err)
     {
-        uint16_t addr = start_address + i;
-        value         = false;
-
-        switch (addr)
-        {
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_0:
-                value = coils->digital_output_0;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_1:
-                value = coils->digital_output_1;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_2:
-                value = coils->digital_output_2;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_3:
-                value = coils->digital_output_3;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_4:
-                value = coils->digital_output_4;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_5:
-                value = coils->digital_output_5;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_6:
-                value = coils->digital_output_6;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_7:
-                value = coils->digital_output_7;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_8:
-                value = coils->digital_output_8;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_9:
-                value = coils->digital_output_9;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_10:
-                value = coils->digital_output_10;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_11:
-                value = coils->digital_output_11;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_12:
-                value = coils->digital_output_12;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_13:
-                value = coils->digital_output_13;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_14:
-                value = coils->digital_output_14;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_15:
-                value = coils->digital_output_15;
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_INPUT_0:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_0,
-                                                   &(coils->digital_input_0),
-                                                   NULL))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = coils->digital_input_0;
-                }
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_INPUT_1:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_1,
-                                                   &(coils->digital_input_1),
-                                                   NULL))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = coils->digital_input_1;
-                }
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_INPUT_2:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_2,
-                                                   &(coils->digital_input_2),
-                                                   NULL))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = coils->digital_input_2;
-                }
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_INPUT_3:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_3,
-                                                   &(coils->digital_input_3),
-                                                   NULL))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = coils->digital_input_3;
-                }
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_INPUT_4:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_4,
-                                                   &(coils->digital_input_4),
-                                                   NULL))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = coils->digital_input_4;
-                }
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_INPUT_5:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_5,
-                                                   &(coils->digital_input_5),
-                                                   NULL))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = coils->digital_input_5;
-                }
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_INPUT_6:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_6,
-                                                   &(coils->digital_input_6),
-                                                   NULL))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = coils->digital_input_6;
-                }
-                break;
-            case JERRY_DEVICE_COIL_DIGITAL_INPUT_7:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_7,
-                                                   &(coils->digital_input_7),
-                                                   NULL))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = coils->digital_input_7;
-                }
-                break;
-            case JERRY_DEVICE_COIL_PWM_0_ENABLE:
-                value = coils->pwm_0_enable;
-                break;
-            case JERRY_DEVICE_COIL_PWM_1_ENABLE:
-                value = coils->pwm_1_enable;
-                break;
-            case JERRY_DEVICE_COIL_PWM_2_ENABLE:
-                value = coils->pwm_2_enable;
-                break;
-            case JERRY_DEVICE_COIL_PWM_3_ENABLE:
-                value = coils->pwm_3_enable;
-                break;
-            default:
-                return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+        err = BSP_I2CDO_Wait(&s_xfer, BSP_I2CDO_TIMEOUT);
+    }
+
+    if (BSP_OK != err)
+    {
+        BSP_I2CDO_Discard();
+    }
+
+    return err;
+}
+
+/**
+ * @brief Locate the registers of a PWM channel
+ *
+ * @param[in] regs Holding registers structure
+ * @param[in] ch   PWM channel, below BSP_PWM_COUNT
+ *
+ * @return pwm_registers_t Duty cycle and frequency of the channel
+ */
+static pwm_registers_t pwm_registers(jerry_device_holding_registers_t *regs,
+                                     uint8_t                           ch)
+{
+    pwm_registers_t pwm;
+
+    switch (ch)
+    {
+        case 0U:
+            pwm.duty      = &regs->pwm_0_duty_cycle;
+            pwm.frequency = &regs->pwm_0_frequency;
+            break;
+        case 1U:
+            pwm.duty      = &regs->pwm_1_duty_cycle;
+            pwm.frequency = &regs->pwm_1_frequency;
+            break;
+        case 2U:
+            pwm.duty      = &regs->pwm_2_duty_cycle;
+            pwm.frequency = &regs->pwm_2_frequency;
+            break;
+        default:
+            pwm.duty      = &regs->pwm_3_duty_cycle;
+            pwm.frequency = &regs->pwm_3_frequency;
+            break;
+    }
+
+    return pwm;
+}
+
+/**
+ * @brief Drive the PWM outputs whose registers or enable coils changed
+ *
+ * Called once per request, after the whole block is stored and its
+ * frequencies checked (holding_block_commit()). The BSP preloads the timer,
+ * so the new setting starts at the next period boundary without waiting
+ * for the Modbus task.
+ *
+ * @param[in] channels PWM channels to update (bit n = channel n)
+ *
+ * @return modbus_exception_t MODBUS_EXCEPTION_NONE if every channel was
+ * applied
+ */
+static modbus_exception_t update_pwm_outputs(uint8_t channels)
+{
+    jerry_device_holding_registers_t *regs =
+        jerry_device_get_holding_registers();
+    modbus_exception_t result = MODBUS_EXCEPTION_NONE;
+    uint32_t           enabled;
+
+    enabled = jerry_device_coils_get_bits(
+        JERRY_DEVICE_COIL_GROUP_PWM_CONTROL_ADDR,
+        JERRY_DEVICE_COIL_GROUP_PWM_CONTROL_COUNT);
+
+    for (uint8_t ch = 0U; ch < BSP_PWM_COUNT; ch++)
+    {
+        pwm_registers_t pwm;
+        bsp_error_t     err;
+
+        if ((channels & PWM_CHANNEL_BIT(ch)) == 0U)
+        {
+            continue;
+        }
+
+        pwm = pwm_registers(regs, ch);
+        if ((enabled & (1UL << ch)) != 0U)
+        {
+            err = BSP_PWM_Start(ch, *pwm.frequency, *pwm.duty);
+        }
+        else
+        {
+            err = BSP_PWM_Stop(ch);
+        }
+
+        if (BSP_OK != err)
+        {
+            result = MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Locate the calibration registers of an ADC channel
+ *
+ * @param[in] regs Holding registers structure
+ * @param[in] ch   ADC channel, below ADC_REGISTER_COUNT
+ *
+ * @return adc_calibration_registers_t Gain and offset of the channel
+ */
+static adc_calibration_registers_t
+adc_calibration_registers(jerry_device_holding_registers_t *regs, uint8_t ch)
+{
+    adc_calibration_registers_t cal;
+
+    switch (ch)
+    {
+        case 0U:
+            cal.gain   = &regs->adc_0_cal_gain;
+            cal.offset = &regs->adc_0_cal_offset;
+            break;
+        case 1U:
+            cal.gain   = &regs->adc_1_cal_gain;
+            cal.offset = &regs->adc_1_cal_offset;
+            break;
+        case 2U:
+            cal.gain   = &regs->adc_2_cal_gain;
+            cal.offset = &regs->adc_2_cal_offset;
+            break;
+        default:
+            cal.gain   = &regs->adc_3_cal_gain;
+            cal.offset = &regs->adc_3_cal_offset;
+            break;
+    }
+
+    return cal;
+}
+
+/**
+ * @brief Hand the ADC calibrations a request wrote to the filter task
+ *
+ * Called once per request, after the whole block is stored and its
+ * calibrations checked (holding_block_valid()). The filter task applies
+ * the calibration from its next block on.
+ *
+ * @param[in] channels ADC channels to update (bit n = channel n)
+ *
+ * @return modbus_exception_t MODBUS_EXCEPTION_NONE if every channel was
+ * applied
+ */
+static modbus_exception_t update_adc_calibration(uint8_t channels)
+{
+    jerry_device_holding_registers_t *regs =
+        jerry_device_get_holding_registers();
+    modbus_exception_t result = MODBUS_EXCEPTION_NONE;
+
+    for (uint8_t ch = 0U; ch < ADC_REGISTER_COUNT; ch++)
+    {
+        adc_calibration_registers_t cal;
+
+        if ((channels & (1U << ch)) == 0U)
+        {
+            continue;
+        }
+
+        cal = adc_calibration_registers(regs, ch);
+        if (BSP_OK != BSP_ADC1_SetCalibration(ch, *cal.gain, *cal.offset))
+        {
+            result = MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Locate the registers of a control loop
+ *
+ * @param[in] regs Holding registers structure
+ * @param[in] loop Control loop, below CONTROL_LOOP_COUNT
+ *
+ * @return control_registers_t Registers of the loop
+ */
+static control_registers_t
+control_registers(jerry_device_holding_registers_t *regs, uint8_t loop)
+{
+    control_registers_t ctl;
+
+    switch (loop)
+    {
+        case 0U:
+            ctl = (control_registers_t){
+                &regs->control_0_enable, &regs->control_0_input,
+                &regs->control_0_output, &regs->control_0_setpoint,
+                &regs->control_0_kp, &regs->control_0_ki,
+                &regs->control_0_kd, &regs->control_0_output_min,
+                &regs->control_0_output_max};
+            break;
+        case 1U:
+            ctl = (control_registers_t){
+                &regs->control_1_enable, &regs->control_1_input,
+                &regs->control_1_output, &regs->control_1_setpoint,
+                &regs->control_1_kp, &regs->control_1_ki,
+                &regs->control_1_kd, &regs->control_1_output_min,
+                &regs->control_1_output_max};
+            break;
+        case 2U:
+            ctl = (control_registers_t){
+                &regs->control_2_enable, &regs->control_2_input,
+                &regs->control_2_output, &regs->control_2_setpoint,
+                &regs->control_2_kp, &regs->control_2_ki,
+                &regs->control_2_kd, &regs->control_2_output_min,
+                &regs->control_2_output_max};
+            break;
+        default:
+            ctl = (control_registers_t){
+                &regs->control_3_enable, &regs->control_3_input,
+                &regs->control_3_output, &regs->control_3_setpoint,
+                &regs->control_3_kp, &regs->control_3_ki,
+                &regs->control_3_kd, &regs->control_3_output_min,
+                &regs->control_3_output_max};
+            break;
+    }
+
+    return ctl;
+}
+
+/**
+ * @brief Validate, store and apply one analog watchdog register
+ *
+ * @param[in] regs    Holding registers structure
+ * @param[in] address Register address, inside the watchdog registers
+ * @param[in] value   New value
+ *
+ * @return modbus_exception_t MODBUS_EXCEPTION_NONE if the value was stored
+ */
+static modbus_exception_t
+write_adc_watchdog_register(jerry_device_holding_registers_t *regs,
+                            uint16_t address, uint16_t value)
+{
+    uint16_t offset = (uint16_t)(address - JERRY_DEVICE_HR_ADC_AWD_0_CHANNEL);
+    uint8_t  awd    = (uint8_t)(offset / ADC_WATCHDOG_STRIDE);
+    adc_watchdog_registers_t wd = adc_watchdog_registers(regs, awd);
+
+    switch (offset % ADC_WATCHDOG_STRIDE)
+    {
+        case ADC_WATCHDOG_FIELD(CHANNEL):
+            if (value >= BSP_ADC1_NUM_CHANNELS)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            *wd.channel = value;
+            break;
+        case ADC_WATCHDOG_FIELD(LOW):
+            *wd.low = value;
+            break;
+        case ADC_WATCHDOG_FIELD(HIGH):
+            *wd.high = value;
+            break;
+        case ADC_WATCHDOG_FIELD(INTERLOCKS):
+            if (((uint32_t)value >> JERRY_DEVICE_INTERLOCK_COUNT) != 0U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            *wd.interlocks = value;
+            break;
+        default:
+            return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    update_adc_watchdog_config(regs, awd);
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief Validate, store and apply one tone register
+ *
+ * @param[in] regs    Holding registers structure
+ * @param[in] address Register address, inside the tone registers
+ * @param[in] value   New value
+ *
+ * @return modbus_exception_t MODBUS_EXCEPTION_NONE if the value was stored
+ */
+static modbus_exception_t
+write_goertzel_register(jerry_device_holding_registers_t *regs,
+                        uint16_t address, uint16_t value)
+{
+    uint16_t offset = (uint16_t)(address - JERRY_DEVICE_HR_GOERTZEL_0_CHANNEL);
+    goertzel_tone_registers_t tone =
+        goertzel_tone_registers(regs, (uint8_t)(offset / GOERTZEL_STRIDE));
+
+    switch (offset % GOERTZEL_STRIDE)
+    {
+        case GOERTZEL_FIELD(CHANNEL):
+            if (value >= BSP_ADC1_NUM_CHANNELS)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            *tone.channel = value;
+            break;
+        case GOERTZEL_FIELD(FREQUENCY):
+            *tone.frequency = value;
+            break;
+        default:
+            return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    update_goertzel_config(regs);
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief Validate, store and apply one channel register of a metered pair
+ *
+ * @param[in] regs    Holding registers structure
+ * @param[in] address Register address, inside the pair registers
+ * @param[in] value   New value
+ *
+ * @return modbus_exception_t MODBUS_EXCEPTION_NONE if the value was stored
+ */
+static modbus_exception_t
+write_power_pair_register(jerry_device_holding_registers_t *regs,
+                          uint16_t address, uint16_t value)
+{
+    uint16_t offset =
+        (uint16_t)(address - JERRY_DEVICE_HR_POWER_0_VOLTAGE_CHANNEL);
+    power_pair_registers_t pair =
+        power_pair_registers(regs, (uint8_t)(offset / POWER_PAIR_STRIDE));
+
+    if (value >= BSP_ADC1_NUM_CHANNELS)
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+
+    switch (offset % POWER_PAIR_STRIDE)
+    {
+        case POWER_PAIR_FIELD(VOLTAGE):
+            *pair.voltage = value;
+            break;
+        case POWER_PAIR_FIELD(CURRENT):
+            *pair.current = value;
+            break;
+        default:
+            return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    update_power_meter_config(regs);
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief Validate, store and request the ADC1 sample rate
+ *
+ * The filter task switches to the rate and its coefficient set between
+ * blocks. A rate without a set, or faster than the conversion sequence,
+ * is refused.
+ *
+ * @param[in] regs  Holding registers structure
+ * @param[in] value Sample rate in Hz
+ *
+ * @return modbus_exception_t MODBUS_EXCEPTION_NONE if the rate was stored
+ */
+static modbus_exception_t
+write_adc_sample_rate(jerry_device_holding_registers_t *regs, uint16_t value)
+{
+    bsp_error_t status = BSP_ADC1_SetSampleRate(value);
+
+    if (status == BSP_INVALID_ARG)
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    if (status != BSP_OK)
+    {
+        return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
+    }
+    regs->adc_sample_rate = value;
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief Hand the registers of changed control loops to the control engine
+ *
+ * Called once per request, after the whole block is stored and its duty
+ * ranges checked (holding_block_valid()), so a loop never runs a
+ * half-written configuration. A loop starts from the duty cycle register
+ * of its PWM channel.
+ *
+ * @param[in] loops Control loops to update (bit n = loop n)
+ */
+static void update_control_loops(uint8_t loops)
+{
+    jerry_device_holding_registers_t *regs =
+        jerry_device_get_holding_registers();
+
+    for (uint8_t i = 0U; i < CONTROL_LOOP_COUNT; i++)
+    {
+        control_registers_t   ctl;
+        control_loop_config_t config;
+
+        if ((loops & (1U << i)) == 0U)
+        {
+            continue;
+        }
+
+        ctl               = control_registers(regs, i);
+        config.enable     = (*ctl.enable != 0U);
+        config.input      = (uint8_t)*ctl.input;
+        config.output     = (uint8_t)*ctl.output;
+        config.setpoint   = (float32_t)*ctl.setpoint / 1000.0f;
+        config.kp         = (float32_t)*ctl.kp;
+        config.ki         = (float32_t)*ctl.ki;
+        config.kd         = (float32_t)*ctl.kd * 0.01f;
+        config.output_min = *ctl.output_min;
+        config.output_max = *ctl.output_max;
+        config.start_duty = *pwm_registers(regs, config.output).duty;
+
+        control_loop_set_config(i, &config);
+    }
+}
+
+/**
+ * @brief Sample all GPIO digital inputs into one word
+ *
+ * One debounced snapshot of every input (BSP_GPIODI_ReadAll()), so a
+ * block of inputs is always coherent.
+ *
+ * @param[out] pBits Input states, bit n = BSP_GPIODI_INDEX_n
+ *
+ * @return bsp_error_t
+ * @retval BSP_OK    All inputs read, @p pBits updated
+ * @retval BSP_ERROR BSP read failure
+ */
+static bsp_error_t read_digital_inputs(uint32_t *pBits)
+{
+    uint8_t     bits      = 0U;
+    bsp_error_t apiStatus = BSP_GPIODI_ReadAll(&bits);
+
+    if (BSP_OK == apiStatus)
+    {
+        *pBits = bits;
+    }
+
+    return apiStatus;
+}
+
+/**
+ * @brief Locate the input registers of a captured digital input
+ *
+ * @param[in] regs Input registers structure
+ * @param[in] ch   Digital input, below GPIODI_CHANNEL_COUNT
+ *
+ * @return di_capture_registers_t Count, frequency and high time
+ */
+static di_capture_registers_t
+di_capture_registers(jerry_device_input_registers_t *regs, uint8_t ch)
+{
+    di_capture_registers_t di;
+
+    switch (ch)
+    {
+        case 0U:
+            di.rising_count = &regs->di_0_rising_count;
+            di.frequency    = &regs->di_0_frequency;
+            di.high_time    = &regs->di_0_high_time;
+            break;
+        case 1U:
+            di.rising_count = &regs->di_1_rising_count;
+            di.frequency    = &regs->di_1_frequency;
+            di.high_time    = &regs->di_1_high_time;
+            break;
+        case 2U:
+            di.rising_count = &regs->di_2_rising_count;
+            di.frequency    = &regs->di_2_frequency;
+            di.high_time    = &regs->di_2_high_time;
+            break;
+        case 3U:
+            di.rising_count = &regs->di_3_rising_count;
+            di.frequency    = &regs->di_3_frequency;
+            di.high_time    = &regs->di_3_high_time;
+            break;
+        case 4U:
+            di.rising_count = &regs->di_4_rising_count;
+            di.frequency    = &regs->di_4_frequency;
+            di.high_time    = &regs->di_4_high_time;
+            break;
+        case 5U:
+            di.rising_count = &regs->di_5_rising_count;
+            di.frequency    = &regs->di_5_frequency;
+            di.high_time    = &regs->di_5_high_time;
+            break;
+        case 6U:
+            di.rising_count = &regs->di_6_rising_count;
+            di.frequency    = &regs->di_6_frequency;
+            di.high_time    = &regs->di_6_high_time;
+            break;
+        default:
+            di.rising_count = &regs->di_7_rising_count;
+            di.frequency    = &regs->di_7_frequency;
+            di.high_time    = &regs->di_7_high_time;
+            break;
+    }
+
+    return di;
+}
+
+/**
+ * @brief Locate the input registers of an edge log entry
+ *
+ * @param[in] regs  Input registers structure
+ * @param[in] entry Entry, 0 is the newest edge
+ *
+ * @return di_edge_registers_t Time and event of the entry
+ */
+static di_edge_registers_t
+di_edge_registers(jerry_device_input_registers_t *regs, uint8_t entry)
+{
+    di_edge_registers_t edge;
+
+    switch (entry)
+    {
+        case 0U:
+            edge.time  = &regs->di_edge_0_time;
+            edge.event = &regs->di_edge_0_event;
+            break;
+        case 1U:
+            edge.time  = &regs->di_edge_1_time;
+            edge.event = &regs->di_edge_1_event;
+            break;
+        case 2U:
+            edge.time  = &regs->di_edge_2_time;
+            edge.event = &regs->di_edge_2_event;
+            break;
+        case 3U:
+            edge.time  = &regs->di_edge_3_time;
+            edge.event = &regs->di_edge_3_event;
+            break;
+        case 4U:
+            edge.time  = &regs->di_edge_4_time;
+            edge.event = &regs->di_edge_4_event;
+            break;
+        case 5U:
+            edge.time  = &regs->di_edge_5_time;
+            edge.event = &regs->di_edge_5_event;
+            break;
+        case 6U:
+            edge.time  = &regs->di_edge_6_time;
+            edge.event = &regs->di_edge_6_event;
+            break;
+        default:
+            edge.time  = &regs->di_edge_7_time;
+            edge.event = &regs->di_edge_7_event;
+            break;
+    }
+
+    return edge;
+}
+
+/**
+ * @brief Update the capture input registers of every digital input
+ *
+ * The frequency comes from the last period, so it is exact for a steady
+ * signal and reads 0 once the next rising edge is DI_STOPPED_PERIODS
+ * periods late. Inputs without capture read all zero, but for the count
+ * kept across a power loss by power_fail.h.
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_di_capture_registers(jerry_device_input_registers_t *regs)
+{
+    uint64_t now       = BSP_CycleCounter_Read64();
+    uint32_t cycles_hz = BSP_CycleCounter_Hz();
+    uint32_t cycles_us = cycles_hz / 1000000U;
+
+    for (uint8_t ch = 0U; ch < GPIODI_CHANNEL_COUNT; ch++)
+    {
+        di_capture_registers_t di = di_capture_registers(regs, ch);
+        bsp_gpiodi_capture_t   capture;
+
+        if (BSP_OK != BSP_GPIODI_CaptureRead(ch, &capture))
+        {
+            (void)memset(&capture, 0, sizeof(capture));
+        }
+
+#if POWER_FAIL
+        /* Counted on from the count at the last power loss */
+        *di.rising_count = power_fail_di_base(ch) + capture.rising;
+#else
+        *di.rising_count = capture.rising;
+#endif
+        *di.high_time    = capture.high_time / cycles_us;
+        if ((capture.period == 0U) ||
+            ((now - capture.last_rise) >
+             ((uint64_t)capture.period * DI_STOPPED_PERIODS)))
+        {
+            *di.frequency = 0U;
+        }
+        else
+        {
+            *di.frequency =
+                (uint32_t)(((uint64_t)cycles_hz * 1000U) / capture.period);
+        }
+    }
+}
+
+/**
+ * @brief Update the edge log input registers from the BSP edge FIFO
+ *
+ * Drains the FIFO and shows the newest DI_EDGE_LOG_COUNT edges, newest
+ * first, numbered by the edge sequence: a master that read sequence S
+ * before finds the edges since at entries 0 to (sequence - S - 1). Reading
+ * does not consume the log, only the FIFO behind it.
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_di_edge_registers(jerry_device_input_registers_t *regs)
+{
+    bsp_gpiodi_edge_t edges[DI_EDGE_LOG_COUNT];
+    uint32_t          count     = 0U;
+    uint32_t          cycles_us = BSP_CycleCounter_Hz() / 1000000U;
+
+    do
+    {
+        if (BSP_OK != BSP_GPIODI_EdgeRead(edges, DI_EDGE_LOG_COUNT, &count))
+        {
+            count = 0U;
+        }
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            s_edge_log[s_edge_sequence % DI_EDGE_LOG_COUNT] = edges[i];
+            s_edge_sequence++;
+        }
+    } while (count == DI_EDGE_LOG_COUNT);
+
+    regs->di_edge_sequence = s_edge_sequence;
+    regs->di_edge_overruns = BSP_GPIODI_EdgeOverruns();
+
+    for (uint8_t k = 0U; k < DI_EDGE_LOG_COUNT; k++)
+    {
+        di_edge_registers_t      entry = di_edge_registers(regs, k);
+        const bsp_gpiodi_edge_t *edge =
+            &s_edge_log[(s_edge_sequence - 1U - k) % DI_EDGE_LOG_COUNT];
+
+        if (k >= s_edge_sequence)
+        {
+            *entry.time  = 0U;
+            *entry.event = 0U;
+            continue;
+        }
+
+        *entry.time  = (uint32_t)(edge->time / cycles_us);
+        *entry.event = (uint16_t)(edge->channel |
+                                  (edge->rising ? DI_EDGE_EVENT_RISING : 0U));
+    }
+}
+
+/**
+ * @brief Update the capture status input registers
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_capture_registers(jerry_device_input_registers_t *regs)
+{
+    regs->adc_capture_state    = (uint16_t)adc_capture_get_state();
+    regs->adc_capture_snapshot = adc_capture_get_snapshot();
+}
+
+/**
+ * @brief Locate the input registers of an analysed ADC channel
+ *
+ * @param[in] regs Input registers structure
+ * @param[in] ch   ADC channel, below BSP_ADC1_NUM_CHANNELS
+ *
+ * @return spectrum_registers_t Figures of the channel
+ */
+static spectrum_registers_t
+spectrum_registers(jerry_device_input_registers_t *regs, uint8_t ch)
+{
+    spectrum_registers_t spec;
+
+    switch (ch)
+    {
+        case 0U:
+            spec = (spectrum_registers_t){
+                &regs->spectrum_0_mean,      &regs->spectrum_0_rms,
+                &regs->spectrum_0_peak,      &regs->spectrum_0_frequency,
+                &regs->spectrum_0_amplitude, &regs->spectrum_0_thd};
+            break;
+        case 1U:
+            spec = (spectrum_registers_t){
+                &regs->spectrum_1_mean,      &regs->spectrum_1_rms,
+                &regs->spectrum_1_peak,      &regs->spectrum_1_frequency,
+                &regs->spectrum_1_amplitude, &regs->spectrum_1_thd};
+            break;
+        case 2U:
+            spec = (spectrum_registers_t){
+                &regs->spectrum_2_mean,      &regs->spectrum_2_rms,
+                &regs->spectrum_2_peak,      &regs->spectrum_2_frequency,
+                &regs->spectrum_2_amplitude, &regs->spectrum_2_thd};
+            break;
+        case 3U:
+            spec = (spectrum_registers_t){
+                &regs->spectrum_3_mean,      &regs->spectrum_3_rms,
+                &regs->spectrum_3_peak,      &regs->spectrum_3_frequency,
+                &regs->spectrum_3_amplitude, &regs->spectrum_3_thd};
+            break;
+        case 4U:
+            spec = (spectrum_registers_t){
+                &regs->spectrum_4_mean,      &regs->spectrum_4_rms,
+                &regs->spectrum_4_peak,      &regs->spectrum_4_frequency,
+                &regs->spectrum_4_amplitude, &regs->spectrum_4_thd};
+            break;
+        default:
+            spec = (spectrum_registers_t){
+                &regs->spectrum_5_mean,      &regs->spectrum_5_rms,
+                &regs->spectrum_5_peak,      &regs->spectrum_5_frequency,
+                &regs->spectrum_5_amplitude, &regs->spectrum_5_thd};
+            break;
+    }
+
+    return spec;
+}
+
+/**
+ * @brief Update the spectrum input registers from the last frame
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_spectrum_registers(jerry_device_input_registers_t *regs)
+{
+    spectrum_result_t results[BSP_ADC1_NUM_CHANNELS];
+
+    regs->spectrum_frame = spectrum_get_results(results);
+
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        spectrum_registers_t spec = spectrum_registers(regs, ch);
+
+        *spec.mean      = results[ch].mean;
+        *spec.rms       = results[ch].rms;
+        *spec.peak      = results[ch].peak;
+        *spec.frequency = results[ch].frequency;
+        *spec.amplitude = results[ch].amplitude;
+        *spec.thd       = results[ch].thd;
+    }
+}
+
+/**
+ * @brief Locate the input registers of the result of a monitored tone
+ *
+ * @param[in] regs Input registers structure
+ * @param[in] tone Tone, below GOERTZEL_TONES
+ *
+ * @return goertzel_result_registers_t Registers of the tone
+ */
+static goertzel_result_registers_t
+goertzel_result_registers(jerry_device_input_registers_t *regs, uint8_t tone)
+{
+    switch (tone)
+    {
+        case 0U:
+            return GOERTZEL_RESULT_REGISTERS(regs, 0);
+        case 1U:
+            return GOERTZEL_RESULT_REGISTERS(regs, 1);
+        case 2U:
+            return GOERTZEL_RESULT_REGISTERS(regs, 2);
+        case 3U:
+            return GOERTZEL_RESULT_REGISTERS(regs, 3);
+        case 4U:
+            return GOERTZEL_RESULT_REGISTERS(regs, 4);
+        case 5U:
+            return GOERTZEL_RESULT_REGISTERS(regs, 5);
+        case 6U:
+            return GOERTZEL_RESULT_REGISTERS(regs, 6);
+        default:
+            return GOERTZEL_RESULT_REGISTERS(regs, 7);
+    }
+}
+
+/**
+ * @brief Update the tone monitor input registers from the last window
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_goertzel_registers(jerry_device_input_registers_t *regs)
+{
+    goertzel_result_t results[GOERTZEL_TONES];
+
+    regs->goertzel_window = goertzel_get_results(results);
+
+    for (uint8_t t = 0U; t < GOERTZEL_TONES; t++)
+    {
+        goertzel_result_registers_t tone = goertzel_result_registers(regs, t);
+
+        *tone.magnitude = results[t].magnitude;
+        *tone.phase     = results[t].phase;
+    }
+}
+
+/**
+ * @brief Locate the input registers of the result of a metered pair
+ *
+ * @param[in] regs Input registers structure
+ * @param[in] pair Pair, below POWER_METER_PAIRS
+ *
+ * @return power_result_registers_t Registers of the pair
+ */
+static power_result_registers_t
+power_result_registers(jerry_device_input_registers_t *regs, uint8_t pair)
+{
+    switch (pair)
+    {
+        case 0U:
+            return POWER_RESULT_REGISTERS(regs, 0);
+        case 1U:
+            return POWER_RESULT_REGISTERS(regs, 1);
+        default:
+            return POWER_RESULT_REGISTERS(regs, 2);
+    }
+}
+
+/**
+ * @brief Energy total in thousandths of its unit, for the 64-bit registers
+ */
+static uint64_t power_milli(float64_t total)
+{
+    return (uint64_t)((total * 1000.0) + 0.5);
+}
+
+/**
+ * @brief Update the power meter input registers from the last window
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_power_registers(jerry_device_input_registers_t *regs)
+{
+    power_meter_result_t results[POWER_METER_PAIRS];
+
+    regs->power_window = power_meter_get_results(results);
+
+    for (uint8_t p = 0U; p < POWER_METER_PAIRS; p++)
+    {
+        power_result_registers_t    pair   = power_result_registers(regs, p);
+        const power_meter_energy_t *energy = &results[p].energy;
+
+        *pair.real            = results[p].real;
+        *pair.apparent        = results[p].apparent;
+        *pair.imported        = power_milli(energy->imported);
+        *pair.exported        = power_milli(energy->exported);
+        *pair.apparent_energy = power_milli(energy->apparent);
+
+        /* The 32-bit totals wrap, in whole Wh */
+        *pair.imported_wh = (uint32_t)(*pair.imported / 1000U);
+        *pair.exported_wh = (uint32_t)(*pair.exported / 1000U);
+    }
+}
+
+/**
+ * @brief Locate the input registers of an ADC channel over every window
+ *
+ * @param[in]  regs Input registers structure
+ * @param[in]  ch   ADC channel, below BSP_ADC1_NUM_CHANNELS
+ * @param[out] win  ADC_STATS_WINDOW_COUNT entries, in adc_stats_window_t
+ *                  order
+ */
+static void adc_stats_registers(jerry_device_input_registers_t *regs,
+                                uint8_t ch, adc_stats_registers_t *win)
+{
+    switch (ch)
+    {
+        case 0U:
+            win[0] = ADC_STATS_REGISTERS(regs, 0, 1s);
+            win[1] = ADC_STATS_REGISTERS(regs, 0, 10s);
+            win[2] = ADC_STATS_REGISTERS(regs, 0, 1min);
+            break;
+        case 1U:
+            win[0] = ADC_STATS_REGISTERS(regs, 1, 1s);
+            win[1] = ADC_STATS_REGISTERS(regs, 1, 10s);
+            win[2] = ADC_STATS_REGISTERS(regs, 1, 1min);
+            break;
+        case 2U:
+            win[0] = ADC_STATS_REGISTERS(regs, 2, 1s);
+            win[1] = ADC_STATS_REGISTERS(regs, 2, 10s);
+            win[2] = ADC_STATS_REGISTERS(regs, 2, 1min);
+            break;
+        case 3U:
+            win[0] = ADC_STATS_REGISTERS(regs, 3, 1s);
+            win[1] = ADC_STATS_REGISTERS(regs, 3, 10s);
+            win[2] = ADC_STATS_REGISTERS(regs, 3, 1min);
+            break;
+        case 4U:
+            win[0] = ADC_STATS_REGISTERS(regs, 4, 1s);
+            win[1] = ADC_STATS_REGISTERS(regs, 4, 10s);
+            win[2] = ADC_STATS_REGISTERS(regs, 4, 1min);
+            break;
+        default:
+            win[0] = ADC_STATS_REGISTERS(regs, 5, 1s);
+            win[1] = ADC_STATS_REGISTERS(regs, 5, 10s);
+            win[2] = ADC_STATS_REGISTERS(regs, 5, 1min);
+            break;
+    }
+}
+
+/**
+ * @brief Update the window statistics input registers
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_adc_stats_registers(jerry_device_input_registers_t *regs)
+{
+    adc_stats_result_t results[ADC_STATS_CHANNELS][ADC_STATS_WINDOW_COUNT];
+
+    regs->adc_stats_update = adc_stats_get_results(results);
+
+    for (uint8_t ch = 0U; ch < ADC_STATS_CHANNELS; ch++)
+    {
+        adc_stats_registers_t win[ADC_STATS_WINDOW_COUNT];
+
+        adc_stats_registers(regs, ch, win);
+        for (uint32_t w = 0U; w < ADC_STATS_WINDOW_COUNT; w++)
+        {
+            *win[w].min  = results[ch][w].min;
+            *win[w].max  = results[ch][w].max;
+            *win[w].mean = results[ch][w].mean;
+            *win[w].rms  = results[ch][w].rms;
+        }
+    }
+}
+
+/**
+ * @brief Update the anomaly input registers from the last frame scored
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_anomaly_registers(jerry_device_input_registers_t *regs)
+{
+    anomaly_status_t status;
+
+    anomaly_get_status(&status);
+
+    regs->anomaly_frame        = status.frame;
+    regs->anomaly_alarms       = status.alarms;
+    regs->anomaly_alarm_events = status.events;
+    regs->anomaly_0_score      = status.score[0];
+    regs->anomaly_1_score      = status.score[1];
+    regs->anomaly_2_score      = status.score[2];
+    regs->anomaly_3_score      = status.score[3];
+    regs->anomaly_4_score      = status.score[4];
+    regs->anomaly_5_score      = status.score[5];
+}
+
+/**
+ * @brief Update the interlock input registers from the last block
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_interlock_registers(jerry_device_input_registers_t *regs)
+{
+    interlock_status_t status;
+
+    interlock_get_status(&status);
+
+    regs->interlock_tripped      = status.tripped;
+    regs->interlock_events       = status.events;
+    regs->interlock_write_errors = status.write_errors;
+}
+
+/**
+ * @brief Update the scheduled output input registers from the queue
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_do_schedule_registers(jerry_device_input_registers_t *regs)
+{
+    do_schedule_status_t status;
+
+    do_schedule_get_status(&status);
+
+    regs->do_schedule_pending  = status.pending;
+    regs->do_schedule_executed = status.executed;
+    regs->do_schedule_failed   = status.failed;
+    regs->do_schedule_latency  = status.latency_ns;
+}
+
+/**
+ * @brief Update the analog watchdog input registers from the BSP
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_adc_watchdog_registers(jerry_device_input_registers_t *regs)
+{
+    bsp_adc1_awd_status_t status = {0U, 0U};
+
+    (void)BSP_ADC1_GetWatchdogStatus(&status);
+
+    regs->adc_awd_alarms = (uint16_t)status.active;
+    regs->adc_awd_events = status.raised;
+}
+
+/**
+ * @brief Update the ADC quality input registers from the last block
+ *
+ * @param regs Pointer to input registers structure
+ */
+static void update_adc_quality_registers(jerry_device_input_registers_t *regs)
+{
+    uint8_t quality[BSP_ADC1_NUM_CHANNELS] = {0U};
+
+    (void)BSP_ADC1_GetQualityAll(quality);
+
+    regs->adc_0_quality = quality[0];
+    regs->adc_1_quality = quality[1];
+    regs->adc_2_quality = quality[2];
+    regs->adc_3_quality = quality[3];
+    regs->adc_4_quality = quality[4];
+    regs->adc_5_quality = quality[5];
+}
+
+/**
+ * @brief Check whether a request block touches a register group
+ *
+ * @param[in] start_address First address of the block
+ * @param[in] end_address   Last address of the block
+ * @param[in] group_address First address of the group
+ * @param[in] group_count   Number of addresses in the group
+ *
+ * @return true if at least one address is shared
+ */
+static bool block_overlaps_group(uint16_t start_address, uint16_t end_address,
+                                 uint16_t group_address, uint16_t group_count)
+{
+    return (start_address <= (group_address + group_count - 1U)) &&
+           (group_address <= end_address);
+}
+
+/**
+ * @brief Check the values of a stored block that depend on each other
+ *
+ * Each register is checked against its limits by
+ * jerry_device_holding_registers_in_limits(). A duty range or a
+ * calibration is only valid as a pair, so the channels and loops the
+ * block touches are checked once all of it is stored.
+ *
+ * @param[in] start_address First address of the block
+ * @param[in] end_address   Last address of the block
+ *
+ * @return true if every channel and loop touched is valid
+ */
+static bool holding_block_valid(uint16_t start_address, uint16_t end_address)
+{
+    jerry_device_holding_registers_t *regs =
+        jerry_device_get_holding_registers();
+    bool valid = true;
+
+    for (uint8_t i = 0U; i < CONTROL_LOOP_COUNT; i++)
+    {
+        control_registers_t ctl = control_registers(regs, i);
+
+        if (block_overlaps_group(start_address, end_address,
+                                 JERRY_DEVICE_HR_CONTROL_0_ENABLE +
+                                     (i * CONTROL_REGISTER_STRIDE),
+                                 CONTROL_REGISTER_STRIDE) &&
+            (*ctl.output_min > *ctl.output_max))
+        {
+            valid = false;
+        }
+    }
+
+    for (uint8_t ch = 0U; ch < ADC_REGISTER_COUNT; ch++)
+    {
+        adc_calibration_registers_t cal = adc_calibration_registers(regs, ch);
+
+        if (block_overlaps_group(start_address, end_address,
+                                 JERRY_DEVICE_HR_ADC_0_CAL_GAIN +
+                                     (ch * ADC_CALIBRATION_STRIDE),
+                                 ADC_CALIBRATION_STRIDE) &&
+            (!isfinite(*cal.gain) || (*cal.gain == 0.0f) ||
+             !isfinite(*cal.offset)))
+        {
+            valid = false;
+        }
+    }
+
+    return valid;
+}
+
+/**
+ * @brief Check a stored block before any hook or reader sees it
+ *
+ * The registers of the groups written in bulk are stored unchecked, their
+ * 32-bit values only being whole once the block is, and checked here
+ * against the generated limits of jerry_registers.json. A block that fails
+ * those or holding_block_valid() has the registers of the groups
+ * written in bulk put back to their published values, all of them and not
+ * only the pair at fault; none of them has been applied yet, as their
+ * write hooks have not run. Registers of other groups, written one at a
+ * time with their effects, stay.
+ *
+ * @param[in] start_address First address of the block
+ * @param[in] quantity      Number of registers stored
+ *
+ * @return modbus_exception_t MODBUS_EXCEPTION_NONE if the block is valid
+ */
+static modbus_exception_t holding_block_commit(uint16_t start_address,
+                                               uint16_t quantity)
+{
+    if (jerry_device_holding_registers_in_limits(start_address, quantity) &&
+        holding_block_valid(start_address,
+                            (uint16_t)(start_address + quantity - 1U)))
+    {
+        return MODBUS_EXCEPTION_NONE;
+    }
+
+    for (uint16_t i = 0U; i < quantity; i++)
+    {
+        uint16_t address = (uint16_t)(start_address + i);
+        uint16_t value;
+
+        if (jerry_device_holding_registers_is_bulk_writable(address, 1U) &&
+            jerry_device_read_holding_registers(address, 1U, &value))
+        {
+            (void)jerry_device_holding_registers_write_word(address, value);
+        }
+    }
+
+    return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+}
+
+/* ==========================================================================
+ * Write Hooks (groups with write_hook in jerry_registers.json)
+ * ========================================================================== */
+
+/**
+ * @brief Apply the digital output coils of a request
+ *
+ * All outputs written are applied with a single masked expander update.
+ * The coils are then set from the BSP shadow image, which holds the
+ * outputs actually driven: all of them if the update failed, and the ones
+ * held by an interlock, which a write does not change.
+ */
+modbus_exception_t jerry_device_digital_outputs_written(
+    jerry_device_space_t space, uint64_t dirty)
+{
+    uint32_t    mask = (uint32_t)dirty;
+    bsp_error_t err  = update_digital_outputs(
+        mask, (uint32_t)jerry_device_coils_get_bits(
+                  JERRY_DEVICE_HOOK_DIGITAL_OUTPUTS_COIL_ADDR,
+                  JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_COUNT));
+
+    (void)space;
+
+    jerry_device_coils_set_bits(JERRY_DEVICE_HOOK_DIGITAL_OUTPUTS_COIL_ADDR,
+                                JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_COUNT,
+                                BSP_I2CDO_GetShadow());
+
+    return (BSP_OK == err) ? MODBUS_EXCEPTION_NONE
+                           : MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
+}
+
+/**
+ * @brief Drive the PWM channels whose enable coils or registers a request
+ * wrote
+ */
+modbus_exception_t jerry_device_pwm_control_written(jerry_device_space_t space,
+                                                    uint64_t dirty)
+{
+    uint8_t channels = 0U;
+
+    for (uint8_t ch = 0U; ch < BSP_PWM_COUNT; ch++)
+    {
+        uint64_t bits = (space == JERRY_DEVICE_SPACE_COILS)
+                            ? ((uint64_t)1U << ch)
+                            : ((uint64_t)((1U << PWM_REGISTER_STRIDE) - 1U)
+                               << (PWM_REGISTER_STRIDE * ch));
+
+        if ((dirty & bits) != 0U)
+        {
+            channels |= PWM_CHANNEL_BIT(ch);
+        }
+    }
+
+    return update_pwm_outputs(channels);
+}
+
+/**
+ * @brief Hand the control loops whose registers a request wrote to the
+ * control engine
+ */
+modbus_exception_t jerry_device_control_written(jerry_device_space_t space,
+                                                uint64_t             dirty)
+{
+    uint8_t loops = 0U;
+
+    (void)space;
+
+    for (uint8_t i = 0U; i < CONTROL_LOOP_COUNT; i++)
+    {
+        uint64_t bits = ((uint64_t)1U << CONTROL_REGISTER_STRIDE) - 1U;
+
+        if ((dirty & (bits << (CONTROL_REGISTER_STRIDE * i))) != 0U)
+        {
+            loops |= (uint8_t)(1U << i);
+        }
+    }
+
+    update_control_loops(loops);
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief Hand the ADC channels whose calibration a request wrote to the
+ * filter task
+ */
+modbus_exception_t jerry_device_adc_calibration_written(
+    jerry_device_space_t space, uint64_t dirty)
+{
+    uint8_t channels = 0U;
+
+    (void)space;
+
+    for (uint8_t ch = 0U; ch < ADC_REGISTER_COUNT; ch++)
+    {
+        uint64_t bits = ((uint64_t)1U << ADC_CALIBRATION_STRIDE) - 1U;
+
+        if ((dirty & (bits << (ADC_CALIBRATION_STRIDE * ch))) != 0U)
+        {
+            channels |= (uint8_t)(1U << ch);
         }
+    }
+
+    return update_adc_calibration(channels);
+}
+
+/**
+ * @brief Run a command a request wrote to the scheduled output registers
+ *
+ * Called once per request, so the time, the outputs and the command can
+ * come in one block. Writing the other registers alone only stores them.
+ */
+modbus_exception_t jerry_device_do_schedule_written(jerry_device_space_t space,
+                                                    uint64_t dirty)
+{
+    const jerry_device_holding_registers_t *regs =
+        jerry_device_get_holding_registers();
+    uint64_t time_ns;
+
+    (void)space;
+
+    if ((dirty & ((uint64_t)1U << DO_SCHEDULE_COMMAND_BIT)) == 0U)
+    {
+        return MODBUS_EXCEPTION_NONE;
+    }
+
+    switch (regs->do_schedule_command)
+    {
+        case DO_SCHEDULE_COMMAND_ADD:
+            if (regs->do_schedule_nanoseconds >= 1000000000UL)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            time_ns = ((uint64_t)regs->do_schedule_seconds *
+                       (uint64_t)BSP_PTP_NS_PER_S) +
+                      regs->do_schedule_nanoseconds;
+            switch (do_schedule_add(time_ns, regs->do_schedule_mask,
+                                    regs->do_schedule_value))
+            {
+                case DO_SCHEDULE_OK:
+                    break;
+                case DO_SCHEDULE_FULL:
+                    return MODBUS_EXCEPTION_SLAVE_DEVICE_BUSY;
+                default:
+                    /* Too late to be applied at its time */
+                    return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            break;
+        case DO_SCHEDULE_COMMAND_CANCEL:
+            do_schedule_cancel();
+            break;
+        default:
+            break;
+    }
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+_Static_assert(JERRY_DEVICE_HOOK_PWM_CONTROL_HR_ADDR ==
+                   JERRY_DEVICE_HR_PWM_0_DUTY_CYCLE,
+               "PWM dirty mask starts at channel 0");
+_Static_assert(JERRY_DEVICE_HOOK_PWM_CONTROL_COIL_ADDR ==
+                   JERRY_DEVICE_COIL_GROUP_PWM_CONTROL_ADDR,
+               "PWM enable coils follow the channel order");
+_Static_assert(JERRY_DEVICE_HOOK_CONTROL_HR_ADDR ==
+                   JERRY_DEVICE_HR_CONTROL_0_ENABLE,
+               "control dirty mask starts at loop 0");
+_Static_assert(JERRY_DEVICE_HOOK_ADC_CALIBRATION_HR_ADDR ==
+                   JERRY_DEVICE_HR_ADC_0_CAL_GAIN,
+               "calibration dirty mask starts at channel 0");
+_Static_assert(JERRY_DEVICE_HOOK_DO_SCHEDULE_HR_ADDR ==
+                   JERRY_DEVICE_HR_DO_SCHEDULE_SECONDS,
+               "schedule dirty mask starts at the time");
+
+/* The limits of jerry_registers.json are the only range checks of the
+ * groups written in bulk, so they must be those of the firmware */
+_Static_assert((JERRY_DEVICE_HR_PWM_0_DUTY_CYCLE_MAX_VALUE ==
+                BSP_PWM_DUTY_MAX) &&
+                   (JERRY_DEVICE_HR_PWM_3_DUTY_CYCLE_MAX_VALUE ==
+                    BSP_PWM_DUTY_MAX),
+               "PWM duty limit is BSP_PWM_DUTY_MAX");
+_Static_assert((JERRY_DEVICE_HR_PWM_0_FREQUENCY_MIN_VALUE ==
+                BSP_PWM_MIN_FREQUENCY) &&
+                   (JERRY_DEVICE_HR_PWM_0_FREQUENCY_MAX_VALUE ==
+                    BSP_PWM_MAX_FREQUENCY),
+               "PWM frequency limits are those of the BSP");
+_Static_assert((JERRY_DEVICE_HR_CONTROL_0_ENABLE_MAX_VALUE == 1U) &&
+                   (JERRY_DEVICE_HR_CONTROL_3_ENABLE_MAX_VALUE == 1U),
+               "control loop enable is a flag");
+_Static_assert((JERRY_DEVICE_HR_CONTROL_0_INPUT_MAX_VALUE ==
+                (BSP_ADC1_NUM_CHANNELS - 1U)) &&
+                   (JERRY_DEVICE_HR_CONTROL_3_INPUT_MAX_VALUE ==
+                    (BSP_ADC1_NUM_CHANNELS - 1U)),
+               "control loop input is an ADC channel");
+_Static_assert((JERRY_DEVICE_HR_CONTROL_0_OUTPUT_MAX_VALUE ==
+                (BSP_PWM_COUNT - 1U)) &&
+                   (JERRY_DEVICE_HR_CONTROL_3_OUTPUT_MAX_VALUE ==
+                    (BSP_PWM_COUNT - 1U)),
+               "control loop output is a PWM channel");
+_Static_assert((JERRY_DEVICE_HR_CONTROL_0_OUTPUT_MIN_MAX_VALUE ==
+                BSP_PWM_DUTY_MAX) &&
+                   (JERRY_DEVICE_HR_CONTROL_0_OUTPUT_MAX_MAX_VALUE ==
+                    BSP_PWM_DUTY_MAX) &&
+                   (JERRY_DEVICE_HR_CONTROL_3_OUTPUT_MIN_MAX_VALUE ==
+                    BSP_PWM_DUTY_MAX) &&
+                   (JERRY_DEVICE_HR_CONTROL_3_OUTPUT_MAX_MAX_VALUE ==
+                    BSP_PWM_DUTY_MAX),
+               "control loop duty range limit is BSP_PWM_DUTY_MAX");
+_Static_assert(JERRY_DEVICE_HR_DO_SCHEDULE_COMMAND_MAX_VALUE ==
+                   (DO_SCHEDULE_COMMAND_COUNT - 1U),
+               "schedule command limit is the last command");
+
+/**
+ * @brief Drop the cached read responses after a write
+ *
+ * Called by the write callbacks once anything was stored, so a write takes
+ * effect on the cache whichever task made it; the callers hold the register
+ * mutex that serializes the cache too.
+ */
+static void registers_written(void)
+{
+#if MODBUS_RESPONSE_CACHE
+    modbus_response_cache_invalidate();
+#endif
+}
+
+/* ==========================================================================
+ * Coil Callbacks (FC01, FC05, FC15)
+ * ========================================================================== */
+
+/**
+ * @brief Read coils callback (FC01)
+ *
+ * The digital input mirrors are sampled first if the block touches them,
+ * and the digital output coils are set from the BSP shadow image, which
+ * an interlock may have changed; the block is then copied out of the
+ * packed coil bitmap.
+ */
+modbus_exception_t modbus_cb_read_coils(uint16_t start_address,
+                                        uint16_t quantity, uint8_t *coil_values)
+{
+    uint16_t end_address = start_address + quantity - 1U;
+
+    /* Validate address range */
+    if (!ADDR_IN_RANGE_FROM_ZERO(start_address, JERRY_DEVICE_COIL_MAX_ADDR) ||
+        !ADDR_IN_RANGE_FROM_ZERO(end_address, JERRY_DEVICE_COIL_MAX_ADDR))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    if (block_overlaps_group(start_address, end_address,
+                             JERRY_DEVICE_COIL_GROUP_DIGITAL_INPUTS_ADDR,
+                             JERRY_DEVICE_COIL_GROUP_DIGITAL_INPUTS_COUNT))
+    {
+        uint32_t inputs = 0U;
 
-        /* Pack bit into output buffer */
-        byte_index = i / 8U;
-        bit_index  = i % 8U;
-        if (value)
+        if (BSP_OK != read_digital_inputs(&inputs))
         {
-            coil_values[byte_index] |= (uint8_t)(1U << bit_index);
+            return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
         }
+
+        jerry_device_coils_set_bits(
+            JERRY_DEVICE_COIL_GROUP_DIGITAL_INPUTS_ADDR,
+            JERRY_DEVICE_COIL_GROUP_DIGITAL_INPUTS_COUNT, inputs);
+    }
+
+    if (block_overlaps_group(start_address, end_address,
+                             JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_ADDR,
+                             JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_COUNT))
+    {
+        jerry_device_coils_set_bits(
+            JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_ADDR,
+            JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_COUNT,
+            BSP_I2CDO_GetShadow());
+    }
+
+    if (!jerry_device_read_coils(start_address, quantity, coil_values))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
     }
 
     return MODBUS_EXCEPTION_NONE;
@@ -386,119 +2211,29 @@ modbus_exception_t modbus_cb_read_coils(uint16_t start_address,
  */
 modbus_exception_t modbus_cb_write_single_coil(uint16_t address, bool value)
 {
-    jerry_device_coils_t *coils = jerry_device_get_coils();
-
-    switch (address)
-    {
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_0:
-            update_digital_output(BSP_I2CDO_INDEX_D0, value,
-                                  &(coils->digital_output_0));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_1:
-            update_digital_output(BSP_I2CDO_INDEX_D1, value,
-                                  &(coils->digital_output_1));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_2:
-            update_digital_output(BSP_I2CDO_INDEX_D2, value,
-                                  &(coils->digital_output_2));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_3:
-            update_digital_output(BSP_I2CDO_INDEX_D3, value,
-                                  &(coils->digital_output_3));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_4:
-            update_digital_output(BSP_I2CDO_INDEX_D4, value,
-                                  &(coils->digital_output_4));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_5:
-            update_digital_output(BSP_I2CDO_INDEX_D5, value,
-                                  &(coils->digital_output_5));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_6:
-            update_digital_output(BSP_I2CDO_INDEX_D6, value,
-                                  &(coils->digital_output_6));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_7:
-            update_digital_output(BSP_I2CDO_INDEX_D7, value,
-                                  &(coils->digital_output_7));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_8:
-            update_digital_output(BSP_I2CDO_INDEX_D8, value,
-                                  &(coils->digital_output_8));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_9:
-            update_digital_output(BSP_I2CDO_INDEX_D9, value,
-                                  &(coils->digital_output_9));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_10:
-            update_digital_output(BSP_I2CDO_INDEX_D10, value,
-                                  &(coils->digital_output_10));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_11:
-            update_digital_output(BSP_I2CDO_INDEX_D11, value,
-                                  &(coils->digital_output_11));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_12:
-            update_digital_output(BSP_I2CDO_INDEX_D12, value,
-                                  &(coils->digital_output_12));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_13:
-            update_digital_output(BSP_I2CDO_INDEX_D13, value,
-                                  &(coils->digital_output_13));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_14:
-            update_digital_output(BSP_I2CDO_INDEX_D14, value,
-                                  &(coils->digital_output_14));
-            break;
-        case JERRY_DEVICE_COIL_DIGITAL_OUTPUT_15:
-            update_digital_output(BSP_I2CDO_INDEX_D15, value,
-                                  &(coils->digital_output_15));
-            break;
-        case JERRY_DEVICE_COIL_PWM_0_ENABLE:
-            coils->pwm_0_enable = value;
-            break;
-        case JERRY_DEVICE_COIL_PWM_1_ENABLE:
-            coils->pwm_1_enable = value;
-            break;
-        case JERRY_DEVICE_COIL_PWM_2_ENABLE:
-            coils->pwm_2_enable = value;
-            break;
-        case JERRY_DEVICE_COIL_PWM_3_ENABLE:
-            coils->pwm_3_enable = value;
-            break;
-        default:
-            return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
-    }
+    uint8_t coil_value = value ? 0x01U : 0x00U;
 
-    return MODBUS_EXCEPTION_NONE;
+    return modbus_cb_write_multiple_coils(address, 1U, &coil_value);
 }
 
 /**
  * @brief Write multiple coils callback (FC15)
+ *
+ * The block is stored in the coil bitmap first; the write hooks then apply
+ * the digital outputs and PWM enables it touched, each group once.
  */
 modbus_exception_t modbus_cb_write_multiple_coils(uint16_t       start_address,
                                                   uint16_t       quantity,
                                                   const uint8_t *coil_values)
 {
-    modbus_exception_t result;
-    uint16_t           byte_index;
-    uint16_t           bit_index;
-    bool               value;
-
-    for (uint16_t i = 0U; i < quantity; i++)
+    if (!jerry_device_write_coils(start_address, quantity, coil_values))
     {
-        byte_index = i / 8U;
-        bit_index  = i % 8U;
-        value      = ((coil_values[byte_index] >> bit_index) & 0x01U) != 0U;
-
-        result = modbus_cb_write_single_coil(start_address + i, value);
-        if (result != MODBUS_EXCEPTION_NONE)
-        {
-            return result;
-        }
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
     }
 
-    return MODBUS_EXCEPTION_NONE;
+    registers_written();
+
+    return jerry_device_coils_written(start_address, quantity);
 }
 
 /* ==========================================================================
@@ -512,11 +2247,7 @@ modbus_exception_t modbus_cb_read_discrete_inputs(uint16_t start_address,
                                                   uint16_t quantity,
                                                   uint8_t *input_values)
 {
-    jerry_device_discrete_inputs_t *inputs = jerry_device_get_discrete_inputs();
-    uint16_t                        end_address = start_address + quantity - 1U;
-    uint16_t                        byte_index;
-    uint16_t                        bit_index;
-    bool                            value;
+    uint16_t end_address = start_address + quantity - 1U;
 
     /* Validate address range */
     if (!ADDR_IN_RANGE_FROM_ZERO(start_address, JERRY_DEVICE_DI_MAX_ADDR) ||
@@ -525,130 +2256,108 @@ modbus_exception_t modbus_cb_read_discrete_inputs(uint16_t start_address,
         return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
     }
 
-    /* Clear output buffer */
-    for (uint16_t i = 0U; i < ((quantity + 7U) / 8U); i++)
-    {
-        input_values[i] = 0U;
-    }
-
-    /* Read each input */
-    for (uint16_t i = 0U; i < quantity; i++)
+    if (block_overlaps_group(start_address, end_address,
+                             JERRY_DEVICE_DI_GROUP_DIGITAL_INPUTS_ADDR,
+                             JERRY_DEVICE_DI_GROUP_DIGITAL_INPUTS_COUNT))
     {
-        uint16_t addr = start_address + i;
-        value         = false;
+        uint32_t inputs = 0U;
 
-        switch (addr)
+        if (BSP_OK != read_digital_inputs(&inputs))
         {
-            case JERRY_DEVICE_DI_DIGITAL_INPUT_0:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_0, NULL,
-                                                   &(inputs->digital_input_0)))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = inputs->digital_input_0;
-                }
-                break;
-            case JERRY_DEVICE_DI_DIGITAL_INPUT_1:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_1, NULL,
-                                                   &(inputs->digital_input_1)))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = inputs->digital_input_1;
-                }
-                break;
-            case JERRY_DEVICE_DI_DIGITAL_INPUT_2:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_2, NULL,
-                                                   &(inputs->digital_input_2)))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = inputs->digital_input_2;
-                }
-                break;
-            case JERRY_DEVICE_DI_DIGITAL_INPUT_3:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_3, NULL,
-                                                   &(inputs->digital_input_3)))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = inputs->digital_input_3;
-                }
-                break;
-            case JERRY_DEVICE_DI_DIGITAL_INPUT_4:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_4, NULL,
-                                                   &(inputs->digital_input_4)))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = inputs->digital_input_4;
-                }
-                break;
-            case JERRY_DEVICE_DI_DIGITAL_INPUT_5:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_5, NULL,
-                                                   &(inputs->digital_input_5)))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = inputs->digital_input_5;
-                }
-                break;
-            case JERRY_DEVICE_DI_DIGITAL_INPUT_6:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_6, NULL,
-                                                   &(inputs->digital_input_6)))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = inputs->digital_input_6;
-                }
-                break;
-            case JERRY_DEVICE_DI_DIGITAL_INPUT_7:
-                if (BSP_OK != update_digital_input(BSP_GPIODI_INDEX_7, NULL,
-                                                   &(inputs->digital_input_7)))
-                {
-                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
-                }
-                else
-                {
-                    value = inputs->digital_input_7;
-                }
-                break;
-            default:
-                return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+            return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
         }
 
-        /* Pack bit into output buffer */
-        byte_index = i / 8U;
-        bit_index  = i % 8U;
-        if (value)
-        {
-            input_values[byte_index] |= (uint8_t)(1U << bit_index);
-        }
+        jerry_device_discrete_inputs_set_bits(
+            JERRY_DEVICE_DI_GROUP_DIGITAL_INPUTS_ADDR,
+            JERRY_DEVICE_DI_GROUP_DIGITAL_INPUTS_COUNT, inputs);
+    }
+
+    if (!jerry_device_read_discrete_inputs(start_address, quantity,
+                                           input_values))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
     }
 
     return MODBUS_EXCEPTION_NONE;
 }
 
+/* ==========================================================================
+ * Live Holding Register Blocks
+ * ========================================================================== */
+
+/**
+ * @brief Refresh function of a live register block
+ *
+ * Fills every register of its block from the current device state in one
+ * pass, so all registers of the block are always read as one snapshot.
+ */
+typedef void (*hr_block_fill_t)(jerry_device_holding_registers_t *regs);
+
+/**
+ * @brief Contiguous holding registers refreshed on read
+ */
+typedef struct
+{
+    uint16_t        address;      /**< First register address of the block */
+    uint16_t        count;        /**< Number of registers in the block */
+    hr_block_fill_t fill;         /**< Refreshes the whole block */
+    uint32_t        ttl_ms;       /**< Response cache window, 0 = uncached */
+    uint32_t        adc_channels; /**< ADC channels it follows (adc_change.h) */
+} hr_block_provider_t;
+
+/**
+ * Live register blocks, in address order. A read touching any register of
+ * a block refreshes the whole block once before the copy-out.
+ */
+static const hr_block_provider_t hr_block_providers[] = {
+    /* Cached until a channel moves beyond its deadband */
+    {JERRY_DEVICE_HR_ADC_0_VALUE, ADC_REGISTER_COUNT, update_adc_registers,
+     STATIC_DATA_CACHE_TTL_MS, ADC_REGISTER_CHANNELS},
+    /* Stamps the newest filtered block */
+    {JERRY_DEVICE_HR_ADC_TIMESTAMP, 2U, update_adc_timestamp_register,
+     ADC_UPDATE_PERIOD_MS, 0U},
+    {JERRY_DEVICE_HR_ADC_MAINS_FREQUENCY, 1U, update_mains_frequency_register,
+     ADC_UPDATE_PERIOD_MS, 0U},
+    /* Both tick words come from the same tick count */
+    {JERRY_DEVICE_HR_SYSTEM_TICK_LOW, 2U, update_system_tick_registers, 0U,
+     0U},
+    {JERRY_DEVICE_HR_ADC_0_VOLTAGE, 2U * ADC_REGISTER_COUNT,
+     update_adc_voltage_registers, STATIC_DATA_CACHE_TTL_MS,
+     ADC_REGISTER_CHANNELS},
+};
+
+/** Number of entries in hr_block_providers */
+#define HR_BLOCK_PROVIDER_COUNT \
+    (sizeof(hr_block_providers) / sizeof(hr_block_providers[0]))
+
+_Static_assert((JERRY_DEVICE_HR_ADC_3_VALUE - JERRY_DEVICE_HR_ADC_0_VALUE) ==
+                   (ADC_REGISTER_COUNT - 1U),
+               "ADC value registers must be contiguous");
+_Static_assert((BSP_ADC1_CHANNEL_A0 == 0U) &&
+                   (BSP_ADC1_CHANNEL_A3 == (ADC_REGISTER_COUNT - 1U)),
+               "ADC value registers follow the channel order");
+_Static_assert((JERRY_DEVICE_HR_ADC_3_DEADBAND -
+                JERRY_DEVICE_HR_ADC_0_DEADBAND) == (ADC_REGISTER_COUNT - 1U),
+               "ADC deadband registers must be contiguous");
+_Static_assert((JERRY_DEVICE_HR_ADC_3_VOLTAGE -
+                JERRY_DEVICE_HR_ADC_0_VOLTAGE) ==
+                   (2U * (ADC_REGISTER_COUNT - 1U)),
+               "float32 ADC registers must be contiguous");
+_Static_assert((JERRY_DEVICE_HR_SYSTEM_TICK_HIGH -
+                JERRY_DEVICE_HR_SYSTEM_TICK_LOW) == 1U,
+               "system tick registers must be adjacent");
+
 /* ==========================================================================
  * Holding Register Callbacks (FC03, FC06, FC16)
  * ========================================================================== */
 
 /**
  * @brief Read holding registers callback (FC03)
+ *
+ * Live blocks (ADC readings, system tick) touched by the request are
+ * refreshed first, each with one call, and published; the block is then
+ * copied out of the published image through the generated register map,
+ * which also splits 32-bit values into high/low words.
  */
 modbus_exception_t modbus_cb_read_holding_registers(uint16_t  start_address,
                                                     uint16_t  quantity,
@@ -657,190 +2366,543 @@ modbus_exception_t modbus_cb_read_holding_registers(uint16_t  start_address,
     jerry_device_holding_registers_t *regs =
         jerry_device_get_holding_registers();
     uint16_t end_address = start_address + quantity - 1U;
+    bool     refreshed   = false;
 
-    /* Validate address range */
-    if (!ADDR_IN_RANGE_FROM_ZERO(start_address, JERRY_DEVICE_HR_MAX_ADDR) ||
-        !ADDR_IN_RANGE_FROM_ZERO(end_address, JERRY_DEVICE_HR_MAX_ADDR))
+    /* Validate address range, gaps included */
+    if (!jerry_device_holding_registers_mapped(start_address, quantity))
     {
         return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
     }
 
-    /* Read each register */
-    for (uint16_t i = 0U; i < quantity; i++)
+    for (uint16_t i = 0U; i < HR_BLOCK_PROVIDER_COUNT; i++)
     {
-        uint16_t addr = start_address + i;
-
-        switch (addr)
-        {
-            case JERRY_DEVICE_HR_PWM_0_DUTY_CYCLE:
-                register_values[i] = (uint16_t)regs->pwm_0_duty_cycle;
-                break;
-            case JERRY_DEVICE_HR_PWM_0_FREQUENCY:
-                /* High word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)(((uint32_t)regs->pwm_0_frequency) >> 16U);
-                break;
-            case JERRY_DEVICE_HR_PWM_0_FREQUENCY + 1U:
-                /* Low word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->pwm_0_frequency & 0xFFFFU);
-                break;
-            case JERRY_DEVICE_HR_PWM_1_DUTY_CYCLE:
-                register_values[i] = (uint16_t)regs->pwm_1_duty_cycle;
-                break;
-            case JERRY_DEVICE_HR_PWM_1_FREQUENCY:
-                /* High word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->pwm_1_frequency >> 16U);
-                break;
-            case JERRY_DEVICE_HR_PWM_1_FREQUENCY + 1U:
-                /* Low word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->pwm_1_frequency & 0xFFFFU);
-                break;
-            case JERRY_DEVICE_HR_PWM_2_DUTY_CYCLE:
-                register_values[i] = (uint16_t)regs->pwm_2_duty_cycle;
-                break;
-            case JERRY_DEVICE_HR_PWM_2_FREQUENCY:
-                /* High word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->pwm_2_frequency >> 16U);
-                break;
-            case JERRY_DEVICE_HR_PWM_2_FREQUENCY + 1U:
-                /* Low word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->pwm_2_frequency & 0xFFFFU);
-                break;
-            case JERRY_DEVICE_HR_PWM_3_DUTY_CYCLE:
-                register_values[i] = (uint16_t)regs->pwm_3_duty_cycle;
-                break;
-            case JERRY_DEVICE_HR_PWM_3_FREQUENCY:
-                /* High word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->pwm_3_frequency >> 16U);
-                break;
-            case JERRY_DEVICE_HR_PWM_3_FREQUENCY + 1U:
-                /* Low word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->pwm_3_frequency & 0xFFFFU);
-                break;
-            case JERRY_DEVICE_HR_ADC_0_VALUE:
-                update_reg_with_adcval(BSP_ADC1_CHANNEL_A0,
-                                       &(regs->adc_0_value),
-                                       &register_values[i]);
-                break;
-            case JERRY_DEVICE_HR_ADC_1_VALUE:
-                update_reg_with_adcval(BSP_ADC1_CHANNEL_A1,
-                                       &(regs->adc_1_value),
-                                       &register_values[i]);
-                break;
-            case JERRY_DEVICE_HR_ADC_2_VALUE:
-                update_reg_with_adcval(BSP_ADC1_CHANNEL_A2,
-                                       &(regs->adc_2_value),
-                                       &register_values[i]);
-                break;
-            case JERRY_DEVICE_HR_ADC_3_VALUE:
-                update_reg_with_adcval(BSP_ADC1_CHANNEL_A3,
-                                       &(regs->adc_3_value),
-                                       &register_values[i]);
-                break;
-            case JERRY_DEVICE_HR_SYSTEM_TICK_LOW:
-                /* Update both tick registers before returning either one */
-                update_system_tick_registers(regs);
-                register_values[i] = (uint16_t)regs->system_tick_low;
-                break;
-            case JERRY_DEVICE_HR_SYSTEM_TICK_HIGH:
-                /* Update both tick registers before returning either one */
-                update_system_tick_registers(regs);
-                register_values[i] = (uint16_t)regs->system_tick_high;
-                break;
-            case JERRY_DEVICE_HR_RTC_YEAR:
-                register_values[i] = (uint16_t)regs->rtc_year;
-                break;
-            case JERRY_DEVICE_HR_RTC_MONTH:
-                register_values[i] = (uint16_t)regs->rtc_month;
-                break;
-            case JERRY_DEVICE_HR_RTC_DAY:
-                register_values[i] = (uint16_t)regs->rtc_day;
-                break;
-            case JERRY_DEVICE_HR_RTC_HOUR:
-                register_values[i] = (uint16_t)regs->rtc_hour;
-                break;
-            case JERRY_DEVICE_HR_RTC_MINUTE:
-                register_values[i] = (uint16_t)regs->rtc_minute;
-                break;
-            case JERRY_DEVICE_HR_RTC_SECOND:
-                register_values[i] = (uint16_t)regs->rtc_second;
-                break;
-            case JERRY_DEVICE_HR_APP_VERSION_MAJOR:
-                register_values[i] = (uint16_t)regs->app_version_major;
-                break;
-            case JERRY_DEVICE_HR_APP_VERSION_MINOR:
-                register_values[i] = (uint16_t)regs->app_version_minor;
-                break;
-            case JERRY_DEVICE_HR_APP_VERSION_PATCH:
-                register_values[i] = (uint16_t)regs->app_version_patch;
-                break;
-            case JERRY_DEVICE_HR_APP_BUILD_NUMBER:
-                /* High word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->app_build_number >> 16U);
-                break;
-            case JERRY_DEVICE_HR_APP_BUILD_NUMBER + 1U:
-                /* Low word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->app_build_number & 0xFFFFU);
-                break;
-            default:
-                return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+        const hr_block_provider_t *block = &hr_block_providers[i];
+
+        if (block_overlaps_group(start_address, end_address, block->address,
+                                 block->count))
+        {
+            block->fill(regs);
+            refreshed = true;
         }
     }
 
+    if (refreshed)
+    {
+        jerry_device_registers_publish();
+    }
+
+    if (!jerry_device_read_holding_registers(start_address, quantity,
+                                             register_values))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
     return MODBUS_EXCEPTION_NONE;
 }
 
 /**
- * @brief Write single register callback (FC06)
+ * @brief Validate and apply one holding register write
+ *
+ * Updates the working registers only; the caller publishes them.
+ *
+ * @param[in] address Register address
+ * @param[in] value   New value
+ *
+ * @return modbus_exception_t MODBUS_EXCEPTION_NONE if the value was applied
  */
-modbus_exception_t modbus_cb_write_single_register(uint16_t address,
-                                                   uint16_t value)
+static modbus_exception_t write_holding_register(uint16_t address,
+                                                 uint16_t value)
 {
     jerry_device_holding_registers_t *regs =
         jerry_device_get_holding_registers();
 
+    /* Checked against the generated limits with the whole request */
+    if (jerry_device_holding_registers_is_bulk_writable(address, 1U))
+    {
+        (void)jerry_device_holding_registers_write_word(address, value);
+        return MODBUS_EXCEPTION_NONE;
+    }
+    if ((address >= JERRY_DEVICE_HR_ADC_AWD_0_CHANNEL) &&
+        (address <= JERRY_DEVICE_HR_ADC_AWD_2_INTERLOCKS))
+    {
+        return write_adc_watchdog_register(regs, address, value);
+    }
+    if ((address >= JERRY_DEVICE_HR_GOERTZEL_0_CHANNEL) &&
+        (address <= JERRY_DEVICE_HR_GOERTZEL_7_FREQUENCY))
+    {
+        return write_goertzel_register(regs, address, value);
+    }
+    if ((address >= JERRY_DEVICE_HR_POWER_0_VOLTAGE_CHANNEL) &&
+        (address <= JERRY_DEVICE_HR_POWER_2_CURRENT_CHANNEL))
+    {
+        return write_power_pair_register(regs, address, value);
+    }
+
     switch (address)
     {
-        case JERRY_DEVICE_HR_PWM_0_DUTY_CYCLE:
+        case JERRY_DEVICE_HR_ADC_0_DEADBAND:
+        case JERRY_DEVICE_HR_ADC_1_DEADBAND:
+        case JERRY_DEVICE_HR_ADC_2_DEADBAND:
+        case JERRY_DEVICE_HR_ADC_3_DEADBAND:
+            /* Validate value range */
+            if (value > 3300U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            (void)jerry_device_holding_registers_write_word(address, value);
+            adc_change_set_deadband(
+                (uint8_t)(address - JERRY_DEVICE_HR_ADC_0_DEADBAND),
+                (float32_t)value / 1000.0f);
+            break;
+        case JERRY_DEVICE_HR_ADC_FILTER_BANK:
+            /* Validate value range */
+            if (value > 3U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            /* Switched by the filter task at its next block boundary */
+            if (regs->adc_mains_tracking != 0U)
+            {
+                /* Tracking keeps the notches, the bank supplies the LPF */
+                if (BSP_ADC1_SetMainsTracking(true, (uint8_t)value) != BSP_OK)
+                {
+                    return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
+                }
+            }
+            else
+            {
+                for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+                {
+                    if (BSP_ADC1_SetFilterBank(ch, (uint8_t)value) != BSP_OK)
+                    {
+                        return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
+                    }
+                }
+            }
+            regs->adc_filter_bank = value;
+            break;
+        case JERRY_DEVICE_HR_ADC_MAINS_TRACKING:
+            /* Validate value range */
+            if (value > 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            if (BSP_ADC1_SetMainsTracking(value != 0U,
+                                          (uint8_t)regs->adc_filter_bank) !=
+                BSP_OK)
+            {
+                return MODBUS_EXCEPTION_SLAVE_DEVICE_FAILURE;
+            }
+            regs->adc_mains_tracking = value;
+            break;
+        case JERRY_DEVICE_HR_ADC_SAMPLE_RATE:
+            return write_adc_sample_rate(regs, value);
+        case JERRY_DEVICE_HR_ADC_STREAM_ENABLE:
+            /* Validate value range */
+            if (value > 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_stream_enable = value;
+            update_stream_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_STREAM_CONTENT:
+            /* Validate value range */
+            if (value < 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            if ((value & ~(uint16_t)(ADC_STREAM_FLAG_RAW |
+                                     ADC_STREAM_FLAG_FILTERED |
+                                     ADC_STREAM_FLAG_DI)) != 0U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_stream_content = value;
+            update_stream_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_STREAM_CHANNELS:
+            /* Validate value range */
+            if (value < 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            if (value > ((1U << BSP_ADC1_NUM_CHANNELS) - 1U))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_stream_channels = value;
+            update_stream_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_STREAM_DECIMATED:
+            /* Validate value range */
+            if (value > 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_stream_decimated = value;
+            update_stream_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_STREAM_IP_HIGH:
+            regs->adc_stream_ip_high = value;
+            update_stream_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_STREAM_IP_LOW:
+            regs->adc_stream_ip_low = value;
+            update_stream_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_STREAM_PORT:
+            /* Validate value range */
+            if (value < 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_stream_port = value;
+            update_stream_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_STREAM_COMPRESS:
+            /* Validate value range */
+            if (value > 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_stream_compress = value;
+            update_stream_config(regs);
+            break;
+        case JERRY_DEVICE_HR_TELEMETRY_PERIOD_S:
+            /* Validate value range */
+            if (value > 3600U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->telemetry_period_s = value;
+            update_telemetry_config(regs);
+            break;
+        case JERRY_DEVICE_HR_TELEMETRY_IP_HIGH:
+            regs->telemetry_ip_high = value;
+            update_telemetry_config(regs);
+            break;
+        case JERRY_DEVICE_HR_TELEMETRY_IP_LOW:
+            regs->telemetry_ip_low = value;
+            update_telemetry_config(regs);
+            break;
+        case JERRY_DEVICE_HR_TELEMETRY_PORT:
+            /* Validate value range */
+            if (value < 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->telemetry_port = value;
+            update_telemetry_config(regs);
+            break;
+        case JERRY_DEVICE_HR_DI_CAPTURE_ENABLE:
+            /* Validate value range */
+            if (value > ((1U << GPIODI_CHANNEL_COUNT) - 1U))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            /* Refused for two inputs of one EXTI line */
+            if (BSP_GPIODI_CaptureSelect((uint8_t)value) != BSP_OK)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->di_capture_enable = value;
+            break;
+        case JERRY_DEVICE_HR_CAN_PUBLISH_RATE:
+            /* Validate value range */
+            if (value > CAN_PUBLISH_MAX_RATE_HZ)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->can_publish_rate = value;
+            update_can_config(regs);
+            break;
+        case JERRY_DEVICE_HR_CAN_NOMINAL_BITRATE:
+            /* Validate value range */
+            if ((value < (BSP_CAN_MIN_BITRATE / 1000U)) ||
+                (value > (BSP_CAN_MAX_BITRATE / 1000U)))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->can_nominal_bitrate = value;
+            update_can_config(regs);
+            break;
+        case JERRY_DEVICE_HR_CAN_DATA_BITRATE:
+            /* Validate value range */
+            if ((value < (BSP_CAN_MIN_BITRATE / 1000U)) ||
+                (value > (BSP_CAN_MAX_DATA_BITRATE / 1000U)))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->can_data_bitrate = value;
+            update_can_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_CAPTURE_COMMAND:
+            /* Validate value range */
+            if (value >= (uint16_t)ADC_CAPTURE_COMMAND_COUNT)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_capture_command = value;
+            adc_capture_command(value);
+            break;
+        case JERRY_DEVICE_HR_ADC_CAPTURE_TRIGGER:
+            /* Validate value range */
+            if (value >= (uint16_t)ADC_CAPTURE_TRIGGER_COUNT)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_capture_trigger = value;
+            update_capture_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_CAPTURE_INPUT:
+            /* Validate value range */
+            if (value >= BSP_GPIODI_COUNT)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_capture_input = value;
+            update_capture_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_CAPTURE_LEVEL:
+            /* Validate value range */
+            if (value > ADC_CAPTURE_MAX_LEVEL_MV)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_capture_level = value;
+            update_capture_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_CAPTURE_PRE_SAMPLES:
+            /* Validate value range */
+            if (value > ADC_CAPTURE_MAX_SAMPLES)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_capture_pre_samples = value;
+            update_capture_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ADC_CAPTURE_POST_SAMPLES:
+            /* Validate value range */
+            if (value > ADC_CAPTURE_MAX_SAMPLES)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->adc_capture_post_samples = value;
+            update_capture_config(regs);
+            break;
+        case JERRY_DEVICE_HR_SPECTRUM_CHANNELS:
+            /* Validate value range */
+            if (value > SPECTRUM_ALL_CHANNELS)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->spectrum_channels = value;
+            spectrum_set_channels(value);
+            break;
+        case JERRY_DEVICE_HR_ANOMALY_THRESHOLD:
+            regs->anomaly_threshold = value;
+            update_anomaly_config(regs);
+            break;
+        case JERRY_DEVICE_HR_ANOMALY_HOLD_FRAMES:
+            /* Validate value range */
+            if ((value < 1U) || (value > ANOMALY_MAX_HOLD_FRAMES))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->anomaly_hold_frames = value;
+            update_anomaly_config(regs);
+            break;
+        case JERRY_DEVICE_HR_INTERLOCK_DISABLE:
+            regs->interlock_disable = value;
+            interlock_set_disabled(value);
+            break;
+        case JERRY_DEVICE_HR_SNAPSHOT_RATE_HZ:
+            /* Validate value range */
+            if (value > SNAPSHOT_PUBLISH_MAX_RATE_HZ)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->snapshot_rate_hz = value;
+            update_snapshot_config(regs);
+            break;
+        case JERRY_DEVICE_HR_SNAPSHOT_IP_HIGH:
+            regs->snapshot_ip_high = value;
+            update_snapshot_config(regs);
+            break;
+        case JERRY_DEVICE_HR_SNAPSHOT_IP_LOW:
+            regs->snapshot_ip_low = value;
+            update_snapshot_config(regs);
+            break;
+        case JERRY_DEVICE_HR_SNAPSHOT_PORT:
+            /* Validate value range */
+            if (value < 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->snapshot_port = value;
+            update_snapshot_config(regs);
+            break;
+        case JERRY_DEVICE_HR_MQTT_PERIOD_MS:
+            /* Validate value range; 0 is off */
+            if ((value != 0U) && (value < MQTT_CLIENT_MIN_PERIOD_MS))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            if (value > MQTT_CLIENT_MAX_PERIOD_MS)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->mqtt_period_ms = value;
+            update_mqtt_config(regs);
+            break;
+        case JERRY_DEVICE_HR_MQTT_IP_HIGH:
+            regs->mqtt_ip_high = value;
+            update_mqtt_config(regs);
+            break;
+        case JERRY_DEVICE_HR_MQTT_IP_LOW:
+            regs->mqtt_ip_low = value;
+            update_mqtt_config(regs);
+            break;
+        case JERRY_DEVICE_HR_MQTT_PORT:
+            /* Validate value range */
+            if (value < 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->mqtt_port = value;
+            update_mqtt_config(regs);
+            break;
+        case JERRY_DEVICE_HR_MQTT_QOS:
+            /* Validate value range */
+            if (value >= (1U << MQTT_CLIENT_TOPIC_COUNT))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->mqtt_qos = value;
+            update_mqtt_config(regs);
+            break;
+        case JERRY_DEVICE_HR_MQTT_KEEPALIVE_S:
+            /* Validate value range */
+            if (value > MQTT_CLIENT_MAX_KEEPALIVE_S)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->mqtt_keepalive_s = value;
+            update_mqtt_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_LEASE_IP_HIGH:
+            regs->net_lease_ip_high = value;
+            update_net_cache_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_LEASE_IP_LOW:
+            regs->net_lease_ip_low = value;
+            update_net_cache_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_MASTER_IP_HIGH:
+            regs->net_master_ip_high = value;
+            update_net_cache_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_MASTER_IP_LOW:
+            regs->net_master_ip_low = value;
+            update_net_cache_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_MASTER_MAC_HIGH:
+            regs->net_master_mac_high = value;
+            update_net_cache_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_MASTER_MAC_MID:
+            regs->net_master_mac_mid = value;
+            update_net_cache_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_MASTER_MAC_LOW:
+            regs->net_master_mac_low = value;
+            update_net_cache_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_VLAN_ENABLE:
+            /* Validate value range */
+            if (value > 1U)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->net_vlan_enable = value;
+            update_vlan_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_VLAN_ID:
+            /* Validate value range */
+            if (value > ETHERNETIF_VLAN_ID_MAX)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->net_vlan_id = value;
+            update_vlan_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_VLAN_PCP_CONTROL:
+            /* Validate value range */
+            if (value > ETHERNETIF_PCP_MAX)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->net_vlan_pcp_control = value;
+            update_vlan_config(regs);
+            break;
+        case JERRY_DEVICE_HR_NET_VLAN_PCP_DEFAULT:
             /* Validate value range */
-            if (value > 10000U)
+            if (value > ETHERNETIF_PCP_MAX)
             {
                 return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
             }
-            regs->pwm_0_duty_cycle = value;
+            regs->net_vlan_pcp_default = value;
+            update_vlan_config(regs);
             break;
-        case JERRY_DEVICE_HR_PWM_1_DUTY_CYCLE:
+        case JERRY_DEVICE_HR_NET_VLAN_PCP_BULK:
             /* Validate value range */
-            if (value > 10000U)
+            if (value > ETHERNETIF_PCP_MAX)
             {
                 return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
             }
-            regs->pwm_1_duty_cycle = value;
+            regs->net_vlan_pcp_bulk = value;
+            update_vlan_config(regs);
+            break;
+        case JERRY_DEVICE_HR_FOTA_RESUME_TAG_HIGH:
+            regs->fota_resume_tag_high = value;
+            update_fota_resume(regs);
             break;
-        case JERRY_DEVICE_HR_PWM_2_DUTY_CYCLE:
+        case JERRY_DEVICE_HR_FOTA_RESUME_TAG_LOW:
+            regs->fota_resume_tag_low = value;
+            update_fota_resume(regs);
+            break;
+        case JERRY_DEVICE_HR_FOTA_RESUME_KIB:
+            regs->fota_resume_kib = value;
+            update_fota_resume(regs);
+            break;
+        case JERRY_DEVICE_HR_GOERTZEL_WINDOW_MS:
             /* Validate value range */
-            if (value > 10000U)
+            if ((value < GOERTZEL_MIN_WINDOW_MS) ||
+                (value > GOERTZEL_MAX_WINDOW_MS))
             {
                 return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
             }
-            regs->pwm_2_duty_cycle = value;
+            regs->goertzel_window_ms = value;
+            update_goertzel_config(regs);
             break;
-        case JERRY_DEVICE_HR_PWM_3_DUTY_CYCLE:
+        case JERRY_DEVICE_HR_POWER_WINDOW_MS:
             /* Validate value range */
-            if (value > 10000U)
+            if ((value < POWER_METER_MIN_WINDOW_MS) ||
+                (value > POWER_METER_MAX_WINDOW_MS))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            regs->power_window_ms = value;
+            update_power_meter_config(regs);
+            break;
+        case JERRY_DEVICE_HR_POWER_ENERGY_CLEAR:
+            /* A command: the register keeps reading 0 */
+            if ((value & ~POWER_PAIR_MASK) != 0U)
             {
                 return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
             }
-            regs->pwm_3_duty_cycle = value;
+            power_meter_clear_energy((uint8_t)value);
             break;
         case JERRY_DEVICE_HR_RTC_YEAR:
             /* Validate value range */
@@ -909,90 +2971,364 @@ modbus_exception_t modbus_cb_write_single_register(uint16_t address,
     return MODBUS_EXCEPTION_NONE;
 }
 
+/**
+ * @brief Write single register callback (FC06)
+ */
+modbus_exception_t modbus_cb_write_single_register(uint16_t address,
+                                                   uint16_t value)
+{
+    modbus_exception_t result = MODBUS_EXCEPTION_NONE;
+
+    if (jerry_device_holding_registers_is_bulk_writable(address, 1U))
+    {
+        result = jerry_device_write_holding_registers(address, 1U, &value);
+    }
+    else
+    {
+        result = write_holding_register(address, value);
+    }
+
+    if (result == MODBUS_EXCEPTION_NONE)
+    {
+        result = holding_block_commit(address, 1U);
+    }
+
+    if (result == MODBUS_EXCEPTION_NONE)
+    {
+        registers_written();
+        result = jerry_device_holding_registers_written(address, 1U);
+    }
+
+    if (result == MODBUS_EXCEPTION_NONE)
+    {
+        jerry_device_registers_publish();
+        config_store_note(address, 1U);
+    }
+
+    return result;
+}
+
 /**
  * @brief Write multiple registers callback (FC16)
+ *
+ * The registers written are published once, so readers never see part of
+ * the block (e.g. one word of a 32-bit value). The write hooks run once for
+ * the registers stored, so each PWM channel and control loop is updated
+ * once for the whole block, and the configuration store sees the block
+ * once.
+ *
+ * A block of the groups marked "bulk_write" (PWM, control loops, ADC
+ * calibration, scheduled outputs) is checked against the generated limits
+ * and stored in one pass, then checked as a whole by holding_block_commit()
+ * before any hook runs, so it is applied whole or not at all; any other
+ * block goes through write_holding_register() one register at a time,
+ * which stores the registers of those groups unchecked for
+ * holding_block_commit() to check against the same limits.
  */
 modbus_exception_t modbus_cb_write_multiple_registers(
     uint16_t start_address, uint16_t quantity, const uint16_t *register_values)
 {
-    modbus_exception_t result;
+    modbus_exception_t result = MODBUS_EXCEPTION_NONE;
+    uint16_t           stored = 0U;
+    bool               bulk   = false;
 
-    for (uint16_t i = 0U; i < quantity; i++)
+    /* A block touching a gap is rejected before anything is written */
+    if (!jerry_device_holding_registers_mapped(start_address, quantity))
     {
-        result = modbus_cb_write_single_register(start_address + i,
-                                                 register_values[i]);
-        if (result != MODBUS_EXCEPTION_NONE)
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    if (jerry_device_holding_registers_is_bulk_writable(start_address,
+                                                        quantity))
+    {
+        result = jerry_device_write_holding_registers(start_address, quantity,
+                                                      register_values);
+        stored = (result == MODBUS_EXCEPTION_NONE) ? quantity : 0U;
+        bulk   = true;
+    }
+
+    while ((result == MODBUS_EXCEPTION_NONE) && (stored < quantity))
+    {
+        result = write_holding_register(start_address + stored,
+                                        register_values[stored]);
+        if (result == MODBUS_EXCEPTION_NONE)
         {
-            return result;
+            stored++;
         }
     }
 
-    return MODBUS_EXCEPTION_NONE;
+    if (stored > 0U)
+    {
+        modbus_exception_t check = holding_block_commit(start_address, stored);
+
+        if (result == MODBUS_EXCEPTION_NONE)
+        {
+            result = check;
+        }
+        if (bulk && (check != MODBUS_EXCEPTION_NONE))
+        {
+            stored = 0U;
+        }
+    }
+
+    if (stored > 0U)
+    {
+        modbus_exception_t hook_result =
+            jerry_device_holding_registers_written(start_address, stored);
+
+        registers_written();
+        if (result == MODBUS_EXCEPTION_NONE)
+        {
+            result = hook_result;
+        }
+    }
+
+    /* Registers written one at a time before a failure stay applied */
+    jerry_device_registers_publish();
+    config_store_note(start_address, stored);
+
+    return result;
 }
 
 /* ==========================================================================
  * Input Register Callbacks (FC04)
  * ========================================================================== */
 
+/**
+ * @brief Refresh function of a live input register block
+ *
+ * Fills every register of its block in one pass, like hr_block_fill_t.
+ */
+typedef void (*ir_block_fill_t)(jerry_device_input_registers_t *regs);
+
+/**
+ * @brief Contiguous input registers refreshed on read and never cached
+ */
+typedef struct
+{
+    uint16_t        address; /**< First register address of the block */
+    uint16_t        count;   /**< Number of registers in the block */
+    ir_block_fill_t fill;    /**< Refreshes the whole block */
+} ir_block_provider_t;
+
+/** Live input register blocks, in address order */
+static const ir_block_provider_t ir_block_providers[] = {
+    {JERRY_DEVICE_IR_DI_0_RISING_COUNT,
+     (JERRY_DEVICE_IR_DI_7_HIGH_TIME + 2U) - JERRY_DEVICE_IR_DI_0_RISING_COUNT,
+     update_di_capture_registers},
+    {JERRY_DEVICE_IR_DI_EDGE_SEQUENCE,
+     (JERRY_DEVICE_IR_DI_EDGE_7_EVENT + 1U) - JERRY_DEVICE_IR_DI_EDGE_SEQUENCE,
+     update_di_edge_registers},
+    {JERRY_DEVICE_IR_ADC_CAPTURE_STATE,
+     (JERRY_DEVICE_IR_ADC_CAPTURE_SNAPSHOT + 2U) -
+         JERRY_DEVICE_IR_ADC_CAPTURE_STATE,
+     update_capture_registers},
+    {JERRY_DEVICE_IR_SPECTRUM_FRAME,
+     (JERRY_DEVICE_IR_SPECTRUM_5_THD + 1U) - JERRY_DEVICE_IR_SPECTRUM_FRAME,
+     update_spectrum_registers},
+    {JERRY_DEVICE_IR_ADC_STATS_UPDATE,
+     (JERRY_DEVICE_IR_ADC_STATS_5_1MIN_RMS + 1U) -
+         JERRY_DEVICE_IR_ADC_STATS_UPDATE,
+     update_adc_stats_registers},
+    {JERRY_DEVICE_IR_ANOMALY_FRAME,
+     (JERRY_DEVICE_IR_ANOMALY_5_SCORE + 1U) - JERRY_DEVICE_IR_ANOMALY_FRAME,
+     update_anomaly_registers},
+    {JERRY_DEVICE_IR_INTERLOCK_TRIPPED,
+     (JERRY_DEVICE_IR_INTERLOCK_WRITE_ERRORS + 2U) -
+         JERRY_DEVICE_IR_INTERLOCK_TRIPPED,
+     update_interlock_registers},
+    {JERRY_DEVICE_IR_DO_SCHEDULE_PENDING,
+     (JERRY_DEVICE_IR_DO_SCHEDULE_LATENCY + 2U) -
+         JERRY_DEVICE_IR_DO_SCHEDULE_PENDING,
+     update_do_schedule_registers},
+    {JERRY_DEVICE_IR_ADC_AWD_ALARMS,
+     (JERRY_DEVICE_IR_ADC_AWD_EVENTS + 2U) - JERRY_DEVICE_IR_ADC_AWD_ALARMS,
+     update_adc_watchdog_registers},
+    {JERRY_DEVICE_IR_ADC_0_QUALITY,
+     (JERRY_DEVICE_IR_ADC_5_QUALITY + 1U) - JERRY_DEVICE_IR_ADC_0_QUALITY,
+     update_adc_quality_registers},
+    {JERRY_DEVICE_IR_GOERTZEL_WINDOW,
+     (JERRY_DEVICE_IR_GOERTZEL_7_PHASE + 1U) - JERRY_DEVICE_IR_GOERTZEL_WINDOW,
+     update_goertzel_registers},
+    {JERRY_DEVICE_IR_POWER_WINDOW,
+     (JERRY_DEVICE_IR_POWER_2_APPARENT_ENERGY + 4U) -
+         JERRY_DEVICE_IR_POWER_WINDOW,
+     update_power_registers},
+};
+
+/** Number of entries in ir_block_providers */
+#define IR_BLOCK_PROVIDER_COUNT \
+    (sizeof(ir_block_providers) / sizeof(ir_block_providers[0]))
+
 /**
  * @brief Read input registers callback (FC04)
+ *
+ * Live blocks touched by the request are refreshed and published first,
+ * as for holding registers.
  */
 modbus_exception_t modbus_cb_read_input_registers(uint16_t  start_address,
                                                   uint16_t  quantity,
                                                   uint16_t *register_values)
 {
-    jerry_device_input_registers_t *regs = jerry_device_get_input_registers();
-    uint16_t                        end_address = start_address + quantity - 1U;
+    uint16_t end_address = start_address + quantity - 1U;
+    bool     refreshed   = false;
 
-    /* Validate address range */
-    if (!ADDR_IN_RANGE_FROM_ZERO(start_address, JERRY_DEVICE_IR_MAX_ADDR) ||
-        !ADDR_IN_RANGE_FROM_ZERO(end_address, JERRY_DEVICE_IR_MAX_ADDR))
+    /* Latency histograms and CPU load (modbus_diag.h) */
+    if (modbus_diag_overlaps(start_address, quantity))
+    {
+        return modbus_diag_read_input_registers(start_address, quantity,
+                                                register_values);
+    }
+
+    /* Validate address range, gaps included */
+    if (!jerry_device_input_registers_mapped(start_address, quantity))
     {
         return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
     }
 
-    /* Read each register */
-    for (uint16_t i = 0U; i < quantity; i++)
+    for (uint16_t i = 0U; i < IR_BLOCK_PROVIDER_COUNT; i++)
     {
-        uint16_t addr = start_address + i;
-
-        switch (addr)
-        {
-            case JERRY_DEVICE_IR_ADC_0_VALUE:
-                register_values[i] = (uint16_t)regs->adc_0_value;
-                break;
-            case JERRY_DEVICE_IR_ADC_1_VALUE:
-                register_values[i] = (uint16_t)regs->adc_1_value;
-                break;
-            case JERRY_DEVICE_IR_ADC_2_VALUE:
-                register_values[i] = (uint16_t)regs->adc_2_value;
-                break;
-            case JERRY_DEVICE_IR_ADC_3_VALUE:
-                register_values[i] = (uint16_t)regs->adc_3_value;
-                break;
-            case JERRY_DEVICE_IR_APP_VERSION_MAJOR:
-                register_values[i] = (uint16_t)regs->app_version_major;
-                break;
-            case JERRY_DEVICE_IR_APP_VERSION_MINOR:
-                register_values[i] = (uint16_t)regs->app_version_minor;
-                break;
-            case JERRY_DEVICE_IR_APP_VERSION_PATCH:
-                register_values[i] = (uint16_t)regs->app_version_patch;
-                break;
-            case JERRY_DEVICE_IR_APP_BUILD_NUMBER:
-                /* High word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->app_build_number >> 16U);
-                break;
-            case JERRY_DEVICE_IR_APP_BUILD_NUMBER + 1U:
-                /* Low word of 32-bit value */
-                register_values[i] =
-                    (uint16_t)((uint32_t)regs->app_build_number & 0xFFFFU);
-                break;
-            default:
-                return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+        const ir_block_provider_t *block = &ir_block_providers[i];
+
+        if (block_overlaps_group(start_address, end_address, block->address,
+                                 block->count))
+        {
+            block->fill(jerry_device_get_input_registers());
+            refreshed = true;
         }
     }
 
+    if (refreshed)
+    {
+        jerry_device_registers_publish();
+    }
+
+    if (!jerry_device_read_input_registers(start_address, quantity,
+                                           register_values))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
     return MODBUS_EXCEPTION_NONE;
 }
+
+/* ==========================================================================
+ * Response Cache Policy
+ * ========================================================================== */
+
+/**
+ * @brief Freshness window of a read block (see modbus_response_cache.h)
+ *
+ * Holding register reads get the shortest window of the live blocks they
+ * touch. Digital inputs are sampled from the expanders on every read and
+ * are never cached, nor are the diagnostic and live input register blocks,
+ * nor the digital output coils, which the output schedule and the
+ * interlock drive too. Everything else only changes through the write
+ * callbacks above, whoever calls them (Modbus on any transport, OPC UA,
+ * the configuration store, FOTA, the network cache), and they drop the
+ * cache.
+ */
+uint32_t modbus_response_cache_ttl_ms(uint8_t  function_code,
+                                      uint16_t start_address,
+                                      uint16_t quantity)
+{
+    uint16_t end_address = start_address + quantity - 1U;
+    uint32_t ttl_ms      = STATIC_DATA_CACHE_TTL_MS;
+
+    if (quantity == 0U)
+    {
+        return 0U;
+    }
+
+    switch (function_code)
+    {
+        case MODBUS_FC_READ_COILS:
+            if (block_overlaps_group(
+                    start_address, end_address,
+                    JERRY_DEVICE_COIL_GROUP_DIGITAL_INPUTS_ADDR,
+                    JERRY_DEVICE_COIL_GROUP_DIGITAL_INPUTS_COUNT) ||
+                block_overlaps_group(
+                    start_address, end_address,
+                    JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_ADDR,
+                    JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_COUNT))
+            {
+                ttl_ms = 0U;
+            }
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            if (block_overlaps_group(start_address, end_address,
+                                     JERRY_DEVICE_DI_GROUP_DIGITAL_INPUTS_ADDR,
+                                     JERRY_DEVICE_DI_GROUP_DIGITAL_INPUTS_COUNT))
+            {
+                ttl_ms = 0U;
+            }
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            for (uint16_t i = 0U; i < HR_BLOCK_PROVIDER_COUNT; i++)
+            {
+                const hr_block_provider_t *block = &hr_block_providers[i];
+
+                if (block_overlaps_group(start_address, end_address,
+                                         block->address, block->count) &&
+                    (block->ttl_ms < ttl_ms))
+                {
+                    ttl_ms = block->ttl_ms;
+                }
+            }
+            break;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            if (modbus_diag_overlaps(start_address, quantity))
+            {
+                ttl_ms = 0U;
+            }
+            for (uint16_t i = 0U; i < IR_BLOCK_PROVIDER_COUNT; i++)
+            {
+                if (block_overlaps_group(start_address, end_address,
+                                         ir_block_providers[i].address,
+                                         ir_block_providers[i].count))
+                {
+                    ttl_ms = 0U;
+                }
+            }
+            break;
+        default:
+            ttl_ms = 0U;
+            break;
+    }
+
+    return ttl_ms;
+}
+
+/**
+ * @brief Version of the data behind a read block
+ *
+ * The ADC value blocks only change when the change detector publishes one
+ * of their channels, so their version is the total change count of those
+ * channels; every other block stays at version 0.
+ */
+uint32_t modbus_response_cache_version(uint8_t  function_code,
+                                       uint16_t start_address,
+                                       uint16_t quantity)
+{
+    uint16_t end_address = start_address + quantity - 1U;
+    uint32_t channels    = 0U;
+
+    if ((function_code != MODBUS_FC_READ_HOLDING_REGISTERS) ||
+        (quantity == 0U))
+    {
+        return 0U;
+    }
+
+    for (uint16_t i = 0U; i < HR_BLOCK_PROVIDER_COUNT; i++)
+    {
+        const hr_block_provider_t *block = &hr_block_providers[i];
+
+        if (block_overlaps_group(start_address, end_address, block->address,
+                                 block->count))
+        {
+            channels |= block->adc_channels;
+        }
+    }
+
+    return (channels != 0U) ? adc_change_count(channels) : 0U;
+}
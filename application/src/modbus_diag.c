@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus Diagnostic Registers
+ *
+ * Owns the latency statistics of both transports and implements the cycle
+ * counter port hook of the Modbus library on the DWT counter. Registers
+ * are computed from the histograms, the CPU load snapshot and the ADC1
+ * stage times on every read.
+ */
+
+#include "modbus_diag.h"
+
+#include "bsp.h"
+#include "modbus_internal.h"
+
+#if MODBUS_ENABLE_LATENCY_STATS
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Latency statistics, written by the Modbus core under the register mutex */
+static modbus_latency_stats_t s_latency_stats[MODBUS_DIAG_TRANSPORT_COUNT];
+#endif
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Check whether a register block lies wholly in a diagnostic block
+ */
+static bool diag_block_contains(uint16_t start_address, uint16_t quantity,
+                                uint32_t base, uint32_t count)
+{
+    uint32_t end = (uint32_t)start_address + quantity;
+
+    return (start_address >= base) && (end <= (base + count));
+}
+
+/**
+ * @brief Check whether a register block touches a diagnostic block
+ */
+static bool diag_block_overlaps(uint16_t start_address, uint16_t quantity,
+                                uint32_t base, uint32_t count)
+{
+    uint32_t end = (uint32_t)start_address + quantity;
+
+    return (quantity != 0U) && (end > base) &&
+           (start_address < (base + count));
+}
+
+/**
+ * @brief Read CPU load registers
+ *
+ * @param[in]  offset   Offset of the first register in the CPU load block
+ * @param[in]  quantity Number of registers
+ * @param[out] values   Register values
+ */
+static void diag_read_cpu_load(uint16_t offset, uint16_t quantity,
+                               uint16_t *values)
+{
+    static cpu_load_snapshot_t snapshot;
+
+    cpu_load_get(&snapshot);
+
+    for (uint16_t i = 0U; i < quantity; i++)
+    {
+        uint16_t reg = (uint16_t)(offset + i);
+        uint16_t value = 0U;
+
+        if (reg == 0U)
+        {
+            value = snapshot.total;
+        }
+        else if (reg == 1U)
+        {
+            value = snapshot.isr[BSP_ISR_ADC1_DMA];
+        }
+        else if (reg == 2U)
+        {
+            value = snapshot.isr[BSP_ISR_ETH];
+        }
+        else if (reg == 3U)
+        {
+            value = snapshot.task_count;
+        }
+        else
+        {
+            uint16_t task  = (uint16_t)((reg - 4U) / MODBUS_DIAG_CPU_TASK_REGS);
+            uint16_t field = (uint16_t)((reg - 4U) % MODBUS_DIAG_CPU_TASK_REGS);
+
+            if (task >= snapshot.task_count)
+            {
+                /* Unused slot reads as 0 */
+            }
+            else if (field == (MODBUS_DIAG_CPU_TASK_REGS - 1U))
+            {
+                value = snapshot.tasks[task].load;
+            }
+            else
+            {
+                const char *name = &snapshot.tasks[task].name[field * 2U];
+
+                value = (uint16_t)(((uint16_t)(uint8_t)name[0] << 8) |
+                                   (uint8_t)name[1]);
+            }
+        }
+
+        values[i] = value;
+    }
+}
+
+/**
+ * @brief Convert cycles to 0.1 us, saturating
+ */
+static uint16_t diag_cycles_to_tenth_us(uint64_t cycles)
+{
+    uint64_t tenths = (cycles * 10U) / (BSP_CycleCounter_Hz() / 1000000U);
+
+    return (tenths > UINT16_MAX) ? UINT16_MAX : (uint16_t)tenths;
+}
+
+/**
+ * @brief Read ADC latency registers
+ *
+ * @param[in]  offset   Offset of the first register in the ADC latency block
+ * @param[in]  quantity Number of registers
+ * @param[out] values   Register values
+ */
+static void diag_read_adc_latency(uint16_t offset, uint16_t quantity,
+                                  uint16_t *values)
+{
+    static bsp_adc1_latency_t latency;
+    uint16_t                  stage = UINT16_MAX;
+
+    for (uint16_t i = 0U; i < quantity; i++)
+    {
+        uint16_t reg   = (uint16_t)(offset + i);
+        uint16_t field = (uint16_t)(reg % MODBUS_DIAG_ADC_STAGE_REGS);
+        uint32_t value;
+
+        /* One copy per stage, so a slot is read from one moment */
+        if ((reg / MODBUS_DIAG_ADC_STAGE_REGS) != stage)
+        {
+            stage = (uint16_t)(reg / MODBUS_DIAG_ADC_STAGE_REGS);
+            (void)BSP_ADC1_GetLatency((bsp_adc1_latency_stage_t)stage,
+                                      &latency);
+        }
+
+        if (field == 0U)
+        {
+            value = latency.count >> 16;
+        }
+        else if (field == 1U)
+        {
+            value = latency.count & 0xFFFFU;
+        }
+        else if (field == 2U)
+        {
+            value = diag_cycles_to_tenth_us(latency.min_cycles);
+        }
+        else if (field == 3U)
+        {
+            value = (latency.count == 0U)
+                        ? 0U
+                        : diag_cycles_to_tenth_us(latency.sum_cycles /
+                                                  latency.count);
+        }
+        else if (field == 4U)
+        {
+            value = diag_cycles_to_tenth_us(latency.max_cycles);
+        }
+        else
+        {
+            uint32_t bucket = latency.buckets[(field - 5U) / 2U];
+
+            value = (((field - 5U) % 2U) == 0U) ? (bucket >> 16)
+                                                : (bucket & 0xFFFFU);
+        }
+
+        values[i] = (uint16_t)value;
+    }
+}
+
+#if MODBUS_ENABLE_LATENCY_STATS
+/**
+ * @brief Compute one latency register
+ *
+ * @param[in] offset Register offset in the latency block
+ *
+ * @return Register value
+ */
+static uint16_t diag_register(uint16_t offset)
+{
+    const modbus_latency_histogram_t *histogram;
+    uint16_t transport = (uint16_t)(offset / MODBUS_DIAG_TRANSPORT_REGS);
+    uint16_t slot      = (uint16_t)(offset % MODBUS_DIAG_TRANSPORT_REGS);
+    uint16_t field     = (uint16_t)(slot % MODBUS_DIAG_SLOT_REGS);
+    uint16_t value;
+
+    histogram =
+        &s_latency_stats[transport].fc[slot / MODBUS_DIAG_SLOT_REGS];
+
+    if (field == 0U)
+    {
+        value = (uint16_t)(histogram->count >> 16);
+    }
+    else if (field == 1U)
+    {
+        value = (uint16_t)histogram->count;
+    }
+    else if (field < (2U + MODBUS_LATENCY_BUCKETS))
+    {
+        value = histogram->buckets[field - 2U];
+    }
+    else if (histogram->count == 0U)
+    {
+        value = 0U;
+    }
+    else
+    {
+        uint32_t cycles_per_us = BSP_CycleCounter_Hz() / 1000000U;
+        uint64_t mean_us =
+            histogram->stage_cycles[field - 2U - MODBUS_LATENCY_BUCKETS] /
+            histogram->count / ((cycles_per_us != 0U) ? cycles_per_us : 1U);
+
+        value = (mean_us > UINT16_MAX) ? UINT16_MAX : (uint16_t)mean_us;
+    }
+
+    return value;
+}
+#endif
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+#if MODBUS_ENABLE_LATENCY_STATS
+uint32_t modbus_port_cycle_count(void) { return BSP_CycleCounter_Read(); }
+
+modbus_latency_stats_t *modbus_diag_latency_stats(
+    modbus_diag_transport_t transport)
+{
+    if ((uint32_t)transport >= (uint32_t)MODBUS_DIAG_TRANSPORT_COUNT)
+    {
+        return NULL;
+    }
+
+    return &s_latency_stats[transport];
+}
+#endif
+
+bool modbus_diag_overlaps(uint16_t start_address, uint16_t quantity)
+{
+    bool overlaps = diag_block_overlaps(start_address, quantity,
+                                        MODBUS_DIAG_CPU_IR_BASE,
+                                        MODBUS_DIAG_CPU_IR_COUNT) ||
+                    diag_block_overlaps(start_address, quantity,
+                                        MODBUS_DIAG_ADC_IR_BASE,
+                                        MODBUS_DIAG_ADC_IR_COUNT);
+
+#if MODBUS_ENABLE_LATENCY_STATS
+    overlaps = overlaps ||
+               diag_block_overlaps(start_address, quantity,
+                                   MODBUS_DIAG_IR_BASE, MODBUS_DIAG_IR_COUNT);
+#endif
+
+    return overlaps;
+}
+
+modbus_exception_t modbus_diag_read_input_registers(uint16_t  start_address,
+                                                    uint16_t  quantity,
+                                                    uint16_t *values)
+{
+    if (diag_block_contains(start_address, quantity, MODBUS_DIAG_CPU_IR_BASE,
+                            MODBUS_DIAG_CPU_IR_COUNT))
+    {
+        diag_read_cpu_load((uint16_t)(start_address - MODBUS_DIAG_CPU_IR_BASE),
+                           quantity, values);
+        return MODBUS_EXCEPTION_NONE;
+    }
+
+    if (diag_block_contains(start_address, quantity, MODBUS_DIAG_ADC_IR_BASE,
+                            MODBUS_DIAG_ADC_IR_COUNT))
+    {
+        diag_read_adc_latency(
+            (uint16_t)(start_address - MODBUS_DIAG_ADC_IR_BASE), quantity,
+            values);
+        return MODBUS_EXCEPTION_NONE;
+    }
+
+#if MODBUS_ENABLE_LATENCY_STATS
+    if (diag_block_contains(start_address, quantity, MODBUS_DIAG_IR_BASE,
+                            MODBUS_DIAG_IR_COUNT))
+    {
+        for (uint16_t i = 0U; i < quantity; i++)
+        {
+            values[i] = diag_register(
+                (uint16_t)(start_address - MODBUS_DIAG_IR_BASE + i));
+        }
+        return MODBUS_EXCEPTION_NONE;
+    }
+#endif
+
+    return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus File Records
+ *
+ * Dispatches FC20 and FC21 sub-requests by file number; see
+ * modbus_files.h.
+ */
+
+#include "modbus_files.h"
+
+#include "adc_archive.h"
+#include "adc_capture.h"
+#include "config_store.h"
+#include "interlock.h"
+#include "spectrum.h"
+#include "telemetry.h"
+
+_Static_assert(SPECTRUM_FILE_NUMBER >=
+                   (ADC_CAPTURE_FILE_NUMBER + ADC_CAPTURE_FILE_COUNT),
+               "spectrum file overlaps the capture files");
+_Static_assert(INTERLOCK_FILE_NUMBER > SPECTRUM_FILE_NUMBER,
+               "interlock file overlaps the spectrum file");
+_Static_assert(CONFIG_STORE_FILE_NUMBER > INTERLOCK_FILE_NUMBER,
+               "configuration file overlaps the interlock file");
+_Static_assert(ADC_ARCHIVE_FILE_NUMBER > CONFIG_STORE_FILE_NUMBER,
+               "archive file overlaps the configuration file");
+
+modbus_exception_t modbus_files_read_record(uint16_t  file_number,
+                                            uint16_t  record_number,
+                                            uint16_t  record_length,
+                                            uint16_t *values)
+{
+    if (file_number == TELEMETRY_FILE_NUMBER)
+    {
+        return telemetry_read_file_record(file_number, record_number,
+                                          record_length, values);
+    }
+
+    if ((file_number >= ADC_CAPTURE_FILE_NUMBER) &&
+        (file_number < (ADC_CAPTURE_FILE_NUMBER + ADC_CAPTURE_FILE_COUNT)))
+    {
+        return adc_capture_read_file_record(file_number, record_number,
+                                            record_length, values);
+    }
+
+    if (file_number == SPECTRUM_FILE_NUMBER)
+    {
+        return spectrum_read_file_record(file_number, record_number,
+                                         record_length, values);
+    }
+
+    if (file_number == INTERLOCK_FILE_NUMBER)
+    {
+        return interlock_read_file_record(file_number, record_number,
+                                          record_length, values);
+    }
+
+    if (file_number == CONFIG_STORE_FILE_NUMBER)
+    {
+        return config_store_read_file_record(file_number, record_number,
+                                             record_length, values);
+    }
+
+#if ADC_ARCHIVE
+    if (file_number == ADC_ARCHIVE_FILE_NUMBER)
+    {
+        return adc_archive_read_file_record(file_number, record_number,
+                                            record_length, values);
+    }
+#endif
+
+    return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+}
+
+const uint16_t *modbus_files_map_record(uint16_t file_number,
+                                        uint16_t record_number,
+                                        uint16_t record_length)
+{
+    return adc_capture_map_file_record(file_number, record_number,
+                                       record_length);
+}
+
+modbus_exception_t modbus_files_write_record(uint16_t        file_number,
+                                             uint16_t        record_number,
+                                             uint16_t        record_length,
+                                             const uint16_t *values)
+{
+    if (file_number == CONFIG_STORE_FILE_NUMBER)
+    {
+        return config_store_write_file_record(file_number, record_number,
+                                              record_length, values);
+    }
+
+#if ADC_ARCHIVE
+    if (file_number == ADC_ARCHIVE_FILE_NUMBER)
+    {
+        return adc_archive_write_file_record(file_number, record_number,
+                                             record_length, values);
+    }
+#endif
+
+    return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+}
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP to RTU Gateway
+ *
+ * A TCP worker that receives a request for a downstream unit queues a
+ * descriptor of it on the port serving that unit and sleeps until the
+ * port task has completed the transaction, successfully or not. The port
+ * task owns its serial port: it sends the request, waits for the matching
+ * response and wakes the worker.
+ */
+
+#include "modbus_gateway.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "modbus_internal.h"
+#include "modbus_rtu_task.h"
+#include "modbus_units.h"
+#include "queue.h"
+#include "task.h"
+#include "task_priorities.h"
+
+#if MODBUS_GATEWAY
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Number of serial ports downstream devices can be reached on */
+#define MODBUS_GATEWAY_PORT_COUNT 1U
+
+/** Stack size of each port task (words) */
+#define MODBUS_GATEWAY_STACK_SIZE 384U
+
+/** Priority of the port tasks, that of the RS-485 port */
+#define MODBUS_GATEWAY_PRIORITY TASK_PRIO_RS485
+
+/** Transmit timeout, above a 256-byte frame at 9600 baud (293 ms) */
+#define MODBUS_GATEWAY_TX_TIMEOUT_MS 500U
+
+/** Offset of the unit ID in an MBAP frame, where the RTU frame starts */
+#define MODBUS_GATEWAY_UNIT_OFFSET 6U
+
+/** Highest unit ID an RTU device can have */
+#define MODBUS_GATEWAY_MAX_UNIT_ID 247U
+
+/** Smallest RTU response: unit ID, function code, one byte, CRC */
+#define MODBUS_GATEWAY_MIN_RESPONSE 5U
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Serial driver of a port
+ */
+typedef struct
+{
+    const char *task_name;
+    bsp_error_t (*init)(const bsp_rs485_config_t *config);
+    bsp_error_t (*transmit)(const uint8_t *data, uint16_t length,
+                            uint32_t timeout_ms);
+    bsp_error_t (*read_frame)(uint8_t *frame, uint16_t size, uint16_t *length,
+                              uint32_t timeout_ms);
+} modbus_gateway_driver_t;
+
+/**
+ * @brief One forwarded transaction, owned by the waiting worker
+ *
+ * @c frame holds the RTU request on entry and the RTU response on return,
+ * in the worker's TX buffer.
+ */
+typedef struct
+{
+    uint8_t           *frame;  /**< RTU frame buffer */
+    uint16_t           size;   /**< Size of @c frame in bytes */
+    uint16_t           length; /**< Request, then response length */
+    TaskHandle_t       waiter; /**< Worker woken on completion */
+    modbus_exception_t result; /**< NONE, or the gateway exception */
+} modbus_gateway_request_t;
+
+/**
+ * @brief Port state
+ */
+typedef struct
+{
+    const modbus_gateway_driver_t *driver;
+    QueueHandle_t                  queue;
+    StaticQueue_t                  queue_buffer;
+    modbus_gateway_request_t *queue_storage[MODBUS_GATEWAY_QUEUE_DEPTH];
+    StaticTask_t              task_tcb;
+    StackType_t               task_stack[MODBUS_GATEWAY_STACK_SIZE];
+    modbus_gateway_stats_t    stats;
+} modbus_gateway_port_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Serial drivers, indexed by port */
+static const modbus_gateway_driver_t
+    s_gateway_drivers[MODBUS_GATEWAY_PORT_COUNT] = {
+        {"GwRS485", BSP_RS485_Init, BSP_RS485_Transmit, BSP_RS485_ReadFrame},
+};
+
+/** Port state, indexed by port */
+static modbus_gateway_port_t s_gateway_ports[MODBUS_GATEWAY_PORT_COUNT];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Select the port a unit is reached on
+ *
+ * With a single serial port every downstream unit is on port 0.
+ */
+static modbus_gateway_port_t *modbus_gateway_route(uint8_t unit_id)
+{
+    (void)unit_id;
+    return &s_gateway_ports[0];
+}
+
+/**
+ * @brief Discard frames received since the last transaction
+ *
+ * A late answer to a timed-out request must not be taken for the response
+ * to the next one. A 1-byte buffer makes the driver consume every frame.
+ */
+static void modbus_gateway_drain(const modbus_gateway_driver_t *driver)
+{
+    uint8_t  scratch;
+    uint16_t length;
+
+    while (driver->read_frame(&scratch, 1U, &length, 0U) != BSP_TIMEOUT)
+    {
+        /* Frame dropped */
+    }
+}
+
+/**
+ * @brief Run one transaction on a port
+ *
+ * @param[in]     port    Port
+ * @param[in,out] request Transaction, completed on return
+ */
+static void modbus_gateway_transact(modbus_gateway_port_t    *port,
+                                    modbus_gateway_request_t *request)
+{
+    const modbus_gateway_driver_t *driver   = port->driver;
+    uint8_t                        unit_id  = request->frame[0];
+    uint8_t                        function = request->frame[1];
+    TimeOut_t                      timeout;
+    TickType_t remaining = pdMS_TO_TICKS(MODBUS_GATEWAY_RESPONSE_TIMEOUT_MS);
+
+    request->result = MODBUS_EXCEPTION_GATEWAY_TARGET_FAILED;
+
+    modbus_gateway_drain(driver);
+
+    if (driver->transmit(request->frame, request->length,
+                         MODBUS_GATEWAY_TX_TIMEOUT_MS) != BSP_OK)
+    {
+        request->result = MODBUS_EXCEPTION_GATEWAY_PATH_UNAVAIL;
+        return;
+    }
+    port->stats.forwarded++;
+
+    vTaskSetTimeOutState(&timeout);
+    while (xTaskCheckForTimeOut(&timeout, &remaining) == pdFALSE)
+    {
+        uint16_t length = 0U;
+
+        if ((driver->read_frame(request->frame, request->size, &length,
+                                pdTICKS_TO_MS(remaining)) == BSP_OK) &&
+            (length >= MODBUS_GATEWAY_MIN_RESPONSE) &&
+            (request->frame[0] == unit_id) &&
+            ((request->frame[1] & 0x7FU) == function) &&
+            modbus_crc16_verify(request->frame, length))
+        {
+            request->length = length;
+            request->result = MODBUS_EXCEPTION_NONE;
+            port->stats.responses++;
+            return;
+        }
+    }
+
+    port->stats.timeouts++;
+}
+
+/**
+ * @brief Port task
+ *
+ * @param[in] arg Pointer to the port's modbus_gateway_port_t
+ */
+static void modbus_gateway_port_task(void *arg)
+{
+    modbus_gateway_port_t    *port = (modbus_gateway_port_t *)arg;
+    modbus_gateway_request_t *request;
+    bsp_rs485_config_t        config;
+    bool                      port_ok;
+
+    config.baudrate = MODBUS_RTU_BAUDRATE;
+    config.parity   = MODBUS_RTU_PARITY;
+    config.frame_timeout_us =
+        modbus_rtu_get_interframe_delay_us(MODBUS_RTU_BAUDRATE);
+
+    port_ok = (port->driver->init(&config) == BSP_OK);
+    if (port_ok)
+    {
+        printf("Modbus gateway: %s at %u baud\n", port->driver->task_name,
+               (unsigned int)config.baudrate);
+    }
+    else
+    {
+        /* Requests are still taken and answered as path unavailable */
+        printf("Modbus gateway: %s init failed\n", port->driver->task_name);
+    }
+
+    for (;;)
+    {
+        if (xQueueReceive(port->queue, &request, portMAX_DELAY) == pdPASS)
+        {
+            if (port_ok)
+            {
+                modbus_gateway_transact(port, request);
+            }
+            else
+            {
+                request->result = MODBUS_EXCEPTION_GATEWAY_PATH_UNAVAIL;
+            }
+            (void)xTaskNotifyGiveIndexed(request->waiter,
+                                         MODBUS_GATEWAY_NOTIFY_INDEX);
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_gateway_start(void)
+{
+    for (uint8_t i = 0U; i < MODBUS_GATEWAY_PORT_COUNT; i++)
+    {
+        modbus_gateway_port_t *port = &s_gateway_ports[i];
+
+        port->driver = &s_gateway_drivers[i];
+        port->queue  = xQueueCreateStatic(
+            MODBUS_GATEWAY_QUEUE_DEPTH, sizeof(modbus_gateway_request_t *),
+            (uint8_t *)port->queue_storage, &port->queue_buffer);
+        (void)xTaskCreateStatic(modbus_gateway_port_task,
+                                port->driver->task_name,
+                                MODBUS_GATEWAY_STACK_SIZE, port,
+                                MODBUS_GATEWAY_PRIORITY, port->task_stack,
+                                &port->task_tcb);
+    }
+}
+
+bool modbus_gateway_is_remote(uint8_t unit_id)
+{
+    return (unit_id != 0U) && (unit_id <= MODBUS_GATEWAY_MAX_UNIT_ID) &&
+           (modbus_units_lookup(unit_id) == NULL);
+}
+
+modbus_error_t modbus_gateway_forward(const uint8_t *request,
+                                      uint16_t request_len, uint8_t *response,
+                                      uint16_t *response_len)
+{
+    modbus_gateway_request_t  transaction;
+    modbus_gateway_request_t *pending = &transaction;
+    modbus_gateway_port_t    *port;
+    uint8_t                  *rtu      = &response[MODBUS_GATEWAY_UNIT_OFFSET];
+    uint16_t                  rtu_len  = 0U;
+    uint16_t                  mbap_len = 0U;
+
+    /* Unit ID + PDU, then room for the CRC */
+    if ((request_len <= (MODBUS_GATEWAY_UNIT_OFFSET + 1U)) ||
+        ((request_len - MODBUS_GATEWAY_UNIT_OFFSET + 2U) >
+         MODBUS_RTU_MAX_ADU_SIZE) ||
+        (request[2] != 0U) || (request[3] != 0U))
+    {
+        return MODBUS_ERROR_FRAME;
+    }
+
+    port = modbus_gateway_route(request[MODBUS_GATEWAY_UNIT_OFFSET]);
+
+    rtu_len = (uint16_t)(request_len - MODBUS_GATEWAY_UNIT_OFFSET);
+    (void)memcpy(rtu, &request[MODBUS_GATEWAY_UNIT_OFFSET], rtu_len);
+
+    transaction.frame  = rtu;
+    transaction.size   = MODBUS_RTU_MAX_ADU_SIZE;
+    transaction.length = modbus_crc16_append(rtu, rtu_len);
+    transaction.waiter = xTaskGetCurrentTaskHandle();
+    transaction.result = MODBUS_EXCEPTION_GATEWAY_PATH_UNAVAIL;
+
+    (void)xTaskNotifyStateClearIndexed(NULL, MODBUS_GATEWAY_NOTIFY_INDEX);
+    if (xQueueSend(port->queue, &pending, 0U) == pdPASS)
+    {
+        /* The port always completes a transaction it has taken */
+        (void)ulTaskNotifyTakeIndexed(MODBUS_GATEWAY_NOTIFY_INDEX, pdTRUE,
+                                      portMAX_DELAY);
+    }
+    else
+    {
+        port->stats.rejected++;
+    }
+
+    if (transaction.result == MODBUS_EXCEPTION_NONE)
+    {
+        /* Unit ID + PDU of the response, CRC dropped */
+        mbap_len = (uint16_t)(transaction.length - 2U);
+    }
+    else
+    {
+        rtu[0]   = request[MODBUS_GATEWAY_UNIT_OFFSET];
+        rtu[1]   = (uint8_t)(request[MODBUS_GATEWAY_UNIT_OFFSET + 1U] | 0x80U);
+        rtu[2]   = (uint8_t)transaction.result;
+        mbap_len = 3U;
+    }
+
+    /* MBAP header: transaction and protocol ID echoed, new length */
+    response[0]   = request[0];
+    response[1]   = request[1];
+    response[2]   = 0U;
+    response[3]   = 0U;
+    response[4]   = (uint8_t)(mbap_len >> 8U);
+    response[5]   = (uint8_t)(mbap_len & 0xFFU);
+    *response_len = (uint16_t)(MODBUS_GATEWAY_UNIT_OFFSET + mbap_len);
+
+    return MODBUS_OK;
+}
+
+bool modbus_gateway_get_stats(uint8_t port, modbus_gateway_stats_t *stats)
+{
+    if ((port >= MODBUS_GATEWAY_PORT_COUNT) || (stats == NULL))
+    {
+        return false;
+    }
+
+    *stats = s_gateway_ports[port].stats;
+    return true;
+}
+
+#endif /* MODBUS_GATEWAY */
@@ -0,0 +1,556 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus Report by Exception Task
+ *
+ * One task owns the UDP connection and the subscription table: it handles
+ * the subscribe messages as they arrive and scans every subscribed block
+ * once per MODBUS_RBE_SCAN_MS. Blocks are read through the Modbus read
+ * callbacks under the register mutex shared with the other transports, so
+ * live blocks (ADC readings) are refreshed exactly as for a Modbus read.
+ * Each subscription keeps the values last reported to its client; a
+ * change is measured against those, not against the previous scan, so a
+ * slow drift is reported once it exceeds the deadband.
+ */
+
+#include "modbus_rbe.h"
+
+#if MODBUS_RBE
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bsp_sections.h"
+#include "ethernetif.h"
+#include "log.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "lwip/netbuf.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include "modbus.h"
+#include "modbus_callbacks.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the task (words) */
+#define MODBUS_RBE_STACK_SIZE 512U
+
+/** Largest block of bits */
+#define MODBUS_RBE_MAX_BITS (MODBUS_RBE_MAX_REGISTERS * 16U)
+
+/** Largest update: header and a full block */
+#define MODBUS_RBE_MAX_MESSAGE \
+    (MODBUS_RBE_HEADER_SIZE + (MODBUS_RBE_MAX_REGISTERS * 2U))
+
+_Static_assert(MODBUS_RBE_MAX_MESSAGE <= 1472U,
+               "an update must fit one datagram");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One subscription
+ */
+typedef struct
+{
+    bool       used;       /**< Entry holds a subscription */
+    ip_addr_t  addr;       /**< Client address */
+    u16_t      port;       /**< Client UDP port */
+    uint8_t    id;         /**< Subscription ID chosen by the client */
+    uint8_t    table;      /**< Modbus read function code */
+    uint16_t   start;      /**< First address */
+    uint16_t   quantity;   /**< Number of registers or bits */
+    uint16_t   deadband;   /**< Deadband in register units */
+    uint16_t   refresh_s;  /**< Refresh period */
+    uint16_t   holdoff_ms; /**< Shortest interval between two updates */
+    uint16_t   sequence;   /**< Sequence number of the last message */
+    TickType_t renewed;    /**< Last subscribe received */
+    TickType_t refreshed;  /**< Last refresh sent */
+    TickType_t sent;       /**< Last message sent */
+    uint16_t   reported[MODBUS_RBE_MAX_REGISTERS]; /**< Values last sent,
+                                                        bits packed */
+} modbus_rbe_sub_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task control block and stack */
+static StaticTask_t s_rbe_task_tcb;
+static StackType_t  s_rbe_task_stack[MODBUS_RBE_STACK_SIZE] BSP_SECTION_STACK;
+
+/** Register mutex owned by the Modbus TCP task */
+static SemaphoreHandle_t s_register_mutex;
+
+/** Connection and the buffer messages are sent from */
+static struct netconn *s_conn;
+static struct netbuf  *s_tx_buf;
+
+/** Subscriptions */
+static modbus_rbe_sub_t s_subs[MODBUS_RBE_MAX_SUBSCRIPTIONS];
+
+/** Values of the block being scanned, bits packed */
+static uint16_t s_values[MODBUS_RBE_MAX_REGISTERS];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Whether a table holds bits rather than registers
+ */
+static bool modbus_rbe_is_bits(uint8_t table)
+{
+    return (table == MODBUS_FC_READ_COILS) ||
+           (table == MODBUS_FC_READ_DISCRETE_INPUTS);
+}
+
+/**
+ * @brief One bit of a packed bit field
+ */
+static bool modbus_rbe_get_bit(const uint16_t *values, uint16_t index)
+{
+    const uint8_t *bits = (const uint8_t *)values;
+
+    return ((bits[index / 8U] >> (index % 8U)) & 1U) != 0U;
+}
+
+/**
+ * @brief Set one bit of a packed bit field
+ */
+static void modbus_rbe_set_bit(uint16_t *values, uint16_t index, bool value)
+{
+    uint8_t *bits = (uint8_t *)values;
+    uint8_t  mask = (uint8_t)(1U << (index % 8U));
+
+    if (value)
+    {
+        bits[index / 8U] |= mask;
+    }
+    else
+    {
+        bits[index / 8U] &= (uint8_t)~mask;
+    }
+}
+
+/**
+ * @brief Read a block through the Modbus read callbacks
+ *
+ * @param[in]  table    Modbus read function code
+ * @param[in]  start    First address
+ * @param[in]  quantity Number of registers or bits
+ * @param[out] values   Register values, or bits packed LSB first
+ * @return true if the whole block could be read
+ */
+static bool modbus_rbe_read(uint8_t table, uint16_t start, uint16_t quantity,
+                            uint16_t *values)
+{
+    modbus_exception_t ex;
+
+    (void)xSemaphoreTake(s_register_mutex, portMAX_DELAY);
+    switch (table)
+    {
+        case MODBUS_FC_READ_COILS:
+            ex = modbus_cb_read_coils(start, quantity, (uint8_t *)values);
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            ex = modbus_cb_read_discrete_inputs(start, quantity,
+                                                (uint8_t *)values);
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            ex = modbus_cb_read_holding_registers(start, quantity, values);
+            break;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            ex = modbus_cb_read_input_registers(start, quantity, values);
+            break;
+        default:
+            ex = MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+            break;
+    }
+    (void)xSemaphoreGive(s_register_mutex);
+
+    return ex == MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief Send a message of a subscription
+ *
+ * @param[in] sub    Subscription
+ * @param[in] type   MODBUS_RBE_MSG_*
+ * @param[in] offset Index of the first value in the block
+ * @param[in] count  Number of values, 0 for a bare header
+ * @param[in] values Values of the whole block, bits packed
+ */
+static void modbus_rbe_send(modbus_rbe_sub_t *sub, uint8_t type,
+                            uint16_t offset, uint16_t count,
+                            const uint16_t *values)
+{
+    uint16_t address = (uint16_t)(sub->start + offset);
+    uint32_t uptime  = (uint32_t)pdTICKS_TO_MS(xTaskGetTickCount());
+    uint16_t size;
+    uint8_t *msg;
+
+    if (modbus_rbe_is_bits(sub->table))
+    {
+        size = (uint16_t)((count + 7U) / 8U);
+    }
+    else
+    {
+        size = (uint16_t)(count * 2U);
+    }
+    size = (uint16_t)(size + MODBUS_RBE_HEADER_SIZE);
+
+    msg = (uint8_t *)netbuf_alloc(s_tx_buf, size);
+    if (msg == NULL)
+    {
+        return;
+    }
+
+    sub->sequence++;
+    (void)memset(msg, 0, size);
+    msg[0]  = (uint8_t)MODBUS_RBE_MAGIC;
+    msg[1]  = (uint8_t)(MODBUS_RBE_MAGIC >> 8);
+    msg[2]  = MODBUS_RBE_VERSION;
+    msg[3]  = type;
+    msg[4]  = sub->id;
+    msg[5]  = sub->table;
+    msg[6]  = (uint8_t)address;
+    msg[7]  = (uint8_t)(address >> 8);
+    msg[8]  = (uint8_t)count;
+    msg[9]  = (uint8_t)(count >> 8);
+    msg[10] = (uint8_t)sub->sequence;
+    msg[11] = (uint8_t)(sub->sequence >> 8);
+    msg[12] = (uint8_t)uptime;
+    msg[13] = (uint8_t)(uptime >> 8);
+    msg[14] = (uint8_t)(uptime >> 16);
+    msg[15] = (uint8_t)(uptime >> 24);
+
+    for (uint16_t i = 0U; i < count; i++)
+    {
+        uint8_t *value = &msg[MODBUS_RBE_HEADER_SIZE];
+
+        if (modbus_rbe_is_bits(sub->table))
+        {
+            if (modbus_rbe_get_bit(values, (uint16_t)(offset + i)))
+            {
+                value[i / 8U] |= (uint8_t)(1U << (i % 8U));
+            }
+        }
+        else
+        {
+            value[2U * i]      = (uint8_t)values[offset + i];
+            value[2U * i + 1U] = (uint8_t)(values[offset + i] >> 8);
+        }
+    }
+
+    (void)netconn_sendto(s_conn, s_tx_buf, &sub->addr, sub->port);
+    netbuf_free(s_tx_buf);
+    sub->sent = xTaskGetTickCount();
+}
+
+/**
+ * @brief Whether a value moved beyond the deadband since it was reported
+ */
+static bool modbus_rbe_changed(const modbus_rbe_sub_t *sub,
+                               const uint16_t *values, uint16_t index)
+{
+    if (modbus_rbe_is_bits(sub->table))
+    {
+        return modbus_rbe_get_bit(values, index) !=
+               modbus_rbe_get_bit(sub->reported, index);
+    }
+
+    if (values[index] > sub->reported[index])
+    {
+        return (uint16_t)(values[index] - sub->reported[index]) >
+               sub->deadband;
+    }
+
+    return (uint16_t)(sub->reported[index] - values[index]) > sub->deadband;
+}
+
+/**
+ * @brief Take values of the block as reported
+ */
+static void modbus_rbe_mark_reported(modbus_rbe_sub_t *sub,
+                                     const uint16_t *values, uint16_t offset,
+                                     uint16_t count)
+{
+    for (uint16_t i = offset; i < (uint16_t)(offset + count); i++)
+    {
+        if (modbus_rbe_is_bits(sub->table))
+        {
+            modbus_rbe_set_bit(sub->reported, i,
+                               modbus_rbe_get_bit(values, i));
+        }
+        else
+        {
+            sub->reported[i] = values[i];
+        }
+    }
+}
+
+/**
+ * @brief Send the whole block of a subscription
+ */
+static void modbus_rbe_refresh(modbus_rbe_sub_t *sub, const uint16_t *values)
+{
+    modbus_rbe_mark_reported(sub, values, 0U, sub->quantity);
+    modbus_rbe_send(sub, MODBUS_RBE_MSG_REFRESH, 0U, sub->quantity, values);
+    sub->refreshed = sub->sent;
+}
+
+/**
+ * @brief Scan the block of a subscription and report what changed
+ */
+static void modbus_rbe_scan(modbus_rbe_sub_t *sub, TickType_t now)
+{
+    TickType_t refresh = pdMS_TO_TICKS((uint32_t)sub->refresh_s * 1000U);
+    uint16_t   first   = sub->quantity;
+    uint16_t   last    = 0U;
+
+    if ((now - sub->renewed) > (refresh * MODBUS_RBE_LEASE_PERIODS))
+    {
+        /* The client stopped renewing it */
+        LOG("Modbus RBE: subscription %u expired\n", (unsigned int)sub->id);
+        sub->used = false;
+        return;
+    }
+
+    if (!modbus_rbe_read(sub->table, sub->start, sub->quantity, s_values))
+    {
+        return;
+    }
+
+    if ((now - sub->refreshed) >= refresh)
+    {
+        modbus_rbe_refresh(sub, s_values);
+        return;
+    }
+
+    if ((now - sub->sent) < pdMS_TO_TICKS(sub->holdoff_ms))
+    {
+        /* Changes wait, still measured against the values reported */
+        return;
+    }
+
+    for (uint16_t i = 0U; i < sub->quantity; i++)
+    {
+        if (modbus_rbe_changed(sub, s_values, i))
+        {
+            if (first == sub->quantity)
+            {
+                first = i;
+            }
+            last = i;
+        }
+    }
+
+    if (first < sub->quantity)
+    {
+        uint16_t count = (uint16_t)(last - first + 1U);
+
+        modbus_rbe_mark_reported(sub, s_values, first, count);
+        modbus_rbe_send(sub, MODBUS_RBE_MSG_CHANGE, first, count, s_values);
+    }
+}
+
+/**
+ * @brief Subscription of a client with the given ID
+ * @return The subscription, or NULL if there is none
+ */
+static modbus_rbe_sub_t *modbus_rbe_find(const ip_addr_t *addr, u16_t port,
+                                         uint8_t id)
+{
+    for (uint32_t i = 0U; i < MODBUS_RBE_MAX_SUBSCRIPTIONS; i++)
+    {
+        modbus_rbe_sub_t *sub = &s_subs[i];
+
+        if (sub->used && (sub->id == id) && (sub->port == port) &&
+            ip_addr_cmp(&sub->addr, addr))
+        {
+            return sub;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Handle a subscribe or unsubscribe message
+ */
+static void modbus_rbe_handle_request(const uint8_t *msg, uint16_t len,
+                                      const ip_addr_t *addr, u16_t port)
+{
+    modbus_rbe_sub_t  request;
+    modbus_rbe_sub_t *sub;
+    uint16_t          max_quantity;
+
+    if ((len < MODBUS_RBE_REQUEST_SIZE) ||
+        ((msg[0] | ((uint16_t)msg[1] << 8)) != MODBUS_RBE_MAGIC) ||
+        (msg[2] != MODBUS_RBE_VERSION))
+    {
+        return;
+    }
+
+    sub = modbus_rbe_find(addr, port, msg[4]);
+    if (msg[3] == MODBUS_RBE_MSG_UNSUBSCRIBE)
+    {
+        if (sub != NULL)
+        {
+            sub->used = false;
+        }
+        return;
+    }
+    if (msg[3] != MODBUS_RBE_MSG_SUBSCRIBE)
+    {
+        return;
+    }
+
+    (void)memset(&request, 0, sizeof(request));
+    request.used       = true;
+    request.addr       = *addr;
+    request.port       = port;
+    request.id         = msg[4];
+    request.table      = msg[5];
+    request.start      = (uint16_t)(msg[6] | ((uint16_t)msg[7] << 8));
+    request.quantity   = (uint16_t)(msg[8] | ((uint16_t)msg[9] << 8));
+    request.deadband   = (uint16_t)(msg[10] | ((uint16_t)msg[11] << 8));
+    request.refresh_s  = (uint16_t)(msg[12] | ((uint16_t)msg[13] << 8));
+    request.holdoff_ms = (uint16_t)(msg[14] | ((uint16_t)msg[15] << 8));
+    request.renewed    = xTaskGetTickCount();
+    if (request.refresh_s == 0U)
+    {
+        request.refresh_s = MODBUS_RBE_DEFAULT_REFRESH_S;
+    }
+
+    /* The same subscribe again only renews the lease */
+    if ((sub != NULL) && (sub->table == request.table) &&
+        (sub->start == request.start) &&
+        (sub->quantity == request.quantity) &&
+        (sub->deadband == request.deadband) &&
+        (sub->refresh_s == request.refresh_s) &&
+        (sub->holdoff_ms == request.holdoff_ms))
+    {
+        sub->renewed = request.renewed;
+        return;
+    }
+
+    for (uint32_t i = 0U; (sub == NULL) && (i < MODBUS_RBE_MAX_SUBSCRIPTIONS);
+         i++)
+    {
+        if (!s_subs[i].used)
+        {
+            sub = &s_subs[i];
+        }
+    }
+
+    max_quantity = modbus_rbe_is_bits(request.table) ? MODBUS_RBE_MAX_BITS
+                                                     : MODBUS_RBE_MAX_REGISTERS;
+    if ((sub == NULL) || (request.quantity == 0U) ||
+        (request.quantity > max_quantity) ||
+        !modbus_rbe_read(request.table, request.start, request.quantity,
+                         s_values))
+    {
+        LOG("Modbus RBE: subscription %u rejected\n", (unsigned int)msg[4]);
+        if (sub != NULL)
+        {
+            sub->used = false;
+        }
+        modbus_rbe_send(&request, MODBUS_RBE_MSG_REJECT, 0U, 0U, s_values);
+        return;
+    }
+
+    /* New or changed: answered with the whole block */
+    *sub = request;
+    modbus_rbe_refresh(sub, s_values);
+    LOG("Modbus RBE: subscription %u, table %u, %u values\n",
+        (unsigned int)sub->id, (unsigned int)sub->table,
+        (unsigned int)sub->quantity);
+}
+
+/**
+ * @brief Report by exception task
+ */
+static void modbus_rbe_task(void *arg)
+{
+    TickType_t     last_scan = xTaskGetTickCount();
+    struct netbuf *buf;
+    uint8_t        msg[MODBUS_RBE_REQUEST_SIZE];
+
+    (void)arg;
+
+    while (((s_conn = netconn_new(NETCONN_UDP)) == NULL) ||
+           ((s_tx_buf = netbuf_new()) == NULL))
+    {
+        printf("Modbus RBE: Failed to create UDP connection\n");
+        if (s_conn != NULL)
+        {
+            netconn_delete(s_conn);
+        }
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    if (netconn_bind(s_conn, IP_ADDR_ANY, MODBUS_RBE_PORT) != ERR_OK)
+    {
+        printf("Modbus RBE: Failed to bind port %u\n", MODBUS_RBE_PORT);
+    }
+    netconn_set_recvtimeout(s_conn, MODBUS_RBE_SCAN_MS);
+
+    /* Reports are control traffic */
+    LOCK_TCPIP_CORE();
+    s_conn->pcb.udp->tos = ETHERNETIF_TOS_CONTROL;
+    UNLOCK_TCPIP_CORE();
+
+    printf("Modbus RBE listening on port %u\n", MODBUS_RBE_PORT);
+
+    for (;;)
+    {
+        TickType_t now;
+
+        if (netconn_recv(s_conn, &buf) == ERR_OK)
+        {
+            uint16_t len = netbuf_copy(buf, msg, sizeof(msg));
+
+            modbus_rbe_handle_request(msg, len, netbuf_fromaddr(buf),
+                                      netbuf_fromport(buf));
+            netbuf_delete(buf);
+        }
+
+        now = xTaskGetTickCount();
+        if ((now - last_scan) >= pdMS_TO_TICKS(MODBUS_RBE_SCAN_MS))
+        {
+            last_scan = now;
+            for (uint32_t i = 0U; i < MODBUS_RBE_MAX_SUBSCRIPTIONS; i++)
+            {
+                if (s_subs[i].used)
+                {
+                    modbus_rbe_scan(&s_subs[i], now);
+                }
+            }
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_rbe_start(SemaphoreHandle_t register_mutex)
+{
+    s_register_mutex = register_mutex;
+
+    (void)xTaskCreateStatic(modbus_rbe_task, "ModbusRBE",
+                            MODBUS_RBE_STACK_SIZE, NULL, TASK_PRIO_MODBUS_RBE,
+                            s_rbe_task_stack, &s_rbe_task_tcb);
+}
+
+#endif /* MODBUS_RBE */
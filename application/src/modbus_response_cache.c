@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Response Cache
+ *
+ * A small fully associative cache of complete response frames. A hit is a
+ * key compare, one memcpy of the stored frame and a two-byte transaction ID
+ * patch; the register callbacks do not run. Ages are kept in RTOS ticks, so
+ * a freshness window shorter than one tick still lasts one tick.
+ *
+ * An entry keeps the data version taken at the lookup that missed, before
+ * the request was processed, so a change during processing makes the entry
+ * miss next time rather than serve the old data as new.
+ */
+
+#include "modbus_response_cache.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "modbus.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** MBAP header size; the function code follows it */
+#define CACHE_MBAP_SIZE 7U
+
+/** Length of an FC01-FC04 request: MBAP + FC + start + quantity */
+#define CACHE_READ_REQUEST_LEN (CACHE_MBAP_SIZE + 5U)
+
+/** Exception responses have this bit set in the function code */
+#define CACHE_EXCEPTION_FLAG 0x80U
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One cached response
+ */
+typedef struct
+{
+    bool       valid;
+    uint8_t    unit_id;
+    uint8_t    function_code;
+    uint16_t   start_address;
+    uint16_t   quantity;
+    uint16_t   length;    /**< Response frame length */
+    TickType_t stored_at; /**< Tick count when the response was built */
+    TickType_t lifetime;  /**< Freshness window in ticks */
+    uint32_t   version;   /**< Data version the response was built from */
+    uint8_t    frame[MODBUS_TCP_MAX_ADU_SIZE];
+} cache_entry_t;
+
+/**
+ * @brief Lookup key, decoded from a read request
+ */
+typedef struct
+{
+    uint8_t  unit_id;
+    uint8_t  function_code;
+    uint16_t start_address;
+    uint16_t quantity;
+} cache_key_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+static cache_entry_t                 s_entries[MODBUS_RESPONSE_CACHE_ENTRIES];
+static modbus_response_cache_stats_t s_stats;
+
+/** Key and data version of the last lookup, for the update that follows */
+static cache_key_t s_lookup_key;
+static uint32_t    s_lookup_version;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Decode the cache key of a request
+ *
+ * @return false if the request is not a cacheable read
+ */
+static bool cache_get_key(const uint8_t *request, uint16_t request_len,
+                          cache_key_t *key)
+{
+    uint8_t function_code;
+
+    if (request_len != CACHE_READ_REQUEST_LEN)
+    {
+        return false;
+    }
+
+    function_code = request[CACHE_MBAP_SIZE];
+    if ((function_code < MODBUS_FC_READ_COILS) ||
+        (function_code > MODBUS_FC_READ_INPUT_REGISTERS))
+    {
+        return false;
+    }
+
+    key->unit_id       = request[CACHE_MBAP_SIZE - 1U];
+    key->function_code = function_code;
+    key->start_address = (uint16_t)(((uint16_t)request[8] << 8U) | request[9]);
+    key->quantity = (uint16_t)(((uint16_t)request[10] << 8U) | request[11]);
+
+    return true;
+}
+
+/**
+ * @brief Compare two keys
+ */
+static bool cache_key_equal(const cache_key_t *a, const cache_key_t *b)
+{
+    return (a->function_code == b->function_code) &&
+           (a->start_address == b->start_address) &&
+           (a->quantity == b->quantity) && (a->unit_id == b->unit_id);
+}
+
+/**
+ * @brief Check whether an entry holds the response for a key
+ */
+static bool cache_entry_matches(const cache_entry_t *entry,
+                                const cache_key_t   *key)
+{
+    return entry->valid && (entry->function_code == key->function_code) &&
+           (entry->start_address == key->start_address) &&
+           (entry->quantity == key->quantity) &&
+           (entry->unit_id == key->unit_id);
+}
+
+/**
+ * @brief Check whether an entry is still within its freshness window
+ */
+static bool cache_entry_is_fresh(const cache_entry_t *entry, TickType_t now)
+{
+    return entry->valid && ((now - entry->stored_at) < entry->lifetime);
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_response_cache_init(void)
+{
+    (void)memset(s_entries, 0, sizeof(s_entries));
+    (void)memset(&s_stats, 0, sizeof(s_stats));
+}
+
+uint16_t modbus_response_cache_lookup(const uint8_t *request,
+                                      uint16_t       request_len,
+                                      uint8_t       *response,
+                                      uint16_t       response_size)
+{
+    cache_key_t key;
+    TickType_t  now = xTaskGetTickCount();
+
+    if (!cache_get_key(request, request_len, &key))
+    {
+        return 0U;
+    }
+
+    s_lookup_key     = key;
+    s_lookup_version = modbus_response_cache_version(
+        key.function_code, key.start_address, key.quantity);
+
+    for (uint32_t i = 0U; i < MODBUS_RESPONSE_CACHE_ENTRIES; i++)
+    {
+        const cache_entry_t *entry = &s_entries[i];
+
+        if (cache_entry_matches(entry, &key) &&
+            cache_entry_is_fresh(entry, now) &&
+            (entry->version == s_lookup_version) &&
+            (entry->length <= response_size))
+        {
+            (void)memcpy(response, entry->frame, entry->length);
+            response[0] = request[0];
+            response[1] = request[1];
+            s_stats.hits++;
+            return entry->length;
+        }
+    }
+
+    s_stats.misses++;
+    return 0U;
+}
+
+void modbus_response_cache_update(const uint8_t *request,
+                                  uint16_t       request_len,
+                                  const uint8_t *response,
+                                  uint16_t       response_len)
+{
+    cache_key_t    key;
+    cache_entry_t *slot = NULL;
+    uint32_t       ttl_ms;
+    TickType_t     now = xTaskGetTickCount();
+
+    /* Writes drop the cache in the write callbacks, whoever makes them */
+    if (!cache_get_key(request, request_len, &key))
+    {
+        return;
+    }
+
+    if ((response_len <= CACHE_MBAP_SIZE) ||
+        (response_len > MODBUS_TCP_MAX_ADU_SIZE) ||
+        ((response[CACHE_MBAP_SIZE] & CACHE_EXCEPTION_FLAG) != 0U))
+    {
+        return;
+    }
+
+    ttl_ms = modbus_response_cache_ttl_ms(key.function_code, key.start_address,
+                                          key.quantity);
+    if (ttl_ms == 0U)
+    {
+        return;
+    }
+
+    /* Same key, else a free or expired entry, else the oldest one */
+    for (uint32_t i = 0U; (i < MODBUS_RESPONSE_CACHE_ENTRIES) && (slot == NULL);
+         i++)
+    {
+        if (cache_entry_matches(&s_entries[i], &key))
+        {
+            slot = &s_entries[i];
+        }
+    }
+    for (uint32_t i = 0U; (i < MODBUS_RESPONSE_CACHE_ENTRIES) && (slot == NULL);
+         i++)
+    {
+        if (!cache_entry_is_fresh(&s_entries[i], now))
+        {
+            slot = &s_entries[i];
+        }
+    }
+    if (slot == NULL)
+    {
+        slot = &s_entries[0];
+        for (uint32_t i = 1U; i < MODBUS_RESPONSE_CACHE_ENTRIES; i++)
+        {
+            if ((now - s_entries[i].stored_at) > (now - slot->stored_at))
+            {
+                slot = &s_entries[i];
+            }
+        }
+    }
+
+    slot->valid         = true;
+    slot->unit_id       = key.unit_id;
+    slot->function_code = key.function_code;
+    slot->start_address = key.start_address;
+    slot->quantity      = key.quantity;
+    slot->length        = response_len;
+    slot->stored_at     = now;
+    slot->lifetime      = pdMS_TO_TICKS(ttl_ms);
+    slot->version       = cache_key_equal(&key, &s_lookup_key)
+                              ? s_lookup_version
+                              : modbus_response_cache_version(
+                                    key.function_code, key.start_address,
+                                    key.quantity);
+    if (slot->lifetime == 0U)
+    {
+        slot->lifetime = 1U;
+    }
+    (void)memcpy(slot->frame, response, response_len);
+}
+
+void modbus_response_cache_invalidate(void)
+{
+    for (uint32_t i = 0U; i < MODBUS_RESPONSE_CACHE_ENTRIES; i++)
+    {
+        s_entries[i].valid = false;
+    }
+    s_stats.invalidations++;
+}
+
+void modbus_response_cache_get_stats(modbus_response_cache_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        *stats = s_stats;
+    }
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus RTU Serial Transport Task
+ *
+ * The RS-485 port receives by circular DMA and ends a frame with the USART
+ * receiver timeout set to t3.5, so there is one interrupt and one task
+ * wake-up per frame whatever its length. The task has its own slave context
+ * and takes the register mutex shared with the Modbus TCP workers around
+ * each dispatch.
+ *
+ * A frame is only delivered t3.5 after its last character, so the response
+ * DMA is started as soon as the response is built, with no further wait;
+ * the USART drives DE for the transmission on its own.
+ */
+
+#include "modbus_rtu_task.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bsp.h"
+#include "bsp_sections.h"
+#include "jerry_device_registers.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "modbus_diag.h"
+#include "modbus_files.h"
+#include "modbus_internal.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the RTU task (words) */
+#define MODBUS_RTU_STACK_SIZE 384U
+
+/** Priority of the RTU task, above the network for the RS-485 turnaround */
+#define MODBUS_RTU_PRIORITY TASK_PRIO_RS485
+
+/** Frame wait period; the task only loops, nothing is polled */
+#define MODBUS_RTU_READ_TIMEOUT_MS 1000U
+
+/** Transmit timeout, above a 256-byte frame at 9600 baud (293 ms) */
+#define MODBUS_RTU_TX_TIMEOUT_MS 500U
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** RTU task control block and stack */
+static StaticTask_t s_rtu_task_tcb;
+static StackType_t  s_rtu_task_stack[MODBUS_RTU_STACK_SIZE] BSP_SECTION_STACK;
+
+/** Register mutex owned by the Modbus TCP task */
+static SemaphoreHandle_t s_register_mutex;
+
+/** Slave address */
+static uint8_t s_unit_id;
+
+/** Slave context of the RTU transport (RTU task only) */
+static modbus_context_storage_t s_rtu_ctx_storage;
+static modbus_context_t *const  s_rtu_ctx =
+    (modbus_context_t *)&s_rtu_ctx_storage;
+
+/** Frame buffers; requests are decoded and responses built in place */
+static uint8_t s_rx_frame[MODBUS_RTU_MAX_ADU_SIZE];
+static uint8_t s_tx_frame[MODBUS_RTU_MAX_ADU_SIZE];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Process one received frame and transmit its response
+ *
+ * Frames with a bad CRC or for another slave are dropped silently, as the
+ * RTU specification requires.
+ *
+ * @param[in] length Frame length in s_rx_frame
+ */
+static void modbus_rtu_handle_frame(uint16_t length)
+{
+    modbus_pdu_view_t   request;
+    modbus_pdu_buffer_t response;
+    uint8_t             unit_id;
+    uint16_t            tx_length = 0U;
+    modbus_error_t      err;
+
+#if MODBUS_ENABLE_LATENCY_STATS
+    modbus_slave_mark_frame_start(s_rtu_ctx);
+#endif
+
+    if (modbus_rtu_parse_frame_view(s_rx_frame, length, &unit_id,
+                                    &request) != MODBUS_OK)
+    {
+        /* Short frame or CRC error */
+        metrics_add(METRIC_MODBUS_RTU_ERR, 1U);
+        return;
+    }
+
+    if (!modbus_rtu_address_match(unit_id, s_unit_id))
+    {
+        return;
+    }
+
+    /* The response PDU is written straight behind the address byte */
+    (void)modbus_pdu_buffer_from_frame(
+        &s_tx_frame[MODBUS_RTU_PDU_OFFSET],
+        (uint16_t)(sizeof(s_tx_frame) - MODBUS_RTU_PDU_OFFSET), &response);
+
+    (void)xSemaphoreTake(s_register_mutex, portMAX_DELAY);
+    err = modbus_slave_process_pdu_buffer(s_rtu_ctx, &request, &response);
+    (void)xSemaphoreGive(s_register_mutex);
+
+    if (err != MODBUS_OK)
+    {
+        metrics_add(METRIC_MODBUS_RTU_ERR, 1U);
+        return;
+    }
+
+    if (modbus_rtu_is_broadcast(unit_id))
+    {
+        return;
+    }
+
+    if ((modbus_rtu_build_frame_in_place(
+             s_unit_id, s_tx_frame, (uint16_t)(1U + response.data_length),
+             sizeof(s_tx_frame), &tx_length) != MODBUS_OK) ||
+        (BSP_RS485_Transmit(s_tx_frame, tx_length, MODBUS_RTU_TX_TIMEOUT_MS) !=
+         BSP_OK))
+    {
+        metrics_add(METRIC_MODBUS_RTU_ERR, 1U);
+    }
+}
+
+/**
+ * @brief Modbus RTU task
+ */
+static void modbus_rtu_task(void *arg)
+{
+    bsp_rs485_config_t port_config;
+    modbus_config_t    modbus_config;
+    uint16_t           length;
+
+    (void)arg;
+
+    (void)memset(&modbus_config, 0, sizeof(modbus_config));
+    modbus_config.mode     = MODBUS_MODE_SLAVE;
+    modbus_config.protocol = MODBUS_PROTOCOL_RTU;
+    modbus_config.unit_id  = s_unit_id;
+    (void)modbus_init(s_rtu_ctx, &modbus_config);
+    (void)modbus_slave_set_device_id(s_rtu_ctx, &jerry_device_device_id);
+    (void)modbus_slave_set_file_reader(s_rtu_ctx, modbus_files_read_record);
+    (void)modbus_slave_set_file_mapper(s_rtu_ctx, modbus_files_map_record);
+    (void)modbus_slave_set_file_writer(s_rtu_ctx, modbus_files_write_record);
+#if MODBUS_ENABLE_LATENCY_STATS
+    (void)modbus_slave_set_latency_stats(
+        s_rtu_ctx, modbus_diag_latency_stats(MODBUS_DIAG_TRANSPORT_RTU));
+#endif
+
+    port_config.baudrate = MODBUS_RTU_BAUDRATE;
+    port_config.parity   = MODBUS_RTU_PARITY;
+    port_config.frame_timeout_us =
+        modbus_rtu_get_interframe_delay_us(MODBUS_RTU_BAUDRATE);
+
+    if (BSP_RS485_Init(&port_config) != BSP_OK)
+    {
+        printf("Modbus RTU: RS-485 port init failed\n");
+        vTaskDelete(NULL);
+    }
+
+    printf("Modbus RTU: %u baud, unit ID %u, t3.5 = %u us\n",
+           (unsigned int)port_config.baudrate, (unsigned int)s_unit_id,
+           (unsigned int)port_config.frame_timeout_us);
+
+    for (;;)
+    {
+        if (BSP_RS485_ReadFrame(s_rx_frame, sizeof(s_rx_frame), &length,
+                                MODBUS_RTU_READ_TIMEOUT_MS) == BSP_OK)
+        {
+            modbus_rtu_handle_frame(length);
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_rtu_task_start(SemaphoreHandle_t register_mutex, uint8_t unit_id)
+{
+    s_register_mutex = register_mutex;
+    s_unit_id        = unit_id;
+
+    (void)xTaskCreateStatic(modbus_rtu_task, "ModbusRTU",
+                            MODBUS_RTU_STACK_SIZE, NULL, MODBUS_RTU_PRIORITY,
+                            s_rtu_task_stack, &s_rtu_task_tcb);
+}
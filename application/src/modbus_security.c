@@ -0,0 +1,666 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus/TCP Security Task
+ *
+ * A single task accepts a connection, runs the TLS handshake and then
+ * serves MBAP frames from the decrypted stream the way the port 502
+ * workers do: every frame of a record is processed, and all responses of
+ * one receive go out in one record. The task has its own slave context and
+ * takes the register mutex shared with the other transports around each
+ * dispatch. Mbed TLS reads and writes the connection through netconn
+ * callbacks, so it sees lwIP's pbufs without a socket layer.
+ */
+
+#include "modbus_security.h"
+
+#if MODBUS_SECURITY
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bsp_sections.h"
+#include "ethernetif.h"
+#include "jerry_device_registers.h"
+#include "log.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "lwip/netbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls_port.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "modbus_files.h"
+#include "modbus_internal.h"
+#include "modbus_tls_credentials.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the task (words); the ECC of a full handshake is deep */
+#define MODBUS_SECURITY_STACK_SIZE 1536U
+
+/** Priority of the task, that of the port 502 workers */
+#define MODBUS_SECURITY_PRIORITY TASK_PRIO_MODBUS_TCP
+
+/** netconn_recv() poll period */
+#define MODBUS_SECURITY_RECV_POLL_MS 250U
+
+/** A partial frame is dropped after this long without data */
+#define MODBUS_SECURITY_RECV_TIMEOUT_MS 5000U
+
+/** Connections without a request for this long are closed */
+#define MODBUS_SECURITY_IDLE_TIMEOUT_MS 60000U
+
+/** Longest time a handshake may take, full or resumed */
+#define MODBUS_SECURITY_HANDSHAKE_TIMEOUT_MS 10000U
+
+/** Maximum-size responses batched into one record */
+#define MODBUS_SECURITY_PIPELINE_DEPTH 4U
+
+/** MBAP header size; the function code follows it */
+#define MODBUS_SECURITY_MBAP_SIZE 7U
+
+_Static_assert((MODBUS_SECURITY_PIPELINE_DEPTH * MODBUS_TCP_MAX_ADU_SIZE) <=
+                   MBEDTLS_SSL_OUT_CONTENT_LEN,
+               "a batch of responses must fit one record");
+
+/* ==========================================================================
+ * Credentials
+ * ========================================================================== */
+
+/*
+ * Masters must present a certificate issued by the CA; the device
+ * certificate and its key identify Jerry to them. All three come from the
+ * files given at configure time (JERRY_MODBUS_TLS_CA, _CERT and _KEY,
+ * application/dependencies/mbedtls/CMakeLists.txt); the default is the
+ * development set of tools/keys, generated per checkout and never
+ * committed, which release builds refuse.
+ */
+
+/** CA that issues master certificates */
+static const char s_ca_cert[] = MODBUS_TLS_CA_CERT_PEM;
+
+/** Device certificate, issued by the same CA */
+static const char s_device_cert[] = MODBUS_TLS_DEVICE_CERT_PEM;
+
+/** Private key of the device certificate */
+static const char s_device_key[] = MODBUS_TLS_DEVICE_KEY_PEM;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task control block and stack */
+static StaticTask_t s_security_task_tcb;
+static StackType_t  s_security_task_stack[MODBUS_SECURITY_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** Register mutex owned by the Modbus TCP task */
+static SemaphoreHandle_t s_register_mutex;
+
+/** Modbus unit ID */
+static uint8_t s_unit_id;
+
+/** Slave context of the secure transport (this task only) */
+static modbus_context_storage_t s_security_ctx_storage;
+static modbus_context_t *const  s_security_ctx =
+    (modbus_context_t *)&s_security_ctx_storage;
+
+/** TLS state; the session cache and ticket key outlive connections */
+static mbedtls_entropy_context  s_entropy;
+static mbedtls_ctr_drbg_context s_drbg;
+static mbedtls_x509_crt         s_ca;
+static mbedtls_x509_crt         s_cert;
+static mbedtls_pk_context       s_key;
+static mbedtls_ssl_config       s_conf;
+static mbedtls_ssl_cache_context  s_cache;
+static mbedtls_ssl_ticket_context s_ticket;
+static mbedtls_ssl_context        s_ssl;
+
+/** Connection being served */
+static struct netconn *s_conn;
+
+/** Received netbuf not yet read by Mbed TLS, and how much of it was */
+static struct netbuf *s_rx_netbuf;
+static u16_t          s_rx_offset;
+
+/** Decrypted stream; frames split across records are reassembled */
+static modbus_tcp_rx_context_t s_rx;
+static uint8_t s_rx_plain[MODBUS_SECURITY_PIPELINE_DEPTH *
+                          MODBUS_TCP_MAX_ADU_SIZE];
+
+/** Responses of the current receive, sent as one record */
+static uint8_t  s_tx_buffer[MODBUS_SECURITY_PIPELINE_DEPTH *
+                           MODBUS_TCP_MAX_ADU_SIZE];
+static uint16_t s_tx_length;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Mbed TLS send callback
+ */
+static int modbus_security_send(void *ctx, const unsigned char *buf,
+                                size_t len)
+{
+    (void)ctx;
+
+    if (netconn_write(s_conn, buf, len, NETCONN_COPY) != ERR_OK)
+    {
+        return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+    }
+
+    return (int)len;
+}
+
+/**
+ * @brief Mbed TLS receive callback
+ *
+ * Hands out a received netbuf piecewise, as Mbed TLS reads a record
+ * header before its body. A poll period without data is reported as
+ * MBEDTLS_ERR_SSL_WANT_READ, so the caller can check its timeouts and
+ * call again.
+ */
+static int modbus_security_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    u16_t copied;
+    err_t err;
+
+    (void)ctx;
+
+    if (s_rx_netbuf == NULL)
+    {
+        err = netconn_recv(s_conn, &s_rx_netbuf);
+        if (err == ERR_TIMEOUT)
+        {
+            return MBEDTLS_ERR_SSL_WANT_READ;
+        }
+        if (err != ERR_OK)
+        {
+            /* Closed or reset: end of stream */
+            s_rx_netbuf = NULL;
+            return 0;
+        }
+        s_rx_offset = 0U;
+    }
+
+    if (len > 0xFFFFU)
+    {
+        len = 0xFFFFU;
+    }
+    copied = netbuf_copy_partial(s_rx_netbuf, buf, (u16_t)len, s_rx_offset);
+    s_rx_offset = (u16_t)(s_rx_offset + copied);
+
+    if (s_rx_offset >= netbuf_len(s_rx_netbuf))
+    {
+        netbuf_delete(s_rx_netbuf);
+        s_rx_netbuf = NULL;
+    }
+
+    return (int)copied;
+}
+
+/**
+ * @brief Load the credentials and set up the TLS configuration
+ * @return true on success
+ */
+static bool modbus_security_setup(void)
+{
+    static const char personalization[] = "jerry-modbus-security";
+    int               ret;
+
+    mbedtls_port_init();
+
+    mbedtls_entropy_init(&s_entropy);
+    mbedtls_ctr_drbg_init(&s_drbg);
+    mbedtls_x509_crt_init(&s_ca);
+    mbedtls_x509_crt_init(&s_cert);
+    mbedtls_pk_init(&s_key);
+    mbedtls_ssl_config_init(&s_conf);
+    mbedtls_ssl_cache_init(&s_cache);
+    mbedtls_ssl_ticket_init(&s_ticket);
+    mbedtls_ssl_init(&s_ssl);
+
+    /* The PEM sizes include the terminating NUL, as the parsers expect */
+    ret = mbedtls_ctr_drbg_seed(&s_drbg, mbedtls_entropy_func, &s_entropy,
+                                (const unsigned char *)personalization,
+                                sizeof(personalization) - 1U);
+    if (ret == 0)
+    {
+        ret = mbedtls_x509_crt_parse(&s_ca, (const unsigned char *)s_ca_cert,
+                                     sizeof(s_ca_cert));
+    }
+    if (ret == 0)
+    {
+        ret = mbedtls_x509_crt_parse(&s_cert,
+                                     (const unsigned char *)s_device_cert,
+                                     sizeof(s_device_cert));
+    }
+    if (ret == 0)
+    {
+        ret = mbedtls_pk_parse_key(&s_key, (const unsigned char *)s_device_key,
+                                   sizeof(s_device_key), NULL, 0U,
+                                   mbedtls_ctr_drbg_random, &s_drbg);
+    }
+    if (ret == 0)
+    {
+        ret = mbedtls_ssl_config_defaults(&s_conf, MBEDTLS_SSL_IS_SERVER,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+    if (ret == 0)
+    {
+        mbedtls_ssl_conf_rng(&s_conf, mbedtls_ctr_drbg_random, &s_drbg);
+        mbedtls_ssl_conf_min_tls_version(&s_conf, MBEDTLS_SSL_VERSION_TLS1_2);
+        mbedtls_ssl_conf_authmode(&s_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_ca_chain(&s_conf, &s_ca, NULL);
+        ret = mbedtls_ssl_conf_own_cert(&s_conf, &s_cert, &s_key);
+    }
+    if (ret == 0)
+    {
+        /* Resumption by session ID ... */
+        mbedtls_ssl_cache_set_timeout(&s_cache,
+                                      MODBUS_SECURITY_TICKET_LIFETIME_S);
+        mbedtls_ssl_conf_session_cache(&s_conf, &s_cache, mbedtls_ssl_cache_get,
+                                       mbedtls_ssl_cache_set);
+
+        /* ... and by ticket, which keeps no state on the device */
+        ret = mbedtls_ssl_ticket_setup(&s_ticket, mbedtls_ctr_drbg_random,
+                                       &s_drbg, MBEDTLS_CIPHER_AES_128_GCM,
+                                       MODBUS_SECURITY_TICKET_LIFETIME_S);
+    }
+    if (ret == 0)
+    {
+        mbedtls_ssl_conf_session_tickets_cb(&s_conf, mbedtls_ssl_ticket_write,
+                                            mbedtls_ssl_ticket_parse,
+                                            &s_ticket);
+        ret = mbedtls_ssl_setup(&s_ssl, &s_conf);
+    }
+    if (ret == 0)
+    {
+        mbedtls_ssl_set_bio(&s_ssl, NULL, modbus_security_send,
+                            modbus_security_recv, NULL);
+    }
+    else
+    {
+        printf("Modbus Security: TLS setup failed: -0x%04X\n",
+               (unsigned int)-ret);
+    }
+
+    return ret == 0;
+}
+
+/**
+ * @brief Process a Modbus request and build its response in place
+ *
+ * As the port 502 server does, the response PDU is written straight into
+ * the TX buffer behind the space of the MBAP header.
+ */
+static modbus_error_t modbus_security_process_request(const uint8_t *request,
+                                                      uint16_t request_len,
+                                                      uint8_t *response,
+                                                      uint16_t response_size,
+                                                      uint16_t *response_len)
+{
+    modbus_pdu_view_t   request_pdu;
+    modbus_pdu_buffer_t response_pdu;
+    uint16_t            transaction_id;
+    uint8_t             unit_id;
+    modbus_error_t      err;
+
+    err = modbus_tcp_parse_frame_view(request, request_len, &transaction_id,
+                                      &unit_id, &request_pdu);
+    if (err != MODBUS_OK)
+    {
+        return err;
+    }
+
+    /* Check unit ID (0 = broadcast, or match our ID) */
+    if ((unit_id != 0U) && (unit_id != s_unit_id))
+    {
+        return MODBUS_ERROR_INVALID_PARAM;
+    }
+
+    if (response_size <= MODBUS_TCP_PDU_OFFSET)
+    {
+        return MODBUS_ERROR_BUFFER_OVERFLOW;
+    }
+
+    (void)modbus_pdu_buffer_from_frame(
+        &response[MODBUS_TCP_PDU_OFFSET],
+        (uint16_t)(response_size - MODBUS_TCP_PDU_OFFSET), &response_pdu);
+
+    (void)xSemaphoreTake(s_register_mutex, portMAX_DELAY);
+    err = modbus_slave_process_pdu_buffer(s_security_ctx, &request_pdu,
+                                          &response_pdu);
+    (void)xSemaphoreGive(s_register_mutex);
+
+    if (err != MODBUS_OK)
+    {
+        return err;
+    }
+
+    return modbus_tcp_build_frame_in_place(
+        transaction_id, s_unit_id, response,
+        (uint16_t)(1U + response_pdu.data_length), response_size,
+        response_len);
+}
+
+/**
+ * @brief Send the queued responses as one record
+ * @return false if the connection failed
+ */
+static bool modbus_security_flush(void)
+{
+    uint16_t sent = 0U;
+    int      ret;
+
+    while (sent < s_tx_length)
+    {
+        ret = mbedtls_ssl_write(&s_ssl, &s_tx_buffer[sent],
+                                (size_t)(s_tx_length - sent));
+        if (ret > 0)
+        {
+            sent = (uint16_t)(sent + (uint16_t)ret);
+        }
+        else if ((ret != MBEDTLS_ERR_SSL_WANT_READ) &&
+                 (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+        {
+            LOG("Modbus Security: Write error: -0x%04X\n", (unsigned int)-ret);
+            s_tx_length = 0U;
+            return false;
+        }
+        else
+        {
+            /* Blocking connection - try again */
+        }
+    }
+    s_tx_length = 0U;
+
+    return true;
+}
+
+/**
+ * @brief Process one complete MBAP frame and queue its response
+ */
+static void modbus_security_handle_frame(const uint8_t *frame,
+                                         uint16_t       frame_len)
+{
+    uint16_t       response_len = 0U;
+    uint16_t       response_max = MODBUS_TCP_MAX_ADU_SIZE;
+    modbus_error_t err;
+
+    /* Only reserve as much TX space as this function code can answer with */
+    if (frame_len > MODBUS_SECURITY_MBAP_SIZE)
+    {
+        response_max = (uint16_t)(MODBUS_SECURITY_MBAP_SIZE +
+                                  modbus_slave_get_response_bound(
+                                      s_security_ctx,
+                                      frame[MODBUS_SECURITY_MBAP_SIZE]));
+    }
+    if ((sizeof(s_tx_buffer) - s_tx_length) < response_max)
+    {
+        (void)modbus_security_flush();
+    }
+
+    err = modbus_security_process_request(
+        frame, frame_len, &s_tx_buffer[s_tx_length],
+        (uint16_t)(sizeof(s_tx_buffer) - s_tx_length), &response_len);
+    if (err == MODBUS_OK)
+    {
+        s_tx_length = (uint16_t)(s_tx_length + response_len);
+    }
+    else
+    {
+        LOG("Modbus Security: Process error: %d\n", (int)err);
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+    }
+}
+
+/**
+ * @brief Feed decrypted bytes through the frame receiver
+ * @return false if the stream is corrupt and the connection must be closed
+ */
+static bool modbus_security_process_stream(const uint8_t *data,
+                                           uint16_t       length)
+{
+    uint16_t offset = 0U;
+
+    while (offset < length)
+    {
+        uint16_t remaining = (uint16_t)(length - offset);
+        uint16_t frame_len = 0U;
+
+        if (s_rx.index == 0U)
+        {
+            frame_len = modbus_tcp_get_frame_length(&data[offset], remaining);
+        }
+
+        if (frame_len > 0U)
+        {
+            /* Whole frame in this record - decoded where it lies */
+            modbus_security_handle_frame(&data[offset], frame_len);
+            offset = (uint16_t)(offset + frame_len);
+        }
+        else
+        {
+            uint16_t       consumed = 0U;
+            const uint8_t *frame;
+            modbus_error_t err     = modbus_tcp_rx_process_data(
+                &s_rx, &data[offset], remaining, (uint32_t)xTaskGetTickCount(),
+                &consumed);
+
+            offset = (uint16_t)(offset + consumed);
+            if (err != MODBUS_OK)
+            {
+                LOG("Modbus Security: Stream framing error: %d\n", (int)err);
+                metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+                return false;
+            }
+            if (modbus_tcp_rx_is_complete(&s_rx))
+            {
+                (void)modbus_tcp_rx_get_frame(&s_rx, &frame, &frame_len);
+                modbus_security_handle_frame(frame, frame_len);
+                modbus_tcp_rx_reset(&s_rx);
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Run the handshake of a new connection
+ * @return true once the connection is secured
+ */
+static bool modbus_security_handshake(void)
+{
+    TickType_t start = xTaskGetTickCount();
+    int        ret;
+
+    while ((ret = mbedtls_ssl_handshake(&s_ssl)) != 0)
+    {
+        if ((ret != MBEDTLS_ERR_SSL_WANT_READ) &&
+            (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+        {
+            LOG("Modbus Security: Handshake failed: -0x%04X\n",
+                (unsigned int)-ret);
+            return false;
+        }
+        if ((xTaskGetTickCount() - start) >=
+            pdMS_TO_TICKS(MODBUS_SECURITY_HANDSHAKE_TIMEOUT_MS))
+        {
+            LOG("Modbus Security: Handshake timeout\n");
+            return false;
+        }
+    }
+
+    /* A resumed session takes milliseconds, a full handshake much longer */
+    LOG("Modbus Security: %s secured in %lu ms\n",
+        mbedtls_ssl_get_ciphersuite(&s_ssl),
+        (unsigned long)pdTICKS_TO_MS(xTaskGetTickCount() - start));
+
+    return true;
+}
+
+/**
+ * @brief Serve a secured connection until it ends
+ */
+static void modbus_security_serve(void)
+{
+    TickType_t last_activity = xTaskGetTickCount();
+    bool       stream_ok     = true;
+    int        ret;
+
+    (void)modbus_tcp_rx_init(&s_rx, MODBUS_SECURITY_RECV_TIMEOUT_MS);
+    s_tx_length = 0U;
+
+    while (stream_ok)
+    {
+        ret = mbedtls_ssl_read(&s_ssl, s_rx_plain, sizeof(s_rx_plain));
+        if (ret > 0)
+        {
+            last_activity = xTaskGetTickCount();
+            stream_ok =
+                modbus_security_process_stream(s_rx_plain, (uint16_t)ret);
+
+            /* Pipelined requests already decrypted join this batch */
+            if (stream_ok && (mbedtls_ssl_get_bytes_avail(&s_ssl) == 0U))
+            {
+                stream_ok = modbus_security_flush();
+            }
+        }
+        else if (ret == MBEDTLS_ERR_SSL_WANT_READ)
+        {
+            TickType_t idle = xTaskGetTickCount() - last_activity;
+
+            if (idle >= pdMS_TO_TICKS(MODBUS_SECURITY_IDLE_TIMEOUT_MS))
+            {
+                LOG("Modbus Security: Idle timeout\n");
+                stream_ok = false;
+            }
+            else if (idle >= pdMS_TO_TICKS(MODBUS_SECURITY_RECV_TIMEOUT_MS))
+            {
+                /* Idle for a full receive timeout - drop any partial frame */
+                modbus_tcp_rx_reset(&s_rx);
+            }
+            else
+            {
+                /* Keep waiting */
+            }
+        }
+        else
+        {
+            /* Closed by the master, or a TLS error */
+            stream_ok = false;
+        }
+    }
+}
+
+/**
+ * @brief Modbus/TCP Security task
+ */
+static void modbus_security_task(void *arg)
+{
+    struct netconn *listen_conn;
+    modbus_config_t modbus_config;
+
+    (void)arg;
+
+    (void)memset(&modbus_config, 0, sizeof(modbus_config));
+    modbus_config.mode     = MODBUS_MODE_SLAVE;
+    modbus_config.protocol = MODBUS_PROTOCOL_TCP;
+    modbus_config.unit_id  = s_unit_id;
+    (void)modbus_init(s_security_ctx, &modbus_config);
+    (void)modbus_slave_set_device_id(s_security_ctx, &jerry_device_device_id);
+    (void)modbus_slave_set_file_reader(s_security_ctx,
+                                       modbus_files_read_record);
+    (void)modbus_slave_set_file_mapper(s_security_ctx,
+                                       modbus_files_map_record);
+    (void)modbus_slave_set_file_writer(s_security_ctx,
+                                       modbus_files_write_record);
+
+    listen_conn = netconn_new(NETCONN_TCP);
+    if (!modbus_security_setup() || (listen_conn == NULL) ||
+        (netconn_bind(listen_conn, IP_ADDR_ANY, MODBUS_SECURITY_PORT) !=
+         ERR_OK) ||
+        (netconn_listen_with_backlog(listen_conn, 1U) != ERR_OK))
+    {
+        printf("Modbus Security: Failed to listen on port %u\n",
+               MODBUS_SECURITY_PORT);
+        if (listen_conn != NULL)
+        {
+            netconn_delete(listen_conn);
+        }
+        vTaskDelete(NULL);
+    }
+
+    printf("Modbus Security listening on port %u\n", MODBUS_SECURITY_PORT);
+
+    for (;;)
+    {
+        if (netconn_accept(listen_conn, &s_conn) != ERR_OK)
+        {
+            continue;
+        }
+
+        LOG("Modbus Security: New connection accepted\n");
+        netconn_set_recvtimeout(s_conn, MODBUS_SECURITY_RECV_POLL_MS);
+
+        LOCK_TCPIP_CORE();
+        if (s_conn->pcb.tcp != NULL)
+        {
+            s_conn->pcb.tcp->tos = ETHERNETIF_TOS_CONTROL;
+        }
+        UNLOCK_TCPIP_CORE();
+
+        if (modbus_security_handshake())
+        {
+            modbus_security_serve();
+            (void)mbedtls_ssl_close_notify(&s_ssl);
+        }
+
+        if (s_rx_netbuf != NULL)
+        {
+            netbuf_delete(s_rx_netbuf);
+            s_rx_netbuf = NULL;
+        }
+        (void)mbedtls_ssl_session_reset(&s_ssl);
+        netconn_close(s_conn);
+        netconn_delete(s_conn);
+        s_conn = NULL;
+        LOG("Modbus Security: Connection closed\n");
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_security_start(SemaphoreHandle_t register_mutex, uint8_t unit_id)
+{
+    s_register_mutex = register_mutex;
+    s_unit_id        = unit_id;
+
+    (void)xTaskCreateStatic(modbus_security_task, "ModbusTLS",
+                            MODBUS_SECURITY_STACK_SIZE, NULL,
+                            MODBUS_SECURITY_PRIORITY, s_security_task_stack,
+                            &s_security_task_tcb);
+}
+
+#endif /* MODBUS_SECURITY */
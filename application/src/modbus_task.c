@@ -6,6 +6,25 @@
  *
  * This task implements a Modbus TCP server that listens on port 502
  * and handles Modbus requests using the generated register callbacks.
+ *
+ * The listening task only accepts connections. Each accepted connection is
+ * handed to one of MODBUS_MAX_CONNECTIONS statically allocated worker tasks,
+ * so several masters are served in parallel. Access to the register
+ * callbacks is serialized by a mutex.
+ *
+ * Requests are routed by the unit ID of their MBAP header to the slave
+ * context of one of the units of modbus_units.h, before anything else is
+ * done with them, then admitted or shed by the rate limits of
+ * modbus_admission.h. Reads take the read gate mutex before the register
+ * mutex, so at most one of them waits for the registers at a time and a
+ * control write is served after the access in progress and that one.
+ *
+ * With MODBUS_CAPTURE set, every frame received is also recorded for
+ * replay by modbus_capture.h while a capture client is connected.
+ *
+ * With MODBUS_TCP_RAW set, neither the workers nor the listening loop are
+ * started: the raw API server of modbus_tcp_raw.h serves port 502 in the
+ * TCP/IP thread instead, from the same units and register mutex.
  */
 
 #include <stdio.h>
@@ -14,16 +33,47 @@
 #include "bsp.h"
 #include "FreeRTOS.h"
 #include "app_tasks.h"
+#include "boot.h"
+#include "config_store.h"
+#include "ethernetif.h"
+#include "fota_task.h"
+#include "http_server.h"
 #include "jerry_device_registers.h"
+#include "log.h"
 #include "lwip/api.h"
 #include "lwip/err.h"
 #include "lwip/netbuf.h"
 #include "lwip/opt.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "modbus_admission.h"
 #include "modbus_callbacks.h"
+#include "modbus_capture.h"
+#include "modbus_diag.h"
+#include "modbus_files.h"
+#include "modbus_gateway.h"
 #include "modbus_internal.h"
+#include "modbus_rbe.h"
+#include "modbus_response_cache.h"
+#include "modbus_rtu_task.h"
+#include "modbus_security.h"
+#include "modbus_tcp_raw.h"
+#include "modbus_udp.h"
+#include "modbus_units.h"
+#include "mqtt_client.h"
+#include "net_cache.h"
+#include "opcua_server.h"
+#include "power_fail.h"
+#include "snapshot_publish.h"
+#include "semphr.h"
+#include "supervisor.h"
 #include "task.h"
+#include "task_priorities.h"
+#include "trace.h"
 
 /* ==========================================================================
  * Configuration
@@ -41,45 +91,163 @@
 /** Receive timeout in milliseconds */
 #define MODBUS_RECV_TIMEOUT_MS 5000U
 
+/** netconn_recv() poll period; bounds how fast an eviction takes effect */
+#define MODBUS_RECV_POLL_MS 250U
+
+/** A response write blocked this long by the peer fails the connection */
+#define MODBUS_SEND_TIMEOUT_MS 1000U
+
+/** Supervisor deadline of a worker serving a connection */
+#define MODBUS_WORKER_DEADLINE_MS 2000U
+
+/** Connections without a request for this long are closed */
+#define MODBUS_IDLE_TIMEOUT_MS 60000U
+
+/** A connection idle for at least this long may be evicted for a new one */
+#define MODBUS_EVICT_MIN_IDLE_MS 1000U
+
+/** How long the accept loop waits for an evicted worker to let go */
+#define MODBUS_EVICT_WAIT_MS (2U * MODBUS_RECV_POLL_MS)
+
+/** TCP keepalive: first probe after this idle time, then every interval */
+#define MODBUS_KEEPALIVE_IDLE_MS     10000U
+#define MODBUS_KEEPALIVE_INTERVAL_MS 2000U
+#define MODBUS_KEEPALIVE_COUNT       3U
+
+/** Stack size of each connection worker task (words) */
+#define MODBUS_WORKER_STACK_SIZE 512U
+
+/** Maximum-size responses batched into one netconn_write() */
+#define MODBUS_TCP_PIPELINE_DEPTH 4U
+
+/** MBAP header size; the function code follows it */
+#define MODBUS_TCP_MBAP_SIZE 7U
+
+/** Offset of the MBAP length field, which counts the bytes behind it */
+#define MODBUS_TCP_MBAP_LENGTH_OFFSET 4U
+
+/** Priority of the connection worker tasks */
+#define MODBUS_WORKER_PRIORITY TASK_PRIO_MODBUS_TCP
+
+/** Raise Modbus PCBs to TCP_PRIO_MAX so lwIP reclaims other PCBs first
+ *  when it runs out (set to 0U to leave them at TCP_PRIO_NORMAL) */
+#define MODBUS_TCP_HIGH_PRIO 1U
+
+#if !MODBUS_TCP_RAW
 /* ==========================================================================
  * Private Types
  * ========================================================================== */
 
 /**
  * @brief Connection handler context
+ *
+ * One entry per worker task. The accept loop fills @c conn, sets @c active
+ * and notifies the worker; the worker clears @c active once the connection
+ * has been closed. The worker updates @c last_activity on every receive;
+ * the accept loop sets @c evict to ask it to drop the connection. @c skip
+ * counts the bytes of a frame for a unit not served here that have yet to
+ * arrive, so they are passed over without being reassembled. @c bucket is
+ * the admission bucket of the connection.
  */
 typedef struct
 {
-    struct netconn *conn;
-    bool            active;
+    struct netconn         *conn;
+    volatile bool           active;
+    volatile bool           evict;
+    volatile TickType_t     last_activity;
+    TaskHandle_t            task;
+    supervisor_id_t         heartbeat;
+    StaticTask_t            task_tcb;
+    StackType_t             task_stack[MODBUS_WORKER_STACK_SIZE];
+    modbus_tcp_rx_context_t rx;
+    uint16_t                skip;
+    modbus_bucket_t         bucket;
+    uint8_t  tx_buffer[MODBUS_TCP_PIPELINE_DEPTH * MODBUS_TCP_MAX_ADU_SIZE];
+    uint16_t tx_length;
 } modbus_connection_t;
 
+#if MODBUS_GATEWAY
+_Static_assert(MODBUS_TCP_PIPELINE_DEPTH * MODBUS_TCP_MAX_ADU_SIZE >=
+                   MODBUS_GATEWAY_BUFFER_SIZE,
+               "TX buffer must hold a forwarded RTU response");
+#endif
+#endif /* !MODBUS_TCP_RAW */
+
 /* ==========================================================================
  * Private Data
  * ========================================================================== */
 
-/** Active connections */
+#if !MODBUS_TCP_RAW
+/** Connection slots, one per worker task */
 static modbus_connection_t s_connections[MODBUS_MAX_CONNECTIONS];
 
-/** Receive buffer */
-static uint8_t s_rx_buffer[MODBUS_TCP_MAX_ADU_SIZE];
+/** Worker task names */
+static const char *const s_worker_names[MODBUS_MAX_CONNECTIONS] = {
+    "ModbusW0", "ModbusW1", "ModbusW2", "ModbusW3"};
+#endif
+
+/** Serializes register callback access between worker tasks */
+static SemaphoreHandle_t s_register_mutex;
+static StaticSemaphore_t s_register_mutex_buffer;
 
-/** Transmit buffer */
-static uint8_t s_tx_buffer[MODBUS_TCP_MAX_ADU_SIZE];
+#if !MODBUS_TCP_RAW
+/** Held by the read of a worker while it waits for s_register_mutex, so
+ *  writes queue behind one read at most */
+static SemaphoreHandle_t s_read_gate;
+static StaticSemaphore_t s_read_gate_buffer;
+#endif
 
 /** Modbus unit ID (initialized from DEVADDR pins) */
 static uint8_t s_modbus_unit_id = MODBUS_UNIT_ID_BASE;
 
+/** Modbus slave context shared by all workers (guarded by the mutex) */
+static modbus_context_storage_t s_modbus_ctx_storage;
+static modbus_context_t *const  s_modbus_ctx =
+    (modbus_context_t *)&s_modbus_ctx_storage;
+
+#if MODBUS_MONITOR_UNIT
+/** Slave context of the read-only monitor unit (guarded by the mutex) */
+static modbus_context_storage_t s_monitor_ctx_storage;
+static modbus_context_t *const  s_monitor_ctx =
+    (modbus_context_t *)&s_monitor_ctx_storage;
+#endif
+
 /* ==========================================================================
  * Private Function Prototypes
  * ========================================================================== */
 
+static void           modbus_add_unit(
+              modbus_context_t *ctx, uint8_t unit_id,
+              const modbus_slave_callbacks_t *callbacks, bool writable);
+#if !MODBUS_TCP_RAW
+static bool           modbus_unit_wanted(uint8_t unit_id);
+static uint16_t       modbus_foreign_frame_length(const uint8_t *data,
+                                                  uint16_t       length);
 static void           modbus_tcp_server_thread(void *arg);
-static void           modbus_handle_connection(struct netconn *conn);
-static modbus_error_t modbus_process_request(const uint8_t *request,
-                                             uint16_t       request_len,
-                                             uint8_t       *response,
-                                             uint16_t      *response_len);
+static void           modbus_connection_worker(void *arg);
+static bool           modbus_dispatch_connection(struct netconn *conn);
+static bool           modbus_evict_idle_connection(void);
+static void           modbus_tune_connection(struct netconn *conn);
+static void           modbus_ack_now(struct netconn *conn);
+static err_t          modbus_flush_responses(modbus_connection_t *slot);
+static void           modbus_shed_request(modbus_connection_t *slot,
+                                          const uint8_t       *frame,
+                                          uint8_t              unit_id,
+                                          modbus_admission_t   admission);
+static void           modbus_handle_frame(modbus_connection_t *slot,
+                                          const uint8_t       *frame,
+                                          uint16_t             frame_len);
+static bool           modbus_process_stream(modbus_connection_t *slot,
+                                            const uint8_t       *data,
+                                            uint16_t             length);
+static void           modbus_handle_connection(modbus_connection_t *slot);
+static modbus_error_t modbus_process_request(const modbus_unit_t *unit,
+                                             const uint8_t       *request,
+                                             uint16_t             request_len,
+                                             uint8_t             *response,
+                                             uint16_t             response_size,
+                                             uint16_t            *response_len);
+#endif
 
 /* ==========================================================================
  * Public Functions
@@ -97,29 +265,115 @@ void vModbusTask(void *pvParameters)
     printf("Modbus: Device address from DEVADDR pins: %u, Unit ID: %u\n",
            dev_addr, s_modbus_unit_id);
 
-    /* Wait for LwIP to be fully initialized
-     * The tcpip_init() is called from main and takes some time to complete.
-     * We need to wait until the network stack is ready before creating
-     * netconn structures.
-     */
-    printf("Modbus: Waiting for network stack initialization...\n");
-    vTaskDelay(pdMS_TO_TICKS(2000));
-
     /* Initialize register data structures */
     jerry_device_registers_init();
     printf("Modbus registers initialized\n");
 
-    /* Initialize connection tracking */
+    /* Saved settings replace the defaults before anyone reads them; the
+     * DHCP start waits for the cached lease among them (net_cache.h) */
+    config_store_start();
+#if POWER_FAIL
+    /* Then the state of the last power loss, newer than the store's */
+    power_fail_start();
+#endif
+    boot_event_set(BOOT_EVENT_CONFIG);
+
+    /* Initialize the slave context of each unit served */
+#if MODBUS_TCP_RAW
+    /* The raw API server must not wait for the output expanders in the
+     * TCP/IP thread (modbus_units.h) */
+    modbus_add_unit(s_modbus_ctx, s_modbus_unit_id,
+                    &modbus_units_tcpip_callbacks, true);
+#else
+    modbus_add_unit(s_modbus_ctx, s_modbus_unit_id, NULL, true);
+#endif
+#if MODBUS_ENABLE_LATENCY_STATS
+    (void)modbus_slave_set_latency_stats(
+        s_modbus_ctx, modbus_diag_latency_stats(MODBUS_DIAG_TRANSPORT_TCP));
+#endif
+#if MODBUS_MONITOR_UNIT
+    modbus_add_unit(s_monitor_ctx,
+                    (uint8_t)(s_modbus_unit_id + MODBUS_UNITS_MONITOR_OFFSET),
+                    &modbus_units_monitor_callbacks, false);
+#endif
+
+    s_register_mutex = xSemaphoreCreateMutexStatic(&s_register_mutex_buffer);
+    net_cache_start(s_register_mutex);
+    fota_resume_start(s_register_mutex);
+#if !MODBUS_TCP_RAW
+    s_read_gate = xSemaphoreCreateMutexStatic(&s_read_gate_buffer);
+#endif
+    modbus_response_cache_init();
+
+#if MODBUS_GATEWAY
+    /* The RS-485 port reaches downstream devices for other unit IDs */
+    modbus_gateway_start();
+#else
+    /* Serve the same registers on the RS-485 port */
+    modbus_rtu_task_start(s_register_mutex, s_modbus_unit_id);
+#endif
+
+    /* The serial side is served from here on; the TCP side needs the
+     * network interface, which the TCP echo task brings up meanwhile */
+    printf("Modbus: Waiting for network stack initialization...\n");
+    (void)boot_wait(BOOT_EVENT_NETIF_UP, BOOT_WAIT_FOREVER);
+
+#if MODBUS_SECURITY
+    /* The same registers over TLS on port 802 */
+    modbus_security_start(s_register_mutex, s_modbus_unit_id);
+#endif
+#if MODBUS_UDP
+    /* The same registers over UDP, answered in the TCP/IP thread */
+    modbus_udp_start(s_register_mutex, s_modbus_unit_id);
+#endif
+#if MODBUS_CAPTURE && !MODBUS_TCP_RAW
+    /* The requests received, recorded for replay while a client asks */
+    modbus_capture_start();
+#endif
+#if MODBUS_RBE
+    /* Changes of subscribed blocks, pushed instead of polled */
+    modbus_rbe_start(s_register_mutex);
+#endif
+#if SNAPSHOT_PUBLISH
+    /* The snapshot groups, multicast to any number of listeners */
+    snapshot_publish_start(s_register_mutex);
+#endif
+#if HTTP_SERVER
+    /* Status page and JSON for a browser, served in the TCP/IP thread */
+    http_server_start(s_register_mutex);
+#endif
+#if MQTT_CLIENT
+    /* Telemetry, statistics and changes, published to an MQTT broker */
+    mqtt_client_start();
+#endif
+#if OPCUA_SERVER
+    /* Browsable address space and subscriptions for OPC UA clients */
+    opcua_server_start(s_register_mutex);
+#endif
+
+#if MODBUS_TCP_RAW
+    /* Serve port 502 from the lwIP callbacks; this task has nothing left
+     * to do */
+    modbus_tcp_raw_start(s_register_mutex);
+#else
+    /* Initialize connection tracking and start one worker per slot */
     for (uint8_t i = 0U; i < MODBUS_MAX_CONNECTIONS; i++)
     {
         s_connections[i].conn   = NULL;
         s_connections[i].active = false;
+        s_connections[i].task   = xTaskCreateStatic(
+            modbus_connection_worker, s_worker_names[i],
+            MODBUS_WORKER_STACK_SIZE, &s_connections[i],
+            MODBUS_WORKER_PRIORITY, s_connections[i].task_stack,
+            &s_connections[i].task_tcb);
     }
 
     /* Start the Modbus TCP server */
     modbus_tcp_server_thread(NULL);
+#endif
 
-    /* Should not reach here */
+    /* Only reached if the server could not listen, or with the raw API
+     * server */
     for (;;)
     {
         vTaskDelay(pdMS_TO_TICKS(1000));
@@ -130,6 +384,99 @@ void vModbusTask(void *pvParameters)
  * Private Functions
  * ========================================================================== */
 
+/**
+ * @brief Initialize the slave context of a unit and add it to the table
+ *
+ * @param[out] ctx       Context storage of the unit
+ * @param[in]  unit_id   Unit ID it answers for
+ * @param[in]  callbacks Its callback table, NULL for modbus_cb_*
+ * @param[in]  writable  Its files may be written
+ */
+static void modbus_add_unit(modbus_context_t *ctx, uint8_t unit_id,
+                            const modbus_slave_callbacks_t *callbacks,
+                            bool                            writable)
+{
+    modbus_config_t modbus_config;
+
+    (void)memset(&modbus_config, 0, sizeof(modbus_config));
+    modbus_config.mode     = MODBUS_MODE_SLAVE;
+    modbus_config.protocol = MODBUS_PROTOCOL_TCP;
+    modbus_config.unit_id  = unit_id;
+    (void)modbus_init(ctx, &modbus_config);
+    (void)modbus_slave_set_device_id(ctx, &jerry_device_device_id);
+    (void)modbus_slave_set_file_reader(ctx, modbus_files_read_record);
+    (void)modbus_slave_set_file_mapper(ctx, modbus_files_map_record);
+    (void)modbus_slave_set_callbacks(ctx, callbacks);
+
+    if (writable)
+    {
+        (void)modbus_slave_set_file_writer(ctx, modbus_files_write_record);
+    }
+
+    if (modbus_units_add(unit_id, ctx))
+    {
+        printf("Modbus: Serving unit ID %u%s\n", unit_id,
+               writable ? "" : " (read-only)");
+    }
+    else
+    {
+        printf("Modbus: Unit ID %u not added\n", unit_id);
+    }
+}
+
+#if !MODBUS_TCP_RAW
+/**
+ * @brief Check whether requests for a unit are answered on this server
+ *
+ * @param[in] unit_id Unit ID of a request
+ * @return true for a unit in the table or one the gateway forwards to
+ */
+static bool modbus_unit_wanted(uint8_t unit_id)
+{
+#if MODBUS_GATEWAY
+    if (modbus_gateway_is_remote(unit_id))
+    {
+        return true;
+    }
+#endif
+
+    return modbus_units_lookup(unit_id) != NULL;
+}
+
+/**
+ * @brief Get the length of a frame that is to be dropped unseen
+ *
+ * Looks at the MBAP header only. A header with an impossible length is not
+ * skipped but left to the receiver, which closes the stream.
+ *
+ * @param[in] data   Start of a frame
+ * @param[in] length Bytes available from @p data
+ * @return Length of the whole frame if it is for a unit not served here,
+ *         0 if it is to be processed or the header is incomplete
+ */
+static uint16_t modbus_foreign_frame_length(const uint8_t *data,
+                                            uint16_t       length)
+{
+    uint16_t frame_len;
+
+    if ((length < MODBUS_TCP_MBAP_SIZE) ||
+        modbus_unit_wanted(data[MODBUS_TCP_MBAP_SIZE - 1U]))
+    {
+        return 0U;
+    }
+
+    frame_len = (uint16_t)(
+        (MODBUS_TCP_MBAP_SIZE - 1U) +
+        (((uint16_t)data[MODBUS_TCP_MBAP_LENGTH_OFFSET] << 8) |
+         data[MODBUS_TCP_MBAP_LENGTH_OFFSET + 1U]));
+
+    /* At least a function code, at most a full ADU */
+    return ((frame_len > MODBUS_TCP_MBAP_SIZE) &&
+            (frame_len <= MODBUS_TCP_MAX_ADU_SIZE))
+               ? frame_len
+               : 0U;
+}
+
 /**
  * @brief Modbus TCP server main thread
  */
@@ -158,8 +505,9 @@ static void modbus_tcp_server_thread(void *arg)
         return;
     }
 
-    /* Start listening */
-    err = netconn_listen(listen_conn);
+    /* Start listening; SYNs beyond the backlog are refused by lwIP, so
+     * pending connections cannot use up MEMP_NUM_TCP_PCB */
+    err = netconn_listen_with_backlog(listen_conn, MODBUS_MAX_CONNECTIONS);
     if (err != ERR_OK)
     {
         printf("Modbus: Failed to listen: %d\n", err);
@@ -167,7 +515,9 @@ static void modbus_tcp_server_thread(void *arg)
         return;
     }
 
-    printf("Modbus TCP Server listening on port %u\n", MODBUS_TCP_PORT);
+    printf("Modbus TCP Server listening on port %u (net profile %s)\n",
+           MODBUS_TCP_PORT, NET_PROFILE_NAME);
+    boot_event_set(BOOT_EVENT_SERVICE_UP);
 
     /* Main server loop */
     while (1)
@@ -176,325 +526,632 @@ static void modbus_tcp_server_thread(void *arg)
         err = netconn_accept(listen_conn, &new_conn);
         if (err == ERR_OK)
         {
-            printf("Modbus: New connection accepted\n");
-
-            /* Set receive timeout */
-            netconn_set_recvtimeout(new_conn, MODBUS_RECV_TIMEOUT_MS);
-
-            /* Handle the connection (blocking) */
-            modbus_handle_connection(new_conn);
-
-            /* Clean up */
-            netconn_close(new_conn);
-            netconn_delete(new_conn);
-            printf("Modbus: Connection closed\n");
+            LOG("Modbus: New connection accepted\n");
+
+            /* Set receive poll period, a bound on a blocked write, so a
+             * stalled peer cannot hold the worker past its deadline, and
+             * per-connection TCP options */
+            netconn_set_recvtimeout(new_conn, MODBUS_RECV_POLL_MS);
+            netconn_set_sendtimeout(new_conn, MODBUS_SEND_TIMEOUT_MS);
+            modbus_tune_connection(new_conn);
+
+            /* Hand the connection to a free worker, evicting the least
+             * recently used idle connection if all are busy */
+            if (!modbus_dispatch_connection(new_conn) &&
+                (!modbus_evict_idle_connection() ||
+                 !modbus_dispatch_connection(new_conn)))
+            {
+                LOG("Modbus: No free connection slot, rejecting\n");
+                netconn_close(new_conn);
+                netconn_delete(new_conn);
+            }
         }
         else
         {
-            printf("Modbus: Accept error: %d\n", err);
+            LOG("Modbus: Accept error: %d\n", err);
             vTaskDelay(pdMS_TO_TICKS(100));
         }
     }
 }
 
 /**
- * @brief Handle a single Modbus TCP connection
+ * @brief Hand an accepted connection to an idle worker task
+ *
+ * @param[in] conn Accepted connection
+ * @return true if a worker took the connection, false if all are busy
  */
-static void modbus_handle_connection(struct netconn *conn)
+static bool modbus_dispatch_connection(struct netconn *conn)
 {
-    struct netbuf *buf;
-    err_t          err;
-    void          *data;
-    u16_t          len;
-    uint16_t       response_len;
-    modbus_error_t modbus_err;
+    bool dispatched = false;
 
-    while (1)
+    for (uint8_t i = 0U; (i < MODBUS_MAX_CONNECTIONS) && !dispatched; i++)
     {
-        /* Receive data */
-        err = netconn_recv(conn, &buf);
-        if (err == ERR_OK)
+        modbus_connection_t *slot = &s_connections[i];
+
+        if ((slot->task != NULL) && !slot->active)
         {
-            /* Get data from netbuf */
-            netbuf_data(buf, &data, &len);
+            slot->conn          = conn;
+            slot->evict         = false;
+            slot->last_activity = xTaskGetTickCount();
+            slot->active        = true;
+            (void)xTaskNotifyGive(slot->task);
+            dispatched = true;
+        }
+    }
 
-            if (len > 0U)
-            {
-                /* Copy to receive buffer */
-                uint16_t copy_len = (len > sizeof(s_rx_buffer))
-                                        ? (uint16_t)sizeof(s_rx_buffer)
-                                        : len;
-                (void)memcpy(s_rx_buffer, data, copy_len);
-
-                /* Process the Modbus request */
-                modbus_err = modbus_process_request(s_rx_buffer, copy_len,
-                                                    s_tx_buffer, &response_len);
-
-                if (modbus_err == MODBUS_OK)
-                {
-                    /* Send response */
-                    err = netconn_write(conn, s_tx_buffer, response_len,
-                                        NETCONN_COPY);
-                    if (err != ERR_OK)
-                    {
-                        printf("Modbus: Write error: %d\n", err);
-                    }
-                }
-                else
-                {
-                    printf("Modbus: Process error: %d\n", (int)modbus_err);
-                }
-            }
+    return dispatched;
+}
 
-            netbuf_delete(buf);
-        }
-        else if (err == ERR_TIMEOUT)
+/**
+ * @brief Evict the least recently used idle connection
+ *
+ * Picks the active connection that has gone longest without a request, if
+ * that is at least MODBUS_EVICT_MIN_IDLE_MS, asks its worker to close it
+ * and waits for the slot to become free.
+ *
+ * @return true if a slot was freed
+ */
+static bool modbus_evict_idle_connection(void)
+{
+    modbus_connection_t *victim   = NULL;
+    TickType_t           now      = xTaskGetTickCount();
+    TickType_t           max_idle = pdMS_TO_TICKS(MODBUS_EVICT_MIN_IDLE_MS);
+    bool                 freed    = false;
+
+    for (uint8_t i = 0U; i < MODBUS_MAX_CONNECTIONS; i++)
+    {
+        modbus_connection_t *slot = &s_connections[i];
+        TickType_t           idle = now - slot->last_activity;
+
+        if (slot->active && !slot->evict && (idle >= max_idle))
         {
-            /* Timeout - continue waiting */
+            victim   = slot;
+            max_idle = idle;
         }
-        else
+    }
+
+    if (victim != NULL)
+    {
+        LOG("Modbus: Evicting connection idle for %lu ms\n",
+            (unsigned long)pdTICKS_TO_MS(max_idle));
+        victim->evict = true;
+
+        for (uint32_t waited = 0U; victim->active &&
+                                   (waited < MODBUS_EVICT_WAIT_MS);
+             waited += 10U)
         {
-            /* Connection error - exit */
-            printf("Modbus: Receive error: %d\n", err);
-            break;
+            vTaskDelay(pdMS_TO_TICKS(10U));
         }
+        freed = !victim->active;
     }
+
+    return freed;
 }
 
 /**
- * @brief Process a Modbus TCP request and generate response
+ * @brief Apply the Modbus TCP options to an accepted connection
+ *
+ * Nagle is disabled (unless the network profile keeps it, see
+ * NET_PROFILE_TCP_NODELAY) so each response leaves as soon as it is
+ * written instead of waiting for the ACK of the previous one. Keepalive
+ * probes detect masters that vanished without closing the connection.
+ * Responses are marked as control traffic (ETHERNETIF_TOS_CONTROL).
+ *
+ * @param[in] conn Accepted connection
  */
-static modbus_error_t modbus_process_request(const uint8_t *request,
-                                             uint16_t       request_len,
-                                             uint8_t       *response,
-                                             uint16_t      *response_len)
+static void modbus_tune_connection(struct netconn *conn)
 {
-    modbus_adu_t       request_adu;
-    modbus_adu_t       response_adu;
-    modbus_pdu_t       response_pdu;
-    modbus_error_t     err;
-    modbus_exception_t exception = MODBUS_EXCEPTION_NONE;
-
-    /* Parse the TCP frame */
-    err = modbus_tcp_parse_frame(request, request_len, &request_adu);
-    if (err != MODBUS_OK)
+    LOCK_TCPIP_CORE();
+    if (conn->pcb.tcp != NULL)
     {
-        printf("Modbus: Frame parse error: %d\n", (int)err);
-        return err;
+#if NET_PROFILE_TCP_NODELAY
+        tcp_nagle_disable(conn->pcb.tcp);
+#endif
+#if MODBUS_TCP_HIGH_PRIO
+        tcp_setprio(conn->pcb.tcp, TCP_PRIO_MAX);
+#endif
+        ip_set_option(conn->pcb.tcp, SOF_KEEPALIVE);
+        conn->pcb.tcp->keep_idle  = MODBUS_KEEPALIVE_IDLE_MS;
+        conn->pcb.tcp->keep_intvl = MODBUS_KEEPALIVE_INTERVAL_MS;
+        conn->pcb.tcp->keep_cnt   = MODBUS_KEEPALIVE_COUNT;
+        conn->pcb.tcp->tos        = ETHERNETIF_TOS_CONTROL;
     }
+    UNLOCK_TCPIP_CORE();
+}
 
-    /* Check unit ID (0 = broadcast, or match our ID) */
-    if ((request_adu.unit_id != 0U) && (request_adu.unit_id != s_modbus_unit_id))
+/**
+ * @brief Acknowledge received data without waiting for the delayed ACK
+ *
+ * Used when a receive produced no response (a request split across
+ * segments). A response segment carries the ACK itself; without one the
+ * master, typically running Nagle, would hold the rest of the request back
+ * until lwIP's delayed ACK timer fires.
+ *
+ * @param[in] conn Connection
+ */
+static void modbus_ack_now(struct netconn *conn)
+{
+    LOCK_TCPIP_CORE();
+    if (conn->pcb.tcp != NULL)
     {
-        /* Not for us - ignore */
-        return MODBUS_ERROR_INVALID_PARAM;
+        tcp_ack_now(conn->pcb.tcp);
+        (void)tcp_output(conn->pcb.tcp);
     }
+    UNLOCK_TCPIP_CORE();
+}
 
-    /* Initialize response PDU */
-    (void)memset(&response_pdu, 0, sizeof(response_pdu));
+/**
+ * @brief Connection worker task
+ *
+ * Waits for the accept loop to assign a connection, serves it until the
+ * peer disconnects, then returns the slot to the pool.
+ *
+ * @param[in] arg Pointer to the worker's modbus_connection_t slot
+ */
+static void modbus_connection_worker(void *arg)
+{
+    modbus_connection_t *slot = (modbus_connection_t *)arg;
 
-    /* Process based on function code */
-    switch (request_adu.pdu.function_code)
+    /* Every receive poll is a check-in while a connection is served */
+    slot->heartbeat = supervisor_register(
+        pcTaskGetName(NULL), MODBUS_RECV_POLL_MS, MODBUS_WORKER_DEADLINE_MS);
+
+    for (;;)
     {
-        case MODBUS_FC_READ_COILS:
+        supervisor_idle(slot->heartbeat);
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (slot->conn != NULL)
         {
-            uint16_t start_address;
-            uint16_t quantity;
-            uint8_t  coil_values[256];
+            printf("Modbus: %s serving connection\n", pcTaskGetName(NULL));
 
-            err = modbus_pdu_decode_read_bits_request(
-                &request_adu.pdu, &start_address, &quantity);
-            if (err == MODBUS_OK)
-            {
-                exception =
-                    modbus_cb_read_coils(start_address, quantity, coil_values);
-                if (exception == MODBUS_EXCEPTION_NONE)
-                {
-                    err = modbus_pdu_encode_read_bits_response(
-                        &response_pdu, MODBUS_FC_READ_COILS, coil_values,
-                        quantity);
-                }
-            }
-            break;
+            modbus_handle_connection(slot);
+
+            /* Clean up */
+            netconn_close(slot->conn);
+            netconn_delete(slot->conn);
+            slot->conn = NULL;
+            LOG("Modbus: Connection closed\n");
         }
 
-        case MODBUS_FC_READ_DISCRETE_INPUTS:
-        {
-            uint16_t start_address;
-            uint16_t quantity;
-            uint8_t  input_values[256];
+        slot->active = false;
+    }
+}
 
-            err = modbus_pdu_decode_read_bits_request(
-                &request_adu.pdu, &start_address, &quantity);
-            if (err == MODBUS_OK)
-            {
-                exception = modbus_cb_read_discrete_inputs(
-                    start_address, quantity, input_values);
-                if (exception == MODBUS_EXCEPTION_NONE)
-                {
-                    err = modbus_pdu_encode_read_bits_response(
-                        &response_pdu, MODBUS_FC_READ_DISCRETE_INPUTS,
-                        input_values, quantity);
-                }
-            }
-            break;
+/**
+ * @brief Send all queued responses of a connection in one write
+ *
+ * @param[in,out] slot Connection slot
+ * @return ERR_OK on success or when nothing is queued
+ */
+static err_t modbus_flush_responses(modbus_connection_t *slot)
+{
+    err_t err = ERR_OK;
+
+    if (slot->tx_length > 0U)
+    {
+        err = netconn_write(slot->conn, slot->tx_buffer, slot->tx_length,
+                            NETCONN_COPY);
+        if (err != ERR_OK)
+        {
+            LOG("Modbus: Write error: %d\n", err);
         }
+        slot->tx_length = 0U;
+    }
+
+    return err;
+}
+
+/**
+ * @brief Answer a request that was not admitted with SLAVE DEVICE BUSY
+ *
+ * @param[in,out] slot      Connection slot
+ * @param[in]     frame     Complete request frame
+ * @param[in]     unit_id   Unit ID of the response
+ * @param[in]     admission Bucket that refused the request
+ */
+static void modbus_shed_request(modbus_connection_t *slot,
+                                const uint8_t *frame, uint8_t unit_id,
+                                modbus_admission_t admission)
+{
+    modbus_pdu_buffer_t response_pdu;
+    uint8_t            *response;
+    uint16_t            response_size;
+    uint16_t            response_len = 0U;
+    uint16_t            transaction_id =
+        (uint16_t)(((uint16_t)frame[0] << 8) | frame[1]);
+
+    metrics_add((admission == MODBUS_ADMIT_SHED_UNIT) ? METRIC_MODBUS_SHED_UNIT
+                                                      : METRIC_MODBUS_SHED_CONN,
+                1U);
+
+    /* MBAP header, function code and exception code */
+    if ((sizeof(slot->tx_buffer) - slot->tx_length) <
+        (MODBUS_TCP_PDU_OFFSET + 2U))
+    {
+        (void)modbus_flush_responses(slot);
+    }
+
+    response      = &slot->tx_buffer[slot->tx_length];
+    response_size = (uint16_t)(sizeof(slot->tx_buffer) - slot->tx_length);
+    (void)modbus_pdu_buffer_from_frame(
+        &response[MODBUS_TCP_PDU_OFFSET],
+        (uint16_t)(response_size - MODBUS_TCP_PDU_OFFSET), &response_pdu);
+
+    if ((modbus_pdu_buffer_encode_exception(
+             &response_pdu, frame[MODBUS_TCP_MBAP_SIZE],
+             MODBUS_EXCEPTION_SLAVE_DEVICE_BUSY) == MODBUS_OK) &&
+        (modbus_tcp_build_frame_in_place(
+             transaction_id, unit_id, response,
+             (uint16_t)(1U + response_pdu.data_length), response_size,
+             &response_len) == MODBUS_OK))
+    {
+        slot->tx_length = (uint16_t)(slot->tx_length + response_len);
+    }
+}
+
+/**
+ * @brief Process one complete MBAP frame and queue its response
+ *
+ * @param[in,out] slot      Connection slot
+ * @param[in]     frame     Complete frame (receive buffer or pbuf payload)
+ * @param[in]     frame_len Frame length in bytes
+ */
+static void modbus_handle_frame(modbus_connection_t *slot,
+                                const uint8_t *frame, uint16_t frame_len)
+{
+    uint16_t             response_len = 0U;
+    uint16_t             response_max = MODBUS_TCP_MAX_ADU_SIZE;
+    const modbus_unit_t *unit         = NULL;
+    bool                 write;
+    modbus_admission_t   admission;
+    modbus_error_t       modbus_err;
+
+    if ((frame_len <= MODBUS_TCP_MBAP_SIZE) ||
+        !modbus_unit_wanted(frame[MODBUS_TCP_MBAP_SIZE - 1U]))
+    {
+        /* Not for us - only a frame whose header arrived split gets here,
+         * the others are skipped in the stream */
+#if MODBUS_CAPTURE
+        modbus_capture_frame((uint8_t)(slot - s_connections), frame,
+                             frame_len, MODBUS_CAPTURE_FLAG_FOREIGN);
+#endif
+        metrics_add(METRIC_MODBUS_UNIT_DROP, 1U);
+        return;
+    }
+
+#if MODBUS_CAPTURE
+    modbus_capture_frame((uint8_t)(slot - s_connections), frame, frame_len,
+                         0U);
+#endif
 
-        case MODBUS_FC_READ_HOLDING_REGISTERS:
+    unit      = modbus_units_lookup(frame[MODBUS_TCP_MBAP_SIZE - 1U]);
+    admission = modbus_admission_check(&slot->bucket, unit,
+                                       frame[MODBUS_TCP_MBAP_SIZE]);
+    if (admission != MODBUS_ADMIT_OK)
+    {
+        modbus_shed_request(slot, frame,
+                            (unit != NULL) ? unit->unit_id
+                                           : frame[MODBUS_TCP_MBAP_SIZE - 1U],
+                            admission);
+        return;
+    }
+
+#if MODBUS_GATEWAY
+    /* Requests for downstream units bypass the registers; send what is
+     * queued first so it does not wait for the serial transaction */
+    if (unit == NULL)
+    {
+        (void)modbus_flush_responses(slot);
+        if (modbus_gateway_forward(frame, frame_len, slot->tx_buffer,
+                                   &response_len) == MODBUS_OK)
         {
-            uint16_t start_address;
-            uint16_t quantity;
-            uint16_t register_values[125];
+            slot->tx_length = response_len;
+        }
+        return;
+    }
+#endif
+
+    /* Only reserve as much TX space as this function code can answer with */
+    response_max = (uint16_t)(MODBUS_TCP_MBAP_SIZE +
+                              modbus_slave_get_response_bound(
+                                  unit->ctx, frame[MODBUS_TCP_MBAP_SIZE]));
+
+    if ((sizeof(slot->tx_buffer) - slot->tx_length) < response_max)
+    {
+        (void)modbus_flush_responses(slot);
+    }
+
+    /* Process the Modbus request, or answer a repeated read from cache;
+     * reads queue one at a time behind the gate, writes go straight on */
+    write = modbus_admission_is_write(frame[MODBUS_TCP_MBAP_SIZE]);
+    if (!write)
+    {
+        (void)xSemaphoreTake(s_read_gate, portMAX_DELAY);
+    }
+    (void)xSemaphoreTake(s_register_mutex, portMAX_DELAY);
+    if (!write)
+    {
+        (void)xSemaphoreGive(s_read_gate);
+    }
+#if MODBUS_RESPONSE_CACHE
+    response_len = modbus_response_cache_lookup(
+        frame, frame_len, &slot->tx_buffer[slot->tx_length],
+        (uint16_t)(sizeof(slot->tx_buffer) - slot->tx_length));
+    if (response_len > 0U)
+    {
+        modbus_err = MODBUS_OK;
+    }
+    else
+#endif
+    {
+        TRACE_USER(TRACE_USER_MODBUS_REQUEST,
+                   (frame_len > MODBUS_TCP_PDU_OFFSET)
+                       ? frame[MODBUS_TCP_PDU_OFFSET]
+                       : 0U);
+        modbus_err = modbus_process_request(
+            unit, frame, frame_len, &slot->tx_buffer[slot->tx_length],
+            (uint16_t)(sizeof(slot->tx_buffer) - slot->tx_length),
+            &response_len);
+        TRACE_USER(TRACE_USER_MODBUS_RESPONSE, modbus_err);
+#if MODBUS_RESPONSE_CACHE
+        modbus_response_cache_update(
+            frame, frame_len, &slot->tx_buffer[slot->tx_length],
+            (modbus_err == MODBUS_OK) ? response_len : 0U);
+#endif
+    }
+    (void)xSemaphoreGive(s_register_mutex);
+
+    if (modbus_err == MODBUS_OK)
+    {
+        slot->tx_length = (uint16_t)(slot->tx_length + response_len);
+    }
+    else
+    {
+        LOG("Modbus: Process error: %d\n", (int)modbus_err);
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+    }
+}
+
+/**
+ * @brief Feed received bytes through the connection's frame receiver
+ *
+ * Every complete MBAP frame is processed in turn and its response appended
+ * to the connection's TX buffer. Frames that arrive whole are decoded in
+ * place from the received payload; only frames split across segments are
+ * reassembled in the receiver buffer. A frame whose header shows a unit
+ * not served here is skipped, in this payload and the following ones,
+ * before either. The TX buffer is flushed early only if it cannot hold
+ * another maximum-size response.
+ *
+ * @param[in,out] slot   Connection slot
+ * @param[in]     data   Received bytes
+ * @param[in]     length Number of received bytes
+ * @return false if the stream is corrupt and the connection must be closed
+ */
+static bool modbus_process_stream(modbus_connection_t *slot,
+                                  const uint8_t *data, uint16_t length)
+{
+    bool     stream_ok = true;
+    uint16_t offset    = 0U;
 
-            err = modbus_pdu_decode_read_registers_request(
-                &request_adu.pdu, &start_address, &quantity);
-            if (err == MODBUS_OK)
+    while ((offset < length) && stream_ok)
+    {
+        uint16_t remaining = (uint16_t)(length - offset);
+        uint16_t frame_len = 0U;
+
+        if ((slot->skip == 0U) && (slot->rx.index == 0U))
+        {
+            slot->skip = modbus_foreign_frame_length(&data[offset], remaining);
+            if (slot->skip > 0U)
+            {
+#if MODBUS_CAPTURE
+                modbus_capture_frame(
+                    (uint8_t)(slot - s_connections), &data[offset],
+                    (remaining < slot->skip) ? remaining : slot->skip,
+                    MODBUS_CAPTURE_FLAG_FOREIGN);
+#endif
+                metrics_add(METRIC_MODBUS_UNIT_DROP, 1U);
+            }
+            else
             {
-                exception = modbus_cb_read_holding_registers(
-                    start_address, quantity, register_values);
-                if (exception == MODBUS_EXCEPTION_NONE)
-                {
-                    err = modbus_pdu_encode_read_registers_response(
-                        &response_pdu, MODBUS_FC_READ_HOLDING_REGISTERS,
-                        register_values, quantity);
-                }
+                frame_len =
+                    modbus_tcp_get_frame_length(&data[offset], remaining);
             }
-            break;
         }
 
-        case MODBUS_FC_READ_INPUT_REGISTERS:
+        if (slot->skip > 0U)
+        {
+            /* Frame for another unit - never copied or parsed */
+            uint16_t skipped = (remaining < slot->skip) ? remaining
+                                                        : slot->skip;
+            slot->skip = (uint16_t)(slot->skip - skipped);
+            offset     = (uint16_t)(offset + skipped);
+        }
+        else if (frame_len > 0U)
+        {
+            /* Whole frame in this payload - no reassembly copy needed */
+            modbus_handle_frame(slot, &data[offset], frame_len);
+            offset = (uint16_t)(offset + frame_len);
+        }
+        else
         {
-            uint16_t start_address;
-            uint16_t quantity;
-            uint16_t register_values[125];
+            uint16_t       consumed   = 0U;
+            modbus_error_t modbus_err = modbus_tcp_rx_process_data(
+                &slot->rx, &data[offset], remaining,
+                (uint32_t)xTaskGetTickCount(), &consumed);
+            offset = (uint16_t)(offset + consumed);
 
-            err = modbus_pdu_decode_read_registers_request(
-                &request_adu.pdu, &start_address, &quantity);
-            if (err == MODBUS_OK)
+            if (modbus_err != MODBUS_OK)
             {
-                exception = modbus_cb_read_input_registers(
-                    start_address, quantity, register_values);
-                if (exception == MODBUS_EXCEPTION_NONE)
-                {
-                    err = modbus_pdu_encode_read_registers_response(
-                        &response_pdu, MODBUS_FC_READ_INPUT_REGISTERS,
-                        register_values, quantity);
-                }
+                /* MBAP framing lost - there is no way to resynchronise */
+                LOG("Modbus: Stream framing error: %d\n", (int)modbus_err);
+                metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+                stream_ok = false;
             }
-            break;
-        }
-
-        case MODBUS_FC_WRITE_SINGLE_COIL:
-        {
-            uint16_t address;
-            bool     value;
+            else if (modbus_tcp_rx_is_complete(&slot->rx))
+            {
+                const uint8_t *frame;
 
-            err = modbus_pdu_decode_write_single_coil_request(&request_adu.pdu,
-                                                              &address, &value);
-            if (err == MODBUS_OK)
+                (void)modbus_tcp_rx_get_frame(&slot->rx, &frame, &frame_len);
+                modbus_handle_frame(slot, frame, frame_len);
+                modbus_tcp_rx_reset(&slot->rx);
+            }
+            else
             {
-                exception = modbus_cb_write_single_coil(address, value);
-                if (exception == MODBUS_EXCEPTION_NONE)
-                {
-                    uint16_t coil_value = value ? 0xFF00U : 0x0000U;
-                    err = modbus_pdu_encode_write_single_response(
-                        &response_pdu, MODBUS_FC_WRITE_SINGLE_COIL, address,
-                        coil_value);
-                }
+                /* Partial frame - wait for more data */
             }
-            break;
         }
+    }
 
-        case MODBUS_FC_WRITE_SINGLE_REGISTER:
+    return stream_ok;
+}
+
+/**
+ * @brief Handle a single Modbus TCP connection
+ */
+static void modbus_handle_connection(modbus_connection_t *slot)
+{
+    struct netconn *conn = slot->conn;
+    struct netbuf  *buf;
+    err_t           err;
+    void           *data;
+    u16_t           len;
+    bool            stream_ok = true;
+
+    (void)modbus_tcp_rx_init(&slot->rx, MODBUS_RECV_TIMEOUT_MS);
+    modbus_admission_init_conn(&slot->bucket);
+    slot->skip      = 0U;
+    slot->tx_length = 0U;
+
+    while (stream_ok)
+    {
+        supervisor_checkin(slot->heartbeat);
+
+        /* Receive data */
+        err = netconn_recv(conn, &buf);
+        if (err == ERR_OK)
         {
-            uint16_t address;
-            uint16_t value;
+            slot->last_activity = xTaskGetTickCount();
 
-            err = modbus_pdu_decode_write_single_register_request(
-                &request_adu.pdu, &address, &value);
-            if (err == MODBUS_OK)
+            /* Walk every pbuf of the netbuf chain */
+            do
             {
-                exception = modbus_cb_write_single_register(address, value);
-                if (exception == MODBUS_EXCEPTION_NONE)
-                {
-                    err = modbus_pdu_encode_write_single_response(
-                        &response_pdu, MODBUS_FC_WRITE_SINGLE_REGISTER, address,
-                        value);
-                }
-            }
-            break;
-        }
+                netbuf_data(buf, &data, &len);
+                stream_ok = modbus_process_stream(slot, (const uint8_t *)data,
+                                                  (uint16_t)len);
+            } while (stream_ok && (netbuf_next(buf) >= 0));
 
-        case MODBUS_FC_WRITE_MULTIPLE_COILS:
-        {
-            uint16_t       start_address;
-            uint16_t       quantity;
-            const uint8_t *values;
+            netbuf_delete(buf);
 
-            err = modbus_pdu_decode_write_multiple_coils_request(
-                &request_adu.pdu, &start_address, &quantity, &values);
-            if (err == MODBUS_OK)
+            /* All responses of this receive go out in one write, which
+             * also carries the ACK; with nothing to send, ACK right away */
+            if (stream_ok && (slot->tx_length == 0U))
+            {
+                modbus_ack_now(conn);
+            }
+            else if (stream_ok && (modbus_flush_responses(slot) != ERR_OK))
             {
-                exception = modbus_cb_write_multiple_coils(start_address,
-                                                           quantity, values);
-                if (exception == MODBUS_EXCEPTION_NONE)
-                {
-                    err = modbus_pdu_encode_write_multiple_response(
-                        &response_pdu, MODBUS_FC_WRITE_MULTIPLE_COILS,
-                        start_address, quantity);
-                }
+                stream_ok = false;
             }
-            break;
         }
-
-        case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+        else if (err == ERR_TIMEOUT)
         {
-            uint16_t start_address;
-            uint16_t quantity;
-            uint16_t values[123];
+            TickType_t idle = xTaskGetTickCount() - slot->last_activity;
 
-            err = modbus_pdu_decode_write_multiple_registers_request(
-                &request_adu.pdu, &start_address, &quantity, values, 123U);
-            if (err == MODBUS_OK)
+            if (slot->evict)
+            {
+                LOG("Modbus: Connection evicted\n");
+                stream_ok = false;
+            }
+            else if (idle >= pdMS_TO_TICKS(MODBUS_IDLE_TIMEOUT_MS))
+            {
+                LOG("Modbus: Idle timeout\n");
+                stream_ok = false;
+            }
+            else if (idle >= pdMS_TO_TICKS(MODBUS_RECV_TIMEOUT_MS))
+            {
+                /* Idle for a full receive timeout - drop any partial frame */
+                modbus_tcp_rx_reset(&slot->rx);
+                slot->skip = 0U;
+            }
+            else
             {
-                exception = modbus_cb_write_multiple_registers(
-                    start_address, quantity, values);
-                if (exception == MODBUS_EXCEPTION_NONE)
-                {
-                    err = modbus_pdu_encode_write_multiple_response(
-                        &response_pdu, MODBUS_FC_WRITE_MULTIPLE_REGISTERS,
-                        start_address, quantity);
-                }
+                /* Keep waiting */
             }
-            break;
         }
+        else
+        {
+            /* Connection error - exit */
+            LOG("Modbus: Receive error: %d\n", err);
+            stream_ok = false;
+        }
+    }
+}
 
-        default:
-            exception = MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
-            break;
+/**
+ * @brief Process a Modbus TCP request and generate response
+ *
+ * The request is decoded in place through a PDU view and dispatched
+ * through the Modbus core's function code table, which writes the response
+ * PDU straight into the caller's TX buffer behind the space of the MBAP
+ * header. The header is written last, so the response is never staged or
+ * copied. The request has been routed to @p unit by its unit ID.
+ */
+static modbus_error_t modbus_process_request(const modbus_unit_t *unit,
+                                             const uint8_t       *request,
+                                             uint16_t             request_len,
+                                             uint8_t             *response,
+                                             uint16_t             response_size,
+                                             uint16_t            *response_len)
+{
+    modbus_pdu_view_t   request_pdu;
+    modbus_pdu_buffer_t response_pdu;
+    uint16_t            transaction_id;
+    uint8_t             unit_id;
+    modbus_error_t      err;
+
+#if MODBUS_ENABLE_LATENCY_STATS
+    /* Called with the register mutex held, so the context is ours */
+    modbus_slave_mark_frame_start(unit->ctx);
+#endif
+
+    /* Parse the TCP frame in place */
+    err = modbus_tcp_parse_frame_view(request, request_len, &transaction_id,
+                                      &unit_id, &request_pdu);
+    if (err != MODBUS_OK)
+    {
+        LOG("Modbus: Frame parse error: %d\n", (int)err);
+        return err;
     }
 
-    /* Build exception response if needed */
-    if (exception != MODBUS_EXCEPTION_NONE)
+    /* Already routed by its unit ID */
+    (void)unit_id;
+
+    if (response_size <= MODBUS_TCP_PDU_OFFSET)
     {
-        err = modbus_pdu_encode_exception(
-            &response_pdu, request_adu.pdu.function_code, exception);
+        return MODBUS_ERROR_BUFFER_OVERFLOW;
     }
 
+    (void)modbus_pdu_buffer_from_frame(
+        &response[MODBUS_TCP_PDU_OFFSET],
+        (uint16_t)(response_size - MODBUS_TCP_PDU_OFFSET), &response_pdu);
+
+    /* Dispatch by function code (exceptions are encoded by the core) */
+    err = modbus_slave_process_pdu_buffer(unit->ctx, &request_pdu,
+                                          &response_pdu);
     if (err != MODBUS_OK)
     {
         return err;
     }
 
-    /* Build response ADU */
-    response_adu.transaction_id = request_adu.transaction_id;
-    response_adu.protocol_id    = 0U;
-    response_adu.unit_id        = s_modbus_unit_id;
-    response_adu.pdu            = response_pdu;
-
-    /* Build TCP frame */
-    err = modbus_tcp_build_frame(&response_adu, response,
-                                 MODBUS_TCP_MAX_ADU_SIZE, response_len);
+    /* Put the MBAP header in front of the response PDU */
+    err = modbus_tcp_build_frame_in_place(
+        transaction_id, unit->unit_id, response,
+        (uint16_t)(1U + response_pdu.data_length), response_size,
+        response_len);
 
     return err;
 }
+
+#endif /* !MODBUS_TCP_RAW */
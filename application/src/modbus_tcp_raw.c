@@ -0,0 +1,723 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Server on the lwIP Raw API
+ *
+ * Every callback of this file runs in the TCP/IP thread, one at a time, so
+ * the connection table and the shared TX buffer need no lock. Each
+ * connection keeps its own frame receiver for requests split across
+ * segments; the responses of one receive are collected in the TX buffer
+ * and copied into the send buffer of the PCB with one tcp_write() before
+ * the callback returns. The register mutex is taken around each dispatch
+ * with a bounded wait, as in modbus_udp.c. See modbus_tcp_raw.h.
+ */
+
+#include "modbus_tcp_raw.h"
+
+#if MODBUS_TCP_RAW
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "boot.h"
+#include "ethernetif.h"
+#include "log.h"
+#include "lwip/err.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "modbus_admission.h"
+#include "modbus_gateway.h"
+#include "modbus_internal.h"
+#include "modbus_response_cache.h"
+#include "modbus_units.h"
+#include "task.h"
+
+#if MODBUS_GATEWAY
+#error "The gateway blocks the TCP/IP thread; build it with the netconn server"
+#endif
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Modbus TCP port number */
+#define MODBUS_TCP_RAW_PORT 502U
+
+/** Longest wait for the register mutex, in the TCP/IP thread */
+#define MODBUS_TCP_RAW_MUTEX_WAIT_MS 5U
+
+/** A partial frame older than this is dropped */
+#define MODBUS_TCP_RAW_RECV_TIMEOUT_MS 5000U
+
+/** Connections without a request for this long are closed */
+#define MODBUS_TCP_RAW_IDLE_TIMEOUT_MS 60000U
+
+/** A connection idle for at least this long may be evicted for a new one */
+#define MODBUS_TCP_RAW_EVICT_MIN_IDLE_MS 1000U
+
+/** tcp_poll() period, in TCP coarse timer ticks of 500 ms */
+#define MODBUS_TCP_RAW_POLL_INTERVAL 2U
+
+/** TCP keepalive: first probe after this idle time, then every interval */
+#define MODBUS_TCP_RAW_KEEPALIVE_IDLE_MS     10000U
+#define MODBUS_TCP_RAW_KEEPALIVE_INTERVAL_MS 2000U
+#define MODBUS_TCP_RAW_KEEPALIVE_COUNT       3U
+
+/** Maximum-size responses collected into one tcp_write() */
+#define MODBUS_TCP_RAW_PIPELINE_DEPTH 4U
+
+/** MBAP header size; the function code follows it */
+#define MODBUS_TCP_RAW_MBAP_SIZE 7U
+
+/** Offset of the MBAP length field, which counts the bytes behind it */
+#define MODBUS_TCP_RAW_MBAP_LENGTH_OFFSET 4U
+
+/* Every connection holds a PCB for its lifetime */
+_Static_assert(MODBUS_TCP_RAW_MAX_CONNECTIONS <= MODBUS_TCP_PCBS,
+               "MEMP_NUM_TCP_PCB is sized for fewer Modbus connections");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One connection
+ *
+ * @c pcb is NULL while the entry is free. @c skip counts the bytes of a
+ * frame for a unit not served here that have yet to arrive.
+ */
+typedef struct
+{
+    struct tcp_pcb         *pcb;           /**< PCB, NULL if free */
+    TickType_t              last_activity; /**< Tick of the last receive */
+    modbus_tcp_rx_context_t rx;            /**< Receiver of split frames */
+    uint16_t                skip;          /**< Bytes of a frame to pass */
+    modbus_bucket_t         bucket;        /**< Admission bucket */
+} modbus_tcp_raw_conn_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Register mutex owned by the Modbus TCP task */
+static SemaphoreHandle_t s_register_mutex;
+
+/** Connections (TCP/IP thread only) */
+static modbus_tcp_raw_conn_t s_conns[MODBUS_TCP_RAW_MAX_CONNECTIONS];
+
+/** Responses of the receive in progress (TCP/IP thread only) */
+static uint8_t
+    s_tx_buffer[MODBUS_TCP_RAW_PIPELINE_DEPTH * MODBUS_TCP_MAX_ADU_SIZE];
+static uint16_t s_tx_length;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Get the length of a frame that is to be dropped unseen
+ *
+ * Looks at the MBAP header only. A header with an impossible length is not
+ * skipped but left to the receiver, which closes the stream.
+ *
+ * @param[in] data   Start of a frame
+ * @param[in] length Bytes available from @p data
+ * @return Length of the whole frame if it is for a unit not served here,
+ *         0 if it is to be processed or the header is incomplete
+ */
+static uint16_t modbus_tcp_raw_foreign_length(const uint8_t *data,
+                                              uint16_t       length)
+{
+    uint16_t frame_len;
+
+    if ((length < MODBUS_TCP_RAW_MBAP_SIZE) ||
+        (modbus_units_lookup(data[MODBUS_TCP_RAW_MBAP_SIZE - 1U]) != NULL))
+    {
+        return 0U;
+    }
+
+    frame_len = (uint16_t)(
+        (MODBUS_TCP_RAW_MBAP_SIZE - 1U) +
+        (((uint16_t)data[MODBUS_TCP_RAW_MBAP_LENGTH_OFFSET] << 8) |
+         data[MODBUS_TCP_RAW_MBAP_LENGTH_OFFSET + 1U]));
+
+    /* At least a function code, at most a full ADU */
+    return ((frame_len > MODBUS_TCP_RAW_MBAP_SIZE) &&
+            (frame_len <= MODBUS_TCP_MAX_ADU_SIZE))
+               ? frame_len
+               : 0U;
+}
+
+/**
+ * @brief Queue the collected responses on a connection and send them
+ *
+ * @param[in] conn Connection
+ * @return ERR_OK on success or when nothing is collected
+ */
+static err_t modbus_tcp_raw_flush(modbus_tcp_raw_conn_t *conn)
+{
+    err_t err = ERR_OK;
+
+    if (s_tx_length > 0U)
+    {
+        /* The master waits for its responses, so the send buffer only fills
+         * up if it stops reading them; what does not fit is lost */
+        if (tcp_sndbuf(conn->pcb) < s_tx_length)
+        {
+            err = ERR_MEM;
+        }
+        else
+        {
+            err = tcp_write(conn->pcb, s_tx_buffer, s_tx_length,
+                            TCP_WRITE_FLAG_COPY);
+        }
+
+        if (err == ERR_OK)
+        {
+            (void)tcp_output(conn->pcb);
+        }
+        else
+        {
+            LOG("Modbus raw: Write error: %d\n", err);
+            metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+        }
+        s_tx_length = 0U;
+    }
+
+    return err;
+}
+
+/**
+ * @brief Collect a SLAVE DEVICE BUSY answer to a request
+ *
+ * @param[in] conn    Connection
+ * @param[in] frame   Complete request frame
+ * @param[in] unit_id Unit ID of the response
+ */
+static void modbus_tcp_raw_busy(modbus_tcp_raw_conn_t *conn,
+                                const uint8_t *frame, uint8_t unit_id)
+{
+    modbus_pdu_buffer_t response_pdu;
+    uint8_t            *response;
+    uint16_t            response_size;
+    uint16_t            response_len = 0U;
+
+    /* MBAP header, function code and exception code */
+    if ((sizeof(s_tx_buffer) - s_tx_length) < (MODBUS_TCP_PDU_OFFSET + 2U))
+    {
+        (void)modbus_tcp_raw_flush(conn);
+    }
+
+    response      = &s_tx_buffer[s_tx_length];
+    response_size = (uint16_t)(sizeof(s_tx_buffer) - s_tx_length);
+    (void)modbus_pdu_buffer_from_frame(
+        &response[MODBUS_TCP_PDU_OFFSET],
+        (uint16_t)(response_size - MODBUS_TCP_PDU_OFFSET), &response_pdu);
+
+    if ((modbus_pdu_buffer_encode_exception(
+             &response_pdu, frame[MODBUS_TCP_RAW_MBAP_SIZE],
+             MODBUS_EXCEPTION_SLAVE_DEVICE_BUSY) == MODBUS_OK) &&
+        (modbus_tcp_build_frame_in_place(
+             modbus_tcp_get_transaction_id(frame), unit_id, response,
+             (uint16_t)(1U + response_pdu.data_length), response_size,
+             &response_len) == MODBUS_OK))
+    {
+        s_tx_length = (uint16_t)(s_tx_length + response_len);
+    }
+}
+
+/**
+ * @brief Process a Modbus TCP request and build its response in place
+ *
+ * Called with the register mutex held. The response PDU is written behind
+ * the space of the MBAP header, which is then filled in front of it.
+ */
+static modbus_error_t modbus_tcp_raw_process_request(
+    const modbus_unit_t *unit, const uint8_t *request, uint16_t request_len,
+    uint8_t *response, uint16_t response_size, uint16_t *response_len)
+{
+    modbus_pdu_view_t   request_pdu;
+    modbus_pdu_buffer_t response_pdu;
+    uint16_t            transaction_id;
+    uint8_t             unit_id;
+    modbus_error_t      err;
+
+#if MODBUS_ENABLE_LATENCY_STATS
+    modbus_slave_mark_frame_start(unit->ctx);
+#endif
+
+    err = modbus_tcp_parse_frame_view(request, request_len, &transaction_id,
+                                      &unit_id, &request_pdu);
+    if (err != MODBUS_OK)
+    {
+        return err;
+    }
+
+    /* Already routed by its unit ID */
+    (void)unit_id;
+
+    if (response_size <= MODBUS_TCP_PDU_OFFSET)
+    {
+        return MODBUS_ERROR_BUFFER_OVERFLOW;
+    }
+
+    (void)modbus_pdu_buffer_from_frame(
+        &response[MODBUS_TCP_PDU_OFFSET],
+        (uint16_t)(response_size - MODBUS_TCP_PDU_OFFSET), &response_pdu);
+
+    err = modbus_slave_process_pdu_buffer(unit->ctx, &request_pdu,
+                                          &response_pdu);
+    if (err != MODBUS_OK)
+    {
+        return err;
+    }
+
+    return modbus_tcp_build_frame_in_place(
+        transaction_id, unit->unit_id, response,
+        (uint16_t)(1U + response_pdu.data_length), response_size,
+        response_len);
+}
+
+/**
+ * @brief Process one complete MBAP frame and collect its response
+ *
+ * @param[in,out] conn      Connection
+ * @param[in]     frame     Complete frame (pbuf payload or receiver buffer)
+ * @param[in]     frame_len Frame length in bytes
+ */
+static void modbus_tcp_raw_handle_frame(modbus_tcp_raw_conn_t *conn,
+                                        const uint8_t         *frame,
+                                        uint16_t               frame_len)
+{
+    const modbus_unit_t *unit = NULL;
+    uint16_t             response_len = 0U;
+    uint16_t             response_max;
+    modbus_admission_t   admission;
+    modbus_error_t       modbus_err;
+
+    if (frame_len > MODBUS_TCP_RAW_MBAP_SIZE)
+    {
+        unit = modbus_units_lookup(frame[MODBUS_TCP_RAW_MBAP_SIZE - 1U]);
+    }
+    if (unit == NULL)
+    {
+        /* Only a frame whose header arrived split gets here, the others
+         * are skipped in the stream */
+        metrics_add(METRIC_MODBUS_UNIT_DROP, 1U);
+        return;
+    }
+
+    admission = modbus_admission_check(&conn->bucket, unit,
+                                       frame[MODBUS_TCP_RAW_MBAP_SIZE]);
+    if (admission != MODBUS_ADMIT_OK)
+    {
+        metrics_add((admission == MODBUS_ADMIT_SHED_UNIT)
+                        ? METRIC_MODBUS_SHED_UNIT
+                        : METRIC_MODBUS_SHED_CONN,
+                    1U);
+        modbus_tcp_raw_busy(conn, frame, unit->unit_id);
+        return;
+    }
+
+    /* Only reserve as much TX space as this function code can answer with */
+    response_max = (uint16_t)(MODBUS_TCP_RAW_MBAP_SIZE +
+                              modbus_slave_get_response_bound(
+                                  unit->ctx, frame[MODBUS_TCP_RAW_MBAP_SIZE]));
+    if ((sizeof(s_tx_buffer) - s_tx_length) < response_max)
+    {
+        (void)modbus_tcp_raw_flush(conn);
+    }
+
+    if (xSemaphoreTake(s_register_mutex,
+                       pdMS_TO_TICKS(MODBUS_TCP_RAW_MUTEX_WAIT_MS)) != pdTRUE)
+    {
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+        modbus_tcp_raw_busy(conn, frame, unit->unit_id);
+        return;
+    }
+#if MODBUS_RESPONSE_CACHE
+    response_len = modbus_response_cache_lookup(
+        frame, frame_len, &s_tx_buffer[s_tx_length],
+        (uint16_t)(sizeof(s_tx_buffer) - s_tx_length));
+    if (response_len > 0U)
+    {
+        modbus_err = MODBUS_OK;
+    }
+    else
+#endif
+    {
+        modbus_err = modbus_tcp_raw_process_request(
+            unit, frame, frame_len, &s_tx_buffer[s_tx_length],
+            (uint16_t)(sizeof(s_tx_buffer) - s_tx_length), &response_len);
+#if MODBUS_RESPONSE_CACHE
+        modbus_response_cache_update(
+            frame, frame_len, &s_tx_buffer[s_tx_length],
+            (modbus_err == MODBUS_OK) ? response_len : 0U);
+#endif
+    }
+    (void)xSemaphoreGive(s_register_mutex);
+
+    if (modbus_err == MODBUS_OK)
+    {
+        s_tx_length = (uint16_t)(s_tx_length + response_len);
+    }
+    else
+    {
+        LOG("Modbus raw: Process error: %d\n", (int)modbus_err);
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+    }
+}
+
+/**
+ * @brief Feed received bytes through the connection's frame receiver
+ *
+ * Frames that arrive whole are processed in place from the pbuf payload;
+ * only frames split across segments are reassembled. A frame whose header
+ * shows a unit not served here is skipped before either.
+ *
+ * @param[in,out] conn   Connection
+ * @param[in]     data   Received bytes
+ * @param[in]     length Number of received bytes
+ * @return false if the stream is corrupt and the connection must be closed
+ */
+static bool modbus_tcp_raw_process_stream(modbus_tcp_raw_conn_t *conn,
+                                          const uint8_t         *data,
+                                          uint16_t               length)
+{
+    bool     stream_ok = true;
+    uint16_t offset    = 0U;
+
+    while ((offset < length) && stream_ok)
+    {
+        uint16_t remaining = (uint16_t)(length - offset);
+        uint16_t frame_len = 0U;
+
+        if ((conn->skip == 0U) && (conn->rx.index == 0U))
+        {
+            conn->skip =
+                modbus_tcp_raw_foreign_length(&data[offset], remaining);
+            if (conn->skip > 0U)
+            {
+                metrics_add(METRIC_MODBUS_UNIT_DROP, 1U);
+            }
+            else
+            {
+                frame_len =
+                    modbus_tcp_get_frame_length(&data[offset], remaining);
+            }
+        }
+
+        if (conn->skip > 0U)
+        {
+            uint16_t skipped = (remaining < conn->skip) ? remaining
+                                                        : conn->skip;
+            conn->skip = (uint16_t)(conn->skip - skipped);
+            offset     = (uint16_t)(offset + skipped);
+        }
+        else if (frame_len > 0U)
+        {
+            modbus_tcp_raw_handle_frame(conn, &data[offset], frame_len);
+            offset = (uint16_t)(offset + frame_len);
+        }
+        else
+        {
+            uint16_t       consumed   = 0U;
+            modbus_error_t modbus_err = modbus_tcp_rx_process_data(
+                &conn->rx, &data[offset], remaining,
+                (uint32_t)xTaskGetTickCount(), &consumed);
+            offset = (uint16_t)(offset + consumed);
+
+            if (modbus_err != MODBUS_OK)
+            {
+                LOG("Modbus raw: Stream framing error: %d\n", (int)modbus_err);
+                metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+                stream_ok = false;
+            }
+            else if (modbus_tcp_rx_is_complete(&conn->rx))
+            {
+                const uint8_t *frame;
+
+                (void)modbus_tcp_rx_get_frame(&conn->rx, &frame, &frame_len);
+                modbus_tcp_raw_handle_frame(conn, frame, frame_len);
+                modbus_tcp_rx_reset(&conn->rx);
+            }
+            else
+            {
+                /* Partial frame - wait for more data */
+            }
+        }
+    }
+
+    return stream_ok;
+}
+
+/**
+ * @brief Detach a connection from its PCB and close it
+ *
+ * @param[in,out] conn  Connection, free on return
+ * @param[in]     abort Reset the connection instead of closing it
+ * @return ERR_ABRT if the PCB was aborted, which a callback of that PCB
+ *         must return, else ERR_OK
+ */
+static err_t modbus_tcp_raw_close(modbus_tcp_raw_conn_t *conn, bool abort)
+{
+    struct tcp_pcb *pcb = conn->pcb;
+    err_t           err = ERR_OK;
+
+    conn->pcb = NULL;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0U);
+
+    if (abort || (tcp_close(pcb) != ERR_OK))
+    {
+        tcp_abort(pcb);
+        err = ERR_ABRT;
+    }
+
+    return err;
+}
+
+/**
+ * @brief tcp_recv() callback: serve the requests of a received pbuf chain
+ */
+static err_t modbus_tcp_raw_recv(void *arg, struct tcp_pcb *pcb,
+                                 struct pbuf *p, err_t err)
+{
+    modbus_tcp_raw_conn_t *conn      = (modbus_tcp_raw_conn_t *)arg;
+    bool                   stream_ok = true;
+
+    if (p == NULL)
+    {
+        LOG("Modbus raw: Connection closed\n");
+        return modbus_tcp_raw_close(conn, false);
+    }
+    if (err != ERR_OK)
+    {
+        pbuf_free(p);
+        return err;
+    }
+
+    conn->last_activity = xTaskGetTickCount();
+    s_tx_length         = 0U;
+
+    for (struct pbuf *q = p; (q != NULL) && stream_ok; q = q->next)
+    {
+        stream_ok = modbus_tcp_raw_process_stream(
+            conn, (const uint8_t *)q->payload, (uint16_t)q->len);
+    }
+
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    /* All responses of this receive go out in one segment, which also
+     * carries the ACK; with nothing to send, ACK right away so a master
+     * running Nagle sends the rest of a split request */
+    if (stream_ok && (s_tx_length == 0U))
+    {
+        tcp_ack_now(pcb);
+        (void)tcp_output(pcb);
+    }
+    else if (stream_ok && (modbus_tcp_raw_flush(conn) != ERR_OK))
+    {
+        stream_ok = false;
+    }
+    else
+    {
+        /* Sent, or the stream is lost */
+    }
+
+    s_tx_length = 0U;
+
+    return stream_ok ? ERR_OK : modbus_tcp_raw_close(conn, true);
+}
+
+/**
+ * @brief tcp_err() callback: the PCB is already freed by lwIP
+ */
+static void modbus_tcp_raw_error(void *arg, err_t err)
+{
+    modbus_tcp_raw_conn_t *conn = (modbus_tcp_raw_conn_t *)arg;
+
+    LOG("Modbus raw: Connection error: %d\n", err);
+    if (conn != NULL)
+    {
+        conn->pcb = NULL;
+    }
+}
+
+/**
+ * @brief tcp_poll() callback: idle timeout and partial frame timeout
+ */
+static err_t modbus_tcp_raw_poll(void *arg, struct tcp_pcb *pcb)
+{
+    modbus_tcp_raw_conn_t *conn = (modbus_tcp_raw_conn_t *)arg;
+    TickType_t             idle = xTaskGetTickCount() - conn->last_activity;
+    err_t                  err  = ERR_OK;
+
+    (void)pcb;
+
+    if (idle >= pdMS_TO_TICKS(MODBUS_TCP_RAW_IDLE_TIMEOUT_MS))
+    {
+        LOG("Modbus raw: Idle timeout\n");
+        err = modbus_tcp_raw_close(conn, false);
+    }
+    else if (idle >= pdMS_TO_TICKS(MODBUS_TCP_RAW_RECV_TIMEOUT_MS))
+    {
+        /* Idle for a full receive timeout - drop any partial frame */
+        modbus_tcp_rx_reset(&conn->rx);
+        conn->skip = 0U;
+    }
+    else
+    {
+        /* Keep waiting */
+    }
+
+    return err;
+}
+
+/**
+ * @brief Get a free connection, evicting the least recently used idle one
+ *        if there is none
+ *
+ * @return Free connection, NULL if all are busy
+ */
+static modbus_tcp_raw_conn_t *modbus_tcp_raw_alloc(void)
+{
+    modbus_tcp_raw_conn_t *victim   = NULL;
+    TickType_t             now      = xTaskGetTickCount();
+    TickType_t             max_idle = pdMS_TO_TICKS(
+        MODBUS_TCP_RAW_EVICT_MIN_IDLE_MS);
+
+    for (uint32_t i = 0U; i < MODBUS_TCP_RAW_MAX_CONNECTIONS; i++)
+    {
+        modbus_tcp_raw_conn_t *conn = &s_conns[i];
+        TickType_t             idle = now - conn->last_activity;
+
+        if (conn->pcb == NULL)
+        {
+            return conn;
+        }
+        if (idle >= max_idle)
+        {
+            victim   = conn;
+            max_idle = idle;
+        }
+    }
+
+    if (victim != NULL)
+    {
+        LOG("Modbus raw: Evicting connection idle for %lu ms\n",
+            (unsigned long)pdTICKS_TO_MS(max_idle));
+        (void)modbus_tcp_raw_close(victim, true);
+    }
+
+    return victim;
+}
+
+/**
+ * @brief tcp_accept() callback: take a connection and tune its PCB
+ *
+ * Nagle is disabled (unless the network profile keeps it, see
+ * NET_PROFILE_TCP_NODELAY) and keepalive probes detect masters that
+ * vanished without closing the connection, as for the netconn server.
+ * Responses are marked as control traffic (ETHERNETIF_TOS_CONTROL).
+ */
+static err_t modbus_tcp_raw_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    modbus_tcp_raw_conn_t *conn;
+
+    (void)arg;
+
+    if ((err != ERR_OK) || (pcb == NULL))
+    {
+        return ERR_VAL;
+    }
+
+    conn = modbus_tcp_raw_alloc();
+    if (conn == NULL)
+    {
+        LOG("Modbus raw: No free connection slot, rejecting\n");
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    conn->pcb           = pcb;
+    conn->last_activity = xTaskGetTickCount();
+    conn->skip          = 0U;
+    (void)modbus_tcp_rx_init(&conn->rx, MODBUS_TCP_RAW_RECV_TIMEOUT_MS);
+    modbus_admission_init_conn(&conn->bucket);
+
+#if NET_PROFILE_TCP_NODELAY
+    tcp_nagle_disable(pcb);
+#endif
+    tcp_setprio(pcb, TCP_PRIO_MAX);
+    ip_set_option(pcb, SOF_KEEPALIVE);
+    pcb->keep_idle  = MODBUS_TCP_RAW_KEEPALIVE_IDLE_MS;
+    pcb->keep_intvl = MODBUS_TCP_RAW_KEEPALIVE_INTERVAL_MS;
+    pcb->keep_cnt   = MODBUS_TCP_RAW_KEEPALIVE_COUNT;
+    pcb->tos        = ETHERNETIF_TOS_CONTROL;
+
+    tcp_arg(pcb, conn);
+    tcp_recv(pcb, modbus_tcp_raw_recv);
+    tcp_err(pcb, modbus_tcp_raw_error);
+    tcp_poll(pcb, modbus_tcp_raw_poll, MODBUS_TCP_RAW_POLL_INTERVAL);
+
+    LOG("Modbus raw: New connection accepted\n");
+
+    return ERR_OK;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_tcp_raw_start(SemaphoreHandle_t register_mutex)
+{
+    struct tcp_pcb *pcb;
+    struct tcp_pcb *listen_pcb = NULL;
+
+    s_register_mutex = register_mutex;
+
+    LOCK_TCPIP_CORE();
+    pcb = tcp_new();
+    if (pcb != NULL)
+    {
+        if (tcp_bind(pcb, IP_ADDR_ANY, MODBUS_TCP_RAW_PORT) == ERR_OK)
+        {
+            /* SYNs beyond the backlog are refused by lwIP, so pending
+             * connections cannot use up MEMP_NUM_TCP_PCB */
+            listen_pcb = tcp_listen_with_backlog(
+                pcb, (u8_t)MODBUS_TCP_RAW_MAX_CONNECTIONS);
+        }
+        if (listen_pcb != NULL)
+        {
+            tcp_accept(listen_pcb, modbus_tcp_raw_accept);
+        }
+        else
+        {
+            (void)tcp_close(pcb);
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+
+    if (listen_pcb == NULL)
+    {
+        printf("Modbus raw: Failed to listen on port %u\n",
+               MODBUS_TCP_RAW_PORT);
+        return;
+    }
+
+    printf("Modbus TCP Server (raw API) listening on port %u (net profile "
+           "%s)\n",
+           MODBUS_TCP_RAW_PORT, NET_PROFILE_NAME);
+    boot_event_set(BOOT_EVENT_SERVICE_UP);
+}
+
+#endif /* MODBUS_TCP_RAW */
@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus/UDP Transport
+ *
+ * A raw UDP PCB whose receive callback runs in the TCP/IP thread: the
+ * request is parsed where it lies in the received pbuf (copied only when
+ * lwIP chained it), the response PDU is built straight into the pbuf that
+ * is sent back, behind the space of its MBAP header. The transport has its
+ * own slave context and takes the register mutex shared with the other
+ * transports around each dispatch, with the callbacks that refuse the
+ * digital output writes (modbus_units.h). Another transport holding the mutex
+ * runs at a lower priority than the TCP/IP thread and is boosted by
+ * priority inheritance; the wait is bounded all the same, so a stuck
+ * holder costs UDP requests, not the network stack.
+ */
+
+#include "modbus_udp.h"
+
+#if MODBUS_UDP
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ethernetif.h"
+#include "jerry_device_registers.h"
+#include "log.h"
+#include "lwip/ip_addr.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "modbus_files.h"
+#include "modbus_internal.h"
+#include "modbus_units.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Longest wait for the register mutex, in the TCP/IP thread */
+#define MODBUS_UDP_MUTEX_WAIT_MS 5U
+
+/** MBAP header size; the function code follows it */
+#define MODBUS_UDP_MBAP_SIZE 7U
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Last write of one master, kept to answer its retries
+ */
+typedef struct
+{
+    bool      used;                              /**< Entry holds a write */
+    ip_addr_t addr;                              /**< Master address */
+    u16_t     port;                              /**< Master UDP port */
+    uint32_t  last_used;                         /**< Use stamp, for eviction */
+    uint16_t  transaction_id;                    /**< Transaction ID */
+    uint16_t  request_len;                       /**< Request length */
+    uint16_t  request_crc;                       /**< CRC-16 of the request */
+    uint16_t  response_len;                      /**< Response length */
+    uint8_t   response[MODBUS_TCP_MAX_ADU_SIZE]; /**< Response sent */
+} modbus_udp_master_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Register mutex owned by the Modbus TCP task */
+static SemaphoreHandle_t s_register_mutex;
+
+/** Modbus unit ID */
+static uint8_t s_unit_id;
+
+/** Slave context of the UDP transport (TCP/IP thread only) */
+static modbus_context_storage_t s_udp_ctx_storage;
+static modbus_context_t *const  s_udp_ctx =
+    (modbus_context_t *)&s_udp_ctx_storage;
+
+/** Request of a chained pbuf, made contiguous */
+static uint8_t s_rx_buffer[MODBUS_TCP_MAX_ADU_SIZE];
+
+/** Last writes, and the stamp of the latest use */
+static modbus_udp_master_t s_masters[MODBUS_UDP_MAX_MASTERS];
+static uint32_t            s_use_count;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Whether a function code only reads, so running it twice is harmless
+ */
+static bool modbus_udp_is_read(uint8_t function_code)
+{
+    return ((function_code >= MODBUS_FC_READ_COILS) &&
+            (function_code <= MODBUS_FC_READ_INPUT_REGISTERS)) ||
+           (function_code == MODBUS_FC_READ_SCATTERED_REGISTERS);
+}
+
+/**
+ * @brief Find the entry of a master, or the one to reuse for it
+ *
+ * @param[in] addr Master address
+ * @param[in] port Master UDP port
+ * @return Entry of the master if it has one, else a free or the least
+ *         recently used entry (not yet marked used)
+ */
+static modbus_udp_master_t *modbus_udp_find_master(const ip_addr_t *addr,
+                                                   u16_t            port)
+{
+    modbus_udp_master_t *victim = &s_masters[0];
+
+    for (uint32_t i = 0U; i < MODBUS_UDP_MAX_MASTERS; i++)
+    {
+        modbus_udp_master_t *entry = &s_masters[i];
+
+        if (entry->used && (entry->port == port) &&
+            ip_addr_cmp(&entry->addr, addr))
+        {
+            return entry;
+        }
+        if (!entry->used)
+        {
+            if (victim->used)
+            {
+                victim = entry;
+            }
+        }
+        else if (victim->used && (entry->last_used < victim->last_used))
+        {
+            victim = entry;
+        }
+        else
+        {
+            /* Keep the current victim */
+        }
+    }
+
+    victim->used = false;
+    return victim;
+}
+
+/**
+ * @brief Send a response frame to a master
+ */
+static void modbus_udp_send(struct udp_pcb *pcb, const uint8_t *frame,
+                            uint16_t frame_len, const ip_addr_t *addr,
+                            u16_t port)
+{
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, frame_len, PBUF_RAM);
+
+    if (p == NULL)
+    {
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+        return;
+    }
+
+    (void)pbuf_take(p, frame, frame_len);
+    if (udp_sendto(pcb, p, addr, port) != ERR_OK)
+    {
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+    }
+    pbuf_free(p);
+}
+
+/**
+ * @brief Process a Modbus request and build its response in place
+ *
+ * The response PDU is written straight into @p response behind the space
+ * of the MBAP header, which is then filled in front of it.
+ */
+static modbus_error_t modbus_udp_process_request(const uint8_t *request,
+                                                 uint16_t       request_len,
+                                                 uint8_t       *response,
+                                                 uint16_t       response_size,
+                                                 uint16_t      *response_len)
+{
+    modbus_pdu_view_t   request_pdu;
+    modbus_pdu_buffer_t response_pdu;
+    uint16_t            transaction_id;
+    uint8_t             unit_id;
+    modbus_error_t      err;
+
+    err = modbus_tcp_parse_frame_view(request, request_len, &transaction_id,
+                                      &unit_id, &request_pdu);
+    if (err != MODBUS_OK)
+    {
+        return err;
+    }
+
+    /* Check unit ID (0 = broadcast, or match our ID) */
+    if ((unit_id != 0U) && (unit_id != s_unit_id))
+    {
+        return MODBUS_ERROR_INVALID_PARAM;
+    }
+
+    if (response_size <= MODBUS_TCP_PDU_OFFSET)
+    {
+        return MODBUS_ERROR_BUFFER_OVERFLOW;
+    }
+
+    (void)modbus_pdu_buffer_from_frame(
+        &response[MODBUS_TCP_PDU_OFFSET],
+        (uint16_t)(response_size - MODBUS_TCP_PDU_OFFSET), &response_pdu);
+
+    if (xSemaphoreTake(s_register_mutex,
+                       pdMS_TO_TICKS(MODBUS_UDP_MUTEX_WAIT_MS)) != pdTRUE)
+    {
+        return MODBUS_ERROR_TIMEOUT;
+    }
+    err = modbus_slave_process_pdu_buffer(s_udp_ctx, &request_pdu,
+                                          &response_pdu);
+    (void)xSemaphoreGive(s_register_mutex);
+
+    if (err != MODBUS_OK)
+    {
+        return err;
+    }
+
+    return modbus_tcp_build_frame_in_place(
+        transaction_id, s_unit_id, response,
+        (uint16_t)(1U + response_pdu.data_length), response_size,
+        response_len);
+}
+
+/**
+ * @brief UDP receive callback, one MBAP frame per datagram
+ */
+static void modbus_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                            const ip_addr_t *addr, u16_t port)
+{
+    const uint8_t       *request;
+    uint16_t             request_len = p->tot_len;
+    uint16_t             request_crc = 0U;
+    uint16_t             response_len = 0U;
+    modbus_udp_master_t *master       = NULL;
+    struct pbuf         *q;
+    modbus_error_t       err;
+
+    (void)arg;
+
+    if (request_len > sizeof(s_rx_buffer))
+    {
+        LOG("Modbus UDP: Datagram too long: %u\n", (unsigned int)request_len);
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+        pbuf_free(p);
+        return;
+    }
+    if (p->len == p->tot_len)
+    {
+        request = (const uint8_t *)p->payload;
+    }
+    else
+    {
+        (void)pbuf_copy_partial(p, s_rx_buffer, request_len, 0U);
+        request = s_rx_buffer;
+    }
+
+    if (modbus_tcp_get_frame_length(request, request_len) != request_len)
+    {
+        LOG("Modbus UDP: Framing error\n");
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+        pbuf_free(p);
+        return;
+    }
+
+    /* A write retried with the same transaction ID is answered again, not
+     * executed again */
+    if (!modbus_udp_is_read(request[MODBUS_UDP_MBAP_SIZE]))
+    {
+        request_crc = modbus_crc16(request, request_len);
+        master      = modbus_udp_find_master(addr, port);
+        if (master->used &&
+            (master->transaction_id ==
+             modbus_tcp_get_transaction_id(request)) &&
+            (master->request_len == request_len) &&
+            (master->request_crc == request_crc))
+        {
+            master->last_used = ++s_use_count;
+            metrics_add(METRIC_MODBUS_UDP_RETRY, 1U);
+            modbus_udp_send(pcb, master->response, master->response_len, addr,
+                            port);
+            pbuf_free(p);
+            return;
+        }
+    }
+
+    /* Only reserve as much space as this function code can answer with */
+    q = pbuf_alloc(
+        PBUF_TRANSPORT,
+        (u16_t)(MODBUS_UDP_MBAP_SIZE +
+                modbus_slave_get_response_bound(
+                    s_udp_ctx, request[MODBUS_UDP_MBAP_SIZE])),
+        PBUF_RAM);
+    if (q == NULL)
+    {
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+        pbuf_free(p);
+        return;
+    }
+
+    err = modbus_udp_process_request(request, request_len,
+                                     (uint8_t *)q->payload, q->len,
+                                     &response_len);
+    pbuf_free(p);
+
+    if (err == MODBUS_OK)
+    {
+        if (master != NULL)
+        {
+            master->used           = true;
+            master->addr           = *addr;
+            master->port           = port;
+            master->last_used      = ++s_use_count;
+            master->transaction_id = modbus_tcp_get_transaction_id(
+                (const uint8_t *)q->payload);
+            master->request_len    = request_len;
+            master->request_crc    = request_crc;
+            master->response_len   = response_len;
+            (void)memcpy(master->response, q->payload, response_len);
+        }
+
+        pbuf_realloc(q, response_len);
+        if (udp_sendto(pcb, q, addr, port) != ERR_OK)
+        {
+            metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+        }
+    }
+    else
+    {
+        LOG("Modbus UDP: Process error: %d\n", (int)err);
+        metrics_add(METRIC_MODBUS_TCP_ERR, 1U);
+    }
+    pbuf_free(q);
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void modbus_udp_start(SemaphoreHandle_t register_mutex, uint8_t unit_id)
+{
+    modbus_config_t modbus_config;
+    struct udp_pcb *pcb;
+    err_t           err = ERR_MEM;
+
+    s_register_mutex = register_mutex;
+    s_unit_id        = unit_id;
+
+    (void)memset(&modbus_config, 0, sizeof(modbus_config));
+    modbus_config.mode     = MODBUS_MODE_SLAVE;
+    modbus_config.protocol = MODBUS_PROTOCOL_TCP;
+    modbus_config.unit_id  = s_unit_id;
+    (void)modbus_init(s_udp_ctx, &modbus_config);
+    (void)modbus_slave_set_device_id(s_udp_ctx, &jerry_device_device_id);
+    (void)modbus_slave_set_file_reader(s_udp_ctx, modbus_files_read_record);
+    (void)modbus_slave_set_file_mapper(s_udp_ctx, modbus_files_map_record);
+    (void)modbus_slave_set_file_writer(s_udp_ctx, modbus_files_write_record);
+    /* No write may wait for the output expanders here (modbus_units.h) */
+    (void)modbus_slave_set_callbacks(s_udp_ctx, &modbus_units_tcpip_callbacks);
+
+    LOCK_TCPIP_CORE();
+    pcb = udp_new();
+    if (pcb != NULL)
+    {
+        pcb->tos = ETHERNETIF_TOS_CONTROL;
+        err = udp_bind(pcb, IP_ADDR_ANY, MODBUS_UDP_PORT);
+        if (err == ERR_OK)
+        {
+            udp_recv(pcb, modbus_udp_recv, NULL);
+        }
+        else
+        {
+            udp_remove(pcb);
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+
+    if (err != ERR_OK)
+    {
+        printf("Modbus UDP: Failed to bind port %u\n", MODBUS_UDP_PORT);
+        return;
+    }
+
+    printf("Modbus UDP listening on port %u\n", MODBUS_UDP_PORT);
+}
+
+#endif /* MODBUS_UDP */
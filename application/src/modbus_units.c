@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Modbus TCP Units
+ *
+ * The table is written by the Modbus TCP task before its workers serve a
+ * connection and only read afterwards, so neither the units nor the lookup
+ * array need a lock. The monitor callbacks run with the register mutex
+ * held, like those of the device unit, and so do the TCP/IP thread
+ * callbacks. See modbus_units.h.
+ */
+
+#include "modbus_units.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "do_schedule.h"
+#include "jerry_device_registers.h"
+#include "modbus_callbacks.h"
+#include "modbus_config.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Units, in the order they were added */
+static modbus_unit_t s_units[MODBUS_UNITS_MAX];
+
+/** Units in s_units */
+static uint8_t s_unit_count;
+
+/** Index into s_units plus one by unit ID, 0 for no unit */
+static uint8_t s_unit_route[256];
+
+/** The coils of an FC15 request in the TCP/IP thread that are not digital
+ *  outputs, repacked from their own address; the callbacks are serialized
+ *  by the register mutex */
+static uint8_t s_tcpip_coils[(MODBUS_MAX_WRITE_COILS + 7U) / 8U];
+
+_Static_assert(MODBUS_UNITS_MAX < 255U, "unit index must fit the route");
+_Static_assert(JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_COUNT <= 16U,
+               "digital outputs fit a do_schedule mask");
+
+/* ==========================================================================
+ * Monitor Unit Callbacks
+ * ========================================================================== */
+
+/**
+ * @brief Refuse an FC05 write
+ */
+static modbus_exception_t monitor_write_single_coil(uint16_t address,
+                                                    bool     value)
+{
+    (void)address;
+    (void)value;
+    return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+}
+
+/**
+ * @brief Refuse an FC15 write
+ */
+static modbus_exception_t monitor_write_multiple_coils(
+    uint16_t start_address, uint16_t quantity, const uint8_t *coil_values)
+{
+    (void)start_address;
+    (void)quantity;
+    (void)coil_values;
+    return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+}
+
+/**
+ * @brief Refuse an FC06 write
+ */
+static modbus_exception_t monitor_write_single_register(uint16_t address,
+                                                        uint16_t value)
+{
+    (void)address;
+    (void)value;
+    return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+}
+
+/**
+ * @brief Refuse an FC16 or FC23 write
+ */
+static modbus_exception_t monitor_write_multiple_registers(
+    uint16_t start_address, uint16_t quantity,
+    const uint16_t *register_values)
+{
+    (void)start_address;
+    (void)quantity;
+    (void)register_values;
+    return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+}
+
+const modbus_slave_callbacks_t modbus_units_monitor_callbacks = {
+    modbus_cb_read_coils,
+    monitor_write_single_coil,
+    monitor_write_multiple_coils,
+    modbus_cb_read_discrete_inputs,
+    modbus_cb_read_holding_registers,
+    monitor_write_single_register,
+    monitor_write_multiple_registers,
+    modbus_cb_read_input_registers,
+};
+
+/* ==========================================================================
+ * TCP/IP Thread Callbacks
+ * ========================================================================== */
+
+/**
+ * @brief Check whether a coil write reaches a digital output
+ */
+static bool tcpip_writes_outputs(uint16_t start_address, uint16_t quantity)
+{
+    uint32_t end = (uint32_t)start_address + quantity;
+
+    return (start_address <
+            (JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_ADDR +
+             JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_COUNT)) &&
+           (end > JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_ADDR);
+}
+
+/**
+ * @brief Read one coil of a bit-packed request
+ */
+static bool tcpip_coil(const uint8_t *coil_values, uint32_t index)
+{
+    return ((coil_values[index / 8U] >> (index % 8U)) & 1U) != 0U;
+}
+
+/**
+ * @brief Write part of an FC15 block through modbus_cb_write_multiple_coils
+ *
+ * @param[in] start_address First address of the request
+ * @param[in] first         Offset of the part in the request
+ * @param[in] count         Coils in the part
+ * @param[in] coil_values   Coils of the request, bit-packed
+ */
+static modbus_exception_t tcpip_write_coil_part(uint16_t       start_address,
+                                                uint32_t       first,
+                                                uint32_t       count,
+                                                const uint8_t *coil_values)
+{
+    (void)memset(s_tcpip_coils, 0, (count + 7U) / 8U);
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        if (tcpip_coil(coil_values, first + i))
+        {
+            s_tcpip_coils[i / 8U] |= (uint8_t)(1U << (i % 8U));
+        }
+    }
+
+    return modbus_cb_write_multiple_coils((uint16_t)(start_address + first),
+                                          (uint16_t)count, s_tcpip_coils);
+}
+
+/**
+ * @brief FC15, digital outputs handed to the output executor
+ *
+ * The outputs of the block are queued with do_schedule_write(), which
+ * applies them in its next expander write, and answered without waiting
+ * for it; a full queue is answered with SLAVE_DEVICE_BUSY before anything
+ * is written. The other coils of the block are written as usual.
+ */
+static modbus_exception_t tcpip_write_multiple_coils(
+    uint16_t start_address, uint16_t quantity, const uint8_t *coil_values)
+{
+    uint32_t first = JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_ADDR;
+    uint32_t last  = first + JERRY_DEVICE_COIL_GROUP_DIGITAL_OUTPUTS_COUNT;
+    uint32_t end   = (uint32_t)start_address + quantity;
+    uint16_t mask  = 0U;
+    uint16_t value = 0U;
+
+    if (!tcpip_writes_outputs(start_address, quantity))
+    {
+        return modbus_cb_write_multiple_coils(start_address, quantity,
+                                              coil_values);
+    }
+
+    if ((end - 1U) > JERRY_DEVICE_COIL_MAX_ADDR)
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    for (uint32_t address = (start_address > first) ? start_address : first;
+         address < ((end < last) ? end : last); address++)
+    {
+        uint16_t bit = (uint16_t)(1U << (address - first));
+
+        mask |= bit;
+        if (tcpip_coil(coil_values, address - start_address))
+        {
+            value |= bit;
+        }
+    }
+
+    if (do_schedule_write(mask, value) != DO_SCHEDULE_OK)
+    {
+        return MODBUS_EXCEPTION_SLAVE_DEVICE_BUSY;
+    }
+
+    if (start_address < first)
+    {
+        modbus_exception_t result = tcpip_write_coil_part(
+            start_address, 0U, first - start_address, coil_values);
+
+        if (result != MODBUS_EXCEPTION_NONE)
+        {
+            return result;
+        }
+    }
+
+    if (end > last)
+    {
+        return tcpip_write_coil_part(start_address, last - start_address,
+                                     end - last, coil_values);
+    }
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief FC05, as a one coil FC15
+ */
+static modbus_exception_t tcpip_write_single_coil(uint16_t address,
+                                                  bool     value)
+{
+    uint8_t coil_value = value ? 0x01U : 0x00U;
+
+    return tcpip_write_multiple_coils(address, 1U, &coil_value);
+}
+
+const modbus_slave_callbacks_t modbus_units_tcpip_callbacks = {
+    modbus_cb_read_coils,
+    tcpip_write_single_coil,
+    tcpip_write_multiple_coils,
+    modbus_cb_read_discrete_inputs,
+    modbus_cb_read_holding_registers,
+    modbus_cb_write_single_register,
+    modbus_cb_write_multiple_registers,
+    modbus_cb_read_input_registers,
+};
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+bool modbus_units_add(uint8_t unit_id, modbus_context_t *ctx)
+{
+    if ((unit_id == 0U) || (ctx == NULL) || (s_unit_route[unit_id] != 0U) ||
+        (s_unit_count >= MODBUS_UNITS_MAX))
+    {
+        return false;
+    }
+
+    s_units[s_unit_count] = (modbus_unit_t){unit_id, s_unit_count, ctx};
+    s_unit_count++;
+    s_unit_route[unit_id] = s_unit_count;
+
+    /* Broadcasts go to the first unit */
+    if (s_unit_count == 1U)
+    {
+        s_unit_route[0] = 1U;
+    }
+
+    return true;
+}
+
+const modbus_unit_t *modbus_units_lookup(uint8_t unit_id)
+{
+    uint8_t index = s_unit_route[unit_id];
+
+    return (index != 0U) ? &s_units[index - 1U] : NULL;
+}
@@ -1,6 +1,19 @@
 /*
  * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
  * All rights reserved.
+ *
+ * System Monitor
+ *
+ * The task sleeps until the metrics counters (metrics.h) wake it on a
+ * threshold crossing, and then prints only the counters that changed. A
+ * full snapshot (lwIP memory, task stacks, CPU load, sleep states and all
+ * counters) is printed when requested with metrics_request_snapshot() and
+ * every MONITOR_SNAPSHOT_PERIOD_MS; with 0 only when requested. Each
+ * snapshot closes a CPU load window (cpu_load.h).
+ *
+ * The task also builds the binary telemetry frames (telemetry.h) whenever
+ * one is due, and with ICACHE_ENABLE turns the instruction cache on as it
+ * starts.
  */
 
 #include <stdbool.h>
@@ -9,7 +22,15 @@
 #include "FreeRTOS.h"
 #include "app_tasks.h"
 #include "bsp.h"
+#include "clock_scaling.h"
+#include "config_store.h"
+#include "cpu_load.h"
+#include "cyclic_exec.h"
+#include "low_power.h"
+#include "metrics.h"
+#include "supervisor.h"
 #include "task.h"
+#include "telemetry.h"
 
 /* LwIP includes for memory stats */
 #include "lwip/stats.h"
@@ -22,74 +43,10 @@ extern bool check_lwip_memory_critical(void);
 extern void print_task_stack_usage(void);
 
 /* Configuration */
-#define MONITOR_INTERVAL_MS       5000U /* Check every 5 seconds */
-#define FULL_STATS_INTERVAL_COUNT 12U   /* Print full stats every 60 seconds */
-
-/* Static counters for tracking errors */
-static uint32_t s_last_mem_err     = 0;
-static uint32_t s_last_pbuf_err    = 0;
-static uint32_t s_last_tcp_seg_err = 0;
-static uint32_t s_last_tcp_pcb_err = 0;
-static uint32_t s_last_netconn_err = 0;
-
-/**
- * @brief Check for new LwIP memory errors and report them immediately
- */
-static void check_lwip_errors(void)
-{
-#if LWIP_STATS && MEM_STATS
-    /* Check heap memory errors */
-    if (lwip_stats.mem.err > s_last_mem_err)
-    {
-        (void)printf("!!! NEW LwIP HEAP ERROR !!! (total: %u)\n",
-                     (unsigned int)lwip_stats.mem.err);
-        s_last_mem_err = lwip_stats.mem.err;
-    }
+#ifndef MONITOR_SNAPSHOT_PERIOD_MS
+#define MONITOR_SNAPSHOT_PERIOD_MS 60000U /* Full snapshot every minute */
 #endif
 
-#if LWIP_STATS && MEMP_STATS
-    /* Check PBUF pool errors - with NULL check and explicit parentheses
-     * (MISRA 12.1) */
-    if ((lwip_stats.memp[MEMP_PBUF] != NULL) &&
-        (lwip_stats.memp[MEMP_PBUF]->err > s_last_pbuf_err))
-    {
-        (void)printf("!!! NEW PBUF POOL ERROR !!! (total: %u)\n",
-                     (unsigned int)lwip_stats.memp[MEMP_PBUF]->err);
-        s_last_pbuf_err = lwip_stats.memp[MEMP_PBUF]->err;
-    }
-
-    /* Check TCP_SEG pool errors - critical for NETCONN_COPY memory leak
-     * diagnosis */
-    if ((lwip_stats.memp[MEMP_TCP_SEG] != NULL) &&
-        (lwip_stats.memp[MEMP_TCP_SEG]->err > s_last_tcp_seg_err))
-    {
-        (void)printf("!!! NEW TCP_SEG POOL ERROR !!! (total: %u)\n",
-                     (unsigned int)lwip_stats.memp[MEMP_TCP_SEG]->err);
-        s_last_tcp_seg_err = lwip_stats.memp[MEMP_TCP_SEG]->err;
-    }
-
-    /* Check TCP PCB pool errors - with NULL check and explicit parentheses
-     * (MISRA 12.1) */
-    if ((lwip_stats.memp[MEMP_TCP_PCB] != NULL) &&
-        (lwip_stats.memp[MEMP_TCP_PCB]->err > s_last_tcp_pcb_err))
-    {
-        (void)printf("!!! NEW TCP_PCB POOL ERROR !!! (total: %u)\n",
-                     (unsigned int)lwip_stats.memp[MEMP_TCP_PCB]->err);
-        s_last_tcp_pcb_err = lwip_stats.memp[MEMP_TCP_PCB]->err;
-    }
-
-    /* Check NETCONN pool errors - with NULL check and explicit parentheses
-     * (MISRA 12.1) */
-    if ((lwip_stats.memp[MEMP_NETCONN] != NULL) &&
-        (lwip_stats.memp[MEMP_NETCONN]->err > s_last_netconn_err))
-    {
-        (void)printf("!!! NEW NETCONN POOL ERROR !!! (total: %u)\n",
-                     (unsigned int)lwip_stats.memp[MEMP_NETCONN]->err);
-        s_last_netconn_err = lwip_stats.memp[MEMP_NETCONN]->err;
-    }
-#endif
-}
-
 /**
  * @brief Check task stack high water marks and warn if low
  */
@@ -105,76 +62,88 @@ static void check_task_stacks(void)
 }
 
 /**
- * @brief Print filtered ADC values for all channels
+ * @brief Print every statistic and close the CPU load window
  */
-static void print_adc_values(void)
+static void print_snapshot(void)
 {
-    float32_t adc_values[BSP_ADC1_NUM_CHANNELS];
+    cpu_load_update();
 
-    /* Check if filter has settled */
-    if (!BSP_ADC1_IsFilterSettled())
-    {
-        (void)printf("[ADC] Filter settling... (%u/%u samples)\n",
-                     (unsigned int)BSP_ADC1_GetFilterSampleCount(),
-                     (unsigned int)BSP_ADC1_FILTER_SETTLING_SAMPLES);
-        return;
-    }
+#if LWIP_STATS
+    print_lwip_memory_stats();
 
-    /* Get all filtered ADC values */
-    if (BSP_ADC1_GetFilteredValuesAll(adc_values) == BSP_OK)
+    /* Check if memory is critically low */
+    if (check_lwip_memory_critical())
     {
-        (void)printf("[ADC] ");
-        for (uint8_t ch = 0; ch < BSP_ADC1_NUM_CHANNELS; ch++)
-        {
-            /* Convert to millivolts (assuming 3.3V reference) */
-            uint32_t mv = (uint32_t)(adc_values[ch] * 3300.0f);
-            (void)printf("CH%u:%4umV ", (unsigned int)ch, (unsigned int)mv);
-        }
-        (void)printf("\n");
+        (void)printf("!!! CRITICAL: LwIP memory is critically low !!!\n");
     }
-    else
+#endif
+    print_task_stack_usage();
+    check_task_stacks();
+    cpu_load_print();
+    low_power_print();
+#if CLOCK_SCALING
+    clock_scaling_print();
+#endif
+    cyclic_exec_print();
+    supervisor_print();
+    config_store_print();
+    metrics_print();
+}
+
+/**
+ * @brief Ticks until the next periodic snapshot
+ */
+static TickType_t snapshot_wait(TickType_t last_snapshot)
+{
+    TickType_t period  = pdMS_TO_TICKS(MONITOR_SNAPSHOT_PERIOD_MS);
+    TickType_t elapsed = xTaskGetTickCount() - last_snapshot;
+
+    if (MONITOR_SNAPSHOT_PERIOD_MS == 0U)
     {
-        (void)printf("[ADC] Error reading filtered values\n");
+        return portMAX_DELAY;
     }
+
+    return (elapsed < period) ? (period - elapsed) : 0U;
 }
 
-/* Stack Monitor Task */
+/* System Monitor Task */
 void vMonitorTask(void* pvParameters)
 {
+    TickType_t last_snapshot = xTaskGetTickCount();
+    uint32_t   events        = 0U;
+
     (void)pvParameters;
 
-    uint32_t stats_counter = 0;
+    (void)printf("[Monitor] Task started - waiting for metrics events\n");
+
+#if ICACHE_ENABLE
+    if (BSP_ICache_Set(true) != BSP_OK)
+    {
+        (void)printf("[Monitor] Instruction cache not turned on\n");
+    }
+#endif
 
-    (void)printf("[Monitor] Task started - monitoring stack and LwIP memory\n");
+    /* Open the first CPU load window */
+    cpu_load_update();
 
     for (;;)
     {
-        /* Check for new errors (quick check every interval) */
-        check_lwip_errors();
-        check_task_stacks();
+        TickType_t wait = telemetry_poll((events & METRICS_EVENT_TELEMETRY) !=
+                                         0U);
+        TickType_t snapshot = snapshot_wait(last_snapshot);
 
-        /* Print ADC values every interval */
-        print_adc_values();
+        events = metrics_wait((snapshot < wait) ? snapshot : wait);
 
-        /* Print full statistics periodically */
-        stats_counter++;
-        if (stats_counter >= FULL_STATS_INTERVAL_COUNT)
+        if ((events & METRICS_EVENT_THRESHOLD) != 0U)
         {
-            stats_counter = 0;
-
-#if LWIP_STATS
-            print_lwip_memory_stats();
-
-            /* Check if memory is critically low */
-            if (check_lwip_memory_critical())
-            {
-                (void)printf(
-                    "!!! CRITICAL: LwIP memory is critically low !!!\n");
-            }
-#endif
-            print_task_stack_usage();
+            metrics_print_changes();
         }
 
-        vTaskDelay(pdMS_TO_TICKS(MONITOR_INTERVAL_MS));
+        if ((snapshot_wait(last_snapshot) == 0U) ||
+            ((events & METRICS_EVENT_SNAPSHOT) != 0U))
+        {
+            print_snapshot();
+            last_snapshot = xTaskGetTickCount();
+        }
     }
 }
@@ -0,0 +1,1154 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * MQTT Publisher on the lwIP Raw API
+ *
+ * One task runs the client under the TCP/IP core lock, ten times a second
+ * and whenever the configuration changes; the receive and error callbacks
+ * run in the TCP/IP thread, so the state needs no other lock. At the start
+ * of a period the data of every topic with nothing in flight is copied
+ * into that topic's publication; the publication is then written as one
+ * PUBLISH straight into the send buffer of the PCB. The JSON payload comes
+ * out of an item generator: a first pass over the items counts the bytes
+ * for the remaining length of the header, a second one writes them, so no
+ * payload is ever assembled in RAM. A packet is started only if the send
+ * buffer holds all of it, and a write that still fails mid-packet closes
+ * the connection, as the stream would be broken. See mqtt_client.h.
+ */
+
+#include "mqtt_client.h"
+
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if MQTT_CLIENT
+
+#include <stdio.h>
+#include <string.h>
+
+#include "adc_change.h"
+#include "adc_stats.h"
+#include "bsp.h"
+#include "bsp_sections.h"
+#include "ethernetif.h"
+#include "jerry_printf.h"
+#include "log.h"
+#include "lwip/err.h"
+#include "lwip/ip_addr.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "metrics.h"
+#include "task_priorities.h"
+
+#endif /* MQTT_CLIENT */
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+#if MQTT_CLIENT
+
+/** Stack size of the task (words) */
+#define MQTT_CLIENT_STACK_SIZE 512U
+
+/** Period of the task when nothing wakes it */
+#define MQTT_CLIENT_TICK_MS 100U
+
+/** Longest wait for the TCP connection and its CONNACK */
+#define MQTT_CLIENT_CONNECT_TIMEOUT_MS 10000U
+
+/** Longest wait for the PUBACK of a QoS 1 publication */
+#define MQTT_CLIENT_ACK_TIMEOUT_MS 10000U
+
+/** Control packet types, in the high nibble of the first byte */
+#define MQTT_CLIENT_PKT_CONNECT  0x10U
+#define MQTT_CLIENT_PKT_CONNACK  0x20U
+#define MQTT_CLIENT_PKT_PUBLISH  0x30U
+#define MQTT_CLIENT_PKT_PUBACK   0x40U
+#define MQTT_CLIENT_PKT_PINGREQ  0xC0U
+#define MQTT_CLIENT_PKT_PINGRESP 0xD0U
+#define MQTT_CLIENT_PKT_MASK     0xF0U
+
+/** PUBLISH flags: duplicate, QoS 1 */
+#define MQTT_CLIENT_FLAG_DUP  0x08U
+#define MQTT_CLIENT_FLAG_QOS1 0x02U
+
+/** CONNECT: protocol level 4 (3.1.1), clean session */
+#define MQTT_CLIENT_PROTOCOL_LEVEL 4U
+#define MQTT_CLIENT_CLEAN_SESSION  0x02U
+
+/** Characters of the device ID, the last three MAC bytes in hex */
+#define MQTT_CLIENT_ID_LENGTH 6U
+
+/** Client identifier: "jerry-" and the device ID */
+#define MQTT_CLIENT_CLIENT_ID_LENGTH (6U + MQTT_CLIENT_ID_LENGTH)
+
+/** CONNECT packet size: 14 bytes of headers, then the client identifier */
+#define MQTT_CLIENT_CONNECT_SIZE (14U + MQTT_CLIENT_CLIENT_ID_LENGTH)
+
+/** Longest topic name, "jerry/<id>/telemetry" */
+#define MQTT_CLIENT_TOPIC_MAX 32U
+
+/** Longest PUBLISH header: type, 4 bytes of length, topic, packet ID */
+#define MQTT_CLIENT_HEADER_MAX (1U + 4U + 2U + MQTT_CLIENT_TOPIC_MAX + 2U)
+
+/** Longest payload item */
+#define MQTT_CLIENT_ITEM_SIZE 64U
+
+/** Returned by an item generator after the last item */
+#define MQTT_CLIENT_ITEM_END 0xFFFFU
+
+/** Body bytes of an incoming packet kept: CONNACK and PUBACK need 2 */
+#define MQTT_CLIENT_RX_KEEP 2U
+
+#endif /* MQTT_CLIENT */
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+#if MQTT_CLIENT
+
+/**
+ * @brief Connection state
+ */
+typedef enum
+{
+    MQTT_CLIENT_IDLE,       /**< Not configured */
+    MQTT_CLIENT_BACKOFF,    /**< Waiting to reconnect */
+    MQTT_CLIENT_CONNECTING, /**< TCP connection being opened */
+    MQTT_CLIENT_CONNACK,    /**< CONNECT sent, waiting for the CONNACK */
+    MQTT_CLIENT_CONNECTED,  /**< Publishing */
+} mqtt_client_state_t;
+
+/**
+ * @brief State of a topic's publication
+ */
+typedef enum
+{
+    MQTT_CLIENT_PUB_FREE,    /**< Nothing held; take data next period */
+    MQTT_CLIENT_PUB_READY,   /**< Data taken, to be written */
+    MQTT_CLIENT_PUB_UNACKED, /**< QoS 1, written, waiting for its PUBACK */
+} mqtt_client_pub_state_t;
+
+/**
+ * @brief Data of one topic, as taken at the start of a period
+ */
+typedef struct
+{
+    mqtt_client_pub_state_t state;     /**< Where it is */
+    bool                    dup;       /**< Written before, connection lost */
+    uint16_t                packet_id; /**< QoS 1 packet identifier */
+    TickType_t              sent_at;   /**< Tick it was written */
+    uint32_t                uptime_ms; /**< Uptime when taken */
+    uint32_t                count;     /**< Events: channels changed, bit n =
+                                            channel n; stats: updates */
+    uint8_t                 di;        /**< Digital inputs, bit n = DI n */
+    union
+    {
+        float32_t          values[BSP_ADC1_NUM_CHANNELS]; /**< V */
+        adc_stats_result_t results[ADC_STATS_CHANNELS]
+                                  [ADC_STATS_WINDOW_COUNT];
+    } data;
+} mqtt_client_pub_t;
+
+/**
+ * @brief Writes item @p index of a payload into @p item
+ *
+ * @return Length of the item, 0 if it is empty, MQTT_CLIENT_ITEM_END after
+ *         the last one. The same publication gives the same items.
+ */
+typedef uint16_t (*mqtt_client_item_fn_t)(const mqtt_client_pub_t *pub,
+                                          uint16_t index, char *item);
+
+/**
+ * @brief Receiver of the broker's packets
+ */
+typedef struct
+{
+    uint8_t  type;   /**< First byte of the packet */
+    uint8_t  stage;  /**< 0 first byte, 1 length, 2 body */
+    uint8_t  shift;  /**< Bits of the length field so far */
+    uint32_t length; /**< Remaining length */
+    uint32_t offset; /**< Body bytes received */
+    uint8_t  body[MQTT_CLIENT_RX_KEEP]; /**< First bytes of the body */
+} mqtt_client_rx_t;
+
+#endif /* MQTT_CLIENT */
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Configuration waiting to be applied by the task */
+static mqtt_client_config_t s_pending_config = {
+    .period_ms   = 1000U,
+    .broker_addr = 0U,
+    .broker_port = MQTT_CLIENT_DEFAULT_PORT,
+    .qos_mask    = 1U << MQTT_CLIENT_TOPIC_EVENTS,
+    .keepalive_s = MQTT_CLIENT_DEFAULT_KEEPALIVE_S,
+};
+
+/** Incremented on every mqtt_client_set_config() call */
+static volatile uint32_t s_config_generation = 1U;
+
+/** Task, notified on a new configuration */
+static TaskHandle_t s_mqtt_task;
+
+#if MQTT_CLIENT
+
+/** Task control block and stack */
+static StaticTask_t s_mqtt_task_tcb;
+static StackType_t  s_mqtt_task_stack[MQTT_CLIENT_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/* Core lock or TCP/IP thread */
+static mqtt_client_config_t s_config;      /**< Active configuration */
+static uint32_t             s_generation;  /**< Generation applied */
+static mqtt_client_state_t  s_state;       /**< Connection state */
+static struct tcp_pcb      *s_pcb;         /**< Connection, NULL if none */
+static TickType_t           s_state_since; /**< Tick the state began */
+static TickType_t           s_retry_at;    /**< End of the backoff */
+static uint32_t             s_backoff_ms;  /**< Backoff of the next loss */
+static TickType_t           s_next_period; /**< Start of the next period */
+static TickType_t           s_last_tx;     /**< Tick of the last sent */
+static TickType_t           s_last_rx;     /**< Tick of the last received */
+static uint16_t             s_packet_id;   /**< Last packet identifier */
+static mqtt_client_rx_t     s_rx;          /**< Incoming packet */
+static adc_change_cursor_t  s_cursor;      /**< Changes published */
+static uint8_t              s_event_di;    /**< Inputs last published */
+static mqtt_client_pub_t    s_pubs[MQTT_CLIENT_TOPIC_COUNT];
+
+/** Device ID, NUL-terminated */
+static char s_id[MQTT_CLIENT_ID_LENGTH + 1U];
+
+/** Last part of each topic name */
+static const char *const s_topic_names[MQTT_CLIENT_TOPIC_COUNT] = {
+    "telemetry",
+    "stats",
+    "events",
+};
+
+#endif /* MQTT_CLIENT */
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+#if MQTT_CLIENT
+
+/**
+ * @brief Store a 16-bit value big-endian, as MQTT does
+ */
+static void put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value >> 8U);
+    dst[1] = (uint8_t)value;
+}
+
+/**
+ * @brief Store a remaining length
+ *
+ * @return Bytes of the length field, 1 to 4
+ */
+static uint8_t mqtt_put_length(uint8_t *dst, uint32_t length)
+{
+    uint8_t count = 0U;
+
+    do
+    {
+        uint8_t byte = (uint8_t)(length & 0x7FU);
+
+        length >>= 7U;
+        if (length != 0U)
+        {
+            byte |= 0x80U;
+        }
+        dst[count] = byte;
+        count++;
+    } while (length != 0U);
+
+    return count;
+}
+
+/**
+ * @brief Write a value of 0.1 mV units as volts with four decimals
+ *
+ * @return Characters written
+ */
+static uint16_t mqtt_put_volts(char *dst, size_t size, int32_t tenth_mv)
+{
+    uint32_t magnitude = (tenth_mv < 0) ? (uint32_t)(-tenth_mv)
+                                        : (uint32_t)tenth_mv;
+    int      length;
+
+    length = jerry_snprintf(dst, size, "%s%lu.%04lu",
+                            (tenth_mv < 0) ? "-" : "",
+                            (unsigned long)(magnitude / 10000U),
+                            (unsigned long)(magnitude % 10000U));
+
+    return (length > 0) ? (uint16_t)length : 0U;
+}
+
+/**
+ * @brief Round volts to 0.1 mV
+ */
+static int32_t mqtt_tenth_mv(float32_t volts)
+{
+    float32_t scaled = volts * 10000.0f;
+
+    return (int32_t)((scaled < 0.0f) ? (scaled - 0.5f) : (scaled + 0.5f));
+}
+
+/**
+ * @brief Items of the telemetry topic: head, one per channel, tail
+ */
+static uint16_t mqtt_telemetry_item(const mqtt_client_pub_t *pub,
+                                    uint16_t index, char *item)
+{
+    int length;
+
+    if (index == 0U)
+    {
+        length = jerry_snprintf(item, MQTT_CLIENT_ITEM_SIZE,
+                                "{\"uptime_ms\":%lu,\"ch\":[",
+                                (unsigned long)pub->uptime_ms);
+    }
+    else if (index <= BSP_ADC1_NUM_CHANNELS)
+    {
+        uint16_t pos = 0U;
+
+        if (index > 1U)
+        {
+            item[pos] = ',';
+            pos++;
+        }
+        length = pos + mqtt_put_volts(&item[pos], MQTT_CLIENT_ITEM_SIZE - pos,
+                                      mqtt_tenth_mv(
+                                          pub->data.values[index - 1U]));
+    }
+    else if (index == (BSP_ADC1_NUM_CHANNELS + 1U))
+    {
+        length = jerry_snprintf(item, MQTT_CLIENT_ITEM_SIZE, "],\"di\":%u}",
+                                (unsigned int)pub->di);
+    }
+    else
+    {
+        return MQTT_CLIENT_ITEM_END;
+    }
+
+    return (length > 0) ? (uint16_t)length : 0U;
+}
+
+/**
+ * @brief Items of the stats topic: head, one per channel and window, tail
+ */
+static uint16_t mqtt_stats_item(const mqtt_client_pub_t *pub, uint16_t index,
+                                char *item)
+{
+    const uint16_t figures = ADC_STATS_CHANNELS * ADC_STATS_WINDOW_COUNT;
+    int            length;
+
+    if (index == 0U)
+    {
+        length = jerry_snprintf(item, MQTT_CLIENT_ITEM_SIZE,
+                                "{\"updates\":%lu,\"ch\":[",
+                                (unsigned long)pub->count);
+    }
+    else if (index <= figures)
+    {
+        uint16_t                  ch     = (uint16_t)(index - 1U);
+        uint16_t                  window = ch % ADC_STATS_WINDOW_COUNT;
+        const adc_stats_result_t *result;
+        uint16_t                  values[4];
+        uint16_t                  pos = 0U;
+
+        ch        = ch / ADC_STATS_WINDOW_COUNT;
+        result    = &pub->data.results[ch][window];
+        values[0] = result->min;
+        values[1] = result->max;
+        values[2] = result->mean;
+        values[3] = result->rms;
+
+        if (window == 0U)
+        {
+            if (ch > 0U)
+            {
+                item[pos] = ',';
+                pos++;
+            }
+            item[pos] = '[';
+            pos++;
+        }
+        else
+        {
+            item[pos] = ',';
+            pos++;
+        }
+        for (uint32_t i = 0U; i < 4U; i++)
+        {
+            item[pos] = (i == 0U) ? '[' : ',';
+            pos++;
+            pos += mqtt_put_volts(&item[pos], MQTT_CLIENT_ITEM_SIZE - pos,
+                                  (int32_t)values[i]);
+        }
+        item[pos] = ']';
+        pos++;
+        if (window == (ADC_STATS_WINDOW_COUNT - 1U))
+        {
+            item[pos] = ']';
+            pos++;
+        }
+        length = pos;
+    }
+    else if (index == (figures + 1U))
+    {
+        length = jerry_snprintf(item, MQTT_CLIENT_ITEM_SIZE, "]}");
+    }
+    else
+    {
+        return MQTT_CLIENT_ITEM_END;
+    }
+
+    return (length > 0) ? (uint16_t)length : 0U;
+}
+
+/**
+ * @brief Items of the events topic: head, one per channel that changed,
+ * tail
+ */
+static uint16_t mqtt_events_item(const mqtt_client_pub_t *pub, uint16_t index,
+                                 char *item)
+{
+    int length;
+
+    if (index == 0U)
+    {
+        length = jerry_snprintf(item, MQTT_CLIENT_ITEM_SIZE,
+                                "{\"uptime_ms\":%lu,\"changes\":[",
+                                (unsigned long)pub->uptime_ms);
+    }
+    else if (index <= BSP_ADC1_NUM_CHANNELS)
+    {
+        uint32_t ch   = index - 1U;
+        uint32_t mask = 1UL << ch;
+
+        if ((pub->count & mask) == 0U)
+        {
+            return 0U;
+        }
+
+        length = jerry_snprintf(item, MQTT_CLIENT_ITEM_SIZE,
+                                "%s{\"ch\":%lu,\"v\":",
+                                ((pub->count & (mask - 1U)) != 0U) ? "," : "",
+                                (unsigned long)ch);
+        if (length > 0)
+        {
+            length += mqtt_put_volts(&item[length],
+                                     MQTT_CLIENT_ITEM_SIZE - (size_t)length,
+                                     mqtt_tenth_mv(pub->data.values[ch]));
+            item[length] = '}';
+            length++;
+        }
+    }
+    else if (index == (BSP_ADC1_NUM_CHANNELS + 1U))
+    {
+        length = jerry_snprintf(item, MQTT_CLIENT_ITEM_SIZE, "],\"di\":%u}",
+                                (unsigned int)pub->di);
+    }
+    else
+    {
+        return MQTT_CLIENT_ITEM_END;
+    }
+
+    return (length > 0) ? (uint16_t)length : 0U;
+}
+
+/** Item generator of each topic */
+static const mqtt_client_item_fn_t s_items[MQTT_CLIENT_TOPIC_COUNT] = {
+    mqtt_telemetry_item,
+    mqtt_stats_item,
+    mqtt_events_item,
+};
+
+/**
+ * @brief Whether a topic is sent at QoS 1
+ */
+static bool mqtt_qos1(uint32_t topic)
+{
+    return ((s_config.qos_mask >> topic) & 1U) != 0U;
+}
+
+/**
+ * @brief Write a whole packet held in RAM
+ */
+static bool mqtt_write(const uint8_t *packet, uint16_t length)
+{
+    if (tcp_write(s_pcb, packet, length, TCP_WRITE_FLAG_COPY) != ERR_OK)
+    {
+        return false;
+    }
+
+    (void)tcp_output(s_pcb);
+    s_last_tx = xTaskGetTickCount();
+    return true;
+}
+
+/**
+ * @brief Close the connection and put back what it left unacknowledged
+ *
+ * QoS 1 publications are written again, flagged as duplicates, on the
+ * next connection; QoS 0 ones are dropped.
+ *
+ * @param abort Reset instead of closing
+ * @return ERR_ABRT if the PCB was aborted, else ERR_OK
+ */
+static err_t mqtt_close(bool abort)
+{
+    struct tcp_pcb *pcb = s_pcb;
+    err_t           err = ERR_OK;
+
+    if (pcb != NULL)
+    {
+        s_pcb = NULL;
+        tcp_arg(pcb, NULL);
+        tcp_recv(pcb, NULL);
+        tcp_err(pcb, NULL);
+
+        if (abort || (tcp_close(pcb) != ERR_OK))
+        {
+            tcp_abort(pcb);
+            err = ERR_ABRT;
+        }
+    }
+
+    for (uint32_t topic = 0U; topic < MQTT_CLIENT_TOPIC_COUNT; topic++)
+    {
+        mqtt_client_pub_t *pub = &s_pubs[topic];
+
+        if (pub->state == MQTT_CLIENT_PUB_UNACKED)
+        {
+            pub->state = MQTT_CLIENT_PUB_READY;
+            pub->dup   = true;
+        }
+        else if ((pub->state == MQTT_CLIENT_PUB_READY) && !mqtt_qos1(topic))
+        {
+            pub->state = MQTT_CLIENT_PUB_FREE;
+        }
+        else
+        {
+            /* Nothing to put back */
+        }
+    }
+
+    s_state       = MQTT_CLIENT_IDLE;
+    s_state_since = xTaskGetTickCount();
+    return err;
+}
+
+/**
+ * @brief Close the connection and wait out a backoff before the next one
+ *
+ * @param abort Reset instead of closing
+ * @return ERR_ABRT if the PCB was aborted, else ERR_OK
+ */
+static err_t mqtt_lost(bool abort)
+{
+    uint32_t backoff = s_backoff_ms;
+    uint32_t wait;
+    err_t    err;
+
+    if (s_state == MQTT_CLIENT_CONNECTED)
+    {
+        metrics_add(METRIC_MQTT_RECONNECT, 1U);
+        LOG("MQTT: Connection lost\n");
+    }
+
+    err = mqtt_close(abort);
+
+    /* Half the backoff, and up to as much again at random */
+    wait = (backoff / 2U) + ((uint32_t)LWIP_RAND() % ((backoff / 2U) + 1U));
+    s_backoff_ms = (backoff >= (MQTT_CLIENT_BACKOFF_MAX_MS / 2U))
+                       ? MQTT_CLIENT_BACKOFF_MAX_MS
+                       : (2U * backoff);
+
+    s_state    = MQTT_CLIENT_BACKOFF;
+    s_retry_at = s_state_since + pdMS_TO_TICKS(wait);
+    return err;
+}
+
+/**
+ * @brief Handle a complete packet of the broker
+ *
+ * @return false if the connection must be closed
+ */
+static bool mqtt_packet(const mqtt_client_rx_t *rx)
+{
+    uint16_t id;
+
+    switch (rx->type & MQTT_CLIENT_PKT_MASK)
+    {
+        case MQTT_CLIENT_PKT_CONNACK:
+            if ((s_state != MQTT_CLIENT_CONNACK) || (rx->length < 2U))
+            {
+                return false;
+            }
+            if (rx->body[1] != 0U)
+            {
+                LOG("MQTT: Broker refused the connection: %u\n",
+                    (unsigned int)rx->body[1]);
+                return false;
+            }
+            s_state       = MQTT_CLIENT_CONNECTED;
+            s_state_since = xTaskGetTickCount();
+            s_next_period = s_state_since;
+            s_backoff_ms  = MQTT_CLIENT_BACKOFF_MIN_MS;
+            LOG("MQTT: Connected as jerry-%s\n", s_id);
+            break;
+        case MQTT_CLIENT_PKT_PUBACK:
+            if (rx->length < 2U)
+            {
+                return false;
+            }
+            id = (uint16_t)(((uint16_t)rx->body[0] << 8U) | rx->body[1]);
+            for (uint32_t topic = 0U; topic < MQTT_CLIENT_TOPIC_COUNT; topic++)
+            {
+                if ((s_pubs[topic].state == MQTT_CLIENT_PUB_UNACKED) &&
+                    (s_pubs[topic].packet_id == id))
+                {
+                    s_pubs[topic].state = MQTT_CLIENT_PUB_FREE;
+                }
+            }
+            break;
+        default:
+            /* PINGRESP, and anything not asked for */
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Take one received byte
+ *
+ * @return false if the connection must be closed
+ */
+static bool mqtt_rx_byte(mqtt_client_rx_t *rx, uint8_t byte)
+{
+    bool complete = false;
+
+    switch (rx->stage)
+    {
+        case 0U:
+            rx->type   = byte;
+            rx->length = 0U;
+            rx->shift  = 0U;
+            rx->offset = 0U;
+            rx->stage  = 1U;
+            break;
+        case 1U:
+            if (rx->shift > 21U)
+            {
+                return false;
+            }
+            rx->length |= (uint32_t)(byte & 0x7FU) << rx->shift;
+            rx->shift = (uint8_t)(rx->shift + 7U);
+            if ((byte & 0x80U) == 0U)
+            {
+                rx->stage = 2U;
+                complete  = (rx->length == 0U);
+            }
+            break;
+        default:
+            if (rx->offset < MQTT_CLIENT_RX_KEEP)
+            {
+                rx->body[rx->offset] = byte;
+            }
+            rx->offset++;
+            complete = (rx->offset == rx->length);
+            break;
+    }
+
+    if (complete)
+    {
+        rx->stage = 0U;
+        return mqtt_packet(rx);
+    }
+
+    return true;
+}
+
+/**
+ * @brief tcp_recv() callback: parse the broker's packets
+ */
+static err_t mqtt_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p,
+                       err_t err)
+{
+    bool ok = true;
+
+    (void)arg;
+
+    if (p == NULL)
+    {
+        return mqtt_lost(false);
+    }
+    if (err != ERR_OK)
+    {
+        pbuf_free(p);
+        return err;
+    }
+
+    for (const struct pbuf *q = p; (q != NULL) && ok; q = q->next)
+    {
+        const uint8_t *bytes = (const uint8_t *)q->payload;
+
+        for (uint16_t i = 0U; (i < q->len) && ok; i++)
+        {
+            ok = mqtt_rx_byte(&s_rx, bytes[i]);
+        }
+    }
+
+    s_last_rx = xTaskGetTickCount();
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    return ok ? ERR_OK : mqtt_lost(true);
+}
+
+/**
+ * @brief tcp_err() callback: the PCB is already freed
+ */
+static void mqtt_error(void *arg, err_t err)
+{
+    (void)arg;
+
+    LOG("MQTT: Connection error: %d\n", err);
+    s_pcb = NULL;
+    (void)mqtt_lost(false);
+}
+
+/**
+ * @brief tcp_connect() callback: send the CONNECT packet
+ */
+static err_t mqtt_connected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    uint8_t packet[MQTT_CLIENT_CONNECT_SIZE];
+
+    (void)arg;
+    (void)pcb;
+
+    if (err != ERR_OK)
+    {
+        return mqtt_lost(true);
+    }
+
+    /* Fixed header, protocol name and level, flags, keepalive, then the
+     * client identifier as the whole payload */
+    packet[0] = MQTT_CLIENT_PKT_CONNECT;
+    packet[1] = (uint8_t)(MQTT_CLIENT_CONNECT_SIZE - 2U);
+    put_u16(&packet[2], 4U);
+    (void)memcpy(&packet[4], "MQTT", 4U);
+    packet[8] = MQTT_CLIENT_PROTOCOL_LEVEL;
+    packet[9] = MQTT_CLIENT_CLEAN_SESSION;
+    put_u16(&packet[10], s_config.keepalive_s);
+    put_u16(&packet[12], MQTT_CLIENT_CLIENT_ID_LENGTH);
+    (void)memcpy(&packet[14], "jerry-", 6U);
+    (void)memcpy(&packet[20], s_id, MQTT_CLIENT_ID_LENGTH);
+
+    (void)memset(&s_rx, 0, sizeof(s_rx));
+    if (!mqtt_write(packet, (uint16_t)sizeof(packet)))
+    {
+        return mqtt_lost(true);
+    }
+
+    s_state       = MQTT_CLIENT_CONNACK;
+    s_state_since = xTaskGetTickCount();
+    s_last_rx     = s_state_since;
+    return ERR_OK;
+}
+
+/**
+ * @brief Open the TCP connection to the broker
+ */
+static void mqtt_connect(void)
+{
+    ip_addr_t broker;
+
+    s_pcb = tcp_new();
+    if (s_pcb == NULL)
+    {
+        (void)mqtt_lost(false);
+        return;
+    }
+
+    tcp_arg(s_pcb, NULL);
+    tcp_recv(s_pcb, mqtt_recv);
+    tcp_err(s_pcb, mqtt_error);
+
+    IP_ADDR4(&broker, (uint8_t)(s_config.broker_addr >> 24U),
+             (uint8_t)(s_config.broker_addr >> 16U),
+             (uint8_t)(s_config.broker_addr >> 8U),
+             (uint8_t)s_config.broker_addr);
+    if (tcp_connect(s_pcb, &broker, s_config.broker_port, mqtt_connected) !=
+        ERR_OK)
+    {
+        (void)mqtt_lost(true);
+        return;
+    }
+
+    s_state       = MQTT_CLIENT_CONNECTING;
+    s_state_since = xTaskGetTickCount();
+}
+
+/**
+ * @brief Write a publication as one PUBLISH packet
+ *
+ * @return false if the send buffer has no room for it now
+ */
+static bool mqtt_publish(uint32_t topic)
+{
+    mqtt_client_pub_t    *pub  = &s_pubs[topic];
+    mqtt_client_item_fn_t item = s_items[topic];
+    bool                  qos1 = mqtt_qos1(topic);
+    uint8_t               header[MQTT_CLIENT_HEADER_MAX];
+    char                  text[MQTT_CLIENT_ITEM_SIZE];
+    uint32_t              payload = 0U;
+    uint32_t              remaining;
+    uint16_t              topic_length;
+    uint16_t              pos;
+    uint16_t              length;
+
+    for (uint16_t i = 0U; (length = item(pub, i, text)) != MQTT_CLIENT_ITEM_END;
+         i++)
+    {
+        payload += length;
+    }
+
+    if (qos1 && !pub->dup)
+    {
+        s_packet_id++;
+        if (s_packet_id == 0U)
+        {
+            s_packet_id = 1U;
+        }
+        pub->packet_id = s_packet_id;
+    }
+
+    topic_length = (uint16_t)jerry_snprintf(
+        (char *)&header[MQTT_CLIENT_HEADER_MAX - MQTT_CLIENT_TOPIC_MAX],
+        MQTT_CLIENT_TOPIC_MAX, "jerry/%s/%s", s_id, s_topic_names[topic]);
+    remaining = 2U + topic_length + (qos1 ? 2U : 0U) + payload;
+
+    header[0] = (uint8_t)(MQTT_CLIENT_PKT_PUBLISH |
+                          (pub->dup ? MQTT_CLIENT_FLAG_DUP : 0U) |
+                          (qos1 ? MQTT_CLIENT_FLAG_QOS1 : 0U));
+    pos = (uint16_t)(1U + mqtt_put_length(&header[1], remaining));
+    put_u16(&header[pos], topic_length);
+    pos += 2U;
+    (void)memmove(&header[pos],
+                  &header[MQTT_CLIENT_HEADER_MAX - MQTT_CLIENT_TOPIC_MAX],
+                  topic_length);
+    pos += topic_length;
+    if (qos1)
+    {
+        put_u16(&header[pos], pub->packet_id);
+        pos += 2U;
+    }
+
+    if ((tcp_sndbuf(s_pcb) < (pos + payload)) ||
+        (tcp_sndqueuelen(s_pcb) >= (TCP_SND_QUEUELEN / 2U)))
+    {
+        return false;
+    }
+
+    /* MORE keeps each segment open for the next item, so the items share
+     * segments instead of taking one each */
+    if (tcp_write(s_pcb, header, pos,
+                  TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE) != ERR_OK)
+    {
+        (void)mqtt_lost(true);
+        return true;
+    }
+    for (uint16_t i = 0U; (length = item(pub, i, text)) != MQTT_CLIENT_ITEM_END;
+         i++)
+    {
+        if ((length != 0U) &&
+            (tcp_write(s_pcb, text, length,
+                       TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE) != ERR_OK))
+        {
+            /* Half a packet is in the stream; only a new connection
+             * recovers from that */
+            LOG("MQTT: Send buffer full mid-packet\n");
+            (void)mqtt_lost(true);
+            return true;
+        }
+    }
+
+    (void)tcp_output(s_pcb);
+    s_last_tx    = xTaskGetTickCount();
+    pub->sent_at = s_last_tx;
+    pub->state   = qos1 ? MQTT_CLIENT_PUB_UNACKED : MQTT_CLIENT_PUB_FREE;
+    return true;
+}
+
+/**
+ * @brief Take the data of every topic with nothing held
+ */
+static void mqtt_take(void)
+{
+    uint32_t uptime = (uint32_t)pdTICKS_TO_MS(xTaskGetTickCount());
+    uint8_t  di     = 0U;
+
+    (void)BSP_GPIODI_ReadAll(&di);
+
+    for (uint32_t topic = 0U; topic < MQTT_CLIENT_TOPIC_COUNT; topic++)
+    {
+        mqtt_client_pub_t *pub = &s_pubs[topic];
+        bool               ready = true;
+
+        if (pub->state != MQTT_CLIENT_PUB_FREE)
+        {
+            continue;
+        }
+
+        pub->uptime_ms = uptime;
+        pub->di        = di;
+        pub->dup       = false;
+        switch (topic)
+        {
+            case MQTT_CLIENT_TOPIC_TELEMETRY:
+                ready = (BSP_ADC1_GetFilteredValuesAll(pub->data.values) ==
+                         BSP_OK);
+                break;
+            case MQTT_CLIENT_TOPIC_STATS:
+                pub->count = adc_stats_get_results(pub->data.results);
+                ready      = (pub->count != 0U);
+                break;
+            default:
+                pub->count = adc_change_poll(&s_cursor, pub->data.values);
+                ready      = (pub->count != 0U) || (di != s_event_di);
+                s_event_di = di;
+                break;
+        }
+
+        if (ready)
+        {
+            pub->state = MQTT_CLIENT_PUB_READY;
+        }
+    }
+}
+
+/**
+ * @brief Run a connected client: periods, keepalive, timeouts
+ */
+static void mqtt_service(TickType_t now)
+{
+    TickType_t keepalive = pdMS_TO_TICKS(1000U * s_config.keepalive_s);
+    TickType_t period    = pdMS_TO_TICKS(s_config.period_ms);
+
+    if ((keepalive != 0U) && ((now - s_last_rx) > (keepalive + keepalive / 2U)))
+    {
+        LOG("MQTT: Broker silent, reconnecting\n");
+        (void)mqtt_lost(true);
+        return;
+    }
+
+    for (uint32_t topic = 0U; topic < MQTT_CLIENT_TOPIC_COUNT; topic++)
+    {
+        if ((s_pubs[topic].state == MQTT_CLIENT_PUB_UNACKED) &&
+            ((now - s_pubs[topic].sent_at) >=
+             pdMS_TO_TICKS(MQTT_CLIENT_ACK_TIMEOUT_MS)))
+        {
+            LOG("MQTT: No PUBACK, reconnecting\n");
+            (void)mqtt_lost(true);
+            return;
+        }
+    }
+
+    if ((int32_t)(now - s_next_period) >= 0)
+    {
+        mqtt_take();
+
+        /* A period missed entirely is skipped, not made up */
+        s_next_period += period;
+        if ((int32_t)(now - s_next_period) >= 0)
+        {
+            s_next_period = now + period;
+        }
+    }
+
+    for (uint32_t topic = 0U;
+         (topic < MQTT_CLIENT_TOPIC_COUNT) && (s_pcb != NULL); topic++)
+    {
+        if ((s_pubs[topic].state == MQTT_CLIENT_PUB_READY) &&
+            !mqtt_publish(topic) && !mqtt_qos1(topic))
+        {
+            /* No room this period */
+            s_pubs[topic].state = MQTT_CLIENT_PUB_FREE;
+        }
+    }
+
+    /* Ping at half the keepalive, well inside what the broker allows */
+    if ((s_pcb != NULL) && (keepalive != 0U) &&
+        ((now - s_last_tx) >= (keepalive / 2U)))
+    {
+        static const uint8_t ping[2] = {MQTT_CLIENT_PKT_PINGREQ, 0U};
+
+        (void)mqtt_write(ping, (uint16_t)sizeof(ping));
+    }
+}
+
+/**
+ * @brief Run the client once; core lock held
+ */
+static void mqtt_run(void)
+{
+    TickType_t now        = xTaskGetTickCount();
+    bool       configured = (s_config.period_ms != 0U) &&
+                      (s_config.broker_addr != 0U) &&
+                      (s_config.broker_port != 0U);
+
+    if (!configured)
+    {
+        if (s_state != MQTT_CLIENT_IDLE)
+        {
+            (void)mqtt_close(false);
+        }
+        return;
+    }
+
+    switch (s_state)
+    {
+        case MQTT_CLIENT_IDLE:
+            mqtt_connect();
+            break;
+        case MQTT_CLIENT_BACKOFF:
+            if ((int32_t)(now - s_retry_at) >= 0)
+            {
+                mqtt_connect();
+            }
+            break;
+        case MQTT_CLIENT_CONNECTING:
+        case MQTT_CLIENT_CONNACK:
+            if ((now - s_state_since) >=
+                pdMS_TO_TICKS(MQTT_CLIENT_CONNECT_TIMEOUT_MS))
+            {
+                LOG("MQTT: Broker not answering\n");
+                (void)mqtt_lost(true);
+            }
+            break;
+        default:
+            mqtt_service(now);
+            break;
+    }
+}
+
+/**
+ * @brief Pick up a new configuration
+ *
+ * @return true if the broker or the keepalive changed
+ */
+static bool mqtt_apply_config(void)
+{
+    uint32_t             generation = s_config_generation;
+    mqtt_client_config_t old        = s_config;
+
+    if (generation == s_generation)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    generation = s_config_generation;
+    s_config   = s_pending_config;
+    taskEXIT_CRITICAL();
+
+    if (s_config.period_ms != 0U)
+    {
+        if (s_config.period_ms < MQTT_CLIENT_MIN_PERIOD_MS)
+        {
+            s_config.period_ms = MQTT_CLIENT_MIN_PERIOD_MS;
+        }
+        if (s_config.period_ms > MQTT_CLIENT_MAX_PERIOD_MS)
+        {
+            s_config.period_ms = MQTT_CLIENT_MAX_PERIOD_MS;
+        }
+    }
+
+    s_generation = generation;
+    return (s_config.broker_addr != old.broker_addr) ||
+           (s_config.broker_port != old.broker_port) ||
+           (s_config.keepalive_s != old.keepalive_s);
+}
+
+/**
+ * @brief MQTT publish task
+ */
+static void mqtt_task(void *arg)
+{
+    (void)arg;
+
+    printf("MQTT publish task started\n");
+
+    for (;;)
+    {
+        LOCK_TCPIP_CORE();
+        if (mqtt_apply_config() && (s_state != MQTT_CLIENT_IDLE))
+        {
+            (void)mqtt_close(false);
+            s_backoff_ms = MQTT_CLIENT_BACKOFF_MIN_MS;
+        }
+        mqtt_run();
+        UNLOCK_TCPIP_CORE();
+
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MQTT_CLIENT_TICK_MS));
+    }
+}
+
+#endif /* MQTT_CLIENT */
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void mqtt_client_set_config(const mqtt_client_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_pending_config = *config;
+    s_config_generation++;
+    taskEXIT_CRITICAL();
+
+    if (s_mqtt_task != NULL)
+    {
+        (void)xTaskNotifyGive(s_mqtt_task);
+    }
+}
+
+#if MQTT_CLIENT
+
+void mqtt_client_start(void)
+{
+    uint8_t mac[6];
+
+    ethernetif_get_mac_addr(mac);
+    (void)jerry_snprintf(s_id, sizeof(s_id), "%02x%02x%02x",
+                         (unsigned int)mac[3], (unsigned int)mac[4],
+                         (unsigned int)mac[5]);
+    s_backoff_ms = MQTT_CLIENT_BACKOFF_MIN_MS;
+
+    s_mqtt_task = xTaskCreateStatic(mqtt_task, "Mqtt", MQTT_CLIENT_STACK_SIZE,
+                                    NULL, TASK_PRIO_MQTT, s_mqtt_task_stack,
+                                    &s_mqtt_task_tcb);
+}
+
+#endif /* MQTT_CLIENT */
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Message Bus
+ *
+ * A message's reference count is set before the first subscriber can see
+ * it: one reference per subscriber plus one for the publisher, which drops
+ * the references of the queues that were full and then its own once every
+ * queue has been tried. Until then no release can reach zero, so a fast
+ * subscriber never frees a message the publisher is still posting. The
+ * holder that drops the count to zero returns the message to the pool,
+ * which is lock-free, so that may be any task or interrupt handler. The
+ * subscriber lists are written before any publishing and only read after.
+ * See msg_bus.h.
+ */
+
+#include "msg_bus.h"
+
+#include "metrics.h"
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Drop references of a message, freeing it with the last
+ *
+ * @param[in] msg  Message
+ * @param[in] refs References to drop
+ */
+static void msg_put(msg_bus_msg_t *msg, unsigned int refs)
+{
+    if (atomic_fetch_sub_explicit(&msg->refs, refs, memory_order_acq_rel) ==
+        refs)
+    {
+        (void)block_pool_free(&msg->topic->pool, msg);
+    }
+}
+
+/**
+ * @brief Post a message to the subscribers of its topic
+ *
+ * @param[in]  msg   Message
+ * @param[out] woken Set to pdTRUE if a subscriber of higher priority was
+ *                   woken, or NULL in a task
+ */
+static void msg_deliver(msg_bus_msg_t *msg, BaseType_t *woken)
+{
+    msg_bus_topic_t *topic  = msg->topic;
+    unsigned int     missed = 0U;
+    BaseType_t       posted;
+    uint8_t          i;
+
+    atomic_store_explicit(&msg->refs,
+                          (unsigned int)topic->subscriber_count + 1U,
+                          memory_order_relaxed);
+
+    for (i = 0U; i < topic->subscriber_count; i++)
+    {
+        QueueHandle_t queue = topic->subscribers[i]->queue;
+
+        /* The release of the queue orders the payload before the pointer */
+        posted = (woken != NULL) ? xQueueSendToBackFromISR(queue, &msg, woken)
+                                 : xQueueSendToBack(queue, &msg, 0);
+        if (posted != pdTRUE)
+        {
+            missed++;
+        }
+    }
+
+    (void)atomic_fetch_add_explicit(&topic->published, 1U,
+                                    memory_order_relaxed);
+    if (missed != 0U)
+    {
+        (void)atomic_fetch_add_explicit(&topic->dropped, missed,
+                                        memory_order_relaxed);
+        metrics_add(METRIC_MSG_BUS_DROP, missed);
+    }
+
+    msg_put(msg, missed + 1U);
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void msg_bus_topic_init(msg_bus_topic_t *topic)
+{
+    block_pool_init(&topic->pool);
+    atomic_init(&topic->published, 0U);
+    atomic_init(&topic->dropped, 0U);
+}
+
+void msg_bus_subscriber_init(msg_bus_subscriber_t *sub)
+{
+    sub->queue = xQueueCreateStatic(sub->depth, sizeof(msg_bus_msg_t *),
+                                    (uint8_t *)sub->storage,
+                                    &sub->queue_buffer);
+    configASSERT(sub->queue != NULL);
+}
+
+bool msg_bus_subscribe(msg_bus_topic_t *topic, msg_bus_subscriber_t *sub)
+{
+    if (topic->subscriber_count >= MSG_BUS_MAX_SUBSCRIBERS)
+    {
+        return false;
+    }
+
+    topic->subscribers[topic->subscriber_count] = sub;
+    topic->subscriber_count++;
+
+    return true;
+}
+
+msg_bus_msg_t *msg_bus_loan(msg_bus_topic_t *topic)
+{
+    msg_bus_msg_t *msg = block_pool_alloc(&topic->pool);
+
+    if (msg != NULL)
+    {
+        msg->topic = topic;
+    }
+
+    return msg;
+}
+
+void *msg_bus_payload(msg_bus_msg_t *msg)
+{
+    return (uint8_t *)msg + msg->topic->payload_offset;
+}
+
+const msg_bus_topic_t *msg_bus_topic(const msg_bus_msg_t *msg)
+{
+    return msg->topic;
+}
+
+void msg_bus_publish(msg_bus_msg_t *msg) { msg_deliver(msg, NULL); }
+
+void msg_bus_publish_from_isr(msg_bus_msg_t *msg,
+                              BaseType_t    *higher_priority_task_woken)
+{
+    msg_deliver(msg, higher_priority_task_woken);
+}
+
+msg_bus_msg_t *msg_bus_receive(msg_bus_subscriber_t *sub, TickType_t timeout)
+{
+    msg_bus_msg_t *msg;
+
+    if (xQueueReceive(sub->queue, &msg, timeout) != pdTRUE)
+    {
+        return NULL;
+    }
+
+    return msg;
+}
+
+void msg_bus_release(msg_bus_msg_t *msg) { msg_put(msg, 1U); }
+
+void msg_bus_get_stats(const msg_bus_topic_t *topic,
+                       msg_bus_topic_stats_t *stats)
+{
+    block_pool_get_stats(&topic->pool, &stats->messages);
+    stats->published =
+        (uint32_t)atomic_load_explicit(&topic->published, memory_order_relaxed);
+    stats->dropped =
+        (uint32_t)atomic_load_explicit(&topic->dropped, memory_order_relaxed);
+}
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Network Bring-up Cache
+ *
+ * The interface is followed from its status and link callbacks in the
+ * TCP/IP thread: it is ready once it is up, its link is up and it has an
+ * address, and the announcements, the master's static ARP entry and the
+ * MAC check run from lwIP timeouts while it stays so. What is learned
+ * there is handed to net_cache_poll() through the critical section, as
+ * the register callbacks run in other tasks. See net_cache.h.
+ */
+
+#include "net_cache.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "jerry_device_registers.h"
+#include "log.h"
+#include "lwip/def.h"
+#include "lwip/dhcp.h"
+#include "lwip/etharp.h"
+#include "lwip/ip4_addr.h"
+#include "lwip/prot/dhcp.h"
+#include "lwip/timeouts.h"
+#include "modbus_callbacks.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** State of the registers, and what was learned since; critical section */
+static net_cache_config_t s_config;
+static uint32_t           s_lease;     /**< Address leased, 0 if none */
+static uint8_t            s_mac[6];    /**< MAC of the master resolved */
+static bool               s_mac_valid; /**< s_mac is of the master set */
+
+/** Register mutex, NULL until net_cache_start() */
+static SemaphoreHandle_t volatile s_register_mutex;
+
+/* TCP/IP thread */
+static bool       s_ready;         /**< Interface up with link and address */
+static uint32_t   s_ready_addr;    /**< Address it is ready with */
+static uint32_t   s_announce_left; /**< Gratuitous ARPs still to send */
+static bool       s_master_held;   /**< Static ARP entry of the master */
+static ip4_addr_t s_master_ip;     /**< Address of that entry */
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Copy the state of the registers
+ */
+static void net_cache_get_config(net_cache_config_t *config)
+{
+    taskENTER_CRITICAL();
+    *config = s_config;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief lwIP timeout: send the next gratuitous ARP
+ */
+static void net_cache_announce(void *arg)
+{
+    struct netif *netif = (struct netif *)arg;
+
+    (void)etharp_gratuitous(netif);
+
+    s_announce_left--;
+    if (s_announce_left > 0U)
+    {
+        sys_timeout(NET_CACHE_ANNOUNCE_MS, net_cache_announce, netif);
+    }
+}
+
+/**
+ * @brief Give the master a static ARP entry with its cached MAC
+ */
+static void net_cache_seed_master(void)
+{
+    static const uint8_t unknown[6] = {0};
+    net_cache_config_t   config;
+    struct eth_addr      mac;
+
+    net_cache_get_config(&config);
+    if ((config.master_addr == 0U) ||
+        (memcmp(config.master_mac, unknown, sizeof(unknown)) == 0))
+    {
+        return;
+    }
+
+    ip4_addr_set_u32(&s_master_ip, lwip_htonl(config.master_addr));
+    (void)memcpy(mac.addr, config.master_mac, sizeof(mac.addr));
+    s_master_held = (etharp_add_static_entry(&s_master_ip, &mac) == ERR_OK);
+}
+
+/**
+ * @brief Drop the static ARP entry of the master, if held
+ */
+static void net_cache_release_master(void)
+{
+    if (s_master_held)
+    {
+        (void)etharp_remove_static_entry(&s_master_ip);
+        s_master_held = false;
+    }
+}
+
+/**
+ * @brief Note the MAC of the master if resolved and other than cached
+ */
+static void net_cache_learn_master(struct netif *netif)
+{
+    net_cache_config_t config;
+    ip4_addr_t         ip;
+    struct eth_addr   *mac;
+    const ip4_addr_t  *found;
+
+    net_cache_get_config(&config);
+    if (config.master_addr == 0U)
+    {
+        return;
+    }
+
+    ip4_addr_set_u32(&ip, lwip_htonl(config.master_addr));
+    if ((etharp_find_addr(netif, &ip, &mac, &found) < 0) ||
+        (memcmp(mac->addr, config.master_mac, sizeof(mac->addr)) == 0))
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    if (s_config.master_addr == config.master_addr)
+    {
+        (void)memcpy(s_mac, mac->addr, sizeof(s_mac));
+        s_mac_valid = true;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief lwIP timeout: end the hold of the master's entry, check its MAC
+ */
+static void net_cache_tick(void *arg)
+{
+    struct netif *netif = (struct netif *)arg;
+
+    net_cache_release_master();
+    net_cache_learn_master(netif);
+
+    sys_timeout(NET_CACHE_LEARN_MS, net_cache_tick, netif);
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void net_cache_set_config(const net_cache_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    if (config->master_addr != s_config.master_addr)
+    {
+        s_mac_valid = false;
+    }
+    s_config = *config;
+    taskEXIT_CRITICAL();
+}
+
+void net_cache_start(SemaphoreHandle_t register_mutex)
+{
+    s_register_mutex = register_mutex;
+}
+
+err_t net_cache_dhcp_start(struct netif *netif)
+{
+    net_cache_config_t config;
+    struct dhcp       *dhcp;
+    err_t              err;
+
+    net_cache_get_config(&config);
+
+    /* With the link up this sends a DISCOVER; the REQUEST below takes a
+     * new transaction ID, so the OFFER to it is ignored */
+    err = dhcp_start(netif);
+    if ((err != ERR_OK) || (config.lease_addr == 0U))
+    {
+        return err;
+    }
+
+    /* lwIP has no call to start from INIT-REBOOT, but reboots the lease
+     * held on a network change; REBOOTING does not count as supplied */
+    dhcp = netif_dhcp_data(netif);
+    ip4_addr_set_u32(&dhcp->offered_ip_addr, lwip_htonl(config.lease_addr));
+    dhcp->state = DHCP_STATE_REBOOTING;
+    LOG("Net: Requesting cached lease %u.%u.%u.%u\n",
+        (unsigned int)ip4_addr1(&dhcp->offered_ip_addr),
+        (unsigned int)ip4_addr2(&dhcp->offered_ip_addr),
+        (unsigned int)ip4_addr3(&dhcp->offered_ip_addr),
+        (unsigned int)ip4_addr4(&dhcp->offered_ip_addr));
+
+    /* Otherwise the link coming up does it */
+    if (netif_is_link_up(netif))
+    {
+        dhcp_network_changed(netif);
+    }
+
+    return err;
+}
+
+void net_cache_netif_changed(struct netif *netif)
+{
+    const ip4_addr_t *ip   = netif_ip4_addr(netif);
+    uint32_t          addr = lwip_ntohl(ip4_addr_get_u32(ip));
+    bool              ready;
+
+    ready = netif_is_up(netif) && netif_is_link_up(netif) &&
+            !ip4_addr_isany(ip);
+
+#if LWIP_DHCP
+    if (dhcp_supplied_address(netif))
+    {
+        taskENTER_CRITICAL();
+        s_lease = addr;
+        taskEXIT_CRITICAL();
+    }
+#endif
+
+    if (!ready)
+    {
+        if (s_ready)
+        {
+            sys_untimeout(net_cache_announce, netif);
+            sys_untimeout(net_cache_tick, netif);
+            net_cache_release_master();
+            s_ready = false;
+        }
+        return;
+    }
+
+    if (s_ready && (addr == s_ready_addr))
+    {
+        return;
+    }
+
+    if (!s_ready)
+    {
+        net_cache_seed_master();
+        sys_timeout(NET_CACHE_MASTER_HOLD_MS, net_cache_tick, netif);
+    }
+
+    /* A new address is announced again, lwIP's first one included */
+    sys_untimeout(net_cache_announce, netif);
+    s_announce_left = NET_CACHE_ANNOUNCE_COUNT;
+    sys_timeout(NET_CACHE_ANNOUNCE_MS, net_cache_announce, netif);
+
+    s_ready      = true;
+    s_ready_addr = addr;
+}
+
+void net_cache_poll(void)
+{
+    SemaphoreHandle_t  mutex = s_register_mutex;
+    net_cache_config_t config;
+    uint32_t           lease;
+    uint8_t            mac[6];
+    bool               save_lease;
+    bool               save_mac;
+    uint16_t           words[3];
+
+    if (mutex == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    config     = s_config;
+    lease      = s_lease;
+    save_mac   = s_mac_valid;
+    (void)memcpy(mac, s_mac, sizeof(mac));
+    taskEXIT_CRITICAL();
+
+    save_lease = (lease != 0U) && (lease != config.lease_addr);
+    save_mac   = save_mac && (memcmp(mac, config.master_mac, sizeof(mac)) != 0);
+    if (!save_lease && !save_mac)
+    {
+        return;
+    }
+
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(NET_CACHE_LOCK_WAIT_MS)) != pdTRUE)
+    {
+        return;
+    }
+
+    /* The write callback hands the values back to net_cache_set_config() */
+    if (save_lease)
+    {
+        words[0] = (uint16_t)(lease >> 16);
+        words[1] = (uint16_t)lease;
+        (void)modbus_cb_write_multiple_registers(
+            JERRY_DEVICE_HR_NET_LEASE_IP_HIGH, 2U, words);
+    }
+    if (save_mac)
+    {
+        for (uint32_t i = 0U; i < 3U; i++)
+        {
+            words[i] = (uint16_t)(((uint16_t)mac[2U * i] << 8) |
+                                  mac[(2U * i) + 1U]);
+        }
+        (void)modbus_cb_write_multiple_registers(
+            JERRY_DEVICE_HR_NET_MASTER_MAC_HIGH, 3U, words);
+    }
+
+    (void)xSemaphoreGive(mutex);
+
+    if (save_lease)
+    {
+        LOG("Net: Lease cached\n");
+    }
+    if (save_mac)
+    {
+        LOG("Net: Master MAC cached\n");
+    }
+}
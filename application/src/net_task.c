@@ -3,25 +3,36 @@
  * All rights reserved.
  */
 
-#include "tcp_echo_task.h"
+#include "net_task.h"
 
 #include <stdio.h>
 
+#include "boot.h"
 #include "bsp.h"
+#include "bsp_sections.h"
 #include "ethernetif.h"
-#include "lwip/api.h"
+#include "log.h"
+#include "low_power.h"
 #include "lwip/dhcp.h"
 #include "lwip/netif.h"
 #include "lwip/opt.h"
 #include "lwip/stats.h"
 #include "lwip/sys.h"
 #include "lwip/tcpip.h"
+#include "lwip/timeouts.h"
+#include "metrics.h"
+#include "net_cache.h"
+#include "task_priorities.h"
+#include "twamp_reflector.h"
 
 /*---------------------------------------------------------------------------*/
 /* IP Address Configuration                                                  */
 /*---------------------------------------------------------------------------*/
-/* Set USE_DHCP to 1 for dynamic IP (DHCP), 0 for static IP                  */
+/* Set USE_DHCP to 1 for dynamic IP (DHCP), 0 for static IP (CMake option   */
+/* JERRY_USE_DHCP)                                                           */
+#ifndef USE_DHCP
 #define USE_DHCP 0
+#endif
 
 #if !USE_DHCP
 /* Static IP Configuration - modify these values as needed
@@ -51,7 +62,7 @@ struct netif gnetif;
 
 /* Ethernet Task resources */
 static StaticTask_t xEthernetTaskTCB;
-static StackType_t  xEthernetTaskStack[512];
+static StackType_t  xEthernetTaskStack[512] BSP_SECTION_STACK;
 
 /* External ethernetif initialization function */
 /* This function is typically provided by the LwIP port or BSP */
@@ -59,11 +70,12 @@ extern err_t ethernetif_init(struct netif *netif);
 
 static void vEthernetTask(void *pvParameters)
 {
-    struct netif *netif = (struct netif *)pvParameters;
-    int           count = 0;
+    struct netif *netif      = (struct netif *)pvParameters;
+    TickType_t    last_stats = xTaskGetTickCount();
     while (1)
     {
-        /* Check link status periodically */
+        /* Check the link on each PHY interrupt, and at the fallback poll
+         * interval in case an edge was missed */
         ethernetif_check_link(netif);
 
         /* NOTE: ethernetif_poll() removed - packet reception is handled by
@@ -71,104 +83,56 @@ static void vEthernetTask(void *pvParameters)
          * Having both polling and interrupt-driven reception caused race
          * conditions and intermittent packet loss. */
 
-        count++;
-        if (count >= 500)
-        { /* 5 seconds */
-            count = 0;
-            (void)printf("Stats - RX: %d, TX: %d, DROP: %d, RX_INT: %u\n",
-                         (int)lwip_stats.link.recv, (int)lwip_stats.link.xmit,
-                         (int)lwip_stats.link.drop,
-                         (unsigned int)ethernetif_get_rx_int_count());
+        if ((xTaskGetTickCount() - last_stats) >= pdMS_TO_TICKS(5000))
+        {
+            last_stats = xTaskGetTickCount();
+            LOG("Stats - RX: %d, TX: %d, DROP: %d, RX_INT: %u\n",
+                (int)lwip_stats.link.recv, (int)lwip_stats.link.xmit,
+                (int)lwip_stats.link.drop,
+                (unsigned int)ethernetif_get_rx_int_count());
         }
 
-        vTaskDelay(pdMS_TO_TICKS(10));
+        /* Save a new lease or master MAC (net_cache.h) */
+        net_cache_poll();
+
+        (void)ethernetif_wait_link_event();
     }
 }
 
 #if LWIP_NETIF_LINK_CALLBACK
 static void link_callback(struct netif *netif)
 {
+    low_power_set_ethernet_active(netif_is_link_up(netif));
+
     if (netif_is_link_up(netif))
     {
-        printf("Link status changed: UP\n");
+        LOG("Link status changed: UP\n");
+        boot_event_set(BOOT_EVENT_LINK_UP);
         /* Optional: Re-trigger DHCP or other actions if needed */
     }
     else
     {
-        printf("Link status changed: DOWN\n");
+        LOG("Link status changed: DOWN\n");
+        boot_event_clear(BOOT_EVENT_LINK_UP);
     }
-}
-#endif
 
-static void tcp_echo_thread(void *arg)
-{
-    struct netconn *conn, *newconn;
-    err_t           err;
-    LWIP_UNUSED_ARG(arg);
-
-    /* Create a new connection identifier */
-    conn = netconn_new(NETCONN_TCP);
-
-    if (conn != NULL)
-    {
-        /* Bind connection to well known port 7 */
-        err = netconn_bind(conn, NULL, 7);
-
-        if (err == ERR_OK)
-        {
-            /* Tell connection to go into listening mode */
-            netconn_listen(conn);
-            printf("TCP Echo Server listening on port 7\n");
-
-            while (1)
-            {
-                /* Grab new connection. */
-                err = netconn_accept(conn, &newconn);
-
-                /* Process the new connection. */
-                if (err == ERR_OK)
-                {
-                    printf("New connection accepted\n");
-                    struct netbuf *buf;
-                    void          *data;
-                    u16_t          len;
-
-                    while ((err = netconn_recv(newconn, &buf)) == ERR_OK)
-                    {
-                        do
-                        {
-                            netbuf_data(buf, &data, &len);
-                            err =
-                                netconn_write(newconn, data, len, NETCONN_COPY);
-                        } while (netbuf_next(buf) >= 0);
-                        netbuf_delete(buf);
-                    }
-                    /* Close connection and discard connection identifier. */
-                    netconn_close(newconn);
-                    netconn_delete(newconn);
-                    printf("Connection closed\n");
-                }
-            }
-        }
-        else
-        {
-            printf("Failed to bind connection: %d\n", err);
-            netconn_delete(conn);
-        }
-    }
-    else
-    {
-        printf("Failed to create new connection\n");
-    }
+    /* Gratuitous ARPs and the master's ARP entry */
+    net_cache_netif_changed(netif);
 }
+#endif
 
 static void tcpip_init_done_callback(void *arg)
 {
     (void)arg;
     printf("*** tcpip_thread is running! ***\n");
+
+    /* Push the lwIP error counters to the metrics from the tcpip thread */
+    sys_timeout(METRICS_LWIP_SAMPLE_MS, metrics_lwip_sample, NULL);
+
+    boot_event_set(BOOT_EVENT_NET_STACK);
 }
 
-void vTcpEchoTask(void *pvParameters)
+void vNetworkTask(void *pvParameters)
 {
     ip4_addr_t ipaddr;
     ip4_addr_t netmask;
@@ -176,7 +140,7 @@ void vTcpEchoTask(void *pvParameters)
 
     (void)pvParameters;
 
-    printf("TCP Echo Task Started\n");
+    printf("Network Task Started\n");
 
     /* Initialize the LwIP stack */
     printf("Initializing LwIP...\n");
@@ -205,8 +169,10 @@ void vTcpEchoTask(void *pvParameters)
              STATIC_GW_ADDR3);
 #endif /* USE_DHCP */
 
-    /* Add the network interface */
+    /* Add the network interface; the TCP/IP thread runs from here on, so
+     * every raw API call takes the core lock */
     printf("Adding Network Interface...\n");
+    LOCK_TCPIP_CORE();
     netif_add(&gnetif, &ipaddr, &netmask, &gw, NULL, &ethernetif_init,
               &tcpip_input);
 
@@ -217,18 +183,29 @@ void vTcpEchoTask(void *pvParameters)
 #if LWIP_NETIF_LINK_CALLBACK
     netif_set_link_callback(&gnetif, link_callback);
 #endif
+#if LWIP_NETIF_STATUS_CALLBACK
+    netif_set_status_callback(&gnetif, net_cache_netif_changed);
+#endif
+    UNLOCK_TCPIP_CORE();
 
     /* Create Ethernet Task to drive the interface */
     xTaskCreateStatic(vEthernetTask, "Ethernet", 512, &gnetif,
-                      tskIDLE_PRIORITY + 2, xEthernetTaskStack,
+                      TASK_PRIO_ETHERNET, xEthernetTaskStack,
                       &xEthernetTaskTCB);
 
     /* Always bring the interface up administratively so DHCP can start */
+    LOCK_TCPIP_CORE();
     netif_set_up(&gnetif);
+    UNLOCK_TCPIP_CORE();
+
+    /* The servers can bind and listen from now on, link or not */
+    boot_event_set(BOOT_EVENT_NETIF_UP);
 
+    low_power_set_ethernet_active(netif_is_link_up(&gnetif));
     if (netif_is_link_up(&gnetif))
     {
         printf("Initial Link status: UP\n");
+        boot_event_set(BOOT_EVENT_LINK_UP);
     }
     else
     {
@@ -249,9 +226,13 @@ void vTcpEchoTask(void *pvParameters)
     printf("========================================\n");
 
 #if USE_DHCP
-    /* Start DHCP to obtain IP address automatically */
+    /* Start DHCP to obtain IP address automatically, asking for the cached
+     * lease first; the lease is one of the saved registers */
+    (void)boot_wait(BOOT_EVENT_CONFIG, BOOT_WAIT_FOREVER);
     printf("Starting DHCP...\n");
-    dhcp_start(&gnetif);
+    LOCK_TCPIP_CORE();
+    (void)net_cache_dhcp_start(&gnetif);
+    UNLOCK_TCPIP_CORE();
 
     /* Wait for DHCP to obtain an IP address */
     printf("Waiting for DHCP to obtain IP address...\n");
@@ -282,9 +263,10 @@ void vTcpEchoTask(void *pvParameters)
     printf("===============================\n");
 #endif /* USE_DHCP */
 
-    /* Create the TCP Echo Server thread */
-    tcp_echo_thread(NULL);
+#if TWAMP_REFLECTOR
+    twamp_reflector_start();
+#endif
 
-    /* Should not reach here */
-    for (;;);
+    /* The Ethernet task and the TCP/IP thread run the interface from here */
+    vTaskDelete(NULL);
 }
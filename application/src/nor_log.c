@@ -0,0 +1,1164 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * SPI NOR Flash Circular Sample and Event Logger
+ *
+ * The capture job owns the page it fills and hands it over as a copy
+ * through the page queue, so it never waits for the writer. The writer
+ * alone changes the sector index and the write position; it and the
+ * back-fill server make every flash call, and read or change the index,
+ * with the log mutex held, which the writer only holds for one page or
+ * one erase step at a time. The archives (adc_archive.h) make theirs under
+ * it as well. The back-fill reads a chunk under the mutex
+ * and sends it without, so a slow client only slows itself. The format is
+ * described in nor_log.h.
+ */
+
+#include "nor_log.h"
+
+#if BSP_SPINOR_ENABLE
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_archive.h"
+#include "boot.h"
+#include "bsp_sections.h"
+#include "log.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "lwip/netbuf.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack sizes of the tasks (words) */
+#define NOR_LOG_WRITE_STACK_SIZE 384U
+#define NOR_LOG_FILL_STACK_SIZE  384U
+
+/** Pages queued for the writer, about 7 s of frames */
+#define NOR_LOG_QUEUE_PAGES 8U
+
+/** Events waiting for the writer (power of two) */
+#define NOR_LOG_EVENT_RING 32U
+
+/** Writer wait for a page, and its erase poll period */
+#define NOR_LOG_POLL_MS 100U
+
+/** Decimated samples copied out of the ring per read, one job period */
+#define NOR_LOG_READ_CHUNK 16U
+
+/** Longest pause in a back-fill request before it is given up */
+#define NOR_LOG_FILL_RECV_TIMEOUT_MS 5000
+
+/** Sectors and pages the index can hold */
+#define NOR_LOG_MAX_SECTORS (BSP_SPINOR_MAX_SIZE / BSP_SPINOR_SECTOR_SIZE)
+#define NOR_LOG_SECTOR_PAGES (BSP_SPINOR_SECTOR_SIZE / BSP_SPINOR_PAGE_SIZE)
+
+/** No sector */
+#define NOR_LOG_NONE 0xFFFFFFFFU
+
+/** Sector sequence field of an erased page */
+#define NOR_LOG_ERASED 0xFFFFFFFFU
+
+_Static_assert(BSP_SPINOR_PAGE_SIZE == (NOR_LOG_PAGE_CRC_OFFSET + 2U),
+               "the CRC must end a page");
+_Static_assert((NOR_LOG_EVENT_RING & (NOR_LOG_EVENT_RING - 1U)) == 0U,
+               "the event ring size must be a power of two");
+_Static_assert(NOR_LOG_FRAMES_PER_PAGE <= 0xFFU,
+               "the record count is one byte");
+_Static_assert(NOR_LOG_SECTOR_PAGES <= 0xFFFFU,
+               "pages per sector are reported in 16 bits");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief What the index knows of a sector
+ */
+typedef enum
+{
+    NOR_LOG_SECTOR_DIRTY  = 0, /**< Unknown or being erased */
+    NOR_LOG_SECTOR_ERASED = 1, /**< Erased, no header yet */
+    NOR_LOG_SECTOR_USED   = 2, /**< Header written */
+} nor_log_sector_state_t;
+
+/**
+ * @brief Index entry of a sector
+ */
+typedef struct
+{
+    uint64_t first_ns; /**< Time of its first data page, 0 if unknown */
+    uint32_t sequence; /**< Sector sequence, if used */
+    uint8_t  state;    /**< nor_log_sector_state_t */
+} nor_log_sector_t;
+
+/**
+ * @brief Capture job state
+ */
+typedef struct
+{
+    bsp_adc1_reader_t reader;  /**< Decimated ring cursor */
+    bool              active;  /**< Reader attached */
+    bool              started; /**< A frame was made since attaching */
+    bool              open;    /**< A frame is being summed */
+    float32_t sum[BSP_ADC1_NUM_CHANNELS]; /**< Sums of the frame */
+    uint32_t  count;          /**< Decimated samples in the frame */
+    uint32_t  frame_sequence; /**< Sequence the frame starts at */
+    uint32_t  frame_end;      /**< Sequence the next frame starts at */
+    uint64_t  frame_ns;       /**< Time of its start, 0 if unknown */
+    uint32_t  next_sequence;  /**< Sequence that continues the frame */
+    uint32_t  frames;         /**< Frames in the page */
+    uint32_t  page_sequence;  /**< Frame sequence that continues the page */
+    uint32_t  lost;           /**< Frames lost since the last page */
+    uint8_t   page[BSP_SPINOR_PAGE_SIZE]; /**< Page being filled */
+} nor_log_capture_t;
+
+/**
+ * @brief Write position, changed by the writer under the log mutex
+ */
+typedef struct
+{
+    uint32_t sectors;       /**< Sectors in the log */
+    uint32_t sector;        /**< Sector being written */
+    uint32_t page;          /**< Page written next, NOR_LOG_SECTOR_PAGES
+                                 once the sector is full */
+    uint32_t next_sequence; /**< Sequence of the next sector */
+    uint32_t erasing;       /**< Sector being erased, NOR_LOG_NONE if none */
+    uint64_t newest_ns;     /**< Time of the last page written, 0 if none */
+} nor_log_writer_t;
+
+/**
+ * @brief Event waiting for the writer
+ */
+typedef struct
+{
+    uint64_t time_ns; /**< BSP_Time_NowNs() when recorded */
+    int32_t  value;   /**< Value */
+    uint16_t index;   /**< Rule or channel */
+    uint8_t  source;  /**< nor_log_source_t */
+    uint8_t  kind;    /**< Kind */
+} nor_log_event_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+/** Task control blocks and stacks */
+static StaticTask_t s_write_task_tcb;
+static StackType_t  s_write_task_stack[NOR_LOG_WRITE_STACK_SIZE]
+    BSP_SECTION_STACK;
+static StaticTask_t s_fill_task_tcb;
+static StackType_t  s_fill_task_stack[NOR_LOG_FILL_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** Pages from the capture job to the writer */
+static StaticQueue_t s_queue_buffer;
+static uint8_t       s_queue_storage[NOR_LOG_QUEUE_PAGES *
+                                     BSP_SPINOR_PAGE_SIZE];
+static QueueHandle_t s_queue = NULL;
+
+/** Serializes the flash, the index and the write position */
+static StaticSemaphore_t s_lock_buffer;
+static SemaphoreHandle_t s_lock = NULL;
+
+/** Set by the writer once the flash is mounted */
+static atomic_bool s_mounted;
+
+/** Flash size found by the writer, valid once s_probed is set */
+static uint32_t    s_flash_size;
+static atomic_bool s_probed;
+
+/** Sector index */
+static nor_log_sector_t s_index[NOR_LOG_MAX_SECTORS];
+
+static nor_log_writer_t  s_writer;
+static nor_log_capture_t s_capture;
+
+/** Event ring, written and drained in critical sections */
+static nor_log_event_t s_events[NOR_LOG_EVENT_RING];
+static uint32_t        s_event_head;
+static uint32_t        s_event_tail;
+static uint32_t        s_event_lost;
+
+/** Samples copied out of the ring, kept off the executive's stack */
+static bsp_adc1_sample_t s_chunk[NOR_LOG_READ_CHUNK];
+
+/** Page being written and sector header (writer task) */
+static uint8_t s_page[BSP_SPINOR_PAGE_SIZE];
+static uint8_t s_header[BSP_SPINOR_PAGE_SIZE];
+
+/** Chunk of a back-fill (server task) */
+static uint8_t s_fill[NOR_LOG_FILL_PAGES * BSP_SPINOR_PAGE_SIZE];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+static uint8_t *put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFU);
+    dst[1] = (uint8_t)(value >> 8U);
+    return &dst[2];
+}
+
+static uint8_t *put_u32(uint8_t *dst, uint32_t value)
+{
+    dst = put_u16(dst, (uint16_t)(value & 0xFFFFU));
+    return put_u16(dst, (uint16_t)(value >> 16U));
+}
+
+static uint8_t *put_u64(uint8_t *dst, uint64_t value)
+{
+    dst = put_u32(dst, (uint32_t)(value & 0xFFFFFFFFU));
+    return put_u32(dst, (uint32_t)(value >> 32U));
+}
+
+static uint16_t get_u16(const uint8_t *src)
+{
+    return (uint16_t)((uint16_t)src[0] | ((uint16_t)src[1] << 8U));
+}
+
+static uint32_t get_u32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8U) |
+           ((uint32_t)src[2] << 16U) | ((uint32_t)src[3] << 24U);
+}
+
+static uint64_t get_u64(const uint8_t *src)
+{
+    return (uint64_t)get_u32(src) | ((uint64_t)get_u32(&src[4]) << 32U);
+}
+
+static uint32_t nor_log_address(uint32_t sector, uint32_t page)
+{
+    return (sector * BSP_SPINOR_SECTOR_SIZE) + (page * BSP_SPINOR_PAGE_SIZE);
+}
+
+/**
+ * @brief Check a data page read back
+ *
+ * @param[in] page     The page
+ * @param[in] sequence Sequence of the sector it was read from
+ */
+static bool nor_log_page_valid(const uint8_t *page, uint32_t sequence)
+{
+    return (get_u32(page) == sequence) &&
+           (modbus_crc16(page, NOR_LOG_PAGE_CRC_OFFSET) ==
+            get_u16(&page[NOR_LOG_PAGE_CRC_OFFSET]));
+}
+
+/**
+ * @brief Queue the page of frames for the writer
+ */
+static void nor_log_close_page(nor_log_capture_t *capture)
+{
+    uint8_t *page = capture->page;
+
+    page[5] = (uint8_t)capture->frames;
+    (void)put_u16(&page[6], (capture->lost > 0xFFFFU)
+                                ? 0xFFFFU
+                                : (uint16_t)capture->lost);
+
+    if (xQueueSend(s_queue, page, 0U) == pdPASS)
+    {
+        capture->lost = 0U;
+    }
+    else
+    {
+        capture->lost += capture->frames;
+        metrics_add(METRIC_NOR_LOG_LOST, capture->frames);
+    }
+    capture->frames = 0U;
+}
+
+/**
+ * @brief Add the completed frame to the page
+ */
+static void nor_log_add_frame(nor_log_capture_t *capture)
+{
+
+    uint32_t spacing = capture->frame_end - capture->frame_sequence;
+    uint8_t *dst;
+
+    /* A frame that does not follow the page's last, or not at its spacing,
+     * starts a new page */
+    if ((capture->frames > 0U) &&
+        ((capture->frame_sequence != capture->page_sequence) ||
+         (spacing != get_u32(&capture->page[20]))))
+    {
+        nor_log_close_page(capture);
+    }
+
+    if (capture->frames == 0U)
+    {
+        int32_t missing = (int32_t)(capture->frame_sequence -
+                                    capture->page_sequence);
+
+        /* Frames missing since the last one made, to gaps or overruns */
+        if (capture->started && (missing > 0))
+        {
+            capture->lost += (uint32_t)missing / spacing;
+        }
+        (void)memset(capture->page, 0, sizeof(capture->page));
+        capture->page[4] = (uint8_t)NOR_LOG_PAGE_SAMPLES;
+        (void)put_u64(&capture->page[8], capture->frame_ns);
+        (void)put_u32(&capture->page[16], capture->frame_sequence);
+        (void)put_u32(&capture->page[20], spacing);
+    }
+
+    dst = &capture->page[NOR_LOG_PAGE_HEADER_SIZE +
+                         (capture->frames * NOR_LOG_FRAME_SIZE)];
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        float32_t mean = capture->sum[ch] / (float32_t)capture->count;
+        uint32_t  bits;
+
+        (void)memcpy(&bits, &mean, sizeof(bits));
+        dst = put_u32(dst, bits);
+    }
+
+    capture->frames++;
+    capture->started       = true;
+    capture->page_sequence = capture->frame_end;
+
+    if (capture->frames == NOR_LOG_FRAMES_PER_PAGE)
+    {
+        nor_log_close_page(capture);
+    }
+}
+
+/**
+ * @brief Start a frame at a sample sequence
+ *
+ * A frame spans the samples of NOR_LOG_FRAME_MS at the rate in force, so
+ * frames hold the same time whatever the rate; one that is not a whole
+ * number of decimated samples holds one more or one fewer now and then.
+ */
+static void nor_log_open_frame(nor_log_capture_t *capture, uint32_t sequence)
+{
+    capture->open           = true;
+    capture->count          = 0U;
+    capture->frame_sequence = sequence;
+    capture->frame_end      =
+        sequence + ((BSP_ADC1_GetSampleRate() * NOR_LOG_FRAME_MS) / 1000U);
+    if (BSP_ADC1_GetSampleTimeNs(sequence, &capture->frame_ns) != BSP_OK)
+    {
+        capture->frame_ns = 0U;
+    }
+    (void)memset(capture->sum, 0, sizeof(capture->sum));
+}
+
+/**
+ * @brief Add one decimated sample to the frame
+ */
+static void nor_log_sample(nor_log_capture_t       *capture,
+                           const bsp_adc1_sample_t *sample)
+{
+    /* A gap, an overrun or a rate change ends the frame early; it is
+     * counted lost by the next frame made */
+    if (capture->open && (sample->sequence != capture->next_sequence))
+    {
+        capture->open = false;
+    }
+
+    if (!capture->open)
+    {
+        nor_log_open_frame(capture, sample->sequence);
+    }
+
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        capture->sum[ch] += sample->filtered[ch];
+    }
+    capture->count++;
+    capture->next_sequence = sample->sequence + ADC_FILTER_DECIMATION_FACTOR;
+
+    if ((int32_t)(capture->next_sequence - capture->frame_end) >= 0)
+    {
+        nor_log_add_frame(capture);
+        nor_log_open_frame(capture, capture->frame_end);
+    }
+}
+
+/**
+ * @brief Find the first erased page of a sector
+ *
+ * Pages are written in order from page 0, so the written ones come first.
+ *
+ * @return Page number, NOR_LOG_SECTOR_PAGES if the sector is full
+ */
+static uint32_t nor_log_find_end(uint32_t sector)
+{
+    uint32_t lo = 1U;
+    uint32_t hi = NOR_LOG_SECTOR_PAGES;
+    uint8_t  word[4];
+
+    while (lo < hi)
+    {
+        uint32_t mid = lo + ((hi - lo) / 2U);
+
+        if ((BSP_SPINOR_Read(nor_log_address(sector, mid), word,
+                             sizeof(word)) == BSP_OK) &&
+            (get_u32(word) == NOR_LOG_ERASED))
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1U;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * @brief Probe the flash, build the index and find the write position
+ *
+ * Writer task, log mutex held.
+ */
+static bool nor_log_mount(nor_log_writer_t *writer)
+{
+    uint32_t size;
+    uint32_t newest = NOR_LOG_NONE;
+
+    if (BSP_SPINOR_Probe(&size) != BSP_OK)
+    {
+        size = 0U;
+    }
+    s_flash_size = size;
+    atomic_store(&s_probed, true);
+
+    writer->sectors = size / BSP_SPINOR_SECTOR_SIZE;
+#if ADC_ARCHIVE
+    /* The top of the flash holds the archives */
+    writer->sectors = (writer->sectors > ADC_ARCHIVE_SECTORS)
+                          ? (writer->sectors - ADC_ARCHIVE_SECTORS)
+                          : 0U;
+#endif
+    if (writer->sectors <= (NOR_LOG_ERASE_AHEAD + 1U))
+    {
+        return false;
+    }
+
+    for (uint32_t s = 0U; s < writer->sectors; s++)
+    {
+        nor_log_sector_t *entry = &s_index[s];
+        const uint8_t    *hdr   = s_page;
+
+        entry->state    = (uint8_t)NOR_LOG_SECTOR_DIRTY;
+        entry->sequence = 0U;
+        entry->first_ns = 0U;
+
+        if ((BSP_SPINOR_Read(nor_log_address(s, 0U), s_page,
+                             NOR_LOG_HEADER_SIZE) != BSP_OK) ||
+            (get_u32(hdr) != NOR_LOG_MAGIC) ||
+            (get_u16(&hdr[4]) != NOR_LOG_VERSION) ||
+            (get_u32(&hdr[12]) != BSP_SPINOR_SECTOR_SIZE) ||
+            (get_u16(&hdr[16]) != BSP_SPINOR_PAGE_SIZE) ||
+            (modbus_crc16(hdr, NOR_LOG_HEADER_SIZE - 2U) != get_u16(&hdr[30])))
+        {
+            continue;
+        }
+
+        entry->state    = (uint8_t)NOR_LOG_SECTOR_USED;
+        entry->sequence = get_u32(&hdr[8]);
+        if ((BSP_SPINOR_Read(nor_log_address(s, 1U), s_page,
+                             BSP_SPINOR_PAGE_SIZE) == BSP_OK) &&
+            nor_log_page_valid(s_page, entry->sequence))
+        {
+            entry->first_ns = get_u64(&s_page[8]);
+        }
+
+        if ((newest == NOR_LOG_NONE) ||
+            ((int32_t)(entry->sequence - s_index[newest].sequence) > 0))
+        {
+            newest = s;
+        }
+    }
+
+    writer->erasing   = NOR_LOG_NONE;
+    writer->newest_ns = 0U;
+
+    if (newest == NOR_LOG_NONE)
+    {
+        /* A blank or foreign flash: start at sector 0 once it is erased */
+        writer->sector        = 0U;
+        writer->page          = 0U;
+        writer->next_sequence = 0U;
+        return true;
+    }
+
+    writer->sector        = newest;
+    writer->next_sequence = s_index[newest].sequence + 1U;
+    writer->page          = nor_log_find_end(newest);
+    if ((writer->page > 1U) &&
+        (BSP_SPINOR_Read(nor_log_address(newest, writer->page - 1U), s_page,
+                         BSP_SPINOR_PAGE_SIZE) == BSP_OK) &&
+        nor_log_page_valid(s_page, s_index[newest].sequence))
+    {
+        writer->newest_ns = get_u64(&s_page[8]);
+    }
+
+    /* No sector counts as erased yet, so the erase ahead also redoes one
+     * that the reset cut short */
+    return true;
+}
+
+/**
+ * @brief Keep the sectors ahead of the write position erased
+ *
+ * Ends the erase in flight once the flash has finished it and starts the
+ * next one needed; never waits. Writer task, log mutex held.
+ */
+static void nor_log_erase_ahead(nor_log_writer_t *writer)
+{
+    if (writer->erasing != NOR_LOG_NONE)
+    {
+        if (BSP_SPINOR_IsErasing())
+        {
+            return;
+        }
+        s_index[writer->erasing].state = (uint8_t)NOR_LOG_SECTOR_ERASED;
+        writer->erasing                = NOR_LOG_NONE;
+    }
+
+    /* The write sector itself only before its header is written */
+    for (uint32_t k = (writer->page == 0U) ? 0U : 1U;
+         k <= NOR_LOG_ERASE_AHEAD; k++)
+    {
+        uint32_t          s     = (writer->sector + k) % writer->sectors;
+        nor_log_sector_t *entry = &s_index[s];
+
+        if (entry->state == (uint8_t)NOR_LOG_SECTOR_ERASED)
+        {
+            continue;
+        }
+
+        /* Out of the index before the first byte goes */
+        entry->state    = (uint8_t)NOR_LOG_SECTOR_DIRTY;
+        entry->first_ns = 0U;
+        if (BSP_SPINOR_EraseSector(nor_log_address(s, 0U)) == BSP_OK)
+        {
+            writer->erasing = s;
+        }
+        return;
+    }
+}
+
+/**
+ * @brief Check that the write position can take a page without waiting
+ *
+ * Writer task, log mutex held.
+ */
+static bool nor_log_writable(const nor_log_writer_t *writer)
+{
+    if (writer->page == NOR_LOG_SECTOR_PAGES)
+    {
+        return s_index[(writer->sector + 1U) % writer->sectors].state ==
+               (uint8_t)NOR_LOG_SECTOR_ERASED;
+    }
+    if (writer->page == 0U)
+    {
+        return s_index[writer->sector].state ==
+               (uint8_t)NOR_LOG_SECTOR_ERASED;
+    }
+    return true;
+}
+
+/**
+ * @brief Write the sector header of the write sector
+ *
+ * Writer task, log mutex held.
+ */
+static bool nor_log_write_header(nor_log_writer_t *writer)
+{
+    nor_log_sector_t *entry  = &s_index[writer->sector];
+    uint8_t          *header = s_header;
+    uint8_t          *hdr    = header;
+
+    (void)memset(header, 0xFF, BSP_SPINOR_PAGE_SIZE);
+    hdr = put_u32(hdr, NOR_LOG_MAGIC);
+    hdr = put_u16(hdr, NOR_LOG_VERSION);
+    hdr = put_u16(hdr, NOR_LOG_HEADER_SIZE);
+    hdr = put_u32(hdr, writer->next_sequence);
+    hdr = put_u32(hdr, BSP_SPINOR_SECTOR_SIZE);
+    hdr = put_u16(hdr, BSP_SPINOR_PAGE_SIZE);
+    hdr = put_u16(hdr, NOR_LOG_PAGE_HEADER_SIZE);
+    *hdr++ = (uint8_t)BSP_ADC1_NUM_CHANNELS;
+    *hdr++ = 0U;
+    hdr    = put_u16(hdr, NOR_LOG_FRAME_MS);
+    hdr    = put_u32(hdr, writer->sectors);
+    hdr    = put_u16(hdr, 0U);
+    (void)put_u16(hdr, modbus_crc16(header, NOR_LOG_HEADER_SIZE - 2U));
+
+    if (BSP_SPINOR_ProgramPage(nor_log_address(writer->sector, 0U), header) !=
+        BSP_OK)
+    {
+        /* Erase it again before another try */
+        entry->state = (uint8_t)NOR_LOG_SECTOR_DIRTY;
+        return false;
+    }
+
+    entry->state    = (uint8_t)NOR_LOG_SECTOR_USED;
+    entry->sequence = writer->next_sequence;
+    entry->first_ns = 0U;
+    writer->next_sequence++;
+    writer->page = 1U;
+    return true;
+}
+
+/**
+ * @brief Write a data page at the write position
+ *
+ * nor_log_writable() must hold. A page that fails to program is given up
+ * and its position skipped; readers drop it by its CRC. Writer task, log
+ * mutex held.
+ *
+ * @param[in,out] page Page, but for its sector sequence and CRC
+ */
+static void nor_log_write_page(nor_log_writer_t *writer, uint8_t *page)
+{
+    nor_log_sector_t *entry;
+    uint64_t          time_ns = get_u64(&page[8]);
+
+    if (writer->page == NOR_LOG_SECTOR_PAGES)
+    {
+        writer->sector = (writer->sector + 1U) % writer->sectors;
+        writer->page   = 0U;
+    }
+    if ((writer->page == 0U) && !nor_log_write_header(writer))
+    {
+        metrics_add(METRIC_NOR_LOG_LOST, page[5]);
+        return;
+    }
+
+    entry = &s_index[writer->sector];
+    (void)put_u32(page, entry->sequence);
+    (void)put_u16(&page[NOR_LOG_PAGE_CRC_OFFSET],
+                  modbus_crc16(page, NOR_LOG_PAGE_CRC_OFFSET));
+
+    if (BSP_SPINOR_ProgramPage(nor_log_address(writer->sector, writer->page),
+                               page) != BSP_OK)
+    {
+        metrics_add(METRIC_NOR_LOG_LOST, page[5]);
+    }
+    else
+    {
+        if (writer->page == 1U)
+        {
+            entry->first_ns = time_ns;
+        }
+        writer->newest_ns = time_ns;
+    }
+    writer->page++;
+}
+
+/**
+ * @brief Pack the oldest waiting events into a page
+ */
+static void nor_log_events_page(uint8_t *page)
+{
+    uint8_t *dst = &page[NOR_LOG_PAGE_HEADER_SIZE];
+    uint32_t first;
+    uint32_t count;
+    uint32_t lost;
+
+    (void)memset(page, 0, BSP_SPINOR_PAGE_SIZE);
+
+    taskENTER_CRITICAL();
+    first = s_event_tail;
+    count = s_event_head - first;
+    if (count > NOR_LOG_EVENTS_PER_PAGE)
+    {
+        count = NOR_LOG_EVENTS_PER_PAGE;
+    }
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const nor_log_event_t *event =
+            &s_events[(first + i) & (NOR_LOG_EVENT_RING - 1U)];
+
+        dst    = put_u64(dst, event->time_ns);
+        *dst++ = event->source;
+        *dst++ = event->kind;
+        dst    = put_u16(dst, event->index);
+        dst    = put_u32(dst, (uint32_t)event->value);
+    }
+    s_event_tail = first + count;
+    lost         = s_event_lost;
+    s_event_lost = 0U;
+    taskEXIT_CRITICAL();
+
+    page[4] = (uint8_t)NOR_LOG_PAGE_EVENTS;
+    page[5] = (uint8_t)count;
+    (void)put_u16(&page[6], (lost > 0xFFFFU) ? 0xFFFFU : (uint16_t)lost);
+    (void)put_u64(&page[8], get_u64(&page[NOR_LOG_PAGE_HEADER_SIZE]));
+    (void)put_u32(&page[16], first);
+}
+
+/**
+ * @brief Writer task: erase ahead, write the queued pages and the events
+ */
+static void nor_log_write_task(void *pvParameters)
+{
+    nor_log_writer_t *writer  = &s_writer;
+    bool              waiting = false;
+    TickType_t        since   = 0U;
+    bool              mounted;
+
+    (void)pvParameters;
+
+    (void)xSemaphoreTake(s_lock, portMAX_DELAY);
+    mounted = nor_log_mount(writer);
+    (void)xSemaphoreGive(s_lock);
+
+    if (!mounted)
+    {
+        LOG("NOR log: No flash found\n");
+        vTaskDelete(NULL);
+    }
+
+    LOG("NOR log: %u sectors, writing sector %u page %u\n",
+        (unsigned int)writer->sectors, (unsigned int)writer->sector,
+        (unsigned int)writer->page);
+    atomic_store(&s_mounted, true);
+
+    for (;;)
+    {
+        uint32_t pending;
+        bool     ready;
+
+        (void)xSemaphoreTake(s_lock, portMAX_DELAY);
+        nor_log_erase_ahead(writer);
+        ready = nor_log_writable(writer);
+        (void)xSemaphoreGive(s_lock);
+
+        /* Pages wait in the queue for the erase ahead to catch up */
+        if (!ready)
+        {
+            vTaskDelay(pdMS_TO_TICKS(NOR_LOG_POLL_MS));
+            continue;
+        }
+
+        taskENTER_CRITICAL();
+        pending = s_event_head - s_event_tail;
+        taskEXIT_CRITICAL();
+
+        if (pending == 0U)
+        {
+            waiting = false;
+        }
+        else if (!waiting)
+        {
+            waiting = true;
+            since   = xTaskGetTickCount();
+        }
+
+        if (waiting && ((pending >= NOR_LOG_EVENTS_PER_PAGE) ||
+                        ((xTaskGetTickCount() - since) >=
+                         pdMS_TO_TICKS(NOR_LOG_EVENT_FLUSH_MS))))
+        {
+            nor_log_events_page(s_page);
+            waiting = false;
+        }
+        else if (xQueueReceive(s_queue, s_page,
+                               pdMS_TO_TICKS(NOR_LOG_POLL_MS)) != pdPASS)
+        {
+            continue;
+        }
+
+        (void)xSemaphoreTake(s_lock, portMAX_DELAY);
+        nor_log_write_page(writer, s_page);
+        (void)xSemaphoreGive(s_lock);
+    }
+}
+
+/**
+ * @brief Receive the back-fill request
+ *
+ * @param[out] start_ns Start time, 0 for the oldest page
+ * @param[out] end_ns   End time, 0 for the newest page
+ */
+static bool nor_log_fill_request(struct netconn *conn, uint64_t *start_ns,
+                                 uint64_t *end_ns)
+{
+    uint8_t        request[NOR_LOG_FILL_REQUEST_SIZE];
+    uint32_t       received = 0U;
+    struct netbuf *buf;
+
+    while (received < sizeof(request))
+    {
+        if (netconn_recv(conn, &buf) != ERR_OK)
+        {
+            return false;
+        }
+        received += netbuf_copy_partial(buf, &request[received],
+                                        (u16_t)(sizeof(request) - received),
+                                        0U);
+        netbuf_delete(buf);
+    }
+
+    *start_ns = get_u64(&request[4]);
+    *end_ns   = get_u64(&request[12]);
+
+    return (get_u16(request) == NOR_LOG_FILL_MAGIC) &&
+           (request[2] == NOR_LOG_VERSION);
+}
+
+/**
+ * @brief Find where a back-fill starts
+ *
+ * The newest sector starting at or before the start time, and in it the
+ * last page starting at or before it; the oldest page kept for a start
+ * before it or 0. Log mutex held.
+ *
+ * @param[out] sector First sector, NOR_LOG_NONE if the log is empty
+ * @param[out] page   First page in it
+ * @param[out] oldest_ns Time of the oldest sector kept
+ */
+static void nor_log_fill_find(uint64_t start_ns, uint32_t *sector,
+                              uint32_t *page, uint64_t *oldest_ns)
+{
+    const nor_log_writer_t *writer = &s_writer;
+    uint32_t                oldest = NOR_LOG_NONE;
+    uint32_t                best   = NOR_LOG_NONE;
+    uint32_t                lo     = 1U;
+    uint32_t                hi;
+
+    for (uint32_t s = 0U; s < writer->sectors; s++)
+    {
+        const nor_log_sector_t *entry = &s_index[s];
+
+        if (entry->state != (uint8_t)NOR_LOG_SECTOR_USED)
+        {
+            continue;
+        }
+        if ((oldest == NOR_LOG_NONE) ||
+            ((int32_t)(entry->sequence - s_index[oldest].sequence) < 0))
+        {
+            oldest = s;
+        }
+        if ((start_ns != 0U) && (entry->first_ns != 0U) &&
+            (entry->first_ns <= start_ns) &&
+            ((best == NOR_LOG_NONE) ||
+             ((int32_t)(entry->sequence - s_index[best].sequence) > 0)))
+        {
+            best = s;
+        }
+    }
+
+    *oldest_ns = (oldest != NOR_LOG_NONE) ? s_index[oldest].first_ns : 0U;
+    *sector    = (best != NOR_LOG_NONE) ? best : oldest;
+    *page      = 1U;
+    if (best == NOR_LOG_NONE)
+    {
+        return;
+    }
+
+    /* Page times rise through a sector, to within a page of records */
+    hi = (best == writer->sector) ? writer->page : NOR_LOG_SECTOR_PAGES;
+    while ((hi - lo) > 1U)
+    {
+        uint32_t mid = lo + ((hi - lo) / 2U);
+        uint8_t  hdr[NOR_LOG_PAGE_HEADER_SIZE];
+
+        if ((BSP_SPINOR_Read(nor_log_address(best, mid), hdr, sizeof(hdr)) ==
+             BSP_OK) &&
+            (get_u32(hdr) == s_index[best].sequence) &&
+            (get_u64(&hdr[8]) <= start_ns))
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    *page = lo;
+}
+
+/**
+ * @brief Send the reply header and the pages of one back-fill
+ */
+static void nor_log_fill(struct netconn *conn)
+{
+    uint8_t               reply[NOR_LOG_FILL_HEADER_SIZE] = {0};
+    nor_log_fill_status_t status = NOR_LOG_FILL_OK;
+    uint64_t              start_ns;
+    uint64_t              end_ns;
+    uint64_t              oldest_ns = 0U;
+    uint64_t              newest_ns = 0U;
+    uint32_t              sector    = NOR_LOG_NONE;
+    uint32_t              sequence  = 0U;
+    uint32_t              page      = 1U;
+    uint8_t              *hdr;
+
+    if (!nor_log_fill_request(conn, &start_ns, &end_ns))
+    {
+        status = NOR_LOG_FILL_BAD_REQUEST;
+    }
+    else if (!atomic_load(&s_mounted))
+    {
+        status = NOR_LOG_FILL_NO_LOG;
+    }
+    else
+    {
+        (void)xSemaphoreTake(s_lock, portMAX_DELAY);
+        nor_log_fill_find(start_ns, &sector, &page, &oldest_ns);
+        if (sector != NOR_LOG_NONE)
+        {
+            sequence = s_index[sector].sequence;
+        }
+        newest_ns = s_writer.newest_ns;
+        (void)xSemaphoreGive(s_lock);
+    }
+
+    hdr    = put_u16(reply, NOR_LOG_FILL_MAGIC);
+    *hdr++ = (uint8_t)NOR_LOG_VERSION;
+    *hdr++ = (uint8_t)status;
+    hdr    = put_u16(hdr, BSP_SPINOR_PAGE_SIZE);
+    hdr    = put_u16(hdr, NOR_LOG_SECTOR_PAGES);
+    hdr    = put_u32(hdr, s_writer.sectors);
+    hdr    = put_u16(hdr, NOR_LOG_FRAME_MS);
+    hdr    = put_u16(hdr, 0U);
+    hdr    = put_u64(hdr, oldest_ns);
+    (void)put_u64(hdr, newest_ns);
+    if ((netconn_write(conn, reply, sizeof(reply), NETCONN_COPY) != ERR_OK) ||
+        (status != NOR_LOG_FILL_OK))
+    {
+        return;
+    }
+
+    while (sector != NOR_LOG_NONE)
+    {
+        const nor_log_sector_t *entry = &s_index[sector];
+        uint32_t                limit;
+        uint32_t                pages;
+        uint32_t                send;
+        bsp_error_t             result;
+
+        (void)xSemaphoreTake(s_lock, portMAX_DELAY);
+        limit = (sector == s_writer.sector) ? s_writer.page
+                                            : NOR_LOG_SECTOR_PAGES;
+        /* Stop where the erase ahead has overtaken the back-fill */
+        if ((entry->state != (uint8_t)NOR_LOG_SECTOR_USED) ||
+            (entry->sequence != sequence))
+        {
+            (void)xSemaphoreGive(s_lock);
+            break;
+        }
+        if (page >= limit)
+        {
+            uint32_t next = (sector + 1U) % s_writer.sectors;
+
+            sector = NOR_LOG_NONE;
+            if ((limit == NOR_LOG_SECTOR_PAGES) &&
+                (s_index[next].state == (uint8_t)NOR_LOG_SECTOR_USED) &&
+                (s_index[next].sequence == (sequence + 1U)))
+            {
+                sector = next;
+                sequence++;
+                page = 1U;
+            }
+            (void)xSemaphoreGive(s_lock);
+            continue;
+        }
+        pages = limit - page;
+        if (pages > NOR_LOG_FILL_PAGES)
+        {
+            pages = NOR_LOG_FILL_PAGES;
+        }
+        result = BSP_SPINOR_Read(nor_log_address(sector, page), s_fill,
+                                 pages * BSP_SPINOR_PAGE_SIZE);
+        (void)xSemaphoreGive(s_lock);
+
+        if (result != BSP_OK)
+        {
+            break;
+        }
+
+        /* Up to the first page starting after the end time */
+        for (send = 0U; send < pages; send++)
+        {
+            const uint8_t *p = &s_fill[send * BSP_SPINOR_PAGE_SIZE];
+
+            if ((end_ns != 0U) && (get_u32(p) == sequence) &&
+                (get_u64(&p[8]) > end_ns))
+            {
+                sector = NOR_LOG_NONE;
+                break;
+            }
+        }
+        if ((send > 0U) &&
+            (netconn_write(conn, s_fill, send * BSP_SPINOR_PAGE_SIZE,
+                           NETCONN_COPY) != ERR_OK))
+        {
+            break;
+        }
+        page += pages;
+    }
+}
+
+/**
+ * @brief Back-fill server task
+ */
+static void nor_log_fill_task(void *pvParameters)
+{
+    struct netconn *listen_conn;
+    struct netconn *conn;
+
+    (void)pvParameters;
+
+    /* Wait for the network interface, as the FOTA task does */
+    (void)boot_wait(BOOT_EVENT_NETIF_UP, BOOT_WAIT_FOREVER);
+
+    while ((listen_conn = netconn_new(NETCONN_TCP)) == NULL)
+    {
+        printf("NOR log: Failed to create connection\n");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    if ((netconn_bind(listen_conn, IP_ADDR_ANY, NOR_LOG_PORT) != ERR_OK) ||
+        (netconn_listen_with_backlog(listen_conn, 1U) != ERR_OK))
+    {
+        printf("NOR log: Failed to listen on port %u\n", NOR_LOG_PORT);
+        netconn_delete(listen_conn);
+        vTaskDelete(NULL);
+    }
+
+    printf("NOR log back-fill listening on port %u\n", NOR_LOG_PORT);
+
+    for (;;)
+    {
+        if (netconn_accept(listen_conn, &conn) != ERR_OK)
+        {
+            continue;
+        }
+
+        netconn_set_recvtimeout(conn, NOR_LOG_FILL_RECV_TIMEOUT_MS);
+        nor_log_fill(conn);
+        netconn_close(conn);
+        netconn_delete(conn);
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void nor_log_event(nor_log_source_t source, uint8_t kind, uint16_t index,
+                   int32_t value)
+{
+    nor_log_event_t event;
+    bool            stored = false;
+
+    if (!atomic_load(&s_mounted))
+    {
+        return;
+    }
+
+    event.time_ns = BSP_Time_NowNs();
+    event.value   = value;
+    event.index   = index;
+    event.source  = (uint8_t)source;
+    event.kind    = kind;
+
+    taskENTER_CRITICAL();
+    if ((s_event_head - s_event_tail) < NOR_LOG_EVENT_RING)
+    {
+        s_events[s_event_head & (NOR_LOG_EVENT_RING - 1U)] = event;
+        s_event_head++;
+        stored = true;
+    }
+    else
+    {
+        s_event_lost++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (!stored)
+    {
+        metrics_add(METRIC_NOR_LOG_LOST, 1U);
+    }
+}
+
+void nor_log_job(void)
+{
+    nor_log_capture_t *capture = &s_capture;
+    uint32_t           count;
+
+    if (!atomic_load(&s_mounted))
+    {
+        return;
+    }
+
+    if (!capture->active)
+    {
+        (void)BSP_ADC1_RingReaderInit(&capture->reader,
+                                      BSP_ADC1_STREAM_DECIMATED);
+        capture->active = true;
+    }
+
+    do
+    {
+        if (BSP_ADC1_RingRead(&capture->reader, s_chunk, NOR_LOG_READ_CHUNK,
+                              &count) != BSP_OK)
+        {
+            break;
+        }
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            nor_log_sample(capture, &s_chunk[i]);
+        }
+    } while (count == NOR_LOG_READ_CHUNK);
+}
+
+bool nor_log_flash_size(uint32_t *size)
+{
+    if (!atomic_load(&s_probed))
+    {
+        return false;
+    }
+    *size = s_flash_size;
+    return true;
+}
+
+bool nor_log_lock(TickType_t wait)
+{
+    return xSemaphoreTake(s_lock, wait) == pdTRUE;
+}
+
+void nor_log_unlock(void)
+{
+    (void)xSemaphoreGive(s_lock);
+}
+
+void nor_log_start(void)
+{
+    s_queue = xQueueCreateStatic(NOR_LOG_QUEUE_PAGES, BSP_SPINOR_PAGE_SIZE,
+                                 s_queue_storage, &s_queue_buffer);
+    s_lock  = xSemaphoreCreateMutexStatic(&s_lock_buffer);
+
+    (void)xTaskCreateStatic(nor_log_write_task, "NorWrite",
+                            NOR_LOG_WRITE_STACK_SIZE, NULL,
+                            TASK_PRIO_NOR_WRITE, s_write_task_stack,
+                            &s_write_task_tcb);
+    (void)xTaskCreateStatic(nor_log_fill_task, "NorFill",
+                            NOR_LOG_FILL_STACK_SIZE, NULL,
+                            TASK_PRIO_BACKGROUND, s_fill_task_stack,
+                            &s_fill_task_tcb);
+}
+
+#endif /* BSP_SPINOR_ENABLE */
@@ -0,0 +1,863 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * OPC UA Server
+ *
+ * The register and statistics variables are data sources, read and
+ * written when a client asks; only the channel variables hold a value,
+ * written by the task itself. See opcua_server.h.
+ */
+
+#include "opcua_server.h"
+
+#if OPCUA_SERVER
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "adc_filter_coefficients.h"
+#include "adc_stats.h"
+#include "bsp.h"
+#include "bsp_sections.h"
+#include "jerry_device_registers.h"
+#include "jerry_printf.h"
+#include "log.h"
+#include "modbus.h"
+#include "modbus_callbacks.h"
+#include "opcua_port.h"
+#include "open62541/server.h"
+#include "open62541/server_config_default.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack of the server task, in words */
+#define OPCUA_SERVER_STACK_SIZE 2048U
+
+/** Namespace of the device nodes */
+#define OPCUA_SERVER_NAMESPACE_URI "urn:aincs:jerry"
+
+/** Decimated samples copied out of the ring per read */
+#define OPCUA_SERVER_READ_CHUNK 16U
+
+/** Longest description of a register variable, with its unit */
+#define OPCUA_SERVER_TEXT_SIZE 128U
+
+/** Statistics units of 0.1 mV, in volts */
+#define OPCUA_SERVER_STATS_VOLTS 0.0001f
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Channel means in progress
+ */
+typedef struct
+{
+    bsp_adc1_reader_t reader; /**< Decimated ring cursor */
+    bool      open;           /**< Means are being summed */
+    float32_t sum[BSP_ADC1_NUM_CHANNELS]; /**< Sums of the means */
+    uint32_t  count;          /**< Decimated samples summed */
+    uint32_t  end_sequence;   /**< Sequence the next means start at */
+    uint64_t  first_ns;       /**< Time of their start, 0 if unknown */
+    uint32_t  next_sequence;  /**< Sequence that continues the means */
+} opcua_means_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+static SemaphoreHandle_t s_register_mutex;
+static UA_Server        *s_server;
+static UA_UInt16         s_ns;
+static opcua_means_t     s_means;
+
+static TaskHandle_t s_opcua_task;
+static StaticTask_t s_opcua_task_tcb;
+static StackType_t  s_opcua_task_stack[OPCUA_SERVER_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** Decimated samples of one ring read */
+static bsp_adc1_sample_t s_chunk[OPCUA_SERVER_READ_CHUNK];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Value type of a register variable
+ */
+static const UA_DataType *
+opcua_node_type(const jerry_device_opcua_node_t *node)
+{
+    if ((node->type != JERRY_DEVICE_OPCUA_BOOL) && (node->scale != 1.0f))
+    {
+        return &UA_TYPES[UA_TYPES_FLOAT];
+    }
+
+    switch (node->type)
+    {
+        case JERRY_DEVICE_OPCUA_BOOL:
+            return &UA_TYPES[UA_TYPES_BOOLEAN];
+        case JERRY_DEVICE_OPCUA_INT16:
+            return &UA_TYPES[UA_TYPES_INT16];
+        case JERRY_DEVICE_OPCUA_UINT32:
+            return &UA_TYPES[UA_TYPES_UINT32];
+        case JERRY_DEVICE_OPCUA_INT32:
+            return &UA_TYPES[UA_TYPES_INT32];
+        case JERRY_DEVICE_OPCUA_FLOAT32:
+            return &UA_TYPES[UA_TYPES_FLOAT];
+        case JERRY_DEVICE_OPCUA_UINT64:
+            return &UA_TYPES[UA_TYPES_UINT64];
+        case JERRY_DEVICE_OPCUA_UINT16:
+        default:
+            return &UA_TYPES[UA_TYPES_UINT16];
+    }
+}
+
+/**
+ * @brief Status of the exception of a register callback
+ */
+static UA_StatusCode opcua_status(modbus_exception_t exception)
+{
+    switch (exception)
+    {
+        case MODBUS_EXCEPTION_NONE:
+            return UA_STATUSCODE_GOOD;
+        case MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE:
+            return UA_STATUSCODE_BADOUTOFRANGE;
+        case MODBUS_EXCEPTION_SLAVE_DEVICE_BUSY:
+            return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+        default:
+            return UA_STATUSCODE_BADINTERNALERROR;
+    }
+}
+
+/**
+ * @brief Read the raw value of a register variable
+ *
+ * The words are joined in the register's word order, a bit is 0 or 1.
+ */
+static UA_StatusCode opcua_read_raw(const jerry_device_opcua_node_t *node,
+                                    uint64_t                        *raw)
+{
+    uint16_t           words[4] = {0};
+    uint8_t            bits     = 0U;
+    modbus_exception_t exception;
+
+    if (xSemaphoreTake(s_register_mutex,
+                       pdMS_TO_TICKS(OPCUA_SERVER_LOCK_WAIT_MS)) != pdTRUE)
+    {
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+
+    switch (node->table)
+    {
+        case MODBUS_FC_READ_COILS:
+            exception = modbus_cb_read_coils(node->address, 1U, &bits);
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            exception =
+                modbus_cb_read_discrete_inputs(node->address, 1U, &bits);
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            exception = modbus_cb_read_holding_registers(node->address,
+                                                         node->count, words);
+            break;
+        default:
+            exception = modbus_cb_read_input_registers(node->address,
+                                                       node->count, words);
+            break;
+    }
+
+    (void)xSemaphoreGive(s_register_mutex);
+
+    if (node->type == JERRY_DEVICE_OPCUA_BOOL)
+    {
+        *raw = (uint64_t)(bits & 0x01U);
+    }
+    else
+    {
+        *raw = 0U;
+        for (uint32_t i = 0U; i < node->count; i++)
+        {
+            uint32_t word = node->low_first ? (node->count - 1U - i) : i;
+
+            *raw = (*raw << 16) | words[word];
+        }
+    }
+
+    return opcua_status(exception);
+}
+
+/**
+ * @brief Write the raw value of a register variable
+ */
+static UA_StatusCode opcua_write_raw(const jerry_device_opcua_node_t *node,
+                                     uint64_t                        raw)
+{
+    uint16_t           words[4];
+    modbus_exception_t exception;
+
+    for (uint32_t i = 0U; i < node->count; i++)
+    {
+        uint32_t word = node->low_first ? i : (node->count - 1U - i);
+
+        words[word] = (uint16_t)(raw >> (16U * i));
+    }
+
+    if (xSemaphoreTake(s_register_mutex,
+                       pdMS_TO_TICKS(OPCUA_SERVER_LOCK_WAIT_MS)) != pdTRUE)
+    {
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+
+    if (node->table == MODBUS_FC_READ_COILS)
+    {
+        exception = modbus_cb_write_single_coil(node->address, raw != 0U);
+    }
+    else
+    {
+        exception = modbus_cb_write_multiple_registers(node->address,
+                                                       node->count, words);
+    }
+
+    (void)xSemaphoreGive(s_register_mutex);
+
+    return opcua_status(exception);
+}
+
+/**
+ * @brief Raw value of a register as a number, signed types sign-extended
+ */
+static float opcua_raw_number(const jerry_device_opcua_node_t *node,
+                              uint64_t                         raw)
+{
+    float value;
+
+    switch (node->type)
+    {
+        case JERRY_DEVICE_OPCUA_INT16:
+            value = (float)(int16_t)raw;
+            break;
+        case JERRY_DEVICE_OPCUA_INT32:
+            value = (float)(int32_t)raw;
+            break;
+        case JERRY_DEVICE_OPCUA_FLOAT32:
+        {
+            uint32_t bits = (uint32_t)raw;
+
+            (void)memcpy(&value, &bits, sizeof(value));
+            break;
+        }
+        default:
+            value = (float)raw;
+            break;
+    }
+
+    return value;
+}
+
+/**
+ * @brief Raw register value of an engineering value
+ *
+ * @return false if the value does not fit the register
+ */
+static bool opcua_number_raw(const jerry_device_opcua_node_t *node,
+                             float value, uint64_t *raw)
+{
+    float  low  = 0.0f;
+    float  high = 65535.0f;
+    double rounded;
+
+    if (node->type == JERRY_DEVICE_OPCUA_FLOAT32)
+    {
+        uint32_t bits;
+
+        (void)memcpy(&bits, &value, sizeof(bits));
+        *raw = bits;
+        return isfinite(value) != 0;
+    }
+
+    switch (node->type)
+    {
+        case JERRY_DEVICE_OPCUA_INT16:
+            low  = -32768.0f;
+            high = 32767.0f;
+            break;
+        case JERRY_DEVICE_OPCUA_UINT32:
+            high = 4294967295.0f;
+            break;
+        case JERRY_DEVICE_OPCUA_INT32:
+            low  = -2147483648.0f;
+            high = 2147483647.0f;
+            break;
+        case JERRY_DEVICE_OPCUA_UINT64:
+            high = 18446744073709551615.0f;
+            break;
+        default:
+            break;
+    }
+
+    rounded = round((double)value);
+    if (!(rounded >= (double)low) || !(rounded <= (double)high))
+    {
+        return false;
+    }
+
+    *raw = (rounded < 0.0) ? (uint64_t)(int64_t)rounded : (uint64_t)rounded;
+
+    return true;
+}
+
+/**
+ * @brief Read a register variable (data source)
+ */
+static UA_StatusCode opcua_register_read(UA_Server *server,
+                                         const UA_NodeId *session_id,
+                                         void *session_context,
+                                         const UA_NodeId *node_id,
+                                         void *node_context,
+                                         UA_Boolean include_source_time,
+                                         const UA_NumericRange *range,
+                                         UA_DataValue *value)
+{
+    const jerry_device_opcua_node_t *node = node_context;
+    const UA_DataType               *type = opcua_node_type(node);
+    uint64_t                         raw;
+    UA_StatusCode                    status;
+
+    (void)server;
+    (void)session_id;
+    (void)session_context;
+    (void)node_id;
+
+    if (range != NULL)
+    {
+        return UA_STATUSCODE_BADINDEXRANGEINVALID;
+    }
+
+    status = opcua_read_raw(node, &raw);
+    if (status != UA_STATUSCODE_GOOD)
+    {
+        return status;
+    }
+
+    if (type == &UA_TYPES[UA_TYPES_BOOLEAN])
+    {
+        UA_Boolean v = (raw != 0U);
+        status = UA_Variant_setScalarCopy(&value->value, &v, type);
+    }
+    else if (type == &UA_TYPES[UA_TYPES_FLOAT])
+    {
+        UA_Float v = opcua_raw_number(node, raw) * node->scale;
+        status = UA_Variant_setScalarCopy(&value->value, &v, type);
+    }
+    else
+    {
+        /* Integers keep their bits; the type gives the width and sign */
+        uint16_t    u16  = (uint16_t)raw;
+        uint32_t    u32  = (uint32_t)raw;
+        const void *data = &u16;
+
+        if (type->memSize == sizeof(uint32_t))
+        {
+            data = &u32;
+        }
+        else if (type->memSize == sizeof(uint64_t))
+        {
+            data = &raw;
+        }
+        status = UA_Variant_setScalarCopy(&value->value, data, type);
+    }
+    if (status != UA_STATUSCODE_GOOD)
+    {
+        return status;
+    }
+
+    value->hasValue = true;
+    if (include_source_time)
+    {
+        value->sourceTimestamp    = UA_DateTime_now();
+        value->hasSourceTimestamp = true;
+    }
+
+    return UA_STATUSCODE_GOOD;
+}
+
+/**
+ * @brief Write a register variable (data source)
+ *
+ * The value must have the variable's type.
+ */
+static UA_StatusCode opcua_register_write(UA_Server *server,
+                                          const UA_NodeId *session_id,
+                                          void *session_context,
+                                          const UA_NodeId *node_id,
+                                          void *node_context,
+                                          const UA_NumericRange *range,
+                                          const UA_DataValue *value)
+{
+    const jerry_device_opcua_node_t *node = node_context;
+    const UA_DataType               *type = opcua_node_type(node);
+    uint64_t                         raw  = 0U;
+
+    (void)server;
+    (void)session_id;
+    (void)session_context;
+    (void)node_id;
+
+    if (range != NULL)
+    {
+        return UA_STATUSCODE_BADINDEXRANGEINVALID;
+    }
+    if (!value->hasValue || !UA_Variant_hasScalarType(&value->value, type))
+    {
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    }
+
+    if (type == &UA_TYPES[UA_TYPES_BOOLEAN])
+    {
+        raw = *(const UA_Boolean *)value->value.data ? 1U : 0U;
+    }
+    else if (type == &UA_TYPES[UA_TYPES_FLOAT])
+    {
+        float v = *(const UA_Float *)value->value.data / node->scale;
+
+        if (!opcua_number_raw(node, v, &raw))
+        {
+            return UA_STATUSCODE_BADOUTOFRANGE;
+        }
+    }
+    else
+    {
+        (void)memcpy(&raw, value->value.data, type->memSize);
+    }
+
+    return opcua_write_raw(node, raw);
+}
+
+/**
+ * @brief Read a statistics variable (data source)
+ *
+ * The node context is the channel times ADC_STATS_WINDOW_COUNT plus the
+ * window.
+ */
+static UA_StatusCode opcua_stats_read(UA_Server *server,
+                                      const UA_NodeId *session_id,
+                                      void *session_context,
+                                      const UA_NodeId *node_id,
+                                      void *node_context,
+                                      UA_Boolean include_source_time,
+                                      const UA_NumericRange *range,
+                                      UA_DataValue *value)
+{
+    adc_stats_result_t results[ADC_STATS_CHANNELS][ADC_STATS_WINDOW_COUNT];
+    uint32_t           index = (uint32_t)(uintptr_t)node_context;
+    const adc_stats_result_t *result;
+    UA_Float                  figures[4];
+    UA_StatusCode             status;
+
+    (void)server;
+    (void)session_id;
+    (void)session_context;
+    (void)node_id;
+
+    if (range != NULL)
+    {
+        return UA_STATUSCODE_BADINDEXRANGEINVALID;
+    }
+    if (adc_stats_get_results(results) == 0U)
+    {
+        return UA_STATUSCODE_BADWAITINGFORINITIALDATA;
+    }
+
+    result     = &results[index / ADC_STATS_WINDOW_COUNT]
+                         [index % ADC_STATS_WINDOW_COUNT];
+    figures[0] = (UA_Float)result->min * OPCUA_SERVER_STATS_VOLTS;
+    figures[1] = (UA_Float)result->max * OPCUA_SERVER_STATS_VOLTS;
+    figures[2] = (UA_Float)result->mean * OPCUA_SERVER_STATS_VOLTS;
+    figures[3] = (UA_Float)result->rms * OPCUA_SERVER_STATS_VOLTS;
+
+    status = UA_Variant_setArrayCopy(&value->value, figures, 4U,
+                                     &UA_TYPES[UA_TYPES_FLOAT]);
+    if (status != UA_STATUSCODE_GOOD)
+    {
+        return status;
+    }
+
+    value->hasValue = true;
+    if (include_source_time)
+    {
+        value->sourceTimestamp    = UA_DateTime_now();
+        value->hasSourceTimestamp = true;
+    }
+
+    return UA_STATUSCODE_GOOD;
+}
+
+/**
+ * @brief Add a folder under @p parent
+ */
+static UA_StatusCode opcua_add_folder(UA_UInt32 id, UA_UInt32 parent,
+                                      UA_UInt16 parent_ns, const char *name,
+                                      const char *description)
+{
+    UA_ObjectAttributes attr = UA_ObjectAttributes_default;
+
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", (char *)name);
+    attr.description = UA_LOCALIZEDTEXT("en-US", (char *)description);
+
+    return UA_Server_addObjectNode(
+        s_server, UA_NODEID_NUMERIC(s_ns, id),
+        UA_NODEID_NUMERIC(parent_ns, parent),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+        UA_QUALIFIEDNAME(s_ns, (char *)name),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE), attr, NULL, NULL);
+}
+
+/**
+ * @brief Add the folders and variables of the register groups
+ */
+static UA_StatusCode opcua_add_registers(void)
+{
+    UA_StatusCode status = UA_STATUSCODE_GOOD;
+    UA_DataSource source = {
+        .read  = opcua_register_read,
+        .write = opcua_register_write,
+    };
+
+    for (uint32_t i = 0U;
+         (i < JERRY_DEVICE_OPCUA_FOLDER_COUNT) && (status == UA_STATUSCODE_GOOD);
+         i++)
+    {
+        status = opcua_add_folder(1U + i, UA_NS0ID_OBJECTSFOLDER, 0U,
+                                  jerry_device_opcua_folders[i].name,
+                                  jerry_device_opcua_folders[i].description);
+    }
+
+    for (uint32_t i = 0U;
+         (i < JERRY_DEVICE_OPCUA_NODE_COUNT) && (status == UA_STATUSCODE_GOOD);
+         i++)
+    {
+        const jerry_device_opcua_node_t *node = &jerry_device_opcua_nodes[i];
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        char                  text[OPCUA_SERVER_TEXT_SIZE];
+
+        if (node->unit[0] != '\0')
+        {
+            (void)jerry_snprintf(text, sizeof(text), "%s (%s)",
+                                 node->description, node->unit);
+        }
+        else
+        {
+            (void)jerry_snprintf(text, sizeof(text), "%s",
+                                 node->description);
+        }
+
+        attr.displayName = UA_LOCALIZEDTEXT("en-US", (char *)node->name);
+        attr.description = UA_LOCALIZEDTEXT("en-US", text);
+        attr.dataType    = opcua_node_type(node)->typeId;
+        attr.valueRank   = UA_VALUERANK_SCALAR;
+        attr.minimumSamplingInterval = OPCUA_SERVER_REGISTER_SAMPLING_MS;
+        attr.accessLevel             = UA_ACCESSLEVELMASK_READ;
+        if (node->writable)
+        {
+            attr.accessLevel |= UA_ACCESSLEVELMASK_WRITE;
+        }
+
+        status = UA_Server_addDataSourceVariableNode(
+            s_server,
+            UA_NODEID_NUMERIC(s_ns,
+                              ((UA_UInt32)node->table << 16) | node->address),
+            UA_NODEID_NUMERIC(s_ns, 1U + node->folder),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+            UA_QUALIFIEDNAME(s_ns, (char *)node->name),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), attr, source,
+            (void *)node, NULL);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Add the Channels and Statistics folders and their variables
+ */
+static UA_StatusCode opcua_add_channels(void)
+{
+    UA_StatusCode status;
+    UA_DataSource source = {.read = opcua_stats_read, .write = NULL};
+    static const char *const window_names[ADC_STATS_WINDOW_COUNT] = {
+        "1s", "10s", "1min",
+    };
+
+    status = opcua_add_folder(OPCUA_SERVER_NODE_CHANNELS,
+                              UA_NS0ID_OBJECTSFOLDER, 0U, "Channels",
+                              "Means of the filtered ADC inputs, V");
+    if (status == UA_STATUSCODE_GOOD)
+    {
+        status = opcua_add_folder(OPCUA_SERVER_NODE_STATISTICS,
+                                  UA_NS0ID_OBJECTSFOLDER, 0U, "Statistics",
+                                  "Min, max, mean and RMS of the filtered "
+                                  "ADC inputs, V");
+    }
+
+    for (uint32_t ch = 0U;
+         (ch < BSP_ADC1_NUM_CHANNELS) && (status == UA_STATUSCODE_GOOD); ch++)
+    {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        UA_Float              zero = 0.0f;
+        char                  name[8];
+
+        (void)jerry_snprintf(name, sizeof(name), "A%u", (unsigned int)ch);
+        attr.displayName = UA_LOCALIZEDTEXT("en-US", name);
+        attr.dataType    = UA_TYPES[UA_TYPES_FLOAT].typeId;
+        attr.valueRank   = UA_VALUERANK_SCALAR;
+        attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+        /* 0, so that a monitored item may sample every write */
+        attr.minimumSamplingInterval = 0.0;
+        UA_Variant_setScalar(&attr.value, &zero, &UA_TYPES[UA_TYPES_FLOAT]);
+
+        status = UA_Server_addVariableNode(
+            s_server, UA_NODEID_NUMERIC(s_ns, OPCUA_SERVER_NODE_CHANNELS + 1U +
+                                                  ch),
+            UA_NODEID_NUMERIC(s_ns, OPCUA_SERVER_NODE_CHANNELS),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+            UA_QUALIFIEDNAME(s_ns, name),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), attr, NULL,
+            NULL);
+    }
+
+    for (uint32_t i = 0U; (i < (ADC_STATS_CHANNELS * ADC_STATS_WINDOW_COUNT)) &&
+                          (status == UA_STATUSCODE_GOOD);
+         i++)
+    {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        UA_UInt32             dims = 4U;
+        char                  name[12];
+
+        (void)jerry_snprintf(name, sizeof(name), "A%u_%s",
+                             (unsigned int)(i / ADC_STATS_WINDOW_COUNT),
+                             window_names[i % ADC_STATS_WINDOW_COUNT]);
+        attr.displayName = UA_LOCALIZEDTEXT("en-US", name);
+        attr.description =
+            UA_LOCALIZEDTEXT("en-US", "{min, max, mean, rms}, V");
+        attr.dataType            = UA_TYPES[UA_TYPES_FLOAT].typeId;
+        attr.valueRank           = UA_VALUERANK_ONE_DIMENSION;
+        attr.arrayDimensionsSize = 1U;
+        attr.arrayDimensions     = &dims;
+        attr.accessLevel         = UA_ACCESSLEVELMASK_READ;
+        attr.minimumSamplingInterval = OPCUA_SERVER_REGISTER_SAMPLING_MS;
+
+        status = UA_Server_addDataSourceVariableNode(
+            s_server,
+            UA_NODEID_NUMERIC(s_ns, OPCUA_SERVER_NODE_STATISTICS + 1U + i),
+            UA_NODEID_NUMERIC(s_ns, OPCUA_SERVER_NODE_STATISTICS),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+            UA_QUALIFIEDNAME(s_ns, name),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), attr, source,
+            (void *)(uintptr_t)i, NULL);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Write the completed channel means, with the time of their start
+ *
+ * Each write samples the monitored items of interval 0 on the variable.
+ */
+static void opcua_write_means(const opcua_means_t *means)
+{
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        UA_DataValue value;
+        UA_Float     mean =
+            means->sum[ch] / (float32_t)means->count;
+
+        UA_DataValue_init(&value);
+        UA_Variant_setScalar(&value.value, &mean, &UA_TYPES[UA_TYPES_FLOAT]);
+        value.hasValue = true;
+        if (means->first_ns != 0U)
+        {
+            value.sourceTimestamp =
+                UA_DATETIME_UNIX_EPOCH +
+                (UA_DateTime)(means->first_ns / 100U);
+            value.hasSourceTimestamp = true;
+        }
+
+        (void)UA_Server_writeDataValue(
+            s_server, UA_NODEID_NUMERIC(s_ns, OPCUA_SERVER_NODE_CHANNELS + 1U +
+                                                  ch),
+            value);
+    }
+}
+
+/**
+ * @brief Start the channel means at a sample sequence
+ *
+ * They span 1 / OPCUA_SERVER_SAMPLE_RATE_HZ at the sample rate in force.
+ */
+static void opcua_open_means(opcua_means_t *means, uint32_t sequence)
+{
+    means->open         = true;
+    means->count        = 0U;
+    means->end_sequence =
+        sequence + (BSP_ADC1_GetSampleRate() / OPCUA_SERVER_SAMPLE_RATE_HZ);
+    if (BSP_ADC1_GetSampleTimeNs(sequence, &means->first_ns) != BSP_OK)
+    {
+        means->first_ns = 0U;
+    }
+    (void)memset(means->sum, 0, sizeof(means->sum));
+}
+
+/**
+ * @brief Add one decimated sample to the channel means
+ */
+static void opcua_sample(opcua_means_t *means, const bsp_adc1_sample_t *sample)
+{
+    if (means->open && (sample->sequence != means->next_sequence))
+    {
+        means->open = false;
+    }
+
+    if (!means->open)
+    {
+        opcua_open_means(means, sample->sequence);
+    }
+
+    for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        means->sum[ch] += sample->filtered[ch];
+    }
+    means->count++;
+    means->next_sequence = sample->sequence + ADC_FILTER_DECIMATION_FACTOR;
+
+    if ((int32_t)(means->next_sequence - means->end_sequence) >= 0)
+    {
+        opcua_write_means(means);
+        opcua_open_means(means, means->end_sequence);
+    }
+}
+
+/**
+ * @brief Take the new decimated samples of the ring
+ */
+static void opcua_sample_job(void)
+{
+    uint32_t count;
+
+    do
+    {
+        if (BSP_ADC1_RingRead(&s_means.reader, s_chunk,
+                              OPCUA_SERVER_READ_CHUNK, &count) != BSP_OK)
+        {
+            break;
+        }
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            opcua_sample(&s_means, &s_chunk[i]);
+        }
+    } while (count == OPCUA_SERVER_READ_CHUNK);
+}
+
+/**
+ * @brief Create the server and its address space
+ */
+static UA_StatusCode opcua_setup(void)
+{
+    UA_ServerConfig *config;
+    UA_StatusCode    status;
+
+    opcua_port_init();
+
+    s_server = UA_Server_new();
+    if (s_server == NULL)
+    {
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    config = UA_Server_getConfig(s_server);
+    status = UA_ServerConfig_setMinimalCustomBuffer(
+        config, OPCUA_SERVER_PORT, NULL, OPCUA_SERVER_BUFFER_SIZE,
+        OPCUA_SERVER_BUFFER_SIZE);
+    if (status != UA_STATUSCODE_GOOD)
+    {
+        return status;
+    }
+
+    config->maxSecureChannels = OPCUA_SERVER_MAX_SESSIONS;
+    config->maxSessions       = OPCUA_SERVER_MAX_SESSIONS;
+    config->maxSubscriptions =
+        OPCUA_SERVER_MAX_SESSIONS * OPCUA_SERVER_MAX_SUBSCRIPTIONS;
+    config->maxSubscriptionsPerSession = OPCUA_SERVER_MAX_SUBSCRIPTIONS;
+    config->maxMonitoredItemsPerSubscription =
+        OPCUA_SERVER_MAX_MONITORED_ITEMS;
+    config->publishingIntervalLimits.min = OPCUA_SERVER_MIN_PUBLISHING_MS;
+    config->samplingIntervalLimits.min   = 0.0;
+    config->queueSizeLimits.min          = 1U;
+    config->queueSizeLimits.max          = OPCUA_SERVER_MAX_QUEUE_SIZE;
+
+    s_ns   = UA_Server_addNamespace(s_server, OPCUA_SERVER_NAMESPACE_URI);
+    status = opcua_add_registers();
+    if (status == UA_STATUSCODE_GOOD)
+    {
+        status = opcua_add_channels();
+    }
+    if (status == UA_STATUSCODE_GOOD)
+    {
+        status = UA_Server_run_startup(s_server);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Server task: network and timers, then the new samples
+ */
+static void opcua_task(void *argument)
+{
+    UA_StatusCode status;
+
+    (void)argument;
+
+    status = opcua_setup();
+    if (status != UA_STATUSCODE_GOOD)
+    {
+        LOG("OPC UA: Server not started: 0x%08lx\n", (unsigned long)status);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    LOG("OPC UA: Listening on port %u\n", (unsigned int)OPCUA_SERVER_PORT);
+    (void)BSP_ADC1_RingReaderInit(&s_means.reader, BSP_ADC1_STREAM_DECIMATED);
+
+    for (;;)
+    {
+        (void)UA_Server_run_iterate(s_server, false);
+        opcua_sample_job();
+        vTaskDelay(pdMS_TO_TICKS(OPCUA_SERVER_POLL_MS));
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void opcua_server_start(SemaphoreHandle_t register_mutex)
+{
+    s_register_mutex = register_mutex;
+
+    s_opcua_task = xTaskCreateStatic(opcua_task, "OpcUa",
+                                     OPCUA_SERVER_STACK_SIZE, NULL,
+                                     TASK_PRIO_OPCUA, s_opcua_task_stack,
+                                     &s_opcua_task_tcb);
+}
+
+#endif /* OPCUA_SERVER */
@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Power-Fail Snapshot
+ *
+ * The detector hook runs above every other interrupt and the Modbus task
+ * arms it only once the sector, offset and sequence it uses are set, so
+ * they need no lock. The hook reads the counts and the registers as they
+ * are, without the critical sections the tasks use: nothing it interrupted
+ * runs again before it returns. The record format is described in
+ * power_fail.h.
+ */
+
+#include "power_fail.h"
+
+#if POWER_FAIL
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bsp.h"
+#include "config_store.h"
+#include "power_meter.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Longest wait for the flash at boot */
+#define POWER_FAIL_FLASH_TIMEOUT_MS 1000U
+
+/** Seed of the check, so that neither an erased nor a zero record passes */
+#define POWER_FAIL_CHECK_SEED 0x9E3779B9U
+
+/** Quad-words a sector must have free to arm the hook: a snapshot and the
+ * CLEARED record that may follow it */
+#define POWER_FAIL_ARM_WORDS (POWER_FAIL_MAX_WORDS + 1U)
+
+_Static_assert(POWER_FAIL_DI_COUNT == (4U * POWER_FAIL_DI_WORDS),
+               "the counts fill the quad-words after the header");
+_Static_assert((sizeof(power_meter_energy_t) * POWER_METER_PAIRS) <=
+                   (POWER_FAIL_ENERGY_WORDS * BSP_FLASH_WORD_SIZE),
+               "the energy totals fit the quad-words after the counts");
+_Static_assert(POWER_FAIL_DI_COUNT <= BSP_GPIODI_COUNT,
+               "every count is of a digital input");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief What a sector holds
+ */
+typedef struct
+{
+    uint32_t next;     /**< Offset of the first free quad-word */
+    uint32_t newest;   /**< Offset of the newest valid record,
+                            BSP_FLASH_SECTOR_SIZE if none */
+    uint32_t sequence; /**< Sequence number of that record */
+    uint32_t quads;    /**< Quad-words of that record */
+} power_fail_scan_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Record built by the hook, or read at boot */
+static uint32_t s_record[POWER_FAIL_MAX_WORDS][4];
+
+/** Counts of the digital inputs before the last power loss */
+static uint32_t s_di_base[POWER_FAIL_DI_COUNT];
+
+/** Snapshot sector written to */
+static uint32_t s_sector;
+
+/** Offset of its first free quad-word */
+static uint32_t s_next;
+
+/** Sequence number of the last record */
+static uint32_t s_sequence;
+
+/** The hook may write a snapshot */
+static volatile bool s_armed;
+
+/** A snapshot was written since the boot and not cleared */
+static bool s_taken;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Check of a record, over every word but the check itself
+ *
+ * @param[in] words First word of the record
+ * @param[in] quads Quad-words of the record
+ */
+static uint32_t power_fail_check(const uint32_t *words, uint32_t quads)
+{
+    uint32_t check = POWER_FAIL_CHECK_SEED;
+
+    for (uint32_t i = 0U; i < (quads * 4U); i++)
+    {
+        if (i != 3U)
+        {
+            check = (check ^ words[i]) * 0x01000193U;
+        }
+    }
+
+    return check;
+}
+
+/**
+ * @brief Fill the header of s_record, its payload being in place
+ *
+ * @param[in] kind  POWER_FAIL_KIND_*
+ * @param[in] quads Quad-words of the record
+ */
+static void power_fail_seal(uint32_t kind, uint32_t quads)
+{
+    s_sequence++;
+    s_record[0][0] = POWER_FAIL_MAGIC;
+    s_record[0][1] = s_sequence;
+    s_record[0][2] = kind | (POWER_FAIL_VERSION << 8) | (quads << 16);
+    s_record[0][3] = power_fail_check(&s_record[0][0], quads);
+}
+
+/**
+ * @brief Walk the records of a sector
+ *
+ * Boot only, before the hook is armed: each record is read into s_record.
+ * A header that is neither erased nor valid, or a quad-word the supply
+ * collapsed on while it was programmed, which fails its ECC check, ends
+ * the walk: nothing after it was written or can be located, so the sector
+ * counts as full.
+ */
+static void power_fail_scan(uint32_t sector, power_fail_scan_t *scan)
+{
+    const uint8_t  *base   = BSP_Flash_SnapshotSector(sector);
+    const uint32_t *header = &s_record[0][0];
+    uint32_t        at     = 0U;
+
+    scan->newest   = BSP_FLASH_SECTOR_SIZE;
+    scan->sequence = 0U;
+    scan->quads    = 0U;
+
+    while (at < BSP_FLASH_SECTOR_SIZE)
+    {
+        uint32_t quads;
+
+        if (BSP_Flash_Read(base + at, s_record, BSP_FLASH_WORD_SIZE) != BSP_OK)
+        {
+            at = BSP_FLASH_SECTOR_SIZE;
+            break;
+        }
+        quads = header[2] >> 16;
+
+        if ((header[0] & header[1] & header[2] & header[3]) == 0xFFFFFFFFU)
+        {
+            break;
+        }
+        if ((header[0] != POWER_FAIL_MAGIC) || (quads == 0U) ||
+            (quads > ((BSP_FLASH_SECTOR_SIZE - at) / BSP_FLASH_WORD_SIZE)))
+        {
+            at = BSP_FLASH_SECTOR_SIZE;
+            break;
+        }
+
+        /* A record of another layout, too long for s_record, is stepped
+         * over; one whose payload was cut short fails its check */
+        if (quads <= POWER_FAIL_MAX_WORDS)
+        {
+            if (BSP_Flash_Read(base + at, s_record,
+                               quads * BSP_FLASH_WORD_SIZE) != BSP_OK)
+            {
+                at = BSP_FLASH_SECTOR_SIZE;
+                break;
+            }
+            if ((((header[2] >> 8) & 0xFFU) == POWER_FAIL_VERSION) &&
+                (header[3] == power_fail_check(header, quads)))
+            {
+                scan->newest   = at;
+                scan->sequence = header[1];
+                scan->quads    = quads;
+            }
+        }
+        at += quads * BSP_FLASH_WORD_SIZE;
+    }
+
+    scan->next = at;
+}
+
+/**
+ * @brief Erase a snapshot sector, or program quad-words into it, and wait
+ *
+ * Boot only, before the hook is armed. A write of another task is waited
+ * for first.
+ *
+ * @return true if the flash took the erase or the write
+ */
+static bool power_fail_flash(uint32_t sector, uint32_t offset,
+                             const void *data, uint32_t length)
+{
+    bsp_error_t result;
+
+    do
+    {
+        result = BSP_Flash_Wait(POWER_FAIL_FLASH_TIMEOUT_MS);
+        if (result != BSP_TIMEOUT)
+        {
+            result = (data == NULL)
+                         ? BSP_Flash_SnapshotEraseAsync(sector)
+                         : BSP_Flash_SnapshotWriteAsync(sector, offset, data,
+                                                        length);
+        }
+    } while (result == BSP_BUSY);
+
+    if (result == BSP_OK)
+    {
+        result = BSP_Flash_Wait(POWER_FAIL_FLASH_TIMEOUT_MS);
+    }
+
+    return result == BSP_OK;
+}
+
+/**
+ * @brief Take the counts, the energy and the registers of a snapshot back
+ *
+ * @param[in] record First word of the snapshot
+ * @param[in] quads  Quad-words of the snapshot
+ */
+static void power_fail_restore(const uint32_t *record, uint32_t quads)
+{
+    power_meter_energy_t energy[POWER_METER_PAIRS];
+    uint32_t             applied;
+
+    for (uint32_t ch = 0U; ch < POWER_FAIL_DI_COUNT; ch++)
+    {
+        s_di_base[ch] = record[4U + ch];
+    }
+
+    (void)memcpy(energy, &record[(1U + POWER_FAIL_DI_WORDS) * 4U],
+                 sizeof(energy));
+    power_meter_restore_energy(energy);
+
+    applied = config_store_apply(
+        (const uint32_t (*)[4])&record[POWER_FAIL_FIXED_WORDS * 4U],
+        quads - POWER_FAIL_FIXED_WORDS);
+
+    printf("Power-fail: snapshot %lu restored, %lu of %lu pending registers\n",
+           (unsigned long)record[1], (unsigned long)applied,
+           (unsigned long)(quads - POWER_FAIL_FIXED_WORDS));
+}
+
+/**
+ * @brief Detector hook (PVD interrupt, above the kernel's mask)
+ *
+ * @param[in] low The supply fell below the threshold, else came back
+ */
+static void power_fail_pvd(bool low)
+{
+    power_meter_energy_t energy[POWER_METER_PAIRS];
+    uint32_t             quads;
+
+    if (low)
+    {
+        if (!s_armed)
+        {
+            return;
+        }
+        s_armed = false;
+
+        for (uint32_t ch = 0U; ch < POWER_FAIL_DI_COUNT; ch++)
+        {
+            s_record[1U + (ch / 4U)][ch % 4U] =
+                s_di_base[ch] + BSP_GPIODI_CaptureRising(ch);
+        }
+        power_meter_saved_energy(energy);
+        (void)memcpy(&s_record[1U + POWER_FAIL_DI_WORDS], energy,
+                     sizeof(energy));
+        quads = POWER_FAIL_FIXED_WORDS +
+                config_store_pending(&s_record[POWER_FAIL_FIXED_WORDS],
+                                     POWER_FAIL_CONFIG_RECORDS);
+        power_fail_seal(POWER_FAIL_KIND_SNAPSHOT, quads);
+
+        s_taken = (BSP_Flash_SnapshotProgram(s_sector, s_next, s_record,
+                                             quads * BSP_FLASH_WORD_SIZE) ==
+                   BSP_OK);
+        s_next += quads * BSP_FLASH_WORD_SIZE;
+    }
+    else if (s_taken)
+    {
+        /* The device runs on, so the snapshot is stale from here */
+        s_taken = false;
+        power_fail_seal(POWER_FAIL_KIND_CLEARED, 1U);
+        (void)BSP_Flash_SnapshotProgram(s_sector, s_next, s_record,
+                                        BSP_FLASH_WORD_SIZE);
+        s_next += BSP_FLASH_WORD_SIZE;
+
+        s_armed = (BSP_FLASH_SECTOR_SIZE - s_next) >=
+                  (POWER_FAIL_ARM_WORDS * BSP_FLASH_WORD_SIZE);
+    }
+    else
+    {
+        /* Came back without a snapshot written */
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void power_fail_start(void)
+{
+    power_fail_scan_t scan[BSP_FLASH_SNAPSHOT_SECTORS];
+    const uint32_t   *newest  = NULL;
+    bool              restore = false;
+    bsp_error_t       result;
+
+    for (uint32_t sector = 0U; sector < BSP_FLASH_SNAPSHOT_SECTORS; sector++)
+    {
+        power_fail_scan(sector, &scan[sector]);
+    }
+
+    /* The sector of the newest record, sector 0 if neither holds one */
+    s_sector = 0U;
+    if ((scan[1].newest < BSP_FLASH_SECTOR_SIZE) &&
+        ((scan[0].newest >= BSP_FLASH_SECTOR_SIZE) ||
+         ((int32_t)(scan[1].sequence - scan[0].sequence) > 0)))
+    {
+        s_sector = 1U;
+    }
+    if ((scan[s_sector].newest < BSP_FLASH_SECTOR_SIZE) &&
+        (BSP_Flash_Read(BSP_Flash_SnapshotSector(s_sector) +
+                            scan[s_sector].newest,
+                        s_record,
+                        scan[s_sector].quads * BSP_FLASH_WORD_SIZE) ==
+         BSP_OK))
+    {
+        newest     = &s_record[0][0];
+        s_sequence = newest[1];
+        restore    = ((newest[2] & 0xFFU) == POWER_FAIL_KIND_SNAPSHOT) &&
+                     ((newest[2] >> 16) >= POWER_FAIL_FIXED_WORDS);
+    }
+    if (restore)
+    {
+        power_fail_restore(newest, newest[2] >> 16);
+    }
+
+    /* A full sector is left for the other one, which holds older records */
+    s_next = scan[s_sector].next;
+    if ((BSP_FLASH_SECTOR_SIZE - s_next) <
+        (POWER_FAIL_ARM_WORDS * BSP_FLASH_WORD_SIZE))
+    {
+        s_sector ^= 1U;
+        s_next = 0U;
+        if ((scan[s_sector].next != 0U) &&
+            !power_fail_flash(s_sector, 0U, NULL, 0U))
+        {
+            printf("Power-fail: erase of sector %lu failed, not armed\n",
+                   (unsigned long)s_sector);
+            return;
+        }
+    }
+
+    if (restore)
+    {
+        power_fail_seal(POWER_FAIL_KIND_CLEARED, 1U);
+        if (!power_fail_flash(s_sector, s_next, s_record,
+                              BSP_FLASH_WORD_SIZE))
+        {
+            printf("Power-fail: snapshot not cleared, not armed\n");
+            return;
+        }
+        s_next += BSP_FLASH_WORD_SIZE;
+    }
+
+    s_armed = true;
+    result  = BSP_PVD_Start(POWER_FAIL_PVD_LEVEL, power_fail_pvd);
+    if (result == BSP_OK)
+    {
+        printf("Power-fail: armed, sector %lu, %lu bytes free\n",
+               (unsigned long)s_sector,
+               (unsigned long)(BSP_FLASH_SECTOR_SIZE - s_next));
+    }
+    else
+    {
+        s_armed = false;
+        printf("Power-fail: no voltage detector (%d), not armed\n",
+               (int)result);
+    }
+}
+
+uint32_t power_fail_di_base(uint8_t channel)
+{
+    return (channel < POWER_FAIL_DI_COUNT) ? s_di_base[channel] : 0U;
+}
+
+#endif /* POWER_FAIL */
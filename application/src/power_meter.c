@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Power Meter
+ *
+ * The window sums, the energy totals and the stream reader belong to the
+ * filter task. The configuration, the clear and restore requests and the
+ * published results are shared, each copied in one short critical section.
+ * The voltage detector hook cannot wait for a critical section, so the
+ * filter task also keeps two copies of the totals and flips the index of
+ * the complete one with a single store.
+ *
+ * A run of at most one ring read is summed in single precision, 32 samples
+ * at a time, and added to the double-precision window sums, so the sums
+ * keep their precision over a window of 10000 samples. See power_meter.h.
+ */
+
+#include "power_meter.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "arm_math.h"
+#include "metrics.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Samples read from the stream at a time, one ADC block's worth */
+#define POWER_METER_READ_BATCH BSP_ADC1_BLOCK_SAMPLES
+
+/** Seconds per hour, for the energy totals */
+#define POWER_METER_S_PER_H 3600.0
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/** Conversion of one channel of a pair to engineering units */
+typedef struct
+{
+    const float32_t *table;   /**< Conversion table, NULL if none */
+    float32_t        scale;   /**< Units per raw count, without a table */
+    float32_t        offset;  /**< Units at a raw count of 0 */
+    uint16_t         channel; /**< ADC1 channel */
+} power_meter_input_t;
+
+/** Running state of one pair over the window */
+typedef struct
+{
+    power_meter_input_t voltage; /**< Voltage channel */
+    power_meter_input_t current; /**< Current channel */
+    float64_t           power;   /**< Sum of the instantaneous power */
+    float64_t           v2;      /**< Sum of the squared voltage */
+    float64_t           i2;      /**< Sum of the squared current */
+    bool                active;  /**< Metered in this window */
+} power_meter_state_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Configuration, guarded by a critical section */
+static power_meter_config_t s_config = {POWER_METER_DEFAULT_WINDOW_MS,
+                                        {{0U, 0U}}};
+
+/** Pairs whose totals to clear, guarded by a critical section */
+static uint8_t s_clear_mask;
+
+/** Totals of a snapshot still to add, guarded by a critical section */
+static power_meter_energy_t s_restore[POWER_METER_PAIRS];
+static volatile bool        s_restore_pending;
+
+/* Filter task only */
+static power_meter_state_t  s_pairs[POWER_METER_PAIRS];
+static power_meter_energy_t s_energy[POWER_METER_PAIRS]; /**< Totals */
+static bsp_adc1_reader_t    s_reader;         /**< Full-rate stream reader */
+static bool                 s_attached;       /**< s_reader initialized */
+static bool                 s_open;           /**< A window is being filled */
+static uint32_t             s_rate;           /**< Sample rate of the window */
+static uint32_t             s_window_samples; /**< Samples of the window */
+static uint32_t             s_fill;           /**< Samples taken in */
+static uint32_t             s_next_sequence;  /**< Sequence that continues it */
+
+/** Totals as of the last window, written by the filter task, read by the
+ * voltage detector hook */
+static power_meter_energy_t s_saved[2][POWER_METER_PAIRS];
+static volatile uint32_t    s_saved_index;
+
+/** Samples being taken in, and one run of them in engineering units */
+static bsp_adc1_sample_t s_samples[POWER_METER_READ_BATCH];
+static float32_t         s_volts[POWER_METER_READ_BATCH];
+static float32_t         s_amps[POWER_METER_READ_BATCH];
+
+/** Results being computed (filter task only) and last published */
+static power_meter_result_t s_next[POWER_METER_PAIRS];
+static power_meter_result_t s_results[POWER_METER_PAIRS];
+
+/** Windows published, 0 until the first */
+static uint32_t s_windows;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Take the calibration of one channel
+ */
+static void power_meter_input(power_meter_input_t *input, uint16_t channel)
+{
+    float32_t gain   = BSP_ADC1_VREF_V;
+    float32_t offset = 0.0f;
+
+    (void)BSP_ADC1_GetCalibration((uint8_t)channel, &gain, &offset);
+    input->table   = BSP_ADC1_GetConversionTable((uint8_t)channel);
+    input->scale   = gain / (float32_t)BSP_ADC1_FULL_SCALE;
+    input->offset  = offset;
+    input->channel = channel;
+}
+
+/**
+ * @brief Convert one channel of a run of samples
+ *
+ * @param[in]  input   Channel and its calibration
+ * @param[in]  samples Samples of the run
+ * @param[in]  count   Number of samples
+ * @param[out] values  Values in engineering units
+ */
+static void power_meter_convert(const power_meter_input_t *input,
+                                const bsp_adc1_sample_t *samples,
+                                uint32_t count, float32_t *values)
+{
+    if (input->table != NULL)
+    {
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            uint16_t raw = samples[i].raw[input->channel];
+
+            values[i] = input->table[BSP_ADC1_LUT_INDEX(raw)];
+        }
+        return;
+    }
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        values[i] = (float32_t)samples[i].raw[input->channel];
+    }
+    arm_scale_f32(values, input->scale, values, count);
+    arm_offset_f32(values, input->offset, values, count);
+}
+
+/**
+ * @brief Start a window with the current configuration
+ */
+static void power_meter_open(void)
+{
+    power_meter_config_t config;
+
+    taskENTER_CRITICAL();
+    config = s_config;
+    taskEXIT_CRITICAL();
+
+    s_window_samples = ((uint32_t)config.window_ms * s_rate) / 1000U;
+    if (s_window_samples == 0U)
+    {
+        s_window_samples = 1U;
+    }
+
+    for (uint32_t p = 0U; p < POWER_METER_PAIRS; p++)
+    {
+        power_meter_state_t      *pair = &s_pairs[p];
+        const power_meter_pair_t *cfg  = &config.pairs[p];
+
+        (void)memset(pair, 0, sizeof(*pair));
+        pair->active = (cfg->voltage != cfg->current) &&
+                       (cfg->voltage < BSP_ADC1_NUM_CHANNELS) &&
+                       (cfg->current < BSP_ADC1_NUM_CHANNELS);
+        if (pair->active)
+        {
+            power_meter_input(&pair->voltage, cfg->voltage);
+            power_meter_input(&pair->current, cfg->current);
+        }
+    }
+
+    s_fill = 0U;
+    s_open = true;
+}
+
+/**
+ * @brief Meter every pair over one run of consecutive samples
+ *
+ * @param[in] samples Samples of the run
+ * @param[in] count   Number of samples, at least 1, that the window still
+ *                    has room for
+ */
+static void power_meter_segment(const bsp_adc1_sample_t *samples,
+                                uint32_t                 count)
+{
+    for (uint32_t p = 0U; p < POWER_METER_PAIRS; p++)
+    {
+        power_meter_state_t *pair = &s_pairs[p];
+        float32_t            power;
+        float32_t            v2;
+        float32_t            i2;
+
+        if (!pair->active)
+        {
+            continue;
+        }
+
+        power_meter_convert(&pair->voltage, samples, count, s_volts);
+        power_meter_convert(&pair->current, samples, count, s_amps);
+        arm_dot_prod_f32(s_volts, s_amps, count, &power);
+        arm_power_f32(s_volts, count, &v2);
+        arm_power_f32(s_amps, count, &i2);
+
+        pair->power += (float64_t)power;
+        pair->v2 += (float64_t)v2;
+        pair->i2 += (float64_t)i2;
+    }
+
+    s_fill += count;
+}
+
+/**
+ * @brief Apply the clear and restore requests to the totals
+ */
+static void power_meter_requests(void)
+{
+    power_meter_energy_t restore[POWER_METER_PAIRS];
+    uint8_t              clear;
+    bool                 pending;
+
+    taskENTER_CRITICAL();
+    clear   = s_clear_mask;
+    pending = s_restore_pending;
+    (void)memcpy(restore, s_restore, sizeof(restore));
+    s_clear_mask      = 0U;
+    s_restore_pending = false;
+    taskEXIT_CRITICAL();
+
+    for (uint32_t p = 0U; p < POWER_METER_PAIRS; p++)
+    {
+        if ((clear & (1U << p)) != 0U)
+        {
+            (void)memset(&s_energy[p], 0, sizeof(s_energy[p]));
+        }
+        else if (pending)
+        {
+            s_energy[p].imported += restore[p].imported;
+            s_energy[p].exported += restore[p].exported;
+            s_energy[p].apparent += restore[p].apparent;
+        }
+        else
+        {
+            /* Totals kept */
+        }
+    }
+}
+
+/**
+ * @brief Integrate the window into the totals and publish its results
+ *
+ * Also closes a window cut short; an empty one publishes nothing.
+ */
+static void power_meter_close(void)
+{
+    float64_t hours;
+
+    s_open = false;
+    if (s_fill == 0U)
+    {
+        return;
+    }
+
+    hours = (float64_t)s_fill / ((float64_t)s_rate * POWER_METER_S_PER_H);
+    power_meter_requests();
+
+    for (uint32_t p = 0U; p < POWER_METER_PAIRS; p++)
+    {
+        const power_meter_state_t *pair     = &s_pairs[p];
+        float64_t                  real     = 0.0;
+        float64_t                  apparent = 0.0;
+
+        if (pair->active)
+        {
+            real     = pair->power / (float64_t)s_fill;
+            apparent = sqrt(pair->v2 / (float64_t)s_fill) *
+                       sqrt(pair->i2 / (float64_t)s_fill);
+            if (real >= 0.0)
+            {
+                s_energy[p].imported += real * hours;
+            }
+            else
+            {
+                s_energy[p].exported -= real * hours;
+            }
+            s_energy[p].apparent += apparent * hours;
+        }
+
+        s_next[p].real     = (float32_t)real;
+        s_next[p].apparent = (float32_t)apparent;
+        s_next[p].energy   = s_energy[p];
+    }
+
+    /* The hook reads the index once, so the copy it points to is whole */
+    (void)memcpy(s_saved[s_saved_index ^ 1U], s_energy, sizeof(s_energy));
+    s_saved_index ^= 1U;
+
+    taskENTER_CRITICAL();
+    (void)memcpy(s_results, s_next, sizeof(s_results));
+    s_windows++;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Take a batch of samples into the window
+ *
+ * A sample that does not follow the one before closes the window early
+ * and starts the next with it.
+ */
+static void power_meter_take(const bsp_adc1_sample_t *samples, uint32_t count)
+{
+    uint32_t i = 0U;
+
+    while (i < count)
+    {
+        uint32_t room;
+        uint32_t run = 1U;
+
+        if (s_open && (samples[i].sequence != s_next_sequence))
+        {
+            power_meter_close();
+        }
+        if (!s_open)
+        {
+            power_meter_open();
+        }
+
+        room = s_window_samples - s_fill;
+        while (((i + run) < count) && (run < room) &&
+               (samples[i + run].sequence == (samples[i].sequence + run)))
+        {
+            run++;
+        }
+
+        power_meter_segment(&samples[i], run);
+        s_next_sequence = samples[i + run - 1U].sequence + 1U;
+        i += run;
+
+        if (s_fill == s_window_samples)
+        {
+            power_meter_close();
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void power_meter_set_config(const power_meter_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_config = *config;
+    if (s_config.window_ms < POWER_METER_MIN_WINDOW_MS)
+    {
+        s_config.window_ms = POWER_METER_MIN_WINDOW_MS;
+    }
+    if (s_config.window_ms > POWER_METER_MAX_WINDOW_MS)
+    {
+        s_config.window_ms = POWER_METER_MAX_WINDOW_MS;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void power_meter_process(void)
+{
+    uint32_t rate = BSP_ADC1_GetSampleRate();
+    uint32_t count;
+
+    if (!s_attached)
+    {
+        (void)BSP_ADC1_RingReaderInit(&s_reader, BSP_ADC1_STREAM_FULL);
+        s_attached = true;
+    }
+
+    /* A window is taken at one rate throughout */
+    if (rate != s_rate)
+    {
+        if (s_open)
+        {
+            power_meter_close();
+        }
+        s_rate = rate;
+    }
+
+    do
+    {
+        uint32_t overruns = s_reader.overruns;
+
+        if (BSP_ADC1_RingRead(&s_reader, s_samples, POWER_METER_READ_BATCH,
+                              &count) != BSP_OK)
+        {
+            break;
+        }
+        metrics_add(METRIC_ADC_OVERRUN, s_reader.overruns - overruns);
+        power_meter_take(s_samples, count);
+    } while (count == POWER_METER_READ_BATCH);
+}
+
+uint32_t
+power_meter_get_results(power_meter_result_t results[POWER_METER_PAIRS])
+{
+    uint32_t windows;
+
+    taskENTER_CRITICAL();
+    (void)memcpy(results, s_results, sizeof(s_results));
+    windows = s_windows;
+    taskEXIT_CRITICAL();
+
+    return windows;
+}
+
+void power_meter_clear_energy(uint8_t mask)
+{
+    taskENTER_CRITICAL();
+    s_clear_mask |= mask;
+    taskEXIT_CRITICAL();
+}
+
+void power_meter_restore_energy(
+    const power_meter_energy_t energy[POWER_METER_PAIRS])
+{
+    taskENTER_CRITICAL();
+    (void)memcpy(s_restore, energy, sizeof(s_restore));
+    s_restore_pending = true;
+    taskEXIT_CRITICAL();
+}
+
+void power_meter_saved_energy(power_meter_energy_t energy[POWER_METER_PAIRS])
+{
+    (void)memcpy(energy, s_saved[s_saved_index], sizeof(s_saved[0]));
+
+    /* A restore the filter task has not taken yet */
+    if (s_restore_pending)
+    {
+        for (uint32_t p = 0U; p < POWER_METER_PAIRS; p++)
+        {
+            energy[p].imported += s_restore[p].imported;
+            energy[p].exported += s_restore[p].exported;
+            energy[p].apparent += s_restore[p].apparent;
+        }
+    }
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Statistical PC Sampling Profiler Task
+ *
+ * The sampling interrupt writes a sample and advances the head; it runs
+ * above every other interrupt that touches the ring, so it needs no lock.
+ * The profile task is the only reader: as in the event trace (trace.c) it
+ * sends the samples between the tail and the head straight from the ring
+ * and frees them once sent, and samples lost while the ring is full always
+ * follow those in it at the moment of the drain. The stream format is
+ * described in profile.h.
+ */
+
+#include "profile.h"
+
+#if PROFILE_ENABLE
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "boot.h"
+#include "bsp.h"
+#include "bsp_sections.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "metrics.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the task (words) */
+#define PROFILE_STACK_SIZE 384U
+
+/** Tasks the task table can list */
+#define PROFILE_MAX_TASKS 32U
+
+/** Time a client has to send its request */
+#define PROFILE_REQUEST_TIMEOUT_MS 2000U
+
+_Static_assert((PROFILE_RING_SAMPLES & (PROFILE_RING_SAMPLES - 1U)) == 0U,
+               "the ring size must be a power of two");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One sample, in its wire layout
+ */
+typedef struct
+{
+    uint32_t pc;        /**< Program counter */
+    uint32_t lr;        /**< Link register */
+    uint16_t task;      /**< Task number */
+    uint8_t  exception; /**< Exception number, 0 in thread mode */
+    uint8_t  flags;     /**< PROFILE_FLAG_* */
+} profile_sample_t;
+
+_Static_assert(sizeof(profile_sample_t) == PROFILE_SAMPLE_SIZE,
+               "samples are sent as they are stored");
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task control block and stack */
+static StaticTask_t s_profile_task_tcb;
+static StackType_t  s_profile_task_stack[PROFILE_STACK_SIZE] BSP_SECTION_STACK;
+
+/** Sample ring */
+static profile_sample_t s_ring[PROFILE_RING_SAMPLES];
+
+/** Samples written, and samples sent, since boot */
+static atomic_uint s_head;
+static atomic_uint s_tail;
+
+/** Samples dropped, written by the interrupt only */
+static atomic_uint s_dropped;
+
+/** Samples dropped that were reported (profile task only) */
+static uint32_t s_dropped_sent;
+
+/** Task states read for the task table (profile task only) */
+static TaskStatus_t s_task_status[PROFILE_MAX_TASKS];
+
+/** Header and task table being sent */
+static uint8_t s_header[PROFILE_HEADER_SIZE +
+                        (PROFILE_MAX_TASKS * PROFILE_TASK_ENTRY_SIZE)];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Load a 16-bit little-endian value
+ */
+static uint16_t get_u16(const uint8_t *src)
+{
+    return (uint16_t)(src[0] | ((uint16_t)src[1] << 8U));
+}
+
+/**
+ * @brief Load a 32-bit little-endian value
+ */
+static uint32_t get_u32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8U) |
+           ((uint32_t)src[2] << 16U) | ((uint32_t)src[3] << 24U);
+}
+
+/**
+ * @brief Store a 16-bit value little-endian
+ */
+static void put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static void put_u32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+    dst[2] = (uint8_t)(value >> 16U);
+    dst[3] = (uint8_t)(value >> 24U);
+}
+
+/**
+ * @brief Store one sample, run by the sampling interrupt
+ *
+ * Above the kernel's mask: the running task and its number (set by
+ * profile_send_header()) are plain reads of the kernel state. A sample
+ * taken during a context switch may name the task switched out.
+ */
+static void profile_hook(const bsp_profile_sample_t *sample)
+{
+    uint32_t head = atomic_load_explicit(&s_head, memory_order_relaxed);
+
+    if ((head - atomic_load_explicit(&s_tail, memory_order_acquire)) <
+        PROFILE_RING_SAMPLES)
+    {
+        profile_sample_t *slot = &s_ring[head & (PROFILE_RING_SAMPLES - 1U)];
+        TaskHandle_t      task = xTaskGetCurrentTaskHandle();
+
+        slot->pc        = sample->pc;
+        slot->lr        = sample->lr;
+        slot->task      = (task != NULL)
+                              ? (uint16_t)uxTaskGetTaskNumber(task)
+                              : 0U;
+        slot->exception = (uint8_t)sample->exception;
+        slot->flags     = sample->secure ? PROFILE_FLAG_SECURE : 0U;
+        atomic_store_explicit(&s_head, head + 1U, memory_order_release);
+    }
+    else
+    {
+        atomic_fetch_add_explicit(&s_dropped, 1U, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Receive the request of a client
+ *
+ * @param[out] hz Sample rate asked for
+ * @return true for a valid request
+ */
+static bool profile_request(struct netconn *conn, uint32_t *hz)
+{
+    uint8_t        request[PROFILE_REQUEST_SIZE];
+    uint32_t       received = 0U;
+    struct netbuf *buf;
+
+    netconn_set_recvtimeout(conn, PROFILE_REQUEST_TIMEOUT_MS);
+
+    while (received < sizeof(request))
+    {
+        if (netconn_recv(conn, &buf) != ERR_OK)
+        {
+            return false;
+        }
+        received += netbuf_copy_partial(buf, &request[received],
+                                        (u16_t)(sizeof(request) - received),
+                                        0U);
+        netbuf_delete(buf);
+    }
+
+    *hz = get_u32(&request[4]);
+    if (*hz == 0U)
+    {
+        *hz = PROFILE_DEFAULT_HZ;
+    }
+
+    return (get_u16(request) == PROFILE_MAGIC) &&
+           (request[2] == PROFILE_VERSION) && (*hz >= BSP_PROFILE_MIN_HZ) &&
+           (*hz <= BSP_PROFILE_MAX_HZ);
+}
+
+/**
+ * @brief Send the header and the task table
+ */
+static err_t profile_send_header(struct netconn *conn, uint32_t hz)
+{
+    UBaseType_t count = uxTaskGetSystemState(s_task_status,
+                                             PROFILE_MAX_TASKS, NULL);
+    uint8_t    *entry = &s_header[PROFILE_HEADER_SIZE];
+
+    put_u16(&s_header[0], (uint16_t)PROFILE_MAGIC);
+    s_header[2] = (uint8_t)PROFILE_VERSION;
+    s_header[3] = (uint8_t)PROFILE_SAMPLE_SIZE;
+    put_u32(&s_header[4], hz);
+    put_u16(&s_header[8], (uint16_t)count);
+    put_u16(&s_header[10], 0U);
+
+    for (UBaseType_t i = 0U; i < count; i++)
+    {
+        const TaskStatus_t *task = &s_task_status[i];
+
+        /* The kernel's own number of a task is private to it: give each
+         * task the number of the table for the sampling interrupt */
+        vTaskSetTaskNumber(task->xHandle, task->xTaskNumber);
+        put_u16(&entry[0], (uint16_t)task->xTaskNumber);
+        entry[2] = (uint8_t)task->uxBasePriority;
+        entry[3] = 0U;
+        (void)memset(&entry[4], 0, PROFILE_NAME_SIZE);
+        (void)strncpy((char *)&entry[4], task->pcTaskName,
+                      PROFILE_NAME_SIZE - 1U);
+        entry = &entry[PROFILE_TASK_ENTRY_SIZE];
+    }
+
+    return netconn_write(conn, s_header, (size_t)(entry - s_header),
+                         NETCONN_COPY);
+}
+
+/**
+ * @brief Send the samples taken since the last drain and free them
+ */
+static err_t profile_drain(struct netconn *conn)
+{
+    uint32_t tail    = atomic_load_explicit(&s_tail, memory_order_relaxed);
+    uint32_t head    = atomic_load_explicit(&s_head, memory_order_acquire);
+    uint32_t dropped = atomic_load(&s_dropped) - s_dropped_sent;
+    err_t    err     = ERR_OK;
+
+    while ((err == ERR_OK) && (tail != head))
+    {
+        uint32_t index = tail & (PROFILE_RING_SAMPLES - 1U);
+        uint32_t count = head - tail;
+
+        /* Up to the end of the ring, the rest on the next pass */
+        if (count > (PROFILE_RING_SAMPLES - index))
+        {
+            count = PROFILE_RING_SAMPLES - index;
+        }
+
+        err = netconn_write(conn, &s_ring[index],
+                            (size_t)count * sizeof(s_ring[0]), NETCONN_COPY);
+        tail += count;
+    }
+
+    /* Free the ring before the lost record, so sampling resumes */
+    atomic_store_explicit(&s_tail, tail, memory_order_release);
+
+    if ((err == ERR_OK) && (dropped != 0U))
+    {
+        profile_sample_t lost = {
+            .pc    = dropped,
+            .flags = PROFILE_FLAG_LOST,
+        };
+
+        s_dropped_sent += dropped;
+        metrics_add(METRIC_PROFILE_DROP, dropped);
+        err = netconn_write(conn, &lost, sizeof(lost), NETCONN_COPY);
+    }
+
+    return err;
+}
+
+/**
+ * @brief Sample and stream to one client until it goes away
+ */
+static void profile_stream(struct netconn *conn)
+{
+    uint32_t    hz;
+    err_t       err;
+    bsp_error_t ret;
+
+    if (!profile_request(conn, &hz))
+    {
+        printf("Profile: bad request\n");
+        return;
+    }
+
+    /* The timer is stopped, so the ring is idle */
+    atomic_store(&s_tail, atomic_load(&s_head));
+    s_dropped_sent = atomic_load(&s_dropped);
+
+    err = profile_send_header(conn, hz);
+    if (err != ERR_OK)
+    {
+        return;
+    }
+
+    ret = BSP_Profile_Start(hz, profile_hook);
+    if (ret != BSP_OK)
+    {
+        printf("Profile: sampling not started (%d)\n", (int)ret);
+        return;
+    }
+    printf("Profile: client connected, %lu Hz\n", (unsigned long)hz);
+
+    while (err == ERR_OK)
+    {
+        vTaskDelay(pdMS_TO_TICKS(PROFILE_DRAIN_MS));
+        err = profile_drain(conn);
+    }
+
+    BSP_Profile_Stop();
+    printf("Profile: client gone (%d)\n", (int)err);
+}
+
+/**
+ * @brief Profile task
+ */
+static void profile_task(void *pvParameters)
+{
+    struct netconn *listen_conn;
+    struct netconn *conn;
+
+    (void)pvParameters;
+
+    /* Wait for the network interface, as the trace task does */
+    (void)boot_wait(BOOT_EVENT_NETIF_UP, BOOT_WAIT_FOREVER);
+
+    while ((listen_conn = netconn_new(NETCONN_TCP)) == NULL)
+    {
+        printf("Profile: Failed to create connection\n");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    if ((netconn_bind(listen_conn, IP_ADDR_ANY, PROFILE_PORT) != ERR_OK) ||
+        (netconn_listen_with_backlog(listen_conn, 1U) != ERR_OK))
+    {
+        printf("Profile: Failed to listen on port %u\n", PROFILE_PORT);
+        netconn_delete(listen_conn);
+        vTaskDelete(NULL);
+    }
+
+    printf("Profile server listening on port %u\n", PROFILE_PORT);
+
+    for (;;)
+    {
+        if (netconn_accept(listen_conn, &conn) != ERR_OK)
+        {
+            continue;
+        }
+
+        profile_stream(conn);
+        netconn_close(conn);
+        netconn_delete(conn);
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void profile_start(void)
+{
+    (void)xTaskCreateStatic(profile_task, "Profile", PROFILE_STACK_SIZE, NULL,
+                            TASK_PRIO_PROFILE, s_profile_task_stack,
+                            &s_profile_task_tcb);
+}
+
+#endif /* PROFILE_ENABLE */
@@ -0,0 +1,671 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * IEEE 1588 PTP Slave
+ *
+ * Both ports are non-blocking netconns whose callback wakes the task, so
+ * one task serves Sync on the event port and Follow_Up and Delay_Resp on
+ * the general port. The receive timestamp of a Sync and the transmit
+ * timestamp of a Delay_Req are collected from the driver by sequence ID;
+ * the message formats are those of IEEE 1588-2008 (PTPv2).
+ */
+
+#include "ptp.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "app_tasks.h"
+#include "boot.h"
+#include "bsp.h"
+#include "ethernetif.h"
+#include "log.h"
+#include "lwip/api.h"
+#include "lwip/netbuf.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Definitions
+ * ========================================================================== */
+
+/** Message types (low nibble of the first header byte) */
+#define PTP_MSG_SYNC       0x0U
+#define PTP_MSG_DELAY_REQ  0x1U
+#define PTP_MSG_FOLLOW_UP  0x8U
+#define PTP_MSG_DELAY_RESP 0x9U
+
+/** Common header size, and the message sizes that follow from it */
+#define PTP_HEADER_SIZE     34U
+#define PTP_SYNC_SIZE       44U
+#define PTP_DELAY_RESP_SIZE 54U
+
+/** Header fields */
+#define PTP_OFF_TYPE       0U
+#define PTP_OFF_VERSION    1U
+#define PTP_OFF_LENGTH     2U
+#define PTP_OFF_DOMAIN     4U
+#define PTP_OFF_FLAGS      6U
+#define PTP_OFF_CORRECTION 8U
+#define PTP_OFF_SOURCE     20U
+#define PTP_OFF_SEQUENCE   30U
+#define PTP_OFF_CONTROL    32U
+#define PTP_OFF_INTERVAL   33U
+#define PTP_OFF_TIMESTAMP  34U
+#define PTP_OFF_REQUESTER  44U
+
+/** sourcePortIdentity size: clockIdentity and portNumber */
+#define PTP_PORT_ID_SIZE 10U
+
+/** twoStepFlag in the first flag byte */
+#define PTP_FLAG_TWO_STEP 0x02U
+
+/** controlField of a Delay_Req, logMessageInterval it carries */
+#define PTP_CONTROL_DELAY_REQ 0x01U
+#define PTP_INTERVAL_UNKNOWN  0x7FU
+
+/** Sync intervals the servo accepts (log2 s) */
+#define PTP_LOG_INTERVAL_MIN (-7)
+#define PTP_LOG_INTERVAL_MAX 4
+
+/** PI servo gains, per second of Sync interval */
+#define PTP_SERVO_KP 0.7f
+#define PTP_SERVO_KI 0.3f
+
+/** Weight of a new sample in the mean path delay, 1 / 2^n */
+#define PTP_DELAY_FILTER_SHIFT 3U
+
+/** Longest wait for a message before the timers are checked, in ms */
+#define PTP_POLL_MS 100U
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Exchange in progress and servo state (PTP task only)
+ */
+typedef struct
+{
+    struct netconn *event;   /**< Event port: Sync in, Delay_Req out */
+    struct netconn *general; /**< General port: Follow_Up, Delay_Resp */
+    struct netbuf  *tx_buf;  /**< Carrier of the Delay_Req */
+
+    uint8_t    self[PTP_PORT_ID_SIZE];   /**< Our port identity */
+    uint8_t    master[PTP_PORT_ID_SIZE]; /**< Port identity followed */
+    bool       has_master;               /**< master is valid */
+    TickType_t last_heard;               /**< Tick of its last Sync */
+
+    uint16_t sync_seq;     /**< Sequence ID of the pending Sync */
+    bool     sync_valid;   /**< t2 is known, waiting for t1 */
+    int64_t  t2;           /**< Sync receive time */
+    int64_t  sync_corr;    /**< Sync correctionField, ns */
+    int8_t   log_interval; /**< Sync interval of the master, log2 s */
+    int64_t  ms_delay;     /**< t2 - t1 of the last complete Sync */
+    bool     ms_valid;     /**< ms_delay is valid */
+
+    uint16_t   delay_seq;      /**< Sequence ID of the last Delay_Req */
+    bool       delay_pending;  /**< Waiting for its Delay_Resp */
+    bool       t3_valid;       /**< t3 is known */
+    int64_t    t3;             /**< Delay_Req transmit time */
+    TickType_t last_delay_req; /**< Tick the last one was sent */
+    bool       delay_valid;    /**< path_delay has been measured */
+    int64_t    path_delay;     /**< Mean path delay, ns */
+
+    float    integral; /**< Servo integral term, ppb */
+    int32_t  freq_ppb; /**< Rate correction applied */
+    uint32_t in_lock;  /**< Consecutive offsets within the lock */
+} ptp_state_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+static ptp_state_t s_ptp;
+
+/** Task woken by the netconn callback */
+static TaskHandle_t s_task;
+
+/** State published to other tasks, under a critical section */
+static ptp_status_t s_status;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Wake the task when a datagram arrived (tcpip thread)
+ */
+static void ptp_netconn_callback(struct netconn *conn, enum netconn_evt evt,
+                                 u16_t len)
+{
+    (void)conn;
+    (void)len;
+
+    if ((evt == NETCONN_EVT_RCVPLUS) && (s_task != NULL))
+    {
+        (void)xTaskNotifyGive(s_task);
+    }
+}
+
+static uint16_t get_u16(const uint8_t *src)
+{
+    return (uint16_t)(((uint16_t)src[0] << 8) | src[1]);
+}
+
+/**
+ * @brief Read a PTP Timestamp (48-bit seconds, 32-bit nanoseconds) as ns
+ */
+static int64_t get_timestamp(const uint8_t *src)
+{
+    uint64_t seconds = 0U;
+    uint32_t nanos   = 0U;
+
+    for (uint32_t i = 0U; i < 6U; i++)
+    {
+        seconds = (seconds << 8) | src[i];
+    }
+    for (uint32_t i = 6U; i < 10U; i++)
+    {
+        nanos = (nanos << 8) | src[i];
+    }
+
+    return (int64_t)((seconds * (uint64_t)BSP_PTP_NS_PER_S) + nanos);
+}
+
+/**
+ * @brief Read a correctionField (ns scaled by 2^16) as whole ns
+ */
+static int64_t get_correction(const uint8_t *src)
+{
+    uint64_t value = 0U;
+
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        value = (value << 8) | src[i];
+    }
+
+    return (int64_t)value / 65536;
+}
+
+/**
+ * @brief Publish the state for ptp_get_status()
+ */
+static void ptp_publish(const ptp_state_t *ptp, int64_t offset,
+                        int32_t freq_ppb, bool synced, bool stepped)
+{
+    taskENTER_CRITICAL();
+    s_status.has_master = ptp->has_master;
+    (void)memcpy(s_status.master_identity, ptp->master,
+                 sizeof(s_status.master_identity));
+    s_status.offset_ns     = offset;
+    s_status.path_delay_ns = ptp->path_delay;
+    s_status.freq_ppb      = freq_ppb;
+    s_status.locked        = ptp->in_lock >= PTP_LOCK_COUNT;
+    if (synced)
+    {
+        s_status.syncs++;
+    }
+    if (stepped)
+    {
+        s_status.steps++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Forget the exchanges in flight, whose times a step invalidated
+ */
+static void ptp_reset_exchange(ptp_state_t *ptp)
+{
+    ptp->sync_valid    = false;
+    ptp->ms_valid      = false;
+    ptp->delay_pending = false;
+    ptp->t3_valid      = false;
+}
+
+/**
+ * @brief Drop the master and start over with the next one heard
+ */
+static void ptp_drop_master(ptp_state_t *ptp)
+{
+    ptp_reset_exchange(ptp);
+    ptp->has_master  = false;
+    ptp->delay_valid = false;
+    ptp->in_lock     = 0U;
+#if BSP_ADC1_SYNC
+    BSP_ADC1_SetTriggerSync(false);
+#endif
+    ptp_publish(ptp, 0, ptp->freq_ppb, false, false);
+}
+
+/**
+ * @brief Collect the transmit time of the pending Delay_Req
+ */
+static void ptp_collect_t3(ptp_state_t *ptp)
+{
+    uint64_t t3;
+
+    if (ptp->delay_pending && !ptp->t3_valid &&
+        ethernetif_ptp_tx_stamp(ptp->delay_seq, &t3))
+    {
+        ptp->t3       = (int64_t)t3;
+        ptp->t3_valid = true;
+    }
+}
+
+/**
+ * @brief Correct the clock by one offset measurement
+ *
+ * @param offset Slave time minus master time, in ns
+ */
+static void ptp_servo(ptp_state_t *ptp, int64_t offset)
+{
+    float   interval_s;
+    float   rate;
+    float   freq;
+    int32_t ppb;
+
+    if ((offset > PTP_STEP_THRESHOLD_NS) || (offset < -PTP_STEP_THRESHOLD_NS))
+    {
+        if (BSP_PTP_StepNs(-offset) == BSP_OK)
+        {
+            LOG("PTP: clock stepped\n");
+            ptp_reset_exchange(ptp);
+            ptp->in_lock = 0U;
+            ptp_publish(ptp, offset, ptp->freq_ppb, true, true);
+        }
+        return;
+    }
+
+    /* The offset gained over one interval is the rate error */
+    interval_s = (ptp->log_interval >= 0)
+                     ? (float)(1UL << (uint32_t)ptp->log_interval)
+                     : 1.0f / (float)(1UL << (uint32_t)(-ptp->log_interval));
+    rate       = (float)offset / interval_s;
+
+    ptp->integral += PTP_SERVO_KI * rate;
+    if (ptp->integral > (float)BSP_PTP_MAX_ADJ_PPB)
+    {
+        ptp->integral = (float)BSP_PTP_MAX_ADJ_PPB;
+    }
+    else if (ptp->integral < -(float)BSP_PTP_MAX_ADJ_PPB)
+    {
+        ptp->integral = -(float)BSP_PTP_MAX_ADJ_PPB;
+    }
+
+    /* Ahead of the master (positive offset) runs slower */
+    freq = -((PTP_SERVO_KP * rate) + ptp->integral);
+    ppb  = (int32_t)freq;
+    if (BSP_PTP_AdjustFrequency(ppb) == BSP_OK)
+    {
+        ptp->freq_ppb = ppb;
+    }
+
+    if ((offset <= PTP_LOCK_THRESHOLD_NS) && (offset >= -PTP_LOCK_THRESHOLD_NS))
+    {
+        if (ptp->in_lock < PTP_LOCK_COUNT)
+        {
+            ptp->in_lock++;
+            if (ptp->in_lock == PTP_LOCK_COUNT)
+            {
+                LOG("PTP: locked, offset %d ns\n", (int)offset);
+#if BSP_ADC1_SYNC
+                BSP_ADC1_SetTriggerSync(true);
+#endif
+            }
+        }
+    }
+    else
+    {
+        if (ptp->in_lock >= PTP_LOCK_COUNT)
+        {
+            LOG("PTP: lost lock, offset %d ns\n", (int)offset);
+        }
+        ptp->in_lock = 0U;
+    }
+
+    ptp_publish(ptp, offset, ptp->freq_ppb, true, false);
+}
+
+/**
+ * @brief Send a Delay_Req once the interval since the last one passed
+ */
+static void ptp_send_delay_req(ptp_state_t *ptp)
+{
+    ip_addr_t dest;
+    uint8_t  *msg;
+
+    if ((xTaskGetTickCount() - ptp->last_delay_req) <
+        pdMS_TO_TICKS(PTP_DELAY_REQ_INTERVAL_MS))
+    {
+        return;
+    }
+
+    msg = (uint8_t *)netbuf_alloc(ptp->tx_buf, PTP_SYNC_SIZE);
+    if (msg == NULL)
+    {
+        return;
+    }
+
+    ptp->delay_seq++;
+    (void)memset(msg, 0, PTP_SYNC_SIZE);
+    msg[PTP_OFF_TYPE]           = PTP_MSG_DELAY_REQ;
+    msg[PTP_OFF_VERSION]        = 2U;
+    msg[PTP_OFF_LENGTH + 1U]    = PTP_SYNC_SIZE;
+    msg[PTP_OFF_DOMAIN]         = PTP_DOMAIN;
+    (void)memcpy(&msg[PTP_OFF_SOURCE], ptp->self, PTP_PORT_ID_SIZE);
+    msg[PTP_OFF_SEQUENCE]       = (uint8_t)(ptp->delay_seq >> 8);
+    msg[PTP_OFF_SEQUENCE + 1U]  = (uint8_t)ptp->delay_seq;
+    msg[PTP_OFF_CONTROL]        = PTP_CONTROL_DELAY_REQ;
+    msg[PTP_OFF_INTERVAL]       = PTP_INTERVAL_UNKNOWN;
+    /* originTimestamp stays 0: t3 is the hardware stamp */
+
+    IP_ADDR4(&dest, 224, 0, 1, 129);
+    if (netconn_sendto(ptp->event, ptp->tx_buf, &dest,
+                       ETHERNETIF_PTP_EVENT_PORT) == ERR_OK)
+    {
+        ptp->delay_pending  = true;
+        ptp->t3_valid       = false;
+        ptp->last_delay_req = xTaskGetTickCount();
+    }
+    netbuf_free(ptp->tx_buf);
+}
+
+/**
+ * @brief Complete a Sync exchange with its origin time
+ *
+ * @param t1 Origin time of the Sync, corrections applied
+ */
+static void ptp_sync_complete(ptp_state_t *ptp, int64_t t1)
+{
+    ptp->sync_valid = false;
+    ptp->ms_delay   = ptp->t2 - t1;
+    ptp->ms_valid   = true;
+
+    /* Until the first Delay_Resp, steps ignore the path delay */
+    ptp_servo(ptp, ptp->ms_delay - (ptp->delay_valid ? ptp->path_delay : 0));
+
+    if (ptp->ms_valid)
+    {
+        ptp_send_delay_req(ptp);
+    }
+}
+
+/**
+ * @brief Handle a message of the event port
+ */
+static void ptp_handle_event(ptp_state_t *ptp, const uint8_t *msg,
+                             uint16_t len)
+{
+    uint16_t seq;
+    uint64_t t2;
+
+    if ((len < PTP_SYNC_SIZE) ||
+        ((msg[PTP_OFF_TYPE] & 0x0FU) != PTP_MSG_SYNC))
+    {
+        return;
+    }
+
+    if (!ptp->has_master)
+    {
+        (void)memcpy(ptp->master, &msg[PTP_OFF_SOURCE], PTP_PORT_ID_SIZE);
+        ptp->has_master = true;
+        LOG("PTP: following master %02x%02x%02x...\n",
+            msg[PTP_OFF_SOURCE], msg[PTP_OFF_SOURCE + 1U],
+            msg[PTP_OFF_SOURCE + 2U]);
+    }
+    else if (memcmp(ptp->master, &msg[PTP_OFF_SOURCE], PTP_PORT_ID_SIZE) !=
+             0)
+    {
+        return;
+    }
+
+    seq              = get_u16(&msg[PTP_OFF_SEQUENCE]);
+    ptp->last_heard  = xTaskGetTickCount();
+    ptp->sync_valid  = false;
+    if (!ethernetif_ptp_rx_stamp(seq, &t2))
+    {
+        return;
+    }
+
+    ptp->t2           = (int64_t)t2;
+    ptp->sync_seq     = seq;
+    ptp->sync_corr    = get_correction(&msg[PTP_OFF_CORRECTION]);
+    ptp->log_interval = (int8_t)msg[PTP_OFF_INTERVAL];
+    if (ptp->log_interval < PTP_LOG_INTERVAL_MIN)
+    {
+        ptp->log_interval = PTP_LOG_INTERVAL_MIN;
+    }
+    else if (ptp->log_interval > PTP_LOG_INTERVAL_MAX)
+    {
+        ptp->log_interval = PTP_LOG_INTERVAL_MAX;
+    }
+
+    if ((msg[PTP_OFF_FLAGS] & PTP_FLAG_TWO_STEP) != 0U)
+    {
+        ptp->sync_valid = true;
+    }
+    else
+    {
+        ptp_sync_complete(ptp, get_timestamp(&msg[PTP_OFF_TIMESTAMP]) +
+                                   ptp->sync_corr);
+    }
+}
+
+/**
+ * @brief Handle a message of the general port
+ */
+static void ptp_handle_general(ptp_state_t *ptp, const uint8_t *msg,
+                               uint16_t len)
+{
+    uint8_t  type = msg[PTP_OFF_TYPE] & 0x0FU;
+    uint16_t seq  = get_u16(&msg[PTP_OFF_SEQUENCE]);
+    int64_t  delay;
+
+    if (!ptp->has_master ||
+        (memcmp(ptp->master, &msg[PTP_OFF_SOURCE], PTP_PORT_ID_SIZE) != 0))
+    {
+        return;
+    }
+
+    if ((type == PTP_MSG_FOLLOW_UP) && (len >= PTP_SYNC_SIZE))
+    {
+        if (ptp->sync_valid && (seq == ptp->sync_seq))
+        {
+            ptp_sync_complete(ptp,
+                              get_timestamp(&msg[PTP_OFF_TIMESTAMP]) +
+                                  ptp->sync_corr +
+                                  get_correction(&msg[PTP_OFF_CORRECTION]));
+        }
+    }
+    else if ((type == PTP_MSG_DELAY_RESP) && (len >= PTP_DELAY_RESP_SIZE))
+    {
+        if (!ptp->delay_pending || (seq != ptp->delay_seq) ||
+            (memcmp(ptp->self, &msg[PTP_OFF_REQUESTER], PTP_PORT_ID_SIZE) !=
+             0))
+        {
+            return;
+        }
+        ptp_collect_t3(ptp);
+        ptp->delay_pending = false;
+        if (!ptp->t3_valid || !ptp->ms_valid)
+        {
+            return;
+        }
+
+        delay = (ptp->ms_delay +
+                 ((get_timestamp(&msg[PTP_OFF_TIMESTAMP]) -
+                   get_correction(&msg[PTP_OFF_CORRECTION])) -
+                  ptp->t3)) /
+                2;
+        if (delay < 0)
+        {
+            return;
+        }
+
+        if (ptp->delay_valid)
+        {
+            ptp->path_delay +=
+                (delay - ptp->path_delay) / (1 << PTP_DELAY_FILTER_SHIFT);
+        }
+        else
+        {
+            ptp->path_delay  = delay;
+            ptp->delay_valid = true;
+        }
+    }
+    else
+    {
+        /* Announce, Management, Signaling: not used */
+    }
+}
+
+/**
+ * @brief Handle every datagram queued on a connection
+ */
+static void ptp_drain(ptp_state_t *ptp, struct netconn *conn, bool event)
+{
+    struct netbuf *buf;
+    uint8_t        msg[PTP_DELAY_RESP_SIZE];
+    uint16_t       len;
+
+    while (netconn_recv(conn, &buf) == ERR_OK)
+    {
+        len = netbuf_copy(buf, msg, sizeof(msg));
+        netbuf_delete(buf);
+
+        if ((len < PTP_HEADER_SIZE) || ((msg[PTP_OFF_VERSION] & 0x0FU) != 2U) ||
+            (msg[PTP_OFF_DOMAIN] != PTP_DOMAIN))
+        {
+            continue;
+        }
+
+        if (event)
+        {
+            ptp_handle_event(ptp, msg, len);
+        }
+        else
+        {
+            ptp_handle_general(ptp, msg, len);
+        }
+    }
+}
+
+/**
+ * @brief Open a non-blocking PTP port
+ */
+static struct netconn *ptp_open(uint16_t port)
+{
+    struct netconn *conn;
+
+    while ((conn = netconn_new_with_callback(NETCONN_UDP,
+                                             ptp_netconn_callback)) == NULL)
+    {
+        printf("PTP: Failed to create UDP connection\n");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    if (netconn_bind(conn, IP_ADDR_ANY, port) != ERR_OK)
+    {
+        printf("PTP: Failed to bind port %u\n", (unsigned)port);
+    }
+    netconn_set_nonblocking(conn, 1);
+
+    /* Delay_Req waiting in a switch queue would skew the path delay */
+    LOCK_TCPIP_CORE();
+    conn->pcb.udp->tos = ETHERNETIF_TOS_CONTROL;
+    UNLOCK_TCPIP_CORE();
+
+    return conn;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+bool ptp_is_locked(void) { return s_status.locked; }
+
+void ptp_get_status(ptp_status_t *status)
+{
+    if (status == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *status = s_status;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief PTP slave task
+ */
+void vPtpTask(void *pvParameters)
+{
+    ptp_state_t *ptp = &s_ptp;
+    ip_addr_t    group;
+    uint8_t      mac[6];
+
+    (void)pvParameters;
+
+    s_task = xTaskGetCurrentTaskHandle();
+
+    /* Wait for the network interface, as the Modbus task does */
+    (void)boot_wait(BOOT_EVENT_NETIF_UP, BOOT_WAIT_FOREVER);
+
+    /* clockIdentity: EUI-64 from the MAC address, port 1 */
+    ethernetif_get_mac_addr(mac);
+    ptp->self[0] = mac[0];
+    ptp->self[1] = mac[1];
+    ptp->self[2] = mac[2];
+    ptp->self[3] = 0xFFU;
+    ptp->self[4] = 0xFEU;
+    ptp->self[5] = mac[3];
+    ptp->self[6] = mac[4];
+    ptp->self[7] = mac[5];
+    ptp->self[9] = 1U;
+
+    ptp->event   = ptp_open(ETHERNETIF_PTP_EVENT_PORT);
+    ptp->general = ptp_open(PTP_GENERAL_PORT);
+
+    /* Only joined groups pass the MAC multicast filter */
+    IP_ADDR4(&group, 224, 0, 1, 129);
+    if (netconn_join_leave_group(ptp->event, &group, IP_ADDR_ANY,
+                                 NETCONN_JOIN) != ERR_OK)
+    {
+        printf("PTP: Failed to join 224.0.1.129\n");
+    }
+    while ((ptp->tx_buf = netbuf_new()) == NULL)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    /* The first Delay_Req may go out with the first Follow_Up */
+    ptp->last_delay_req =
+        xTaskGetTickCount() - pdMS_TO_TICKS(PTP_DELAY_REQ_INTERVAL_MS);
+
+    printf("PTP slave started\n");
+
+    for (;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PTP_POLL_MS));
+
+        ptp_drain(ptp, ptp->event, true);
+        ptp_drain(ptp, ptp->general, false);
+
+        /* The TX stamp arrives from the TX complete interrupt */
+        ptp_collect_t3(ptp);
+
+        if (ptp->has_master &&
+            ((xTaskGetTickCount() - ptp->last_heard) >
+             pdMS_TO_TICKS(PTP_MASTER_TIMEOUT_MS)))
+        {
+            LOG("PTP: master lost\n");
+            ptp_drop_master(ptp);
+        }
+    }
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Lossless ADC Sample Compression
+ *
+ * Every channel of a block takes three passes over its samples: the sums
+ * of the mapped residuals of both predictors pick the predictor and the
+ * Rice parameter, the exact coded size of that choice decides against
+ * verbatim storage, and the last pass writes the bits. The bit string
+ * format is described in sample_codec.h.
+ */
+
+#include "sample_codec.h"
+
+#include <stdbool.h>
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Largest Rice parameter; a larger one never beats verbatim samples */
+#define SAMPLE_CODEC_MAX_K 15U
+
+/** Bits of a verbatim sample */
+#define SAMPLE_CODEC_SAMPLE_BITS 16U
+
+/** Bits of a channel mode */
+#define SAMPLE_CODEC_MODE_BITS 8U
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Bit string being written, most significant bit first
+ */
+typedef struct
+{
+    uint8_t *dst;   /**< Next byte */
+    uint32_t acc;   /**< Pending bits, right-aligned */
+    uint32_t count; /**< Pending bits, at most 7 between calls */
+} sample_codec_bits_t;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Append up to 24 bits
+ */
+static void put_bits(sample_codec_bits_t *bits, uint32_t value, uint32_t n)
+{
+    bits->acc = (bits->acc << n) | (value & ((1U << n) - 1U));
+    bits->count += n;
+
+    while (bits->count >= 8U)
+    {
+        bits->count -= 8U;
+        *bits->dst++ = (uint8_t)(bits->acc >> bits->count);
+    }
+}
+
+/**
+ * @brief Append a Rice code of parameter k
+ */
+static void put_rice(sample_codec_bits_t *bits, uint32_t u, uint32_t k)
+{
+    uint32_t zeros = u >> k;
+
+    while (zeros > 16U)
+    {
+        put_bits(bits, 0U, 16U);
+        zeros -= 16U;
+    }
+    put_bits(bits, 1U, zeros + 1U);
+    put_bits(bits, u, k);
+}
+
+/**
+ * @brief Map a residual to an unsigned value, small for small magnitudes
+ */
+static uint32_t zigzag(int32_t residual)
+{
+    return (residual >= 0) ? ((uint32_t)residual << 1U)
+                           : (((uint32_t)(-(residual + 1)) << 1U) | 1U);
+}
+
+/**
+ * @brief Residual of a sample with one channel's history
+ *
+ * The second-order predictor falls back to the first difference until two
+ * samples are known.
+ */
+static int32_t residual(const sample_codec_channel_t *state, bool order2,
+                        int32_t sample)
+{
+    if (order2 && (state->primed >= 2U))
+    {
+        return sample - ((2 * state->last[0]) - state->last[1]);
+    }
+
+    return sample - state->last[0];
+}
+
+/**
+ * @brief Add a sample to one channel's history
+ */
+static void remember(sample_codec_channel_t *state, int32_t sample)
+{
+    state->last[1] = state->last[0];
+    state->last[0] = sample;
+    if (state->primed < 2U)
+    {
+        state->primed++;
+    }
+}
+
+/**
+ * @brief Encode one channel of a block
+ */
+static void encode_channel(sample_codec_channel_t *state,
+                           const uint16_t *frames, uint32_t stride,
+                           uint32_t count, sample_codec_bits_t *bits)
+{
+    sample_codec_channel_t scan  = *state;
+    const uint32_t         first = (state->primed == 0U) ? 1U : 0U;
+    uint32_t               sum1  = 0U;
+    uint32_t               sum2  = 0U;
+    uint32_t               coded = count - first;
+    uint32_t               k     = 0U;
+    uint32_t               size;
+    bool                   order2;
+
+    if (first != 0U)
+    {
+        remember(&scan, (int32_t)frames[0]);
+    }
+
+    /* Mapped residual sums of both predictors */
+    for (uint32_t i = first; i < count; i++)
+    {
+        const int32_t sample = (int32_t)frames[i * stride];
+
+        sum1 += zigzag(residual(&scan, false, sample));
+        sum2 += zigzag(residual(&scan, true, sample));
+        remember(&scan, sample);
+    }
+
+    /* k = floor(log2(mean)) is within a fraction of a bit of the best */
+    order2 = (sum2 < sum1);
+    {
+        const uint32_t sum = order2 ? sum2 : sum1;
+
+        while ((coded > 0U) && (k < SAMPLE_CODEC_MAX_K) &&
+               ((coded << (k + 1U)) <= sum))
+        {
+            k++;
+        }
+    }
+
+    /* Exact size of the Rice coded channel */
+    scan = *state;
+    size = SAMPLE_CODEC_MODE_BITS + (first * SAMPLE_CODEC_SAMPLE_BITS) +
+           (coded * (k + 1U));
+    if (first != 0U)
+    {
+        remember(&scan, (int32_t)frames[0]);
+    }
+    for (uint32_t i = first; i < count; i++)
+    {
+        const int32_t sample = (int32_t)frames[i * stride];
+
+        size += zigzag(residual(&scan, order2, sample)) >> k;
+        remember(&scan, sample);
+    }
+
+    if (size >=
+        (SAMPLE_CODEC_MODE_BITS + (count * SAMPLE_CODEC_SAMPLE_BITS)))
+    {
+        put_bits(bits, SAMPLE_CODEC_MODE_VERBATIM, SAMPLE_CODEC_MODE_BITS);
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            put_bits(bits, frames[i * stride], SAMPLE_CODEC_SAMPLE_BITS);
+            remember(state, (int32_t)frames[i * stride]);
+        }
+        return;
+    }
+
+    put_bits(bits, (order2 ? SAMPLE_CODEC_MODE_ORDER2 : 0U) | k,
+             SAMPLE_CODEC_MODE_BITS);
+    if (first != 0U)
+    {
+        put_bits(bits, frames[0], SAMPLE_CODEC_SAMPLE_BITS);
+        remember(state, (int32_t)frames[0]);
+    }
+    for (uint32_t i = first; i < count; i++)
+    {
+        const int32_t sample = (int32_t)frames[i * stride];
+
+        put_rice(bits, zigzag(residual(state, order2, sample)), k);
+        remember(state, sample);
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void sample_codec_init(sample_codec_t *codec, uint8_t channels)
+{
+    for (uint32_t ch = 0U; ch < SAMPLE_CODEC_MAX_CHANNELS; ch++)
+    {
+        codec->channel[ch].last[0] = 0;
+        codec->channel[ch].last[1] = 0;
+        codec->channel[ch].primed  = 0U;
+    }
+    codec->channels = channels;
+}
+
+size_t sample_codec_encode(sample_codec_t *codec, const uint16_t *frames,
+                           uint32_t count, uint8_t *dst)
+{
+    sample_codec_bits_t bits = {.dst = dst, .acc = 0U, .count = 0U};
+
+    for (uint32_t ch = 0U; ch < codec->channels; ch++)
+    {
+        encode_channel(&codec->channel[ch], &frames[ch], codec->channels,
+                       count, &bits);
+    }
+
+    /* Pad to a whole byte */
+    if (bits.count > 0U)
+    {
+        put_bits(&bits, 0U, 8U - bits.count);
+    }
+
+    return (size_t)(bits.dst - dst);
+}
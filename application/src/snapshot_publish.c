@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Register Snapshot Multicast Task
+ *
+ * One task builds the datagram in a static buffer once per period and
+ * sends it. The blocks are read through the Modbus read callbacks, so live
+ * blocks (ADC readings) are refreshed exactly as for a Modbus read, and
+ * the register mutex is held over all of them, so no write is published
+ * in between. The wire format is described in snapshot_publish.h.
+ */
+
+#include "snapshot_publish.h"
+
+#if SNAPSHOT_PUBLISH
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bsp_sections.h"
+#include "jerry_device_registers.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "lwip/netbuf.h"
+#include "modbus.h"
+#include "modbus_callbacks.h"
+#include "task.h"
+#include "task_priorities.h"
+
+#ifndef JERRY_DEVICE_SNAPSHOT_BLOCK_COUNT
+#error "SNAPSHOT_PUBLISH needs a register group marked \"snapshot\""
+#endif
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the task (words) */
+#define SNAPSHOT_PUBLISH_STACK_SIZE 384U
+
+/** Datagram size: header and all blocks */
+#define SNAPSHOT_PUBLISH_SIZE \
+    (SNAPSHOT_PUBLISH_HEADER_SIZE + JERRY_DEVICE_SNAPSHOT_DATA_SIZE)
+
+_Static_assert(SNAPSHOT_PUBLISH_SIZE <= 1472U,
+               "a snapshot must fit one datagram");
+_Static_assert(JERRY_DEVICE_SNAPSHOT_BLOCK_COUNT <= 255U,
+               "the block count is one byte");
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task control block and stack */
+static StaticTask_t s_snapshot_task_tcb;
+static StackType_t  s_snapshot_task_stack[SNAPSHOT_PUBLISH_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** Publish task, notified on a new configuration */
+static TaskHandle_t s_snapshot_task;
+
+/** Register mutex owned by the Modbus TCP task */
+static SemaphoreHandle_t s_register_mutex;
+
+/** Configuration waiting to be applied by the publish task */
+static snapshot_publish_config_t s_pending_config = {
+    .rate_hz   = 0U,
+    .dest_addr = SNAPSHOT_PUBLISH_DEFAULT_GROUP,
+    .dest_port = SNAPSHOT_PUBLISH_DEFAULT_PORT,
+};
+
+/** Incremented on every snapshot_publish_set_config() call */
+static volatile uint32_t s_config_generation = 1U;
+
+/* Publish task only */
+static snapshot_publish_config_t s_config;     /**< Active configuration */
+static uint32_t                  s_generation; /**< Generation applied */
+static uint32_t                  s_sequence;   /**< Sequence of the next one */
+static struct netconn           *s_conn;       /**< UDP connection */
+static struct netbuf            *s_tx_buf;     /**< Carrier of the datagram */
+
+/** Datagram being built */
+static uint8_t s_datagram[SNAPSHOT_PUBLISH_SIZE];
+
+/** Values of the block being read, bits packed */
+static uint16_t s_values[JERRY_DEVICE_SNAPSHOT_DATA_SIZE / 2U];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Store a 16-bit value little-endian
+ */
+static void put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static void put_u32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+    dst[2] = (uint8_t)(value >> 16U);
+    dst[3] = (uint8_t)(value >> 24U);
+}
+
+/**
+ * @brief Read one block through the Modbus read callbacks into s_values
+ *
+ * Register mutex held by the caller.
+ *
+ * @return Bytes of values, padded to a whole word; 0 if the block failed
+ */
+static uint16_t snapshot_read_block(const jerry_device_snapshot_block_t *block)
+{
+    modbus_exception_t ex;
+    uint16_t           size;
+
+    switch (block->table)
+    {
+        case MODBUS_FC_READ_COILS:
+            ex = modbus_cb_read_coils(block->address, block->count,
+                                      (uint8_t *)s_values);
+            size = (uint16_t)(((block->count + 15U) / 16U) * 2U);
+            break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            ex = modbus_cb_read_discrete_inputs(block->address, block->count,
+                                                (uint8_t *)s_values);
+            size = (uint16_t)(((block->count + 15U) / 16U) * 2U);
+            break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+            ex = modbus_cb_read_holding_registers(block->address,
+                                                  block->count, s_values);
+            size = (uint16_t)(block->count * 2U);
+            break;
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            ex = modbus_cb_read_input_registers(block->address, block->count,
+                                                s_values);
+            size = (uint16_t)(block->count * 2U);
+            break;
+        default:
+            ex   = MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+            size = 0U;
+            break;
+    }
+
+    return (ex == MODBUS_EXCEPTION_NONE) ? size : 0U;
+}
+
+/**
+ * @brief Build the datagram into s_datagram
+ *
+ * @return Datagram length, 0 if a block could not be read
+ */
+static uint16_t snapshot_build(void)
+{
+    uint32_t uptime = (uint32_t)pdTICKS_TO_MS(xTaskGetTickCount());
+    uint16_t pos    = SNAPSHOT_PUBLISH_HEADER_SIZE;
+
+    put_u16(&s_datagram[0], SNAPSHOT_PUBLISH_MAGIC);
+    s_datagram[2] = (uint8_t)SNAPSHOT_PUBLISH_VERSION;
+    s_datagram[3] = (uint8_t)JERRY_DEVICE_SNAPSHOT_BLOCK_COUNT;
+    put_u32(&s_datagram[4], JERRY_DEVICE_SNAPSHOT_LAYOUT_ID);
+    put_u32(&s_datagram[8], s_sequence);
+    put_u32(&s_datagram[12], uptime);
+
+    (void)xSemaphoreTake(s_register_mutex, portMAX_DELAY);
+    for (uint32_t i = 0U; i < JERRY_DEVICE_SNAPSHOT_BLOCK_COUNT; i++)
+    {
+        const jerry_device_snapshot_block_t *block =
+            &jerry_device_snapshot_blocks[i];
+        uint8_t *dst = &s_datagram[pos + SNAPSHOT_PUBLISH_BLOCK_HEADER_SIZE];
+        uint16_t size;
+
+        (void)memset(s_values, 0, sizeof(s_values));
+        size = snapshot_read_block(block);
+        if (size == 0U)
+        {
+            pos = 0U;
+            break;
+        }
+
+        s_datagram[pos]      = block->table;
+        s_datagram[pos + 1U] = 0U;
+        put_u16(&s_datagram[pos + 2U], block->address);
+        put_u16(&s_datagram[pos + 4U], block->count);
+        if ((block->table == MODBUS_FC_READ_COILS) ||
+            (block->table == MODBUS_FC_READ_DISCRETE_INPUTS))
+        {
+            (void)memcpy(dst, s_values, size);
+        }
+        else
+        {
+            for (uint16_t w = 0U; w < block->count; w++)
+            {
+                put_u16(&dst[2U * w], s_values[w]);
+            }
+        }
+        pos = (uint16_t)(pos + SNAPSHOT_PUBLISH_BLOCK_HEADER_SIZE + size);
+    }
+    (void)xSemaphoreGive(s_register_mutex);
+
+    return pos;
+}
+
+/**
+ * @brief Send the datagram to the configured destination
+ */
+static void snapshot_send(uint16_t length)
+{
+    ip_addr_t dest;
+    void     *payload;
+
+    payload = netbuf_alloc(s_tx_buf, length);
+    if (payload == NULL)
+    {
+        return;
+    }
+
+    (void)memcpy(payload, s_datagram, length);
+    IP_ADDR4(&dest, (uint8_t)(s_config.dest_addr >> 24U),
+             (uint8_t)(s_config.dest_addr >> 16U),
+             (uint8_t)(s_config.dest_addr >> 8U), (uint8_t)s_config.dest_addr);
+    (void)netconn_sendto(s_conn, s_tx_buf, &dest, s_config.dest_port);
+    netbuf_free(s_tx_buf);
+    s_sequence++;
+}
+
+/**
+ * @brief Pick up a new configuration
+ *
+ * @return true if the configuration changed
+ */
+static bool snapshot_apply_config(void)
+{
+    uint32_t generation = s_config_generation;
+
+    if (generation == s_generation)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    generation = s_config_generation;
+    s_config   = s_pending_config;
+    taskEXIT_CRITICAL();
+
+    s_generation = generation;
+    return true;
+}
+
+/**
+ * @brief Snapshot publish task
+ */
+static void snapshot_publish_task(void *arg)
+{
+    TickType_t next = xTaskGetTickCount();
+
+    (void)arg;
+
+    while (((s_conn = netconn_new(NETCONN_UDP)) == NULL) ||
+           ((s_tx_buf = netbuf_new()) == NULL))
+    {
+        printf("Snapshot: Failed to create UDP connection\n");
+        if (s_conn != NULL)
+        {
+            netconn_delete(s_conn);
+        }
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    printf("Snapshot publish task started\n");
+
+    for (;;)
+    {
+        TickType_t now;
+        TickType_t period;
+
+        if (snapshot_apply_config())
+        {
+            next = xTaskGetTickCount();
+        }
+
+        if ((s_config.rate_hz == 0U) || (s_config.dest_addr == 0U) ||
+            (s_config.dest_port == 0U))
+        {
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        period = pdMS_TO_TICKS(1000U / s_config.rate_hz);
+        if (period == 0U)
+        {
+            period = 1U;
+        }
+
+        now = xTaskGetTickCount();
+        if ((int32_t)(now - next) >= 0)
+        {
+            uint16_t length = snapshot_build();
+
+            if (length != 0U)
+            {
+                snapshot_send(length);
+            }
+
+            /* A period missed entirely is skipped, not made up */
+            next += period;
+            if ((int32_t)(now - next) >= 0)
+            {
+                next = now + period;
+            }
+        }
+        else
+        {
+            (void)ulTaskNotifyTake(pdTRUE, next - now);
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void snapshot_publish_set_config(const snapshot_publish_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_pending_config = *config;
+    s_config_generation++;
+    taskEXIT_CRITICAL();
+
+    if (s_snapshot_task != NULL)
+    {
+        (void)xTaskNotifyGive(s_snapshot_task);
+    }
+}
+
+void snapshot_publish_start(SemaphoreHandle_t register_mutex)
+{
+    s_register_mutex = register_mutex;
+
+    s_snapshot_task = xTaskCreateStatic(
+        snapshot_publish_task, "SnapPub", SNAPSHOT_PUBLISH_STACK_SIZE, NULL,
+        TASK_PRIO_SNAPSHOT, s_snapshot_task_stack,
+        &s_snapshot_task_tcb);
+}
+
+#endif /* SNAPSHOT_PUBLISH */
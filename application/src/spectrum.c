@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Spectral Analysis
+ *
+ * The collector job fills the frame buffer from its own ring reader and
+ * hands it to the analysis task, which owns it until the figures are
+ * published. A gap in the sample sequence restarts the frame, so every
+ * frame is SPECTRUM_FFT_SIZE consecutive samples. See spectrum.h.
+ */
+
+#include "spectrum.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_coefficients.h"
+#include "app_tasks.h"
+#include "arm_math.h"
+#include "bsp.h"
+#include "metrics.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Bounds the analysis wait for a frame */
+#define SPECTRUM_IDLE_MS 100U
+
+/** Samples copied out of the ring per read, one ADC block */
+#define SPECTRUM_READ_CHUNK BSP_ADC1_BLOCK_SAMPLES
+
+/** ADC reference in mV */
+#define SPECTRUM_VREF_MV 3300.0f
+
+/** Scale of a raw result converted with arm_q15_to_float() to mV */
+#define SPECTRUM_RAW_TO_MV \
+    ((32768.0f * SPECTRUM_VREF_MV) / (float32_t)BSP_ADC1_FULL_SCALE)
+
+/** Register units per mV and per Hz */
+#define SPECTRUM_UNITS_PER_MV 10.0f
+#define SPECTRUM_UNITS_PER_HZ 10.0f
+
+/** Register units of a THD ratio of 1 */
+#define SPECTRUM_UNITS_PER_THD 10000.0f
+
+/** Largest register value */
+#define SPECTRUM_REGISTER_MAX 65535.0f
+
+/* Header record offsets (spectrum.h) */
+#define HDR_MAGIC       0U
+#define HDR_VERSION     1U
+#define HDR_SIZE        2U
+#define HDR_CHANNELS    3U
+#define HDR_FFT_SIZE    4U
+#define HDR_SAMPLE_RATE 5U
+#define HDR_FRAME       6U
+
+_Static_assert(SPECTRUM_HEADER_RECORDS == (HDR_FRAME + 2U),
+               "header records out of step with the layout");
+_Static_assert(SPECTRUM_FILE_RECORDS <= (MODBUS_FILE_MAX_RECORD + 1U),
+               "spectrum must fit one FC20 file");
+_Static_assert(ADC_FILTER_MAX_SAMPLE_RATE <= 0xFFFFU,
+               "sample rate must fit one record");
+_Static_assert(BSP_ADC1_FULL_SCALE <= 0x7FFFU,
+               "raw results are kept as q15 values");
+_Static_assert(SPECTRUM_MIN_BIN >= SPECTRUM_LOBE_BINS,
+               "fundamental lobe must not reach below bin 0");
+_Static_assert(SPECTRUM_FFT_SIZE == 1024U,
+               "FFT instance is set up with arm_rfft_fast_init_1024_f32()");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Collector job state
+ */
+typedef struct
+{
+    bsp_adc1_reader_t reader;        /**< Ring cursor */
+    bool              active;        /**< Reader attached, frame open */
+    uint32_t          fill;          /**< Samples in the frame */
+    uint32_t          next_sequence; /**< Sequence that continues the frame */
+} spectrum_collector_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+/** Channels to analyse, bit n for A<n> */
+static volatile uint16_t s_channels = 0U;
+
+/** Raw samples of one frame, per channel; owned by the analysis task while
+ * s_frame_full is set */
+static q15_t s_frame[BSP_ADC1_NUM_CHANNELS][SPECTRUM_FFT_SIZE];
+
+/** Set by the collector job when it hands the frame over */
+static atomic_bool s_frame_full;
+
+/** Analysis task, notified for every full frame */
+static TaskHandle_t volatile s_analyser = NULL;
+
+/** Samples copied out of the ring, kept off the executive stack */
+static bsp_adc1_sample_t s_chunk[SPECTRUM_READ_CHUNK];
+
+/** Hann window */
+static float32_t s_window[SPECTRUM_FFT_SIZE];
+
+/** Channel being analysed; the FFT input, overwritten by it */
+static float32_t s_input[SPECTRUM_FFT_SIZE];
+
+/** FFT output, packed as arm_rfft_fast_f32() leaves it */
+static float32_t s_output[SPECTRUM_FFT_SIZE];
+
+/** Bin magnitudes, then bin powers */
+static float32_t s_power[SPECTRUM_BINS];
+
+/** FFT instance */
+static arm_rfft_fast_instance_f32 s_fft;
+
+/** Spectrum file, header and bins, in FC20 records */
+static uint16_t s_file[SPECTRUM_FILE_RECORDS];
+
+/** Records of the spectrum file, 0 until the first frame */
+static volatile uint32_t s_file_records = 0U;
+
+/** Figures of the last frame, guarded by a critical section */
+static spectrum_result_t s_results[BSP_ADC1_NUM_CHANNELS];
+
+/** Number of the last frame, 0 if none */
+static uint32_t s_frame_number = 0U;
+
+/** Run after each frame, NULL for none */
+static spectrum_frame_hook_t volatile s_frame_hook = NULL;
+
+static spectrum_collector_t s_collector;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/* --------------------------------------------------------------------------
+ * Collection
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Hand the full frame to the analysis task
+ */
+static void spectrum_hand_over(spectrum_collector_t *collector)
+{
+    TaskHandle_t analyser = s_analyser;
+
+    atomic_store(&s_frame_full, true);
+    if (analyser != NULL)
+    {
+        (void)xTaskNotifyGive(analyser);
+    }
+
+    /* The next frame starts from fresh samples */
+    collector->active = false;
+}
+
+/**
+ * @brief Move the available ring samples into the frame
+ */
+static void spectrum_collect(spectrum_collector_t *collector)
+{
+    uint32_t count = 0U;
+
+    if (!collector->active)
+    {
+        (void)BSP_ADC1_RingReaderInit(&collector->reader, BSP_ADC1_STREAM_FULL);
+        collector->fill   = 0U;
+        collector->active = true;
+    }
+
+    do
+    {
+        uint32_t overruns = collector->reader.overruns;
+
+        if (BSP_ADC1_RingRead(&collector->reader, s_chunk,
+                              SPECTRUM_READ_CHUNK, &count) != BSP_OK)
+        {
+            return;
+        }
+        metrics_add(METRIC_ADC_OVERRUN, collector->reader.overruns - overruns);
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            const bsp_adc1_sample_t *sample = &s_chunk[i];
+
+            if ((collector->fill > 0U) &&
+                (sample->sequence != collector->next_sequence))
+            {
+                /* Samples lost: start the frame again */
+                collector->fill = 0U;
+            }
+            for (uint32_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+            {
+                s_frame[ch][collector->fill] = (q15_t)sample->raw[ch];
+            }
+            collector->next_sequence = sample->sequence + 1U;
+            collector->fill++;
+
+            if (collector->fill == SPECTRUM_FFT_SIZE)
+            {
+                spectrum_hand_over(collector);
+                return;
+            }
+        }
+    } while (count == SPECTRUM_READ_CHUNK);
+}
+
+/* --------------------------------------------------------------------------
+ * Analysis
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Scale a figure to a register value, rounded and saturated
+ */
+static uint16_t spectrum_register(float32_t value)
+{
+    if (!(value > 0.0f))
+    {
+        return 0U;
+    }
+    if (value >= SPECTRUM_REGISTER_MAX)
+    {
+        return (uint16_t)SPECTRUM_REGISTER_MAX;
+    }
+    return (uint16_t)(value + 0.5f);
+}
+
+/**
+ * @brief Sum the power of the Hann main lobe around a bin
+ *
+ * @param[in]  bin      Centre bin, at least SPECTRUM_LOBE_BINS
+ * @param[out] centroid Power centroid of the lobe in bins, or NULL
+ * @return Lobe power
+ */
+static float32_t spectrum_lobe(uint32_t bin, float32_t *centroid)
+{
+    uint32_t  last   = bin + SPECTRUM_LOBE_BINS;
+    float32_t power  = 0.0f;
+    float32_t moment = 0.0f;
+
+    if (last >= SPECTRUM_BINS)
+    {
+        last = SPECTRUM_BINS - 1U;
+    }
+
+    for (uint32_t k = bin - SPECTRUM_LOBE_BINS; k <= last; k++)
+    {
+        power += s_power[k];
+        moment += (float32_t)k * s_power[k];
+    }
+
+    if (centroid != NULL)
+    {
+        *centroid = (power > 0.0f) ? (moment / power) : (float32_t)bin;
+    }
+    return power;
+}
+
+/**
+ * @brief Analyse one channel of the frame
+ *
+ * A sine of amplitude A centred on a bin gives a magnitude of A N / 4
+ * there, and A^2 N^2 3 / 32 summed over the power of its main lobe.
+ *
+ * @param[in]  channel ADC1 channel
+ * @param[out] result  Figures of the channel
+ * @param[out] bins    SPECTRUM_BINS amplitude records of the channel
+ */
+static void spectrum_analyse(uint8_t channel, spectrum_result_t *result,
+                             uint16_t *bins)
+{
+    float32_t mean;
+    float32_t rms;
+    float32_t peak;
+    float32_t power;
+    float32_t centroid;
+    float32_t fundamental;
+    float32_t amplitude;
+    float32_t harmonics = 0.0f;
+    float32_t thd;
+    uint32_t  index;
+
+    /* Time domain: mean, then RMS and peak of what is left */
+    arm_q15_to_float(s_frame[channel], s_input, SPECTRUM_FFT_SIZE);
+    arm_scale_f32(s_input, SPECTRUM_RAW_TO_MV, s_input, SPECTRUM_FFT_SIZE);
+    arm_mean_f32(s_input, SPECTRUM_FFT_SIZE, &mean);
+    arm_offset_f32(s_input, -mean, s_input, SPECTRUM_FFT_SIZE);
+    arm_rms_f32(s_input, SPECTRUM_FFT_SIZE, &rms);
+    arm_absmax_f32(s_input, SPECTRUM_FFT_SIZE, &peak, &index);
+
+    result->mean = spectrum_register(mean * SPECTRUM_UNITS_PER_MV);
+    result->rms  = spectrum_register(rms * SPECTRUM_UNITS_PER_MV);
+    result->peak = spectrum_register(peak * SPECTRUM_UNITS_PER_MV);
+
+    /* Windowed spectrum; the packed Nyquist term is left out */
+    arm_mult_f32(s_input, s_window, s_input, SPECTRUM_FFT_SIZE);
+    arm_rfft_fast_f32(&s_fft, s_input, s_output, 0U);
+    s_output[1] = 0.0f;
+    arm_cmplx_mag_f32(s_output, s_power, SPECTRUM_BINS);
+
+    for (uint32_t k = 0U; k < SPECTRUM_BINS; k++)
+    {
+        bins[k] = spectrum_register(
+            s_power[k] *
+            ((4.0f * SPECTRUM_UNITS_PER_MV) / (float32_t)SPECTRUM_FFT_SIZE));
+    }
+
+    /* Fundamental and harmonics on the bin powers */
+    arm_mult_f32(s_power, s_power, s_power, SPECTRUM_BINS);
+    arm_max_f32(&s_power[SPECTRUM_MIN_BIN], SPECTRUM_BINS - SPECTRUM_MIN_BIN,
+                &power, &index);
+    fundamental = spectrum_lobe(index + SPECTRUM_MIN_BIN, &centroid);
+    (void)arm_sqrt_f32((fundamental * 2.0f) / 3.0f, &amplitude);
+    amplitude = (amplitude * 4.0f) / (float32_t)SPECTRUM_FFT_SIZE;
+
+    if (amplitude < SPECTRUM_MIN_AMPLITUDE_MV)
+    {
+        result->frequency = 0U;
+        result->amplitude = 0U;
+        result->thd       = 0U;
+        return;
+    }
+
+    for (uint32_t h = 2U; h <= SPECTRUM_HARMONICS; h++)
+    {
+        uint32_t bin = (uint32_t)((centroid * (float32_t)h) + 0.5f);
+
+        if ((bin + SPECTRUM_LOBE_BINS) >= SPECTRUM_BINS)
+        {
+            break;
+        }
+        harmonics += spectrum_lobe(bin, NULL);
+    }
+    (void)arm_sqrt_f32(harmonics / fundamental, &thd);
+
+    result->frequency = spectrum_register(
+        ((centroid * (float32_t)BSP_ADC1_GetSampleRate()) /
+         (float32_t)SPECTRUM_FFT_SIZE) *
+        SPECTRUM_UNITS_PER_HZ);
+    result->amplitude = spectrum_register(amplitude * SPECTRUM_UNITS_PER_MV);
+    result->thd       = spectrum_register(thd * SPECTRUM_UNITS_PER_THD);
+}
+
+/**
+ * @brief Analyse the frame, publish the figures and the spectrum file and
+ * run the frame hook
+ */
+static void spectrum_process(void)
+{
+    uint16_t              channels = s_channels & SPECTRUM_ALL_CHANNELS;
+    uint32_t              number   = s_frame_number + 1U;
+    spectrum_result_t     results[BSP_ADC1_NUM_CHANNELS];
+    spectrum_frame_hook_t hook;
+
+    (void)memset(results, 0, sizeof(results));
+
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        uint16_t *bins =
+            &s_file[SPECTRUM_HEADER_RECORDS + ((uint32_t)ch * SPECTRUM_BINS)];
+
+        if ((channels & (1U << ch)) != 0U)
+        {
+            spectrum_analyse(ch, &results[ch], bins);
+        }
+        else
+        {
+            (void)memset(bins, 0, SPECTRUM_BINS * sizeof(bins[0]));
+        }
+    }
+
+    s_file[HDR_MAGIC]       = (uint16_t)SPECTRUM_MAGIC;
+    s_file[HDR_VERSION]     = (uint16_t)SPECTRUM_VERSION;
+    s_file[HDR_SIZE]        = (uint16_t)SPECTRUM_HEADER_RECORDS;
+    s_file[HDR_CHANNELS]    = channels;
+    s_file[HDR_FFT_SIZE]    = (uint16_t)SPECTRUM_FFT_SIZE;
+    s_file[HDR_SAMPLE_RATE] = (uint16_t)BSP_ADC1_GetSampleRate();
+    s_file[HDR_FRAME]       = (uint16_t)(number >> 16U);
+    s_file[HDR_FRAME + 1U]  = (uint16_t)(number & 0xFFFFU);
+    s_file_records          = SPECTRUM_FILE_RECORDS;
+
+    taskENTER_CRITICAL();
+    (void)memcpy(s_results, results, sizeof(s_results));
+    s_frame_number = number;
+    taskEXIT_CRITICAL();
+
+    hook = s_frame_hook;
+    if (hook != NULL)
+    {
+        hook(channels, &s_file[SPECTRUM_HEADER_RECORDS], results);
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void spectrum_set_frame_hook(spectrum_frame_hook_t hook)
+{
+    s_frame_hook = hook;
+}
+
+void spectrum_set_channels(uint16_t mask)
+{
+    s_channels = (uint16_t)(mask & SPECTRUM_ALL_CHANNELS);
+}
+
+uint32_t spectrum_get_results(spectrum_result_t *results)
+{
+    uint32_t number;
+
+    if (results == NULL)
+    {
+        return s_frame_number;
+    }
+
+    taskENTER_CRITICAL();
+    (void)memcpy(results, s_results, sizeof(s_results));
+    number = s_frame_number;
+    taskEXIT_CRITICAL();
+
+    return number;
+}
+
+modbus_exception_t spectrum_read_file_record(uint16_t  file_number,
+                                             uint16_t  record_number,
+                                             uint16_t  record_length,
+                                             uint16_t *values)
+{
+    if ((file_number != SPECTRUM_FILE_NUMBER) ||
+        (((uint32_t)record_number + record_length) > s_file_records))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    (void)memcpy(values, &s_file[record_number],
+                 (size_t)record_length * sizeof(values[0]));
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief Spectrum collector job, run by the cyclic executive
+ */
+void spectrum_collect_job(void)
+{
+    spectrum_collector_t *collector = &s_collector;
+
+    if (s_channels == 0U)
+    {
+        collector->active = false;
+    }
+    /* While the frame is analysed there is nothing to collect */
+    else if (!atomic_load(&s_frame_full))
+    {
+        spectrum_collect(collector);
+    }
+}
+
+/**
+ * @brief Spectrum analysis task
+ */
+void vSpectrumTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    if (arm_rfft_fast_init_1024_f32(&s_fft) != ARM_MATH_SUCCESS)
+    {
+        printf("Spectrum: FFT setup failed\n");
+        vTaskDelete(NULL);
+    }
+
+    /* Periodic Hann window */
+    for (uint32_t n = 0U; n < SPECTRUM_FFT_SIZE; n++)
+    {
+        s_window[n] = 0.5f - (0.5f * arm_cos_f32(
+                                         (2.0f * PI * (float32_t)n) /
+                                         (float32_t)SPECTRUM_FFT_SIZE));
+    }
+
+    s_analyser = xTaskGetCurrentTaskHandle();
+
+    printf("Spectrum task started\n");
+
+    for (;;)
+    {
+        /* The timeout picks up a frame handed over before the handle was
+         * published */
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SPECTRUM_IDLE_MS));
+
+        if (atomic_load(&s_frame_full))
+        {
+            spectrum_process();
+            atomic_store(&s_frame_full, false);
+        }
+    }
+}
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Task Deadline Supervisor
+ *
+ * An entry is filled in before the count of entries covers it, so the
+ * supervisor and the monitor only ever read complete entries. The state
+ * of an entry is changed by its task and by the supervisor, each with the
+ * kernel interrupts masked for a few loads and stores; the late flag makes
+ * sure a miss is counted once, by whichever of the two sees it first. The
+ * log and the metric are written after the critical section. See
+ * supervisor.h.
+ */
+
+#include "supervisor.h"
+
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "bsp_sections.h"
+#include "log.h"
+#include "metrics.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the task (words) */
+#define SUPERVISOR_STACK_SIZE 256U
+
+_Static_assert(SUPERVISOR_WATCHDOG_MS <= BSP_WATCHDOG_MAX_TIMEOUT_MS,
+               "the watchdog timeout is out of range");
+_Static_assert(SUPERVISOR_WATCHDOG_MS >= (4U * SUPERVISOR_CHECK_MS),
+               "the watchdog must outlast several checks");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Entry of the task table
+ */
+typedef struct
+{
+    const char *name;      /**< Task name */
+    uint32_t    period_ms; /**< Period of the check-ins */
+    TickType_t  deadline;  /**< Longest gap before a miss */
+    TickType_t  last;      /**< Tick of the last check-in */
+    TickType_t  last_miss; /**< Tick of the last miss */
+    TickType_t  max_gap;   /**< Longest gap between two check-ins */
+    uint32_t    checkins;  /**< Check-ins since registration */
+    uint32_t    misses;    /**< Deadlines missed */
+    bool        late;      /**< Miss counted, no check-in since */
+    bool        idle;      /**< Not supervised until the next check-in */
+} supervisor_entry_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task control block and stack */
+static StaticTask_t s_supervisor_task_tcb;
+static StackType_t  s_supervisor_task_stack[SUPERVISOR_STACK_SIZE]
+    BSP_SECTION_STACK;
+
+/** Registered tasks */
+static supervisor_entry_t s_entries[SUPERVISOR_MAX_TASKS];
+
+/** Entries registered */
+static volatile uint32_t s_count;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Count a miss, with interrupts masked
+ */
+static void supervisor_count_miss(supervisor_entry_t *entry, TickType_t now)
+{
+    entry->misses++;
+    entry->last_miss = now;
+}
+
+/**
+ * @brief Report a miss, outside the critical section
+ */
+static void supervisor_report_miss(const supervisor_entry_t *entry,
+                                   TickType_t               gap)
+{
+    metrics_add(METRIC_DEADLINE_MISS, 1U);
+    LOG("Supervisor: %s missed its %lu ms deadline (%lu ms)\n", entry->name,
+        (unsigned long)pdTICKS_TO_MS(entry->deadline),
+        (unsigned long)pdTICKS_TO_MS(gap));
+}
+
+/**
+ * @brief Check every task for an overdue check-in
+ *
+ * @param[in] now Tick count
+ * @return true if no task is late
+ */
+static bool supervisor_check(TickType_t now)
+{
+    uint32_t count   = s_count;
+    bool     healthy = true;
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        supervisor_entry_t *entry = &s_entries[i];
+        TickType_t          gap;
+        bool                missed = false;
+
+        taskENTER_CRITICAL();
+        gap = now - entry->last;
+        if (!entry->idle && !entry->late && (gap > entry->deadline))
+        {
+            entry->late = true;
+            supervisor_count_miss(entry, now);
+            missed = true;
+        }
+        if (entry->late && !entry->idle)
+        {
+            healthy = false;
+        }
+        taskEXIT_CRITICAL();
+
+        if (missed)
+        {
+            supervisor_report_miss(entry, gap);
+        }
+    }
+
+    return healthy;
+}
+
+/**
+ * @brief Supervisor task
+ */
+static void supervisor_task(void *pvParameters)
+{
+    TickType_t wake     = xTaskGetTickCount();
+    bool       reloaded = true;
+
+    (void)pvParameters;
+
+    if (BSP_Watchdog_CausedReset())
+    {
+        LOG("Supervisor: the last reset was the watchdog\n");
+    }
+
+    for (;;)
+    {
+        bool healthy;
+
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(SUPERVISOR_CHECK_MS));
+
+        healthy = supervisor_check(xTaskGetTickCount());
+        if (healthy)
+        {
+            BSP_Watchdog_Kick();
+        }
+
+        /* Once per change, the misses themselves name the tasks */
+        if (healthy != reloaded)
+        {
+            if (healthy)
+            {
+                LOG("Supervisor: all tasks on time, watchdog reloaded\n");
+            }
+            else
+            {
+                LOG("Supervisor: task late, watchdog reset in %lu ms\n",
+                    (unsigned long)SUPERVISOR_WATCHDOG_MS);
+            }
+            reloaded = healthy;
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+supervisor_id_t supervisor_register(const char *name, uint32_t period_ms,
+                                    uint32_t deadline_ms)
+{
+    supervisor_id_t id = SUPERVISOR_INVALID_ID;
+
+    configASSERT(deadline_ms >= period_ms);
+
+    taskENTER_CRITICAL();
+    if (s_count < SUPERVISOR_MAX_TASKS)
+    {
+        supervisor_entry_t *entry = &s_entries[s_count];
+
+        entry->name      = name;
+        entry->period_ms = period_ms;
+        entry->deadline  = pdMS_TO_TICKS(deadline_ms);
+        entry->last      = xTaskGetTickCount();
+        entry->last_miss = 0U;
+        entry->max_gap   = 0U;
+        entry->checkins  = 0U;
+        entry->misses    = 0U;
+        entry->late      = false;
+        entry->idle      = false;
+
+        id = (supervisor_id_t)s_count;
+        s_count++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (id == SUPERVISOR_INVALID_ID)
+    {
+        printf("Supervisor: table full, %s not supervised\n", name);
+    }
+
+    return id;
+}
+
+void supervisor_checkin(supervisor_id_t id)
+{
+    supervisor_entry_t *entry;
+    TickType_t          now;
+    TickType_t          gap;
+    bool                missed;
+
+    if (id >= s_count)
+    {
+        return;
+    }
+
+    entry = &s_entries[id];
+    now   = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    /* The time spent idle is no gap */
+    gap = entry->idle ? 0U : (now - entry->last);
+
+    missed = !entry->late && (gap > entry->deadline);
+    if (missed)
+    {
+        supervisor_count_miss(entry, now);
+    }
+    if (gap > entry->max_gap)
+    {
+        entry->max_gap = gap;
+    }
+    entry->last = now;
+    entry->late = false;
+    entry->idle = false;
+    entry->checkins++;
+    taskEXIT_CRITICAL();
+
+    if (missed)
+    {
+        supervisor_report_miss(entry, gap);
+    }
+}
+
+void supervisor_idle(supervisor_id_t id)
+{
+    if (id >= s_count)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_entries[id].idle = true;
+    s_entries[id].late = false;
+    taskEXIT_CRITICAL();
+}
+
+bool supervisor_get_stats(uint32_t index, supervisor_stats_t *stats)
+{
+    const supervisor_entry_t *entry;
+
+    if (index >= s_count)
+    {
+        return false;
+    }
+
+    entry = &s_entries[index];
+
+    taskENTER_CRITICAL();
+    stats->name         = entry->name;
+    stats->period_ms    = entry->period_ms;
+    stats->deadline_ms  = (uint32_t)pdTICKS_TO_MS(entry->deadline);
+    stats->checkins     = entry->checkins;
+    stats->misses       = entry->misses;
+    stats->max_gap_ms   = (uint32_t)pdTICKS_TO_MS(entry->max_gap);
+    stats->last_miss_ms = (entry->misses != 0U)
+                              ? (uint32_t)pdTICKS_TO_MS(entry->last_miss)
+                              : 0U;
+    stats->late         = entry->late;
+    stats->idle         = entry->idle;
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+void supervisor_print(void)
+{
+    supervisor_stats_t stats;
+
+    (void)printf("\n=== Task Deadlines ===\n");
+    (void)printf("Task         Period(ms) Deadline(ms)   Check-ins  Misses  "
+                 "MaxGap(ms)  LastMiss(ms)\n");
+    (void)printf("------------------------------------------------------------"
+                 "------------------------\n");
+    for (uint32_t i = 0U; supervisor_get_stats(i, &stats); i++)
+    {
+        (void)printf("%-12s %10lu %12lu %11lu %7lu %11lu %13lu%s\n",
+                     stats.name, (unsigned long)stats.period_ms,
+                     (unsigned long)stats.deadline_ms,
+                     (unsigned long)stats.checkins,
+                     (unsigned long)stats.misses,
+                     (unsigned long)stats.max_gap_ms,
+                     (unsigned long)stats.last_miss_ms,
+                     stats.late ? "  LATE" : (stats.idle ? "  idle" : ""));
+    }
+    (void)printf("============================================================"
+                 "========================\n\n");
+}
+
+void supervisor_start(void)
+{
+    /* From here on, the MCU resets unless the supervisor reloads it */
+    if (BSP_Watchdog_Start(SUPERVISOR_WATCHDOG_MS) != BSP_OK)
+    {
+        printf("Supervisor: watchdog did not start\n");
+    }
+
+    (void)xTaskCreateStatic(supervisor_task, "Supervisor",
+                            SUPERVISOR_STACK_SIZE, NULL, TASK_PRIO_SUPERVISOR,
+                            s_supervisor_task_stack, &s_supervisor_task_tcb);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Task Priority Map
+ *
+ * The assertion table names every task the firmware can run. Tasks that
+ * only some builds create (the RTU slave or the gateway port) are checked
+ * when present. The base priority is compared, so a task holding a mutex
+ * with a raised priority does not trip the check.
+ */
+
+#include "task_priorities.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Tasks the check can list */
+#define TASK_PRIORITIES_MAX_TASKS 48U
+
+/**
+ * @brief Expected priority of a task
+ */
+typedef struct
+{
+    const char *name;     /**< Task name, or name prefix */
+    bool        prefix;   /**< Match every task whose name starts so */
+    UBaseType_t priority; /**< Expected base priority */
+} task_priority_entry_t;
+
+static const task_priority_entry_t s_priority_map[] = {
+    {"AdcFilter", false, TASK_PRIO_ADC_FILTER},
+    {"SpiAdc", false, TASK_PRIO_SPI_ADC},
+    {"EthIf", false, TASK_PRIO_ETHIF},
+    {configTIMER_SERVICE_TASK_NAME, false, TASK_PRIO_TIMER},
+    {"DoSched", false, TASK_PRIO_DO_SCHEDULE},
+    {"Supervisor", false, TASK_PRIO_SUPERVISOR},
+    {"AdcStream", false, TASK_PRIO_ADC_STREAM},
+    {"Cyclic", false, TASK_PRIO_CYCLIC},
+    {"UsbLog", false, TASK_PRIO_USB_LOG},
+    {"UsbStream", false, TASK_PRIO_USB_STREAM},
+    {"ModbusRTU", false, TASK_PRIO_RS485},
+    {"GwRS485", false, TASK_PRIO_RS485},
+    {"tcpip_thread", false, TASK_PRIO_TCPIP},
+    {"Ethernet", false, TASK_PRIO_ETHERNET},
+    {"Modbus", false, TASK_PRIO_MODBUS_TCP},
+    {"ModbusW", true, TASK_PRIO_MODBUS_TCP},
+    {"ModbusTLS", false, TASK_PRIO_MODBUS_TCP},
+    {"Network", false, TASK_PRIO_NETWORK},
+    {"UsbWrite", false, TASK_PRIO_USB_WRITE},
+    {"Ptp", false, TASK_PRIO_PTP},
+    {"ModbusRBE", false, TASK_PRIO_MODBUS_RBE},
+    {"SnapPub", false, TASK_PRIO_SNAPSHOT},
+    {"NorWrite", false, TASK_PRIO_NOR_WRITE},
+    {"WsPush", false, TASK_PRIO_WS_PUSH},
+    {"Mqtt", false, TASK_PRIO_MQTT},
+    {"OpcUa", false, TASK_PRIO_OPCUA},
+    {"Log", false, TASK_PRIO_LOG},
+    {"Trace", false, TASK_PRIO_TRACE},
+    {"Config", false, TASK_PRIO_CONFIG},
+    {"Profile", false, TASK_PRIO_PROFILE},
+    {"MbCapture", false, TASK_PRIO_MB_CAPTURE},
+    {"Main", false, TASK_PRIO_BACKGROUND},
+    {"Fota", false, TASK_PRIO_BACKGROUND},
+    {"Monitor", false, TASK_PRIO_BACKGROUND},
+    {"NorFill", false, TASK_PRIO_BACKGROUND},
+    {"ArchWrite", false, TASK_PRIO_BACKGROUND},
+    {"Spectrum", false, TASK_PRIO_SPECTRUM},
+    {configIDLE_TASK_NAME, false, tskIDLE_PRIORITY},
+};
+
+#define TASK_PRIORITY_MAP_SIZE \
+    (sizeof(s_priority_map) / sizeof(s_priority_map[0]))
+
+/** Task states read by the check (Main task only) */
+static TaskStatus_t s_task_status[TASK_PRIORITIES_MAX_TASKS];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Map entry of a task
+ * @return The entry, or NULL for a task missing from the map
+ */
+static const task_priority_entry_t *task_priority_lookup(const char *name)
+{
+    for (size_t i = 0U; i < TASK_PRIORITY_MAP_SIZE; i++)
+    {
+        const task_priority_entry_t *entry = &s_priority_map[i];
+
+        if (entry->prefix ? (strncmp(name, entry->name, strlen(entry->name)) ==
+                             0)
+                          : (strcmp(name, entry->name) == 0))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void task_priorities_check(void)
+{
+    UBaseType_t count =
+        uxTaskGetSystemState(s_task_status, TASK_PRIORITIES_MAX_TASKS, NULL);
+    bool ok = (count > 0U);
+
+    if (!ok)
+    {
+        (void)printf("Priority check: more than %u tasks\n",
+                     (unsigned int)TASK_PRIORITIES_MAX_TASKS);
+    }
+
+    for (UBaseType_t i = 0U; i < count; i++)
+    {
+        const TaskStatus_t          *task  = &s_task_status[i];
+        const task_priority_entry_t *entry = task_priority_lookup(
+            task->pcTaskName);
+
+        if (entry == NULL)
+        {
+            (void)printf("Task %s: not in the priority map\n",
+                         task->pcTaskName);
+            ok = false;
+        }
+        else if (task->uxBasePriority != entry->priority)
+        {
+            (void)printf("Task %s: priority %u, map says %u\n",
+                         task->pcTaskName, (unsigned int)task->uxBasePriority,
+                         (unsigned int)entry->priority);
+            ok = false;
+        }
+        else
+        {
+            /* As mapped */
+        }
+    }
+
+    configASSERT(ok);
+}
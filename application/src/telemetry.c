@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Binary Telemetry
+ *
+ * The frame is built in place in one static buffer by the monitor task,
+ * which FC20 reads serve from and the UDP datagram is copied out of. Each
+ * section is written after its header and dropped again if it overflowed,
+ * so one section too many costs the frame only that section. The wire
+ * format is described in telemetry.h.
+ */
+
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bsp.h"
+#include "cpu_load.h"
+#include "ethernetif.h"
+#include "lwip/api.h"
+#include "lwip/memp.h"
+#include "lwip/netbuf.h"
+#include "lwip/priv/memp_priv.h"
+#include "lwip/stats.h"
+#include "lwip/sys.h"
+#include "metrics.h"
+#include "modbus.h"
+#include "modbus_diag.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Cursor over the frame being built
+ */
+typedef struct
+{
+    uint16_t pos;      /**< Next byte to write */
+    uint16_t limit;    /**< End of the space for sections */
+    uint16_t section;  /**< Start of the open section */
+    uint8_t  count;    /**< Sections written */
+    bool     overflow; /**< The open section did not fit */
+} telemetry_writer_t;
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Section header size: ID, entries, body length */
+#define TELEMETRY_SECTION_HEADER_SIZE 4U
+
+/** Last frame built, read by the FC20 reader from the Modbus tasks */
+static uint8_t s_frame[TELEMETRY_MAX_FRAME_SIZE];
+
+/** Length of the last frame, 0 until the first one is built */
+static volatile uint16_t s_frame_length;
+
+/** Configuration waiting to be applied by the monitor task */
+static telemetry_config_t s_pending_config = {
+    .period_s  = TELEMETRY_DEFAULT_PERIOD_S,
+    .dest_addr = 0U,
+    .dest_port = TELEMETRY_DEFAULT_PORT,
+};
+
+/** Incremented on every telemetry_set_config() call */
+static volatile uint32_t s_config_generation = 1U;
+
+/* Monitor task only */
+static telemetry_config_t s_config;     /**< Active configuration */
+static uint32_t           s_generation; /**< Generation applied */
+static uint32_t           s_sequence;   /**< Sequence of the next frame */
+static TickType_t         s_last_frame; /**< Tick of the last frame */
+static struct netconn    *s_conn;       /**< UDP connection */
+static struct netbuf     *s_buf;        /**< Carrier of the datagram */
+
+/** CPU loads of the last window, kept off the monitor stack */
+static cpu_load_snapshot_t s_cpu_snapshot;
+
+/** Tick of the last read of the cache monitors */
+static TickType_t s_icache_tick;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Reserve bytes of the open section
+ *
+ * @return Where to write them, NULL once the section overflowed
+ */
+static uint8_t *put_bytes(telemetry_writer_t *w, uint16_t size)
+{
+    uint8_t *dst = NULL;
+
+    if (!w->overflow && ((uint32_t)w->pos + size <= w->limit))
+    {
+        dst    = &s_frame[w->pos];
+        w->pos = (uint16_t)(w->pos + size);
+    }
+    else
+    {
+        w->overflow = true;
+    }
+
+    return dst;
+}
+
+/**
+ * @brief Store a byte
+ */
+static void put_u8(telemetry_writer_t *w, uint8_t value)
+{
+    uint8_t *dst = put_bytes(w, 1U);
+
+    if (dst != NULL)
+    {
+        dst[0] = value;
+    }
+}
+
+/**
+ * @brief Store a 16-bit value little-endian
+ */
+static void put_u16(telemetry_writer_t *w, uint16_t value)
+{
+    uint8_t *dst = put_bytes(w, 2U);
+
+    if (dst != NULL)
+    {
+        dst[0] = (uint8_t)value;
+        dst[1] = (uint8_t)(value >> 8U);
+    }
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static void put_u32(telemetry_writer_t *w, uint32_t value)
+{
+    uint8_t *dst = put_bytes(w, 4U);
+
+    if (dst != NULL)
+    {
+        dst[0] = (uint8_t)value;
+        dst[1] = (uint8_t)(value >> 8U);
+        dst[2] = (uint8_t)(value >> 16U);
+        dst[3] = (uint8_t)(value >> 24U);
+    }
+}
+
+/**
+ * @brief Store a name, truncated or NUL padded to TELEMETRY_NAME_SIZE
+ */
+static void put_name(telemetry_writer_t *w, const char *name)
+{
+    uint8_t *dst = put_bytes(w, TELEMETRY_NAME_SIZE);
+
+    if (dst != NULL)
+    {
+        (void)memset(dst, 0, TELEMETRY_NAME_SIZE);
+        if (name != NULL)
+        {
+            (void)strncpy((char *)dst, name, TELEMETRY_NAME_SIZE);
+        }
+    }
+}
+
+/**
+ * @brief Open a section
+ */
+static void section_begin(telemetry_writer_t *w, telemetry_section_t id)
+{
+    w->section  = w->pos;
+    w->overflow = false;
+    put_u8(w, (uint8_t)id);
+    put_u8(w, 0U);
+    put_u16(w, 0U);
+}
+
+/**
+ * @brief Close a section, or drop it if it overflowed
+ *
+ * @param entries Entries written
+ */
+static void section_end(telemetry_writer_t *w, uint8_t entries)
+{
+    uint16_t body =
+        (uint16_t)(w->pos - w->section - TELEMETRY_SECTION_HEADER_SIZE);
+
+    if (w->overflow || (entries == 0U))
+    {
+        w->pos      = w->section;
+        w->overflow = false;
+        return;
+    }
+
+    s_frame[w->section + 1U] = entries;
+    s_frame[w->section + 2U] = (uint8_t)body;
+    s_frame[w->section + 3U] = (uint8_t)(body >> 8U);
+    w->count++;
+}
+
+/**
+ * @brief lwIP heap and pool sections, with the profile of LWIP_PROFILE
+ */
+static void put_lwip(telemetry_writer_t *w)
+{
+#if LWIP_STATS && MEM_STATS
+    section_begin(w, TELEMETRY_SECTION_LWIP_MEM);
+    put_u32(w, (uint32_t)lwip_stats.mem.avail);
+    put_u32(w, (uint32_t)lwip_stats.mem.used);
+    put_u32(w, (uint32_t)lwip_stats.mem.max);
+    put_u32(w, (uint32_t)lwip_stats.mem.err);
+    section_end(w, 1U);
+#endif
+
+#if LWIP_STATS && MEMP_STATS
+    uint8_t pools = 0U;
+
+    section_begin(w, TELEMETRY_SECTION_LWIP_MEMP);
+    for (uint32_t i = 0U; i < (uint32_t)MEMP_MAX; i++)
+    {
+        const struct stats_mem *pool = lwip_stats.memp[i];
+
+        if (pool == NULL)
+        {
+            continue;
+        }
+
+#if defined(LWIP_DEBUG) || LWIP_STATS_DISPLAY
+        put_name(w, pool->name);
+#else
+        put_name(w, NULL);
+#endif
+        put_u16(w, (uint16_t)pool->avail);
+        put_u16(w, (uint16_t)pool->used);
+        put_u16(w, (uint16_t)pool->max);
+        put_u16(w, (uint16_t)pool->err);
+        pools++;
+    }
+    section_end(w, pools);
+
+#if LWIP_PROFILE
+    pools = 0U;
+    section_begin(w, TELEMETRY_SECTION_LWIP_SIZES);
+    for (uint32_t i = 0U; i < (uint32_t)MEMP_MAX; i++)
+    {
+        if (lwip_stats.memp[i] == NULL)
+        {
+            continue;
+        }
+
+        put_u16(w, (uint16_t)(MEMP_SIZE +
+                              MEMP_ALIGN_SIZE(memp_pools[i]->size)));
+        pools++;
+    }
+    section_end(w, pools);
+#endif
+#endif
+
+#if LWIP_PROFILE
+    sys_arch_pool_stats_t sys_pool;
+    uint8_t               sys_pools = 0U;
+
+    section_begin(w, TELEMETRY_SECTION_SYS_POOLS);
+    while (sys_arch_pool_stats(sys_pools, &sys_pool) == 0)
+    {
+        put_name(w, sys_pool.name);
+        put_u16(w, sys_pool.size);
+        put_u16(w, sys_pool.count);
+        put_u16(w, sys_pool.depth);
+        put_u16(w, sys_pool.used);
+        put_u16(w, sys_pool.max_used);
+        put_u16(w, sys_pool.err);
+        put_u16(w, sys_pool.max_fill);
+        put_u16(w, sys_pool.full);
+        sys_pools++;
+    }
+    section_end(w, sys_pools);
+#endif
+
+#if LWIP_STATS && LINK_STATS
+    section_begin(w, TELEMETRY_SECTION_LINK);
+    put_u32(w, (uint32_t)lwip_stats.link.recv);
+    put_u32(w, (uint32_t)lwip_stats.link.xmit);
+    put_u32(w, (uint32_t)lwip_stats.link.drop);
+    put_u32(w, ethernetif_get_rx_int_count());
+    section_end(w, 1U);
+#endif
+}
+
+/**
+ * @brief CPU load and task sections, from the last CPU load window
+ */
+static void put_cpu(telemetry_writer_t *w)
+{
+    const cpu_load_snapshot_t *snapshot = &s_cpu_snapshot;
+
+    cpu_load_get(&s_cpu_snapshot);
+
+    section_begin(w, TELEMETRY_SECTION_CPU);
+    put_u16(w, snapshot->total);
+    put_u16(w, snapshot->isr[BSP_ISR_ADC1_DMA]);
+    put_u16(w, snapshot->isr[BSP_ISR_ETH]);
+    put_u16(w, 0U);
+    section_end(w, 1U);
+
+    section_begin(w, TELEMETRY_SECTION_TASKS);
+    for (uint16_t i = 0U; i < snapshot->task_count; i++)
+    {
+        put_name(w, snapshot->tasks[i].name);
+        put_u16(w, snapshot->tasks[i].load);
+        put_u16(w, snapshot->tasks[i].stack_free);
+    }
+    section_end(w, (uint8_t)snapshot->task_count);
+}
+
+/**
+ * @brief ADC and metrics counter sections
+ */
+static void put_counters(telemetry_writer_t *w)
+{
+    uint32_t totals[METRIC_COUNT];
+
+    section_begin(w, TELEMETRY_SECTION_ADC);
+    put_u32(w, BSP_ADC1_GetFilterSampleCount());
+    put_u32(w, BSP_ADC1_GetFilterBlockOverruns());
+    section_end(w, 1U);
+
+    metrics_get(totals);
+    section_begin(w, TELEMETRY_SECTION_METRICS);
+    for (uint32_t i = 0U; i < (uint32_t)METRIC_COUNT; i++)
+    {
+        put_u32(w, totals[i]);
+    }
+    section_end(w, (uint8_t)METRIC_COUNT);
+}
+
+/**
+ * @brief Instruction cache section, the counts since the last frame
+ */
+static void put_icache(telemetry_writer_t *w)
+{
+    bsp_icache_monitor_t counts;
+    TickType_t           tick = xTaskGetTickCount();
+
+    if (BSP_ICache_ReadMonitor(&counts) != BSP_OK)
+    {
+        return;
+    }
+
+    section_begin(w, TELEMETRY_SECTION_ICACHE);
+    put_u32(w, (uint32_t)((tick - s_icache_tick) * portTICK_PERIOD_MS));
+    put_u32(w, counts.hits);
+    put_u32(w, counts.misses);
+    put_u32(w, counts.hot_start);
+    put_u32(w, counts.hot_size);
+    section_end(w, 1U);
+
+    s_icache_tick = tick;
+}
+
+#if MODBUS_ENABLE_LATENCY_STATS
+/**
+ * @brief Modbus latency histogram section
+ *
+ * The histograms are updated by the Modbus tasks as requests complete, so
+ * an entry may be one request out of step with itself.
+ */
+static void put_latency(telemetry_writer_t *w)
+{
+    uint32_t hz            = BSP_CycleCounter_Hz();
+    uint32_t cycles_per_us = (hz >= 1000000U) ? (hz / 1000000U) : 1U;
+    uint8_t  entries       = 0U;
+
+    section_begin(w, TELEMETRY_SECTION_LATENCY);
+    for (uint32_t t = 0U; t < (uint32_t)MODBUS_DIAG_TRANSPORT_COUNT; t++)
+    {
+        const modbus_latency_stats_t *stats =
+            modbus_diag_latency_stats((modbus_diag_transport_t)t);
+
+        for (uint32_t g = 0U; g < (uint32_t)MODBUS_LATENCY_FC_COUNT; g++)
+        {
+            const modbus_latency_histogram_t *histogram = &stats->fc[g];
+            uint32_t                          count     = histogram->count;
+
+            if (count == 0U)
+            {
+                continue;
+            }
+
+            put_u8(w, (uint8_t)t);
+            put_u8(w, (uint8_t)g);
+            put_u8(w, (uint8_t)MODBUS_LATENCY_MIN_SHIFT);
+            put_u8(w, (uint8_t)MODBUS_LATENCY_BUCKETS);
+            put_u32(w, count);
+            put_u32(w, hz);
+            for (uint32_t b = 0U; b < MODBUS_LATENCY_BUCKETS; b++)
+            {
+                put_u16(w, histogram->buckets[b]);
+            }
+            for (uint32_t s = 0U; s < (uint32_t)MODBUS_LATENCY_STAGE_COUNT;
+                 s++)
+            {
+                uint64_t mean_us =
+                    histogram->stage_cycles[s] / count / cycles_per_us;
+
+                put_u16(w, (mean_us > UINT16_MAX) ? UINT16_MAX
+                                                  : (uint16_t)mean_us);
+            }
+            entries++;
+        }
+    }
+    section_end(w, entries);
+}
+#endif /* MODBUS_ENABLE_LATENCY_STATS */
+
+/**
+ * @brief Build a frame into s_frame
+ *
+ * @return Frame length
+ */
+static uint16_t telemetry_build(void)
+{
+    telemetry_writer_t w = {
+        .pos   = TELEMETRY_HEADER_SIZE,
+        .limit = (uint16_t)(sizeof(s_frame) - 2U),
+    };
+    uint32_t uptime_ms =
+        (uint32_t)(xTaskGetTickCount() * (uint32_t)portTICK_PERIOD_MS);
+    uint16_t length;
+    uint16_t crc;
+
+    put_lwip(&w);
+    put_cpu(&w);
+    put_counters(&w);
+    put_icache(&w);
+#if MODBUS_ENABLE_LATENCY_STATS
+    put_latency(&w);
+#endif
+
+    length = (uint16_t)(w.pos + 2U);
+
+    /* Header, written last so the section count is known */
+    w.pos   = 0U;
+    w.limit = TELEMETRY_HEADER_SIZE;
+    put_u16(&w, TELEMETRY_MAGIC);
+    put_u8(&w, (uint8_t)TELEMETRY_VERSION);
+    put_u8(&w, w.count);
+    put_u16(&w, length);
+    put_u16(&w, s_config.period_s);
+    put_u32(&w, s_sequence);
+    put_u32(&w, uptime_ms);
+
+    crc                  = modbus_crc16(s_frame, (uint16_t)(length - 2U));
+    s_frame[length - 2U] = (uint8_t)crc;
+    s_frame[length - 1U] = (uint8_t)(crc >> 8U);
+    s_sequence++;
+
+    return length;
+}
+
+/**
+ * @brief Send the last frame to the configured destination
+ *
+ * The frame is copied into a heap pbuf, so the next build cannot change a
+ * datagram still queued for transmission.
+ */
+static void telemetry_send(uint16_t length)
+{
+    ip_addr_t dest;
+    void     *payload;
+
+    if ((s_config.dest_addr == 0U) || (s_config.dest_port == 0U))
+    {
+        return;
+    }
+
+    if (s_conn == NULL)
+    {
+        s_conn = netconn_new(NETCONN_UDP);
+        s_buf  = netbuf_new();
+        if ((s_conn == NULL) || (s_buf == NULL))
+        {
+            (void)printf("Telemetry: Failed to create UDP connection\n");
+            if (s_conn != NULL)
+            {
+                (void)netconn_delete(s_conn);
+                s_conn = NULL;
+            }
+            if (s_buf != NULL)
+            {
+                netbuf_delete(s_buf);
+                s_buf = NULL;
+            }
+            return;
+        }
+    }
+
+    payload = netbuf_alloc(s_buf, length);
+    if (payload == NULL)
+    {
+        return;
+    }
+
+    (void)memcpy(payload, s_frame, length);
+    IP_ADDR4(&dest, (uint8_t)(s_config.dest_addr >> 24U),
+             (uint8_t)(s_config.dest_addr >> 16U),
+             (uint8_t)(s_config.dest_addr >> 8U), (uint8_t)s_config.dest_addr);
+    (void)netconn_sendto(s_conn, s_buf, &dest, s_config.dest_port);
+    netbuf_free(s_buf);
+}
+
+/**
+ * @brief Pick up a new configuration
+ *
+ * @return true if the configuration changed
+ */
+static bool telemetry_apply_config(void)
+{
+    uint32_t generation = s_config_generation;
+
+    if (generation == s_generation)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    generation = s_config_generation;
+    s_config   = s_pending_config;
+    taskEXIT_CRITICAL();
+
+    s_generation = generation;
+    return true;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void telemetry_set_config(const telemetry_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    s_pending_config = *config;
+    s_config_generation++;
+    taskEXIT_CRITICAL();
+
+    metrics_request_telemetry();
+}
+
+TickType_t telemetry_poll(bool now)
+{
+    TickType_t tick = xTaskGetTickCount();
+    TickType_t period;
+    TickType_t elapsed;
+
+    if (telemetry_apply_config())
+    {
+        now = true;
+    }
+
+    if (s_config.period_s == 0U)
+    {
+        return portMAX_DELAY;
+    }
+
+    period  = pdMS_TO_TICKS((uint32_t)s_config.period_s * 1000U);
+    elapsed = tick - s_last_frame;
+
+    if (now || (s_frame_length == 0U) || (elapsed >= period))
+    {
+        uint16_t length = telemetry_build();
+
+        s_frame_length = length;
+        telemetry_send(length);
+        s_last_frame = tick;
+        elapsed      = 0U;
+    }
+
+    return period - elapsed;
+}
+
+modbus_exception_t telemetry_read_file_record(uint16_t  file_number,
+                                              uint16_t  record_number,
+                                              uint16_t  record_length,
+                                              uint16_t *values)
+{
+    uint32_t records = ((uint32_t)s_frame_length + 1U) / 2U;
+
+    if ((file_number != TELEMETRY_FILE_NUMBER) ||
+        (((uint32_t)record_number + record_length) > records))
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    for (uint16_t i = 0U; i < record_length; i++)
+    {
+        uint32_t pos  = 2U * ((uint32_t)record_number + i);
+        uint8_t  high = s_frame[pos];
+        uint8_t  low  = ((pos + 1U) < s_frame_length) ? s_frame[pos + 1U] : 0U;
+
+        values[i] = (uint16_t)(((uint16_t)high << 8U) | low);
+    }
+
+    return MODBUS_EXCEPTION_NONE;
+}
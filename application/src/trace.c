@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * Kernel and Interrupt Event Trace Task
+ *
+ * Producers write a record and advance the head with the kernel
+ * interrupts masked, so they never interleave; the trace task is the only
+ * reader. The records between the tail and the head are never written
+ * until the tail passes them, so the task sends them to the client straight
+ * from the ring and only frees them, by moving the tail, once they are
+ * sent. The ring only drops records while it is full, which is while the
+ * head stands still, so the records lost always follow those in the ring
+ * at the moment of the drain. The stream format is described in trace.h.
+ */
+
+#include "trace.h"
+
+#if TRACE_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "boot.h"
+#include "bsp.h"
+#include "bsp_sections.h"
+#include "lwip/api.h"
+#include "lwip/err.h"
+#include "metrics.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Stack size of the task (words) */
+#define TRACE_STACK_SIZE 384U
+
+/** Tasks the task table can list */
+#define TRACE_MAX_TASKS 32U
+
+_Static_assert((TRACE_RING_RECORDS & (TRACE_RING_RECORDS - 1U)) == 0U,
+               "the ring size must be a power of two");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief One record, in its wire layout
+ */
+typedef struct
+{
+    uint32_t time;    /**< Cycle counter, low 32 bits */
+    uint8_t  event;   /**< trace_event_t */
+    uint8_t  context; /**< Context byte */
+    uint16_t arg;     /**< Argument */
+} trace_record_t;
+
+_Static_assert(sizeof(trace_record_t) == TRACE_RECORD_SIZE,
+               "records are sent as they are stored");
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Task control block and stack */
+static StaticTask_t s_trace_task_tcb;
+static StackType_t  s_trace_task_stack[TRACE_STACK_SIZE] BSP_SECTION_STACK;
+
+/** Record ring */
+static trace_record_t s_ring[TRACE_RING_RECORDS];
+
+/** Records written, and records sent, since boot */
+static volatile uint32_t s_head;
+static volatile uint32_t s_tail;
+
+/** Records dropped since the last drain */
+static volatile uint32_t s_dropped;
+
+/** Set while a client is connected */
+static volatile bool s_enabled;
+
+/** Queues numbered so far */
+static volatile uint32_t s_queue_count;
+
+/** Task states read for the task table (trace task only) */
+static TaskStatus_t s_task_status[TRACE_MAX_TASKS];
+
+/** Header and task table being sent */
+static uint8_t s_header[TRACE_HEADER_SIZE +
+                        (TRACE_MAX_TASKS * TRACE_TASK_ENTRY_SIZE)];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Store a 16-bit value little-endian
+ */
+static void put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static void put_u32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+    dst[2] = (uint8_t)(value >> 16U);
+    dst[3] = (uint8_t)(value >> 24U);
+}
+
+/**
+ * @brief Record the entry and exit of an accounted interrupt handler
+ */
+static void trace_isr_hook(bsp_isr_t isr, bool enter)
+{
+    trace_record(
+        (uint8_t)(enter ? TRACE_EVENT_ISR_ENTER : TRACE_EVENT_ISR_EXIT),
+        (uint8_t)isr, 0U);
+}
+
+/**
+ * @brief Send the header and the task table
+ */
+static err_t trace_send_header(struct netconn *conn)
+{
+    UBaseType_t count = uxTaskGetSystemState(s_task_status, TRACE_MAX_TASKS,
+                                             NULL);
+    uint8_t    *entry = &s_header[TRACE_HEADER_SIZE];
+
+    put_u16(&s_header[0], (uint16_t)TRACE_MAGIC);
+    s_header[2] = (uint8_t)TRACE_VERSION;
+    s_header[3] = (uint8_t)TRACE_RECORD_SIZE;
+    put_u32(&s_header[4], BSP_CycleCounter_Hz());
+    put_u16(&s_header[8], (uint16_t)count);
+    put_u16(&s_header[10], 0U);
+
+    for (UBaseType_t i = 0U; i < count; i++)
+    {
+        const TaskStatus_t *task = &s_task_status[i];
+
+        put_u16(&entry[0], (uint16_t)task->xTaskNumber);
+        entry[2] = (uint8_t)task->uxBasePriority;
+        entry[3] = 0U;
+        (void)memset(&entry[4], 0, TRACE_NAME_SIZE);
+        (void)strncpy((char *)&entry[4], task->pcTaskName,
+                      TRACE_NAME_SIZE - 1U);
+        entry = &entry[TRACE_TASK_ENTRY_SIZE];
+    }
+
+    return netconn_write(conn, s_header, (size_t)(entry - s_header),
+                         NETCONN_COPY);
+}
+
+/**
+ * @brief Send the records written since the last drain and free them
+ */
+static err_t trace_drain(struct netconn *conn)
+{
+    uint32_t tail = s_tail;
+    uint32_t head;
+    uint32_t dropped;
+    err_t    err = ERR_OK;
+
+    taskENTER_CRITICAL();
+    head      = s_head;
+    dropped   = s_dropped;
+    s_dropped = 0U;
+    taskEXIT_CRITICAL();
+
+    while ((err == ERR_OK) && (tail != head))
+    {
+        uint32_t index = tail & (TRACE_RING_RECORDS - 1U);
+        uint32_t count = head - tail;
+
+        /* Up to the end of the ring, the rest on the next pass */
+        if (count > (TRACE_RING_RECORDS - index))
+        {
+            count = TRACE_RING_RECORDS - index;
+        }
+
+        err = netconn_write(conn, &s_ring[index],
+                            (size_t)count * sizeof(s_ring[0]), NETCONN_COPY);
+        tail += count;
+    }
+
+    /* Free the ring before the overflow record, so recording resumes */
+    s_tail = tail;
+
+    if ((err == ERR_OK) && (dropped != 0U))
+    {
+        /* The ring was full, so the last record sent was the last kept */
+        trace_record_t overflow = {
+            .time    = s_ring[(head - 1U) & (TRACE_RING_RECORDS - 1U)].time,
+            .event   = (uint8_t)TRACE_EVENT_OVERFLOW,
+            .context = 0U,
+            .arg     = (dropped > 0xFFFFU) ? 0xFFFFU : (uint16_t)dropped,
+        };
+
+        metrics_add(METRIC_TRACE_DROP, dropped);
+        err = netconn_write(conn, &overflow, sizeof(overflow), NETCONN_COPY);
+    }
+
+    return err;
+}
+
+/**
+ * @brief Stream the trace to one client until it goes away
+ */
+static void trace_stream(struct netconn *conn)
+{
+    err_t err;
+
+    /* Nothing is recorded while disabled, so the ring is idle */
+    s_tail    = s_head;
+    s_dropped = 0U;
+
+    err = trace_send_header(conn);
+    if (err == ERR_OK)
+    {
+        printf("Trace: client connected\n");
+        s_enabled = true;
+    }
+
+    while (err == ERR_OK)
+    {
+        vTaskDelay(pdMS_TO_TICKS(TRACE_DRAIN_MS));
+        err = trace_drain(conn);
+    }
+
+    s_enabled = false;
+    printf("Trace: client gone (%d)\n", (int)err);
+}
+
+/**
+ * @brief Trace task
+ */
+static void trace_task(void *pvParameters)
+{
+    struct netconn *listen_conn;
+    struct netconn *conn;
+
+    (void)pvParameters;
+
+    BSP_ISR_SetTraceHook(trace_isr_hook);
+
+    /* Wait for the network interface, as the FOTA task does */
+    (void)boot_wait(BOOT_EVENT_NETIF_UP, BOOT_WAIT_FOREVER);
+
+    while ((listen_conn = netconn_new(NETCONN_TCP)) == NULL)
+    {
+        printf("Trace: Failed to create connection\n");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    if ((netconn_bind(listen_conn, IP_ADDR_ANY, TRACE_PORT) != ERR_OK) ||
+        (netconn_listen_with_backlog(listen_conn, 1U) != ERR_OK))
+    {
+        printf("Trace: Failed to listen on port %u\n", TRACE_PORT);
+        netconn_delete(listen_conn);
+        vTaskDelete(NULL);
+    }
+
+    printf("Trace server listening on port %u\n", TRACE_PORT);
+
+    for (;;)
+    {
+        if (netconn_accept(listen_conn, &conn) != ERR_OK)
+        {
+            continue;
+        }
+
+        trace_stream(conn);
+        netconn_close(conn);
+        netconn_delete(conn);
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void trace_record(uint8_t event, uint8_t context, uint16_t arg)
+{
+    UBaseType_t mask;
+    uint32_t    head;
+
+    if (!s_enabled)
+    {
+        return;
+    }
+
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    head = s_head;
+    if ((head - s_tail) < TRACE_RING_RECORDS)
+    {
+        trace_record_t *record = &s_ring[head & (TRACE_RING_RECORDS - 1U)];
+
+        record->time    = BSP_CycleCounter_Read();
+        record->event   = event;
+        record->context = context;
+        record->arg     = arg;
+        s_head          = head + 1U;
+    }
+    else
+    {
+        s_dropped++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+uint32_t trace_queue_number(void)
+{
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    uint32_t    number;
+
+    s_queue_count++;
+    number = s_queue_count;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    return number;
+}
+
+void trace_start(void)
+{
+    (void)xTaskCreateStatic(trace_task, "Trace", TRACE_STACK_SIZE, NULL,
+                            TASK_PRIO_TRACE, s_trace_task_stack,
+                            &s_trace_task_tcb);
+}
+
+#endif /* TRACE_ENABLE */
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * TWAMP Light Reflector
+ *
+ * A raw UDP PCB whose receive callback runs in the TCP/IP thread, like
+ * modbus_udp.c. The receive time is read first thing in the callback and
+ * the send time last before udp_sendto(), so the reflector's own time is
+ * all inside T3 - T2. The packet format is described in
+ * twamp_reflector.h.
+ */
+
+#include "twamp_reflector.h"
+
+#if TWAMP_REFLECTOR
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bsp.h"
+#include "lwip/ip.h"
+#include "lwip/pbuf.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include "ptp.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Error estimate: the clock follows a master (S bit) */
+#define TWAMP_ERROR_SYNC 0x8000U
+
+/** Error estimate: timestamps in the truncated PTP format (Z bit) */
+#define TWAMP_ERROR_PTP 0x4000U
+
+/** Error estimate while locked: 1 x 2^(16 - 32) s, about 15 us, the jitter
+ * of times read by the TCP/IP thread rather than the PTP lock threshold */
+#define TWAMP_ERROR_LOCKED ((16U << 8) | 1U)
+
+/** Error estimate while not locked: 1 x 2^(63 - 32) s, unknown */
+#define TWAMP_ERROR_UNLOCKED ((63U << 8) | 1U)
+
+/* Offsets of the reply fields */
+#define TWAMP_OFF_TIMESTAMP        4U
+#define TWAMP_OFF_ERROR            12U
+#define TWAMP_OFF_RECEIVE          16U
+#define TWAMP_OFF_SENDER_SEQUENCE  24U
+#define TWAMP_OFF_SENDER_TTL       40U
+
+/* ==========================================================================
+ * Private Data
+ * ========================================================================== */
+
+/** Sequence number of the next reply, TCP/IP thread only */
+static uint32_t s_sequence;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Store a 32-bit value big-endian
+ */
+static void twamp_put_u32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)value;
+}
+
+/**
+ * @brief Store a PTP time as truncated PTP seconds and nanoseconds
+ */
+static void twamp_put_time(uint8_t *dst, uint64_t time_ns)
+{
+    twamp_put_u32(dst, (uint32_t)(time_ns / (uint64_t)BSP_PTP_NS_PER_S));
+    twamp_put_u32(&dst[4],
+                  (uint32_t)(time_ns % (uint64_t)BSP_PTP_NS_PER_S));
+}
+
+/**
+ * @brief UDP receive callback, one test packet per datagram
+ */
+static void twamp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                       const ip_addr_t *addr, u16_t port)
+{
+    uint64_t             receive_ns = BSP_Time_NowNs();
+    const struct ip_hdr *ip         = ip4_current_header();
+    uint16_t             length     = p->tot_len;
+    uint16_t             error      = TWAMP_ERROR_PTP;
+    struct pbuf         *q;
+    uint8_t             *reply;
+
+    (void)arg;
+
+    if ((length < TWAMP_SENDER_SIZE) || (length > TWAMP_MAX_SIZE))
+    {
+        pbuf_free(p);
+        return;
+    }
+    if (length < TWAMP_REFLECTOR_SIZE)
+    {
+        length = TWAMP_REFLECTOR_SIZE;
+    }
+
+    q = pbuf_alloc(PBUF_TRANSPORT, length, PBUF_RAM);
+    if (q == NULL)
+    {
+        pbuf_free(p);
+        return;
+    }
+    reply = (uint8_t *)q->payload;
+    (void)memset(reply, 0, length);
+
+    /* The sender's sequence number, timestamp and error estimate, in the
+     * order they come in */
+    (void)pbuf_copy_partial(p, &reply[TWAMP_OFF_SENDER_SEQUENCE],
+                            TWAMP_SENDER_SIZE, 0U);
+    reply[TWAMP_OFF_SENDER_TTL] = (ip != NULL) ? IPH_TTL(ip) : 0U;
+    pcb->tos                    = (ip != NULL) ? IPH_TOS(ip) : 0U;
+    pbuf_free(p);
+
+    error |= ptp_is_locked() ? (TWAMP_ERROR_SYNC | TWAMP_ERROR_LOCKED)
+                             : TWAMP_ERROR_UNLOCKED;
+    twamp_put_u32(reply, s_sequence);
+    reply[TWAMP_OFF_ERROR]      = (uint8_t)(error >> 8);
+    reply[TWAMP_OFF_ERROR + 1U] = (uint8_t)error;
+    twamp_put_time(&reply[TWAMP_OFF_RECEIVE], receive_ns);
+
+    twamp_put_time(&reply[TWAMP_OFF_TIMESTAMP], BSP_Time_NowNs());
+    if (udp_sendto(pcb, q, addr, port) == ERR_OK)
+    {
+        s_sequence++;
+    }
+    pbuf_free(q);
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void twamp_reflector_start(void)
+{
+    struct udp_pcb *pcb;
+    err_t           err = ERR_MEM;
+
+    LOCK_TCPIP_CORE();
+    pcb = udp_new();
+    if (pcb != NULL)
+    {
+        err = udp_bind(pcb, IP_ADDR_ANY, TWAMP_PORT);
+        if (err == ERR_OK)
+        {
+            udp_recv(pcb, twamp_recv, NULL);
+        }
+        else
+        {
+            udp_remove(pcb);
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+
+    if (err != ERR_OK)
+    {
+        printf("TWAMP: Failed to bind port %u\n", TWAMP_PORT);
+        return;
+    }
+
+    printf("TWAMP Light reflector on UDP port %u\n", TWAMP_PORT);
+}
+
+#endif /* TWAMP_REFLECTOR */
@@ -0,0 +1,707 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * USB Flash Stick Sample Logger
+ *
+ * The capture task packs ring samples into the buffer it owns; the writer
+ * task enumerates the stick, finds where to continue and writes every
+ * buffer the capture task hands over. A buffer belongs to the writer from
+ * the moment its full flag is set until the writer clears it, so neither
+ * task ever waits for the other. The file format is described in
+ * usb_logger.h.
+ *
+ * With USB_LOG_COMPRESS the capture task stages USB_LOG_CODEC_BLOCK
+ * samples and codes them into the open block before the next sample goes
+ * in. Staged samples whose coded size does not fit the rest of the block
+ * start the next block with a fresh codec state.
+ */
+
+#include "usb_logger.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_coefficients.h"
+#include "app_tasks.h"
+#include "boot.h"
+#include "metrics.h"
+#include "sample_codec.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Ring poll period while logging, well below the ring's 25.6 ms depth */
+#define USB_LOG_POLL_MS 2U
+
+/** Poll period of the capture task while not logging */
+#define USB_LOG_IDLE_MS 100U
+
+/** Poll period of the writer task for attach and detach */
+#define USB_LOG_ATTACH_POLL_MS 100U
+
+/** Longest wait for the Modbus service before the host port starts anyway */
+#define USB_LOG_START_WAIT_MS 5000U
+
+/** Samples copied out of the ring per read */
+#define USB_LOG_READ_CHUNK 32U
+
+/** Buffer size in bytes */
+#define USB_LOG_BUFFER_SIZE (USB_LOG_BUFFER_BLOCKS * USB_MSC_BLOCK_SIZE)
+
+/** ADC1 resolution in bits (MX_ADC1_Init) */
+#define USB_LOG_ADC_BITS 12U
+
+_Static_assert((USB_LOG_FILE_BLOCKS % USB_LOG_BUFFER_BLOCKS) == 0U,
+               "file slots must hold whole buffers");
+_Static_assert(USB_LOG_HEADER_SIZE <= USB_MSC_BLOCK_SIZE,
+               "file header must fit one block");
+_Static_assert(SAMPLE_CODEC_MAX_SIZE(BSP_ADC1_NUM_CHANNELS,
+                                     USB_LOG_CODEC_BLOCK) <=
+                   USB_LOG_SAMPLE_AREA,
+               "a coded block must fit an empty data block");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Capture task state
+ */
+typedef struct
+{
+    bsp_adc1_reader_t reader;        /**< Ring cursor */
+    bool              active;        /**< Logging, reader attached */
+    uint8_t           fill;          /**< Buffer filled next */
+    uint8_t          *buffer;        /**< Buffer being filled, NULL if none */
+    uint32_t          blocks;        /**< Complete blocks in the buffer */
+    uint8_t          *block;         /**< Block being filled, NULL if none */
+    uint16_t          count;         /**< Samples in the block */
+    uint16_t          used;          /**< Sample bytes in the block */
+    uint32_t          next_sequence; /**< Sequence that continues the block */
+    uint32_t          lost;          /**< Samples lost since the last block */
+#if USB_LOG_COMPRESS
+    sample_codec_t    codec;           /**< Codec state of the block */
+    uint16_t          staged;          /**< Samples in s_staged */
+    uint32_t          staged_sequence; /**< Sequence of the first one */
+    uint32_t          staged_lost;     /**< Samples lost before it */
+#endif
+} usb_log_capture_t;
+
+/**
+ * @brief Writer task state
+ */
+typedef struct
+{
+    usb_msc_device_t device;      /**< Attached stick */
+    uint32_t         slots;       /**< File slots on the stick */
+    uint32_t         slot;        /**< Slot of the current file */
+    uint32_t         file;        /**< Number of the current file */
+    uint32_t         file_blocks; /**< Data blocks written to the file */
+    uint8_t          drain;       /**< Buffer written next */
+} usb_log_writer_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+/** Sample buffers, each owned by one task at a time */
+static uint8_t s_buffers[USB_LOG_BUFFERS][USB_LOG_BUFFER_SIZE];
+
+/** Set by the capture task when it hands a buffer to the writer */
+static atomic_bool s_full[USB_LOG_BUFFERS];
+
+/** Set by the writer task while a stick takes samples */
+static atomic_bool s_recording;
+
+/** Writer task, notified for every full buffer */
+static TaskHandle_t volatile s_writer = NULL;
+
+/** Samples copied out of the ring, kept off the task stack */
+static bsp_adc1_sample_t s_chunk[USB_LOG_READ_CHUNK];
+
+#if USB_LOG_COMPRESS
+/** Raw results of the staged samples */
+static uint16_t s_staged[USB_LOG_CODEC_BLOCK * BSP_ADC1_NUM_CHANNELS];
+
+/** Coded staged samples that may not fit the block */
+static uint8_t s_coded[SAMPLE_CODEC_MAX_SIZE(BSP_ADC1_NUM_CHANNELS,
+                                             USB_LOG_CODEC_BLOCK)];
+#endif
+
+/** File header and slot scan block */
+static uint8_t s_header[USB_MSC_BLOCK_SIZE];
+
+static usb_log_capture_t s_capture;
+static usb_log_writer_t  s_writer_state;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+static uint8_t *put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFU);
+    dst[1] = (uint8_t)(value >> 8U);
+    return &dst[2];
+}
+
+static uint8_t *put_u32(uint8_t *dst, uint32_t value)
+{
+    dst = put_u16(dst, (uint16_t)(value & 0xFFFFU));
+    return put_u16(dst, (uint16_t)(value >> 16U));
+}
+
+static uint8_t *put_u64(uint8_t *dst, uint64_t value)
+{
+    dst = put_u32(dst, (uint32_t)(value & 0xFFFFFFFFU));
+    return put_u32(dst, (uint32_t)(value >> 32U));
+}
+
+static uint32_t get_u32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8U) |
+           ((uint32_t)src[2] << 16U) | ((uint32_t)src[3] << 24U);
+}
+
+/* --------------------------------------------------------------------------
+ * Capture
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Complete the open block; hand the buffer over once it is full
+ */
+static void usb_log_close_block(usb_log_capture_t *capture)
+{
+    (void)put_u16(&capture->block[16], capture->count);
+    capture->block = NULL;
+    capture->blocks++;
+
+    if (capture->blocks == USB_LOG_BUFFER_BLOCKS)
+    {
+        TaskHandle_t writer = s_writer;
+
+        atomic_store(&s_full[capture->fill], true);
+        if (writer != NULL)
+        {
+            (void)xTaskNotifyGive(writer);
+        }
+        capture->fill   = (uint8_t)((capture->fill + 1U) % USB_LOG_BUFFERS);
+        capture->buffer = NULL;
+    }
+}
+
+/**
+ * @brief Start a block with the header of its first sample
+ *
+ * @param sequence Sequence number of the first sample
+ * @param lost     Samples lost just before it
+ * @return false if no buffer is free
+ */
+static bool usb_log_open_block(usb_log_capture_t *capture, uint32_t sequence,
+                               uint32_t lost)
+{
+    uint64_t time = 0U;
+    uint8_t *hdr;
+
+    if (capture->buffer == NULL)
+    {
+        if (atomic_load(&s_full[capture->fill]))
+        {
+            return false;
+        }
+        capture->buffer = s_buffers[capture->fill];
+        capture->blocks = 0U;
+    }
+
+    if (BSP_ADC1_GetSampleTime(sequence, &time) != BSP_OK)
+    {
+        time = 0U;
+    }
+
+    capture->block =
+        &capture->buffer[capture->blocks * USB_MSC_BLOCK_SIZE];
+    (void)memset(capture->block, 0, USB_MSC_BLOCK_SIZE);
+
+    /* The writer fills in the file number */
+    hdr = put_u32(&capture->block[4], sequence);
+    hdr = put_u64(hdr, time);
+    hdr = put_u16(hdr, 0U);
+    (void)put_u16(hdr, (lost > 0xFFFFU) ? 0xFFFFU : (uint16_t)lost);
+
+    capture->count = 0U;
+    capture->used  = 0U;
+    return true;
+}
+
+#if USB_LOG_COMPRESS
+/**
+ * @brief Code the staged samples into the open block, opening one as needed
+ *
+ * The staged samples are lost if no buffer is free.
+ */
+static void usb_log_code(usb_log_capture_t *capture)
+{
+    const uint32_t count = capture->staged;
+    size_t         size  = 0U;
+    bool           coded = false;
+
+    capture->staged = 0U;
+
+    if (capture->block != NULL)
+    {
+        const size_t room = USB_LOG_SAMPLE_AREA - capture->used;
+        uint8_t     *dst =
+            &capture->block[USB_LOG_BLOCK_HEADER_SIZE + capture->used];
+
+        if (room >= SAMPLE_CODEC_MAX_SIZE(BSP_ADC1_NUM_CHANNELS, count))
+        {
+            size  = sample_codec_encode(&capture->codec, s_staged, count, dst);
+            coded = true;
+        }
+        else
+        {
+            size = sample_codec_encode(&capture->codec, s_staged, count,
+                                       s_coded);
+            if (size <= room)
+            {
+                (void)memcpy(dst, s_coded, size);
+                coded = true;
+            }
+            else
+            {
+                usb_log_close_block(capture);
+            }
+        }
+    }
+
+    if (!coded)
+    {
+        if (!usb_log_open_block(capture, capture->staged_sequence,
+                                capture->staged_lost))
+        {
+            /* Both buffers wait for the stick */
+            capture->lost += count;
+            metrics_add(METRIC_USB_LOG_LOST, count);
+            return;
+        }
+        sample_codec_init(&capture->codec, (uint8_t)BSP_ADC1_NUM_CHANNELS);
+        size = sample_codec_encode(&capture->codec, s_staged, count,
+                                   &capture->block[USB_LOG_BLOCK_HEADER_SIZE]);
+    }
+
+    capture->used  = (uint16_t)(capture->used + size);
+    capture->count = (uint16_t)(capture->count + count);
+}
+
+/**
+ * @brief Stage a ring sample, coding the staged ones when needed
+ */
+static void usb_log_sample(usb_log_capture_t       *capture,
+                           const bsp_adc1_sample_t *sample)
+{
+    const bool gap = (sample->sequence != capture->next_sequence);
+    uint16_t  *dst;
+
+    if ((capture->staged > 0U) &&
+        (gap || (capture->staged >= USB_LOG_CODEC_BLOCK)))
+    {
+        usb_log_code(capture);
+    }
+    if (gap && (capture->block != NULL))
+    {
+        usb_log_close_block(capture);
+    }
+
+    if (capture->staged == 0U)
+    {
+        capture->staged_sequence = sample->sequence;
+        capture->staged_lost     = capture->lost;
+        capture->lost            = 0U;
+    }
+
+    dst = &s_staged[capture->staged * BSP_ADC1_NUM_CHANNELS];
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        dst[ch] = sample->raw[ch];
+    }
+
+    capture->staged++;
+    capture->next_sequence = sample->sequence + 1U;
+}
+#else
+/**
+ * @brief Add a ring sample to the open block
+ */
+static void usb_log_sample(usb_log_capture_t       *capture,
+                           const bsp_adc1_sample_t *sample)
+{
+    uint8_t *dst;
+
+    if ((capture->block != NULL) &&
+        ((capture->count >= USB_LOG_SAMPLES_PER_BLOCK) ||
+         (sample->sequence != capture->next_sequence)))
+    {
+        usb_log_close_block(capture);
+    }
+
+    if (capture->block == NULL)
+    {
+        if (!usb_log_open_block(capture, sample->sequence, capture->lost))
+        {
+            /* Both buffers wait for the stick */
+            capture->lost++;
+            metrics_add(METRIC_USB_LOG_LOST, 1U);
+            return;
+        }
+        capture->lost = 0U;
+    }
+
+    dst = &capture->block[USB_LOG_BLOCK_HEADER_SIZE + capture->used];
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        dst = put_u16(dst, sample->raw[ch]);
+    }
+
+    capture->count++;
+    capture->used = (uint16_t)(capture->used + USB_LOG_SAMPLE_SIZE);
+    capture->next_sequence = sample->sequence + 1U;
+}
+#endif
+
+/**
+ * @brief Move all available ring samples into blocks
+ */
+static void usb_log_drain(usb_log_capture_t *capture)
+{
+    uint32_t count = 0U;
+
+    do
+    {
+        uint32_t overruns = capture->reader.overruns;
+
+        if (BSP_ADC1_RingRead(&capture->reader, s_chunk, USB_LOG_READ_CHUNK,
+                              &count) != BSP_OK)
+        {
+            return;
+        }
+        metrics_add(METRIC_ADC_OVERRUN, capture->reader.overruns - overruns);
+        capture->lost += capture->reader.overruns - overruns;
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            usb_log_sample(capture, &s_chunk[i]);
+        }
+    } while (count == USB_LOG_READ_CHUNK);
+}
+
+/* --------------------------------------------------------------------------
+ * Writer
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Find the newest file on the stick and continue in the next slot
+ *
+ * A stick with no log file starts with file 1 in slot 0.
+ */
+static bsp_error_t usb_log_find_slot(usb_log_writer_t *writer)
+{
+    uint32_t newest = 0U;
+
+    writer->slot = 0U;
+    writer->file = 1U;
+
+    for (uint32_t slot = 0U; slot < writer->slots; slot++)
+    {
+        bsp_error_t status;
+        uint32_t    file;
+
+        status = usb_msc_read(&writer->device, slot * USB_LOG_FILE_BLOCKS,
+                              1U, s_header);
+        if (status != BSP_OK)
+        {
+            return status;
+        }
+
+        file = get_u32(&s_header[8]);
+        if ((get_u32(&s_header[0]) == USB_LOG_MAGIC) &&
+            (get_u32(&s_header[16]) == USB_LOG_FILE_BLOCKS) &&
+            (get_u32(&s_header[12]) == slot) && (file > newest))
+        {
+            newest       = file;
+            writer->slot = (slot + 1U) % writer->slots;
+            writer->file = file + 1U;
+        }
+    }
+
+    return BSP_OK;
+}
+
+/**
+ * @brief Write the header of the current file
+ *
+ * @param first First data block of the file, for its sequence and time
+ */
+static bsp_error_t usb_log_write_header(usb_log_writer_t *writer,
+                                        const uint8_t    *first)
+{
+    uint8_t *hdr = s_header;
+
+    (void)memset(s_header, 0, sizeof(s_header));
+    hdr    = put_u32(hdr, USB_LOG_MAGIC);
+    hdr    = put_u16(hdr, USB_LOG_VERSION);
+    hdr    = put_u16(hdr, USB_LOG_HEADER_SIZE);
+    hdr    = put_u32(hdr, writer->file);
+    hdr    = put_u32(hdr, writer->slot);
+    hdr    = put_u32(hdr, USB_LOG_FILE_BLOCKS);
+    hdr    = put_u16(hdr, USB_MSC_BLOCK_SIZE);
+    hdr    = put_u16(hdr, USB_LOG_BUFFER_BLOCKS);
+    hdr    = put_u32(hdr, BSP_ADC1_GetSampleRate());
+    hdr    = put_u32(hdr, (uint32_t)BSP_ADC1_TIMESTAMP_HZ);
+    hdr[0] = (uint8_t)BSP_ADC1_NUM_CHANNELS;
+    hdr[1] = (uint8_t)USB_LOG_ADC_BITS;
+    hdr    = put_u16(&hdr[2], USB_LOG_SAMPLE_SIZE);
+    hdr    = put_u16(hdr, USB_LOG_BLOCK_HEADER_SIZE);
+#if USB_LOG_COMPRESS
+    hdr    = put_u16(hdr, USB_LOG_CODED_SAMPLES_PER_BLOCK);
+#else
+    hdr    = put_u16(hdr, USB_LOG_SAMPLES_PER_BLOCK);
+#endif
+
+    /* Sequence and timestamp of the first sample, from its block */
+    (void)memcpy(hdr, &first[4], 12U);
+    hdr = &hdr[12];
+
+#if USB_LOG_COMPRESS
+    hdr = put_u16(hdr, USB_LOG_CODING_CODEC);
+    (void)put_u16(hdr, USB_LOG_CODEC_BLOCK);
+#else
+    hdr = put_u16(hdr, USB_LOG_CODING_RAW);
+    (void)put_u16(hdr, 0U);
+#endif
+
+    return usb_msc_write(&writer->device, writer->slot * USB_LOG_FILE_BLOCKS,
+                         1U, s_header);
+}
+
+/**
+ * @brief Write one full buffer to the current file, rotating as needed
+ */
+static bsp_error_t usb_log_write_buffer(usb_log_writer_t *writer,
+                                        uint8_t          *buffer)
+{
+    uint32_t    lba;
+    bsp_error_t status;
+
+    if (writer->file_blocks == 0U)
+    {
+        status = usb_log_write_header(writer, buffer);
+        if (status != BSP_OK)
+        {
+            return status;
+        }
+        printf("USB log: file %lu in slot %lu\n", (unsigned long)writer->file,
+               (unsigned long)writer->slot);
+    }
+
+    for (uint32_t i = 0U; i < USB_LOG_BUFFER_BLOCKS; i++)
+    {
+        (void)put_u32(&buffer[i * USB_MSC_BLOCK_SIZE], writer->file);
+    }
+
+    lba = (writer->slot * USB_LOG_FILE_BLOCKS) + USB_LOG_BUFFER_BLOCKS +
+          writer->file_blocks;
+    status = usb_msc_write(&writer->device, lba, USB_LOG_BUFFER_BLOCKS,
+                           buffer);
+    if (status != BSP_OK)
+    {
+        return status;
+    }
+
+    writer->file_blocks += USB_LOG_BUFFER_BLOCKS;
+    if (writer->file_blocks >=
+        (USB_LOG_FILE_BLOCKS - USB_LOG_BUFFER_BLOCKS))
+    {
+        /* Rotate; the oldest file makes room once the stick is full */
+        writer->file_blocks = 0U;
+        writer->file++;
+        writer->slot = (writer->slot + 1U) % writer->slots;
+    }
+
+    return BSP_OK;
+}
+
+/**
+ * @brief Enumerate a newly attached stick and prepare the next file
+ */
+static bool usb_log_attach(usb_log_writer_t *writer)
+{
+    bsp_error_t status;
+
+    status = usb_msc_attach(&writer->device);
+    if (status != BSP_OK)
+    {
+        printf("USB log: no usable stick (%d)\n", (int)status);
+        return false;
+    }
+
+    writer->slots = writer->device.block_count / USB_LOG_FILE_BLOCKS;
+    if (writer->slots == 0U)
+    {
+        printf("USB log: stick too small (%lu blocks)\n",
+               (unsigned long)writer->device.block_count);
+        return false;
+    }
+
+    status = usb_log_find_slot(writer);
+    if (status != BSP_OK)
+    {
+        printf("USB log: slot scan failed (%d)\n", (int)status);
+        return false;
+    }
+
+    printf("USB log: %lu slots, next file %lu\n", (unsigned long)writer->slots,
+           (unsigned long)writer->file);
+    writer->file_blocks = 0U;
+    return true;
+}
+
+/**
+ * @brief Write the full buffers until the stick fails or is removed
+ */
+static void usb_log_record(usb_log_writer_t *writer)
+{
+    writer->drain = 0U;
+    for (uint8_t i = 0U; i < USB_LOG_BUFFERS; i++)
+    {
+        atomic_store(&s_full[i], false);
+    }
+    atomic_store(&s_recording, true);
+
+    while (BSP_USBH_IsConnected())
+    {
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(USB_LOG_ATTACH_POLL_MS));
+
+        while (atomic_load(&s_full[writer->drain]))
+        {
+            bsp_error_t status =
+                usb_log_write_buffer(writer, s_buffers[writer->drain]);
+
+            if (status != BSP_OK)
+            {
+                printf("USB log: write failed (%d, sense %02X/%02X)\n",
+                       (int)status, (unsigned int)writer->device.sense_key,
+                       (unsigned int)writer->device.asc);
+                atomic_store(&s_recording, false);
+                return;
+            }
+
+            atomic_store(&s_full[writer->drain], false);
+            writer->drain = (uint8_t)((writer->drain + 1U) % USB_LOG_BUFFERS);
+        }
+    }
+
+    atomic_store(&s_recording, false);
+    printf("USB log: stick removed\n");
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+/**
+ * @brief USB log capture task
+ */
+void vUsbLogTask(void *pvParameters)
+{
+    usb_log_capture_t *capture = &s_capture;
+
+    (void)pvParameters;
+
+    printf("USB log capture task started\n");
+
+    for (;;)
+    {
+        bool recording = atomic_load(&s_recording);
+
+        if (recording && !capture->active)
+        {
+            /* The writer has reset the buffers; start from now */
+            (void)BSP_ADC1_RingReaderInit(&capture->reader,
+                                          BSP_ADC1_STREAM_FULL);
+            capture->fill   = 0U;
+            capture->buffer = NULL;
+            capture->block  = NULL;
+            capture->lost   = 0U;
+#if USB_LOG_COMPRESS
+            capture->staged = 0U;
+#endif
+            capture->active = true;
+        }
+        else if (!recording)
+        {
+            capture->active = false;
+        }
+        else
+        {
+            /* Logging continues */
+        }
+
+        if (capture->active)
+        {
+            usb_log_drain(capture);
+            vTaskDelay(pdMS_TO_TICKS(USB_LOG_POLL_MS));
+        }
+        else
+        {
+            vTaskDelay(pdMS_TO_TICKS(USB_LOG_IDLE_MS));
+        }
+    }
+}
+
+/**
+ * @brief USB log writer task
+ */
+void vUsbWriteTask(void *pvParameters)
+{
+    usb_log_writer_t *writer = &s_writer_state;
+
+    (void)pvParameters;
+
+    s_writer = xTaskGetCurrentTaskHandle();
+
+    /* The host port is not needed for control; bring it up after the
+     * Modbus service so that it does not delay it */
+    (void)boot_wait(BOOT_EVENT_SERVICE_UP, USB_LOG_START_WAIT_MS);
+    if (BSP_USBH_Start() != BSP_OK)
+    {
+        printf("USB log: host port did not start\n");
+        vTaskDelete(NULL);
+    }
+
+    printf("USB log writer task started\n");
+
+    for (;;)
+    {
+        while (!BSP_USBH_IsConnected())
+        {
+            vTaskDelay(pdMS_TO_TICKS(USB_LOG_ATTACH_POLL_MS));
+        }
+
+        if (usb_log_attach(writer))
+        {
+            usb_log_record(writer);
+        }
+
+        /* Wait for the stick to go before trying the next one */
+        while (BSP_USBH_IsConnected())
+        {
+            vTaskDelay(pdMS_TO_TICKS(USB_LOG_ATTACH_POLL_MS));
+        }
+    }
+}
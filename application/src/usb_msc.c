@@ -0,0 +1,570 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * USB Mass Storage Host Class
+ *
+ * Enumeration of a single device and the Bulk-Only Transport: every
+ * command goes out as a 31-byte command block wrapper (CBW), is followed
+ * by its data stage, and ends with the 13-byte command status wrapper
+ * (CSW) from the device. See usb_msc.h.
+ */
+
+#include "usb_msc.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Address given to the device */
+#define USB_MSC_ADDRESS 1U
+
+/** Timeout of a control request */
+#define USB_MSC_CONTROL_TIMEOUT_MS 500U
+
+/** Timeout of a CBW, a data stage and a CSW; a stick can stall writes */
+#define USB_MSC_TRANSFER_TIMEOUT_MS 5000U
+
+/** Longest wait for the medium to become ready after attach */
+#define USB_MSC_READY_TIMEOUT_MS 10000U
+
+/** Poll period of TEST UNIT READY while the medium is not ready */
+#define USB_MSC_READY_POLL_MS 100U
+
+/** Configuration descriptor bytes read, enough for a BOT device */
+#define USB_MSC_CONFIG_SIZE 255U
+
+/* ==========================================================================
+ * Protocol Constants
+ * ========================================================================== */
+
+/* Standard requests and descriptor types (USB 2.0, 9.4) */
+#define USB_REQ_SET_ADDRESS       0x05U
+#define USB_REQ_GET_DESCRIPTOR    0x06U
+#define USB_REQ_SET_CONFIGURATION 0x09U
+#define USB_DESC_DEVICE           0x01U
+#define USB_DESC_CONFIGURATION    0x02U
+#define USB_DESC_INTERFACE        0x04U
+#define USB_DESC_ENDPOINT         0x05U
+#define USB_EP_TYPE_BULK          0x02U
+
+/* Mass storage class, SCSI transparent command set, Bulk-Only Transport */
+#define MSC_CLASS            0x08U
+#define MSC_SUBCLASS_SCSI    0x06U
+#define MSC_PROTOCOL_BOT     0x50U
+#define MSC_REQ_RESET        0xFFU
+#define MSC_CBW_SIGNATURE    0x43425355UL /* "USBC" */
+#define MSC_CSW_SIGNATURE    0x53425355UL /* "USBS" */
+#define MSC_CBW_SIZE         31U
+#define MSC_CSW_SIZE         13U
+#define MSC_CSW_PASSED       0x00U
+#define MSC_CSW_FAILED       0x01U
+
+/* SCSI commands */
+#define SCSI_TEST_UNIT_READY 0x00U
+#define SCSI_REQUEST_SENSE   0x03U
+#define SCSI_INQUIRY         0x12U
+#define SCSI_READ_CAPACITY   0x25U
+#define SCSI_READ_10         0x28U
+#define SCSI_WRITE_10        0x2AU
+
+#define SCSI_INQUIRY_SIZE  36U
+#define SCSI_SENSE_SIZE    18U
+#define SCSI_CAPACITY_SIZE 8U
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+/** Descriptor, CBW, CSW and response buffer, used by one task at a time */
+static uint8_t s_buffer[USB_MSC_CONFIG_SIZE];
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+static void put_be32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)(value >> 24U);
+    dst[1] = (uint8_t)(value >> 16U);
+    dst[2] = (uint8_t)(value >> 8U);
+    dst[3] = (uint8_t)value;
+}
+
+static uint32_t get_be32(const uint8_t *src)
+{
+    return ((uint32_t)src[0] << 24U) | ((uint32_t)src[1] << 16U) |
+           ((uint32_t)src[2] << 8U) | (uint32_t)src[3];
+}
+
+static void put_le32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+    dst[2] = (uint8_t)(value >> 16U);
+    dst[3] = (uint8_t)(value >> 24U);
+}
+
+static uint32_t get_le32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8U) |
+           ((uint32_t)src[2] << 16U) | ((uint32_t)src[3] << 24U);
+}
+
+/**
+ * @brief Issue a standard or class request without a data stage
+ */
+static bsp_error_t msc_request(uint8_t request_type, uint8_t request,
+                               uint16_t value, uint16_t index)
+{
+    const bsp_usbh_setup_t setup = {
+        .request_type = request_type,
+        .request      = request,
+        .value        = value,
+        .index        = index,
+        .length       = 0U,
+    };
+
+    return BSP_USBH_Control(&setup, NULL, NULL, USB_MSC_CONTROL_TIMEOUT_MS);
+}
+
+/**
+ * @brief Read a descriptor into s_buffer
+ */
+static bsp_error_t msc_get_descriptor(uint8_t type, uint16_t length,
+                                      uint16_t *actual)
+{
+    const bsp_usbh_setup_t setup = {
+        .request_type = BSP_USBH_EP_IN,
+        .request      = USB_REQ_GET_DESCRIPTOR,
+        .value        = (uint16_t)((uint16_t)type << 8U),
+        .index        = 0U,
+        .length       = length,
+    };
+
+    return BSP_USBH_Control(&setup, s_buffer, actual,
+                            USB_MSC_CONTROL_TIMEOUT_MS);
+}
+
+/**
+ * @brief BOT reset recovery: class reset, then clear both endpoint halts
+ */
+static void msc_reset_recovery(const usb_msc_device_t *device)
+{
+    (void)msc_request(0x21U, MSC_REQ_RESET, 0U, device->interface);
+    (void)BSP_USBH_ClearHalt(device->bulk_in, USB_MSC_CONTROL_TIMEOUT_MS);
+    (void)BSP_USBH_ClearHalt(device->bulk_out, USB_MSC_CONTROL_TIMEOUT_MS);
+}
+
+/**
+ * @brief Run one SCSI command through the Bulk-Only Transport
+ *
+ * @param device    Attached device
+ * @param cb        Command block
+ * @param cb_length Command block length, 6 to 16 bytes
+ * @param data      Data stage buffer, NULL if @p length is 0
+ * @param length    Data stage length
+ * @param in        Data stage direction
+ * @return BSP_OK if the device passed the command, BSP_ERROR if it failed
+ *         it or the transport broke down, or the BSP error of a transfer
+ */
+static bsp_error_t msc_command(usb_msc_device_t *device, const uint8_t *cb,
+                               uint8_t cb_length, uint8_t *data,
+                               uint32_t length, bool in)
+{
+    uint8_t    *cbw         = s_buffer;
+    bsp_error_t status      = BSP_OK;
+    bool        data_failed = false;
+    uint32_t    actual      = 0U;
+
+    device->tag++;
+    (void)memset(cbw, 0, MSC_CBW_SIZE);
+    put_le32(&cbw[0], MSC_CBW_SIGNATURE);
+    put_le32(&cbw[4], device->tag);
+    put_le32(&cbw[8], length);
+    cbw[12] = in ? 0x80U : 0x00U;
+    cbw[13] = 0U; /* LUN */
+    cbw[14] = cb_length;
+    (void)memcpy(&cbw[15], cb, cb_length);
+
+    status = BSP_USBH_Bulk(device->bulk_out, cbw, MSC_CBW_SIZE, NULL,
+                           USB_MSC_TRANSFER_TIMEOUT_MS);
+    if (status != BSP_OK)
+    {
+        msc_reset_recovery(device);
+        return status;
+    }
+
+    if (length != 0U)
+    {
+        uint8_t endpoint = in ? device->bulk_in : device->bulk_out;
+
+        status = BSP_USBH_Bulk(endpoint, data, length, &actual,
+                               USB_MSC_TRANSFER_TIMEOUT_MS);
+        if (status == BSP_USBH_STALL)
+        {
+            /* The device refused the data; its CSW still follows */
+            data_failed = true;
+            (void)BSP_USBH_ClearHalt(endpoint, USB_MSC_CONTROL_TIMEOUT_MS);
+        }
+        else if (status != BSP_OK)
+        {
+            msc_reset_recovery(device);
+            return status;
+        }
+        else
+        {
+            /* A short IN stage is legal; the CSW residue tells */
+        }
+    }
+
+    /* A halted IN endpoint gets one more try at the CSW */
+    status = BSP_USBH_Bulk(device->bulk_in, s_buffer, MSC_CSW_SIZE, &actual,
+                           USB_MSC_TRANSFER_TIMEOUT_MS);
+    if (status == BSP_USBH_STALL)
+    {
+        (void)BSP_USBH_ClearHalt(device->bulk_in, USB_MSC_CONTROL_TIMEOUT_MS);
+        status = BSP_USBH_Bulk(device->bulk_in, s_buffer, MSC_CSW_SIZE,
+                               &actual, USB_MSC_TRANSFER_TIMEOUT_MS);
+    }
+
+    if ((status != BSP_OK) || (actual != MSC_CSW_SIZE) ||
+        (get_le32(&s_buffer[0]) != MSC_CSW_SIGNATURE) ||
+        (get_le32(&s_buffer[4]) != device->tag) ||
+        (s_buffer[12] > MSC_CSW_FAILED))
+    {
+        /* Bad or missing CSW, or phase error */
+        msc_reset_recovery(device);
+        return (status != BSP_OK) ? status : BSP_ERROR;
+    }
+
+    device->residue = get_le32(&s_buffer[8]);
+    return ((s_buffer[12] == MSC_CSW_PASSED) && !data_failed) ? BSP_OK
+                                                              : BSP_ERROR;
+}
+
+/**
+ * @brief Fetch the sense data of the last failed command
+ */
+static void msc_request_sense(usb_msc_device_t *device)
+{
+    uint8_t cb[6]                   = {SCSI_REQUEST_SENSE, 0U, 0U,
+                                       0U, SCSI_SENSE_SIZE, 0U};
+    uint8_t sense[SCSI_SENSE_SIZE] = {0U};
+
+    device->sense_key = 0U;
+    device->asc       = 0U;
+    if (msc_command(device, cb, sizeof(cb), sense, sizeof(sense), true) ==
+        BSP_OK)
+    {
+        device->sense_key = sense[2] & 0x0FU;
+        device->asc       = sense[12];
+    }
+}
+
+/**
+ * @brief Run a command, collecting the sense data if the device fails it
+ */
+static bsp_error_t msc_scsi(usb_msc_device_t *device, const uint8_t *cb,
+                            uint8_t cb_length, uint8_t *data, uint32_t length,
+                            bool in)
+{
+    bsp_error_t status = msc_command(device, cb, cb_length, data, length, in);
+
+    if (status == BSP_ERROR)
+    {
+        msc_request_sense(device);
+    }
+    return status;
+}
+
+/**
+ * @brief Find the BOT SCSI interface in the configuration descriptor
+ *
+ * @param length           Valid bytes of the descriptor in s_buffer
+ * @param[out] device      Interface and endpoints found
+ * @param[out] in_packet   Packet size of the bulk IN endpoint
+ * @param[out] out_packet  Packet size of the bulk OUT endpoint
+ * @return true if an interface with both bulk endpoints was found
+ */
+static bool msc_parse_config(uint16_t length, usb_msc_device_t *device,
+                             uint16_t *in_packet, uint16_t *out_packet)
+{
+    bool     in_bot = false;
+    uint16_t offset = 0U;
+
+    device->bulk_in  = 0U;
+    device->bulk_out = 0U;
+
+    while ((offset + 2U) <= length)
+    {
+        const uint8_t *desc = &s_buffer[offset];
+
+        if ((desc[0] < 2U) || ((offset + desc[0]) > length))
+        {
+            break;
+        }
+
+        if ((desc[1] == USB_DESC_INTERFACE) && (desc[0] >= 9U))
+        {
+            if (in_bot)
+            {
+                /* The BOT interface ended without both endpoints */
+                break;
+            }
+            in_bot = (desc[5] == MSC_CLASS) && (desc[6] == MSC_SUBCLASS_SCSI) &&
+                     (desc[7] == MSC_PROTOCOL_BOT) && (desc[3] == 0U);
+            device->interface = desc[2];
+        }
+        else if (in_bot && (desc[1] == USB_DESC_ENDPOINT) && (desc[0] >= 7U) &&
+                 ((desc[3] & 0x03U) == USB_EP_TYPE_BULK))
+        {
+            uint16_t packet = (uint16_t)(desc[4] | ((uint16_t)desc[5] << 8U));
+
+            if ((desc[2] & BSP_USBH_EP_IN) != 0U)
+            {
+                device->bulk_in = desc[2];
+                *in_packet      = packet;
+            }
+            else
+            {
+                device->bulk_out = desc[2];
+                *out_packet      = packet;
+            }
+        }
+        else
+        {
+            /* Other descriptors are skipped */
+        }
+
+        if ((device->bulk_in != 0U) && (device->bulk_out != 0U))
+        {
+            return true;
+        }
+        offset = (uint16_t)(offset + desc[0]);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Address and configure the device, open its bulk pipes
+ */
+static bsp_error_t msc_enumerate(usb_msc_device_t *device)
+{
+    uint16_t    length     = 0U;
+    uint16_t    in_packet  = 0U;
+    uint16_t    out_packet = 0U;
+    uint8_t     configuration = 0U;
+    bsp_error_t status;
+
+    status = BSP_USBH_ResetPort();
+
+    /* The first 8 bytes of the device descriptor hold the EP0 size */
+    if (status == BSP_OK)
+    {
+        status = msc_get_descriptor(USB_DESC_DEVICE, 8U, &length);
+    }
+    if ((status == BSP_OK) && (length < 8U))
+    {
+        status = BSP_ERROR;
+    }
+    if (status == BSP_OK)
+    {
+        uint8_t ep0_size = s_buffer[7];
+
+        status = BSP_USBH_OpenControl(0U, ep0_size);
+        if (status == BSP_OK)
+        {
+            status = msc_request(0x00U, USB_REQ_SET_ADDRESS, USB_MSC_ADDRESS,
+                                 0U);
+        }
+        if (status == BSP_OK)
+        {
+            /* SET_ADDRESS recovery interval */
+            vTaskDelay(pdMS_TO_TICKS(10U));
+            status = BSP_USBH_OpenControl(USB_MSC_ADDRESS, ep0_size);
+        }
+    }
+
+    /* Configuration header first for the total length, then all of it */
+    if (status == BSP_OK)
+    {
+        status = msc_get_descriptor(USB_DESC_CONFIGURATION, 9U, &length);
+    }
+    if (status == BSP_OK)
+    {
+        uint16_t total = (uint16_t)(s_buffer[2] | ((uint16_t)s_buffer[3] << 8U));
+
+        configuration = s_buffer[5];
+        if (total > USB_MSC_CONFIG_SIZE)
+        {
+            total = USB_MSC_CONFIG_SIZE;
+        }
+        status = msc_get_descriptor(USB_DESC_CONFIGURATION, total, &length);
+    }
+    if (status != BSP_OK)
+    {
+        return status;
+    }
+    if (!msc_parse_config(length, device, &in_packet, &out_packet))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    status = msc_request(0x00U, USB_REQ_SET_CONFIGURATION, configuration, 0U);
+    if (status == BSP_OK)
+    {
+        status = BSP_USBH_OpenBulk(device->bulk_in, in_packet);
+    }
+    if (status == BSP_OK)
+    {
+        status = BSP_USBH_OpenBulk(device->bulk_out, out_packet);
+    }
+    return status;
+}
+
+/**
+ * @brief Run READ(10) or WRITE(10) over a range, in command-sized pieces
+ */
+static bsp_error_t msc_transfer(usb_msc_device_t *device, uint8_t opcode,
+                                uint32_t lba, uint32_t count, uint8_t *data)
+{
+    if ((data == NULL) || (lba > device->block_count) ||
+        (count > (device->block_count - lba)))
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    while (count != 0U)
+    {
+        uint32_t    blocks = (count < USB_MSC_MAX_BLOCKS_PER_COMMAND)
+                                 ? count
+                                 : USB_MSC_MAX_BLOCKS_PER_COMMAND;
+        uint8_t     cb[10] = {opcode};
+        bsp_error_t status;
+
+        put_be32(&cb[2], lba);
+        cb[7] = (uint8_t)(blocks >> 8U);
+        cb[8] = (uint8_t)blocks;
+
+        status = msc_scsi(device, cb, sizeof(cb), data,
+                          blocks * USB_MSC_BLOCK_SIZE, opcode == SCSI_READ_10);
+        if ((status == BSP_OK) && (device->residue != 0U))
+        {
+            /* Passed, but not all blocks were moved */
+            status = BSP_ERROR;
+        }
+        if (status != BSP_OK)
+        {
+            return status;
+        }
+
+        lba += blocks;
+        count -= blocks;
+        data = &data[blocks * USB_MSC_BLOCK_SIZE];
+    }
+
+    return BSP_OK;
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+bsp_error_t usb_msc_attach(usb_msc_device_t *device)
+{
+    uint8_t     inquiry[SCSI_INQUIRY_SIZE];
+    uint8_t     capacity[SCSI_CAPACITY_SIZE];
+    uint8_t     cb[10] = {0U};
+    TickType_t  start;
+    bsp_error_t status;
+
+    if (device == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+    (void)memset(device, 0, sizeof(*device));
+
+    status = msc_enumerate(device);
+    if (status != BSP_OK)
+    {
+        return status;
+    }
+
+    /* Some sticks answer nothing else before an INQUIRY */
+    cb[0] = SCSI_INQUIRY;
+    cb[4] = SCSI_INQUIRY_SIZE;
+    status = msc_scsi(device, cb, 6U, inquiry, sizeof(inquiry), true);
+    if (status != BSP_OK)
+    {
+        return status;
+    }
+    printf("USB MSC: %.8s %.16s\n", (const char *)&inquiry[8],
+           (const char *)&inquiry[16]);
+
+    /* The medium reports not ready or a unit attention while it spins up */
+    start = xTaskGetTickCount();
+    (void)memset(cb, 0, sizeof(cb));
+    cb[0] = SCSI_TEST_UNIT_READY;
+    while (msc_scsi(device, cb, 6U, NULL, 0U, false) != BSP_OK)
+    {
+        if (!BSP_USBH_IsConnected())
+        {
+            return BSP_ERROR;
+        }
+        if ((xTaskGetTickCount() - start) >
+            pdMS_TO_TICKS(USB_MSC_READY_TIMEOUT_MS))
+        {
+            return BSP_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(USB_MSC_READY_POLL_MS));
+    }
+
+    cb[0]  = SCSI_READ_CAPACITY;
+    status = msc_scsi(device, cb, 10U, capacity, sizeof(capacity), true);
+    if (status != BSP_OK)
+    {
+        return status;
+    }
+    if (get_be32(&capacity[4]) != USB_MSC_BLOCK_SIZE)
+    {
+        return BSP_INVALID_ARG;
+    }
+
+    /* The last LBA; a medium of 2 TB or more reports 0xFFFFFFFF */
+    device->block_count = get_be32(&capacity[0]);
+    if (device->block_count != 0xFFFFFFFFUL)
+    {
+        device->block_count++;
+    }
+
+    return BSP_OK;
+}
+
+bsp_error_t usb_msc_read(usb_msc_device_t *device, uint32_t lba,
+                         uint32_t count, uint8_t *data)
+{
+    if (device == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+    return msc_transfer(device, SCSI_READ_10, lba, count, data);
+}
+
+bsp_error_t usb_msc_write(usb_msc_device_t *device, uint32_t lba,
+                          uint32_t count, uint8_t *data)
+{
+    if (device == NULL)
+    {
+        return BSP_INVALID_ARG;
+    }
+    return msc_transfer(device, SCSI_WRITE_10, lba, count, data);
+}
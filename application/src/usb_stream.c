@@ -0,0 +1,790 @@
+/*
+ * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems
+ * All rights reserved.
+ *
+ * ADC Waveform Streaming over USB
+ *
+ * The capture task fills the block buffers in turn and queues each full
+ * one on the bulk endpoint. The port reports the transfers in the order
+ * they were queued, so the buffers are reused in the same order and two
+ * counters tell which are free: blocks queued, counted by the task, and
+ * blocks done, counted by the interrupt. A block is sent once it is full,
+ * once the sample sequence has a gap, or once it has been open for
+ * USB_STREAM_FLUSH_MS. The wire format is described in usb_stream.h.
+ *
+ * The vendor requests and the end of the configuration are served in the
+ * USB interrupt, which only publishes a new stream configuration for the
+ * task, as adc_stream_set_config() does for the UDP stream.
+ */
+
+#include "usb_stream.h"
+
+#if BSP_USBD_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "adc_filter_coefficients.h"
+#include "adc_stream_task.h"
+#include "bsp_sections.h"
+#include "metrics.h"
+#include "ptp.h"
+#include "task.h"
+#include "task_priorities.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Capture task stack, in words */
+#define USB_STREAM_STACK_SIZE 384U
+
+/** Block buffers, one per transfer the port queues */
+#define USB_STREAM_BUFFERS BSP_USBD_QUEUE_DEPTH
+
+/** Ring poll period while streaming, well below the ring's 25.6 ms depth */
+#define USB_STREAM_POLL_MS 2U
+
+/** Configuration poll period while not streaming */
+#define USB_STREAM_IDLE_MS 100U
+
+/** Longest time a partly filled block is held back */
+#define USB_STREAM_FLUSH_MS 20U
+
+/** Samples copied out of the ring per read, at most */
+#define USB_STREAM_READ_CHUNK 32U
+
+/** Bytes per channel in a frame: raw result plus filter output */
+#define USB_STREAM_RAW_SIZE      2U
+#define USB_STREAM_FILTERED_SIZE 4U
+
+/** Bytes per frame of the digital input word */
+#define USB_STREAM_DI_SIZE 2U
+
+/** Channels that exist on ADC1 */
+#define USB_STREAM_CHANNEL_MASK ((1U << BSP_ADC1_NUM_CHANNELS) - 1U)
+
+/** bmRequestType of a vendor request to the device, IN bit aside */
+#define USB_STREAM_REQ_VENDOR_DEVICE 0x40U
+
+/** Fields of bmRequestType compared with it */
+#define USB_STREAM_REQ_TYPE_MASK 0x7FU
+
+/** wIndex of the MS OS 2.0 descriptor set request */
+#define USB_STREAM_MS_OS_INDEX 7U
+
+/** String descriptor indexes */
+#define USB_STREAM_STRING_MANUFACTURER 1U
+#define USB_STREAM_STRING_PRODUCT      2U
+#define USB_STREAM_STRING_COUNT        3U
+
+/** Strings of the device descriptor */
+#define USB_STREAM_MANUFACTURER "Advance Instrumentation 'n' Control Systems"
+#define USB_STREAM_PRODUCT      "Jerry ADC Stream"
+
+/** Size of a string descriptor of an ASCII string literal */
+#define USB_STREAM_STRING_SIZE(text) (2U + (2U * (sizeof(text) - 1U)))
+
+_Static_assert(BSP_ADC1_NUM_CHANNELS <= 8U,
+               "channel mask field is 8 bits wide");
+_Static_assert(USB_STREAM_STRING_SIZE(USB_STREAM_MANUFACTURER) <= 255U,
+               "string descriptor too long");
+
+/* ==========================================================================
+ * Private Types
+ * ========================================================================== */
+
+/**
+ * @brief Stream configuration set by the host
+ */
+typedef struct
+{
+    bool    enable;       /**< Stream samples */
+    uint8_t content;      /**< ADC_STREAM_FLAG_RAW, _FILTERED and/or _DI */
+    uint8_t channel_mask; /**< Streamed channels (bit 0 = A0) */
+    bool    decimated;    /**< Stream the decimated instead of the full ring */
+} usb_stream_config_t;
+
+/**
+ * @brief Capture task state
+ *
+ * Owned by the capture task; only the pending configuration and the
+ * counters of the interrupt are shared.
+ */
+typedef struct
+{
+    usb_stream_config_t config;         /**< Active configuration */
+    bsp_adc1_reader_t   reader;         /**< Ring cursor */
+    uint32_t            generation;     /**< Configuration generation applied */
+    uint32_t            block_sequence; /**< Sequence of next block */
+    uint32_t            queued;         /**< Blocks queued on the port */
+    uint32_t            dropped;        /**< Samples of blocks not queued */
+    uint16_t            frame_size;     /**< Bytes per frame */
+    uint16_t            max_frames;     /**< Frames per full block */
+    uint16_t            sequence_step;  /**< Sequence step between frames */
+    uint8_t             flags;          /**< ADC_STREAM_FLAG_* for header */
+    uint8_t             channel_count;  /**< Channels in the mask */
+
+    /* Block being filled, block is NULL if none */
+    uint8_t   *block;          /**< Buffer holding the block */
+    uint8_t   *write;          /**< Next frame position in the block */
+    uint16_t   frame_count;    /**< Frames stored so far */
+    uint32_t   first_sequence; /**< Sample sequence of the first frame */
+    uint32_t   next_sequence;  /**< Sequence expected for the next frame */
+    uint32_t   lost;           /**< Samples lost before the first frame */
+    TickType_t opened;         /**< Tick count when the first frame went in */
+} usb_stream_state_t;
+
+/* ==========================================================================
+ * Private Variables
+ * ========================================================================== */
+
+/** Device descriptor, USB 2.1 for the BOS descriptor */
+static const uint8_t s_device_desc[18] = {
+    18U, 0x01U, 0x10U, 0x02U, /* bLength, DEVICE, bcdUSB 2.10 */
+    0x00U, 0x00U, 0x00U,      /* Class per interface */
+    BSP_USBD_MAX_PACKET,      /* bMaxPacketSize0 */
+    (uint8_t)(USB_STREAM_VENDOR_ID & 0xFFU),
+    (uint8_t)(USB_STREAM_VENDOR_ID >> 8U),
+    (uint8_t)(USB_STREAM_PRODUCT_ID & 0xFFU),
+    (uint8_t)(USB_STREAM_PRODUCT_ID >> 8U),
+    0x00U, 0x01U,                   /* bcdDevice 1.00 */
+    USB_STREAM_STRING_MANUFACTURER, /* iManufacturer */
+    USB_STREAM_STRING_PRODUCT,      /* iProduct */
+    0x00U,                          /* No serial number */
+    0x01U,                          /* bNumConfigurations */
+};
+
+/** Configuration, interface and endpoint descriptors */
+static const uint8_t s_configuration_desc[25] = {
+    /* Configuration 1, self-powered, 2 mA from the bus */
+    9U, 0x02U, 25U, 0x00U, 0x01U, 0x01U, 0x00U, 0xC0U, 0x01U,
+    /* Interface 0, one endpoint, vendor-specific */
+    9U, 0x04U, 0x00U, 0x00U, 0x01U, 0xFFU, 0x00U, 0x00U, 0x00U,
+    /* Bulk IN endpoint */
+    7U, 0x05U, BSP_USBD_EP_BULK_IN, 0x02U, BSP_USBD_MAX_PACKET, 0x00U, 0x00U,
+};
+
+/** MS OS 2.0 descriptor set: the whole device is WinUSB */
+static const uint8_t s_ms_os_desc[30] = {
+    /* Set header, Windows 8.1 and later, wTotalLength */
+    10U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x03U, 0x06U, 30U, 0x00U,
+    /* Compatible ID "WINUSB" */
+    20U, 0x00U, 0x03U, 0x00U, 'W', 'I', 'N', 'U', 'S', 'B', 0x00U, 0x00U,
+    0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U,
+};
+
+/** BOS descriptor with the MS OS 2.0 platform capability */
+static const uint8_t s_bos_desc[33] = {
+    5U, 0x0FU, 33U, 0x00U, 0x01U,
+    /* Platform capability, MS OS 2.0 UUID
+     * {D8DD60DF-4589-4CC7-9CD2-659D9E648A9F} */
+    28U, 0x10U, 0x05U, 0x00U, 0xDFU, 0x60U, 0xDDU, 0xD8U, 0x89U, 0x45U,
+    0xC7U, 0x4CU, 0x9CU, 0xD2U, 0x65U, 0x9DU, 0x9EU, 0x64U, 0x8AU, 0x9FU,
+    /* Windows 8.1, descriptor set length, vendor code, no alternate */
+    0x00U, 0x00U, 0x03U, 0x06U, (uint8_t)sizeof(s_ms_os_desc), 0x00U,
+    USB_STREAM_REQ_MS_OS, 0x00U,
+};
+
+/** Language IDs: US English */
+static const uint8_t s_language_desc[4] = {4U, 0x03U, 0x09U, 0x04U};
+
+/** String descriptors, built from the ASCII strings at start */
+static uint8_t s_manufacturer_desc[USB_STREAM_STRING_SIZE(
+    USB_STREAM_MANUFACTURER)];
+static uint8_t s_product_desc[USB_STREAM_STRING_SIZE(USB_STREAM_PRODUCT)];
+
+static const uint8_t *const s_strings[USB_STREAM_STRING_COUNT] = {
+    s_language_desc,
+    s_manufacturer_desc,
+    s_product_desc,
+};
+
+/** Forward declarations of the port callbacks, for s_usbd_config */
+static int32_t usb_stream_request(const bsp_usbh_setup_t *setup,
+                                  const uint8_t         **data);
+static void    usb_stream_configured(bool configured);
+static void    usb_stream_transmitted(const uint8_t *data, bool sent);
+
+static const bsp_usbd_config_t s_usbd_config = {
+    .device        = s_device_desc,
+    .configuration = s_configuration_desc,
+    .bos           = s_bos_desc,
+    .strings       = s_strings,
+    .string_count  = USB_STREAM_STRING_COUNT,
+    .request       = usb_stream_request,
+    .configured    = usb_stream_configured,
+    .transmitted   = usb_stream_transmitted,
+};
+
+/** Configuration waiting to be applied by the capture task */
+static usb_stream_config_t s_pending_config = {
+    .enable       = false,
+    .content      = ADC_STREAM_FLAG_RAW | ADC_STREAM_FLAG_FILTERED,
+    .channel_mask = (uint8_t)USB_STREAM_CHANNEL_MASK,
+    .decimated    = false,
+};
+
+/** Incremented on every configuration change by the host */
+static volatile uint32_t s_config_generation = 0U;
+
+/** Blocks the port is done with, sent or dropped (USB interrupt) */
+static volatile uint32_t s_done = 0U;
+
+/** Blocks sent (USB interrupt) */
+static volatile uint32_t s_sent = 0U;
+
+/** Samples of blocks dropped by a bus reset (USB interrupt) */
+static volatile uint32_t s_reset_lost = 0U;
+
+/** Published by the capture task for USB_STREAM_REQ_INFO */
+static volatile bool     s_streaming = false;
+static volatile uint32_t s_lost      = 0U;
+
+/** Reply of USB_STREAM_REQ_INFO */
+static uint8_t s_info[USB_STREAM_INFO_SIZE];
+
+/** Block buffers, read by the USB interrupt while queued */
+static uint8_t s_blocks[USB_STREAM_BUFFERS][USB_STREAM_BLOCK_SIZE]
+    __attribute__((aligned(4)));
+
+/** Samples copied out of the ring, kept off the task stack */
+static bsp_adc1_sample_t s_chunk[USB_STREAM_READ_CHUNK];
+
+/** Capture task state */
+static usb_stream_state_t s_stream;
+
+static StaticTask_t s_task_tcb;
+static StackType_t  s_task_stack[USB_STREAM_STACK_SIZE] BSP_SECTION_STACK;
+
+/* ==========================================================================
+ * Private Functions
+ * ========================================================================== */
+
+/**
+ * @brief Store a 16-bit value little-endian
+ */
+static uint8_t *put_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFU);
+    dst[1] = (uint8_t)((value >> 8U) & 0xFFU);
+    return &dst[2];
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static uint8_t *put_u32(uint8_t *dst, uint32_t value)
+{
+    dst = put_u16(dst, (uint16_t)(value & 0xFFFFU));
+    return put_u16(dst, (uint16_t)(value >> 16U));
+}
+
+/**
+ * @brief Store a 64-bit value little-endian
+ */
+static uint8_t *put_u64(uint8_t *dst, uint64_t value)
+{
+    dst = put_u32(dst, (uint32_t)(value & 0xFFFFFFFFU));
+    return put_u32(dst, (uint32_t)(value >> 32U));
+}
+
+/**
+ * @brief Build a string descriptor from an ASCII string
+ *
+ * @param[out] desc Descriptor of 2 + 2 * strlen(text) bytes
+ * @param[in]  text String
+ */
+static void usb_stream_string(uint8_t *desc, const char *text)
+{
+    const size_t length = strlen(text);
+
+    desc[0] = (uint8_t)(2U + (2U * length));
+    desc[1] = 0x03U;
+    for (size_t i = 0U; i < length; i++)
+    {
+        /* UTF-16LE */
+        desc[2U + (2U * i)] = (uint8_t)text[i];
+        desc[3U + (2U * i)] = 0U;
+    }
+}
+
+/**
+ * @brief Publish a stream configuration for the capture task (ISR)
+ */
+static void usb_stream_publish(bool enable, uint8_t content, uint8_t mask,
+                               bool decimated)
+{
+    s_pending_config.enable       = enable;
+    s_pending_config.content      = content;
+    s_pending_config.channel_mask = mask;
+    s_pending_config.decimated    = decimated;
+    s_config_generation++;
+}
+
+/**
+ * @brief Serve a vendor request (USB interrupt)
+ */
+static int32_t usb_stream_request(const bsp_usbh_setup_t *setup,
+                                  const uint8_t         **data)
+{
+    const bool in = (setup->request_type & BSP_USBH_EP_IN) != 0U;
+    uint8_t   *info;
+
+    if ((setup->request_type & USB_STREAM_REQ_TYPE_MASK) !=
+        USB_STREAM_REQ_VENDOR_DEVICE)
+    {
+        return -1;
+    }
+
+    switch (setup->request)
+    {
+    case USB_STREAM_REQ_START:
+        if (in)
+        {
+            return -1;
+        }
+        usb_stream_publish(true, (uint8_t)(setup->value >> 8U),
+                           (uint8_t)(setup->value & 0xFFU),
+                           (setup->index & USB_STREAM_START_DECIMATED) != 0U);
+        return 0;
+
+    case USB_STREAM_REQ_STOP:
+        if (in)
+        {
+            return -1;
+        }
+        usb_stream_publish(false, s_pending_config.content,
+                           s_pending_config.channel_mask,
+                           s_pending_config.decimated);
+        return 0;
+
+    case USB_STREAM_REQ_INFO:
+        if (!in)
+        {
+            return -1;
+        }
+        info    = s_info;
+        info[0] = (uint8_t)BSP_ADC1_NUM_CHANNELS;
+        info[1] = s_streaming ? 1U : 0U;
+        info    = put_u16(&info[2], (uint16_t)USB_STREAM_BLOCK_SIZE);
+        info    = put_u32(info, BSP_ADC1_GetSampleRate());
+        info    = put_u16(info, (uint16_t)ADC_FILTER_DECIMATION_FACTOR);
+        info    = put_u16(info, 0U);
+        info    = put_u32(info, s_sent);
+        (void)put_u32(info, s_lost);
+        *data = s_info;
+        return (int32_t)sizeof(s_info);
+
+    case USB_STREAM_REQ_MS_OS:
+        if (!in || (setup->index != USB_STREAM_MS_OS_INDEX))
+        {
+            return -1;
+        }
+        *data = s_ms_os_desc;
+        return (int32_t)sizeof(s_ms_os_desc);
+
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief The host configured the device or left it (USB interrupt)
+ *
+ * A host that goes away resets the bus; the stream stops with it, so the
+ * next host starts it afresh.
+ */
+static void usb_stream_configured(bool configured)
+{
+    if (!configured && s_pending_config.enable)
+    {
+        usb_stream_publish(false, s_pending_config.content,
+                           s_pending_config.channel_mask,
+                           s_pending_config.decimated);
+    }
+}
+
+/**
+ * @brief The port is done with a block (USB interrupt)
+ *
+ * The frames of a dropped block are counted from its header.
+ */
+static void usb_stream_transmitted(const uint8_t *data, bool sent)
+{
+    if (sent)
+    {
+        s_sent++;
+    }
+    else
+    {
+        const uint32_t frames = (uint32_t)data[6] | ((uint32_t)data[7] << 8U);
+
+        s_reset_lost += frames;
+        metrics_add(METRIC_USB_STREAM_LOST, frames);
+    }
+    s_done++;
+}
+
+/**
+ * @brief Check whether a configuration produces any blocks
+ */
+static bool usb_stream_is_active(const usb_stream_config_t *config)
+{
+    return config->enable && (config->content != 0U) &&
+           (config->channel_mask != 0U);
+}
+
+/**
+ * @brief Samples lost before the next frame: ring overruns and blocks that
+ * never reached the host
+ */
+static uint32_t usb_stream_lost(const usb_stream_state_t *state)
+{
+    return state->reader.overruns + state->dropped + s_reset_lost;
+}
+
+/**
+ * @brief Pick up a configuration published by the host
+ *
+ * Derives the frame layout and restarts the ring reader, so streaming
+ * starts at the newest sample. A block being filled is discarded.
+ */
+static void usb_stream_apply_config(usb_stream_state_t *state)
+{
+    uint32_t generation = s_config_generation;
+    uint8_t  mask;
+    uint16_t channel_size = 0U;
+
+    if (generation == state->generation)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    generation    = s_config_generation;
+    state->config = s_pending_config;
+    taskEXIT_CRITICAL();
+
+    state->generation  = generation;
+    state->block       = NULL;
+    state->frame_count = 0U;
+
+    mask = state->config.channel_mask & (uint8_t)USB_STREAM_CHANNEL_MASK;
+    state->config.channel_mask = mask;
+    state->config.content &= (uint8_t)(ADC_STREAM_FLAG_RAW |
+                                       ADC_STREAM_FLAG_FILTERED |
+                                       ADC_STREAM_FLAG_DI);
+
+    state->channel_count = 0U;
+    for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+    {
+        if ((mask & (1U << ch)) != 0U)
+        {
+            state->channel_count++;
+        }
+    }
+
+    if ((state->config.content & ADC_STREAM_FLAG_RAW) != 0U)
+    {
+        channel_size += USB_STREAM_RAW_SIZE;
+    }
+    if ((state->config.content & ADC_STREAM_FLAG_FILTERED) != 0U)
+    {
+        channel_size += USB_STREAM_FILTERED_SIZE;
+    }
+
+    state->frame_size = (uint16_t)(state->channel_count * channel_size);
+    if ((state->config.content & ADC_STREAM_FLAG_DI) != 0U)
+    {
+        state->frame_size += USB_STREAM_DI_SIZE;
+    }
+    state->max_frames =
+        (state->frame_size == 0U)
+            ? 0U
+            : (uint16_t)((USB_STREAM_BLOCK_SIZE - ADC_STREAM_HEADER_SIZE) /
+                         state->frame_size);
+    state->flags = state->config.content;
+
+    if (state->config.decimated)
+    {
+        state->flags |= ADC_STREAM_FLAG_DECIMATED;
+        state->sequence_step = (uint16_t)ADC_FILTER_DECIMATION_FACTOR;
+        (void)BSP_ADC1_RingReaderInit(&state->reader,
+                                      BSP_ADC1_STREAM_DECIMATED);
+    }
+    else
+    {
+        state->sequence_step = 1U;
+        (void)BSP_ADC1_RingReaderInit(&state->reader, BSP_ADC1_STREAM_FULL);
+    }
+
+    s_streaming = usb_stream_is_active(&state->config) &&
+                  (state->max_frames > 0U);
+    if (s_streaming)
+    {
+        printf("USB stream: %u channel(s), %u frames of %u bytes\n",
+               (unsigned int)state->channel_count,
+               (unsigned int)state->max_frames,
+               (unsigned int)state->frame_size);
+    }
+    else
+    {
+        printf("USB stream: stopped\n");
+    }
+}
+
+/**
+ * @brief Fill in the header and queue the block being filled
+ *
+ * A block the port does not take, once the host has left, still consumes
+ * a block sequence number, so a receiver sees it as lost.
+ */
+static void usb_stream_send(usb_stream_state_t *state)
+{
+    uint8_t *hdr   = state->block;
+    uint64_t time  = 0U;
+    uint8_t  flags = state->flags;
+
+    if (ptp_is_locked() &&
+        (BSP_ADC1_GetSampleTimeNs(state->first_sequence, &time) == BSP_OK))
+    {
+        flags |= ADC_STREAM_FLAG_TIME_VALID | ADC_STREAM_FLAG_TIME_PTP;
+#if BSP_ADC1_SYNC
+        if (BSP_ADC1_IsTriggerSynced())
+        {
+            flags |= ADC_STREAM_FLAG_TIME_ALIGNED;
+        }
+#endif
+    }
+    else if (BSP_ADC1_GetSampleTime(state->first_sequence, &time) == BSP_OK)
+    {
+        flags |= ADC_STREAM_FLAG_TIME_VALID;
+    }
+
+    hdr    = put_u16(hdr, ADC_STREAM_MAGIC);
+    hdr[0] = (uint8_t)ADC_STREAM_VERSION;
+    hdr[1] = flags;
+    hdr[2] = state->config.channel_mask;
+    hdr[3] = state->channel_count;
+    hdr    = put_u16(&hdr[4], state->frame_count);
+    hdr    = put_u32(hdr, state->block_sequence);
+    hdr    = put_u32(hdr, state->first_sequence);
+    hdr    = put_u16(hdr, state->sequence_step);
+    hdr    = put_u16(hdr, state->frame_size);
+    hdr    = put_u32(hdr, state->lost);
+    (void)put_u64(hdr, time);
+
+    if (BSP_USBD_Transmit(state->block,
+                          (uint32_t)(state->write - state->block)) == BSP_OK)
+    {
+        state->queued++;
+    }
+    else
+    {
+        state->dropped += state->frame_count;
+        metrics_add(METRIC_USB_STREAM_LOST, state->frame_count);
+    }
+
+    state->block_sequence++;
+    state->block       = NULL;
+    state->frame_count = 0U;
+}
+
+/**
+ * @brief Take the next block buffer
+ *
+ * @return false if every buffer is still queued on the port.
+ */
+static bool usb_stream_open(usb_stream_state_t *state)
+{
+    if ((state->queued - s_done) >= USB_STREAM_BUFFERS)
+    {
+        return false;
+    }
+
+    state->block = s_blocks[state->queued % USB_STREAM_BUFFERS];
+    state->write = state->block + ADC_STREAM_HEADER_SIZE;
+
+    return true;
+}
+
+/**
+ * @brief Append one sample to the block, sending it when needed
+ *
+ * @return false if no buffer was free and the sample was dropped.
+ */
+static bool usb_stream_append(usb_stream_state_t *state,
+                              const bsp_adc1_sample_t *sample)
+{
+    const uint8_t mask = state->config.channel_mask;
+
+    /* Frames in a block are consecutive samples */
+    if ((state->frame_count > 0U) && (sample->sequence != state->next_sequence))
+    {
+        usb_stream_send(state);
+    }
+
+    if ((state->block == NULL) && !usb_stream_open(state))
+    {
+        return false;
+    }
+
+    if (state->frame_count == 0U)
+    {
+        state->first_sequence = sample->sequence;
+        state->lost           = usb_stream_lost(state);
+        state->opened         = xTaskGetTickCount();
+    }
+
+    if ((state->flags & ADC_STREAM_FLAG_RAW) != 0U)
+    {
+        for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+        {
+            if ((mask & (1U << ch)) != 0U)
+            {
+                state->write = put_u16(state->write, sample->raw[ch]);
+            }
+        }
+    }
+
+    if ((state->flags & ADC_STREAM_FLAG_FILTERED) != 0U)
+    {
+        for (uint8_t ch = 0U; ch < BSP_ADC1_NUM_CHANNELS; ch++)
+        {
+            if ((mask & (1U << ch)) != 0U)
+            {
+                uint32_t bits;
+
+                (void)memcpy(&bits, &sample->filtered[ch], sizeof(bits));
+                state->write = put_u32(state->write, bits);
+            }
+        }
+    }
+
+    if ((state->flags & ADC_STREAM_FLAG_DI) != 0U)
+    {
+        state->write = put_u16(
+            state->write,
+            (uint16_t)(sample->di | ((uint16_t)sample->di_edges << 8U)));
+    }
+
+    state->frame_count++;
+    state->next_sequence = sample->sequence + state->sequence_step;
+
+    if (state->frame_count >= state->max_frames)
+    {
+        usb_stream_send(state);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Move the ring samples into blocks while a buffer is free
+ *
+ * Reads no more samples than the block being filled has room for, so
+ * that samples are only taken out of the ring once they have a place; a
+ * host that falls behind leaves them in the ring until it overruns.
+ */
+static void usb_stream_drain(usb_stream_state_t *state)
+{
+    uint32_t count = 0U;
+    uint32_t room  = 0U;
+
+    do
+    {
+        uint32_t overruns = state->reader.overruns;
+
+        if ((state->block == NULL) && !usb_stream_open(state))
+        {
+            break;
+        }
+
+        room = (uint32_t)state->max_frames - state->frame_count;
+        if (room > USB_STREAM_READ_CHUNK)
+        {
+            room = USB_STREAM_READ_CHUNK;
+        }
+
+        if (BSP_ADC1_RingRead(&state->reader, s_chunk, room, &count) !=
+            BSP_OK)
+        {
+            return;
+        }
+        metrics_add(METRIC_USB_STREAM_LOST,
+                    state->reader.overruns - overruns);
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            if (!usb_stream_append(state, &s_chunk[i]))
+            {
+                /* A gap sent the block early and no buffer is free: the
+                 * rest of this chunk is lost */
+                state->dropped += count - i;
+                metrics_add(METRIC_USB_STREAM_LOST, count - i);
+                break;
+            }
+        }
+    } while (count == room);
+
+    s_lost = usb_stream_lost(state);
+
+    /* Bound the latency of slow streams */
+    if ((state->frame_count > 0U) &&
+        ((xTaskGetTickCount() - state->opened) >=
+         pdMS_TO_TICKS(USB_STREAM_FLUSH_MS)))
+    {
+        usb_stream_send(state);
+    }
+}
+
+/**
+ * @brief USB stream capture task
+ */
+static void usb_stream_task(void *arg)
+{
+    usb_stream_state_t *state = &s_stream;
+
+    (void)arg;
+
+    if (BSP_USBD_Start(&s_usbd_config) != BSP_OK)
+    {
+        printf("USB stream: device port failed to start\n");
+        vTaskDelete(NULL);
+    }
+
+    printf("USB stream task started\n");
+
+    for (;;)
+    {
+        usb_stream_apply_config(state);
+
+        if (s_streaming && BSP_USBD_IsConfigured())
+        {
+            usb_stream_drain(state);
+            vTaskDelay(pdMS_TO_TICKS(USB_STREAM_POLL_MS));
+        }
+        else
+        {
+            vTaskDelay(pdMS_TO_TICKS(USB_STREAM_IDLE_MS));
+        }
+    }
+}
+
+/* ==========================================================================
+ * Public Functions
+ * ========================================================================== */
+
+void usb_stream_start(void)
+{
+    usb_stream_string(s_manufacturer_desc, USB_STREAM_MANUFACTURER);
+    usb_stream_string(s_product_desc, USB_STREAM_PRODUCT);
+
+    (void)xTaskCreateStatic(usb_stream_task, "UsbStream",
+                            USB_STREAM_STACK_SIZE, NULL, TASK_PRIO_USB_STREAM,
+                            s_task_stack, &s_task_tcb);
+}
+
+#endif /* BSP_USBD_ENABLE */
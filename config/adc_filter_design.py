@@ -5,18 +5,27 @@ ADC Filter Coefficient Generator for Jerry Data Acquisition Firmware.
 This script designs digital filters for ADC signal conditioning:
 - 4th order Butterworth low-pass filter (500Hz cutoff)
 - 10 IIR notch filters for 50Hz mains rejection and harmonics
+- Optional FIR decimator producing a lower-rate output stream
+- Several coefficient banks (mains frequency / LPF cutoff) selectable at
+  run time
+- One set of those banks for each ADC sample rate selectable at run time
+- Optionally, a search for the cheapest LPF order, notch count, notch Q and
+  decimator length that meets a rejection and passband spec (--optimize)
 
-The generated coefficients are formatted for CMSIS-DSP biquad cascade filters.
-Uses Jinja2 templates for C/H file generation.
+The generated coefficients are formatted for CMSIS-DSP biquad cascade filters:
+floating point (DF1/DF2T) plus scaled q31 and q15 sets with a postShift for
+the fixed-point DF1 backends. Uses Jinja2 templates for C/H file generation.
 
 Usage:
     python adc_filter_design.py [--output-dir PATH] [--plot]
+    python adc_filter_design.py --optimize [--rejection DB] [--harmonics N]
 
 Author: Jerry Project
 License: MIT
 """
 
 import argparse
+import math
 import os
 from pathlib import Path
 from typing import List, Tuple, Dict, Any
@@ -32,9 +41,18 @@ except ImportError:
 
 
 # Filter design parameters
-SAMPLE_RATE = 10000  # Hz
+SAMPLE_RATE = 10000  # Hz, the default rate and the one --optimize designs for
+
+# Sample rates selectable at run time (BSP_ADC1_SetSampleRate()), each with
+# its own set of COEFFICIENT_BANKS. Every set has the stages of the default
+# one: notches at or above a rate's Nyquist rate become pass-through stages.
+SAMPLE_RATES = [1000, 5000, 10000, 25000, 50000]  # Hz
+
 LPF_CUTOFF = 500  # Hz
 LPF_ORDER = 4  # 4th order Butterworth
+# Highest LPF cutoff at a rate, as a fraction of it; a bank's cutoff above
+# that is lowered to it (500 Hz to 250 Hz at 1 kHz)
+LPF_MAX_CUTOFF_RATIO = 0.25
 MAINS_FREQ = 50  # Hz
 # Q factor for notch filters - lower values give wider notches but better stability
 # Q=10 gives ~5Hz bandwidth at 50Hz for precise mains rejection
@@ -42,6 +60,70 @@ MAINS_FREQ = 50  # Hz
 NOTCH_Q = 10  # Quality factor for notch filters
 NUM_HARMONICS = 10  # Number of harmonics to reject (50Hz to 500Hz)
 
+# Coefficient banks selectable at run time with adc_filter_select_bank().
+# Bank 0 is the default. Every bank must produce the same number of stages,
+# and the fixed-point banks share one postShift so a switch is a pointer swap.
+COEFFICIENT_BANKS = [
+    {"name": "50HZ_500HZ", "mains_freq": MAINS_FREQ, "lpf_cutoff": LPF_CUTOFF},
+    {"name": "60HZ_500HZ", "mains_freq": 60, "lpf_cutoff": LPF_CUTOFF},
+    {"name": "50HZ_250HZ", "mains_freq": MAINS_FREQ, "lpf_cutoff": 250},
+    {"name": "60HZ_250HZ", "mains_freq": 60, "lpf_cutoff": 250},
+]
+
+# Decimation stage after the cascade (arm_fir_decimate_f32)
+# A factor of 1 disables the stage. The factor must divide the BSP block size.
+DECIMATION_FACTOR = 8  # 10 kHz -> 1.25 kHz output
+DECIMATION_TAPS = 48  # FIR length, at least DECIMATION_FACTOR
+DECIMATION_CUTOFF = LPF_CUTOFF  # Hz, below the output Nyquist rate
+# Highest decimator cutoff at a rate, as a fraction of its output rate; the
+# cutoff is lowered to it at the low rates (500 Hz at 10 kHz)
+DECIMATION_CUTOFF_RATIO = 0.4
+
+# Set of the channels sampled at a low rate (BSP_ADC1_SLOW_CHANNELS): the
+# ADC converts them once per SLOW_SAMPLE_RATE period, and a Butterworth LPF
+# alone filters them, in one bank and without decimation. The mains notches
+# of the other sets would sit above its Nyquist rate.
+SLOW_SAMPLE_RATE = 10  # Hz
+SLOW_LPF_CUTOFF = 1  # Hz
+SLOW_LPF_ORDER = 4
+
+# Fixed-point formats used by the CMSIS-DSP q31/q15 biquad backends
+Q31_BITS = 32
+Q15_BITS = 16
+
+# Default spec for --optimize; the fixed design above meets it
+SPEC_HARMONICS = NUM_HARMONICS  # Mains harmonics to reject
+SPEC_REJECTION_DB = 20.0  # Attenuation at each of them, over the tolerance
+SPEC_MAINS_TOLERANCE = 0.005  # Mains frequency deviation, fraction
+SPEC_PASSBAND_RATIO = 0.5  # Passband edge, fraction of each bank's cutoff
+SPEC_RIPPLE_DB = 3.0  # Attenuation allowed midway between the harmonics
+SPEC_STOPBAND_RATIO = 2.0  # Stopband edge, multiple of each bank's cutoff
+SPEC_STOPBAND_DB = 20.0  # Attenuation at and above the stopband edge
+SPEC_ALIAS_DB = 60.0  # Attenuation of what folds into the decimated passband
+
+# Search space of --optimize
+LPF_ORDERS = range(1, 9)
+NOTCH_Q_CANDIDATES = (5, 8, 10, 12, 15, 20, 25, 30)  # ADC_FILTER_NOTCH_Q is integer
+DECIMATION_TAP_STEP = 4
+DECIMATION_MAX_TAPS = 128
+GRID_POINTS = 512  # Frequencies checked per stopband and alias band
+
+# Cost model. A biquad stage is 5 MACs per sample in every backend; the
+# decimator computes one output per DECIMATION_FACTOR inputs. The cycle
+# figures are estimates for the CMSIS-DSP inner loops on the Cortex-M33;
+# replace them with the jerry_bench adc_filter_block per_op figure divided by
+# the stage count (--cycles-per-stage) once measured.
+MACS_PER_STAGE = 5
+CORE_CLOCK_HZ = 250000000
+NUM_CHANNELS = 6
+CYCLES_PER_STAGE = {
+    "df1_f32": 14.0,
+    "df2t_f32": 12.0,
+    "df1_q31": 16.0,
+    "df1_fast_q15": 9.0,
+}
+CYCLES_PER_DECIMATION_TAP = 2.0
+
 # Template and output paths (relative to this script's directory)
 TEMPLATES_DIR = "templates"
 DEFAULT_OUTPUT_DIR = "../application/dependencies/adc_filter"
@@ -181,30 +263,218 @@ def sos_to_cmsis_coefficients(sos: np.ndarray) -> List[float]:
     return coefficients
 
 
+def stage_dc_gains(coefficients: List[float]) -> List[float]:
+    """
+    DC gain of each stage of a CMSIS-DSP coefficient list.
+
+    adc_filter_warm_start() fills the filter state from these, as if the
+    input had been constant forever.
+
+    Args:
+        coefficients: Coefficients in CMSIS-DSP format, five per stage
+
+    Returns:
+        (b0 + b1 + b2) / (1 + a1 + a2) of every stage, in order
+    """
+    gains = []
+    for i in range(0, len(coefficients), 5):
+        b0, b1, b2, neg_a1, neg_a2 = coefficients[i:i + 5]
+        gains.append((b0 + b1 + b2) / (1.0 - neg_a1 - neg_a2))
+
+    return gains
+
+
+def design_decimation_fir(
+    factor: int, taps: int, cutoff: float, fs: float
+) -> List[float]:
+    """
+    Design the anti-aliasing FIR for the decimation stage.
+
+    A Hamming-windowed sinc low-pass with unity DC gain. The cascade LPF
+    already removes most of the band above the cutoff, so a short FIR is
+    enough to keep aliases out of the decimated stream.
+
+    Args:
+        factor: Decimation factor (output rate = fs / factor)
+        taps: Number of FIR taps
+        cutoff: Cutoff frequency in Hz
+        fs: Sampling frequency in Hz
+
+    Returns:
+        FIR coefficients in CMSIS-DSP order (time reversed, symmetric)
+    """
+    if cutoff >= fs / (2.0 * factor):
+        print(
+            f"Warning: decimator cutoff {cutoff} Hz is above the output "
+            f"Nyquist rate {fs / (2.0 * factor)} Hz"
+        )
+
+    fir = signal.firwin(taps, cutoff, fs=fs, window="hamming")
+
+    return [float(c) for c in fir[::-1]]
+
+
+def decimation_cutoff(sample_rate: int) -> int:
+    """
+    Cutoff of the decimator FIR at a sample rate.
+
+    DECIMATION_CUTOFF, lowered to DECIMATION_CUTOFF_RATIO of the output rate
+    where it would be too close to the output Nyquist rate.
+
+    Args:
+        sample_rate: Sample rate in Hz
+
+    Returns:
+        Cutoff frequency in Hz
+    """
+    return min(
+        DECIMATION_CUTOFF,
+        round(DECIMATION_CUTOFF_RATIO * sample_rate / DECIMATION_FACTOR),
+    )
+
+
 def format_coefficient(coef: float) -> str:
     """Format a coefficient as a C float literal."""
     return f"{coef: .15e}f"
 
 
-def design_complete_filter() -> Tuple[List[float], int, Dict[str, Any], List[Dict[str, Any]]]:
+def compute_post_shift(coefficients: List[float], bits: int) -> int:
+    """
+    Compute the CMSIS-DSP postShift for a fixed-point coefficient set.
+
+    CMSIS-DSP fixed-point biquads take coefficients in [-1, 1) and scale the
+    accumulator back up by 2^postShift. The shift is the smallest one that
+    brings every coefficient into the representable range.
+
+    Args:
+        coefficients: Floating-point coefficients in CMSIS-DSP order
+        bits: Word size of the fixed-point format (32 for q31, 16 for q15)
+
+    Returns:
+        Number of bits the coefficients are scaled down by
+    """
+    limit = (2 ** (bits - 1) - 1) / 2 ** (bits - 1)
+    peak = max(abs(c) for c in coefficients)
+    post_shift = 0
+
+    while peak / 2 ** post_shift > limit:
+        post_shift += 1
+
+    return post_shift
+
+
+def quantize_coefficients(
+    coefficients: List[float], post_shift: int, bits: int
+) -> List[int]:
+    """
+    Scale coefficients by 2^-postShift and round them to fixed point.
+
+    Args:
+        coefficients: Floating-point coefficients in CMSIS-DSP order
+        post_shift: Shift returned by compute_post_shift()
+        bits: Word size of the fixed-point format (32 for q31, 16 for q15)
+
+    Returns:
+        List of integer coefficients, saturated to the symmetric range
+    """
+    full_scale = 2 ** (bits - 1)
+    quantized = []
+
+    for coef in coefficients:
+        value = int(round(coef / 2 ** post_shift * full_scale))
+        quantized.append(max(-(full_scale - 1), min(full_scale - 1, value)))
+
+    return quantized
+
+
+def fixed_point_sections(
+    coefficient_sections: List[Dict[str, Any]],
+    coefficients: List[float],
+    bits: int,
+    post_shift: int,
+) -> List[Dict[str, Any]]:
+    """
+    Build the template sections for a fixed-point coefficient set.
+
+    The q15 CMSIS-DSP biquad expects {b0, 0, b1, b2, a1, a2} per stage (the
+    extra zero lets it use dual 16-bit MACs); q31 uses the float layout.
+
+    Args:
+        coefficient_sections: Floating-point sections (for the comments)
+        coefficients: Floating-point coefficients in CMSIS-DSP order
+        bits: Word size of the fixed-point format (32 for q31, 16 for q15)
+        post_shift: Shift shared by all banks, from compute_post_shift()
+
+    Returns:
+        List of dicts with 'comment' and 'coefficients'
+    """
+    quantized = quantize_coefficients(coefficients, post_shift, bits)
+    sections = []
+
+    for i, section in enumerate(coefficient_sections):
+        b0, b1, b2, a1, a2 = quantized[i * 5 : i * 5 + 5]
+        if bits == Q15_BITS:
+            stage = [b0, 0, b1, b2, a1, a2]
+        else:
+            stage = [b0, b1, b2, a1, a2]
+
+        # Pole radius after quantization must stay inside the unit circle
+        radius_sq = -a2 * 2 ** post_shift / 2 ** (bits - 1)
+        if radius_sq >= 1.0:
+            print(
+                f"Warning: q{bits - 1} {section['comment']} is unstable "
+                "after quantization"
+            )
+
+        sections.append({
+            "comment": section["comment"],
+            "coefficients": [str(c) for c in stage],
+        })
+
+    return sections
+
+
+def design_complete_filter(
+    mains_freq: float,
+    lpf_cutoff: float,
+    lpf_order: int = LPF_ORDER,
+    notch_q: float = NOTCH_Q,
+    num_notches: int = NUM_HARMONICS,
+    sample_rate: int = SAMPLE_RATE,
+) -> Tuple[List[float], int, Dict[str, Any], List[Dict[str, Any]]]:
     """
     Design the complete filter chain (LPF + notch filters).
 
+    The notches sit on the first num_notches harmonics, in order, as
+    adc_filter_retune_mains() expects; a harmonic at or above the Nyquist
+    rate gets a pass-through stage, as there, so the stage count does not
+    depend on the rate. The LPF cutoff is lowered to LPF_MAX_CUTOFF_RATIO
+    of the rate if above it.
+
+    Args:
+        mains_freq: Mains fundamental frequency to notch out, in Hz
+        lpf_cutoff: Low-pass cutoff frequency in Hz
+        lpf_order: Butterworth order of the low-pass filter
+        notch_q: Quality factor of the notch filters
+        num_notches: Number of harmonics to notch out
+        sample_rate: Sample rate the chain is designed for, in Hz
+
     Returns:
         Tuple of (coefficients list, number of stages, design info dict, coefficient sections)
     """
     all_sos = []
     coefficient_sections = []
+    lpf_cutoff = min(lpf_cutoff, round(LPF_MAX_CUTOFF_RATIO * sample_rate))
     design_info = {
-        "sample_rate": SAMPLE_RATE,
-        "lpf_cutoff": LPF_CUTOFF,
-        "lpf_order": LPF_ORDER,
+        "sample_rate": sample_rate,
+        "lpf_cutoff": lpf_cutoff,
+        "lpf_order": lpf_order,
         "notch_frequencies": [],
-        "notch_q": NOTCH_Q,
+        "notch_q": notch_q,
     }
 
     # Design LPF
-    lpf_sos = design_butterworth_lpf(LPF_CUTOFF, SAMPLE_RATE, LPF_ORDER)
+    lpf_sos = design_butterworth_lpf(lpf_cutoff, sample_rate, lpf_order)
     all_sos.append(lpf_sos)
     design_info["lpf_stages"] = len(lpf_sos)
 
@@ -224,27 +494,38 @@ def design_complete_filter() -> Tuple[List[float], int, Dict[str, Any], List[Dic
         })
 
     # Design notch filters for each harmonic
-    for harmonic in range(1, NUM_HARMONICS + 1):
-        notch_freq = MAINS_FREQ * harmonic
-        if notch_freq <= SAMPLE_RATE / 2:  # Must be below Nyquist
-            notch_sos = design_notch_filter(notch_freq, SAMPLE_RATE, NOTCH_Q)
-            all_sos.append(notch_sos)
-            design_info["notch_frequencies"].append(notch_freq)
-
-            # Add notch section to coefficient_sections
-            section = notch_sos[0]
-            b0, b1, b2, a0, a1, a2 = section
-            if a0 != 1.0:
-                b0 /= a0
-                b1 /= a0
-                b2 /= a0
-                a1 /= a0
-                a2 /= a0
-            coeffs = [format_coefficient(c) for c in [b0, b1, b2, -a1, -a2]]
+    for harmonic in range(1, num_notches + 1):
+        notch_freq = mains_freq * harmonic
+        if notch_freq >= sample_rate / 2:
+            # Must be below Nyquist: pass-through stage
+            all_sos.append(np.array([[1.0, 0.0, 0.0, 1.0, 0.0, 0.0]]))
+            coeffs = [format_coefficient(c) for c in [1.0, 0.0, 0.0, 0.0, 0.0]]
             coefficient_sections.append({
-                "comment": f"Notch {notch_freq}Hz",
+                "comment": (
+                    f"Pass-through ({notch_freq}Hz at or above Nyquist)"
+                ),
                 "coefficients": coeffs
             })
+            continue
+
+        notch_sos = design_notch_filter(notch_freq, sample_rate, notch_q)
+        all_sos.append(notch_sos)
+        design_info["notch_frequencies"].append(notch_freq)
+
+        # Add notch section to coefficient_sections
+        section = notch_sos[0]
+        b0, b1, b2, a0, a1, a2 = section
+        if a0 != 1.0:
+            b0 /= a0
+            b1 /= a0
+            b2 /= a0
+            a1 /= a0
+            a2 /= a0
+        coeffs = [format_coefficient(c) for c in [b0, b1, b2, -a1, -a2]]
+        coefficient_sections.append({
+            "comment": f"Notch {notch_freq}Hz",
+            "coefficients": coeffs
+        })
 
     # Combine all SOS sections
     combined_sos = np.vstack(all_sos)
@@ -254,11 +535,299 @@ def design_complete_filter() -> Tuple[List[float], int, Dict[str, Any], List[Dic
     coefficients = sos_to_cmsis_coefficients(combined_sos)
 
     design_info["total_stages"] = num_stages
-    design_info["notch_stages"] = len(design_info["notch_frequencies"])
+    design_info["notch_stages"] = num_stages - len(lpf_sos)
 
     return coefficients, num_stages, design_info, coefficient_sections
 
 
+def cmsis_to_sos(coefficients: List[float]) -> np.ndarray:
+    """
+    Convert CMSIS-DSP biquad coefficients back to scipy SOS format.
+
+    Args:
+        coefficients: Coefficients in CMSIS-DSP format, 5 per stage
+
+    Returns:
+        Second-order sections array (n_sections x 6)
+    """
+    stages = np.reshape(np.asarray(coefficients, dtype=float), (-1, 5))
+    sos = np.zeros((len(stages), 6))
+    sos[:, 0:3] = stages[:, 0:3]
+    sos[:, 3] = 1.0
+    sos[:, 4:6] = -stages[:, 3:5]
+
+    return sos
+
+
+def attenuation_db(response: np.ndarray) -> np.ndarray:
+    """Attenuation in dB of a complex frequency response."""
+    return -20.0 * np.log10(np.abs(response) + 1e-12)
+
+
+def spec_frequencies(
+    bank: Dict[str, Any], spec: Dict[str, Any]
+) -> Dict[str, np.ndarray]:
+    """
+    Frequencies at which a coefficient bank is checked against the spec.
+
+    Args:
+        bank: Coefficient bank (mains_freq, lpf_cutoff)
+        spec: Design spec, see search_design()
+
+    Returns:
+        Dict of frequency arrays in Hz:
+        - rejection: each harmonic and both ends of its tolerance band
+        - passband: midpoints between harmonics up to the passband edge
+        - stopband: grid from the stopband edge to Nyquist
+        - alias: grid of what folds into the decimated passband
+    """
+    nyquist = SAMPLE_RATE / 2.0
+    mains = bank["mains_freq"]
+    edge = SPEC_PASSBAND_RATIO * bank["lpf_cutoff"]
+
+    harmonics = [
+        mains * h for h in range(1, spec["harmonics"] + 1)
+        if mains * h < nyquist
+    ]
+    tolerance = spec["mains_tolerance"]
+    rejection = [
+        f * (1.0 + d * tolerance) for f in harmonics for d in (-1.0, 0.0, 1.0)
+    ]
+    passband = [
+        mains * (h + 0.5) for h in range(int(edge / mains) + 1)
+        if mains * (h + 0.5) <= edge
+    ]
+    stop_edge = min(SPEC_STOPBAND_RATIO * bank["lpf_cutoff"], nyquist)
+    alias_edge = max(SAMPLE_RATE / DECIMATION_FACTOR - edge, 0.0)
+
+    return {
+        "rejection": np.array(rejection),
+        "passband": np.array(passband),
+        "stopband": np.linspace(stop_edge, nyquist, GRID_POINTS),
+        "alias": np.linspace(alias_edge, nyquist, GRID_POINTS),
+    }
+
+
+def sos_responses(
+    sos: np.ndarray, freqs: Dict[str, np.ndarray]
+) -> Dict[str, np.ndarray]:
+    """Complex response of second-order sections at each set of frequencies."""
+    return {
+        band: (
+            signal.sosfreqz(sos, worN=f, fs=SAMPLE_RATE)[1]
+            if len(f) else np.zeros(0, dtype=complex)
+        )
+        for band, f in freqs.items()
+    }
+
+
+def cascade_margins(
+    responses: Dict[str, np.ndarray]
+) -> Dict[str, float]:
+    """
+    Worst-case figures of a cascade at the spec frequencies.
+
+    Returns:
+        Dict with the least harmonic rejection, the most passband
+        attenuation and the least stopband attenuation, in dB
+    """
+    return {
+        "rejection": float(
+            np.min(attenuation_db(responses["rejection"]), initial=np.inf)
+        ),
+        "ripple": float(
+            np.max(attenuation_db(responses["passband"]), initial=0.0)
+        ),
+        "stopband": float(
+            np.min(attenuation_db(responses["stopband"]), initial=np.inf)
+        ),
+    }
+
+
+def cascade_meets_spec(margins: Dict[str, float], spec: Dict[str, Any]) -> bool:
+    """Check the figures from cascade_margins() against the spec."""
+    return (
+        margins["rejection"] >= spec["rejection_db"]
+        and margins["ripple"] <= spec["ripple_db"]
+        and margins["stopband"] >= spec["stopband_db"]
+    )
+
+
+def shortest_decimator(
+    responses: List[Dict[str, np.ndarray]],
+    freqs: List[Dict[str, np.ndarray]],
+    spec: Dict[str, Any],
+    cache: Dict[Tuple[int, int], Dict[str, np.ndarray]],
+) -> int:
+    """
+    Find the shortest decimator FIR that meets the spec after every bank.
+
+    The decimated output must keep the alias rejection and, with the FIR's
+    own droop, the passband ripple.
+
+    Args:
+        responses: Cascade responses of each bank, from sos_responses()
+        freqs: Spec frequencies of each bank, from spec_frequencies()
+        spec: Design spec, see search_design()
+        cache: FIR responses by (bank, taps), shared between calls
+
+    Returns:
+        Number of taps, 0 when decimation is disabled, -1 if no length up
+        to DECIMATION_MAX_TAPS meets the spec
+    """
+    if DECIMATION_FACTOR == 1:
+        return 0
+
+    first = -(-DECIMATION_FACTOR // DECIMATION_TAP_STEP) * DECIMATION_TAP_STEP
+    for taps in range(first, DECIMATION_MAX_TAPS + 1, DECIMATION_TAP_STEP):
+        meets = True
+        for index, (response, bank_freqs) in enumerate(zip(responses, freqs)):
+            if (index, taps) not in cache:
+                fir = design_decimation_fir(
+                    DECIMATION_FACTOR, taps, DECIMATION_CUTOFF, SAMPLE_RATE
+                )
+                cache[(index, taps)] = {
+                    band: (
+                        signal.freqz(fir, worN=bank_freqs[band],
+                                     fs=SAMPLE_RATE)[1]
+                        if len(bank_freqs[band])
+                        else np.zeros(0, dtype=complex)
+                    )
+                    for band in ("passband", "alias")
+                }
+            fir_response = cache[(index, taps)]
+
+            alias = np.min(
+                attenuation_db(response["alias"] * fir_response["alias"]),
+                initial=np.inf,
+            )
+            ripple = np.max(
+                attenuation_db(response["passband"] * fir_response["passband"]),
+                initial=0.0,
+            )
+            if alias < spec["alias_db"] or ripple > spec["ripple_db"]:
+                meets = False
+                break
+
+        if meets:
+            return taps
+
+    return -1
+
+
+def design_cost(
+    num_stages: int, decimation_taps: int, cycles_per_stage: float
+) -> Dict[str, float]:
+    """
+    Compute the cost of a design per input sample of one channel.
+
+    Args:
+        num_stages: Number of biquad stages
+        decimation_taps: Decimator FIR length (0 when disabled)
+        cycles_per_stage: Cycles of one biquad stage for the backend
+
+    Returns:
+        Dict with MACs and predicted cycles per sample, and the CPU load in
+        percent for all channels at the sample rate
+    """
+    taps_per_sample = (
+        decimation_taps / DECIMATION_FACTOR if DECIMATION_FACTOR > 1 else 0.0
+    )
+    macs = MACS_PER_STAGE * num_stages + taps_per_sample
+    cycles = (
+        cycles_per_stage * num_stages
+        + CYCLES_PER_DECIMATION_TAP * taps_per_sample
+    )
+    load = cycles * SAMPLE_RATE * NUM_CHANNELS * 100.0 / CORE_CLOCK_HZ
+
+    return {"macs": macs, "cycles": cycles, "load": load}
+
+
+def search_design(spec: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Find the cheapest design that meets the spec in every coefficient bank.
+
+    All banks share one LPF order, notch count and Q, since a bank switch
+    keeps the stage count. For each LPF order and Q the fewest notches that
+    meet the spec are taken, then the shortest decimator FIR. The cost is
+    MACs per input sample; ties go to the most harmonic rejection.
+
+    The spec is a dict with:
+        harmonics: Number of mains harmonics to reject
+        rejection_db: Least attenuation at each harmonic, over the tolerance
+        mains_tolerance: Mains frequency deviation, as a fraction
+        ripple_db: Most attenuation midway between harmonics in the passband
+        stopband_db: Least attenuation above the stopband edge
+        alias_db: Least attenuation of what aliases into the decimated
+            passband
+
+    Args:
+        spec: Design spec
+
+    Returns:
+        Dict with lpf_order, notch_q, num_notches, num_stages,
+        decimation_taps, macs and the worst rejection_db, ripple_db,
+        stopband_db over the banks
+
+    Raises:
+        ValueError: If no design in the search space meets the spec
+    """
+    freqs = [spec_frequencies(bank, spec) for bank in COEFFICIENT_BANKS]
+    fir_cache: Dict[Tuple[int, int], Dict[str, np.ndarray]] = {}
+    best: Dict[str, Any] = {}
+
+    for lpf_order in LPF_ORDERS:
+        for notch_q in NOTCH_Q_CANDIDATES:
+            for num_notches in range(spec["harmonics"] + 1):
+                designs = [
+                    design_complete_filter(
+                        bank["mains_freq"], bank["lpf_cutoff"], lpf_order,
+                        notch_q, num_notches
+                    )
+                    for bank in COEFFICIENT_BANKS
+                ]
+                num_stages = designs[0][1]
+
+                # More notches only cost more
+                if best and MACS_PER_STAGE * num_stages > best["macs"]:
+                    break
+
+                responses = [
+                    sos_responses(cmsis_to_sos(design[0]), bank_freqs)
+                    for design, bank_freqs in zip(designs, freqs)
+                ]
+                margins = [cascade_margins(r) for r in responses]
+                if not all(cascade_meets_spec(m, spec) for m in margins):
+                    continue
+
+                taps = shortest_decimator(responses, freqs, spec, fir_cache)
+                if taps < 0:
+                    continue
+
+                cost = design_cost(num_stages, taps, 0.0)
+                rejection = min(m["rejection"] for m in margins)
+                if not best or (cost["macs"], -rejection) < (
+                    best["macs"], -best["rejection_db"]
+                ):
+                    best = {
+                        "lpf_order": lpf_order,
+                        "notch_q": notch_q,
+                        "num_notches": num_notches,
+                        "num_stages": num_stages,
+                        "decimation_taps": taps,
+                        "macs": cost["macs"],
+                        "rejection_db": rejection,
+                        "ripple_db": max(m["ripple"] for m in margins),
+                        "stopband_db": min(m["stopband"] for m in margins),
+                    }
+                break
+
+    if not best:
+        raise ValueError("no design in the search space meets the spec")
+
+    return best
+
+
 def render_template(
     env: Environment,
     template_name: str,
@@ -300,11 +869,7 @@ def plot_frequency_response(coefficients: List[float], num_stages: int, design_i
         return
 
     # Convert CMSIS coefficients back to SOS for analysis
-    sos = np.zeros((num_stages, 6))
-    for i in range(num_stages):
-        start = i * 5
-        b0, b1, b2, neg_a1, neg_a2 = coefficients[start : start + 5]
-        sos[i] = [b0, b1, b2, 1.0, -neg_a1, -neg_a2]
+    sos = cmsis_to_sos(coefficients[: num_stages * 5])
 
     # Compute frequency response
     w, h = signal.sosfreqz(sos, worN=2000, fs=SAMPLE_RATE)
@@ -358,6 +923,63 @@ def main() -> None:
         action="store_true",
         help="Plot frequency response (requires matplotlib)",
     )
+    parser.add_argument(
+        "--optimize",
+        action="store_true",
+        help="Search for the cheapest design that meets the spec below",
+    )
+    parser.add_argument(
+        "--harmonics",
+        type=int,
+        default=SPEC_HARMONICS,
+        help=f"Mains harmonics to reject (default: {SPEC_HARMONICS})",
+    )
+    parser.add_argument(
+        "--rejection",
+        type=float,
+        default=SPEC_REJECTION_DB,
+        help=f"Rejection at each harmonic in dB (default: {SPEC_REJECTION_DB:g})",
+    )
+    parser.add_argument(
+        "--mains-tolerance",
+        type=float,
+        default=SPEC_MAINS_TOLERANCE,
+        help="Mains frequency deviation the rejection must cover, as a "
+        f"fraction (default: {SPEC_MAINS_TOLERANCE:g})",
+    )
+    parser.add_argument(
+        "--ripple",
+        type=float,
+        default=SPEC_RIPPLE_DB,
+        help=f"Passband attenuation allowed in dB (default: {SPEC_RIPPLE_DB:g})",
+    )
+    parser.add_argument(
+        "--stopband",
+        type=float,
+        default=SPEC_STOPBAND_DB,
+        help="Attenuation above the stopband edge in dB "
+        f"(default: {SPEC_STOPBAND_DB:g})",
+    )
+    parser.add_argument(
+        "--alias-rejection",
+        type=float,
+        default=SPEC_ALIAS_DB,
+        help="Attenuation of what aliases into the decimated passband in dB "
+        f"(default: {SPEC_ALIAS_DB:g})",
+    )
+    parser.add_argument(
+        "--backend",
+        choices=sorted(CYCLES_PER_STAGE),
+        default="df1_f32",
+        help="ADC_FILTER_BACKEND the cycles are predicted for "
+        "(default: df1_f32)",
+    )
+    parser.add_argument(
+        "--cycles-per-stage",
+        type=float,
+        help="Measured cycles of one biquad stage, overriding the backend "
+        "estimate",
+    )
     args = parser.parse_args()
 
     # Get script directory for relative paths
@@ -381,23 +1003,181 @@ def main() -> None:
         lstrip_blocks=True,
     )
 
-    # Design the filter
+    lpf_order = LPF_ORDER
+    notch_q = NOTCH_Q
+    num_notches = NUM_HARMONICS
+    decimation_taps = DECIMATION_TAPS
+    if args.optimize:
+        spec = {
+            "harmonics": args.harmonics,
+            "rejection_db": args.rejection,
+            "mains_tolerance": args.mains_tolerance,
+            "ripple_db": args.ripple,
+            "stopband_db": args.stopband,
+            "alias_db": args.alias_rejection,
+        }
+        print("\nSearching for the cheapest design...")
+        try:
+            best = search_design(spec)
+        except ValueError as e:
+            print(f"Error: {e}")
+            return
+
+        lpf_order = best["lpf_order"]
+        notch_q = best["notch_q"]
+        num_notches = best["num_notches"]
+        decimation_taps = best["decimation_taps"]
+        print(f"  LPF order {lpf_order}, {num_notches} notches at Q "
+              f"{notch_q}, {decimation_taps} decimator taps")
+        print(f"  Worst rejection {best['rejection_db']:.1f} dB, passband "
+              f"{best['ripple_db']:.2f} dB, stopband "
+              f"{best['stopband_db']:.1f} dB")
+
+    # Design every coefficient bank at every sample rate
     print("\nDesigning filters...")
-    coefficients, num_stages, design_info, coefficient_sections = design_complete_filter()
+    if SAMPLE_RATE not in SAMPLE_RATES:
+        print(f"Error: SAMPLE_RATE {SAMPLE_RATE} Hz is not in SAMPLE_RATES")
+        return
+
+    rates = []
+    expected_stages = None
+    for rate_index, sample_rate in enumerate(SAMPLE_RATES):
+        banks = []
+        print(f"  {sample_rate} Hz:")
+        for index, bank in enumerate(COEFFICIENT_BANKS):
+            coefficients, num_stages, design_info, coefficient_sections = (
+                design_complete_filter(
+                    bank["mains_freq"], bank["lpf_cutoff"], lpf_order,
+                    notch_q, num_notches, sample_rate
+                )
+            )
+
+            print(f"    Bank {index} ({bank['name']}):")
+            print(f"      LPF: {design_info['lpf_order']}th order "
+                  f"Butterworth, {design_info['lpf_cutoff']} Hz cutoff")
+            print(f"      LPF Stages: {design_info['lpf_stages']}")
+            print(f"      Notch Frequencies: "
+                  f"{design_info['notch_frequencies']} Hz")
+            print(f"      Notch Q Factor: {design_info['notch_q']}")
+            print(f"      Total Biquad Stages: {num_stages}")
+            print(f"      Total Coefficients: {len(coefficients)}")
+
+            if expected_stages is None:
+                expected_stages = num_stages
+            elif num_stages != expected_stages:
+                print(f"Error: bank {bank['name']} at {sample_rate} Hz has "
+                      f"{num_stages} stages, expected {expected_stages}")
+                return
+
+            banks.append({
+                "index": index,
+                "name": bank["name"],
+                "mains_freq": bank["mains_freq"],
+                "lpf_cutoff": design_info["lpf_cutoff"],
+                "num_stages": num_stages,
+                "design_info": design_info,
+                "coefficients": coefficients,
+                "coefficient_sections": coefficient_sections,
+                "dc_gains": [
+                    format_coefficient(g)
+                    for g in stage_dc_gains(coefficients)
+                ],
+            })
+
+        cutoff = decimation_cutoff(sample_rate)
+        rates.append({
+            "index": rate_index,
+            "sample_rate": sample_rate,
+            "banks": banks,
+            "decimation_cutoff": cutoff,
+            "decimation_coefficients": [
+                format_coefficient(c) for c in design_decimation_fir(
+                    DECIMATION_FACTOR, decimation_taps, cutoff, sample_rate
+                )
+            ],
+        })
+        print(f"    Decimation: /{DECIMATION_FACTOR}, {decimation_taps} "
+              f"taps, {cutoff} Hz cutoff")
+
+    # LPF-only set of the slow channels
+    slow_coefficients, slow_stages, slow_info, slow_sections = (
+        design_complete_filter(
+            MAINS_FREQ, SLOW_LPF_CUTOFF, SLOW_LPF_ORDER, notch_q, 0,
+            SLOW_SAMPLE_RATE
+        )
+    )
+    slow = {
+        "sample_rate": SLOW_SAMPLE_RATE,
+        "lpf_cutoff": slow_info["lpf_cutoff"],
+        "lpf_order": SLOW_LPF_ORDER,
+        "num_stages": slow_stages,
+        "coefficients": slow_coefficients,
+        "coefficient_sections": slow_sections,
+        "dc_gains": [
+            format_coefficient(g) for g in stage_dc_gains(slow_coefficients)
+        ],
+    }
+    print(f"  Slow channels: {SLOW_SAMPLE_RATE} Hz, {slow_stages} LPF "
+          f"stages, {slow['lpf_cutoff']} Hz cutoff")
+
+    # The default bank at the default rate describes the filter in the file
+    # headers and plot
+    default_rate = rates[SAMPLE_RATES.index(SAMPLE_RATE)]
+    banks = default_rate["banks"]
+    coefficients = banks[0]["coefficients"]
+    num_stages = banks[0]["num_stages"]
+    design_info = banks[0]["design_info"]
+
+    # One postShift per format for all banks of all rates, so switching
+    # needs no re-init; the slow set shares it
+    all_coefficients = [
+        c for rate in rates for bank in rate["banks"]
+        for c in bank["coefficients"]
+    ] + slow_coefficients
+    q31_post_shift = compute_post_shift(all_coefficients, Q31_BITS)
+    q15_post_shift = compute_post_shift(all_coefficients, Q15_BITS)
+    for rate in rates:
+        for bank in rate["banks"]:
+            bank["q31_sections"] = fixed_point_sections(
+                bank["coefficient_sections"], bank["coefficients"], Q31_BITS,
+                q31_post_shift
+            )
+            bank["q15_sections"] = fixed_point_sections(
+                bank["coefficient_sections"], bank["coefficients"], Q15_BITS,
+                q15_post_shift
+            )
+    slow["q31_sections"] = fixed_point_sections(
+        slow_sections, slow_coefficients, Q31_BITS, q31_post_shift
+    )
+    slow["q15_sections"] = fixed_point_sections(
+        slow_sections, slow_coefficients, Q15_BITS, q15_post_shift
+    )
+    print(f"  q31 postShift: {q31_post_shift}")
+    print(f"  q15 postShift: {q15_post_shift}")
 
-    print(f"  Sample Rate: {design_info['sample_rate']} Hz")
-    print(f"  LPF: {design_info['lpf_order']}th order Butterworth, {design_info['lpf_cutoff']} Hz cutoff")
-    print(f"  LPF Stages: {design_info['lpf_stages']}")
-    print(f"  Notch Frequencies: {design_info['notch_frequencies']} Hz")
-    print(f"  Notch Q Factor: {design_info['notch_q']}")
-    print(f"  Total Biquad Stages: {num_stages}")
-    print(f"  Total Coefficients: {len(coefficients)}")
+    cycles_per_stage = args.cycles_per_stage or CYCLES_PER_STAGE[args.backend]
+    cost = design_cost(num_stages, decimation_taps, cycles_per_stage)
+    design_info["macs_per_sample"] = f"{cost['macs']:g}"
+    print(f"  Cost: {cost['macs']:g} MACs/sample, {cost['cycles']:.0f} "
+          f"cycles/sample ({args.backend}), {cost['load']:.2f}% CPU for "
+          f"{NUM_CHANNELS} channels at {CORE_CLOCK_HZ / 1e6:g} MHz")
 
     # Prepare template context
     context = {
         "design_info": design_info,
         "num_stages": num_stages,
-        "coefficient_sections": coefficient_sections,
+        "banks": banks,
+        "rates": rates,
+        "slow": slow,
+        "default_rate": default_rate["index"],
+        "max_sample_rate": max(SAMPLE_RATES),
+        "q31_post_shift": q31_post_shift,
+        "q15_post_shift": q15_post_shift,
+        "decimation": {
+            "factor": DECIMATION_FACTOR,
+            "taps": decimation_taps,
+            "cutoff": default_rate["decimation_cutoff"],
+        },
     }
 
     # Generate header file
@@ -76,13 +76,23 @@ function(modbus_generate_code)
     set(GENERATED_HEADER "${MODBUS_GEN_OUTPUT_DIR}/${DEVICE_NAME_LOWER}_registers.h")
     set(GENERATED_SOURCE "${MODBUS_GEN_OUTPUT_DIR}/${DEVICE_NAME_LOWER}_registers.c")
     set(GENERATED_DOC "${CMAKE_BINARY_DIR}/${DEVICE_NAME_LOWER}_register_map.txt")
+    set(GENERATED_PY "${CMAKE_BINARY_DIR}/${DEVICE_NAME_LOWER}_registers.py")
 
     set(ALL_GENERATED_FILES
         ${GENERATED_HEADER}
         ${GENERATED_SOURCE}
         ${GENERATED_DOC}
+        ${GENERATED_PY}
     )
 
+    # CAN database, only for configurations with a "can" section
+    string(JSON CAN_SECTION ERROR_VARIABLE CAN_SECTION_ERROR
+           GET "${CONFIG_CONTENT}" "can")
+    if(NOT CAN_SECTION_ERROR)
+        set(GENERATED_DBC "${CMAKE_BINARY_DIR}/${DEVICE_NAME_LOWER}_can.dbc")
+        list(APPEND ALL_GENERATED_FILES ${GENERATED_DBC})
+    endif()
+
     # Get template files for dependency tracking
     file(GLOB TEMPLATE_FILES "${MODBUS_CODEGEN_TEMPLATES_DIR}/*.j2")
 
@@ -100,6 +110,10 @@ function(modbus_generate_code)
     message(STATUS "    - ${DEVICE_NAME_LOWER}_registers.h")
     message(STATUS "    - ${DEVICE_NAME_LOWER}_registers.c")
     message(STATUS "    - ${DEVICE_NAME_LOWER}_register_map.txt")
+    message(STATUS "    - ${DEVICE_NAME_LOWER}_registers.py")
+    if(GENERATED_DBC)
+        message(STATUS "    - ${DEVICE_NAME_LOWER}_can.dbc")
+    endif()
     message(STATUS "========================================")
     message(STATUS "")
 
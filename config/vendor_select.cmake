@@ -8,6 +8,11 @@ set(BSP_DIR "${CMAKE_SOURCE_DIR}/application/bsp")
 
 if(VENDOR STREQUAL "stm")
     set(CMAKE_TOOLCHAIN_FILE "${BSP_DIR}/toolchain.cmake")
+    set(JERRY_HOST OFF)
+elseif(VENDOR STREQUAL "posix")
+    # Host simulation on the FreeRTOS POSIX port, with the native compiler
+    # (bsp/posix/bsp.c)
+    set(JERRY_HOST ON)
 else()
     message(FATAL_ERROR "Unsupported Vendor: ${VENDOR}")
 endif()
@@ -0,0 +1,611 @@
+#!/usr/bin/env python3
+"""
+Modbus TCP Load Generator
+
+asyncio load for test_modbus_performance.py, shaped like a plant network
+rather than a single polling master:
+
+- N concurrent connections, each with up to a given number of
+  transactions in flight (pipelined, matched by MBAP transaction ID);
+- a weighted mix of function codes, e.g. "fc03=4,fc04=2,fc06=1";
+- closed loop (every connection sends as fast as its responses come back)
+  or open loop (a fixed total request rate, whatever the server does);
+- optional reconnect storms: every connection closes and reopens after a
+  number of requests.
+
+Open-loop latencies are measured from the time a request was scheduled,
+not from when it was sent, so a server that falls behind is not hidden by
+the generator slowing down with it (coordinated omission). Latencies go
+into log-linear histograms in the manner of HdrHistogram, so long runs
+report exact-enough percentiles in constant memory.
+
+Usage (through the performance script):
+    python test_modbus_performance.py --load --connections 4 --depth 8
+    python test_modbus_performance.py --load --rate 2000 --mix fc03=1
+    python test_modbus_performance.py --load --reconnect-every 50 \\
+        --profile BUILD_A --json-out a.json
+
+Copyright (c) 2026
+"""
+
+from __future__ import annotations
+
+import asyncio
+import math
+import random
+import ssl
+import struct
+import time
+from dataclasses import dataclass, field
+from typing import Optional
+
+# Percentiles printed and saved for every histogram
+REPORT_PERCENTILES = (50.0, 90.0, 99.0, 99.9, 99.99, 100.0)
+
+# Default function code mix: mostly polling, some writes
+DEFAULT_MIX = "fc03=4,fc04=2,fc01=1,fc02=1,fc06=1,fc16=1"
+
+# Open-loop requests waiting for a free slot, per connection, before new
+# ones are dropped and counted as failed
+MAX_BACKLOG = 1000
+
+
+class LatencyHistogram:
+    """Log-linear latency histogram in the manner of HdrHistogram.
+
+    Values are recorded in microseconds. Below 2 ** (SUB_BUCKET_BITS + 1)
+    they are exact; above, each power of two is split into
+    2 ** SUB_BUCKET_BITS buckets, a relative precision better than 1 %.
+    """
+
+    SUB_BUCKET_BITS = 7
+
+    def __init__(self) -> None:
+        self.counts: dict[tuple[int, int], int] = {}
+        self.total = 0
+        self.max_us = 0
+
+    def record(self, value_us: float) -> None:
+        """Record one latency."""
+        value = max(0, int(value_us))
+        shift = max(0, value.bit_length() - (self.SUB_BUCKET_BITS + 1))
+        key = (shift, value >> shift)
+        self.counts[key] = self.counts.get(key, 0) + 1
+        self.total += 1
+        self.max_us = max(self.max_us, value)
+
+    def merge(self, other: LatencyHistogram) -> None:
+        """Add the counts of another histogram."""
+        for key, count in other.counts.items():
+            self.counts[key] = self.counts.get(key, 0) + count
+        self.total += other.total
+        self.max_us = max(self.max_us, other.max_us)
+
+    def percentile_ms(self, percentile: float) -> float:
+        """Highest value of the bucket holding the given percentile."""
+        if self.total == 0:
+            return 0.0
+        rank = max(1, math.ceil(self.total * percentile / 100.0))
+        seen = 0
+        for shift, high in sorted(self.counts, key=lambda k: k[1] << k[0]):
+            seen += self.counts[(shift, high)]
+            if seen >= rank:
+                highest = ((high + 1) << shift) - 1
+                return min(highest, self.max_us) / 1000.0
+        return self.max_us / 1000.0
+
+    def since(self, earlier: LatencyHistogram) -> LatencyHistogram:
+        """The values recorded after @p earlier, a copy of this histogram."""
+        window = LatencyHistogram()
+        for key, count in self.counts.items():
+            count -= earlier.counts.get(key, 0)
+            if count > 0:
+                window.counts[key] = count
+                window.total += count
+                shift, high = key
+                window.max_us = max(window.max_us, ((high + 1) << shift) - 1)
+        window.max_us = min(window.max_us, self.max_us)
+        return window
+
+    def copy(self) -> LatencyHistogram:
+        """A copy to take windows from with since()."""
+        other = LatencyHistogram()
+        other.merge(self)
+        return other
+
+    def percentiles(self) -> dict[str, float]:
+        """The REPORT_PERCENTILES, keyed like "p99.9", in ms."""
+        return {
+            f"p{p:g}": self.percentile_ms(p) for p in REPORT_PERCENTILES
+        }
+
+
+@dataclass(frozen=True)
+class Operation:
+    """One request of the mix; addresses are those the other tests use."""
+
+    name: str
+    function: int
+    data: bytes
+
+
+OPERATIONS = {
+    # PWM, ADC, coil and input ranges that are valid on the device
+    "fc01": Operation("fc01", 1, struct.pack(">HH", 0, 16)),
+    "fc02": Operation("fc02", 2, struct.pack(">HH", 0, 8)),
+    "fc03": Operation("fc03", 3, struct.pack(">HH", 0, 12)),
+    "fc04": Operation("fc04", 4, struct.pack(">HH", 0, 4)),
+    "fc05": Operation("fc05", 5, struct.pack(">HH", 0, 0x0000)),
+    "fc06": Operation("fc06", 6, struct.pack(">HH", 0, 5000)),
+    "fc16": Operation(
+        "fc16", 16, struct.pack(">HHBHHH", 0, 3, 6, 5000, 0, 1000)
+    ),
+}
+
+
+def parse_mix(text: str) -> list[tuple[Operation, int]]:
+    """Parse "fc03=4,fc06=1" into operations and weights."""
+    mix = []
+    for item in text.split(","):
+        name, _, weight = item.strip().partition("=")
+        if name not in OPERATIONS:
+            known = ", ".join(sorted(OPERATIONS))
+            raise ValueError(f"unknown operation {name!r} (known: {known})")
+        mix.append((OPERATIONS[name], int(weight) if weight else 1))
+    if not mix or sum(w for _, w in mix) <= 0:
+        raise ValueError("the mix needs at least one positive weight")
+    return mix
+
+
+@dataclass
+class LoadConfig:
+    """Parameters of one load run."""
+
+    host: str
+    port: int
+    unit_id: int = 1
+    connections: int = 4
+    depth: int = 4
+    duration_s: float = 10.0
+    rate: Optional[float] = None
+    mix: str = DEFAULT_MIX
+    reconnect_every: int = 0
+    timeout_s: float = 2.0
+    source_ip: Optional[str] = None
+    seed: int = 1
+
+    @property
+    def name(self) -> str:
+        """Test name, stable across runs for comparison."""
+        pacing = f"{self.rate:g} req/s" if self.rate else "closed loop"
+        storm = (
+            f", reconnect/{self.reconnect_every}"
+            if self.reconnect_every
+            else ""
+        )
+        return (
+            f"Load {self.connections}x{self.depth} {pacing}{storm} "
+            f"[{self.mix}]"
+        )
+
+
+@dataclass
+class LoadStats:
+    """Counters and histograms, per connection and merged."""
+
+    sent: int = 0
+    successful: int = 0
+    exceptions: int = 0
+    timeouts: int = 0
+    errors: int = 0
+    dropped: int = 0
+    connects: int = 0
+    connect_failures: int = 0
+    latency: LatencyHistogram = field(default_factory=LatencyHistogram)
+    connect_time: LatencyHistogram = field(default_factory=LatencyHistogram)
+    by_operation: dict[str, LatencyHistogram] = field(default_factory=dict)
+
+    def record(self, operation: Operation, latency_us: float) -> None:
+        """Record a successful transaction."""
+        self.successful += 1
+        self.latency.record(latency_us)
+        self.by_operation.setdefault(
+            operation.name, LatencyHistogram()
+        ).record(latency_us)
+
+    def merge(self, other: LoadStats) -> None:
+        """Add the counts of another connection."""
+        for name in (
+            "sent",
+            "successful",
+            "exceptions",
+            "timeouts",
+            "errors",
+            "dropped",
+            "connects",
+            "connect_failures",
+        ):
+            setattr(self, name, getattr(self, name) + getattr(other, name))
+        self.latency.merge(other.latency)
+        self.connect_time.merge(other.connect_time)
+        for name, histogram in other.by_operation.items():
+            self.by_operation.setdefault(name, LatencyHistogram()).merge(
+                histogram
+            )
+
+    @property
+    def failed(self) -> int:
+        """Transactions that did not get a valid response."""
+        return self.exceptions + self.timeouts + self.errors + self.dropped
+
+
+@dataclass
+class LoadResult:
+    """Outcome of a load run, as saved for regression comparison."""
+
+    test_name: str
+    config: dict
+    total_time_sec: float
+    sent: int
+    successful: int
+    failed: int
+    exceptions: int
+    timeouts: int
+    dropped: int
+    connects: int
+    connect_failures: int
+    requests_per_second: float
+    latency_ms: dict[str, float]
+    connect_ms: dict[str, float]
+    operations: dict[str, dict[str, float]]
+
+    @property
+    def success_rate(self) -> float:
+        """Success rate in percent of the requests attempted."""
+        attempted = self.successful + self.failed
+        return self.successful * 100.0 / attempted if attempted else 0.0
+
+    def print_report(self) -> None:
+        """Print the load run with its latency percentiles."""
+        print(f"\n{'=' * 60}")
+        print(f"Load Test: {self.test_name}")
+        print(f"{'=' * 60}")
+        print(f"  Sent:                {self.sent}")
+        print(f"  Successful:          {self.successful}")
+        print(f"  Exceptions:          {self.exceptions}")
+        print(f"  Timeouts:            {self.timeouts}")
+        print(f"  Dropped (backlog):   {self.dropped}")
+        print(f"  Success Rate:        {self.success_rate:.2f}%")
+        print(f"  Connects:            {self.connects} "
+              f"({self.connect_failures} failed)")
+        print(f"  Total Time:          {self.total_time_sec:.3f} sec")
+        print(f"  Throughput:          {self.requests_per_second:.2f} req/sec")
+        print("\n  Latency Percentiles (ms):")
+        for name, value in self.latency_ms.items():
+            print(f"    {name:<18} {value:.3f}")
+        if self.connects:
+            print(f"\n  Connect time: p50 {self.connect_ms['p50']:.3f} ms, "
+                  f"p99 {self.connect_ms['p99']:.3f} ms, "
+                  f"max {self.connect_ms['p100']:.3f} ms")
+        print("\n  Per operation (ms):      p50      p99    p99.9")
+        for name, values in sorted(self.operations.items()):
+            print(f"    {name:<18} {values['p50']:>8.3f} "
+                  f"{values['p99']:>8.3f} {values['p99.9']:>8.3f}")
+        print(f"{'=' * 60}")
+
+
+class _Session:
+    """One TCP connection with its in-flight transactions."""
+
+    def __init__(
+        self,
+        reader: asyncio.StreamReader,
+        writer: asyncio.StreamWriter,
+        unit_id: int,
+        depth: int,
+    ) -> None:
+        self.reader = reader
+        self.writer = writer
+        self.unit_id = unit_id
+        self.slots = asyncio.Semaphore(depth)
+        self.pending: dict[int, asyncio.Future] = {}
+        self.transaction = 0
+        self.closed = False
+        self.receiver = asyncio.ensure_future(self._receive())
+
+    async def _receive(self) -> None:
+        """Hand every response to the transaction with its ID."""
+        try:
+            while True:
+                header = await self.reader.readexactly(7)
+                tid, _, length, _ = struct.unpack(">HHHB", header)
+                pdu = await self.reader.readexactly(max(length - 1, 0))
+                future = self.pending.pop(tid, None)
+                if future is not None and not future.done():
+                    future.set_result(pdu)
+        except (asyncio.IncompleteReadError, ConnectionError, OSError) as e:
+            self._fail(e)
+        except asyncio.CancelledError:
+            self._fail(ConnectionError("session closed"))
+            raise
+
+    def _fail(self, error: Exception) -> None:
+        self.closed = True
+        for future in self.pending.values():
+            if not future.done():
+                future.set_exception(ConnectionError(str(error)))
+        self.pending.clear()
+
+    async def transact(
+        self,
+        operation: Operation,
+        stats: LoadStats,
+        timeout_s: float,
+        scheduled: Optional[float] = None,
+    ) -> None:
+        """Run one transaction; latency from @p scheduled if given."""
+        async with self.slots:
+            if self.closed:
+                stats.errors += 1
+                return
+            self.transaction = (self.transaction + 1) & 0xFFFF
+            tid = self.transaction
+            pdu = bytes([operation.function]) + operation.data
+            frame = (
+                struct.pack(">HHHB", tid, 0, len(pdu) + 1, self.unit_id)
+                + pdu
+            )
+            future = asyncio.get_running_loop().create_future()
+            self.pending[tid] = future
+
+            sent = time.perf_counter()
+            stats.sent += 1
+            try:
+                self.writer.write(frame)
+                await self.writer.drain()
+                response = await asyncio.wait_for(future, timeout_s)
+            except asyncio.TimeoutError:
+                self.pending.pop(tid, None)
+                stats.timeouts += 1
+                return
+            except (ConnectionError, OSError):
+                self.pending.pop(tid, None)
+                stats.errors += 1
+                return
+
+            origin = scheduled if scheduled is not None else sent
+            if response and response[0] == operation.function:
+                stats.record(operation, (time.perf_counter() - origin) * 1e6)
+            else:
+                stats.exceptions += 1
+
+    async def close(self) -> None:
+        """Close the connection once the in-flight transactions are done."""
+        self.receiver.cancel()
+        try:
+            await self.receiver
+        except asyncio.CancelledError:
+            pass
+        self.writer.close()
+        try:
+            await self.writer.wait_closed()
+        except (ConnectionError, OSError, ssl.SSLError):
+            pass
+
+
+async def _open(
+    config: LoadConfig, tls: Optional[ssl.SSLContext], stats: LoadStats
+) -> Optional[_Session]:
+    """Connect, timing the TCP (and TLS) handshake."""
+    start = time.perf_counter()
+    try:
+        reader, writer = await asyncio.wait_for(
+            asyncio.open_connection(
+                config.host,
+                config.port,
+                ssl=tls,
+                local_addr=(config.source_ip, 0) if config.source_ip else None,
+            ),
+            config.timeout_s,
+        )
+    except (asyncio.TimeoutError, ConnectionError, OSError, ssl.SSLError):
+        stats.connect_failures += 1
+        return None
+    stats.connects += 1
+    stats.connect_time.record((time.perf_counter() - start) * 1e6)
+    return _Session(reader, writer, config.unit_id, config.depth)
+
+
+async def _closed_loop(
+    session: _Session,
+    config: LoadConfig,
+    choose,
+    stats: LoadStats,
+    deadline: float,
+    budget: int,
+) -> None:
+    """Keep @p config.depth transactions in flight until done."""
+    remaining = [budget]
+
+    async def lane() -> None:
+        while (
+            time.perf_counter() < deadline
+            and not session.closed
+            and remaining[0] != 0
+        ):
+            remaining[0] -= 1
+            await session.transact(choose(), stats, config.timeout_s)
+
+    await asyncio.gather(*(lane() for _ in range(config.depth)))
+
+
+async def _open_loop(
+    session: _Session,
+    config: LoadConfig,
+    choose,
+    stats: LoadStats,
+    deadline: float,
+    budget: int,
+    schedule: list[float],
+    interval: float,
+) -> None:
+    """Start transactions on the schedule, whatever the responses do."""
+    tasks: set[asyncio.Task] = set()
+
+    while schedule[0] < deadline and not session.closed and budget != 0:
+        delay = schedule[0] - time.perf_counter()
+        if delay > 0:
+            await asyncio.sleep(delay)
+        if len(tasks) >= MAX_BACKLOG:
+            stats.dropped += 1
+        else:
+            task = asyncio.ensure_future(
+                session.transact(
+                    choose(), stats, config.timeout_s, scheduled=schedule[0]
+                )
+            )
+            tasks.add(task)
+            task.add_done_callback(tasks.discard)
+        schedule[0] += interval
+        budget -= 1
+
+    if tasks:
+        await asyncio.gather(*tasks)
+
+
+async def _connection(
+    index: int,
+    config: LoadConfig,
+    tls: Optional[ssl.SSLContext],
+    start: float,
+    deadline: float,
+    stats: LoadStats,
+) -> LoadStats:
+    """One master: connect, load, reconnect as configured, until done."""
+    rng = random.Random(config.seed + index)
+    mix = parse_mix(config.mix)
+    operations = [op for op, _ in mix]
+    weights = [w for _, w in mix]
+
+    def choose() -> Operation:
+        return rng.choices(operations, weights)[0]
+
+    interval = config.connections / config.rate if config.rate else 0.0
+    # Connections are staggered over one interval
+    schedule = [start + interval * index / config.connections]
+    budget = config.reconnect_every if config.reconnect_every else -1
+
+    while time.perf_counter() < deadline:
+        session = await _open(config, tls, stats)
+        if session is None:
+            await asyncio.sleep(0.1)
+            continue
+        if config.rate:
+            await _open_loop(
+                session, config, choose, stats, deadline, budget,
+                schedule, interval,
+            )
+        else:
+            await _closed_loop(
+                session, config, choose, stats, deadline, budget
+            )
+        await session.close()
+
+    return stats
+
+
+async def run_connections(
+    config: LoadConfig,
+    tls: Optional[ssl.SSLContext],
+    per_connection: Optional[list[LoadStats]] = None,
+) -> tuple[LoadStats, float]:
+    """Run the connections; @p per_connection lets a caller watch them."""
+    if per_connection is None:
+        per_connection = [LoadStats() for _ in range(config.connections)]
+    start = time.perf_counter()
+    deadline = start + config.duration_s
+    await asyncio.gather(
+        *(
+            _connection(i, config, tls, start, deadline, per_connection[i])
+            for i in range(config.connections)
+        )
+    )
+    stats = LoadStats()
+    for connection_stats in per_connection:
+        stats.merge(connection_stats)
+    return stats, time.perf_counter() - start
+
+
+def run_load(
+    config: LoadConfig, tls: Optional[ssl.SSLContext] = None
+) -> LoadResult:
+    """Run one load test and summarize it."""
+    parse_mix(config.mix)
+    pacing = f"{config.rate:g} req/s" if config.rate else "closed loop"
+    print(f"\nRunning: {config.connections} connections, depth "
+          f"{config.depth}, {pacing}, {config.duration_s:g} s...")
+
+    stats, total_time = asyncio.run(run_connections(config, tls))
+
+    return LoadResult(
+        test_name=config.name,
+        config={
+            "connections": config.connections,
+            "depth": config.depth,
+            "duration_s": config.duration_s,
+            "rate": config.rate,
+            "mix": config.mix,
+            "reconnect_every": config.reconnect_every,
+            "timeout_s": config.timeout_s,
+        },
+        total_time_sec=total_time,
+        sent=stats.sent,
+        successful=stats.successful,
+        failed=stats.failed,
+        exceptions=stats.exceptions,
+        timeouts=stats.timeouts,
+        dropped=stats.dropped,
+        connects=stats.connects,
+        connect_failures=stats.connect_failures,
+        requests_per_second=(
+            stats.successful / total_time if total_time else 0.0
+        ),
+        latency_ms=stats.latency.percentiles(),
+        connect_ms=stats.connect_time.percentiles(),
+        operations={
+            name: histogram.percentiles()
+            for name, histogram in stats.by_operation.items()
+        },
+    )
+
+
+def print_load_comparison(runs: list[tuple[str, list[dict]]]) -> None:
+    """Print saved load runs of several builds side by side.
+
+    Args:
+        runs: (profile, saved LoadResult dicts) per build, first the base
+    """
+    names: list[str] = []
+    for _, results in runs:
+        for result in results:
+            if result["test_name"] not in names:
+                names.append(result["test_name"])
+    if not names:
+        return
+
+    print("\n" + "=" * 80)
+    print("LOAD COMPARISON (req/s | p50 ms | p99 ms | p99.9 ms)")
+    print("=" * 80)
+    for name in names:
+        print(name)
+        for profile, results in runs:
+            match = [r for r in results if r["test_name"] == name]
+            if not match:
+                print(f"  {profile:<20} -")
+                continue
+            r = match[0]
+            lat = r["latency_ms"]
+            print(f"  {profile:<20} {r['requests_per_second']:>9.1f} | "
+                  f"{lat['p50']:>8.3f} | {lat['p99']:>8.3f} | "
+                  f"{lat['p99.9']:>8.3f}   ({r['failed']} failed)")
+    print("=" * 80)
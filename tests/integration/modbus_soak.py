@@ -0,0 +1,540 @@
+#!/usr/bin/env python3
+"""
+Modbus TCP Soak Test
+
+Long runs of the load generator for test_modbus_performance.py --soak,
+hours to days, to catch what only shows after a while: a pbuf pool that
+gives back one buffer less per hour, netconns left behind by reconnects,
+a stack that keeps getting deeper, latency that creeps up.
+
+Every sample interval the device's telemetry frame (application/inc/
+telemetry.h) is read with FC20 on a connection of its own, and the load
+counters are taken, without stopping the load. Each sample holds
+
+- lwIP heap and pool use, sys_arch pools (with JERRY_LWIP_PROFILE builds),
+  the stack high water mark of every task and the metrics.h counters;
+- the device latency of each transport and function code group, and the
+  host latency of the load, over the last interval only.
+
+Samples are written to a JSON lines file (--soak-log) as they are taken, so the
+trends of a run that was stopped or crashed can still be computed from it
+(--soak-report). After the warm-up, each series is split into quarters:
+
+- a resource (pool or heap in use, stack high water mark) grows when the
+  mean of every quarter is beyond that of the one before and the fitted
+  trend moves it by --growth percent, and by one element or word at least;
+- a latency drifts when its quarters rise the same way by --drift percent;
+- an error counter is flagged when it counts faster at the end than at the
+  start.
+
+A restart of the device (its uptime going back) is always flagged.
+
+Usage (through the performance script):
+    python test_modbus_performance.py --soak --duration 86400 \\
+        --soak-log soak.jsonl --json-out soak.json
+    python test_modbus_performance.py --soak --duration 172800 --rate 500 \\
+        --soak-interval 300 --soak-warmup 1800
+    python test_modbus_performance.py --soak-report soak.jsonl
+
+Copyright (c) 2026
+"""
+
+from __future__ import annotations
+
+import asyncio
+import json
+import ssl
+import statistics
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Optional
+
+from modbus_load import (
+    LatencyHistogram,
+    LoadConfig,
+    LoadStats,
+    parse_mix,
+    run_connections,
+)
+
+# The telemetry decoder of tools/
+sys.path.insert(0, str(Path(__file__).resolve().parents[2] / "tools"))
+
+from telemetry_decoder import (  # noqa: E402
+    FC_GROUP_NAMES,
+    METRIC_NAMES,
+    NAME_SIZE,
+    SECTION_LATENCY,
+    SECTION_LWIP_MEM,
+    SECTION_LWIP_MEMP,
+    SECTION_METRICS,
+    SECTION_SYS_POOLS,
+    SECTION_TASKS,
+    STAGE_NAMES,
+    SYS_POOL_ENTRY,
+    TRANSPORT_NAMES,
+    FileRecordClient,
+    Frame,
+    FrameError,
+    read_modbus,
+)
+
+# Defaults of the soak options
+DEFAULT_INTERVAL_S = 60.0
+DEFAULT_WARMUP_S = 600.0
+DEFAULT_GROWTH_PERCENT = 10.0
+DEFAULT_DRIFT_PERCENT = 20.0
+DEFAULT_TELEMETRY_PORT = 502
+
+# Samples after the warm-up needed to fit a trend, at least 2 per quarter
+MIN_TREND_SAMPLES = 8
+
+# FC20 attempts per sample; a frame built between two requests fails
+TELEMETRY_ATTEMPTS = 3
+
+MEMP_ENTRY = struct.Struct(f"<{NAME_SIZE}sHHHH")
+TASK_ENTRY = struct.Struct(f"<{NAME_SIZE}sHH")
+LATENCY_HEAD = struct.Struct("<BBBBII")
+
+# Series kinds: the direction that is bad, and how it is judged
+KIND_RESOURCE = "resource"
+KIND_STACK = "stack"
+KIND_LATENCY = "latency"
+KIND_COUNTER = "counter"
+
+
+@dataclass
+class SoakConfig:
+    """Parameters of one soak run."""
+
+    load: LoadConfig
+    interval_s: float = DEFAULT_INTERVAL_S
+    warmup_s: float = DEFAULT_WARMUP_S
+    growth_percent: float = DEFAULT_GROWTH_PERCENT
+    drift_percent: float = DEFAULT_DRIFT_PERCENT
+    log_path: Optional[str] = None
+    # FC20 reads are plaintext, also when the load runs over TLS
+    telemetry_port: int = DEFAULT_TELEMETRY_PORT
+
+
+@dataclass
+class Trend:
+    """The trend of one series after the warm-up."""
+
+    name: str
+    kind: str
+    first: float
+    last: float
+    slope_per_hour: float
+    quarters: list[float]
+    flagged: bool
+    reason: str = ""
+
+
+@dataclass
+class SoakResult:
+    """Summary of a soak run, as saved with --json-out."""
+
+    test_name: str
+    duration_h: float
+    samples: int
+    telemetry_failures: int
+    restarts: int
+    sent: int
+    successful: int
+    failed: int
+    trends: list[Trend] = field(default_factory=list)
+
+    @property
+    def flagged(self) -> list[Trend]:
+        """Series that grew, drifted or counted faster."""
+        return [t for t in self.trends if t.flagged]
+
+    @property
+    def passed(self) -> bool:
+        """No degradation found over the run."""
+        return not self.flagged and self.restarts == 0 and self.failed == 0
+
+    def print_report(self) -> None:
+        """Print the flagged series, then every fitted one."""
+        print(f"\n{'=' * 80}")
+        print(f"Soak Test: {self.test_name}")
+        print(f"{'=' * 80}")
+        print(f"  Duration:            {self.duration_h:.2f} h")
+        print(f"  Samples:             {self.samples} "
+              f"({self.telemetry_failures} telemetry reads failed)")
+        print(f"  Device restarts:     {self.restarts}")
+        print(f"  Requests:            {self.sent} "
+              f"({self.successful} ok, {self.failed} failed)")
+
+        flagged = self.flagged
+        print(f"\n  Degradation:         "
+              f"{len(flagged) if flagged else 'none found'}")
+        for trend in flagged:
+            print(f"    {trend.name:<40} {trend.reason}")
+
+        print(f"\n  {'Series':<40} {'first':>10} {'last':>10} "
+              f"{'per hour':>10}")
+        for trend in self.trends:
+            mark = "!" if trend.flagged else " "
+            print(f" {mark}{trend.name[:40]:<40} {trend.first:>10.1f} "
+                  f"{trend.last:>10.1f} {trend.slope_per_hour:>+10.2f}")
+        print(f"{'=' * 80}")
+
+
+def _name(raw: bytes) -> str:
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def _lookup(names: list[str], index: int) -> str:
+    return names[index] if index < len(names) else str(index)
+
+
+def _section_entries(frame: Frame, section_id: int):
+    for section in frame.sections:
+        if section.section_id == section_id:
+            return section.body, section.entries
+    return None, 0
+
+
+def _device_p99_us(buckets: list[int], min_shift: int, hz: int) -> float:
+    """Upper bound of the bucket holding the 99th percentile, in us."""
+    total = sum(buckets)
+    if total == 0 or hz == 0:
+        return 0.0
+    seen = 0
+    for i, count in enumerate(buckets):
+        seen += count
+        if seen * 100 >= total * 99:
+            return (1 << (min_shift + i)) * 1e6 / hz
+    return (1 << (min_shift + len(buckets) - 1)) * 1e6 / hz
+
+
+def frame_series(
+    frame: Frame, previous: Optional[dict[str, Any]]
+) -> tuple[dict[str, float], dict[str, Any]]:
+    """The series of a telemetry frame.
+
+    Returns the values keyed by series name ("kind:name") and the latency
+    histograms, kept to take the next frame's window from.
+    """
+    series: dict[str, float] = {}
+
+    body, _ = _section_entries(frame, SECTION_LWIP_MEM)
+    if body is not None:
+        _, used, _, _ = struct.unpack_from("<IIII", body)
+        series[f"{KIND_RESOURCE}:heap.used"] = used
+
+    body, entries = _section_entries(frame, SECTION_LWIP_MEMP)
+    for i in range(entries):
+        name, _, used, _, _ = MEMP_ENTRY.unpack_from(body, i * MEMP_ENTRY.size)
+        series[f"{KIND_RESOURCE}:pool.{_name(name) or i}.used"] = used
+
+    body, entries = _section_entries(frame, SECTION_SYS_POOLS)
+    for i in range(entries):
+        name, _, _, _, used, *_ = SYS_POOL_ENTRY.unpack_from(
+            body, i * SYS_POOL_ENTRY.size
+        )
+        series[f"{KIND_RESOURCE}:sys.{_name(name) or i}.used"] = used
+
+    body, entries = _section_entries(frame, SECTION_TASKS)
+    for i in range(entries):
+        name, _, stack_free = TASK_ENTRY.unpack_from(body, i * TASK_ENTRY.size)
+        series[f"{KIND_STACK}:{_name(name)}.stack_free"] = stack_free
+
+    body, entries = _section_entries(frame, SECTION_METRICS)
+    if body is not None:
+        for i, total in enumerate(struct.unpack_from(f"<{entries}I", body)):
+            name = METRIC_NAMES[i] if i < len(METRIC_NAMES) else f"metric_{i}"
+            series[f"{KIND_COUNTER}:{name}"] = total
+
+    # Latency histograms are totals since boot: the window is the
+    # difference from the last frame, the u16 buckets wrapping
+    histograms: dict[str, Any] = {}
+    body, entries = _section_entries(frame, SECTION_LATENCY)
+    pos = 0
+    for _ in range(entries):
+        transport, group, min_shift, count, requests, hz = (
+            LATENCY_HEAD.unpack_from(body, pos)
+        )
+        pos += LATENCY_HEAD.size
+        buckets = list(struct.unpack_from(f"<{count}H", body, pos))
+        pos += 2 * (count + len(STAGE_NAMES))
+        key = (
+            f"{_lookup(TRANSPORT_NAMES, transport)}."
+            f"{_lookup(FC_GROUP_NAMES, group)}"
+        )
+        histograms[key] = {"requests": requests, "buckets": buckets}
+
+        before = (previous or {}).get(key)
+        if before is None or before["requests"] > requests:
+            continue
+        window = [
+            (now - then) & 0xFFFF
+            for now, then in zip(buckets, before["buckets"], strict=True)
+        ]
+        if sum(window):
+            series[f"{KIND_LATENCY}:device.{key}.p99_us"] = _device_p99_us(
+                window, min_shift, hz
+            )
+
+    return series, histograms
+
+
+class _TelemetryReader:
+    """FC20 reads of the telemetry frame, reconnecting after errors."""
+
+    def __init__(self, config: LoadConfig, port: int) -> None:
+        self._config = config
+        self._port = port
+        self._client: Optional[FileRecordClient] = None
+
+    def read(self) -> Optional[Frame]:
+        """The current frame, or None when it cannot be read."""
+        for _ in range(TELEMETRY_ATTEMPTS):
+            try:
+                if self._client is None:
+                    self._client = FileRecordClient(
+                        self._config.host,
+                        self._port,
+                        self._config.unit_id,
+                        self._config.timeout_s,
+                    )
+                return read_modbus(self._client)
+            except FrameError:
+                continue
+            except (OSError, struct.error):
+                self.close()
+        return None
+
+    def close(self) -> None:
+        """Close the connection."""
+        if self._client is not None:
+            self._client.close()
+            self._client = None
+
+
+def _merged(per_connection: list[LoadStats]) -> LoadStats:
+    stats = LoadStats()
+    for connection_stats in per_connection:
+        stats.merge(connection_stats)
+    return stats
+
+
+async def _soak(
+    config: SoakConfig, tls: Optional[ssl.SSLContext], log
+) -> tuple[list[dict[str, Any]], LoadStats, float]:
+    """Run the load and take a sample every interval until it ends."""
+    per_connection = [LoadStats() for _ in range(config.load.connections)]
+    load = asyncio.ensure_future(
+        run_connections(config.load, tls, per_connection)
+    )
+    reader = _TelemetryReader(config.load, config.telemetry_port)
+    samples: list[dict[str, Any]] = []
+    histograms: Optional[dict[str, Any]] = None
+    latency = LatencyHistogram()
+    counts = (0, 0)
+    start = time.perf_counter()
+
+    try:
+        while not load.done():
+            await asyncio.wait([load], timeout=config.interval_s)
+            stats = _merged(per_connection)
+            window = stats.latency.since(latency)
+            latency = stats.latency.copy()
+            sent, failed = stats.sent - counts[0], stats.failed - counts[1]
+            counts = (stats.sent, stats.failed)
+
+            frame = await asyncio.to_thread(reader.read)
+            sample: dict[str, Any] = {
+                "time": time.time(),
+                "elapsed_s": time.perf_counter() - start,
+                "sent": sent,
+                "failed": failed,
+                "uptime_ms": None,
+                "series": {},
+            }
+            if window.total:
+                sample["series"][f"{KIND_LATENCY}:host.p50_ms"] = (
+                    window.percentile_ms(50.0)
+                )
+                sample["series"][f"{KIND_LATENCY}:host.p99_ms"] = (
+                    window.percentile_ms(99.0)
+                )
+            if frame is not None:
+                series, histograms = frame_series(frame, histograms)
+                sample["uptime_ms"] = frame.uptime_ms
+                sample["series"].update(series)
+
+            samples.append(sample)
+            if log is not None:
+                log.write(json.dumps(sample) + "\n")
+                log.flush()
+            print(f"  {sample['elapsed_s'] / 3600:6.2f} h: {sent} requests, "
+                  f"{failed} failed"
+                  + ("" if frame is not None else ", no telemetry"))
+        stats, total_time = load.result()
+    finally:
+        if not load.done():
+            load.cancel()
+        reader.close()
+
+    return samples, stats, total_time
+
+
+def _quarters(values: list[float]) -> list[float]:
+    size = len(values) / 4.0
+    return [
+        statistics.fmean(values[round(i * size) : round((i + 1) * size)])
+        for i in range(4)
+    ]
+
+
+def fit_trend(
+    name: str,
+    hours: list[float],
+    values: list[float],
+    growth_percent: float,
+    drift_percent: float,
+) -> Trend:
+    """Fit one series and judge it by its kind."""
+    kind, _, label = name.partition(":")
+    slope = statistics.linear_regression(hours, values).slope
+    quarters = _quarters(values)
+    trend = Trend(label, kind, values[0], values[-1], slope, quarters, False)
+    change = slope * (hours[-1] - hours[0])
+
+    if kind == KIND_COUNTER:
+        # Totals: judge the counts per quarter, not the totals
+        steps = [b - a for a, b in zip(values, values[1:])]
+        rates = _quarters([0.0] + steps)
+        if values[-1] > values[0] and rates[3] > rates[0]:
+            trend.flagged = True
+            trend.reason = (
+                f"+{values[-1] - values[0]:g} after the warm-up, "
+                f"{rates[0]:.2f} -> {rates[3]:.2f} per sample"
+            )
+        return trend
+
+    rising = all(b > a for a, b in zip(quarters, quarters[1:]))
+    falling = all(b < a for a, b in zip(quarters, quarters[1:]))
+    base = max(abs(quarters[0]), 1.0)
+    if kind == KIND_RESOURCE and rising:
+        if change >= max(1.0, base * growth_percent / 100.0):
+            trend.flagged = True
+            trend.reason = f"grows {slope:+.2f}/h, {change:+.1f} over the run"
+    elif kind == KIND_STACK and falling:
+        if -change >= max(1.0, base * growth_percent / 100.0):
+            trend.flagged = True
+            trend.reason = (
+                f"high water mark deepens {slope:+.2f} words/h"
+            )
+    elif kind == KIND_LATENCY and rising:
+        if change >= base * drift_percent / 100.0:
+            trend.flagged = True
+            trend.reason = (
+                f"drifts {change * 100.0 / base:+.0f} % over the run"
+            )
+    return trend
+
+
+def analyze(
+    samples: list[dict[str, Any]],
+    warmup_s: float,
+    growth_percent: float,
+    drift_percent: float,
+    test_name: str = "Soak",
+) -> SoakResult:
+    """Fit the trends of the samples taken after the warm-up."""
+    restarts = 0
+    uptime = None
+    for sample in samples:
+        if sample["uptime_ms"] is None:
+            continue
+        if uptime is not None and sample["uptime_ms"] < uptime:
+            restarts += 1
+        uptime = sample["uptime_ms"]
+
+    result = SoakResult(
+        test_name=test_name,
+        duration_h=samples[-1]["elapsed_s"] / 3600.0 if samples else 0.0,
+        samples=len(samples),
+        telemetry_failures=sum(1 for s in samples if s["uptime_ms"] is None),
+        restarts=restarts,
+        sent=sum(s["sent"] for s in samples),
+        successful=sum(s["sent"] - s["failed"] for s in samples),
+        failed=sum(s["failed"] for s in samples),
+    )
+
+    steady = [s for s in samples if s["elapsed_s"] >= warmup_s]
+    names: list[str] = []
+    for sample in steady:
+        for name in sample["series"]:
+            if name not in names:
+                names.append(name)
+
+    for name in names:
+        points = [
+            (s["elapsed_s"] / 3600.0, s["series"][name])
+            for s in steady
+            if name in s["series"]
+        ]
+        if len(points) < MIN_TREND_SAMPLES:
+            continue
+        hours = [t for t, _ in points]
+        values = [float(v) for _, v in points]
+        result.trends.append(
+            fit_trend(name, hours, values, growth_percent, drift_percent)
+        )
+    return result
+
+
+def run_soak(
+    config: SoakConfig, tls: Optional[ssl.SSLContext] = None
+) -> SoakResult:
+    """Run one soak test and judge its trends."""
+    parse_mix(config.load.mix)
+    pacing = f"{config.load.rate:g} req/s" if config.load.rate else (
+        "closed loop"
+    )
+    print(f"\nSoaking: {config.load.connections} connections, depth "
+          f"{config.load.depth}, {pacing}, "
+          f"{config.load.duration_s / 3600:g} h, a sample every "
+          f"{config.interval_s:g} s...")
+
+    log = (
+        open(config.log_path, "w", encoding="utf-8")
+        if config.log_path
+        else None
+    )
+    try:
+        samples, stats, _ = asyncio.run(_soak(config, tls, log))
+    finally:
+        if log is not None:
+            log.close()
+
+    result = analyze(
+        samples,
+        config.warmup_s,
+        config.growth_percent,
+        config.drift_percent,
+        test_name=f"Soak {config.load.name}",
+    )
+    # The load's own totals include the requests of the last interval
+    result.sent = stats.sent
+    result.successful = stats.successful
+    result.failed = stats.failed
+    return result
+
+
+def load_samples(path: str) -> list[dict[str, Any]]:
+    """Read the samples of a --soak-log file."""
+    samples = []
+    with open(path, encoding="utf-8") as file:
+        for line in file:
+            if line.strip():
+                samples.append(json.loads(line))
+    return samples
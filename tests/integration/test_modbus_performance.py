@@ -7,31 +7,99 @@ This script measures the performance of Modbus TCP communication:
 - Throughput (requests per second)
 - Sustained load testing
 - Burst testing
+- Pipelined requests (several in flight on one connection)
+- Concurrent load from several connections (--load, see modbus_load.py)
+- Soak runs of hours to days with device resource trends (--soak, see
+  modbus_soak.py)
 
 Usage:
     python test_modbus_performance.py --host 192.168.1.100 --port 502
 
+    # Compare network tuning profiles (JERRY_NET_PROFILE): run once per
+    # flashed build, saving the results, then compare them:
+    python test_modbus_performance.py --profile LOW_LATENCY --json-out ll.json
+    python test_modbus_performance.py --profile BULK --json-out bulk.json
+    python test_modbus_performance.py --compare ll.json bulk.json
+
     # With source IP binding (for VPN/multi-interface systems):
     python test_modbus_performance.py --host 169.254.4.100 --source-ip 169.254.4.50
 
+    # Modbus/TCP Security (JERRY_MODBUS_SECURITY) on port 802, with the
+    # development master certificate, compared against plaintext:
+    python test_modbus_performance.py --profile PLAIN --json-out plain.json
+    python test_modbus_performance.py --tls --profile TLS --json-out tls.json
+    python test_modbus_performance.py --compare plain.json tls.json
+
+    # Concurrent load: 8 connections with 4 requests in flight each, closed
+    # loop, then open loop at a fixed rate with a reconnect storm:
+    python test_modbus_performance.py --load --connections 8 --depth 4
+    python test_modbus_performance.py --load --rate 2000 --reconnect-every 100
+    python test_modbus_performance.py --load --mix fc03=1,fc16=1 \
+        --profile BULK --json-out bulk-load.json
+
+    # Soak before a release: a day of mixed load at 500 req/s, telemetry
+    # sampled every minute, trends fitted after a 10-minute warm-up, then
+    # the report recomputed from the sample log:
+    python test_modbus_performance.py --soak --rate 500 --duration 86400 \
+        --soak-log soak.jsonl --json-out soak.json
+    python test_modbus_performance.py --soak-report soak.jsonl
+
 Copyright (c) 2026
 """
 
 import argparse
+import json
+import socket
+import ssl
 import statistics
+import struct
 import sys
 import time
-from dataclasses import dataclass
+from dataclasses import asdict, dataclass
 from pathlib import Path
 from typing import Callable, Optional
 
-from pymodbus.client import ModbusTcpClient
+from pymodbus.client import ModbusTcpClient, ModbusTlsClient
 from pymodbus.exceptions import ModbusException
 
+from modbus_load import DEFAULT_MIX, LoadConfig, LoadResult, print_load_comparison, run_load
+from modbus_soak import (
+    DEFAULT_DRIFT_PERCENT,
+    DEFAULT_GROWTH_PERCENT,
+    DEFAULT_INTERVAL_S,
+    DEFAULT_TELEMETRY_PORT,
+    DEFAULT_WARMUP_S,
+    SoakConfig,
+    SoakResult,
+    analyze,
+    load_samples,
+    run_soak,
+)
+
 # Default configuration
 DEFAULT_HOST = "192.168.1.100"
 DEFAULT_PORT = 502
 DEFAULT_UNIT_ID = 1
+DEFAULT_TLS_PORT = 802
+
+# Development PKI of the Modbus/TCP Security server, generated by
+# tools/modbus_tls_credentials.py on the first configure of the checkout
+KEYS_DIR = Path(__file__).resolve().parents[2] / "tools" / "keys"
+
+
+def make_tls_context() -> ssl.SSLContext:
+    """TLS context presenting the development master certificate.
+
+    The server certificate is checked against the development CA; its name
+    (jerry.local) is not, as the device is addressed by IP.
+    """
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    ctx.minimum_version = ssl.TLSVersion.TLSv1_2
+    ctx.load_verify_locations(KEYS_DIR / "modbus_dev_ca.pem")
+    ctx.load_cert_chain(KEYS_DIR / "modbus_dev_client.pem",
+                        KEYS_DIR / "modbus_dev_client_key.pem")
+    ctx.check_hostname = False
+    return ctx
 
 
 @dataclass
@@ -450,12 +518,95 @@ def test_burst(client: ModbusTcpClient, burst_size: int = 100, num_bursts: int =
     )
 
 
+def test_pipelined(
+    host: str,
+    port: int,
+    unit_id: int,
+    depth: int = 8,
+    rounds: int = 100,
+    source_ip: Optional[str] = None,
+    tls: Optional[ssl.SSLContext] = None
+) -> PerformanceResult:
+    """Test pipelined FC03 requests with several requests in flight.
+
+    Each round writes @p depth requests in one send and then reads all the
+    responses. This is where the network profiles differ most: with Nagle
+    enabled (BULK) the server holds back each response until the previous
+    one is acknowledged. The recorded latency is per round.
+    """
+    latencies = []
+    successful = 0
+    failed = 0
+
+    print(f"\nRunning: Pipelined Test ({rounds} rounds of {depth} requests)...")
+
+    sock = socket.create_connection(
+        (host, port), timeout=5,
+        source_address=(source_ip, 0) if source_ip else None
+    )
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    if tls is not None:
+        sock = tls.wrap_socket(sock)
+
+    # FC03, PWM registers 0-11; response is MBAP(7) + FC + count + 24 bytes
+    response_len = 7 + 2 + 12 * 2
+    transaction = 0
+
+    start_time = time.perf_counter()
+
+    try:
+        for _ in range(rounds):
+            frames = b""
+            for _ in range(depth):
+                transaction = (transaction + 1) & 0xFFFF
+                frames += struct.pack(">HHHBBHH", transaction, 0, 6, unit_id, 3, 0, 12)
+
+            round_start = time.perf_counter()
+            sock.sendall(frames)
+
+            expected = response_len * depth
+            received = b""
+            try:
+                while len(received) < expected:
+                    chunk = sock.recv(expected - len(received))
+                    if not chunk:
+                        break
+                    received += chunk
+            except socket.timeout:
+                pass
+
+            good = 0
+            for i in range(len(received) // response_len):
+                if received[i * response_len + 7] == 3:
+                    good += 1
+            successful += good
+            failed += depth - good
+            if good == depth:
+                latencies.append((time.perf_counter() - round_start) * 1000)
+            elif len(received) < expected:
+                break
+    finally:
+        sock.close()
+
+    total_time = time.perf_counter() - start_time
+
+    return PerformanceResult(
+        test_name=f"Pipelined FC03 (depth {depth})",
+        total_requests=successful + failed,
+        successful_requests=successful,
+        failed_requests=failed,
+        total_time_sec=total_time,
+        latencies_ms=latencies
+    )
+
+
 def run_all_performance_tests(
     host: str,
     port: int,
     unit_id: int,
     quick: bool = False,
-    source_ip: Optional[str] = None
+    source_ip: Optional[str] = None,
+    tls: Optional[ssl.SSLContext] = None
 ) -> list[PerformanceResult]:
     """Run all performance tests.
 
@@ -465,13 +616,24 @@ def run_all_performance_tests(
         unit_id: Modbus unit/slave ID
         quick: If True, run fewer iterations
         source_ip: Optional source IP to bind to (for multi-interface systems)
+        tls: TLS context for Modbus/TCP Security, or None for plaintext
     """
     print(f"Connecting to Modbus TCP server at {host}:{port} (unit_id={unit_id})...")
     if source_ip:
         print(f"Using source IP: {source_ip}")
 
-    # Create client with source address if specified
-    if source_ip:
+    # Create client with source address if specified. Over TLS the frames
+    # keep their MBAP header, as the Modbus/TCP Security specification says
+    if tls is not None:
+        client = ModbusTlsClient(
+            host=host,
+            port=port,
+            sslctx=tls,
+            framer="socket",
+            timeout=5,
+            source_address=(source_ip, 0) if source_ip else None
+        )
+    elif source_ip:
         client = ModbusTcpClient(
             host=host,
             port=port,
@@ -536,6 +698,11 @@ def run_all_performance_tests(
         client.close()
         print("\nConnection closed.")
 
+    # Pipelined test on its own connection
+    results.append(test_pipelined(host, port, unit_id,
+                                  rounds=num_requests // 10,
+                                  source_ip=source_ip, tls=tls))
+
     return results
 
 
@@ -578,6 +745,78 @@ def print_summary(results: list[PerformanceResult]) -> None:
         print(f"    Median:            {statistics.median(all_latencies):.3f}")
 
 
+def save_results(
+    path: str,
+    profile: str,
+    results: list[PerformanceResult],
+    load_results: Optional[list[LoadResult]] = None,
+    soak_result: Optional[SoakResult] = None,
+) -> None:
+    """Save results tagged with the network profile they were run against."""
+    data = {"profile": profile, "results": [asdict(r) for r in results]}
+    if load_results:
+        data["load"] = [asdict(r) for r in load_results]
+    if soak_result:
+        data["soak"] = asdict(soak_result)
+    Path(path).write_text(json.dumps(data, indent=2))
+    print(f"\nResults saved to {path}")
+
+
+def print_profile_comparison(paths: list[str]) -> None:
+    """Print throughput and latency side by side for saved profile runs."""
+    runs = []
+    load_runs = []
+    for path in paths:
+        data = json.loads(Path(path).read_text())
+        results = {r["test_name"]: PerformanceResult(**r) for r in data["results"]}
+        runs.append((data["profile"], results))
+        load_runs.append((data["profile"], data.get("load", [])))
+
+    print_load_comparison(load_runs)
+    if not any(results for _, results in runs):
+        return
+
+    test_names = []
+    for _, results in runs:
+        for name in results:
+            if name not in test_names:
+                test_names.append(name)
+
+    print("\n" + "=" * 80)
+    print("NETWORK PROFILE COMPARISON (req/s | avg ms | p99 ms)")
+    print("=" * 80)
+    print(f"{'Test Name':<35}" + "".join(f"{p:>22}" for p, _ in runs))
+    print("-" * 80)
+    for name in test_names:
+        row = f"{name[:34]:<35}"
+        for _, results in runs:
+            r = results.get(name)
+            if r is None:
+                row += f"{'-':>22}"
+            else:
+                cell = f"{r.requests_per_second:.0f} | {r.avg_latency_ms:.2f} | {r.p99_latency_ms:.2f}"
+                row += f"{cell:>22}"
+        print(row)
+    print("=" * 80)
+
+    # Average latency of each run relative to the first, e.g. TLS/plaintext
+    if len(runs) > 1:
+        base_profile, base = runs[0]
+        print(f"\nAVERAGE LATENCY RELATIVE TO {base_profile}")
+        print("-" * 80)
+        for name in test_names:
+            row = f"{name[:34]:<35}"
+            for _, results in runs[1:]:
+                r = results.get(name)
+                b = base.get(name)
+                if r is None or b is None or b.avg_latency_ms == 0:
+                    row += f"{'-':>22}"
+                else:
+                    row += f"{r.avg_latency_ms / b.avg_latency_ms:>21.2f}x"
+            print(row)
+        print("=" * 80)
+
+
 def main():
     """Main entry point."""
     parser = argparse.ArgumentParser(
@@ -591,8 +830,9 @@ def main():
     parser.add_argument(
         "--port",
         type=int,
-        default=DEFAULT_PORT,
-        help=f"Modbus TCP server port (default: {DEFAULT_PORT})"
+        default=None,
+        help=f"Modbus TCP server port (default: {DEFAULT_PORT}, "
+             f"{DEFAULT_TLS_PORT} with --tls)"
     )
     parser.add_argument(
         "--unit-id",
@@ -615,9 +855,151 @@ def main():
         default=None,
         help="Source IP address to bind to (for multi-interface/VPN systems)"
     )
+    parser.add_argument(
+        "--tls",
+        action="store_true",
+        help="Use Modbus/TCP Security with the development certificates in tools/keys "
+        "(tools/modbus_tls_credentials.py generates them)"
+    )
+
+    parser.add_argument(
+        "--profile",
+        default="unknown",
+        help="Network profile (JERRY_NET_PROFILE) of the firmware under test"
+    )
+    parser.add_argument(
+        "--json-out",
+        default=None,
+        help="Save results, tagged with --profile, to this JSON file"
+    )
+    parser.add_argument(
+        "--compare",
+        nargs="+",
+        metavar="JSON",
+        default=None,
+        help="Compare saved per-profile results instead of running tests"
+    )
+
+    load = parser.add_argument_group("concurrent load (--load)")
+    load.add_argument(
+        "--load",
+        action="store_true",
+        help="Run the asyncio load generator instead of the test suite"
+    )
+    load.add_argument(
+        "--connections",
+        type=int,
+        default=4,
+        help="Concurrent connections (default: 4)"
+    )
+    load.add_argument(
+        "--depth",
+        type=int,
+        default=4,
+        help="Requests in flight per connection (default: 4)"
+    )
+    load.add_argument(
+        "--mix",
+        default=DEFAULT_MIX,
+        help=f"Weighted function code mix (default: {DEFAULT_MIX})"
+    )
+    load.add_argument(
+        "--rate",
+        type=float,
+        default=None,
+        help="Total requests per second, open loop (default: closed loop)"
+    )
+    load.add_argument(
+        "--duration",
+        type=float,
+        default=None,
+        help="Seconds of load (default: 10, 3 with --quick, 1 day with --soak)"
+    )
+    load.add_argument(
+        "--reconnect-every",
+        type=int,
+        default=0,
+        help="Reconnect each connection after this many requests (default: never)"
+    )
+    load.add_argument(
+        "--timeout",
+        type=float,
+        default=2.0,
+        help="Response timeout in seconds (default: 2)"
+    )
+
+    soak = parser.add_argument_group("soak test (--soak)")
+    soak.add_argument(
+        "--soak",
+        action="store_true",
+        help="Run the load for --duration, tracking the device's resource "
+             "and latency trends"
+    )
+    soak.add_argument(
+        "--soak-interval",
+        type=float,
+        default=DEFAULT_INTERVAL_S,
+        help=f"Seconds between telemetry samples (default: {DEFAULT_INTERVAL_S:g})"
+    )
+    soak.add_argument(
+        "--soak-warmup",
+        type=float,
+        default=DEFAULT_WARMUP_S,
+        help=f"Seconds left out of the trends (default: {DEFAULT_WARMUP_S:g})"
+    )
+    soak.add_argument(
+        "--growth",
+        type=float,
+        default=DEFAULT_GROWTH_PERCENT,
+        help="Resource growth over the run that is flagged, in percent "
+             f"(default: {DEFAULT_GROWTH_PERCENT:g})"
+    )
+    soak.add_argument(
+        "--drift",
+        type=float,
+        default=DEFAULT_DRIFT_PERCENT,
+        help="Latency rise over the run that is flagged, in percent "
+             f"(default: {DEFAULT_DRIFT_PERCENT:g})"
+    )
+    soak.add_argument(
+        "--soak-log",
+        default=None,
+        help="Write every sample to this JSON lines file as it is taken"
+    )
+    soak.add_argument(
+        "--telemetry-port",
+        type=int,
+        default=DEFAULT_TELEMETRY_PORT,
+        help="Plaintext Modbus TCP port of the FC20 telemetry reads "
+             f"(default: {DEFAULT_TELEMETRY_PORT})"
+    )
+    soak.add_argument(
+        "--soak-report",
+        metavar="JSONL",
+        default=None,
+        help="Fit the trends of a saved --soak-log instead of running tests"
+    )
 
     args = parser.parse_args()
 
+    if args.soak_report:
+        soak_result = analyze(
+            load_samples(args.soak_report),
+            args.soak_warmup,
+            args.growth,
+            args.drift,
+            test_name=f"Soak {args.soak_report}",
+        )
+        soak_result.print_report()
+        sys.exit(0 if soak_result.passed else 1)
+
+    if args.compare:
+        print_profile_comparison(args.compare)
+        sys.exit(0)
+
+    if args.port is None:
+        args.port = DEFAULT_TLS_PORT if args.tls else DEFAULT_PORT
+
     print("=" * 60)
     print("Modbus TCP Performance Test")
     print("=" * 60)
@@ -626,14 +1008,64 @@ def main():
     if args.source_ip:
         print(f"Source IP: {args.source_ip}")
     print(f"Mode: {'Quick' if args.quick else 'Full'}")
+    print(f"Transport: {'TLS' if args.tls else 'Plaintext'}")
+    print(f"Network profile: {args.profile}")
     print("=" * 60)
 
+    if args.load or args.soak:
+        default_duration = 86400.0 if args.soak else 10.0
+        config = LoadConfig(
+            host=args.host,
+            port=args.port,
+            unit_id=args.unit_id,
+            connections=args.connections,
+            depth=args.depth,
+            duration_s=args.duration or (3.0 if args.quick else default_duration),
+            rate=args.rate,
+            mix=args.mix,
+            reconnect_every=args.reconnect_every,
+            timeout_s=args.timeout,
+            source_ip=args.source_ip,
+        )
+        if args.soak:
+            try:
+                soak_result = run_soak(
+                    SoakConfig(
+                        load=config,
+                        interval_s=args.soak_interval,
+                        warmup_s=args.soak_warmup,
+                        growth_percent=args.growth,
+                        drift_percent=args.drift,
+                        log_path=args.soak_log,
+                        telemetry_port=args.telemetry_port,
+                    ),
+                    make_tls_context() if args.tls else None,
+                )
+            except ValueError as e:
+                parser.error(str(e))
+            soak_result.print_report()
+            if args.json_out:
+                save_results(args.json_out, args.profile, [], soak_result=soak_result)
+            sys.exit(0 if soak_result.passed else 1)
+
+        try:
+            load_result = run_load(config, make_tls_context() if args.tls else None)
+        except ValueError as e:
+            parser.error(str(e))
+        load_result.print_report()
+
+        if args.json_out:
+            save_results(args.json_out, args.profile, [], [load_result])
+
+        sys.exit(1 if load_result.failed > 0 else 0)
+
     results = run_all_performance_tests(
         args.host,
         args.port,
         args.unit_id,
         args.quick,
-        args.source_ip
+        args.source_ip,
+        make_tls_context() if args.tls else None
     )
 
     if args.detailed:
@@ -642,6 +1074,9 @@ def main():
 
     print_summary(results)
 
+    if args.json_out:
+        save_results(args.json_out, args.profile, results)
+
     # Return non-zero if any test had failures
     total_failed = sum(r.failed_requests for r in results)
     sys.exit(1 if total_failed > 0 else 0)
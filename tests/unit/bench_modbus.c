@@ -0,0 +1,452 @@
+/**
+ * @file bench_modbus.c
+ * @brief Host micro-benchmarks of the Modbus library hot paths
+ *
+ * Times PDU serialization, MBAP frame parsing, CRC-16 and slave dispatch
+ * over three frame mixes: a short FC03 read, a maximum-size FC16 write and
+ * a maximum-coil FC15 write. Each case is calibrated to run for about
+ * BENCH_TARGET_NS and the best of BENCH_REPEATS runs is reported, which
+ * keeps the figures stable on a loaded host.
+ *
+ * Usage: modbus_bench [--output FILE] [--baseline FILE] [--tolerance PCT]
+ *
+ *   --output    Write the results as CSV (case,ns_per_op,bytes_per_s)
+ *   --baseline  Compare with a results file written by --output; exits
+ *               with 1 if a case is more than the tolerance slower
+ *   --tolerance Allowed slowdown in percent (default 25)
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "modbus.h"
+#include "modbus_internal.h"
+
+/* ==========================================================================
+ * Configuration
+ * ========================================================================== */
+
+/** Wall time one timed run of a case aims for */
+#define BENCH_TARGET_NS 50000000ULL
+
+/** Timed runs of each case; the fastest is reported */
+#define BENCH_REPEATS 5U
+
+/** Default allowed slowdown against the baseline, in percent */
+#define BENCH_DEFAULT_TOLERANCE 25.0
+
+/** Longest case name in a results file */
+#define BENCH_NAME_SIZE 48U
+
+/* ==========================================================================
+ * Frame Mixes
+ * ========================================================================== */
+
+/**
+ * @brief One representative request
+ */
+typedef struct
+{
+    const char  *name;
+    modbus_pdu_t request;                        /**< Request PDU */
+    uint8_t      tcp_frame[MODBUS_TCP_MAX_ADU_SIZE]; /**< MBAP frame */
+    uint16_t     tcp_length;
+    uint8_t      rtu_frame[MODBUS_RTU_MAX_ADU_SIZE]; /**< RTU frame, no CRC */
+    uint16_t     rtu_length;
+} bench_frame_t;
+
+enum
+{
+    BENCH_FRAME_FC03_SHORT,
+    BENCH_FRAME_FC16_MAX,
+    BENCH_FRAME_FC15_MAX,
+    BENCH_FRAME_COUNT
+};
+
+static bench_frame_t s_frames[BENCH_FRAME_COUNT];
+
+/** Sink the results go to, so the timed calls are not optimized away */
+static volatile uint32_t s_sink;
+
+static modbus_context_storage_t s_ctx_storage;
+static modbus_context_t *const  s_ctx = (modbus_context_t *)&s_ctx_storage;
+
+/**
+ * @brief Build the TCP and RTU frames of a request PDU
+ */
+static void bench_frame_init(bench_frame_t *frame, const char *name)
+{
+    modbus_adu_t adu;
+
+    frame->name = name;
+
+    memset(&adu, 0, sizeof(adu));
+    adu.unit_id        = 0x01;
+    adu.transaction_id = 0x1234;
+    adu.pdu            = frame->request;
+    if (modbus_tcp_build_frame(&adu, frame->tcp_frame,
+                               (uint16_t)sizeof(frame->tcp_frame),
+                               &frame->tcp_length) != MODBUS_OK)
+    {
+        fprintf(stderr, "%s: TCP frame not built\n", name);
+        exit(2);
+    }
+
+    frame->rtu_frame[0] = 0x01;
+    if (modbus_pdu_serialize(&frame->request, &frame->rtu_frame[1],
+                             (uint16_t)(sizeof(frame->rtu_frame) - 3U),
+                             &frame->rtu_length) != MODBUS_OK)
+    {
+        fprintf(stderr, "%s: RTU frame not built\n", name);
+        exit(2);
+    }
+    frame->rtu_length = (uint16_t)(frame->rtu_length + 1U);
+}
+
+/**
+ * @brief Build the frame mixes and the slave context
+ */
+static void bench_setup(void)
+{
+    uint16_t        registers[MODBUS_MAX_WRITE_REGISTERS];
+    uint8_t         coils[(MODBUS_MAX_WRITE_COILS + 7U) / 8U];
+    modbus_config_t config;
+
+    for (uint16_t i = 0; i < MODBUS_MAX_WRITE_REGISTERS; i++)
+    {
+        registers[i] = (uint16_t)(0xA5C3U ^ (i * 0x0101U));
+    }
+    for (uint16_t i = 0; i < sizeof(coils); i++)
+    {
+        coils[i] = (uint8_t)(0x5AU ^ i);
+    }
+
+    (void)modbus_pdu_encode_read_holding_registers(
+        &s_frames[BENCH_FRAME_FC03_SHORT].request, 0x0000, 4);
+    (void)modbus_pdu_encode_write_multiple_registers(
+        &s_frames[BENCH_FRAME_FC16_MAX].request, 0x0000,
+        MODBUS_MAX_WRITE_REGISTERS, registers);
+    (void)modbus_pdu_encode_write_multiple_coils(
+        &s_frames[BENCH_FRAME_FC15_MAX].request, 0x0000,
+        MODBUS_MAX_WRITE_COILS, coils);
+
+    bench_frame_init(&s_frames[BENCH_FRAME_FC03_SHORT], "fc03_short");
+    bench_frame_init(&s_frames[BENCH_FRAME_FC16_MAX], "fc16_max");
+    bench_frame_init(&s_frames[BENCH_FRAME_FC15_MAX], "fc15_max");
+
+    memset(&config, 0, sizeof(config));
+    config.mode     = MODBUS_MODE_SLAVE;
+    config.protocol = MODBUS_PROTOCOL_TCP;
+    config.unit_id  = 0x01;
+    (void)modbus_init(s_ctx, &config);
+}
+
+/* ==========================================================================
+ * Benchmarked Operations
+ * ========================================================================== */
+
+/**
+ * @brief One benchmarked operation
+ *
+ * @return Result folded into s_sink
+ */
+typedef uint32_t (*bench_op_t)(const bench_frame_t *frame);
+
+static uint32_t op_pdu_serialize(const bench_frame_t *frame)
+{
+    uint8_t  buffer[MODBUS_MAX_PDU_SIZE];
+    uint16_t length = 0;
+
+    (void)modbus_pdu_serialize(&frame->request, buffer, sizeof(buffer),
+                               &length);
+    return (uint32_t)length + buffer[length - 1U];
+}
+
+static uint32_t op_tcp_parse_frame(const bench_frame_t *frame)
+{
+    modbus_adu_t adu;
+
+    (void)modbus_tcp_parse_frame(frame->tcp_frame, frame->tcp_length, &adu);
+    return (uint32_t)adu.pdu.data_length + adu.pdu.data[0];
+}
+
+static uint32_t op_crc16(const bench_frame_t *frame)
+{
+    return modbus_crc16(frame->rtu_frame, frame->rtu_length);
+}
+
+static uint32_t op_slave_process_pdu(const bench_frame_t *frame)
+{
+    modbus_pdu_t response;
+
+    (void)modbus_slave_process_pdu(s_ctx, &frame->request, &response);
+    return (uint32_t)response.function_code + response.data_length;
+}
+
+/**
+ * @brief Bytes one operation handles
+ */
+static uint16_t op_bytes(bench_op_t op, const bench_frame_t *frame)
+{
+    uint16_t bytes = (uint16_t)(1U + frame->request.data_length);
+
+    if (op == op_tcp_parse_frame)
+    {
+        bytes = frame->tcp_length;
+    }
+    else if (op == op_crc16)
+    {
+        bytes = frame->rtu_length;
+    }
+    else
+    {
+        /* PDU bytes */
+    }
+
+    return bytes;
+}
+
+static const struct
+{
+    const char *name;
+    bench_op_t  op;
+} s_ops[] = {
+    {"pdu_serialize", op_pdu_serialize},
+    {"tcp_parse_frame", op_tcp_parse_frame},
+    {"crc16", op_crc16},
+    {"slave_process_pdu", op_slave_process_pdu},
+};
+
+#define BENCH_OP_COUNT (sizeof(s_ops) / sizeof(s_ops[0]))
+
+/* ==========================================================================
+ * Timing
+ * ========================================================================== */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void)timespec_get(&ts, TIME_UTC);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t run_ns(bench_op_t op, const bench_frame_t *frame,
+                       uint64_t iterations)
+{
+    uint64_t start = now_ns();
+    uint32_t acc   = 0;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        acc += op(frame);
+    }
+    s_sink = s_sink + acc;
+
+    return now_ns() - start;
+}
+
+/**
+ * @brief Time one case
+ *
+ * @return Best time per operation in nanoseconds
+ */
+static double bench_case(bench_op_t op, const bench_frame_t *frame)
+{
+    uint64_t iterations = 16;
+    uint64_t elapsed    = run_ns(op, frame, iterations);
+    double   best       = 0.0;
+
+    /* Grow the run until it lasts a tenth of the target, then scale */
+    while (elapsed < (BENCH_TARGET_NS / 10U))
+    {
+        iterations *= 4U;
+        elapsed = run_ns(op, frame, iterations);
+    }
+    iterations = (iterations * BENCH_TARGET_NS) / (elapsed + 1U) + 1U;
+
+    for (unsigned r = 0; r < BENCH_REPEATS; r++)
+    {
+        double ns = (double)run_ns(op, frame, iterations) / (double)iterations;
+
+        if ((r == 0U) || (ns < best))
+        {
+            best = ns;
+        }
+    }
+
+    return best;
+}
+
+/* ==========================================================================
+ * Baseline
+ * ========================================================================== */
+
+typedef struct
+{
+    char   name[BENCH_NAME_SIZE];
+    double ns_per_op;
+    double bytes_per_s;
+} bench_result_t;
+
+static bench_result_t s_results[BENCH_OP_COUNT * BENCH_FRAME_COUNT];
+
+static void write_results(const char *path, size_t count)
+{
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "cannot write %s\n", path);
+        exit(2);
+    }
+
+    fprintf(file, "case,ns_per_op,bytes_per_s\n");
+    for (size_t i = 0; i < count; i++)
+    {
+        fprintf(file, "%s,%.2f,%.0f\n", s_results[i].name,
+                s_results[i].ns_per_op, s_results[i].bytes_per_s);
+    }
+    fclose(file);
+}
+
+/**
+ * @brief Compare the results with a baseline file
+ *
+ * Cases missing from either side are reported but do not fail.
+ *
+ * @return Number of cases slower than the tolerance allows
+ */
+static unsigned compare_baseline(const char *path, size_t count,
+                                 double tolerance)
+{
+    FILE    *file = fopen(path, "r");
+    char     line[128];
+    unsigned regressions = 0;
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        exit(2);
+    }
+
+    printf("\n%-32s %12s %12s %8s\n", "case", "baseline", "now", "change");
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char   name[BENCH_NAME_SIZE];
+        double baseline;
+        size_t i;
+
+        if (sscanf(line, "%47[^,],%lf", name, &baseline) != 2)
+        {
+            continue; /* Header or blank line */
+        }
+
+        for (i = 0; i < count; i++)
+        {
+            if (strcmp(s_results[i].name, name) == 0)
+            {
+                break;
+            }
+        }
+
+        if (i == count)
+        {
+            printf("%-32s %12.2f %12s\n", name, baseline, "missing");
+        }
+        else
+        {
+            double change =
+                ((s_results[i].ns_per_op - baseline) / baseline) * 100.0;
+            int slow = change > tolerance;
+
+            printf("%-32s %12.2f %12.2f %+7.1f%%%s\n", name, baseline,
+                   s_results[i].ns_per_op, change, slow ? "  SLOWER" : "");
+            regressions += slow ? 1U : 0U;
+        }
+    }
+    fclose(file);
+
+    return regressions;
+}
+
+/* ==========================================================================
+ * Main
+ * ========================================================================== */
+
+int main(int argc, char **argv)
+{
+    const char *output    = NULL;
+    const char *baseline  = NULL;
+    double      tolerance = BENCH_DEFAULT_TOLERANCE;
+    size_t      count     = 0;
+    int         status    = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--output") == 0) && ((i + 1) < argc))
+        {
+            output = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--baseline") == 0) && ((i + 1) < argc))
+        {
+            baseline = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--tolerance") == 0) && ((i + 1) < argc))
+        {
+            tolerance = atof(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr,
+                    "usage: %s [--output FILE] [--baseline FILE] "
+                    "[--tolerance PCT]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    bench_setup();
+
+    printf("%-32s %12s %14s\n", "case", "ns/op", "bytes/s");
+    for (size_t o = 0; o < BENCH_OP_COUNT; o++)
+    {
+        for (size_t f = 0; f < BENCH_FRAME_COUNT; f++)
+        {
+            bench_result_t *result = &s_results[count++];
+            double ns = bench_case(s_ops[o].op, &s_frames[f]);
+
+            (void)snprintf(result->name, sizeof(result->name), "%s/%s",
+                           s_ops[o].name, s_frames[f].name);
+            result->ns_per_op = ns;
+            result->bytes_per_s =
+                ((double)op_bytes(s_ops[o].op, &s_frames[f]) * 1e9) / ns;
+            printf("%-32s %12.2f %14.0f\n", result->name, result->ns_per_op,
+                   result->bytes_per_s);
+        }
+    }
+
+    if (output != NULL)
+    {
+        write_results(output, count);
+    }
+
+    if (baseline != NULL)
+    {
+        unsigned regressions = compare_baseline(baseline, count, tolerance);
+
+        if (regressions > 0U)
+        {
+            printf("\n%u case(s) more than %.0f%% slower than the baseline\n",
+                   regressions, tolerance);
+            status = 1;
+        }
+    }
+
+    return status;
+}
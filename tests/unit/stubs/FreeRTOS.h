@@ -0,0 +1,22 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stub of the FreeRTOS kernel for the unit tests
+ *
+ * Just the types the headers of the modules built into the tests use.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef STUB_FREERTOS_H
+#define STUB_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef long     BaseType_t;
+
+#define pdTRUE  ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+
+#endif /* STUB_FREERTOS_H */
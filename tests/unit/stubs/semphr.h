@@ -0,0 +1,31 @@
+/**
+ * @file semphr.h
+ * @brief Host stub of the FreeRTOS semaphores for the unit tests
+ *
+ * Every take succeeds at once.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef STUB_SEMPHR_H
+#define STUB_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex,
+                                        TickType_t wait)
+{
+    (void)mutex;
+    (void)wait;
+    return pdTRUE;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+    (void)mutex;
+    return pdTRUE;
+}
+
+#endif /* STUB_SEMPHR_H */
@@ -0,0 +1,214 @@
+/**
+ * @file test_block_pool.c
+ * @brief Unity unit tests for the fixed-block pool
+ *
+ * Tests the free list of block_pool.c, a Treiber stack: the order blocks
+ * are handed out and taken back in, an empty pool, blocks of another pool
+ * and the tag that tells a head apart from the same block back at the
+ * head, plus the statistics.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include "unity.h"
+#include "block_pool.h"
+
+/* ==========================================================================
+ * Test Pools
+ * ========================================================================== */
+
+/** Block with a size that is not a power of 2 */
+typedef struct
+{
+    uint8_t bytes[12];
+} test_block_t;
+
+#define TEST_POOL_BLOCKS 4U
+
+BLOCK_POOL_DEFINE(s_test_pool, test_block_t, TEST_POOL_BLOCKS);
+
+/** Pool over existing arrays, with a companion array indexed alike */
+static uint32_t s_words[3];
+static uint16_t s_word_links[3];
+static block_pool_t s_word_pool =
+    BLOCK_POOL_INIT("words", s_words, s_word_links);
+
+/** Block index of the free list head, as block_pool.c keeps it */
+static uint16_t head_index(const block_pool_t* pool)
+{
+    return (uint16_t)(atomic_load(&pool->head) & 0xFFFFU);
+}
+
+/* ==========================================================================
+ * Free List Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test that a new pool hands out its blocks in array order
+ */
+void test_block_pool_alloc_in_order(void)
+{
+    block_pool_init(&s_test_pool);
+
+    for (uint32_t i = 0; i < TEST_POOL_BLOCKS; i++)
+    {
+        void* block = block_pool_alloc(&s_test_pool);
+
+        TEST_ASSERT_TRUE(block == (void*)&s_test_pool_blocks[i]);
+        TEST_ASSERT_EQUAL_INT32(i, block_pool_index(&s_test_pool, block));
+    }
+    TEST_ASSERT_NULL(block_pool_alloc(&s_test_pool));
+    TEST_ASSERT_FALSE(block_pool_available(&s_test_pool));
+}
+
+/**
+ * @brief Test that freed blocks come back last in, first out
+ */
+void test_block_pool_free_alloc_lifo(void)
+{
+    void* blocks[TEST_POOL_BLOCKS];
+
+    block_pool_init(&s_test_pool);
+    for (uint32_t i = 0; i < TEST_POOL_BLOCKS; i++)
+    {
+        blocks[i] = block_pool_alloc(&s_test_pool);
+    }
+
+    /* Push 1, 3, 0: the head is always the block freed last */
+    TEST_ASSERT_TRUE(block_pool_free(&s_test_pool, blocks[1]));
+    TEST_ASSERT_EQUAL_UINT16(1, head_index(&s_test_pool));
+    TEST_ASSERT_TRUE(block_pool_free(&s_test_pool, blocks[3]));
+    TEST_ASSERT_EQUAL_UINT16(3, head_index(&s_test_pool));
+    TEST_ASSERT_TRUE(block_pool_free(&s_test_pool, blocks[0]));
+    TEST_ASSERT_EQUAL_UINT16(0, head_index(&s_test_pool));
+
+    TEST_ASSERT_TRUE(block_pool_alloc(&s_test_pool) == blocks[0]);
+    TEST_ASSERT_TRUE(block_pool_alloc(&s_test_pool) == blocks[3]);
+
+    /* A block freed between pops goes back on top */
+    TEST_ASSERT_TRUE(block_pool_free(&s_test_pool, blocks[3]));
+    TEST_ASSERT_TRUE(block_pool_alloc(&s_test_pool) == blocks[3]);
+    TEST_ASSERT_TRUE(block_pool_alloc(&s_test_pool) == blocks[1]);
+    TEST_ASSERT_NULL(block_pool_alloc(&s_test_pool));
+}
+
+/**
+ * @brief Test that every change of the head moves its tag on
+ *
+ * A pop preempted after reading the head must fail its swap even when the
+ * same block is back at the head by then: alloc A, alloc B, free A leaves
+ * A on top again, under another tag.
+ */
+void test_block_pool_head_tag(void)
+{
+    unsigned int before;
+    unsigned int after;
+    void* a;
+    void* b;
+
+    block_pool_init(&s_test_pool);
+    before = atomic_load(&s_test_pool.head);
+
+    a = block_pool_alloc(&s_test_pool);
+    b = block_pool_alloc(&s_test_pool);
+    TEST_ASSERT_TRUE(block_pool_free(&s_test_pool, a));
+
+    after = atomic_load(&s_test_pool.head);
+    TEST_ASSERT_EQUAL_UINT16(before & 0xFFFFU, after & 0xFFFFU);
+    TEST_ASSERT_EQUAL_HEX32(before + 0x30000U, after);
+
+    /* The stale head no longer swaps: its link would hand out B again */
+    TEST_ASSERT_FALSE(atomic_compare_exchange_strong(&s_test_pool.head,
+                                                     &before, 0xFFFFU));
+    TEST_ASSERT_TRUE(block_pool_alloc(&s_test_pool) == a);
+    TEST_ASSERT_TRUE(block_pool_alloc(&s_test_pool) ==
+                     (void*)&s_test_pool_blocks[2]);
+    TEST_ASSERT_TRUE(block_pool_free(&s_test_pool, b));
+}
+
+/**
+ * @brief Test that pointers not naming a block of the pool are refused
+ */
+void test_block_pool_free_foreign(void)
+{
+    test_block_t other;
+    uint8_t* first;
+    block_pool_stats_t stats;
+
+    block_pool_init(&s_test_pool);
+    first = block_pool_alloc(&s_test_pool);
+
+    TEST_ASSERT_FALSE(block_pool_free(&s_test_pool, &other));
+    TEST_ASSERT_FALSE(block_pool_free(&s_test_pool, first + 1));
+    TEST_ASSERT_FALSE(
+        block_pool_free(&s_test_pool, &s_test_pool_blocks[TEST_POOL_BLOCKS]));
+    TEST_ASSERT_EQUAL_INT32(-1, block_pool_index(&s_test_pool, &other));
+
+    /* Nothing was pushed or uncounted */
+    block_pool_get_stats(&s_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT16(1, stats.used);
+    TEST_ASSERT_EQUAL_UINT16(1, head_index(&s_test_pool));
+}
+
+/**
+ * @brief Test a pool over existing arrays
+ */
+void test_block_pool_init_existing(void)
+{
+    uint32_t* word;
+
+    block_pool_init(&s_word_pool);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(uint32_t), s_word_pool.block_size);
+    TEST_ASSERT_EQUAL_UINT16(3, s_word_pool.count);
+
+    word = block_pool_alloc(&s_word_pool);
+    TEST_ASSERT_TRUE(word == &s_words[0]);
+    word = block_pool_alloc(&s_word_pool);
+    TEST_ASSERT_EQUAL_INT32(1, block_pool_index(&s_word_pool, word));
+    TEST_ASSERT_TRUE(block_pool_free(&s_word_pool, word));
+
+    /* Init makes every block free again */
+    block_pool_init(&s_word_pool);
+    for (uint32_t i = 0; i < 3U; i++)
+    {
+        TEST_ASSERT_TRUE(block_pool_alloc(&s_word_pool) == &s_words[i]);
+    }
+}
+
+/* ==========================================================================
+ * Statistics Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test the use count, high-water mark and refused allocations
+ */
+void test_block_pool_stats(void)
+{
+    void* blocks[TEST_POOL_BLOCKS];
+    block_pool_stats_t stats;
+
+    block_pool_init(&s_test_pool);
+    for (uint32_t i = 0; i < TEST_POOL_BLOCKS; i++)
+    {
+        blocks[i] = block_pool_alloc(&s_test_pool);
+    }
+    TEST_ASSERT_NULL(block_pool_alloc(&s_test_pool));
+    TEST_ASSERT_NULL(block_pool_alloc(&s_test_pool));
+    TEST_ASSERT_TRUE(block_pool_free(&s_test_pool, blocks[2]));
+    TEST_ASSERT_TRUE(block_pool_free(&s_test_pool, blocks[0]));
+    TEST_ASSERT_TRUE(block_pool_available(&s_test_pool));
+
+    block_pool_get_stats(&s_test_pool, &stats);
+    TEST_ASSERT_EQUAL_STRING("s_test_pool", stats.name);
+    TEST_ASSERT_EQUAL_UINT16(TEST_POOL_BLOCKS, stats.count);
+    TEST_ASSERT_EQUAL_UINT16(2, stats.used);
+    TEST_ASSERT_EQUAL_UINT16(TEST_POOL_BLOCKS, stats.max_used);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.failures);
+
+    /* Init clears them */
+    block_pool_init(&s_test_pool);
+    block_pool_get_stats(&s_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT16(0, stats.used);
+    TEST_ASSERT_EQUAL_UINT16(0, stats.max_used);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.failures);
+}
@@ -0,0 +1,639 @@
+/**
+ * @file test_fota_decode.c
+ * @brief Unity unit tests for the FOTA payload decoder
+ *
+ * Tests fota_decode.c: patches made here from a base image, and LZ4
+ * blocks made here, must rebuild the image however the payload is cut
+ * into segments, and malformed ones must be refused before any of their
+ * bytes reach the output. The base image and the update slot are arrays
+ * here, and the output copies into the slot.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include "unity.h"
+#include "fota_decode.h"
+#include <stdbool.h>
+#include <string.h>
+
+/* ==========================================================================
+ * Test Helpers
+ * ========================================================================== */
+
+/** Largest payload and image of a test */
+#define TEST_STREAM_SIZE (16U * 1024U)
+
+/** Size of the base image of the patches */
+#define TEST_BASE_SIZE 8192U
+
+static fota_decode_t s_decode;
+static uint8_t s_stream[TEST_STREAM_SIZE];
+static uint32_t s_stream_length;
+static uint8_t s_image[TEST_STREAM_SIZE];
+static uint32_t s_image_length;
+static uint8_t s_base[TEST_BASE_SIZE];
+
+/** Update slot, and the image bytes output into it */
+static uint8_t s_slot[TEST_STREAM_SIZE];
+static uint32_t s_written;
+
+/** Status the output returns */
+static fota_status_t s_output_status;
+
+/** Deterministic noise, a 32-bit LCG */
+static uint32_t s_seed;
+
+static uint8_t noise(void)
+{
+    s_seed = (s_seed * 1664525U) + 1013904223U;
+    return (uint8_t)(s_seed >> 24);
+}
+
+/** Fill the base image of the patches */
+static void fill_base(void)
+{
+    s_seed = 7U;
+    for (uint32_t i = 0; i < TEST_BASE_SIZE; i++)
+    {
+        s_base[i] = noise();
+    }
+}
+
+/**
+ * @brief Output of the decoder, appending the chunk to the slot
+ *
+ * Only the last chunk may be short.
+ */
+static fota_status_t output(void* context, uint8_t* chunk, uint32_t length)
+{
+    TEST_ASSERT_TRUE(context == &s_decode);
+    TEST_ASSERT_EQUAL_UINT32(0U, s_written % FOTA_CHUNK_SIZE);
+    TEST_ASSERT_TRUE(length <= (sizeof(s_slot) - s_written));
+    (void)memcpy(&s_slot[s_written], chunk, length);
+    s_written += length;
+
+    return s_output_status;
+}
+
+/**
+ * @brief Start decoding a payload
+ *
+ * @param base_size Base of a patch, checked with its CRC-32
+ * @return Status of the base, FOTA_STATUS_OK for another payload
+ */
+static fota_status_t start_decode(fota_payload_t type, uint32_t image_size,
+                                  uint32_t base_size)
+{
+    (void)memset(s_slot, 0xEE, sizeof(s_slot));
+    s_written = 0U;
+    s_output_status = FOTA_STATUS_OK;
+    fota_decode_init(&s_decode, type, image_size, output, &s_decode);
+
+    if (type != FOTA_PAYLOAD_DELTA)
+    {
+        return FOTA_STATUS_OK;
+    }
+    return fota_decode_base(&s_decode, s_base, base_size,
+                            fota_crc32(s_base, base_size));
+}
+
+/**
+ * @brief Start a payload that is written afterwards
+ */
+static fota_status_t start_transfer(fota_payload_t type, uint32_t image_size,
+                                    uint32_t base_size)
+{
+    s_stream_length = 0U;
+    s_image_length = 0U;
+
+    return start_decode(type, image_size, base_size);
+}
+
+/**
+ * @brief Hand the payload over in segments of @p segment bytes
+ * @return The first status that is not FOTA_STATUS_OK, or that one
+ */
+static fota_status_t take_stream(uint32_t segment)
+{
+    fota_status_t status = FOTA_STATUS_OK;
+
+    for (uint32_t pos = 0;
+         (status == FOTA_STATUS_OK) && (pos < s_stream_length); pos += segment)
+    {
+        uint32_t n = s_stream_length - pos;
+
+        if (n > segment)
+        {
+            n = segment;
+        }
+        status = fota_decode_take(&s_decode, &s_stream[pos], n);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Assert that the payload rebuilt the expected image in the slot
+ */
+static void assert_image_written(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(s_image_length, s_decode.received);
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK, fota_decode_finish(&s_decode));
+    TEST_ASSERT_EQUAL_UINT32(s_image_length, s_written);
+    TEST_ASSERT_EQUAL_MEMORY(s_image, s_slot, s_image_length);
+
+    /* Nothing is left for a second finish */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK, fota_decode_finish(&s_decode));
+    TEST_ASSERT_EQUAL_UINT32(s_image_length, s_written);
+}
+
+/**
+ * @brief Assert that a payload is refused and produced nothing further
+ *
+ * @param received Image bytes produced before the malformed command
+ */
+static void assert_refused(fota_status_t status, uint32_t received)
+{
+    TEST_ASSERT_EQUAL(FOTA_STATUS_BAD_PATCH, status);
+    TEST_ASSERT_EQUAL_UINT32(received, s_decode.received);
+}
+
+static void put_byte(uint8_t byte)
+{
+    s_stream[s_stream_length++] = byte;
+}
+
+/* ==========================================================================
+ * Patch Writer
+ * ========================================================================== */
+
+static void put_varint(uint32_t value)
+{
+    while (value >= 0x80U)
+    {
+        put_byte((uint8_t)(value | 0x80U));
+        value >>= 7;
+    }
+    put_byte((uint8_t)value);
+}
+
+/** Last base offset copied from, as the decoder tracks it */
+static uint32_t s_copy_end;
+
+/**
+ * @brief Append an ADD of @p length fresh bytes
+ */
+static void patch_add(uint32_t length)
+{
+    put_varint(length << 1);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint8_t byte = noise();
+
+        put_byte(byte);
+        s_image[s_image_length++] = byte;
+    }
+}
+
+/**
+ * @brief Append a COPY of @p length base bytes from @p source
+ */
+static void patch_copy(uint32_t source, uint32_t length)
+{
+    int32_t distance = (int32_t)source - (int32_t)s_copy_end;
+
+    put_varint((length << 1) | 1U);
+    put_varint(((uint32_t)distance << 1) ^ (uint32_t)(distance >> 31));
+    (void)memcpy(&s_image[s_image_length], &s_base[source], length);
+    s_image_length += length;
+    s_copy_end = source + length;
+}
+
+/**
+ * @brief Write the patch of the rebuild tests, and start its transfer
+ */
+static void start_patch(void)
+{
+    fill_base();
+    s_copy_end = 0U;
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_DELTA, 6005U, 8192U));
+
+    /* Forward and backward COPYs with ADDs between, over three chunks */
+    patch_copy(0U, 3000U);
+    patch_add(100U);
+    patch_copy(5000U, 2000U);
+    patch_copy(1000U, 500U);
+    patch_add(1U);
+    patch_copy(8192U - 397U, 397U);
+    patch_add(7U);
+    TEST_ASSERT_EQUAL_UINT32(6005U, s_image_length);
+}
+
+/* ==========================================================================
+ * Patch Decoder Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test the CRC-32 the base image is checked with
+ */
+void test_fota_crc32(void)
+{
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926U,
+                            fota_crc32((const uint8_t*)"123456789", 9U));
+    TEST_ASSERT_EQUAL_HEX32(0x00000000U, fota_crc32(NULL, 0U));
+}
+
+/**
+ * @brief Test that a patch rebuilds the image in one segment
+ */
+void test_fota_delta_rebuild(void)
+{
+    start_patch();
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK, take_stream(s_stream_length));
+    assert_image_written();
+}
+
+/**
+ * @brief Test that a patch rebuilds the image cut at every byte
+ *
+ * Varints, literals and COPYs are all split between segments.
+ */
+void test_fota_delta_rebuild_split(void)
+{
+    static const uint32_t segments[] = {1U, 2U, 3U, 7U, 1460U};
+
+    for (uint32_t i = 0; i < sizeof(segments) / sizeof(segments[0]); i++)
+    {
+        start_patch();
+        TEST_ASSERT_EQUAL(FOTA_STATUS_OK, take_stream(segments[i]));
+        assert_image_written();
+    }
+}
+
+/**
+ * @brief Test that bytes after the end of the image are ignored
+ */
+void test_fota_delta_trailing_bytes(void)
+{
+    start_patch();
+    put_byte(0xFFU);
+    put_byte(0x00U);
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK, take_stream(s_stream_length));
+    assert_image_written();
+}
+
+/**
+ * @brief Test that a patch is only taken on the base it was made from
+ */
+void test_fota_delta_bad_base(void)
+{
+    fill_base();
+    fota_decode_init(&s_decode, FOTA_PAYLOAD_DELTA, 64U, output, &s_decode);
+    TEST_ASSERT_EQUAL(FOTA_STATUS_BAD_HEADER,
+                      fota_decode_base(&s_decode, s_base, 0U, 0U));
+
+    /* The CRC of another base */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_BAD_BASE,
+                      fota_decode_base(&s_decode, s_base, 4096U,
+                                       fota_crc32(s_base, 4095U)));
+}
+
+/**
+ * @brief Test that COPYs reaching outside the base are refused
+ */
+void test_fota_delta_copy_outside_base(void)
+{
+    fill_base();
+
+    /* Past the end of the base by one byte */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_DELTA, 256U, 1024U));
+    s_copy_end = 0U;
+    patch_copy(0U, 16U);
+    patch_copy(1024U - 15U, 16U);
+    assert_refused(take_stream(s_stream_length), 16U);
+
+    /* Before its start */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_DELTA, 256U, 1024U));
+    put_varint((16U << 1) | 1U);
+    put_varint((40U << 1) | 1U);
+    assert_refused(take_stream(s_stream_length), 0U);
+
+    /* A distance so far it would wrap around */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_DELTA, 256U, 1024U));
+    put_varint((16U << 1) | 1U);
+    put_varint(0xFFFFFFFEU);
+    assert_refused(take_stream(s_stream_length), 0U);
+}
+
+/**
+ * @brief Test that commands longer than the rest of the image are refused
+ */
+void test_fota_delta_length_past_image(void)
+{
+    fill_base();
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_DELTA, 100U, 1024U));
+    patch_add(60U);
+    put_varint(41U << 1);
+    assert_refused(take_stream(s_stream_length), 60U);
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_DELTA, 100U, 1024U));
+    put_varint((101U << 1) | 1U);
+    put_varint(0U);
+    assert_refused(take_stream(s_stream_length), 0U);
+
+    /* A command of no bytes would never end the patch */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_DELTA, 100U, 1024U));
+    put_varint(0U);
+    assert_refused(take_stream(s_stream_length), 0U);
+}
+
+/**
+ * @brief Test that a varint of more than 32 bits is refused
+ */
+void test_fota_delta_varint_overflow(void)
+{
+    fill_base();
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_DELTA, 100U, 1024U));
+    for (uint32_t i = 0; i < 4U; i++)
+    {
+        put_byte(0x80U);
+    }
+    put_byte(0x10U);
+    assert_refused(take_stream(1U), 0U);
+}
+
+/* ==========================================================================
+ * Compressed Block Writer
+ * ========================================================================== */
+
+/**
+ * @brief Append a length continuation of @p length beyond the nibble
+ */
+static void put_lz_length(uint32_t length)
+{
+    while (length >= 255U)
+    {
+        put_byte(255U);
+        length -= 255U;
+    }
+    put_byte((uint8_t)length);
+}
+
+/**
+ * @brief Append a sequence of @p literals fresh bytes and a match
+ *
+ * @param match    Match length, at least 4, or 0 for a last sequence of
+ *                 literals only
+ * @param distance Match distance
+ */
+static void lz_sequence(uint32_t literals, uint32_t match, uint32_t distance)
+{
+    uint32_t nibble = (match >= 4U) ? (match - 4U) : 0U;
+
+    put_byte((uint8_t)((((literals < 15U) ? literals : 15U) << 4) |
+                       ((nibble < 15U) ? nibble : 15U)));
+    if (literals >= 15U)
+    {
+        put_lz_length(literals - 15U);
+    }
+    for (uint32_t i = 0; i < literals; i++)
+    {
+        uint8_t byte = noise();
+
+        put_byte(byte);
+        s_image[s_image_length++] = byte;
+    }
+    if (match == 0U)
+    {
+        return;
+    }
+
+    put_byte((uint8_t)distance);
+    put_byte((uint8_t)(distance >> 8));
+    if (nibble >= 15U)
+    {
+        put_lz_length(nibble - 15U);
+    }
+
+    /* Byte by byte, so an overlapping match repeats its start; a malformed
+     * one has no image */
+    for (uint32_t i = 0;
+         (distance > 0U) && (distance <= s_image_length) && (i < match); i++)
+    {
+        s_image[s_image_length] = s_image[s_image_length - distance];
+        s_image_length++;
+    }
+}
+
+/**
+ * @brief Write the block of the decompression tests
+ *
+ * @param end_on_match The block ends on a match, not on literals
+ */
+static void write_lz_block(bool end_on_match)
+{
+    s_seed = 11U;
+    s_stream_length = 0U;
+    s_image_length = 0U;
+
+    lz_sequence(20U, 4U, 20U);
+    /* An overlapping run, and lengths continued over several bytes */
+    lz_sequence(300U, 1000U, 1U);
+    lz_sequence(0U, 19U, 300U);
+    lz_sequence(14U, 18U, 7U);
+    lz_sequence(15U, 19U, 16U);
+    /* The farthest distance, into the other chunk buffer */
+    lz_sequence(800U, 2000U, FOTA_LZ_WINDOW);
+    lz_sequence(1U, 3000U, 2047U);
+    lz_sequence(270U, 520U, 1500U);
+    if (end_on_match)
+    {
+        lz_sequence(3U, 33U, 2U);
+    }
+    else
+    {
+        lz_sequence(10U, 0U, 0U);
+    }
+}
+
+/* ==========================================================================
+ * Decompressor Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test that a block decompresses into the image, ending on literals
+ * and on a match, however it is cut into segments
+ */
+void test_fota_lz_decompress(void)
+{
+    static const uint32_t segments[] = {100000U, 1U, 2U, 5U, 1460U};
+
+    for (uint32_t end = 0; end < 2U; end++)
+    {
+        for (uint32_t i = 0; i < sizeof(segments) / sizeof(segments[0]); i++)
+        {
+            write_lz_block(end != 0U);
+            TEST_ASSERT_GREATER_THAN(3U * FOTA_CHUNK_SIZE, s_image_length);
+            TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                              start_decode(FOTA_PAYLOAD_LZ, s_image_length, 0U));
+            TEST_ASSERT_EQUAL(FOTA_STATUS_OK, take_stream(segments[i]));
+            assert_image_written();
+        }
+    }
+}
+
+/**
+ * @brief Test that bytes after the end of the image are ignored
+ */
+void test_fota_lz_trailing_bytes(void)
+{
+    write_lz_block(true);
+    put_byte(0x4FU);
+    put_byte(0x00U);
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_decode(FOTA_PAYLOAD_LZ, s_image_length, 0U));
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK, take_stream(s_stream_length));
+    assert_image_written();
+}
+
+/**
+ * @brief Test that distances of no bytes, beyond the bytes received or
+ * beyond the window are refused
+ */
+void test_fota_lz_bad_distance(void)
+{
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_LZ, 8192U, 0U));
+    lz_sequence(10U, 4U, 0U);
+    assert_refused(take_stream(s_stream_length), 10U);
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_LZ, 8192U, 0U));
+    lz_sequence(10U, 4U, 11U);
+    assert_refused(take_stream(s_stream_length), 10U);
+
+    /* Before the start of the image in the second sequence */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_LZ, 8192U, 0U));
+    lz_sequence(10U, 4U, 10U);
+    lz_sequence(0U, 4U, 15U);
+    assert_refused(take_stream(3U), 14U);
+
+    /* Within the image, but farther back than the chunk buffers reach */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_LZ, 8192U, 0U));
+    lz_sequence(3000U, 4U, 100U);
+    put_byte(0x00U);
+    put_byte((uint8_t)(FOTA_LZ_WINDOW + 1U));
+    put_byte((uint8_t)((FOTA_LZ_WINDOW + 1U) >> 8));
+    assert_refused(take_stream(s_stream_length), 3004U);
+}
+
+/**
+ * @brief Test that literal and match lengths past the image are refused
+ */
+void test_fota_lz_length_past_image(void)
+{
+    /* Literals: one too many, from the nibble and from a continuation */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_LZ, 10U, 0U));
+    put_byte(0xB0U);
+    assert_refused(take_stream(s_stream_length), 0U);
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_LZ, 300U, 0U));
+    put_byte(0xF0U);
+    put_byte(255U);
+    put_byte(31U);
+    assert_refused(take_stream(s_stream_length), 0U);
+
+    /* A match one byte longer than the rest of the image */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_LZ, 100U, 0U));
+    lz_sequence(50U, 51U, 50U);
+    assert_refused(take_stream(s_stream_length), 50U);
+
+    /* A continuation that only grows, which must not wrap the length */
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_LZ, 8192U, 0U));
+    lz_sequence(4U, 4U, 4U);
+    put_byte(0x0FU);
+    put_byte(8U);
+    put_byte(0U);
+    for (uint32_t i = 0; i < 40U; i++)
+    {
+        put_byte(255U);
+    }
+    assert_refused(take_stream(s_stream_length), 8U);
+}
+
+/* ==========================================================================
+ * Full Image Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test that a full image is output as it is, bytes after its end
+ * ignored
+ */
+void test_fota_image_take(void)
+{
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_IMAGE, 5000U, 0U));
+    s_seed = 3U;
+    for (uint32_t i = 0; i < 5000U; i++)
+    {
+        s_image[s_image_length++] = noise();
+    }
+    (void)memcpy(s_stream, s_image, s_image_length);
+    s_stream_length = s_image_length + 3U;
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK, take_stream(333U));
+    assert_image_written();
+}
+
+/**
+ * @brief Test that a resumed image goes on at the offset it is given
+ */
+void test_fota_image_resume(void)
+{
+    const uint32_t offset = 2U * FOTA_CHUNK_SIZE;
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_IMAGE, offset + 100U, 0U));
+    fota_decode_resume(&s_decode, offset);
+    s_written = offset;
+    for (uint32_t i = 0; i < 100U; i++)
+    {
+        put_byte((uint8_t)i);
+    }
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK, take_stream(s_stream_length));
+    TEST_ASSERT_EQUAL_UINT32(offset + 100U, s_decode.received);
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK, fota_decode_finish(&s_decode));
+    TEST_ASSERT_EQUAL_UINT32(offset + 100U, s_written);
+    TEST_ASSERT_EQUAL_MEMORY(s_stream, &s_slot[offset], 100U);
+}
+
+/**
+ * @brief Test that a status of the output ends the payload
+ */
+void test_fota_output_status(void)
+{
+    TEST_ASSERT_EQUAL(FOTA_STATUS_OK,
+                      start_transfer(FOTA_PAYLOAD_IMAGE, 8192U, 0U));
+    s_stream_length = 3U * FOTA_CHUNK_SIZE;
+    s_output_status = FOTA_STATUS_FLASH;
+
+    TEST_ASSERT_EQUAL(FOTA_STATUS_FLASH, take_stream(s_stream_length));
+    TEST_ASSERT_EQUAL_UINT32(FOTA_CHUNK_SIZE, s_written);
+}
@@ -0,0 +1,227 @@
+/**
+ * @file test_jerry_printf.c
+ * @brief Unity unit tests for the allocation-free formatter
+ *
+ * Tests jerry_snprintf() against the host C library's snprintf() on the
+ * flags, widths, precisions and length modifiers of the subset it
+ * supports, and on cut output, plus what it does with the conversions it
+ * does not support.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include "unity.h"
+#include "jerry_printf.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* The formats combine flags that cancel out and cut their output on
+ * purpose */
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wformat"
+#if !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#endif
+#endif
+
+/* ==========================================================================
+ * Test Helpers
+ * ========================================================================== */
+
+static char s_expected[128];
+static char s_actual[128];
+
+/**
+ * @brief Assert that a format gives the same text and length as snprintf()
+ */
+#define ASSERT_AS_SNPRINTF(...)                                          \
+    do                                                                   \
+    {                                                                    \
+        int expected_length =                                            \
+            snprintf(s_expected, sizeof(s_expected), __VA_ARGS__);       \
+        int actual_length =                                              \
+            jerry_snprintf(s_actual, sizeof(s_actual), __VA_ARGS__);     \
+        TEST_ASSERT_EQUAL_STRING(s_expected, s_actual);                  \
+        TEST_ASSERT_EQUAL_INT(expected_length, actual_length);           \
+    } while (0)
+
+/* ==========================================================================
+ * Flag Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test the flags and which of them wins when they conflict
+ */
+void test_printf_flags(void)
+{
+    ASSERT_AS_SNPRINTF("[%-6d]", 42);
+    ASSERT_AS_SNPRINTF("[%06d]", -42);
+    ASSERT_AS_SNPRINTF("[%+d] [%+d] [%+d]", 42, -42, 0);
+    ASSERT_AS_SNPRINTF("[% d] [% d]", 42, -42);
+
+    /* '+' beats ' ', '-' beats '0' */
+    ASSERT_AS_SNPRINTF("[%+ d] [% +d]", 42, 42);
+    ASSERT_AS_SNPRINTF("[%-06d]", 42);
+
+    /* No sign for unsigned conversions */
+    ASSERT_AS_SNPRINTF("[%+u] [% x]", 42U, 42U);
+}
+
+/**
+ * @brief Test the alternate forms of the octal and hexadecimal conversions
+ */
+void test_printf_alternate_form(void)
+{
+    ASSERT_AS_SNPRINTF("[%#x] [%#X] [%#o]", 255U, 255U, 8U);
+
+    /* No prefix for 0; octal always shows a leading 0 */
+    ASSERT_AS_SNPRINTF("[%#x] [%#o] [%#.0o] [%#.0x]", 0U, 0U, 0U, 0U);
+    ASSERT_AS_SNPRINTF("[%#.3o] [%#.4o]", 8U, 8U);
+
+    /* Zero padding goes between the prefix and the digits */
+    ASSERT_AS_SNPRINTF("[%#08x] [%-#8x] [%#8.4x]", 0xABU, 0xABU, 0xABU);
+}
+
+/* ==========================================================================
+ * Width and Precision Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test field widths, given and taken from the arguments
+ */
+void test_printf_width(void)
+{
+    ASSERT_AS_SNPRINTF("[%8s] [%-8s]", "abc", "abc");
+    ASSERT_AS_SNPRINTF("[%3c] [%-3c]", 'x', 'y');
+    ASSERT_AS_SNPRINTF("[%*d]", 6, 42);
+
+    /* A negative width from the arguments means '-' */
+    ASSERT_AS_SNPRINTF("[%*d] [%*s]", -6, 42, -4, "ab");
+
+    /* A width smaller than the text never cuts it */
+    ASSERT_AS_SNPRINTF("[%2d] [%1s]", -12345, "abc");
+}
+
+/**
+ * @brief Test precisions: minimum digits, or the longest string
+ */
+void test_printf_precision(void)
+{
+    ASSERT_AS_SNPRINTF("[%.5d] [%.5d] [%.10x]", 42, -42, 0xBEEFU);
+
+    /* Precision 0 prints no digits for 0, but keeps the width */
+    ASSERT_AS_SNPRINTF("[%.0d] [%5.0d] [%.0u]", 0, 0, 0U);
+    ASSERT_AS_SNPRINTF("[%.d] [%+.0d]", 0, 0);
+
+    /* With a precision the '0' flag is ignored */
+    ASSERT_AS_SNPRINTF("[%08.3d] [%-8.3d]", -7, 7);
+
+    ASSERT_AS_SNPRINTF("[%.3s] [%.0s] [%8.2s]", "abcdef", "abc", "abc");
+
+    /* A negative precision from the arguments is as if none were given */
+    ASSERT_AS_SNPRINTF("[%.*d] [%.*s]", 4, 7, -1, "abc");
+    ASSERT_AS_SNPRINTF("[%.*s]", 2, "abc");
+}
+
+/**
+ * @brief Test that a string is not read past its precision
+ */
+void test_printf_precision_unterminated(void)
+{
+    const char text[3] = {'a', 'b', 'c'};
+
+    TEST_ASSERT_EQUAL_INT(
+        3, jerry_snprintf(s_actual, sizeof(s_actual), "%.3s", text));
+    TEST_ASSERT_EQUAL_STRING("abc", s_actual);
+}
+
+/* ==========================================================================
+ * Length Modifier Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test the length modifiers at the limits of their types
+ */
+void test_printf_lengths(void)
+{
+    ASSERT_AS_SNPRINTF("[%d] [%d] [%u]", INT_MIN, INT_MAX, UINT_MAX);
+    ASSERT_AS_SNPRINTF("[%lld] [%lld]", LLONG_MIN, LLONG_MAX);
+    ASSERT_AS_SNPRINTF("[%llu] [%llo] [%llX]", ULLONG_MAX, ULLONG_MAX,
+                       ULLONG_MAX);
+    ASSERT_AS_SNPRINTF("[%ld] [%lu] [%lx]", LONG_MIN, ULONG_MAX, ULONG_MAX);
+
+    /* hh and h convert the promoted argument back */
+    ASSERT_AS_SNPRINTF("[%hhd] [%hhu] [%hd] [%hu]", 300, 300, 70000, 70000);
+    ASSERT_AS_SNPRINTF("[%hhd] [%hx]", -129, -1);
+
+    ASSERT_AS_SNPRINTF("[%zu] [%td] [%jd] [%ju]", (size_t)SIZE_MAX,
+                       (ptrdiff_t)-5, (intmax_t)INT64_MIN,
+                       (uintmax_t)UINT64_MAX);
+}
+
+/**
+ * @brief Test characters, strings, pointers and the percent sign
+ */
+void test_printf_conversions(void)
+{
+    int value = 0;
+    const char* none = NULL;
+
+    ASSERT_AS_SNPRINTF("%c%s%%%i", 'a', "bc", -1);
+    ASSERT_AS_SNPRINTF("[%p]", (void*)&value);
+    ASSERT_AS_SNPRINTF("[%20p] [%-20p]", (void*)&value, (void*)&value);
+    ASSERT_AS_SNPRINTF("no conversions");
+    ASSERT_AS_SNPRINTF("%s", "");
+
+    TEST_ASSERT_EQUAL_INT(
+        8, jerry_snprintf(s_actual, sizeof(s_actual), "[%s]", none));
+    TEST_ASSERT_EQUAL_STRING("[(null)]", s_actual);
+}
+
+/**
+ * @brief Test that unsupported conversions are copied as written
+ */
+void test_printf_unsupported(void)
+{
+    /* The conversion takes no argument, the 7 is left for %d */
+    int length =
+        jerry_snprintf(s_actual, sizeof(s_actual), "a%5.2fb%dc", 7);
+
+    TEST_ASSERT_EQUAL_STRING("a%5.2fb7c", s_actual);
+    TEST_ASSERT_EQUAL_INT(9, length);
+
+    length = jerry_snprintf(s_actual, sizeof(s_actual), "%-08q|%");
+    TEST_ASSERT_EQUAL_STRING("%-08q|%", s_actual);
+    TEST_ASSERT_EQUAL_INT(7, length);
+}
+
+/* ==========================================================================
+ * Output Length Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test that cut output is terminated and the full length returned
+ */
+void test_printf_truncation(void)
+{
+    char expected[8];
+    char actual[8];
+    int expected_length;
+    int actual_length;
+
+    for (size_t size = 1U; size <= sizeof(actual); size++)
+    {
+        (void)memset(expected, 'Z', sizeof(expected));
+        (void)memset(actual, 'Z', sizeof(actual));
+        expected_length = snprintf(expected, size, "%-4d|%05x", -12, 0xABU);
+        actual_length = jerry_snprintf(actual, size, "%-4d|%05x", -12, 0xABU);
+
+        TEST_ASSERT_EQUAL_INT(expected_length, actual_length);
+        TEST_ASSERT_EQUAL_MEMORY(expected, actual, sizeof(actual));
+    }
+
+    /* Size 0 only measures, the buffer may be NULL */
+    TEST_ASSERT_EQUAL_INT(10, jerry_snprintf(NULL, 0U, "%010d", 1));
+}
@@ -10,6 +10,15 @@
 
 #include "modbus_callbacks.h"
 
+/* ==========================================================================
+ * Stub Register Image
+ * ========================================================================== */
+
+/** Holding registers 0-15 keep what FC16/FC23 write, for read-back tests */
+#define STUB_HOLDING_REGISTERS 16U
+
+static uint16_t s_holding_registers[STUB_HOLDING_REGISTERS];
+
 /* ==========================================================================
  * Stub Callback Implementations
  * ========================================================================== */
@@ -44,9 +53,12 @@ modbus_exception_t modbus_cb_read_discrete_inputs(uint16_t start_address,
 modbus_exception_t modbus_cb_read_holding_registers(uint16_t start_address,
                                                     uint16_t quantity,
                                                     uint16_t *register_values) {
-  (void)start_address;
-  (void)quantity;
-  (void)register_values;
+  for (uint16_t i = 0U; i < quantity; i++) {
+    uint32_t address = (uint32_t)start_address + i;
+    if (address < STUB_HOLDING_REGISTERS) {
+      register_values[i] = s_holding_registers[address];
+    }
+  }
   return MODBUS_EXCEPTION_NONE;
 }
 
@@ -99,8 +111,11 @@ modbus_exception_t modbus_cb_write_multiple_coils(uint16_t start_address,
 modbus_exception_t
 modbus_cb_write_multiple_registers(uint16_t start_address, uint16_t quantity,
                                    const uint16_t *register_values) {
-  (void)start_address;
-  (void)quantity;
-  (void)register_values;
+  for (uint16_t i = 0U; i < quantity; i++) {
+    uint32_t address = (uint32_t)start_address + i;
+    if (address < STUB_HOLDING_REGISTERS) {
+      s_holding_registers[address] = register_values[i];
+    }
+  }
   return MODBUS_EXCEPTION_NONE;
 }
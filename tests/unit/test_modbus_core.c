@@ -0,0 +1,1115 @@
+/**
+ * @file test_modbus_core.c
+ * @brief Unity unit tests for Modbus core slave dispatch
+ *
+ * Tests the table-driven function code dispatch including length
+ * validation, unsupported function codes and custom handlers.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include "unity.h"
+#include "modbus_types.h"
+#include <string.h>
+
+/* ==========================================================================
+ * External Function Declarations
+ * ========================================================================== */
+
+extern modbus_error_t modbus_init(modbus_context_t* ctx,
+                                  const modbus_config_t* config);
+extern modbus_error_t modbus_slave_register_handler(
+    modbus_context_t* ctx, const modbus_fc_entry_t* entry);
+extern modbus_error_t modbus_slave_process_pdu_view(
+    modbus_context_t* ctx, const modbus_pdu_view_t* request,
+    modbus_pdu_t* response);
+extern modbus_error_t modbus_slave_process_pdu_buffer(
+    modbus_context_t* ctx, const modbus_pdu_view_t* request,
+    modbus_pdu_buffer_t* response);
+extern modbus_error_t modbus_pdu_buffer_from_frame(
+    uint8_t* frame, uint16_t frame_size, modbus_pdu_buffer_t* buffer);
+extern uint16_t modbus_slave_get_response_bound(const modbus_context_t* ctx,
+                                                uint8_t function_code);
+extern modbus_error_t modbus_slave_set_device_id(
+    modbus_context_t* ctx, const modbus_device_id_t* device_id);
+extern modbus_error_t modbus_slave_set_file_reader(modbus_context_t* ctx,
+                                                   modbus_file_read_t reader);
+extern modbus_error_t modbus_slave_set_file_mapper(modbus_context_t* ctx,
+                                                   modbus_file_map_t mapper);
+extern modbus_error_t modbus_slave_set_file_writer(modbus_context_t* ctx,
+                                                   modbus_file_write_t writer);
+extern modbus_error_t modbus_slave_set_callbacks(
+    modbus_context_t* ctx, const modbus_slave_callbacks_t* callbacks);
+extern void modbus_reset_statistics(modbus_context_t* ctx);
+#if MODBUS_ENABLE_LATENCY_STATS
+extern modbus_error_t modbus_slave_set_latency_stats(
+    modbus_context_t* ctx, modbus_latency_stats_t* stats);
+extern void modbus_slave_mark_frame_start(modbus_context_t* ctx);
+#endif
+
+/* ==========================================================================
+ * Test Helpers
+ * ========================================================================== */
+
+static modbus_context_storage_t s_ctx_storage;
+static uint8_t s_custom_calls;
+
+static modbus_context_t* init_slave_context(void)
+{
+    modbus_context_t* ctx = (modbus_context_t*)&s_ctx_storage;
+    modbus_config_t config;
+
+    memset(&config, 0, sizeof(config));
+    config.mode = MODBUS_MODE_SLAVE;
+    config.protocol = MODBUS_PROTOCOL_TCP;
+    config.unit_id = 0x01;
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_init(ctx, &config));
+    s_custom_calls = 0;
+
+    return ctx;
+}
+
+static modbus_error_t custom_echo_handler(modbus_context_t* ctx,
+                                          const modbus_pdu_view_t* request,
+                                          modbus_pdu_buffer_t* response)
+{
+    (void)ctx;
+    s_custom_calls++;
+    *response->function_code = request->function_code;
+    memcpy(response->data, request->data, request->data_length);
+    response->data_length = request->data_length;
+    return MODBUS_OK;
+}
+
+/* ==========================================================================
+ * Test Cases - Function Code Dispatch
+ * ========================================================================== */
+
+/**
+ * @brief Test that an unsupported function code yields ILLEGAL_FUNCTION
+ */
+void test_core_dispatch_unknown_function(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t data[] = {0x00, 0x00};
+    modbus_pdu_view_t request = {0x41, data, sizeof(data)};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0xC1, response.function_code);
+    TEST_ASSERT_EQUAL(1, response.data_length);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_FUNCTION, response.data[0]);
+    TEST_ASSERT_EQUAL(2, modbus_slave_get_response_bound(ctx, 0x41));
+}
+
+/**
+ * @brief Test that a request with a bad data length is rejected up front
+ */
+void test_core_dispatch_bad_length(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t data[] = {0x00, 0x00, 0x00};  /* FC03 needs 4 bytes */
+    modbus_pdu_view_t request = {MODBUS_FC_READ_HOLDING_REGISTERS, data,
+                                 sizeof(data)};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x83, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE,
+                           response.data[0]);
+}
+
+/**
+ * @brief Test that a registered custom handler is dispatched
+ */
+void test_core_dispatch_custom_handler(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t data[] = {0xAB, 0xCD};
+    modbus_pdu_view_t request = {0x41, data, sizeof(data)};
+    static const modbus_fc_entry_t entry = {0x41, custom_echo_handler, 1, 8,
+                                            9};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_register_handler(ctx, &entry));
+    TEST_ASSERT_EQUAL(9, modbus_slave_get_response_bound(ctx, 0x41));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL(1, s_custom_calls);
+    TEST_ASSERT_EQUAL_HEX8(0x41, response.function_code);
+    TEST_ASSERT_EQUAL(2, response.data_length);
+    TEST_ASSERT_EQUAL_HEX8(0xAB, response.data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xCD, response.data[1]);
+}
+
+/* ==========================================================================
+ * Test Cases - In-Place Response Building
+ * ========================================================================== */
+
+/**
+ * @brief Test that a response PDU is written straight into a frame
+ */
+void test_core_process_pdu_buffer_in_frame(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    uint8_t frame[16];
+    modbus_pdu_buffer_t response;
+    const uint8_t data[] = {0xAB, 0xCD};
+    modbus_pdu_view_t request = {0x41, data, sizeof(data)};
+    static const modbus_fc_entry_t entry = {0x41, custom_echo_handler, 1, 8,
+                                            9};
+
+    memset(frame, 0xEE, sizeof(frame));
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_register_handler(ctx, &entry));
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_pdu_buffer_from_frame(&frame[1],
+                                                   sizeof(frame) - 1U,
+                                                   &response));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_process_pdu_buffer(
+                                     ctx, &request, &response));
+    TEST_ASSERT_EQUAL(2, response.data_length);
+    TEST_ASSERT_EQUAL_HEX8(0xEE, frame[0]);  /* Header space untouched */
+    TEST_ASSERT_EQUAL_HEX8(0x41, frame[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xAB, frame[2]);
+    TEST_ASSERT_EQUAL_HEX8(0xCD, frame[3]);
+    TEST_ASSERT_EQUAL_HEX8(0xEE, frame[4]);
+}
+
+/**
+ * @brief Test that a response not fitting the buffer is refused
+ */
+void test_core_process_pdu_buffer_overflow(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    uint8_t frame[1];
+    modbus_pdu_buffer_t response;
+    modbus_pdu_view_t request = {0x42, NULL, 0};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_pdu_buffer_from_frame(frame, sizeof(frame),
+                                                   &response));
+
+    /* The exception needs one data byte behind the function code */
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_BUFFER_OVERFLOW,
+                      modbus_slave_process_pdu_buffer(ctx, &request,
+                                                      &response));
+}
+
+/* ==========================================================================
+ * Test Cases - Read/Write Multiple Registers (FC23)
+ * ========================================================================== */
+
+/**
+ * @brief Test that FC23 writes before it reads
+ */
+void test_core_read_write_registers(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t data[] = {
+        0x00, 0x03,  /* Read starting address 3 */
+        0x00, 0x03,  /* Read 3 registers */
+        0x00, 0x04,  /* Write starting address 4 */
+        0x00, 0x02,  /* Write 2 registers */
+        0x04,        /* Byte count */
+        0x11, 0x11, 0x22, 0x22
+    };
+    modbus_pdu_view_t request = {MODBUS_FC_READ_WRITE_MULTIPLE_REGS, data,
+                                 sizeof(data)};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x17, response.function_code);
+    TEST_ASSERT_EQUAL(7, response.data_length);
+    TEST_ASSERT_EQUAL_HEX8(0x06, response.data[0]);  /* Byte count */
+    TEST_ASSERT_EQUAL_HEX8(0x11, response.data[3]);  /* Register 4 */
+    TEST_ASSERT_EQUAL_HEX8(0x11, response.data[4]);
+    TEST_ASSERT_EQUAL_HEX8(0x22, response.data[5]);  /* Register 5 */
+    TEST_ASSERT_EQUAL_HEX8(0x22, response.data[6]);
+}
+
+/**
+ * @brief Test that an FC23 byte count not matching the quantity is refused
+ */
+void test_core_read_write_registers_bad_count(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t data[] = {0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+                            0x00, 0x02, 0x02, 0x12, 0x34};
+    modbus_pdu_view_t request = {MODBUS_FC_READ_WRITE_MULTIPLE_REGS, data,
+                                 sizeof(data)};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x97, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE,
+                           response.data[0]);
+}
+
+/* ==========================================================================
+ * Test Cases - Callback Tables
+ * ========================================================================== */
+
+/** Calls of the table below */
+static uint8_t s_table_calls;
+
+static modbus_exception_t table_read_bits(uint16_t start_address,
+                                          uint16_t quantity, uint8_t* values)
+{
+    (void)start_address;
+    (void)quantity;
+    (void)values;
+    s_table_calls++;
+    return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+}
+
+static modbus_exception_t table_write_coil(uint16_t address, bool value)
+{
+    (void)address;
+    (void)value;
+    s_table_calls++;
+    return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+}
+
+static modbus_exception_t table_write_coils(uint16_t start_address,
+                                            uint16_t quantity,
+                                            const uint8_t* values)
+{
+    (void)start_address;
+    (void)quantity;
+    (void)values;
+    s_table_calls++;
+    return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+}
+
+/** Every register reads back its own address plus 0x1000 */
+static modbus_exception_t table_read_registers(uint16_t start_address,
+                                               uint16_t quantity,
+                                               uint16_t* values)
+{
+    for (uint16_t i = 0; i < quantity; i++)
+    {
+        values[i] = (uint16_t)(0x1000U + start_address + i);
+    }
+    s_table_calls++;
+    return MODBUS_EXCEPTION_NONE;
+}
+
+static modbus_exception_t table_write_register(uint16_t address,
+                                               uint16_t value)
+{
+    (void)address;
+    (void)value;
+    s_table_calls++;
+    return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+}
+
+static modbus_exception_t table_write_registers(uint16_t start_address,
+                                                uint16_t quantity,
+                                                const uint16_t* values)
+{
+    (void)start_address;
+    (void)quantity;
+    (void)values;
+    s_table_calls++;
+    return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+}
+
+static const modbus_slave_callbacks_t s_read_only_table = {
+    table_read_bits,      table_write_coil,      table_write_coils,
+    table_read_bits,      table_read_registers,  table_write_register,
+    table_write_registers, table_read_registers,
+};
+
+/** Send one FC03 request for two registers at address 5 */
+static modbus_error_t read_two_registers(modbus_context_t* ctx,
+                                         modbus_pdu_t* response)
+{
+    const uint8_t data[] = {0x00, 0x05, 0x00, 0x02};
+    modbus_pdu_view_t request = {MODBUS_FC_READ_HOLDING_REGISTERS, data,
+                                 sizeof(data)};
+
+    return modbus_slave_process_pdu_view(ctx, &request, response);
+}
+
+/**
+ * @brief Test that a context dispatches to its own table
+ */
+void test_core_callback_table(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t write[] = {0x00, 0x05, 0x12, 0x34};
+    modbus_pdu_view_t write_request = {MODBUS_FC_WRITE_SINGLE_REGISTER, write,
+                                       sizeof(write)};
+
+    s_table_calls = 0;
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_callbacks(ctx, &s_read_only_table));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_two_registers(ctx, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x03, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(0x10, response.data[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x05, response.data[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x10, response.data[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, response.data[4]);
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_process_pdu_view(
+                                     ctx, &write_request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x86, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_FUNCTION,
+                           response.data[0]);
+    TEST_ASSERT_EQUAL(2, s_table_calls);
+
+    /* Back to the modbus_cb_* functions */
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_set_callbacks(ctx, NULL));
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_two_registers(ctx, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x03, response.function_code);
+    TEST_ASSERT_EQUAL(2, s_table_calls);
+}
+
+/**
+ * @brief Test that a table with a missing entry is refused
+ */
+void test_core_callback_table_incomplete(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_slave_callbacks_t table = s_read_only_table;
+    modbus_pdu_t response;
+
+    s_table_calls = 0;
+    table.read_input_registers = NULL;
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_INVALID_PARAM,
+                      modbus_slave_set_callbacks(ctx, &table));
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_INVALID_PARAM,
+                      modbus_slave_set_callbacks(NULL, &s_read_only_table));
+
+    /* The context keeps the modbus_cb_* functions */
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_two_registers(ctx, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x03, response.function_code);
+    TEST_ASSERT_EQUAL(0, s_table_calls);
+}
+
+/* ==========================================================================
+ * Test Cases - Read Scattered Registers (FC100)
+ * ========================================================================== */
+
+/** Every input register reads back its own address plus 0x2000, and those
+ *  from 0x8000 on are unmapped */
+static modbus_exception_t table_read_inputs(uint16_t start_address,
+                                            uint16_t quantity,
+                                            uint16_t* values)
+{
+    s_table_calls++;
+    if (((uint32_t)start_address + quantity) > 0x8000U)
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+    for (uint16_t i = 0; i < quantity; i++)
+    {
+        values[i] = (uint16_t)(0x2000U + start_address + i);
+    }
+    return MODBUS_EXCEPTION_NONE;
+}
+
+static const modbus_slave_callbacks_t s_scatter_table = {
+    table_read_bits,      table_write_coil,      table_write_coils,
+    table_read_bits,      table_read_registers,  table_write_register,
+    table_write_registers, table_read_inputs,
+};
+
+/** Send one FC100 request of the given descriptors: table, address, count */
+static void read_scattered(modbus_context_t* ctx, const uint8_t* descriptors,
+                           uint8_t length, modbus_pdu_t* response)
+{
+    uint8_t data[1U + (5U * MODBUS_SCATTER_MAX_DESCRIPTORS) + 5U];
+    modbus_pdu_view_t request = {MODBUS_FC_READ_SCATTERED_REGISTERS, data,
+                                 (uint16_t)(1U + length)};
+
+    data[0] = length;
+    memcpy(&data[1], descriptors, length);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, response));
+}
+
+/** Assert that the last FC100 request was answered with an exception */
+static void assert_scatter_exception(const modbus_pdu_t* response,
+                                     modbus_exception_t exception)
+{
+    TEST_ASSERT_EQUAL_HEX8(0xE4, response->function_code);
+    TEST_ASSERT_EQUAL_HEX8(exception, response->data[0]);
+}
+
+/**
+ * @brief Test that FC100 returns the blocks of both spaces back to back
+ */
+void test_core_scattered_registers(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t descriptors[] = {
+        0x03, 0x00, 0x05, 0x00, 0x02,  /* Holding 5-6 */
+        0x04, 0x01, 0x00, 0x00, 0x01,  /* Input 256 */
+        0x03, 0x00, 0x28, 0x00, 0x03,  /* Holding 40-42 */
+    };
+    const uint16_t expected[] = {0x1005, 0x1006, 0x2100,
+                                 0x1028, 0x1029, 0x102A};
+
+    s_table_calls = 0;
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_callbacks(ctx, &s_scatter_table));
+
+    read_scattered(ctx, descriptors, sizeof(descriptors), &response);
+    TEST_ASSERT_EQUAL_HEX8(0x64, response.function_code);
+    TEST_ASSERT_EQUAL(13, response.data_length);
+    TEST_ASSERT_EQUAL_HEX8(12, response.data[0]);  /* Byte count */
+    for (uint8_t i = 0; i < 6U; i++)
+    {
+        TEST_ASSERT_EQUAL_HEX16(
+            expected[i], (uint16_t)((response.data[1 + (2 * i)] << 8) |
+                                    response.data[2 + (2 * i)]));
+    }
+    TEST_ASSERT_EQUAL(3, s_table_calls);
+    TEST_ASSERT_EQUAL(252, modbus_slave_get_response_bound(
+                               ctx, MODBUS_FC_READ_SCATTERED_REGISTERS));
+}
+
+/**
+ * @brief Test that FC100 fills a whole response, up to 50 descriptors
+ */
+void test_core_scattered_registers_limits(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    uint8_t descriptors[5U * MODBUS_SCATTER_MAX_DESCRIPTORS];
+    const uint8_t full[] = {0x03, 0x00, 0x00, 0x00, 0x64,
+                            0x04, 0x00, 0x00, 0x00, 0x19};
+    const uint8_t over[] = {0x03, 0x00, 0x00, 0x00, 0x64,
+                            0x04, 0x00, 0x00, 0x00, 0x1A};
+
+    /* 125 registers in two blocks */
+    read_scattered(ctx, full, sizeof(full), &response);
+    TEST_ASSERT_EQUAL_HEX8(0x64, response.function_code);
+    TEST_ASSERT_EQUAL(251, response.data_length);
+    TEST_ASSERT_EQUAL_HEX8(250, response.data[0]);
+
+    /* 50 descriptors of one register each */
+    for (uint8_t i = 0; i < MODBUS_SCATTER_MAX_DESCRIPTORS; i++)
+    {
+        const uint8_t descriptor[] = {0x03, 0x00, (uint8_t)(2U * i), 0x00,
+                                      0x01};
+
+        memcpy(&descriptors[5U * i], descriptor, sizeof(descriptor));
+    }
+    read_scattered(ctx, descriptors, sizeof(descriptors), &response);
+    TEST_ASSERT_EQUAL_HEX8(0x64, response.function_code);
+    TEST_ASSERT_EQUAL(101, response.data_length);
+
+    /* 126 registers */
+    read_scattered(ctx, over, sizeof(over), &response);
+    assert_scatter_exception(&response, MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+}
+
+/**
+ * @brief Test that malformed and unreadable FC100 requests are refused
+ */
+void test_core_scattered_registers_invalid(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t coils[] = {0x01, 0x00, 0x00, 0x00, 0x01};
+    const uint8_t empty[] = {0x03, 0x00, 0x05, 0x00, 0x02,
+                             0x04, 0x00, 0x00, 0x00, 0x00};
+    const uint8_t unmapped[] = {0x03, 0x00, 0x05, 0x00, 0x02,
+                                0x04, 0x7F, 0xFF, 0x00, 0x02};
+    const uint8_t data[] = {0x04, 0x03, 0x00, 0x00, 0x00};
+    modbus_pdu_view_t short_count = {MODBUS_FC_READ_SCATTERED_REGISTERS, data,
+                                     sizeof(data)};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_callbacks(ctx, &s_scatter_table));
+
+    /* A byte count that is not a whole number of descriptors */
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_process_pdu_view(
+                                     ctx, &short_count, &response));
+    assert_scatter_exception(&response, MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+
+    /* Only the register spaces */
+    read_scattered(ctx, coils, sizeof(coils), &response);
+    assert_scatter_exception(&response, MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS);
+
+    read_scattered(ctx, empty, sizeof(empty), &response);
+    assert_scatter_exception(&response, MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE);
+
+    /* The callback's exception ends the request */
+    s_table_calls = 0;
+    read_scattered(ctx, unmapped, sizeof(unmapped), &response);
+    assert_scatter_exception(&response, MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS);
+    TEST_ASSERT_EQUAL(2, s_table_calls);
+}
+
+/* ==========================================================================
+ * Test Cases - Read Device Identification (FC43/14)
+ * ========================================================================== */
+
+static const modbus_device_id_object_t s_device_id_objects[] = {
+    {MODBUS_DEVICE_ID_VENDOR_NAME, 4, "AICS"},
+    {MODBUS_DEVICE_ID_PRODUCT_CODE, 5, "jerry"},
+    {MODBUS_DEVICE_ID_MAJOR_MINOR_REVISION, 5, "1.0.0"},
+    {MODBUS_DEVICE_ID_PRODUCT_NAME, 2, "J1"},
+};
+
+static const modbus_device_id_t s_device_id = {s_device_id_objects, 4};
+
+/** Send one FC43/14 request */
+static modbus_error_t read_device_id(modbus_context_t* ctx, uint8_t read_code,
+                                     uint8_t object_id,
+                                     modbus_pdu_t* response)
+{
+    const uint8_t data[] = {MODBUS_MEI_READ_DEVICE_ID, read_code, object_id};
+    modbus_pdu_view_t request = {MODBUS_FC_ENCAPSULATED_INTERFACE, data,
+                                 sizeof(data)};
+
+    return modbus_slave_process_pdu_view(ctx, &request, response);
+}
+
+/**
+ * @brief Test stream access to the basic and regular objects
+ */
+void test_core_device_id_stream(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+
+    /* No table set: not supported */
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_device_id(ctx, 0x01, 0x00, &response));
+    TEST_ASSERT_EQUAL_HEX8(0xAB, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_FUNCTION,
+                           response.data[0]);
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_set_device_id(ctx, &s_device_id));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_device_id(ctx, 0x01, 0x00, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x2B, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(0x0E, response.data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, response.data[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x82, response.data[2]);  /* Regular, individual */
+    TEST_ASSERT_EQUAL_HEX8(0x00, response.data[3]);  /* No more follows */
+    TEST_ASSERT_EQUAL(3, response.data[5]);
+    TEST_ASSERT_EQUAL(6 + (2 + 4) + (2 + 5) + (2 + 5), response.data_length);
+    TEST_ASSERT_EQUAL_HEX8(0x00, response.data[6]);
+    TEST_ASSERT_EQUAL(4, response.data[7]);
+    TEST_ASSERT_EQUAL_MEMORY("AICS", &response.data[8], 4);
+
+    /* Regular stream continues past the basic objects */
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_device_id(ctx, 0x02, 0x01, &response));
+    TEST_ASSERT_EQUAL(3, response.data[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, response.data[6]);
+
+    /* Unknown object ID restarts the stream */
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_device_id(ctx, 0x02, 0x05, &response));
+    TEST_ASSERT_EQUAL(4, response.data[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, response.data[6]);
+}
+
+/**
+ * @brief Test individual access and request validation
+ */
+void test_core_device_id_specific(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_set_device_id(ctx, &s_device_id));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_device_id(ctx, 0x04, 0x04, &response));
+    TEST_ASSERT_EQUAL(1, response.data[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, response.data[6]);
+    TEST_ASSERT_EQUAL_MEMORY("J1", &response.data[8], 2);
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_device_id(ctx, 0x04, 0x03, &response));
+    TEST_ASSERT_EQUAL_HEX8(0xAB, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, read_device_id(ctx, 0x05, 0x00, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE,
+                           response.data[0]);
+}
+
+/**
+ * @brief Test that a stream not fitting the response continues later
+ */
+void test_core_device_id_more_follows(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    uint8_t frame[1 + 6 + (2 + 4) + (2 + 5)];
+    modbus_pdu_buffer_t response;
+    const uint8_t data[] = {MODBUS_MEI_READ_DEVICE_ID, 0x01, 0x00};
+    modbus_pdu_view_t request = {MODBUS_FC_ENCAPSULATED_INTERFACE, data,
+                                 sizeof(data)};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_set_device_id(ctx, &s_device_id));
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_pdu_buffer_from_frame(frame, sizeof(frame),
+                                                   &response));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_process_pdu_buffer(
+                                     ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, frame[4]);  /* More follows */
+    TEST_ASSERT_EQUAL_HEX8(0x02, frame[5]);  /* Next object ID */
+    TEST_ASSERT_EQUAL(2, frame[6]);
+}
+
+/* ==========================================================================
+ * Test Cases - Read File Record (FC20)
+ * ========================================================================== */
+
+/** Test files 1 and 2: record R of file F reads as 0xF000 + R */
+static modbus_exception_t read_test_file(uint16_t file_number,
+                                         uint16_t record_number,
+                                         uint16_t record_length,
+                                         uint16_t* values)
+{
+    if (file_number > 2U)
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    for (uint16_t i = 0; i < record_length; i++)
+    {
+        values[i] = (uint16_t)((file_number << 12) + record_number + i);
+    }
+
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/** Send one FC20 request with a single sub-request */
+static modbus_error_t read_file_record(modbus_context_t* ctx,
+                                       uint8_t reference_type,
+                                       uint16_t file_number,
+                                       uint16_t record_number,
+                                       uint16_t record_length,
+                                       modbus_pdu_t* response)
+{
+    const uint8_t data[] = {0x07,
+                            reference_type,
+                            (uint8_t)(file_number >> 8),
+                            (uint8_t)file_number,
+                            (uint8_t)(record_number >> 8),
+                            (uint8_t)record_number,
+                            (uint8_t)(record_length >> 8),
+                            (uint8_t)record_length};
+    modbus_pdu_view_t request = {MODBUS_FC_READ_FILE_RECORD, data,
+                                 sizeof(data)};
+
+    return modbus_slave_process_pdu_view(ctx, &request, response);
+}
+
+/**
+ * @brief Test a request with two sub-requests
+ */
+void test_core_file_record_read(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t data[] = {0x0E,
+                            0x06, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+                            0x06, 0x00, 0x02, 0x00, 0x05, 0x00, 0x01};
+    modbus_pdu_view_t request = {MODBUS_FC_READ_FILE_RECORD, data,
+                                 sizeof(data)};
+
+    /* No reader set: not supported */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x06, 1, 0, 1, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x94, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_FUNCTION,
+                           response.data[0]);
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_file_reader(ctx, read_test_file));
+    TEST_ASSERT_EQUAL(MODBUS_MAX_PDU_SIZE,
+                      modbus_slave_get_response_bound(ctx, 0x14));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x14, response.function_code);
+    TEST_ASSERT_EQUAL(11, response.data_length);
+    TEST_ASSERT_EQUAL(10, response.data[0]);
+    TEST_ASSERT_EQUAL(5, response.data[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, response.data[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x10, response.data[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, response.data[4]);
+    TEST_ASSERT_EQUAL_HEX8(0x10, response.data[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, response.data[6]);
+    TEST_ASSERT_EQUAL(3, response.data[7]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, response.data[8]);
+    TEST_ASSERT_EQUAL_HEX8(0x20, response.data[9]);
+    TEST_ASSERT_EQUAL_HEX8(0x05, response.data[10]);
+}
+
+/**
+ * @brief Test request validation and reader exceptions
+ */
+void test_core_file_record_invalid(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t bad_count[] = {0x08, 0x06, 0x00, 0x01, 0x00,
+                                 0x00, 0x00, 0x01, 0x00};
+    modbus_pdu_view_t request = {MODBUS_FC_READ_FILE_RECORD, bad_count,
+                                 sizeof(bad_count)};
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_file_reader(ctx, read_test_file));
+
+    /* Byte count not a whole number of sub-requests */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x94, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE,
+                           response.data[0]);
+
+    /* Wrong reference type, file 0, record past 0x270F, no records */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x05, 1, 0, 1, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x06, 0, 0, 1, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x06, 1, 0x2710, 1, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x06, 1, 0, 0, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+
+    /* Reader exception is passed on */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x06, 3, 0, 1, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x94, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+
+    /* 124 records fit one response, 125 do not */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x06, 1, 0, 124, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x14, response.function_code);
+    TEST_ASSERT_EQUAL(1 + 2 + (2 * 124), response.data_length);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x06, 1, 0, 125, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE,
+                           response.data[0]);
+}
+
+/** Records of file 1 held in memory, for the mapper */
+static const uint16_t s_mapped_file[4] = {0xA000, 0xA001, 0xA002, 0xA003};
+static uint8_t s_reader_calls;
+
+/** Reader that counts its calls */
+static modbus_exception_t read_counted_file(uint16_t file_number,
+                                            uint16_t record_number,
+                                            uint16_t record_length,
+                                            uint16_t* values)
+{
+    s_reader_calls++;
+    return read_test_file(file_number, record_number, record_length, values);
+}
+
+/** Mapper of file 1 only */
+static const uint16_t* map_test_file(uint16_t file_number,
+                                     uint16_t record_number,
+                                     uint16_t record_length)
+{
+    if ((file_number != 1U) || ((record_number + record_length) > 4U))
+    {
+        return NULL;
+    }
+
+    return &s_mapped_file[record_number];
+}
+
+/**
+ * @brief Test mapped and read sub-requests in one request
+ */
+void test_core_file_record_mapped(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t data[] = {0x0E,
+                            0x06, 0x00, 0x01, 0x00, 0x01, 0x00, 0x02,
+                            0x06, 0x00, 0x02, 0x00, 0x05, 0x00, 0x01};
+    modbus_pdu_view_t request = {MODBUS_FC_READ_FILE_RECORD, data,
+                                 sizeof(data)};
+
+    s_reader_calls = 0U;
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_file_reader(ctx, read_counted_file));
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_file_mapper(ctx, map_test_file));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x14, response.function_code);
+    TEST_ASSERT_EQUAL(11, response.data_length);
+    TEST_ASSERT_EQUAL_HEX8(0xA0, response.data[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, response.data[4]);
+    TEST_ASSERT_EQUAL_HEX8(0xA0, response.data[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, response.data[6]);
+    TEST_ASSERT_EQUAL_HEX8(0x20, response.data[9]);
+    TEST_ASSERT_EQUAL_HEX8(0x05, response.data[10]);
+
+    /* Only the unmapped sub-request went to the reader */
+    TEST_ASSERT_EQUAL(1, s_reader_calls);
+
+    /* Past the mapped records the reader answers */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      read_file_record(ctx, 0x06, 1, 3, 2, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x14, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(0x10, response.data[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, response.data[4]);
+    TEST_ASSERT_EQUAL(2, s_reader_calls);
+}
+
+/* ==========================================================================
+ * Test Cases - Write File Record (FC21)
+ * ========================================================================== */
+
+static uint16_t s_written_file;
+static uint16_t s_written_record;
+static uint16_t s_written_values[8];
+static uint8_t s_writer_calls;
+
+/** Writer of files 1 and 2 that keeps the last sub-request */
+static modbus_exception_t write_test_file(uint16_t file_number,
+                                          uint16_t record_number,
+                                          uint16_t record_length,
+                                          const uint16_t* values)
+{
+    if (file_number > 2U)
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+
+    s_writer_calls++;
+    s_written_file = file_number;
+    s_written_record = record_number;
+    memcpy(s_written_values, values,
+           (record_length < 8U ? record_length : 8U) * sizeof(values[0]));
+    return MODBUS_EXCEPTION_NONE;
+}
+
+/**
+ * @brief Test a request with two sub-requests, answered with an echo
+ */
+void test_core_file_record_write(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    const uint8_t data[] = {0x14,
+                            0x06, 0x00, 0x01, 0x00, 0x02, 0x00, 0x02,
+                            0x12, 0x34, 0x56, 0x78,
+                            0x06, 0x00, 0x02, 0x00, 0x07, 0x00, 0x01,
+                            0x9A, 0xBC};
+    modbus_pdu_view_t request = {MODBUS_FC_WRITE_FILE_RECORD, data,
+                                 sizeof(data)};
+
+    /* No writer set: not supported */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x95, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_FUNCTION,
+                           response.data[0]);
+
+    s_writer_calls = 0U;
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_file_writer(ctx, write_test_file));
+    TEST_ASSERT_EQUAL(MODBUS_MAX_PDU_SIZE,
+                      modbus_slave_get_response_bound(ctx, 0x15));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x15, response.function_code);
+    TEST_ASSERT_EQUAL(sizeof(data), response.data_length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, response.data, sizeof(data));
+
+    TEST_ASSERT_EQUAL(2, s_writer_calls);
+    TEST_ASSERT_EQUAL(2, s_written_file);
+    TEST_ASSERT_EQUAL(7, s_written_record);
+    TEST_ASSERT_EQUAL_HEX16(0x9ABC, s_written_values[0]);
+}
+
+/**
+ * @brief Test write request validation and writer exceptions
+ */
+void test_core_file_record_write_invalid(void)
+{
+    modbus_context_t* ctx = init_slave_context();
+    modbus_pdu_t response;
+    /* Byte count one short of the sub-request */
+    const uint8_t short_count[] = {0x08, 0x06, 0x00, 0x01, 0x00, 0x00,
+                                   0x00, 0x01, 0x12, 0x34};
+    /* Record length 0 */
+    const uint8_t no_records[] = {0x09, 0x06, 0x00, 0x01, 0x00, 0x00,
+                                  0x00, 0x00, 0x12, 0x34};
+    /* Wrong reference type */
+    const uint8_t bad_type[] = {0x09, 0x05, 0x00, 0x01, 0x00, 0x00,
+                                0x00, 0x01, 0x12, 0x34};
+    /* Last record past 0x270F */
+    const uint8_t past_end[] = {0x0B, 0x06, 0x00, 0x01, 0x27, 0x0F,
+                                0x00, 0x02, 0x12, 0x34, 0x56, 0x78};
+    /* File the writer rejects */
+    const uint8_t bad_file[] = {0x09, 0x06, 0x00, 0x03, 0x00, 0x00,
+                                0x00, 0x01, 0x12, 0x34};
+    modbus_pdu_view_t request = {MODBUS_FC_WRITE_FILE_RECORD, short_count,
+                                 sizeof(short_count)};
+
+    s_writer_calls = 0U;
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_set_file_writer(ctx, write_test_file));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x95, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE,
+                           response.data[0]);
+
+    request.data = no_records;
+    request.data_length = sizeof(no_records);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE,
+                           response.data[0]);
+
+    request.data = bad_type;
+    request.data_length = sizeof(bad_type);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+
+    request.data = past_end;
+    request.data_length = sizeof(past_end);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+
+    request.data = bad_file;
+    request.data_length = sizeof(bad_file);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x95, response.function_code);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                           response.data[0]);
+
+    TEST_ASSERT_EQUAL(0, s_writer_calls);
+}
+
+/* ==========================================================================
+ * Test Cases - Latency Statistics
+ * ========================================================================== */
+
+#if MODBUS_ENABLE_LATENCY_STATS
+static uint32_t s_cycle_count;
+static uint32_t s_cycle_step;
+
+/**
+ * @brief Test implementation of the cycle counter port hook
+ *
+ * Advances by s_cycle_step on every read, so each timed stage lasts
+ * exactly one step.
+ */
+uint32_t modbus_port_cycle_count(void)
+{
+    s_cycle_count += s_cycle_step;
+    return s_cycle_count;
+}
+#endif
+
+/**
+ * @brief Test that a request is timed by stage into its function code
+ */
+void test_core_latency_stages(void)
+{
+#if MODBUS_ENABLE_LATENCY_STATS
+    modbus_context_t* ctx = init_slave_context();
+    modbus_latency_stats_t stats;
+    modbus_pdu_t response;
+    const uint8_t data[] = {0x00, 0x00, 0x00, 0x02};
+    modbus_pdu_view_t request = {MODBUS_FC_READ_HOLDING_REGISTERS, data,
+                                 sizeof(data)};
+    const modbus_latency_histogram_t* fc03 = &stats.fc[MODBUS_LATENCY_FC03];
+
+    memset(&stats, 0xA5, sizeof(stats));
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_set_latency_stats(ctx, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, fc03->count);
+
+    /* 4 stages of 1000 cycles: bucket 3 holds 2^11 up to 2^12 cycles */
+    s_cycle_count = 0xFFFFF000U;  /* Wraps during the request */
+    s_cycle_step = 1000U;
+    modbus_slave_mark_frame_start(ctx);
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_HEX8(0x03, response.function_code);
+
+    TEST_ASSERT_EQUAL_UINT32(1, fc03->count);
+    TEST_ASSERT_EQUAL_UINT16(1, fc03->buckets[3]);
+    for (uint32_t i = 0; i < MODBUS_LATENCY_STAGE_COUNT; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(1000U, (uint32_t)fc03->stage_cycles[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, stats.fc[MODBUS_LATENCY_FC04].count);
+#else
+    TEST_IGNORE_MESSAGE("MODBUS_ENABLE_LATENCY_STATS is off");
+#endif
+}
+
+/**
+ * @brief Test that rejected requests count as dispatch and reset clears
+ */
+void test_core_latency_rejected_and_reset(void)
+{
+#if MODBUS_ENABLE_LATENCY_STATS
+    modbus_context_t* ctx = init_slave_context();
+    modbus_latency_stats_t stats;
+    modbus_pdu_t response;
+    modbus_pdu_view_t request = {0x41, NULL, 0};
+    const modbus_latency_histogram_t* other = &stats.fc[MODBUS_LATENCY_OTHER];
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_set_latency_stats(ctx, &stats));
+
+    /* Not marked: no parse time, everything is dispatch */
+    s_cycle_count = 0U;
+    s_cycle_step = 0x10000000U;
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_UINT32(1, other->count);
+    TEST_ASSERT_EQUAL_UINT16(1, other->buckets[MODBUS_LATENCY_BUCKETS - 1U]);
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)other->stage_cycles[0]);
+    TEST_ASSERT_EQUAL_UINT32(0x10000000U, (uint32_t)other->stage_cycles[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)other->stage_cycles[2]);
+
+    modbus_reset_statistics(ctx);
+    TEST_ASSERT_EQUAL_UINT32(0, other->count);
+    TEST_ASSERT_EQUAL_UINT16(0, other->buckets[MODBUS_LATENCY_BUCKETS - 1U]);
+
+    /* Detached: nothing is recorded */
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_slave_set_latency_stats(ctx, NULL));
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_slave_process_pdu_view(ctx, &request, &response));
+    TEST_ASSERT_EQUAL_UINT32(0, other->count);
+#else
+    TEST_IGNORE_MESSAGE("MODBUS_ENABLE_LATENCY_STATS is off");
+#endif
+}
@@ -17,8 +17,86 @@
  * ========================================================================== */
 
 extern uint16_t modbus_crc16(const uint8_t* data, uint16_t length);
+extern uint16_t modbus_crc16_table(const uint8_t* data, uint16_t length);
+extern uint16_t modbus_crc16_update(uint16_t crc, const uint8_t* data,
+                                    uint16_t length);
+extern uint16_t modbus_crc16_bitwise(const uint8_t* data, uint16_t length);
 extern bool modbus_crc16_verify(const uint8_t* data, uint16_t length);
 
+/* ==========================================================================
+ * Hardware Backend Emulation
+ * ========================================================================== */
+
+#if MODBUS_CRC_BACKEND == MODBUS_CRC_BACKEND_HW
+/* Busy flag and call count of the emulated CRC unit */
+static bool s_crc_hw_busy = false;
+static uint32_t s_crc_hw_calls = 0;
+
+static uint8_t reverse8(uint8_t value)
+{
+    uint8_t result = 0;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        result = (uint8_t)((result << 1) | ((value >> i) & 1U));
+    }
+    return result;
+}
+
+static uint16_t reverse16(uint16_t value)
+{
+    return (uint16_t)(((uint16_t)reverse8((uint8_t)value) << 8) |
+                      reverse8((uint8_t)(value >> 8)));
+}
+
+/**
+ * @brief Port hook emulating the STM32 CRC unit
+ *
+ * Computes the CRC the way the peripheral is programmed by the BSP: MSB
+ * first with polynomial 0x8005 from 0xFFFF, input bytes bit-reversed and
+ * the result bit-reversed, so it shares no code with the table backend.
+ */
+bool modbus_crc16_hw(const uint8_t* data, uint16_t length, uint16_t* crc)
+{
+    uint16_t value = 0xFFFF;
+
+    if (s_crc_hw_busy)
+    {
+        return false;
+    }
+    s_crc_hw_calls++;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        value ^= (uint16_t)((uint16_t)reverse8(data[i]) << 8);
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            if ((value & 0x8000U) != 0U)
+            {
+                value = (uint16_t)((value << 1) ^ 0x8005U);
+            }
+            else
+            {
+                value = (uint16_t)(value << 1);
+            }
+        }
+    }
+
+    *crc = reverse16(value);
+    return true;
+}
+#endif
+
+/* Fill a buffer with a repeatable pseudo-random pattern */
+static void fill_pattern(uint8_t* data, uint16_t length, uint32_t seed)
+{
+    uint32_t state = seed;
+    for (uint16_t i = 0; i < length; i++)
+    {
+        state = (state * 1103515245U) + 12345U;
+        data[i] = (uint8_t)(state >> 16);
+    }
+}
+
 /* ==========================================================================
  * Test Cases
  * ========================================================================== */
@@ -288,3 +366,87 @@ void test_crc16_verify_frame_too_short(void)
     /* Should fail because frame is too short for CRC verification */
     TEST_ASSERT_FALSE(result);
 }
+
+/**
+ * @brief Test every CRC-16 backend against the bitwise reference
+ *
+ * Covers lengths on both sides of MODBUS_CRC_HW_MIN_LENGTH and every
+ * remainder of the hardware word loop, up to a full RTU ADU.
+ */
+void test_crc16_backends_match_bitwise(void)
+{
+    uint8_t data[MODBUS_RTU_MAX_ADU_SIZE];
+
+    for (uint16_t length = 0; length <= sizeof(data); length++)
+    {
+        fill_pattern(data, length, length);
+        uint16_t expected = modbus_crc16_bitwise(data, length);
+
+        TEST_ASSERT_EQUAL_HEX16(expected, modbus_crc16_table(data, length));
+        TEST_ASSERT_EQUAL_HEX16(expected, modbus_crc16(data, length));
+#if MODBUS_CRC_BACKEND == MODBUS_CRC_BACKEND_HW
+        uint16_t hw = 0;
+        TEST_ASSERT_TRUE(modbus_crc16_hw(data, length, &hw));
+        TEST_ASSERT_EQUAL_HEX16(expected, hw);
+#endif
+    }
+}
+
+/**
+ * @brief Test the CRC-16 backend dispatch
+ *
+ * Long buffers go to the hardware unit, short ones stay on the table, and
+ * a busy unit falls back to the table with the same result.
+ */
+void test_crc16_backend_dispatch(void)
+{
+#if MODBUS_CRC_BACKEND == MODBUS_CRC_BACKEND_HW
+    uint8_t data[MODBUS_CRC_HW_MIN_LENGTH];
+    fill_pattern(data, sizeof(data), 0x4D42U);
+    uint16_t expected = modbus_crc16_bitwise(data, sizeof(data));
+
+    s_crc_hw_calls = 0;
+    TEST_ASSERT_EQUAL_HEX16(expected, modbus_crc16(data, sizeof(data)));
+    TEST_ASSERT_EQUAL_UINT32(1, s_crc_hw_calls);
+
+    (void)modbus_crc16(data, (uint16_t)(sizeof(data) - 1U));
+    TEST_ASSERT_EQUAL_UINT32(1, s_crc_hw_calls);
+
+    s_crc_hw_busy = true;
+    TEST_ASSERT_EQUAL_HEX16(expected, modbus_crc16(data, sizeof(data)));
+    s_crc_hw_busy = false;
+    TEST_ASSERT_EQUAL_UINT32(1, s_crc_hw_calls);
+#else
+    TEST_IGNORE_MESSAGE("Hardware CRC backend not selected");
+#endif
+}
+
+/**
+ * @brief Test the incremental CRC-16 API
+ *
+ * A frame fed in two pieces from the initial value 0xFFFF, split at every
+ * offset, gives the one-shot CRC, and running on over the appended CRC
+ * bytes leaves zero.
+ */
+void test_crc16_update_incremental(void)
+{
+    uint8_t frame[MODBUS_RTU_MAX_ADU_SIZE];
+    uint16_t data_length = (uint16_t)(sizeof(frame) - 2U);
+
+    fill_pattern(frame, data_length, 0x5254U);
+    uint16_t expected = modbus_crc16_bitwise(frame, data_length);
+
+    for (uint16_t split = 0; split <= data_length; split++)
+    {
+        uint16_t crc = modbus_crc16_update(0xFFFF, frame, split);
+        crc = modbus_crc16_update(crc, &frame[split],
+                                  (uint16_t)(data_length - split));
+        TEST_ASSERT_EQUAL_HEX16(expected, crc);
+    }
+
+    frame[data_length] = (uint8_t)(expected & 0xFF);
+    frame[data_length + 1U] = (uint8_t)(expected >> 8);
+    TEST_ASSERT_EQUAL_HEX16(
+        0x0000, modbus_crc16_update(0xFFFF, frame, sizeof(frame)));
+}
+
@@ -24,6 +24,10 @@ extern uint16_t modbus_binary_to_ascii(const uint8_t* binary, uint16_t binary_le
                                         char* ascii, uint16_t ascii_size);
 extern uint16_t modbus_ascii_to_binary(const char* ascii, uint16_t ascii_len,
                                         uint8_t* binary, uint16_t binary_size);
+extern uint16_t modbus_binary_to_ascii_lrc(const uint8_t* binary, uint16_t binary_len,
+                                            char* ascii, uint16_t ascii_size, uint8_t* lrc);
+extern uint16_t modbus_ascii_to_binary_lrc(const char* ascii, uint16_t ascii_len,
+                                            uint8_t* binary, uint16_t binary_size, uint8_t* lrc);
 
 /* ==========================================================================
  * Test Cases - LRC Calculation
@@ -382,3 +386,102 @@ void test_lrc_verify_minimum_length(void)
 
     TEST_ASSERT_TRUE(result);
 }
+
+/* ==========================================================================
+ * Test Cases - Table-Driven Conversion
+ * ========================================================================== */
+
+/* Reference hex digit decoder, -1 for anything else */
+static int reference_nibble(int c)
+{
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * @brief Test hex decoding of every character pair
+ *
+ * The lookup tables must accept exactly the hex digits of both cases.
+ */
+void test_ascii_to_byte_all_pairs(void)
+{
+    for (int high = 0; high < 256; high++)
+    {
+        for (int low = 0; low < 256; low++)
+        {
+            uint8_t byte = 0;
+            int h = reference_nibble(high);
+            int l = reference_nibble(low);
+            modbus_error_t err = modbus_ascii_to_byte((char)high, (char)low, &byte);
+
+            if ((h < 0) || (l < 0))
+            {
+                TEST_ASSERT_EQUAL(MODBUS_ERROR_FRAME, err);
+            }
+            else
+            {
+                TEST_ASSERT_EQUAL(MODBUS_OK, err);
+                TEST_ASSERT_EQUAL_HEX8((h << 4) | l, byte);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Test single-pass encode with LRC
+ *
+ * Output and LRC must match the separate conversion and LRC passes.
+ */
+void test_binary_to_ascii_lrc(void)
+{
+    uint8_t binary[256];
+    char expected[512];
+    char ascii[512];
+    uint8_t lrc = 0;
+
+    for (uint16_t i = 0; i < sizeof(binary); i++)
+    {
+        binary[i] = (uint8_t)((i * 37U) + 11U);
+    }
+
+    TEST_ASSERT_EQUAL(512, modbus_binary_to_ascii(binary, sizeof(binary),
+                                                  expected, sizeof(expected)));
+    TEST_ASSERT_EQUAL(512, modbus_binary_to_ascii_lrc(binary, sizeof(binary),
+                                                      ascii, sizeof(ascii), &lrc));
+    TEST_ASSERT_EQUAL_MEMORY(expected, ascii, sizeof(ascii));
+    TEST_ASSERT_EQUAL_HEX8(modbus_lrc(binary, sizeof(binary)), lrc);
+}
+
+/**
+ * @brief Test single-pass decode with LRC
+ *
+ * Decoding data followed by its LRC leaves 0, and one bad character
+ * anywhere rejects the whole string.
+ */
+void test_ascii_to_binary_lrc(void)
+{
+    uint8_t data[] = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x00};
+    char ascii[2 * sizeof(data)];
+    uint8_t binary[sizeof(data)];
+    uint8_t lrc = 0xAA;
+
+    data[sizeof(data) - 1U] = modbus_lrc(data, (uint16_t)(sizeof(data) - 1U));
+    (void)modbus_binary_to_ascii(data, sizeof(data), ascii, sizeof(ascii));
+
+    TEST_ASSERT_EQUAL(sizeof(data), modbus_ascii_to_binary_lrc(ascii, sizeof(ascii),
+                                                               binary, sizeof(binary), &lrc));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, binary, sizeof(data));
+    TEST_ASSERT_EQUAL_HEX8(0x00, lrc);
+
+    for (uint16_t i = 0; i < sizeof(ascii); i++)
+    {
+        char saved = ascii[i];
+        ascii[i] = 'G';
+        TEST_ASSERT_EQUAL(0, modbus_ascii_to_binary_lrc(ascii, sizeof(ascii),
+                                                        binary, sizeof(binary), &lrc));
+        ascii[i] = saved;
+    }
+}
+
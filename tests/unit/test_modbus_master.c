@@ -0,0 +1,419 @@
+/**
+ * @file test_modbus_master.c
+ * @brief Unity unit tests for the Modbus master polling engine
+ *
+ * Tests the merging of the poll table into read requests, the deadline
+ * scheduling of poll groups and the matching of RTU and pipelined TCP
+ * responses, against a simulated slave.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include "unity.h"
+#include "modbus_master.h"
+#include "modbus_types.h"
+#include <string.h>
+
+/* ==========================================================================
+ * External Function Declarations
+ * ========================================================================== */
+
+extern uint16_t modbus_crc16(const uint8_t* data, uint16_t length);
+
+/* ==========================================================================
+ * Simulated Slave
+ * ========================================================================== */
+
+/** Register value the simulated slave returns for an address */
+#define SLAVE_REGISTER(unit, address) \
+    ((uint16_t)(((uint16_t)(unit) << 12) + (uint16_t)(address)))
+
+/** Coil state the simulated slave returns for an address */
+#define SLAVE_COIL(address) (((address) % 3U) == 0U)
+
+static uint16_t read_be16(const uint8_t* p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+/**
+ * @brief Answer one request frame built by the poller
+ *
+ * @param tcp       Frames are MBAP (true) or RTU (false)
+ * @param exception Exception code to answer with, 0 for a normal response
+ */
+static uint16_t slave_respond(bool tcp, const uint8_t* request,
+                              uint8_t* response, uint8_t exception)
+{
+    uint16_t header = tcp ? 7U : 1U;
+    uint8_t unit = request[header - 1U];
+    uint8_t fc = request[header];
+    uint16_t address = read_be16(&request[header + 1U]);
+    uint16_t quantity = read_be16(&request[header + 3U]);
+    uint16_t pdu_length;
+    uint16_t length;
+
+    (void)memcpy(response, request, header);
+    response[header] = fc;
+
+    if (exception != 0U)
+    {
+        response[header] = (uint8_t)(fc | 0x80U);
+        response[header + 1U] = exception;
+        pdu_length = 2U;
+    }
+    else if ((fc == MODBUS_FC_READ_COILS) ||
+             (fc == MODBUS_FC_READ_DISCRETE_INPUTS))
+    {
+        uint8_t byte_count = (uint8_t)((quantity + 7U) / 8U);
+
+        response[header + 1U] = byte_count;
+        (void)memset(&response[header + 2U], 0, byte_count);
+        for (uint16_t i = 0U; i < quantity; i++)
+        {
+            if (SLAVE_COIL((uint16_t)(address + i)))
+            {
+                response[header + 2U + (i / 8U)] |= (uint8_t)(1U << (i % 8U));
+            }
+        }
+        pdu_length = (uint16_t)(2U + byte_count);
+    }
+    else
+    {
+        response[header + 1U] = (uint8_t)(quantity * 2U);
+        for (uint16_t i = 0U; i < quantity; i++)
+        {
+            uint16_t value = SLAVE_REGISTER(unit, address + i);
+
+            response[header + 2U + (i * 2U)] = (uint8_t)(value >> 8);
+            response[header + 3U + (i * 2U)] = (uint8_t)value;
+        }
+        pdu_length = (uint16_t)(2U + (quantity * 2U));
+    }
+
+    length = (uint16_t)(header + pdu_length);
+    if (tcp)
+    {
+        response[4] = (uint8_t)((pdu_length + 1U) >> 8);
+        response[5] = (uint8_t)(pdu_length + 1U);
+    }
+    else
+    {
+        uint16_t crc = modbus_crc16(response, length);
+
+        response[length] = (uint8_t)crc;
+        response[length + 1U] = (uint8_t)(crc >> 8);
+        length = (uint16_t)(length + 2U);
+    }
+
+    return length;
+}
+
+static modbus_poller_t s_poller;
+
+/* ==========================================================================
+ * Test Cases - Poll Table Merging
+ * ========================================================================== */
+
+/**
+ * @brief Test that touching register blocks of one group share a request
+ */
+void test_master_merge_adjacent(void)
+{
+    static uint16_t a[10], b[10], c[10], d[10], e[4], f[4];
+    const modbus_poll_item_t items[] = {
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 0, 10, 100, a },
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 10, 10, 100, b },
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 30, 10, 100, c },
+        /* Closes the gap between the first two and the third */
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 20, 10, 100, d },
+        /* Other function code and other period: own requests */
+        { 1, MODBUS_FC_READ_INPUT_REGISTERS, 40, 4, 100, e },
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 40, 4, 1000, f },
+    };
+    modbus_error_t err;
+
+    err = modbus_poll_init(&s_poller, items, 6, MODBUS_PROTOCOL_RTU, 100, 0);
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, err);
+    TEST_ASSERT_EQUAL(3, s_poller.batch_count);
+    TEST_ASSERT_EQUAL(0, s_poller.batches[s_poller.item_batch[0]].start_address);
+    TEST_ASSERT_EQUAL(40, s_poller.batches[s_poller.item_batch[0]].quantity);
+    for (uint8_t i = 1U; i < 4U; i++)
+    {
+        TEST_ASSERT_EQUAL(s_poller.item_batch[0], s_poller.item_batch[i]);
+    }
+    TEST_ASSERT_NOT_EQUAL(s_poller.item_batch[4], s_poller.item_batch[5]);
+    TEST_ASSERT_NOT_EQUAL(s_poller.item_batch[0], s_poller.item_batch[5]);
+}
+
+/**
+ * @brief Test that merging stops at MODBUS_MAX_READ_REGISTERS
+ */
+void test_master_merge_respects_limit(void)
+{
+    static uint16_t a[100], b[50];
+    const modbus_poll_item_t items[] = {
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 0, 100, 100, a },
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 100, 50, 100, b },
+    };
+    static uint16_t c[126];
+    const modbus_poll_item_t too_big[] = {
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 0, 126, 100, c },
+    };
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_init(&s_poller, items, 2,
+                                                  MODBUS_PROTOCOL_RTU, 100, 0));
+    TEST_ASSERT_EQUAL(2, s_poller.batch_count);
+
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_INVALID_PARAM,
+                      modbus_poll_init(&s_poller, too_big, 1,
+                                       MODBUS_PROTOCOL_RTU, 100, 0));
+}
+
+/* ==========================================================================
+ * Test Cases - RTU Polling
+ * ========================================================================== */
+
+/**
+ * @brief Test one RTU poll cycle over merged register and coil blocks
+ */
+void test_master_rtu_poll_cycle(void)
+{
+    static uint16_t regs_a[3], regs_b[2];
+    static uint8_t coils[2];
+    const modbus_poll_item_t items[] = {
+        { 5, MODBUS_FC_READ_HOLDING_REGISTERS, 0x0100, 3, 50, regs_a },
+        { 5, MODBUS_FC_READ_HOLDING_REGISTERS, 0x0103, 2, 50, regs_b },
+        { 5, MODBUS_FC_READ_COILS, 7, 10, 50, coils },
+    };
+    uint8_t request[MODBUS_RTU_MAX_ADU_SIZE];
+    uint8_t response[MODBUS_RTU_MAX_ADU_SIZE];
+    uint16_t request_len;
+    uint16_t response_len;
+    modbus_poll_status_t status;
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_init(&s_poller, items, 3,
+                                                  MODBUS_PROTOCOL_RTU, 100, 0));
+
+    /* Registers: a single FC03 request for 0x0100..0x0104 */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_poll_next_request(&s_poller, 0, request,
+                                               sizeof(request), &request_len));
+    TEST_ASSERT_EQUAL(8, request_len);
+    TEST_ASSERT_EQUAL_HEX8(0x05, request[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, request[1]);
+    TEST_ASSERT_EQUAL_HEX16(0x0100, read_be16(&request[2]));
+    TEST_ASSERT_EQUAL(5, read_be16(&request[4]));
+    TEST_ASSERT_EQUAL_HEX16(0x0000, modbus_crc16(request, request_len));
+
+    /* RTU has one transaction outstanding at a time */
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_BUSY,
+                      modbus_poll_next_request(&s_poller, 0, request,
+                                               sizeof(request), &request_len));
+
+    response_len = slave_respond(false, request, response, 0);
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_handle_response(
+                                     &s_poller, response, response_len, 2));
+    TEST_ASSERT_EQUAL_HEX16(SLAVE_REGISTER(5, 0x0100), regs_a[0]);
+    TEST_ASSERT_EQUAL_HEX16(SLAVE_REGISTER(5, 0x0102), regs_a[2]);
+    TEST_ASSERT_EQUAL_HEX16(SLAVE_REGISTER(5, 0x0103), regs_b[0]);
+    TEST_ASSERT_EQUAL_HEX16(SLAVE_REGISTER(5, 0x0104), regs_b[1]);
+
+    /* Coils: 7..16, unpacked to bit 0 of the item */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_poll_next_request(&s_poller, 2, request,
+                                               sizeof(request), &request_len));
+    TEST_ASSERT_EQUAL_HEX8(0x01, request[1]);
+    response_len = slave_respond(false, request, response, 0);
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_handle_response(
+                                     &s_poller, response, response_len, 3));
+    for (uint16_t i = 0U; i < 10U; i++)
+    {
+        TEST_ASSERT_EQUAL(SLAVE_COIL(7U + i),
+                          (coils[i / 8U] >> (i % 8U)) & 1U);
+    }
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_get_status(&s_poller, 1, &status));
+    TEST_ASSERT_EQUAL(1, status.responses);
+    TEST_ASSERT_EQUAL(0, status.failures);
+    TEST_ASSERT_EQUAL(2, status.updated_ms);
+
+    /* Nothing is due again before the period has passed */
+    TEST_ASSERT_EQUAL(47, modbus_poll_time_to_next(&s_poller, 3));
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_BUSY,
+                      modbus_poll_next_request(&s_poller, 49, request,
+                                               sizeof(request), &request_len));
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_poll_next_request(&s_poller, 50, request,
+                                               sizeof(request), &request_len));
+}
+
+/**
+ * @brief Test timeout, exception and corrupt response handling
+ */
+void test_master_rtu_failures(void)
+{
+    static uint16_t regs[2];
+    const modbus_poll_item_t items[] = {
+        { 9, MODBUS_FC_READ_INPUT_REGISTERS, 0, 2, 1000, regs },
+    };
+    uint8_t request[MODBUS_RTU_MAX_ADU_SIZE];
+    uint8_t response[MODBUS_RTU_MAX_ADU_SIZE];
+    uint16_t request_len;
+    uint16_t response_len;
+    modbus_poll_status_t status;
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_init(&s_poller, items, 1,
+                                                  MODBUS_PROTOCOL_RTU, 100, 0));
+
+    /* No response: retired once the timeout has passed */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_poll_next_request(&s_poller, 0, request,
+                                               sizeof(request), &request_len));
+    TEST_ASSERT_EQUAL(100, modbus_poll_time_to_next(&s_poller, 0));
+    (void)modbus_poll_next_request(&s_poller, 100, request, sizeof(request),
+                                   &request_len);
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_get_status(&s_poller, 0, &status));
+    TEST_ASSERT_EQUAL(1, status.failures);
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_TIMEOUT, status.last_error);
+
+    /* The late response no longer matches anything */
+    response_len = slave_respond(false, request, response, 0);
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_INVALID_STATE,
+                      modbus_poll_handle_response(&s_poller, response,
+                                                  response_len, 101));
+
+    /* Exception */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_poll_next_request(&s_poller, 1000, request,
+                                               sizeof(request), &request_len));
+    response_len = slave_respond(false, request, response,
+                                 MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS);
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_EXCEPTION,
+                      modbus_poll_handle_response(&s_poller, response,
+                                                  response_len, 1001));
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_get_status(&s_poller, 0, &status));
+    TEST_ASSERT_EQUAL(2, status.failures);
+    TEST_ASSERT_EQUAL(MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS,
+                      status.last_exception);
+
+    /* Corrupt CRC: dropped, the transaction stays outstanding */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_poll_next_request(&s_poller, 2000, request,
+                                               sizeof(request), &request_len));
+    response_len = slave_respond(false, request, response, 0);
+    response[3] ^= 0x01U;
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_CRC,
+                      modbus_poll_handle_response(&s_poller, response,
+                                                  response_len, 2001));
+    response[3] ^= 0x01U;
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_poll_handle_response(&s_poller, response,
+                                                  response_len, 2002));
+    TEST_ASSERT_EQUAL_HEX16(SLAVE_REGISTER(9, 1), regs[1]);
+}
+
+/**
+ * @brief Test that a fast group is not held up by a slow one
+ */
+void test_master_deadline_scheduling(void)
+{
+    static uint16_t fast[1], slow[1];
+    const modbus_poll_item_t items[] = {
+        { 2, MODBUS_FC_READ_HOLDING_REGISTERS, 0, 1, 1000, slow },
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 0, 1, 10, fast },
+    };
+    uint8_t request[MODBUS_RTU_MAX_ADU_SIZE];
+    uint8_t response[MODBUS_RTU_MAX_ADU_SIZE];
+    uint16_t request_len;
+    uint16_t response_len;
+    uint32_t polls[3] = { 0U, 0U, 0U };
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_init(&s_poller, items, 2,
+                                                  MODBUS_PROTOCOL_RTU, 5, 0));
+
+    /* Both are due at start; the fast group has the earlier deadline */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_poll_next_request(&s_poller, 0, request,
+                                               sizeof(request), &request_len));
+    TEST_ASSERT_EQUAL_HEX8(0x01, request[0]);
+    response_len = slave_respond(false, request, response, 0);
+    (void)modbus_poll_handle_response(&s_poller, response, response_len, 1);
+    polls[1]++;
+
+    /* Each transaction takes 1 ms */
+    for (uint32_t now = 1U; now < 1000U; now++)
+    {
+        if (modbus_poll_next_request(&s_poller, now, request, sizeof(request),
+                                     &request_len) == MODBUS_OK)
+        {
+            polls[request[0]]++;
+            response_len = slave_respond(false, request, response, 0);
+            TEST_ASSERT_EQUAL(MODBUS_OK,
+                              modbus_poll_handle_response(
+                                  &s_poller, response, response_len, now + 1U));
+            now++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(1, polls[2]);
+    TEST_ASSERT_EQUAL(100, polls[1]);
+}
+
+/* ==========================================================================
+ * Test Cases - TCP Pipelining
+ * ========================================================================== */
+
+/**
+ * @brief Test out-of-order TCP responses matched by transaction ID
+ */
+void test_master_tcp_pipeline(void)
+{
+    static uint16_t regs[3][2];
+    const modbus_poll_item_t items[] = {
+        { 1, MODBUS_FC_READ_HOLDING_REGISTERS, 10, 2, 100, regs[0] },
+        { 2, MODBUS_FC_READ_HOLDING_REGISTERS, 20, 2, 100, regs[1] },
+        { 3, MODBUS_FC_READ_HOLDING_REGISTERS, 30, 2, 100, regs[2] },
+    };
+    uint8_t request[3][MODBUS_TCP_MAX_ADU_SIZE];
+    uint8_t response[MODBUS_TCP_MAX_ADU_SIZE];
+    uint16_t request_len;
+    uint16_t response_len;
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_init(&s_poller, items, 3,
+                                                  MODBUS_PROTOCOL_TCP, 100, 0));
+
+    /* All three are outstanding together, with distinct transaction IDs */
+    for (uint8_t i = 0U; i < 3U; i++)
+    {
+        TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_next_request(
+                                         &s_poller, 0, request[i],
+                                         sizeof(request[i]), &request_len));
+        TEST_ASSERT_EQUAL(12, request_len);
+        TEST_ASSERT_EQUAL(i, read_be16(&request[i][0]));
+    }
+
+    /* Answer in reverse order */
+    for (uint8_t i = 3U; i > 0U; i--)
+    {
+        response_len = slave_respond(true, request[i - 1U], response, 0);
+        TEST_ASSERT_EQUAL(MODBUS_OK, modbus_poll_handle_response(
+                                         &s_poller, response, response_len, 1));
+    }
+
+    for (uint8_t i = 0U; i < 3U; i++)
+    {
+        uint16_t address = (uint16_t)(10U * (i + 1U));
+
+        TEST_ASSERT_EQUAL_HEX16(SLAVE_REGISTER(i + 1U, address), regs[i][0]);
+        TEST_ASSERT_EQUAL_HEX16(SLAVE_REGISTER(i + 1U, address + 1U),
+                                regs[i][1]);
+    }
+
+    /* A response with an unknown transaction ID is ignored */
+    response_len = slave_respond(true, request[0], response, 0);
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_INVALID_STATE,
+                      modbus_poll_handle_response(&s_poller, response,
+                                                  response_len, 2));
+}
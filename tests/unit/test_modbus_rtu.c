@@ -22,6 +22,15 @@ extern modbus_error_t modbus_rtu_build_frame(const modbus_adu_t* adu,
 extern modbus_error_t modbus_rtu_parse_frame(const uint8_t* frame,
                                               uint16_t frame_length,
                                               modbus_adu_t* adu);
+extern modbus_error_t modbus_rtu_build_frame_in_place(uint8_t unit_id,
+                                                       uint8_t* frame,
+                                                       uint16_t pdu_length,
+                                                       uint16_t frame_size,
+                                                       uint16_t* frame_length);
+extern modbus_error_t modbus_rtu_parse_frame_view(const uint8_t* frame,
+                                                   uint16_t frame_length,
+                                                   uint8_t* unit_id,
+                                                   modbus_pdu_view_t* pdu);
 extern uint32_t modbus_rtu_get_interframe_delay_us(uint32_t baudrate);
 extern uint32_t modbus_rtu_get_interchar_timeout_us(uint32_t baudrate);
 extern bool modbus_rtu_address_match(uint8_t frame_address, uint8_t slave_address);
@@ -312,3 +321,53 @@ void test_rtu_parse_frame_null_adu(void)
 
     TEST_ASSERT_EQUAL(MODBUS_ERROR_INVALID_PARAM, err);
 }
+
+/* ==========================================================================
+ * Test Cases - In-Place Framing
+ * ========================================================================== */
+
+/**
+ * @brief Test RTU framing around a PDU already in the frame buffer
+ */
+void test_rtu_build_frame_in_place(void)
+{
+    uint8_t frame[10] = {0x00, 0x03, 0x00, 0x00, 0x00, 0x0A};
+    uint16_t frame_length = 0;
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_rtu_build_frame_in_place(
+                                     0x01, frame, 5U, sizeof(frame),
+                                     &frame_length));
+
+    /* Same frame as test_rtu_build_frame_fc03() */
+    TEST_ASSERT_EQUAL(8, frame_length);
+    TEST_ASSERT_EQUAL_HEX8(0x01, frame[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xC5, frame[6]);
+    TEST_ASSERT_EQUAL_HEX8(0xCD, frame[7]);
+
+    /* No room for the CRC */
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_BUFFER_OVERFLOW,
+                      modbus_rtu_build_frame_in_place(0x01, frame, 5U, 7U,
+                                                      &frame_length));
+}
+
+/**
+ * @brief Test RTU frame view parsing references the frame buffer
+ */
+void test_rtu_parse_frame_view(void)
+{
+    uint8_t frame[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0A, 0xC5, 0xCD};
+    modbus_pdu_view_t pdu;
+    uint8_t unit_id = 0;
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_rtu_parse_frame_view(
+                                     frame, sizeof(frame), &unit_id, &pdu));
+    TEST_ASSERT_EQUAL_HEX8(0x01, unit_id);
+    TEST_ASSERT_EQUAL_HEX8(0x03, pdu.function_code);
+    TEST_ASSERT_EQUAL(4, pdu.data_length);
+    TEST_ASSERT_TRUE(pdu.data == &frame[2]);
+
+    frame[7] ^= 0x01U;
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_CRC, modbus_rtu_parse_frame_view(
+                                            frame, sizeof(frame), &unit_id,
+                                            &pdu));
+}
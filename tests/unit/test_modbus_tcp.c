@@ -23,6 +23,31 @@ extern modbus_error_t modbus_tcp_build_frame(const modbus_adu_t* adu,
 extern modbus_error_t modbus_tcp_parse_frame(const uint8_t* frame,
                                               uint16_t frame_length,
                                               modbus_adu_t* adu);
+extern modbus_error_t modbus_tcp_parse_frame_view(const uint8_t* frame,
+                                                  uint16_t frame_length,
+                                                  uint16_t* transaction_id,
+                                                  uint8_t* unit_id,
+                                                  modbus_pdu_view_t* pdu);
+extern modbus_error_t modbus_tcp_build_frame_in_place(uint16_t transaction_id,
+                                                       uint8_t unit_id,
+                                                       uint8_t* frame,
+                                                       uint16_t pdu_length,
+                                                       uint16_t frame_size,
+                                                       uint16_t* frame_length);
+extern uint16_t modbus_tcp_get_frame_length(const uint8_t* data,
+                                            uint16_t length);
+extern modbus_error_t modbus_tcp_rx_init(modbus_tcp_rx_context_t* ctx,
+                                         uint32_t timeout_ms);
+extern void modbus_tcp_rx_reset(modbus_tcp_rx_context_t* ctx);
+extern modbus_error_t modbus_tcp_rx_process_data(modbus_tcp_rx_context_t* ctx,
+                                                 const uint8_t* data,
+                                                 uint16_t length,
+                                                 uint32_t current_time_ms,
+                                                 uint16_t* consumed);
+extern bool modbus_tcp_rx_is_complete(const modbus_tcp_rx_context_t* ctx);
+extern modbus_error_t modbus_tcp_rx_get_frame(const modbus_tcp_rx_context_t* ctx,
+                                              const uint8_t** frame,
+                                              uint16_t* length);
 
 /* ==========================================================================
  * Test Cases - Frame Building
@@ -381,3 +406,169 @@ void test_tcp_parse_exception_frame(void)
     TEST_ASSERT_EQUAL(1, adu.pdu.data_length);
     TEST_ASSERT_EQUAL_HEX8(0x02, adu.pdu.data[0]);
 }
+
+/* ==========================================================================
+ * Test Cases - Stream Reassembly
+ * ========================================================================== */
+
+/**
+ * @brief Test receiver splits two coalesced frames from one segment
+ */
+void test_tcp_rx_coalesced_frames(void)
+{
+    modbus_tcp_rx_context_t rx;
+    const uint8_t* frame;
+    uint16_t frame_length;
+    uint16_t consumed;
+    modbus_error_t err;
+
+    /* Two FC03 requests back to back, as sent by a pipelining master */
+    uint8_t stream[] = {
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A,
+        0x00, 0x02, 0x00, 0x00, 0x00, 0x06, 0x01, 0x03, 0x00, 0x10, 0x00, 0x02
+    };
+
+    (void)modbus_tcp_rx_init(&rx, 1000U);
+
+    err = modbus_tcp_rx_process_data(&rx, stream, sizeof(stream), 0U, &consumed);
+    TEST_ASSERT_EQUAL(MODBUS_OK, err);
+    TEST_ASSERT_EQUAL(12, consumed);
+    TEST_ASSERT_TRUE(modbus_tcp_rx_is_complete(&rx));
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_tcp_rx_get_frame(&rx, &frame, &frame_length));
+    TEST_ASSERT_EQUAL(12, frame_length);
+    TEST_ASSERT_EQUAL_HEX8(0x01, frame[1]);
+
+    modbus_tcp_rx_reset(&rx);
+    err = modbus_tcp_rx_process_data(&rx, &stream[consumed],
+                                     (uint16_t)(sizeof(stream) - consumed), 0U,
+                                     &consumed);
+    TEST_ASSERT_EQUAL(MODBUS_OK, err);
+    TEST_ASSERT_EQUAL(12, consumed);
+    TEST_ASSERT_TRUE(modbus_tcp_rx_is_complete(&rx));
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_tcp_rx_get_frame(&rx, &frame, &frame_length));
+    TEST_ASSERT_EQUAL_HEX8(0x02, frame[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x10, frame[9]);
+}
+
+/**
+ * @brief Test receiver reassembles a frame split across segments
+ */
+void test_tcp_rx_split_frame(void)
+{
+    modbus_tcp_rx_context_t rx;
+    const uint8_t* frame;
+    uint16_t frame_length;
+    uint16_t consumed;
+
+    uint8_t stream[] = {
+        0x00, 0x07, 0x00, 0x00, 0x00, 0x06, 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A
+    };
+
+    (void)modbus_tcp_rx_init(&rx, 1000U);
+
+    /* Split inside the MBAP header */
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_tcp_rx_process_data(&rx, stream, 5U, 0U, &consumed));
+    TEST_ASSERT_EQUAL(5, consumed);
+    TEST_ASSERT_FALSE(modbus_tcp_rx_is_complete(&rx));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_tcp_rx_process_data(&rx, &stream[5], 4U, 1U, &consumed));
+    TEST_ASSERT_FALSE(modbus_tcp_rx_is_complete(&rx));
+
+    TEST_ASSERT_EQUAL(MODBUS_OK,
+                      modbus_tcp_rx_process_data(&rx, &stream[9], 3U, 2U, &consumed));
+    TEST_ASSERT_EQUAL(3, consumed);
+    TEST_ASSERT_TRUE(modbus_tcp_rx_is_complete(&rx));
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_tcp_rx_get_frame(&rx, &frame, &frame_length));
+    TEST_ASSERT_EQUAL(sizeof(stream), frame_length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(stream, frame, sizeof(stream));
+}
+
+/* ==========================================================================
+ * Test Cases - In-Place Parsing
+ * ========================================================================== */
+
+/**
+ * @brief Test TCP frame view parsing references the frame buffer
+ */
+void test_tcp_parse_frame_view(void)
+{
+    modbus_pdu_view_t pdu;
+    uint16_t transaction_id;
+    uint8_t unit_id;
+    modbus_error_t err;
+
+    uint8_t frame[] = {
+        0x12, 0x34,  /* Transaction ID */
+        0x00, 0x00,  /* Protocol ID */
+        0x00, 0x06,  /* Length */
+        0x05,        /* Unit ID */
+        0x03,        /* FC03 */
+        0x00, 0x10,  /* Start address */
+        0x00, 0x02   /* Quantity */
+    };
+
+    err = modbus_tcp_parse_frame_view(frame, sizeof(frame), &transaction_id,
+                                      &unit_id, &pdu);
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, err);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, transaction_id);
+    TEST_ASSERT_EQUAL_HEX8(0x05, unit_id);
+    TEST_ASSERT_EQUAL_HEX8(0x03, pdu.function_code);
+    TEST_ASSERT_EQUAL(4, pdu.data_length);
+    TEST_ASSERT_TRUE(pdu.data == &frame[8]);
+
+    /* Length field mismatch is rejected like modbus_tcp_parse_frame() */
+    err = modbus_tcp_parse_frame_view(frame, sizeof(frame) - 1U,
+                                      &transaction_id, &unit_id, &pdu);
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_FRAME, err);
+}
+
+/**
+ * @brief Test complete-frame detection used by the in-place fast path
+ */
+void test_tcp_get_frame_length(void)
+{
+    uint8_t frame[] = {
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A,
+        0x00, 0x02  /* Start of a following frame */
+    };
+
+    TEST_ASSERT_EQUAL(12, modbus_tcp_get_frame_length(frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(12, modbus_tcp_get_frame_length(frame, 12U));
+    TEST_ASSERT_EQUAL(0, modbus_tcp_get_frame_length(frame, 11U));
+    TEST_ASSERT_EQUAL(0, modbus_tcp_get_frame_length(frame, 4U));
+}
+
+/**
+ * @brief Test MBAP header written in front of a PDU already in the buffer
+ */
+void test_tcp_build_frame_in_place(void)
+{
+    uint8_t frame[16] = {0};
+    uint16_t frame_length = 0;
+
+    frame[7] = 0x03;  /* FC03 response, 1 register */
+    frame[8] = 0x02;
+    frame[9] = 0x12;
+    frame[10] = 0x34;
+
+    TEST_ASSERT_EQUAL(MODBUS_OK, modbus_tcp_build_frame_in_place(
+                                     0xBEEF, 0x05, frame, 4U, sizeof(frame),
+                                     &frame_length));
+    TEST_ASSERT_EQUAL(11, frame_length);
+    TEST_ASSERT_EQUAL_HEX8(0xBE, frame[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xEF, frame[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[4]);
+    TEST_ASSERT_EQUAL_HEX8(0x05, frame[5]);  /* Unit ID + 4 PDU bytes */
+    TEST_ASSERT_EQUAL_HEX8(0x05, frame[6]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, frame[7]);  /* PDU untouched */
+    TEST_ASSERT_EQUAL_HEX8(0x34, frame[10]);
+
+    TEST_ASSERT_EQUAL(MODBUS_ERROR_BUFFER_OVERFLOW,
+                      modbus_tcp_build_frame_in_place(0xBEEF, 0x05, frame, 4U,
+                                                      10U, &frame_length));
+}
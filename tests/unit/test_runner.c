@@ -22,6 +22,9 @@ extern void test_crc16_verify_valid(void);
 extern void test_crc16_verify_invalid(void);
 extern void test_crc16_null_pointer(void);
 extern void test_crc16_large_buffer(void);
+extern void test_crc16_backends_match_bitwise(void);
+extern void test_crc16_backend_dispatch(void);
+extern void test_crc16_update_incremental(void);
 
 /* LRC Tests */
 extern void test_lrc_empty_data(void);
@@ -34,6 +37,9 @@ extern void test_ascii_to_byte_valid(void);
 extern void test_ascii_to_byte_invalid(void);
 extern void test_binary_to_ascii(void);
 extern void test_ascii_to_binary(void);
+extern void test_ascii_to_byte_all_pairs(void);
+extern void test_binary_to_ascii_lrc(void);
+extern void test_ascii_to_binary_lrc(void);
 
 /* PDU Tests */
 extern void test_pdu_read_coils_request(void);
@@ -62,6 +68,8 @@ extern void test_rtu_interchar_timeout_9600(void);
 extern void test_rtu_address_match_direct(void);
 extern void test_rtu_address_match_broadcast(void);
 extern void test_rtu_address_mismatch(void);
+extern void test_rtu_build_frame_in_place(void);
+extern void test_rtu_parse_frame_view(void);
 
 /* ASCII Tests */
 extern void test_ascii_build_frame_fc03(void);
@@ -78,6 +86,86 @@ extern void test_tcp_parse_frame_wrong_protocol(void);
 extern void test_tcp_parse_frame_length_mismatch(void);
 extern void test_tcp_parse_frame_too_short(void);
 extern void test_tcp_transaction_id(void);
+extern void test_tcp_rx_coalesced_frames(void);
+extern void test_tcp_rx_split_frame(void);
+extern void test_tcp_parse_frame_view(void);
+extern void test_tcp_get_frame_length(void);
+extern void test_tcp_build_frame_in_place(void);
+
+/* Core Tests */
+extern void test_core_dispatch_unknown_function(void);
+extern void test_core_dispatch_bad_length(void);
+extern void test_core_dispatch_custom_handler(void);
+extern void test_core_process_pdu_buffer_in_frame(void);
+extern void test_core_process_pdu_buffer_overflow(void);
+extern void test_core_read_write_registers(void);
+extern void test_core_read_write_registers_bad_count(void);
+extern void test_core_callback_table(void);
+extern void test_core_callback_table_incomplete(void);
+extern void test_core_scattered_registers(void);
+extern void test_core_scattered_registers_limits(void);
+extern void test_core_scattered_registers_invalid(void);
+extern void test_core_device_id_stream(void);
+extern void test_core_device_id_specific(void);
+extern void test_core_device_id_more_follows(void);
+extern void test_core_file_record_read(void);
+extern void test_core_file_record_invalid(void);
+extern void test_core_file_record_mapped(void);
+extern void test_core_file_record_write(void);
+extern void test_core_file_record_write_invalid(void);
+extern void test_core_latency_stages(void);
+extern void test_core_latency_rejected_and_reset(void);
+
+/* Master Tests */
+extern void test_master_merge_adjacent(void);
+extern void test_master_merge_respects_limit(void);
+extern void test_master_rtu_poll_cycle(void);
+extern void test_master_rtu_failures(void);
+extern void test_master_deadline_scheduling(void);
+extern void test_master_tcp_pipeline(void);
+
+/* Block Pool Tests */
+extern void test_block_pool_alloc_in_order(void);
+extern void test_block_pool_free_alloc_lifo(void);
+extern void test_block_pool_head_tag(void);
+extern void test_block_pool_free_foreign(void);
+extern void test_block_pool_init_existing(void);
+extern void test_block_pool_stats(void);
+
+/* Formatter Tests */
+extern void test_printf_flags(void);
+extern void test_printf_alternate_form(void);
+extern void test_printf_width(void);
+extern void test_printf_precision(void);
+extern void test_printf_precision_unterminated(void);
+extern void test_printf_lengths(void);
+extern void test_printf_conversions(void);
+extern void test_printf_unsupported(void);
+extern void test_printf_truncation(void);
+
+/* Sample Codec Tests */
+extern void test_codec_round_trip_stream(void);
+extern void test_codec_round_trip_block_sizes(void);
+extern void test_codec_round_trip_steps(void);
+extern void test_codec_modes(void);
+extern void test_codec_sizes(void);
+
+/* FOTA Decoder Tests */
+extern void test_fota_crc32(void);
+extern void test_fota_delta_rebuild(void);
+extern void test_fota_delta_rebuild_split(void);
+extern void test_fota_delta_trailing_bytes(void);
+extern void test_fota_delta_bad_base(void);
+extern void test_fota_delta_copy_outside_base(void);
+extern void test_fota_delta_length_past_image(void);
+extern void test_fota_delta_varint_overflow(void);
+extern void test_fota_lz_decompress(void);
+extern void test_fota_lz_trailing_bytes(void);
+extern void test_fota_lz_bad_distance(void);
+extern void test_fota_lz_length_past_image(void);
+extern void test_fota_image_take(void);
+extern void test_fota_image_resume(void);
+extern void test_fota_output_status(void);
 
 /* ==========================================================================
  * Unity Setup and Teardown
@@ -113,6 +201,9 @@ int main(void)
     RUN_TEST(test_crc16_verify_invalid);
     RUN_TEST(test_crc16_null_pointer);
     RUN_TEST(test_crc16_large_buffer);
+    RUN_TEST(test_crc16_backends_match_bitwise);
+    RUN_TEST(test_crc16_backend_dispatch);
+    RUN_TEST(test_crc16_update_incremental);
 
     /* ======================================================================
      * LRC Module Tests
@@ -128,6 +219,9 @@ int main(void)
     RUN_TEST(test_ascii_to_byte_invalid);
     RUN_TEST(test_binary_to_ascii);
     RUN_TEST(test_ascii_to_binary);
+    RUN_TEST(test_ascii_to_byte_all_pairs);
+    RUN_TEST(test_binary_to_ascii_lrc);
+    RUN_TEST(test_ascii_to_binary_lrc);
 
     /* ======================================================================
      * PDU Module Tests
@@ -162,6 +256,8 @@ int main(void)
     RUN_TEST(test_rtu_address_match_direct);
     RUN_TEST(test_rtu_address_match_broadcast);
     RUN_TEST(test_rtu_address_mismatch);
+    RUN_TEST(test_rtu_build_frame_in_place);
+    RUN_TEST(test_rtu_parse_frame_view);
 
     /* ======================================================================
      * ASCII Module Tests
@@ -184,6 +280,104 @@ int main(void)
     RUN_TEST(test_tcp_parse_frame_length_mismatch);
     RUN_TEST(test_tcp_parse_frame_too_short);
     RUN_TEST(test_tcp_transaction_id);
+    RUN_TEST(test_tcp_rx_coalesced_frames);
+    RUN_TEST(test_tcp_rx_split_frame);
+    RUN_TEST(test_tcp_parse_frame_view);
+    RUN_TEST(test_tcp_get_frame_length);
+    RUN_TEST(test_tcp_build_frame_in_place);
+
+    /* ======================================================================
+     * Core Module Tests
+     * ====================================================================== */
+    printf("\n=== Core Module Tests ===\n");
+    RUN_TEST(test_core_dispatch_unknown_function);
+    RUN_TEST(test_core_dispatch_bad_length);
+    RUN_TEST(test_core_dispatch_custom_handler);
+    RUN_TEST(test_core_process_pdu_buffer_in_frame);
+    RUN_TEST(test_core_process_pdu_buffer_overflow);
+    RUN_TEST(test_core_read_write_registers);
+    RUN_TEST(test_core_read_write_registers_bad_count);
+    RUN_TEST(test_core_callback_table);
+    RUN_TEST(test_core_callback_table_incomplete);
+    RUN_TEST(test_core_scattered_registers);
+    RUN_TEST(test_core_scattered_registers_limits);
+    RUN_TEST(test_core_scattered_registers_invalid);
+    RUN_TEST(test_core_device_id_stream);
+    RUN_TEST(test_core_device_id_specific);
+    RUN_TEST(test_core_device_id_more_follows);
+    RUN_TEST(test_core_file_record_read);
+    RUN_TEST(test_core_file_record_invalid);
+    RUN_TEST(test_core_file_record_mapped);
+    RUN_TEST(test_core_file_record_write);
+    RUN_TEST(test_core_file_record_write_invalid);
+    RUN_TEST(test_core_latency_stages);
+    RUN_TEST(test_core_latency_rejected_and_reset);
+
+    /* ======================================================================
+     * Master Module Tests
+     * ====================================================================== */
+    printf("\n=== Master Module Tests ===\n");
+    RUN_TEST(test_master_merge_adjacent);
+    RUN_TEST(test_master_merge_respects_limit);
+    RUN_TEST(test_master_rtu_poll_cycle);
+    RUN_TEST(test_master_rtu_failures);
+    RUN_TEST(test_master_deadline_scheduling);
+    RUN_TEST(test_master_tcp_pipeline);
+
+    /* ======================================================================
+     * Block Pool Tests
+     * ====================================================================== */
+    printf("\n=== Block Pool Tests ===\n");
+    RUN_TEST(test_block_pool_alloc_in_order);
+    RUN_TEST(test_block_pool_free_alloc_lifo);
+    RUN_TEST(test_block_pool_head_tag);
+    RUN_TEST(test_block_pool_free_foreign);
+    RUN_TEST(test_block_pool_init_existing);
+    RUN_TEST(test_block_pool_stats);
+
+    /* ======================================================================
+     * Formatter Tests
+     * ====================================================================== */
+    printf("\n=== Formatter Tests ===\n");
+    RUN_TEST(test_printf_flags);
+    RUN_TEST(test_printf_alternate_form);
+    RUN_TEST(test_printf_width);
+    RUN_TEST(test_printf_precision);
+    RUN_TEST(test_printf_precision_unterminated);
+    RUN_TEST(test_printf_lengths);
+    RUN_TEST(test_printf_conversions);
+    RUN_TEST(test_printf_unsupported);
+    RUN_TEST(test_printf_truncation);
+
+    /* ======================================================================
+     * Sample Codec Tests
+     * ====================================================================== */
+    printf("\n=== Sample Codec Tests ===\n");
+    RUN_TEST(test_codec_round_trip_stream);
+    RUN_TEST(test_codec_round_trip_block_sizes);
+    RUN_TEST(test_codec_round_trip_steps);
+    RUN_TEST(test_codec_modes);
+    RUN_TEST(test_codec_sizes);
+
+    /* ======================================================================
+     * FOTA Decoder Tests
+     * ====================================================================== */
+    printf("\n=== FOTA Decoder Tests ===\n");
+    RUN_TEST(test_fota_crc32);
+    RUN_TEST(test_fota_delta_rebuild);
+    RUN_TEST(test_fota_delta_rebuild_split);
+    RUN_TEST(test_fota_delta_trailing_bytes);
+    RUN_TEST(test_fota_delta_bad_base);
+    RUN_TEST(test_fota_delta_copy_outside_base);
+    RUN_TEST(test_fota_delta_length_past_image);
+    RUN_TEST(test_fota_delta_varint_overflow);
+    RUN_TEST(test_fota_lz_decompress);
+    RUN_TEST(test_fota_lz_trailing_bytes);
+    RUN_TEST(test_fota_lz_bad_distance);
+    RUN_TEST(test_fota_lz_length_past_image);
+    RUN_TEST(test_fota_image_take);
+    RUN_TEST(test_fota_image_resume);
+    RUN_TEST(test_fota_output_status);
 
     return UNITY_END();
 }
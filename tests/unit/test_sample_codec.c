@@ -0,0 +1,301 @@
+/**
+ * @file test_sample_codec.c
+ * @brief Unity unit tests for the lossless sample codec
+ *
+ * Encodes streams of blocks with sample_codec_encode() and decodes them
+ * with a reference decoder written from the format in sample_codec.h, as
+ * tools/sample_codec.py does: the samples must come back exactly, the
+ * size stay within SAMPLE_CODEC_MAX_SIZE(), and each channel take the mode
+ * its signal calls for.
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include "unity.h"
+#include "sample_codec.h"
+#include <string.h>
+
+/* ==========================================================================
+ * Reference Decoder
+ * ========================================================================== */
+
+#define TEST_CHANNELS 6U
+#define TEST_FRAMES   256U
+
+/** Predictor history of one channel, kept apart from the encoder's */
+typedef struct
+{
+    int32_t last[2];
+    uint32_t primed;
+} decoder_channel_t;
+
+/** Bit string being read, most significant bit first */
+typedef struct
+{
+    const uint8_t* data;
+    size_t bit;
+} bit_reader_t;
+
+static uint32_t read_bits(bit_reader_t* reader, uint32_t n)
+{
+    uint32_t value = 0;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint8_t byte = reader->data[reader->bit / 8U];
+
+        value = (value << 1) | ((byte >> (7U - (reader->bit % 8U))) & 1U);
+        reader->bit++;
+    }
+    return value;
+}
+
+static int32_t unzigzag(uint32_t u)
+{
+    return ((u & 1U) != 0U) ? -(int32_t)(u >> 1) - 1 : (int32_t)(u >> 1);
+}
+
+static void decoder_remember(decoder_channel_t* state, int32_t sample)
+{
+    state->last[1] = state->last[0];
+    state->last[0] = sample;
+    if (state->primed < 2U)
+    {
+        state->primed++;
+    }
+}
+
+/**
+ * @brief Decode one block of @p count frames
+ *
+ * @param modes Receives the mode of each channel
+ * @return Bytes of the block, padding included
+ */
+static size_t decode_block(decoder_channel_t* channels, uint32_t channel_count,
+                           const uint8_t* data, uint32_t count,
+                           uint16_t* frames, uint8_t* modes)
+{
+    bit_reader_t reader = {data, 0};
+
+    for (uint32_t ch = 0; ch < channel_count; ch++)
+    {
+        decoder_channel_t* state = &channels[ch];
+        uint32_t mode = read_bits(&reader, 8U);
+        uint32_t k = mode & 0x0FU;
+        uint32_t i = 0;
+
+        modes[ch] = (uint8_t)mode;
+        if (mode == SAMPLE_CODEC_MODE_VERBATIM)
+        {
+            for (; i < count; i++)
+            {
+                frames[(i * channel_count) + ch] =
+                    (uint16_t)read_bits(&reader, 16U);
+                decoder_remember(state, frames[(i * channel_count) + ch]);
+            }
+            continue;
+        }
+
+        if (state->primed == 0U)
+        {
+            frames[ch] = (uint16_t)read_bits(&reader, 16U);
+            decoder_remember(state, frames[ch]);
+            i = 1U;
+        }
+        for (; i < count; i++)
+        {
+            uint32_t zeros = 0;
+            int32_t prediction = state->last[0];
+            int32_t sample;
+
+            while (read_bits(&reader, 1U) == 0U)
+            {
+                zeros++;
+            }
+            if (((mode & SAMPLE_CODEC_MODE_ORDER2) != 0U) &&
+                (state->primed >= 2U))
+            {
+                prediction = (2 * state->last[0]) - state->last[1];
+            }
+            sample = prediction +
+                     unzigzag((zeros << k) | read_bits(&reader, k));
+            frames[(i * channel_count) + ch] = (uint16_t)sample;
+            decoder_remember(state, sample);
+        }
+    }
+
+    return (reader.bit + 7U) / 8U;
+}
+
+/* ==========================================================================
+ * Test Helpers
+ * ========================================================================== */
+
+static sample_codec_t s_codec;
+static decoder_channel_t s_decoder[SAMPLE_CODEC_MAX_CHANNELS];
+static uint16_t s_frames[TEST_FRAMES * TEST_CHANNELS];
+static uint16_t s_decoded[TEST_FRAMES * TEST_CHANNELS];
+static uint8_t s_encoded[SAMPLE_CODEC_MAX_SIZE(TEST_CHANNELS, TEST_FRAMES)];
+static uint8_t s_modes[SAMPLE_CODEC_MAX_CHANNELS];
+
+/** Deterministic noise, a 32-bit LCG */
+static uint32_t s_seed;
+
+static uint32_t noise(void)
+{
+    s_seed = (s_seed * 1664525U) + 1013904223U;
+    return s_seed >> 16;
+}
+
+static void start_stream(uint8_t channels)
+{
+    sample_codec_init(&s_codec, channels);
+    (void)memset(s_decoder, 0, sizeof(s_decoder));
+    s_seed = 1U;
+}
+
+/**
+ * @brief Encode a block of s_frames and check that it decodes back
+ */
+static void assert_round_trip(uint8_t channels, uint32_t count)
+{
+    size_t size;
+    size_t decoded;
+
+    (void)memset(s_encoded, 0xA5, sizeof(s_encoded));
+    (void)memset(s_decoded, 0, sizeof(s_decoded));
+
+    size = sample_codec_encode(&s_codec, s_frames, count, s_encoded);
+    TEST_ASSERT_LESS_OR_EQUAL(SAMPLE_CODEC_MAX_SIZE(channels, count), size);
+
+    decoded = decode_block(s_decoder, channels, s_encoded, count, s_decoded,
+                           s_modes);
+    TEST_ASSERT_EQUAL_UINT32(size, decoded);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(s_frames, s_decoded, count * channels);
+}
+
+/* ==========================================================================
+ * Round-Trip Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test a stream of blocks of slow signals with 12-bit noise on them
+ */
+void test_codec_round_trip_stream(void)
+{
+    start_stream((uint8_t)TEST_CHANNELS);
+
+    for (uint32_t block = 0; block < 8U; block++)
+    {
+        for (uint32_t i = 0; i < TEST_FRAMES; i++)
+        {
+            uint32_t n = (block * TEST_FRAMES) + i;
+
+            for (uint32_t ch = 0; ch < TEST_CHANNELS; ch++)
+            {
+                /* A ramp, a triangle and noise of growing amplitude */
+                uint32_t level = (ch * 600U) + ((n * (ch + 1U)) % 512U);
+
+                s_frames[(i * TEST_CHANNELS) + ch] =
+                    (uint16_t)((level + (noise() % (4U << ch))) & 0x0FFFU);
+            }
+        }
+        assert_round_trip((uint8_t)TEST_CHANNELS, TEST_FRAMES);
+    }
+}
+
+/**
+ * @brief Test blocks of every size from one frame, the state carried on
+ */
+void test_codec_round_trip_block_sizes(void)
+{
+    start_stream(2U);
+
+    for (uint32_t count = 1U; count <= 40U; count++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            s_frames[i * 2U] = (uint16_t)(2048U + (noise() % 16U));
+            s_frames[(i * 2U) + 1U] = (uint16_t)(count * 100U);
+        }
+        assert_round_trip(2U, count);
+    }
+}
+
+/**
+ * @brief Test full-scale steps, residuals far beyond the Rice parameter
+ */
+void test_codec_round_trip_steps(void)
+{
+    start_stream(1U);
+
+    /* Flat with one spike, whose residuals take hundreds of zero bits */
+    for (uint32_t i = 0; i < TEST_FRAMES; i++)
+    {
+        s_frames[i] = 100U;
+    }
+    s_frames[100] = 4095U;
+    assert_round_trip(1U, TEST_FRAMES);
+
+    /* The extremes of 16 bits, both signs of the largest residual */
+    for (uint32_t i = 0; i < TEST_FRAMES; i++)
+    {
+        s_frames[i] = ((i % 2U) == 0U) ? 0U : 0xFFFFU;
+    }
+    assert_round_trip(1U, TEST_FRAMES);
+}
+
+/* ==========================================================================
+ * Mode Tests
+ * ========================================================================== */
+
+/**
+ * @brief Test that each channel takes the predictor its signal calls for
+ */
+void test_codec_modes(void)
+{
+    start_stream(3U);
+
+    for (uint32_t i = 0; i < 64U; i++)
+    {
+        /* Constant, a ramp, and white noise over 16 bits */
+        s_frames[i * 3U] = 1234U;
+        s_frames[(i * 3U) + 1U] = (uint16_t)(i * 37U);
+        s_frames[(i * 3U) + 2U] = (uint16_t)noise();
+    }
+    assert_round_trip(3U, 64U);
+
+    TEST_ASSERT_EQUAL_HEX8(0x00U, s_modes[0]);
+    TEST_ASSERT_EQUAL_HEX8(SAMPLE_CODEC_MODE_ORDER2, s_modes[1]);
+    TEST_ASSERT_EQUAL_HEX8(SAMPLE_CODEC_MODE_VERBATIM, s_modes[2]);
+}
+
+/**
+ * @brief Test the size of a constant block and of a block stored verbatim
+ */
+void test_codec_sizes(void)
+{
+    size_t size;
+
+    /* Mode, first sample and one bit per further sample */
+    start_stream(1U);
+    for (uint32_t i = 0; i < 64U; i++)
+    {
+        s_frames[i] = 7U;
+    }
+    size = sample_codec_encode(&s_codec, s_frames, 64U, s_encoded);
+    TEST_ASSERT_EQUAL_UINT32(1U + 2U + 8U, size);
+
+    /* The next block has no first sample: 8 + 64 bits */
+    size = sample_codec_encode(&s_codec, s_frames, 64U, s_encoded);
+    TEST_ASSERT_EQUAL_UINT32(9U, size);
+
+    /* Noise is stored verbatim, at the bound */
+    start_stream(1U);
+    for (uint32_t i = 0; i < 64U; i++)
+    {
+        s_frames[i] = (uint16_t)noise();
+    }
+    size = sample_codec_encode(&s_codec, s_frames, 64U, s_encoded);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_CODEC_MAX_SIZE(1U, 64U), size);
+}
@@ -5,8 +5,10 @@ This module tests the modbus_codegen.py tool, specifically:
 - MAX_ADDR calculation for multi-register values (uint32)
 - Address range calculations
 - Configuration preprocessing
+- Read plans and the generated Python module
 """
 
+import importlib.util
 import sys
 from pathlib import Path
 
@@ -318,3 +320,756 @@ class TestStatisticsCalculation:
         # Check that size was added
         assert processed["registers"]["holding_registers"][0]["size"] == 1
         assert processed["registers"]["input_registers"][0]["size"] == 1
+
+
+class TestRegisterMap:
+    """Tests for the address run layout of the register maps."""
+
+    def test_runs_merge_consecutive_words(self):
+        """Test that adjacent registers, 32-bit ones included, form one run."""
+        layout = ModbusCodeGenerator._build_register_map([
+            {"name": "a", "address": 10, "size": 1},
+            {"name": "b", "address": 11, "size": 2},
+            {"name": "c", "address": 20, "size": 1},
+        ], "holding register")
+
+        assert layout["runs"] == [
+            {"start": 10, "count": 3, "slot": 0},
+            {"start": 20, "count": 1, "slot": 3},
+        ]
+        assert [s["word"] for s in layout["slots"]] == [0, 0, 1, 0]
+
+    def test_dense_map_direct_indexed(self):
+        """Test that a map with small gaps is indexed by address offset."""
+        layout = ModbusCodeGenerator._build_register_map([
+            {"name": "a", "address": 100, "size": 1},
+            {"name": "b", "address": 102, "size": 2},
+        ], "holding register")
+
+        assert layout["dense"] is True
+        assert layout["size"] == layout["span"] == 4
+        assert [s["index"] for s in layout["slots"]] == [0, 2, 3]
+
+    def test_sparse_map_compressed(self):
+        """Test that a gappy map only stores its mapped addresses."""
+        layout = ModbusCodeGenerator._build_register_map([
+            {"name": "a", "address": 0, "size": 1},
+            {"name": "b", "address": 40000, "size": 2},
+        ], "input register")
+
+        assert layout["dense"] is False
+        assert layout["span"] == 40002
+        assert layout["size"] == 3
+        assert [s["index"] for s in layout["slots"]] == [0, 1, 2]
+
+    def test_overlapping_32bit_register(self):
+        """Test that a register inside the second word of a uint32 is rejected."""
+        with pytest.raises(ValueError, match="overlaps"):
+            ModbusCodeGenerator._build_register_map([
+                {"name": "wide", "address": 5, "size": 2},
+                {"name": "narrow", "address": 6, "size": 1},
+            ], "holding register")
+
+    def test_register_past_address_space(self):
+        """Test that a uint32 at the last address is rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_register_map(
+                [{"name": "wide", "address": 65535, "size": 2}], "input register"
+            )
+
+
+class TestRegisterTypes:
+    """Tests for register sizes and word order of the data types."""
+
+    def test_size_follows_data_type(self):
+        """Test that a missing size is taken from the data type."""
+        regs = [
+            {"name": "f", "address": 0, "data_type": "float32"},
+            {"name": "q", "address": 2, "data_type": "uint64"},
+        ]
+        for reg in regs:
+            ModbusCodeGenerator._apply_register_type(reg, "high_first")
+
+        assert [r["size"] for r in regs] == [2, 4]
+
+    def test_size_mismatch(self):
+        """Test that an explicit size not matching the data type is rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._apply_register_type(
+                {"name": "q", "address": 0, "data_type": "uint64", "size": 2},
+                "high_first",
+            )
+
+    def test_word_order_shifts(self):
+        """Test the word shifts of both word orders, per register."""
+        regs = [
+            {"name": "hi", "address": 0, "data_type": "uint64"},
+            {"name": "lo", "address": 4, "data_type": "uint32",
+             "word_order": "low_first"},
+        ]
+        for reg in regs:
+            ModbusCodeGenerator._apply_register_type(reg, "high_first")
+
+        layout = ModbusCodeGenerator._build_register_map(regs, "input register")
+
+        assert [s["shift"] for s in layout["slots"]] == [48, 32, 16, 0, 0, 16]
+
+
+class TestWriteHooks:
+    """Tests for the per-group write hooks."""
+
+    def test_hook_spans(self):
+        """Test that a hook covers the group's writable members per space."""
+        registers = {
+            "coils": [{"name": "c", "address": 8, "group": "out"}],
+            "holding_registers": [
+                {"name": "a", "address": 10, "size": 2, "group": "out"},
+                {"name": "b", "address": 14, "group": "out"},
+                {"name": "r", "address": 20, "group": "out",
+                 "access": "read_only"},
+            ],
+        }
+        groups = [{"name": "out", "write_hook": True}, {"name": "other"}]
+
+        hooks = ModbusCodeGenerator._build_write_hooks(registers, groups)
+
+        assert len(hooks) == 1
+        assert hooks[0]["coils"] == {"address": 8, "span": 1}
+        assert hooks[0]["holding_registers"] == {"address": 10, "span": 5}
+
+    def test_hook_without_writable_members(self):
+        """Test that a hooked group with nothing writable is rejected."""
+        registers = {
+            "holding_registers": [
+                {"name": "r", "address": 0, "group": "g",
+                 "access": "read_only"},
+            ],
+        }
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_write_hooks(
+                registers, [{"name": "g", "write_hook": True}]
+            )
+
+    def test_hook_span_too_wide(self):
+        """Test that a group wider than the dirty mask is rejected."""
+        registers = {
+            "holding_registers": [
+                {"name": "a", "address": 0, "group": "g"},
+                {"name": "b", "address": 64, "group": "g"},
+            ],
+        }
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_write_hooks(
+                registers, [{"name": "g", "write_hook": True}]
+            )
+
+
+class TestBulkWrite:
+    """Tests for the limits of the holding registers written in bulk."""
+
+    @staticmethod
+    def _build(registers, groups):
+        for reg in registers["holding_registers"]:
+            ModbusCodeGenerator._apply_register_type(reg, "high_first")
+        holding_map = ModbusCodeGenerator._build_register_map(
+            registers["holding_registers"], "holding register"
+        )
+        return ModbusCodeGenerator._build_bulk_write(
+            registers, groups, holding_map
+        )
+
+    def test_limits_and_slots(self):
+        """Test that every word of a bulk register names its limits."""
+        registers = {
+            "holding_registers": [
+                {"name": "a", "address": 10, "group": "g",
+                 "min_value": 1, "max_value": 5},
+                {"name": "b", "address": 11, "group": "g",
+                 "data_type": "int32"},
+                {"name": "r", "address": 13, "group": "g",
+                 "access": "read_only"},
+                {"name": "c", "address": 14},
+            ],
+        }
+        groups = [{"name": "g", "write_hook": True, "bulk_write": True}]
+
+        bulk = self._build(registers, groups)
+
+        assert [(l["reg"]["name"], l["kind"], l["min"], l["max"])
+                for l in bulk["limits"]] == [
+            ("a", "unsigned", 1, 5),
+            ("b", "signed", -(1 << 31), (1 << 31) - 1),
+        ]
+        assert bulk["slots"] == [
+            {"index": 0, "limit": 1},
+            {"index": 1, "limit": 2},
+            {"index": 2, "limit": 2},
+        ]
+
+    def test_float_keys_order(self):
+        """Test that float32 keys order like the values."""
+        values = [float("-inf"), -2.5, -1e-30, 0.0, 1e-30, 1.0, float("inf")]
+        keys = [ModbusCodeGenerator._float_key(v) for v in values]
+
+        assert keys == sorted(keys)
+        assert ModbusCodeGenerator._float_key(-0.0) == 0
+        nan = ModbusCodeGenerator._float_key(float("nan"))
+        assert not keys[0] <= nan <= keys[-1]
+
+    def test_float_limits_default_to_infinities(self):
+        """Test that an unbounded float32 still rejects NaN."""
+        registers = {
+            "holding_registers": [
+                {"name": "f", "address": 0, "group": "g",
+                 "data_type": "float32"},
+            ],
+        }
+        bulk = self._build(registers, [{"name": "g", "bulk_write": True}])
+
+        assert bulk["limits"][0]["kind"] == "float"
+        assert bulk["limits"][0]["min"] == -0x7F800000
+        assert bulk["limits"][0]["max"] == 0x7F800000
+
+    def test_group_without_writable_registers(self):
+        """Test that a bulk group with nothing writable is rejected."""
+        registers = {
+            "holding_registers": [
+                {"name": "r", "address": 0, "group": "g",
+                 "access": "read_only"},
+            ],
+        }
+        with pytest.raises(ValueError):
+            self._build(registers, [{"name": "g", "bulk_write": True}])
+
+    def test_limit_outside_type(self):
+        """Test that a limit the data type cannot hold is rejected."""
+        registers = {
+            "holding_registers": [
+                {"name": "a", "address": 0, "group": "g",
+                 "max_value": 70000},
+            ],
+        }
+        with pytest.raises(ValueError):
+            self._build(registers, [{"name": "g", "bulk_write": True}])
+
+
+class TestSnapshot:
+    """Tests for the register snapshot block layout."""
+
+    def test_blocks_split_at_gaps(self):
+        """Test that runs of consecutive addresses become one block each."""
+        registers = {
+            "discrete_inputs": [
+                {"name": f"di_{i}", "address": i, "group": "io"}
+                for i in range(18)
+            ],
+            "input_registers": [
+                {"name": "a", "address": 10, "size": 2,
+                 "data_type": "uint32", "group": "io"},
+                {"name": "b", "address": 12, "group": "io"},
+                {"name": "c", "address": 20, "group": "io"},
+                {"name": "x", "address": 30, "group": "other"},
+            ],
+        }
+        groups = [{"name": "other"}, {"name": "io", "snapshot": True}]
+
+        snapshot = ModbusCodeGenerator._build_snapshot(registers, groups)
+
+        blocks = [
+            (b["table"], b["address"], b["count"]) for b in snapshot["blocks"]
+        ]
+        assert blocks == [(2, 0, 18), (4, 10, 3), (4, 20, 1)]
+        # Bits padded to whole words: 18 bits take 4 bytes
+        assert snapshot["size"] == 3 * 6 + 4 + 6 + 2
+
+    def test_layout_id_follows_names(self):
+        """Test that renaming a register changes the layout ID."""
+        groups = [{"name": "g", "snapshot": True}]
+        first = ModbusCodeGenerator._build_snapshot(
+            {"holding_registers": [{"name": "a", "address": 0, "group": "g"}]},
+            groups,
+        )
+        second = ModbusCodeGenerator._build_snapshot(
+            {"holding_registers": [{"name": "b", "address": 0, "group": "g"}]},
+            groups,
+        )
+        assert first["layout_id"] != second["layout_id"]
+
+    def test_snapshot_too_large(self):
+        """Test that a snapshot beyond one datagram is rejected."""
+        registers = {
+            "input_registers": [
+                {"name": f"r_{i}", "address": i, "group": "g"}
+                for i in range(800)
+            ],
+        }
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_snapshot(
+                registers, [{"name": "g", "snapshot": True}]
+            )
+
+
+class TestOpcua:
+    """Tests for the OPC UA address space tables."""
+
+    def test_folders_and_variables(self):
+        """Test that only marked groups become folders, with their registers."""
+        registers = {
+            "coils": [{"name": "out", "address": 3, "group": "io"}],
+            "holding_registers": [
+                {"name": "ro", "address": 9, "size": 1, "data_type": "enum",
+                 "access": "read_only", "group": "io"},
+                {"name": "sp", "address": 4, "size": 2,
+                 "data_type": "float32", "word_order": "low_first",
+                 "scale_factor": 0.1, "unit": "V", "group": "io"},
+            ],
+            "input_registers": [
+                {"name": "x", "address": 0, "size": 1, "data_type": "uint16",
+                 "group": "other"},
+            ],
+        }
+        groups = [
+            {"name": "other"},
+            {"name": "io", "description": 'say "io"', "opcua": True},
+        ]
+
+        opcua = ModbusCodeGenerator._build_opcua(registers, groups)
+
+        assert opcua["folders"] == [
+            {"name": "io", "description": 'say \\"io\\"'}
+        ]
+        nodes = [
+            (n["name"], n["table"], n["type"], n["address"], n["writable"])
+            for n in opcua["nodes"]
+        ]
+        assert nodes == [
+            ("out", 1, "BOOL", 3, True),
+            ("sp", 3, "FLOAT32", 4, True),
+            ("ro", 3, "UINT16", 9, False),
+        ]
+        assert opcua["nodes"][1]["low_first"]
+        assert opcua["nodes"][1]["scale"] == 0.1
+
+    def test_empty_group(self):
+        """Test that a marked group without registers is rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_opcua(
+                {}, [{"name": "g", "opcua": True}]
+            )
+
+
+class TestPersistent:
+    """Tests for the table of the persistent holding registers."""
+
+    def test_table_in_address_order(self):
+        """Test that only persistent registers are listed, by address."""
+        registers = {
+            "holding_registers": [
+                {"name": "b", "address": 4, "size": 2, "persistent": True},
+                {"name": "x", "address": 2},
+                {"name": "a", "address": 0, "persistent": True},
+            ],
+        }
+
+        table = ModbusCodeGenerator._build_persistent(registers)
+
+        assert [(r["name"], r["address"], r["size"]) for r in table] == [
+            ("a", 0, 1), ("b", 4, 2),
+        ]
+
+    def test_read_only_rejected(self):
+        """Test that a read-only persistent register is rejected."""
+        registers = {
+            "holding_registers": [
+                {"name": "a", "address": 0, "access": "read_only",
+                 "persistent": True},
+            ],
+        }
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_persistent(registers)
+
+    def test_other_space_rejected(self):
+        """Test that a persistent coil is rejected."""
+        registers = {
+            "coils": [{"name": "c", "address": 0, "persistent": True}],
+        }
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_persistent(registers)
+
+
+class TestDeviceIdentification:
+    """Tests for the FC43/14 device identification object table."""
+
+    def test_basic_objects_defaults(self):
+        """Test that the three basic objects are always generated."""
+        objects = ModbusCodeGenerator._build_device_id({"name": "test_device"})
+
+        assert [o["id"] for o in objects] == [0x00, 0x01, 0x02]
+        assert objects[1]["value"] == "test_device"
+        assert objects[2]["value"] == "1.0.0"
+
+    def test_regular_objects_sorted(self):
+        """Test that optional objects are included in object ID order."""
+        objects = ModbusCodeGenerator._build_device_id({
+            "name": "test_device",
+            "model_name": "M1",
+            "vendor_url": "http://example.com",
+        })
+
+        assert [o["id"] for o in objects] == [0x00, 0x01, 0x02, 0x03, 0x05]
+
+    def test_value_escaped_length_unescaped(self):
+        """Test that quotes are escaped for C but counted once."""
+        objects = ModbusCodeGenerator._build_device_id(
+            {"name": "test_device", "vendor_name": 'A "B"'}
+        )
+
+        assert objects[0]["value"] == 'A \\"B\\"'
+        assert objects[0]["length"] == 5
+
+    def test_value_too_long(self):
+        """Test that an object not fitting one response is rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_device_id(
+                {"name": "test_device", "product_name": "x" * 245}
+            )
+
+
+class TestCanDatabase:
+    """Tests for the DBC file of the CAN messages."""
+
+    MESSAGE = {
+        "name": "samples",
+        "id": 256,
+        "length": 16,
+        "signals": [
+            {"name": "sequence", "start_byte": 0, "data_type": "uint32"},
+            {"name": "value", "start_byte": 4, "data_type": "int16",
+             "count": 3, "step_bytes": 4, "scale_factor": 0.001, "unit": "V"},
+        ],
+    }
+
+    def test_repeated_signals_expanded(self):
+        """Test that a repeated signal becomes one signal per repetition."""
+        signals = ModbusCodeGenerator._build_can_signals(self.MESSAGE)
+
+        assert [s["name"] for s in signals] == [
+            "sequence", "value_0", "value_1", "value_2",
+        ]
+        assert [s["start_bit"] for s in signals] == [0, 32, 64, 96]
+        assert signals[1]["signed"] is True
+        assert (signals[1]["min"], signals[1]["max"]) == (-32768, 32767)
+
+    def test_signal_past_message_end(self):
+        """Test that a signal not fitting the payload is rejected."""
+        message = dict(self.MESSAGE, length=12)
+
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_can_signals(message)
+
+    def test_overlapping_signals(self):
+        """Test that signals sharing a byte are rejected."""
+        message = dict(self.MESSAGE, signals=[
+            {"name": "a", "start_byte": 0, "data_type": "uint16"},
+            {"name": "b", "start_byte": 1, "data_type": "uint8"},
+        ])
+
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_can_signals(message)
+
+    def test_dbc_written(self, tmp_path):
+        """Test the message, signal and FD attribute lines of the DBC file."""
+        template_dir = Path(__file__).parent.parent.parent / "tools" / "modbus_codegen" / "templates"
+        generator = ModbusCodeGenerator(template_dir=template_dir)
+        config = {
+            "device": {"name": "test_device"},
+            "can": {
+                "nominal_bitrate": 500000,
+                "data_bitrate": 2000000,
+                "messages": [dict(self.MESSAGE, fd=True, brs=True)],
+            },
+        }
+
+        path = generator.generate_can_database(config, tmp_path / "test.dbc")
+        dbc = path.read_text(encoding="utf-8")
+
+        assert "BO_ 256 samples: 16 test_device" in dbc
+        assert ' SG_ value_2 : 96|16@1- (0.001,0) [-32.768|32.767] "V"' in dbc
+        assert 'BA_ "VFrameFormat" BO_ 256 14;' in dbc
+        assert 'BA_ "CANFD_BRS" BO_ 256 1;' in dbc
+        assert 'BA_ "BaudrateCANFD" 2000000;' in dbc
+
+
+class TestInterlocks:
+    """Tests for the interlock rule table."""
+
+    RULE = {
+        "name": "a0_high",
+        "input": 0,
+        "condition": "above",
+        "threshold": 3,
+        "output": 4,
+        "state": False,
+    }
+
+    def test_defaults_and_literals(self):
+        """Test the defaults and the C literals of a rule."""
+        rules = ModbusCodeGenerator._build_interlocks([
+            self.RULE,
+            dict(self.RULE, name="a1_low", input=1, condition="below",
+                 threshold=0.25, hysteresis=0.05, delay_ms=20, output=5,
+                 state=True, enabled=False),
+        ])
+
+        assert [(r["above"], r["threshold"], r["hysteresis"], r["delay_ms"],
+                 r["enabled"]) for r in rules] == [
+            (True, "3.0f", "0.0f", 0, True),
+            (False, "0.25f", "0.05f", 20, False),
+        ]
+
+    def test_shared_output_same_state(self):
+        """Test that rules may share an output they force the same way."""
+        rules = ModbusCodeGenerator._build_interlocks([
+            self.RULE, dict(self.RULE, name="a1_high", input=1),
+        ])
+
+        assert len(rules) == 2
+
+    def test_shared_output_different_states(self):
+        """Test that rules forcing one output both ways are rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_interlocks([
+                self.RULE, dict(self.RULE, name="a1_high", state=True),
+            ])
+
+    def test_duplicate_name(self):
+        """Test that two rules of one name are rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_interlocks([self.RULE, self.RULE])
+
+    def test_negative_hysteresis(self):
+        """Test that a negative hysteresis is rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_interlocks([
+                dict(self.RULE, hysteresis=-0.1),
+            ])
+
+    def test_too_many_rules(self):
+        """Test that more rules than register bits are rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_interlocks([
+                dict(self.RULE, name=f"r_{i}") for i in range(17)
+            ])
+
+
+class TestExpanders:
+    """Tests for the I2C expanders of the digital outputs."""
+
+    @staticmethod
+    def coils(count, start=0):
+        """Registers with count coils of the group "do" from start."""
+        return {
+            "coils": [
+                {"name": f"do_{i}", "address": start + i, "group": "do"}
+                for i in range(count)
+            ],
+        }
+
+    def test_no_expanders(self):
+        """Test that a map without expanders has no table."""
+        assert ModbusCodeGenerator._build_expanders(
+            self.coils(8), [{"name": "do"}]
+        ) is None
+
+    def test_expanders_in_output_order(self):
+        """Test that the addresses are kept in the order listed."""
+        expanders = ModbusCodeGenerator._build_expanders(
+            self.coils(32, start=100),
+            [{"name": "do", "i2c_expanders": [0x21, 0x20, 0x23, 0x22]}],
+        )
+
+        assert expanders == {
+            "group": "do", "addresses": [0x21, 0x20, 0x23, 0x22],
+        }
+
+    def test_coils_per_expander(self):
+        """Test that a group needs eight coils per expander."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_expanders(
+                self.coils(12), [{"name": "do", "i2c_expanders": [0x20, 0x21]}]
+            )
+
+    def test_coils_consecutive(self):
+        """Test that a group with a gap in its coils is rejected."""
+        registers = self.coils(8)
+        registers["coils"][7]["address"] = 9
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_expanders(
+                registers, [{"name": "do", "i2c_expanders": [0x20]}]
+            )
+
+    def test_duplicate_address(self):
+        """Test that an expander listed twice is rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_expanders(
+                self.coils(16), [{"name": "do", "i2c_expanders": [0x20, 0x20]}]
+            )
+
+    def test_too_many_expanders(self):
+        """Test that more expanders than the output image holds are rejected."""
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_expanders(
+                self.coils(40),
+                [{"name": "do", "i2c_expanders": [0x20, 0x21, 0x22, 0x23, 0x24]}],
+            )
+
+    def test_two_groups(self):
+        """Test that only one group may drive the expanders."""
+        registers = self.coils(8)
+        with pytest.raises(ValueError):
+            ModbusCodeGenerator._build_expanders(
+                registers,
+                [{"name": "do", "i2c_expanders": [0x20]},
+                 {"name": "other", "i2c_expanders": [0x21]}],
+            )
+
+
+class TestReadPlan:
+    """Tests for the read plans and the generated Python module."""
+
+    RUNS = [
+        {"start": 0, "count": 200, "slot": 0},
+        {"start": 300, "count": 10, "slot": 200},
+    ]
+
+    @staticmethod
+    def _load_module(tmp_path, config):
+        """Generate the Python module of a configuration and import it."""
+        generator = ModbusCodeGenerator()
+        config = generator._preprocess_config(config)
+        path = generator.generate_python_client(
+            config, tmp_path / "test_device_registers.py"
+        )
+        spec = importlib.util.spec_from_file_location(path.stem, path)
+        module = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(module)
+        return module
+
+    def test_unselected_addresses_bridged(self):
+        """Test that one request covers registers with unselected ones between."""
+        items = [(10, 1), (0, 2), (50, 4)]
+
+        plan = ModbusCodeGenerator._build_read_plan(items, self.RUNS, 125)
+
+        assert plan == [{"start": 0, "count": 54, "items": [1, 0, 2]}]
+
+    def test_request_limit(self):
+        """Test that no request exceeds the limit and a register is never split."""
+        items = [(0, 1), (123, 2), (125, 1)]
+
+        plan = ModbusCodeGenerator._build_read_plan(items, self.RUNS, 125)
+
+        assert [(r["start"], r["count"]) for r in plan] == [(0, 125), (125, 1)]
+
+    def test_runs_not_crossed(self):
+        """Test that a request never spans an unmapped address."""
+        items = [(199, 1), (300, 2)]
+
+        plan = ModbusCodeGenerator._build_read_plan(items, self.RUNS, 125)
+
+        assert [(r["start"], r["count"]) for r in plan] == [(199, 1), (300, 2)]
+
+    def test_minimum_requests(self):
+        """Test that a run is covered by the fewest requests of the limit."""
+        items = [(address, 1) for address in range(0, 200, 3)]
+
+        plan = ModbusCodeGenerator._build_read_plan(items, self.RUNS, 125)
+
+        assert len(plan) == 2
+        assert all(r["count"] <= 125 for r in plan)
+
+    def test_module_plans_and_decoders(self, tmp_path):
+        """Test the generated plans, keys and decoders."""
+        module = self._load_module(tmp_path, {
+            "device": {"name": "test_device"},
+            "groups": [{"name": "a"}, {"name": "b"}],
+            "registers": {
+                "coils": [
+                    {"name": "level", "address": 0, "group": "a"},
+                ],
+                "input_registers": [
+                    {"name": "level", "address": 0, "group": "a",
+                     "scale_factor": 0.5},
+                    {"name": "count", "address": 1, "data_type": "uint32",
+                     "group": "a"},
+                    {"name": "ratio", "address": 3, "data_type": "float32",
+                     "word_order": "low_first", "group": "b"},
+                    {"name": "far", "address": 10, "group": "b"},
+                ],
+            },
+        })
+
+        assert module.IR_COUNT == 1
+        assert set(module.GROUPS["a"]) == {
+            "coils.level", "input_registers.level", "count",
+        }
+        assert [(r.function, r.start, r.count) for r in module.PLANS["b"]] == [
+            (4, 3, 2), (4, 10, 1),
+        ]
+        for group, plan in module.PLANS.items():
+            assert tuple(module.plan(module.GROUPS[group])) == plan
+        assert tuple(module.plan(module.REGISTERS)) == module.PLAN_ALL
+
+        read = module.PLAN_ALL[1]
+        values = module.decode_read(
+            read, [3, 0x0001, 0x0002, 0x0000, 0x3FC0]
+        )
+        assert values == {
+            "input_registers.level": 1.5, "count": 0x10002, "ratio": 1.5,
+        }
+        assert module.decode_int32([0xFFFF, 0xFFFE]) == -2
+        assert module.decode_uint64([0, 0, 1, 0]) == 0x10000
+
+    def test_module_scatter(self, tmp_path):
+        """Test that FC100 requests pack scattered registers without gaps."""
+        module = self._load_module(tmp_path, {
+            "device": {"name": "test_device"},
+            "registers": {
+                "coils": [{"name": "relay", "address": 0}],
+                "holding_registers": [
+                    {"name": "setpoint", "address": 40},
+                    {"name": "limit", "address": 41, "data_type": "uint32"},
+                    {"name": "mode", "address": 900},
+                ],
+                "input_registers": [
+                    {"name": "level", "address": 7, "scale_factor": 0.5},
+                ] + [
+                    {"name": f"ch_{i}", "address": 100 + 2 * i}
+                    for i in range(60)
+                ],
+            },
+        })
+
+        scatters = module.plan_scatter(
+            ["mode", "level", "setpoint", "limit"]
+        )
+        assert len(scatters) == 1
+        scatter = scatters[0]
+        assert [(d.function, d.start, d.count) for d in scatter.descriptors] == [
+            (3, 40, 3), (3, 900, 1), (4, 7, 1),
+        ]
+        assert scatter.count == 5
+        assert module.encode_scatter(scatter) == bytes([
+            15, 3, 0, 40, 0, 3, 3, 0x03, 0x84, 0, 1, 4, 0, 7, 0, 1,
+        ])
+        assert module.decode_scatter(scatter, [1, 0, 2, 3, 5]) == {
+            "setpoint": 1, "limit": 2, "mode": 3, "level": 2.5,
+        }
+
+        # 60 registers apart from each other: over 50 descriptors
+        scatters = module.plan_scatter(f"ch_{i}" for i in range(60))
+        assert [len(s.descriptors) for s in scatters] == [50, 10]
+        assert all(s.count <= module.MAX_READ_REGISTERS for s in scatters)
+
+        with pytest.raises(ValueError):
+            module.plan_scatter(["relay"])
@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+"""
+ADC Sample Path Latency Reader
+
+Reads the stage times of the ADC1 sample path from the diagnostic input
+registers of a jerry_device (modbus_diag.h, from 0xF300) and prints them
+per stage: trigger to DMA interrupt, interrupt to block callback, callback
+to filter task, filtering, block hook, and the whole path. The counts and
+histograms are cumulative since boot; with --interval the figures are those
+of the blocks timed between two reads.
+
+The table is in the units of the timing budget in
+plans/adc_filter_architecture.md. --plot draws the histograms with
+matplotlib, to a window or to a file.
+
+Usage:
+    python adc_latency.py --host 169.254.4.100
+    python adc_latency.py --host 169.254.4.100 --interval 10
+    python adc_latency.py --host 169.254.4.100 --plot latency.png
+"""
+
+from __future__ import annotations
+
+import argparse
+import sys
+import time
+from dataclasses import dataclass
+
+try:
+    from pymodbus.client import ModbusTcpClient
+    from pymodbus.exceptions import ModbusException
+except ImportError:
+    print("Error: pymodbus is required. Install with: pip install pymodbus")
+    sys.exit(1)
+
+
+# Default configuration matching jerry_device register map
+DEFAULT_HOST = "169.254.4.100"
+DEFAULT_PORT = 502
+DEFAULT_UNIT_ID = 1
+
+# ADC latency block (modbus_diag.h, bsp_adc1_latency_stage_t)
+ADC_IR_BASE = 0xF300
+BUCKETS = 16
+MIN_SHIFT = 8
+STAGE_REGS = 5 + 2 * BUCKETS
+STAGES = [
+    "Trigger to DMA interrupt",
+    "Interrupt to callback",
+    "Callback to filter task",
+    "Filter",
+    "Block hook",
+    "Total",
+]
+
+# Registers per read, the FC04 limit
+MAX_READ = 125
+
+# Cycle counter rate, for the bucket bounds
+CPU_HZ = 250_000_000
+
+
+@dataclass
+class StageTimes:
+    """Times of one stage, in 0.1 us for min, mean and max."""
+
+    count: int
+    min_tenths: int
+    mean_tenths: int
+    max_tenths: int
+    buckets: list[int]
+
+
+def bucket_bound_us(bucket: int) -> float:
+    """Upper bound of a histogram bucket in us."""
+    return (1 << (MIN_SHIFT + bucket)) * 1e6 / CPU_HZ
+
+
+def bucket_label(bucket: int) -> str:
+    """Range of a histogram bucket, for axis labels."""
+    if bucket == BUCKETS - 1:
+        return f">={bucket_bound_us(bucket - 1):.3g}"
+    return f"<{bucket_bound_us(bucket):.3g}"
+
+
+def read_stages(client: ModbusTcpClient, unit_id: int) -> list[StageTimes]:
+    """Read the ADC latency block and split it into stages."""
+    total = STAGE_REGS * len(STAGES)
+    registers: list[int] = []
+
+    while len(registers) < total:
+        count = min(MAX_READ, total - len(registers))
+        result = client.read_input_registers(
+            address=ADC_IR_BASE + len(registers), count=count, slave=unit_id
+        )
+        if result.isError():
+            raise ModbusException(str(result))
+        registers.extend(result.registers)
+
+    stages = []
+    for i in range(len(STAGES)):
+        slot = registers[i * STAGE_REGS : (i + 1) * STAGE_REGS]
+        buckets = [
+            (slot[5 + 2 * b] << 16) | slot[6 + 2 * b] for b in range(BUCKETS)
+        ]
+        stages.append(
+            StageTimes((slot[0] << 16) | slot[1], slot[2], slot[3], slot[4], buckets)
+        )
+    return stages
+
+
+def difference(new: list[StageTimes], old: list[StageTimes]) -> list[StageTimes]:
+    """Counts and buckets of the blocks timed between two reads.
+
+    The minimum, mean and maximum are only kept since boot, so the mean is
+    estimated from the buckets and the extremes are left as read.
+    """
+    stages = []
+    for a, b in zip(new, old):
+        buckets = [(x - y) & 0xFFFFFFFF for x, y in zip(a.buckets, b.buckets)]
+        stages.append(
+            StageTimes(
+                (a.count - b.count) & 0xFFFFFFFF,
+                a.min_tenths,
+                round(histogram_mean_us(buckets) * 10),
+                a.max_tenths,
+                buckets,
+            )
+        )
+    return stages
+
+
+def histogram_mean_us(buckets: list[int]) -> float:
+    """Mean of a histogram, taking each bucket at its geometric midpoint."""
+    count = sum(buckets)
+    if count == 0:
+        return 0.0
+    total = 0.0
+    for bucket, n in enumerate(buckets):
+        upper = bucket_bound_us(bucket)
+        total += n * (upper / 2 if bucket == 0 else upper / 2**0.5)
+    return total / count
+
+
+def percentile_us(buckets: list[int], fraction: float) -> float:
+    """Upper bucket bound below which a fraction of the blocks falls."""
+    count = sum(buckets)
+    if count == 0:
+        return 0.0
+    seen = 0
+    for bucket, n in enumerate(buckets):
+        seen += n
+        if seen >= fraction * count:
+            return bucket_bound_us(bucket)
+    return bucket_bound_us(BUCKETS - 1)
+
+
+def print_stages(stages: list[StageTimes]) -> None:
+    """Print one row per stage."""
+    print(
+        f"{'Stage':<26}{'Blocks':>10}{'Min(us)':>10}{'Mean(us)':>10}"
+        f"{'Max(us)':>10}{'p99<(us)':>10}"
+    )
+    print("-" * 76)
+    for name, stage in zip(STAGES, stages):
+        print(
+            f"{name:<26}{stage.count:>10}{stage.min_tenths / 10:>10.1f}"
+            f"{stage.mean_tenths / 10:>10.1f}{stage.max_tenths / 10:>10.1f}"
+            f"{percentile_us(stage.buckets, 0.99):>10.1f}"
+        )
+
+
+def plot_stages(stages: list[StageTimes], output: str | None) -> None:
+    """Draw the histogram of every stage."""
+    try:
+        import matplotlib
+
+        if output:
+            matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("Error: matplotlib is required for --plot. Install with: pip install matplotlib")
+        return
+
+    fig, axes = plt.subplots(len(STAGES), 1, figsize=(9, 2.2 * len(STAGES)))
+    labels = [bucket_label(b) for b in range(BUCKETS)]
+    for ax, name, stage in zip(axes, STAGES, stages):
+        ax.bar(range(BUCKETS), stage.buckets)
+        ax.set_yscale("symlog")
+        ax.set_title(f"{name} ({stage.count} blocks)", fontsize=9)
+        ax.set_xticks(range(BUCKETS))
+        ax.set_xticklabels(labels, fontsize=7)
+    axes[-1].set_xlabel("Stage time (us)")
+    fig.tight_layout()
+
+    if output:
+        fig.savefig(output)
+        print(f"Histograms written to {output}")
+    else:
+        plt.show()
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Read the ADC1 sample path stage times of a jerry_device",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --host 169.254.4.100
+  %(prog)s --host 169.254.4.100 --interval 10
+  %(prog)s --host 169.254.4.100 --plot latency.png
+        """,
+    )
+
+    parser.add_argument(
+        "--host",
+        "-H",
+        default=DEFAULT_HOST,
+        help=f"Modbus TCP server IP address (default: {DEFAULT_HOST})",
+    )
+    parser.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"Modbus TCP server port (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--unit-id",
+        "-u",
+        type=int,
+        default=DEFAULT_UNIT_ID,
+        help=f"Modbus unit ID (default: {DEFAULT_UNIT_ID})",
+    )
+    parser.add_argument(
+        "--interval",
+        "-i",
+        type=float,
+        help="Report only the blocks timed over this many seconds",
+    )
+    parser.add_argument(
+        "--plot",
+        nargs="?",
+        const="",
+        metavar="FILE",
+        help="Plot the histograms, to FILE if given",
+    )
+
+    args = parser.parse_args()
+
+    client = ModbusTcpClient(host=args.host, port=args.port, timeout=3.0)
+    if not client.connect():
+        print(f"Error: Could not connect to {args.host}:{args.port}")
+        return 1
+
+    try:
+        stages = read_stages(client, args.unit_id)
+        if args.interval is not None:
+            time.sleep(args.interval)
+            stages = difference(read_stages(client, args.unit_id), stages)
+    except ModbusException as exc:
+        print(f"Error: {exc}")
+        return 1
+    finally:
+        client.close()
+
+    print_stages(stages)
+    if args.plot is not None:
+        plot_stages(stages, args.plot or None)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
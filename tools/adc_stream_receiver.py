@@ -0,0 +1,481 @@
+#!/usr/bin/env python3
+"""
+ADC Stream Receiver
+
+Receives the UDP waveform stream sent by the jerry_device ADC stream task,
+puts the datagrams back in order and reports packet and sample loss.
+Optionally writes the reassembled samples to a CSV file.
+
+The stream is configured through the Modbus holding registers 120-127
+(adc_stream_enable, _content, _channels, _decimated, _ip_high, _ip_low,
+_port, _compress); see config/jerry_registers.json. The datagram format is
+described in application/inc/adc_stream_task.h; compressed datagrams are
+decoded with sample_codec.py.
+
+Usage:
+    python adc_stream_receiver.py --port 5005
+    python adc_stream_receiver.py --port 5005 --csv samples.csv
+    python adc_stream_receiver.py --bind 169.254.4.50 --interval 5
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import socket
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+from typing import Any, TextIO
+
+from sample_codec import CodecError, Decoder
+
+# Default configuration matching the ADC stream task
+DEFAULT_BIND = "0.0.0.0"
+DEFAULT_PORT = 5005
+DEFAULT_INTERVAL = 1.0
+
+# Datagrams held back waiting for a reordered predecessor
+DEFAULT_REORDER_WINDOW = 8
+
+# Datagram format (adc_stream_task.h)
+STREAM_MAGIC = 0x534A
+STREAM_VERSION = 1
+HEADER = struct.Struct("<HBBBBHIIHHIQ")
+
+FLAG_RAW = 0x01
+FLAG_FILTERED = 0x02
+FLAG_DECIMATED = 0x04
+FLAG_TIME_VALID = 0x08
+FLAG_TIME_PTP = 0x10
+FLAG_COMPRESSED = 0x20
+FLAG_TIME_ALIGNED = 0x40
+FLAG_DI = 0x80
+FLAG_TIME = FLAG_TIME_VALID | FLAG_TIME_PTP | FLAG_TIME_ALIGNED
+
+# Sample timestamp tick rate (BSP_ADC1_TIMESTAMP_HZ), and that of PTP time
+TIMESTAMP_HZ = 10_000_000
+PTP_TIMESTAMP_HZ = 1_000_000_000
+
+# Sample timestamp ticks between consecutive triggers (ADC_FILTER_SAMPLE_RATE)
+SAMPLE_PERIOD_TICKS = TIMESTAMP_HZ // 10_000
+
+# Number of ADC1 channels (BSP_ADC1_NUM_CHANNELS)
+NUM_CHANNELS = 6
+
+# Frames per encoded block of a compressed datagram (ADC_STREAM_CODEC_BLOCK)
+CODEC_BLOCK = 32
+
+# Sequence numbers are 32-bit and wrap
+SEQ_MOD = 1 << 32
+
+# Datagram sequence jump back that is taken as a device restart
+RESTART_DISTANCE = 1000
+
+
+@dataclass
+class Datagram:
+    """One decoded stream datagram."""
+
+    flags: int
+    channel_mask: int
+    sequence: int
+    first_sample: int
+    sequence_step: int
+    device_lost: int
+    time: int | None
+    raw: list[tuple[int, ...]]
+    filtered: list[tuple[float, ...]]
+    di: list[int] = field(default_factory=list)
+
+    @property
+    def frame_count(self) -> int:
+        """Number of frames in the datagram."""
+        return max(len(self.raw), len(self.filtered), len(self.di))
+
+    @property
+    def channels(self) -> list[int]:
+        """Channel indices in the mask, in frame order."""
+        return [ch for ch in range(NUM_CHANNELS) if self.channel_mask & (1 << ch)]
+
+
+@dataclass
+class StreamStats:
+    """Loss and throughput counters."""
+
+    received: int = 0
+    lost: int = 0
+    late: int = 0
+    invalid: int = 0
+    frames: int = 0
+    frames_aligned: int = 0
+    sample_gaps: int = 0
+    samples_lost_network: int = 0
+    samples_lost_device: int = 0
+    bytes: int = 0
+    started: float = field(default_factory=time.monotonic)
+
+    def report(self) -> str:
+        """Format the counters as one line."""
+        expected = self.received + self.lost
+        loss = (100.0 * self.lost / expected) if expected else 0.0
+        elapsed = max(time.monotonic() - self.started, 1e-6)
+        return (
+            f"datagrams {self.received} lost {self.lost} ({loss:.3f}%) "
+            f"late {self.late} invalid {self.invalid} | "
+            f"frames {self.frames} aligned {self.frames_aligned} | "
+            f"gap samples net {self.samples_lost_network} "
+            f"device {self.samples_lost_device} | "
+            f"{8.0 * self.bytes / elapsed / 1e6:.2f} Mbit/s"
+        )
+
+
+def decode_datagram(data: bytes) -> Datagram | None:
+    """Decode a datagram, or return None if it is not a valid stream datagram."""
+    if len(data) < HEADER.size:
+        return None
+
+    (
+        magic,
+        version,
+        flags,
+        channel_mask,
+        channel_count,
+        frame_count,
+        sequence,
+        first_sample,
+        sequence_step,
+        frame_size,
+        device_lost,
+        timestamp,
+    ) = HEADER.unpack_from(data)
+
+    if magic != STREAM_MAGIC or version != STREAM_VERSION:
+        return None
+
+    raw_size = 2 * channel_count if flags & FLAG_RAW else 0
+    filtered_size = 4 * channel_count if flags & FLAG_FILTERED else 0
+    di_size = 2 if flags & FLAG_DI else 0
+    if frame_size != raw_size + filtered_size + di_size or frame_size == 0:
+        return None
+
+    di: list[int] = []
+    if flags & FLAG_COMPRESSED:
+        if filtered_size or di_size or not channel_count:
+            return None
+        raw = decode_compressed(data, channel_count, frame_count)
+        if raw is None:
+            return None
+        filtered = []
+    else:
+        if len(data) != HEADER.size + frame_count * frame_size:
+            return None
+        raw, filtered, di = decode_frames(
+            data, channel_count, frame_count, raw_size, filtered_size, di_size
+        )
+
+    return Datagram(
+        flags=flags,
+        channel_mask=channel_mask,
+        sequence=sequence,
+        first_sample=first_sample,
+        sequence_step=sequence_step,
+        device_lost=device_lost,
+        time=timestamp if flags & FLAG_TIME_VALID else None,
+        raw=raw,
+        filtered=filtered,
+        di=di,
+    )
+
+
+def decode_compressed(
+    data: bytes, channel_count: int, frame_count: int
+) -> list[tuple[int, ...]] | None:
+    """Decode the coded blocks of a compressed datagram, None if invalid."""
+    decoder = Decoder(channel_count)
+    raw: list[tuple[int, ...]] = []
+    offset = HEADER.size
+    try:
+        while len(raw) < frame_count:
+            count = min(CODEC_BLOCK, frame_count - len(raw))
+            frames, offset = decoder.decode(data, count, offset)
+            raw += frames
+    except CodecError:
+        return None
+    return raw if offset == len(data) else None
+
+
+def decode_frames(
+    data: bytes,
+    channel_count: int,
+    frame_count: int,
+    raw_size: int,
+    filtered_size: int,
+    di_size: int = 0,
+) -> tuple[list[tuple[int, ...]], list[tuple[float, ...]], list[int]]:
+    """Unpack the uncoded frames of a datagram."""
+
+    raw_fmt = struct.Struct(f"<{channel_count}H")
+    filtered_fmt = struct.Struct(f"<{channel_count}f")
+    di_fmt = struct.Struct("<H")
+    raw: list[tuple[int, ...]] = []
+    filtered: list[tuple[float, ...]] = []
+    di: list[int] = []
+
+    offset = HEADER.size
+    for _ in range(frame_count):
+        if raw_size:
+            raw.append(raw_fmt.unpack_from(data, offset))
+            offset += raw_size
+        if filtered_size:
+            filtered.append(filtered_fmt.unpack_from(data, offset))
+            offset += filtered_size
+        if di_size:
+            di.append(di_fmt.unpack_from(data, offset)[0])
+            offset += di_size
+    return raw, filtered, di
+
+
+class StreamReassembler:
+    """Puts datagrams back in order and tracks loss."""
+
+    def __init__(self, window: int, writer: Any | None) -> None:
+        self.window = window
+        self.writer = writer
+        self.stats = StreamStats()
+        self.pending: dict[int, Datagram] = {}
+        self.next_sequence: int | None = None
+        self.next_sample: int | None = None
+        self.device_lost: int | None = None
+        self.layout: tuple[int, int] | None = None
+
+    def push(self, data: bytes) -> None:
+        """Feed one received datagram."""
+        datagram = decode_datagram(data)
+        if datagram is None:
+            self.stats.invalid += 1
+            return
+
+        self.stats.received += 1
+        self.stats.bytes += len(data)
+
+        if self.next_sequence is None:
+            self.next_sequence = datagram.sequence
+        else:
+            behind = (self.next_sequence - datagram.sequence) % SEQ_MOD
+            if 0 < behind <= RESTART_DISTANCE:
+                # Arrived after the stream position moved past it
+                self.stats.late += 1
+                return
+            if RESTART_DISTANCE < behind < SEQ_MOD // 2:
+                # Far behind: the device restarted its sequence
+                self.flush()
+                self.next_sequence = datagram.sequence
+                self.layout = None
+
+        self.pending[datagram.sequence] = datagram
+        self._release()
+
+    def flush(self) -> None:
+        """Release everything still held back, counting the gaps as lost."""
+        while self.pending:
+            self._skip_to_oldest()
+            self._release()
+
+    def _skip_to_oldest(self) -> None:
+        assert self.next_sequence is not None
+        oldest = min(
+            self.pending, key=lambda seq: (seq - self.next_sequence) % SEQ_MOD
+        )
+        self.stats.lost += (oldest - self.next_sequence) % SEQ_MOD
+        self.next_sequence = oldest
+
+    def _release(self) -> None:
+        assert self.next_sequence is not None
+        while True:
+            datagram = self.pending.pop(self.next_sequence, None)
+            if datagram is None:
+                if len(self.pending) <= self.window:
+                    return
+                self._skip_to_oldest()
+                continue
+
+            self._consume(datagram)
+            self.next_sequence = (self.next_sequence + 1) % SEQ_MOD
+
+    def _consume(self, datagram: Datagram) -> None:
+        layout = (datagram.flags & ~FLAG_TIME, datagram.channel_mask)
+        if layout != self.layout:
+            # Configuration changed on the device: start a new sample stream
+            self.layout = layout
+            self.next_sample = None
+            self.device_lost = None
+            self._write_header(datagram)
+
+        if self.next_sample is not None and datagram.first_sample != self.next_sample:
+            missing = (
+                (datagram.first_sample - self.next_sample) % SEQ_MOD
+            ) // max(datagram.sequence_step, 1)
+            device = 0
+            if self.device_lost is not None:
+                device = (datagram.device_lost - self.device_lost) % SEQ_MOD
+                device = min(device, missing)
+            self.stats.sample_gaps += 1
+            self.stats.samples_lost_device += device
+            self.stats.samples_lost_network += missing - device
+
+        self.device_lost = datagram.device_lost
+        self.stats.frames += datagram.frame_count
+        if datagram.flags & FLAG_TIME_ALIGNED:
+            # Captured at the same PTP times as on the other aligned nodes
+            self.stats.frames_aligned += datagram.frame_count
+        self.next_sample = (
+            datagram.first_sample + datagram.frame_count * datagram.sequence_step
+        ) % SEQ_MOD
+
+        if self.writer is not None:
+            self._write_frames(datagram)
+
+    def _write_header(self, datagram: Datagram) -> None:
+        if self.writer is None:
+            return
+        row = ["sequence", "time_s"]
+        if datagram.flags & FLAG_RAW:
+            row += [f"raw_a{ch}" for ch in datagram.channels]
+        if datagram.flags & FLAG_FILTERED:
+            row += [f"filtered_a{ch}" for ch in datagram.channels]
+        if datagram.flags & FLAG_DI:
+            # Captured input levels and inputs with an edge, bit n = DIn
+            row += ["di", "di_edges"]
+        self.writer.writerow(row)
+
+    def _write_frames(self, datagram: Datagram) -> None:
+        assert self.writer is not None
+        # Only the first frame is stamped; the others follow at the trigger
+        # period. PTP times are ns on the master's timescale.
+        if datagram.flags & FLAG_TIME_PTP:
+            rate, digits = PTP_TIMESTAMP_HZ, 9
+        else:
+            rate, digits = TIMESTAMP_HZ, 7
+        period = datagram.sequence_step * SAMPLE_PERIOD_TICKS * (rate // TIMESTAMP_HZ)
+        for i in range(datagram.frame_count):
+            sequence = (datagram.first_sample + i * datagram.sequence_step) % SEQ_MOD
+            if datagram.time is not None:
+                ticks = datagram.time + i * period
+                stamp = f"{ticks / rate:.{digits}f}"
+            else:
+                stamp = ""
+            row: list[object] = [sequence, stamp]
+            if datagram.raw:
+                row += list(datagram.raw[i])
+            if datagram.filtered:
+                row += [f"{value:.7g}" for value in datagram.filtered[i]]
+            if datagram.di:
+                word = datagram.di[i]
+                row += [f"0x{word & 0xFF:02X}", f"0x{word >> 8:02X}"]
+            self.writer.writerow(row)
+
+
+def receive(
+    bind: str, port: int, interval: float, window: int, csv_file: TextIO | None
+) -> int:
+    """Receive the stream until interrupted, printing loss reports."""
+    writer = csv.writer(csv_file) if csv_file is not None else None
+    stream = StreamReassembler(window, writer)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4 * 1024 * 1024)
+    sock.bind((bind, port))
+    sock.settimeout(0.2)
+
+    print(f"Listening on {bind}:{port} (reorder window {window})")
+    print("Press Ctrl+C to stop\n")
+
+    next_report = time.monotonic() + interval
+    try:
+        while True:
+            try:
+                data, _ = sock.recvfrom(2048)
+                stream.push(data)
+            except socket.timeout:
+                pass
+
+            now = time.monotonic()
+            if now >= next_report:
+                next_report = now + interval
+                print(stream.stats.report())
+
+    except KeyboardInterrupt:
+        print("\n\nReception stopped.")
+    finally:
+        stream.flush()
+        sock.close()
+
+    print(f"Total: {stream.stats.report()}")
+    return 0 if stream.stats.lost == 0 else 2
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Receive the jerry_device ADC UDP stream and report loss",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --port 5005
+  %(prog)s --port 5005 --csv samples.csv
+  %(prog)s --bind 169.254.4.50 --interval 5
+
+Exit status is 2 if any datagram was lost.
+        """,
+    )
+
+    parser.add_argument(
+        "--bind",
+        "-b",
+        default=DEFAULT_BIND,
+        help=f"Local address to listen on (default: {DEFAULT_BIND})",
+    )
+    parser.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"UDP port to listen on (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--interval",
+        "-i",
+        type=float,
+        default=DEFAULT_INTERVAL,
+        help=f"Report interval in seconds (default: {DEFAULT_INTERVAL})",
+    )
+    parser.add_argument(
+        "--window",
+        "-w",
+        type=int,
+        default=DEFAULT_REORDER_WINDOW,
+        help=(
+            "Datagrams held back for reordering before a gap counts as lost "
+            f"(default: {DEFAULT_REORDER_WINDOW})"
+        ),
+    )
+    parser.add_argument(
+        "--csv",
+        "-c",
+        default=None,
+        help="Write the reassembled samples to this CSV file",
+    )
+
+    args = parser.parse_args()
+
+    if args.csv:
+        with open(args.csv, "w", newline="", encoding="utf-8") as csv_file:
+            return receive(args.bind, args.port, args.interval, args.window, csv_file)
+
+    return receive(args.bind, args.port, args.interval, args.window, None)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,541 @@
+#!/usr/bin/env python3
+"""
+Anomaly Model Trainer
+
+Records the spectral features the jerry_device anomaly detector scores,
+trains one int8 autoencoder per ADC channel on them and writes the models
+as application/src/anomaly_model.c.
+
+The features are computed here exactly as on the device, from the
+amplitude spectrum (Modbus FC20, file 4) and the AC RMS input registers of
+each spectrum frame; see application/inc/anomaly.h. Record them while the
+equipment runs normally, with the channels to watch selected in holding
+register 230 (spectrum_channels).
+
+A model is the principal subspace of a channel's normal feature vectors:
+the encoder projects the features onto its ANOMALY_HIDDEN main directions
+and the decoder maps them back, so a frame that does not lie near the
+subspace is reconstructed badly. Training prints the scores the model gives
+its own frames and suggests an alarm threshold (holding register 232,
+anomaly_threshold, in 0.01 dB).
+
+Usage:
+    python anomaly_train.py record --host 169.254.4.100 --output normal.csv
+    python anomaly_train.py train --input normal.csv
+    python anomaly_train.py train --untrained
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import math
+import socket
+import struct
+import sys
+import time
+from pathlib import Path
+
+import numpy as np
+
+# Default configuration matching the device
+DEFAULT_MODBUS_PORT = 502
+DEFAULT_UNIT_ID = 1
+DEFAULT_TIMEOUT = 2.0
+DEFAULT_INTERVAL = 0.2
+DEFAULT_OUTPUT = (
+    Path(__file__).resolve().parent.parent
+    / "application"
+    / "src"
+    / "anomaly_model.c"
+)
+
+# Spectrum file (spectrum.h)
+SPECTRUM_FILE_NUMBER = 4
+SPECTRUM_MAGIC = 0x4A53
+SPECTRUM_HEADER_RECORDS = 8
+SPECTRUM_BINS = 512
+REFERENCE_TYPE = 6
+FC_READ_INPUT_REGISTERS = 0x04
+FC_READ_FILE_RECORD = 0x14
+
+# Records one FC20 sub-request can return in a 253-byte PDU
+MAX_RECORDS = 124
+
+# Input registers: spectrum_frame, then six figures per channel from 300
+IR_SPECTRUM_FRAME = 290
+IR_SPECTRUM_FIRST = 300
+SPECTRUM_FIGURES = 6
+SPECTRUM_RMS = 1
+
+# Features and model (anomaly.h)
+CHANNELS = 6
+BAND_EDGES = [1, 2, 3, 4, 6, 8, 11, 16, 23, 32, 45, 64, 91, 128, 181, 256, 512]
+BANDS = len(BAND_EDGES) - 1
+FEATURES = BANDS + 1
+HIDDEN = 8
+FEATURE_STEP_DB = 0.5
+FEATURE_ZERO_POINT = -88
+UNITS_PER_STEP = FEATURE_STEP_DB * 100.0
+
+# Suggested threshold: this margin over the highest training score
+THRESHOLD_MARGIN = 1.5
+
+
+class ModbusError(Exception):
+    """A request the device did not answer as expected."""
+
+
+class ModbusClient:
+    """Minimal Modbus TCP client for FC04 and FC20."""
+
+    def __init__(self, host: str, port: int, unit_id: int, timeout: float):
+        self._sock = socket.create_connection((host, port), timeout=timeout)
+        self._unit_id = unit_id
+        self._transaction = 0
+
+    def close(self) -> None:
+        """Close the connection."""
+        self._sock.close()
+
+    def _recv_exact(self, size: int) -> bytes:
+        data = b""
+        while len(data) < size:
+            chunk = self._sock.recv(size - len(data))
+            if not chunk:
+                raise ConnectionError("connection closed")
+            data += chunk
+        return data
+
+    def _request(self, pdu: bytes) -> bytes:
+        self._transaction = (self._transaction + 1) & 0xFFFF
+        self._sock.sendall(
+            struct.pack(
+                ">HHHB", self._transaction, 0, len(pdu) + 1, self._unit_id
+            )
+            + pdu
+        )
+        transaction, _, length, _ = struct.unpack(
+            ">HHHB", self._recv_exact(7)
+        )
+        response = self._recv_exact(length - 1)
+        if transaction != self._transaction:
+            raise ModbusError(f"unexpected transaction {transaction}")
+        if response[0] == pdu[0] | 0x80:
+            raise ModbusError(f"Modbus exception {response[1]}")
+        return response
+
+    def read_input_registers(self, address: int, count: int) -> list[int]:
+        """Read count input registers."""
+        response = self._request(
+            struct.pack(">BHH", FC_READ_INPUT_REGISTERS, address, count)
+        )
+        return list(struct.unpack(f">{count}H", response[2 : 2 + 2 * count]))
+
+    def read_records(
+        self, file_number: int, record: int, count: int
+    ) -> list[int]:
+        """Read count records of one file."""
+        response = self._request(
+            struct.pack(
+                ">BBBHHH",
+                FC_READ_FILE_RECORD,
+                7,
+                REFERENCE_TYPE,
+                file_number,
+                record,
+                count,
+            )
+        )
+        if len(response) < 4 or response[3] != REFERENCE_TYPE:
+            raise ModbusError("malformed FC20 response")
+        return list(struct.unpack(f">{count}H", response[4 : 4 + 2 * count]))
+
+
+def quantize_features(bins: list[int], rms: int) -> list[int]:
+    """Features of one channel, as anomaly.c computes them."""
+    powers = []
+    for band in range(BANDS):
+        powers.append(
+            sum(
+                float(a) * float(a)
+                for a in bins[BAND_EDGES[band] : BAND_EDGES[band + 1]]
+            )
+        )
+    powers.append(float(rms) * float(rms))
+
+    offset = FEATURE_ZERO_POINT - 20.0 / FEATURE_STEP_DB + 0.5
+    features = []
+    for power in powers:
+        # Powers in 0.1 mV squared: 1 is the floor of -20 dB re 1 mV
+        level_db = math.log(max(power, 1.0)) * 10.0 / math.log(10.0)
+        q = math.floor(level_db / FEATURE_STEP_DB + offset)
+        features.append(min(127, max(-128, q)))
+    return features
+
+
+def read_frame(client: ModbusClient) -> tuple[int, dict[int, list[int]]] | None:
+    """Features of every analysed channel of the last frame, or None if a
+    new frame was published while reading."""
+    registers = client.read_input_registers(
+        IR_SPECTRUM_FRAME,
+        IR_SPECTRUM_FIRST + CHANNELS * SPECTRUM_FIGURES - IR_SPECTRUM_FRAME,
+    )
+    frame = (registers[0] << 16) | registers[1]
+    header = client.read_records(
+        SPECTRUM_FILE_NUMBER, 0, SPECTRUM_HEADER_RECORDS
+    )
+    if header[0] != SPECTRUM_MAGIC or ((header[6] << 16) | header[7]) != frame:
+        return None
+
+    features = {}
+    for ch in range(CHANNELS):
+        if not header[3] & (1 << ch):
+            continue
+        first = SPECTRUM_HEADER_RECORDS + ch * SPECTRUM_BINS
+        bins: list[int] = []
+        while len(bins) < SPECTRUM_BINS:
+            count = min(MAX_RECORDS, SPECTRUM_BINS - len(bins))
+            bins += client.read_records(
+                SPECTRUM_FILE_NUMBER, first + len(bins), count
+            )
+        rms = registers[
+            IR_SPECTRUM_FIRST
+            - IR_SPECTRUM_FRAME
+            + ch * SPECTRUM_FIGURES
+            + SPECTRUM_RMS
+        ]
+        features[ch] = quantize_features(bins, rms)
+
+    header = client.read_records(
+        SPECTRUM_FILE_NUMBER, 0, SPECTRUM_HEADER_RECORDS
+    )
+    if ((header[6] << 16) | header[7]) != frame:
+        return None
+    return frame, features
+
+
+def record(args: argparse.Namespace) -> int:
+    """Append the features of new frames to the CSV file."""
+    client = ModbusClient(
+        args.host, args.modbus_port, args.unit_id, args.timeout
+    )
+    path = Path(args.output)
+    new_file = not path.exists()
+    last = 0
+    rows = 0
+    try:
+        with path.open("a", newline="", encoding="utf-8") as stream:
+            writer = csv.writer(stream)
+            if new_file:
+                writer.writerow(
+                    ["frame", "channel"] + [f"f{i}" for i in range(FEATURES)]
+                )
+            while args.frames <= 0 or rows < args.frames:
+                result = read_frame(client)
+                if result is not None and result[0] != last:
+                    last = result[0]
+                    for ch, features in result[1].items():
+                        writer.writerow([last, ch] + features)
+                    stream.flush()
+                    rows += 1
+                    print(f"\rFrame {last}: {rows} recorded", end="")
+                time.sleep(args.interval)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        client.close()
+        print()
+    return 0
+
+
+def load_features(path: Path) -> dict[int, np.ndarray]:
+    """Recorded feature vectors by channel."""
+    by_channel: dict[int, list[list[int]]] = {}
+    with path.open(newline="", encoding="utf-8") as stream:
+        for row in csv.DictReader(stream):
+            by_channel.setdefault(int(row["channel"]), []).append(
+                [int(row[f"f{i}"]) for i in range(FEATURES)]
+            )
+    return {
+        ch: np.array(rows, dtype=np.float64)
+        for ch, rows in by_channel.items()
+    }
+
+
+def quantize_multiplier(real: float) -> tuple[int, int]:
+    """Q31 multiplier and shift of a real scale (TensorFlow Lite scheme)."""
+    if real == 0.0:
+        return 0, 0
+    mantissa, exponent = math.frexp(real)
+    multiplier = round(mantissa * (1 << 31))
+    if multiplier == 1 << 31:
+        multiplier //= 2
+        exponent += 1
+    return multiplier, exponent
+
+
+def requantize(value: np.ndarray, multiplier: int, shift: int) -> np.ndarray:
+    """arm_nn_requantize() on int64 values."""
+    value = value.astype(np.int64) << max(shift, 0)
+    value = (value * multiplier + (1 << 30)) >> 31
+    right = max(-shift, 0)
+    mask = (1 << right) - 1
+    result = value >> right
+    threshold = (mask >> 1) + (result < 0)
+    return result + ((value & mask) > threshold)
+
+
+class Layer:
+    """One fully connected int8 layer, as anomaly_layer_t holds it."""
+
+    def __init__(
+        self,
+        weights: np.ndarray,
+        bias: np.ndarray,
+        input_offset: int,
+        output_offset: int,
+        scale: float,
+    ):
+        self.weights = weights.astype(np.int64)
+        self.bias = bias.astype(np.int64)
+        self.input_offset = input_offset
+        self.output_offset = output_offset
+        self.multiplier, self.shift = quantize_multiplier(scale)
+
+    def run(self, inputs: np.ndarray) -> np.ndarray:
+        """arm_fully_connected_s8() on a batch of int8 rows."""
+        acc = (inputs.astype(np.int64) + self.input_offset) @ self.weights.T
+        acc += self.bias
+        out = requantize(acc, self.multiplier, self.shift) + self.output_offset
+        return np.clip(out, -128, 127)
+
+
+def untrained_model() -> tuple[Layer, Layer]:
+    """Model that reconstructs every frame as the feature floor."""
+    encoder = Layer(
+        np.zeros((HIDDEN, FEATURES)), np.zeros(HIDDEN), 0, 0, 0.0
+    )
+    decoder = Layer(
+        np.zeros((FEATURES, HIDDEN)), np.zeros(FEATURES), 0, -128, 0.0
+    )
+    return encoder, decoder
+
+
+def train_model(features: np.ndarray) -> tuple[Layer, Layer]:
+    """Linear autoencoder of the principal subspace of the features.
+
+    The features are kept in quantization steps, zero point 0."""
+    mean = features.mean(axis=0)
+    _, _, vt = np.linalg.svd(features - mean, full_matrices=False)
+    basis = np.zeros((HIDDEN, FEATURES))
+    basis[: min(HIDDEN, vt.shape[0])] = vt[:HIDDEN]
+
+    weight_scale = max(np.abs(basis).max(), 1e-9) / 127.0
+    encoder_weights = np.round(basis / weight_scale)
+    decoder_weights = encoder_weights.T
+
+    # Hidden range from the training frames, asymmetric int8
+    hidden = (features - mean) @ basis.T
+    low = min(hidden.min(), 0.0)
+    high = max(hidden.max(), 0.0)
+    hidden_scale = max(high - low, 1e-9) / 255.0
+    hidden_zero_point = int(round(-128.0 - low / hidden_scale))
+
+    encoder = Layer(
+        encoder_weights,
+        np.round(-(encoder_weights @ mean)),
+        0,
+        hidden_zero_point,
+        weight_scale / hidden_scale,
+    )
+    decoder_scale = hidden_scale * weight_scale
+    decoder = Layer(
+        decoder_weights,
+        np.round(mean / decoder_scale),
+        -hidden_zero_point,
+        0,
+        decoder_scale,
+    )
+    return encoder, decoder
+
+
+def scores(model: tuple[Layer, Layer], features: np.ndarray) -> np.ndarray:
+    """Scores of feature rows in 0.01 dB, as anomaly.c computes them."""
+    reconstruction = model[1].run(model[0].run(features))
+    error = reconstruction - features
+    rms = np.sqrt((error * error).mean(axis=1)) * UNITS_PER_STEP
+    return np.minimum(np.round(rms), 65535)
+
+
+def c_array(values: np.ndarray, per_line: int) -> str:
+    """Values as the lines of a C initializer."""
+    flat = [str(int(v)) for v in values.flatten()]
+    lines = []
+    for i in range(0, len(flat), per_line):
+        lines.append("    " + ", ".join(flat[i : i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def c_layer(name: str, layer: Layer) -> str:
+    """Weight and bias arrays of one layer."""
+    return (
+        f"static const int8_t {name}_weights[] = {{\n"
+        f"{c_array(layer.weights, 12)}\n}};\n\n"
+        f"static const int32_t {name}_bias[] = {{\n"
+        f"{c_array(layer.bias, 6)}\n}};\n\n"
+    )
+
+
+def c_layer_init(name: str, layer: Layer) -> str:
+    """anomaly_layer_t initializer of one layer."""
+    return (
+        f"{{{name}_weights, {name}_bias, {layer.input_offset}, "
+        f"{layer.output_offset}, {layer.multiplier}, {layer.shift}}}"
+    )
+
+
+def write_models(
+    path: Path, models: list[tuple[Layer, Layer]], source: str
+) -> None:
+    """Write anomaly_model.c."""
+    body = ""
+    inits = []
+    for ch, (encoder, decoder) in enumerate(models):
+        body += c_layer(f"a{ch}_encoder", encoder)
+        body += c_layer(f"a{ch}_decoder", decoder)
+        inits.append(
+            f"    /* A{ch} */\n"
+            f"    {{{c_layer_init(f'a{ch}_encoder', encoder)},\n"
+            f"     {c_layer_init(f'a{ch}_decoder', decoder)}}},"
+        )
+
+    path.write_text(
+        "/*\n"
+        " * Copyright (c) 2026 Advance Instrumentation 'n' Control Systems\n"
+        " * All rights reserved.\n"
+        " *\n"
+        " * Anomaly Models\n"
+        " *\n"
+        " * Generated by tools/anomaly_train.py " f"{source}.\n"
+        " * Do not edit; train again instead. See anomaly.h.\n"
+        " */\n"
+        "\n"
+        '#include "anomaly.h"\n'
+        "\n"
+        "#if ANOMALY_DETECT\n"
+        "\n"
+        f"_Static_assert((ANOMALY_FEATURES == {FEATURES}U) && "
+        f"(ANOMALY_HIDDEN == {HIDDEN}U),\n"
+        '               "models out of step with anomaly.h");\n'
+        "\n"
+        f"{body}"
+        "const anomaly_model_t anomaly_models[BSP_ADC1_NUM_CHANNELS] = {\n"
+        + "\n".join(inits)
+        + "\n};\n"
+        "\n"
+        "#endif /* ANOMALY_DETECT */\n",
+        encoding="utf-8",
+    )
+
+
+def train(args: argparse.Namespace) -> int:
+    """Train the models and write them."""
+    recorded = {} if args.untrained else load_features(Path(args.input))
+    models = []
+    for ch in range(CHANNELS):
+        features = recorded.get(ch)
+        if features is None or len(features) < 2:
+            models.append(untrained_model())
+            if not args.untrained:
+                print(f"A{ch}: no frames, untrained")
+            continue
+        model = train_model(features)
+        own = scores(model, features)
+        threshold = min(65535, int(own.max() * THRESHOLD_MARGIN) + 1)
+        print(
+            f"A{ch}: {len(features)} frames, score median {np.median(own):.0f}"
+            f" max {own.max():.0f}; suggested anomaly_threshold {threshold}"
+        )
+        models.append(model)
+
+    if args.untrained:
+        source = "(untrained)"
+    else:
+        source = f"from {Path(args.input).name}"
+    write_models(Path(args.output), models, source)
+    print(f"Wrote {args.output}")
+    return 0
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Record features and train the jerry_device anomaly models",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog=__doc__,
+    )
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    rec = commands.add_parser("record", help="Record features of new frames")
+    rec.add_argument("--host", required=True, help="Device address")
+    rec.add_argument(
+        "--output", required=True, help="CSV file to append the features to"
+    )
+    rec.add_argument(
+        "--frames",
+        type=int,
+        default=0,
+        help="Stop after this many frames (default: until Ctrl+C)",
+    )
+    rec.add_argument(
+        "--interval",
+        type=float,
+        default=DEFAULT_INTERVAL,
+        help=f"Poll period in seconds (default: {DEFAULT_INTERVAL})",
+    )
+    rec.add_argument(
+        "--modbus-port",
+        type=int,
+        default=DEFAULT_MODBUS_PORT,
+        help=f"Modbus TCP port (default: {DEFAULT_MODBUS_PORT})",
+    )
+    rec.add_argument(
+        "--unit-id",
+        type=int,
+        default=DEFAULT_UNIT_ID,
+        help=f"Modbus unit ID (default: {DEFAULT_UNIT_ID})",
+    )
+    rec.add_argument(
+        "--timeout",
+        type=float,
+        default=DEFAULT_TIMEOUT,
+        help=f"Modbus response timeout in seconds (default: {DEFAULT_TIMEOUT})",
+    )
+
+    trn = commands.add_parser("train", help="Train and write the models")
+    source = trn.add_mutually_exclusive_group(required=True)
+    source.add_argument("--input", help="CSV file of recorded features")
+    source.add_argument(
+        "--untrained",
+        action="store_true",
+        help="Write the untrained default models",
+    )
+    trn.add_argument(
+        "--output",
+        default=str(DEFAULT_OUTPUT),
+        help="Model source to write (default: application/src/anomaly_model.c)",
+    )
+    args = parser.parse_args()
+
+    try:
+        if args.command == "record":
+            return record(args)
+        return train(args)
+    except (OSError, ModbusError) as exc:
+        print(f"Error: {exc}", file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+"""
+Benchmark Compare
+
+Reads the results of the jerry_bench image (application/bench/bench_main.c)
+from its console and compares them against a baseline, so that
+optimisation work is judged on measured cycles.
+
+The firmware prints one "BENCH" record per line; other console output
+is ignored. Input is a capture file, standard input, or a serial device,
+which is configured raw at the given baud rate (POSIX only) and read until
+the end record. A baseline is a capture or a JSON file written by --save.
+
+Usage:
+    python bench_compare.py /dev/ttyACM0 --save baseline.json
+    python bench_compare.py /dev/ttyACM0 --baseline baseline.json
+    python bench_compare.py after.txt --baseline before.txt --threshold 2
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import sys
+from dataclasses import asdict, dataclass, field
+from typing import Iterator, TextIO
+
+# Default configuration matching the console port
+DEFAULT_BAUD = 115200
+
+# Output format version of bench_main.c this tool reads
+FORMAT_VERSION = 1
+
+# Slowdown in percent, of the fastest run, reported as a regression
+DEFAULT_THRESHOLD = 5.0
+
+
+@dataclass
+class BenchCase:
+    """Cycles of one case in one cache configuration."""
+
+    name: str
+    icache: int
+    ops: int
+    min: int
+    median: int
+
+    @property
+    def key(self) -> str:
+        """Case name and cache configuration, e.g. "crc16/icache=1"."""
+        return f"{self.name}/icache={self.icache}"
+
+    @property
+    def per_op(self) -> float:
+        """Fastest cycles per unit of work."""
+        return self.min / self.ops if self.ops else 0.0
+
+
+@dataclass
+class BenchRun:
+    """All records of one benchmark run."""
+
+    core_hz: int = 0
+    overhead: int = 0
+    complete: bool = False
+    skipped: list[str] = field(default_factory=list)
+    cases: dict[str, BenchCase] = field(default_factory=dict)
+
+
+def parse_fields(line: str) -> tuple[str, dict[str, str]]:
+    """Split "BENCH <kind> key=value..." into the kind and the fields."""
+    words = line.split()
+    kind = words[1] if len(words) > 1 and "=" not in words[1] else "case"
+    fields = dict(w.split("=", 1) for w in words[1:] if "=" in w)
+    return kind, fields
+
+
+def parse_run(lines: Iterator[str]) -> BenchRun:
+    """Collect the records of the first complete run in the lines."""
+    run = BenchRun()
+    for raw in lines:
+        line = raw.strip()
+        start = line.find("BENCH ")
+        if start < 0:
+            continue
+        kind, fields = parse_fields(line[start:])
+
+        if kind == "begin":
+            version = int(fields.get("version", "0"))
+            if version != FORMAT_VERSION:
+                raise ValueError(f"unsupported benchmark format version {version}")
+            run = BenchRun(
+                core_hz=int(fields["core_hz"]), overhead=int(fields["overhead"])
+            )
+        elif kind == "case":
+            case = BenchCase(
+                name=fields["case"],
+                icache=int(fields["icache"]),
+                ops=int(fields["ops"]),
+                min=int(fields["min"]),
+                median=int(fields["median"]),
+            )
+            run.cases[case.key] = case
+        elif kind == "skip":
+            run.skipped.append(
+                f"icache={fields.get('icache')} (error {fields.get('error')})"
+            )
+        elif kind == "end":
+            run.complete = True
+            break
+        elif kind == "error":
+            raise ValueError(f"benchmark failed: {line[start:]}")
+    return run
+
+
+def load_baseline(path: str) -> BenchRun:
+    """Load a baseline saved with --save, or parse a capture."""
+    with open(path, encoding="utf-8", errors="replace") as baseline_file:
+        text = baseline_file.read()
+    if text.lstrip().startswith("{"):
+        data = json.loads(text)
+        cases = {}
+        for item in data["cases"]:
+            case = BenchCase(**item)
+            cases[case.key] = case
+        return BenchRun(
+            core_hz=data["core_hz"],
+            overhead=data["overhead"],
+            complete=True,
+            skipped=data.get("skipped", []),
+            cases=cases,
+        )
+    return parse_run(iter(text.splitlines()))
+
+
+def save_run(path: str, run: BenchRun) -> None:
+    """Save a run as a JSON baseline."""
+    data = {
+        "version": FORMAT_VERSION,
+        "core_hz": run.core_hz,
+        "overhead": run.overhead,
+        "skipped": run.skipped,
+        "cases": [asdict(case) for case in run.cases.values()],
+    }
+    with open(path, "w", encoding="utf-8") as out:
+        json.dump(data, out, indent=2)
+        out.write("\n")
+
+
+def print_run(run: BenchRun) -> None:
+    """Print a run as a table."""
+    mhz = run.core_hz / 1e6
+    print(f"Core clock {mhz:.1f} MHz, timing overhead {run.overhead} cycles")
+    for skipped in run.skipped:
+        print(f"Skipped pass: {skipped}")
+    print(f"{'Case':<34} {'Ops':>6} {'Min':>10} {'Median':>10} {'Cyc/op':>9} {'us':>9}")
+    print("-" * 82)
+    for case in run.cases.values():
+        micros = case.min / mhz if mhz else 0.0
+        print(
+            f"{case.key:<34} {case.ops:>6} {case.min:>10} {case.median:>10} "
+            f"{case.per_op:>9.2f} {micros:>9.2f}"
+        )
+
+
+def compare(run: BenchRun, baseline: BenchRun, threshold: float) -> int:
+    """Print each case against the baseline; return the regressions."""
+    regressions = 0
+    print(f"{'Case':<34} {'Base':>10} {'Now':>10} {'Change':>9}")
+    print("-" * 67)
+    for key in sorted(set(run.cases) | set(baseline.cases)):
+        now = run.cases.get(key)
+        base = baseline.cases.get(key)
+        if now is None or base is None:
+            where = "baseline" if now is None else "new run"
+            print(f"{key:<34} {'only in ' + where:>31}")
+            continue
+        change = (now.min - base.min) * 100.0 / base.min if base.min else 0.0
+        mark = ""
+        if change > threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        elif change < -threshold:
+            mark = "  faster"
+        print(f"{key:<34} {base.min:>10} {now.min:>10} {change:>+8.1f}%{mark}")
+    if baseline.core_hz and run.core_hz != baseline.core_hz:
+        print(
+            f"\nNote: core clock differs, {baseline.core_hz} Hz in the baseline "
+            f"and {run.core_hz} Hz now"
+        )
+    return regressions
+
+
+def open_input(path: str, baud: int) -> TextIO:
+    """Open the benchmark output, configuring a serial device raw."""
+    if path == "-":
+        return sys.stdin
+
+    stream = open(path, encoding="ascii", errors="replace")
+    if os.isatty(stream.fileno()):
+        import termios  # pylint: disable=import-outside-toplevel
+        import tty  # pylint: disable=import-outside-toplevel
+
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, f"B{baud}")
+        attrs[4] = speed
+        attrs[5] = speed
+        # 8 data bits, no parity, one stop bit
+        attrs[2] = (attrs[2] & ~(termios.PARENB | termios.CSTOPB | termios.CSIZE)) | (
+            termios.CS8 | termios.CLOCAL | termios.CREAD
+        )
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    return stream
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Read and compare jerry_bench cycle counts",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s /dev/ttyACM0 --save baseline.json
+  %(prog)s /dev/ttyACM0 --baseline baseline.json
+  %(prog)s after.txt --baseline before.txt --threshold 2
+
+Exit status is 1 if a case is slower than the baseline by more than the
+threshold, 2 if the run is incomplete.
+        """,
+    )
+
+    parser.add_argument(
+        "input",
+        nargs="?",
+        default="-",
+        help="Serial device, capture file, or - for standard input (default: -)",
+    )
+    parser.add_argument(
+        "--baud",
+        "-b",
+        type=int,
+        default=DEFAULT_BAUD,
+        help=f"Baud rate of a serial device (default: {DEFAULT_BAUD})",
+    )
+    parser.add_argument("--baseline", help="Baseline capture or JSON to compare against")
+    parser.add_argument("--save", help="Save the run as a JSON baseline")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=DEFAULT_THRESHOLD,
+        help=f"Slowdown in percent reported as a regression (default: {DEFAULT_THRESHOLD:g})",
+    )
+
+    args = parser.parse_args()
+
+    stream = open_input(args.input, args.baud)
+    try:
+        run = parse_run(iter(stream.readline, ""))
+    except (KeyError, ValueError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 2
+    except KeyboardInterrupt:
+        return 2
+    finally:
+        if stream is not sys.stdin:
+            stream.close()
+
+    if not run.complete:
+        print("Error: no complete benchmark run in the input", file=sys.stderr)
+        return 2
+
+    print_run(run)
+    if args.save:
+        save_run(args.save, run)
+        print(f"\nBaseline saved to {args.save}")
+
+    if args.baseline:
+        print()
+        regressions = compare(run, load_baseline(args.baseline), args.threshold)
+        if regressions:
+            print(f"\n{regressions} cases slower than the baseline by more than {args.threshold:g}%")
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
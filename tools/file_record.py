@@ -0,0 +1,424 @@
+#!/usr/bin/env python3
+"""
+Modbus File Record Transfer
+
+Bulk transfers of the jerry_device Modbus files (application/inc/
+modbus_files.h) with FC20 (Read File Record) and FC21 (Write File Record).
+Reads are planned over all the records wanted, across file boundaries, and
+packed into requests of as many sub-requests as fill the 253-byte response
+PDU, so every request but the last returns 124 records. A 2048-sample
+capture snapshot takes 102 requests, the samples themselves 100.
+
+Commands:
+    read      Dump records of any file as hex, or raw big-endian to a file
+    snapshot  Download the ADC capture snapshot (files 2-3) to CSV, checking
+              that no new trigger replaced it during the download
+    save      Save the persistent registers (file 6) to JSON
+    load      Write the persistent registers of a JSON file back (FC21)
+
+Usage:
+    python file_record.py --host 169.254.4.100 read 5 --count 24
+    python file_record.py --host 169.254.4.100 snapshot capture.csv
+    python file_record.py --host 169.254.4.100 save config.json
+    python file_record.py --host 169.254.4.100 load config.json
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import json
+import socket
+import struct
+import sys
+from collections.abc import Sequence
+
+# Default configuration matching the Modbus task
+DEFAULT_MODBUS_PORT = 502
+DEFAULT_UNIT_ID = 1
+DEFAULT_TIMEOUT = 2.0
+
+# Function codes and limits (MODBUS_FILE_REFERENCE_TYPE, MODBUS_MAX_PDU_SIZE)
+FC_READ_FILE_RECORD = 0x14
+FC_WRITE_FILE_RECORD = 0x15
+REFERENCE_TYPE = 6
+MAX_PDU = 253
+FILE_RECORDS = 10000
+
+# FC20: 35 sub-requests of 7 bytes; response data of 2 + 2n bytes each
+MAX_READ_SUB_REQUESTS = 35
+MAX_READ_DATA = MAX_PDU - 2
+
+# FC21: request data of 7 + 2n bytes each, byte count 0xFB at most
+MAX_WRITE_DATA = 0xFB
+
+# Snapshot (adc_capture.h)
+CAPTURE_FILE_NUMBER = 2
+CAPTURE_MAGIC = 0x4A43
+CAPTURE_VERSION = 1
+CAPTURE_HEADER_RECORDS = 20
+
+# Configuration file (config_store.h)
+CONFIG_FILE_NUMBER = 6
+CONFIG_VERSION = 1
+CONFIG_HEADER_RECORDS = 4
+CONFIG_ENTRY_RECORDS = 6
+
+Span = tuple[int, int, int]
+
+
+class ModbusError(Exception):
+    """A Modbus exception response or a malformed frame."""
+
+
+def plan_reads(spans: Sequence[Span]) -> list[list[Span]]:
+    """Pack (file, record, length) spans into FC20 requests.
+
+    Every request is filled up to the response PDU; a span is split where
+    a request is full and carried on in the next one.
+    """
+    requests: list[list[Span]] = []
+    subs: list[Span] = []
+    used = 0
+    for file_number, record, length in spans:
+        while length > 0:
+            room = (MAX_READ_DATA - used - 2) // 2
+            if room < 1 or len(subs) == MAX_READ_SUB_REQUESTS:
+                requests.append(subs)
+                subs, used = [], 0
+                continue
+            take = min(length, room)
+            subs.append((file_number, record, take))
+            used += 2 + 2 * take
+            record += take
+            length -= take
+    if subs:
+        requests.append(subs)
+    return requests
+
+
+def snapshot_spans(first: int, count: int) -> list[Span]:
+    """Spans of records [first, first + count) of the capture snapshot."""
+    spans = []
+    while count > 0:
+        file_number = CAPTURE_FILE_NUMBER + first // FILE_RECORDS
+        record = first % FILE_RECORDS
+        take = min(count, FILE_RECORDS - record)
+        spans.append((file_number, record, take))
+        first += take
+        count -= take
+    return spans
+
+
+class FileRecordClient:
+    """Minimal Modbus TCP client for FC20 and FC21."""
+
+    def __init__(self, host: str, port: int, unit_id: int, timeout: float):
+        self._sock = socket.create_connection((host, port), timeout=timeout)
+        self._unit_id = unit_id
+        self._transaction = 0
+        self.requests = 0
+
+    def close(self) -> None:
+        """Close the connection."""
+        self._sock.close()
+
+    def _recv_exact(self, size: int) -> bytes:
+        data = b""
+        while len(data) < size:
+            chunk = self._sock.recv(size - len(data))
+            if not chunk:
+                raise ConnectionError("connection closed")
+            data += chunk
+        return data
+
+    def _request(self, pdu: bytes) -> bytes:
+        self._transaction = (self._transaction + 1) & 0xFFFF
+        self.requests += 1
+        self._sock.sendall(
+            struct.pack(
+                ">HHHB", self._transaction, 0, len(pdu) + 1, self._unit_id
+            )
+            + pdu
+        )
+        transaction, _, length, _ = struct.unpack(
+            ">HHHB", self._recv_exact(7)
+        )
+        response = self._recv_exact(length - 1)
+        if transaction != self._transaction:
+            raise ModbusError(f"unexpected transaction {transaction}")
+        if response[0] == pdu[0] | 0x80:
+            raise ModbusError(f"Modbus exception {response[1]}")
+        if response[0] != pdu[0]:
+            raise ModbusError(f"unexpected function code {response[0]}")
+        return response
+
+    def read(self, subs: Sequence[Span]) -> list[list[int]]:
+        """Read the sub-requests of one FC20 request."""
+        body = b"".join(
+            struct.pack(">BHHH", REFERENCE_TYPE, file_number, record, length)
+            for file_number, record, length in subs
+        )
+        response = self._request(
+            bytes([FC_READ_FILE_RECORD, len(body)]) + body
+        )
+        values, pos = [], 2
+        for _, _, length in subs:
+            if (
+                pos + 2 + 2 * length > len(response)
+                or response[pos] != 1 + 2 * length
+                or response[pos + 1] != REFERENCE_TYPE
+            ):
+                raise ModbusError("malformed FC20 response")
+            values.append(
+                list(struct.unpack_from(f">{length}H", response, pos + 2))
+            )
+            pos += 2 + 2 * length
+        return values
+
+    def read_spans(self, spans: Sequence[Span]) -> list[int]:
+        """Read spans of records with packed requests, in order."""
+        values: list[int] = []
+        for subs in plan_reads(spans):
+            for sub in self.read(subs):
+                values.extend(sub)
+        return values
+
+    def write(self, subs: Sequence[tuple[int, int, Sequence[int]]]) -> None:
+        """Write (file, record, values) sub-requests in one FC21 request."""
+        body = b"".join(
+            struct.pack(
+                f">BHHH{len(values)}H",
+                REFERENCE_TYPE,
+                file_number,
+                record,
+                len(values),
+                *values,
+            )
+            for file_number, record, values in subs
+        )
+        if len(body) > MAX_WRITE_DATA:
+            raise ValueError("FC21 request too long")
+        request = bytes([FC_WRITE_FILE_RECORD, len(body)]) + body
+        if self._request(request) != request:
+            raise ModbusError("FC21 response is not an echo")
+
+
+def read_snapshot(
+    client: FileRecordClient,
+) -> tuple[list[int], list[tuple[int, ...]]]:
+    """Download the snapshot; returns its header and samples."""
+    header = client.read_spans(snapshot_spans(0, CAPTURE_HEADER_RECORDS))
+    if header[0] != CAPTURE_MAGIC or header[1] != CAPTURE_VERSION:
+        raise ModbusError("no snapshot of a known format")
+    channels, samples = header[3], header[14]
+    values = client.read_spans(
+        snapshot_spans(header[2], samples * channels)
+    )
+
+    # A trigger during the download replaces the records read so far
+    if client.read_spans(snapshot_spans(0, header[2]))[4:6] != header[4:6]:
+        raise ModbusError("snapshot replaced during the download")
+    frames = [
+        tuple(values[i : i + channels])
+        for i in range(0, len(values), channels)
+    ]
+    return header, frames
+
+
+def read_config(client: FileRecordClient) -> list[dict[str, object]]:
+    """Read the entries of the configuration file."""
+    header = client.read_spans(
+        [(CONFIG_FILE_NUMBER, 0, CONFIG_HEADER_RECORDS)]
+    )
+    if header[0] != CONFIG_VERSION or header[3] != CONFIG_ENTRY_RECORDS:
+        raise ModbusError("configuration file of an unknown format")
+    values = client.read_spans(
+        [(CONFIG_FILE_NUMBER, header[1], header[2] * CONFIG_ENTRY_RECORDS)]
+    )
+    entries = []
+    for i in range(0, len(values), CONFIG_ENTRY_RECORDS):
+        address, count = values[i], values[i + 1]
+        entries.append(
+            {
+                "address": address,
+                "count": count,
+                "value": values[i + 2 : i + 2 + count],
+            }
+        )
+    return entries
+
+
+def write_config(
+    client: FileRecordClient, wanted: Sequence[dict[str, object]]
+) -> int:
+    """Write the entries of wanted that the device has; returns their count.
+
+    Runs of adjacent entries become one sub-request each, as many as fit
+    one request.
+    """
+    device = read_config(client)
+    values = {int(e["address"]): list(e["value"]) for e in wanted}
+    runs: list[tuple[int, list[int]]] = []
+    last = -2
+    for index, entry in enumerate(device):
+        value = values.get(int(entry["address"]))
+        if value is None:
+            continue
+        if len(value) != entry["count"]:
+            raise ValueError(f"register {entry['address']}: wrong size")
+        records = [entry["address"], entry["count"]] + value
+        records += [0xFFFF] * (CONFIG_ENTRY_RECORDS - len(records))
+        merged = len(runs[-1][1]) + CONFIG_ENTRY_RECORDS if runs else 0
+        if index == last + 1 and 7 + 2 * merged <= MAX_WRITE_DATA:
+            runs[-1][1].extend(records)
+        else:
+            runs.append(
+                (CONFIG_HEADER_RECORDS + CONFIG_ENTRY_RECORDS * index, records)
+            )
+        last = index
+
+    subs: list[tuple[int, int, Sequence[int]]] = []
+    used = 0
+    for record, records in runs:
+        size = 7 + 2 * len(records)
+        if used + size > MAX_WRITE_DATA:
+            client.write(subs)
+            subs, used = [], 0
+        subs.append((CONFIG_FILE_NUMBER, record, records))
+        used += size
+    if subs:
+        client.write(subs)
+    return sum(len(r) for _, r in runs) // CONFIG_ENTRY_RECORDS
+
+
+def command_read(client: FileRecordClient, args: argparse.Namespace) -> int:
+    """Dump records of a file."""
+    values = client.read_spans([(args.file, args.first, args.count)])
+    if args.out:
+        with open(args.out, "wb") as out:
+            out.write(struct.pack(f">{len(values)}H", *values))
+    else:
+        for i in range(0, len(values), 8):
+            words = " ".join(f"{v:04x}" for v in values[i : i + 8])
+            print(f"{args.first + i:5d}: {words}")
+    return 0
+
+
+def command_snapshot(
+    client: FileRecordClient, args: argparse.Namespace
+) -> int:
+    """Download the capture snapshot to CSV."""
+    header, frames = read_snapshot(client)
+    first = (header[6] << 16) | header[7]
+    with open(args.csv, "w", newline="", encoding="utf-8") as csv_file:
+        writer = csv.writer(csv_file)
+        writer.writerow(
+            ["sequence"] + [f"raw_a{ch}" for ch in range(header[3])]
+        )
+        for i, frame in enumerate(frames):
+            writer.writerow([(first + i) & 0xFFFFFFFF, *frame])
+    print(
+        f"Snapshot {(header[4] << 16) | header[5]}: {len(frames)} samples "
+        f"({header[15]} before the trigger) in {client.requests} requests"
+    )
+    return 0
+
+
+def command_save(client: FileRecordClient, args: argparse.Namespace) -> int:
+    """Save the persistent registers to JSON."""
+    entries = read_config(client)
+    with open(args.json, "w", encoding="utf-8") as out:
+        json.dump(
+            {"version": CONFIG_VERSION, "registers": entries}, out, indent=2
+        )
+        out.write("\n")
+    print(f"Saved {len(entries)} registers")
+    return 0
+
+
+def command_load(client: FileRecordClient, args: argparse.Namespace) -> int:
+    """Write the persistent registers of a JSON file."""
+    with open(args.json, encoding="utf-8") as in_file:
+        saved = json.load(in_file)
+    if saved.get("version") != CONFIG_VERSION:
+        raise ValueError(f"{args.json}: unknown version")
+    written = write_config(client, saved["registers"])
+    print(f"Wrote {written} of {len(saved['registers'])} registers")
+    return 0
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Transfer jerry_device Modbus files with FC20 and FC21",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog=__doc__,
+    )
+    parser.add_argument("--host", required=True, help="Device address")
+    parser.add_argument(
+        "--modbus-port",
+        type=int,
+        default=DEFAULT_MODBUS_PORT,
+        help=f"Modbus TCP port (default: {DEFAULT_MODBUS_PORT})",
+    )
+    parser.add_argument(
+        "--unit-id",
+        type=int,
+        default=DEFAULT_UNIT_ID,
+        help=f"Modbus unit ID (default: {DEFAULT_UNIT_ID})",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=DEFAULT_TIMEOUT,
+        help=f"Response timeout in seconds (default: {DEFAULT_TIMEOUT})",
+    )
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    read = commands.add_parser("read", help="Dump records of a file")
+    read.add_argument("file", type=int, help="File number")
+    read.add_argument("--first", type=int, default=0, help="First record")
+    read.add_argument(
+        "--count", type=int, required=True, help="Number of records"
+    )
+    read.add_argument("--out", help="Write raw big-endian records here")
+    read.set_defaults(handler=command_read)
+
+    snapshot = commands.add_parser(
+        "snapshot", help="Download the capture snapshot to CSV"
+    )
+    snapshot.add_argument("csv", help="CSV file to write")
+    snapshot.set_defaults(handler=command_snapshot)
+
+    save = commands.add_parser(
+        "save", help="Save the persistent registers to JSON"
+    )
+    save.add_argument("json", help="JSON file to write")
+    save.set_defaults(handler=command_save)
+
+    load = commands.add_parser(
+        "load", help="Write the persistent registers of a JSON file"
+    )
+    load.add_argument("json", help="JSON file written by save")
+    load.set_defaults(handler=command_load)
+
+    args = parser.parse_args()
+    try:
+        client = FileRecordClient(
+            args.host, args.modbus_port, args.unit_id, args.timeout
+        )
+    except OSError as err:
+        print(f"Error: {err}", file=sys.stderr)
+        return 2
+    try:
+        return args.handler(client, args)
+    except (ModbusError, OSError, ValueError, KeyError) as err:
+        print(f"Error: {err}", file=sys.stderr)
+        return 1
+    finally:
+        client.close()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
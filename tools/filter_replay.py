@@ -0,0 +1,355 @@
+#!/usr/bin/env python3
+"""
+ADC Filter Replay
+
+Replays a recorded capture through every ADC filter backend built by
+tests/filter (filter_replay_<backend>), and through the multi-channel frame
+filter, and compares each output with a float64 reference: the cascade
+designed by config/adc_filter_design.py for the selected bank, run with
+scipy on the raw readings. Prints throughput and error per backend, and the
+fastest backend whose error meets the spec.
+
+The capture is a USB stick log image or device (usb_log_reader.py format),
+or a CSV with raw_a<ch> columns as written by usb_log_reader.py --csv and
+adc_stream_receiver.py --csv. It must be at ADC_FILTER_SAMPLE_RATE: a CSV of
+a decimated UDP stream is not.
+
+Errors are in LSB of a 12-bit reading. Both sides start from rest, so the
+start-up transient is compared like the rest of the capture.
+
+Usage:
+    cmake -S tests/filter -B build_filter && cmake --build build_filter
+    python filter_replay.py stick.img --file 12 --build-dir build_filter
+    python filter_replay.py file12.csv --bank 1 --max-error 0.5
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import re
+import subprocess
+import sys
+import tempfile
+from dataclasses import dataclass
+from pathlib import Path
+
+import numpy as np
+from scipy import signal
+
+import usb_log_reader
+
+REPO_ROOT = Path(__file__).resolve().parent.parent
+sys.path.insert(0, str(REPO_ROOT / "config"))
+
+import adc_filter_design  # noqa: E402  (needs the config/ path above)
+
+COEFFICIENTS_HEADER = (
+    REPO_ROOT
+    / "application"
+    / "dependencies"
+    / "adc_filter"
+    / "inc"
+    / "adc_filter_coefficients.h"
+)
+
+# Backends built by tests/filter/CMakeLists.txt
+BACKENDS = ("df1_f32", "df2t_f32", "df1_q31", "df1_fast_q15")
+
+# The frame filter is float only; it is run from this build
+FRAME_BACKEND = "df1_f32"
+
+# Most channels the filter context holds (REPLAY_MAX_CHANNELS)
+MAX_CHANNELS = 6
+
+ADC_BITS = 12
+DEFAULT_MAX_ERROR = 1.0  # LSB of a 12-bit reading
+DEFAULT_REPEATS = 5
+
+
+@dataclass
+class Capture:
+    """Raw readings of a capture, one column per channel."""
+
+    raw: np.ndarray
+    resolution: int
+    sample_rate: int | None
+
+
+@dataclass
+class Result:
+    """Throughput and error of one backend."""
+
+    name: str
+    ns_per_sample: float
+    max_error: float
+    rms_error: float
+
+
+def read_header() -> dict[str, object]:
+    """Read the design parameters of the generated coefficient header."""
+    text = COEFFICIENTS_HEADER.read_text(encoding="utf-8")
+
+    def define(name: str) -> int:
+        match = re.search(rf"#define {name} (\d+)U", text)
+        if match is None:
+            raise ValueError(f"{COEFFICIENTS_HEADER.name}: no {name}")
+        return int(match.group(1))
+
+    order = re.search(r"LPF Type: (\d+)\w* order Butterworth", text)
+    banks = re.findall(
+        r"Bank (\d+): (\d+) Hz mains notches, (\d+) Hz LPF \*/", text
+    )
+    if order is None or not banks:
+        raise ValueError(f"{COEFFICIENTS_HEADER.name}: no design parameters")
+    return {
+        "stages": define("ADC_FILTER_NUM_STAGES"),
+        "lpf_stages": define("ADC_FILTER_LPF_STAGES"),
+        "notch_q": define("ADC_FILTER_NOTCH_Q"),
+        "sample_rate": define("ADC_FILTER_SAMPLE_RATE"),
+        "lpf_order": int(order.group(1)),
+        "banks": {int(n): (int(m), int(c)) for n, m, c in banks},
+    }
+
+
+def reference_sos(header: dict[str, object], bank: int) -> np.ndarray:
+    """Design the float64 cascade the coefficient bank was generated from."""
+    banks = header["banks"]
+    assert isinstance(banks, dict)
+    if bank not in banks:
+        raise ValueError(f"bank {bank} not in {COEFFICIENTS_HEADER.name}")
+    mains_freq, lpf_cutoff = banks[bank]
+    notches = int(header["stages"]) - int(header["lpf_stages"])
+    coefficients, stages, _, _ = adc_filter_design.design_complete_filter(
+        mains_freq,
+        lpf_cutoff,
+        lpf_order=int(header["lpf_order"]),
+        notch_q=int(header["notch_q"]),
+        num_notches=notches,
+    )
+    if stages != header["stages"]:
+        raise ValueError(
+            f"design has {stages} stages, the header {header['stages']}: "
+            "regenerate the coefficients"
+        )
+    return adc_filter_design.cmsis_to_sos(coefficients)
+
+
+def read_log(path: str, number: int | None) -> Capture:
+    """Read one file of a USB stick log, by default the newest."""
+    with open(path, "rb") as medium:
+        files = usb_log_reader.scan(medium)
+        if number is not None:
+            files = [f for f in files if f.number == number]
+        if not files:
+            raise ValueError(f"{path}: no log file {number or ''}".rstrip())
+        log_file = files[-1]
+        rows = [
+            raw for _, _, _, raw in usb_log_reader.samples(medium, log_file)
+        ]
+    raw = np.array(rows, dtype=np.uint16).reshape(-1, log_file.channels)
+    return Capture(raw, log_file.resolution, log_file.sample_rate)
+
+
+def read_csv(path: str, resolution: int) -> Capture:
+    """Read the raw_a<ch> columns of a CSV capture."""
+    with open(path, newline="", encoding="utf-8") as csv_file:
+        reader = csv.reader(csv_file)
+        header = next(reader)
+        columns = [
+            i for i, name in enumerate(header) if name.startswith("raw_a")
+        ]
+        if not columns:
+            raise ValueError(f"{path}: no raw_a<ch> columns")
+        rows = [[int(row[i]) for i in columns] for row in reader if row]
+    raw = np.array(rows, dtype=np.uint16).reshape(-1, len(columns))
+    return Capture(raw, resolution, None)
+
+
+def find_executable(build_dir: str, backend: str) -> Path | None:
+    """Return the replay executable of a backend, or None if not built."""
+    for name in (f"filter_replay_{backend}", f"filter_replay_{backend}.exe"):
+        path = Path(build_dir) / name
+        if path.exists():
+            return path
+    return None
+
+
+def run_backend(
+    executable: Path,
+    raw_path: Path,
+    capture: Capture,
+    args: argparse.Namespace,
+    frame: bool,
+) -> tuple[float, np.ndarray]:
+    """Run one replay executable and return (ns/sample, output in counts)."""
+    channels = capture.raw.shape[1]
+    out_path = raw_path.with_suffix(".f32")
+    command = [
+        str(executable),
+        "--input", str(raw_path),
+        "--output", str(out_path),
+        "--channels", str(channels),
+        "--bank", str(args.bank),
+        "--extra-bits", str(capture.resolution - ADC_BITS),
+        "--repeat", str(args.repeat),
+    ]
+    if frame:
+        command.append("--frame")
+    completed = subprocess.run(
+        command, check=True, capture_output=True, text=True
+    )
+    fields = dict(
+        item.split("=", 1) for item in completed.stdout.split() if "=" in item
+    )
+    output = np.fromfile(out_path, dtype="<f4").reshape(-1, channels)
+    return float(fields["ns_per_sample"]), output
+
+
+def compare(
+    output: np.ndarray, reference: np.ndarray, lsb: float
+) -> tuple[float, float]:
+    """Return the (max, RMS) error in LSB of a 12-bit reading."""
+    error = (output.astype(np.float64) - reference) / lsb
+    return float(np.max(np.abs(error))), float(np.sqrt(np.mean(error**2)))
+
+
+def replay(capture: Capture, args: argparse.Namespace) -> int:
+    """Run every backend over the capture and print the table."""
+    header = read_header()
+    if capture.sample_rate not in (None, header["sample_rate"]):
+        print(
+            f"Capture is at {capture.sample_rate} Hz, the filter is designed "
+            f"for {header['sample_rate']} Hz",
+            file=sys.stderr,
+        )
+        return 2
+    if not ADC_BITS <= capture.resolution <= ADC_BITS + 3:
+        print(f"Unsupported resolution {capture.resolution}", file=sys.stderr)
+        return 2
+
+    raw = capture.raw[:, :MAX_CHANNELS]
+    capture = Capture(raw, capture.resolution, capture.sample_rate)
+    sos = reference_sos(header, args.bank)
+    reference = signal.sosfilt(sos, raw.astype(np.float64), axis=0)
+    lsb = float(1 << (capture.resolution - ADC_BITS))
+
+    runs = [(name, name, False) for name in BACKENDS]
+    runs.append((f"{FRAME_BACKEND} frame", FRAME_BACKEND, True))
+
+    results: list[Result] = []
+    with tempfile.TemporaryDirectory() as temp:
+        raw_path = Path(temp) / "capture.raw"
+        raw.astype("<u2").tofile(raw_path)
+        for name, backend, frame in runs:
+            executable = find_executable(args.build_dir, backend)
+            if executable is None:
+                print(f"{name}: filter_replay_{backend} not built, skipped")
+                continue
+            ns_per_sample, output = run_backend(
+                executable, raw_path, capture, args, frame
+            )
+            max_error, rms_error = compare(output, reference, lsb)
+            results.append(Result(name, ns_per_sample, max_error, rms_error))
+
+    if not results:
+        print("No replay executables found", file=sys.stderr)
+        return 2
+
+    seconds = raw.shape[0] / int(header["sample_rate"])
+    print(
+        f"{raw.shape[0]} samples ({seconds:.1f} s) x {raw.shape[1]} ch, "
+        f"bank {args.bank}, {capture.resolution}-bit readings"
+    )
+    print(f"\n{'backend':<20} {'ns/sample':>10} {'Msample/s':>10} "
+          f"{'max LSB':>10} {'RMS LSB':>10}")
+    for result in results:
+        rate = 1e3 / result.ns_per_sample if result.ns_per_sample else 0.0
+        within = result.max_error <= args.max_error
+        print(
+            f"{result.name:<20} {result.ns_per_sample:10.2f} {rate:10.2f} "
+            f"{result.max_error:10.4f} {result.rms_error:10.4f}"
+            f"{'' if within else '  OVER SPEC'}"
+        )
+
+    passing = [r for r in results if r.max_error <= args.max_error]
+    if not passing:
+        print(f"\nNo backend within {args.max_error} LSB")
+        return 1
+    best = min(passing, key=lambda r: r.ns_per_sample)
+    print(f"\nFastest within {args.max_error} LSB: {best.name}")
+    return 0
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Replay a capture through the ADC filter backends",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s stick.img --file 12 --build-dir build_filter
+  %(prog)s file12.csv --resolution 14 --bank 2
+
+Exit status is 1 if no backend meets --max-error, 2 on errors.
+        """,
+    )
+
+    parser.add_argument(
+        "capture", help="USB log image or device, or a CSV capture"
+    )
+    parser.add_argument(
+        "--build-dir",
+        "-b",
+        default="build_filter",
+        help="Build directory of tests/filter (default: build_filter)",
+    )
+    parser.add_argument(
+        "--file",
+        "-f",
+        type=int,
+        default=None,
+        help="Log file number in a USB log (default: the newest)",
+    )
+    parser.add_argument(
+        "--resolution",
+        type=int,
+        default=ADC_BITS,
+        help=f"Bits of the CSV readings (default: {ADC_BITS})",
+    )
+    parser.add_argument(
+        "--bank",
+        type=int,
+        default=0,
+        help="Coefficient bank of every channel (default: 0)",
+    )
+    parser.add_argument(
+        "--max-error",
+        type=float,
+        default=DEFAULT_MAX_ERROR,
+        help="Accuracy spec, max error in 12-bit LSB "
+        f"(default: {DEFAULT_MAX_ERROR})",
+    )
+    parser.add_argument(
+        "--repeat",
+        type=int,
+        default=DEFAULT_REPEATS,
+        help="Timed passes per backend, fastest kept "
+        f"(default: {DEFAULT_REPEATS})",
+    )
+
+    args = parser.parse_args()
+
+    try:
+        if args.capture.lower().endswith(".csv"):
+            capture = read_csv(args.capture, args.resolution)
+        else:
+            capture = read_log(args.capture, args.file)
+        return replay(capture, args)
+    except (OSError, ValueError, subprocess.CalledProcessError) as err:
+        print(f"Error: {err}", file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,579 @@
+#!/usr/bin/env python3
+"""
+Jerry Fleet Scanner
+
+Finds the jerry_device nodes of a site and reads register groups from all
+of them at once. A node's address follows from its DEVADDR pins: IP
+<subnet>.<100 + DEVADDR> and unit ID 1 + DEVADDR (net_task.c,
+modbus_task.c), so every subnet holds up to 16 nodes at known addresses.
+All candidates are tried concurrently; a node that does not accept the
+connection within --connect-timeout is taken as absent.
+
+The registers to read come from the register map the code generator
+builds from config/jerry_registers.json. The selected registers of each
+space are merged into as few read requests as the per-request limits and
+the mapped address runs allow: a read never crosses an unmapped address,
+which the device answers with exception 02. On each connection up to
+--pipeline requests are outstanding, matched to their responses by MBAP
+transaction ID, as the server's MODBUS_TCP_PIPELINE_DEPTH allows. A busy
+answer (exception 06, the admission limits of modbus_admission.h) is
+retried.
+
+The results go to CSV, or to Parquet when the output ends in .parquet
+(needs pyarrow): one row per node with its address, status and one column
+per register, with the register scale factors applied unless --raw.
+
+Usage:
+    python fleet_scan.py --subnet 169.254.4 --output site.csv
+    python fleet_scan.py --subnet 10.1.1 --subnet 10.1.2 --groups adc_values
+    python fleet_scan.py --groups di_capture,version_info --plan
+"""
+
+from __future__ import annotations
+
+import argparse
+import asyncio
+import csv
+import logging
+import struct
+import sys
+import time
+from collections import deque
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any
+
+sys.path.insert(0, str(Path(__file__).parent / "modbus_codegen"))
+
+from modbus_codegen import ModbusCodeGenerator  # noqa: E402
+
+# Default configuration matching jerry_device addressing
+DEFAULT_SUBNET = "169.254.4"
+DEFAULT_PORT = 502
+DEFAULT_CONFIG = (
+    Path(__file__).resolve().parent.parent / "config" / "jerry_registers.json"
+)
+IP_ADDR3_BASE = 100  # STATIC_IP_ADDR3_BASE
+UNIT_ID_BASE = 1  # MODBUS_UNIT_ID_BASE
+MONITOR_UNIT_OFFSET = 128  # Read-only monitor unit (modbus_units.h)
+DEVADDR_COUNT = 16  # Four DEVADDR pins
+
+DEFAULT_PIPELINE = 4  # MODBUS_TCP_PIPELINE_DEPTH
+DEFAULT_CONCURRENCY = 256
+DEFAULT_CONNECT_TIMEOUT = 0.5
+DEFAULT_TIMEOUT = 1.0
+DEFAULT_RETRIES = 3
+BUSY_BACKOFF = 0.05  # s before a request answered with exception 06 is resent
+
+# Read function code, most items per request (modbus_config.h) and whether
+# the space holds 16-bit words, per register space
+SPACES = {
+    "coils": (0x01, 2000, False),
+    "discrete_inputs": (0x02, 2000, False),
+    "holding_registers": (0x03, 125, True),
+    "input_registers": (0x04, 125, True),
+}
+
+# Mapped address runs of each space: start, count and first slot index
+Runs = dict[str, list[dict[str, int]]]
+
+MBAP = struct.Struct(">HHHB")
+EXCEPTION_BUSY = 0x06
+
+
+@dataclass
+class Field:
+    """One register or bit of the register map."""
+
+    name: str
+    column: str  # The name, or <space>.<name> if several spaces have it
+    group: str
+    space: str
+    address: int
+    size: int
+    data_type: str
+    word_order: str
+    scale: float | None
+
+
+@dataclass
+class Read:
+    """One merged read request and the registers it returns."""
+
+    space: str
+    function: int
+    start: int
+    count: int
+    fields: list[Field] = field(default_factory=list)
+
+
+@dataclass
+class NodeResult:
+    """Outcome of the scan of one candidate address."""
+
+    host: str
+    devaddr: int
+    unit_id: int
+    online: bool = False
+    status: str = "absent"
+    elapsed_ms: float = 0.0
+    values: dict[str, Any] = field(default_factory=dict)
+
+
+class ProtocolError(Exception):
+    """A response that is not a Modbus/TCP answer to the request."""
+
+
+def load_fields(
+    config_path: Path,
+) -> tuple[dict[str, list[Field]], Runs, set[str]]:
+    """Load the fields and mapped address runs of every space.
+
+    Returns:
+        Fields by space in address order, address runs by space, and the
+        group names.
+    """
+    logging.getLogger("modbus_codegen").setLevel(logging.ERROR)
+    config = ModbusCodeGenerator().load_config(config_path)
+    registers = config.get("registers", {})
+    word_order = config.get("device", {}).get("word_order", "high_first")
+
+    names = [
+        reg["name"] for space in SPACES for reg in registers.get(space, [])
+    ]
+    fields: dict[str, list[Field]] = {}
+    runs: Runs = {}
+    for space, (_, _, words) in SPACES.items():
+        defs = [dict(reg) for reg in registers.get(space, [])]
+        for reg in defs:
+            if words:
+                ModbusCodeGenerator._apply_register_type(reg, word_order)
+            else:
+                reg["size"] = 1
+        runs[space] = ModbusCodeGenerator._build_register_map(
+            defs, space.replace("_", " ").rstrip("s")
+        )["runs"]
+        fields[space] = [
+            Field(
+                reg["name"],
+                reg["name"]
+                if names.count(reg["name"]) == 1
+                else f"{space}.{reg['name']}",
+                reg.get("group", ""),
+                space,
+                reg["address"],
+                reg["size"],
+                reg.get("data_type", "bit") if words else "bit",
+                reg.get("word_order", word_order),
+                reg.get("scale_factor"),
+            )
+            for reg in sorted(defs, key=lambda r: r["address"])
+        ]
+    groups = {group["name"] for group in config.get("groups", [])}
+    return fields, runs, groups
+
+
+def plan_reads(
+    fields: dict[str, list[Field]],
+    runs: Runs,
+    groups: set[str] | None,
+) -> list[Read]:
+    """Merge the fields of the selected groups into the fewest reads.
+
+    The cover is the code generator's (_build_read_plan): a read grows
+    over the next selected field while both lie in one mapped address run
+    and the request stays within the space's limit; addresses between them
+    that were not selected are read and dropped.
+    """
+    reads: list[Read] = []
+    for space, (function, limit, _) in SPACES.items():
+        selected = [
+            item
+            for item in fields[space]
+            if groups is None or item.group in groups
+        ]
+        for request in ModbusCodeGenerator._build_read_plan(
+            [(item.address, item.size) for item in selected],
+            runs[space],
+            limit,
+        ):
+            reads.append(
+                Read(
+                    space,
+                    function,
+                    request["start"],
+                    request["count"],
+                    [selected[i] for i in request["items"]],
+                )
+            )
+    return reads
+
+
+def decode_field(item: Field, data: list[int], raw: bool) -> Any:
+    """Decode a field from its words (or its bit) as read."""
+    if item.data_type == "bit":
+        return data[0]
+    words = data if item.word_order != "low_first" else data[::-1]
+    value = 0
+    for word in words:
+        value = (value << 16) | word
+    if item.data_type == "int16":
+        value = value - 0x10000 if value & 0x8000 else value
+    elif item.data_type == "int32":
+        value = value - 0x100000000 if value & 0x80000000 else value
+    elif item.data_type == "float32":
+        value = struct.unpack(">f", struct.pack(">I", value))[0]
+    if item.scale is not None and not raw:
+        return value * item.scale
+    return value
+
+
+def decode_response(read: Read, pdu: bytes) -> list[int] | int:
+    """Return the words or bits of a response, or its exception code."""
+    if len(pdu) >= 2 and pdu[0] == (read.function | 0x80):
+        return pdu[1]
+    if len(pdu) < 2 or pdu[0] != read.function or pdu[1] != len(pdu) - 2:
+        raise ProtocolError(f"bad response to FC{read.function:02d}")
+    data = pdu[2:]
+    if SPACES[read.space][2]:
+        if len(data) != 2 * read.count:
+            raise ProtocolError(f"FC{read.function:02d}: wrong byte count")
+        return list(struct.unpack(f">{read.count}H", data))
+    if len(data) != (read.count + 7) // 8:
+        raise ProtocolError(f"FC{read.function:02d}: wrong byte count")
+    return [(data[i // 8] >> (i % 8)) & 1 for i in range(read.count)]
+
+
+async def transact(
+    reader: asyncio.StreamReader,
+    writer: asyncio.StreamWriter,
+    unit_id: int,
+    reads: list[Read],
+    args: argparse.Namespace,
+) -> dict[int, list[int] | int]:
+    """Issue every read, up to --pipeline at a time, and collect results.
+
+    Returns:
+        The data or the exception code of each read, by index.
+    """
+    results: dict[int, list[int] | int] = {}
+    queue = deque(range(len(reads)))
+    attempts = [0] * len(reads)
+    pending: dict[int, int] = {}
+    tid = 0
+
+    while queue or pending:
+        while queue and len(pending) < args.pipeline:
+            index = queue.popleft()
+            read = reads[index]
+            tid = (tid + 1) & 0xFFFF
+            writer.write(
+                MBAP.pack(tid, 0, 6, unit_id)
+                + struct.pack(">BHH", read.function, read.start, read.count)
+            )
+            pending[tid] = index
+            attempts[index] += 1
+        await writer.drain()
+
+        header = await asyncio.wait_for(
+            reader.readexactly(MBAP.size), args.timeout
+        )
+        rtid, protocol, length, _ = MBAP.unpack(header)
+        if protocol != 0 or not 2 <= length <= 254:
+            raise ProtocolError("bad MBAP header")
+        pdu = await asyncio.wait_for(
+            reader.readexactly(length - 1), args.timeout
+        )
+        index = pending.pop(rtid, -1)
+        if index < 0:
+            continue  # Answer to a request already given up on
+        result = decode_response(reads[index], pdu)
+        if result == EXCEPTION_BUSY and attempts[index] <= args.retries:
+            await asyncio.sleep(BUSY_BACKOFF)
+            queue.append(index)
+        else:
+            results[index] = result
+    return results
+
+
+async def scan_node(
+    node: NodeResult,
+    reads: list[Read],
+    args: argparse.Namespace,
+    semaphore: asyncio.Semaphore,
+) -> NodeResult:
+    """Connect to one candidate and read the planned registers."""
+    async with semaphore:
+        start = time.perf_counter()
+        try:
+            reader, writer = await asyncio.wait_for(
+                asyncio.open_connection(node.host, args.port),
+                args.connect_timeout,
+            )
+        except (OSError, asyncio.TimeoutError):
+            return node
+
+        node.online = True
+        try:
+            results = await transact(reader, writer, node.unit_id, reads, args)
+            errors = []
+            for index, read in enumerate(reads):
+                result = results[index]
+                if isinstance(result, int):
+                    errors.append(
+                        f"exception {result:02X} at {read.space} {read.start}"
+                    )
+                    continue
+                for item in read.fields:
+                    offset = item.address - read.start
+                    node.values[item.column] = decode_field(
+                        item, result[offset : offset + item.size], args.raw
+                    )
+            node.status = "; ".join(errors) if errors else "ok"
+        except (asyncio.TimeoutError, asyncio.IncompleteReadError):
+            node.status = "timeout"
+        except (OSError, ProtocolError) as err:
+            node.status = f"error: {err}"
+        finally:
+            writer.close()
+            try:
+                await writer.wait_closed()
+            except OSError:
+                pass
+        node.elapsed_ms = (time.perf_counter() - start) * 1000.0
+    return node
+
+
+def candidates(args: argparse.Namespace) -> list[NodeResult]:
+    """Every DEVADDR-derived address of the selected subnets."""
+    unit_offset = MONITOR_UNIT_OFFSET if args.monitor else 0
+    nodes = []
+    for subnet in args.subnet or [DEFAULT_SUBNET]:
+        for devaddr in args.devaddr:
+            nodes.append(
+                NodeResult(
+                    f"{subnet}.{IP_ADDR3_BASE + devaddr}",
+                    devaddr,
+                    UNIT_ID_BASE + devaddr + unit_offset,
+                )
+            )
+    return nodes
+
+
+def parse_devaddr(text: str) -> list[int]:
+    """Parse a DEVADDR list such as 0-7,12."""
+    values: list[int] = []
+    for part in text.split(","):
+        low, _, high = part.partition("-")
+        first, last = int(low), int(high or low)
+        if not 0 <= first <= last < DEVADDR_COUNT:
+            raise argparse.ArgumentTypeError(f"bad DEVADDR range {part}")
+        values.extend(range(first, last + 1))
+    return values
+
+
+def import_pyarrow() -> tuple[Any, Any]:
+    """Import pyarrow, only needed for Parquet output."""
+    try:
+        import pyarrow as pa  # noqa: PLC0415
+        import pyarrow.parquet as pq  # noqa: PLC0415
+    except ImportError as err:
+        raise ValueError(
+            "Parquet output needs pyarrow: pip install pyarrow"
+        ) from err
+    return pa, pq
+
+
+def write_results(
+    path: str, nodes: list[NodeResult], reads: list[Read]
+) -> None:
+    """Write one row per node to CSV, or Parquet for a .parquet path."""
+    names = [item.column for read in reads for item in read.fields]
+    rows = [
+        {
+            "host": node.host,
+            "devaddr": node.devaddr,
+            "unit_id": node.unit_id,
+            "status": node.status,
+            "elapsed_ms": round(node.elapsed_ms, 1),
+            **{name: node.values.get(name) for name in names},
+        }
+        for node in nodes
+    ]
+    if path.lower().endswith(".parquet"):
+        pa, pq = import_pyarrow()
+        pq.write_table(pa.Table.from_pylist(rows), path)
+        return
+    with open(path, "w", newline="", encoding="utf-8") as csv_file:
+        writer = csv.DictWriter(
+            csv_file, fieldnames=["host", "devaddr", "unit_id", "status",
+                                  "elapsed_ms", *names]
+        )
+        writer.writeheader()
+        writer.writerows(rows)
+
+
+def print_plan(reads: list[Read]) -> None:
+    """Print the merged requests."""
+    for read in reads:
+        names = ", ".join(item.name for item in read.fields)
+        print(
+            f"FC{read.function:02d} {read.start:5d} x{read.count:<4d} "
+            f"{len(read.fields):3d} fields: {names}"
+        )
+    print(f"{len(reads)} requests per node")
+
+
+async def scan(args: argparse.Namespace, reads: list[Read]) -> list[NodeResult]:
+    """Scan every candidate concurrently."""
+    semaphore = asyncio.Semaphore(args.concurrency)
+    return await asyncio.gather(
+        *(scan_node(node, reads, args, semaphore) for node in candidates(args))
+    )
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Find the jerry_device nodes of a site and read them all",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --subnet 169.254.4 --output site.csv
+  %(prog)s --subnet 10.1.1 --subnet 10.1.2 --groups adc_values,adc_stats
+  %(prog)s --groups di_capture --plan
+
+Exit status is 1 if no node answered, 2 on errors.
+        """,
+    )
+
+    parser.add_argument(
+        "--subnet",
+        "-s",
+        action="append",
+        help=f"First three octets of a site subnet, repeatable "
+        f"(default: {DEFAULT_SUBNET})",
+    )
+    parser.add_argument(
+        "--devaddr",
+        type=parse_devaddr,
+        default=list(range(DEVADDR_COUNT)),
+        help="DEVADDR values to try, e.g. 0-7,12 (default: 0-15)",
+    )
+    parser.add_argument(
+        "--port", "-p", type=int, default=DEFAULT_PORT, help="Modbus TCP port"
+    )
+    parser.add_argument(
+        "--monitor",
+        action="store_true",
+        help="Read through the read-only monitor unit ID (+128)",
+    )
+    parser.add_argument(
+        "--config",
+        type=Path,
+        default=DEFAULT_CONFIG,
+        help="Register map (default: config/jerry_registers.json)",
+    )
+    parser.add_argument(
+        "--groups",
+        "-g",
+        default=None,
+        help="Comma-separated register groups to read (default: all)",
+    )
+    parser.add_argument(
+        "--output", "-o", default=None, help="CSV or .parquet output file"
+    )
+    parser.add_argument(
+        "--raw", action="store_true", help="Do not apply the scale factors"
+    )
+    parser.add_argument(
+        "--pipeline",
+        type=int,
+        default=DEFAULT_PIPELINE,
+        help=f"Requests outstanding per node (default: {DEFAULT_PIPELINE})",
+    )
+    parser.add_argument(
+        "--concurrency",
+        type=int,
+        default=DEFAULT_CONCURRENCY,
+        help=f"Nodes scanned at once (default: {DEFAULT_CONCURRENCY})",
+    )
+    parser.add_argument(
+        "--connect-timeout",
+        type=float,
+        default=DEFAULT_CONNECT_TIMEOUT,
+        help=f"Seconds before a node is absent (default: "
+        f"{DEFAULT_CONNECT_TIMEOUT})",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=DEFAULT_TIMEOUT,
+        help=f"Seconds to wait for a response (default: {DEFAULT_TIMEOUT})",
+    )
+    parser.add_argument(
+        "--retries",
+        type=int,
+        default=DEFAULT_RETRIES,
+        help=f"Resends of a busy request (default: {DEFAULT_RETRIES})",
+    )
+    parser.add_argument(
+        "--all",
+        action="store_true",
+        help="Also write rows for absent nodes",
+    )
+    parser.add_argument(
+        "--plan",
+        action="store_true",
+        help="Print the merged requests and exit",
+    )
+
+    args = parser.parse_args()
+    if args.pipeline < 1 or args.concurrency < 1:
+        parser.error("--pipeline and --concurrency must be at least 1")
+
+    try:
+        fields, runs, known = load_fields(args.config)
+        groups = None
+        if args.groups:
+            groups = {g.strip() for g in args.groups.split(",")}
+            unknown = sorted(groups - known)
+            if unknown:
+                raise ValueError(f"unknown group(s): {', '.join(unknown)}")
+        reads = plan_reads(fields, runs, groups)
+        if args.output and args.output.lower().endswith(".parquet"):
+            import_pyarrow()
+    except (OSError, ValueError) as err:
+        print(f"Error: {err}", file=sys.stderr)
+        return 2
+
+    if args.plan:
+        print_plan(reads)
+        return 0
+
+    start = time.perf_counter()
+    nodes = asyncio.run(scan(args, reads))
+    elapsed = time.perf_counter() - start
+
+    online = [node for node in nodes if node.online]
+    for node in online:
+        print(
+            f"{node.host:<16} DEVADDR {node.devaddr:2d}  unit {node.unit_id:3d}"
+            f"  {node.elapsed_ms:7.1f} ms  {node.status}"
+        )
+    print(
+        f"{len(online)} of {len(nodes)} addresses answered, "
+        f"{len(reads)} requests each, in {elapsed:.2f} s"
+    )
+
+    if args.output:
+        try:
+            write_results(args.output, nodes if args.all else online, reads)
+        except (OSError, ValueError) as err:
+            print(f"Error: {err}", file=sys.stderr)
+            return 2
+    return 0 if online else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
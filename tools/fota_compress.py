@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+FOTA Compress
+
+Compresses application images for the jerry_device FOTA task, which
+decompresses them as they arrive and writes the result into the inactive
+bank without ever holding more of the image than its two chunk buffers.
+The stream is the LZ4 block format with matches reaching back at most
+WINDOW bytes, the size of a chunk buffer (FOTA_LZ_WINDOW), and it may end
+on a match. The format is described in application/inc/fota_task.h.
+
+Matches are found through hash chains over the window, taking the longest
+within MAX_CHAIN candidates, and deferred by one byte when the next
+position has a longer one. Every stream is checked by decompressing it
+before it is used.
+
+Run as a script, it compresses an image and reports the saving;
+fota_upload.py --compress does the same and sends the result.
+
+Usage:
+    python fota_compress.py build/jerry_app.bin -o jerry_app.lz
+    python fota_compress.py jerry_app.bin
+"""
+
+from __future__ import annotations
+
+import argparse
+import sys
+from pathlib import Path
+
+# Farthest match distance (FOTA_LZ_WINDOW)
+WINDOW = 2048
+
+# Shortest match of the format
+MIN_MATCH = 4
+
+# Candidates tried per position
+MAX_CHAIN = 32
+
+# Lengths held in the token before the extension bytes
+TOKEN_MAX = 15
+
+
+class CompressError(ValueError):
+    """A stream that does not decompress into its image."""
+
+
+def _length(value: int) -> bytes:
+    """Extension bytes of a length beyond TOKEN_MAX."""
+    out = bytearray()
+    value -= TOKEN_MAX
+    while value >= 255:
+        out.append(255)
+        value -= 255
+    out.append(value)
+    return bytes(out)
+
+
+class _Matcher:
+    """Hash chains of the positions within the window."""
+
+    def __init__(self, data: bytes) -> None:
+        self.data = data
+        self.head: dict[bytes, int] = {}
+        self.prev = [-1] * len(data)
+        self.inserted = 0
+
+    def insert_to(self, pos: int) -> None:
+        data = self.data
+        while self.inserted < pos:
+            i = self.inserted
+            key = data[i : i + MIN_MATCH]
+            self.prev[i] = self.head.get(key, -1)
+            self.head[key] = i
+            self.inserted += 1
+
+    def longest(self, pos: int) -> tuple[int, int]:
+        """Longest earlier match at pos, as distance and length."""
+        data = self.data
+        end = len(data)
+        best_length, best_distance = 0, 0
+        cand = self.head.get(data[pos : pos + MIN_MATCH], -1)
+        tries = MAX_CHAIN
+        while cand >= 0 and pos - cand <= WINDOW and tries > 0:
+            if data[cand + best_length : cand + best_length + 1] == data[
+                pos + best_length : pos + best_length + 1
+            ]:
+                length = 0
+                while pos + length < end and data[cand + length] == data[
+                    pos + length
+                ]:
+                    length += 1
+                if length > best_length:
+                    best_length, best_distance = length, pos - cand
+            cand = self.prev[cand]
+            tries -= 1
+        if best_length < MIN_MATCH:
+            return 0, 0
+        return best_distance, best_length
+
+
+def _sequence(literals: bytes, distance: int, length: int) -> bytes:
+    """One sequence: literals, then a match unless length is 0."""
+    lit = len(literals)
+    match = length - MIN_MATCH if length else 0
+    token = min(lit, TOKEN_MAX) << 4 | min(match, TOKEN_MAX)
+    out = bytearray([token])
+    if lit >= TOKEN_MAX:
+        out += _length(lit)
+    out += literals
+    if length:
+        out += distance.to_bytes(2, "little")
+        if match >= TOKEN_MAX:
+            out += _length(match)
+    return bytes(out)
+
+
+def compress(image: bytes) -> bytes:
+    """Compress an image into the stream the device decompresses."""
+    matcher = _Matcher(image)
+    out = bytearray()
+    pos = 0
+    literal_start = 0
+
+    while pos + MIN_MATCH <= len(image):
+        matcher.insert_to(pos)
+        distance, length = matcher.longest(pos)
+        if length:
+            # Defer by one byte when that gives a longer match
+            matcher.insert_to(pos + 1)
+            next_distance, next_length = matcher.longest(pos + 1)
+            if next_length > length + 1:
+                pos += 1
+                distance, length = next_distance, next_length
+        if not length:
+            pos += 1
+            continue
+        out += _sequence(image[literal_start:pos], distance, length)
+        pos += length
+        literal_start = pos
+
+    if literal_start < len(image):
+        out += _sequence(image[literal_start:], 0, 0)
+    return bytes(out)
+
+
+def decompress(stream: bytes, image_size: int) -> bytes:
+    """Decompress a stream as the device does, with its checks."""
+    image = bytearray()
+    pos = 0
+
+    def byte() -> int:
+        nonlocal pos
+        if pos >= len(stream):
+            raise CompressError("stream ends inside a sequence")
+        pos += 1
+        return stream[pos - 1]
+
+    def length(value: int) -> int:
+        if value == TOKEN_MAX:
+            while True:
+                extra = byte()
+                value += extra
+                if extra != 255:
+                    break
+        return value
+
+    while len(image) < image_size:
+        token = byte()
+        lit = length(token >> 4)
+        if lit > image_size - len(image) or pos + lit > len(stream):
+            raise CompressError(f"{lit} literals at {pos}")
+        image += stream[pos : pos + lit]
+        pos += lit
+        if len(image) == image_size:
+            break
+        distance = byte() | byte() << 8
+        match = length(token & 0x0F) + MIN_MATCH
+        if not 0 < distance <= min(WINDOW, len(image)):
+            raise CompressError(f"match distance {distance} at {pos}")
+        if match > image_size - len(image):
+            raise CompressError(f"match of {match} bytes at {pos}")
+        for _ in range(match):
+            image.append(image[-distance])
+
+    return bytes(image)
+
+
+def compress_checked(image: bytes) -> bytes:
+    """Compress an image and check that the stream decompresses to it."""
+    stream = compress(image)
+    if decompress(stream, len(image)) != image:
+        raise CompressError("stream does not decompress to the image")
+    return stream
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Compress an application image for a FOTA update",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s build/jerry_app.bin -o jerry_app.lz
+  %(prog)s jerry_app.bin
+        """,
+    )
+    parser.add_argument("image", type=Path, help="Raw application image")
+    parser.add_argument(
+        "--output", "-o", type=Path, help="Stream file (default: report only)"
+    )
+    args = parser.parse_args()
+
+    try:
+        image = args.image.read_bytes()
+        stream = compress_checked(image)
+        if args.output is not None:
+            args.output.write_bytes(stream)
+    except (OSError, CompressError) as err:
+        print(f"Error: {err}", file=sys.stderr)
+        return 1
+
+    saved = 100.0 * (1.0 - len(stream) / max(len(image), 1))
+    print(f"Image:  {len(image)} bytes")
+    print(f"Stream: {len(stream)} bytes, {saved:.0f}% fewer")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+FOTA Delta
+
+Makes the patches of a delta update for the jerry_device FOTA task: the
+commands that rebuild a new application image from the one the device
+runs, so only what changed between the two builds is sent. The device
+decodes the patch as it arrives and writes the rebuilt image into the
+inactive bank, checking it against the signature of the new image as for
+a full update. The patch format is described in application/inc/fota_task.h.
+
+The patch copies runs of the base image and adds the bytes found nowhere
+in it. Runs are looked up in an index of the base and, first, at the
+distance of the previous run, which keeps following code that only moved
+when a change shifted it. Every patch is checked by applying it before it
+is used.
+
+Run as a script, it writes a patch and reports its size; fota_upload.py
+--base makes one the same way and sends it.
+
+Usage:
+    python fota_delta.py old/jerry_app.bin build/jerry_app.bin -o app.patch
+    python fota_delta.py old.bin new.bin
+"""
+
+from __future__ import annotations
+
+import argparse
+import sys
+import zlib
+from dataclasses import dataclass
+from pathlib import Path
+
+# Patch commands (fota_task.h)
+CMD_ADD = 0
+CMD_COPY = 1
+
+# Bytes a run must share with the base to be looked up in the index
+KEY_SIZE = 12
+
+# Base offsets indexed, every INDEX_STRIDE bytes; runs of KEY_SIZE +
+# INDEX_STRIDE - 1 bytes or more are always found
+INDEX_STRIDE = 4
+
+# Shortest run worth a COPY rather than adding its bytes
+MIN_COPY = 8
+
+
+class PatchError(ValueError):
+    """A patch that does not rebuild an image from its base."""
+
+
+@dataclass
+class PatchStats:
+    """Make-up of a patch."""
+
+    copies: int = 0
+    copied: int = 0
+    adds: int = 0
+    added: int = 0
+
+
+def crc32(data: bytes) -> int:
+    """CRC-32 of the base image as the device computes it."""
+    return zlib.crc32(data) & 0xFFFFFFFF
+
+
+def _varint(value: int) -> bytes:
+    out = bytearray()
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def _zigzag(value: int) -> int:
+    return value << 1 if value >= 0 else ((-value - 1) << 1) | 1
+
+
+def _unzigzag(u: int) -> int:
+    return -(u >> 1) - 1 if u & 1 else u >> 1
+
+
+def _index(base: bytes) -> dict[bytes, int]:
+    """First base offset of each key, at every INDEX_STRIDE bytes."""
+    index: dict[bytes, int] = {}
+    for pos in range(0, len(base) - KEY_SIZE + 1, INDEX_STRIDE):
+        index.setdefault(base[pos : pos + KEY_SIZE], pos)
+    return index
+
+
+def _run(base: bytes, src: int, image: bytes, pos: int) -> int:
+    """Length of the bytes shared from base[src] and image[pos]."""
+    if src < 0 or src >= len(base):
+        return 0
+    length = 0
+    limit = min(len(base) - src, len(image) - pos)
+    while length < limit and base[src + length] == image[pos + length]:
+        length += 1
+    return length
+
+
+class _Writer:
+    """Encodes the commands of a patch."""
+
+    def __init__(self) -> None:
+        self.patch = bytearray()
+        self.copy_end = 0
+        self.stats = PatchStats()
+
+    def add(self, data: bytes) -> None:
+        if data:
+            self.patch += _varint(len(data) << 1 | CMD_ADD) + data
+            self.stats.adds += 1
+            self.stats.added += len(data)
+
+    def copy(self, src: int, length: int) -> None:
+        self.patch += _varint(length << 1 | CMD_COPY)
+        self.patch += _varint(_zigzag(src - self.copy_end))
+        self.copy_end = src + length
+        self.stats.copies += 1
+        self.stats.copied += length
+
+
+def make_patch(base: bytes, image: bytes) -> tuple[bytes, PatchStats]:
+    """Make the patch that rebuilds image from base."""
+    index = _index(base)
+    writer = _Writer()
+    pos = 0
+    literal_start = 0
+    # Base offset minus image offset of the previous run
+    shift = 0
+
+    while pos < len(image):
+        src, length = pos + shift, _run(base, pos + shift, image, pos)
+        if length < MIN_COPY:
+            found = index.get(image[pos : pos + KEY_SIZE])
+            if found is not None:
+                src, length = found, _run(base, found, image, pos)
+        if length < MIN_COPY:
+            pos += 1
+            continue
+
+        # Take back the bytes before the run that also match
+        while (
+            pos > literal_start
+            and src > 0
+            and base[src - 1] == image[pos - 1]
+        ):
+            src -= 1
+            pos -= 1
+            length += 1
+
+        writer.add(image[literal_start:pos])
+        writer.copy(src, length)
+        shift = src - pos
+        pos += length
+        literal_start = pos
+
+    writer.add(image[literal_start:])
+    return bytes(writer.patch), writer.stats
+
+
+def apply_patch(base: bytes, patch: bytes, image_size: int) -> bytes:
+    """Rebuild an image as the device does, with its checks."""
+    image = bytearray()
+    copy_end = 0
+    pos = 0
+
+    def read_varint() -> int:
+        nonlocal pos
+        value = 0
+        shift = 0
+        while True:
+            if pos >= len(patch):
+                raise PatchError("patch ends inside a command")
+            byte = patch[pos]
+            pos += 1
+            if shift == 28 and byte > 0x0F:
+                raise PatchError("varint longer than 32 bits")
+            value |= (byte & 0x7F) << shift
+            if not byte & 0x80:
+                return value
+            shift += 7
+
+    while len(image) < image_size:
+        command = read_varint()
+        length = command >> 1
+        if length == 0 or length > image_size - len(image):
+            raise PatchError(f"command of {length} bytes at {pos}")
+        if command & 1 == CMD_ADD:
+            if pos + length > len(patch):
+                raise PatchError("patch ends inside an ADD")
+            image += patch[pos : pos + length]
+            pos += length
+        else:
+            src = copy_end + _unzigzag(read_varint())
+            if src < 0 or src + length > len(base):
+                raise PatchError(f"COPY from {src} outside the base")
+            image += base[src : src + length]
+            copy_end = src + length
+
+    return bytes(image)
+
+
+def make_checked_patch(base: bytes, image: bytes) -> tuple[bytes, PatchStats]:
+    """Make a patch and check that it rebuilds the image."""
+    patch, stats = make_patch(base, image)
+    if apply_patch(base, patch, len(image)) != image:
+        raise PatchError("patch does not rebuild the image")
+    return patch, stats
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Make a delta update patch between two application images",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s old/jerry_app.bin build/jerry_app.bin -o app.patch
+  %(prog)s old.bin new.bin
+        """,
+    )
+    parser.add_argument("base", type=Path, help="Image the device runs")
+    parser.add_argument("image", type=Path, help="New image")
+    parser.add_argument(
+        "--output", "-o", type=Path, help="Patch file (default: report only)"
+    )
+    args = parser.parse_args()
+
+    try:
+        base = args.base.read_bytes()
+        image = args.image.read_bytes()
+        patch, stats = make_checked_patch(base, image)
+        if args.output is not None:
+            args.output.write_bytes(patch)
+    except (OSError, PatchError) as err:
+        print(f"Error: {err}", file=sys.stderr)
+        return 1
+
+    print(f"Base:  {len(base)} bytes, CRC-32 0x{crc32(base):08X}")
+    print(f"Image: {len(image)} bytes")
+    print(
+        f"Patch: {len(patch)} bytes, {len(image) / max(len(patch), 1):.1f}x "
+        f"smaller"
+    )
+    print(f"  {stats.copies} copies of {stats.copied} bytes")
+    print(f"  {stats.adds} adds of {stats.added} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
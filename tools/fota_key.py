@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""
+FOTA Verification Key
+
+Writes the public half of the image signing key as the C header the
+secure image builds its signature check from (secure_nsc.c). The key is
+a P-256 key in PEM, private or public; its public half is taken with the
+openssl command line tool, as fota_upload.py signs with it.
+
+The header also says whether the key is the development key of
+tools/keys, which signs images for anyone holding the checkout: the
+build warns about it, and refuses it for release builds unless allowed
+(application/bsp/stm/stm32h563/fota_key.cmake). That key is never
+committed; asked for while it is missing, it is generated here with
+openssl, once per checkout.
+
+Usage:
+    python fota_key.py signing.pem -o build/fota_public_key.h
+    python fota_key.py tools/keys/fota_dev_p256.pem -o fota_public_key.h
+"""
+
+from __future__ import annotations
+
+import argparse
+import subprocess
+import sys
+from pathlib import Path
+
+# Development signing key, the default of fota_upload.py
+DEV_KEY = Path(__file__).resolve().parent / "keys" / "fota_dev_p256.pem"
+
+# P-256 coordinate size in bytes
+CURVE_SIZE = 32
+
+# SubjectPublicKeyInfo of a P-256 key up to its uncompressed point: the
+# ecPublicKey and prime256v1 OIDs, then 0x04 ahead of X and Y
+SPKI_PREFIX = bytes.fromhex(
+    "3059301306072a8648ce3d020106082a8648ce3d03010703420004"
+)
+
+# Bytes per line of the key initializer
+BYTES_PER_LINE = 12
+
+
+class KeyFileError(Exception):
+    """The key file is not a P-256 key openssl can read."""
+
+
+def public_point(key: Path) -> bytes:
+    """Read a PEM key, returning X then Y of its public point, big-endian."""
+    command = ["openssl", "pkey", "-in", str(key), "-pubout", "-outform", "DER"]
+    if b"PUBLIC KEY" in key.read_bytes():
+        command.insert(2, "-pubin")
+    result = subprocess.run(command, capture_output=True, check=False)
+    if result.returncode != 0:
+        message = result.stderr.decode(errors="replace").strip()
+        raise KeyFileError(f"openssl cannot read {key}: {message}")
+
+    der = result.stdout
+    if (len(der) != len(SPKI_PREFIX) + 2 * CURVE_SIZE) or not der.startswith(
+        SPKI_PREFIX
+    ):
+        raise KeyFileError(f"{key} is not a P-256 key")
+    return der[len(SPKI_PREFIX) :]
+
+
+def generate_dev_key() -> None:
+    """Generate the development key of this checkout."""
+    DEV_KEY.parent.mkdir(parents=True, exist_ok=True)
+    command = ["openssl", "ecparam", "-name", "prime256v1", "-genkey", "-noout",
+               "-out", str(DEV_KEY)]
+    result = subprocess.run(command, capture_output=True, check=False)
+    if result.returncode != 0:
+        message = result.stderr.decode(errors="replace").strip()
+        raise KeyFileError(f"openssl cannot generate {DEV_KEY}: {message}")
+    print(f"Generated the development key {DEV_KEY}", file=sys.stderr)
+
+
+def generate(key: Path, point: bytes, development: bool) -> str:
+    """Generate the header for a public point."""
+    lines = [
+        "/*",
+        " * Generated by tools/fota_key.py - do not edit",
+        " *",
+        f" * Public half of {key.name}, X then Y, big-endian",
+        " */",
+        "",
+        "#ifndef FOTA_PUBLIC_KEY_H",
+        "#define FOTA_PUBLIC_KEY_H",
+        "",
+        "/* The development key of tools/keys, which anyone with the checkout",
+        "   can sign with */",
+        f"#define FOTA_PUBLIC_KEY_DEVELOPMENT {1 if development else 0}",
+        "",
+        "#define FOTA_PUBLIC_KEY_BYTES \\",
+    ]
+    for start in range(0, len(point), BYTES_PER_LINE):
+        chunk = point[start : start + BYTES_PER_LINE]
+        last = start + BYTES_PER_LINE >= len(point)
+        text = ", ".join(f"0x{b:02X}" for b in chunk)
+        lines.append(f"  {text}" + ("" if last else ", \\"))
+    lines.append("")
+    lines.append("#endif /* FOTA_PUBLIC_KEY_H */")
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Write the FOTA verification key as a C header"
+    )
+    parser.add_argument("key", type=Path, help="P-256 signing key (PEM)")
+    parser.add_argument(
+        "-o", "--output", type=Path, required=True, help="Header to write"
+    )
+    args = parser.parse_args()
+
+    try:
+        if (args.key.resolve() == DEV_KEY) and not DEV_KEY.exists():
+            generate_dev_key()
+        point = public_point(args.key)
+        development = DEV_KEY.exists() and (point == public_point(DEV_KEY))
+    except (OSError, KeyFileError) as exc:
+        print(f"Error: {exc}", file=sys.stderr)
+        return 1
+
+    code = generate(args.key, point, development)
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    # Only rewrite on a change, so the secure image is not rebuilt for nothing
+    old = args.output.read_text(encoding="utf-8") if args.output.exists() else ""
+    if old != code:
+        args.output.write_text(code, encoding="utf-8")
+    kind = "development key" if development else "key"
+    print(f"FOTA verification {kind} {args.key.name}: {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,325 @@
+#!/usr/bin/env python3
+"""
+FOTA Upload
+
+Signs an application image and sends it to the jerry_device FOTA task
+over TCP, then prints the device's reply. On success the device swaps its
+flash banks and resets into the new image.
+
+The image is the raw binary of the NonSecure application, jerry_app.bin,
+which the build writes next to the ELF. It is signed with ECDSA P-256 over
+its SHA-256 using the openssl command line tool; the device only accepts
+images signed with the key whose public half is built into the secure
+image (JERRY_FOTA_KEY, fota_key.py). The header and reply formats are
+described in application/inc/fota_task.h.
+
+With --base, the image the device runs, only a patch is sent
+(fota_delta.py) and the device rebuilds the new image from its own. The
+signature is still over the new image; a device running any other image
+than the base refuses the patch with BAD_BASE before writing. With
+--compress the image is sent compressed (fota_compress.py) instead.
+
+A full image whose transfer is cut resumes where the device says it
+stopped, on a new connection, up to --retries times; the device keeps its
+progress across a reset too, so running the tool again after one also
+resumes.
+
+Usage:
+    python fota_upload.py 169.254.4.100 build/jerry_app.bin
+    python fota_upload.py 169.254.4.105 jerry_app.bin --key signing.pem
+    python fota_upload.py 169.254.4.100 build/jerry_app.bin --base v1.bin
+    python fota_upload.py 169.254.4.100 build/jerry_app.bin --compress
+"""
+
+from __future__ import annotations
+
+import argparse
+import socket
+import struct
+import subprocess
+import sys
+import time
+from pathlib import Path
+
+from fota_compress import CompressError, compress_checked
+from fota_delta import PatchError, crc32, make_checked_patch
+
+# Default configuration matching the FOTA task
+DEFAULT_PORT = 5008
+DEFAULT_TIMEOUT = 30.0
+DEFAULT_RETRIES = 3
+
+# Pause before a cut transfer is resumed
+RETRY_DELAY = 1.0
+
+# Development signing key, the default JERRY_FOTA_KEY of the secure image
+DEFAULT_KEY = Path(__file__).resolve().parent / "keys" / "fota_dev_p256.pem"
+
+# Segment size handed to the socket, about one Ethernet MTU of payload
+CHUNK_SIZE = 1460
+
+# Header and reply formats (fota_task.h)
+FOTA_MAGIC = 0x464A
+FOTA_VERSION = 3
+HEADER = struct.Struct("<HBBIII64s")
+PAYLOAD_IMAGE = 0
+PAYLOAD_DELTA = 1
+PAYLOAD_LZ = 2
+REPLY = struct.Struct("<B3xI")
+
+# P-256 scalar size in bytes
+CURVE_SIZE = 32
+
+# Largest image, the update slot (BSP_FLASH_APP_SIZE)
+MAX_IMAGE_SIZE = 880 * 1024
+
+STATUS_NAMES = {
+    0: "OK",
+    1: "BAD_HEADER",
+    2: "TIMEOUT",
+    3: "FLASH",
+    4: "BAD_SIGNATURE",
+    5: "BAD_IMAGE",
+    6: "VERIFY",
+    7: "BAD_BASE",
+    8: "BAD_PATCH",
+}
+
+
+def _der_integer(der: bytes, pos: int) -> tuple[int, int]:
+    """Read one DER INTEGER, returning its value and the next position."""
+    if der[pos] != 0x02:
+        raise ValueError("expected a DER INTEGER")
+    length = der[pos + 1]
+    start = pos + 2
+    return int.from_bytes(der[start : start + length], "big"), start + length
+
+
+def sign(image: bytes, key: Path) -> bytes:
+    """Sign an image, returning r then s as big-endian scalars."""
+    der = subprocess.run(
+        ["openssl", "dgst", "-sha256", "-sign", str(key)],
+        input=image,
+        capture_output=True,
+        check=True,
+    ).stdout
+    # SEQUENCE { INTEGER r, INTEGER s }, short length forms for P-256
+    if der[0] != 0x30:
+        raise ValueError("expected a DER SEQUENCE")
+    r, pos = _der_integer(der, 2)
+    s, _ = _der_integer(der, pos)
+    return r.to_bytes(CURVE_SIZE, "big") + s.to_bytes(CURVE_SIZE, "big")
+
+
+def build_header(
+    image: bytes,
+    signature: bytes,
+    payload_type: int = PAYLOAD_IMAGE,
+    base: bytes = b"",
+) -> bytes:
+    """Build the update header for a signed image, sent as payload_type.
+
+    A full image carries its own CRC-32, which names it for a resume.
+    """
+    return HEADER.pack(
+        FOTA_MAGIC,
+        FOTA_VERSION,
+        payload_type,
+        len(image),
+        len(base),
+        crc32(base if base else image),
+        signature,
+    )
+
+
+def read_reply(sock: socket.socket) -> tuple[int, int] | None:
+    """Read one reply, as status and bytes written."""
+    reply = b""
+    while len(reply) < REPLY.size:
+        data = sock.recv(REPLY.size - len(reply))
+        if not data:
+            return None
+        reply += data
+    return REPLY.unpack(reply)
+
+
+def transfer(
+    host: str, port: int, header: bytes, payload: bytes, timeout: float
+) -> tuple[int, int] | None:
+    """Send the payload from where the device asks and return its reply."""
+    with socket.create_connection((host, port), timeout=timeout) as sock:
+        sock.sendall(header)
+        reply = read_reply(sock)
+        if reply is None or reply[0] != 0:
+            return reply
+
+        # The device tells how much of the image it already holds
+        sent = reply[1]
+        if sent:
+            print(f"Device holds {sent} bytes, resuming")
+        while sent < len(payload):
+            chunk = payload[sent : sent + CHUNK_SIZE]
+            sock.sendall(chunk)
+            sent += len(chunk)
+            print(f"\rSent {sent}/{len(payload)} bytes", end="", flush=True)
+        print()
+
+        return read_reply(sock)
+
+
+def upload(
+    host: str,
+    port: int,
+    image: bytes,
+    key: Path,
+    timeout: float,
+    base: bytes | None = None,
+    compress: bool = False,
+    retries: int = 0,
+) -> int:
+    """Sign and send one image, a patch to it or it compressed."""
+    signature = sign(image, key)
+    if base is not None:
+        payload, _ = make_checked_patch(base, image)
+        header = build_header(image, signature, PAYLOAD_DELTA, base)
+        print(f"Patch of {len(payload)} bytes for the {len(image)} byte image")
+    elif compress:
+        payload = compress_checked(image)
+        header = build_header(image, signature, PAYLOAD_LZ)
+        print(f"Compressed the {len(image)} byte image to {len(payload)}")
+    else:
+        payload = image
+        header = build_header(image, signature)
+    start = time.monotonic()
+    for attempt in range(retries + 1):
+        if attempt > 0:
+            print(f"Resuming, attempt {attempt + 1} of {retries + 1}")
+            time.sleep(RETRY_DELAY)
+        try:
+            reply = transfer(host, port, header, payload, timeout)
+            break
+        except OSError as exc:
+            print(f"\nTransfer cut: {exc}", file=sys.stderr)
+    else:
+        return 1
+
+    if reply is None:
+        print("Connection closed without a reply", file=sys.stderr)
+        return 1
+
+    status, written = reply
+    elapsed = time.monotonic() - start
+    name = STATUS_NAMES.get(status, f"UNKNOWN({status})")
+    print(f"Status {name}, {written} bytes written in {elapsed:.1f} s")
+    if status != 0:
+        return 2
+
+    print("Device is swapping banks and resetting")
+    return 0
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Upload an application image to the jerry_device FOTA task",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s 169.254.4.100 build/jerry_app.bin
+  %(prog)s 169.254.4.105 jerry_app.bin --key signing.pem
+  %(prog)s 169.254.4.100 build/jerry_app.bin --base v1.bin
+  %(prog)s 169.254.4.100 build/jerry_app.bin --compress
+
+Exit status is 2 if the device rejected the image.
+        """,
+    )
+
+    parser.add_argument("host", help="Device IP address")
+    parser.add_argument("image", type=Path, help="Raw application image")
+    parser.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"FOTA TCP port (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--key",
+        "-k",
+        type=Path,
+        default=DEFAULT_KEY,
+        help="ECDSA P-256 private key in PEM (default: the development key)",
+    )
+    payload = parser.add_mutually_exclusive_group()
+    payload.add_argument(
+        "--base",
+        "-b",
+        type=Path,
+        help="Image the device runs, to send only a patch to it",
+    )
+    payload.add_argument(
+        "--compress",
+        "-c",
+        action="store_true",
+        help="Send the image compressed",
+    )
+    parser.add_argument(
+        "--retries",
+        "-r",
+        type=int,
+        default=DEFAULT_RETRIES,
+        help=f"Resumes of a cut transfer (default: {DEFAULT_RETRIES})",
+    )
+    parser.add_argument(
+        "--timeout",
+        "-t",
+        type=float,
+        default=DEFAULT_TIMEOUT,
+        help=f"Socket timeout in seconds (default: {DEFAULT_TIMEOUT})",
+    )
+
+    args = parser.parse_args()
+
+    if not args.key.exists():
+        # The development key is generated by the build, never committed
+        print(
+            f"No signing key {args.key}: configure the build to generate "
+            "the development key, or give --key",
+            file=sys.stderr,
+        )
+        return 1
+
+    image = args.image.read_bytes()
+    if not 8 <= len(image) <= MAX_IMAGE_SIZE:
+        print(
+            f"Image size {len(image)} is outside 8..{MAX_IMAGE_SIZE} bytes",
+            file=sys.stderr,
+        )
+        return 1
+
+    try:
+        base = None if args.base is None else args.base.read_bytes()
+        return upload(
+            args.host,
+            args.port,
+            image,
+            args.key,
+            args.timeout,
+            base,
+            args.compress,
+            args.retries,
+        )
+    except (PatchError, CompressError) as exc:
+        print(f"Encoding failed: {exc}", file=sys.stderr)
+        return 1
+    except subprocess.CalledProcessError as exc:
+        message = exc.stderr.decode(errors="replace")
+        print(f"Signing failed: {message}", file=sys.stderr)
+        return 1
+    except OSError as exc:
+        print(f"Upload failed: {exc}", file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+HTTP Asset Compiler
+
+Compresses the files of a directory with gzip and writes them as a C table
+for the HTTP server of jerry_device (built with -DJERRY_HTTP_SERVER=ON),
+which sends them from flash as they are, header included. The table type
+is http_asset_t in application/inc/http_server.h. The output is the same
+for the same input, so the build is reproducible.
+
+Usage:
+    python http_assets.py application/web -o build/http_assets.c
+"""
+
+from __future__ import annotations
+
+import argparse
+import gzip
+import sys
+from pathlib import Path
+
+# Content types by file extension
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css; charset=utf-8",
+    ".js": "text/javascript; charset=utf-8",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+    ".txt": "text/plain; charset=utf-8",
+}
+
+# Static assets change with the firmware only
+CACHE_CONTROL = "max-age=3600"
+
+# Bytes per line of the body arrays
+BYTES_PER_LINE = 12
+
+
+def response_header(content_type: str, length: int) -> str:
+    """Build the complete response header of an asset."""
+    return (
+        "HTTP/1.0 200 OK\r\n"
+        f"Content-Type: {content_type}\r\n"
+        "Content-Encoding: gzip\r\n"
+        f"Content-Length: {length}\r\n"
+        f"Cache-Control: {CACHE_CONTROL}\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+    )
+
+
+def c_string(text: str) -> str:
+    """Quote text as a C string literal."""
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"').replace(
+        "\r", "\\r"
+    ).replace("\n", "\\n") + '"'
+
+
+def c_bytes(data: bytes) -> list[str]:
+    """Format data as the lines of a C array initializer."""
+    lines = []
+    for start in range(0, len(data), BYTES_PER_LINE):
+        chunk = data[start : start + BYTES_PER_LINE]
+        lines.append("    " + ", ".join(f"0x{b:02X}" for b in chunk) + ",")
+    return lines
+
+
+def generate(source: Path) -> tuple[str, int, int]:
+    """Generate the C source for the files in source.
+
+    Returns:
+        The C source, the number of assets and their compressed size.
+    """
+    files = sorted(
+        path
+        for path in source.rglob("*")
+        if path.is_file() and path.suffix in CONTENT_TYPES
+    )
+
+    lines = [
+        "/*",
+        " * Generated by tools/http_assets.py - do not edit",
+        " *",
+        f" * Assets of {source.name}/, gzip compressed",
+        " */",
+        "",
+        '#include "http_server.h"',
+        "",
+        "#if HTTP_SERVER",
+        "",
+    ]
+    entries = []
+    total = 0
+    for index, path in enumerate(files):
+        url = "/" + path.relative_to(source).as_posix()
+        body = gzip.compress(path.read_bytes(), compresslevel=9, mtime=0)
+        header = response_header(CONTENT_TYPES[path.suffix], len(body))
+        total += len(body)
+
+        lines.append(
+            f"/* {url}: {path.stat().st_size} bytes, {len(body)} compressed */"
+        )
+        lines.append(f"static const char s_header_{index}[] =")
+        lines.append(f"    {c_string(header)};")
+        lines.append(f"static const uint8_t s_body_{index}[{len(body)}] = {{")
+        lines.extend(c_bytes(body))
+        lines.append("};")
+        lines.append("")
+        entries.append(
+            f"    {{{c_string(url)}, s_header_{index}, "
+            f"sizeof(s_header_{index}) - 1U, s_body_{index}, "
+            f"sizeof(s_body_{index})}},"
+        )
+
+    lines.append(f"const http_asset_t http_assets[{max(len(files), 1)}] = {{")
+    lines.extend(entries if entries else ["    {NULL, NULL, 0U, NULL, 0U},"])
+    lines.append("};")
+    lines.append("")
+    lines.append(f"const uint32_t http_asset_count = {len(files)}U;")
+    lines.append("")
+    lines.append("#endif /* HTTP_SERVER */")
+    lines.append("")
+    return "\n".join(lines), len(files), total
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Compress web assets into a C table for the HTTP server"
+    )
+    parser.add_argument("source", type=Path, help="Directory of the assets")
+    parser.add_argument(
+        "-o", "--output", type=Path, required=True, help="C file to write"
+    )
+    args = parser.parse_args()
+
+    if not args.source.is_dir():
+        print(f"Error: {args.source} is not a directory", file=sys.stderr)
+        return 1
+
+    code, count, total = generate(args.source)
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    args.output.write_text(code, encoding="utf-8")
+    print(f"{count} assets, {total} bytes compressed: {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+"""
+Log Decoder
+
+Decodes the binary console log of a jerry_device firmware built with
+-DJERRY_LOG_BINARY=ON. The firmware sends format string addresses instead
+of text; they are looked up in the ELF file of the same build, and the
+records are formatted here.
+
+The frame format is described in application/src/logging_task.c. Input is
+a capture file, standard input, or a serial device, which is configured
+raw at the given baud rate (POSIX only).
+
+Usage:
+    python log_decoder.py build/jerry_app.elf /dev/ttyACM0
+    python log_decoder.py build/jerry_app.elf capture.bin
+    python log_decoder.py build/jerry_app.elf - < capture.bin
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import re
+import struct
+import sys
+from dataclasses import dataclass, field
+from typing import BinaryIO, Iterator
+
+# Default configuration matching the console port
+DEFAULT_BAUD = 115200
+
+# Frame format (logging_task.c)
+FRAME_SYNC = 0xA5
+KIND_FORMAT = 0
+KIND_TEXT = 1
+KIND_DROPPED = 2
+
+# Largest payload: timestamp, format address and LOG_MAX_ARGS arguments
+MAX_PAYLOAD = (2 + 4) * 4
+
+# ELF constants
+ELF_MAGIC = b"\x7fELF"
+ELFCLASS32 = 1
+ELFDATA2LSB = 1
+SHT_PROGBITS = 1
+SHF_ALLOC = 0x2
+
+# One C conversion specification
+CONVERSION = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<precision>\*|\d+))?"
+    r"(?P<length>hh|h|ll|l|j|z|t)?(?P<type>[diouxXcsp%])"
+)
+
+
+@dataclass
+class Section:
+    """Loaded section of the ELF file."""
+
+    address: int
+    data: bytes
+
+
+class ElfImage:
+    """Read-only view of the allocated sections of a 32-bit ELF file."""
+
+    def __init__(self, path: str) -> None:
+        with open(path, "rb") as elf_file:
+            image = elf_file.read()
+
+        if image[:4] != ELF_MAGIC or image[4] != ELFCLASS32 or image[5] != ELFDATA2LSB:
+            raise ValueError(f"{path}: not a little-endian 32-bit ELF file")
+
+        shoff = struct.unpack_from("<I", image, 0x20)[0]
+        shentsize, shnum = struct.unpack_from("<HH", image, 0x2E)
+
+        self.sections: list[Section] = []
+        for index in range(shnum):
+            (_, sh_type, flags, address, offset, size) = struct.unpack_from(
+                "<IIIIII", image, shoff + index * shentsize
+            )
+            if sh_type == SHT_PROGBITS and flags & SHF_ALLOC and size > 0:
+                self.sections.append(Section(address, image[offset : offset + size]))
+
+    def string(self, address: int) -> str | None:
+        """Return the NUL-terminated string at a target address."""
+        for section in self.sections:
+            start = address - section.address
+            if 0 <= start < len(section.data):
+                end = section.data.find(b"\0", start)
+                if end < 0:
+                    end = len(section.data)
+                return section.data[start:end].decode("utf-8", errors="replace")
+        return None
+
+
+def format_record(elf: ElfImage, fmt: str, args: list[int]) -> str:
+    """Format a record like the target printf() would."""
+    queue = list(args)
+
+    def take() -> int:
+        return queue.pop(0) if queue else 0
+
+    def convert(match: re.Match[str]) -> str:
+        conv = match.group("type")
+        if conv == "%":
+            return "%"
+
+        width = match.group("width") or ""
+        if width == "*":
+            width = str(struct.unpack("<i", struct.pack("<I", take()))[0])
+        precision = match.group("precision")
+        if precision == "*":
+            precision = str(take())
+        spec = "%" + match.group("flags") + width
+        if precision is not None:
+            spec += "." + precision
+
+        value = take()
+        if conv in "di":
+            return (spec + "d") % struct.unpack("<i", struct.pack("<I", value))[0]
+        if conv == "u":
+            return (spec + "d") % value
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv == "s":
+            text = elf.string(value)
+            return (spec + "s") % (text if text is not None else f"<0x{value:08x}>")
+        if conv == "p":
+            return "0x%08x" % value
+        return (spec + conv) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+@dataclass
+class Decoder:
+    """Reassembles frames from the byte stream and prints the records."""
+
+    elf: ElfImage
+    out: BinaryIO
+    buffer: bytearray = field(default_factory=bytearray)
+    at_line_start: bool = True
+    bad_frames: int = 0
+
+    def push(self, data: bytes) -> None:
+        """Consume received bytes."""
+        self.buffer.extend(data)
+        for kind, payload in self._frames():
+            self._emit(kind, payload)
+        self.out.flush()
+
+    def _frames(self) -> Iterator[tuple[int, bytes]]:
+        while True:
+            start = self.buffer.find(FRAME_SYNC)
+            if start < 0:
+                self.buffer.clear()
+                return
+            del self.buffer[:start]
+            if len(self.buffer) < 3:
+                return
+            kind, length = self.buffer[1], self.buffer[2]
+            if kind > KIND_DROPPED or length > MAX_PAYLOAD:
+                self.bad_frames += 1
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < 4 + length:
+                return
+            if sum(self.buffer[1 : 4 + length]) & 0xFF != 0:
+                # Not a frame start, resynchronize on the next sync byte
+                self.bad_frames += 1
+                del self.buffer[:1]
+                continue
+            payload = bytes(self.buffer[3 : 3 + length])
+            del self.buffer[: 4 + length]
+            yield kind, payload
+
+    def _write(self, text: str) -> None:
+        if text:
+            self.out.write(text.encode("utf-8", errors="replace"))
+            self.at_line_start = text.endswith("\n")
+
+    def _emit(self, kind: int, payload: bytes) -> None:
+        if kind == KIND_TEXT:
+            self._write(payload.decode("utf-8", errors="replace"))
+        elif kind == KIND_FORMAT and len(payload) >= 8 and len(payload) % 4 == 0:
+            words = list(struct.unpack(f"<{len(payload) // 4}I", payload))
+            timestamp_ms, address, args = words[0], words[1], words[2:]
+            fmt = self.elf.string(address)
+            if fmt is None:
+                text = f"<unknown format 0x{address:08x}> {args}\n"
+            else:
+                text = format_record(self.elf, fmt, args)
+            if self.at_line_start:
+                text = f"[{timestamp_ms // 1000:6d}.{timestamp_ms % 1000:03d}] " + text
+            self._write(text)
+        elif kind == KIND_DROPPED and len(payload) == 4:
+            if not self.at_line_start:
+                self._write("\n")
+            self._write(f"[log] {struct.unpack('<I', payload)[0]} records dropped\n")
+        else:
+            self.bad_frames += 1
+
+
+def open_input(path: str, baud: int) -> BinaryIO:
+    """Open the log source, configuring a serial device raw."""
+    if path == "-":
+        return sys.stdin.buffer
+
+    stream = open(path, "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios  # pylint: disable=import-outside-toplevel
+        import tty  # pylint: disable=import-outside-toplevel
+
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, f"B{baud}")
+        attrs[4] = speed
+        attrs[5] = speed
+        # 8 data bits, no parity, one stop bit
+        attrs[2] = (attrs[2] & ~(termios.PARENB | termios.CSTOPB | termios.CSIZE)) | (
+            termios.CS8 | termios.CLOCAL | termios.CREAD
+        )
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    return stream
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Decode the binary jerry_device console log",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s build/jerry_app.elf /dev/ttyACM0
+  %(prog)s build/jerry_app.elf capture.bin
+  %(prog)s build/jerry_app.elf - < capture.bin
+
+Exit status is 2 if any malformed frame was skipped.
+        """,
+    )
+
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    parser.add_argument(
+        "input",
+        nargs="?",
+        default="-",
+        help="Serial device, capture file, or - for standard input (default: -)",
+    )
+    parser.add_argument(
+        "--baud",
+        "-b",
+        type=int,
+        default=DEFAULT_BAUD,
+        help=f"Baud rate of a serial device (default: {DEFAULT_BAUD})",
+    )
+
+    args = parser.parse_args()
+
+    decoder = Decoder(ElfImage(args.elf), sys.stdout.buffer)
+    stream = open_input(args.input, args.baud)
+    try:
+        while True:
+            data = stream.read(4096)
+            if not data:
+                break
+            decoder.push(data)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if stream is not sys.stdin.buffer:
+            stream.close()
+
+    if decoder.bad_frames:
+        print(f"\n{decoder.bad_frames} malformed frames skipped", file=sys.stderr)
+    return 0 if decoder.bad_frames == 0 else 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,563 @@
+#!/usr/bin/env python3
+"""
+lwIP Pool Profiler
+
+Sizes the lwIP pools of lwipopts.h for the traffic a device actually
+sees. The device is built with -DJERRY_LWIP_PROFILE=ON, so every
+telemetry frame also carries the RAM per element of each pool and the
+sys_arch kernel object pools with the deepest level of each mailbox
+class (application/inc/telemetry.h). "record" stores the frames that
+arrive while a test workload runs, one JSON line per frame; "recommend"
+reads such a recording and prints
+
+- the allocation failures over time, per pool and frame period,
+- the high-water mark and failures of the heap, of every MEMP pool
+  (the pbuf pool included) and of every mailbox class,
+- recommended lwipopts.h values with the headroom asked for, and the
+  RAM the pools take now and would take with them.
+
+A pool that refused allocations was too small to show the real demand; it
+is recommended twice the headroom above its current size and flagged, so
+the workload should be run again with the new value. Set the telemetry
+period (holding register 130) to 1 s for a finer failure time series.
+
+MEM_SIZE, PBUF_POOL_SIZE and MEMP_NUM_TCP_SEG are set per network
+profile (lwipopts.h, section 3c); the mutex, semaphore and thread counts
+are MAX_MUTEXES, MAX_SEMAPHORES and MAX_THREADS in sys_arch.c.
+
+Usage:
+    python lwip_pool_profile.py record profile.jsonl
+    python lwip_pool_profile.py record profile.jsonl --duration 600
+    python lwip_pool_profile.py recommend profile.jsonl
+    python lwip_pool_profile.py recommend profile.jsonl --headroom 50
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import math
+import socket
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+from typing import Any
+
+from telemetry_decoder import (
+    NAME_SIZE,
+    SECTION_LWIP_MEM,
+    SECTION_LWIP_MEMP,
+    SECTION_LWIP_SIZES,
+    SECTION_SYS_POOLS,
+    SYS_POOL_ENTRY,
+    Frame,
+    FrameError,
+    decode_frame,
+)
+
+# Default configuration matching the telemetry module
+DEFAULT_BIND = "0.0.0.0"
+DEFAULT_PORT = 5006
+DEFAULT_HEADROOM = 25
+
+# Heap recommendations are rounded up to this many bytes
+HEAP_ROUNDING = 256
+
+# Size of a mailbox entry, a pointer on the Cortex-M33
+POINTER_SIZE = 4
+
+MEMP_ENTRY = struct.Struct(f"<{NAME_SIZE}sHHHH")
+
+# lwipopts.h setting of each MEMP pool, by the pool's name in lwip_stats
+MEMP_SETTINGS = {
+    "RAW_PCB": "MEMP_NUM_RAW_PCB",
+    "UDP_PCB": "MEMP_NUM_UDP_PCB",
+    "TCP_PCB": "MEMP_NUM_TCP_PCB",
+    "TCP_PCB_LISTEN": "MEMP_NUM_TCP_PCB_LISTEN",
+    "TCP_SEG": "MEMP_NUM_TCP_SEG",
+    "ALTCP_PCB": "MEMP_NUM_ALTCP_PCB",
+    "REASSDATA": "MEMP_NUM_REASSDATA",
+    "FRAG_PBUF": "MEMP_NUM_FRAG_PBUF",
+    "NETBUF": "MEMP_NUM_NETBUF",
+    "NETCONN": "MEMP_NUM_NETCONN",
+    "SELECT_CB": "MEMP_NUM_SELECT_CB",
+    "TCPIP_MSG_API": "MEMP_NUM_TCPIP_MSG_API",
+    "TCPIP_MSG_INPKT": "MEMP_NUM_TCPIP_MSG_INPKT",
+    "ARP_QUEUE": "MEMP_NUM_ARP_QUEUE",
+    "IGMP_GROUP": "MEMP_NUM_IGMP_GROUP",
+    "SYS_TIMEOUT": "MEMP_NUM_SYS_TIMEOUT",
+    "NETDB": "MEMP_NUM_NETDB",
+    "LOCALHOSTLIST": "MEMP_NUM_LOCALHOSTLIST",
+    "PBUF_REF/ROM": "MEMP_NUM_PBUF",
+    "PBUF_POOL": "PBUF_POOL_SIZE",
+}
+
+# sys_arch.c pools: setting of the count, setting of the depth
+SYS_SETTINGS = {
+    "mutex": ("MAX_MUTEXES", None),
+    "sem": ("MAX_SEMAPHORES", None),
+    "mbox_tcpip": (None, "TCPIP_MBOX_SIZE"),
+    "mbox_conn": (None, "DEFAULT_*_RECVMBOX_SIZE"),
+    "thread": ("MAX_THREADS", None),
+}
+
+# Settings chosen by the network profile, lwipopts.h section 3c
+PROFILE_SETTINGS = {"MEM_SIZE", "PBUF_POOL_SIZE", "MEMP_NUM_TCP_SEG"}
+
+
+def _name(raw: bytes) -> str:
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def _section(frame: Frame, section_id: int) -> Any:
+    for section in frame.sections:
+        if section.section_id == section_id:
+            return section
+    return None
+
+
+def frame_record(frame: Frame) -> dict[str, Any]:
+    """The pool usage of a frame, as one JSON-serializable record."""
+    record: dict[str, Any] = {
+        "time": time.time(),
+        "sequence": frame.sequence,
+        "uptime_ms": frame.uptime_ms,
+        "period_s": frame.period_s,
+        "heap": None,
+        "pools": [],
+        "sys_pools": [],
+    }
+
+    heap = _section(frame, SECTION_LWIP_MEM)
+    if heap is not None:
+        avail, used, peak, err = struct.unpack_from("<IIII", heap.body)
+        record["heap"] = {
+            "avail": avail,
+            "used": used,
+            "max": peak,
+            "err": err,
+        }
+
+    memp = _section(frame, SECTION_LWIP_MEMP)
+    sizes_section = _section(frame, SECTION_LWIP_SIZES)
+    sizes: tuple[int, ...] = ()
+    if sizes_section is not None:
+        sizes = struct.unpack_from(
+            f"<{sizes_section.entries}H", sizes_section.body
+        )
+    if memp is not None:
+        for i in range(memp.entries):
+            name, avail, used, peak, err = MEMP_ENTRY.unpack_from(
+                memp.body, i * MEMP_ENTRY.size
+            )
+            record["pools"].append(
+                {
+                    "name": _name(name),
+                    "avail": avail,
+                    "used": used,
+                    "max": peak,
+                    "err": err,
+                    "size": sizes[i] if i < len(sizes) else None,
+                }
+            )
+
+    sys_pools = _section(frame, SECTION_SYS_POOLS)
+    if sys_pools is not None:
+        for i in range(sys_pools.entries):
+            name, size, count, depth, used, peak, err, fill, full = (
+                SYS_POOL_ENTRY.unpack_from(
+                    sys_pools.body, i * SYS_POOL_ENTRY.size
+                )
+            )
+            record["sys_pools"].append(
+                {
+                    "name": _name(name),
+                    "size": size,
+                    "count": count,
+                    "depth": depth,
+                    "used": used,
+                    "max": peak,
+                    "err": err,
+                    "max_fill": fill,
+                    "full": full,
+                }
+            )
+
+    return record
+
+
+def record_udp(path: str, bind: str, port: int, duration: float) -> int:
+    """Store the frames received on a UDP port until stopped."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((bind, port))
+    sock.settimeout(1.0)
+    end = time.monotonic() + duration if duration > 0 else None
+    frames = 0
+    warned = False
+
+    print(f"Recording frames from {bind}:{port} to {path}, Ctrl+C to stop")
+    try:
+        with open(path, "a", encoding="utf-8") as out:
+            while end is None or time.monotonic() < end:
+                try:
+                    data, sender = sock.recvfrom(2048)
+                except socket.timeout:
+                    continue
+                try:
+                    frame = decode_frame(data)
+                except FrameError as exc:
+                    print(f"{sender[0]}: {exc}", file=sys.stderr)
+                    continue
+
+                record = frame_record(frame)
+                if not record["sys_pools"] and not warned:
+                    print(
+                        "Warning: no sys_arch pools in the frames, is the "
+                        "device built with -DJERRY_LWIP_PROFILE=ON?",
+                        file=sys.stderr,
+                    )
+                    warned = True
+                out.write(json.dumps(record) + "\n")
+                out.flush()
+                frames += 1
+                uptime_s = frame.uptime_ms / 1000
+                print(
+                    f"\r{frames} frames, uptime {uptime_s:.0f} s",
+                    end="",
+                    flush=True,
+                )
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+    print()
+    return 0
+
+
+@dataclass
+class Usage:
+    """Usage of one pool over a recording."""
+
+    name: str
+    setting: str | None
+    count: int = 0
+    size: int | None = None
+    peak: int = 0
+    failures: int = 0
+    depth: int = 0
+    max_fill: int = 0
+    full: int = 0
+    last_err: int = 0
+    last_full: int = 0
+    series: list[tuple[float, int]] = field(default_factory=list)
+
+    def update(
+        self, uptime_s: float, count: int, peak: int, err: int, rebooted: bool
+    ) -> None:
+        """Take the cumulative counters of one frame."""
+        if rebooted:
+            self.last_err = 0
+        self.count = count
+        self.peak = max(self.peak, peak)
+        new = err - self.last_err if err >= self.last_err else err
+        if new > 0:
+            self.failures += new
+            self.series.append((uptime_s, new))
+        self.last_err = err
+
+
+def _scale(value: int, headroom: float) -> int:
+    return math.ceil(value * (1.0 + headroom))
+
+
+def recommend_count(usage: Usage, headroom: float) -> int:
+    """Recommended element count of a pool."""
+    if usage.failures:
+        # The demand above the pool size is unknown
+        return max(usage.count + 1, _scale(usage.count, 2.0 * headroom))
+    return max(1, _scale(usage.peak, headroom))
+
+
+def recommend_depth(usage: Usage, headroom: float) -> int:
+    """Recommended depth of a mailbox class."""
+    if usage.full:
+        return max(usage.depth + 1, _scale(usage.depth, 2.0 * headroom))
+    return max(2, _scale(usage.max_fill, headroom))
+
+
+@dataclass
+class Profile:
+    """Everything read from a recording."""
+
+    frames: int = 0
+    duration_s: float = 0.0
+    reboots: int = 0
+    heap: Usage = field(default_factory=lambda: Usage("heap", "MEM_SIZE"))
+    pools: dict[str, Usage] = field(default_factory=dict)
+    sys_pools: dict[str, Usage] = field(default_factory=dict)
+
+
+def load_profile(path: str) -> Profile:
+    """Fold the frames of a recording into per-pool usage."""
+    profile = Profile()
+    last_uptime = None
+
+    with open(path, encoding="utf-8") as source:
+        for line_number, line in enumerate(source, 1):
+            if not line.strip():
+                continue
+            try:
+                record = json.loads(line)
+            except json.JSONDecodeError as exc:
+                raise ValueError(f"{path}:{line_number}: {exc}") from exc
+
+            uptime_s = record["uptime_ms"] / 1000.0
+            rebooted = last_uptime is not None and uptime_s < last_uptime
+            if rebooted:
+                profile.reboots += 1
+                profile.duration_s += uptime_s
+            elif last_uptime is not None:
+                profile.duration_s += uptime_s - last_uptime
+            profile.frames += 1
+            last_uptime = uptime_s
+
+            heap = record.get("heap")
+            if heap is not None:
+                profile.heap.update(
+                    uptime_s, heap["avail"], heap["max"], heap["err"], rebooted
+                )
+
+            for pool in record.get("pools", []):
+                usage = profile.pools.setdefault(
+                    pool["name"],
+                    Usage(pool["name"], MEMP_SETTINGS.get(pool["name"])),
+                )
+                usage.size = pool.get("size") or usage.size
+                usage.update(
+                    uptime_s, pool["avail"], pool["max"], pool["err"], rebooted
+                )
+
+            for pool in record.get("sys_pools", []):
+                count_setting, _ = SYS_SETTINGS.get(pool["name"], (None, None))
+                usage = profile.sys_pools.setdefault(
+                    pool["name"], Usage(pool["name"], count_setting)
+                )
+                usage.size = pool["size"]
+                usage.depth = pool["depth"]
+                usage.max_fill = max(usage.max_fill, pool["max_fill"])
+                if rebooted:
+                    usage.last_full = 0
+                if pool["full"] >= usage.last_full:
+                    usage.full += pool["full"] - usage.last_full
+                else:
+                    usage.full += pool["full"]
+                usage.last_full = pool["full"]
+                usage.update(
+                    uptime_s, pool["count"], pool["max"], pool["err"], rebooted
+                )
+
+    return profile
+
+
+def _ram(count: int, size: int | None) -> int | None:
+    return None if size is None else count * size
+
+
+def _bytes(value: int | None) -> str:
+    return "?" if value is None else str(value)
+
+
+def report(profile: Profile, headroom_percent: float) -> list[str]:
+    """Render the recommendations of a profile."""
+    headroom = headroom_percent / 100.0
+    lines = [
+        f"{profile.frames} frames over {profile.duration_s:.0f} s of uptime"
+        + (f", {profile.reboots} reboot(s)" if profile.reboots else "")
+        + f", headroom {headroom_percent:g} %",
+        "",
+        "Allocation failures (uptime s, pool, new failures):",
+    ]
+
+    series = [
+        (t, usage.name, new)
+        for usage in [profile.heap, *profile.pools.values()]
+        + list(profile.sys_pools.values())
+        for t, new in usage.series
+    ]
+    lines.extend(
+        f"  {t:10.1f}  {name:<16} +{new}" for t, name, new in sorted(series)
+    )
+    if not series:
+        lines.append("  none")
+
+    settings: list[tuple[str, int, str]] = []
+    ram_now = 0
+    ram_then = 0
+    unknown_ram = False
+
+    lines += [
+        "",
+        f"{'Pool':<16} {'count':>6} {'peak':>6} {'fail':>5} {'rec':>6} "
+        f"{'RAM now':>8} {'RAM rec':>8}",
+    ]
+
+    heap = profile.heap
+    if heap.count:
+        rec = (
+            math.ceil(recommend_count(heap, headroom) / HEAP_ROUNDING)
+            * HEAP_ROUNDING
+        )
+        lines.append(
+            f"{'heap':<16} {heap.count:>6} {heap.peak:>6} {heap.failures:>5} "
+            f"{rec:>6} {heap.count:>8} {rec:>8}"
+        )
+        ram_now += heap.count
+        ram_then += rec
+        settings.append(
+            ("MEM_SIZE", rec, f"peak {heap.peak} of {heap.count} bytes")
+        )
+
+    recommended: dict[str, int] = {}
+    for usage in profile.pools.values():
+        rec = recommend_count(usage, headroom)
+        recommended[usage.name] = rec
+        now = _ram(usage.count, usage.size)
+        then = _ram(rec, usage.size)
+        lines.append(
+            f"{usage.name:<16} {usage.count:>6} {usage.peak:>6} "
+            f"{usage.failures:>5} {rec:>6} {_bytes(now):>8} {_bytes(then):>8}"
+        )
+        if now is None or then is None:
+            unknown_ram = True
+        else:
+            ram_now += now
+            ram_then += then
+        if usage.setting is not None:
+            note = f"peak {usage.peak} of {usage.count}"
+            if usage.failures:
+                note += f", {usage.failures} failures: run again"
+            settings.append((usage.setting, rec, note))
+
+    for usage in profile.sys_pools.values():
+        rec_count = usage.count
+        rec_depth = usage.depth
+        if usage.setting is not None:
+            rec_count = recommend_count(usage, headroom)
+        elif usage.name == "mbox_conn" and {
+            "NETCONN",
+            "TCP_PCB_LISTEN",
+        } <= recommended.keys():
+            # One receive mailbox per netconn, one accept mailbox per
+            # listener (sys_arch.c)
+            rec_count = recommended["NETCONN"] + recommended["TCP_PCB_LISTEN"]
+        if usage.depth:
+            rec_depth = recommend_depth(usage, headroom)
+
+        size = usage.size
+        rec_size = size
+        if usage.depth and size is not None:
+            rec_size = size + (rec_depth - usage.depth) * POINTER_SIZE
+        now = _ram(usage.count, size)
+        then = _ram(rec_count, rec_size)
+        label = usage.name
+        if usage.depth:
+            label += f" x{usage.depth}"
+        lines.append(
+            f"{label:<16} {usage.count:>6} {usage.peak:>6} "
+            f"{usage.failures:>5} {rec_count:>6} {_bytes(now):>8} "
+            f"{_bytes(then):>8}"
+        )
+        if now is not None and then is not None:
+            ram_now += now
+            ram_then += then
+
+        if usage.setting is not None:
+            note = f"peak {usage.peak} of {usage.count}, sys_arch.c"
+            if usage.failures:
+                note += f", {usage.failures} failures: run again"
+            settings.append((usage.setting, rec_count, note))
+        depth_setting = SYS_SETTINGS.get(usage.name, (None, None))[1]
+        if depth_setting is not None:
+            note = f"deepest {usage.max_fill} of {usage.depth}"
+            if usage.full:
+                note += f", {usage.full} refused posts: run again"
+            settings.append((depth_setting, rec_depth, note))
+
+    lines += ["", "Recommended settings:"]
+    for setting, value, note in settings:
+        if setting in PROFILE_SETTINGS:
+            note += ", per network profile"
+        lines.append(f"#define {setting:<31} {value:<6} /* {note} */")
+
+    lines += [
+        "",
+        f"Pool RAM: {ram_now} bytes now, {ram_then} bytes recommended "
+        f"({ram_then - ram_now:+d})"
+        + (", pool sizes missing from some frames" if unknown_ram else ""),
+    ]
+    return lines
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Recommend lwipopts.h pool sizes from recorded telemetry",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog=__doc__,
+    )
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    record = commands.add_parser(
+        "record", help="Record telemetry frames during a workload"
+    )
+    record.add_argument("output", help="JSON lines file, appended to")
+    record.add_argument(
+        "--bind",
+        default=DEFAULT_BIND,
+        help=f"UDP address to listen on (default: {DEFAULT_BIND})",
+    )
+    record.add_argument(
+        "--port",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"UDP port to listen on (default: {DEFAULT_PORT})",
+    )
+    record.add_argument(
+        "--duration",
+        type=float,
+        default=0.0,
+        help="Stop after DURATION seconds (default: at Ctrl+C)",
+    )
+
+    recommend = commands.add_parser(
+        "recommend", help="Recommend pool sizes from a recording"
+    )
+    recommend.add_argument("input", help="JSON lines file from record")
+    recommend.add_argument(
+        "--headroom",
+        type=float,
+        default=DEFAULT_HEADROOM,
+        help="Headroom above the peak in percent "
+        f"(default: {DEFAULT_HEADROOM})",
+    )
+
+    args = parser.parse_args()
+
+    try:
+        if args.command == "record":
+            return record_udp(args.output, args.bind, args.port, args.duration)
+
+        profile = load_profile(args.input)
+        if profile.frames == 0:
+            print(f"Error: no frames in {args.input}", file=sys.stderr)
+            return 1
+        print("\n".join(report(profile, args.headroom)))
+    except (OSError, ValueError, KeyError) as exc:
+        print(f"Error: {exc}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
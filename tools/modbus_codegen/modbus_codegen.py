@@ -3,7 +3,9 @@
 Modbus Register Code Generator
 
 This tool generates C header and source files from a JSON register definition file.
-It uses Jinja2 templates for flexible code generation.
+It uses Jinja2 templates for flexible code generation. It also writes the
+register map documentation, a Python module of the register map with read
+plans for host tools, and a CAN database when the configuration has one.
 
 Note: Callback implementations are maintained manually in the application source
 directory to allow custom hardware logic.
@@ -17,7 +19,10 @@ Copyright (c) 2026
 import argparse
 import json
 import logging
+import struct
 import sys
+import zlib
+from bisect import bisect_right
 from pathlib import Path
 from typing import Any
 
@@ -41,6 +46,325 @@ logging.basicConfig(
 )
 logger = logging.getLogger(__name__)
 
+# Longest device identification object that fits one FC43/14 response:
+# 253-byte PDU less function code, 6 header bytes, object ID and length
+DEVICE_ID_MAX_OBJECT_LENGTH = 244
+
+# Largest address span, as a multiple of the mapped addresses, of a register
+# map stored direct-indexed; sparser maps are stored as an address run table
+DENSE_MAP_MAX_SPAN_RATIO = 2
+
+# Widest span of addresses of one space a write hook dirty mask covers
+WRITE_HOOK_MAX_SPAN = 64
+
+# Most holding registers written in bulk: limits are numbered from 1 in a
+# byte per slot, 0 marking the others
+BULK_WRITE_MAX_REGISTERS = 255
+
+# Value range of the integer data types, as (signed, bits); float32 limits
+# default to the infinities and uint64 ones stop at the int64 keys
+INTEGER_TYPE_RANGES = {
+    "uint16": (False, 16),
+    "enum": (False, 16),
+    "int16": (True, 16),
+    "uint32": (False, 32),
+    "int32": (True, 32),
+    "uint64": (False, 63),
+}
+
+# Table code of each space in a register snapshot: its Modbus read function
+SNAPSHOT_TABLES = {
+    "coils": 1,
+    "discrete_inputs": 2,
+    "holding_registers": 3,
+    "input_registers": 4,
+}
+
+# Bytes of a snapshot block header: table, reserved, address and count
+SNAPSHOT_BLOCK_HEADER_SIZE = 6
+
+# Largest snapshot block data: one UDP datagram on an Ethernet MTU (1472
+# bytes) less the 16-byte snapshot header
+SNAPSHOT_MAX_DATA_SIZE = 1456
+
+# Registers taken by the multi-register data types; all others take one
+DATA_TYPE_WORDS = {"uint32": 2, "int32": 2, "float32": 2, "uint64": 4}
+
+# Read function code and most addresses of one read request
+# (MODBUS_MAX_READ_* in modbus_config.h) of every space
+READ_SPACES = {
+    "coils": (0x01, 2000),
+    "discrete_inputs": (0x02, 2000),
+    "holding_registers": (0x03, 125),
+    "input_registers": (0x04, 125),
+}
+
+# Vendor-specific Read Scattered Registers function code and most
+# descriptors of one request (MODBUS_SCATTER_MAX_DESCRIPTORS)
+SCATTER_FUNCTION = 0x64
+SCATTER_MAX_DESCRIPTORS = 50
+
+# Address name prefix of every space, as in the generated header
+SPACE_PREFIXES = {
+    "coils": "COIL",
+    "discrete_inputs": "DI",
+    "holding_registers": "HR",
+    "input_registers": "IR",
+}
+
+# Size in bytes and signedness of the CAN signal data types
+CAN_SIGNAL_TYPES = {
+    "uint8": (1, False),
+    "int8": (1, True),
+    "uint16": (2, False),
+    "int16": (2, True),
+    "uint32": (4, False),
+    "int32": (4, True),
+}
+
+# Most interlock rules: one bit each in the tripped and disable registers
+INTERLOCK_MAX_RULES = 16
+
+# Most I2C output expanders (BSP_I2CDO_MAX_EXPANDERS) and outputs of each
+I2C_EXPANDER_MAX = 4
+I2C_EXPANDER_OUTPUTS = 8
+
+# Values of the DBC VFrameFormat message attribute
+DBC_FRAME_FORMATS = [
+    "StandardCAN", "ExtendedCAN", "reserved", "J1939PG", "reserved",
+    "reserved", "reserved", "reserved", "reserved", "reserved", "reserved",
+    "reserved", "reserved", "reserved", "StandardCAN_FD", "ExtendedCAN_FD",
+]
+
+# Functions of the generated Python module, after its tables
+PYTHON_CLIENT_FUNCTIONS = '''
+
+def _join(words: Sequence[int], word_order: str) -> int:
+    """Combine Modbus words, first word most significant unless low_first."""
+    value = 0
+    for word in reversed(words) if word_order == "low_first" else words:
+        value = (value << 16) | (word & 0xFFFF)
+    return value
+
+
+def decode_uint16(words: Sequence[int], word_order: str = "high_first") -> int:
+    """Decode a uint16 (or enum) register."""
+    return words[0] & 0xFFFF
+
+
+def decode_int16(words: Sequence[int], word_order: str = "high_first") -> int:
+    """Decode an int16 register."""
+    value = words[0] & 0xFFFF
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def decode_uint32(words: Sequence[int], word_order: str = "high_first") -> int:
+    """Decode a uint32 from its two words."""
+    return _join(words[:2], word_order)
+
+
+def decode_int32(words: Sequence[int], word_order: str = "high_first") -> int:
+    """Decode an int32 from its two words."""
+    value = _join(words[:2], word_order)
+    return value - 0x100000000 if value & 0x80000000 else value
+
+
+def decode_float32(
+    words: Sequence[int], word_order: str = "high_first"
+) -> float:
+    """Decode an IEEE 754 float32 from its two words."""
+    value = _join(words[:2], word_order)
+    return struct.unpack(">f", struct.pack(">I", value))[0]
+
+
+def decode_uint64(words: Sequence[int], word_order: str = "high_first") -> int:
+    """Decode a uint64 from its four words."""
+    return _join(words[:4], word_order)
+
+
+def decode_bit(words: Sequence[int], word_order: str = "high_first") -> int:
+    """Decode a coil or discrete input."""
+    return 1 if words[0] else 0
+
+
+# Decoder of every data type
+DECODERS: dict[str, Callable[[Sequence[int], str], int | float]] = {
+    "bit": decode_bit,
+    "uint16": decode_uint16,
+    "int16": decode_int16,
+    "enum": decode_uint16,
+    "uint32": decode_uint32,
+    "int32": decode_int32,
+    "float32": decode_float32,
+    "uint64": decode_uint64,
+}
+
+
+def decode(
+    register: Register, words: Sequence[int], raw: bool = False
+) -> int | float:
+    """Decode a register from its words (or its bit) as read.
+
+    The scale factor is applied unless raw.
+    """
+    value = DECODERS[register.data_type](words, register.word_order)
+    if register.scale is not None and not raw:
+        return value * register.scale
+    return value
+
+
+def plan(keys: Iterable[str]) -> list[Read]:
+    """Cover registers with the fewest read requests.
+
+    A request starts at the lowest register of its space not yet covered
+    and takes in the following ones while they lie in the same mapped
+    address run and the request stays within the space's limit; addresses
+    between them that were not asked for are read and dropped. Every
+    request starts as late as it can, so the cover is minimal.
+
+    Args:
+        keys: Register keys, in any order.
+
+    Returns:
+        Requests by space and address.
+
+    Raises:
+        KeyError: If a key is not in REGISTERS.
+    """
+    selected = sorted(
+        {REGISTERS[key] for key in keys},
+        key=lambda reg: (SPACE_ORDER.index(reg.space), reg.address),
+    )
+    reads: list[Read] = []
+    current_run = -1
+    for reg in selected:
+        function, limit = SPACES[reg.space]
+        starts = [start for start, _ in RUNS[reg.space]]
+        run = bisect_right(starts, reg.address) - 1
+        end = reg.address + reg.size
+        last = reads[-1] if reads else None
+        if (
+            last is not None
+            and last.space == reg.space
+            and run == current_run
+            and end - last.start <= limit
+        ):
+            reads[-1] = last._replace(
+                count=end - last.start, keys=(*last.keys, reg.key)
+            )
+        else:
+            reads.append(
+                Read(reg.space, function, reg.address, reg.size, (reg.key,))
+            )
+            current_run = run
+    return reads
+
+
+def plan_groups(groups: Iterable[str]) -> list[Read]:
+    """Cover the registers of groups with the fewest read requests."""
+    return plan(key for group in groups for key in GROUPS[group])
+
+
+def decode_read(
+    read: Read, data: Sequence[int], raw: bool = False
+) -> dict[str, int | float]:
+    """Decode the registers of a request from its words or bits.
+
+    Returns:
+        Value of every register of the request, by key.
+    """
+    values = {}
+    for key in read.keys:
+        reg = REGISTERS[key]
+        offset = reg.address - read.start
+        values[key] = decode(reg, data[offset : offset + reg.size], raw)
+    return values
+
+
+def plan_scatter(keys: Iterable[str]) -> list[Scatter]:
+    """Cover holding and input registers with the fewest FC100 requests.
+
+    Registers next to each other in a space share a descriptor; no address
+    that was not asked for is read. A request takes the descriptors in
+    order while it stays within SCATTER_MAX_DESCRIPTORS and
+    MAX_READ_REGISTERS.
+
+    Args:
+        keys: Register keys, in any order.
+
+    Returns:
+        Requests, their descriptors by space and address.
+
+    Raises:
+        KeyError: If a key is not in REGISTERS.
+        ValueError: If a key is a coil or discrete input.
+    """
+    selected = sorted(
+        {REGISTERS[key] for key in keys},
+        key=lambda reg: (SPACE_ORDER.index(reg.space), reg.address),
+    )
+    descriptors: list[Read] = []
+    for reg in selected:
+        function, _ = SPACES[reg.space]
+        if function not in (0x03, 0x04):
+            raise ValueError(f"{reg.key}: FC100 reads registers only")
+        last = descriptors[-1] if descriptors else None
+        if (
+            last is not None
+            and last.space == reg.space
+            and last.start + last.count == reg.address
+            and last.count + reg.size <= MAX_READ_REGISTERS
+        ):
+            descriptors[-1] = last._replace(
+                count=last.count + reg.size, keys=(*last.keys, reg.key)
+            )
+        else:
+            descriptors.append(
+                Read(reg.space, function, reg.address, reg.size, (reg.key,))
+            )
+
+    requests: list[Scatter] = []
+    for descriptor in descriptors:
+        last = requests[-1] if requests else None
+        if (
+            last is not None
+            and len(last.descriptors) < SCATTER_MAX_DESCRIPTORS
+            and last.count + descriptor.count <= MAX_READ_REGISTERS
+        ):
+            requests[-1] = Scatter(
+                (*last.descriptors, descriptor), last.count + descriptor.count
+            )
+        else:
+            requests.append(Scatter((descriptor,), descriptor.count))
+    return requests
+
+
+def encode_scatter(scatter: Scatter) -> bytes:
+    """Encode the data of an FC100 request, after its function code."""
+    data = b"".join(
+        struct.pack(">BHH", d.function, d.start, d.count)
+        for d in scatter.descriptors
+    )
+    return bytes([len(data)]) + data
+
+
+def decode_scatter(
+    scatter: Scatter, data: Sequence[int], raw: bool = False
+) -> dict[str, int | float]:
+    """Decode the registers of an FC100 request from the words returned.
+
+    Returns:
+        Value of every register of the request, by key.
+    """
+    values: dict[str, int | float] = {}
+    offset = 0
+    for descriptor in scatter.descriptors:
+        words = data[offset : offset + descriptor.count]
+        values.update(decode_read(descriptor, words, raw))
+        offset += descriptor.count
+    return values
+'''
+
 
 class ModbusCodeGenerator:
     """Generates C code from Modbus register JSON configuration."""
@@ -137,18 +461,12 @@ class ModbusCodeGenerator:
             "num_input_registers": len(registers.get("input_registers", [])),
         }
 
-        # Add size information for multi-register types first
-        for reg in registers.get("holding_registers", []):
-            if "size" not in reg:
-                reg["size"] = 1
-            if "data_type" not in reg:
-                reg["data_type"] = "uint16"
-
-        for reg in registers.get("input_registers", []):
-            if "size" not in reg:
-                reg["size"] = 1
-            if "data_type" not in reg:
-                reg["data_type"] = "uint16"
+        # Add type, size and word order information for multi-register types
+        word_order = config.get("device", {}).get("word_order", "high_first")
+        stats["word_order"] = word_order
+        for reg_type in ["holding_registers", "input_registers"]:
+            for reg in registers.get(reg_type, []):
+                self._apply_register_type(reg, word_order)
 
         # Calculate address ranges (accounting for multi-register values)
         for reg_type in ["coils", "discrete_inputs", "holding_registers", "input_registers"]:
@@ -163,9 +481,1174 @@ class ModbusCodeGenerator:
                 stats[f"{reg_type}_min_addr"] = 0
                 stats[f"{reg_type}_max_addr"] = 0
 
+        # Address runs of the word spaces, rejecting overlapping registers
+        stats["holding_register_map"] = self._build_register_map(
+            registers.get("holding_registers", []), "holding register",
+        )
+        stats["input_register_map"] = self._build_register_map(
+            registers.get("input_registers", []), "input register",
+        )
+
+        # Packed bitmap layout for bit spaces (bit n = address min_addr + n)
+        groups = config.get("groups", [])
+        stats["coil_bitmap"] = self._build_bitmap(
+            registers.get("coils", []), stats["coils_min_addr"],
+            stats["coils_max_addr"], groups,
+        )
+        stats["discrete_input_bitmap"] = self._build_bitmap(
+            registers.get("discrete_inputs", []),
+            stats["discrete_inputs_min_addr"],
+            stats["discrete_inputs_max_addr"], groups,
+        )
+
+        stats["write_hooks"] = self._build_write_hooks(registers, groups)
+        stats["bulk_write"] = self._build_bulk_write(
+            registers, groups, stats["holding_register_map"]
+        )
+        stats["snapshot"] = self._build_snapshot(registers, groups)
+        stats["persistent"] = self._build_persistent(registers)
+        stats["opcua"] = self._build_opcua(registers, groups)
+
+        stats["device_id_objects"] = self._build_device_id(config["device"])
+        stats["interlocks"] = self._build_interlocks(
+            config.get("interlocks", [])
+        )
+        stats["i2c_expanders"] = self._build_expanders(registers, groups)
+
         config["stats"] = stats
         return config
 
+    @staticmethod
+    def _build_write_hooks(
+        registers: dict[str, Any], groups: list[dict[str, Any]]
+    ) -> list[dict[str, Any]]:
+        """Compute the write hooks of the groups that ask for one.
+
+        Each hook covers the group's writable coils and holding registers;
+        bit n of the dirty mask it gets is the lowest address of the group
+        in the space written plus n.
+
+        Args:
+            registers: Register definitions (sizes set).
+            groups: Group definitions from the configuration.
+
+        Returns:
+            Hooks in group order, each with its name, description and, per
+            space holding group members, the lowest address and the span.
+
+        Raises:
+            ValueError: If a hooked group has no writable member or spans
+                more addresses of a space than a dirty mask holds.
+        """
+        hooks = []
+        for group in groups:
+            if not group.get("write_hook", False):
+                continue
+            hook: dict[str, Any] = {
+                "name": group["name"],
+                "description": group.get("description", group["name"]),
+            }
+            for space in ["coils", "holding_registers"]:
+                members = [
+                    r for r in registers.get(space, [])
+                    if r.get("group") == group["name"]
+                    and r.get("access", "read_write") == "read_write"
+                ]
+                if not members:
+                    continue
+                low = min(r["address"] for r in members)
+                high = max(r["address"] + r.get("size", 1) - 1 for r in members)
+                if high - low + 1 > WRITE_HOOK_MAX_SPAN:
+                    raise ValueError(
+                        f"write hook group {group['name']} spans "
+                        f"{high - low + 1} {space.replace('_', ' ')}, more "
+                        f"than {WRITE_HOOK_MAX_SPAN}"
+                    )
+                hook[space] = {"address": low, "span": high - low + 1}
+            if "coils" not in hook and "holding_registers" not in hook:
+                raise ValueError(
+                    f"write hook group {group['name']} has no writable "
+                    "coils or holding registers"
+                )
+            hooks.append(hook)
+        return hooks
+
+    @staticmethod
+    def _build_bulk_write(
+        registers: dict[str, Any],
+        groups: list[dict[str, Any]],
+        holding_map: dict[str, Any],
+    ) -> dict[str, Any]:
+        """Compute the limits of the holding registers written in bulk.
+
+        The writable holding registers of the groups marked "bulk_write" are
+        only checked against their min_value and max_value, so a block of
+        them is checked and stored in one pass. Limits are compared as int64
+        keys: integers as their value, float32 as their bit pattern, which
+        orders like the value once the sign bit is turned into a negation.
+
+        Args:
+            registers: Register definitions (sizes set).
+            groups: Group definitions from the configuration.
+            holding_map: Holding register map from _build_register_map.
+
+        Returns:
+            The limits, in address order, each with its register, kind
+            ("unsigned", "signed" or "float") and lowest and highest key, and
+            the slots written in bulk, each with its slot index and limits
+            number (limits index plus 1).
+
+        Raises:
+            ValueError: If a bulk group has no writable holding register,
+                there are more than BULK_WRITE_MAX_REGISTERS of them or a
+                limit does not fit its data type.
+        """
+        names = [g["name"] for g in groups if g.get("bulk_write", False)]
+        members = [
+            r for r in registers.get("holding_registers", [])
+            if r.get("group") in names
+            and r.get("access", "read_write") == "read_write"
+        ]
+        for name in names:
+            if not any(r["group"] == name for r in members):
+                raise ValueError(
+                    f"bulk write group {name} has no writable holding "
+                    "registers"
+                )
+        if len(members) > BULK_WRITE_MAX_REGISTERS:
+            raise ValueError(
+                f"{len(members)} holding registers are written in bulk, more "
+                f"than {BULK_WRITE_MAX_REGISTERS}"
+            )
+
+        limits = []
+        for reg in sorted(members, key=lambda r: r["address"]):
+            data_type = reg.get("data_type", "uint16")
+            if data_type == "float32":
+                low = ModbusCodeGenerator._float_key(
+                    reg.get("min_value", float("-inf"))
+                )
+                high = ModbusCodeGenerator._float_key(
+                    reg.get("max_value", float("inf"))
+                )
+                kind = "float"
+            else:
+                signed, bits = INTEGER_TYPE_RANGES[data_type]
+                first = -(1 << (bits - 1)) if signed else 0
+                last = (1 << (bits - 1 if signed else bits)) - 1
+                low = reg.get("min_value", first)
+                high = reg.get("max_value", last)
+                if (low != int(low) or high != int(high)
+                        or not first <= low <= last
+                        or not first <= high <= last):
+                    raise ValueError(
+                        f"limits of holding register {reg['name']} do not "
+                        f"fit its type {data_type}"
+                    )
+                low, high = int(low), int(high)
+                kind = "signed" if signed else "unsigned"
+            if low > high:
+                raise ValueError(
+                    f"holding register {reg['name']} has min_value above "
+                    "max_value"
+                )
+            limits.append({"reg": reg, "kind": kind, "min": low, "max": high})
+
+        numbers = {id(limit["reg"]): n for n, limit in enumerate(limits, 1)}
+        slots = [
+            {"index": slot["index"], "limit": numbers[id(slot["reg"])]}
+            for slot in holding_map["slots"]
+            if id(slot["reg"]) in numbers
+        ]
+        return {"limits": limits, "slots": slots}
+
+    @staticmethod
+    def _float_key(value: float) -> int:
+        """Order-preserving int64 key of a float32 value.
+
+        Non-negative values keep their bit pattern, negative ones become the
+        negated magnitude bits, so -0.0 and 0.0 share key 0 and every NaN
+        falls outside the infinities.
+        """
+        bits = struct.unpack("<I", struct.pack("<f", value))[0]
+        if bits & 0x80000000:
+            return -(bits & 0x7FFFFFFF)
+        return bits
+
+    @staticmethod
+    def _build_snapshot(
+        registers: dict[str, Any], groups: list[dict[str, Any]]
+    ) -> dict[str, Any]:
+        """Compute the block layout of the register snapshot.
+
+        The snapshot holds every register of the groups marked "snapshot",
+        in group order and per group in space order. Each maximal run of
+        consecutive addresses of one space is a block: a block header and
+        the values, 16-bit words or bits packed LSB first and padded to a
+        whole word.
+
+        Args:
+            registers: Register definitions (sizes set).
+            groups: Group definitions from the configuration.
+
+        Returns:
+            The blocks (table, space, address, count and group), the size of
+            their headers and values in bytes and the layout ID, a CRC-32 of
+            the blocks and of the names and types of their registers.
+
+        Raises:
+            ValueError: If the blocks exceed SNAPSHOT_MAX_DATA_SIZE.
+        """
+        blocks: list[dict[str, Any]] = []
+        layout: list[Any] = []
+        size = 0
+        for group in groups:
+            if not group.get("snapshot", False):
+                continue
+            for space, table in SNAPSHOT_TABLES.items():
+                members = sorted(
+                    (r for r in registers.get(space, [])
+                     if r.get("group") == group["name"]),
+                    key=lambda r: r["address"],
+                )
+                addresses = [
+                    r["address"] + word
+                    for r in members for word in range(r.get("size", 1))
+                ]
+                for address in addresses:
+                    if (blocks and blocks[-1]["space"] == space
+                            and blocks[-1]["group"] == group["name"]
+                            and address == blocks[-1]["address"]
+                            + blocks[-1]["count"]):
+                        blocks[-1]["count"] += 1
+                    else:
+                        blocks.append({
+                            "table": table,
+                            "space": space,
+                            "address": address,
+                            "count": 1,
+                            "group": group["name"],
+                        })
+                layout += [
+                    [table, r["address"], r["name"],
+                     r.get("data_type", "bool")]
+                    for r in members
+                ]
+
+        for block in blocks:
+            if block["table"] <= SNAPSHOT_TABLES["discrete_inputs"]:
+                values = 2 * ((block["count"] + 15) // 16)
+            else:
+                values = 2 * block["count"]
+            size += SNAPSHOT_BLOCK_HEADER_SIZE + values
+
+        if size > SNAPSHOT_MAX_DATA_SIZE:
+            raise ValueError(
+                f"snapshot groups take {size} bytes, more than "
+                f"{SNAPSHOT_MAX_DATA_SIZE}"
+            )
+
+        layout_id = zlib.crc32(
+            json.dumps([blocks, layout], sort_keys=True).encode("utf-8")
+        )
+        return {
+            "blocks": blocks,
+            "size": size,
+            "layout_id": f"0x{layout_id:08X}U",
+        }
+
+    @staticmethod
+    def _build_persistent(registers: dict[str, Any]) -> list[dict[str, Any]]:
+        """Compute the table of the holding registers kept in flash.
+
+        The configuration store saves each register marked "persistent" as
+        one record keyed by its address, so the table is all it needs.
+
+        Args:
+            registers: Register definitions (sizes set).
+
+        Returns:
+            The persistent holding registers in address order, each with its
+            name, address and size in words.
+
+        Raises:
+            ValueError: If a persistent register is read-only, or if a coil,
+                discrete input or input register is marked persistent.
+        """
+        for space in ["coils", "discrete_inputs", "input_registers"]:
+            for reg in registers.get(space, []):
+                if reg.get("persistent", False):
+                    raise ValueError(
+                        f"{reg['name']} is marked persistent, only holding "
+                        "registers are kept"
+                    )
+
+        table = []
+        for reg in sorted(registers.get("holding_registers", []),
+                          key=lambda r: r["address"]):
+            if not reg.get("persistent", False):
+                continue
+            if reg.get("access", "read_write") != "read_write":
+                raise ValueError(
+                    f"persistent register {reg['name']} is read-only"
+                )
+            table.append({
+                "name": reg["name"],
+                "address": reg["address"],
+                "size": reg.get("size", 1),
+            })
+        return table
+
+    @staticmethod
+    def _build_opcua(
+        registers: dict[str, Any], groups: list[dict[str, Any]]
+    ) -> dict[str, Any]:
+        """Compute the address space the OPC UA server builds its nodes from.
+
+        Each group marked "opcua" is a folder, and each of its registers a
+        variable of that folder, in space order and per space in address
+        order. The variables of coils and read-write holding registers are
+        writable.
+
+        Args:
+            registers: Register definitions (sizes set).
+            groups: Group definitions from the configuration.
+
+        Returns:
+            The folders (name and description) and the variables, each with
+            its name, description and unit escaped for a C string literal,
+            scale, table, type, address, size, word order, folder index and
+            whether it is writable.
+
+        Raises:
+            ValueError: If a group marked "opcua" has no registers.
+        """
+        def escape(text: str) -> str:
+            return text.replace("\\", "\\\\").replace('"', '\\"')
+
+        folders: list[dict[str, Any]] = []
+        nodes: list[dict[str, Any]] = []
+        for group in groups:
+            if not group.get("opcua", False):
+                continue
+            folder = len(folders)
+            count = len(nodes)
+            for space, table in SNAPSHOT_TABLES.items():
+                bits = table <= SNAPSHOT_TABLES["discrete_inputs"]
+                writable_space = space in ("coils", "holding_registers")
+                for reg in sorted(
+                    (r for r in registers.get(space, [])
+                     if r.get("group") == group["name"]),
+                    key=lambda r: r["address"],
+                ):
+                    data_type = "bool" if bits else reg["data_type"]
+                    if data_type == "enum":
+                        data_type = "uint16"
+                    nodes.append({
+                        "name": reg["name"],
+                        "description": escape(
+                            reg.get("description", reg["name"])
+                        ),
+                        "unit": escape(reg.get("unit", "")),
+                        "scale": float(reg.get("scale_factor", 1.0)),
+                        "table": table,
+                        "type": data_type.upper(),
+                        "address": reg["address"],
+                        "size": reg.get("size", 1),
+                        "low_first": reg.get("word_order") == "low_first",
+                        "folder": folder,
+                        "writable": writable_space and reg.get(
+                            "access", "read_write"
+                        ) == "read_write",
+                    })
+            if len(nodes) == count:
+                raise ValueError(
+                    f"opcua group {group['name']} has no registers"
+                )
+            folders.append({
+                "name": group["name"],
+                "description": escape(
+                    group.get("description", group["name"])
+                ),
+            })
+        return {"folders": folders, "nodes": nodes}
+
+    @staticmethod
+    def _build_interlocks(rules: list[dict[str, Any]]) -> list[dict[str, Any]]:
+        """Compute the table of the on-device interlock rules.
+
+        A rule trips once its ADC input has been beyond the threshold for
+        the delay, forcing its digital output to its state, and releases once
+        the input is back past the threshold by the hysteresis. Rules sharing
+        an output must force it to the same state.
+
+        Args:
+            rules: Rules from the interlocks section, in table order.
+
+        Returns:
+            The rules with defaults applied, the threshold and hysteresis as
+            C float literals.
+
+        Raises:
+            ValueError: If there are more than INTERLOCK_MAX_RULES rules, two
+                share a name, a hysteresis or delay is negative, or two
+                rules force one output to different states.
+        """
+        if len(rules) > INTERLOCK_MAX_RULES:
+            raise ValueError(
+                f"{len(rules)} interlock rules, more than "
+                f"{INTERLOCK_MAX_RULES}"
+            )
+
+        table = []
+        states: dict[int, tuple[str, bool]] = {}
+        for rule in rules:
+            name = rule["name"]
+            if any(r["name"] == name for r in table):
+                raise ValueError(f"interlock rule {name} defined twice")
+            hysteresis = float(rule.get("hysteresis", 0.0))
+            delay_ms = int(rule.get("delay_ms", 0))
+            if hysteresis < 0.0 or delay_ms < 0:
+                raise ValueError(
+                    f"interlock rule {name} has a negative hysteresis or delay"
+                )
+            output = rule["output"]
+            state = bool(rule["state"])
+            if output in states and states[output][1] != state:
+                raise ValueError(
+                    f"interlock rules {states[output][0]} and {name} force "
+                    f"output {output} to different states"
+                )
+            states.setdefault(output, (name, state))
+            table.append({
+                "name": name,
+                "description": rule.get("description", name),
+                "input": rule["input"],
+                "above": rule["condition"] == "above",
+                "threshold": f"{float(rule['threshold'])!r}f",
+                "hysteresis": f"{hysteresis!r}f",
+                "delay_ms": delay_ms,
+                "output": output,
+                "state": state,
+                "enabled": bool(rule.get("enabled", True)),
+            })
+        return table
+
+    @staticmethod
+    def _build_expanders(
+        registers: dict[str, Any], groups: list[dict[str, Any]]
+    ) -> dict[str, Any] | None:
+        """Compute the I2C expanders driving the coils of a group.
+
+        The group's coils are the digital outputs in address order, eight to
+        an expander: coil n of the group drives bit n % 8 of expander n / 8,
+        which is bit n of the BSP output image.
+
+        Args:
+            registers: Register definitions (sizes set).
+            groups: Group definitions from the configuration.
+
+        Returns:
+            The group name and the 7-bit expander addresses, or None if no
+            group lists expanders.
+
+        Raises:
+            ValueError: If more than one group lists expanders, an address
+                is listed twice, or the group's coils are not consecutive
+                addresses eight per expander.
+        """
+        listed = [g for g in groups if "i2c_expanders" in g]
+        if not listed:
+            return None
+        if len(listed) > 1:
+            raise ValueError(
+                "i2c_expanders listed by groups "
+                f"{', '.join(g['name'] for g in listed)}, only one drives "
+                "the outputs"
+            )
+
+        group = listed[0]
+        addresses = list(group["i2c_expanders"])
+        if not 0 < len(addresses) <= I2C_EXPANDER_MAX:
+            raise ValueError(
+                f"group {group['name']} lists {len(addresses)} I2C "
+                f"expanders, 1 to {I2C_EXPANDER_MAX} are driven"
+            )
+        if len(set(addresses)) != len(addresses):
+            raise ValueError(
+                f"group {group['name']} lists an I2C expander twice"
+            )
+
+        coils = sorted(
+            r["address"] for r in registers.get("coils", [])
+            if r.get("group") == group["name"]
+        )
+        outputs = I2C_EXPANDER_OUTPUTS * len(addresses)
+        if len(coils) != outputs or (
+            coils and coils[-1] - coils[0] + 1 != len(coils)
+        ):
+            raise ValueError(
+                f"group {group['name']} has {len(coils)} coils, its "
+                f"{len(addresses)} I2C expanders need {outputs} at "
+                "consecutive addresses"
+            )
+
+        return {"group": group["name"], "addresses": addresses}
+
+    @staticmethod
+    def _build_device_id(device: dict[str, Any]) -> list[dict[str, Any]]:
+        """Compute the Read Device Identification (FC43/14) object table.
+
+        The three basic objects are always present; the regular ones only
+        when the device section sets them.
+
+        Args:
+            device: Device section of the configuration.
+
+        Returns:
+            Objects sorted by ID, each with its name, ASCII value escaped
+            for a C string literal and unescaped length.
+
+        Raises:
+            ValueError: If a value is not ASCII or does not fit a response.
+        """
+        fields = [
+            (0x00, "vendor_name", device.get("vendor_name", "Unknown")),
+            (0x01, "product_code", device.get("product_code", device["name"])),
+            (0x02, "major_minor_revision", device.get("version", "1.0.0")),
+            (0x03, "vendor_url", device.get("vendor_url")),
+            (0x04, "product_name", device.get("product_name")),
+            (0x05, "model_name", device.get("model_name")),
+            (0x06, "user_application_name", device.get("user_application_name")),
+        ]
+
+        objects = []
+        for object_id, name, value in fields:
+            if value is None:
+                continue
+            if not value.isascii() or len(value) > DEVICE_ID_MAX_OBJECT_LENGTH:
+                raise ValueError(
+                    f"device {name} must be ASCII and at most "
+                    f"{DEVICE_ID_MAX_OBJECT_LENGTH} characters"
+                )
+            objects.append({
+                "id": object_id,
+                "name": name,
+                "length": len(value),
+                "value": value.replace("\\", "\\\\").replace('"', '\\"'),
+            })
+        return objects
+
+    @staticmethod
+    def _apply_register_type(reg: dict[str, Any], word_order: str) -> None:
+        """Fill in the data type, size and word order of a register.
+
+        Args:
+            reg: Holding or input register definition, updated in place.
+            word_order: Device default word order.
+
+        Raises:
+            ValueError: If an explicit size does not match the data type.
+        """
+        reg.setdefault("data_type", "uint16")
+        words = DATA_TYPE_WORDS.get(reg["data_type"], 1)
+        reg.setdefault("size", words)
+        if reg["size"] != words:
+            raise ValueError(
+                f"register {reg['name']} of type {reg['data_type']} takes "
+                f"{words} registers, not {reg['size']}"
+            )
+        reg.setdefault("word_order", word_order)
+
+    @staticmethod
+    def _build_register_map(
+        registers: list[dict[str, Any]], kind: str
+    ) -> dict[str, Any]:
+        """Compute the address map layout of a holding or input register space.
+
+        Every mapped address gets one slot naming its register and word.
+        Maximal runs of consecutive mapped addresses are sorted by address,
+        so the run holding an address is found by binary search. A map whose
+        span is at most DENSE_MAP_MAX_SPAN_RATIO times its mapped addresses
+        is direct-indexed instead: its slots are indexed by the offset from
+        the lowest address and gaps stay empty.
+
+        Args:
+            registers: Holding or input register definitions (sizes set).
+            kind: Register type for error messages.
+
+        Returns:
+            Dense flag, span, number of slots, the slots (register, word,
+            right shift selecting the word from the value and slot index) and
+            the runs (start, count and first slot index).
+
+        Raises:
+            ValueError: If two registers share an address or a register
+                extends past address 65535.
+        """
+        owners: dict[int, tuple[dict[str, Any], int]] = {}
+        for reg in registers:
+            for word in range(reg["size"]):
+                address = reg["address"] + word
+                if address > 0xFFFF:
+                    raise ValueError(
+                        f"{kind} {reg['name']} extends past address 65535"
+                    )
+                if address in owners:
+                    raise ValueError(
+                        f"{kind} {reg['name']} at {reg['address']} overlaps "
+                        f"{owners[address][0]['name']} at address {address}"
+                    )
+                owners[address] = (reg, word)
+
+        addresses = sorted(owners)
+        runs: list[dict[str, int]] = []
+        for index, address in enumerate(addresses):
+            if runs and address == runs[-1]["start"] + runs[-1]["count"]:
+                runs[-1]["count"] += 1
+            else:
+                runs.append({"start": address, "count": 1, "slot": index})
+
+        span = addresses[-1] - addresses[0] + 1 if addresses else 0
+        dense = span <= DENSE_MAP_MAX_SPAN_RATIO * len(addresses)
+        slots = [
+            {
+                "reg": owners[address][0],
+                "word": owners[address][1],
+                "shift": ModbusCodeGenerator._word_shift(*owners[address]),
+                "index": address - addresses[0] if dense else index,
+            }
+            for index, address in enumerate(addresses)
+        ]
+
+        return {
+            "dense": dense,
+            "span": span,
+            "size": span if dense else len(addresses),
+            "slots": slots,
+            "runs": runs,
+        }
+
+    @staticmethod
+    def _word_shift(reg: dict[str, Any], word: int) -> int:
+        """Right shift selecting one Modbus word of a register value."""
+        if reg.get("word_order", "high_first") == "low_first":
+            return 16 * word
+        return 16 * (reg["size"] - 1 - word)
+
+    @staticmethod
+    def _build_bitmap(
+        bits: list[dict[str, Any]],
+        min_addr: int,
+        max_addr: int,
+        groups: list[dict[str, Any]],
+    ) -> dict[str, Any]:
+        """Compute the packed bitmap layout of a coil or discrete input space.
+
+        Args:
+            bits: Coil or discrete input definitions.
+            min_addr: Lowest address of the space.
+            max_addr: Highest address of the space.
+            groups: Group definitions from the configuration.
+
+        Returns:
+            Word count, constant mask words (mapped, writable, defaults) and
+            the contiguous groups of at most 32 bits that can be accessed as
+            one word.
+        """
+        num_words = (max_addr - min_addr) // 32 + 1
+        masks = {"mapped": [0] * num_words, "writable": [0] * num_words,
+                 "defaults": [0] * num_words}
+
+        for bit in bits:
+            offset = bit["address"] - min_addr
+            word, mask = offset // 32, 1 << (offset % 32)
+            masks["mapped"][word] |= mask
+            if bit.get("access", "read_write") == "read_write":
+                masks["writable"][word] |= mask
+            if bit.get("default_value", False):
+                masks["defaults"][word] |= mask
+
+        word_groups = []
+        for group in groups:
+            addresses = sorted(
+                b["address"] for b in bits if b.get("group") == group["name"]
+            )
+            if (addresses and len(addresses) <= 32
+                    and addresses[-1] - addresses[0] + 1 == len(addresses)):
+                word_groups.append({
+                    "name": group["name"],
+                    "description": group.get("description", group["name"]),
+                    "address": addresses[0],
+                    "count": len(addresses),
+                })
+
+        layout: dict[str, Any] = {
+            name: [f"0x{value:08X}U" for value in values]
+            for name, values in masks.items()
+        }
+        layout["words"] = num_words
+        layout["groups"] = word_groups
+        return layout
+
+    @staticmethod
+    def _build_read_plan(
+        items: list[tuple[int, int]],
+        runs: list[dict[str, int]],
+        limit: int,
+    ) -> list[dict[str, Any]]:
+        """Cover registers of one space with the fewest read requests.
+
+        A request starts at the lowest register not yet covered and takes in
+        the following ones while they lie in the same mapped address run and
+        the request stays within limit; addresses between them that were not
+        asked for are read and dropped. Every request starts as late as it
+        can, so the cover is minimal. The generated Python module plans the
+        same way at run time.
+
+        Args:
+            items: Address and size of the registers to read.
+            runs: Mapped address runs of the space (_build_register_map).
+            limit: Most addresses of one request.
+
+        Returns:
+            Requests in address order: start, count and the indices into
+            items of the registers returned.
+        """
+        starts = [run["start"] for run in runs]
+        requests: list[dict[str, Any]] = []
+        current_run = -1
+        for index in sorted(range(len(items)), key=lambda i: items[i][0]):
+            address, size = items[index]
+            run = bisect_right(starts, address) - 1
+            end = address + size
+            if (
+                requests
+                and run == current_run
+                and end - requests[-1]["start"] <= limit
+            ):
+                requests[-1]["count"] = end - requests[-1]["start"]
+                requests[-1]["items"].append(index)
+            else:
+                requests.append(
+                    {"start": address, "count": size, "items": [index]}
+                )
+                current_run = run
+        return requests
+
+    @staticmethod
+    def _build_can_signals(message: dict[str, Any]) -> list[dict[str, Any]]:
+        """Expand the signals of a CAN message into single DBC signals.
+
+        A signal with a count above one becomes one signal per repetition,
+        named with the suffix _0, _1, ... and step_bytes apart.
+
+        Args:
+            message: Message definition from the can section.
+
+        Returns:
+            Signals in message order, each with its name, start bit, size in
+            bits, signedness, scale factor, raw value range, unit and
+            description.
+
+        Raises:
+            ValueError: If a signal does not fit the message or overlaps
+                another one.
+        """
+        used: set[int] = set()
+        signals = []
+        for signal in message["signals"]:
+            size, signed = CAN_SIGNAL_TYPES[signal["data_type"]]
+            count = signal.get("count", 1)
+            step = signal.get("step_bytes", size)
+            for i in range(count):
+                start = signal["start_byte"] + i * step
+                name = signal["name"] if count == 1 else f"{signal['name']}_{i}"
+                span = set(range(start, start + size))
+                if start + size > message["length"] or span & used:
+                    raise ValueError(
+                        f"CAN signal {name} does not fit message "
+                        f"{message['name']} or overlaps another signal"
+                    )
+                used |= span
+                bits = size * 8
+                signals.append({
+                    "name": name,
+                    "start_bit": start * 8,
+                    "bits": bits,
+                    "signed": signed,
+                    "scale": signal.get("scale_factor", 1),
+                    "min": -(1 << (bits - 1)) if signed else 0,
+                    "max": (1 << (bits - 1)) - 1 if signed else (1 << bits) - 1,
+                    "unit": signal.get("unit", ""),
+                    "description": signal.get("description", ""),
+                })
+        return signals
+
+    def generate_can_database(
+        self,
+        config: dict[str, Any],
+        output_path: Path,
+    ) -> Path:
+        """Generate a DBC file of the CAN messages.
+
+        All signals are little-endian (Intel). The bus type, the default bit
+        rates and the frame format and bit rate switching of every message
+        are written as the usual Vector attributes.
+
+        Args:
+            config: Configuration dictionary with a can section.
+            output_path: Path to write the DBC file.
+
+        Returns:
+            Path to the generated DBC file.
+        """
+        can = config["can"]
+        node = config["device"]["name"]
+
+        def number(value: float) -> str:
+            return f"{value:.10g}"
+
+        def text(value: str) -> str:
+            return value.replace("\\", "\\\\").replace('"', '\\"')
+
+        lines = ['VERSION ""', "", "NS_ :", "", "BS_:", "", f"BU_: {node}", ""]
+        comments = []
+        attributes = []
+
+        for message in can["messages"]:
+            msg_id = message["id"]
+            lines.append(
+                f"BO_ {msg_id} {message['name']}: {message['length']} {node}"
+            )
+            for sig in self._build_can_signals(message):
+                sign = "-" if sig["signed"] else "+"
+                lines.append(
+                    f" SG_ {sig['name']} : {sig['start_bit']}|{sig['bits']}"
+                    f"@1{sign} ({number(sig['scale'])},0) "
+                    f"[{number(sig['min'] * sig['scale'])}|"
+                    f"{number(sig['max'] * sig['scale'])}] "
+                    f'"{text(sig["unit"])}" Vector__XXX'
+                )
+                if sig["description"]:
+                    comments.append(
+                        f'CM_ SG_ {msg_id} {sig["name"]} '
+                        f'"{text(sig["description"])}";'
+                    )
+            lines.append("")
+            if message.get("description"):
+                comments.append(
+                    f'CM_ BO_ {msg_id} "{text(message["description"])}";'
+                )
+            fd = message.get("fd", False)
+            frame_format = "StandardCAN_FD" if fd else "StandardCAN"
+            attributes.append(
+                f'BA_ "VFrameFormat" BO_ {msg_id} '
+                f"{DBC_FRAME_FORMATS.index(frame_format)};"
+            )
+            attributes.append(
+                f'BA_ "CANFD_BRS" BO_ {msg_id} '
+                f'{1 if fd and message.get("brs", False) else 0};'
+            )
+
+        nominal = can["nominal_bitrate"]
+        data = can.get("data_bitrate", nominal)
+        formats = ",".join(f'"{name}"' for name in DBC_FRAME_FORMATS)
+        lines.extend(comments)
+        lines.append("")
+        lines.extend([
+            'BA_DEF_ "BusType" STRING ;',
+            'BA_DEF_ "Baudrate" INT 10000 1000000;',
+            'BA_DEF_ "BaudrateCANFD" INT 10000 8000000;',
+            f'BA_DEF_ BO_ "VFrameFormat" ENUM {formats};',
+            'BA_DEF_ BO_ "CANFD_BRS" ENUM "0","1";',
+            'BA_DEF_DEF_ "BusType" "CAN FD";',
+            f'BA_DEF_DEF_ "Baudrate" {nominal};',
+            f'BA_DEF_DEF_ "BaudrateCANFD" {data};',
+            'BA_DEF_DEF_ "VFrameFormat" "StandardCAN";',
+            'BA_DEF_DEF_ "CANFD_BRS" "0";',
+            'BA_ "BusType" "CAN FD";',
+            f'BA_ "Baudrate" {nominal};',
+            f'BA_ "BaudrateCANFD" {data};',
+        ])
+        lines.extend(attributes)
+        lines.append("")
+
+        output_path.parent.mkdir(parents=True, exist_ok=True)
+        output_path.write_text("\n".join(lines), encoding="utf-8")
+        logger.info("Generated: %s", output_path)
+
+        return output_path
+
+    def generate_python_client(
+        self,
+        config: dict[str, Any],
+        output_path: Path,
+    ) -> Path:
+        """Generate a Python module of the register map for host tools.
+
+        The module holds the address of every register, named as in the
+        generated header without the device prefix, a Register entry with
+        the type, word order and scale factor of each, the mapped address
+        runs of every space, decoders of the data types and the read plan
+        (_build_read_plan) of every group and of the whole map. Its plan()
+        covers any other selection the same way.
+
+        A register is keyed by its name, or by <space>.<name> if several
+        spaces have the name.
+
+        Args:
+            config: Configuration dictionary (preprocessed).
+            output_path: Path to write the Python module.
+
+        Returns:
+            Path to the generated module.
+        """
+        device = config["device"]
+        registers = config.get("registers", {})
+        word_order = config["stats"]["word_order"]
+
+        spaces: dict[str, list[dict[str, Any]]] = {}
+        runs: dict[str, list[dict[str, int]]] = {}
+        for space in READ_SPACES:
+            defs = sorted(registers.get(space, []), key=lambda r: r["address"])
+            if space in ("coils", "discrete_inputs"):
+                defs = [
+                    dict(reg, size=1, data_type="bit", word_order=word_order)
+                    for reg in defs
+                ]
+            spaces[space] = defs
+            runs[space] = self._build_register_map(
+                defs, space.replace("_", " ").rstrip("s")
+            )["runs"]
+
+        names = [reg["name"] for defs in spaces.values() for reg in defs]
+
+        def key(space: str, reg: dict[str, Any]) -> str:
+            if names.count(reg["name"]) == 1:
+                return reg["name"]
+            return f"{space}.{reg['name']}"
+
+        def literal(value: Any) -> str:
+            if isinstance(value, str):
+                return json.dumps(value)
+            return repr(value)
+
+        def pack(items: list[str], indent: str) -> list[str]:
+            lines: list[str] = []
+            for item in items:
+                if lines and len(lines[-1]) + len(item) + 2 <= 80:
+                    lines[-1] += f" {item},"
+                else:
+                    lines.append(f"{indent}{item},")
+            return lines
+
+        def read_plan(keys: set[str], indent: str) -> list[str]:
+            lines = []
+            for space, (function, limit) in READ_SPACES.items():
+                selected = [
+                    reg for reg in spaces[space] if key(space, reg) in keys
+                ]
+                items = [(reg["address"], reg["size"]) for reg in selected]
+                for request in self._build_read_plan(
+                    items, runs[space], limit
+                ):
+                    lines.append(
+                        f'{indent}Read("{space}", {function}, '
+                        f'{request["start"]}, {request["count"]}, ('
+                    )
+                    lines.extend(pack(
+                        [literal(key(space, selected[i]))
+                         for i in request["items"]],
+                        indent + "    ",
+                    ))
+                    lines.append(f"{indent})),")
+            return lines
+
+        name = device["name"]
+        lines = [
+            '"""',
+            f"{name} Register Map",
+            "",
+            "Generated by modbus_codegen.py from the register configuration; "
+            "do not edit.",
+            "",
+            f"Addresses, types and scale factors of the {name} registers, the",
+            "mapped address runs of every space, decoders of the data types "
+            "and",
+            "read plans: the fewest FC01 to FC04 requests covering a set of",
+            "registers within the MODBUS_MAX_READ_* limits, never across an",
+            "unmapped address (which the device answers with exception 02).",
+            "plan_scatter() packs holding and input registers from anywhere "
+            "in",
+            "the map into vendor-specific FC100 requests instead, one round "
+            "trip",
+            "for up to 125 of them.",
+            "",
+            "Usage:",
+            f"    import {output_path.stem} as regs",
+            "",
+            '    for read in regs.PLANS["adc_values"]:',
+            "        data = read_function(read.function, read.start, "
+            "read.count)",
+            "        values.update(regs.decode_read(read, data))",
+            "",
+            "    for scatter in regs.plan_scatter(keys):",
+            "        data = request(regs.SCATTER_FUNCTION, "
+            "regs.encode_scatter(scatter))",
+            "        values.update(regs.decode_scatter(scatter, data))",
+            '"""',
+            "",
+            "from __future__ import annotations",
+            "",
+            "import struct",
+            "from bisect import bisect_right",
+            "from collections.abc import Callable, Iterable, Sequence",
+            "from typing import NamedTuple",
+            "",
+            f"DEVICE_NAME = {literal(name)}",
+            f"DEVICE_VERSION = {literal(device.get('version', ''))}",
+            f"WORD_ORDER = {literal(word_order)}",
+            "",
+            "# Most registers and bits of one read request (modbus_config.h)",
+            f"MAX_READ_REGISTERS = {READ_SPACES['holding_registers'][1]}",
+            f"MAX_READ_BITS = {READ_SPACES['coils'][1]}",
+            "",
+            "# Read Scattered Registers (FC100, vendor-specific): function "
+            "code and",
+            "# most descriptors of one request",
+            f"SCATTER_FUNCTION = 0x{SCATTER_FUNCTION:02X}",
+            f"SCATTER_MAX_DESCRIPTORS = {SCATTER_MAX_DESCRIPTORS}",
+            "",
+            "# Read function code and most addresses of one request, by space",
+            "SPACES = {",
+            *[
+                f'    "{space}": (0x{function:02X}, MAX_READ_'
+                f'{"BITS" if function <= 0x02 else "REGISTERS"}),'
+                for space, (function, _) in READ_SPACES.items()
+            ],
+            "}",
+            "SPACE_ORDER = tuple(SPACES)",
+            "",
+            "",
+            "class Register(NamedTuple):",
+            '    """One register, coil or discrete input of the map."""',
+            "",
+            "    key: str",
+            "    name: str",
+            "    space: str",
+            "    address: int",
+            "    size: int",
+            '    data_type: str  # "bit" for coils and discrete inputs',
+            "    word_order: str",
+            "    scale: float | None",
+            "    unit: str",
+            "    group: str",
+            "",
+            "",
+            "class Read(NamedTuple):",
+            '    """One read request and the keys of its registers."""',
+            "",
+            "    space: str",
+            "    function: int",
+            "    start: int",
+            "    count: int",
+            "    keys: tuple[str, ...]",
+            "",
+            "",
+            "class Scatter(NamedTuple):",
+            '    """One FC100 request: its descriptors and their registers."""',
+            "",
+            "    descriptors: tuple[Read, ...]",
+            "    count: int",
+            "",
+        ]
+
+        for space, defs in spaces.items():
+            if not defs:
+                continue
+            lines.append("")
+            lines.append(f"# {space.replace('_', ' ').capitalize()}")
+            prefix = SPACE_PREFIXES[space]
+            for reg in defs:
+                lines.append(
+                    f"{prefix}_{self._to_upper_snake_case(reg['name'])} = "
+                    f"{reg['address']}"
+                )
+
+        lines.extend(["", "# Every register by key, by space and address"])
+        lines.append("REGISTERS = {")
+        for space, defs in spaces.items():
+            for reg in defs:
+                lines.append(f"    {literal(key(space, reg))}: Register(")
+                lines.extend(pack([
+                    literal(key(space, reg)),
+                    literal(reg["name"]),
+                    literal(space),
+                    literal(reg["address"]),
+                    literal(reg["size"]),
+                    literal(reg.get("data_type", "uint16")),
+                    literal(reg.get("word_order", word_order)),
+                    literal(reg.get("scale_factor")),
+                    literal(reg.get("unit", "")),
+                    literal(reg.get("group", "")),
+                ], "        "))
+                lines.append("    ),")
+        lines.append("}")
+
+        groups = [group["name"] for group in config.get("groups", [])]
+        members = {
+            group: [
+                key(space, reg)
+                for space, defs in spaces.items()
+                for reg in defs
+                if reg.get("group") == group
+            ]
+            for group in groups
+        }
+        lines.extend(["", "# Keys of the registers of every group"])
+        lines.append("GROUPS = {")
+        for group in groups:
+            lines.append(f"    {literal(group)}: (")
+            lines.extend(pack([literal(k) for k in members[group]], " " * 8))
+            lines.append("    ),")
+        lines.append("}")
+
+        lines.extend(["", "# Mapped address runs of every space: start, count"])
+        lines.append("RUNS = {")
+        for space in READ_SPACES:
+            lines.append(f"    {literal(space)}: (")
+            lines.extend(pack(
+                [f"({run['start']}, {run['count']})" for run in runs[space]],
+                " " * 8,
+            ))
+            lines.append("    ),")
+        lines.append("}")
+
+        lines.extend(["", "# Read plan of every group"])
+        lines.append("PLANS = {")
+        for group in groups:
+            lines.append(f"    {literal(group)}: (")
+            lines.extend(read_plan(set(members[group]), " " * 8))
+            lines.append("    ),")
+        lines.append("}")
+
+        lines.extend(["", "# Read plan of the whole map"])
+        lines.append("PLAN_ALL = (")
+        lines.extend(read_plan(
+            {key(space, reg) for space, defs in spaces.items() for reg in defs},
+            "    ",
+        ))
+        lines.append(")")
+
+        output_path.parent.mkdir(parents=True, exist_ok=True)
+        output_path.write_text(
+            "\n".join(lines) + PYTHON_CLIENT_FUNCTIONS, encoding="utf-8"
+        )
+        logger.info("Generated: %s", output_path)
+
+        return output_path
+
     def generate_register_documentation(
         self,
         config: dict[str, Any],
@@ -195,6 +1678,8 @@ class ModbusCodeGenerator:
         lines.append("")
         lines.append(f"Slave ID:    {device.get('slave_id', 'N/A')}")
         lines.append(f"Version:     {device.get('version', 'N/A')}")
+        word_order = device.get("word_order", "high_first").replace("_", " ")
+        lines.append(f"Word order:  {word_order} (32/64-bit values)")
         lines.append("")
         lines.append("-" * 80)
         lines.append("")
@@ -286,6 +1771,44 @@ class ModbusCodeGenerator:
                 lines.append(f"  {group_name:<20} - {group_desc}")
             lines.append("")
 
+        # Snapshot blocks
+        snapshot = config.get("stats", {}).get("snapshot", {})
+        if snapshot.get("blocks"):
+            lines.append(
+                f"REGISTER SNAPSHOT (layout {snapshot['layout_id'][:-1]}, "
+                f"{snapshot['size']} bytes of blocks)"
+            )
+            lines.append("-" * 80)
+            lines.append(f"{'Table':<8} {'Address':<10} {'Count':<8} Group")
+            lines.append("-" * 80)
+            for block in snapshot["blocks"]:
+                lines.append(
+                    f"{block['table']:<8} {block['address']:<10} "
+                    f"{block['count']:<8} {block['group']}"
+                )
+            lines.append("")
+
+        # Interlock rules
+        interlocks = config.get("stats", {}).get("interlocks", [])
+        if interlocks:
+            lines.append("INTERLOCK RULES")
+            lines.append("-" * 80)
+            lines.append(
+                f"{'Rule':<6} {'Name':<25} {'Input':<7} {'Trip':<18} "
+                f"{'Output':<9} Delay"
+            )
+            lines.append("-" * 80)
+            for index, rule in enumerate(interlocks):
+                sign = ">" if rule["above"] else "<"
+                trip = f"{sign} {rule['threshold'][:-1]} V"
+                output = f"D{rule['output']}={int(rule['state'])}"
+                enabled = "" if rule["enabled"] else " (disabled)"
+                lines.append(
+                    f"{index:<6} {rule['name']:<25} A{rule['input']:<6} "
+                    f"{trip:<18} {output:<9} {rule['delay_ms']} ms{enabled}"
+                )
+            lines.append("")
+
         # Statistics
         stats = config.get("stats", {})
         lines.append("STATISTICS")
@@ -353,6 +1876,17 @@ class ModbusCodeGenerator:
         self.generate_register_documentation(config, doc_path)
         generated_files.append(doc_path)
 
+        # Generate the register map module of the host tools
+        client_path = doc_output_dir / f"{device_name}_registers.py"
+        self.generate_python_client(config, client_path)
+        generated_files.append(client_path)
+
+        # Generate the CAN database of the published messages
+        if "can" in config:
+            dbc_path = doc_output_dir / f"{device_name}_can.dbc"
+            self.generate_can_database(config, dbc_path)
+            generated_files.append(dbc_path)
+
         return generated_files
 
 
@@ -0,0 +1,399 @@
+#!/usr/bin/env python3
+"""
+Modbus Request Replay
+
+Records the Modbus TCP requests a jerry_device receives in the field
+(CMake option JERRY_MODBUS_CAPTURE) and replays them to a device or to the
+host simulation, so that a change can be judged on the traffic the masters
+really send. The stream and record formats are described in
+application/inc/modbus_capture.h.
+
+record saves a capture. summary prints its function codes, range sizes,
+unit IDs, connections and request rate. replay opens one connection per
+captured connection and sends each request at its captured time, divided
+by --speed; a master waits for each response before its next request, as
+the captured ones mostly do, so a slow target shows as lag. It prints the
+response times per function code.
+
+A capture holds no register values. Write requests are therefore replayed
+as reads of the same range unless --allow-writes is given, when they write
+zeros; FC22 keeps the register as it is either way (AND 0xFFFF, OR 0).
+Requests for foreign unit IDs are sent without waiting for an answer.
+
+Usage:
+    python modbus_replay.py record 169.254.4.100 --duration 600 -o site.cap
+    python modbus_replay.py summary site.cap
+    python modbus_replay.py replay site.cap 127.0.0.1 --speed 2
+"""
+
+from __future__ import annotations
+
+import argparse
+import socket
+import statistics
+import struct
+import sys
+import threading
+import time
+from collections import Counter, defaultdict
+from dataclasses import dataclass
+from pathlib import Path
+
+# Default configuration matching the capture task
+DEFAULT_PORT = 5013
+DEFAULT_MODBUS_PORT = 502
+DEFAULT_DURATION = 60.0
+
+# Stream formats (modbus_capture.h)
+CAPTURE_MAGIC = 0x434A
+CAPTURE_VERSION = 1
+REQUEST = struct.Struct("<HBx")
+HEADER = struct.Struct("<HBBI")
+RECORD = struct.Struct("<IHHHHHHBBBB")
+FLAG_FOREIGN = 0x01
+FLAG_LOST = 0x02
+
+MBAP = struct.Struct(">HHHB")
+
+# Write function codes and the read each is replayed as without
+# --allow-writes
+WRITE_AS_READ = {5: 1, 15: 1, 6: 3, 16: 3, 23: 3}
+
+
+class CaptureError(Exception):
+    """Raised for a stream that is not a capture."""
+
+
+@dataclass
+class Record:
+    """One captured request."""
+
+    time_us: int
+    transaction: int
+    length: int
+    address: int
+    quantity: int
+    write_address: int
+    write_quantity: int
+    unit_id: int
+    function: int
+    connection: int
+    flags: int
+
+
+def record_stream(host: str, port: int, duration: float) -> bytes:
+    """Ask the capture task for records and record its stream for a while."""
+    chunks = []
+    end = time.monotonic() + duration
+    with socket.create_connection((host, port), timeout=5.0) as sock:
+        sock.sendall(REQUEST.pack(CAPTURE_MAGIC, CAPTURE_VERSION))
+        sock.settimeout(0.5)
+        while time.monotonic() < end:
+            try:
+                data = sock.recv(65536)
+            except socket.timeout:
+                continue
+            if not data:
+                break
+            chunks.append(data)
+    return b"".join(chunks)
+
+
+def parse_stream(data: bytes) -> tuple[int, list[Record], int]:
+    """Parse a capture into its start second, records and losses.
+
+    The times are unwrapped to microseconds since the start.
+    """
+    if len(data) < HEADER.size:
+        raise CaptureError("stream shorter than its header")
+    magic, version, record_size, start = HEADER.unpack_from(data)
+    if magic != CAPTURE_MAGIC or version != CAPTURE_VERSION:
+        raise CaptureError(f"not a version {CAPTURE_VERSION} capture")
+    if record_size != RECORD.size:
+        raise CaptureError(f"unexpected record size {record_size}")
+
+    records = []
+    lost = 0
+    wraps = 0
+    previous = 0
+    end = HEADER.size + ((len(data) - HEADER.size) // RECORD.size) * RECORD.size
+    for fields in RECORD.iter_unpack(data[HEADER.size : end]):
+        record = Record(*fields)
+        if record.flags & FLAG_LOST:
+            lost += record.time_us
+            continue
+        if record.time_us < previous - (1 << 31):
+            wraps += 1
+        previous = record.time_us
+        record.time_us += wraps << 32
+        records.append(record)
+    return start, records, lost
+
+
+def build_request(record: Record, allow_writes: bool) -> bytes:
+    """Build a request of the captured shape, without its values."""
+    fc = record.function
+    if not allow_writes and fc in WRITE_AS_READ:
+        address = record.address
+        quantity = record.quantity
+        if fc in (5, 6):
+            quantity = 1
+        fc = WRITE_AS_READ[fc]
+        pdu = struct.pack(">BHH", fc, address, quantity)
+    elif fc in (1, 2, 3, 4):
+        pdu = struct.pack(">BHH", fc, record.address, record.quantity)
+    elif fc in (5, 6):
+        pdu = struct.pack(">BHH", fc, record.address, 0)
+    elif fc == 15:
+        count = (record.quantity + 7) // 8
+        pdu = struct.pack(">BHHB", fc, record.address, record.quantity, count)
+        pdu += bytes(count)
+    elif fc == 16:
+        count = 2 * record.quantity
+        pdu = struct.pack(">BHHB", fc, record.address, record.quantity, count)
+        pdu += bytes(count & 0xFF)
+    elif fc == 22:
+        pdu = struct.pack(">BHHH", fc, record.address, 0xFFFF, 0)
+    elif fc == 23:
+        count = 2 * record.write_quantity
+        pdu = struct.pack(
+            ">BHHHHB",
+            fc,
+            record.address,
+            record.quantity,
+            record.write_address,
+            record.write_quantity,
+            count & 0xFF,
+        )
+        pdu += bytes(count & 0xFF)
+    else:
+        # No range: the function code padded to the captured length
+        pdu = bytes([fc]) + bytes(max(record.length - MBAP.size - 1, 0))
+    return (
+        MBAP.pack(record.transaction, 0, len(pdu) + 1, record.unit_id) + pdu
+    )
+
+
+def receive_response(sock: socket.socket) -> None:
+    """Read one whole response frame."""
+    header = b""
+    while len(header) < 6:
+        chunk = sock.recv(6 - len(header))
+        if not chunk:
+            raise ConnectionError("connection closed by the target")
+        header += chunk
+    remaining = struct.unpack(">H", header[4:6])[0]
+    while remaining > 0:
+        chunk = sock.recv(remaining)
+        if not chunk:
+            raise ConnectionError("connection closed by the target")
+        remaining -= len(chunk)
+
+
+class Master(threading.Thread):
+    """Replays the requests of one captured connection."""
+
+    def __init__(
+        self,
+        records: list[Record],
+        target: tuple[str, int],
+        start: float,
+        args: argparse.Namespace,
+    ) -> None:
+        super().__init__(daemon=True)
+        self.records = records
+        self.target = target
+        self.start_time = start
+        self.speed = args.speed
+        self.allow_writes = args.allow_writes
+        self.results: list[tuple[int, float, float]] = []
+        self.error: str | None = None
+
+    def run(self) -> None:
+        try:
+            with socket.create_connection(self.target, timeout=5.0) as sock:
+                sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                for record in self.records:
+                    due = self.start_time + record.time_us / 1e6 / self.speed
+                    delay = due - time.monotonic()
+                    if delay > 0:
+                        time.sleep(delay)
+                    sent = time.monotonic()
+                    sock.sendall(build_request(record, self.allow_writes))
+                    if record.flags & FLAG_FOREIGN:
+                        continue
+                    receive_response(sock)
+                    self.results.append(
+                        (record.function, time.monotonic() - sent, sent - due)
+                    )
+        except OSError as exc:
+            self.error = str(exc)
+
+
+def print_summary(start: int, records: list[Record], lost: int) -> None:
+    """Print the shape of the traffic of a capture."""
+    seconds = records[-1].time_us / 1e6 if records else 0.0
+    rate = len(records) / seconds if seconds > 0 else 0.0
+    print(
+        f"{len(records)} requests over {seconds:.1f} s ({rate:.1f}/s), "
+        f"{lost} lost, capture started at {start} s\n"
+    )
+
+    print("Function codes:")
+    for fc, count in sorted(Counter(r.function for r in records).items()):
+        sizes = [r.quantity for r in records if r.function == fc]
+        print(
+            f"  FC{fc:02d}  {count:8d}  quantity min {min(sizes)} "
+            f"median {statistics.median(sizes):g} max {max(sizes)}"
+        )
+
+    print("\nUnit IDs:")
+    units = Counter((r.unit_id, bool(r.flags & FLAG_FOREIGN)) for r in records)
+    for (unit, foreign), count in sorted(units.items()):
+        print(f"  {unit:3d}  {count:8d}{'  foreign' if foreign else ''}")
+
+    print("\nConnections:")
+    for connection, count in sorted(
+        Counter(r.connection for r in records).items()
+    ):
+        print(f"  {connection:3d}  {count:8d}")
+
+    gaps = [b.time_us - a.time_us for a, b in zip(records, records[1:])]
+    if gaps:
+        bursts = sum(1 for gap in gaps if gap < 1000)
+        print(
+            f"\nGaps: median {statistics.median(gaps) / 1000:.2f} ms, "
+            f"{bursts} under 1 ms"
+        )
+
+
+def replay(records: list[Record], args: argparse.Namespace) -> int:
+    """Replay a capture and print the response times."""
+    by_connection: dict[int, list[Record]] = defaultdict(list)
+    for record in records:
+        by_connection[record.connection].append(record)
+
+    start = time.monotonic() + 0.5
+    masters = [
+        Master(group, (args.host, args.port), start, args)
+        for group in by_connection.values()
+    ]
+    for master in masters:
+        master.start()
+    for master in masters:
+        master.join()
+
+    failed = [master.error for master in masters if master.error is not None]
+    results = [result for master in masters for result in master.results]
+    if not results:
+        print("No responses", file=sys.stderr)
+        return 1
+
+    print(f"{len(results)} responses, {len(masters)} connections\n")
+    print("FC      count   mean ms    p50 ms    p99 ms   max lag ms")
+    for fc in sorted({fc for fc, _, _ in results}):
+        times = sorted(t for f, t, _ in results if f == fc)
+        lag = max(lag for f, _, lag in results if f == fc)
+        p99 = times[min(len(times) - 1, int(len(times) * 0.99))]
+        print(
+            f"FC{fc:02d} {len(times):8d} {statistics.mean(times) * 1e3:9.3f} "
+            f"{statistics.median(times) * 1e3:9.3f} {p99 * 1e3:9.3f} "
+            f"{lag * 1e3:12.3f}"
+        )
+    for error in failed:
+        print(f"Connection failed: {error}", file=sys.stderr)
+    return 1 if failed else 0
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Record the Modbus requests of a jerry_device and "
+        "replay them",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s record 169.254.4.100 --duration 600 -o site.cap
+  %(prog)s summary site.cap
+  %(prog)s replay site.cap 169.254.4.100
+  %(prog)s replay site.cap 127.0.0.1 --speed 4 --allow-writes
+        """,
+    )
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    record = commands.add_parser("record", help="Save a capture")
+    record.add_argument("host", help="Device IP address")
+    record.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"Capture TCP port (default: {DEFAULT_PORT})",
+    )
+    record.add_argument(
+        "--duration",
+        "-d",
+        type=float,
+        default=DEFAULT_DURATION,
+        help=f"Seconds to record (default: {DEFAULT_DURATION})",
+    )
+    record.add_argument(
+        "--output", "-o", type=Path, required=True, help="Capture file"
+    )
+
+    summary = commands.add_parser("summary", help="Describe a capture")
+    summary.add_argument("capture", type=Path, help="Capture file")
+
+    play = commands.add_parser("replay", help="Replay a capture")
+    play.add_argument("capture", type=Path, help="Capture file")
+    play.add_argument("host", help="Target IP address")
+    play.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_MODBUS_PORT,
+        help=f"Target Modbus TCP port (default: {DEFAULT_MODBUS_PORT})",
+    )
+    play.add_argument(
+        "--speed",
+        "-s",
+        type=float,
+        default=1.0,
+        help="Time scale, 2 replays twice as fast (default: 1)",
+    )
+    play.add_argument(
+        "--allow-writes",
+        action="store_true",
+        help="Send the writes, with zeros, instead of reads of their range",
+    )
+
+    args = parser.parse_args()
+
+    try:
+        if args.command == "record":
+            data = record_stream(args.host, args.port, args.duration)
+            args.output.write_bytes(data)
+        else:
+            data = args.capture.read_bytes()
+        start, records, lost = parse_stream(data)
+    except OSError as exc:
+        print(f"Capture failed: {exc}", file=sys.stderr)
+        return 1
+    except CaptureError as exc:
+        print(f"Bad capture: {exc}", file=sys.stderr)
+        return 1
+
+    if args.command == "replay":
+        if args.speed <= 0:
+            parser.error("--speed must be positive")
+        return replay(records, args)
+
+    if not records:
+        print("No requests", file=sys.stderr)
+        return 1
+    print_summary(start, records, lost)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""
+Modbus/TCP Security Credentials
+
+Writes the credentials of the Modbus/TCP Security server as the C header
+modbus_security.c builds them in from: the CA that issues master
+certificates, the device certificate and the device's private key, all
+in PEM. The key must belong to the certificate.
+
+The default set is the development set of tools/keys, with which anyone
+holding the checkout can impersonate the device or a master. When the
+device key or the CA is of that set the header says so, the build warns
+about it, and refuses it for release builds unless allowed
+(application/dependencies/mbedtls/CMakeLists.txt).
+That set is never committed; asked for while it is missing, it is
+generated here with openssl, once per checkout, together with a master
+certificate for the test tools:
+
+    modbus_dev_ca.pem, modbus_dev_ca_key.pem          CA
+    modbus_dev_server.pem, modbus_dev_server_key.pem  device (jerry.local)
+    modbus_dev_client.pem, modbus_dev_client_key.pem  master
+
+Usage:
+    python modbus_tls_credentials.py -o build/modbus_tls_credentials.h
+    python modbus_tls_credentials.py --ca ca.pem --cert device.pem \\
+        --key device_key.pem -o build/modbus_tls_credentials.h
+"""
+
+from __future__ import annotations
+
+import argparse
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+# Development credentials, the defaults of this tool and of the test tools
+KEYS_DIR = Path(__file__).resolve().parent / "keys"
+DEV_CA = KEYS_DIR / "modbus_dev_ca.pem"
+DEV_CA_KEY = KEYS_DIR / "modbus_dev_ca_key.pem"
+DEV_CERT = KEYS_DIR / "modbus_dev_server.pem"
+DEV_KEY = KEYS_DIR / "modbus_dev_server_key.pem"
+DEV_CLIENT = KEYS_DIR / "modbus_dev_client.pem"
+DEV_CLIENT_KEY = KEYS_DIR / "modbus_dev_client_key.pem"
+
+# Validity of the development certificates, in days
+DEV_DAYS = 7300
+
+# Organization of the development certificates
+DEV_ORG = "Jerry Development"
+
+
+class CredentialError(Exception):
+    """A credential file is not one openssl can read, or does not match."""
+
+
+def openssl(*args: str) -> bytes:
+    """Run openssl, returning its output."""
+    result = subprocess.run(["openssl", *args], capture_output=True, check=False)
+    if result.returncode != 0:
+        message = result.stderr.decode(errors="replace").strip()
+        raise CredentialError(f"openssl {args[0]}: {message}")
+    return result.stdout
+
+
+def generate_key(path: Path) -> None:
+    """Generate a P-256 key."""
+    openssl("ecparam", "-name", "prime256v1", "-genkey", "-noout",
+            "-out", str(path))
+
+
+def generate_cert(path: Path, key: Path, subject: str, extensions: str,
+                  issuer: tuple[Path, Path] | None) -> None:
+    """Generate a certificate, a self-signed CA when there is no issuer."""
+    with tempfile.TemporaryDirectory() as tmp:
+        ext = Path(tmp) / "ext.cnf"
+        ext.write_text(f"[ext]\n{extensions}\n", encoding="utf-8")
+        if issuer is None:
+            openssl("req", "-new", "-x509", "-key", str(key), "-subj", subject,
+                    "-days", str(DEV_DAYS), "-sha256",
+                    "-addext", "basicConstraints=critical,CA:TRUE",
+                    "-addext", "keyUsage=critical,keyCertSign,cRLSign",
+                    "-out", str(path))
+            return
+        csr = Path(tmp) / "req.csr"
+        openssl("req", "-new", "-key", str(key), "-subj", subject,
+                "-out", str(csr))
+        openssl("x509", "-req", "-in", str(csr), "-CA", str(issuer[0]),
+                "-CAkey", str(issuer[1]), "-CAcreateserial",
+                "-CAserial", str(Path(tmp) / "ca.srl"),
+                "-days", str(DEV_DAYS), "-sha256", "-extfile", str(ext),
+                "-extensions", "ext", "-out", str(path))
+
+
+def generate_dev_set() -> None:
+    """Generate the development set of this checkout."""
+    KEYS_DIR.mkdir(parents=True, exist_ok=True)
+    generate_key(DEV_CA_KEY)
+    generate_cert(DEV_CA, DEV_CA_KEY,
+                  f"/O={DEV_ORG}/CN=Jerry Modbus Dev CA", "", None)
+    issuer = (DEV_CA, DEV_CA_KEY)
+    generate_key(DEV_KEY)
+    generate_cert(DEV_CERT, DEV_KEY, f"/O={DEV_ORG}/CN=jerry.local",
+                  "basicConstraints=critical,CA:FALSE\n"
+                  "keyUsage=critical,digitalSignature\n"
+                  "extendedKeyUsage=serverAuth\n"
+                  "subjectAltName=DNS:jerry.local", issuer)
+    generate_key(DEV_CLIENT_KEY)
+    generate_cert(DEV_CLIENT, DEV_CLIENT_KEY,
+                  f"/O={DEV_ORG}/CN=Jerry Dev Master",
+                  "basicConstraints=critical,CA:FALSE\n"
+                  "keyUsage=critical,digitalSignature\n"
+                  "extendedKeyUsage=clientAuth", issuer)
+    print(f"Generated the development credentials in {KEYS_DIR}",
+          file=sys.stderr)
+
+
+def openssl_stdin(data: bytes, *args: str) -> bytes:
+    """Run openssl on data, returning its output."""
+    result = subprocess.run(["openssl", *args], input=data,
+                            capture_output=True, check=False)
+    if result.returncode != 0:
+        message = result.stderr.decode(errors="replace").strip()
+        raise CredentialError(f"openssl {args[0]}: {message}")
+    return result.stdout
+
+
+def public_key(path: Path, certificate: bool) -> bytes:
+    """Read the public key of a certificate or a private key, as DER."""
+    if certificate:
+        pem = openssl("x509", "-in", str(path), "-noout", "-pubkey")
+        return openssl_stdin(pem, "pkey", "-pubin", "-outform", "DER")
+    return openssl("pkey", "-in", str(path), "-pubout", "-outform", "DER")
+
+
+def c_string(name: str, pem: str) -> list[str]:
+    """A PEM file as a string literal macro, one line per PEM line."""
+    lines = [f"#define {name} \\"]
+    pem_lines = pem.strip().splitlines()
+    for index, line in enumerate(pem_lines):
+        last = index == len(pem_lines) - 1
+        lines.append(f'  "{line}\\n"' + ("" if last else " \\"))
+    return lines
+
+
+def generate(ca: Path, cert: Path, key: Path, development: bool) -> str:
+    """Generate the header for a set of credentials."""
+    lines = [
+        "/*",
+        " * Generated by tools/modbus_tls_credentials.py - do not edit",
+        " *",
+        f" * CA {ca.name}, device certificate {cert.name} and its key",
+        f" * {key.name}",
+        " */",
+        "",
+        "#ifndef MODBUS_TLS_CREDENTIALS_H",
+        "#define MODBUS_TLS_CREDENTIALS_H",
+        "",
+        "/* The device key or the CA is of the development set of tools/keys,",
+        "   held by anyone with the checkout */",
+        f"#define MODBUS_TLS_CREDENTIALS_DEVELOPMENT {1 if development else 0}",
+        "",
+    ]
+    lines += c_string("MODBUS_TLS_CA_CERT_PEM", ca.read_text(encoding="ascii"))
+    lines.append("")
+    lines += c_string("MODBUS_TLS_DEVICE_CERT_PEM",
+                      cert.read_text(encoding="ascii"))
+    lines.append("")
+    lines += c_string("MODBUS_TLS_DEVICE_KEY_PEM",
+                      key.read_text(encoding="ascii"))
+    lines.append("")
+    lines.append("#endif /* MODBUS_TLS_CREDENTIALS_H */")
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Write the Modbus/TCP Security credentials as a C header"
+    )
+    parser.add_argument("--ca", type=Path, default=DEV_CA,
+                        help="CA certificate of the masters (PEM)")
+    parser.add_argument("--cert", type=Path, default=DEV_CERT,
+                        help="Device certificate (PEM)")
+    parser.add_argument("--key", type=Path, default=DEV_KEY,
+                        help="Private key of the device certificate (PEM)")
+    parser.add_argument(
+        "-o", "--output", type=Path, required=True, help="Header to write"
+    )
+    args = parser.parse_args()
+
+    dev_paths = (DEV_CA, DEV_CERT, DEV_KEY)
+    chosen = tuple(p.resolve() for p in (args.ca, args.cert, args.key))
+    try:
+        if (chosen == dev_paths) and not all(p.exists() for p in dev_paths):
+            generate_dev_set()
+        device = public_key(args.key, certificate=False)
+        if device != public_key(args.cert, certificate=True):
+            raise CredentialError(f"{args.key} is not the key of {args.cert}")
+        ca = public_key(args.ca, certificate=True)
+        # A device trusting the development CA takes any checkout as master
+        development = (
+            DEV_KEY.exists() and (device == public_key(DEV_KEY, False))
+        ) or (DEV_CA.exists() and (ca == public_key(DEV_CA, True)))
+    except (OSError, CredentialError) as exc:
+        print(f"Error: {exc}", file=sys.stderr)
+        return 1
+
+    code = generate(args.ca, args.cert, args.key, development)
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    # Only rewrite on a change, so the application is not rebuilt for nothing
+    old = args.output.read_text(encoding="utf-8") if args.output.exists() else ""
+    if old != code:
+        args.output.write_text(code, encoding="utf-8")
+    kind = "development credentials" if development else "credentials"
+    print(f"Modbus/TCP Security {kind} {args.cert.name}: {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
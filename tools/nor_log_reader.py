@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+"""
+NOR Log Reader
+
+Fetches and decodes the circular sample and event log that jerry_device
+keeps on its external SPI NOR flash (built with -DJERRY_SPI_NOR=ON). The
+pages of a time range are back-filled over TCP port 5011, or all of them
+read from an image of the flash. Pages whose CRC fails are skipped. The
+format is described in application/inc/nor_log.h.
+
+Usage:
+    python nor_log_reader.py --host 192.168.1.100
+    python nor_log_reader.py --host 192.168.1.100 --start 1767225600 \\
+        --end 1767229200 --csv samples.csv --events events.csv
+    python nor_log_reader.py --image nor.img --csv samples.csv
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import socket
+import struct
+import sys
+from contextlib import ExitStack
+from dataclasses import dataclass
+from typing import BinaryIO, Iterable, Iterator
+
+from telemetry_decoder import crc16_modbus
+
+DEFAULT_PORT = 5011
+
+# Sector header format (nor_log.h)
+LOG_MAGIC = 0x524F4E4A
+LOG_VERSION = 1
+SECTOR_HEADER = struct.Struct("<IHHIIHHBBHIHH")
+
+# Data page format (nor_log.h)
+PAGE_HEADER = struct.Struct("<IBBHQII")
+PAGE_SIZE = 256
+CRC_OFFSET = 254
+ERASED = 0xFFFFFFFF
+PAGE_SAMPLES = 1
+PAGE_EVENTS = 2
+EVENT = struct.Struct("<QBBHi")
+
+# Back-fill request and reply (nor_log.h)
+FILL_MAGIC = 0x424A
+FILL_REQUEST = struct.Struct("<HBBQQI")
+FILL_HEADER = struct.Struct("<HBBHHIHHQQ")
+FILL_STATUS = {1: "malformed request", 2: "no flash mounted"}
+
+# Flash geometry (BSP_SPINOR_SECTOR_SIZE)
+SECTOR_SIZE = 0x10000
+
+# Sample frame spacing of pages without one (NOR_LOG_FRAME_MS at 10 kHz)
+FRAME_SAMPLES = 1000
+FRAME_NS = 100_000_000
+
+EVENT_SOURCES = {1: "interlock", 2: "anomaly"}
+INTERLOCK_KINDS = {1: "tripped", 2: "released", 3: "disabled"}
+
+
+class LogError(Exception):
+    """The node refused the back-fill or the image holds no log."""
+
+
+@dataclass
+class Page:
+    """One valid data page."""
+
+    sequence: int
+    kind: int
+    count: int
+    lost: int
+    time_ns: int
+    first: int
+    spacing: int
+    data: bytes
+
+
+def decode_page(data: bytes) -> Page | None:
+    """Decode a data page, or return None if it is erased or corrupt."""
+    if len(data) < PAGE_SIZE:
+        return None
+    sequence, kind, count, lost, time_ns, first, spacing = (
+        PAGE_HEADER.unpack_from(data)
+    )
+    (crc,) = struct.unpack_from("<H", data, CRC_OFFSET)
+    if sequence == ERASED or crc != crc16_modbus(data[:CRC_OFFSET]):
+        return None
+    if kind not in (PAGE_SAMPLES, PAGE_EVENTS):
+        return None
+    return Page(sequence, kind, count, lost, time_ns, first, spacing, data)
+
+
+def fetch(host: str, port: int, start_ns: int, end_ns: int) -> Iterator[bytes]:
+    """Request a back-fill and yield the raw pages as they arrive.
+
+    Raises:
+        LogError: If the node refuses the request.
+    """
+    with socket.create_connection((host, port), timeout=10.0) as sock:
+        sock.sendall(
+            FILL_REQUEST.pack(FILL_MAGIC, LOG_VERSION, 0, start_ns, end_ns, 0)
+        )
+        stream = sock.makefile("rb")
+        header = stream.read(FILL_HEADER.size)
+        if len(header) < FILL_HEADER.size:
+            raise LogError("connection closed before the reply")
+        (
+            magic,
+            _version,
+            status,
+            page_size,
+            sector_pages,
+            sectors,
+            frame_ms,
+            _,
+            oldest_ns,
+            newest_ns,
+        ) = FILL_HEADER.unpack(header)
+        if magic != FILL_MAGIC:
+            raise LogError("not a back-fill reply")
+        if status != 0:
+            raise LogError(FILL_STATUS.get(status, f"status {status}"))
+        print(
+            f"log: {sectors} sectors of {sector_pages} pages, "
+            f"{frame_ms} ms frames, {oldest_ns / 1e9:.3f} s "
+            f"to {newest_ns / 1e9:.3f} s",
+            file=sys.stderr,
+        )
+        while True:
+            data = stream.read(page_size)
+            if len(data) < page_size:
+                return
+            yield data
+
+
+def read_image(image: BinaryIO) -> Iterator[bytes]:
+    """Yield the data pages of a flash image, oldest sector first.
+
+    Raises:
+        LogError: If no sector holds a log header.
+    """
+    sectors: list[tuple[int, int]] = []
+    offset = 0
+    while True:
+        image.seek(offset)
+        data = image.read(SECTOR_HEADER.size)
+        if len(data) < SECTOR_HEADER.size:
+            break
+        magic, version, _, sequence, sector_size, page_size = (
+            SECTOR_HEADER.unpack(data)[:6]
+        )
+        (crc,) = struct.unpack_from("<H", data, SECTOR_HEADER.size - 2)
+        if (
+            magic == LOG_MAGIC
+            and version == LOG_VERSION
+            and sector_size == SECTOR_SIZE
+            and page_size == PAGE_SIZE
+            and crc == crc16_modbus(data[:-2])
+        ):
+            sectors.append((sequence, offset))
+        offset += SECTOR_SIZE
+    if not sectors:
+        raise LogError("no log sector found")
+
+    for sequence, start in sorted(sectors):
+        image.seek(start + PAGE_SIZE)
+        data = image.read(SECTOR_SIZE - PAGE_SIZE)
+        for page in range(0, len(data) - PAGE_SIZE + 1, PAGE_SIZE):
+            raw = data[page : page + PAGE_SIZE]
+            (page_sequence,) = struct.unpack_from("<I", raw)
+            if page_sequence == ERASED:
+                break
+            if page_sequence == sequence:
+                yield raw
+
+
+def records(
+    pages: Iterable[bytes], channels: int
+) -> Iterator[tuple[str, tuple]]:
+    """Yield ("sample", row), ("event", row) and ("lost", count) records."""
+    frame = struct.Struct(f"<{channels}f")
+    for raw in pages:
+        page = decode_page(raw)
+        if page is None:
+            yield "corrupt", (1,)
+            continue
+        if page.lost:
+            yield "lost", (page.lost,)
+        base = PAGE_HEADER.size
+        if page.kind == PAGE_SAMPLES:
+            spacing = page.spacing or FRAME_SAMPLES
+            for i in range(page.count):
+                means = frame.unpack_from(page.data, base + i * frame.size)
+                time_ns = page.time_ns + i * FRAME_NS if page.time_ns else 0
+                yield "sample", (
+                    (page.first + i * spacing) & 0xFFFFFFFF,
+                    time_ns,
+                    *means,
+                )
+        else:
+            for i in range(page.count):
+                time_ns, source, kind, index, value = EVENT.unpack_from(
+                    page.data, base + i * EVENT.size
+                )
+                name = EVENT_SOURCES.get(source, str(source))
+                if source == 1:
+                    what = INTERLOCK_KINDS.get(kind, str(kind))
+                else:
+                    what = "raised" if kind else "cleared"
+                yield "event", (time_ns, name, what, index, value)
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Back-fill and decode the jerry_device SPI NOR log",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --host 192.168.1.100 --csv samples.csv
+  %(prog)s --host 192.168.1.100 --start 1767225600 --end 1767229200
+  %(prog)s --image nor.img --events events.csv
+
+Times are seconds on the PTP timescale. Exit status is 2 if records
+were lost or pages failed their CRC.
+        """,
+    )
+
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--host", help="Node IP address")
+    source.add_argument("--image", help="Image file of the flash")
+    parser.add_argument(
+        "--port", type=int, default=DEFAULT_PORT, help="Back-fill TCP port"
+    )
+    parser.add_argument(
+        "--start", type=float, default=0.0, help="Start time (default: oldest)"
+    )
+    parser.add_argument(
+        "--end", type=float, default=0.0, help="End time (default: newest)"
+    )
+    parser.add_argument(
+        "--channels", type=int, default=6, help="Channels per sample frame"
+    )
+    parser.add_argument("--csv", default=None, help="Write the samples here")
+    parser.add_argument("--events", default=None, help="Write the events here")
+
+    args = parser.parse_args()
+
+    counts = {"sample": 0, "event": 0, "lost": 0, "corrupt": 0}
+    try:
+        with ExitStack() as stack:
+            sample_writer = None
+            event_writer = None
+            if args.csv:
+                sample_writer = csv.writer(
+                    stack.enter_context(
+                        open(args.csv, "w", newline="", encoding="utf-8")
+                    )
+                )
+                sample_writer.writerow(
+                    [
+                        "sequence",
+                        "time_ns",
+                        *[f"a{ch}_v" for ch in range(args.channels)],
+                    ]
+                )
+            if args.events:
+                event_writer = csv.writer(
+                    stack.enter_context(
+                        open(args.events, "w", newline="", encoding="utf-8")
+                    )
+                )
+                event_writer.writerow(
+                    ["time_ns", "source", "kind", "index", "value"]
+                )
+
+            if args.host:
+                pages = fetch(
+                    args.host,
+                    args.port,
+                    int(args.start * 1e9),
+                    int(args.end * 1e9),
+                )
+            else:
+                pages = read_image(stack.enter_context(open(args.image, "rb")))
+
+            for kind, row in records(pages, args.channels):
+                if kind in ("lost", "corrupt"):
+                    counts[kind] += row[0]
+                    continue
+                counts[kind] += 1
+                writer = sample_writer if kind == "sample" else event_writer
+                if writer is not None:
+                    writer.writerow(row)
+    except (LogError, OSError) as exc:
+        print(f"Error: {exc}", file=sys.stderr)
+        return 1
+
+    print(
+        f"{counts['sample']} frames, {counts['event']} events, "
+        f"{counts['lost']} records lost, {counts['corrupt']} corrupt pages"
+    )
+    return 2 if counts["lost"] or counts["corrupt"] else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,408 @@
+#!/usr/bin/env python3
+"""
+Profile Report
+
+Records the PC samples of a jerry_device (CMake option JERRY_PROFILE) and
+symbolizes them against the ELF file of the same build. The stream and
+sample formats are described in application/inc/profile.h.
+
+The flat profile lists the functions by the samples that fell in them,
+with the share of the run, and the tasks and interrupts by the samples
+taken in them. The folded stacks (--folded) are one line per distinct
+task or interrupt, caller and function with its count, the input of
+flamegraph.pl and speedscope; --svg draws the flame graph itself. The
+caller is the function of the stacked link register, which is the true
+caller only in leaf functions; it is left out where it is the function
+itself or no function.
+
+Usage:
+    python profile_report.py build/jerry_app.elf 169.254.4.100 --duration 10
+    python profile_report.py build/jerry_app.elf 169.254.4.100 --raw run.bin
+    python profile_report.py build/jerry_app.elf --input run.bin --svg flame.svg
+"""
+
+from __future__ import annotations
+
+import argparse
+import bisect
+import html
+import socket
+import struct
+import sys
+import time
+import zlib
+from collections import Counter
+from dataclasses import dataclass
+from pathlib import Path
+
+# Default configuration matching the profile task
+DEFAULT_PORT = 5012
+DEFAULT_DURATION = 5.0
+DEFAULT_TOP = 30
+
+# Stream formats (profile.h)
+PROFILE_MAGIC = 0x504A
+PROFILE_VERSION = 1
+REQUEST = struct.Struct("<HBxI")
+HEADER = struct.Struct("<HBBIHH")
+TASK_ENTRY = struct.Struct("<HBx16s")
+SAMPLE = struct.Struct("<IIHBB")
+FLAG_SECURE = 0x01
+FLAG_LOST = 0x02
+
+# ELF constants
+ELF_MAGIC = b"\x7fELF"
+ELFCLASS32 = 1
+ELFDATA2LSB = 1
+SHT_SYMTAB = 2
+STT_FUNC = 2
+
+# Exceptions of the firmware, IRQ number + 16 (stm32h563xx.h)
+EXCEPTION_NAMES = {
+    11: "SVCall",
+    14: "PendSV",
+    15: "SysTick",
+    22: "FLASH",
+    27: "EXTI0",
+    28: "EXTI1",
+    29: "EXTI2",
+    30: "EXTI3",
+    36: "EXTI9",
+    40: "EXTI13",
+    43: "GPDMA1_Channel0",
+    44: "GPDMA1_Channel1",
+    45: "GPDMA1_Channel2",
+    46: "GPDMA1_Channel3",
+    47: "GPDMA1_Channel4",
+    49: "GPDMA1_Channel6",
+    50: "GPDMA1_Channel7",
+    53: "ADC1",
+    55: "FDCAN1_IT0",
+    61: "TIM2",
+    65: "TIM6",
+    75: "USART2",
+    76: "USART3",
+    80: "LPTIM1",
+    85: "ADC2",
+    90: "USB_DRD_FS",
+    96: "I2C3_EV",
+    97: "I2C3_ER",
+    122: "ETH",
+}
+
+
+class ProfileError(Exception):
+    """Raised when the stream is not a profile of the expected version."""
+
+
+@dataclass
+class Sample:
+    """One PC sample."""
+
+    pc: int
+    lr: int
+    task: int
+    exception: int
+    flags: int
+
+
+class SymbolTable:
+    """Function symbols of a 32-bit little-endian ELF file."""
+
+    def __init__(self, path: Path) -> None:
+        image = path.read_bytes()
+        if (
+            image[:4] != ELF_MAGIC
+            or image[4] != ELFCLASS32
+            or image[5] != ELFDATA2LSB
+        ):
+            raise ValueError(f"{path}: not a little-endian 32-bit ELF file")
+
+        shoff = struct.unpack_from("<I", image, 0x20)[0]
+        shentsize, shnum = struct.unpack_from("<HH", image, 0x2E)
+        sections = [
+            struct.unpack_from("<IIIIIIIIII", image, shoff + i * shentsize)
+            for i in range(shnum)
+        ]
+
+        functions: dict[int, tuple[int, str]] = {}
+        for _, sh_type, _, _, offset, size, link, _, _, entsize in sections:
+            if sh_type != SHT_SYMTAB or entsize == 0:
+                continue
+            strtab = sections[link]
+            strings = image[strtab[4] : strtab[4] + strtab[5]]
+            for pos in range(offset, offset + size, entsize):
+                name, value, sym_size, info, _, _ = struct.unpack_from(
+                    "<IIIBBH", image, pos
+                )
+                if info & 0xF != STT_FUNC or sym_size == 0:
+                    continue
+                end = strings.find(b"\0", name)
+                text = strings[name:end].decode("utf-8", errors="replace")
+                # Thumb functions have bit 0 of their address set
+                functions.setdefault(value & ~1, (sym_size, text))
+
+        self.starts = sorted(functions)
+        self.functions = [functions[start] for start in self.starts]
+
+    def lookup(self, address: int) -> str | None:
+        """Return the function holding an address, or None."""
+        index = bisect.bisect_right(self.starts, address) - 1
+        if index < 0:
+            return None
+        size, name = self.functions[index]
+        return name if address < self.starts[index] + size else None
+
+
+def record_stream(host: str, port: int, rate: int, duration: float) -> bytes:
+    """Ask the profile task for samples and record its stream for a while."""
+    chunks = []
+    end = time.monotonic() + duration
+    with socket.create_connection((host, port), timeout=5.0) as sock:
+        sock.sendall(REQUEST.pack(PROFILE_MAGIC, PROFILE_VERSION, rate))
+        sock.settimeout(0.5)
+        while time.monotonic() < end:
+            try:
+                data = sock.recv(65536)
+            except socket.timeout:
+                continue
+            if not data:
+                break
+            chunks.append(data)
+    return b"".join(chunks)
+
+
+def parse_stream(data: bytes) -> tuple[int, dict[int, str], list[Sample], int]:
+    """Parse a recorded stream into its rate, tasks, samples and losses."""
+    if len(data) < HEADER.size:
+        raise ProfileError("stream shorter than its header")
+    magic, version, sample_size, hz, count, _ = HEADER.unpack_from(data)
+    if magic != PROFILE_MAGIC or version != PROFILE_VERSION:
+        raise ProfileError(f"not a version {PROFILE_VERSION} profile stream")
+    if sample_size != SAMPLE.size:
+        raise ProfileError(f"unexpected sample size {sample_size}")
+    offset = HEADER.size + count * TASK_ENTRY.size
+    if len(data) < offset:
+        raise ProfileError("stream shorter than its task table")
+
+    tasks = {}
+    for i in range(count):
+        number, _, name = TASK_ENTRY.unpack_from(
+            data, HEADER.size + i * TASK_ENTRY.size
+        )
+        tasks[number] = name.split(b"\0", 1)[0].decode(errors="replace")
+
+    samples = []
+    lost = 0
+    end = offset + ((len(data) - offset) // SAMPLE.size) * SAMPLE.size
+    for fields in SAMPLE.iter_unpack(data[offset:end]):
+        sample = Sample(*fields)
+        if sample.flags & FLAG_LOST:
+            lost += sample.pc
+        else:
+            samples.append(sample)
+    return hz, tasks, samples, lost
+
+
+def context_name(sample: Sample, tasks: dict[int, str]) -> str:
+    """Name of the task or interrupt a sample was taken in."""
+    if sample.exception != 0:
+        name = EXCEPTION_NAMES.get(sample.exception)
+        return f"ISR {name or f'exception {sample.exception}'}"
+    return tasks.get(sample.task, f"task {sample.task}")
+
+
+def function_name(sample: Sample, symbols: SymbolTable) -> str:
+    """Name of the function a sample fell in."""
+    if sample.flags & FLAG_SECURE:
+        return "[secure]"
+    name = symbols.lookup(sample.pc)
+    return name if name is not None else f"0x{sample.pc:08x}"
+
+
+def folded_stacks(
+    samples: list[Sample], tasks: dict[int, str], symbols: SymbolTable
+) -> Counter:
+    """Count the samples of each task or interrupt, caller and function."""
+    stacks: Counter = Counter()
+    for sample in samples:
+        frames = [context_name(sample, tasks)]
+        function = function_name(sample, symbols)
+        if not sample.flags & FLAG_SECURE:
+            caller = symbols.lookup(sample.lr & ~1)
+            if caller is not None and caller != function:
+                frames.append(caller)
+        frames.append(function)
+        stacks[";".join(frames)] += 1
+    return stacks
+
+
+def print_flat(
+    samples: list[Sample],
+    tasks: dict[int, str],
+    symbols: SymbolTable,
+    top: int,
+) -> None:
+    """Print the functions and the contexts by their samples."""
+    total = len(samples)
+    functions = Counter(function_name(s, symbols) for s in samples)
+    contexts = Counter(context_name(s, tasks) for s in samples)
+
+    print(f"{'Samples':>8}  {'Share':>6}  Function")
+    for name, count in functions.most_common(top):
+        print(f"{count:8d}  {100.0 * count / total:5.1f}%  {name}")
+    print()
+    print(f"{'Samples':>8}  {'Share':>6}  Task or interrupt")
+    for name, count in contexts.most_common():
+        print(f"{count:8d}  {100.0 * count / total:5.1f}%  {name}")
+
+
+def flame_svg(stacks: Counter, title: str) -> str:
+    """Draw folded stacks as a flame graph, roots at the bottom."""
+    width = 1200.0
+    frame_height = 16
+    total = sum(stacks.values())
+
+    # Merge the stacks into a tree: name -> [count, children]
+    root: dict = {}
+    depth = 0
+    for stack, count in stacks.items():
+        node = root
+        frames = stack.split(";")
+        depth = max(depth, len(frames))
+        for frame in frames:
+            entry = node.setdefault(frame, [0, {}])
+            entry[0] += count
+            node = entry[1]
+
+    height = (depth + 2) * frame_height
+    parts = [
+        f'<svg xmlns="http://www.w3.org/2000/svg" width="{width:.0f}" '
+        f'height="{height}" font-family="monospace" font-size="11">',
+        f'<text x="4" y="12">{html.escape(title)}</text>',
+    ]
+
+    def draw(node: dict, x: float, level: int) -> None:
+        for name, (count, children) in sorted(node.items()):
+            w = width * count / total
+            y = height - (level + 1) * frame_height
+            hue = 20 + (zlib.crc32(name.encode()) % 40)
+            label = html.escape(name)
+            share = 100.0 * count / total
+            parts.append(
+                f"<g><title>{label} ({count} samples, {share:.1f}%)</title>"
+                f'<rect x="{x:.2f}" y="{y}" width="{w:.2f}" '
+                f'height="{frame_height - 1}" fill="hsl({hue},90%,60%)"/>'
+            )
+            if w > 40:
+                chars = int(w / 7)
+                if len(name) > chars:
+                    label = html.escape(name[: chars - 2]) + ".."
+                parts.append(
+                    f'<text x="{x + 2:.2f}" y="{y + 11}">{label}</text>'
+                )
+            parts.append("</g>")
+            draw(children, x, level + 1)
+            x += w
+
+    draw(root, 0.0, 0)
+    parts.append("</svg>")
+    return "\n".join(parts)
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Record jerry_device PC samples and report where the "
+        "CPU time goes",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s build/jerry_app.elf 169.254.4.100 --duration 10
+  %(prog)s build/jerry_app.elf 169.254.4.100 --rate 10000 --raw run.bin
+  %(prog)s build/jerry_app.elf --input run.bin --svg flame.svg
+  %(prog)s build/jerry_app.elf --input run.bin --folded run.folded
+        """,
+    )
+
+    parser.add_argument(
+        "elf", type=Path, help="ELF file of the running firmware"
+    )
+    parser.add_argument("host", nargs="?", help="Device IP address")
+    parser.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"Profile TCP port (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--rate",
+        "-r",
+        type=int,
+        default=0,
+        help="Samples per second, 100 to 20000 (default: the device's, 4999)",
+    )
+    parser.add_argument(
+        "--duration",
+        "-d",
+        type=float,
+        default=DEFAULT_DURATION,
+        help=f"Seconds to record (default: {DEFAULT_DURATION})",
+    )
+    parser.add_argument(
+        "--input", "-i", type=Path, help="Report on a recorded stream instead"
+    )
+    parser.add_argument(
+        "--raw", type=Path, help="Also save the recorded stream"
+    )
+    parser.add_argument("--folded", type=Path, help="Write the folded stacks")
+    parser.add_argument("--svg", type=Path, help="Write the flame graph")
+    parser.add_argument(
+        "--top",
+        type=int,
+        default=DEFAULT_TOP,
+        help=f"Functions in the flat profile (default: {DEFAULT_TOP})",
+    )
+
+    args = parser.parse_args()
+
+    if (args.host is None) == (args.input is None):
+        parser.error("give either a host or --input")
+
+    try:
+        symbols = SymbolTable(args.elf)
+        if args.input is not None:
+            data = args.input.read_bytes()
+        else:
+            data = record_stream(args.host, args.port, args.rate, args.duration)
+            if args.raw is not None:
+                args.raw.write_bytes(data)
+        hz, tasks, samples, lost = parse_stream(data)
+    except (OSError, ValueError) as exc:
+        print(f"Recording failed: {exc}", file=sys.stderr)
+        return 1
+    except ProfileError as exc:
+        print(f"Bad stream: {exc}", file=sys.stderr)
+        return 1
+
+    if not samples:
+        print("No samples", file=sys.stderr)
+        return 1
+
+    seconds = len(samples) / hz
+    print(f"{len(samples)} samples at {hz} Hz, {seconds:.2f} s, {lost} lost\n")
+    print_flat(samples, tasks, symbols, args.top)
+
+    stacks = folded_stacks(samples, tasks, symbols)
+    if args.folded is not None:
+        lines = [f"{stack} {count}" for stack, count in sorted(stacks.items())]
+        args.folded.write_text("\n".join(lines) + "\n", encoding="utf-8")
+    if args.svg is not None:
+        title = f"jerry_app, {len(samples)} samples at {hz} Hz"
+        args.svg.write_text(flame_svg(stacks, title), encoding="utf-8")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
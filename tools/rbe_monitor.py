@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+"""
+Report by Exception Monitor
+
+Subscribes to a block of jerry_device registers and prints the values
+whenever the device reports a change, instead of polling them over Modbus.
+The subscription is renewed every refresh period and dropped on exit. The
+message format is described in application/inc/modbus_rbe.h.
+
+Usage:
+    python rbe_monitor.py --host 169.254.4.100 --table di --count 8
+    python rbe_monitor.py --table hr --count 4 --deadband 10 --holdoff 100
+"""
+
+from __future__ import annotations
+
+import argparse
+import socket
+import struct
+import sys
+import time
+from datetime import datetime
+
+# Default configuration matching the report by exception task
+DEFAULT_HOST = "169.254.4.100"
+DEFAULT_PORT = 5021
+DEFAULT_REFRESH = 10
+
+# Message format (modbus_rbe.h)
+RBE_MAGIC = 0x524A
+RBE_VERSION = 1
+REQUEST = struct.Struct("<HBBBBHHHHH")
+HEADER = struct.Struct("<HBBBBHHHI")
+
+MSG_SUBSCRIBE = 1
+MSG_UNSUBSCRIBE = 2
+MSG_CHANGE = 3
+MSG_REFRESH = 4
+MSG_REJECT = 5
+
+# Tables, by the Modbus read function code
+TABLES = {"coils": 1, "di": 2, "hr": 3, "ir": 4}
+
+
+def build_request(msg_type: int, args: argparse.Namespace) -> bytes:
+    """Build a subscribe or unsubscribe message for the arguments."""
+    return REQUEST.pack(
+        RBE_MAGIC,
+        RBE_VERSION,
+        msg_type,
+        args.id,
+        TABLES[args.table],
+        args.start,
+        args.count,
+        args.deadband,
+        args.refresh,
+        args.holdoff,
+    )
+
+
+def decode_values(table: int, count: int, payload: bytes) -> list[int]:
+    """Decode the values of an update: words, or bits packed LSB first."""
+    if table in (TABLES["coils"], TABLES["di"]):
+        return [(payload[i // 8] >> (i % 8)) & 1 for i in range(count)]
+    return list(struct.unpack_from(f"<{count}H", payload))
+
+
+def monitor(args: argparse.Namespace) -> int:
+    """Subscribe and print updates until interrupted."""
+    table = TABLES[args.table]
+    subscribe = build_request(MSG_SUBSCRIBE, args)
+    target = (args.host, args.port)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(0.5)
+    sock.sendto(subscribe, target)
+
+    last = args.start + args.count - 1
+    print(f"Subscribed to {args.table} {args.start}..{last}")
+    print("Press Ctrl+C to stop\n")
+
+    values: list[int | None] = [None] * args.count
+    last_sequence: int | None = None
+    lost = 0
+    next_renew = time.monotonic() + args.refresh
+    try:
+        while True:
+            if time.monotonic() >= next_renew:
+                next_renew = time.monotonic() + args.refresh
+                sock.sendto(subscribe, target)
+
+            try:
+                data, _ = sock.recvfrom(2048)
+            except socket.timeout:
+                continue
+            if len(data) < HEADER.size:
+                continue
+
+            (
+                magic,
+                version,
+                msg_type,
+                sub_id,
+                _,
+                address,
+                count,
+                sequence,
+                uptime,
+            ) = HEADER.unpack_from(data)
+            if (magic, version, sub_id) != (RBE_MAGIC, RBE_VERSION, args.id):
+                continue
+            if msg_type == MSG_REJECT:
+                print("Subscription rejected")
+                return 1
+
+            if (last_sequence is not None) and (
+                ((sequence - last_sequence) & 0xFFFF) != 1
+            ):
+                lost += (sequence - last_sequence - 1) & 0xFFFF
+            last_sequence = sequence
+
+            offset = address - args.start
+            payload = data[HEADER.size :]
+            for i, value in enumerate(decode_values(table, count, payload)):
+                values[offset + i] = value
+
+            kind = "refresh" if msg_type == MSG_REFRESH else "change "
+            stamp = datetime.now().strftime("%H:%M:%S.%f")[:-3]
+            shown = " ".join("-" if v is None else str(v) for v in values)
+            print(f"[{stamp}] {kind} {uptime} ms @{address}+{count}: {shown}")
+
+    except KeyboardInterrupt:
+        print("\n\nMonitoring stopped.")
+    finally:
+        sock.sendto(build_request(MSG_UNSUBSCRIBE, args), target)
+        sock.close()
+
+    print(f"Updates lost: {lost}")
+    return 0
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Print changes of subscribed jerry_device registers",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --table di --start 0 --count 8
+  %(prog)s --table hr --start 0 --count 4 --deadband 10 --holdoff 100
+        """,
+    )
+
+    parser.add_argument(
+        "--host",
+        "-H",
+        default=DEFAULT_HOST,
+        help=f"Device IP address (default: {DEFAULT_HOST})",
+    )
+    parser.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"Device UDP port (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--table",
+        "-t",
+        choices=sorted(TABLES),
+        default="hr",
+        help="Register table (default: hr)",
+    )
+    parser.add_argument(
+        "--start", "-s", type=int, default=0, help="First address"
+    )
+    parser.add_argument(
+        "--count", "-c", type=int, default=1, help="Number of values"
+    )
+    parser.add_argument(
+        "--deadband",
+        "-d",
+        type=int,
+        default=0,
+        help="Change in register units that is reported (default: any)",
+    )
+    parser.add_argument(
+        "--refresh",
+        "-r",
+        type=int,
+        default=DEFAULT_REFRESH,
+        help=f"Refresh period in seconds (default: {DEFAULT_REFRESH})",
+    )
+    parser.add_argument(
+        "--holdoff",
+        type=int,
+        default=0,
+        help="Shortest interval between two updates in ms (default: none)",
+    )
+    parser.add_argument(
+        "--id", type=int, default=1, help="Subscription ID (default: 1)"
+    )
+
+    return monitor(parser.parse_args())
+
+
+if __name__ == "__main__":
+    sys.exit(main())
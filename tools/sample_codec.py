@@ -0,0 +1,290 @@
+#!/usr/bin/env python3
+"""
+ADC Sample Codec
+
+Decoder of the lossless compression of raw ADC results used by the
+jerry_device UDP stream and USB stick logger, and a bit-exact encoder for
+checking and sizing. Each channel of a block is predicted by the first
+difference or the second-order extrapolation and the residuals are Rice
+coded; a block is never more than one byte per channel larger than the raw
+samples. The format is described in application/inc/sample_codec.h.
+
+Run as a script, it reports the compression of the raw_a<ch> columns of a
+CSV capture (as written by usb_log_reader.py --csv and
+adc_stream_receiver.py --csv) in blocks as the device codes them.
+
+Usage:
+    python sample_codec.py file12.csv
+    python sample_codec.py file12.csv --block 32
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import sys
+from collections.abc import Sequence
+
+# Channel modes (sample_codec.h)
+MODE_VERBATIM = 0xFF
+MODE_ORDER2 = 0x10
+MAX_K = 15
+SAMPLE_BITS = 16
+
+# Frames of the blocks the stream and the logger code (ADC_STREAM_CODEC_BLOCK,
+# USB_LOG_CODEC_BLOCK)
+DEFAULT_BLOCK = 32
+
+
+class CodecError(ValueError):
+    """A bit string that is not a valid encoded block."""
+
+
+def max_size(channels: int, frames: int) -> int:
+    """Largest encoded size of a block (SAMPLE_CODEC_MAX_SIZE)."""
+    return channels * (1 + 2 * frames)
+
+
+def _zigzag(residual: int) -> int:
+    return residual << 1 if residual >= 0 else ((-residual - 1) << 1) | 1
+
+
+def _unzigzag(u: int) -> int:
+    return -(u >> 1) - 1 if u & 1 else u >> 1
+
+
+class _History:
+    """Predictor history of one channel."""
+
+    def __init__(self) -> None:
+        self.last = [0, 0]
+        self.primed = 0
+
+    def predict(self, order2: bool) -> int:
+        if order2 and self.primed >= 2:
+            return 2 * self.last[0] - self.last[1]
+        return self.last[0]
+
+    def remember(self, sample: int) -> None:
+        self.last = [sample, self.last[0]]
+        self.primed = min(self.primed + 1, 2)
+
+
+class _BitReader:
+    """Bit string reader, most significant bit first."""
+
+    def __init__(self, data: bytes, offset: int) -> None:
+        self.data = data
+        self.position = offset * 8
+
+    def bits(self, n: int) -> int:
+        value = 0
+        for _ in range(n):
+            byte = self.position >> 3
+            if byte >= len(self.data):
+                raise CodecError("encoded block truncated")
+            value = (value << 1) | (
+                (self.data[byte] >> (7 - (self.position & 7))) & 1
+            )
+            self.position += 1
+        return value
+
+    def rice(self, k: int) -> int:
+        zeros = 0
+        while self.bits(1) == 0:
+            zeros += 1
+        return (zeros << k) | self.bits(k)
+
+    @property
+    def offset(self) -> int:
+        """Byte offset after the padding of the block."""
+        return (self.position + 7) >> 3
+
+
+class _BitWriter:
+    """Bit string writer, most significant bit first."""
+
+    def __init__(self) -> None:
+        self.value = 0
+        self.count = 0
+
+    def bits(self, value: int, n: int) -> None:
+        self.value = (self.value << n) | (value & ((1 << n) - 1))
+        self.count += n
+
+    def rice(self, u: int, k: int) -> None:
+        self.bits(1, (u >> k) + 1)
+        self.bits(u, k)
+
+    def getvalue(self) -> bytes:
+        pad = -self.count % 8
+        return (self.value << pad).to_bytes((self.count + pad) // 8, "big")
+
+
+class Decoder:
+    """Decodes the blocks of one stream since its sample_codec_init()."""
+
+    def __init__(self, channels: int) -> None:
+        self.history = [_History() for _ in range(channels)]
+
+    def decode(
+        self, data: bytes, count: int, offset: int = 0
+    ) -> tuple[list[tuple[int, ...]], int]:
+        """Decode a block of count frames at offset.
+
+        Returns:
+            The frames and the byte offset after the block.
+
+        Raises:
+            CodecError: If the block is truncated or has a bad mode.
+        """
+        reader = _BitReader(data, offset)
+        columns = []
+        for history in self.history:
+            mode = reader.bits(8)
+            column = []
+            if mode == MODE_VERBATIM:
+                for _ in range(count):
+                    column.append(reader.bits(SAMPLE_BITS))
+                    history.remember(column[-1])
+            else:
+                if mode & ~(MODE_ORDER2 | MAX_K):
+                    raise CodecError(f"bad channel mode {mode:#04x}")
+                order2, k = bool(mode & MODE_ORDER2), mode & MAX_K
+                first = history.primed == 0
+                if first and count:
+                    column.append(reader.bits(SAMPLE_BITS))
+                    history.remember(column[-1])
+                for _ in range(count - len(column)):
+                    sample = history.predict(order2) + _unzigzag(
+                        reader.rice(k)
+                    )
+                    if not 0 <= sample <= 0xFFFF:
+                        raise CodecError("sample out of range")
+                    column.append(sample)
+                    history.remember(sample)
+            columns.append(column)
+        return list(zip(*columns)), reader.offset
+
+
+class Encoder:
+    """Encodes blocks exactly as sample_codec_encode() does."""
+
+    def __init__(self, channels: int) -> None:
+        self.history = [_History() for _ in range(channels)]
+
+    def encode(self, frames: Sequence[Sequence[int]]) -> bytes:
+        """Encode a block of frames."""
+        writer = _BitWriter()
+        for ch, history in enumerate(self.history):
+            self._channel(history, [frame[ch] for frame in frames], writer)
+        return writer.getvalue()
+
+    @staticmethod
+    def _residuals(
+        history: _History, samples: list[int], order2: bool
+    ) -> list[int]:
+        scan = _History()
+        scan.last, scan.primed = list(history.last), history.primed
+        first = 1 if history.primed == 0 else 0
+        if first:
+            scan.remember(samples[0])
+        residuals = []
+        for sample in samples[first:]:
+            residuals.append(_zigzag(sample - scan.predict(order2)))
+            scan.remember(sample)
+        return residuals
+
+    def _channel(
+        self, history: _History, samples: list[int], writer: _BitWriter
+    ) -> None:
+        first = 1 if history.primed == 0 else 0
+        sum1 = sum(self._residuals(history, samples, False))
+        sum2 = sum(self._residuals(history, samples, True))
+        order2 = sum2 < sum1
+        total, coded, k = min(sum1, sum2), len(samples) - first, 0
+        while coded and k < MAX_K and coded << (k + 1) <= total:
+            k += 1
+
+        residuals = self._residuals(history, samples, order2)
+        size = 8 + first * SAMPLE_BITS
+        size += sum((u >> k) + 1 + k for u in residuals)
+        if size >= 8 + len(samples) * SAMPLE_BITS:
+            writer.bits(MODE_VERBATIM, 8)
+            for sample in samples:
+                writer.bits(sample, SAMPLE_BITS)
+        else:
+            writer.bits((MODE_ORDER2 if order2 else 0) | k, 8)
+            if first:
+                writer.bits(samples[0], SAMPLE_BITS)
+            for u in residuals:
+                writer.rice(u, k)
+        for sample in samples:
+            history.remember(sample)
+
+
+def read_csv(path: str) -> list[tuple[int, ...]]:
+    """Read the raw_a<ch> columns of a CSV capture."""
+    with open(path, newline="", encoding="utf-8") as csv_file:
+        reader = csv.reader(csv_file)
+        header = next(reader)
+        columns = [
+            i for i, name in enumerate(header) if name.startswith("raw_a")
+        ]
+        if not columns:
+            raise ValueError(f"{path}: no raw_a<ch> columns")
+        return [tuple(int(row[i]) for i in columns) for row in reader if row]
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Report the compression of a CSV capture",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s file12.csv
+  %(prog)s file12.csv --block 64
+        """,
+    )
+    parser.add_argument("capture", help="CSV capture with raw_a<ch> columns")
+    parser.add_argument(
+        "--block",
+        "-b",
+        type=int,
+        default=DEFAULT_BLOCK,
+        help=f"Frames per encoded block (default: {DEFAULT_BLOCK})",
+    )
+    args = parser.parse_args()
+
+    try:
+        frames = read_csv(args.capture)
+    except (OSError, ValueError) as err:
+        print(f"Error: {err}", file=sys.stderr)
+        return 2
+    if not frames:
+        print("Error: empty capture", file=sys.stderr)
+        return 2
+
+    channels = len(frames[0])
+    encoder, decoder = Encoder(channels), Decoder(channels)
+    size = 0
+    for first in range(0, len(frames), args.block):
+        block = frames[first : first + args.block]
+        data = encoder.encode(block)
+        if decoder.decode(data, len(block))[0] != block:
+            print("Error: round trip mismatch", file=sys.stderr)
+            return 1
+        size += len(data)
+
+    raw = 2 * channels * len(frames)
+    print(
+        f"{len(frames)} frames x {channels} ch: {raw} bytes raw, {size} "
+        f"coded, {8 * size / (channels * len(frames)):.2f} bits/sample, "
+        f"ratio {raw / size:.2f}"
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+Register Snapshot Listener
+
+Joins the multicast group of the jerry_device register snapshots and
+prints every snapshot received. Any number of listeners can run at the same
+time; the device sends each snapshot once. The datagram format is described
+in application/inc/snapshot_publish.h.
+
+Usage:
+    python snapshot_listener.py
+    python snapshot_listener.py --group 239.255.74.1 --port 5023
+    python snapshot_listener.py --config config/jerry_registers.json
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import socket
+import struct
+import sys
+from datetime import datetime
+from pathlib import Path
+
+# Default configuration matching the snapshot publish task
+DEFAULT_GROUP = "239.255.74.1"
+DEFAULT_PORT = 5023
+
+# Datagram format (snapshot_publish.h)
+SNAPSHOT_MAGIC = 0x534A
+SNAPSHOT_VERSION = 1
+HEADER = struct.Struct("<HBBIII")
+BLOCK = struct.Struct("<BBHH")
+
+# Tables, by the Modbus read function code
+TABLES = {
+    1: "coils",
+    2: "discrete_inputs",
+    3: "holding_registers",
+    4: "input_registers",
+}
+
+
+def load_names(path: Path) -> dict[tuple[int, int], str]:
+    """Map (table, address) to register names from the register config."""
+    spaces = {name: table for table, name in TABLES.items()}
+    config = json.loads(path.read_text(encoding="utf-8"))
+    names: dict[tuple[int, int], str] = {}
+    for space, table in spaces.items():
+        for reg in config.get("registers", {}).get(space, []):
+            names[(table, reg["address"])] = reg["name"]
+    return names
+
+
+Block = tuple[int, int, list[int]]
+
+
+def decode(data: bytes) -> tuple[tuple[int, ...], list[Block]]:
+    """Split a snapshot into its header and (table, address, values) blocks."""
+    header = HEADER.unpack_from(data)
+    blocks = []
+    pos = HEADER.size
+    for _ in range(header[2]):
+        table, _, address, count = BLOCK.unpack_from(data, pos)
+        pos += BLOCK.size
+        if table in (1, 2):
+            size = 2 * ((count + 15) // 16)
+            values = [(data[pos + i // 8] >> (i % 8)) & 1 for i in range(count)]
+        else:
+            size = 2 * count
+            values = list(struct.unpack_from(f"<{count}H", data, pos))
+        pos += size
+        blocks.append((table, address, values))
+    return header, blocks
+
+
+def listen(args: argparse.Namespace) -> int:
+    """Print snapshots until interrupted."""
+    names = load_names(args.config) if args.config else {}
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", args.port))
+    membership = struct.pack(
+        "4s4s", socket.inet_aton(args.group), socket.inet_aton(args.interface)
+    )
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, membership)
+
+    print(f"Listening on {args.group}:{args.port}")
+    print("Press Ctrl+C to stop\n")
+
+    layout: int | None = None
+    last_sequence: int | None = None
+    received = 0
+    lost = 0
+    try:
+        while True:
+            data, sender = sock.recvfrom(2048)
+            if len(data) < HEADER.size:
+                continue
+            header, blocks = decode(data)
+            magic, version, _, layout_id, sequence, uptime = header
+            if (magic, version) != (SNAPSHOT_MAGIC, SNAPSHOT_VERSION):
+                continue
+
+            if layout != layout_id:
+                print(f"Layout 0x{layout_id:08X} from {sender[0]}")
+                layout = layout_id
+            if last_sequence is not None:
+                lost += (sequence - last_sequence - 1) & 0xFFFFFFFF
+            last_sequence = sequence
+            received += 1
+
+            if args.quiet:
+                continue
+            stamp = datetime.now().strftime("%H:%M:%S.%f")[:-3]
+            print(f"[{stamp}] #{sequence} {uptime} ms")
+            for table, address, values in blocks:
+                if names:
+                    for i, value in enumerate(values):
+                        name = names.get((table, address + i))
+                        if name is not None:
+                            print(f"  {name:<28} {value}")
+                else:
+                    shown = " ".join(str(v) for v in values)
+                    print(f"  {TABLES.get(table, table)} @{address}: {shown}")
+
+    except KeyboardInterrupt:
+        print("\n\nListening stopped.")
+    finally:
+        sock.close()
+
+    print(f"Snapshots received: {received}, lost: {lost}")
+    return 0
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Print the multicast register snapshots of jerry_device",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s
+  %(prog)s --config config/jerry_registers.json
+  %(prog)s --quiet
+        """,
+    )
+
+    parser.add_argument(
+        "--group",
+        "-g",
+        default=DEFAULT_GROUP,
+        help=f"Multicast group (default: {DEFAULT_GROUP})",
+    )
+    parser.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"UDP port (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--interface",
+        "-i",
+        default="0.0.0.0",
+        help="Address of the local interface to join on (default: any)",
+    )
+    parser.add_argument(
+        "--config",
+        "-c",
+        type=Path,
+        help="Register config, to print the values by register name",
+    )
+    parser.add_argument(
+        "--quiet",
+        "-q",
+        action="store_true",
+        help="Only count snapshots and losses",
+    )
+
+    return listen(parser.parse_args())
+
+
+if __name__ == "__main__":
+    sys.exit(main())
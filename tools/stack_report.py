@@ -0,0 +1,636 @@
+#!/usr/bin/env python3
+"""
+Stack Report
+
+Worst-case stack use of every task of jerry_app and the RAM budget of the
+non-secure region, checked after the link.
+
+The stack use of each function and its direct calls come from the GCC
+call graph files (-fcallgraph-info=su, one .ci file per object). The
+deepest path from a task's entry function, plus the context a switch
+stacks, must fit the task stack taken from the linker map. Interrupts run
+on the main stack: the deepest handlers, one per nesting level, must fit
+_Min_Stack_Size. Calls through function pointers and calls into prebuilt
+libraries are resolved from config/stack_budget.json; whatever it does not
+cover is listed, and the result for that task is a lower bound.
+
+The RAM budget sums the output sections placed in the RAM region of the
+map and lists the largest objects and modules.
+
+Exit status is 1 on a stack or RAM overrun, and with --strict also when a
+result is incomplete.
+
+Usage:
+    python stack_report.py --map build/jerry_app.map --callgraph build
+    python stack_report.py --map build/jerry_app.map --callgraph build \\
+        --exclude "*/jerry_secure_app.dir/*" --output build/stack.txt
+"""
+
+from __future__ import annotations
+
+import argparse
+import fnmatch
+import json
+import os
+import re
+import sys
+from dataclasses import dataclass, field
+
+# Size of a StackType_t
+STACK_WORD_BYTES = 4
+
+# Call graph placeholder of a call through a pointer
+INDIRECT_CALL = "__indirect_call"
+
+# Call graph file syntax (VCG)
+CI_NODE = re.compile(
+    r'node: \{ title: "(?P<title>[^"]*)" label: "(?P<label>[^"]*)"'
+)
+CI_EDGE = re.compile(
+    r'edge: \{ sourcename: "(?P<source>[^"]*)" '
+    r'targetname: "(?P<target>[^"]*)"'
+)
+CI_STACK = re.compile(r"(?P<bytes>\d+) bytes \((?P<qualifier>[a-z,]+)\)")
+
+# Linker map syntax (GNU ld)
+MAP_REGION = re.compile(
+    r"^(?P<name>\S+)\s+0x(?P<origin>[0-9a-fA-F]+)\s+0x(?P<length>[0-9a-fA-F]+)"
+)
+MAP_ADDRESS = re.compile(
+    r"^\s+0x(?P<address>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)"
+    r"(?:\s+(?P<object>\S.*))?$"
+)
+MAP_SECTION = re.compile(
+    r"^(?P<indent>\s?)(?P<name>\.\S+|COMMON)"
+    r"(?:\s+0x(?P<address>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)"
+    r"(?:\s+(?P<object>\S.*))?)?$"
+)
+MAP_ASSIGNMENT = re.compile(
+    r"^\s+0x(?P<value>[0-9a-fA-F]+)\s+(?P<symbol>\w+) = "
+)
+
+# Interrupt and exception handlers, entered on the main stack
+HANDLER = re.compile(
+    r"^(?:\w+_IRQHandler|(?:NMI|HardFault|MemManage|BusFault|UsageFault"
+    r"|SecureFault|DebugMon|SVC|PendSV|SysTick)_Handler)$"
+)
+
+# Number of entries in the largest-object lists
+TOP_COUNT = 12
+
+
+# ==========================================================================
+# Call Graph
+# ==========================================================================
+
+
+@dataclass(eq=False)
+class Function:
+    """Function defined in a compiled object."""
+
+    title: str
+    name: str
+    unit: str
+    stack: int
+    qualifier: str
+    calls: list[str] = field(default_factory=list)
+    indirect: bool = False
+
+
+@dataclass
+class Usage:
+    """Worst-case stack use below a function."""
+
+    depth: int
+    path: list[str]
+    issues: set[str] = field(default_factory=set)
+
+
+class CallGraph:
+    """Functions of all call graph files, with worst-case stack depths.
+
+    Nodes are titled by the symbol name, prefixed by the source file for
+    static functions, and labelled by the plain name. Calls refer to
+    titles; the budget file uses plain names.
+    """
+
+    def __init__(self, budget: dict) -> None:
+        self.units: dict[str, dict[str, Function]] = {}
+        self.globals: dict[str, list[Function]] = {}
+        self.titles: dict[str, list[Function]] = {}
+        self.indirect: dict[str, list[str]] = {
+            name: targets
+            for name, targets in budget.get("indirect_calls", {}).items()
+            if isinstance(targets, list)
+        }
+        self.external: dict[str, int] = {
+            name: size
+            for name, size in budget.get("external_functions", {}).items()
+            if isinstance(size, int)
+        }
+        self._memo: dict[Function, Usage] = {}
+        self._active: set[Function] = set()
+
+    def load(self, root: str, exclude: list[str]) -> int:
+        """Read every .ci file below a directory, return the file count."""
+        count = 0
+        for directory, _, files in os.walk(root):
+            for name in files:
+                path = os.path.join(directory, name)
+                if not name.endswith(".ci"):
+                    continue
+                if any(fnmatch.fnmatch(path, pattern) for pattern in exclude):
+                    continue
+                self._load_file(path)
+                count += 1
+        return count
+
+    def _load_file(self, path: str) -> None:
+        functions: dict[str, Function] = {}
+        with open(path, encoding="utf-8", errors="replace") as ci_file:
+            text = ci_file.read()
+
+        for match in CI_NODE.finditer(text):
+            stack = CI_STACK.search(match["label"])
+            if stack is None:
+                continue
+            function = Function(
+                title=match["title"],
+                name=match["label"].split("\\n", 1)[0],
+                unit=path,
+                stack=int(stack["bytes"]),
+                qualifier=stack["qualifier"],
+            )
+            functions[function.title] = function
+            self.titles.setdefault(function.title, []).append(function)
+            self.globals.setdefault(function.name, []).append(function)
+
+        for match in CI_EDGE.finditer(text):
+            caller = functions.get(match["source"])
+            if caller is None:
+                continue
+            if match["target"] == INDIRECT_CALL:
+                caller.indirect = True
+            elif match["target"] not in caller.calls:
+                caller.calls.append(match["target"])
+
+        self.units[path] = functions
+
+    def find(self, name: str, unit: str | None = None) -> Function | None:
+        """Definition of a function by title or plain name.
+
+        The calling unit is searched first. Of several definitions
+        elsewhere, the one with the largest frame is taken.
+        """
+        functions = self.units.get(unit, {}) if unit is not None else {}
+        if name in functions:
+            return functions[name]
+        for function in functions.values():
+            if function.name == name:
+                return function
+        candidates = self.titles.get(name) or self.globals.get(name)
+        if not candidates:
+            return None
+        return max(candidates, key=lambda function: function.stack)
+
+    def usage(self, function: Function) -> Usage:
+        """Deepest stack use of a function and everything it calls."""
+        if function in self._memo:
+            return self._memo[function]
+
+        self._active.add(function)
+        deepest = Usage(0, [])
+        issues: set[str] = set()
+        if function.qualifier != "static":
+            issues.add(f"{function.name}: {function.qualifier} stack")
+
+        callees = list(function.calls)
+        if function.indirect:
+            targets = self.indirect.get(function.name)
+            if targets is None:
+                issues.add(f"{function.name}: unresolved indirect call")
+            else:
+                callees.extend(targets)
+
+        for callee in callees:
+            below = self._callee_usage(callee, function.unit)
+            issues |= below.issues
+            if below.depth > deepest.depth:
+                deepest = below
+
+        self._active.discard(function)
+        result = Usage(
+            function.stack + deepest.depth,
+            [f"{function.name} ({function.stack})", *deepest.path],
+            issues,
+        )
+        self._memo[function] = result
+        return result
+
+    def _callee_usage(self, name: str, unit: str) -> Usage:
+        callee = self.find(name, unit)
+        if callee is None:
+            if name in self.external:
+                size = self.external[name]
+                return Usage(size, [f"{name} ({size}, assumed)"])
+            return Usage(0, [], {f"{name}: no stack information"})
+        if callee in self._active:
+            return Usage(0, [], {f"{name}: recursion"})
+        return self.usage(callee)
+
+
+# ==========================================================================
+# Linker Map
+# ==========================================================================
+
+
+@dataclass
+class Allocation:
+    """Input or output section placed by the linker."""
+
+    name: str
+    address: int
+    size: int
+    module: str
+
+
+class LinkerMap:
+    """Memory regions, sections and script symbols of a GNU ld map file."""
+
+    def __init__(self, path: str) -> None:
+        self.regions: dict[str, tuple[int, int]] = {}
+        self.outputs: list[Allocation] = []
+        self.inputs: list[Allocation] = []
+        self.symbols: dict[str, int] = {}
+
+        with open(path, encoding="utf-8", errors="replace") as map_file:
+            lines = map_file.read().splitlines()
+
+        start = self._parse_regions(lines)
+        self._parse_layout(lines[start:])
+
+    def _parse_regions(self, lines: list[str]) -> int:
+        in_regions = False
+        for index, line in enumerate(lines):
+            if line.startswith("Memory Configuration"):
+                in_regions = True
+            elif line.startswith("Linker script and memory map"):
+                return index + 1
+            elif in_regions:
+                match = MAP_REGION.match(line)
+                if match is not None and match["name"] != "*default*":
+                    self.regions[match["name"]] = (
+                        int(match["origin"], 16),
+                        int(match["length"], 16),
+                    )
+        return len(lines)
+
+    def _parse_layout(self, lines: list[str]) -> None:
+        pending: tuple[str, bool] | None = None
+        for line in lines:
+            assignment = MAP_ASSIGNMENT.match(line)
+            if assignment is not None:
+                value = int(assignment["value"], 16)
+                self.symbols[assignment["symbol"]] = value
+                continue
+
+            if pending is not None:
+                match = MAP_ADDRESS.match(line)
+                if match is not None:
+                    self._add(pending[0], pending[1], match)
+                pending = None
+                continue
+
+            match = MAP_SECTION.match(line)
+            if match is None:
+                continue
+            is_input = match["indent"] != ""
+            if match["address"] is None:
+                pending = (match["name"], is_input)
+            else:
+                self._add(match["name"], is_input, match)
+
+    def _add(self, name: str, is_input: bool, match: re.Match[str]) -> None:
+        allocation = Allocation(
+            name=name,
+            address=int(match["address"], 16),
+            size=int(match["size"], 16),
+            module=(match["object"] or "").strip(),
+        )
+        if allocation.size == 0:
+            return
+        (self.inputs if is_input else self.outputs).append(allocation)
+
+    def in_region(
+        self, region: str, allocations: list[Allocation]
+    ) -> list[Allocation]:
+        """Allocations that start inside a memory region."""
+        origin, length = self.regions[region]
+        end = origin + length
+        return [item for item in allocations if origin <= item.address < end]
+
+    def object_size(self, symbol: str, module: str | None = None) -> int | None:
+        """Size of a data object, from its -fdata-sections input section."""
+        pattern = re.compile(
+            rf"^\.(?:bss|data|noinit)[^.]*\.{re.escape(symbol)}(?:\.\d+)?$"
+        )
+        for item in self.inputs:
+            if pattern.match(item.name) is None:
+                continue
+            if module is not None and module not in item.module:
+                continue
+            return item.size
+        return None
+
+
+# ==========================================================================
+# Report
+# ==========================================================================
+
+
+@dataclass
+class TaskResult:
+    """Stack check of one task."""
+
+    name: str
+    entry: str
+    need: int
+    size: int
+    usage: Usage
+
+    def free(self) -> int:
+        """Bytes left on the worst-case path."""
+        return self.size - self.need
+
+
+class Report:
+    """Stack and RAM checks, printed as text."""
+
+    def __init__(
+        self, budget: dict, graph: CallGraph, linker_map: LinkerMap
+    ) -> None:
+        self.budget = budget
+        self.graph = graph
+        self.map = linker_map
+        self.lines: list[str] = []
+        self.overrun = False
+        self.incomplete = False
+        self.margin = int(budget.get("stack_margin_bytes", 0))
+        context = budget.get("context_bytes", {})
+        self.task_context = int(context.get("task", 0))
+        self.isr_context = int(context.get("isr", 0))
+
+    def emit(self, text: str = "") -> None:
+        """Add a report line."""
+        self.lines.append(text)
+
+    def stack_size(self, task: dict, root: str) -> int | None:
+        """Stack size of a task in bytes, None if it is not linked."""
+        stack = task["stack"]
+        if "symbol" in stack:
+            size = self.map.object_size(stack["symbol"], stack.get("object"))
+            if size is None:
+                return None
+            return size // int(stack.get("count", 1))
+
+        path = os.path.join(root, stack["file"])
+        with open(path, encoding="utf-8") as source:
+            match = re.search(
+                rf"^#define\s+{re.escape(stack['define'])}\s+\(?(\d+)U?\)?",
+                source.read(),
+                re.MULTILINE,
+            )
+        if match is None:
+            raise ValueError(f"{path}: {stack['define']} not found")
+        return int(match[1]) * STACK_WORD_BYTES
+
+    def check_tasks(self, root: str) -> None:
+        """Worst-case stack of every task against its stack size."""
+        results: list[TaskResult] = []
+        skipped: list[str] = []
+        for task in self.budget["tasks"]:
+            entry = self.graph.find(task["entry"])
+            size = self.stack_size(task, root)
+            if entry is None or size is None:
+                skipped.append(task["name"])
+                continue
+            usage = self.graph.usage(entry)
+            results.append(
+                TaskResult(
+                    task["name"],
+                    task["entry"],
+                    usage.depth + self.task_context,
+                    size,
+                    usage,
+                )
+            )
+
+        self.emit("=== Task Stacks (bytes, worst case) ===")
+        self.emit(
+            f"{'Task':<13} {'Entry':<27} {'Need':>6} {'Size':>6} {'Free':>6}"
+        )
+        self.emit("-" * 64)
+        for result in results:
+            status = self._task_status(result)
+            self.emit(
+                f"{result.name:<13} {result.entry:<27} {result.need:>6} "
+                f"{result.size:>6} {result.free():>6}  {status}"
+            )
+        if skipped:
+            self.emit(f"Not linked: {', '.join(skipped)}")
+
+        reclaimable = sum(
+            result.free() - self.margin
+            for result in results
+            if not result.usage.issues and result.free() > self.margin
+        )
+        self.emit(
+            f"Free beyond the {self.margin} byte margin on complete results: "
+            f"{reclaimable} bytes"
+        )
+        self.emit(f"Task context per switch: {self.task_context} bytes")
+
+        for result in results:
+            self.emit_path(result.name, result.usage)
+
+    def emit_path(self, name: str, usage: Usage) -> None:
+        """Add the deepest path below a root and what it leaves out."""
+        self.emit()
+        self.emit(f"{name}: {' > '.join(usage.path)}")
+        for issue in sorted(usage.issues):
+            self.emit(f"    incomplete: {issue}")
+        if usage.issues:
+            self.incomplete = True
+
+    def _task_status(self, result: TaskResult) -> str:
+        if result.free() < self.margin:
+            self.overrun = True
+            return "OVERRUN"
+        if result.usage.issues:
+            return "OK (lower bound)"
+        return "OK"
+
+    def check_main_stack(self) -> None:
+        """Interrupt nesting and main() against the main stack size."""
+        size = self.map.symbols.get("_Min_Stack_Size")
+        levels = int(self.budget.get("isr_nesting_levels", 1))
+        handlers = sorted(
+            (
+                (self.graph.usage(function), name)
+                for name, functions in self.graph.globals.items()
+                if HANDLER.match(name)
+                for function in functions[:1]
+            ),
+            key=lambda item: item[0].depth,
+            reverse=True,
+        )
+        deepest = handlers[:levels]
+        isr_need = sum(usage.depth + self.isr_context for usage, _ in deepest)
+
+        main = self.graph.find("main")
+        main_usage = Usage(0, []) if main is None else self.graph.usage(main)
+        need = max(isr_need, main_usage.depth)
+
+        self.emit()
+        self.emit("=== Main Stack (bytes) ===")
+        self.emit(f"main() before the scheduler starts: {main_usage.depth}")
+        for usage, name in deepest:
+            self.emit(f"  {name:<32} {usage.depth:>6}")
+        self.emit(
+            f"{len(deepest)} nested handlers with {self.isr_context} bytes "
+            f"context each: {isr_need}"
+        )
+        if size is None:
+            self.emit("_Min_Stack_Size not found in the map")
+            self.incomplete = True
+        else:
+            status = "OK" if need + self.margin <= size else "OVERRUN"
+            self.overrun |= status == "OVERRUN"
+            self.emit(f"Need {need} of _Min_Stack_Size {size}: {status}")
+
+        self.emit_path("main", main_usage)
+        for usage, name in deepest:
+            self.emit_path(name, usage)
+
+    def check_ram(self) -> None:
+        """Sections in the RAM region against its length."""
+        region = self.budget.get("ram_region", "RAM")
+        if region not in self.map.regions:
+            self.emit()
+            self.emit(f"Memory region {region} not in the map")
+            self.overrun = True
+            return
+        origin, length = self.map.regions[region]
+        reserve = int(self.budget.get("ram_reserve_bytes", 0))
+        outputs = self.map.in_region(region, self.map.outputs)
+        inputs = self.map.in_region(region, self.map.inputs)
+        used = sum(item.size for item in outputs)
+
+        self.emit()
+        self.emit(
+            f"=== RAM Budget ({region} at 0x{origin:08X}, {length} bytes) ==="
+        )
+        for item in outputs:
+            self.emit(f"  {item.name:<24} {item.size:>8}")
+        status = "OK" if used + reserve <= length else "OVERRUN"
+        self.overrun |= status == "OVERRUN"
+        self.emit(
+            f"Used {used}, free {length - used} ({reserve} reserved): {status}"
+        )
+
+        largest = sorted(inputs, key=lambda item: item.size, reverse=True)
+        self.emit()
+        self.emit("Largest objects:")
+        for item in largest[:TOP_COUNT]:
+            module = os.path.basename(item.module)
+            self.emit(f"  {item.size:>8}  {item.name:<40} {module}")
+
+        modules: dict[str, int] = {}
+        for item in inputs:
+            module = os.path.basename(item.module)
+            modules[module] = modules.get(module, 0) + item.size
+        self.emit()
+        self.emit("Largest modules:")
+        for module, size in sorted(
+            modules.items(), key=lambda entry: entry[1], reverse=True
+        )[:TOP_COUNT]:
+            self.emit(f"  {size:>8}  {module}")
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Check the stack and RAM budget of jerry_app",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --map build/jerry_app.map --callgraph build
+  %(prog)s --map build/jerry_app.map --callgraph build --strict
+
+Exit status is 1 on an overrun, or with --strict on an incomplete result.
+        """,
+    )
+    root = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+    parser.add_argument("--map", required=True, help="Linker map of jerry_app")
+    parser.add_argument(
+        "--callgraph",
+        required=True,
+        help="Build directory holding the .ci files (-fcallgraph-info=su)",
+    )
+    parser.add_argument(
+        "--budget",
+        default=os.path.join(root, "config", "stack_budget.json"),
+        help="Task list and call graph additions "
+        "(default: config/stack_budget.json)",
+    )
+    parser.add_argument(
+        "--root",
+        default=root,
+        help="Source tree root (default: repository root)",
+    )
+    parser.add_argument(
+        "--exclude",
+        action="append",
+        default=[],
+        help="Glob of .ci files of other images to skip (repeatable)",
+    )
+    parser.add_argument("--output", help="Also write the report to this file")
+    parser.add_argument(
+        "--strict",
+        action="store_true",
+        help="Fail on results that are only lower bounds",
+    )
+
+    args = parser.parse_args()
+
+    with open(args.budget, encoding="utf-8") as budget_file:
+        budget = json.load(budget_file)
+
+    graph = CallGraph(budget)
+    if graph.load(args.callgraph, args.exclude) == 0:
+        print(f"No .ci files below {args.callgraph}", file=sys.stderr)
+        return 1
+
+    report = Report(budget, graph, LinkerMap(args.map))
+    report.check_tasks(args.root)
+    report.check_main_stack()
+    report.check_ram()
+
+    text = "\n".join(report.lines) + "\n"
+    print(text, end="")
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as output:
+            output.write(text)
+
+    if report.overrun:
+        print("Stack or RAM budget exceeded", file=sys.stderr)
+        return 1
+    if args.strict and report.incomplete:
+        print("Incomplete stack results (--strict)", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,551 @@
+#!/usr/bin/env python3
+"""
+Telemetry Decoder
+
+Decodes the binary telemetry frames built by the jerry_device monitor task,
+either as they arrive over UDP or by reading the last frame with Modbus
+FC20 (Read File Record), and prints their sections.
+
+The frame period and UDP destination are set through the Modbus holding
+registers 130-133 (telemetry_period_s, _ip_high, _ip_low, _port); see
+config/jerry_registers.json. The frame format is described in
+application/inc/telemetry.h.
+
+Usage:
+    python telemetry_decoder.py --port 5006
+    python telemetry_decoder.py --host 169.254.4.100
+    python telemetry_decoder.py --host 169.254.4.100 --interval 10
+"""
+
+from __future__ import annotations
+
+import argparse
+import socket
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+
+# Default configuration matching the telemetry module
+DEFAULT_BIND = "0.0.0.0"
+DEFAULT_PORT = 5006
+DEFAULT_MODBUS_PORT = 502
+DEFAULT_UNIT_ID = 1
+DEFAULT_TIMEOUT = 2.0
+
+# Frame format (telemetry.h)
+TELEMETRY_MAGIC = 0x544A
+TELEMETRY_VERSION = 1
+HEADER = struct.Struct("<HBBHHII")
+SECTION_HEADER = struct.Struct("<BBH")
+CRC_SIZE = 2
+NAME_SIZE = 16
+
+# FC20 access (TELEMETRY_FILE_NUMBER, MODBUS_FILE_REFERENCE_TYPE)
+FILE_NUMBER = 1
+REFERENCE_TYPE = 6
+FC_READ_FILE_RECORD = 0x14
+
+# Records one FC20 sub-request can return in a 253-byte PDU
+MAX_RECORDS = 124
+
+# Section IDs (telemetry_section_t)
+SECTION_LWIP_MEM = 1
+SECTION_LWIP_MEMP = 2
+SECTION_LINK = 3
+SECTION_CPU = 4
+SECTION_TASKS = 5
+SECTION_ADC = 6
+SECTION_METRICS = 7
+SECTION_LATENCY = 8
+SECTION_LWIP_SIZES = 9
+SECTION_SYS_POOLS = 10
+SECTION_ICACHE = 11
+
+# ICACHE miss counter maximum (BSP_ICACHE_MISS_MAX), it stops there
+ICACHE_MISS_MAX = 0xFFFF
+
+# SYS_POOLS entry: name, size, count, depth, used, max, err, max fill, full
+SYS_POOL_ENTRY = struct.Struct(f"<{NAME_SIZE}s8H")
+
+# metrics.h counters in metric_id_t order
+METRIC_NAMES = [
+    "lwip_heap_err",
+    "lwip_pbuf_err",
+    "lwip_tcp_seg_err",
+    "lwip_tcp_pcb_err",
+    "lwip_netconn_err",
+    "eth_rx_no_buffer",
+    "eth_rx_stall",
+    "eth_rx_dropped",
+    "eth_tx_err",
+    "adc_overrun",
+    "adc_dropped",
+    "modbus_tcp_err",
+    "modbus_rtu_err",
+    "usb_log_lost",
+    "eth_rx_recovered",
+    "eth_rx_stall_us",
+    "eth_bcast_storm",
+    "modbus_udp_retry",
+    "modbus_unit_drop",
+    "modbus_shed_conn",
+    "modbus_shed_unit",
+    "eth_rx_poll",
+    "msg_bus_drop",
+    "trace_drop",
+    "deadline_miss",
+    "log_drop",
+    "config_fail",
+    "nor_log_lost",
+    "ws_drop",
+    "mqtt_reconnect",
+    "archive_lost",
+    "usb_stream_lost",
+    "profile_drop",
+    "capture_drop",
+]
+
+# modbus_diag_transport_t
+TRANSPORT_NAMES = ["tcp", "rtu"]
+
+# modbus_latency_fc_t
+FC_GROUP_NAMES = [
+    "FC01",
+    "FC02",
+    "FC03",
+    "FC04",
+    "FC05",
+    "FC06",
+    "FC15",
+    "FC16",
+    "FC23",
+    "FC43",
+    "other",
+]
+
+# modbus_latency_stage_t
+STAGE_NAMES = ["parse", "dispatch", "callback", "encode"]
+
+
+class FrameError(Exception):
+    """A frame that cannot be decoded."""
+
+
+def crc16_modbus(data: bytes) -> int:
+    """CRC-16/MODBUS of data."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            if crc & 1:
+                crc = (crc >> 1) ^ 0xA001
+            else:
+                crc >>= 1
+    return crc
+
+
+@dataclass
+class Section:
+    """One frame section, body still encoded."""
+
+    section_id: int
+    entries: int
+    body: bytes
+
+
+@dataclass
+class Frame:
+    """One decoded telemetry frame."""
+
+    version: int
+    period_s: int
+    sequence: int
+    uptime_ms: int
+    sections: list[Section] = field(default_factory=list)
+
+
+def decode_frame(data: bytes) -> Frame:
+    """Check and split a frame into its sections."""
+    if len(data) < HEADER.size + CRC_SIZE:
+        raise FrameError(f"short frame ({len(data)} bytes)")
+
+    magic, version, count, length, period_s, sequence, uptime_ms = (
+        HEADER.unpack_from(data)
+    )
+    if magic != TELEMETRY_MAGIC:
+        raise FrameError(f"bad magic 0x{magic:04X}")
+    if length > len(data) or length < HEADER.size + CRC_SIZE:
+        raise FrameError(f"bad length {length} ({len(data)} bytes read)")
+
+    (crc,) = struct.unpack_from("<H", data, length - CRC_SIZE)
+    if crc != crc16_modbus(data[: length - CRC_SIZE]):
+        raise FrameError("CRC mismatch")
+    if version != TELEMETRY_VERSION:
+        raise FrameError(f"unsupported version {version}")
+
+    frame = Frame(version, period_s, sequence, uptime_ms)
+    pos = HEADER.size
+    end = length - CRC_SIZE
+    for _ in range(count):
+        if pos + SECTION_HEADER.size > end:
+            raise FrameError("truncated section header")
+        section_id, entries, body_len = SECTION_HEADER.unpack_from(data, pos)
+        pos += SECTION_HEADER.size
+        if pos + body_len > end:
+            raise FrameError(f"truncated section {section_id}")
+        frame.sections.append(
+            Section(section_id, entries, data[pos : pos + body_len])
+        )
+        pos += body_len
+    return frame
+
+
+def _name(raw: bytes) -> str:
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def _percent(value: int) -> str:
+    return f"{value / 100:6.2f} %"
+
+
+def _format_lwip_mem(body: bytes, _entries: int) -> list[str]:
+    avail, used, peak, err = struct.unpack_from("<IIII", body)
+    return [f"heap avail={avail} used={used} max={peak} err={err}"]
+
+
+def _format_lwip_memp(body: bytes, entries: int) -> list[str]:
+    entry = struct.Struct(f"<{NAME_SIZE}sHHHH")
+    lines = []
+    for i in range(entries):
+        name, avail, used, peak, err = entry.unpack_from(body, i * entry.size)
+        lines.append(
+            f"{_name(name) or '?':<16} avail={avail:<5} used={used:<5} "
+            f"max={peak:<5} err={err}"
+        )
+    return lines
+
+
+def _format_link(body: bytes, _entries: int) -> list[str]:
+    recv, xmit, drop, rx_int = struct.unpack_from("<IIII", body)
+    return [f"recv={recv} xmit={xmit} drop={drop} rx_interrupts={rx_int}"]
+
+
+def _format_cpu(body: bytes, _entries: int) -> list[str]:
+    total, adc_dma, eth, _reserved = struct.unpack_from("<HHHH", body)
+    return [
+        f"tasks    {_percent(total)}",
+        f"ADC1 DMA {_percent(adc_dma)}",
+        f"ETH      {_percent(eth)}",
+    ]
+
+
+def _format_tasks(body: bytes, entries: int) -> list[str]:
+    entry = struct.Struct(f"<{NAME_SIZE}sHH")
+    lines = []
+    for i in range(entries):
+        name, load, stack_free = entry.unpack_from(body, i * entry.size)
+        lines.append(
+            f"{_name(name):<16} {_percent(load)}  stack free {stack_free} "
+            "words"
+        )
+    return lines
+
+
+def _format_adc(body: bytes, _entries: int) -> list[str]:
+    samples, overruns = struct.unpack_from("<II", body)
+    return [f"filtered samples={samples} block overruns={overruns}"]
+
+
+def _format_metrics(body: bytes, entries: int) -> list[str]:
+    totals = struct.unpack_from(f"<{entries}I", body)
+    lines = []
+    for i, total in enumerate(totals):
+        name = METRIC_NAMES[i] if i < len(METRIC_NAMES) else f"metric_{i}"
+        lines.append(f"{name:<18} {total}")
+    return lines
+
+
+def _lookup(names: list[str], index: int) -> str:
+    return names[index] if index < len(names) else str(index)
+
+
+def _format_latency(body: bytes, entries: int) -> list[str]:
+    head = struct.Struct("<BBBBII")
+    lines = []
+    pos = 0
+    for _ in range(entries):
+        transport, group, min_shift, buckets, count, hz = head.unpack_from(
+            body, pos
+        )
+        pos += head.size
+        histogram = struct.unpack_from(f"<{buckets}H", body, pos)
+        pos += 2 * buckets
+        means = struct.unpack_from(f"<{len(STAGE_NAMES)}H", body, pos)
+        pos += 2 * len(STAGE_NAMES)
+
+        first_us = (1 << min_shift) * 1e6 / hz if hz else 0.0
+        stages = " ".join(
+            f"{stage}={mean}us"
+            for stage, mean in zip(STAGE_NAMES, means, strict=True)
+        )
+        lines.append(
+            f"{_lookup(TRANSPORT_NAMES, transport)} "
+            f"{_lookup(FC_GROUP_NAMES, group):<5} requests={count} {stages}"
+        )
+        lines.append(
+            f"  buckets (first < {first_us:.1f} us, x2 each): "
+            + " ".join(str(n) for n in histogram)
+        )
+    return lines
+
+
+def _format_lwip_sizes(body: bytes, entries: int) -> list[str]:
+    sizes = struct.unpack_from(f"<{entries}H", body)
+    return ["bytes per element: " + " ".join(str(size) for size in sizes)]
+
+
+def _format_sys_pools(body: bytes, entries: int) -> list[str]:
+    lines = []
+    for i in range(entries):
+        name, size, count, depth, used, peak, err, fill, full = (
+            SYS_POOL_ENTRY.unpack_from(body, i * SYS_POOL_ENTRY.size)
+        )
+        line = (
+            f"{_name(name) or '?':<16} count={count:<5} used={used:<5} "
+            f"max={peak:<5} err={err} ({size} bytes each)"
+        )
+        if depth:
+            line += f" depth={depth} max_fill={fill} full={full}"
+        lines.append(line)
+    return lines
+
+
+def _format_icache(body: bytes, _entries: int) -> list[str]:
+    interval_ms, hits, misses, hot_start, hot_size = struct.unpack_from(
+        "<5I", body
+    )
+    fetches = hits + misses
+    if fetches == 0:
+        line = f"off or idle over {interval_ms} ms"
+    else:
+        line = (
+            f"hits={hits} misses={misses} over {interval_ms} ms, "
+            f"hit rate {_percent(hits * 10000 // fetches)}"
+        )
+        if misses >= ICACHE_MISS_MAX:
+            line += " (misses saturated, shorten the period)"
+    lines = [line]
+    if hot_size:
+        lines.append(f"hot code 0x{hot_start:08x}, {hot_size} bytes")
+    return lines
+
+
+SECTION_FORMATTERS = {
+    SECTION_LWIP_MEM: ("lwIP heap", _format_lwip_mem),
+    SECTION_LWIP_MEMP: ("lwIP pools", _format_lwip_memp),
+    SECTION_LINK: ("Link", _format_link),
+    SECTION_CPU: ("CPU load", _format_cpu),
+    SECTION_TASKS: ("Tasks", _format_tasks),
+    SECTION_ADC: ("ADC", _format_adc),
+    SECTION_METRICS: ("Metrics", _format_metrics),
+    SECTION_LATENCY: ("Modbus latency", _format_latency),
+    SECTION_LWIP_SIZES: ("lwIP pool sizes", _format_lwip_sizes),
+    SECTION_SYS_POOLS: ("sys_arch pools", _format_sys_pools),
+    SECTION_ICACHE: ("Instruction cache", _format_icache),
+}
+
+
+def format_frame(frame: Frame) -> str:
+    """Render a frame as text."""
+    lines = [
+        f"=== Telemetry frame {frame.sequence} "
+        f"(v{frame.version}, uptime {frame.uptime_ms / 1000:.1f} s, "
+        f"period {frame.period_s} s) ==="
+    ]
+    for section in frame.sections:
+        title, formatter = SECTION_FORMATTERS.get(
+            section.section_id, (f"Section {section.section_id}", None)
+        )
+        lines.append(f"{title}:")
+        if formatter is None:
+            lines.append(f"  {len(section.body)} bytes, not decoded")
+            continue
+        try:
+            body = formatter(section.body, section.entries)
+        except (struct.error, IndexError) as exc:
+            body = [f"undecodable ({exc})"]
+        lines.extend(f"  {line}" for line in body)
+    return "\n".join(lines)
+
+
+def receive_udp(bind: str, port: int) -> None:
+    """Print every frame received on a UDP port."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((bind, port))
+    print(f"Listening on {bind}:{port}, Ctrl+C to stop")
+    try:
+        while True:
+            data, sender = sock.recvfrom(2048)
+            try:
+                frame = decode_frame(data)
+            except FrameError as exc:
+                print(f"{sender[0]}: {exc}", file=sys.stderr)
+                continue
+            print(format_frame(frame))
+    finally:
+        sock.close()
+
+
+class FileRecordClient:
+    """Minimal Modbus TCP client for FC20 on one file."""
+
+    def __init__(self, host: str, port: int, unit_id: int, timeout: float):
+        self._sock = socket.create_connection((host, port), timeout=timeout)
+        self._unit_id = unit_id
+        self._transaction = 0
+
+    def close(self) -> None:
+        """Close the connection."""
+        self._sock.close()
+
+    def _recv_exact(self, size: int) -> bytes:
+        data = b""
+        while len(data) < size:
+            chunk = self._sock.recv(size - len(data))
+            if not chunk:
+                raise ConnectionError("connection closed")
+            data += chunk
+        return data
+
+    def read_records(self, file_number: int, record: int, count: int) -> bytes:
+        """Read count records, returned as big-endian bytes."""
+        self._transaction = (self._transaction + 1) & 0xFFFF
+        pdu = struct.pack(
+            ">BBBHHH",
+            FC_READ_FILE_RECORD,
+            7,
+            REFERENCE_TYPE,
+            file_number,
+            record,
+            count,
+        )
+        self._sock.sendall(
+            struct.pack(
+                ">HHHB", self._transaction, 0, len(pdu) + 1, self._unit_id
+            )
+            + pdu
+        )
+
+        transaction, _, length, _ = struct.unpack(
+            ">HHHB", self._recv_exact(7)
+        )
+        response = self._recv_exact(length - 1)
+        if transaction != self._transaction:
+            raise FrameError(f"unexpected transaction {transaction}")
+        if response[0] == FC_READ_FILE_RECORD | 0x80:
+            raise FrameError(f"Modbus exception {response[1]}")
+        if len(response) < 4 or response[3] != REFERENCE_TYPE:
+            raise FrameError("malformed FC20 response")
+        return response[4 : 4 + 2 * count]
+
+
+def read_modbus(client: FileRecordClient) -> Frame:
+    """Read and decode the last frame over FC20."""
+    header_records = (HEADER.size + 1) // 2
+    data = client.read_records(FILE_NUMBER, 0, header_records)
+    _, _, _, length, _, _, _ = HEADER.unpack_from(data)
+    records = (length + 1) // 2
+    while len(data) // 2 < records:
+        first = len(data) // 2
+        count = min(MAX_RECORDS, records - first)
+        data += client.read_records(FILE_NUMBER, first, count)
+    return decode_frame(data)
+
+
+def poll_modbus(args: argparse.Namespace) -> int:
+    """Read the last frame over FC20, once or every interval."""
+    client = FileRecordClient(
+        args.host, args.modbus_port, args.unit_id, args.timeout
+    )
+    try:
+        while True:
+            for _ in range(3):
+                try:
+                    print(format_frame(read_modbus(client)))
+                    break
+                except FrameError as exc:
+                    # A frame built between two requests fails the CRC
+                    print(f"Read failed: {exc}", file=sys.stderr)
+            else:
+                return 1
+            if args.interval <= 0:
+                return 0
+            time.sleep(args.interval)
+    finally:
+        client.close()
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Decode jerry_device binary telemetry frames",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog=__doc__,
+    )
+    parser.add_argument(
+        "--host",
+        help="Read the last frame with Modbus FC20 from this device "
+        "instead of listening for UDP",
+    )
+    parser.add_argument(
+        "--bind",
+        default=DEFAULT_BIND,
+        help=f"UDP address to listen on (default: {DEFAULT_BIND})",
+    )
+    parser.add_argument(
+        "--port",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"UDP port to listen on (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--modbus-port",
+        type=int,
+        default=DEFAULT_MODBUS_PORT,
+        help=f"Modbus TCP port (default: {DEFAULT_MODBUS_PORT})",
+    )
+    parser.add_argument(
+        "--unit-id",
+        type=int,
+        default=DEFAULT_UNIT_ID,
+        help=f"Modbus unit ID (default: {DEFAULT_UNIT_ID})",
+    )
+    parser.add_argument(
+        "--interval",
+        type=float,
+        default=0.0,
+        help="With --host, read again every INTERVAL seconds (default: once)",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=DEFAULT_TIMEOUT,
+        help=f"Modbus response timeout in seconds (default: {DEFAULT_TIMEOUT})",
+    )
+    args = parser.parse_args()
+
+    try:
+        if args.host:
+            return poll_modbus(args)
+        receive_udp(args.bind, args.port)
+    except KeyboardInterrupt:
+        print()
+    except OSError as exc:
+        print(f"Error: {exc}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
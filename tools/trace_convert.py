@@ -0,0 +1,342 @@
+#!/usr/bin/env python3
+"""
+Trace Converter
+
+Records the kernel and interrupt event trace of a jerry_device (CMake
+option JERRY_TRACE) and converts it to the Chrome trace event format, which
+Perfetto (ui.perfetto.dev) and chrome://tracing open. The stream and record
+formats are described in application/inc/trace.h.
+
+Each task becomes a track with one slice per time it ran, each accounted
+interrupt and the kernel tick a track with one slice per run. Queue,
+semaphore and mutex operations are instant events on the track of the task
+or interrupt that made them. The Modbus request and ADC block trace points
+become slices of their own, one track per trace point and task. Records
+the device lost to a full ring are marked with a global instant event.
+
+Usage:
+    python trace_convert.py 169.254.4.100 --duration 10
+    python trace_convert.py 169.254.4.100 --raw capture.bin -o trace.json
+    python trace_convert.py --input capture.bin -o trace.json
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import time
+from pathlib import Path
+
+# Default configuration matching the trace task
+DEFAULT_PORT = 5010
+DEFAULT_DURATION = 5.0
+DEFAULT_OUTPUT = Path("trace.json")
+
+# Stream formats (trace.h)
+TRACE_MAGIC = 0x524A
+TRACE_VERSION = 1
+HEADER = struct.Struct("<HBBIHH")
+TASK_ENTRY = struct.Struct("<HBx16s")
+RECORD = struct.Struct("<IBBH")
+
+# trace_event_t
+EVENT_TASK_SWITCH = 1
+EVENT_ISR_ENTER = 2
+EVENT_ISR_EXIT = 3
+EVENT_QUEUE_SEND = 4
+EVENT_QUEUE_RECEIVE = 5
+EVENT_QUEUE_SEND_FAILED = 6
+EVENT_QUEUE_RECEIVE_FAILED = 7
+EVENT_QUEUE_BLOCK = 8
+EVENT_USER = 9
+EVENT_OVERFLOW = 10
+
+QUEUE_EVENT_NAMES = {
+    EVENT_QUEUE_SEND: "send",
+    EVENT_QUEUE_RECEIVE: "receive",
+    EVENT_QUEUE_SEND_FAILED: "send failed",
+    EVENT_QUEUE_RECEIVE_FAILED: "receive failed",
+}
+
+# bsp_isr_t, and TRACE_ISR_TICK
+ISR_NAMES = {0: "ISR ADC1 DMA", 1: "ISR ETH", 0xFF: "ISR tick"}
+
+# trace_user_t pairs: start point -> (end point, slice name)
+USER_SLICES = {
+    0: (1, "Modbus request"),
+    2: (3, "ADC block"),
+}
+
+# Chrome trace track numbers
+PID = 1
+ISR_TID_BASE = 1000
+USER_TID_BASE = 2000
+
+
+class TraceError(Exception):
+    """Raised when the stream is not a trace of the expected version."""
+
+
+def parse_header(data: bytes) -> tuple[int, dict[int, str], int]:
+    """Parse header and task table, returning the rate, tasks and size."""
+    if len(data) < HEADER.size:
+        raise TraceError("stream shorter than its header")
+    magic, version, record_size, hz, count, _ = HEADER.unpack_from(data)
+    if magic != TRACE_MAGIC or version != TRACE_VERSION:
+        raise TraceError(f"not a version {TRACE_VERSION} trace stream")
+    if record_size != RECORD.size:
+        raise TraceError(f"unexpected record size {record_size}")
+    size = HEADER.size + count * TASK_ENTRY.size
+    if len(data) < size:
+        raise TraceError("stream shorter than its task table")
+
+    tasks = {}
+    for i in range(count):
+        number, _, name = TASK_ENTRY.unpack_from(
+            data, HEADER.size + i * TASK_ENTRY.size
+        )
+        tasks[number] = name.split(b"\0", 1)[0].decode(errors="replace")
+    return hz, tasks, size
+
+
+def record_stream(host: str, port: int, duration: float) -> bytes:
+    """Connect to the trace task and record its stream for a while."""
+    chunks = []
+    end = time.monotonic() + duration
+    with socket.create_connection((host, port), timeout=5.0) as sock:
+        sock.settimeout(0.5)
+        while time.monotonic() < end:
+            try:
+                data = sock.recv(65536)
+            except socket.timeout:
+                continue
+            if not data:
+                break
+            chunks.append(data)
+    return b"".join(chunks)
+
+
+class Converter:
+    """Turns trace records into Chrome trace events."""
+
+    def __init__(self, hz: int, tasks: dict[int, str]) -> None:
+        self.hz = hz
+        self.tasks = tasks
+        self.events: list[dict] = []
+        self.tracks: dict[int, str] = {}
+        self.cycles = 0
+        self.last_raw: int | None = None
+        self.task: int | None = None
+        self.task_start = 0.0
+        self.isr_stack: list[tuple[int, float]] = []
+        self.user_open: dict[tuple[int, int], float] = {}
+        self.records = 0
+        self.lost = 0
+
+    def _us(self) -> float:
+        return self.cycles * 1e6 / self.hz
+
+    def _task_name(self, number: int) -> str:
+        return self.tasks.get(number, f"task {number}")
+
+    def _track(self, tid: int, name: str) -> int:
+        self.tracks.setdefault(tid, name)
+        return tid
+
+    def _slice(self, tid: int, name: str, start: float, end: float) -> None:
+        self.events.append(
+            {
+                "name": name,
+                "ph": "X",
+                "ts": start,
+                "dur": max(end - start, 0.0),
+                "pid": PID,
+                "tid": tid,
+            }
+        )
+
+    def _current_tid(self) -> int:
+        """Track of the interrupt or task the CPU is in."""
+        if self.isr_stack:
+            isr = self.isr_stack[-1][0]
+            return self._track(ISR_TID_BASE + isr, ISR_NAMES.get(isr, f"ISR {isr}"))
+        if self.task is not None:
+            return self._track(self.task, self._task_name(self.task))
+        return self._track(0, "unknown")
+
+    def _close_task(self, now: float) -> None:
+        if self.task is not None:
+            tid = self._track(self.task, self._task_name(self.task))
+            self._slice(tid, self._task_name(self.task), self.task_start, now)
+
+    def add(self, raw: int, event: int, context: int, arg: int) -> None:
+        """Convert one record."""
+        if self.last_raw is not None:
+            self.cycles += (raw - self.last_raw) & 0xFFFFFFFF
+        self.last_raw = raw
+        self.records += 1
+        now = self._us()
+
+        if event == EVENT_TASK_SWITCH:
+            self._close_task(now)
+            self.task = arg
+            self.task_start = now
+        elif event == EVENT_ISR_ENTER:
+            self.isr_stack.append((context, now))
+        elif event == EVENT_ISR_EXIT:
+            if self.isr_stack and self.isr_stack[-1][0] == context:
+                isr, start = self.isr_stack.pop()
+                name = ISR_NAMES.get(isr, f"ISR {isr}")
+                self._slice(self._track(ISR_TID_BASE + isr, name), name, start, now)
+        elif event in QUEUE_EVENT_NAMES or event == EVENT_QUEUE_BLOCK:
+            if event == EVENT_QUEUE_BLOCK:
+                name = f"block on {'send' if context else 'receive'}"
+            else:
+                name = QUEUE_EVENT_NAMES[event]
+            self.events.append(
+                {
+                    "name": f"{name} q{arg}",
+                    "ph": "i",
+                    "s": "t",
+                    "ts": now,
+                    "pid": PID,
+                    "tid": self._current_tid(),
+                    "args": {"queue": arg, "from_isr": bool(context)},
+                }
+            )
+        elif event == EVENT_USER:
+            self._user(context, arg, now)
+        elif event == EVENT_OVERFLOW:
+            self.lost += arg
+            self.events.append(
+                {
+                    "name": f"{arg} records lost",
+                    "ph": "i",
+                    "s": "g",
+                    "ts": now,
+                    "pid": PID,
+                    "tid": 0,
+                }
+            )
+
+    def _user(self, point: int, value: int, now: float) -> None:
+        task = self.task if self.task is not None else 0
+        for index, (start_point, (end_point, name)) in enumerate(USER_SLICES.items()):
+            if point == start_point:
+                self.user_open[(index, task)] = now
+                return
+            if point == end_point:
+                start = self.user_open.pop((index, task), None)
+                if start is not None:
+                    tid = self._track(
+                        USER_TID_BASE + index * 256 + task,
+                        f"{name}s ({self._task_name(task)})",
+                    )
+                    self._slice(tid, name, start, now)
+                return
+
+    def finish(self) -> dict:
+        """Close the open slices and return the trace document."""
+        self._close_task(self._us())
+        metadata = [
+            {"name": "process_name", "ph": "M", "pid": PID, "args": {"name": "jerry"}}
+        ]
+        for tid, name in sorted(self.tracks.items()):
+            metadata.append(
+                {
+                    "name": "thread_name",
+                    "ph": "M",
+                    "pid": PID,
+                    "tid": tid,
+                    "args": {"name": name},
+                }
+            )
+        return {"traceEvents": metadata + self.events, "displayTimeUnit": "ns"}
+
+
+def convert(data: bytes) -> tuple[dict, Converter]:
+    """Convert a recorded stream, returning the trace and its converter."""
+    hz, tasks, offset = parse_header(data)
+    converter = Converter(hz, tasks)
+    end = offset + ((len(data) - offset) // RECORD.size) * RECORD.size
+    for fields in RECORD.iter_unpack(data[offset:end]):
+        converter.add(*fields)
+    return converter.finish(), converter
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Record a jerry_device event trace and convert it for a trace viewer",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s 169.254.4.100 --duration 10
+  %(prog)s 169.254.4.100 --raw capture.bin -o trace.json
+  %(prog)s --input capture.bin -o trace.json
+
+Open the output in ui.perfetto.dev or chrome://tracing.
+        """,
+    )
+
+    parser.add_argument("host", nargs="?", help="Device IP address")
+    parser.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"Trace TCP port (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--duration",
+        "-d",
+        type=float,
+        default=DEFAULT_DURATION,
+        help=f"Seconds to record (default: {DEFAULT_DURATION})",
+    )
+    parser.add_argument(
+        "--input", "-i", type=Path, help="Convert a recorded stream instead"
+    )
+    parser.add_argument("--raw", type=Path, help="Also save the recorded stream")
+    parser.add_argument(
+        "--output",
+        "-o",
+        type=Path,
+        default=DEFAULT_OUTPUT,
+        help=f"Chrome trace JSON to write (default: {DEFAULT_OUTPUT})",
+    )
+
+    args = parser.parse_args()
+
+    if (args.host is None) == (args.input is None):
+        parser.error("give either a host or --input")
+
+    try:
+        if args.input is not None:
+            data = args.input.read_bytes()
+        else:
+            data = record_stream(args.host, args.port, args.duration)
+            if args.raw is not None:
+                args.raw.write_bytes(data)
+        trace, converter = convert(data)
+    except OSError as exc:
+        print(f"Recording failed: {exc}", file=sys.stderr)
+        return 1
+    except TraceError as exc:
+        print(f"Bad stream: {exc}", file=sys.stderr)
+        return 1
+
+    args.output.write_text(json.dumps(trace), encoding="utf-8")
+    span_ms = converter.cycles * 1e3 / converter.hz
+    print(
+        f"{converter.records} records over {span_ms:.1f} ms, "
+        f"{converter.lost} lost, written to {args.output}"
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
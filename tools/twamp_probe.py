@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+"""
+Jerry TWAMP Light Probe
+
+Sends TWAMP Light test packets (RFC 5357, appendix I, unauthenticated) to
+the reflector of a jerry_device on UDP port 862 (twamp_reflector.h) and
+prints the spread of the delays: p50, p99 and maximum of the round trip
+with the reflector's own time taken out, (T4 - T1) - (T3 - T2), of the
+time the reflector took, T3 - T2, and of the forward and backward one-way
+delays, T2 - T1 and T4 - T3.
+
+Timestamps are in the truncated PTP format of RFC 8186 on both sides. The
+host's are read from its system clock, UTC, and moved to PTP time (TAI) by
+--utc-offset. The one-way delays only mean something when that clock
+follows the same PTP master as the device; they are left out while the
+reflector says its own clock is not synchronized. The round trip and the
+reflector time need no common clock.
+
+--dscp marks the probes, and so the replies, with a traffic class, to
+compare the classes of the network (ethernetif.h).
+
+Usage:
+    python twamp_probe.py --host 169.254.4.100
+    python twamp_probe.py --host 169.254.4.100 --count 1000 --interval 0.01
+    python twamp_probe.py --host 169.254.4.100 --dscp 46 --size 128
+"""
+
+from __future__ import annotations
+
+import argparse
+import math
+import socket
+import struct
+import sys
+import time
+from dataclasses import dataclass
+
+# Default configuration matching jerry_device addressing
+DEFAULT_HOST = "169.254.4.100"
+DEFAULT_PORT = 862  # TWAMP_PORT
+
+# Packet sizes (twamp_reflector.h)
+SENDER_SIZE = 14  # TWAMP_SENDER_SIZE
+REFLECTOR_SIZE = 41  # TWAMP_REFLECTOR_SIZE
+MAX_SIZE = 1472  # TWAMP_MAX_SIZE
+
+# Error estimate bits
+ERROR_SYNC = 0x8000  # S, the clock follows a master
+ERROR_PTP = 0x4000  # Z, truncated PTP timestamps
+
+# Error estimate of the probes: PTP format, not synchronized, error unknown
+# (scale 63, multiplier 1)
+SENDER_ERROR = ERROR_PTP | (63 << 8) | 1
+
+# TAI - UTC since 2017, PTP time against the host clock
+DEFAULT_UTC_OFFSET = 37
+
+NS_PER_S = 1_000_000_000
+
+# Reply: sequence, T3, error, MBZ, T2, sender sequence, T1, sender error,
+# MBZ, sender TTL
+REPLY = struct.Struct(">IIIHHIIIIIHHB")
+
+
+@dataclass
+class Sample:
+    """Times of one answered probe, in ns."""
+
+    round_trip: int
+    reflector: int
+    forward: int
+    backward: int
+    synchronized: bool
+    ttl: int
+
+
+def ptp_time(time_ns: int) -> tuple[int, int]:
+    """Truncated PTP seconds and nanoseconds of a time in ns."""
+    return (time_ns // NS_PER_S) & 0xFFFFFFFF, time_ns % NS_PER_S
+
+
+def elapsed_ns(later: tuple[int, int], earlier: tuple[int, int]) -> int:
+    """Signed time between two truncated PTP times, across a seconds wrap."""
+    seconds = (later[0] - earlier[0]) & 0xFFFFFFFF
+    if seconds >= 1 << 31:
+        seconds -= 1 << 32
+    return seconds * NS_PER_S + later[1] - earlier[1]
+
+
+def build_probe(sequence: int, size: int, send: tuple[int, int]) -> bytes:
+    """Sender packet with its timestamp T1."""
+    head = struct.pack(">IIIH", sequence, send[0], send[1], SENDER_ERROR)
+    return head + bytes(size - SENDER_SIZE)
+
+
+def probe(
+    sock: socket.socket,
+    address: tuple[str, int],
+    sequence: int,
+    size: int,
+    offset_ns: int,
+    timeout: float,
+) -> Sample | None:
+    """Send one probe and wait for its reply; None if none came in time."""
+    t1 = ptp_time(time.time_ns() + offset_ns)
+    sock.sendto(build_probe(sequence, size, t1), address)
+    deadline = time.monotonic() + timeout
+
+    while True:
+        remaining = deadline - time.monotonic()
+        if remaining <= 0:
+            return None
+        sock.settimeout(remaining)
+        try:
+            data, _ = sock.recvfrom(MAX_SIZE)
+        except socket.timeout:
+            return None
+        t4 = ptp_time(time.time_ns() + offset_ns)
+        if len(data) < REFLECTOR_SIZE:
+            continue
+
+        fields = REPLY.unpack_from(data)
+        if fields[7] != sequence:
+            continue  # A late reply to an earlier probe
+
+        t3 = (fields[1], fields[2])
+        t2 = (fields[5], fields[6])
+        reflector = elapsed_ns(t3, t2)
+        return Sample(
+            round_trip=elapsed_ns(t4, t1) - reflector,
+            reflector=reflector,
+            forward=elapsed_ns(t2, t1),
+            backward=elapsed_ns(t4, t3),
+            synchronized=bool(fields[3] & ERROR_SYNC),
+            ttl=fields[12],
+        )
+
+
+def percentile(values: list[int], fraction: float) -> int:
+    """Nearest-rank percentile of a list of values."""
+    ordered = sorted(values)
+    rank = max(1, math.ceil(len(ordered) * fraction))
+    return ordered[rank - 1]
+
+
+def print_summary(samples: list[Sample], sent: int) -> None:
+    """Print p50, p99 and maximum of each delay, in us."""
+    lost = sent - len(samples)
+    print(f"{sent} probes, {len(samples)} answered, {lost} lost")
+    if not samples:
+        return
+
+    rows = [
+        ("Round trip", [s.round_trip for s in samples]),
+        ("Reflector", [s.reflector for s in samples]),
+    ]
+    synchronized = [s for s in samples if s.synchronized]
+    if synchronized:
+        rows.append(("Forward", [s.forward for s in synchronized]))
+        rows.append(("Backward", [s.backward for s in synchronized]))
+
+    print(f"{'Delay':<12}{'Samples':>10}{'p50(us)':>12}{'p99(us)':>12}{'Max(us)':>12}")
+    print("-" * 58)
+    for name, values in rows:
+        print(
+            f"{name:<12}{len(values):>10}"
+            f"{percentile(values, 0.50) / 1000:>12.1f}"
+            f"{percentile(values, 0.99) / 1000:>12.1f}"
+            f"{max(values) / 1000:>12.1f}"
+        )
+
+    if not synchronized:
+        print("One-way delays left out: the reflector's clock is not synchronized")
+    print(f"TTL at the reflector: {samples[-1].ttl}")
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Measure the network latency to a jerry_device with TWAMP Light",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s --host 169.254.4.100
+  %(prog)s --host 169.254.4.100 --count 1000 --interval 0.01
+  %(prog)s --host 169.254.4.100 --dscp 46 --size 128
+        """,
+    )
+
+    parser.add_argument(
+        "--host",
+        "-H",
+        default=DEFAULT_HOST,
+        help=f"Reflector IP address (default: {DEFAULT_HOST})",
+    )
+    parser.add_argument(
+        "--port",
+        "-p",
+        type=int,
+        default=DEFAULT_PORT,
+        help=f"Reflector UDP port (default: {DEFAULT_PORT})",
+    )
+    parser.add_argument(
+        "--count",
+        "-c",
+        type=int,
+        default=100,
+        help="Probes to send (default: 100)",
+    )
+    parser.add_argument(
+        "--interval",
+        "-i",
+        type=float,
+        default=0.1,
+        help="Seconds between probes (default: 0.1)",
+    )
+    parser.add_argument(
+        "--size",
+        "-s",
+        type=int,
+        default=REFLECTOR_SIZE,
+        help=f"Probe size in bytes, {SENDER_SIZE} to {MAX_SIZE} (default: {REFLECTOR_SIZE})",
+    )
+    parser.add_argument(
+        "--dscp",
+        type=int,
+        default=0,
+        help="DSCP of the probes and replies, 0 to 63 (default: 0)",
+    )
+    parser.add_argument(
+        "--timeout",
+        "-t",
+        type=float,
+        default=1.0,
+        help="Seconds to wait for each reply (default: 1.0)",
+    )
+    parser.add_argument(
+        "--utc-offset",
+        type=int,
+        default=DEFAULT_UTC_OFFSET,
+        help=f"TAI - UTC in seconds, added to the host clock (default: {DEFAULT_UTC_OFFSET})",
+    )
+
+    args = parser.parse_args()
+
+    if not SENDER_SIZE <= args.size <= MAX_SIZE:
+        print(f"Error: --size must be {SENDER_SIZE} to {MAX_SIZE}")
+        return 1
+    if not 0 <= args.dscp <= 63:
+        print("Error: --dscp must be 0 to 63")
+        return 1
+
+    address = (args.host, args.port)
+    offset_ns = args.utc_offset * NS_PER_S
+    samples: list[Sample] = []
+    sent = 0
+
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_TOS, args.dscp << 2)
+        try:
+            for sequence in range(args.count):
+                sample = probe(
+                    sock, address, sequence, args.size, offset_ns, args.timeout
+                )
+                sent += 1
+                if sample is not None:
+                    samples.append(sample)
+                time.sleep(args.interval)
+        except KeyboardInterrupt:
+            pass
+        except OSError as exc:
+            print(f"Error: {exc}")
+            return 1
+
+    print_summary(samples, sent)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
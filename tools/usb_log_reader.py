@@ -0,0 +1,313 @@
+#!/usr/bin/env python3
+"""
+USB Log Reader
+
+Lists and extracts the sample log files that the jerry_device USB logger
+writes to a flash stick. The stick holds no file system: read it as a raw
+block device (for example /dev/sdb on Linux, \\\\.\\PhysicalDrive2 on
+Windows, both usually needing administrator rights) or from an image taken
+with dd. The format is described in application/inc/usb_logger.h; coded
+files are decoded with sample_codec.py.
+
+Usage:
+    python usb_log_reader.py /dev/sdb
+    python usb_log_reader.py /dev/sdb --file 12 --csv file12.csv
+    python usb_log_reader.py stick.img --file 12 --csv file12.csv
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import struct
+import sys
+from dataclasses import dataclass
+from typing import BinaryIO, Iterator, TextIO
+
+from sample_codec import CodecError, Decoder
+
+# File header format (usb_logger.h); version 2 adds the sample coding
+LOG_MAGIC = 0x474F4C4A
+LOG_VERSIONS = (1, 2)
+FILE_HEADER = struct.Struct("<IHHIIIHHIIBBHHHIQ")
+CODING_HEADER = struct.Struct("<HH")
+
+# Sample codings (USB_LOG_CODING_*)
+CODING_RAW = 0
+CODING_CODEC = 1
+
+# Data block header format (usb_logger.h)
+BLOCK_HEADER = struct.Struct("<IIQHHI")
+
+# Block size of the medium (USB_MSC_BLOCK_SIZE)
+BLOCK_SIZE = 512
+
+# Slot size in blocks (USB_LOG_FILE_BLOCKS); every slot starts with a header
+FILE_BLOCKS = 262144
+
+# Blocks read per request while extracting
+READ_BLOCKS = 64
+
+
+@dataclass
+class LogFile:
+    """Header of one log file."""
+
+    number: int
+    slot: int
+    file_blocks: int
+    block_size: int
+    data_offset: int
+    sample_rate: int
+    timestamp_hz: int
+    channels: int
+    resolution: int
+    sample_size: int
+    block_header_size: int
+    samples_per_block: int
+    first_sequence: int
+    first_time: int
+    coding: int = CODING_RAW
+    codec_block: int = 0
+
+    @property
+    def start(self) -> int:
+        """Byte offset of the file on the medium."""
+        return self.slot * self.file_blocks * self.block_size
+
+
+def decode_header(data: bytes, slot: int) -> LogFile | None:
+    """Decode a file header, or return None if the slot holds no log file."""
+    if len(data) < FILE_HEADER.size:
+        return None
+    (
+        magic,
+        version,
+        header_size,
+        number,
+        header_slot,
+        file_blocks,
+        block_size,
+        data_offset,
+        sample_rate,
+        timestamp_hz,
+        channels,
+        resolution,
+        sample_size,
+        block_header_size,
+        samples_per_block,
+        first_sequence,
+        first_time,
+    ) = FILE_HEADER.unpack_from(data)
+    if (
+        magic != LOG_MAGIC
+        or version not in LOG_VERSIONS
+        or header_size < FILE_HEADER.size
+        or header_slot != slot
+        or block_size == 0
+        or block_header_size < BLOCK_HEADER.size
+        or sample_size != channels * 2
+    ):
+        return None
+    coding, codec_block = CODING_RAW, 0
+    if version >= 2:
+        if header_size < FILE_HEADER.size + CODING_HEADER.size:
+            return None
+        coding, codec_block = CODING_HEADER.unpack_from(data, FILE_HEADER.size)
+        if coding not in (CODING_RAW, CODING_CODEC) or (
+            coding == CODING_CODEC and codec_block == 0
+        ):
+            return None
+    return LogFile(
+        number,
+        slot,
+        file_blocks,
+        block_size,
+        data_offset,
+        sample_rate,
+        timestamp_hz,
+        channels,
+        resolution,
+        sample_size,
+        block_header_size,
+        samples_per_block,
+        first_sequence,
+        first_time,
+        coding,
+        codec_block,
+    )
+
+
+def scan(medium: BinaryIO) -> list[LogFile]:
+    """Read the header of every slot and return the files, oldest first."""
+    files: list[LogFile] = []
+    slot = 0
+    while True:
+        medium.seek(slot * FILE_BLOCKS * BLOCK_SIZE)
+        data = medium.read(BLOCK_SIZE)
+        if len(data) < BLOCK_SIZE:
+            break
+        log_file = decode_header(data, slot)
+        if log_file is not None:
+            files.append(log_file)
+        slot += 1
+    return sorted(files, key=lambda f: f.number)
+
+
+def decode_block(
+    log_file: LogFile, data: bytes, base: int, end: int, count: int
+) -> list[tuple[int, ...]]:
+    """Return the count samples of a data block stored from base to end.
+
+    Raises:
+        CodecError: If the coded samples are invalid.
+    """
+    if log_file.coding == CODING_RAW:
+        sample = struct.Struct(f"<{log_file.channels}H")
+        return [
+            sample.unpack_from(data, base + i * log_file.sample_size)
+            for i in range(count)
+        ]
+
+    # The codec state starts afresh in every data block
+    decoder = Decoder(log_file.channels)
+    block = data[:end]
+    decoded: list[tuple[int, ...]] = []
+    while len(decoded) < count:
+        frames, base = decoder.decode(
+            block, min(log_file.codec_block, count - len(decoded)), base
+        )
+        decoded += frames
+    return decoded
+
+
+def samples(
+    medium: BinaryIO, log_file: LogFile
+) -> Iterator[tuple[int, int, int, tuple[int, ...]]]:
+    """Yield (sequence, ticks, lost_before, raw) for every sample of a file.
+
+    ticks is 0 where the device had no timestamp for the block. The file ends
+    at the first block of another file, one without samples or one whose
+    coded samples do not decode.
+    """
+    period = log_file.timestamp_hz // max(log_file.sample_rate, 1)
+    block = log_file.data_offset
+    medium.seek(log_file.start + block * log_file.block_size)
+
+    while block < log_file.file_blocks:
+        data = medium.read(READ_BLOCKS * log_file.block_size)
+        if not data:
+            return
+        last = len(data) - log_file.block_size + 1
+        for offset in range(0, last, log_file.block_size):
+            number, sequence, ticks, count, lost, _ = BLOCK_HEADER.unpack_from(
+                data, offset
+            )
+            if (
+                number != log_file.number
+                or count == 0
+                or count > log_file.samples_per_block
+            ):
+                return
+            base = offset + log_file.block_header_size
+            end = offset + log_file.block_size
+            try:
+                block_samples = decode_block(log_file, data, base, end, count)
+            except CodecError:
+                return
+            for i, raw in enumerate(block_samples):
+                stamp = ticks + i * period if ticks else 0
+                lost_before = lost if i == 0 else 0
+                yield (sequence + i) & 0xFFFFFFFF, stamp, lost_before, raw
+            block += 1
+
+
+def list_files(medium: BinaryIO) -> int:
+    """Print the files on the medium."""
+    files = scan(medium)
+    if not files:
+        print("No log files found")
+        return 1
+    for log_file in files:
+        start = log_file.first_time / max(log_file.timestamp_hz, 1)
+        print(
+            f"file {log_file.number:6d}  slot {log_file.slot:4d}  "
+            f"first sample {log_file.first_sequence} at {start:.3f} s  "
+            f"{log_file.channels} ch @ {log_file.sample_rate} Hz"
+        )
+    return 0
+
+
+def extract(medium: BinaryIO, number: int, csv_file: TextIO | None) -> int:
+    """Print the statistics of a file and optionally write its samples."""
+    matches = [f for f in scan(medium) if f.number == number]
+    if not matches:
+        print(f"File {number} not found", file=sys.stderr)
+        return 1
+    log_file = matches[0]
+
+    writer = None
+    if csv_file is not None:
+        writer = csv.writer(csv_file)
+        channels = [f"raw_a{ch}" for ch in range(log_file.channels)]
+        writer.writerow(["sequence", "time_s", *channels])
+
+    count = 0
+    lost = 0
+    for sequence, ticks, lost_before, raw in samples(medium, log_file):
+        count += 1
+        lost += lost_before
+        if writer is not None:
+            stamp = f"{ticks / log_file.timestamp_hz:.7f}" if ticks else ""
+            writer.writerow([sequence, stamp, *raw])
+
+    seconds = count / max(log_file.sample_rate, 1)
+    print(f"file {number}: {count} samples ({seconds:.1f} s), {lost} lost")
+    return 2 if lost else 0
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="List and extract the jerry_device USB stick sample logs",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s /dev/sdb
+  %(prog)s /dev/sdb --file 12 --csv file12.csv
+  %(prog)s stick.img --file 12
+
+Exit status is 2 if the extracted file reports lost samples.
+        """,
+    )
+
+    parser.add_argument("medium", help="Raw stick device or image file")
+    parser.add_argument(
+        "--file",
+        "-f",
+        type=int,
+        default=None,
+        help="File number to extract (default: list the files)",
+    )
+    parser.add_argument(
+        "--csv",
+        "-c",
+        default=None,
+        help="Write the samples of the extracted file to this CSV file",
+    )
+
+    args = parser.parse_args()
+
+    with open(args.medium, "rb") as medium:
+        if args.file is None:
+            return list_files(medium)
+        if args.csv:
+            with open(
+                args.csv, "w", newline="", encoding="utf-8"
+            ) as csv_file:
+                return extract(medium, args.file, csv_file)
+        return extract(medium, args.file, None)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
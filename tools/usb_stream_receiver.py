@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""
+USB Stream Receiver
+
+Starts the ADC waveform stream of a jerry_device built with
+JERRY_USB_STREAM and receives it from the USB bulk endpoint. Every bulk
+transfer is one block in the UDP stream datagram format, so the blocks are
+put together and checked by adc_stream_receiver.py; the stream is started
+and stopped with the vendor requests of application/inc/usb_stream.h.
+
+Needs pyusb and a libusb backend; on Windows the device binds WinUSB by
+itself.
+
+Usage:
+    python usb_stream_receiver.py
+    python usb_stream_receiver.py --channels 0x03 --csv samples.csv
+    python usb_stream_receiver.py --decimated --content filtered
+    python usb_stream_receiver.py --di --csv samples.csv
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import struct
+import sys
+import time
+from typing import Any, TextIO
+
+import adc_stream_receiver as stream
+
+try:
+    import usb.core
+    import usb.util
+except ImportError:
+    print("Error: pyusb is required. Install with: pip install pyusb")
+    sys.exit(1)
+
+# Device IDs (USB_STREAM_VENDOR_ID, USB_STREAM_PRODUCT_ID)
+DEFAULT_VENDOR_ID = 0x1209
+DEFAULT_PRODUCT_ID = 0x0001
+DEFAULT_INTERVAL = 1.0
+
+# Vendor requests (usb_stream.h)
+REQ_START = 0x01
+REQ_STOP = 0x02
+REQ_INFO = 0x03
+REQ_TYPE_OUT = 0x40
+REQ_TYPE_IN = 0xC0
+START_DECIMATED = 0x0001
+
+# Bulk IN endpoint and largest block (BSP_USBD_EP_BULK_IN, USB_STREAM_BLOCK_SIZE)
+ENDPOINT = 0x81
+BLOCK_SIZE = 1472
+
+# Reply of REQ_INFO
+INFO = struct.Struct("<BBHIHHII")
+
+# Blocks arrive in order: none are held back
+REORDER_WINDOW = 0
+
+# Bulk read timeout in milliseconds
+READ_TIMEOUT_MS = 200
+
+CONTENT = {
+    "raw": stream.FLAG_RAW,
+    "filtered": stream.FLAG_FILTERED,
+    "both": stream.FLAG_RAW | stream.FLAG_FILTERED,
+}
+
+
+def read_info(device: Any) -> dict[str, int]:
+    """Read the stream information of the device."""
+    data = bytes(device.ctrl_transfer(REQ_TYPE_IN, REQ_INFO, 0, 0, INFO.size))
+    if len(data) < INFO.size:
+        raise ValueError(f"short info reply, {len(data)} bytes")
+    channels, streaming, block_size, rate, decimation, _, sent, lost = (
+        INFO.unpack_from(data)
+    )
+    return {
+        "channels": channels,
+        "streaming": streaming,
+        "block_size": block_size,
+        "sample_rate": rate,
+        "decimation": decimation,
+        "blocks_sent": sent,
+        "samples_lost": lost,
+    }
+
+
+def drain(device: Any) -> None:
+    """Discard the blocks still queued from an earlier stream."""
+    while True:
+        try:
+            device.read(ENDPOINT, 4096, timeout=50)
+        except usb.core.USBTimeoutError:
+            return
+
+
+def receive(
+    device: Any,
+    mask: int,
+    content: int,
+    decimated: bool,
+    interval: float,
+    csv_file: TextIO | None,
+) -> int:
+    """Start the stream and receive it until interrupted."""
+    writer = csv.writer(csv_file) if csv_file is not None else None
+    reassembler = stream.StreamReassembler(REORDER_WINDOW, writer)
+
+    device.ctrl_transfer(REQ_TYPE_OUT, REQ_STOP, 0, 0)
+    drain(device)
+
+    info = read_info(device)
+    rate = info["sample_rate"]
+    if decimated and info["decimation"]:
+        rate //= info["decimation"]
+    print(
+        f"Device: {info['channels']} channels, {rate} Hz streamed, "
+        f"blocks of up to {info['block_size']} bytes"
+    )
+
+    device.ctrl_transfer(
+        REQ_TYPE_OUT,
+        REQ_START,
+        (mask & 0xFF) | (content << 8),
+        START_DECIMATED if decimated else 0,
+    )
+    print("Press Ctrl+C to stop\n")
+
+    next_report = time.monotonic() + interval
+    try:
+        while True:
+            try:
+                data = device.read(ENDPOINT, 4096, timeout=READ_TIMEOUT_MS)
+                reassembler.push(bytes(data))
+            except usb.core.USBTimeoutError:
+                pass
+
+            now = time.monotonic()
+            if now >= next_report:
+                next_report = now + interval
+                print(reassembler.stats.report())
+
+    except KeyboardInterrupt:
+        print("\n\nReception stopped.")
+    finally:
+        try:
+            device.ctrl_transfer(REQ_TYPE_OUT, REQ_STOP, 0, 0)
+        except usb.core.USBError:
+            pass
+        reassembler.flush()
+
+    print(f"Total: {reassembler.stats.report()}")
+    return 0 if reassembler.stats.lost == 0 else 2
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(
+        description="Receive the jerry_device ADC stream over USB and report loss",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  %(prog)s
+  %(prog)s --channels 0x03 --csv samples.csv
+  %(prog)s --decimated --content filtered
+  %(prog)s --di --csv samples.csv
+
+Exit status is 2 if any block was lost.
+        """,
+    )
+
+    parser.add_argument(
+        "--vid",
+        type=lambda value: int(value, 0),
+        default=DEFAULT_VENDOR_ID,
+        help=f"USB vendor ID (default: 0x{DEFAULT_VENDOR_ID:04X})",
+    )
+    parser.add_argument(
+        "--pid",
+        type=lambda value: int(value, 0),
+        default=DEFAULT_PRODUCT_ID,
+        help=f"USB product ID (default: 0x{DEFAULT_PRODUCT_ID:04X})",
+    )
+    parser.add_argument(
+        "--channels",
+        "-m",
+        type=lambda value: int(value, 0),
+        default=(1 << stream.NUM_CHANNELS) - 1,
+        help="Channel mask, bit 0 = A0 (default: all)",
+    )
+    parser.add_argument(
+        "--content",
+        choices=sorted(CONTENT),
+        default="both",
+        help="Samples streamed per channel (default: both)",
+    )
+    parser.add_argument(
+        "--di",
+        action="store_true",
+        help="Add the captured digital inputs to every frame",
+    )
+    parser.add_argument(
+        "--decimated",
+        "-d",
+        action="store_true",
+        help="Stream the decimated instead of the full-rate samples",
+    )
+    parser.add_argument(
+        "--interval",
+        "-i",
+        type=float,
+        default=DEFAULT_INTERVAL,
+        help=f"Report interval in seconds (default: {DEFAULT_INTERVAL})",
+    )
+    parser.add_argument(
+        "--csv",
+        "-c",
+        default=None,
+        help="Write the received samples to this CSV file",
+    )
+
+    args = parser.parse_args()
+
+    device = usb.core.find(idVendor=args.vid, idProduct=args.pid)
+    if device is None:
+        print(f"Error: no device {args.vid:04X}:{args.pid:04X} found")
+        return 1
+    device.set_configuration()
+    usb.util.claim_interface(device, 0)
+
+    content = CONTENT[args.content] | (stream.FLAG_DI if args.di else 0)
+
+    try:
+        if args.csv:
+            with open(args.csv, "w", newline="", encoding="utf-8") as csv_file:
+                return receive(
+                    device,
+                    args.channels,
+                    content,
+                    args.decimated,
+                    args.interval,
+                    csv_file,
+                )
+        return receive(
+            device,
+            args.channels,
+            content,
+            args.decimated,
+            args.interval,
+            None,
+        )
+    finally:
+        usb.util.release_interface(device, 0)
+        usb.util.dispose_resources(device)
+
+
+if __name__ == "__main__":
+    sys.exit(main())